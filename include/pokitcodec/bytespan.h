@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitCodec::ByteSpan and PokitCodec::MutableByteSpan types, and little-endian byte helpers.
+ */
+
+#ifndef POKITCODEC_BYTESPAN_H
+#define POKITCODEC_BYTESPAN_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__has_include)
+  #if __has_include(<version>)
+    #include <version>
+  #endif
+#endif
+#if defined(__cpp_lib_span)
+  #include <span>
+#endif
+
+namespace PokitCodec {
+
+#if defined(__cpp_lib_span)
+
+/// Read-only view of a contiguous sequence of bytes, such as a characteristic's value.
+using ByteSpan = std::span<const std::byte>;
+
+/// Writable view of a contiguous sequence of bytes, such as a buffer to encode a characteristic's value into.
+using MutableByteSpan = std::span<std::byte>;
+
+#else
+
+/*!
+ * Minimal stand-in for C++20's `std::span`, for C++17 builds, providing just the members the codecs need. With C++20,
+ * ByteSpan and MutableByteSpan are `std::span` instead, so code written against this subset works with either.
+ */
+template<typename T>
+class Span
+{
+public:
+    /// Constructs an empty span.
+    constexpr Span() noexcept = default;
+
+    /// Constructs a span over the \a size elements beginning at \a data.
+    constexpr Span(T * const data, const std::size_t size) noexcept : first(data), count(size) { }
+
+    /// Constructs a span over all of \a array's elements.
+    template<typename U, std::size_t N, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    constexpr Span(std::array<U, N> &array) noexcept : first(array.data()), count(N) { }
+
+    /// Constructs a span over all of \a array's elements.
+    template<typename U, std::size_t N, typename = std::enable_if_t<std::is_convertible_v<const U (*)[], T (*)[]>>>
+    constexpr Span(const std::array<U, N> &array) noexcept : first(array.data()), count(N) { }
+
+    /// Constructs a span over all of \a other's elements, such as a read-only span over a writable one.
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    constexpr Span(const Span<U> &other) noexcept : first(other.data()), count(other.size()) { }
+
+    constexpr T * data() const noexcept { return first; }             ///< Returns the first element.
+    constexpr std::size_t size() const noexcept { return count; }     ///< Returns the number of elements.
+    constexpr bool empty() const noexcept { return count == 0; }      ///< Returns \c true if there are no elements.
+    constexpr T * begin() const noexcept { return first; }            ///< Returns the first element.
+    constexpr T * end() const noexcept { return first + count; }      ///< Returns one past the last element.
+    constexpr T &operator[](const std::size_t index) const { return first[index]; } ///< Returns element \a index.
+
+    /// Returns a span over the \a size elements of this span beginning at \a offset, which must all be in range.
+    constexpr Span subspan(const std::size_t offset, const std::size_t size) const
+    {
+        return Span(first + offset, size);
+    }
+
+private:
+    T * first { nullptr };  ///< First element.
+    std::size_t count { 0 }; ///< Number of elements.
+};
+
+using ByteSpan = Span<const std::byte>; ///< Read-only view of a contiguous sequence of bytes.
+using MutableByteSpan = Span<std::byte>; ///< Writable view of a contiguous sequence of bytes.
+
+#endif
+
+/*!
+ * Returns \a T decoded from the little-endian bytes beginning at \a data, regardless of the host's byte order. \a T
+ * must be an arithmetic type of 1, 2, 4 or 8 bytes; \a Byte may be any byte-sized type (such as `std::byte` or
+ * `char`). Compilers reduce this to a single (possibly byte-swapped) load.
+ */
+template<typename T, typename Byte>
+T fromLittleEndian(const Byte * const data) noexcept
+{
+    static_assert(sizeof(Byte) == 1, "Byte must be a byte-sized type");
+    static_assert(std::is_arithmetic_v<T>, "Only arithmetic types may be decoded");
+    using Bits = std::conditional_t<sizeof(T) == 1, std::uint8_t, std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                 std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+    static_assert(sizeof(Bits) == sizeof(T), "Only 1, 2, 4 and 8 byte types may be decoded");
+    Bits bits = 0;
+    for (std::size_t index = 0; index < sizeof(T); ++index) {
+        bits = static_cast<Bits>(bits | (static_cast<Bits>(static_cast<std::uint8_t>(data[index])) << (8 * index)));
+    }
+    if constexpr (std::is_integral_v<T>) {
+        return static_cast<T>(bits);
+    } else {
+        T value {};
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+}
+
+/*!
+ * Encodes \a value as little-endian bytes into \a data, which must have room for `sizeof(T)` bytes, regardless of the
+ * host's byte order.
+ *
+ * \see fromLittleEndian
+ */
+template<typename T, typename Byte>
+void toLittleEndian(const T value, Byte * const data) noexcept
+{
+    static_assert(sizeof(Byte) == 1, "Byte must be a byte-sized type");
+    static_assert(std::is_arithmetic_v<T>, "Only arithmetic types may be encoded");
+    using Bits = std::conditional_t<sizeof(T) == 1, std::uint8_t, std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                 std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+    static_assert(sizeof(Bits) == sizeof(T), "Only 1, 2, 4 and 8 byte types may be encoded");
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    for (std::size_t index = 0; index < sizeof(T); ++index) {
+        data[index] = static_cast<Byte>((bits >> (8 * index)) & 0xFF);
+    }
+}
+
+} // namespace PokitCodec
+
+#endif // POKITCODEC_BYTESPAN_H
@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitCodec::CharacteristicLayout namespace, for describing the byte layouts of Pokit characteristics.
+ */
+
+#ifndef POKITCODEC_CHARACTERISTICLAYOUT_H
+#define POKITCODEC_CHARACTERISTICLAYOUT_H
+
+#include "bytespan.h"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+/*!
+ * Compile-time descriptions of the (little-endian, packed) byte layouts of Pokit characteristics.
+ *
+ * Each characteristic's fields are described once, as a chain of Field (and Bytes) types, each following the previous,
+ * and then gathered into a Layout, which derives the offset of every field, and the total size, at compile time. For
+ * example:
+ *
+ * \code
+ * namespace ReadingLayout {
+ *     using Status = CharacteristicLayout::Field<std::uint8_t>;
+ *     using Value  = CharacteristicLayout::Field<float, Status>;
+ *     using Layout = CharacteristicLayout::Layout<Status, Value>;
+ *     static_assert(Layout::size == 5);
+ * }
+ * \endcode
+ *
+ * Layout::write then encodes fields into a fixed-size Layout::Buffer (with no allocations, or growing), while
+ * Layout::read decodes fields in place, direct from a value's bytes (as `std::byte`, `char`, or any other byte type).
+ *
+ * This namespace has no dependencies beyond the C++17 standard library.
+ */
+namespace PokitCodec::CharacteristicLayout {
+
+/// The (empty) start of a layout, which the first field in a layout follows.
+struct Start
+{
+    static constexpr std::size_t end = 0; ///< Offset of the byte following this field (ie none).
+};
+
+/*!
+ * A field of type \a T, immediately following the \a Previous field. \a T must be an arithmetic type (encoded in
+ * little-endian byte order), or an enumeration (encoded as its underlying type).
+ */
+template<typename T, typename Previous = Start>
+struct Field
+{
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "Fields must be arithmetic, or enumeration, types");
+    using Type = T; ///< The field's (decoded) type.
+    using StorageType = typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>,
+                                                    std::remove_cv<T>>::type; ///< The field's encoded type.
+    static constexpr std::size_t offset = Previous::end;         ///< Offset of the field's first byte.
+    static constexpr std::size_t size = sizeof(StorageType);     ///< Number of bytes the field occupies.
+    static constexpr std::size_t end = offset + size;            ///< Offset of the byte following this field.
+};
+
+/*!
+ * A field of \a Size raw bytes, immediately following the \a Previous field. This is used for fields that are not
+ * little-endian numbers (such as MAC addresses), and for reserved (or undocumented) bytes.
+ */
+template<std::size_t Size, typename Previous = Start>
+struct Bytes
+{
+    static_assert(Size > 0, "Bytes fields must have at least one byte");
+    using Type = void;                                           ///< Raw bytes have no (decoded) type.
+    static constexpr std::size_t offset = Previous::end;         ///< Offset of the field's first byte.
+    static constexpr std::size_t size = Size;                    ///< Number of bytes the field occupies.
+    static constexpr std::size_t end = offset + size;            ///< Offset of the byte following this field.
+};
+
+/*!
+ * Returns \c true if each of the \a Next and \a Rest fields immediately follows its predecessor, starting from
+ * \a Previous.
+ */
+template<typename Previous, typename Next, typename... Rest>
+constexpr bool isContiguous()
+{
+    if constexpr (sizeof...(Rest) == 0) {
+        return Next::offset == Previous::end;
+    } else {
+        return (Next::offset == Previous::end) && isContiguous<Next, Rest...>();
+    }
+}
+
+/*!
+ * The layout of a characteristic made up of \a Fields, in order. The fields must be listed in the same order they were
+ * chained, without gaps, which is verified at compile time.
+ */
+template<typename... Fields>
+struct Layout
+{
+    static_assert(sizeof...(Fields) > 0, "Layouts must have at least one field");
+    static_assert(isContiguous<Start, Fields...>(), "Layout fields must be listed in order, with none missing");
+
+    static constexpr std::size_t size = (0 + ... + Fields::size); ///< Total number of bytes in the layout.
+
+    using Buffer = std::array<std::byte, size>; ///< Fixed-size buffer, for encoding an entire layout.
+
+    /// \c true if \a F is one of this layout's fields.
+    template<typename F>
+    static constexpr bool hasField = (std::is_same_v<F, Fields> || ...);
+
+    /*!
+     * Returns \c true if a value of \a valueSize bytes is long enough to include field \a F. This is for optional,
+     * trailing fields, that only some devices (or firmware versions) include.
+     */
+    template<typename F>
+    static constexpr bool includes(const std::size_t valueSize)
+    {
+        static_assert(hasField<F>, "Field is not part of this layout");
+        return valueSize >= F::end;
+    }
+
+    /*!
+     * Returns field \a F, decoded in place from \a data, which must contain at least size bytes (or F::end bytes, for
+     * optional, trailing fields).
+     */
+    template<typename F, typename Byte>
+    static typename F::Type read(const Byte * const data)
+    {
+        static_assert(hasField<F>, "Field is not part of this layout");
+        static_assert(!std::is_void_v<typename F::Type>, "Bytes fields have no type; use bytes() instead");
+        return static_cast<typename F::Type>(fromLittleEndian<typename F::StorageType>(data + F::offset));
+    }
+
+    /*!
+     * Returns field \a F, decoded in place from \a value, which must contain at least size bytes (or F::end bytes,
+     * for optional, trailing fields).
+     */
+    template<typename F>
+    static typename F::Type read(const ByteSpan value)
+    {
+        return read<F>(value.data());
+    }
+
+    /*!
+     * Returns a pointer to the first byte of (Bytes) field \a F, within \a data.
+     */
+    template<typename F, typename Byte>
+    static const Byte * bytes(const Byte * const data)
+    {
+        static_assert(hasField<F>, "Field is not part of this layout");
+        return data + F::offset;
+    }
+
+    /*!
+     * Encodes \a value into \a data, which must have room for at least size bytes, as field \a F. The \a value's type
+     * must match the field's type exactly; this catches (at compile time) any implicit narrowing, or conversion, of the
+     * value being encoded.
+     */
+    template<typename F, typename V>
+    static void write(std::byte * const data, const V value)
+    {
+        static_assert(hasField<F>, "Field is not part of this layout");
+        static_assert(std::is_same_v<V, typename F::Type>, "Value type must match the field's type");
+        toLittleEndian<typename F::StorageType>(static_cast<typename F::StorageType>(value), data + F::offset);
+    }
+
+    /*!
+     * Encodes \a value into the \a buffer as field \a F.
+     */
+    template<typename F, typename V>
+    static void write(Buffer &buffer, const V value)
+    {
+        write<F>(buffer.data(), value);
+    }
+};
+
+} // namespace PokitCodec::CharacteristicLayout
+
+#endif // POKITCODEC_CHARACTERISTICLAYOUT_H
@@ -0,0 +1,519 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitCodec namespace, for encoding and decoding the values of Pokit characteristics.
+ */
+
+#ifndef POKITCODEC_POKITCODEC_H
+#define POKITCODEC_POKITCODEC_H
+
+#include "bytespan.h"
+#include "characteristiclayout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+/*!
+ * Encoders and decoders for the values of Pokit characteristics, independent of any Bluetooth stack.
+ *
+ * Every function here works on caller-owned memory (a ByteSpan to decode from, or a MutableByteSpan to encode into),
+ * performs no allocations, never throws, and has no dependencies beyond the C++17 standard library. This makes them
+ * suitable for firmware-adjacent tools, fuzzers, and other bindings, as well as QtPokit, which is a thin layer over
+ * these, adding Qt types, logging, and diagnostics.
+ *
+ * Enumerated fields are represented by their raw (underlying) values, since the meaning of those values (and their
+ * names) is left to the caller.
+ *
+ * Decoders return \c false if the value is too short to decode, in which case the output is left untouched. Values
+ * that are longer than expected are decoded anyway, ignoring the unexpected trailing bytes, since Pokit devices have
+ * been known to append (as yet, undocumented) fields over time.
+ */
+namespace PokitCodec {
+
+/*!
+ * Decodes the little-endian 16-bit samples in \a value into the caller-owned \a samples buffer, which must have room
+ * for at least half as many samples as \a value has bytes. This is the format of both the DSO and Data Logger
+ * services' `Reading` characteristics.
+ *
+ * On little-endian hosts, this reduces to a plain memory copy.
+ *
+ * Returns \c true on success, or \c false if \a value has an odd number of bytes (in which case \a samples is left
+ * untouched).
+ */
+inline bool decodeSamples(const ByteSpan value, std::int16_t * const samples) noexcept
+{
+    if ((value.size()%2) != 0) {
+        return false;
+    }
+    #if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+    if (!value.empty()) {
+        std::memcpy(samples, value.data(), value.size());
+    }
+    #else
+    for (std::size_t index = 0; index < value.size()/2; ++index) {
+        samples[index] = fromLittleEndian<std::int16_t>(value.data() + (index * 2));
+    }
+    #endif
+    return true;
+}
+
+/// Codecs for the Calibration service's characteristics.
+namespace Calibration {
+
+/// Layout of the `Temperature` characteristic.
+namespace TemperatureLayout {
+    using Temperature = CharacteristicLayout::Field<float>;
+    using Layout = CharacteristicLayout::Layout<Temperature>;
+    static_assert(Layout::size == 4, "Pokit devices expect 32-bit floats");
+}
+
+constexpr std::size_t temperatureSize = TemperatureLayout::Layout::size; ///< Size of an encoded `Temperature` value.
+
+/*!
+ * Encodes the ambient temperature \a value (in degrees Celsius) into \a out, and returns the number of bytes written,
+ * or \c 0 if \a out is too small.
+ */
+inline std::size_t encodeTemperature(const float value, const MutableByteSpan out) noexcept
+{
+    using namespace TemperatureLayout;
+    if (out.size() < Layout::size) {
+        return 0;
+    }
+    Layout::write<Temperature>(out.data(), value);
+    return Layout::size;
+}
+
+} // namespace Calibration
+
+/// Codecs for the Data Logger service's characteristics.
+namespace DataLogger {
+
+/// Attributes of the `Settings` characteristic.
+struct Settings {
+    std::uint8_t command;        ///< Custom operation request.
+    std::uint16_t arguments;     ///< Reserved to used along with #command in future.
+    std::uint8_t mode;           ///< Desired operation mode.
+    std::uint8_t range;          ///< Desired range.
+    std::uint32_t updateInterval; ///< Desired update interval in milliseconds.
+    std::uint32_t timestamp;     ///< Custom timestamp for start time in retrieved metadata.
+};
+
+/// Attributes of the `Metadata` characteristic.
+struct Metadata {
+    std::uint8_t status;          ///< Current data logger status.
+    float scale;                  ///< Scale to apply to read samples.
+    std::uint8_t mode;            ///< Current operation mode.
+    std::uint8_t range;           ///< Current range.
+    std::uint32_t updateInterval; ///< Current logging interval in milliseconds.
+    std::uint16_t numberOfSamples; ///< Number of samples acquired.
+    std::uint32_t timestamp;      ///< Timestamp stored at the beginning of the logging session.
+};
+
+/// Layout of the `Settings` characteristic, for Pokit Meter devices.
+namespace MeterSettingsLayout {
+    using Command        = CharacteristicLayout::Field<std::uint8_t>;
+    using Arguments      = CharacteristicLayout::Field<std::uint16_t, Command>;
+    using Mode           = CharacteristicLayout::Field<std::uint8_t,  Arguments>;
+    using Range          = CharacteristicLayout::Field<std::uint8_t,  Mode>;
+    using UpdateInterval = CharacteristicLayout::Field<std::uint16_t, Range>; // Seconds.
+    using Timestamp      = CharacteristicLayout::Field<std::uint32_t, UpdateInterval>;
+    using Layout = CharacteristicLayout::Layout<Command, Arguments, Mode, Range, UpdateInterval, Timestamp>;
+    static_assert(Layout::size == 11, "Pokit API 1.00 specifies 11 bytes");
+}
+
+/// Layout of the `Settings` characteristic, for Pokit Pro devices.
+namespace ProSettingsLayout {
+    using MeterSettingsLayout::Command, MeterSettingsLayout::Arguments, MeterSettingsLayout::Mode,
+          MeterSettingsLayout::Range;
+    using UpdateInterval = CharacteristicLayout::Field<std::uint32_t, Range>; // Milliseconds.
+    using Timestamp      = CharacteristicLayout::Field<std::uint32_t, UpdateInterval>;
+    using Layout = CharacteristicLayout::Layout<Command, Arguments, Mode, Range, UpdateInterval, Timestamp>;
+    static_assert(Layout::size == 13, "Expected 13 bytes, according to testing / experimentation");
+}
+
+/// Layout of the `Metadata` characteristic, for Pokit Meter devices.
+namespace MeterMetadataLayout {
+    using Status          = CharacteristicLayout::Field<std::uint8_t>;
+    using Scale           = CharacteristicLayout::Field<float,         Status>;
+    using Mode            = CharacteristicLayout::Field<std::uint8_t,  Scale>;
+    using Range           = CharacteristicLayout::Field<std::uint8_t,  Mode>;
+    using UpdateInterval  = CharacteristicLayout::Field<std::uint16_t, Range>; // Seconds.
+    using NumberOfSamples = CharacteristicLayout::Field<std::uint16_t, UpdateInterval>;
+    using Timestamp       = CharacteristicLayout::Field<std::uint32_t, NumberOfSamples>;
+    using Layout = CharacteristicLayout::Layout<Status, Scale, Mode, Range, UpdateInterval, NumberOfSamples,
+                                                Timestamp>;
+    static_assert(Layout::size == 15, "Pokit API 1.00 specifies 15 bytes");
+}
+
+/// Layout of the `Metadata` characteristic, for Pokit Pro devices.
+namespace ProMetadataLayout {
+    using MeterMetadataLayout::Status, MeterMetadataLayout::Scale, MeterMetadataLayout::Mode,
+          MeterMetadataLayout::Range;
+    using UpdateInterval  = CharacteristicLayout::Field<std::uint32_t, Range>; // Milliseconds.
+    using NumberOfSamples = CharacteristicLayout::Field<std::uint16_t, UpdateInterval>;
+    using Unknown         = CharacteristicLayout::Bytes<6,             NumberOfSamples>; // As yet, undocumented.
+    using Timestamp       = CharacteristicLayout::Field<std::uint32_t, Unknown>;
+    using Layout = CharacteristicLayout::Layout<Status, Scale, Mode, Range, UpdateInterval, NumberOfSamples, Unknown,
+                                                Timestamp>;
+    static_assert(Layout::size == 23, "Expected 23 bytes, according to testing / experimentation");
+}
+
+constexpr std::size_t meterSettingsSize = MeterSettingsLayout::Layout::size; ///< Size of Pokit Meter `Settings`.
+constexpr std::size_t proSettingsSize   = ProSettingsLayout::Layout::size;   ///< Size of Pokit Pro `Settings`.
+constexpr std::size_t meterMetadataSize = MeterMetadataLayout::Layout::size; ///< Size of Pokit Meter `Metadata`.
+constexpr std::size_t proMetadataSize   = ProMetadataLayout::Layout::size;   ///< Size of Pokit Pro `Metadata`.
+
+/*!
+ * Encodes \a settings into \a out, and returns the number of bytes written, or \c 0 if \a out is too small.
+ *
+ * If \a updateIntervalIs32bit is \c true, then the `Update Interval` field is encoded as 32-bit milliseconds (as for
+ * Pokit Pro devices), otherwise as 16-bit seconds, rounded to the nearest second (as for Pokit Meter devices).
+ */
+inline std::size_t encodeSettings(const Settings &settings, const bool updateIntervalIs32bit,
+                                  const MutableByteSpan out) noexcept
+{
+    // The Command, Arguments, Mode and Range fields are common to both the Pokit Meter and Pokit Pro layouts.
+    using namespace MeterSettingsLayout;
+    const std::size_t size = (updateIntervalIs32bit) ? ProSettingsLayout::Layout::size : Layout::size;
+    if (out.size() < size) {
+        return 0;
+    }
+    std::byte * const data = out.data();
+    Layout::write<Command>(data, settings.command);
+    Layout::write<Arguments>(data, settings.arguments);
+    Layout::write<Mode>(data, settings.mode);
+    Layout::write<Range>(data, settings.range);
+    if (updateIntervalIs32bit) {
+        ProSettingsLayout::Layout::write<ProSettingsLayout::UpdateInterval>(data, settings.updateInterval);
+        ProSettingsLayout::Layout::write<ProSettingsLayout::Timestamp>(data, settings.timestamp);
+    } else {
+        Layout::write<UpdateInterval>(data, static_cast<std::uint16_t>((settings.updateInterval+500)/1000));
+        Layout::write<Timestamp>(data, settings.timestamp);
+    }
+    return size;
+}
+
+/*!
+ * Decodes the `Metadata` \a value into \a metadata, with the update interval normalised to milliseconds.
+ *
+ * Pokit Meter and Pokit Pro devices use different (15 and 23 byte) layouts, which share their first four fields. So
+ * if \a value is at least as long as the shorter layout, but is not exactly either layout's size, then just those
+ * first four fields are decoded, and \c false returned.
+ */
+inline bool parseMetadata(const ByteSpan value, Metadata &metadata) noexcept
+{
+    if (value.size() < MeterMetadataLayout::Layout::size) {
+        return false;
+    }
+
+    const std::byte * const data = value.data();
+    metadata.status = MeterMetadataLayout::Layout::read<MeterMetadataLayout::Status>(data);
+    metadata.scale  = MeterMetadataLayout::Layout::read<MeterMetadataLayout::Scale>(data);
+    metadata.mode   = MeterMetadataLayout::Layout::read<MeterMetadataLayout::Mode>(data);
+    metadata.range  = MeterMetadataLayout::Layout::read<MeterMetadataLayout::Range>(data);
+
+    if (value.size() == MeterMetadataLayout::Layout::size) {
+        using namespace MeterMetadataLayout;
+        metadata.updateInterval  = static_cast<std::uint32_t>(Layout::read<UpdateInterval>(data))*1000;
+        metadata.numberOfSamples = Layout::read<NumberOfSamples>(data);
+        metadata.timestamp       = Layout::read<Timestamp>(data);
+        return true;
+    }
+    if (value.size() == ProMetadataLayout::Layout::size) {
+        using namespace ProMetadataLayout;
+        metadata.updateInterval  = Layout::read<UpdateInterval>(data);
+        metadata.numberOfSamples = Layout::read<NumberOfSamples>(data);
+        metadata.timestamp       = Layout::read<Timestamp>(data);
+        return true;
+    }
+    return false;
+}
+
+} // namespace DataLogger
+
+/// Codecs for the DSO service's characteristics.
+namespace Dso {
+
+/// Attributes of the `Settings` characteristic.
+struct Settings {
+    std::uint8_t command;          ///< Custom operation request.
+    float triggerLevel;            ///< Trigger threshold level in Volts or Amps, depending on #mode.
+    std::uint8_t mode;             ///< Desired operation mode.
+    std::uint8_t range;            ///< Desired range.
+    std::uint32_t samplingWindow;  ///< Desired sampling window in microseconds.
+    std::uint16_t numberOfSamples; ///< Desired number of samples to acquire.
+};
+
+/// Attributes of the `Metadata` characteristic.
+struct Metadata {
+    std::uint8_t status;           ///< Current DSO status.
+    float scale;                   ///< Scale to apply to read samples.
+    std::uint8_t mode;             ///< Operation mode used during last acquisition.
+    std::uint8_t range;            ///< Range used during last acquisition.
+    std::uint32_t samplingWindow;  ///< Sampling window (microseconds) used during last acquisition.
+    std::uint16_t numberOfSamples; ///< Number of samples acquired.
+    std::uint32_t samplingRate;    ///< Sampling rate used during last acquisition.
+};
+
+/// Layout of the `Settings` characteristic.
+namespace SettingsLayout {
+    using Command         = CharacteristicLayout::Field<std::uint8_t>;
+    using TriggerLevel    = CharacteristicLayout::Field<float,         Command>;
+    using Mode            = CharacteristicLayout::Field<std::uint8_t,  TriggerLevel>;
+    using Range           = CharacteristicLayout::Field<std::uint8_t,  Mode>;
+    using SamplingWindow  = CharacteristicLayout::Field<std::uint32_t, Range>;
+    using NumberOfSamples = CharacteristicLayout::Field<std::uint16_t, SamplingWindow>;
+    using Layout = CharacteristicLayout::Layout<Command, TriggerLevel, Mode, Range, SamplingWindow, NumberOfSamples>;
+    static_assert(Layout::size == 13, "Pokit API 1.00 specifies 13 bytes");
+}
+
+/// Layout of the `Metadata` characteristic.
+namespace MetadataLayout {
+    using Status          = CharacteristicLayout::Field<std::uint8_t>;
+    using Scale           = CharacteristicLayout::Field<float,         Status>;
+    using Mode            = CharacteristicLayout::Field<std::uint8_t,  Scale>;
+    using Range           = CharacteristicLayout::Field<std::uint8_t,  Mode>;
+    using SamplingWindow  = CharacteristicLayout::Field<std::uint32_t, Range>;
+    using NumberOfSamples = CharacteristicLayout::Field<std::uint16_t, SamplingWindow>;
+    using SamplingRate    = CharacteristicLayout::Field<std::uint32_t, NumberOfSamples>;
+    using Layout = CharacteristicLayout::Layout<Status, Scale, Mode, Range, SamplingWindow, NumberOfSamples,
+                                                SamplingRate>;
+    static_assert(Layout::size == 17, "Pokit API 1.00 specifies 17 bytes");
+}
+
+constexpr std::size_t settingsSize = SettingsLayout::Layout::size; ///< Size of an encoded `Settings` value.
+constexpr std::size_t metadataSize = MetadataLayout::Layout::size; ///< Size of a `Metadata` value.
+
+/*!
+ * Encodes \a settings into \a out, and returns the number of bytes written, or \c 0 if \a out is too small.
+ */
+inline std::size_t encodeSettings(const Settings &settings, const MutableByteSpan out) noexcept
+{
+    using namespace SettingsLayout;
+    if (out.size() < Layout::size) {
+        return 0;
+    }
+    std::byte * const data = out.data();
+    Layout::write<Command>(data, settings.command);
+    Layout::write<TriggerLevel>(data, settings.triggerLevel);
+    Layout::write<Mode>(data, settings.mode);
+    Layout::write<Range>(data, settings.range);
+    Layout::write<SamplingWindow>(data, settings.samplingWindow);
+    Layout::write<NumberOfSamples>(data, settings.numberOfSamples);
+    return Layout::size;
+}
+
+/*!
+ * Decodes the `Metadata` \a value into \a metadata.
+ */
+inline bool parseMetadata(const ByteSpan value, Metadata &metadata) noexcept
+{
+    using namespace MetadataLayout;
+    if (value.size() < Layout::size) {
+        return false;
+    }
+    const std::byte * const data = value.data();
+    metadata.status          = Layout::read<Status>(data);
+    metadata.scale           = Layout::read<Scale>(data);
+    metadata.mode            = Layout::read<Mode>(data);
+    metadata.range           = Layout::read<Range>(data);
+    metadata.samplingWindow  = Layout::read<SamplingWindow>(data);
+    metadata.numberOfSamples = Layout::read<NumberOfSamples>(data);
+    metadata.samplingRate    = Layout::read<SamplingRate>(data);
+    return true;
+}
+
+} // namespace Dso
+
+/// Codecs for the Multimeter service's characteristics.
+namespace Multimeter {
+
+/// Attributes of the `Settings` characteristic.
+struct Settings {
+    std::uint8_t mode;            ///< Desired operation mode.
+    std::uint8_t range;           ///< Desired range.
+    std::uint32_t updateInterval; ///< Desired update interval in milliseconds.
+};
+
+/// Attributes of the `Reading` characteristic.
+struct Reading {
+    std::uint8_t status; ///< Current multimeter status.
+    float value;         ///< Last acquired value.
+    std::uint8_t mode;   ///< Current operation mode.
+    std::uint8_t range;  ///< Current range.
+};
+
+/// Layout of the `Settings` characteristic.
+namespace SettingsLayout {
+    using Mode           = CharacteristicLayout::Field<std::uint8_t>;
+    using Range          = CharacteristicLayout::Field<std::uint8_t,  Mode>;
+    using UpdateInterval = CharacteristicLayout::Field<std::uint32_t, Range>;
+    using Layout = CharacteristicLayout::Layout<Mode, Range, UpdateInterval>;
+    static_assert(Layout::size == 6, "Pokit API 1.00 specifies 6 bytes");
+}
+
+/// Layout of the `Reading` characteristic.
+namespace ReadingLayout {
+    using Status = CharacteristicLayout::Field<std::uint8_t>;
+    using Value  = CharacteristicLayout::Field<float,        Status>;
+    using Mode   = CharacteristicLayout::Field<std::uint8_t, Value>;
+    using Range  = CharacteristicLayout::Field<std::uint8_t, Mode>;
+    using Layout = CharacteristicLayout::Layout<Status, Value, Mode, Range>;
+    static_assert(Layout::size == 7, "Pokit API 1.00 specifies 7 bytes");
+}
+
+constexpr std::size_t settingsSize = SettingsLayout::Layout::size; ///< Size of an encoded `Settings` value.
+constexpr std::size_t readingSize  = ReadingLayout::Layout::size;  ///< Size of a `Reading` value.
+
+/*!
+ * Encodes \a settings into \a out, and returns the number of bytes written, or \c 0 if \a out is too small.
+ */
+inline std::size_t encodeSettings(const Settings &settings, const MutableByteSpan out) noexcept
+{
+    using namespace SettingsLayout;
+    if (out.size() < Layout::size) {
+        return 0;
+    }
+    std::byte * const data = out.data();
+    Layout::write<Mode>(data, settings.mode);
+    Layout::write<Range>(data, settings.range);
+    Layout::write<UpdateInterval>(data, settings.updateInterval);
+    return Layout::size;
+}
+
+/*!
+ * Decodes the `Reading` \a value into \a reading.
+ */
+inline bool parseReading(const ByteSpan value, Reading &reading) noexcept
+{
+    using namespace ReadingLayout;
+    if (value.size() < Layout::size) {
+        return false;
+    }
+    const std::byte * const data = value.data();
+    reading.status = Layout::read<Status>(data);
+    reading.value  = Layout::read<Value>(data);
+    reading.mode   = Layout::read<Mode>(data);
+    reading.range  = Layout::read<Range>(data);
+    return true;
+}
+
+} // namespace Multimeter
+
+/// Codecs for the Status service's characteristics.
+namespace Status {
+
+/// Attributes of the `Device Characteristics` characteristic.
+struct DeviceCharacteristics {
+    std::uint8_t firmwareMajor;        ///< Device's major firmware version.
+    std::uint8_t firmwareMinor;        ///< Device's minor firmware version.
+    std::uint16_t maximumVoltage;      ///< Device's maximum input voltage.
+    std::uint16_t maximumCurrent;      ///< Device's maximum input current.
+    std::uint16_t maximumResistance;   ///< Device's maximum input resistance.
+    std::uint16_t maximumSamplingRate; ///< Device's maximum sampling rate.
+    std::uint16_t samplingBufferSize;  ///< Device's sampling buffer size.
+    std::uint16_t capabilityMask;      ///< Reserved.
+    std::uint64_t macAddress;          ///< Device's MAC address, in the lower 48 bits.
+};
+
+/// Attributes of the `Status` characteristic.
+struct Status {
+    std::uint8_t deviceStatus;                  ///< Current Pokit device status.
+    float batteryVoltage;                       ///< Current battery voltage level.
+    std::optional<std::uint8_t> batteryStatus;  ///< Battery status, if provided by the device.
+    std::optional<std::uint8_t> switchPosition; ///< Physical mode switch position, if provided by the device.
+    std::optional<std::uint8_t> chargingStatus; ///< Current charging status, if provided by the device.
+};
+
+/// Layout of the `Device Characteristics` characteristic.
+namespace DeviceCharacteristicsLayout {
+    using FirmwareMajor       = CharacteristicLayout::Field<std::uint8_t>;
+    using FirmwareMinor       = CharacteristicLayout::Field<std::uint8_t,  FirmwareMajor>;
+    using MaximumVoltage      = CharacteristicLayout::Field<std::uint16_t, FirmwareMinor>;
+    using MaximumCurrent      = CharacteristicLayout::Field<std::uint16_t, MaximumVoltage>;
+    using MaximumResistance   = CharacteristicLayout::Field<std::uint16_t, MaximumCurrent>;
+    using MaximumSamplingRate = CharacteristicLayout::Field<std::uint16_t, MaximumResistance>;
+    using SamplingBufferSize  = CharacteristicLayout::Field<std::uint16_t, MaximumSamplingRate>;
+    using CapabilityMask      = CharacteristicLayout::Field<std::uint16_t, SamplingBufferSize>;
+    using MacAddress          = CharacteristicLayout::Bytes<6,             CapabilityMask>; // Big-endian.
+    using Layout = CharacteristicLayout::Layout<FirmwareMajor, FirmwareMinor, MaximumVoltage, MaximumCurrent,
+        MaximumResistance, MaximumSamplingRate, SamplingBufferSize, CapabilityMask, MacAddress>;
+    static_assert(Layout::size == 20, "Pokit API 1.00 specifies 20 bytes");
+}
+
+/// Layout of the `Status` characteristic, including the trailing fields not all devices provide.
+namespace StatusLayout {
+    using DeviceStatus   = CharacteristicLayout::Field<std::uint8_t>;
+    using BatteryVoltage = CharacteristicLayout::Field<float,        DeviceStatus>;
+    using BatteryStatus  = CharacteristicLayout::Field<std::uint8_t, BatteryVoltage>;
+    using SwitchPosition = CharacteristicLayout::Field<std::uint8_t, BatteryStatus>;
+    using ChargingStatus = CharacteristicLayout::Field<std::uint8_t, SwitchPosition>;
+    using Layout = CharacteristicLayout::Layout<DeviceStatus, BatteryVoltage, BatteryStatus, SwitchPosition,
+                                                ChargingStatus>;
+    static_assert(BatteryVoltage::end == 5, "Pokit API 0.02 specifies 5 bytes");
+    static_assert(BatteryStatus::end == 6, "Pokit API 1.00 specifies 6 bytes");
+    static_assert(Layout::size == 8, "Pokit Pro devices provide 8 bytes");
+}
+
+/// Size of a `Device Characteristics` value.
+constexpr std::size_t deviceCharacteristicsSize = DeviceCharacteristicsLayout::Layout::size;
+constexpr std::size_t minimumStatusSize = StatusLayout::BatteryVoltage::end; ///< Minimum size of a `Status` value.
+constexpr std::size_t maximumStatusSize = StatusLayout::Layout::size;        ///< Maximum size of a `Status` value.
+
+/*!
+ * Decodes the `Device Characteristics` \a value into \a characteristics.
+ */
+inline bool parseDeviceCharacteristics(const ByteSpan value, DeviceCharacteristics &characteristics) noexcept
+{
+    using namespace DeviceCharacteristicsLayout;
+    if (value.size() < Layout::size) {
+        return false;
+    }
+    const std::byte * const data = value.data();
+    characteristics.firmwareMajor       = Layout::read<FirmwareMajor>(data);
+    characteristics.firmwareMinor       = Layout::read<FirmwareMinor>(data);
+    characteristics.maximumVoltage      = Layout::read<MaximumVoltage>(data);
+    characteristics.maximumCurrent      = Layout::read<MaximumCurrent>(data);
+    characteristics.maximumResistance   = Layout::read<MaximumResistance>(data);
+    characteristics.maximumSamplingRate = Layout::read<MaximumSamplingRate>(data);
+    characteristics.samplingBufferSize  = Layout::read<SamplingBufferSize>(data);
+    characteristics.capabilityMask      = Layout::read<CapabilityMask>(data);
+    characteristics.macAddress = 0;
+    for (const std::byte * byte = Layout::bytes<MacAddress>(data); byte < data + MacAddress::end; ++byte) {
+        characteristics.macAddress = (characteristics.macAddress << 8) | static_cast<std::uint8_t>(*byte);
+    }
+    return true;
+}
+
+/*!
+ * Decodes the `Status` \a value into \a status. Pokit API 0.02 specifies 5 bytes, API 1.00 added a 6th (`Battery
+ * Status`), and Pokit Pro devices provide 8 bytes (adding the, as yet, undocumented `Switch Position` and `Charging
+ * Status`). Trailing fields that \a value does not include are reset to \c std::nullopt.
+ */
+inline bool parseStatus(const ByteSpan value, Status &status) noexcept
+{
+    using namespace StatusLayout;
+    if (value.size() < BatteryVoltage::end) {
+        return false;
+    }
+    const std::byte * const data = value.data();
+    status.deviceStatus = Layout::read<DeviceStatus>(data);
+    status.batteryVoltage = Layout::read<BatteryVoltage>(data);
+    status.batteryStatus = (Layout::includes<BatteryStatus>(value.size()))
+        ? std::optional<std::uint8_t>(Layout::read<BatteryStatus>(data)) : std::nullopt;
+    status.switchPosition = (Layout::includes<SwitchPosition>(value.size()))
+        ? std::optional<std::uint8_t>(Layout::read<SwitchPosition>(data)) : std::nullopt;
+    status.chargingStatus = (Layout::includes<ChargingStatus>(value.size()))
+        ? std::optional<std::uint8_t>(Layout::read<ChargingStatus>(data)) : std::nullopt;
+    return true;
+}
+
+} // namespace Status
+
+} // namespace PokitCodec
+
+#endif // POKITCODEC_POKITCODEC_H
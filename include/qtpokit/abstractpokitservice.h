@@ -10,10 +10,13 @@
 #define QTPOKIT_ABSTRACTPOKITSERVICE_H
 
 #include "qtpokit_global.h"
+#include "latencyhistogram.h"
 #include "pokitproducts.h"
 
+#include <QFuture>
 #include <QLowEnergyService>
 #include <QObject>
+#include <QVector>
 
 #include <optional>
 
@@ -28,23 +31,77 @@ class QTPOKIT_EXPORT AbstractPokitService : public QObject
     Q_OBJECT
 
 public:
+    /// Number of buckets in Statistics::notificationGaps.
+    static constexpr int notificationGapBuckets { 16 };
+
+    /// Runtime statistics for a Pokit service, accumulated since the service was constructed.
+    struct Statistics {
+        QBluetoothUuid service;        ///< UUID of the service, or null if the service object has not been created yet.
+        quint64 notifications { 0 };   ///< Number of characteristic notifications received.
+        quint64 reads { 0 };           ///< Number of characteristic reads completed.
+        quint64 bytes { 0 };           ///< Number of characteristic value bytes received, by notification or read.
+        quint64 parseFailures { 0 };   ///< Number of received values that were too short, or otherwise malformed.
+        quint64 errors { 0 };          ///< Number of service (ie GATT) errors reported.
+        quint64 stalls { 0 };          ///< Number of notification stalls detected (see StallWatchdog).
+        quint64 stallRecoveries { 0 }; ///< Number of notification stalls recovered from (see StallWatchdog).
+        qint64 memoryBytes { 0 };      ///< Number of bytes currently held by the service's buffers (see MemoryBudget).
+        /// Histogram of the intervals between consecutive notifications. Bucket 0 counts intervals of less than 1ms,
+        /// the last bucket counts intervals of 2^(notificationGapBuckets-2)ms or more, and each bucket `i` in between
+        /// counts intervals of at least 2^(i-1)ms, but less than 2^i ms.
+        QVector<quint64> notificationGaps = QVector<quint64>(notificationGapBuckets, 0);
+        /// Latencies from each sample (or reading) value's receipt (see receiveTimestamp()), to it being parsed.
+        LatencyHistogram parseLatency;
+        /// Latencies from each sample (or reading) value's receipt, to the return of the derived class' signal, so
+        /// including the time taken by any directly connected slots, such as the application's output formatting.
+        LatencyHistogram emitLatency;
+    };
+
+    /// Batching of high-rate notifications into single signal emissions, see setBatching().
+    struct Batching {
+        quint32 maxCount { 0 };   ///< Maximum number of notifications per batch, or 0 for no limit.
+        quint32 maxLatency { 0 }; ///< Maximum time to hold a notification's values, in microseconds, or 0 for no limit.
+    };
+
     AbstractPokitService() = delete;
     virtual ~AbstractPokitService();
 
     virtual bool readCharacteristics() = 0;
+    QFuture<bool> readCharacteristicsAsync();
 
     bool autoDiscover() const;
     void setAutoDiscover(const bool discover = true);
 
+    bool skipValueDiscovery() const;
+    void setSkipValueDiscovery(const bool skip = true);
+
     std::optional<PokitProduct> pokitProduct() const;
     void setPokitProduct(const PokitProduct product);
 
     QLowEnergyService * service();
     const QLowEnergyService * service() const;
 
+    qint64 receiveTimestamp() const;
+    int mtu() const;
+
+    quint64 lastRequestId() const;
+    int pendingRequestCount() const;
+
+    Statistics statistics() const;
+
+    Batching batching() const;
+    void setBatching(const Batching &batching);
+    void flushBatch();
+
+    bool subscribe(const QBluetoothUuid &characteristic);
+    bool unsubscribe(const QBluetoothUuid &characteristic);
+    int subscriberCount(const QBluetoothUuid &characteristic) const;
+
 Q_SIGNALS:
     void serviceDetailsDiscovered();
     void serviceErrorOccurred(QLowEnergyService::ServiceError newError);
+    void valueReceived(const QBluetoothUuid &characteristic, const qint64 timestamp);
+    void requestFinished(const quint64 id, const bool success);
+    void resumed(const qint64 gapStart, const qint64 gapEnd);
 
 protected:
     /// \cond internal
@@ -56,6 +113,10 @@ private:
     Q_DECLARE_PRIVATE(AbstractPokitService)
     Q_DISABLE_COPY(AbstractPokitService)
     QTPOKIT_BEFRIEND_TEST(AbstractPokitService)
+    friend class PokitSimulatorPrivate;
+    friend class StallWatchdogPrivate;
+    friend class TrafficRecorderPrivate;
+    friend class TrafficReplayerPrivate;
 };
 
 QTPOKIT_END_NAMESPACE
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the AsyncLogHandler class.
+ */
+
+#ifndef QTPOKIT_ASYNCLOGHANDLER_H
+#define QTPOKIT_ASYNCLOGHANDLER_H
+
+#include "qtpokit_global.h"
+
+#include <QCoreApplication>
+#include <QString>
+
+#include <cstdio>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT AsyncLogHandler
+{
+    Q_DECLARE_TR_FUNCTIONS(AsyncLogHandler)
+
+public:
+    static constexpr quint32 defaultCapacity { 4096 }; ///< Default maximum number of messages queued at once.
+
+    /// Settings for install().
+    struct Settings {
+        quint32 capacity { defaultCapacity }; ///< Maximum messages queued at once, beyond which new ones are dropped.
+        quint32 rateLimit { 0 };              ///< Maximum messages per second, per logging category, or 0 for none.
+        bool prefixContext { false };         ///< Whether to prefix messages with the time, and thread, logged from.
+        FILE * stream { nullptr };            ///< Stream to write messages to, or \c nullptr for stderr.
+    };
+
+    /// Counts of the messages handled since install().
+    struct Statistics {
+        quint64 queued { 0 };     ///< Messages queued for the background thread.
+        quint64 written { 0 };    ///< Messages written by the background thread.
+        quint64 dropped { 0 };    ///< Messages dropped, because the queue was full.
+        quint64 suppressed { 0 }; ///< Messages suppressed by the Settings::rateLimit.
+    };
+
+    static bool install(const Settings &settings);
+    static bool isInstalled();
+    static void flush();
+    static Statistics statistics();
+    static bool uninstall();
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_ASYNCLOGHANDLER_H
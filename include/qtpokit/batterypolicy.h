@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the BatteryPolicy class.
+ */
+
+#ifndef QTPOKIT_BATTERYPOLICY_H
+#define QTPOKIT_BATTERYPOLICY_H
+
+#include "pokitdevice.h"
+#include "statusservice.h"
+
+#include <QObject>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class BatteryPolicyPrivate;
+
+class QTPOKIT_EXPORT BatteryPolicy : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Battery budget levels, in order of increasing conservation.
+    enum class Level : quint8 {
+        Normal,   ///< The battery is healthy (or charging), so measure at the requested rate.
+        Conserve, ///< The battery is running low, so measure less often, over a lower power connection.
+        Critical, ///< The battery is nearly exhausted, so measure at the minimum acceptable rate.
+    };
+    static QString toString(const Level level);
+
+    /// Measurement parameters recommended for the current battery budget.
+    struct Decision {
+        Level level { Level::Normal }; ///< Battery budget level the decision was made for.
+        quint32 updateInterval { 0 };  ///< Recommended interval between readings, in milliseconds.
+        PokitDevice::ConnectionProfile connectionProfile { PokitDevice::ConnectionProfile::Default }; ///< Profile.
+        bool preferLogging { false };  ///< Whether to switch from live readings to on-device logging, if possible.
+    };
+
+    explicit BatteryPolicy(StatusService * const service, QObject * parent = nullptr);
+    virtual ~BatteryPolicy();
+
+    StatusService * service() const;
+
+    quint32 baseInterval() const;
+    void setBaseInterval(const quint32 interval);
+
+    quint32 maximumInterval() const;
+    void setMaximumInterval(const quint32 interval);
+
+    float conserveFactor() const;
+    void setConserveFactor(const float factor);
+
+    float conserveVoltage() const;
+    void setConserveVoltage(const float voltage);
+
+    float criticalVoltage() const;
+    void setCriticalVoltage(const float voltage);
+
+    float hysteresis() const;
+    void setHysteresis(const float hysteresis);
+
+    std::optional<StatusService::Status> lastStatus() const;
+    Level level() const;
+    Decision decision() const;
+
+public Q_SLOTS:
+    void addStatus(const StatusService::Status &status);
+    void reset();
+
+Q_SIGNALS:
+    void decisionChanged(const BatteryPolicy::Decision &decision);
+
+protected:
+    /// \cond internal
+    BatteryPolicyPrivate * d_ptr; ///< Internal d-pointer.
+    BatteryPolicy(BatteryPolicyPrivate * const d, StatusService * const service, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(BatteryPolicy)
+    Q_DISABLE_COPY(BatteryPolicy)
+    QTPOKIT_BEFRIEND_TEST(BatteryPolicy)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_BATTERYPOLICY_H
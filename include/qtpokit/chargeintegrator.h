@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the ChargeIntegrator class.
+ */
+
+#ifndef QTPOKIT_CHARGEINTEGRATOR_H
+#define QTPOKIT_CHARGEINTEGRATOR_H
+
+#include "qtpokit_global.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class ChargeIntegratorPrivate;
+
+class QTPOKIT_EXPORT ChargeIntegrator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// How to integrate across gaps between samples (ie intervals longer than maximumGap()).
+    enum class GapPolicy : quint8 {
+        Exclude     = 0, ///< Exclude gaps from the integrated charge, and duration.
+        Hold        = 1, ///< Hold the value before each gap across the gap (ie zero-order hold).
+        Interpolate = 2, ///< Interpolate linearly across each gap, as if it were an ordinary interval.
+    };
+
+    /// Running totals, from the first sample (since construction, or the last reset()) to the latest.
+    struct Total {
+        qint64 start;          ///< Time of the first sample, in milliseconds since the epoch.
+        qint64 end;            ///< Time of the latest sample, in milliseconds since the epoch.
+        quint64 count;         ///< Number of samples integrated.
+        double charge;         ///< Charge integrated so far, in amp-hours.
+        double averageCurrent; ///< Average current over the integrated #duration, in amps.
+        qint64 duration;       ///< Time integrated, in milliseconds (including bridged, but not excluded, gaps).
+        quint64 gaps;          ///< Number of gaps.
+        qint64 gapDuration;    ///< Total length of the gaps, in milliseconds, whether bridged, or excluded.
+    };
+
+    explicit ChargeIntegrator(QObject * parent = nullptr);
+    virtual ~ChargeIntegrator();
+
+    quint32 period() const;
+    void setPeriod(const quint32 period);
+
+    quint32 maximumGap() const;
+    void setMaximumGap(const quint32 gap);
+
+    GapPolicy gapPolicy() const;
+    void setGapPolicy(const GapPolicy policy);
+
+    bool hasTotal() const;
+    Total total() const;
+
+public Q_SLOTS:
+    void addSample(const float amps, const qint64 timestamp);
+    void flush();
+    void reset();
+
+Q_SIGNALS:
+    void totalReady(const ChargeIntegrator::Total &total);
+
+protected:
+    /// \cond internal
+    ChargeIntegratorPrivate * d_ptr; ///< Internal d-pointer.
+    ChargeIntegrator(ChargeIntegratorPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(ChargeIntegrator)
+    Q_DISABLE_COPY(ChargeIntegrator)
+    QTPOKIT_BEFRIEND_TEST(ChargeIntegrator)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_CHARGEINTEGRATOR_H
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the ClockAligner class.
+ */
+
+#ifndef QTPOKIT_CLOCKALIGNER_H
+#define QTPOKIT_CLOCKALIGNER_H
+
+#include "dataloggerservice.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class ClockAlignerPrivate;
+
+class QTPOKIT_EXPORT ClockAligner : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Estimated relationship between a device's clock, and the host's steady clock.
+    struct Estimate {
+        qint64 offset { 0 };    ///< Host time minus device time, in milliseconds, as of the latest observation.
+        double drift { 0.0 };   ///< Parts per million by which the device's clock runs slow (or fast, if negative).
+        int observations { 0 }; ///< Number of observations the estimate is based on, or 0 if none.
+    };
+
+    explicit ClockAligner(QObject * parent = nullptr);
+    virtual ~ClockAligner();
+
+    int window() const;
+    void setWindow(const int observations);
+
+    double maximumDrift() const;
+    void setMaximumDrift(const double drift);
+
+    QStringList devices() const;
+    bool contains(const QString &device) const;
+    Estimate estimate(const QString &device) const;
+
+    qint64 toHostTime(const QString &device, const qint64 deviceTime) const;
+
+    static qint64 hostTime();
+    static qint64 loggerSampleTime(const DataLoggerService::Metadata &metadata, const int index);
+    static QVector<float> resample(const QVector<qint64> &times, const QVector<float> &values, const qint64 start,
+                                   const quint32 step, const int count);
+
+public Q_SLOTS:
+    void addObservation(const QString &device, const qint64 deviceTime, const qint64 hostTime);
+    void addObservation(const QString &device, const qint64 deviceTime);
+    void remove(const QString &device);
+    void clear();
+
+protected:
+    /// \cond internal
+    ClockAlignerPrivate * d_ptr; ///< Internal d-pointer.
+    ClockAligner(ClockAlignerPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(ClockAligner)
+    Q_DISABLE_COPY(ClockAligner)
+    QTPOKIT_BEFRIEND_TEST(ClockAligner)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_CLOCKALIGNER_H
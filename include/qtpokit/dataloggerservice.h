@@ -10,6 +10,7 @@
 #define QTPOKIT_DATALOGGERSERVICE_H
 
 #include "abstractpokitservice.h"
+#include "ringbuffer.h"
 
 #include <QBluetoothAddress>
 #include <QBluetoothUuid>
@@ -92,6 +93,7 @@ public:
     };
 
     typedef QVector<qint16> Samples;
+    typedef QVector<float> ScaledSamples;
 
     DataLoggerService(QLowEnergyController * const pokitDevice, QObject * parent = nullptr);
     ~DataLoggerService() = default;
@@ -101,23 +103,39 @@ public:
 
     // Settings characteristic (BLE write only).
     bool setSettings(const Settings &settings);
+    QFuture<bool> setSettingsAsync(const Settings &settings);
     bool startLogger(const Settings &settings);
+    QFuture<bool> startLoggerAsync(const Settings &settings);
     bool stopLogger();
+    QFuture<bool> stopLoggerAsync();
     bool fetchSamples();
+    QFuture<bool> fetchSamplesAsync();
+    std::optional<bool> updateIntervalIs32bit() const;
+    void setUpdateIntervalIs32bit(const bool is32bit);
 
     // Metadata characteristic (BLE read/notify).
     Metadata metadata() const;
     bool enableMetadataNotifications();
+    QFuture<bool> enableMetadataNotificationsAsync();
     bool disableMetadataNotifications();
+    QFuture<bool> disableMetadataNotificationsAsync();
 
     // Reading characteristic (BLE notify only).
     bool enableReadingNotifications();
+    QFuture<bool> enableReadingNotificationsAsync();
     bool disableReadingNotifications();
+    QFuture<bool> disableReadingNotificationsAsync();
+
+    RingBuffer<Samples> * samplesBuffer() const;
+    void setSamplesBuffer(RingBuffer<Samples> * const buffer);
 
 Q_SIGNALS:
     void settingsWritten();
     void metadataRead(const DataLoggerService::Metadata &meta);
     void samplesRead(const DataLoggerService::Samples &samples);
+    void rawSamplesRead(const QByteArray &samples);
+    void scaledSamplesRead(const DataLoggerService::ScaledSamples &samples);
+    void samplesBatchRead(const QVector<DataLoggerService::Samples> &batch);
 
 protected:
     /// \cond internal
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the Decimation namespace.
+ */
+
+#ifndef QTPOKIT_DECIMATION_H
+#define QTPOKIT_DECIMATION_H
+
+#include "dataloggerservice.h"
+#include "dsoservice.h"
+
+#include <QPointF>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// Reduces long sample series to a bounded number of points, suitable for charting.
+namespace Decimation {
+
+    QTPOKIT_EXPORT QVector<QPointF> minMax(const QVector<QPointF> &points, const qsizetype buckets);
+    QTPOKIT_EXPORT QVector<QPointF> minMax(const DsoService::Metadata &metadata,
+                                           const DsoService::Samples &samples, const qsizetype buckets);
+    QTPOKIT_EXPORT QVector<QPointF> minMax(const DataLoggerService::Metadata &metadata,
+                                           const DataLoggerService::Samples &samples, const qsizetype buckets);
+
+    QTPOKIT_EXPORT QVector<QPointF> largestTriangleThreeBuckets(const QVector<QPointF> &points,
+                                                                const qsizetype threshold);
+    QTPOKIT_EXPORT QVector<QPointF> largestTriangleThreeBuckets(const DsoService::Metadata &metadata,
+                                                                const DsoService::Samples &samples,
+                                                                const qsizetype threshold);
+    QTPOKIT_EXPORT QVector<QPointF> largestTriangleThreeBuckets(const DataLoggerService::Metadata &metadata,
+                                                                const DataLoggerService::Samples &samples,
+                                                                const qsizetype threshold);
+
+}
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_DECIMATION_H
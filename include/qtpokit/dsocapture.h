@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the DsoCapture class.
+ */
+
+#ifndef QTPOKIT_DSOCAPTURE_H
+#define QTPOKIT_DSOCAPTURE_H
+
+#include "dsoservice.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class DsoCapturePrivate;
+
+class QTPOKIT_EXPORT DsoCapture : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Default number of milliseconds, without any new samples, before a capture is considered incomplete.
+    static constexpr int defaultCompletionTimeout { 2000 };
+    /// Default number of times an incomplete capture is re-requested, before it is abandoned.
+    static constexpr int defaultMaxResends { 3 };
+
+    explicit DsoCapture(DsoService * const service, QObject * parent = nullptr);
+    virtual ~DsoCapture();
+
+    DsoService * service() const;
+
+    DsoService::Metadata metadata() const;
+    DsoService::Samples samples() const;
+    qsizetype samplesReceived() const;
+    bool isComplete() const;
+    quint64 sequenceNumber() const;
+
+    bool isContinuous() const;
+    bool startContinuous(const DsoService::Settings &settings);
+    void stopContinuous();
+
+    int completionTimeout() const;
+    void setCompletionTimeout(const int msecs);
+    int maxResends() const;
+    void setMaxResends(const int count);
+
+public Q_SLOTS:
+    void reset();
+
+Q_SIGNALS:
+    void captureComplete(const DsoService::Metadata &metadata, const DsoService::Samples &samples,
+                         const quint64 sequenceNumber);
+    void captureFailed(const DsoService::Metadata &metadata, const qsizetype samplesReceived);
+
+protected:
+    /// \cond internal
+    DsoCapturePrivate * d_ptr; ///< Internal d-pointer.
+    DsoCapture(DsoCapturePrivate * const d, DsoService * const service, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(DsoCapture)
+    Q_DISABLE_COPY(DsoCapture)
+    QTPOKIT_BEFRIEND_TEST(DsoCapture)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_DSOCAPTURE_H
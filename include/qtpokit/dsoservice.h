@@ -10,6 +10,7 @@
 #define QTPOKIT_DSOSERVICE_H
 
 #include "abstractpokitservice.h"
+#include "ringbuffer.h"
 #include "pokitproducts.h"
 
 #include <QBluetoothAddress>
@@ -92,6 +93,7 @@ public:
     };
 
     typedef QVector<qint16> Samples;
+    typedef QVector<float> ScaledSamples;
 
     DsoService(QLowEnergyController * const pokitDevice, QObject * parent = nullptr);
     ~DsoService() = default;
@@ -101,22 +103,35 @@ public:
 
     // Settings characteristic (BLE write only).
     bool setSettings(const Settings &settings);
+    QFuture<bool> setSettingsAsync(const Settings &settings);
     bool startDso(const Settings &settings);
+    QFuture<bool> startDsoAsync(const Settings &settings);
     bool fetchSamples();
+    QFuture<bool> fetchSamplesAsync();
 
     // Metadata characteristic (BLE read/notify).
     Metadata metadata() const;
     bool enableMetadataNotifications();
+    QFuture<bool> enableMetadataNotificationsAsync();
     bool disableMetadataNotifications();
+    QFuture<bool> disableMetadataNotificationsAsync();
 
     // Reading characteristic (BLE notify only).
     bool enableReadingNotifications();
+    QFuture<bool> enableReadingNotificationsAsync();
     bool disableReadingNotifications();
+    QFuture<bool> disableReadingNotificationsAsync();
+
+    RingBuffer<Samples> * samplesBuffer() const;
+    void setSamplesBuffer(RingBuffer<Samples> * const buffer);
 
 Q_SIGNALS:
     void settingsWritten();
     void metadataRead(const DsoService::Metadata &meta);
     void samplesRead(const DsoService::Samples &samples);
+    void rawSamplesRead(const QByteArray &samples);
+    void scaledSamplesRead(const DsoService::ScaledSamples &samples);
+    void samplesBatchRead(const QVector<DsoService::Samples> &batch);
 
 protected:
     /// \cond internal
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the DsoSpectrum class.
+ */
+
+#ifndef QTPOKIT_DSOSPECTRUM_H
+#define QTPOKIT_DSOSPECTRUM_H
+
+#include "dsoservice.h"
+
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class DsoCapture;
+class DsoSpectrumPrivate;
+
+class QTPOKIT_EXPORT DsoSpectrum : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Single-sided amplitude spectrum of a DSO capture.
+    struct Spectrum {
+        float resolution;          ///< Width of each frequency bin, in Hz.
+        QVector<float> magnitudes; ///< Amplitude of each bin (from DC upwards), in the capture's (scaled) units.
+    };
+
+    explicit DsoSpectrum(DsoCapture * const capture, QObject * parent = nullptr);
+    virtual ~DsoSpectrum();
+
+    DsoCapture * capture() const;
+
+    Spectrum analyse(const DsoService::Metadata &metadata, const DsoService::Samples &samples);
+
+Q_SIGNALS:
+    void spectrumReady(const DsoSpectrum::Spectrum &spectrum, const quint64 sequenceNumber);
+
+protected:
+    /// \cond internal
+    DsoSpectrumPrivate * d_ptr; ///< Internal d-pointer.
+    DsoSpectrum(DsoSpectrumPrivate * const d, DsoCapture * const capture, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(DsoSpectrum)
+    Q_DISABLE_COPY(DsoSpectrum)
+    QTPOKIT_BEFRIEND_TEST(DsoSpectrum)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_DSOSPECTRUM_H
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the DsoStatistics class.
+ */
+
+#ifndef QTPOKIT_DSOSTATISTICS_H
+#define QTPOKIT_DSOSTATISTICS_H
+
+#include "dsoservice.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class DsoStatisticsPrivate;
+
+class QTPOKIT_EXPORT DsoStatistics : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Summary statistics for a single DSO capture, in the capture's (scaled) units.
+    struct Summary {
+        quint64 count;           ///< Number of samples summarised.
+        float minimum;           ///< Minimum sample value.
+        float maximum;           ///< Maximum sample value.
+        float peakToPeak;        ///< Difference between #maximum and #minimum.
+        float mean;              ///< Arithmetic mean, ie the DC offset.
+        float rms;               ///< Root mean square (ie DC-coupled RMS).
+        float standardDeviation; ///< Population standard deviation (ie AC-coupled RMS).
+        float frequency;         ///< Estimated fundamental frequency in Hz, or NaN if not estimable.
+    };
+
+    explicit DsoStatistics(DsoService * const service, QObject * parent = nullptr);
+    virtual ~DsoStatistics();
+
+    DsoService * service() const;
+    DsoService::Metadata metadata() const;
+    Summary summary() const;
+
+    static Summary summarise(const DsoService::Metadata &metadata, const DsoService::Samples &samples);
+
+public Q_SLOTS:
+    void reset();
+
+Q_SIGNALS:
+    void summaryReady(const DsoStatistics::Summary &summary);
+
+protected:
+    /// \cond internal
+    DsoStatisticsPrivate * d_ptr; ///< Internal d-pointer.
+    DsoStatistics(DsoStatisticsPrivate * const d, DsoService * const service, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(DsoStatistics)
+    Q_DISABLE_COPY(DsoStatistics)
+    QTPOKIT_BEFRIEND_TEST(DsoStatistics)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_DSOSTATISTICS_H
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the EventDetector class.
+ */
+
+#ifndef QTPOKIT_EVENTDETECTOR_H
+#define QTPOKIT_EVENTDETECTOR_H
+
+#include "dataloggerservice.h"
+#include "multimeterservice.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class EventDetectorPrivate;
+
+class QTPOKIT_EXPORT EventDetector : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Quantities that may be compared with the threshold.
+    enum class Quantity : quint8 {
+        Value        = 0, ///< Each value, in its own units (such as volts).
+        RateOfChange = 1, ///< The rate of change between consecutive values, in their units per second.
+    };
+
+    /// Directions, beyond the threshold, that constitute an event.
+    enum class Direction : quint8 {
+        Above = 0, ///< The quantity is at, or above, the threshold.
+        Below = 1, ///< The quantity is at, or below, the threshold.
+    };
+
+    /// Attributes of an event detector.
+    struct Settings {
+        Quantity quantity;   ///< Quantity to compare with the threshold.
+        Direction direction; ///< Direction, beyond the threshold, that constitutes an event.
+        float threshold;     ///< Threshold, in the quantity's units.
+        float hysteresis;    ///< How far the quantity must return past the threshold, to end an event.
+        quint32 minDuration; ///< Minimum duration, in milliseconds, for an event to be reported.
+    };
+
+    /// A detected event.
+    struct Event {
+        qint64 start;  ///< Timestamp of the event's first value, in milliseconds since the epoch.
+        qint64 end;    ///< Timestamp of the event's last value, in milliseconds since the epoch.
+        float peak;    ///< Most extreme quantity reached during the event (such as the maximum value, if Above).
+        quint64 count; ///< Number of values within the event.
+    };
+
+    explicit EventDetector(QObject * parent = nullptr);
+    explicit EventDetector(MultimeterService * const service, QObject * parent = nullptr);
+    explicit EventDetector(DataLoggerService * const service, QObject * parent = nullptr);
+    virtual ~EventDetector();
+
+    AbstractPokitService * service() const;
+
+    Settings settings() const;
+    void setSettings(const Settings &settings);
+
+    bool isActive() const;
+    quint64 eventCount() const;
+
+    static Settings defaultSettings();
+    static bool isValid(const Settings &settings);
+
+public Q_SLOTS:
+    void addValue(const float value, const qint64 timestamp);
+    void flush();
+    void reset();
+
+Q_SIGNALS:
+    void eventStarted(const EventDetector::Event &event);
+    void eventFinished(const EventDetector::Event &event);
+
+protected:
+    /// \cond internal
+    EventDetectorPrivate * d_ptr; ///< Internal d-pointer.
+    EventDetector(EventDetectorPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(EventDetector)
+    Q_DISABLE_COPY(EventDetector)
+    QTPOKIT_BEFRIEND_TEST(EventDetector)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_EVENTDETECTOR_H
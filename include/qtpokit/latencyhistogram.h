@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the LatencyHistogram class.
+ */
+
+#ifndef QTPOKIT_LATENCYHISTOGRAM_H
+#define QTPOKIT_LATENCYHISTOGRAM_H
+
+#include "qtpokit_global.h"
+
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT LatencyHistogram
+{
+public:
+    /// Number of bits of each recorded value's precision; that is, values are recorded to within 1/2^subBucketBits.
+    static constexpr int subBucketBits { 5 };
+    /// Number of sub-buckets per power of two (beyond the first two powers of two, which are recorded exactly).
+    static constexpr int subBucketCount { 1 << subBucketBits };
+    /// Number of bits of the largest recordable value, in nanoseconds (ie about 18 minutes); larger values are clamped.
+    static constexpr int maxValueBits { 40 };
+    /// Total number of buckets.
+    static constexpr int bucketCount { subBucketCount * (maxValueBits - subBucketBits + 1) };
+
+    void record(const qint64 nanoseconds);
+    void merge(const LatencyHistogram &other);
+    void reset();
+
+    bool isEmpty() const;
+    quint64 count() const;
+    qint64 minimum() const;
+    qint64 maximum() const;
+    double mean() const;
+    qint64 percentile(const double percent) const;
+
+    static int bucketIndex(const qint64 nanoseconds);
+    static qint64 bucketValue(const int index);
+
+private:
+    QVector<quint64> counts; ///< Count of values recorded per bucket, or empty if none yet.
+    quint64 total { 0 };     ///< Number of values recorded.
+    qint64 min { 0 };        ///< Smallest value recorded, if any.
+    qint64 max { 0 };        ///< Largest value recorded, if any.
+    double sum { 0.0 };      ///< Sum of all values recorded.
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_LATENCYHISTOGRAM_H
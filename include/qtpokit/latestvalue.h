@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares and defines the LatestValue class template.
+ */
+
+#ifndef QTPOKIT_LATESTVALUE_H
+#define QTPOKIT_LATESTVALUE_H
+
+#include "qtpokit_global.h"
+
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class LatestValue
+ *
+ * The LatestValue class template holds the most recent \a T value published by a single writer thread, such that any
+ * number of reader threads can load it, at any rate, without locks, and without ever seeing a partially-written value.
+ *
+ * This allows the thread that owns a Pokit service's QLowEnergyController (the single writer) to publish each parsed
+ * reading or metadata (see MultimeterService::reading(), DsoService::metadata() and DataLoggerService::metadata()),
+ * for control loops on other threads to poll, without touching the controller thread's objects.
+ *
+ * The value is guarded by a sequence lock (seqlock): the writer makes the sequence number odd while storing, then even
+ * again once done, and readers retry any load that overlapped a store. The value itself is held in relaxed atomic
+ * words, rather than as a plain \a T, so that overlapping loads and stores are still well-defined. So \a T must be
+ * trivially copyable, which is the case for all of the services' reading and metadata structs.
+ *
+ * Stores never wait for readers, and readers only retry while a store is actually in progress, which (for the small
+ * structs held here) is a handful of instructions.
+ */
+template<typename T>
+class LatestValue
+{
+    static_assert(std::is_trivially_copyable_v<T>, "LatestValue requires trivially copyable types");
+    static_assert(std::is_default_constructible_v<T>, "LatestValue requires default constructible types");
+
+public:
+    /*!
+     * Constructs a new latest value cell, holding \a initial, until the first store().
+     */
+    explicit LatestValue(const T &initial = T{})
+    {
+        Words source {};
+        std::memcpy(source.data(), &initial, sizeof(T));
+        for (std::size_t index = 0; index < wordCount; ++index) {
+            words[index].store(source[index], std::memory_order_relaxed);
+        }
+    }
+
+    /*!
+     * Returns the number of values stored since construction. Readers can compare this before, and after, polling
+     * load() to tell whether a new value has arrived.
+     */
+    quint64 storeCount() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+    /*!
+     * Returns the most recently stored value (or the initial value, if none has been stored yet). Safe to call from
+     * any thread, concurrently with store().
+     */
+    T load() const
+    {
+        Words loaded;
+        for (;;) {
+            const quint64 before = sequence.load(std::memory_order_acquire);
+            if ((before % 2) != 0) {
+                continue; // A store is in progress.
+            }
+            for (std::size_t index = 0; index < wordCount; ++index) {
+                loaded[index] = words[index].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                break; // No store overlapped this load.
+            }
+        }
+        T value {};
+        std::memcpy(&value, loaded.data(), sizeof(T));
+        return value;
+    }
+
+    /*!
+     * Stores \a value, replacing the previous value for all subsequent load() calls. Must only be called by the
+     * (single) writer thread.
+     */
+    void store(const T &value)
+    {
+        Words source {};
+        std::memcpy(source.data(), &value, sizeof(T));
+        const quint64 before = sequence.load(std::memory_order_relaxed);
+        sequence.store(before + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t index = 0; index < wordCount; ++index) {
+            words[index].store(source[index], std::memory_order_relaxed);
+        }
+        sequence.store(before + 2, std::memory_order_release);
+    }
+
+private:
+    static constexpr std::size_t wordCount = (sizeof(T) + sizeof(quint64) - 1) / sizeof(quint64); ///< Words per T.
+    using Words = std::array<quint64, wordCount>; ///< Plain (non-atomic) copy of a value's words.
+
+    std::atomic<quint64> sequence { 0 };                ///< Number of stores begun and completed (odd while storing).
+    std::array<std::atomic<quint64>, wordCount> words;  ///< The value, as relaxed atomic words.
+
+    Q_DISABLE_COPY(LatestValue)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_LATESTVALUE_H
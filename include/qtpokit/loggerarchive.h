@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the LoggerArchive class.
+ */
+
+#ifndef QTPOKIT_LOGGERARCHIVE_H
+#define QTPOKIT_LOGGERARCHIVE_H
+
+#include "dataloggerservice.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class LoggerArchivePrivate;
+
+class QTPOKIT_EXPORT LoggerArchive : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// A contiguous run of samples from a single Data Logger session, as stored in an archive.
+    struct Session {
+        DataLoggerService::Metadata metadata; ///< Session metadata, with `numberOfSamples` archived.
+        quint32 firstSample;    ///< Index of the first archived sample, within the logging session.
+        quint64 firstTimestamp; ///< Timestamp of the first archived sample, in milliseconds since the epoch.
+        quint64 lastTimestamp;  ///< Timestamp of the last archived sample, in milliseconds since the epoch.
+    };
+
+    /// Summary statistics of a range of archived samples, as scaled values.
+    struct Aggregate {
+        quint64 count { 0 };          ///< Number of samples aggregated.
+        float minimum { 0.0f };       ///< Minimum sample value.
+        float maximum { 0.0f };       ///< Maximum sample value.
+        double sum { 0.0 };           ///< Sum of sample values, such that the mean is `sum / count`.
+        quint64 firstTimestamp { 0 }; ///< Timestamp of the first sample aggregated, in milliseconds since the epoch.
+        quint64 lastTimestamp { 0 };  ///< Timestamp of the last sample aggregated, in milliseconds since the epoch.
+    };
+
+    /// Aggregate of the archived samples within a single, fixed-width, period of time.
+    struct Bucket {
+        quint64 start;       ///< Start of the bucket, in milliseconds since the epoch, as a multiple of its width.
+        Aggregate aggregate; ///< Aggregate of the bucket's samples.
+    };
+
+    explicit LoggerArchive(const QString &fileName, QObject * parent = nullptr);
+    virtual ~LoggerArchive();
+
+    QString fileName() const;
+
+    bool compressSamples() const;
+    void setCompressSamples(const bool compress);
+
+    bool open();
+    bool isOpen() const;
+    void close();
+
+    qsizetype sessionCount() const;
+    Session session(const qsizetype index) const;
+    qsizetype findSession(const quint64 timestamp) const;
+    QVector<qsizetype> findSessions(const quint64 from, const quint64 to) const;
+
+    DataLoggerService::Samples samples(const qsizetype index) const;
+    DataLoggerService::Samples samples(const qsizetype index, const quint64 from, const quint64 to) const;
+
+    Aggregate aggregate(const qsizetype index, const quint64 from, const quint64 to) const;
+    QVector<Bucket> downsample(const qsizetype index, const quint64 from, const quint64 to,
+                               const quint64 width) const;
+    static void merge(Aggregate &aggregate, const Aggregate &other);
+
+    bool append(const DataLoggerService::Metadata &metadata, const DataLoggerService::Samples &samples,
+                const quint32 firstSample = 0);
+
+    static bool compact(const QStringList &sources, const QString &destination, const bool compress = false);
+
+protected:
+    /// \cond internal
+    LoggerArchivePrivate * d_ptr; ///< Internal d-pointer.
+    LoggerArchive(LoggerArchivePrivate * const d, const QString &fileName, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(LoggerArchive)
+    Q_DISABLE_COPY(LoggerArchive)
+    QTPOKIT_BEFRIEND_TEST(LoggerArchive)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_LOGGERARCHIVE_H
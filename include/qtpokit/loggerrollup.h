@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the LoggerRollup class.
+ */
+
+#ifndef QTPOKIT_LOGGERROLLUP_H
+#define QTPOKIT_LOGGERROLLUP_H
+
+#include "loggerarchive.h"
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class LoggerRollupPrivate;
+
+class QTPOKIT_EXPORT LoggerRollup : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LoggerRollup(const QString &fileName, QObject * parent = nullptr);
+    virtual ~LoggerRollup();
+
+    QString fileName() const;
+    static QString fileNameFor(const QString &archiveFileName);
+    static QVector<quint64> defaultTiers();
+
+    bool build(const LoggerArchive &archive, const QVector<quint64> &tiers = defaultTiers());
+
+    bool open(const LoggerArchive &archive);
+    bool isOpen() const;
+    void close();
+
+    QVector<quint64> tiers(const DataLoggerService::Mode mode) const;
+    QVector<LoggerArchive::Bucket> buckets(const DataLoggerService::Mode mode, const quint64 width,
+                                           const quint64 from, const quint64 to) const;
+
+protected:
+    /// \cond internal
+    LoggerRollupPrivate * d_ptr; ///< Internal d-pointer.
+    LoggerRollup(LoggerRollupPrivate * const d, const QString &fileName, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(LoggerRollup)
+    Q_DISABLE_COPY(LoggerRollup)
+    QTPOKIT_BEFRIEND_TEST(LoggerRollup)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_LOGGERROLLUP_H
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MemoryBudget class.
+ */
+
+#ifndef QTPOKIT_MEMORYBUDGET_H
+#define QTPOKIT_MEMORYBUDGET_H
+
+#include "qtpokit_global.h"
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT MemoryBudget
+{
+public:
+    /// Kinds of buffers accounted for by a memory budget.
+    enum class Kind : quint8 {
+        RingBuffer, ///< Fixed-capacity RingBuffer of readings, or samples.
+        SamplePool, ///< SamplePool of reusable notification buffers.
+        Capture,    ///< DsoCapture buffers.
+        Output,     ///< Output queued for writing, such as by a writer thread.
+        Spill,      ///< Messages held for a network sink, while it is disconnected, or behind.
+    };
+    static QString toString(const Kind kind);
+
+    /// Memory usage of a single stream (that is, a single buffer).
+    struct Usage {
+        QString name;                   ///< Name of the stream, such as "dso.samples".
+        Kind kind { Kind::RingBuffer }; ///< Kind of buffer.
+        qint64 bytes { 0 };             ///< Number of bytes currently held.
+        qint64 peak { 0 };              ///< Largest number of bytes held at any one time.
+        qint64 quota { 0 };             ///< Stream's effective quota, in bytes, or 0 for no quota.
+        quint64 refusals { 0 };         ///< Number of times the stream's quota (or the budget's limit) was reached.
+    };
+
+    /// Memory usage of all streams accounted for by a budget.
+    struct Statistics {
+        qint64 limit { 0 };         ///< Budget's limit, in bytes, or 0 for no limit.
+        qint64 bytes { 0 };         ///< Number of bytes currently held by all streams.
+        qint64 peak { 0 };          ///< Largest number of bytes held by all streams at any one time.
+        quint64 refusals { 0 };     ///< Number of times any stream's quota (or the budget's limit) was reached.
+        QVector<Usage> streams;     ///< Usage of each stream, in order of creation.
+    };
+
+    class QTPOKIT_EXPORT Stream
+    {
+    public:
+        Stream(const QString &name, const Kind kind, MemoryBudget * const budget = MemoryBudget::global());
+        ~Stream();
+
+        QString name() const;
+        Kind kind() const;
+        qint64 quota() const;
+        void setQuota(const qint64 bytes);
+
+        bool fits(const qint64 bytes) const;
+        bool reserve(const qint64 bytes);
+        void charge(const qint64 bytes);
+        void release(const qint64 bytes);
+        void countRefusal();
+
+        qint64 bytes() const;
+        Usage usage() const;
+
+    private:
+        MemoryBudget * const budget; ///< Budget this stream is accounted against.
+        Usage current;               ///< This stream's usage, guarded by the budget's mutex.
+        qint64 streamQuota { -1 };   ///< Quota set via setQuota(), or -1 for the budget's default quota.
+
+        qint64 effectiveQuota() const;
+
+        friend class MemoryBudget;
+        Q_DISABLE_COPY(Stream)
+    };
+
+    MemoryBudget();
+
+    static MemoryBudget * global();
+
+    qint64 limit() const;
+    void setLimit(const qint64 bytes);
+    qint64 defaultQuota() const;
+    void setDefaultQuota(const qint64 bytes);
+
+    qint64 bytes() const;
+    Statistics statistics() const;
+
+private:
+    mutable QMutex mutex;      ///< Guards everything below, and every stream's usage.
+    qint64 maxBytes { 0 };     ///< Budget's limit, in bytes, or 0 for no limit.
+    qint64 streamQuota { 0 };  ///< Default quota for each stream, in bytes, or 0 for no quota.
+    qint64 used { 0 };         ///< Number of bytes currently held by all streams.
+    qint64 peak { 0 };         ///< Largest value #used has had.
+    quint64 refusals { 0 };    ///< Number of refusals, across all streams.
+    QList<Stream *> streams;   ///< Streams currently accounted against this budget.
+
+    Q_DISABLE_COPY(MemoryBudget)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_MEMORYBUDGET_H
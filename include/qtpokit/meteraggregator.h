@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterAggregator class.
+ */
+
+#ifndef QTPOKIT_METERAGGREGATOR_H
+#define QTPOKIT_METERAGGREGATOR_H
+
+#include "multimeterservice.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class MeterAggregatorPrivate;
+
+class QTPOKIT_EXPORT MeterAggregator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Aggregate of the multimeter readings within a single time window.
+    struct Window {
+        qint64 start;   ///< Start of the window, in milliseconds since the epoch.
+        qint64 end;     ///< End of the window (exclusive), in milliseconds since the epoch.
+        quint64 count;  ///< Number of readings aggregated.
+        float minimum;  ///< Minimum reading value, or NaN for MultimeterService::MeterStatus::Error windows.
+        float maximum;  ///< Maximum reading value, or NaN for MultimeterService::MeterStatus::Error windows.
+        float mean;     ///< Mean reading value, or NaN for MultimeterService::MeterStatus::Error windows.
+        MultimeterService::MeterStatus status; ///< Status of the most recent reading.
+        MultimeterService::Mode mode;          ///< Mode shared by all of the readings.
+        quint8 range;                          ///< Range shared by all of the readings.
+    };
+
+    explicit MeterAggregator(MultimeterService * const service, QObject * parent = nullptr);
+    virtual ~MeterAggregator();
+
+    MultimeterService * service() const;
+
+    quint32 period() const;
+    void setPeriod(const quint32 period);
+
+    quint32 step() const;
+    void setStep(const quint32 step);
+
+public Q_SLOTS:
+    void addReading(const MultimeterService::Reading &reading, const qint64 timestamp);
+    void flush();
+    void reset();
+
+Q_SIGNALS:
+    void windowReady(const MeterAggregator::Window &window);
+
+protected:
+    /// \cond internal
+    MeterAggregatorPrivate * d_ptr; ///< Internal d-pointer.
+    MeterAggregator(MeterAggregatorPrivate * const d, MultimeterService * const service, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(MeterAggregator)
+    Q_DISABLE_COPY(MeterAggregator)
+    QTPOKIT_BEFRIEND_TEST(MeterAggregator)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERAGGREGATOR_H
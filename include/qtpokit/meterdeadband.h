@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterDeadband class.
+ */
+
+#ifndef QTPOKIT_METERDEADBAND_H
+#define QTPOKIT_METERDEADBAND_H
+
+#include "multimeterservice.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class MeterDeadbandPrivate;
+
+class QTPOKIT_EXPORT MeterDeadband : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MeterDeadband(MultimeterService * const service, QObject * parent = nullptr);
+    virtual ~MeterDeadband();
+
+    MultimeterService * service() const;
+
+    float absoluteDeadband() const;
+    void setAbsoluteDeadband(const float deadband);
+
+    float relativeDeadband() const;
+    void setRelativeDeadband(const float deadband);
+
+    quint32 heartbeat() const;
+    void setHeartbeat(const quint32 heartbeat);
+
+    quint64 acceptedCount() const;
+    quint64 suppressedCount() const;
+
+public Q_SLOTS:
+    bool addReading(const MultimeterService::Reading &reading, const qint64 timestamp);
+    void reset();
+
+Q_SIGNALS:
+    void readingAccepted(const MultimeterService::Reading &reading);
+
+protected:
+    /// \cond internal
+    MeterDeadbandPrivate * d_ptr; ///< Internal d-pointer.
+    MeterDeadband(MeterDeadbandPrivate * const d, MultimeterService * const service, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(MeterDeadband)
+    Q_DISABLE_COPY(MeterDeadband)
+    QTPOKIT_BEFRIEND_TEST(MeterDeadband)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERDEADBAND_H
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterHistory class.
+ */
+
+#ifndef QTPOKIT_METERHISTORY_H
+#define QTPOKIT_METERHISTORY_H
+
+#include "qtpokit_global.h"
+#include "multimeterservice.h"
+
+#include <QCoreApplication>
+#include <QVector>
+
+#include <iterator>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT MeterHistory
+{
+    Q_DECLARE_TR_FUNCTIONS(MeterHistory)
+
+public:
+    static constexpr qsizetype defaultChunkSize { 4096 }; ///< Default number of readings stored per chunk.
+
+    /// A run of consecutive readings, all with the same status, mode and range, and contiguous values.
+    struct Span {
+        qsizetype first;                       ///< Index of the span's first reading, within the whole history.
+        qsizetype count;                       ///< Number of readings in the span.
+        const float * values;                  ///< The span's #count values, valid until the history is modified.
+        qint64 timestamp;                      ///< Timestamp of the span's first reading.
+        MultimeterService::MeterStatus status; ///< Status of every reading in the span.
+        MultimeterService::Mode mode;          ///< Mode of every reading in the span.
+        quint8 range;                          ///< Range of every reading in the span.
+    };
+
+    class ConstIterator;
+
+    explicit MeterHistory(const qsizetype chunkSize = defaultChunkSize);
+
+    qsizetype chunkSize() const;
+    qsizetype chunkCount() const;
+    qsizetype size() const;
+    bool isEmpty() const;
+    qsizetype memoryUsage() const;
+
+    void append(const qint64 timestamp, const MultimeterService::Reading &reading);
+    void append(const MultimeterService::TimedReading &reading);
+    void append(const QVector<MultimeterService::TimedReading> &readings);
+    void clear();
+
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+    MultimeterService::TimedReading at(const qsizetype index) const;
+    qsizetype indexOf(const qint64 timestamp) const;
+
+    MeterHistory slice(const qsizetype first, const qsizetype count = -1) const;
+    MeterHistory between(const qint64 from, const qint64 to) const;
+    qsizetype removeBefore(const qint64 timestamp);
+    QVector<Span> spans(const qsizetype first = 0, const qsizetype count = -1) const;
+
+    ConstIterator begin() const;
+    ConstIterator end() const;
+    ConstIterator constBegin() const;
+    ConstIterator constEnd() const;
+
+    QVector<MultimeterService::TimedReading> toVector() const;
+    static MeterHistory fromVector(const QVector<MultimeterService::TimedReading> &readings,
+                                   const qsizetype chunkSize = defaultChunkSize);
+
+private:
+    static constexpr quint32 wideDelta { 0xFFFFFFFF }; ///< Delta marking that the actual delta is in Chunk::wide.
+
+    /// A run of consecutive readings, within a chunk, all with the same status, mode and range.
+    struct Run {
+        quint32 start;                         ///< Index of the run's first reading, within its chunk.
+        MultimeterService::MeterStatus status; ///< Status of every reading in the run.
+        MultimeterService::Mode mode;          ///< Mode of every reading in the run.
+        quint8 range;                          ///< Range of every reading in the run.
+    };
+
+    /// A chunk of (up to #capacity) consecutive readings, stored as columns.
+    struct Chunk {
+        qint64 first { 0 };      ///< Timestamp of the chunk's first reading.
+        qint64 last { 0 };       ///< Timestamp of the chunk's last reading.
+        QVector<float> values;   ///< Value of each reading.
+        QVector<quint32> deltas; ///< Time since the previous reading (0 for the first), or #wideDelta.
+        QVector<qint64> wide;    ///< Deltas too large for #deltas (or negative), in order.
+        QVector<Run> runs;       ///< Status, mode and range of the readings, run-length encoded.
+    };
+
+    QVector<Chunk> chunks; ///< Chunks of readings, oldest first; all but the last are closed to further appends.
+    qsizetype capacity;    ///< Maximum number of readings per chunk.
+    qsizetype count { 0 }; ///< Total number of readings, across all #chunks.
+
+    qsizetype locate(qsizetype &index) const;
+
+    friend class ConstIterator;
+};
+
+/// A forward iterator over a MeterHistory's readings, oldest first, decoding each reading's timestamp as it goes.
+class QTPOKIT_EXPORT MeterHistory::ConstIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;     ///< Iterator category.
+    using value_type = MultimeterService::TimedReading;      ///< Type of value iterated over.
+    using difference_type = qsizetype;                       ///< Type of distances between iterators.
+    using pointer = const MultimeterService::TimedReading *; ///< Pointer to a value.
+    using reference = MultimeterService::TimedReading;       ///< Reference to a value, being a decoded copy.
+
+    ConstIterator() = default;
+
+    MultimeterService::TimedReading operator*() const;
+    ConstIterator &operator++();
+    ConstIterator operator++(int);
+    bool operator==(const ConstIterator &other) const;
+    bool operator!=(const ConstIterator &other) const;
+
+private:
+    friend class MeterHistory;
+    ConstIterator(const MeterHistory * const history, const qsizetype chunk);
+
+    const MeterHistory * history { nullptr }; ///< History being iterated over.
+    qsizetype chunk { 0 };                    ///< Index of the current chunk.
+    qsizetype position { 0 };                 ///< Index of the current reading, within the current chunk.
+    qsizetype run { 0 };                      ///< Index of the current reading's run.
+    qsizetype wide { 0 };                     ///< Index of the current chunk's next wide delta.
+    qint64 timestamp { 0 };                   ///< Timestamp of the current reading.
+
+    void enterChunk();
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERHISTORY_H
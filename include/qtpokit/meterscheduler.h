@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterScheduler class.
+ */
+
+#ifndef QTPOKIT_METERSCHEDULER_H
+#define QTPOKIT_METERSCHEDULER_H
+
+#include "multimeterservice.h"
+
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class MeterSchedulerPrivate;
+
+class QTPOKIT_EXPORT MeterScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// A single step of a measurement schedule.
+    struct Entry {
+        MultimeterService::Mode mode; ///< Mode to measure.
+        quint8 range;                 ///< Range to measure with, such as PokitMeter::VoltageRange::AutoRange.
+        quint32 dwell;                ///< Time to spend on this entry, in milliseconds, including switch latency.
+    };
+
+    explicit MeterScheduler(MultimeterService * const service, QObject * parent = nullptr);
+    virtual ~MeterScheduler();
+
+    MultimeterService * service() const;
+
+    QVector<Entry> entries() const;
+    void setEntries(const QVector<Entry> &entries);
+
+    quint32 updateInterval() const;
+    void setUpdateInterval(const quint32 interval);
+
+    bool isRunning() const;
+    int currentIndex() const;
+    quint64 staleCount() const;
+
+public Q_SLOTS:
+    bool start();
+    void stop();
+
+Q_SIGNALS:
+    void entryStarted(const int index, const qint64 latency);
+    void readingReady(const MultimeterService::Reading &reading, const int index);
+
+protected:
+    /// \cond internal
+    MeterSchedulerPrivate * d_ptr; ///< Internal d-pointer.
+    MeterScheduler(MeterSchedulerPrivate * const d, MultimeterService * const service, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(MeterScheduler)
+    Q_DISABLE_COPY(MeterScheduler)
+    QTPOKIT_BEFRIEND_TEST(MeterScheduler)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERSCHEDULER_H
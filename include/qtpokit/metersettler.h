@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterSettler class.
+ */
+
+#ifndef QTPOKIT_METERSETTLER_H
+#define QTPOKIT_METERSETTLER_H
+
+#include "multimeterservice.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class MeterSettlerPrivate;
+
+class QTPOKIT_EXPORT MeterSettler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MeterSettler(MultimeterService * const service, QObject * parent = nullptr);
+    virtual ~MeterSettler();
+
+    MultimeterService * service() const;
+
+    quint32 defaultSettleTime() const;
+    void setDefaultSettleTime(const quint32 settleTime);
+
+    quint32 settleTime(const MultimeterService::Mode mode) const;
+    void setSettleTime(const MultimeterService::Mode mode, const quint32 settleTime);
+
+    bool isSettled() const;
+    quint64 transitionCount() const;
+    quint64 unsettledCount() const;
+
+public Q_SLOTS:
+    bool addReading(const MultimeterService::Reading &reading, const qint64 timestamp);
+    void reset();
+
+Q_SIGNALS:
+    void readingSettled(const MultimeterService::Reading &reading, const qint64 timestamp);
+    void readingUnsettled(const MultimeterService::Reading &reading, const qint64 timestamp);
+
+protected:
+    /// \cond internal
+    MeterSettlerPrivate * d_ptr; ///< Internal d-pointer.
+    MeterSettler(MeterSettlerPrivate * const d, MultimeterService * const service, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(MeterSettler)
+    Q_DISABLE_COPY(MeterSettler)
+    QTPOKIT_BEFRIEND_TEST(MeterSettler)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERSETTLER_H
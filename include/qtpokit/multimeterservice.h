@@ -10,6 +10,7 @@
 #define QTPOKIT_MULTIMETERSERVICE_H
 
 #include "abstractpokitservice.h"
+#include "ringbuffer.h"
 
 #include <QBluetoothAddress>
 #include <QBluetoothUuid>
@@ -82,6 +83,12 @@ public:
         quint8 range;       ///< Current range.
     };
 
+    /// A Reading, and the time it was received, as recorded by a burst capture (see startBurst()).
+    struct TimedReading {
+        qint64 timestamp; ///< Steady clock time the reading was received, in nanoseconds (see receiveTimestamp()).
+        Reading reading;  ///< The reading itself.
+    };
+
     MultimeterService(QLowEnergyController * const pokitDevice, QObject * parent = nullptr);
     ~MultimeterService() = default;
 
@@ -90,15 +97,28 @@ public:
 
     // Settings characteristic (BLE write only).
     bool setSettings(const Settings &settings);
+    QFuture<bool> setSettingsAsync(const Settings &settings);
 
     // Reading characteristic (BLE read/notify).
     Reading reading() const;
     bool enableReadingNotifications();
+    QFuture<bool> enableReadingNotificationsAsync();
     bool disableReadingNotifications();
+    QFuture<bool> disableReadingNotificationsAsync();
+
+    RingBuffer<Reading> * readingsBuffer() const;
+    void setReadingsBuffer(RingBuffer<Reading> * const buffer);
+
+    // Burst capture, to memory.
+    bool startBurst(const int count);
+    QVector<TimedReading> cancelBurst();
+    bool isBursting() const;
 
 Q_SIGNALS:
     void settingsWritten();
     void readingRead(const MultimeterService::Reading &reading);
+    void readingsBatchRead(const QVector<MultimeterService::Reading> &readings);
+    void burstCompleted(const QVector<MultimeterService::TimedReading> &readings);
 
 protected:
     /// \cond internal
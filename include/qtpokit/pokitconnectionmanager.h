@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitConnectionManager class.
+ */
+
+#ifndef QTPOKIT_POKITCONNECTIONMANAGER_H
+#define QTPOKIT_POKITCONNECTIONMANAGER_H
+
+#include "qtpokit_global.h"
+
+#include <QBluetoothAddress>
+#include <QBluetoothDeviceInfo>
+#include <QList>
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class PokitConnectionManagerPrivate;
+class PokitDevice;
+
+class QTPOKIT_EXPORT PokitConnectionManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PokitConnectionManager(QObject * parent = nullptr);
+    virtual ~PokitConnectionManager();
+
+    int maxConnections() const;
+    void setMaxConnections(const int connections);
+    int maxConnections(const QBluetoothAddress &adapter) const;
+    void setMaxConnections(const QBluetoothAddress &adapter, const int connections);
+
+    QList<QBluetoothAddress> adapters() const;
+    void setAdapters(const QList<QBluetoothAddress> &adapters);
+    static QList<QBluetoothAddress> localAdapters();
+
+    quint32 idleTimeout() const;
+    void setIdleTimeout(const quint32 timeout);
+
+    quint32 leaseTimeout() const;
+    void setLeaseTimeout(const quint32 timeout);
+
+    quint32 request(const QBluetoothDeviceInfo &info, const QBluetoothAddress &adapter = QBluetoothAddress());
+    bool release(const quint32 ticket);
+    bool disconnectIdle(const QBluetoothDeviceInfo &info);
+    bool prewarm(const QBluetoothDeviceInfo &info, const QBluetoothAddress &adapter = QBluetoothAddress());
+
+    PokitDevice * device(const quint32 ticket) const;
+    int connectionCount(const QBluetoothAddress &adapter = QBluetoothAddress()) const;
+    int pendingCount() const;
+
+public Q_SLOTS:
+    void updateRssi(const QBluetoothDeviceInfo &info, const QBluetoothAddress &adapter);
+
+Q_SIGNALS:
+    void granted(const quint32 ticket, PokitDevice * device);
+    void failed(const quint32 ticket);
+    void leaseExpired(const quint32 ticket);
+
+protected:
+    /// \cond internal
+    PokitConnectionManagerPrivate * d_ptr; ///< Internal d-pointer.
+    PokitConnectionManager(PokitConnectionManagerPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(PokitConnectionManager)
+    Q_DISABLE_COPY(PokitConnectionManager)
+    QTPOKIT_BEFRIEND_TEST(PokitConnectionManager)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POKITCONNECTIONMANAGER_H
@@ -10,9 +10,18 @@
 #define QTPOKIT_POKITDEVICE_H
 
 #include "qtpokit_global.h"
+#include "abstractpokitservice.h"
+#include "pokitproducts.h"
+#include "threadpolicy.h"
 
+#include <QBluetoothAddress>
 #include <QBluetoothDeviceInfo>
+#include <QLowEnergyConnectionParameters>
 #include <QObject>
+#include <QVector>
+#include <QVersionNumber>
+
+#include <optional>
 
 class QLowEnergyController;
 
@@ -32,12 +41,70 @@ class QTPOKIT_EXPORT PokitDevice : public QObject
     Q_OBJECT
 
 public:
+    /// Capabilities of a Pokit device, resolved once from its services, and shared by them all.
+    struct Capabilities {
+        std::optional<PokitProduct> product;             ///< Pokit product, if known.
+        QVersionNumber firmwareVersion;                  ///< Device's firmware version, if known.
+        std::optional<bool> loggerUpdateIntervalIs32bit; ///< Whether Data Logger settings use 32-bit intervals.
+        quint16 maximumSamplingRate { 0 };               ///< Device's maximum sampling rate, or 0 if not known.
+        quint16 samplingBufferSize { 0 };                ///< Device's sampling buffer size, or 0 if not known.
+        quint16 maximumVoltage { 0 };                    ///< Device's maximum input voltage, or 0 if not known.
+        quint16 maximumCurrent { 0 };                    ///< Device's maximum input current, or 0 if not known.
+        quint16 maximumResistance { 0 };                 ///< Device's maximum input resistance, or 0 if not known.
+        quint16 capabilityMask { 0 };                    ///< Device's (reserved) capability mask, if known.
+        QBluetoothAddress macAddress;                    ///< Device's MAC address, if known.
+    };
+
+    /// Predefined BLE connection parameter profiles, trading throughput and latency against power.
+    enum class ConnectionProfile : quint8 {
+        Default,    ///< Moderate connection intervals, typical of most platforms' defaults.
+        LowLatency, ///< Minimum connection intervals, for DSO transfers and fast meter rates.
+        LowPower,   ///< Long connection intervals, with peripheral latency, for slow data logging.
+    };
+    static QString toString(const ConnectionProfile profile);
+    static QLowEnergyConnectionParameters connectionParameters(const ConnectionProfile profile);
+
+    /// Policy for automatically reconnecting to a Pokit device after an unexpected disconnection.
+    struct ReconnectPolicy {
+        int maximumAttempts { 0 };      ///< Maximum consecutive reconnection attempts, or 0 to never reconnect.
+        quint32 initialDelay { 1000 };  ///< Delay before the first reconnection attempt, in milliseconds.
+        quint32 maximumDelay { 60000 }; ///< Maximum delay between reconnection attempts, in milliseconds.
+        float backoff { 2.0f };         ///< Factor the delay is multiplied by after each failed attempt.
+        float jitter { 0.25f };         ///< Maximum random variation of each delay, as a fraction of the delay.
+    };
+
+    /// Pokit services, such as for preparing several at once, via prepareServices().
+    enum class Service : quint8 {
+        Calibration = 0x01, ///< CalibrationService, as per calibration().
+        DataLogger  = 0x02, ///< DataLoggerService, as per dataLogger().
+        DeviceInfo  = 0x04, ///< DeviceInfoService, as per deviceInformation().
+        Dso         = 0x08, ///< DsoService, as per dso().
+        Multimeter  = 0x10, ///< MultimeterService, as per multimeter().
+        Status      = 0x20, ///< StatusService, as per status().
+    };
+    Q_DECLARE_FLAGS(Services, Service)
+    static QString toString(const Service service);
+    static QString toString(const Services services);
+
+    /// Runtime statistics for a Pokit device's connection, and services, accumulated since construction.
+    struct Statistics {
+        quint64 connections { 0 };       ///< Number of times the device has connected, including reconnections.
+        quint64 disconnections { 0 };    ///< Number of times the device has disconnected, whether requested or not.
+        quint64 reconnections { 0 };     ///< Number of successful automatic reconnections.
+        quint64 reconnectFailures { 0 }; ///< Number of times all automatic reconnection attempts have failed.
+        quint64 errors { 0 };            ///< Number of controller errors reported.
+        QVector<AbstractPokitService::Statistics> services; ///< Statistics of each service created so far.
+    };
+
     explicit PokitDevice(const QBluetoothDeviceInfo &deviceInfo, QObject * parent = nullptr);
+    PokitDevice(const QBluetoothDeviceInfo &deviceInfo, const QBluetoothAddress &localAdapter,
+                QObject * parent = nullptr);
     explicit PokitDevice(QLowEnergyController * controller, QObject * parent = nullptr);
     virtual ~PokitDevice();
 
     QLowEnergyController * controller();
     const QLowEnergyController * controller() const;
+    QBluetoothAddress localAdapter() const;
 
     CalibrationService * calibration();
     DataLoggerService * dataLogger();
@@ -45,6 +112,28 @@ public:
     DsoService * dso();
     MultimeterService * multimeter();
     StatusService * status();
+    AbstractPokitService * service(const Service service);
+
+    bool prepareServices(const Services services);
+    Services preparedServices() const;
+
+    Capabilities capabilities() const;
+    void setCapabilities(const Capabilities &capabilities);
+
+    ConnectionProfile connectionProfile() const;
+    bool setConnectionProfile(const ConnectionProfile profile);
+
+    int mtu() const;
+
+    ReconnectPolicy reconnectPolicy() const;
+    void setReconnectPolicy(const ReconnectPolicy &policy);
+    bool isReconnecting() const;
+    void disconnectFromDevice();
+
+    ThreadPolicy::State threadPolicy() const;
+    void setThreadPolicy(const ThreadPolicy::Settings &settings);
+
+    Statistics statistics() const;
 
     static QString serviceToString(const QBluetoothUuid &uuid);
     static QString charcteristicToString(const QBluetoothUuid &uuid);
@@ -52,6 +141,11 @@ public:
 public Q_SLOTS:
 
 Q_SIGNALS:
+    void capabilitiesChanged(const PokitDevice::Capabilities &capabilities);
+    void reconnecting(const int attempt, const quint32 delay);
+    void reconnected();
+    void reconnectFailed();
+    void servicesPrepared(const PokitDevice::Services prepared, const PokitDevice::Services failed);
 
 protected:
     /// \cond internal
@@ -65,6 +159,8 @@ private:
     QTPOKIT_BEFRIEND_TEST(PokitDevice)
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(PokitDevice::Services)
+
 QTPOKIT_END_NAMESPACE
 
 #endif // QTPOKIT_POKITDEVICE_H
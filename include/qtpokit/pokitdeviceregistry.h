@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitDeviceRegistry class.
+ */
+
+#ifndef QTPOKIT_POKITDEVICEREGISTRY_H
+#define QTPOKIT_POKITDEVICEREGISTRY_H
+
+#include "pokitproducts.h"
+
+#include <QBluetoothAddress>
+#include <QBluetoothDeviceInfo>
+#include <QObject>
+#include <QVector>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class PokitDeviceRegistryPrivate;
+class PokitDiscoveryAgent;
+
+class QTPOKIT_EXPORT PokitDeviceRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Connection states of registered devices, as reported via setConnectionState().
+    enum class ConnectionState : quint8 {
+        Disconnected, ///< Not connected (the default), so the device is aged out once no longer seen.
+        Connecting,   ///< Being connected to.
+        Connected,    ///< Connected to.
+    };
+    static QString toString(const ConnectionState &state);
+
+    /// Attributes of a registered device.
+    struct Entry {
+        QBluetoothDeviceInfo info;   ///< Most recently discovered, or updated, device info.
+        PokitProduct product { PokitProduct::PokitMeter }; ///< Pokit product.
+        QString name;                ///< Device name.
+        qint16 rssi { 0 };           ///< Most recent (possibly smoothed) RSSI, in dBm.
+        qint64 lastSeen { 0 };       ///< Time the device was last seen, in milliseconds since the epoch.
+        ConnectionState connectionState { ConnectionState::Disconnected }; ///< Connection state.
+    };
+
+    explicit PokitDeviceRegistry(const QBluetoothAddress &deviceAdapter, QObject * parent = nullptr);
+    PokitDeviceRegistry(QObject * parent = nullptr);
+    virtual ~PokitDeviceRegistry();
+
+    PokitDiscoveryAgent * discoveryAgent() const;
+
+    quint32 scanDuration() const;
+    void setScanDuration(const quint32 duration);
+
+    quint32 scanInterval() const;
+    void setScanInterval(const quint32 interval);
+
+    quint32 maximumAge() const;
+    void setMaximumAge(const quint32 age);
+
+    bool isRunning() const;
+
+    static QString key(const QBluetoothDeviceInfo &info);
+    int count() const;
+    bool contains(const QString &key) const;
+    std::optional<Entry> device(const QString &key) const;
+    QVector<Entry> devices() const;
+
+    bool setConnectionState(const QString &key, const ConnectionState state);
+
+public Q_SLOTS:
+    void start();
+    void stop();
+    void clear();
+
+Q_SIGNALS:
+    void deviceAdded(const PokitDeviceRegistry::Entry &entry);
+    void deviceUpdated(const PokitDeviceRegistry::Entry &entry);
+    void deviceRemoved(const PokitDeviceRegistry::Entry &entry);
+
+protected:
+    /// \cond internal
+    PokitDeviceRegistryPrivate * d_ptr; ///< Internal d-pointer.
+    PokitDeviceRegistry(PokitDeviceRegistryPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(PokitDeviceRegistry)
+    Q_DISABLE_COPY(PokitDeviceRegistry)
+    QTPOKIT_BEFRIEND_TEST(PokitDeviceRegistry)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POKITDEVICEREGISTRY_H
@@ -26,6 +26,17 @@ public:
     PokitDiscoveryAgent(QObject * parent = nullptr);
     virtual ~PokitDiscoveryAgent();
 
+    QBluetoothAddress adapterAddress() const;
+
+    quint32 updateInterval() const;
+    void setUpdateInterval(const quint32 interval);
+
+    float rssiSmoothing() const;
+    void setRssiSmoothing(const float smoothing);
+
+    quint16 rssiThreshold() const;
+    void setRssiThreshold(const quint16 threshold);
+
 public Q_SLOTS:
     void start(QBluetoothDeviceDiscoveryAgent::DiscoveryMethods methods);
     void start();
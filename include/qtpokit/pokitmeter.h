@@ -10,6 +10,7 @@
 #define QTPOKIT_POKITMETER_H
 
 #include "qtpokit_global.h"
+#include "rangetable.h"
 
 QTPOKIT_BEGIN_NAMESPACE
 
@@ -27,6 +28,14 @@ namespace PokitMeter {
     };
     QTPOKIT_EXPORT QString toString(const CurrentRange &range);
     QTPOKIT_EXPORT quint32 maxValue(const CurrentRange &range);
+    /// The Pokit Meter's current ranges, with maximum values in microamps.
+    inline constexpr std::array<RangeInfo<CurrentRange>, 5> currentRanges {{
+        { CurrentRange::_10mA,     10'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 10mA") },
+        { CurrentRange::_30mA,     30'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 30mA") },
+        { CurrentRange::_150mA,   150'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 150mA") },
+        { CurrentRange::_300mA,   300'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 300mA") },
+        { CurrentRange::_2A,    2'000'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 2A") },
+    }};
 
     /// Values supported by the Pokit Meter's `Range` attributes in `Resistance` mode.
     enum class ResistanceRange : quint8 {
@@ -42,6 +51,17 @@ namespace PokitMeter {
     };
     QTPOKIT_EXPORT QString toString(const ResistanceRange &range);
     QTPOKIT_EXPORT quint32 maxValue(const ResistanceRange &range);
+    /// The Pokit Meter's resistance ranges, with maximum values in ohms.
+    inline constexpr std::array<RangeInfo<ResistanceRange>, 8> resistanceRanges {{
+        { ResistanceRange::_160,        160, QT_TRANSLATE_NOOP("PokitMeter", "Up to 160Ω") },
+        { ResistanceRange::_330,        330, QT_TRANSLATE_NOOP("PokitMeter", "Up to 330Ω") },
+        { ResistanceRange::_890,        890, QT_TRANSLATE_NOOP("PokitMeter", "Up to 890Ω") },
+        { ResistanceRange::_1K5,      1'500, QT_TRANSLATE_NOOP("PokitMeter", "Up to 1.5KΩ") },
+        { ResistanceRange::_10K,     10'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 10KΩ") },
+        { ResistanceRange::_100K,   100'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 100KΩ") },
+        { ResistanceRange::_470K,   470'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 470KΩ") },
+        { ResistanceRange::_1M,   1'000'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 1MΩ") },
+    }};
 
     /// Values supported by the Pokit Meter's `Range` attributes in `*Voltage` modes.
     enum class VoltageRange : quint8 {
@@ -55,6 +75,15 @@ namespace PokitMeter {
     };
     QTPOKIT_EXPORT QString toString(const VoltageRange &range);
     QTPOKIT_EXPORT quint32 maxValue(const VoltageRange &range);
+    /// The Pokit Meter's voltage ranges, with maximum values in millivolts.
+    inline constexpr std::array<RangeInfo<VoltageRange>, 6> voltageRanges {{
+        { VoltageRange::_300mV,    300, QT_TRANSLATE_NOOP("PokitMeter", "Up to 300mV") },
+        { VoltageRange::_2V,     2'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 2V") },
+        { VoltageRange::_6V,     6'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 6V") },
+        { VoltageRange::_12V,   12'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 12V") },
+        { VoltageRange::_30V,   30'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 30V") },
+        { VoltageRange::_60V,   60'000, QT_TRANSLATE_NOOP("PokitMeter", "Up to 60V") },
+    }};
 
 }
 
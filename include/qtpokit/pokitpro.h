@@ -10,6 +10,7 @@
 #define QTPOKIT_POKITPRO_H
 
 #include "qtpokit_global.h"
+#include "rangetable.h"
 
 QTPOKIT_BEGIN_NAMESPACE
 
@@ -25,7 +26,12 @@ namespace PokitPro {
     };
     QTPOKIT_EXPORT QString toString(const CapacitanceRange &range);
     QTPOKIT_EXPORT quint32 maxValue(const CapacitanceRange &range);
-
+    /// The Pokit Pro's capacitance ranges, with maximum values in nanofarads.
+    inline constexpr std::array<RangeInfo<CapacitanceRange>, 3> capacitanceRanges {{
+        { CapacitanceRange::_100nF,       100, QT_TRANSLATE_NOOP("PokitPro", "Up to 100nF") },
+        { CapacitanceRange::_10uF,     10'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 10μF") },
+        { CapacitanceRange::_1mF,   1'000'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 1mF") },
+    }};
 
     /// Values supported by the Pokit Pro's `Range` attributes in `*Current` modes.
     enum class CurrentRange : quint8 {
@@ -40,6 +46,16 @@ namespace PokitPro {
     };
     QTPOKIT_EXPORT QString toString(const CurrentRange &range);
     QTPOKIT_EXPORT quint32 maxValue(const CurrentRange &range);
+    /// The Pokit Pro's current ranges, with maximum values in microamps.
+    inline constexpr std::array<RangeInfo<CurrentRange>, 7> currentRanges {{
+        { CurrentRange::_500uA,        500, QT_TRANSLATE_NOOP("PokitPro", "Up to 500μA") },
+        { CurrentRange::_2mA,        2'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 2mA") },
+        { CurrentRange::_10mA,      10'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 10mA") },
+        { CurrentRange::_125mA,    125'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 125mA") },
+        { CurrentRange::_300mA,    300'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 300mA") },
+        { CurrentRange::_3A,     3'000'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 3A") },
+        { CurrentRange::_10A,   10'000'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 10A") },
+    }};
 
     /// Values supported by the Pokit Pro's `Range` attributes in `Resistance` mode.
     enum class ResistanceRange : quint8 {
@@ -58,6 +74,20 @@ namespace PokitPro {
     };
     QTPOKIT_EXPORT QString toString(const ResistanceRange &range);
     QTPOKIT_EXPORT quint32 maxValue(const ResistanceRange &range);
+    /// The Pokit Pro's resistance ranges, with maximum values in ohms.
+    inline constexpr std::array<RangeInfo<ResistanceRange>, 11> resistanceRanges {{
+        { ResistanceRange::_30,          30, QT_TRANSLATE_NOOP("PokitPro", "Up to 30Ω") },
+        { ResistanceRange::_75,          75, QT_TRANSLATE_NOOP("PokitPro", "Up to 75Ω") },
+        { ResistanceRange::_400,        400, QT_TRANSLATE_NOOP("PokitPro", "Up to 400Ω") },
+        { ResistanceRange::_5K,       5'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 5KΩ") },
+        { ResistanceRange::_10K,     10'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 10KΩ") },
+        { ResistanceRange::_15K,     15'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 15KΩ") },
+        { ResistanceRange::_40K,     40'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 40KΩ") },
+        { ResistanceRange::_500K,   500'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 500KΩ") },
+        { ResistanceRange::_700K,   700'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 700KΩ") },
+        { ResistanceRange::_1M,   1'000'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 1MΩ") },
+        { ResistanceRange::_3M,   3'000'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 3MΩ") },
+    }};
 
     /// Values supported by the Pokit Pro's `Range` attributes in `*Voltage` modes.
     enum class VoltageRange : quint8 {
@@ -73,6 +103,17 @@ namespace PokitPro {
     };
     QTPOKIT_EXPORT QString toString(const VoltageRange &range);
     QTPOKIT_EXPORT quint32 maxValue(const VoltageRange &range);
+    /// The Pokit Pro's voltage ranges, with maximum values in millivolts.
+    inline constexpr std::array<RangeInfo<VoltageRange>, 8> voltageRanges {{
+        { VoltageRange::_250mV,     250, QT_TRANSLATE_NOOP("PokitPro", "Up to 250mV") },
+        { VoltageRange::_2V,      2'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 2V") },
+        { VoltageRange::_10V,    10'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 10V") },
+        { VoltageRange::_30V,    30'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 30V") },
+        { VoltageRange::_60V,    60'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 60V") },
+        { VoltageRange::_125V,  125'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 125V") },
+        { VoltageRange::_400V,  400'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 400V") },
+        { VoltageRange::_600V,  600'000, QT_TRANSLATE_NOOP("PokitPro", "Up to 600V") },
+    }};
 
 }
 
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitSimulator class.
+ */
+
+#ifndef QTPOKIT_POKITSIMULATOR_H
+#define QTPOKIT_POKITSIMULATOR_H
+
+#include "pokitproducts.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class PokitDevice;
+class PokitSimulatorPrivate;
+
+class QTPOKIT_EXPORT PokitSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Streams of characteristic values generated by the simulator.
+    enum class Stream : quint8 {
+        Multimeter = 0, ///< Multimeter `Reading` values.
+        Dso        = 1, ///< DSO `Metadata` and `Reading` values.
+        DataLogger = 2, ///< Data Logger `Metadata` and `Reading` values.
+        Status     = 3, ///< Status `Status` values.
+    };
+    static QString toString(const Stream stream);
+
+    /// Timing, sizing, and failure characteristics of a simulated stream.
+    struct Profile {
+        quint32 interval { 0 };     ///< Milliseconds between notifications, or 0 for the stream's default.
+        quint32 jitter { 0 };       ///< Maximum random deviation of each interval, in milliseconds.
+        quint16 payloadSize { 0 };  ///< Sample bytes per notification (DSO and Data Logger only), or 0 for 244.
+        float failureRate { 0.0f }; ///< Probability, from 0 to 1, of each request failing, and each value truncating.
+    };
+
+    /// Simulation statistics.
+    struct Statistics {
+        quint64 requests { 0 };        ///< Number of GATT requests handled.
+        quint64 failedRequests { 0 };  ///< Number of GATT requests deliberately failed.
+        quint64 values { 0 };          ///< Number of values delivered (notified, or read).
+        quint64 bytes { 0 };           ///< Number of value bytes delivered.
+        quint64 truncatedValues { 0 }; ///< Number of values deliberately truncated.
+    };
+
+    explicit PokitSimulator(PokitDevice * const device, QObject * parent = nullptr);
+    virtual ~PokitSimulator();
+
+    PokitDevice * device() const;
+
+    PokitProduct product() const;
+    void setProduct(const PokitProduct product);
+
+    Profile profile(const Stream stream) const;
+    void setProfile(const Stream stream, const Profile &profile);
+
+    quint32 latency() const;
+    void setLatency(const quint32 latency);
+
+    quint16 loggedSamples() const;
+    void setLoggedSamples(const quint16 samples);
+
+    bool isRunning() const;
+    Statistics statistics() const;
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+protected:
+    /// \cond internal
+    PokitSimulatorPrivate * d_ptr; ///< Internal d-pointer.
+    PokitSimulator(PokitSimulatorPrivate * const d, PokitDevice * const device, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(PokitSimulator)
+    Q_DISABLE_COPY(PokitSimulator)
+    QTPOKIT_BEFRIEND_TEST(PokitSimulator)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POKITSIMULATOR_H
@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitTrace namespace, and the QTPOKIT_TRACE_POINT, QTPOKIT_TRACE_ZONE, QTPOKIT_TRACE_FRAME_MARK and
+ * QTPOKIT_TRACE_THREAD_NAME macros.
+ */
+
+#ifndef QTPOKIT_POKITTRACE_H
+#define QTPOKIT_POKITTRACE_H
+
+#include "qtpokit_global.h"
+
+#include <QString>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// Records lightweight trace points, at key stages of the BLE pipeline, into an in-memory ring buffer.
+namespace PokitTrace {
+
+    /// Stages of the BLE pipeline that trace points are recorded at.
+    enum class Stage : quint8 {
+        Connect,   ///< Controller connected, or disconnected.
+        Discovery, ///< Services, or service details, discovered.
+        Write,     ///< GATT request issued.
+        Notify,    ///< Characteristic notification received.
+        Parse,     ///< Characteristic value parsed.
+        Emit,      ///< Parsed value emitted to (directly connected) consumers.
+        Format,    ///< Application output formatted (such as by the dokit CLI).
+        Output,    ///< Application output written (such as to stdout, or an output file).
+    };
+    QTPOKIT_EXPORT QString toString(const Stage stage);
+
+    /// A single recorded trace point.
+    struct Event {
+        qint64 timestamp { 0 };         ///< Steady clock time the event was recorded, in nanoseconds.
+        Stage stage { Stage::Connect }; ///< Pipeline stage the event was recorded at.
+        const char * label { nullptr }; ///< Static label identifying the trace point.
+        qint64 value { 0 };             ///< Trace point specific value, such as a byte count, or request ID.
+    };
+
+    QTPOKIT_EXPORT bool isEnabled();
+    QTPOKIT_EXPORT quint32 capacity();
+
+    QTPOKIT_EXPORT void record(const Stage stage, const char * const label, const qint64 value = 0);
+    QTPOKIT_EXPORT QVector<Event> events();
+    QTPOKIT_EXPORT void clear();
+
+    QTPOKIT_EXPORT bool isProfilerEnabled();
+    QTPOKIT_EXPORT void beginZone(const Stage stage, const char * const label);
+    QTPOKIT_EXPORT void endZone();
+    QTPOKIT_EXPORT void markFrame(const char * const name);
+    QTPOKIT_EXPORT void setThreadName(const char * const name);
+
+    /// Scoped profiler zone, begun on construction, and ended on destruction (see QTPOKIT_TRACE_ZONE).
+    class Zone
+    {
+    public:
+        /// Begins a profiler zone at \a stage, with static string \a label.
+        Zone(const Stage stage, const char * const label) { beginZone(stage, label); }
+        /// Ends the profiler zone.
+        ~Zone() { endZone(); }
+    private:
+        Q_DISABLE_COPY(Zone)
+    };
+
+}
+
+/*!
+ * \def QTPOKIT_TRACE_POINT
+ *
+ * Records a PokitTrace::Event at \a stage, with static string \a label, and trace point specific \a value, if built
+ * with `QTPOKIT_TRACE` defined (see the `ENABLE_TRACE` CMake option), or with a profiler (see the `TRACE_PROFILER`
+ * CMake option), in which case the event is also forwarded to the profiler. Otherwise, expands to an empty statement,
+ * so neither \a label nor \a value is evaluated.
+ */
+#if defined(QTPOKIT_TRACE) || defined(QTPOKIT_TRACE_PROFILER)
+  #define QTPOKIT_TRACE_POINT(stage, label, value) \
+    QTPOKIT_PREPEND_NAMESPACE(PokitTrace)::record(QTPOKIT_PREPEND_NAMESPACE(PokitTrace)::Stage::stage, label, value)
+#else
+  #define QTPOKIT_TRACE_POINT(stage, label, value) do { } while (false)
+#endif
+
+/*!
+ * \def QTPOKIT_TRACE_ZONE
+ *
+ * Begins a profiler zone (a Tracy zone, or a Perfetto track event slice) at \a stage, with static string \a label,
+ * which ends with the enclosing scope, if built with a profiler (see the `TRACE_PROFILER` CMake option). Otherwise,
+ * expands to an empty statement.
+ */
+
+/*!
+ * \def QTPOKIT_TRACE_FRAME_MARK
+ *
+ * Marks the end of a frame, such as a GUI render tick, with static string \a name, if built with a profiler (see the
+ * `TRACE_PROFILER` CMake option). Otherwise, expands to an empty statement.
+ */
+
+/*!
+ * \def QTPOKIT_TRACE_THREAD_NAME
+ *
+ * Names the current thread \a name (which is copied) in the profiler's timeline, if built with a profiler (see the
+ * `TRACE_PROFILER` CMake option). Otherwise, expands to an empty statement, so \a name is not evaluated.
+ */
+#ifdef QTPOKIT_TRACE_PROFILER
+  #define QTPOKIT_TRACE_CONCAT_(lhs, rhs) lhs##rhs
+  #define QTPOKIT_TRACE_CONCAT(lhs, rhs) QTPOKIT_TRACE_CONCAT_(lhs, rhs)
+  #define QTPOKIT_TRACE_ZONE(stage, label) \
+    const QTPOKIT_PREPEND_NAMESPACE(PokitTrace)::Zone QTPOKIT_TRACE_CONCAT(qtpokitTraceZone, __LINE__)( \
+        QTPOKIT_PREPEND_NAMESPACE(PokitTrace)::Stage::stage, label)
+  #define QTPOKIT_TRACE_FRAME_MARK(name) QTPOKIT_PREPEND_NAMESPACE(PokitTrace)::markFrame(name)
+  #define QTPOKIT_TRACE_THREAD_NAME(name) QTPOKIT_PREPEND_NAMESPACE(PokitTrace)::setThreadName(name)
+#else
+  #define QTPOKIT_TRACE_ZONE(stage, label) do { } while (false)
+  #define QTPOKIT_TRACE_FRAME_MARK(name) do { } while (false)
+  #define QTPOKIT_TRACE_THREAD_NAME(name) do { } while (false)
+#endif
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POKITTRACE_H
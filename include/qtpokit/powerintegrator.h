@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PowerIntegrator class.
+ */
+
+#ifndef QTPOKIT_POWERINTEGRATOR_H
+#define QTPOKIT_POWERINTEGRATOR_H
+
+#include "qtpokit_global.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class PowerIntegratorPrivate;
+
+class QTPOKIT_EXPORT PowerIntegrator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Maximum number of samples buffered per channel, while waiting for the other channel to catch up.
+    static constexpr int maxPendingSamples { 1024 };
+
+    /// Derived power, and the running totals, as of a single point in time.
+    struct Result {
+        qint64 timestamp;    ///< Time of this result, in milliseconds since the epoch.
+        float voltage;       ///< Voltage at #timestamp, in volts, interpolated if necessary.
+        float current;       ///< Current at #timestamp, in amps, interpolated if necessary.
+        float power;         ///< Instantaneous power (ie #voltage times #current), in watts.
+        double averagePower; ///< Average power over the integrated #duration, in watts, or #power if none yet.
+        double energy;       ///< Energy integrated so far, in watt-hours.
+        double charge;       ///< Charge integrated so far, in amp-hours.
+        qint64 duration;     ///< Total time integrated so far, in milliseconds, excluding any gaps.
+    };
+
+    explicit PowerIntegrator(QObject * parent = nullptr);
+    virtual ~PowerIntegrator();
+
+    quint32 maximumGap() const;
+    void setMaximumGap(const quint32 gap);
+
+    bool hasResult() const;
+    Result result() const;
+
+public Q_SLOTS:
+    void addVoltage(const float volts, const qint64 timestamp);
+    void addCurrent(const float amps, const qint64 timestamp);
+    void reset();
+
+Q_SIGNALS:
+    void resultReady(const PowerIntegrator::Result &result);
+
+protected:
+    /// \cond internal
+    PowerIntegratorPrivate * d_ptr; ///< Internal d-pointer.
+    PowerIntegrator(PowerIntegratorPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(PowerIntegrator)
+    Q_DISABLE_COPY(PowerIntegrator)
+    QTPOKIT_BEFRIEND_TEST(PowerIntegrator)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POWERINTEGRATOR_H
@@ -109,11 +109,11 @@
 /*!
  * \def QTPOKIT_BEFRIEND_TEST
  *
- * Macro for befriending a related unit test class, but only when QT_TESTLIB_LIB is defined.
+ * Macro for befriending related unit test and benchmark classes, but only when QT_TESTLIB_LIB is defined.
  */
 
 #ifdef QT_TESTLIB_LIB
-  #define QTPOKIT_BEFRIEND_TEST(Class) friend class Test##Class;
+  #define QTPOKIT_BEFRIEND_TEST(Class) friend class Test##Class; friend class Bench##Class;
 #else
   #define QTPOKIT_BEFRIEND_TEST(Class)
 #endif
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the QuantileSketch class.
+ */
+
+#ifndef QTPOKIT_QUANTILESKETCH_H
+#define QTPOKIT_QUANTILESKETCH_H
+
+#include "qtpokit_global.h"
+
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT QuantileSketch
+{
+public:
+    /// Default accuracy parameter; that is, percentiles are typically within about 1% (of the count) of their rank.
+    static constexpr int defaultAccuracy { 200 };
+
+    explicit QuantileSketch(const int accuracy = defaultAccuracy);
+
+    void add(const float value);
+    void merge(const QuantileSketch &other);
+    void reset();
+
+    int accuracy() const;
+    bool isEmpty() const;
+    quint64 count() const;
+    float minimum() const;
+    float maximum() const;
+    double mean() const;
+    float percentile(const double percent) const;
+    qsizetype retainedCount() const;
+
+private:
+    int k;                          ///< Accuracy parameter, being the capacity of the highest level.
+    QVector<QVector<float>> levels; ///< Retained values per level, with each level-n value weighted 2^n.
+    qsizetype retained { 0 };       ///< Total number of values retained, across all levels.
+    quint64 total { 0 };            ///< Number of values added.
+    float min { 0.0f };             ///< Smallest value added, if any.
+    float max { 0.0f };             ///< Largest value added, if any.
+    double sum { 0.0 };             ///< Sum of all values added.
+    bool oddOffset { false };       ///< Whether the next compaction keeps the odd, rather than even, values.
+
+    qsizetype capacity(const int level) const;
+    qsizetype maximumRetained() const;
+    void compress();
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_QUANTILESKETCH_H
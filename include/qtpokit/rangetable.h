@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the RangeInfo struct, and the RangeTable namespace, for describing Pokit products' measurement ranges.
+ */
+
+#ifndef QTPOKIT_RANGETABLE_H
+#define QTPOKIT_RANGETABLE_H
+
+#include "qtpokit_global.h"
+
+#include <array>
+#include <cstddef>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// Describes a single measurement range of a Pokit product.
+template<typename Range>
+struct RangeInfo {
+    Range range;          ///< The range's enumerator.
+    quint32 maxValue;     ///< The range's maximum value, in the range's (integral) units, such as millivolts.
+    const char * label;   ///< The range's (untranslated) label, in the product's translation context.
+};
+
+/*!
+ * Compile-time lookups over tables of RangeInfo, such as PokitMeter::voltageRanges.
+ *
+ * Range tables must list every range (except AutoRange) in order of the ranges' enumerator values, which must start
+ * from 0, and increase with the ranges' maximum values. This is verified at compile time, via isValid(), and allows
+ * ranges to be found by index, and minimum ranges by binary search.
+ */
+namespace RangeTable {
+
+/*!
+ * Returns \c true if \a table's ranges are numbered consecutively from 0, with strictly increasing maximum values.
+ */
+template<typename Range, std::size_t N>
+constexpr bool isValid(const std::array<RangeInfo<Range>, N> &table)
+{
+    for (std::size_t index = 0; index < N; ++index) {
+        if ((static_cast<std::size_t>(table[index].range) != index) || (table[index].maxValue == 0) ||
+            ((index > 0) && (table[index].maxValue <= table[index - 1].maxValue))) {
+            return false;
+        }
+    }
+    return (N > 0);
+}
+
+/*!
+ * Returns \a table's entry for \a range, or \c nullptr if \a range is not in \a table (such as AutoRange).
+ */
+template<typename Range, std::size_t N>
+constexpr const RangeInfo<Range> * find(const std::array<RangeInfo<Range>, N> &table, const Range range)
+{
+    const std::size_t index = static_cast<std::size_t>(range);
+    return ((index < N) && (table[index].range == range)) ? &table[index] : nullptr;
+}
+
+/*!
+ * Returns the maximum value of \a range, or 0 if \a range is not known to \a table. The maximum value of AutoRange is
+ * that of \a table's highest range.
+ */
+template<typename Range, std::size_t N>
+constexpr quint32 maxValue(const std::array<RangeInfo<Range>, N> &table, const Range range)
+{
+    if (range == Range::AutoRange) {
+        return table[N - 1].maxValue;
+    }
+    const RangeInfo<Range> * const info = find(table, range);
+    return (info == nullptr) ? 0 : info->maxValue;
+}
+
+/*!
+ * Returns the lowest of \a table's ranges that can measure at least up to \a value, or AutoRange if \a value is 0,
+ * or higher than all of \a table's ranges.
+ */
+template<typename Range, std::size_t N>
+constexpr Range minRange(const std::array<RangeInfo<Range>, N> &table, const quint32 value)
+{
+    if (value == 0) {
+        return Range::AutoRange;
+    }
+    std::size_t first = 0, last = N; // Binary search (std::lower_bound is not constexpr until C++20).
+    while (first < last) {
+        const std::size_t middle = first + (last - first) / 2;
+        if (table[middle].maxValue < value) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return (first < N) ? table[first].range : Range::AutoRange;
+}
+
+/*!
+ * Returns \c true if \a value (in \a range's units) is at, or beyond, the limits of \a range, such that a (fixed)
+ * \a range measurement of \a value is likely to have been clipped. Returns \c false for AutoRange, and unknown ranges.
+ */
+template<typename Range, std::size_t N>
+constexpr bool isSaturated(const std::array<RangeInfo<Range>, N> &table, const Range range, const double value)
+{
+    const RangeInfo<Range> * const info = find(table, range);
+    return (info != nullptr) && ((value >= info->maxValue) || (-value >= info->maxValue));
+}
+
+} // namespace RangeTable
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_RANGETABLE_H
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the ReferenceClock class.
+ */
+
+#ifndef QTPOKIT_REFERENCECLOCK_H
+#define QTPOKIT_REFERENCECLOCK_H
+
+#include "qtpokit_global.h"
+
+#include <QObject>
+#include <QString>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class ReferenceClockPrivate;
+
+class QTPOKIT_EXPORT ReferenceClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// References that host timestamps may be disciplined against.
+    enum class Source : quint8 {
+        System = 0, ///< The system clock alone, with no bound on its error.
+        Ntp    = 1, ///< The system clock, as disciplined by NTP (such as via chronyd, or ntpd), and its error bound.
+        Ptp    = 2, ///< A PTP hardware clock (PHC), such as one disciplined by ptp4l.
+    };
+    static QString toString(const Source source);
+
+    /// A host timestamp, disciplined against the reference, with a bound on its error.
+    struct Timestamp {
+        qint64 time { 0 };         ///< Milliseconds since the epoch, on the reference's timeline.
+        qint64 uncertainty { -1 }; ///< Bound on #time's error, in microseconds, or -1 if unbounded (unsynchronised).
+    };
+
+    /// The result of the latest comparison of the system clock with the reference.
+    struct Status {
+        Source source { Source::System }; ///< Reference compared against.
+        bool synchronised { false };      ///< Whether the reference is synchronised, and so #uncertainty bounded.
+        qint64 offset { 0 };              ///< Reference time minus system time, in microseconds.
+        qint64 uncertainty { -1 };        ///< Bound on #offset's error, in microseconds, or -1 if unbounded.
+        qint64 updated { 0 };             ///< System time of the comparison, in milliseconds since the epoch.
+        QString error;                    ///< Why the comparison failed, if it did.
+    };
+
+    static constexpr int defaultUpdateInterval { 1000 }; ///< Default interval between comparisons, in milliseconds.
+    static constexpr double maximumDrift { 500.0 };      ///< Assumed worst-case drift since a comparison, in ppm.
+
+    explicit ReferenceClock(QObject * parent = nullptr);
+    virtual ~ReferenceClock();
+
+    Source source() const;
+    QString device() const;
+    bool setSource(const Source source, const QString &device = QString());
+    QString errorString() const;
+
+    int updateInterval() const;
+    void setUpdateInterval(const int interval);
+
+    Status status() const;
+    Timestamp now() const;
+    Timestamp toReference(const qint64 systemTime) const;
+
+public Q_SLOTS:
+    bool update();
+
+Q_SIGNALS:
+    void synchronisedChanged(const bool synchronised);
+
+protected:
+    /// \cond internal
+    ReferenceClockPrivate * d_ptr; ///< Internal d-pointer.
+    ReferenceClock(ReferenceClockPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(ReferenceClock)
+    Q_DISABLE_COPY(ReferenceClock)
+    QTPOKIT_BEFRIEND_TEST(ReferenceClock)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_REFERENCECLOCK_H
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the Resampler class.
+ */
+
+#ifndef QTPOKIT_RESAMPLER_H
+#define QTPOKIT_RESAMPLER_H
+
+#include "qtpokit_global.h"
+
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class ResamplerPrivate;
+
+class QTPOKIT_EXPORT Resampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Maximum number of samples (or decimated bins) buffered per channel, while waiting for other channels.
+    static constexpr int maxPendingSamples { 4096 };
+
+    /// How each channel's samples are converted to values at the grid's times.
+    enum class Method : quint8 {
+        Linear   = 0, ///< Linearly interpolate between the samples either side of each grid time.
+        Hold     = 1, ///< Hold the latest sample at, or before, each grid time (ie zero-order hold).
+        Decimate = 2, ///< Average the samples within half a period either side of each grid time.
+    };
+
+    explicit Resampler(const int channels, QObject * parent = nullptr);
+    virtual ~Resampler();
+
+    int channelCount() const;
+
+    Method method() const;
+    void setMethod(const Method method);
+
+    quint32 period() const;
+    void setPeriod(const quint32 period);
+
+    quint32 maximumGap() const;
+    void setMaximumGap(const quint32 gap);
+
+public Q_SLOTS:
+    void addSample(const int channel, const float value, const qint64 timestamp);
+    void flush();
+    void reset();
+
+Q_SIGNALS:
+    void rowReady(const qint64 timestamp, const QVector<float> &values);
+
+protected:
+    /// \cond internal
+    ResamplerPrivate * d_ptr; ///< Internal d-pointer.
+    Resampler(ResamplerPrivate * const d, const int channels, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(Resampler)
+    Q_DISABLE_COPY(Resampler)
+    QTPOKIT_BEFRIEND_TEST(Resampler)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_RESAMPLER_H
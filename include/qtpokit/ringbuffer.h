@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares and defines the RingBuffer class template.
+ */
+
+#ifndef QTPOKIT_RINGBUFFER_H
+#define QTPOKIT_RINGBUFFER_H
+
+#include "memorybudget.h"
+#include "qtpokit_global.h"
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class RingBuffer
+ *
+ * The RingBuffer class template provides a fixed-capacity, lock-free, single-producer/single-consumer queue of \a T
+ * values.
+ *
+ * This allows the thread that owns a Pokit service's QLowEnergyController (the single producer) to hand off parsed
+ * samples or readings (see DsoService::setSamplesBuffer(), DataLoggerService::setSamplesBuffer() and
+ * MultimeterService::setReadingsBuffer()) to a consumer on another thread, such that a slow consumer (such as a disk
+ * or network sink) does not stall BLE event handling.
+ *
+ * When the buffer is full, push() either drops the oldest value (OverflowPolicy::DropOldest), or waits for the
+ * consumer to pop() one (OverflowPolicy::Block). Either way, overflowCount() counts the number of pushes that found
+ * the buffer full, and droppedCount() the number of values dropped as a result.
+ *
+ * Each slot carries its own sequence number, so the producer can safely drop the oldest value, even while the
+ * consumer is popping it, without either side taking a lock.
+ *
+ * Since the buffer's capacity is fixed, its slots are accounted against the global MemoryBudget once, on construction,
+ * as memory the buffer cannot decline to hold. Values that themselves share memory (such as QVector samples) are
+ * accounted by whatever allocated them, such as a SamplePool.
+ */
+template<typename T>
+class RingBuffer
+{
+public:
+    /// Policies for pushing values into a full buffer.
+    enum class OverflowPolicy {
+        DropOldest, ///< Drop the oldest value, to make room for the new one.
+        Block,      ///< Wait (yielding) for the consumer to make room for the new one.
+    };
+
+    /*!
+     * Constructs a new ring buffer, with room for \a capacity values, and overflow \a policy.
+     */
+    explicit RingBuffer(const quint32 capacity, const OverflowPolicy policy = OverflowPolicy::DropOldest)
+        : slotCount(qMax(capacity, 1u)), overflowPolicy(policy), slots(new Slot[slotCount]),
+          memory(QStringLiteral("ringBuffer"), MemoryBudget::Kind::RingBuffer)
+    {
+        for (quint32 index = 0; index < slotCount; ++index) {
+            slots[index].sequence.store(2 * index, std::memory_order_relaxed);
+        }
+        memory.charge((qint64)slotCount * (qint64)sizeof(Slot));
+    }
+
+    /// Returns the maximum number of values this buffer can hold.
+    quint32 capacity() const { return slotCount; }
+
+    /// Returns this buffer's overflow policy.
+    OverflowPolicy policy() const { return overflowPolicy; }
+
+    /*!
+     * Returns the number of values currently in this buffer. This is only a snapshot if either the producer or
+     * consumer is active on another thread.
+     */
+    quint32 size() const
+    {
+        const quint64 tail = readPosition.load(std::memory_order_acquire);
+        const quint64 head = writePosition.load(std::memory_order_acquire);
+        return (head > tail) ? (quint32)qMin<quint64>(head - tail, slotCount) : 0;
+    }
+
+    /// Returns \c true if this buffer currently holds no values.
+    bool isEmpty() const { return size() == 0; }
+
+    /// Returns the number of pushes that have found this buffer full.
+    quint64 overflowCount() const { return overflows.load(std::memory_order_relaxed); }
+
+    /// Returns the number of values dropped, to make room for newer ones, under OverflowPolicy::DropOldest.
+    quint64 droppedCount() const { return drops.load(std::memory_order_relaxed); }
+
+    /*!
+     * Pushes \a value into this buffer. Must only be called by the (single) producer thread.
+     *
+     * If the buffer is full, then the oldest value is dropped, or this function waits for the consumer to pop() one,
+     * according to policy().
+     */
+    void push(T value)
+    {
+        const quint64 position = writePosition.load(std::memory_order_relaxed);
+        Slot &slot = slots[position % slotCount];
+        for (bool overflowed = false; slot.sequence.load(std::memory_order_acquire) != 2 * position;) {
+            // The slot still holds the oldest value (position - capacity), or the consumer is popping it.
+            if (!overflowed) {
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                overflowed = true;
+            }
+            if (overflowPolicy == OverflowPolicy::DropOldest) {
+                quint64 oldest = position - slotCount;
+                if (readPosition.compare_exchange_strong(oldest, oldest + 1, std::memory_order_acq_rel)) {
+                    drops.fetch_add(1, std::memory_order_relaxed);
+                    break; // The oldest value is now ours to overwrite.
+                }
+            }
+            std::this_thread::yield(); // Wait for the consumer to finish popping (or to make room).
+        }
+        slot.value = std::move(value);
+        slot.sequence.store(2 * position + 1, std::memory_order_release);
+        writePosition.store(position + 1, std::memory_order_release);
+    }
+
+    /*!
+     * Pops the oldest value from this buffer into \a value, and returns \c true, or returns \c false if this buffer is
+     * empty. Must only be called by the (single) consumer thread.
+     */
+    bool pop(T &value)
+    {
+        quint64 position = readPosition.load(std::memory_order_acquire);
+        for (;;) {
+            Slot &slot = slots[position % slotCount];
+            const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == 2 * position + 1) {
+                // Claim the value, unless the producer has just dropped it.
+                if (readPosition.compare_exchange_weak(position, position + 1, std::memory_order_acq_rel)) {
+                    value = std::move(slot.value);
+                    slot.sequence.store(2 * (position + slotCount), std::memory_order_release);
+                    return true;
+                }
+            } else if (sequence > 2 * position + 1) {
+                position = readPosition.load(std::memory_order_acquire); // Dropped, and overwritten, already.
+            } else {
+                return false; // Not yet written (or being overwritten after a drop).
+            }
+        }
+    }
+
+private:
+    /// A single value, and the position it was most recently written at, or is next writable at.
+    struct Slot {
+        std::atomic<quint64> sequence { 0 }; ///< Position of #value, doubled, plus one if readable.
+        T value {};                          ///< Value most recently pushed to this slot.
+    };
+
+    const quint32 slotCount;              ///< Maximum number of values this buffer can hold.
+    const OverflowPolicy overflowPolicy;  ///< What push() does when this buffer is full.
+    std::unique_ptr<Slot[]> slots;        ///< Storage for this buffer's values.
+    MemoryBudget::Stream memory;          ///< Accounts for #slots.
+    alignas(64) std::atomic<quint64> writePosition { 0 }; ///< Position of the next push(), by the producer.
+    alignas(64) std::atomic<quint64> readPosition { 0 };  ///< Position of the next pop(), by consumer or producer.
+    std::atomic<quint64> overflows { 0 }; ///< Number of pushes that found this buffer full.
+    std::atomic<quint64> drops { 0 };     ///< Number of values dropped under OverflowPolicy::DropOldest.
+
+    Q_DISABLE_COPY(RingBuffer)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_RINGBUFFER_H
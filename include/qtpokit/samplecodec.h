@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SampleCodec namespace.
+ */
+
+#ifndef QTPOKIT_SAMPLECODEC_H
+#define QTPOKIT_SAMPLECODEC_H
+
+#include "qtpokit_global.h"
+
+#include <QByteArray>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// Compresses slowly varying sample series, such as DSO and data logger samples, via zigzag varint deltas.
+namespace SampleCodec {
+
+    QTPOKIT_EXPORT qsizetype maxEncodedSize(const qsizetype count);
+
+    QTPOKIT_EXPORT qsizetype encode(const qint16 * const samples, const qsizetype count, char * const data,
+                                    const qint16 previous = 0);
+    QTPOKIT_EXPORT QByteArray encode(const QVector<qint16> &samples, const qint16 previous = 0);
+
+    QTPOKIT_EXPORT qsizetype decode(const char * const data, const qsizetype size, qint16 * const samples,
+                                    const qsizetype count, const qint16 previous = 0);
+    QTPOKIT_EXPORT QVector<qint16> decode(const QByteArray &data, bool * const ok = nullptr);
+
+}
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SAMPLECODEC_H
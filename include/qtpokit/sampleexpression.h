@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SampleExpression class.
+ */
+
+#ifndef QTPOKIT_SAMPLEEXPRESSION_H
+#define QTPOKIT_SAMPLEEXPRESSION_H
+
+#include "qtpokit_global.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT SampleExpression
+{
+    Q_DECLARE_TR_FUNCTIONS(SampleExpression)
+
+public:
+    static constexpr qsizetype chunkSize { 256 }; ///< Values processed by each instruction, per pass.
+    static constexpr int maximumDepth { 64 };     ///< Maximum nesting of parentheses, and function calls.
+
+    SampleExpression();
+    explicit SampleExpression(const QString &formula, const QStringList &variables = { });
+
+    bool compile(const QString &formula, const QStringList &variables = { });
+    bool isValid() const;
+    QString formula() const;
+    QStringList variables() const;
+    QString errorString() const;
+    qsizetype instructionCount() const;
+
+    float evaluate(const QVector<float> &values) const;
+    void evaluate(const QVector<const float *> &inputs, float * const output, const qsizetype count) const;
+
+private:
+    /// Operations that instructions may perform, element-wise, on their operands.
+    enum class Op : quint8 {
+        Neg, Not, Abs, Sqrt, Exp, Log, Log10, Sin, Cos, Tan, Floor, Ceil, Round,   // Unary.
+        Add, Sub, Mul, Div, Mod, Pow, Min, Max, Lt, Le, Gt, Ge, Eq, Ne, And, Or,   // Binary.
+        Select,                                                                    // Ternary.
+    };
+
+    /// An instruction's operand.
+    struct Operand {
+        /// Kinds of operands.
+        enum class Kind : quint8 {
+            Variable  = 0, ///< One of the input variables, by index.
+            Temporary = 1, ///< A temporary, holding an earlier instruction's result, by index.
+            Constant  = 2, ///< A constant, broadcast to every element.
+        };
+        Kind kind { Kind::Constant }; ///< Kind of operand.
+        int index { 0 };              ///< Variable, or temporary, index, if not a constant.
+        float value { 0.0f };         ///< Value, if a constant.
+    };
+
+    /// A single instruction, applying #op to each element of its operands, into a temporary.
+    struct Instruction {
+        Op op;               ///< Operation to apply.
+        int arity;           ///< Number of #operands used.
+        Operand operands[3]; ///< Operands to apply #op to.
+        int target;          ///< Index of the temporary to write the results to.
+    };
+
+    class Compiler;
+
+    QString source;                 ///< Formula, as compiled.
+    QStringList names;              ///< Names of the input variables, in order.
+    QString error;                  ///< Why the formula failed to compile, if it did.
+    QVector<Instruction> program;   ///< Compiled instructions, in order of execution.
+    Operand result;                 ///< Operand holding the formula's result, once #program has executed.
+    int temporaries { 0 };          ///< Number of temporaries #program uses.
+    mutable QVector<float> scratch; ///< A #chunkSize buffer per temporary, reused by each evaluation.
+
+    static void execute(const Op op, const int arity, const float * const * const operands,
+                        const qsizetype * const strides, float * const output, const qsizetype count);
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SAMPLEEXPRESSION_H
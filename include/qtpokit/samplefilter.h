@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SampleFilter class.
+ */
+
+#ifndef QTPOKIT_SAMPLEFILTER_H
+#define QTPOKIT_SAMPLEFILTER_H
+
+#include "dataloggerservice.h"
+#include "dsoservice.h"
+
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class SampleFilterPrivate;
+
+class QTPOKIT_EXPORT SampleFilter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Frequency responses that biquad sections may be designed for.
+    enum class Response : quint8 {
+        Custom   = 0, ///< Coefficients given explicitly, and used as-is, regardless of the sample rate.
+        LowPass  = 1, ///< Second-order low-pass, designed for the sample rate.
+        HighPass = 2, ///< Second-order high-pass, designed for the sample rate.
+        Notch    = 3, ///< Second-order notch (band-stop), designed for the sample rate.
+    };
+
+    /// A single second-order (biquad) IIR section, in one of a cascade of sections.
+    struct Biquad {
+        Response response; ///< Response to design the coefficients for, or Response::Custom.
+        double frequency;  ///< Cutoff (or notch) frequency in Hz, if not Response::Custom.
+        double q;          ///< Quality factor, if not Response::Custom.
+        double b0;         ///< Feed-forward coefficient, normalised such that a0 is 1, if Response::Custom.
+        double b1;         ///< Feed-forward coefficient, normalised such that a0 is 1, if Response::Custom.
+        double b2;         ///< Feed-forward coefficient, normalised such that a0 is 1, if Response::Custom.
+        double a1;         ///< Feedback coefficient, normalised such that a0 is 1, if Response::Custom.
+        double a2;         ///< Feedback coefficient, normalised such that a0 is 1, if Response::Custom.
+    };
+
+    explicit SampleFilter(QObject * parent = nullptr);
+    explicit SampleFilter(DsoService * const service, QObject * parent = nullptr);
+    explicit SampleFilter(DataLoggerService * const service, QObject * parent = nullptr);
+    virtual ~SampleFilter();
+
+    AbstractPokitService * service() const;
+
+    QVector<Biquad> biquads() const;
+    void setBiquads(const QVector<Biquad> &sections);
+    QVector<float> firTaps() const;
+    void setFirTaps(const QVector<float> &taps);
+    bool isEmpty() const;
+
+    double sampleRate() const;
+    void setSampleRate(const double rate);
+    Biquad designed(const qsizetype section) const;
+
+    void process(float * const values, const qsizetype count);
+    void process(QVector<float> &values);
+
+    static Biquad lowPass(const double frequency, const double q = 0.7071067811865476);
+    static Biquad highPass(const double frequency, const double q = 0.7071067811865476);
+    static Biquad notch(const double frequency, const double q = 10.0);
+    static Biquad custom(const double b0, const double b1, const double b2, const double a1, const double a2);
+    static Biquad design(const Biquad &section, const double sampleRate);
+
+public Q_SLOTS:
+    void reset();
+
+Q_SIGNALS:
+    void samplesFiltered(const QVector<float> &values);
+
+protected:
+    /// \cond internal
+    SampleFilterPrivate * d_ptr; ///< Internal d-pointer.
+    SampleFilter(SampleFilterPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(SampleFilter)
+    Q_DISABLE_COPY(SampleFilter)
+    QTPOKIT_BEFRIEND_TEST(SampleFilter)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SAMPLEFILTER_H
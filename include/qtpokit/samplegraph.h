@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SampleGraph class.
+ */
+
+#ifndef QTPOKIT_SAMPLEGRAPH_H
+#define QTPOKIT_SAMPLEGRAPH_H
+
+#include "dsoservice.h"
+#include "eventdetector.h"
+#include "resampler.h"
+#include "sampleexpression.h"
+#include "samplefilter.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class SampleGraphPrivate;
+
+class QTPOKIT_EXPORT SampleGraph : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Kinds of stages within a sample graph.
+    enum class Stage : quint8 {
+        Source     = 0, ///< The graph's input, fed via addBlock(), addSamples() or addValue().
+        Filter     = 1, ///< Filters values via a SampleFilter.
+        Aggregate  = 2, ///< Averages values over fixed windows.
+        Detect     = 3, ///< Passes only the values within events detected by an EventDetector.
+        Resample   = 4, ///< Resamples values onto a regular grid via a Resampler.
+        Sink       = 5, ///< Emits blockReady() for each block received.
+        Expression = 6, ///< Derives values from those of its inputs via a SampleExpression.
+    };
+    static QString toString(const Stage stage);
+
+    /// A block of consecutive values, shared (not copied) by every stage it fans out to.
+    struct Block {
+        qint64 timestamp;      ///< Timestamp of the block's first value, in milliseconds since the epoch.
+        double interval;       ///< Interval between consecutive values, in milliseconds, or 0 if unknown.
+        QVector<float> values; ///< The block's values, implicitly shared.
+    };
+
+    /// Statistics of a single stage.
+    struct StageStatistics {
+        QString name;                ///< Name of the stage.
+        Stage stage;                 ///< Kind of stage.
+        QStringList inputs;          ///< Names of the stages this stage receives blocks from.
+        quint64 blocksIn { 0 };      ///< Number of blocks received.
+        quint64 valuesIn { 0 };      ///< Number of values received.
+        quint64 blocksOut { 0 };     ///< Number of blocks passed on (or, for sinks, emitted).
+        quint64 valuesOut { 0 };     ///< Number of values passed on (or, for sinks, emitted).
+        qint64 queueDepth { 0 };     ///< Number of values received, but not yet reflected in the stage's output.
+        qint64 peakQueueDepth { 0 }; ///< Largest #queueDepth reached.
+        qint64 busyTime { 0 };       ///< Time spent processing received blocks, in nanoseconds.
+        double throughput { 0.0 };   ///< Values processed per second of #busyTime, or 0 if none yet.
+    };
+
+    explicit SampleGraph(QObject * parent = nullptr);
+    virtual ~SampleGraph();
+
+    static QString sourceName();
+    QStringList stageNames() const;
+
+    bool addFilter(const QString &name, const QStringList &inputs, const QVector<SampleFilter::Biquad> &sections,
+                   const QVector<float> &taps = { });
+    bool addAggregator(const QString &name, const QStringList &inputs, const quint32 period);
+    bool addDetector(const QString &name, const QStringList &inputs, const EventDetector::Settings &settings);
+    bool addResampler(const QString &name, const QStringList &inputs, const quint32 period,
+                      const Resampler::Method method = Resampler::Method::Linear);
+    bool addExpression(const QString &name, const QStringList &inputs, const QString &formula);
+    bool addSink(const QString &name, const QStringList &inputs);
+
+    QVector<StageStatistics> statistics() const;
+
+public Q_SLOTS:
+    void addBlock(const SampleGraph::Block &block);
+    void addSamples(const DsoService::Samples &samples, const float scale, const qint64 timestamp,
+                    const double interval);
+    void addValue(const float value, const qint64 timestamp, const double interval = 0.0);
+    void flush();
+    void reset();
+
+Q_SIGNALS:
+    void blockReady(const QString &sink, const SampleGraph::Block &block);
+    void eventFinished(const QString &detector, const EventDetector::Event &event);
+
+protected:
+    /// \cond internal
+    SampleGraphPrivate * d_ptr; ///< Internal d-pointer.
+    SampleGraph(SampleGraphPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(SampleGraph)
+    Q_DISABLE_COPY(SampleGraph)
+    QTPOKIT_BEFRIEND_TEST(SampleGraph)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SAMPLEGRAPH_H
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SampleHistogram class.
+ */
+
+#ifndef QTPOKIT_SAMPLEHISTOGRAM_H
+#define QTPOKIT_SAMPLEHISTOGRAM_H
+
+#include "qtpokit_global.h"
+
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT SampleHistogram
+{
+public:
+    /// Maximum number of bins; finer resolutions are widened (by powers of two) to fit.
+    static constexpr int maxBinCount { 4096 };
+
+    SampleHistogram(const float lowerBound, const float upperBound, const float resolution);
+
+    static SampleHistogram forScale(const float scale);
+
+    void add(const float value);
+    bool merge(const SampleHistogram &other);
+    void reset();
+
+    float lowerBound() const;
+    float binWidth() const;
+    int binCount() const;
+    int binIndex(const float value) const;
+    float binValue(const int index) const;
+    quint64 binTotal(const int index) const;
+
+    bool isEmpty() const;
+    quint64 count() const;
+    float minimum() const;
+    float maximum() const;
+    double mean() const;
+    float percentile(const double percent) const;
+
+private:
+    float lower;             ///< Lower bound of the first bin.
+    float width;             ///< Width of every bin.
+    int bins;                ///< Number of bins.
+    QVector<quint64> counts; ///< Count of values added per bin, or empty if none yet.
+    quint64 total { 0 };     ///< Number of values added.
+    float min { 0.0f };      ///< Smallest value added, if any.
+    float max { 0.0f };      ///< Largest value added, if any.
+    double sum { 0.0 };      ///< Sum of all values added.
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SAMPLEHISTOGRAM_H
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares and defines the SamplePool class template.
+ */
+
+#ifndef QTPOKIT_SAMPLEPOOL_H
+#define QTPOKIT_SAMPLEPOOL_H
+
+#include "memorybudget.h"
+#include "qtpokit_global.h"
+
+#include <QVector>
+
+#include <atomic>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class SamplePool
+ *
+ * The SamplePool class template provides a small free list of reusable QVector<\a T> sample buffers.
+ *
+ * QVector is already implicitly shared (that is, reference counted), so samples emitted by a Pokit service are
+ * shared, not copied, by every queued connection, RingBuffer and sink that receives them. What implicit sharing alone
+ * does not avoid is the allocation of a fresh buffer for every notification. So services acquire() each
+ * notification's buffer from a pool instead, which hands back a buffer that every consumer has since released (that
+ * is, one the pool again holds the only reference to), resized in place, without touching the heap.
+ *
+ * A buffer is never reused while any consumer still holds a reference to it, no matter how slow (or far behind) that
+ * consumer is, since consumers only ever see the buffers as ordinary, implicitly shared, QVectors. When all of the
+ * pool's buffers are still in use, acquire() falls back to allocating a new buffer (outside of the pool), and counts
+ * that in overflowCount().
+ *
+ * The memory held by the pool's buffers is accounted against a MemoryBudget. If growing the pool (or one of its
+ * buffers) would exceed the pool's quota, or the budget's limit, then acquire() falls back to a buffer outside of the
+ * pool instead, just as it does when all of the pool's buffers are in use, so the memory the pool retains is bounded
+ * by its quota.
+ *
+ * The pool itself is not thread-safe, and must only be used by the thread that owns the service (the single
+ * producer). Consumers on other threads may release their references at any time, as usual.
+ */
+template<typename T>
+class SamplePool
+{
+public:
+    static constexpr qsizetype defaultCapacity { 16 }; ///< Default maximum number of buffers held by a pool.
+
+    /*!
+     * Constructs a new, empty, pool that will hold up to \a capacity buffers, accounted against \a budget as a
+     * stream called \a name.
+     */
+    explicit SamplePool(const qsizetype capacity = defaultCapacity, const QString &name = QStringLiteral("samplePool"),
+                        MemoryBudget * const budget = MemoryBudget::global())
+        : maxBuffers(qMax<qsizetype>(capacity, 1)), memory(name, MemoryBudget::Kind::SamplePool, budget)
+    {
+        buffers.reserve(maxBuffers);
+    }
+
+    /// Returns the maximum number of buffers this pool can hold.
+    qsizetype capacity() const { return maxBuffers; }
+
+    /// Returns the number of buffers this pool currently holds, whether in use, or not.
+    qsizetype size() const { return buffers.size(); }
+
+    /// Returns the number of buffers this pool currently holds that are no longer in use by any consumer.
+    qsizetype available() const
+    {
+        qsizetype count = 0;
+        for (const QVector<T> &buffer: buffers) {
+            count += (buffer.isDetached()) ? 1 : 0;
+        }
+        return count;
+    }
+
+    /// Returns the number of acquire() calls that reused one of this pool's buffers.
+    quint64 reuseCount() const { return reuses; }
+
+    /// Returns the number of buffers allocated to grow this pool (up to capacity()).
+    quint64 allocationCount() const { return allocations; }
+
+    /// Returns the number of acquire() calls that had to allocate a buffer outside of this pool, since all of the
+    /// pool's buffers were still in use.
+    quint64 overflowCount() const { return overflows; }
+
+    /// Returns this pool's memory budget stream, which accounts for the memory held by this pool's buffers.
+    const MemoryBudget::Stream &memoryStream() const { return memory; }
+
+    /*!
+     * Returns a buffer of \a size (uninitialised) values, that no consumer holds a reference to. The returned
+     * reference is only valid until the next call to acquire(), by which time the caller would typically have copied
+     * (that is, shared) the buffer into whatever signal or queue it's bound for.
+     *
+     * Buffers are reused round-robin, so the buffer most recently released is the last to be reused, giving slow
+     * consumers the most time to release theirs.
+     */
+    QVector<T> &acquire(const qsizetype size)
+    {
+        if (size <= 0) {
+            // Empty (including null) vectors are never detached under Qt 6, so could never be reused anyway.
+            spare = QVector<T>();
+            return spare;
+        }
+        for (qsizetype count = 0; count < buffers.size(); ++count) {
+            QVector<T> &buffer = buffers[next];
+            next = (next + 1) % buffers.size();
+            if (buffer.isDetached()) {
+                // Pairs with the (release) dereference by whichever consumer last released the buffer, so none of
+                // that consumer's reads can be reordered after our subsequent writes.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if ((size > buffer.capacity()) && (!memory.reserve(bytes(size - buffer.capacity())))) {
+                    break; // Growing the buffer would exceed the pool's quota, so fall back to a spare buffer.
+                }
+                buffer.resize(size); // Within the buffer's existing capacity, once the pool has warmed up.
+                ++reuses;
+                return buffer;
+            }
+        }
+        if ((buffers.size() < maxBuffers) && (memory.reserve(bytes(size)))) {
+            buffers.append(QVector<T>(size));
+            ++allocations;
+            return buffers.last();
+        }
+        spare = QVector<T>(size);
+        ++overflows;
+        return spare;
+    }
+
+private:
+    const qsizetype maxBuffers;  ///< Maximum number of buffers this pool can hold.
+    MemoryBudget::Stream memory; ///< Accounts for the memory held by #buffers.
+    QVector<QVector<T>> buffers; ///< This pool's buffers, some of which may still be in use by consumers.
+    QVector<T> spare;            ///< Buffer most recently returned from outside of #buffers, if any.
+    qsizetype next { 0 };        ///< Index of the next buffer to consider for reuse.
+    quint64 reuses { 0 };        ///< Number of acquire() calls that reused a buffer.
+    quint64 allocations { 0 };   ///< Number of buffers allocated to grow #buffers.
+    quint64 overflows { 0 };     ///< Number of acquire() calls that allocated outside of #buffers.
+
+    /// Returns the size, in bytes, of \a count values.
+    static qint64 bytes(const qsizetype count) { return (qint64)count * (qint64)sizeof(T); }
+
+    Q_DISABLE_COPY(SamplePool)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SAMPLEPOOL_H
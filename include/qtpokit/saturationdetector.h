@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SaturationDetector class.
+ */
+
+#ifndef QTPOKIT_SATURATIONDETECTOR_H
+#define QTPOKIT_SATURATIONDETECTOR_H
+
+#include "dataloggerservice.h"
+#include "dsoservice.h"
+
+#include <QByteArray>
+#include <QVector>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT SaturationDetector
+{
+public:
+    /// Magnitude of raw samples at the limits of their range, as per DsoService::Samples.
+    static constexpr qint16 fullScaleSample { 2047 };
+
+    /// A run of consecutive saturated samples.
+    struct Segment {
+        qint64 first; ///< Index of the run's first sample, counting all samples processed since the last reset().
+        qint64 count; ///< Number of samples in the run.
+    };
+
+    explicit SaturationDetector(const qint16 threshold = fullScaleSample);
+
+    static qint16 threshold(const PokitProduct product, const DsoService::Mode mode, const quint8 range,
+                            const float scale);
+    static qint16 threshold(const PokitProduct product, const DataLoggerService::Mode mode, const quint8 range,
+                            const float scale);
+    static quint8 nextRange(const PokitProduct product, const DsoService::Mode mode, const quint8 range);
+    static quint8 nextRange(const PokitProduct product, const DataLoggerService::Mode mode, const quint8 range);
+
+    qint16 threshold() const;
+    void setThreshold(const qint16 threshold);
+
+    QVector<Segment> process(const QVector<qint16> &samples);
+    QVector<Segment> processRaw(const QByteArray &samples);
+    std::optional<Segment> flush();
+    void reset();
+
+    qint64 sampleCount() const;
+    qint64 saturatedCount() const;
+    bool isSaturated() const;
+    int peak() const;
+
+private:
+    qint16 limit;              ///< Magnitude at, or beyond, which raw samples are saturated.
+    qint64 processed { 0 };    ///< Number of samples processed since the last reset().
+    qint64 saturated { 0 };    ///< Number of those samples that were saturated.
+    int maximum { 0 };         ///< Largest magnitude of those samples.
+    qint64 runStart { -1 };    ///< Index of the current run's first sample, or -1 if not within a run.
+
+    template<typename Sample> QVector<Segment> scan(const qsizetype size, const Sample &sample);
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SATURATIONDETECTOR_H
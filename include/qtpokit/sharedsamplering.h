@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SharedSampleRing class.
+ */
+
+#ifndef QTPOKIT_SHAREDSAMPLERING_H
+#define QTPOKIT_SHAREDSAMPLERING_H
+
+#include "dsoservice.h"
+#include "multimeterservice.h"
+
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class SharedSampleRingPrivate;
+
+class QTPOKIT_EXPORT SharedSampleRing : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Kinds of values published in a ring.
+    enum class Kind : quint8 {
+        None         = 0, ///< No value (such as an unused record).
+        MeterReading = 1, ///< A multimeter reading.
+        DsoSample    = 2, ///< A single DSO sample.
+        LoggerSample = 3, ///< A single data logger sample.
+    };
+
+    /// A single published value, as laid out (after each slot's own sequence number) in shared memory.
+    struct Record {
+        quint64 sequence { 0 };    ///< Record number, from 0, incrementing by one with each published record.
+        qint64 timestamp { 0 };    ///< Time of the value, in microseconds since the epoch.
+        float value { 0.0f };      ///< Value, in the mode's units (such as Volts or Amps).
+        quint16 source { 0 };      ///< Publisher-assigned source of the value, such as a device index.
+        Kind kind { Kind::None };  ///< Kind of value.
+        quint8 mode { 0 };         ///< Service-specific mode, such as MultimeterService::Mode.
+        quint8 range { 0 };        ///< Service-specific range.
+        quint8 status { 0 };       ///< Service-specific status, such as MultimeterService::MeterStatus.
+        quint8 reserved[6] { };    ///< Reserved for future use; always 0.
+    };
+
+    static constexpr quint32 defaultCapacity { 65536 }; ///< Capacity of rings created without an explicit one.
+
+    explicit SharedSampleRing(QObject * parent = nullptr);
+    virtual ~SharedSampleRing();
+
+    QString key() const;
+    bool isAttached() const;
+    bool isPublisher() const;
+    quint32 capacity() const;
+    QString errorString() const;
+
+    bool create(const QString &key, const quint32 capacity = defaultCapacity);
+    bool attach(const QString &key);
+    void detach();
+
+    quint64 published() const;
+    bool publish(const Record &record);
+    bool publish(const MultimeterService::Reading &reading, const qint64 timestamp, const quint16 source = 0);
+    bool publish(const DsoService::Metadata &metadata, const DsoService::Samples &samples, const qint64 timestamp,
+                 const qint64 interval, const quint16 source = 0);
+
+    quint64 nextSequence() const;
+    quint64 overrunCount() const;
+    qsizetype available() const;
+    qsizetype read(QVector<Record> &records, const qsizetype maxRecords = -1);
+
+protected:
+    /// \cond internal
+    SharedSampleRingPrivate * d_ptr; ///< Internal d-pointer.
+    SharedSampleRing(SharedSampleRingPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(SharedSampleRing)
+    Q_DISABLE_COPY(SharedSampleRing)
+    QTPOKIT_BEFRIEND_TEST(SharedSampleRing)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SHAREDSAMPLERING_H
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SoftwareTrigger class.
+ */
+
+#ifndef QTPOKIT_SOFTWARETRIGGER_H
+#define QTPOKIT_SOFTWARETRIGGER_H
+
+#include "dsoservice.h"
+#include "multimeterservice.h"
+
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class SoftwareTriggerPrivate;
+
+class QTPOKIT_EXPORT SoftwareTrigger : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Conditions that may trigger a segment.
+    enum class Condition : quint8 {
+        Level      = 0, ///< Value is at, or beyond, the trigger level.
+        Edge       = 1, ///< Value crosses the trigger level.
+        Window     = 2, ///< Value leaves the window between the lower and upper trigger levels.
+        PulseWidth = 3, ///< A pulse beyond the trigger level ends, with a width between the minimum and maximum.
+    };
+
+    /// Directions (or polarities) of values that may trigger a segment.
+    enum class Slope : quint8 {
+        Rising  = 0, ///< Rising to (or above) the level, or leaving the window's top, or positive pulses.
+        Falling = 1, ///< Falling to (or below) the level, or leaving the window's bottom, or negative pulses.
+        Either  = 2, ///< Either of the above.
+    };
+
+    /// Attributes of a software trigger.
+    struct Settings {
+        Condition condition; ///< Condition to trigger on.
+        Slope slope;         ///< Direction, or polarity, to trigger on.
+        float level;         ///< Trigger level, or the window's lower level, in the values' own units.
+        float upperLevel;    ///< The window's upper level, if Condition::Window.
+        float hysteresis;    ///< How far values must return past the level, before an edge or pulse may begin again.
+        quint32 minWidth;    ///< Minimum pulse width, in samples, if Condition::PulseWidth.
+        quint32 maxWidth;    ///< Maximum pulse width, in samples, if Condition::PulseWidth, or 0 for no maximum.
+        quint32 preTrigger;  ///< Maximum number of samples to include from before the trigger sample.
+        quint32 postTrigger; ///< Number of samples to include from the trigger sample onwards.
+    };
+
+    /// A triggered segment of consecutive samples.
+    struct Segment {
+        quint64 firstSample;    ///< Position, within the whole stream, of the segment's first value.
+        quint64 triggerSample;  ///< Position, within the whole stream, of the sample that triggered the segment.
+        QVector<float> values;  ///< The segment's values, from up to Settings::preTrigger values before the trigger.
+    };
+
+    explicit SoftwareTrigger(QObject * parent = nullptr);
+    explicit SoftwareTrigger(DsoService * const service, QObject * parent = nullptr);
+    explicit SoftwareTrigger(MultimeterService * const service, QObject * parent = nullptr);
+    virtual ~SoftwareTrigger();
+
+    AbstractPokitService * service() const;
+
+    Settings settings() const;
+    void setSettings(const Settings &settings);
+
+    bool isCapturing() const;
+    quint64 samplesProcessed() const;
+    quint64 triggerCount() const;
+
+    void process(const float * const values, const qsizetype count);
+    void process(const QVector<float> &values);
+
+    static Settings defaultSettings();
+    static bool isValid(const Settings &settings);
+
+public Q_SLOTS:
+    void flush();
+    void reset();
+
+Q_SIGNALS:
+    void triggered(const SoftwareTrigger::Segment &segment);
+
+protected:
+    /// \cond internal
+    SoftwareTriggerPrivate * d_ptr; ///< Internal d-pointer.
+    SoftwareTrigger(SoftwareTriggerPrivate * const d, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(SoftwareTrigger)
+    Q_DISABLE_COPY(SoftwareTrigger)
+    QTPOKIT_BEFRIEND_TEST(SoftwareTrigger)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SOFTWARETRIGGER_H
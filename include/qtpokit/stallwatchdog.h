@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the StallWatchdog class.
+ */
+
+#ifndef QTPOKIT_STALLWATCHDOG_H
+#define QTPOKIT_STALLWATCHDOG_H
+
+#include "qtpokit_global.h"
+
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class AbstractPokitService;
+class PokitDevice;
+class StallWatchdogPrivate;
+
+class QTPOKIT_EXPORT StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Recovery actions, in the order they are attempted for each stall.
+    enum class Action : quint8 {
+        ReenableNotifications, ///< Disable, and re-enable, all of the service's enabled notifications.
+        RewriteSettings,       ///< Re-write the service's last written settings (such as the multimeter's mode).
+        Reconnect,             ///< Disconnect the device, for its reconnection policy to reconnect, and resume.
+    };
+    static QString toString(const Action action);
+
+    explicit StallWatchdog(AbstractPokitService * const service, PokitDevice * const device = nullptr,
+                           QObject * parent = nullptr);
+    virtual ~StallWatchdog();
+
+    AbstractPokitService * service() const;
+    PokitDevice * device() const;
+
+    quint32 expectedInterval() const;
+    void setExpectedInterval(const quint32 interval);
+    quint32 learnedInterval() const;
+
+    float stallFactor() const;
+    void setStallFactor(const float factor);
+
+    quint32 minimumTimeout() const;
+    void setMinimumTimeout(const quint32 timeout);
+
+    quint32 stallTimeout() const;
+
+    bool isActive() const;
+    bool isStalled() const;
+    quint64 stallCount() const;
+    quint64 recoveryCount() const;
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+Q_SIGNALS:
+    void stalled(const qint64 elapsed);
+    void recoveryAttempted(const StallWatchdog::Action action, const int attempt);
+    void recovered(const qint64 duration);
+    void recoveryFailed();
+
+protected:
+    /// \cond internal
+    StallWatchdogPrivate * d_ptr; ///< Internal d-pointer.
+    StallWatchdog(StallWatchdogPrivate * const d, AbstractPokitService * const service, PokitDevice * const device,
+                  QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(StallWatchdog)
+    Q_DISABLE_COPY(StallWatchdog)
+    QTPOKIT_BEFRIEND_TEST(StallWatchdog)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_STALLWATCHDOG_H
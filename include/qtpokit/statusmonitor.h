@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the StatusMonitor class.
+ */
+
+#ifndef QTPOKIT_STATUSMONITOR_H
+#define QTPOKIT_STATUSMONITOR_H
+
+#include "statusservice.h"
+
+#include <QObject>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class StatusMonitorPrivate;
+
+class QTPOKIT_EXPORT StatusMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Alerts raised by StatusMonitor.
+    enum class Alert : quint8 {
+        LowBattery,       ///< The battery has become low.
+        BatteryRecovered, ///< The battery is no longer low, such as after charging, or replacement.
+        ChargingChanged,  ///< The battery's charging status has changed.
+    };
+    static QString toString(const Alert alert);
+
+    explicit StatusMonitor(StatusService * const service, QObject * parent = nullptr);
+    virtual ~StatusMonitor();
+
+    StatusService * service() const;
+
+    quint32 coalesceInterval() const;
+    void setCoalesceInterval(const quint32 interval);
+
+    float batteryDeadband() const;
+    void setBatteryDeadband(const float deadband);
+
+    float lowBatteryThreshold() const;
+    void setLowBatteryThreshold(const float threshold);
+
+    std::optional<StatusService::Status> lastStatus() const;
+    bool isBatteryLow() const;
+
+    quint64 notificationCount() const;
+    quint64 changeCount() const;
+
+public Q_SLOTS:
+    void addStatus(const StatusService::Status &status);
+    void flush();
+    void reset();
+
+Q_SIGNALS:
+    void statusChanged(const StatusService::Status &status);
+    void alertRaised(const StatusMonitor::Alert alert, const StatusService::Status &status);
+
+protected:
+    /// \cond internal
+    StatusMonitorPrivate * d_ptr; ///< Internal d-pointer.
+    StatusMonitor(StatusMonitorPrivate * const d, StatusService * const service, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(StatusMonitor)
+    Q_DISABLE_COPY(StatusMonitor)
+    QTPOKIT_BEFRIEND_TEST(StatusMonitor)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_STATUSMONITOR_H
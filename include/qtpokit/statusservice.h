@@ -154,7 +154,9 @@ public:
     // Status characteristic (Meter: read, Pro: read/notify).
     Status status() const;
     bool enableStatusNotifications();
+    QFuture<bool> enableStatusNotificationsAsync();
     bool disableStatusNotifications();
+    QFuture<bool> disableStatusNotificationsAsync();
 
     // Device Name characteristic (Both read/write).
     QString deviceName() const;
@@ -167,12 +169,16 @@ public:
     std::optional<TorchStatus> torchStatus() const;
     bool setTorchStatus(const TorchStatus status);
     bool enableTorchStatusNotifications();
+    QFuture<bool> enableTorchStatusNotificationsAsync();
     bool disableTorchStatusNotifications();
+    QFuture<bool> disableTorchStatusNotificationsAsync();
 
     // Undocumented Button Press characteristic (Pro only: read/write/notify).
     std::optional<ButtonStatus> buttonPress() const;
     bool enableButtonPressedNotifications();
+    QFuture<bool> enableButtonPressedNotificationsAsync();
     bool disableButtonPressedNotifications();
+    QFuture<bool> disableButtonPressedNotificationsAsync();
 
 Q_SIGNALS:
     void deviceCharacteristicsRead(const StatusService::DeviceCharacteristics &characteristics);
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the ThreadPolicy class.
+ */
+
+#ifndef QTPOKIT_THREADPOLICY_H
+#define QTPOKIT_THREADPOLICY_H
+
+#include "qtpokit_global.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT ThreadPolicy
+{
+    Q_DECLARE_TR_FUNCTIONS(ThreadPolicy)
+
+public:
+    /// Scheduling priorities that may be requested for a thread.
+    enum class Priority : quint8 {
+        Normal   = 0, ///< The thread's existing (normally, the OS's default) scheduling, left unchanged.
+        High     = 1, ///< Elevated, but not real-time, priority, such as a negative nice value on Linux.
+        Realtime = 2, ///< Real-time scheduling, such as `SCHED_FIFO` on Linux, or time-critical priority on Windows.
+    };
+    static QString toString(const Priority priority);
+
+    static constexpr int defaultRealtimePriority { 10 }; ///< Default `SCHED_FIFO` priority, for Priority::Realtime.
+
+    /// Settings to apply to a thread.
+    struct Settings {
+        QVector<int> cpus;                                ///< CPUs to pin the thread to, or empty to not pin it.
+        Priority priority { Priority::Normal };           ///< Scheduling priority to request.
+        int realtimePriority { defaultRealtimePriority }; ///< Real-time priority, for Priority::Realtime.
+    };
+
+    /// A thread's effective settings.
+    struct State {
+        bool applied { false };                 ///< Whether any settings have been applied to the thread.
+        QVector<int> cpus;                      ///< CPUs the thread may run on, or empty if unknown.
+        Priority priority { Priority::Normal }; ///< Thread's effective scheduling priority.
+        int realtimePriority { 0 };             ///< Thread's real-time priority, if Priority::Realtime, otherwise 0.
+        QStringList errors;                     ///< Why any of the requested settings could not be applied.
+    };
+
+    static State apply(const Settings &settings);
+    static State current();
+
+    static QVector<int> parseCpus(const QString &list, bool * const ok = nullptr);
+    static QString formatCpus(const QVector<int> &cpus);
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_THREADPOLICY_H
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the TrafficRecorder class.
+ */
+
+#ifndef QTPOKIT_TRAFFICRECORDER_H
+#define QTPOKIT_TRAFFICRECORDER_H
+
+#include "qtpokit_global.h"
+
+#include <QBluetoothUuid>
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class AbstractPokitService;
+class TrafficRecorderPrivate;
+
+class QTPOKIT_EXPORT TrafficRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Characteristic operations recorded.
+    enum class Operation : quint8 {
+        Read   = 0, ///< Characteristic value read from the device.
+        Write  = 1, ///< Characteristic value written to (and acknowledged by) the device.
+        Notify = 2, ///< Characteristic value notified by the device.
+    };
+    static QString toString(const Operation operation);
+
+    /// A single recorded characteristic operation.
+    struct Record {
+        Operation operation;           ///< Characteristic operation.
+        QBluetoothUuid characteristic; ///< UUID of the characteristic operated on.
+        QByteArray value;              ///< Raw value read, written, or notified.
+        qint64 timestamp;              ///< Host time of the operation, in nanoseconds since the first record.
+    };
+
+    explicit TrafficRecorder(const QString &fileName, QObject * parent = nullptr);
+    virtual ~TrafficRecorder();
+
+    QString fileName() const;
+
+    void addService(AbstractPokitService * const service);
+    void removeService(AbstractPokitService * const service);
+
+    bool isRecording() const;
+    quint64 recordCount() const;
+
+public Q_SLOTS:
+    bool start();
+    void stop();
+
+protected:
+    /// \cond internal
+    TrafficRecorderPrivate * d_ptr; ///< Internal d-pointer.
+    TrafficRecorder(TrafficRecorderPrivate * const d, const QString &fileName, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(TrafficRecorder)
+    Q_DISABLE_COPY(TrafficRecorder)
+    QTPOKIT_BEFRIEND_TEST(TrafficRecorder)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_TRAFFICRECORDER_H
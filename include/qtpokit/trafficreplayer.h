@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the TrafficReplayer class.
+ */
+
+#ifndef QTPOKIT_TRAFFICREPLAYER_H
+#define QTPOKIT_TRAFFICREPLAYER_H
+
+#include "trafficrecorder.h"
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class AbstractPokitService;
+class TrafficReplayerPrivate;
+
+class QTPOKIT_EXPORT TrafficReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Pacing of replayed records.
+    enum class Pacing : quint8 {
+        Recorded         = 0, ///< Replay records at their recorded times.
+        AsFastAsPossible = 1, ///< Replay records back-to-back, as fast as the event loop allows.
+    };
+
+    explicit TrafficReplayer(const QString &fileName, QObject * parent = nullptr);
+    virtual ~TrafficReplayer();
+
+    QString fileName() const;
+
+    bool load();
+    QVector<TrafficRecorder::Record> records() const;
+
+    void addService(AbstractPokitService * const service);
+    void removeService(AbstractPokitService * const service);
+
+    Pacing pacing() const;
+    void setPacing(const Pacing pacing);
+
+    bool isReplaying() const;
+    quint64 replayedCount() const;
+    quint64 skippedCount() const;
+
+public Q_SLOTS:
+    bool start();
+    void stop();
+
+Q_SIGNALS:
+    void finished();
+
+protected:
+    /// \cond internal
+    TrafficReplayerPrivate * d_ptr; ///< Internal d-pointer.
+    TrafficReplayer(TrafficReplayerPrivate * const d, const QString &fileName, QObject * const parent);
+    /// \endcond
+
+private:
+    Q_DECLARE_PRIVATE(TrafficReplayer)
+    Q_DISABLE_COPY(TrafficReplayer)
+    QTPOKIT_BEFRIEND_TEST(TrafficReplayer)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_TRAFFICREPLAYER_H
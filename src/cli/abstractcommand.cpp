@@ -2,16 +2,37 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "abstractcommand.h"
+#include "outputfilewriter.h"
+#include "phasetimer.h"
 #include "../stringliterals_p.h"
 
+#include <qtpokit/memorybudget.h>
 #include <qtpokit/pokitdevice.h>
 #include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/pokittrace.h>
+#include <qtpokit/samplecodec.h>
 
+#include <QBluetoothUuid>
 #include <QLocale>
 #include <QTimer>
+#include <QtEndian>
 
+#include <charconv>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
 #include <ratio>
+#include <type_traits>
+#include <utility>
+
+#if defined(Q_OS_WIN)
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 DOKIT_USE_STRINGLITERALS
 
@@ -43,6 +64,22 @@ AbstractCommand::AbstractCommand(QObject * const parent) : QObject(parent),
             QCoreApplication::exit(EXIT_FAILURE);
         });
     });
+    outputBuffer.reserve(4096); // Reserved capacity is retained by flushOutput(), for re-use by later output.
+}
+
+/*!
+ * Destroys this command, first flushing any buffered output to stdout (or the output file), including the Arrow
+ * output's end-of-stream marker, if any Arrow output was written.
+ */
+AbstractCommand::~AbstractCommand()
+{
+    if (arrowSchemaWritten) {
+        writeArrowEndOfStream(outputBuffer);
+    }
+    flushOutput();
+    if (outputFile) {
+        outputFile->close(); // Blocks until all queued output has been written.
+    }
 }
 
 /*!
@@ -87,10 +124,19 @@ QStringList AbstractCommand::requiredOptions(const QCommandLineParser &parser) c
 QStringList AbstractCommand::supportedOptions(const QCommandLineParser &parser) const
 {
     return requiredOptions(parser) + QStringList{
+        u"async-log"_s,
+        u"backpressure"_s,
         u"debug"_s,
         u"device"_s, u"d"_s,
+        u"flush"_s,
+        u"memory-budget"_s,
         u"output"_s,
+        u"output-file"_s,
+        u"rotate-interval"_s,
+        u"rotate-size"_s,
         u"timeout"_s,
+        u"timings"_s,
+        u"trace"_s,
     };
 }
 
@@ -113,6 +159,517 @@ QString AbstractCommand::escapeCsvField(const QString &field)
     } else return field;
 }
 
+/*!
+ * Returns \a string as an RFC 8259 compliant, UTF-8 encoded JSON string. That is, \a string is surrounded in
+ * double-quotes, with any double-quotes, backslashes and control characters escaped.
+ *
+ * This is much cheaper than wrapping \a string in a QJsonDocument, so is used for NDJSON output, which may be
+ * written for every sample.
+ *
+ * Some examples:
+ * ```
+ * QCOMPARE(escapeJsonString("abc"), R"("abc")");        // Just wrapped in double-quotes.
+ * QCOMPARE(escapeJsonString(R"(a"c)"), R"("a\"c")");    // Existing double-quotes escaped, then wrapped.
+ * QCOMPARE(escapeJsonString("a\nc"), R"("a\nc")");      // Control characters escaped, then wrapped.
+ * ```
+ */
+QByteArray AbstractCommand::escapeJsonString(const QString &string)
+{
+    const QByteArray utf8 = string.toUtf8();
+    QByteArray result;
+    result.reserve(utf8.size() + 2);
+    result.append('"');
+    for (const char c: utf8) {
+        switch (c) {
+        case '"':  result.append("\\\""); break;
+        case '\\': result.append("\\\\"); break;
+        case '\b': result.append("\\b");  break;
+        case '\f': result.append("\\f");  break;
+        case '\n': result.append("\\n");  break;
+        case '\r': result.append("\\r");  break;
+        case '\t': result.append("\\t");  break;
+        default:
+            if ((quint8)c < 0x20) {
+                result.append("\\u00").append(QByteArray::number((quint8)c, 16).rightJustified(2, '0'));
+            } else {
+                result.append(c);
+            }
+        }
+    }
+    result.append('"');
+    return result;
+}
+
+/*!
+ * Returns \a tag as a UTF-8 encoded InfluxDB line protocol tag key or value. That is, with any commas, equals signs
+ * and spaces escaped with backslashes. Newlines, which line protocol cannot represent, are replaced with spaces (and
+ * then escaped).
+ *
+ * Some examples:
+ * ```
+ * QCOMPARE(escapeLineProtocolTag("abc"), "abc");                   // Returned unchanged.
+ * QCOMPARE(escapeLineProtocolTag("DC voltage"), R"(DC\ voltage)"); // Spaces escaped.
+ * QCOMPARE(escapeLineProtocolTag("a,b=c"), R"(a\,b\=c)");          // Commas and equals signs escaped.
+ * ```
+ */
+QByteArray AbstractCommand::escapeLineProtocolTag(const QString &tag)
+{
+    const QByteArray utf8 = tag.toUtf8();
+    QByteArray result;
+    result.reserve(utf8.size() + 4);
+    for (const char c: utf8) {
+        switch (c) {
+        case ',':
+        case '=':
+        case ' ':
+            result.append('\\').append(c);
+            break;
+        case '\n':
+        case '\r':
+            result.append("\\ ");
+            break;
+        default:
+            result.append(c);
+        }
+    }
+    return result;
+}
+
+/*!
+ * Returns \a number as an RFC 8259 compliant JSON number, with up to 6 significant digits (the same precision as
+ * CSV and Text output). Since JSON has no representation of infinity, nor NaN, these are returned as \c null.
+ */
+QByteArray AbstractCommand::formatJsonNumber(const double number)
+{
+    QByteArray result;
+    appendJsonNumber(result, number);
+    return result;
+}
+
+namespace {
+
+/*!
+ * \internal
+ * Appends \a number to \a buffer, as AbstractCommand::appendNumber() does, for either `float` or `double` numbers.
+ *
+ * Where the standard library supports floating point `std::to_chars()` (which is locale-independent, and never
+ * allocates), finite numbers are written to a stack buffer, and appended from there. Otherwise, or if the stack
+ * buffer is too small (such as for huge numbers in fixed notation), this falls back to QByteArray::number().
+ */
+template<typename T>
+void appendFloatingPoint(QByteArray &buffer, const T number, const char format, const int precision)
+{
+    #if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+    if (std::isfinite(number)) {
+        const std::chars_format chars = (format == 'f') ? std::chars_format::fixed
+            : (format == 'e') ? std::chars_format::scientific : std::chars_format::general;
+        char digits[64];
+        const std::to_chars_result result = (precision == QLocale::FloatingPointShortest)
+            ? std::to_chars(digits, digits + sizeof(digits), number, chars)
+            : std::to_chars(digits, digits + sizeof(digits), number, chars, precision);
+        if (result.ec == std::errc()) {
+            buffer.append(digits, result.ptr - digits);
+            return;
+        }
+    }
+    #endif
+    if constexpr (std::is_same_v<T, float>) {
+        if ((precision == QLocale::FloatingPointShortest) && (std::isfinite(number))) {
+            // QByteArray::number() only has a double overload, whose shortest representation of a float promoted to
+            // double is typically much longer than the float's own. So find the latter the long way instead.
+            for (int digits = 1; digits < std::numeric_limits<float>::max_digits10; ++digits) {
+                const QByteArray candidate = QByteArray::number((double)number, format, digits);
+                if (candidate.toFloat() == number) {
+                    buffer.append(candidate);
+                    return;
+                }
+            }
+            buffer.append(QByteArray::number((double)number, format, std::numeric_limits<float>::max_digits10));
+            return;
+        }
+    }
+    buffer.append(QByteArray::number((double)number, format, precision));
+}
+
+}
+
+/*!
+ * Appends \a number to \a buffer, in the given \a format (`e`, `f` or `g`, as per QByteArray::number()) with
+ * \a precision, which may be QLocale::FloatingPointShortest for the shortest representation that reads back as the
+ * same `float`.
+ *
+ * The result is the same as QByteArray::number() would give (regardless of locale), but without the temporary
+ * QByteArray. This is used for formatting every sample's value in CSV, NDJSON and Text output, so its cost matters.
+ */
+void AbstractCommand::appendNumber(QByteArray &buffer, const float number, const char format, const int precision)
+{
+    appendFloatingPoint(buffer, number, format, precision);
+}
+
+/*!
+ * \overload
+ *
+ * With QLocale::FloatingPointShortest \a precision, this gives the shortest representation that reads back as the
+ * same `double`.
+ */
+void AbstractCommand::appendNumber(QByteArray &buffer, const double number, const char format, const int precision)
+{
+    appendFloatingPoint(buffer, number, format, precision);
+}
+
+/*!
+ * \overload
+ *
+ * Appends integer \a number to \a buffer, in decimal.
+ */
+void AbstractCommand::appendNumber(QByteArray &buffer, const qint64 number)
+{
+    char digits[24];
+    const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number);
+    Q_ASSERT(result.ec == std::errc()); // 24 characters is enough for any 64-bit integer.
+    buffer.append(digits, result.ptr - digits);
+}
+
+/*!
+ * Appends \a number to \a buffer as formatJsonNumber() would return it, but without the temporary QByteArray.
+ */
+void AbstractCommand::appendJsonNumber(QByteArray &buffer, const double number)
+{
+    if (std::isfinite(number)) {
+        appendNumber(buffer, number, 'g', 6);
+    } else {
+        buffer.append("null");
+    }
+}
+
+/*!
+ * Returns the size, in bytes, of each record in a Binary output \a block.
+ */
+quint32 AbstractCommand::binaryRecordSize(const BinaryBlock block)
+{
+    switch (block) {
+    case BinaryBlock::DsoSamples:    return sizeof(qint16);
+    case BinaryBlock::LoggerSamples: return sizeof(qint16);
+    case BinaryBlock::MeterReadings: return 8;
+    }
+    return 0;
+}
+
+/*!
+ * Appends a Binary output block header to \a buffer.
+ *
+ * Binary output is a sequence of blocks, each consisting of a fixed 32-byte header, followed by \a count fixed-size
+ * records. All multi-byte values are little-endian, and all fields are naturally aligned, so the output may be
+ * memory-mapped, and read directly.
+ *
+ * | Offset | Size | Type    | Field                                                                  |
+ * |-------:|-----:|---------|------------------------------------------------------------------------|
+ * |      0 |    4 | char[4] | Magic `DOKB`.                                                          |
+ * |      4 |    1 | uint8   | Format version; currently always `1`.                                  |
+ * |      5 |    1 | uint8   | Block kind (\a block); one of the AbstractCommand::BinaryBlock values. |
+ * |      6 |    1 | uint8   | The service's raw \a mode enumerator value.                            |
+ * |      7 |    1 | uint8   | The service's raw \a range enumerator value.                           |
+ * |      8 |    4 | float32 | \a scale to multiply raw samples by, to get values in the mode's units. |
+ * |     12 |    4 | uint32  | \a rate: sampling rate (Hz) for DSO blocks, else interval (ms).        |
+ * |     16 |    8 | uint64  | \a timestamp of the first record, in milliseconds since the epoch.     |
+ * |     24 |    4 | uint32  | \a count of records to follow, or `0` if unbounded (until EOF).        |
+ * |     28 |    4 | uint32  | Size of each record, in bytes (see binaryRecordSize()), or `0`.        |
+ *
+ * DSO and data logger records are raw int16 samples. Multimeter records are packed as a float32 value, followed by
+ * uint8 status, mode, and range values, and one reserved (zero) byte.
+ *
+ * If \a compressed is \c true, the record size is written as `0`, indicating that the block's \a count samples
+ * follow as variable-length SampleCodec deltas (see writeBinarySamples()), rather than fixed-size records.
+ */
+void AbstractCommand::writeBinaryHeader(QByteArray &buffer, const BinaryBlock block, const quint8 mode,
+                                        const quint8 range, const float scale, const quint32 rate,
+                                        const quint64 timestamp, const quint32 count, const bool compressed)
+{
+    static_assert(sizeof(float) == sizeof(quint32), "Binary output requires 32-bit floats");
+    quint32 scaleBits;
+    std::memcpy(&scaleBits, &scale, sizeof(scaleBits));
+    char header[32] { 'D', 'O', 'K', 'B', 1, (char)block, (char)mode, (char)range };
+    qToLittleEndian<quint32>(scaleBits, header + 8);
+    qToLittleEndian<quint32>(rate, header + 12);
+    qToLittleEndian<quint64>(timestamp, header + 16);
+    qToLittleEndian<quint32>(count, header + 24);
+    qToLittleEndian<quint32>((compressed) ? 0 : binaryRecordSize(block), header + 28);
+    buffer.append(header, sizeof(header));
+}
+
+/*!
+ * Appends raw \a samples to \a buffer, as Binary output records.
+ *
+ * If \a previous is not \c nullptr, \a samples are instead appended as SampleCodec deltas, continuing on from the
+ * \a previous sample, which is then updated to the last of \a samples. So a compressed block's samples may be written
+ * in any number of batches, provided \a previous was reset to `0` when the block's header was written.
+ */
+void AbstractCommand::writeBinarySamples(QByteArray &buffer, const QVector<qint16> &samples, qint16 * const previous)
+{
+    if (previous) {
+        // Encode in place, so a buffer with enough capacity reserved need not reallocate.
+        const qsizetype size = buffer.size();
+        buffer.resize(size + SampleCodec::maxEncodedSize(samples.size()));
+        buffer.truncate(size + SampleCodec::encode(samples.constData(), samples.size(), buffer.data() + size,
+                                                   *previous));
+        if (!samples.isEmpty()) {
+            *previous = samples.last();
+        }
+        return;
+    }
+#if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN)
+    // Samples are already little-endian in memory, so can be appended verbatim.
+    buffer.append(reinterpret_cast<const char *>(samples.constData()), (int)(samples.size() * sizeof(qint16)));
+#else
+    for (const qint16 sample: samples) {
+        char record[sizeof(qint16)];
+        qToLittleEndian<qint16>(sample, record);
+        buffer.append(record, sizeof(record));
+    }
+#endif
+}
+
+/*!
+ * \internal
+ * A minimal, front-to-back FlatBuffers writer, sufficient for the Arrow IPC message metadata written by
+ * writeArrowSchema() and writeArrowRecordBatch().
+ *
+ * Unlike the reference FlatBuffers builders, which write back-to-front, this writer appends each object after any
+ * objects that refer to it, so (unsigned) offsets always point forwards, and may be resolved once the referenced
+ * object's position is known.
+ */
+struct FlatBufferWriter {
+    QByteArray bytes; ///< FlatBuffer written so far.
+
+    //! Pads #bytes with zeros, to a multiple of \a alignment bytes.
+    void align(const qsizetype alignment)
+    {
+        bytes.append((int)((alignment - (bytes.size() % alignment)) % alignment), '\0');
+    }
+
+    //! Appends \a value, as little-endian.
+    template<typename T> void append(const T value)
+    {
+        char data[sizeof(T)];
+        qToLittleEndian<T>(value, data);
+        bytes.append(data, sizeof(data));
+    }
+
+    //! Overwrites the bytes at \a pos with \a value, as little-endian.
+    template<typename T> void set(const qsizetype pos, const T value)
+    {
+        qToLittleEndian<T>(value, bytes.data() + pos);
+    }
+
+    //! Sets the offset at \a pos, if any, to refer to the end of #bytes.
+    void resolve(const qsizetype pos)
+    {
+        if (pos >= 0) {
+            set<quint32>(pos, (quint32)(bytes.size() - pos));
+        }
+    }
+
+    /*!
+     * Appends a table (preceded by its vtable) with fields of the given \a sizes, in bytes (with `0` for absent
+     * fields), and resolves the \a parent offset to refer to it. Returns the positions of each field, to be set().
+     */
+    QVector<qsizetype> table(const QVector<int> &sizes, const qsizetype parent)
+    {
+        align(2);
+        const qsizetype vtable = bytes.size();
+        append<quint16>((quint16)(4 + 2 * sizes.size()));
+        bytes.append((int)(2 + 2 * sizes.size()), '\0'); // Table size and field offsets, set below.
+        align(8);
+        const qsizetype table = bytes.size();
+        resolve(parent);
+        append<qint32>((qint32)(table - vtable));
+        QVector<qsizetype> positions(sizes.size(), -1);
+        for (const int size: { 8, 4, 2, 1 }) { // Largest first, to minimise padding.
+            for (int field = 0; field < sizes.size(); ++field) {
+                if (sizes.at(field) == size) {
+                    align(size);
+                    positions[field] = bytes.size();
+                    set<quint16>(vtable + 4 + 2 * field, (quint16)(bytes.size() - table));
+                    bytes.append(size, '\0');
+                }
+            }
+        }
+        set<quint16>(vtable + 2, (quint16)(bytes.size() - table));
+        return positions;
+    }
+
+    /*!
+     * Appends a vector's \a length, aligned such that its elements will be aligned to \a alignment, and resolves the
+     * \a parent offset to refer to it. Returns the position of the vector's first element.
+     */
+    qsizetype vector(const quint32 length, const qsizetype alignment, const qsizetype parent)
+    {
+        align(4);
+        if (((bytes.size() + 4) % alignment) != 0) {
+            append<quint32>(0);
+        }
+        resolve(parent);
+        append<quint32>(length);
+        return bytes.size();
+    }
+
+    //! Appends a (null-terminated) \a string, and resolves the \a parent offset to refer to it.
+    void string(const QByteArray &string, const qsizetype parent)
+    {
+        vector((quint32)string.size(), 4, parent);
+        bytes.append(string).append('\0');
+    }
+};
+
+/*!
+ * \internal
+ * Appends an Arrow IPC encapsulated message, consisting of the FlatBuffer \a metadata, and the message \a body, to
+ * \a buffer.
+ */
+static void writeArrowMessage(QByteArray &buffer, QByteArray metadata, const QByteArray &body)
+{
+    metadata.append((int)((8 - (metadata.size() % 8)) % 8), '\0'); // Keep the body 8-byte aligned.
+    char prefix[8];
+    qToLittleEndian<quint32>(0xFFFFFFFF, prefix);   // Continuation marker.
+    qToLittleEndian<qint32>((qint32)metadata.size(), prefix + 4);
+    buffer.append(prefix, sizeof(prefix)).append(metadata).append(body);
+}
+
+/*!
+ * Appends an Arrow IPC stream Schema message to \a buffer.
+ *
+ * Arrow output is an [Arrow IPC stream](https://arrow.apache.org/docs/format/Columnar.html#ipc-streaming-format),
+ * consisting of a single Schema message, followed by one RecordBatch message per batch of samples or readings (see
+ * writeArrowRecordBatch()), and an end-of-stream marker (see writeArrowEndOfStream()). So the output may be read
+ * directly by Arrow-based tools, such as `pyarrow.ipc.open_stream()`, without any parsing step. The schema's columns
+ * are:
+ *
+ * | Column      | Arrow Type              | Description                                             |
+ * |-------------|-------------------------|---------------------------------------------------------|
+ * | `timestamp` | `timestamp[us, tz=UTC]` | Time of the sample or reading.                          |
+ * | `value`     | `float`                 | Sample or reading value, in the mode's units.           |
+ * | `mode`      | `uint8`                 | The service's raw mode enumerator value.                |
+ * | `range`     | `uint8`                 | The service's raw range enumerator value.               |
+ */
+void AbstractCommand::writeArrowSchema(QByteArray &buffer)
+{
+    FlatBufferWriter fb;
+    fb.append<quint32>(0); // Root offset, resolved by the Message table.
+    const QVector<qsizetype> message = fb.table({ 2, 1, 4, 8 }, 0); // version, header_type, header, bodyLength.
+    fb.set<qint16>(message.at(0), 4); // MetadataVersion::V5
+    fb.set<quint8>(message.at(1), 1); // MessageHeader::Schema
+    const QVector<qsizetype> schema = fb.table({ 0, 4 }, message.at(2)); // endianness (default Little), fields.
+
+    /// \todo Use dictionary encoded mode and range columns, with the modes' and ranges' names?
+    struct Column {
+        QByteArray name; quint8 type; QVector<int> sizes;
+    };
+    static const Column columns[] {
+        { "timestamp", 10, { 2, 4 } }, // Type::Timestamp; unit, timezone.
+        { "value",      3, { 2 }    }, // Type::FloatingPoint; precision.
+        { "mode",       2, { 4, 1 } }, // Type::Int; bitWidth, is_signed.
+        { "range",      2, { 4, 1 } }, // Type::Int; bitWidth, is_signed.
+    };
+    const qsizetype fields = fb.vector((quint32)std::size(columns), 4, schema.at(1));
+    fb.bytes.append((int)(4 * std::size(columns)), '\0'); // Field offsets, resolved below.
+    for (qsizetype index = 0; index < (qsizetype)std::size(columns); ++index) {
+        const Column &column = columns[index];
+        // name, nullable, type_type, type, dictionary (absent), children.
+        const QVector<qsizetype> field = fb.table({ 4, 1, 1, 4, 0, 4 }, fields + 4 * index);
+        fb.set<quint8>(field.at(2), column.type);
+        fb.string(column.name, field.at(0));
+        const QVector<qsizetype> type = fb.table(column.sizes, field.at(3));
+        switch (column.type) {
+        case 10:
+            fb.set<qint16>(type.at(0), 2); // TimeUnit::MICROSECOND
+            fb.string("UTC", type.at(1));
+            break;
+        case 3:
+            fb.set<qint16>(type.at(0), 1); // Precision::SINGLE
+            break;
+        case 2:
+            fb.set<qint32>(type.at(0), 8);  // bitWidth; is_signed remains false.
+            break;
+        }
+        fb.vector(0, 4, field.at(5)); // Arrow requires (empty) children for all fields.
+    }
+    writeArrowMessage(buffer, fb.bytes, QByteArray());
+}
+
+/*!
+ * Appends an Arrow IPC stream RecordBatch message to \a buffer, containing one row per each of \a timestamps (in
+ * microseconds since the epoch) and \a values, all with the same \a mode and \a range.
+ *
+ * \see writeArrowSchema
+ */
+void AbstractCommand::writeArrowRecordBatch(QByteArray &buffer, const QVector<qint64> &timestamps,
+                                            const QVector<float> &values, const quint8 mode, const quint8 range)
+{
+    Q_ASSERT(timestamps.size() == values.size());
+    const qsizetype count = qMin(timestamps.size(), values.size());
+
+    // Write the body's four (non-nullable) columns' data buffers, each padded to a multiple of 8 bytes.
+    QByteArray body;
+    body.reserve((int)(count * 16 + 24));
+    qsizetype offsets[5] { 0 };
+    for (qsizetype index = 0; index < count; ++index) {
+        char data[sizeof(qint64)];
+        qToLittleEndian<qint64>(timestamps.at(index), data);
+        body.append(data, sizeof(qint64));
+    }
+    offsets[1] = body.size();
+    for (qsizetype index = 0; index < count; ++index) {
+        static_assert(sizeof(float) == sizeof(quint32), "Arrow output requires 32-bit floats");
+        quint32 bits;
+        std::memcpy(&bits, &values.at(index), sizeof(bits));
+        char data[sizeof(quint32)];
+        qToLittleEndian<quint32>(bits, data);
+        body.append(data, sizeof(quint32));
+    }
+    body.append((int)((8 - (body.size() % 8)) % 8), '\0');
+    offsets[2] = body.size();
+    body.append((int)count, (char)mode).append((int)((8 - (count % 8)) % 8), '\0');
+    offsets[3] = body.size();
+    body.append((int)count, (char)range).append((int)((8 - (count % 8)) % 8), '\0');
+    offsets[4] = body.size();
+    const qint64 lengths[4] { count * 8, count * 4, count, count };
+
+    FlatBufferWriter fb;
+    fb.append<quint32>(0); // Root offset, resolved by the Message table.
+    const QVector<qsizetype> message = fb.table({ 2, 1, 4, 8 }, 0); // version, header_type, header, bodyLength.
+    fb.set<qint16>(message.at(0), 4); // MetadataVersion::V5
+    fb.set<quint8>(message.at(1), 3); // MessageHeader::RecordBatch
+    fb.set<qint64>(message.at(3), body.size());
+    const QVector<qsizetype> batch = fb.table({ 8, 4, 4 }, message.at(2)); // length, nodes, buffers.
+    fb.set<qint64>(batch.at(0), count);
+    fb.vector((quint32)std::size(lengths), 8, batch.at(1));
+    for (int column = 0; column < (int)std::size(lengths); ++column) {
+        fb.append<qint64>(count); // FieldNode::length
+        fb.append<qint64>(0);     // FieldNode::null_count
+    }
+    fb.vector((quint32)(2 * std::size(lengths)), 8, batch.at(2));
+    for (int column = 0; column < (int)std::size(lengths); ++column) {
+        fb.append<qint64>(offsets[column]); // Validity bitmap (empty, since no nulls).
+        fb.append<qint64>(0);
+        fb.append<qint64>(offsets[column]); // Values.
+        fb.append<qint64>(lengths[column]);
+    }
+    writeArrowMessage(buffer, fb.bytes, body);
+}
+
+/*!
+ * Appends an Arrow IPC stream end-of-stream marker to \a buffer.
+ *
+ * \see writeArrowSchema
+ */
+void AbstractCommand::writeArrowEndOfStream(QByteArray &buffer)
+{
+    char marker[8];
+    qToLittleEndian<quint32>(0xFFFFFFFF, marker); // Continuation marker.
+    qToLittleEndian<qint32>(0, marker + 4);       // Zero-length metadata.
+    buffer.append(marker, sizeof(marker));
+}
+
 /*!
  * \internal
  * A (run-time) class approximately equivalent to the compile-time std::ratio template.
@@ -238,6 +795,49 @@ DOKIT_INSTANTIATE_TEMPLATE_FUNCTION(std::femto);
 DOKIT_INSTANTIATE_TEMPLATE_FUNCTION(std::atto);
 #undef DOKIT_INSTANTIATE_TEMPLATE_FUNCTION
 
+/*!
+ * Returns the devices in \a values (typically those given via one or more `--device` options), each of which may be
+ * a comma-separated list of devices, with whitespace trimmed, and empty and duplicate devices removed.
+ */
+QStringList AbstractCommand::parseDeviceList(const QStringList &values)
+{
+    QStringList devices;
+    for (const QString &value: values) {
+        const QStringList names = value.split(u","_s);
+        for (const QString &name: names) {
+            const QString device = name.trimmed();
+            if ((!device.isEmpty()) && (!devices.contains(device))) {
+                devices.append(device);
+            }
+        }
+    }
+    return devices;
+}
+
+/*!
+ * Returns the devices listed in \a file (typically one given via `--device-list`), one per line, or in
+ * comma-separated lists, as per parseDeviceList(). Anything following a `#` on a line is ignored, as a comment.
+ */
+QStringList AbstractCommand::readDeviceList(QIODevice &file)
+{
+    QStringList lines;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine());
+        lines.append(line.left(line.indexOf(u'#')));
+    }
+    return parseDeviceList(lines);
+}
+
+/*!
+ * Returns \c true if \a info matches \a device, by name, address or UUID. An empty \a device matches any device.
+ */
+bool AbstractCommand::isMatchingDevice(const QBluetoothDeviceInfo &info, const QString &device)
+{
+    return (device.isEmpty()) || (device == info.name()) ||
+        ((!info.address().isNull()) && (info.address() == QBluetoothAddress(device))) ||
+        ((!info.deviceUuid().isNull()) && (info.deviceUuid() == QBluetoothUuid(device)));
+}
+
 /*!
  * Processes the relevant options from the command line \a parser.
  *
@@ -279,6 +879,15 @@ QStringList AbstractCommand::processOptions(const QCommandLineParser &parser)
         deviceToScanFor = parser.value(u"device"_s);
     }
 
+    // Validate the async log option (main() installs the handler itself, before any command is processed).
+    if (parser.isSet(u"async-log"_s)) {
+        bool ok = false;
+        parser.value(u"async-log"_s).toUInt(&ok);
+        if (!ok) {
+            errors.append(tr("Invalid async log rate limit: %1").arg(parser.value(u"async-log"_s)));
+        }
+    }
+
     // Parse the output format options (if supported, and supplied).
     if ((supportedOptionNames.contains(u"output"_s)) && // Derived classes may have removed.
         (parser.isSet(u"output"_s)))
@@ -290,11 +899,137 @@ QStringList AbstractCommand::processOptions(const QCommandLineParser &parser)
             format = OutputFormat::Json;
         } else if (output == u"text"_s) {
             format = OutputFormat::Text;
+        } else if (output == u"binary"_s) {
+            if (supportsBinaryOutput()) {
+                format = OutputFormat::Binary;
+                #if defined(Q_OS_WIN)
+                _setmode(_fileno(stdout), _O_BINARY); // Don't let the C runtime translate '\n' bytes to "\r\n".
+                #endif
+            } else {
+                errors.append(tr("Binary output is not supported by this command"));
+            }
+        } else if (output == u"arrow"_s) {
+            if (supportsArrowOutput()) {
+                format = OutputFormat::Arrow;
+                #if defined(Q_OS_WIN)
+                _setmode(_fileno(stdout), _O_BINARY); // Don't let the C runtime translate '\n' bytes to "\r\n".
+                #endif
+            } else {
+                errors.append(tr("Arrow output is not supported by this command"));
+            }
+        } else if (output == u"line-protocol"_s) {
+            if (supportsLineProtocolOutput()) {
+                format = OutputFormat::LineProtocol;
+            } else {
+                errors.append(tr("Line protocol output is not supported by this command"));
+            }
+        } else if (output == u"ndjson"_s) {
+            if (supportsNdjsonOutput()) {
+                format = OutputFormat::Ndjson;
+            } else {
+                errors.append(tr("NDJSON output is not supported by this command"));
+            }
+        } else if (output == u"ndjson-envelope"_s) {
+            if (supportsNdjsonEnvelopeOutput()) {
+                format = OutputFormat::NdjsonEnvelope;
+            } else {
+                errors.append(tr("NDJSON envelope output is not supported by this command"));
+            }
         } else {
             errors.append(tr("Unknown output format: %1").arg(output));
         }
     }
 
+    // Parse the output flush policy option.
+    if (parser.isSet(u"flush"_s)) {
+        const QString value = parser.value(u"flush"_s);
+        if (value.trimmed().toLower() == u"batch"_s) {
+            flushPolicy = FlushPolicy::Batch;
+        } else if (value.trimmed().toLower() == u"exit"_s) {
+            flushPolicy = FlushPolicy::Exit;
+        } else if (const quint32 size = parseNumber<std::ratio<1>>(value, u"B"_s); size > 0) {
+            flushPolicy = FlushPolicy::Size;
+            flushSize = size;
+            outputBuffer.reserve(size);
+        } else {
+            errors.append(tr("Invalid flush policy: %1").arg(value));
+        }
+    }
+
+    // Parse the output backpressure policy option.
+    std::optional<OutputFileWriter::OverflowPolicy> backpressure;
+    if (parser.isSet(u"backpressure"_s)) {
+        const QString value = parser.value(u"backpressure"_s).trimmed().toLower();
+        if (value == u"block"_s) {
+            backpressure = OutputFileWriter::OverflowPolicy::Block;
+        } else if (value == u"drop-oldest"_s) {
+            backpressure = OutputFileWriter::OverflowPolicy::DropOldest;
+        } else if (value == u"drop-newest"_s) {
+            backpressure = OutputFileWriter::OverflowPolicy::DropNewest;
+        } else if (value == u"decimate"_s) {
+            backpressure = OutputFileWriter::OverflowPolicy::Decimate;
+        } else {
+            errors.append(tr("Unknown backpressure policy: %1").arg(parser.value(u"backpressure"_s)));
+        }
+    }
+
+    // Parse the memory budget option.
+    if (parser.isSet(u"memory-budget"_s)) {
+        const QStringList values = parser.value(u"memory-budget"_s).split(u',');
+        const quint32 limit = parseNumber<std::ratio<1>>(values.first(), u"B"_s);
+        const quint32 quota = (values.size() == 2) ? parseNumber<std::ratio<1>>(values.last(), u"B"_s) : 0;
+        if ((limit == 0) || (values.size() > 2) || ((values.size() == 2) && ((quota == 0) || (quota > limit)))) {
+            errors.append(tr("Invalid memory budget: %1").arg(parser.value(u"memory-budget"_s)));
+        } else {
+            MemoryBudget::global()->setLimit(limit);
+            MemoryBudget::global()->setDefaultQuota(quota);
+        }
+    }
+
+    // Parse the output file, and rotation, options.
+    if (parser.isSet(u"output-file"_s)) {
+        quint32 rotateSize = 0, rotateInterval = 0;
+        if (parser.isSet(u"rotate-size"_s)) {
+            rotateSize = parseNumber<std::ratio<1>>(parser.value(u"rotate-size"_s), u"B"_s);
+            if (rotateSize == 0) {
+                errors.append(tr("Invalid rotate size: %1").arg(parser.value(u"rotate-size"_s)));
+            }
+        }
+        if (parser.isSet(u"rotate-interval"_s)) {
+            rotateInterval = parseNumber<std::milli>(parser.value(u"rotate-interval"_s), u"s"_s, 60'000);
+            if (rotateInterval == 0) {
+                errors.append(tr("Invalid rotate interval: %1").arg(parser.value(u"rotate-interval"_s)));
+            }
+        }
+        if (errors.isEmpty()) {
+            outputFile = new OutputFileWriter(this);
+            outputFile->setRotation(rotateSize, rotateInterval);
+            if (backpressure) {
+                outputFile->setOverflowPolicy(*backpressure);
+            }
+            if (!outputFile->open(parser.value(u"output-file"_s))) {
+                errors.append(tr("Failed to open output file %1: %2").arg(parser.value(u"output-file"_s),
+                                                                       outputFile->errorString()));
+                delete std::exchange(outputFile, nullptr);
+            }
+        }
+    } else {
+        for (const QString &option: { u"rotate-interval"_s, u"rotate-size"_s }) {
+            if (parser.isSet(option)) {
+                errors.append(tr("Missing required option for --%1: --output-file").arg(option));
+            }
+        }
+        // With an explicit backpressure policy, stdout is written via a writer thread too, subject to that policy.
+        if ((backpressure) && (errors.isEmpty())) {
+            outputFile = new OutputFileWriter(this);
+            outputFile->setOverflowPolicy(*backpressure);
+            if (!outputFile->openStdout()) {
+                errors.append(tr("Failed to open stdout: %1").arg(outputFile->errorString()));
+                delete std::exchange(outputFile, nullptr);
+            }
+        }
+    }
+
     // Parse the device scan timeout option.
     if (parser.isSet(u"timeout"_s)) {
         const quint32 timeout = parseNumber<std::milli>(parser.value(u"timeout"_s), u"s"_s, 500);
@@ -319,6 +1054,202 @@ QStringList AbstractCommand::processOptions(const QCommandLineParser &parser)
     return errors;
 }
 
+/*!
+ * Removes, and returns, the first of #devicesToScanFor that \a info matches, or returns a null string if none match.
+ *
+ * This allows multi-device commands to connect to each device as soon as it is discovered, while discovery continues
+ * for the rest. Once all of #devicesToScanFor have been found, discovery is stopped, so multi-device commands take
+ * only as long to set up as their slowest device's advertisement (or until the scan times out).
+ */
+QString AbstractCommand::takeDevice(const QBluetoothDeviceInfo &info)
+{
+    for (auto iter = devicesToScanFor.begin(); iter != devicesToScanFor.end(); ++iter) {
+        if (isMatchingDevice(info, *iter)) {
+            const QString device = *iter;
+            devicesToScanFor.erase(iter);
+            if (devicesToScanFor.isEmpty()) {
+                qCDebug(lc).noquote() << tr("Found all requested Pokit devices.");
+                discoveryAgent->stop();
+            }
+            return device;
+        }
+    }
+    return QString();
+}
+
+/*!
+ * Returns \c true if this command supports the Arrow output format, \c false otherwise.
+ *
+ * This base implementation returns \c false. Commands that output samples or readings should override this to return
+ * \c true, and handle OutputFormat::Arrow accordingly, typically via outputArrowRecordBatch().
+ */
+bool AbstractCommand::supportsArrowOutput() const
+{
+    return false;
+}
+
+/*!
+ * Returns \c true if this command supports the Binary output format, \c false otherwise.
+ *
+ * This base implementation returns \c false. Commands that output raw samples or readings should override this to
+ * return \c true, and handle OutputFormat::Binary accordingly.
+ */
+bool AbstractCommand::supportsBinaryOutput() const
+{
+    return false;
+}
+
+/*!
+ * Returns \c true if this command supports the InfluxDB line protocol output format, \c false otherwise.
+ *
+ * This base implementation returns \c false. Commands that output timestamped samples or readings should override
+ * this to return \c true, and handle OutputFormat::LineProtocol accordingly, typically via
+ * MeasurementFormatter::appendLineProtocol().
+ */
+bool AbstractCommand::supportsLineProtocolOutput() const
+{
+    return false;
+}
+
+/*!
+ * Returns \c true if this command supports the NDJSON output format, \c false otherwise.
+ *
+ * This base implementation returns \c false. Commands that stream many samples or readings should override this to
+ * return \c true, and handle OutputFormat::Ndjson accordingly, typically by writing one compact JSON object (via
+ * escapeJsonString() and formatJsonNumber()) per line.
+ */
+bool AbstractCommand::supportsNdjsonOutput() const
+{
+    return false;
+}
+
+/*!
+ * Returns \c true if this command supports the NDJSON envelope output format, \c false otherwise.
+ *
+ * This base implementation returns \c false. Commands whose samples share constant metadata (such as the mode, unit
+ * and range of a DSO capture) should override this to return \c true, and handle OutputFormat::NdjsonEnvelope by
+ * writing one JSON object per capture, containing that metadata just once, followed by a plain array of values.
+ */
+bool AbstractCommand::supportsNdjsonEnvelopeOutput() const
+{
+    return false;
+}
+
+/*!
+ * Appends \a bytes to the buffered output.
+ *
+ * The output will be written to stdout by a later flushOutput(), typically via outputBatchComplete().
+ */
+void AbstractCommand::output(const QByteArray &bytes)
+{
+    outputBuffer.append(bytes);
+}
+
+/*!
+ * Appends \a text, as UTF-8, to the buffered output.
+ *
+ * \overload
+ */
+void AbstractCommand::output(const QString &text)
+{
+    outputBuffer.append(text.toUtf8());
+}
+
+/*!
+ * Appends an Arrow record batch of \a timestamps, \a values, \a mode and \a range to the buffered output, preceded by
+ * the Arrow schema, if not written already.
+ *
+ * \see writeArrowRecordBatch
+ */
+void AbstractCommand::outputArrowRecordBatch(const QVector<qint64> &timestamps, const QVector<float> &values,
+                                             const quint8 mode, const quint8 range)
+{
+    for (; !arrowSchemaWritten; arrowSchemaWritten = true) {
+        writeArrowSchema(outputBuffer);
+    }
+    writeArrowRecordBatch(outputBuffer, timestamps, values, mode, range);
+}
+
+/*!
+ * Marks the end of a batch of output, such as all of the samples from a single notification, flushing the buffered
+ * output to stdout if #flushPolicy requires it.
+ *
+ * If #latencyTracking, and the batch's (steady clock) receive time \a receivedAt is given (see
+ * AbstractPokitService::receiveTimestamp()), then the batch's latency to now is added to #formatLatency, and its
+ * latency to being written (by flushOutput()) will be added to #writeLatency.
+ */
+void AbstractCommand::outputBatchComplete(const qint64 receivedAt)
+{
+    QTPOKIT_TRACE_POINT(Format, "outputBatchComplete", outputBuffer.size());
+    if ((latencyTracking) && (receivedAt >= 0) && (!outputBuffer.isEmpty())) {
+        formatLatency.record(steadyTimestamp() - receivedAt);
+        unwrittenBatches.append(receivedAt);
+    }
+    switch (flushPolicy) {
+    case FlushPolicy::Batch:
+        flushOutput();
+        break;
+    case FlushPolicy::Size:
+        if (outputBuffer.size() >= (qsizetype)flushSize) {
+            flushOutput();
+        }
+        break;
+    case FlushPolicy::Exit:
+        break; // Flushed by the destructor.
+    }
+}
+
+/*!
+ * Writes all buffered output to stdout, with a single write.
+ *
+ * Or, if writing to an output file (or to stdout, with an explicit \c --backpressure policy), queues all buffered
+ * output for the #outputFile writer thread instead, so that slow I/O never blocks the event loop. If the writer has
+ * fallen so far behind that its queue is full, then output is dropped (and logged, once per episode), or the event
+ * loop blocked, according to the writer's OutputFileWriter::overflowPolicy().
+ *
+ * Either way, the latencies of any batches tracked by outputBatchComplete() are then added to #writeLatency.
+ */
+void AbstractCommand::flushOutput()
+{
+    if (outputBuffer.isEmpty()) {
+        return;
+    }
+    PhaseTimer::mark(PhaseTimer::Phase::FirstOutput); // A no-op after the first time.
+    QTPOKIT_TRACE_ZONE(Output, "flushOutput");
+    QTPOKIT_TRACE_POINT(Output, "flushOutput", outputBuffer.size());
+    if (outputFile) {
+        const qsizetype capacity = outputBuffer.capacity();
+        if (outputFile->write(std::exchange(outputBuffer, QByteArray()))) { // Hand over, rather than copy, the data.
+            warnedDropping = false;
+        } else if (!std::exchange(warnedDropping, true)) {
+            qCWarning(lc).noquote() << tr("Output to %1 is not keeping up; dropping output.")
+                .arg(outputFile->fileName());
+        }
+        outputBuffer.reserve(capacity);
+    } else {
+        std::cout.write(outputBuffer.constData(), (std::streamsize)outputBuffer.size());
+        std::cout.flush();
+        outputBuffer.resize(0); // Unlike clear(), retains the reserved capacity.
+    }
+    if (!unwrittenBatches.isEmpty()) {
+        const qint64 writtenAt = steadyTimestamp();
+        for (const qint64 receivedAt: std::as_const(unwrittenBatches)) {
+            writeLatency.record(writtenAt - receivedAt);
+        }
+        unwrittenBatches.clear(); // Retains the reserved capacity.
+    }
+}
+
+/*!
+ * Returns the current time, in nanoseconds, according to the same steady clock as
+ * AbstractPokitService::receiveTimestamp().
+ */
+qint64 AbstractCommand::steadyTimestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 /*!
  * \fn virtual bool AbstractCommand::start()
  *
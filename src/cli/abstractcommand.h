@@ -4,14 +4,20 @@
 #ifndef DOKIT_ABSTRACTCOMMAND_H
 #define DOKIT_ABSTRACTCOMMAND_H
 
+#include <qtpokit/latencyhistogram.h>
 #include <qtpokit/qtpokit_global.h>
 
 #include <QBluetoothDeviceInfo>
 #include <QCommandLineParser>
+#include <QIODevice>
 #include <QLoggingCategory>
 #include <QObject>
+#include <QVector>
+
+class OutputFileWriter;
 
 QTPOKIT_FORWARD_DECLARE_CLASS(PokitDiscoveryAgent)
+QTPOKIT_USE_NAMESPACE
 
 class AbstractCommand : public QObject
 {
@@ -23,26 +29,98 @@ public:
         Csv,  ///< RFC 4180 compliant CSV text.
         Json, ///< RFC 8259 compliant JSON text.
         Text, ///< Plain unstructured text.
+        Binary, ///< Packed little-endian binary (see writeBinaryHeader()), if supportsBinaryOutput().
+        Ndjson, ///< Newline-delimited JSON, with one compact object per line, if supportsNdjsonOutput().
+        NdjsonEnvelope, ///< NDJSON, with one object of metadata and values per capture, if supportsNdjsonEnvelopeOutput().
+        Arrow,  ///< Apache Arrow IPC stream (see writeArrowSchema()), if supportsArrowOutput().
+        LineProtocol, ///< InfluxDB line protocol, with nanosecond timestamps, if supportsLineProtocolOutput().
+    };
+
+    /// Policies for flushing buffered output to stdout.
+    enum class FlushPolicy {
+        Batch, ///< Flush at the end of each batch of output, such as each notification's samples.
+        Size,  ///< Flush whenever the buffered output reaches a given number of bytes.
+        Exit,  ///< Flush only when the command is destroyed, typically on application exit.
+    };
+
+    /// Kinds of record blocks written by the Binary output format.
+    enum class BinaryBlock : quint8 {
+        DsoSamples    = 1, ///< Raw DSO samples, as little-endian int16 values.
+        LoggerSamples = 2, ///< Raw data logger samples, as little-endian int16 values.
+        MeterReadings = 3, ///< Packed multimeter readings.
     };
 
     explicit AbstractCommand(QObject * const parent = nullptr);
+    ~AbstractCommand() override;
 
     virtual QStringList requiredOptions(const QCommandLineParser &parser) const;
     virtual QStringList supportedOptions(const QCommandLineParser &parser) const;
 
     static QString escapeCsvField(const QString &field);
+    static QByteArray escapeJsonString(const QString &string);
+    static QByteArray escapeLineProtocolTag(const QString &tag);
+    static QByteArray formatJsonNumber(const double number);
+    static void appendNumber(QByteArray &buffer, const float number, const char format = 'g', const int precision = 6);
+    static void appendNumber(QByteArray &buffer, const double number, const char format = 'g', const int precision = 6);
+    static void appendNumber(QByteArray &buffer, const qint64 number);
+    static void appendJsonNumber(QByteArray &buffer, const double number);
+
+    static quint32 binaryRecordSize(const BinaryBlock block);
+    static void writeBinaryHeader(QByteArray &buffer, const BinaryBlock block, const quint8 mode,
+                                  const quint8 range, const float scale, const quint32 rate,
+                                  const quint64 timestamp, const quint32 count, const bool compressed = false);
+    static void writeBinarySamples(QByteArray &buffer, const QVector<qint16> &samples,
+                                   qint16 * const previous = nullptr);
+
+    static void writeArrowSchema(QByteArray &buffer);
+    static void writeArrowRecordBatch(QByteArray &buffer, const QVector<qint64> &timestamps,
+                                      const QVector<float> &values, const quint8 mode, const quint8 range);
+    static void writeArrowEndOfStream(QByteArray &buffer);
 
     template<typename R>
     static quint32 parseNumber(const QString &value, const QString &unit, const quint32 sensibleMinimum = 0);
 
+    static QStringList parseDeviceList(const QStringList &values);
+    static QStringList readDeviceList(QIODevice &file);
+    static bool isMatchingDevice(const QBluetoothDeviceInfo &info, const QString &device);
+
 public slots:
     virtual QStringList processOptions(const QCommandLineParser &parser);
     virtual bool start() = 0;
 
 protected:
+    virtual bool supportsArrowOutput() const;
+    virtual bool supportsBinaryOutput() const;
+    virtual bool supportsLineProtocolOutput() const;
+    virtual bool supportsNdjsonOutput() const;
+    virtual bool supportsNdjsonEnvelopeOutput() const;
+
+    void output(const QByteArray &bytes);
+    void output(const QString &text);
+    void outputArrowRecordBatch(const QVector<qint64> &timestamps, const QVector<float> &values,
+                                const quint8 mode, const quint8 range);
+    void outputBatchComplete(const qint64 receivedAt = -1);
+    void flushOutput();
+    static qint64 steadyTimestamp();
+
+    QString takeDevice(const QBluetoothDeviceInfo &info);
+
     QString deviceToScanFor; ///< Device (if any) that were passed to processOptions().
+    QStringList devicesToScanFor; ///< Devices, for multi-device commands, not yet discovered, per takeDevice().
     PokitDiscoveryAgent * discoveryAgent; ///< Agent for Pokit device discovery.
     OutputFormat format { OutputFormat::Text }; ///< Selected output format.
+    FlushPolicy flushPolicy { FlushPolicy::Batch }; ///< When to flush #outputBuffer to stdout.
+    quint32 flushSize { 0 };  ///< Size (in bytes) at which to flush #outputBuffer, for FlushPolicy::Size.
+    QByteArray outputBuffer;  ///< Output formatted, but not yet written to stdout (or #outputFile).
+    bool compressSamples { false }; ///< Whether to compress Binary output samples, via SampleCodec.
+    qint16 previousSample { 0 };    ///< Last sample written to the current compressed Binary block.
+    bool arrowSchemaWritten { false }; ///< Whether the Arrow output's schema has been written yet.
+    OutputFileWriter * outputFile { nullptr }; ///< Writer of output to a file, instead of stdout, if requested.
+    bool warnedDropping { false }; ///< Whether dropped #outputFile output has been logged since the last write.
+    bool latencyTracking { false }; ///< Whether to record #formatLatency and #writeLatency.
+    LatencyHistogram formatLatency; ///< Latencies from each batch's receipt, to its output being formatted.
+    LatencyHistogram writeLatency;  ///< Latencies from each batch's receipt, to its output being written (or queued).
+    QVector<qint64> unwrittenBatches; ///< Receive times of the batches in #outputBuffer, not yet written.
     static Q_LOGGING_CATEGORY(lc, "dokit.cli.command", QtInfoMsg); ///< Logging category for UI commands.
 
 protected slots:
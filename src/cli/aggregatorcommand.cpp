@@ -0,0 +1,912 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "aggregatorcommand.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/samplecodec.h>
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class AggregatorCommand
+ *
+ * The AggregatorCommand class implements the `aggregator` CLI command.
+ *
+ * A single host's Bluetooth adapter only covers part of a larger site, so this command joins any number of daemons
+ * (see DaemonCommand), each running on its own host with its own adapter, into a single cluster. Each daemon, given
+ * `--aggregator`, connects to this command (at `--listen`) as a gateway, registers its capacity, and periodically
+ * reports the devices it can see, with their (smoothed) RSSI. This command then assigns each device to a single
+ * gateway (see assignDevices()): preferably the gateway that already owns it, and otherwise the gateway that hears it
+ * best, with capacity to spare. So the cluster's capacity grows with each gateway added.
+ *
+ * As devices move about (or their signals fade), they are handed off to whichever gateway then hears them best, but
+ * only once that gateway has heard them better, by #handoffMargin dB, for #handoffHold milliseconds, and once the old
+ * gateway has finished any of the device's requests still in flight. Subscriptions follow their devices to their new
+ * gateways, with `handoff` and `resumed` events marking the (typically few second) gap in each stream.
+ *
+ * Clients connect to this command's local socket (named by `--socket`, `dokit-aggregator` by default), and make the
+ * same requests as they would of a daemon, for any device in the cluster. Requests for a device are forwarded to the
+ * gateway that owns it, and the gateway's responses (and events, such as meter readings) are routed back to the
+ * client, with the client's own request IDs. Additionally, `devices` responses list every device in the cluster, with
+ * its owning `gateway`, and every gateway that can see it, while `gateways` responses list the registered gateways.
+ *
+ * Samples are always forwarded from gateways in the daemon's compact `delta-varint-zlib` encoding, however clients
+ * negotiated their own, and only transcoded here (see transcode()), so the cluster's links carry as little as
+ * possible. Since a gateway serves this command as a single client, meter subscriptions (and the like) are only
+ * unsubscribed from a gateway once no client is still subscribed to that device.
+ */
+
+/*!
+ * Construct a new AggregatorCommand object with \a parent.
+ */
+AggregatorCommand::AggregatorCommand(QObject * const parent) : AbstractCommand(parent)
+{
+
+}
+
+QStringList AggregatorCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser) + QStringList{
+        u"listen"_s,
+    };
+}
+
+QStringList AggregatorCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"socket"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList AggregatorCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the socket option.
+    if (parser.isSet(u"socket"_s)) {
+        socketName = parser.value(u"socket"_s).trimmed();
+        if (socketName.isEmpty()) {
+            errors.append(tr("Invalid socket name: %1").arg(parser.value(u"socket"_s)));
+        }
+    }
+
+    // Parse the listen option, being a port, optionally preceded by an address (IPv6 addresses in brackets).
+    const QString value = parser.value(u"listen"_s).trimmed();
+    const qsizetype colon = value.lastIndexOf(u':');
+    QString host = (colon < 0) ? QString() : value.left(colon);
+    bool ok = false;
+    const uint port = value.mid(colon + 1).toUInt(&ok);
+    if ((host.startsWith(u'[')) && (host.endsWith(u']'))) {
+        host = host.mid(1, host.size() - 2);
+    }
+    const QHostAddress address = (host.isEmpty()) ? QHostAddress(QHostAddress::LocalHost)
+        : (host == u"*"_s) ? QHostAddress(QHostAddress::Any)
+        : (host.compare(u"localhost"_s, Qt::CaseInsensitive) == 0) ? QHostAddress(QHostAddress::LocalHost)
+        : QHostAddress(host);
+    if ((!ok) || (port == 0) || (port > std::numeric_limits<quint16>::max()) || (address.isNull())) {
+        errors.append(tr("Invalid listen value: %1").arg(value));
+    } else {
+        listenAddress = address;
+        listenPort = (quint16)port;
+    }
+    return errors;
+}
+
+/*!
+ * Begins listening for local clients, and for gateways.
+ */
+bool AggregatorCommand::start()
+{
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    if ((!server->listen(socketName)) && (server->serverError() == QAbstractSocket::AddressInUseError)) {
+        QLocalSocket probe;
+        probe.connectToServer(socketName);
+        if (probe.waitForConnected(1000)) {
+            qCWarning(lc).noquote() << tr("Another aggregator is already listening on %1.").arg(socketName);
+            return false;
+        }
+        qCDebug(lc).noquote() << tr("Removing stale socket %1.").arg(socketName);
+        QLocalServer::removeServer(socketName);
+        server->listen(socketName);
+    }
+    if (!server->isListening()) {
+        qCWarning(lc).noquote() << tr("Failed to listen on %1: %2").arg(socketName, server->errorString());
+        return false;
+    }
+    connect(server, &QLocalServer::newConnection, this, &AggregatorCommand::newConnection);
+    qCInfo(lc).noquote() << tr("Listening on %1.").arg(server->fullServerName());
+
+    gatewayServer = new QTcpServer(this);
+    if (!gatewayServer->listen(listenAddress, listenPort)) {
+        qCWarning(lc).noquote() << tr("Failed to listen on %1 port %2: %3").arg(listenAddress.toString())
+            .arg(listenPort).arg(gatewayServer->errorString());
+        return false;
+    }
+    connect(gatewayServer, &QTcpServer::newConnection, this, &AggregatorCommand::newGatewayConnection);
+    qCInfo(lc).noquote() << tr("Accepting gateways on %1 port %2.").arg(listenAddress.toString())
+        .arg(gatewayServer->serverPort());
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscovered
+ *
+ * This override does nothing, since this command never scans for devices itself.
+ */
+void AggregatorCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_UNUSED(info)
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscoveryFinished
+ *
+ * This override does nothing, since this command never scans for devices itself.
+ */
+void AggregatorCommand::deviceDiscoveryFinished()
+{
+
+}
+
+/*!
+ * Accepts all pending client connections.
+ */
+void AggregatorCommand::newConnection()
+{
+    while (server->hasPendingConnections()) {
+        QLocalSocket * const client = server->nextPendingConnection();
+        qCDebug(lc).noquote() << tr("Client connected.");
+        connect(client, &QLocalSocket::readyRead, this, [this, client]() { readRequests(client); });
+        connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+            qCDebug(lc).noquote() << tr("Client disconnected.");
+            clientDisconnected(client);
+            client->deleteLater();
+        });
+    }
+}
+
+/*!
+ * Accepts all pending gateway connections. Gateways are not assigned any devices until they register.
+ */
+void AggregatorCommand::newGatewayConnection()
+{
+    while (gatewayServer->hasPendingConnections()) {
+        QTcpSocket * const gateway = gatewayServer->nextPendingConnection();
+        qCDebug(lc).noquote() << tr("Gateway connected from %1.").arg(gateway->peerAddress().toString());
+        gateways.insert(gateway, Gateway{});
+        connect(gateway, &QTcpSocket::readyRead, this, [this, gateway]() { readMessages(gateway); });
+        connect(gateway, &QTcpSocket::disconnected, this, [this, gateway]() {
+            gatewayDisconnected(gateway);
+            gateway->deleteLater();
+        });
+    }
+}
+
+/*!
+ * Reads, and handles, all complete requests (ie lines) from \a client.
+ */
+void AggregatorCommand::readRequests(QIODevice * const client)
+{
+    while (client->canReadLine()) {
+        const QByteArray line = client->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(line, &error);
+        const QJsonObject response = (document.isObject()) ? handleRequest(client, document.object())
+            : errorResponse(QJsonValue(), (error.error == QJsonParseError::NoError)
+                ? tr("Request is not a JSON object") : tr("Invalid request: %1").arg(error.errorString()));
+        if (!response.isEmpty()) {
+            send(client, response);
+        }
+    }
+    if (client->bytesAvailable() > maxRequestSize) {
+        qCWarning(lc).noquote() << tr("Disconnecting client after %L1 bytes without a complete request.")
+            .arg(client->bytesAvailable());
+        send(client, errorResponse(QJsonValue(), tr("Request too long")));
+        client->close();
+    }
+}
+
+/*!
+ * Removes all of \a client's routes, unsubscribing the gateways from any devices no longer subscribed to.
+ */
+void AggregatorCommand::clientDisconnected(QIODevice * const client)
+{
+    QSet<std::pair<QTcpSocket *, QString>> subscriptions;
+    for (auto iter = routes.begin(); iter != routes.end();) {
+        if (iter->client == client) {
+            if (iter->persistent) {
+                subscriptions.insert({ iter->gateway, iter->device });
+            }
+            iter = routes.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    for (const auto &subscription: subscriptions) {
+        unsubscribeIfUnused(subscription.first, subscription.second);
+    }
+}
+
+/*!
+ * Handles \a request from \a client, returning the response to send, or an empty object if the request was forwarded
+ * to a gateway (which will respond later).
+ */
+QJsonObject AggregatorCommand::handleRequest(QIODevice * const client, const QJsonObject &request)
+{
+    const QJsonValue id = request.value(u"id"_s);
+    const QString command = request.value(u"command"_s).toString();
+    const QString deviceName = request.value(u"device"_s).toString();
+    if (command.isEmpty()) {
+        return errorResponse(id, tr("Missing command"));
+    } else if (command == u"devices"_s) {
+        return devicesResponse(id);
+    } else if (command == u"gateways"_s) {
+        return gatewaysResponse(id);
+    } else if (command == u"unsubscribe"_s) {
+        return unsubscribe(client, id, deviceName);
+    } else if ((command != u"status"_s) && (command != u"meter"_s) && (command != u"dso"_s) &&
+               (command != u"logger-fetch"_s) && (command != u"watch-status"_s) && (command != u"calibrate"_s) &&
+               (command != u"schedule"_s)) {
+        return errorResponse(id, tr("Unknown command: %1").arg(command));
+    }
+
+    // Only requests with sample arrays in their responses negotiate an encoding.
+    QString encoding;
+    if ((command == u"dso"_s) || (command == u"logger-fetch"_s) ||
+        ((command == u"schedule"_s) && (request.value(u"job"_s).toString() == u"logger-fetch"_s))) {
+        bool ok = false;
+        encoding = parseEncoding(request, ok);
+        if (!ok) {
+            return errorResponse(id, tr("Unsupported encoding: %1 (supported: json, delta-varint, delta-varint-zlib)")
+                .arg(encoding));
+        }
+    }
+
+    const QString key = findDevice(deviceName);
+    if (key.isNull()) {
+        return errorResponse(id, (deviceName.isEmpty()) ? tr("No devices found")
+            : tr(R"(Device not found: "%1")").arg(deviceName));
+    }
+    QTcpSocket * const gateway = owners.value(key);
+    if (!gateway) {
+        return errorResponse(id, tr(R"(No gateway has capacity for device "%1")").arg(key));
+    }
+
+    QJsonObject forwarded = request;
+    forwarded.insert(u"id"_s, (qint64)++lastRouteId);
+    forwarded.insert(u"device"_s, key); // Unambiguous, unlike device names.
+    if (!encoding.isNull()) {
+        forwarded.insert(u"encoding"_s, u"delta-varint-zlib"_s);
+    }
+    const bool persistent = ((command == u"meter"_s) || (command == u"watch-status"_s) || (command == u"schedule"_s));
+    routes.insert(lastRouteId, Route{ client, id, gateway, key, encoding, persistent, false, forwarded });
+    send(gateway, forwarded);
+    return QJsonObject();
+}
+
+/*!
+ * Returns a response, to the `devices` request with \a id, listing every device seen by any registered gateway, as
+ * reported by the gateway that hears it best, plus its owning `gateway` (if any), and every gateway that can see it.
+ */
+QJsonObject AggregatorCommand::devicesResponse(const QJsonValue &id) const
+{
+    QHash<QString, QVector<std::pair<qint16, const Gateway *>>> seenBy;
+    for (const Gateway &gateway: gateways) {
+        for (auto sighting = gateway.sightings.constBegin(); sighting != gateway.sightings.constEnd(); ++sighting) {
+            seenBy[sighting.key()].append({ sighting->rssi, &gateway });
+        }
+    }
+    QStringList keys = seenBy.keys();
+    std::sort(keys.begin(), keys.end());
+    QJsonArray devices;
+    for (const QString &key: keys) {
+        QVector<std::pair<qint16, const Gateway *>> &sightings = seenBy[key];
+        std::stable_sort(sightings.begin(), sightings.end(), [](const auto &a, const auto &b) {
+            return (a.first > b.first) || ((a.first == b.first) && (a.second->name < b.second->name));
+        });
+        QJsonObject device = sightings.constFirst().second->sightings.value(key).device;
+        QJsonArray seen;
+        for (const auto &sighting: std::as_const(sightings)) {
+            seen.append(QJsonObject{ { u"gateway"_s, sighting.second->name }, { u"rssi"_s, sighting.first } });
+        }
+        device.insert(u"gateways"_s, seen);
+        const auto owner = gateways.constFind(owners.value(key));
+        device.insert(u"gateway"_s, (owner == gateways.constEnd()) ? QJsonValue() : QJsonValue(owner->name));
+        devices.append(device);
+    }
+    return okResponse(id, QJsonObject{ { u"devices"_s, devices } });
+}
+
+/*!
+ * Returns a response, to the `gateways` request with \a id, listing every registered gateway, with its capacity, and
+ * the number of devices it can see, and has been assigned, plus its reference clock status, if the gateway reports
+ * one (that is, if given `--reference-clock`).
+ */
+QJsonObject AggregatorCommand::gatewaysResponse(const QJsonValue &id) const
+{
+    QVector<QJsonObject> list;
+    for (auto iter = gateways.constBegin(); iter != gateways.constEnd(); ++iter) {
+        if (!iter->name.isEmpty()) {
+            QJsonObject gateway{
+                { u"name"_s,     iter->name },
+                { u"address"_s,  iter.key()->peerAddress().toString() },
+                { u"capacity"_s, iter->capacity },
+                { u"seen"_s,     (qint64)iter->sightings.size() },
+                { u"assigned"_s, (qint64)iter->assigned.size() },
+            };
+            if (!iter->clock.isEmpty()) {
+                gateway.insert(u"clock"_s, iter->clock);
+            }
+            list.append(gateway);
+        }
+    }
+    std::sort(list.begin(), list.end(), [](const QJsonObject &a, const QJsonObject &b) { // For stable output.
+        return a.value(u"name"_s).toString() < b.value(u"name"_s).toString();
+    });
+    QJsonArray array;
+    for (const QJsonObject &gateway: std::as_const(list)) {
+        array.append(gateway);
+    }
+    return okResponse(id, QJsonObject{ { u"gateways"_s, array } });
+}
+
+/*!
+ * Removes \a client's subscriptions (and scheduled jobs) for the device identified by \a deviceName (or for all
+ * devices, if \a deviceName is empty), unsubscribing the gateways from any devices no longer subscribed to, and
+ * returns the response to the `unsubscribe` request with \a id.
+ */
+QJsonObject AggregatorCommand::unsubscribe(QIODevice * const client, const QJsonValue &id, const QString &deviceName)
+{
+    const QString key = (deviceName.isEmpty()) ? QString() : findDevice(deviceName);
+    if ((!deviceName.isEmpty()) && (key.isNull())) {
+        return okResponse(id, QJsonObject{ { u"unsubscribed"_s, 0 } });
+    }
+    QSet<std::pair<QTcpSocket *, QString>> subscriptions;
+    int count = 0;
+    for (auto iter = routes.begin(); iter != routes.end();) {
+        if ((iter->client == client) && (iter->persistent) && ((key.isNull()) || (iter->device == key))) {
+            subscriptions.insert({ iter->gateway, iter->device });
+            iter = routes.erase(iter);
+            ++count;
+        } else {
+            ++iter;
+        }
+    }
+    for (const auto &subscription: subscriptions) {
+        unsubscribeIfUnused(subscription.first, subscription.second);
+    }
+    return okResponse(id, QJsonObject{ { u"unsubscribed"_s, count } });
+}
+
+/*!
+ * Returns the registry key of the first device, seen by any gateway, that matches \a deviceName (by key, name,
+ * address or UUID), or a null string if none. An empty \a deviceName matches the first device with an owner.
+ */
+QString AggregatorCommand::findDevice(const QString &deviceName) const
+{
+    QStringList keys;
+    for (const Gateway &gateway: gateways) {
+        for (auto sighting = gateway.sightings.constBegin(); sighting != gateway.sightings.constEnd(); ++sighting) {
+            const QJsonObject &device = sighting->device;
+            if ((deviceName.isEmpty()) ? owners.contains(sighting.key())
+                : ((sighting.key().compare(deviceName, Qt::CaseInsensitive) == 0) ||
+                   (device.value(u"name"_s).toString() == deviceName) ||
+                   (device.value(u"address"_s).toString().compare(deviceName, Qt::CaseInsensitive) == 0) ||
+                   (device.value(u"uuid"_s).toString().compare(deviceName, Qt::CaseInsensitive) == 0))) {
+                keys.append(sighting.key());
+            }
+        }
+    }
+    return (keys.isEmpty()) ? QString() : *std::min_element(keys.cbegin(), keys.cend());
+}
+
+/*!
+ * Unsubscribes \a gateway from the device for \a key, unless any client is still subscribed to it via \a gateway.
+ */
+void AggregatorCommand::unsubscribeIfUnused(QTcpSocket * const gateway, const QString &key)
+{
+    const bool used = std::any_of(routes.cbegin(), routes.cend(), [gateway, &key](const Route &route) {
+        return (route.persistent) && (route.gateway == gateway) && (route.device == key) && (route.client);
+    });
+    if ((!used) && (gateways.contains(gateway))) {
+        send(gateway, QJsonObject{ { u"command"_s, u"unsubscribe"_s }, { u"device"_s, key } });
+    }
+}
+
+/*!
+ * Reads, and handles, all complete messages (ie lines) from \a gateway.
+ */
+void AggregatorCommand::readMessages(QTcpSocket * const gateway)
+{
+    while (gateway->canReadLine()) {
+        const QByteArray line = gateway->readLine().trimmed();
+        const QJsonDocument document = QJsonDocument::fromJson(line);
+        if (document.isObject()) {
+            handleMessage(gateway, document.object());
+        } else if (!line.isEmpty()) {
+            qCWarning(lc).noquote() << tr("Ignoring invalid message from gateway %1.")
+                .arg(gateway->peerAddress().toString());
+        }
+    }
+    if (gateway->bytesAvailable() > maxMessageSize) {
+        qCWarning(lc).noquote() << tr("Disconnecting gateway after %L1 bytes without a complete message.")
+            .arg(gateway->bytesAvailable());
+        gateway->disconnectFromHost();
+    }
+}
+
+/*!
+ * Handles \a message from \a gateway: being either the gateway's registration, a report of the devices it can see,
+ * or a response (or event) for a request forwarded to it, which is routed back to the requesting client.
+ */
+void AggregatorCommand::handleMessage(QTcpSocket * const gateway, const QJsonObject &message)
+{
+    const auto iter = gateways.find(gateway);
+    if (iter == gateways.end()) {
+        return;
+    }
+    const QString event = message.value(u"event"_s).toString();
+    if (event == u"register"_s) {
+        const QString name = message.value(u"gateway"_s).toString();
+        const bool taken = std::any_of(gateways.cbegin(), gateways.cend(),
+            [&name](const Gateway &other) { return other.name == name; });
+        if ((name.isEmpty()) || ((taken) && (iter->name != name))) {
+            qCWarning(lc).noquote() << tr(R"(Rejecting gateway "%1" from %2, since that name is already taken.)")
+                .arg(name, gateway->peerAddress().toString());
+            send(gateway, errorResponse(QJsonValue(), tr(R"(Gateway name already taken: "%1")").arg(name)));
+            gateway->disconnectFromHost();
+            return;
+        }
+        iter->name = name;
+        iter->capacity = std::max(message.value(u"capacity"_s).toInt(), 0);
+        iter->clock = message.value(u"clock"_s).toObject();
+        qCInfo(lc).noquote() << tr(R"(Gateway "%1" registered, with capacity for %Ln device(s).)", nullptr,
+            iter->capacity).arg(name);
+        return;
+    }
+    if (iter->name.isEmpty()) {
+        return; // Not yet registered.
+    }
+    if (event == u"devices"_s) {
+        iter->clock = message.value(u"clock"_s).toObject();
+        iter->sightings.clear();
+        for (const QJsonValue &value: message.value(u"devices"_s).toArray()) {
+            const QJsonObject device = value.toObject();
+            const QString key = device.value(u"key"_s).toString();
+            if (!key.isEmpty()) {
+                iter->sightings.insert(key, Sighting{ device, (qint16)device.value(u"rssi"_s).toInt() });
+            }
+        }
+        reassignDevices();
+        return;
+    }
+
+    // Or the response to an assign request releasing devices being handed off, ready for their new gateways.
+    const QJsonValue id = message.value(u"id"_s);
+    const auto release = (id.isDouble()) ? releases.find((quint32)id.toDouble()) : releases.end();
+    if ((release != releases.end()) && (release->gateway == gateway)) {
+        const QStringList keys = release->devices;
+        releases.erase(release);
+        resumeHandoffs(keys);
+        return;
+    }
+
+    // Otherwise, the message is a response (or event) for a forwarded request, if it is for any request at all.
+    const auto route = (id.isDouble()) ? routes.find((quint32)id.toDouble()) : routes.end();
+    if ((route == routes.end()) || (route->gateway != gateway)) {
+        return; // Such as the responses to assign requests, or to unsubscribe requests, which have no IDs.
+    }
+    if ((route->handoffAt >= 0) && (event.isEmpty()) && (message.value(u"ok"_s).toBool())) {
+        // Resubscribed via the device's new gateway, so mark the end of the gap, instead of responding all over again.
+        if (route->client) {
+            QJsonObject resumed{
+                { u"event"_s,   u"resumed"_s },
+                { u"device"_s,  route->device },
+                { u"gateway"_s, iter->name },
+                { u"gap"_s,     QDateTime::currentMSecsSinceEpoch() - route->handoffAt },
+            };
+            if ((!route->id.isNull()) && (!route->id.isUndefined())) {
+                resumed.insert(u"id"_s, route->id);
+            }
+            send(route->client, resumed);
+        }
+        route->handoffAt = -1;
+        return;
+    }
+    if (route->client) {
+        QJsonObject reply = transcode(message, route->encoding);
+        reply.remove(u"id"_s);
+        if ((!route->id.isNull()) && (!route->id.isUndefined())) {
+            reply.insert(u"id"_s, route->id);
+        }
+        send(route->client, reply);
+    }
+    if (event.isEmpty()) {
+        const bool failed = !message.value(u"ok"_s).toBool();
+        if ((!route->persistent) || (((!route->answered) || (route->handoffAt >= 0)) && (failed)) ||
+            (!route->client)) {
+            routes.erase(route); // Done, since only persistent requests are followed by events, if successful.
+            return;
+        }
+        route->answered = true;
+    }
+}
+
+/*!
+ * Handles \a gateway disconnecting, by failing all of the requests forwarded to it (including subscriptions), and
+ * reassigning its devices to the remaining gateways.
+ */
+void AggregatorCommand::gatewayDisconnected(QTcpSocket * const gateway)
+{
+    const QString name = gateways.value(gateway).name;
+    if (name.isEmpty()) {
+        qCDebug(lc).noquote() << tr("Unregistered gateway disconnected.");
+    } else {
+        qCWarning(lc).noquote() << tr(R"(Gateway "%1" disconnected.)").arg(name);
+    }
+    for (auto iter = routes.begin(); iter != routes.end();) {
+        if (iter->gateway == gateway) {
+            if (iter->client) {
+                QJsonObject response = errorResponse(iter->id, tr(R"(Gateway "%1" disconnected)").arg(name));
+                response.insert(u"device"_s, iter->device);
+                send(iter->client, response);
+            }
+            iter = routes.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    QStringList released; // Since the gateway has, in effect, released any devices it was handing off.
+    for (auto iter = releases.begin(); iter != releases.end();) {
+        if (iter->gateway == gateway) {
+            released.append(iter->devices);
+            iter = releases.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    gateways.remove(gateway);
+    resumeHandoffs(released);
+    reassignDevices();
+}
+
+/*!
+ * Reassigns devices to gateways (as per assignDevices()), and sends each gateway whose assignment changed its new
+ * assignment.
+ *
+ * Devices are only handed off from a gateway that can still see them once another gateway has heard them better, by
+ * at least #handoffMargin dB, for at least #handoffHold milliseconds (so that devices do not flap between gateways
+ * that hear them about as well as each other), and once any of the device's requests still in flight via the old
+ * gateway (such as a logger fetch, or DSO capture) have completed. Subscriptions are then moved to the new gateway
+ * (see handOff()), once the old gateway has released the device.
+ */
+void AggregatorCommand::reassignDevices()
+{
+    QHash<QString, QHash<QString, qint16>> sightings;
+    QHash<QString, int> capacities;
+    QHash<QString, QTcpSocket *> sockets;
+    for (auto iter = gateways.constBegin(); iter != gateways.constEnd(); ++iter) {
+        if (iter->name.isEmpty()) {
+            continue;
+        }
+        capacities.insert(iter->name, iter->capacity);
+        sockets.insert(iter->name, iter.key());
+        for (auto sighting = iter->sightings.constBegin(); sighting != iter->sightings.constEnd(); ++sighting) {
+            sightings[sighting.key()].insert(iter->name, sighting->rssi);
+        }
+    }
+    QHash<QString, QString> current;
+    for (auto owner = owners.constBegin(); owner != owners.constEnd(); ++owner) {
+        current.insert(owner.key(), gateways.value(owner.value()).name);
+    }
+
+    // Track which devices other gateways hear better, and for how long, to hand off only those that stay that way.
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QHash<QString, QString> contested = contestedDevices(sightings, current, handoffMargin);
+    for (auto iter = handoffs.begin(); iter != handoffs.end();) {
+        if (contested.value(iter.key()) == iter->gateway) {
+            ++iter;
+        } else {
+            iter = handoffs.erase(iter);
+        }
+    }
+    QSet<QString> ready;
+    for (auto iter = contested.constBegin(); iter != contested.constEnd(); ++iter) {
+        const auto handoff = handoffs.constFind(iter.key());
+        if (handoff == handoffs.constEnd()) {
+            qCDebug(lc).noquote() << tr(R"(Gateway "%1" hears device %2 better than gateway "%3" does.)")
+                .arg(iter.value(), iter.key(), current.value(iter.key()));
+            handoffs.insert(iter.key(), Handoff{ iter.value(), now });
+            continue;
+        }
+        QTcpSocket * const owner = owners.value(iter.key());
+        const bool busy = std::any_of(routes.cbegin(), routes.cend(), [owner, &iter](const Route &route) {
+            return (!route.persistent) && (route.gateway == owner) && (route.device == iter.key());
+        });
+        if ((now - handoff->since >= handoffHold) && (!busy)) {
+            ready.insert(iter.key());
+        }
+    }
+
+    const QHash<QString, QString> assignment = assignDevices(sightings, capacities, current, ready);
+    QHash<QString, QSet<QString>> assigned;
+    QHash<QTcpSocket *, QStringList> released;
+    owners.clear();
+    for (auto iter = assignment.constBegin(); iter != assignment.constEnd(); ++iter) {
+        QTcpSocket * const gateway = sockets.value(iter.value());
+        owners.insert(iter.key(), gateway);
+        assigned[iter.value()].insert(iter.key());
+        const QString previous = current.value(iter.key());
+        if (previous == iter.value()) {
+            continue;
+        }
+        handoffs.remove(iter.key());
+        QTcpSocket * const from = sockets.value(previous);
+        if ((from) && (handOff(iter.key(), from, gateway))) {
+            released[from].append(iter.key());
+        } else {
+            qCDebug(lc).noquote() << tr(R"(Assigned device %1 to gateway "%2".)").arg(iter.key(), iter.value());
+        }
+    }
+    for (auto iter = gateways.begin(); iter != gateways.end(); ++iter) {
+        if ((iter->name.isEmpty()) || (iter->assigned == assigned.value(iter->name))) {
+            continue;
+        }
+        iter->assigned = assigned.value(iter->name);
+        QStringList keys = iter->assigned.values();
+        std::sort(keys.begin(), keys.end());
+        QJsonObject request{
+            { u"command"_s, u"assign"_s },
+            { u"devices"_s, QJsonArray::fromStringList(keys) },
+        };
+        const QStringList devices = released.take(iter.key());
+        if (!devices.isEmpty()) {
+            // Resubscribe via the new gateways only once the old gateway has responded, and so released the devices.
+            request.insert(u"id"_s, (qint64)++lastRouteId);
+            releases.insert(lastRouteId, Release{ iter.key(), devices });
+        }
+        send(iter.key(), request);
+    }
+}
+
+/*!
+ * Begins handing off the device for \a key from gateway \a from to gateway \a to, by moving the device's subscriptions
+ * (and scheduled jobs), if any, to \a to, telling their clients (via `handoff` events), and unsubscribing \a from.
+ * The subscriptions are then resubscribed via \a to once \a from has released the device (see resumeHandoffs()), and
+ * any readings (or other events) in between are lost, so each subscription's client is sent a `resumed` event, with
+ * the length of the `gap`, in milliseconds, once its subscription is resumed.
+ *
+ * Returns \c true if any subscriptions were moved, otherwise \c false.
+ */
+bool AggregatorCommand::handOff(const QString &key, QTcpSocket * const from, QTcpSocket * const to)
+{
+    const QString fromName = gateways.value(from).name;
+    const QString toName = gateways.value(to).name;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int moved = 0;
+    for (Route &route: routes) {
+        if ((route.gateway != from) || (route.device != key) || (!route.persistent)) {
+            continue;
+        }
+        route.gateway = to;
+        route.handoffAt = now;
+        if (route.client) {
+            QJsonObject event{
+                { u"event"_s,  u"handoff"_s },
+                { u"device"_s, key },
+                { u"from"_s,   fromName },
+                { u"to"_s,     toName },
+            };
+            if ((!route.id.isNull()) && (!route.id.isUndefined())) {
+                event.insert(u"id"_s, route.id);
+            }
+            send(route.client, event);
+        }
+        ++moved;
+    }
+    qCInfo(lc).noquote() << tr(R"(Handing off device %1 from gateway "%2" to gateway "%3", with %Ln subscription(s).)",
+        nullptr, moved).arg(key, fromName, toName);
+    if (moved > 0) {
+        send(from, QJsonObject{ { u"command"_s, u"unsubscribe"_s }, { u"device"_s, key } });
+    }
+    return (moved > 0);
+}
+
+/*!
+ * Resubscribes, via their new gateways, the subscriptions handed off for the devices for \a keys.
+ */
+void AggregatorCommand::resumeHandoffs(const QStringList &keys)
+{
+    for (const Route &route: std::as_const(routes)) {
+        if ((route.handoffAt >= 0) && (keys.contains(route.device)) && (gateways.contains(route.gateway))) {
+            send(route.gateway, route.request);
+        }
+    }
+}
+
+/*!
+ * Returns an assignment of devices to gateways (both by name), given each device's RSSI at each of the gateways that
+ * can see it (\a sightings, by device), each gateway's \a capacities, and the \a current assignment.
+ *
+ * Devices stay with their current gateway, if it can still see them, and still has the capacity (so that connections,
+ * and subscriptions, are not needlessly moved), unless being handed off (per \a handoffs). Then the remaining devices
+ * are assigned, strongest signal first, to the gateway that hears each best, of those with capacity to spare. Devices
+ * that no gateway has the capacity for are left unassigned, until a gateway is added, or another device leaves.
+ */
+QHash<QString, QString> AggregatorCommand::assignDevices(const QHash<QString, QHash<QString, qint16>> &sightings,
+    const QHash<QString, int> &capacities, const QHash<QString, QString> &current, const QSet<QString> &handoffs)
+{
+    QHash<QString, QString> assignment;
+    QHash<QString, int> load;
+    QStringList keys = sightings.keys();
+    std::sort(keys.begin(), keys.end()); // For deterministic assignments.
+
+    for (const QString &key: std::as_const(keys)) {
+        const QString gateway = current.value(key);
+        if ((!gateway.isEmpty()) && (!handoffs.contains(key)) && (sightings.value(key).contains(gateway)) &&
+            (load.value(gateway) < capacities.value(gateway))) {
+            assignment.insert(key, gateway);
+            ++load[gateway];
+        }
+    }
+
+    const auto best = [&sightings](const QString &key) {
+        const QHash<QString, qint16> &rssis = sightings[key];
+        return *std::max_element(rssis.cbegin(), rssis.cend());
+    };
+    keys.erase(std::remove_if(keys.begin(), keys.end(), [&assignment, &sightings](const QString &key) {
+        return (assignment.contains(key)) || (sightings.value(key).isEmpty());
+    }), keys.end());
+    std::stable_sort(keys.begin(), keys.end(), [&best](const QString &a, const QString &b) {
+        return best(a) > best(b);
+    });
+    for (const QString &key: std::as_const(keys)) {
+        const QHash<QString, qint16> &rssis = sightings[key];
+        QStringList candidates = rssis.keys();
+        std::sort(candidates.begin(), candidates.end());
+        std::stable_sort(candidates.begin(), candidates.end(), [&rssis](const QString &a, const QString &b) {
+            return rssis.value(a) > rssis.value(b);
+        });
+        const auto gateway = std::find_if(candidates.cbegin(), candidates.cend(),
+            [&load, &capacities](const QString &name) { return load.value(name) < capacities.value(name); });
+        if (gateway != candidates.cend()) {
+            assignment.insert(key, *gateway);
+            ++load[*gateway];
+        }
+    }
+    return assignment;
+}
+
+/*!
+ * Returns the devices (by registry key) that some other gateway hears better than their \a current gateway does, by
+ * at least \a margin dB, given each device's RSSI at each of the gateways that can see it (\a sightings, by device),
+ * mapped to the gateway that hears each best (the first, by name, of any that hear it equally well).
+ *
+ * Devices their current gateway can no longer see at all are not contested, since assignDevices() reassigns those
+ * anyway.
+ */
+QHash<QString, QString> AggregatorCommand::contestedDevices(const QHash<QString, QHash<QString, qint16>> &sightings,
+    const QHash<QString, QString> &current, const qint16 margin)
+{
+    QHash<QString, QString> contested;
+    for (auto iter = current.constBegin(); iter != current.constEnd(); ++iter) {
+        const QHash<QString, qint16> rssis = sightings.value(iter.key());
+        const auto owner = rssis.constFind(iter.value());
+        if (owner == rssis.constEnd()) {
+            continue;
+        }
+        QString best;
+        for (auto rssi = rssis.constBegin(); rssi != rssis.constEnd(); ++rssi) {
+            if ((rssi.key() != iter.value()) && (rssi.value() >= owner.value() + margin) && ((best.isNull()) ||
+                (rssi.value() > rssis.value(best)) || ((rssi.value() == rssis.value(best)) && (rssi.key() < best)))) {
+                best = rssi.key();
+            }
+        }
+        if (!best.isNull()) {
+            contested.insert(iter.key(), best);
+        }
+    }
+    return contested;
+}
+
+/*!
+ * Returns the sample encoding \a request negotiates (`json`, if none), setting \a ok to \c true if it is one the
+ * daemon supports, otherwise \c false.
+ */
+QString AggregatorCommand::parseEncoding(const QJsonObject &request, bool &ok)
+{
+    const QString encoding = request.value(u"encoding"_s).toString();
+    ok = (encoding.isEmpty()) || (encoding == u"json"_s) || (encoding == u"delta-varint"_s) ||
+         (encoding == u"delta-varint-zlib"_s);
+    return (encoding.isEmpty()) ? u"json"_s : encoding;
+}
+
+/*!
+ * Returns \a message, with its `delta-varint-zlib` encoded samples (if any) transcoded to \a encoding: either
+ * decompressed (for `delta-varint`), or decoded, and scaled, into a `values` array (for `json`).
+ */
+QJsonObject AggregatorCommand::transcode(const QJsonObject &message, const QString &encoding)
+{
+    if ((message.value(u"encoding"_s).toString() != u"delta-varint-zlib"_s) || (encoding.isEmpty()) ||
+        (encoding == u"delta-varint-zlib"_s)) {
+        return message;
+    }
+    QJsonObject transcoded = message;
+    const QByteArray data = qUncompress(QByteArray::fromBase64(message.value(u"samples"_s).toString().toLatin1()));
+    if (encoding == u"delta-varint"_s) {
+        transcoded.insert(u"encoding"_s, encoding);
+        transcoded.insert(u"samples"_s, QString::fromLatin1(data.toBase64()));
+        return transcoded;
+    }
+    const float scale = (float)message.value(u"scale"_s).toDouble();
+    QJsonArray values;
+    for (const qint16 sample: SampleCodec::decode(data)) {
+        values.append(sample * scale);
+    }
+    for (const QString &field: { u"encoding"_s, u"count"_s, u"scale"_s, u"samples"_s }) {
+        transcoded.remove(field);
+    }
+    transcoded.insert(u"values"_s, values);
+    return transcoded;
+}
+
+/*!
+ * Returns a successful response, with \a object's fields, to the request with \a id (if not null, or undefined).
+ */
+QJsonObject AggregatorCommand::okResponse(const QJsonValue &id, QJsonObject object)
+{
+    if ((!id.isNull()) && (!id.isUndefined())) {
+        object.insert(u"id"_s, id);
+    }
+    object.insert(u"ok"_s, true);
+    return object;
+}
+
+/*!
+ * Returns an error response, with \a message, to the request with \a id (if not null, or undefined).
+ */
+QJsonObject AggregatorCommand::errorResponse(const QJsonValue &id, const QString &message)
+{
+    QJsonObject object{
+        { u"ok"_s,    false },
+        { u"error"_s, message },
+    };
+    if ((!id.isNull()) && (!id.isUndefined())) {
+        object.insert(u"id"_s, id);
+    }
+    return object;
+}
+
+/*!
+ * Sends \a message to \a device (a client, or a gateway), as a single line of compact JSON.
+ */
+void AggregatorCommand::send(QIODevice * const device, const QJsonObject &message)
+{
+    device->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+}
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+
+#include <QHash>
+#include <QHostAddress>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSet>
+#include <QVector>
+
+class QLocalServer;
+class QTcpServer;
+class QTcpSocket;
+
+class AggregatorCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit AggregatorCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// A gateway's most recent report of a single device.
+    struct Sighting {
+        QJsonObject device;                   ///< Device, as reported by the gateway (see DaemonCommand).
+        qint16 rssi { 0 };                    ///< Device's (smoothed) RSSI, at the gateway, in dBm.
+    };
+
+    /// A daemon, registered as a gateway, and the devices it can see.
+    struct Gateway {
+        QString name;                         ///< Gateway's name, or empty if not yet registered.
+        int capacity { 0 };                   ///< Maximum number of devices to assign to the gateway.
+        QHash<QString, Sighting> sightings;   ///< Devices the gateway can see, by registry key.
+        QSet<QString> assigned;               ///< Registry keys of the devices assigned to the gateway.
+        QJsonObject clock;                    ///< Gateway's reference clock status, if reported (see DaemonCommand).
+    };
+
+    /// A client request forwarded to a gateway, for routing the gateway's responses (and events) back to the client.
+    struct Route {
+        QPointer<QIODevice> client;           ///< Client to respond to, or \c nullptr if since disconnected.
+        QJsonValue id;                        ///< Client's request ID, to restore in responses, if any.
+        QTcpSocket * gateway { nullptr };     ///< Gateway the request was forwarded to.
+        QString device;                       ///< Registry key of the requested device.
+        QString encoding;                     ///< Sample encoding the client negotiated, if any.
+        bool persistent { false };            ///< Whether events follow the response (such as for subscriptions).
+        bool answered { false };              ///< Whether the gateway has responded (as opposed to sent events).
+        QJsonObject request;                  ///< Request, as forwarded, for forwarding again on handoff.
+        qint64 handoffAt { -1 };              ///< Time a handoff to #gateway began, or -1 if not being handed off.
+    };
+
+    /// A gateway that hears a device better than the device's current gateway does, by enough to take it over.
+    struct Handoff {
+        QString gateway;                      ///< Gateway to hand the device off to.
+        qint64 since { 0 };                   ///< Time the gateway first heard the device better, enough.
+    };
+
+    /// Devices handed off from a gateway, waiting for it to release them, before resubscribing via their new gateway.
+    struct Release {
+        QTcpSocket * gateway { nullptr };     ///< Gateway releasing the devices.
+        QStringList devices;                  ///< Registry keys of the devices being released.
+    };
+
+    QString socketName { QStringLiteral("dokit-aggregator") }; ///< Name of the local socket to serve clients on.
+    QHostAddress listenAddress;               ///< Address to accept gateways on.
+    quint16 listenPort { 0 };                 ///< Port to accept gateways on.
+    QLocalServer * server { nullptr };        ///< Local server, for clients to connect to.
+    QTcpServer * gatewayServer { nullptr };   ///< TCP server, for gateways to connect to.
+    QHash<QTcpSocket *, Gateway> gateways;    ///< Connected gateways (registered, or not yet).
+    QHash<QString, QTcpSocket *> owners;      ///< Gateways assigned to each device, by registry key.
+    QHash<quint32, Route> routes;             ///< Requests forwarded to gateways, by forwarded request ID.
+    quint32 lastRouteId { 0 };                ///< ID of the most recently forwarded request.
+    QHash<QString, Handoff> handoffs;         ///< Pending handoffs, by registry key.
+    QHash<quint32, Release> releases;         ///< Handoffs waiting for their gateways to release, by assign request ID.
+
+    static constexpr qint64 maxRequestSize { 64 * 1024 }; ///< Maximum size of a single client request line.
+    static constexpr qint64 maxMessageSize { 16 * 1024 * 1024 }; ///< Maximum size of a single gateway message line.
+    static constexpr qint16 handoffMargin { 8 };  ///< RSSI, in dB, another gateway must beat the owner by to take over.
+    static constexpr qint64 handoffHold { 15000 }; ///< Time, in ms, another gateway must do so for, before it does.
+
+    void newConnection();
+    void newGatewayConnection();
+    void readRequests(QIODevice * const client);
+    void clientDisconnected(QIODevice * const client);
+    QJsonObject handleRequest(QIODevice * const client, const QJsonObject &request);
+    QJsonObject devicesResponse(const QJsonValue &id) const;
+    QJsonObject gatewaysResponse(const QJsonValue &id) const;
+    QJsonObject unsubscribe(QIODevice * const client, const QJsonValue &id, const QString &deviceName);
+    QString findDevice(const QString &deviceName) const;
+    void unsubscribeIfUnused(QTcpSocket * const gateway, const QString &key);
+
+    void readMessages(QTcpSocket * const gateway);
+    void handleMessage(QTcpSocket * const gateway, const QJsonObject &message);
+    void gatewayDisconnected(QTcpSocket * const gateway);
+    void reassignDevices();
+    bool handOff(const QString &key, QTcpSocket * const from, QTcpSocket * const to);
+    void resumeHandoffs(const QStringList &keys);
+
+    static QHash<QString, QString> assignDevices(const QHash<QString, QHash<QString, qint16>> &sightings,
+                                                 const QHash<QString, int> &capacities,
+                                                 const QHash<QString, QString> &current,
+                                                 const QSet<QString> &handoffs = QSet<QString>());
+    static QHash<QString, QString> contestedDevices(const QHash<QString, QHash<QString, qint16>> &sightings,
+                                                    const QHash<QString, QString> &current, const qint16 margin);
+    static QString parseEncoding(const QJsonObject &request, bool &ok);
+    static QJsonObject transcode(const QJsonObject &message, const QString &encoding);
+    static QJsonObject okResponse(const QJsonValue &id, QJsonObject object = QJsonObject());
+    static QJsonObject errorResponse(const QJsonValue &id, const QString &message);
+    static void send(QIODevice * const device, const QJsonObject &message);
+
+    QTPOKIT_BEFRIEND_TEST(AggregatorCommand)
+};
@@ -0,0 +1,651 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchcommand.h"
+#include "commandsequence.h"
+#include "phasetimer.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/dsocapture.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitmeter.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class BenchCommand
+ *
+ * The BenchCommand class implements the `bench` CLI command, which runs a standard battery of measurements against a
+ * connected device, and outputs a machine-readable report (JSON, by default) of:
+ *
+ * * the time taken to connect to the device, and then to discover its service details (see PhaseTimer);
+ * * the fastest multimeter update interval the device and host can sustain, found by streaming `--samples` readings
+ *   at each of a fixed set of intervals, from slowest to fastest, until readings no longer keep up;
+ * * the multimeter mode-switch latency, from writing new settings to the first reading in the new mode;
+ * * the DSO transfer time, per 1000 samples, from the capture's final metadata notification to its last sample; and
+ * * the data logger fetch throughput, for whatever logging session the device currently holds (if any),
+ *
+ * along with the total number of notifications, and bytes, received (see AbstractPokitService::statistics()). All
+ * timings are taken from the services' steady clock receive timestamps (see AbstractPokitService::receiveTimestamp()),
+ * and all durations are reported in milliseconds.
+ *
+ * This is intended for qualifying new Bluetooth adapters, and hosts, before putting them into production, so each
+ * step times out (and the battery moves on) rather than waiting forever for a device that cannot keep up.
+ */
+
+const QVector<quint32> BenchCommand::intervals { 1000, 500, 250, 100, 50, 20, 10 };
+
+/// Number of mode switches, and of DSO captures, to measure.
+static constexpr int repeats { 5 };
+
+/// Factor by which readings may arrive slower than requested, on average, and still count as sustained.
+static constexpr double tolerance { 1.2 };
+
+/// Number of samples to acquire per DSO capture.
+static constexpr quint16 dsoSamples { 1000 };
+
+/*!
+ * Construct a new BenchCommand object with \a parent.
+ */
+BenchCommand::BenchCommand(QObject * const parent) : DeviceCommand(parent)
+{
+
+}
+
+QStringList BenchCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return DeviceCommand::requiredOptions(parser) + QStringList{
+    };
+}
+
+QStringList BenchCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return DeviceCommand::supportedOptions(parser) + QStringList{
+        u"samples"_s,
+    };
+}
+
+/*!
+ * Returns \a stage as a (non-translated) string, suitable for machine-readable output.
+ */
+QString BenchCommand::toString(const Stage stage)
+{
+    switch (stage) {
+    case Stage::MeterIntervals: return u"meterIntervals"_s;
+    case Stage::ModeSwitches:   return u"modeSwitches"_s;
+    case Stage::DsoTransfers:   return u"dsoTransfers"_s;
+    case Stage::LoggerFetch:    return u"loggerFetch"_s;
+    case Stage::Done:           return u"done"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Returns the minimum, mean and maximum of \a durations (in nanoseconds), in milliseconds.
+ */
+BenchCommand::Summary BenchCommand::summarise(const QVector<qint64> &durations)
+{
+    Summary summary;
+    if (durations.isEmpty()) {
+        return summary;
+    }
+    const auto [min, max] = std::minmax_element(durations.constBegin(), durations.constEnd());
+    const qint64 total = std::accumulate(durations.constBegin(), durations.constEnd(), qint64(0));
+    summary.count = durations.size();
+    summary.min = (double)*min / 1'000'000.0;
+    summary.mean = (double)total / (double)durations.size() / 1'000'000.0;
+    summary.max = (double)*max / 1'000'000.0;
+    return summary;
+}
+
+/*!
+ * Returns the fastest of the \a intervals that was sustained, or 0 if none were.
+ */
+quint32 BenchCommand::fastestInterval(const QVector<IntervalResult> &intervals)
+{
+    quint32 fastest = 0;
+    for (const IntervalResult &result: intervals) {
+        if ((result.sustained) && ((fastest == 0) || (result.requested < fastest))) {
+            fastest = result.requested;
+        }
+    }
+    return fastest;
+}
+
+/*!
+ * \copybrief DeviceCommand::processOptions
+ *
+ * This implementation extends DeviceCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList BenchCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = DeviceCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+    if (!parser.isSet(u"output"_s)) {
+        format = OutputFormat::Json; // The report is primarily for machines, not people.
+    }
+
+    // Parse the samples option.
+    if (parser.isSet(u"samples"_s)) {
+        const QString value = parser.value(u"samples"_s);
+        const quint32 samples = parseNumber<std::ratio<1>>(value, u"S"_s);
+        if ((samples < 2) || (samples > 1000)) {
+            errors.append(tr("Invalid samples value: %1").arg(value));
+        } else {
+            samplesPerStep = (int)samples;
+        }
+    }
+    return errors;
+}
+
+/*!
+ * \copybrief DeviceCommand::getService
+ *
+ * This override returns a pointer to a MultimeterService object, which is also the service whose connection, and
+ * discovery, are timed. The DSO and data logger services are created later, once the multimeter stages are done.
+ */
+AbstractPokitService * BenchCommand::getService()
+{
+    Q_ASSERT(device);
+    if (!meter) {
+        meter = device->multimeter();
+        Q_ASSERT(meter);
+        connect(meter, &MultimeterService::settingsWritten, this, [this]() {
+            if ((stage == Stage::MeterIntervals) && (stepStarted < 0)) {
+                stepStarted = steadyTimestamp(); // Only count readings taken with the new interval.
+            }
+        });
+        connect(meter, &MultimeterService::readingRead, this, &BenchCommand::meterReading);
+    }
+    return meter;
+}
+
+/*!
+ * \copybrief DeviceCommand::serviceDetailsDiscovered
+ *
+ * This override records the connection and discovery times, then begins the measurement battery.
+ */
+void BenchCommand::serviceDetailsDiscovered()
+{
+    DeviceCommand::serviceDetailsDiscovered(); // Just logs consistently.
+
+    report.deviceName = deviceName();
+    if (const std::optional<PokitProduct> product = meter->pokitProduct(); product) {
+        report.model = ::toString(*product);
+    }
+    report.host = u"%1 (%2)"_s.arg(QSysInfo::machineHostName(), QSysInfo::prettyProductName());
+    if (!device->localAdapter().isNull()) {
+        report.adapter = device->localAdapter().toString();
+    }
+    const qint64 found = PhaseTimer::elapsed(PhaseTimer::Phase::DeviceFound);
+    const qint64 connected = PhaseTimer::elapsed(PhaseTimer::Phase::Connected);
+    const qint64 discovered = PhaseTimer::elapsed(PhaseTimer::Phase::Discovered);
+    if ((found >= 0) && (connected >= found)) {
+        report.connectTime = (double)(connected - found) / 1'000'000.0;
+    }
+    if ((connected >= 0) && (discovered >= connected)) {
+        report.discoveryTime = (double)(discovered - connected) / 1'000'000.0;
+    }
+
+    stageTimer = new QTimer(this);
+    stageTimer->setSingleShot(true);
+    connect(stageTimer, &QTimer::timeout, this, [this]() {
+        if (stage == Stage::MeterIntervals) {
+            finishMeterInterval(false);
+            return;
+        }
+        qCWarning(lc).noquote() << tr("Timed out during the %1 stage; skipping the rest of it.").arg(toString(stage));
+        nextStage();
+    });
+
+    qCInfo(lc).noquote() << tr(R"(Benchmarking device "%1"...)").arg(report.deviceName);
+    meter->enableReadingNotifications();
+    startStage(Stage::MeterIntervals);
+}
+
+/*!
+ * Begins the \a newStage of the measurement battery, at its first step.
+ */
+void BenchCommand::startStage(const Stage newStage)
+{
+    stage = newStage;
+    step = 0;
+    qCDebug(lc).noquote() << tr("Starting the %1 stage.").arg(toString(stage));
+    switch (stage) {
+    case Stage::MeterIntervals:
+        startMeterInterval();
+        break;
+    case Stage::ModeSwitches:
+        switchMeterMode();
+        break;
+    case Stage::DsoTransfers:
+        meter->disableReadingNotifications();
+        if (!dso) {
+            dso = device->dso();
+            Q_ASSERT(dso);
+            dso->setPokitProduct(meter->pokitProduct().value_or(PokitProduct::PokitMeter));
+            capture = new DsoCapture(dso, this);
+            connect(dso, &DsoService::metadataRead, this, &BenchCommand::dsoMetadata);
+            connect(capture, &DsoCapture::captureComplete, this,
+                [this](const DsoService::Metadata &metadata, const DsoService::Samples &samples) {
+                    dsoCaptureComplete(metadata, samples);
+                });
+            connect(dso, &AbstractPokitService::serviceDetailsDiscovered, this, [this]() {
+                auto * const sequence = new CommandSequence(this);
+                sequence->then(u"enable metadata notifications"_s,
+                                [this]() { return dso->enableMetadataNotificationsAsync(); })
+                    .alongside(u"enable reading notifications"_s,
+                                [this]() { return dso->enableReadingNotificationsAsync(); });
+                connect(sequence, &CommandSequence::failed, this, [this, sequence](const QString &failedStep) {
+                    qCWarning(lc).noquote() << tr("Failed to prepare the DSO: %1").arg(failedStep);
+                    sequence->deleteLater();
+                    nextStage();
+                });
+                connect(sequence, &CommandSequence::finished, this, [this, sequence]() {
+                    sequence->deleteLater();
+                    startDsoCapture();
+                });
+                sequence->start();
+            });
+        }
+        startTimeout(10'000); // Allowing for the DSO service's discovery.
+        break;
+    case Stage::LoggerFetch:
+        dso->disableReadingNotifications();
+        dso->disableMetadataNotifications();
+        if (!logger) {
+            logger = device->dataLogger();
+            Q_ASSERT(logger);
+            logger->setPokitProduct(meter->pokitProduct().value_or(PokitProduct::PokitMeter));
+            connect(logger, &DataLoggerService::metadataRead, this, &BenchCommand::loggerMetadata);
+            connect(logger, &DataLoggerService::samplesRead, this, &BenchCommand::loggerSamples);
+            connect(logger, &AbstractPokitService::serviceDetailsDiscovered, this, &BenchCommand::startLoggerFetch);
+        }
+        startTimeout(10'000); // Allowing for the data logger service's discovery.
+        break;
+    case Stage::Done:
+        accumulateStatistics(meter);
+        accumulateStatistics(dso);
+        accumulateStatistics(logger);
+        outputReport();
+        disconnect(); // Will exit the application once disconnected.
+        break;
+    }
+}
+
+/*!
+ * Ends the current stage (if it has not already timed out), and begins the next.
+ */
+void BenchCommand::nextStage()
+{
+    if (stage == Stage::Done) {
+        return;
+    }
+    stageTimer->stop();
+    startStage((Stage)((int)stage + 1));
+}
+
+/*!
+ * (Re)starts the timeout for the current step, of \a milliseconds.
+ */
+void BenchCommand::startTimeout(const qint64 milliseconds)
+{
+    stageTimer->start((int)std::min<qint64>(milliseconds, std::numeric_limits<int>::max()));
+}
+
+/*!
+ * Begins streaming multimeter readings at the current step's update interval.
+ */
+void BenchCommand::startMeterInterval()
+{
+    const quint32 interval = intervals.at(step);
+    received = 0;
+    stepStarted = firstReceived = lastReceived = -1;
+    qCInfo(lc).noquote() << tr("Measuring %Ln reading/s at %L1ms intervals...", nullptr, samplesPerStep)
+        .arg(interval);
+    // All products' AutoRange enumerators share the same value.
+    meter->setSettings({ MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::AutoRange, interval });
+    startTimeout(std::max<qint64>(5'000, (qint64)interval * (samplesPerStep + 1) * 2));
+}
+
+/*!
+ * Records the result of the current multimeter update interval, which is only sustained if the step is \a complete
+ * (ie all readings arrived before timing out), and the readings arrived close enough to the requested interval. Then
+ * either tries the next (faster) interval, or moves on to the next stage, once an interval is not sustained.
+ */
+void BenchCommand::finishMeterInterval(const bool complete)
+{
+    stageTimer->stop();
+    IntervalResult result;
+    result.requested = intervals.at(step);
+    if (received > 1) {
+        result.achieved = (double)(lastReceived - firstReceived) / (double)(received - 1) / 1'000'000.0;
+    }
+    result.sustained = (complete) && (result.achieved <= (double)result.requested * tolerance);
+    qCInfo(lc).noquote() << ((result.sustained) ? tr("Sustained %L1ms intervals (%L2ms achieved).")
+        : tr("Could not sustain %L1ms intervals (%L2ms achieved)."))
+        .arg(result.requested).arg(result.achieved, 0, 'f', 1);
+    report.intervals.append(result);
+    if ((!result.sustained) || (++step >= intervals.size())) {
+        nextStage();
+        return;
+    }
+    startMeterInterval();
+}
+
+/*!
+ * Switches the multimeter between the DC voltage, and resistance, modes, at the fastest sustained interval (or the
+ * slowest interval tried, if none were sustained), timing how long the first reading in the new mode takes to arrive.
+ */
+void BenchCommand::switchMeterMode()
+{
+    switchMode = (switchMode == MultimeterService::Mode::DcVoltage)
+        ? MultimeterService::Mode::Resistance : MultimeterService::Mode::DcVoltage;
+    const quint32 fastest = fastestInterval(report.intervals);
+    stepStarted = steadyTimestamp();
+    meter->setSettings({ switchMode, +PokitMeter::VoltageRange::AutoRange,
+                         (fastest == 0) ? intervals.constFirst() : fastest });
+    startTimeout(5'000);
+}
+
+/*!
+ * Handles multimeter \a reading, according to the current stage.
+ */
+void BenchCommand::meterReading(const MultimeterService::Reading &reading)
+{
+    const qint64 timestamp = meter->receiveTimestamp();
+    switch (stage) {
+    case Stage::MeterIntervals:
+        if ((stepStarted < 0) || (reading.mode != MultimeterService::Mode::DcVoltage)) {
+            return; // Not yet taken with this step's settings.
+        }
+        if (++received == 1) {
+            firstReceived = timestamp; // The first reading anchors the intervals measured.
+        }
+        lastReceived = timestamp;
+        if (received > samplesPerStep) {
+            finishMeterInterval(true);
+        }
+        break;
+    case Stage::ModeSwitches:
+        if (reading.mode != switchMode) {
+            return; // Still in the previous mode.
+        }
+        report.modeSwitches.append(timestamp - stepStarted);
+        qCDebug(lc).noquote() << tr("Switched to %1 in %L2ms.").arg(MultimeterService::toString(switchMode))
+            .arg((double)(timestamp - stepStarted) / 1'000'000.0, 0, 'f', 1);
+        if (++step >= repeats) {
+            nextStage();
+            return;
+        }
+        switchMeterMode();
+        break;
+    case Stage::DsoTransfers:
+    case Stage::LoggerFetch:
+    case Stage::Done:
+        break; // Trailing readings, from before notifications were disabled.
+    }
+}
+
+/*!
+ * Begins a single, free-running, DSO capture.
+ */
+void BenchCommand::startDsoCapture()
+{
+    if (stage != Stage::DsoTransfers) {
+        return; // Timed out already.
+    }
+    const PokitProduct product = dso->pokitProduct().value_or(PokitProduct::PokitMeter);
+    firstReceived = -1;
+    stepStarted = steadyTimestamp();
+    qCInfo(lc).noquote() << tr("Capturing %Ln DSO sample/s...", nullptr, dsoSamples);
+    dso->startDso({ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage,
+                    minVoltageRange(product, 0), 10'000, dsoSamples });
+    startTimeout(10'000);
+}
+
+/*!
+ * Records the arrival time of DSO \a metadata, since the capture's samples follow the final metadata notification.
+ */
+void BenchCommand::dsoMetadata(const DsoService::Metadata &metadata)
+{
+    Q_UNUSED(metadata)
+    if ((stage == Stage::DsoTransfers) && (stepStarted >= 0)) {
+        firstReceived = dso->receiveTimestamp();
+    }
+}
+
+/*!
+ * Records the transfer time of a DSO capture (from its final \a metadata notification, to its last \a samples), then
+ * either begins the next capture, or moves on to the next stage.
+ */
+void BenchCommand::dsoCaptureComplete(const DsoService::Metadata &metadata, const DsoService::Samples &samples)
+{
+    Q_UNUSED(metadata)
+    if ((stage != Stage::DsoTransfers) || (firstReceived < 0) || (samples.isEmpty())) {
+        return;
+    }
+    const qint64 transfer = dso->receiveTimestamp() - firstReceived;
+    report.dsoTransfers.append(transfer * 1000 / samples.size());
+    qCDebug(lc).noquote() << tr("Transferred %Ln DSO sample/s in %L1ms.", nullptr, samples.size())
+        .arg((double)transfer / 1'000'000.0, 0, 'f', 1);
+    if (++step >= repeats) {
+        nextStage();
+        return;
+    }
+    startDsoCapture();
+}
+
+/*!
+ * Begins fetching the data logger's current logging session, if any.
+ */
+void BenchCommand::startLoggerFetch()
+{
+    if (stage != Stage::LoggerFetch) {
+        return; // Timed out already.
+    }
+    qCInfo(lc).noquote() << tr("Fetching logger samples...");
+    auto * const sequence = new CommandSequence(this);
+    sequence->then(u"enable metadata notifications"_s, [this]() { return logger->enableMetadataNotificationsAsync(); })
+        .alongside(u"enable reading notifications"_s, [this]() { return logger->enableReadingNotificationsAsync(); })
+        .then(u"fetch samples"_s, [this]() {
+            firstReceived = -1;
+            stepStarted = steadyTimestamp();
+            return logger->fetchSamplesAsync();
+        });
+    connect(sequence, &CommandSequence::failed, this, [this, sequence](const QString &failedStep) {
+        qCWarning(lc).noquote() << tr("Failed to fetch logger samples: %1").arg(failedStep);
+        sequence->deleteLater();
+        nextStage();
+    });
+    connect(sequence, &CommandSequence::finished, sequence, &QObject::deleteLater);
+    sequence->start();
+    startTimeout(60'000); // Allowing for a full sampling buffer.
+}
+
+/*!
+ * Records the number of samples the fetched logging session holds, per \a metadata, and the time they begin arriving.
+ * If the device holds no samples, then there is nothing to measure, and the battery moves on.
+ */
+void BenchCommand::loggerMetadata(const DataLoggerService::Metadata &metadata)
+{
+    if ((stage != Stage::LoggerFetch) || (stepStarted < 0) || (firstReceived >= 0)) {
+        return; // Read during discovery, or already fetching.
+    }
+    firstReceived = logger->receiveTimestamp();
+    received = 0;
+    report.loggerSamples = metadata.numberOfSamples;
+    if (metadata.numberOfSamples == 0) {
+        qCInfo(lc).noquote() << tr("Device holds no logger samples to fetch.");
+        nextStage();
+    }
+}
+
+/*!
+ * Counts fetched logger \a samples, recording the fetch time once all of the session's samples have arrived.
+ */
+void BenchCommand::loggerSamples(const DataLoggerService::Samples &samples)
+{
+    if ((stage != Stage::LoggerFetch) || (firstReceived < 0)) {
+        return;
+    }
+    received += (int)samples.size();
+    if (received >= report.loggerSamples) {
+        report.loggerFetchTime = logger->receiveTimestamp() - firstReceived;
+        nextStage();
+    }
+}
+
+/*!
+ * Adds \a service's notification, and byte, counts (if \a service is not null) to the report.
+ */
+void BenchCommand::accumulateStatistics(const AbstractPokitService * const service)
+{
+    if (service) {
+        const AbstractPokitService::Statistics statistics = service->statistics();
+        report.notifications += statistics.notifications;
+        report.bytes += statistics.bytes;
+    }
+}
+
+/*!
+ * Outputs the report, in the selected format.
+ */
+void BenchCommand::outputReport()
+{
+    const quint32 fastest = fastestInterval(report.intervals);
+    const Summary modeSwitch = summarise(report.modeSwitches);
+    const Summary dsoTransfer = summarise(report.dsoTransfers);
+    const bool fetched = ((report.loggerSamples > 0) && (report.loggerFetchTime > 0));
+    const double loggerFetchTime = (double)report.loggerFetchTime / 1'000'000.0;
+    const double loggerThroughput = (fetched) ? (double)report.loggerSamples * 1000.0 / loggerFetchTime : 0.0;
+
+    switch (format) {
+    case OutputFormat::Csv: {
+        const auto number = [](const double value, const bool valid) {
+            return (valid) ? QString::number(value, 'f', 3) : QString();
+        };
+        const auto row = [this](const QString &metric, const QString &value, const QString &unit) {
+            output(metric + u',' + value + u',' + unit + u'\n');
+        };
+        output(tr("metric,value,unit\n"));
+        row(u"device"_s, escapeCsvField(report.deviceName), QString());
+        row(u"model"_s, escapeCsvField(report.model), QString());
+        row(u"host"_s, escapeCsvField(report.host), QString());
+        row(u"adapter"_s, escapeCsvField(report.adapter), QString());
+        row(u"connect_time"_s, number(report.connectTime, report.connectTime >= 0), u"ms"_s);
+        row(u"discovery_time"_s, number(report.discoveryTime, report.discoveryTime >= 0), u"ms"_s);
+        for (const IntervalResult &result: std::as_const(report.intervals)) {
+            row(u"meter_interval_%1"_s.arg(result.requested), number(result.achieved, result.achieved > 0), u"ms"_s);
+        }
+        row(u"meter_fastest_interval"_s, (fastest == 0) ? QString() : QString::number(fastest), u"ms"_s);
+        for (const auto &[name, summary]: { std::pair{ u"mode_switch"_s, modeSwitch },
+                                            std::pair{ u"dso_transfer_per_1k_samples"_s, dsoTransfer } }) {
+            row(name + u"_count"_s, QString::number(summary.count), QString());
+            row(name + u"_min"_s, number(summary.min, summary.count > 0), u"ms"_s);
+            row(name + u"_mean"_s, number(summary.mean, summary.count > 0), u"ms"_s);
+            row(name + u"_max"_s, number(summary.max, summary.count > 0), u"ms"_s);
+        }
+        row(u"logger_samples"_s, (report.loggerSamples < 0) ? QString() : QString::number(report.loggerSamples),
+            QString());
+        row(u"logger_fetch_time"_s, number(loggerFetchTime, fetched), u"ms"_s);
+        row(u"logger_throughput"_s, number(loggerThroughput, fetched), u"samples/s"_s);
+        row(u"notifications"_s, QString::number(report.notifications), QString());
+        row(u"bytes"_s, QString::number(report.bytes), QString());
+    }   break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson: {
+        const auto summary = [](const Summary &value) {
+            return (value.count == 0) ? QJsonValue() : QJsonObject{
+                { u"count"_s, (qint64)value.count },
+                { u"min"_s,   value.min },
+                { u"mean"_s,  value.mean },
+                { u"max"_s,   value.max },
+            };
+        };
+        QJsonArray results;
+        for (const IntervalResult &result: std::as_const(report.intervals)) {
+            results.append(QJsonObject{
+                { u"requested"_s, (qint64)result.requested },
+                { u"achieved"_s,  result.achieved },
+                { u"sustained"_s, result.sustained },
+            });
+        }
+        QJsonObject object{
+            { u"device"_s,        report.deviceName },
+            { u"model"_s,         report.model },
+            { u"host"_s,          report.host },
+            { u"connectTime"_s,   (report.connectTime < 0) ? QJsonValue() : report.connectTime },
+            { u"discoveryTime"_s, (report.discoveryTime < 0) ? QJsonValue() : report.discoveryTime },
+            { u"meter"_s, QJsonObject{
+                { u"intervals"_s,       results },
+                { u"fastestInterval"_s, (fastest == 0) ? QJsonValue() : (qint64)fastest },
+                { u"modeSwitch"_s,      summary(modeSwitch) },
+            }},
+            { u"dso"_s, QJsonObject{
+                { u"transferPer1kSamples"_s, summary(dsoTransfer) },
+            }},
+            { u"logger"_s, (report.loggerSamples < 0) ? QJsonValue() : QJsonObject{
+                { u"samples"_s,    report.loggerSamples },
+                { u"fetchTime"_s,  (fetched) ? QJsonValue(loggerFetchTime) : QJsonValue() },
+                { u"throughput"_s, (fetched) ? QJsonValue(loggerThroughput) : QJsonValue() },
+            }},
+            { u"notifications"_s, (qint64)report.notifications },
+            { u"bytes"_s,         (qint64)report.bytes },
+        };
+        if (!report.adapter.isEmpty()) {
+            object.insert(u"adapter"_s, report.adapter);
+        }
+        output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+            : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:          // Not supported.
+    case OutputFormat::LineProtocol:   // Not supported.
+    case OutputFormat::Binary:         // Not supported.
+    case OutputFormat::NdjsonEnvelope: // Not supported.
+    case OutputFormat::Text: {
+        const auto duration = [](const double value) {
+            return (value < 0) ? tr("N/A") : tr("%L1ms").arg(value, 0, 'f', 1);
+        };
+        const auto summary = [](const Summary &value) {
+            return (value.count == 0) ? tr("N/A")
+                : tr("%L1ms / %L2ms / %L3ms (min / mean / max of %Ln)", nullptr, (int)value.count)
+                    .arg(value.min, 0, 'f', 1).arg(value.mean, 0, 'f', 1).arg(value.max, 0, 'f', 1);
+        };
+        output(tr("Device:                  %1\n").arg((report.model.isEmpty()) ? report.deviceName
+            : u"%1 (%2)"_s.arg(report.deviceName, report.model)));
+        output(tr("Host:                    %1\n").arg(report.host));
+        if (!report.adapter.isEmpty()) {
+            output(tr("Adapter:                 %1\n").arg(report.adapter));
+        }
+        output(tr("Connect time:            %1\n").arg(duration(report.connectTime)));
+        output(tr("Discovery time:          %1\n").arg(duration(report.discoveryTime)));
+        for (const IntervalResult &result: std::as_const(report.intervals)) {
+            output(tr("Meter interval %1: %2 (%3)\n").arg(tr("%L1ms").arg(result.requested), -8)
+                .arg(duration(result.achieved), (result.sustained) ? tr("sustained") : tr("not sustained")));
+        }
+        output(tr("Fastest meter interval:  %1\n").arg((fastest == 0) ? tr("N/A") : tr("%L1ms").arg(fastest)));
+        output(tr("Mode-switch latency:     %1\n").arg(summary(modeSwitch)));
+        output(tr("DSO transfer per 1k:     %1\n").arg(summary(dsoTransfer)));
+        output(tr("Logger fetch:            %1\n").arg((report.loggerSamples < 0) ? tr("N/A") : (!fetched)
+            ? tr("%Ln sample/s", nullptr, report.loggerSamples)
+            : tr("%Ln sample/s in %1 (%L2 samples/s)", nullptr, report.loggerSamples)
+                .arg(duration(loggerFetchTime)).arg(loggerThroughput, 0, 'f', 1)));
+        output(tr("Notifications received:  %L1 (%L2 bytes)\n").arg(report.notifications).arg(report.bytes));
+    }   break;
+    }
+    outputBatchComplete();
+}
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "devicecommand.h"
+
+#include <qtpokit/dataloggerservice.h>
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+
+QTPOKIT_FORWARD_DECLARE_CLASS(DsoCapture)
+
+class QTimer;
+
+class BenchCommand : public DeviceCommand
+{
+    Q_OBJECT
+
+public:
+    /// Stages of the measurement battery, in the order they are run.
+    enum class Stage : quint8 {
+        MeterIntervals, ///< Finding the fastest sustainable multimeter update interval.
+        ModeSwitches,   ///< Measuring multimeter mode-switch latency.
+        DsoTransfers,   ///< Measuring DSO sample transfer times.
+        LoggerFetch,    ///< Measuring data logger fetch throughput.
+        Done,           ///< All stages finished.
+    };
+
+    /// Minimum, mean and maximum of a set of durations, in milliseconds.
+    struct Summary {
+        qsizetype count { 0 }; ///< Number of durations summarised, or 0 if none were measured.
+        double min { 0.0 };    ///< Shortest duration, in milliseconds.
+        double mean { 0.0 };   ///< Mean duration, in milliseconds.
+        double max { 0.0 };    ///< Longest duration, in milliseconds.
+    };
+
+    /// Result of streaming multimeter readings at a single requested update interval.
+    struct IntervalResult {
+        quint32 requested { 0 }; ///< Requested update interval, in milliseconds.
+        double achieved { 0.0 }; ///< Mean interval between the readings actually received, in milliseconds.
+        bool sustained { false }; ///< Whether all readings arrived, at (close to) the requested interval.
+    };
+
+    /// Results of the measurement battery, as reported by outputReport().
+    struct Report {
+        QString deviceName;                  ///< Name of the device benchmarked.
+        QString model;                       ///< Pokit product model of the device benchmarked.
+        QString host;                        ///< Name, and operating system, of the host benchmarked.
+        QString adapter;                     ///< Address of the local Bluetooth adapter used, if known.
+        double connectTime { -1.0 };         ///< Time from finding the device, to connecting, in ms, or -1.
+        double discoveryTime { -1.0 };       ///< Time from connecting, to discovering service details, in ms, or -1.
+        QVector<IntervalResult> intervals;   ///< Results of each multimeter update interval tried.
+        QVector<qint64> modeSwitches;        ///< Multimeter mode-switch latencies, in nanoseconds.
+        QVector<qint64> dsoTransfers;        ///< DSO transfer times, per 1000 samples, in nanoseconds.
+        qint32 loggerSamples { -1 };         ///< Number of data logger samples fetched, or -1 if not fetched.
+        qint64 loggerFetchTime { -1 };       ///< Time taken to fetch #loggerSamples, in nanoseconds, or -1.
+        quint64 notifications { 0 };         ///< Number of notifications received, across all services.
+        quint64 bytes { 0 };                 ///< Number of value bytes received, across all services.
+    };
+
+    explicit BenchCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+    static QString toString(const Stage stage);
+    static Summary summarise(const QVector<qint64> &durations);
+    static quint32 fastestInterval(const QVector<IntervalResult> &intervals);
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+
+protected:
+    AbstractPokitService * getService() override;
+
+protected slots:
+    void serviceDetailsDiscovered() override;
+
+private:
+    MultimeterService * meter { nullptr };    ///< Multimeter service, also used for connection and discovery timing.
+    DsoService * dso { nullptr };             ///< DSO service, created once the multimeter stages are done.
+    DataLoggerService * logger { nullptr };   ///< Data logger service, created once the DSO stage is done.
+    DsoCapture * capture { nullptr };         ///< Assembles each DSO capture's samples.
+    QTimer * stageTimer { nullptr };          ///< Times out the current step, if the device stops responding.
+    Stage stage { Stage::MeterIntervals };    ///< Stage of the measurement battery currently running.
+    int samplesPerStep { 20 };                ///< Number of readings (or captures) to measure per step.
+    qsizetype step { 0 };                     ///< Index of the current step, within the current stage.
+    int received { 0 };                       ///< Number of readings, or samples, received in the current step.
+    qint64 stepStarted { -1 };                ///< Steady clock time the current step started, in nanoseconds.
+    qint64 firstReceived { -1 };              ///< Steady clock time of the current step's first value, in nanoseconds.
+    qint64 lastReceived { -1 };               ///< Steady clock time of the current step's last value, in nanoseconds.
+    MultimeterService::Mode switchMode { MultimeterService::Mode::DcVoltage }; ///< Mode the meter is switching to.
+    Report report;                            ///< Results measured so far.
+
+    static const QVector<quint32> intervals;  ///< Multimeter update intervals to try, slowest first.
+
+    void startStage(const Stage newStage);
+    void nextStage();
+    void startTimeout(const qint64 milliseconds);
+
+    void startMeterInterval();
+    void switchMeterMode();
+    void meterReading(const MultimeterService::Reading &reading);
+    void finishMeterInterval(const bool complete);
+
+    void startDsoCapture();
+    void dsoMetadata(const DsoService::Metadata &metadata);
+    void dsoCaptureComplete(const DsoService::Metadata &metadata, const DsoService::Samples &samples);
+
+    void startLoggerFetch();
+    void loggerMetadata(const DataLoggerService::Metadata &metadata);
+    void loggerSamples(const DataLoggerService::Samples &samples);
+
+    void accumulateStatistics(const AbstractPokitService * const service);
+    void outputReport();
+
+    QTPOKIT_BEFRIEND_TEST(BenchCommand)
+};
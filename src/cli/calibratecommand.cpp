@@ -92,7 +92,7 @@ void CalibrateCommand::serviceDetailsDiscovered()
     DeviceCommand::serviceDetailsDiscovered(); // Just logs consistently.
     qCInfo(lc).noquote() << tr("Calibrating temperature at %1 degrees celsius...").arg(temperature);
     if (!service->calibrateTemperature(0)) {
-        QCoreApplication::exit(EXIT_FAILURE);
+        finish(EXIT_FAILURE);
     }
 }
 
@@ -108,6 +108,11 @@ void CalibrateCommand::temperatureCalibrated()
     case OutputFormat::Json:
         std::cout << qUtf8Printable(u"true\n"_s);
         break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         std::cout << qUtf8Printable(tr("Done.\n"));
         break;
@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "calibratefleetcommand.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/calibrationservice.h>
+#include <qtpokit/pokitconnectionmanager.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitdiscoveryagent.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class CalibrateFleetCommand
+ *
+ * The CalibrateFleetCommand class implements the `calibrate-fleet` CLI command.
+ *
+ * Unlike `calibrate`, which calibrates a single device, this command calibrates the temperature of each of the
+ * devices given via `--device` (and/or listed in a `--device-list` file) to the one ambient `--temperature`, all from
+ * the one event loop. Connections are leased via a PokitConnectionManager, so up to `--max-connections` devices are
+ * scanned for, connected to, discovered and calibrated concurrently, while the rest wait for a free connection.
+ *
+ * Once every device has either been calibrated, or has failed (including not being found), a summary of each
+ * device's result is output.
+ */
+
+/*!
+ * Construct a new CalibrateFleetCommand object with \a parent.
+ */
+CalibrateFleetCommand::CalibrateFleetCommand(QObject * const parent)
+    : AbstractCommand(parent), manager(new PokitConnectionManager(this))
+{
+    manager->setIdleTimeout(0); // Each device is calibrated just the once, so disconnect as soon as released.
+    connect(manager, &PokitConnectionManager::granted, this, &CalibrateFleetCommand::granted, Qt::QueuedConnection);
+    connect(manager, &PokitConnectionManager::failed, this, &CalibrateFleetCommand::failed, Qt::QueuedConnection);
+}
+
+QStringList CalibrateFleetCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser) + QStringList{
+        u"temperature"_s,
+    };
+}
+
+QStringList CalibrateFleetCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"device-list"_s,
+        u"max-connections"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList CalibrateFleetCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the device and device-list options, either (or both) of which may list multiple devices.
+    QStringList devices = parser.values(u"device"_s);
+    if (parser.isSet(u"device-list"_s)) {
+        QFile file(parser.value(u"device-list"_s));
+        if (file.open(QIODevice::ReadOnly|QIODevice::Text)) {
+            devices.append(readDeviceList(file));
+        } else {
+            errors.append(tr("Failed to open device list %1: %2").arg(file.fileName(), file.errorString()));
+        }
+    }
+    devices = parseDeviceList(devices);
+    calibrations.clear();
+    for (const QString &deviceName: devices) {
+        calibrations.append(Calibration{ deviceName });
+    }
+    devicesToScanFor = devices;
+    if ((calibrations.isEmpty()) && (errors.isEmpty())) {
+        errors.append(tr("No devices to calibrate"));
+    }
+
+    // Parse the (required) temperature option.
+    const QString temperatureString = parser.value(u"temperature"_s);
+    bool ok;
+    const float temperatureFloat = temperatureString.toFloat(&ok);
+    if (ok) {
+        temperature = temperatureFloat;
+    } else {
+        errors.append(tr("Unrecognised temperature format: %1").arg(temperatureString));
+    }
+
+    // Parse the max-connections option.
+    if (parser.isSet(u"max-connections"_s)) {
+        const QString value = parser.value(u"max-connections"_s);
+        const int connections = value.toInt(&ok);
+        if ((!ok) || (connections <= 0)) {
+            errors.append(tr("Invalid max-connections value: %1").arg(value));
+        } else {
+            maxConnections = connections;
+        }
+    }
+    manager->setMaxConnections(maxConnections);
+    return errors;
+}
+
+/*!
+ * Begins scanning for the requested Pokit devices.
+ */
+bool CalibrateFleetCommand::start()
+{
+    qCInfo(lc).noquote() << tr("Looking for %Ln Pokit device/s to calibrate at %1 degrees celsius...", nullptr,
+                               calibrations.size()).arg(temperature);
+    discoveryAgent->start();
+    return true;
+}
+
+/*!
+ * Checks if \a info is one of the (not yet discovered) devices to calibrate, and if so, requests a connection to it.
+ *
+ * Discovery continues until all requested devices have been discovered (see AbstractCommand::takeDevice()), so that
+ * devices may be calibrated while others are still being discovered.
+ */
+void CalibrateFleetCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_ASSERT(isPokitProduct(info));
+
+    const QString deviceName = takeDevice(info);
+    const auto iter = std::find_if(calibrations.begin(), calibrations.end(),
+        [&deviceName](const Calibration &calibration) {
+            return (!deviceName.isNull()) && (calibration.deviceName == deviceName);
+        });
+    if (iter == calibrations.end()) {
+        qCDebug(lc).noquote() << tr(R"(Ignoring non-requested Pokit device "%1" (%2) at (%3).)")
+            .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+        return;
+    }
+
+    qCDebug(lc).noquote() << tr(R"(Found Pokit device "%1" (%2) at (%3).)")
+        .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+    iter->discovered = true;
+    iter->ticket = manager->request(info);
+    if (devicesToScanFor.isEmpty()) {
+        discoveryFinished = true; // takeDevice() has stopped discovery, since all requested devices were found.
+    }
+}
+
+/*!
+ * Fails any requested devices that were not discovered, and exits once all others have finished too.
+ */
+void CalibrateFleetCommand::deviceDiscoveryFinished()
+{
+    discoveryFinished = true;
+    for (int index = 0; index < calibrations.size(); ++index) {
+        if (!calibrations.at(index).discovered) {
+            qCWarning(lc).noquote() << tr(R"(Failed to find device "%1".)").arg(calibrations.at(index).deviceName);
+            finishCalibration(index, tr("Device not found"));
+        }
+    }
+    checkComplete();
+}
+
+/*!
+ * Returns the index of the calibration that holds connection request \a ticket, or -1 if none.
+ */
+int CalibrateFleetCommand::indexOf(const quint32 ticket) const
+{
+    const auto iter = std::find_if(calibrations.cbegin(), calibrations.cend(),
+        [ticket](const Calibration &calibration) { return (ticket != 0) && (calibration.ticket == ticket); });
+    return (iter == calibrations.cend()) ? -1 : (int)(iter - calibrations.cbegin());
+}
+
+/*!
+ * Handles PokitConnectionManager::granted events, by calibrating the newly connected \a device for \a ticket.
+ */
+void CalibrateFleetCommand::granted(const quint32 ticket, PokitDevice * const device)
+{
+    const int index = indexOf(ticket);
+    if (index < 0) {
+        manager->release(ticket); // No longer wanted, such as already finished.
+        return;
+    }
+    qCDebug(lc).noquote() << tr(R"(Connected to device "%1" (%2 of %3 connections).)")
+        .arg(calibrations.at(index).deviceName).arg(manager->connectionCount()).arg(maxConnections);
+    calibrate(index, device);
+}
+
+/*!
+ * Handles PokitConnectionManager::failed events, by failing the calibration for \a ticket.
+ */
+void CalibrateFleetCommand::failed(const quint32 ticket)
+{
+    const int index = indexOf(ticket);
+    if (index < 0) {
+        return;
+    }
+    qCWarning(lc).noquote() << tr(R"(Lost connection to device "%1".)").arg(calibrations.at(index).deviceName);
+    calibrations[index].ticket = 0; // No longer valid, so nothing to release.
+    finishCalibration(index, tr("Connection failed"));
+}
+
+/*!
+ * Calibrates the temperature of \a device (leased for the calibration at \a index), once its Calibration service's
+ * details have been discovered.
+ */
+void CalibrateFleetCommand::calibrate(const int index, PokitDevice * const device)
+{
+    CalibrationService * const service = device->calibration();
+    Q_ASSERT(service);
+    connect(service, &CalibrationService::temperatureCalibrated, this, [this, index]() {
+        qCInfo(lc).noquote() << tr(R"(Calibrated device "%1".)").arg(calibrations.at(index).deviceName);
+        finishCalibration(index);
+    });
+    connect(service, &AbstractPokitService::serviceErrorOccurred,
+        this, [this, index](const QLowEnergyService::ServiceError error) {
+            qCWarning(lc).noquote() << tr(R"(Bluetooth service error for device "%1":)")
+                .arg(calibrations.at(index).deviceName) << error;
+            finishCalibration(index, tr("Bluetooth service error"));
+        });
+    connect(service, &AbstractPokitService::serviceDetailsDiscovered, this, [this, index, service]() {
+        qCInfo(lc).noquote() << tr(R"(Calibrating device "%1" at %2 degrees celsius...)")
+            .arg(calibrations.at(index).deviceName).arg(temperature);
+        if (!service->calibrateTemperature(temperature)) {
+            finishCalibration(index, tr("Calibration service not available"));
+        }
+    });
+}
+
+/*!
+ * Marks the calibration at \a index as finished, or failed if \a error is not null, releasing its connection (if any)
+ * for the next waiting device.
+ */
+void CalibrateFleetCommand::finishCalibration(const int index, const QString &error)
+{
+    Calibration &calibration = calibrations[index];
+    if (calibration.finished) {
+        return; // Already finished, such as by a service error before disconnecting.
+    }
+    calibration.finished = true;
+    calibration.error = error;
+    if (calibration.ticket != 0) {
+        manager->release(std::exchange(calibration.ticket, 0)); // Disconnects, freeing the connection for others.
+    }
+    checkComplete();
+}
+
+/*!
+ * Outputs the summary, and exits, once all requested devices have either been calibrated, or failed.
+ */
+void CalibrateFleetCommand::checkComplete()
+{
+    if ((exiting) || (!discoveryFinished) || (!std::all_of(calibrations.cbegin(), calibrations.cend(),
+        [](const Calibration &calibration){ return calibration.finished; })))
+    {
+        return;
+    }
+    exiting = true;
+    outputSummary();
+    const bool failed = std::any_of(calibrations.cbegin(), calibrations.cend(),
+        [](const Calibration &calibration){ return !calibration.error.isNull(); });
+    QCoreApplication::exit((failed) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*!
+ * Outputs each requested device's calibration result, in command line order, in the selected output format.
+ */
+void CalibrateFleetCommand::outputSummary()
+{
+    switch (format) {
+    case OutputFormat::Csv:
+        output(tr("device,calibration_result,error\n"));
+        for (const Calibration &calibration: std::as_const(calibrations)) {
+            output(escapeCsvField(calibration.deviceName) + u',' +
+                   ((calibration.error.isNull()) ? u"success"_s : u"failure"_s) + u',' +
+                   escapeCsvField(calibration.error) + u'\n');
+        }
+        break;
+    case OutputFormat::Json: {
+        QJsonArray array;
+        for (const Calibration &calibration: std::as_const(calibrations)) {
+            QJsonObject object{
+                { u"device"_s,  calibration.deviceName },
+                { u"success"_s, calibration.error.isNull() },
+            };
+            if (!calibration.error.isNull()) {
+                object.insert(u"error"_s, calibration.error);
+            }
+            array.append(object);
+        }
+        output(QJsonDocument(array).toJson());
+    }   break;
+    case OutputFormat::Arrow:          // Not supported.
+    case OutputFormat::LineProtocol:   // Not supported.
+    case OutputFormat::Binary:         // Not supported.
+    case OutputFormat::Ndjson:         // Not supported.
+    case OutputFormat::NdjsonEnvelope: // Not supported.
+    case OutputFormat::Text: {
+        int failures = 0;
+        for (const Calibration &calibration: std::as_const(calibrations)) {
+            if (calibration.error.isNull()) {
+                output(tr("%1: done\n").arg(calibration.deviceName));
+            } else {
+                output(tr("%1: failed (%2)\n").arg(calibration.deviceName, calibration.error));
+                ++failures;
+            }
+        }
+        output(tr("Calibrated %Ln of %1 device/s.\n", nullptr, (int)calibrations.size() - failures)
+            .arg(calibrations.size()));
+    }   break;
+    }
+    outputBatchComplete();
+}
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+
+#include <limits>
+
+QTPOKIT_FORWARD_DECLARE_CLASS(PokitConnectionManager)
+QTPOKIT_FORWARD_DECLARE_CLASS(PokitDevice)
+QTPOKIT_USE_NAMESPACE
+
+class CalibrateFleetCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit CalibrateFleetCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// Progress of the calibration of a single requested device.
+    struct Calibration {
+        QString deviceName;               ///< Device, as requested, to report the result for.
+        quint32 ticket { 0 };             ///< Connection request ticket, or 0 if not (or no longer) requested.
+        bool discovered { false };        ///< Whether the device has been discovered.
+        bool finished { false };          ///< Whether this calibration has completed (or failed).
+        QString error;                    ///< Reason this calibration failed, or a null string if it succeeded.
+    };
+
+    PokitConnectionManager * manager;     ///< Shares #maxConnections connections between the requested devices.
+    QVector<Calibration> calibrations;    ///< One calibration per requested device, in command line order.
+    int maxConnections { 3 };             ///< Maximum number of concurrent device connections.
+    float temperature { std::numeric_limits<float>::quiet_NaN() }; ///< Ambient temperature from the CLI options.
+    bool discoveryFinished { false };     ///< Whether device discovery has finished (or been stopped).
+    bool exiting { false };               ///< Whether all devices have finished, and the application is exiting.
+
+    int indexOf(const quint32 ticket) const;
+    void calibrate(const int index, PokitDevice * const device);
+    void finishCalibration(const int index, const QString &error = QString());
+    void checkComplete();
+    void outputSummary();
+
+private slots:
+    void granted(const quint32 ticket, PokitDevice * const device);
+    void failed(const quint32 ticket);
+
+    QTPOKIT_BEFRIEND_TEST(CalibrateFleetCommand)
+};
@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "commandsequence.h"
+
+#include <QFutureWatcher>
+
+/*!
+ * \class CommandSequence
+ *
+ * The CommandSequence class runs a command's device interactions as a sequence of stages, each of one or more steps
+ * built on the services' future-based (`*Async()`) API, instead of as a chain of slots that each issue the next.
+ *
+ * Steps added via then() start a new stage, which only starts once all of the previous stage's steps have finished
+ * successfully. Steps added via alongside() join the most recent stage, and are issued together with its other steps,
+ * without waiting for any of them to finish. So independent requests, such as enabling metadata and reading
+ * notifications, are issued back-to-back, and the sequence only waits once for all of them, rather than a full
+ * round-trip per request.
+ *
+ * If any step fails (that is, its future finishes with a \c false result, or is cancelled), then failed() is emitted
+ * (once) for that step, and the sequence stops once the rest of that stage's steps have finished; no later stages are
+ * started. Otherwise, stageFinished() is emitted as each stage completes, and finished() once all stages have.
+ *
+ * A sequence may be started again once it has finished (or failed), such as for each capture of a continuous DSO
+ * command, as long as its steps capture whatever per-run state they need by reference.
+ */
+
+/*!
+ * Constructs a new, empty, command sequence with \a parent.
+ */
+CommandSequence::CommandSequence(QObject * const parent) : QObject(parent)
+{
+
+}
+
+/*!
+ * Appends a new stage, beginning with \a step, named \a name. Returns a reference to this sequence, so that calls may
+ * be chained.
+ */
+CommandSequence &CommandSequence::then(const QString &name, const Step &step)
+{
+    Q_ASSERT(!isRunning());
+    stages.append({ NamedStep{ name, step } });
+    return *this;
+}
+
+/*!
+ * Appends \a step, named \a name, to the most recent stage, to be issued concurrently with that stage's other steps.
+ * If there are no stages yet, this is equivalent to then(). Returns a reference to this sequence, so that calls may be
+ * chained.
+ */
+CommandSequence &CommandSequence::alongside(const QString &name, const Step &step)
+{
+    if (stages.isEmpty()) {
+        return then(name, step);
+    }
+    Q_ASSERT(!isRunning());
+    stages.last().append({ name, step });
+    return *this;
+}
+
+/*!
+ * Returns the number of stages in this sequence.
+ */
+int CommandSequence::stageCount() const
+{
+    return stages.size();
+}
+
+/*!
+ * Returns the index of the stage currently running, or -1 if this sequence is not running.
+ */
+int CommandSequence::currentStage() const
+{
+    return stage;
+}
+
+/*!
+ * Returns \c true if this sequence has been started, and has neither finished, nor failed, yet.
+ */
+bool CommandSequence::isRunning() const
+{
+    return (stage >= 0);
+}
+
+/*!
+ * Starts this sequence, from its first stage. Does nothing (but log a warning) if this sequence is already running.
+ */
+void CommandSequence::start()
+{
+    if (isRunning()) {
+        qCWarning(lc).noquote() << tr("Command sequence is already running, at stage %L1.").arg(stage + 1);
+        return;
+    }
+    runStage(0);
+}
+
+/*!
+ * Issues all of the steps of stage \a index, or emits finished() if there are no more stages.
+ */
+void CommandSequence::runStage(const int index)
+{
+    if (index >= stages.size()) {
+        stage = -1;
+        emit finished();
+        return;
+    }
+    stage = index;
+    stageFailed = false;
+    const QVector<NamedStep> &steps = stages.at(index);
+    pending = steps.size();
+    for (const NamedStep &step: steps) {
+        qCDebug(lc).noquote() << tr("Issuing step %1 (stage %L2 of %L3).").arg(step.name).arg(index + 1)
+            .arg(stages.size());
+        auto * const watcher = new QFutureWatcher<bool>(this);
+        connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, name = step.name]() {
+            const QFuture<bool> future = watcher->future();
+            watcher->deleteLater();
+            stepFinished(name, (!future.isCanceled()) && (future.resultCount() > 0) && (future.result()));
+        });
+        watcher->setFuture(step.step()); // Finishes (via the event loop) even if the future already has.
+    }
+}
+
+/*!
+ * Records the completion of the current stage's step \a name, with \a result, and when it is the last of the stage's
+ * steps to finish, either starts the next stage, or stops this sequence if any of the stage's steps failed.
+ */
+void CommandSequence::stepFinished(const QString &name, const bool result)
+{
+    Q_ASSERT(isRunning());
+    Q_ASSERT(pending > 0);
+    if (result) {
+        qCDebug(lc).noquote() << tr("Step %1 succeeded.").arg(name);
+    } else {
+        qCWarning(lc).noquote() << tr("Step %1 failed.").arg(name);
+        if (!stageFailed) {
+            stageFailed = true;
+            emit failed(name);
+        }
+    }
+    if (--pending > 0) {
+        return;
+    }
+    if (stageFailed) {
+        stage = -1;
+        return;
+    }
+    const int finishedStage = stage;
+    emit stageFinished(finishedStage);
+    runStage(finishedStage + 1);
+}
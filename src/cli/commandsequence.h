@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_COMMANDSEQUENCE_H
+#define DOKIT_COMMANDSEQUENCE_H
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QFuture>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QVector>
+
+#include <functional>
+
+class CommandSequence : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// A single step, which issues one or more (typically `*Async()`) service requests, and returns their future.
+    using Step = std::function<QFuture<bool>()>;
+
+    explicit CommandSequence(QObject * const parent = nullptr);
+
+    CommandSequence &then(const QString &name, const Step &step);
+    CommandSequence &alongside(const QString &name, const Step &step);
+
+    int stageCount() const;
+    int currentStage() const;
+    bool isRunning() const;
+
+public slots:
+    void start();
+
+signals:
+    void stageFinished(const int index);
+    void finished();
+    void failed(const QString &step);
+
+private:
+    /// A named step, so failures can be reported meaningfully.
+    struct NamedStep {
+        QString name; ///< Name of the step, for logging, and failed().
+        Step step;    ///< Function to invoke to issue the step.
+    };
+
+    QVector<QVector<NamedStep>> stages; ///< Sequential stages, each of one or more concurrent steps.
+    int stage { -1 };                   ///< Index of the stage currently running, or -1 if not running.
+    int pending { 0 };                  ///< Number of the current stage's steps yet to finish.
+    bool stageFailed { false };         ///< Whether any of the current stage's steps have failed.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.sequence", QtInfoMsg); ///< Logging category for command sequences.
+
+    void runStage(const int index);
+    void stepFinished(const QString &name, const bool result);
+
+    QTPOKIT_BEFRIEND_TEST(CommandSequence)
+};
+
+#endif // DOKIT_COMMANDSEQUENCE_H
@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "compactcommand.h"
+#include "exportcommand.h"
+#include "shardedworkerpool.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/loggerarchive.h>
+#include <qtpokit/loggerrollup.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+
+#include <algorithm>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class CompactCommand
+ *
+ * The CompactCommand class implements the `compact` CLI command, compacting logger archives (see LoggerArchive), and
+ * building their rollups (see LoggerRollup), so later queries (see QueryCommand) read as little as possible.
+ *
+ * Incremental fetches (such as `logger-fetch --archive`, run periodically) append many small session runs to their
+ * archives. Each `--archive` (which may be an archive file, or a directory of them, see ExportCommand::findArchives())
+ * is compacted in place, coalescing each logging session's runs into as few blocks as possible, in time order (see
+ * LoggerArchive::compact). Alternatively, with `--merge`, all of the archives are compacted into the single given
+ * archive file, leaving the original archives unchanged. Either way, a rollup of one second, one minute and one hour
+ * aggregates is then (re)built beside each compacted archive.
+ *
+ * This is intended to be run in the background (such as from cron), between fetches. Archives are compacted
+ * concurrently, on a ShardedWorkerPool of `--workers` threads (one per core, by default), with one shard per output
+ * archive. Each archive is only replaced once its compacted copy is complete, so readers never see a partial archive.
+ */
+
+/*!
+ * Construct a new CompactCommand object with \a parent.
+ */
+CompactCommand::CompactCommand(QObject * const parent) : AbstractCommand(parent)
+{
+
+}
+
+QStringList CompactCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser) + QStringList{
+        u"archive"_s,
+    };
+}
+
+QStringList CompactCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"compress"_s,
+        u"merge"_s,
+        u"workers"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList CompactCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the compress option.
+    compress = parser.isSet(u"compress"_s);
+
+    // Parse the workers option.
+    if (parser.isSet(u"workers"_s)) {
+        const QString value = parser.value(u"workers"_s).trimmed();
+        bool ok = (value.compare(u"auto"_s, Qt::CaseInsensitive) == 0);
+        threads = (ok) ? 0 : value.toInt(&ok); // 0 for one thread per core.
+        if ((!ok) || (threads < 0)) {
+            errors.append(tr("Invalid workers value: %1").arg(parser.value(u"workers"_s)));
+        }
+    }
+
+    // Parse the archive option/s.
+    compactions.clear();
+    QStringList archives;
+    QSet<QString> seen;
+    for (const QString &path: parser.values(u"archive"_s)) {
+        if (!QFileInfo::exists(path)) {
+            errors.append(tr("Archive does not exist: %1").arg(path));
+            continue;
+        }
+        const QStringList found = ExportCommand::findArchives(path);
+        if (found.isEmpty()) {
+            errors.append(tr("No archives found in %1").arg(path));
+        }
+        for (const QString &archive: found) {
+            const QString canonical = QFileInfo(archive).canonicalFilePath();
+            if (seen.contains(canonical)) {
+                errors.append(tr("Archive given more than once: %1").arg(archive));
+                continue;
+            }
+            seen.insert(canonical);
+            archives.append(archive);
+        }
+    }
+
+    // Parse the merge option.
+    if (parser.isSet(u"merge"_s)) {
+        const QString output = parser.value(u"merge"_s);
+        const QFileInfo info(output);
+        if ((info.exists()) && (!seen.contains(info.canonicalFilePath()))) {
+            errors.append(tr("Merge file already exists, but is not one of the archives: %1").arg(output));
+        } else if (!info.absoluteDir().exists()) {
+            errors.append(tr("Merge file directory does not exist: %1").arg(info.absolutePath()));
+        }
+        compactions.append({ archives, output, QString(), Statistics{}, Statistics{} });
+    } else for (const QString &archive: std::as_const(archives)) {
+        compactions.append({ { archive }, archive, QString(), Statistics{}, Statistics{} });
+    }
+    return errors;
+}
+
+/*!
+ * Begins compacting the archives, on the worker threads, and returns \c true. The command exits once all of the
+ * archives have been compacted (or failed to).
+ */
+bool CompactCommand::start()
+{
+    finished = 0;
+    workers = new ShardedWorkerPool(threads, this);
+    connect(workers, &ShardedWorkerPool::outputReady, this,
+            [this](const int shard, const QByteArray &) { compactionFinished(shard); });
+    qCInfo(lc).noquote() << tr("Compacting %Ln archive(s).", nullptr, (int)compactions.size());
+
+    // Each job writes only its own compaction, which is not read here again until the job's completion is delivered.
+    for (int index = 0; index < compactions.size(); ++index) {
+        Compaction * const item = &compactions[index];
+        workers->submit(index, [item, compress = this->compress]() {
+            item->error = compact(item->archives, item->output, compress, item->before, item->after);
+            return QByteArray();
+        });
+    }
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscovered
+ *
+ * This override does nothing, since this command never scans for devices.
+ */
+void CompactCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_UNUSED(info)
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscoveryFinished
+ *
+ * This override does nothing, since this command never scans for devices.
+ */
+void CompactCommand::deviceDiscoveryFinished()
+{
+
+}
+
+/*!
+ * Reports the completion of the compaction at \a index, and exits once all compactions have finished.
+ */
+void CompactCommand::compactionFinished(const int index)
+{
+    const Compaction &item = compactions.at(index);
+    if (item.error.isEmpty()) {
+        qCInfo(lc).noquote() << tr("Compacted %Ln session run(s), of %L1 bytes, into %L2 run(s), of %L3 bytes, in %4.",
+            nullptr, (int)item.before.sessions).arg(item.before.bytes).arg(item.after.sessions).arg(item.after.bytes)
+            .arg(item.output);
+    } else {
+        qCWarning(lc).noquote() << tr("Failed to compact %1: %2").arg(item.output, item.error);
+    }
+    if (++finished < compactions.size()) {
+        return;
+    }
+    const auto failures = std::count_if(compactions.cbegin(), compactions.cend(),
+        [](const Compaction &item) { return !item.error.isEmpty(); });
+    if (failures > 0) {
+        qCWarning(lc).noquote() << tr("Failed to compact %Ln of %1 archive(s).", nullptr, (int)failures)
+            .arg(compactions.size());
+    }
+    QCoreApplication::exit((failures > 0) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*!
+ * Compacts \a archives into \a output (which may be one of \a archives), compressing samples if \a compress is
+ * \c true, then builds \a output's rollup, and sets \a before and \a after to the sizes of \a archives and \a output.
+ * Returns an empty string on success, otherwise a description of the failure.
+ *
+ * The rollup is a cache, so failing to build it does not fail the compaction (queries simply scan the archive instead).
+ * This is called on worker threads, so uses only its own (thread-local) objects.
+ */
+QString CompactCommand::compact(const QStringList &archives, const QString &output, const bool compress,
+                                Statistics &before, Statistics &after)
+{
+    before = Statistics{};
+    for (const QString &archive: archives) {
+        LoggerArchive source(archive);
+        if (!source.open()) {
+            return tr("Invalid, or unreadable, archive: %1").arg(archive);
+        }
+        before.sessions += source.sessionCount();
+        before.bytes += QFileInfo(archive).size();
+    }
+    if (!LoggerArchive::compact(archives, output, compress)) {
+        return tr("Failed to write archive");
+    }
+
+    LoggerArchive compacted(output);
+    if (!compacted.open()) {
+        return tr("Invalid, or unreadable, archive: %1").arg(output);
+    }
+    after = Statistics{ compacted.sessionCount(), QFileInfo(output).size() };
+    LoggerRollup rollup(LoggerRollup::fileNameFor(output));
+    if (!rollup.build(compacted)) {
+        qCWarning(lc).noquote() << tr("Failed to build rollup for %1").arg(output);
+    }
+    return QString();
+}
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+
+#include <QStringList>
+#include <QVector>
+
+class ShardedWorkerPool;
+
+class CompactCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit CompactCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// Sizes of an archive (or set of archives), before or after compaction.
+    struct Statistics {
+        qsizetype sessions { 0 };         ///< Number of session runs (ie blocks).
+        qint64 bytes { 0 };               ///< Total file size, in bytes.
+    };
+
+    /// The compaction of one or more archive files, into a single archive file.
+    struct Compaction {
+        QStringList archives;             ///< Archive files to compact.
+        QString output;                   ///< Archive file to write, which may be one of #archives.
+        QString error;                    ///< Why the compaction failed, or empty if it succeeded (or is pending).
+        Statistics before;                ///< Sizes of #archives, before compacting.
+        Statistics after;                 ///< Size of #output, once compacted.
+    };
+
+    QVector<Compaction> compactions;      ///< One compaction per output file, in command line (then file name) order.
+    bool compress { false };              ///< Whether to compress the compacted archives' samples.
+    int threads { 0 };                    ///< Maximum number of archives to compact at once, or 0 for one per core.
+    ShardedWorkerPool * workers { nullptr }; ///< Threads running #compactions, once started.
+    int finished { 0 };                   ///< Number of #compactions finished (successfully, or not).
+
+    void compactionFinished(const int index);
+
+    static QString compact(const QStringList &archives, const QString &output, const bool compress,
+                           Statistics &before, Statistics &after);
+
+    QTPOKIT_BEFRIEND_TEST(CompactCommand)
+};
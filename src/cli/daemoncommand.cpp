@@ -0,0 +1,1988 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "daemoncommand.h"
+#include "websocketconnection.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/calibrationservice.h>
+#include <qtpokit/dsocapture.h>
+#include <qtpokit/pokitconnectionmanager.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/referenceclock.h>
+#include <qtpokit/samplecodec.h>
+#include <qtpokit/statusmonitor.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class DaemonCommand
+ *
+ * The DaemonCommand class implements the `daemon` CLI command.
+ *
+ * Rather than connecting to a device, performing a single action, and exiting (as all other commands do), this command
+ * keeps running, scanning for nearby devices in the background (via PokitDeviceRegistry), and serves requests from
+ * any number of local clients (such as scripts, or other applications) via a local socket, named by `--socket`. Since
+ * devices are leased via a PokitConnectionManager, devices are shared between clients, and remain connected for a
+ * while after each request, so that subsequent requests avoid the multi-second cost of connecting, and discovering
+ * the device's services, again.
+ *
+ * The protocol is newline-delimited JSON, in both directions. Each request is a JSON object with a `command`, and
+ * optionally an `id` (which is echoed, as is, in all responses and events for that request) and `device` (a device
+ * name, address or UUID, as per `--device`; otherwise the first known device is used). For example:
+ *
+ * ```
+ * {"id":1,"command":"devices"}
+ * {"id":2,"command":"status","device":"Pokit Meter"}
+ * {"id":3,"command":"meter","device":"Pokit Meter","mode":"Vdc","range":"auto","interval":"1s"}
+ * {"id":4,"command":"unsubscribe","device":"Pokit Meter"}
+ * {"id":5,"command":"dso","mode":"Vac","range":"10V","interval":"10ms","samples":1000}
+ * {"id":6,"command":"logger-fetch"}
+ * {"id":7,"command":"watch-status","device":"Pokit Meter","lowBattery":"3.5V","coalesce":"5s"}
+ * {"id":8,"command":"calibrate","device":"Pokit Meter","temperature":21.5}
+ * {"id":9,"command":"schedule","job":"logger-fetch","device":"Pokit Meter","every":"1h"}
+ * ```
+ *
+ * Each request receives a single response, being either `{"id":...,"ok":true,...}` or
+ * `{"id":...,"ok":false,"error":"..."}`. Meter subscriptions are additionally followed by
+ * `{"id":...,"event":"reading",...}` events, for each reading, until unsubscribed (or the client disconnects). Since
+ * a device can only measure one thing at a time, concurrent meter (or DSO) requests for the same device are shared
+ * if their settings match, and rejected otherwise.
+ *
+ * Status watches are likewise followed by `{"id":...,"event":"status",...}` events, whenever the device's status
+ * changes (as coalesced over `coalesce` by a StatusMonitor), and `{"id":...,"event":"alert","alert":"LowBattery",...}`
+ * events for low battery (below `lowBattery`, if given, or else as reported by the device), recovered battery, and
+ * charging changes. Since status notifications do not interfere with the device's other functions, status watches
+ * share the device's connection with any other requests, and each watch has its own thresholds.
+ *
+ * Scheduled jobs run a `status`, `logger-fetch` or `calibrate` request (with the schedule request's other fields, such
+ * as `device` and `temperature`) periodically, every `every`, until unsubscribed (or the client disconnects), with each
+ * run's response sent to the scheduling client, tagged with the `job` ID returned by the `schedule` request. So a
+ * single daemon can replace many cron jobs (one process per device, per job), without them fighting for the adapter.
+ * All jobs are held in a hierarchical TimerWheel, so the cost of keeping track of them does not grow with the number of
+ * jobs. Each run is delayed by a random jitter (up to `--jitter`, or a tenth of the job's interval), so that jobs
+ * scheduled together spread out over time, and at most `--max-jobs` runs are dispatched to the connection manager at a
+ * time, so that interactive requests are not stuck behind a queue of harvests. A job that comes due while its previous
+ * run is still in progress skips that run.
+ *
+ * Given `--prewarm`, each job's device is also pre-warmed (see PokitConnectionManager::prewarm()) that long before each
+ * run, via a free connection, if any, so that the run starts on time, rather than only once the device has connected,
+ * and its services have been discovered. Pre-warming times are held in a TimerWheel of their own, so looking ahead is
+ * no more costly than the schedule itself.
+ *
+ * The sample arrays of `dso` and `logger-fetch` responses are, by default, JSON arrays of scaled `values`, which cost
+ * some 8 to 12 bytes per sample. Clients (such as those on other machines, via forwarded sockets) may instead
+ * negotiate a compact `encoding` per request: `delta-varint`, for the raw samples' zigzag varint deltas (as per
+ * SampleCodec), or `delta-varint-zlib`, for the same, further zlib-compressed (as per qCompress(), so prefixed with
+ * the big-endian, 32-bit, size of the uncompressed deltas). Either way, the response then has the base64 encoded
+ * `samples`, their `count`, the `scale` to multiply each raw sample by, and the `encoding` used, instead of `values`.
+ * Unsupported encodings are rejected, with the supported encodings listed in the error. Every response is encoded
+ * independently of all others, with no state carried between responses (such as a previous sample, or a shared
+ * dictionary), so a client may join (or re-join) a shared capture, or scheduled job, at any point, and decode
+ * every response it receives. Since encoding is done once per encoding, per response, however many clients share it,
+ * it adds no more latency than the JSON array it replaces.
+ *
+ * Given `--listen`, the same requests are also served to WebSocket clients (such as browser dashboards), one request
+ * per text message, and one response (or event) per text message. Each meter subscription may then set its own rate,
+ * independent of the device's `interval` (which all subscribers must share): given an `every` period, a subscriber
+ * receives at most one reading event per period, with the `mean` (or, given `"aggregate":"last"`, the last) of the
+ * readings since its previous event, and their `min`, `max` and `count`. Likewise, `dso` and `logger-fetch` requests
+ * may limit their responses to `points` samples, by min/max decimation of the raw samples (so peaks survive), with the
+ * original sample count as `decimatedFrom`. Each WebSocket client has its own bounded send queue (see
+ * WebSocketConnection), so a slow client only ever drops its own messages (and is told how many), rather than
+ * delaying other clients, or growing the daemon's memory without bound. These fields work the same way for local
+ * socket clients, too.
+ *
+ * Given `--aggregator`, the daemon also joins a cluster as a gateway (named by `--gateway-name`, or the host name): it
+ * connects to the AggregatorCommand at that address, registers its capacity (`--max-connections`), and reports its
+ * registry's devices (including their smoothed RSSI) every #reportInterval milliseconds. The aggregator then assigns
+ * each device to a single gateway (via `assign` requests), and forwards clients' requests for that device to its
+ * gateway, over the same connection, which the daemon serves just like any other client's. Lost connections to the
+ * aggregator are re-established every #reconnectInterval milliseconds.
+ *
+ * Since events from different gateways are only as comparable as those gateways' clocks, `--reference-clock`
+ * disciplines every event's `timestamp` against NTP, or a PTP hardware clock (see ReferenceClock), and adds its error
+ * bound, as `timestampUncertainty` microseconds (or `null` while the reference is not synchronised). The reference's
+ * status is reported to the aggregator, too, as each gateway's `clock`.
+ */
+
+/*!
+ * Construct a new DaemonCommand object with \a parent.
+ */
+DaemonCommand::DaemonCommand(QObject * const parent) : AbstractCommand(parent),
+    referenceClock(new ReferenceClock(this)), registry(new PokitDeviceRegistry(this)),
+    manager(new PokitConnectionManager(this))
+{
+    // Queued, since the manager may grant a warm device before request() has even returned its ticket.
+    connect(manager, &PokitConnectionManager::granted, this, &DaemonCommand::granted, Qt::QueuedConnection);
+    connect(manager, &PokitConnectionManager::failed, this, &DaemonCommand::failed, Qt::QueuedConnection);
+
+    clock.start(); // The wheel starts at time 0.
+    wheelTimer = new QTimer(this);
+    connect(wheelTimer, &QTimer::timeout, this, &DaemonCommand::advanceJobs);
+}
+
+QStringList DaemonCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser);
+}
+
+QStringList DaemonCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"aggregator"_s,
+        u"gateway-name"_s,
+        u"jitter"_s,
+        u"listen"_s,
+        u"max-connections"_s,
+        u"max-jobs"_s,
+        u"prewarm"_s,
+        u"reference-clock"_s,
+        u"socket"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList DaemonCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the socket option.
+    if (parser.isSet(u"socket"_s)) {
+        socketName = parser.value(u"socket"_s).trimmed();
+        if (socketName.isEmpty()) {
+            errors.append(tr("Invalid socket name: %1").arg(parser.value(u"socket"_s)));
+        }
+    }
+
+    // Parse the listen option, being a port, optionally preceded by an address (IPv6 addresses in brackets).
+    if (parser.isSet(u"listen"_s)) {
+        const QString value = parser.value(u"listen"_s).trimmed();
+        const qsizetype colon = value.lastIndexOf(u':');
+        QString host = (colon < 0) ? QString() : value.left(colon);
+        bool ok = false;
+        const uint port = value.mid(colon + 1).toUInt(&ok);
+        if ((host.startsWith(u'[')) && (host.endsWith(u']'))) {
+            host = host.mid(1, host.size() - 2);
+        }
+        const QHostAddress address = (host.isEmpty()) ? QHostAddress(QHostAddress::LocalHost)
+            : (host == u"*"_s) ? QHostAddress(QHostAddress::Any)
+            : (host.compare(u"localhost"_s, Qt::CaseInsensitive) == 0) ? QHostAddress(QHostAddress::LocalHost)
+            : QHostAddress(host);
+        if ((!ok) || (port == 0) || (port > std::numeric_limits<quint16>::max()) || (address.isNull())) {
+            errors.append(tr("Invalid listen value: %1").arg(value));
+        } else {
+            listenAddress = address;
+            listenPort = (quint16)port;
+        }
+    }
+
+    // Parse the aggregator option, being a port, optionally preceded by a host (IPv6 addresses in brackets).
+    if (parser.isSet(u"aggregator"_s)) {
+        const QString value = parser.value(u"aggregator"_s).trimmed();
+        const qsizetype colon = value.lastIndexOf(u':');
+        QString host = (colon < 0) ? u"localhost"_s : value.left(colon);
+        bool ok = false;
+        const uint port = value.mid(colon + 1).toUInt(&ok);
+        if ((host.startsWith(u'[')) && (host.endsWith(u']'))) {
+            host = host.mid(1, host.size() - 2);
+        }
+        if ((!ok) || (port == 0) || (port > std::numeric_limits<quint16>::max()) || (host.isEmpty())) {
+            errors.append(tr("Invalid aggregator value: %1").arg(value));
+        } else {
+            aggregatorHost = host;
+            aggregatorPort = (quint16)port;
+        }
+    }
+
+    // Parse the gateway-name option.
+    if (parser.isSet(u"gateway-name"_s)) {
+        gatewayName = parser.value(u"gateway-name"_s).trimmed();
+        if (gatewayName.isEmpty()) {
+            errors.append(tr("Invalid gateway-name value: %1").arg(parser.value(u"gateway-name"_s)));
+        }
+    }
+
+    // Parse the max-connections option.
+    if (parser.isSet(u"max-connections"_s)) {
+        const QString value = parser.value(u"max-connections"_s);
+        bool ok;
+        const int connections = value.toInt(&ok);
+        if ((!ok) || (connections <= 0)) {
+            errors.append(tr("Invalid max-connections value: %1").arg(value));
+        } else {
+            maxConnections = connections;
+        }
+    }
+    manager->setMaxConnections(maxConnections);
+
+    // Parse the max-jobs option.
+    if (parser.isSet(u"max-jobs"_s)) {
+        const QString value = parser.value(u"max-jobs"_s);
+        bool ok;
+        const int jobs = value.toInt(&ok);
+        if ((!ok) || (jobs <= 0)) {
+            errors.append(tr("Invalid max-jobs value: %1").arg(value));
+        } else {
+            maxJobs = jobs;
+        }
+    }
+
+    // Parse the jitter option.
+    if (parser.isSet(u"jitter"_s)) {
+        const QString value = parser.value(u"jitter"_s);
+        const quint32 delay = (value.trimmed() == u"0"_s) ? 0 : parseNumber<std::milli>(value, u"s"_s, 500);
+        if ((delay == 0) && (value.trimmed() != u"0"_s)) {
+            errors.append(tr("Invalid jitter value: %1").arg(value));
+        } else {
+            jitter = delay;
+        }
+    }
+
+    // Parse the prewarm option, which must be less than the manager's idle timeout, else connections would be
+    // disconnected (as idle) before their jobs run.
+    if (parser.isSet(u"prewarm"_s)) {
+        const QString value = parser.value(u"prewarm"_s);
+        const quint32 lead = (value.trimmed() == u"0"_s) ? 0 : parseNumber<std::milli>(value, u"s"_s, 500);
+        if (((lead == 0) && (value.trimmed() != u"0"_s)) || (lead >= manager->idleTimeout())) {
+            errors.append(tr("Invalid prewarm value: %1").arg(value));
+        } else {
+            prewarmLead = lead;
+        }
+    }
+
+    // Parse the reference-clock option, being `ntp`, or `ptp`, optionally followed by a PTP hardware clock device.
+    if (parser.isSet(u"reference-clock"_s)) {
+        const QString value = parser.value(u"reference-clock"_s).trimmed();
+        const QString source = value.section(u':', 0, 0).toLower();
+        const QString device = value.section(u':', 1);
+        if ((source == u"ntp"_s) && (device.isEmpty())) {
+            if (!referenceClock->setSource(ReferenceClock::Source::Ntp)) {
+                errors.append(referenceClock->errorString());
+            }
+        } else if (source == u"ptp"_s) {
+            if (!referenceClock->setSource(ReferenceClock::Source::Ptp, device)) {
+                errors.append(referenceClock->errorString());
+            }
+        } else {
+            errors.append(tr("Invalid reference-clock value: %1").arg(value));
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Begins listening for local clients (and WebSocket clients, if `--listen` was given), and scanning for nearby
+ * devices.
+ *
+ * If another process has left a stale socket behind (such as a previous daemon that did not exit cleanly), it is
+ * removed; but if another daemon is still listening on the socket, this command fails instead.
+ */
+bool DaemonCommand::start()
+{
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    if ((!server->listen(socketName)) && (server->serverError() == QAbstractSocket::AddressInUseError)) {
+        QLocalSocket probe;
+        probe.connectToServer(socketName);
+        if (probe.waitForConnected(1000)) {
+            qCWarning(lc).noquote() << tr("Another daemon is already listening on %1.").arg(socketName);
+            return false;
+        }
+        qCDebug(lc).noquote() << tr("Removing stale socket %1.").arg(socketName);
+        QLocalServer::removeServer(socketName);
+        server->listen(socketName);
+    }
+    if (!server->isListening()) {
+        qCWarning(lc).noquote() << tr("Failed to listen on %1: %2").arg(socketName, server->errorString());
+        return false;
+    }
+    connect(server, &QLocalServer::newConnection, this, &DaemonCommand::newConnection);
+    qCInfo(lc).noquote() << tr("Listening on %1.").arg(server->fullServerName());
+    if (listenPort != 0) {
+        webSocketServer = new QTcpServer(this);
+        if (!webSocketServer->listen(listenAddress, listenPort)) {
+            qCWarning(lc).noquote() << tr("Failed to listen on %1 port %2: %3").arg(listenAddress.toString())
+                .arg(listenPort).arg(webSocketServer->errorString());
+            return false;
+        }
+        connect(webSocketServer, &QTcpServer::newConnection, this, &DaemonCommand::newWebSocketConnection);
+        qCInfo(lc).noquote() << tr("Serving WebSocket clients at ws://%1:%2/").arg(
+            (listenAddress.protocol() == QAbstractSocket::IPv6Protocol) ? u"[%1]"_s.arg(listenAddress.toString())
+                : listenAddress.toString()).arg(webSocketServer->serverPort());
+    }
+    if (aggregatorPort != 0) {
+        registry->discoveryAgent()->setRssiSmoothing(0.25f); // So that devices are not handed off on a single blip.
+        aggregator = new QTcpSocket(this);
+        reportTimer = new QTimer(this);
+        reconnectTimer = new QTimer(this);
+        reconnectTimer->setSingleShot(true);
+        connect(reportTimer, &QTimer::timeout, this, &DaemonCommand::reportDevices);
+        connect(reconnectTimer, &QTimer::timeout, this, &DaemonCommand::connectToAggregator);
+        connect(aggregator, &QTcpSocket::connected, this, &DaemonCommand::aggregatorConnected);
+        connect(aggregator, &QTcpSocket::disconnected, this, &DaemonCommand::aggregatorDisconnected);
+        connect(aggregator, &QTcpSocket::readyRead, this, [this]() { readRequests(aggregator); });
+        connect(aggregator,
+            #if (QT_VERSION < QT_VERSION_CHECK(5, 15, 0))
+            QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
+            #else
+            &QAbstractSocket::errorOccurred,
+            #endif
+            this, [this]() {
+                if (aggregator->state() == QAbstractSocket::UnconnectedState) {
+                    aggregatorDisconnected(); // Never connected, so disconnected() will not be emitted.
+                }
+            });
+        connectToAggregator();
+    }
+    registry->start();
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscovered
+ *
+ * This override does nothing, since this command discovers devices via #registry instead.
+ */
+void DaemonCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_UNUSED(info)
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscoveryFinished
+ *
+ * This override does nothing, since this command discovers devices via #registry instead.
+ */
+void DaemonCommand::deviceDiscoveryFinished()
+{
+
+}
+
+/*!
+ * Accepts all pending client connections.
+ */
+void DaemonCommand::newConnection()
+{
+    while (server->hasPendingConnections()) {
+        QLocalSocket * const client = server->nextPendingConnection();
+        qCDebug(lc).noquote() << tr("Client connected.");
+        connect(client, &QLocalSocket::readyRead, this, [this, client]() { readRequests(client); });
+        connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+            qCDebug(lc).noquote() << tr("Client disconnected.");
+            clientDisconnected(client);
+            client->deleteLater();
+        });
+    }
+}
+
+/*!
+ * Accepts all pending WebSocket client connections. Each client's requests are read, and handled, exactly as per local
+ * socket clients, once its WebSocketConnection has completed the opening handshake.
+ */
+void DaemonCommand::newWebSocketConnection()
+{
+    while (webSocketServer->hasPendingConnections()) {
+        QTcpSocket * const socket = webSocketServer->nextPendingConnection();
+        WebSocketConnection * const client = new WebSocketConnection(socket, this);
+        qCDebug(lc).noquote() << tr("WebSocket client connected from %1.").arg(client->peerName());
+        connect(client, &WebSocketConnection::readyRead, this, [this, client]() { readRequests(client); });
+        connect(client, &WebSocketConnection::disconnected, this, [this, client]() {
+            qCDebug(lc).noquote() << tr("WebSocket client disconnected, after %Ln dropped message(s).", nullptr,
+                (int)client->droppedMessages());
+            clientDisconnected(client);
+            client->deleteLater();
+        });
+    }
+}
+
+/*!
+ * Reads, and handles, all complete requests (ie lines) from \a client.
+ */
+void DaemonCommand::readRequests(QIODevice * const client)
+{
+    while (client->canReadLine()) {
+        const QByteArray line = client->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(line, &error);
+        const QJsonObject response = (document.isObject()) ? handleRequest(client, document.object())
+            : errorResponse(QJsonValue(), (error.error == QJsonParseError::NoError)
+                ? tr("Request is not a JSON object") : tr("Invalid request: %1").arg(error.errorString()));
+        if (!response.isEmpty()) {
+            send(client, response);
+        }
+    }
+    if (client->bytesAvailable() > maxRequestSize) {
+        qCWarning(lc).noquote() << tr("Disconnecting client after %L1 bytes without a complete request.")
+            .arg(client->bytesAvailable());
+        send(client, errorResponse(QJsonValue(), tr("Request too long")));
+        client->close();
+    }
+}
+
+/*!
+ * Removes all of \a client's meter subscriptions, status watches, and scheduled jobs, stopping (and releasing) any
+ * meters, and status notifications, no longer subscribed to.
+ *
+ * Other outstanding requests are left to complete, since the device is in the middle of them anyway, and their
+ * responses are then simply discarded.
+ */
+void DaemonCommand::clientDisconnected(QIODevice * const client)
+{
+    const QStringList keys = sessions.keys();
+    for (const QString &key: keys) {
+        QVector<MeterSubscriber> &subscribers = sessions[key].meterSubscribers;
+        const bool subscribed = !subscribers.isEmpty();
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+            [client](const MeterSubscriber &subscriber) { return subscriber.reply.client == client; }),
+            subscribers.end());
+        if ((subscribed) && (subscribers.isEmpty())) {
+            stopMeter(key);
+        }
+        if ((sessions.contains(key)) && (removeStatusWatchers(key, client) > 0) &&
+            (sessions.value(key).statusWatchers.isEmpty())) {
+            unwatchStatus(key);
+        }
+    }
+    removeScheduledJobs(client);
+}
+
+/*!
+ * Handles \a request from \a client, returning the response to send, or an empty object if the response will be sent
+ * later (such as once the requested device has been connected to). If not 0, \a job is the ID of the scheduled job
+ * the request is a run of.
+ */
+QJsonObject DaemonCommand::handleRequest(QIODevice * const client, const QJsonObject &request, const quint32 job)
+{
+    const QJsonValue id = request.value(u"id"_s);
+    const QString command = request.value(u"command"_s).toString();
+    const QString deviceName = toOptionValue(request.value(u"device"_s));
+    if (command.isEmpty()) {
+        return errorResponse(id, tr("Missing command"));
+    } else if (command == u"devices"_s) {
+        return devicesResponse(id);
+    } else if (command == u"unsubscribe"_s) {
+        return unsubscribe(client, id, deviceName);
+    } else if (command == u"schedule"_s) {
+        return scheduleJob(client, request);
+    } else if (command == u"assign"_s) {
+        return assign(id, request.value(u"devices"_s));
+    } else if ((command != u"status"_s) && (command != u"meter"_s) && (command != u"dso"_s) &&
+               (command != u"logger-fetch"_s) && (command != u"watch-status"_s) && (command != u"calibrate"_s)) {
+        return errorResponse(id, tr("Unknown command: %1").arg(command));
+    }
+
+    // Parse the meter, DSO, status, or calibration settings (if any) before looking up the device, so errors are
+    // reported consistently.
+    MultimeterService::Settings meterSettings{ MultimeterService::Mode::Idle, 0, 1000 };
+    DsoService::Settings dsoSettings{ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage,
+        0, 1'000'000, 1000 };
+    MeterCommand::MinRangeFunc rangeFunc = nullptr;
+    quint32 rangeValue = 0;
+    quint32 coalesceInterval = 1000;
+    quint32 lowBatteryThreshold = 0;
+    float temperature = 0.0f;
+    Encoding encoding = Encoding::Json;
+    quint32 points = 0;
+    quint32 every = 0;
+    bool last = false;
+    QStringList errors = (command == u"meter"_s)
+        ? parseMeterSettings(request, meterSettings, rangeFunc, rangeValue) : (command == u"dso"_s)
+        ? parseDsoSettings(request, dsoSettings, rangeFunc, rangeValue) : (command == u"watch-status"_s)
+        ? parseStatusSettings(request, coalesceInterval, lowBatteryThreshold) : (command == u"calibrate"_s)
+        ? parseCalibrationSettings(request, temperature) : QStringList();
+    if ((command == u"dso"_s) || (command == u"logger-fetch"_s)) {
+        errors.append(parseEncoding(request, encoding));
+        errors.append(parsePoints(request, points));
+    } else if (command == u"meter"_s) {
+        errors.append(parseRate(request, every, last));
+    }
+    if (!errors.isEmpty()) {
+        return errorResponse(id, errors.join(u"; "_s));
+    }
+
+    const std::optional<PokitDeviceRegistry::Entry> entry = findDevice(deviceName);
+    if (!entry) {
+        return errorResponse(id, (deviceName.isEmpty()) ? tr("No devices found")
+            : tr(R"(Device not found: "%1")").arg(deviceName));
+    }
+    const QString key = PokitDeviceRegistry::key(entry->info);
+    Session &session = sessions[key];
+    session.name = entry->name;
+    session.product = entry->product;
+    const Reply reply{ client, id, job, encoding, points };
+
+    if (command == u"status"_s) {
+        session.statusReplies.append(reply);
+        if (session.statusReplies.size() == 1) {
+            enqueue(*entry, [this, key]() { readStatus(key); });
+        }
+        return QJsonObject();
+    }
+
+    if (command == u"watch-status"_s) {
+        StatusMonitor * const monitor = new StatusMonitor(nullptr, this); // Fed by statusRead().
+        monitor->setCoalesceInterval(coalesceInterval);
+        if (lowBatteryThreshold > 0) {
+            monitor->setLowBatteryThreshold((float)lowBatteryThreshold / 1000.0f);
+        }
+        const QString name = session.name;
+        connect(monitor, &StatusMonitor::statusChanged, monitor,
+            [this, reply, name](const StatusService::Status &status) {
+                QJsonObject event = toJson(status);
+                event.insert(u"event"_s, u"status"_s);
+                event.insert(u"device"_s, name);
+                stamp(event);
+                send(QVector<Reply>{ reply }, event);
+            });
+        connect(monitor, &StatusMonitor::alertRaised, monitor,
+            [this, reply, name](const StatusMonitor::Alert alert, const StatusService::Status &status) {
+                QJsonObject event = toJson(status);
+                event.insert(u"event"_s, u"alert"_s);
+                event.insert(u"alert"_s, StatusMonitor::toString(alert));
+                event.insert(u"device"_s, name);
+                stamp(event);
+                send(QVector<Reply>{ reply }, event);
+            });
+        session.statusWatchers.append({ reply, monitor });
+        enqueue(*entry, [this, key]() { watchStatus(key); });
+        return okResponse(id, QJsonObject{ { u"device"_s, session.name }, { u"subscribed"_s, true } });
+    }
+
+    if (command == u"meter"_s) {
+        if (!session.meterSubscribers.isEmpty()) {
+            if ((session.meterSettings.mode != meterSettings.mode) || (session.meterRange != rangeValue) ||
+                (session.meterSettings.updateInterval != meterSettings.updateInterval)) {
+                return errorResponse(id, tr(R"(Device "%1" is already metering with different settings)")
+                    .arg(session.name));
+            }
+            session.meterSubscribers.append({ reply, every, last, clock.elapsed() + every });
+        } else {
+            session.meterSubscribers.append({ reply, every, last, clock.elapsed() + every });
+            session.meterSettings = meterSettings;
+            session.meterRangeFunc = rangeFunc;
+            session.meterRange = rangeValue;
+            enqueue(*entry, [this, key]() { startMeter(key); });
+        }
+        return okResponse(id, QJsonObject{ { u"device"_s, session.name }, { u"subscribed"_s, true } });
+    }
+
+    if (command == u"dso"_s) {
+        if (!session.dsoReplies.isEmpty()) {
+            if ((session.dsoSettings.mode != dsoSettings.mode) || (session.dsoRange != rangeValue) ||
+                (session.dsoSettings.samplingWindow != dsoSettings.samplingWindow) ||
+                (session.dsoSettings.numberOfSamples != dsoSettings.numberOfSamples)) {
+                return errorResponse(id, tr(R"(Device "%1" is already capturing with different settings)")
+                    .arg(session.name));
+            }
+            session.dsoReplies.append(reply);
+        } else {
+            session.dsoReplies.append(reply);
+            session.dsoSettings = dsoSettings;
+            session.dsoRangeFunc = rangeFunc;
+            session.dsoRange = rangeValue;
+            enqueue(*entry, [this, key]() { captureDso(key); });
+        }
+        return QJsonObject();
+    }
+
+    if (command == u"calibrate"_s) {
+        if ((!session.calibrationReplies.isEmpty()) && (session.calibrationTemperature != temperature)) {
+            return errorResponse(id, tr(R"(Device "%1" is already calibrating at a different temperature)")
+                .arg(session.name));
+        }
+        session.calibrationReplies.append(reply);
+        session.calibrationTemperature = temperature;
+        if (session.calibrationReplies.size() == 1) {
+            enqueue(*entry, [this, key]() { calibrate(key); });
+        }
+        return QJsonObject();
+    }
+
+    Q_ASSERT(command == u"logger-fetch"_s);
+    session.loggerReplies.append(reply);
+    if (session.loggerReplies.size() == 1) {
+        enqueue(*entry, [this, key]() { fetchLogger(key); });
+    }
+    return QJsonObject();
+}
+
+/*!
+ * Returns the response to a `devices` request with \a id, listing all devices currently known to #registry.
+ */
+QJsonObject DaemonCommand::devicesResponse(const QJsonValue &id) const
+{
+    QJsonArray devices;
+    const QVector<PokitDeviceRegistry::Entry> entries = registry->devices();
+    for (const PokitDeviceRegistry::Entry &entry: entries) {
+        QJsonObject device{
+            { u"key"_s,             PokitDeviceRegistry::key(entry.info) },
+            { u"name"_s,            entry.name },
+            { u"product"_s,         toString(entry.product) },
+            { u"rssi"_s,            entry.rssi },
+            { u"lastSeen"_s,        entry.lastSeen },
+            { u"connectionState"_s, PokitDeviceRegistry::toString(entry.connectionState) },
+        };
+        if (!entry.info.address().isNull()) {
+            device.insert(u"address"_s, entry.info.address().toString());
+        }
+        if (!entry.info.deviceUuid().isNull()) {
+            device.insert(u"uuid"_s, entry.info.deviceUuid().toString());
+        }
+        devices.append(device);
+    }
+    return okResponse(id, QJsonObject{ { u"devices"_s, devices } });
+}
+
+/*!
+ * Removes \a client's meter subscriptions, status watches, and scheduled jobs, for the device identified by
+ * \a deviceName (or for all devices, if \a deviceName is empty), and returns the response to the `unsubscribe` request
+ * with \a id.
+ */
+QJsonObject DaemonCommand::unsubscribe(QIODevice * const client, const QJsonValue &id, const QString &deviceName)
+{
+    int count = 0;
+    const QStringList keys = sessions.keys();
+    for (const QString &key: keys) {
+        Session &session = sessions[key];
+        if ((!deviceName.isEmpty()) && (deviceName != session.name) && (deviceName != key)) {
+            continue;
+        }
+        QVector<MeterSubscriber> &subscribers = session.meterSubscribers;
+        const qsizetype size = subscribers.size();
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+            [client](const MeterSubscriber &subscriber) { return subscriber.reply.client == client; }),
+            subscribers.end());
+        count += (int)(size - subscribers.size());
+        if ((size > 0) && (subscribers.isEmpty())) {
+            stopMeter(key);
+        }
+        if (sessions.contains(key)) {
+            const int watches = removeStatusWatchers(key, client);
+            count += watches;
+            if ((watches > 0) && (sessions.value(key).statusWatchers.isEmpty())) {
+                unwatchStatus(key);
+            }
+        }
+    }
+    count += removeScheduledJobs(client, deviceName);
+    return okResponse(id, QJsonObject{ { u"unsubscribed"_s, count } });
+}
+
+/*!
+ * Removes (and deletes the monitors of) all of \a client's status watches of the device for \a key, returning the
+ * number of watches removed.
+ */
+int DaemonCommand::removeStatusWatchers(const QString &key, QIODevice * const client)
+{
+    const auto iter = sessions.find(key);
+    if (iter == sessions.end()) {
+        return 0;
+    }
+    QVector<StatusWatcher> &watchers = iter->statusWatchers;
+    const auto begin = std::stable_partition(watchers.begin(), watchers.end(),
+        [client](const StatusWatcher &watcher) { return watcher.reply.client != client; });
+    const int count = (int)std::distance(begin, watchers.end());
+    std::for_each(begin, watchers.end(), [](const StatusWatcher &watcher) { delete watcher.monitor; });
+    watchers.erase(begin, watchers.end());
+    return count;
+}
+
+/*!
+ * Returns the first device known to #registry that matches \a deviceName (per AbstractCommand::isMatchingDevice), if
+ * any. An empty \a deviceName matches any device.
+ */
+std::optional<PokitDeviceRegistry::Entry> DaemonCommand::findDevice(const QString &deviceName) const
+{
+    const QVector<PokitDeviceRegistry::Entry> entries = registry->devices();
+    const auto iter = std::find_if(entries.cbegin(), entries.cend(), [&deviceName](const auto &entry) {
+        return isMatchingDevice(entry.info, deviceName);
+    });
+    return (iter == entries.cend()) ? std::nullopt : std::optional<PokitDeviceRegistry::Entry>(*iter);
+}
+
+/*!
+ * Connects to the aggregator, to join its cluster as a gateway.
+ */
+void DaemonCommand::connectToAggregator()
+{
+    if (aggregator->state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Connecting to aggregator %1 port %2.").arg(aggregatorHost).arg(aggregatorPort);
+    aggregator->connectToHost(aggregatorHost, aggregatorPort);
+}
+
+/*!
+ * Registers with the aggregator, as gateway #gatewayName, then reports this gateway's devices (and keeps doing so,
+ * every #reportInterval milliseconds, while connected).
+ */
+void DaemonCommand::aggregatorConnected()
+{
+    qCInfo(lc).noquote() << tr(R"(Joined aggregator %1 port %2 as gateway "%3".)").arg(aggregatorHost)
+        .arg(aggregatorPort).arg(gatewayName);
+    QJsonObject event{
+        { u"event"_s,    u"register"_s },
+        { u"gateway"_s,  gatewayName },
+        { u"capacity"_s, maxConnections },
+    };
+    if (const QJsonObject clock = clockReport(); !clock.isEmpty()) {
+        event.insert(u"clock"_s, clock);
+    }
+    send(aggregator, event);
+    reportDevices();
+    reportTimer->start(reportInterval);
+}
+
+/*!
+ * Handles the connection to the aggregator being lost (or failing to be established), by dropping the aggregator's
+ * requests, and assignments, and scheduling a reconnection.
+ */
+void DaemonCommand::aggregatorDisconnected()
+{
+    reportTimer->stop();
+    if (reconnectTimer->isActive()) {
+        return; // Already handled, such as by both an error, and a disconnection.
+    }
+    qCWarning(lc).noquote() << tr("Not connected to aggregator %1 port %2 (%3); retrying in %L4ms.")
+        .arg(aggregatorHost).arg(aggregatorPort).arg(aggregator->errorString()).arg(reconnectInterval);
+    clientDisconnected(aggregator);
+    assignedDevices.clear();
+    reconnectTimer->start(reconnectInterval);
+}
+
+/*!
+ * Reports all devices known to #registry (as per the `devices` request) to the aggregator.
+ */
+void DaemonCommand::reportDevices()
+{
+    if ((aggregator) && (aggregator->state() == QAbstractSocket::ConnectedState)) {
+        QJsonObject event{
+            { u"event"_s,   u"devices"_s },
+            { u"gateway"_s, gatewayName },
+            { u"devices"_s, devicesResponse(QJsonValue()).value(u"devices"_s) },
+        };
+        if (const QJsonObject clock = clockReport(); !clock.isEmpty()) {
+            event.insert(u"clock"_s, clock);
+        }
+        send(aggregator, event);
+    }
+}
+
+/*!
+ * Returns #referenceClock's current status, for reporting to the aggregator (so that it, and its clients, know how far
+ * this gateway's timestamps may be trusted), or an empty object if no `--reference-clock` was given.
+ */
+QJsonObject DaemonCommand::clockReport() const
+{
+    if (referenceClock->source() == ReferenceClock::Source::System) {
+        return QJsonObject();
+    }
+    const ReferenceClock::Status status = referenceClock->status();
+    const ReferenceClock::Timestamp now = referenceClock->now();
+    QJsonObject report{
+        { u"source"_s,       ReferenceClock::toString(status.source) },
+        { u"synchronised"_s, status.synchronised },
+        { u"offset"_s,       status.offset },
+        { u"uncertainty"_s,  (now.uncertainty < 0) ? QJsonValue() : QJsonValue(now.uncertainty) },
+    };
+    if (!referenceClock->device().isEmpty()) {
+        report.insert(u"device"_s, referenceClock->device());
+    }
+    if (!status.error.isEmpty()) {
+        report.insert(u"error"_s, status.error);
+    }
+    return report;
+}
+
+/*!
+ * Stamps \a event with the current time, disciplined by #referenceClock. If a `--reference-clock` was given, the
+ * event is also stamped with the timestamp's error bound, in microseconds, or `null` while the reference is not
+ * synchronised, so that events from different gateways are only ever compared as far as their bounds allow.
+ */
+void DaemonCommand::stamp(QJsonObject &event) const
+{
+    const ReferenceClock::Timestamp now = referenceClock->now();
+    event.insert(u"timestamp"_s, now.time);
+    if (referenceClock->source() != ReferenceClock::Source::System) {
+        event.insert(u"timestampUncertainty"_s, (now.uncertainty < 0) ? QJsonValue() : QJsonValue(now.uncertainty));
+    }
+}
+
+/*!
+ * Records the aggregator's assignment of \a devices (an array of registry keys) to this gateway, and returns the
+ * response to the `assign` request with \a id.
+ *
+ * Devices no longer assigned to this gateway (such as those being handed off to another gateway that hears them
+ * better) are disconnected straight away, if idle, rather than being kept warm, since Pokit devices accept just one
+ * connection at a time, and so would otherwise keep the new gateway waiting. The aggregator unsubscribes from such
+ * devices first, so they are idle, unless still in use by this daemon's own local clients.
+ */
+QJsonObject DaemonCommand::assign(const QJsonValue &id, const QJsonValue &devices)
+{
+    if (!devices.isArray()) {
+        return errorResponse(id, tr("Missing devices"));
+    }
+    QSet<QString> keys;
+    for (const QJsonValue &device: devices.toArray()) {
+        keys.insert(device.toString());
+    }
+    if (keys != assignedDevices) {
+        qCInfo(lc).noquote() << tr("Assigned %Ln device(s) by the aggregator.", nullptr, (int)keys.size());
+        for (const QString &key: std::as_const(assignedDevices)) {
+            const std::optional<PokitDeviceRegistry::Entry> entry = registry->device(key);
+            if ((!keys.contains(key)) && (entry) && (manager->disconnectIdle(entry->info))) {
+                qCDebug(lc).noquote() << tr("Released %1, for its new gateway.").arg(key);
+            }
+        }
+        assignedDevices = keys;
+    }
+    return okResponse(id, QJsonObject{ { u"assigned"_s, (qint64)keys.size() } });
+}
+
+/*!
+ * Schedules the periodic job described by the `schedule` \a request, from \a client, and returns the response to send.
+ *
+ * The job's first run is due after just its jitter, so that a freshly (re)started daemon catches up straight away,
+ * but without all of its jobs running at once.
+ */
+QJsonObject DaemonCommand::scheduleJob(QIODevice * const client, const QJsonObject &request)
+{
+    const QJsonValue id = request.value(u"id"_s);
+    const QString command = request.value(u"job"_s).toString();
+    if ((command != u"status"_s) && (command != u"logger-fetch"_s) && (command != u"calibrate"_s)) {
+        return errorResponse(id, (command.isEmpty()) ? tr("Missing job") : tr("Unknown job: %1").arg(command));
+    }
+
+    QStringList errors;
+    const QString every = toOptionValue(request.value(u"every"_s));
+    const quint32 interval = parseNumber<std::milli>(every, u"s"_s, 500);
+    if (interval < wheel.tickInterval()) {
+        errors.append(tr("Invalid every value: %1").arg(every));
+    }
+    float temperature = 0.0f;
+    if (command == u"calibrate"_s) {
+        errors.append(parseCalibrationSettings(request, temperature));
+    }
+    // The encoding, and points, are only validated here, since each run parses its own request.
+    Encoding encoding = Encoding::Json;
+    quint32 points = 0;
+    if (command == u"logger-fetch"_s) {
+        errors.append(parseEncoding(request, encoding));
+        errors.append(parsePoints(request, points));
+    }
+    if (!errors.isEmpty()) {
+        return errorResponse(id, errors.join(u"; "_s));
+    }
+
+    QJsonObject jobRequest = request;
+    jobRequest.insert(u"command"_s, command);
+    jobRequest.remove(u"job"_s);
+    jobRequest.remove(u"every"_s);
+    const quint32 jobId = ++lastJobId;
+    const qint64 now = clock.elapsed();
+    scheduledJobs.insert(jobId, ScheduledJob{ Reply{ client, id, jobId }, jobRequest, interval, now, false });
+    const qint64 due = now + jitterFor(interval);
+    wheel.schedule(jobId, due);
+    schedulePrewarm(jobId, due);
+    if (!wheelTimer->isActive()) {
+        wheelTimer->start((int)wheel.tickInterval());
+    }
+    qCDebug(lc).noquote() << tr("Scheduled job %1 (%2), every %L3ms.").arg(jobId).arg(command).arg(interval);
+    return okResponse(id, QJsonObject{ { u"job"_s, (qint64)jobId }, { u"every"_s, (qint64)interval } });
+}
+
+/*!
+ * Removes all of \a client's scheduled jobs for the device identified by \a deviceName (or for all devices, if
+ * \a deviceName is empty), and returns the number of jobs removed. Runs already in progress are left to complete.
+ */
+int DaemonCommand::removeScheduledJobs(QIODevice * const client, const QString &deviceName)
+{
+    int count = 0;
+    for (auto iter = scheduledJobs.begin(); iter != scheduledJobs.end();) {
+        if ((iter->reply.client == client) && ((deviceName.isEmpty()) ||
+            (toOptionValue(iter->request.value(u"device"_s)) == deviceName))) {
+            wheel.cancel(iter.key());
+            prewarmWheel.cancel(iter.key());
+            iter = scheduledJobs.erase(iter);
+            ++count;
+        } else {
+            ++iter;
+        }
+    }
+    if (scheduledJobs.isEmpty()) {
+        wheelTimer->stop();
+    }
+    return count;
+}
+
+/*!
+ * Advances the #wheel to the current time, rescheduling each job that has come due, and queuing it for dispatch,
+ * unless its previous run is still in progress. Then advances the #prewarmWheel, pre-warming the devices of jobs
+ * that are due soon.
+ */
+void DaemonCommand::advanceJobs()
+{
+    const qint64 now = clock.elapsed();
+    const QVector<quint32> expired = wheel.advance(now);
+    for (const quint32 id: expired) {
+        const auto iter = scheduledJobs.find(id);
+        if (iter == scheduledJobs.end()) {
+            continue;
+        }
+        // Schedule relative to the nominal (un-jittered) time, so jitter does not accumulate as drift, but without
+        // trying to catch up on runs missed altogether, such as while the host was suspended.
+        iter->nominalTime = std::max(iter->nominalTime + iter->interval, now);
+        const qint64 due = iter->nominalTime + jitterFor(iter->interval);
+        wheel.schedule(id, due);
+        schedulePrewarm(id, due);
+        if (iter->running) {
+            qCDebug(lc).noquote() << tr("Skipping run of job %1, since its previous run is still in progress.")
+                .arg(id);
+            continue;
+        }
+        iter->running = true;
+        dueJobs.enqueue(id);
+    }
+    dispatchJobs();
+
+    // Pre-warm after dispatching, so that due jobs have first claim on any free connections.
+    const QVector<quint32> warming = prewarmWheel.advance(now);
+    for (const quint32 id: warming) {
+        prewarmJob(id);
+    }
+}
+
+/*!
+ * Runs as many due jobs as the concurrency limit (`--max-jobs`, or else `--max-connections`) allows.
+ */
+void DaemonCommand::dispatchJobs()
+{
+    const int limit = (maxJobs > 0) ? maxJobs : maxConnections;
+    while ((runningJobs < limit) && (!dueJobs.isEmpty())) {
+        const quint32 id = dueJobs.dequeue();
+        if (scheduledJobs.contains(id)) {
+            runJob(id);
+        }
+    }
+}
+
+/*!
+ * Runs the scheduled job with \a id, by handling its request on behalf of the client that scheduled it.
+ */
+void DaemonCommand::runJob(const quint32 id)
+{
+    const ScheduledJob job = scheduledJobs.value(id);
+    ++runningJobs;
+    qCDebug(lc).noquote() << tr("Running job %1 (%2).").arg(id).arg(job.request.value(u"command"_s).toString());
+    const QJsonObject response = handleRequest(job.reply.client, job.request, id);
+    if (!response.isEmpty()) {
+        // Finished already, such as for a device that has not been discovered (yet).
+        const QVector<Reply> replies{ job.reply };
+        send(replies, response);
+        finishJobs(replies);
+    }
+}
+
+/*!
+ * Marks the job runs (if any) that \a replies were for as finished, so that more due jobs can be dispatched.
+ */
+void DaemonCommand::finishJobs(const QVector<Reply> &replies)
+{
+    bool finished = false;
+    for (const Reply &reply: replies) {
+        if (reply.job == 0) {
+            continue;
+        }
+        Q_ASSERT(runningJobs > 0);
+        --runningJobs;
+        finished = true;
+        if (const auto iter = scheduledJobs.find(reply.job); iter != scheduledJobs.end()) {
+            iter->running = false;
+        }
+    }
+    if ((finished) && (!dueJobs.isEmpty())) {
+        // Queued, since callers are typically part way through updating their sessions.
+        QMetaObject::invokeMethod(this, [this]() { dispatchJobs(); }, Qt::QueuedConnection);
+    }
+}
+
+/*!
+ * Schedules the pre-warming of the device for the job with \a id, #prewarmLead milliseconds before its next run, due
+ * at #clock time \a due. Does nothing if pre-warming is disabled, or that is not in the future.
+ */
+void DaemonCommand::schedulePrewarm(const quint32 id, const qint64 due)
+{
+    if ((prewarmLead > 0) && (due - prewarmLead > clock.elapsed())) {
+        prewarmWheel.schedule(id, due - prewarmLead);
+    }
+}
+
+/*!
+ * Pre-warms the connection to the device for the job with \a id, ahead of its next run, unless the device is already
+ * requested (or leased), or has not been discovered (yet).
+ */
+void DaemonCommand::prewarmJob(const quint32 id)
+{
+    const auto job = scheduledJobs.constFind(id);
+    if ((job == scheduledJobs.constEnd()) || (job->running)) {
+        return; // Unscheduled since, or still running, so its device is connected already.
+    }
+    const std::optional<PokitDeviceRegistry::Entry> entry = findDevice(toOptionValue(job->request.value(u"device"_s)));
+    if (!entry) {
+        return; // The run will fail anyway.
+    }
+    if (const auto session = sessions.constFind(PokitDeviceRegistry::key(entry->info));
+        (session != sessions.constEnd()) && (session->ticket != 0)) {
+        return; // Requested already, such as by another client.
+    }
+    if (manager->prewarm(entry->info)) {
+        qCDebug(lc).noquote() << tr(R"(Pre-warming device "%1", for job %2.)").arg(entry->name).arg(id);
+    }
+}
+
+/*!
+ * Returns a random delay, in milliseconds, to add to a run of a job with \a interval, of up to `--jitter`, or else up
+ * to a tenth of \a interval.
+ */
+quint32 DaemonCommand::jitterFor(const quint32 interval) const
+{
+    const quint32 maximum = jitter.value_or(interval / 10);
+    return (maximum == 0) ? 0 : QRandomGenerator::global()->bounded(maximum + 1);
+}
+
+/*!
+ * Invokes \a job once the device of \a entry has been granted, requesting it from #manager if not already.
+ */
+void DaemonCommand::enqueue(const PokitDeviceRegistry::Entry &entry, const std::function<void()> &job)
+{
+    const QString key = PokitDeviceRegistry::key(entry.info);
+    Session &session = sessions[key];
+    if (session.device) {
+        job();
+        return;
+    }
+    session.jobs.append(job);
+    if (session.ticket == 0) {
+        session.ticket = manager->request(entry.info);
+        tickets.insert(session.ticket, key);
+        registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Connecting);
+        qCDebug(lc).noquote() << tr(R"(Requested device "%1", with ticket %2.)").arg(session.name).arg(session.ticket);
+    }
+}
+
+/*!
+ * Invoked when #manager grants \a device to \a ticket, to run the jobs waiting for it.
+ */
+void DaemonCommand::granted(const quint32 ticket, PokitDevice * const device)
+{
+    const QString key = tickets.value(ticket);
+    const auto iter = sessions.find(key);
+    if ((key.isNull()) || (iter == sessions.end())) {
+        manager->release(ticket); // The session has ended already, such as by its clients disconnecting.
+        return;
+    }
+    qCDebug(lc).noquote() << tr(R"(Granted device "%1".)").arg(iter->name);
+    iter->device = device;
+    iter->context = new QObject(this);
+    registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Connected);
+    const QVector<std::function<void()>> jobs = std::exchange(iter->jobs, {});
+    for (const std::function<void()> &job: jobs) {
+        job(); // Note, jobs may end the session, so iter must not be used from here on.
+    }
+}
+
+/*!
+ * Invoked when the device for \a ticket could not be connected to, or has disconnected, to fail all of its requests.
+ */
+void DaemonCommand::failed(const quint32 ticket)
+{
+    const QString key = tickets.take(ticket);
+    const auto iter = sessions.find(key);
+    if ((key.isNull()) || (iter == sessions.end())) {
+        return;
+    }
+    iter->ticket = 0; // No longer valid, so nothing to release.
+    endSession(key, tr(R"(Lost connection to device "%1")").arg(iter->name));
+}
+
+/*!
+ * Invokes \a job once \a service (of the device leased for \a key) has discovered its details, which may be
+ * immediately, such as for devices kept warm by #manager.
+ */
+void DaemonCommand::whenReady(const QString &key, AbstractPokitService * const service,
+                              const std::function<void()> &job)
+{
+    const QLowEnergyService * const lowEnergyService = service->service();
+    if ((lowEnergyService) && (lowEnergyService->state() == QLowEnergyService::
+        #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+        ServiceDiscovered
+        #else
+        RemoteServiceDiscovered
+        #endif
+    )) {
+        job();
+        return;
+    }
+    const auto connection = std::make_shared<QMetaObject::Connection>();
+    *connection = connect(service, &AbstractPokitService::serviceDetailsDiscovered, sessions.value(key).context,
+        [connection, job]() {
+            QObject::disconnect(*connection); // Just the once.
+            job();
+        });
+}
+
+/*!
+ * Invoked when a service of the device leased for \a key reports \a error, to fail all of the session's requests.
+ */
+void DaemonCommand::serviceError(const QString &key, const QLowEnergyService::ServiceError error)
+{
+    const QString name = sessions.value(key).name;
+    qCWarning(lc).noquote() << tr(R"(Bluetooth service error for device "%1":)").arg(name) << error;
+    endSession(key, tr(R"(Bluetooth service error for device "%1")").arg(name));
+}
+
+/*!
+ * Ends the session for \a key, releasing its device, if nothing remains outstanding for it.
+ */
+void DaemonCommand::maybeRelease(const QString &key)
+{
+    const auto iter = sessions.constFind(key);
+    if ((iter != sessions.constEnd()) && (iter->statusReplies.isEmpty()) && (iter->statusWatchers.isEmpty()) &&
+        (iter->meterSubscribers.isEmpty()) && (iter->dsoReplies.isEmpty()) && (iter->loggerReplies.isEmpty()) &&
+        (iter->calibrationReplies.isEmpty())) {
+        endSession(key);
+    }
+}
+
+/*!
+ * Ends the session for \a key, releasing its device (for #manager to keep warm, for a while), after first failing
+ * any outstanding requests with \a error, if not null.
+ */
+void DaemonCommand::endSession(const QString &key, const QString &error)
+{
+    const auto iter = sessions.find(key);
+    if (iter == sessions.end()) {
+        return;
+    }
+    const Session session = *iter;
+    sessions.erase(iter);
+    delete session.context; // Disconnects from all of the device's services, and deletes the DSO capture, if any.
+    QVector<Reply> watchers, meterSubscribers;
+    for (const StatusWatcher &watcher: session.statusWatchers) {
+        watchers.append(watcher.reply);
+        delete watcher.monitor;
+    }
+    for (const MeterSubscriber &subscriber: session.meterSubscribers) {
+        meterSubscribers.append(subscriber.reply);
+    }
+    if (!error.isNull()) {
+        QJsonObject response = errorResponse(QJsonValue(), error);
+        response.insert(u"device"_s, session.name);
+        for (const QVector<Reply> &replies: { session.statusReplies, watchers, meterSubscribers,
+                                              session.dsoReplies, session.loggerReplies,
+                                              session.calibrationReplies }) {
+            send(replies, response);
+        }
+    }
+    for (const QVector<Reply> &replies: { session.statusReplies, session.loggerReplies,
+                                          session.calibrationReplies }) {
+        finishJobs(replies); // Only status, logger, and calibration requests are ever scheduled.
+    }
+    if (session.ticket != 0) {
+        tickets.remove(session.ticket);
+        manager->release(session.ticket);
+        qCDebug(lc).noquote() << tr(R"(Released device "%1".)").arg(session.name);
+    }
+    registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Disconnected);
+}
+
+/*!
+ * Reads the status of the device leased for \a key.
+ */
+void DaemonCommand::readStatus(const QString &key)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (!iter->device)) {
+        return;
+    }
+    StatusService * const service = iter->device->status();
+    Q_ASSERT(service);
+    if (!iter->statusConnected) {
+        iter->statusConnected = true;
+        connect(service, &StatusService::deviceStatusRead, iter->context,
+            [this, key](const StatusService::Status &status) { statusRead(key, status); });
+        connect(service, &AbstractPokitService::serviceErrorOccurred, iter->context,
+            [this, key](const QLowEnergyService::ServiceError error) { serviceError(key, error); });
+    }
+    whenReady(key, service, [service]() { service->readStatusCharacteristic(); });
+}
+
+/*!
+ * Passes \a status to all status watchers of the device leased for \a key, and responds to all of its outstanding
+ * status requests.
+ */
+void DaemonCommand::statusRead(const QString &key, const StatusService::Status &status)
+{
+    const auto iter = sessions.find(key);
+    if (iter == sessions.end()) {
+        return;
+    }
+    for (const StatusWatcher &watcher: std::as_const(iter->statusWatchers)) {
+        watcher.monitor->addStatus(status); // Reports (coalesced) changes, and alerts, to the watcher's client.
+    }
+    if (iter->statusReplies.isEmpty()) {
+        return; // Status notifications, for watchers only.
+    }
+    const StatusService::DeviceCharacteristics chrs = iter->device->status()->deviceCharacteristics();
+    QJsonObject object = toJson(status);
+    object.insert(u"device"_s, iter->name);
+    object.insert(u"firmwareVersion"_s, chrs.firmwareVersion.toString());
+    object.insert(u"macAddress"_s, chrs.macAddress.toString());
+    const QVector<Reply> replies = std::exchange(iter->statusReplies, {});
+    send(replies, okResponse(QJsonValue(), object));
+    finishJobs(replies);
+    maybeRelease(key);
+}
+
+/*!
+ * Enables status notifications from the device leased for \a key, for its status watchers, after first reading its
+ * current status, for any watchers yet to receive it.
+ */
+void DaemonCommand::watchStatus(const QString &key)
+{
+    const auto iter = sessions.constFind(key);
+    if ((iter == sessions.constEnd()) || (!iter->device)) {
+        return;
+    }
+    if (iter->statusWatchers.isEmpty()) {
+        maybeRelease(key); // All watchers left before the device was granted.
+        return;
+    }
+    StatusService * const service = iter->device->status();
+    Q_ASSERT(service);
+    readStatus(key);
+    whenReady(key, service, [service]() { service->enableStatusNotifications(); });
+}
+
+/*!
+ * Disables status notifications from the device leased for \a key, now that it has no status watchers.
+ */
+void DaemonCommand::unwatchStatus(const QString &key)
+{
+    const auto iter = sessions.constFind(key);
+    if ((iter != sessions.constEnd()) && (iter->device) && (iter->statusConnected)) {
+        iter->device->status()->disableStatusNotifications();
+    }
+    maybeRelease(key);
+}
+
+/*!
+ * Configures, and begins streaming readings from, the multimeter of the device leased for \a key.
+ */
+void DaemonCommand::startMeter(const QString &key)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (!iter->device)) {
+        return;
+    }
+    if (iter->meterSubscribers.isEmpty()) {
+        maybeRelease(key); // All subscribers left before the device was granted.
+        return;
+    }
+    MultimeterService * const service = iter->device->multimeter();
+    Q_ASSERT(service);
+    if (!iter->meterConnected) {
+        iter->meterConnected = true;
+        connect(service, &MultimeterService::readingRead, iter->context,
+            [this, key](const MultimeterService::Reading &reading) { meterReading(key, reading); });
+        connect(service, &MultimeterService::settingsWritten, iter->context,
+            [service]() { service->enableReadingNotifications(); });
+        connect(service, &AbstractPokitService::serviceErrorOccurred, iter->context,
+            [this, key](const QLowEnergyService::ServiceError error) { serviceError(key, error); });
+    }
+    whenReady(key, service, [this, key, service]() {
+        const auto iter = sessions.constFind(key);
+        if (iter == sessions.constEnd()) {
+            return;
+        }
+        MultimeterService::Settings settings = iter->meterSettings;
+        settings.range = (iter->meterRangeFunc == nullptr) ? 0
+            : iter->meterRangeFunc(service->pokitProduct().value_or(iter->product), iter->meterRange);
+        qCInfo(lc).noquote() << tr(R"(Measuring %1 on device "%2", every %L3ms.)").arg(
+            MultimeterService::toString(settings.mode), iter->name).arg(settings.updateInterval);
+        service->setSettings(settings);
+    });
+}
+
+/*!
+ * Sends \a reading, from the device leased for \a key, to all of that device's meter subscribers. Subscribers with
+ * their own rate instead accumulate \a reading, and are sent a single, aggregated, reading once their next event is
+ * due.
+ */
+void DaemonCommand::meterReading(const QString &key, const MultimeterService::Reading &reading)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (iter->meterSubscribers.isEmpty())) {
+        return; // Unsubscribed, and waiting for notifications to be disabled.
+    }
+    const QString unit = MeterCommand::toUnit(reading.mode);
+    const QString range = iter->device->multimeter()->toString(reading.range, reading.mode);
+    QJsonObject event{
+        { u"event"_s,     u"reading"_s },
+        { u"device"_s,    iter->name },
+        { u"status"_s,    MeterCommand::toStatus(reading.status, reading.mode) },
+        { u"value"_s,     qIsInf(reading.value) ? QJsonValue(tr("Infinity")) : QJsonValue(reading.value) },
+        { u"mode"_s,      MultimeterService::toString(reading.mode) },
+    };
+    if (!unit.isEmpty()) {
+        event.insert(u"unit"_s, unit);
+    }
+    if (!range.isNull()) {
+        event.insert(u"range"_s, range);
+    }
+    stamp(event);
+
+    const qint64 now = clock.elapsed();
+    for (MeterSubscriber &subscriber: iter->meterSubscribers) {
+        if (subscriber.every == 0) {
+            send(QVector<Reply>{ subscriber.reply }, event);
+            continue;
+        }
+        subscriber.minimum = (subscriber.count == 0) ? reading.value : std::min(subscriber.minimum, reading.value);
+        subscriber.maximum = (subscriber.count == 0) ? reading.value : std::max(subscriber.maximum, reading.value);
+        subscriber.sum += reading.value;
+        ++subscriber.count;
+        if (now < subscriber.due) {
+            continue;
+        }
+        const auto toValue = [](const double value) {
+            return qIsInf(value) ? QJsonValue(tr("Infinity")) : QJsonValue(value);
+        };
+        QJsonObject aggregate = event;
+        aggregate.insert(u"value"_s,
+            toValue((subscriber.last) ? (double)reading.value : subscriber.sum / subscriber.count));
+        aggregate.insert(u"min"_s, toValue(subscriber.minimum));
+        aggregate.insert(u"max"_s, toValue(subscriber.maximum));
+        aggregate.insert(u"count"_s, (qint64)subscriber.count);
+        aggregate.insert(u"every"_s, (qint64)subscriber.every);
+        send(QVector<Reply>{ subscriber.reply }, aggregate);
+        subscriber.count = 0;
+        subscriber.sum = 0.0;
+        subscriber.due += subscriber.every;
+        if (subscriber.due <= now) {
+            subscriber.due = now + subscriber.every; // Fell behind (such as while the device was busy), so skip ahead.
+        }
+    }
+}
+
+/*!
+ * Stops streaming readings from the multimeter of the device leased for \a key, now that it has no subscribers.
+ */
+void DaemonCommand::stopMeter(const QString &key)
+{
+    const auto iter = sessions.constFind(key);
+    if ((iter != sessions.constEnd()) && (iter->device) && (iter->meterConnected)) {
+        iter->device->multimeter()->disableReadingNotifications();
+    }
+    maybeRelease(key);
+}
+
+/*!
+ * Begins a single, free-running, DSO capture on the device leased for \a key.
+ */
+void DaemonCommand::captureDso(const QString &key)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (!iter->device)) {
+        return;
+    }
+    DsoService * const service = iter->device->dso();
+    Q_ASSERT(service);
+    if (!iter->capture) {
+        iter->capture = new DsoCapture(service, iter->context);
+        connect(iter->capture, &DsoCapture::captureComplete, iter->context,
+            [this, key](const DsoService::Metadata &metadata, const DsoService::Samples &samples) {
+                dsoCaptured(key, metadata, samples);
+            });
+        connect(service, &DsoService::settingsWritten, iter->context, [service]() {
+            service->enableMetadataNotifications();
+            service->enableReadingNotifications();
+        });
+        connect(service, &AbstractPokitService::serviceErrorOccurred, iter->context,
+            [this, key](const QLowEnergyService::ServiceError error) { serviceError(key, error); });
+    }
+    whenReady(key, service, [this, key, service]() {
+        const auto iter = sessions.constFind(key);
+        if (iter == sessions.constEnd()) {
+            return;
+        }
+        DsoService::Settings settings = iter->dsoSettings;
+        settings.range = iter->dsoRangeFunc(service->pokitProduct().value_or(iter->product), iter->dsoRange);
+        qCInfo(lc).noquote() << tr(R"(Capturing %1 on device "%2", over %L3us.)").arg(
+            DsoService::toString(settings.mode), iter->name).arg(settings.samplingWindow);
+        service->setSettings(settings);
+    });
+}
+
+/*!
+ * Responds to all outstanding DSO requests for the device leased for \a key, with the captured \a metadata, and
+ * (scaled) \a samples.
+ */
+void DaemonCommand::dsoCaptured(const QString &key, const DsoService::Metadata &metadata,
+                                const DsoService::Samples &samples)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (iter->dsoReplies.isEmpty())) {
+        return;
+    }
+    const QString range = iter->device->dso()->toString(metadata.range, metadata.mode);
+    QJsonObject object{
+        { u"device"_s,         iter->name },
+        { u"mode"_s,           DsoService::toString(metadata.mode) },
+        { u"samplingWindow"_s, (qint64)metadata.samplingWindow },
+        { u"samplingRate"_s,   (qint64)metadata.samplingRate },
+    };
+    if (!range.isNull()) {
+        object.insert(u"range"_s, range);
+    }
+    iter->device->dso()->disableReadingNotifications();
+    iter->device->dso()->disableMetadataNotifications();
+    sendSamples(std::exchange(iter->dsoReplies, {}), okResponse(QJsonValue(), object), samples, metadata.scale);
+    maybeRelease(key);
+}
+
+/*!
+ * Begins fetching all data logger samples from the device leased for \a key.
+ */
+void DaemonCommand::fetchLogger(const QString &key)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (!iter->device)) {
+        return;
+    }
+    DataLoggerService * const service = iter->device->dataLogger();
+    Q_ASSERT(service);
+    if (!iter->loggerConnected) {
+        iter->loggerConnected = true;
+        connect(service, &DataLoggerService::metadataRead, iter->context,
+            [this, key](const DataLoggerService::Metadata &metadata) { loggerMetadataRead(key, metadata); });
+        connect(service, &DataLoggerService::samplesRead, iter->context,
+            [this, key](const DataLoggerService::Samples &samples) { loggerSamplesRead(key, samples); });
+        connect(service, &AbstractPokitService::serviceErrorOccurred, iter->context,
+            [this, key](const QLowEnergyService::ServiceError error) { serviceError(key, error); });
+    }
+    iter->loggerSamplesToGo = -1;
+    iter->loggerSamples.clear();
+    whenReady(key, service, [this, key, service]() {
+        qCInfo(lc).noquote() << tr(R"(Fetching logger samples from device "%1"...)").arg(sessions.value(key).name);
+        service->enableMetadataNotifications();
+        service->enableReadingNotifications();
+        service->fetchSamples();
+    });
+}
+
+/*!
+ * Invoked when logger \a metadata has been read from the device leased for \a key, ahead of its samples.
+ */
+void DaemonCommand::loggerMetadataRead(const QString &key, const DataLoggerService::Metadata &metadata)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (iter->loggerReplies.isEmpty()) || (iter->loggerSamplesToGo >= 0)) {
+        return; // Not fetching, or metadata for samples already being fetched.
+    }
+    iter->loggerMetadata = metadata;
+    iter->loggerSamplesToGo = metadata.numberOfSamples;
+    iter->loggerSamples.reserve(metadata.numberOfSamples);
+    if (iter->loggerSamplesToGo == 0) {
+        loggerSamplesRead(key, DataLoggerService::Samples());
+    }
+}
+
+/*!
+ * Invoked when logger \a samples have been read from the device leased for \a key, to respond to all outstanding
+ * logger-fetch requests once all samples have been read.
+ */
+void DaemonCommand::loggerSamplesRead(const QString &key, const DataLoggerService::Samples &samples)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (iter->loggerReplies.isEmpty()) || (iter->loggerSamplesToGo < 0)) {
+        return; // Not fetching, or samples before metadata.
+    }
+    const qint32 count = std::min(iter->loggerSamplesToGo, (qint32)samples.size());
+    iter->loggerSamples.append(samples.mid(0, count));
+    iter->loggerSamplesToGo -= count;
+    if (iter->loggerSamplesToGo > 0) {
+        return;
+    }
+
+    const DataLoggerService::Metadata &metadata = iter->loggerMetadata;
+    DataLoggerService * const service = iter->device->dataLogger();
+    const QString range = service->toString(metadata.range, metadata.mode);
+    QJsonObject object{
+        { u"device"_s,    iter->name },
+        { u"mode"_s,      DataLoggerService::toString(metadata.mode) },
+        { u"interval"_s,  (qint64)metadata.updateInterval },
+        { u"timestamp"_s, (qint64)metadata.timestamp * 1000 },
+    };
+    if (!range.isNull()) {
+        object.insert(u"range"_s, range);
+    }
+    service->disableReadingNotifications();
+    service->disableMetadataNotifications();
+    const DataLoggerService::Samples samples = std::exchange(iter->loggerSamples, {});
+    iter->loggerSamplesToGo = -1;
+    const QVector<Reply> replies = std::exchange(iter->loggerReplies, {});
+    sendSamples(replies, okResponse(QJsonValue(), object), samples, metadata.scale);
+    finishJobs(replies);
+    maybeRelease(key);
+}
+
+/*!
+ * Calibrates the temperature of the device leased for \a key.
+ */
+void DaemonCommand::calibrate(const QString &key)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (!iter->device)) {
+        return;
+    }
+    CalibrationService * const service = iter->device->calibration();
+    Q_ASSERT(service);
+    if (!iter->calibrationConnected) {
+        iter->calibrationConnected = true;
+        connect(service, &CalibrationService::temperatureCalibrated, iter->context, [this, key]() { calibrated(key); });
+        connect(service, &AbstractPokitService::serviceErrorOccurred, iter->context,
+            [this, key](const QLowEnergyService::ServiceError error) { serviceError(key, error); });
+    }
+    whenReady(key, service, [this, key, service]() {
+        const auto iter = sessions.find(key);
+        if (iter == sessions.end()) {
+            return;
+        }
+        qCInfo(lc).noquote() << tr(R"(Calibrating device "%1" at %L2 degrees celsius.)").arg(iter->name)
+            .arg(iter->calibrationTemperature);
+        if (!service->calibrateTemperature(iter->calibrationTemperature)) {
+            QJsonObject response = errorResponse(QJsonValue(), tr(R"(Failed to calibrate device "%1")")
+                .arg(iter->name));
+            response.insert(u"device"_s, iter->name);
+            const QVector<Reply> replies = std::exchange(iter->calibrationReplies, {});
+            send(replies, response);
+            finishJobs(replies);
+            maybeRelease(key);
+        }
+    });
+}
+
+/*!
+ * Responds to all outstanding calibrate requests for the device leased for \a key, now that it has been calibrated.
+ */
+void DaemonCommand::calibrated(const QString &key)
+{
+    const auto iter = sessions.find(key);
+    if ((iter == sessions.end()) || (iter->calibrationReplies.isEmpty())) {
+        return;
+    }
+    const QVector<Reply> replies = std::exchange(iter->calibrationReplies, {});
+    send(replies, okResponse(QJsonValue(), QJsonObject{
+        { u"device"_s,      iter->name },
+        { u"temperature"_s, iter->calibrationTemperature },
+    }));
+    finishJobs(replies);
+    maybeRelease(key);
+}
+
+/*!
+ * Parses the multimeter `mode`, `range` and `interval` of \a request into \a settings, \a rangeFunc and \a rangeValue,
+ * as per the `meter` command's options of the same names. Returns a list of errors, if any.
+ */
+QStringList DaemonCommand::parseMeterSettings(const QJsonObject &request, MultimeterService::Settings &settings,
+                                              MeterCommand::MinRangeFunc &rangeFunc, quint32 &rangeValue)
+{
+    QStringList errors;
+    const QString mode = toOptionValue(request.value(u"mode"_s));
+    settings.mode = MeterCommand::parseMode(mode, rangeFunc);
+    if (settings.mode == MultimeterService::Mode::Idle) {
+        errors.append(tr("Unknown meter mode: %1").arg(mode));
+        return errors;
+    }
+
+    if (const QString value = toOptionValue(request.value(u"interval"_s)); !value.isEmpty()) {
+        const quint32 interval = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (interval == 0) {
+            errors.append(tr("Invalid interval value: %1").arg(value));
+        } else {
+            settings.updateInterval = interval;
+        }
+    }
+
+    rangeValue = 0; // Default to auto.
+    if (const QString value = toOptionValue(request.value(u"range"_s));
+        (!value.isEmpty()) && (value.trimmed().compare(u"auto"_s, Qt::CaseInsensitive) != 0)) {
+        rangeValue = MeterCommand::parseRange(value, settings.mode);
+        if ((rangeFunc != nullptr) && (rangeValue == 0)) {
+            errors.append(tr("Invalid range value: %1").arg(value));
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Parses the DSO `mode`, `range`, `interval` and `samples` of \a request into \a settings, \a rangeFunc and
+ * \a rangeValue, as per the `dso` command's options of the same names. Returns a list of errors, if any.
+ */
+QStringList DaemonCommand::parseDsoSettings(const QJsonObject &request, DsoService::Settings &settings,
+                                            MeterCommand::MinRangeFunc &rangeFunc, quint32 &rangeValue)
+{
+    // The DSO modes are a subset of the multimeter's, so parse them the same way.
+    QStringList errors;
+    const QString mode = toOptionValue(request.value(u"mode"_s));
+    const MultimeterService::Mode meterMode = MeterCommand::parseMode(mode, rangeFunc);
+    switch (meterMode) {
+    case MultimeterService::Mode::DcVoltage: settings.mode = DsoService::Mode::DcVoltage; break;
+    case MultimeterService::Mode::AcVoltage: settings.mode = DsoService::Mode::AcVoltage; break;
+    case MultimeterService::Mode::DcCurrent: settings.mode = DsoService::Mode::DcCurrent; break;
+    case MultimeterService::Mode::AcCurrent: settings.mode = DsoService::Mode::AcCurrent; break;
+    default:
+        errors.append(tr("Unknown DSO mode: %1").arg(mode));
+        return errors;
+    }
+
+    const QString range = toOptionValue(request.value(u"range"_s));
+    rangeValue = MeterCommand::parseRange(range, meterMode);
+    if (rangeValue == 0) {
+        errors.append(tr("Invalid range value: %1").arg(range));
+    }
+
+    if (const QString value = toOptionValue(request.value(u"interval"_s)); !value.isEmpty()) {
+        const quint32 interval = parseNumber<std::micro>(value, u"s"_s, 500'000);
+        if (interval == 0) {
+            errors.append(tr("Invalid interval value: %1").arg(value));
+        } else {
+            settings.samplingWindow = interval;
+        }
+    }
+
+    if (const QString value = toOptionValue(request.value(u"samples"_s)); !value.isEmpty()) {
+        const quint32 samples = parseNumber<std::ratio<1>>(value, u"S"_s);
+        if ((samples == 0) || (samples > std::numeric_limits<quint16>::max())) {
+            errors.append(tr("Invalid samples value: %1").arg(value));
+        } else {
+            settings.numberOfSamples = (quint16)samples;
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Parses the status watch `coalesce` and `lowBattery` of \a request into \a coalesceInterval (in milliseconds) and
+ * \a lowBatteryThreshold (in millivolts), as per the `status` command's `interval` and `low-battery` options. Returns a
+ * list of errors, if any.
+ */
+QStringList DaemonCommand::parseStatusSettings(const QJsonObject &request, quint32 &coalesceInterval,
+                                               quint32 &lowBatteryThreshold)
+{
+    QStringList errors;
+    if (const QString value = toOptionValue(request.value(u"coalesce"_s)); !value.isEmpty()) {
+        const quint32 interval = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (interval == 0) {
+            errors.append(tr("Invalid coalesce value: %1").arg(value));
+        } else {
+            coalesceInterval = interval;
+        }
+    }
+
+    if (const QString value = toOptionValue(request.value(u"lowBattery"_s)); !value.isEmpty()) {
+        const quint32 threshold = parseNumber<std::milli>(value, u"V"_s, 50); // mV.
+        if (threshold == 0) {
+            errors.append(tr("Invalid lowBattery value: %1").arg(value));
+        } else {
+            lowBatteryThreshold = threshold;
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Parses the (required) `temperature` of calibrate \a request into \a temperature, in degrees celsius, as per the
+ * `calibrate` command's option of the same name. Returns a list of errors, if any.
+ */
+QStringList DaemonCommand::parseCalibrationSettings(const QJsonObject &request, float &temperature)
+{
+    const QString value = toOptionValue(request.value(u"temperature"_s));
+    if (value.isEmpty()) {
+        return QStringList{ tr("Missing temperature") };
+    }
+    bool ok;
+    const float number = value.toFloat(&ok);
+    if ((!ok) || (!qIsFinite(number))) {
+        return QStringList{ tr("Unrecognised temperature format: %1").arg(value) };
+    }
+    temperature = number;
+    return QStringList();
+}
+
+/*!
+ * Parses the `encoding` field (if any) of \a request into \a encoding, returning any errors.
+ */
+QStringList DaemonCommand::parseEncoding(const QJsonObject &request, Encoding &encoding)
+{
+    const QString value = toOptionValue(request.value(u"encoding"_s));
+    if ((value.isEmpty()) || (value == u"json"_s)) {
+        encoding = Encoding::Json;
+    } else if (value == u"delta-varint"_s) {
+        encoding = Encoding::DeltaVarint;
+    } else if (value == u"delta-varint-zlib"_s) {
+        encoding = Encoding::DeltaVarintZlib;
+    } else {
+        return QStringList{ tr("Unsupported encoding: %1 (supported: json, delta-varint, delta-varint-zlib)")
+            .arg(value) };
+    }
+    return QStringList();
+}
+
+/*!
+ * Parses the (optional) `points` field of \a request, being the maximum number of samples the client wants per sample
+ * array, into \a points (or 0, if not given), returning any errors.
+ */
+QStringList DaemonCommand::parsePoints(const QJsonObject &request, quint32 &points)
+{
+    points = 0;
+    if (const QString value = toOptionValue(request.value(u"points"_s)); !value.isEmpty()) {
+        bool ok;
+        points = value.toUInt(&ok);
+        if ((!ok) || (points < 2)) { // Each decimated bucket needs room for both its minimum and maximum.
+            points = 0;
+            return QStringList{ tr("Invalid points value: %1").arg(value) };
+        }
+    }
+    return QStringList();
+}
+
+/*!
+ * Parses the (optional) `every` and `aggregate` fields of the meter \a request into \a every (being the subscriber's
+ * minimum interval between events, in milliseconds, or 0 for every reading), and \a last (whether each event carries
+ * the interval's last reading, rather than its mean), returning any errors.
+ */
+QStringList DaemonCommand::parseRate(const QJsonObject &request, quint32 &every, bool &last)
+{
+    QStringList errors;
+    every = 0;
+    if (const QString value = toOptionValue(request.value(u"every"_s)); !value.isEmpty()) {
+        every = (value == u"0"_s) ? 0 : parseNumber<std::milli>(value, u"s"_s, 500);
+        if ((every == 0) && (value != u"0"_s)) {
+            errors.append(tr("Invalid every value: %1").arg(value));
+        }
+    }
+    const QString aggregate = toOptionValue(request.value(u"aggregate"_s));
+    last = (aggregate == u"last"_s);
+    if ((!aggregate.isEmpty()) && (!last) && (aggregate != u"mean"_s)) {
+        errors.append(tr("Unknown aggregate value: %1").arg(aggregate));
+    }
+    return errors;
+}
+
+/*!
+ * Returns the response fields for raw \a samples, of \a scale, in \a encoding: either the scaled `values`, or the
+ * encoded `samples`, and the `count`, `scale` and `encoding` needed to decode them.
+ */
+QJsonObject DaemonCommand::encodeSamples(const QVector<qint16> &samples, const float scale, const Encoding encoding)
+{
+    switch (encoding) {
+    case Encoding::Json:
+        break;
+    case Encoding::DeltaVarint:
+    case Encoding::DeltaVarintZlib: {
+        QByteArray data = SampleCodec::encode(samples); // Relative to 0, so decodable without any earlier responses.
+        if (encoding == Encoding::DeltaVarintZlib) {
+            data = qCompress(data);
+        }
+        return QJsonObject{
+            { u"encoding"_s, (encoding == Encoding::DeltaVarint) ? u"delta-varint"_s : u"delta-varint-zlib"_s },
+            { u"count"_s,    (qint64)samples.size() },
+            { u"scale"_s,    scale },
+            { u"samples"_s,  QString::fromLatin1(data.toBase64()) },
+        };
+    }
+    }
+
+    QJsonArray values;
+    for (const qint16 sample: samples) {
+        values.append(sample * scale);
+    }
+    return QJsonObject{ { u"values"_s, values } };
+}
+
+/*!
+ * Returns raw \a samples, decimated to at most \a points samples (or all \a samples, if \a points is 0, or no less
+ * than the number of samples). Samples are split into buckets of (near) equal size, and each bucket is reduced to its
+ * minimum and maximum samples, in the order they occurred, so that any peaks and glitches survive decimation (unlike
+ * simply keeping every nth sample).
+ */
+QVector<qint16> DaemonCommand::decimateSamples(const QVector<qint16> &samples, const quint32 points)
+{
+    if ((points == 0) || (samples.size() <= (qsizetype)points)) {
+        return samples;
+    }
+    const qsizetype buckets = std::max<qsizetype>(points / 2, 1);
+    QVector<qint16> decimated;
+    decimated.reserve(buckets * 2);
+    for (qsizetype bucket = 0; bucket < buckets; ++bucket) {
+        const auto begin = samples.cbegin() + (bucket * samples.size() / buckets);
+        const auto end = samples.cbegin() + ((bucket + 1) * samples.size() / buckets);
+        const auto [minimum, maximum] = std::minmax_element(begin, end);
+        decimated.append((minimum < maximum) ? *minimum : *maximum);
+        if (*minimum != *maximum) {
+            decimated.append((minimum < maximum) ? *maximum : *minimum);
+        }
+    }
+    return decimated;
+}
+
+/*!
+ * Returns \a status as a JSON object, as included in `status` responses, and status watch events.
+ */
+QJsonObject DaemonCommand::toJson(const StatusService::Status &status)
+{
+    QJsonObject object{
+        { u"deviceStatus"_s, StatusService::toString(status.deviceStatus) },
+        { u"battery"_s, QJsonObject{
+            { u"level"_s,  status.batteryVoltage },
+            { u"status"_s, StatusService::toString(status.batteryStatus) },
+        }},
+    };
+    if (status.switchPosition) {
+        object.insert(u"switchPosition"_s, StatusService::toString(*status.switchPosition));
+    }
+    if (status.chargingStatus) {
+        object.insert(u"chargingStatus"_s, StatusService::toString(*status.chargingStatus));
+    }
+    return object;
+}
+
+/*!
+ * Returns JSON \a value as a string, for parsing as if a command line option. That is, strings are returned as is,
+ * and numbers are formatted as strings. Anything else returns a null string.
+ */
+QString DaemonCommand::toOptionValue(const QJsonValue &value)
+{
+    if (value.isString()) {
+        return value.toString();
+    } else if (value.isDouble()) {
+        return QString::number(value.toDouble(), 'g', 17);
+    }
+    return QString();
+}
+
+/*!
+ * Returns \a object as a successful response to the request with \a id (if not null, or undefined).
+ */
+QJsonObject DaemonCommand::okResponse(const QJsonValue &id, QJsonObject object)
+{
+    if ((!id.isNull()) && (!id.isUndefined())) {
+        object.insert(u"id"_s, id);
+    }
+    object.insert(u"ok"_s, true);
+    return object;
+}
+
+/*!
+ * Returns an error response, with \a message, to the request with \a id (if not null, or undefined).
+ */
+QJsonObject DaemonCommand::errorResponse(const QJsonValue &id, const QString &message)
+{
+    QJsonObject object{
+        { u"ok"_s,    false },
+        { u"error"_s, message },
+    };
+    if ((!id.isNull()) && (!id.isUndefined())) {
+        object.insert(u"id"_s, id);
+    }
+    return object;
+}
+
+/*!
+ * Sends \a message to \a client, as a single line of compact JSON.
+ */
+void DaemonCommand::send(QIODevice * const client, const QJsonObject &message)
+{
+    client->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+}
+
+/*!
+ * Sends \a message, with raw \a samples (of \a scale), to each of the (still connected) clients of \a replies, with
+ * the samples decimated to each reply's requested points (if any), in each reply's negotiated encoding. Samples are
+ * decimated, and encoded, (at most) once per combination of points and encoding, however many replies share it.
+ */
+void DaemonCommand::sendSamples(const QVector<Reply> &replies, const QJsonObject &message,
+                                const QVector<qint16> &samples, const float scale)
+{
+    std::map<std::pair<Encoding, quint32>, QJsonObject> messages; // By encoding, and points.
+    std::map<quint32, QVector<qint16>> decimated; // By points.
+    for (const Reply &reply: replies) {
+        if (!reply.client) {
+            continue;
+        }
+        const auto [encoded, isNew] = messages.try_emplace({ reply.encoding, reply.points }, message);
+        if (isNew) {
+            const auto [points, isNewPoints] = decimated.try_emplace(reply.points);
+            if (isNewPoints) {
+                points->second = decimateSamples(samples, reply.points);
+            }
+            const QJsonObject fields = encodeSamples(points->second, scale, reply.encoding);
+            for (auto field = fields.constBegin(); field != fields.constEnd(); ++field) {
+                encoded->second.insert(field.key(), field.value());
+            }
+            if (points->second.size() < samples.size()) {
+                encoded->second.insert(u"decimatedFrom"_s, (qint64)samples.size());
+            }
+        }
+        send(QVector<Reply>{ reply }, encoded->second);
+    }
+}
+
+/*!
+ * Sends \a message to each of the (still connected) clients of \a replies, with each reply's request ID, if any.
+ */
+void DaemonCommand::send(const QVector<Reply> &replies, const QJsonObject &message)
+{
+    for (const Reply &reply: replies) {
+        if (reply.client) {
+            QJsonObject object = message;
+            if ((!reply.id.isNull()) && (!reply.id.isUndefined())) {
+                object.insert(u"id"_s, reply.id);
+            }
+            if (reply.job != 0) {
+                object.insert(u"job"_s, (qint64)reply.job);
+            }
+            send(reply.client, object);
+        }
+    }
+}
@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+#include "metercommand.h"
+#include "timerwheel.h"
+
+#include <qtpokit/dataloggerservice.h>
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdeviceregistry.h>
+#include <qtpokit/pokitproducts.h>
+#include <qtpokit/statusservice.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QLowEnergyService>
+#include <QPointer>
+#include <QQueue>
+#include <QSet>
+#include <QSysInfo>
+#include <QVector>
+
+#include <functional>
+#include <optional>
+
+QTPOKIT_FORWARD_DECLARE_CLASS(AbstractPokitService)
+QTPOKIT_FORWARD_DECLARE_CLASS(DsoCapture)
+QTPOKIT_FORWARD_DECLARE_CLASS(PokitConnectionManager)
+QTPOKIT_FORWARD_DECLARE_CLASS(PokitDevice)
+QTPOKIT_FORWARD_DECLARE_CLASS(ReferenceClock)
+QTPOKIT_FORWARD_DECLARE_CLASS(StatusMonitor)
+QTPOKIT_USE_NAMESPACE
+
+class QLocalServer;
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+class DaemonCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit DaemonCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// Encodings of the sample arrays in `dso` and `logger-fetch` responses, as negotiated by each request.
+    enum class Encoding : quint8 {
+        Json,            ///< JSON array of scaled values (the default).
+        DeltaVarint,     ///< Base64 of the raw samples' SampleCodec encoding, and the scale to apply to them.
+        DeltaVarintZlib, ///< As per DeltaVarint, but also zlib-compressed, as per qCompress().
+    };
+
+    /// A client request that is yet to be responded to.
+    struct Reply {
+        QPointer<QIODevice> client;    ///< Client to respond to, or \c nullptr if the client has since disconnected.
+        QJsonValue id;                 ///< Client's request ID, to echo in the response, if any.
+        quint32 job { 0 };             ///< Scheduled job this reply is for, or 0 if for a one-off request.
+        Encoding encoding { Encoding::Json }; ///< Encoding of any sample arrays in the response.
+        quint32 points { 0 };          ///< Maximum samples per sample array (decimating if more), or 0 for all.
+    };
+
+    /// A client subscribed to a device's meter readings, at its own rate.
+    struct MeterSubscriber {
+        Reply reply;                   ///< Client to send reading events to.
+        quint32 every { 0 };           ///< Minimum interval between events, in milliseconds, or 0 for every reading.
+        bool last { false };           ///< Whether events carry the last reading of each interval, not the mean.
+        qint64 due { 0 };              ///< Time the next event is due, per #clock.
+        quint32 count { 0 };           ///< Number of readings aggregated since the last event.
+        double sum { 0.0 };            ///< Sum of those readings' values.
+        float minimum { 0.0f };        ///< Least of those readings' values.
+        float maximum { 0.0f };        ///< Greatest of those readings' values.
+    };
+
+    /// A client subscribed to a device's status changes, and alerts, each with its own thresholds.
+    struct StatusWatcher {
+        Reply reply;                          ///< Client to send status events to.
+        StatusMonitor * monitor { nullptr };  ///< Coalesces the device's statuses, and raises alerts, for #reply.
+    };
+
+    /// A (possibly not yet granted) lease of a single device, shared by all clients' requests for that device.
+    struct Session {
+        QString name;                         ///< Device name, to tag responses and events with.
+        PokitProduct product { PokitProduct::PokitMeter }; ///< Pokit product, for resolving requested ranges.
+        quint32 ticket { 0 };                 ///< Connection manager ticket, or 0 if not (yet) requested.
+        PokitDevice * device { nullptr };     ///< Leased device, or \c nullptr if not (yet) granted.
+        QObject * context { nullptr };        ///< Context for all connections to #device, while leased.
+        QVector<std::function<void()>> jobs;  ///< Jobs waiting for #device to be granted.
+        bool statusConnected { false };       ///< Whether status service signals are connected to #context.
+
+        QVector<Reply> statusReplies;         ///< Requests waiting for the device's status.
+        QVector<StatusWatcher> statusWatchers; ///< Clients watching the device's status changes.
+
+        QVector<MeterSubscriber> meterSubscribers; ///< Clients subscribed to the device's meter readings.
+        MultimeterService::Settings meterSettings { MultimeterService::Mode::Idle, 0, 1000 }; ///< Meter settings.
+        MeterCommand::MinRangeFunc meterRangeFunc { nullptr }; ///< Resolves #meterRange to the product's range.
+        quint32 meterRange { 0 };             ///< Requested meter range, or 0 for auto.
+        bool meterConnected { false };        ///< Whether multimeter service signals are connected to #context.
+
+        QVector<Reply> dsoReplies;            ///< Requests waiting for the device's DSO capture.
+        DsoService::Settings dsoSettings { }; ///< Settings for the DSO capture in progress, if any.
+        MeterCommand::MinRangeFunc dsoRangeFunc { nullptr }; ///< Resolves #dsoRange to the product's range.
+        quint32 dsoRange { 0 };               ///< Requested DSO range.
+        DsoCapture * capture { nullptr };     ///< Assembles the device's DSO captures, once connected to #context.
+
+        QVector<Reply> loggerReplies;         ///< Requests waiting for the device's data logger samples.
+        DataLoggerService::Metadata loggerMetadata { }; ///< Metadata of the logger samples being fetched.
+        DataLoggerService::Samples loggerSamples;      ///< Logger samples fetched so far.
+        qint32 loggerSamplesToGo { -1 };      ///< Number of logger samples still to fetch, or -1 if awaiting metadata.
+        bool loggerConnected { false };       ///< Whether data logger service signals are connected to #context.
+
+        QVector<Reply> calibrationReplies;    ///< Requests waiting for the device's temperature calibration.
+        float calibrationTemperature { 0.0f }; ///< Ambient temperature to calibrate at, in degrees celsius.
+        bool calibrationConnected { false };  ///< Whether calibration service signals are connected to #context.
+    };
+
+    /// A periodic job, such as a logger harvest, or status poll, scheduled by a client.
+    struct ScheduledJob {
+        Reply reply;                          ///< Client to send each run's response to.
+        QJsonObject request;                  ///< Request to handle, on behalf of #reply's client, for each run.
+        quint32 interval { 0 };               ///< Interval between runs, in milliseconds.
+        qint64 nominalTime { 0 };             ///< Time of the job's current run, before jitter, per #clock.
+        bool running { false };               ///< Whether a run is waiting to be dispatched, or is in progress.
+    };
+
+    QString socketName { QStringLiteral("dokitd") }; ///< Name of the local socket to listen on.
+    int maxConnections { 3 };                        ///< Maximum number of concurrent device connections.
+    QLocalServer * server { nullptr };               ///< Local server, for clients to connect to.
+    QHostAddress listenAddress;                      ///< Address to serve WebSocket clients on, if #listenPort.
+    quint16 listenPort { 0 };                        ///< Port to serve WebSocket clients on, or 0 for none.
+    QTcpServer * webSocketServer { nullptr };        ///< TCP server, for WebSocket clients to connect to, if any.
+    QString aggregatorHost;                          ///< Aggregator to join as a gateway, if #aggregatorPort.
+    quint16 aggregatorPort { 0 };                    ///< Aggregator's port, or 0 for none.
+    QString gatewayName { QSysInfo::machineHostName() }; ///< Name to register with the aggregator as.
+    QTcpSocket * aggregator { nullptr };             ///< Connection to the aggregator, if any.
+    QTimer * reportTimer { nullptr };                ///< Reports nearby devices to the aggregator, while connected.
+    QTimer * reconnectTimer { nullptr };             ///< Reconnects to the aggregator, after losing the connection.
+    ReferenceClock * referenceClock { nullptr };     ///< Disciplines event timestamps, per `--reference-clock`.
+    QSet<QString> assignedDevices;                   ///< Registry keys of the devices assigned by the aggregator.
+    PokitDeviceRegistry * registry { nullptr };      ///< Nearby devices, kept up to date in the background.
+    PokitConnectionManager * manager { nullptr };    ///< Leases device connections, and keeps released ones warm.
+    QHash<QString, Session> sessions;                ///< Device sessions, by registry key.
+    QHash<quint32, QString> tickets;                 ///< Registry keys, by connection manager ticket.
+
+    int maxJobs { 0 };                               ///< Maximum concurrent job runs, or 0 for #maxConnections.
+    std::optional<quint32> jitter;                   ///< Maximum delay per job run; default: a tenth of its interval.
+    QHash<quint32, ScheduledJob> scheduledJobs;      ///< Scheduled jobs, by job ID.
+    QQueue<quint32> dueJobs;                         ///< Jobs that are due, but waiting for a free concurrent run.
+    int runningJobs { 0 };                           ///< Number of job runs dispatched, and not yet finished.
+    quint32 lastJobId { 0 };                         ///< ID of the most recently scheduled job.
+    TimerWheel wheel { 250 };                        ///< Due times of all #scheduledJobs, per #clock.
+    QElapsedTimer clock;                             ///< Monotonic clock for #wheel.
+    QTimer * wheelTimer { nullptr };                 ///< Advances #wheel, and #prewarmWheel, while jobs are scheduled.
+    quint32 prewarmLead { 0 };                       ///< Milliseconds to pre-warm devices before job runs, or 0.
+    TimerWheel prewarmWheel { 250 };                 ///< Pre-warming times of #scheduledJobs' next runs, per #clock.
+
+    static constexpr qint64 maxRequestSize { 64 * 1024 }; ///< Maximum size of a single client request line.
+    static constexpr int reportInterval { 5000 };    ///< Interval between device reports to the aggregator, in ms.
+    static constexpr int reconnectInterval { 5000 }; ///< Delay before reconnecting to the aggregator, in ms.
+
+    void newConnection();
+    void newWebSocketConnection();
+    void readRequests(QIODevice * const client);
+    void clientDisconnected(QIODevice * const client);
+    QJsonObject handleRequest(QIODevice * const client, const QJsonObject &request, const quint32 job = 0);
+    QJsonObject devicesResponse(const QJsonValue &id) const;
+    QJsonObject unsubscribe(QIODevice * const client, const QJsonValue &id, const QString &deviceName);
+    int removeStatusWatchers(const QString &key, QIODevice * const client);
+    std::optional<PokitDeviceRegistry::Entry> findDevice(const QString &deviceName) const;
+
+    void connectToAggregator();
+    void aggregatorConnected();
+    void aggregatorDisconnected();
+    void reportDevices();
+    QJsonObject clockReport() const;
+    void stamp(QJsonObject &event) const;
+    QJsonObject assign(const QJsonValue &id, const QJsonValue &devices);
+
+    QJsonObject scheduleJob(QIODevice * const client, const QJsonObject &request);
+    int removeScheduledJobs(QIODevice * const client, const QString &deviceName = QString());
+    void advanceJobs();
+    void dispatchJobs();
+    void runJob(const quint32 id);
+    void finishJobs(const QVector<Reply> &replies);
+    void schedulePrewarm(const quint32 id, const qint64 due);
+    void prewarmJob(const quint32 id);
+    quint32 jitterFor(const quint32 interval) const;
+
+    void enqueue(const PokitDeviceRegistry::Entry &entry, const std::function<void()> &job);
+    void granted(const quint32 ticket, PokitDevice * const device);
+    void failed(const quint32 ticket);
+    void whenReady(const QString &key, AbstractPokitService * const service, const std::function<void()> &job);
+    void serviceError(const QString &key, const QLowEnergyService::ServiceError error);
+    void maybeRelease(const QString &key);
+    void endSession(const QString &key, const QString &error = QString());
+
+    void readStatus(const QString &key);
+    void statusRead(const QString &key, const StatusService::Status &status);
+    void watchStatus(const QString &key);
+    void unwatchStatus(const QString &key);
+    void startMeter(const QString &key);
+    void meterReading(const QString &key, const MultimeterService::Reading &reading);
+    void stopMeter(const QString &key);
+    void captureDso(const QString &key);
+    void dsoCaptured(const QString &key, const DsoService::Metadata &metadata, const DsoService::Samples &samples);
+    void fetchLogger(const QString &key);
+    void loggerMetadataRead(const QString &key, const DataLoggerService::Metadata &metadata);
+    void loggerSamplesRead(const QString &key, const DataLoggerService::Samples &samples);
+    void calibrate(const QString &key);
+    void calibrated(const QString &key);
+
+    static QStringList parseMeterSettings(const QJsonObject &request, MultimeterService::Settings &settings,
+                                          MeterCommand::MinRangeFunc &rangeFunc, quint32 &rangeValue);
+    static QStringList parseDsoSettings(const QJsonObject &request, DsoService::Settings &settings,
+                                        MeterCommand::MinRangeFunc &rangeFunc, quint32 &rangeValue);
+    static QStringList parseStatusSettings(const QJsonObject &request, quint32 &coalesceInterval,
+                                           quint32 &lowBatteryThreshold);
+    static QStringList parseCalibrationSettings(const QJsonObject &request, float &temperature);
+    static QStringList parseEncoding(const QJsonObject &request, Encoding &encoding);
+    static QStringList parsePoints(const QJsonObject &request, quint32 &points);
+    static QStringList parseRate(const QJsonObject &request, quint32 &every, bool &last);
+    static QVector<qint16> decimateSamples(const QVector<qint16> &samples, const quint32 points);
+    static QJsonObject encodeSamples(const QVector<qint16> &samples, const float scale, const Encoding encoding);
+    static QJsonObject toJson(const StatusService::Status &status);
+    static QString toOptionValue(const QJsonValue &value);
+    static QJsonObject okResponse(const QJsonValue &id, QJsonObject object = QJsonObject());
+    static QJsonObject errorResponse(const QJsonValue &id, const QString &message);
+    static void send(QIODevice * const client, const QJsonObject &message);
+    static void send(const QVector<Reply> &replies, const QJsonObject &message);
+    static void sendSamples(const QVector<Reply> &replies, const QJsonObject &message, const QVector<qint16> &samples,
+                            const float scale);
+
+    QTPOKIT_BEFRIEND_TEST(DaemonCommand)
+};
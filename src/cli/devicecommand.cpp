@@ -2,12 +2,69 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "devicecommand.h"
+#include "phasetimer.h"
+#include "../stringliterals_p.h"
 
 #include <qtpokit/abstractpokitservice.h>
 #include <qtpokit/pokitdevice.h>
 #include <qtpokit/pokitdiscoveryagent.h>
 #include <qtpokit/pokitmeter.h>
 #include <qtpokit/pokitpro.h>
+#include <qtpokit/sampleexpression.h>
+#include <qtpokit/samplefilter.h>
+#include <qtpokit/stallwatchdog.h>
+#include <qtpokit/statusservice.h>
+#include <qtpokit/trafficrecorder.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QLowEnergyService>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#if defined(Q_OS_UNIX)
+#include <QSocketNotifier>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Qt 6.5.0 added new QDateTime::fromSecsSinceEpoch() and fromMSecsSinceEpoch()
+// overloads, then Qt 6.6.0 deprecated some of of the older ones.
+#if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
+    #define DOKIT_QT_UTC Qt::UTC
+#else
+    #include <QTimeZone>
+    #define DOKIT_QT_UTC QTimeZone::UTC
+#endif
+
+DOKIT_USE_STRINGLITERALS
+
+#if defined(Q_OS_UNIX)
+namespace {
+
+int statisticsSignalSockets[2] { -1, -1 }; ///< Socket pair for forwarding SIGUSR1 to the event loop.
+
+/// Handles SIGUSR1 by waking the event loop, since (almost) nothing else is async-signal-safe.
+void statisticsSignalHandler(int)
+{
+    const char signal = 1;
+    [[maybe_unused]] const auto bytesWritten = ::write(statisticsSignalSockets[0], &signal, sizeof(signal));
+}
+
+}
+#endif
 
 /*!
  * \class DeviceCommand
@@ -24,10 +81,130 @@ DeviceCommand::DeviceCommand(QObject * const parent) : AbstractCommand(parent)
 }
 
 /*!
- * Begins scanning for the Pokit device.
+ * \copybrief AbstractCommand::supportedOptions
+ *
+ * This implementation extends AbstractCommand::supportedOptions to add the `connection-profile`, `device-thread`,
+ * `discovery-cache`, `known-devices`, `latency-report`, `link-statistics`, `reconnect`, `record` and `sink-threads`
+ * options, supported by all device commands.
+ */
+QStringList DeviceCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"connection-profile"_s,
+        u"device-thread"_s,
+        u"discovery-cache"_s,
+        u"known-devices"_s,
+        u"latency-report"_s,
+        u"link-statistics"_s,
+        u"reconnect"_s,
+        u"record"_s,
+        u"sink-threads"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process the `connection-profile`, `device-thread`,
+ * `discovery-cache`, `known-devices`, `latency-report`, `link-statistics`, `reconnect`, `record` and `sink-threads`
+ * options.
+ */
+QStringList DeviceCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    if (parser.isSet(u"connection-profile"_s)) {
+        const QString value = parser.value(u"connection-profile"_s).trimmed().toLower();
+        if (value == u"default"_s) {
+            connectionProfile = PokitDevice::ConnectionProfile::Default;
+        } else if ((value == u"low-latency"_s) || (value == u"lowlatency"_s)) {
+            connectionProfile = PokitDevice::ConnectionProfile::LowLatency;
+        } else if ((value == u"low-power"_s) || (value == u"lowpower"_s)) {
+            connectionProfile = PokitDevice::ConnectionProfile::LowPower;
+        } else {
+            errors.append(tr("Unknown connection profile: %1").arg(parser.value(u"connection-profile"_s)));
+        }
+    }
+
+    if (parser.isSet(u"device-thread"_s)) {
+        if (ThreadPolicy::Settings settings; parseThreadPolicy(parser.value(u"device-thread"_s), settings)) {
+            deviceThreadPolicy = settings;
+        } else {
+            errors.append(tr("Invalid device thread policy: %1").arg(parser.value(u"device-thread"_s)));
+        }
+    }
+
+    if (parser.isSet(u"discovery-cache"_s)) {
+        discoveryCache = new QSettings(this);
+        discoveryCache->beginGroup(u"discoveryCache"_s);
+    }
+
+    if (parser.isSet(u"known-devices"_s)) {
+        knownDevices = new QSettings(this);
+        knownDevices->beginGroup(u"knownDevices"_s);
+    }
+
+    if (parser.isSet(u"latency-report"_s)) {
+        latencyTracking = true;
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                this, &DeviceCommand::outputLatencyReport);
+    }
+
+    if (parser.isSet(u"link-statistics"_s)) {
+        linkStatistics = true;
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &DeviceCommand::outputStatistics);
+        watchStatisticsSignal();
+    }
+
+    if (parser.isSet(u"reconnect"_s)) {
+        const QString value = parser.value(u"reconnect"_s);
+        bool ok;
+        const uint attempts = value.toUInt(&ok);
+        if ((!ok) || (attempts == 0) || (attempts > (uint)std::numeric_limits<int>::max())) {
+            errors.append(tr("Invalid reconnect attempts: %1").arg(value));
+        } else {
+            reconnectAttempts = (int)attempts;
+        }
+    }
+
+    if (parser.isSet(u"record"_s)) {
+        recorder = new TrafficRecorder(parser.value(u"record"_s), this);
+        if (recorder->start()) {
+            // Commands may exit without being destroyed, so flush the recording on quit.
+            connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, recorder, &TrafficRecorder::stop);
+        } else {
+            errors.append(tr("Failed to record traffic to %1").arg(recorder->fileName()));
+        }
+    }
+
+    if (parser.isSet(u"sink-threads"_s)) {
+        if (ThreadPolicy::Settings settings; parseThreadPolicy(parser.value(u"sink-threads"_s), settings)) {
+            sinkThreadPolicy = settings;
+            if (outputFile) {
+                outputFile->setThreadPolicy(settings);
+            }
+        } else {
+            errors.append(tr("Invalid sink threads policy: %1").arg(parser.value(u"sink-threads"_s)));
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Begins scanning for the Pokit device, or if the device is known (see knownDevice()), begins connecting to it
+ * directly, without scanning first.
  */
 bool DeviceCommand::start()
 {
+    if (const std::optional<QBluetoothDeviceInfo> info = knownDevice(deviceToScanFor); info) {
+        qCInfo(lc).noquote() << tr(R"(Connecting to known device "%1"...)").arg(deviceToScanFor);
+        connectingDirectly = true;
+        deviceDiscovered(*info);
+        return true;
+    }
     qCInfo(lc).noquote() << ((deviceToScanFor.isNull())
         ? tr("Looking for first available Pokit device...")
         : tr(R"(Looking for device "%1"...)").arg(deviceToScanFor));
@@ -35,19 +212,108 @@ bool DeviceCommand::start()
     return true;
 }
 
+/*!
+ * Begins this command on \a sharedDevice, a \a product device that has already been connected to (by SessionCommand),
+ * instead of scanning for, and connecting to, a device of its own.
+ *
+ * The shared device's controller signals remain the session's to handle. And since the device's services are shared
+ * too, this command's service may have already discovered its details (for an earlier command), in which case
+ * serviceDetailsDiscovered() is invoked straight away (via the event loop).
+ *
+ * Once done, this command emits finished(), rather than disconnecting the device, or exiting the application.
+ */
+bool DeviceCommand::startWithDevice(PokitDevice * const sharedDevice, const PokitProduct product)
+{
+    Q_ASSERT(sharedDevice);
+    Q_ASSERT(!device);
+    device = sharedDevice;
+    deviceIsShared = true;
+
+    AbstractPokitService * const service = getService();
+    Q_ASSERT(service);
+    service->setPokitProduct(product);
+    if (recorder) {
+        recorder->addService(service);
+    }
+    connect(service, &AbstractPokitService::serviceDetailsDiscovered, this, [this]() {
+        if (!std::exchange(serviceResuming, false)) {
+            serviceDetailsDiscovered();
+        }
+    });
+    connect(service, &AbstractPokitService::resumed, this, [this](const qint64 gapStart, const qint64 gapEnd) {
+        serviceResuming = true; // The service is about to emit serviceDetailsDiscovered again.
+        serviceResumed(gapStart, gapEnd);
+    });
+    connect(service, &AbstractPokitService::serviceErrorOccurred,
+            this, &DeviceCommand::serviceError);
+
+    if (const QLowEnergyService * const lowEnergyService = service->service(); (lowEnergyService) &&
+        (lowEnergyService->state() ==
+        #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+        QLowEnergyService::ServiceDiscovered
+        #else
+        QLowEnergyService::RemoteServiceDiscovered
+        #endif
+    )) {
+        QTimer::singleShot(0, this, [this]() { serviceDetailsDiscovered(); });
+    }
+    return true;
+}
+
 /*!
  * Disconnects the underlying Pokit device, and sets \a exitCode to be return to the OS once the
  * disconnection has taken place.
+ *
+ * If a non-default connection profile was requested, the default profile is requested again first.
+ *
+ * However, if the device is shared (see startWithDevice()), then the device is left connected, and this command
+ * simply finishes with \a exitCode instead.
  */
 void DeviceCommand::disconnect(int exitCode)
 {
-    qCDebug(lc).noquote() << tr("Disconnecting Pokit device...");
     Q_ASSERT(device);
     Q_ASSERT(device->controller());
     exitCodeOnDisconnect = exitCode;
-    device->controller()->disconnectFromDevice();
+    if (deviceIsShared) {
+        finish(exitCode);
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Disconnecting Pokit device...");
+    if ((connectionProfile) && (*connectionProfile != PokitDevice::ConnectionProfile::Default)) {
+        // Revert to the default profile, in case the platform keeps the connection (and its parameters) alive.
+        device->setConnectionProfile(PokitDevice::ConnectionProfile::Default);
+    }
+    device->disconnectFromDevice(); // Via the device, so this is not treated as an unexpected disconnection.
+}
+
+/*!
+ * Finishes this command with \a exitCode, without disconnecting the device. That is, emits finished() if the device is
+ * shared (see startWithDevice()), otherwise exits the application with \a exitCode.
+ *
+ * When shared, all of this command's output is written first (as the destructor would), so that it precedes the output
+ * of the session's next command.
+ */
+void DeviceCommand::finish(const int exitCode)
+{
+    if (deviceIsShared) {
+        qCDebug(lc).noquote() << tr("Command finished with code %1.").arg(exitCode);
+        if (std::exchange(arrowSchemaWritten, false)) {
+            writeArrowEndOfStream(outputBuffer);
+        }
+        flushOutput();
+        emit finished(exitCode);
+        return;
+    }
+    QCoreApplication::exit(exitCode);
 }
 
+/*!
+ * \fn void DeviceCommand::finished(const int exitCode)
+ *
+ * This signal is emitted when a command, running on a shared device (see startWithDevice()), has finished with
+ * \a exitCode.
+ */
+
 /*!
  * \fn virtual AbstractPokitService * DeviceCommand::getService() = 0
  *
@@ -57,9 +323,369 @@ void DeviceCommand::disconnect(int exitCode)
  * device's connection process.
  */
 
-#define DOKIT_CLI_IF_LESS_THAN_RETURN(value, ns, label) \
-if (value <= ns::maxValue(label)) { \
-    return label; \
+/*!
+ * Returns \c true if this command reads characteristic values cached by service discovery (such as
+ * DeviceInfoService::serialNumber()), rather than reading, or being notified of, them explicitly.
+ *
+ * This base implementation returns \c false, which allows restoreDiscoveryCache() to skip value discovery. Derived
+ * classes that use discovered values should override this function to return \c true.
+ */
+bool DeviceCommand::usesDiscoveredValues() const
+{
+    return false;
+}
+
+/*!
+ * Restores the current device's cached capabilities (if any) to #device, and if \a service's characteristic layout
+ * has been cached, and this command does not use discovered values, has \a service skip value discovery.
+ *
+ * Layouts are cached by service class name, rather than UUID, since not all services' UUIDs are known before
+ * discovery (see StatusService::ServiceUuids).
+ *
+ * \see saveDiscoveryCache
+ */
+void DeviceCommand::restoreDiscoveryCache(AbstractPokitService * const service)
+{
+    if ((!discoveryCache) || (discoveryCacheKey.isEmpty())) {
+        return;
+    }
+    discoveryCache->beginGroup(discoveryCacheKey);
+    if ((device) && (discoveryCache->contains(u"firmwareVersion"_s))) {
+        PokitDevice::Capabilities capabilities = device->capabilities();
+        capabilities.firmwareVersion =
+            QVersionNumber::fromString(discoveryCache->value(u"firmwareVersion"_s).toString());
+        capabilities.maximumSamplingRate = discoveryCache->value(u"maximumSamplingRate"_s).toUInt();
+        capabilities.samplingBufferSize = discoveryCache->value(u"samplingBufferSize"_s).toUInt();
+        capabilities.maximumVoltage = discoveryCache->value(u"maximumVoltage"_s).toUInt();
+        capabilities.maximumCurrent = discoveryCache->value(u"maximumCurrent"_s).toUInt();
+        capabilities.maximumResistance = discoveryCache->value(u"maximumResistance"_s).toUInt();
+        capabilities.capabilityMask = discoveryCache->value(u"capabilityMask"_s).toUInt();
+        capabilities.macAddress = QBluetoothAddress(discoveryCache->value(u"macAddress"_s).toString());
+        if (discoveryCache->contains(u"loggerUpdateIntervalIs32bit"_s)) {
+            capabilities.loggerUpdateIntervalIs32bit = discoveryCache->value(u"loggerUpdateIntervalIs32bit"_s).toBool();
+        }
+        qCDebug(lc).noquote() << tr("Restoring cached capabilities for firmware %1.")
+            .arg(capabilities.firmwareVersion.toString());
+        device->setCapabilities(capabilities);
+    }
+    if ((service) && (!usesDiscoveredValues()) &&
+        (discoveryCache->contains(u"services/"_s + QString::fromLatin1(service->metaObject()->className())))) {
+        qCDebug(lc).noquote() << tr("Service layout cached; skipping value discovery.");
+        service->setSkipValueDiscovery();
+    }
+    discoveryCache->endGroup();
+}
+
+/*!
+ * Saves \a service's discovered characteristic layout to the discovery cache, first invalidating the current device's
+ * whole cache entry if the cached layout differs from the discovered one.
+ *
+ * \see restoreDiscoveryCache
+ */
+void DeviceCommand::saveDiscoveryCache(const AbstractPokitService * const service)
+{
+    if ((!discoveryCache) || (discoveryCacheKey.isEmpty()) || (!service) || (!service->service())) {
+        return;
+    }
+    QStringList layout;
+    for (const QLowEnergyCharacteristic &characteristic: service->service()->characteristics()) {
+        layout.append(characteristic.uuid().toString(QUuid::WithoutBraces));
+    }
+    layout.sort();
+
+    const QString key = discoveryCacheKey + u"/services/"_s + QString::fromLatin1(service->metaObject()->className());
+    if ((discoveryCache->contains(key)) && (discoveryCache->value(key).toStringList() != layout)) {
+        qCInfo(lc).noquote() << tr("Cached service layout is stale; invalidating discovery cache for %1.")
+            .arg(discoveryCacheKey);
+        discoveryCache->remove(discoveryCacheKey);
+    }
+    discoveryCache->setValue(key, layout);
+}
+
+/*!
+ * Returns \a statistics formatted as (non-translated) `key=value` lines, suitable for machine parsing.
+ *
+ * The first line covers the device's connection, followed by two lines for each service: one for its counts, and one
+ * for its histogram of intervals between notifications, in milliseconds (see AbstractPokitService::Statistics).
+ */
+QString DeviceCommand::formatStatistics(const PokitDevice::Statistics &statistics)
+{
+    QString text = QStringLiteral("# link statistics\n"
+        "device: connections=%1 disconnections=%2 reconnections=%3 reconnectFailures=%4 errors=%5\n")
+        .arg(statistics.connections).arg(statistics.disconnections).arg(statistics.reconnections)
+        .arg(statistics.reconnectFailures).arg(statistics.errors);
+    for (const AbstractPokitService::Statistics &service: statistics.services) {
+        QString name = PokitDevice::serviceToString(service.service);
+        if (name.isEmpty()) {
+            name = (service.service.isNull()) ? u"unknown"_s : service.service.toString(QUuid::WithoutBraces);
+        }
+        text += QStringLiteral("service \"%1\": notifications=%2 reads=%3 bytes=%4 parseFailures=%5 errors=%6 "
+            "stalls=%7 stallRecoveries=%8 memoryBytes=%9\n").arg(name)
+            .arg(service.notifications).arg(service.reads).arg(service.bytes).arg(service.parseFailures)
+            .arg(service.errors).arg(service.stalls).arg(service.stallRecoveries).arg(service.memoryBytes);
+        text += u"service \"%1\": gaps(ms):"_s.arg(name);
+        for (int bucket = 0; bucket < service.notificationGaps.size(); ++bucket) {
+            const QString range = (bucket == 0) ? u"<1"_s : (bucket == service.notificationGaps.size() - 1)
+                ? u">=%1"_s.arg(1 << (bucket - 1)) : u"%1-%2"_s.arg(1 << (bucket - 1)).arg(1 << bucket);
+            text += u" %1=%2"_s.arg(range).arg(service.notificationGaps.at(bucket));
+        }
+        text += u'\n';
+    }
+    return text;
+}
+
+/*!
+ * Returns the \a statistics of the output writer writing to \a name (such as `stdout`, or an output file), formatted
+ * as a single (non-translated) `key=value` line, like formatStatistics(), so that output lost (or delayed) between the
+ * device's notifications and the output can be told apart from notifications lost by the device itself.
+ */
+QString DeviceCommand::formatSinkStatistics(const QString &name, const OutputFileWriter::Statistics &statistics)
+{
+    return u"sink \"%1\": bytes=%2 writes=%3 dropped=%4 bytesDropped=%5 blocked=%6 blockedMs=%7 errors=%8\n"_s
+        .arg(name).arg(statistics.bytesWritten).arg(statistics.writes).arg(statistics.dropped)
+        .arg(statistics.bytesDropped).arg(statistics.blocked).arg(statistics.blockedTime / 1'000'000)
+        .arg(statistics.errors);
+}
+
+/*!
+ * Returns the \a statistics of the InfluxDB writer, formatted as a single (non-translated) `key=value` line, like
+ * formatStatistics().
+ */
+QString DeviceCommand::formatSinkStatistics(const InfluxWriter::Statistics &statistics)
+{
+    return u"sink \"influx\": points=%1 skipped=%2 batches=%3 written=%4 retries=%5 rejected=%6 dropped=%7\n"_s
+        .arg(statistics.points).arg(statistics.skipped).arg(statistics.batches).arg(statistics.written)
+        .arg(statistics.retries).arg(statistics.rejected).arg(statistics.dropped);
+}
+
+/*!
+ * Returns the memory budget \a statistics, formatted as (non-translated) `key=value` lines, like formatStatistics():
+ * one for the budget as a whole, followed by one for each of its streams (that is, buffers) currently holding memory.
+ * Limits and quotas of 0 mean there is none.
+ */
+QString DeviceCommand::formatMemoryStatistics(const MemoryBudget::Statistics &statistics)
+{
+    QString text = u"memory: limit=%1 bytes=%2 peak=%3 refusals=%4\n"_s
+        .arg(statistics.limit).arg(statistics.bytes).arg(statistics.peak).arg(statistics.refusals);
+    for (const MemoryBudget::Usage &usage: statistics.streams) {
+        if ((usage.bytes > 0) || (usage.refusals > 0)) {
+            text += u"memory \"%1\": kind=%2 bytes=%3 peak=%4 quota=%5 refusals=%6\n"_s.arg(usage.name,
+                MemoryBudget::toString(usage.kind)).arg(usage.bytes).arg(usage.peak).arg(usage.quota)
+                .arg(usage.refusals);
+        }
+    }
+    return text;
+}
+
+/*!
+ * Returns the \a statistics of each of a pipeline's stages, formatted as (non-translated) `key=value` lines, like
+ * formatStatistics(), so that each stage's own throughput (values processed per second of busy time) and queue depth
+ * (values held, such as by an open aggregate window) can be told apart from those of the device, and the sinks.
+ */
+QString DeviceCommand::formatPipelineStatistics(const QVector<SampleGraph::StageStatistics> &statistics)
+{
+    QString text;
+    for (const SampleGraph::StageStatistics &stage: statistics) {
+        text += QStringLiteral("pipeline \"%1\": stage=%2 inputs=%3 blocksIn=%4 valuesIn=%5 blocksOut=%6 "
+            "valuesOut=%7 queueDepth=%8 peakQueueDepth=%9 ").arg(stage.name, SampleGraph::toString(stage.stage),
+            stage.inputs.join(u',')).arg(stage.blocksIn).arg(stage.valuesIn).arg(stage.blocksOut)
+            .arg(stage.valuesOut).arg(stage.queueDepth).arg(stage.peakQueueDepth);
+        text += u"busyUs=%1 throughput=%2\n"_s.arg(stage.busyTime / 1000).arg(qRound64(stage.throughput));
+    }
+    return text;
+}
+
+/*!
+ * Returns the effective settings (\a state) of the thread \a name, such as the device's thread, or an output file's
+ * writer thread, formatted as a single (non-translated) `key=value` line, like formatStatistics(). The `errors` count
+ * is the number of requested settings the OS refused (each of which is also logged, as a warning).
+ */
+QString DeviceCommand::formatThreadStatistics(const QString &name, const ThreadPolicy::State &state)
+{
+    return u"thread \"%1\": cpus=%2 priority=%3 realtimePriority=%4 errors=%5\n"_s.arg(name,
+        ThreadPolicy::formatCpus(state.cpus), ThreadPolicy::toString(state.priority)).arg(state.realtimePriority)
+        .arg(state.errors.size());
+}
+
+/*!
+ * Outputs the device's link statistics (if connected to a device yet), followed by the statistics of the command's
+ * output writer, InfluxDB writer and pipeline (if any), and of the global memory budget, to stderr. The effective
+ * settings of the device's thread, and of each writer's thread, follow their statistics, if set via the
+ * `device-thread` and `sink-threads` options.
+ *
+ * \see formatStatistics
+ * \see formatSinkStatistics
+ * \see formatPipelineStatistics
+ * \see formatThreadStatistics
+ * \see formatMemoryStatistics
+ */
+void DeviceCommand::outputStatistics() const
+{
+    if (device) {
+        fputs(qUtf8Printable(formatStatistics(device->statistics())), stderr);
+        if (const ThreadPolicy::State state = device->threadPolicy(); state.applied) {
+            fputs(qUtf8Printable(formatThreadStatistics(u"device"_s, state)), stderr);
+        }
+    }
+    if (outputFile) {
+        fputs(qUtf8Printable(formatSinkStatistics(outputFile->fileName(), outputFile->statistics())), stderr);
+        if (const ThreadPolicy::State state = outputFile->threadPolicy(); state.applied) {
+            fputs(qUtf8Printable(formatThreadStatistics(outputFile->fileName(), state)), stderr);
+        }
+    }
+    if (influx) {
+        fputs(qUtf8Printable(formatSinkStatistics(influx->statistics())), stderr);
+    }
+    if (pipeline) {
+        fputs(qUtf8Printable(formatPipelineStatistics(pipeline->statistics())), stderr);
+        for (const PipelineSink &sink: pipelineSinks) {
+            fputs(qUtf8Printable(formatSinkStatistics(sink.writer->fileName(), sink.writer->statistics())), stderr);
+            if (const ThreadPolicy::State state = sink.writer->threadPolicy(); state.applied) {
+                fputs(qUtf8Printable(formatThreadStatistics(sink.writer->fileName(), state)), stderr);
+            }
+        }
+    }
+    fputs(qUtf8Printable(formatMemoryStatistics(MemoryBudget::global()->statistics())), stderr);
+}
+
+/*!
+ * Returns a latency report, as (non-translated) `key=value` lines, suitable for machine parsing, for the `parse` and
+ * `emit` stages of all of \a statistics' services (see AbstractPokitService::Statistics), and the command's own
+ * `format` and `write` stages, per \a formatLatency and \a writeLatency.
+ *
+ * Each stage's latencies are from the (host) receipt of each value, to the end of that stage, so the `write` stage's
+ * latencies are end-to-end. Since commands format (and, per #flushPolicy, write) their output in slots directly
+ * connected to the services' signals, the `emit` stage normally ends last. Latencies are in microseconds, with
+ * `jitter` being the difference between the 99th and 50th percentiles.
+ */
+QString DeviceCommand::formatLatencyReport(const PokitDevice::Statistics &statistics,
+                                           const LatencyHistogram &formatLatency, const LatencyHistogram &writeLatency)
+{
+    LatencyHistogram parseLatency, emitLatency;
+    for (const AbstractPokitService::Statistics &service: statistics.services) {
+        parseLatency.merge(service.parseLatency);
+        emitLatency.merge(service.emitLatency);
+    }
+    const auto us = [](const qint64 nanoseconds) { return QString::number((double)nanoseconds / 1e3, 'f', 1); };
+    const auto line = [&us](const QString &stage, const LatencyHistogram &histogram) {
+        return u"stage \"%1\": count=%2 min=%3 p50=%4 p90=%5 p99=%6 p99.9=%7 max=%8 jitter=%9\n"_s.arg(stage)
+            .arg(histogram.count()).arg(us(histogram.minimum())).arg(us(histogram.percentile(50.0)))
+            .arg(us(histogram.percentile(90.0))).arg(us(histogram.percentile(99.0)))
+            .arg(us(histogram.percentile(99.9))).arg(us(histogram.maximum()))
+            .arg(us(histogram.percentile(99.0) - histogram.percentile(50.0)));
+    };
+    return u"# latency report (us)\n"_s + line(u"parse"_s, parseLatency) + line(u"emit"_s, emitLatency)
+        + line(u"format"_s, formatLatency) + line(u"write"_s, writeLatency);
+}
+
+/*!
+ * Outputs the latency report (see formatLatencyReport()) to stderr.
+ */
+void DeviceCommand::outputLatencyReport() const
+{
+    fputs(qUtf8Printable(formatLatencyReport((device) ? device->statistics() : PokitDevice::Statistics{},
+                                             formatLatency, writeLatency)), stderr);
+}
+
+/*!
+ * On Unix-like systems, arranges for outputStatistics() to be invoked whenever the process receives SIGUSR1, such as
+ * via `kill -USR1 <pid>`, so that the statistics of long-running commands can be checked on demand. The signal is
+ * forwarded to the event loop via a socket pair, so that outputStatistics() is invoked safely, on the main thread.
+ *
+ * On other platforms, this function does nothing.
+ */
+void DeviceCommand::watchStatisticsSignal()
+{
+    #if defined(Q_OS_UNIX)
+    if ((statisticsSignalSockets[0] < 0) && (::socketpair(AF_UNIX, SOCK_STREAM, 0, statisticsSignalSockets) != 0)) {
+        qCWarning(lc).noquote() << tr("Failed to watch for SIGUSR1: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+        statisticsSignalSockets[0] = statisticsSignalSockets[1] = -1;
+        return;
+    }
+    auto * const notifier = new QSocketNotifier(statisticsSignalSockets[1], QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, [this]() {
+        char signal;
+        [[maybe_unused]] const auto bytesRead = ::read(statisticsSignalSockets[1], &signal, sizeof(signal));
+        outputStatistics();
+    });
+    struct sigaction action {};
+    action.sa_handler = statisticsSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR1, &action, nullptr) != 0) {
+        qCWarning(lc).noquote() << tr("Failed to watch for SIGUSR1: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+    }
+    #endif
+}
+
+/*!
+ * Returns the known device (see saveKnownDevice()) best matching \a device, by name, address or (on macOS) UUID, or
+ * \c std::nullopt if there is no such device, or the known-device store is not enabled.
+ *
+ * If more than one known device matches (typically by name), the most recently seen is returned. The returned info
+ * is enough to connect to the device directly, without scanning for it first.
+ */
+std::optional<QBluetoothDeviceInfo> DeviceCommand::knownDevice(const QString &device) const
+{
+    if ((!knownDevices) || (device.isEmpty())) {
+        return std::nullopt;
+    }
+    std::optional<QBluetoothDeviceInfo> known;
+    QDateTime knownLastSeen;
+    for (const QString &key: knownDevices->childGroups()) {
+        knownDevices->beginGroup(key);
+        const QString name = knownDevices->value(u"name"_s).toString();
+        const QBluetoothAddress address(knownDevices->value(u"address"_s).toString());
+        const QBluetoothUuid uuid(knownDevices->value(u"uuid"_s).toString());
+        const QString product = knownDevices->value(u"product"_s).toString();
+        const QDateTime lastSeen = QDateTime::fromString(knownDevices->value(u"lastSeen"_s).toString(), Qt::ISODate);
+        knownDevices->endGroup();
+
+        const bool matches = (device == name) || ((!address.isNull()) && (QBluetoothAddress(device) == address)) ||
+            ((!uuid.isNull()) && (QBluetoothUuid(device) == uuid));
+        if ((!matches) || ((address.isNull()) && (uuid.isNull())) || ((known) && (lastSeen <= knownLastSeen))) {
+            continue;
+        }
+
+        QBluetoothDeviceInfo info = (address.isNull()) ? QBluetoothDeviceInfo(uuid, name, 0)
+                                                       : QBluetoothDeviceInfo(address, name, 0);
+        info.setCoreConfigurations(QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+        const QBluetoothUuid statusService = (product == toString(PokitProduct::PokitPro))
+            ? StatusService::ServiceUuids::pokitPro : StatusService::ServiceUuids::pokitMeter;
+        #if (QT_VERSION < QT_VERSION_CHECK(5, 13, 0))
+        info.setServiceUuids({ statusService }, QBluetoothDeviceInfo::DataIncomplete);
+        #else
+        info.setServiceUuids({ statusService });
+        #endif
+        known = info;
+        knownLastSeen = lastSeen;
+    }
+    return known;
+}
+
+/*!
+ * Saves \a info's name, address (or on macOS, UUID) and Pokit product, and the current time, to the known-device
+ * store (if enabled), so later invocations can connect to the same device without scanning for it first.
+ *
+ * \see knownDevice
+ */
+void DeviceCommand::saveKnownDevice(const QBluetoothDeviceInfo &info)
+{
+    if (!knownDevices) {
+        return;
+    }
+    // Prefer the device's address, but macOS only provides an (OS-assigned) UUID.
+    knownDevices->beginGroup((info.address().isNull()) ? info.deviceUuid().toString(QUuid::WithoutBraces)
+                                                       : info.address().toString());
+    knownDevices->setValue(u"name"_s, info.name());
+    if (info.address().isNull()) {
+        knownDevices->setValue(u"uuid"_s, info.deviceUuid().toString(QUuid::WithoutBraces));
+    } else {
+        knownDevices->setValue(u"address"_s, info.address().toString());
+    }
+    knownDevices->setValue(u"product"_s, toString(pokitProduct(info)));
+    knownDevices->setValue(u"lastSeen"_s, QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    knownDevices->endGroup();
 }
 
 /**
@@ -88,13 +714,7 @@ if (value <= ns::maxValue(label)) { \
  */
 template<> PokitMeter::CurrentRange DeviceCommand::minRange<>(const quint32 maxValue)
 {
-    if (maxValue == 0) return PokitMeter::CurrentRange::AutoRange;
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::CurrentRange::_10mA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::CurrentRange::_30mA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::CurrentRange::_150mA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::CurrentRange::_300mA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::CurrentRange::_2A)
-    return PokitMeter::CurrentRange::AutoRange;
+    return RangeTable::minRange(PokitMeter::currentRanges, maxValue);
 }
 
 /*!
@@ -103,16 +723,7 @@ template<> PokitMeter::CurrentRange DeviceCommand::minRange<>(const quint32 maxV
  */
 template<> PokitMeter::ResistanceRange DeviceCommand::minRange(const quint32 maxValue)
 {
-    if (maxValue == 0) return PokitMeter::ResistanceRange::AutoRange;
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::ResistanceRange::_160)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::ResistanceRange::_330)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::ResistanceRange::_890)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::ResistanceRange::_1K5)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::ResistanceRange::_10K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::ResistanceRange::_100K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::ResistanceRange::_470K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::ResistanceRange::_1M)
-    return PokitMeter::ResistanceRange::AutoRange;
+    return RangeTable::minRange(PokitMeter::resistanceRanges, maxValue);
 }
 
 /*!
@@ -121,14 +732,7 @@ template<> PokitMeter::ResistanceRange DeviceCommand::minRange(const quint32 max
  */
 template<> PokitMeter::VoltageRange DeviceCommand::minRange(const quint32 maxValue)
 {
-    if (maxValue == 0) return PokitMeter::VoltageRange::AutoRange;
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::VoltageRange::_300mV)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::VoltageRange::_2V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::VoltageRange::_6V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::VoltageRange::_12V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::VoltageRange::_30V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitMeter, PokitMeter::VoltageRange::_60V)
-    return PokitMeter::VoltageRange::AutoRange;
+    return RangeTable::minRange(PokitMeter::voltageRanges, maxValue);
 }
 
 /*!
@@ -137,11 +741,7 @@ template<> PokitMeter::VoltageRange DeviceCommand::minRange(const quint32 maxVal
  */
 template<> PokitPro::CapacitanceRange DeviceCommand::minRange(const quint32 maxValue)
 {
-    if (maxValue == 0) return PokitPro::CapacitanceRange::AutoRange;
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CapacitanceRange::_100nF)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CapacitanceRange::_10uF)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CapacitanceRange::_1mF)
-    return PokitPro::CapacitanceRange::AutoRange;
+    return RangeTable::minRange(PokitPro::capacitanceRanges, maxValue);
 }
 
 /*!
@@ -150,15 +750,7 @@ template<> PokitPro::CapacitanceRange DeviceCommand::minRange(const quint32 maxV
  */
 template<> PokitPro::CurrentRange DeviceCommand::minRange(const quint32 maxValue)
 {
-    if (maxValue == 0) return PokitPro::CurrentRange::AutoRange;
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CurrentRange::_500uA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CurrentRange::_2mA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CurrentRange::_10mA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CurrentRange::_125mA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CurrentRange::_300mA)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CurrentRange::_3A)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::CurrentRange::_10A)
-    return PokitPro::CurrentRange::AutoRange;
+    return RangeTable::minRange(PokitPro::currentRanges, maxValue);
 }
 
 /*!
@@ -167,19 +759,7 @@ template<> PokitPro::CurrentRange DeviceCommand::minRange(const quint32 maxValue
  */
 template<> PokitPro::ResistanceRange DeviceCommand::minRange(const quint32 maxValue)
 {
-    if (maxValue == 0) return PokitPro::ResistanceRange::AutoRange;
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_30)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_75)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_400)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_5K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_10K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_15K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_40K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_500K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_700K)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_1M)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::ResistanceRange::_3M)
-    return PokitPro::ResistanceRange::AutoRange;
+    return RangeTable::minRange(PokitPro::resistanceRanges, maxValue);
 }
 
 /*!
@@ -188,16 +768,7 @@ template<> PokitPro::ResistanceRange DeviceCommand::minRange(const quint32 maxVa
  */
 template<> PokitPro::VoltageRange DeviceCommand::minRange(const quint32 maxValue)
 {
-    if (maxValue == 0) return PokitPro::VoltageRange::AutoRange;
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::VoltageRange::_250mV)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::VoltageRange::_2V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::VoltageRange::_10V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::VoltageRange::_30V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::VoltageRange::_60V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::VoltageRange::_125V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::VoltageRange::_400V)
-    DOKIT_CLI_IF_LESS_THAN_RETURN(maxValue, PokitPro, PokitPro::VoltageRange::_600V)
-    return PokitPro::VoltageRange::AutoRange;
+    return RangeTable::minRange(PokitPro::voltageRanges, maxValue);
 }
 
 /// \endcond
@@ -281,17 +852,773 @@ quint8 DeviceCommand::minVoltageRange(const PokitProduct product, const quint32
     return 255;
 }
 
-#undef DOKIT_CLI_IF_LESS_THAN_RETURN
+/*!
+ * Parses \a specs (as per the `filter` option) into \a filter's FIR taps and biquad sections, with the sections
+ * cascaded in the order given. Returns a list of errors, if any, in which case \a filter is left unchanged.
+ *
+ * Each spec is one of `lowpass:<frequency>[:<q>]`, `highpass:<frequency>[:<q>]`, `notch:<frequency>[:<q>]`,
+ * `biquad:<b0>,<b1>,<b2>,<a1>,<a2>` or `fir:<h0>[,<h1>...]`, where frequencies are in Hz (such as `50`, or `1.5kHz`).
+ * At most one FIR spec may be given, since consecutive FIR filters could have been convolved into one anyway.
+ */
+QStringList DeviceCommand::parseFilters(const QStringList &specs, SampleFilter * const filter)
+{
+    Q_ASSERT(filter);
+    QStringList errors;
+    QVector<SampleFilter::Biquad> sections;
+    QVector<float> taps;
+    for (const QString &spec: specs) {
+        const QStringList parts = spec.split(u':');
+        const QString type = parts.first().trimmed().toLower();
+        if ((type == u"lowpass"_s) || (type == u"highpass"_s) || (type == u"notch"_s)) {
+            const QString value = (parts.size() < 2) ? QString() : parts.at(1).trimmed();
+            const quint32 frequency = (value.isEmpty()) ? 0 : parseNumber<std::milli>(
+                (value.endsWith(u"Hz"_s, Qt::CaseInsensitive)) ? value : value + u"Hz"_s, u"Hz"_s); // Hz by default.
+            bool ok = true;
+            const double q = (parts.size() < 3) ? 0.0 : QLocale().toDouble(parts.at(2).trimmed(), &ok);
+            if ((frequency == 0) || (parts.size() > 3) || (!ok) || ((parts.size() == 3) && (!(q > 0.0)))) {
+                errors.append(tr("Invalid filter: %1").arg(spec));
+                continue;
+            }
+            SampleFilter::Biquad section = (type == u"lowpass"_s) ? SampleFilter::lowPass(frequency / 1000.0)
+                : (type == u"highpass"_s) ? SampleFilter::highPass(frequency / 1000.0)
+                : SampleFilter::notch(frequency / 1000.0);
+            if (parts.size() == 3) {
+                section.q = q;
+            }
+            sections.append(section);
+        } else if ((type == u"biquad"_s) || (type == u"fir"_s)) {
+            QVector<double> coefficients;
+            bool ok = (parts.size() == 2);
+            for (const QString &value: (ok) ? parts.at(1).split(u',') : QStringList()) {
+                coefficients.append(QLocale().toDouble(value.trimmed(), &ok));
+                if ((!ok) || (!std::isfinite(coefficients.last()))) {
+                    ok = false;
+                    break;
+                }
+            }
+            if ((!ok) || ((type == u"biquad"_s) && (coefficients.size() != 5))) {
+                errors.append(tr("Invalid filter: %1").arg(spec));
+            } else if (type == u"biquad"_s) {
+                sections.append(SampleFilter::custom(coefficients.at(0), coefficients.at(1), coefficients.at(2),
+                                                     coefficients.at(3), coefficients.at(4)));
+            } else if (!taps.isEmpty()) {
+                errors.append(tr("Only one FIR filter may be provided: %1").arg(spec));
+            } else {
+                std::transform(coefficients.constBegin(), coefficients.constEnd(), std::back_inserter(taps),
+                               [](const double tap) { return (float)tap; });
+            }
+        } else {
+            errors.append(tr("Unknown filter type: %1").arg(spec));
+        }
+    }
+    if (errors.isEmpty()) {
+        filter->setFirTaps(taps);
+        filter->setBiquads(sections);
+    }
+    return errors;
+}
+
+/*!
+ * Parses \a spec (as per the `event` option) into \a settings. Returns \c true if \a spec was parsed, and the
+ * resulting \a settings are valid (see EventDetector::isValid), otherwise \c false.
+ *
+ * The \a spec is `<type>:<threshold>[:<hysteresis>[:<min-duration>]]`, where `<type>` is `above` or `below` (for
+ * thresholds on the values themselves), or `rate-above` or `rate-below` (for thresholds on the values' rate of change,
+ * per second), and `<min-duration>` is a period, such as `500ms` or `2s`.
+ */
+bool DeviceCommand::parseEvent(const QString &spec, EventDetector::Settings &settings)
+{
+    const QStringList parts = spec.split(u':');
+    if ((parts.size() < 2) || (parts.size() > 4)) {
+        return false;
+    }
+
+    if (const QString type = parts.at(0).trimmed().toLower(); type == u"above"_s) {
+        settings.quantity = EventDetector::Quantity::Value;
+        settings.direction = EventDetector::Direction::Above;
+    } else if (type == u"below"_s) {
+        settings.quantity = EventDetector::Quantity::Value;
+        settings.direction = EventDetector::Direction::Below;
+    } else if (type == u"rate-above"_s) {
+        settings.quantity = EventDetector::Quantity::RateOfChange;
+        settings.direction = EventDetector::Direction::Above;
+    } else if (type == u"rate-below"_s) {
+        settings.quantity = EventDetector::Quantity::RateOfChange;
+        settings.direction = EventDetector::Direction::Below;
+    } else {
+        return false;
+    }
 
+    bool ok = false;
+    settings.threshold = (float)QLocale().toDouble(parts.at(1).trimmed(), &ok);
+    settings.hysteresis = 0.0f;
+    if ((ok) && (parts.size() > 2) && (!parts.at(2).trimmed().isEmpty())) {
+        settings.hysteresis = (float)QLocale().toDouble(parts.at(2).trimmed(), &ok);
+    }
+    settings.minDuration = 0;
+    if ((ok) && (parts.size() > 3) && (parts.at(3).trimmed() != u"0"_s)) {
+        settings.minDuration = parseNumber<std::milli>(parts.at(3), u"s"_s, 500);
+        ok = (settings.minDuration > 0);
+    }
+    return (ok) && (EventDetector::isValid(settings));
+}
+
+/*!
+ * Parses \a spec (as per the `device-thread` and `sink-threads` options) into \a settings. Returns \c true if \a spec
+ * was parsed, otherwise \c false.
+ *
+ * The \a spec is `[<cpus>][:<priority>[:<level>]]`, where `<cpus>` is a list of CPUs (see ThreadPolicy::parseCpus),
+ * such as `2-3`, `<priority>` is `normal`, `high` or `realtime`, and `<level>` is the real-time priority, from 1 to 99,
+ * for `realtime` only. Either the CPUs, or the priority, may be omitted (but not both), such as `2`, or `realtime`.
+ */
+bool DeviceCommand::parseThreadPolicy(const QString &spec, ThreadPolicy::Settings &settings)
+{
+    QStringList parts = spec.split(u':');
+    settings = ThreadPolicy::Settings{};
+    if (const QString cpus = parts.constFirst().trimmed().toLower();
+        (cpus != u"normal"_s) && (cpus != u"high"_s) && (cpus != u"realtime"_s)) {
+        bool ok = true;
+        if (!cpus.isEmpty()) {
+            settings.cpus = ThreadPolicy::parseCpus(cpus, &ok);
+        }
+        if (!ok) {
+            return false;
+        }
+        parts.removeFirst();
+        if (parts.isEmpty()) {
+            return !settings.cpus.isEmpty();
+        }
+    }
+
+    if (const QString priority = parts.takeFirst().trimmed().toLower(); priority == u"normal"_s) {
+        settings.priority = ThreadPolicy::Priority::Normal;
+    } else if (priority == u"high"_s) {
+        settings.priority = ThreadPolicy::Priority::High;
+    } else if (priority == u"realtime"_s) {
+        settings.priority = ThreadPolicy::Priority::Realtime;
+    } else {
+        return false;
+    }
+
+    if (parts.isEmpty()) {
+        return true;
+    }
+    bool ok = false;
+    settings.realtimePriority = parts.constFirst().trimmed().toInt(&ok);
+    return (ok) && (parts.size() == 1) && (settings.priority == ThreadPolicy::Priority::Realtime) &&
+           (settings.realtimePriority >= 1) && (settings.realtimePriority <= 99);
+}
+
+/*!
+ * Parses \a specs (as per the `event` option), appending one event detector per spec to #eventDetectors, such that
+ * each detector's finished events are output via outputEvent(), and started events are logged. Returns a list of
+ * errors, if any, including if the current output format cannot represent event records.
+ */
+QStringList DeviceCommand::addEventDetectors(const QStringList &specs)
+{
+    QStringList errors;
+    for (const QString &spec: specs) {
+        EventDetector::Settings settings = EventDetector::defaultSettings();
+        if (!parseEvent(spec, settings)) {
+            errors.append(tr("Invalid event: %1").arg(spec));
+            continue;
+        }
+        auto * const detector = new EventDetector(this);
+        detector->setObjectName(spec.trimmed());
+        detector->setSettings(settings);
+        connect(detector, &EventDetector::eventStarted, this, [this, detector](const EventDetector::Event &event) {
+            qCInfo(lc).noquote() << tr("Event %1 started at %2.").arg(detector->objectName(),
+                QDateTime::fromMSecsSinceEpoch(event.start, DOKIT_QT_UTC).toString(Qt::ISODateWithMs));
+        });
+        connect(detector, &EventDetector::eventFinished, this, [this, detector](const EventDetector::Event &event) {
+            outputEvent(detector->objectName(), event);
+        });
+        eventDetectors.append(detector);
+    }
+    if (format == OutputFormat::Binary) {
+        errors.append(tr("Binary output is only supported for raw values, not --event"));
+    }
+    if (format == OutputFormat::Arrow) {
+        errors.append(tr("Arrow output is only supported for raw values, not --event"));
+    }
+    if (format == OutputFormat::LineProtocol) {
+        errors.append(tr("Line protocol output is only supported for raw values, not --event"));
+    }
+    return errors;
+}
+
+/*!
+ * Adds \a value, taken at \a timestamp (in milliseconds since the epoch), to each of the #eventDetectors.
+ */
+void DeviceCommand::addEventValue(const float value, const qint64 timestamp)
+{
+    for (EventDetector * const detector: std::as_const(eventDetectors)) {
+        detector->addValue(value, timestamp);
+    }
+}
+
+/*!
+ * Flushes each of the #eventDetectors, such that any events still in progress are output.
+ */
+void DeviceCommand::flushEvents()
+{
+    for (EventDetector * const detector: std::as_const(eventDetectors)) {
+        detector->flush();
+    }
+}
+
+/*!
+ * Outputs \a event, as detected by the \a condition (ie `event` option spec), in the selected output format.
+ */
+void DeviceCommand::outputEvent(const QString &condition, const EventDetector::Event &event)
+{
+    const QString start = QDateTime::fromMSecsSinceEpoch(event.start, DOKIT_QT_UTC).toString(Qt::ISODateWithMs);
+    const QString end = QDateTime::fromMSecsSinceEpoch(event.end, DOKIT_QT_UTC).toString(Qt::ISODateWithMs);
+    const qint64 duration = event.end - event.start;
+
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showEventCsvHeader; showEventCsvHeader = false) {
+            output(tr("condition,start,end,duration,peak,count,unit\n"));
+        }
+        output(QString::fromLatin1("%1,%2,%3,%4,%5,%6,%7\n").arg(escapeCsvField(condition), start, end)
+            .arg(duration).arg(event.peak).arg(event.count).arg(eventUnit));
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope: {
+        QJsonObject object{
+            { u"condition"_s, condition },
+            { u"start"_s,     start },
+            { u"end"_s,       end },
+            { u"duration"_s,  duration },
+            { u"peak"_s,      qIsInf(event.peak) ? QJsonValue(tr("Infinity")) : QJsonValue(event.peak) },
+            { u"count"_s,     (qint64)event.count },
+        };
+        if (!eventUnit.isNull()) {
+            object.insert(u"unit"_s, eventUnit);
+        }
+        output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+            : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:  // Not supported (rejected by addEventDetectors).
+    case OutputFormat::LineProtocol: // Not supported (rejected by addEventDetectors).
+    case OutputFormat::Binary: // Not supported (rejected by addEventDetectors).
+        break;
+    case OutputFormat::Text:
+        output(tr("%1: %2 to %3 (%4ms), peaking at %5 %6, over %Ln value/s\n", nullptr, (int)event.count)
+            .arg(condition, start, end).arg(duration).arg(event.peak).arg(eventUnit));
+        break;
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Parses \a config (as per the `pipeline` option) into the stages of a new #pipeline, with each of its sinks writing
+ * to its own output file, alongside the command's own output. If \a config begins with `@`, then the pipeline is read
+ * from the file named by the rest of \a config instead. Returns a list of errors, if any.
+ *
+ * A pipeline is a list of stages, separated by semicolons and/or newlines, each of the form
+ * `<name> = <type>[:<args>] [<- <input>[,<input>...]]`, where each input is the name of an earlier stage, or `source`
+ * (the command's own values), which is also the default. Anything following a `#` on a line is ignored, as a comment.
+ * The supported types are:
+ *
+ * - `filter:<spec>`, where `<spec>` is as per the `filter` option (see parseFilters());
+ * - `aggregate:<period>`, for the mean of each window of `<period>`, such as `1s`;
+ * - `detect:<spec>`, for only the values within events, where `<spec>` is as per the `event` option (see
+ *   parseEvent()), with each event also logged, once it ends;
+ * - `resample:<period>[:<method>]`, where `<method>` is `linear` (the default), `hold` or `decimate`;
+ * - `expression:<formula>`, for the results of `<formula>` (see SampleExpression), in which each input is a variable
+ *   named for its stage, such as `expression:(source - lp) * 1000 <- source,lp`, with the values of multiple inputs
+ *   paired up in order (so `<-` must not appear within `<formula>` itself, such as in `a<-1`, but may as `a < -1`); and
+ * - `sink:<format>:<file>`, where `<format>` is `csv` or `ndjson`.
+ *
+ * Since the stages share each block of values (see SampleGraph), any number of stages, and sinks, may process the
+ * same values, without the values being copied, or the command run more than once.
+ */
+QStringList DeviceCommand::addPipeline(const QString &config)
+{
+    QString text = config;
+    if (config.startsWith(u'@')) {
+        QFile file(config.mid(1));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            return { tr("Failed to read pipeline file %1: %2").arg(file.fileName(), file.errorString()) };
+        }
+        text = QString::fromUtf8(file.readAll());
+    }
+
+    delete pipeline;
+    for (const PipelineSink &sink: std::as_const(pipelineSinks)) {
+        delete sink.writer;
+    }
+    pipelineSinks.clear();
+    pipeline = new SampleGraph(this);
+    connect(pipeline, &SampleGraph::blockReady, this, &DeviceCommand::outputPipelineBlock);
+    connect(pipeline, &SampleGraph::eventFinished, this,
+            [](const QString &detector, const EventDetector::Event &event) {
+        qCInfo(lc).noquote() << tr("Pipeline stage %1 detected an event from %2 to %3, peaking at %4.").arg(detector,
+            QDateTime::fromMSecsSinceEpoch(event.start, DOKIT_QT_UTC).toString(Qt::ISODateWithMs),
+            QDateTime::fromMSecsSinceEpoch(event.end, DOKIT_QT_UTC).toString(Qt::ISODateWithMs)).arg(event.peak);
+    });
+    // Commands may exit without being destroyed, so flush the pipeline's stages, and sinks, on quit.
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &DeviceCommand::flushPipeline,
+            Qt::UniqueConnection);
+
+    QStringList errors;
+    for (const QString &line: text.split(u'\n')) {
+        for (const QString &statement: line.section(u'#', 0, 0).split(u';')) {
+            if (!statement.trimmed().isEmpty()) {
+                errors.append(addPipelineStage(statement.trimmed()));
+            }
+        }
+    }
+    if ((errors.isEmpty()) && (pipelineSinks.isEmpty())) {
+        errors.append(tr("Pipeline has no sinks: %1").arg(config));
+    }
+    return errors;
+}
+
+/*!
+ * Parses a single pipeline \a statement (see addPipeline()), adding its stage to the #pipeline, and for sinks, opening
+ * its output file. Returns a list of errors, if any.
+ */
+QStringList DeviceCommand::addPipelineStage(const QString &statement)
+{
+    Q_ASSERT(pipeline);
+    const qsizetype equals = statement.indexOf(u'=');
+    const QString name = statement.left(equals).trimmed();
+    const QString rest = statement.mid(equals + 1);
+    const qsizetype arrow = rest.indexOf(u"<-"_s);
+    const QString spec = ((arrow < 0) ? rest : rest.left(arrow)).trimmed();
+    QStringList inputs;
+    for (const QString &input: (arrow < 0) ? QStringList() : rest.mid(arrow + 2).split(u',')) {
+        if (!input.trimmed().isEmpty()) {
+            inputs.append(input.trimmed());
+        }
+    }
+    if ((equals <= 0) || (name.isEmpty()) || ((arrow >= 0) && (inputs.isEmpty()))) {
+        return { tr("Invalid pipeline stage: %1").arg(statement) };
+    }
+
+    const QString type = spec.section(u':', 0, 0).trimmed().toLower();
+    const QString args = spec.section(u':', 1).trimmed();
+    bool added = false;
+    if (type == u"filter"_s) {
+        SampleFilter filter;
+        if (const QStringList errors = parseFilters({ args }, &filter); !errors.isEmpty()) {
+            return errors;
+        }
+        added = pipeline->addFilter(name, inputs, filter.biquads(), filter.firTaps());
+    } else if (type == u"aggregate"_s) {
+        const quint32 period = parseNumber<std::milli>(args, u"s"_s, 500);
+        added = (period > 0) && (pipeline->addAggregator(name, inputs, period));
+    } else if (type == u"detect"_s) {
+        EventDetector::Settings settings = EventDetector::defaultSettings();
+        added = (parseEvent(args, settings)) && (pipeline->addDetector(name, inputs, settings));
+    } else if (type == u"resample"_s) {
+        const quint32 period = parseNumber<std::milli>(args.section(u':', 0, 0), u"s"_s, 500);
+        const QString method = args.section(u':', 1).trimmed().toLower();
+        if ((method.isEmpty()) || (method == u"linear"_s)) {
+            added = (period > 0) && (pipeline->addResampler(name, inputs, period, Resampler::Method::Linear));
+        } else if (method == u"hold"_s) {
+            added = (period > 0) && (pipeline->addResampler(name, inputs, period, Resampler::Method::Hold));
+        } else if (method == u"decimate"_s) {
+            added = (period > 0) && (pipeline->addResampler(name, inputs, period, Resampler::Method::Decimate));
+        }
+    } else if (type == u"expression"_s) {
+        const SampleExpression expression(args, (inputs.isEmpty()) ? QStringList{ SampleGraph::sourceName() } : inputs);
+        if (!expression.isValid()) {
+            return { expression.errorString() };
+        }
+        added = pipeline->addExpression(name, inputs, args);
+    } else if (type == u"sink"_s) {
+        const QString sinkFormat = args.section(u':', 0, 0).trimmed().toLower();
+        const QString fileName = args.section(u':', 1).trimmed(); // May itself contain colons, such as C:\...
+        if (((sinkFormat != u"csv"_s) && (sinkFormat != u"ndjson"_s)) || (fileName.isEmpty()) ||
+            (!pipeline->addSink(name, inputs))) {
+            return { tr("Invalid pipeline stage: %1").arg(statement) };
+        }
+        auto * const writer = new OutputFileWriter(this);
+        if (sinkThreadPolicy) {
+            writer->setThreadPolicy(*sinkThreadPolicy);
+        }
+        if (!writer->open(fileName)) {
+            const QString error = tr("Failed to open pipeline sink %1: %2").arg(fileName, writer->errorString());
+            delete writer;
+            return { error };
+        }
+        pipelineSinks.insert(name, { writer, (sinkFormat == u"csv"_s) ? OutputFormat::Csv : OutputFormat::Ndjson });
+        return { };
+    } else {
+        return { tr("Unknown pipeline stage type: %1").arg(statement) };
+    }
+    return (added) ? QStringList{ } : QStringList{ tr("Invalid pipeline stage: %1").arg(statement) };
+}
+
+/*!
+ * Writes \a block, as received by the #pipeline's \a sink, to that sink's output file.
+ *
+ * CSV files have one `timestamp,value` line per value, with timestamps in (fractional) milliseconds since the epoch.
+ * NDJSON files have one `{"timestamp":...,"interval":...,"values":[...]}` object per block, with the timestamp of the
+ * block's first value, and the interval between its values, both in milliseconds.
+ */
+void DeviceCommand::outputPipelineBlock(const QString &sink, const SampleGraph::Block &block)
+{
+    const auto iter = pipelineSinks.find(sink);
+    if (iter == pipelineSinks.end()) {
+        return;
+    }
+    QByteArray bytes;
+    bytes.reserve(block.values.size() * 24 + 64);
+    if (iter->format == OutputFormat::Csv) {
+        for (; iter->showCsvHeader; iter->showCsvHeader = false) {
+            bytes.append("timestamp,value\n");
+        }
+        for (qsizetype index = 0; index < block.values.size(); ++index) {
+            bytes.append(QByteArray::number((double)block.timestamp + (double)index * block.interval, 'f', 3));
+            bytes.append(',');
+            bytes.append(QByteArray::number(block.values.at(index)));
+            bytes.append('\n');
+        }
+    } else {
+        bytes.append("{\"timestamp\":" + QByteArray::number(block.timestamp) +
+                     ",\"interval\":" + QByteArray::number(block.interval) + ",\"values\":[");
+        for (qsizetype index = 0; index < block.values.size(); ++index) {
+            if (index > 0) {
+                bytes.append(',');
+            }
+            const float value = block.values.at(index);
+            bytes.append((qIsFinite(value)) ? QByteArray::number(value) : QByteArray("null"));
+        }
+        bytes.append("]}\n");
+    }
+    iter->writer->write(bytes);
+}
+
+/*!
+ * Flushes the #pipeline's stages (such that open aggregate windows, pending resampled values, and events still in
+ * progress are output), then closes each of its sinks' output files, blocking until all queued output is written.
+ */
+void DeviceCommand::flushPipeline()
+{
+    if (pipeline) {
+        pipeline->flush();
+    }
+    for (const PipelineSink &sink: std::as_const(pipelineSinks)) {
+        sink.writer->close();
+    }
+}
+
+
+/*!
+ * Creates #chargeIntegrator, to emit running totals every \a period (as per the `charge` option), bridging gaps as per
+ * \a gap (as per the `charge-gap` option, or a null string for the defaults), such that the totals are output via
+ * outputCharge(). Returns a list of errors, if any, including if the current output format cannot represent charge
+ * records.
+ *
+ * \a gap is `<policy>[:<duration>]`, where policy is one of `exclude`, `hold` or `interpolate`, and duration is the
+ * longest interval that is not a gap. If no duration is given, the integrator's maximum gap is left at 0, for the
+ * caller to default, once the sample interval is known.
+ */
+QStringList DeviceCommand::addChargeIntegrator(const QString &period, const QString &gap)
+{
+    QStringList errors;
+    const quint32 periodMsecs = parseNumber<std::milli>(period, u"s"_s, 500);
+    if (periodMsecs == 0) {
+        errors.append(tr("Invalid charge value: %1").arg(period));
+    }
+    chargeIntegrator = new ChargeIntegrator(this);
+    chargeIntegrator->setPeriod(periodMsecs);
+    connect(chargeIntegrator, &ChargeIntegrator::totalReady, this, &DeviceCommand::outputCharge);
+
+    if (!gap.isNull()) {
+        const QStringList parts = gap.split(u':');
+        const QString policy = parts.constFirst().trimmed().toLower();
+        if (policy == u"exclude"_s) {
+            chargeIntegrator->setGapPolicy(ChargeIntegrator::GapPolicy::Exclude);
+        } else if (policy == u"hold"_s) {
+            chargeIntegrator->setGapPolicy(ChargeIntegrator::GapPolicy::Hold);
+        } else if (policy == u"interpolate"_s) {
+            chargeIntegrator->setGapPolicy(ChargeIntegrator::GapPolicy::Interpolate);
+        } else {
+            errors.append(tr("Invalid charge-gap value: %1").arg(gap));
+        }
+        if (parts.size() > 2) {
+            errors.append(tr("Invalid charge-gap value: %1").arg(gap));
+        } else if (parts.size() == 2) {
+            const quint32 maximumGap = parseNumber<std::milli>(parts.at(1), u"s"_s, 500);
+            if (maximumGap == 0) {
+                errors.append(tr("Invalid charge-gap duration: %1").arg(parts.at(1)));
+            }
+            chargeIntegrator->setMaximumGap(maximumGap);
+        }
+    }
+
+    if (format == OutputFormat::Binary) {
+        errors.append(tr("Binary output is only supported for raw values, not --charge"));
+    }
+    if (format == OutputFormat::Arrow) {
+        errors.append(tr("Arrow output is only supported for raw values, not --charge"));
+    }
+    if (format == OutputFormat::LineProtocol) {
+        errors.append(tr("Line protocol output is only supported for raw values, not --charge"));
+    }
+    return errors;
+}
+
+/*!
+ * Outputs the running charge \a total in the selected output format, with the charge in milliamp-hours, and the
+ * average current in milliamps.
+ */
+void DeviceCommand::outputCharge(const ChargeIntegrator::Total &total)
+{
+    const QString start = QDateTime::fromMSecsSinceEpoch(total.start, DOKIT_QT_UTC).toString(Qt::ISODateWithMs);
+    const QString end = QDateTime::fromMSecsSinceEpoch(total.end, DOKIT_QT_UTC).toString(Qt::ISODateWithMs);
+    const double milliampHours = total.charge * 1000.0, milliamps = total.averageCurrent * 1000.0;
+
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showChargeCsvHeader; showChargeCsvHeader = false) {
+            output(tr("start,end,count,charge,average_current,duration,gaps,gap_duration\n"));
+        }
+        output(QString::fromLatin1("%1,%2,%3,%4,%5,%6,%7,%8\n").arg(start, end).arg(total.count)
+            .arg(milliampHours, 0, 'f').arg(milliamps, 0, 'f').arg(total.duration).arg(total.gaps)
+            .arg(total.gapDuration));
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope: {
+        const QJsonObject object{
+            { u"start"_s,          start },
+            { u"end"_s,            end },
+            { u"count"_s,          (qint64)total.count },
+            { u"charge"_s,         milliampHours },
+            { u"averageCurrent"_s, milliamps },
+            { u"duration"_s,       total.duration },
+            { u"gaps"_s,           (qint64)total.gaps },
+            { u"gapDuration"_s,    total.gapDuration },
+        };
+        output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+            : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:  // Not supported (rejected by addChargeIntegrator).
+    case OutputFormat::LineProtocol: // Not supported (rejected by addChargeIntegrator).
+    case OutputFormat::Binary: // Not supported (rejected by addChargeIntegrator).
+        break;
+    case OutputFormat::Text:
+        output(tr("%1 to %2: %3 mAh, averaging %4 mA over %5ms, with %Ln gap/s (%6ms)\n", nullptr,
+                  (int)total.gaps).arg(start, end).arg(milliampHours, 0, 'f').arg(milliamps, 0, 'f')
+            .arg(total.duration).arg(total.gapDuration));
+        break;
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Opens the SQLite database \a fileName (creating it, if necessary), to store the command's values in, alongside
+ * its own output. Returns any errors, such as being unable to open the database.
+ */
+QStringList DeviceCommand::addSqliteSink(const QString &fileName)
+{
+    delete sqlite;
+    sqlite = new SqliteSink(this);
+    if (!sqlite->open(fileName)) {
+        return { tr("Failed to open SQLite database %1: %2").arg(fileName, sqlite->errorString()) };
+    }
+    return { };
+}
+
+/*!
+ * Sets the SQLite session that subsequent values are stored in, to the current device's \a command session, with
+ * \a mode, \a unit, \a range and \a interval, \a started at (in milliseconds since the epoch). See
+ * SqliteSink::setSession().
+ */
+bool DeviceCommand::setSqliteSession(const QString &command, const QString &mode, const QString &unit,
+                                     const QString &range, const quint32 interval, const qint64 started)
+{
+    Q_ASSERT(sqlite);
+    return sqlite->setSession({ deviceName(), command, mode, unit, range, interval, started });
+}
+
+/*!
+ * Configures an InfluxDB writer, to write the command's values to the server at \a url, alongside its own output.
+ * Returns any errors, such as an invalid \a url. See InfluxWriter::setUrl().
+ */
+QStringList DeviceCommand::addInfluxWriter(const QString &url)
+{
+    delete influx;
+    influx = new InfluxWriter(this);
+    if (!influx->setUrl(QUrl(url))) {
+        return { tr("Invalid InfluxDB URL %1: %2").arg(url, influx->errorString()) };
+    }
+    return { };
+}
+
+/*!
+ * Sets the stall factor for the command's StallWatchdog (see startWatchdog()) to \a factor, which must be a number no
+ * less than 1. Returns any errors, such as an invalid \a factor.
+ */
+QStringList DeviceCommand::setWatchdogFactor(const QString &factor)
+{
+    bool ok;
+    const float value = factor.toFloat(&ok);
+    if ((!ok) || (!std::isfinite(value)) || (value < 1.0f)) {
+        return { tr("Invalid watchdog value: %1").arg(factor) };
+    }
+    watchdogFactor = value;
+    return { };
+}
+
+/*!
+ * Starts watching \a service's values for stalls, expected every \a expectedInterval milliseconds (or 0 to learn the
+ * interval instead), if the watchdog option was set. Does nothing if the option was not set, or if the service is
+ * already being watched, such as when settings are re-written to recover from a stall.
+ *
+ * If the watchdog fails to recover from a stall, finishes with `EXIT_FAILURE`, rather than wait indefinitely.
+ */
+void DeviceCommand::startWatchdog(AbstractPokitService * const service, const quint32 expectedInterval)
+{
+    if (watchdogFactor <= 0.0f) {
+        return;
+    }
+    if (!watchdog) {
+        watchdog = new StallWatchdog(service, device, this);
+        connect(watchdog, &StallWatchdog::recoveryFailed, this, [this]() {
+            qCWarning(lc).noquote() << tr("Failed to recover from stalled notifications.");
+            finish(EXIT_FAILURE);
+        });
+    }
+    watchdog->setStallFactor(watchdogFactor);
+    watchdog->setExpectedInterval(expectedInterval);
+    if (!watchdog->isActive()) {
+        watchdog->start();
+    }
+}
+
+/*!
+ * Returns the current device's name, or if it has none, its address. Returns a null string if there is no current
+ * device (yet).
+ */
+QString DeviceCommand::deviceName() const
+{
+    if (!device) {
+        return QString();
+    }
+    const QLowEnergyController * const controller = device->controller();
+    return (controller->remoteName().isEmpty()) ? controller->remoteAddress().toString() : controller->remoteName();
+}
+
+/*!
+ * Returns the line protocol \a measurement, tags and field key, to be output before the value of each point within
+ * \a context. The tags are the current device's name, and \a context's mode, range, status and unit, in that
+ * (lexical) order, as InfluxDB prefers, with any empty tags omitted, since line protocol does not allow them.
+ *
+ * \see MeasurementFormatter::appendLineProtocol
+ */
+QByteArray DeviceCommand::lineProtocolPrefix(const QByteArray &measurement,
+                                             const MeasurementFormatter::Context &context) const
+{
+    const std::pair<const char *, QString> tags[] {
+        { "device", deviceName() }, { "mode", context.mode }, { "range", context.range },
+        { "status", context.status }, { "unit", context.unit },
+    };
+    QByteArray prefix = measurement;
+    for (const auto &[key, value]: tags) {
+        if (!value.isEmpty()) {
+            prefix.append(',').append(key).append('=').append(escapeLineProtocolTag(value));
+        }
+    }
+    return prefix.append(" value=");
+}
+
+/*!
+ * Enables raw count output (see the `raw` option), for the current output format. Returns any errors, such as
+ * \a conflicts (the names of any set options that output something other than samples, or that modify the samples'
+ * values), or an output format without raw counts.
+ */
+QStringList DeviceCommand::setRawCounts(const QStringList &conflicts)
+{
+    QStringList errors;
+    if (!conflicts.isEmpty()) {
+        errors.append(tr("Raw counts are only supported for unmodified sample output, not --%1")
+            .arg(conflicts.join(u", --"_s)));
+    }
+    if ((format != OutputFormat::Csv) && (format != OutputFormat::Ndjson) &&
+        (format != OutputFormat::NdjsonEnvelope) && (format != OutputFormat::Text)) {
+        errors.append(tr("Raw counts are only supported for CSV, NDJSON, NDJSON-Envelope and text output"));
+    }
+    rawCounts = errors.isEmpty();
+    return errors;
+}
+
+/*!
+ * Returns \a scale formatted for output alongside raw counts, as the shortest representation that reads back as exactly
+ * the same \c float, so that applying the scale to the counts is lossless.
+ */
+QByteArray DeviceCommand::formatScale(const float scale)
+{
+    QByteArray buffer;
+    appendNumber(buffer, scale, 'g', QLocale::FloatingPointShortest);
+    return buffer;
+}
+
+/*!
+ * Outputs a declaration of the \a scale, and \a context's mode, unit and range, that all subsequent raw counts are
+ * to be interpreted with, unless that is what the most recent declaration already said. So consumers need only
+ * multiply each count by the most recently declared scale (which they can do in bulk), while the per-sample output
+ * is just the count itself (and its sample number, or timestamp).
+ *
+ * NDJSON-Envelope output declares the scale within each envelope instead, so this function outputs nothing for that
+ * format.
+ */
+void DeviceCommand::declareRawCounts(const MeasurementFormatter::Context &context, const float scale)
+{
+    QByteArray declaration;
+    switch (format) {
+    case OutputFormat::Csv:
+        declaration = "# mode=" + context.mode.toUtf8() + ",unit=" + context.unit.toUtf8() + ",range=" +
+            context.range.toUtf8() + ",scale=" + formatScale(scale) + '\n';
+        break;
+    case OutputFormat::Ndjson:
+        declaration = "{\"mode\":" + escapeJsonString(context.mode) + ",\"unit\":" + escapeJsonString(context.unit) +
+            ",\"range\":" + escapeJsonString(context.range) + ",\"scale\":" + formatScale(scale) + "}\n";
+        break;
+    case OutputFormat::Text:
+        declaration = tr("Raw counts of %1, range %2, at %3 %4 per count\n").arg(context.mode,
+            (context.range.isEmpty()) ? tr("N/A") : context.range, QString::fromLatin1(formatScale(scale)),
+            context.unit).toUtf8();
+        break;
+    default:
+        return;
+    }
+    if (declaration != rawCountsDeclaration) {
+        output(declaration);
+        rawCountsDeclaration = declaration;
+    }
+}
 
 /*!
  * Handles controller error events. This base implementation simply logs \a error and then exits
  * with `EXIT_FAILURE`. Derived classes may override this slot to implement their own error
  * handing if desired.
+ *
+ * However, errors from failed reconnection attempts (see the `reconnect` option) are only logged, since the device
+ * will try again, or give up, itself. And if a known device (see the `known-devices` option) could not be connected
+ * to directly, then this function begins scanning for the device instead.
  */
 void DeviceCommand::controllerError(QLowEnergyController::Error error)
 {
+    if (connectingDirectly) {
+        qCInfo(lc).noquote() << tr("Failed to connect to known device; scanning for it instead.") << error;
+        if (!discoveryAgent->isActive()) {
+            discoveryAgent->start();
+        }
+        return;
+    }
     qCWarning(lc).noquote() << tr("Bluetooth controller error:") << error;
+    if ((device) && (device->isReconnecting())) {
+        return;
+    }
     QCoreApplication::exit(EXIT_FAILURE);
 }
 
@@ -301,17 +1628,29 @@ void DeviceCommand::controllerError(QLowEnergyController::Error error)
  * initialise to `EXIT_FAILURE` in the constructor, but should be set to `EXIT_SUCESS` if/when
  * the derived command class has completed its actions and requested the disconnection (as opposed
  * to a spontaneous disconnection on error).
+ *
+ * However, if the device is reconnecting (see the `reconnect` option), then this function only logs the
+ * disconnection, and exits later only if all reconnection attempts fail. Likewise, if a known device could not be
+ * connected to directly (see the `known-devices` option), then the disconnection is ignored, while scanning for the
+ * device instead.
  */
 void DeviceCommand::deviceDisconnected()
 {
+    if (connectingDirectly) {
+        return; // Never connected, so controllerError() falls back to scanning instead.
+    }
+    if ((device) && (device->isReconnecting())) {
+        qCWarning(lc).noquote() << tr("Pokit device disconnected unexpectedly; reconnecting...");
+        return;
+    }
     qCDebug(lc).noquote() << tr("Pokit device disconnected. Exiting with code %1.")
         .arg(exitCodeOnDisconnect);
     QCoreApplication::exit(exitCodeOnDisconnect);
 }
 
 /*!
- * Handles service error events. This base implementation simply logs \a error and then exits
- * with `EXIT_FAILURE`. Derived classes may override this slot to implement their own error
+ * Handles service error events. This base implementation simply logs \a error and then finishes
+ * with `EXIT_FAILURE` (see finish()). Derived classes may override this slot to implement their own error
  * handing if desired.
  *
  * \note As this base class does not construct services (derived classed do), its up to the derived
@@ -320,42 +1659,126 @@ void DeviceCommand::deviceDisconnected()
 void DeviceCommand::serviceError(const QLowEnergyService::ServiceError error)
 {
     qCWarning(lc).noquote() << tr("Bluetooth service error:") << error;
-    QCoreApplication::exit(EXIT_FAILURE);
+    finish(EXIT_FAILURE);
 }
 
 /*!
- * Handles service detail discovery events. This base implementation simply logs the event, and
- * nothing more. Derived classes may (usually do) override this slot to provide their own processing
- * when a services details have been discovered.
+ * Handles service detail discovery events. This base implementation simply logs the event, and saves the service's
+ * layout to the discovery cache (if enabled). Derived classes may (usually do) override this slot to provide their own
+ * processing when a services details have been discovered.
  */
 void DeviceCommand::serviceDetailsDiscovered()
 {
     qCDebug(lc).noquote() << tr("Service details discovered.");
+    PhaseTimer::mark(PhaseTimer::Phase::Discovered);
+    if ((discoveryCache) && (device)) {
+        saveDiscoveryCache(getService());
+    }
+}
+
+/*!
+ * Handles service resumption events, after the device has reconnected. This base implementation simply logs the gap,
+ * from \a gapStart to \a gapEnd (in steady clock nanoseconds), in the service's values. Derived classes may override
+ * this slot to mark, or recover from, the gap, for example by fetching again.
+ *
+ * Since the service itself resumes its notifications, and settings (see AbstractPokitService::resumed), the
+ * serviceDetailsDiscovered() slot is not invoked again on resumption.
+ */
+void DeviceCommand::serviceResumed(const qint64 gapStart, const qint64 gapEnd)
+{
+    if (gapStart < 0) {
+        qCWarning(lc).noquote() << tr("Resumed after reconnecting.");
+    } else {
+        qCWarning(lc).noquote() << tr("Resumed after reconnecting; no values were received for %L1ms.")
+            .arg((gapEnd - gapStart) / 1000000);
+    }
+}
+
+/*!
+ * Saves the device's resolved \a capabilities to the discovery cache, first invalidating the current device's whole
+ * cache entry if its firmware version has changed.
+ */
+void DeviceCommand::saveCapabilities(const PokitDevice::Capabilities &capabilities)
+{
+    if ((!discoveryCache) || (discoveryCacheKey.isEmpty()) || (capabilities.firmwareVersion.isNull())) {
+        return;
+    }
+    discoveryCache->beginGroup(discoveryCacheKey);
+    if ((discoveryCache->contains(u"firmwareVersion"_s)) &&
+        (discoveryCache->value(u"firmwareVersion"_s).toString() != capabilities.firmwareVersion.toString())) {
+        qCInfo(lc).noquote() << tr("Firmware version changed; invalidating discovery cache for %1.")
+            .arg(discoveryCacheKey);
+        discoveryCache->remove(QString()); // Removes every key in the current group.
+    }
+    discoveryCache->setValue(u"firmwareVersion"_s, capabilities.firmwareVersion.toString());
+    discoveryCache->setValue(u"maximumSamplingRate"_s, capabilities.maximumSamplingRate);
+    discoveryCache->setValue(u"samplingBufferSize"_s, capabilities.samplingBufferSize);
+    discoveryCache->setValue(u"maximumVoltage"_s, capabilities.maximumVoltage);
+    discoveryCache->setValue(u"maximumCurrent"_s, capabilities.maximumCurrent);
+    discoveryCache->setValue(u"maximumResistance"_s, capabilities.maximumResistance);
+    discoveryCache->setValue(u"capabilityMask"_s, capabilities.capabilityMask);
+    if (!capabilities.macAddress.isNull()) {
+        discoveryCache->setValue(u"macAddress"_s, capabilities.macAddress.toString());
+    }
+    if (capabilities.loggerUpdateIntervalIs32bit) {
+        discoveryCache->setValue(u"loggerUpdateIntervalIs32bit"_s, *capabilities.loggerUpdateIntervalIs32bit);
+    }
+    discoveryCache->endGroup();
 }
 
 /*!
  * Checks if \a info is the device (if any) we're looking for, and if so, create a controller and
  * service, and begins connecting to the device.
+ *
+ * If a known device could not be connected to directly (see start()), and \a info is that device, then connecting is
+ * simply attempted again, now that the platform's Bluetooth stack has seen the device.
  */
 void DeviceCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
 {
     Q_ASSERT(isPokitProduct(info));
 
+    if ((device) && (connectingDirectly) && (device->controller()) &&
+        (((!info.address().isNull()) && (info.address() == device->controller()->remoteAddress())) ||
+         ((!info.deviceUuid().isNull()) && (info.deviceUuid() == device->controller()->remoteDeviceUuid())))) {
+        qCDebug(lc).noquote() << tr(R"(Found known Pokit device "%1" (%2) at (%3); connecting again.)")
+            .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+        discoveryAgent->stop();
+        device->controller()->connectToDevice();
+        return;
+    }
+
     if (device) {
         qCDebug(lc).noquote() << tr(R"(Ignoring additional Pokit device "%1" (%2) at (%3).)")
             .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
         return;
     }
 
-    if ((deviceToScanFor.isEmpty()) || (deviceToScanFor == info.name()) ||
-        ((!info.address().isNull()) && (info.address() == QBluetoothAddress(deviceToScanFor))) ||
-        ((!info.deviceUuid().isNull()) && (info.deviceUuid() == QBluetoothUuid(deviceToScanFor))))
-    {
+    if (isMatchingDevice(info, deviceToScanFor)) {
         qCDebug(lc).noquote() << tr(R"(Found Pokit device "%1" (%2) at (%3).)")
             .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
         discoveryAgent->stop();
+        PhaseTimer::mark(PhaseTimer::Phase::DeviceFound);
 
         device = new PokitDevice(info, this);
+        if (deviceThreadPolicy) {
+            // The device lives on this (the main) thread, so the settings are applied straight away.
+            device->setThreadPolicy(*deviceThreadPolicy);
+            const ThreadPolicy::State state = device->threadPolicy();
+            qCInfo(lc).noquote() << tr("Device thread running on CPUs %1, with %2 priority.")
+                .arg(ThreadPolicy::formatCpus(state.cpus), (state.priority == ThreadPolicy::Priority::Realtime)
+                    ? u"%1 (%2)"_s.arg(ThreadPolicy::toString(state.priority)).arg(state.realtimePriority)
+                    : ThreadPolicy::toString(state.priority));
+        }
+        if (connectionProfile) {
+            qCDebug(lc).noquote() << tr("Requesting %1 connection profile.")
+                .arg(PokitDevice::toString(*connectionProfile));
+            device->setConnectionProfile(*connectionProfile);
+        }
+        connect(device->controller(), &QLowEnergyController::connected, this, [this, info]() {
+            PhaseTimer::mark(PhaseTimer::Phase::Connected);
+            connectingDirectly = false;
+            saveKnownDevice(info);
+        });
         connect(device->controller(), &QLowEnergyController::disconnected,
                 this, &DeviceCommand::deviceDisconnected);
         connect(device->controller(),
@@ -368,10 +1791,35 @@ void DeviceCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
 
         AbstractPokitService * const service = getService();
         service->setPokitProduct(pokitProduct(info));
+        if (recorder) {
+            recorder->addService(service);
+        }
+        if (discoveryCache) {
+            // Prefer the device's address, but macOS only provides an (OS-assigned) UUID.
+            discoveryCacheKey = (info.address().isNull()) ? info.deviceUuid().toString(QUuid::WithoutBraces)
+                : info.address().toString();
+            restoreDiscoveryCache(service);
+            connect(device, &PokitDevice::capabilitiesChanged, this, &DeviceCommand::saveCapabilities);
+        }
 
         Q_ASSERT(service);
-        connect(service, &AbstractPokitService::serviceDetailsDiscovered,
-                this, &DeviceCommand::serviceDetailsDiscovered);
+        connect(service, &AbstractPokitService::serviceDetailsDiscovered, this, [this]() {
+            if (!std::exchange(serviceResuming, false)) {
+                serviceDetailsDiscovered();
+            }
+        });
+        if (reconnectAttempts > 0) {
+            PokitDevice::ReconnectPolicy policy;
+            policy.maximumAttempts = reconnectAttempts;
+            device->setReconnectPolicy(policy);
+            connect(device, &PokitDevice::reconnectFailed, this, []() {
+                QCoreApplication::exit(EXIT_FAILURE);
+            });
+            connect(service, &AbstractPokitService::resumed, this, [this](const qint64 gapStart, const qint64 gapEnd) {
+                serviceResuming = true; // The service is about to emit serviceDetailsDiscovered again.
+                serviceResumed(gapStart, gapEnd);
+            });
+        }
         connect(service, &AbstractPokitService::serviceErrorOccurred,
                 this, &DeviceCommand::serviceError);
 
@@ -387,11 +1835,11 @@ void DeviceCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
 }
 
 /*!
- * Checks that the requested device was discovered, and if not, reports and error and exits.
+ * Checks that the requested device was discovered (or connected to directly), and if not, reports and error and exits.
  */
 void DeviceCommand::deviceDiscoveryFinished()
 {
-    if (!device) {
+    if ((!device) || (connectingDirectly)) {
         qCWarning(lc).noquote() << ((deviceToScanFor.isNull())
             ? tr("Failed to find any Pokit device.")
             : tr(R"(Failed to find device "%1".)").arg(deviceToScanFor));
@@ -5,12 +5,27 @@
 #define DOKIT_DEVICECOMMAND_H
 
 #include "abstractcommand.h"
+#include "influxwriter.h"
+#include "outputfilewriter.h"
+#include "sqlitesink.h"
+#include <qtpokit/chargeintegrator.h>
+#include <qtpokit/eventdetector.h>
+#include <qtpokit/memorybudget.h>
+#include <qtpokit/pokitdevice.h>
 #include <qtpokit/pokitproducts.h>
+#include <qtpokit/samplegraph.h>
+#include <qtpokit/threadpolicy.h>
 
 #include <QLowEnergyController>
+#include <QMap>
+#include <QSettings>
+
+#include <optional>
 
 QTPOKIT_FORWARD_DECLARE_CLASS(AbstractPokitService)
-QTPOKIT_FORWARD_DECLARE_CLASS(PokitDevice)
+QTPOKIT_FORWARD_DECLARE_CLASS(SampleFilter)
+QTPOKIT_FORWARD_DECLARE_CLASS(StallWatchdog)
+QTPOKIT_FORWARD_DECLARE_CLASS(TrafficRecorder)
 QTPOKIT_USE_NAMESPACE
 
 class DeviceCommand : public AbstractCommand
@@ -20,15 +35,76 @@ class DeviceCommand : public AbstractCommand
 public:
     explicit DeviceCommand(QObject * const parent = nullptr);
 
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+    bool startWithDevice(PokitDevice * const sharedDevice, const PokitProduct product);
+
 public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
     bool start() override;
 
+signals:
+    void finished(const int exitCode);
+
 protected:
+    /// Output file, and format, of a single pipeline sink.
+    struct PipelineSink {
+        OutputFileWriter * writer { nullptr };     ///< Writes the sink's blocks to its file.
+        OutputFormat format { OutputFormat::Csv }; ///< Format of the sink's file (CSV or NDJSON).
+        bool showCsvHeader { true };               ///< Whether or not to write a header before the first CSV line.
+    };
+
     PokitDevice * device { nullptr }; ///< Pokit Bluetooth device (if any) this command interacts with.
     int exitCodeOnDisconnect { EXIT_FAILURE }; ///< Exit code to return on device disconnection.
+    std::optional<PokitDevice::ConnectionProfile> connectionProfile; ///< Connection profile to request, if any.
+    QSettings * discoveryCache { nullptr }; ///< Persisted discovery cache, if \c --discovery-cache was set.
+    QString discoveryCacheKey; ///< Key identifying the current device within the #discoveryCache.
+    QSettings * knownDevices { nullptr }; ///< Persisted known-device store, if \c --known-devices was set.
+    bool connectingDirectly { false }; ///< Whether connecting to a known device, without having scanned for it.
+    int reconnectAttempts { 0 }; ///< Maximum reconnection attempts after unexpected disconnections, if any.
+    bool serviceResuming { false }; ///< Whether the service's next details discovery is a resumption.
+    bool linkStatistics { false }; ///< Whether to output the device's link statistics on exit (and on SIGUSR1).
+    bool deviceIsShared { false }; ///< Whether #device is shared with (and owned by) a session (see startWithDevice()).
+    TrafficRecorder * recorder { nullptr }; ///< Records the service's characteristic traffic, if \c --record was set.
+    QVector<EventDetector *> eventDetectors; ///< Detects events in the command's values, if \c --event was set.
+    QString eventUnit; ///< Unit of the values that #eventDetectors detect events in.
+    bool showEventCsvHeader { true }; ///< Whether or not to show a header before the first CSV event record.
+    ChargeIntegrator * chargeIntegrator { nullptr }; ///< Counts the charge of the command's values, if \c --charge.
+    bool showChargeCsvHeader { true }; ///< Whether or not to show a header before the first CSV charge record.
+    SqliteSink * sqlite { nullptr }; ///< Stores the command's values in an SQLite database, if \c --sqlite was set.
+    InfluxWriter * influx { nullptr }; ///< Writes the command's values to an InfluxDB server, if \c --influx was set.
+    float watchdogFactor { 0.0f }; ///< Stall factor for the #watchdog, or 0 if \c --watchdog was not set.
+    StallWatchdog * watchdog { nullptr }; ///< Detects, and recovers from, stalled notifications, if \c --watchdog.
+    bool rawCounts { false }; ///< Whether to output raw device counts, instead of scaled values, if \c --raw was set.
+    QByteArray rawCountsDeclaration; ///< Most recent declaration output by declareRawCounts(), if any.
+    SampleGraph * pipeline { nullptr }; ///< Routes the command's values through stages, to sinks, if \c --pipeline.
+    QMap<QString, PipelineSink> pipelineSinks; ///< Output file, and format, of each of the #pipeline's sinks.
+    std::optional<ThreadPolicy::Settings> deviceThreadPolicy; ///< Settings for the device's thread, if any.
+    std::optional<ThreadPolicy::Settings> sinkThreadPolicy; ///< Settings for output writer threads, if any.
 
     void disconnect(int exitCode=EXIT_SUCCESS);
+    void finish(const int exitCode);
     virtual AbstractPokitService * getService() = 0;
+    virtual bool usesDiscoveredValues() const;
+
+    void restoreDiscoveryCache(AbstractPokitService * const service);
+    void saveDiscoveryCache(const AbstractPokitService * const service);
+
+    std::optional<QBluetoothDeviceInfo> knownDevice(const QString &device) const;
+    void saveKnownDevice(const QBluetoothDeviceInfo &info);
+
+    static QString formatStatistics(const PokitDevice::Statistics &statistics);
+    static QString formatSinkStatistics(const QString &name, const OutputFileWriter::Statistics &statistics);
+    static QString formatSinkStatistics(const InfluxWriter::Statistics &statistics);
+    static QString formatMemoryStatistics(const MemoryBudget::Statistics &statistics);
+    static QString formatPipelineStatistics(const QVector<SampleGraph::StageStatistics> &statistics);
+    static QString formatThreadStatistics(const QString &name, const ThreadPolicy::State &state);
+    void outputStatistics() const;
+    void watchStatisticsSignal();
+
+    static QString formatLatencyReport(const PokitDevice::Statistics &statistics,
+                                       const LatencyHistogram &formatLatency, const LatencyHistogram &writeLatency);
+    void outputLatencyReport() const;
 
     template<typename T> static T minRange(const quint32 maxValue);
     static quint8 minCapacitanceRange(const PokitProduct product, const quint32 maxValue);
@@ -36,11 +112,38 @@ protected:
     static quint8 minResistanceRange(const PokitProduct product, const quint32 maxValue);
     static quint8 minVoltageRange(const PokitProduct product, const quint32 maxValue);
 
+    static QStringList parseFilters(const QStringList &specs, SampleFilter * const filter);
+    static bool parseEvent(const QString &spec, EventDetector::Settings &settings);
+    static bool parseThreadPolicy(const QString &spec, ThreadPolicy::Settings &settings);
+    QStringList addEventDetectors(const QStringList &specs);
+    void addEventValue(const float value, const qint64 timestamp);
+    void flushEvents();
+    void outputEvent(const QString &condition, const EventDetector::Event &event);
+    QStringList addPipeline(const QString &config);
+    QStringList addPipelineStage(const QString &statement);
+    void outputPipelineBlock(const QString &sink, const SampleGraph::Block &block);
+    void flushPipeline();
+    QStringList addChargeIntegrator(const QString &period, const QString &gap);
+    void outputCharge(const ChargeIntegrator::Total &total);
+    QStringList addSqliteSink(const QString &fileName);
+    bool setSqliteSession(const QString &command, const QString &mode, const QString &unit, const QString &range,
+                          const quint32 interval, const qint64 started);
+    QStringList addInfluxWriter(const QString &url);
+    QStringList setWatchdogFactor(const QString &factor);
+    void startWatchdog(AbstractPokitService * const service, const quint32 expectedInterval);
+    QString deviceName() const;
+    QByteArray lineProtocolPrefix(const QByteArray &measurement, const MeasurementFormatter::Context &context) const;
+    QStringList setRawCounts(const QStringList &conflicts);
+    static QByteArray formatScale(const float scale);
+    void declareRawCounts(const MeasurementFormatter::Context &context, const float scale);
+
 protected slots:
     virtual void controllerError(const QLowEnergyController::Error error);
     virtual void deviceDisconnected();
     virtual void serviceError(const QLowEnergyService::ServiceError error);
     virtual void serviceDetailsDiscovered();
+    virtual void serviceResumed(const qint64 gapStart, const qint64 gapEnd);
+    void saveCapabilities(const PokitDevice::Capabilities &capabilities);
 
 private slots:
     // These are protected in the base class, but hidden (private) for our descendents.
@@ -2,14 +2,24 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "dsocommand.h"
+#include "commandsequence.h"
+#include "phasetimer.h"
 #include "../stringliterals_p.h"
 
 #include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokittrace.h>
 
+#include <QDateTime>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QLocale>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
-#include <iostream>
 
 DOKIT_USE_STRINGLITERALS
 
@@ -22,9 +32,11 @@ DOKIT_USE_STRINGLITERALS
 /*!
  * Construct a new DsoCommand object with \a parent.
  */
-DsoCommand::DsoCommand(QObject * const parent) : DeviceCommand(parent)
+DsoCommand::DsoCommand(QObject * const parent) : DeviceCommand(parent), completionTimer(new QTimer(this))
 {
-
+    completionTimer->setInterval(DsoCapture::defaultCompletionTimeout);
+    completionTimer->setSingleShot(true);
+    connect(completionTimer, &QTimer::timeout, this, &DsoCommand::captureTimedOut);
 }
 
 QStringList DsoCommand::requiredOptions(const QCommandLineParser &parser) const
@@ -38,10 +50,29 @@ QStringList DsoCommand::requiredOptions(const QCommandLineParser &parser) const
 QStringList DsoCommand::supportedOptions(const QCommandLineParser &parser) const
 {
     return DeviceCommand::supportedOptions(parser) + QStringList{
+        u"auto-range"_s,
+        u"bandwidth"_s,
+        u"compress"_s,
+        u"continuous"_s,
+        u"duration"_s,
+        u"filter"_s,
+        u"influx"_s,
         u"interval"_s,
+        u"long-capture"_s,
+        u"mark-clipping"_s,
+        u"mqtt"_s,
+        u"pipeline"_s,
+        u"post-trigger"_s,
+        u"pre-trigger"_s,
+        u"raw"_s,
         u"samples"_s,
+        u"shared-memory"_s,
+        u"soft-trigger"_s,
+        u"spectrum"_s,
+        u"stats"_s,
         u"trigger-level"_s,
         u"trigger-mode"_s,
+        u"wav"_s,
     };
 }
 
@@ -132,12 +163,51 @@ QStringList DsoCommand::processOptions(const QCommandLineParser &parser)
         errors.append(tr("If either option is provided, then both must be: trigger-level, trigger-mode"));
     }
 
+    // Long captures require both the (total) samples, and the (total) interval to capture them over.
+    const bool isLongCapture = parser.isSet(u"long-capture"_s);
+    if (isLongCapture) {
+        for (const QString &option: { u"samples"_s, u"interval"_s }) {
+            if (!parser.isSet(option)) {
+                errors.append(tr("Missing required option for --%1: --%2").arg(u"long-capture"_s, option));
+            }
+        }
+    }
+
+    // Parse the bandwidth and duration options, which are planned into settings once the device's capabilities are
+    // known (see applyAcquisitionPlan()), so cannot be combined with the options they would replace.
+    if (parser.isSet(u"bandwidth"_s) || parser.isSet(u"duration"_s)) {
+        if (parser.isSet(u"bandwidth"_s) != parser.isSet(u"duration"_s)) {
+            errors.append(tr("If either option is provided, then both must be: bandwidth, duration"));
+        }
+        for (const QString &option: { u"interval"_s, u"long-capture"_s, u"samples"_s }) {
+            if (parser.isSet(option)) {
+                errors.append(tr("Only one of these options may be provided: bandwidth, %1").arg(option));
+            }
+        }
+    }
+    if (parser.isSet(u"bandwidth"_s)) {
+        const QString value = parser.value(u"bandwidth"_s);
+        plannedBandwidth = parseNumber<std::ratio<1>>(value, u"Hz"_s);
+        if (plannedBandwidth == 0) {
+            errors.append(tr("Invalid bandwidth value: %1").arg(value));
+        }
+    }
+    if (parser.isSet(u"duration"_s)) {
+        const QString value = parser.value(u"duration"_s);
+        plannedDuration = parseNumber<std::micro>(value, u"s"_s, 500'000);
+        if (plannedDuration == 0) {
+            errors.append(tr("Invalid duration value: %1").arg(value));
+        }
+    }
+
     // Parse the interval option.
     if (parser.isSet(u"interval"_s)) {
         const QString value = parser.value(u"interval"_s);
         const quint32 interval = parseNumber<std::micro>(value, u"s"_s, 500'000);
         if (interval == 0) {
             errors.append(tr("Invalid interval value: %1").arg(value));
+        } else if (isLongCapture) {
+            longCapture.totalWindow = interval; // Divided between the segments by segmentSettings().
         } else {
             settings.samplingWindow = interval;
         }
@@ -149,6 +219,8 @@ QStringList DsoCommand::processOptions(const QCommandLineParser &parser)
         const quint32 samples = parseNumber<std::ratio<1>>(value, u"S"_s);
         if (samples == 0) {
             errors.append(tr("Invalid samples value: %1").arg(value));
+        } else if (isLongCapture) {
+            longCapture.totalSamples = samples; // Divided between the segments by segmentSettings().
         } else if (samples > std::numeric_limits<quint16>::max()) {
             errors.append(tr("Samples value (%1) must be no greater than %2")
                 .arg(value).arg(std::numeric_limits<quint16>::max()));
@@ -159,9 +231,207 @@ QStringList DsoCommand::processOptions(const QCommandLineParser &parser)
             settings.numberOfSamples = (quint16)samples;
         }
     }
+
+    // Parse the shared-memory option.
+    if (parser.isSet(u"shared-memory"_s)) {
+        const QString key = parser.value(u"shared-memory"_s);
+        if (!ring) {
+            ring = new SharedSampleRing(this);
+        }
+        if (!ring->create(key)) {
+            errors.append(tr("Failed to create shared memory ring %1: %2").arg(key, ring->errorString()));
+        }
+    }
+
+    // Parse the mqtt option.
+    if (parser.isSet(u"mqtt"_s)) {
+        const QString url = parser.value(u"mqtt"_s);
+        if (!mqtt) {
+            mqtt = new MqttPublisher(this);
+        }
+        if (!mqtt->setUrl(QUrl(url))) {
+            errors.append(tr("Invalid MQTT URL %1: %2").arg(url, mqtt->errorString()));
+        }
+    }
+
+    // Parse the influx option.
+    if (parser.isSet(u"influx"_s)) {
+        errors.append(addInfluxWriter(parser.value(u"influx"_s)));
+    }
+
+    // Parse the wav option.
+    if (parser.isSet(u"wav"_s)) {
+        const QString fileName = parser.value(u"wav"_s);
+        delete wav;
+        wav = new WavWriter(this);
+        if (!wav->open(fileName)) {
+            errors.append(tr("Failed to open WAV file %1: %2").arg(fileName, wav->errorString()));
+        }
+    }
+
+    compressSamples = parser.isSet(u"compress"_s);
+    continuous = parser.isSet(u"continuous"_s);
+    showStatistics = parser.isSet(u"stats"_s);
+    showSpectrum = parser.isSet(u"spectrum"_s);
+    if ((format == OutputFormat::Binary) && ((showStatistics) || (showSpectrum))) {
+        errors.append(tr("Binary output is only supported for raw samples, not --spectrum or --stats"));
+    }
+    if ((format == OutputFormat::Arrow) && ((showStatistics) || (showSpectrum))) {
+        errors.append(tr("Arrow output is only supported for raw samples, not --spectrum or --stats"));
+    }
+    if ((format == OutputFormat::LineProtocol) && ((showStatistics) || (showSpectrum))) {
+        errors.append(tr("Line protocol output is only supported for raw samples, not --spectrum or --stats"));
+    }
+    if ((isLongCapture) && (continuous)) {
+        errors.append(tr("Only one of these options may be provided: continuous, long-capture"));
+    }
+    if ((isLongCapture) && ((showStatistics) || (showSpectrum))) {
+        errors.append(tr("Long captures are only supported for raw samples, not --spectrum or --stats"));
+    }
+    autoRange = parser.isSet(u"auto-range"_s);
+    if ((autoRange) && (!continuous)) {
+        errors.append(tr("Missing required option for --%1: --%2").arg(u"auto-range"_s, u"continuous"_s));
+    }
+    markClipping = parser.isSet(u"mark-clipping"_s);
+    if ((markClipping) && ((showStatistics) || (showSpectrum) || (parser.isSet(u"soft-trigger"_s)))) {
+        errors.append(tr("Clipping markers are only supported for sample output, not --soft-trigger, --spectrum or "
+                         "--stats"));
+    }
+    if ((markClipping) && (format != OutputFormat::Json) && (format != OutputFormat::Ndjson) &&
+        (format != OutputFormat::Text)) {
+        errors.append(tr("Clipping markers are only supported for JSON, NDJSON and text output"));
+    }
+
+    // Parse the raw option.
+    if (parser.isSet(u"raw"_s)) {
+        QStringList conflicts;
+        for (const QString &option: { u"filter"_s, u"soft-trigger"_s, u"spectrum"_s, u"stats"_s }) {
+            if (parser.isSet(option)) {
+                conflicts.append(option);
+            }
+        }
+        errors.append(setRawCounts(conflicts));
+    }
+
+    // Parse the filter option/s.
+    if (parser.isSet(u"filter"_s)) {
+        if (format == OutputFormat::Binary) {
+            errors.append(tr("Binary output is only supported for raw samples, not --filter"));
+        }
+        if ((showStatistics) || (showSpectrum)) {
+            errors.append(tr("Filters are only supported for sample output, not --spectrum or --stats"));
+        }
+        filter = new SampleFilter(this);
+        errors.append(parseFilters(parser.values(u"filter"_s), filter));
+    }
+
+    // Parse the pipeline option.
+    if (parser.isSet(u"pipeline"_s)) {
+        errors.append(addPipeline(parser.value(u"pipeline"_s)));
+    }
+
+    // Parse the soft-trigger, pre-trigger, and post-trigger options.
+    for (const QString &option: { u"pre-trigger"_s, u"post-trigger"_s }) {
+        if ((parser.isSet(option)) && (!parser.isSet(u"soft-trigger"_s))) {
+            errors.append(tr("Missing required option for --%1: --%2").arg(option, u"soft-trigger"_s));
+        }
+    }
+    if (parser.isSet(u"soft-trigger"_s)) {
+        if (format == OutputFormat::Binary) {
+            errors.append(tr("Binary output is only supported for raw samples, not --soft-trigger"));
+        }
+        if (format == OutputFormat::Arrow) {
+            errors.append(tr("Arrow output is only supported for raw samples, not --soft-trigger"));
+        }
+        if (format == OutputFormat::LineProtocol) {
+            errors.append(tr("Line protocol output is only supported for raw samples, not --soft-trigger"));
+        }
+        if ((showStatistics) || (showSpectrum)) {
+            errors.append(tr("Software triggers are only supported for sample output, not --spectrum or --stats"));
+        }
+        SoftwareTrigger::Settings triggerSettings = SoftwareTrigger::defaultSettings();
+        if (parser.isSet(u"pre-trigger"_s)) {
+            const QString value = parser.value(u"pre-trigger"_s);
+            const quint32 samples = (value.trimmed() == u"0"_s) ? 0 : parseNumber<std::ratio<1>>(value, u"S"_s);
+            if ((samples == 0) && (value.trimmed() != u"0"_s)) {
+                errors.append(tr("Invalid pre-trigger value: %1").arg(value));
+            } else {
+                triggerSettings.preTrigger = samples;
+            }
+        }
+        if (parser.isSet(u"post-trigger"_s)) {
+            const QString value = parser.value(u"post-trigger"_s);
+            const quint32 samples = parseNumber<std::ratio<1>>(value, u"S"_s);
+            if (samples == 0) {
+                errors.append(tr("Invalid post-trigger value: %1").arg(value));
+            } else {
+                triggerSettings.postTrigger = samples;
+            }
+        }
+        if (!parseSoftwareTrigger(parser.value(u"soft-trigger"_s), triggerSettings)) {
+            errors.append(tr("Invalid soft-trigger value: %1").arg(parser.value(u"soft-trigger"_s)));
+        } else if (!softwareTrigger) {
+            softwareTrigger = new SoftwareTrigger(this);
+            connect(softwareTrigger, &SoftwareTrigger::triggered, this, &DsoCommand::outputTriggeredSegment);
+        }
+        if (softwareTrigger) {
+            softwareTrigger->setSettings(triggerSettings);
+        }
+    }
     return errors;
 }
 
+/*!
+ * \copybrief AbstractCommand::supportsArrowOutput
+ *
+ * This override returns \c true, since DSO samples may be output as Arrow record batches.
+ */
+bool DsoCommand::supportsArrowOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsBinaryOutput
+ *
+ * This override returns \c true, since DSO samples may be output as raw Binary blocks.
+ */
+bool DsoCommand::supportsBinaryOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsLineProtocolOutput
+ *
+ * This override returns \c true, since DSO samples may be output as line protocol points, with timestamps
+ * interpolated from the capture's sampling rate.
+ */
+bool DsoCommand::supportsLineProtocolOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonOutput
+ *
+ * This override returns \c true, since DSO captures may include many thousands of samples.
+ */
+bool DsoCommand::supportsNdjsonOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonEnvelopeOutput
+ *
+ * This override returns \c true, since all of a DSO capture's samples share the same mode, unit and range.
+ */
+bool DsoCommand::supportsNdjsonEnvelopeOutput() const
+{
+    return true;
+}
+
 /*!
  * \copybrief DeviceCommand::getService
  *
@@ -175,6 +445,16 @@ AbstractPokitService * DsoCommand::getService()
         Q_ASSERT(service);
         connect(service, &DsoService::settingsWritten,
                 this, &DsoCommand::settingsWritten);
+        if (showStatistics) {
+            statistics = new DsoStatistics(service, this);
+            connect(statistics, &DsoStatistics::summaryReady, this, &DsoCommand::outputStatistics);
+        }
+        if (showSpectrum) {
+            capture = new DsoCapture(service, this);
+            capture->setCompletionTimeout(0); // Stalled captures are re-requested by captureTimedOut() instead.
+            spectrum = new DsoSpectrum(capture, this);
+            connect(spectrum, &DsoSpectrum::spectrumReady, this, &DsoCommand::outputSpectrum);
+        }
     }
     return service;
 }
@@ -187,8 +467,27 @@ AbstractPokitService * DsoCommand::getService()
 void DsoCommand::serviceDetailsDiscovered()
 {
     DeviceCommand::serviceDetailsDiscovered(); // Just logs consistently.
+    if (mqtt) {
+        const QLowEnergyController * const controller = device->controller();
+        mqttTopic = mqtt->topic((controller->remoteName().isEmpty()) ? controller->remoteAddress().toString()
+            : controller->remoteName(), u"dso"_s);
+        mqtt->start();
+    }
     settings.range = (minRangeFunc == nullptr) ? 0 : minRangeFunc(*service->pokitProduct(), rangeOptionValue);
     const QString range = service->toString(settings.range, settings.mode);
+    if ((plannedBandwidth > 0) && (!applyAcquisitionPlan())) {
+        finish(EXIT_FAILURE);
+        return;
+    }
+    if (longCapture.totalSamples > 0) {
+        const quint16 bufferSize = device->capabilities().samplingBufferSize;
+        longCapture.segmentSize = (bufferSize > 0) ? bufferSize : defaultSegmentSize;
+        qCInfo(lc).noquote() << tr("Sampling %1, with range %2, %L3 samples over %L4us, in segments of up to %L5 "
+            "samples").arg(DsoService::toString(settings.mode), (range.isNull()) ? QString::fromLatin1("N/A") : range)
+            .arg(longCapture.totalSamples).arg(longCapture.totalWindow).arg(longCapture.segmentSize);
+        service->setSettings(segmentSettings(settings, longCapture));
+        return;
+    }
     qCInfo(lc).noquote() << tr("Sampling %1, with range %2, %Ln sample/s over %L3us", nullptr, settings.numberOfSamples)
         .arg(DsoService::toString(settings.mode), (range.isNull()) ? QString::fromLatin1("N/A") : range)
         .arg(settings.samplingWindow);
@@ -215,11 +514,42 @@ void DsoCommand::serviceDetailsDiscovered()
 void DsoCommand::settingsWritten()
 {
     Q_ASSERT(service);
+    if (longCapture.totalSamples > 0) {
+        // Free-running segments begin sampling as soon as their settings are written.
+        longCapture.segmentStart = QDateTime::currentMSecsSinceEpoch() * 1000;
+        if (longCapture.previousEnd >= 0) {
+            outputSegmentMarker(captureNumber, longCapture.firstSample, longCapture.segmentStart,
+                                longCapture.segmentStart - longCapture.previousEnd);
+        }
+    }
+    if (captureNumber > 0) {
+        qCDebug(lc).noquote() << tr("Settings written; DSO has restarted for capture %L1.").arg(captureNumber + 1);
+        return; // Signals and notifications are already in place from the first capture.
+    }
     qCDebug(lc).noquote() << tr("Settings written; DSO has started.");
+    PhaseTimer::mark(PhaseTimer::Phase::SettingsWritten);
     connect(service, &DsoService::metadataRead, this, &DsoCommand::metadataRead);
-    connect(service, &DsoService::samplesRead, this, &DsoCommand::outputSamples);
-    service->enableMetadataNotifications();
-    service->enableReadingNotifications();
+    if (isPassthrough()) {
+        // Nothing needs the decoded samples, so the notifications' bytes are output as is.
+        connect(service, &DsoService::rawSamplesRead, this, &DsoCommand::outputRawSamples);
+    } else {
+        connect(service, &DsoService::samplesRead, this, &DsoCommand::outputSamples);
+    }
+
+    // The two notifications are independent, so are enabled together, and only then waited on (once).
+    auto * const sequence = new CommandSequence(this);
+    sequence->then(u"enable metadata notifications"_s, [this]() { return service->enableMetadataNotificationsAsync(); })
+        .alongside(u"enable reading notifications"_s, [this]() { return service->enableReadingNotificationsAsync(); });
+    connect(sequence, &CommandSequence::failed, this, [this, sequence](const QString &step) {
+        qCWarning(lc).noquote() << tr("Failed to start DSO notifications: %1").arg(step);
+        sequence->deleteLater();
+        if (device) disconnect(EXIT_FAILURE);
+    });
+    connect(sequence, &CommandSequence::finished, this, [sequence]() {
+        qCDebug(lc).noquote() << tr("Metadata and reading notifications enabled.");
+        sequence->deleteLater();
+    });
+    sequence->start();
 }
 
 /*!
@@ -234,55 +564,924 @@ void DsoCommand::metadataRead(const DsoService::Metadata &data)
     qCDebug(lc) << "samplingWindow:" << (int)data.samplingWindow;
     qCDebug(lc) << "numberOfSamples:" << data.numberOfSamples;
     qCDebug(lc) << "samplingRate:" << data.samplingRate << "Hz";
+    if (std::exchange(resending, false) && (data.status != DsoService::DsoStatus::Error) &&
+        (data.mode == metadata.mode) && (data.numberOfSamples == metadata.numberOfSamples)) {
+        // The whole window will be re-sent, so skip the samples already output, and carry on from there.
+        resendSkip = metadata.numberOfSamples - samplesToGo;
+        qCDebug(lc).noquote() << tr("Re-sending window; skipping %Ln sample/s already received.", nullptr, resendSkip);
+        completionTimer->start();
+        return;
+    }
+    resends = 0;
+    resendSkip = 0;
     this->metadata = data;
     this->samplesToGo = data.numberOfSamples;
+    this->captureTimestamp = QDateTime::currentMSecsSinceEpoch() * 1000;
+    if (longCapture.firstSample == 0) {
+        saturation.reset(); // Otherwise, carry on from the long capture's previous segment, as one series.
+    }
+    saturation.setThreshold(SaturationDetector::threshold((service) ? service->pokitProduct()
+        .value_or(PokitProduct::PokitMeter) : PokitProduct::PokitMeter, data.mode, data.range, data.scale));
+    if (filter) {
+        filter->setSampleRate(data.samplingRate);
+        if (longCapture.firstSample == 0) {
+            filter->reset(); // Otherwise, carry on filtering from the long capture's previous segment.
+        }
+    }
+    if ((pipeline) && (longCapture.firstSample == 0)) {
+        pipeline->flush(); // The previous capture's windows, and events, so they're not merged with this capture's.
+        pipeline->reset();
+    }
+    if (format == OutputFormat::Binary) {
+        writeBinaryHeader(outputBuffer, BinaryBlock::DsoSamples, (quint8)data.mode, data.range, data.scale,
+                          data.samplingRate, (quint64)(captureTimestamp / 1000), data.numberOfSamples,
+                          compressSamples);
+        previousSample = 0;
+    } else if ((format == OutputFormat::NdjsonEnvelope) && (!statistics) && (!spectrum) && (!softwareTrigger)) {
+        // Open this capture's envelope; outputSamples() will append the values, and close it.
+        const MeasurementFormatter::Context &context = formatter.context((quint8)data.mode, data.range);
+        output(QByteArray("{\"mode\":") + escapeJsonString(context.mode) +
+               ",\"unit\":" + escapeJsonString(context.unit) +
+               ",\"range\":" + escapeJsonString(context.range) +
+               ",\"samplingRate\":" + QByteArray::number(data.samplingRate) +
+               ",\"numberOfSamples\":" + QByteArray::number(data.numberOfSamples) + ((rawCounts)
+               ? ",\"scale\":" + formatScale(data.scale) + ",\"counts\":[" : QByteArray(",\"values\":[")));
+        if (samplesToGo <= 0) {
+            output(QByteArray("]}\n"));
+            outputBatchComplete();
+        }
+    } else if (rawCounts) {
+        declareRawCounts(formatter.context((quint8)data.mode, data.range), data.scale);
+    }
+    if (samplesToGo > 0) {
+        completionTimer->start();
+    }
+}
+
+/*!
+ * Returns the unit string for DSO \a mode, or a null string if \a mode has no known unit.
+ */
+QString DsoCommand::toUnit(const DsoService::Mode mode)
+{
+    switch (mode) {
+    case DsoService::Mode::DcVoltage: return u"Vdc"_s;
+    case DsoService::Mode::AcVoltage: return u"Vac"_s;
+    case DsoService::Mode::DcCurrent: return u"Adc"_s;
+    case DsoService::Mode::AcCurrent: return u"Aac"_s;
+    default:
+        qCDebug(lc).noquote() << tr(R"(No known unit for mode %1 "%2".)").arg((int)mode)
+            .arg(DsoService::toString(mode));
+    }
+    return QString();
+}
+
+/*!
+ * Parses \a spec (as per the `soft-trigger` option) into \a settings' condition, slope, levels, hysteresis and pulse
+ * widths, leaving \a settings' pre- and post-trigger lengths unchanged. Returns \c true if \a spec was parsed, and
+ * the resulting \a settings are valid (see SoftwareTrigger::isValid), otherwise \c false.
+ *
+ * The \a spec is one of `level:<slope>:<level>`, `edge:<slope>:<level>[:<hysteresis>]`,
+ * `window:<slope>:<lower>:<upper>[:<hysteresis>]` or `pulse:<slope>:<level>:<min-width>[:<max-width>]`, where
+ * `<slope>` is `rising`, `falling` or `either`, levels are in the mode's own units (such as volts), and pulse widths
+ * are in samples.
+ */
+bool DsoCommand::parseSoftwareTrigger(const QString &spec, SoftwareTrigger::Settings &settings)
+{
+    const QStringList parts = spec.split(u':');
+    if (parts.size() < 3) {
+        return false;
+    }
+
+    if (const QString condition = parts.at(0).trimmed().toLower(); condition == u"level"_s) {
+        settings.condition = SoftwareTrigger::Condition::Level;
+    } else if (condition == u"edge"_s) {
+        settings.condition = SoftwareTrigger::Condition::Edge;
+    } else if (condition == u"window"_s) {
+        settings.condition = SoftwareTrigger::Condition::Window;
+    } else if (condition.startsWith(u"pulse"_s)) {
+        settings.condition = SoftwareTrigger::Condition::PulseWidth;
+    } else {
+        return false;
+    }
+
+    if (const QString slope = parts.at(1).trimmed().toLower(); slope.startsWith(u"ris"_s)) {
+        settings.slope = SoftwareTrigger::Slope::Rising;
+    } else if (slope.startsWith(u"fall"_s)) {
+        settings.slope = SoftwareTrigger::Slope::Falling;
+    } else if ((slope == u"either"_s) || (slope == u"both"_s)) {
+        settings.slope = SoftwareTrigger::Slope::Either;
+    } else {
+        return false;
+    }
+
+    bool ok = true;
+    const auto number = [&parts, &ok](const qsizetype index) {
+        bool parsed = false;
+        const double value = QLocale().toDouble(parts.at(index).trimmed(), &parsed);
+        ok = (ok) && (parsed);
+        return value;
+    };
+    const auto width = [&parts, &ok](const qsizetype index) {
+        bool parsed = false;
+        const uint value = parts.at(index).trimmed().toUInt(&parsed);
+        ok = (ok) && (parsed);
+        return (quint32)value;
+    };
+    settings.level = (float)number(2);
+    settings.upperLevel = 0.0f;
+    settings.hysteresis = 0.0f;
+    settings.minWidth = 1;
+    settings.maxWidth = 0;
+    switch (settings.condition) {
+    case SoftwareTrigger::Condition::Level:
+        ok = (ok) && (parts.size() == 3);
+        break;
+    case SoftwareTrigger::Condition::Edge:
+        ok = (ok) && (parts.size() <= 4);
+        if ((ok) && (parts.size() == 4)) {
+            settings.hysteresis = (float)number(3);
+        }
+        break;
+    case SoftwareTrigger::Condition::Window:
+        ok = (ok) && (parts.size() >= 4) && (parts.size() <= 5);
+        if (ok) {
+            settings.upperLevel = (float)number(3);
+        }
+        if ((ok) && (parts.size() == 5)) {
+            settings.hysteresis = (float)number(4);
+        }
+        break;
+    case SoftwareTrigger::Condition::PulseWidth:
+        ok = (ok) && (parts.size() >= 4) && (parts.size() <= 5);
+        if (ok) {
+            settings.minWidth = width(3);
+        }
+        if ((ok) && (parts.size() == 5)) {
+            settings.maxWidth = width(4);
+        }
+        break;
+    }
+    return (ok) && (SoftwareTrigger::isValid(settings));
+}
+
+/*!
+ * Resolves the context (labels, and each output format's constant fields) of DSO samples with \a mode and \a range.
+ */
+MeasurementFormatter::Context DsoCommand::resolveContext(const quint8 mode, const quint8 range) const
+{
+    MeasurementFormatter::Context context;
+    context.mode = DsoService::toString((DsoService::Mode)mode);
+    context.unit = toUnit((DsoService::Mode)mode);
+    context.range = service->toString(range, (DsoService::Mode)mode);
+    if (rawCounts) {
+        // The mode, unit and range are declared once, by declareRawCounts(), rather than per sample.
+        context.csv.infix = ","; // sample_number,count
+        context.csv.suffix = "\n";
+        context.ndjson.prefix = "{\"count\":";
+        context.ndjson.suffix = "}\n";
+        context.text = tr("%1 %2\n"); // Just the sample number and count.
+        return context;
+    }
+    context.csv.infix = ","; // sample_number,value,unit,range
+    context.csv.suffix = ',' + context.unit.toUtf8() + ',' + context.range.toUtf8() + '\n';
+    context.ndjson.prefix = "{\"value\":";
+    context.ndjson.suffix = ",\"unit\":" + escapeJsonString(context.unit) + ",\"range\":" +
+        escapeJsonString(context.range) + ",\"mode\":" + escapeJsonString(context.mode) + "}\n";
+    context.lineProtocol = lineProtocolPrefix("dso", context);
+    context.text = tr("%1 %2 %3\n").arg(u"%1"_s, u"%2"_s, context.unit); // Just the sample number and value to go.
+    return context;
+}
+
+/*!
+ * Returns the DSO settings for the next segment of long \a capture, that is, \a settings, but with the number of
+ * samples (and sampling window) of the segment beginning at \a capture's \c firstSample.
+ *
+ * Each segment is up to \a capture's \c segmentSize samples, with its share of the \c totalWindow, so that every
+ * segment samples at the same rate. Each segment's window is derived from the total window up to its first and last
+ * samples, so rounding errors never accumulate across segments. Only the first segment waits for the trigger (if any),
+ * since later segments should follow on as soon as possible.
+ */
+DsoService::Settings DsoCommand::segmentSettings(const DsoService::Settings &settings, const LongCapture &capture)
+{
+    Q_ASSERT(capture.firstSample < capture.totalSamples);
+    DsoService::Settings segment = settings;
+    segment.numberOfSamples = (quint16)std::min<quint64>(capture.totalSamples - capture.firstSample,
+                                                         capture.segmentSize);
+    const auto windowTo = [&capture](const quint64 sample) {
+        return qRound64((double)capture.totalWindow * (double)sample / (double)capture.totalSamples);
+    };
+    segment.samplingWindow = (quint32)std::max<qint64>(
+        windowTo(capture.firstSample + segment.numberOfSamples) - windowTo(capture.firstSample), 1);
+    if (capture.firstSample > 0) {
+        segment.command = DsoService::Command::FreeRunning;
+    }
+    return segment;
+}
+
+/*!
+ * Returns the capture settings that best capture frequencies up to \a bandwidth (in Hz) for \a duration (in
+ * microseconds), on a device with a \a maximumSamplingRate (in kHz) and \a bufferSize (in samples), either of which
+ * may be 0 if not known, in which case defaults are assumed.
+ *
+ * The plan needs at least #oversampling times \a bandwidth samples per second (comfortably above the Nyquist rate),
+ * so if that exceeds the device's maximum sampling rate, the plan has no samples. Otherwise, the plan uses as few
+ * device captures as can hold that many samples, since each additional capture adds a gap while the DSO is restarted,
+ * but then fills every capture's buffer (up to the device's maximum sampling rate), since the extra resolution is free.
+ * So durations short enough for a single capture are sampled as finely as the device allows, while longer durations
+ * are planned as a long capture (see segmentSettings()), stitched together from full-buffer captures.
+ */
+DsoCommand::AcquisitionPlan DsoCommand::planAcquisition(const quint32 bandwidth, const quint32 duration,
+                                                        const quint16 maximumSamplingRate, const quint16 bufferSize)
+{
+    AcquisitionPlan plan;
+    const double maxRate = ((maximumSamplingRate > 0) ? maximumSamplingRate : defaultMaximumSamplingRate) * 1000.0;
+    plan.maximumBandwidth = (quint32)(maxRate / oversampling);
+    plan.segmentSize = (bufferSize > 0) ? bufferSize : defaultSegmentSize;
+    plan.samplingWindow = duration;
+    const double minRate = oversampling * bandwidth;
+    if ((bandwidth == 0) || (duration == 0) || (minRate > maxRate)) {
+        return plan;
+    }
+    const double seconds = duration / 1'000'000.0;
+    const quint64 minSamples = std::max<quint64>((quint64)std::ceil(minRate * seconds), 1);
+    const quint64 maxSamples = std::max<quint64>((quint64)std::floor(maxRate * seconds), minSamples);
+    const quint64 captures = (minSamples + plan.segmentSize - 1) / plan.segmentSize;
+    plan.numberOfSamples = std::min<quint64>(captures * plan.segmentSize, maxSamples);
+    plan.captures = (quint32)((plan.numberOfSamples + plan.segmentSize - 1) / plan.segmentSize);
+    return plan;
+}
+
+/*!
+ * Applies the capture settings planned (see planAcquisition()) for the `bandwidth` and `duration` options, from the
+ * device's capabilities, either to #settings for a single capture, or to #longCapture for more. Returns \c false, after
+ * logging why, if the plan cannot be captured, or needs more captures than the other options allow.
+ */
+bool DsoCommand::applyAcquisitionPlan()
+{
+    const PokitDevice::Capabilities capabilities = device->capabilities();
+    const AcquisitionPlan plan = planAcquisition(plannedBandwidth, plannedDuration, capabilities.maximumSamplingRate,
+                                                 capabilities.samplingBufferSize);
+    if (plan.numberOfSamples == 0) {
+        qCCritical(lc).noquote() << tr("Bandwidth of %L1Hz exceeds the device's maximum of %L2Hz.")
+            .arg(plannedBandwidth).arg(plan.maximumBandwidth);
+        return false;
+    }
+    qCInfo(lc).noquote() << tr("Planned %L1 samples over %L2us, for bandwidth up to %L3Hz, in %L4 capture/s.")
+        .arg(plan.numberOfSamples).arg(plan.samplingWindow).arg(plannedBandwidth).arg(plan.captures);
+    if (plan.captures > 1) {
+        if ((continuous) || (showStatistics) || (showSpectrum)) {
+            qCCritical(lc).noquote() << tr("Capturing %L1Hz for %L2us needs %L3 captures, but only single captures "
+                "are supported by --continuous, --spectrum and --stats.").arg(plannedBandwidth).arg(plannedDuration)
+                .arg(plan.captures);
+            return false;
+        }
+        longCapture.totalSamples = plan.numberOfSamples;
+        longCapture.totalWindow = plan.samplingWindow;
+    } else {
+        settings.numberOfSamples = (quint16)plan.numberOfSamples;
+        settings.samplingWindow = plan.samplingWindow;
+    }
+    return true;
+}
+
+/*!
+ * Returns the best range for the next capture in \a product's DSO \a mode, given the peak magnitude (in volts, or
+ * amps) of the previous capture, which used \a range. If \a clipped, then the previous capture reached the limits of
+ * \a range, so its true peak is unknown, and at least the next range up is chosen.
+ *
+ * To avoid flapping between adjacent ranges, a higher range is only chosen once \a peak exceeds 90% of \a range's
+ * maximum, whereas a lower range is only chosen if \a peak is within 80% of that range's maximum. If no range is high
+ * enough, then the highest range is chosen. If \a mode has no ranges, or \a range is not known, then \a range is
+ * returned unchanged.
+ */
+quint8 DsoCommand::nextRange(const PokitProduct product, const DsoService::Mode mode, const quint8 range,
+                             const float peak, const bool clipped)
+{
+    quint8 (* minRangeOf)(const PokitProduct product, const quint32 maxValue) { nullptr };
+    double unitsPerValue { 0.0 }; // Range units (millivolts, or microamps) per volt, or amp.
+    switch (mode) {
+    case DsoService::Mode::Idle:
+        return range;
+    case DsoService::Mode::DcVoltage:
+    case DsoService::Mode::AcVoltage:
+        minRangeOf = minVoltageRange;
+        unitsPerValue = 1'000.0;
+        break;
+    case DsoService::Mode::DcCurrent:
+    case DsoService::Mode::AcCurrent:
+        minRangeOf = minCurrentRange;
+        unitsPerValue = 1'000'000.0;
+        break;
+    }
+    Q_ASSERT(minRangeOf);
+
+    const quint32 rangeMax = DsoService::maxValue(product, range, mode);
+    if (rangeMax == 0) {
+        return range;
+    }
+    const quint32 highestMax = DsoService::maxValue(product, 255, mode); // AutoRange is the highest range's maximum.
+    const auto rangeFor = [&](const double value) {
+        return minRangeOf(product, (quint32)std::clamp(std::ceil(value), 1.0, (double)highestMax));
+    };
+
+    const double peakValue = qAbs(peak) * unitsPerValue;
+    if ((clipped) || (peakValue > rangeMax * 0.9)) {
+        return rangeFor(std::max(rangeMax + 1.0, peakValue / 0.8));
+    }
+    const quint8 lower = rangeFor(peakValue / 0.8);
+    return (DsoService::maxValue(product, lower, mode) < rangeMax) ? lower : range;
+}
+
+/*!
+ * Outputs a marker for the gap before (zero-based) long capture \a segment, in the selected output format. The
+ * segment begins with (zero-based) sample \a firstSample of the whole series, at \a start (in microseconds since the
+ * epoch), \a gap microseconds after the previous segment's (nominal) end.
+ *
+ * Binary and Arrow output have no markers, since every segment's Binary header includes its own timestamp, and every
+ * Arrow sample its own timestamp, already.
+ */
+void DsoCommand::outputSegmentMarker(const quint64 segment, const quint64 firstSample, const qint64 start,
+                                     const qint64 gap)
+{
+    qCInfo(lc).noquote() << tr("Segment %L1 started %L2us after the previous segment ended.").arg(segment + 1)
+        .arg(gap);
+    switch (format) {
+    case OutputFormat::Csv: {
+        // An empty row, which most CSV consumers treat as missing values, breaking any plotted line at the gap.
+        const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+        output(",," + context.unit.toUtf8() + ',' + context.range.toUtf8() + '\n');
+    }   break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope: {
+        const QJsonDocument document(QJsonObject{
+                { u"segment"_s,     (qint64)segment + 1 },     // One-based, as per the Text output.
+                { u"firstSample"_s, (qint64)firstSample + 1 }, // One-based, as per the CSV sample_number.
+                { u"start"_s,       start },
+                { u"gap"_s,         gap },
+            });
+        output((format == OutputFormat::Json) ? document.toJson() : document.toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+        break;
+    case OutputFormat::Text:
+        output(tr("-- segment %1, from sample %2, after a gap of %3us --\n").arg(segment + 1)
+            .arg(firstSample + 1).arg(gap));
+        break;
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Outputs a marker for a run of clipped samples (see SaturationDetector), in the selected output format. The
+ * \a segment's first sample is numbered from 1, from the start of the capture (or, for long captures, the whole
+ * series), as per the CSV `sample_number`.
+ *
+ * Only JSON, NDJSON and Text output have markers (see processOptions()), since the other formats' fixed schemas have
+ * no place for them.
+ */
+void DsoCommand::outputClippingMarker(const SaturationDetector::Segment &segment)
+{
+    const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+    switch (format) {
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson: {
+        const QJsonDocument document(QJsonObject{
+                { u"clipped"_s,     segment.count },
+                { u"firstSample"_s, segment.first + 1 },
+                { u"range"_s,       context.range },
+            });
+        output((format == OutputFormat::Json) ? document.toJson() : document.toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Csv:
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::NdjsonEnvelope:
+        break;
+    case OutputFormat::Text:
+        output(tr("-- %Ln sample/s clipped (%1), from sample %2 --\n", nullptr, (int)segment.count)
+            .arg(context.range).arg(segment.first + 1));
+        break;
+    }
 }
 
 /*!
  * Outputs DSO \a samples in the selected output format.
+ *
+ * If per-capture statistics or spectra were requested, then \a samples are only counted here, since
+ * outputStatistics() and/or outputSpectrum() will output a summary of them instead. Either way, \a samples are also
+ * published to the shared memory #ring, the MQTT broker, the InfluxDB server, the WAV file, and the #pipeline (if
+ * any).
  */
 void DsoCommand::outputSamples(const DsoService::Samples &samples)
 {
-    QString unit;
-    switch (metadata.mode) {
-    case DsoService::Mode::DcVoltage: unit = u"Vdc"_s; break;
-    case DsoService::Mode::AcVoltage: unit = u"Vac"_s; break;
-    case DsoService::Mode::DcCurrent: unit = u"Adc"_s; break;
-    case DsoService::Mode::AcCurrent: unit = u"Aac"_s; break;
-    default:
-        qCDebug(lc).noquote() << tr(R"(No known unit for mode %1 "%2".)").arg((int)metadata.mode)
-            .arg(DsoService::toString(metadata.mode));
+    QTPOKIT_TRACE_ZONE(Format, "dsoSamples");
+    if (resendSkip > 0) {
+        // Skip the re-sent samples that were already output before the window stalled.
+        completionTimer->start();
+        if (samples.size() <= resendSkip) {
+            resendSkip -= samples.size();
+            return;
+        }
+        outputSamples(samples.mid(std::exchange(resendSkip, 0)));
+        return;
+    }
+
+    // Runs of clipped samples are found regardless of output format, for the end-of-capture warning, and ranging.
+    const QVector<SaturationDetector::Segment> clipped = saturation.process(samples);
+
+    if ((ring) || (mqtt) || (influx)) {
+        // Interpolate from this batch's first sample, so the (truncated) interval's error does not accumulate.
+        const qint64 firstSample = metadata.numberOfSamples - samplesToGo;
+        const qint64 timestamp = captureTimestamp + ((metadata.samplingRate == 0) ? 0 :
+            (firstSample * 1'000'000 / (qint64)metadata.samplingRate));
+        if (ring) {
+            ring->publish(metadata, samples, timestamp,
+                (metadata.samplingRate == 0) ? 0 : 1'000'000 / (qint64)metadata.samplingRate);
+        }
+        if (mqtt) {
+            mqtt->publish(mqttTopic, metadata, samples, timestamp / 1000);
+        }
+        if (influx) {
+            influx->write(deviceName(), formatter.context((quint8)metadata.mode, metadata.range), samples,
+                metadata.scale, captureTimestamp * 1000 + ((metadata.samplingRate == 0) ? 0 :
+                (firstSample * 1'000'000'000 / (qint64)metadata.samplingRate)),
+                (metadata.samplingRate == 0) ? 0.0 : 1'000'000'000.0 / metadata.samplingRate);
+        }
+    }
+    if (wav) {
+        wav->write(metadata, formatter.context((quint8)metadata.mode, metadata.range), samples);
+    }
+    if (pipeline) {
+        // Scaled once, into a pooled buffer shared by all of the pipeline's stages, timestamped to the nearest ms.
+        const qint64 firstSample = metadata.numberOfSamples - samplesToGo;
+        const double interval = (metadata.samplingRate == 0) ? 0.0 : 1000.0 / metadata.samplingRate;
+        pipeline->addSamples(samples, metadata.scale, captureTimestamp / 1000 + qRound64(firstSample * interval),
+                             interval);
+    }
+
+    // Scale (and filter, if requested) the batch's values once, for whichever output format needs them.
+    if ((!statistics) && (!spectrum) && (!rawCounts) && (format != OutputFormat::Binary)) {
+        values.resize(samples.size());
+        std::transform(samples.constBegin(), samples.constEnd(), values.begin(),
+                       [this](const qint16 sample) { return sample * metadata.scale; });
+        if (filter) {
+            filter->process(values);
+        }
     }
-    const QString range = service->toString(metadata.range, metadata.mode);
 
-    for (const qint16 &sample: samples) {
-        static int sampleNumber = 0; ++sampleNumber;
-        const float value = sample * metadata.scale;
+    if ((statistics) || (spectrum)) {
+        samplesToGo -= samples.size(); // Summarised by outputStatistics() and/or outputSpectrum() instead.
+    } else if (format == OutputFormat::Binary) {
+        // Following the header written by metadataRead().
+        writeBinarySamples(outputBuffer, samples, (compressSamples) ? &previousSample : nullptr);
+        samplesToGo -= samples.size();
+    } else if (softwareTrigger) {
+        // Only the triggered segments are output, by outputTriggeredSegment().
+        softwareTrigger->process(values);
+        samplesToGo -= samples.size();
+    } else if (format == OutputFormat::Arrow) {
+        // One record batch per notification, with timestamps interpolated from the capture's sampling rate.
+        const qint64 firstSample = metadata.numberOfSamples - samplesToGo;
+        QVector<qint64> timestamps(samples.size());
+        for (int index = 0; index < samples.size(); ++index) {
+            timestamps[index] = captureTimestamp + ((metadata.samplingRate == 0) ? 0 :
+                ((firstSample + index) * 1'000'000 / (qint64)metadata.samplingRate));
+        }
+        outputArrowRecordBatch(timestamps, values, (quint8)metadata.mode, metadata.range);
+        samplesToGo -= samples.size();
+    } else if (rawCounts) {
+        // Just the counts, since their scale, mode and range were declared by metadataRead().
+        outputRawCounts(samples);
+        samplesToGo -= samples.size();
+        if ((format == OutputFormat::NdjsonEnvelope) && (samplesToGo <= 0)) {
+            output(QByteArray("]}\n")); // Close the envelope opened by metadataRead().
+        }
+        if (markClipping) {
+            for (const SaturationDetector::Segment &segment: clipped) {
+                outputClippingMarker(segment); // Following the batch that ended the run.
+            }
+        }
+    } else {
+        // The context is constant for the whole batch (and usually the whole capture), so is only resolved once. And
+        // likewise the output format, so each format gets its own loop, free of any per-sample format checks.
+        const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+        static qint64 sampleNumber = 0; // Continues across long capture segments.
         switch (format) {
         case OutputFormat::Csv:
             for (; showCsvHeader; showCsvHeader = false) {
-                std::cout << qUtf8Printable(tr("sample_number,value,unit,range\n"));
+                output(tr("sample_number,value,unit,range\n"));
+            }
+            outputBuffer.reserve(outputBuffer.size() + samples.size() * (context.csv.infix.size() +
+                                 context.csv.suffix.size() + 16)); // 16 bytes for the sample number and value.
+            for (const float value: values) {
+                MeasurementFormatter::appendCsv(outputBuffer, context, (qint64)++sampleNumber, value);
             }
-            std::cout << qUtf8Printable(QString::fromLatin1("%1,%2,%3,%4\n")
-                .arg(sampleNumber).arg(value).arg(unit, range));
             break;
         case OutputFormat::Json:
-            std::cout << QJsonDocument(QJsonObject{
-                    { u"value"_s,  value },
-                    { u"unit"_s,   unit },
-                    { u"range"_s,  range },
-                    { u"mode"_s,   DsoService::toString(metadata.mode) },
-                }).toJson().toStdString();
+            for (const float value: values) {
+                output(QJsonDocument(QJsonObject{
+                        { u"value"_s,  value },
+                        { u"unit"_s,   context.unit },
+                        { u"range"_s,  context.range },
+                        { u"mode"_s,   context.mode },
+                    }).toJson());
+            }
+            break;
+        case OutputFormat::Arrow:  // Written in bulk, above.
+        case OutputFormat::Binary: // Written in bulk, above.
+            break;
+        case OutputFormat::LineProtocol: { // Timestamps interpolated from the capture's sampling rate, in nanoseconds.
+            const qint64 firstSample = metadata.numberOfSamples - samplesToGo;
+            outputBuffer.reserve(outputBuffer.size() + samples.size() * (context.lineProtocol.size() + 32));
+            for (int index = 0; index < values.size(); ++index) {
+                MeasurementFormatter::appendLineProtocol(outputBuffer, context, values.at(index),
+                    captureTimestamp * 1000 + ((metadata.samplingRate == 0) ? 0 :
+                    ((firstSample + index) * 1'000'000'000 / (qint64)metadata.samplingRate)));
+            }
+        }   break;
+        case OutputFormat::Ndjson:
+            outputBuffer.reserve(outputBuffer.size() + samples.size() * (context.ndjson.prefix.size() +
+                                 context.ndjson.suffix.size() + 12)); // 12 bytes for the value.
+            for (const float value: values) {
+                MeasurementFormatter::appendNdjson(outputBuffer, context, QByteArray(), value);
+            }
             break;
+        case OutputFormat::NdjsonEnvelope: { // Appended to the envelope opened by metadataRead().
+            const qsizetype start = outputBuffer.size();
+            for (const float value: values) {
+                appendJsonNumber(outputBuffer.append(','), value);
+            }
+            if ((samplesToGo == metadata.numberOfSamples) && (outputBuffer.size() > start)) {
+                outputBuffer.remove(start, 1); // The envelope's first value has no preceding comma.
+            }
+        }   break;
         case OutputFormat::Text:
-            std::cout << qUtf8Printable(tr("%1 %2 %3\n").arg(sampleNumber).arg(value).arg(unit));
+            for (const float value: values) {
+                output(MeasurementFormatter::formatText(context, QString::number(++sampleNumber), value));
+            }
             break;
         }
-        --samplesToGo;
+        samplesToGo -= samples.size();
+        if ((format == OutputFormat::NdjsonEnvelope) && (samplesToGo <= 0)) {
+            output(QByteArray("]}\n")); // Close the envelope opened by metadataRead().
+        }
+        if (markClipping) {
+            for (const SaturationDetector::Segment &segment: clipped) {
+                outputClippingMarker(segment); // Following the batch that ended the run.
+            }
+        }
+    }
+    finishBatch();
+}
+
+/*!
+ * Outputs raw DSO \a samples, as little-endian 16-bit integers straight from the DSO's `Reading` notifications, for
+ * uncompressed binary output with nothing else requiring the decoded samples (see isPassthrough()).
+ *
+ * Since uncompressed binary records are little-endian 16-bit integers too, \a samples are appended to the output (and
+ * the WAV file, if any) verbatim, without ever being decoded. Only the saturation detector reads them.
+ */
+void DsoCommand::outputRawSamples(const QByteArray &samples)
+{
+    const qsizetype count = samples.size() / 2;
+    if (resendSkip > 0) {
+        // Skip the re-sent samples that were already output before the window stalled.
+        completionTimer->start();
+        if (count <= resendSkip) {
+            resendSkip -= count;
+            return;
+        }
+        outputRawSamples(samples.mid(std::exchange(resendSkip, 0) * 2));
+        return;
+    }
+
+    saturation.processRaw(samples); // For the end-of-capture warning, and ranging.
+    if (wav) {
+        wav->writeRaw(metadata, formatter.context((quint8)metadata.mode, metadata.range), samples);
+    }
+    outputBuffer.append(samples.constData(), count * 2); // Following the header written by metadataRead().
+    samplesToGo -= count;
+    finishBatch();
+}
+
+/*!
+ * Returns \c true if DSO samples are to be output without being decoded, via outputRawSamples(); that is, if the output
+ * format is uncompressed binary (which processOptions() already limits to unfiltered, untriggered, and unanalysed
+ * samples), and there are no publishers requiring decoded samples.
+ */
+bool DsoCommand::isPassthrough() const
+{
+    return (format == OutputFormat::Binary) && (!compressSamples) && (!ring) && (!mqtt) && (!influx);
+}
+
+/*!
+ * Completes the output of a batch of DSO samples, for outputSamples() and outputRawSamples(). That is, flushes the
+ * batch's output, and once the window is complete, either starts the next capture (or long capture segment), or
+ * disconnects.
+ */
+void DsoCommand::finishBatch()
+{
+    outputBatchComplete((service) ? service->receiveTimestamp() : -1);
+    if (samplesToGo > 0) {
+        completionTimer->start(); // Restarted with each batch, so only fires once the window has stalled.
+    } else {
+        completionTimer->stop();
     }
     if (samplesToGo <= 0) {
         qCInfo(lc).noquote() << tr("Finished fetching %Ln sample/s (with %L2 to remaining).",
             nullptr, metadata.numberOfSamples).arg(samplesToGo);
+        if (wav) {
+            wav->commit(); // So the file is valid up to this capture, even if the next never completes.
+        }
+        if ((longCapture.totalSamples > 0) && (service) && (metadata.numberOfSamples > 0) &&
+            ((longCapture.firstSample += metadata.numberOfSamples) < longCapture.totalSamples)) {
+            // Start the next segment straight away, with the same settings, to minimise the gap between segments.
+            longCapture.previousEnd = longCapture.segmentStart + (qint64)metadata.samplingWindow;
+            ++captureNumber;
+            service->startDso(segmentSettings(settings, longCapture));
+            return;
+        }
+        if (const std::optional<SaturationDetector::Segment> segment = saturation.flush();
+            (segment) && (markClipping)) {
+            outputClippingMarker(*segment); // The run continued to the end of the capture.
+            outputBatchComplete();
+        }
+        if (saturation.isSaturated()) {
+            qCWarning(lc).noquote() << tr("Capture has %Ln clipped sample/s, at the limit of range %1.", nullptr,
+                saturation.saturatedCount()).arg((service) ? service->toString(metadata.range, metadata.mode)
+                : QString::number(metadata.range));
+        }
+        if ((continuous) && (service)) {
+            // Restart straight away, rather than disconnecting, with the same settings, except perhaps the range.
+            ++captureNumber;
+            if (autoRange) {
+                const quint8 range = nextRange(*service->pokitProduct(), metadata.mode, metadata.range,
+                                               saturation.peak() * metadata.scale, saturation.isSaturated());
+                if (range != settings.range) {
+                    qCInfo(lc).noquote() << tr("Capture %L1 peaked at %2 (of range %3), so switching to range %4.")
+                        .arg(captureNumber).arg(qAbs(saturation.peak() * metadata.scale))
+                        .arg(service->toString(metadata.range, metadata.mode), service->toString(range, metadata.mode));
+                    settings.range = range;
+                }
+            } else if (saturation.isSaturated()) {
+                // Even with a fixed range, clipped captures are of little use, so step up to the next range (if any).
+                const quint8 range = SaturationDetector::nextRange(*service->pokitProduct(), metadata.mode,
+                                                                   settings.range);
+                if (range != settings.range) {
+                    qCInfo(lc).noquote() << tr("Capture %L1 clipped, so switching to range %2.").arg(captureNumber)
+                        .arg(service->toString(range, metadata.mode));
+                    settings.range = range;
+                }
+            }
+            service->startDso(settings);
+            return;
+        }
+        if (softwareTrigger) {
+            softwareTrigger->flush(); // Output the last segment, if any, even if not yet complete.
+        }
         if (device) disconnect(); // Will exit the application once disconnected.
     }
 }
+
+/*!
+ * Outputs DSO \a samples as raw (unscaled) device counts, in the selected output format, for the `raw` option.
+ *
+ * Integer counts are much cheaper to format than scaled values, and are lossless, while consumers can apply the
+ * scale declared by metadataRead() to all of the counts at once.
+ */
+void DsoCommand::outputRawCounts(const DsoService::Samples &samples)
+{
+    const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("sample_number,count\n"));
+        }
+        outputBuffer.reserve(outputBuffer.size() + samples.size() * 16); // Up to 16 bytes per sample number and count.
+        for (const qint16 sample: samples) {
+            MeasurementFormatter::appendCsvCount(outputBuffer, context, (qint64)++rawSampleNumber, sample);
+        }
+        break;
+    case OutputFormat::Ndjson:
+        outputBuffer.reserve(outputBuffer.size() + samples.size() * (context.ndjson.prefix.size() +
+                             context.ndjson.suffix.size() + 6)); // 6 bytes for the count.
+        for (const qint16 sample: samples) {
+            MeasurementFormatter::appendNdjsonCount(outputBuffer, context, QByteArray(), sample);
+        }
+        break;
+    case OutputFormat::NdjsonEnvelope: { // Appended to the envelope opened by metadataRead().
+        const qsizetype start = outputBuffer.size();
+        for (const qint16 sample: samples) {
+            appendNumber(outputBuffer.append(','), (qint64)sample);
+        }
+        if ((samplesToGo == metadata.numberOfSamples) && (outputBuffer.size() > start)) {
+            outputBuffer.remove(start, 1); // The envelope's first count has no preceding comma.
+        }
+    }   break;
+    case OutputFormat::Text:
+        for (const qint16 sample: samples) {
+            output(MeasurementFormatter::formatTextCount(context, QString::number(++rawSampleNumber), sample));
+        }
+        break;
+    default: // No other formats are supported by setRawCounts().
+        break;
+    }
+}
+
+/*!
+ * Invoked when no DSO samples have arrived for DsoCapture::defaultCompletionTimeout milliseconds, while the current
+ * window is still incomplete; that is, when one or more `Reading` notifications have been lost.
+ *
+ * Re-requests the whole window via DsoService::fetchSamples (skipping, in outputSamples(), whatever was already output)
+ * up to DsoCapture::defaultMaxResends times, before giving up, and exiting with an error, rather than hanging forever.
+ */
+void DsoCommand::captureTimedOut()
+{
+    if (samplesToGo <= 0) {
+        return;
+    }
+    const qint32 received = metadata.numberOfSamples - samplesToGo;
+    if ((service) && (resends < DsoCapture::defaultMaxResends)) {
+        ++resends;
+        qCWarning(lc).noquote() << tr("DSO capture stalled after %1 of %Ln sample/s; requesting resend %2 of %3.",
+            nullptr, metadata.numberOfSamples).arg(received).arg(resends).arg(DsoCapture::defaultMaxResends);
+        resending = true;
+        if (!service->fetchSamples()) {
+            qCWarning(lc).noquote() << tr("Failed to request resend %1.").arg(resends);
+        }
+        completionTimer->start(); // Try again (or give up) if the resend stalls too.
+        return;
+    }
+    qCWarning(lc).noquote() << tr("DSO capture incomplete: received %1 of %Ln sample/s.", nullptr,
+        metadata.numberOfSamples).arg(received);
+    samplesToGo = 0;
+    if (device) disconnect(EXIT_FAILURE); // Will exit the application once disconnected.
+}
+
+/*!
+ * Outputs DSO statistics \a summary in the selected output format.
+ */
+void DsoCommand::outputStatistics(const DsoStatistics::Summary &summary)
+{
+    const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+    const QString &unit = context.unit;
+    const QString &range = context.range;
+
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("count,minimum,maximum,peak_to_peak,mean,rms,standard_deviation,"
+                                           "frequency,unit,range\n"));
+        }
+        output(QString::fromLatin1("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10\n")
+            .arg(summary.count).arg(summary.minimum).arg(summary.maximum).arg(summary.peakToPeak)
+            .arg(summary.mean).arg(summary.rms).arg(summary.standardDeviation)
+            .arg(qIsNaN(summary.frequency) ? QString() : QString::number(summary.frequency), unit, range));
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope: {
+        QJsonObject object{
+            { u"count"_s,             (qint64)summary.count },
+            { u"minimum"_s,           summary.minimum },
+            { u"maximum"_s,           summary.maximum },
+            { u"peakToPeak"_s,        summary.peakToPeak },
+            { u"mean"_s,              summary.mean },
+            { u"rms"_s,               summary.rms },
+            { u"standardDeviation"_s, summary.standardDeviation },
+            { u"unit"_s,              unit },
+            { u"range"_s,             range },
+            { u"mode"_s,              context.mode },
+        };
+        if (!qIsNaN(summary.frequency)) {
+            object.insert(u"frequency"_s, summary.frequency);
+        }
+        output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+            : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Text:
+        output(tr("Samples:      %1\n").arg(summary.count));
+        output(tr("Minimum:      %1 %2\n").arg(summary.minimum).arg(unit));
+        output(tr("Maximum:      %1 %2\n").arg(summary.maximum).arg(unit));
+        output(tr("Peak-to-peak: %1 %2\n").arg(summary.peakToPeak).arg(unit));
+        output(tr("Mean:         %1 %2\n").arg(summary.mean).arg(unit));
+        output(tr("RMS:          %1 %2\n").arg(summary.rms).arg(unit));
+        output(tr("Std dev:      %1 %2\n").arg(summary.standardDeviation).arg(unit));
+        output(tr("Frequency:    %1\n").arg(qIsNaN(summary.frequency)
+            ? tr("N/A") : tr("%1 Hz").arg(summary.frequency)));
+        break;
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Outputs the DSO spectrum \a data of capture \a sequenceNumber in the selected output format.
+ */
+void DsoCommand::outputSpectrum(const DsoSpectrum::Spectrum &data, const quint64 sequenceNumber)
+{
+    const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+    const QString &unit = context.unit;
+    const QString &range = context.range;
+
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("capture,frequency,magnitude,unit\n"));
+        }
+        for (qsizetype bin = 0; bin < data.magnitudes.size(); ++bin) {
+            output(QString::fromLatin1("%1,%2,%3,%4\n").arg(sequenceNumber)
+                .arg((float)bin * data.resolution).arg(data.magnitudes.at(bin)).arg(unit));
+        }
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope: {
+        QJsonArray magnitudes;
+        for (const float magnitude: data.magnitudes) {
+            magnitudes.append(magnitude);
+        }
+        const QJsonDocument document(QJsonObject{
+                { u"capture"_s,    (qint64)sequenceNumber },
+                { u"resolution"_s, data.resolution },
+                { u"magnitudes"_s, magnitudes },
+                { u"unit"_s,       unit },
+                { u"range"_s,      range },
+                { u"mode"_s,       context.mode },
+            });
+        output((format == OutputFormat::Json) ? document.toJson() : document.toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Text:
+        for (qsizetype bin = 0; bin < data.magnitudes.size(); ++bin) {
+            output(tr("%1 Hz %2 %3\n").arg((float)bin * data.resolution)
+                .arg(data.magnitudes.at(bin)).arg(unit));
+        }
+        break;
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Outputs the software-triggered \a segment in the selected output format.
+ *
+ * CSV and Text output number each value by its position within the whole stream, as per untriggered output, and
+ * follow each segment with a marker, so that plotted segments are not joined together.
+ */
+void DsoCommand::outputTriggeredSegment(const SoftwareTrigger::Segment &segment)
+{
+    qCInfo(lc).noquote() << tr("Triggered at sample %L1, with %Ln sample/s.", nullptr, segment.values.size())
+        .arg(segment.triggerSample + 1);
+    const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+    qint64 sampleNumber = (qint64)segment.firstSample;
+
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("sample_number,value,unit,range\n"));
+        }
+        for (const float value: segment.values) {
+            MeasurementFormatter::appendCsv(outputBuffer, context, ++sampleNumber, value);
+        }
+        output(",," + context.unit.toUtf8() + ',' + context.range.toUtf8() + '\n'); // Breaks any plotted line.
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope: {
+        QJsonArray values;
+        for (const float value: segment.values) {
+            values.append(value);
+        }
+        const QJsonDocument document(QJsonObject{
+                { u"triggerSample"_s, (qint64)segment.triggerSample + 1 }, // One-based, as per the CSV sample_number.
+                { u"firstSample"_s,   (qint64)segment.firstSample + 1 },
+                { u"mode"_s,          context.mode },
+                { u"unit"_s,          context.unit },
+                { u"range"_s,         context.range },
+                { u"samplingRate"_s,  (qint64)metadata.samplingRate },
+                { u"values"_s,        values },
+            });
+        output((format == OutputFormat::Json) ? document.toJson() : document.toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:  // Rejected by processOptions().
+    case OutputFormat::LineProtocol: // Rejected by processOptions().
+    case OutputFormat::Binary: // Rejected by processOptions().
+        break;
+    case OutputFormat::Text:
+        output(tr("-- trigger %1, at sample %2 --\n").arg(softwareTrigger->triggerCount())
+            .arg(segment.triggerSample + 1));
+        for (const float value: segment.values) {
+            output(MeasurementFormatter::formatText(context, QString::number(++sampleNumber), value));
+        }
+        break;
+    }
+    outputBatchComplete();
+}
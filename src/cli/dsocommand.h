@@ -2,10 +2,22 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "devicecommand.h"
+#include "measurementformatter.h"
+#include "mqttpublisher.h"
+#include "wavwriter.h"
 
+#include <qtpokit/dsocapture.h>
 #include <qtpokit/dsoservice.h>
+#include <qtpokit/dsospectrum.h>
+#include <qtpokit/dsostatistics.h>
 #include <qtpokit/pokitmeter.h>
 #include <qtpokit/pokitpro.h>
+#include <qtpokit/samplefilter.h>
+#include <qtpokit/saturationdetector.h>
+#include <qtpokit/sharedsamplering.h>
+#include <qtpokit/softwaretrigger.h>
+
+class QTimer;
 
 class DsoCommand : public DeviceCommand
 {
@@ -21,12 +33,38 @@ public slots:
     QStringList processOptions(const QCommandLineParser &parser) override;
 
 protected:
+    bool supportsArrowOutput() const override;
+    bool supportsBinaryOutput() const override;
+    bool supportsLineProtocolOutput() const override;
+    bool supportsNdjsonOutput() const override;
+    bool supportsNdjsonEnvelopeOutput() const override;
     AbstractPokitService * getService() override;
 
 protected slots:
     void serviceDetailsDiscovered() override;
 
 private:
+    /// State of a long capture, stitched together from successive device captures (see the `long-capture` option).
+    struct LongCapture {
+        quint64 totalSamples { 0 }; ///< Total samples to capture, across all segments, or 0 if not a long capture.
+        quint32 totalWindow { 0 };  ///< Total sampling window, across all segments, in microseconds.
+        quint16 segmentSize { 0 };  ///< Maximum number of samples per segment (ie per device capture).
+        quint64 firstSample { 0 };  ///< Position, within the whole series, of the current segment's first sample.
+        qint64 segmentStart { -1 }; ///< Start of the current segment, in microseconds since the epoch, or -1.
+        qint64 previousEnd { -1 };  ///< Nominal end of the previous segment, in microseconds since the epoch, or -1.
+    };
+    /// Capture settings planned (see planAcquisition()) for the `bandwidth` and `duration` options.
+    struct AcquisitionPlan {
+        quint64 numberOfSamples { 0 };  ///< Total samples to capture, or 0 if the bandwidth cannot be captured.
+        quint32 samplingWindow { 0 };   ///< Total sampling window, in microseconds.
+        quint16 segmentSize { 0 };      ///< Maximum number of samples per device capture.
+        quint32 captures { 0 };         ///< Number of device captures, stitched together if more than one.
+        quint32 maximumBandwidth { 0 }; ///< Highest bandwidth the device can capture, in Hz.
+    };
+    static constexpr quint16 defaultSegmentSize { 8192 }; ///< Segment size, if the device's buffer size is unknown.
+    static constexpr quint16 defaultMaximumSamplingRate { 1000 }; ///< Sampling rate (kHz), if the device's is unknown.
+    static constexpr double oversampling { 2.5 }; ///< Planned sampling rate, as a multiple of the requested bandwidth.
+
     quint8 (* minRangeFunc)(const PokitProduct product, const quint32 maxValue) { nullptr };
     quint32 rangeOptionValue { 0 };   ///< The parsed value of range option.
     DsoService * service { nullptr }; ///< Bluetooth service this command interacts with.
@@ -36,12 +74,60 @@ private:
     };
     DsoService::Metadata metadata; ///< Most recent DSO metadata.
     qint32 samplesToGo { 0 };      ///< Number of samples we're expecting in the current window.
+    qint64 captureTimestamp { 0 }; ///< Start of the current window, in microseconds since the epoch.
+    qint64 rawSampleNumber { 0 };  ///< Number of the most recent raw count output, continuing across captures.
+    QTimer * completionTimer { nullptr }; ///< Re-requests the current window's samples, if they stop short.
+    int resends { 0 };             ///< Number of times the current window's samples have been re-requested.
+    bool resending { false };      ///< Whether a resend has been requested, but its metadata not yet received.
+    qint32 resendSkip { 0 };       ///< Number of re-sent samples still to skip, having been output already.
     bool showCsvHeader { true };   ///< Whether or not to show a header as the first line of CSV output.
+    bool continuous { false };     ///< Whether or not to restart the DSO after each capture.
+    bool autoRange { false };      ///< Whether to choose each continuous capture's range from the last one's peak.
+    SaturationDetector saturation; ///< Finds the current capture's clipped samples, and its peak.
+    bool markClipping { false };   ///< Whether to output a marker for each run of clipped samples.
+    quint64 captureNumber { 0 };   ///< Number of captures completed so far.
+    LongCapture longCapture;       ///< Long capture state, if the `long-capture` option was given.
+    quint32 plannedBandwidth { 0 }; ///< Highest frequency of interest, in Hz, if the `bandwidth` option was given.
+    quint32 plannedDuration { 0 };  ///< Duration to capture, in microseconds, if the `duration` option was given.
+    bool showStatistics { false }; ///< Whether to output per-capture statistics, instead of individual samples.
+    DsoStatistics * statistics { nullptr }; ///< Per-capture statistics, if #showStatistics is \c true.
+    bool showSpectrum { false };   ///< Whether to output per-capture spectra, instead of individual samples.
+    DsoCapture * capture { nullptr };   ///< Reassembles complete captures, if #showSpectrum is \c true.
+    DsoSpectrum * spectrum { nullptr }; ///< Per-capture spectrum analysis, if #showSpectrum is \c true.
+    SampleFilter * filter { nullptr };  ///< Filters the samples' values before output, if \c --filter was set.
+    QVector<float> values;              ///< The current batch of samples' scaled (and perhaps filtered) values.
+    SoftwareTrigger * softwareTrigger { nullptr }; ///< Selects segments to output, if \c --soft-trigger was set.
+    SharedSampleRing * ring { nullptr }; ///< Shared memory to publish samples to, if requested.
+    MqttPublisher * mqtt { nullptr };    ///< MQTT broker to publish samples to, if requested.
+    QString mqttTopic;                   ///< MQTT topic to publish samples to, once the device is known.
+    WavWriter * wav { nullptr };         ///< WAV file to write raw samples to, if \c --wav was set.
+    MeasurementFormatter formatter {     ///< Resolved (and cached) labels and fields, per mode and range.
+        [this](const quint8 mode, const quint8 range, const quint8) { return resolveContext(mode, range); } };
+
+    static QString toUnit(const DsoService::Mode mode);
+    static bool parseSoftwareTrigger(const QString &spec, SoftwareTrigger::Settings &settings);
+    MeasurementFormatter::Context resolveContext(const quint8 mode, const quint8 range) const;
+    static DsoService::Settings segmentSettings(const DsoService::Settings &settings, const LongCapture &capture);
+    static AcquisitionPlan planAcquisition(const quint32 bandwidth, const quint32 duration,
+                                           const quint16 maximumSamplingRate, const quint16 bufferSize);
+    bool applyAcquisitionPlan();
+    static quint8 nextRange(const PokitProduct product, const DsoService::Mode mode, const quint8 range,
+                            const float peak, const bool clipped);
+    void outputSegmentMarker(const quint64 segment, const quint64 firstSample, const qint64 start, const qint64 gap);
+    void outputClippingMarker(const SaturationDetector::Segment &segment);
+    void outputRawCounts(const DsoService::Samples &samples);
+    bool isPassthrough() const;
+    void finishBatch();
 
 private slots:
     void settingsWritten();
     void metadataRead(const DsoService::Metadata &data);
     void outputSamples(const DsoService::Samples &samples);
+    void outputRawSamples(const QByteArray &samples);
+    void outputStatistics(const DsoStatistics::Summary &summary);
+    void outputSpectrum(const DsoSpectrum::Spectrum &data, const quint64 sequenceNumber);
+    void outputTriggeredSegment(const SoftwareTrigger::Segment &segment);
+    void captureTimedOut();
 
     QTPOKIT_BEFRIEND_TEST(DsoCommand)
 };
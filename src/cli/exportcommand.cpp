@@ -0,0 +1,248 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "exportcommand.h"
+#include "shardedworkerpool.h"
+#include "../stringliterals_p.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+#include <algorithm>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class ExportCommand
+ *
+ * The ExportCommand class implements the `export` CLI command, converting logger archives (see LoggerArchive) to
+ * Apache Parquet files (see ParquetWriter), for offline analysis.
+ *
+ * Each `--archive` may be an archive file, or a directory of them, in which case every file in the directory that
+ * begins with an archive's magic bytes is converted. Each archive is written to its own Parquet file, named after the
+ * archive, with a `.parquet` suffix, beside the archive, or in `--output-dir`. Each archived session becomes a single
+ * row group, so tools can skip whole sessions when querying by time.
+ *
+ * Archives are converted concurrently, on a ShardedWorkerPool of `--workers` threads (one per core, by default), with
+ * one shard per archive. Archives are memory-mapped, and each worker holds only the columns of the single session it
+ * is converting, so memory use is bounded per worker, not by the size (or number) of archives. Archives that fail to
+ * convert are reported (with any partial Parquet file removed), and the command exits with a failure, but only once
+ * all other archives have been converted.
+ */
+
+/*!
+ * Construct a new ExportCommand object with \a parent.
+ */
+ExportCommand::ExportCommand(QObject * const parent) : AbstractCommand(parent)
+{
+
+}
+
+QStringList ExportCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser) + QStringList{
+        u"archive"_s,
+    };
+}
+
+QStringList ExportCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"output-dir"_s,
+        u"workers"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList ExportCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the output-dir option.
+    if (parser.isSet(u"output-dir"_s)) {
+        outputDir = parser.value(u"output-dir"_s);
+        if (!QFileInfo(outputDir).isDir()) {
+            errors.append(tr("Output directory does not exist: %1").arg(outputDir));
+        }
+    }
+
+    // Parse the workers option.
+    if (parser.isSet(u"workers"_s)) {
+        const QString value = parser.value(u"workers"_s).trimmed();
+        bool ok = (value.compare(u"auto"_s, Qt::CaseInsensitive) == 0);
+        threads = (ok) ? 0 : value.toInt(&ok); // 0 for one thread per core.
+        if ((!ok) || (threads < 0)) {
+            errors.append(tr("Invalid workers value: %1").arg(parser.value(u"workers"_s)));
+        }
+    }
+
+    // Parse the archive option/s.
+    exports.clear();
+    QSet<QString> outputs;
+    for (const QString &path: parser.values(u"archive"_s)) {
+        if (!QFileInfo::exists(path)) {
+            errors.append(tr("Archive does not exist: %1").arg(path));
+            continue;
+        }
+        const QStringList archives = findArchives(path);
+        if (archives.isEmpty()) {
+            errors.append(tr("No archives found in %1").arg(path));
+        }
+        for (const QString &archive: archives) {
+            const QString output = outputFileName(archive, outputDir);
+            if (outputs.contains(output)) {
+                errors.append(tr("More than one archive would be exported to %1").arg(output));
+                continue;
+            }
+            if (QFileInfo(output) == QFileInfo(archive)) {
+                errors.append(tr("Archive would be overwritten by its own export: %1").arg(archive));
+                continue;
+            }
+            outputs.insert(output);
+            exports.append({ archive, output, QString(), ParquetWriter::Statistics{} });
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Begins converting the archives, on the worker threads, and returns \c true. The command exits once all of the
+ * archives have been converted (or failed to).
+ */
+bool ExportCommand::start()
+{
+    finished = 0;
+    workers = new ShardedWorkerPool(threads, this);
+    connect(workers, &ShardedWorkerPool::outputReady, this,
+            [this](const int shard, const QByteArray &) { exportFinished(shard); });
+    qCInfo(lc).noquote() << tr("Exporting %Ln archive(s).", nullptr, (int)exports.size());
+
+    // Each job writes only its own export, which is not read here again until the job's completion is delivered.
+    for (int index = 0; index < exports.size(); ++index) {
+        Export * const item = &exports[index];
+        workers->submit(index, [item]() {
+            item->error = convert(item->archive, item->output, item->stats);
+            return QByteArray();
+        });
+    }
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscovered
+ *
+ * This override does nothing, since this command never scans for devices.
+ */
+void ExportCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_UNUSED(info)
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscoveryFinished
+ *
+ * This override does nothing, since this command never scans for devices.
+ */
+void ExportCommand::deviceDiscoveryFinished()
+{
+
+}
+
+/*!
+ * Reports the completion of the export at \a index, and exits once all exports have finished.
+ */
+void ExportCommand::exportFinished(const int index)
+{
+    const Export &item = exports.at(index);
+    if (item.error.isEmpty()) {
+        qCInfo(lc).noquote() << tr("Exported %Ln session(s), of %L1 sample(s), from %2 to %3 (%L4 bytes).", nullptr,
+            (int)item.stats.rowGroups).arg(item.stats.rows).arg(item.archive, item.output).arg(item.stats.bytes);
+    } else {
+        qCWarning(lc).noquote() << tr("Failed to export %1: %2").arg(item.archive, item.error);
+    }
+    if (++finished < exports.size()) {
+        return;
+    }
+    const auto failures = std::count_if(exports.cbegin(), exports.cend(),
+        [](const Export &item) { return !item.error.isEmpty(); });
+    if (failures > 0) {
+        qCWarning(lc).noquote() << tr("Failed to export %Ln of %1 archive(s).", nullptr, (int)failures)
+            .arg(exports.size());
+    }
+    QCoreApplication::exit((failures > 0) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*!
+ * Returns the archives at \a path: either \a path itself, if a file, or else every file in directory \a path that
+ * begins with an archive's magic bytes, in name order.
+ */
+QStringList ExportCommand::findArchives(const QString &path)
+{
+    if (!QFileInfo(path).isDir()) {
+        return { path };
+    }
+    QStringList archives;
+    const QDir dir(path);
+    for (const QString &name: dir.entryList(QDir::Files|QDir::Readable, QDir::Name)) {
+        QFile file(dir.filePath(name));
+        if ((file.open(QIODevice::ReadOnly)) && (file.read(4) == "DOKA")) {
+            archives.append(file.fileName());
+        }
+    }
+    return archives;
+}
+
+/*!
+ * Returns the name of the Parquet file to export \a archive to, ie the archive's name with a `.parquet` suffix
+ * (instead of any existing suffix), in \a outputDir, or beside the archive if \a outputDir is empty.
+ */
+QString ExportCommand::outputFileName(const QString &archive, const QString &outputDir)
+{
+    const QFileInfo info(archive);
+    const QString name = info.completeBaseName() + u".parquet"_s;
+    return QDir::cleanPath(((outputDir.isEmpty()) ? info.path() : outputDir) + u'/' + name);
+}
+
+/*!
+ * Converts \a archive to Parquet file \a output, one session at a time, and sets \a stats to the file's statistics.
+ * Returns an empty string on success, otherwise a description of the failure, having removed any partial \a output.
+ *
+ * This is called on worker threads, so uses only its own (thread-local) objects.
+ */
+QString ExportCommand::convert(const QString &archive, const QString &output, ParquetWriter::Statistics &stats)
+{
+    LoggerArchive source(archive);
+    if (!source.open()) {
+        return tr("Invalid, or unreadable, archive");
+    }
+    ParquetWriter writer;
+    writer.setSourceName(QFileInfo(archive).fileName());
+    if (!writer.open(output)) {
+        return writer.errorString();
+    }
+    for (qsizetype index = 0; index < source.sessionCount(); ++index) {
+        if (!writer.write(source.session(index), source.samples(index))) {
+            const QString error = writer.errorString();
+            writer.close();
+            QFile::remove(output);
+            return error;
+        }
+    }
+    if (!writer.close()) {
+        QFile::remove(output);
+        return writer.errorString();
+    }
+    stats = writer.statistics();
+    return QString();
+}
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_EXPORTCOMMAND_H
+#define DOKIT_EXPORTCOMMAND_H
+
+#include "abstractcommand.h"
+#include "parquetwriter.h"
+
+#include <QVector>
+
+class ShardedWorkerPool;
+
+class ExportCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit ExportCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+    static QStringList findArchives(const QString &path);
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// The conversion of a single archive file.
+    struct Export {
+        QString archive;                  ///< Archive file to convert.
+        QString output;                   ///< Parquet file to write.
+        QString error;                    ///< Why the conversion failed, or empty if it succeeded (or is pending).
+        ParquetWriter::Statistics stats;  ///< Statistics of the Parquet file written, once converted.
+    };
+
+    QVector<Export> exports;              ///< One export per archive file, in command line (then file name) order.
+    QString outputDir;                    ///< Directory to write Parquet files to, or empty for beside each archive.
+    int threads { 0 };                    ///< Maximum number of archives to convert at once, or 0 for one per core.
+    ShardedWorkerPool * workers { nullptr }; ///< Threads converting #exports, once started.
+    int finished { 0 };                   ///< Number of #exports finished (successfully, or not).
+
+    void exportFinished(const int index);
+
+    static QString outputFileName(const QString &archive, const QString &outputDir);
+    static QString convert(const QString &archive, const QString &output, ParquetWriter::Statistics &stats);
+
+    QTPOKIT_BEFRIEND_TEST(ExportCommand)
+};
+
+#endif // DOKIT_EXPORTCOMMAND_H
@@ -0,0 +1,722 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "exportercommand.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/pokitproducts.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class ExporterCommand
+ *
+ * The ExporterCommand class implements the `exporter` CLI command.
+ *
+ * This command reads the multimeter of each of the devices given via `--device` (and/or listed in a `--device-list`
+ * file), much like `meter-fleet`, but instead of outputting every reading, it serves a `/metrics` HTTP endpoint, in the
+ * Prometheus text exposition format (or OpenMetrics, if the scraper asks for it), for Prometheus (or any compatible
+ * scraper) to collect. The metrics include each device's latest reading (per mode, if `--mode` lists more than one, in
+ * which case each device measures them round-robin), its battery voltage and status (refreshed every minute), and its
+ * link statistics (see PokitDevice::Statistics).
+ *
+ * Since each device's values are updated in place as they arrive, rather than appended, the cost of each scrape is
+ * proportional to the number of devices, no matter how fast readings arrive. Devices that disconnect are reconnected
+ * automatically, and those that fail are retried periodically, since exporters are expected to run indefinitely.
+ */
+
+/*!
+ * Construct a new ExporterCommand object with \a parent.
+ */
+ExporterCommand::ExporterCommand(QObject * const parent) : AbstractCommand(parent)
+{
+
+}
+
+QStringList ExporterCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser) + QStringList{
+        u"mode"_s,
+    };
+}
+
+QStringList ExporterCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"device-list"_s,
+        u"dwell"_s,
+        u"interval"_s,
+        u"listen"_s,
+        u"max-connections"_s,
+        u"range"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList ExporterCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the device and device-list options, either (or both) of which may list multiple devices.
+    QStringList deviceNames = parser.values(u"device"_s);
+    if (parser.isSet(u"device-list"_s)) {
+        QFile file(parser.value(u"device-list"_s));
+        if (file.open(QIODevice::ReadOnly|QIODevice::Text)) {
+            deviceNames.append(readDeviceList(file));
+        } else {
+            errors.append(tr("Failed to open device list %1: %2").arg(file.fileName(), file.errorString()));
+        }
+    }
+    deviceNames = parseDeviceList(deviceNames);
+    devices.clear();
+    for (const QString &deviceName: deviceNames) {
+        devices.append(Exported{ deviceName });
+    }
+    devicesToScanFor = deviceNames;
+    if ((devices.isEmpty()) && (errors.isEmpty())) {
+        errors.append(tr("No devices to export"));
+    }
+
+    // Parse the (required) mode option, which may be a comma-separated list of modes to measure round-robin.
+    schedule.clear();
+    const QStringList modes = parser.value(u"mode"_s).split(u","_s);
+    for (const QString &value: modes) {
+        MeterCommand::MinRangeFunc rangeFunc = nullptr;
+        const MultimeterService::Mode mode = MeterCommand::parseMode(value, rangeFunc);
+        if (mode == MultimeterService::Mode::Idle) {
+            errors.append(tr("Unknown meter mode: %1").arg(value));
+            return errors;
+        }
+        if (schedule.isEmpty()) {
+            settings.mode = mode;
+            minRangeFunc = rangeFunc;
+        }
+        // Scheduled modes are always auto-ranged, and all products' AutoRange enumerators share the same value.
+        schedule.append({ mode, (rangeFunc == nullptr) ? quint8(0) : +PokitMeter::VoltageRange::AutoRange,
+                          dwellTime });
+    }
+    if (schedule.size() == 1) {
+        schedule.clear(); // Just a single mode, so nothing to schedule.
+    }
+
+    // Parse the dwell option.
+    if (parser.isSet(u"dwell"_s)) {
+        const QString value = parser.value(u"dwell"_s);
+        const quint32 dwell = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (dwell == 0) {
+            errors.append(tr("Invalid dwell value: %1").arg(value));
+        } else if (schedule.isEmpty()) {
+            errors.append(tr("The dwell option requires multiple modes"));
+        } else {
+            dwellTime = dwell;
+        }
+    }
+    for (MeterScheduler::Entry &entry: schedule) {
+        entry.dwell = dwellTime;
+    }
+
+    // Parse the interval option.
+    if (parser.isSet(u"interval"_s)) {
+        const QString value = parser.value(u"interval"_s);
+        const quint32 interval = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (interval == 0) {
+            errors.append(tr("Invalid interval value: %1").arg(value));
+        } else {
+            settings.updateInterval = interval;
+        }
+    }
+
+    // Parse the listen option, being a port, optionally preceded by an address (IPv6 addresses in brackets).
+    if (parser.isSet(u"listen"_s)) {
+        const QString value = parser.value(u"listen"_s).trimmed();
+        const qsizetype colon = value.lastIndexOf(u':');
+        QString host = (colon < 0) ? QString() : value.left(colon);
+        bool ok = false;
+        const uint port = value.mid(colon + 1).toUInt(&ok);
+        if ((host.startsWith(u'[')) && (host.endsWith(u']'))) {
+            host = host.mid(1, host.size() - 2);
+        }
+        const QHostAddress address = (host.isEmpty()) ? QHostAddress(QHostAddress::LocalHost)
+            : (host == u"*"_s) ? QHostAddress(QHostAddress::Any)
+            : (host.compare(u"localhost"_s, Qt::CaseInsensitive) == 0) ? QHostAddress(QHostAddress::LocalHost)
+            : QHostAddress(host);
+        if ((!ok) || (port == 0) || (port > std::numeric_limits<quint16>::max()) || (address.isNull())) {
+            errors.append(tr("Invalid listen value: %1").arg(value));
+        } else {
+            listenAddress = address;
+            listenPort = (quint16)port;
+        }
+    }
+
+    // Parse the max-connections option.
+    if (parser.isSet(u"max-connections"_s)) {
+        const QString value = parser.value(u"max-connections"_s);
+        bool ok;
+        const int connections = value.toInt(&ok);
+        if ((!ok) || (connections <= 0)) {
+            errors.append(tr("Invalid max-connections value: %1").arg(value));
+        } else {
+            maxConnections = connections;
+        }
+    }
+
+    // Parse the range option.
+    rangeOptionValue = 0; // Default to auto.
+    if (parser.isSet(u"range"_s)) {
+        const QString value = parser.value(u"range"_s);
+        if (value.trimmed().compare(u"auto"_s, Qt::CaseInsensitive) != 0) {
+            rangeOptionValue = MeterCommand::parseRange(value, settings.mode);
+            if ((minRangeFunc != nullptr) && (rangeOptionValue == 0)) {
+                errors.append(tr("Invalid range value: %1").arg(value));
+            }
+            if (!schedule.isEmpty()) {
+                errors.append(tr("The range option is only supported for a single mode"));
+            }
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Begins listening for scrapes, and scanning for the requested Pokit devices.
+ */
+bool ExporterCommand::start()
+{
+    server = new QTcpServer(this);
+    if (!server->listen(listenAddress, listenPort)) {
+        qCWarning(lc).noquote() << tr("Failed to listen on %1 port %2: %3").arg(listenAddress.toString())
+            .arg(listenPort).arg(server->errorString());
+        return false;
+    }
+    connect(server, &QTcpServer::newConnection, this, &ExporterCommand::newConnection);
+    qCInfo(lc).noquote() << tr("Serving metrics at http://%1:%2/metrics").arg(
+        (listenAddress.protocol() == QAbstractSocket::IPv6Protocol) ? u"[%1]"_s.arg(listenAddress.toString())
+            : listenAddress.toString()).arg(server->serverPort());
+
+    statusTimer = new QTimer(this);
+    connect(statusTimer, &QTimer::timeout, this, &ExporterCommand::readStatus);
+    statusTimer->start(statusInterval);
+
+    qCInfo(lc).noquote() << tr("Looking for %Ln Pokit device/s...", nullptr, devices.size());
+    discoveryAgent->start();
+    return true;
+}
+
+/*!
+ * Checks if \a info is one of the (not yet discovered) devices to export, and if so, creates a device and its services,
+ * and queues it for connection.
+ */
+void ExporterCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_ASSERT(isPokitProduct(info));
+
+    const QString deviceName = takeDevice(info);
+    const auto iter = std::find_if(devices.begin(), devices.end(), [&deviceName](const Exported &exported) {
+        return (!deviceName.isNull()) && (exported.deviceName == deviceName);
+    });
+    if (iter == devices.end()) {
+        qCDebug(lc).noquote() << tr(R"(Ignoring non-requested Pokit device "%1" (%2) at (%3).)")
+            .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+        return;
+    }
+
+    const int index = (int)(iter - devices.begin());
+    qCDebug(lc).noquote() << tr(R"(Found Pokit device "%1" (%2) at (%3).)")
+        .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+    Exported &exported = *iter;
+    exported.rssi = info.rssi();
+    exported.device = new PokitDevice(info, this);
+    exported.service = exported.device->multimeter();
+    exported.status = exported.device->status();
+    Q_ASSERT(exported.service);
+    Q_ASSERT(exported.status);
+    exported.service->setPokitProduct(pokitProduct(info));
+    exported.status->setPokitProduct(pokitProduct(info));
+
+    // Exporters run indefinitely, so keep reconnecting (with backoff) to devices that disconnect unexpectedly.
+    PokitDevice::ReconnectPolicy policy;
+    policy.maximumAttempts = std::numeric_limits<int>::max();
+    exported.device->setReconnectPolicy(policy);
+    connect(exported.device, &PokitDevice::reconnectFailed, this, [this, index]() { deviceFailed(index); });
+
+    const QLowEnergyController * const controller = exported.device->controller();
+    connect(controller, &QLowEnergyController::connected, this, [this, index]() { devices[index].up = true; });
+    connect(controller, &QLowEnergyController::disconnected, this, [this, index]() {
+        devices[index].up = false;
+        if (!devices.at(index).device->isReconnecting()) {
+            deviceFailed(index);
+        }
+    });
+    connect(controller,
+        #if (QT_VERSION < QT_VERSION_CHECK(6, 2, 0))
+        QOverload<QLowEnergyController::Error>::of(&QLowEnergyController::error),
+        #else
+        &QLowEnergyController::errorOccurred,
+        #endif
+        this, [this, index](const QLowEnergyController::Error error) {
+            qCWarning(lc).noquote() << tr(R"(Bluetooth controller error for device "%1":)")
+                .arg(devices.at(index).deviceName) << error;
+            if (!devices.at(index).device->isReconnecting()) {
+                deviceFailed(index);
+            }
+        }, Qt::QueuedConnection);
+    connect(exported.service, &AbstractPokitService::serviceDetailsDiscovered, this, [this, index]() {
+        configureMeter(index);
+    });
+    connect(exported.service, &AbstractPokitService::serviceErrorOccurred,
+        this, [this, index](const QLowEnergyService::ServiceError error) {
+            qCWarning(lc).noquote() << tr(R"(Bluetooth service error for device "%1":)")
+                .arg(devices.at(index).deviceName) << error;
+        });
+    connect(exported.service, &MultimeterService::settingsWritten, this, [this, index]() { settingsWritten(index); });
+    connect(exported.status, &AbstractPokitService::serviceDetailsDiscovered, exported.status,
+            &StatusService::readStatusCharacteristic);
+    connect(exported.status, &StatusService::deviceStatusRead, this,
+            [this, index](const StatusService::Status &status) { devices[index].deviceStatus = status; });
+
+    if (!schedule.isEmpty()) {
+        exported.scheduler = new MeterScheduler(exported.service, this);
+        exported.scheduler->setEntries(schedule);
+        exported.scheduler->setUpdateInterval(settings.updateInterval);
+        connect(exported.scheduler, &MeterScheduler::readingReady, this,
+            [this, index](const MultimeterService::Reading &reading) { recordReading(index, reading); });
+    }
+
+    pending.append(index);
+    connectPending();
+}
+
+/*!
+ * Reports any requested devices that have not been discovered yet, and keeps looking for them.
+ */
+void ExporterCommand::deviceDiscoveryFinished()
+{
+    if (devicesToScanFor.isEmpty()) {
+        return; // takeDevice() stopped discovery, since all requested devices were found.
+    }
+    qCWarning(lc).noquote() << tr("Still looking for %Ln device/s: %1", nullptr, devicesToScanFor.size())
+        .arg(devicesToScanFor.join(u", "_s));
+    QTimer::singleShot(retryInterval, discoveryAgent, [this]() { discoveryAgent->start(); });
+}
+
+/*!
+ * Begins connecting to pending devices, until either there are no more pending devices, or the maximum number of
+ * concurrent connections has been reached.
+ */
+void ExporterCommand::connectPending()
+{
+    while ((activeConnections < maxConnections) && (!pending.isEmpty())) {
+        Exported &exported = devices[pending.takeFirst()];
+        Q_ASSERT(exported.device);
+        Q_ASSERT(!exported.connected);
+        exported.connected = true;
+        ++activeConnections;
+        qCDebug(lc).noquote() << tr(R"(Connecting to device "%1" (%2 of %3 connections).)")
+            .arg(exported.deviceName).arg(activeConnections).arg(maxConnections);
+        exported.device->controller()->connectToDevice();
+    }
+}
+
+/*!
+ * Begins measuring on the device at \a index, once its service details have been discovered (including after each
+ * automatic reconnection).
+ */
+void ExporterCommand::configureMeter(const int index)
+{
+    Exported &exported = devices[index];
+    if (exported.scheduler) {
+        exported.scheduler->stop();
+        exported.scheduler->start();
+        return;
+    }
+    MultimeterService::Settings deviceSettings = settings;
+    deviceSettings.range = (minRangeFunc == nullptr)
+        ? 0 : minRangeFunc(*exported.service->pokitProduct(), rangeOptionValue);
+    qCInfo(lc).noquote() << tr(R"(Measuring %1 on device "%2", every %L3ms.)").arg(
+        MultimeterService::toString(deviceSettings.mode), exported.deviceName).arg(deviceSettings.updateInterval);
+    exported.service->setSettings(deviceSettings);
+}
+
+/*!
+ * Invoked when the multimeter settings have been written to the device at \a index, to begin reading its values.
+ */
+void ExporterCommand::settingsWritten(const int index)
+{
+    MultimeterService * const service = devices.at(index).service;
+    if (devices.at(index).scheduler) {
+        return; // The scheduler handles its own settings, and readings.
+    }
+    connect(service, &MultimeterService::readingRead, this,
+            [this, index](const MultimeterService::Reading &reading) { recordReading(index, reading); },
+            Qt::UniqueConnection);
+    service->enableReadingNotifications();
+}
+
+/*!
+ * Records \a reading as the latest, in its mode, from the device at \a index, replacing any earlier reading.
+ */
+void ExporterCommand::recordReading(const int index, const MultimeterService::Reading &reading)
+{
+    Latest &latest = devices[index].readings[reading.mode];
+    latest.reading = reading;
+    latest.timestamp = QDateTime::currentMSecsSinceEpoch();
+    ++latest.count;
+}
+
+/*!
+ * Requests a fresh status from each connected device, so that battery levels are kept up to date.
+ */
+void ExporterCommand::readStatus()
+{
+    for (const Exported &exported: devices) {
+        if ((exported.up) && (exported.status)) {
+            exported.status->readStatusCharacteristic();
+        }
+    }
+}
+
+/*!
+ * Frees the connection used by the device at \a index, which has failed (or disconnected, without reconnecting), and
+ * queues it to be retried later.
+ */
+void ExporterCommand::deviceFailed(const int index)
+{
+    Exported &exported = devices[index];
+    exported.up = false;
+    if (!exported.connected) {
+        return; // Already failed, such as by a controller error before disconnecting.
+    }
+    qCWarning(lc).noquote() << tr(R"(Lost device "%1"; retrying in %L2ms.)").arg(exported.deviceName)
+        .arg(retryInterval);
+    exported.connected = false;
+    --activeConnections;
+    if (exported.device->controller()->state() != QLowEnergyController::UnconnectedState) {
+        exported.device->disconnectFromDevice();
+    }
+    QTimer::singleShot(retryInterval, this, [this, index]() {
+        if ((!devices.at(index).connected) && (!pending.contains(index))) {
+            pending.append(index);
+            connectPending();
+        }
+    });
+    connectPending();
+}
+
+/*!
+ * Accepts new HTTP clients, such as Prometheus scrapes.
+ */
+void ExporterCommand::newConnection()
+{
+    while (QTcpSocket * const client = server->nextPendingConnection()) {
+        connect(client, &QTcpSocket::readyRead, this, [this, client]() { readRequest(client); });
+        connect(client, &QTcpSocket::disconnected, client, &QObject::deleteLater);
+    }
+}
+
+/*!
+ * Reads (the head of) an HTTP request from \a client, and once complete, responds, and closes the connection.
+ */
+void ExporterCommand::readRequest(QTcpSocket * const client)
+{
+    QByteArray request = client->property("request").toByteArray() + client->readAll();
+    if ((!request.contains("\r\n\r\n")) && (!request.contains("\n\n"))) {
+        if (request.size() > maxRequestSize) {
+            client->write(httpResponse(431, "Request Header Fields Too Large", "text/plain; charset=utf-8",
+                                       "Request too large\n"));
+            client->disconnectFromHost();
+        } else {
+            client->setProperty("request", request); // Wait for the rest of the request.
+        }
+        return;
+    }
+    client->write(handleRequest(request));
+    client->disconnectFromHost(); // Flushes the response first.
+}
+
+/*!
+ * Returns the HTTP response to \a request. Only `GET` (and `HEAD`) requests for `/metrics` are supported.
+ *
+ * Scrapers that accept `application/openmetrics-text` receive OpenMetrics, and all others, the Prometheus text
+ * exposition format.
+ */
+QByteArray ExporterCommand::handleRequest(const QByteArray &request)
+{
+    const QList<QByteArray> lines = request.split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3) {
+        return httpResponse(400, "Bad Request", "text/plain; charset=utf-8", "Bad request\n");
+    }
+    const QByteArray &method = requestLine.at(0);
+    const QByteArray path = requestLine.at(1).split('?').first();
+    if (path != "/metrics") {
+        return httpResponse(404, "Not Found", "text/plain; charset=utf-8", "Metrics are at /metrics\n");
+    }
+    if ((method != "GET") && (method != "HEAD")) {
+        return httpResponse(405, "Method Not Allowed", "text/plain; charset=utf-8", "Method not allowed\n");
+    }
+    bool openMetrics = false;
+    for (const QByteArray &line: lines) {
+        if (line.toLower().startsWith("accept:") && line.contains("application/openmetrics-text")) {
+            openMetrics = true;
+        }
+    }
+    ++scrapes;
+    return httpResponse(200, "OK", (openMetrics)
+        ? "application/openmetrics-text; version=1.0.0; charset=utf-8"
+        : "text/plain; version=0.0.4; charset=utf-8", metrics(openMetrics), method == "GET");
+}
+
+/*!
+ * Returns the current value of all metrics, in either the OpenMetrics (if \a openMetrics is \c true), or Prometheus
+ * text exposition format. The two are identical, except for counters' metadata, and OpenMetrics' trailing `# EOF`.
+ */
+QByteArray ExporterCommand::metrics(const bool openMetrics) const
+{
+    constexpr int floatPrecision { 7 }; // Enough for single-precision readings, without spurious trailing digits.
+    QByteArray text;
+    const auto family = [&text, openMetrics](const QByteArray &name, const QByteArray &type, const QByteArray &help) {
+        // OpenMetrics names counter (and info) families without their samples' suffix, and the older Prometheus
+        // format has no stateset, or info, types, so they are plain gauges there.
+        const QByteArray familyName = (!openMetrics) ? name : (type == "counter") ? name.left(name.size() - 6)
+            : (type == "info") ? name.left(name.size() - 5) : name;
+        const QByteArray familyType = ((openMetrics) || (type == "counter") || (type == "histogram")) ? type
+            : "gauge";
+        text += "# HELP " + familyName + ' ' + help + "\n# TYPE " + familyName + ' ' + familyType + '\n';
+    };
+    const auto sample = [&text](const QByteArray &name, const QByteArray &labels, const double value,
+                                const int precision = 15) {
+        text += name + '{' + labels + "} " + formatValue(value, precision) + '\n';
+    };
+    const auto deviceLabel = [](const Exported &exported) {
+        return "device=\"" + escapeLabelValue(exported.deviceName) + '"';
+    };
+
+    family("pokit_up", "gauge", "Whether the device is currently connected.");
+    for (const Exported &exported: devices) {
+        sample("pokit_up", deviceLabel(exported), (exported.up) ? 1 : 0);
+    }
+    family("pokit_rssi_dbm", "gauge", "Signal strength of the device, when last discovered.");
+    for (const Exported &exported: devices) {
+        if (exported.device) {
+            sample("pokit_rssi_dbm", deviceLabel(exported), exported.rssi);
+        }
+    }
+
+    // Latest meter readings, per device and mode.
+    family("pokit_meter_reading", "gauge", "Latest multimeter reading, in the mode's unit.");
+    for (const Exported &exported: devices) {
+        for (auto iter = exported.readings.cbegin(); iter != exported.readings.cend(); ++iter) {
+            sample("pokit_meter_reading", deviceLabel(exported) + ",mode=\"" +
+                   escapeLabelValue(MultimeterService::toString(iter.key())) + "\",unit=\"" +
+                   escapeLabelValue(MeterCommand::toUnit(iter.key())) + '"', iter->reading.value, floatPrecision);
+        }
+    }
+    family("pokit_meter_reading_timestamp_seconds", "gauge", "Time of the latest multimeter reading.");
+    for (const Exported &exported: devices) {
+        for (auto iter = exported.readings.cbegin(); iter != exported.readings.cend(); ++iter) {
+            sample("pokit_meter_reading_timestamp_seconds", deviceLabel(exported) + ",mode=\"" +
+                   escapeLabelValue(MultimeterService::toString(iter.key())) + '"', iter->timestamp / 1000.0);
+        }
+    }
+    family("pokit_meter_readings_total", "counter", "Number of multimeter readings received.");
+    for (const Exported &exported: devices) {
+        for (auto iter = exported.readings.cbegin(); iter != exported.readings.cend(); ++iter) {
+            sample("pokit_meter_readings_total", deviceLabel(exported) + ",mode=\"" +
+                   escapeLabelValue(MultimeterService::toString(iter.key())) + '"', (double)iter->count);
+        }
+    }
+
+    // Device status, including battery.
+    family("pokit_battery_voltage_volts", "gauge", "Battery voltage.");
+    for (const Exported &exported: devices) {
+        if (exported.deviceStatus) {
+            sample("pokit_battery_voltage_volts", deviceLabel(exported), exported.deviceStatus->batteryVoltage,
+                   floatPrecision);
+        }
+    }
+    family("pokit_battery_status", "stateset", "Logical interpretation of the battery voltage.");
+    for (const Exported &exported: devices) {
+        if (exported.deviceStatus) {
+            for (const StatusService::BatteryStatus status: {
+                 StatusService::BatteryStatus::Low, StatusService::BatteryStatus::Good }) {
+                sample("pokit_battery_status", deviceLabel(exported) + ",pokit_battery_status=\"" +
+                       escapeLabelValue(StatusService::toString(status)) + '"',
+                       (exported.deviceStatus->batteryStatus == status) ? 1 : 0);
+            }
+        }
+    }
+    family("pokit_charging_status", "stateset", "Battery charging status, if supported by the device.");
+    for (const Exported &exported: devices) {
+        if ((exported.deviceStatus) && (exported.deviceStatus->chargingStatus)) {
+            for (const StatusService::ChargingStatus status: { StatusService::ChargingStatus::Discharging,
+                 StatusService::ChargingStatus::Charging, StatusService::ChargingStatus::Charged }) {
+                sample("pokit_charging_status", deviceLabel(exported) + ",pokit_charging_status=\"" +
+                       escapeLabelValue(StatusService::toString(status)) + '"',
+                       (*exported.deviceStatus->chargingStatus == status) ? 1 : 0);
+            }
+        }
+    }
+    family("pokit_device_status_info", "info", "Current device status.");
+    for (const Exported &exported: devices) {
+        if (exported.deviceStatus) {
+            sample("pokit_device_status_info", deviceLabel(exported) + ",status=\"" +
+                   escapeLabelValue(StatusService::toString(exported.deviceStatus->deviceStatus)) + '"', 1);
+        }
+    }
+
+    // Link statistics, per device, and per service.
+    struct DeviceCounter {
+        QByteArray name, help;
+        quint64 PokitDevice::Statistics::* member;
+    };
+    static const DeviceCounter deviceCounters[] {
+        { "pokit_connections_total", "Number of times the device has connected, including reconnections.",
+          &PokitDevice::Statistics::connections },
+        { "pokit_disconnections_total", "Number of times the device has disconnected.",
+          &PokitDevice::Statistics::disconnections },
+        { "pokit_reconnections_total", "Number of successful automatic reconnections.",
+          &PokitDevice::Statistics::reconnections },
+        { "pokit_reconnect_failures_total", "Number of times all automatic reconnection attempts have failed.",
+          &PokitDevice::Statistics::reconnectFailures },
+        { "pokit_errors_total", "Number of Bluetooth controller errors.", &PokitDevice::Statistics::errors },
+    };
+    struct ServiceCounter {
+        QByteArray name, help;
+        quint64 AbstractPokitService::Statistics::* member;
+    };
+    static const ServiceCounter serviceCounters[] {
+        { "pokit_service_notifications_total", "Number of characteristic notifications received.",
+          &AbstractPokitService::Statistics::notifications },
+        { "pokit_service_reads_total", "Number of characteristic reads completed.",
+          &AbstractPokitService::Statistics::reads },
+        { "pokit_service_received_bytes_total", "Number of characteristic value bytes received.",
+          &AbstractPokitService::Statistics::bytes },
+        { "pokit_service_parse_failures_total", "Number of malformed characteristic values received.",
+          &AbstractPokitService::Statistics::parseFailures },
+        { "pokit_service_errors_total", "Number of service (GATT) errors.",
+          &AbstractPokitService::Statistics::errors },
+        { "pokit_service_stalls_total", "Number of notification stalls detected.",
+          &AbstractPokitService::Statistics::stalls },
+        { "pokit_service_stall_recoveries_total", "Number of notification stalls recovered from.",
+          &AbstractPokitService::Statistics::stallRecoveries },
+    };
+
+    QVector<PokitDevice::Statistics> statistics(devices.size());
+    for (int index = 0; index < devices.size(); ++index) {
+        if (devices.at(index).device) {
+            statistics[index] = devices.at(index).device->statistics();
+        }
+    }
+    for (const DeviceCounter &counter: deviceCounters) {
+        family(counter.name, "counter", counter.help);
+        for (int index = 0; index < devices.size(); ++index) {
+            if (devices.at(index).device) {
+                sample(counter.name, deviceLabel(devices.at(index)), (double)(statistics.at(index).*counter.member));
+            }
+        }
+    }
+    const auto serviceLabels = [&deviceLabel](const Exported &exported, const AbstractPokitService::Statistics &stats) {
+        QString name = PokitDevice::serviceToString(stats.service);
+        if (name.isEmpty()) {
+            name = (stats.service.isNull()) ? u"unknown"_s : stats.service.toString(QUuid::WithoutBraces);
+        }
+        return deviceLabel(exported) + ",service=\"" + escapeLabelValue(name) + '"';
+    };
+    for (const ServiceCounter &counter: serviceCounters) {
+        family(counter.name, "counter", counter.help);
+        for (int index = 0; index < devices.size(); ++index) {
+            for (const AbstractPokitService::Statistics &stats: statistics.at(index).services) {
+                sample(counter.name, serviceLabels(devices.at(index), stats), (double)(stats.*counter.member));
+            }
+        }
+    }
+
+    // Notification intervals, as a (cumulative) histogram, in seconds. The sum of intervals is not tracked.
+    family("pokit_service_notification_interval_seconds", "histogram", "Intervals between consecutive notifications.");
+    for (int index = 0; index < devices.size(); ++index) {
+        for (const AbstractPokitService::Statistics &stats: statistics.at(index).services) {
+            const QByteArray labels = serviceLabels(devices.at(index), stats);
+            quint64 cumulative = 0;
+            for (int bucket = 0; bucket < stats.notificationGaps.size(); ++bucket) {
+                cumulative += stats.notificationGaps.at(bucket);
+                const QByteArray upperBound = (bucket == stats.notificationGaps.size() - 1) ? "+Inf"
+                    : formatValue((1 << bucket) / 1000.0);
+                sample("pokit_service_notification_interval_seconds_bucket",
+                       labels + ",le=\"" + upperBound + '"', (double)cumulative);
+            }
+            sample("pokit_service_notification_interval_seconds_count", labels, (double)cumulative);
+        }
+    }
+
+    family("pokit_exporter_scrapes_total", "counter", "Number of metrics requests served by this exporter.");
+    text += "pokit_exporter_scrapes_total " + formatValue((double)scrapes) + '\n';
+    if (openMetrics) {
+        text += "# EOF\n";
+    }
+    return text;
+}
+
+/*!
+ * Returns \a value escaped for use as a metric label value. That is, with any backslashes, double-quotes, and
+ * newlines escaped by a backslash.
+ */
+QByteArray ExporterCommand::escapeLabelValue(const QString &value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+
+/*!
+ * Returns \a value formatted as a metric sample value, with up to \a precision significant digits, including the
+ * exposition formats' special values for infinities (such as a multimeter's open circuit), and NaN.
+ */
+QByteArray ExporterCommand::formatValue(const double value, const int precision)
+{
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return (value > 0) ? "+Inf" : "-Inf";
+    }
+    return QByteArray::number(value, 'g', precision);
+}
+
+/*!
+ * Returns a complete HTTP/1.1 response, with \a status code and \a reason phrase, and \a body of \a contentType. The
+ * \a body is omitted (but still counted by Content-Length) if \a includeBody is \c false, as for `HEAD` requests.
+ */
+QByteArray ExporterCommand::httpResponse(const int status, const QByteArray &reason, const QByteArray &contentType,
+                                         const QByteArray &body, const bool includeBody)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reason + "\r\n"
+        "Content-Type: " + contentType + "\r\n"
+        "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    if (status == 405) {
+        response += "Allow: GET, HEAD\r\n";
+    }
+    response += "Connection: close\r\n\r\n";
+    if (includeBody) {
+        response += body;
+    }
+    return response;
+}
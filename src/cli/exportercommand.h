@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+#include "metercommand.h"
+
+#include <qtpokit/meterscheduler.h>
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/statusservice.h>
+
+#include <QHostAddress>
+#include <QMap>
+#include <QVector>
+
+#include <optional>
+
+QTPOKIT_USE_NAMESPACE
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+class ExporterCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit ExporterCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// Most recent reading of a single multimeter mode.
+    struct Latest {
+        MultimeterService::Reading reading { }; ///< Most recent reading.
+        qint64 timestamp { 0 };                 ///< Arrival of #reading, in milliseconds since the epoch.
+        quint64 count { 0 };                    ///< Number of readings received in this mode so far.
+    };
+
+    /// Latest state of a single requested device, updated in place as each new value arrives.
+    struct Exported {
+        QString deviceName;                      ///< Device, as requested, to label metrics with.
+        PokitDevice * device { nullptr };        ///< Discovered device, or \c nullptr if not (yet) discovered.
+        MultimeterService * service { nullptr }; ///< Discovered device's multimeter service.
+        StatusService * status { nullptr };      ///< Discovered device's status service.
+        MeterScheduler * scheduler { nullptr };  ///< Round-robin measurement, if more than one mode was requested.
+        qint16 rssi { 0 };                       ///< Signal strength, in dBm, when last discovered.
+        bool connected { false };                ///< Whether a connection to #device has been started.
+        bool up { false };                       ///< Whether #device is currently connected.
+        QMap<MultimeterService::Mode, Latest> readings;  ///< Most recent readings, by mode.
+        std::optional<StatusService::Status> deviceStatus; ///< Most recent status, if read yet.
+    };
+
+    QHostAddress listenAddress { QHostAddress::LocalHost }; ///< Address to listen for scrapes on.
+    quint16 listenPort { 9464 };                ///< Port to listen for scrapes on.
+    QTcpServer * server { nullptr };            ///< HTTP server, for Prometheus (or similar) to scrape.
+    QVector<Exported> devices;                  ///< One entry per requested device, in command line order.
+    QVector<int> pending;                       ///< Indexes of discovered #devices, waiting for a free connection.
+    int activeConnections { 0 };                ///< Number of devices currently connected, or connecting.
+    int maxConnections { 3 };                   ///< Maximum number of concurrent device connections.
+    MeterCommand::MinRangeFunc minRangeFunc { nullptr }; ///< Converts #rangeOptionValue to each product's range.
+    quint32 rangeOptionValue { 0 };             ///< The parsed value of range option, if one was supplied.
+    MultimeterService::Settings settings        ///< Settings for every device's multimeter mode.
+        { MultimeterService::Mode::DcVoltage, 0, 1000 };
+    QVector<MeterScheduler::Entry> schedule;    ///< Modes to measure round-robin, if more than one was requested.
+    quint32 dwellTime { 10000 };                ///< Time to spend measuring each scheduled mode, in milliseconds.
+    QTimer * statusTimer { nullptr };           ///< Periodically refreshes each connected device's status.
+    quint64 scrapes { 0 };                      ///< Number of metrics requests served.
+
+    static constexpr int statusInterval { 60000 }; ///< Interval between status reads, in milliseconds.
+    static constexpr int retryInterval { 30000 };  ///< Delay before retrying a failed device, in milliseconds.
+    static constexpr qint64 maxRequestSize { 8 * 1024 }; ///< Maximum size of an HTTP request's head.
+
+    void connectPending();
+    void configureMeter(const int index);
+    void settingsWritten(const int index);
+    void recordReading(const int index, const MultimeterService::Reading &reading);
+    void readStatus();
+    void deviceFailed(const int index);
+
+    void newConnection();
+    void readRequest(QTcpSocket * const client);
+    QByteArray handleRequest(const QByteArray &request);
+    QByteArray metrics(const bool openMetrics) const;
+
+    static QByteArray escapeLabelValue(const QString &value);
+    static QByteArray formatValue(const double value, const int precision = 15);
+    static QByteArray httpResponse(const int status, const QByteArray &reason, const QByteArray &contentType,
+                                   const QByteArray &body, const bool includeBody = true);
+
+    QTPOKIT_BEFRIEND_TEST(ExporterCommand)
+};
@@ -79,7 +79,7 @@ void FlashLedCommand::serviceDetailsDiscovered()
     DeviceCommand::serviceDetailsDiscovered(); // Just logs consistently.
     qCInfo(lc).noquote() << tr("Flashing Pokit device LED...");
     if (!service->flashLed()) {
-        QCoreApplication::exit(EXIT_FAILURE);
+        finish(EXIT_FAILURE);
     }
 }
 
@@ -95,6 +95,11 @@ void FlashLedCommand::deviceLedFlashed()
     case OutputFormat::Json:
         std::cout << qUtf8Printable(u"true\n"_s);
         break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         std::cout << qUtf8Printable(tr("Done.\n"));
         break;
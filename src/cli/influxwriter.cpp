@@ -0,0 +1,423 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "influxwriter.h"
+#include "abstractcommand.h"
+#include "../stringliterals_p.h"
+
+#include <QDateTime>
+#include <QEventLoop>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QUrlQuery>
+
+#include <algorithm>
+#include <limits>
+#include <ratio>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class InfluxWriter
+ *
+ * The InfluxWriter class writes meter readings, DSO samples, and data logger samples, to an InfluxDB server, as
+ * batches of line protocol points, via its HTTP write API.
+ *
+ * Points are appended to a per-device batch, which is closed (and queued for writing as a single request) once it
+ * reaches a size limit, or once it has been open for a time limit, whichever comes first. So servers receive a bounded
+ * number of requests per second, no matter how fast values arrive, such as during DSO bursts.
+ *
+ * Each point's measurement, tags and field key come straight from its MeasurementFormatter::Context, so are only
+ * formatted (and escaped) once per distinct mode and range, leaving just the value and timestamp to format per point.
+ *
+ * Queued batches are written one at a time, in order, and held in an in-memory retry buffer until the server accepts
+ * them. Failed writes (such as connection failures, timeouts, \c 429 and \c 5xx responses) are retried, with
+ * exponential backoff, or as requested by the server's \c Retry-After header. Batches rejected outright (such as with
+ * a \c 400 response, for malformed points) are logged and discarded, since retrying them cannot succeed. If the buffer
+ * fills up, the oldest unsent batches are discarded.
+ *
+ * Since all network I/O is asynchronous (via the Qt event loop), and write() only appends to an in-memory batch, the
+ * acquisition of values never blocks on the server.
+ */
+
+/*!
+ * Constructs a new InfluxDB writer with \a parent. Call setUrl() to configure the writer, before writing any points.
+ */
+InfluxWriter::InfluxWriter(QObject * const parent) : QObject(parent),
+    network(new QNetworkAccessManager(this)), batchTimer(new QTimer(this)), retryTimer(new QTimer(this))
+{
+    batchTimer->setSingleShot(true);
+    retryTimer->setSingleShot(true);
+    connect(batchTimer, &QTimer::timeout, this, &InfluxWriter::closeExpiredBatches);
+    connect(retryTimer, &QTimer::timeout, this, &InfluxWriter::sendQueued);
+}
+
+/*!
+ * Destroys this writer, after closing all open batches, and waiting (for a short time) for any queued batches to be
+ * written to the server. Any batches not written by then are lost.
+ */
+InfluxWriter::~InfluxWriter()
+{
+    flush();
+    if (!queue.isEmpty()) {
+        QEventLoop loop; // Only ever blocks on exit.
+        QTimer::singleShot(exitTimeout, &loop, &QEventLoop::quit);
+        connect(this, &InfluxWriter::idle, &loop, &QEventLoop::quit);
+        retryTimer->stop(); // Retry straight away, rather than waiting out the backoff.
+        sendQueued();
+        loop.exec();
+    }
+    if (reply) {
+        reply->disconnect(this);
+        reply->abort();
+    }
+    if (!queue.isEmpty()) {
+        qCWarning(lc).noquote() << tr("Discarding %Ln unwritten InfluxDB batch/es.", nullptr, (int)queue.size());
+    }
+    qCDebug(lc).noquote() << tr("Wrote %L1 point/s in %L2 batch/es; %L3 retried, %L4 rejected, %L5 dropped.")
+        .arg(stats.points).arg(stats.written).arg(stats.retries).arg(stats.rejected).arg(stats.dropped);
+}
+
+/*!
+ * Configures this writer from \a url, returning \c true on success, otherwise \c false, with errorString() set.
+ *
+ * The \a url is the server's write endpoint, such as `http://host:8086/api/v2/write?org=lab&bucket=pokit` (for
+ * InfluxDB 2 and later) or `http://host:8086/write?db=pokit` (for InfluxDB 1). If the path is empty, it defaults to
+ * `/api/v2/write`. The query is passed to the server as-is, with `precision=ns` added, except for any of:
+ *
+ * | Item       | Description                                                                 | Default            |
+ * |------------|-----------------------------------------------------------------------------|--------------------|
+ * | `interval` | Maximum time a batch may stay open, such as `500ms`, or `2s`.               | `1s`               |
+ * | `size`     | Batch size, in bytes, at which a batch is closed early, such as `256K`.     | `1048576`          |
+ * | `buffer`   | Size of the retry buffer for when the server is unreachable, such as `32M`. | `67108864`         |
+ * | `token`    | API token to authenticate with.                                             | `$INFLUX_TOKEN`    |
+ *
+ * If there is no token, then the URL's user name and password (if any) are used for basic authentication instead.
+ */
+bool InfluxWriter::setUrl(const QUrl &url)
+{
+    if ((!url.isValid()) || (url.host().isEmpty())) {
+        errorMessage = tr("Invalid URL");
+        return false;
+    }
+    if ((url.scheme() != u"http"_s) && (url.scheme() != u"https"_s)) {
+        errorMessage = tr("Unsupported scheme: %1").arg(url.scheme());
+        return false;
+    }
+
+    QString token = qEnvironmentVariable("INFLUX_TOKEN");
+    QUrlQuery forwardedQuery;
+    for (const auto &[key, value]: QUrlQuery(url).queryItems(QUrl::FullyDecoded)) {
+        if (key == u"interval"_s) {
+            batchInterval = AbstractCommand::parseNumber<std::milli>(value, u"s"_s, 1);
+            if (batchInterval == 0) {
+                errorMessage = tr("Invalid interval value: %1").arg(value);
+                return false;
+            }
+        } else if (key == u"size"_s) {
+            batchSize = AbstractCommand::parseNumber<std::ratio<1>>(value, u"B"_s);
+            if (batchSize == 0) {
+                errorMessage = tr("Invalid size value: %1").arg(value);
+                return false;
+            }
+        } else if (key == u"buffer"_s) {
+            bufferSize = AbstractCommand::parseNumber<std::ratio<1>>(value, u"B"_s);
+            if (bufferSize == 0) {
+                errorMessage = tr("Invalid buffer value: %1").arg(value);
+                return false;
+            }
+        } else if (key == u"token"_s) {
+            token = value;
+        } else if (key == u"precision"_s) {
+            if (value.compare(u"ns"_s, Qt::CaseInsensitive) != 0) {
+                errorMessage = tr("Unsupported precision value: %1").arg(value);
+                return false; // All timestamps are in nanoseconds.
+            }
+        } else {
+            forwardedQuery.addQueryItem(key, value);
+        }
+    }
+    forwardedQuery.addQueryItem(u"precision"_s, u"ns"_s);
+
+    if (!token.isEmpty()) {
+        authorization = "Token " + token.toUtf8();
+    } else if (!url.userName().isEmpty()) {
+        authorization = "Basic " + (url.userName(QUrl::FullyDecoded) + u':' + url.password(QUrl::FullyDecoded))
+            .toUtf8().toBase64();
+    } else {
+        authorization.clear();
+    }
+
+    this->url = url.adjusted(QUrl::RemoveUserInfo | QUrl::RemoveQuery | QUrl::RemoveFragment);
+    if ((this->url.path().isEmpty()) || (this->url.path() == u"/"_s)) {
+        this->url.setPath(u"/api/v2/write"_s);
+    }
+    this->url.setQuery(forwardedQuery);
+    errorMessage.clear();
+    return true;
+}
+
+/*!
+ * Returns a human-readable description of the last error, if any.
+ */
+QString InfluxWriter::errorString() const
+{
+    return errorMessage;
+}
+
+/*!
+ * Returns the URL that batches are written to, without any credentials.
+ */
+QUrl InfluxWriter::writeUrl() const
+{
+    return url;
+}
+
+/*!
+ * Returns this writer's statistics.
+ */
+InfluxWriter::Statistics InfluxWriter::statistics() const
+{
+    return stats;
+}
+
+/*!
+ * Returns the total size of all batches currently held in the retry buffer.
+ */
+qint64 InfluxWriter::bufferedBytes() const
+{
+    return queuedBytes;
+}
+
+/*!
+ * Returns \c true if all closed batches have been written, or discarded, otherwise \c false. Open batches (see
+ * flush()) are not included.
+ */
+bool InfluxWriter::isIdle() const
+{
+    return queue.isEmpty();
+}
+
+/*!
+ * Adds a point of \a value, taken at \a timestamp (in nanoseconds since the epoch), within \a context, to the batch
+ * for \a device. Non-finite values are skipped, since line protocol cannot represent them.
+ */
+void InfluxWriter::write(const QString &device, const MeasurementFormatter::Context &context, const float value,
+                         const qint64 timestamp)
+{
+    Batch &batch = openBatch(device, QDateTime::currentMSecsSinceEpoch());
+    if (MeasurementFormatter::appendLineProtocol(batch.lines, context, value, timestamp)) {
+        ++stats.points;
+    } else {
+        ++stats.skipped;
+    }
+    if (batch.lines.size() >= batchSize) {
+        closeBatch(device);
+    }
+}
+
+/*!
+ * Adds a point for each of \a samples, scaled by \a scale, within \a context, to the batch for \a device. The first
+ * sample was taken at \a timestamp, and each subsequent sample \a interval later (both in nanoseconds).
+ *
+ * \overload
+ */
+void InfluxWriter::write(const QString &device, const MeasurementFormatter::Context &context,
+                         const QVector<qint16> &samples, const float scale, const qint64 timestamp,
+                         const double interval)
+{
+    if (samples.isEmpty()) {
+        return;
+    }
+    Batch &batch = openBatch(device, QDateTime::currentMSecsSinceEpoch());
+    batch.lines.reserve(batch.lines.size() + samples.size() * (context.lineProtocol.size() + 32));
+    for (qsizetype index = 0; index < samples.size(); ++index) {
+        // Interpolate from the first sample, so the (rounded) interval's error does not accumulate.
+        const qint64 sampleTimestamp = timestamp + (qint64)((double)index * interval);
+        if (MeasurementFormatter::appendLineProtocol(batch.lines, context, samples.at(index) * scale,
+                                                     sampleTimestamp)) {
+            ++stats.points;
+        } else {
+            ++stats.skipped;
+        }
+    }
+    if (batch.lines.size() >= batchSize) {
+        closeBatch(device);
+    }
+}
+
+/*!
+ * Closes all open batches, queuing them for writing straight away, regardless of their size, or age.
+ */
+void InfluxWriter::flush()
+{
+    const QStringList devices = batches.keys();
+    for (const QString &device: devices) {
+        closeBatch(device);
+    }
+}
+
+/*!
+ * Returns the open batch for \a device, opening a new one (at time \a now) if there is none.
+ */
+InfluxWriter::Batch &InfluxWriter::openBatch(const QString &device, const qint64 now)
+{
+    auto iter = batches.find(device);
+    if (iter == batches.end()) {
+        Batch batch;
+        batch.lines.reserve(std::min<qsizetype>(batchSize, 64 * 1024));
+        batch.opened = now;
+        iter = batches.insert(device, batch);
+        if (!batchTimer->isActive()) {
+            batchTimer->start((int)batchInterval);
+        }
+    }
+    return *iter;
+}
+
+/*!
+ * Closes the open batch for \a device, and queues its points for writing (if it has any).
+ */
+void InfluxWriter::closeBatch(const QString &device)
+{
+    QByteArray lines = std::move(batches[device].lines);
+    batches.remove(device);
+    if (!lines.isEmpty()) {
+        enqueue(std::move(lines));
+    }
+}
+
+/*!
+ * Closes all batches that have been open for at least #batchInterval, and re-arms #batchTimer for the next-oldest
+ * batch (if any).
+ */
+void InfluxWriter::closeExpiredBatches()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QStringList devices = batches.keys();
+    for (const QString &device: devices) {
+        if (now - batches.value(device).opened >= batchInterval) {
+            closeBatch(device);
+        }
+    }
+    if (!batches.isEmpty()) {
+        qint64 oldest = std::numeric_limits<qint64>::max();
+        for (const Batch &batch: std::as_const(batches)) {
+            oldest = std::min(oldest, batch.opened);
+        }
+        batchTimer->start((int)std::max<qint64>(oldest + batchInterval - now, 1));
+    }
+}
+
+/*!
+ * Appends \a lines to the retry buffer, as a single batch, discarding the oldest unsent batches if the buffer would
+ * otherwise exceed #bufferSize (or its MemoryBudget quota), then writes the oldest batch, if not already writing.
+ */
+void InfluxWriter::enqueue(QByteArray lines)
+{
+    queuedBytes += lines.size();
+    memory.charge(lines.size());
+    queue.enqueue(std::move(lines));
+    ++stats.batches;
+
+    // The batch in flight (at the head of the queue) cannot be discarded, since it may yet be accepted.
+    const int inFlight = (reply) ? 1 : 0;
+    while (((queuedBytes > bufferSize) || (!memory.fits(0))) && (queue.size() > inFlight + 1)) {
+        if (queuedBytes <= bufferSize) {
+            memory.countRefusal(); // The memory budget, rather than the retry buffer, is what's full.
+        }
+        queuedBytes -= queue.at(inFlight).size();
+        memory.release(queue.at(inFlight).size());
+        queue.removeAt(inFlight);
+        ++stats.dropped;
+        if (!warnedDropping) {
+            qCWarning(lc).noquote() << tr("InfluxDB retry buffer full; discarding oldest batches.");
+            warnedDropping = true;
+        }
+    }
+    sendQueued();
+}
+
+/*!
+ * Writes the oldest queued batch to the server, unless there are none, one is already being written, or a retry is
+ * pending. Batches are written one at a time, so that they reach the server in order.
+ */
+void InfluxWriter::sendQueued()
+{
+    if ((reply) || (queue.isEmpty()) || (retryTimer->isActive())) {
+        return;
+    }
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, u"text/plain; charset=utf-8"_s);
+    if (!authorization.isEmpty()) {
+        request.setRawHeader("Authorization", authorization);
+    }
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+    request.setTransferTimeout(requestTimeout);
+    #endif
+    reply = network->post(request, queue.head());
+    connect(reply, &QNetworkReply::finished, this, &InfluxWriter::replyFinished);
+}
+
+/*!
+ * Handles the server's response to the write of the oldest queued batch, by either removing it from the queue (if
+ * accepted, or rejected outright), or scheduling a retry, with backoff.
+ */
+void InfluxWriter::replyFinished()
+{
+    QNetworkReply * const finished = std::exchange(reply, nullptr);
+    finished->deleteLater();
+    const int status = finished->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (finished->error() == QNetworkReply::NoError) {
+        const qsizetype size = queue.dequeue().size();
+        queuedBytes -= size;
+        memory.release(size);
+        ++stats.written;
+        retryDelay = 0;
+        warnedDropping = false;
+    } else if (isRetryable(status)) {
+        ++stats.retries;
+        const int delay = retryAfter(finished->rawHeader("Retry-After"));
+        retryDelay = (delay > 0) ? delay : (retryDelay == 0) ? 1000 : std::min(retryDelay * 2, maxRetryDelay);
+        errorMessage = finished->errorString();
+        qCWarning(lc).noquote() << tr("Failed to write to InfluxDB %1: %2; retrying in %L3ms (%L4 byte/s buffered).")
+            .arg(url.host(), errorMessage).arg(retryDelay).arg(queuedBytes);
+        retryTimer->start(retryDelay);
+        return;
+    } else {
+        const qsizetype size = queue.dequeue().size();
+        queuedBytes -= size;
+        memory.release(size);
+        ++stats.rejected;
+        errorMessage = QString::fromUtf8(finished->readAll()).trimmed();
+        qCWarning(lc).noquote() << tr("InfluxDB %1 rejected %L2 byte/s of points (HTTP status %3): %4")
+            .arg(url.host()).arg(size).arg(status).arg(errorMessage);
+    }
+    if (queue.isEmpty()) {
+        emit idle();
+    }
+    sendQueued();
+}
+
+/*!
+ * Returns \c true if a write that failed with HTTP \a status (or 0, if there was no response at all) may succeed if
+ * retried, otherwise \c false.
+ */
+bool InfluxWriter::isRetryable(const int status)
+{
+    return (status == 0) || (status == 429) || (status >= 500); // No response, too many requests, or server errors.
+}
+
+/*!
+ * Returns the delay, in milliseconds, requested by a `Retry-After` \a header, or 0 if \a header is empty, or not a
+ * number of seconds. (HTTP dates are not supported, since InfluxDB only sends seconds.)
+ */
+int InfluxWriter::retryAfter(const QByteArray &header)
+{
+    bool ok;
+    const int seconds = header.trimmed().toInt(&ok);
+    return ((ok) && (seconds > 0)) ? std::min(seconds, maxRetryDelay / 1000) * 1000 : 0; // Capped, like backoff.
+}
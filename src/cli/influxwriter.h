@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_INFLUXWRITER_H
+#define DOKIT_INFLUXWRITER_H
+
+#include "measurementformatter.h"
+
+#include <qtpokit/memorybudget.h>
+
+#include <QHash>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QQueue>
+#include <QUrl>
+#include <QVector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+QTPOKIT_USE_NAMESPACE
+
+class InfluxWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Writing statistics.
+    struct Statistics {
+        quint64 points { 0 };   ///< Number of points added to batches.
+        quint64 skipped { 0 };  ///< Number of points skipped, because their values were not finite.
+        quint64 batches { 0 };  ///< Number of batches closed, and queued for writing.
+        quint64 written { 0 };  ///< Number of batches accepted by the server.
+        quint64 retries { 0 };  ///< Number of failed writes, to be retried.
+        quint64 rejected { 0 }; ///< Number of batches rejected by the server, and discarded.
+        quint64 dropped { 0 };  ///< Number of batches discarded, because the retry buffer was full.
+    };
+
+    static constexpr quint32 defaultBatchInterval { 1000 };         ///< Default maximum batch age, in milliseconds.
+    static constexpr quint32 defaultBatchSize { 1024 * 1024 };      ///< Default maximum batch size, in bytes.
+    static constexpr qint64 defaultBufferSize { 64 * 1024 * 1024 }; ///< Default retry buffer size, in bytes.
+
+    explicit InfluxWriter(QObject * const parent = nullptr);
+    ~InfluxWriter() override;
+
+    bool setUrl(const QUrl &url);
+    QString errorString() const;
+    QUrl writeUrl() const;
+    Statistics statistics() const;
+    qint64 bufferedBytes() const;
+    bool isIdle() const;
+
+    void write(const QString &device, const MeasurementFormatter::Context &context, const float value,
+               const qint64 timestamp);
+    void write(const QString &device, const MeasurementFormatter::Context &context, const QVector<qint16> &samples,
+               const float scale, const qint64 timestamp, const double interval);
+
+public slots:
+    void flush();
+
+signals:
+    void idle();
+
+private:
+    /// Points added for a single device, but not yet queued for writing.
+    struct Batch {
+        QByteArray lines;    ///< Line protocol points, one per line.
+        qint64 opened { 0 }; ///< Time the batch's first point was added, in milliseconds since the epoch.
+    };
+
+    QUrl url;                                       ///< Write endpoint, including its query, but no credentials.
+    QByteArray authorization;                       ///< HTTP Authorization header value, if any.
+    quint32 batchInterval { defaultBatchInterval }; ///< Maximum batch age, in milliseconds.
+    quint32 batchSize { defaultBatchSize };         ///< Batch size at which batches are closed early.
+    qint64 bufferSize { defaultBufferSize };        ///< Maximum size of all queued batches.
+    QString errorMessage;                           ///< Description of the last error, if any.
+
+    QNetworkAccessManager * network { nullptr }; ///< Sends write requests.
+    QTimer * batchTimer { nullptr };             ///< Closes batches that have reached #batchInterval.
+    QTimer * retryTimer { nullptr };             ///< Delays retrying failed writes.
+    QHash<QString, Batch> batches;               ///< Open batches, by device.
+    QQueue<QByteArray> queue;                    ///< Retry buffer of closed batches, oldest (and in flight) first.
+    qint64 queuedBytes { 0 };                    ///< Total size of all #queue batches.
+    MemoryBudget::Stream memory { QStringLiteral("influx"), MemoryBudget::Kind::Spill }; ///< Accounts for #queue.
+    QNetworkReply * reply { nullptr };           ///< Reply to the write of the #queue head, if in flight.
+    int retryDelay { 0 };                        ///< Current retry backoff, in milliseconds.
+    bool warnedDropping { false };               ///< Whether dropping batches has been logged since the last write.
+    Statistics stats;                            ///< Writing statistics.
+
+    static constexpr int maxRetryDelay { 60000 };  ///< Maximum retry backoff, in milliseconds.
+    static constexpr int requestTimeout { 30000 }; ///< Maximum time to wait for a write, in milliseconds.
+    static constexpr int exitTimeout { 5000 };     ///< Maximum time to wait for queued writes on exit, in milliseconds.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.influx", QtInfoMsg); ///< Logging category for InfluxDB writing.
+
+    Batch &openBatch(const QString &device, const qint64 now);
+    void closeBatch(const QString &device);
+    void closeExpiredBatches();
+    void enqueue(QByteArray lines);
+    void sendQueued();
+    void replyFinished();
+
+    static bool isRetryable(const int status);
+    static int retryAfter(const QByteArray &header);
+
+    QTPOKIT_BEFRIEND_TEST(InfluxWriter)
+};
+
+#endif // DOKIT_INFLUXWRITER_H
@@ -9,6 +9,8 @@
 
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QLowEnergyService>
+#include <QSettings>
 
 #include <iostream>
 
@@ -70,19 +72,148 @@ AbstractPokitService * InfoCommand::getService()
     return service;
 }
 
+/*!
+ * \copybrief DeviceCommand::usesDiscoveredValues
+ *
+ * This override returns \c true, since this command outputs the DeviceInfoService values read during service discovery,
+ * unless the device's information has been cached (see readCachedInfo), in which case only the firmware revision is
+ * read (to validate the cached information), after discovery.
+ */
+bool InfoCommand::usesDiscoveredValues() const
+{
+    return !readCachedInfo();
+}
+
+/*!
+ * Returns the device information currently held by #service.
+ */
+InfoCommand::DeviceInfo InfoCommand::currentInfo() const
+{
+    Q_ASSERT(service);
+    return DeviceInfo{
+        service->manufacturer(), service->modelNumber(), service->hardwareRevision(),
+        service->firmwareRevision(), service->softwareRevision(), service->serialNumber(),
+    };
+}
+
+/*!
+ * Returns the current device's cached information, if the discovery cache is enabled, and has information for the
+ * current device.
+ *
+ * \see saveCachedInfo
+ */
+std::optional<InfoCommand::DeviceInfo> InfoCommand::readCachedInfo() const
+{
+    if ((!discoveryCache) || (discoveryCacheKey.isEmpty()) ||
+        (!discoveryCache->contains(discoveryCacheKey + u"/deviceInfo/firmwareRevision"_s))) {
+        return std::nullopt;
+    }
+    discoveryCache->beginGroup(discoveryCacheKey + u"/deviceInfo"_s);
+    DeviceInfo info{
+        discoveryCache->value(u"manufacturer"_s).toString(),
+        discoveryCache->value(u"modelNumber"_s).toString(),
+        discoveryCache->value(u"hardwareRevision"_s).toString(),
+        discoveryCache->value(u"firmwareRevision"_s).toString(),
+        discoveryCache->value(u"softwareRevision"_s).toString(),
+        (discoveryCache->contains(u"serialNumber"_s)) ? discoveryCache->value(u"serialNumber"_s).toString() : QString(),
+    };
+    discoveryCache->endGroup();
+    return info;
+}
+
+/*!
+ * Saves \a info to the discovery cache (if enabled) for the current device, replacing any previously cached
+ * information.
+ *
+ * \see readCachedInfo
+ */
+void InfoCommand::saveCachedInfo(const DeviceInfo &info)
+{
+    if ((!discoveryCache) || (discoveryCacheKey.isEmpty()) || (info.firmwareRevision.isEmpty())) {
+        return;
+    }
+    discoveryCache->beginGroup(discoveryCacheKey + u"/deviceInfo"_s);
+    discoveryCache->remove(QString()); // Removes every key in the current group, such as any stale serial number.
+    discoveryCache->setValue(u"manufacturer"_s, info.manufacturer);
+    discoveryCache->setValue(u"modelNumber"_s, info.modelNumber);
+    discoveryCache->setValue(u"hardwareRevision"_s, info.hardwareRevision);
+    discoveryCache->setValue(u"firmwareRevision"_s, info.firmwareRevision);
+    discoveryCache->setValue(u"softwareRevision"_s, info.softwareRevision);
+    if (!info.serialNumber.isNull()) {
+        discoveryCache->setValue(u"serialNumber"_s, info.serialNumber);
+    }
+    discoveryCache->endGroup();
+}
+
 /*!
  * \copybrief DeviceCommand::serviceDetailsDiscovered
  *
  * This override fetches the current device's information, and outputs it in the selected format.
+ *
+ * If value discovery was skipped, because the device's information had been cached, then only the firmware revision is
+ * read, and the cached information output if still current (see cachedFirmwareRevisionRead).
  */
 void InfoCommand::serviceDetailsDiscovered()
 {
     DeviceCommand::serviceDetailsDiscovered(); // Just logs consistently.
+    if ((service->skipValueDiscovery()) && (readCachedInfo())) {
+        connect(service, &DeviceInfoService::firmwareRevisionRead, this, &InfoCommand::cachedFirmwareRevisionRead);
+        service->readFirmwareRevisionCharacteristic();
+        return;
+    }
+    const DeviceInfo info = currentInfo();
+    saveCachedInfo(info);
+    outputDeviceInfo(info);
+}
+
+/*!
+ * Handles the firmware \a revision read for validating the device's cached information. If \a revision matches the
+ * cached firmware revision, the cached information is output. Otherwise, the cached information is stale, so all of
+ * the device's information is read afresh (see characteristicsRead).
+ */
+void InfoCommand::cachedFirmwareRevisionRead(const QString &revision)
+{
+    QObject::disconnect(service, &DeviceInfoService::firmwareRevisionRead,
+                        this, &InfoCommand::cachedFirmwareRevisionRead);
+    if (const std::optional<DeviceInfo> info = readCachedInfo();
+        (info) && (info->firmwareRevision == revision)) {
+        qCDebug(lc).noquote() << tr("Firmware revision %1 unchanged; using cached device information.").arg(revision);
+        outputDeviceInfo(*info);
+        return;
+    }
+    qCInfo(lc).noquote() << tr("Firmware revision changed; re-reading device information.");
+    const bool hasSerialNumber = service->service() &&
+        service->service()->characteristic(DeviceInfoService::CharacteristicUuids::serialNumber).isValid();
+    // DeviceInfoService::readCharacteristics() queues the serial number (if any) last, and model number before it.
+    if (hasSerialNumber) {
+        connect(service, &DeviceInfoService::serialNumberRead, this, &InfoCommand::characteristicsRead);
+    } else {
+        connect(service, &DeviceInfoService::modelNumberRead, this, &InfoCommand::characteristicsRead);
+    }
+    service->readCharacteristics();
+}
+
+/*!
+ * Handles the completion of re-reading all of the device's information, by caching, and outputting, it.
+ */
+void InfoCommand::characteristicsRead()
+{
+    QObject::disconnect(service, nullptr, this, nullptr);
+    const DeviceInfo info = currentInfo();
+    saveCachedInfo(info);
+    outputDeviceInfo(info);
+}
+
+/*!
+ * Outputs the current device's \a info in the selected format, then disconnects from the device.
+ */
+void InfoCommand::outputDeviceInfo(const DeviceInfo &info)
+{
     const QLowEnergyController * const controller = (device) ? device->controller() : nullptr;
     const QString deviceName = (controller) ? controller->remoteName() : QString();
     const QBluetoothAddress deviceAddress = (controller) ? controller->remoteAddress() : QBluetoothAddress();
     const QBluetoothUuid deviceUuid = (controller) ? controller->remoteDeviceUuid() : QBluetoothUuid();
-    const QString serialNumber = service->serialNumber();
+    const QString &serialNumber = info.serialNumber;
     switch (format) {
     case OutputFormat::Csv:
         std::cout << qUtf8Printable(tr("device_name,device_address,device_uuid,manufacturer_name,model_number,"
@@ -91,17 +222,17 @@ void InfoCommand::serviceDetailsDiscovered()
             escapeCsvField(deviceName),
             (deviceAddress.isNull()) ? QString() : deviceAddress.toString(),
             (deviceUuid.isNull()) ? QString() : deviceUuid.toString(),
-            escapeCsvField(service->manufacturer()), escapeCsvField(service->modelNumber()),
-            escapeCsvField(service->hardwareRevision()), escapeCsvField(service->firmwareRevision()),
-            escapeCsvField(service->softwareRevision()), escapeCsvField(serialNumber)));
+            escapeCsvField(info.manufacturer), escapeCsvField(info.modelNumber),
+            escapeCsvField(info.hardwareRevision), escapeCsvField(info.firmwareRevision),
+            escapeCsvField(info.softwareRevision), escapeCsvField(serialNumber)));
         break;
     case OutputFormat::Json: {
         QJsonObject jsonObject{
-            { u"manufacturerName"_s, service->manufacturer() },
-            { u"modelNumber"_s,      service->modelNumber() },
-            { u"hardwareRevision"_s, service->hardwareRevision() },
-            { u"firmwareRevision"_s, service->firmwareRevision() },
-            { u"softwareRevision"_s, service->softwareRevision() },
+            { u"manufacturerName"_s, info.manufacturer },
+            { u"modelNumber"_s,      info.modelNumber },
+            { u"hardwareRevision"_s, info.hardwareRevision },
+            { u"firmwareRevision"_s, info.firmwareRevision },
+            { u"softwareRevision"_s, info.softwareRevision },
         };
         if (!deviceName.isEmpty()) {
             jsonObject.insert(u"deviceName"_s, deviceName);
@@ -117,6 +248,11 @@ void InfoCommand::serviceDetailsDiscovered()
         }
         std::cout << QJsonDocument(jsonObject).toJson().toStdString();
     }   break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         if (!deviceName.isEmpty()) {
             std::cout << qUtf8Printable(tr("Device name:       %1\n").arg(deviceName));
@@ -127,11 +263,11 @@ void InfoCommand::serviceDetailsDiscovered()
         if (!deviceUuid.isNull()) {
             std::cout << qUtf8Printable(tr("Device UUID:       %1\n").arg(deviceUuid.toString()));
         }
-        std::cout << qUtf8Printable(tr("Manufacturer name: %1\n").arg(service->manufacturer()));
-        std::cout << qUtf8Printable(tr("Model number:      %1\n").arg(service->modelNumber()));
-        std::cout << qUtf8Printable(tr("Hardware revision: %1\n").arg(service->hardwareRevision()));
-        std::cout << qUtf8Printable(tr("Firmware revision: %1\n").arg(service->firmwareRevision()));
-        std::cout << qUtf8Printable(tr("Software revision: %1\n").arg(service->softwareRevision()));
+        std::cout << qUtf8Printable(tr("Manufacturer name: %1\n").arg(info.manufacturer));
+        std::cout << qUtf8Printable(tr("Model number:      %1\n").arg(info.modelNumber));
+        std::cout << qUtf8Printable(tr("Hardware revision: %1\n").arg(info.hardwareRevision));
+        std::cout << qUtf8Printable(tr("Firmware revision: %1\n").arg(info.firmwareRevision));
+        std::cout << qUtf8Printable(tr("Software revision: %1\n").arg(info.softwareRevision));
         if (!serialNumber.isNull()) {
             std::cout << qUtf8Printable(tr("Serial number:     %1\n").arg(serialNumber));
         }
@@ -3,6 +3,8 @@
 
 #include "devicecommand.h"
 
+#include <optional>
+
 QTPOKIT_FORWARD_DECLARE_CLASS(DeviceInfoService)
 
 class InfoCommand : public DeviceCommand
@@ -19,10 +21,28 @@ public slots:
     QStringList processOptions(const QCommandLineParser &parser) override;
 
 protected:
+    /// Device information, as read from (or cached for) a device's DeviceInfoService.
+    struct DeviceInfo {
+        QString manufacturer;     ///< Manufacturer name.
+        QString modelNumber;      ///< Model number.
+        QString hardwareRevision; ///< Hardware revision.
+        QString firmwareRevision; ///< Firmware revision, used to validate cached device information.
+        QString softwareRevision; ///< Software revision.
+        QString serialNumber;     ///< Serial number, or a null string if the device does not report one.
+    };
+
     AbstractPokitService * getService() override;
+    bool usesDiscoveredValues() const override;
+
+    DeviceInfo currentInfo() const;
+    std::optional<DeviceInfo> readCachedInfo() const;
+    void saveCachedInfo(const DeviceInfo &info);
+    void outputDeviceInfo(const DeviceInfo &info);
 
 protected slots:
     void serviceDetailsDiscovered() override;
+    void cachedFirmwareRevisionRead(const QString &revision);
+    void characteristicsRead();
 
 private:
     DeviceInfoService * service { nullptr }; ///< Bluetooth service this command interacts with.
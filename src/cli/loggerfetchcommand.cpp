@@ -2,15 +2,18 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "loggerfetchcommand.h"
+#include "commandsequence.h"
 #include "../stringliterals_p.h"
 
 #include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokittrace.h>
 
 #include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
 
-#include <iostream>
+#include <algorithm>
+#include <utility>
 
 // Qt 6.5.0 added new QDateTime::fromSecsSinceEpoch() and fromMSecsSinceEpoch()
 // overloads, then Qt 6.6.0 deprecated some of of the older ones.
@@ -37,6 +40,192 @@ LoggerFetchCommand::LoggerFetchCommand(QObject * const parent) : DeviceCommand(p
 
 }
 
+QStringList LoggerFetchCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return DeviceCommand::supportedOptions(parser) + QStringList{
+        u"archive"_s,
+        u"charge"_s,
+        u"charge-gap"_s,
+        u"compress"_s,
+        u"event"_s,
+        u"filter"_s,
+        u"incremental"_s,
+        u"influx"_s,
+        u"mark-clipping"_s,
+        u"raw"_s,
+        u"sqlite"_s,
+        u"summary"_s,
+        u"time-format"_s,
+    };
+}
+
+/*!
+ * \copybrief DeviceCommand::processOptions
+ *
+ * This implementation extends DeviceCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList LoggerFetchCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = DeviceCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the archive and compress options.
+    compressSamples = parser.isSet(u"compress"_s);
+    if (parser.isSet(u"archive"_s)) {
+        archive = new LoggerArchive(parser.value(u"archive"_s), this);
+        archive->setCompressSamples(compressSamples);
+    }
+
+    // Parse the incremental option.
+    if (parser.isSet(u"incremental"_s)) {
+        cursors = new QSettings(this);
+        cursors->beginGroup(u"loggerFetchCursors"_s);
+    }
+
+    // Parse the sqlite option.
+    if (parser.isSet(u"sqlite"_s)) {
+        errors.append(addSqliteSink(parser.value(u"sqlite"_s)));
+    }
+
+    // Parse the influx option.
+    if (parser.isSet(u"influx"_s)) {
+        errors.append(addInfluxWriter(parser.value(u"influx"_s)));
+    }
+
+    // Parse the time format option.
+    if (parser.isSet(u"time-format"_s)) {
+        const QString timeFormat = parser.value(u"time-format"_s).trimmed().toLower();
+        if (timeFormat == u"iso"_s) {
+            epochTimestamps = false;
+        } else if (timeFormat == u"epoch"_s) {
+            epochTimestamps = true;
+        } else {
+            errors.append(tr("Unknown time format: %1").arg(parser.value(u"time-format"_s)));
+        }
+    }
+
+    // Parse the filter option/s.
+    if (parser.isSet(u"filter"_s)) {
+        if (format == OutputFormat::Binary) {
+            errors.append(tr("Binary output is only supported for raw samples, not --filter"));
+        }
+        filter = new SampleFilter(this);
+        errors.append(parseFilters(parser.values(u"filter"_s), filter));
+    }
+
+    // Parse the event option/s.
+    if (parser.isSet(u"event"_s)) {
+        errors.append(addEventDetectors(parser.values(u"event"_s)));
+    }
+
+    // Parse the summary option.
+    if (parser.isSet(u"summary"_s)) {
+        const QString value = parser.value(u"summary"_s);
+        summaryPeriod = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (summaryPeriod == 0) {
+            errors.append(tr("Invalid summary value: %1").arg(value));
+        }
+        if (format == OutputFormat::Binary) {
+            errors.append(tr("Binary output is only supported for raw samples, not --summary"));
+        } else if (format == OutputFormat::Arrow) {
+            errors.append(tr("Arrow output is only supported for raw samples, not --summary"));
+        } else if (format == OutputFormat::LineProtocol) {
+            errors.append(tr("Line protocol output is only supported for raw samples, not --summary"));
+        }
+        if (parser.isSet(u"event"_s)) {
+            errors.append(tr("The summary option cannot be combined with the event option"));
+        }
+    }
+
+    // Parse the charge and charge-gap options.
+    if (parser.isSet(u"charge"_s)) {
+        errors.append(addChargeIntegrator(parser.value(u"charge"_s),
+            (parser.isSet(u"charge-gap"_s)) ? parser.value(u"charge-gap"_s) : QString()));
+        if ((parser.isSet(u"event"_s)) || (parser.isSet(u"summary"_s))) {
+            errors.append(tr("The charge option cannot be combined with the event or summary options"));
+        }
+    } else if (parser.isSet(u"charge-gap"_s)) {
+        errors.append(tr("The charge-gap option requires the charge option"));
+    }
+
+    // Parse the mark-clipping option.
+    markClipping = parser.isSet(u"mark-clipping"_s);
+    if ((markClipping) && ((parser.isSet(u"charge"_s)) || (parser.isSet(u"event"_s)) ||
+        (parser.isSet(u"summary"_s)))) {
+        errors.append(tr("Clipping markers are only supported for sample output, not --charge, --event or --summary"));
+    }
+    if ((markClipping) && (format != OutputFormat::Json) && (format != OutputFormat::Ndjson) &&
+        (format != OutputFormat::Text)) {
+        errors.append(tr("Clipping markers are only supported for JSON, NDJSON and text output"));
+    }
+
+    // Parse the raw option.
+    if (parser.isSet(u"raw"_s)) {
+        QStringList conflicts;
+        for (const QString &option: { u"charge"_s, u"event"_s, u"filter"_s, u"summary"_s }) {
+            if (parser.isSet(option)) {
+                conflicts.append(option);
+            }
+        }
+        errors.append(setRawCounts(conflicts));
+    }
+    return errors;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsArrowOutput
+ *
+ * This override returns \c true, since logger samples may be output as Arrow record batches.
+ */
+bool LoggerFetchCommand::supportsArrowOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsBinaryOutput
+ *
+ * This override returns \c true, since logger samples may be output as raw Binary blocks.
+ */
+bool LoggerFetchCommand::supportsBinaryOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsLineProtocolOutput
+ *
+ * This override returns \c true, since logger samples may be output as line protocol points, timestamped from the
+ * logging session's start.
+ */
+bool LoggerFetchCommand::supportsLineProtocolOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonOutput
+ *
+ * This override returns \c true, since logger fetches may include many thousands of samples.
+ */
+bool LoggerFetchCommand::supportsNdjsonOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonEnvelopeOutput
+ *
+ * This override returns \c true, since all of a logger fetch's samples share the same mode, unit and range.
+ */
+bool LoggerFetchCommand::supportsNdjsonEnvelopeOutput() const
+{
+    return true;
+}
+
 /*!
  * \copybrief DeviceCommand::getService
  *
@@ -54,6 +243,26 @@ AbstractPokitService * LoggerFetchCommand::getService()
     return service;
 }
 
+/*!
+ * Sets the percentage of the device's sampling buffer that, once filled by a tailed logging session, causes that
+ * session to be drained, and logging restarted (see drainLogger()). \a percent must be a whole number from 1 to 100,
+ * optionally followed by a `%` sign. Returns any errors, such as an invalid \a percent.
+ */
+QStringList LoggerFetchCommand::setAutoDrain(const QString &percent)
+{
+    QString value = percent.trimmed();
+    if (value.endsWith(u'%')) {
+        value.chop(1);
+    }
+    bool ok;
+    const uint number = value.toUInt(&ok);
+    if ((!ok) || (number < 1) || (number > 100)) {
+        return { tr("Invalid auto-drain value: %1").arg(percent) };
+    }
+    drainPercent = (quint8)number;
+    return { };
+}
+
 /*!
  * \copybrief DeviceCommand::serviceDetailsDiscovered
  *
@@ -62,9 +271,53 @@ AbstractPokitService * LoggerFetchCommand::getService()
 void LoggerFetchCommand::serviceDetailsDiscovered()
 {
     DeviceCommand::serviceDetailsDiscovered(); // Just logs consistently.
+    if (const QLowEnergyController * const controller = device->controller(); (cursors) && (controller)) {
+        // Prefer the device's address, but macOS only provides an (OS-assigned) UUID.
+        cursorKey = (controller->remoteAddress().isNull()) ? controller->remoteDeviceUuid().toString()
+            : controller->remoteAddress().toString();
+    }
+    if ((drainPercent > 0) && (device->capabilities().samplingBufferSize == 0)) {
+        qCWarning(lc).noquote() << tr("Device's sampling buffer size is unknown; logging sessions will only be "
+            "drained once the buffer is full.");
+    }
     qCInfo(lc).noquote() << tr("Fetching logger samples...");
-    service->enableMetadataNotifications();
-    service->enableReadingNotifications();
+
+    // Both notifications must be enabled before fetching, but are independent of each other, so are enabled together.
+    auto * const sequence = new CommandSequence(this);
+    sequence->then(u"enable metadata notifications"_s, [this]() { return service->enableMetadataNotificationsAsync(); })
+        .alongside(u"enable reading notifications"_s, [this]() { return service->enableReadingNotificationsAsync(); })
+        .then(u"fetch samples"_s, [this]() { return service->fetchSamplesAsync(); });
+    connect(sequence, &CommandSequence::failed, this, [this, sequence](const QString &step) {
+        qCWarning(lc).noquote() << tr("Failed to start fetching logger samples: %1").arg(step);
+        sequence->deleteLater();
+        if (device) disconnect(EXIT_FAILURE);
+    });
+    connect(sequence, &CommandSequence::finished, sequence, &QObject::deleteLater);
+    refreshing = true;
+    sequence->start();
+}
+
+/*!
+ * \copybrief DeviceCommand::serviceResumed
+ *
+ * This override fetches the logging session's samples again, since any fetch in progress when the device disconnected
+ * will not complete. When tailing (or fetching incrementally), already output samples are skipped, so the output just
+ * continues where it left off. Otherwise, since the samples would be output twice, the command fails instead.
+ */
+void LoggerFetchCommand::serviceResumed(const qint64 gapStart, const qint64 gapEnd)
+{
+    DeviceCommand::serviceResumed(gapStart, gapEnd); // Just logs consistently.
+    if ((!tail) && (!cursors) && (samplesToGo > 0)) {
+        qCCritical(lc).noquote() << tr("Logger fetch interrupted; use --incremental to resume interrupted fetches.");
+        finish(EXIT_FAILURE);
+        return;
+    }
+    if ((format == OutputFormat::NdjsonEnvelope) && (eventDetectors.isEmpty()) && (summaryPeriod == 0) &&
+        (!chargeIntegrator) && (samplesToGo > 0)) {
+        output(QByteArray("]}\n")); // Close the envelope left open by the interrupted fetch.
+    }
+    samplesToGo = 0;
+    refreshing = true;
     service->fetchSamples();
 }
 
@@ -73,6 +326,12 @@ void LoggerFetchCommand::serviceDetailsDiscovered()
  */
 void LoggerFetchCommand::metadataRead(const DataLoggerService::Metadata &data)
 {
+    if ((tail) && (!refreshing)) {
+        tailMetadataRead(data); // Notified (or polled) between fetches, rather than the start of a new fetch.
+        return;
+    }
+    refreshing = false;
+
     qCDebug(lc) << "status:"          << (int)(data.status);
     qCDebug(lc) << "scale:"           << data.scale;
     qCDebug(lc) << "mode:"            << DataLoggerService::toString(data.mode) << (quint8)data.mode;
@@ -80,10 +339,387 @@ void LoggerFetchCommand::metadataRead(const DataLoggerService::Metadata &data)
     qCDebug(lc) << "updateInterval:"  << (int)data.updateInterval;
     qCDebug(lc) << "numberOfSamples:" << data.numberOfSamples;
     qCDebug(lc) << "timestamp:"       << data.timestamp << QDateTime::fromSecsSinceEpoch(data.timestamp, DOKIT_QT_UTC);
+
+    // Charge can only be counted from current samples, and gaps can only be found once the interval is known.
+    if (chargeIntegrator) {
+        if (data.mode != DataLoggerService::Mode::DcCurrent) {
+            qCCritical(lc).noquote() << tr("The charge option requires a DC current logging session, not %1.")
+                .arg(DataLoggerService::toString(data.mode));
+            finish(EXIT_FAILURE);
+            return;
+        }
+        if (chargeIntegrator->maximumGap() == 0) {
+            chargeIntegrator->setMaximumGap(3 * data.updateInterval);
+        }
+    }
+
+    // Each logging session is stored as its own SQLite session (resumed, if already stored by an earlier fetch).
+    if (sqlite) {
+        sqlite->endSession();
+    }
+
+    // Find the number of samples (if any) already output by this tail, or by a previous incremental fetch.
+    bool haveCursor = false;
+    quint32 cursorTimestamp = 0, cursorSamples = 0;
+    if ((tail) && (samplesTailed > 0)) {
+        haveCursor = true;
+        cursorTimestamp = metadata.timestamp;
+        cursorSamples = samplesTailed;
+    } else if ((cursors) && (!cursorKey.isEmpty()) && (cursors->contains(cursorKey + u"/timestamp"_s))) {
+        haveCursor = true;
+        cursorTimestamp = cursors->value(cursorKey + u"/timestamp"_s).toUInt();
+        cursorSamples = cursors->value(cursorKey + u"/samples"_s).toUInt();
+    }
+
+    const quint8 previousRange = metadata.range;
     this->metadata = data;
     this->samplesToGo = data.numberOfSamples;
     this->timestamp = (quint64)data.timestamp * (quint64)1000;
+
+    // Skip any of those samples belonging to the same logging session.
+    archiveSamples.clear();
+    samplesSkipped = samplesToSkip = 0;
+    if (haveCursor) {
+        if ((cursorTimestamp == data.timestamp) && (cursorSamples <= data.numberOfSamples)) {
+            samplesSkipped = samplesToSkip = cursorSamples;
+            samplesToGo -= (qint32)cursorSamples;
+            timestamp += (quint64)data.updateInterval * (quint64)cursorSamples;
+            qCInfo(lc).noquote() << tr("Skipping %Ln previously fetched logger sample/s.", nullptr, cursorSamples);
+        } else if ((drainedTimestamp != 0) && (data.timestamp == drainedTimestamp)) {
+            qCInfo(lc).noquote() << tr("Continuing the drained logging session.");
+        } else {
+            qCInfo(lc).noquote() << tr("New logging session detected; fetching all logger samples.");
+        }
+    }
+    samplesTailed = samplesSkipped;
+
+    // A session restarted by drainLogger() continues the drained session's series, so carries on where it left off.
+    const bool continuing = (samplesSkipped > 0) || ((drainedTimestamp != 0) && (data.timestamp == drainedTimestamp));
+    if (filter) {
+        filter->setSampleRate((data.updateInterval == 0) ? 0.0 : 1000.0 / data.updateInterval);
+        if (!continuing) {
+            filter->reset(); // Otherwise, carry on filtering from the samples already output.
+        }
+    }
+    eventUnit = toUnit(data.mode);
+    if ((!continuing) || (data.range != previousRange)) {
+        saturation.reset(); // Otherwise, carry on from the samples already output, even across fetches.
+    }
+    saturation.setThreshold(SaturationDetector::threshold((service) ? service->pokitProduct()
+        .value_or(PokitProduct::PokitMeter) : PokitProduct::PokitMeter, data.mode, data.range, data.scale));
+    if (!continuing) {
+        for (EventDetector * const detector: std::as_const(eventDetectors)) {
+            detector->reset(); // Otherwise, carry on detecting from the samples already output.
+        }
+        flushSummary(); // Output the previous logging session's final period, if any.
+        if (chargeIntegrator) {
+            chargeIntegrator->flush(); // Output the previous logging session's final totals, if any.
+            chargeIntegrator->reset();
+        }
+    }
+
+    if (format == OutputFormat::Binary) {
+        writeBinaryHeader(outputBuffer, BinaryBlock::LoggerSamples, (quint8)data.mode, data.range, data.scale,
+                          data.updateInterval, timestamp, (quint32)samplesToGo, compressSamples);
+        previousSample = 0;
+    } else if ((format == OutputFormat::NdjsonEnvelope) && (eventDetectors.isEmpty()) && (summaryPeriod == 0) &&
+               (!chargeIntegrator)) {
+        // Open this fetch's envelope; outputSamples() will append the values, and close it.
+        const MeasurementFormatter::Context &context = formatter.context((quint8)data.mode, data.range);
+        output(QByteArray("{\"mode\":") + escapeJsonString(context.mode) +
+               ",\"unit\":" + escapeJsonString(context.unit) +
+               ((context.range.isEmpty()) ? QByteArray() : ",\"range\":" + escapeJsonString(context.range)) +
+               ",\"timestamp\":" + toJsonTimestamp(formatTimestamp(timestamp)) +
+               ",\"updateInterval\":" + QByteArray::number(data.updateInterval) +
+               ",\"numberOfSamples\":" + QByteArray::number(samplesToGo) + ((rawCounts)
+               ? ",\"scale\":" + formatScale(data.scale) + ",\"counts\":[" : QByteArray(",\"values\":[")));
+        if (samplesToGo <= 0) {
+            output(QByteArray("]}\n"));
+            outputBatchComplete();
+        }
+    } else if (rawCounts) {
+        declareRawCounts(formatter.context((quint8)data.mode, data.range), data.scale);
+    }
     qCInfo(lc).noquote() << tr("Fetching %Ln logger sample/s...", nullptr, data.numberOfSamples);
+    if ((samplesSkipped > 0) && (samplesToGo <= 0)) {
+        qCInfo(lc).noquote() << tr("No new logger samples to fetch.");
+        if ((!tail) && (device)) disconnect(); // Will exit the application once disconnected.
+    }
+    if ((tail) && (samplesToGo <= 0)) {
+        if (shouldDrain()) {
+            drainLogger();
+        } else {
+            schedulePoll(); // Wait for the logging session to grow.
+        }
+    }
+}
+
+/*!
+ * Invoked when \a data has been notified (or polled) while tailing, between fetches.
+ *
+ * If the logging session has grown (or a new session has begun) since the last fetch, then fetches the session again,
+ * so that metadataRead() and outputSamples() can output just the new samples. Otherwise, waits to poll again.
+ */
+void LoggerFetchCommand::tailMetadataRead(const DataLoggerService::Metadata &data)
+{
+    if ((samplesToGo > 0) || (draining)) {
+        return; // Still fetching (or restarting); any further samples will be found by the next poll.
+    }
+    if ((data.timestamp == metadata.timestamp) && (data.numberOfSamples <= samplesTailed)) {
+        schedulePoll();
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Logging session now has %Ln sample/s.", nullptr, data.numberOfSamples);
+    refreshing = true;
+    if (service) service->fetchSamples();
+}
+
+/*!
+ * (Re)starts the timer to read the logging session's metadata again, after one update interval (but no more often
+ * than once per second).
+ *
+ * Pokit devices notify metadata changes as sampling progresses, but polling too ensures that the tail never stalls if
+ * a notification is missed.
+ */
+void LoggerFetchCommand::schedulePoll()
+{
+    if (!pollTimer) {
+        pollTimer = new QTimer(this);
+        pollTimer->setSingleShot(true);
+        connect(pollTimer, &QTimer::timeout, this, [this]() {
+            if ((service) && (!refreshing) && (!draining) && (samplesToGo <= 0)) {
+                service->readMetadataCharacteristic();
+            }
+        });
+    }
+    pollTimer->start((int)qMax(metadata.updateInterval, (quint32)1000));
+    startWatchdog(service, (quint32)pollTimer->interval()); // Metadata arrives at least once per poll, if not stalled.
+}
+
+/*!
+ * Returns \c true if the current logging session, having just been fetched in full, should be drained (see
+ * drainLogger()). That is, if \c --auto-drain was set, and the session is either still sampling, but has filled at
+ * least #drainPercent of the device's sampling buffer, or has already stopped because the buffer is full.
+ *
+ * Sessions that have otherwise stopped sampling (such as via \c logger-stop) are never drained, and nor are any
+ * sessions still sampling if the device's buffer size is not known. Except that sessions still sampling are also
+ * drained once they have clipped (see SaturationDetector), if there is a higher range to restart logging with.
+ */
+bool LoggerFetchCommand::shouldDrain() const
+{
+    if (drainPercent == 0) {
+        return false;
+    }
+    switch (metadata.status) {
+    case DataLoggerService::LoggerStatus::BufferFull:
+        return true;
+    case DataLoggerService::LoggerStatus::Sampling: {
+        if ((saturation.isSaturated()) && (nextRange() != metadata.range)) {
+            return true;
+        }
+        const quint16 bufferSize = (device) ? device->capabilities().samplingBufferSize : 0;
+        return (bufferSize > 0) && ((quint64)metadata.numberOfSamples * 100 >= (quint64)bufferSize * drainPercent);
+    }
+    default:
+        return false;
+    }
+}
+
+/*!
+ * Restarts the data logger, with the same mode, range and update interval as the (just fetched) current logging
+ * session, so that the device's buffer never fills, and logging continues indefinitely.
+ *
+ * The new session's timestamp continues from the end of the drained session (or from now, if later, so that the two
+ * sessions never overlap), and metadataRead() treats the new session as a continuation of the drained one. So output,
+ * filters, events, summaries and archives all carry on as one logical series, with a gap of just however long the
+ * restart took (which is logged).
+ *
+ * If the drained session clipped, then logging restarts at the next range up (if any), so the rest of the series is
+ * not clipped too.
+ */
+void LoggerFetchCommand::drainLogger()
+{
+    Q_ASSERT(service);
+    const quint32 sessionEnd = metadata.timestamp + (quint32)(((quint64)metadata.numberOfSamples *
+        (quint64)metadata.updateInterval + 999) / 1000);
+    const quint8 range = (saturation.isSaturated()) ? nextRange() : metadata.range;
+    const DataLoggerService::Settings settings{
+        DataLoggerService::Command::Start, 0, metadata.mode, range, metadata.updateInterval,
+        qMax(sessionEnd, (quint32)QDateTime::currentSecsSinceEpoch()), // Note, subject to Y2038 epochalypse.
+    };
+    if (const std::optional<SaturationDetector::Segment> segment = saturation.flush(); (segment) && (markClipping)) {
+        outputClippingMarker(*segment); // The run ends with the drained session.
+        outputBatchComplete();
+    }
+    if (range != metadata.range) {
+        qCInfo(lc).noquote() << tr("Logging session has %Ln clipped sample/s; restarting the data logger at range %1.",
+            nullptr, saturation.saturatedCount()).arg(service->toString(range, metadata.mode));
+    } else {
+        qCInfo(lc).noquote() << tr("Logging session has %Ln sample/s; restarting the data logger before its buffer "
+            "fills.", nullptr, metadata.numberOfSamples);
+    }
+    draining = true;
+    auto * const sequence = new CommandSequence(this);
+    sequence->then(u"restart logger"_s, [this, settings]() { return service->startLoggerAsync(settings); });
+    connect(sequence, &CommandSequence::failed, this, [this, sequence](const QString &step) {
+        qCWarning(lc).noquote() << tr("Failed to drain the logging session: %1").arg(step);
+        sequence->deleteLater();
+        draining = false;
+        schedulePoll(); // Carry on tailing the (undrained) session, and try again once it has grown.
+    });
+    connect(sequence, &CommandSequence::finished, this, [this, sequence, settings, sessionEnd]() {
+        sequence->deleteLater();
+        qCInfo(lc).noquote() << tr("Data logger restarted, with a gap of %L1s.").arg(settings.timestamp - sessionEnd);
+        draining = false;
+        drainedTimestamp = settings.timestamp;
+        schedulePoll(); // Wait for the new logging session to begin.
+    });
+    sequence->start();
+}
+
+/*!
+ * Returns the range immediately above the current logging session's range (see SaturationDetector::nextRange), or the
+ * session's range, if there is none.
+ */
+quint8 LoggerFetchCommand::nextRange() const
+{
+    return SaturationDetector::nextRange((service) ? service->pokitProduct().value_or(PokitProduct::PokitMeter)
+        : PokitProduct::PokitMeter, metadata.mode, metadata.range);
+}
+
+/*!
+ * Outputs a marker for a run of clipped samples (see SaturationDetector), in the selected output format. The marker
+ * is timestamped as per the \a segment's first sample.
+ *
+ * Only JSON, NDJSON and Text output have markers (see processOptions()), since the other formats' fixed schemas have
+ * no place for them.
+ */
+void LoggerFetchCommand::outputClippingMarker(const SaturationDetector::Segment &segment)
+{
+    // The detector counts the same samples as #timestamp, so the run's start is that many sample intervals ago.
+    const quint64 start = timestamp - (quint64)(saturation.sampleCount() - segment.first) * metadata.updateInterval;
+    const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+    switch (format) {
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson: {
+        QJsonObject object{
+            { u"timestamp"_s, (epochTimestamps) ? QJsonValue((qint64)start)
+                                                : QJsonValue(QString::fromLatin1(formatTimestamp(start))) },
+            { u"clipped"_s,   segment.count },
+        };
+        if (!context.range.isEmpty()) {
+            object.insert(u"range"_s, context.range);
+        }
+        const QJsonDocument document(object);
+        output((format == OutputFormat::Json) ? document.toJson() : document.toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Csv:
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::NdjsonEnvelope:
+        break;
+    case OutputFormat::Text:
+        output(tr("-- %Ln sample/s clipped (%1), from %2 --\n", nullptr, (int)segment.count)
+            .arg(context.range, QString::fromLatin1(formatTimestamp(start))));
+        break;
+    }
+}
+
+/*!
+ * Returns the unit string for data logger \a mode, or a null string if \a mode has no known unit.
+ */
+QString LoggerFetchCommand::toUnit(const DataLoggerService::Mode mode)
+{
+    switch (mode) {
+    case DataLoggerService::Mode::DcVoltage: return u"Vdc"_s;
+    case DataLoggerService::Mode::AcVoltage: return u"Vac"_s;
+    case DataLoggerService::Mode::DcCurrent: return u"Adc"_s;
+    case DataLoggerService::Mode::AcCurrent: return u"Aac"_s;
+    case DataLoggerService::Mode::Temperature: return QString::fromUtf8("°C");
+    default:
+        qCDebug(lc).noquote() << tr(R"(No known unit for mode %1 "%2".)").arg((int)mode)
+            .arg(DataLoggerService::toString(mode));
+    }
+    return QString();
+}
+
+/*!
+ * Resolves the context (labels, and each output format's constant fields) of data logger samples with \a mode and
+ * \a range.
+ */
+MeasurementFormatter::Context LoggerFetchCommand::resolveContext(const quint8 mode, const quint8 range) const
+{
+    MeasurementFormatter::Context context;
+    context.mode = DataLoggerService::toString((DataLoggerService::Mode)mode);
+    context.unit = toUnit((DataLoggerService::Mode)mode);
+    context.range = service->toString(range, (DataLoggerService::Mode)mode);
+    if (rawCounts) {
+        // The mode, unit and range are declared once, by declareRawCounts(), rather than per sample.
+        context.csv.infix = ","; // timestamp,count
+        context.csv.suffix = "\n";
+        context.ndjson.prefix = "{\"timestamp\":";
+        context.ndjson.infix = ",\"count\":";
+        context.ndjson.suffix = "}\n";
+        context.text = tr("%1 %2\n"); // Just the timestamp and count.
+        return context;
+    }
+    context.csv.infix = ","; // timestamp,value,unit,range
+    context.csv.suffix = ',' + context.unit.toUtf8() + ',' + context.range.toUtf8() + '\n';
+    context.ndjson.prefix = "{\"timestamp\":";
+    context.ndjson.infix = ",\"value\":";
+    context.ndjson.suffix = ",\"unit\":" + escapeJsonString(context.unit) + ",\"mode\":" +
+        escapeJsonString(context.mode) +
+        ((context.range.isEmpty()) ? QByteArray() : ",\"range\":" + escapeJsonString(context.range)) + "}\n";
+    context.lineProtocol = lineProtocolPrefix("logger", context);
+    context.text = tr("%1 %2 %3\n").arg(u"%1"_s, u"%2"_s, context.unit); // Just the timestamp and value to go.
+    return context;
+}
+
+/*!
+ * Returns \a msecs formatted for output. That is, as an ISO 8601 UTC date and time with milliseconds, unless either
+ * epoch timestamps were requested, or the current logging session has no timestamp, in which case \a msecs is
+ * returned as a plain integer.
+ *
+ * Since consecutive samples' timestamps differ only by the session's fixed update interval, the (relatively
+ * expensive) date portion is rendered via QDateTime at most once per minute, and cached, so that only the seconds and
+ * milliseconds need be rendered per sample. The result is always identical to (though much cheaper than):
+ *
+ * ```
+ * QDateTime::fromMSecsSinceEpoch(msecs, QTimeZone::UTC).toString(Qt::ISODateWithMs).toLatin1()
+ * ```
+ */
+QByteArray LoggerFetchCommand::formatTimestamp(const quint64 msecs)
+{
+    if ((epochTimestamps) || (metadata.timestamp == 0)) {
+        return QByteArray::number(msecs);
+    }
+
+    // Re-render the "yyyy-MM-ddTHH:mm:" prefix only when the minute changes.
+    if (const quint64 minute = msecs / 60000; minute != cachedMinute) {
+        cachedMinutePrefix = QDateTime::fromMSecsSinceEpoch((qint64)(minute * 60000), DOKIT_QT_UTC)
+            .toString(u"yyyy-MM-dd'T'HH:mm:"_s).toLatin1();
+        cachedMinute = minute;
+    }
+
+    // Then render just the "ss.zzzZ" suffix.
+    const int seconds = (int)((msecs % 60000) / 1000), millis = (int)(msecs % 1000);
+    const char suffix[7] {
+        (char)('0' + seconds / 10), (char)('0' + seconds % 10), '.',
+        (char)('0' + millis / 100), (char)('0' + (millis / 10) % 10), (char)('0' + millis % 10), 'Z'
+    };
+    return cachedMinutePrefix + QByteArray(suffix, sizeof(suffix));
+}
+
+/*!
+ * Returns \a timestamp (as returned by formatTimestamp()) as a JSON value. That is, as a number for epoch
+ * timestamps, otherwise as a string.
+ *
+ * Note, \a timestamp never contains characters that would need escaping.
+ */
+QByteArray LoggerFetchCommand::toJsonTimestamp(const QByteArray &timestamp) const
+{
+    return (epochTimestamps) ? timestamp : ('"' + timestamp + '"');
 }
 
 /*!
@@ -91,53 +727,391 @@ void LoggerFetchCommand::metadataRead(const DataLoggerService::Metadata &data)
  */
 void LoggerFetchCommand::outputSamples(const DataLoggerService::Samples &samples)
 {
-    QString unit;
-    switch (metadata.mode) {
-    case DataLoggerService::Mode::DcVoltage: unit = u"Vdc"_s; break;
-    case DataLoggerService::Mode::AcVoltage: unit = u"Vac"_s; break;
-    case DataLoggerService::Mode::DcCurrent: unit = u"Adc"_s; break;
-    case DataLoggerService::Mode::AcCurrent: unit = u"Aac"_s; break;
-    case DataLoggerService::Mode::Temperature: unit = QString::fromUtf8("°C"); break;
-    default:
-        qCDebug(lc).noquote() << tr(R"(No known unit for mode %1 "%2".)").arg((int)metadata.mode)
-            .arg(DataLoggerService::toString(metadata.mode));
+    QTPOKIT_TRACE_ZONE(Format, "dataLoggerSamples");
+    if (samplesToSkip > 0) { // Already output by a previous incremental fetch.
+        const qsizetype skip = qMin((qsizetype)samplesToSkip, (qsizetype)samples.size());
+        samplesToSkip -= (quint32)skip;
+        if (skip < samples.size()) {
+            outputSamples(samples.mid(skip));
+        }
+        return;
     }
-    const QString range = service->toString(metadata.range, metadata.mode);
 
-    for (const qint16 &sample: samples) {
-        const QString timeString = (metadata.timestamp == 0) ? QString::number(timestamp)
-            : QDateTime::fromMSecsSinceEpoch(timestamp, DOKIT_QT_UTC).toString(Qt::ISODateWithMs);
-        const float value = sample * metadata.scale;
+    if ((tail) && (samplesToGo <= 0)) {
+        qCDebug(lc).noquote() << tr("Ignoring %Ln unexpected logger sample/s.", nullptr, samples.size());
+        return;
+    }
+
+    if (archive) {
+        archiveSamples.append(samples);
+    }
+
+    // Runs of clipped samples are found regardless of output format, for the end-of-session warning, and draining.
+    const QVector<SaturationDetector::Segment> clipped = saturation.process(samples);
+
+    // The context is constant for the whole batch (and the whole logging session), so is only resolved once.
+    const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+
+    // The unfiltered values are stored in SQLite (if requested), in one transaction per batch.
+    if ((sqlite) && (setSqliteSession(u"logger"_s, context.mode, context.unit, context.range, metadata.updateInterval,
+                                      (qint64)metadata.timestamp * 1000))) {
+        qint64 sampleTimestamp = (qint64)timestamp;
+        for (const qint16 sample: samples) {
+            sqlite->addSample(sampleTimestamp, sample * metadata.scale);
+            sampleTimestamp += metadata.updateInterval;
+        }
+        sqlite->commit();
+    }
+
+    // And likewise written to InfluxDB (if requested), batched per device.
+    if (influx) {
+        influx->write(deviceName(), context, samples, metadata.scale, (qint64)timestamp * 1'000'000,
+                      metadata.updateInterval * 1'000'000.0);
+    }
+
+    // Likewise, the batch's values are scaled (and filtered, if requested) once, for whichever format needs them.
+    if ((!rawCounts) && (format != OutputFormat::Binary)) {
+        values.resize(samples.size());
+        std::transform(samples.constBegin(), samples.constEnd(), values.begin(),
+                       [this](const qint16 sample) { return sample * metadata.scale; });
+        if (filter) {
+            filter->process(values);
+        }
+    }
+
+    if (format == OutputFormat::Binary) {
+        // Following the header written by metadataRead().
+        writeBinarySamples(outputBuffer, samples, (compressSamples) ? &previousSample : nullptr);
+        timestamp += (quint64)metadata.updateInterval * (quint64)samples.size();
+        samplesToGo -= samples.size();
+    } else if (!eventDetectors.isEmpty()) {
+        // Only the detected events are output, by outputEvent().
+        for (const float value: values) {
+            addEventValue(value, (qint64)timestamp);
+            timestamp += metadata.updateInterval;
+        }
+        samplesToGo -= samples.size();
+    } else if (summaryPeriod > 0) {
+        // Only each period's distribution is output, by outputSummary().
+        for (const float value: values) {
+            addSummaryValue(value, timestamp);
+            timestamp += metadata.updateInterval;
+        }
+        samplesToGo -= samples.size();
+    } else if (chargeIntegrator) {
+        // Only the running totals are output, by outputCharge().
+        for (const float value: values) {
+            chargeIntegrator->addSample(value, (qint64)timestamp);
+            timestamp += metadata.updateInterval;
+        }
+        samplesToGo -= samples.size();
+    } else if (format == OutputFormat::Arrow) {
+        // One record batch per notification, with microsecond timestamps.
+        QVector<qint64> timestamps(samples.size());
+        for (int index = 0; index < samples.size(); ++index) {
+            timestamps[index] = (qint64)timestamp * 1000;
+            timestamp += metadata.updateInterval;
+        }
+        outputArrowRecordBatch(timestamps, values, (quint8)metadata.mode, metadata.range);
+        samplesToGo -= samples.size();
+    } else if (rawCounts) {
+        // Just the counts, since their scale, mode and range were declared by metadataRead().
+        outputRawCounts(samples, context);
+        samplesToGo -= samples.size();
+        if (markClipping) {
+            for (const SaturationDetector::Segment &segment: clipped) {
+                outputClippingMarker(segment); // Following the batch that ended the run.
+            }
+        }
+    } else {
+        // As with the context, the output format is constant, so each format gets its own loop, free of any
+        // per-sample format checks.
         switch (format) {
         case OutputFormat::Csv:
             for (; showCsvHeader; showCsvHeader = false) {
-                std::cout << qUtf8Printable(tr("timestamp,value,unit,range\n"));
+                output(tr("timestamp,value,unit,range\n"));
+            }
+            outputBuffer.reserve(outputBuffer.size() + samples.size() * (context.csv.infix.size() +
+                                 context.csv.suffix.size() + 36)); // 36 bytes for the timestamp and value.
+            for (const float value: values) {
+                MeasurementFormatter::appendCsv(outputBuffer, context, formatTimestamp(timestamp), value);
+                timestamp += metadata.updateInterval;
+            }
+            break;
+        case OutputFormat::Json:
+            for (const float value: values) {
+                QJsonObject object{
+                    { u"timestamp"_s, (epochTimestamps) ? QJsonValue((qint64)timestamp)
+                                                        : QJsonValue(QString::fromLatin1(formatTimestamp(timestamp))) },
+                    { u"value"_s,     value },
+                    { u"unit"_s,      context.unit },
+                    { u"mode"_s,      context.mode },
+                };
+                if (!context.range.isEmpty()) {
+                    object.insert(u"range"_s, context.range);
+                }
+                output(QJsonDocument(object).toJson());
+                timestamp += metadata.updateInterval;
+            }
+            break;
+        case OutputFormat::Arrow:  // Written in bulk, above.
+        case OutputFormat::Binary: // Written in bulk, above.
+            break;
+        case OutputFormat::LineProtocol: // Nanosecond timestamps.
+            outputBuffer.reserve(outputBuffer.size() + samples.size() * (context.lineProtocol.size() + 32));
+            for (const float value: values) {
+                MeasurementFormatter::appendLineProtocol(outputBuffer, context, value, (qint64)timestamp * 1'000'000);
+                timestamp += metadata.updateInterval;
+            }
+            break;
+        case OutputFormat::Ndjson:
+            outputBuffer.reserve(outputBuffer.size() + samples.size() * (context.ndjson.prefix.size() +
+                                 context.ndjson.infix.size() + context.ndjson.suffix.size() + 38));
+            for (const float value: values) {
+                MeasurementFormatter::appendNdjson(outputBuffer, context, toJsonTimestamp(formatTimestamp(timestamp)),
+                                                   value);
+                timestamp += metadata.updateInterval;
             }
-            std::cout << qUtf8Printable(QString::fromLatin1("%1,%2,%3,%4\n")
-                .arg(timeString).arg(value).arg(unit, range));
             break;
-        case OutputFormat::Json: {
-            QJsonObject object{
-                { u"timestamp"_s, timeString },
-                { u"value"_s,     value },
-                { u"unit"_s,      unit },
-                { u"mode"_s,      DataLoggerService::toString(metadata.mode) },
-            };
-            if (!range.isEmpty()) {
-                object.insert(u"range"_s, range);
+        case OutputFormat::NdjsonEnvelope: { // Appended to the envelope opened by metadataRead().
+            const qsizetype start = outputBuffer.size();
+            for (const float value: values) {
+                appendJsonNumber(outputBuffer.append(','), value);
+            }
+            if ((samplesToGo == (qint32)(metadata.numberOfSamples - samplesSkipped)) && (outputBuffer.size() > start)) {
+                outputBuffer.remove(start, 1); // The envelope's first value has no preceding comma.
             }
-            std::cout << QJsonDocument(object).toJson().toStdString();
+            timestamp += (quint64)metadata.updateInterval * (quint64)samples.size();
         }   break;
         case OutputFormat::Text:
-            std::cout << qUtf8Printable(tr("%1 %2 %3\n").arg(timeString).arg(value).arg(unit));
+            for (const float value: values) {
+                output(MeasurementFormatter::formatText(context, QString::fromLatin1(formatTimestamp(timestamp)),
+                                                        value));
+                timestamp += metadata.updateInterval;
+            }
             break;
         }
-        timestamp += metadata.updateInterval;
-        --samplesToGo;
+        samplesToGo -= samples.size();
+        if (markClipping) {
+            for (const SaturationDetector::Segment &segment: clipped) {
+                outputClippingMarker(segment); // Following the batch that ended the run.
+            }
+        }
+    }
+    if ((format == OutputFormat::NdjsonEnvelope) && (eventDetectors.isEmpty()) && (summaryPeriod == 0) &&
+        (!chargeIntegrator) && (samplesToGo <= 0)) {
+        output(QByteArray("]}\n")); // Close the envelope opened by metadataRead().
+    }
+    outputBatchComplete((service) ? service->receiveTimestamp() : -1);
+    saveCursor();
+    if (tail) {
+        samplesTailed = (quint32)qMax(metadata.numberOfSamples - samplesToGo, 0);
     }
     if (samplesToGo <= 0) {
+        appendToArchive();
         qCInfo(lc).noquote() << tr("Finished fetching %Ln sample/s (with %L1 remaining).",
             nullptr, metadata.numberOfSamples).arg(samplesToGo);
-        if (device) disconnect(); // Will exit the application once disconnected.
+        if ((tail) && (shouldDrain())) {
+            drainLogger(); // Restart logging before the device's buffer fills, with any event, or period, still open.
+        } else if (tail) {
+            schedulePoll(); // Wait for the logging session to grow, with any event, or period, still open.
+        } else {
+            if (const std::optional<SaturationDetector::Segment> segment = saturation.flush();
+                (segment) && (markClipping)) {
+                outputClippingMarker(*segment); // The run continued to the end of the logging session.
+                outputBatchComplete();
+            }
+            if (saturation.isSaturated()) {
+                qCWarning(lc).noquote() << tr("Logging session has %Ln clipped sample/s, at the limit of range %1.",
+                    nullptr, saturation.saturatedCount()).arg((service) ? service->toString(metadata.range,
+                    metadata.mode) : QString::number(metadata.range));
+            }
+            flushEvents(); // Output the final event, if still in progress.
+            flushSummary(); // Output the final, partial, period.
+            if (chargeIntegrator) chargeIntegrator->flush(); // Output the final totals.
+            if (device) disconnect(); // Will exit the application once disconnected.
+        }
+    }
+}
+
+/*!
+ * Outputs logger \a samples as raw (unscaled) device counts within \a context, in the selected output format, for the
+ * `raw` option.
+ *
+ * Integer counts are much cheaper to format than scaled values, and are lossless, while consumers can apply the
+ * scale declared by metadataRead() to all of the counts at once.
+ */
+void LoggerFetchCommand::outputRawCounts(const DataLoggerService::Samples &samples,
+                                         const MeasurementFormatter::Context &context)
+{
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("timestamp,count\n"));
+        }
+        outputBuffer.reserve(outputBuffer.size() + samples.size() * 32); // 32 bytes for the timestamp and count.
+        for (const qint16 sample: samples) {
+            MeasurementFormatter::appendCsvCount(outputBuffer, context, formatTimestamp(timestamp), sample);
+            timestamp += metadata.updateInterval;
+        }
+        break;
+    case OutputFormat::Ndjson:
+        outputBuffer.reserve(outputBuffer.size() + samples.size() * (context.ndjson.prefix.size() +
+                             context.ndjson.infix.size() + context.ndjson.suffix.size() + 32));
+        for (const qint16 sample: samples) {
+            MeasurementFormatter::appendNdjsonCount(outputBuffer, context,
+                                                    toJsonTimestamp(formatTimestamp(timestamp)), sample);
+            timestamp += metadata.updateInterval;
+        }
+        break;
+    case OutputFormat::NdjsonEnvelope: { // Appended to the envelope opened by metadataRead().
+        const qsizetype start = outputBuffer.size();
+        for (const qint16 sample: samples) {
+            appendNumber(outputBuffer.append(','), (qint64)sample);
+        }
+        if ((samplesToGo == (qint32)(metadata.numberOfSamples - samplesSkipped)) && (outputBuffer.size() > start)) {
+            outputBuffer.remove(start, 1); // The envelope's first count has no preceding comma.
+        }
+        timestamp += (quint64)metadata.updateInterval * (quint64)samples.size();
+    }   break;
+    case OutputFormat::Text:
+        for (const qint16 sample: samples) {
+            output(MeasurementFormatter::formatTextCount(context, QString::fromLatin1(formatTimestamp(timestamp)),
+                                                         sample));
+            timestamp += metadata.updateInterval;
+        }
+        break;
+    default: // No other formats are supported by setRawCounts().
+        break;
+    }
+}
+
+/*!
+ * Adds \a value, sampled at \a timestamp, to the current summary period, first outputting (and resetting) the
+ * previous period's summary, if \a timestamp begins a new period.
+ *
+ * Periods are aligned to multiples of #summaryPeriod since the epoch, so (for example) hourly periods begin on the
+ * hour, regardless of when the logging session began.
+ */
+void LoggerFetchCommand::addSummaryValue(const float value, const quint64 timestamp)
+{
+    const quint64 start = timestamp - (timestamp % summaryPeriod);
+    if ((!summary.isEmpty()) && (start != summaryStart)) {
+        outputSummary();
+        summary.reset();
+    }
+    summaryStart = start;
+    summary.add(value);
+}
+
+/*!
+ * Outputs (and resets) the current summary period's summary, if it has any values.
+ */
+void LoggerFetchCommand::flushSummary()
+{
+    if (!summary.isEmpty()) {
+        outputSummary();
+        summary.reset();
+    }
+}
+
+/*!
+ * Outputs the distribution of the current summary period's values, in the selected output format.
+ */
+void LoggerFetchCommand::outputSummary()
+{
+    const MeasurementFormatter::Context &context = formatter.context((quint8)metadata.mode, metadata.range);
+    const QByteArray start = formatTimestamp(summaryStart), end = formatTimestamp(summaryStart + summaryPeriod);
+    const std::pair<QString, double> statistics[] {
+        { u"minimum"_s, summary.minimum() },
+        { u"mean"_s,    summary.mean() },
+        { u"p50"_s,     summary.percentile(50.0) },
+        { u"p95"_s,     summary.percentile(95.0) },
+        { u"p99"_s,     summary.percentile(99.0) },
+        { u"maximum"_s, summary.maximum() },
+    };
+
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("start,end,count,minimum,mean,p50,p95,p99,maximum,unit\n"));
+        }
+        output(QString::fromLatin1("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10\n")
+            .arg(QString::fromLatin1(start), QString::fromLatin1(end)).arg(summary.count())
+            .arg(statistics[0].second).arg(statistics[1].second).arg(statistics[2].second)
+            .arg(statistics[3].second).arg(statistics[4].second).arg(statistics[5].second).arg(context.unit));
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope: {
+        const auto toJson = [this](const QByteArray &timestamp) {
+            return (epochTimestamps) ? QJsonValue(timestamp.toLongLong()) : QJsonValue(QString::fromLatin1(timestamp));
+        };
+        QJsonObject object{
+            { u"start"_s, toJson(start) },
+            { u"end"_s,   toJson(end) },
+            { u"count"_s, (qint64)summary.count() },
+            { u"unit"_s,  context.unit },
+            { u"mode"_s,  context.mode },
+        };
+        for (const auto &[key, value]: statistics) {
+            object.insert(key, qIsInf(value) ? QJsonValue(tr("Infinity")) : QJsonValue(value));
+        }
+        if (!context.range.isEmpty()) {
+            object.insert(u"range"_s, context.range);
+        }
+        output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+            : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:  // Not supported (rejected by processOptions).
+    case OutputFormat::LineProtocol: // Not supported (rejected by processOptions).
+    case OutputFormat::Binary: // Not supported (rejected by processOptions).
+        break;
+    case OutputFormat::Text:
+        output(tr("Period:  %1 to %2\n").arg(QString::fromLatin1(start), QString::fromLatin1(end)));
+        output(tr("Count:   %1\n").arg(summary.count()));
+        for (const auto &[label, value]: { std::pair(tr("Minimum: %1 %2\n"), statistics[0].second),
+                                           std::pair(tr("Mean:    %1 %2\n"), statistics[1].second),
+                                           std::pair(tr("p50:     %1 %2\n"), statistics[2].second),
+                                           std::pair(tr("p95:     %1 %2\n"), statistics[3].second),
+                                           std::pair(tr("p99:     %1 %2\n"), statistics[4].second),
+                                           std::pair(tr("Maximum: %1 %2\n"), statistics[5].second) }) {
+            output(label.arg(value).arg(context.unit));
+        }
+        break;
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Appends the samples fetched from the current logging session (if any) to the archive, if \c --archive was set.
+ *
+ * Samples skipped by an incremental fetch are not appended again, so the archive receives each sample only once.
+ */
+void LoggerFetchCommand::appendToArchive()
+{
+    if ((archive) && (!archiveSamples.isEmpty())) {
+        if (archive->append(metadata, archiveSamples, samplesSkipped)) {
+            qCInfo(lc).noquote() << tr("Appended %Ln logger sample/s to %1.", nullptr, archiveSamples.size())
+                .arg(archive->fileName());
+        } else {
+            qCWarning(lc).noquote() << tr("Failed to append logger samples to %1.").arg(archive->fileName());
+        }
+        archiveSamples.clear();
+    }
+}
+
+/*!
+ * Persists the incremental fetch cursor (if any) for the current device, being the current logging session's
+ * timestamp, and the number of samples fetched (and output) so far.
+ *
+ * Logging sessions are identified by their start timestamp, so a later fetch of the same session will skip this many
+ * samples, while a fetch of a new session will fetch them all.
+ */
+void LoggerFetchCommand::saveCursor()
+{
+    if ((cursors) && (!cursorKey.isEmpty())) {
+        cursors->setValue(cursorKey + u"/timestamp"_s, metadata.timestamp);
+        cursors->setValue(cursorKey + u"/samples"_s, qMax(metadata.numberOfSamples - samplesToGo, 0));
     }
 }
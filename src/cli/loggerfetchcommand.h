@@ -1,9 +1,22 @@
 // SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#ifndef DOKIT_LOGGERFETCHCOMMAND_H
+#define DOKIT_LOGGERFETCHCOMMAND_H
+
 #include "devicecommand.h"
+#include "measurementformatter.h"
 
 #include <qtpokit/dataloggerservice.h>
+#include <qtpokit/loggerarchive.h>
+#include <qtpokit/quantilesketch.h>
+#include <qtpokit/samplefilter.h>
+#include <qtpokit/saturationdetector.h>
+
+#include <QSettings>
+#include <QTimer>
+
+#include <limits>
 
 class LoggerFetchCommand : public DeviceCommand
 {
@@ -12,11 +25,28 @@ class LoggerFetchCommand : public DeviceCommand
 public:
     explicit LoggerFetchCommand(QObject * const parent = nullptr);
 
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+    static QString toUnit(const DataLoggerService::Mode mode);
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+
 protected:
+    bool supportsArrowOutput() const override;
+    bool supportsBinaryOutput() const override;
+    bool supportsLineProtocolOutput() const override;
+    bool supportsNdjsonOutput() const override;
+    bool supportsNdjsonEnvelopeOutput() const override;
     AbstractPokitService * getService() override;
+    QStringList setAutoDrain(const QString &percent);
+
+    bool tail { false }; ///< Whether to keep following the logging session for new samples, as per \c logger-tail.
+    quint8 drainPercent { 0 }; ///< Buffer fill percentage at which to restart logging, if \c --auto-drain.
 
 protected slots:
     void serviceDetailsDiscovered() override;
+    void serviceResumed(const qint64 gapStart, const qint64 gapEnd) override;
 
 private:
     DataLoggerService * service { nullptr }; ///< Bluetooth service this command interacts with.
@@ -24,6 +54,45 @@ private:
     qint32 samplesToGo { 0 };    ///< Number of samples we're still expecting to receive.
     quint64 timestamp { 0 };     ///< Current sample's epoch milliseconds timestamp.
     bool showCsvHeader { true }; ///< Whether or not to show a header as the first line of CSV output.
+    QSettings * cursors { nullptr }; ///< Persisted incremental fetch cursors, if \c --incremental was set.
+    QString cursorKey;               ///< Key identifying this device's cursor within #cursors.
+    quint32 samplesSkipped { 0 };    ///< Number of samples already output by a previous incremental fetch.
+    quint32 samplesToSkip { 0 };     ///< Number of those samples still to be received, and skipped.
+    bool epochTimestamps { false };  ///< Whether to output timestamps as epoch milliseconds, instead of ISO 8601.
+    quint64 cachedMinute { std::numeric_limits<quint64>::max() }; ///< Epoch minute of #cachedMinutePrefix.
+    QByteArray cachedMinutePrefix;   ///< ISO 8601 date, hour and minute prefix of the most recent timestamp.
+    LoggerArchive * archive { nullptr }; ///< Archive to append fetched samples to, if \c --archive was set.
+    DataLoggerService::Samples archiveSamples; ///< Fetched samples, to be appended to #archive once complete.
+    bool refreshing { false };       ///< Whether a fetch has been requested, but its metadata not yet read.
+    quint32 samplesTailed { 0 };     ///< Number of the current logging session's samples output so far, if #tail.
+    QTimer * pollTimer { nullptr };  ///< Timer for polling the logging session's metadata between fetches, if #tail.
+    bool draining { false };         ///< Whether the data logger is being restarted, after its session was drained.
+    quint32 drainedTimestamp { 0 };  ///< Timestamp of the logging session most recently restarted by drainLogger().
+    SampleFilter * filter { nullptr }; ///< Filters the samples' values before output, if \c --filter was set.
+    QVector<float> values;           ///< The current batch of samples' scaled (and perhaps filtered) values.
+    quint32 summaryPeriod { 0 };     ///< Period of each summary, in milliseconds, if \c --summary was set.
+    QuantileSketch summary;          ///< Distribution of the current summary period's values, if #summaryPeriod.
+    quint64 summaryStart { 0 };      ///< Start of the current summary period, in epoch milliseconds.
+    SaturationDetector saturation;   ///< Finds the current logging session's clipped samples.
+    bool markClipping { false };     ///< Whether to output a marker for each run of clipped samples.
+    MeasurementFormatter formatter { ///< Resolved (and cached) labels and fields, per mode and range.
+        [this](const quint8 mode, const quint8 range, const quint8) { return resolveContext(mode, range); } };
+
+    MeasurementFormatter::Context resolveContext(const quint8 mode, const quint8 range) const;
+    void saveCursor();
+    void appendToArchive();
+    void tailMetadataRead(const DataLoggerService::Metadata &data);
+    void schedulePoll();
+    bool shouldDrain() const;
+    quint8 nextRange() const;
+    void drainLogger();
+    QByteArray formatTimestamp(const quint64 msecs);
+    QByteArray toJsonTimestamp(const QByteArray &timestamp) const;
+    void addSummaryValue(const float value, const quint64 timestamp);
+    void flushSummary();
+    void outputSummary();
+    void outputClippingMarker(const SaturationDetector::Segment &segment);
+    void outputRawCounts(const DataLoggerService::Samples &samples, const MeasurementFormatter::Context &context);
 
 private slots:
     void metadataRead(const DataLoggerService::Metadata &data);
@@ -31,3 +100,5 @@ private slots:
 
     QTPOKIT_BEFRIEND_TEST(LoggerFetchCommand)
 };
+
+#endif // DOKIT_LOGGERFETCHCOMMAND_H
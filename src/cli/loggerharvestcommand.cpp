@@ -0,0 +1,427 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "loggerharvestcommand.h"
+#include "loggerfetchcommand.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/pokitproducts.h>
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <tuple>
+
+// Qt 6.5.0 added new QDateTime::fromSecsSinceEpoch() and fromMSecsSinceEpoch()
+// overloads, then Qt 6.6.0 deprecated some of of the older ones.
+#if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
+    #define DOKIT_QT_UTC Qt::UTC
+#else
+    #include <QTimeZone>
+    #define DOKIT_QT_UTC QTimeZone::UTC
+#endif
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class LoggerHarvestCommand
+ *
+ * The LoggerHarvestCommand class implements the `logger-harvest` CLI command.
+ *
+ * Unlike `logger-fetch`, which fetches from a single device, this command fetches the data logger samples from each of
+ * the devices given via `--device`, connecting to up to `--max-connections` devices concurrently. Once all devices
+ * have been harvested, their samples are output as a single stream, ordered by absolute timestamp, with each sample
+ * tagged with its source device (as named via `--device`).
+ */
+
+/*!
+ * Construct a new LoggerHarvestCommand object with \a parent.
+ */
+LoggerHarvestCommand::LoggerHarvestCommand(QObject * const parent) : AbstractCommand(parent)
+{
+
+}
+
+QStringList LoggerHarvestCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser) + QStringList{
+        u"device"_s,
+    };
+}
+
+QStringList LoggerHarvestCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"max-connections"_s,
+        u"time-format"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList LoggerHarvestCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the device option/s, each of which may be a comma-separated list of devices.
+    harvests.clear();
+    const QStringList devices = parseDeviceList(parser.values(u"device"_s));
+    for (const QString &deviceName: devices) {
+        harvests.append(Harvest{ deviceName });
+    }
+    devicesToScanFor = devices;
+    if (harvests.isEmpty()) {
+        errors.append(tr("No devices to harvest"));
+    }
+
+    // Parse the max-connections option.
+    if (parser.isSet(u"max-connections"_s)) {
+        const QString value = parser.value(u"max-connections"_s);
+        bool ok;
+        const int connections = value.toInt(&ok);
+        if ((!ok) || (connections <= 0)) {
+            errors.append(tr("Invalid max-connections value: %1").arg(value));
+        } else {
+            maxConnections = connections;
+        }
+    }
+
+    // Parse the time format option.
+    if (parser.isSet(u"time-format"_s)) {
+        const QString timeFormat = parser.value(u"time-format"_s).trimmed().toLower();
+        if (timeFormat == u"iso"_s) {
+            epochTimestamps = false;
+        } else if (timeFormat == u"epoch"_s) {
+            epochTimestamps = true;
+        } else {
+            errors.append(tr("Unknown time format: %1").arg(parser.value(u"time-format"_s)));
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Begins scanning for the requested Pokit devices.
+ */
+bool LoggerHarvestCommand::start()
+{
+    qCInfo(lc).noquote() << tr("Looking for %Ln Pokit device/s...", nullptr, harvests.size());
+    discoveryAgent->start();
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonOutput
+ *
+ * This override returns \c true, since harvests may include many thousands of samples.
+ */
+bool LoggerHarvestCommand::supportsNdjsonOutput() const
+{
+    return true;
+}
+
+/*!
+ * Checks if \a info is one of the (not yet discovered) devices to harvest, and if so, creates a device and service
+ * for it, and queues it for connection.
+ *
+ * Discovery continues until all requested devices have been discovered (see AbstractCommand::takeDevice()), so that
+ * devices may be harvested while others are still being discovered.
+ */
+void LoggerHarvestCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_ASSERT(isPokitProduct(info));
+
+    const QString deviceName = takeDevice(info);
+    const auto iter = std::find_if(harvests.begin(), harvests.end(), [&deviceName](const Harvest &harvest) {
+        return (!deviceName.isNull()) && (harvest.deviceName == deviceName);
+    });
+    if (iter == harvests.end()) {
+        qCDebug(lc).noquote() << tr(R"(Ignoring non-requested Pokit device "%1" (%2) at (%3).)")
+            .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+        return;
+    }
+
+    const int index = (int)(iter - harvests.begin());
+    qCDebug(lc).noquote() << tr(R"(Found Pokit device "%1" (%2) at (%3).)")
+        .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+    Harvest &harvest = *iter;
+    harvest.device = new PokitDevice(info, this);
+    harvest.service = harvest.device->dataLogger();
+    Q_ASSERT(harvest.service);
+    harvest.service->setPokitProduct(pokitProduct(info));
+
+    const QLowEnergyController * const controller = harvest.device->controller();
+    connect(controller, &QLowEnergyController::disconnected, this, [this, index]() {
+        const Harvest &harvest = harvests.at(index);
+        finishHarvest(index, harvest.samplesToGo != 0); // Ie failed if disconnected before all samples fetched.
+    });
+    connect(controller,
+        #if (QT_VERSION < QT_VERSION_CHECK(6, 2, 0))
+        QOverload<QLowEnergyController::Error>::of(&QLowEnergyController::error),
+        #else
+        &QLowEnergyController::errorOccurred,
+        #endif
+        this, [this, index](const QLowEnergyController::Error error) {
+            qCWarning(lc).noquote() << tr(R"(Bluetooth controller error for device "%1":)")
+                .arg(harvests.at(index).deviceName) << error;
+            finishHarvest(index, true);
+        }, Qt::QueuedConnection);
+    connect(harvest.service, &AbstractPokitService::serviceDetailsDiscovered, this, [this, index]() {
+        fetchSamples(index);
+    });
+    connect(harvest.service, &AbstractPokitService::serviceErrorOccurred,
+        this, [this, index](const QLowEnergyService::ServiceError error) {
+            qCWarning(lc).noquote() << tr(R"(Bluetooth service error for device "%1":)")
+                .arg(harvests.at(index).deviceName) << error;
+            finishHarvest(index, true);
+        });
+    connect(harvest.service, &DataLoggerService::metadataRead,
+        this, [this, index](const DataLoggerService::Metadata &metadata) { metadataRead(index, metadata); });
+    connect(harvest.service, &DataLoggerService::samplesRead,
+        this, [this, index](const DataLoggerService::Samples &samples) { samplesRead(index, samples); });
+
+    pending.append(index);
+    if (devicesToScanFor.isEmpty()) {
+        discoveryFinished = true; // takeDevice() has stopped discovery, since all requested devices were found.
+    }
+    connectPending();
+}
+
+/*!
+ * Reports any requested devices that were not discovered, and outputs whatever was harvested from the rest, once
+ * complete.
+ */
+void LoggerHarvestCommand::deviceDiscoveryFinished()
+{
+    discoveryFinished = true;
+    for (Harvest &harvest: harvests) {
+        if (!harvest.device) {
+            qCWarning(lc).noquote() << tr(R"(Failed to find device "%1".)").arg(harvest.deviceName);
+            harvest.finished = harvest.failed = true;
+        }
+    }
+    checkComplete();
+}
+
+/*!
+ * Begins connecting to pending devices, until either there are no more pending devices, or the maximum number of
+ * concurrent connections has been reached.
+ */
+void LoggerHarvestCommand::connectPending()
+{
+    while ((activeConnections < maxConnections) && (!pending.isEmpty())) {
+        Harvest &harvest = harvests[pending.takeFirst()];
+        Q_ASSERT(harvest.device);
+        Q_ASSERT(!harvest.connected);
+        harvest.connected = true;
+        ++activeConnections;
+        qCDebug(lc).noquote() << tr(R"(Connecting to device "%1" (%2 of %3 connections).)")
+            .arg(harvest.deviceName).arg(activeConnections).arg(maxConnections);
+        harvest.device->controller()->connectToDevice();
+    }
+}
+
+/*!
+ * Begins fetching the data logger samples from the device at \a index, once its service details have been
+ * discovered.
+ */
+void LoggerHarvestCommand::fetchSamples(const int index)
+{
+    DataLoggerService * const service = harvests.at(index).service;
+    qCInfo(lc).noquote() << tr(R"(Fetching logger samples from device "%1"...)").arg(harvests.at(index).deviceName);
+    service->enableMetadataNotifications();
+    service->enableReadingNotifications();
+    service->fetchSamples();
+}
+
+/*!
+ * Invoked when \a metadata has been received from the device at \a index.
+ */
+void LoggerHarvestCommand::metadataRead(const int index, const DataLoggerService::Metadata &metadata)
+{
+    Harvest &harvest = harvests[index];
+    qCDebug(lc).noquote() << tr(R"(Fetching %Ln logger sample/s from device "%1"...)", nullptr,
+        metadata.numberOfSamples).arg(harvest.deviceName);
+    harvest.metadata = metadata;
+    harvest.samples.clear();
+    harvest.samples.reserve(metadata.numberOfSamples);
+    harvest.samplesToGo = metadata.numberOfSamples;
+    if (harvest.samplesToGo <= 0) {
+        harvest.device->controller()->disconnectFromDevice();
+    }
+}
+
+/*!
+ * Invoked when \a samples have been received from the device at \a index.
+ */
+void LoggerHarvestCommand::samplesRead(const int index, const DataLoggerService::Samples &samples)
+{
+    Harvest &harvest = harvests[index];
+    if (harvest.samplesToGo < 0) {
+        qCWarning(lc).noquote() << tr(R"(Ignoring logger samples from device "%1", received before metadata.)")
+            .arg(harvest.deviceName);
+        return;
+    }
+    harvest.samples.append(samples);
+    harvest.samplesToGo -= samples.size();
+    if (harvest.samplesToGo <= 0) {
+        qCInfo(lc).noquote() << tr(R"(Finished fetching %Ln sample/s from device "%1".)", nullptr,
+            harvest.samples.size()).arg(harvest.deviceName);
+        harvest.samplesToGo = 0;
+        harvest.device->controller()->disconnectFromDevice();
+    }
+}
+
+/*!
+ * Marks the harvest at \a index as finished (or \a failed), freeing its connection for the next pending device.
+ */
+void LoggerHarvestCommand::finishHarvest(const int index, const bool failed)
+{
+    Harvest &harvest = harvests[index];
+    if (harvest.finished) {
+        return; // Already finished, such as by a controller error before disconnecting.
+    }
+    harvest.finished = true;
+    harvest.failed = failed;
+    if (failed) {
+        qCWarning(lc).noquote() << tr(R"(Failed to harvest all logger samples from device "%1".)")
+            .arg(harvest.deviceName);
+        if ((harvest.device) && (harvest.device->controller()->state() != QLowEnergyController::UnconnectedState)) {
+            harvest.device->controller()->disconnectFromDevice(); // Free the connection for other devices.
+        }
+    }
+    if (harvest.connected) {
+        --activeConnections;
+    }
+    connectPending();
+    checkComplete();
+}
+
+/*!
+ * Outputs the merged samples, and exits, once all requested devices have either been harvested, or failed.
+ */
+void LoggerHarvestCommand::checkComplete()
+{
+    if ((outputComplete) || (!discoveryFinished) ||
+        (!std::all_of(harvests.cbegin(), harvests.cend(), [](const Harvest &harvest){ return harvest.finished; })))
+    {
+        return;
+    }
+    outputSamples();
+    outputComplete = true;
+    const bool failed = std::any_of(harvests.cbegin(), harvests.cend(),
+        [](const Harvest &harvest){ return harvest.failed; });
+    QCoreApplication::exit((failed) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*!
+ * Returns the \a msecs timestamp formatted according to the selected time format; that is, either as epoch
+ * milliseconds, or an ISO 8601 UTC date and time.
+ */
+QByteArray LoggerHarvestCommand::formatTimestamp(const quint64 msecs) const
+{
+    return (epochTimestamps) ? QByteArray::number(msecs)
+        : QDateTime::fromMSecsSinceEpoch((qint64)msecs, DOKIT_QT_UTC).toString(Qt::ISODateWithMs).toLatin1();
+}
+
+/*!
+ * Outputs all harvested samples, in the selected output format, as a single stream ordered by timestamp.
+ *
+ * Each harvest's samples are already in timestamp order, so this is a k-way merge (via a min-heap of each harvest's
+ * next sample). Samples with equal timestamps are output in device (ie command line) order.
+ */
+void LoggerHarvestCommand::outputSamples()
+{
+    using Next = std::tuple<quint64, int, qsizetype>; // Timestamp, harvest index, and sample index.
+    std::priority_queue<Next, std::vector<Next>, std::greater<Next>> heap;
+    const auto timestampOf = [this](const int harvest, const qsizetype sample) {
+        const DataLoggerService::Metadata &metadata = harvests.at(harvest).metadata;
+        return (quint64)metadata.timestamp * 1000 + (quint64)sample * metadata.updateInterval;
+    };
+    for (int index = 0; index < harvests.size(); ++index) {
+        if (!harvests.at(index).samples.isEmpty()) {
+            heap.emplace(timestampOf(index, 0), index, 0);
+        }
+    }
+
+    // These are constant per harvest, so prepare them just once.
+    QVector<QString> units, ranges;
+    for (const Harvest &harvest: harvests) {
+        units.append(LoggerFetchCommand::toUnit(harvest.metadata.mode));
+        ranges.append((harvest.service) ? harvest.service->toString(harvest.metadata.range, harvest.metadata.mode)
+                                        : QString());
+    }
+    const QString textFormat = tr("%1 %2 %3 %4\n");
+
+    bool showCsvHeader = true;
+    while (!heap.empty()) {
+        const Next next = heap.top();
+        heap.pop();
+        const auto [timestamp, index, sample] = next;
+        const Harvest &harvest = harvests.at(index);
+        const float value = harvest.samples.at(sample) * harvest.metadata.scale;
+        const QByteArray timeString = formatTimestamp(timestamp);
+        switch (format) {
+        case OutputFormat::Csv:
+            for (; showCsvHeader; showCsvHeader = false) {
+                output(tr("timestamp,device,value,unit,range\n"));
+            }
+            output(QString::fromLatin1(timeString) + u',' + escapeCsvField(harvest.deviceName) + u',' +
+                   QString::number(value) + u',' + units.at(index) + u',' + escapeCsvField(ranges.at(index)) +
+                   u'\n');
+            break;
+        case OutputFormat::Json: {
+            QJsonObject object{
+                { u"timestamp"_s, (epochTimestamps) ? QJsonValue((qint64)timestamp)
+                                                    : QJsonValue(QString::fromLatin1(timeString)) },
+                { u"device"_s,    harvest.deviceName },
+                { u"value"_s,     value },
+                { u"unit"_s,      units.at(index) },
+                { u"mode"_s,      DataLoggerService::toString(harvest.metadata.mode) },
+            };
+            if (!ranges.at(index).isEmpty()) {
+                object.insert(u"range"_s, ranges.at(index));
+            }
+            output(QJsonDocument(object).toJson());
+        }   break;
+        case OutputFormat::Ndjson:
+            outputBuffer.append("{\"timestamp\":")
+                .append((epochTimestamps) ? timeString : ('"' + timeString + '"'))
+                .append(",\"device\":").append(escapeJsonString(harvest.deviceName))
+                .append(",\"value\":").append(formatJsonNumber(value))
+                .append(",\"unit\":").append(escapeJsonString(units.at(index)))
+                .append(",\"mode\":").append(escapeJsonString(DataLoggerService::toString(harvest.metadata.mode)))
+                .append((ranges.at(index).isEmpty()) ? QByteArray()
+                        : ",\"range\":" + escapeJsonString(ranges.at(index)))
+                .append("}\n");
+            break;
+        case OutputFormat::Arrow:
+        case OutputFormat::LineProtocol:
+        case OutputFormat::Binary:
+        case OutputFormat::NdjsonEnvelope:
+        case OutputFormat::Text:
+            output(textFormat.arg(QString::fromLatin1(timeString), harvest.deviceName)
+                .arg(value).arg(units.at(index)));
+            break;
+        }
+
+        // Replace this harvest's sample with its next one (if any).
+        if (sample + 1 < harvest.samples.size()) {
+            heap.emplace(timestampOf(index, sample + 1), index, sample + 1);
+        }
+    }
+    outputBatchComplete();
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+
+#include <qtpokit/dataloggerservice.h>
+
+#include <QLowEnergyController>
+
+QTPOKIT_FORWARD_DECLARE_CLASS(PokitDevice)
+QTPOKIT_USE_NAMESPACE
+
+class LoggerHarvestCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit LoggerHarvestCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected:
+    bool supportsNdjsonOutput() const override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// Progress of the fetch from a single requested device.
+    struct Harvest {
+        QString deviceName;                      ///< Device, as requested via \c --device, to tag samples with.
+        PokitDevice * device { nullptr };        ///< Discovered device, or \c nullptr if not (yet) discovered.
+        DataLoggerService * service { nullptr }; ///< Discovered device's data logger service.
+        DataLoggerService::Metadata metadata {   ///< Metadata of the logging session being fetched.
+            DataLoggerService::LoggerStatus::Error, 0.0f, DataLoggerService::Mode::Idle, 0, 0, 0, 0
+        };
+        DataLoggerService::Samples samples;      ///< Samples fetched so far.
+        qint32 samplesToGo { -1 };               ///< Number of samples still expected, or -1 if metadata not read.
+        bool connected { false };                ///< Whether a connection to #device has been started.
+        bool finished { false };                 ///< Whether this harvest has completed (or failed).
+        bool failed { false };                   ///< Whether this harvest failed.
+    };
+
+    QVector<Harvest> harvests;   ///< One harvest per requested device, in command line order.
+    QVector<int> pending;        ///< Indexes of discovered #harvests, waiting for a free connection.
+    int activeConnections { 0 }; ///< Number of devices currently connected, or connecting.
+    int maxConnections { 3 };    ///< Maximum number of concurrent device connections.
+    bool discoveryFinished { false }; ///< Whether device discovery has finished (or been stopped).
+    bool outputComplete { false };    ///< Whether the merged output has been written.
+    bool epochTimestamps { false };   ///< Whether to output timestamps as epoch milliseconds, instead of ISO 8601.
+
+    void connectPending();
+    void fetchSamples(const int index);
+    void metadataRead(const int index, const DataLoggerService::Metadata &metadata);
+    void samplesRead(const int index, const DataLoggerService::Samples &samples);
+    void finishHarvest(const int index, const bool failed);
+    void checkComplete();
+    QByteArray formatTimestamp(const quint64 msecs) const;
+    void outputSamples();
+
+    QTPOKIT_BEFRIEND_TEST(LoggerHarvestCommand)
+};
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "loggerstartcommand.h"
+#include "phasetimer.h"
 #include "../stringliterals_p.h"
 
 #include <qtpokit/pokitdevice.h>
@@ -57,46 +58,61 @@ QStringList LoggerStartCommand::processOptions(const QCommandLineParser &parser)
         return errors;
     }
 
+    errors.append(parseSettings(parser, settings, minRangeFunc, rangeOptionValue));
+    return errors;
+}
+
+/*!
+ * Parses the data logger options (mode, range, interval and timestamp) from \a parser into \a settings, \a rangeFunc
+ * and \a rangeValue, returning a list of any errors.
+ *
+ * This is shared with LoggerStartFleetCommand, so that both commands start data loggers the same way.
+ */
+QStringList LoggerStartCommand::parseSettings(const QCommandLineParser &parser, DataLoggerService::Settings &settings,
+                                              MinRangeFunc &rangeFunc, quint32 &rangeValue)
+{
+    QStringList errors;
+
     // Parse the (required) mode option.
     if (const QString mode = parser.value(u"mode"_s).trimmed().toLower();
         mode.startsWith(u"ac v"_s) || mode.startsWith(u"vac"_s)) {
         settings.mode = DataLoggerService::Mode::AcVoltage;
-        minRangeFunc = minVoltageRange;
+        rangeFunc = minVoltageRange;
     } else if (mode.startsWith(u"dc v"_s) || mode.startsWith(u"vdc"_s)) {
         settings.mode = DataLoggerService::Mode::DcVoltage;
-        minRangeFunc = minVoltageRange;
+        rangeFunc = minVoltageRange;
     } else if (mode.startsWith(u"ac c"_s) || mode.startsWith(u"aac"_s)) {
         settings.mode = DataLoggerService::Mode::AcCurrent;
-        minRangeFunc = minCurrentRange;
+        rangeFunc = minCurrentRange;
     } else if (mode.startsWith(u"dc c"_s) || mode.startsWith(u"adc"_s)) {
         settings.mode = DataLoggerService::Mode::DcCurrent;
-        minRangeFunc = minCurrentRange;
+        rangeFunc = minCurrentRange;
     } else if (mode.startsWith(u"temp"_s)) {
         settings.mode = DataLoggerService::Mode::Temperature;
-        minRangeFunc = nullptr;
+        rangeFunc = nullptr;
     } else {
-        minRangeFunc = nullptr;
+        rangeFunc = nullptr;
         errors.append(tr("Unknown logger mode: %1").arg(parser.value(u"mode"_s)));
         return errors;
     }
 
     // Parse the range option.
-    rangeOptionValue = 0;
+    rangeValue = 0;
     if (parser.isSet(u"range"_s)) {
         const QString value = parser.value(u"range"_s);
         switch (settings.mode) {
         case DataLoggerService::Mode::DcVoltage:
         case DataLoggerService::Mode::AcVoltage:
-            rangeOptionValue = parseNumber<std::milli>(value, u"V"_s, 50); // mV.
+            rangeValue = parseNumber<std::milli>(value, u"V"_s, 50); // mV.
             break;
         case DataLoggerService::Mode::DcCurrent:
         case DataLoggerService::Mode::AcCurrent:
-            rangeOptionValue = parseNumber<std::milli>(value, u"A"_s, 5); // mA.
+            rangeValue = parseNumber<std::milli>(value, u"A"_s, 5); // mA.
             break;
         default:
             qCInfo(lc).noquote() << tr("Ignoring range value: %1").arg(value);
         }
-        if ((minRangeFunc != nullptr) && (rangeOptionValue == 0)) {
+        if ((rangeFunc != nullptr) && (rangeValue == 0)) {
             errors.append(tr("Invalid range value: %1").arg(value));
         }
     } else if (settings.mode != DataLoggerService::Mode::Temperature) {
@@ -181,6 +197,7 @@ void LoggerStartCommand::serviceDetailsDiscovered()
 void LoggerStartCommand::settingsWritten()
 {
     qCDebug(lc).noquote() << tr("Settings written; data logger has started.");
+    PhaseTimer::mark(PhaseTimer::Phase::SettingsWritten);
     switch (format) {
     case OutputFormat::Csv:
         std::cout << qUtf8Printable(tr("logger_start_result\nsuccess\n"));
@@ -188,6 +205,11 @@ void LoggerStartCommand::settingsWritten()
     case OutputFormat::Json:
         std::cout << qUtf8Printable(u"true\n"_s);
         break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         std::cout << qUtf8Printable(tr("Done.\n"));
         break;
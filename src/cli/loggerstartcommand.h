@@ -12,11 +12,16 @@ class LoggerStartCommand : public DeviceCommand
     Q_OBJECT
 
 public:
+    typedef quint8 (* MinRangeFunc)(const PokitProduct product, const quint32 maxValue);
+
     explicit LoggerStartCommand(QObject * const parent = nullptr);
 
     QStringList requiredOptions(const QCommandLineParser &parser) const override;
     QStringList supportedOptions(const QCommandLineParser &parser) const override;
 
+    static QStringList parseSettings(const QCommandLineParser &parser, DataLoggerService::Settings &settings,
+                                     MinRangeFunc &rangeFunc, quint32 &rangeValue);
+
 public slots:
     QStringList processOptions(const QCommandLineParser &parser) override;
 
@@ -27,7 +32,7 @@ protected slots:
     void serviceDetailsDiscovered() override;
 
 private:
-    quint8 (* minRangeFunc)(const PokitProduct product, const quint32 maxValue) { nullptr };
+    MinRangeFunc minRangeFunc { nullptr };
     quint32 rangeOptionValue { 0 };          ///< The parsed value of range option.
     DataLoggerService * service { nullptr }; ///< Bluetooth service this command interacts with.
     DataLoggerService::Settings settings {   ///< Settings for the Pokit device's data logger mode.
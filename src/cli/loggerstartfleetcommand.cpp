@@ -0,0 +1,446 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "loggerstartfleetcommand.h"
+#include "loggerstartcommand.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/pokitconnectionmanager.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitdiscoveryagent.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class LoggerStartFleetCommand
+ *
+ * The LoggerStartFleetCommand class implements the `logger-start-fleet` CLI command.
+ *
+ * Unlike `logger-start`, which starts a single device's data logger, this command starts the data loggers of each of
+ * the devices given via `--device` (and/or listed in a `--device-list` file), with the same settings and the one
+ * shared `--timestamp`, so that their logs can later be aligned sample-for-sample.
+ *
+ * To start the loggers as close together as possible, the command works in two phases. First, every device is
+ * connected to (via a PokitConnectionManager), and its data logger service prepared, with each connection held
+ * open until all devices are ready (or have failed). Then the start is written to every ready device back-to-back,
+ * from the one event loop iteration, and the time each device acknowledges its start is recorded.
+ *
+ * Once every device has either started, or failed, a summary of each device's result is output, including its start
+ * skew (how long after the first device's acknowledgement its own start was acknowledged).
+ */
+
+/*!
+ * Construct a new LoggerStartFleetCommand object with \a parent.
+ */
+LoggerStartFleetCommand::LoggerStartFleetCommand(QObject * const parent)
+    : AbstractCommand(parent), manager(new PokitConnectionManager(this))
+{
+    manager->setIdleTimeout(0); // Each logger is started just the once, so disconnect as soon as released.
+    connect(manager, &PokitConnectionManager::granted, this, &LoggerStartFleetCommand::granted, Qt::QueuedConnection);
+    connect(manager, &PokitConnectionManager::failed, this, &LoggerStartFleetCommand::failed, Qt::QueuedConnection);
+}
+
+QStringList LoggerStartFleetCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser) + QStringList{
+        u"mode"_s,
+    };
+}
+
+QStringList LoggerStartFleetCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"device-list"_s,
+        u"interval"_s,
+        u"max-connections"_s,
+        u"range"_s, // May still be required by processOptions(), depending on the --mode option's value.
+        u"timestamp"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList LoggerStartFleetCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the device and device-list options, either (or both) of which may list multiple devices.
+    QStringList devices = parser.values(u"device"_s);
+    if (parser.isSet(u"device-list"_s)) {
+        QFile file(parser.value(u"device-list"_s));
+        if (file.open(QIODevice::ReadOnly|QIODevice::Text)) {
+            devices.append(readDeviceList(file));
+        } else {
+            errors.append(tr("Failed to open device list %1: %2").arg(file.fileName(), file.errorString()));
+        }
+    }
+    devices = parseDeviceList(devices);
+    loggers.clear();
+    for (const QString &deviceName: devices) {
+        loggers.append(Logger{ deviceName });
+    }
+    devicesToScanFor = devices;
+    if ((loggers.isEmpty()) && (errors.isEmpty())) {
+        errors.append(tr("No devices to start"));
+    }
+
+    // Parse the mode, range, interval and timestamp options, exactly as the logger-start command does.
+    errors.append(LoggerStartCommand::parseSettings(parser, settings, minRangeFunc, rangeOptionValue));
+    timestampOption = parser.isSet(u"timestamp"_s);
+
+    // Parse the max-connections option, which must allow every device to be connected at once.
+    maxConnections = (int)loggers.size();
+    if (parser.isSet(u"max-connections"_s)) {
+        const QString value = parser.value(u"max-connections"_s);
+        bool ok;
+        const int connections = value.toInt(&ok);
+        if ((!ok) || (connections <= 0)) {
+            errors.append(tr("Invalid max-connections value: %1").arg(value));
+        } else if (connections < loggers.size()) {
+            errors.append(tr("The max-connections value (%1) must allow all %Ln device/s to be connected at once",
+                             nullptr, loggers.size()).arg(connections));
+        } else {
+            maxConnections = connections;
+        }
+    }
+    manager->setMaxConnections(maxConnections);
+    return errors;
+}
+
+/*!
+ * Begins scanning for the requested Pokit devices.
+ */
+bool LoggerStartFleetCommand::start()
+{
+    qCInfo(lc).noquote() << tr("Looking for %Ln Pokit device/s to start logging %1...", nullptr, loggers.size())
+        .arg(DataLoggerService::toString(settings.mode));
+    discoveryAgent->start();
+    return true;
+}
+
+/*!
+ * Checks if \a info is one of the (not yet discovered) devices to start, and if so, requests a connection to it.
+ *
+ * Discovery continues until all requested devices have been discovered (see AbstractCommand::takeDevice()), so that
+ * devices may be connected to, and prepared, while others are still being discovered.
+ */
+void LoggerStartFleetCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_ASSERT(isPokitProduct(info));
+
+    const QString deviceName = takeDevice(info);
+    const auto iter = std::find_if(loggers.begin(), loggers.end(),
+        [&deviceName](const Logger &logger) {
+            return (!deviceName.isNull()) && (logger.deviceName == deviceName);
+        });
+    if (iter == loggers.end()) {
+        qCDebug(lc).noquote() << tr(R"(Ignoring non-requested Pokit device "%1" (%2) at (%3).)")
+            .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+        return;
+    }
+
+    qCDebug(lc).noquote() << tr(R"(Found Pokit device "%1" (%2) at (%3).)")
+        .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+    iter->discovered = true;
+    iter->ticket = manager->request(info);
+    if (devicesToScanFor.isEmpty()) {
+        discoveryFinished = true; // takeDevice() has stopped discovery, since all requested devices were found.
+    }
+}
+
+/*!
+ * Fails any requested devices that were not discovered, and starts the rest once they are all ready.
+ */
+void LoggerStartFleetCommand::deviceDiscoveryFinished()
+{
+    discoveryFinished = true;
+    for (int index = 0; index < loggers.size(); ++index) {
+        if (!loggers.at(index).discovered) {
+            qCWarning(lc).noquote() << tr(R"(Failed to find device "%1".)").arg(loggers.at(index).deviceName);
+            finishLogger(index, tr("Device not found"));
+        }
+    }
+    checkReady();
+    checkComplete();
+}
+
+/*!
+ * Returns the index of the logger that holds connection request \a ticket, or -1 if none.
+ */
+int LoggerStartFleetCommand::indexOf(const quint32 ticket) const
+{
+    const auto iter = std::find_if(loggers.cbegin(), loggers.cend(),
+        [ticket](const Logger &logger) { return (ticket != 0) && (logger.ticket == ticket); });
+    return (iter == loggers.cend()) ? -1 : (int)(iter - loggers.cbegin());
+}
+
+/*!
+ * Handles PokitConnectionManager::granted events, by preparing the newly connected \a device for \a ticket.
+ */
+void LoggerStartFleetCommand::granted(const quint32 ticket, PokitDevice * const device)
+{
+    const int index = indexOf(ticket);
+    if (index < 0) {
+        manager->release(ticket); // No longer wanted, such as already finished.
+        return;
+    }
+    qCDebug(lc).noquote() << tr(R"(Connected to device "%1" (%2 of %3 connections).)")
+        .arg(loggers.at(index).deviceName).arg(manager->connectionCount()).arg(maxConnections);
+    prepare(index, device);
+}
+
+/*!
+ * Handles PokitConnectionManager::failed events, by failing the logger for \a ticket.
+ */
+void LoggerStartFleetCommand::failed(const quint32 ticket)
+{
+    const int index = indexOf(ticket);
+    if (index < 0) {
+        return;
+    }
+    qCWarning(lc).noquote() << tr(R"(Lost connection to device "%1".)").arg(loggers.at(index).deviceName);
+    loggers[index].ticket = 0; // No longer valid, so nothing to release.
+    finishLogger(index, tr("Connection failed"));
+}
+
+/*!
+ * Prepares the data logger service of \a device (leased for the logger at \a index), marking the logger as ready
+ * once the service's details have been discovered.
+ */
+void LoggerStartFleetCommand::prepare(const int index, PokitDevice * const device)
+{
+    DataLoggerService * const service = device->dataLogger();
+    Q_ASSERT(service);
+    loggers[index].service = service;
+    connect(service, &DataLoggerService::settingsWritten, this, [this, index]() {
+        Logger &logger = loggers[index];
+        if ((logger.issuedAt < 0) || (logger.finished)) {
+            return; // Not started by this command.
+        }
+        logger.startedAt = clock.nsecsElapsed();
+        qCDebug(lc).noquote() << tr(R"(Started data logger on device "%1", %L2ms after issuing.)")
+            .arg(logger.deviceName).arg((logger.startedAt - logger.issuedAt) / 1'000'000.0, 0, 'f', 3);
+        finishLogger(index);
+    });
+    connect(service, &AbstractPokitService::serviceErrorOccurred,
+        this, [this, index](const QLowEnergyService::ServiceError error) {
+            qCWarning(lc).noquote() << tr(R"(Bluetooth service error for device "%1":)")
+                .arg(loggers.at(index).deviceName) << error;
+            finishLogger(index, tr("Bluetooth service error"));
+        });
+    connect(device, &PokitDevice::servicesPrepared,
+        this, [this, index](const PokitDevice::Services prepared, const PokitDevice::Services failed) {
+            Logger &logger = loggers[index];
+            if ((logger.ready) || (logger.finished)) {
+                return;
+            }
+            if (failed.testFlag(PokitDevice::Service::DataLogger)) {
+                finishLogger(index, tr("Data logger service not available"));
+            } else if (prepared.testFlag(PokitDevice::Service::DataLogger)) {
+                qCDebug(lc).noquote() << tr(R"(Device "%1" is ready to start.)").arg(logger.deviceName);
+                logger.ready = true;
+                checkReady();
+            }
+        });
+    if (!device->prepareServices(PokitDevice::Service::DataLogger)) {
+        finishLogger(index, tr("Data logger service not available"));
+    }
+}
+
+/*!
+ * Starts all of the ready loggers, once every requested device is either ready, or has failed.
+ */
+void LoggerStartFleetCommand::checkReady()
+{
+    if ((started) || (exiting) || (!discoveryFinished) || (!std::all_of(loggers.cbegin(), loggers.cend(),
+        [](const Logger &logger){ return (logger.ready) || (logger.finished); })))
+    {
+        return;
+    }
+    startAll();
+}
+
+/*!
+ * Issues the start to every ready logger, back-to-back, with the one shared timestamp.
+ *
+ * Everything that can be done beforehand (such as resolving each product's range) is, so that the loop that issues
+ * the starts does nothing but queue each device's characteristic write. Any loggers that fail to issue are only
+ * finished after all others have been issued, for the same reason.
+ */
+void LoggerStartFleetCommand::startAll()
+{
+    started = true;
+    if (!timestampOption) {
+        // Take 'now' as late as possible, since connecting to all devices may have taken some time.
+        settings.timestamp = (quint32)QDateTime::currentSecsSinceEpoch(); // Note, subject to Y2038 epochalypse.
+    }
+
+    QVector<int> indexes;
+    QVector<DataLoggerService::Settings> deviceSettings;
+    for (int index = 0; index < loggers.size(); ++index) {
+        const Logger &logger = loggers.at(index);
+        if ((!logger.ready) || (logger.finished)) {
+            continue;
+        }
+        DataLoggerService::Settings loggerSettings = settings;
+        const std::optional<PokitProduct> product = logger.service->pokitProduct();
+        loggerSettings.range = ((minRangeFunc == nullptr) || (!product)) ? 0
+            : minRangeFunc(*product, rangeOptionValue);
+        indexes.append(index);
+        deviceSettings.append(loggerSettings);
+    }
+    qCInfo(lc).noquote() << tr("Starting %Ln data logger/s, with timestamp %1...", nullptr, indexes.size())
+        .arg(settings.timestamp);
+
+    QVector<int> failures;
+    clock.start();
+    for (int i = 0; i < indexes.size(); ++i) {
+        Logger &logger = loggers[indexes.at(i)];
+        logger.issuedAt = clock.nsecsElapsed();
+        if (!logger.service->setSettings(deviceSettings.at(i))) {
+            failures.append(indexes.at(i));
+        }
+    }
+    qCDebug(lc).noquote() << tr("Issued %Ln start/s in %L1ms.", nullptr, indexes.size())
+        .arg(clock.nsecsElapsed() / 1'000'000.0, 0, 'f', 3);
+
+    for (const int index: std::as_const(failures)) {
+        finishLogger(index, tr("Failed to write data logger settings"));
+    }
+    checkComplete(); // In case there were no ready loggers to start.
+}
+
+/*!
+ * Marks the logger at \a index as finished, or failed if \a error is not null, releasing its connection (if any).
+ */
+void LoggerStartFleetCommand::finishLogger(const int index, const QString &error)
+{
+    Logger &logger = loggers[index];
+    if (logger.finished) {
+        return; // Already finished, such as by a service error before disconnecting.
+    }
+    logger.finished = true;
+    logger.error = error;
+    if (logger.ticket != 0) {
+        manager->release(std::exchange(logger.ticket, 0)); // Disconnects, since the idle timeout is zero.
+    }
+    checkReady(); // This may have been the last device the others were waiting for.
+    checkComplete();
+}
+
+/*!
+ * Outputs the summary, and exits, once all requested devices have either started, or failed.
+ */
+void LoggerStartFleetCommand::checkComplete()
+{
+    if ((exiting) || (!discoveryFinished) || (!std::all_of(loggers.cbegin(), loggers.cend(),
+        [](const Logger &logger){ return logger.finished; })))
+    {
+        return;
+    }
+    exiting = true;
+    outputSummary();
+    const bool failed = std::any_of(loggers.cbegin(), loggers.cend(),
+        [](const Logger &logger){ return !logger.error.isNull(); });
+    QCoreApplication::exit((failed) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*!
+ * Returns the number of nanoseconds between the first started logger's acknowledgement, and that of the logger at
+ * \a index, or -1 if the logger at \a index has not started.
+ */
+qint64 LoggerStartFleetCommand::skew(const int index) const
+{
+    if (loggers.at(index).startedAt < 0) {
+        return -1;
+    }
+    qint64 first = loggers.at(index).startedAt;
+    for (const Logger &logger: loggers) {
+        if (logger.startedAt >= 0) {
+            first = qMin(first, logger.startedAt);
+        }
+    }
+    return loggers.at(index).startedAt - first;
+}
+
+/*!
+ * Outputs each requested device's start result, and skew, in command line order, in the selected output format.
+ */
+void LoggerStartFleetCommand::outputSummary()
+{
+    const auto skewMs = [this](const int index) {
+        return QString::number(skew(index) / 1'000'000.0, 'f', 3);
+    };
+    switch (format) {
+    case OutputFormat::Csv:
+        output(tr("device,logger_start_result,timestamp,skew_ms,error\n"));
+        for (int index = 0; index < loggers.size(); ++index) {
+            const Logger &logger = loggers.at(index);
+            output(escapeCsvField(logger.deviceName) + u',' +
+                   ((logger.error.isNull()) ? u"success"_s : u"failure"_s) + u',' +
+                   QString::number(settings.timestamp) + u',' +
+                   ((logger.error.isNull()) ? skewMs(index) : QString()) + u',' +
+                   escapeCsvField(logger.error) + u'\n');
+        }
+        break;
+    case OutputFormat::Json: {
+        QJsonArray array;
+        for (int index = 0; index < loggers.size(); ++index) {
+            const Logger &logger = loggers.at(index);
+            QJsonObject object{
+                { u"device"_s,  logger.deviceName },
+                { u"success"_s, logger.error.isNull() },
+            };
+            if (logger.error.isNull()) {
+                object.insert(u"skew_ms"_s, skew(index) / 1'000'000.0);
+            } else {
+                object.insert(u"error"_s, logger.error);
+            }
+            array.append(object);
+        }
+        output(QJsonDocument(QJsonObject{
+            { u"timestamp"_s, (qint64)settings.timestamp },
+            { u"devices"_s,   array },
+        }).toJson());
+    }   break;
+    case OutputFormat::Arrow:          // Not supported.
+    case OutputFormat::LineProtocol:   // Not supported.
+    case OutputFormat::Binary:         // Not supported.
+    case OutputFormat::Ndjson:         // Not supported.
+    case OutputFormat::NdjsonEnvelope: // Not supported.
+    case OutputFormat::Text: {
+        int failures = 0;
+        qint64 spread = 0;
+        for (int index = 0; index < loggers.size(); ++index) {
+            const Logger &logger = loggers.at(index);
+            if (logger.error.isNull()) {
+                output(tr("%1: started (+%2ms)\n").arg(logger.deviceName, skewMs(index)));
+                spread = qMax(spread, skew(index));
+            } else {
+                output(tr("%1: failed (%2)\n").arg(logger.deviceName, logger.error));
+                ++failures;
+            }
+        }
+        output(tr("Started %Ln of %1 data logger/s, with timestamp %2, within %3ms.\n", nullptr,
+                  (int)loggers.size() - failures).arg(loggers.size()).arg(settings.timestamp)
+                  .arg(spread / 1'000'000.0, 0, 'f', 3));
+    }   break;
+    }
+    outputBatchComplete();
+}
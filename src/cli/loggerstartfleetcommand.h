@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+
+#include <qtpokit/dataloggerservice.h>
+#include <qtpokit/pokitmeter.h>
+
+#include <QElapsedTimer>
+
+QTPOKIT_FORWARD_DECLARE_CLASS(PokitConnectionManager)
+QTPOKIT_FORWARD_DECLARE_CLASS(PokitDevice)
+QTPOKIT_USE_NAMESPACE
+
+class LoggerStartFleetCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit LoggerStartFleetCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// Progress of starting the data logger of a single requested device.
+    struct Logger {
+        QString deviceName;               ///< Device, as requested, to report the result for.
+        quint32 ticket { 0 };             ///< Connection request ticket, or 0 if not (or no longer) requested.
+        bool discovered { false };        ///< Whether the device has been discovered.
+        DataLoggerService * service { nullptr }; ///< Device's data logger service, once connected.
+        bool ready { false };             ///< Whether the data logger service is ready to be started.
+        qint64 issuedAt { -1 };           ///< When the start was issued, in #clock nanoseconds, or -1 if not yet.
+        qint64 startedAt { -1 };          ///< When the start was acknowledged, in #clock nanoseconds, or -1 if not.
+        bool finished { false };          ///< Whether this start has completed (or failed).
+        QString error;                    ///< Reason this start failed, or a null string if it succeeded.
+    };
+
+    PokitConnectionManager * manager;     ///< Holds one connection per requested device, until all have started.
+    QVector<Logger> loggers;              ///< One logger per requested device, in command line order.
+    int maxConnections { 0 };             ///< Maximum number of concurrent device connections, or 0 for all.
+    quint8 (* minRangeFunc)(const PokitProduct product, const quint32 maxValue) { nullptr };
+    quint32 rangeOptionValue { 0 };       ///< The parsed value of range option.
+    bool timestampOption { false };       ///< Whether the timestamp was given, rather than taken at start.
+    DataLoggerService::Settings settings {   ///< Settings shared by every Pokit device's data logger.
+        DataLoggerService::Command::Start, 0, DataLoggerService::Mode::DcVoltage,
+        +PokitMeter::VoltageRange::AutoRange, 60'000, 0
+    };
+    QElapsedTimer clock;                  ///< Times each start, from the moment the first was issued.
+    bool discoveryFinished { false };     ///< Whether device discovery has finished (or been stopped).
+    bool started { false };               ///< Whether the starts have been issued to all ready devices.
+    bool exiting { false };               ///< Whether all devices have finished, and the application is exiting.
+
+    int indexOf(const quint32 ticket) const;
+    void prepare(const int index, PokitDevice * const device);
+    void checkReady();
+    void startAll();
+    void finishLogger(const int index, const QString &error = QString());
+    void checkComplete();
+    qint64 skew(const int index) const;
+    void outputSummary();
+
+private slots:
+    void granted(const quint32 ticket, PokitDevice * const device);
+    void failed(const quint32 ticket);
+
+    QTPOKIT_BEFRIEND_TEST(LoggerStartFleetCommand)
+};
@@ -69,6 +69,11 @@ void LoggerStopCommand::settingsWritten()
     case OutputFormat::Json:
         std::cout << qUtf8Printable(u"true\n"_s);
         break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         std::cout << qUtf8Printable(tr("Done.\n"));
         break;
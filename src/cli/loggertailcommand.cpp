@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "loggertailcommand.h"
+#include "../stringliterals_p.h"
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class LoggerTailCommand
+ *
+ * The LoggerTailCommand class implements the `logger-tail` CLI command.
+ *
+ * This is a LoggerFetchCommand that, instead of disconnecting once the logging session's samples have been fetched,
+ * stays connected and watches the session's metadata. Then whenever the session grows (or a new session begins), the
+ * session is fetched again, and only the new samples output.
+ *
+ * With the `auto-drain` option, sessions nearing the end of the device's sampling buffer are restarted once fetched,
+ * so that logging continues indefinitely, rather than stopping once the buffer is full.
+ */
+
+/*!
+ * Construct a new LoggerTailCommand object with \a parent.
+ */
+LoggerTailCommand::LoggerTailCommand(QObject * const parent) : LoggerFetchCommand(parent)
+{
+    tail = true;
+}
+
+QStringList LoggerTailCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return LoggerFetchCommand::supportedOptions(parser) + QStringList{
+        u"auto-drain"_s,
+        u"watchdog"_s,
+    };
+}
+
+/*!
+ * \copybrief LoggerFetchCommand::processOptions
+ *
+ * This implementation extends LoggerFetchCommand::processOptions to process the `auto-drain` and `watchdog` options,
+ * since only tails stay connected long enough to fill the device's buffer, or to stall.
+ */
+QStringList LoggerTailCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = LoggerFetchCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+    if (parser.isSet(u"auto-drain"_s)) {
+        errors.append(setAutoDrain(parser.value(u"auto-drain"_s)));
+    }
+    if (parser.isSet(u"watchdog"_s)) {
+        errors.append(setWatchdogFactor(parser.value(u"watchdog"_s)));
+    }
+    return errors;
+}
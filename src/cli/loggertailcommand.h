@@ -0,0 +1,19 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "loggerfetchcommand.h"
+
+class LoggerTailCommand : public LoggerFetchCommand
+{
+    Q_OBJECT
+
+public:
+    explicit LoggerTailCommand(QObject * const parent = nullptr);
+
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+
+    QTPOKIT_BEFRIEND_TEST(LoggerTailCommand)
+};
@@ -1,26 +1,44 @@
 // SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include "aggregatorcommand.h"
+#include "benchcommand.h"
 #include "calibratecommand.h"
+#include "calibratefleetcommand.h"
+#include "compactcommand.h"
+#include "daemoncommand.h"
 #include "dsocommand.h"
+#include "exportcommand.h"
+#include "exportercommand.h"
 #include "flashledcommand.h"
 #include "infocommand.h"
 #include "loggerfetchcommand.h"
+#include "loggerharvestcommand.h"
 #include "loggerstartcommand.h"
+#include "loggerstartfleetcommand.h"
 #include "loggerstopcommand.h"
+#include "loggertailcommand.h"
 #include "metercommand.h"
+#include "meterfleetcommand.h"
+#include "phasetimer.h"
+#include "querycommand.h"
 #include "scancommand.h"
+#include "sessioncommand.h"
 #include "setnamecommand.h"
 #include "settorchcommand.h"
 #include "statuscommand.h"
 #include "../stringliterals_p.h"
 
+#include <qtpokit/asyncloghandler.h>
+#include <qtpokit/pokittrace.h>
+
 #include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QLocale>
 #include <QLoggingCategory>
 #include <QTranslator>
 
+#include <cstdlib>
 #include <iostream>
 
 #if defined(Q_OS_UNIX)
@@ -54,12 +72,21 @@ void configureLogging(const QCommandLineParser &parser)
     // Start with the Qt default message pattern (see qtbase:::qlogging.cpp:defaultPattern)
     QString messagePattern = u"%{if-category}%{category}: %{endif}%{message}"_s;
 
+    // Invalid rate limits are reported by AbstractCommand::processOptions(), so just log synchronously for those.
+    AsyncLogHandler::Settings asyncSettings;
+    bool async = false;
+    if (parser.isSet(u"async-log"_s)) {
+        asyncSettings.rateLimit = parser.value(u"async-log"_s).toUInt(&async);
+    }
+
     if (parser.isSet(u"debug"_s)) {
         #ifdef QT_MESSAGELOGCONTEXT
         // %{file}, %{line} and %{function} are only available when QT_MESSAGELOGCONTEXT is set.
         messagePattern.prepend(u"%{function} "_s);
         #endif
-        messagePattern.prepend(u"%{time process} %{threadid} %{type} "_s);
+        // The async handler captures the time and thread itself, since the pattern is applied on its own thread.
+        messagePattern.prepend((async) ? u"%{type} "_s : u"%{time process} %{threadid} %{type} "_s);
+        asyncSettings.prefixContext = true;
         QLoggingCategory::setFilterRules(u"dokit.*.debug=true\npokit.*.debug=true"_s);
     }
 
@@ -75,6 +102,11 @@ void configureLogging(const QCommandLineParser &parser)
     }
 
     qSetMessagePattern(messagePattern);
+
+    // Commands may exit without returning from main(), so write any queued messages on exit, however it happens.
+    if ((async) && (AsyncLogHandler::install(asyncSettings))) {
+        std::atexit([]() { AsyncLogHandler::uninstall(); });
+    }
 }
 
 enum class Command {
@@ -82,15 +114,28 @@ enum class Command {
     Info,
     Status,
     Meter,
+    MeterFleet,
     DSO,
     LoggerStart,
+    LoggerStartFleet,
     LoggerStop,
     LoggerFetch,
+    LoggerHarvest,
+    LoggerTail,
     Scan,
     SetName,
     SetTorch,
     FlashLed,
-    Calibrate
+    Calibrate,
+    CalibrateFleet,
+    Bench,
+    Daemon,
+    Aggregator,
+    Export,
+    Exporter,
+    Query,
+    Compact,
+    Session
 };
 
 void showCliError(const QString &errorText)
@@ -100,6 +145,57 @@ void showCliError(const QString &errorText)
     fputs(qUtf8Printable(message), stderr);
 }
 
+void outputTrace()
+{
+    if (!PokitTrace::isEnabled()) {
+        showCliError(Private::tr("Trace points are not enabled in this build"));
+        return;
+    }
+    const QVector<PokitTrace::Event> events = PokitTrace::events();
+    const qint64 first = (events.isEmpty()) ? 0 : events.constFirst().timestamp;
+    qint64 previous = first;
+    fputs("# elapsed(us) delta(us) stage label value\n", stderr);
+    for (const PokitTrace::Event &event: events) {
+        const QString line = u"%1 %2 %3 %4 %5\n"_s.arg((event.timestamp - first) / 1000, 12)
+            .arg((event.timestamp - previous) / 1000, 9).arg(PokitTrace::toString(event.stage), -9)
+            .arg(QString::fromLatin1(event.label), -32).arg(event.value);
+        fputs(qUtf8Printable(line), stderr);
+        previous = event.timestamp;
+    }
+}
+
+Command commandFromName(const QString &name)
+{
+    const QMap<QString, Command> supportedCommands {
+        { u"info"_s,           Command::Info },
+        { u"status"_s,         Command::Status },
+        { u"meter"_s,          Command::Meter },
+        { u"meter-fleet"_s,    Command::MeterFleet },
+        { u"dso"_s,            Command::DSO },
+        { u"logger-start"_s,   Command::LoggerStart },
+        { u"logger-start-fleet"_s, Command::LoggerStartFleet },
+        { u"logger-stop"_s,    Command::LoggerStop },
+        { u"logger-fetch"_s,   Command::LoggerFetch },
+        { u"logger-harvest"_s, Command::LoggerHarvest },
+        { u"logger-tail"_s,    Command::LoggerTail },
+        { u"scan"_s,           Command::Scan },
+        { u"set-name"_s,       Command::SetName },
+        { u"set-torch"_s,      Command::SetTorch },
+        { u"flash-led"_s,      Command::FlashLed },
+        { u"calibrate"_s,      Command::Calibrate },
+        { u"calibrate-fleet"_s, Command::CalibrateFleet },
+        { u"bench"_s,          Command::Bench },
+        { u"daemon"_s,         Command::Daemon },
+        { u"aggregator"_s,     Command::Aggregator },
+        { u"export"_s,         Command::Export },
+        { u"exporter"_s,       Command::Exporter },
+        { u"query"_s,          Command::Query },
+        { u"compact"_s,        Command::Compact },
+        { u"session"_s,        Command::Session },
+    };
+    return supportedCommands.value(name.toLower(), Command::None);
+}
+
 Command getCliCommand(const QStringList &posArguments)
 {
     if (posArguments.isEmpty()) {
@@ -110,21 +206,7 @@ Command getCliCommand(const QStringList &posArguments)
         ::exit(EXIT_FAILURE);
     }
 
-    const QMap<QString, Command> supportedCommands {
-        { u"info"_s,         Command::Info },
-        { u"status"_s,       Command::Status },
-        { u"meter"_s,        Command::Meter },
-        { u"dso"_s,          Command::DSO },
-        { u"logger-start"_s, Command::LoggerStart },
-        { u"logger-stop"_s,  Command::LoggerStop },
-        { u"logger-fetch"_s, Command::LoggerFetch },
-        { u"scan"_s,         Command::Scan },
-        { u"set-name"_s,     Command::SetName },
-        { u"set-torch"_s,    Command::SetTorch },
-        { u"flash-led"_s,    Command::FlashLed },
-        { u"calibrate"_s,    Command::Calibrate },
-    };
-    const Command command = supportedCommands.value(posArguments.first().toLower(), Command::None);
+    const Command command = commandFromName(posArguments.first());
     if (command == Command::None) {
         showCliError(Private::tr("Unknown command: %1").arg(posArguments.first()));
         ::exit(EXIT_FAILURE);
@@ -132,9 +214,8 @@ Command getCliCommand(const QStringList &posArguments)
     return command;
 }
 
-Command parseCommandLine(const QStringList &appArguments, QCommandLineParser &parser)
+void addOptions(QCommandLineParser &parser)
 {
-    // Setup the command line options.
     parser.addOptions({
         { u"color"_s,
           Private::tr("Colors the console output. Valid options are: yes, no and auto. The default is auto."),
@@ -143,43 +224,369 @@ Command parseCommandLine(const QStringList &appArguments, QCommandLineParser &pa
           Private::tr("Enable debug output.")},
         {{u"d"_s, u"device"_s},
           Private::tr("Set the name, hardware address or macOS UUID of Pokit device to use. If not specified, "
-          "the first discovered Pokit device will be used."),
+          "the first discovered Pokit device will be used. For the calibrate-fleet, logger-harvest, "
+          "logger-start-fleet and meter-fleet commands, this option may be repeated, or given a comma-separated list, "
+          "to use multiple devices."),
           Private::tr("device")},
     });
     parser.addHelpOption();
     parser.addOptions({
+        {{u"aggregate"_s},
+          Private::tr("Output the count, minimum, maximum and mean of meter readings over windows of the given "
+          "period, instead of individual readings. For the query command, output a downsampled series of such "
+          "aggregates, over periods aligned to the epoch, instead of one aggregate per archive and mode. Suffixes such "
+          "as 's' and 'ms' (for seconds and milliseconds) may be used."),
+          Private::tr("period")},
+        {{u"aggregate-step"_s},
+          Private::tr("Start a new (overlapping) aggregate window at every multiple of the given period, for sliding "
+          "windows. The default is fixed, non-overlapping windows."),
+          Private::tr("period")},
+        {{u"aggregator"_s},
+          Private::tr("Join the daemon command to a cluster, as a gateway of the aggregator command at the given host "
+          "and port, such as pi.local:7468."),
+          Private::tr("address")},
+        {{u"align"_s},
+          Private::tr("Timestamp meter-fleet readings on a common timeline, estimated from each device's own reading "
+          "interval, instead of by their time of arrival, which varies with Bluetooth latency.")},
+        {{u"archive"_s},
+          Private::tr("Also append fetched logger samples to the given archive file, creating it if necessary. For "
+          "the compact, export and query commands, the archive file (or directory of archive files) to read, which "
+          "may be repeated."),
+          Private::tr("file")},
+        {{u"async-log"_s},
+          Private::tr("Format, and write, log messages on a background thread, so that verbose logging (such as with "
+          "--debug) does not delay the handling of Pokit devices, allowing at most the given number of messages per "
+          "second from each logging category (or 0 for no limit). Messages the background thread cannot keep up with "
+          "are dropped, and counted, rather than waited for."),
+          Private::tr("rate")},
+        {{u"auto-drain"_s},
+          Private::tr("For the logger-tail command, restart the data logger (with the same settings) whenever a "
+          "logging session has filled the given percentage of the device's sampling buffer, once its samples have been "
+          "fetched, so that logging continues indefinitely instead of stopping once the buffer is full."),
+          Private::tr("percent")},
+        {{u"auto-range"_s},
+          Private::tr("Choose the range of each --continuous DSO capture from the previous capture's peak, stepping "
+          "up when the peak nears (or clips at) the range's limit, and down when a lower range has room for it. The "
+          "--range option gives the first capture's range.")},
+        {{u"backpressure"_s},
+          Private::tr("Set what happens when stdout, or the --output-file, cannot keep up with the output. Supported "
+          "policies are: block (wait for it to catch up, delaying the device's notifications), drop-oldest, "
+          "drop-newest (the default for --output-file) and decimate (drop every second queued batch of output). If "
+          "given, stdout is also written via a background thread, subject to the same policy."),
+          Private::tr("policy")},
+        {{u"bandwidth"_s},
+          Private::tr("Plan the DSO's samples and sampling window from the highest frequency of interest, and the "
+          "--duration to capture it for, using the device's maximum sampling rate and buffer size. Durations "
+          "longer than one buffer can hold are stitched together from successive captures, as per --long-capture."),
+          Private::tr("frequency")},
+        {{u"battery-saver"_s},
+          Private::tr("Poll the device's battery, and lengthen the meter interval as it runs low, up to the given "
+          "maximum interval. The battery begins conserving power below 3.5V, and is critical below 3.3V (or when the "
+          "device reports a low battery), unless other voltages are given, such as 300s,3.6V,3.4V."),
+          Private::tr("max[,conserve[,critical]]")},
+        {{u"burst"_s},
+          Private::tr("For the meter command, capture the given number of readings to memory, without outputting any "
+          "until the last has arrived, then output them all at once, with their timing and summary statistics. "
+          "Readings are taken at the fastest interval (10ms), unless --interval is also given."),
+          Private::tr("count")},
+        {{u"charge"_s},
+          Private::tr("Count the charge (in mAh) of DC current meter readings, or logger samples, instead of "
+          "outputting them, and output the running totals once per the given period. Suffixes such as 's' and 'ms' "
+          "(for seconds and milliseconds) may be used."),
+          Private::tr("period")},
+        {{u"charge-gap"_s},
+          Private::tr("Set how --charge integrates gaps between readings (or samples): exclude (the default), hold "
+          "the value before the gap, or interpolate across it, optionally followed by ':' and the longest interval "
+          "that is not a gap. The default is three reading (or sampling) intervals."),
+          Private::tr("policy")},
+        {{u"compress"_s},
+          Private::tr("Compress DSO and logger samples, as zigzag varint deltas, in Binary output and logger "
+          "archives (including those written by the compact command).")},
+        {{u"connection-profile"_s},
+          Private::tr("Request a Bluetooth connection parameter profile while the command runs. Supported profiles "
+          "are: low-latency (for faster DSO transfers and meter rates), low-power (for slow data logging), and "
+          "default. Not all platforms support connection parameter requests."),
+          Private::tr("profile")},
+        {{u"continuous"_s},
+          Private::tr("Keep acquiring DSO captures back-to-back, with the same settings, until interrupted.")},
+        {{u"deadband"_s},
+          Private::tr("Only output meter readings that differ from the last output reading by more than the given "
+          "tolerance, either absolute (in the reading's units, such as 0.01) or relative (such as 1%). Both may be "
+          "given, separated by a comma, in which case the larger applies. Status, mode and range changes are always "
+          "output."),
+          Private::tr("tolerance")},
+        {{u"device-list"_s},
+          Private::tr("For the calibrate-fleet, exporter, logger-start-fleet and meter-fleet commands, read the "
+          "devices to use from the given file, one per line (or comma-separated), in addition to any given via "
+          "--device. Anything after a '#' is ignored."),
+          Private::tr("file")},
+        {{u"device-thread"_s},
+          Private::tr("Pin the thread that handles the Pokit device's notifications to the given CPUs, and/or request "
+          "high or real-time priority for it, as [<cpus>][:<priority>[:<level>]], such as 2-3:realtime:10, or high. "
+          "Priorities the OS refuses (such as without the privileges for real-time scheduling) are logged."),
+          Private::tr("policy")},
+        {{u"discovery-cache"_s},
+          Private::tr("Cache each device's service layout and capabilities between invocations, so later "
+          "connections to the same device can skip reading characteristic values during service discovery. The "
+          "cache is invalidated automatically if the device's services or firmware version change.")},
+        {{u"duration"_s},
+          Private::tr("Set how long the DSO is to capture for, with --bandwidth. Suffixes such as 's' and 'ms' (for "
+          "seconds and milliseconds) may be used."),
+          Private::tr("period")},
+        {{u"dwell"_s},
+          Private::tr("When the exporter or meter command is given multiple modes, set how long to measure each mode "
+          "before switching to the next, including the time taken to switch. The default is 10s."),
+          Private::tr("period")},
+        {{u"event"_s},
+          Private::tr("Output only events, rather than every meter reading, or logger sample. The spec is "
+          "<type>:<threshold>[:<hysteresis>[:<min-duration>]], where type is above, below, rate-above or rate-below "
+          "(for rates of change per second). Each event is output once it ends, with its start, end, duration and "
+          "peak. May be given more than once, to detect multiple conditions."),
+          Private::tr("spec")},
+        {{u"filter"_s},
+          Private::tr("Filter DSO and logger sample values before output. Supported filters are: lowpass:<Hz>[:q], "
+          "highpass:<Hz>[:q], notch:<Hz>[:q], biquad:<b0>,<b1>,<b2>,<a1>,<a2> and fir:<h0>[,<h1>...]. May be given "
+          "more than once, in which case the biquad sections are cascaded in the order given, after any FIR filter. "
+          "Binary, shared memory, MQTT and archived samples are always raw."),
+          Private::tr("spec")},
+        {{u"flush"_s},
+          Private::tr("Set when buffered output is written to stdout. Supported policies are: batch (after each "
+          "batch of samples), exit (only once the command completes), or a buffer size in bytes, such as 64K. "
+          "The default is batch."),
+          Private::tr("policy"), u"batch"_s},
+        {{u"from"_s},
+          Private::tr("Set the start of the query command's time range, as an ISO 8601 date and time (in local time, "
+          "unless given an offset, such as Z), or as milliseconds since the Unix epoch. The default is the start of "
+          "each archive."),
+          Private::tr("time")},
+        {{u"gateway-name"_s},
+          Private::tr("Set the name the daemon command registers with its --aggregator as. The default is the host "
+          "name."),
+          Private::tr("name")},
+        {{u"heartbeat"_s},
+          Private::tr("With --deadband, output a meter reading, even if unchanged, whenever at least the given "
+          "period has passed since the last output reading."),
+          Private::tr("period")},
+        {{u"incremental"_s},
+          Private::tr("Only output logger samples not already output by a previous incremental logger-fetch of the "
+          "same device and logging session.")},
+        {{u"influx"_s},
+          Private::tr("Also write dso samples, logger samples, or meter readings, in batches of line protocol points "
+          "to the InfluxDB server at the given URL, such as "
+          "http://host:8086/?org=lab&bucket=pokit&interval=1s&size=1M. The API token is read from the INFLUX_TOKEN "
+          "environment variable, if not given via the token query item. "
+          "Batches are buffered in memory (and retried) while the server is unreachable."),
+          Private::tr("url")},
         {{u"interval"_s},
           Private::tr("Set the update interval for DOS, meter and "
-          "logger modes. Suffixes such as 's' and 'ms' (for seconds and milliseconds) may be used. "
+          "logger modes, the change reporting interval for scan --watch, and the notification coalescing interval "
+          "for status --watch. "
+          "Suffixes such as 's' and 'ms' (for seconds and milliseconds) may be used. "
           "If no suffix is present, the units will be inferred from the magnitide of the given "
           "interval. If the option itself is not specified, a sensible default will be chosen "
           "according to the selected command."),
           Private::tr("interval")},
+        {{u"jitter"_s},
+          Private::tr("Delay each run of the daemon command's scheduled jobs by a random period of up to the given "
+          "length, so that jobs scheduled together do not all contend for the Bluetooth adapter at once. The default "
+          "is a tenth of each job's interval."),
+          Private::tr("period")},
+        {{u"known-devices"_s},
+          Private::tr("Remember each device connected to (by name, address and product), and connect to known "
+          "devices given via --device directly, without scanning first. If the direct connection fails, the device "
+          "is scanned for as usual.")},
+        {{u"listen"_s},
+          Private::tr("Set the address and port, such as 0.0.0.0:9464, or just a port, that the exporter command "
+          "serves metrics on (the default is localhost:9464), that the daemon command serves WebSocket clients on "
+          "(the default is none), or that the aggregator command accepts gateways on."),
+          Private::tr("address"), u"localhost:9464"_s},
+        {{u"latency-report"_s},
+          Private::tr("Output a report of the latencies (count, minimum, percentiles, maximum and jitter) from "
+          "receiving each value, to parsing, emitting, formatting and writing its output, to stderr on exit.")},
+        {{u"link-statistics"_s},
+          Private::tr("Output link statistics (connections, notifications and bytes received, parse failures, errors, "
+          "notification interval histograms, pipeline stage throughput and queue depths, effective thread settings, "
+          "and memory usage) to stderr on exit, and on Unix-like systems, whenever SIGUSR1 is received.")},
+        {{u"long-capture"_s},
+          Private::tr("Acquire more DSO samples than the device can buffer, by splitting --samples into successive "
+          "captures (each with the same sampling rate) over the whole --interval, and stitching them together, with "
+          "markers for the gaps between them.")},
+        {{u"low-battery"_s},
+          Private::tr("With status --watch, alert when the battery voltage falls below the given level, such as 3.5V, "
+          "in addition to when the device itself reports its battery as low."),
+          Private::tr("voltage")},
+        {{u"mark-clipping"_s},
+          Private::tr("With dso, logger-fetch and logger-tail JSON, NDJSON and text output, also output a marker for "
+          "each run of clipped samples (those at the limit of their range), giving its first sample, and length.")},
+        {{u"max-connections"_s},
+          Private::tr("Set the maximum number of devices the calibrate-fleet, daemon, exporter, logger-harvest and "
+          "meter-fleet commands will connect to concurrently. The default is 3. The logger-start-fleet command "
+          "connects to all of its devices at once, so defaults to (and requires at least) the number of devices."),
+          Private::tr("count"), u"3"_s},
+        {{u"max-jobs"_s},
+          Private::tr("Set the maximum number of the daemon command's scheduled jobs to run concurrently. The default "
+          "is the --max-connections value."),
+          Private::tr("count")},
+        {{u"memory-budget"_s},
+          Private::tr("Bound the memory held by all of the command's buffers (such as output queues, MQTT and "
+          "InfluxDB spill buffers, sample pools, and DSO capture buffers) to the given size, such as 256M, optionally "
+          "followed by a comma and the quota for each buffer, such as 256M,32M. Buffers that reach the limit, or "
+          "their quota, apply their backpressure policy (such as --backpressure) instead of growing."),
+          Private::tr("size[,quota]")},
+        {{u"merge"_s},
+          Private::tr("For the compact command, merge all of the archives into the given archive file, instead of "
+          "compacting each archive in place."),
+          Private::tr("file")},
         {{u"mode"_s},
           Private::tr("Set the desired operation mode. For "
           "meter, dso, and logger commands, the supported modes are: AC Voltage, DC Voltage, AC Current, "
           "DC Current, Resistance, Diode, Continuity, and Temperature. All are case insensitive. "
           "Only the first four options are available for dso and logger commands; the rest are "
           "available in meter mode only. Temperature is also available for logger commands, but "
-          "requires firmware v1.5 or later for Pokit devices to support it. For the set-torch command "
+          "requires firmware v1.5 or later for Pokit devices to support it. The exporter and meter commands also "
+          "accept a comma-separated list of modes, to measure round-robin (see --dwell). For the set-torch command "
           "supported modes are On and Off."),
           Private::tr("mode")},
+        {{u"mqtt"_s},
+          Private::tr("Also publish dso samples, or meter readings, in batches to the MQTT broker at the given URL, "
+          "such as mqtt://broker:1883/plant/line1?qos=1&format=json&interval=1s&size=16K&buffer=8M. Batches are "
+          "buffered in memory while the broker is unreachable."),
+          Private::tr("url")},
         {{u"new-name"_s},
           Private::tr("Give the desired new name for the set-name command."), Private::tr("name")},
         {{u"output"_s},
           Private::tr("Set the format for output. Supported "
-          "formats are: CSV, JSON and Text. All are case insensitive. The default is Text."),
+          "formats are: CSV, JSON and Text, plus Arrow, Binary, Line-Protocol (for InfluxDB) and NDJSON for the dso, "
+          "logger-fetch, logger-tail and meter commands, and NDJSON-Envelope for the dso, logger-fetch and logger-tail "
+          "commands. All are case insensitive. The default is Text."),
           Private::tr("format"),
           Private::tr("text")},
+        {{u"output-dir"_s},
+          Private::tr("Write the export command's Parquet files to the given directory, instead of beside each "
+          "archive."),
+          Private::tr("dir")},
+        {{u"output-file"_s},
+          Private::tr("Write output to the given file, via a background writer thread, instead of stdout. If the "
+          "disk cannot keep up, output is dropped (and logged), rather than delaying the Pokit device's "
+          "notifications."),
+          Private::tr("file")},
+        {{u"pipeline"_s},
+          Private::tr("Also route dso samples, or meter readings, through a pipeline of stages, to one or more sinks. "
+          "The pipeline is a list of stages, separated by semicolons, each of the form <name> = <type>[:<args>] "
+          "[<- <input>[,<input>...]], where inputs are earlier stages, or source (the default). Supported types "
+          "are: filter:<spec> (as per --filter), aggregate:<period> (the mean of each window), detect:<spec> (only "
+          "values within events, as per --event), resample:<period>[:linear|hold|decimate], expression:<formula> "
+          "(arithmetic, comparisons and functions such as abs, min, max and if, of each input by name), and "
+          "sink:<csv|ndjson>:<file>. Stages share each batch of values, rather than copying it. Prefix a file name "
+          "with @ to read the pipeline from that file instead."),
+          Private::tr("config")},
+        {{u"post-trigger"_s},
+          Private::tr("With --soft-trigger, output the given number of samples from each trigger sample onwards. "
+          "The default is 900."),
+          Private::tr("samples")},
+        {{u"power"_s},
+          Private::tr("For the meter-fleet command, measure DC voltage with the first device, and DC current with the "
+          "second, and output the power, energy and charge derived from their (aligned) readings, instead of the "
+          "individual readings.")},
+        {{u"pre-trigger"_s},
+          Private::tr("With --soft-trigger, also output up to the given number of samples from before each trigger "
+          "sample. The default is 100."),
+          Private::tr("samples")},
+        {{u"prewarm"_s},
+          Private::tr("Connect to the device of each of the daemon command's scheduled jobs the given period before "
+          "each run (if a connection is free), so that runs start on time, without waiting to connect. The period "
+          "must be less than 30s. The default is not to pre-warm connections."),
+          Private::tr("period")},
         {{u"range"_s},
           Private::tr("Set the desired measurement range. Pokit "
           "devices support specific ranges, such as 0 to 300mV. Specify the desired upper limit, "
           "and the best range will be selected, or use 'auto' to enable the Pokit device's auto-"
           "range feature. The default is 'auto'."),
           Private::tr("range"), u"auto"_s},
-        {{u"samples"_s}, Private::tr("Set the number of samples to acquire."), Private::tr("count")},
+        {{u"raw"_s},
+          Private::tr("With dso, logger-fetch and logger-tail CSV, NDJSON, NDJSON-Envelope and text output, output "
+          "each sample as its raw (integer) device count, instead of its scaled value, with the scale (per count), "
+          "mode and range declared just once, whenever they change (or per envelope).")},
+        {{u"record"_s},
+          Private::tr("Record the raw characteristic traffic (every value read, written and notified, with host "
+          "timestamps) to the given file, for later replay away from the device."),
+          Private::tr("file")},
+        {{u"reconnect"_s},
+          Private::tr("Automatically reconnect, up to the given number of attempts, with exponential backoff, if "
+          "the Pokit device disconnects unexpectedly. Notifications and settings are then resumed, where possible."),
+          Private::tr("attempts")},
+        {{u"reference-clock"_s},
+          Private::tr("For the daemon command, discipline event timestamps against a reference clock, being ntp "
+          "(the kernel's NTP discipline), or ptp, optionally followed by a PTP hardware clock device (such as "
+          "ptp:/dev/ptp1), and add each timestamp's error bound, in microseconds."),
+          Private::tr("source")},
+        {{u"resample"_s},
+          Private::tr("For the meter-fleet command, resample every device's readings onto a common grid of times, at "
+          "the given period, such as 1s, and output one row per grid time, with one column per device, instead of "
+          "the individual readings."),
+          Private::tr("period")},
+        {{u"resample-method"_s},
+          Private::tr("Set how --resample resamples each device's readings: linear (the default) interpolation, hold "
+          "the latest reading, or decimate (average) the readings within half a period of each grid time."),
+          Private::tr("method")},
+        {{u"rotate-interval"_s},
+          Private::tr("With --output-file, rename the file, and start a new one, once it has been written to for "
+          "the given period, such as 86400s, or 3600 (seconds)."),
+          Private::tr("period")},
+        {{u"rotate-size"_s},
+          Private::tr("With --output-file, rename the file, and start a new one, before it would exceed the given "
+          "size in bytes, such as 100M."),
+          Private::tr("size")},
+        {{u"samples"_s}, Private::tr("Set the number of samples to acquire, or for the bench command, the number "
+          "of meter readings to time at each interval."), Private::tr("count")},
+        {{u"script"_s},
+          Private::tr("For the session command, read the commands to run from the given file, one per line, instead "
+          "of from stdin. Anything after a '#' is ignored, and the session ends at the first failed command."),
+          Private::tr("file")},
+        {{u"settle"_s},
+          Private::tr("Discard meter readings taken within the given period after each range change (such as by "
+          "auto-ranging), while the value settles. Discarded readings do not count towards --samples."),
+          Private::tr("period")},
+        {{u"shared-memory"_s},
+          Private::tr("Also publish dso samples, or meter readings, to a shared memory ring buffer with the given key, "
+          "for other local processes to read."),
+          Private::tr("key")},
+        {{u"sink-threads"_s},
+          Private::tr("Pin the threads writing --output-file, and pipeline sink, output to the given CPUs, and/or "
+          "request high or real-time priority for them, as per --device-thread, such as 0-1."),
+          Private::tr("policy")},
+        {{u"socket"_s},
+          Private::tr("Set the name of the local socket the daemon command listens on. The default is dokitd (or "
+          "dokit-aggregator, for the aggregator command)."),
+          Private::tr("name"), u"dokitd"_s},
+        {{u"soft-trigger"_s},
+          Private::tr("Trigger on the host, rather than the device, outputting only the segments of (continuous) DSO "
+          "samples around each trigger. The spec is one of level:<slope>:<level>, edge:<slope>:<level>[:<hysteresis>], "
+          "window:<slope>:<lower>:<upper>[:<hysteresis>] or pulse:<slope>:<level>:<min-width>[:<max-width>], where "
+          "slope is rising, falling or either, and pulse widths are in samples."),
+          Private::tr("spec")},
+        {{u"sqlite"_s},
+          Private::tr("Also store meter readings, or logger samples, in the SQLite database at the given file name "
+          "(creating it, if necessary), alongside their device, mode, range and interval."),
+          Private::tr("file")},
+        {{u"spectrum"_s},
+          Private::tr("Output the frequency spectrum (via a Hann-windowed FFT) of each DSO capture, instead of "
+          "individual samples.")},
+        {{u"stats"_s},
+          Private::tr("Output summary statistics (minimum, maximum, mean, RMS, frequency, etc) for each DSO capture, "
+          "instead of individual samples.")},
+        {{u"summary"_s},
+          Private::tr("Output the distribution (count, minimum, mean, 50th, 95th and 99th percentiles, and maximum) of "
+          "logger samples in each period, such as 3600s, instead of every sample. Periods are aligned to the epoch, "
+          "so hourly periods begin on the hour."), Private::tr("period")},
         {{u"temperature"_s},
-          Private::tr("Set the current ambient temperature for the calibration command."), Private::tr("degrees")},
+          Private::tr("Set the current ambient temperature for the calibrate and calibrate-fleet commands."),
+          Private::tr("degrees")},
+        {{u"time-format"_s},
+          Private::tr("Set the format of logger-fetch, logger-harvest, logger-tail, meter-fleet and query timestamps. "
+          "Supported formats are: ISO (8601 dates and times, in UTC) and Epoch (milliseconds since the Unix epoch). "
+          "Both are case insensitive. The default is ISO."),
+          Private::tr("format"), u"iso"_s},
         {{u"timeout"_s},
           Private::tr("Set the device discovery scan timeout. "
           "Suffixes such as 's' and 'ms' (for seconds and milliseconds) may be used. "
@@ -189,26 +596,88 @@ Command parseCommandLine(const QStringList &appArguments, QCommandLineParser &pa
         {{u"timestamp"_s},
           Private::tr("Set the optional starting timestamp for data logging. Default to 'now'."),
           Private::tr("period")},
+        {{u"timings"_s},
+          Private::tr("Output the time taken to reach each phase of startup (application, translations, options, "
+          "command, device-found, connected, discovered, settings-written and first-output) to stderr on exit.")},
+        {{u"to"_s},
+          Private::tr("Set the (inclusive) end of the query command's time range, in the same formats as --from. The "
+          "default is the end of each archive."),
+          Private::tr("time")},
+        {{u"trace"_s},
+          Private::tr("Output the library's BLE trace points (connection, discovery, writes, notifications, parsing "
+          "and emitting) to stderr on exit. Requires a build with the ENABLE_TRACE CMake option.")},
         {{u"trigger-level"_s}, Private::tr("Set the DSO trigger level."), Private::tr("level")},
         {{u"trigger-mode"_s},
           Private::tr("Set the DSO trigger mode. Supported modes are: free, rising and falling. The default is free."),
           Private::tr("mode"), u"free"_s},
+        {{u"wav"_s},
+          Private::tr("Also write raw dso samples to a mono, 16-bit PCM, WAV file with the given name, at the "
+          "capture's sampling rate, with the samples' scale, unit and range in the file's comment. Continuous captures "
+          "are appended to the same file, unless their sampling rate, or range, changes, in which case a new "
+          "(numbered) file is started."),
+          Private::tr("file")},
+        {{u"watch"_s},
+          Private::tr("Scan continuously, and output only changes to nearby devices (appeared, disappeared, renamed, "
+          "and significant signal strength changes) once per --interval, as NDJSON by default. For the status command, "
+          "stay connected, and output only status changes, and battery and charging alerts, as NDJSON by default.")},
+        {{u"watchdog"_s},
+          Private::tr("For the meter and logger-tail commands, treat the device's notifications as stalled once none "
+          "have arrived for the given multiple (such as 5) of their expected interval (and at least 2s), and recover "
+          "by re-enabling notifications, then re-writing settings, then reconnecting (if --reconnect is set)."),
+          Private::tr("factor")},
+        {{u"workers"_s},
+          Private::tr("Format the meter-fleet command's readings on the given number of worker threads (or auto, for "
+          "one per core), sharded by device, instead of on the main thread. Each device's readings remain in order. "
+          "For the compact, export and query commands, process up to the given number of archives at once (one per "
+          "core by default)."),
+          Private::tr("count")},
     });
     parser.addVersionOption();
+}
+
+Command parseCommandLine(const QStringList &appArguments, QCommandLineParser &parser)
+{
+    // Setup the command line options.
+    addOptions(parser);
 
     // Add supported 'commands' (as positional arguments, so they'll appear in the help text).
     parser.addPositionalArgument(u"info"_s,         Private::tr("Get Pokit device information"), u" "_s);
     parser.addPositionalArgument(u"status"_s,       Private::tr("Get Pokit device status"), u" "_s);
     parser.addPositionalArgument(u"meter"_s,        Private::tr("Access Pokit device's multimeter mode"), u" "_s);
+    parser.addPositionalArgument(u"meter-fleet"_s,
+        Private::tr("Read, and merge, multimeter readings from multiple Pokit devices"), u" "_s);
     parser.addPositionalArgument(u"dso"_s,          Private::tr("Access Pokit device's DSO mode"), u" "_s);
     parser.addPositionalArgument(u"logger-start"_s, Private::tr("Start Pokit device's data logger mode"), u" "_s);
+    parser.addPositionalArgument(u"logger-start-fleet"_s,
+        Private::tr("Start multiple Pokit devices' data loggers together, with one shared timestamp"), u" "_s);
     parser.addPositionalArgument(u"logger-stop"_s,  Private::tr("Stop Pokit device's data logger mode"), u" "_s);
     parser.addPositionalArgument(u"logger-fetch"_s, Private::tr("Fetch Pokit device's data logger samples"), u" "_s);
+    parser.addPositionalArgument(u"logger-harvest"_s,
+        Private::tr("Fetch, and merge, data logger samples from multiple Pokit devices"), u" "_s);
+    parser.addPositionalArgument(u"logger-tail"_s,  Private::tr("Follow Pokit device's data logger samples"), u" "_s);
     parser.addPositionalArgument(u"scan"_s,         Private::tr("Scan Bluetooth for Pokit devices"), u" "_s);
     parser.addPositionalArgument(u"set-name"_s,     Private::tr("Set Pokit device's name"), u" "_s);
     parser.addPositionalArgument(u"set-torch"_s,    Private::tr("Set Pokit device's torch on or off"), u" "_s);
     parser.addPositionalArgument(u"flash-led"_s,    Private::tr("Flash Pokit device's LED (Pokit Meter only)"), u" "_s);
     parser.addPositionalArgument(u"calibrate"_s,    Private::tr("Calibrate Pokit device temperature"), u" "_s);
+    parser.addPositionalArgument(u"calibrate-fleet"_s,
+        Private::tr("Calibrate the temperature of multiple Pokit devices concurrently"), u" "_s);
+    parser.addPositionalArgument(u"bench"_s,
+        Private::tr("Benchmark a Pokit device, and its host, with a standard measurement battery"), u" "_s);
+    parser.addPositionalArgument(u"daemon"_s,
+        Private::tr("Serve Pokit devices to local clients, keeping connections warm"), u" "_s);
+    parser.addPositionalArgument(u"aggregator"_s,
+        Private::tr("Aggregate daemon gateways into a cluster, serving all of their Pokit devices"), u" "_s);
+    parser.addPositionalArgument(u"export"_s,
+        Private::tr("Convert logger archives to Parquet files, for offline analysis"), u" "_s);
+    parser.addPositionalArgument(u"exporter"_s,
+        Private::tr("Serve Pokit devices' readings, status and statistics as Prometheus metrics"), u" "_s);
+    parser.addPositionalArgument(u"query"_s,
+        Private::tr("Aggregate, or downsample, logger archives' samples over a time range"), u" "_s);
+    parser.addPositionalArgument(u"compact"_s,
+        Private::tr("Compact logger archives, and build their rollups for faster queries"), u" "_s);
+    parser.addPositionalArgument(u"session"_s,
+        Private::tr("Run a sequence of commands, from stdin or a script, over one Pokit device connection"), u" "_s);
 
     // Do the initial parse, the see if we have a command specified yet.
     parser.parse(appArguments);
@@ -239,24 +708,75 @@ Command parseCommandLine(const QStringList &appArguments, QCommandLineParser &pa
     return command;
 }
 
+DeviceCommand * getSessionCommandObject(const QString &name, QObject * const parent)
+{
+    switch (commandFromName(name)) {
+    case Command::Calibrate:     return new CalibrateCommand(parent);
+    case Command::DSO:           return new DsoCommand(parent);
+    case Command::FlashLed:      return new FlashLedCommand(parent);
+    case Command::Info:          return new InfoCommand(parent);
+    case Command::LoggerStart:   return new LoggerStartCommand(parent);
+    case Command::LoggerStop:    return new LoggerStopCommand(parent);
+    case Command::LoggerFetch:   return new LoggerFetchCommand(parent);
+    case Command::LoggerTail:    return new LoggerTailCommand(parent);
+    case Command::Meter:         return new MeterCommand(parent);
+    case Command::Status:        return new StatusCommand(parent);
+    case Command::SetName:       return new SetNameCommand(parent);
+    case Command::SetTorch:      return new SetTorchCommand(parent);
+    case Command::None:
+    case Command::Aggregator:
+    case Command::Bench:         // Needs a fresh connection, to time connecting and discovery.
+    case Command::CalibrateFleet:
+    case Command::Compact:
+    case Command::Daemon:
+    case Command::Export:
+    case Command::Exporter:
+    case Command::LoggerHarvest:
+    case Command::LoggerStartFleet:
+    case Command::MeterFleet:
+    case Command::Query:
+    case Command::Scan:
+    case Command::Session:
+        break; // Not single-device commands, so cannot share a session's device.
+    }
+    return nullptr;
+}
+
 AbstractCommand * getCommandObject(const Command command, QObject * const parent)
 {
     switch (command) {
     case Command::None:
         showCliError(Private::tr("Missing argument: <command>\nSee --help for usage information."));
         return nullptr;
-    case Command::Calibrate:   return new CalibrateCommand(parent);
-    case Command::DSO:         return new DsoCommand(parent);
-    case Command::FlashLed:    return new FlashLedCommand(parent);
-    case Command::Info:        return new InfoCommand(parent);
-    case Command::LoggerStart: return new LoggerStartCommand(parent);
-    case Command::LoggerStop:  return new LoggerStopCommand(parent);
-    case Command::LoggerFetch: return new LoggerFetchCommand(parent);
-    case Command::Meter:       return new MeterCommand(parent);
-    case Command::Scan:        return new ScanCommand(parent);
-    case Command::Status:      return new StatusCommand(parent);
-    case Command::SetName:     return new SetNameCommand(parent);
-    case Command::SetTorch:    return new SetTorchCommand(parent);
+    case Command::Aggregator:    return new AggregatorCommand(parent);
+    case Command::Bench:         return new BenchCommand(parent);
+    case Command::Calibrate:     return new CalibrateCommand(parent);
+    case Command::CalibrateFleet: return new CalibrateFleetCommand(parent);
+    case Command::Compact:       return new CompactCommand(parent);
+    case Command::Daemon:        return new DaemonCommand(parent);
+    case Command::DSO:           return new DsoCommand(parent);
+    case Command::Export:        return new ExportCommand(parent);
+    case Command::Exporter:      return new ExporterCommand(parent);
+    case Command::FlashLed:      return new FlashLedCommand(parent);
+    case Command::Info:          return new InfoCommand(parent);
+    case Command::LoggerStart:   return new LoggerStartCommand(parent);
+    case Command::LoggerStartFleet: return new LoggerStartFleetCommand(parent);
+    case Command::LoggerStop:    return new LoggerStopCommand(parent);
+    case Command::LoggerFetch:   return new LoggerFetchCommand(parent);
+    case Command::LoggerHarvest: return new LoggerHarvestCommand(parent);
+    case Command::LoggerTail:    return new LoggerTailCommand(parent);
+    case Command::Meter:         return new MeterCommand(parent);
+    case Command::MeterFleet:    return new MeterFleetCommand(parent);
+    case Command::Query:         return new QueryCommand(parent);
+    case Command::Scan:          return new ScanCommand(parent);
+    case Command::Session: {
+        SessionCommand * const session = new SessionCommand(parent);
+        session->setCommandFactory(addOptions, getSessionCommandObject);
+        return session;
+    }
+    case Command::Status:        return new StatusCommand(parent);
+    case Command::SetName:       return new SetNameCommand(parent);
+    case Command::SetTorch:      return new SetTorchCommand(parent);
     }
     showCliError(Private::tr("Unknown command (%1)").arg((int)command));
     return nullptr;
@@ -264,6 +784,9 @@ AbstractCommand * getCommandObject(const Command command, QObject * const parent
 
 int main(int argc, char *argv[])
 {
+    PhaseTimer::start(); // As early as possible, so the timings include the application's own setup.
+    QTPOKIT_TRACE_THREAD_NAME("main");
+
     // Setup the core application.
     QCoreApplication app(argc, argv);
     QCoreApplication::setApplicationName(QStringLiteral(PROJECT_NAME));
@@ -275,6 +798,9 @@ int main(int argc, char *argv[])
         "+" PROJECT_BUILD_ID
         #endif
     ));
+    QCoreApplication::setOrganizationName(QStringLiteral(PROJECT_ORGANIZATION_NAME));     // Only used for QSettings.
+    QCoreApplication::setOrganizationDomain(QStringLiteral(PROJECT_ORGANIZATION_DOMAIN)); // Only used for QSettings.
+    PhaseTimer::mark(PhaseTimer::Phase::Application);
 
 #if defined(Q_OS_MACOS)
     // Qt ignores shell locale overrides on macOS (QTBUG-51386), so mimic Qt's handling of LANG on *nixes.
@@ -289,20 +815,25 @@ int main(int argc, char *argv[])
     }
 #endif
 
-    // Install localised translators, if we have translations for the current locale.
+    // Install localised translators, if we have translations for the current locale. The C locale (such as the POSIX
+    // default, or LANG=C in scripts) never has translations, so skip searching for them in that case.
     const QLocale locale;
     QTranslator appTranslator, libTranslator;
-    if (appTranslator.load(locale, u"cli"_s, u"/"_s, u":/i18n"_s)) {
-        QCoreApplication::installTranslator(&appTranslator);
-    }
-    if (libTranslator.load(locale, u"lib"_s, u"/"_s, u":/i18n"_s)) {
-        QCoreApplication::installTranslator(&libTranslator);
+    if (locale.language() != QLocale::C) {
+        if (appTranslator.load(locale, u"cli"_s, u"/"_s, u":/i18n"_s)) {
+            QCoreApplication::installTranslator(&appTranslator);
+        }
+        if (libTranslator.load(locale, u"lib"_s, u"/"_s, u":/i18n"_s)) {
+            QCoreApplication::installTranslator(&libTranslator);
+        }
     }
+    PhaseTimer::mark(PhaseTimer::Phase::Translations);
 
     // Parse the command line.
     const QStringList appArguments = QCoreApplication::arguments();
     QCommandLineParser parser;
     const Command commandType = parseCommandLine(appArguments, parser);
+    PhaseTimer::mark(PhaseTimer::Phase::Options);
     qCDebug(lc).noquote() << "Locale:" << locale << locale.uiLanguages();
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)) // QTranslator::filePath() added in Qt 5.15.
     qCDebug(lc).noquote() << "App translations:" <<
@@ -323,7 +854,14 @@ int main(int argc, char *argv[])
     for (const QString &error: cliErrors) {
         showCliError(error);
     }
+    PhaseTimer::mark(PhaseTimer::Phase::Command);
     const int result = ((cliErrors.isEmpty()) && (command->start())) ? QCoreApplication::exec() : EXIT_FAILURE;
+    if (parser.isSet(u"timings"_s)) {
+        fputs(qUtf8Printable(PhaseTimer::report()), stderr);
+    }
+    if (parser.isSet(u"trace"_s)) {
+        outputTrace();
+    }
     delete command; // We don't strictly need to do this, but it does fix QTBUG-119063, and is probably good practice.
     return result;
 }
@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "measurementformatter.h"
+#include "abstractcommand.h"
+
+#include <QtMath>
+
+/*!
+ * \class MeasurementFormatter
+ *
+ * The MeasurementFormatter class caches the context of measurements (their mode, unit, range and status labels, and
+ * each output format's constant fields), and formats measurements' values within them.
+ *
+ * Resolving a context typically involves switching on the mode, looking up range labels via the service, translating
+ * templates, and escaping the results for each output format. That is far too much work to repeat for every sample
+ * (or even every batch of samples), but the context only changes when the device's mode, range (or for the meter,
+ * status) changes. So commands resolve each distinct context once, via their Resolver function, leaving only the
+ * values themselves to be formatted per sample.
+ *
+ * For example, a DSO sample's CSV row is formatted as:
+ *
+ * ```
+ * csv.prefix + sampleNumber + csv.infix + value + csv.suffix
+ * ```
+ *
+ * where `csv.prefix` is empty, `csv.infix` is `,`, and `csv.suffix` is `,Vdc,30V\n` (say).
+ *
+ * The `Count` variants format raw (unscaled) device counts, instead of scaled values, for the `raw` option. They use
+ * the same affixes, so commands resolve raw contexts (typically without the per-sample unit and range, since those
+ * are declared just once) when raw output was requested.
+ */
+
+/*!
+ * Constructs a new formatter, with \a resolver to resolve each distinct context.
+ */
+MeasurementFormatter::MeasurementFormatter(const Resolver &resolver) : resolver(resolver)
+{
+
+}
+
+/*!
+ * Returns the context of measurements with \a mode, \a range and \a status, resolving it first if not already cached.
+ *
+ * Since consecutive measurements (such as all of a DSO capture's samples) usually share the same context, the most
+ * recently returned context is checked first, before any hash lookup.
+ *
+ * The returned reference remains valid only until the next call to context() or clear().
+ */
+const MeasurementFormatter::Context &MeasurementFormatter::context(const quint8 mode, const quint8 range,
+                                                                   const quint8 status)
+{
+    const quint32 key = (quint32)mode | ((quint32)range << 8) | ((quint32)status << 16);
+    if ((last != nullptr) && (key == lastKey)) {
+        return *last;
+    }
+    auto iter = contexts.find(key);
+    if (iter == contexts.end()) {
+        iter = contexts.insert(key, resolver(mode, range, status));
+    }
+    lastKey = key;
+    last = &*iter;
+    return *last;
+}
+
+/*!
+ * Discards all cached contexts, such as when the labels they were resolved with may have changed.
+ */
+void MeasurementFormatter::clear()
+{
+    contexts.clear();
+    last = nullptr;
+}
+
+/*!
+ * Returns the number of contexts resolved (and cached) so far.
+ */
+int MeasurementFormatter::size() const
+{
+    return (int)contexts.size();
+}
+
+/*!
+ * Appends a CSV row to \a buffer, for a measurement of \a value, with \a lead (such as its sample number or
+ * timestamp), within \a context.
+ */
+void MeasurementFormatter::appendCsv(QByteArray &buffer, const Context &context, const QByteArray &lead,
+                                     const float value)
+{
+    buffer.append(context.csv.prefix).append(lead).append(context.csv.infix);
+    AbstractCommand::appendNumber(buffer, value, context.notation, 6);
+    buffer.append(context.csv.suffix);
+}
+
+/*!
+ * \overload
+ *
+ * This overload saves formatting integer \a lead (such as a DSO sample number) into a temporary QByteArray first.
+ */
+void MeasurementFormatter::appendCsv(QByteArray &buffer, const Context &context, const qint64 lead,
+                                     const float value)
+{
+    buffer.append(context.csv.prefix);
+    AbstractCommand::appendNumber(buffer, lead);
+    buffer.append(context.csv.infix);
+    AbstractCommand::appendNumber(buffer, value, context.notation, 6);
+    buffer.append(context.csv.suffix);
+}
+
+/*!
+ * Appends an NDJSON line to \a buffer, for a measurement of \a value, with \a lead (such as its timestamp), within
+ * \a context.
+ */
+void MeasurementFormatter::appendNdjson(QByteArray &buffer, const Context &context, const QByteArray &lead,
+                                        const float value)
+{
+    buffer.append(context.ndjson.prefix).append(lead).append(context.ndjson.infix);
+    if ((qIsInf(value)) && (!context.jsonInfinity.isNull())) {
+        buffer.append(context.jsonInfinity);
+    } else {
+        AbstractCommand::appendJsonNumber(buffer, value);
+    }
+    buffer.append(context.ndjson.suffix);
+}
+
+/*!
+ * Appends an InfluxDB line protocol point to \a buffer, for a measurement of \a value, taken at \a timestamp (in
+ * nanoseconds since the epoch), within \a context. Returns \c true if appended, or \c false if \a value is not
+ * finite, since line protocol has no representation of infinity, nor NaN, so such points are skipped.
+ */
+bool MeasurementFormatter::appendLineProtocol(QByteArray &buffer, const Context &context, const float value,
+                                              const qint64 timestamp)
+{
+    if (!qIsFinite(value)) {
+        return false;
+    }
+    buffer.append(context.lineProtocol);
+    AbstractCommand::appendNumber(buffer, value, 'g', 6);
+    buffer.append(' ');
+    AbstractCommand::appendNumber(buffer, timestamp);
+    buffer.append('\n');
+    return true;
+}
+
+/*!
+ * Returns the Text output for a measurement of \a value, with \a lead (or, if \a lead is null, no lead), within
+ * \a context.
+ */
+QString MeasurementFormatter::formatText(const Context &context, const QString &lead, const float value)
+{
+    QByteArray digits;
+    AbstractCommand::appendNumber(digits, value, context.notation, 6);
+    const QString number = QString::fromLatin1(digits);
+    return context.textPrefix + ((lead.isNull()) ? context.text.arg(number) : context.text.arg(lead, number)) +
+        context.textSuffix;
+}
+
+/*!
+ * Appends a CSV row to \a buffer, for a raw device \a count, with \a lead (such as its timestamp), within \a context.
+ */
+void MeasurementFormatter::appendCsvCount(QByteArray &buffer, const Context &context, const QByteArray &lead,
+                                          const qint16 count)
+{
+    buffer.append(context.csv.prefix).append(lead).append(context.csv.infix);
+    AbstractCommand::appendNumber(buffer, (qint64)count);
+    buffer.append(context.csv.suffix);
+}
+
+/*!
+ * \overload
+ *
+ * This overload saves formatting integer \a lead (such as a DSO sample number) into a temporary QByteArray first.
+ */
+void MeasurementFormatter::appendCsvCount(QByteArray &buffer, const Context &context, const qint64 lead,
+                                          const qint16 count)
+{
+    buffer.append(context.csv.prefix);
+    AbstractCommand::appendNumber(buffer, lead);
+    buffer.append(context.csv.infix);
+    AbstractCommand::appendNumber(buffer, (qint64)count);
+    buffer.append(context.csv.suffix);
+}
+
+/*!
+ * Appends an NDJSON line to \a buffer, for a raw device \a count, with \a lead (such as its timestamp), within
+ * \a context.
+ */
+void MeasurementFormatter::appendNdjsonCount(QByteArray &buffer, const Context &context, const QByteArray &lead,
+                                             const qint16 count)
+{
+    buffer.append(context.ndjson.prefix).append(lead).append(context.ndjson.infix);
+    AbstractCommand::appendNumber(buffer, (qint64)count);
+    buffer.append(context.ndjson.suffix);
+}
+
+/*!
+ * Returns the Text output for a raw device \a count, with \a lead (or, if \a lead is null, no lead), within
+ * \a context.
+ */
+QString MeasurementFormatter::formatTextCount(const Context &context, const QString &lead, const qint16 count)
+{
+    const QString number = QString::number(count);
+    return context.textPrefix + ((lead.isNull()) ? context.text.arg(number) : context.text.arg(lead, number)) +
+        context.textSuffix;
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_MEASUREMENTFORMATTER_H
+#define DOKIT_MEASUREMENTFORMATTER_H
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include <functional>
+
+class MeasurementFormatter
+{
+public:
+    /// Constant text, such as field separators and labels, output before and after each measurement's value.
+    struct Affixes {
+        QByteArray prefix; ///< Output before the measurement's lead (such as its sample number, or timestamp).
+        QByteArray infix;  ///< Output between the measurement's lead, and its value.
+        QByteArray suffix; ///< Output after the measurement's value, including any line ending.
+    };
+
+    /// Everything about a measurement except its value (and sample number or timestamp), resolved just once per
+    /// distinct mode, range and status.
+    struct Context {
+        QString mode;       ///< Mode label, such as "DC Voltage".
+        QString unit;       ///< Unit label, such as "Vdc", or a null string if the mode has no unit.
+        QString range;      ///< Range label, such as "30V", or a null string if the mode has no range.
+        QString status;     ///< Status label, or a null string if not applicable (such as for DSO samples).
+        Affixes csv;        ///< Fields surrounding the value in CSV output.
+        Affixes ndjson;     ///< Fields surrounding the value in NDJSON output.
+        QByteArray lineProtocol; ///< Measurement, tags and field key output before the value in line protocol output.
+        QString textPrefix; ///< Text output before the #text template's output.
+        QString text;       ///< Translated Text output template, with the lead as %1 (if any) then the value.
+        QString textSuffix; ///< Text output after the #text template's output.
+        char notation { 'g' };   ///< QByteArray::number() format for values in CSV and Text output.
+        QByteArray jsonInfinity; ///< JSON value to output for infinite values, or null to output `null`.
+    };
+
+    /// Resolves the context of measurements with a given (raw) mode, range and status.
+    typedef std::function<Context(const quint8 mode, const quint8 range, const quint8 status)> Resolver;
+
+    explicit MeasurementFormatter(const Resolver &resolver);
+
+    const Context &context(const quint8 mode, const quint8 range, const quint8 status = 0);
+    void clear();
+    int size() const;
+
+    static void appendCsv(QByteArray &buffer, const Context &context, const QByteArray &lead, const float value);
+    static void appendCsv(QByteArray &buffer, const Context &context, const qint64 lead, const float value);
+    static void appendNdjson(QByteArray &buffer, const Context &context, const QByteArray &lead, const float value);
+    static bool appendLineProtocol(QByteArray &buffer, const Context &context, const float value,
+                                   const qint64 timestamp);
+    static QString formatText(const Context &context, const QString &lead, const float value);
+
+    static void appendCsvCount(QByteArray &buffer, const Context &context, const QByteArray &lead, const qint16 count);
+    static void appendCsvCount(QByteArray &buffer, const Context &context, const qint64 lead, const qint16 count);
+    static void appendNdjsonCount(QByteArray &buffer, const Context &context, const QByteArray &lead,
+                                  const qint16 count);
+    static QString formatTextCount(const Context &context, const QString &lead, const qint16 count);
+
+private:
+    Resolver resolver;                 ///< Resolves contexts not yet in #contexts.
+    QHash<quint32, Context> contexts;  ///< Resolved contexts, by key (see context()).
+    quint32 lastKey { 0 };             ///< Key of the most recently returned context, if #last is not \c nullptr.
+    const Context * last { nullptr };  ///< Most recently returned context, if any.
+
+    QTPOKIT_BEFRIEND_TEST(MeasurementFormatter)
+};
+
+#endif // DOKIT_MEASUREMENTFORMATTER_H
@@ -2,17 +2,39 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "metercommand.h"
+#include "phasetimer.h"
 #include "../stringliterals_p.h"
 
 #include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokittrace.h>
+#include <qtpokit/stallwatchdog.h>
 
+#include <QDateTime>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QTimer>
+#include <QtEndian>
 
-#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+// Qt 6.5.0 added new QDateTime::fromSecsSinceEpoch() and fromMSecsSinceEpoch()
+// overloads, then Qt 6.6.0 deprecated some of of the older ones.
+#if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
+    #define DOKIT_QT_UTC Qt::UTC
+#else
+    #include <QTimeZone>
+    #define DOKIT_QT_UTC QTimeZone::UTC
+#endif
 
 DOKIT_USE_STRINGLITERALS
 
+/// Default update interval for \c --burst captures, in milliseconds; the fastest interval the bench command tries.
+static constexpr quint32 burstInterval { 10 };
+
 /*!
  * \class MeterCommand
  *
@@ -37,9 +59,26 @@ QStringList MeterCommand::requiredOptions(const QCommandLineParser &parser) cons
 QStringList MeterCommand::supportedOptions(const QCommandLineParser &parser) const
 {
     return DeviceCommand::supportedOptions(parser) + QStringList{
+        u"aggregate"_s,
+        u"aggregate-step"_s,
+        u"battery-saver"_s,
+        u"burst"_s,
+        u"charge"_s,
+        u"charge-gap"_s,
+        u"deadband"_s,
+        u"dwell"_s,
+        u"event"_s,
+        u"heartbeat"_s,
+        u"influx"_s,
         u"interval"_s,
+        u"mqtt"_s,
+        u"pipeline"_s,
         u"range"_s,
         u"samples"_s,
+        u"settle"_s,
+        u"shared-memory"_s,
+        u"sqlite"_s,
+        u"watchdog"_s,
     };
 }
 
@@ -56,38 +95,41 @@ QStringList MeterCommand::processOptions(const QCommandLineParser &parser)
         return errors;
     }
 
-    // Parse the (required) mode option.
-    if (const QString mode = parser.value(u"mode"_s).trimmed().toLower();
-        mode.startsWith(u"ac v"_s) || mode.startsWith(u"vac"_s)) {
-        settings.mode = MultimeterService::Mode::AcVoltage;
-        minRangeFunc = minVoltageRange;
-    } else if (mode.startsWith(u"dc v"_s) || mode.startsWith(u"vdc"_s)) {
-        settings.mode = MultimeterService::Mode::DcVoltage;
-        minRangeFunc = minVoltageRange;
-    } else if (mode.startsWith(u"ac c"_s) || mode.startsWith(u"aac"_s)) {
-        settings.mode = MultimeterService::Mode::AcCurrent;
-        minRangeFunc = minCurrentRange;
-    } else if (mode.startsWith(u"dc c"_s) || mode.startsWith(u"adc"_s)) {
-        settings.mode = MultimeterService::Mode::DcCurrent;
-        minRangeFunc = minCurrentRange;
-    } else if (mode.startsWith(u"res"_s)) {
-        settings.mode = MultimeterService::Mode::Resistance;
-        minRangeFunc = minResistanceRange;
-    } else if (mode.startsWith(u"dio"_s)) {
-        settings.mode = MultimeterService::Mode::Diode;
-        minRangeFunc = nullptr;
-    } else if (mode.startsWith(u"cont"_s)) {
-        settings.mode = MultimeterService::Mode::Continuity;
-        minRangeFunc = nullptr;
-    } else if (mode.startsWith(u"temp"_s)) {
-        settings.mode = MultimeterService::Mode::Temperature;
-        minRangeFunc = nullptr;
-    } else if (mode.startsWith(u"cap"_s)) {
-        settings.mode = MultimeterService::Mode::Capacitance;
-        minRangeFunc = minCapacitanceRange;
-    } else {
-        errors.append(tr("Unknown meter mode: %1").arg(parser.value(u"mode"_s)));
-        return errors;
+    // Parse the (required) mode option, which may be a comma-separated list of modes to measure round-robin.
+    const QStringList modes = parser.value(u"mode"_s).split(u","_s);
+    for (const QString &value: modes) {
+        MinRangeFunc rangeFunc = nullptr;
+        const MultimeterService::Mode mode = parseMode(value, rangeFunc);
+        if (mode == MultimeterService::Mode::Idle) {
+            errors.append(tr("Unknown meter mode: %1").arg(value));
+            return errors;
+        }
+        if (schedule.isEmpty()) {
+            settings.mode = mode;
+            minRangeFunc = rangeFunc;
+        }
+        // Scheduled modes are always auto-ranged, and all products' AutoRange enumerators share the same value.
+        schedule.append({ mode, (rangeFunc == nullptr) ? quint8(0) : +PokitMeter::VoltageRange::AutoRange,
+                          dwellTime });
+    }
+    if (schedule.size() == 1) {
+        schedule.clear(); // Just a single mode, so nothing to schedule.
+    }
+
+    // Parse the dwell option.
+    if (parser.isSet(u"dwell"_s)) {
+        const QString value = parser.value(u"dwell"_s);
+        const quint32 dwell = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (dwell == 0) {
+            errors.append(tr("Invalid dwell value: %1").arg(value));
+        } else if (schedule.isEmpty()) {
+            errors.append(tr("The dwell option requires multiple modes"));
+        } else {
+            dwellTime = dwell;
+        }
+    }
+    for (MeterScheduler::Entry &entry: schedule) {
+        entry.dwell = dwellTime;
     }
 
     // Parse the interval option.
@@ -106,27 +148,13 @@ QStringList MeterCommand::processOptions(const QCommandLineParser &parser)
     if (parser.isSet(u"range"_s)) {
         const QString value = parser.value(u"range"_s);
         if (value.trimmed().compare(u"auto"_s, Qt::CaseInsensitive) != 0) {
-            switch (settings.mode) {
-            case MultimeterService::Mode::DcVoltage:
-            case MultimeterService::Mode::AcVoltage:
-                rangeOptionValue =  parseNumber<std::milli>(value, u"V"_s, 50); // mV.
-                break;
-            case MultimeterService::Mode::DcCurrent:
-            case MultimeterService::Mode::AcCurrent:
-                rangeOptionValue = parseNumber<std::milli>(value, u"A"_s, 5); // mA.
-                break;
-            case MultimeterService::Mode::Resistance:
-                rangeOptionValue = parseNumber<std::ratio<1>>(value, u"ohms"_s);
-                break;
-            case MultimeterService::Mode::Capacitance:
-                rangeOptionValue = parseNumber<std::nano>(value, u"F"_s, 500); // pF.
-                break;
-            default:
-                qCInfo(lc).noquote() << tr("Ignoring range value: %1").arg(value);
-            }
+            rangeOptionValue = parseRange(value, settings.mode);
             if ((minRangeFunc != nullptr) && (rangeOptionValue == 0)) {
                 errors.append(tr("Invalid range value: %1").arg(value));
             }
+            if (!schedule.isEmpty()) {
+                errors.append(tr("The range option is only supported for a single mode"));
+            }
         }
     }
 
@@ -140,9 +168,325 @@ QStringList MeterCommand::processOptions(const QCommandLineParser &parser)
             samplesToGo = samples;
         }
     }
+
+    // Parse the burst option.
+    if (parser.isSet(u"burst"_s)) {
+        const QString value = parser.value(u"burst"_s);
+        const quint32 burst = parseNumber<std::ratio<1>>(value, u"S"_s);
+        if ((burst == 0) || (burst > (quint32)std::numeric_limits<int>::max())) {
+            errors.append(tr("Invalid burst value: %1").arg(value));
+        } else {
+            burstCount = (int)burst;
+        }
+        if (!parser.isSet(u"interval"_s)) {
+            settings.updateInterval = burstInterval; // As fast as possible, unless asked otherwise.
+        }
+    }
+
+    // Parse the aggregate and aggregate-step options.
+    if (parser.isSet(u"aggregate"_s)) {
+        const QString value = parser.value(u"aggregate"_s);
+        aggregatePeriod = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (aggregatePeriod == 0) {
+            errors.append(tr("Invalid aggregate value: %1").arg(value));
+        }
+    }
+    if (parser.isSet(u"aggregate-step"_s)) {
+        const QString value = parser.value(u"aggregate-step"_s);
+        aggregateStep = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (aggregateStep == 0) {
+            errors.append(tr("Invalid aggregate-step value: %1").arg(value));
+        } else if (!parser.isSet(u"aggregate"_s)) {
+            errors.append(tr("The aggregate-step option requires the aggregate option"));
+        }
+    }
+
+    // Parse the deadband and heartbeat options.
+    if (((parser.isSet(u"deadband"_s)) || (parser.isSet(u"heartbeat"_s))) && (!deadband)) {
+        deadband = new MeterDeadband(nullptr, this);
+    }
+    if (parser.isSet(u"deadband"_s)) {
+        // Each comma-separated tolerance is either absolute (eg 0.01), or relative (eg 1%).
+        const QStringList tolerances = parser.value(u"deadband"_s).split(u","_s);
+        for (const QString &tolerance: tolerances) {
+            QString number = tolerance.trimmed();
+            const bool relative = number.endsWith(u"%"_s);
+            if (relative) {
+                number.chop(1);
+            }
+            bool ok = false;
+            const float value = number.trimmed().toFloat(&ok);
+            if ((!ok) || (value < 0.0f) || (!qIsFinite(value))) {
+                errors.append(tr("Invalid deadband value: %1").arg(tolerance));
+            } else if (relative) {
+                deadband->setRelativeDeadband(value / 100.0f);
+            } else {
+                deadband->setAbsoluteDeadband(value);
+            }
+        }
+    }
+    if (parser.isSet(u"heartbeat"_s)) {
+        const QString value = parser.value(u"heartbeat"_s);
+        const quint32 heartbeat = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (heartbeat == 0) {
+            errors.append(tr("Invalid heartbeat value: %1").arg(value));
+        } else {
+            deadband->setHeartbeat(heartbeat);
+        }
+    }
+    if ((deadband) && (aggregatePeriod > 0)) {
+        errors.append(tr("The deadband and heartbeat options cannot be combined with the aggregate option"));
+    }
+
+    // Parse the settle option.
+    if (parser.isSet(u"settle"_s)) {
+        const QString value = parser.value(u"settle"_s);
+        const quint32 settleTime = parseNumber<std::milli>(value, u"s"_s, 10);
+        if (settleTime == 0) {
+            errors.append(tr("Invalid settle value: %1").arg(value));
+        } else {
+            if (!settler) {
+                settler = new MeterSettler(nullptr, this);
+            }
+            settler->setDefaultSettleTime(settleTime);
+        }
+    }
+
+    // Parse the shared-memory option.
+    if (parser.isSet(u"shared-memory"_s)) {
+        const QString key = parser.value(u"shared-memory"_s);
+        if (!ring) {
+            ring = new SharedSampleRing(this);
+        }
+        if (!ring->create(key)) {
+            errors.append(tr("Failed to create shared memory ring %1: %2").arg(key, ring->errorString()));
+        }
+    }
+
+    // Parse the mqtt option.
+    if (parser.isSet(u"mqtt"_s)) {
+        const QString url = parser.value(u"mqtt"_s);
+        if (!mqtt) {
+            mqtt = new MqttPublisher(this);
+        }
+        if (!mqtt->setUrl(QUrl(url))) {
+            errors.append(tr("Invalid MQTT URL %1: %2").arg(url, mqtt->errorString()));
+        }
+    }
+
+    // Parse the sqlite option.
+    if (parser.isSet(u"sqlite"_s)) {
+        errors.append(addSqliteSink(parser.value(u"sqlite"_s)));
+    }
+
+    // Parse the influx option.
+    if (parser.isSet(u"influx"_s)) {
+        errors.append(addInfluxWriter(parser.value(u"influx"_s)));
+    }
+
+    // Parse the pipeline option.
+    if (parser.isSet(u"pipeline"_s)) {
+        errors.append(addPipeline(parser.value(u"pipeline"_s)));
+        if (!schedule.isEmpty()) {
+            errors.append(tr("The pipeline option is only supported for a single mode"));
+        }
+    }
+
+    // Parse the event option/s.
+    if (parser.isSet(u"event"_s)) {
+        errors.append(addEventDetectors(parser.values(u"event"_s)));
+        eventUnit = toUnit(settings.mode);
+        if (!schedule.isEmpty()) {
+            errors.append(tr("The event option is only supported for a single mode"));
+        }
+        if ((deadband) || (aggregatePeriod > 0)) {
+            errors.append(tr("The event option cannot be combined with the aggregate, deadband or heartbeat options"));
+        }
+    }
+
+    // Parse the charge and charge-gap options.
+    if (parser.isSet(u"charge"_s)) {
+        errors.append(addChargeIntegrator(parser.value(u"charge"_s),
+            (parser.isSet(u"charge-gap"_s)) ? parser.value(u"charge-gap"_s) : QString()));
+        if ((settings.mode != MultimeterService::Mode::DcCurrent) || (!schedule.isEmpty())) {
+            errors.append(tr("The charge option requires the (single) DC current mode"));
+        }
+        if ((deadband) || (aggregatePeriod > 0) || (!eventDetectors.isEmpty())) {
+            errors.append(tr("The charge option cannot be combined with the aggregate, deadband, event or heartbeat "
+                             "options"));
+        }
+        if (chargeIntegrator->maximumGap() == 0) {
+            // Readings arrive with some jitter, so only treat several missed readings in a row as a gap.
+            chargeIntegrator->setMaximumGap(3 * settings.updateInterval);
+        }
+    } else if (parser.isSet(u"charge-gap"_s)) {
+        errors.append(tr("The charge-gap option requires the charge option"));
+    }
+
+    // Parse the battery-saver option, of the form <max-interval>[,<conserve-voltage>[,<critical-voltage>]].
+    if (parser.isSet(u"battery-saver"_s)) {
+        const QString value = parser.value(u"battery-saver"_s);
+        const QStringList parts = value.split(u","_s);
+        const auto parseVoltage = [](QString text, float &voltage) {
+            text = text.trimmed();
+            if (text.endsWith(u"V"_s, Qt::CaseInsensitive)) {
+                text.chop(1);
+            }
+            bool ok = false;
+            const float number = text.trimmed().toFloat(&ok);
+            if ((!ok) || (number <= 0.0f) || (!qIsFinite(number))) {
+                return false;
+            }
+            voltage = number;
+            return true;
+        };
+        batterySaverInterval = parseNumber<std::milli>(parts.at(0), u"s"_s, 500);
+        if ((batterySaverInterval == 0) || (parts.size() > 3)
+            || ((parts.size() > 1) && (!parseVoltage(parts.at(1), conserveVoltage)))
+            || ((parts.size() > 2) && (!parseVoltage(parts.at(2), criticalVoltage)))) {
+            errors.append(tr("Invalid battery-saver value: %1").arg(value));
+        } else if (criticalVoltage >= conserveVoltage) {
+            errors.append(tr("The battery-saver critical voltage must be less than its conserve voltage"));
+        } else if (batterySaverInterval <= settings.updateInterval) {
+            errors.append(tr("The battery-saver interval must be longer than the meter interval"));
+        }
+    }
+
+    // Parse the watchdog option.
+    if (parser.isSet(u"watchdog"_s)) {
+        errors.append(setWatchdogFactor(parser.value(u"watchdog"_s)));
+    }
+
+    if (burstCount > 0) {
+        if (!schedule.isEmpty()) {
+            errors.append(tr("The burst option is only supported for a single mode"));
+        }
+        if ((samplesToGo > 0) || (aggregatePeriod > 0) || (deadband) || (settler) || (!eventDetectors.isEmpty()) ||
+            (chargeIntegrator) || (batterySaverInterval > 0) || (watchdogFactor > 0.0f)) {
+            errors.append(tr("The burst option cannot be combined with the aggregate, battery-saver, charge, deadband, "
+                             "event, heartbeat, samples, settle or watchdog options"));
+        }
+        if ((ring) || (mqtt) || (sqlite) || (influx)) {
+            errors.append(tr("The burst option cannot be combined with the influx, mqtt, shared-memory or sqlite "
+                             "options"));
+        }
+        if ((format != OutputFormat::Csv) && (format != OutputFormat::Json) && (format != OutputFormat::Text)) {
+            errors.append(tr("The burst option only supports CSV, JSON and Text output"));
+        }
+    }
+    if ((format == OutputFormat::Binary) && (aggregatePeriod > 0)) {
+        errors.append(tr("Binary output is only supported for raw readings, not --aggregate"));
+    }
+    if ((format == OutputFormat::Arrow) && (aggregatePeriod > 0)) {
+        errors.append(tr("Arrow output is only supported for raw readings, not --aggregate"));
+    }
+    if ((format == OutputFormat::LineProtocol) && (aggregatePeriod > 0)) {
+        errors.append(tr("Line protocol output is only supported for raw readings, not --aggregate"));
+    }
     return errors;
 }
 
+/*!
+ * Returns the multimeter mode named by \a value, such as "Vdc" or "resistance", and sets \a rangeFunc to the function
+ * for converting range option values for that mode (or \c nullptr if the mode has no ranges). Returns
+ * MultimeterService::Mode::Idle if \a value is not a supported mode.
+ */
+MultimeterService::Mode MeterCommand::parseMode(const QString &value, MinRangeFunc &rangeFunc)
+{
+    const QString mode = value.trimmed().toLower();
+    rangeFunc = nullptr;
+    if (mode.startsWith(u"ac v"_s) || mode.startsWith(u"vac"_s)) {
+        rangeFunc = minVoltageRange;
+        return MultimeterService::Mode::AcVoltage;
+    } else if (mode.startsWith(u"dc v"_s) || mode.startsWith(u"vdc"_s)) {
+        rangeFunc = minVoltageRange;
+        return MultimeterService::Mode::DcVoltage;
+    } else if (mode.startsWith(u"ac c"_s) || mode.startsWith(u"aac"_s)) {
+        rangeFunc = minCurrentRange;
+        return MultimeterService::Mode::AcCurrent;
+    } else if (mode.startsWith(u"dc c"_s) || mode.startsWith(u"adc"_s)) {
+        rangeFunc = minCurrentRange;
+        return MultimeterService::Mode::DcCurrent;
+    } else if (mode.startsWith(u"res"_s)) {
+        rangeFunc = minResistanceRange;
+        return MultimeterService::Mode::Resistance;
+    } else if (mode.startsWith(u"dio"_s)) {
+        return MultimeterService::Mode::Diode;
+    } else if (mode.startsWith(u"cont"_s)) {
+        return MultimeterService::Mode::Continuity;
+    } else if (mode.startsWith(u"temp"_s)) {
+        return MultimeterService::Mode::Temperature;
+    } else if (mode.startsWith(u"cap"_s)) {
+        rangeFunc = minCapacitanceRange;
+        return MultimeterService::Mode::Capacitance;
+    }
+    return MultimeterService::Mode::Idle;
+}
+
+/*!
+ * Returns the range option \a value as an upper limit in the units of \a mode's range functions (ie mV, mA, ohms or
+ * pF), or 0 if \a value is not valid. Modes without ranges ignore \a value (with an informational message), and so
+ * also return 0.
+ */
+quint32 MeterCommand::parseRange(const QString &value, const MultimeterService::Mode mode)
+{
+    switch (mode) {
+    case MultimeterService::Mode::DcVoltage:
+    case MultimeterService::Mode::AcVoltage:
+        return parseNumber<std::milli>(value, u"V"_s, 50); // mV.
+    case MultimeterService::Mode::DcCurrent:
+    case MultimeterService::Mode::AcCurrent:
+        return parseNumber<std::milli>(value, u"A"_s, 5); // mA.
+    case MultimeterService::Mode::Resistance:
+        return parseNumber<std::ratio<1>>(value, u"ohms"_s);
+    case MultimeterService::Mode::Capacitance:
+        return parseNumber<std::nano>(value, u"F"_s, 500); // pF.
+    default:
+        qCInfo(lc).noquote() << tr("Ignoring range value: %1").arg(value);
+    }
+    return 0;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsArrowOutput
+ *
+ * This override returns \c true, since meter readings may be output as Arrow record batches.
+ */
+bool MeterCommand::supportsArrowOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsBinaryOutput
+ *
+ * This override returns \c true, since meter readings may be output as packed Binary records.
+ */
+bool MeterCommand::supportsBinaryOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsLineProtocolOutput
+ *
+ * This override returns \c true, since meter readings may be output as line protocol points, timestamped by the host.
+ */
+bool MeterCommand::supportsLineProtocolOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonOutput
+ *
+ * This override returns \c true, since meter readings may be streamed indefinitely.
+ */
+bool MeterCommand::supportsNdjsonOutput() const
+{
+    return true;
+}
+
 /*!
  * \copybrief DeviceCommand::getService
  *
@@ -154,8 +498,48 @@ AbstractPokitService * MeterCommand::getService()
     if (!service) {
         service = device->multimeter();
         Q_ASSERT(service);
-        connect(service, &MultimeterService::settingsWritten,
-                this, &MeterCommand::settingsWritten);
+        if (schedule.isEmpty()) {
+            connect(service, &MultimeterService::settingsWritten,
+                    this, &MeterCommand::settingsWritten);
+        } else {
+            scheduler = new MeterScheduler(service, this);
+            scheduler->setEntries(schedule);
+            connect(scheduler, &MeterScheduler::entryStarted, this, &MeterCommand::entryStarted);
+        }
+        if (aggregatePeriod > 0) {
+            // Aggregate raw readings from the service, unless they need to be settled, or scheduled, first.
+            aggregator = new MeterAggregator(((settler) || (scheduler)) ? nullptr : service, this);
+            aggregator->setPeriod(aggregatePeriod);
+            aggregator->setStep(aggregateStep);
+            if (settler) {
+                connect(settler, &MeterSettler::readingSettled, aggregator, &MeterAggregator::addReading);
+            } else if (scheduler) {
+                connect(scheduler, &MeterScheduler::readingReady, aggregator,
+                        [this](const MultimeterService::Reading &reading) {
+                            aggregator->addReading(reading, QDateTime::currentMSecsSinceEpoch());
+                        });
+            }
+            connect(aggregator, &MeterAggregator::windowReady, this, &MeterCommand::outputWindow);
+        }
+        if (scheduler) {
+            connect(scheduler, &MeterScheduler::readingReady, this, &MeterCommand::outputReading);
+        }
+        if (batterySaverInterval > 0) {
+            // The status service is discovered alongside the multimeter service, so just read it once it's ready.
+            StatusService * const status = device->status();
+            Q_ASSERT(status);
+            batteryPolicy = new BatteryPolicy(status, this);
+            batteryPolicy->setBaseInterval(settings.updateInterval);
+            batteryPolicy->setMaximumInterval(batterySaverInterval);
+            batteryPolicy->setConserveVoltage(conserveVoltage);
+            batteryPolicy->setCriticalVoltage(criticalVoltage);
+            connect(batteryPolicy, &BatteryPolicy::decisionChanged, this, &MeterCommand::batteryDecisionChanged);
+            connect(status, &AbstractPokitService::serviceDetailsDiscovered, status,
+                    &StatusService::readStatusCharacteristic);
+            statusTimer = new QTimer(this);
+            connect(statusTimer, &QTimer::timeout, status, &StatusService::readStatusCharacteristic);
+            statusTimer->start(60000); // Battery voltage changes slowly, and every read costs the device power too.
+        }
     }
     return service;
 }
@@ -168,12 +552,32 @@ AbstractPokitService * MeterCommand::getService()
 void MeterCommand::serviceDetailsDiscovered()
 {
     DeviceCommand::serviceDetailsDiscovered(); // Just logs consistently.
+    if (mqtt) {
+        const QLowEnergyController * const controller = device->controller();
+        mqttTopic = mqtt->topic((controller->remoteName().isEmpty()) ? controller->remoteAddress().toString()
+            : controller->remoteName(), u"meter"_s);
+        mqtt->start();
+    }
+    if (scheduler) {
+        QStringList names;
+        for (const MeterScheduler::Entry &entry: schedule) {
+            names.append(MultimeterService::toString(entry.mode));
+        }
+        qCInfo(lc).noquote() << tr("Measuring %1, round-robin for %L2ms each, every %L3ms.")
+            .arg(names.join(u", "_s)).arg(dwellTime).arg(settings.updateInterval);
+        scheduler->setUpdateInterval(settings.updateInterval);
+        scheduler->start();
+        settingsRequested = true;
+        startWatchdog(service, settings.updateInterval);
+        return;
+    }
     settings.range = (minRangeFunc == nullptr) ? 0 : minRangeFunc(*service->pokitProduct(), rangeOptionValue);
     const QString range = service->toString(settings.range, settings.mode);
     qCInfo(lc).noquote() << tr("Measuring %1, with range %2, every %L3ms.").arg(
         MultimeterService::toString(settings.mode),
         (range.isNull()) ? QString::fromLatin1("N/A") : range).arg(settings.updateInterval);
     service->setSettings(settings);
+    settingsRequested = true;
 }
 
 /*!
@@ -196,20 +600,146 @@ void MeterCommand::serviceDetailsDiscovered()
 void MeterCommand::settingsWritten()
 {
     qCDebug(lc).noquote() << tr("Settings written; starting meter readings...");
+    PhaseTimer::mark(PhaseTimer::Phase::SettingsWritten);
+    if (burstCount > 0) {
+        // Only record the readings until the burst is complete, so that nothing delays them in the meantime.
+        qCInfo(lc).noquote() << tr("Capturing %Ln reading/s to memory...", nullptr, burstCount);
+        connect(service, &MultimeterService::burstCompleted, this, &MeterCommand::outputBurst, Qt::UniqueConnection);
+        service->startBurst(burstCount);
+        service->enableReadingNotifications();
+        return;
+    }
+    // Settings may be written again, such as by the watchdog (if set) to recover from stalled readings.
     connect(service, &MultimeterService::readingRead,
-            this, &MeterCommand::outputReading);
+            this, &MeterCommand::outputReading, Qt::UniqueConnection);
     service->enableReadingNotifications();
+    startWatchdog(service, settings.updateInterval);
 }
 
 /*!
- * Outputs meter \a reading in the selected output format.
+ * Invoked when the #batteryPolicy makes a new \a decision, to apply its update interval and connection profile.
+ *
+ * Single-mode measurement applies a new interval by rewriting the multimeter settings, while scheduled measurement
+ * applies it as of the next mode switch. If the battery is critical, also suggests (once) that on-device logging would
+ * conserve much more power than any meter update interval can.
  */
-void MeterCommand::outputReading(const MultimeterService::Reading &reading)
+void MeterCommand::batteryDecisionChanged(const BatteryPolicy::Decision &decision)
+{
+    const std::optional<StatusService::Status> status = batteryPolicy->lastStatus();
+    qCInfo(lc).noquote() << tr("Battery %1 (%L2V); measuring every %L3ms.")
+        .arg(BatteryPolicy::toString(decision.level))
+        .arg((status) ? status->batteryVoltage : std::numeric_limits<float>::quiet_NaN())
+        .arg(decision.updateInterval);
+    if (decision.updateInterval != settings.updateInterval) {
+        settings.updateInterval = decision.updateInterval;
+        if (scheduler) {
+            scheduler->setUpdateInterval(settings.updateInterval);
+        } else if (settingsRequested) {
+            service->setSettings(settings); // Re-enables reading notifications once written.
+        }
+        if (watchdog) {
+            watchdog->setExpectedInterval(settings.updateInterval);
+        }
+    }
+    device->setConnectionProfile((decision.connectionProfile == PokitDevice::ConnectionProfile::Default)
+        ? connectionProfile.value_or(PokitDevice::ConnectionProfile::Default) : decision.connectionProfile);
+    if ((decision.preferLogging) && (!loggingSuggested) && (samplesToGo < 0)) {
+        loggingSuggested = true;
+        qCWarning(lc).noquote() << tr("Battery is critical; consider on-device logging (logger-start, then periodic "
+                                      "logger-fetch) instead.");
+    }
+}
+
+/*!
+ * Invoked when the first reading for the #scheduler's entry at \a index has arrived, \a latency milliseconds after
+ * switching to it, to report the switch latency.
+ */
+void MeterCommand::entryStarted(const int index, const qint64 latency)
+{
+    qCInfo(lc).noquote() << tr("Switched to %1 in %L2ms.")
+        .arg(MultimeterService::toString(schedule.at(index).mode)).arg(latency);
+}
+
+/*!
+ * Returns summary statistics of the burst of readings in \a history, such as their timing (from the time each was
+ * received), and the range of their values. Readings with an error status are counted, but excluded from the value
+ * statistics. Standard deviations are of the whole population (ie the burst itself).
+ */
+MeterCommand::BurstSummary MeterCommand::summariseBurst(const MeterHistory &history)
+{
+    BurstSummary summary;
+    summary.count = (int)history.size();
+    if (history.isEmpty()) {
+        return summary;
+    }
+    summary.duration = (history.lastTimestamp() - history.firstTimestamp()) / 1'000'000.0;
+
+    // Intervals between consecutive readings.
+    if (history.size() > 1) {
+        summary.meanInterval = summary.duration / (double)(history.size() - 1);
+        double sumOfSquares = 0.0;
+        summary.maxInterval = 0.0;
+        qint64 previous = history.firstTimestamp();
+        for (auto iter = ++history.begin(); iter != history.end(); ++iter) {
+            const qint64 timestamp = (*iter).timestamp;
+            const double interval = (timestamp - previous) / 1'000'000.0;
+            sumOfSquares += (interval - summary.meanInterval) * (interval - summary.meanInterval);
+            summary.maxInterval = qMax(summary.maxInterval, interval);
+            previous = timestamp;
+        }
+        summary.intervalJitter = std::sqrt(sumOfSquares / (double)(history.size() - 1));
+    }
+
+    // Values of the (non-error) readings, scanned a span (of contiguous values) at a time.
+    const QVector<MeterHistory::Span> spans = history.spans();
+    double sum = 0.0;
+    for (const MeterHistory::Span &span: spans) {
+        if (span.status == MultimeterService::MeterStatus::Error) {
+            summary.errors += (int)span.count;
+            continue;
+        }
+        for (qsizetype index = 0; index < span.count; ++index) {
+            const double value = span.values[index];
+            summary.minimum = (qIsNaN(summary.minimum)) ? value : qMin(summary.minimum, value);
+            summary.maximum = (qIsNaN(summary.maximum)) ? value : qMax(summary.maximum, value);
+            sum += value;
+        }
+    }
+    const int values = summary.count - summary.errors;
+    if (values > 0) {
+        summary.mean = sum / values;
+        double sumOfSquares = 0.0;
+        for (const MeterHistory::Span &span: spans) {
+            if (span.status != MultimeterService::MeterStatus::Error) {
+                for (qsizetype index = 0; index < span.count; ++index) {
+                    sumOfSquares += (span.values[index] - summary.mean) * (span.values[index] - summary.mean);
+                }
+            }
+        }
+        summary.stddev = std::sqrt(sumOfSquares / values);
+    }
+    return summary;
+}
+
+/*!
+ * \overload
+ *
+ * Returns summary statistics of the burst of \a readings, as stored in a MeterHistory.
+ */
+MeterCommand::BurstSummary MeterCommand::summariseBurst(const QVector<MultimeterService::TimedReading> &readings)
+{
+    return summariseBurst(MeterHistory::fromVector(readings));
+}
+
+/*!
+ * Returns a human-readable string for meter \a status, as interpreted for \a mode.
+ */
+QString MeterCommand::toStatus(const MultimeterService::MeterStatus status, const MultimeterService::Mode mode)
 {
-    QString status;
-    if (reading.status == MultimeterService::MeterStatus::Error) {
-        status = u"Error"_s;
-    } else switch (reading.mode) {
+    QString string;
+    if (status == MultimeterService::MeterStatus::Error) {
+        string = u"Error"_s;
+    } else switch (mode) {
     case MultimeterService::Mode::Idle:
         break;
     case MultimeterService::Mode::DcVoltage:
@@ -218,74 +748,375 @@ void MeterCommand::outputReading(const MultimeterService::Reading &reading)
     case MultimeterService::Mode::AcCurrent:
     case MultimeterService::Mode::Resistance:
     case MultimeterService::Mode::Capacitance:
-        status = (reading.status == MultimeterService::MeterStatus::AutoRangeOn)
+        string = (status == MultimeterService::MeterStatus::AutoRangeOn)
             ? tr("Auto Range On") : tr("Auto Range Off");
         break;
     case MultimeterService::Mode::Continuity:
-        status = (reading.status == MultimeterService::MeterStatus::Continuity)
+        string = (status == MultimeterService::MeterStatus::Continuity)
             ? tr("Continuity") : tr("No continuity");
         break;
     case MultimeterService::Mode::Temperature:
     case MultimeterService::Mode::ExternalTemperature:
     case MultimeterService::Mode::Diode:
-        status = tr("Ok");
+        string = tr("Ok");
         break;
     }
+    return string;
+}
 
-    QString unit;
-    switch (reading.mode) {
+/*!
+ * Returns the unit string for meter \a mode, or a null string if \a mode has no unit.
+ */
+QString MeterCommand::toUnit(const MultimeterService::Mode mode)
+{
+    switch (mode) {
     case MultimeterService::Mode::Idle:        break;
-    case MultimeterService::Mode::DcVoltage:   unit = u"Vdc"_s; break;
-    case MultimeterService::Mode::AcVoltage:   unit = u"Vac"_s; break;
-    case MultimeterService::Mode::DcCurrent:   unit = u"Adc"_s; break;
-    case MultimeterService::Mode::AcCurrent:   unit = u"Aac"_s; break;
-    case MultimeterService::Mode::Resistance:  unit = QString::fromUtf8("Ω"); break;
+    case MultimeterService::Mode::DcVoltage:   return u"Vdc"_s;
+    case MultimeterService::Mode::AcVoltage:   return u"Vac"_s;
+    case MultimeterService::Mode::DcCurrent:   return u"Adc"_s;
+    case MultimeterService::Mode::AcCurrent:   return u"Aac"_s;
+    case MultimeterService::Mode::Resistance:  return QString::fromUtf8("Ω");
     case MultimeterService::Mode::Diode:       break;
     case MultimeterService::Mode::Continuity:  break;
-    case MultimeterService::Mode::Temperature: unit = QString::fromUtf8("°C"); break;
-    case MultimeterService::Mode::Capacitance: unit = QString::fromUtf8("F");  break;
-    case MultimeterService::Mode::ExternalTemperature: unit = QString::fromUtf8("°C"); break;
+    case MultimeterService::Mode::Temperature: return QString::fromUtf8("°C");
+    case MultimeterService::Mode::Capacitance: return QString::fromUtf8("F");
+    case MultimeterService::Mode::ExternalTemperature: return QString::fromUtf8("°C");
+    }
+    return QString();
+}
+
+/*!
+ * Resolves the context (labels, and each output format's constant fields) of meter readings with \a mode, \a range
+ * and \a status.
+ */
+MeasurementFormatter::Context MeterCommand::resolveContext(const quint8 mode, const quint8 range,
+                                                           const quint8 status) const
+{
+    const auto meterMode = (MultimeterService::Mode)mode;
+    MeasurementFormatter::Context context;
+    context.mode = MultimeterService::toString(meterMode);
+    context.unit = toUnit(meterMode);
+    context.range = service->toString(range, meterMode);
+    context.status = toStatus((MultimeterService::MeterStatus)status, meterMode);
+    context.notation = 'f';
+    context.csv.prefix = escapeCsvField(context.mode).toUtf8() + ','; // mode,value,unit,status,range
+    context.csv.suffix = ',' + context.unit.toUtf8() + ',' + context.status.toUtf8() + ',' +
+        context.range.toUtf8() + '\n';
+    context.ndjson.prefix = "{\"status\":" + escapeJsonString(context.status) + ",\"value\":";
+    context.ndjson.suffix = ",\"mode\":" + escapeJsonString(context.mode);
+    if (!context.unit.isNull()) {
+        context.ndjson.suffix.append(",\"unit\":").append(escapeJsonString(context.unit));
+    }
+    if (!context.range.isNull()) {
+        context.ndjson.suffix.append(",\"range\":").append(escapeJsonString(context.range));
+    }
+    context.ndjson.suffix.append("}\n");
+    context.jsonInfinity = escapeJsonString(tr("Infinity"));
+    context.lineProtocol = lineProtocolPrefix("meter", context);
+    context.textPrefix = tr("Mode:   %1 (0x%2)\n").arg(context.mode).arg(mode,2,16,'0'_L1);
+    context.text = tr("Value:  %1 %2\n").arg(u"%1"_s, context.unit); // Just the value to go.
+    context.textSuffix = tr("Status: %1 (0x%2)\n").arg(context.status).arg(status,2,16,'0'_L1) +
+        tr("Range:  %1 (0x%2)\n").arg(context.range).arg(range,2,16,'0'_L1);
+    return context;
+}
+
+/*!
+ * Outputs meter \a reading in the selected output format.
+ *
+ * If readings are being aggregated, then \a reading is only counted here, and is output (as part of a window) by
+ * outputWindow() instead. Likewise, if \a reading is suppressed by the #deadband filter, it is only counted. And if
+ * events are being detected, then \a reading is only added to the #eventDetectors, which output events instead. And
+ * if charge is being counted, then \a reading is only added to the #chargeIntegrator, which outputs running totals.
+ *
+ * If \a reading was taken before the value settled following a range change (see #settler), then it is discarded
+ * without being counted, so that all requested samples are settled ones. Otherwise, it is also published to the
+ * shared memory #ring, the MQTT broker, the SQLite database, the InfluxDB server, and the #pipeline (if any),
+ * regardless of any aggregation or filtering of the command's own output. SQLite sessions start afresh whenever the
+ * meter's mode or range changes.
+ */
+void MeterCommand::outputReading(const MultimeterService::Reading &reading)
+{
+    QTPOKIT_TRACE_ZONE(Format, "meterReading");
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+    if ((settler) && (!settler->addReading(reading, timestamp))) {
+        qCDebug(lc).noquote() << tr("Discarding unsettled reading: %1").arg(reading.value);
+        return;
+    }
+    if (ring) {
+        ring->publish(reading, timestamp * 1000);
+    }
+    if (mqtt) {
+        mqtt->publish(mqttTopic, reading, timestamp, settings.updateInterval);
+    }
+    if ((sqlite) && (reading.status != MultimeterService::MeterStatus::Error)) {
+        const MeasurementFormatter::Context &context =
+            formatter.context((quint8)reading.mode, reading.range, (quint8)reading.status);
+        if (setSqliteSession(u"meter"_s, context.mode, context.unit, context.range, settings.updateInterval,
+                             timestamp)) {
+            sqlite->addSample(timestamp, reading.value);
+            sqlite->commit(); // One transaction per reading.
+        }
+    }
+    if ((influx) && (reading.status != MultimeterService::MeterStatus::Error)) {
+        influx->write(deviceName(), formatter.context((quint8)reading.mode, reading.range, (quint8)reading.status),
+                      reading.value, timestamp * 1'000'000);
+    }
+    if ((pipeline) && (reading.status != MultimeterService::MeterStatus::Error)) {
+        pipeline->addValue(reading.value, timestamp, settings.updateInterval);
+    }
+    if ((!eventDetectors.isEmpty()) && (reading.status != MultimeterService::MeterStatus::Error)) {
+        addEventValue(reading.value, timestamp);
+    }
+    if ((chargeIntegrator) && (reading.status != MultimeterService::MeterStatus::Error)) {
+        chargeIntegrator->addSample(reading.value, timestamp);
+    }
+    if ((aggregator) || (!eventDetectors.isEmpty()) || (chargeIntegrator) ||
+        ((deadband) && (!deadband->addReading(reading, timestamp)))) {
+        if ((samplesToGo > 0) && (--samplesToGo == 0)) {
+            if (aggregator) aggregator->flush(); // Output the final, partial, window(s).
+            flushEvents(); // Output the final event, if still in progress.
+            if (chargeIntegrator) chargeIntegrator->flush(); // Output the final totals.
+            if (device) disconnect(); // Will exit the application once disconnected.
+        }
+        return;
     }
 
-    const QString range = service->toString(reading.range, reading.mode);
+    const MeasurementFormatter::Context &context =
+        formatter.context((quint8)reading.mode, reading.range, (quint8)reading.status);
 
     switch (format) {
     case OutputFormat::Csv:
         for (; showCsvHeader; showCsvHeader = false) {
-            std::cout << qUtf8Printable(tr("mode,value,unit,status,range\n"));
+            output(tr("mode,value,unit,status,range\n"));
         }
-        std::cout << qUtf8Printable(QString::fromLatin1("%1,%2,%3,%4,%5\n")
-            .arg(escapeCsvField(MultimeterService::toString(reading.mode)))
-            .arg(reading.value, 0, 'f').arg(unit, status, range)
-            );
+        MeasurementFormatter::appendCsv(outputBuffer, context, QByteArray(), reading.value);
         break;
     case OutputFormat::Json: {
         QJsonObject object{
-            { u"status"_s, status },
+            { u"status"_s, context.status },
             { u"value"_s, qIsInf(reading.value) ?
                 QJsonValue(tr("Infinity")) : QJsonValue(reading.value) },
-            { u"mode"_s,   MultimeterService::toString(reading.mode) },
+            { u"mode"_s,   context.mode },
+        };
+        if (!context.unit.isNull()) {
+            object.insert(u"unit"_s, context.unit);
+        }
+        if (!context.range.isNull()) {
+            object.insert(u"range"_s, context.range);
+        }
+        output(QJsonDocument(object).toJson());
+    }   break;
+    case OutputFormat::Ndjson:
+        MeasurementFormatter::appendNdjson(outputBuffer, context, QByteArray(), reading.value);
+        break;
+    case OutputFormat::NdjsonEnvelope: // Not supported (readings may vary in mode and range).
+        break;
+    case OutputFormat::Arrow: // One single-row record batch per reading, since each is a separate notification.
+        outputArrowRecordBatch({ QDateTime::currentMSecsSinceEpoch() * 1000 }, { reading.value },
+                               (quint8)reading.mode, reading.range);
+        break;
+    case OutputFormat::LineProtocol: // Timestamped by the host, in nanoseconds.
+        MeasurementFormatter::appendLineProtocol(outputBuffer, context, reading.value, timestamp * 1'000'000);
+        break;
+    case OutputFormat::Binary: {
+        for (; showBinaryHeader; showBinaryHeader = false) {
+            writeBinaryHeader(outputBuffer, BinaryBlock::MeterReadings, (quint8)settings.mode, settings.range,
+                              1.0f, settings.updateInterval, (quint64)QDateTime::currentMSecsSinceEpoch(),
+                              ((samplesToGo > 0) && (!deadband)) ? (quint32)samplesToGo : 0);
+        }
+        quint32 valueBits;
+        std::memcpy(&valueBits, &reading.value, sizeof(valueBits));
+        char record[8] { 0, 0, 0, 0, (char)reading.status, (char)reading.mode, (char)reading.range, 0 };
+        qToLittleEndian<quint32>(valueBits, record);
+        outputBuffer.append(record, sizeof(record));
+    }   break;
+    case OutputFormat::Text:
+        output(MeasurementFormatter::formatText(context, QString(), reading.value));
+        break;
+    }
+    outputBatchComplete((service) ? service->receiveTimestamp() : -1);
+
+    if ((samplesToGo > 0) && (--samplesToGo == 0)) {
+        if (device) disconnect(); // Will exit the application once disconnected.
+    }
+}
+
+/*!
+ * Outputs the aggregated readings of \a window in the selected output format.
+ */
+void MeterCommand::outputWindow(const MeterAggregator::Window &window)
+{
+    const QString start = QDateTime::fromMSecsSinceEpoch(window.start, DOKIT_QT_UTC).toString(Qt::ISODateWithMs);
+    const QString end = QDateTime::fromMSecsSinceEpoch(window.end, DOKIT_QT_UTC).toString(Qt::ISODateWithMs);
+    const MeasurementFormatter::Context &context =
+        formatter.context((quint8)window.mode, window.range, (quint8)window.status);
+    const QString &status = context.status;
+    const QString &unit = context.unit;
+    const QString &range = context.range;
+    const auto toString = [](const float value) { return qIsNaN(value) ? QString() : QString::number(value); };
+
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("start,end,mode,count,minimum,maximum,mean,unit,status,range\n"));
+        }
+        output(QString::fromLatin1("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10\n")
+            .arg(start, end, escapeCsvField(context.mode)).arg(window.count)
+            .arg(toString(window.minimum), toString(window.maximum), toString(window.mean), unit, status, range));
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope: {
+        QJsonObject object{
+            { u"start"_s,  start },
+            { u"end"_s,    end },
+            { u"mode"_s,   context.mode },
+            { u"count"_s,  (qint64)window.count },
+            { u"status"_s, status },
         };
+        for (const auto &[key, value]: { std::pair(u"minimum"_s, window.minimum),
+                                         std::pair(u"maximum"_s, window.maximum),
+                                         std::pair(u"mean"_s, window.mean) }) {
+            if (!qIsNaN(value)) {
+                object.insert(key, qIsInf(value) ? QJsonValue(tr("Infinity")) : QJsonValue(value));
+            }
+        }
         if (!unit.isNull()) {
             object.insert(u"unit"_s, unit);
         }
         if (!range.isNull()) {
             object.insert(u"range"_s, range);
         }
-        std::cout << QJsonDocument(object).toJson().toStdString();
+        output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+            : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
     }   break;
+    case OutputFormat::Arrow:  // Not supported (rejected by processOptions).
+    case OutputFormat::LineProtocol: // Not supported (rejected by processOptions).
+    case OutputFormat::Binary: // Not supported (rejected by processOptions).
     case OutputFormat::Text:
-        std::cout << qUtf8Printable(tr("Mode:   %1 (0x%2)\n").arg(MultimeterService::toString(reading.mode))
-            .arg((quint8)reading.mode,2,16,'0'_L1));
-        std::cout << qUtf8Printable(tr("Value:  %1 %2\n").arg(reading.value,0,'f').arg(unit));
-        std::cout << qUtf8Printable(tr("Status: %1 (0x%2)\n").arg(status)
-            .arg((quint8)reading.status,2,16,'0'_L1));
-        std::cout << qUtf8Printable(tr("Range:  %1 (0x%2)\n").arg(range)
-            .arg((quint8)reading.range,2,16,'0'_L1));
+        output(tr("Window:  %1 to %2\n").arg(start, end));
+        output(tr("Mode:    %1 (0x%2)\n").arg(context.mode)
+            .arg((quint8)window.mode,2,16,'0'_L1));
+        output(tr("Count:   %1\n").arg(window.count));
+        for (const auto &[label, value]: { std::pair(tr("Minimum: %1\n"), window.minimum),
+                                           std::pair(tr("Maximum: %1\n"), window.maximum),
+                                           std::pair(tr("Mean:    %1\n"), window.mean) }) {
+            output(label.arg(qIsNaN(value) ? tr("N/A") : QString::fromLatin1("%1 %2").arg(value).arg(unit)));
+        }
+        output(tr("Status:  %1 (0x%2)\n").arg(status)
+            .arg((quint8)window.status,2,16,'0'_L1));
+        output(tr("Range:   %1 (0x%2)\n").arg(range)
+            .arg((quint8)window.range,2,16,'0'_L1));
         break;
     }
+    outputBatchComplete();
+}
 
-    if ((samplesToGo > 0) && (--samplesToGo == 0)) {
-        if (device) disconnect(); // Will exit the application once disconnected.
+/*!
+ * Outputs the burst of \a readings, each with its time (in milliseconds) since the first reading, followed by their
+ * summary statistics (see summariseBurst()), all in one batch, in the selected output format. For CSV output, which has
+ * no place for the summary, the summary is logged instead.
+ *
+ * Since the burst is complete, this then disconnects from the device, which will exit the application.
+ */
+void MeterCommand::outputBurst(const QVector<MultimeterService::TimedReading> &readings)
+{
+    const BurstSummary summary = summariseBurst(readings);
+    const qint64 start = (readings.isEmpty()) ? 0 : readings.constFirst().timestamp;
+    const auto elapsed = [start](const MultimeterService::TimedReading &timed) {
+        return (timed.timestamp - start) / 1'000'000.0;
+    };
+    const QString unit = (readings.isEmpty()) ? QString() : toUnit(readings.constFirst().reading.mode);
+    const auto toString = [](const double value, const char numberFormat = 'g', const int precision = 6) {
+        return qIsNaN(value) ? tr("N/A") : QString::number(value, numberFormat, precision);
+    };
+
+    switch (format) {
+    case OutputFormat::Csv:
+        output(tr("elapsed_ms,mode,value,unit,status,range\n"));
+        for (const MultimeterService::TimedReading &timed: readings) {
+            const MultimeterService::Reading &reading = timed.reading;
+            appendNumber(outputBuffer, elapsed(timed), 'f', 3);
+            outputBuffer.append(',');
+            MeasurementFormatter::appendCsv(outputBuffer,
+                formatter.context((quint8)reading.mode, reading.range, (quint8)reading.status), QByteArray(),
+                reading.value);
+        }
+        qCInfo(lc).noquote() << tr("Captured %Ln reading/s in %1ms; intervals %2ms mean, %3ms jitter, %4ms max.",
+            nullptr, summary.count).arg(toString(summary.duration, 'f', 3), toString(summary.meanInterval, 'f', 3),
+            toString(summary.intervalJitter, 'f', 3), toString(summary.maxInterval, 'f', 3));
+        qCInfo(lc).noquote() << tr("Minimum %1, maximum %2, mean %3, standard deviation %4 %5 (%Ln error/s).",
+            nullptr, summary.errors).arg(toString(summary.minimum), toString(summary.maximum),
+            toString(summary.mean), toString(summary.stddev), unit);
+        break;
+    case OutputFormat::Json: {
+        QJsonArray array;
+        for (const MultimeterService::TimedReading &timed: readings) {
+            const MultimeterService::Reading &reading = timed.reading;
+            const MeasurementFormatter::Context &context =
+                formatter.context((quint8)reading.mode, reading.range, (quint8)reading.status);
+            QJsonObject object{
+                { u"elapsed_ms"_s, elapsed(timed) },
+                { u"status"_s, context.status },
+                { u"value"_s, qIsInf(reading.value) ? QJsonValue(tr("Infinity")) : QJsonValue(reading.value) },
+                { u"mode"_s,   context.mode },
+            };
+            if (!context.unit.isNull()) {
+                object.insert(u"unit"_s, context.unit);
+            }
+            if (!context.range.isNull()) {
+                object.insert(u"range"_s, context.range);
+            }
+            array.append(object);
+        }
+        QJsonObject object{
+            { u"count"_s,       summary.count },
+            { u"errors"_s,      summary.errors },
+            { u"duration_ms"_s, summary.duration },
+        };
+        for (const auto &[key, value]: { std::pair(u"interval_mean_ms"_s, summary.meanInterval),
+                                         std::pair(u"interval_jitter_ms"_s, summary.intervalJitter),
+                                         std::pair(u"interval_max_ms"_s, summary.maxInterval),
+                                         std::pair(u"minimum"_s, summary.minimum),
+                                         std::pair(u"maximum"_s, summary.maximum),
+                                         std::pair(u"mean"_s, summary.mean),
+                                         std::pair(u"stddev"_s, summary.stddev) }) {
+            if (!qIsNaN(value)) {
+                object.insert(key, qIsInf(value) ? QJsonValue(tr("Infinity")) : QJsonValue(value));
+            }
+        }
+        if (!unit.isNull()) {
+            object.insert(u"unit"_s, unit);
+        }
+        output(QJsonDocument(QJsonObject{ { u"readings"_s, array }, { u"summary"_s, object } }).toJson());
+    }   break;
+    case OutputFormat::Arrow:          // Not supported (rejected by processOptions).
+    case OutputFormat::LineProtocol:   // Not supported (rejected by processOptions).
+    case OutputFormat::Binary:         // Not supported (rejected by processOptions).
+    case OutputFormat::Ndjson:         // Not supported (rejected by processOptions).
+    case OutputFormat::NdjsonEnvelope: // Not supported (rejected by processOptions).
+    case OutputFormat::Text: {
+        QString text;
+        for (const MultimeterService::TimedReading &timed: readings) {
+            const MultimeterService::Reading &reading = timed.reading;
+            text += tr("Elapsed: %1ms\n").arg(elapsed(timed), 0, 'f', 3) + MeasurementFormatter::formatText(
+                formatter.context((quint8)reading.mode, reading.range, (quint8)reading.status), QString(),
+                reading.value);
+        }
+        const QString suffix = (unit.isNull()) ? QString() : (u' ' + unit);
+        text += tr("Readings: %1 (%Ln error/s)\n", nullptr, summary.errors).arg(summary.count);
+        text += tr("Duration: %1ms\n").arg(toString(summary.duration, 'f', 3));
+        text += tr("Interval: %1ms mean, %2ms jitter, %3ms max\n").arg(toString(summary.meanInterval, 'f', 3),
+            toString(summary.intervalJitter, 'f', 3), toString(summary.maxInterval, 'f', 3));
+        for (const auto &[label, value]: { std::pair(tr("Minimum:  %1\n"), summary.minimum),
+                                           std::pair(tr("Maximum:  %1\n"), summary.maximum),
+                                           std::pair(tr("Mean:     %1\n"), summary.mean),
+                                           std::pair(tr("Std dev:  %1\n"), summary.stddev) }) {
+            text += label.arg(qIsNaN(value) ? tr("N/A") : (toString(value) + suffix));
+        }
+        output(text);
+    }   break;
     }
+    outputBatchComplete();
+    if (device) disconnect(); // Will exit the application once disconnected.
 }
@@ -1,43 +1,117 @@
 // SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#ifndef DOKIT_METERCOMMAND_H
+#define DOKIT_METERCOMMAND_H
+
 #include "devicecommand.h"
+#include "measurementformatter.h"
+#include "mqttpublisher.h"
 
+#include <qtpokit/batterypolicy.h>
+#include <qtpokit/meteraggregator.h>
+#include <qtpokit/meterdeadband.h>
+#include <qtpokit/meterhistory.h>
+#include <qtpokit/meterscheduler.h>
+#include <qtpokit/metersettler.h>
 #include <qtpokit/multimeterservice.h>
 #include <qtpokit/pokitmeter.h>
 #include <qtpokit/pokitpro.h>
+#include <qtpokit/sharedsamplering.h>
+
+class QTimer;
 
 class MeterCommand : public DeviceCommand
 {
     Q_OBJECT
 
 public:
+    /// Function for converting a range option value to a Pokit product's range enumerator.
+    typedef quint8 (* MinRangeFunc)(const PokitProduct product, const quint32 maxValue);
+
     explicit MeterCommand(QObject * const parent = nullptr);
 
     QStringList requiredOptions(const QCommandLineParser &parser) const override;
     QStringList supportedOptions(const QCommandLineParser &parser) const override;
 
+    static MultimeterService::Mode parseMode(const QString &value, MinRangeFunc &rangeFunc);
+    static quint32 parseRange(const QString &value, const MultimeterService::Mode mode);
+
+    /// Summary statistics of a burst of readings, as captured via \c --burst. Intervals are in milliseconds.
+    struct BurstSummary {
+        int count { 0 };                   ///< Number of readings in the burst.
+        int errors { 0 };                  ///< Number of error readings, excluded from the value statistics.
+        double duration { 0.0 };           ///< Time from the first reading to the last.
+        double meanInterval { qQNaN() };   ///< Mean time between consecutive readings.
+        double intervalJitter { qQNaN() }; ///< Standard deviation of the time between consecutive readings.
+        double maxInterval { qQNaN() };    ///< Longest time between consecutive readings.
+        double minimum { qQNaN() };        ///< Minimum reading value.
+        double maximum { qQNaN() };        ///< Maximum reading value.
+        double mean { qQNaN() };           ///< Mean reading value.
+        double stddev { qQNaN() };         ///< Standard deviation of the reading values.
+    };
+    static BurstSummary summariseBurst(const MeterHistory &history);
+    static BurstSummary summariseBurst(const QVector<MultimeterService::TimedReading> &readings);
+
+    static QString toStatus(const MultimeterService::MeterStatus status, const MultimeterService::Mode mode);
+    static QString toUnit(const MultimeterService::Mode mode);
+
 public slots:
     QStringList processOptions(const QCommandLineParser &parser) override;
 
 protected:
+    bool supportsArrowOutput() const override;
+    bool supportsBinaryOutput() const override;
+    bool supportsLineProtocolOutput() const override;
+    bool supportsNdjsonOutput() const override;
     AbstractPokitService * getService() override;
 
 protected slots:
     void serviceDetailsDiscovered() override;
 
 private:
-    quint8 (* minRangeFunc)(const PokitProduct product, const quint32 maxValue) { nullptr };
+    MinRangeFunc minRangeFunc { nullptr };
     quint32 rangeOptionValue { 0 };          ///< The parsed value of range option, if one was supplied.
     MultimeterService * service { nullptr }; ///< Bluetooth service this command interacts with.
     MultimeterService::Settings settings     ///< Settings for the Pokit device's multimeter mode.
         { MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::AutoRange, 1000 };
     int samplesToGo { -1 } ;     ///< Number of samples to read, if specified on the CLI.
+    int burstCount { 0 };        ///< Number of readings to capture to memory, then output together, or 0 for none.
     bool showCsvHeader { true }; ///< Whether or not to show a header as the first line of CSV output.
+    bool showBinaryHeader { true }; ///< Whether or not to write a header before the first Binary record.
+    quint32 aggregatePeriod { 0 }; ///< Aggregation window length in milliseconds, or 0 to output every reading.
+    quint32 aggregateStep { 0 };   ///< Aggregation window step in milliseconds, or 0 for fixed windows.
+    MeterAggregator * aggregator { nullptr }; ///< Windowed aggregation of readings, if #aggregatePeriod is non-zero.
+    MeterDeadband * deadband { nullptr };     ///< Change-only filtering of readings, if requested.
+    MeterSettler * settler { nullptr };       ///< Discarding of transitional readings, if requested.
+    QVector<MeterScheduler::Entry> schedule;  ///< Modes to measure round-robin, if more than one was requested.
+    quint32 dwellTime { 10000 };              ///< Time to spend measuring each scheduled mode, in milliseconds.
+    MeterScheduler * scheduler { nullptr };   ///< Round-robin measurement of the #schedule, if not empty.
+    SharedSampleRing * ring { nullptr };      ///< Shared memory to publish readings to, if requested.
+    quint32 batterySaverInterval { 0 };       ///< Longest interval to back off to on low battery, or 0 if disabled.
+    float conserveVoltage { 3.5f };           ///< Battery voltage below which to begin conserving power.
+    float criticalVoltage { 3.3f };           ///< Battery voltage below which to conserve as much power as possible.
+    BatteryPolicy * batteryPolicy { nullptr }; ///< Battery-aware adaptation of the update interval, if requested.
+    QTimer * statusTimer { nullptr };         ///< Periodically refreshes the device's status for #batteryPolicy.
+    bool settingsRequested { false };         ///< Whether the multimeter settings have been written (or scheduled).
+    bool loggingSuggested { false };          ///< Whether on-device logging has already been suggested.
+    MqttPublisher * mqtt { nullptr };         ///< MQTT broker to publish readings to, if requested.
+    QString mqttTopic;                        ///< MQTT topic to publish readings to, once the device is known.
+    MeasurementFormatter formatter {          ///< Resolved (and cached) labels and fields, per mode, range and status.
+        [this](const quint8 mode, const quint8 range, const quint8 status) {
+            return resolveContext(mode, range, status); } };
+
+    MeasurementFormatter::Context resolveContext(const quint8 mode, const quint8 range, const quint8 status) const;
 
 private slots:
     void settingsWritten();
+    void batteryDecisionChanged(const BatteryPolicy::Decision &decision);
+    void entryStarted(const int index, const qint64 latency);
     void outputReading(const MultimeterService::Reading &reading);
+    void outputWindow(const MeterAggregator::Window &window);
+    void outputBurst(const QVector<MultimeterService::TimedReading> &readings);
 
     QTPOKIT_BEFRIEND_TEST(MeterCommand)
 };
+
+#endif // DOKIT_METERCOMMAND_H
@@ -0,0 +1,773 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "meterfleetcommand.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/pokitmeter.h>
+#include <qtpokit/pokitproducts.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+// Qt 6.5.0 added new QDateTime::fromSecsSinceEpoch() and fromMSecsSinceEpoch()
+// overloads, then Qt 6.6.0 deprecated some of of the older ones.
+#if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
+    #define DOKIT_QT_UTC Qt::UTC
+#else
+    #include <QTimeZone>
+    #define DOKIT_QT_UTC QTimeZone::UTC
+#endif
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class MeterFleetCommand
+ *
+ * The MeterFleetCommand class implements the `meter-fleet` CLI command.
+ *
+ * Unlike `meter`, which reads from a single device, this command reads the multimeter from each of the devices given
+ * via `--device` (and/or listed in a `--device-list` file), all from the one event loop, connecting to up to
+ * `--max-connections` devices concurrently. Readings from all devices are output as a single stream, in order of
+ * arrival, with each reading timestamped, and tagged with its source device (as requested).
+ *
+ * Since meter readings are streamed for as long as a device remains connected, devices beyond the connection limit
+ * wait until an earlier device finishes (that is, reaches its `--samples` count, or disconnects, or fails).
+ *
+ * By default, readings are timestamped with their time of arrival, which includes some milliseconds of BLE latency
+ * that varies from reading to reading, and device to device. With `--align`, each device's readings are instead
+ * placed on a common timeline by a ClockAligner, from each device's own reading interval.
+ *
+ * With `--power`, exactly two devices are read: the first measuring DC voltage, and the second DC current (of the
+ * same circuit). Their aligned readings are then joined by a PowerIntegrator, and the derived power, energy and
+ * charge are output instead of the individual readings.
+ *
+ * With `--resample`, every device's readings are instead resampled by a Resampler onto a common grid of times (at the
+ * given period), and output as a single, wide table, with one row per grid time, and one column per device. Readings
+ * are linearly interpolated by default, or held, or decimated (ie averaged), according to `--resample-method`.
+ *
+ * With `--workers`, readings are formatted by a ShardedWorkerPool, sharded by device, instead of on the event loop's
+ * thread, so formatting the readings of many devices is spread across cores. Each device's readings are still output
+ * in order, but readings from different devices may be output in a (slightly) different order than they arrived.
+ */
+
+/*!
+ * Construct a new MeterFleetCommand object with \a parent.
+ */
+MeterFleetCommand::MeterFleetCommand(QObject * const parent) : AbstractCommand(parent)
+{
+
+}
+
+QStringList MeterFleetCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    // The power option implies each device's mode, so the mode option is only required without it.
+    return AbstractCommand::requiredOptions(parser) + ((parser.optionNames().contains(u"power"_s))
+        ? QStringList{} : QStringList{ u"mode"_s });
+}
+
+QStringList MeterFleetCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"align"_s,
+        u"device-list"_s,
+        u"interval"_s,
+        u"max-connections"_s,
+        u"power"_s,
+        u"range"_s,
+        u"resample"_s,
+        u"resample-method"_s,
+        u"samples"_s,
+        u"time-format"_s,
+        u"workers"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList MeterFleetCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    alignTimestamps = parser.isSet(u"align"_s);
+
+    // Parse the device and device-list options, either (or both) of which may list multiple devices.
+    QStringList devices = parser.values(u"device"_s);
+    if (parser.isSet(u"device-list"_s)) {
+        QFile file(parser.value(u"device-list"_s));
+        if (file.open(QIODevice::ReadOnly|QIODevice::Text)) {
+            devices.append(readDeviceList(file));
+        } else {
+            errors.append(tr("Failed to open device list %1: %2").arg(file.fileName(), file.errorString()));
+        }
+    }
+    devices = parseDeviceList(devices);
+    meters.clear();
+    for (const QString &deviceName: devices) {
+        meters.append(Meter{ deviceName });
+    }
+    devicesToScanFor = devices;
+    if ((meters.isEmpty()) && (errors.isEmpty())) {
+        errors.append(tr("No devices to read"));
+    }
+
+    // Parse the power option, which implies each device's mode, or otherwise, the (required) mode option.
+    delete powerIntegrator;
+    powerIntegrator = nullptr;
+    if (parser.isSet(u"power"_s)) {
+        if (parser.isSet(u"mode"_s)) {
+            errors.append(tr("The power option cannot be combined with the mode option"));
+        }
+        if ((!meters.isEmpty()) && (meters.size() != 2)) {
+            errors.append(tr("The power option requires exactly two devices: voltage, then current"));
+        }
+        powerIntegrator = new PowerIntegrator(this);
+        connect(powerIntegrator, &PowerIntegrator::resultReady, this, &MeterFleetCommand::outputPower);
+        alignTimestamps = true; // The two devices' readings can only be joined on a common timeline.
+        minRangeFunc = nullptr;
+    } else {
+        const QString mode = parser.value(u"mode"_s);
+        settings.mode = MeterCommand::parseMode(mode, minRangeFunc);
+        if (settings.mode == MultimeterService::Mode::Idle) {
+            errors.append(tr("Unknown meter mode: %1").arg(mode));
+            return errors;
+        }
+    }
+
+    // Parse the interval option.
+    if (parser.isSet(u"interval"_s)) {
+        const QString value = parser.value(u"interval"_s);
+        const quint32 interval = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (interval == 0) {
+            errors.append(tr("Invalid interval value: %1").arg(value));
+        } else {
+            settings.updateInterval = interval;
+        }
+    }
+    if (powerIntegrator) {
+        // Don't interpolate, or integrate, across more than a couple of missed readings.
+        powerIntegrator->setMaximumGap(3 * settings.updateInterval);
+    }
+
+    // Parse the resample and resample-method options.
+    delete resampler;
+    resampler = nullptr;
+    if (parser.isSet(u"resample"_s)) {
+        const QString value = parser.value(u"resample"_s);
+        const quint32 period = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (period == 0) {
+            errors.append(tr("Invalid resample value: %1").arg(value));
+        } else if (powerIntegrator) {
+            errors.append(tr("The resample option cannot be combined with the power option"));
+        } else {
+            resampler = new Resampler((int)meters.size(), this);
+            resampler->setPeriod(period);
+            // Don't interpolate, or hold, across more than a couple of missed readings.
+            resampler->setMaximumGap(3 * settings.updateInterval);
+            connect(resampler, &Resampler::rowReady, this, &MeterFleetCommand::outputRow);
+        }
+    }
+    if (parser.isSet(u"resample-method"_s)) {
+        const QString value = parser.value(u"resample-method"_s).trimmed().toLower();
+        if (!parser.isSet(u"resample"_s)) {
+            errors.append(tr("The resample-method option requires the resample option"));
+        } else if (value == u"linear"_s) {
+            if (resampler) resampler->setMethod(Resampler::Method::Linear);
+        } else if (value == u"hold"_s) {
+            if (resampler) resampler->setMethod(Resampler::Method::Hold);
+        } else if (value == u"decimate"_s) {
+            if (resampler) resampler->setMethod(Resampler::Method::Decimate);
+        } else {
+            errors.append(tr("Unknown resample method: %1").arg(parser.value(u"resample-method"_s)));
+        }
+    }
+
+    // Parse the max-connections option.
+    if (parser.isSet(u"max-connections"_s)) {
+        const QString value = parser.value(u"max-connections"_s);
+        bool ok;
+        const int connections = value.toInt(&ok);
+        if ((!ok) || (connections <= 0)) {
+            errors.append(tr("Invalid max-connections value: %1").arg(value));
+        } else {
+            maxConnections = connections;
+        }
+    }
+
+    // Parse the range option.
+    rangeOptionValue = 0; // Default to auto.
+    if (parser.isSet(u"range"_s)) {
+        const QString value = parser.value(u"range"_s);
+        if (value.trimmed().compare(u"auto"_s, Qt::CaseInsensitive) != 0) {
+            if (powerIntegrator) {
+                errors.append(tr("The power option only supports the auto range"));
+            } else {
+                rangeOptionValue = MeterCommand::parseRange(value, settings.mode);
+                if ((minRangeFunc != nullptr) && (rangeOptionValue == 0)) {
+                    errors.append(tr("Invalid range value: %1").arg(value));
+                }
+            }
+        }
+    }
+
+    // Parse the samples option.
+    if (parser.isSet(u"samples"_s)) {
+        const QString value = parser.value(u"samples"_s);
+        const quint32 samples = parseNumber<std::ratio<1>>(value, u"S"_s);
+        if (samples == 0) {
+            errors.append(tr("Invalid samples value: %1").arg(value));
+        } else for (Meter &meter: meters) {
+            meter.samplesToGo = samples;
+        }
+    }
+
+    // Parse the time format option.
+    if (parser.isSet(u"time-format"_s)) {
+        const QString timeFormat = parser.value(u"time-format"_s).trimmed().toLower();
+        if (timeFormat == u"iso"_s) {
+            epochTimestamps = false;
+        } else if (timeFormat == u"epoch"_s) {
+            epochTimestamps = true;
+        } else {
+            errors.append(tr("Unknown time format: %1").arg(parser.value(u"time-format"_s)));
+        }
+    }
+
+    // Parse the workers option.
+    delete workers;
+    workers = nullptr;
+    if (parser.isSet(u"workers"_s)) {
+        const QString value = parser.value(u"workers"_s).trimmed();
+        bool ok = (value.compare(u"auto"_s, Qt::CaseInsensitive) == 0);
+        const int threads = (ok) ? 0 : value.toInt(&ok); // 0 for one thread per core.
+        if ((!ok) || (threads < 0)) {
+            errors.append(tr("Invalid workers value: %1").arg(parser.value(u"workers"_s)));
+        } else if ((powerIntegrator) || (resampler)) {
+            errors.append(tr("The workers option cannot be combined with the power or resample options"));
+        } else {
+            workers = new ShardedWorkerPool(threads, this);
+            connect(workers, &ShardedWorkerPool::outputReady, this, &MeterFleetCommand::outputFormatted);
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Begins scanning for the requested Pokit devices.
+ */
+bool MeterFleetCommand::start()
+{
+    qCInfo(lc).noquote() << tr("Looking for %Ln Pokit device/s...", nullptr, meters.size());
+    discoveryAgent->start();
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonOutput
+ *
+ * This override returns \c true, since fleet readings may be streamed indefinitely.
+ */
+bool MeterFleetCommand::supportsNdjsonOutput() const
+{
+    return true;
+}
+
+/*!
+ * Checks if \a info is one of the (not yet discovered) devices to read, and if so, creates a device and service for
+ * it, and queues it for connection.
+ *
+ * Discovery continues until all requested devices have been discovered (see AbstractCommand::takeDevice()), so that
+ * devices may be read while others are still being discovered.
+ */
+void MeterFleetCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_ASSERT(isPokitProduct(info));
+
+    const QString deviceName = takeDevice(info);
+    const auto iter = std::find_if(meters.begin(), meters.end(), [&deviceName](const Meter &meter) {
+        return (!deviceName.isNull()) && (meter.deviceName == deviceName);
+    });
+    if (iter == meters.end()) {
+        qCDebug(lc).noquote() << tr(R"(Ignoring non-requested Pokit device "%1" (%2) at (%3).)")
+            .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+        return;
+    }
+
+    const int index = (int)(iter - meters.begin());
+    qCDebug(lc).noquote() << tr(R"(Found Pokit device "%1" (%2) at (%3).)")
+        .arg(info.name(), info.deviceUuid().toString(), info.address().toString());
+    Meter &meter = *iter;
+    meter.device = new PokitDevice(info, this);
+    meter.service = meter.device->multimeter();
+    Q_ASSERT(meter.service);
+    meter.service->setPokitProduct(pokitProduct(info));
+
+    const QLowEnergyController * const controller = meter.device->controller();
+    connect(controller, &QLowEnergyController::disconnected, this, [this, index]() {
+        finishMeter(index, meters.at(index).samplesToGo != 0); // Ie failed if disconnected before all readings.
+    });
+    connect(controller,
+        #if (QT_VERSION < QT_VERSION_CHECK(6, 2, 0))
+        QOverload<QLowEnergyController::Error>::of(&QLowEnergyController::error),
+        #else
+        &QLowEnergyController::errorOccurred,
+        #endif
+        this, [this, index](const QLowEnergyController::Error error) {
+            qCWarning(lc).noquote() << tr(R"(Bluetooth controller error for device "%1":)")
+                .arg(meters.at(index).deviceName) << error;
+            finishMeter(index, true);
+        }, Qt::QueuedConnection);
+    connect(meter.service, &AbstractPokitService::serviceDetailsDiscovered, this, [this, index]() {
+        configureMeter(index);
+    });
+    connect(meter.service, &AbstractPokitService::serviceErrorOccurred,
+        this, [this, index](const QLowEnergyService::ServiceError error) {
+            qCWarning(lc).noquote() << tr(R"(Bluetooth service error for device "%1":)")
+                .arg(meters.at(index).deviceName) << error;
+            finishMeter(index, true);
+        });
+    connect(meter.service, &MultimeterService::settingsWritten, this, [this, index]() { settingsWritten(index); });
+
+    pending.append(index);
+    if (devicesToScanFor.isEmpty()) {
+        discoveryFinished = true; // takeDevice() has stopped discovery, since all requested devices were found.
+    }
+    connectPending();
+}
+
+/*!
+ * Reports any requested devices that were not discovered, and exits once all others have finished too.
+ */
+void MeterFleetCommand::deviceDiscoveryFinished()
+{
+    discoveryFinished = true;
+    for (Meter &meter: meters) {
+        if (!meter.device) {
+            qCWarning(lc).noquote() << tr(R"(Failed to find device "%1".)").arg(meter.deviceName);
+            meter.finished = meter.failed = true;
+        }
+    }
+    checkComplete();
+}
+
+/*!
+ * Begins connecting to pending devices, until either there are no more pending devices, or the maximum number of
+ * concurrent connections has been reached.
+ */
+void MeterFleetCommand::connectPending()
+{
+    while ((activeConnections < maxConnections) && (!pending.isEmpty())) {
+        Meter &meter = meters[pending.takeFirst()];
+        Q_ASSERT(meter.device);
+        Q_ASSERT(!meter.connected);
+        meter.connected = true;
+        ++activeConnections;
+        qCDebug(lc).noquote() << tr(R"(Connecting to device "%1" (%2 of %3 connections).)")
+            .arg(meter.deviceName).arg(activeConnections).arg(maxConnections);
+        meter.device->controller()->connectToDevice();
+    }
+}
+
+/*!
+ * Writes the multimeter settings to the device at \a index, once its service details have been discovered. The
+ * range is resolved per device, since each device may be a different Pokit product.
+ *
+ * When deriving power, the first device measures DC voltage, and the second DC current, both auto-ranged.
+ */
+void MeterFleetCommand::configureMeter(const int index)
+{
+    MultimeterService * const service = meters.at(index).service;
+    MultimeterService::Settings deviceSettings = settings;
+    if (powerIntegrator) {
+        deviceSettings.mode = (index == 0) ? MultimeterService::Mode::DcVoltage : MultimeterService::Mode::DcCurrent;
+        deviceSettings.range = +PokitMeter::VoltageRange::AutoRange; // All products' AutoRange values are the same.
+    } else {
+        deviceSettings.range = (minRangeFunc == nullptr) ? 0
+            : minRangeFunc(*service->pokitProduct(), rangeOptionValue);
+    }
+    const QString range = service->toString(deviceSettings.range, deviceSettings.mode);
+    qCInfo(lc).noquote() << tr(R"(Measuring %1 on device "%2", with range %3, every %L4ms.)").arg(
+        MultimeterService::toString(deviceSettings.mode), meters.at(index).deviceName,
+        (range.isNull()) ? QString::fromLatin1("N/A") : range).arg(deviceSettings.updateInterval);
+    service->setSettings(deviceSettings);
+}
+
+/*!
+ * Invoked when the multimeter settings have been written to the device at \a index, to begin reading its values.
+ */
+void MeterFleetCommand::settingsWritten(const int index)
+{
+    MultimeterService * const service = meters.at(index).service;
+    qCDebug(lc).noquote() << tr(R"(Settings written; starting meter readings from device "%1"...)")
+        .arg(meters.at(index).deviceName);
+    connect(service, &MultimeterService::readingRead, this,
+            [this, index](const MultimeterService::Reading &reading) {
+                outputReading(index, reading, readingTimestamp(index));
+            },
+            Qt::UniqueConnection);
+    service->enableReadingNotifications();
+}
+
+/*!
+ * Marks the device at \a index as finished (or \a failed), freeing its connection for the next pending device.
+ */
+void MeterFleetCommand::finishMeter(const int index, const bool failed)
+{
+    Meter &meter = meters[index];
+    if (meter.finished) {
+        return; // Already finished, such as by a controller error before disconnecting.
+    }
+    meter.finished = true;
+    meter.failed = failed;
+    if (failed) {
+        qCWarning(lc).noquote() << tr(R"(Failed to read all meter readings from device "%1".)")
+            .arg(meter.deviceName);
+    }
+    if ((meter.device) && (meter.device->controller()->state() != QLowEnergyController::UnconnectedState)) {
+        meter.device->disconnectFromDevice(); // Free the connection for other devices.
+    }
+    if (meter.connected) {
+        --activeConnections;
+    }
+    connectPending();
+    checkComplete();
+}
+
+/*!
+ * Exits, once all requested devices have either finished, or failed.
+ */
+void MeterFleetCommand::checkComplete()
+{
+    if ((exiting) || (!discoveryFinished) ||
+        (!std::all_of(meters.cbegin(), meters.cend(), [](const Meter &meter){ return meter.finished; })))
+    {
+        return;
+    }
+    exiting = true;
+    if (workers) {
+        workers->flush(); // Output the readings still being formatted.
+    }
+    if (resampler) {
+        resampler->flush(); // Output the remaining rows, as far as the last device's readings.
+    }
+    const bool failed = std::any_of(meters.cbegin(), meters.cend(), [](const Meter &meter){ return meter.failed; });
+    QCoreApplication::exit((failed) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*!
+ * Returns the timestamp, in milliseconds since the epoch, for a reading just received from the device at \a index.
+ * That is, either its time of arrival, or if aligning timestamps, the time of arrival the device's own clock implies.
+ */
+qint64 MeterFleetCommand::readingTimestamp(const int index)
+{
+    if (!alignTimestamps) {
+        return QDateTime::currentMSecsSinceEpoch();
+    }
+    Meter &meter = meters[index];
+    const qint64 deviceTime = (meter.readings++) * (qint64)settings.updateInterval;
+    aligner.addObservation(meter.deviceName, deviceTime);
+    return aligner.toHostTime(meter.deviceName, deviceTime);
+}
+
+/*!
+ * Returns the \a msecs timestamp formatted according to the selected time format; that is, either as epoch
+ * milliseconds, or an ISO 8601 UTC date and time.
+ */
+QByteArray MeterFleetCommand::formatTimestamp(const qint64 msecs) const
+{
+    return formatTimestamp(msecs, epochTimestamps);
+}
+
+/*!
+ * Returns the \a msecs timestamp formatted as epoch milliseconds if \a epoch is \c true, otherwise as an ISO 8601 UTC
+ * date and time.
+ *
+ * \overload
+ */
+QByteArray MeterFleetCommand::formatTimestamp(const qint64 msecs, const bool epoch)
+{
+    return (epoch) ? QByteArray::number(msecs)
+        : QDateTime::fromMSecsSinceEpoch(msecs, DOKIT_QT_UTC).toString(Qt::ISODateWithMs).toLatin1();
+}
+
+/*!
+ * Outputs meter \a reading, from the device at \a index, in the selected output format, tagged with the device, and
+ * \a timestamp (the time of its arrival, in milliseconds since the epoch).
+ */
+void MeterFleetCommand::outputReading(const int index, const MultimeterService::Reading &reading,
+                                      const qint64 timestamp)
+{
+    Meter &meter = meters[index];
+    if ((meter.finished) || (meter.samplesToGo == 0)) {
+        return; // Already read all requested samples, and waiting to disconnect.
+    }
+
+    if (powerIntegrator) {
+        // Join the reading with the other device's, instead of outputting it; see outputPower().
+        if (reading.status != MultimeterService::MeterStatus::Error) {
+            if (index == 0) {
+                powerIntegrator->addVoltage(reading.value, timestamp);
+            } else {
+                powerIntegrator->addCurrent(reading.value, timestamp);
+            }
+        }
+        countReading(index);
+        return;
+    }
+
+    if (resampler) {
+        // Resample the reading onto the common grid, instead of outputting it; see outputRow().
+        if (reading.status != MultimeterService::MeterStatus::Error) {
+            resampler->addSample(index, reading.value, timestamp);
+        }
+        countReading(index);
+        return;
+    }
+
+    for (; (format == OutputFormat::Csv) && (showCsvHeader); showCsvHeader = false) {
+        output(tr("timestamp,device,mode,value,unit,status,range\n"));
+    }
+    const QString range = (meter.service) ? meter.service->toString(reading.range, reading.mode) : QString();
+    if (workers) {
+        // Format on the device's own worker, so in order; the output is delivered back via outputFormatted().
+        workers->submit(index, [format = format, epoch = epochTimestamps, deviceName = meter.deviceName, reading,
+                                timestamp, range]() {
+            return formatReading(format, epoch, deviceName, reading, timestamp, range);
+        });
+    } else {
+        output(formatReading(format, epochTimestamps, meter.deviceName, reading, timestamp, range));
+        outputBatchComplete();
+    }
+    countReading(index);
+}
+
+/*!
+ * Returns meter \a reading, from device \a deviceName, formatted in output \a format, tagged with the device, and
+ * \a timestamp (in milliseconds since the epoch), as epoch milliseconds if \a epochTimestamps, otherwise ISO 8601.
+ * The \a range is the reading's range label, if any.
+ *
+ * This function touches no command state, so may be invoked on any thread, such as by #workers.
+ */
+QByteArray MeterFleetCommand::formatReading(const OutputFormat format, const bool epochTimestamps,
+                                            const QString &deviceName, const MultimeterService::Reading &reading,
+                                            const qint64 timestamp, const QString &range)
+{
+    const QByteArray timeString = formatTimestamp(timestamp, epochTimestamps);
+    const QString status = MeterCommand::toStatus(reading.status, reading.mode);
+    const QString unit = MeterCommand::toUnit(reading.mode);
+
+    switch (format) {
+    case OutputFormat::Csv:
+        return (QString::fromLatin1(timeString) + u',' + escapeCsvField(deviceName) + u',' +
+                escapeCsvField(MultimeterService::toString(reading.mode)) + u',' +
+                QString::number(reading.value, 'f') + u',' + unit + u',' + status + u',' + escapeCsvField(range) +
+                u'\n').toUtf8();
+    case OutputFormat::Json: {
+        QJsonObject object{
+            { u"timestamp"_s, (epochTimestamps) ? QJsonValue(timestamp)
+                                                : QJsonValue(QString::fromLatin1(timeString)) },
+            { u"device"_s, deviceName },
+            { u"status"_s, status },
+            { u"value"_s, qIsInf(reading.value) ?
+                QJsonValue(tr("Infinity")) : QJsonValue(reading.value) },
+            { u"mode"_s,   MultimeterService::toString(reading.mode) },
+        };
+        if (!unit.isNull()) {
+            object.insert(u"unit"_s, unit);
+        }
+        if (!range.isNull()) {
+            object.insert(u"range"_s, range);
+        }
+        return QJsonDocument(object).toJson();
+    }
+    case OutputFormat::Ndjson: {
+        QByteArray bytes;
+        bytes.append("{\"timestamp\":")
+            .append((epochTimestamps) ? timeString : ('"' + timeString + '"'))
+            .append(",\"device\":").append(escapeJsonString(deviceName))
+            .append(",\"status\":").append(escapeJsonString(status))
+            .append(",\"value\":").append(qIsInf(reading.value) ? escapeJsonString(tr("Infinity"))
+                : formatJsonNumber(reading.value))
+            .append(",\"mode\":").append(escapeJsonString(MultimeterService::toString(reading.mode)));
+        if (!unit.isNull()) {
+            bytes.append(",\"unit\":").append(escapeJsonString(unit));
+        }
+        if (!range.isNull()) {
+            bytes.append(",\"range\":").append(escapeJsonString(range));
+        }
+        return bytes.append("}\n");
+    }
+    case OutputFormat::Arrow:          // Not supported.
+    case OutputFormat::LineProtocol:   // Not supported.
+    case OutputFormat::Binary:         // Not supported.
+    case OutputFormat::NdjsonEnvelope: // Not supported.
+    case OutputFormat::Text:
+        break;
+    }
+    return tr("%1 %2 %3 %4\n").arg(QString::fromLatin1(timeString), deviceName)
+        .arg(reading.value, 0, 'f').arg(unit).toUtf8();
+}
+
+/*!
+ * Outputs \a bytes, formatted by #workers from a reading from the device at \a index.
+ */
+void MeterFleetCommand::outputFormatted(const int index, const QByteArray &bytes)
+{
+    Q_UNUSED(index)
+    output(bytes);
+    outputBatchComplete();
+}
+
+/*!
+ * Outputs the power, energy and charge \a result derived from the voltage and current devices' readings, in the
+ * selected output format.
+ */
+void MeterFleetCommand::outputPower(const PowerIntegrator::Result &result)
+{
+    const QByteArray timeString = formatTimestamp(result.timestamp);
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("timestamp,voltage,current,power,average_power,energy,charge,duration\n"));
+        }
+        output(QString::fromLatin1(timeString) + u',' + QString::number(result.voltage, 'f') + u',' +
+               QString::number(result.current, 'f') + u',' + QString::number(result.power, 'f') + u',' +
+               QString::number(result.averagePower, 'f') + u',' + QString::number(result.energy, 'f', 9) + u',' +
+               QString::number(result.charge, 'f', 9) + u',' + QString::number(result.duration) + u'\n');
+        break;
+    case OutputFormat::Json:
+        output(QJsonDocument(QJsonObject{
+            { u"timestamp"_s, (epochTimestamps) ? QJsonValue(result.timestamp)
+                                                : QJsonValue(QString::fromLatin1(timeString)) },
+            { u"voltage"_s, result.voltage },
+            { u"current"_s, result.current },
+            { u"power"_s, result.power },
+            { u"averagePower"_s, result.averagePower },
+            { u"energy"_s, result.energy },
+            { u"charge"_s, result.charge },
+            { u"duration"_s, result.duration },
+        }).toJson());
+        break;
+    case OutputFormat::Ndjson:
+        outputBuffer.append("{\"timestamp\":")
+            .append((epochTimestamps) ? timeString : ('"' + timeString + '"'))
+            .append(",\"voltage\":").append(formatJsonNumber(result.voltage))
+            .append(",\"current\":").append(formatJsonNumber(result.current))
+            .append(",\"power\":").append(formatJsonNumber(result.power))
+            .append(",\"averagePower\":").append(formatJsonNumber(result.averagePower))
+            .append(",\"energy\":").append(formatJsonNumber(result.energy))
+            .append(",\"charge\":").append(formatJsonNumber(result.charge))
+            .append(",\"duration\":").append(QByteArray::number(result.duration))
+            .append("}\n");
+        break;
+    case OutputFormat::Arrow:          // Not supported.
+    case OutputFormat::LineProtocol:   // Not supported.
+    case OutputFormat::Binary:         // Not supported.
+    case OutputFormat::NdjsonEnvelope: // Not supported.
+    case OutputFormat::Text:
+        output(tr("%1 %2 V %3 A %4 W %5 Wh %6 Ah\n").arg(QString::fromLatin1(timeString))
+            .arg(result.voltage, 0, 'f').arg(result.current, 0, 'f').arg(result.power, 0, 'f')
+            .arg(result.energy, 0, 'f', 9).arg(result.charge, 0, 'f', 9));
+        break;
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Outputs a single row of the resampled table, being one resampled reading per device (in command line order) at
+ * \a timestamp, in the selected output format. Any \a values that could not be resampled (such as while a device
+ * was disconnected) are left empty for CSV, null for JSON, and NaN for text.
+ */
+void MeterFleetCommand::outputRow(const qint64 timestamp, const QVector<float> &values)
+{
+    Q_ASSERT(values.size() == meters.size());
+    const QByteArray timeString = formatTimestamp(timestamp);
+    const QString mode = MultimeterService::toString(settings.mode);
+    const QString unit = MeterCommand::toUnit(settings.mode);
+    switch (format) {
+    case OutputFormat::Csv: {
+        for (; showCsvHeader; showCsvHeader = false) {
+            QString header = tr("timestamp");
+            for (const Meter &meter: std::as_const(meters)) {
+                header += u',' + escapeCsvField(meter.deviceName);
+            }
+            output(header + u'\n');
+        }
+        QString line = QString::fromLatin1(timeString);
+        for (const float value: values) {
+            line += u',' + (qIsNaN(value) ? QString() : QString::number(value, 'f'));
+        }
+        output(line + u'\n');
+    }   break;
+    case OutputFormat::Json: {
+        QJsonObject readings;
+        for (int index = 0; index < values.size(); ++index) {
+            readings.insert(meters.at(index).deviceName, qIsNaN(values.at(index))
+                ? QJsonValue(QJsonValue::Null) : QJsonValue(values.at(index)));
+        }
+        QJsonObject object{
+            { u"timestamp"_s, (epochTimestamps) ? QJsonValue(timestamp)
+                                                : QJsonValue(QString::fromLatin1(timeString)) },
+            { u"mode"_s, mode },
+            { u"values"_s, readings },
+        };
+        if (!unit.isNull()) {
+            object.insert(u"unit"_s, unit);
+        }
+        output(QJsonDocument(object).toJson());
+    }   break;
+    case OutputFormat::Ndjson:
+        outputBuffer.append("{\"timestamp\":")
+            .append((epochTimestamps) ? timeString : ('"' + timeString + '"'))
+            .append(",\"mode\":").append(escapeJsonString(mode))
+            .append(",\"values\":{");
+        for (int index = 0; index < values.size(); ++index) {
+            outputBuffer.append((index == 0) ? "" : ",").append(escapeJsonString(meters.at(index).deviceName))
+                .append(':').append(qIsNaN(values.at(index)) ? QByteArray("null") : formatJsonNumber(values.at(index)));
+        }
+        outputBuffer.append('}');
+        if (!unit.isNull()) {
+            outputBuffer.append(",\"unit\":").append(escapeJsonString(unit));
+        }
+        outputBuffer.append("}\n");
+        break;
+    case OutputFormat::Arrow:          // Not supported.
+    case OutputFormat::LineProtocol:   // Not supported.
+    case OutputFormat::Binary:         // Not supported.
+    case OutputFormat::NdjsonEnvelope: // Not supported.
+    case OutputFormat::Text: {
+        QString line = QString::fromLatin1(timeString);
+        for (const float value: values) {
+            line += u' ' + QString::number(value, 'f');
+        }
+        output(tr("%1 %2\n").arg(line, unit));
+    }   break;
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Counts a reading received from the device at \a index, disconnecting from the device once all requested readings
+ * have been received.
+ */
+void MeterFleetCommand::countReading(const int index)
+{
+    Meter &meter = meters[index];
+    if ((meter.samplesToGo > 0) && (--meter.samplesToGo == 0)) {
+        qCInfo(lc).noquote() << tr(R"(Finished reading from device "%1".)").arg(meter.deviceName);
+        if (meter.device) meter.device->disconnectFromDevice(); // Will finish this device once disconnected.
+    }
+}
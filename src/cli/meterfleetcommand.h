@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+#include "metercommand.h"
+#include "shardedworkerpool.h"
+
+#include <qtpokit/clockaligner.h>
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/powerintegrator.h>
+#include <qtpokit/resampler.h>
+
+#include <QLowEnergyController>
+
+QTPOKIT_FORWARD_DECLARE_CLASS(PokitDevice)
+QTPOKIT_USE_NAMESPACE
+
+class MeterFleetCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit MeterFleetCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected:
+    bool supportsNdjsonOutput() const override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// Progress of the readings from a single requested device.
+    struct Meter {
+        QString deviceName;                      ///< Device, as requested, to tag readings with.
+        PokitDevice * device { nullptr };        ///< Discovered device, or \c nullptr if not (yet) discovered.
+        MultimeterService * service { nullptr }; ///< Discovered device's multimeter service.
+        qint64 samplesToGo { -1 };               ///< Number of readings still to output, or -1 for no limit.
+        qint64 readings { 0 };                   ///< Number of readings received so far.
+        bool connected { false };                ///< Whether a connection to #device has been started.
+        bool finished { false };                 ///< Whether this device has completed (or failed).
+        bool failed { false };                   ///< Whether this device failed.
+    };
+
+    QVector<Meter> meters;       ///< One meter per requested device, in command line order.
+    QVector<int> pending;        ///< Indexes of discovered #meters, waiting for a free connection.
+    int activeConnections { 0 }; ///< Number of devices currently connected, or connecting.
+    int maxConnections { 3 };    ///< Maximum number of concurrent device connections.
+    MeterCommand::MinRangeFunc minRangeFunc { nullptr }; ///< Converts #rangeOptionValue to each product's range.
+    quint32 rangeOptionValue { 0 };    ///< The parsed value of range option, if one was supplied.
+    MultimeterService::Settings settings ///< Settings for every device's multimeter mode.
+        { MultimeterService::Mode::DcVoltage, 0, 1000 };
+    bool alignTimestamps { false };   ///< Whether to timestamp readings via #aligner, instead of their arrival.
+    ClockAligner aligner;             ///< Aligns each device's readings onto a common timeline.
+    PowerIntegrator * powerIntegrator { nullptr }; ///< Derives power from the two devices' readings, if requested.
+    Resampler * resampler { nullptr }; ///< Resamples every device's readings onto a common grid, if requested.
+    ShardedWorkerPool * workers { nullptr }; ///< Formats each device's readings off the event loop, if requested.
+    bool discoveryFinished { false }; ///< Whether device discovery has finished (or been stopped).
+    bool exiting { false };           ///< Whether all devices have finished, and the application is exiting.
+    bool epochTimestamps { false };   ///< Whether to output timestamps as epoch milliseconds, instead of ISO 8601.
+    bool showCsvHeader { true };      ///< Whether or not to show a header as the first line of CSV output.
+
+    void connectPending();
+    void configureMeter(const int index);
+    void settingsWritten(const int index);
+    void finishMeter(const int index, const bool failed);
+    void checkComplete();
+    qint64 readingTimestamp(const int index);
+    QByteArray formatTimestamp(const qint64 msecs) const;
+    static QByteArray formatTimestamp(const qint64 msecs, const bool epoch);
+    void outputReading(const int index, const MultimeterService::Reading &reading, const qint64 timestamp);
+    static QByteArray formatReading(const OutputFormat format, const bool epochTimestamps, const QString &deviceName,
+                                    const MultimeterService::Reading &reading, const qint64 timestamp,
+                                    const QString &range);
+    void outputFormatted(const int index, const QByteArray &bytes);
+    void outputPower(const PowerIntegrator::Result &result);
+    void outputRow(const qint64 timestamp, const QVector<float> &values);
+    void countReading(const int index);
+
+    QTPOKIT_BEFRIEND_TEST(MeterFleetCommand)
+};
@@ -0,0 +1,713 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "mqttpublisher.h"
+#include "abstractcommand.h"
+#include "../stringliterals_p.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrlQuery>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <ratio>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class MqttPublisher
+ *
+ * The MqttPublisher class publishes batches of meter readings, and DSO samples, to an MQTT broker.
+ *
+ * Values are appended to a per-topic batch, which is closed (and queued for publishing as a single message) once its
+ * payload reaches a size limit, or once it has been open for a time limit, whichever comes first. So brokers receive a
+ * bounded number of messages per second, no matter how fast values arrive.
+ *
+ * Queued messages are held in an in-memory spill buffer until they have been written to the broker (or, for QoS 1,
+ * acknowledged by it), so that values are not lost while the broker is briefly unreachable. If the buffer fills up,
+ * the oldest unsent messages are discarded. Lost connections are re-established automatically, with backoff.
+ *
+ * Since all network I/O is asynchronous (via the Qt event loop), and publish() only appends to an in-memory batch,
+ * the acquisition of values never blocks on the broker.
+ *
+ * Only the subset of MQTT 3.1.1 used for publishing (with QoS 0 or 1, and clean sessions) is implemented, over plain
+ * TCP, so that no additional dependencies are required.
+ */
+
+/*!
+ * Constructs a new MQTT publisher with \a parent. Call setUrl() to configure the publisher, then start() to connect.
+ */
+MqttPublisher::MqttPublisher(QObject * const parent) : QObject(parent),
+    clientId(u"dokit-%1"_s.arg(QCoreApplication::applicationPid())), topicPrefix(u"dokit"_s),
+    socket(new QTcpSocket(this)), batchTimer(new QTimer(this)), reconnectTimer(new QTimer(this)),
+    keepAliveTimer(new QTimer(this))
+{
+    batchTimer->setSingleShot(true);
+    reconnectTimer->setSingleShot(true);
+    connect(batchTimer, &QTimer::timeout, this, &MqttPublisher::closeExpiredBatches);
+    connect(reconnectTimer, &QTimer::timeout, this, &MqttPublisher::connectToBroker);
+    connect(keepAliveTimer, &QTimer::timeout, this, &MqttPublisher::checkKeepAlive);
+
+    connect(socket, &QTcpSocket::connected, this, &MqttPublisher::socketConnected);
+    connect(socket, &QTcpSocket::disconnected, this, &MqttPublisher::socketDisconnected);
+    connect(socket, &QTcpSocket::readyRead, this, &MqttPublisher::readPackets);
+    connect(socket, &QTcpSocket::bytesWritten, this, &MqttPublisher::sendQueued);
+    connect(socket,
+        #if (QT_VERSION < QT_VERSION_CHECK(5, 15, 0))
+        QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
+        #else
+        &QAbstractSocket::errorOccurred,
+        #endif
+        this, [this](const QAbstractSocket::SocketError error) {
+            errorMessage = socket->errorString();
+            qCWarning(lc).noquote() << tr("MQTT broker connection error:") << error << errorMessage;
+            if (socket->state() == QAbstractSocket::UnconnectedState) {
+                socketDisconnected(); // Never connected, so disconnected() will not be emitted.
+            }
+        });
+}
+
+/*!
+ * Destroys this publisher, after closing all open batches, and making a best-effort attempt to write any queued
+ * messages to the broker. Any QoS 1 messages not yet acknowledged by then are lost.
+ */
+MqttPublisher::~MqttPublisher()
+{
+    flush();
+    if (sessionOpen) {
+        sendQueued();
+        socket->write(encodePacket(PacketType::Disconnect, 0, QByteArray()));
+        socket->waitForBytesWritten(1000); // Only ever blocks on exit.
+    }
+    if (!queue.isEmpty()) {
+        qCWarning(lc).noquote() << tr("Discarding %Ln unsent MQTT message/s.", nullptr, (int)queue.size());
+    }
+    qCDebug(lc).noquote() << tr("Published %L1 value/s in %L2 message/s; %L3 sent, %L4 acknowledged, %L5 dropped.")
+        .arg(stats.values).arg(stats.messages).arg(stats.sent).arg(stats.acknowledged).arg(stats.dropped);
+}
+
+/*!
+ * Configures this publisher from \a url, returning \c true on success, otherwise \c false, with errorString() set.
+ *
+ * The \a url takes the form `mqtt://[user[:password]@]host[:port][/topic-prefix][?query]`, where the topic prefix
+ * defaults to `dokit`, and the query may include any of:
+ *
+ * | Item         | Description                                                                 | Default       |
+ * |--------------|-----------------------------------------------------------------------------|---------------|
+ * | `qos`        | Quality of service to publish with: `0` or `1`.                             | `0`           |
+ * | `format`     | Batch payload format: `binary` or `json`.                                   | `binary`      |
+ * | `interval`   | Maximum time a batch may stay open, such as `500ms`, or `2s`.               | `1s`          |
+ * | `size`       | Payload size, in bytes, at which a batch is closed early, such as `64K`.    | `16384`       |
+ * | `buffer`     | Size of the spill buffer for when the broker is unreachable, such as `32M`. | `8388608`     |
+ * | `client-id`  | MQTT client identifier.                                                     | `dokit-<pid>` |
+ * | `keep-alive` | MQTT keep-alive interval, in seconds.                                       | `30`          |
+ */
+bool MqttPublisher::setUrl(const QUrl &url)
+{
+    if ((!url.isValid()) || (url.host().isEmpty())) {
+        errorMessage = tr("Invalid URL");
+        return false;
+    }
+    if ((url.scheme() != u"mqtt"_s) && (url.scheme() != u"tcp"_s)) {
+        errorMessage = tr("Unsupported scheme: %1").arg(url.scheme());
+        return false;
+    }
+    host = url.host();
+    port = (quint16)url.port(1883);
+    userName = url.userName(QUrl::FullyDecoded);
+    password = url.password(QUrl::FullyDecoded);
+    QString path = url.path(QUrl::FullyDecoded);
+    while (path.startsWith(u'/')) {
+        path.remove(0, 1);
+    }
+    while (path.endsWith(u'/')) {
+        path.chop(1);
+    }
+    if (!path.isEmpty()) {
+        topicPrefix = path;
+    }
+
+    const QUrlQuery query(url);
+    for (const auto &[key, value]: query.queryItems(QUrl::FullyDecoded)) {
+        if (key == u"qos"_s) {
+            if ((value != u"0"_s) && (value != u"1"_s)) {
+                errorMessage = tr("Unsupported qos value: %1").arg(value);
+                return false;
+            }
+            qos = (quint8)value.toUInt();
+        } else if (key == u"format"_s) {
+            if (value.compare(u"binary"_s, Qt::CaseInsensitive) == 0) {
+                format = PayloadFormat::Binary;
+            } else if (value.compare(u"json"_s, Qt::CaseInsensitive) == 0) {
+                format = PayloadFormat::Json;
+            } else {
+                errorMessage = tr("Unsupported format value: %1").arg(value);
+                return false;
+            }
+        } else if (key == u"interval"_s) {
+            batchInterval = AbstractCommand::parseNumber<std::milli>(value, u"s"_s, 1);
+            if (batchInterval == 0) {
+                errorMessage = tr("Invalid interval value: %1").arg(value);
+                return false;
+            }
+        } else if (key == u"size"_s) {
+            batchSize = AbstractCommand::parseNumber<std::ratio<1>>(value, u"B"_s);
+            if (batchSize == 0) {
+                errorMessage = tr("Invalid size value: %1").arg(value);
+                return false;
+            }
+        } else if (key == u"buffer"_s) {
+            bufferSize = AbstractCommand::parseNumber<std::ratio<1>>(value, u"B"_s);
+            if (bufferSize == 0) {
+                errorMessage = tr("Invalid buffer value: %1").arg(value);
+                return false;
+            }
+        } else if (key == u"client-id"_s) {
+            clientId = value;
+        } else if (key == u"keep-alive"_s) {
+            bool ok;
+            const uint seconds = value.toUInt(&ok);
+            if ((!ok) || (seconds == 0) || (seconds > std::numeric_limits<quint16>::max())) {
+                errorMessage = tr("Invalid keep-alive value: %1").arg(value);
+                return false;
+            }
+            keepAlive = (quint16)seconds;
+        } else {
+            errorMessage = tr("Unknown query item: %1").arg(key);
+            return false;
+        }
+    }
+    errorMessage.clear();
+    return true;
+}
+
+/*!
+ * Returns a human-readable description of the last error, if any.
+ */
+QString MqttPublisher::errorString() const
+{
+    return errorMessage;
+}
+
+/*!
+ * Returns the topic to publish \a stream (such as `meter`, or `dso`) values from \a device to. Any MQTT wildcard, or
+ * topic level separator, characters in \a device are replaced with underscores, so that each device has a single
+ * topic level.
+ */
+QString MqttPublisher::topic(const QString &device, const QString &stream) const
+{
+    QString level = (device.isEmpty()) ? u"unknown"_s : device;
+    for (const QChar c: { u'/', u'+', u'#' }) {
+        level.replace(c, u'_');
+    }
+    return topicPrefix + u'/' + level + u'/' + stream;
+}
+
+/*!
+ * Returns this publisher's statistics.
+ */
+MqttPublisher::Statistics MqttPublisher::statistics() const
+{
+    return stats;
+}
+
+/*!
+ * Returns the total size of all messages' payloads currently held in the spill buffer.
+ */
+qint64 MqttPublisher::bufferedBytes() const
+{
+    return queuedBytes;
+}
+
+/*!
+ * Returns \c true if the broker has accepted this publisher's current connection, otherwise \c false.
+ */
+bool MqttPublisher::isConnected() const
+{
+    return sessionOpen;
+}
+
+/*!
+ * Adds meter \a reading, taken at \a timestamp (in milliseconds since the epoch), with the meter's update \a interval
+ * (in milliseconds), to the batch for \a topic.
+ *
+ * Consecutive readings of the same mode and range share a single block: in the Binary format, a block header (with
+ * the first reading's \a timestamp, and the \a interval) followed by one 8-byte record per reading, and in the JSON
+ * format, an object with `mode`, `range`, `timestamps` and `values` arrays (with any non-finite values as `null`).
+ */
+void MqttPublisher::publish(const QString &topic, const MultimeterService::Reading &reading, const qint64 timestamp,
+                            const quint32 interval)
+{
+    Batch &batch = openBatch(topic, QDateTime::currentMSecsSinceEpoch());
+    if ((batch.blockCount > 0) && ((batch.blockMode != (quint8)reading.mode) || (batch.blockRange != reading.range))) {
+        closeMeterBlock(batch);
+    }
+
+    if (batch.blockCount == 0) {
+        batch.blockMode = (quint8)reading.mode;
+        batch.blockRange = reading.range;
+        if (format == PayloadFormat::Binary) {
+            batch.blockOffset = (int)batch.payload.size();
+            AbstractCommand::writeBinaryHeader(batch.payload, AbstractCommand::BinaryBlock::MeterReadings,
+                batch.blockMode, batch.blockRange, 1.0f, interval, (quint64)timestamp, 0);
+        }
+    }
+    ++batch.blockCount;
+    ++stats.values;
+
+    if (format == PayloadFormat::Binary) {
+        quint32 valueBits;
+        std::memcpy(&valueBits, &reading.value, sizeof(valueBits));
+        char record[8] { 0, 0, 0, 0, (char)reading.status, (char)reading.mode, (char)reading.range, 0 };
+        qToLittleEndian<quint32>(valueBits, record);
+        batch.payload.append(record, sizeof(record));
+        qToLittleEndian<quint32>(batch.blockCount, batch.payload.data() + batch.blockOffset + 24);
+    } else {
+        if (batch.blockCount > 1) {
+            batch.timestamps.append(',');
+            batch.values.append(',');
+        }
+        batch.timestamps.append(QByteArray::number(timestamp));
+        batch.values.append(AbstractCommand::formatJsonNumber(reading.value));
+    }
+
+    if (batch.payload.size() + batch.timestamps.size() + batch.values.size() >= batchSize) {
+        closeBatch(topic, batch);
+    }
+}
+
+/*!
+ * Adds DSO \a samples, the first of which was taken at \a timestamp (in milliseconds since the epoch), to the batch
+ * for \a topic, as a single block described by \a metadata.
+ *
+ * In the Binary format, the block is a block header followed by the raw samples, exactly as per the `dso` command's
+ * Binary output. In the JSON format, it is an object with `mode`, `range`, `timestamp`, `samplingRate` and (scaled)
+ * `values`.
+ */
+void MqttPublisher::publish(const QString &topic, const DsoService::Metadata &metadata,
+                            const DsoService::Samples &samples, const qint64 timestamp)
+{
+    if (samples.isEmpty()) {
+        return;
+    }
+    Batch &batch = openBatch(topic, QDateTime::currentMSecsSinceEpoch());
+    stats.values += samples.size();
+    if (format == PayloadFormat::Binary) {
+        AbstractCommand::writeBinaryHeader(batch.payload, AbstractCommand::BinaryBlock::DsoSamples,
+            (quint8)metadata.mode, metadata.range, metadata.scale, metadata.samplingRate, (quint64)timestamp,
+            (quint32)samples.size());
+        AbstractCommand::writeBinarySamples(batch.payload, samples);
+    } else {
+        if (batch.payload.size() > 1) {
+            batch.payload.append(',');
+        }
+        batch.payload.append("{\"mode\":")
+            .append(AbstractCommand::escapeJsonString(DsoService::toString(metadata.mode)))
+            .append(",\"range\":").append(QByteArray::number(metadata.range))
+            .append(",\"timestamp\":").append(QByteArray::number(timestamp))
+            .append(",\"samplingRate\":").append(QByteArray::number(metadata.samplingRate))
+            .append(",\"values\":[");
+        for (qsizetype index = 0; index < samples.size(); ++index) {
+            if (index > 0) {
+                batch.payload.append(',');
+            }
+            batch.payload.append(AbstractCommand::formatJsonNumber(samples.at(index) * metadata.scale));
+        }
+        batch.payload.append("]}");
+    }
+
+    if (batch.payload.size() >= batchSize) {
+        closeBatch(topic, batch);
+    }
+}
+
+/*!
+ * Begins connecting to the broker. Values may be published before (and while) connected, in which case they are held
+ * in the spill buffer until the connection is established.
+ */
+void MqttPublisher::start()
+{
+    connectToBroker();
+}
+
+/*!
+ * Closes all open batches, queuing them for publishing straight away, regardless of their size, or age.
+ */
+void MqttPublisher::flush()
+{
+    const QStringList topics = batches.keys();
+    for (const QString &topic: topics) {
+        closeBatch(topic, batches[topic]);
+    }
+}
+
+/*!
+ * Returns the open batch for \a topic, opening a new one (at time \a now) if there is none.
+ */
+MqttPublisher::Batch &MqttPublisher::openBatch(const QString &topic, const qint64 now)
+{
+    auto iter = batches.find(topic);
+    if (iter == batches.end()) {
+        Batch batch;
+        batch.payload.reserve(batchSize + 64);
+        if (format == PayloadFormat::Json) {
+            batch.payload.append('[');
+        }
+        batch.opened = now;
+        iter = batches.insert(topic, batch);
+        if (!batchTimer->isActive()) {
+            batchTimer->start((int)batchInterval);
+        }
+    }
+    return *iter;
+}
+
+/*!
+ * Closes \a batch's open meter block, if any.
+ */
+void MqttPublisher::closeMeterBlock(Batch &batch)
+{
+    if ((format == PayloadFormat::Json) && (batch.blockCount > 0)) {
+        if (batch.payload.size() > 1) {
+            batch.payload.append(',');
+        }
+        batch.payload.append("{\"mode\":").append(AbstractCommand::escapeJsonString(
+                MultimeterService::toString((MultimeterService::Mode)batch.blockMode)))
+            .append(",\"range\":").append(QByteArray::number(batch.blockRange))
+            .append(",\"timestamps\":[").append(batch.timestamps)
+            .append("],\"values\":[").append(batch.values).append("]}");
+        batch.timestamps.clear();
+        batch.values.clear();
+    }
+    batch.blockOffset = -1;
+    batch.blockCount = 0;
+}
+
+/*!
+ * Closes \a batch (which must be the open batch for \a topic), and queues its payload for publishing.
+ */
+void MqttPublisher::closeBatch(const QString &topic, Batch &batch)
+{
+    closeMeterBlock(batch);
+    QByteArray payload = std::move(batch.payload);
+    if (format == PayloadFormat::Json) {
+        payload.append(']');
+    }
+    batches.remove(topic); // Invalidates batch.
+    enqueue(topic, payload);
+}
+
+/*!
+ * Closes all batches that have been open for at least #batchInterval, and re-arms #batchTimer for the next-oldest
+ * batch (if any).
+ */
+void MqttPublisher::closeExpiredBatches()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QStringList topics = batches.keys();
+    for (const QString &topic: topics) {
+        if (now - batches.value(topic).opened >= batchInterval) {
+            closeBatch(topic, batches[topic]);
+        }
+    }
+    if (!batches.isEmpty()) {
+        qint64 oldest = std::numeric_limits<qint64>::max();
+        for (const Batch &batch: std::as_const(batches)) {
+            oldest = std::min(oldest, batch.opened);
+        }
+        batchTimer->start((int)std::max<qint64>(oldest + batchInterval - now, 1));
+    }
+}
+
+/*!
+ * Appends \a payload to the spill buffer, as a message for \a topic, discarding the oldest unsent messages if the
+ * buffer would otherwise exceed #bufferSize (or its MemoryBudget quota), then sends as many queued messages as the
+ * connection allows.
+ */
+void MqttPublisher::enqueue(const QString &topic, const QByteArray &payload)
+{
+    queue.enqueue({ topic.toUtf8(), payload });
+    queuedBytes += payload.size();
+    memory.charge(payload.size());
+    ++stats.messages;
+
+    // Messages already in flight (at the head of the queue) cannot be discarded, since they may yet be acknowledged.
+    while (((queuedBytes > bufferSize) || (!memory.fits(0))) && (queue.size() > unacknowledged + 1)) {
+        if (queuedBytes <= bufferSize) {
+            memory.countRefusal(); // The memory budget, rather than the spill buffer, is what's full.
+        }
+        queuedBytes -= queue.at(unacknowledged).payload.size();
+        memory.release(queue.at(unacknowledged).payload.size());
+        queue.removeAt(unacknowledged);
+        ++stats.dropped;
+        if (!warnedDropping) {
+            qCWarning(lc).noquote() << tr("MQTT spill buffer full; discarding oldest messages.");
+            warnedDropping = true;
+        }
+    }
+    sendQueued();
+}
+
+/*!
+ * Writes queued messages to the broker, in order, until either there are none left, the socket's write buffer is
+ * full enough (to be resumed once bytes have been written), or (for QoS 1) the in-flight limit has been reached.
+ *
+ * QoS 0 messages leave the queue as soon as they are written, while QoS 1 messages remain until acknowledged.
+ */
+void MqttPublisher::sendQueued()
+{
+    while ((sessionOpen) && (unacknowledged < queue.size()) && (socket->bytesToWrite() < maxSocketBuffer)) {
+        if (qos == 0) {
+            const Message message = queue.dequeue();
+            queuedBytes -= message.payload.size();
+            memory.release(message.payload.size());
+            socket->write(publishPacket(message.topic, message.payload, 0, 0, false));
+        } else if (unacknowledged < maxUnacknowledged) {
+            Message &message = queue[unacknowledged++];
+            message.packetId = nextPacketId;
+            nextPacketId = (nextPacketId == std::numeric_limits<quint16>::max()) ? 1 : nextPacketId + 1;
+            socket->write(publishPacket(message.topic, message.payload, qos, message.packetId, false));
+        } else {
+            break;
+        }
+        ++stats.sent;
+    }
+}
+
+/*!
+ * Begins connecting to the broker, unless already connected (or connecting).
+ */
+void MqttPublisher::connectToBroker()
+{
+    if (socket->state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Connecting to MQTT broker %1 port %2.").arg(host).arg(port);
+    socket->connectToHost(host, port);
+}
+
+/*!
+ * Handles the TCP connection to the broker being established, by requesting an MQTT session.
+ */
+void MqttPublisher::socketConnected()
+{
+    received.clear();
+    lastReceived = QDateTime::currentMSecsSinceEpoch();
+    socket->write(connectPacket(clientId, userName, password, keepAlive));
+    keepAliveTimer->start(keepAlive * 1000 / 2);
+}
+
+/*!
+ * Handles the connection to the broker being lost (or failing to be established), by scheduling a reconnection, with
+ * exponential backoff. Any QoS 1 messages in flight will be re-sent once reconnected.
+ */
+void MqttPublisher::socketDisconnected()
+{
+    sessionOpen = false;
+    keepAliveTimer->stop();
+    if (reconnectTimer->isActive()) {
+        return; // Already reported, such as by both an error, and a disconnection.
+    }
+    reconnectDelay = (reconnectDelay == 0) ? 1000 : std::min(reconnectDelay * 2, maxReconnectDelay);
+    qCWarning(lc).noquote() << tr("Not connected to MQTT broker %1 port %2; retrying in %L3ms (%L4 byte/s buffered).")
+        .arg(host).arg(port).arg(reconnectDelay).arg(queuedBytes);
+    reconnectTimer->start(reconnectDelay);
+}
+
+/*!
+ * Reads, and handles, all complete packets received from the broker.
+ */
+void MqttPublisher::readPackets()
+{
+    received.append(socket->readAll());
+    lastReceived = QDateTime::currentMSecsSinceEpoch();
+    quint8 header;
+    QByteArray body;
+    for (qsizetype size; (size = parsePacket(received, header, body)) != 0; received.remove(0, size)) {
+        if (size < 0) {
+            qCWarning(lc).noquote() << tr("Received malformed packet from MQTT broker.");
+            socket->abort();
+            return;
+        }
+        handlePacket((PacketType)(header >> 4), body);
+        if (socket->state() != QAbstractSocket::ConnectedState) {
+            return; // Aborted, such as by a refused connection.
+        }
+    }
+}
+
+/*!
+ * Pings the broker, as required by the keep-alive interval, and aborts the connection if the broker has been silent
+ * for too long (including not having accepted the connection yet).
+ */
+void MqttPublisher::checkKeepAlive()
+{
+    if (QDateTime::currentMSecsSinceEpoch() - lastReceived > keepAlive * 1500) {
+        qCWarning(lc).noquote() << tr("MQTT broker %1 port %2 is not responding.").arg(host).arg(port);
+        socket->abort();
+        socketDisconnected(); // In case abort() did not emit disconnected().
+        return;
+    }
+    if (sessionOpen) {
+        socket->write(encodePacket(PacketType::PingReq, 0, QByteArray()));
+    }
+}
+
+/*!
+ * Handles an MQTT packet of \a type, with \a body (that is, the packet after its fixed header), from the broker.
+ */
+void MqttPublisher::handlePacket(const PacketType type, const QByteArray &body)
+{
+    switch (type) {
+    case PacketType::ConnAck:
+        if ((body.size() != 2) || (body.at(1) != 0)) {
+            errorMessage = tr("MQTT broker refused connection (code %1)")
+                .arg((body.size() == 2) ? (int)body.at(1) : -1);
+            qCWarning(lc).noquote() << errorMessage;
+            socket->abort();
+            return;
+        }
+        qCInfo(lc).noquote() << tr("Connected to MQTT broker %1 port %2.").arg(host).arg(port);
+        sessionOpen = true;
+        reconnectDelay = 0;
+        warnedDropping = false;
+        ++stats.connections;
+        for (int index = 0; index < unacknowledged; ++index) { // Re-send any in-flight messages.
+            const Message &message = queue.at(index);
+            socket->write(publishPacket(message.topic, message.payload, qos, message.packetId, true));
+            ++stats.sent;
+        }
+        sendQueued();
+        break;
+    case PacketType::PubAck: {
+        if (body.size() != 2) {
+            break;
+        }
+        const quint16 packetId = qFromBigEndian<quint16>(body.constData());
+        for (int index = 0; index < unacknowledged; ++index) {
+            if (queue.at(index).packetId == packetId) {
+                queuedBytes -= queue.at(index).payload.size();
+                memory.release(queue.at(index).payload.size());
+                queue.removeAt(index);
+                --unacknowledged;
+                ++stats.acknowledged;
+                break;
+            }
+        }
+        sendQueued();
+    }   break;
+    case PacketType::PingResp:
+        break;
+    default:
+        qCDebug(lc).noquote() << tr("Ignoring unexpected MQTT packet type %1.").arg((int)type);
+    }
+}
+
+/*!
+ * Returns \a string encoded as an MQTT UTF-8 string; that is, preceded by its big-endian 16-bit length.
+ */
+QByteArray MqttPublisher::encodeString(const QByteArray &string)
+{
+    char length[2];
+    qToBigEndian<quint16>((quint16)string.size(), length);
+    return QByteArray(length, sizeof(length)) + string;
+}
+
+/*!
+ * Returns an MQTT control packet of \a type, with (fixed header) \a flags, and \a body.
+ */
+QByteArray MqttPublisher::encodePacket(const PacketType type, const quint8 flags, const QByteArray &body)
+{
+    QByteArray packet;
+    packet.reserve(body.size() + 5);
+    packet.append((char)(((quint8)type << 4) | (flags & 0x0F)));
+    quint32 remaining = (quint32)body.size();
+    do { // Variable-length encoding, seven bits at a time, least significant first.
+        const quint8 byte = remaining & 0x7F;
+        remaining >>= 7;
+        packet.append((char)((remaining > 0) ? (byte | 0x80) : byte));
+    } while (remaining > 0);
+    return packet + body;
+}
+
+/*!
+ * Returns an MQTT CONNECT packet, requesting a clean session for \a clientId, with optional \a userName and
+ * \a password, and \a keepAlive interval (in seconds).
+ */
+QByteArray MqttPublisher::connectPacket(const QString &clientId, const QString &userName, const QString &password,
+                                        const quint16 keepAlive)
+{
+    quint8 flags = 0x02; // Clean session.
+    if (!userName.isEmpty()) {
+        flags |= 0x80;
+        if (!password.isEmpty()) {
+            flags |= 0x40; // MQTT 3.1.1 does not allow a password without a user name.
+        }
+    }
+    char keepAliveBytes[2];
+    qToBigEndian<quint16>(keepAlive, keepAliveBytes);
+    QByteArray body = encodeString("MQTT") + (char)4 + (char)flags + QByteArray(keepAliveBytes, 2)
+        + encodeString(clientId.toUtf8());
+    if (flags & 0x80) {
+        body += encodeString(userName.toUtf8());
+    }
+    if (flags & 0x40) {
+        body += encodeString(password.toUtf8());
+    }
+    return encodePacket(PacketType::Connect, 0, body);
+}
+
+/*!
+ * Returns an MQTT PUBLISH packet for \a payload to \a topic, with \a qos, and (for QoS 1) \a packetId, flagged as a
+ * \a duplicate (re-sent) message if \c true.
+ */
+QByteArray MqttPublisher::publishPacket(const QByteArray &topic, const QByteArray &payload, const quint8 qos,
+                                        const quint16 packetId, const bool duplicate)
+{
+    QByteArray body = encodeString(topic);
+    if (qos > 0) {
+        char packetIdBytes[2];
+        qToBigEndian<quint16>(packetId, packetIdBytes);
+        body.append(packetIdBytes, sizeof(packetIdBytes));
+    }
+    body.append(payload);
+    return encodePacket(PacketType::Publish, (quint8)(((duplicate) ? 0x08 : 0) | (qos << 1)), body);
+}
+
+/*!
+ * Parses the first MQTT packet in \a data, setting \a header to its first (type and flags) byte, and \a body to the
+ * rest of the packet, after its fixed header.
+ *
+ * Returns the size, in bytes, of the packet parsed, or 0 if \a data does not contain a complete packet yet, or -1 if
+ * \a data is malformed.
+ */
+qsizetype MqttPublisher::parsePacket(const QByteArray &data, quint8 &header, QByteArray &body)
+{
+    quint32 length = 0;
+    qsizetype pos = 1;
+    for (int shift = 0; ; shift += 7) {
+        if (pos >= data.size()) {
+            return 0;
+        }
+        if (pos > 4) {
+            return -1; // The remaining length is at most four bytes.
+        }
+        const quint8 byte = (quint8)data.at(pos++);
+        length |= (quint32)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    if (data.size() - pos < (qsizetype)length) {
+        return 0;
+    }
+    header = (quint8)data.at(0);
+    body = data.mid(pos, length);
+    return pos + length;
+}
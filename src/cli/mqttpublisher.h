@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_MQTTPUBLISHER_H
+#define DOKIT_MQTTPUBLISHER_H
+
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/memorybudget.h>
+#include <qtpokit/multimeterservice.h>
+
+#include <QHash>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QQueue>
+#include <QUrl>
+
+QTPOKIT_USE_NAMESPACE
+
+class QTcpSocket;
+class QTimer;
+
+class MqttPublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Supported batch payload formats.
+    enum class PayloadFormat {
+        Binary, ///< Binary output format blocks (see AbstractCommand::writeBinaryHeader()).
+        Json,   ///< Compact JSON, with one array of values per block.
+    };
+
+    /// Publishing statistics.
+    struct Statistics {
+        quint64 values { 0 };      ///< Number of readings and samples added to batches.
+        quint64 messages { 0 };    ///< Number of batches closed, and queued as messages.
+        quint64 sent { 0 };        ///< Number of messages written to the broker, including re-sends.
+        quint64 acknowledged { 0 };///< Number of QoS 1 messages acknowledged by the broker.
+        quint64 dropped { 0 };     ///< Number of messages discarded, because the spill buffer was full.
+        quint64 connections { 0 }; ///< Number of times the broker has accepted a connection.
+    };
+
+    static constexpr quint32 defaultBatchInterval { 1000 };        ///< Default maximum batch age, in milliseconds.
+    static constexpr quint32 defaultBatchSize { 16 * 1024 };       ///< Default maximum batch size, in bytes.
+    static constexpr qint64 defaultBufferSize { 8 * 1024 * 1024 }; ///< Default spill buffer size, in bytes.
+
+    explicit MqttPublisher(QObject * const parent = nullptr);
+    ~MqttPublisher() override;
+
+    bool setUrl(const QUrl &url);
+    QString errorString() const;
+    QString topic(const QString &device, const QString &stream) const;
+    Statistics statistics() const;
+    qint64 bufferedBytes() const;
+    bool isConnected() const;
+
+    void publish(const QString &topic, const MultimeterService::Reading &reading, const qint64 timestamp,
+                 const quint32 interval);
+    void publish(const QString &topic, const DsoService::Metadata &metadata, const DsoService::Samples &samples,
+                 const qint64 timestamp);
+
+public slots:
+    void start();
+    void flush();
+
+private:
+    /// Values added for a single topic, but not yet queued as a message.
+    struct Batch {
+        QByteArray payload;        ///< Payload encoded so far, excluding any open JSON meter block.
+        qint64 opened { 0 };       ///< Time the batch's first value was added, in milliseconds since the epoch.
+        int blockOffset { -1 };    ///< Offset of the open binary meter block's header, or -1 if none is open.
+        quint32 blockCount { 0 };  ///< Number of readings in the open meter block.
+        quint8 blockMode { 0 };    ///< Mode of the open meter block.
+        quint8 blockRange { 0 };   ///< Range of the open meter block.
+        QByteArray timestamps;     ///< Open JSON meter block's timestamps, as comma-separated values.
+        QByteArray values;         ///< Open JSON meter block's values, as comma-separated values.
+    };
+
+    /// A closed batch, waiting to be sent to (or, for QoS 1, acknowledged by) the broker.
+    struct Message {
+        QByteArray topic;        ///< UTF-8 encoded topic.
+        QByteArray payload;      ///< Batch payload.
+        quint16 packetId { 0 };  ///< QoS 1 packet identifier, once sent, or 0 if not (yet) sent.
+    };
+
+    /// MQTT control packet types.
+    enum class PacketType : quint8 {
+        Connect = 1, ConnAck = 2, Publish = 3, PubAck = 4, PingReq = 12, PingResp = 13, Disconnect = 14,
+    };
+
+    QString host;        ///< Broker host name or address.
+    quint16 port { 1883 };  ///< Broker port.
+    QString clientId;    ///< Client identifier to connect with.
+    QString userName;    ///< User name to connect with, if any.
+    QString password;    ///< Password to connect with, if any.
+    QString topicPrefix; ///< Prefix of all topics published to, without trailing slash.
+    PayloadFormat format { PayloadFormat::Binary };  ///< Batch payload format.
+    quint8 qos { 0 };                                ///< Quality of service to publish with (0 or 1).
+    quint32 batchInterval { defaultBatchInterval };  ///< Maximum batch age, in milliseconds.
+    quint32 batchSize { defaultBatchSize };          ///< Payload size at which batches are closed early.
+    qint64 bufferSize { defaultBufferSize };         ///< Maximum size of all queued messages' payloads.
+    quint16 keepAlive { 30 };                        ///< Keep-alive interval, in seconds.
+    QString errorMessage;                            ///< Description of the last error, if any.
+
+    QTcpSocket * socket { nullptr };       ///< Connection to the broker.
+    QTimer * batchTimer { nullptr };       ///< Closes batches that have reached #batchInterval.
+    QTimer * reconnectTimer { nullptr };   ///< Delays reconnection attempts.
+    QTimer * keepAliveTimer { nullptr };   ///< Pings the broker, and detects dead connections.
+    QHash<QString, Batch> batches;         ///< Open batches, by topic.
+    QQueue<Message> queue;                 ///< Spill buffer of closed batches, oldest first.
+    qint64 queuedBytes { 0 };              ///< Total size of all #queue payloads.
+    MemoryBudget::Stream memory { QStringLiteral("mqtt"), MemoryBudget::Kind::Spill }; ///< Accounts for #queue.
+    int unacknowledged { 0 };              ///< Number of #queue messages sent with QoS 1, but not yet acknowledged.
+    quint16 nextPacketId { 1 };            ///< Next QoS 1 packet identifier.
+    bool sessionOpen { false };            ///< Whether the broker has accepted the current connection.
+    bool warnedDropping { false };         ///< Whether dropping messages has been logged since the last connection.
+    int reconnectDelay { 0 };              ///< Current reconnect backoff, in milliseconds.
+    qint64 lastReceived { 0 };             ///< Time the last packet was received, in milliseconds since the epoch.
+    QByteArray received;                   ///< Bytes received, but not yet parsed as complete packets.
+    Statistics stats;                      ///< Publishing statistics.
+
+    static constexpr int maxUnacknowledged { 16 };      ///< Maximum QoS 1 messages in flight at once.
+    static constexpr qint64 maxSocketBuffer { 64 * 1024 }; ///< Socket write buffer level to stop sending at.
+    static constexpr int maxReconnectDelay { 60000 };   ///< Maximum reconnect backoff, in milliseconds.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.mqtt", QtInfoMsg); ///< Logging category for MQTT publishing.
+
+    Batch &openBatch(const QString &topic, const qint64 now);
+    void closeMeterBlock(Batch &batch);
+    void closeBatch(const QString &topic, Batch &batch);
+    void closeExpiredBatches();
+    void enqueue(const QString &topic, const QByteArray &payload);
+    void sendQueued();
+
+    void connectToBroker();
+    void socketConnected();
+    void socketDisconnected();
+    void readPackets();
+    void checkKeepAlive();
+    void handlePacket(const PacketType type, const QByteArray &body);
+
+    static QByteArray encodeString(const QByteArray &string);
+    static QByteArray encodePacket(const PacketType type, const quint8 flags, const QByteArray &body);
+    static QByteArray connectPacket(const QString &clientId, const QString &userName, const QString &password,
+                                    const quint16 keepAlive);
+    static QByteArray publishPacket(const QByteArray &topic, const QByteArray &payload, const quint8 qos,
+                                    const quint16 packetId, const bool duplicate);
+    static qsizetype parsePacket(const QByteArray &data, quint8 &header, QByteArray &body);
+
+    QTPOKIT_BEFRIEND_TEST(MqttPublisher)
+};
+
+#endif // DOKIT_MQTTPUBLISHER_H
@@ -0,0 +1,470 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "outputfilewriter.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/pokittrace.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class OutputFileWriter
+ *
+ * The OutputFileWriter class writes command output to a file, via a dedicated writer thread, so that a slow (or
+ * briefly unresponsive, such as NFS) disk never blocks the Qt event loop, and thus the processing of Bluetooth
+ * notifications.
+ *
+ * Output passed to write() is only appended to an in-memory queue, which the writer thread drains, coalescing queued
+ * output into writes of up to #chunkSize bytes. The queue is bounded by a maximum size (see setQueueSize()). If the
+ * disk falls so far behind that the queue fills up, then by default further output is dropped (and counted, see
+ * statistics()) until the writer thread catches up, rather than ever blocking the caller. Other policies (see
+ * setOverflowPolicy()) instead drop the oldest queued output, thin the queued output out, or block the caller until
+ * there is room; the latter pushes back on the device's notifications instead, which then risks the device itself
+ * dropping them (uncounted).
+ *
+ * The queue is also accounted against the global MemoryBudget, as an "output" stream, so the queue is also full
+ * whenever it has reached that stream's quota (or the budget has reached its limit), with the same overflow policy.
+ *
+ * The writer may also write to stdout (see openStdout()), so that a stalled stdout pipe is subject to the same
+ * overflow policy, instead of blocking the event loop.
+ *
+ * The writer thread may also be pinned to chosen CPUs, and given elevated (or real-time) priority, via
+ * setThreadPolicy(), such as to keep it off the CPUs reserved for the device's thread.
+ *
+ * The file may also be rotated once it reaches a maximum size, and/or a maximum age (see setRotation()). Rotation
+ * renames the current file (see rotatedFileName()), then starts a new file with the original name. Since each call to
+ * write() is only ever written to a single file, files are only rotated between the commands' batches of output.
+ */
+
+/*!
+ * Constructs a new output file writer with \a parent. Call open() to begin writing.
+ */
+OutputFileWriter::OutputFileWriter(QObject * const parent) : QObject(parent)
+{
+
+}
+
+/*!
+ * Destroys this writer, first writing any queued output, as per close().
+ */
+OutputFileWriter::~OutputFileWriter()
+{
+    close();
+}
+
+/*!
+ * Opens (and truncates, if it already exists) \a fileName for writing, and starts the writer thread. Returns \c true
+ * on success, otherwise \c false, in which case errorString() describes the failure.
+ */
+bool OutputFileWriter::open(const QString &fileName)
+{
+    Q_ASSERT(!thread.joinable());
+    name = fileName;
+    return start(new QFile(name)); // Not parented, since it will be used by the writer thread.
+}
+
+/*!
+ * Begins writing to stdout, via the writer thread, instead of a named file. Returns \c true on success, otherwise
+ * \c false, in which case errorString() describes the failure.
+ *
+ * Output already written to stdout by other means (such as \c std::cout) is flushed first. Rotation is not supported
+ * for stdout, so must not be set.
+ */
+bool OutputFileWriter::openStdout()
+{
+    Q_ASSERT(!thread.joinable());
+    Q_ASSERT((rotateSize == 0) && (rotateAge == 0));
+    std::cout.flush();
+    name = u"stdout"_s;
+    return start(new QFile);
+}
+
+/*!
+ * Opens \a newFile, which becomes the current #file, and starts the writer thread. Returns \c true on success, or
+ * otherwise deletes \a newFile, sets errorString(), and returns \c false. A \a newFile without a file name is
+ * opened on stdout.
+ */
+bool OutputFileWriter::start(QFile * const newFile)
+{
+    file = newFile;
+    const bool opened = (file->fileName().isEmpty())
+        ? file->open(stdout, QIODevice::WriteOnly|QIODevice::Unbuffered, QFileDevice::DontCloseHandle)
+        : file->open(QIODevice::WriteOnly|QIODevice::Truncate|QIODevice::Unbuffered);
+    if (!opened) {
+        errorMessage = file->errorString();
+        delete std::exchange(file, nullptr);
+        return false;
+    }
+    fileSize = 0;
+    fileOpened = QDateTime::currentMSecsSinceEpoch();
+    stopping = false;
+    threadSettingsPending = threadSettings.has_value();
+    qCDebug(lc).noquote() << tr("Writing output to %1.").arg(name);
+    thread = std::thread(&OutputFileWriter::run, this);
+    return true;
+}
+
+/*!
+ * Writes all queued output, stops the writer thread, and closes the file. This blocks until the writer thread has
+ * finished, so should only be called once the command has finished producing output.
+ */
+void OutputFileWriter::close()
+{
+    if (!thread.joinable()) {
+        return;
+    }
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    drained.notify_all(); // Release any (other thread's) blocked write() calls.
+    thread.join();
+    file->close();
+    delete std::exchange(file, nullptr);
+
+    const Statistics summary = statistics();
+    if (summary.dropped > 0) {
+        qCWarning(lc).noquote() << tr("Dropped %Ln write/s (%L1 byte/s) to %2, because the disk could not keep up.",
+            nullptr, (int)summary.dropped).arg(summary.bytesDropped).arg(name);
+    }
+    if (summary.blocked > 0) {
+        qCWarning(lc).noquote() << tr("Blocked %Ln write/s to %2, for %L1ms in total, because the disk could not keep "
+            "up.", nullptr, (int)summary.blocked).arg(summary.blockedTime / 1'000'000).arg(name);
+    }
+    qCDebug(lc).noquote() << tr("Wrote %L1 byte/s to %2 in %L3 write/s, with %L4 rotation/s and %L5 error/s.")
+        .arg(summary.bytesWritten).arg(name).arg(summary.writes).arg(summary.rotations).arg(summary.errors);
+}
+
+/*!
+ * Returns \c true if the file has been opened (and the writer thread started), and not yet closed.
+ */
+bool OutputFileWriter::isOpen() const
+{
+    return thread.joinable();
+}
+
+/*!
+ * Returns the name of the file being written, as passed to open().
+ */
+QString OutputFileWriter::fileName() const
+{
+    return name;
+}
+
+/*!
+ * Returns a description of the last open() failure, if any.
+ */
+QString OutputFileWriter::errorString() const
+{
+    return errorMessage;
+}
+
+/*!
+ * Sets the maximum total size of output queued for the writer thread to \a size bytes. The default is
+ * #defaultQueueSize.
+ */
+void OutputFileWriter::setQueueSize(const qint64 size)
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    queueSize = size;
+}
+
+/*!
+ * Returns the policy for writing output when the queue is full.
+ *
+ * \see setOverflowPolicy
+ */
+OutputFileWriter::OverflowPolicy OutputFileWriter::overflowPolicy() const
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    return policy;
+}
+
+/*!
+ * Sets the policy for writing output when the queue is full to \a policy. The default is OverflowPolicy::DropNewest.
+ */
+void OutputFileWriter::setOverflowPolicy(const OverflowPolicy policy)
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    this->policy = policy;
+}
+
+/*!
+ * Sets the file to be rotated once it is at least \a maxSize bytes, or \a maxAge milliseconds old, whichever comes
+ * first. Either may be 0 to disable that kind of rotation. Must be called before open().
+ */
+void OutputFileWriter::setRotation(const qint64 maxSize, const qint64 maxAge)
+{
+    Q_ASSERT(!thread.joinable());
+    rotateSize = maxSize;
+    rotateAge = maxAge;
+}
+
+/*!
+ * Queues \a bytes to be written to the file by the writer thread, and returns \c true. However, if the queue is
+ * already full, then output is dropped according to overflowPolicy(), and \c false returned instead. Only under
+ * OverflowPolicy::Block does this function ever wait for the writer thread (but even then, not for any one write).
+ *
+ * Since QByteArray is implicitly shared, callers may avoid copying \a bytes by releasing their own reference to them,
+ * such as via `write(std::exchange(buffer, QByteArray()))`.
+ */
+bool OutputFileWriter::write(const QByteArray &bytes)
+{
+    if (bytes.isEmpty()) {
+        return true;
+    }
+    bool dropped = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        const quint64 droppedBefore = stats.dropped;
+        if (makeRoom(lock, bytes.size())) {
+            queue.enqueue(bytes);
+            queuedBytes += bytes.size();
+            memory.charge(bytes.size());
+        }
+        dropped = (stats.dropped != droppedBefore);
+    }
+    wake.notify_one();
+    return !dropped;
+}
+
+/*!
+ * Returns the writer thread's effective settings, as applied per setThreadPolicy(). If no settings have been set (or
+ * the writer thread has not applied them yet), ThreadPolicy::State::applied is \c false.
+ */
+ThreadPolicy::State OutputFileWriter::threadPolicy() const
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    return threadState;
+}
+
+/*!
+ * Sets the writer thread's CPU affinity, and priority, to \a settings. The writer thread applies the settings to itself
+ * as soon as it is started (see open()), or if it is already running, once woken (which this function does).
+ */
+void OutputFileWriter::setThreadPolicy(const ThreadPolicy::Settings &settings)
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        threadSettings = settings;
+        threadSettingsPending = true;
+    }
+    wake.notify_one();
+}
+
+/*!
+ * Returns the writer's statistics so far.
+ */
+OutputFileWriter::Statistics OutputFileWriter::statistics() const
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/*!
+ * Returns the name that \a fileName is renamed to, when rotated for the \a index th time. For example,
+ * `rotatedFileName("meter.csv", 3)` returns `meter.3.csv`.
+ */
+QString OutputFileWriter::rotatedFileName(const QString &fileName, const int index)
+{
+    const QFileInfo info(fileName);
+    const QString suffix = info.suffix();
+    const QString path = fileName.left(fileName.size() - info.fileName().size());
+    return (suffix.isEmpty()) ? u"%1%2.%3"_s.arg(path, info.fileName()).arg(index)
+        : u"%1%2.%3.%4"_s.arg(path, info.completeBaseName()).arg(index).arg(suffix);
+}
+
+/*!
+ * Makes room in the queue for another \a size bytes, according to #policy, and returns \c true, or returns \c false
+ * if the new output is to be dropped instead. Any output dropped is counted in #stats. Must be called with #mutex
+ * held, via \a lock, which OverflowPolicy::Block releases while waiting.
+ *
+ * Even when full, an empty queue accepts one buffer of any size, so over-sized buffers are never dropped.
+ */
+bool OutputFileWriter::makeRoom(std::unique_lock<std::mutex> &lock, const qint64 size)
+{
+    const auto full = [this, size]() {
+        return (queuedBytes > 0) && ((queuedBytes + size > queueSize) || (!memory.fits(size)));
+    };
+    if (!full()) {
+        return true;
+    }
+    if (!memory.fits(size)) {
+        memory.countRefusal(); // The memory budget, rather than the queue size, is what's full.
+    }
+    const auto drop = [this](const qint64 bytes) {
+        ++stats.dropped;
+        stats.bytesDropped += (quint64)bytes;
+    };
+    switch (policy) {
+    case OverflowPolicy::Block:
+        if (thread.joinable()) { // Otherwise, there is no writer thread to wait for.
+            const auto started = std::chrono::steady_clock::now();
+            ++stats.blocked;
+            drained.wait(lock, [this, &full]() { return (stopping) || (!full()); });
+            stats.blockedTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - started).count();
+        }
+        return true;
+    case OverflowPolicy::DropOldest:
+        while (full()) {
+            const QByteArray oldest = queue.dequeue();
+            queuedBytes -= oldest.size();
+            memory.release(oldest.size());
+            drop(oldest.size());
+        }
+        return true;
+    case OverflowPolicy::Decimate:
+        // Drop every second queued buffer (keeping the oldest), so the queue still spans the same period of output.
+        for (qsizetype index = 1; index < queue.size(); ++index) {
+            queuedBytes -= queue.at(index).size();
+            memory.release(queue.at(index).size());
+            drop(queue.at(index).size());
+            queue.removeAt(index);
+        }
+        if (!full()) {
+            return true;
+        }
+        break; // Even the remaining buffers leave no room, so drop the new output, as per DropNewest.
+    case OverflowPolicy::DropNewest:
+        break;
+    }
+    drop(size);
+    return false;
+}
+
+/*!
+ * Runs the writer thread, until close() has been called, and the queue drained.
+ */
+void OutputFileWriter::run()
+{
+    QTPOKIT_TRACE_THREAD_NAME("outputFileWriter");
+    QByteArray chunk;
+    chunk.reserve(chunkSize);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return (stopping) || (!queue.isEmpty()) || (threadSettingsPending); });
+        if (threadSettingsPending) {
+            applyThreadPolicy(lock);
+        }
+        if (queue.isEmpty()) {
+            return; // Stopping, with nothing left to write.
+        }
+
+        // Coalesce queued output into one large write, without letting it span a rotation.
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        const bool rotateFirst = rotationDue(queue.head().size(), now);
+        const qint64 startSize = (rotateFirst) ? 0 : fileSize;
+        while ((!queue.isEmpty()) && ((chunk.isEmpty()) || ((chunk.size() + queue.head().size() <= chunkSize) &&
+               ((rotateSize == 0) || (startSize + chunk.size() + queue.head().size() <= rotateSize))))) {
+            const QByteArray bytes = queue.dequeue();
+            queuedBytes -= bytes.size();
+            memory.release(bytes.size());
+            chunk.append(bytes);
+        }
+        lock.unlock();
+        drained.notify_all();
+
+        if (rotateFirst) {
+            rotate(now);
+        }
+        writeChunk(chunk);
+        chunk.resize(0); // Unlike clear(), retains the reserved capacity.
+        lock.lock();
+    }
+}
+
+/*!
+ * Applies #threadSettings to the (calling) writer thread, and records the effective settings in #threadState. The
+ * \a lock (on #mutex) is released while applying the settings, so write() is never blocked by the OS.
+ */
+void OutputFileWriter::applyThreadPolicy(std::unique_lock<std::mutex> &lock)
+{
+    Q_ASSERT(threadSettings);
+    const ThreadPolicy::Settings settings = *threadSettings;
+    threadSettingsPending = false;
+    lock.unlock();
+    const ThreadPolicy::State state = ThreadPolicy::apply(settings);
+    for (const QString &error: state.errors) {
+        qCWarning(lc).noquote() << tr("%1 (writing %2)").arg(error, name);
+    }
+    qCDebug(lc).noquote() << tr("Writing %1 from CPUs %2, with %3 priority.").arg(name,
+        ThreadPolicy::formatCpus(state.cpus), ThreadPolicy::toString(state.priority));
+    lock.lock();
+    threadState = state;
+}
+
+/*!
+ * Returns \c true if the file should be rotated before writing another \a size bytes to it at time \a now.
+ *
+ * Empty files are never rotated, so a single write larger than the maximum size still only produces one file.
+ */
+bool OutputFileWriter::rotationDue(const qint64 size, const qint64 now) const
+{
+    return (fileSize > 0) && (((rotateSize > 0) && (fileSize + size > rotateSize)) ||
+                              ((rotateAge > 0) && (now - fileOpened >= rotateAge)));
+}
+
+/*!
+ * Renames the current file to its next rotatedFileName(), and then opens a new file in its place, at time \a now.
+ * Returns \c true on success, otherwise \c false, in which case output continues to be written to the current file
+ * (if still open).
+ */
+bool OutputFileWriter::rotate(const qint64 now)
+{
+    file->close();
+    QString rotatedName;
+    do {
+        rotatedName = rotatedFileName(name, ++rotationIndex);
+    } while (QFile::exists(rotatedName)); // Never overwrite a previous run's rotated files.
+    const bool renamed = QFile::rename(name, rotatedName);
+    if (!renamed) {
+        qCWarning(lc).noquote() << tr("Failed to rename %1 to %2.").arg(name, rotatedName);
+    }
+    if (!file->open(QIODevice::WriteOnly|QIODevice::Unbuffered|((renamed) ? QIODevice::Truncate : QIODevice::Append))) {
+        qCWarning(lc).noquote() << tr("Failed to open %1: %2").arg(name, file->errorString());
+    }
+    const std::lock_guard<std::mutex> lock(mutex);
+    if ((!renamed) || (!file->isOpen())) {
+        ++stats.errors;
+        return false;
+    }
+    qCDebug(lc).noquote() << tr("Rotated %1 to %2.").arg(name, rotatedName);
+    ++stats.rotations;
+    fileSize = 0;
+    fileOpened = now;
+    return true;
+}
+
+/*!
+ * Writes \a chunk to the file.
+ */
+void OutputFileWriter::writeChunk(const QByteArray &chunk)
+{
+    QTPOKIT_TRACE_ZONE(Output, "writeChunk");
+    const qint64 written = (file->isOpen()) ? file->write(chunk) : -1; // Unbuffered, so straight to the OS.
+    file->flush(); // Except for stdout, which is (potentially) buffered by the C runtime.
+    if (written > 0) {
+        fileSize += written;
+    }
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (written > 0) {
+        ++stats.writes;
+        stats.bytesWritten += (quint64)written;
+    }
+    if (written != chunk.size()) {
+        if (stats.errors++ == 0) { // Only log the first failure, rather than (potentially) once per batch.
+            qCWarning(lc).noquote() << tr("Failed to write to %1: %2").arg(name, file->errorString());
+        }
+    }
+}
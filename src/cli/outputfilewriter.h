@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_OUTPUTFILEWRITER_H
+#define DOKIT_OUTPUTFILEWRITER_H
+
+#include <qtpokit/memorybudget.h>
+#include <qtpokit/qtpokit_global.h>
+#include <qtpokit/threadpolicy.h>
+
+#include <QByteArray>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QQueue>
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+class QFile;
+
+QTPOKIT_USE_NAMESPACE
+
+class OutputFileWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Policies for writing output when the queue is full.
+    enum class OverflowPolicy {
+        Block,      ///< Wait for the writer thread to make room, delaying the caller (and so, notifications).
+        DropOldest, ///< Drop the oldest queued output, to make room for the new output.
+        DropNewest, ///< Drop the new output, keeping all queued output.
+        Decimate,   ///< Drop every second queued output, to make room, preserving the span of the queued output.
+    };
+
+    /// Writing statistics.
+    struct Statistics {
+        quint64 bytesWritten { 0 }; ///< Number of bytes written to the file (and its rotations).
+        quint64 writes { 0 };       ///< Number of writes to the file, each of up to #chunkSize bytes.
+        quint64 dropped { 0 };      ///< Number of write() buffers dropped (new, or queued), because the queue was full.
+        quint64 bytesDropped { 0 }; ///< Number of bytes dropped, because the queue was full.
+        quint64 blocked { 0 };      ///< Number of write() calls that waited for room, under OverflowPolicy::Block.
+        qint64 blockedTime { 0 };   ///< Total time write() calls waited for room, in nanoseconds.
+        quint64 rotations { 0 };    ///< Number of times the file has been rotated.
+        quint64 errors { 0 };       ///< Number of failed writes, or rotations.
+    };
+
+    static constexpr qint64 defaultQueueSize { 64 * 1024 * 1024 }; ///< Default maximum queued output, in bytes.
+    static constexpr qint64 chunkSize { 1024 * 1024 };              ///< Size to coalesce queued output up to.
+
+    explicit OutputFileWriter(QObject * const parent = nullptr);
+    ~OutputFileWriter() override;
+
+    bool open(const QString &fileName);
+    bool openStdout();
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+
+    void setQueueSize(const qint64 size);
+    OverflowPolicy overflowPolicy() const;
+    void setOverflowPolicy(const OverflowPolicy policy);
+    void setRotation(const qint64 maxSize, const qint64 maxAge);
+    ThreadPolicy::State threadPolicy() const;
+    void setThreadPolicy(const ThreadPolicy::Settings &settings);
+
+    bool write(const QByteArray &bytes);
+    Statistics statistics() const;
+
+    static QString rotatedFileName(const QString &fileName, const int index);
+
+private:
+    QString name;                          ///< Name of the file being written.
+    QString errorMessage;                  ///< Description of the last open() error, if any.
+    qint64 queueSize { defaultQueueSize }; ///< Maximum total size of all #queue buffers.
+    OverflowPolicy policy { OverflowPolicy::DropNewest }; ///< What write() does when #queue is full.
+    qint64 rotateSize { 0 };               ///< Size at which to rotate the file, in bytes, or 0 to never rotate.
+    qint64 rotateAge { 0 };                ///< Age at which to rotate the file, in milliseconds, or 0 to never rotate.
+
+    // Accessed only by the writer thread, once started.
+    QFile * file { nullptr };  ///< File currently being written.
+    qint64 fileSize { 0 };     ///< Number of bytes written to #file so far.
+    qint64 fileOpened { 0 };   ///< Time #file was opened, in milliseconds since the epoch.
+    int rotationIndex { 0 };   ///< Index of the most recent rotated file, if any.
+
+    MemoryBudget::Stream memory { QStringLiteral("output"), MemoryBudget::Kind::Output }; ///< Accounts for #queue.
+
+    // Guarded by #mutex.
+    mutable std::mutex mutex;          ///< Guards the queue, statistics, and stopping flag.
+    std::condition_variable wake;      ///< Signals the writer thread that #queue has output, or it is #stopping.
+    std::condition_variable drained;   ///< Signals blocked write() calls that #queue has room.
+    QQueue<QByteArray> queue;          ///< Output not yet written, oldest first.
+    qint64 queuedBytes { 0 };          ///< Total size of all #queue buffers.
+    bool stopping { false };           ///< Whether the writer thread should exit, once #queue is empty.
+    Statistics stats;                  ///< Writing statistics.
+    std::optional<ThreadPolicy::Settings> threadSettings; ///< Settings for the writer thread, if any.
+    bool threadSettingsPending { false }; ///< Whether the writer thread has yet to apply #threadSettings.
+    ThreadPolicy::State threadState;   ///< Writer thread's effective settings, once #threadSettings are applied.
+
+    std::thread thread; ///< Writer thread, while the file is open.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.output", QtInfoMsg); ///< Logging category for output files.
+
+    bool start(QFile * const file);
+    bool makeRoom(std::unique_lock<std::mutex> &lock, const qint64 size);
+    void run();
+    void applyThreadPolicy(std::unique_lock<std::mutex> &lock);
+    bool rotationDue(const qint64 size, const qint64 now) const;
+    bool rotate(const qint64 now);
+    void writeChunk(const QByteArray &chunk);
+
+    QTPOKIT_BEFRIEND_TEST(OutputFileWriter)
+};
+
+#endif // DOKIT_OUTPUTFILEWRITER_H
@@ -0,0 +1,632 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "parquetwriter.h"
+#include "loggerfetchcommand.h"
+#include "../stringliterals_p.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QtEndian>
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class ParquetWriter
+ *
+ * The ParquetWriter class writes archived Data Logger sessions to an Apache Parquet file, for offline analysis with
+ * tools such as pandas, DuckDB and Spark.
+ *
+ * Each session written becomes a single row group, with one row per sample, so readers can skip whole sessions via
+ * the row groups' statistics, and the writer only ever holds a single session's columns in memory. The schema is:
+ *
+ * Column      | Type                         | Description
+ * ----------- | ---------------------------- | -----------
+ * `timestamp` | `INT64` (`TIMESTAMP_MILLIS`) | Time the sample was logged.
+ * `session`   | `INT64` (`TIMESTAMP_MILLIS`) | Time the sample's logging session started.
+ * `mode`      | `BYTE_ARRAY` (`UTF8`)        | Session's logger mode, such as `DC voltage`.
+ * `unit`      | `BYTE_ARRAY` (`UTF8`)        | Unit of the sample's value, such as `Vdc`.
+ * `range`     | `INT32` (`UINT_8`)           | Session's (device-specific) range.
+ * `sample`    | `INT32` (`INT_16`)           | The device's raw sample.
+ * `value`     | `FLOAT`                      | The sample's value, ie the raw sample times the session's scale.
+ *
+ * All columns but `timestamp` (whose values are all distinct) are dictionary encoded, with the dictionary indexes
+ * written as per Parquet's RLE/bit-packed hybrid encoding. So the per-session columns cost a few bytes per row group,
+ * and the samples typically much less than their raw size, since logged samples tend to repeat. All pages are then
+ * GZIP compressed, which (unlike Snappy, or Zstandard) every Parquet reader supports, and Qt's own zlib can produce.
+ *
+ * The file is only valid once close() has written its footer, so an interrupted write leaves an incomplete file.
+ */
+
+namespace {
+
+/// Appends \a value to \a buffer, as an unsigned LEB128 varint.
+void appendVarint(QByteArray &buffer, quint64 value)
+{
+    while (value >= 0x80) {
+        buffer.append((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buffer.append((char)value);
+}
+
+/// Appends \a value to \a buffer, as a little-endian integer of type \a T.
+template<typename T>
+void appendLittleEndian(QByteArray &buffer, const T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    buffer.append(bytes, sizeof(bytes));
+}
+
+/// Appends \a value to \a buffer, as a little-endian IEEE 754 single-precision float.
+void appendFloat(QByteArray &buffer, const float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendLittleEndian<quint32>(buffer, bits);
+}
+
+/// Appends \a value to \a buffer, plain encoded as a Parquet `BYTE_ARRAY`, ie prefixed with its 32-bit length.
+void appendByteArray(QByteArray &buffer, const QByteArray &value)
+{
+    appendLittleEndian<quint32>(buffer, (quint32)value.size());
+    buffer.append(value);
+}
+
+/// Serialises Thrift structs, as per Thrift's compact protocol, which Parquet uses for its page headers and footer.
+class CompactWriter
+{
+public:
+    /// Compact protocol field (and list element) types.
+    enum Type : quint8 { I32 = 5, I64 = 6, Binary = 8, List = 9, Struct = 12 };
+
+    void i32(const qint16 id, const qint32 value) { field(id, I32); element(value); }
+    void i64(const qint16 id, const qint64 value) { field(id, I64); element(value); }
+    void binary(const qint16 id, const QByteArray &value) { field(id, Binary); element(value); }
+
+    /// Begins a struct field with \a id; end it with endStruct().
+    void beginStruct(const qint16 id) { field(id, Struct); beginElement(); }
+
+    /// Begins a struct list element; end it with endStruct().
+    void beginElement() { lastIds.append(lastId); lastId = 0; }
+
+    void endStruct() { buffer.append('\0'); lastId = lastIds.takeLast(); }
+
+    /// Begins a list field with \a id, of \a size elements of \a type, which must then follow.
+    void beginList(const qint16 id, const Type type, const qsizetype size)
+    {
+        field(id, List);
+        if (size < 15) {
+            buffer.append((char)((size << 4) | type));
+        } else {
+            buffer.append((char)(0xF0 | type));
+            appendVarint(buffer, (quint64)size);
+        }
+    }
+
+    void element(const qint64 value) { appendVarint(buffer, ((quint64)value << 1) ^ (quint64)(value >> 63)); }
+    void element(const QByteArray &value) { appendVarint(buffer, (quint64)value.size()); buffer.append(value); }
+
+    /// Returns the serialised (top-level) struct.
+    QByteArray finish() { buffer.append('\0'); return buffer; }
+
+private:
+    QByteArray buffer;        ///< Serialised fields so far.
+    qint16 lastId { 0 };      ///< ID of the previous field in the current struct, for delta-encoding the next.
+    QVector<qint16> lastIds;  ///< IDs of the previous fields in the enclosing structs, if any.
+
+    void field(const qint16 id, const Type type)
+    {
+        if ((id > lastId) && (id - lastId <= 15)) {
+            buffer.append((char)(((id - lastId) << 4) | type));
+        } else {
+            buffer.append((char)type);
+            element(id);
+        }
+        lastId = id;
+    }
+};
+
+constexpr qint32 gzipCodec { 2 };   ///< Parquet's `CompressionCodec` for GZIP.
+constexpr qint32 required { 0 };    ///< Parquet's `FieldRepetitionType` for required fields.
+
+}
+
+/// The file's schema, in column order.
+const ParquetWriter::Column ParquetWriter::columns[columnCount] {
+    { "timestamp", Type::Int64,     9 },  // TIMESTAMP_MILLIS
+    { "session",   Type::Int64,     9 },  // TIMESTAMP_MILLIS
+    { "mode",      Type::ByteArray, 0 },  // UTF8
+    { "unit",      Type::ByteArray, 0 },  // UTF8
+    { "range",     Type::Int32,    11 },  // UINT_8
+    { "sample",    Type::Int32,    16 },  // INT_16
+    { "value",     Type::Float,    -1 },
+};
+
+/*!
+ * Constructs a new Parquet writer with \a parent. Call open() to set the file to write, before writing any sessions.
+ */
+ParquetWriter::ParquetWriter(QObject * const parent) : QObject(parent)
+{
+
+}
+
+/*!
+ * Destroys this writer, after closing the file (and so writing its footer) if still open.
+ */
+ParquetWriter::~ParquetWriter()
+{
+    close();
+}
+
+/*!
+ * Creates (or truncates) \a fileName, for writing sessions to. Returns \c true on success, otherwise sets errorString()
+ * and returns \c false.
+ */
+bool ParquetWriter::open(const QString &fileName)
+{
+    close();
+    errorMessage.clear();
+    stats = Statistics{};
+    file = new QFile(fileName, this);
+    if (!file->open(QIODevice::WriteOnly|QIODevice::Truncate)) {
+        const QString reason = file->errorString();
+        delete file;
+        file = nullptr;
+        return fail(tr("Failed to open %1: %2").arg(fileName, reason));
+    }
+    if (file->write("PAR1", 4) != 4) {
+        return fail(tr("Failed to write to %1: %2").arg(fileName, file->errorString()));
+    }
+    return true;
+}
+
+/*!
+ * Returns \c true if a file is open for writing, otherwise \c false.
+ */
+bool ParquetWriter::isOpen() const
+{
+    return (file != nullptr);
+}
+
+/*!
+ * Returns the name of the file being written, or a null string if none.
+ */
+QString ParquetWriter::fileName() const
+{
+    return (file == nullptr) ? QString() : file->fileName();
+}
+
+/*!
+ * Returns a description of the last error, if any.
+ */
+QString ParquetWriter::errorString() const
+{
+    return errorMessage;
+}
+
+/*!
+ * Returns this writer's statistics for the current (or last closed) file.
+ */
+ParquetWriter::Statistics ParquetWriter::statistics() const
+{
+    return stats;
+}
+
+/*!
+ * Sets the \a name of the archive being converted, which is recorded in the file's key-value metadata (as
+ * `dokit.archive`).
+ */
+void ParquetWriter::setSourceName(const QString &name)
+{
+    sourceName = name;
+}
+
+/*!
+ * Writes \a samples of archived \a session as a new row group. Returns \c true on success, otherwise sets
+ * errorString() and returns \c false.
+ *
+ * Sessions without any samples are skipped, since they would have no rows.
+ */
+bool ParquetWriter::write(const LoggerArchive::Session &session, const DataLoggerService::Samples &samples)
+{
+    if (file == nullptr) {
+        return fail(tr("No Parquet file open"));
+    }
+    if (samples.isEmpty()) {
+        return true;
+    }
+    const int count = (int)samples.size();
+    const qint64 firstTimestamp = (qint64)session.firstTimestamp;
+    const qint64 interval = session.metadata.updateInterval;
+    RowGroup group;
+    group.numRows = count;
+    group.chunks.resize(columnCount);
+
+    // Timestamps are all distinct, so would gain nothing from a dictionary.
+    QByteArray timestamps;
+    timestamps.reserve(count * (int)sizeof(qint64));
+    for (int index = 0; index < count; ++index) {
+        appendLittleEndian<qint64>(timestamps, firstTimestamp + (index * interval));
+    }
+    appendLittleEndian<qint64>(group.chunks[0].minValue, firstTimestamp);
+    appendLittleEndian<qint64>(group.chunks[0].maxValue, firstTimestamp + ((count - 1) * interval));
+    if (!writeChunk(group.chunks[0], QByteArray(), 0, timestamps, Encoding::Plain, count)) {
+        return false;
+    }
+
+    // The session's own properties are the same for every row, so each is a single-entry dictionary, and a single run.
+    const QByteArray constant = encodeIndexes(QVector<quint32>(count, 0), bitWidth(0));
+    const QByteArray mode = DataLoggerService::toString(session.metadata.mode).toUtf8();
+    const QByteArray unit = LoggerFetchCommand::toUnit(session.metadata.mode).toUtf8();
+    QByteArray dictionaries[4];
+    appendLittleEndian<qint64>(dictionaries[0], (qint64)session.metadata.timestamp * 1000);
+    appendByteArray(dictionaries[1], mode);
+    appendByteArray(dictionaries[2], unit);
+    appendLittleEndian<qint32>(dictionaries[3], session.metadata.range);
+    for (int column = 1; column <= 4; ++column) {
+        Chunk &chunk = group.chunks[column];
+        chunk.minValue = chunk.maxValue = (columns[column].type == Type::ByteArray)
+            ? dictionaries[column - 1].mid((int)sizeof(quint32)) // Statistics omit the length prefix.
+            : dictionaries[column - 1];
+        if (!writeChunk(chunk, dictionaries[column - 1], 1, constant, Encoding::RleDictionary, count)) {
+            return false;
+        }
+    }
+
+    // The raw samples, and so their values, share a single dictionary of the distinct samples, in order of appearance.
+    QHash<qint16, quint32> lookup;
+    QVector<qint16> distinct;
+    QVector<quint32> indexes;
+    indexes.reserve(count);
+    qint16 minSample = samples.constFirst(), maxSample = samples.constFirst();
+    for (const qint16 sample: samples) {
+        auto iter = lookup.constFind(sample);
+        if (iter == lookup.constEnd()) {
+            iter = lookup.insert(sample, (quint32)distinct.size());
+            distinct.append(sample);
+        }
+        indexes.append(iter.value());
+        minSample = qMin(minSample, sample);
+        maxSample = qMax(maxSample, sample);
+    }
+    const float scale = session.metadata.scale;
+    QByteArray sampleDictionary, valueDictionary;
+    for (const qint16 sample: std::as_const(distinct)) {
+        appendLittleEndian<qint32>(sampleDictionary, sample);
+        appendFloat(valueDictionary, sample * scale);
+    }
+    const QByteArray sampleIndexes = encodeIndexes(indexes, bitWidth((quint32)distinct.size() - 1));
+    appendLittleEndian<qint32>(group.chunks[5].minValue, minSample);
+    appendLittleEndian<qint32>(group.chunks[5].maxValue, maxSample);
+    appendFloat(group.chunks[6].minValue, qMin(minSample * scale, maxSample * scale)); // Scales may be negative.
+    appendFloat(group.chunks[6].maxValue, qMax(minSample * scale, maxSample * scale));
+    if ((!writeChunk(group.chunks[5], sampleDictionary, (int)distinct.size(), sampleIndexes, Encoding::RleDictionary,
+                     count)) ||
+        (!writeChunk(group.chunks[6], valueDictionary, (int)distinct.size(), sampleIndexes, Encoding::RleDictionary,
+                     count))) {
+        return false;
+    }
+
+    for (const Chunk &chunk: std::as_const(group.chunks)) {
+        group.totalByteSize += chunk.uncompressedSize;
+    }
+    rowGroups.append(group);
+    stats.rows += count;
+    ++stats.rowGroups;
+    return true;
+}
+
+/*!
+ * Writes the file's footer, and closes it. Returns \c true on success, or if no file was open, otherwise sets
+ * errorString() and returns \c false.
+ */
+bool ParquetWriter::close()
+{
+    if (file == nullptr) {
+        return true;
+    }
+    const QByteArray metadata = fileMetaData();
+    QByteArray footer = metadata;
+    appendLittleEndian<quint32>(footer, (quint32)metadata.size());
+    footer.append("PAR1", 4);
+    const bool written = (file->write(footer) == footer.size()) && (file->flush());
+    if (written) {
+        stats.bytes = file->size();
+        qCDebug(lc).noquote() << tr("Wrote %Ln row group(s), of %L1 row(s), to %2.", nullptr, (int)stats.rowGroups)
+            .arg(stats.rows).arg(file->fileName());
+    } else {
+        fail(tr("Failed to write to %1: %2").arg(file->fileName(), file->errorString()));
+    }
+    file->close();
+    delete file;
+    file = nullptr;
+    rowGroups.clear();
+    return written;
+}
+
+/*!
+ * Writes a column chunk of \a numValues \a values (a data page's body, as per \a encoding), preceded by a dictionary
+ * page of \a dictionarySize plain encoded \a dictionary values, unless \a dictionary is empty, and records where in
+ * \a chunk.
+ */
+bool ParquetWriter::writeChunk(Chunk &chunk, const QByteArray &dictionary, const int dictionarySize,
+                               const QByteArray &values, const Encoding encoding, const int numValues)
+{
+    chunk.numValues = numValues;
+    chunk.encodings = { Encoding::Plain, Encoding::Rle };
+    if (!dictionary.isEmpty()) {
+        chunk.encodings.append(Encoding::RleDictionary);
+        chunk.dictionaryPageOffset = file->pos();
+        const QByteArray page = gzip(dictionary);
+        const QByteArray header = pageHeader(true, dictionarySize, Encoding::Plain, dictionary.size(), page.size());
+        if (!writePage(header, page)) {
+            return false;
+        }
+        chunk.uncompressedSize += header.size() + dictionary.size();
+        chunk.compressedSize += header.size() + page.size();
+    }
+    chunk.dataPageOffset = file->pos();
+    const QByteArray page = gzip(values);
+    const QByteArray header = pageHeader(false, numValues, encoding, values.size(), page.size());
+    if (!writePage(header, page)) {
+        return false;
+    }
+    chunk.uncompressedSize += header.size() + values.size();
+    chunk.compressedSize += header.size() + page.size();
+    return true;
+}
+
+/*!
+ * Writes a page's \a header, then the \a page itself. Returns \c true on success, otherwise sets errorString() and
+ * returns \c false.
+ */
+bool ParquetWriter::writePage(const QByteArray &header, const QByteArray &page)
+{
+    if ((file->write(header) != header.size()) || (file->write(page) != page.size())) {
+        return fail(tr("Failed to write to %1: %2").arg(file->fileName(), file->errorString()));
+    }
+    return true;
+}
+
+/*!
+ * Sets errorString() to \a message, and returns \c false (for the convenience of callers).
+ */
+bool ParquetWriter::fail(const QString &message)
+{
+    qCDebug(lc).noquote() << message;
+    errorMessage = message;
+    return false;
+}
+
+/*!
+ * Returns the file's footer, ie the Thrift (compact protocol) serialised `FileMetaData` struct, describing the schema
+ * and every row group written.
+ */
+QByteArray ParquetWriter::fileMetaData() const
+{
+    CompactWriter writer;
+    writer.i32(1, 1); // Format version.
+
+    writer.beginList(2, CompactWriter::Struct, 1 + columnCount);
+    writer.beginElement(); // The schema's root.
+    writer.binary(4, "schema");
+    writer.i32(5, columnCount);
+    writer.endStruct();
+    for (const Column &column: columns) {
+        writer.beginElement();
+        writer.i32(1, (qint32)column.type);
+        writer.i32(3, required);
+        writer.binary(4, column.name);
+        if (column.convertedType >= 0) {
+            writer.i32(6, column.convertedType);
+        }
+        writer.endStruct();
+    }
+
+    writer.i64(3, (qint64)stats.rows);
+
+    writer.beginList(4, CompactWriter::Struct, rowGroups.size());
+    for (const RowGroup &group: rowGroups) {
+        writer.beginElement();
+        writer.beginList(1, CompactWriter::Struct, group.chunks.size());
+        qint64 compressedSize = 0;
+        for (int column = 0; column < group.chunks.size(); ++column) {
+            const Chunk &chunk = group.chunks.at(column);
+            const qint64 offset = (chunk.dictionaryPageOffset < 0) ? chunk.dataPageOffset : chunk.dictionaryPageOffset;
+            compressedSize += chunk.compressedSize;
+            writer.beginElement();
+            writer.i64(2, offset);
+            writer.beginStruct(3); // ColumnMetaData
+            writer.i32(1, (qint32)columns[column].type);
+            writer.beginList(2, CompactWriter::I32, chunk.encodings.size());
+            for (const Encoding encoding: chunk.encodings) {
+                writer.element((qint32)encoding);
+            }
+            writer.beginList(3, CompactWriter::Binary, 1);
+            writer.element(QByteArray(columns[column].name));
+            writer.i32(4, gzipCodec);
+            writer.i64(5, chunk.numValues);
+            writer.i64(6, chunk.uncompressedSize);
+            writer.i64(7, chunk.compressedSize);
+            writer.i64(9, chunk.dataPageOffset);
+            if (chunk.dictionaryPageOffset >= 0) {
+                writer.i64(11, chunk.dictionaryPageOffset);
+            }
+            if (!chunk.minValue.isEmpty()) {
+                writer.beginStruct(12); // Statistics
+                writer.binary(5, chunk.maxValue);
+                writer.binary(6, chunk.minValue);
+                writer.endStruct();
+            }
+            writer.endStruct();
+            writer.endStruct();
+        }
+        writer.i64(2, group.totalByteSize);
+        writer.i64(3, group.numRows);
+        const Chunk &first = group.chunks.constFirst();
+        writer.i64(5, (first.dictionaryPageOffset < 0) ? first.dataPageOffset : first.dictionaryPageOffset);
+        writer.i64(6, compressedSize);
+        writer.endStruct();
+    }
+
+    if (!sourceName.isEmpty()) {
+        writer.beginList(5, CompactWriter::Struct, 1);
+        writer.beginElement(); // KeyValue
+        writer.binary(1, "dokit.archive");
+        writer.binary(2, sourceName.toUtf8());
+        writer.endStruct();
+    }
+
+    writer.binary(6, u"%1 version %2"_s.arg(QCoreApplication::applicationName(),
+                                            QCoreApplication::applicationVersion()).toUtf8());
+    return writer.finish();
+}
+
+/*!
+ * Returns a Thrift serialised `PageHeader` for a \a dictionary (or else, data) page of \a numValues values, encoded
+ * as per \a encoding, that is \a uncompressedSize bytes, compressed to \a compressedSize.
+ */
+QByteArray ParquetWriter::pageHeader(const bool dictionary, const int numValues, const Encoding encoding,
+                                     const qsizetype uncompressedSize, const qsizetype compressedSize)
+{
+    CompactWriter writer;
+    writer.i32(1, (dictionary) ? 2 : 0); // DICTIONARY_PAGE, or DATA_PAGE.
+    writer.i32(2, (qint32)uncompressedSize);
+    writer.i32(3, (qint32)compressedSize);
+    if (dictionary) {
+        writer.beginStruct(7); // DictionaryPageHeader
+        writer.i32(1, numValues);
+        writer.i32(2, (qint32)encoding);
+    } else {
+        writer.beginStruct(5); // DataPageHeader
+        writer.i32(1, numValues);
+        writer.i32(2, (qint32)encoding);
+        writer.i32(3, (qint32)Encoding::Rle); // Definition levels (none, since all columns are required).
+        writer.i32(4, (qint32)Encoding::Rle); // Repetition levels (none, since no columns are repeated).
+    }
+    writer.endStruct();
+    return writer.finish();
+}
+
+/*!
+ * Returns dictionary \a indexes, encoded for a data page, ie a single byte of the indexes' bit \a width, followed by
+ * the indexes, each \a width bits, as per Parquet's RLE/bit-packed hybrid encoding.
+ *
+ * Runs of eight or more repeated indexes are run-length encoded, and the rest bit-packed, in groups of eight. Since
+ * only the last group may be padded, any indexes waiting to be bit-packed are first topped up to a whole group from
+ * the start of the next run.
+ */
+QByteArray ParquetWriter::encodeIndexes(const QVector<quint32> &indexes, const int width)
+{
+    QByteArray data(1, (char)width);
+    QVector<quint32> literals;
+    const auto flushLiterals = [&data, &literals, width]() {
+        if (literals.isEmpty()) {
+            return;
+        }
+        const qsizetype groups = (literals.size() + 7) / 8;
+        literals.resize(groups * 8);
+        appendVarint(data, ((quint64)groups << 1) | 1);
+        quint64 buffer = 0;
+        int bits = 0;
+        for (const quint32 literal: std::as_const(literals)) {
+            buffer |= (quint64)literal << bits;
+            for (bits += width; bits >= 8; bits -= 8) {
+                data.append((char)(buffer & 0xFF));
+                buffer >>= 8;
+            }
+        }
+        literals.clear(); // Groups of eight values always fill whole bytes, so no bits remain.
+    };
+
+    for (qsizetype index = 0; index < indexes.size();) {
+        qsizetype run = 1;
+        while ((index + run < indexes.size()) && (indexes.at(index + run) == indexes.at(index))) {
+            ++run;
+        }
+        const qsizetype topUp = qMin(run, (8 - (literals.size() % 8)) % 8);
+        for (qsizetype count = 0; count < topUp; ++count) {
+            literals.append(indexes.at(index));
+        }
+        index += topUp;
+        run -= topUp;
+        if (run >= 8) {
+            flushLiterals();
+            appendVarint(data, (quint64)run << 1);
+            for (int byte = 0; byte < (width + 7) / 8; ++byte) {
+                data.append((char)((indexes.at(index) >> (byte * 8)) & 0xFF));
+            }
+        } else {
+            for (qsizetype count = 0; count < run; ++count) {
+                literals.append(indexes.at(index));
+            }
+        }
+        index += run;
+    }
+    flushLiterals();
+    return data;
+}
+
+/*!
+ * Returns the number of bits needed to represent \a maxValue, and so every dictionary index up to it. This is at
+ * least 1, since not all Parquet readers accept zero-width indexes.
+ */
+int ParquetWriter::bitWidth(const quint32 maxValue)
+{
+    int bits = 1;
+    while ((bits < 32) && ((maxValue >> bits) != 0)) {
+        ++bits;
+    }
+    return bits;
+}
+
+/*!
+ * Returns \a data, GZIP compressed.
+ *
+ * qCompress() produces a zlib stream, prefixed with the (big-endian) uncompressed size. A GZIP stream wraps the same
+ * (raw) deflate data, so this swaps that prefix, the zlib header, and the stream's Adler-32 trailer, for a minimal
+ * GZIP header, and the CRC-32 and size trailer.
+ */
+QByteArray ParquetWriter::gzip(const QByteArray &data)
+{
+    const QByteArray zlib = qCompress(data);
+    QByteArray result("\x1F\x8B\x08\x00\x00\x00\x00\x00\x00\xFF", 10); // Deflate, no flags or time, unknown OS.
+    if (zlib.size() < 10) {
+        result.append("\x03\x00", 2); // qCompress() returns only the size prefix for empty data.
+    } else {
+        result.append(zlib.constData() + 6, zlib.size() - 10);
+    }
+    appendLittleEndian<quint32>(result, crc32(data));
+    appendLittleEndian<quint32>(result, (quint32)data.size());
+    return result;
+}
+
+/*!
+ * Returns the (ISO-HDLC, as used by GZIP) CRC-32 of \a data.
+ */
+quint32 ParquetWriter::crc32(const QByteArray &data)
+{
+    static const std::array<quint32, 256> table = []() {
+        std::array<quint32, 256> table{};
+        for (quint32 index = 0; index < table.size(); ++index) {
+            quint32 crc = index;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (0xEDB88320 ^ (crc >> 1)) : (crc >> 1);
+            }
+            table[index] = crc;
+        }
+        return table;
+    }();
+    quint32 crc = 0xFFFFFFFF;
+    for (const char byte: data) {
+        crc = table[(crc ^ (quint8)byte) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_PARQUETWRITER_H
+#define DOKIT_PARQUETWRITER_H
+
+#include <qtpokit/loggerarchive.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+#include <QVector>
+
+class QFile;
+
+QTPOKIT_USE_NAMESPACE
+
+class ParquetWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Writing statistics.
+    struct Statistics {
+        quint64 rows { 0 };      ///< Number of rows (samples) written.
+        quint64 rowGroups { 0 }; ///< Number of row groups (sessions) written.
+        qint64 bytes { 0 };      ///< Size of the file written, in bytes, once closed.
+    };
+
+    explicit ParquetWriter(QObject * const parent = nullptr);
+    ~ParquetWriter() override;
+
+    bool open(const QString &fileName);
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+    Statistics statistics() const;
+
+    void setSourceName(const QString &name);
+    bool write(const LoggerArchive::Session &session, const DataLoggerService::Samples &samples);
+    bool close();
+
+private:
+    /// Parquet physical types, as per the format's `Type` enum.
+    enum class Type : qint32 { Int32 = 1, Int64 = 2, Float = 4, ByteArray = 6 };
+
+    /// Parquet value encodings, as per the format's `Encoding` enum.
+    enum class Encoding : qint32 { Plain = 0, Rle = 3, RleDictionary = 8 };
+
+    /// A single (required, top-level) column of the file's schema.
+    struct Column {
+        const char * name;         ///< Column name.
+        Type type;                 ///< Physical type.
+        qint32 convertedType;      ///< Converted (logical) type, as per the format's `ConvertedType` enum, or -1.
+    };
+
+    /// Where, and how, a column chunk was written, for the file's footer.
+    struct Chunk {
+        QVector<Encoding> encodings;        ///< Encodings used by the chunk's pages.
+        qint64 numValues { 0 };             ///< Number of values in the chunk.
+        qint64 uncompressedSize { 0 };      ///< Total size of the chunk's pages (including headers), uncompressed.
+        qint64 compressedSize { 0 };        ///< Total size of the chunk's pages (including headers), as written.
+        qint64 dataPageOffset { 0 };        ///< File offset of the chunk's data page.
+        qint64 dictionaryPageOffset { -1 }; ///< File offset of the chunk's dictionary page, or -1 if none.
+        QByteArray minValue;                ///< Minimum value, plain encoded, or empty if not known.
+        QByteArray maxValue;                ///< Maximum value, plain encoded, or empty if not known.
+    };
+
+    /// A row group (ie one archived session) written, for the file's footer.
+    struct RowGroup {
+        QVector<Chunk> chunks;              ///< Column chunks, in schema order.
+        qint64 numRows { 0 };               ///< Number of rows in the row group.
+        qint64 totalByteSize { 0 };         ///< Total uncompressed size of the row group's column chunks.
+    };
+
+    static constexpr int columnCount { 7 }; ///< Number of columns in the file's schema.
+    static const Column columns[columnCount]; ///< The file's schema.
+
+    QFile * file { nullptr };               ///< File being written, if any.
+    QString sourceName;                     ///< Name of the archive the rows were read from, for the file's metadata.
+    QVector<RowGroup> rowGroups;            ///< Row groups written to #file so far.
+    QString errorMessage;                   ///< Description of the last error, if any.
+    Statistics stats;                       ///< Writing statistics.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.parquet", QtInfoMsg); ///< Logging category for Parquet files.
+
+    bool writeChunk(Chunk &chunk, const QByteArray &dictionary, const int dictionarySize, const QByteArray &values,
+                    const Encoding encoding, const int numValues);
+    bool writePage(const QByteArray &header, const QByteArray &page);
+    bool fail(const QString &message);
+    QByteArray fileMetaData() const;
+
+    static QByteArray pageHeader(const bool dictionary, const int numValues, const Encoding encoding,
+                                 const qsizetype uncompressedSize, const qsizetype compressedSize);
+    static QByteArray encodeIndexes(const QVector<quint32> &indexes, const int width);
+    static int bitWidth(const quint32 maxValue);
+    static QByteArray gzip(const QByteArray &data);
+    static quint32 crc32(const QByteArray &data);
+
+    QTPOKIT_BEFRIEND_TEST(ParquetWriter)
+};
+
+#endif // DOKIT_PARQUETWRITER_H
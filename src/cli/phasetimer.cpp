@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "phasetimer.h"
+#include "../stringliterals_p.h"
+
+#include <algorithm>
+#include <chrono>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class PhaseTimer
+ *
+ * The PhaseTimer class records how long the CLI takes to reach each phase of its startup, from the application's
+ * launch to its first output (such as the `meter` command's first printed reading), for the `timings` option.
+ *
+ * Each phase is recorded only the first time it is reached (for example, only the first of the `session` command's
+ * service discoveries), and only once start() has been called, so mark() is cheap enough to call on every code path
+ * that reaches a phase. Phases are recorded via the same steady clock as PokitTrace events, so the two may be
+ * compared directly.
+ *
+ * PhaseTimer is not thread-safe, so phases should only be marked from the main (event loop) thread.
+ */
+
+qint64 PhaseTimer::started { -1 };
+std::array<qint64, PhaseTimer::phaseCount> PhaseTimer::marks { };
+
+/*!
+ * Starts timing, from now, discarding any phases recorded previously. This should be called as early as possible,
+ * such as at the very start of `main()`.
+ */
+void PhaseTimer::start()
+{
+    marks.fill(-1);
+    started = now();
+}
+
+/*!
+ * Returns \c true if start() has been called (and reset() not called since).
+ */
+bool PhaseTimer::isStarted()
+{
+    return started >= 0;
+}
+
+/*!
+ * Stops timing, and discards all recorded phases.
+ */
+void PhaseTimer::reset()
+{
+    marks.fill(-1);
+    started = -1;
+}
+
+/*!
+ * Records that \a phase has been reached, unless it has been reached already, or start() has not been called.
+ */
+void PhaseTimer::mark(const Phase phase)
+{
+    if ((started < 0) || (marks.at((size_t)phase) >= 0)) {
+        return;
+    }
+    marks[(size_t)phase] = now();
+    qCDebug(lc).noquote() << tr("Reached %1 phase after %L2ms.").arg(toString(phase))
+        .arg((double)(marks.at((size_t)phase) - started) / 1e6, 0, 'f', 3);
+}
+
+/*!
+ * Returns the time taken to reach \a phase, in nanoseconds since start(), or -1 if \a phase has not been reached.
+ */
+qint64 PhaseTimer::elapsed(const Phase phase)
+{
+    const qint64 mark = marks.at((size_t)phase);
+    return ((started < 0) || (mark < 0)) ? -1 : mark - started;
+}
+
+/*!
+ * Returns \a phase as a (non-translated) string, suitable for machine-readable output.
+ */
+QString PhaseTimer::toString(const Phase phase)
+{
+    switch (phase) {
+    case Phase::Application:     return u"application"_s;
+    case Phase::Translations:    return u"translations"_s;
+    case Phase::Options:         return u"options"_s;
+    case Phase::Command:         return u"command"_s;
+    case Phase::DeviceFound:     return u"device-found"_s;
+    case Phase::Connected:       return u"connected"_s;
+    case Phase::Discovered:      return u"discovered"_s;
+    case Phase::SettingsWritten: return u"settings-written"_s;
+    case Phase::FirstOutput:     return u"first-output"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Returns a report of the phases reached so far, one per line, in the order they were reached. Each line gives the
+ * time the phase was reached since start(), and since the previous phase, in milliseconds, followed by the phase.
+ *
+ * Phases not reached (such as `device-found`, for commands that need no device) are omitted.
+ */
+QString PhaseTimer::report()
+{
+    std::array<Phase, phaseCount> phases;
+    int count = 0;
+    for (int index = 0; index < phaseCount; ++index) {
+        if (elapsed((Phase)index) >= 0) {
+            phases[(size_t)count++] = (Phase)index;
+        }
+    }
+    std::stable_sort(phases.begin(), phases.begin() + count, [](const Phase lhs, const Phase rhs) {
+        return elapsed(lhs) < elapsed(rhs);
+    });
+
+    QString report = u"# elapsed(ms) delta(ms) phase\n"_s;
+    qint64 previous = 0;
+    for (int index = 0; index < count; ++index) {
+        const qint64 elapsed = PhaseTimer::elapsed(phases.at((size_t)index));
+        report += u"%1 %2 %3\n"_s.arg((double)elapsed / 1e6, 12, 'f', 3)
+            .arg((double)(elapsed - previous) / 1e6, 9, 'f', 3).arg(toString(phases.at((size_t)index)));
+        previous = elapsed;
+    }
+    return report;
+}
+
+/*!
+ * Returns the current steady clock time, in nanoseconds.
+ */
+qint64 PhaseTimer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
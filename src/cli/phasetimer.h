@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_PHASETIMER_H
+#define DOKIT_PHASETIMER_H
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <QString>
+
+#include <array>
+
+class PhaseTimer
+{
+    Q_DECLARE_TR_FUNCTIONS(PhaseTimer)
+
+public:
+    /// Phases of the CLI's startup, in the order they are normally reached.
+    enum class Phase : quint8 {
+        Application,     ///< QCoreApplication constructed.
+        Translations,    ///< Translators loaded, and installed.
+        Options,         ///< Command line parsed, and logging configured.
+        Command,         ///< Command constructed, and its options processed.
+        DeviceFound,     ///< Device found by scanning, or known already (see the `known-devices` option).
+        Connected,       ///< Controller connected to the device.
+        Discovered,      ///< Service details discovered.
+        SettingsWritten, ///< Command's settings written to the device.
+        FirstOutput,     ///< First output written to stdout, or queued for the output file.
+    };
+    static constexpr int phaseCount { (int)Phase::FirstOutput + 1 }; ///< Number of Phase enum values.
+
+    static void start();
+    static bool isStarted();
+    static void reset();
+
+    static void mark(const Phase phase);
+    static qint64 elapsed(const Phase phase);
+
+    static QString toString(const Phase phase);
+    static QString report();
+
+private:
+    static qint64 started;                         ///< Steady clock time start() was called, in nanoseconds.
+    static std::array<qint64, phaseCount> marks;   ///< Steady clock time each Phase was reached, or -1 if not yet.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.timings", QtInfoMsg); ///< Logging category for phase timings.
+
+    static qint64 now();
+
+    QTPOKIT_BEFRIEND_TEST(PhaseTimer)
+};
+
+#endif // DOKIT_PHASETIMER_H
@@ -0,0 +1,424 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "querycommand.h"
+#include "exportcommand.h"
+#include "loggerfetchcommand.h"
+#include "shardedworkerpool.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/loggerrollup.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+
+#include <algorithm>
+#include <utility>
+
+// Qt 6.5.0 added new QDateTime::fromSecsSinceEpoch() and fromMSecsSinceEpoch()
+// overloads, then Qt 6.6.0 deprecated some of of the older ones.
+#if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
+    #define DOKIT_QT_UTC Qt::UTC
+#else
+    #include <QTimeZone>
+    #define DOKIT_QT_UTC QTimeZone::UTC
+#endif
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class QueryCommand
+ *
+ * The QueryCommand class implements the `query` CLI command, summarising the samples of logger archives (see
+ * LoggerArchive) within a time range, without first extracting (or exporting) them.
+ *
+ * Each `--archive` may be an archive file, or a directory of them (see ExportCommand::findArchives()). For each
+ * archive, and measurement mode, the command outputs the count, minimum, maximum and mean of the samples logged
+ * between `--from` and `--to`, or with `--aggregate`, a downsampled series of those aggregates, in buckets of the given
+ * period (aligned to the epoch).
+ *
+ * Each archive's time index is used to seek to just the session runs that overlap the time range, and only those runs'
+ * samples are then scanned, directly from the memory-mapped archive. Where an archive has an up-to-date rollup (see
+ * LoggerRollup, and CompactCommand), whole rollup buckets are merged instead of scanning their samples. Archives (which
+ * are typically one per device) are queried concurrently, on a ShardedWorkerPool of `--workers` threads (one per core,
+ * by default), with one shard per archive. Results are output once all archives have been queried, in command line
+ * (then file name) order.
+ */
+
+/*!
+ * Construct a new QueryCommand object with \a parent.
+ */
+QueryCommand::QueryCommand(QObject * const parent) : AbstractCommand(parent)
+{
+
+}
+
+QStringList QueryCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::requiredOptions(parser) + QStringList{
+        u"archive"_s,
+    };
+}
+
+QStringList QueryCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"aggregate"_s,
+        u"from"_s,
+        u"time-format"_s,
+        u"to"_s,
+        u"workers"_s,
+    };
+}
+
+/*!
+ * \copybrief AbstractCommand::processOptions
+ *
+ * This implementation extends AbstractCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList QueryCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = AbstractCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    // Parse the from and to options.
+    if ((parser.isSet(u"from"_s)) && (!parseTime(parser.value(u"from"_s), from))) {
+        errors.append(tr("Invalid from value: %1").arg(parser.value(u"from"_s)));
+    }
+    if ((parser.isSet(u"to"_s)) && (!parseTime(parser.value(u"to"_s), to))) {
+        errors.append(tr("Invalid to value: %1").arg(parser.value(u"to"_s)));
+    }
+    if (from > to) {
+        errors.append(tr("The from time must not be after the to time"));
+    }
+
+    // Parse the aggregate option.
+    if (parser.isSet(u"aggregate"_s)) {
+        const QString value = parser.value(u"aggregate"_s);
+        bucketWidth = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (bucketWidth == 0) {
+            errors.append(tr("Invalid aggregate value: %1").arg(value));
+        }
+    }
+
+    // Parse the time format option.
+    if (parser.isSet(u"time-format"_s)) {
+        const QString timeFormat = parser.value(u"time-format"_s).trimmed().toLower();
+        if (timeFormat == u"iso"_s) {
+            epochTimestamps = false;
+        } else if (timeFormat == u"epoch"_s) {
+            epochTimestamps = true;
+        } else {
+            errors.append(tr("Unknown time format: %1").arg(parser.value(u"time-format"_s)));
+        }
+    }
+
+    // Parse the workers option.
+    if (parser.isSet(u"workers"_s)) {
+        const QString value = parser.value(u"workers"_s).trimmed();
+        bool ok = (value.compare(u"auto"_s, Qt::CaseInsensitive) == 0);
+        threads = (ok) ? 0 : value.toInt(&ok); // 0 for one thread per core.
+        if ((!ok) || (threads < 0)) {
+            errors.append(tr("Invalid workers value: %1").arg(parser.value(u"workers"_s)));
+        }
+    }
+
+    // Parse the archive option/s.
+    queries.clear();
+    for (const QString &path: parser.values(u"archive"_s)) {
+        if (!QFileInfo::exists(path)) {
+            errors.append(tr("Archive does not exist: %1").arg(path));
+            continue;
+        }
+        const QStringList archives = ExportCommand::findArchives(path);
+        if (archives.isEmpty()) {
+            errors.append(tr("No archives found in %1").arg(path));
+        }
+        for (const QString &archive: archives) {
+            queries.append({ archive, QString(), 0, { } });
+        }
+    }
+    return errors;
+}
+
+/*!
+ * Begins querying the archives, on the worker threads, and returns \c true. The results are output, and the command
+ * exits, once all of the archives have been queried (or failed to be).
+ */
+bool QueryCommand::start()
+{
+    finished = 0;
+    workers = new ShardedWorkerPool(threads, this);
+    connect(workers, &ShardedWorkerPool::outputReady, this,
+            [this](const int shard, const QByteArray &) { queryFinished(shard); });
+    qCInfo(lc).noquote() << tr("Querying %Ln archive(s).", nullptr, (int)queries.size());
+
+    // Each job writes only its own query, which is not read here again until the job's completion is delivered.
+    for (int index = 0; index < queries.size(); ++index) {
+        Query * const item = &queries[index];
+        workers->submit(index, [item, from = this->from, to = this->to, width = bucketWidth]() {
+            item->error = query(item->archive, from, to, width, item->sessions, item->series);
+            return QByteArray();
+        });
+    }
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonOutput
+ *
+ * This override returns \c true, since downsampled series may include many thousands of buckets.
+ */
+bool QueryCommand::supportsNdjsonOutput() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscovered
+ *
+ * This override does nothing, since this command never scans for devices.
+ */
+void QueryCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    Q_UNUSED(info)
+}
+
+/*!
+ * \copybrief AbstractCommand::deviceDiscoveryFinished
+ *
+ * This override does nothing, since this command never scans for devices.
+ */
+void QueryCommand::deviceDiscoveryFinished()
+{
+
+}
+
+/*!
+ * Reports the completion of the query at \a index, and once all queries have finished, outputs their results, and
+ * exits.
+ */
+void QueryCommand::queryFinished(const int index)
+{
+    const Query &item = queries.at(index);
+    if (item.error.isEmpty()) {
+        qCDebug(lc).noquote() << tr("Queried %Ln session(s) of %1.", nullptr, (int)item.sessions).arg(item.archive);
+    } else {
+        qCWarning(lc).noquote() << tr("Failed to query %1: %2").arg(item.archive, item.error);
+    }
+    if (++finished < queries.size()) {
+        return;
+    }
+    outputResults();
+    const auto failures = std::count_if(queries.cbegin(), queries.cend(),
+        [](const Query &item) { return !item.error.isEmpty(); });
+    if (failures > 0) {
+        qCWarning(lc).noquote() << tr("Failed to query %Ln of %1 archive(s).", nullptr, (int)failures)
+            .arg(queries.size());
+    }
+    QCoreApplication::exit((failures > 0) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*!
+ * Outputs the results of all successful #queries, in the selected output format.
+ */
+void QueryCommand::outputResults()
+{
+    bool showCsvHeader = true;
+    for (const Query &item: std::as_const(queries)) {
+        const QString archive = QFileInfo(item.archive).fileName();
+        for (const Series &series: item.series) {
+            if (bucketWidth == 0) {
+                outputAggregate(archive, series.mode, series.total.firstTimestamp, series.total.lastTimestamp,
+                                series.total, showCsvHeader);
+                continue;
+            }
+            for (const LoggerArchive::Bucket &bucket: series.buckets) {
+                outputAggregate(archive, series.mode, bucket.start, bucket.start + bucketWidth, bucket.aggregate,
+                                showCsvHeader);
+            }
+        }
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Outputs \a aggregate, of \a archive's \a mode samples from \a start to \a end, in the selected output format, first
+ * outputting a CSV header if \a showCsvHeader is set (in which case it is then cleared).
+ */
+void QueryCommand::outputAggregate(const QString &archive, const DataLoggerService::Mode mode, const quint64 start,
+                                   const quint64 end, const LoggerArchive::Aggregate &aggregate, bool &showCsvHeader)
+{
+    const QString startString = QString::fromLatin1(formatTimestamp(start));
+    const QString endString = QString::fromLatin1(formatTimestamp(end));
+    const QString modeString = DataLoggerService::toString(mode);
+    const QString unit = LoggerFetchCommand::toUnit(mode);
+    const double mean = aggregate.sum / (double)aggregate.count;
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("start,end,archive,mode,count,minimum,maximum,mean,unit\n"));
+        }
+        output(QString::fromLatin1("%1,%2,%3,%4,%5,%6,%7,%8,%9\n").arg(startString, endString,
+            escapeCsvField(archive), escapeCsvField(modeString)).arg(aggregate.count).arg(aggregate.minimum)
+            .arg(aggregate.maximum).arg(mean).arg(unit));
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson: {
+        const QJsonObject object{
+            { u"start"_s,   (epochTimestamps) ? QJsonValue((qint64)start) : QJsonValue(startString) },
+            { u"end"_s,     (epochTimestamps) ? QJsonValue((qint64)end) : QJsonValue(endString) },
+            { u"archive"_s, archive },
+            { u"mode"_s,    modeString },
+            { u"count"_s,   (qint64)aggregate.count },
+            { u"minimum"_s, aggregate.minimum },
+            { u"maximum"_s, aggregate.maximum },
+            { u"mean"_s,    mean },
+            { u"unit"_s,    unit },
+        };
+        output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+            : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:          // Not supported by this command.
+    case OutputFormat::LineProtocol:   // Not supported by this command.
+    case OutputFormat::Binary:         // Not supported by this command.
+    case OutputFormat::NdjsonEnvelope: // Not supported by this command.
+    case OutputFormat::Text:
+        output(tr("%1 %2 %3 %4 count=%5 min=%6 max=%7 mean=%8 %9\n").arg(startString, endString, archive, modeString)
+            .arg(aggregate.count).arg(aggregate.minimum).arg(aggregate.maximum).arg(mean).arg(unit));
+        break;
+    }
+}
+
+/*!
+ * Returns the \a msecs timestamp formatted according to the selected time format; that is, either as epoch
+ * milliseconds, or an ISO 8601 UTC date and time.
+ */
+QByteArray QueryCommand::formatTimestamp(const quint64 msecs) const
+{
+    return (epochTimestamps) ? QByteArray::number(msecs)
+        : QDateTime::fromMSecsSinceEpoch((qint64)msecs, DOKIT_QT_UTC).toString(Qt::ISODateWithMs).toLatin1();
+}
+
+/*!
+ * Parses \a value as either a number of milliseconds since the epoch, or an ISO 8601 date (and optional time), setting
+ * \a msecs to the corresponding milliseconds since the epoch.
+ *
+ * ISO 8601 dates and times without an offset (such as `Z` or `+10:00`) are interpreted as local time. Returns `true`
+ * on success, otherwise `false`.
+ */
+bool QueryCommand::parseTime(const QString &value, quint64 &msecs)
+{
+    bool ok;
+    if (const qulonglong number = value.trimmed().toULongLong(&ok); ok) {
+        msecs = number;
+        return true;
+    }
+    const QDateTime dateTime = QDateTime::fromString(value.trimmed(), Qt::ISODateWithMs);
+    if ((!dateTime.isValid()) || (dateTime.toMSecsSinceEpoch() < 0)) {
+        return false;
+    }
+    msecs = (quint64)dateTime.toMSecsSinceEpoch();
+    return true;
+}
+
+/*!
+ * Queries \a archive for the samples logged between \a from and \a to (inclusive, and in milliseconds since the epoch),
+ * setting \a sessions to the number of session runs that overlap that range, and \a series to one aggregate (and, if
+ * \a width is non-zero, one downsampled series) per measurement mode. Returns an empty string on success, otherwise a
+ * description of the failure.
+ *
+ * Runs of the same mode are merged, including any buckets that they share. If the archive has an up-to-date rollup
+ * (see LoggerRollup), then each mode's coarsest suitable tier is used for the part of the range that its buckets cover
+ * entirely, and only the (partial-bucket) ends of the range are scanned from the archive itself. This is called on
+ * worker threads, so uses only its own (thread-local) objects.
+ */
+QString QueryCommand::query(const QString &archive, const quint64 from, const quint64 to, const quint64 width,
+                            qsizetype &sessions, QVector<Series> &series)
+{
+    LoggerArchive source(archive);
+    if (!source.open()) {
+        return tr("Invalid, or unreadable, archive");
+    }
+    const QVector<qsizetype> indexes = source.findSessions(from, to);
+    sessions = indexes.size();
+    QMap<DataLoggerService::Mode, QVector<qsizetype>> runs;
+    for (const qsizetype index: indexes) {
+        runs[source.session(index).metadata.mode].append(index);
+    }
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive));
+    rollup.open(source); // Optional, so just scan the archive if missing, or out of date.
+
+    // Finds the tier buckets that lie entirely within the range, being careful not to overflow at either end.
+    const bool unbounded = (to == std::numeric_limits<quint64>::max());
+    const auto wholeBuckets = [from, to, unbounded](const quint64 tier, quint64 &head, quint64 &tail) {
+        head = ((from % tier) == 0) ? from : from - (from % tier) + tier;
+        tail = (unbounded) ? to : (to + 1) - ((to + 1) % tier); // Exclusive end, unless unbounded.
+        return (head >= from) && ((unbounded) || (tail > head));
+    };
+
+    QMap<DataLoggerService::Mode, LoggerArchive::Aggregate> totals;
+    QMap<DataLoggerService::Mode, QMap<quint64, LoggerArchive::Aggregate>> buckets;
+    for (auto iter = runs.cbegin(); iter != runs.cend(); ++iter) {
+        const DataLoggerService::Mode mode = iter.key();
+        const auto merge = [&](const quint64 start, const LoggerArchive::Aggregate &aggregate) {
+            LoggerArchive::merge(totals[mode], aggregate);
+            if (width > 0) {
+                LoggerArchive::merge(buckets[mode][start - (start % width)], aggregate);
+            }
+        };
+        const auto scan = [&](const quint64 first, const quint64 last) {
+            for (const qsizetype index: iter.value()) {
+                if (width == 0) {
+                    merge(0, source.aggregate(index, first, last));
+                } else for (const LoggerArchive::Bucket &bucket: source.downsample(index, first, last, width)) {
+                    merge(bucket.start, bucket.aggregate); // Cheaper than re-scanning the run's samples.
+                }
+            }
+        };
+
+        // Use the coarsest tier that divides the bucket width, and has at least one whole bucket within the range.
+        quint64 tier = 0, head = 0, tail = 0;
+        const QVector<quint64> tiers = rollup.tiers(mode);
+        for (auto candidate = tiers.crbegin(); (tier == 0) && (candidate != tiers.crend()); ++candidate) {
+            if (((width % *candidate) == 0) && (wholeBuckets(*candidate, head, tail))) {
+                tier = *candidate;
+            }
+        }
+        if (tier == 0) {
+            scan(from, to); // No whole tier buckets, so scan the archive only.
+            continue;
+        }
+        if (head > from) {
+            scan(from, head - 1);
+        }
+        for (const LoggerArchive::Bucket &bucket: rollup.buckets(mode, tier, head, (unbounded) ? to : tail - tier)) {
+            merge(bucket.start, bucket.aggregate);
+        }
+        if ((!unbounded) && (tail <= to)) {
+            scan(tail, to);
+        }
+    }
+
+    series.clear();
+    for (auto iter = totals.cbegin(); iter != totals.cend(); ++iter) {
+        if (iter.value().count == 0) {
+            continue; // The mode's runs overlapped the range, but had no samples within it.
+        }
+        Series modeSeries{ iter.key(), iter.value(), { } };
+        const QMap<quint64, LoggerArchive::Aggregate> modeBuckets = buckets.value(iter.key());
+        modeSeries.buckets.reserve(modeBuckets.size());
+        for (auto bucket = modeBuckets.cbegin(); bucket != modeBuckets.cend(); ++bucket) {
+            modeSeries.buckets.append({ bucket.key(), bucket.value() });
+        }
+        series.append(modeSeries);
+    }
+    return QString();
+}
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "abstractcommand.h"
+
+#include <qtpokit/loggerarchive.h>
+
+#include <QVector>
+
+#include <limits>
+
+class ShardedWorkerPool;
+
+class QueryCommand : public AbstractCommand
+{
+    Q_OBJECT
+
+public:
+    explicit QueryCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+    bool start() override;
+
+protected:
+    bool supportsNdjsonOutput() const override;
+
+protected slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info) override;
+    void deviceDiscoveryFinished() override;
+
+private:
+    /// Query results for a single measurement mode, within a single archive file.
+    struct Series {
+        DataLoggerService::Mode mode;           ///< Measurement mode of the series' samples.
+        LoggerArchive::Aggregate total;         ///< Aggregate of all of the series' samples within the time range.
+        QVector<LoggerArchive::Bucket> buckets; ///< Downsampled series, in time order, if #bucketWidth is non-zero.
+    };
+
+    /// The query of a single archive file.
+    struct Query {
+        QString archive;                  ///< Archive file to query.
+        QString error;                    ///< Why the query failed, or empty if it succeeded (or is pending).
+        qsizetype sessions { 0 };         ///< Number of the archive's session runs that overlap the time range.
+        QVector<Series> series;           ///< Results, in mode order, once queried.
+    };
+
+    QVector<Query> queries;               ///< One query per archive file, in command line (then file name) order.
+    quint64 from { 0 };                   ///< Start of the time range, in milliseconds since the epoch.
+    quint64 to { std::numeric_limits<quint64>::max() }; ///< End of the time range (inclusive).
+    quint64 bucketWidth { 0 };            ///< Width of each downsampled bucket, or 0 for overall aggregates only.
+    bool epochTimestamps { false };       ///< Whether to output timestamps as epoch milliseconds, instead of ISO 8601.
+    int threads { 0 };                    ///< Maximum number of archives to query at once, or 0 for one per core.
+    ShardedWorkerPool * workers { nullptr }; ///< Threads querying #queries, once started.
+    int finished { 0 };                   ///< Number of #queries finished (successfully, or not).
+
+    void queryFinished(const int index);
+    void outputResults();
+    void outputAggregate(const QString &archive, const DataLoggerService::Mode mode, const quint64 start,
+                         const quint64 end, const LoggerArchive::Aggregate &aggregate, bool &showCsvHeader);
+    QByteArray formatTimestamp(const quint64 msecs) const;
+
+    static bool parseTime(const QString &value, quint64 &msecs);
+    static QString query(const QString &archive, const quint64 from, const quint64 to, const quint64 width,
+                         qsizetype &sessions, QVector<Series> &series);
+
+    QTPOKIT_BEFRIEND_TEST(QueryCommand)
+};
@@ -7,10 +7,14 @@
 #include <qtpokit/pokitdiscoveryagent.h>
 
 #include <QBluetoothUuid>
+#include <QDateTime>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSet>
+#include <QTimer>
 
+#include <algorithm>
 #include <iostream>
 
 DOKIT_USE_STRINGLITERALS
@@ -20,6 +24,11 @@ DOKIT_USE_STRINGLITERALS
  *
  * The ScanCommand class implements the `scan` CLI command, by scanning for nearby Pokit Bluetooth
  * devices. When devices are found, they are logged to stdout in the chosen format.
+ *
+ * Alternatively, with the `watch` option, the ScanCommand class scans continuously (via PokitDeviceRegistry), and
+ * once per refresh interval, outputs only the changes since the previous refresh: devices that appeared,
+ * disappeared, were renamed, or whose RSSI changed significantly. This keeps fleet presence monitoring cheap enough
+ * to leave running indefinitely.
  */
 
 /*!
@@ -28,6 +37,10 @@ DOKIT_USE_STRINGLITERALS
 ScanCommand::ScanCommand(QObject * const parent) : AbstractCommand(parent)
 {
     #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    // Report each device at most once per second, with smoothed RSSI, rather than once per advertisement.
+    discoveryAgent->setUpdateInterval(1000);
+    discoveryAgent->setRssiSmoothing(0.25f);
+    discoveryAgent->setRssiThreshold(1);
     connect(discoveryAgent, &PokitDiscoveryAgent::pokitDeviceUpdated,
             this, &ScanCommand::deviceUpdated);
     #endif
@@ -41,6 +54,8 @@ QStringList ScanCommand::requiredOptions(const QCommandLineParser &parser) const
 QStringList ScanCommand::supportedOptions(const QCommandLineParser &parser) const
 {
     return AbstractCommand::supportedOptions(parser) + QStringList{
+        u"interval"_s,
+        u"watch"_s,
     };
 }
 
@@ -52,6 +67,28 @@ QStringList ScanCommand::processOptions(const QCommandLineParser &parser)
         return errors;
     }
 
+    watch = parser.isSet(u"watch"_s);
+    if ((watch) && (!parser.isSet(u"output"_s))) {
+        format = OutputFormat::Ndjson; // Compact, and easily filtered, so the natural default for watching.
+    }
+
+    // Parse the interval option.
+    if (parser.isSet(u"interval"_s)) {
+        const QString value = parser.value(u"interval"_s);
+        const quint32 interval = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (!watch) {
+            errors.append(tr("Missing required option for --%1: --%2").arg(u"interval"_s, u"watch"_s));
+        } else if (interval == 0) {
+            errors.append(tr("Invalid interval value: %1").arg(value));
+        } else {
+            refreshInterval = interval;
+        }
+    }
+
+    // When watching, the timeout (already validated by AbstractCommand) applies to the whole watch, not to each scan.
+    if ((watch) && (parser.isSet(u"timeout"_s))) {
+        watchTimeout = parseNumber<std::milli>(parser.value(u"timeout"_s), u"s"_s, 500);
+    }
     return errors;
 }
 
@@ -61,6 +98,25 @@ QStringList ScanCommand::processOptions(const QCommandLineParser &parser)
 bool ScanCommand::start()
 {
     Q_ASSERT(discoveryAgent);
+    if (watch) {
+        qCInfo(lc).noquote() << tr("Watching for Pokit devices, reporting changes every %L1ms...")
+            .arg(refreshInterval);
+        registry = new PokitDeviceRegistry(this);
+        registry->setScanDuration(0); // Scan continuously.
+        registry->setMaximumAge(std::max(refreshInterval * 3, 10'000u));
+        #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Update coalescing requires the deviceUpdated signal.
+        registry->discoveryAgent()->setUpdateInterval(1000);
+        registry->discoveryAgent()->setRssiSmoothing(0.25f);
+        #endif
+        QTimer * const timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, &ScanCommand::refresh);
+        timer->start((int)refreshInterval);
+        if (watchTimeout > 0) {
+            QTimer::singleShot((int)watchTimeout, this, []() { QCoreApplication::quit(); });
+        }
+        registry->start();
+        return true;
+    }
     qCInfo(lc).noquote() << tr("Scanning for Pokit devices...");
     discoveryAgent->start();
     return true;
@@ -83,6 +139,13 @@ void ScanCommand::deviceDiscovered(const QBluetoothDeviceInfo &info)
     case OutputFormat::Json:
         std::cout << QJsonDocument(toJson(info)).toJson().toStdString();
         break;
+    case OutputFormat::Ndjson:
+        std::cout << (QJsonDocument(toJson(info)).toJson(QJsonDocument::Compact) + '\n').toStdString();
+        break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         std::cout << qUtf8Printable(tr("%1 %2 %3 %4\n").arg(info.deviceUuid().toString(),
             info.address().toString(), info.name()).arg(info.rssi()));
@@ -112,6 +175,143 @@ void ScanCommand::deviceDiscoveryFinished()
     QCoreApplication::quit();
 }
 
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonOutput
+ *
+ * This override returns \c true, since scans (especially when watching) may run indefinitely.
+ */
+bool ScanCommand::supportsNdjsonOutput() const
+{
+    return true;
+}
+
+/*!
+ * Outputs the changes to the registered devices since the previous refresh, when watching.
+ */
+void ScanCommand::refresh()
+{
+    Q_ASSERT(registry);
+    outputChanges(diff(watched, registry->devices()), QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+ * Returns the changes between \a watched devices (as last reported) and registry \a entries, updating \a watched to
+ * match. Changes are ordered by device, so the output is stable from one refresh to the next.
+ *
+ * A device's RSSI is only reported as changed once it differs from the last reported RSSI (rather than the previous
+ * refresh's) by at least #significantRssiChange dB, so slow drifts are still reported eventually.
+ */
+QVector<ScanCommand::WatchChange> ScanCommand::diff(QHash<QString, WatchedDevice> &watched,
+                                                    const QVector<PokitDeviceRegistry::Entry> &entries)
+{
+    QVector<WatchChange> changes;
+    QSet<QString> seen;
+    for (const PokitDeviceRegistry::Entry &entry: entries) {
+        const QString key = PokitDeviceRegistry::key(entry.info);
+        seen.insert(key);
+        const auto iter = watched.find(key);
+        if (iter == watched.end()) {
+            changes.append({ WatchEvent::Appeared, key, entry.name, entry.rssi, QString(), 0 });
+            watched.insert(key, { entry.name, entry.rssi });
+            continue;
+        }
+        if (iter->name != entry.name) {
+            changes.append({ WatchEvent::Renamed, key, entry.name, entry.rssi, iter->name, 0 });
+            iter->name = entry.name;
+        }
+        if (qAbs(entry.rssi - iter->rssi) >= significantRssiChange) {
+            changes.append({ WatchEvent::RssiChanged, key, entry.name, entry.rssi, QString(), iter->rssi });
+            iter->rssi = entry.rssi;
+        }
+    }
+    for (auto iter = watched.begin(); iter != watched.end();) {
+        if (seen.contains(iter.key())) {
+            ++iter;
+            continue;
+        }
+        changes.append({ WatchEvent::Disappeared, iter.key(), iter->name, iter->rssi, QString(), 0 });
+        iter = watched.erase(iter);
+    }
+    std::stable_sort(changes.begin(), changes.end(), [](const WatchChange &lhs, const WatchChange &rhs) {
+        return lhs.device < rhs.device;
+    });
+    return changes;
+}
+
+/*!
+ * Outputs watched device \a changes, detected at \a timestamp (in milliseconds since the epoch), in the selected
+ * output format.
+ */
+void ScanCommand::outputChanges(const QVector<WatchChange> &changes, const qint64 timestamp)
+{
+    for (const WatchChange &change: changes) {
+        switch (format) {
+        case OutputFormat::Csv:
+            for (; showCsvHeader; showCsvHeader = false) {
+                output(tr("timestamp,event,device,name,signal_strength,previous_name,previous_signal_strength\n"));
+            }
+            output(QString::fromLatin1("%1,%2,%3,%4,%5,%6,%7\n").arg(timestamp).arg(toString(change.event),
+                escapeCsvField(change.device), escapeCsvField(change.name)).arg(change.rssi)
+                .arg(escapeCsvField(change.previousName),
+                     (change.event == WatchEvent::RssiChanged) ? QString::number(change.previousRssi) : QString()));
+            break;
+        case OutputFormat::Json:
+        case OutputFormat::Ndjson: {
+            QJsonObject object{
+                { u"timestamp"_s, timestamp },
+                { u"event"_s,     toString(change.event) },
+                { u"device"_s,    change.device },
+                { u"name"_s,      change.name },
+                { u"rssi"_s,      change.rssi },
+            };
+            if (change.event == WatchEvent::Renamed) {
+                object.insert(u"previousName"_s, change.previousName);
+            } else if (change.event == WatchEvent::RssiChanged) {
+                object.insert(u"previousRssi"_s, change.previousRssi);
+            }
+            output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+                : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+        }   break;
+        case OutputFormat::Arrow:
+        case OutputFormat::LineProtocol:
+        case OutputFormat::Binary:
+        case OutputFormat::NdjsonEnvelope:
+        case OutputFormat::Text:
+            switch (change.event) {
+            case WatchEvent::Appeared:
+            case WatchEvent::Disappeared:
+                output(tr("%1 %2 %3 %4\n").arg(toString(change.event), change.device, change.name)
+                    .arg(change.rssi));
+                break;
+            case WatchEvent::Renamed:
+                output(tr("%1 %2 %3 %4 (was %5)\n").arg(toString(change.event), change.device, change.name)
+                    .arg(change.rssi).arg(change.previousName));
+                break;
+            case WatchEvent::RssiChanged:
+                output(tr("%1 %2 %3 %4 (was %5)\n").arg(toString(change.event), change.device, change.name)
+                    .arg(change.rssi).arg(change.previousRssi));
+                break;
+            }
+            break;
+        }
+    }
+    outputBatchComplete();
+}
+
+/*!
+ * Returns \a event as a (non-translated) string, suitable for machine-readable output.
+ */
+QString ScanCommand::toString(const WatchEvent event)
+{
+    switch (event) {
+    case WatchEvent::Appeared:    return u"appeared"_s;
+    case WatchEvent::Disappeared: return u"disappeared"_s;
+    case WatchEvent::Renamed:     return u"renamed"_s;
+    case WatchEvent::RssiChanged: return u"rssi"_s;
+    }
+    return QString();
+}
+
 /*!
  * Returns \a info as a JSON object.
  */
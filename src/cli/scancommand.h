@@ -3,6 +3,11 @@
 
 #include "abstractcommand.h"
 
+#include <qtpokit/pokitdeviceregistry.h>
+
+#include <QHash>
+#include <QVector>
+
 class ScanCommand : public AbstractCommand
 {
     Q_OBJECT
@@ -25,8 +30,47 @@ protected slots:
     #endif
     void deviceDiscoveryFinished() override;
 
+protected:
+    bool supportsNdjsonOutput() const override;
+
 private:
+    /// Kinds of changes reported by the `watch` option.
+    enum class WatchEvent : quint8 {
+        Appeared,    ///< Device seen for the first time (or again, after disappearing).
+        Disappeared, ///< Device no longer seen (see PokitDeviceRegistry::maximumAge()).
+        Renamed,     ///< Device's name changed.
+        RssiChanged, ///< Device's RSSI changed by at least #significantRssiChange dB.
+    };
+
+    /// A watched device, as last reported.
+    struct WatchedDevice {
+        QString name;      ///< Device's name, as last reported.
+        qint16 rssi { 0 }; ///< Device's RSSI, as last reported.
+    };
+
+    /// A change to a watched device, since the previous refresh.
+    struct WatchChange {
+        WatchEvent event;          ///< Kind of change.
+        QString device;            ///< Device's key (see PokitDeviceRegistry::key()).
+        QString name;              ///< Device's current name.
+        qint16 rssi { 0 };         ///< Device's current RSSI.
+        QString previousName;      ///< Device's previous name, for WatchEvent::Renamed changes.
+        qint16 previousRssi { 0 }; ///< Device's previously reported RSSI, for WatchEvent::RssiChanged changes.
+    };
+
+    static constexpr int significantRssiChange { 10 }; ///< Smallest RSSI change (in dB) reported when watching.
+
     bool showCsvHeader { true }; ///< Whether or not to show a header as the first line of CSV output.
+    bool watch { false };        ///< Whether to watch for changes, instead of reporting every discovery.
+    quint32 refreshInterval { 5000 }; ///< Milliseconds between change reports, when watching.
+    quint32 watchTimeout { 0 }; ///< Milliseconds to watch for before exiting, or 0 to watch until interrupted.
+    PokitDeviceRegistry * registry { nullptr }; ///< Registry of nearby devices, when watching.
+    QHash<QString, WatchedDevice> watched;      ///< Watched devices as last reported, by key.
+
+    static QVector<WatchChange> diff(QHash<QString, WatchedDevice> &watched,
+                                     const QVector<PokitDeviceRegistry::Entry> &entries);
+    void outputChanges(const QVector<WatchChange> &changes, const qint64 timestamp);
+    static QString toString(const WatchEvent event);
 
     static QJsonObject toJson(const QBluetoothDeviceInfo &info);
     static QJsonArray  toJson(const QBluetoothDeviceInfo::CoreConfigurations &configurations);
@@ -39,5 +83,8 @@ private:
     static QString toString(const QBluetoothDeviceInfo::MajorDeviceClass &majorClass);
     static QString toString(const QBluetoothDeviceInfo::MajorDeviceClass &majorClass, const quint8 minorClass);
 
+private slots:
+    void refresh();
+
     QTPOKIT_BEFRIEND_TEST(ScanCommand)
 };
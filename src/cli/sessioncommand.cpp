@@ -0,0 +1,434 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "sessioncommand.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/pokitdevice.h>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <cstdio>
+#include <utility>
+
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class SessionCommand
+ *
+ * The SessionCommand class implements the `session` CLI command, which connects to a Pokit device once, then runs a
+ * sequence of device commands (read from a script, or stdin) against that one connection. This avoids the scan,
+ * connection and service discovery that would otherwise precede every command, which often takes longer than the
+ * commands themselves.
+ *
+ * Each line of input is a command line, without the application name, such as `meter --mode Vdc --samples 10`.
+ * Arguments may be quoted (with single or double quotes), or escaped (with backslashes), as they would be in a POSIX
+ * shell, while blank lines, and everything from an unquoted `#` onwards, are ignored. The `quit` (or `exit`) command
+ * ends the session early.
+ *
+ * Scripts are scanned up front for the services their commands use, so that all of them can be discovered at once
+ * (see PokitDevice::prepareServices) while connecting, rather than one after another, as each command first runs.
+ */
+
+/*!
+ * Construct a new SessionCommand object with \a parent.
+ */
+SessionCommand::SessionCommand(QObject * const parent) : DeviceCommand(parent)
+{
+
+}
+
+QStringList SessionCommand::requiredOptions(const QCommandLineParser &parser) const
+{
+    return DeviceCommand::requiredOptions(parser) + QStringList{
+    };
+}
+
+QStringList SessionCommand::supportedOptions(const QCommandLineParser &parser) const
+{
+    return DeviceCommand::supportedOptions(parser) + QStringList{
+        u"script"_s,
+    };
+}
+
+/*!
+ * Sets the functions used to parse, and construct, each of the session's commands to \a addOptions and
+ * \a createCommand respectively.
+ *
+ * These are provided by the main application, since it alone knows the complete set of CLI options and commands.
+ */
+void SessionCommand::setCommandFactory(const OptionsFunc &addOptions, const CommandFunc &createCommand)
+{
+    this->addOptions = addOptions;
+    this->createCommand = createCommand;
+}
+
+/*!
+ * \copybrief DeviceCommand::processOptions
+ *
+ * This implementation extends DeviceCommand::processOptions to process additional CLI options
+ * supported (or required) by this command.
+ */
+QStringList SessionCommand::processOptions(const QCommandLineParser &parser)
+{
+    QStringList errors = DeviceCommand::processOptions(parser);
+    if (!errors.isEmpty()) {
+        return errors;
+    }
+
+    input = new QFile(this);
+    if (parser.isSet(u"script"_s)) {
+        scriptFileName = parser.value(u"script"_s);
+        input->setFileName(scriptFileName);
+        if (!input->open(QIODevice::ReadOnly|QIODevice::Text)) {
+            errors.append(tr("Failed to open script %1: %2").arg(scriptFileName, input->errorString()));
+            return errors;
+        }
+        scriptServices = servicesOf(input->readAll()); // Scripts are small, so are just read twice.
+        input->seek(0);
+        return errors;
+    }
+
+    #if defined(Q_OS_UNIX)
+    // Unbuffered, so that #notifier is never left waiting for input that has already been read into the buffer.
+    if (!input->open(STDIN_FILENO, QIODevice::ReadOnly|QIODevice::Unbuffered)) {
+        errors.append(tr("Failed to open stdin: %1").arg(input->errorString()));
+        return errors;
+    }
+    interactive = isatty(STDIN_FILENO);
+    notifier = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+    notifier->setEnabled(false); // Until the device is ready for commands.
+    connect(notifier, &QSocketNotifier::activated, this, [this]() {
+        readCommand();
+        nextCommand();
+    });
+    #else
+    if (!input->open(stdin, QIODevice::ReadOnly|QIODevice::Text)) {
+        errors.append(tr("Failed to open stdin: %1").arg(input->errorString()));
+    }
+    #endif
+    return errors;
+}
+
+/*!
+ * \copybrief DeviceCommand::getService
+ *
+ * This override returns a pointer to a StatusService object, which is kept discovered for the life of the session,
+ * both to know when the device is ready for commands, and to save the session's commands from discovering it again.
+ *
+ * Any other services that the session's script uses (see servicesOf()) are prepared alongside it, so that all of them
+ * are discovered at once, before the script's first command runs, rather than as each command first uses them.
+ */
+AbstractPokitService * SessionCommand::getService()
+{
+    Q_ASSERT(device);
+    if (!service) {
+        service = device->status();
+        Q_ASSERT(service);
+        connect(device, &PokitDevice::servicesPrepared, this, &SessionCommand::servicesPrepared);
+        device->prepareServices(scriptServices|PokitDevice::Service::Status);
+    }
+    return service;
+}
+
+/*!
+ * \copybrief DeviceCommand::usesDiscoveredValues
+ *
+ * This override returns \c true, since the session's commands (such as `status`) may use values read during service
+ * discovery.
+ */
+bool SessionCommand::usesDiscoveredValues() const
+{
+    return true;
+}
+
+/*!
+ * Handles the session's services having been \a prepared (see getService()), by beginning to read, and run, the
+ * session's commands. Any \a failed services are reported, but left for the commands that use them to fail on.
+ */
+void SessionCommand::servicesPrepared(const PokitDevice::Services prepared, const PokitDevice::Services failed)
+{
+    if (failed) {
+        qCWarning(lc).noquote() << tr("Failed to prepare services: %1").arg(PokitDevice::toString(failed));
+    }
+    if ((ending) || (std::exchange(ready, true))) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Prepared services: %1").arg(PokitDevice::toString(prepared));
+    qCInfo(lc).noquote() << tr(R"(Connected to "%1"; ready for commands.)").arg(device->controller()->remoteName());
+    nextCommand();
+}
+
+/*!
+ * Returns the names of options that apply to the whole session (ie its device connection), and so are not supported
+ * on the session's individual command lines.
+ */
+QStringList SessionCommand::sessionOptions()
+{
+    return {
+        u"connection-profile"_s,
+        u"device"_s,
+        u"device-thread"_s,
+        u"discovery-cache"_s,
+        u"known-devices"_s,
+        u"link-statistics"_s,
+        u"reconnect"_s,
+        u"record"_s,
+        u"script"_s,
+    };
+}
+
+/*!
+ * Returns the services that the \a command device command uses, or none, if \a command is not known to use any.
+ */
+PokitDevice::Services SessionCommand::servicesOf(const QString &command)
+{
+    static const QHash<QString, PokitDevice::Service> services {
+        { u"calibrate"_s,    PokitDevice::Service::Calibration },
+        { u"dso"_s,          PokitDevice::Service::Dso },
+        { u"flash-led"_s,    PokitDevice::Service::Status },
+        { u"info"_s,         PokitDevice::Service::DeviceInfo },
+        { u"logger-fetch"_s, PokitDevice::Service::DataLogger },
+        { u"logger-start"_s, PokitDevice::Service::DataLogger },
+        { u"logger-stop"_s,  PokitDevice::Service::DataLogger },
+        { u"logger-tail"_s,  PokitDevice::Service::DataLogger },
+        { u"meter"_s,        PokitDevice::Service::Multimeter },
+        { u"set-name"_s,     PokitDevice::Service::Status },
+        { u"set-torch"_s,    PokitDevice::Service::Status },
+        { u"status"_s,       PokitDevice::Service::Status },
+    };
+    const auto iter = services.constFind(command);
+    return (iter == services.constEnd()) ? PokitDevice::Services() : PokitDevice::Services(*iter);
+}
+
+/*!
+ * Returns the services that the commands of \a script use, parsing each line as runCommand() will. Lines that cannot be
+ * parsed are skipped, since runCommand() will report them in due course.
+ */
+PokitDevice::Services SessionCommand::servicesOf(const QByteArray &script) const
+{
+    PokitDevice::Services services;
+    for (const QByteArray &line: script.split('\n')) {
+        QString error;
+        const QStringList arguments = splitArguments(QString::fromUtf8(line), error);
+        if ((!error.isEmpty()) || (arguments.isEmpty())) {
+            continue;
+        }
+        QCommandLineParser parser;
+        if (addOptions) {
+            addOptions(parser);
+        }
+        if (parser.parse(QStringList{ QCoreApplication::applicationName() } + arguments)) {
+            services |= servicesOf(parser.positionalArguments().value(0));
+        }
+    }
+    return services;
+}
+
+/*!
+ * Reads, and runs, input lines until one starts a command, or the session ends. However, if reading stdin via
+ * #notifier, then this function only prompts for the next line (if #interactive), and returns, since #notifier will
+ * read the line once it is available.
+ */
+void SessionCommand::nextCommand()
+{
+    while ((!current) && (!ending)) {
+        if (interactive) {
+            fputs(qUtf8Printable(QCoreApplication::applicationName() + u"> "_s), stderr);
+            fflush(stderr);
+        }
+        if (notifier) {
+            notifier->setEnabled(true);
+            return;
+        }
+        readCommand();
+    }
+}
+
+/*!
+ * Reads the next line of input, and runs it as a command, or ends the session if there is no more input.
+ */
+void SessionCommand::readCommand()
+{
+    if (notifier) {
+        notifier->setEnabled(false);
+    }
+    const QByteArray line = input->readLine();
+    if (line.isEmpty()) { // Blank lines still include their line endings.
+        qCDebug(lc).noquote() << tr("End of session input.");
+        endSession();
+        return;
+    }
+    ++lineNumber;
+    runCommand(QString::fromUtf8(line));
+}
+
+/*!
+ * Parses \a line as a command line, and runs the resulting command against the session's device.
+ */
+void SessionCommand::runCommand(const QString &line)
+{
+    Q_ASSERT(!current);
+    QString error;
+    const QStringList arguments = splitArguments(line, error);
+    if (!error.isEmpty()) {
+        commandFailed(error);
+        return;
+    }
+    if (arguments.isEmpty()) {
+        return; // Blank line, or comment.
+    }
+    if ((arguments.constFirst() == u"quit"_s) || (arguments.constFirst() == u"exit"_s)) {
+        endSession();
+        return;
+    }
+
+    QCommandLineParser parser;
+    if (addOptions) {
+        addOptions(parser);
+    }
+    if (!parser.parse(QStringList{ QCoreApplication::applicationName() } + arguments)) {
+        commandFailed(parser.errorText());
+        return;
+    }
+    for (const QString &option: sessionOptions()) {
+        if (parser.isSet(option)) {
+            commandFailed(tr("Option applies to the whole session, so must be given to the session command: %1")
+                .arg(option));
+            return;
+        }
+    }
+    const QStringList commands = parser.positionalArguments();
+    if (commands.size() != 1) {
+        commandFailed((commands.isEmpty()) ? tr("Missing argument: <command>")
+            : tr("More than one command: %1").arg(commands.join(u", "_s)));
+        return;
+    }
+    DeviceCommand * const command = (createCommand) ? createCommand(commands.constFirst(), this) : nullptr;
+    if (!command) {
+        commandFailed(tr("Unknown, or unsupported in sessions, command: %1").arg(commands.constFirst()));
+        return;
+    }
+    if (const QStringList errors = command->processOptions(parser); !errors.isEmpty()) {
+        delete command;
+        commandFailed(errors.join(u"; "_s));
+        return;
+    }
+
+    qCDebug(lc).noquote() << tr("Running command: %1").arg(arguments.join(u' '));
+    current = command;
+    connect(current, &DeviceCommand::finished, this, &SessionCommand::commandFinished);
+    current->startWithDevice(device, service->pokitProduct().value_or(PokitProduct::PokitMeter));
+}
+
+/*!
+ * Handles the current command finishing with \a exitCode, by running the session's next command.
+ */
+void SessionCommand::commandFinished(const int exitCode)
+{
+    Q_ASSERT(current);
+    current->deleteLater(); // Not deleted directly, since it is still emitting the finished() signal.
+    current = nullptr;
+    if (exitCode != EXIT_SUCCESS) {
+        commandFailed(tr("Command failed with code %1").arg(exitCode));
+    }
+    QTimer::singleShot(0, this, &SessionCommand::nextCommand);
+}
+
+/*!
+ * Reports \a error for the current input line. Unless #interactive, this also ends the session, much like a POSIX
+ * shell does with `set -e`, since later commands in a script are likely to depend on earlier ones.
+ */
+void SessionCommand::commandFailed(const QString &error)
+{
+    qCWarning(lc).noquote() << tr("%1:%2: %3").arg((scriptFileName.isEmpty()) ? u"stdin"_s : scriptFileName)
+        .arg(lineNumber).arg(error);
+    ++failures;
+    if (!interactive) {
+        endSession();
+    }
+}
+
+/*!
+ * Ends the session, disconnecting the device, and exiting with `EXIT_FAILURE` if any of the session's commands failed,
+ * or `EXIT_SUCCESS` otherwise.
+ */
+void SessionCommand::endSession()
+{
+    if (std::exchange(ending, true)) {
+        return;
+    }
+    if (notifier) {
+        notifier->setEnabled(false);
+    }
+    if (device) {
+        disconnect((failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE); // Will exit the application once disconnected.
+    }
+}
+
+/*!
+ * Splits \a line into separate arguments, much like a POSIX shell would, but without any expansions. That is,
+ * arguments are separated by unquoted whitespace; single quotes preserve everything within them; double quotes
+ * preserve everything within them except backslash escapes of `"` and `\`; an unquoted backslash escapes the next
+ * character; and an unquoted `#` at the start of an argument begins a comment, which extends to the end of \a line.
+ *
+ * If \a line has an unterminated quote, then \a error is set to a description of the problem, and the returned list
+ * should be ignored.
+ */
+QStringList SessionCommand::splitArguments(const QString &line, QString &error)
+{
+    QStringList arguments;
+    QString argument;
+    bool inArgument = false;
+    QChar quote;
+    for (qsizetype index = 0; index < line.size(); ++index) {
+        const QChar c = line.at(index);
+        if (quote == u'\'') {
+            if (c == u'\'') {
+                quote = QChar();
+            } else {
+                argument.append(c);
+            }
+        } else if (quote == u'"') {
+            if (c == u'"') {
+                quote = QChar();
+            } else if ((c == u'\\') && (index + 1 < line.size()) &&
+                       ((line.at(index + 1) == u'"') || (line.at(index + 1) == u'\\'))) {
+                argument.append(line.at(++index));
+            } else {
+                argument.append(c);
+            }
+        } else if (c.isSpace()) {
+            if (std::exchange(inArgument, false)) {
+                arguments.append(std::exchange(argument, QString()));
+            }
+        } else if ((c == u'#') && (!inArgument)) {
+            break; // The rest of the line is a comment.
+        } else {
+            inArgument = true;
+            if ((c == u'\'') || (c == u'"')) {
+                quote = c;
+            } else if ((c == u'\\') && (index + 1 < line.size())) {
+                argument.append(line.at(++index));
+            } else {
+                argument.append(c);
+            }
+        }
+    }
+    if (!quote.isNull()) {
+        error = tr("Unterminated quote: %1").arg(line.trimmed());
+        return QStringList{};
+    }
+    if (inArgument) {
+        arguments.append(argument);
+    }
+    return arguments;
+}
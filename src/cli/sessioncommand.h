@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "devicecommand.h"
+
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/statusservice.h>
+
+#include <functional>
+
+class QFile;
+class QSocketNotifier;
+
+class SessionCommand : public DeviceCommand
+{
+    Q_OBJECT
+
+public:
+    /// Adds all of the CLI's options to a command line parser, for parsing each of the session's command lines.
+    typedef std::function<void(QCommandLineParser &parser)> OptionsFunc;
+
+    /// Constructs the device command named by its first argument, with its second argument as parent, or returns
+    /// \c nullptr if the name is not that of a device command.
+    typedef std::function<DeviceCommand *(const QString &name, QObject * const parent)> CommandFunc;
+
+    explicit SessionCommand(QObject * const parent = nullptr);
+
+    QStringList requiredOptions(const QCommandLineParser &parser) const override;
+    QStringList supportedOptions(const QCommandLineParser &parser) const override;
+
+    void setCommandFactory(const OptionsFunc &addOptions, const CommandFunc &createCommand);
+
+public slots:
+    QStringList processOptions(const QCommandLineParser &parser) override;
+
+protected:
+    AbstractPokitService * getService() override;
+    bool usesDiscoveredValues() const override;
+
+private:
+    StatusService * service { nullptr };  ///< Bluetooth service this command keeps discovered, for the session.
+    OptionsFunc addOptions;               ///< Adds the CLI's options to each command line's parser.
+    CommandFunc createCommand;            ///< Constructs each command line's command.
+    QString scriptFileName;               ///< Script to read commands from, or empty to read from stdin.
+    QFile * input { nullptr };            ///< Script, or stdin, to read commands from.
+    QSocketNotifier * notifier { nullptr }; ///< Signals when stdin has more input, where supported.
+    bool interactive { false };           ///< Whether stdin is a terminal, to prompt for commands on.
+    DeviceCommand * current { nullptr };  ///< Command currently running against the device, if any.
+    int lineNumber { 0 };                 ///< Number of the last line read from #input.
+    int failures { 0 };                   ///< Number of commands that have failed so far.
+    bool ending { false };                ///< Whether the session has ended, and is disconnecting.
+    bool ready { false };                 ///< Whether the session's services are prepared, and it is reading commands.
+    PokitDevice::Services scriptServices; ///< Services the script's commands use, to prepare up front.
+
+    static QStringList sessionOptions();
+    static PokitDevice::Services servicesOf(const QString &command);
+    PokitDevice::Services servicesOf(const QByteArray &script) const;
+
+    void servicesPrepared(const PokitDevice::Services prepared, const PokitDevice::Services failed);
+
+    void nextCommand();
+    void readCommand();
+    void runCommand(const QString &line);
+    void commandFinished(const int exitCode);
+    void commandFailed(const QString &error);
+    void endSession();
+
+    static QStringList splitArguments(const QString &line, QString &error);
+
+    QTPOKIT_BEFRIEND_TEST(SessionCommand)
+};
@@ -85,7 +85,7 @@ void SetNameCommand::serviceDetailsDiscovered()
 {
     qCInfo(lc).noquote() << tr("Setting device name to: %1").arg(newName);
     if (!service->setDeviceName(newName)) {
-        QCoreApplication::exit(EXIT_FAILURE);
+        finish(EXIT_FAILURE);
     }
 }
 
@@ -101,6 +101,11 @@ void SetNameCommand::deviceNameWritten()
     case OutputFormat::Json:
         std::cout << qUtf8Printable(u"true\n"_s);
         break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         std::cout << qUtf8Printable(tr("Done.\n"));
         break;
@@ -86,7 +86,7 @@ void SetTorchCommand::serviceDetailsDiscovered()
 {
     qCInfo(lc).noquote() << tr("Setting torch %1").arg(StatusService::toString(newStatus).toLower());
     if (!service->setTorchStatus(newStatus)) {
-        QCoreApplication::exit(EXIT_FAILURE);
+        finish(EXIT_FAILURE);
     }
 }
 
@@ -102,6 +102,11 @@ void SetTorchCommand::torchStatusWritten()
     case OutputFormat::Json:
         std::cout << qUtf8Printable(u"true\n"_s);
         break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         std::cout << qUtf8Printable(tr("Done.\n"));
         break;
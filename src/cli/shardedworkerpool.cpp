@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "shardedworkerpool.h"
+
+#include <QRunnable>
+
+/*!
+ * \class ShardedWorkerPool
+ *
+ * The ShardedWorkerPool class moves parse, and format, work off the event loop's thread, onto a pool of worker
+ * threads, while still delivering all of the resulting output back to the one (event loop) thread that writes it.
+ *
+ * Work is sharded, such as by device: each shard's jobs are processed one at a time, in the order submitted, so the
+ * output of each shard (such as each device's stream of readings) stays in order. But different shards' jobs are
+ * processed concurrently, on up to threadCount() threads, so throughput scales with cores as shards (devices) are
+ * added, instead of being limited to the single event loop thread.
+ *
+ * Completed outputs are delivered, via outputReady(), on the thread this pool lives on (typically the main thread),
+ * in the order they completed. So the receiver is the single writer of all shards' output, and needs no locking of
+ * its own. Deliveries are coalesced, so a burst of completions costs a single queued call, not one per job.
+ *
+ * Since outputs are delivered asynchronously, call flush() before writing any final output (such as on exit), to
+ * wait for, and deliver, all outstanding jobs' output first.
+ */
+
+/// \cond internal
+/// Runs a ShardedWorkerPool shard's worker loop, as a QRunnable (since QThreadPool::start() only accepts functors from
+/// Qt 5.15).
+class ShardedWorkerPoolRunnable : public QRunnable
+{
+public:
+    ShardedWorkerPoolRunnable(ShardedWorkerPool * const pool, const int shard) : pool(pool), shard(shard) { }
+    void run() override { pool->run(shard); }
+private:
+    ShardedWorkerPool * const pool;
+    const int shard;
+};
+/// \endcond
+
+/*!
+ * Constructs a new worker pool with \a parent, and up to \a threads worker threads. If \a threads is less than 1, then
+ * QThread::idealThreadCount() threads are used.
+ */
+ShardedWorkerPool::ShardedWorkerPool(const int threads, QObject * const parent) : QObject(parent)
+{
+    if (threads > 0) {
+        pool.setMaxThreadCount(threads);
+    }
+    qCDebug(lc).noquote() << tr("Using %Ln worker thread(s).", nullptr, pool.maxThreadCount());
+}
+
+/*!
+ * Destroys this pool, discarding any jobs not yet started, and any output not yet delivered, after waiting for any
+ * current jobs to finish.
+ */
+ShardedWorkerPool::~ShardedWorkerPool()
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        shards.clear();
+    }
+    pool.waitForDone();
+}
+
+/*!
+ * Returns the maximum number of worker threads this pool uses.
+ */
+int ShardedWorkerPool::threadCount() const
+{
+    return pool.maxThreadCount();
+}
+
+/*!
+ * Returns this pool's processing statistics so far.
+ */
+ShardedWorkerPool::Statistics ShardedWorkerPool::statistics() const
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/*!
+ * Queues \a job to be processed, after all jobs previously submitted for the same \a shard, and starts a worker for
+ * the shard if not already running.
+ *
+ * \a job is invoked on a worker thread, so must only read state that no other thread modifies meanwhile; typically, it
+ * captures (by value) everything it needs to format its output.
+ */
+void ShardedWorkerPool::submit(const int shard, Job job)
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) {
+        return;
+    }
+    Shard &queue = shards[shard];
+    queue.jobs.enqueue(std::move(job));
+    ++stats.submitted;
+    stats.maxQueued = qMax<qsizetype>(stats.maxQueued, queue.jobs.size());
+    if (!queue.running) {
+        queue.running = true;
+        pool.start(new ShardedWorkerPoolRunnable(this, shard)); // The pool deletes the runnable once done.
+    }
+}
+
+/*!
+ * Waits for all submitted jobs to finish, then delivers all of their outputs (via outputReady()) before returning.
+ *
+ * Must only be called from the thread this pool lives on.
+ */
+void ShardedWorkerPool::flush()
+{
+    pool.waitForDone();
+    deliver();
+}
+
+/*!
+ * Runs the worker loop for \a shard, processing its jobs in order, until there are no more.
+ */
+void ShardedWorkerPool::run(const int shard)
+{
+    while (true) {
+        Job job;
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            const auto iter = shards.find(shard);
+            if ((stopping) || (iter == shards.end()) || (iter->jobs.isEmpty())) {
+                if (iter != shards.end()) {
+                    iter->running = false;
+                }
+                return;
+            }
+            job = iter->jobs.dequeue();
+        }
+        QByteArray output = job();
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            ++stats.completed;
+            done.append({ shard, std::move(output) });
+            if (std::exchange(deliveryPosted, true)) {
+                continue; // Will be delivered along with the outputs already waiting.
+            }
+        }
+        QMetaObject::invokeMethod(this, [this]() { deliver(); }, Qt::QueuedConnection);
+    }
+}
+
+/*!
+ * Delivers, via outputReady(), all completed outputs not yet delivered, in the order they completed.
+ */
+void ShardedWorkerPool::deliver()
+{
+    QVector<std::pair<int, QByteArray>> outputs;
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        outputs.swap(done);
+        deliveryPosted = false;
+        stats.delivered += outputs.size();
+    }
+    for (const auto &[shard, output]: std::as_const(outputs)) {
+        emit outputReady(shard, output);
+    }
+}
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_SHARDEDWORKERPOOL_H
+#define DOKIT_SHARDEDWORKERPOOL_H
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QQueue>
+#include <QThreadPool>
+#include <QVector>
+
+#include <functional>
+#include <mutex>
+#include <utility>
+
+class ShardedWorkerPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// A unit of work, such as parsing, and formatting, a single reading, returning the output to write.
+    using Job = std::function<QByteArray()>;
+
+    /// Processing statistics.
+    struct Statistics {
+        quint64 submitted { 0 };   ///< Number of jobs submitted.
+        quint64 completed { 0 };   ///< Number of jobs completed, whether or not their output has been delivered yet.
+        quint64 delivered { 0 };   ///< Number of jobs whose output has been delivered, via outputReady().
+        qsizetype maxQueued { 0 }; ///< Largest number of jobs waiting for any single shard's worker.
+    };
+
+    explicit ShardedWorkerPool(const int threads, QObject * const parent = nullptr);
+    ~ShardedWorkerPool() override;
+
+    int threadCount() const;
+    Statistics statistics() const;
+
+    void submit(const int shard, Job job);
+    void flush();
+
+signals:
+    void outputReady(const int shard, const QByteArray &output);
+
+private:
+    /// Jobs for a single shard, such as a single device, which are processed one at a time, in order.
+    struct Shard {
+        QQueue<Job> jobs;       ///< Jobs waiting to be processed.
+        bool running { false }; ///< Whether a worker is processing, or about to process, this shard's jobs.
+    };
+
+    QThreadPool pool;                           ///< Worker threads.
+
+    mutable std::mutex mutex;                   ///< Guards the members below.
+    QHash<int, Shard> shards;                   ///< Jobs, by shard.
+    QVector<std::pair<int, QByteArray>> done;   ///< Outputs of completed jobs, in completion order, not yet delivered.
+    bool deliveryPosted { false };              ///< Whether a call to deliver() is already queued.
+    bool stopping { false };                    ///< Whether this pool is being destroyed.
+    Statistics stats;                           ///< Processing statistics.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.workers", QtInfoMsg); ///< Logging category for worker pools.
+
+    void run(const int shard);
+    void deliver();
+
+    friend class ShardedWorkerPoolRunnable;
+
+    QTPOKIT_BEFRIEND_TEST(ShardedWorkerPool)
+};
+
+#endif // DOKIT_SHARDEDWORKERPOOL_H
@@ -0,0 +1,350 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "sqlitesink.h"
+#include "../stringliterals_p.h"
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class SqliteSink
+ *
+ * The SqliteSink class stores meter readings, and data logger samples, in an SQLite database, so that they may be
+ * queried (such as by dashboards) as they arrive, without first converting any other output format.
+ *
+ * The database's schema has one table of `devices`, one of `sessions` (each a contiguous run of samples from a single
+ * device, with the same mode, range and interval), and one of `samples` (each a timestamp, in milliseconds since the
+ * epoch, and value), along with a `readings` view that joins all three. Tables are created if they do not already
+ * exist, so repeated commands may store their samples in the same database.
+ *
+ * Samples are buffered by addSample(), then inserted by commit(), in a single transaction, via prepared multi-row
+ * insert statements. Commands commit once per batch of samples (such as each notification), so the cost of each
+ * transaction is spread across the whole batch. The database is opened in write-ahead log (WAL) mode, so that other
+ * processes may query it while samples are being stored, and commits need not wait for them.
+ */
+
+/*!
+ * Constructs a new SQLite sink with \a parent. Call open() to open (or create) the database.
+ */
+SqliteSink::SqliteSink(QObject * const parent) : QObject(parent),
+    connectionName(u"dokit-sqlite-%1"_s.arg((quintptr)this, 0, 16))
+{
+
+}
+
+/*!
+ * Destroys this sink, after committing any samples not yet committed.
+ */
+SqliteSink::~SqliteSink()
+{
+    commit();
+    close();
+}
+
+/*!
+ * Opens (or creates) the SQLite database \a fileName, in WAL mode, and creates the schema's tables, if necessary.
+ * Returns \c true on success, otherwise sets errorString() and returns \c false.
+ */
+bool SqliteSink::open(const QString &fileName)
+{
+    close();
+    if (!initialise(fileName)) {
+        close(); // Now that initialise()'s queries, which would otherwise hold the connection open, are destroyed.
+        return false;
+    }
+    qCDebug(lc).noquote() << tr("Opened SQLite database %1.").arg(fileName);
+    return true;
+}
+
+/*!
+ * Returns \c true if the database has been opened successfully.
+ */
+bool SqliteSink::isOpen() const
+{
+    return (insertRow != nullptr);
+}
+
+/*!
+ * Returns the name of the database file, if open, otherwise a null string.
+ */
+QString SqliteSink::fileName() const
+{
+    return (isOpen()) ? QSqlDatabase::database(connectionName, false).databaseName() : QString();
+}
+
+/*!
+ * Returns a human-readable description of the last error.
+ */
+QString SqliteSink::errorString() const
+{
+    return errorMessage;
+}
+
+/*!
+ * Returns the sink's storage statistics.
+ */
+SqliteSink::Statistics SqliteSink::statistics() const
+{
+    return stats;
+}
+
+/*!
+ * Returns the row ID of the current session, or -1 if there is no current session.
+ */
+qint64 SqliteSink::sessionId() const
+{
+    return currentSession;
+}
+
+/*!
+ * Sets the session that samples are added to, to \a session, if not already the current session.
+ *
+ * Sessions are the same if all but their start times match, so callers may call this for every batch of samples,
+ * and a new session is only begun when the device's mode, range, or interval changes. Otherwise, any samples added
+ * to the previous session are committed, and the \a session is either resumed (if the database already has the
+ * same session, with the same start time, such as from an earlier incremental fetch), or inserted.
+ *
+ * Returns \c true if \a session is now the current session.
+ */
+bool SqliteSink::setSession(const Session &session)
+{
+    if ((currentSession >= 0) && (sameSession(session, this->session))) {
+        return true;
+    }
+    commit();
+    currentSession = findOrInsertSession(session);
+    if (currentSession < 0) {
+        qCWarning(lc).noquote() << tr("Failed to store SQLite session:") << errorMessage;
+        return false;
+    }
+    this->session = session;
+    ++stats.sessions;
+    return true;
+}
+
+/*!
+ * Commits any pending samples, and ends the current session, so that the next call to setSession() begins (or
+ * resumes) a session, even if it is the same as the current one, apart from its start time.
+ */
+void SqliteSink::endSession()
+{
+    commit();
+    currentSession = -1;
+}
+
+/*!
+ * Adds a sample of \a value, taken at \a timestamp (in milliseconds since the epoch), to the current session, to be
+ * inserted by the next commit(). Samples added while there is no current session are ignored.
+ */
+void SqliteSink::addSample(const qint64 timestamp, const double value)
+{
+    if (currentSession < 0) {
+        return;
+    }
+    pending.append({ timestamp, value });
+}
+
+/*!
+ * Inserts all pending samples, in a single transaction. Returns \c true on success (including if there were no
+ * pending samples), otherwise rolls back the transaction, sets errorString(), discards the pending samples (so that
+ * a persistent failure, such as a full disk, cannot grow the pending samples without bound), and returns \c false.
+ */
+bool SqliteSink::commit()
+{
+    if ((pending.isEmpty()) || (!isOpen())) {
+        pending.clear();
+        return true;
+    }
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    bool ok = db.transaction();
+    qsizetype index = 0;
+    for (; (ok) && (pending.size() - index >= rowsPerInsert); index += rowsPerInsert) {
+        for (int row = 0; row < rowsPerInsert; ++row) {
+            insertRows->bindValue(row * 3,     currentSession);
+            insertRows->bindValue(row * 3 + 1, pending.at(index + row).timestamp);
+            insertRows->bindValue(row * 3 + 2, pending.at(index + row).value);
+        }
+        ok = insertRows->exec();
+        if (!ok) errorMessage = insertRows->lastError().text();
+    }
+    for (; (ok) && (index < pending.size()); ++index) {
+        insertRow->bindValue(0, currentSession);
+        insertRow->bindValue(1, pending.at(index).timestamp);
+        insertRow->bindValue(2, pending.at(index).value);
+        ok = insertRow->exec();
+        if (!ok) errorMessage = insertRow->lastError().text();
+    }
+    if ((ok) && (!db.commit())) {
+        errorMessage = db.lastError().text();
+        ok = false;
+    }
+
+    if (ok) {
+        stats.samples += (quint64)pending.size();
+        ++stats.transactions;
+    } else {
+        db.rollback();
+        ++stats.failures;
+        qCWarning(lc).noquote() << tr("Failed to store %Ln sample/s in SQLite:", nullptr, (int)pending.size())
+            << errorMessage;
+    }
+    pending.clear();
+    return ok;
+}
+
+/*!
+ * Opens the SQLite database \a fileName, configures it, creates the schema (if necessary), and prepares the sample
+ * inserts. Returns \c true on success, otherwise sets errorString() and returns \c false.
+ */
+bool SqliteSink::initialise(const QString &fileName)
+{
+    if (!QSqlDatabase::isDriverAvailable(u"QSQLITE"_s)) {
+        errorMessage = tr("The Qt SQLite driver is not available");
+        return false;
+    }
+    QSqlDatabase db = QSqlDatabase::addDatabase(u"QSQLITE"_s, connectionName);
+    db.setDatabaseName(fileName);
+    if (!db.open()) {
+        errorMessage = db.lastError().text();
+        return false;
+    }
+
+    // Use a write-ahead log, which only needs syncing at checkpoints, so that readers don't block the writer.
+    QSqlQuery journal(db);
+    if ((!journal.exec(u"PRAGMA journal_mode=WAL"_s)) || (!journal.next())) {
+        errorMessage = journal.lastError().text();
+        return false;
+    }
+    if (const QString mode = journal.value(0).toString(); mode.compare(u"wal"_s, Qt::CaseInsensitive) != 0) {
+        qCDebug(lc).noquote() << tr("SQLite journal mode is %1, not WAL.").arg(mode); // Such as for :memory:.
+    }
+    journal.finish();
+
+    for (const QString &statement: {
+        QStringLiteral("PRAGMA synchronous=NORMAL"), // Safe, with a write-ahead log, for all but power loss.
+        QStringLiteral("PRAGMA foreign_keys=ON"),
+        QStringLiteral("CREATE TABLE IF NOT EXISTS devices (id INTEGER PRIMARY KEY, name TEXT NOT NULL UNIQUE)"),
+        QStringLiteral("CREATE TABLE IF NOT EXISTS sessions (id INTEGER PRIMARY KEY, "
+            "device_id INTEGER NOT NULL REFERENCES devices(id), command TEXT NOT NULL, mode TEXT NOT NULL, "
+            "unit TEXT, range TEXT, interval INTEGER NOT NULL, started INTEGER NOT NULL)"),
+        QStringLiteral("CREATE TABLE IF NOT EXISTS samples (session_id INTEGER NOT NULL REFERENCES sessions(id), "
+            "timestamp INTEGER NOT NULL, value REAL)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS samples_session_timestamp ON samples (session_id, timestamp)"),
+        QStringLiteral("CREATE VIEW IF NOT EXISTS readings AS SELECT devices.name AS device, sessions.command, "
+            "sessions.mode, sessions.unit, sessions.range, samples.timestamp, samples.value FROM samples "
+            "JOIN sessions ON sessions.id = samples.session_id JOIN devices ON devices.id = sessions.device_id"),
+    }) {
+        if (!exec(statement)) {
+            return false;
+        }
+    }
+
+    // Prepare the inserts once, for re-use by every commit.
+    QString values;
+    for (int row = 0; row < rowsPerInsert; ++row) {
+        values += (row == 0) ? u"(?,?,?)"_s : u",(?,?,?)"_s;
+    }
+    insertRows = new QSqlQuery(db);
+    insertRow = new QSqlQuery(db);
+    if (!insertRows->prepare(u"INSERT INTO samples (session_id, timestamp, value) VALUES "_s + values)) {
+        errorMessage = insertRows->lastError().text();
+        return false;
+    }
+    if (!insertRow->prepare(u"INSERT INTO samples (session_id, timestamp, value) VALUES (?,?,?)"_s)) {
+        errorMessage = insertRow->lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * Executes \a statement on this sink's database. Returns \c true on success, otherwise sets errorString() and
+ * returns \c false.
+ */
+bool SqliteSink::exec(const QString &statement)
+{
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    if (!query.exec(statement)) {
+        errorMessage = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * Returns the row ID of \a session, inserting its device and the session itself first, if not already in the
+ * database. Returns -1 on failure.
+ */
+qint64 SqliteSink::findOrInsertSession(const Session &session)
+{
+    if (!isOpen()) {
+        errorMessage = tr("The SQLite database is not open");
+        return -1;
+    }
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    QSqlQuery query(db);
+    query.prepare(u"INSERT OR IGNORE INTO devices (name) VALUES (?)"_s);
+    query.addBindValue(session.device);
+    if (!query.exec()) {
+        errorMessage = query.lastError().text();
+        return -1;
+    }
+
+    // Note, `IS` (unlike `=`) matches null units and ranges too.
+    query.prepare(QStringLiteral("SELECT sessions.id FROM sessions JOIN devices ON devices.id = sessions.device_id "
+        "WHERE devices.name = ? AND command = ? AND mode = ? AND unit IS ? AND range IS ? AND interval = ? "
+        "AND started = ?"));
+    for (const QVariant &value: { QVariant(session.device), QVariant(session.command), QVariant(session.mode),
+                                  QVariant(session.unit), QVariant(session.range), QVariant(session.interval),
+                                  QVariant(session.started) }) {
+        query.addBindValue(value);
+    }
+    if (!query.exec()) {
+        errorMessage = query.lastError().text();
+        return -1;
+    }
+    if (query.next()) {
+        return query.value(0).toLongLong(); // Resuming an existing session.
+    }
+
+    query.prepare(QStringLiteral("INSERT INTO sessions (device_id, command, mode, unit, range, interval, started) "
+        "SELECT id, ?, ?, ?, ?, ?, ? FROM devices WHERE name = ?"));
+    for (const QVariant &value: { QVariant(session.command), QVariant(session.mode), QVariant(session.unit),
+                                  QVariant(session.range), QVariant(session.interval), QVariant(session.started),
+                                  QVariant(session.device) }) {
+        query.addBindValue(value);
+    }
+    if (!query.exec()) {
+        errorMessage = query.lastError().text();
+        return -1;
+    }
+    return query.lastInsertId().toLongLong();
+}
+
+/*!
+ * Closes this sink's database connection (if open), discarding its prepared statements.
+ */
+void SqliteSink::close()
+{
+    delete insertRows;
+    delete insertRow;
+    insertRows = insertRow = nullptr;
+    currentSession = -1;
+    if (QSqlDatabase::contains(connectionName)) {
+        QSqlDatabase::database(connectionName, false).close();
+        QSqlDatabase::removeDatabase(connectionName); // Note, all queries on the connection must be destroyed first.
+    }
+}
+
+/*!
+ * Returns \c true if sessions \a a and \a b are the same, apart from (perhaps) their start times.
+ */
+bool SqliteSink::sameSession(const Session &a, const Session &b)
+{
+    return (a.device == b.device) && (a.command == b.command) && (a.mode == b.mode) && (a.unit == b.unit) &&
+           (a.range == b.range) && (a.interval == b.interval);
+}
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_SQLITESINK_H
+#define DOKIT_SQLITESINK_H
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+#include <QVector>
+
+class QSqlQuery;
+
+class SqliteSink : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// A contiguous run of samples from a single device, with the same mode, range and interval.
+    struct Session {
+        QString device;   ///< Device name (or address) the samples were read from.
+        QString command;  ///< Kind of samples, such as "meter" or "logger".
+        QString mode;     ///< Mode label, such as "DC voltage".
+        QString unit;     ///< Unit label, such as "Vdc", or a null string if the mode has no unit.
+        QString range;    ///< Range label, such as "Up to 30V", or a null string if the mode has no range.
+        quint32 interval; ///< Sampling (or update) interval, in milliseconds.
+        qint64 started;   ///< Start of the session, in milliseconds since the epoch.
+    };
+
+    /// Storage statistics.
+    struct Statistics {
+        quint64 samples { 0 };      ///< Number of samples committed.
+        quint64 transactions { 0 }; ///< Number of transactions committed.
+        quint64 sessions { 0 };     ///< Number of sessions started (or resumed).
+        quint64 failures { 0 };     ///< Number of failed transactions, whose samples were discarded.
+    };
+
+    static constexpr int rowsPerInsert { 100 }; ///< Rows per multi-row insert; three bound values each.
+
+    explicit SqliteSink(QObject * const parent = nullptr);
+    ~SqliteSink() override;
+
+    bool open(const QString &fileName);
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+    Statistics statistics() const;
+
+    qint64 sessionId() const;
+    bool setSession(const Session &session);
+    void endSession();
+
+    void addSample(const qint64 timestamp, const double value);
+    bool commit();
+
+private:
+    /// A single sample, not yet committed.
+    struct Sample {
+        qint64 timestamp; ///< Time of the sample, in milliseconds since the epoch.
+        double value;     ///< Value of the sample.
+    };
+
+    QString connectionName;            ///< Name of this sink's (unique) database connection.
+    QString errorMessage;              ///< Description of the last error, if any.
+    QSqlQuery * insertRows { nullptr }; ///< Prepared insert of #rowsPerInsert samples.
+    QSqlQuery * insertRow { nullptr };  ///< Prepared insert of a single sample.
+    Session session { };               ///< Current session, if #currentSession is valid.
+    qint64 currentSession { -1 };      ///< Row ID of the current session, or -1 if none.
+    QVector<Sample> pending;           ///< Samples added to the current session, but not yet committed.
+    Statistics stats;                  ///< Storage statistics.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.sqlite", QtInfoMsg); ///< Logging category for SQLite storage.
+
+    bool initialise(const QString &fileName);
+    bool exec(const QString &statement);
+    qint64 findOrInsertSession(const Session &session);
+    void close();
+
+    static bool sameSession(const Session &a, const Session &b);
+
+    QTPOKIT_BEFRIEND_TEST(SqliteSink)
+};
+
+#endif // DOKIT_SQLITESINK_H
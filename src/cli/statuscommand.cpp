@@ -5,18 +5,35 @@
 #include "../stringliterals_p.h"
 
 #include <qtpokit/pokitdevice.h>
+#include <qtpokit/statusmonitor.h>
 
+#include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
 
 #include <iostream>
 
+// Qt 6.5.0 added new QDateTime::fromSecsSinceEpoch() and fromMSecsSinceEpoch()
+// overloads, then Qt 6.6.0 deprecated some of of the older ones.
+#if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
+    #define DOKIT_QT_UTC Qt::UTC
+#else
+    #include <QTimeZone>
+    #define DOKIT_QT_UTC QTimeZone::UTC
+#endif
+
 DOKIT_USE_STRINGLITERALS
 
 /*!
  * \class StatusCommand
  *
  * The StatusCommand class implements the `status` CLI command.
+ *
+ * Alternatively, with the `watch` option, the StatusCommand class stays connected, and outputs the device's status
+ * only when it changes (as reported by status notifications, coalesced over `--interval` via StatusMonitor), along
+ * with any low battery (per `--low-battery`, if given, or else the device's own battery status) and charging alerts.
+ * This is much cheaper than polling with repeated `status` commands, since each of those must connect, and discover
+ * the device's services, again.
  */
 
 /*!
@@ -35,7 +52,11 @@ QStringList StatusCommand::requiredOptions(const QCommandLineParser &parser) con
 
 QStringList StatusCommand::supportedOptions(const QCommandLineParser &parser) const
 {
-    return DeviceCommand::supportedOptions(parser);
+    return DeviceCommand::supportedOptions(parser) + QStringList{
+        u"interval"_s,
+        u"low-battery"_s,
+        u"watch"_s,
+    };
 }
 
 /*!
@@ -46,11 +67,40 @@ QStringList StatusCommand::supportedOptions(const QCommandLineParser &parser) co
  */
 QStringList StatusCommand::processOptions(const QCommandLineParser &parser)
 {
+    watch = parser.isSet(u"watch"_s); // Before the base class's processing, since NDJSON output depends on it.
     QStringList errors = DeviceCommand::processOptions(parser);
     if (!errors.isEmpty()) {
         return errors;
     }
+    if ((watch) && (!parser.isSet(u"output"_s))) {
+        format = OutputFormat::Ndjson; // Compact, and easily filtered, so the natural default for watching.
+    }
 
+    // Parse the interval option.
+    if (parser.isSet(u"interval"_s)) {
+        const QString value = parser.value(u"interval"_s);
+        const quint32 interval = parseNumber<std::milli>(value, u"s"_s, 500);
+        if (!watch) {
+            errors.append(tr("Missing required option for --%1: --%2").arg(u"interval"_s, u"watch"_s));
+        } else if (interval == 0) {
+            errors.append(tr("Invalid interval value: %1").arg(value));
+        } else {
+            coalesceInterval = interval;
+        }
+    }
+
+    // Parse the low-battery option.
+    if (parser.isSet(u"low-battery"_s)) {
+        const QString value = parser.value(u"low-battery"_s);
+        const quint32 threshold = parseNumber<std::milli>(value, u"V"_s, 50); // mV.
+        if (!watch) {
+            errors.append(tr("Missing required option for --%1: --%2").arg(u"low-battery"_s, u"watch"_s));
+        } else if (threshold == 0) {
+            errors.append(tr("Invalid low-battery value: %1").arg(value));
+        } else {
+            lowBatteryThreshold = threshold;
+        }
+    }
     return errors;
 }
 
@@ -69,10 +119,31 @@ AbstractPokitService * StatusCommand::getService()
     return service;
 }
 
+/*!
+ * \copybrief DeviceCommand::usesDiscoveredValues
+ *
+ * This override returns \c true, since this command outputs the StatusService values read during service discovery.
+ */
+bool StatusCommand::usesDiscoveredValues() const
+{
+    return true;
+}
+
+/*!
+ * \copybrief AbstractCommand::supportsNdjsonOutput
+ *
+ * This override returns \c true when watching, since status changes are then output one record at a time.
+ */
+bool StatusCommand::supportsNdjsonOutput() const
+{
+    return watch;
+}
+
 /*!
  * \copybrief DeviceCommand::serviceDetailsDiscovered
  *
- * This override fetches the current device's status, and outputs it in the selected format.
+ * This override fetches the current device's status, and outputs it in the selected format, or begins watching for
+ * status changes, if the `watch` option was given.
  */
 void StatusCommand::serviceDetailsDiscovered()
 {
@@ -80,10 +151,14 @@ void StatusCommand::serviceDetailsDiscovered()
     const StatusService::DeviceCharacteristics chrs = service->deviceCharacteristics();
     if (chrs.firmwareVersion.isNull()) {
         qCWarning(lc).noquote() << tr("Failed to parse device information");
-        QCoreApplication::exit(EXIT_FAILURE);
+        finish(EXIT_FAILURE);
         return;
     }
-    outputDeviceStatus(chrs);
+    if (watch) {
+        startWatching();
+    } else {
+        outputDeviceStatus(chrs);
+    }
 }
 
 /*!
@@ -168,6 +243,11 @@ void StatusCommand::outputDeviceStatus(const StatusService::DeviceCharacteristic
         }
         std::cout << QJsonDocument(object).toJson().toStdString();
     }   break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::Ndjson:
+    case OutputFormat::NdjsonEnvelope:
     case OutputFormat::Text:
         std::cout << qUtf8Printable(tr("Device name:           %1\n").arg(deviceName));
         std::cout << qUtf8Printable(tr("Firmware version:      %1\n").arg(chrs.firmwareVersion.toString()));
@@ -196,3 +276,89 @@ void StatusCommand::outputDeviceStatus(const StatusService::DeviceCharacteristic
     }
     if (device) disconnect(); // Will exit the application once disconnected.
 }
+
+/*!
+ * Begins watching the device's status, via status notifications, outputting the (already discovered) current status
+ * straight away, and then any changes, and alerts, until interrupted.
+ */
+void StatusCommand::startWatching()
+{
+    Q_ASSERT(service);
+    if (!monitor) {
+        monitor = new StatusMonitor(service, this);
+        monitor->setCoalesceInterval(coalesceInterval);
+        if (lowBatteryThreshold > 0) {
+            monitor->setLowBatteryThreshold((float)lowBatteryThreshold / 1000.0f);
+        }
+        connect(monitor, &StatusMonitor::statusChanged, this, [this](const StatusService::Status &status) {
+            outputStatusChange(u"StatusChanged"_s, status, QDateTime::currentMSecsSinceEpoch());
+        });
+        connect(monitor, &StatusMonitor::alertRaised, this,
+            [this](const StatusMonitor::Alert alert, const StatusService::Status &status) {
+                outputStatusChange(StatusMonitor::toString(alert), status, QDateTime::currentMSecsSinceEpoch());
+            });
+    }
+    qCInfo(lc).noquote() << tr("Watching for status changes, coalesced over %L1ms...").arg(coalesceInterval);
+    monitor->addStatus(service->status());
+    service->enableStatusNotifications();
+}
+
+/*!
+ * Outputs \a status, being either a status change, or an alert, as named by \a event, at \a timestamp (in
+ * milliseconds since the epoch), in the selected output format.
+ */
+void StatusCommand::outputStatusChange(const QString &event, const StatusService::Status &status,
+                                       const qint64 timestamp)
+{
+    const QString statusLabel = StatusService::toString(status.deviceStatus);
+    const QString batteryLabel = StatusService::toString(status.batteryStatus);
+    const QString switchLabel = status.switchPosition ? StatusService::toString(*status.switchPosition) : QString();
+    const QString chargingLabel = status.chargingStatus ? StatusService::toString(*status.chargingStatus) : QString();
+
+    switch (format) {
+    case OutputFormat::Csv:
+        for (; showCsvHeader; showCsvHeader = false) {
+            output(tr("timestamp,event,device_status,battery_voltage,battery_status,switch_position,"
+                      "charging_status\n"));
+        }
+        output(QString::fromLatin1("%1,%2,%3,%4,%5,%6,%7\n").arg(timestamp).arg(event.toLower(), statusLabel.toLower())
+            .arg(status.batteryVoltage).arg(batteryLabel.toLower(), switchLabel.toLower(), chargingLabel.toLower()));
+        break;
+    case OutputFormat::Json:
+    case OutputFormat::Ndjson: {
+        QJsonObject battery{
+            { u"level"_s,  status.batteryVoltage },
+        };
+        if (!batteryLabel.isNull()) {
+            battery.insert(u"status"_s, batteryLabel);
+        }
+        QJsonObject object{
+            { u"timestamp"_s,    timestamp },
+            { u"event"_s,        event },
+            { u"deviceStatus"_s, statusLabel },
+            { u"battery"_s,      battery },
+        };
+        if (status.switchPosition) {
+            object.insert(u"switchPosition"_s, switchLabel);
+        }
+        if (status.chargingStatus) {
+            object.insert(u"chargingStatus"_s, chargingLabel);
+        }
+        output((format == OutputFormat::Json) ? QJsonDocument(object).toJson()
+            : QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+    }   break;
+    case OutputFormat::Arrow:
+    case OutputFormat::LineProtocol:
+    case OutputFormat::Binary:
+    case OutputFormat::NdjsonEnvelope:
+    case OutputFormat::Text:
+        output(tr("%1 %2 %3 %4V %5%6%7\n").arg(QDateTime::fromMSecsSinceEpoch(timestamp, DOKIT_QT_UTC)
+            .toString(Qt::ISODateWithMs),
+            event, statusLabel).arg(status.batteryVoltage)
+            .arg(batteryLabel.isNull() ? QString::fromLatin1("N/A") : batteryLabel,
+                 switchLabel.isNull() ? QString() : u' ' + switchLabel,
+                 chargingLabel.isNull() ? QString() : u' ' + chargingLabel));
+        break;
+    }
+    outputBatchComplete();
+}
@@ -5,6 +5,8 @@
 
 #include <qtpokit/statusservice.h>
 
+QTPOKIT_FORWARD_DECLARE_CLASS(StatusMonitor)
+
 class StatusCommand : public DeviceCommand
 {
     Q_OBJECT
@@ -20,14 +22,23 @@ public slots:
 
 protected:
     AbstractPokitService * getService() override;
+    bool usesDiscoveredValues() const override;
+    bool supportsNdjsonOutput() const override;
 
 protected slots:
     void serviceDetailsDiscovered() override;
 
 private:
     StatusService * service { nullptr }; ///< Bluetooth service this command interacts with.
+    bool watch { false };                ///< Whether to watch for status changes, instead of exiting.
+    quint32 coalesceInterval { 1000 };   ///< Milliseconds over which to coalesce status notifications, when watching.
+    quint32 lowBatteryThreshold { 0 };   ///< Battery millivolts below which to alert, or 0 for the device's own status.
+    bool showCsvHeader { true };         ///< Whether or not to show a header as the first line of CSV output.
+    StatusMonitor * monitor { nullptr }; ///< Monitors status notifications, when watching.
 
     void outputDeviceStatus(const StatusService::DeviceCharacteristics &chrs);
+    void startWatching();
+    void outputStatusChange(const QString &event, const StatusService::Status &status, const qint64 timestamp);
 
     QTPOKIT_BEFRIEND_TEST(StatusCommand)
 };
@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "timerwheel.h"
+
+#include <utility>
+
+/*!
+ * \class TimerWheel
+ *
+ * The TimerWheel class holds any number of one-shot timers, identified by ID, in a hierarchical timer wheel, so that
+ * scheduling, cancelling, and expiring each timer costs a constant amount of work, no matter how many timers are held.
+ *
+ * Time is divided into ticks of tickInterval() milliseconds. The finest level has one slot per tick, for the next
+ * #slotCount ticks; each coarser level has one slot per full rotation of the level below it. Timers are placed in the
+ * finest level that can hold them, and as each coarser slot comes due, its timers are cascaded down into the finer
+ * levels, until they reach the finest level, and expire. Timers due beyond the wheel's range (#maxTicks) are held in
+ * the coarsest level, and re-placed each time it rotates, until they are in range.
+ *
+ * Rescheduling, and cancelling, timers leaves any stale slot entries in place, to be discarded (cheaply) when their
+ * slot comes due, rather than searching for them.
+ *
+ * The wheel does not run by itself; its owner calls advance() periodically (typically once per tick, from a QTimer)
+ * with the current time, on whatever monotonic clock it schedules timers with.
+ */
+
+/*!
+ * Constructs a new, empty, timer wheel with ticks of \a tickInterval milliseconds (at least 1), starting at \a now.
+ */
+TimerWheel::TimerWheel(const qint64 tickInterval, const qint64 now)
+    : interval(qMax<qint64>(tickInterval, 1)), tick(now / interval)
+{
+
+}
+
+/*!
+ * Returns the length of each tick, in milliseconds.
+ */
+qint64 TimerWheel::tickInterval() const
+{
+    return interval;
+}
+
+/*!
+ * Returns the time of the most recently processed tick. That is, the time this wheel has been advanced to, rounded
+ * down to a whole tick.
+ */
+qint64 TimerWheel::currentTime() const
+{
+    return tick * interval;
+}
+
+/*!
+ * Returns the number of timers currently scheduled.
+ */
+int TimerWheel::size() const
+{
+    return (int)timers.size();
+}
+
+/*!
+ * Returns \c true if the timer with \a id is currently scheduled.
+ */
+bool TimerWheel::contains(const quint32 id) const
+{
+    return timers.contains(id);
+}
+
+/*!
+ * Returns the time the timer with \a id is due to expire, rounded up to a whole tick, or -1 if no such timer is
+ * scheduled.
+ */
+qint64 TimerWheel::dueTime(const quint32 id) const
+{
+    const auto iter = timers.constFind(id);
+    return (iter == timers.constEnd()) ? -1 : iter->dueTick * interval;
+}
+
+/*!
+ * Schedules the timer with \a id to expire at time \a due, replacing any existing schedule for \a id. Timers due at,
+ * or before, the current tick expire on the next tick.
+ */
+void TimerWheel::schedule(const quint32 id, const qint64 due)
+{
+    const qint64 dueTick = (due <= currentTime()) ? tick + 1 : (due + interval - 1) / interval;
+    const Timer timer{ qMax(dueTick, tick + 1), ++generations };
+    timers.insert(id, timer);
+    place(id, timer);
+}
+
+/*!
+ * Cancels the timer with \a id, returning \c true if it was scheduled.
+ */
+bool TimerWheel::cancel(const quint32 id)
+{
+    return timers.remove(id) > 0;
+}
+
+/*!
+ * Advances this wheel, one tick at a time, to time \a now, and returns the IDs of all timers that expired along the
+ * way, in the order they expired. Expired timers are no longer scheduled, so may be scheduled again as needed.
+ */
+QVector<quint32> TimerWheel::advance(const qint64 now)
+{
+    QVector<quint32> expired;
+    const qint64 target = now / interval;
+    while (tick < target) {
+        if (timers.isEmpty()) {
+            tick = target; // Nothing to expire, so no need to visit the remaining slots.
+            break;
+        }
+        ++tick;
+        // Cascade coarsest first, since timers cascaded from one level may land in the next level's current slot.
+        for (int level = levelCount - 1; level > 0; --level) {
+            if ((tick & ((qint64(1) << (slotBits * level)) - 1)) == 0) {
+                cascade(level);
+            }
+        }
+        const QVector<SlotEntry> entries = std::exchange(levels[0][tick & (slotCount - 1)], {});
+        for (const SlotEntry &entry: entries) {
+            const auto iter = timers.constFind(entry.id);
+            if ((iter != timers.constEnd()) && (iter->generation == entry.generation)) {
+                Q_ASSERT(iter->dueTick == tick);
+                expired.append(entry.id);
+                timers.erase(iter);
+            }
+        }
+    }
+    return expired;
+}
+
+/*!
+ * Adds a slot entry for \a timer, with \a id, to the finest level that can hold it, relative to the current tick.
+ */
+void TimerWheel::place(const quint32 id, const Timer &timer)
+{
+    const qint64 delta = qMin(timer.dueTick - tick, maxTicks - 1); // Clamped to the coarsest level's range.
+    const qint64 placeTick = tick + delta;
+    int level = 0;
+    while ((level < levelCount - 1) && (delta >= (qint64(1) << (slotBits * (level + 1))))) {
+        ++level;
+    }
+    levels[level][(placeTick >> (slotBits * level)) & (slotCount - 1)].append({ id, timer.generation });
+}
+
+/*!
+ * Re-places all (still current) timers from \a level's slot for the current tick into finer levels.
+ */
+void TimerWheel::cascade(const int level)
+{
+    const QVector<SlotEntry> entries = std::exchange(levels[level][(tick >> (slotBits * level)) & (slotCount - 1)],
+                                                     {});
+    for (const SlotEntry &entry: entries) {
+        const auto iter = timers.constFind(entry.id);
+        if ((iter != timers.constEnd()) && (iter->generation == entry.generation)) {
+            place(entry.id, *iter);
+        }
+    }
+}
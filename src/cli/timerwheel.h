@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_TIMERWHEEL_H
+#define DOKIT_TIMERWHEEL_H
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QHash>
+#include <QVector>
+
+#include <array>
+
+class TimerWheel
+{
+public:
+    static constexpr int levelCount { 4 };     ///< Number of levels (wheels) in the hierarchy.
+    static constexpr int slotBits { 6 };       ///< Number of bits of the tick count resolved by each level.
+    static constexpr int slotCount { 1 << slotBits }; ///< Number of slots in each level.
+    static constexpr qint64 maxTicks { qint64(1) << (slotBits * levelCount) }; ///< Range of the wheel, in ticks.
+
+    explicit TimerWheel(const qint64 tickInterval = 100, const qint64 now = 0);
+
+    qint64 tickInterval() const;
+    qint64 currentTime() const;
+    int size() const;
+    bool contains(const quint32 id) const;
+    qint64 dueTime(const quint32 id) const;
+
+    void schedule(const quint32 id, const qint64 due);
+    bool cancel(const quint32 id);
+    QVector<quint32> advance(const qint64 now);
+
+private:
+    /// A single timer, as held in one of the wheel's slots.
+    struct Timer {
+        qint64 dueTick { 0 };     ///< Tick at which this timer expires.
+        quint32 generation { 0 }; ///< Incremented each time the timer is (re)scheduled, to invalidate stale slots.
+    };
+
+    /// A reference to a timer, from a slot, which is stale if the timer has since been rescheduled, or cancelled.
+    struct SlotEntry {
+        quint32 id;         ///< Timer ID.
+        quint32 generation; ///< Timer generation when this entry was added.
+    };
+
+    using Level = std::array<QVector<SlotEntry>, slotCount>; ///< A single wheel of slots.
+
+    qint64 interval;                     ///< Length of each tick, in milliseconds.
+    qint64 tick;                         ///< Most recent tick processed.
+    QHash<quint32, Timer> timers;        ///< Scheduled timers, by ID.
+    std::array<Level, levelCount> levels; ///< The wheels, from finest (one tick per slot) to coarsest.
+    quint32 generations { 0 };           ///< Source of timer generations.
+
+    void place(const quint32 id, const Timer &timer);
+    void cascade(const int level);
+
+    QTPOKIT_BEFRIEND_TEST(TimerWheel)
+};
+
+#endif // DOKIT_TIMERWHEEL_H
@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "wavwriter.h"
+#include "outputfilewriter.h"
+#include "../stringliterals_p.h"
+
+#include <QFile>
+#include <QtEndian>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class WavWriter
+ *
+ * The WavWriter class writes DSO samples to a mono, 16-bit PCM, WAV file, so that captures (such as audio-band AC
+ * measurements) may be opened directly by audio tools.
+ *
+ * The file's sample rate is the capture's sampling rate, and its samples are the device's raw (signed 16-bit) samples,
+ * written straight from each notification's buffer, without any conversion to floating point. Since PCM samples have
+ * no units, the capture's scale (the value of each sample's least significant bit), unit, mode and range are written
+ * to a standard `LIST`/`INFO` chunk's comment (`ICMT`), such as `scale=0.000244140625;unit=Vdc;mode=DC voltage`, that
+ * most audio tools preserve, and display.
+ *
+ * Samples are streamed to the file as they arrive, and the RIFF and data chunk sizes updated by commit() (such as
+ * after each capture), so the file is always valid up to the last commit, even if the command is interrupted. The
+ * metadata chunk precedes the data chunk, so that the data chunk may keep growing, and successive (such as continuous,
+ * or long) captures are appended to the same file. Only if a later capture's sampling rate, scale, mode or range
+ * differs (such as with continuous auto-ranging), or the file reaches the format's 4 GiB size limit, is a new file
+ * started, named after the first, as per OutputFileWriter::rotatedFileName(), such as `capture.1.wav`.
+ */
+
+namespace {
+
+/// Appends \a value to \a buffer, as a little-endian unsigned 16-bit integer.
+void appendUInt16(QByteArray &buffer, const quint16 value)
+{
+    char bytes[sizeof(quint16)];
+    qToLittleEndian<quint16>(value, bytes);
+    buffer.append(bytes, sizeof(bytes));
+}
+
+/// Appends \a value to \a buffer, as a little-endian unsigned 32-bit integer.
+void appendUInt32(QByteArray &buffer, const quint32 value)
+{
+    char bytes[sizeof(quint32)];
+    qToLittleEndian<quint32>(value, bytes);
+    buffer.append(bytes, sizeof(bytes));
+}
+
+}
+
+/*!
+ * Constructs a new WAV writer with \a parent. Call open() to set the file to write, before writing any samples.
+ */
+WavWriter::WavWriter(QObject * const parent) : QObject(parent)
+{
+
+}
+
+/*!
+ * Destroys this writer, after committing any samples not yet committed.
+ */
+WavWriter::~WavWriter()
+{
+    commit();
+    qCDebug(lc).noquote() << tr("Wrote %L1 sample/s to %Ln WAV file/s.", nullptr, (int)stats.files)
+        .arg(stats.samples);
+}
+
+/*!
+ * Creates (or truncates) \a fileName, for writing samples to. Returns \c true on success, otherwise sets errorString()
+ * and returns \c false.
+ *
+ * The file's header is not written until the first samples are, since the header depends on their sampling rate.
+ */
+bool WavWriter::open(const QString &fileName)
+{
+    commit();
+    baseName = fileName;
+    fileIndex = 0;
+    return openFile(fileName);
+}
+
+/*!
+ * Returns \c true if a file has been opened successfully.
+ */
+bool WavWriter::isOpen() const
+{
+    return (file != nullptr);
+}
+
+/*!
+ * Returns the name of the file currently being written, if open, otherwise a null string.
+ */
+QString WavWriter::fileName() const
+{
+    return (file) ? file->fileName() : QString();
+}
+
+/*!
+ * Returns a human-readable description of the last error, if any.
+ */
+QString WavWriter::errorString() const
+{
+    return errorMessage;
+}
+
+/*!
+ * Returns this writer's statistics.
+ */
+WavWriter::Statistics WavWriter::statistics() const
+{
+    return stats;
+}
+
+/*!
+ * Appends \a samples, captured with \a metadata, to the current file. The \a context provides the labels for the
+ * file's metadata chunk. Returns \c true on success, otherwise sets errorString() and returns \c false.
+ *
+ * If \a metadata's sampling rate, scale, mode or range differ from the current file's samples, or the file would
+ * otherwise grow beyond #maxDataSize, then the current file is committed, and a new one started.
+ */
+bool WavWriter::write(const DsoService::Metadata &metadata, const MeasurementFormatter::Context &context,
+                      const DsoService::Samples &samples)
+{
+    const qint64 size = samples.size() * (qint64)sizeof(qint16);
+#if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN)
+    // Samples are already little-endian in memory, so can be written verbatim.
+    return writeData(metadata, context, reinterpret_cast<const char *>(samples.constData()), size);
+#else
+    QByteArray bytes(size, Qt::Uninitialized);
+    qToLittleEndian<qint16>(samples.constData(), samples.size(), bytes.data());
+    return writeData(metadata, context, bytes.constData(), size);
+#endif
+}
+
+/*!
+ * Appends raw \a samples, as little-endian 16-bit integers (such as DsoService::rawSamplesRead provides), to the
+ * current file, as per write(), but without decoding them first. Any trailing odd byte is ignored.
+ */
+bool WavWriter::writeRaw(const DsoService::Metadata &metadata, const MeasurementFormatter::Context &context,
+                         const QByteArray &samples)
+{
+    // WAV samples are little-endian too, so can be written verbatim.
+    return writeData(metadata, context, samples.constData(), samples.size() & ~(qsizetype)1);
+}
+
+/*!
+ * Updates the current file's header to include all samples written so far, and flushes the file to disk. Returns
+ * \c true on success (including when there is nothing to commit), otherwise sets errorString() and returns \c false.
+ */
+bool WavWriter::commit()
+{
+    if ((!file) || (!headerWritten) || (committedSize == dataSize)) {
+        return true;
+    }
+    const QByteArray bytes = header(format.samplingRate, fileComment, dataSize);
+    Q_ASSERT(bytes.size() == dataOffset);
+    if ((!file->seek(0)) || (file->write(bytes) != bytes.size()) || (!file->seek(dataOffset + dataSize)) ||
+        (!file->flush())) {
+        return fail(file->errorString());
+    }
+    committedSize = dataSize;
+    ++stats.commits;
+    return true;
+}
+
+/*!
+ * Returns the comment written to each file's metadata chunk, for samples of \a scale, within \a context. That is,
+ * semicolon-separated `key=value` pairs, such as `scale=0.000244140625;unit=Vdc;mode=DC voltage;range=Up to 2V`,
+ * with any empty values omitted.
+ *
+ * The scale is written with enough digits to be read back exactly.
+ */
+QByteArray WavWriter::comment(const float scale, const MeasurementFormatter::Context &context)
+{
+    QByteArray comment = "scale=" + QByteArray::number(scale, 'g', 9);
+    const std::pair<const char *, QString> labels[] {
+        { "unit", context.unit }, { "mode", context.mode }, { "range", context.range },
+    };
+    for (const auto &[key, value]: labels) {
+        if (!value.isEmpty()) {
+            comment.append(';').append(key).append('=').append(value.toUtf8());
+        }
+    }
+    return comment;
+}
+
+/*!
+ * Creates (or truncates) \a fileName, and makes it the current file, without writing its header yet. Returns \c true
+ * on success, otherwise sets errorString() and returns \c false.
+ */
+bool WavWriter::openFile(const QString &fileName)
+{
+    delete file;
+    file = new QFile(fileName, this);
+    headerWritten = false;
+    dataOffset = 0;
+    dataSize = 0;
+    committedSize = -1;
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = file->errorString();
+        delete file;
+        file = nullptr;
+        return false;
+    }
+    qCDebug(lc).noquote() << tr("Opened WAV file %1.").arg(fileName);
+    return true;
+}
+
+/*!
+ * Writes the current file's header, for samples captured with \a metadata, which then become the current file's
+ * format. The \a context provides the labels for the file's metadata chunk. Returns \c true on success, otherwise
+ * sets errorString() and returns \c false.
+ */
+bool WavWriter::startFile(const DsoService::Metadata &metadata, const MeasurementFormatter::Context &context)
+{
+    Q_ASSERT(file);
+    if (metadata.samplingRate == 0) {
+        return fail(tr("Unsupported sampling rate: %1").arg(metadata.samplingRate));
+    }
+    format = { metadata.samplingRate, metadata.scale, metadata.mode, metadata.range };
+    fileComment = comment(metadata.scale, context);
+    const QByteArray bytes = header(format.samplingRate, fileComment, 0);
+    if (file->write(bytes) != bytes.size()) {
+        return fail(file->errorString());
+    }
+    headerWritten = true;
+    dataOffset = bytes.size();
+    committedSize = 0;
+    ++stats.files;
+    return true;
+}
+
+/*!
+ * Appends \a size bytes of little-endian samples, from \a data, for write() and writeRaw().
+ */
+bool WavWriter::writeData(const DsoService::Metadata &metadata, const MeasurementFormatter::Context &context,
+                          const char * const data, const qint64 size)
+{
+    if ((!file) || (size <= 0)) {
+        return (file != nullptr);
+    }
+    if ((headerWritten) && ((!sameFormat(format, metadata)) || (dataSize + size > maxDataSize))) {
+        commit();
+        const QString nextName = OutputFileWriter::rotatedFileName(baseName, ++fileIndex);
+        qCInfo(lc).noquote() << tr("Starting new WAV file %1.").arg(nextName);
+        if (!openFile(nextName)) {
+            return fail(errorMessage);
+        }
+    }
+    if ((!headerWritten) && (!startFile(metadata, context))) {
+        return false;
+    }
+
+    const qint64 written = file->write(data, size);
+    if (written != size) {
+        return fail(file->errorString());
+    }
+    dataSize += size;
+    stats.samples += size / (qint64)sizeof(qint16);
+    return true;
+}
+
+/*!
+ * Records a failed write, with \a message, which is logged only for the first failure, so that a full (or removed)
+ * disk does not flood the log with one warning per notification. Always returns \c false.
+ */
+bool WavWriter::fail(const QString &message)
+{
+    errorMessage = message;
+    if (++stats.errors == 1) {
+        qCWarning(lc).noquote() << tr("Failed to write WAV file %1: %2").arg(fileName(), message);
+    }
+    return false;
+}
+
+/*!
+ * Returns the header of a WAV file of mono, 16-bit PCM, samples at \a samplingRate, with \a comment in its metadata
+ * chunk, and \a dataSize bytes of samples. That is, the `RIFF` chunk's header, the `fmt ` chunk, the `LIST`/`INFO`
+ * chunk, and the `data` chunk's header, immediately after which the samples follow.
+ */
+QByteArray WavWriter::header(const quint32 samplingRate, const QByteArray &comment, const qint64 dataSize)
+{
+    Q_ASSERT((dataSize >= 0) && (dataSize <= maxDataSize));
+    QByteArray info("INFO");
+    const qsizetype commentSize = comment.size() + 1; // Including the null terminator.
+    info.append("ICMT");
+    appendUInt32(info, (quint32)commentSize);
+    info.append(comment).append('\0');
+    if (commentSize % 2 != 0) {
+        info.append('\0'); // Chunks are word-aligned.
+    }
+
+    QByteArray header;
+    header.reserve(12 + 24 + 8 + info.size() + 8);
+    header.append("RIFF");
+    appendUInt32(header, (quint32)(4 + 24 + 8 + info.size() + 8 + dataSize));
+    header.append("WAVE");
+    header.append("fmt ");
+    appendUInt32(header, 16);
+    appendUInt16(header, 1); // PCM.
+    appendUInt16(header, 1); // Mono.
+    appendUInt32(header, samplingRate);
+    appendUInt32(header, samplingRate * (quint32)sizeof(qint16)); // Bytes per second.
+    appendUInt16(header, sizeof(qint16));                       // Bytes per (single channel) frame.
+    appendUInt16(header, 16);                                   // Bits per sample.
+    header.append("LIST");
+    appendUInt32(header, (quint32)info.size());
+    header.append(info);
+    header.append("data");
+    appendUInt32(header, (quint32)dataSize);
+    return header;
+}
+
+/*!
+ * Returns \c true if samples captured with \a metadata may be appended to a file of \a format, otherwise \c false.
+ */
+bool WavWriter::sameFormat(const Format &format, const DsoService::Metadata &metadata)
+{
+    return (format.samplingRate == metadata.samplingRate) && (format.scale == metadata.scale) &&
+        (format.mode == metadata.mode) && (format.range == metadata.range);
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_WAVWRITER_H
+#define DOKIT_WAVWRITER_H
+
+#include "measurementformatter.h"
+
+#include <qtpokit/dsoservice.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+
+class QFile;
+
+class WavWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Writing statistics.
+    struct Statistics {
+        quint64 samples { 0 }; ///< Number of samples written.
+        quint64 commits { 0 }; ///< Number of times the file's header was updated to include all samples written.
+        quint64 files { 0 };   ///< Number of files started.
+        quint64 errors { 0 };  ///< Number of failed writes.
+    };
+
+    static constexpr qint64 maxDataSize { 0xFFFF0000ll }; ///< Largest data chunk a single file may hold, in bytes.
+
+    explicit WavWriter(QObject * const parent = nullptr);
+    ~WavWriter() override;
+
+    bool open(const QString &fileName);
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+    Statistics statistics() const;
+
+    bool write(const DsoService::Metadata &metadata, const MeasurementFormatter::Context &context,
+               const DsoService::Samples &samples);
+    bool writeRaw(const DsoService::Metadata &metadata, const MeasurementFormatter::Context &context,
+                  const QByteArray &samples);
+    bool commit();
+
+    static QByteArray comment(const float scale, const MeasurementFormatter::Context &context);
+
+private:
+    /// Properties that all samples within a single file share.
+    struct Format {
+        quint32 samplingRate { 0 };                       ///< Sample rate, in Hertz.
+        float scale { 0.0f };                             ///< Value of each sample's least significant bit.
+        DsoService::Mode mode { DsoService::Mode::Idle }; ///< DSO mode the samples were captured in.
+        quint8 range { 0 };                               ///< DSO range the samples were captured in.
+    };
+
+    QString baseName;              ///< Name of the first file; later files are numbered after it.
+    QFile * file { nullptr };      ///< File currently being written, if any.
+    int fileIndex { 0 };           ///< Number of files started after the first, for naming the next one.
+    bool headerWritten { false };  ///< Whether #file has a header (and therefore, a #format) yet.
+    Format format;                 ///< Properties of the samples in #file, if #headerWritten.
+    QByteArray fileComment;        ///< Comment written to #file's (LIST/INFO) metadata chunk, if #headerWritten.
+    qint64 dataOffset { 0 };       ///< Offset within #file of the data chunk's samples.
+    qint64 dataSize { 0 };         ///< Size of the samples written to #file so far, in bytes.
+    qint64 committedSize { -1 };   ///< Data size last written to #file's header, or -1 if none.
+    QString errorMessage;          ///< Description of the last error, if any.
+    Statistics stats;              ///< Writing statistics.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.wav", QtInfoMsg); ///< Logging category for WAV files.
+
+    bool openFile(const QString &fileName);
+    bool startFile(const DsoService::Metadata &metadata, const MeasurementFormatter::Context &context);
+    bool fail(const QString &message);
+    bool writeData(const DsoService::Metadata &metadata, const MeasurementFormatter::Context &context,
+                   const char * const data, const qint64 size);
+
+    static QByteArray header(const quint32 samplingRate, const QByteArray &comment, const qint64 dataSize);
+    static bool sameFormat(const Format &format, const DsoService::Metadata &metadata);
+
+    QTPOKIT_BEFRIEND_TEST(WavWriter)
+};
+
+#endif // DOKIT_WAVWRITER_H
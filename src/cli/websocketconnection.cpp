@@ -0,0 +1,373 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "websocketconnection.h"
+#include "../stringliterals_p.h"
+
+#include <QCryptographicHash>
+#include <QHash>
+#include <QTcpSocket>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class WebSocketConnection
+ *
+ * The WebSocketConnection class serves a single WebSocket client, such as a browser dashboard, over an accepted TCP
+ * connection, as a sequential QIODevice of newline-delimited text messages.
+ *
+ * That is, each text message received from the client is read as a single line (with any newlines within the message
+ * replaced by spaces), and each write() is sent to the client as a single text message (without any trailing newline).
+ * So services that speak newline-delimited JSON over local sockets (such as DaemonCommand) may serve WebSocket clients
+ * unchanged.
+ *
+ * Messages are only ever queued in the socket's write buffer, which is bounded by maxQueued(): once a client falls so
+ * far behind that another message would exceed that, messages are dropped (and counted), rather than buffering
+ * without limit. Once the client catches up, it is sent a `{"event":"dropped","dropped":N}` message, with the number
+ * of messages it missed, before the next message. So a slow client (such as one on a congested link) costs a bounded
+ * amount of memory, and never delays any other client, or the acquisition.
+ *
+ * Only the subset of RFC 6455 needed for serving text messages is implemented (with no extensions, or subprotocols),
+ * over plain TCP, so that no additional dependencies are required. Pings are answered, binary messages are rejected,
+ * and malformed frames close the connection.
+ */
+
+/*!
+ * Constructs a new connection, taking ownership of the (already connected) \a socket, with \a parent.
+ */
+WebSocketConnection::WebSocketConnection(QTcpSocket * const socket, QObject * const parent)
+    : QIODevice(parent), socket(socket)
+{
+    socket->setParent(this);
+    QIODevice::open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+    connect(socket, &QTcpSocket::readyRead, this, &WebSocketConnection::readSocket);
+    connect(socket, &QTcpSocket::disconnected, this, &WebSocketConnection::disconnected);
+    if (socket->bytesAvailable() > 0) {
+        readSocket();
+    }
+}
+
+/*!
+ * Returns \c true once the opening handshake has completed, and messages may be sent.
+ */
+bool WebSocketConnection::isHandshakeComplete() const
+{
+    return handshaken;
+}
+
+/*!
+ * Returns the client's address and port, such as for logging.
+ */
+QString WebSocketConnection::peerName() const
+{
+    return u"%1:%2"_s.arg(socket->peerAddress().toString()).arg(socket->peerPort());
+}
+
+/*!
+ * Returns the maximum number of bytes waiting to be sent to the client, beyond which messages are dropped.
+ */
+qint64 WebSocketConnection::maxQueued() const
+{
+    return queueLimit;
+}
+
+/*!
+ * Sets the maximum number of bytes waiting to be sent to the client to \a bytes. The default is #defaultMaxQueued.
+ */
+void WebSocketConnection::setMaxQueued(const qint64 bytes)
+{
+    queueLimit = bytes;
+}
+
+/*!
+ * Returns the number of messages dropped, because the client was not keeping up.
+ */
+quint64 WebSocketConnection::droppedMessages() const
+{
+    return dropped;
+}
+
+bool WebSocketConnection::isSequential() const
+{
+    return true;
+}
+
+qint64 WebSocketConnection::bytesAvailable() const
+{
+    return incoming.size() + QIODevice::bytesAvailable();
+}
+
+bool WebSocketConnection::canReadLine() const
+{
+    return (incoming.contains('\n')) || (QIODevice::canReadLine());
+}
+
+/*!
+ * Closes the connection, with a normal closure (if the handshake has completed), once any queued messages are sent.
+ */
+void WebSocketConnection::close()
+{
+    if ((handshaken) && (!closing)) {
+        closing = true;
+        QByteArray payload(2, Qt::Uninitialized);
+        qToBigEndian<quint16>(1000, payload.data()); // Normal closure.
+        sendFrame(Opcode::Close, payload);
+    }
+    socket->disconnectFromHost();
+    QIODevice::close();
+}
+
+qint64 WebSocketConnection::readData(char * data, qint64 maxSize)
+{
+    const qint64 size = std::min<qint64>(maxSize, incoming.size());
+    std::memcpy(data, incoming.constData(), (size_t)size);
+    incoming.remove(0, (qsizetype)size);
+    return size;
+}
+
+/*!
+ * Sends \a size bytes of \a data (less any trailing newline) to the client as a single text message, unless the
+ * client is too far behind, in which case the message is dropped. Either way, returns \a size.
+ */
+qint64 WebSocketConnection::writeData(const char * data, qint64 size)
+{
+    if ((!handshaken) || (closing)) {
+        return size; // Nothing may be sent before the handshake, or after closing.
+    }
+    const qint64 length = ((size > 0) && (data[size - 1] == '\n')) ? size - 1 : size;
+    if (socket->bytesToWrite() + length > queueLimit) {
+        if (unreported++ == 0) {
+            qCWarning(lc).noquote() << tr("Dropping messages for %1, since it is not keeping up.").arg(peerName());
+        }
+        ++dropped;
+        return size;
+    }
+    if (unreported > 0) {
+        sendFrame(Opcode::Text, R"({"dropped":)" + QByteArray::number(unreported) + R"(,"event":"dropped"})");
+        unreported = 0;
+    }
+    sendFrame(Opcode::Text, QByteArray(data, (qsizetype)length));
+    return size;
+}
+
+/*!
+ * Reads the opening handshake (if not already complete), and then any complete frames, from the socket.
+ */
+void WebSocketConnection::readSocket()
+{
+    received.append(socket->readAll());
+    if (!handshaken) {
+        const qsizetype end = received.indexOf("\r\n\r\n");
+        if (end < 0) {
+            if (received.size() > maxHandshakeSize) {
+                socket->write("HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\n\r\n");
+                socket->disconnectFromHost();
+            }
+            return; // Wait for the rest of the handshake.
+        }
+        bool accepted = false;
+        socket->write(handshakeResponse(received.left(end + 4), accepted));
+        received.remove(0, end + 4);
+        if (!accepted) {
+            qCDebug(lc).noquote() << tr("Rejected non-WebSocket request from %1.").arg(peerName());
+            socket->disconnectFromHost();
+            return;
+        }
+        handshaken = true;
+    }
+    readFrames();
+}
+
+/*!
+ * Handles all complete frames received, and emits readyRead() if any complete text messages were received.
+ */
+void WebSocketConnection::readFrames()
+{
+    bool messages = false;
+    quint8 header = 0;
+    QByteArray payload;
+    for (qsizetype size; (!closing) && ((size = parseFrame(received, header, payload)) != 0);
+         received.remove(0, size)) {
+        if (size < 0) {
+            fail(1002, "Malformed frame"); // Protocol error.
+            break;
+        }
+        const bool fin = (header & 0x80);
+        switch ((Opcode)(header & 0x0F)) {
+        case Opcode::Text:
+        case Opcode::Continuation:
+            if (messageOpen == (((Opcode)(header & 0x0F)) == Opcode::Text)) {
+                fail(1002, "Unexpected continuation"); // A new message before the last ended, or vice versa.
+                break;
+            }
+            message.append(payload);
+            messageOpen = !fin;
+            if (message.size() > maxMessageSize) {
+                fail(1009, "Message too big");
+            } else if (fin) {
+                message.replace('\n', ' ').replace('\r', ' '); // Each message is exactly one line.
+                incoming.append(message + '\n');
+                message.clear();
+                messages = true;
+            }
+            break;
+        case Opcode::Binary:
+            fail(1003, "Binary messages are not supported"); // Unsupported data.
+            break;
+        case Opcode::Ping:
+            sendFrame(Opcode::Pong, payload);
+            break;
+        case Opcode::Pong:
+            break;
+        case Opcode::Close:
+            closing = true;
+            sendFrame(Opcode::Close, payload.left(2)); // Echo the client's status code, if any.
+            socket->disconnectFromHost();
+            break;
+        default:
+            fail(1002, "Unknown opcode");
+        }
+    }
+    if (messages) {
+        emit readyRead();
+    }
+}
+
+/*!
+ * Sends a single (unfragmented) frame of \a opcode, with \a payload, to the client.
+ */
+void WebSocketConnection::sendFrame(const Opcode opcode, const QByteArray &payload)
+{
+    socket->write(encodeFrame(opcode, payload));
+}
+
+/*!
+ * Closes the connection with status \a code, and \a reason, such as for protocol errors.
+ */
+void WebSocketConnection::fail(const quint16 code, const QByteArray &reason)
+{
+    qCDebug(lc).noquote() << tr("Closing connection to %1: %2").arg(peerName(), QString::fromUtf8(reason));
+    QByteArray payload(2, Qt::Uninitialized);
+    qToBigEndian<quint16>(code, payload.data());
+    sendFrame(Opcode::Close, payload + reason);
+    closing = true;
+    socket->disconnectFromHost();
+}
+
+/*!
+ * Returns the `Sec-WebSocket-Accept` value for the client's `Sec-WebSocket-Key` \a key, as per RFC 6455.
+ */
+QByteArray WebSocketConnection::acceptKey(const QByteArray &key)
+{
+    return QCryptographicHash::hash(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", QCryptographicHash::Sha1)
+        .toBase64();
+}
+
+/*!
+ * Returns the HTTP response to the opening handshake \a request, setting \a accepted to \c true if it is a valid
+ * WebSocket (version 13) upgrade request, and the response is `101 Switching Protocols`, otherwise \c false.
+ */
+QByteArray WebSocketConnection::handshakeResponse(const QByteArray &request, bool &accepted)
+{
+    accepted = false;
+    const QList<QByteArray> lines = request.split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    QHash<QByteArray, QByteArray> headers;
+    for (qsizetype index = 1; index < lines.size(); ++index) {
+        const qsizetype colon = lines.at(index).indexOf(':');
+        if (colon > 0) {
+            headers.insert(lines.at(index).left(colon).trimmed().toLower(), lines.at(index).mid(colon + 1).trimmed());
+        }
+    }
+    if ((requestLine.size() != 3) || (requestLine.at(0) != "GET")) {
+        return "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+    }
+    if ((!headers.value("upgrade").toLower().contains("websocket")) ||
+        (!headers.value("connection").toLower().contains("upgrade"))) {
+        return "HTTP/1.1 426 Upgrade Required\r\nUpgrade: websocket\r\nConnection: close\r\n\r\n";
+    }
+    if (headers.value("sec-websocket-version") != "13") {
+        return "HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\nConnection: close\r\n\r\n";
+    }
+    const QByteArray key = headers.value("sec-websocket-key");
+    if (key.isEmpty()) {
+        return "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+    }
+    accepted = true;
+    return "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " + acceptKey(key) + "\r\n\r\n";
+}
+
+/*!
+ * Returns a single, final, unmasked (as all server frames are) frame of \a opcode, with \a payload.
+ */
+QByteArray WebSocketConnection::encodeFrame(const Opcode opcode, const QByteArray &payload)
+{
+    QByteArray frame;
+    frame.reserve(payload.size() + 10);
+    frame.append((char)(0x80 | (quint8)opcode));
+    if (payload.size() < 126) {
+        frame.append((char)payload.size());
+    } else if (payload.size() <= 0xFFFF) {
+        char length[2];
+        qToBigEndian<quint16>((quint16)payload.size(), length);
+        frame.append((char)126).append(length, sizeof(length));
+    } else {
+        char length[8];
+        qToBigEndian<quint64>((quint64)payload.size(), length);
+        frame.append((char)127).append(length, sizeof(length));
+    }
+    return frame + payload;
+}
+
+/*!
+ * Parses the first client frame in \a data, setting \a header to the frame's first byte (its FIN bit, and opcode),
+ * and \a payload to its unmasked payload.
+ *
+ * Returns the size of the frame, 0 if \a data does not yet hold a complete frame, or -1 if the frame is malformed:
+ * unmasked (as client frames must be), with reserved bits set, a fragmented or oversized control frame, or a payload
+ * larger than #maxMessageSize.
+ */
+qsizetype WebSocketConnection::parseFrame(const QByteArray &data, quint8 &header, QByteArray &payload)
+{
+    if (data.size() < 2) {
+        return 0;
+    }
+    const uchar * const bytes = reinterpret_cast<const uchar *>(data.constData());
+    header = bytes[0];
+    if (((header & 0x70) != 0) || ((bytes[1] & 0x80) == 0)) {
+        return -1; // Reserved bits set (no extensions are negotiated), or unmasked.
+    }
+    quint64 length = bytes[1] & 0x7F;
+    qsizetype offset = 2;
+    if (length == 126) {
+        if (data.size() < 4) {
+            return 0;
+        }
+        length = qFromBigEndian<quint16>(bytes + 2);
+        offset = 4;
+    } else if (length == 127) {
+        if (data.size() < 10) {
+            return 0;
+        }
+        length = qFromBigEndian<quint64>(bytes + 2);
+        offset = 10;
+    }
+    if ((length > (quint64)maxMessageSize) || (((header & 0x08) != 0) && ((length > 125) || (!(header & 0x80))))) {
+        return -1; // Too large, or a control frame that is too large for one, or fragmented.
+    }
+    const qsizetype size = offset + 4 + (qsizetype)length;
+    if (data.size() < size) {
+        return 0;
+    }
+    const uchar * const mask = bytes + offset;
+    payload.resize((qsizetype)length);
+    for (qsizetype index = 0; index < (qsizetype)length; ++index) {
+        payload[index] = (char)(bytes[offset + 4 + index] ^ mask[index % 4]);
+    }
+    return size;
+}
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_WEBSOCKETCONNECTION_H
+#define DOKIT_WEBSOCKETCONNECTION_H
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QLoggingCategory>
+
+class QTcpSocket;
+
+class WebSocketConnection : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 defaultMaxQueued { 1024 * 1024 }; ///< Default maximum bytes waiting to be sent.
+    static constexpr qint64 maxMessageSize { 64 * 1024 };     ///< Maximum size of a single (reassembled) message.
+    static constexpr qint64 maxHandshakeSize { 16 * 1024 };   ///< Maximum size of the opening HTTP handshake.
+
+    explicit WebSocketConnection(QTcpSocket * const socket, QObject * const parent = nullptr);
+
+    bool isHandshakeComplete() const;
+    QString peerName() const;
+
+    qint64 maxQueued() const;
+    void setMaxQueued(const qint64 bytes);
+    quint64 droppedMessages() const;
+
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+    bool canReadLine() const override;
+    void close() override;
+
+signals:
+    void disconnected();
+
+protected:
+    qint64 readData(char * data, qint64 maxSize) override;
+    qint64 writeData(const char * data, qint64 size) override;
+
+private:
+    /// WebSocket frame opcodes, as per RFC 6455.
+    enum class Opcode : quint8 {
+        Continuation = 0x0, Text = 0x1, Binary = 0x2, Close = 0x8, Ping = 0x9, Pong = 0xA,
+    };
+
+    QTcpSocket * socket;          ///< Underlying TCP connection.
+    QByteArray received;          ///< Bytes received, but not yet parsed as the handshake, or complete frames.
+    QByteArray message;           ///< Fragments of the text message being received, if any.
+    bool messageOpen { false };   ///< Whether a fragmented text message is being received.
+    QByteArray incoming;          ///< Complete text messages, each terminated by a newline, not yet read.
+    bool handshaken { false };    ///< Whether the opening handshake has completed.
+    bool closing { false };       ///< Whether a close frame has been sent.
+    qint64 queueLimit { defaultMaxQueued }; ///< Maximum bytes waiting to be sent, before messages are dropped.
+    quint64 dropped { 0 };        ///< Number of messages dropped, since the client was not keeping up.
+    quint64 unreported { 0 };     ///< Number of those messages not yet reported to the client.
+
+    static Q_LOGGING_CATEGORY(lc, "dokit.cli.websocket", QtInfoMsg); ///< Logging category for WebSocket clients.
+
+    void readSocket();
+    void readFrames();
+    void sendFrame(const Opcode opcode, const QByteArray &payload);
+    void fail(const quint16 code, const QByteArray &reason);
+
+    static QByteArray acceptKey(const QByteArray &key);
+    static QByteArray handshakeResponse(const QByteArray &request, bool &accepted);
+    static QByteArray encodeFrame(const Opcode opcode, const QByteArray &payload);
+    static qsizetype parseFrame(const QByteArray &data, quint8 &header, QByteArray &payload);
+
+    QTPOKIT_BEFRIEND_TEST(WebSocketConnection)
+};
+
+#endif // DOKIT_WEBSOCKETCONNECTION_H
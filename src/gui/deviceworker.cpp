@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "deviceworker.h"
+
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitmeter.h>
+#include <qtpokit/pokittrace.h>
+#include <qtpokit/statusservice.h>
+
+#include <QLowEnergyController>
+
+/*!
+ * \class DeviceWorker
+ *
+ * The DeviceWorker class connects to one Pokit device, and reports its multimeter readings, and battery status, via
+ * plain-typed signals. Each worker is intended to be moved to its own thread (before start() is invoked there), so
+ * that a device's Bluetooth traffic, and parsing, never competes with the GUI thread, nor with other devices.
+ *
+ * The worker has no parent (so it can be moved), and creates its PokitDevice (and thus all of the device's Bluetooth
+ * objects) only once started, so they all belong to the worker's thread.
+ */
+
+/*!
+ * Constructs a new worker for the Pokit device described by \a info, of Pokit \a product.
+ */
+DeviceWorker::DeviceWorker(const QBluetoothDeviceInfo &info, const PokitProduct product)
+    : QObject(nullptr), info(info), product(product)
+{
+
+}
+
+/*!
+ * Connects to the device, and begins reporting its readings, and battery status, once connected.
+ */
+void DeviceWorker::start()
+{
+    Q_ASSERT(device == nullptr);
+    QTPOKIT_TRACE_THREAD_NAME(qUtf8Printable(info.name())); // The worker's thread is this device's alone.
+    device = new PokitDevice(info, this);
+    device->setReconnectPolicy({ 5 }); // Dashboards are often left running, so ride out brief dropouts.
+
+    // Prepare both services before connecting, so both are discovered at once on connection (and each then starts
+    // itself, including after any reconnection).
+    device->prepareServices(PokitDevice::Service::Multimeter|PokitDevice::Service::Status);
+    MultimeterService * const multimeter = device->multimeter();
+    multimeter->setPokitProduct(product);
+    connect(multimeter, &MultimeterService::serviceDetailsDiscovered, multimeter, [multimeter]() {
+        multimeter->setSettings({
+            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::AutoRange, updateInterval });
+    });
+    connect(multimeter, &MultimeterService::settingsWritten, multimeter, [multimeter]() {
+        multimeter->enableReadingNotifications();
+    });
+    connect(multimeter, &MultimeterService::readingRead, this, [this](const MultimeterService::Reading &reading) {
+        emit readingRead(reading.value, MultimeterService::toString(reading.mode));
+    });
+
+    StatusService * const status = device->status();
+    connect(status, &StatusService::serviceDetailsDiscovered, status, [status]() {
+        status->readStatusCharacteristic();
+        status->enableStatusNotifications(); // Not supported by older firmware, so also read once, above.
+    });
+    connect(status, &StatusService::deviceStatusRead, this, [this](const StatusService::Status &status) {
+        emit batteryRead(status.batteryVoltage, StatusService::toString(status.batteryStatus));
+    });
+
+    connect(device->controller(), &QLowEnergyController::connected, this, &DeviceWorker::connected);
+    connect(device->controller(), &QLowEnergyController::disconnected, this, &DeviceWorker::disconnected);
+    qCDebug(lc).noquote() << tr("Connecting to %1.").arg(info.name());
+    device->controller()->connectToDevice();
+}
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_DEVICEWORKER_H
+#define DOKIT_GUI_DEVICEWORKER_H
+
+#include <qtpokit/pokitproducts.h>
+
+#include <QBluetoothDeviceInfo>
+#include <QLoggingCategory>
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+class PokitDevice;
+QTPOKIT_END_NAMESPACE
+
+QTPOKIT_USE_NAMESPACE
+
+class DeviceWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint32 updateInterval { 250 }; ///< Multimeter update interval, in milliseconds.
+
+    explicit DeviceWorker(const QBluetoothDeviceInfo &info, const PokitProduct product);
+
+public slots:
+    void start();
+
+signals:
+    void connected();
+    void disconnected();
+    void readingRead(const float value, const QString &mode);
+    void batteryRead(const float voltage, const QString &status);
+
+protected:
+    static Q_LOGGING_CATEGORY(lc, "dokit.gui.deviceWorker", QtInfoMsg);
+
+private:
+    QBluetoothDeviceInfo info;       ///< Device to connect to.
+    PokitProduct product;            ///< Device's Pokit product.
+    PokitDevice * device { nullptr }; ///< Device, once started.
+};
+
+#endif // DOKIT_GUI_DEVICEWORKER_H
@@ -4,6 +4,8 @@
 #include "mainwindow.h"
 #include "../stringliterals_p.h"
 
+#include <qtpokit/pokittrace.h>
+
 #include <QApplication>
 #include <QDebug>
 
@@ -13,6 +15,7 @@ int main(int argc, char *argv[])
 {
     // Setup the application.
     QApplication app(argc, argv);
+    QTPOKIT_TRACE_THREAD_NAME("gui");
     QApplication::setApplicationName(QStringLiteral(PROJECT_NAME));
     QApplication::setApplicationVersion(QString::fromLatin1(PROJECT_VERSION
         #ifdef PROJECT_PRE_RELEASE
@@ -22,8 +25,8 @@ int main(int argc, char *argv[])
         "+" PROJECT_BUILD_ID
         #endif
     ));
-    QApplication::setOrganizationName(u"pcolby"_s);        // Only used for QSettings. We should Manage these via
-    QApplication::setOrganizationDomain(u"colby.id.au"_s); // CMake if we ever add settings to the console app too.
+    QApplication::setOrganizationName(QStringLiteral(PROJECT_ORGANIZATION_NAME));     // Only used for QSettings.
+    QApplication::setOrganizationDomain(QStringLiteral(PROJECT_ORGANIZATION_DOMAIN)); // Only used for QSettings.
 
     /// \todo Install localised translators, if we have translations for the current locale.
 
@@ -4,25 +4,23 @@
 #include "mainwindow.h"
 #include "../stringliterals_p.h"
 
+#include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/pokitmeter.h>
+#include <qtpokit/pokitpro.h>
 
 #include <QApplication>
-#include <QChartView>
-#include <QDockWidget>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QInputDialog>
 #include <QListView>
+#include <QLocale>
+#include <QLowEnergyController>
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QSettings>
 #include <QStatusBar>
-
-/// \todo Remove these. Only needed for example code below.
-#include <QCategoryAxis>
-#include <QChart>
-#include <QSplineSeries>
-
-/// As of Qt6, Qt Charts no longer has a custom QtCharts namespace.
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-using namespace QtCharts;
-#endif
+#include <QTableView>
 
 DOKIT_USE_STRINGLITERALS
 
@@ -30,65 +28,91 @@ MainWindow::MainWindow(QWidget * const parent, const Qt::WindowFlags flags) : QM
 {
     setWindowIcon(QIcon(u":/dokit-icon-512.png"_s));
     setWindowTitle(tr("%1 %2").arg(QApplication::applicationName(), QApplication::applicationVersion()));
+    chartView = new LiveChartView(this);
+    chartView->setRenderHint(QPainter::Antialiasing);
+    plotPipeline = new PlotPipeline(this); // Decimate, and analyse, off the GUI thread.
+    chartView->setPipeline(plotPipeline);
+    connect(plotPipeline, &PlotPipeline::frameReady, this, &MainWindow::showFrameStatistics);
+    archiveModel = new LoggerArchiveModel(this);
+    recorder = new Recorder(this); // Writes to disk off the GUI thread.
+    connect(recorder, &Recorder::statisticsChanged, this, &MainWindow::showRecordingStatistics);
+    persistenceView = new PersistenceView(this);
+    persistenceDockWidget = new QDockWidget(tr("Persistence"));
+    persistenceDockWidget->setObjectName(u"persistenceDockWidget"_s); ///< For save/restore state.
+    persistenceDockWidget->setWidget(persistenceView);
+    addDockWidget(Qt::BottomDockWidgetArea, persistenceDockWidget);
+    persistenceDockWidget->hide(); // Until shown via the Device menu.
+
     setupMenuBar();
 
-    discoveryAgent = new PokitDiscoveryAgent(this);
+    deviceRegistry = new PokitDeviceRegistry(this);
+    PokitDiscoveryAgent * const discoveryAgent = deviceRegistry->discoveryAgent();
+    discoveryAgent->setUpdateInterval(500); // Keep dense environments from flooding the event loop.
+    discoveryAgent->setRssiSmoothing(0.25f);
+    discoveryAgent->setRssiThreshold(2);
     devicesModel = new PokitDevicesModel(this);
-    devicesModel->setDiscoveryAgent(discoveryAgent);
-
-    /// \todo Remove this block; its just from Qt's multiaxis chart example, and only for visual inspiration currently.
-    QChart *chart = new QChart();
-    chart->legend()->hide();
-    QValueAxis *axisX = new QValueAxis;
-    axisX->setTickCount(10);
-    chart->addAxis(axisX, Qt::AlignBottom);
-    QSplineSeries *series = new QSplineSeries;
-    *series << QPointF(1, 5) << QPointF(3.5, 18) << QPointF(4.8, 7.5) << QPointF(10, 2.5);
-    chart->addSeries(series);
-    QValueAxis *axisY = new QValueAxis;
-    axisY->setLinePenColor(series->pen().color());
-    chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisX);
-    series->attachAxis(axisY);
-    series = new QSplineSeries;
-    *series << QPointF(1, 0.5) << QPointF(1.5, 4.5) << QPointF(2.4, 2.5) << QPointF(4.3, 12.5)
-            << QPointF(5.2, 3.5) << QPointF(7.4, 16.5) << QPointF(8.3, 7.5) << QPointF(10, 17);
-    chart->addSeries(series);
-    QCategoryAxis *axisY3 = new QCategoryAxis;
-    axisY3->append(u"Low"_s, 5);
-    axisY3->append(u"Medium"_s, 12);
-    axisY3->append(u"High"_s, 17);
-    axisY3->setLinePenColor(series->pen().color());
-    axisY3->setGridLinePen((series->pen()));
-    chart->addAxis(axisY3, Qt::AlignRight);
-    series->attachAxis(axisX);
-    series->attachAxis(axisY3);
-    QChartView *chartView = new QChartView(chart);
-    chartView->setRenderHint(QPainter::Antialiasing);
-    // End of sample code to delete.
+    devicesModel->setDeviceRegistry(deviceRegistry);
 
     setCentralWidget(chartView);
+    recordingLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(recordingLabel);
+    recordingLabel->hide(); // Until recording.
     setDockOptions(QMainWindow::AnimatedDocks);
 
     auto pokitDevicesListView = new QListView(this);
     pokitDevicesListView->setModel(devicesModel);
+    pokitDevicesListView->setToolTip(
+        tr("Double-click a device to connect to it, or check it to add it to the dashboard"));
+    connect(pokitDevicesListView, &QListView::activated, this, &MainWindow::connectDevice);
     auto const scanDockWidget = new QDockWidget(tr("Pokit Devices"));
     scanDockWidget->setObjectName(u"pokitDevicesDockWidget"_s); ///< For save/restore state.
     scanDockWidget->setWidget(pokitDevicesListView);
     addDockWidget(Qt::RightDockWidgetArea, scanDockWidget);
 
+    auto archiveTableView = new QTableView(this);
+    archiveTableView->setModel(archiveModel);
+    archiveTableView->setAlternatingRowColors(true);
+    archiveTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed); // Never measure every row.
+    archiveTableView->horizontalHeader()->setStretchLastSection(true);
+    dashboardView = new DashboardView(this);
+    dashboardView->setDeviceRegistry(deviceRegistry);
+    connect(devicesModel, &PokitDevicesModel::checkedChanged, this, [this](const QString &key, const bool checked) {
+        if (checked) {
+            dashboardView->addDevice(key);
+        } else {
+            dashboardView->removeDevice(key);
+        }
+    });
+    dashboardDockWidget = new QDockWidget(tr("Dashboard"));
+    dashboardDockWidget->setObjectName(u"dashboardDockWidget"_s); ///< For save/restore state.
+    dashboardDockWidget->setWidget(dashboardView);
+    addDockWidget(Qt::TopDockWidgetArea, dashboardDockWidget);
+    dashboardDockWidget->hide(); // Until a device is checked.
+    connect(dashboardView, &DashboardView::countChanged, this, [this](const qsizetype count) {
+        if (count == 1) {
+            dashboardDockWidget->show(); // The first device has just been added.
+        }
+    });
+
+    archiveDockWidget = new QDockWidget(tr("Logger Archive"));
+    archiveDockWidget->setObjectName(u"loggerArchiveDockWidget"_s); ///< For save/restore state.
+    archiveDockWidget->setWidget(archiveTableView);
+    addDockWidget(Qt::BottomDockWidgetArea, archiveDockWidget);
+    archiveDockWidget->hide(); // Until an archive is opened.
+
     // Restore the window's geometry and state.
     QSettings settings;
     settings.beginGroup(u"mainwindow"_s);
     restoreGeometry(settings.value(u"geometry"_s).toByteArray());
     restoreState(settings.value(u"state"_s).toByteArray());
 
-    /// \todo Restore the model's default check states.
+    // Devices checked last session are checked (and so added to the dashboard) again, as (if) they are discovered.
+    devicesModel->setDefaultCheckedKeys(settings.value(u"checkedDevices"_s).toStringList());
 
     // Begin the Pokit device discovery.
     connect(discoveryAgent, &PokitDiscoveryAgent::finished, this, &MainWindow::discoveryFinished);
     statusBar()->showMessage(tr("Scanning for Pokit devices"));
-    discoveryAgent->start();
+    deviceRegistry->start();
 }
 
 void MainWindow::about()
@@ -107,7 +131,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
     settings.setValue(u"geometry"_s, saveGeometry());
     settings.setValue(u"state"_s, saveState());
 
-    /// \todo Save the checked states of devices.
+    settings.setValue(u"checkedDevices"_s, devicesModel->checkedKeys());
 
     // Let the base class accept or ignore the event.
     QMainWindow::closeEvent(event);
@@ -116,9 +140,31 @@ void MainWindow::closeEvent(QCloseEvent *event)
 void MainWindow::setupMenuBar()
 {
     QMenu *fileMenu = menuBar()->addMenu(tr("&File"));
+    QAction *openArchiveAct = fileMenu->addAction(tr("&Open Logger Archive..."), this, &MainWindow::openArchive);
+    openArchiveAct->setStatusTip(tr("Browse the samples of a dokit logger-fetch --archive file"));
+    recordAction = fileMenu->addAction(tr("&Record..."), this, &MainWindow::setRecording);
+    recordAction->setCheckable(true);
+    recordAction->setStatusTip(tr("Record the live DSO captures, and multimeter readings, to a dokit binary file"));
     fileMenu->addSeparator();
     fileMenu->addAction(tr("E&xit"), qApp, &QApplication::quit);
 
+    QMenu *deviceMenu = menuBar()->addMenu(tr("&Device"));
+    meterAction = deviceMenu->addAction(tr("&Multimeter"), this, &MainWindow::startMeter);
+    meterAction->setStatusTip(tr("Chart the connected device's multimeter readings"));
+    dsoAction = deviceMenu->addAction(tr("&Oscilloscope"), this, &MainWindow::startDso);
+    dsoAction->setStatusTip(tr("Chart the connected device's DSO captures, continuously"));
+    xyAction = deviceMenu->addAction(tr("&XY Mode..."), this, &MainWindow::startXy);
+    xyAction->setStatusTip(tr("Chart the connected device's DSO captures against a second device's"));
+    QAction * const persistenceAction = persistenceDockWidget->toggleViewAction();
+    persistenceAction->setText(tr("&Persistence"));
+    persistenceAction->setStatusTip(tr("Show every DSO capture, intensity-graded by how often each path is taken"));
+    deviceMenu->addAction(persistenceAction);
+    deviceMenu->addSeparator();
+    disconnectAction = deviceMenu->addAction(tr("&Disconnect"), this, &MainWindow::disconnectDevice);
+    for (QAction * const action: { meterAction, dsoAction, xyAction, disconnectAction }) {
+        action->setEnabled(false); // Until connected to a device.
+    }
+
     QMenu *aboutMenu = menuBar()->addMenu(tr("&About"));
     QAction *aboutAct = aboutMenu->addAction(tr("About &%1").arg(QApplication::applicationName()), this, &MainWindow::about);
     aboutAct->setStatusTip(tr("Show the application's About box"));
@@ -130,3 +176,238 @@ void MainWindow::discoveryFinished()
 {
     statusBar()->showMessage(tr("Finishing scanning for Pokit Devices"));
 }
+
+void MainWindow::connectDevice(const QModelIndex &index)
+{
+    const std::optional<PokitDeviceRegistry::Entry> entry =
+        deviceRegistry->device(index.data(PokitDevicesModel::DeviceKeyRole).toString());
+    if (!entry) {
+        return;
+    }
+    disconnectDevice();
+    qCDebug(lc).noquote() << tr("Connecting to %1.").arg(entry->name);
+    deviceKey = PokitDeviceRegistry::key(entry->info);
+    product = entry->product;
+    device = new PokitDevice(entry->info, this);
+    device->setConnectionProfile(PokitDevice::ConnectionProfile::LowLatency); // For DSO transfers.
+
+    // Prepare both services before connecting, so both are discovered at once on connection.
+    device->prepareServices(PokitDevice::Service::Multimeter|PokitDevice::Service::Dso);
+    connect(device, &PokitDevice::servicesPrepared, this, [this](const PokitDevice::Services prepared) {
+        meterAction->setEnabled(prepared.testFlag(PokitDevice::Service::Multimeter));
+        for (QAction * const action: { dsoAction, xyAction }) {
+            action->setEnabled(prepared.testFlag(PokitDevice::Service::Dso));
+        }
+        if (prepared.testFlag(PokitDevice::Service::Multimeter)) {
+            startMeter();
+        }
+    });
+    MultimeterService * const multimeter = device->multimeter();
+    multimeter->setPokitProduct(product);
+    connect(multimeter, &MultimeterService::settingsWritten, this, [multimeter]() {
+        multimeter->enableReadingNotifications();
+    });
+    connect(multimeter, &MultimeterService::readingRead, recorder, &Recorder::recordReading);
+    DsoService * const dso = device->dso();
+    dso->setPokitProduct(product);
+    dsoCapture = new DsoCapture(dso, device);
+    connect(dsoCapture, &DsoCapture::captureComplete, recorder,
+            [this](const DsoService::Metadata &metadata, const DsoService::Samples &samples) {
+        recorder->recordCapture(metadata, samples);
+    });
+
+    connect(device->controller(), &QLowEnergyController::connected, this, [this, name = entry->name]() {
+        statusBar()->showMessage(tr("Connected to %1").arg(name));
+        disconnectAction->setEnabled(true); // The others, once their services are prepared.
+    });
+    connect(device->controller(), &QLowEnergyController::disconnected, this, [this, name = entry->name]() {
+        statusBar()->showMessage(tr("Disconnected from %1").arg(name));
+    });
+    statusBar()->showMessage(tr("Connecting to %1").arg(entry->name));
+    device->controller()->connectToDevice();
+}
+
+void MainWindow::disconnectDevice()
+{
+    for (QAction * const action: { meterAction, dsoAction, xyAction, disconnectAction }) {
+        action->setEnabled(false);
+    }
+    disconnectXyDevice();
+    if (device) {
+        device->controller()->disconnectFromDevice();
+        device->deleteLater(); // Also deletes the device's services, and DSO capture.
+        device = nullptr;
+        dsoCapture = nullptr;
+    }
+    deviceKey.clear();
+    chartView->clear();
+    persistenceView->clear();
+}
+
+void MainWindow::disconnectXyDevice()
+{
+    if (xyDevice) {
+        xyDevice->controller()->disconnectFromDevice();
+        xyDevice->deleteLater(); // Also deletes the device's services, and DSO capture.
+        xyDevice = nullptr;
+        xyCapture = nullptr;
+    }
+}
+
+void MainWindow::startMeter()
+{
+    if (!device) {
+        return;
+    }
+    disconnectXyDevice();
+    dsoCapture->stopContinuous();
+    chartView->setMultimeterService(device->multimeter());
+    recorder->setMeterInterval(100);
+    device->multimeter()->setSettings({
+        MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::AutoRange, 100 });
+}
+
+void MainWindow::startDso()
+{
+    if (!device) {
+        return;
+    }
+    disconnectXyDevice();
+    device->multimeter()->disableReadingNotifications();
+    chartView->setDsoCapture(dsoCapture);
+    persistenceView->setDsoCapture(dsoCapture);
+    dsoCapture->startContinuous(dsoSettings(device, product));
+}
+
+void MainWindow::startXy()
+{
+    if (!device) {
+        return;
+    }
+    QStringList names;
+    QVector<PokitDeviceRegistry::Entry> entries;
+    for (const PokitDeviceRegistry::Entry &entry: deviceRegistry->devices()) {
+        if (PokitDeviceRegistry::key(entry.info) != deviceKey) {
+            names.append(entry.name);
+            entries.append(entry);
+        }
+    }
+    if (entries.isEmpty()) {
+        QMessageBox::information(this, tr("XY Mode"), tr("XY mode requires a second Pokit device, but none "
+            "have been discovered yet"));
+        return;
+    }
+    bool ok = false;
+    const QString name = QInputDialog::getItem(this, tr("XY Mode"), tr("Device to chart on the Y axis:"), names, 0,
+                                               false, &ok);
+    if (!ok) {
+        return;
+    }
+    const PokitDeviceRegistry::Entry &entry = entries.at(names.indexOf(name));
+
+    disconnectXyDevice();
+    qCDebug(lc).noquote() << tr("Connecting to %1, for XY mode.").arg(entry.name);
+    xyDevice = new PokitDevice(entry.info, this);
+    xyDevice->setConnectionProfile(PokitDevice::ConnectionProfile::LowLatency);
+    DsoService * const dso = xyDevice->dso();
+    dso->setPokitProduct(entry.product);
+    xyCapture = new DsoCapture(dso, xyDevice);
+    connect(dso, &DsoService::serviceDetailsDiscovered, this, [this, product = entry.product]() {
+        if (xyDevice) {
+            xyCapture->startContinuous(dsoSettings(xyDevice, product));
+        }
+    });
+    connect(xyDevice->controller(), &QLowEnergyController::disconnected, this, [this, name = entry.name]() {
+        statusBar()->showMessage(tr("Disconnected from %1").arg(name));
+    });
+
+    // Both devices capture continuously, and the chart pairs each device's latest captures, on its pipeline.
+    device->multimeter()->disableReadingNotifications();
+    chartView->setXyDsoCaptures(dsoCapture, xyCapture);
+    persistenceView->setDsoCapture(dsoCapture);
+    dsoCapture->startContinuous(dsoSettings(device, product));
+    statusBar()->showMessage(tr("Connecting to %1, for XY mode").arg(entry.name));
+    xyDevice->controller()->connectToDevice();
+}
+
+DsoService::Settings MainWindow::dsoSettings(const PokitDevice * const device, const PokitProduct product)
+{
+    // Charted continuously, so prefer the widest range (DSO modes do not auto-range), and a 100ms window.
+    const quint16 bufferSize = device->capabilities().samplingBufferSize;
+    return {
+        DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage,
+        (product == PokitProduct::PokitPro) ? +PokitPro::VoltageRange::_60V : +PokitMeter::VoltageRange::_60V,
+        100'000, (bufferSize > 0) ? bufferSize : (quint16)8192 };
+}
+
+void MainWindow::openArchive()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, tr("Open Logger Archive"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+    auto const newArchive = new LoggerArchive(fileName, this);
+    if (!newArchive->open()) {
+        QMessageBox::warning(this, tr("Open Logger Archive"), tr("Failed to open %1").arg(fileName));
+        delete newArchive;
+        return;
+    }
+    archiveModel->setArchive(newArchive);
+    delete archive;
+    archive = newArchive;
+    archiveDockWidget->setWindowTitle(tr("Logger Archive: %1").arg(QFileInfo(fileName).fileName()));
+    archiveDockWidget->show();
+    statusBar()->showMessage(tr("Opened %Ln sample/s from %1", nullptr, archiveModel->rowCount()).arg(fileName));
+}
+
+void MainWindow::setRecording(const bool record)
+{
+    if (!record) {
+        const QString fileName = recorder->fileName();
+        recorder->stop();
+        recordingLabel->hide();
+        statusBar()->showMessage(tr("Recorded %1 to %2").arg(QLocale().formattedDataSize(
+            (qint64)recorder->statistics().writer.bytesWritten), fileName));
+        return;
+    }
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Record"), QString(),
+        tr("Dokit binary files (*.bin);;All files (*)"));
+    if ((fileName.isEmpty()) || (!recorder->start(fileName))) {
+        if (!fileName.isEmpty()) {
+            QMessageBox::warning(this, tr("Record"), tr("Failed to record to %1: %2")
+                .arg(fileName, recorder->errorString()));
+        }
+        recordAction->setChecked(false);
+        return;
+    }
+    recordingLabel->setText(tr("Recording %1").arg(QFileInfo(fileName).fileName()));
+    recordingLabel->show();
+}
+
+void MainWindow::showRecordingStatistics(const Recorder::Statistics &statistics)
+{
+    const QLocale locale;
+    QString text = tr("Recording %1: %2").arg(QFileInfo(recorder->fileName()).fileName(),
+        locale.formattedDataSize((qint64)statistics.writer.bytesWritten));
+    if (const quint64 done = statistics.writer.bytesWritten + statistics.writer.bytesDropped;
+        statistics.bytesQueued > done) {
+        text = tr("%1 (%2 pending)").arg(text, locale.formattedDataSize((qint64)(statistics.bytesQueued - done)));
+    }
+    if (statistics.writer.dropped > 0) {
+        text = tr("%1, %Ln batch/es dropped", nullptr, (int)statistics.writer.dropped).arg(text);
+    }
+    recordingLabel->setText(text);
+}
+
+void MainWindow::showFrameStatistics(const PlotPipeline::Frame &frame)
+{
+    if (!frame.statistics) {
+        return; // Not a DSO capture, or not analysed.
+    }
+    const DsoStatistics::Summary &summary = *frame.statistics;
+    QString message = tr("Mean %1, RMS %2, peak-to-peak %3").arg(summary.mean).arg(summary.rms).arg(summary.peakToPeak);
+    if (!qIsNaN(summary.frequency)) {
+        message = tr("%1, frequency %2 Hz").arg(message).arg(summary.frequency);
+    }
+    statusBar()->showMessage(message);
+}
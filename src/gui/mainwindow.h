@@ -1,10 +1,22 @@
 // SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include "models/loggerarchivemodel.h"
 #include "models/pokitdevicesmodel.h"
+#include "plotpipeline.h"
+#include "recorder.h"
+#include "widgets/dashboardview.h"
+#include "widgets/livechartview.h"
+#include "widgets/persistenceview.h"
 
-#include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/dsocapture.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitdeviceregistry.h>
+#include <qtpokit/pokitproducts.h>
 
+#include <QAction>
+#include <QDockWidget>
+#include <QLabel>
 #include <QLoggingCategory>
 #include <QMainWindow>
 
@@ -26,11 +38,45 @@ protected:
     virtual void closeEvent(QCloseEvent *event) override;
 
 private:
-    PokitDiscoveryAgent * discoveryAgent;
+    PokitDeviceRegistry * deviceRegistry;
     PokitDevicesModel * devicesModel;
+    LiveChartView * chartView;
+    PlotPipeline * plotPipeline;
+    PersistenceView * persistenceView;
+    QDockWidget * persistenceDockWidget;
+    DashboardView * dashboardView;
+    QDockWidget * dashboardDockWidget;
+    LoggerArchive * archive { nullptr };
+    LoggerArchiveModel * archiveModel;
+    QDockWidget * archiveDockWidget;
+    Recorder * recorder;
+    QAction * recordAction;
+    QLabel * recordingLabel;
+
+    PokitDevice * device { nullptr };
+    QString deviceKey;
+    PokitProduct product { PokitProduct::PokitMeter };
+    DsoCapture * dsoCapture { nullptr };
+    PokitDevice * xyDevice { nullptr };
+    DsoCapture * xyCapture { nullptr };
+    QAction * meterAction;
+    QAction * dsoAction;
+    QAction * xyAction;
+    QAction * disconnectAction;
 
     void setupMenuBar();
+    static DsoService::Settings dsoSettings(const PokitDevice * const device, const PokitProduct product);
 
 private slots:
     void discoveryFinished();
+    void connectDevice(const QModelIndex &index);
+    void disconnectDevice();
+    void disconnectXyDevice();
+    void startMeter();
+    void startDso();
+    void startXy();
+    void openArchive();
+    void setRecording(const bool record);
+    void showRecordingStatistics(const Recorder::Statistics &statistics);
+    void showFrameStatistics(const PlotPipeline::Frame &frame);
 };
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "loggerarchivemodel.h"
+#include "../../stringliterals_p.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class LoggerArchiveModel
+ *
+ * The LoggerArchiveModel class presents the samples of a (memory-mapped) LoggerArchive as a table, one row per
+ * sample, for browsing even hours (or days) of logged samples.
+ *
+ * Nothing is stored per row. Instead, rows are mapped to sessions via the archive's in-memory session index, and each
+ * sample's timestamp calculated from its session's start and logging interval. Samples themselves are only read from
+ * the archive when a view asks for them (that is, for visible rows), a page of #pageSize rows at a time, with the most
+ * recent #maximumPages pages cached. Each cell's text is then formatted on request, and never stored. So memory stays
+ * proportional to the viewport, rather than the archive, and scrolling to any row costs just one page read.
+ */
+
+/*!
+ * Constructs a new, empty, logger archive model with \a parent.
+ */
+LoggerArchiveModel::LoggerArchiveModel(QObject * const parent) : QAbstractTableModel(parent)
+{
+
+}
+
+/*!
+ * Returns the archive being modelled, if any.
+ */
+const LoggerArchive * LoggerArchiveModel::archive() const
+{
+    return loggerArchive;
+}
+
+/*!
+ * Sets the (already opened) \a archive to be modelled, or \c nullptr to model nothing. The archive must outlive this
+ * model, or at least, this model's use of it.
+ */
+void LoggerArchiveModel::setArchive(const LoggerArchive * const archive)
+{
+    beginResetModel();
+    loggerArchive = archive;
+    pages.clear();
+    sessionRows.clear();
+    qint64 rows = 0;
+    const qsizetype sessions = ((archive) && (archive->isOpen())) ? archive->sessionCount() : 0;
+    sessionRows.reserve(sessions + 1);
+    for (qsizetype index = 0; index < sessions; ++index) {
+        sessionRows.append(rows);
+        rows += archive->session(index).metadata.numberOfSamples;
+    }
+    sessionRows.append(rows);
+    qCDebug(lc).noquote() << tr("Modelling %Ln sample/s, in %1 session/s.", nullptr, (int)rows).arg(sessions);
+    endResetModel();
+}
+
+int LoggerArchiveModel::rowCount(const QModelIndex &parent) const
+{
+    return (parent.isValid()) ? 0 : (int)std::min<qint64>(sessionRows.value(sessionRows.size() - 1),
+                                                          std::numeric_limits<int>::max());
+}
+
+int LoggerArchiveModel::columnCount(const QModelIndex &parent) const
+{
+    return (parent.isValid()) ? 0 : ColumnCount;
+}
+
+QVariant LoggerArchiveModel::data(const QModelIndex &index, int role) const
+{
+    if ((!index.isValid()) || (!loggerArchive) || (index.row() >= rowCount()) ||
+        ((role != Qt::DisplayRole) && (role != TimestampRole) && (role != ValueRole) &&
+         (role != Qt::TextAlignmentRole))) {
+        return QVariant();
+    }
+    if (role == Qt::TextAlignmentRole) {
+        return (index.column() == ValueColumn) ? QVariant((int)(Qt::AlignRight|Qt::AlignVCenter)) : QVariant();
+    }
+
+    const qsizetype sessionIndex = session(index.row());
+    const qint64 offset = index.row() - sessionRows.at(sessionIndex);
+    const LoggerArchive::Session run = loggerArchive->session(sessionIndex);
+    const qint64 timestamp = (qint64)run.firstTimestamp + (offset * run.metadata.updateInterval);
+    if (role == TimestampRole) {
+        return timestamp;
+    }
+
+    const auto value = [&]() -> std::optional<double> {
+        const Page * const samples = page(sessionIndex, offset);
+        const qsizetype pageOffset = (run.metadata.updateInterval == 0) ? offset : (offset % pageSize);
+        if ((samples == nullptr) || (pageOffset >= samples->samples.size())) {
+            return std::nullopt;
+        }
+        return (double)samples->samples.at(pageOffset) * run.metadata.scale;
+    };
+    if (role == ValueRole) {
+        const std::optional<double> sample = value();
+        return (sample) ? QVariant(*sample) : QVariant();
+    }
+
+    switch (index.column()) {
+    case TimestampColumn:
+        return QDateTime::fromMSecsSinceEpoch(timestamp).toString(Qt::ISODateWithMs);
+    case ValueColumn: {
+        const std::optional<double> sample = value();
+        return (sample) ? QString::number(*sample) : QString();
+    }
+    case ModeColumn:
+        return DataLoggerService::toString(run.metadata.mode);
+    case SessionColumn:
+        return QString::number(sessionIndex + 1);
+    }
+    return QVariant();
+}
+
+QVariant LoggerArchiveModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Vertical) {
+        return QString::number(section + 1);
+    }
+    switch (section) {
+    case TimestampColumn: return tr("Timestamp");
+    case ValueColumn:     return tr("Value");
+    case ModeColumn:      return tr("Mode");
+    case SessionColumn:   return tr("Session");
+    }
+    return QVariant();
+}
+
+/*!
+ * Returns the index of the session containing \a row.
+ */
+qsizetype LoggerArchiveModel::session(const int row) const
+{
+    // sessionRows is sorted, so binary search it, skipping its final (total rows) entry.
+    const auto iter = std::upper_bound(sessionRows.cbegin(), sessionRows.cend() - 1, (qint64)row);
+    return (iter - sessionRows.cbegin()) - 1;
+}
+
+/*!
+ * Returns the (possibly cached) page of samples containing the sample at \a offset within \a session, or \c nullptr
+ * if the samples could not be read.
+ *
+ * Sessions without a logging interval cannot be read by timestamp range, so are read as a single page (which, given
+ * the Data Logger's buffer size, is never much more than a few pages anyway).
+ */
+const LoggerArchiveModel::Page * LoggerArchiveModel::page(const qsizetype session, const qint64 offset) const
+{
+    const LoggerArchive::Session run = loggerArchive->session(session);
+    const quint64 interval = run.metadata.updateInterval;
+    const qint64 pageIndex = (interval == 0) ? 0 : (offset / pageSize);
+    const quint64 key = ((quint64)session << 32) | (quint64)pageIndex;
+    if (const Page * const cached = pages.object(key)) {
+        return cached;
+    }
+
+    Page * const newPage = new Page;
+    if (interval == 0) {
+        newPage->samples = loggerArchive->samples(session);
+    } else {
+        const quint64 from = run.firstTimestamp + ((quint64)pageIndex * pageSize * interval);
+        newPage->samples = loggerArchive->samples(session, from, from + ((pageSize - 1) * interval));
+    }
+    const Page * const result = newPage;
+    pages.insert(key, newPage); // Takes ownership, evicting the least recently used page if full.
+    return result;
+}
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_LOGGERARCHIVEMODEL_H
+#define DOKIT_GUI_LOGGERARCHIVEMODEL_H
+
+#include <qtpokit/loggerarchive.h>
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QVector>
+
+QTPOKIT_USE_NAMESPACE
+
+class LoggerArchiveModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    /// Model columns.
+    enum Column : int {
+        TimestampColumn, ///< Sample's timestamp, in local time.
+        ValueColumn,     ///< Sample's (scaled) value.
+        ModeColumn,      ///< Sample's session's logging mode.
+        SessionColumn,   ///< Sample's session's (1-based) index within the archive.
+        ColumnCount,     ///< Number of columns.
+    };
+
+    enum : int {
+        TimestampRole = Qt::UserRole, ///< Sample's timestamp, in milliseconds since the epoch.
+        ValueRole,                    ///< Sample's (scaled) value, as a \c double.
+    };
+
+    static constexpr int pageSize { 256 };      ///< Number of rows read from the archive at a time.
+    static constexpr int maximumPages { 64 };   ///< Number of pages cached; a few viewports full.
+
+    explicit LoggerArchiveModel(QObject * const parent = nullptr);
+
+    const LoggerArchive * archive() const;
+    void setArchive(const LoggerArchive * const archive);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+protected:
+    static Q_LOGGING_CATEGORY(lc, "dokit.model.loggerArchive", QtInfoMsg);
+
+private:
+    /// A page of consecutive samples, all from one session.
+    struct Page {
+        DataLoggerService::Samples samples; ///< Raw samples.
+    };
+
+    QPointer<const LoggerArchive> loggerArchive; ///< Archive being modelled, if any.
+    QVector<qint64> sessionRows; ///< First row of each session, followed by the total number of rows.
+    mutable QCache<quint64, Page> pages { maximumPages }; ///< Recently read pages, by (session, page) key.
+
+    qsizetype session(const int row) const;
+    const Page * page(const qsizetype session, const qint64 offset) const;
+};
+
+#endif // DOKIT_GUI_LOGGERARCHIVEMODEL_H
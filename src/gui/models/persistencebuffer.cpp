@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "persistencebuffer.h"
+
+#include <QColor>
+
+#include <algorithm>
+#include <cmath>
+
+/*!
+ * \class PersistenceBuffer
+ *
+ * The PersistenceBuffer class accumulates DSO captures into a fixed-size, two-dimensional, intensity buffer, for
+ * persistence (that is, intensity-graded) display, much like an analogue oscilloscope's phosphor.
+ *
+ * Each capture is accumulate()'d in a single pass over its samples: columns span the capture's samples, and rows span
+ * the raw samples' full scale, with each sample adding to the cells between it and the previous sample (so edges are
+ * drawn, not just dots). Intensities then grow with how often the trace passes through each cell, so the usual trace
+ * is bright, while rare glitches still show, dimly, rather than being overdrawn by the next capture. Intensities
+ * decay() (typically once per displayed frame), so old captures fade away.
+ *
+ * Since the buffer's size is fixed, memory, decay, and toImage() costs are all independent of how many (or how large)
+ * captures are accumulated. Captures are accumulated as raw samples, so the buffer should be clear()'d whenever the
+ * captures' mode, range, or size changes.
+ *
+ * PersistenceBuffer is not thread-safe, so is intended to be written, and read, on the GUI thread only.
+ */
+
+/*!
+ * Constructs a new, empty, buffer of \a width columns, and \a height rows.
+ */
+PersistenceBuffer::PersistenceBuffer(const int width, const int height)
+    : columns(std::max(width, 1)), rows(std::max(height, 2)), intensities(columns * rows, 0.0f)
+{
+
+}
+
+/*!
+ * Returns the number of columns, spanning each capture's samples.
+ */
+int PersistenceBuffer::width() const
+{
+    return columns;
+}
+
+/*!
+ * Returns the number of rows, spanning the raw samples' full scale.
+ */
+int PersistenceBuffer::height() const
+{
+    return rows;
+}
+
+/*!
+ * Returns the number of captures accumulated since the last clear().
+ */
+quint64 PersistenceBuffer::captures() const
+{
+    return accumulated;
+}
+
+/*!
+ * Returns the largest intensity of any cell, or 0 once every capture has faded away.
+ */
+float PersistenceBuffer::peak() const
+{
+    return maximum;
+}
+
+/*!
+ * Accumulates one capture's raw \a samples, adding 1 to each cell the trace passes through.
+ */
+void PersistenceBuffer::accumulate(const QVector<qint16> &samples)
+{
+    const qsizetype size = samples.size();
+    if (size == 0) {
+        return;
+    }
+    float * const cells = intensities.data();
+    int previous = rowOf(samples.at(0));
+    for (qsizetype index = 0; index < size; ++index) {
+        const int column = (int)(((qint64)index * columns) / size);
+        const int row = rowOf(samples.at(index));
+        const auto [top, bottom] = std::minmax(previous, row);
+        for (int cell = top * columns + column; cell <= bottom * columns + column; cell += columns) {
+            maximum = std::max(maximum, cells[cell] += 1.0f);
+        }
+        previous = row;
+    }
+    ++accumulated;
+}
+
+/*!
+ * Multiplies every cell's intensity by \a factor, being between 0 (to clear) and 1 (for infinite persistence). Cells
+ * that decay below #fadedIntensity are cleared.
+ */
+void PersistenceBuffer::decay(const float factor)
+{
+    if (factor >= 1.0f) {
+        return;
+    }
+    const float multiplier = std::max(factor, 0.0f);
+    for (float &intensity: intensities) {
+        // Faded-out cells are zeroed, so they are drawn as no trace, rather than dimly, forever.
+        const float decayed = intensity * multiplier;
+        intensity = (decayed >= fadedIntensity) ? decayed : 0.0f; // A select, so compilers readily vectorise it.
+    }
+    maximum = (maximum * multiplier >= fadedIntensity) ? maximum * multiplier : 0.0f;
+}
+
+/*!
+ * Clears all intensities, such as when the captures' mode, range, or size, changes.
+ */
+void PersistenceBuffer::clear()
+{
+    intensities.fill(0.0f);
+    accumulated = 0;
+    maximum = 0.0f;
+}
+
+/*!
+ * Returns the buffer as a width() by height() image, for blitting, with intensities graded (logarithmically, so rare
+ * traces do not vanish beside common ones) from black, through blue, to red.
+ */
+QImage PersistenceBuffer::toImage() const
+{
+    static const QVector<QRgb> palette = []() { // Computed once, since QColor conversions are relatively slow.
+        QVector<QRgb> colors(256);
+        colors[0] = qRgb(0, 0, 0);
+        for (int level = 1; level < colors.size(); ++level) {
+            const qreal fraction = level / 255.0;
+            colors[level] = QColor::fromHsvF(0.66 * (1.0 - fraction), 1.0, 0.4 + 0.6 * fraction).rgb();
+        }
+        return colors;
+    }();
+
+    QImage image(columns, rows, QImage::Format_RGB32);
+    const float scale = (maximum > 0.0f) ? 255.0f / std::log1p(maximum) : 0.0f;
+    for (int row = 0; row < rows; ++row) {
+        const float * const cells = intensities.constData() + (qsizetype)row * columns;
+        QRgb * const pixels = reinterpret_cast<QRgb *>(image.scanLine(row));
+        for (int column = 0; column < columns; ++column) {
+            const float intensity = cells[column];
+            // Any trace at all is at least level 1, so never indistinguishable from no trace.
+            const int level = (intensity > 0.0f) ? std::clamp((int)(std::log1p(intensity) * scale), 1, 255) : 0;
+            pixels[column] = palette.at(level);
+        }
+    }
+    return image;
+}
+
+/*!
+ * Returns the row of raw \a sample, with the most positive samples at the top (row 0).
+ */
+int PersistenceBuffer::rowOf(const qint16 sample) const
+{
+    const int clamped = std::clamp<int>(sample, -2048, 2047); // Raw samples' full scale.
+    return std::clamp((int)(((qint64)(2047 - clamped) * rows) / 4096), 0, rows - 1);
+}
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_PERSISTENCEBUFFER_H
+#define DOKIT_GUI_PERSISTENCEBUFFER_H
+
+#include <QImage>
+#include <QVector>
+
+class PersistenceBuffer
+{
+public:
+    static constexpr int defaultWidth { 1024 }; ///< Default number of columns, spanning each capture's samples.
+    static constexpr int defaultHeight { 512 }; ///< Default number of rows, spanning the raw samples' full scale.
+    static constexpr float fadedIntensity { 0.05f }; ///< Intensity below which cells have faded away entirely.
+
+    explicit PersistenceBuffer(const int width = defaultWidth, const int height = defaultHeight);
+
+    int width() const;
+    int height() const;
+    quint64 captures() const;
+    float peak() const;
+
+    void accumulate(const QVector<qint16> &samples);
+    void decay(const float factor);
+    void clear();
+
+    QImage toImage() const;
+
+private:
+    int columns;                ///< Number of columns.
+    int rows;                   ///< Number of rows.
+    QVector<float> intensities; ///< Row-major intensities, with row 0 at the top (the most positive samples).
+    quint64 accumulated { 0 };  ///< Number of captures accumulated since the last clear().
+    float maximum { 0.0f };     ///< Largest intensity, as of the last accumulate() or decay().
+
+    int rowOf(const qint16 sample) const;
+};
+
+#endif // DOKIT_GUI_PERSISTENCEBUFFER_H
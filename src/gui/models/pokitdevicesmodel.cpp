@@ -5,7 +5,6 @@
 #include "../resources.h"
 #include "../../stringliterals_p.h"
 
-#include <qtpokit/pokitdiscoveryagent.h>
 #include <qtpokit/pokitproducts.h>
 
 #include <QBluetoothUuid>
@@ -15,53 +14,173 @@ DOKIT_USE_STRINGLITERALS
 
 PokitDevicesModel::PokitDevicesModel(QObject * const parent) : QStandardItemModel(parent)
 {
+    connect(this, &QStandardItemModel::itemChanged, this, &PokitDevicesModel::onItemChanged);
+}
 
+void PokitDevicesModel::setDeviceRegistry(const PokitDeviceRegistry * registry)
+{
+    connect(registry, &PokitDeviceRegistry::deviceAdded, this, &PokitDevicesModel::onDeviceAdded);
+    connect(registry, &PokitDeviceRegistry::deviceUpdated, this, &PokitDevicesModel::onDeviceUpdated);
+    connect(registry, &PokitDeviceRegistry::deviceRemoved, this, &PokitDevicesModel::onDeviceRemoved);
+    for (const PokitDeviceRegistry::Entry &entry: registry->devices()) {
+        onDeviceAdded(entry);
+    }
 }
 
-void PokitDevicesModel::setDiscoveryAgent(const PokitDiscoveryAgent * agent)
+/*!
+ * Returns the index of the item for the registered device with PokitDeviceRegistry::key() \a key, or an invalid
+ * index if there is no such item. This is a constant time lookup, however many devices are registered.
+ */
+QModelIndex PokitDevicesModel::indexOf(const QString &key) const
 {
-    connect(agent, &PokitDiscoveryAgent::pokitDeviceDiscovered, this, &PokitDevicesModel::onDeviceDiscovered);
-    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
-    connect(agent, &PokitDiscoveryAgent::pokitDeviceUpdated, this, &PokitDevicesModel::onDeviceUpdated);
-    #endif
+    const QStandardItem * const item = items.value(key);
+    return (item == nullptr) ? QModelIndex() : item->index();
 }
 
-void PokitDevicesModel::onDeviceDiscovered(const QBluetoothDeviceInfo &info)
+/*!
+ * Returns the names of this model's roles, including the custom roles, so that QML delegates can bind to them by
+ * name, such as \c model.name, \c model.rssi and \c model.checkState.
+ */
+QHash<int, QByteArray> PokitDevicesModel::roleNames() const
 {
-    qCInfo(lc) << "Discovered" << info.deviceUuid() << QIcon::themeName() << QIcon::themeSearchPaths();
-    /// \todo Check for existing entries (ie avoid duplicates).
-    auto item = new QStandardItem(info.name());
-    item->setCheckable(true);
-    item->setEditable(false);
+    QHash<int, QByteArray> names = QStandardItemModel::roleNames();
+    names.insert(Qt::DisplayRole, "name");
+    names.insert(Qt::CheckStateRole, "checkState");
+    names.insert(BluetoothAddressRole, "bluetoothAddress");
+    names.insert(DeviceUuidRole, "deviceUuid");
+    names.insert(RssiRole, "rssi");
+    names.insert(ConnectionStateRole, "connectionState");
+    names.insert(DeviceKeyRole, "deviceKey");
+    names.insert(ProductRole, "product");
+    return names;
+}
 
-    switch (pokitProduct(info)) {
-        case PokitProduct::PokitMeter: {
-            static QIcon pokitMeterIcon = loadPokitMeterIcon(u"transparent"_s);
-            item->setIcon(pokitMeterIcon);
-        }   break;
-        case PokitProduct::PokitPro: {
-            static QIcon pokitProIcon = loadPokitProIcon(u"gray"_s);
-            item->setIcon(pokitProIcon);
-        }   break;
-        default: {
-            static QIcon pokitLogoIcon = loadPokitLogoIcon();
-            item->setIcon(pokitLogoIcon);
-        }
+/*!
+ * Returns the PokitDeviceRegistry::key() of each checked device.
+ */
+QStringList PokitDevicesModel::checkedKeys() const
+{
+    QStringList keys = checked.values();
+    keys.sort();
+    return keys;
+}
+
+/*!
+ * Sets the PokitDeviceRegistry::key() \a keys of devices to be checked when (if ever) they are added, such as the
+ * devices that were checked when the application last closed. Devices already added are not affected.
+ */
+void PokitDevicesModel::setDefaultCheckedKeys(const QStringList &keys)
+{
+    defaultChecked.clear();
+    for (const QString &key: keys) {
+        defaultChecked.insert(key);
     }
+}
 
-    item->setToolTip(info.address().isNull() ? info.deviceUuid().toString() : info.address().toString());
-    item->setData(info.address().toUInt64(), BluetoothAddressRole);
-    item->setData(info.deviceUuid(), DeviceUuidRole);
+void PokitDevicesModel::onDeviceAdded(const PokitDeviceRegistry::Entry &entry)
+{
+    const QString key = PokitDeviceRegistry::key(entry.info);
+    if (items.contains(key)) {
+        onDeviceUpdated(entry); // Already added, so never duplicated.
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Adding %1 (%2).").arg(entry.name, key);
+    auto item = new QStandardItem(entry.name);
+    item->setCheckable(true);
+    if (defaultChecked.contains(key)) {
+        item->setCheckState(Qt::Checked);
+    }
+    item->setEditable(false);
+    item->setIcon(icon(entry.product));
+    item->setToolTip(key);
+    item->setData(entry.info.address().toUInt64(), BluetoothAddressRole);
+    item->setData(entry.info.deviceUuid(), DeviceUuidRole);
+    item->setData(entry.rssi, RssiRole);
+    item->setData((int)entry.connectionState, ConnectionStateRole);
+    item->setData(key, DeviceKeyRole);
+    item->setData((int)entry.product, ProductRole);
     /// \todo plenty of other data.
+    items.insert(key, item);
     appendRow(item);
+    if (item->checkState() == Qt::Checked) {
+        checked.insert(key);
+        emit checkedChanged(key, true);
+    }
 }
 
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
-void PokitDevicesModel::onDeviceUpdated(const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields)
+void PokitDevicesModel::onDeviceUpdated(const PokitDeviceRegistry::Entry &entry)
 {
-    qCDebug(lc) << "Updated" << info.deviceUuid() << updatedFields;
-    /// \todo 1. Locate the existing item.
-    /// \todo 2. Set the updated field/s.
-    /// \todo 3. emit item->dataChanged().
+    QStandardItem * const item = items.value(PokitDeviceRegistry::key(entry.info));
+    if (item == nullptr) {
+        onDeviceAdded(entry);
+        return;
+    }
+    // Most updates are RSSI changes alone, so only set (and thus only emit dataChanged for) roles that have changed.
+    setDataIfChanged(item, entry.name, Qt::DisplayRole);
+    setDataIfChanged(item, entry.rssi, RssiRole);
+    setDataIfChanged(item, (int)entry.connectionState, ConnectionStateRole);
+    if (item->data(ProductRole).toInt() != (int)entry.product) {
+        item->setData((int)entry.product, ProductRole);
+        item->setIcon(icon(entry.product));
+    }
+}
+
+void PokitDevicesModel::onDeviceRemoved(const PokitDeviceRegistry::Entry &entry)
+{
+    QStandardItem * const item = items.take(PokitDeviceRegistry::key(entry.info));
+    if (item != nullptr) {
+        removeRow(item->row());
+    }
+    if (checked.remove(PokitDeviceRegistry::key(entry.info))) {
+        emit checkedChanged(PokitDeviceRegistry::key(entry.info), false);
+    }
+}
+
+/*!
+ * Emits checkedChanged() if \a item's check state has changed, ignoring the (much more common) changes to its other
+ * data.
+ */
+void PokitDevicesModel::onItemChanged(QStandardItem * const item)
+{
+    const QString key = item->data(DeviceKeyRole).toString();
+    const bool isChecked = (item->checkState() == Qt::Checked);
+    if ((key.isEmpty()) || (isChecked == checked.contains(key))) {
+        return;
+    }
+    if (isChecked) {
+        checked.insert(key);
+    } else {
+        checked.remove(key);
+    }
+    emit checkedChanged(key, isChecked);
+}
+
+/*!
+ * Returns the icon for \a product.
+ */
+QIcon PokitDevicesModel::icon(const PokitProduct product)
+{
+    switch (product) {
+    case PokitProduct::PokitMeter: {
+        static const QIcon pokitMeterIcon = loadPokitMeterIcon(u"transparent"_s);
+        return pokitMeterIcon;
+    }
+    case PokitProduct::PokitPro: {
+        static const QIcon pokitProIcon = loadPokitProIcon(u"gray"_s);
+        return pokitProIcon;
+    }
+    }
+    static const QIcon pokitLogoIcon = loadPokitLogoIcon();
+    return pokitLogoIcon;
+}
+
+/*!
+ * Sets \a item's \a role data to \a value, unless it already has that value, so that views are only notified (via
+ * dataChanged) of roles that have actually changed.
+ */
+void PokitDevicesModel::setDataIfChanged(QStandardItem * const item, const QVariant &value, const int role)
+{
+    if (item->data(role) != value) {
+        item->setData(value, role);
+    }
 }
-#endif
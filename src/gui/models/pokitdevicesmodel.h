@@ -4,13 +4,13 @@
 #ifndef DOKIT_GUI_POKITDEVICESMODEL_H
 #define DOKIT_GUI_POKITDEVICESMODEL_H
 
-#include <qtpokit/qtpokit_global.h>
+#include <qtpokit/pokitdeviceregistry.h>
 
-#include <QBluetoothDeviceInfo>
+#include <QHash>
 #include <QLoggingCategory>
+#include <QSet>
 #include <QStandardItemModel>
 
-QTPOKIT_FORWARD_DECLARE_CLASS(PokitDiscoveryAgent)
 QTPOKIT_USE_NAMESPACE
 
 class PokitDevicesModel : public QStandardItemModel
@@ -21,19 +21,39 @@ public:
     enum : int {
         BluetoothAddressRole = Qt::UserRole,
         DeviceUuidRole,
+        RssiRole,
+        ConnectionStateRole,
+        DeviceKeyRole,
+        ProductRole,
     };
 
     explicit PokitDevicesModel(QObject * const parent = nullptr);
-    void setDiscoveryAgent(const PokitDiscoveryAgent * agent);
+    void setDeviceRegistry(const PokitDeviceRegistry * registry);
+
+    QModelIndex indexOf(const QString &key) const;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QStringList checkedKeys() const;
+    void setDefaultCheckedKeys(const QStringList &keys);
+
+signals:
+    void checkedChanged(const QString &key, const bool checked);
 
 protected:
     static Q_LOGGING_CATEGORY(lc, "dokit.model.devices", QtInfoMsg);
 
+    QHash<QString, QStandardItem *> items; ///< Items for registered devices, by PokitDeviceRegistry::key().
+    QSet<QString> checked;                 ///< Keys of checked items.
+    QSet<QString> defaultChecked;          ///< Keys of devices to check when first added.
+
+    static QIcon icon(const PokitProduct product);
+    static void setDataIfChanged(QStandardItem * const item, const QVariant &value, const int role);
+
 protected slots:
-    void onDeviceDiscovered(const QBluetoothDeviceInfo &info);
-    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
-    void onDeviceUpdated(const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields);
-    #endif
+    void onDeviceAdded(const PokitDeviceRegistry::Entry &entry);
+    void onDeviceUpdated(const PokitDeviceRegistry::Entry &entry);
+    void onDeviceRemoved(const PokitDeviceRegistry::Entry &entry);
+    void onItemChanged(QStandardItem * const item);
 
 };
 
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "samplehistory.h"
+
+#include <algorithm>
+#include <iterator>
+
+/*!
+ * \class SampleHistory
+ *
+ * The SampleHistory class keeps a bounded history of one stream's most recent points, such as a device's meter
+ * readings, for charting.
+ *
+ * Points are appended as values arrive (typically, once per BLE notification), overwriting the oldest points once
+ * depth() points are held, so memory stays flat however long the stream runs. Charts then take a snapshot() at their
+ * own (fixed) refresh rate, so the cost of charting scales with the display's frame rate, rather than the stream's data
+ * rate. Readers may compare totalAppended() between refreshes, to skip refreshing when nothing new has arrived.
+ *
+ * SampleHistory is not thread-safe, so is intended to be written, and read, on the GUI thread only.
+ */
+
+/*!
+ * Constructs a new, empty, history of at most \a depth points.
+ */
+SampleHistory::SampleHistory(const qsizetype depth) : capacity(std::max<qsizetype>(depth, 1))
+{
+    points.reserve(capacity); // Allocated once, up front.
+}
+
+/*!
+ * Returns the maximum number of points kept.
+ */
+qsizetype SampleHistory::depth() const
+{
+    return capacity;
+}
+
+/*!
+ * Sets the maximum number of points kept to \a depth, discarding the oldest points if more than \a depth are already
+ * held.
+ */
+void SampleHistory::setDepth(const qsizetype depth)
+{
+    QVector<QPointF> newest = snapshot();
+    capacity = std::max<qsizetype>(depth, 1);
+    if (newest.size() > capacity) {
+        newest.remove(0, newest.size() - capacity);
+    }
+    newest.reserve(capacity);
+    points = newest;
+    head = 0;
+}
+
+/*!
+ * Returns the number of points currently held.
+ */
+qsizetype SampleHistory::size() const
+{
+    return points.size();
+}
+
+/*!
+ * Returns \c true if no points are held.
+ */
+bool SampleHistory::isEmpty() const
+{
+    return points.isEmpty();
+}
+
+/*!
+ * Returns the total number of points ever appended (since construction, or the last clear()), including those since
+ * overwritten.
+ */
+quint64 SampleHistory::totalAppended() const
+{
+    return appended;
+}
+
+/*!
+ * Appends \a point, overwriting the oldest point if depth() points are already held.
+ */
+void SampleHistory::append(const QPointF &point)
+{
+    ++appended;
+    if (points.size() < capacity) {
+        points.append(point);
+        return;
+    }
+    points[head] = point;
+    head = (head + 1) % capacity;
+}
+
+/*!
+ * Discards all points.
+ */
+void SampleHistory::clear()
+{
+    points.resize(0); // Unlike clear(), retains the reserved capacity.
+    head = 0;
+    appended = 0;
+}
+
+/*!
+ * Returns a copy of all points currently held, oldest first.
+ */
+QVector<QPointF> SampleHistory::snapshot() const
+{
+    if (head == 0) {
+        return points; // Not (yet) wrapped, so already in order, and implicitly shared.
+    }
+    QVector<QPointF> result;
+    result.reserve(points.size());
+    std::copy(points.cbegin() + head, points.cend(), std::back_inserter(result));
+    std::copy(points.cbegin(), points.cbegin() + head, std::back_inserter(result));
+    return result;
+}
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_SAMPLEHISTORY_H
+#define DOKIT_GUI_SAMPLEHISTORY_H
+
+#include <QPointF>
+#include <QVector>
+
+class SampleHistory
+{
+public:
+    static constexpr qsizetype defaultDepth { 600 }; ///< Default number of (most recent) points kept.
+
+    explicit SampleHistory(const qsizetype depth = defaultDepth);
+
+    qsizetype depth() const;
+    void setDepth(const qsizetype depth);
+
+    qsizetype size() const;
+    bool isEmpty() const;
+    quint64 totalAppended() const;
+
+    void append(const QPointF &point);
+    void clear();
+
+    QVector<QPointF> snapshot() const;
+
+private:
+    QVector<QPointF> points;  ///< Circular storage, of #depth points once full.
+    qsizetype capacity;       ///< Maximum number of points kept.
+    qsizetype head { 0 };     ///< Index of the oldest point, once #points is full.
+    quint64 appended { 0 };   ///< Total number of points ever appended.
+};
+
+#endif // DOKIT_GUI_SAMPLEHISTORY_H
@@ -0,0 +1,290 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "plotpipeline.h"
+
+#include <qtpokit/decimation.h>
+#include <qtpokit/dsospectrum.h>
+#include <qtpokit/pokittrace.h>
+
+#include <QRunnable>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/*!
+ * \class PlotPipeline
+ *
+ * The PlotPipeline class decimates, and analyses, values for plotting on a worker thread, so that the GUI thread only
+ * ever has to swap ready-to-plot point buffers into its charts.
+ *
+ * DSO captures (via processCapture()) are decimated, summarised (via DsoStatistics::summarise()), and their spectrum
+ * analysed (via DsoSpectrum), while history snapshots (via processHistory()) are decimated only. Each finished frame
+ * is delivered, via frameReady(), back to the GUI thread.
+ *
+ * Pairs of DSO captures, from two devices (via processXyCaptures()), are instead combined into an XY point cloud (see
+ * pairXy()), with the first capture's values on the X axis, and the second's on the Y axis. Since each device samples
+ * on its own clock, the pairing, and resampling onto a common time base, are done on the worker thread too.
+ *
+ * Jobs are processed one at a time, and at most one job waits for the worker: submitting a job while another is
+ * waiting replaces (that is, cancels) the waiting job, since its frame would be stale before it could be shown. So
+ * however far values outpace processing, the backlog never exceeds one job, and the GUI always shows the newest values
+ * the worker can keep up with. Since jobs cancel each other, each chart should have its own pipeline.
+ */
+
+/// \cond internal
+/// Runs a PlotPipeline's worker loop, as a QRunnable (since QThreadPool::start() only accepts functors from Qt 5.15).
+class PlotPipelineRunnable : public QRunnable
+{
+public:
+    explicit PlotPipelineRunnable(PlotPipeline * const pipeline) : pipeline(pipeline) { }
+    void run() override { pipeline->run(); }
+private:
+    PlotPipeline * const pipeline;
+};
+/// \endcond
+
+/*!
+ * Constructs a new plot pipeline with \a parent.
+ */
+PlotPipeline::PlotPipeline(QObject * const parent) : QObject(parent), spectrum(new DsoSpectrum(nullptr, this))
+{
+    qRegisterMetaType<PlotPipeline::Frame>(); // For queued delivery to the GUI thread.
+    pool.setMaxThreadCount(1);
+}
+
+/*!
+ * Destroys this pipeline, discarding any waiting job, after waiting for any current job to finish.
+ */
+PlotPipeline::~PlotPipeline()
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        pending.reset();
+    }
+    pool.waitForDone();
+}
+
+/*!
+ * Returns \c true if DSO captures are analysed (for statistics and spectrum), as well as decimated.
+ */
+bool PlotPipeline::isAnalysisEnabled() const
+{
+    return analysisEnabled;
+}
+
+/*!
+ * Sets whether DSO captures are analysed (for statistics and spectrum), as well as decimated, to \a enabled. The
+ * default is \c true.
+ */
+void PlotPipeline::setAnalysisEnabled(const bool enabled)
+{
+    analysisEnabled = enabled;
+}
+
+/*!
+ * Returns this pipeline's processing statistics so far.
+ */
+PlotPipeline::Statistics PlotPipeline::statistics() const
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/*!
+ * Queues DSO capture \a samples (and their \a metadata) to be decimated into \a buckets buckets, and (if enabled)
+ * analysed. Returns the job's sequence number, as will be reported by its Frame.
+ */
+quint64 PlotPipeline::processCapture(const DsoService::Metadata &metadata, const DsoService::Samples &samples,
+                                     const qsizetype buckets)
+{
+    Job job;
+    job.buckets = buckets;
+    job.metadata = metadata;
+    job.samples = samples; // Implicitly shared, so no copy.
+    job.analyse = analysisEnabled;
+    return submit(std::move(job));
+}
+
+/*!
+ * Queues history snapshot \a points to be decimated into \a buckets buckets. Returns the job's sequence number, as
+ * will be reported by its Frame.
+ */
+quint64 PlotPipeline::processHistory(const QVector<QPointF> &points, const qsizetype buckets)
+{
+    Job job;
+    job.buckets = buckets;
+    job.points = points; // Implicitly shared, so no copy.
+    return submit(std::move(job));
+}
+
+/*!
+ * Queues DSO captures \a x and \a y, from two devices, to be paired into an XY point cloud, decimated to a grid of
+ * \a buckets by \a buckets cells, as per pairXy(). Returns the job's sequence number, as will be reported by its
+ * Frame.
+ */
+quint64 PlotPipeline::processXyCaptures(const PlotPipeline::TimedCapture &x, const PlotPipeline::TimedCapture &y,
+                                        const qsizetype buckets)
+{
+    Job job;
+    job.buckets = buckets;
+    job.x = x; // Samples are implicitly shared, so no copy.
+    job.y = y;
+    return submit(std::move(job));
+}
+
+/*!
+ * Returns the XY point cloud of capture \a x's values against capture \a y's, over the time both captures span.
+ *
+ * The captures' samples are first resampled, by linear interpolation, onto a common time base: a grid at the finer of
+ * the two captures' sample intervals, across the captures' overlap (according to their start times, and sampling
+ * rates). So the captures need not share a sampling rate, nor be exactly aligned, but the pairing is only ever as
+ * good as their start times. Returns no points if the captures do not overlap.
+ *
+ * The cloud is then decimated by binning its points into a grid of (at most) \a buckets by \a buckets cells spanning
+ * the cloud, keeping only the first point in each cell. Unlike Decimation::minMax(), that does not depend on the
+ * points being in X order, and bounds the points drawn by the display's resolution, however dense the cloud.
+ */
+QVector<QPointF> PlotPipeline::pairXy(const TimedCapture &x, const TimedCapture &y, const qsizetype buckets)
+{
+    const auto intervalOf = [](const TimedCapture &capture) { // Microseconds between samples.
+        return (capture.metadata.samplingRate > 0) ? 1e6 / capture.metadata.samplingRate : 0.0;
+    };
+    const double xInterval = intervalOf(x), yInterval = intervalOf(y);
+    if ((x.samples.size() < 2) || (y.samples.size() < 2) || (xInterval <= 0.0) || (yInterval <= 0.0)
+        || (buckets <= 0)) {
+        return { };
+    }
+    const double begin = (double)std::max(x.start, y.start);
+    const double end = std::min(x.start + xInterval * (double)(x.samples.size() - 1),
+                                y.start + yInterval * (double)(y.samples.size() - 1));
+    if (end < begin) {
+        return { }; // The captures do not overlap.
+    }
+
+    // Returns capture's value at time, linearly interpolated between the two nearest samples.
+    const auto valueAt = [](const TimedCapture &capture, const double interval, const double time) {
+        const double position = (time - (double)capture.start) / interval;
+        const qsizetype index = std::clamp<qsizetype>((qsizetype)position, 0, capture.samples.size() - 2);
+        const double before = capture.samples.at(index), after = capture.samples.at(index + 1);
+        return (before + (position - (double)index) * (after - before)) * capture.metadata.scale;
+    };
+
+    // Resample both captures onto the common time base.
+    const double step = std::min(xInterval, yInterval);
+    const qsizetype count = (qsizetype)((end - begin) / step) + 1;
+    QVector<QPointF> points;
+    points.reserve(count);
+    for (qsizetype point = 0; point < count; ++point) {
+        const double time = begin + (double)point * step;
+        points.append(QPointF(valueAt(x, xInterval, time), valueAt(y, yInterval, time)));
+    }
+    if (points.size() <= buckets) {
+        return points;
+    }
+
+    // Keep only the first point in each cell of a buckets x buckets grid over the cloud's bounds.
+    const auto [minX, maxX] = std::minmax_element(points.cbegin(), points.cend(),
+        [](const QPointF &lhs, const QPointF &rhs) { return lhs.x() < rhs.x(); });
+    const auto [minY, maxY] = std::minmax_element(points.cbegin(), points.cend(),
+        [](const QPointF &lhs, const QPointF &rhs) { return lhs.y() < rhs.y(); });
+    const qsizetype cells = std::min<qsizetype>(buckets, 2048);
+    const qreal left = minX->x(), bottom = minY->y();
+    const qreal xScale = (maxX->x() > left) ? (qreal)(cells - 1) / (maxX->x() - left) : 0.0;
+    const qreal yScale = (maxY->y() > bottom) ? (qreal)(cells - 1) / (maxY->y() - bottom) : 0.0;
+    std::vector<bool> occupied((size_t)(cells * cells), false);
+    QVector<QPointF> decimated;
+    decimated.reserve(std::min(points.size(), cells * cells));
+    for (const QPointF &point: points) {
+        const qsizetype column = (qsizetype)((point.x() - left) * xScale + 0.5);
+        const qsizetype row = (qsizetype)((point.y() - bottom) * yScale + 0.5);
+        if (const size_t cell = (size_t)(row * cells + column); !occupied[cell]) {
+            occupied[cell] = true;
+            decimated.append(point);
+        }
+    }
+    return decimated;
+}
+
+/*!
+ * Queues \a job for the worker, replacing any job still waiting, and starts the worker if not already running.
+ * Returns the job's sequence number.
+ */
+quint64 PlotPipeline::submit(Job &&job)
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    const quint64 sequence = nextSequence++;
+    if (stopping) {
+        return sequence;
+    }
+    job.sequence = sequence;
+    ++stats.submitted;
+    if (pending) {
+        ++stats.cancelled;
+        qCDebug(lc).noquote() << tr("Cancelling stale job %1, for job %2.").arg(pending->sequence).arg(job.sequence);
+    }
+    pending = std::move(job);
+    if (!running) {
+        running = true;
+        pool.start(new PlotPipelineRunnable(this)); // The pool deletes the runnable once done.
+    }
+    return sequence;
+}
+
+/*!
+ * Runs the worker loop, processing the pending job (if any), until there are no more pending jobs.
+ */
+void PlotPipeline::run()
+{
+    QTPOKIT_TRACE_THREAD_NAME("plotPipeline");
+    while (true) {
+        std::optional<Job> job;
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            if ((stopping) || (!pending)) {
+                running = false;
+                return;
+            }
+            job.swap(pending);
+        }
+        const Frame frame = process(*job);
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            ++stats.processed;
+        }
+        emit frameReady(frame); // Queued to receivers on the GUI thread.
+    }
+}
+
+/*!
+ * Processes \a job, returning its frame.
+ */
+PlotPipeline::Frame PlotPipeline::process(const Job &job)
+{
+    QTPOKIT_TRACE_ZONE(Format, "plotPipeline");
+    Frame frame;
+    frame.sequence = job.sequence;
+    if ((job.x) && (job.y)) {
+        frame.points = pairXy(*job.x, *job.y, job.buckets);
+        return frame;
+    }
+    if (!job.metadata) {
+        frame.points = Decimation::minMax(job.points, job.buckets);
+        return frame;
+    }
+
+    frame.points = Decimation::minMax(*job.metadata, job.samples, job.buckets);
+    if (job.analyse) {
+        frame.statistics = DsoStatistics::summarise(*job.metadata, job.samples);
+        const DsoSpectrum::Spectrum result = spectrum->analyse(*job.metadata, job.samples);
+        QVector<QPointF> magnitudes;
+        magnitudes.reserve(result.magnitudes.size());
+        for (qsizetype bin = 0; bin < result.magnitudes.size(); ++bin) {
+            magnitudes.append(QPointF(bin * (qreal)result.resolution, (qreal)result.magnitudes.at(bin)));
+        }
+        frame.spectrum = Decimation::minMax(magnitudes, job.buckets);
+    }
+    return frame;
+}
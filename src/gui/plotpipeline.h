@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_PLOTPIPELINE_H
+#define DOKIT_GUI_PLOTPIPELINE_H
+
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/dsostatistics.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+#include <QPointF>
+#include <QThreadPool>
+#include <QVector>
+
+#include <mutex>
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+class DsoSpectrum;
+QTPOKIT_END_NAMESPACE
+
+QTPOKIT_USE_NAMESPACE
+
+class PlotPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// A processed frame, ready to plot.
+    struct Frame {
+        quint64 sequence { 0 };   ///< Sequence number of the job this frame was processed for.
+        QVector<QPointF> points;  ///< Decimated points.
+        std::optional<DsoStatistics::Summary> statistics; ///< Capture's statistics, for DSO captures only.
+        QVector<QPointF> spectrum; ///< Capture's decimated (Hz, amplitude) spectrum, for DSO captures only.
+    };
+
+    /// Processing statistics.
+    struct Statistics {
+        quint64 submitted { 0 }; ///< Number of jobs submitted.
+        quint64 processed { 0 }; ///< Number of jobs processed, and delivered via frameReady().
+        quint64 cancelled { 0 }; ///< Number of jobs replaced by a newer job before processing began.
+    };
+
+    /// A DSO capture, and the time it began, for pairing with another device's capture in XY mode.
+    struct TimedCapture {
+        DsoService::Metadata metadata; ///< Capture's metadata.
+        DsoService::Samples samples;   ///< Capture's raw samples.
+        qint64 start { 0 };            ///< Time of the capture's first sample, in microseconds, on a shared clock.
+    };
+
+    explicit PlotPipeline(QObject * const parent = nullptr);
+    ~PlotPipeline() override;
+
+    bool isAnalysisEnabled() const;
+    void setAnalysisEnabled(const bool enabled);
+
+    Statistics statistics() const;
+
+    static QVector<QPointF> pairXy(const TimedCapture &x, const TimedCapture &y, const qsizetype buckets);
+
+public slots:
+    quint64 processCapture(const DsoService::Metadata &metadata, const DsoService::Samples &samples,
+                           const qsizetype buckets);
+    quint64 processHistory(const QVector<QPointF> &points, const qsizetype buckets);
+    quint64 processXyCaptures(const PlotPipeline::TimedCapture &x, const PlotPipeline::TimedCapture &y,
+                              const qsizetype buckets);
+
+signals:
+    void frameReady(const PlotPipeline::Frame &frame);
+
+protected:
+    static Q_LOGGING_CATEGORY(lc, "dokit.gui.plotPipeline", QtInfoMsg);
+
+private:
+    /// A unit of work: either a DSO capture, a history snapshot, or a pair of DSO captures for XY mode.
+    struct Job {
+        quint64 sequence { 0 };          ///< Job's sequence number.
+        qsizetype buckets { 0 };         ///< Number of buckets to decimate to.
+        std::optional<DsoService::Metadata> metadata; ///< DSO capture's metadata, for DSO captures only.
+        DsoService::Samples samples;     ///< DSO capture's samples, for DSO captures only.
+        QVector<QPointF> points;         ///< History snapshot's points, for history snapshots only.
+        bool analyse { false };          ///< Whether to calculate statistics and spectrum, for DSO captures.
+        std::optional<TimedCapture> x;   ///< Capture to plot on the X axis, for XY pairs only.
+        std::optional<TimedCapture> y;   ///< Capture to plot on the Y axis, for XY pairs only.
+    };
+
+    QThreadPool pool;                 ///< Single worker thread, so jobs are processed one at a time, in order.
+    DsoSpectrum * spectrum;           ///< Spectrum analyser, only ever used by the worker thread.
+    bool analysisEnabled { true };    ///< Whether DSO captures are also analysed.
+
+    mutable std::mutex mutex;         ///< Guards the members below.
+    quint64 nextSequence { 0 };       ///< Sequence number of the next job submitted.
+    std::optional<Job> pending;       ///< Newest job not yet started, if any.
+    bool running { false };           ///< Whether the worker is processing, or about to process, a job.
+    bool stopping { false };          ///< Whether this pipeline is being destroyed.
+    Statistics stats;                 ///< Processing statistics.
+
+    quint64 submit(Job &&job);
+    void run();
+    Frame process(const Job &job);
+
+    friend class PlotPipelineRunnable;
+};
+
+Q_DECLARE_METATYPE(PlotPipeline::Frame)
+
+#endif // DOKIT_GUI_PLOTPIPELINE_H
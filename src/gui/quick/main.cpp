@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "plotitem.h"
+#include "quickdashboard.h"
+#include "../models/pokitdevicesmodel.h"
+#include "../../stringliterals_p.h"
+
+#include <qtpokit/pokitdeviceregistry.h>
+#include <qtpokit/pokittrace.h>
+
+#include <QGuiApplication>
+#include <QQmlApplicationEngine>
+#include <QQmlContext>
+#include <QtQml/qqml.h>
+
+DOKIT_USE_STRINGLITERALS
+
+int main(int argc, char *argv[])
+{
+    // Setup the application.
+    QGuiApplication app(argc, argv);
+    QTPOKIT_TRACE_THREAD_NAME("gui");
+    QGuiApplication::setApplicationName(QStringLiteral(PROJECT_NAME));
+    QGuiApplication::setApplicationVersion(QString::fromLatin1(PROJECT_VERSION
+        #ifdef PROJECT_PRE_RELEASE
+        "-" PROJECT_PRE_RELEASE
+        #endif
+        #ifdef PROJECT_BUILD_ID
+        "+" PROJECT_BUILD_ID
+        #endif
+    ));
+    QGuiApplication::setOrganizationName(QStringLiteral(PROJECT_ORGANIZATION_NAME));     // Only used for QSettings.
+    QGuiApplication::setOrganizationDomain(QStringLiteral(PROJECT_ORGANIZATION_DOMAIN)); // Only used for QSettings.
+
+    /// \todo Install localised translators, if we have translations for the current locale.
+
+    // Register the QML types, as used by qml/main.qml.
+    qmlRegisterType<PlotItem>("Dokit", 1, 0, "Plot");
+    qmlRegisterUncreatableType<QuickDashboard>("Dokit", 1, 0, "Dashboard",
+        u"Dashboard is provided by the application, as the dashboard context property"_s);
+    qmlRegisterUncreatableType<PokitDeviceRegistry>("Dokit", 1, 0, "DeviceRegistry",
+        u"DeviceRegistry is provided by the application, as the deviceRegistry context property"_s);
+
+    // Share one device registry between the devices model (for choosing devices) and the dashboard (for showing them).
+    PokitDeviceRegistry deviceRegistry;
+    PokitDevicesModel devicesModel;
+    devicesModel.setDeviceRegistry(&deviceRegistry);
+    QuickDashboard dashboard;
+    dashboard.setDeviceRegistry(&deviceRegistry);
+    QObject::connect(&devicesModel, &PokitDevicesModel::checkedChanged, &dashboard,
+                     [&dashboard](const QString &key, const bool checked) {
+        if (checked) {
+            dashboard.addDevice(key);
+        } else {
+            dashboard.removeDevice(key);
+        }
+    });
+
+    // Load the QML front end.
+    QQmlApplicationEngine engine;
+    engine.rootContext()->setContextProperty(u"deviceRegistry"_s, &deviceRegistry);
+    engine.rootContext()->setContextProperty(u"devicesModel"_s, &devicesModel);
+    engine.rootContext()->setContextProperty(u"dashboard"_s, &dashboard);
+    engine.load(QUrl(u"qrc:/qml/main.qml"_s));
+    if (engine.rootObjects().isEmpty()) {
+        return 1;
+    }
+    deviceRegistry.start();
+    return QGuiApplication::exec();
+}
@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "plotitem.h"
+
+#include <QSGFlatColorMaterial>
+#include <QSGGeometry>
+#include <QSGGeometryNode>
+
+#include <algorithm>
+
+/*!
+ * \class PlotItem
+ *
+ * The PlotItem class draws an axis-less line plot of points, scaled to fill the item, directly as Qt Quick
+ * scene-graph geometry, so the line is rasterised by the GPU (on the scene graph's render thread), with no
+ * QPainter, or Qt Charts, involved.
+ *
+ * Points are expected to already be decimated (see Decimation::minMax()) to about the item's width, such as by a
+ * QuickDashboard render tick, or a PlotPipeline frame. Setting points only records them (and their bounds), and
+ * schedules an update. The render thread then writes them straight into the node's existing vertex buffer, which is
+ * only ever reallocated when a frame has more points than any before it: shorter frames repeat their last point,
+ * drawing zero-length segments. So steady-state frames cost no allocations at all.
+ */
+
+/*!
+ * Constructs a new, empty, plot with \a parent.
+ */
+PlotItem::PlotItem(QQuickItem * const parent) : QQuickItem(parent)
+{
+    setFlag(ItemHasContents);
+}
+
+/*!
+ * Returns the colour of the plotted line.
+ */
+QColor PlotItem::color() const
+{
+    return lineColor;
+}
+
+/*!
+ * Sets the colour of the plotted line to \a color.
+ */
+void PlotItem::setColor(const QColor &color)
+{
+    if (lineColor == color) {
+        return;
+    }
+    lineColor = color;
+    materialDirty = true;
+    update();
+    emit colorChanged();
+}
+
+/*!
+ * Returns the width of the plotted line, in pixels.
+ */
+qreal PlotItem::lineWidth() const
+{
+    return penWidth;
+}
+
+/*!
+ * Sets the width of the plotted line to \a width pixels. Note, some graphics APIs (such as Metal, and OpenGL core
+ * profiles) only support lines one pixel wide.
+ */
+void PlotItem::setLineWidth(const qreal width)
+{
+    if (qFuzzyCompare(penWidth, width)) {
+        return;
+    }
+    penWidth = width;
+    geometryDirty = true;
+    update();
+    emit lineWidthChanged();
+}
+
+/*!
+ * Returns the number of points plotted.
+ */
+int PlotItem::pointCount() const
+{
+    return (int)values.size();
+}
+
+/*!
+ * Returns the points plotted.
+ */
+const QVector<QPointF> &PlotItem::points() const
+{
+    return values;
+}
+
+/*!
+ * Sets the \a points to plot, and schedules an update.
+ */
+void PlotItem::setPoints(const QVector<QPointF> &points)
+{
+    values = points; // Implicitly shared, so no copy.
+    if (values.isEmpty()) {
+        bounds = QRectF();
+    } else {
+        const auto [min, max] = std::minmax_element(values.cbegin(), values.cend(),
+            [](const QPointF &lhs, const QPointF &rhs) { return lhs.y() < rhs.y(); });
+        bounds = QRectF(QPointF(values.first().x(), min->y()), QPointF(values.last().x(), max->y()));
+    }
+    geometryDirty = true;
+    update();
+    emit pointsChanged();
+}
+
+/*!
+ * Removes all plotted points.
+ */
+void PlotItem::clear()
+{
+    setPoints({ });
+}
+
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+void PlotItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+#else
+void PlotItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+#endif
+    if (newGeometry.size() != oldGeometry.size()) {
+        geometryDirty = true; // Points are scaled to fill the item, so need rescaling.
+        update();
+    }
+}
+
+/*!
+ * Updates (or creates) \a oldNode's line strip geometry, and material, from the points last set. This is invoked on
+ * the scene graph's render thread, while the GUI thread is blocked, so may safely read this item's members.
+ */
+QSGNode * PlotItem::updatePaintNode(QSGNode * oldNode, UpdatePaintNodeData * data)
+{
+    Q_UNUSED(data)
+    if (values.size() < 2) {
+        delete oldNode; // Nothing to draw, so no node at all.
+        return nullptr;
+    }
+
+    auto node = static_cast<QSGGeometryNode *>(oldNode);
+    if (node == nullptr) {
+        node = new QSGGeometryNode;
+        auto geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), (int)values.size());
+        geometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new QSGFlatColorMaterial);
+        node->setFlag(QSGNode::OwnsMaterial);
+        geometryDirty = materialDirty = true;
+    }
+
+    if (materialDirty) {
+        static_cast<QSGFlatColorMaterial *>(node->material())->setColor(lineColor);
+        node->markDirty(QSGNode::DirtyMaterial);
+        materialDirty = false;
+    }
+
+    if (geometryDirty) {
+        QSGGeometry * const geometry = node->geometry();
+        if (geometry->vertexCount() < values.size()) {
+            geometry->allocate((int)values.size()); // Only ever grows, so steady-state frames never allocate.
+        }
+        geometry->setLineWidth((float)penWidth);
+
+        const qreal rangeX = std::max(bounds.width(), 1e-6);
+        const qreal rangeY = std::max(bounds.height(), 1e-6);
+        const QRectF area = boundingRect().adjusted(1, 1, -1, -1);
+        QSGGeometry::Point2D * const vertices = geometry->vertexDataAsPoint2D();
+        for (qsizetype index = 0; index < values.size(); ++index) {
+            const QPointF &point = values.at(index);
+            vertices[index].set((float)(area.left() + ((point.x() - bounds.left()) / rangeX) * area.width()),
+                                (float)(area.bottom() - ((point.y() - bounds.top()) / rangeY) * area.height()));
+        }
+        std::fill(vertices + values.size(), vertices + geometry->vertexCount(), vertices[values.size() - 1]);
+        node->markDirty(QSGNode::DirtyGeometry);
+        geometryDirty = false;
+    }
+    return node;
+}
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_PLOTITEM_H
+#define DOKIT_GUI_PLOTITEM_H
+
+#include <QColor>
+#include <QPointF>
+#include <QQuickItem>
+#include <QRectF>
+#include <QVector>
+
+class PlotItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(qreal lineWidth READ lineWidth WRITE setLineWidth NOTIFY lineWidthChanged)
+    Q_PROPERTY(int pointCount READ pointCount NOTIFY pointsChanged)
+
+public:
+    explicit PlotItem(QQuickItem * const parent = nullptr);
+
+    QColor color() const;
+    void setColor(const QColor &color);
+
+    qreal lineWidth() const;
+    void setLineWidth(const qreal width);
+
+    int pointCount() const;
+    const QVector<QPointF> &points() const;
+
+public slots:
+    void setPoints(const QVector<QPointF> &points);
+    void clear();
+
+signals:
+    void colorChanged();
+    void lineWidthChanged();
+    void pointsChanged();
+
+protected:
+    #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    #else
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    #endif
+    QSGNode * updatePaintNode(QSGNode * oldNode, UpdatePaintNodeData * data) override;
+
+private:
+    QVector<QPointF> values;       ///< Points to draw, already decimated to (about) this item's width.
+    QRectF bounds;                 ///< Bounding rectangle of #values, in the values' own units.
+    QColor lineColor { 0x2a, 0x82, 0xda }; ///< Colour of the line.
+    qreal penWidth { 1.5 };        ///< Width of the line, in pixels, where the graphics API supports wide lines.
+    bool geometryDirty { false };  ///< Whether #values (or this item's size) has changed since the last render.
+    bool materialDirty { true };   ///< Whether #lineColor has changed since the last render.
+};
+
+#endif // DOKIT_GUI_PLOTITEM_H
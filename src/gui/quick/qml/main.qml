@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import Dokit 1.0
+
+ApplicationWindow {
+    id: window
+    width: 1280
+    height: 800
+    visible: true
+    title: Qt.application.name
+
+    // Devices to choose from, as discovered by the device registry. Checking a device adds it to the dashboard.
+    Drawer {
+        id: devicesDrawer
+        width: Math.min(window.width * 0.3, 320)
+        height: window.height
+
+        ListView {
+            anchors.fill: parent
+            model: devicesModel
+            delegate: CheckDelegate {
+                width: ListView.view.width
+                text: model.name
+                checked: model.checkState === Qt.Checked
+                onToggled: model.checkState = checked ? Qt.Checked : Qt.Unchecked
+                ToolTip.text: qsTr("%1 (%2 dBm)").arg(model.deviceKey).arg(model.rssi)
+                ToolTip.visible: hovered
+            }
+        }
+    }
+
+    header: ToolBar {
+        RowLayout {
+            anchors.fill: parent
+            ToolButton {
+                text: qsTr("Devices")
+                onClicked: devicesDrawer.open()
+            }
+            Label {
+                Layout.fillWidth: true
+                text: qsTr("%1 device(s) on the dashboard").arg(dashboard.count)
+                elide: Label.ElideRight
+            }
+        }
+    }
+
+    // One card per dashboard device, each with a scene-graph plot of its recent readings.
+    GridView {
+        id: grid
+        anchors.fill: parent
+        anchors.margins: 8
+        cellWidth: Math.max(width / 4, 240)
+        cellHeight: 180
+        model: dashboard
+
+        delegate: Frame {
+            width: grid.cellWidth - 8
+            height: grid.cellHeight - 8
+
+            ColumnLayout {
+                anchors.fill: parent
+
+                Label {
+                    text: model.name
+                    font.bold: true
+                    elide: Label.ElideRight
+                    Layout.fillWidth: true
+                }
+                Label {
+                    text: (model.value === undefined) ? model.status : qsTr("%1 (%2)").arg(model.value).arg(model.mode)
+                    font.pointSize: 16
+                }
+                Plot {
+                    id: plot
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    color: palette.highlight
+                    Component.onCompleted: dashboard.setPlot(model.deviceKey, plot)
+                }
+                Label {
+                    text: model.battery ? qsTr("Battery: %1").arg(model.battery) : ""
+                    font.pointSize: 9
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,323 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "quickdashboard.h"
+#include "plotitem.h"
+#include "../deviceworker.h"
+
+#include <qtpokit/decimation.h>
+#include <qtpokit/pokittrace.h>
+
+#include <algorithm>
+#include <utility>
+
+/*!
+ * \class QuickDashboard
+ *
+ * The QuickDashboard class is the Qt Quick counterpart of DashboardView: a list model of any number of devices, such
+ * as all devices checked in a PokitDevicesModel, for a QML view (such as a GridView) to show one delegate per device.
+ *
+ * As for DashboardView, each device is connected to, and read by, its own DeviceWorker, on its own thread, so the
+ * devices' PokitDevice and service objects never live on (nor compete with) the GUI thread. QML binds to the devices'
+ * names, connection statuses, readings and battery statuses via this model's roles instead.
+ *
+ * Readings are only recorded as they arrive. Then all devices' plots (each a PlotItem, attached via setPlot()) are
+ * refreshed together, by one shared render tick, at a capped frameRate(), which only runs while readings are
+ * arriving: each tick decimates (see Decimation::minMax()) just the stale devices' histories to their plots' widths,
+ * and hands the points to the scene graph. Likewise, the reading roles' dataChanged signals are only emitted once
+ * per tick, not once per reading.
+ */
+
+/*!
+ * Constructs a new, empty, dashboard with \a parent.
+ */
+QuickDashboard::QuickDashboard(QObject * const parent) : QAbstractListModel(parent)
+{
+    renderTimer = new QTimer(this);
+    renderTimer->setInterval(1000 / defaultFrameRate);
+    connect(renderTimer, &QTimer::timeout, this, &QuickDashboard::render);
+}
+
+/*!
+ * Destroys this dashboard, disconnecting from all devices, after waiting for their worker threads to finish.
+ */
+QuickDashboard::~QuickDashboard()
+{
+    for (const Device &device: std::as_const(devices)) {
+        device.thread->quit(); // The worker (and its device) are then deleted in the thread, as it finishes.
+        device.thread->wait();
+        delete device.thread;
+    }
+}
+
+/*!
+ * Sets the \a registry to look up devices in (by key), and to share device names and connection states with.
+ */
+void QuickDashboard::setDeviceRegistry(PokitDeviceRegistry * const registry)
+{
+    if (this->registry) {
+        disconnect(this->registry, nullptr, this, nullptr);
+    }
+    this->registry = registry;
+    if (registry) {
+        connect(registry, &PokitDeviceRegistry::deviceUpdated, this, &QuickDashboard::onDeviceUpdated);
+    }
+}
+
+/*!
+ * Returns the number of devices on this dashboard.
+ */
+int QuickDashboard::count() const
+{
+    return (int)devices.size();
+}
+
+/*!
+ * Returns the maximum number of times the plots are refreshed per second.
+ */
+int QuickDashboard::frameRate() const
+{
+    return 1000 / std::max(renderTimer->interval(), 1);
+}
+
+/*!
+ * Sets the maximum number of times the plots are refreshed per second to \a rate. The default is #defaultFrameRate.
+ */
+void QuickDashboard::setFrameRate(const int rate)
+{
+    const int interval = 1000 / std::clamp(rate, 1, 1000);
+    if (renderTimer->interval() != interval) {
+        renderTimer->setInterval(interval);
+        emit frameRateChanged();
+    }
+}
+
+/*!
+ * Returns \c true if the device with PokitDeviceRegistry::key() \a key is on this dashboard.
+ */
+bool QuickDashboard::contains(const QString &key) const
+{
+    return rowOf(key) >= 0;
+}
+
+int QuickDashboard::rowCount(const QModelIndex &parent) const
+{
+    return (parent.isValid()) ? 0 : (int)devices.size();
+}
+
+QVariant QuickDashboard::data(const QModelIndex &index, int role) const
+{
+    if ((!index.isValid()) || (index.row() >= devices.size())) {
+        return QVariant();
+    }
+    const Device &device = devices.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:      return device.name;
+    case Qt::ToolTipRole:
+    case DeviceKeyRole: return device.key;
+    case StatusRole:    return device.status;
+    case ValueRole:     return (device.mode.isNull()) ? QVariant() : QVariant(device.value);
+    case ModeRole:      return device.mode;
+    case BatteryRole:   return device.battery;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> QuickDashboard::roleNames() const
+{
+    return {
+        { DeviceKeyRole, "deviceKey" },
+        { NameRole,      "name" },
+        { StatusRole,    "status" },
+        { ValueRole,     "value" },
+        { ModeRole,      "mode" },
+        { BatteryRole,   "battery" },
+    };
+}
+
+/*!
+ * Adds the registered device with PokitDeviceRegistry::key() \a key, and starts its worker. Returns \c true if the
+ * device is (now, or already) on this dashboard, or \c false if no such device is registered.
+ */
+bool QuickDashboard::addDevice(const QString &key)
+{
+    if (contains(key)) {
+        return true;
+    }
+    const std::optional<PokitDeviceRegistry::Entry> entry = (registry) ? registry->device(key) : std::nullopt;
+    if (!entry) {
+        qCWarning(lc).noquote() << tr("No registered device %1.").arg(key);
+        return false;
+    }
+    qCDebug(lc).noquote() << tr("Adding %1 (%2).").arg(entry->name, key);
+
+    Device device;
+    device.key = key;
+    device.name = entry->name;
+    device.status = tr("Connecting");
+    device.thread = new QThread;
+    device.thread->setObjectName(entry->name);
+    device.worker = new DeviceWorker(entry->info, entry->product);
+    device.worker->moveToThread(device.thread);
+    connect(device.thread, &QThread::started, device.worker, &DeviceWorker::start);
+    connect(device.thread, &QThread::finished, device.worker, &QObject::deleteLater);
+
+    // Worker signals are queued to the GUI thread. The worker is deleted (on its own thread) only after it is removed
+    // from this dashboard, so look the device up by key, rather than capturing any reference to it.
+    connect(device.worker, &DeviceWorker::connected, this, [this, key]() {
+        updateDevice(key, { StatusRole }, [](Device &device) { device.status = tr("Connected"); });
+        if (registry) {
+            registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Connected);
+        }
+    });
+    connect(device.worker, &DeviceWorker::disconnected, this, [this, key]() {
+        updateDevice(key, { StatusRole }, [](Device &device) { device.status = tr("Disconnected"); });
+        if (registry) {
+            registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Disconnected);
+        }
+    });
+    connect(device.worker, &DeviceWorker::readingRead, this, [this, key](const float value, const QString &mode) {
+        const int row = rowOf(key);
+        if (row < 0) {
+            return;
+        }
+        Device &device = devices[row];
+        if (!device.clock.isValid()) {
+            device.clock.start();
+        }
+        device.history.append(QPointF((qreal)device.clock.nsecsElapsed() / 1e9, (qreal)value));
+        device.value = value;
+        device.mode = mode;
+        scheduleRender(); // Roles, and plots, are then updated once per frame.
+    });
+    connect(device.worker, &DeviceWorker::batteryRead, this, [this, key](const float voltage, const QString &status) {
+        updateDevice(key, { BatteryRole }, [voltage, &status](Device &device) {
+            device.battery = tr("%1 V (%2)").arg(voltage, 0, 'f', 2).arg(status);
+        });
+    });
+
+    if (registry) {
+        registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Connecting);
+    }
+    const auto iter = std::lower_bound(devices.cbegin(), devices.cend(), key,
+        [](const Device &device, const QString &key) { return device.key < key; });
+    const int row = (int)(iter - devices.cbegin());
+    beginInsertRows(QModelIndex(), row, row);
+    devices.insert(row, device);
+    endInsertRows();
+    device.thread->start();
+    emit countChanged();
+    return true;
+}
+
+/*!
+ * Removes the device with PokitDeviceRegistry::key() \a key, if any, disconnecting from the device.
+ */
+void QuickDashboard::removeDevice(const QString &key)
+{
+    const int row = rowOf(key);
+    if (row < 0) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Removing %1.").arg(key);
+    beginRemoveRows(QModelIndex(), row, row);
+    const Device device = devices.takeAt(row);
+    endRemoveRows();
+    connect(device.thread, &QThread::finished, device.thread, &QObject::deleteLater);
+    device.thread->quit(); // The worker (and its device) are then deleted in the thread, as it finishes.
+    if (registry) {
+        registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Disconnected);
+    }
+    emit countChanged();
+}
+
+/*!
+ * Sets the \a plot to show the history of the device with PokitDeviceRegistry::key() \a key, such as from the
+ * device's QML delegate, once created. The plot is shown the device's current history on the next frame.
+ */
+void QuickDashboard::setPlot(const QString &key, PlotItem * const plot)
+{
+    const int row = rowOf(key);
+    if (row < 0) {
+        qCWarning(lc).noquote() << tr("No dashboard device %1.").arg(key);
+        return;
+    }
+    Device &device = devices[row];
+    device.plot = plot;
+    device.shown = device.history.totalAppended() - 1; // Stale, so rendered on the next frame.
+    scheduleRender();
+}
+
+/*!
+ * Returns the row of the device with PokitDeviceRegistry::key() \a key, or -1 if there is no such device.
+ */
+int QuickDashboard::rowOf(const QString &key) const
+{
+    const auto iter = std::lower_bound(devices.cbegin(), devices.cend(), key,
+        [](const Device &device, const QString &key) { return device.key < key; });
+    return ((iter == devices.cend()) || (iter->key != key)) ? -1 : (int)(iter - devices.cbegin());
+}
+
+/*!
+ * Starts the shared render tick, if not already running.
+ */
+void QuickDashboard::scheduleRender()
+{
+    if (!renderTimer->isActive()) {
+        renderTimer->start();
+    }
+}
+
+/*!
+ * Applies \a update to the device with PokitDeviceRegistry::key() \a key, if any, then notifies views that its
+ * \a roles have changed.
+ */
+void QuickDashboard::updateDevice(const QString &key, const QVector<int> &roles,
+                                  const std::function<void(Device &)> &update)
+{
+    const int row = rowOf(key);
+    if (row >= 0) {
+        update(devices[row]);
+        emit dataChanged(index(row), index(row), roles);
+    }
+}
+
+/*!
+ * Updates the name of \a entry's device, if it is on this dashboard.
+ */
+void QuickDashboard::onDeviceUpdated(const PokitDeviceRegistry::Entry &entry)
+{
+    const int row = rowOf(PokitDeviceRegistry::key(entry.info));
+    if ((row >= 0) && (devices.at(row).name != entry.name)) {
+        devices[row].name = entry.name;
+        emit dataChanged(index(row), index(row), { NameRole, Qt::DisplayRole });
+    }
+}
+
+/*!
+ * Refreshes every device with readings recorded since the last refresh, in a single pass, or stops the render tick
+ * if there are none.
+ */
+void QuickDashboard::render()
+{
+    bool rendered = false;
+    for (int row = 0; row < devices.size(); ++row) {
+        Device &device = devices[row];
+        if (device.history.totalAppended() == device.shown) {
+            continue;
+        }
+        device.shown = device.history.totalAppended();
+        emit dataChanged(index(row), index(row), { ValueRole, ModeRole });
+        if (device.plot) {
+            device.plot->setPoints(Decimation::minMax(device.history.snapshot(),
+                                                      std::max((qsizetype)device.plot->width(), (qsizetype)16)));
+        }
+        rendered = true;
+    }
+    if (rendered) {
+        QTPOKIT_TRACE_FRAME_MARK("quickDashboard");
+    } else {
+        renderTimer->stop(); // Nothing new, so idle until more readings arrive.
+    }
+}
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_QUICKDASHBOARD_H
+#define DOKIT_GUI_QUICKDASHBOARD_H
+
+#include "../models/samplehistory.h"
+
+#include <qtpokit/pokitdeviceregistry.h>
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
+
+class DeviceWorker;
+class PlotItem;
+
+QTPOKIT_USE_NAMESPACE
+
+class QuickDashboard : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int frameRate READ frameRate WRITE setFrameRate NOTIFY frameRateChanged)
+
+public:
+    static constexpr int defaultFrameRate { 10 };    ///< Default maximum number of frames rendered per second.
+    static constexpr qsizetype historyDepth { 240 }; ///< Number of (most recent) readings kept per device.
+
+    enum : int {
+        DeviceKeyRole = Qt::UserRole,
+        NameRole,
+        StatusRole,
+        ValueRole,
+        ModeRole,
+        BatteryRole,
+    };
+
+    explicit QuickDashboard(QObject * const parent = nullptr);
+    ~QuickDashboard() override;
+
+    void setDeviceRegistry(PokitDeviceRegistry * const registry);
+
+    int count() const;
+    int frameRate() const;
+    void setFrameRate(const int rate);
+
+    Q_INVOKABLE bool contains(const QString &key) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+public slots:
+    bool addDevice(const QString &key);
+    void removeDevice(const QString &key);
+    void setPlot(const QString &key, PlotItem * const plot);
+
+signals:
+    void countChanged();
+    void frameRateChanged();
+
+protected:
+    static Q_LOGGING_CATEGORY(lc, "dokit.gui.quickDashboard", QtInfoMsg);
+
+private:
+    /// A device on the dashboard.
+    struct Device {
+        QString key;                          ///< Device's PokitDeviceRegistry::key().
+        QString name;                         ///< Device's name.
+        QString status;                       ///< Connection status, until the first reading arrives.
+        QString mode;                         ///< Most recent reading's mode, or a null string if none yet.
+        float value { 0.0f };                 ///< Most recent reading's value.
+        QString battery;                      ///< Battery voltage and status, or a null string if not yet read.
+        SampleHistory history { historyDepth }; ///< Most recent readings, in seconds since the first reading.
+        quint64 shown { 0 };                  ///< Value of SampleHistory::totalAppended() when last rendered.
+        QElapsedTimer clock;                  ///< Time since the first reading.
+        QPointer<PlotItem> plot;              ///< Plot showing the device's history, if any.
+        QThread * thread { nullptr };         ///< Device's worker thread.
+        DeviceWorker * worker { nullptr };    ///< Device's worker, living on #thread.
+    };
+
+    QPointer<PokitDeviceRegistry> registry; ///< Registry of discovered devices, if any.
+    QVector<Device> devices;                ///< Devices shown, ordered by key, so rows never move between sessions.
+    QTimer * renderTimer;                   ///< Shared render tick, for all devices' plots.
+
+    int rowOf(const QString &key) const;
+    void scheduleRender();
+    void updateDevice(const QString &key, const QVector<int> &roles, const std::function<void(Device &)> &update);
+
+private slots:
+    void onDeviceUpdated(const PokitDeviceRegistry::Entry &entry);
+    void render();
+};
+
+#endif // DOKIT_GUI_QUICKDASHBOARD_H
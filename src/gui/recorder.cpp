@@ -0,0 +1,254 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "recorder.h"
+
+#include <QDateTime>
+#include <QTimer>
+#include <QtEndian>
+
+#include <cstring>
+
+/*!
+ * \class Recorder
+ *
+ * The Recorder class records live DSO captures, and multimeter readings, to disk, while they are being viewed.
+ *
+ * Recordings use the dokit CLI's Binary output format (see AbstractCommand::writeBinaryHeader()), so may be read by
+ * any of the same tools: one DsoSamples block per DSO capture, and one MeterReadings block per run of multimeter
+ * readings with the same mode and range. Blocks are only ever built up in memory on the GUI thread, which costs little
+ * more than a copy of each capture's samples. Complete blocks are then batched, up to #batchSize bytes (or for at most
+ * #flushInterval milliseconds), and queued for an OutputFileWriter, which writes them, in chunks of up to a megabyte,
+ * on its own thread. So a slow (or briefly unresponsive) disk never delays the live display. If the disk falls so far
+ * behind that the writer's queue fills, then batches are dropped, and counted, rather than ever blocking the GUI
+ * thread.
+ *
+ * Statistics, including the recording's size and any drops, are emitted (via statisticsChanged()) with each flush.
+ *
+ * Note, the LoggerArchive format is not supported, since it holds only data logger sessions, and rewrites its index
+ * with every append, so does not suit being streamed to.
+ */
+
+/*!
+ * Constructs a new recorder with \a parent. Call start() to begin recording.
+ */
+Recorder::Recorder(QObject * const parent) : QObject(parent), flushTimer(new QTimer(this))
+{
+    qRegisterMetaType<Recorder::Statistics>();
+    flushTimer->setInterval(flushInterval);
+    connect(flushTimer, &QTimer::timeout, this, &Recorder::flush);
+}
+
+/*!
+ * Destroys this recorder, first writing anything already recorded, as per stop().
+ */
+Recorder::~Recorder()
+{
+    stop();
+}
+
+/*!
+ * Begins recording to \a fileName, replacing any existing file. Returns \c true on success, otherwise \c false, in
+ * which case errorString() describes the failure.
+ */
+bool Recorder::start(const QString &fileName)
+{
+    stop();
+    writer = new OutputFileWriter(this);
+    if (!writer->open(fileName)) {
+        errorMessage = writer->errorString();
+        delete writer;
+        writer = nullptr;
+        return false;
+    }
+    batch.clear();
+    batch.reserve(batchSize + 64 * 1024); // Room for the last block to overrun the batch size, typically.
+    meterRecords.clear();
+    meterCount = 0;
+    stats = Statistics{};
+    startTime = QDateTime::currentMSecsSinceEpoch();
+    flushTimer->start();
+    qCDebug(lc).noquote() << tr("Recording to %1.").arg(fileName);
+    return true;
+}
+
+/*!
+ * Stops recording, if recording, after queueing anything already recorded. This waits for the writer thread to write
+ * all queued batches, which is typically well under a second, unless the disk is stalled.
+ */
+void Recorder::stop()
+{
+    if (!writer) {
+        return;
+    }
+    flush();
+    flushTimer->stop();
+    writer->close();
+    stats = statistics(); // Including the writer's final statistics, for after it is gone.
+    qCDebug(lc).noquote() << tr("Recorded %L1 bytes to %2.").arg(stats.writer.bytesWritten).arg(writer->fileName());
+    delete writer;
+    writer = nullptr;
+}
+
+/*!
+ * Returns \c true if recording.
+ */
+bool Recorder::isRecording() const
+{
+    return (writer != nullptr);
+}
+
+/*!
+ * Returns the name of the file being recorded to, or a null string if not recording.
+ */
+QString Recorder::fileName() const
+{
+    return (writer) ? writer->fileName() : QString();
+}
+
+/*!
+ * Returns a description of the last start() error, if any.
+ */
+QString Recorder::errorString() const
+{
+    return errorMessage;
+}
+
+/*!
+ * Returns the multimeter update interval recorded in MeterReadings block headers, in milliseconds, or 0 if unknown.
+ */
+quint32 Recorder::meterInterval() const
+{
+    return interval;
+}
+
+/*!
+ * Sets the multimeter update interval recorded in MeterReadings block headers to \a interval milliseconds. This only
+ * applies to subsequent blocks.
+ */
+void Recorder::setMeterInterval(const quint32 interval)
+{
+    this->interval = interval;
+}
+
+/*!
+ * Returns the current recording statistics, including the writer thread's, or the final statistics of the most recent
+ * recording, if not recording.
+ */
+Recorder::Statistics Recorder::statistics() const
+{
+    Statistics statistics = stats;
+    if (writer) {
+        statistics.duration = QDateTime::currentMSecsSinceEpoch() - startTime;
+        statistics.writer = writer->statistics();
+    }
+    return statistics;
+}
+
+/*!
+ * Records a complete DSO capture's \a metadata and \a samples, if recording.
+ */
+void Recorder::recordCapture(const DsoService::Metadata &metadata, const DsoService::Samples &samples)
+{
+    if (!writer) {
+        return;
+    }
+    endMeterBlock(); // Keep blocks in the order they were recorded.
+
+    // Captures only complete once all samples are fetched, so the capture began one sampling window ago.
+    const quint64 timestamp = (quint64)(QDateTime::currentMSecsSinceEpoch() - metadata.samplingWindow / 1000);
+    appendHeader(batch, Block::DsoSamples, (quint8)metadata.mode, metadata.range, metadata.scale,
+                 metadata.samplingRate, timestamp, (quint32)samples.size());
+#if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN)
+    // Samples are already little-endian in memory, so can be appended verbatim.
+    batch.append(reinterpret_cast<const char *>(samples.constData()), (int)(samples.size() * sizeof(qint16)));
+#else
+    for (const qint16 sample: samples) {
+        char record[sizeof(qint16)];
+        qToLittleEndian<qint16>(sample, record);
+        batch.append(record, sizeof(record));
+    }
+#endif
+    ++stats.captures;
+    if (batch.size() >= batchSize) {
+        flush();
+    }
+}
+
+/*!
+ * Records a multimeter \a reading, if recording.
+ */
+void Recorder::recordReading(const MultimeterService::Reading &reading)
+{
+    if (!writer) {
+        return;
+    }
+    if ((meterCount > 0) && ((reading.mode != meterMode) || (reading.range != meterRange))) {
+        endMeterBlock(); // Each block has a single mode and range.
+    }
+    if (meterCount == 0) {
+        meterMode = reading.mode;
+        meterRange = reading.range;
+        meterTimestamp = (quint64)QDateTime::currentMSecsSinceEpoch();
+    }
+    quint32 valueBits;
+    std::memcpy(&valueBits, &reading.value, sizeof(valueBits));
+    char record[8] { 0, 0, 0, 0, (char)reading.status, (char)reading.mode, (char)reading.range, 0 };
+    qToLittleEndian<quint32>(valueBits, record);
+    meterRecords.append(record, sizeof(record));
+    ++meterCount;
+    ++stats.readings;
+}
+
+/*!
+ * Queues everything recorded so far for the writer thread, and emits statisticsChanged(). Invoked automatically, at
+ * least every #flushInterval milliseconds, and whenever the current batch reaches #batchSize bytes.
+ */
+void Recorder::flush()
+{
+    if (!writer) {
+        return;
+    }
+    endMeterBlock();
+    if (!batch.isEmpty()) {
+        stats.bytesQueued += batch.size();
+        writer->write(batch); // Dropped (and counted), rather than blocking, if the writer has fallen too far behind.
+        batch = QByteArray(); // The writer's (implicitly shared) copy keeps the old buffer, so start a new one.
+        batch.reserve(batchSize + 64 * 1024);
+    }
+    emit statisticsChanged(statistics());
+}
+
+/*!
+ * Appends a Binary output block header to \a buffer, as per AbstractCommand::writeBinaryHeader(), for uncompressed
+ * \a block records.
+ */
+void Recorder::appendHeader(QByteArray &buffer, const Block block, const quint8 mode, const quint8 range,
+                            const float scale, const quint32 rate, const quint64 timestamp, const quint32 count)
+{
+    static_assert(sizeof(float) == sizeof(quint32), "Binary output requires 32-bit floats");
+    quint32 scaleBits;
+    std::memcpy(&scaleBits, &scale, sizeof(scaleBits));
+    char header[32] { 'D', 'O', 'K', 'B', 1, (char)block, (char)mode, (char)range };
+    qToLittleEndian<quint32>(scaleBits, header + 8);
+    qToLittleEndian<quint32>(rate, header + 12);
+    qToLittleEndian<quint64>(timestamp, header + 16);
+    qToLittleEndian<quint32>(count, header + 24);
+    qToLittleEndian<quint32>((block == Block::DsoSamples) ? (quint32)sizeof(qint16) : 8u, header + 28);
+    buffer.append(header, sizeof(header));
+}
+
+/*!
+ * Appends the multimeter block still being recorded (if any) to the current batch.
+ */
+void Recorder::endMeterBlock()
+{
+    if (meterCount == 0) {
+        return;
+    }
+    appendHeader(batch, Block::MeterReadings, (quint8)meterMode, meterRange, 1.0f, interval, meterTimestamp,
+                 meterCount);
+    batch.append(meterRecords);
+    meterRecords.clear();
+    meterCount = 0;
+}
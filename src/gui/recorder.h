@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_RECORDER_H
+#define DOKIT_GUI_RECORDER_H
+
+#include "../cli/outputfilewriter.h"
+
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+
+#include <QByteArray>
+#include <QLoggingCategory>
+#include <QObject>
+
+class QTimer;
+
+QTPOKIT_USE_NAMESPACE
+
+class Recorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Recording statistics, for showing the session's progress.
+    struct Statistics {
+        qint64 duration { 0 };    ///< Time since recording started, in milliseconds.
+        quint64 captures { 0 };   ///< Number of DSO captures recorded.
+        quint64 readings { 0 };   ///< Number of multimeter readings recorded.
+        quint64 bytesQueued { 0 }; ///< Number of bytes queued for the writer thread (written, dropped, or pending).
+        OutputFileWriter::Statistics writer; ///< Writer thread's statistics, including bytes written and dropped.
+    };
+
+    static constexpr qint64 batchSize { 256 * 1024 }; ///< Size to batch recorded blocks up to, before queuing them.
+    static constexpr int flushInterval { 1000 };      ///< Longest time to batch recorded blocks for, in milliseconds.
+
+    explicit Recorder(QObject * const parent = nullptr);
+    ~Recorder() override;
+
+    bool start(const QString &fileName);
+    void stop();
+    bool isRecording() const;
+    QString fileName() const;
+    QString errorString() const;
+
+    quint32 meterInterval() const;
+    void setMeterInterval(const quint32 interval);
+
+    Statistics statistics() const;
+
+public slots:
+    void recordCapture(const DsoService::Metadata &metadata, const DsoService::Samples &samples);
+    void recordReading(const MultimeterService::Reading &reading);
+    void flush();
+
+signals:
+    void statisticsChanged(const Recorder::Statistics &statistics);
+
+protected:
+    static Q_LOGGING_CATEGORY(lc, "dokit.gui.recorder", QtInfoMsg);
+
+private:
+    /// Kinds of record blocks, as per the dokit CLI's Binary output format.
+    enum class Block : quint8 {
+        DsoSamples    = 1, ///< Raw DSO samples, as little-endian int16 values.
+        MeterReadings = 3, ///< Packed multimeter readings.
+    };
+
+    OutputFileWriter * writer { nullptr }; ///< Writes batches to disk on its own thread, while recording.
+    QString errorMessage;       ///< Description of the last start() error, if any.
+    QTimer * flushTimer;        ///< Flushes the current batch at least every #flushInterval, while recording.
+    QByteArray batch;           ///< Complete blocks not yet queued for #writer.
+    QByteArray meterRecords;    ///< Records of the multimeter block still being recorded, if any.
+    quint32 meterCount { 0 };   ///< Number of records in #meterRecords.
+    quint64 meterTimestamp { 0 }; ///< Time of the first of #meterRecords, in milliseconds since the epoch.
+    MultimeterService::Mode meterMode { MultimeterService::Mode::Idle }; ///< Mode of all #meterRecords.
+    quint8 meterRange { 0 };    ///< Range of all #meterRecords.
+    quint32 interval { 0 };     ///< Multimeter update interval, in milliseconds, or 0 if unknown.
+    qint64 startTime { 0 };     ///< Time recording started, in milliseconds since the epoch.
+    Statistics stats;           ///< Recording statistics, other than the writer's own.
+
+    static void appendHeader(QByteArray &buffer, const Block block, const quint8 mode, const quint8 range,
+                             const float scale, const quint32 rate, const quint64 timestamp, const quint32 count);
+    void endMeterBlock();
+};
+
+Q_DECLARE_METATYPE(Recorder::Statistics)
+
+#endif // DOKIT_GUI_RECORDER_H
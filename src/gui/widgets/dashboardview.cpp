@@ -0,0 +1,244 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dashboardview.h"
+#include "devicetile.h"
+#include "../deviceworker.h"
+
+#include <qtpokit/decimation.h>
+#include <qtpokit/pokittrace.h>
+
+#include <algorithm>
+#include <utility>
+
+/*!
+ * \class DashboardView
+ *
+ * The DashboardView class shows a live DeviceTile for each of any number of devices, such as all devices checked in
+ * a PokitDevicesModel.
+ *
+ * Each device is connected to, and read by, its own DeviceWorker, on its own thread, so no one device's Bluetooth
+ * traffic (or parsing) delays the GUI, or any other device. Workers' readings are only recorded by their tiles as
+ * they arrive. Then all tiles are refreshed together, by one shared render tick, at a capped frameRate(), which only
+ * runs while readings are arriving: each tick is one pass over the tiles, decimating (see Decimation::minMax()) just
+ * the stale tiles' histories to their sparklines' widths. So a dashboard of many devices repaints no more often than
+ * one of a single device.
+ *
+ * Device names (and connection states) are shared with a PokitDeviceRegistry, which also keeps connected devices
+ * from being aged out.
+ */
+
+/*!
+ * Constructs a new, empty, dashboard with \a parent.
+ */
+DashboardView::DashboardView(QWidget * const parent) : QScrollArea(parent)
+{
+    auto const container = new QWidget;
+    grid = new QGridLayout(container);
+    grid->setAlignment(Qt::AlignTop|Qt::AlignLeft);
+    setWidget(container);
+    setWidgetResizable(true);
+
+    renderTimer = new QTimer(this);
+    renderTimer->setInterval(1000 / defaultFrameRate);
+    connect(renderTimer, &QTimer::timeout, this, &DashboardView::render);
+}
+
+/*!
+ * Destroys this dashboard, disconnecting from all devices, after waiting for their worker threads to finish.
+ */
+DashboardView::~DashboardView()
+{
+    for (const Device &device: std::as_const(devices)) {
+        device.thread->quit(); // The worker (and its device) are then deleted in the thread, as it finishes.
+        device.thread->wait();
+        delete device.thread;
+    }
+}
+
+/*!
+ * Sets the \a registry to look up devices in (by key), and to share device names and connection states with.
+ */
+void DashboardView::setDeviceRegistry(PokitDeviceRegistry * const registry)
+{
+    if (this->registry) {
+        disconnect(this->registry, nullptr, this, nullptr);
+    }
+    this->registry = registry;
+    if (registry) {
+        connect(registry, &PokitDeviceRegistry::deviceUpdated, this, &DashboardView::onDeviceUpdated);
+    }
+}
+
+/*!
+ * Returns the maximum number of times the tiles are refreshed per second.
+ */
+int DashboardView::frameRate() const
+{
+    return 1000 / std::max(renderTimer->interval(), 1);
+}
+
+/*!
+ * Sets the maximum number of times the tiles are refreshed per second to \a rate. The default is #defaultFrameRate.
+ */
+void DashboardView::setFrameRate(const int rate)
+{
+    renderTimer->setInterval(1000 / std::clamp(rate, 1, 1000));
+}
+
+/*!
+ * Returns the number of devices on this dashboard.
+ */
+qsizetype DashboardView::count() const
+{
+    return devices.size();
+}
+
+/*!
+ * Returns \c true if the device with PokitDeviceRegistry::key() \a key is on this dashboard.
+ */
+bool DashboardView::contains(const QString &key) const
+{
+    return devices.contains(key);
+}
+
+/*!
+ * Returns the PokitDeviceRegistry::key() of each device on this dashboard.
+ */
+QStringList DashboardView::keys() const
+{
+    return devices.keys();
+}
+
+/*!
+ * Adds a tile for the registered device with PokitDeviceRegistry::key() \a key, and starts its worker. Returns
+ * \c true if the device is (now, or already) on this dashboard, or \c false if no such device is registered.
+ */
+bool DashboardView::addDevice(const QString &key)
+{
+    if (devices.contains(key)) {
+        return true;
+    }
+    const std::optional<PokitDeviceRegistry::Entry> entry = (registry) ? registry->device(key) : std::nullopt;
+    if (!entry) {
+        qCWarning(lc).noquote() << tr("No registered device %1.").arg(key);
+        return false;
+    }
+    qCDebug(lc).noquote() << tr("Adding %1 (%2).").arg(entry->name, key);
+
+    Device device;
+    device.tile = new DeviceTile(entry->name);
+    device.tile->setToolTip(key);
+    device.thread = new QThread;
+    device.thread->setObjectName(entry->name);
+    device.worker = new DeviceWorker(entry->info, entry->product);
+    device.worker->moveToThread(device.thread);
+    connect(device.thread, &QThread::started, device.worker, &DeviceWorker::start);
+    connect(device.thread, &QThread::finished, device.worker, &QObject::deleteLater);
+
+    // Worker signals are queued to the GUI thread, where the tile is the context, so end with the tile.
+    DeviceTile * const tile = device.tile;
+    connect(device.worker, &DeviceWorker::connected, tile, [this, tile, key]() {
+        tile->setStatus(tr("Connected"));
+        if (registry) {
+            registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Connected);
+        }
+    });
+    connect(device.worker, &DeviceWorker::disconnected, tile, [this, tile, key]() {
+        tile->setStatus(tr("Disconnected"));
+        if (registry) {
+            registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Disconnected);
+        }
+    });
+    connect(device.worker, &DeviceWorker::readingRead, tile, [this, tile](const float value, const QString &mode) {
+        tile->addReading(value, mode);
+        scheduleRender();
+    });
+    connect(device.worker, &DeviceWorker::batteryRead, tile, &DeviceTile::setBattery);
+
+    registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Connecting);
+    devices.insert(key, device);
+    layoutTiles();
+    device.thread->start();
+    emit countChanged(devices.size());
+    return true;
+}
+
+/*!
+ * Removes the tile for the device with PokitDeviceRegistry::key() \a key, if any, disconnecting from the device.
+ */
+void DashboardView::removeDevice(const QString &key)
+{
+    const auto iter = devices.constFind(key);
+    if (iter == devices.constEnd()) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Removing %1.").arg(key);
+    const Device device = *iter;
+    devices.erase(iter);
+    connect(device.thread, &QThread::finished, device.thread, &QObject::deleteLater);
+    device.thread->quit(); // The worker (and its device) are then deleted in the thread, as it finishes.
+    delete device.tile;
+    if (registry) {
+        registry->setConnectionState(key, PokitDeviceRegistry::ConnectionState::Disconnected);
+    }
+    layoutTiles();
+    emit countChanged(devices.size());
+}
+
+/*!
+ * Lays out all tiles in a grid of #columns columns, ordered by key, so tiles never move about between sessions.
+ */
+void DashboardView::layoutTiles()
+{
+    QStringList keys = devices.keys();
+    keys.sort();
+    for (const Device &device: std::as_const(devices)) {
+        grid->removeWidget(device.tile);
+    }
+    for (qsizetype index = 0; index < keys.size(); ++index) {
+        grid->addWidget(devices.value(keys.at(index)).tile, (int)(index / columns), (int)(index % columns));
+    }
+}
+
+/*!
+ * Starts the shared render tick, if not already running.
+ */
+void DashboardView::scheduleRender()
+{
+    if (!renderTimer->isActive()) {
+        renderTimer->start();
+    }
+}
+
+/*!
+ * Updates the name of the tile (if any) for \a entry's device.
+ */
+void DashboardView::onDeviceUpdated(const PokitDeviceRegistry::Entry &entry)
+{
+    const auto iter = devices.constFind(PokitDeviceRegistry::key(entry.info));
+    if (iter != devices.constEnd()) {
+        iter->tile->setName(entry.name);
+    }
+}
+
+/*!
+ * Refreshes every tile with readings recorded since the last refresh, in a single pass, or stops the render tick if
+ * there are none.
+ */
+void DashboardView::render()
+{
+    bool rendered = false;
+    for (const Device &device: std::as_const(devices)) {
+        if (device.tile->isStale()) {
+            device.tile->showFrame(
+                Decimation::minMax(device.tile->history().snapshot(), device.tile->sparklineWidth()));
+            rendered = true;
+        }
+    }
+    if (rendered) {
+        QTPOKIT_TRACE_FRAME_MARK("dashboard");
+    } else {
+        renderTimer->stop(); // Nothing new, so idle until more readings arrive.
+    }
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_DASHBOARDVIEW_H
+#define DOKIT_GUI_DASHBOARDVIEW_H
+
+#include <qtpokit/pokitdeviceregistry.h>
+
+#include <QGridLayout>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QScrollArea>
+#include <QThread>
+#include <QTimer>
+
+class DeviceTile;
+class DeviceWorker;
+
+QTPOKIT_USE_NAMESPACE
+
+class DashboardView : public QScrollArea
+{
+    Q_OBJECT
+
+public:
+    static constexpr int defaultFrameRate { 10 }; ///< Default maximum number of frames rendered per second.
+    static constexpr int columns { 4 };           ///< Number of tiles per row.
+
+    explicit DashboardView(QWidget * const parent = nullptr);
+    ~DashboardView() override;
+
+    void setDeviceRegistry(PokitDeviceRegistry * const registry);
+
+    int frameRate() const;
+    void setFrameRate(const int rate);
+
+    qsizetype count() const;
+    bool contains(const QString &key) const;
+    QStringList keys() const;
+
+public slots:
+    bool addDevice(const QString &key);
+    void removeDevice(const QString &key);
+
+signals:
+    void countChanged(const qsizetype count);
+
+protected:
+    static Q_LOGGING_CATEGORY(lc, "dokit.gui.dashboard", QtInfoMsg);
+
+private:
+    /// A device on the dashboard.
+    struct Device {
+        DeviceTile * tile;     ///< Device's tile.
+        QThread * thread;      ///< Device's worker thread.
+        DeviceWorker * worker; ///< Device's worker, living on #thread.
+    };
+
+    QPointer<PokitDeviceRegistry> registry; ///< Registry of discovered devices, if any.
+    QHash<QString, Device> devices;         ///< Devices shown, by PokitDeviceRegistry::key().
+    QGridLayout * grid;                     ///< Layout of all tiles.
+    QTimer * renderTimer;                   ///< Shared render tick, for all tiles.
+
+    void layoutTiles();
+    void scheduleRender();
+
+private slots:
+    void onDeviceUpdated(const PokitDeviceRegistry::Entry &entry);
+    void render();
+};
+
+#endif // DOKIT_GUI_DASHBOARDVIEW_H
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "devicetile.h"
+#include "sparkline.h"
+
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+/*!
+ * \class DeviceTile
+ *
+ * The DeviceTile class shows one device's current reading, recent readings (as a Sparkline), and battery status, on
+ * a DashboardView.
+ *
+ * Like LiveChartView, readings are only recorded as they arrive (into a bounded SampleHistory). The tile is then only
+ * redrawn when its dashboard's shared render tick calls showFrame(), so a tile's cost is per frame, not per reading.
+ */
+
+/*!
+ * Constructs a new tile for the device called \a name, with \a parent.
+ */
+DeviceTile::DeviceTile(const QString &name, QWidget * const parent) : QFrame(parent)
+{
+    setFrameShape(QFrame::StyledPanel);
+    nameLabel = new QLabel(name);
+    QFont font = nameLabel->font();
+    font.setBold(true);
+    nameLabel->setFont(font);
+    readingLabel = new QLabel(tr("Connecting"));
+    font.setPointSizeF(font.pointSizeF() * 1.5);
+    readingLabel->setFont(font);
+    batteryLabel = new QLabel;
+    sparkline = new Sparkline;
+
+    auto const layout = new QVBoxLayout(this);
+    layout->addWidget(nameLabel);
+    layout->addWidget(readingLabel);
+    layout->addWidget(sparkline);
+    layout->addWidget(batteryLabel);
+}
+
+/*!
+ * Sets the tile's device \a name.
+ */
+void DeviceTile::setName(const QString &name)
+{
+    if (nameLabel->text() != name) {
+        nameLabel->setText(name);
+    }
+}
+
+/*!
+ * Shows \a status (such as "Disconnected") in place of the current reading, until the next reading is shown.
+ */
+void DeviceTile::setStatus(const QString &status)
+{
+    readingLabel->setText(status);
+}
+
+/*!
+ * Shows the device's battery \a voltage, and \a status.
+ */
+void DeviceTile::setBattery(const float voltage, const QString &status)
+{
+    batteryLabel->setText(tr("Battery: %1 V (%2)").arg(voltage, 0, 'f', 2).arg(status));
+}
+
+/*!
+ * Records a reading of \a value, in \a mode, to be shown on the next frame.
+ */
+void DeviceTile::addReading(const float value, const QString &mode)
+{
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    readings.append(QPointF((qreal)clock.nsecsElapsed() / 1e9, (qreal)value));
+    latestValue = value;
+    latestMode = mode;
+}
+
+/*!
+ * Returns the tile's recent readings.
+ */
+const SampleHistory &DeviceTile::history() const
+{
+    return readings;
+}
+
+/*!
+ * Returns \c true if readings have been recorded since the last frame was shown.
+ */
+bool DeviceTile::isStale() const
+{
+    return readings.totalAppended() != readingsShown;
+}
+
+/*!
+ * Returns the maximum number of buckets to decimate readings to, being the sparkline's width in pixels.
+ */
+qsizetype DeviceTile::sparklineWidth() const
+{
+    return std::max(sparkline->width(), 16);
+}
+
+/*!
+ * Shows the most recent reading, and \a points (being the decimated history()) as the sparkline.
+ */
+void DeviceTile::showFrame(const QVector<QPointF> &points)
+{
+    readingsShown = readings.totalAppended();
+    readingLabel->setText(tr("%1 (%2)").arg(latestValue).arg(latestMode));
+    sparkline->setPoints(points);
+}
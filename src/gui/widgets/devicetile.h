@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_DEVICETILE_H
+#define DOKIT_GUI_DEVICETILE_H
+
+#include "../models/samplehistory.h"
+
+#include <QElapsedTimer>
+#include <QFrame>
+#include <QLabel>
+
+class Sparkline;
+
+class DeviceTile : public QFrame
+{
+    Q_OBJECT
+
+public:
+    static constexpr qsizetype historyDepth { 240 }; ///< Number of (most recent) readings kept for the sparkline.
+
+    explicit DeviceTile(const QString &name, QWidget * const parent = nullptr);
+
+    void setName(const QString &name);
+    void setStatus(const QString &status);
+    void setBattery(const float voltage, const QString &status);
+    void addReading(const float value, const QString &mode);
+
+    const SampleHistory &history() const;
+    bool isStale() const;
+    qsizetype sparklineWidth() const;
+    void showFrame(const QVector<QPointF> &points);
+
+private:
+    QLabel * nameLabel;
+    QLabel * readingLabel;
+    QLabel * batteryLabel;
+    Sparkline * sparkline;
+
+    SampleHistory readings { historyDepth }; ///< Most recent readings, in seconds since the first reading.
+    quint64 readingsShown { 0 };              ///< Value of SampleHistory::totalAppended() when last shown.
+    QElapsedTimer clock;                      ///< Time since the first reading.
+    float latestValue { 0.0f };               ///< Most recent reading's value.
+    QString latestMode;                       ///< Most recent reading's mode.
+};
+
+#endif // DOKIT_GUI_DEVICETILE_H
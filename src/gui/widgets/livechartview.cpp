@@ -0,0 +1,362 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "livechartview.h"
+#include "../../stringliterals_p.h"
+
+#include <qtpokit/decimation.h>
+#include <qtpokit/dsocapture.h>
+#include <qtpokit/pokittrace.h>
+
+#include <QChart>
+
+#include <algorithm>
+
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class LiveChartView
+ *
+ * The LiveChartView class charts live DSO captures, and multimeter readings.
+ *
+ * Values are never charted as they arrive. Instead, they are only recorded (which is cheap): the most recent DSO
+ * capture replaces the previous one, while meter readings are appended to a bounded SampleHistory, which overwrites
+ * the oldest readings once meterWindow() readings are held, so memory stays flat over long sessions. The chart is then
+ * refreshed from a snapshot of those values by a timer, at a fixed frameRate(), only running while values are
+ * arriving. Each refresh first reduces the values to at most a couple of points per horizontal pixel (see
+ * Decimation::minMax()), and then swaps them into the chart's one series via QXYSeries::replace(), which redraws the
+ * series just once, rather than once per point, as appending would. The series is also drawn via OpenGL, where
+ * available.
+ *
+ * So the cost of charting scales with the chart's width, and frame rate, rather than the rate (or size) of the
+ * values, so even continuous 8192 sample DSO captures chart smoothly.
+ *
+ * If a PlotPipeline is set (see setPipeline()), then the reduction is done on the pipeline's worker thread instead,
+ * and the chart updated once each frame is ready, so the GUI thread only ever swaps points into the series.
+ *
+ * In XY mode (see setXyDsoCaptures()), the most recent captures of two DSOs are instead charted against each other,
+ * as a point cloud, on a separate (also OpenGL) scatter series. Each capture is timestamped as it arrives, on a clock
+ * shared by both devices, and then paired, and resampled onto a common time base, by PlotPipeline::pairXy() (on the
+ * pipeline's worker thread, if set). Since captures are only timestamped on arrival, alignment is only as good as the
+ * two devices' transfer latencies are similar.
+ */
+
+/*!
+ * Constructs a new live chart view with \a parent.
+ */
+LiveChartView::LiveChartView(QWidget * const parent) : QChartView(parent)
+{
+    QChart * const chart = new QChart;
+    chart->legend()->hide();
+    axisX = new QValueAxis;
+    axisX->setTitleText(tr("Time (s)"));
+    chart->addAxis(axisX, Qt::AlignBottom);
+    axisY = new QValueAxis;
+    chart->addAxis(axisY, Qt::AlignLeft);
+    series = new QLineSeries;
+    series->setUseOpenGL(true); // Falls back to software rendering if OpenGL is not available.
+    chart->addSeries(series);
+    series->attachAxis(axisX);
+    series->attachAxis(axisY);
+    scatter = new QScatterSeries;
+    scatter->setUseOpenGL(true);
+    scatter->setMarkerSize(2.0);
+    scatter->setBorderColor(Qt::transparent); // Unbordered, so dense clouds do not blur into outlines.
+    chart->addSeries(scatter);
+    scatter->attachAxis(axisX);
+    scatter->attachAxis(axisY);
+    scatter->hide(); // Until charting an XY source.
+    setChart(chart);
+
+    renderTimer = new QTimer(this);
+    renderTimer->setInterval(1000 / defaultFrameRate);
+    connect(renderTimer, &QTimer::timeout, this, &LiveChartView::render);
+}
+
+/*!
+ * Returns the maximum number of times the chart is refreshed per second.
+ */
+int LiveChartView::frameRate() const
+{
+    return 1000 / std::max(renderTimer->interval(), 1);
+}
+
+/*!
+ * Sets the maximum number of times the chart is refreshed per second to \a rate. The default is #defaultFrameRate.
+ */
+void LiveChartView::setFrameRate(const int rate)
+{
+    renderTimer->setInterval(1000 / std::clamp(rate, 1, 1000));
+}
+
+/*!
+ * Returns the number of (most recent) multimeter readings charted.
+ */
+qsizetype LiveChartView::meterWindow() const
+{
+    return meterHistory.depth();
+}
+
+/*!
+ * Sets the number of (most recent) multimeter readings charted to \a readings. The default is
+ * SampleHistory::defaultDepth.
+ */
+void LiveChartView::setMeterWindow(const qsizetype readings)
+{
+    meterHistory.setDepth(std::max<qsizetype>(readings, 2));
+}
+
+/*!
+ * Charts each of \a capture's complete captures, in place of any other source.
+ */
+void LiveChartView::setDsoCapture(const DsoCapture * const capture)
+{
+    disconnect(sourceConnection);
+    disconnect(ySourceConnection);
+    sourceConnection = connect(capture, &DsoCapture::captureComplete, this,
+        [this](const DsoService::Metadata &metadata, const DsoService::Samples &samples) {
+            setDsoSamples(metadata, samples);
+        });
+}
+
+/*!
+ * Charts \a service's readings, in place of any other source.
+ */
+void LiveChartView::setMultimeterService(const MultimeterService * const service)
+{
+    disconnect(sourceConnection);
+    disconnect(ySourceConnection);
+    sourceConnection = connect(service, &MultimeterService::readingRead, this, &LiveChartView::addMeterReading);
+}
+
+/*!
+ * Charts each of \a x's complete captures against \a y's, as an XY point cloud, in place of any other source.
+ */
+void LiveChartView::setXyDsoCaptures(const DsoCapture * const x, const DsoCapture * const y)
+{
+    disconnect(sourceConnection);
+    disconnect(ySourceConnection);
+    sourceConnection = connect(x, &DsoCapture::captureComplete, this,
+        [this](const DsoService::Metadata &metadata, const DsoService::Samples &samples) {
+            setXyDsoSamples(false, metadata, samples);
+        });
+    ySourceConnection = connect(y, &DsoCapture::captureComplete, this,
+        [this](const DsoService::Metadata &metadata, const DsoService::Samples &samples) {
+            setXyDsoSamples(true, metadata, samples);
+        });
+}
+
+/*!
+ * Returns the pipeline values are processed on, or \c nullptr if values are processed inline, on the GUI thread.
+ */
+PlotPipeline * LiveChartView::pipeline() const
+{
+    return plotPipeline;
+}
+
+/*!
+ * Sets \a pipeline to process values on, or \c nullptr to process values inline, on the GUI thread.
+ */
+void LiveChartView::setPipeline(PlotPipeline * const pipeline)
+{
+    disconnect(pipelineConnection);
+    plotPipeline = pipeline;
+    if (pipeline) {
+        pipelineConnection = connect(pipeline, &PlotPipeline::frameReady, this, &LiveChartView::showFrame);
+    }
+}
+
+/*!
+ * Clears the chart.
+ */
+void LiveChartView::clear()
+{
+    setSource(Source::None, QString());
+    series->clear();
+    scatter->clear();
+}
+
+/*!
+ * Records DSO \a samples (and their \a metadata), to be charted, in place of any previous samples, on the next
+ * refresh.
+ */
+void LiveChartView::setDsoSamples(const DsoService::Metadata &metadata, const DsoService::Samples &samples)
+{
+    setSource(Source::Dso, DsoService::toString(metadata.mode));
+    dsoMetadata = metadata;
+    dsoSamples = samples; // Implicitly shared, so no copy.
+    pending = true;
+    if (!renderTimer->isActive()) {
+        renderTimer->start();
+    }
+}
+
+/*!
+ * Records multimeter \a reading, to be charted on the next refresh.
+ */
+void LiveChartView::addMeterReading(const MultimeterService::Reading &reading)
+{
+    setSource(Source::Meter, MultimeterService::toString(reading.mode));
+    if (!meterClock.isValid()) {
+        meterClock.start();
+    }
+    meterHistory.append(QPointF((qreal)meterClock.nsecsElapsed() / 1e9, (qreal)reading.value));
+    if (!renderTimer->isActive()) {
+        renderTimer->start();
+    }
+}
+
+/*!
+ * Records DSO \a samples (and their \a metadata), to be charted on the Y axis if \a isY, otherwise the X axis, against
+ * the other axis's most recent samples, on the next refresh.
+ *
+ * The capture is timestamped as it arrives, as having begun one sampling window ago, for pairing with the other
+ * axis's capture (see PlotPipeline::pairXy()).
+ */
+void LiveChartView::setXyDsoSamples(const bool isY, const DsoService::Metadata &metadata,
+                                    const DsoService::Samples &samples)
+{
+    const QString title = DsoService::toString(metadata.mode);
+    setSource(Source::Xy, (isY) ? title : axisY->titleText());
+    if (!isY) {
+        axisX->setTitleText(title);
+    }
+    if (!xyClock.isValid()) {
+        xyClock.start();
+    }
+    xyCaptures[isY ? 1 : 0] = { metadata, samples, (xyClock.nsecsElapsed() / 1000) - (qint64)metadata.samplingWindow };
+    pending = true;
+    if (!renderTimer->isActive()) {
+        renderTimer->start();
+    }
+}
+
+/*!
+ * Sets the current source of charted values to \a newSource, titled \a title, clearing all previous values if the
+ * source has changed.
+ */
+void LiveChartView::setSource(const Source newSource, const QString &title)
+{
+    axisY->setTitleText(title);
+    if (source == newSource) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Charting %1.").arg((title.isEmpty()) ? tr("nothing") : title);
+    source = newSource;
+    series->setVisible(newSource != Source::Xy);
+    scatter->setVisible(newSource == Source::Xy);
+    if (newSource != Source::Xy) {
+        axisX->setTitleText(tr("Time (s)"));
+    }
+    sourceSubmitted = false; // Discard frames for any previous source, still in the pipeline.
+    pending = false;
+    dsoSamples.clear();
+    meterHistory.clear();
+    meterRendered = 0;
+    meterClock.invalidate();
+    xyCaptures[0] = xyCaptures[1] = PlotPipeline::TimedCapture{};
+    xyClock.invalidate();
+}
+
+/*!
+ * Returns the maximum number of buckets to reduce values to, for charting, being the chart's width in pixels.
+ */
+qsizetype LiveChartView::pointBudget() const
+{
+    return std::max<qsizetype>((qsizetype)chart()->plotArea().width(), 256);
+}
+
+/*!
+ * Refreshes the chart with any values recorded since the last refresh, or stops the refresh timer if there are none.
+ */
+void LiveChartView::render()
+{
+    const bool meterPending = (meterHistory.totalAppended() != meterRendered);
+    if ((!std::exchange(pending, false)) && (!meterPending)) {
+        renderTimer->stop(); // Nothing new, so idle until more values arrive.
+        return;
+    }
+    meterRendered = meterHistory.totalAppended();
+
+    if (plotPipeline) {
+        quint64 sequence = 0;
+        switch (source) {
+        case Source::None:
+            showPoints({ });
+            return;
+        case Source::Dso:
+            sequence = plotPipeline->processCapture(dsoMetadata, dsoSamples, pointBudget());
+            break;
+        case Source::Meter:
+            sequence = plotPipeline->processHistory(meterHistory.snapshot(), pointBudget());
+            break;
+        case Source::Xy:
+            if ((xyCaptures[0].samples.isEmpty()) || (xyCaptures[1].samples.isEmpty())) {
+                return; // Nothing to pair (yet).
+            }
+            sequence = plotPipeline->processXyCaptures(xyCaptures[0], xyCaptures[1], pointBudget());
+            break;
+        }
+        if (!std::exchange(sourceSubmitted, true)) {
+            firstSequence = sequence;
+        }
+        return;
+    }
+
+    QVector<QPointF> points;
+    switch (source) {
+    case Source::None:
+        break;
+    case Source::Dso:
+        points = Decimation::minMax(dsoMetadata, dsoSamples, pointBudget());
+        break;
+    case Source::Meter:
+        points = Decimation::minMax(meterHistory.snapshot(), pointBudget());
+        break;
+    case Source::Xy:
+        points = PlotPipeline::pairXy(xyCaptures[0], xyCaptures[1], pointBudget());
+        if (points.isEmpty()) {
+            return; // Nothing paired, so keep showing the previous cloud.
+        }
+        break;
+    }
+    showPoints(points);
+}
+
+/*!
+ * Charts \a frame's points, as processed by the pipeline, unless the source has changed since it was submitted.
+ */
+void LiveChartView::showFrame(const PlotPipeline::Frame &frame)
+{
+    if ((sourceSubmitted) && (frame.sequence >= firstSequence)
+        && ((source != Source::Xy) || (!frame.points.isEmpty()))) { // Keep the previous cloud if nothing paired.
+        showPoints(frame.points);
+    }
+}
+
+/*!
+ * Swaps \a points into the chart's (current source's) series, and rescales the axes to fit.
+ */
+void LiveChartView::showPoints(const QVector<QPointF> &points)
+{
+    QTPOKIT_TRACE_FRAME_MARK("liveChart");
+    ((source == Source::Xy) ? static_cast<QXYSeries *>(scatter) : series)->replace(points);
+    if (points.isEmpty()) {
+        return;
+    }
+
+    const auto [min, max] = std::minmax_element(points.cbegin(), points.cend(),
+        [](const QPointF &lhs, const QPointF &rhs) { return lhs.y() < rhs.y(); });
+    const qreal margin = (max->y() > min->y()) ? (max->y() - min->y()) * 0.05 : 1.0;
+    axisY->setRange(min->y() - margin, max->y() + margin);
+    if (source != Source::Xy) {
+        axisX->setRange(points.first().x(), std::max(points.last().x(), points.first().x() + 1e-6));
+        return;
+    }
+
+    // XY points are not in X order, so find the X extent too.
+    const auto [left, right] = std::minmax_element(points.cbegin(), points.cend(),
+        [](const QPointF &lhs, const QPointF &rhs) { return lhs.x() < rhs.x(); });
+    const qreal xMargin = (right->x() > left->x()) ? (right->x() - left->x()) * 0.05 : 1.0;
+    axisX->setRange(left->x() - xMargin, right->x() + xMargin);
+}
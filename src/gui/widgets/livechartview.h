@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_LIVECHARTVIEW_H
+#define DOKIT_GUI_LIVECHARTVIEW_H
+
+#include "../models/samplehistory.h"
+#include "../plotpipeline.h"
+
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+
+#include <QChartView>
+#include <QElapsedTimer>
+#include <QLineSeries>
+#include <QLoggingCategory>
+#include <QScatterSeries>
+#include <QTimer>
+#include <QValueAxis>
+
+/// As of Qt6, Qt Charts no longer has a custom QtCharts namespace.
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+using namespace QtCharts;
+#endif
+
+QTPOKIT_BEGIN_NAMESPACE
+class DsoCapture;
+QTPOKIT_END_NAMESPACE
+
+QTPOKIT_USE_NAMESPACE
+
+class LiveChartView : public QChartView
+{
+    Q_OBJECT
+
+public:
+    static constexpr int defaultFrameRate { 30 };    ///< Default maximum number of chart refreshes per second.
+
+    explicit LiveChartView(QWidget * const parent = nullptr);
+
+    int frameRate() const;
+    void setFrameRate(const int rate);
+
+    qsizetype meterWindow() const;
+    void setMeterWindow(const qsizetype readings);
+
+    void setDsoCapture(const DsoCapture * const capture);
+    void setMultimeterService(const MultimeterService * const service);
+    void setXyDsoCaptures(const DsoCapture * const x, const DsoCapture * const y);
+
+    PlotPipeline * pipeline() const;
+    void setPipeline(PlotPipeline * const pipeline);
+
+public slots:
+    void clear();
+    void setDsoSamples(const DsoService::Metadata &metadata, const DsoService::Samples &samples);
+    void addMeterReading(const MultimeterService::Reading &reading);
+    void setXyDsoSamples(const bool isY, const DsoService::Metadata &metadata, const DsoService::Samples &samples);
+    void showFrame(const PlotPipeline::Frame &frame);
+
+protected:
+    static Q_LOGGING_CATEGORY(lc, "dokit.gui.liveChart", QtInfoMsg);
+
+private:
+    /// Sources of charted values.
+    enum class Source : quint8 {
+        None,  ///< Nothing charted (yet).
+        Dso,   ///< DSO captures, each replacing the last.
+        Meter, ///< Multimeter readings, scrolling.
+        Xy,    ///< Pairs of DSO captures, from two devices, as an XY point cloud.
+    };
+
+    QLineSeries * series;     ///< OpenGL accelerated series of charted points, for all but XY sources.
+    QScatterSeries * scatter; ///< OpenGL accelerated series of charted points, for XY sources.
+    QValueAxis * axisX;       ///< Time axis, in seconds, or the X capture's value axis, for XY sources.
+    QValueAxis * axisY;       ///< Value axis, in the source's units.
+    QTimer * renderTimer;     ///< Frame rate limiting timer, only running while new values are pending.
+    QMetaObject::Connection sourceConnection; ///< Connection to the current source's values signal, if any.
+    QMetaObject::Connection ySourceConnection; ///< Connection to the Y capture's values signal, for XY sources.
+    PlotPipeline * plotPipeline { nullptr };  ///< Pipeline to process values on, or \c nullptr to process inline.
+    QMetaObject::Connection pipelineConnection; ///< Connection to the pipeline's frameReady signal, if any.
+    quint64 firstSequence { 0 };     ///< Sequence number of the current source's first pipeline job.
+    bool sourceSubmitted { false };  ///< Whether the current source has submitted any pipeline jobs yet.
+
+    Source source { Source::None };    ///< Current source of charted values.
+    bool pending { false };            ///< Whether a DSO capture has arrived since the chart was last refreshed.
+    DsoService::Metadata dsoMetadata;  ///< Most recent DSO capture's metadata.
+    DsoService::Samples dsoSamples;    ///< Most recent DSO capture's (raw) samples.
+    SampleHistory meterHistory;        ///< Most recent meter readings, as (seconds, value) points.
+    quint64 meterRendered { 0 };       ///< Value of meterHistory.totalAppended() when the chart was last refreshed.
+    QElapsedTimer meterClock;          ///< Time since the first meter reading charted.
+    PlotPipeline::TimedCapture xyCaptures[2]; ///< Most recent X, and Y, DSO captures, for XY sources.
+    QElapsedTimer xyClock;             ///< Clock the XY captures' start times are measured on.
+
+    void setSource(const Source newSource, const QString &title);
+    qsizetype pointBudget() const;
+    void showPoints(const QVector<QPointF> &points);
+
+private slots:
+    void render();
+};
+
+#endif // DOKIT_GUI_LIVECHARTVIEW_H
@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "persistenceview.h"
+
+#include <qtpokit/dsocapture.h>
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/*!
+ * \class PersistenceView
+ *
+ * The PersistenceView class draws live DSO captures as a persistence (intensity-graded) display, via a
+ * PersistenceBuffer.
+ *
+ * Rather than drawing each capture (as LiveChartView does, for the newest only), every capture is accumulated into a
+ * fixed-size intensity buffer as it arrives, which is a single pass over the capture's samples. The buffer is then
+ * decayed, converted to an image, and blitted (scaled to the widget), once per frame, by a timer at a fixed
+ * frameRate(), which only runs while captures are arriving, or still fading. So the cost of drawing is independent of
+ * the rate of captures, while how often the trace takes each path is shown by its intensity: rare glitches stand out,
+ * dimly, rather than flickering past in a single frame.
+ *
+ * Traces fade to half intensity every halfLife() milliseconds. The buffer is cleared whenever the captures' mode,
+ * range, scale, sampling window, or size, changes, since their raw samples are then no longer comparable.
+ */
+
+/*!
+ * Constructs a new, empty, persistence view with \a parent.
+ */
+PersistenceView::PersistenceView(QWidget * const parent) : QWidget(parent), renderTimer(new QTimer(this))
+{
+    setAttribute(Qt::WA_OpaquePaintEvent); // Every pixel is painted, so Qt need not erase the background first.
+    renderTimer->setInterval(1000 / defaultFrameRate);
+    connect(renderTimer, &QTimer::timeout, this, &PersistenceView::render);
+}
+
+/*!
+ * Returns the maximum number of times the view is repainted per second.
+ */
+int PersistenceView::frameRate() const
+{
+    return 1000 / std::max(renderTimer->interval(), 1);
+}
+
+/*!
+ * Sets the maximum number of times the view is repainted per second to \a rate. The default is #defaultFrameRate.
+ */
+void PersistenceView::setFrameRate(const int rate)
+{
+    renderTimer->setInterval(1000 / std::clamp(rate, 1, 1000));
+}
+
+/*!
+ * Returns the time for traces to fade to half intensity, in milliseconds, or 0 if traces never fade.
+ */
+int PersistenceView::halfLife() const
+{
+    return fadeHalfLife;
+}
+
+/*!
+ * Sets the time for traces to fade to half intensity to \a milliseconds, or 0 for traces to never fade (that is,
+ * infinite persistence). The default is #defaultHalfLife.
+ */
+void PersistenceView::setHalfLife(const int milliseconds)
+{
+    fadeHalfLife = std::max(milliseconds, 0);
+}
+
+/*!
+ * Accumulates each of \a capture's complete captures, in place of any other capture.
+ */
+void PersistenceView::setDsoCapture(const DsoCapture * const capture)
+{
+    disconnect(sourceConnection);
+    clear();
+    sourceConnection = connect(capture, &DsoCapture::captureComplete, this,
+        [this](const DsoService::Metadata &metadata, const DsoService::Samples &samples) {
+            addCapture(metadata, samples);
+        });
+}
+
+QSize PersistenceView::sizeHint() const
+{
+    return QSize(buffer.width() / 2, buffer.height() / 2);
+}
+
+/*!
+ * Clears all accumulated captures.
+ */
+void PersistenceView::clear()
+{
+    buffer.clear();
+    metadata.reset();
+    sampleCount = 0;
+    pending = false;
+    image = QImage();
+    update();
+}
+
+/*!
+ * Accumulates DSO \a samples (and their \a metadata), to be shown on the next repaint.
+ */
+void PersistenceView::addCapture(const DsoService::Metadata &metadata, const DsoService::Samples &samples)
+{
+    if ((this->metadata) && ((metadata.mode != this->metadata->mode) || (metadata.range != this->metadata->range)
+        || (metadata.scale != this->metadata->scale) || (metadata.samplingWindow != this->metadata->samplingWindow)
+        || (samples.size() != sampleCount))) {
+        qCDebug(lc).noquote() << tr("Capture settings changed, so clearing %Ln capture/s.", nullptr,
+                                    (int)buffer.captures());
+        buffer.clear();
+    }
+    this->metadata = metadata;
+    sampleCount = samples.size();
+    buffer.accumulate(samples);
+    pending = true;
+    if (!renderTimer->isActive()) {
+        decayClock.start();
+        renderTimer->start();
+    }
+}
+
+/*!
+ * Decays the buffer by the time since it last decayed, and schedules a repaint with its new image, or stops the
+ * render timer if there are no new captures, and every trace has faded.
+ */
+void PersistenceView::render()
+{
+    const qint64 elapsed = decayClock.restart();
+    if (fadeHalfLife > 0) {
+        buffer.decay((float)std::exp2(-(double)elapsed / fadeHalfLife));
+    }
+    if ((!std::exchange(pending, false)) && ((fadeHalfLife == 0) || (buffer.peak() <= 0.0f))) {
+        renderTimer->stop(); // Nothing new, and nothing left to fade, so idle until more captures arrive.
+    }
+    image = buffer.toImage();
+    update();
+}
+
+void PersistenceView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+    QPainter painter(this);
+    if (image.isNull()) {
+        painter.fillRect(rect(), Qt::black);
+        return;
+    }
+    painter.drawImage(rect(), image); // Scaled, without smoothing, so a single blit.
+    if (metadata) {
+        painter.setPen(Qt::white);
+        painter.drawText(rect().adjusted(4, 4, -4, -4), Qt::AlignLeft | Qt::AlignTop,
+            tr("%1, %Ln capture/s", nullptr, (int)buffer.captures()).arg(DsoService::toString(metadata->mode)));
+    }
+}
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_PERSISTENCEVIEW_H
+#define DOKIT_GUI_PERSISTENCEVIEW_H
+
+#include "../models/persistencebuffer.h"
+
+#include <qtpokit/dsoservice.h>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLoggingCategory>
+#include <QTimer>
+#include <QWidget>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+class DsoCapture;
+QTPOKIT_END_NAMESPACE
+
+QTPOKIT_USE_NAMESPACE
+
+class PersistenceView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int defaultFrameRate { 30 };   ///< Default maximum number of repaints per second.
+    static constexpr int defaultHalfLife { 500 };   ///< Default time for traces to fade to half intensity, in ms.
+
+    explicit PersistenceView(QWidget * const parent = nullptr);
+
+    int frameRate() const;
+    void setFrameRate(const int rate);
+
+    int halfLife() const;
+    void setHalfLife(const int milliseconds);
+
+    void setDsoCapture(const DsoCapture * const capture);
+
+    QSize sizeHint() const override;
+
+public slots:
+    void clear();
+    void addCapture(const DsoService::Metadata &metadata, const DsoService::Samples &samples);
+
+protected:
+    static Q_LOGGING_CATEGORY(lc, "dokit.gui.persistenceView", QtInfoMsg);
+
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    PersistenceBuffer buffer;       ///< Accumulated captures.
+    QImage image;                   ///< Buffer's image, as of the last render().
+    QTimer * renderTimer;           ///< Frame rate limiting timer, only running while captures are arriving, or fading.
+    QElapsedTimer decayClock;       ///< Time since the buffer last decayed.
+    int fadeHalfLife { defaultHalfLife }; ///< Time for traces to fade to half intensity, in ms, or 0 for infinite.
+    QMetaObject::Connection sourceConnection; ///< Connection to the current capture's signal, if any.
+    std::optional<DsoService::Metadata> metadata; ///< Most recent capture's metadata, if any.
+    qsizetype sampleCount { 0 };    ///< Most recent capture's number of samples.
+    bool pending { false };         ///< Whether a capture has arrived since the last render().
+
+private slots:
+    void render();
+};
+
+#endif // DOKIT_GUI_PERSISTENCEVIEW_H
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "sparkline.h"
+
+#include <QPainter>
+#include <QPolygonF>
+
+#include <algorithm>
+
+/*!
+ * \class Sparkline
+ *
+ * The Sparkline class draws a small, axis-less, line chart of points, scaled to fill the widget.
+ *
+ * Unlike QChartView, there is no scene, series or axis to maintain, so a repaint is one polyline, making sparklines
+ * cheap enough to show dozens at once. Points are expected to already be decimated to (about) the widget's width.
+ */
+
+/*!
+ * Constructs a new, empty, sparkline with \a parent.
+ */
+Sparkline::Sparkline(QWidget * const parent) : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+/*!
+ * Returns the points drawn.
+ */
+const QVector<QPointF> &Sparkline::points() const
+{
+    return values;
+}
+
+/*!
+ * Sets the \a points to draw, and schedules a repaint.
+ */
+void Sparkline::setPoints(const QVector<QPointF> &points)
+{
+    values = points; // Implicitly shared, so no copy.
+    update();
+}
+
+QSize Sparkline::sizeHint() const
+{
+    return QSize(160, 40);
+}
+
+void Sparkline::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+    if (values.size() < 2) {
+        return;
+    }
+    const auto [min, max] = std::minmax_element(values.cbegin(), values.cend(),
+        [](const QPointF &lhs, const QPointF &rhs) { return lhs.y() < rhs.y(); });
+    const qreal minX = values.first().x();
+    const qreal rangeX = std::max(values.last().x() - minX, 1e-6);
+    const qreal minY = min->y();
+    const qreal rangeY = std::max(max->y() - minY, 1e-6);
+    const QRectF area = QRectF(rect()).adjusted(1, 1, -1, -1);
+
+    QPolygonF polyline;
+    polyline.reserve(values.size());
+    for (const QPointF &point: values) {
+        polyline.append(QPointF(area.left() + ((point.x() - minX) / rangeX) * area.width(),
+                                area.bottom() - ((point.y() - minY) / rangeY) * area.height()));
+    }
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(palette().color(QPalette::Highlight), 1.5));
+    painter.drawPolyline(polyline);
+}
@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_GUI_SPARKLINE_H
+#define DOKIT_GUI_SPARKLINE_H
+
+#include <QPointF>
+#include <QVector>
+#include <QWidget>
+
+class Sparkline : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit Sparkline(QWidget * const parent = nullptr);
+
+    const QVector<QPointF> &points() const;
+    void setPoints(const QVector<QPointF> &points);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QVector<QPointF> values; ///< Points to draw, already decimated to this widget's width.
+};
+
+#endif // DOKIT_GUI_SPARKLINE_H
@@ -12,16 +12,37 @@
 #include "../stringliterals_p.h"
 
 #include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokittrace.h>
 
 #include <QLowEnergyController>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
 
 QTPOKIT_BEGIN_NAMESPACE
 DOKIT_USE_STRINGLITERALS
 
+namespace {
+thread_local quint64 threadParseFailures { 0 }; ///< Parse failures counted on this thread (see countParseFailure()).
+}
+
 /*!
  * \class AbstractPokitService
  *
  * The AbstractPokitService class provides a common base for Pokit services classes.
+ *
+ * All GATT operations (characteristic reads and writes, and notification enables and disables) are queued per
+ * service, and issued one at a time, each once the previous operation has completed (or failed). Duplicate reads of
+ * the same characteristic, queued while an earlier read is still waiting to be issued, are coalesced into that earlier
+ * read. The completion of each request is reported via requestFinished, with the ID returned by lastRequestId().
+ *
+ * Services may be hosted on a dedicated BLE worker thread, by moving them (usually along with their PokitDevice, via
+ * `QObject::moveToThread`) to that thread. Signals then reach consumers on other threads via queued connections,
+ * and GATT operations invoked from other threads are queued to be issued on the service's own thread. In that case,
+ * the `*Async()` variants (such as readCharacteristicsAsync()) are preferred, since their futures identify exactly
+ * when each operation has completed, while lastRequestId() is only meaningful on the service's own thread.
  */
 
 /*!
@@ -32,7 +53,7 @@ AbstractPokitService::AbstractPokitService(
     AbstractPokitServicePrivate * const d, QObject * const parent)
     : QObject(parent), d_ptr(d)
 {
-
+    d->setParent(this); // So moveToThread() moves the private implementation (and its service object) too.
 }
 /// \endcond
 
@@ -56,6 +77,21 @@ AbstractPokitService::~AbstractPokitService()
  * characteristic is successfully read.
  */
 
+/*!
+ * Asynchronous variant of readCharacteristics().
+ *
+ * Returns a future that finishes once all of the characteristic reads have completed. The future's result is \c true
+ * if all of the reads were queued, and succeeded, otherwise \c false.
+ *
+ * Since requests are issued in order, further requests (such as notification enables) can be queued immediately,
+ * without waiting for the returned future to finish.
+ */
+QFuture<bool> AbstractPokitService::readCharacteristicsAsync()
+{
+    Q_D(AbstractPokitService);
+    return d->whenFinished([this]{ return readCharacteristics(); });
+}
+
 /*!
  * Returns `true` if autodiscovery of services and service details is enabled, `false` otherwise.
  *
@@ -82,6 +118,39 @@ void AbstractPokitService::setAutoDiscover(const bool discover)
     d->autoDiscover = discover;
 }
 
+/*!
+ * Returns `true` if service details autodiscovery skips reading the service's characteristic values, `false`
+ * otherwise.
+ *
+ * \see setSkipValueDiscovery
+ */
+bool AbstractPokitService::skipValueDiscovery() const
+{
+    Q_D(const AbstractPokitService);
+    return d->skipValueDiscovery;
+}
+
+/*!
+ * If \a skip is \c true, service details autodiscovery will discover the service's characteristics and descriptors,
+ * but not read their values (ie `QLowEnergyService::SkipValueDiscovery`).
+ *
+ * This can make discovery considerably faster, but means that functions that return current characteristic values,
+ * such as DeviceInfoService::serialNumber() and StatusService::status(), will not return valid values until the
+ * corresponding characteristics have been read explicitly (such as via readCharacteristics()). Applications that
+ * already know the service's layout (for example, from a previous connection to the same device) may choose to skip
+ * value discovery when their first action is to write settings, or enable notifications, anyway.
+ *
+ * This must be set before the internal service object is created to have any effect, and (since it requires Qt 6.2
+ * or later) is ignored by earlier Qt versions.
+ *
+ * \see skipValueDiscovery
+ */
+void AbstractPokitService::setSkipValueDiscovery(const bool skip)
+{
+    Q_D(AbstractPokitService);
+    d->skipValueDiscovery = skip;
+}
+
 /*!
  * Returns the Pokit product this service is attached to.
  *
@@ -135,6 +204,181 @@ const QLowEnergyService * AbstractPokitService::service() const
     return d->service;
 }
 
+/*!
+ * Returns the time at which the most recent characteristic value (read, or notified) was received, before it was
+ * parsed, or -1 if no value has been received yet.
+ *
+ * The time is in nanoseconds, according to a steady (ie monotonic) clock, so is suitable for measuring latencies, and
+ * for aligning the streams of multiple services and devices within a single process, but is not related to the wall
+ * clock. Since parsed values are emitted synchronously, slots connected to signals such as
+ * MultimeterService::readingRead and DsoService::samplesRead may call this function to get the receive time of the
+ * value being emitted. Alternatively, see valueReceived.
+ */
+qint64 AbstractPokitService::receiveTimestamp() const
+{
+    Q_D(const AbstractPokitService);
+    return d->receiveTimestamp;
+}
+
+/*!
+ * Returns the ATT MTU negotiated for this service's BLE connection, in bytes, or -1 if unknown.
+ *
+ * Each notification carries at most 3 bytes less than the MTU, so this determines the number of notifications (and
+ * in turn, connection events) required to transfer DSO and data logger samples. The MTU is only available with Qt 6,
+ * and only once connected.
+ *
+ * \see PokitDevice::mtu()
+ */
+int AbstractPokitService::mtu() const
+{
+    Q_D(const AbstractPokitService);
+    return d->mtu();
+}
+
+/*!
+ * Returns the ID of the GATT request most recently queued by this service, or 0 if no requests have been queued yet.
+ *
+ * Call this function immediately after a successful request, such as MultimeterService::setSettings(), to get the ID
+ * that requestFinished will report that request's completion with. If the request was a read coalesced into an
+ * earlier, still pending, read of the same characteristic, then this is the earlier read's ID.
+ */
+quint64 AbstractPokitService::lastRequestId() const
+{
+    Q_D(const AbstractPokitService);
+    return d->lastRequestId;
+}
+
+/*!
+ * Returns the number of GATT requests queued, but not yet completed, including any request currently in flight.
+ */
+int AbstractPokitService::pendingRequestCount() const
+{
+    Q_D(const AbstractPokitService);
+    return d->requests.size() + ((d->inFlight) ? 1 : 0);
+}
+
+/*!
+ * Returns a snapshot of this service's runtime statistics, such as the number of notifications, and bytes, received,
+ * and the distribution of intervals between notifications.
+ *
+ * Statistics are accumulated from construction, including across reconnections, and may be fetched from any thread.
+ *
+ * \see PokitDevice::statistics()
+ */
+AbstractPokitService::Statistics AbstractPokitService::statistics() const
+{
+    Q_D(const AbstractPokitService);
+    Statistics statistics;
+    {
+        const QMutexLocker scopedLock(&d->statisticsMutex);
+        statistics = d->statistics;
+    }
+    if (d->memoryStream) {
+        statistics.memoryBytes = d->memoryStream->bytes();
+    }
+    return statistics;
+}
+
+/*!
+ * Returns this service's notification batching, as set by setBatching().
+ *
+ * \see setBatching
+ */
+AbstractPokitService::Batching AbstractPokitService::batching() const
+{
+    Q_D(const AbstractPokitService);
+    return d->batching;
+}
+
+/*!
+ * Sets this service's notification \a batching, after emitting any batch already in progress.
+ *
+ * Each notification is normally emitted as soon as it is parsed, via the derived class' own signal, such as
+ * DsoService::samplesRead(). For high-rate streams, that means one signal emission (and so, for queued connections,
+ * one event) per notification. With batching enabled (that is, with either Batching::maxCount greater than 1, or a
+ * non-zero Batching::maxLatency), services that support it (currently DsoService, DataLoggerService and
+ * MultimeterService) also gather the parsed values of consecutive notifications, and emit them together, via a
+ * single batch signal, such as DsoService::samplesBatchRead(). A batch is emitted once it holds Batching::maxCount
+ * notifications' values, once its first value has been held for Batching::maxLatency microseconds (to within the
+ * resolution of Qt's timers), or at the end of a sample transfer, whichever comes first.
+ *
+ * The per-notification signals are still emitted, so consumers may connect to whichever suits them; consumers on other
+ * threads would typically connect to just the batch signals, to pay the cost of dispatch once per batch, instead of
+ * once per notification.
+ *
+ * \see batching
+ * \see flushBatch
+ */
+void AbstractPokitService::setBatching(const Batching &batching)
+{
+    Q_D(AbstractPokitService);
+    d->flushBatch();
+    d->batching = batching;
+}
+
+/*!
+ * Emits the batch in progress, if any, immediately, such as before stopping a stream of notifications.
+ *
+ * \see setBatching
+ */
+void AbstractPokitService::flushBatch()
+{
+    Q_D(AbstractPokitService);
+    d->flushBatch();
+}
+
+/*!
+ * Subscribes to \a characteristic notifications, on behalf of one of (possibly) many consumers sharing this service,
+ * such as GUI tiles, daemon clients, and StatusMonitor instances.
+ *
+ * Subscribers are reference-counted, per characteristic, so the device's client characteristic configuration
+ * descriptor (CCCD) is only written when the first subscriber subscribes, and not again until the last subscriber
+ * unsubscribes. Those CCCD writes are also deferred to the next event loop iteration, so that any subscribe and
+ * unsubscribe calls in between (such as a consumer being replaced by another) are batched into at most one write
+ * per characteristic, or none at all, if the notifications are already in the wanted state.
+ *
+ * Each successful subscribe() must be matched by an unsubscribe(). Note, enabling or disabling notifications directly
+ * (such as via MultimeterService::enableReadingNotifications()) bypasses the subscriber counts altogether.
+ *
+ * Returns \c true if the subscription was counted, or \c false if \a characteristic has no CCCD. If called from a
+ * thread other than this object's, the subscription is counted on this object's thread instead.
+ *
+ * \see unsubscribe
+ * \see subscriberCount
+ */
+bool AbstractPokitService::subscribe(const QBluetoothUuid &characteristic)
+{
+    Q_D(AbstractPokitService);
+    return d->subscribe(characteristic);
+}
+
+/*!
+ * Unsubscribes one subscriber from \a characteristic notifications, and disables the notifications if that was the
+ * last subscriber (once any pending CCCD writes are batched, as per subscribe()).
+ *
+ * Returns \c true if a subscription was released, or \c false if \a characteristic had no subscribers.
+ *
+ * \see subscribe
+ * \see subscriberCount
+ */
+bool AbstractPokitService::unsubscribe(const QBluetoothUuid &characteristic)
+{
+    Q_D(AbstractPokitService);
+    return d->unsubscribe(characteristic);
+}
+
+/*!
+ * Returns the number of subscribers to \a characteristic notifications.
+ *
+ * \see subscribe
+ * \see unsubscribe
+ */
+int AbstractPokitService::subscriberCount(const QBluetoothUuid &characteristic) const
+{
+    Q_D(const AbstractPokitService);
+    return d->subscriberCounts.value(characteristic);
+}
+
 /*!
  * \fn void AbstractPokitService::serviceDetailsDiscovered()
  *
@@ -151,6 +395,29 @@ const QLowEnergyService * AbstractPokitService::service() const
  *  This signal is emitted whenever an error occurs on the underlying QLowEnergyService.
  */
 
+/*!
+ * \fn void AbstractPokitService::valueReceived(const QBluetoothUuid &characteristic, const qint64 timestamp)
+ *
+ * This signal is emitted when a value (read, or notified) has been received for \a characteristic, at \a timestamp
+ * (see receiveTimestamp()), immediately before the value is parsed, and emitted via the derived class' own signal.
+ */
+
+/*!
+ * \fn void AbstractPokitService::requestFinished(const quint64 id, const bool success)
+ *
+ * This signal is emitted when the GATT request identified by \a id (see lastRequestId()) has completed. \a success is
+ * \c false if the request failed, or could not be issued at all.
+ */
+
+/*!
+ * \fn void AbstractPokitService::resumed(const qint64 gapStart, const qint64 gapEnd)
+ *
+ * This signal is emitted when this service has resumed its notifications and settings, after its device reconnected
+ * (see PokitDevice::setReconnectPolicy). It marks a gap in this service's stream of values, from \a gapStart (the
+ * receiveTimestamp() of the last value received before the disconnection, or -1 if none) until \a gapEnd (the time
+ * of resumption), both according to the same steady clock as receiveTimestamp().
+ */
+
 /*!
  * \cond internal
  * \class AbstractPokitServicePrivate
@@ -187,6 +454,38 @@ AbstractPokitServicePrivate::AbstractPokitServicePrivate(const QBluetoothUuid &s
     }
 }
 
+/*!
+ * Destroys this AbstractPokitServicePrivate object, finishing any outstanding futures with \c false results.
+ */
+AbstractPokitServicePrivate::~AbstractPokitServicePrivate()
+{
+    for (Waiter &waiter: waiters) {
+        finishFuture(waiter.promise, false);
+    }
+}
+
+/*!
+ * Queues \a function to be invoked on this object's thread, and returns \c true, if called from any other thread.
+ * Otherwise, returns \c false, and the caller should continue on this (the current) thread.
+ *
+ * This allows services to be hosted on a dedicated BLE worker thread (see PokitDevice), while still being controlled
+ * from other threads, since all GATT requests are then issued from the thread that owns the internal service object.
+ */
+bool AbstractPokitServicePrivate::invokeOnServiceThread(const std::function<void()> &function)
+{
+    if (QThread::currentThread() == thread()) {
+        return false;
+    }
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 10, 0))
+    Q_UNUSED(function)
+    qCWarning(lc).noquote() << tr("Cross-thread service access requires Qt 5.10 or later.");
+    return false;
+    #else
+    QMetaObject::invokeMethod(this, function, Qt::QueuedConnection);
+    return true;
+    #endif
+}
+
 /*!
  * Creates an internal service object from the internal controller.
  *
@@ -215,15 +514,31 @@ bool AbstractPokitServicePrivate::createServiceObject()
         return false;
     }
     qCDebug(lc).noquote() << tr("Service object created for %1 device:").arg(toString(*this->pokitProduct)) << service;
+    {
+        const QMutexLocker scopedLock(&statisticsMutex);
+        statistics.service = serviceUuid;
+    }
 
     connect(service, &QLowEnergyService::stateChanged,
             this, &AbstractPokitServicePrivate::stateChanged);
     connect(service, &QLowEnergyService::characteristicRead,
-            this, &AbstractPokitServicePrivate::characteristicRead);
+            this, &AbstractPokitServicePrivate::valueRead);
     connect(service, &QLowEnergyService::characteristicWritten,
             this, &AbstractPokitServicePrivate::characteristicWritten);
     connect(service, &QLowEnergyService::characteristicChanged,
-            this, &AbstractPokitServicePrivate::characteristicChanged);
+            this, &AbstractPokitServicePrivate::notified);
+
+    // Complete queued requests only after the (virtual) handlers above have processed the results.
+    connect(service, &QLowEnergyService::characteristicRead, this,
+        [this](const QLowEnergyCharacteristic &characteristic, const QByteArray &value){
+            completeRequest(Request::Type::ReadCharacteristic, characteristic.uuid());
+            Q_UNUSED(value)
+        });
+    connect(service, &QLowEnergyService::characteristicWritten, this,
+        [this](const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue){
+            completeRequest(Request::Type::WriteCharacteristic, characteristic.uuid());
+            Q_UNUSED(newValue)
+        });
 
     connect(service, &QLowEnergyService::descriptorRead, this,
         [](const QLowEnergyDescriptor &descriptor, const QByteArray &value){
@@ -233,9 +548,10 @@ bool AbstractPokitServicePrivate::createServiceObject()
         });
 
     connect(service, &QLowEnergyService::descriptorWritten, this,
-        [](const QLowEnergyDescriptor &descriptor, const QByteArray &newValue){
+        [this](const QLowEnergyDescriptor &descriptor, const QByteArray &newValue){
             qCDebug(lc).noquote() << tr(R"(Descriptor "%1" (%2) written.)")
                 .arg(descriptor.name(), descriptor.uuid().toString());
+            completeRequest(Request::Type::WriteDescriptor, QBluetoothUuid());
             Q_UNUSED(newValue)
         });
 
@@ -248,7 +564,12 @@ bool AbstractPokitServicePrivate::createServiceObject()
         this, &AbstractPokitServicePrivate::errorOccurred);
 
     if (autoDiscover) {
+        #if (QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)) // DiscoveryMode added in Qt 6.2.
+        service->discoverDetails((skipValueDiscovery) ? QLowEnergyService::SkipValueDiscovery
+                                                      : QLowEnergyService::FullDiscovery);
+        #else
         service->discoverDetails();
+        #endif
     }
     return true;
 }
@@ -263,11 +584,18 @@ bool AbstractPokitServicePrivate::createServiceObject()
  * except that it performs some sanity checks, such as checking the service object pointer has been
  * assigned first, and also logs failures in a consistent manner.
  *
+ * Once the service has been discovered, characteristics are returned from #characteristics (as resolved by
+ * resolveCharacteristics()), so the common case is a single hash lookup, with no checks, or logging, at all.
+ *
  * \param uuid
  * \return
  */
 QLowEnergyCharacteristic AbstractPokitServicePrivate::getCharacteristic(const QBluetoothUuid &uuid) const
 {
+    if (const auto cached = characteristics.constFind(uuid); cached != characteristics.constEnd()) {
+        return cached->characteristic;
+    }
+
     if (!service) {
         qCDebug(lc).noquote() << tr(R"(Characteristic %1 "%2" requested before service assigned.)")
             .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
@@ -298,6 +626,72 @@ QLowEnergyCharacteristic AbstractPokitServicePrivate::getCharacteristic(const QB
     return QLowEnergyCharacteristic();
 }
 
+/*!
+ * Get the client characteristic configuration descriptor (CCCD) of the \a uuid characteristic, as required to enable,
+ * or disable, its notifications. Like getCharacteristic(), this is served from #characteristics once the service has
+ * been discovered, and otherwise falls back to looking the descriptor up in #service.
+ *
+ * Returns an invalid descriptor if the characteristic is not available, or has no CCCD.
+ */
+QLowEnergyDescriptor AbstractPokitServicePrivate::getClientConfiguration(const QBluetoothUuid &uuid) const
+{
+    if (const auto cached = characteristics.constFind(uuid); cached != characteristics.constEnd()) {
+        return cached->clientConfiguration;
+    }
+    return getCharacteristic(uuid).descriptor(QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration);
+}
+
+/*!
+ * Resolves all of #service's characteristics, and their client characteristic configuration descriptors, into
+ * #characteristics, so that getCharacteristic() and getClientConfiguration() need not look them up (in #service) on
+ * every request.
+ *
+ * This is called once the service reaches the [Remote]ServiceDiscovered state, since the objects (and their handles)
+ * are only valid for the lifetime of the discovered service. The cache is cleared on any other state change.
+ */
+void AbstractPokitServicePrivate::resolveCharacteristics()
+{
+    characteristics.clear();
+    if (!service) {
+        return;
+    }
+    const QList<QLowEnergyCharacteristic> serviceCharacteristics = service->characteristics();
+    characteristics.reserve(serviceCharacteristics.size());
+    for (const QLowEnergyCharacteristic &characteristic: serviceCharacteristics) {
+        characteristics.insert(characteristic.uuid(), { characteristic,
+            characteristic.descriptor(QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration) });
+    }
+    qCDebug(lc).noquote() << tr("Cached %Ln characteristic/s.", nullptr, characteristics.size());
+}
+
+/*!
+ * Returns \c true if the \a uuid characteristic is available, either in #service, or via #requestHandler.
+ */
+bool AbstractPokitServicePrivate::hasCharacteristic(const QBluetoothUuid &uuid) const
+{
+    return (requestHandler) || (getCharacteristic(uuid).isValid());
+}
+
+/*!
+ * Returns \c true if the \a uuid characteristic has a client characteristic configuration descriptor (as required to
+ * enable, or disable, its notifications), either in #service, or via #requestHandler.
+ */
+bool AbstractPokitServicePrivate::hasClientConfiguration(const QBluetoothUuid &uuid) const
+{
+    if (requestHandler) {
+        return true;
+    }
+    if (!getCharacteristic(uuid).isValid()) {
+        return false;
+    }
+    if (!getClientConfiguration(uuid).isValid()) {
+        qCWarning(lc).noquote() << tr(R"(Characteristic %1 "%2" has no client configuration descriptor.)")
+            .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+        return false;
+    }
+    return true;
+}
+
 /*!
  * Read the \a uuid characteristic.
  *
@@ -306,19 +700,50 @@ QLowEnergyCharacteristic AbstractPokitServicePrivate::getCharacteristic(const QB
  * virtual function to handle the read value.
  *
  * Returns \c true if the characteristic read request was successfully queued, \c false otherwise.
+ * If called from a thread other than this object's, the request is queued via invokeOnServiceThread() instead.
  *
  * \see AbstractPokitService::readCharacteristics()
  * \see AbstractPokitServicePrivate::characteristicRead()
  */
 bool AbstractPokitServicePrivate::readCharacteristic(const QBluetoothUuid &uuid)
 {
-    const QLowEnergyCharacteristic characteristic = getCharacteristic(uuid);
-    if (!characteristic.isValid()) {
+    if (invokeOnServiceThread([this, uuid]() { readCharacteristic(uuid); })) {
+        return true;
+    }
+    if (!hasCharacteristic(uuid)) {
         return false;
     }
     qCDebug(lc).noquote() << tr(R"(Reading characteristic %1 "%2".)")
         .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
-    service->readCharacteristic(characteristic);
+    queueRequest(Request::Type::ReadCharacteristic, uuid);
+    return true;
+}
+
+/*!
+ * Write \a value to the \a uuid characteristic.
+ *
+ * If successful, the `QLowEnergyService::characteristicWritten` signal will be emitted by the internal service object.
+ * For convenience, derived classes should implement the characteristicWritten() virtual function to handle the write.
+ *
+ * If \a uuid is one of the #resumableCharacteristics, then \a value is also recorded, to be written again by resume().
+ *
+ * Returns \c true if the characteristic write request was successfully queued, \c false otherwise.
+ * If called from a thread other than this object's, the request is queued via invokeOnServiceThread() instead.
+ */
+bool AbstractPokitServicePrivate::writeCharacteristic(const QBluetoothUuid &uuid, const QByteArray &value)
+{
+    if (invokeOnServiceThread([this, uuid, value]() { writeCharacteristic(uuid, value); })) {
+        return true;
+    }
+    if (!hasCharacteristic(uuid)) {
+        return false;
+    }
+    qCDebug(lc).noquote() << tr(R"(Writing characteristic %1 "%2".)")
+        .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+    queueRequest(Request::Type::WriteCharacteristic, uuid, value);
+    if (resumableCharacteristics.contains(uuid)) {
+        resumeValues.insert(uuid, value);
+    }
     return true;
 }
 
@@ -326,34 +751,30 @@ bool AbstractPokitServicePrivate::readCharacteristic(const QBluetoothUuid &uuid)
  * Enables client (Pokit device) side notification for characteristic \a uuid.
  *
  * Returns \c true if the notification enable request was successfully queued, \c false otherwise.
+ * If called from a thread other than this object's, the request is queued via invokeOnServiceThread() instead.
  *
  * \see AbstractPokitServicePrivate::characteristicChanged
  * \see AbstractPokitServicePrivate::disableCharacteristicNotificatons
  */
 bool AbstractPokitServicePrivate::enableCharacteristicNotificatons(const QBluetoothUuid &uuid)
 {
+    if (invokeOnServiceThread([this, uuid]() { enableCharacteristicNotificatons(uuid); })) {
+        return true;
+    }
     qCDebug(lc).noquote() << tr(R"(Enabling CCCD for characteristic %1 "%2".)")
         .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
-    QLowEnergyCharacteristic characteristic = getCharacteristic(uuid);
-    if (!characteristic.isValid()) {
-        return false;
-    }
-
-    QLowEnergyDescriptor descriptor = characteristic.descriptor(
-        QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration); // 0x2902
-    if (!descriptor.isValid()) {
-        qCWarning(lc).noquote() << tr(R"(Characteristic %1 "%2" has no client configuration descriptor.)")
-            .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+    if (!hasClientConfiguration(uuid)) {
         return false;
     }
 
-    service->writeDescriptor(descriptor,
+    queueRequest(Request::Type::WriteDescriptor, uuid,
         #if (QT_VERSION >= QT_VERSION_CHECK(6, 2, 0))
         QLowEnergyCharacteristic::CCCDEnableNotification
         #else
         QByteArray::fromHex("0100") // See Qt6's QLowEnergyCharacteristic::CCCDEnableNotification.
         #endif
     );
+    notifyingCharacteristics.insert(uuid);
     return true;
 }
 
@@ -361,84 +782,535 @@ bool AbstractPokitServicePrivate::enableCharacteristicNotificatons(const QBlueto
  * Disables client (Pokit device) side notification for characteristic \a uuid.
  *
  * Returns \c true if the notification disable request was successfully queued, \c false otherwise.
+ * If called from a thread other than this object's, the request is queued via invokeOnServiceThread() instead.
  *
  * \see AbstractPokitServicePrivate::characteristicChanged
  * \see AbstractPokitServicePrivate::enableCharacteristicNotificatons
  */
 bool AbstractPokitServicePrivate::disableCharacteristicNotificatons(const QBluetoothUuid &uuid)
 {
+    if (invokeOnServiceThread([this, uuid]() { disableCharacteristicNotificatons(uuid); })) {
+        return true;
+    }
     qCDebug(lc).noquote() << tr(R"(Disabling CCCD for characteristic %1 "%2".)")
         .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
-    QLowEnergyCharacteristic characteristic = getCharacteristic(uuid);
-    if (!characteristic.isValid()) {
-        return false;
-    }
-
-    QLowEnergyDescriptor descriptor = characteristic.descriptor(
-        QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration); // 0x2902
-    if (!descriptor.isValid()) {
-        qCWarning(lc).noquote() << tr(R"(Characteristic %1 "%2" has no client configuration descriptor.)")
-            .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+    if (!hasClientConfiguration(uuid)) {
         return false;
     }
 
-    service->writeDescriptor(descriptor,
+    queueRequest(Request::Type::WriteDescriptor, uuid,
         #if (QT_VERSION >= QT_VERSION_CHECK(6, 2, 0))
         QLowEnergyCharacteristic::CCCDDisable
         #else
         QByteArray::fromHex("0000") // See Qt6's QLowEnergyCharacteristic::CCCDDisable.
         #endif
     );
+    notifyingCharacteristics.remove(uuid);
     return true;
 }
 
 /*!
- * Returns `false` if \a data is smaller than \a minSize, otherwise returns \a failOnMax if \a data
- * is bigger than \a maxSize, otherwise returns `true`.
+ * Counts a new subscriber to characteristic \a uuid's notifications, and schedules flushSubscriptions(), if this is
+ * the first subscriber.
  *
- * A warning is logged if either \a minSize or \a maxSize is violated, regardless of the returned
- * value; ie this funcion can be used to simply warn if \a data is too big, or it can be used to
- * failed (return `false`) in that case.
+ * Returns \c true if the subscriber was counted, \c false otherwise.
+ * If called from a thread other than this object's, the subscriber is counted via invokeOnServiceThread() instead.
+ *
+ * \see AbstractPokitService::subscribe
  */
-bool AbstractPokitServicePrivate::checkSize(const QString &label, const QByteArray &data,
-                                            const int minSize, const int maxSize,
-                                            const bool failOnMax)
+bool AbstractPokitServicePrivate::subscribe(const QBluetoothUuid &uuid)
 {
-    if (data.size() < minSize) {
-        qCWarning(lc).noquote() << tr("%1 requires %n byte/s, but only %2 present: %3", nullptr, minSize)
-            .arg(label).arg(data.size()).arg(toHexString(data));
+    if (invokeOnServiceThread([this, uuid]() { subscribe(uuid); })) {
+        return true;
+    }
+    if (!hasClientConfiguration(uuid)) {
         return false;
     }
-    if ((maxSize >= 0) && (data.size() > maxSize)) {
-        qCWarning(lc).noquote() << tr("%1 has %n extraneous byte/s: %2", nullptr, data.size()-maxSize)
-            .arg(label, toHexString(data.mid(maxSize)));
-        return (!failOnMax);
+    const int count = ++subscriberCounts[uuid];
+    qCDebug(lc).noquote() << tr(R"(Characteristic %1 "%2" has %Ln subscriber/s.)", nullptr, count)
+        .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+    if (count == 1) {
+        scheduleSubscriptions(uuid);
     }
     return true;
 }
 
 /*!
- * Returns up to \a maxSize bytes of \a data as a human readable hexadecimal string. If \a data
- * exceeds \a maxSize, then \a data is elided in the middle. For example:
+ * Releases one subscriber to characteristic \a uuid's notifications, and schedules flushSubscriptions(), if that was
+ * the last subscriber.
  *
- * ```
- * toHex(QBytArray("\x1\x2\x3\x4\x5\x6", 4); // "0x01,02,...,05,06"
- * ```
+ * Returns \c true if a subscriber was released, or \c false if \a uuid had no subscribers.
+ * If called from a thread other than this object's, the subscriber is released via invokeOnServiceThread() instead.
+ *
+ * \see AbstractPokitService::unsubscribe
  */
-QString AbstractPokitServicePrivate::toHexString(const QByteArray &data, const int maxSize)
+bool AbstractPokitServicePrivate::unsubscribe(const QBluetoothUuid &uuid)
 {
-    return (data.size() <= maxSize)
-        ? QString::fromLatin1("0x%1").arg(QLatin1String(data.toHex(',')))
-        : QString::fromLatin1("0x%1,...,%2").arg(
-            QLatin1String(data.left(maxSize/2-1).toHex(',')),
-            QLatin1String(data.right(maxSize/2-1).toHex(',')));
-}
-
+    if (invokeOnServiceThread([this, uuid]() { unsubscribe(uuid); })) {
+        return true;
+    }
+    const auto iter = subscriberCounts.find(uuid);
+    if (iter == subscriberCounts.end()) {
+        qCWarning(lc).noquote() << tr(R"(Characteristic %1 "%2" has no subscribers to unsubscribe.)")
+            .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+        return false;
+    }
+    const int count = --iter.value();
+    qCDebug(lc).noquote() << tr(R"(Characteristic %1 "%2" has %Ln subscriber/s.)", nullptr, count)
+        .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+    if (count == 0) {
+        subscriberCounts.erase(iter);
+        scheduleSubscriptions(uuid);
+    }
+    return true;
+}
+
+/*!
+ * Marks characteristic \a uuid's CCCD as possibly needing to be written, and schedules flushSubscriptions() for the
+ * next event loop iteration, if not already scheduled.
+ */
+void AbstractPokitServicePrivate::scheduleSubscriptions(const QBluetoothUuid &uuid)
+{
+    const bool scheduled = !pendingSubscriptions.isEmpty();
+    pendingSubscriptions.insert(uuid);
+    if (!scheduled) {
+        QTimer::singleShot(0, this, [this]() { flushSubscriptions(); });
+    }
+}
+
+/*!
+ * Writes the CCCD of each of the #pendingSubscriptions characteristics whose notifications are not already in the
+ * wanted state; that is, enabled if the characteristic has any subscribers, or disabled otherwise. So a characteristic
+ * that gained its first subscriber, and lost its last, since the last flush, is not written at all.
+ */
+void AbstractPokitServicePrivate::flushSubscriptions()
+{
+    const QSet<QBluetoothUuid> pending = pendingSubscriptions;
+    pendingSubscriptions.clear();
+    for (const QBluetoothUuid &uuid: pending) {
+        const bool wanted = subscriberCounts.contains(uuid);
+        if (wanted == notifyingCharacteristics.contains(uuid)) {
+            qCDebug(lc).noquote() << tr(R"(Characteristic %1 "%2" notifications already %3.)")
+                .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid),
+                     (wanted) ? tr("enabled") : tr("disabled"));
+        } else if (wanted) {
+            enableCharacteristicNotificatons(uuid);
+        } else {
+            disableCharacteristicNotificatons(uuid);
+        }
+    }
+}
+
+/*!
+ * Queues a \a type GATT request for characteristic \a uuid (with \a value, if writing), and returns the request's ID.
+ *
+ * If \a type is Request::Type::ReadCharacteristic, and a read of \a uuid is already queued (but not yet issued), then
+ * no new request is queued, and the existing request's ID is returned instead.
+ *
+ * Likewise, if \a type is Request::Type::WriteCharacteristic, \a uuid is one of the #coalescedCharacteristics, and a
+ * write of \a uuid is already queued (but not yet issued), then that write's value is replaced by \a value (that is,
+ * the last writer wins), and the existing request's ID is returned instead.
+ */
+quint64 AbstractPokitServicePrivate::queueRequest(const Request::Type type, const QBluetoothUuid &uuid,
+                                                  const QByteArray &value)
+{
+    if ((type == Request::Type::WriteCharacteristic) && (coalescedCharacteristics.contains(uuid))) {
+        for (Request &request: requests) {
+            if ((request.type == type) && (request.characteristic == uuid)) {
+                qCDebug(lc).noquote() << tr("Coalescing write of characteristic %1 into request %2.")
+                    .arg(uuid.toString()).arg(request.id);
+                request.value = value;
+                if (batch) {
+                    batch->insert(request.id);
+                }
+                return lastRequestId = request.id;
+            }
+        }
+    }
+    if (type == Request::Type::ReadCharacteristic) {
+        for (const Request &request: std::as_const(requests)) {
+            if ((request.type == type) && (request.characteristic == uuid)) {
+                qCDebug(lc).noquote() << tr("Coalescing read of characteristic %1 into request %2.")
+                    .arg(uuid.toString()).arg(request.id);
+                if (batch) {
+                    batch->insert(request.id);
+                }
+                return lastRequestId = request.id;
+            }
+        }
+    }
+    requests.enqueue({ ++requestCount, type, uuid, value });
+    lastRequestId = requestCount;
+    if (batch) {
+        batch->insert(lastRequestId);
+    }
+    processRequests();
+    return lastRequestId;
+}
+
+/*!
+ * Issues the next queued request, if any, unless a request is already in flight.
+ *
+ * Requests that cannot be issued (for example, because their characteristic is no longer available) are finished
+ * immediately, as failures.
+ */
+void AbstractPokitServicePrivate::processRequests()
+{
+    QTPOKIT_TRACE_ZONE(Write, "processRequests");
+    while ((!inFlight) && (!requests.isEmpty())) {
+        const Request request = requests.dequeue();
+        if (requestHandler) {
+            inFlight = request;
+            startRequestTimer();
+            requestHandler(request); // Which finishes the request (later) via finishRequest().
+            continue;
+        }
+        const QLowEnergyCharacteristic characteristic = getCharacteristic(request.characteristic);
+        const QLowEnergyDescriptor descriptor = (request.type == Request::Type::WriteDescriptor)
+            ? getClientConfiguration(request.characteristic) : QLowEnergyDescriptor();
+        if ((!characteristic.isValid()) ||
+            ((request.type == Request::Type::WriteDescriptor) && (!descriptor.isValid()))) {
+            qCWarning(lc).noquote() << tr("Unable to issue request %1 for characteristic %2.")
+                .arg(request.id).arg(request.characteristic.toString());
+            notifyFinished(request.id, false);
+            continue;
+        }
+
+        inFlight = request; // Before issuing, since some backends report errors synchronously.
+        startRequestTimer();
+        switch (request.type) {
+        case Request::Type::ReadCharacteristic:
+            QTPOKIT_TRACE_POINT(Write, "readCharacteristic", request.id);
+            service->readCharacteristic(characteristic);
+            break;
+        case Request::Type::WriteCharacteristic:
+            QTPOKIT_TRACE_POINT(Write, "writeCharacteristic", request.id);
+            if ((coalescedCharacteristics.contains(request.characteristic)) &&
+                (characteristic.properties().testFlag(QLowEnergyCharacteristic::WriteNoResponse))) {
+                service->writeCharacteristic(characteristic, request.value, QLowEnergyService::WriteWithoutResponse);
+                completeUnacknowledgedWrite(characteristic, request);
+                break;
+            }
+            service->writeCharacteristic(characteristic, request.value);
+            break;
+        case Request::Type::WriteDescriptor:
+            QTPOKIT_TRACE_POINT(Write, "writeDescriptor", request.id);
+            service->writeDescriptor(descriptor, request.value);
+            break;
+        }
+    }
+}
+
+/*!
+ * Completes \a request, a write-without-response of \a characteristic, on the next event loop iteration (once the
+ * backend has had the chance to report any error for it), as if it had been acknowledged.
+ *
+ * Unlike acknowledged writes, `QLowEnergyService` does not emit `characteristicWritten` for these, so this invokes
+ * characteristicWritten() itself, such that derived classes still emit their specialised signals (such as
+ * MultimeterService::settingsWritten), before finishing the request.
+ */
+void AbstractPokitServicePrivate::completeUnacknowledgedWrite(const QLowEnergyCharacteristic &characteristic,
+                                                              const Request &request)
+{
+    QTimer::singleShot(0, this, [this, characteristic, request]() {
+        if ((inFlight) && (inFlight->id == request.id)) {
+            characteristicWritten(characteristic, request.value);
+            finishRequest(true);
+        }
+    });
+}
+
+/*!
+ * Finishes the in-flight request successfully, if it is a \a type request for characteristic \a uuid. Descriptor
+ * writes do not identify their characteristic, so any descriptor write completes an in-flight descriptor write.
+ *
+ * The first completion matching an #abandoned request is consumed by it instead, since it is most likely that request's
+ * late completion, and not the (newer) in-flight request's.
+ */
+void AbstractPokitServicePrivate::completeRequest(const Request::Type type, const QBluetoothUuid &uuid)
+{
+    const auto matches = [type, &uuid](const Request &request) {
+        return (request.type == type) && ((type == Request::Type::WriteDescriptor) || (request.characteristic == uuid));
+    };
+    const auto late = std::find_if(abandoned.begin(), abandoned.end(), matches);
+    if (late != abandoned.end()) {
+        qCDebug(lc).noquote() << tr("Ignoring late completion of request %1.").arg(late->id);
+        abandoned.erase(late);
+        return;
+    }
+    if ((inFlight) && (inFlight->type == type) &&
+        ((type == Request::Type::WriteDescriptor) || (inFlight->characteristic == uuid))) {
+        finishRequest(true);
+    }
+}
+
+/*!
+ * Finishes the in-flight request, emitting AbstractPokitService::requestFinished with \a success, then issues the
+ * next queued request, if any. Successful characteristic writes are recorded too (see recordTraffic()).
+ */
+void AbstractPokitServicePrivate::finishRequest(const bool success)
+{
+    Q_ASSERT(inFlight);
+    if ((success) && (inFlight->type == Request::Type::WriteCharacteristic)) {
+        recordTraffic(TrafficRecorder::Operation::Write, inFlight->characteristic, inFlight->value);
+    }
+    const quint64 id = inFlight->id;
+    inFlight.reset();
+    stopRequestTimer();
+    notifyFinished(id, success);
+    processRequests();
+}
+
+/*!
+ * Starts (or restarts) #requestTimer, creating it if necessary, to fail #inFlight if it has not completed within
+ * #requestTimeout milliseconds.
+ */
+void AbstractPokitServicePrivate::startRequestTimer()
+{
+    if (!requestTimer) {
+        requestTimer = new QTimer(this);
+        requestTimer->setSingleShot(true);
+        connect(requestTimer, &QTimer::timeout, this, &AbstractPokitServicePrivate::requestTimedOut);
+    }
+    requestTimer->start(requestTimeout);
+}
+
+/*!
+ * Stops #requestTimer, if it has been created.
+ */
+void AbstractPokitServicePrivate::stopRequestTimer()
+{
+    if (requestTimer) {
+        requestTimer->stop();
+    }
+}
+
+/*!
+ * Finishes the in-flight request (if any) as a failure, since its completion has not arrived in time, such that the
+ * next queued requests are not stalled behind it. Requests issued to #service are added to #abandoned, so that their
+ * late completions (if any) are not credited to the next in-flight request instead (see completeRequest()).
+ */
+void AbstractPokitServicePrivate::requestTimedOut()
+{
+    if (!inFlight) {
+        return;
+    }
+    qCWarning(lc).noquote() << tr("Request %1 for characteristic %2 timed out after %Ln millisecond/s.", nullptr,
+        requestTimeout).arg(inFlight->id).arg(inFlight->characteristic.toString());
+    if (!requestHandler) { // Request handlers finish requests by ID, so are not confused by late completions.
+        abandoned.append(*inFlight);
+    }
+    finishRequest(false);
+}
+
+/*!
+ * Finishes all in-flight and queued requests as failures, such as when the service has become invalid.
+ */
+void AbstractPokitServicePrivate::failRequests()
+{
+    QQueue<Request> failed;
+    abandoned.clear(); // No late completions will arrive now, either.
+    std::swap(failed, requests);
+    if (inFlight) {
+        failed.prepend(*inFlight);
+        inFlight.reset();
+        stopRequestTimer();
+    }
+    for (const Request &request: std::as_const(failed)) {
+        notifyFinished(request.id, false);
+    }
+}
+
+/*!
+ * Records that request \a id has finished, with \a success, finishing any futures that were waiting on it, and emits
+ * AbstractPokitService::requestFinished.
+ */
+void AbstractPokitServicePrivate::notifyFinished(const quint64 id, const bool success)
+{
+    if ((batch) && (batch->remove(id)) && (!success)) {
+        batchSucceeded = false; // Failed synchronously, while being queued by whenFinished().
+    }
+    for (auto waiter = waiters.begin(); waiter != waiters.end();) {
+        if (waiter->ids.remove(id)) {
+            waiter->success = waiter->success && success;
+            if (waiter->ids.isEmpty()) {
+                finishFuture(waiter->promise, waiter->success);
+                waiter = waiters.erase(waiter);
+                continue;
+            }
+        }
+        ++waiter;
+    }
+    Q_Q(AbstractPokitService);
+    Q_EMIT q->requestFinished(id, success);
+}
+
+/*!
+ * Invokes \a issue to queue one or more requests, and returns a future that will finish once all of those requests
+ * have finished.
+ *
+ * The future's result is \c true if \a issue returned \c true, and all of the requests it queued succeeded, otherwise
+ * \c false. If \a issue returns \c false, then the returned future will already be finished, with a \c false result.
+ *
+ * This function may be called from any thread, in which case \a issue is invoked on this object's thread instead, and
+ * the returned future finishes (even if \a issue returns \c false) only once it has been invoked there.
+ */
+QFuture<bool> AbstractPokitServicePrivate::whenFinished(const std::function<bool()> &issue)
+{
+    QFutureInterface<bool> promise(QFutureInterfaceBase::Started);
+    if (!invokeOnServiceThread([this, issue, promise]() { issueBatch(issue, promise); })) {
+        issueBatch(issue, promise);
+    }
+    return promise.future();
+}
+
+/*!
+ * Invokes \a issue to queue one or more requests, then finishes \a promise once all of those requests have finished.
+ *
+ * \see whenFinished()
+ */
+void AbstractPokitServicePrivate::issueBatch(const std::function<bool()> &issue, QFutureInterface<bool> promise)
+{
+    Q_ASSERT(!batch); // whenFinished() is not re-entrant.
+    batch.emplace();
+    batchSucceeded = true;
+    const bool queued = issue();
+    const QSet<quint64> ids = *batch;
+    batch.reset();
+
+    if ((!queued) || (!batchSucceeded) || (ids.isEmpty())) {
+        finishFuture(promise, queued && batchSucceeded);
+    } else {
+        waiters.append({ ids, true, promise });
+    }
+}
+
+/*!
+ * Reports \a result to \a promise, and finishes it.
+ */
+void AbstractPokitServicePrivate::finishFuture(QFutureInterface<bool> &promise, const bool result)
+{
+    promise.reportResult(result);
+    promise.reportFinished();
+}
+
+/*!
+ * Sets \a handler as the handler for notifications of characteristic \a uuid, replacing any existing handler.
+ *
+ * Derived classes should set handlers (typically in their constructors) for all of the characteristics they expect to
+ * be notified of. Once the service details have been discovered, notifications are then routed directly to the
+ * relevant handler, by characteristic handle, instead of via characteristicChanged().
+ */
+void AbstractPokitServicePrivate::setNotificationHandler(const QBluetoothUuid &uuid, const NotificationHandler &handler)
+{
+    for (auto &existing: notificationHandlers) {
+        if (existing.first == uuid) {
+            existing.second = handler;
+            resolveNotificationRoutes();
+            return;
+        }
+    }
+    notificationHandlers.append({ uuid, handler });
+    resolveNotificationRoutes();
+}
+
+/*!
+ * Resolves #notificationHandlers to #notificationRoutes, by looking up each characteristic's handle in the service.
+ *
+ * Characteristics not (yet) present in the service are not routed, so their notifications will still be dispatched
+ * via characteristicChanged().
+ */
+void AbstractPokitServicePrivate::resolveNotificationRoutes()
+{
+    notificationRoutes.clear();
+    if (!service) {
+        return;
+    }
+    for (const auto &handler: std::as_const(notificationHandlers)) {
+        if (const QLowEnergyCharacteristic characteristic = service->characteristic(handler.first);
+            characteristic.isValid()) {
+            notificationRoutes.insert(characteristic.handle(), handler.second);
+        }
+    }
+    qCDebug(lc).noquote() << tr("Routing notifications for %Ln characteristic/s.", nullptr, notificationRoutes.size());
+}
+
+/*!
+ * Returns `false` if \a data is smaller than \a minSize, otherwise returns \a failOnMax if \a data
+ * is bigger than \a maxSize, otherwise returns `true`.
+ *
+ * A warning is logged if either \a minSize or \a maxSize is violated, regardless of the returned
+ * value; ie this funcion can be used to simply warn if \a data is too big, or it can be used to
+ * failed (return `false`) in that case.
+ */
+bool AbstractPokitServicePrivate::checkSize(const QString &label, const QByteArray &data,
+                                            const int minSize, const int maxSize,
+                                            const bool failOnMax)
+{
+    if (data.size() < minSize) {
+        qCWarning(lc).noquote() << tr("%1 requires %n byte/s, but only %2 present: %3", nullptr, minSize)
+            .arg(label).arg(data.size()).arg(toHexString(data));
+        countParseFailure();
+        return false;
+    }
+    if ((maxSize >= 0) && (data.size() > maxSize)) {
+        qCWarning(lc).noquote() << tr("%1 has %n extraneous byte/s: %2", nullptr, data.size()-maxSize)
+            .arg(label, toHexString(data.mid(maxSize)));
+        if (failOnMax) {
+            countParseFailure();
+        }
+        return (!failOnMax);
+    }
+    return true;
+}
+
+/*!
+ * Returns up to \a maxSize bytes of \a data as a human readable hexadecimal string. If \a data
+ * exceeds \a maxSize, then \a data is elided in the middle. For example:
+ *
+ * ```
+ * toHex(QBytArray("\x1\x2\x3\x4\x5\x6", 4); // "0x01,02,...,05,06"
+ * ```
+ */
+QString AbstractPokitServicePrivate::toHexString(const QByteArray &data, const int maxSize)
+{
+    return (data.size() <= maxSize)
+        ? QString::fromLatin1("0x%1").arg(QLatin1String(data.toHex(',')))
+        : QString::fromLatin1("0x%1,...,%2").arg(
+            QLatin1String(data.left(maxSize/2-1).toHex(',')),
+            QLatin1String(data.right(maxSize/2-1).toHex(',')));
+}
+
+/*!
+ * Resumes this service after a reconnection, by re-enabling all #notifyingCharacteristics, then re-writing all of the
+ * #resumeValues (such as the last multimeter or DSO settings), and emitting AbstractPokitService::resumed.
+ *
+ * Notifications are re-enabled first, so that no values are missed once the settings have been re-applied.
+ */
+void AbstractPokitServicePrivate::resume()
+{
+    Q_Q(AbstractPokitService);
+    qCDebug(lc).noquote() << tr("Resuming %Ln notification/s, and %1 setting/s.", nullptr,
+        notifyingCharacteristics.size()).arg(resumeValues.size());
+    const QSet<QBluetoothUuid> notifying = notifyingCharacteristics; // Copies, since re-enabling re-inserts.
+    const QHash<QBluetoothUuid, QByteArray> values = resumeValues;
+    for (const QBluetoothUuid &uuid: notifying) {
+        enableCharacteristicNotificatons(uuid);
+    }
+    for (auto iter = values.constBegin(); iter != values.constEnd(); ++iter) {
+        writeCharacteristic(iter.key(), iter.value());
+    }
+    Q_EMIT q->resumed(receiveTimestamp, steadyTimestamp());
+}
+
 /*!
  * Handles `QLowEnergyController::connected` events.
  *
  * If `autoDiscover` is enabled, this will begin service discovery on the newly connected controller.
  *
+ * If this is a reconnection, then the previous connection's (now invalid) service object is released, so that a new
+ * one will be created once discovered, and the service will resume() once the new object's details are discovered.
+ *
  * \see AbstractPokitService::autoDiscover()
  */
 void AbstractPokitServicePrivate::connected()
@@ -448,6 +1320,15 @@ void AbstractPokitServicePrivate::connected()
         return;
     }
 
+    if ((service) && (service->state() == QLowEnergyService::InvalidService)) {
+        qCDebug(lc).noquote() << tr("Reconnected; releasing invalidated service object.");
+        disconnect(service, nullptr, this, nullptr);
+        service->deleteLater();
+        service = nullptr;
+        characteristics.clear();
+        resuming = true;
+    }
+
     qCDebug(lc).noquote() << tr(R"(Connected to "%1" (%2) at %3.)").arg(
         controller->remoteName(), controller->remoteDeviceUuid().toString(),
         controller->remoteAddress().toString());
@@ -489,6 +1370,13 @@ void AbstractPokitServicePrivate::errorOccurred(const QLowEnergyService::Service
 {
     Q_Q(AbstractPokitService);
     qCDebug(lc).noquote() << tr("Service error") << newError;
+    if (newError != QLowEnergyService::ServiceError::NoError) {
+        const QMutexLocker scopedLock(&statisticsMutex);
+        ++statistics.errors;
+    }
+    if ((inFlight) && (newError != QLowEnergyService::ServiceError::NoError)) {
+        finishRequest(false);
+    }
     Q_EMIT q->serviceErrorOccurred(newError);
 }
 
@@ -511,7 +1399,8 @@ void AbstractPokitServicePrivate::serviceDiscovered(const QBluetoothUuid &newSer
  * Handles `QLowEnergyController::stateChanged` events.
  *
  * If \a newState indicates that service details have now been discovered, then
- * AbstractPokitService::serviceDetailsDiscovered will be emitted.
+ * AbstractPokitService::serviceDetailsDiscovered will be emitted. Or if \a newState indicates that the service has
+ * become invalid, then all queued requests are failed.
  *
  * \see AbstractPokitService::autoDiscover()
  */
@@ -519,6 +1408,12 @@ void AbstractPokitServicePrivate::stateChanged(QLowEnergyService::ServiceState n
 {
     qCDebug(lc).noquote() << tr("State changed to") << newState;
 
+    if (newState == QLowEnergyService::InvalidService) {
+        failRequests(); // The service has gone away, so no queued requests will complete now.
+        notificationRoutes.clear(); // Characteristic handles are only valid for the lifetime of the service.
+    }
+    characteristics.clear(); // Re-resolved below, if (and only if) the service is now discovered.
+
     if (lc().isDebugEnabled()) {
         for (const auto &characteristic: service->characteristics()) {
             QStringList properties;
@@ -551,13 +1446,330 @@ void AbstractPokitServicePrivate::stateChanged(QLowEnergyService::ServiceState n
         ) {
         Q_Q(AbstractPokitService);
         qCDebug(lc).noquote() << tr("Service details discovered.");
+        QTPOKIT_TRACE_ZONE(Discovery, "serviceDetailsDiscovered");
+        QTPOKIT_TRACE_POINT(Discovery, "serviceDetailsDiscovered", 0);
+        resolveCharacteristics();
+        resolveNotificationRoutes();
+        if (resuming) {
+            resuming = false;
+            resume();
+        }
         Q_EMIT q->serviceDetailsDiscovered();
     }
 }
 
 /*!
- * Handles `QLowEnergyService::characteristicRead` events. This base implementation simply debug
- * logs the event.
+ * Returns #controller's ATT MTU, or -1 if unknown.
+ */
+int AbstractPokitServicePrivate::mtu() const
+{
+    #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+    if (controller) {
+        return controller->mtu();
+    }
+    #endif
+    return -1;
+}
+
+/*!
+ * Starts accounting for a new transfer of \a expectedBytes payload bytes, such as the samples described by a DSO or
+ * data logger `Metadata` notification, and logs the number of notifications expected at the current MTU.
+ *
+ * Any incomplete transfer still in progress is ended (and logged) first.
+ */
+void AbstractPokitServicePrivate::beginTransfer(const qint64 expectedBytes)
+{
+    if ((transfer) && (transfer->packets > 0)) {
+        endTransfer();
+    }
+    transfer.reset();
+    if (expectedBytes <= 0) {
+        return;
+    }
+    transfer = Transfer{ expectedBytes, 0, 0 };
+    if (const int mtu = this->mtu(); mtu > 3) {
+        const qint64 packets = (expectedBytes + mtu - 4) / (mtu - 3);
+        qCDebug(lc).noquote() << tr("Expecting %1 bytes in %Ln notification/s, at an ATT MTU of %2 bytes.", nullptr,
+            packets).arg(expectedBytes).arg(mtu);
+    } else {
+        qCDebug(lc).noquote() << tr("Expecting %1 bytes, at an unknown ATT MTU.").arg(expectedBytes);
+    }
+}
+
+/*!
+ * Adds the notified \a value to the transfer in progress (if any), ending the transfer once all expected bytes have
+ * been received.
+ */
+void AbstractPokitServicePrivate::countTransfer(const QByteArray &value)
+{
+    if (!transfer) {
+        return;
+    }
+    transfer->bytes += value.size();
+    ++transfer->packets;
+    if (transfer->bytes >= transfer->expectedBytes) {
+        endTransfer();
+    }
+}
+
+/*!
+ * Logs the totals of the transfer in progress (if any), including the mean payload per notification, then ends it.
+ */
+void AbstractPokitServicePrivate::endTransfer()
+{
+    if (!transfer) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Received %1 of %2 bytes in %Ln notification/s (%3 bytes each), at an ATT MTU of %4.",
+        nullptr, transfer->packets).arg(transfer->bytes).arg(transfer->expectedBytes)
+        .arg((transfer->packets == 0) ? 0.0 : (double)transfer->bytes / transfer->packets, 0, 'f', 1).arg(mtu());
+    transfer.reset();
+}
+
+/*!
+ * Returns the current time, in nanoseconds, according to a steady (ie monotonic) clock.
+ */
+qint64 AbstractPokitServicePrivate::steadyTimestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * Counts a value that failed to parse, such as one rejected by checkSize(), on behalf of the service (if any) whose
+ * value is currently being parsed on this thread.
+ *
+ * Since parse functions, such as DsoServicePrivate::parseSamples(), are static (and also used to parse cached values
+ * outside of any notification), failures are counted per thread, then attributed to the service by notified() and
+ * valueRead(), which compare parseFailureCount() before and after parsing.
+ */
+void AbstractPokitServicePrivate::countParseFailure()
+{
+    ++threadParseFailures;
+}
+
+/*!
+ * Returns the number of parse failures counted, via countParseFailure(), on the current thread.
+ */
+quint64 AbstractPokitServicePrivate::parseFailureCount()
+{
+    return threadParseFailures;
+}
+
+/*!
+ * Returns the AbstractPokitService::Statistics::notificationGaps bucket for a \a gap of nanoseconds.
+ */
+int AbstractPokitServicePrivate::notificationGapBucket(const qint64 gap)
+{
+    int bucket = 0;
+    for (qint64 ms = gap / 1000000; (ms > 0) && (bucket < AbstractPokitService::notificationGapBuckets - 1); ms /= 2) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+/*!
+ * Adds the received \a value, and the number of \a parseFailures parsing it, to #statistics. If \a notifiedAt is
+ * non-negative, the value was notified at that (steady clock) time, otherwise it was read.
+ */
+void AbstractPokitServicePrivate::countValue(const QByteArray &value, const quint64 parseFailures,
+                                             const qint64 notifiedAt)
+{
+    const QMutexLocker scopedLock(&statisticsMutex);
+    statistics.bytes += value.size();
+    statistics.parseFailures += parseFailures;
+    if (notifiedAt < 0) {
+        ++statistics.reads;
+        return;
+    }
+    ++statistics.notifications;
+    if (notifyTimestamp >= 0) {
+        ++statistics.notificationGaps[notificationGapBucket(notifiedAt - notifyTimestamp)];
+    }
+    notifyTimestamp = notifiedAt;
+}
+
+/*!
+ * Adds the latencies of the value received at #receiveTimestamp to #statistics: to being parsed at (steady clock)
+ * \a parsedAt, and to now, which (when called immediately after emitting the value) is when the derived class'
+ * signal returned.
+ */
+void AbstractPokitServicePrivate::countLatency(const qint64 parsedAt)
+{
+    if (receiveTimestamp < 0) {
+        return;
+    }
+    const qint64 emittedAt = steadyTimestamp();
+    const QMutexLocker scopedLock(&statisticsMutex);
+    statistics.parseLatency.record(parsedAt - receiveTimestamp);
+    statistics.emitLatency.record(emittedAt - receiveTimestamp);
+}
+
+/*!
+ * Returns \c true if #batching is enabled, that is, if batches may hold more than one notification's values.
+ */
+bool AbstractPokitServicePrivate::isBatching() const
+{
+    return (batching.maxCount > 1) || (batching.maxLatency > 0);
+}
+
+/*!
+ * Accounts for the derived class having appended a notification's values to its batch in progress, which now holds
+ * \a size notifications' values, emitting the batch (via flushBatch()) if it has reached #batching's maximum count or
+ * latency, or if \a complete (such as at the end of a sample transfer).
+ *
+ * The batch's first value starts #batchTimer (if #batching has a maximum latency), so that batches are emitted on time
+ * even if no further notifications arrive.
+ */
+void AbstractPokitServicePrivate::batchAppended(const qsizetype size, const bool complete)
+{
+    const qint64 now = steadyTimestamp();
+    if (size == 1) {
+        batchStarted = now;
+        if ((batching.maxLatency > 0) && (!complete)) {
+            if (!batchTimer) {
+                batchTimer = new QTimer(this);
+                batchTimer->setSingleShot(true);
+                batchTimer->setTimerType(Qt::PreciseTimer);
+                connect(batchTimer, &QTimer::timeout, this, &AbstractPokitServicePrivate::flushBatch);
+            }
+            batchTimer->start((int)((batching.maxLatency + 999) / 1000)); // Rounded up to whole milliseconds.
+        }
+    }
+    if ((complete) || ((batching.maxCount > 0) && (size >= (qsizetype)batching.maxCount)) ||
+        ((batching.maxLatency > 0) && (now - batchStarted >= batching.maxLatency * 1000ll))) {
+        flushBatch();
+    }
+}
+
+/*!
+ * Emits the batch in progress (if any) via emitBatch(), and stops #batchTimer.
+ */
+void AbstractPokitServicePrivate::flushBatch()
+{
+    if (batchTimer) {
+        batchTimer->stop();
+    }
+    batchStarted = -1;
+    emitBatch();
+}
+
+/*!
+ * Emits, then clears, the derived class' batch in progress, if any. This default implementation does nothing, for
+ * services that do not support batching.
+ */
+void AbstractPokitServicePrivate::emitBatch()
+{
+
+}
+
+/*!
+ * Records the receipt of a new value for \a characteristic, by setting #receiveTimestamp to the current time, and
+ * emitting AbstractPokitService::valueReceived.
+ */
+void AbstractPokitServicePrivate::received(const QLowEnergyCharacteristic &characteristic)
+{
+    received(characteristic.uuid());
+}
+
+/*!
+ * Records the receipt of a new value for characteristic \a uuid, by setting #receiveTimestamp to the current time,
+ * and emitting AbstractPokitService::valueReceived.
+ */
+void AbstractPokitServicePrivate::received(const QBluetoothUuid &uuid)
+{
+    Q_Q(AbstractPokitService);
+    receiveTimestamp = steadyTimestamp();
+    Q_EMIT q->valueReceived(uuid, receiveTimestamp);
+}
+
+/*!
+ * Passes \a operation's \a value for characteristic \a uuid, at steady clock \a timestamp (in nanoseconds, or -1 for
+ * now), to #trafficHandler, if set.
+ */
+void AbstractPokitServicePrivate::recordTraffic(const TrafficRecorder::Operation operation, const QBluetoothUuid &uuid,
+                                                const QByteArray &value, const qint64 timestamp)
+{
+    if (trafficHandler) {
+        trafficHandler(operation, uuid, value, (timestamp < 0) ? steadyTimestamp() : timestamp);
+    }
+}
+
+/*!
+ * Returns \c true if characteristic \a uuid has a notification handler (see setNotificationHandler()), otherwise
+ * \c false.
+ */
+bool AbstractPokitServicePrivate::hasNotificationHandler(const QBluetoothUuid &uuid) const
+{
+    return std::any_of(notificationHandlers.cbegin(), notificationHandlers.cend(),
+        [&uuid](const QPair<QBluetoothUuid, NotificationHandler> &pair) { return pair.first == uuid; });
+}
+
+/*!
+ * Delivers \a value, as if notified (or read) for characteristic \a uuid, straight to the characteristic's
+ * notification handler (see setNotificationHandler()), without any QLowEnergyService. The value is counted in
+ * #statistics just like a real notification. This is how PokitSimulator feeds simulated devices' values through the
+ * same parsing, and signals, as real devices' values.
+ *
+ * Returns \c true if \a uuid has a notification handler, otherwise \c false (and the value is discarded).
+ */
+bool AbstractPokitServicePrivate::simulateValue(const QBluetoothUuid &uuid, const QByteArray &value)
+{
+    const auto handler = std::find_if(notificationHandlers.cbegin(), notificationHandlers.cend(),
+        [&uuid](const QPair<QBluetoothUuid, NotificationHandler> &pair) { return pair.first == uuid; });
+    if (handler == notificationHandlers.cend()) {
+        qCDebug(lc).noquote() << tr(R"(No handler for simulated characteristic %1 "%2".)")
+            .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+        return false;
+    }
+    const qint64 timestamp = steadyTimestamp();
+    recordTraffic(TrafficRecorder::Operation::Notify, uuid, value, timestamp);
+    const quint64 failures = parseFailureCount();
+    received(uuid);
+    handler->second(value);
+    countValue(value, parseFailureCount() - failures, timestamp);
+    return true;
+}
+
+/*!
+ * Handles `QLowEnergyService::characteristicChanged` events.
+ *
+ * If \a characteristic has a resolved route (see setNotificationHandler()), then \a newValue is passed straight to
+ * that route's handler, after the base characteristicChanged() processing. Otherwise, \a newValue is dispatched via the
+ * virtual characteristicChanged() function. Either way, the notification is then counted in #statistics.
+ */
+void AbstractPokitServicePrivate::notified(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
+{
+    QTPOKIT_TRACE_ZONE(Notify, "characteristicChanged");
+    QTPOKIT_TRACE_POINT(Notify, "characteristicChanged", newValue.size());
+    const qint64 timestamp = steadyTimestamp();
+    recordTraffic(TrafficRecorder::Operation::Notify, characteristic.uuid(), newValue, timestamp);
+    const quint64 failures = parseFailureCount();
+    if (const auto route = notificationRoutes.constFind(characteristic.handle());
+        route == notificationRoutes.constEnd()) {
+        characteristicChanged(characteristic, newValue);
+    } else {
+        AbstractPokitServicePrivate::characteristicChanged(characteristic, newValue);
+        (*route)(newValue);
+    }
+    countValue(newValue, parseFailureCount() - failures, timestamp);
+}
+
+/*!
+ * Handles `QLowEnergyService::characteristicRead` events, by recording the read (see recordTraffic()), dispatching
+ * \a characteristic's \a value via the virtual characteristicRead() function, then counting the read in #statistics.
+ */
+void AbstractPokitServicePrivate::valueRead(const QLowEnergyCharacteristic &characteristic, const QByteArray &value)
+{
+    recordTraffic(TrafficRecorder::Operation::Read, characteristic.uuid(), value);
+    const quint64 failures = parseFailureCount();
+    characteristicRead(characteristic, value);
+    countValue(value, parseFailureCount() - failures);
+}
+
+/*!
+ * Handles `QLowEnergyService::characteristicRead` events. This base implementation records the
+ * receive time (see AbstractPokitService::receiveTimestamp), and debug logs the event.
  *
  * Derived classes should implement this function to handle the successful reads of
  * \a characteristic, typically by parsing \a value, then emitting a specialised signal.
@@ -565,6 +1777,7 @@ void AbstractPokitServicePrivate::stateChanged(QLowEnergyService::ServiceState n
 void AbstractPokitServicePrivate::characteristicRead(
     const QLowEnergyCharacteristic &characteristic, const QByteArray &value)
 {
+    received(characteristic); // Before anything else, for the most accurate timestamp.
     qCDebug(lc).noquote() << tr(R"(Characteristic %1 "%2" read %n byte/s: %3)", nullptr, value.size()).arg(
         characteristic.uuid().toString(), PokitDevice::charcteristicToString(characteristic.uuid()), toHexString(value));
 }
@@ -584,8 +1797,8 @@ void AbstractPokitServicePrivate::characteristicWritten(
 }
 
 /*!
- * Handles `QLowEnergyService::characteristicChanged` events. This base implementation simply debug
- * logs the event.
+ * Handles `QLowEnergyService::characteristicChanged` events. This base implementation records the
+ * receive time (see AbstractPokitService::receiveTimestamp), and debug logs the event.
  *
  * If derived classes support characteristics with client-side notification (ie Notify, as opposed
  * to Read or Write operations), they should implement this function to handle the successful reads of
@@ -594,6 +1807,7 @@ void AbstractPokitServicePrivate::characteristicWritten(
 void AbstractPokitServicePrivate::characteristicChanged(
     const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue)
 {
+    received(characteristic); // Before anything else, for the most accurate timestamp.
     qCDebug(lc).noquote() << tr(R"(Characteristic %1 "%2" changed to %Ln byte/s: %3)", nullptr, newValue.size())
         .arg(characteristic.uuid().toString(), PokitDevice::charcteristicToString(characteristic.uuid()), toHexString(newValue));
 }
@@ -9,14 +9,26 @@
 #ifndef QTPOKIT_ABSTRACTPOKITSERVICE_P_H
 #define QTPOKIT_ABSTRACTPOKITSERVICE_P_H
 
+#include <qtpokit/memorybudget.h>
 #include <qtpokit/qtpokit_global.h>
 #include <qtpokit/pokitproducts.h>
+#include <qtpokit/trafficrecorder.h>
 
+#include <QFutureInterface>
+#include <QHash>
 #include <QLoggingCategory>
 #include <QLowEnergyService>
+#include <QMutex>
 #include <QObject>
+#include <QPair>
+#include <QQueue>
+#include <QSet>
+#include <QVector>
+
+#include <functional>
 
 class QLowEnergyController;
+class QTimer;
 
 QTPOKIT_BEGIN_NAMESPACE
 
@@ -29,27 +41,157 @@ class QTPOKIT_EXPORT AbstractPokitServicePrivate : public QObject
 public:
     static Q_LOGGING_CATEGORY(lc, "pokit.ble.service", QtInfoMsg); ///< Logging category.
 
+    /// A GATT operation, queued to be issued once all earlier operations have completed.
+    struct Request {
+        /// GATT operations supported by the request queue.
+        enum class Type {
+            ReadCharacteristic,  ///< Read the characteristic's value.
+            WriteCharacteristic, ///< Write #value to the characteristic.
+            WriteDescriptor,     ///< Write #value to the characteristic's client configuration descriptor.
+        };
+        quint64 id;                    ///< Request ID, as reported by AbstractPokitService::requestFinished.
+        Type type;                     ///< GATT operation to perform.
+        QBluetoothUuid characteristic; ///< UUID of the characteristic to operate on.
+        QByteArray value;              ///< Value to write, if any.
+    };
+
+    /// Parses a notified characteristic value, and emits the relevant specialised signal.
+    typedef std::function<void(const QByteArray &value)> NotificationHandler;
+
+    /// Issues a request in place of #service, such as for a simulated device, and later calls finishRequest().
+    typedef std::function<void(const Request &request)> RequestHandler;
+
+    /// Records a characteristic value read, written, or notified at steady clock \a timestamp (in nanoseconds).
+    typedef std::function<void(const TrafficRecorder::Operation operation, const QBluetoothUuid &uuid,
+                               const QByteArray &value, const qint64 timestamp)> TrafficHandler;
+
+    /// Running totals for a multi-notification transfer, such as a DSO or data logger sample transfer.
+    struct Transfer {
+        qint64 expectedBytes; ///< Number of payload bytes expected, according to the transfer's metadata.
+        qint64 bytes;         ///< Number of payload bytes received so far.
+        qint64 packets;       ///< Number of notifications received so far.
+    };
+
+    /// A characteristic, and its client characteristic configuration descriptor (if any), as resolved from #service.
+    struct CachedCharacteristic {
+        QLowEnergyCharacteristic characteristic; ///< The characteristic.
+        QLowEnergyDescriptor clientConfiguration; ///< The characteristic's CCCD, or invalid if it has none.
+    };
+
+    /// A future, waiting for one or more requests to finish.
+    struct Waiter {
+        QSet<quint64> ids;              ///< IDs of the requests not yet finished.
+        bool success;                   ///< Whether all of the requests finished so far have succeeded.
+        QFutureInterface<bool> promise; ///< Future to finish once all #ids have finished.
+    };
+
     bool autoDiscover { true };                    ///< Whether autodiscovery is enabled or not.
+    bool skipValueDiscovery { false };             ///< Whether autodiscovery skips reading characteristic values.
     QLowEnergyController * controller { nullptr }; ///< BLE controller to fetch the service from.
     std::optional<PokitProduct> pokitProduct;      ///< The Pokit product #controller is connected to.
     QLowEnergyService * service { nullptr };       ///< BLE service to read/write characteristics.
     QBluetoothUuid serviceUuid;                    ///< UUIDs for #service.
+    qint64 receiveTimestamp { -1 };                ///< Steady clock time the last value was received, in ns.
+    QQueue<Request> requests;                      ///< GATT requests not yet issued.
+    std::optional<Request> inFlight;               ///< GATT request issued, but not yet completed.
+    QTimer * requestTimer { nullptr };             ///< Fails #inFlight, if it has not completed within #requestTimeout.
+    int requestTimeout { 10000 };                  ///< Milliseconds to wait for #inFlight to complete.
+    QVector<Request> abandoned;                    ///< Timed out requests, whose late completions to ignore.
+    quint64 requestCount { 0 };                    ///< Number of GATT requests queued, for assigning IDs.
+    quint64 lastRequestId { 0 };                   ///< ID of the most recently queued (or coalesced) request.
+    QVector<Waiter> waiters;                       ///< Futures waiting for requests to finish.
+    std::optional<QSet<quint64>> batch;            ///< IDs of requests queued by the current whenFinished() call.
+    bool batchSucceeded { true };                  ///< Whether any of the #batch requests have failed already.
+    QVector<QPair<QBluetoothUuid, NotificationHandler>> notificationHandlers; ///< Handlers, by characteristic UUID.
+    QHash<QLowEnergyHandle, NotificationHandler> notificationRoutes; ///< Handlers, by characteristic handle.
+    QHash<QBluetoothUuid, CachedCharacteristic> characteristics; ///< #service's characteristics, once discovered.
+    std::optional<Transfer> transfer;              ///< Sample transfer in progress, if any.
+    QSet<QBluetoothUuid> resumableCharacteristics; ///< Characteristics whose last written value to resume.
+    QHash<QBluetoothUuid, QByteArray> resumeValues; ///< Last values written to #resumableCharacteristics.
+    QSet<QBluetoothUuid> coalescedCharacteristics; ///< Characteristics whose queued writes coalesce.
+    QSet<QBluetoothUuid> notifyingCharacteristics; ///< Characteristics with notifications enabled.
+    QHash<QBluetoothUuid, int> subscriberCounts;  ///< Number of notification subscribers, by characteristic UUID.
+    QSet<QBluetoothUuid> pendingSubscriptions;     ///< Characteristics whose CCCDs flushSubscriptions() is to check.
+    bool resuming { false };                       ///< Whether to resume once the service is (re)discovered.
+    AbstractPokitService::Statistics statistics;   ///< Runtime statistics, guarded by #statisticsMutex.
+    mutable QMutex statisticsMutex;                ///< Mutex for protecting access to #statistics.
+    const MemoryBudget::Stream * memoryStream { nullptr }; ///< Accounts for the service's buffers, if any.
+    qint64 notifyTimestamp { -1 };                 ///< Steady clock time the last notification was received, in ns.
+    RequestHandler requestHandler;                 ///< Issues requests in place of #service, if set.
+    TrafficHandler trafficHandler;                 ///< Records characteristic traffic, if set (see TrafficRecorder).
+    AbstractPokitService::Batching batching;       ///< Batching of notifications into single signals, if enabled.
+    QTimer * batchTimer { nullptr };               ///< Emits the batch in progress, once #batching's latency is up.
+    qint64 batchStarted { -1 };                    ///< Steady clock time the batch in progress started, in ns.
 
     AbstractPokitServicePrivate(const QBluetoothUuid &serviceUuid,
         QLowEnergyController * controller, AbstractPokitService * const q);
 
-    virtual ~AbstractPokitServicePrivate() = default;
+    virtual ~AbstractPokitServicePrivate();
 
+    bool invokeOnServiceThread(const std::function<void()> &function);
     bool createServiceObject();
     QLowEnergyCharacteristic getCharacteristic(const QBluetoothUuid &uuid) const;
+    QLowEnergyDescriptor getClientConfiguration(const QBluetoothUuid &uuid) const;
+    void resolveCharacteristics();
+    bool hasCharacteristic(const QBluetoothUuid &uuid) const;
+    bool hasClientConfiguration(const QBluetoothUuid &uuid) const;
     bool readCharacteristic(const QBluetoothUuid &uuid);
+    bool writeCharacteristic(const QBluetoothUuid &uuid, const QByteArray &value);
 
     bool enableCharacteristicNotificatons(const QBluetoothUuid &uuid);
     bool disableCharacteristicNotificatons(const QBluetoothUuid &uuid);
+    bool subscribe(const QBluetoothUuid &uuid);
+    bool unsubscribe(const QBluetoothUuid &uuid);
+    void scheduleSubscriptions(const QBluetoothUuid &uuid);
+    void flushSubscriptions();
 
     static bool checkSize(const QString &label, const QByteArray &data, const int minSize,
                           const int maxSize=-1, const bool failOnMax=false);
     static QString toHexString(const QByteArray &data, const int maxSize=20);
+    static qint64 steadyTimestamp();
+
+    static void countParseFailure();
+    static quint64 parseFailureCount();
+    static int notificationGapBucket(const qint64 gap);
+    void countValue(const QByteArray &value, const quint64 parseFailures, const qint64 notifiedAt = -1);
+    void countLatency(const qint64 parsedAt);
+
+    bool isBatching() const;
+    void batchAppended(const qsizetype size, const bool complete = false);
+    void flushBatch();
+    virtual void emitBatch();
+
+    void received(const QLowEnergyCharacteristic &characteristic);
+    void received(const QBluetoothUuid &uuid);
+    void recordTraffic(const TrafficRecorder::Operation operation, const QBluetoothUuid &uuid, const QByteArray &value,
+                       const qint64 timestamp = -1);
+    bool hasNotificationHandler(const QBluetoothUuid &uuid) const;
+    bool simulateValue(const QBluetoothUuid &uuid, const QByteArray &value);
+
+    quint64 queueRequest(const Request::Type type, const QBluetoothUuid &uuid, const QByteArray &value = QByteArray());
+    void processRequests();
+    void completeUnacknowledgedWrite(const QLowEnergyCharacteristic &characteristic, const Request &request);
+    void completeRequest(const Request::Type type, const QBluetoothUuid &uuid);
+    void finishRequest(const bool success);
+    void startRequestTimer();
+    void stopRequestTimer();
+    void requestTimedOut();
+    void failRequests();
+    void notifyFinished(const quint64 id, const bool success);
+
+    int mtu() const;
+    void beginTransfer(const qint64 expectedBytes);
+    void countTransfer(const QByteArray &value);
+    void endTransfer();
+
+    QFuture<bool> whenFinished(const std::function<bool()> &issue);
+    void issueBatch(const std::function<bool()> &issue, QFutureInterface<bool> promise);
+    static void finishFuture(QFutureInterface<bool> &promise, const bool result);
+
+    void setNotificationHandler(const QBluetoothUuid &uuid, const NotificationHandler &handler);
+    void resolveNotificationRoutes();
+
+    void resume();
 
 protected:
     AbstractPokitService * q_ptr; ///< Internal q-pointer.
@@ -60,6 +202,8 @@ protected Q_SLOTS:
     void errorOccurred(const QLowEnergyService::ServiceError newError);
     virtual void serviceDiscovered(const QBluetoothUuid &newService);
     void stateChanged(QLowEnergyService::ServiceState newState);
+    void notified(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
+    void valueRead(const QLowEnergyCharacteristic &characteristic, const QByteArray &value);
 
     virtual void characteristicRead(const QLowEnergyCharacteristic &characteristic,
                                     const QByteArray &value);
@@ -0,0 +1,470 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the AsyncLogHandler class.
+ */
+
+#include <qtpokit/asyncloghandler.h>
+#include <qtpokit/pokittrace.h>
+#include "../stringliterals_p.h"
+
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class AsyncLogHandler
+ *
+ * The AsyncLogHandler class provides an optional Qt message handler (see qInstallMessageHandler()) that formats, and
+ * writes, log messages on a background thread, so that verbose logging (such as the library's `pokit.*` debug
+ * categories, while diagnosing a problem in the field) does not stall the threads doing the logging, such as those
+ * handling BLE notifications.
+ *
+ * Logging threads only capture each message, along with its context, the time, and the logging thread's ID, into a
+ * fixed-capacity, lock-free, multi-producer queue. If the queue is full (because the background thread cannot keep
+ * up), the new message is dropped, rather than the logging thread kept waiting, and counted via Statistics::dropped.
+ * The background thread then formats each message via qFormatLogMessage() (so according to qSetMessagePattern()),
+ * and writes them, coalesced, to stderr (or Settings::stream).
+ *
+ * Since messages are formatted on the background thread, any `%{time}`, `%{threadid}` or `%{backtrace}` in the
+ * message pattern would describe the background thread, not the logging thread, at the time of formatting. Instead,
+ * Settings::prefixContext prefixes each message with the time (in seconds since install(), as per `%{time process}`)
+ * and thread ID captured when the message was logged.
+ *
+ * Optionally, Settings::rateLimit limits each logging category to a maximum number of messages per second, with
+ * any excess counted via Statistics::suppressed, and noted (per category) once the next second's first message
+ * arrives. Critical messages are never rate-limited. Fatal messages are never queued: they are written directly, once
+ * all earlier messages have been written, since Qt aborts the application as soon as the handler returns.
+ *
+ * Categories are told apart by their name's address, rather than its content, which suffices for categories declared
+ * via Q_LOGGING_CATEGORY (whose names are string literals), and keeps the rate limiting lock-free.
+ */
+
+/// \cond internal
+namespace {
+
+constexpr int categoryCount { 256 };    ///< Maximum number of categories individually rate-limited.
+constexpr int chunkSize { 64 * 1024 };  ///< Maximum bytes coalesced into each write by the background thread.
+
+/// A single message, as captured by the logging thread.
+struct Message {
+    QtMsgType type { QtDebugMsg };     ///< Type of message.
+    const char * category { nullptr }; ///< Name of the message's logging category.
+    const char * file { nullptr };     ///< Source file the message was logged from, if known.
+    const char * function { nullptr }; ///< Function the message was logged from, if known.
+    int line { 0 };                    ///< Source line the message was logged from, if known.
+    qint64 time { 0 };                 ///< Time the message was logged, in nanoseconds since install().
+    Qt::HANDLE thread { nullptr };     ///< ID of the thread that logged the message.
+    QString text;                      ///< The message itself.
+};
+
+/// A single queued message, and the position it was most recently written at, or is next writable at.
+struct Slot {
+    std::atomic<quint64> sequence { 0 }; ///< Position of #message, plus one if readable.
+    Message message;                     ///< Message most recently queued in this slot.
+};
+
+/// Rate-limiting state of a single logging category.
+struct Category {
+    std::atomic<const char *> name { nullptr }; ///< Name of the category, or \c nullptr if this entry is unused.
+    std::atomic<qint64> window { -1 };          ///< Second (since install()) the #count applies to.
+    std::atomic<quint32> count { 0 };           ///< Number of messages logged in the current #window.
+    std::atomic<quint64> suppressed { 0 };      ///< Number of messages suppressed since the last note thereof.
+};
+
+/// An installed handler's state, shared by the logging threads, and the background thread.
+struct State {
+    explicit State(const AsyncLogHandler::Settings &settings)
+        : settings(settings), stream((settings.stream == nullptr) ? stderr : settings.stream),
+          capacity(std::max(settings.capacity, 1u)), slots(new Slot[capacity]),
+          start(std::chrono::steady_clock::now())
+    {
+        for (quint32 index = 0; index < capacity; ++index) {
+            slots[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    const AsyncLogHandler::Settings settings;          ///< Settings given to install().
+    FILE * const stream;                               ///< Stream to write messages to.
+    const quint32 capacity;                            ///< Maximum number of messages queued at once.
+    std::unique_ptr<Slot[]> slots;                     ///< Storage for queued messages.
+    const std::chrono::steady_clock::time_point start; ///< Time of install().
+    Category categories[categoryCount];                ///< Rate-limiting state, by (hashed) category.
+    QtMessageHandler previous { nullptr };             ///< Handler to restore on uninstall().
+
+    alignas(64) std::atomic<quint64> writePosition { 0 }; ///< Position of the next message, claimed by loggers.
+    alignas(64) quint64 readPosition { 0 };               ///< Position of the next message, for the background thread.
+    std::atomic<quint64> flushed { 0 };                   ///< Position up to which all messages have been written.
+
+    std::atomic<quint64> queued { 0 };     ///< Statistics::queued.
+    std::atomic<quint64> written { 0 };    ///< Statistics::written.
+    std::atomic<quint64> dropped { 0 };    ///< Statistics::dropped.
+    std::atomic<quint64> suppressed { 0 }; ///< Statistics::suppressed.
+
+    std::atomic<bool> sleeping { false }; ///< Whether the background thread is (about to be) waiting for #wake.
+    std::mutex mutex;                     ///< Guards #stopping, and waits on #wake (only while idle).
+    std::condition_variable wake;         ///< Signals the background thread that messages are queued, or to stop.
+    bool stopping { false };              ///< Whether the background thread should stop, once the queue is empty.
+    std::thread thread;                   ///< The background thread.
+
+    /// Returns the time since install(), in nanoseconds.
+    qint64 elapsed() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+std::mutex installMutex;                    ///< Serialises install(), uninstall(), and the like.
+std::atomic<State *> active { nullptr };    ///< The installed handler's state, if any.
+std::atomic<int> producers { 0 };           ///< Number of threads currently within handle().
+AsyncLogHandler::Statistics lastStatistics; ///< Statistics of the most recently uninstalled handler.
+
+/// Returns \a state's statistics.
+AsyncLogHandler::Statistics statisticsOf(const State &state)
+{
+    return {
+        state.queued.load(std::memory_order_relaxed),
+        state.written.load(std::memory_order_relaxed),
+        state.dropped.load(std::memory_order_relaxed),
+        state.suppressed.load(std::memory_order_relaxed),
+    };
+}
+
+/// Wakes \a state's background thread, if it is waiting.
+void wakeConsumer(State &state)
+{
+    if (state.sleeping.exchange(false)) {
+        const std::lock_guard<std::mutex> lock(state.mutex);
+        state.wake.notify_one();
+    }
+}
+
+/*!
+ * Queues \a message for \a state's background thread, and returns \c true, or counts it as dropped, and returns
+ * \c false, if the queue is full. Safe to call from any number of threads at once.
+ */
+bool enqueue(State &state, Message &&message)
+{
+    quint64 position = state.writePosition.load(std::memory_order_relaxed);
+    Slot * slot = nullptr;
+    for (;;) {
+        slot = &state.slots[position % state.capacity];
+        const qint64 difference = (qint64)(slot->sequence.load(std::memory_order_acquire) - position);
+        if (difference == 0) {
+            // The slot is free for this position; claim it, unless another thread beat us to it.
+            if (state.writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The slot still holds the message from a lap ago, so the queue is full.
+            state.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = state.writePosition.load(std::memory_order_relaxed); // Claimed by another thread already.
+        }
+    }
+    slot->message = std::move(message);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    state.queued.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the background thread's, before it sleeps.
+    wakeConsumer(state);
+    return true;
+}
+
+/*!
+ * Returns \c true if \a state's next message is ready for the background thread. Must only be called by that thread.
+ */
+bool isReady(const State &state)
+{
+    return state.slots[state.readPosition % state.capacity].sequence.load(std::memory_order_acquire)
+        == state.readPosition + 1;
+}
+
+/*!
+ * Moves \a state's next message into \a message, and returns \c true, or returns \c false if no message is ready.
+ * Must only be called by the background thread.
+ */
+bool dequeue(State &state, Message &message)
+{
+    if (!isReady(state)) {
+        return false;
+    }
+    Slot &slot = state.slots[state.readPosition % state.capacity];
+    message = std::move(slot.message);
+    slot.message.text = QString(); // Release the text now, rather than a lap later.
+    slot.sequence.store(state.readPosition + state.capacity, std::memory_order_release);
+    ++state.readPosition;
+    return true;
+}
+
+/*!
+ * Returns \a message formatted (via qFormatLogMessage()) for writing, optionally with a \a prefixContext, or an empty
+ * array if the message pattern omits the message entirely.
+ */
+QByteArray format(const Message &message, const bool prefixContext)
+{
+    const QMessageLogContext context(message.file, message.line, message.function, message.category);
+    const QString formatted = qFormatLogMessage(message.type, context, message.text);
+    if (formatted.isNull()) {
+        return QByteArray(); // As per Qt's own handlers.
+    }
+    QString line;
+    if (prefixContext) {
+        const qint64 milliseconds = message.time / 1000000;
+        line = QString::asprintf("%6lld.%03lld 0x%llx ", (long long)(milliseconds / 1000),
+                                 (long long)(milliseconds % 1000), (unsigned long long)(quintptr)message.thread);
+    }
+    line += formatted;
+    line += u'\n';
+    return line.toLocal8Bit();
+}
+
+/// Writes \a bytes to \a stream, and flushes it.
+void write(FILE * const stream, const QByteArray &bytes)
+{
+    if (!bytes.isEmpty()) {
+        std::fwrite(bytes.constData(), 1, (size_t)bytes.size(), stream);
+        std::fflush(stream);
+    }
+}
+
+/*!
+ * Runs \a state's background thread, until told to stop, and the queue is empty.
+ */
+void run(State * const state)
+{
+    QTPOKIT_TRACE_THREAD_NAME("asyncLogHandler");
+    QByteArray chunk;
+    chunk.reserve(chunkSize);
+    Message message;
+    for (;;) {
+        // Format, and coalesce, as many messages as are ready into one write.
+        quint64 count = 0;
+        while ((chunk.size() < chunkSize) && (dequeue(*state, message))) {
+            chunk.append(format(message, state->settings.prefixContext));
+            ++count;
+        }
+        write(state->stream, chunk);
+        chunk.resize(0); // Unlike clear(), retains the reserved capacity.
+        state->written.fetch_add(count, std::memory_order_relaxed);
+        state->flushed.store(state->readPosition, std::memory_order_release);
+        if (count > 0) {
+            continue;
+        }
+
+        // Nothing was ready, so wait for a logging thread to wake us (which only they need lock for).
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with enqueue()'s, after it queues a message.
+        if (isReady(*state)) {
+            state->sleeping.store(false);
+            continue;
+        }
+        if (state->stopping) {
+            return;
+        }
+        state->wake.wait(lock, [state]() { return (!state->sleeping.load()) || (state->stopping); });
+        state->sleeping.store(false);
+    }
+}
+
+/*!
+ * Waits for \a state's background thread to have written all messages queued so far. Must not be called by the
+ * background thread itself.
+ */
+void drain(State &state)
+{
+    const quint64 target = state.writePosition.load();
+    wakeConsumer(state);
+    while (state.flushed.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        wakeConsumer(state); // In case the last message's writer was still publishing it when we first woke it.
+    }
+}
+
+/*!
+ * Returns \a state's rate-limiting entry for the category called \a name, or \c nullptr if there is no room for a
+ * new entry. Safe to call from any number of threads at once.
+ */
+Category * categoryOf(State &state, const char * const name)
+{
+    const quintptr start = ((quintptr)name >> 3) % categoryCount;
+    for (int probe = 0; probe < categoryCount; ++probe) {
+        Category &category = state.categories[(start + probe) % categoryCount];
+        const char * key = category.name.load(std::memory_order_acquire);
+        if ((key == nullptr) && (category.name.compare_exchange_strong(key, name, std::memory_order_acq_rel))) {
+            return &category;
+        }
+        if (key == name) {
+            return &category;
+        }
+    }
+    return nullptr;
+}
+
+/*!
+ * Returns \c true if a message of the category called \a name, logged at \a time, is within \a state's rate limit,
+ * otherwise counts it as suppressed, and returns \c false.
+ *
+ * The first message each second (of a category with messages suppressed during an earlier second) also queues a note
+ * of how many were suppressed.
+ */
+bool admit(State &state, const char * const name, const qint64 time)
+{
+    Category * const category = categoryOf(state, name);
+    if (category == nullptr) {
+        return true; // Too many categories to track, so this one is not rate-limited.
+    }
+    const qint64 second = time / 1000000000;
+    qint64 window = category->window.load(std::memory_order_relaxed);
+    if ((window < second) && (category->window.compare_exchange_strong(window, second))) {
+        category->count.store(0, std::memory_order_relaxed);
+        if (const quint64 suppressed = category->suppressed.exchange(0); suppressed > 0) {
+            Message note;
+            note.type = QtWarningMsg;
+            note.category = name;
+            note.time = time;
+            note.thread = QThread::currentThreadId();
+            const int count = (int)std::min<quint64>(suppressed, std::numeric_limits<int>::max());
+            note.text = AsyncLogHandler::tr("Suppressed %n message(s), exceeding the limit of %1 per second.",
+                                            nullptr, count).arg(state.settings.rateLimit);
+            enqueue(state, std::move(note));
+        }
+    }
+    if (category->count.fetch_add(1, std::memory_order_relaxed) < state.settings.rateLimit) {
+        return true;
+    }
+    category->suppressed.fetch_add(1, std::memory_order_relaxed);
+    state.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+/*!
+ * Handles a single message, as installed via qInstallMessageHandler(). Safe to call from any number of threads at
+ * once, as Qt does.
+ */
+void handle(const QtMsgType type, const QMessageLogContext &context, const QString &text)
+{
+    producers.fetch_add(1);
+    State * const state = active.load();
+    Message message{ type, (context.category == nullptr) ? "default" : context.category, context.file,
+                     context.function, context.line, 0, QThread::currentThreadId(), text };
+    if (state == nullptr) {
+        // uninstall() has begun, after Qt had already called us, so just write the message directly.
+        producers.fetch_sub(1);
+        write(stderr, format(message, false));
+        return;
+    }
+    message.time = state->elapsed();
+
+    if (type == QtFatalMsg) {
+        // Qt aborts the application as soon as we return, so write the message now, after those already queued.
+        if (std::this_thread::get_id() != state->thread.get_id()) {
+            drain(*state);
+        }
+        write(state->stream, format(message, state->settings.prefixContext));
+    } else if ((state->settings.rateLimit == 0) || (type == QtCriticalMsg) ||
+               (admit(*state, message.category, message.time))) {
+        enqueue(*state, std::move(message));
+    }
+    producers.fetch_sub(1);
+}
+
+}
+/// \endcond
+
+/*!
+ * Installs the handler, with \a settings, in place of the current Qt message handler, and starts its background
+ * thread. Returns \c true on success, or \c false if the handler is already installed.
+ */
+bool AsyncLogHandler::install(const Settings &settings)
+{
+    const std::lock_guard<std::mutex> lock(installMutex);
+    if (active.load() != nullptr) {
+        return false;
+    }
+    auto * const state = new State(settings);
+    state->thread = std::thread(&run, state);
+    active.store(state);
+    state->previous = qInstallMessageHandler(&handle);
+    return true;
+}
+
+/*!
+ * Returns \c true if the handler is currently installed, otherwise \c false.
+ */
+bool AsyncLogHandler::isInstalled()
+{
+    return active.load() != nullptr;
+}
+
+/*!
+ * Waits for all messages queued so far to have been written. Does nothing if the handler is not installed.
+ */
+void AsyncLogHandler::flush()
+{
+    const std::lock_guard<std::mutex> lock(installMutex);
+    if (State * const state = active.load(); state != nullptr) {
+        drain(*state);
+    }
+}
+
+/*!
+ * Returns the counts of messages handled by the installed handler, or if none is installed, by the most recently
+ * uninstalled handler, if any.
+ */
+AsyncLogHandler::Statistics AsyncLogHandler::statistics()
+{
+    const std::lock_guard<std::mutex> lock(installMutex);
+    const State * const state = active.load();
+    return (state == nullptr) ? lastStatistics : statisticsOf(*state);
+}
+
+/*!
+ * Restores the message handler that was current when install() was called, writes all queued messages, and stops
+ * the background thread. If any messages were dropped, or suppressed, a warning summarising them is then logged, via
+ * the restored handler. Returns \c true on success, or \c false if the handler was not installed.
+ *
+ * Applications should call this before exiting (such as via `std::atexit()`), so no queued messages are lost.
+ */
+bool AsyncLogHandler::uninstall()
+{
+    const std::lock_guard<std::mutex> lock(installMutex);
+    State * const state = active.load();
+    if (state == nullptr) {
+        return false;
+    }
+    qInstallMessageHandler(state->previous);
+    active.store(nullptr);
+    while (producers.load() > 0) {
+        std::this_thread::yield(); // Wait for any threads still queueing messages.
+    }
+    {
+        const std::lock_guard<std::mutex> stateLock(state->mutex);
+        state->stopping = true;
+    }
+    state->wake.notify_one();
+    state->thread.join();
+    lastStatistics = statisticsOf(*state);
+    delete state;
+
+    if ((lastStatistics.dropped > 0) || (lastStatistics.suppressed > 0)) {
+        qWarning().noquote() << tr("Asynchronous logging dropped %1 message(s), and suppressed %2.")
+            .arg(lastStatistics.dropped).arg(lastStatistics.suppressed);
+    }
+    return true;
+}
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,386 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the BatteryPolicy and BatteryPolicyPrivate classes.
+ */
+
+#include <qtpokit/batterypolicy.h>
+#include "batterypolicy_p.h"
+#include "../stringliterals_p.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class BatteryPolicy
+ *
+ * The BatteryPolicy class trades measurement throughput against battery runtime, by recommending how often, and over
+ * what kind of connection, to take readings, according to a device's battery level and charging state.
+ *
+ * Each status (typically from StatusService::deviceStatusRead) places the battery at one of three budget levels:
+ *
+ * - Level::Normal, while the battery is healthy, or charging (or charged), in which case readings are recommended at
+ *   baseInterval(), over the default connection profile.
+ * - Level::Conserve, once the battery voltage drops below conserveVoltage(), in which case readings are recommended at
+ *   conserveFactor() times baseInterval(), over a low power connection.
+ * - Level::Critical, once the battery voltage drops below criticalVoltage(), or the device itself reports its battery
+ *   as low, in which case readings are recommended at maximumInterval(), over a low power connection, and on-device
+ *   logging (with periodic harvesting) is preferred to live readings, where the application supports that.
+ *
+ * The recommended interval never exceeds maximumInterval() (if set), which is the caller's minimum acceptable data
+ * rate, nor drops below baseInterval(). To avoid flapping between levels, the battery voltage must rise more than
+ * hysteresis() above a level's threshold to leave that level again.
+ *
+ * The thresholds default to none, since suitable voltages depend on the device's battery chemistry, in which case only
+ * the device's own battery status is considered (that is, the battery is either normal, or critical).
+ *
+ * Note, this class does not read (or enable notifications of) the device's status itself, since the service may be
+ * shared with other users, which may already do so.
+ */
+
+/// Returns \a level as a (non-translated) string, suitable for machine-readable output.
+QString BatteryPolicy::toString(const Level level)
+{
+    switch (level) {
+    case Level::Normal:   return u"Normal"_s;
+    case Level::Conserve: return u"Conserve"_s;
+    case Level::Critical: return u"Critical"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Constructs a new BatteryPolicy object that takes statuses from \a service, with \a parent.
+ *
+ * \a service may be \c nullptr, in which case statuses may be added via addStatus() instead.
+ */
+BatteryPolicy::BatteryPolicy(StatusService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new BatteryPolicyPrivate(this))
+{
+    Q_D(BatteryPolicy);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new BatteryPolicy object with \a service, \a parent, and private implementation \a d.
+ */
+BatteryPolicy::BatteryPolicy(BatteryPolicyPrivate * const d, StatusService * const service, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service);
+}
+/// \endcond
+
+/*!
+ * Destroys this BatteryPolicy object.
+ */
+BatteryPolicy::~BatteryPolicy()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the status service this object takes statuses from.
+ */
+StatusService * BatteryPolicy::service() const
+{
+    Q_D(const BatteryPolicy);
+    return d->service;
+}
+
+/*!
+ * Returns the interval between readings recommended while the battery is healthy, in milliseconds.
+ */
+quint32 BatteryPolicy::baseInterval() const
+{
+    Q_D(const BatteryPolicy);
+    return d->baseInterval;
+}
+
+/*!
+ * Sets the interval between readings recommended while the battery is healthy to \a interval milliseconds, which
+ * would typically be the interval the application was asked to measure at. The default is 1,000ms.
+ */
+void BatteryPolicy::setBaseInterval(const quint32 interval)
+{
+    Q_D(BatteryPolicy);
+    d->baseInterval = interval;
+    d->update();
+}
+
+/*!
+ * Returns the longest acceptable interval between readings, in milliseconds, or 0 if there is no limit.
+ */
+quint32 BatteryPolicy::maximumInterval() const
+{
+    Q_D(const BatteryPolicy);
+    return d->maximumInterval;
+}
+
+/*!
+ * Sets the longest acceptable interval between readings (that is, the minimum acceptable data rate) to \a interval
+ * milliseconds. The default is 0, in which case the critical interval is conserveFactor() squared times baseInterval().
+ */
+void BatteryPolicy::setMaximumInterval(const quint32 interval)
+{
+    Q_D(BatteryPolicy);
+    d->maximumInterval = interval;
+    d->update();
+}
+
+/*!
+ * Returns the multiple of baseInterval() recommended while conserving the battery.
+ */
+float BatteryPolicy::conserveFactor() const
+{
+    Q_D(const BatteryPolicy);
+    return d->conserveFactor;
+}
+
+/*!
+ * Sets the multiple of baseInterval() recommended while conserving the battery to \a factor. The default is 4. Values
+ * less than 1 (and non-finite values) are treated as 1.
+ */
+void BatteryPolicy::setConserveFactor(const float factor)
+{
+    Q_D(BatteryPolicy);
+    d->conserveFactor = (qIsFinite(factor)) ? qMax(factor, 1.0f) : 1.0f;
+    d->update();
+}
+
+/*!
+ * Returns the battery voltage below which the battery is conserved, or NaN if none (the default).
+ */
+float BatteryPolicy::conserveVoltage() const
+{
+    Q_D(const BatteryPolicy);
+    return d->conserveVoltage;
+}
+
+/*!
+ * Sets the battery voltage below which the battery is conserved to \a voltage. Non-positive (and non-finite) values
+ * clear the threshold.
+ */
+void BatteryPolicy::setConserveVoltage(const float voltage)
+{
+    Q_D(BatteryPolicy);
+    d->conserveVoltage = ((qIsFinite(voltage)) && (voltage > 0.0f)) ? voltage : std::numeric_limits<float>::quiet_NaN();
+    d->update();
+}
+
+/*!
+ * Returns the battery voltage below which the battery is critical, or NaN if none (the default), in which case the
+ * battery is only critical when the device itself reports its battery as low.
+ */
+float BatteryPolicy::criticalVoltage() const
+{
+    Q_D(const BatteryPolicy);
+    return d->criticalVoltage;
+}
+
+/*!
+ * Sets the battery voltage below which the battery is critical to \a voltage. Non-positive (and non-finite) values
+ * clear the threshold.
+ */
+void BatteryPolicy::setCriticalVoltage(const float voltage)
+{
+    Q_D(BatteryPolicy);
+    d->criticalVoltage = ((qIsFinite(voltage)) && (voltage > 0.0f)) ? voltage : std::numeric_limits<float>::quiet_NaN();
+    d->update();
+}
+
+/*!
+ * Returns the voltage, in volts, that the battery must rise above a level's threshold to leave that level.
+ */
+float BatteryPolicy::hysteresis() const
+{
+    Q_D(const BatteryPolicy);
+    return d->hysteresis;
+}
+
+/*!
+ * Sets the threshold hysteresis to \a hysteresis volts. The default is 0.05 volts. Negative values are treated as 0.
+ */
+void BatteryPolicy::setHysteresis(const float hysteresis)
+{
+    Q_D(BatteryPolicy);
+    d->hysteresis = qMax(hysteresis, 0.0f);
+}
+
+/*!
+ * Returns the most recently added status, if any.
+ */
+std::optional<StatusService::Status> BatteryPolicy::lastStatus() const
+{
+    Q_D(const BatteryPolicy);
+    return d->lastStatus;
+}
+
+/*!
+ * Returns the battery budget level, as of the most recently added status, or Level::Normal if none.
+ */
+BatteryPolicy::Level BatteryPolicy::level() const
+{
+    Q_D(const BatteryPolicy);
+    return d->level;
+}
+
+/*!
+ * Returns the measurement parameters recommended for the current level().
+ */
+BatteryPolicy::Decision BatteryPolicy::decision() const
+{
+    Q_D(const BatteryPolicy);
+    return d->decide(d->level);
+}
+
+/*!
+ * Considers \a status, emitting decisionChanged if the recommended measurement parameters change as a result.
+ *
+ * Statuses from service() are added automatically. This slot allows statuses from other sources to be considered too.
+ */
+void BatteryPolicy::addStatus(const StatusService::Status &status)
+{
+    Q_D(BatteryPolicy);
+    d->level = d->levelFor(status);
+    d->lastStatus = status;
+    d->update();
+}
+
+/*!
+ * Forgets all statuses added, returning to Level::Normal, without emitting decisionChanged.
+ */
+void BatteryPolicy::reset()
+{
+    Q_D(BatteryPolicy);
+    d->lastStatus.reset();
+    d->level = Level::Normal;
+    d->decision = d->decide(d->level);
+}
+
+/*!
+ * \fn BatteryPolicy::decisionChanged
+ *
+ * This signal is emitted when the recommended measurement parameters change to \a decision, either because the battery
+ * budget level has changed, or because the policy's settings have.
+ */
+
+/*!
+ * \cond internal
+ * \class BatteryPolicyPrivate
+ *
+ * The BatteryPolicyPrivate class provides private implementation for BatteryPolicy.
+ */
+
+/*!
+ * Constructs a new BatteryPolicyPrivate object with public implementation \a q.
+ */
+BatteryPolicyPrivate::BatteryPolicyPrivate(BatteryPolicy * const q) : q_ptr(q)
+{
+    decision = decide(level);
+}
+
+/*!
+ * Sets \a newService as the status service to take statuses from, disconnecting from any previous service.
+ */
+void BatteryPolicyPrivate::setService(StatusService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &StatusService::deviceStatusRead, this, [this](const StatusService::Status &status) {
+            q_ptr->addStatus(status);
+        });
+    }
+}
+
+/*!
+ * Returns the battery budget level for \a status, allowing for hysteresis from the current #level.
+ */
+BatteryPolicy::Level BatteryPolicyPrivate::levelFor(const StatusService::Status &status) const
+{
+    if ((status.chargingStatus) && (*status.chargingStatus != StatusService::ChargingStatus::Discharging)) {
+        return BatteryPolicy::Level::Normal; // Charging, or charged, so no need to conserve.
+    }
+    if (status.batteryStatus == StatusService::BatteryStatus::Low) {
+        return BatteryPolicy::Level::Critical;
+    }
+
+    // Returns true if the voltage is below threshold, or (if already below it) not yet recovered above it. An unknown
+    // voltage is neither below, nor recovered above, the threshold, so leaves the current level unchanged.
+    const auto isBelow = [&status, this](const float threshold, const BatteryPolicy::Level thresholdLevel) {
+        if (!qIsFinite(threshold)) {
+            return false;
+        }
+        if (!qIsFinite(status.batteryVoltage)) {
+            return (level >= thresholdLevel);
+        }
+        return (level >= thresholdLevel) ? !(status.batteryVoltage > threshold + hysteresis)
+                                         : (status.batteryVoltage < threshold);
+    };
+    if (isBelow(criticalVoltage, BatteryPolicy::Level::Critical)) {
+        return BatteryPolicy::Level::Critical;
+    }
+    if (isBelow(conserveVoltage, BatteryPolicy::Level::Conserve)) {
+        return BatteryPolicy::Level::Conserve;
+    }
+    return BatteryPolicy::Level::Normal;
+}
+
+/*!
+ * Returns the measurement parameters recommended for \a level, given the current settings.
+ */
+BatteryPolicy::Decision BatteryPolicyPrivate::decide(const BatteryPolicy::Level level) const
+{
+    BatteryPolicy::Decision result;
+    result.level = level;
+    result.updateInterval = baseInterval;
+    if (level == BatteryPolicy::Level::Normal) {
+        return result;
+    }
+
+    double interval = (double)baseInterval * conserveFactor;
+    if (level == BatteryPolicy::Level::Critical) {
+        interval = (maximumInterval > 0) ? (double)maximumInterval : interval * conserveFactor;
+    }
+    if (maximumInterval > 0) {
+        interval = qMin(interval, (double)maximumInterval);
+    }
+    interval = qMin(std::ceil(interval), (double)std::numeric_limits<quint32>::max());
+    result.updateInterval = qMax(baseInterval, (quint32)interval);
+    result.connectionProfile = PokitDevice::ConnectionProfile::LowPower;
+    result.preferLogging = (level == BatteryPolicy::Level::Critical);
+    return result;
+}
+
+/*!
+ * Updates the current #decision, emitting BatteryPolicy::decisionChanged if it has changed.
+ */
+void BatteryPolicyPrivate::update()
+{
+    const BatteryPolicy::Decision newDecision = decide(level);
+    if ((newDecision.level == decision.level) && (newDecision.updateInterval == decision.updateInterval) &&
+        (newDecision.connectionProfile == decision.connectionProfile) &&
+        (newDecision.preferLogging == decision.preferLogging)) {
+        return;
+    }
+    decision = newDecision;
+    Q_Q(BatteryPolicy);
+    Q_EMIT q->decisionChanged(decision);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
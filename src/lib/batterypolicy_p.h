@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the BatteryPolicyPrivate class.
+ */
+
+#ifndef QTPOKIT_BATTERYPOLICY_P_H
+#define QTPOKIT_BATTERYPOLICY_P_H
+
+#include <qtpokit/batterypolicy.h>
+
+#include <QObject>
+
+#include <limits>
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT BatteryPolicyPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    StatusService * service { nullptr }; ///< Status service to take statuses from.
+    quint32 baseInterval { 1000 };       ///< Interval between readings when the battery is healthy, in milliseconds.
+    quint32 maximumInterval { 0 };       ///< Longest acceptable interval between readings, in milliseconds, or 0.
+    float conserveFactor { 4.0f };       ///< Multiple of #baseInterval to measure at when conserving the battery.
+    float conserveVoltage { std::numeric_limits<float>::quiet_NaN() }; ///< Voltage to start conserving below, if any.
+    float criticalVoltage { std::numeric_limits<float>::quiet_NaN() }; ///< Voltage that is critical below, if any.
+    float hysteresis { 0.05f };          ///< Voltage above a threshold needed to return to the previous level.
+    std::optional<StatusService::Status> lastStatus; ///< Most recently added status, if any.
+    BatteryPolicy::Level level { BatteryPolicy::Level::Normal }; ///< Battery budget level, as of #lastStatus.
+    BatteryPolicy::Decision decision;    ///< Most recently reported (or initial) decision.
+
+    explicit BatteryPolicyPrivate(BatteryPolicy * const q);
+
+    void setService(StatusService * const newService);
+
+    BatteryPolicy::Level levelFor(const StatusService::Status &status) const;
+    BatteryPolicy::Decision decide(const BatteryPolicy::Level level) const;
+    void update();
+
+protected:
+    BatteryPolicy * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(BatteryPolicy)
+    Q_DISABLE_COPY(BatteryPolicyPrivate)
+    QTPOKIT_BEFRIEND_TEST(BatteryPolicy)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_BATTERYPOLICY_P_H
@@ -7,9 +7,9 @@
  */
 
 #include <qtpokit/calibrationservice.h>
+#include <pokitcodec/pokitcodec.h>
 #include "calibrationservice_p.h"
-
-#include <QtEndian>
+#include "characteristiclayout_p.h"
 
 QTPOKIT_BEGIN_NAMESPACE
 
@@ -64,7 +64,7 @@ bool CalibrationService::readCharacteristics()
 bool CalibrationService::calibrateTemperature(const float ambientTemperature)
 {
     static_assert(sizeof(float) == 4, "Pokit devices expect 32-bit floats");
-    Q_D(const CalibrationService);
+    Q_D(CalibrationService);
     const QLowEnergyCharacteristic characteristic =
         d->getCharacteristic(CharacteristicUuids::temperature);
     if (!characteristic.isValid()) {
@@ -74,8 +74,7 @@ bool CalibrationService::calibrateTemperature(const float ambientTemperature)
     const QByteArray newValue = CalibrationServicePrivate::encodeTemperature(ambientTemperature);
     qCDebug(d->lc).noquote() << tr("Writing new temperature %1 (0x%2).")
         .arg(ambientTemperature).arg(QLatin1String(newValue.toHex()));
-    d->service->writeCharacteristic(characteristic, newValue);
-    return (d->service->error() != QLowEnergyService::ServiceError::CharacteristicWriteError);
+    return d->writeCharacteristic(characteristic.uuid(), newValue);
 }
 
 /*!
@@ -110,10 +109,9 @@ CalibrationServicePrivate::CalibrationServicePrivate(
  */
 QByteArray CalibrationServicePrivate::encodeTemperature(const float value)
 {
-    static_assert(sizeof(value) == 4, "Pokit devices expect 32-bit floats");
-    QByteArray bytes(sizeof(float), '\0');
-    qToLittleEndian<float>(value, bytes.data());
-    return bytes;
+    std::array<std::byte, PokitCodec::Calibration::temperatureSize> bytes{};
+    PokitCodec::Calibration::encodeTemperature(value, bytes);
+    return CharacteristicLayout::toByteArray(bytes.data(), bytes.size());
 }
 
 /*!
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the CharacteristicLayout namespace, for describing the byte layouts of Pokit characteristics.
+ */
+
+#ifndef QTPOKIT_CHARACTERISTICLAYOUT_P_H
+#define QTPOKIT_CHARACTERISTICLAYOUT_P_H
+
+#include <qtpokit/qtpokit_global.h>
+#include <pokitcodec/characteristiclayout.h>
+
+#include <QByteArray>
+
+#include <cstddef>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// \cond internal
+
+/*!
+ * Compile-time descriptions of the (little-endian, packed) byte layouts of Pokit characteristics.
+ *
+ * This is a thin layer over PokitCodec::CharacteristicLayout (which has no Qt dependencies), adding conversion of
+ * encoded layouts to QByteArray. Fields are described, and gathered into Layouts, exactly as for the underlying
+ * namespace. For example:
+ *
+ * \code
+ * namespace ReadingLayout {
+ *     using Status = CharacteristicLayout::Field<MultimeterService::MeterStatus>;
+ *     using Value  = CharacteristicLayout::Field<float, Status>;
+ *     using Layout = CharacteristicLayout::Layout<Status, Value>;
+ *     static_assert(Layout::size == 5);
+ * }
+ * \endcode
+ *
+ * Layout::write then encodes fields into a fixed-size Layout::Buffer (with no allocations, or growing), while
+ * Layout::read decodes fields in place, direct from a value's constData().
+ */
+namespace CharacteristicLayout {
+
+using PokitCodec::CharacteristicLayout::Start;
+using PokitCodec::CharacteristicLayout::Field;
+using PokitCodec::CharacteristicLayout::Bytes;
+
+/*!
+ * Returns a read-only PokitCodec::ByteSpan over \a value's bytes, for decoding (in place) via the PokitCodec functions.
+ */
+inline PokitCodec::ByteSpan toByteSpan(const QByteArray &value)
+{
+    return PokitCodec::ByteSpan(reinterpret_cast<const std::byte *>(value.constData()), (std::size_t)value.size());
+}
+
+/*!
+ * Returns a copy of the \a size bytes beginning at \a data, such as an encoded PokitCodec value, as a QByteArray.
+ */
+inline QByteArray toByteArray(const std::byte * const data, const std::size_t size)
+{
+    return QByteArray(reinterpret_cast<const char *>(data), (int)size);
+}
+
+/*!
+ * The layout of a characteristic made up of \a Fields, in order.
+ *
+ * \see PokitCodec::CharacteristicLayout::Layout
+ */
+template<typename... Fields>
+struct Layout : PokitCodec::CharacteristicLayout::Layout<Fields...>
+{
+    using typename PokitCodec::CharacteristicLayout::Layout<Fields...>::Buffer;
+
+    /*!
+     * Returns a copy of \a buffer, as a QByteArray.
+     */
+    static QByteArray toByteArray(const Buffer &buffer)
+    {
+        return CharacteristicLayout::toByteArray(buffer.data(), buffer.size());
+    }
+};
+
+} // namespace CharacteristicLayout
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_CHARACTERISTICLAYOUT_P_H
@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the ChargeIntegrator and ChargeIntegratorPrivate classes.
+ */
+
+#include <qtpokit/chargeintegrator.h>
+#include "chargeintegrator_p.h"
+
+#include <QtMath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// Number of milliseconds per hour, for converting amp-milliseconds to amp-hours.
+static constexpr double millisecondsPerHour { 3'600'000.0 };
+
+/*!
+ * \class ChargeIntegrator
+ *
+ * The ChargeIntegrator class counts the charge (ie coulombs, though reported in amp-hours) of a single stream of
+ * timestamped current samples, such as multimeter readings, or data logger samples, of a Pokit device in a current
+ * mode. Only the running totals are kept, so memory is constant, no matter how long the session, such as for
+ * multi-day battery discharge tests.
+ *
+ * Samples are integrated via the trapezoidal rule, using each sample's own timestamp (such as its time of arrival,
+ * for multimeter readings, or the timestamp implied by the logger's metadata, for logger samples), so samples need
+ * not be evenly spaced. Within a stream, samples must be added in timestamp order; samples not after the previous
+ * sample, and non-finite samples (such as from overloaded ranges), are ignored.
+ *
+ * If maximumGap() is non-zero, then any interval between samples longer than that is a gap (such as while a device
+ * was disconnected), which is integrated according to the gapPolicy(). By default, gaps are excluded, so the totals
+ * only ever include measured current. Either way, gaps are counted, so that totals may be judged accordingly.
+ *
+ * If period() is non-zero, then the running totals are emitted, via totalReady, once per period; that is, as each
+ * sample in a later period than the previous sample is added, before integrating that sample. Periods are aligned to
+ * multiples of period() since the epoch. The totals may also be emitted at any time via flush().
+ */
+
+/*!
+ * Constructs a new ChargeIntegrator object with \a parent.
+ */
+ChargeIntegrator::ChargeIntegrator(QObject * parent)
+    : QObject(parent), d_ptr(new ChargeIntegratorPrivate(this))
+{
+
+}
+
+/*!
+ * \cond internal
+ * Constructs a new ChargeIntegrator object with \a parent, and private implementation \a d.
+ */
+ChargeIntegrator::ChargeIntegrator(ChargeIntegratorPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this ChargeIntegrator object.
+ */
+ChargeIntegrator::~ChargeIntegrator()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the period, in milliseconds, at which running totals are emitted, or 0 (the default) if totals are only
+ * emitted via flush().
+ */
+quint32 ChargeIntegrator::period() const
+{
+    Q_D(const ChargeIntegrator);
+    return d->period;
+}
+
+/*!
+ * Sets the period at which running totals are emitted to \a period milliseconds, or 0 to only emit totals via flush().
+ */
+void ChargeIntegrator::setPeriod(const quint32 period)
+{
+    Q_D(ChargeIntegrator);
+    d->period = period;
+}
+
+/*!
+ * Returns the longest interval, in milliseconds, between samples that is not a gap, or 0 (the default) if no
+ * intervals are gaps.
+ */
+quint32 ChargeIntegrator::maximumGap() const
+{
+    Q_D(const ChargeIntegrator);
+    return d->maximumGap;
+}
+
+/*!
+ * Sets the longest interval between samples that is not a gap to \a gap milliseconds, or 0 for no gaps.
+ */
+void ChargeIntegrator::setMaximumGap(const quint32 gap)
+{
+    Q_D(ChargeIntegrator);
+    d->maximumGap = gap;
+}
+
+/*!
+ * Returns how gaps are integrated. The default is GapPolicy::Exclude.
+ */
+ChargeIntegrator::GapPolicy ChargeIntegrator::gapPolicy() const
+{
+    Q_D(const ChargeIntegrator);
+    return d->gapPolicy;
+}
+
+/*!
+ * Sets how gaps are integrated to \a policy.
+ */
+void ChargeIntegrator::setGapPolicy(const GapPolicy policy)
+{
+    Q_D(ChargeIntegrator);
+    d->gapPolicy = policy;
+}
+
+/*!
+ * Returns \c true if at least one sample has been added (since construction, or the last reset()).
+ */
+bool ChargeIntegrator::hasTotal() const
+{
+    Q_D(const ChargeIntegrator);
+    return d->total.count > 0;
+}
+
+/*!
+ * Returns the running totals, if hasTotal(), otherwise zeroed totals.
+ */
+ChargeIntegrator::Total ChargeIntegrator::total() const
+{
+    Q_D(const ChargeIntegrator);
+    return d->total;
+}
+
+/*!
+ * Adds a current sample of \a amps, taken at \a timestamp (in milliseconds since the epoch), first emitting
+ * totalReady if \a timestamp begins a new period().
+ */
+void ChargeIntegrator::addSample(const float amps, const qint64 timestamp)
+{
+    Q_D(ChargeIntegrator);
+    d->addSample(amps, timestamp);
+}
+
+/*!
+ * Emits totalReady, if the running totals have changed since they were last emitted.
+ */
+void ChargeIntegrator::flush()
+{
+    Q_D(ChargeIntegrator);
+    d->emitTotal();
+}
+
+/*!
+ * Discards the running totals, but not the period(), maximumGap() or gapPolicy(). The totals are not emitted first;
+ * call flush() before reset() for that.
+ */
+void ChargeIntegrator::reset()
+{
+    Q_D(ChargeIntegrator);
+    d->total = { 0, 0, 0, 0.0, 0.0, 0, 0, 0 };
+    d->previous = 0.0f;
+    d->ampMilliseconds = 0.0;
+    d->pending = false;
+}
+
+/*!
+ * \fn ChargeIntegrator::totalReady
+ *
+ * This signal is emitted with the running \a total, once per period(), and on flush().
+ */
+
+/*!
+ * \cond internal
+ * \class ChargeIntegratorPrivate
+ *
+ * The ChargeIntegratorPrivate class provides private implementation for ChargeIntegrator.
+ */
+
+/*!
+ * Constructs a new ChargeIntegratorPrivate object with public implementation \a q.
+ */
+ChargeIntegratorPrivate::ChargeIntegratorPrivate(ChargeIntegrator * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Integrates \a amps, taken at \a timestamp, from the previous sample, bridging (or excluding) the interval according
+ * to #gapPolicy if it is longer than #maximumGap.
+ */
+void ChargeIntegratorPrivate::addSample(const float amps, const qint64 timestamp)
+{
+    if (!qIsFinite(amps)) {
+        qCDebug(lc).noquote() << tr("Ignoring non-finite sample at %1.").arg(timestamp);
+        return;
+    }
+    if (total.count == 0) {
+        total.start = total.end = timestamp;
+        total.count = 1;
+        total.averageCurrent = amps; // Nothing integrated yet.
+        previous = amps;
+        pending = true;
+        return;
+    }
+    if (timestamp <= total.end) {
+        qCDebug(lc).noquote() << tr("Ignoring out-of-order sample at %1 (after %2).").arg(timestamp).arg(total.end);
+        return;
+    }
+    if ((period > 0) && ((timestamp / period) != (total.end / period))) {
+        emitTotal(); // The previous period's running totals.
+    }
+
+    const qint64 interval = timestamp - total.end;
+    if ((maximumGap > 0) && (interval > maximumGap)) {
+        ++total.gaps;
+        total.gapDuration += interval;
+        switch (gapPolicy) {
+        case ChargeIntegrator::GapPolicy::Exclude:
+            break;
+        case ChargeIntegrator::GapPolicy::Hold:
+            ampMilliseconds += (double)previous * (double)interval;
+            total.duration += interval;
+            break;
+        case ChargeIntegrator::GapPolicy::Interpolate:
+            ampMilliseconds += (previous + amps) / 2.0 * (double)interval;
+            total.duration += interval;
+            break;
+        }
+    } else {
+        ampMilliseconds += (previous + amps) / 2.0 * (double)interval;
+        total.duration += interval;
+    }
+
+    total.end = timestamp;
+    ++total.count;
+    total.charge = ampMilliseconds / millisecondsPerHour;
+    total.averageCurrent = (total.duration > 0) ? ampMilliseconds / (double)total.duration : (double)amps;
+    previous = amps;
+    pending = true;
+}
+
+/*!
+ * Emits the running #total, if it has changed since it was last emitted.
+ */
+void ChargeIntegratorPrivate::emitTotal()
+{
+    if (!pending) {
+        return;
+    }
+    pending = false;
+    Q_Q(ChargeIntegrator);
+    Q_EMIT q->totalReady(total);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the ChargeIntegratorPrivate class.
+ */
+
+#ifndef QTPOKIT_CHARGEINTEGRATOR_P_H
+#define QTPOKIT_CHARGEINTEGRATOR_P_H
+
+#include <qtpokit/chargeintegrator.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT ChargeIntegratorPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.charge.integrator", QtInfoMsg); ///< Logging category.
+
+    quint32 period { 0 };     ///< Period, in milliseconds, to emit running totals at, or 0 for only on flush.
+    quint32 maximumGap { 0 }; ///< Longest interval between samples that is not a gap, or 0 for no gaps.
+    ChargeIntegrator::GapPolicy gapPolicy { ChargeIntegrator::GapPolicy::Exclude }; ///< How to integrate gaps.
+
+    ChargeIntegrator::Total total { 0, 0, 0, 0.0, 0.0, 0, 0, 0 }; ///< Running totals.
+    float previous { 0.0f };        ///< Value of the latest sample, in amps.
+    double ampMilliseconds { 0.0 }; ///< Charge integrated so far, in amp-milliseconds.
+    bool pending { false };         ///< Whether #total has changed since it was last emitted.
+
+    explicit ChargeIntegratorPrivate(ChargeIntegrator * const q);
+
+    void addSample(const float amps, const qint64 timestamp);
+    void emitTotal();
+
+protected:
+    ChargeIntegrator * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(ChargeIntegrator)
+    Q_DISABLE_COPY(ChargeIntegratorPrivate)
+    QTPOKIT_BEFRIEND_TEST(ChargeIntegrator)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_CHARGEINTEGRATOR_P_H
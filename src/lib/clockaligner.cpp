@@ -0,0 +1,320 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the ClockAligner and ClockAlignerPrivate classes.
+ */
+
+#include <qtpokit/clockaligner.h>
+#include "clockaligner_p.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class ClockAligner
+ *
+ * The ClockAligner class places samples from many Pokit devices on a single, common, timeline, so that (for example)
+ * voltage measured by one device, and current measured by another, may be multiplied sample-by-sample.
+ *
+ * Each device's samples follow that device's own clock: Data Logger samples are some multiple of the logging interval
+ * after the session's Metadata::timestamp (see loggerSampleTime()), while multimeter readings (and DSO samples) have
+ * no device timestamp at all, but are still spaced by the device's own update (or sampling) interval, such that the
+ * Nth reading's device time is N times that interval. Neither is directly comparable with other devices' times.
+ *
+ * So for each device, addObservation() pairs device times with the host's hostTime() at which they were received. The
+ * aligner fits a linear model (offset and drift) to the most recent window() observations of each device, then
+ * lowers that line to the earliest-arriving observation, since transport latency only ever delays, never advances,
+ * a sample's arrival. toHostTime() then maps any device time onto the host's timeline, free of the (often tens of
+ * milliseconds of) jitter that BLE connection intervals add to raw arrival times. resample() optionally interpolates
+ * the aligned samples onto a grid shared by all devices.
+ *
+ * If a device's time ever goes backwards, such as for a new logging session, its previous observations are discarded.
+ */
+
+/*!
+ * Constructs a new ClockAligner object with \a parent.
+ */
+ClockAligner::ClockAligner(QObject * parent) : QObject(parent), d_ptr(new ClockAlignerPrivate(this))
+{
+
+}
+
+/*!
+ * \cond internal
+ * Constructs a new ClockAligner object with \a parent, and private implementation \a d.
+ */
+ClockAligner::ClockAligner(ClockAlignerPrivate * const d, QObject * const parent) : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this ClockAligner object.
+ */
+ClockAligner::~ClockAligner()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the maximum number of (most recent) observations each device's clock is fitted to. The default is 64.
+ */
+int ClockAligner::window() const
+{
+    Q_D(const ClockAligner);
+    return d->window;
+}
+
+/*!
+ * Sets the maximum number of (most recent) observations each device's clock is fitted to, to \a observations. Values
+ * less than 2 are treated as 2, the fewest able to estimate drift.
+ *
+ * Larger windows average out more jitter, and track drift over longer periods, but respond more slowly to changes
+ * (such as temperature-induced drift).
+ */
+void ClockAligner::setWindow(const int observations)
+{
+    Q_D(ClockAligner);
+    d->window = qMax(observations, 2);
+    for (auto iter = d->clocks.begin(); iter != d->clocks.end(); ++iter) {
+        if (iter->observations.size() > d->window) {
+            iter->observations.remove(0, iter->observations.size() - d->window);
+            d->fit(*iter);
+        }
+    }
+}
+
+/*!
+ * Returns the largest believable clock drift, in parts per million. The default is 1,000.
+ */
+double ClockAligner::maximumDrift() const
+{
+    Q_D(const ClockAligner);
+    return d->maximumDrift;
+}
+
+/*!
+ * Sets the largest believable clock drift to \a drift parts per million. Fitted drifts beyond this are clamped, which
+ * prevents jitter across the first few (closely spaced) observations from being mistaken for drift. Typical crystal
+ * oscillators are within 100 ppm, so the default of 1,000 ppm is generous.
+ */
+void ClockAligner::setMaximumDrift(const double drift)
+{
+    Q_D(ClockAligner);
+    d->maximumDrift = std::abs(drift);
+}
+
+/*!
+ * Returns the devices with at least one observation.
+ */
+QStringList ClockAligner::devices() const
+{
+    Q_D(const ClockAligner);
+    return d->clocks.keys();
+}
+
+/*!
+ * Returns \c true if \a device has at least one observation, \c false otherwise.
+ */
+bool ClockAligner::contains(const QString &device) const
+{
+    Q_D(const ClockAligner);
+    return d->clocks.contains(device);
+}
+
+/*!
+ * Returns the current estimate of \a device's clock, or an estimate with no observations if \a device has none.
+ */
+ClockAligner::Estimate ClockAligner::estimate(const QString &device) const
+{
+    Q_D(const ClockAligner);
+    const auto iter = d->clocks.constFind(device);
+    if (iter == d->clocks.constEnd()) {
+        return Estimate{};
+    }
+    const qint64 latest = iter->observations.last().deviceTime;
+    return Estimate{
+        qRound64(iter->offset + iter->rate * (double)(latest - iter->deviceReference)),
+        iter->rate * 1e6, (int)iter->observations.size()
+    };
+}
+
+/*!
+ * Returns \a deviceTime, of \a device's clock, mapped onto the host's hostTime() timeline, or \a deviceTime itself
+ * if \a device has no observations (yet).
+ */
+qint64 ClockAligner::toHostTime(const QString &device, const qint64 deviceTime) const
+{
+    Q_D(const ClockAligner);
+    const auto iter = d->clocks.constFind(device);
+    if (iter == d->clocks.constEnd()) {
+        return deviceTime;
+    }
+    return deviceTime + qRound64(iter->offset + iter->rate * (double)(deviceTime - iter->deviceReference));
+}
+
+/*!
+ * Returns the host's current steady clock time, in milliseconds.
+ *
+ * The steady clock is anchored to the wall clock (ie milliseconds since the epoch) when first used, so its times are
+ * directly comparable to (and may be formatted like) epoch timestamps, but are never affected by later wall clock
+ * adjustments, such as via NTP.
+ */
+qint64 ClockAligner::hostTime()
+{
+    static const struct HostClock {
+        qint64 epoch;        ///< Wall clock time the timer was started.
+        QElapsedTimer timer; ///< Steady (monotonic, where available) timer.
+        HostClock() : epoch(QDateTime::currentMSecsSinceEpoch()) { timer.start(); }
+    } clock;
+    return clock.epoch + clock.timer.elapsed();
+}
+
+/*!
+ * Returns the device time, in milliseconds, of the Data Logger sample at \a index (from 0) of the session described
+ * by \a metadata. That is, \a index logging intervals after the session's timestamp.
+ */
+qint64 ClockAligner::loggerSampleTime(const DataLoggerService::Metadata &metadata, const int index)
+{
+    return ((qint64)metadata.timestamp * 1000) + ((qint64)index * metadata.updateInterval);
+}
+
+/*!
+ * Returns \a values, sampled at (ascending) \a times, linearly interpolated onto a grid of \a count points, \a step
+ * milliseconds apart, beginning at \a start. Grid points outside of the span of \a times are NaN.
+ *
+ * Resampling every device's aligned samples onto the same grid gives samples that may be combined point-by-point.
+ */
+QVector<float> ClockAligner::resample(const QVector<qint64> &times, const QVector<float> &values, const qint64 start,
+                                      const quint32 step, const int count)
+{
+    QVector<float> resampled(qMax(count, 0), std::numeric_limits<float>::quiet_NaN());
+    const qsizetype size = qMin(times.size(), values.size());
+    qsizetype index = 0; // Index of the first sample at, or after, the current grid point.
+    for (int point = 0; (point < resampled.size()) && (size > 0); ++point) {
+        const qint64 time = start + ((qint64)point * step);
+        while ((index < size) && (times.at(index) < time)) {
+            ++index;
+        }
+        if (index >= size) {
+            break; // Beyond the last sample, so this, and all later, points are NaN.
+        }
+        if (times.at(index) == time) {
+            resampled[point] = values.at(index);
+        } else if (index > 0) {
+            const double fraction = (double)(time - times.at(index-1)) / (double)(times.at(index) - times.at(index-1));
+            resampled[point] = (float)(values.at(index-1) + fraction * (values.at(index) - values.at(index-1)));
+        } // Else before the first sample, so NaN.
+    }
+    return resampled;
+}
+
+/*!
+ * Adds an observation of \a device's clock: that \a deviceTime, in milliseconds, was received at the host's \a hostTime.
+ *
+ * For the best estimates, \a hostTime should be taken as soon as the sample is received (such as via hostTime(), in
+ * a slot directly connected to the service's signal), and observations should be added for every sample received.
+ */
+void ClockAligner::addObservation(const QString &device, const qint64 deviceTime, const qint64 hostTime)
+{
+    Q_D(ClockAligner);
+    ClockAlignerPrivate::Clock &clock = d->clocks[device];
+    if ((!clock.observations.isEmpty()) && (deviceTime < clock.observations.last().deviceTime)) {
+        clock.observations.clear(); // The device's clock has restarted, such as for a new logging session.
+    }
+    clock.observations.append({ deviceTime, hostTime });
+    if (clock.observations.size() > d->window) {
+        clock.observations.removeFirst();
+    }
+    d->fit(clock);
+}
+
+/*!
+ * Adds an observation of \a device's clock: that \a deviceTime, in milliseconds, was received just now (per
+ * hostTime()).
+ */
+void ClockAligner::addObservation(const QString &device, const qint64 deviceTime)
+{
+    addObservation(device, deviceTime, hostTime());
+}
+
+/*!
+ * Removes all observations of \a device.
+ */
+void ClockAligner::remove(const QString &device)
+{
+    Q_D(ClockAligner);
+    d->clocks.remove(device);
+}
+
+/*!
+ * Removes all observations of all devices.
+ */
+void ClockAligner::clear()
+{
+    Q_D(ClockAligner);
+    d->clocks.clear();
+}
+
+/*!
+ * \cond internal
+ * \class ClockAlignerPrivate
+ *
+ * The ClockAlignerPrivate class provides private implementation for ClockAligner.
+ */
+
+/*!
+ * Constructs a new ClockAlignerPrivate object with public implementation \a q.
+ */
+ClockAlignerPrivate::ClockAlignerPrivate(ClockAligner * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Fits \a clock's model to its observations. That is, a least squares fit of each observation's host-minus-device
+ * time against device time (with the slope clamped to #maximumDrift), lowered such that no observation lies below
+ * the line, since every observation's host time includes some (unknown, but non-negative) transport latency.
+ */
+void ClockAlignerPrivate::fit(Clock &clock) const
+{
+    Q_ASSERT(!clock.observations.isEmpty());
+    clock.deviceReference = clock.observations.first().deviceTime;
+
+    double meanX = 0.0, meanY = 0.0;
+    for (const Observation &observation: clock.observations) {
+        meanX += (double)(observation.deviceTime - clock.deviceReference);
+        meanY += (double)(observation.hostTime - observation.deviceTime);
+    }
+    meanX /= clock.observations.size();
+    meanY /= clock.observations.size();
+
+    double sxx = 0.0, sxy = 0.0;
+    for (const Observation &observation: clock.observations) {
+        const double dx = (double)(observation.deviceTime - clock.deviceReference) - meanX;
+        sxx += dx * dx;
+        sxy += dx * ((double)(observation.hostTime - observation.deviceTime) - meanY);
+    }
+    const double limit = maximumDrift / 1e6;
+    clock.rate = (sxx > 0.0) ? std::clamp(sxy / sxx, -limit, limit) : 0.0;
+
+    double lowest = std::numeric_limits<double>::max();
+    for (const Observation &observation: clock.observations) {
+        const double x = (double)(observation.deviceTime - clock.deviceReference);
+        lowest = qMin(lowest, (double)(observation.hostTime - observation.deviceTime) - clock.rate * x);
+    }
+    clock.offset = lowest;
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
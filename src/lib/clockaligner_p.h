@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the ClockAlignerPrivate class.
+ */
+
+#ifndef QTPOKIT_CLOCKALIGNER_P_H
+#define QTPOKIT_CLOCKALIGNER_P_H
+
+#include <qtpokit/clockaligner.h>
+
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT ClockAlignerPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// A single device time, paired with the host time it was received at.
+    struct Observation {
+        qint64 deviceTime; ///< Device time, in milliseconds.
+        qint64 hostTime;   ///< Host (steady clock) time, in milliseconds.
+    };
+
+    /// Observations of, and the fitted model for, a single device's clock.
+    struct Clock {
+        QVector<Observation> observations; ///< Most recent observations, oldest first.
+        qint64 deviceReference { 0 };      ///< Device time the model is relative to (the oldest observation's).
+        double offset { 0.0 };             ///< Host minus device time, in milliseconds, at #deviceReference.
+        double rate { 0.0 };               ///< Change in #offset per device millisecond (ie drift).
+    };
+
+    QHash<QString, Clock> clocks;    ///< Device clocks, by device.
+    int window { 64 };               ///< Maximum number of observations to fit each device's clock to.
+    double maximumDrift { 1000.0 };  ///< Largest believable drift, in parts per million.
+
+    explicit ClockAlignerPrivate(ClockAligner * const q);
+
+    void fit(Clock &clock) const;
+
+protected:
+    ClockAligner * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(ClockAligner)
+    Q_DISABLE_COPY(ClockAlignerPrivate)
+    QTPOKIT_BEFRIEND_TEST(ClockAligner)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_CLOCKALIGNER_P_H
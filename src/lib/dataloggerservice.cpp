@@ -7,16 +7,17 @@
  */
 
 #include <qtpokit/dataloggerservice.h>
+#include "characteristiclayout_p.h"
 #include "dataloggerservice_p.h"
 #include "pokitproducts_p.h"
 #include "../stringliterals_p.h"
 
+#include <qtpokit/pokittrace.h>
 #include <qtpokit/statusservice.h>
+#include <pokitcodec/pokitcodec.h>
 
-#include <QDataStream>
-#include <QIODevice>
 #include <QLowEnergyController>
-#include <QtEndian>
+#include <QMetaMethod>
 
 QTPOKIT_BEGIN_NAMESPACE
 DOKIT_USE_STRINGLITERALS
@@ -156,22 +157,30 @@ bool DataLoggerService::readMetadataCharacteristic()
  */
 bool DataLoggerService::setSettings(const Settings &settings)
 {
-    Q_D(const DataLoggerService);
-    const QLowEnergyCharacteristic characteristic =
-        d->getCharacteristic(CharacteristicUuids::settings);
-    if (!characteristic.isValid()) {
+    Q_D(DataLoggerService);
+    if (!d->hasCharacteristic(CharacteristicUuids::settings)) {
         return false;
     }
 
-    const bool updateIntervalIs32bit =
-        (d->getCharacteristic(CharacteristicUuids::metadata).value().size() >= 23);
-    const QByteArray value = DataLoggerServicePrivate::encodeSettings(settings, updateIntervalIs32bit);
+    const QByteArray value = DataLoggerServicePrivate::encodeSettings(settings,
+        updateIntervalIs32bit().value_or(false));
     if (value.isNull()) {
         return false;
     }
 
-    d->service->writeCharacteristic(characteristic, value);
-    return (d->service->error() != QLowEnergyService::ServiceError::CharacteristicWriteError);
+    return d->writeCharacteristic(CharacteristicUuids::settings, value);
+}
+
+/*!
+ * Asynchronous variant of setSettings().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the settings write. The future's result is
+ * \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DataLoggerService::setSettingsAsync(const Settings &settings)
+{
+    Q_D(DataLoggerService);
+    return d->whenFinished([this, settings]{ return setSettings(settings); });
 }
 
 /*!
@@ -191,6 +200,18 @@ bool DataLoggerService::startLogger(const Settings &settings)
     return setSettings(settings);
 }
 
+/*!
+ * Asynchronous variant of startLogger().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the settings write. The future's result is
+ * \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DataLoggerService::startLoggerAsync(const Settings &settings)
+{
+    Q_D(DataLoggerService);
+    return d->whenFinished([this, settings]{ return startLogger(settings); });
+}
+
 /*!
  * Stop the data logger.
  *
@@ -205,6 +226,18 @@ bool DataLoggerService::stopLogger()
     return setSettings({ DataLoggerService::Command::Stop,  0, DataLoggerService::Mode::Idle, 0, 0, 0 });
 }
 
+/*!
+ * Asynchronous variant of stopLogger().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the settings write. The future's result is
+ * \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DataLoggerService::stopLoggerAsync()
+{
+    Q_D(DataLoggerService);
+    return d->whenFinished([this]{ return stopLogger(); });
+}
+
 /*!
  * Start the data logger.
  *
@@ -223,12 +256,66 @@ bool DataLoggerService::fetchSamples()
     return setSettings({ DataLoggerService::Command::Refresh, 0, DataLoggerService::Mode::Idle, 0, 0, 0 });
 }
 
+/*!
+ * Asynchronous variant of fetchSamples().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the settings write. The future's result is
+ * \c true if the request was queued, and succeeded, otherwise \c false.
+ *
+ * Note, the future finishes once the device has acknowledged the request, not once all samples have been received;
+ * the samples are still reported via samplesRead as usual.
+ */
+QFuture<bool> DataLoggerService::fetchSamplesAsync()
+{
+    Q_D(DataLoggerService);
+    return d->whenFinished([this]{ return fetchSamples(); });
+}
+
+/*!
+ * Returns `true` if the Pokit device's `Settings` characteristic uses a 32-bit update interval, `false` if it uses a
+ * 16-bit update interval, or an empty optional if not yet known.
+ *
+ * Pokit Pro devices use 32-bit update intervals, and report a 23 byte `Metadata` characteristic, whereas Pokit Meter
+ * devices use 16-bit update intervals, and report a 15 byte `Metadata` characteristic. This is resolved once, from
+ * the first available `Metadata` value, and then cached, so setSettings() need not re-derive the device's layout on
+ * every call.
+ *
+ * \see setUpdateIntervalIs32bit
+ */
+std::optional<bool> DataLoggerService::updateIntervalIs32bit() const
+{
+    Q_D(const DataLoggerService);
+    if (!d->updateIntervalIs32bit) {
+        const QByteArray value = d->getCharacteristic(CharacteristicUuids::metadata).value();
+        if (!value.isEmpty()) {
+            d->updateIntervalIs32bit = (value.size() >= 23);
+        }
+    }
+    return d->updateIntervalIs32bit;
+}
+
+/*!
+ * Sets whether the Pokit device's `Settings` characteristic uses a 32-bit update interval to \a is32bit.
+ *
+ * This is typically only needed to restore a previously resolved PokitDevice::Capabilities profile, since
+ * updateIntervalIs32bit() will otherwise resolve this from the device's `Metadata` characteristic.
+ *
+ * \see updateIntervalIs32bit
+ */
+void DataLoggerService::setUpdateIntervalIs32bit(const bool is32bit)
+{
+    Q_D(DataLoggerService);
+    d->updateIntervalIs32bit = is32bit;
+}
+
 /*!
  * Returns the most recent value of the `DataLogger` service's `Metadata` characteristic.
  *
- * The returned value, if any, is from the underlying Bluetooth stack's cache. If no such value is
- * currently available (ie the serviceDetailsDiscovered signal has not been emitted yet), then the
- * returned DataLoggerService::Metadata::scale member will be a quiet NaN, which can be checked like:
+ * The returned value is the most recently read, or notified, metadata, as held in a lock-free LatestValue cell. So
+ * this function may be called from any thread, at any rate, without locking, re-parsing, or touching the underlying
+ * Bluetooth stack's objects. If no such value is available yet (ie the `Metadata` characteristic has not been read,
+ * or notified, yet), then the returned DataLoggerService::Metadata::scale member will be a quiet NaN, which can be
+ * checked like:
  *
  * ```
  * const DataLoggerService::Metadata metadata = multimeterService->metadata();
@@ -240,10 +327,7 @@ bool DataLoggerService::fetchSamples()
 DataLoggerService::Metadata DataLoggerService::metadata() const
 {
     Q_D(const DataLoggerService);
-    const QLowEnergyCharacteristic characteristic =
-        d->getCharacteristic(CharacteristicUuids::metadata);
-    return (characteristic.isValid()) ? DataLoggerServicePrivate::parseMetadata(characteristic.value())
-        : Metadata{ LoggerStatus::Error, std::numeric_limits<float>::quiet_NaN(), Mode::Idle, 0, 0, 0, 0 };
+    return d->latestMetadata.load();
 }
 
 /*!
@@ -261,6 +345,18 @@ bool DataLoggerService::enableMetadataNotifications()
     return d->enableCharacteristicNotificatons(CharacteristicUuids::metadata);
 }
 
+/*!
+ * Asynchronous variant of enableMetadataNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DataLoggerService::enableMetadataNotificationsAsync()
+{
+    Q_D(DataLoggerService);
+    return d->whenFinished([this]{ return enableMetadataNotifications(); });
+}
+
 /*!
  * Disables client-side notifications of Data Logger metadata changes.
  *
@@ -274,6 +370,18 @@ bool DataLoggerService::disableMetadataNotifications()
     return d->disableCharacteristicNotificatons(CharacteristicUuids::metadata);
 }
 
+/*!
+ * Asynchronous variant of disableMetadataNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DataLoggerService::disableMetadataNotificationsAsync()
+{
+    Q_D(DataLoggerService);
+    return d->whenFinished([this]{ return disableMetadataNotifications(); });
+}
+
 /*!
  * Enables client-side notifications of Data Logger readings.
  *
@@ -287,6 +395,18 @@ bool DataLoggerService::enableReadingNotifications()
     return d->enableCharacteristicNotificatons(CharacteristicUuids::reading);
 }
 
+/*!
+ * Asynchronous variant of enableReadingNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DataLoggerService::enableReadingNotificationsAsync()
+{
+    Q_D(DataLoggerService);
+    return d->whenFinished([this]{ return enableReadingNotifications(); });
+}
+
 /*!
  * Disables client-side notifications of Data Logger readings.
  *
@@ -298,6 +418,45 @@ bool DataLoggerService::disableReadingNotifications()
     return d->disableCharacteristicNotificatons(CharacteristicUuids::reading);
 }
 
+/*!
+ * Asynchronous variant of disableReadingNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DataLoggerService::disableReadingNotificationsAsync()
+{
+    Q_D(DataLoggerService);
+    return d->whenFinished([this]{ return disableReadingNotifications(); });
+}
+
+/*!
+ * Returns the buffer that parsed `Reading` samples are pushed into, if any.
+ *
+ * \see setSamplesBuffer
+ */
+RingBuffer<DataLoggerService::Samples> * DataLoggerService::samplesBuffer() const
+{
+    Q_D(const DataLoggerService);
+    return d->samplesBuffer;
+}
+
+/*!
+ * Sets the \a buffer that parsed `Reading` samples will be pushed into, as well as being emitted via samplesRead().
+ *
+ * This allows a consumer on another thread to drain the samples, without a slow consumer stalling the thread that
+ * handles this service's BLE events. This object does not take ownership of \a buffer, which must remain valid until
+ * replaced (or cleared, via \c nullptr). Only this service (on its controller's thread) may push into \a buffer.
+ *
+ * \see samplesBuffer
+ * \see RingBuffer
+ */
+void DataLoggerService::setSamplesBuffer(RingBuffer<Samples> * const buffer)
+{
+    Q_D(DataLoggerService);
+    d->samplesBuffer = buffer;
+}
+
 /*!
  * \fn DataLoggerService::settingsWritten
  *
@@ -323,6 +482,44 @@ bool DataLoggerService::disableReadingNotifications()
  * \see stopSampling
  */
 
+/*!
+ * \fn DataLoggerService::rawSamplesRead
+ *
+ * This signal is emitted when the `Reading` characteristic has been notified, with the notification's raw \a samples,
+ * as little-endian 16-bit integers (to be scaled by the most recent `Metadata` value's `scale`). The \a samples share
+ * the notification's own data (QByteArray being implicitly shared), so can be handed on to binary sinks, such as
+ * files, without any copying.
+ *
+ * Moreover, if nothing requires the decoded samples (that is, nothing is connected to samplesRead, or
+ * scaledSamplesRead, and there is no samplesBuffer, or batching), then the samples are not decoded at all. Values of
+ * odd size are not emitted, but are instead logged, and counted, as per samplesRead.
+ *
+ * \see samplesRead
+ * \see metadataRead
+ */
+
+/*!
+ * \fn DataLoggerService::scaledSamplesRead
+ *
+ * This signal is emitted when the `Reading` characteristic has been notified, after the samples have been multiplied
+ * by the `scale` of the most recent `Metadata` value. It is only emitted if something is connected to it, and the
+ * `Metadata` characteristic has been read (or notified) at least once.
+ *
+ * \see samplesRead
+ * \see metadataRead
+ */
+
+/*!
+ * \fn DataLoggerService::samplesBatchRead
+ *
+ * This signal is emitted, if batching is enabled (see setBatching()), with the samples of one or more consecutive
+ * `Reading` notifications, in the order they were notified, each as also emitted via samplesRead. Any batch in
+ * progress is emitted before the next metadataRead, so batches never span transfers.
+ *
+ * \see samplesRead
+ * \see setBatching
+ */
+
 
 /*!
  * \cond internal
@@ -339,43 +536,33 @@ DataLoggerServicePrivate::DataLoggerServicePrivate(
     QLowEnergyController * controller, DataLoggerService * const q)
     : AbstractPokitServicePrivate(DataLoggerService::serviceUuid, controller, q)
 {
-
+    memoryStream = &samplePool.memoryStream();
+    setNotificationHandler(DataLoggerService::CharacteristicUuids::metadata,
+        [this](const QByteArray &value){ emitMetadata(value); });
+    setNotificationHandler(DataLoggerService::CharacteristicUuids::reading,
+        [this](const QByteArray &value){ emitSamples(value); });
 }
 
 /*!
  * Returns \a settings in the format Pokit devices expect. If \a updateIntervalIs32bit is \c true
- * then the `Update Interval` field will be encoded in 32-bit instead of 16.
+ * then the `Update Interval` field will be encoded in 32-bit milliseconds (as for Pokit Pro devices) instead of
+ * 16-bit seconds (as for Pokit Meter devices).
  */
 QByteArray DataLoggerServicePrivate::encodeSettings(const DataLoggerService::Settings &settings,
                                                     const bool updateIntervalIs32bit)
 {
-    static_assert(sizeof(settings.command)        == 1, "Expected to be 1 byte.");
-    static_assert(sizeof(settings.arguments)      == 2, "Expected to be 2 bytes.");
-    static_assert(sizeof(settings.mode)           == 1, "Expected to be 1 byte.");
-    static_assert(sizeof(settings.range)          == 1, "Expected to be 1 byte.");
-    static_assert(sizeof(settings.updateInterval) == 4, "Expected to be 4 bytes.");
-    static_assert(sizeof(settings.timestamp)      == 4, "Expected to be 4 bytes.");
-
-    QByteArray value;
-    QDataStream stream(&value, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::LittleEndian);
-    stream.setFloatingPointPrecision(QDataStream::SinglePrecision); // 32-bit floats, not 64-bit.
-    stream << (quint8)settings.command << settings.arguments << (quint8)settings.mode << settings.range;
-
     /*!
      * \pokitApi For Pokit Meter, `updateInterval` is `uint16` seconds (as per the Pokit API 1.00),
      * however for Pokit Pro it's `uint32` milliseconds, even though that's not officially
      * documented anywhere.
      */
 
-    if (!updateIntervalIs32bit) {
-        stream << (quint16)((settings.updateInterval+500)/1000) << settings.timestamp;
-        Q_ASSERT(value.size() == 11); // According to Pokit API 1.00.
-    } else {
-        stream << settings.updateInterval << settings.timestamp;
-        Q_ASSERT(value.size() == 13); // According to testing / experimentation.
-    }
-    return value;
+    std::array<std::byte, PokitCodec::DataLogger::proSettingsSize> value{};
+    const std::size_t size = PokitCodec::DataLogger::encodeSettings({
+        static_cast<quint8>(settings.command), settings.arguments, static_cast<quint8>(settings.mode),
+        settings.range, settings.updateInterval, settings.timestamp
+    }, updateIntervalIs32bit, value);
+    return CharacteristicLayout::toByteArray(value.data(), size);
 }
 
 /*!
@@ -388,17 +575,11 @@ DataLoggerService::Metadata DataLoggerServicePrivate::parseMetadata(const QByteA
         DataLoggerService::Mode::Idle, 0, 0, 0, 0
     };
 
-    // Pokit Meter: 15 bytes, Pokit Pro: 23 bytes.
-    if (!checkSize(u"Metadata"_s, value, 15, 23)) {
+    if (!checkSize(u"Metadata"_s, value, PokitCodec::DataLogger::meterMetadataSize,
+                   PokitCodec::DataLogger::proMetadataSize)) {
         return metadata;
     }
 
-    qCDebug(lc) << value.mid(7,12).toHex(',');
-    metadata.status = static_cast<DataLoggerService::LoggerStatus>(value.at(0));
-    metadata.scale  = qFromLittleEndian<float>(value.mid(1,4).constData());
-    metadata.mode   = static_cast<DataLoggerService::Mode>(value.at(5));
-    metadata.range  = static_cast<quint8>(value.at(6));
-
     /*!
      * \pokitApi For Pokit Meter, `updateInterval` is `uint16` (as per the Pokit API 1.00), however
      * for Pokit Pro it's `uint32`, even though that's not officially documented anywhere.
@@ -406,14 +587,19 @@ DataLoggerService::Metadata DataLoggerServicePrivate::parseMetadata(const QByteA
      * (ie 10^-3) for Pokit Pro, and whole seconds for Pokit Meter.
      */
 
-    if (value.size() == 15) {
-        metadata.updateInterval  = qFromLittleEndian<quint16>(value.mid(7,2).constData())*1000;
-        metadata.numberOfSamples = qFromLittleEndian<quint16>(value.mid(9,2).constData());
-        metadata.timestamp       = qFromLittleEndian<quint32>(value.mid(11,4).constData());
-    } else if (value.size() == 23) {
-        metadata.updateInterval  = qFromLittleEndian<quint32>(value.mid(7,4).constData());
-        metadata.numberOfSamples = qFromLittleEndian<quint16>(value.mid(11,2).constData());
-        metadata.timestamp       = qFromLittleEndian<quint32>(value.mid(19,4).constData());
+    PokitCodec::DataLogger::Metadata decoded{};
+    const bool decodedAll = PokitCodec::DataLogger::parseMetadata(CharacteristicLayout::toByteSpan(value), decoded);
+
+    // The Status, Scale, Mode and Range fields are common to both the Pokit Meter and Pokit Pro layouts.
+    metadata.status = static_cast<DataLoggerService::LoggerStatus>(decoded.status);
+    metadata.scale  = decoded.scale;
+    metadata.mode   = static_cast<DataLoggerService::Mode>(decoded.mode);
+    metadata.range  = decoded.range;
+
+    if (decodedAll) {
+        metadata.updateInterval  = decoded.updateInterval;
+        metadata.numberOfSamples = decoded.numberOfSamples;
+        metadata.timestamp       = decoded.timestamp;
     } else {
         qCWarning(lc).noquote() << tr("Cannot decode metadata of %n byte/s: %1", nullptr, value.size())
             .arg(toHexString(value));
@@ -430,15 +616,145 @@ DataLoggerService::Samples DataLoggerServicePrivate::parseSamples(const QByteArr
     if ((value.size()%2) != 0) {
         qCWarning(lc).noquote() << tr("Samples value has odd size %1 (should be even): %2")
             .arg(value.size()).arg(toHexString(value));
+        countParseFailure();
         return samples;
     }
-    while ((samples.size()*2) < value.size()) {
-        samples.append(qFromLittleEndian<qint16>(value.mid(samples.size()*2,2).constData()));
+    samples.resize(value.size()/2);
+    PokitCodec::decodeSamples(CharacteristicLayout::toByteSpan(value), samples.data());
+    qCDebug(lc).noquote() << tr("Read %n sample/s from %1-bytes.", nullptr, samples.size()).arg(value.size());
+    return samples;
+}
+
+/*!
+ * Parses the `Reading` \a value into a DataLoggerService::Samples vector, acquired from \a pool, such that (once the
+ * pool has warmed up, and as long as consumers keep up) no heap allocations are required.
+ *
+ * \see SamplePool
+ */
+DataLoggerService::Samples DataLoggerServicePrivate::parseSamples(const QByteArray &value, SamplePool<qint16> &pool)
+{
+    QTPOKIT_TRACE_ZONE(Parse, "dataLoggerSamples");
+    if ((value.size()%2) != 0) {
+        return parseSamples(value); // Logs, and counts, the failure.
     }
+    QVector<qint16> &samples = pool.acquire(value.size()/2);
+    PokitCodec::decodeSamples(CharacteristicLayout::toByteSpan(value), samples.data());
     qCDebug(lc).noquote() << tr("Read %n sample/s from %1-bytes.", nullptr, samples.size()).arg(value.size());
     return samples;
 }
 
+/*!
+ * Returns \a samples multiplied by \a scale.
+ *
+ * The loop is intentionally trivial, so that compilers are free to vectorise it.
+ */
+DataLoggerService::ScaledSamples DataLoggerServicePrivate::scaleSamples(const DataLoggerService::Samples &samples, const float scale)
+{
+    DataLoggerService::ScaledSamples scaled(samples.size());
+    const qint16 * const in = samples.constData();
+    float * const out = scaled.data();
+    for (qsizetype index = 0; index < samples.size(); ++index) {
+        out[index] = in[index] * scale;
+    }
+    return scaled;
+}
+
+/*!
+ * Parses the `Metadata` \a value, stores it as the latestMetadata, records its scale (for scaling subsequent samples),
+ * and the device's settings layout (if not yet known), begins accounting for the transfer of the samples it
+ * describes, then emits metadataRead.
+ */
+void DataLoggerServicePrivate::emitMetadata(const QByteArray &value)
+{
+    Q_Q(DataLoggerService);
+    const DataLoggerService::Metadata metadata = parseMetadata(value);
+    latestMetadata.store(metadata);
+    scale = metadata.scale;
+    if ((!updateIntervalIs32bit) && (!value.isEmpty())) {
+        updateIntervalIs32bit = (value.size() >= 23);
+    }
+    flushBatch();
+    beginTransfer((metadata.status == DataLoggerService::LoggerStatus::Error) ? 0 : metadata.numberOfSamples * 2);
+    Q_EMIT q->metadataRead(metadata);
+}
+
+/*!
+ * Parses the `Reading` \a value, adds it to the transfer in progress (if any), pushes it into the samplesBuffer (if
+ * any), then emits samplesRead (counting its latencies, see countLatency()), and (if anything is connected to it,
+ * and the current scale is known) scaledSamplesRead. If batching, the samples are also added to the batch in
+ * progress, which is emitted via samplesBatchRead once full, or at the end of the transfer.
+ *
+ * If anything is connected to rawSamplesRead, then \a value is also emitted via that (just before samplesRead), and
+ * if nothing else requires the decoded samples (see samplesRequired()), then \a value is not parsed at all.
+ */
+void DataLoggerServicePrivate::emitSamples(const QByteArray &value)
+{
+    Q_Q(DataLoggerService);
+    const bool raw = ((value.size()%2) == 0)
+        && (q->isSignalConnected(QMetaMethod::fromSignal(&DataLoggerService::rawSamplesRead)));
+    if ((raw) && (!samplesRequired())) {
+        const qint64 receivedAt = steadyTimestamp();
+        countTransfer(value);
+        Q_EMIT q->rawSamplesRead(value);
+        QTPOKIT_TRACE_POINT(Emit, "dataLoggerRawSamples", value.size()/2);
+        countLatency(receivedAt);
+        return;
+    }
+
+    const DataLoggerService::Samples samples = parseSamples(value, samplePool);
+    QTPOKIT_TRACE_POINT(Parse, "dataLoggerSamples", samples.size());
+    const qint64 parsedAt = steadyTimestamp();
+    const bool transferring = transfer.has_value();
+    countTransfer(value);
+    if (samplesBuffer) {
+        samplesBuffer->push(samples);
+    }
+    if (raw) {
+        Q_EMIT q->rawSamplesRead(value);
+    }
+    {
+        QTPOKIT_TRACE_ZONE(Emit, "dataLoggerSamples");
+        Q_EMIT q->samplesRead(samples);
+    }
+    QTPOKIT_TRACE_POINT(Emit, "dataLoggerSamples", samples.size());
+    countLatency(parsedAt);
+    if (q->isSignalConnected(QMetaMethod::fromSignal(&DataLoggerService::scaledSamplesRead))) {
+        if (qIsNaN(scale)) {
+            qCDebug(lc).noquote() << tr("Not emitting scaled samples, since no metadata has been received yet.");
+        } else {
+            Q_EMIT q->scaledSamplesRead(scaleSamples(samples, scale));
+        }
+    }
+    if (isBatching()) {
+        samplesBatch.append(samples);
+        batchAppended(samplesBatch.size(), (transferring) && (!transfer));
+    }
+}
+
+/*!
+ * Returns \c true if anything requires decoded `Reading` samples, that is, if there is a samplesBuffer, batching is
+ * enabled, or anything is connected to samplesRead, or scaledSamplesRead.
+ */
+bool DataLoggerServicePrivate::samplesRequired() const
+{
+    Q_Q(const DataLoggerService);
+    return (samplesBuffer) || (isBatching())
+        || (q->isSignalConnected(QMetaMethod::fromSignal(&DataLoggerService::samplesRead)))
+        || (q->isSignalConnected(QMetaMethod::fromSignal(&DataLoggerService::scaledSamplesRead)));
+}
+
+/*!
+ * Implements AbstractPokitServicePrivate::emitBatch to emit, then clear, the samplesBatch, if not empty.
+ */
+void DataLoggerServicePrivate::emitBatch()
+{
+    Q_Q(DataLoggerService);
+    if (!samplesBatch.isEmpty()) {
+        Q_EMIT q->samplesBatchRead(samplesBatch);
+        samplesBatch.clear();
+    }
+}
+
 /*!
  * Implements AbstractPokitServicePrivate::characteristicRead to parse \a value, then emit a
  * specialised signal, for each supported \a characteristic.
@@ -454,9 +770,8 @@ void DataLoggerServicePrivate::characteristicRead(const QLowEnergyCharacteristic
         return;
     }
 
-    Q_Q(DataLoggerService);
     if (characteristic.uuid() == DataLoggerService::CharacteristicUuids::metadata) {
-        Q_EMIT q->metadataRead(parseMetadata(value));
+        emitMetadata(value);
         return;
     }
 
@@ -510,7 +825,6 @@ void DataLoggerServicePrivate::characteristicChanged(const QLowEnergyCharacteris
 {
     AbstractPokitServicePrivate::characteristicChanged(characteristic, newValue);
 
-    Q_Q(DataLoggerService);
     if (characteristic.uuid() == DataLoggerService::CharacteristicUuids::settings) {
         qCWarning(lc).noquote() << tr("Settings characteristic is write-only, but somehow updated")
             << serviceUuid << characteristic.name() << characteristic.uuid();
@@ -518,12 +832,12 @@ void DataLoggerServicePrivate::characteristicChanged(const QLowEnergyCharacteris
     }
 
     if (characteristic.uuid() == DataLoggerService::CharacteristicUuids::metadata) {
-        Q_EMIT q->metadataRead(parseMetadata(newValue));
+        emitMetadata(newValue);
         return;
     }
 
     if (characteristic.uuid() == DataLoggerService::CharacteristicUuids::reading) {
-        Q_EMIT q->samplesRead(parseSamples(newValue));
+        emitSamples(newValue);
         return;
     }
 
@@ -10,6 +10,8 @@
 #define QTPOKIT_DATALOGGERSERVICE_P_H
 
 #include <qtpokit/dataloggerservice.h>
+#include <qtpokit/latestvalue.h>
+#include <qtpokit/samplepool.h>
 
 #include "abstractpokitservice_p.h"
 
@@ -20,6 +22,17 @@ class QTPOKIT_EXPORT DataLoggerServicePrivate : public AbstractPokitServicePriva
     Q_OBJECT
 
 public:
+    float scale { std::numeric_limits<float>::quiet_NaN() }; ///< Scale from the most recent `Metadata` read.
+    RingBuffer<DataLoggerService::Samples> * samplesBuffer { nullptr }; ///< Buffer to push samples into, if any.
+    SamplePool<qint16> samplePool { ///< Reusable buffers for parsed samples.
+        SamplePool<qint16>::defaultCapacity, QStringLiteral("logger.samples") };
+    LatestValue<DataLoggerService::Metadata> latestMetadata { DataLoggerService::Metadata{
+        DataLoggerService::LoggerStatus::Error, std::numeric_limits<float>::quiet_NaN(),
+        DataLoggerService::Mode::Idle, 0, 0, 0, 0
+    } }; ///< Most recent metadata, for metadata() to load from any thread.
+    QVector<DataLoggerService::Samples> samplesBatch; ///< Samples not yet emitted via samplesBatchRead, if batching.
+    mutable std::optional<bool> updateIntervalIs32bit; ///< Whether `Settings` use a 32-bit update interval, if known.
+
     explicit DataLoggerServicePrivate(QLowEnergyController * controller, DataLoggerService * const q);
 
     static QByteArray encodeSettings(const DataLoggerService::Settings &settings,
@@ -27,8 +40,15 @@ public:
 
     static DataLoggerService::Metadata parseMetadata(const QByteArray &value);
     static DataLoggerService::Samples parseSamples(const QByteArray &value);
+    static DataLoggerService::Samples parseSamples(const QByteArray &value, SamplePool<qint16> &pool);
+    static DataLoggerService::ScaledSamples scaleSamples(const DataLoggerService::Samples &samples, const float scale);
 
 protected:
+    void emitMetadata(const QByteArray &value);
+    void emitSamples(const QByteArray &value);
+    bool samplesRequired() const;
+    void emitBatch() override;
+
     void characteristicRead(const QLowEnergyCharacteristic &characteristic,
                             const QByteArray &value) override;
     void characteristicWritten(const QLowEnergyCharacteristic &characteristic,
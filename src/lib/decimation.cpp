@@ -0,0 +1,254 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the Decimation namespace.
+ */
+
+#include <qtpokit/decimation.h>
+
+#include <QtMath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \namespace Decimation
+ *
+ * The Decimation namespace provides algorithms for reducing long sample series (such as complete DSO captures, or
+ * many fetched logger samples) to a bounded number of points before they reach a chart. This way, rendering cost
+ * scales with the chart's width, rather than with the length of the series.
+ *
+ * Two algorithms are provided:
+ *
+ * * minMax() retains the minimum and maximum point of each bucket. This preserves the signal's envelope exactly
+ *   (including any narrow spikes), so is best when there are many more samples than pixels.
+ * * largestTriangleThreeBuckets() retains the single most visually significant point of each bucket, per Sveinn
+ *   Steinarsson's "Largest-Triangle-Three-Buckets" algorithm. This preserves the signal's shape well with fewer
+ *   points, so is best for line series with only modestly more samples than pixels.
+ *
+ * The DSO and data logger overloads scale raw samples via the given metadata, and place them in seconds, relative to
+ * the first sample. Their results are equivalent to converting the samples to points first, but without allocating
+ * the full-length series.
+ */
+
+namespace Decimation {
+
+namespace {
+
+/*!
+ * Returns a point accessor for raw DSO \a samples, scaled and spaced according to \a metadata.
+ *
+ * If \a metadata does not have a usable sampling rate, points are spaced by sample index instead.
+ */
+auto pointAccessor(const DsoService::Metadata &metadata, const DsoService::Samples &samples)
+{
+    const qreal interval = (metadata.samplingRate == 0) ? 1.0 : (1.0 / metadata.samplingRate);
+    return [&samples, interval, scale = metadata.scale](const qsizetype index) {
+        return QPointF(index * interval, samples.at(index) * scale);
+    };
+}
+
+/*!
+ * Returns a point accessor for raw data logger \a samples, scaled and spaced according to \a metadata.
+ *
+ * If \a metadata does not have a usable update interval, points are spaced by sample index instead.
+ */
+auto pointAccessor(const DataLoggerService::Metadata &metadata, const DataLoggerService::Samples &samples)
+{
+    const qreal interval = (metadata.updateInterval == 0) ? 1.0 : (metadata.updateInterval / 1000.0);
+    return [&samples, interval, scale = metadata.scale](const qsizetype index) {
+        return QPointF(index * interval, samples.at(index) * scale);
+    };
+}
+
+/*!
+ * Returns all \a size points given by \a point, unreduced.
+ */
+template<typename Accessor>
+QVector<QPointF> allPoints(const qsizetype size, const Accessor &point)
+{
+    QVector<QPointF> result;
+    result.reserve(size);
+    for (qsizetype index = 0; index < size; ++index) {
+        result.append(point(index));
+    }
+    return result;
+}
+
+/*!
+ * Returns the min/max envelope of the \a size points given by \a point, across \a buckets buckets.
+ */
+template<typename Accessor>
+QVector<QPointF> envelope(const qsizetype size, const qsizetype buckets, const Accessor &point)
+{
+    if ((buckets <= 0) || (size <= (buckets * 2))) {
+        return allPoints(size, point);
+    }
+
+    QVector<QPointF> result;
+    result.reserve(buckets * 2);
+    for (qsizetype bucket = 0; bucket < buckets; ++bucket) {
+        const qsizetype begin = (bucket * size) / buckets;
+        const qsizetype end = ((bucket + 1) * size) / buckets;
+        QPointF minimum = point(begin), maximum = minimum;
+        qsizetype minIndex = begin, maxIndex = begin;
+        for (qsizetype index = begin + 1; index < end; ++index) {
+            const QPointF value = point(index);
+            if (value.y() < minimum.y()) {
+                minimum = value;
+                minIndex = index;
+            }
+            if (value.y() > maximum.y()) {
+                maximum = value;
+                maxIndex = index;
+            }
+        }
+        // Append in index order, so the result remains monotonic in x.
+        if (minIndex == maxIndex) {
+            result.append(minimum);
+        } else if (minIndex < maxIndex) {
+            result.append(minimum);
+            result.append(maximum);
+        } else {
+            result.append(maximum);
+            result.append(minimum);
+        }
+    }
+    return result;
+}
+
+/*!
+ * Returns \a threshold points, chosen from the \a size points given by \a point, via Largest-Triangle-Three-Buckets.
+ */
+template<typename Accessor>
+QVector<QPointF> lttb(const qsizetype size, const qsizetype threshold, const Accessor &point)
+{
+    if ((threshold < 3) || (size <= threshold)) {
+        return allPoints(size, point);
+    }
+
+    QVector<QPointF> result;
+    result.reserve(threshold);
+    result.append(point(0)); // The first point is always retained.
+
+    // Every bucket, except the first and last, spans this many points.
+    const qreal every = (qreal)(size - 2) / (qreal)(threshold - 2);
+    qsizetype selected = 0;
+    for (qsizetype bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Average the next bucket's points, as the third vertex of each triangle.
+        const qsizetype nextBegin = (qsizetype)qFloor((bucket + 1) * every) + 1;
+        const qsizetype nextEnd = qMin((qsizetype)qFloor((bucket + 2) * every) + 1, size);
+        QPointF average;
+        for (qsizetype index = nextBegin; index < nextEnd; ++index) {
+            average += point(index);
+        }
+        average /= (qreal)(nextEnd - nextBegin);
+
+        // Pick this bucket's point that forms the largest triangle with the previously selected point, and the average.
+        const QPointF a = point(selected);
+        const qsizetype begin = (qsizetype)qFloor(bucket * every) + 1;
+        const qsizetype end = (qsizetype)qFloor((bucket + 1) * every) + 1;
+        qreal maxArea = -1.0;
+        for (qsizetype index = begin; index < end; ++index) {
+            const QPointF b = point(index);
+            const qreal area = qAbs(((a.x() - average.x()) * (b.y() - a.y())) -
+                                    ((a.x() - b.x()) * (average.y() - a.y())));
+            if (area > maxArea) {
+                maxArea = area;
+                selected = index;
+            }
+        }
+        result.append(point(selected));
+    }
+
+    result.append(point(size - 1)); // The last point is always retained.
+    return result;
+}
+
+}
+
+/*!
+ * Returns the min/max envelope of \a points, across \a buckets buckets.
+ *
+ * \a points are divided into \a buckets equal-sized buckets, and the minimum and maximum (by y value) points of each
+ * bucket are retained, in their original order. So the result will have no more than twice \a buckets points. If
+ * \a points is already that short (or \a buckets is not positive), then \a points is returned unchanged.
+ *
+ * Typically, \a buckets would be the chart's plot area width, in pixels.
+ */
+QVector<QPointF> minMax(const QVector<QPointF> &points, const qsizetype buckets)
+{
+    if ((buckets <= 0) || (points.size() <= (buckets * 2))) {
+        return points;
+    }
+    return envelope(points.size(), buckets, [&points](const qsizetype index) { return points.at(index); });
+}
+
+/*!
+ * Returns the min/max envelope of DSO \a samples, scaled and spaced according to \a metadata, across \a buckets
+ * buckets.
+ *
+ * \see minMax(const QVector<QPointF> &, const qsizetype)
+ */
+QVector<QPointF> minMax(const DsoService::Metadata &metadata, const DsoService::Samples &samples,
+                        const qsizetype buckets)
+{
+    return envelope(samples.size(), buckets, pointAccessor(metadata, samples));
+}
+
+/*!
+ * Returns the min/max envelope of data logger \a samples, scaled and spaced according to \a metadata, across
+ * \a buckets buckets.
+ *
+ * \see minMax(const QVector<QPointF> &, const qsizetype)
+ */
+QVector<QPointF> minMax(const DataLoggerService::Metadata &metadata, const DataLoggerService::Samples &samples,
+                        const qsizetype buckets)
+{
+    return envelope(samples.size(), buckets, pointAccessor(metadata, samples));
+}
+
+/*!
+ * Returns \a threshold points chosen from \a points via the Largest-Triangle-Three-Buckets algorithm.
+ *
+ * The first and last points are always retained. The remaining points are divided into `threshold - 2` buckets, and
+ * from each, the point forming the largest triangle with the previously retained point, and the average of the next
+ * bucket, is retained. If \a points is already no longer than \a threshold (or \a threshold is less than 3), then
+ * \a points is returned unchanged.
+ */
+QVector<QPointF> largestTriangleThreeBuckets(const QVector<QPointF> &points, const qsizetype threshold)
+{
+    if ((threshold < 3) || (points.size() <= threshold)) {
+        return points;
+    }
+    return lttb(points.size(), threshold, [&points](const qsizetype index) { return points.at(index); });
+}
+
+/*!
+ * Returns \a threshold points chosen from DSO \a samples, scaled and spaced according to \a metadata, via the
+ * Largest-Triangle-Three-Buckets algorithm.
+ *
+ * \see largestTriangleThreeBuckets(const QVector<QPointF> &, const qsizetype)
+ */
+QVector<QPointF> largestTriangleThreeBuckets(const DsoService::Metadata &metadata,
+                                             const DsoService::Samples &samples, const qsizetype threshold)
+{
+    return lttb(samples.size(), threshold, pointAccessor(metadata, samples));
+}
+
+/*!
+ * Returns \a threshold points chosen from data logger \a samples, scaled and spaced according to \a metadata, via
+ * the Largest-Triangle-Three-Buckets algorithm.
+ *
+ * \see largestTriangleThreeBuckets(const QVector<QPointF> &, const qsizetype)
+ */
+QVector<QPointF> largestTriangleThreeBuckets(const DataLoggerService::Metadata &metadata,
+                                             const DataLoggerService::Samples &samples, const qsizetype threshold)
+{
+    return lttb(samples.size(), threshold, pointAccessor(metadata, samples));
+}
+
+}
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,412 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the DsoCapture and DsoCapturePrivate classes.
+ */
+
+#include <qtpokit/dsocapture.h>
+#include "dsocapture_p.h"
+
+#include <algorithm>
+#include <utility>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class DsoCapture
+ *
+ * The DsoCapture class reassembles the many `Reading` notifications that make up a single DSO acquisition into one
+ * contiguous buffer.
+ *
+ * Each time a DsoService emits DsoService::metadataRead, the capture buffer is (re)sized to the number of samples
+ * reported by the metadata, and each subsequent DsoService::samplesRead chunk is copied into place. Once all expected
+ * samples have arrived, captureComplete is emitted (exactly once) with the whole waveform.
+ *
+ * By default, this class does not drive the DSO itself; callers are responsible for DsoService::startDso, and for
+ * enabling the service's metadata and reading notifications. However, startContinuous() may be used to have each
+ * capture immediately followed by another, for the highest possible duty cycle.
+ *
+ * Internally, two sample buffers are alternated, so the buffer handed to captureComplete receivers is not written to
+ * again while the next capture is being assembled.
+ *
+ * Since the device's `Reading` notifications carry no sequence numbers, a lost notification can only be detected as a
+ * transfer that stops short. So, if no new samples arrive within completionTimeout() of the previous ones, the whole
+ * buffer is re-requested via DsoService::fetchSamples (which re-notifies the metadata, and then all of the samples),
+ * up to maxResends() times. If the capture is still incomplete after that, it is abandoned, and captureFailed is
+ * emitted instead.
+ *
+ * The capture buffers are accounted against the global MemoryBudget, as a "dso.capture" stream. A capture that would
+ * grow the buffers beyond that stream's quota (or the budget's limit) is discarded, and captureFailed emitted, rather
+ * than the buffers growing.
+ */
+
+/*!
+ * Constructs a new DsoCapture object that assembles captures from \a service, with \a parent.
+ */
+DsoCapture::DsoCapture(DsoService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new DsoCapturePrivate(this))
+{
+    Q_D(DsoCapture);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new DsoCapture object with \a service, \a parent, and private implementation \a d.
+ */
+DsoCapture::DsoCapture(DsoCapturePrivate * const d, DsoService * const service, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service);
+}
+/// \endcond
+
+/*!
+ * Destroys this DsoCapture object.
+ */
+DsoCapture::~DsoCapture()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the DSO service this capture is assembled from.
+ */
+DsoService * DsoCapture::service() const
+{
+    Q_D(const DsoCapture);
+    return d->service;
+}
+
+/*!
+ * Returns the metadata of the current (or most recently completed) capture.
+ */
+DsoService::Metadata DsoCapture::metadata() const
+{
+    Q_D(const DsoCapture);
+    return d->metadata;
+}
+
+/*!
+ * Returns the most recently completed capture's samples, or an empty vector if no capture has completed yet.
+ */
+DsoService::Samples DsoCapture::samples() const
+{
+    Q_D(const DsoCapture);
+    return d->completed;
+}
+
+/*!
+ * Returns the number of samples received so far for the capture in progress (if any).
+ */
+qsizetype DsoCapture::samplesReceived() const
+{
+    Q_D(const DsoCapture);
+    return d->received;
+}
+
+/*!
+ * Returns \c true if at least one capture has completed, and no other capture is currently in progress.
+ */
+bool DsoCapture::isComplete() const
+{
+    Q_D(const DsoCapture);
+    return (d->sequenceNumber > 0) && (d->expected == 0);
+}
+
+/*!
+ * Returns the sequence number of the most recently completed capture, or 0 if no capture has completed yet.
+ *
+ * Sequence numbers start at 1, and increment with each completed capture.
+ */
+quint64 DsoCapture::sequenceNumber() const
+{
+    Q_D(const DsoCapture);
+    return d->sequenceNumber;
+}
+
+/*!
+ * Returns \c true if this capture is in continuous mode.
+ *
+ * \see startContinuous
+ */
+bool DsoCapture::isContinuous() const
+{
+    Q_D(const DsoCapture);
+    return d->continuousSettings.has_value();
+}
+
+/*!
+ * Starts the DSO with \a settings, and then restarts it with the same \a settings as soon as each capture completes,
+ * until stopContinuous() is called.
+ *
+ * The next capture is requested before captureComplete is emitted, so that the device's acquisition overlaps
+ * whatever processing the captureComplete receivers perform.
+ *
+ * Returns \c true if the initial request was successfully submitted to the device queue, \c false otherwise.
+ */
+bool DsoCapture::startContinuous(const DsoService::Settings &settings)
+{
+    Q_D(DsoCapture);
+    if (!d->service) {
+        qCWarning(d->lc).noquote() << tr("Cannot start continuous capture without a DSO service.");
+        return false;
+    }
+    d->continuousSettings = settings;
+    if (!d->service->startDso(settings)) {
+        d->continuousSettings.reset();
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * Stops continuous mode. Any capture already in progress will still complete, but the DSO will not be restarted.
+ */
+void DsoCapture::stopContinuous()
+{
+    Q_D(DsoCapture);
+    d->continuousSettings.reset();
+}
+
+/*!
+ * Returns the number of milliseconds, without any new samples, after which the capture in progress is considered
+ * incomplete, or 0 if incomplete captures are never detected.
+ *
+ * Defaults to #defaultCompletionTimeout.
+ *
+ * \see setCompletionTimeout
+ */
+int DsoCapture::completionTimeout() const
+{
+    Q_D(const DsoCapture);
+    return d->completionTimeout;
+}
+
+/*!
+ * Sets the completion timeout to \a msecs milliseconds. A value of 0 disables incomplete capture detection, such that
+ * a capture that stops short will wait indefinitely for its remaining samples.
+ *
+ * \see completionTimeout
+ */
+void DsoCapture::setCompletionTimeout(const int msecs)
+{
+    Q_D(DsoCapture);
+    d->completionTimeout = std::max(msecs, 0);
+    if (d->completionTimeout == 0) {
+        d->completionTimer.stop();
+    }
+}
+
+/*!
+ * Returns the maximum number of times an incomplete capture will be re-requested, before it is abandoned.
+ *
+ * Defaults to #defaultMaxResends.
+ *
+ * \see setMaxResends
+ */
+int DsoCapture::maxResends() const
+{
+    Q_D(const DsoCapture);
+    return d->maxResends;
+}
+
+/*!
+ * Sets the maximum number of times an incomplete capture will be re-requested to \a count. A value of 0 abandons
+ * incomplete captures as soon as they time out.
+ *
+ * \see maxResends
+ */
+void DsoCapture::setMaxResends(const int count)
+{
+    Q_D(DsoCapture);
+    d->maxResends = std::max(count, 0);
+}
+
+/*!
+ * Discards the capture in progress (if any), such that subsequent samples will be ignored until the next metadata
+ * arrives.
+ */
+void DsoCapture::reset()
+{
+    Q_D(DsoCapture);
+    d->expected = 0;
+    d->received = 0;
+    d->resends = 0;
+    d->resending = false;
+    d->completionTimer.stop();
+}
+
+/*!
+ * \fn DsoCapture::captureComplete
+ *
+ * This signal is emitted when all of the samples described by \a metadata have been received. The \a samples vector
+ * contains the entire (unscaled) waveform, and \a sequenceNumber identifies the capture (starting at 1).
+ */
+
+/*!
+ * \fn DsoCapture::captureFailed
+ *
+ * This signal is emitted when the capture described by \a metadata is abandoned, having received only
+ * \a samplesReceived of its samples, even after maxResends() re-requests. It is also emitted (with no samples
+ * received) when the capture is discarded because it would exceed its memory quota (see MemoryBudget).
+ *
+ * \see completionTimeout
+ */
+
+/*!
+ * \cond internal
+ * \class DsoCapturePrivate
+ *
+ * The DsoCapturePrivate class provides private implementation for DsoCapture.
+ */
+
+/*!
+ * Constructs a new DsoCapturePrivate object with public implementation \a q.
+ */
+DsoCapturePrivate::DsoCapturePrivate(DsoCapture * const q) : q_ptr(q)
+{
+    completionTimer.setSingleShot(true);
+    connect(&completionTimer, &QTimer::timeout, this, &DsoCapturePrivate::completionTimedOut);
+}
+
+/*!
+ * Sets \a newService as the DSO service to assemble captures from, disconnecting from any previous service.
+ */
+void DsoCapturePrivate::setService(DsoService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &DsoService::metadataRead, this, &DsoCapturePrivate::metadataRead);
+        connect(service, &DsoService::samplesRead, this, &DsoCapturePrivate::samplesRead);
+    }
+}
+
+/*!
+ * Reserves memory (see MemoryBudget) for the capture buffer to hold \a count samples, and returns \c true, or returns
+ * \c false if growing the buffer would exceed the capture's memory quota. Since the two buffers alternate, each grows
+ * to the size of the largest capture, at most; once both have, no further memory is reserved.
+ */
+bool DsoCapturePrivate::reserveSamples(const qsizetype count)
+{
+    const qsizetype growth = count - samples.capacity();
+    return (growth <= 0) || (memory.reserve((qint64)growth * (qint64)sizeof(qint16)));
+}
+
+/*!
+ * Handles \a newMetadata by (re)sizing the capture buffer, ready for the capture's samples.
+ */
+void DsoCapturePrivate::metadataRead(const DsoService::Metadata &newMetadata)
+{
+    metadata = newMetadata;
+    received = 0;
+    if (!resending) {
+        resends = 0; // A new capture, rather than a resend of the current one.
+    }
+    resending = false;
+    if (metadata.status == DsoService::DsoStatus::Error) {
+        qCWarning(lc).noquote() << tr("DSO reported an error; discarding capture.");
+        expected = 0;
+        completionTimer.stop();
+        return;
+    }
+    expected = metadata.numberOfSamples;
+    if (!reserveSamples(expected)) {
+        qCWarning(lc).noquote() << tr("Capture of %Ln sample/s would exceed its memory quota; discarding capture.",
+            nullptr, (int)expected);
+        expected = 0;
+        completionTimer.stop();
+        Q_Q(DsoCapture);
+        Q_EMIT q->captureFailed(metadata, 0);
+        return;
+    }
+    samples.resize(expected); // Retains capacity, so repeat captures do not reallocate.
+    qCDebug(lc).noquote() << tr("Expecting %Ln sample/s.", nullptr, metadata.numberOfSamples);
+    if ((expected > 0) && (completionTimeout > 0)) {
+        completionTimer.start(completionTimeout);
+    }
+}
+
+/*!
+ * Copies \a chunk into the capture buffer, emitting DsoCapture::captureComplete once the buffer is full.
+ */
+void DsoCapturePrivate::samplesRead(const DsoService::Samples &chunk)
+{
+    const qsizetype remaining = expected - received;
+    if (remaining <= 0) {
+        qCDebug(lc).noquote() << tr("Ignoring %Ln unexpected sample/s.", nullptr, chunk.size());
+        return;
+    }
+    if (chunk.size() > remaining) {
+        qCWarning(lc).noquote() << tr("Received %Ln more sample/s than expected.", nullptr, chunk.size() - remaining);
+    }
+    const qsizetype count = std::min<qsizetype>(chunk.size(), remaining);
+    std::copy(chunk.constBegin(), chunk.constBegin() + count, samples.begin() + received);
+    received += count;
+    if (received < expected) {
+        if (completionTimeout > 0) {
+            completionTimer.start(completionTimeout);
+        }
+        return;
+    }
+    completionTimer.stop();
+
+    Q_Q(DsoCapture);
+    ++sequenceNumber;
+    qCDebug(lc).noquote() << tr("Capture %1 of %Ln sample/s complete.", nullptr, samples.size()).arg(sequenceNumber);
+    if ((continuousSettings) && (service) && (!service->startDso(*continuousSettings))) {
+        qCWarning(lc).noquote() << tr("Failed to restart DSO after capture %1.").arg(sequenceNumber);
+    }
+    // Swap buffers, so the next capture does not write into the one we're about to hand out.
+    std::swap(samples, completed);
+    expected = 0;
+    received = 0;
+    Q_EMIT q->captureComplete(metadata, completed, sequenceNumber);
+}
+
+/*!
+ * Handles a stalled capture by re-requesting its samples, or abandoning it once DsoCapture::maxResends is exhausted.
+ */
+void DsoCapturePrivate::completionTimedOut()
+{
+    if (expected <= 0) {
+        return;
+    }
+
+    if (resends < maxResends) {
+        ++resends;
+        qCWarning(lc).noquote() << tr("Capture stalled after %1 of %Ln sample/s; requesting resend %2 of %3.",
+            nullptr, (int)expected).arg(received).arg(resends).arg(maxResends);
+        resending = true;
+        if ((!service) || (!service->fetchSamples())) {
+            qCWarning(lc).noquote() << tr("Failed to request resend %1.").arg(resends);
+        }
+        completionTimer.start(completionTimeout); // Try again (or give up) if the resend stalls too.
+        return;
+    }
+
+    Q_Q(DsoCapture);
+    const qsizetype samplesReceived = received;
+    qCWarning(lc).noquote() << tr("Abandoning capture after %1 of %Ln sample/s, and %2 resend/s.",
+        nullptr, (int)expected).arg(samplesReceived).arg(resends);
+    expected = 0;
+    received = 0;
+    resends = 0;
+    resending = false;
+    if ((continuousSettings) && (service) && (!service->startDso(*continuousSettings))) {
+        qCWarning(lc).noquote() << tr("Failed to restart DSO after abandoned capture.");
+    }
+    Q_EMIT q->captureFailed(metadata, samplesReceived);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
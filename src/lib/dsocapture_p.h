@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the DsoCapturePrivate class.
+ */
+
+#ifndef QTPOKIT_DSOCAPTURE_P_H
+#define QTPOKIT_DSOCAPTURE_P_H
+
+#include <qtpokit/dsocapture.h>
+#include <qtpokit/memorybudget.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+#include <QTimer>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT DsoCapturePrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.dso.capture", QtInfoMsg); ///< Logging category.
+
+    DsoService * service { nullptr }; ///< DSO service to assemble captures from.
+    DsoService::Metadata metadata {   ///< Metadata for the current capture.
+        DsoService::DsoStatus::Error, std::numeric_limits<float>::quiet_NaN(), DsoService::Mode::Idle, 0, 0, 0, 0
+    };
+    DsoService::Samples samples;      ///< Buffer for the capture in progress, pre-sized from #metadata.
+    DsoService::Samples completed;    ///< Most recently completed capture; swapped with #samples on completion.
+    qsizetype expected { 0 };         ///< Number of samples expected for the capture in progress, if any.
+    qsizetype received { 0 };         ///< Number of #samples received so far for the capture in progress.
+    quint64 sequenceNumber { 0 };     ///< Number of captures completed so far.
+    std::optional<DsoService::Settings> continuousSettings; ///< Settings to restart the DSO with, if continuous.
+    QTimer completionTimer;           ///< Restarted with each chunk; fires if the capture in progress stalls.
+    int completionTimeout { DsoCapture::defaultCompletionTimeout }; ///< Milliseconds before a capture has stalled.
+    int maxResends { DsoCapture::defaultMaxResends }; ///< Maximum resends per capture, before it is abandoned.
+    int resends { 0 };                ///< Number of resends requested so far for the capture in progress.
+    bool resending { false };         ///< Whether a resend has been requested, but its metadata not yet received.
+    /// Accounts for the memory held by both #samples and #completed.
+    MemoryBudget::Stream memory { QStringLiteral("dso.capture"), MemoryBudget::Kind::Capture };
+
+    explicit DsoCapturePrivate(DsoCapture * const q);
+
+    void setService(DsoService * const newService);
+    bool reserveSamples(const qsizetype count);
+
+public Q_SLOTS:
+    void metadataRead(const DsoService::Metadata &newMetadata);
+    void samplesRead(const DsoService::Samples &chunk);
+    void completionTimedOut();
+
+protected:
+    DsoCapture * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(DsoCapture)
+    Q_DISABLE_COPY(DsoCapturePrivate)
+    QTPOKIT_BEFRIEND_TEST(DsoCapture)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_DSOCAPTURE_P_H
@@ -9,13 +9,14 @@
 #include <qtpokit/dsoservice.h>
 #include <qtpokit/pokitmeter.h>
 #include <qtpokit/pokitpro.h>
+#include <qtpokit/pokittrace.h>
+#include <pokitcodec/pokitcodec.h>
+#include "characteristiclayout_p.h"
 #include "dsoservice_p.h"
 #include "pokitproducts_p.h"
 #include "../stringliterals_p.h"
 
-#include <QDataStream>
-#include <QIODevice>
-#include <QtEndian>
+#include <QMetaMethod>
 
 QTPOKIT_BEGIN_NAMESPACE
 DOKIT_USE_STRINGLITERALS
@@ -149,10 +150,8 @@ bool DsoService::readMetadataCharacteristic()
  */
 bool DsoService::setSettings(const Settings &settings)
 {
-    Q_D(const DsoService);
-    const QLowEnergyCharacteristic characteristic =
-        d->getCharacteristic(CharacteristicUuids::settings);
-    if (!characteristic.isValid()) {
+    Q_D(DsoService);
+    if (!d->hasCharacteristic(CharacteristicUuids::settings)) {
         return false;
     }
 
@@ -161,8 +160,19 @@ bool DsoService::setSettings(const Settings &settings)
         return false;
     }
 
-    d->service->writeCharacteristic(characteristic, value);
-    return (d->service->error() != QLowEnergyService::ServiceError::CharacteristicWriteError);
+    return d->writeCharacteristic(CharacteristicUuids::settings, value);
+}
+
+/*!
+ * Asynchronous variant of setSettings().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the settings write. The future's result is
+ * \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DsoService::setSettingsAsync(const Settings &settings)
+{
+    Q_D(DsoService);
+    return d->whenFinished([this, settings]{ return setSettings(settings); });
 }
 
 /*!
@@ -182,6 +192,18 @@ bool DsoService::startDso(const Settings &settings)
     return setSettings(settings);
 }
 
+/*!
+ * Asynchronous variant of startDso().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the settings write. The future's result is
+ * \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DsoService::startDsoAsync(const Settings &settings)
+{
+    Q_D(DsoService);
+    return d->whenFinished([this, settings]{ return startDso(settings); });
+}
+
 /*!
  * Fetch DSO samples.
  *
@@ -200,12 +222,29 @@ bool DsoService::fetchSamples()
     return setSettings({ DsoService::Command::ResendData, 0, DsoService::Mode::Idle, 0, 0, 0 });
 }
 
+/*!
+ * Asynchronous variant of fetchSamples().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the settings write. The future's result is
+ * \c true if the request was queued, and succeeded, otherwise \c false.
+ *
+ * Note, the future finishes once the device has acknowledged the request, not once all samples have been received;
+ * the samples are still reported via samplesRead as usual.
+ */
+QFuture<bool> DsoService::fetchSamplesAsync()
+{
+    Q_D(DsoService);
+    return d->whenFinished([this]{ return fetchSamples(); });
+}
+
 /*!
  * Returns the most recent value of the `DSO` service's `Metadata` characteristic.
  *
- * The returned value, if any, is from the underlying Bluetooth stack's cache. If no such value is
- * currently available (ie the serviceDetailsDiscovered signal has not been emitted yet), then the
- * returned DsoService::Metadata::scale member will be a quiet NaN, which can be checked like:
+ * The returned value is the most recently read, or notified, metadata, as held in a lock-free LatestValue cell. So
+ * this function may be called from any thread, at any rate, without locking, re-parsing, or touching the underlying
+ * Bluetooth stack's objects. If no such value is available yet (ie the `Metadata` characteristic has not been read,
+ * or notified, yet), then the returned DsoService::Metadata::scale member will be a quiet NaN, which can be checked
+ * like:
  *
  * ```
  * const DsoService::Metadata metadata = multimeterService->metadata();
@@ -217,10 +256,7 @@ bool DsoService::fetchSamples()
 DsoService::Metadata DsoService::metadata() const
 {
     Q_D(const DsoService);
-    const QLowEnergyCharacteristic characteristic =
-        d->getCharacteristic(CharacteristicUuids::metadata);
-    return (characteristic.isValid()) ? DsoServicePrivate::parseMetadata(characteristic.value())
-        : Metadata{ DsoStatus::Error, std::numeric_limits<float>::quiet_NaN(), Mode::Idle, 0, 0, 0, 0 };
+    return d->latestMetadata.load();
 }
 
 /*!
@@ -238,6 +274,18 @@ bool DsoService::enableMetadataNotifications()
     return d->enableCharacteristicNotificatons(CharacteristicUuids::metadata);
 }
 
+/*!
+ * Asynchronous variant of enableMetadataNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DsoService::enableMetadataNotificationsAsync()
+{
+    Q_D(DsoService);
+    return d->whenFinished([this]{ return enableMetadataNotifications(); });
+}
+
 /*!
  * Disables client-side notifications of DSO metadata changes.
  *
@@ -251,6 +299,18 @@ bool DsoService::disableMetadataNotifications()
     return d->disableCharacteristicNotificatons(CharacteristicUuids::metadata);
 }
 
+/*!
+ * Asynchronous variant of disableMetadataNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DsoService::disableMetadataNotificationsAsync()
+{
+    Q_D(DsoService);
+    return d->whenFinished([this]{ return disableMetadataNotifications(); });
+}
+
 /*!
  * Enables client-side notifications of DSO readings.
  *
@@ -264,6 +324,18 @@ bool DsoService::enableReadingNotifications()
     return d->enableCharacteristicNotificatons(CharacteristicUuids::reading);
 }
 
+/*!
+ * Asynchronous variant of enableReadingNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DsoService::enableReadingNotificationsAsync()
+{
+    Q_D(DsoService);
+    return d->whenFinished([this]{ return enableReadingNotifications(); });
+}
+
 /*!
  * Disables client-side notifications of DSO readings.
  *
@@ -275,6 +347,45 @@ bool DsoService::disableReadingNotifications()
     return d->disableCharacteristicNotificatons(CharacteristicUuids::reading);
 }
 
+/*!
+ * Asynchronous variant of disableReadingNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> DsoService::disableReadingNotificationsAsync()
+{
+    Q_D(DsoService);
+    return d->whenFinished([this]{ return disableReadingNotifications(); });
+}
+
+/*!
+ * Returns the buffer that parsed `Reading` samples are pushed into, if any.
+ *
+ * \see setSamplesBuffer
+ */
+RingBuffer<DsoService::Samples> * DsoService::samplesBuffer() const
+{
+    Q_D(const DsoService);
+    return d->samplesBuffer;
+}
+
+/*!
+ * Sets the \a buffer that parsed `Reading` samples will be pushed into, as well as being emitted via samplesRead().
+ *
+ * This allows a consumer on another thread to drain the samples, without a slow consumer stalling the thread that
+ * handles this service's BLE events. This object does not take ownership of \a buffer, which must remain valid until
+ * replaced (or cleared, via \c nullptr). Only this service (on its controller's thread) may push into \a buffer.
+ *
+ * \see samplesBuffer
+ * \see RingBuffer
+ */
+void DsoService::setSamplesBuffer(RingBuffer<Samples> * const buffer)
+{
+    Q_D(DsoService);
+    d->samplesBuffer = buffer;
+}
+
 /*!
  * \fn DsoService::settingsWritten
  *
@@ -300,6 +411,44 @@ bool DsoService::disableReadingNotifications()
  * \see stopSampling
  */
 
+/*!
+ * \fn DsoService::rawSamplesRead
+ *
+ * This signal is emitted when the `Reading` characteristic has been notified, with the notification's raw \a samples,
+ * as little-endian 16-bit integers (to be scaled by the most recent `Metadata` value's `scale`). The \a samples share
+ * the notification's own data (QByteArray being implicitly shared), so can be handed on to binary sinks, such as
+ * files, without any copying.
+ *
+ * Moreover, if nothing requires the decoded samples (that is, nothing is connected to samplesRead, or
+ * scaledSamplesRead, and there is no samplesBuffer, or batching), then the samples are not decoded at all. Values of
+ * odd size are not emitted, but are instead logged, and counted, as per samplesRead.
+ *
+ * \see samplesRead
+ * \see metadataRead
+ */
+
+/*!
+ * \fn DsoService::scaledSamplesRead
+ *
+ * This signal is emitted when the `Reading` characteristic has been notified, after the samples have been multiplied
+ * by the `scale` of the most recent `Metadata` value. It is only emitted if something is connected to it, and the
+ * `Metadata` characteristic has been read (or notified) at least once.
+ *
+ * \see samplesRead
+ * \see metadataRead
+ */
+
+/*!
+ * \fn DsoService::samplesBatchRead
+ *
+ * This signal is emitted, if batching is enabled (see setBatching()), with the samples of one or more consecutive
+ * `Reading` notifications, in the order they were notified, each as also emitted via samplesRead. Any batch in
+ * progress is emitted before the next metadataRead, so batches never span captures.
+ *
+ * \see samplesRead
+ * \see setBatching
+ */
+
 
 /*!
  * \cond internal
@@ -311,12 +460,20 @@ bool DsoService::disableReadingNotifications()
 /*!
  * \internal
  * Constructs a new DsoServicePrivate object with public implementation \a q.
+ *
+ * The `Settings` characteristic is resumable, so after a reconnection the last DSO request is made again, in place of
+ * the capture the disconnection interrupted.
  */
 DsoServicePrivate::DsoServicePrivate(
     QLowEnergyController * controller, DsoService * const q)
     : AbstractPokitServicePrivate(DsoService::serviceUuid, controller, q)
 {
-
+    memoryStream = &samplePool.memoryStream();
+    setNotificationHandler(DsoService::CharacteristicUuids::metadata,
+        [this](const QByteArray &value){ emitMetadata(value); });
+    setNotificationHandler(DsoService::CharacteristicUuids::reading,
+        [this](const QByteArray &value){ emitSamples(value); });
+    resumableCharacteristics.insert(DsoService::CharacteristicUuids::settings);
 }
 
 /*!
@@ -324,22 +481,12 @@ DsoServicePrivate::DsoServicePrivate(
  */
 QByteArray DsoServicePrivate::encodeSettings(const DsoService::Settings &settings)
 {
-    static_assert(sizeof(settings.command)         == 1, "Expected to be 1 byte.");
-    static_assert(sizeof(settings.triggerLevel)    == 4, "Expected to be 2 bytes.");
-    static_assert(sizeof(settings.mode)            == 1, "Expected to be 1 byte.");
-    static_assert(sizeof(settings.range)           == 1, "Expected to be 1 byte.");
-    static_assert(sizeof(settings.samplingWindow)  == 4, "Expected to be 4 bytes.");
-    static_assert(sizeof(settings.numberOfSamples) == 2, "Expected to be 2 bytes.");
-
-    QByteArray value;
-    QDataStream stream(&value, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::LittleEndian);
-    stream.setFloatingPointPrecision(QDataStream::SinglePrecision); // 32-bit floats, not 64-bit.
-    stream << (quint8)settings.command << settings.triggerLevel << (quint8)settings.mode
-           << settings.range << settings.samplingWindow << settings.numberOfSamples;
-
-    Q_ASSERT(value.size() == 13);
-    return value;
+    std::array<std::byte, PokitCodec::Dso::settingsSize> value{};
+    PokitCodec::Dso::encodeSettings({
+        static_cast<quint8>(settings.command), settings.triggerLevel, static_cast<quint8>(settings.mode),
+        settings.range, settings.samplingWindow, settings.numberOfSamples
+    }, value);
+    return CharacteristicLayout::toByteArray(value.data(), value.size());
 }
 
 /*!
@@ -352,22 +499,27 @@ DsoService::Metadata DsoServicePrivate::parseMetadata(const QByteArray &value)
         DsoService::Mode::Idle, 0, 0, 0, 0
     };
 
-    if (!checkSize(u"Metadata"_s, value, 17, 17)) {
+    constexpr int size = PokitCodec::Dso::metadataSize;
+    PokitCodec::Dso::Metadata decoded{};
+    if ((!checkSize(u"Metadata"_s, value, size, size)) ||
+        (!PokitCodec::Dso::parseMetadata(CharacteristicLayout::toByteSpan(value), decoded))) {
         return metadata;
     }
 
-    metadata.status          = static_cast<DsoService::DsoStatus>(value.at(0));
-    metadata.scale           = qFromLittleEndian<float>(value.mid(1,4).constData());
-    metadata.mode            = static_cast<DsoService::Mode>(value.at(5));
-    metadata.range           = static_cast<quint8>(value.at(6));
-    metadata.samplingWindow  = qFromLittleEndian<quint32>(value.mid(7,4).constData());
-    metadata.numberOfSamples = qFromLittleEndian<quint16>(value.mid(11,2).constData());
-    metadata.samplingRate    = qFromLittleEndian<quint32>(value.mid(13,4).constData());
+    metadata.status          = static_cast<DsoService::DsoStatus>(decoded.status);
+    metadata.scale           = decoded.scale;
+    metadata.mode            = static_cast<DsoService::Mode>(decoded.mode);
+    metadata.range           = decoded.range;
+    metadata.samplingWindow  = decoded.samplingWindow;
+    metadata.numberOfSamples = decoded.numberOfSamples;
+    metadata.samplingRate    = decoded.samplingRate;
     return metadata;
 }
 
 /*!
  * Parses the `Reading` \a value into a DsoService::Samples vector.
+ *
+ * \see decodeSamples
  */
 DsoService::Samples DsoServicePrivate::parseSamples(const QByteArray &value)
 {
@@ -375,15 +527,160 @@ DsoService::Samples DsoServicePrivate::parseSamples(const QByteArray &value)
     if ((value.size()%2) != 0) {
         qCWarning(lc).noquote() << tr("Samples value has odd size %1 (should be even): %2")
             .arg(value.size()).arg(toHexString(value));
+        countParseFailure();
         return samples;
     }
-    while ((samples.size()*2) < value.size()) {
-        samples.append(qFromLittleEndian<qint16>(value.mid(samples.size()*2,2).constData()));
+    samples.resize(value.size()/2);
+    decodeSamples(value.constData(), value.size(), samples.data());
+    qCDebug(lc).noquote() << tr("Read %n sample/s from %1-bytes.", nullptr, samples.size()).arg(value.size());
+    return samples;
+}
+
+/*!
+ * Parses the `Reading` \a value into a DsoService::Samples vector, acquired from \a pool, such that (once the pool has
+ * warmed up, and as long as consumers keep up) no heap allocations are required.
+ *
+ * \see SamplePool
+ */
+DsoService::Samples DsoServicePrivate::parseSamples(const QByteArray &value, SamplePool<qint16> &pool)
+{
+    QTPOKIT_TRACE_ZONE(Parse, "dsoSamples");
+    if ((value.size()%2) != 0) {
+        return parseSamples(value); // Logs, and counts, the failure.
     }
+    QVector<qint16> &samples = pool.acquire(value.size()/2);
+    decodeSamples(value.constData(), value.size(), samples.data());
     qCDebug(lc).noquote() << tr("Read %n sample/s from %1-bytes.", nullptr, samples.size()).arg(value.size());
     return samples;
 }
 
+/*!
+ * Decodes \a size bytes of little-endian `Reading` \a data into the caller-owned \a samples buffer, which must have
+ * room for at least \a size / 2 samples.
+ *
+ * Unlike parseSamples, this function performs no allocations, so callers that manage their own sample storage can
+ * decode each notification directly into place. The whole payload is converted in a single pass, which on
+ * little-endian hosts reduces to a plain memory copy.
+ *
+ * Returns \c true on success, or \c false if \a size is odd (in which case \a samples is left untouched).
+ *
+ * \see parseSamples
+ * \see PokitCodec::decodeSamples
+ */
+bool DsoServicePrivate::decodeSamples(const char * const data, const qsizetype size, qint16 * const samples)
+{
+    return PokitCodec::decodeSamples(PokitCodec::ByteSpan(reinterpret_cast<const std::byte *>(data), (std::size_t)size),
+                                     samples);
+}
+
+/*!
+ * Returns \a samples multiplied by \a scale.
+ *
+ * The loop is intentionally trivial, so that compilers are free to vectorise it.
+ */
+DsoService::ScaledSamples DsoServicePrivate::scaleSamples(const DsoService::Samples &samples, const float scale)
+{
+    DsoService::ScaledSamples scaled(samples.size());
+    const qint16 * const in = samples.constData();
+    float * const out = scaled.data();
+    for (qsizetype index = 0; index < samples.size(); ++index) {
+        out[index] = in[index] * scale;
+    }
+    return scaled;
+}
+
+/*!
+ * Parses the `Metadata` \a value, stores it as the latestMetadata, records its scale (for scaling subsequent samples),
+ * begins accounting for the transfer of the samples it describes, then emits metadataRead.
+ */
+void DsoServicePrivate::emitMetadata(const QByteArray &value)
+{
+    Q_Q(DsoService);
+    const DsoService::Metadata metadata = parseMetadata(value);
+    latestMetadata.store(metadata);
+    scale = metadata.scale;
+    flushBatch();
+    beginTransfer((metadata.status == DsoService::DsoStatus::Error) ? 0 : metadata.numberOfSamples * 2);
+    Q_EMIT q->metadataRead(metadata);
+}
+
+/*!
+ * Parses the `Reading` \a value, adds it to the transfer in progress (if any), pushes it into the samplesBuffer (if
+ * any), then emits samplesRead (counting its latencies, see countLatency()), and (if anything is connected to it,
+ * and the current scale is known) scaledSamplesRead. If batching, the samples are also added to the batch in
+ * progress, which is emitted via samplesBatchRead once full, or at the end of the transfer.
+ *
+ * If anything is connected to rawSamplesRead, then \a value is also emitted via that (just before samplesRead), and
+ * if nothing else requires the decoded samples (see samplesRequired()), then \a value is not parsed at all.
+ */
+void DsoServicePrivate::emitSamples(const QByteArray &value)
+{
+    Q_Q(DsoService);
+    const bool raw = ((value.size()%2) == 0)
+        && (q->isSignalConnected(QMetaMethod::fromSignal(&DsoService::rawSamplesRead)));
+    if ((raw) && (!samplesRequired())) {
+        const qint64 receivedAt = steadyTimestamp();
+        countTransfer(value);
+        Q_EMIT q->rawSamplesRead(value);
+        QTPOKIT_TRACE_POINT(Emit, "dsoRawSamples", value.size()/2);
+        countLatency(receivedAt);
+        return;
+    }
+
+    const DsoService::Samples samples = parseSamples(value, samplePool);
+    QTPOKIT_TRACE_POINT(Parse, "dsoSamples", samples.size());
+    const qint64 parsedAt = steadyTimestamp();
+    const bool transferring = transfer.has_value();
+    countTransfer(value);
+    if (samplesBuffer) {
+        samplesBuffer->push(samples);
+    }
+    if (raw) {
+        Q_EMIT q->rawSamplesRead(value);
+    }
+    {
+        QTPOKIT_TRACE_ZONE(Emit, "dsoSamples");
+        Q_EMIT q->samplesRead(samples);
+    }
+    QTPOKIT_TRACE_POINT(Emit, "dsoSamples", samples.size());
+    countLatency(parsedAt);
+    if (q->isSignalConnected(QMetaMethod::fromSignal(&DsoService::scaledSamplesRead))) {
+        if (qIsNaN(scale)) {
+            qCDebug(lc).noquote() << tr("Not emitting scaled samples, since no metadata has been received yet.");
+        } else {
+            Q_EMIT q->scaledSamplesRead(scaleSamples(samples, scale));
+        }
+    }
+    if (isBatching()) {
+        samplesBatch.append(samples);
+        batchAppended(samplesBatch.size(), (transferring) && (!transfer));
+    }
+}
+
+/*!
+ * Returns \c true if anything requires decoded `Reading` samples, that is, if there is a samplesBuffer, batching is
+ * enabled, or anything is connected to samplesRead, or scaledSamplesRead.
+ */
+bool DsoServicePrivate::samplesRequired() const
+{
+    Q_Q(const DsoService);
+    return (samplesBuffer) || (isBatching())
+        || (q->isSignalConnected(QMetaMethod::fromSignal(&DsoService::samplesRead)))
+        || (q->isSignalConnected(QMetaMethod::fromSignal(&DsoService::scaledSamplesRead)));
+}
+
+/*!
+ * Implements AbstractPokitServicePrivate::emitBatch to emit, then clear, the samplesBatch, if not empty.
+ */
+void DsoServicePrivate::emitBatch()
+{
+    Q_Q(DsoService);
+    if (!samplesBatch.isEmpty()) {
+        Q_EMIT q->samplesBatchRead(samplesBatch);
+        samplesBatch.clear();
+    }
+}
+
 /*!
  * Implements AbstractPokitServicePrivate::characteristicRead to parse \a value, then emit a
  * specialised signal, for each supported \a characteristic.
@@ -399,9 +696,8 @@ void DsoServicePrivate::characteristicRead(const QLowEnergyCharacteristic &chara
         return;
     }
 
-    Q_Q(DsoService);
     if (characteristic.uuid() == DsoService::CharacteristicUuids::metadata) {
-        Q_EMIT q->metadataRead(parseMetadata(value));
+        emitMetadata(value);
         return;
     }
 
@@ -455,7 +751,6 @@ void DsoServicePrivate::characteristicChanged(const QLowEnergyCharacteristic &ch
 {
     AbstractPokitServicePrivate::characteristicChanged(characteristic, newValue);
 
-    Q_Q(DsoService);
     if (characteristic.uuid() == DsoService::CharacteristicUuids::settings) {
         qCWarning(lc).noquote() << tr("Settings characteristic is write-only, but somehow updated")
             << serviceUuid << characteristic.name() << characteristic.uuid();
@@ -463,12 +758,12 @@ void DsoServicePrivate::characteristicChanged(const QLowEnergyCharacteristic &ch
     }
 
     if (characteristic.uuid() == DsoService::CharacteristicUuids::metadata) {
-        Q_EMIT q->metadataRead(parseMetadata(newValue));
+        emitMetadata(newValue);
         return;
     }
 
     if (characteristic.uuid() == DsoService::CharacteristicUuids::reading) {
-        Q_EMIT q->samplesRead(parseSamples(newValue));
+        emitSamples(newValue);
         return;
     }
 
@@ -10,6 +10,8 @@
 #define QTPOKIT_DSOSERVICE_P_H
 
 #include <qtpokit/dsoservice.h>
+#include <qtpokit/latestvalue.h>
+#include <qtpokit/samplepool.h>
 
 #include "abstractpokitservice_p.h"
 
@@ -20,14 +22,31 @@ class QTPOKIT_EXPORT DsoServicePrivate : public AbstractPokitServicePrivate
     Q_OBJECT
 
 public:
+    float scale { std::numeric_limits<float>::quiet_NaN() }; ///< Scale from the most recent `Metadata` read.
+    RingBuffer<DsoService::Samples> * samplesBuffer { nullptr }; ///< Buffer to push samples into, if any.
+    SamplePool<qint16> samplePool { ///< Reusable buffers for parsed samples.
+        SamplePool<qint16>::defaultCapacity, QStringLiteral("dso.samples") };
+    LatestValue<DsoService::Metadata> latestMetadata { DsoService::Metadata{
+        DsoService::DsoStatus::Error, std::numeric_limits<float>::quiet_NaN(), DsoService::Mode::Idle, 0, 0, 0, 0
+    } }; ///< Most recent metadata, for metadata() to load from any thread.
+    QVector<DsoService::Samples> samplesBatch; ///< Samples not yet emitted via samplesBatchRead, if batching.
+
     explicit DsoServicePrivate(QLowEnergyController * controller, DsoService * const q);
 
     static QByteArray encodeSettings(const DsoService::Settings &settings);
 
     static DsoService::Metadata parseMetadata(const QByteArray &value);
     static DsoService::Samples parseSamples(const QByteArray &value);
+    static DsoService::Samples parseSamples(const QByteArray &value, SamplePool<qint16> &pool);
+    static DsoService::ScaledSamples scaleSamples(const DsoService::Samples &samples, const float scale);
+    static bool decodeSamples(const char * const data, const qsizetype size, qint16 * const samples);
 
 protected:
+    void emitMetadata(const QByteArray &value);
+    void emitSamples(const QByteArray &value);
+    bool samplesRequired() const;
+    void emitBatch() override;
+
     void characteristicRead(const QLowEnergyCharacteristic &characteristic,
                             const QByteArray &value) override;
     void characteristicWritten(const QLowEnergyCharacteristic &characteristic,
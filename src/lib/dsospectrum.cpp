@@ -0,0 +1,241 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the DsoSpectrum and DsoSpectrumPrivate classes.
+ */
+
+#include <qtpokit/dsocapture.h>
+#include <qtpokit/dsospectrum.h>
+#include "dsospectrum_p.h"
+
+#include <QtMath>
+
+#include <utility>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class DsoSpectrum
+ *
+ * The DsoSpectrum class computes the amplitude spectrum of complete DSO captures.
+ *
+ * Each capture is scaled, Hann windowed, zero-padded to the next power of two, and transformed via a real FFT
+ * (implemented as a half-size complex FFT). The resulting single-sided amplitude spectrum is corrected for the
+ * window's coherent gain, so a pure sinusoid of amplitude \e A will show a peak of approximately \e A.
+ *
+ * FFT plans (window coefficients, twiddle factors, and so on) are retained between captures, so consecutive captures
+ * of the same size (the common case) do not recompute them.
+ *
+ * If constructed with a DsoCapture, spectrumReady will be emitted for every completed capture. Alternatively,
+ * analyse() may be invoked directly.
+ */
+
+/*!
+ * Constructs a new DsoSpectrum object that analyses captures completed by \a capture, with \a parent.
+ *
+ * \a capture may be \c nullptr, in which case only analyse() is useful.
+ */
+DsoSpectrum::DsoSpectrum(DsoCapture * const capture, QObject * parent)
+    : QObject(parent), d_ptr(new DsoSpectrumPrivate(this))
+{
+    Q_D(DsoSpectrum);
+    d->setCapture(capture);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new DsoSpectrum object with \a capture, \a parent, and private implementation \a d.
+ */
+DsoSpectrum::DsoSpectrum(DsoSpectrumPrivate * const d, DsoCapture * const capture, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setCapture(capture);
+}
+/// \endcond
+
+/*!
+ * Destroys this DsoSpectrum object.
+ */
+DsoSpectrum::~DsoSpectrum()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the DSO capture this object analyses, if any.
+ */
+DsoCapture * DsoSpectrum::capture() const
+{
+    Q_D(const DsoSpectrum);
+    return d->capture;
+}
+
+/*!
+ * Returns the amplitude spectrum of \a samples, using \a metadata's scale and sampling rate.
+ *
+ * If fewer than two samples are given, the returned spectrum will have no magnitudes. Just two samples are too few
+ * for a Hann window, so are analysed with a rectangular window instead.
+ */
+DsoSpectrum::Spectrum DsoSpectrum::analyse(const DsoService::Metadata &metadata, const DsoService::Samples &samples)
+{
+    Q_D(DsoSpectrum);
+    if (samples.size() < 2) {
+        return { 0.0f, {} };
+    }
+
+    // Pack the scaled, windowed, real samples into a half-size complex sequence (even samples as the real parts, and
+    // odd samples as the imaginary parts), zero-padding as needed.
+    d->plan(samples.size());
+    const qsizetype half = d->fftSize / 2;
+    const auto windowed = [&](const qsizetype index) {
+        return (index < samples.size()) ? samples.at(index) * metadata.scale * d->window.at(index) : 0.0f;
+    };
+    for (qsizetype index = 0; index < half; ++index) {
+        d->buffer[index] = { windowed(index * 2), windowed((index * 2) + 1) };
+    }
+    d->transform();
+
+    // Unpack the half-size complex FFT into the real FFT's (single-sided) spectrum.
+    Spectrum spectrum{ (float)metadata.samplingRate / (float)d->fftSize, QVector<float>(half + 1) };
+    for (qsizetype bin = 0; bin <= half; ++bin) {
+        const std::complex<float> z = d->buffer.at(bin % half);
+        const std::complex<float> zc = std::conj(d->buffer.at((half - bin) % half));
+        const std::complex<float> even = (z + zc) * 0.5f;
+        const std::complex<float> odd = (z - zc) * std::complex<float>(0.0f, -0.5f);
+        const std::complex<float> value = even + (d->unpackTwiddles.at(bin) * odd);
+        const float sides = ((bin == 0) || (bin == half)) ? 1.0f : 2.0f;
+        spectrum.magnitudes[bin] = sides * std::abs(value) / d->windowSum;
+    }
+    return spectrum;
+}
+
+/*!
+ * \fn DsoSpectrum::spectrumReady
+ *
+ * This signal is emitted when the \a spectrum of the capture identified by \a sequenceNumber has been computed.
+ */
+
+/*!
+ * \cond internal
+ * \class DsoSpectrumPrivate
+ *
+ * The DsoSpectrumPrivate class provides private implementation for DsoSpectrum.
+ */
+
+/*!
+ * Constructs a new DsoSpectrumPrivate object with public implementation \a q.
+ */
+DsoSpectrumPrivate::DsoSpectrumPrivate(DsoSpectrum * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Sets \a newCapture as the DSO capture to analyse, disconnecting from any previous capture.
+ */
+void DsoSpectrumPrivate::setCapture(DsoCapture * const newCapture)
+{
+    if (newCapture == capture) {
+        return;
+    }
+    if (capture) {
+        disconnect(capture, nullptr, this, nullptr);
+    }
+    capture = newCapture;
+    if (capture) {
+        connect(capture, &DsoCapture::captureComplete, this, &DsoSpectrumPrivate::captureComplete);
+    }
+}
+
+/*!
+ * Prepares the window, permutation and twiddle factors for transforming \a size samples, unless already prepared.
+ */
+void DsoSpectrumPrivate::plan(const qsizetype size)
+{
+    if (size == plannedSize) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Planning FFT for %Ln sample/s.", nullptr, size);
+    plannedSize = size;
+    fftSize = 2;
+    while (fftSize < size) {
+        fftSize *= 2;
+    }
+    const qsizetype half = fftSize / 2;
+
+    window.resize(size);
+    windowSum = 0.0f;
+    for (qsizetype index = 0; index < size; ++index) {
+        window[index] = 0.5f - (0.5f * qCos((2.0 * M_PI * index) / (size - 1)));
+        windowSum += window.at(index);
+    }
+    if (windowSum <= 0.0f) {
+        // Too few samples (ie two) for any of the Hann window to be non-zero, so fall back to a rectangular window.
+        window.fill(1.0f);
+        windowSum = (float)size;
+    }
+
+    int bits = 0;
+    while (((qsizetype)1 << bits) < half) {
+        ++bits;
+    }
+    bitReversal.resize(half);
+    for (qsizetype index = 0; index < half; ++index) {
+        qsizetype reversed = 0;
+        for (int bit = 0; bit < bits; ++bit) {
+            reversed |= ((index >> bit) & 1) << (bits - 1 - bit);
+        }
+        bitReversal[index] = reversed;
+    }
+
+    twiddles.resize(half / 2);
+    for (qsizetype index = 0; index < twiddles.size(); ++index) {
+        twiddles[index] = std::polar(1.0f, (float)((-2.0 * M_PI * index) / half));
+    }
+    unpackTwiddles.resize(half + 1);
+    for (qsizetype index = 0; index < unpackTwiddles.size(); ++index) {
+        unpackTwiddles[index] = std::polar(1.0f, (float)((-2.0 * M_PI * index) / fftSize));
+    }
+    buffer.resize(half);
+}
+
+/*!
+ * Performs an in-place, iterative radix-2 complex FFT of #buffer.
+ */
+void DsoSpectrumPrivate::transform()
+{
+    const qsizetype size = buffer.size();
+    for (qsizetype index = 0; index < size; ++index) {
+        if (index < bitReversal.at(index)) {
+            std::swap(buffer[index], buffer[bitReversal.at(index)]);
+        }
+    }
+    for (qsizetype length = 2; length <= size; length *= 2) {
+        const qsizetype step = size / length;
+        for (qsizetype start = 0; start < size; start += length) {
+            for (qsizetype offset = 0; offset < length / 2; ++offset) {
+                const std::complex<float> u = buffer.at(start + offset);
+                const std::complex<float> v = buffer.at(start + offset + length / 2) * twiddles.at(offset * step);
+                buffer[start + offset] = u + v;
+                buffer[start + offset + length / 2] = u - v;
+            }
+        }
+    }
+}
+
+/*!
+ * Computes the spectrum of the completed capture (\a metadata and \a samples), and emits DsoSpectrum::spectrumReady
+ * along with the capture's \a sequenceNumber.
+ */
+void DsoSpectrumPrivate::captureComplete(const DsoService::Metadata &metadata, const DsoService::Samples &samples,
+                                         const quint64 sequenceNumber)
+{
+    Q_Q(DsoSpectrum);
+    Q_EMIT q->spectrumReady(q->analyse(metadata, samples), sequenceNumber);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the DsoSpectrumPrivate class.
+ */
+
+#ifndef QTPOKIT_DSOSPECTRUM_P_H
+#define QTPOKIT_DSOSPECTRUM_P_H
+
+#include <qtpokit/dsospectrum.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+
+#include <complex>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT DsoSpectrumPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.dso.spectrum", QtInfoMsg); ///< Logging category.
+
+    DsoCapture * capture { nullptr }; ///< DSO capture to analyse.
+
+    qsizetype plannedSize { 0 };                    ///< Number of input samples the current plan is for.
+    qsizetype fftSize { 0 };                        ///< Real FFT size (#plannedSize rounded up to a power of two).
+    QVector<float> window;                          ///< Hann window coefficients, of #plannedSize.
+    float windowSum { 0.0f };                       ///< Sum of the #window coefficients.
+    QVector<qsizetype> bitReversal;                 ///< Bit-reversal permutation, of half #fftSize.
+    QVector<std::complex<float>> twiddles;          ///< Twiddle factors for the half-size complex FFT.
+    QVector<std::complex<float>> unpackTwiddles;    ///< Twiddle factors for unpacking the real FFT.
+    QVector<std::complex<float>> buffer;            ///< Workspace for the half-size complex FFT.
+
+    explicit DsoSpectrumPrivate(DsoSpectrum * const q);
+
+    void setCapture(DsoCapture * const newCapture);
+    void plan(const qsizetype size);
+    void transform();
+
+public Q_SLOTS:
+    void captureComplete(const DsoService::Metadata &metadata, const DsoService::Samples &samples,
+                         const quint64 sequenceNumber);
+
+protected:
+    DsoSpectrum * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(DsoSpectrum)
+    Q_DISABLE_COPY(DsoSpectrumPrivate)
+    QTPOKIT_BEFRIEND_TEST(DsoSpectrum)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_DSOSPECTRUM_P_H
@@ -0,0 +1,252 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the DsoStatistics and DsoStatisticsPrivate classes.
+ */
+
+#include <qtpokit/dsostatistics.h>
+#include "dsostatistics_p.h"
+
+#include <QtMath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class DsoStatistics
+ *
+ * The DsoStatistics class computes summary statistics for DSO captures, as each `Reading` notification arrives.
+ *
+ * Statistics are accumulated incrementally, in constant memory, so samples need not be stored. Mean and variance are
+ * accumulated via Welford's algorithm, for numerical stability.
+ *
+ * The fundamental frequency is estimated by counting rising crossings of the running mean, with a hysteresis band of
+ * half the running standard deviation to reject noise. As such, it's only meaningful for reasonably periodic signals
+ * spanning at least a couple of cycles.
+ *
+ * Each time a DsoService emits DsoService::metadataRead, statistics are reset for the new capture. Once the number of
+ * samples reported by that metadata have been accumulated, summaryReady is emitted.
+ */
+
+/*!
+ * Constructs a new DsoStatistics object that analyses captures from \a service, with \a parent.
+ */
+DsoStatistics::DsoStatistics(DsoService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new DsoStatisticsPrivate(this))
+{
+    Q_D(DsoStatistics);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new DsoStatistics object with \a service, \a parent, and private implementation \a d.
+ */
+DsoStatistics::DsoStatistics(DsoStatisticsPrivate * const d, DsoService * const service, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service);
+}
+/// \endcond
+
+/*!
+ * Destroys this DsoStatistics object.
+ */
+DsoStatistics::~DsoStatistics()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the DSO service this object analyses captures from.
+ */
+DsoService * DsoStatistics::service() const
+{
+    Q_D(const DsoStatistics);
+    return d->service;
+}
+
+/*!
+ * Returns the metadata of the current capture.
+ */
+DsoService::Metadata DsoStatistics::metadata() const
+{
+    Q_D(const DsoStatistics);
+    return d->metadata;
+}
+
+/*!
+ * Returns the statistics accumulated so far for the current capture.
+ */
+DsoStatistics::Summary DsoStatistics::summary() const
+{
+    Q_D(const DsoStatistics);
+    return d->summary();
+}
+
+/*!
+ * Returns the statistics of a complete capture's \a samples, scaled according to \a metadata.
+ *
+ * Unlike the rest of this class, this function needs no DsoService, and is thread-safe, so may be used to analyse
+ * captures from any source, on any thread (such as a GUI's worker thread).
+ */
+DsoStatistics::Summary DsoStatistics::summarise(const DsoService::Metadata &metadata,
+                                                const DsoService::Samples &samples)
+{
+    DsoStatisticsPrivate accumulator(nullptr);
+    accumulator.metadata = metadata;
+    for (const qint16 sample: samples) {
+        accumulator.addSample(sample * (double)metadata.scale);
+    }
+    return accumulator.summary();
+}
+
+/*!
+ * Discards all statistics accumulated for the current capture.
+ */
+void DsoStatistics::reset()
+{
+    Q_D(DsoStatistics);
+    d->clear();
+}
+
+/*!
+ * \fn DsoStatistics::summaryReady
+ *
+ * This signal is emitted when all of the current capture's samples have been accumulated into \a summary.
+ */
+
+/*!
+ * \cond internal
+ * \class DsoStatisticsPrivate
+ *
+ * The DsoStatisticsPrivate class provides private implementation for DsoStatistics.
+ */
+
+/*!
+ * Constructs a new DsoStatisticsPrivate object with public implementation \a q.
+ */
+DsoStatisticsPrivate::DsoStatisticsPrivate(DsoStatistics * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Sets \a newService as the DSO service to analyse captures from, disconnecting from any previous service.
+ */
+void DsoStatisticsPrivate::setService(DsoService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &DsoService::metadataRead, this, &DsoStatisticsPrivate::metadataRead);
+        connect(service, &DsoService::samplesRead, this, &DsoStatisticsPrivate::samplesRead);
+    }
+}
+
+/*!
+ * Resets all accumulators.
+ */
+void DsoStatisticsPrivate::clear()
+{
+    count = 0;
+    mean = 0.0;
+    m2 = 0.0;
+    minimum = std::numeric_limits<double>::infinity();
+    maximum = -std::numeric_limits<double>::infinity();
+    level = 0;
+    crossings = 0;
+    firstCrossing = 0;
+    lastCrossing = 0;
+}
+
+/*!
+ * Accumulates a single (scaled) sample \a value.
+ */
+void DsoStatisticsPrivate::addSample(const double value)
+{
+    // Welford's online algorithm.
+    ++count;
+    const double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+
+    minimum = qMin(minimum, value);
+    maximum = qMax(maximum, value);
+
+    // Track rising crossings of the mean, with hysteresis.
+    const double hysteresis = (count < 2) ? 0.0 : qSqrt(m2 / count) / 2.0;
+    if (value > mean + hysteresis) {
+        if (level < 0) {
+            if (crossings++ == 0) {
+                firstCrossing = count - 1;
+            }
+            lastCrossing = count - 1;
+        }
+        level = 1;
+    } else if (value < mean - hysteresis) {
+        level = -1;
+    }
+}
+
+/*!
+ * Returns the statistics accumulated so far.
+ */
+DsoStatistics::Summary DsoStatisticsPrivate::summary() const
+{
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    if (count == 0) {
+        return { 0, nan, nan, nan, nan, nan, nan, nan };
+    }
+    const double variance = m2 / count;
+    const float frequency = ((crossings < 2) || (metadata.samplingRate == 0)) ? nan : (float)
+        ((crossings - 1) * (double)metadata.samplingRate / (double)(lastCrossing - firstCrossing));
+    return {
+        count,
+        (float)minimum,
+        (float)maximum,
+        (float)(maximum - minimum),
+        (float)mean,
+        (float)qSqrt(variance + (mean * mean)),
+        (float)qSqrt(variance),
+        frequency,
+    };
+}
+
+/*!
+ * Handles \a newMetadata by resetting the statistics, ready for the new capture's samples.
+ */
+void DsoStatisticsPrivate::metadataRead(const DsoService::Metadata &newMetadata)
+{
+    metadata = newMetadata;
+    clear();
+}
+
+/*!
+ * Accumulates \a samples, emitting DsoStatistics::summaryReady once all of the capture's samples have arrived.
+ */
+void DsoStatisticsPrivate::samplesRead(const DsoService::Samples &samples)
+{
+    if (qIsNaN(metadata.scale)) {
+        qCDebug(lc).noquote() << tr("Ignoring %Ln sample/s received before metadata.", nullptr, samples.size());
+        return;
+    }
+    const quint64 previousCount = count;
+    for (const qint16 sample: samples) {
+        addSample(sample * (double)metadata.scale);
+    }
+    if ((previousCount < metadata.numberOfSamples) && (count >= metadata.numberOfSamples)) {
+        Q_Q(DsoStatistics);
+        Q_EMIT q->summaryReady(summary());
+    }
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
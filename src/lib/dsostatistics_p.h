@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the DsoStatisticsPrivate class.
+ */
+
+#ifndef QTPOKIT_DSOSTATISTICS_P_H
+#define QTPOKIT_DSOSTATISTICS_P_H
+
+#include <qtpokit/dsostatistics.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT DsoStatisticsPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.dso.statistics", QtInfoMsg); ///< Logging category.
+
+    DsoService * service { nullptr }; ///< DSO service to analyse captures from.
+    DsoService::Metadata metadata {   ///< Metadata for the current capture.
+        DsoService::DsoStatus::Error, std::numeric_limits<float>::quiet_NaN(), DsoService::Mode::Idle, 0, 0, 0, 0
+    };
+
+    quint64 count { 0 };   ///< Number of samples accumulated for the current capture.
+    double mean { 0.0 };   ///< Running mean (Welford).
+    double m2 { 0.0 };     ///< Running sum of squared differences from the #mean (Welford).
+    double minimum { std::numeric_limits<double>::infinity() };  ///< Running minimum.
+    double maximum { -std::numeric_limits<double>::infinity() }; ///< Running maximum.
+    int level { 0 };       ///< Current position relative to the #mean hysteresis band (-1, 0 or +1).
+    quint64 crossings { 0 };     ///< Number of rising crossings of the #mean hysteresis band.
+    quint64 firstCrossing { 0 }; ///< Sample index of the first rising crossing.
+    quint64 lastCrossing { 0 };  ///< Sample index of the most recent rising crossing.
+
+    explicit DsoStatisticsPrivate(DsoStatistics * const q);
+
+    void setService(DsoService * const newService);
+
+    void clear();
+    void addSample(const double value);
+    DsoStatistics::Summary summary() const;
+
+public Q_SLOTS:
+    void metadataRead(const DsoService::Metadata &newMetadata);
+    void samplesRead(const DsoService::Samples &samples);
+
+protected:
+    DsoStatistics * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(DsoStatistics)
+    Q_DISABLE_COPY(DsoStatisticsPrivate)
+    QTPOKIT_BEFRIEND_TEST(DsoStatistics)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_DSOSTATISTICS_P_H
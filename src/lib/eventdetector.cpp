@@ -0,0 +1,353 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the EventDetector and EventDetectorPrivate classes.
+ */
+
+#include <qtpokit/eventdetector.h>
+#include "eventdetector_p.h"
+
+#include <QDateTime>
+#include <QtMath>
+
+#include <algorithm>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class EventDetector
+ *
+ * The EventDetector class watches a stream of timestamped values, such as multimeter readings, or data logger
+ * samples, for excursions beyond a threshold, and reports each excursion as a compact Event (its start, end, peak,
+ * and number of values), rather than every value within it. This allows long-running monitoring, such as for
+ * over-voltage or over-current conditions, to record only the events of interest.
+ *
+ * The threshold applies either to the values themselves (Quantity::Value), or to their rate of change, in units per
+ * second, between consecutive values (Quantity::RateOfChange). An event begins with the first quantity at, or beyond,
+ * the threshold (in the settings' Direction), and ends once the quantity returns past the threshold by more than
+ * Settings::hysteresis, so noise near the threshold does not split one event into many.
+ *
+ * Events shorter than Settings::minDuration are ignored. Otherwise, eventStarted is emitted as soon as an event has
+ * lasted Settings::minDuration (so alerts need not wait for the event to end), and eventFinished once it ends. An
+ * event's duration is its Event::end minus its Event::start, so a single-value event has zero duration.
+ *
+ * When attached to a multimeter service, each reading is timestamped on arrival, and erroneous readings are ignored.
+ * When attached to a data logger service, each sample is timestamped according to the logging session's metadata,
+ * with every fetch assumed to begin from the session's first sample.
+ */
+
+/*!
+ * Constructs a new EventDetector object, not attached to any service, with \a parent. Values may be added via
+ * addValue() instead.
+ */
+EventDetector::EventDetector(QObject * parent)
+    : QObject(parent), d_ptr(new EventDetectorPrivate(this))
+{
+
+}
+
+/*!
+ * Constructs a new EventDetector object that detects events in reading values from multimeter \a service, with
+ * \a parent.
+ */
+EventDetector::EventDetector(MultimeterService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new EventDetectorPrivate(this))
+{
+    Q_D(EventDetector);
+    d->setService(service);
+}
+
+/*!
+ * Constructs a new EventDetector object that detects events in (scaled) samples from data logger \a service, with
+ * \a parent.
+ */
+EventDetector::EventDetector(DataLoggerService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new EventDetectorPrivate(this))
+{
+    Q_D(EventDetector);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new EventDetector object with \a parent, and private implementation \a d.
+ */
+EventDetector::EventDetector(EventDetectorPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this EventDetector object.
+ */
+EventDetector::~EventDetector()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the service this object detects events in, if any.
+ */
+AbstractPokitService * EventDetector::service() const
+{
+    Q_D(const EventDetector);
+    return d->service;
+}
+
+/*!
+ * Returns the current detector settings.
+ */
+EventDetector::Settings EventDetector::settings() const
+{
+    Q_D(const EventDetector);
+    return d->settings;
+}
+
+/*!
+ * Sets the detector settings to \a settings, and resets the detector, or if \a settings are not valid (see
+ * isValid()), logs a warning, and leaves the current settings unchanged.
+ */
+void EventDetector::setSettings(const Settings &settings)
+{
+    Q_D(EventDetector);
+    if (!isValid(settings)) {
+        qCWarning(d->lc).noquote() << tr("Invalid event detector settings; keeping the current settings.");
+        return;
+    }
+    d->settings = settings;
+    d->clear();
+}
+
+/*!
+ * Returns \c true if the most recent value was within an event, even if that event has not yet lasted long enough to
+ * be reported.
+ */
+bool EventDetector::isActive() const
+{
+    Q_D(const EventDetector);
+    return d->active;
+}
+
+/*!
+ * Returns the number of events reported (via eventStarted) since construction, or the last reset().
+ */
+quint64 EventDetector::eventCount() const
+{
+    Q_D(const EventDetector);
+    return d->events;
+}
+
+/*!
+ * Returns the default detector settings: any value at, or above, zero, with no hysteresis, and no minimum duration.
+ */
+EventDetector::Settings EventDetector::defaultSettings()
+{
+    return { Quantity::Value, Direction::Above, 0.0f, 0.0f, 0 };
+}
+
+/*!
+ * Returns \c true if \a settings are valid. That is, with a known quantity and direction, a finite threshold, and a
+ * finite, non-negative, hysteresis.
+ */
+bool EventDetector::isValid(const Settings &settings)
+{
+    return ((settings.quantity == Quantity::Value) || (settings.quantity == Quantity::RateOfChange)) &&
+        ((settings.direction == Direction::Above) || (settings.direction == Direction::Below)) &&
+        (qIsFinite(settings.threshold)) && (qIsFinite(settings.hysteresis)) && (settings.hysteresis >= 0.0f);
+}
+
+/*!
+ * Adds \a value, taken at \a timestamp (in milliseconds since the epoch), to the stream, emitting eventStarted and/or
+ * eventFinished as appropriate. Values should be added in timestamp order. NaN values are ignored.
+ */
+void EventDetector::addValue(const float value, const qint64 timestamp)
+{
+    Q_D(EventDetector);
+    if (qIsNaN(value)) {
+        return;
+    }
+
+    float quantity = value;
+    if (d->settings.quantity == Quantity::RateOfChange) {
+        const bool hasRate = (qIsFinite(value)) && (qIsFinite(d->previousValue)) &&
+            (timestamp > d->previousTimestamp);
+        if (hasRate) {
+            quantity = (float)((value - d->previousValue) * 1000.0 / (double)(timestamp - d->previousTimestamp));
+        }
+        d->previousValue = (qIsFinite(value)) ? value : qQNaN(); // Rates across infinite values are meaningless.
+        d->previousTimestamp = timestamp;
+        if (!hasRate) {
+            return;
+        }
+    }
+
+    const float hysteresis = (d->settings.direction == Direction::Above) ? d->settings.hysteresis
+        : -d->settings.hysteresis;
+    if (!d->active) {
+        if (!d->isBeyond(quantity, d->settings.threshold)) {
+            return;
+        }
+        d->active = true;
+        d->started = false;
+        d->event = { timestamp, timestamp, quantity, 1 };
+    } else if (d->isBeyond(quantity, d->settings.threshold - hysteresis)) {
+        d->event.end = timestamp;
+        d->event.peak = (d->settings.direction == Direction::Above) ? std::max(d->event.peak, quantity)
+            : std::min(d->event.peak, quantity);
+        ++d->event.count;
+    } else {
+        d->finish();
+        return;
+    }
+
+    if ((!d->started) && (d->event.end - d->event.start >= (qint64)d->settings.minDuration)) {
+        d->started = true;
+        ++d->events;
+        Q_EMIT eventStarted(d->event);
+    }
+}
+
+/*!
+ * Ends the event in progress (if any), emitting eventFinished if that event has already been reported. This is
+ * typically called at the end of a stream, such that its final event is not lost.
+ */
+void EventDetector::flush()
+{
+    Q_D(EventDetector);
+    d->finish();
+}
+
+/*!
+ * Clears all detector state (without emitting the event in progress, if any), and the eventCount().
+ */
+void EventDetector::reset()
+{
+    Q_D(EventDetector);
+    d->clear();
+}
+
+/*!
+ * \fn EventDetector::eventStarted
+ *
+ * This signal is emitted when an \a event has lasted at least Settings::minDuration. The \a event's end, peak and
+ * count are as of that moment, and will likely have grown by the time eventFinished is emitted.
+ */
+
+/*!
+ * \fn EventDetector::eventFinished
+ *
+ * This signal is emitted when a previously started \a event has ended (or been flushed).
+ */
+
+/*!
+ * \cond internal
+ * \class EventDetectorPrivate
+ *
+ * The EventDetectorPrivate class provides private implementation for EventDetector.
+ */
+
+/*!
+ * Constructs a new EventDetectorPrivate object with public implementation \a q.
+ */
+EventDetectorPrivate::EventDetectorPrivate(EventDetector * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Sets \a newService as the service to detect events in, disconnecting from any previous service. \a newService must
+ * be a MultimeterService, a DataLoggerService, or \c nullptr.
+ */
+void EventDetectorPrivate::setService(AbstractPokitService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (auto * const meter = qobject_cast<MultimeterService *>(service); meter) {
+        connect(meter, &MultimeterService::readingRead, this, &EventDetectorPrivate::readingRead);
+    } else if (auto * const logger = qobject_cast<DataLoggerService *>(service); logger) {
+        connect(logger, &DataLoggerService::metadataRead, this, &EventDetectorPrivate::loggerMetadataRead);
+        connect(logger, &DataLoggerService::samplesRead, this, &EventDetectorPrivate::loggerSamplesRead);
+    }
+}
+
+/*!
+ * Returns \c true if \a quantity is at, or beyond, \a threshold, in the settings' direction.
+ */
+bool EventDetectorPrivate::isBeyond(const float quantity, const float threshold) const
+{
+    return (settings.direction == EventDetector::Direction::Above) ? (quantity >= threshold) : (quantity <= threshold);
+}
+
+/*!
+ * Ends the event in progress (if any), emitting EventDetector::eventFinished if it had been reported as started.
+ */
+void EventDetectorPrivate::finish()
+{
+    const bool wasStarted = (active) && (started);
+    active = false;
+    started = false;
+    if (wasStarted) {
+        Q_Q(EventDetector);
+        Q_EMIT q->eventFinished(event);
+    }
+}
+
+/*!
+ * Clears all detector state.
+ */
+void EventDetectorPrivate::clear()
+{
+    previousValue = qQNaN();
+    previousTimestamp = -1;
+    active = false;
+    started = false;
+    event = { 0, 0, 0.0f, 0 };
+    events = 0;
+}
+
+/*!
+ * Adds the value of multimeter \a reading, timestamped now, unless the \a reading is erroneous.
+ */
+void EventDetectorPrivate::readingRead(const MultimeterService::Reading &reading)
+{
+    if (reading.status == MultimeterService::MeterStatus::Error) {
+        return;
+    }
+    Q_Q(EventDetector);
+    q->addValue(reading.value, QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+ * Prepares to timestamp, and scale, the samples of the logging session described by data logger \a metadata.
+ */
+void EventDetectorPrivate::loggerMetadataRead(const DataLoggerService::Metadata &metadata)
+{
+    loggerScale = metadata.scale;
+    loggerInterval = metadata.updateInterval;
+    loggerTimestamp = (qint64)metadata.timestamp * 1000;
+}
+
+/*!
+ * Scales, timestamps, and adds data logger \a samples.
+ */
+void EventDetectorPrivate::loggerSamplesRead(const DataLoggerService::Samples &samples)
+{
+    Q_Q(EventDetector);
+    for (const qint16 sample: samples) {
+        q->addValue(sample * loggerScale, loggerTimestamp);
+        loggerTimestamp += loggerInterval;
+    }
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the EventDetectorPrivate class.
+ */
+
+#ifndef QTPOKIT_EVENTDETECTOR_P_H
+#define QTPOKIT_EVENTDETECTOR_P_H
+
+#include <qtpokit/eventdetector.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT EventDetectorPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.event.detector", QtInfoMsg); ///< Logging category.
+
+    AbstractPokitService * service { nullptr }; ///< Multimeter, or data logger, service to detect events in, if any.
+    EventDetector::Settings settings { EventDetector::defaultSettings() }; ///< Current detector settings.
+
+    float previousValue { qQNaN() };  ///< Most recent value, for rates of change, or NaN if none.
+    qint64 previousTimestamp { -1 };  ///< Timestamp of #previousValue, in milliseconds since the epoch.
+    bool active { false };            ///< Whether an event is in progress.
+    bool started { false };           ///< Whether the event in progress has lasted long enough to be reported.
+    EventDetector::Event event { 0, 0, 0.0f, 0 }; ///< Event in progress, if #active.
+    quint64 events { 0 };             ///< Number of events reported (ie started).
+
+    float loggerScale { 1.0f };       ///< Scale of the current logging session's raw samples.
+    quint32 loggerInterval { 0 };     ///< Update interval of the current logging session, in milliseconds.
+    qint64 loggerTimestamp { 0 };     ///< Timestamp of the next logger sample, in milliseconds since the epoch.
+
+    explicit EventDetectorPrivate(EventDetector * const q);
+
+    void setService(AbstractPokitService * const newService);
+
+    bool isBeyond(const float quantity, const float threshold) const;
+    void finish();
+    void clear();
+
+public Q_SLOTS:
+    void readingRead(const MultimeterService::Reading &reading);
+    void loggerMetadataRead(const DataLoggerService::Metadata &metadata);
+    void loggerSamplesRead(const DataLoggerService::Samples &samples);
+
+protected:
+    EventDetector * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(EventDetector)
+    Q_DISABLE_COPY(EventDetectorPrivate)
+    QTPOKIT_BEFRIEND_TEST(EventDetector)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_EVENTDETECTOR_P_H
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the LatencyHistogram class.
+ */
+
+#include <qtpokit/latencyhistogram.h>
+
+#include <QtAlgorithms>
+
+#include <cmath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class LatencyHistogram
+ *
+ * The LatencyHistogram class records a distribution of latencies (in nanoseconds), in the style of an HDR histogram.
+ * That is, values less than `2 * subBucketCount` are recorded exactly, and larger values are recorded in log-linear
+ * buckets: `subBucketCount` equal-width buckets per power of two. So every value is recorded to within about 3%,
+ * from nanoseconds to minutes, in a fixed number of buckets, and recording is just a bucket lookup and increment, no
+ * matter how many values are recorded.
+ *
+ * Percentiles are reported as the highest value equivalent to the bucket the percentile falls in (but never more
+ * than the maximum value recorded), so are never understated. Histograms may be merged, such as to combine the
+ * latencies of several services, or devices.
+ *
+ * The bucket counts are only allocated once the first value is recorded, so histograms that are never recorded to
+ * are cheap to construct, and copy. LatencyHistogram is not thread-safe; see AbstractPokitService::statistics() for
+ * thread-safe access to services' histograms.
+ */
+
+/*!
+ * Records the latency of \a nanoseconds. Negative latencies (such as from a clock that is not steady) are recorded
+ * as zero, and latencies of 2^maxValueBits nanoseconds, or more, in the last bucket.
+ */
+void LatencyHistogram::record(const qint64 nanoseconds)
+{
+    const qint64 value = qMax<qint64>(nanoseconds, 0);
+    if (counts.isEmpty()) {
+        counts.fill(0, bucketCount);
+        min = max = value;
+    } else {
+        min = qMin(min, value);
+        max = qMax(max, value);
+    }
+    ++counts[bucketIndex(value)];
+    ++total;
+    sum += (double)value;
+}
+
+/*!
+ * Adds all of the values recorded by \a other to this histogram.
+ */
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    if (other.isEmpty()) {
+        return;
+    }
+    if (isEmpty()) {
+        *this = other;
+        return;
+    }
+    for (int index = 0; index < bucketCount; ++index) {
+        counts[index] += other.counts.at(index);
+    }
+    total += other.total;
+    min = qMin(min, other.min);
+    max = qMax(max, other.max);
+    sum += other.sum;
+}
+
+/*!
+ * Discards all recorded values, but retains the bucket counts' allocation (if any), for re-use.
+ */
+void LatencyHistogram::reset()
+{
+    if (!counts.isEmpty()) {
+        counts.fill(0);
+    }
+    total = 0;
+    min = max = 0;
+    sum = 0.0;
+}
+
+/*!
+ * Returns \c true if no values have been recorded (since the last reset()), otherwise \c false.
+ */
+bool LatencyHistogram::isEmpty() const
+{
+    return total == 0;
+}
+
+/*!
+ * Returns the number of values recorded.
+ */
+quint64 LatencyHistogram::count() const
+{
+    return total;
+}
+
+/*!
+ * Returns the smallest value recorded (exactly, not to the bucket's precision), or 0 if none have been recorded.
+ */
+qint64 LatencyHistogram::minimum() const
+{
+    return min;
+}
+
+/*!
+ * Returns the largest value recorded (exactly, not to the bucket's precision), or 0 if none have been recorded.
+ */
+qint64 LatencyHistogram::maximum() const
+{
+    return max;
+}
+
+/*!
+ * Returns the mean of the values recorded (exactly, not to the buckets' precision), or NaN if none have been recorded.
+ */
+double LatencyHistogram::mean() const
+{
+    return (total == 0) ? std::nan("") : sum / (double)total;
+}
+
+/*!
+ * Returns the value, in nanoseconds, that \a percent percent of recorded values are less than, or equal to, such as
+ * `percentile(99.0)` for the 99th percentile. Returns 0 if no values have been recorded.
+ *
+ * The 0th and 100th percentiles are the minimum() and maximum() values. Otherwise, the result is the highest value
+ * equivalent to the percentile's bucket (see bucketValue()), but no more than maximum().
+ */
+qint64 LatencyHistogram::percentile(const double percent) const
+{
+    if (total == 0) {
+        return 0;
+    }
+    if (percent <= 0.0) {
+        return min;
+    }
+    const quint64 rank = qBound<quint64>(1, (quint64)std::ceil(percent / 100.0 * (double)total), total);
+    quint64 cumulative = 0;
+    for (int index = bucketIndex(min); index < bucketCount; ++index) {
+        if ((cumulative += counts.at(index)) >= rank) {
+            return qMin(bucketValue(index), max);
+        }
+    }
+    return max; // Should never be reached.
+}
+
+/*!
+ * Returns the index of the bucket that \a nanoseconds is recorded in.
+ */
+int LatencyHistogram::bucketIndex(const qint64 nanoseconds)
+{
+    if (nanoseconds < 2 * subBucketCount) {
+        return (nanoseconds < 0) ? 0 : (int)nanoseconds; // Recorded exactly.
+    }
+    const int topBit = 63 - (int)qCountLeadingZeroBits((quint64)nanoseconds);
+    if (topBit >= maxValueBits) {
+        return bucketCount - 1;
+    }
+    const int shift = topBit - subBucketBits; // At least 1, since nanoseconds >= 2 * subBucketCount.
+    return (subBucketCount * (shift + 1)) + (int)(nanoseconds >> shift) - subBucketCount;
+}
+
+/*!
+ * Returns the highest value, in nanoseconds, that is recorded in the bucket at \a index.
+ */
+qint64 LatencyHistogram::bucketValue(const int index)
+{
+    if (index < 2 * subBucketCount) {
+        return index;
+    }
+    const int shift = (index / subBucketCount) - 1;
+    const qint64 top = (index % subBucketCount) + subBucketCount;
+    return (top << shift) + ((qint64)1 << shift) - 1;
+}
+
+QTPOKIT_END_NAMESPACE
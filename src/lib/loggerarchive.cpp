@@ -0,0 +1,886 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the LoggerArchive and LoggerArchivePrivate classes.
+ */
+
+#include <qtpokit/loggerarchive.h>
+#include <qtpokit/samplecodec.h>
+#include "loggerarchive_p.h"
+
+#include <QDataStream>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class LoggerArchive
+ *
+ * The LoggerArchive class reads, and appends to, a columnar archive of Data Logger sessions.
+ *
+ * Archives are designed to be memory-mapped: open() maps the whole file, and samples() then copies only the requested
+ * samples out of the mapping, so a time range can be extracted from a large archive without reading the rest of it.
+ *
+ * All values are little-endian. An archive consists of:
+ *
+ * 1. an 8-byte file header: the magic bytes `DOKA`, followed by a `uint32` format version (currently `1`);
+ * 2. one block per archived session run, each consisting of a 32-byte header (`uint8` mode, `uint8` range, `uint8`
+ *    status, `uint8` encoding, `float32` scale, `uint32` update interval in milliseconds, `uint32` session timestamp
+ *    in seconds, `uint32` index of the first sample within the session, `uint32` number of samples, `uint32` encoded
+ *    size in bytes, and 4 reserved bytes), followed by the samples, padded with zeros to a multiple of 8 bytes. The
+ *    samples are either raw `int16` values (encoding `0`, with an encoded size of `0`), or SampleCodec compressed
+ *    (encoding `1`, see setCompressSamples());
+ * 3. a sparse time index, with one 24-byte entry per block (`uint64` first and last sample timestamps in milliseconds,
+ *    followed by the `uint64` file offset of the block), sorted by first sample timestamp; and
+ * 4. a 16-byte footer: the `uint64` file offset of the time index, the `uint32` number of index entries, and the magic
+ *    bytes `DOKI`.
+ *
+ * Since the index is at the end of the file, append() overwrites the existing index with the new block, and then
+ * re-writes the (extended) index and footer after it. This means an interrupted append can leave an archive unreadable,
+ * so callers archiving data they cannot re-fetch should keep a backup.
+ */
+
+/*!
+ * Constructs a new LoggerArchive object for \a fileName, with \a parent.
+ *
+ * The archive is not opened; use open() before reading, if required. Note, append() does not require the archive to be
+ * open.
+ */
+LoggerArchive::LoggerArchive(const QString &fileName, QObject * parent)
+    : QObject(parent), d_ptr(new LoggerArchivePrivate(this))
+{
+    Q_D(LoggerArchive);
+    d->file.setFileName(fileName);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new LoggerArchive object for \a fileName, with \a parent, and private implementation \a d.
+ */
+LoggerArchive::LoggerArchive(LoggerArchivePrivate * const d, const QString &fileName, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->file.setFileName(fileName);
+}
+/// \endcond
+
+/*!
+ * Destroys this LoggerArchive object, closing the archive first if necessary.
+ */
+LoggerArchive::~LoggerArchive()
+{
+    close();
+    delete d_ptr;
+}
+
+/*!
+ * Returns the name of the archive file.
+ */
+QString LoggerArchive::fileName() const
+{
+    Q_D(const LoggerArchive);
+    return d->file.fileName();
+}
+
+/*!
+ * Returns `true` if append() compresses samples (via SampleCodec), otherwise `false` (the default).
+ *
+ * \see setCompressSamples
+ */
+bool LoggerArchive::compressSamples() const
+{
+    Q_D(const LoggerArchive);
+    return d->compressSamples;
+}
+
+/*!
+ * Sets whether append() should \a compress samples (via SampleCodec).
+ *
+ * Slowly varying samples typically compress to around one byte each, instead of two. However, compressed samples can
+ * no longer be read directly from the memory-mapped archive, so samples() has to decode each compressed run from its
+ * first sample, up to the end of the requested range.
+ *
+ * Archives may freely mix compressed and uncompressed runs, so this only affects subsequently appended runs.
+ */
+void LoggerArchive::setCompressSamples(const bool compress)
+{
+    Q_D(LoggerArchive);
+    d->compressSamples = compress;
+}
+
+/*!
+ * Memory-maps the archive file, and parses its time index.
+ *
+ * Returns `true` on success, otherwise `false` if the file could not be opened or mapped, or is not a valid archive.
+ */
+bool LoggerArchive::open()
+{
+    Q_D(LoggerArchive);
+    close();
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        qCWarning(d->lc).noquote() << tr("Failed to open archive %1: %2")
+            .arg(d->file.fileName(), d->file.errorString());
+        return false;
+    }
+    const qint64 size = d->file.size();
+    const uchar * const data = (size > 0) ? d->file.map(0, size) : nullptr;
+    if ((data == nullptr) || (!d->parse(data, size))) {
+        qCWarning(d->lc).noquote() << tr("Failed to read archive %1").arg(d->file.fileName());
+        d->file.close(); // Also unmaps, if mapped.
+        d->sessions.clear();
+        d->offsets.clear();
+        d->encodedSizes.clear();
+        d->lastTimestamps.clear();
+        return false;
+    }
+    d->data = data;
+    d->size = size;
+    qCDebug(d->lc).noquote() << tr("Opened archive %1 with %Ln session/s.", nullptr, d->sessions.size())
+        .arg(d->file.fileName());
+    return true;
+}
+
+/*!
+ * Returns `true` if the archive is currently open (ie memory-mapped), otherwise `false`.
+ */
+bool LoggerArchive::isOpen() const
+{
+    Q_D(const LoggerArchive);
+    return (d->data != nullptr);
+}
+
+/*!
+ * Unmaps, and closes, the archive file. Does nothing if the archive is not open.
+ */
+void LoggerArchive::close()
+{
+    Q_D(LoggerArchive);
+    if (d->data != nullptr) {
+        d->file.unmap(const_cast<uchar *>(d->data));
+        d->data = nullptr;
+        d->size = 0;
+    }
+    d->file.close();
+    d->sessions.clear();
+    d->offsets.clear();
+    d->encodedSizes.clear();
+    d->lastTimestamps.clear();
+}
+
+/*!
+ * Returns the number of session runs in the archive, or `0` if the archive is not open.
+ */
+qsizetype LoggerArchive::sessionCount() const
+{
+    Q_D(const LoggerArchive);
+    return d->sessions.size();
+}
+
+/*!
+ * Returns the session run at \a index, in time index order.
+ *
+ * \a index must be valid (ie `0 <= index < sessionCount()`).
+ */
+LoggerArchive::Session LoggerArchive::session(const qsizetype index) const
+{
+    Q_D(const LoggerArchive);
+    Q_ASSERT((index >= 0) && (index < d->sessions.size()));
+    return d->sessions.at(index);
+}
+
+/*!
+ * Returns the index of the session run containing \a timestamp (in milliseconds since the epoch), or `-1` if no run
+ * contains \a timestamp.
+ *
+ * If more than one run contains \a timestamp (for example, when runs from multiple devices have been archived to the
+ * same file), the run that started most recently is returned.
+ *
+ * This is a binary search of the in-memory time index, followed by a backwards scan of the runs that started before
+ * \a timestamp, which stops as soon as the running maximum of the runs' last timestamps (see findSessions()) shows that
+ * no earlier run could contain \a timestamp. So it does not touch any sample data.
+ */
+qsizetype LoggerArchive::findSession(const quint64 timestamp) const
+{
+    Q_D(const LoggerArchive);
+    const auto iter = std::upper_bound(d->sessions.cbegin(), d->sessions.cend(), timestamp,
+        [](const quint64 value, const Session &session) { return value < session.firstTimestamp; });
+    if (iter == d->sessions.cbegin()) {
+        return -1;
+    }
+    for (qsizetype index = (iter - d->sessions.cbegin()) - 1;
+         (index >= 0) && (d->lastTimestamps.at(index) >= timestamp); --index) {
+        if (d->sessions.at(index).lastTimestamp >= timestamp) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+/*!
+ * Returns the indexes of all session runs with samples logged between \a from and \a to (inclusive, and in
+ * milliseconds since the epoch), in time index order.
+ *
+ * Runs may overlap (for example, when runs from multiple devices have been archived to the same file), so the index
+ * also records the running maximum of the runs' last timestamps. That is sorted, so the first run that could overlap
+ * the range is found by binary search, and only runs from there, up to the first that starts after \a to, are
+ * examined. Like findSession(), this does not touch any sample data.
+ */
+QVector<qsizetype> LoggerArchive::findSessions(const quint64 from, const quint64 to) const
+{
+    Q_D(const LoggerArchive);
+    QVector<qsizetype> indexes;
+    if (from > to) {
+        return indexes;
+    }
+    const auto begin = std::lower_bound(d->lastTimestamps.cbegin(), d->lastTimestamps.cend(), from);
+    for (qsizetype index = begin - d->lastTimestamps.cbegin();
+         (index < d->sessions.size()) && (d->sessions.at(index).firstTimestamp <= to); ++index) {
+        if (d->sessions.at(index).lastTimestamp >= from) {
+            indexes.append(index);
+        }
+    }
+    return indexes;
+}
+
+/*!
+ * Returns all of the samples of the session run at \a index.
+ *
+ * \a index must be valid (ie `0 <= index < sessionCount()`).
+ */
+DataLoggerService::Samples LoggerArchive::samples(const qsizetype index) const
+{
+    const Session run = session(index);
+    return samples(index, run.firstTimestamp, run.lastTimestamp);
+}
+
+/*!
+ * Returns the samples of the session run at \a index, that were logged between \a from and \a to (inclusive, and in
+ * milliseconds since the epoch).
+ *
+ * Only the requested samples are read from the memory-mapped archive. Or for compressed runs, only the samples up to
+ * the end of the requested range.
+ *
+ * \a index must be valid (ie `0 <= index < sessionCount()`).
+ */
+DataLoggerService::Samples LoggerArchive::samples(const qsizetype index, const quint64 from, const quint64 to) const
+{
+    Q_D(const LoggerArchive);
+    quint64 first, last;
+    if (!d->sampleRange(session(index), from, to, first, last)) {
+        return { };
+    }
+
+    if (const qint64 encodedSize = d->encodedSizes.at(index); encodedSize >= 0) {
+        DataLoggerService::Samples samples((int)(last + 1)); // Deltas can only be decoded from the first sample.
+        if (SampleCodec::decode(reinterpret_cast<const char *>(d->data + d->offsets.at(index)), encodedSize,
+                                samples.data(), samples.size()) < 0) {
+            qCWarning(d->lc).noquote() << tr("Invalid compressed archive samples at offset %1")
+                .arg(d->offsets.at(index));
+            return { };
+        }
+        return samples.mid((int)first);
+    }
+
+    DataLoggerService::Samples samples((int)(last - first + 1));
+    const uchar * column = d->data + d->offsets.at(index) + first * sizeof(qint16);
+    for (qint16 &sample: samples) {
+        sample = qFromLittleEndian<qint16>(column);
+        column += sizeof(qint16);
+    }
+    return samples;
+}
+
+/*!
+ * Returns the aggregate (count, minimum, maximum and sum) of the samples of the session run at \a index, that were
+ * logged between \a from and \a to (inclusive, and in milliseconds since the epoch).
+ *
+ * Raw samples are aggregated directly from the memory-mapped archive, without copying them. If no samples were logged
+ * during the range, the returned aggregate's count is `0`.
+ *
+ * \a index must be valid (ie `0 <= index < sessionCount()`).
+ *
+ * \see findSessions
+ */
+LoggerArchive::Aggregate LoggerArchive::aggregate(const qsizetype index, const quint64 from, const quint64 to) const
+{
+    Q_D(const LoggerArchive);
+    const Session run = session(index);
+    quint64 first, last;
+    if (!d->sampleRange(run, from, to, first, last)) {
+        return { };
+    }
+    qint16 minimum = std::numeric_limits<qint16>::max(), maximum = std::numeric_limits<qint16>::min();
+    qint64 sum = 0;
+    if (!d->forEachSample(index, first, last, [&](const quint64, const qint16 sample) {
+        minimum = std::min(minimum, sample);
+        maximum = std::max(maximum, sample);
+        sum += sample;
+    })) {
+        return { };
+    }
+    return d->toAggregate(run, first, last, minimum, maximum, sum);
+}
+
+/*!
+ * Returns the aggregates of the samples of the session run at \a index, that were logged between \a from and \a to
+ * (inclusive, and in milliseconds since the epoch), in consecutive buckets of \a width milliseconds.
+ *
+ * Buckets are aligned to the epoch (so hourly buckets begin on the hour), and only buckets containing at least one
+ * sample are returned, in time order. Buckets at either end of the range may be partial; use merge() to combine them
+ * with neighbouring runs' buckets with the same start.
+ *
+ * \a index must be valid (ie `0 <= index < sessionCount()`), and \a width must be greater than `0`.
+ *
+ * \see findSessions
+ */
+QVector<LoggerArchive::Bucket> LoggerArchive::downsample(const qsizetype index, const quint64 from, const quint64 to,
+                                                         const quint64 width) const
+{
+    Q_D(const LoggerArchive);
+    Q_ASSERT(width > 0);
+    const Session run = session(index);
+    quint64 first, last;
+    if ((width == 0) || (!d->sampleRange(run, from, to, first, last))) {
+        return { };
+    }
+
+    QVector<Bucket> buckets;
+    quint64 bucketEnd = 0, bucketFirst = 0, bucketLast = 0;
+    qint16 minimum = 0, maximum = 0;
+    qint64 sum = 0;
+    const auto flush = [&]() {
+        buckets.append({ bucketEnd - width,
+                         d->toAggregate(run, bucketFirst, bucketLast, minimum, maximum, sum) });
+    };
+    const quint64 interval = run.metadata.updateInterval;
+    if (!d->forEachSample(index, first, last, [&](const quint64 sample, const qint16 value) {
+        const quint64 timestamp = run.firstTimestamp + sample * interval;
+        if ((sample == first) || (timestamp >= bucketEnd)) {
+            if (sample != first) {
+                flush();
+            }
+            bucketEnd = timestamp - (timestamp % width) + width;
+            bucketFirst = sample;
+            minimum = maximum = value;
+            sum = 0;
+        }
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        sum += value;
+        bucketLast = sample;
+    })) {
+        return { };
+    }
+    flush();
+    return buckets;
+}
+
+/*!
+ * Merges \a other into \a aggregate, such as to combine the aggregates of multiple session runs, or archives.
+ *
+ * Either aggregate may be empty (ie have a count of `0`), in which case it is ignored.
+ */
+void LoggerArchive::merge(Aggregate &aggregate, const Aggregate &other)
+{
+    if (other.count == 0) {
+        return;
+    }
+    if (aggregate.count == 0) {
+        aggregate = other;
+        return;
+    }
+    aggregate.count += other.count;
+    aggregate.minimum = std::min(aggregate.minimum, other.minimum);
+    aggregate.maximum = std::max(aggregate.maximum, other.maximum);
+    aggregate.sum += other.sum;
+    aggregate.firstTimestamp = std::min(aggregate.firstTimestamp, other.firstTimestamp);
+    aggregate.lastTimestamp = std::max(aggregate.lastTimestamp, other.lastTimestamp);
+}
+
+/*!
+ * Appends \a samples, from a logging session described by \a metadata, to the archive. \a firstSample is the index of
+ * the first of \a samples within the logging session (eg when only new samples have been fetched).
+ *
+ * The archive file is created if it does not already exist. If the archive is open, it is re-opened after appending,
+ * so the new session run is immediately available to readers.
+ *
+ * Returns `true` on success, otherwise `false`.
+ */
+bool LoggerArchive::append(const DataLoggerService::Metadata &metadata, const DataLoggerService::Samples &samples,
+                           const quint32 firstSample)
+{
+    Q_D(LoggerArchive);
+    if (samples.isEmpty()) {
+        qCDebug(d->lc).noquote() << tr("No samples to append to archive.");
+        return true;
+    }
+    if (samples.size() > std::numeric_limits<quint16>::max()) {
+        qCWarning(d->lc).noquote() << tr("Too many samples to archive as a single session: %1").arg(samples.size());
+        return false;
+    }
+
+    const bool wasOpen = isOpen();
+    close();
+
+    // Locate (and keep) the existing time index, or write the file header if this is a new archive.
+    QFile file(d->file.fileName());
+    if (!file.open(QIODevice::ReadWrite)) {
+        qCWarning(d->lc).noquote() << tr("Failed to open archive %1: %2").arg(file.fileName(), file.errorString());
+        return false;
+    }
+    QByteArray index;
+    qint64 blockOffset = LoggerArchivePrivate::fileHeaderSize;
+    if (file.size() == 0) {
+        file.write(LoggerArchivePrivate::encodeFileHeader());
+    } else {
+        const uchar * const data = file.map(0, file.size());
+        if ((data == nullptr) || (!d->parse(data, file.size()))) {
+            qCWarning(d->lc).noquote() << tr("Failed to read archive %1").arg(file.fileName());
+            d->sessions.clear();
+            d->offsets.clear();
+            d->encodedSizes.clear();
+            d->lastTimestamps.clear();
+            return false;
+        }
+        blockOffset = qFromLittleEndian<quint64>(data + file.size() - LoggerArchivePrivate::footerSize);
+        index = QByteArray(reinterpret_cast<const char *>(data) + blockOffset,
+                           d->sessions.size() * LoggerArchivePrivate::indexEntrySize);
+        file.unmap(const_cast<uchar *>(data));
+    }
+
+    // Write the new block over the old index, and insert its entry into the (time-ordered) index.
+    const QByteArray block = LoggerArchivePrivate::encodeBlock(metadata, samples, firstSample, d->compressSamples);
+    const Session run {
+        { metadata.status, metadata.scale, metadata.mode, metadata.range, metadata.updateInterval,
+          (quint16)samples.size(), metadata.timestamp },
+        firstSample,
+        LoggerArchivePrivate::toTimestamp(metadata, firstSample),
+        LoggerArchivePrivate::toTimestamp(metadata, firstSample + samples.size() - 1),
+    };
+    const auto position = std::upper_bound(d->sessions.cbegin(), d->sessions.cend(), run.firstTimestamp,
+        [](const quint64 value, const Session &session) { return value < session.firstTimestamp; });
+    index.insert((position - d->sessions.cbegin()) * LoggerArchivePrivate::indexEntrySize,
+                 LoggerArchivePrivate::encodeIndexEntry(run, blockOffset));
+    const quint32 entryCount = d->sessions.size() + 1;
+    d->sessions.clear();
+    d->offsets.clear();
+    d->encodedSizes.clear();
+    d->lastTimestamps.clear();
+
+    const qint64 indexOffset = blockOffset + block.size();
+    if ((!file.seek(blockOffset)) || (file.write(block) != block.size()) || (file.write(index) != index.size()) ||
+        (file.write(LoggerArchivePrivate::encodeFooter(indexOffset, entryCount)) != LoggerArchivePrivate::footerSize) ||
+        (!file.resize(file.pos()))) {
+        qCWarning(d->lc).noquote() << tr("Failed to write archive %1: %2").arg(file.fileName(), file.errorString());
+        return false;
+    }
+    file.close();
+    qCDebug(d->lc).noquote() << tr("Appended %Ln sample/s to archive %1.", nullptr, samples.size())
+        .arg(file.fileName());
+    return (wasOpen) ? open() : true;
+}
+
+/*!
+ * Writes the session runs of all of the \a sources archives to a single, compacted, \a destination archive, which is
+ * replaced if it already exists (and may be one of the \a sources). Samples are compressed if \a compress is `true`.
+ *
+ * Incremental fetches append a short run per fetch, so a long logging session is typically archived as many small
+ * runs, each with its own block header and index entry. Compaction coalesces consecutive runs of the same logging
+ * session (which need not be from the same source) into as few blocks as possible, and drops any samples archived more
+ * than once. Runs from multiple sessions (or devices) may be interleaved. The destination is written in a single pass,
+ * in time order, and only replaces any existing file once complete.
+ *
+ * Returns `true` on success, otherwise `false`.
+ */
+bool LoggerArchive::compact(const QStringList &sources, const QString &destination, const bool compress)
+{
+    // Open all of the sources, and order all of their runs by time.
+    struct Run {
+        const LoggerArchive * archive; ///< Run's source archive.
+        qsizetype index;               ///< Run's index within its source archive.
+        Session session;               ///< Run's metadata.
+    };
+    std::vector<std::unique_ptr<LoggerArchive>> archives;
+    QVector<Run> runs;
+    for (const QString &source: sources) {
+        archives.push_back(std::make_unique<LoggerArchive>(source));
+        if (!archives.back()->open()) {
+            return false;
+        }
+        for (qsizetype index = 0; index < archives.back()->sessionCount(); ++index) {
+            runs.append({ archives.back().get(), index, archives.back()->session(index) });
+        }
+    }
+    std::stable_sort(runs.begin(), runs.end(), [](const Run &a, const Run &b) {
+        return a.session.firstTimestamp < b.session.firstTimestamp;
+    });
+
+    QSaveFile file(destination);
+    if ((!file.open(QIODevice::WriteOnly)) ||
+        (file.write(LoggerArchivePrivate::encodeFileHeader()) != LoggerArchivePrivate::fileHeaderSize)) {
+        qCWarning(LoggerArchivePrivate::lc).noquote() << tr("Failed to write archive %1: %2")
+            .arg(destination, file.errorString());
+        return false;
+    }
+
+    // Coalesce each session's runs in a pending block, until the next run is not contiguous, or the block is full.
+    struct Pending {
+        Session session;                    ///< Pending block's metadata.
+        DataLoggerService::Samples samples; ///< Pending block's samples.
+    };
+    QVector<Pending> pending;
+    QVector<QPair<Session, quint64>> entries; // Time index entries, and their block offsets, in block order.
+    bool ok = true;
+    const auto flush = [&](const Pending &block) {
+        Session session = block.session;
+        session.metadata.numberOfSamples = (quint16)block.samples.size();
+        session.firstTimestamp = LoggerArchivePrivate::toTimestamp(session.metadata, session.firstSample);
+        session.lastTimestamp = LoggerArchivePrivate::toTimestamp(session.metadata,
+            session.firstSample + block.samples.size() - 1);
+        const QByteArray bytes = LoggerArchivePrivate::encodeBlock(session.metadata, block.samples,
+                                                                  session.firstSample, compress);
+        entries.append({ session, (quint64)file.pos() });
+        ok = ok && (file.write(bytes) == bytes.size());
+    };
+    const auto sameSession = [](const DataLoggerService::Metadata &a, const DataLoggerService::Metadata &b) {
+        return (a.timestamp == b.timestamp) && (a.mode == b.mode) && (a.range == b.range) &&
+               (a.updateInterval == b.updateInterval) && (a.scale == b.scale);
+    };
+    constexpr int maxSamples = std::numeric_limits<quint16>::max();
+    for (const Run &run: std::as_const(runs)) {
+        DataLoggerService::Samples samples = run.archive->samples(run.index);
+        auto block = std::find_if(pending.begin(), pending.end(), [&](const Pending &block) {
+            return sameSession(block.session.metadata, run.session.metadata);
+        });
+        if (block == pending.end()) {
+            pending.append({ run.session, { } });
+            block = pending.end() - 1;
+            block->samples.reserve(maxSamples);
+        } else if (const quint64 end = (quint64)block->session.firstSample + block->samples.size();
+                   run.session.firstSample > end) {
+            flush(*block); // The session's samples are not contiguous, so start a new block.
+            block->session = run.session;
+            block->samples.clear();
+        } else {
+            samples.remove(0, std::min<int>((int)(end - run.session.firstSample), samples.size())); // Duplicates.
+        }
+        block->session.metadata.status = run.session.metadata.status; // Later runs have the more recent status.
+        for (qsizetype first = 0; first < samples.size();) {
+            if (block->samples.size() == maxSamples) {
+                flush(*block); // The block is full, so continue the session in a new block.
+                block->session.firstSample += maxSamples;
+                block->samples.clear();
+            }
+            const int count = std::min<int>(maxSamples - block->samples.size(), samples.size() - first);
+            block->samples.append(samples.mid(first, count));
+            first += count;
+        }
+    }
+    for (const Pending &block: std::as_const(pending)) {
+        if (!block.samples.isEmpty()) {
+            flush(block);
+        }
+    }
+    archives.clear(); // Unmap the sources, in case the destination is one of them.
+
+    // Write the time index, sorted by time, and the footer.
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+        return a.first.firstTimestamp < b.first.firstTimestamp;
+    });
+    const qint64 indexOffset = file.pos();
+    for (const auto &[session, offset]: std::as_const(entries)) {
+        ok = ok && (file.write(LoggerArchivePrivate::encodeIndexEntry(session, offset)) ==
+                    LoggerArchivePrivate::indexEntrySize);
+    }
+    ok = ok && (file.write(LoggerArchivePrivate::encodeFooter(indexOffset, entries.size())) ==
+                LoggerArchivePrivate::footerSize);
+    if ((!ok) || (!file.commit())) {
+        qCWarning(LoggerArchivePrivate::lc).noquote() << tr("Failed to write archive %1: %2")
+            .arg(destination, file.errorString());
+        return false;
+    }
+    qCDebug(LoggerArchivePrivate::lc).noquote() << tr("Compacted %Ln session run/s into %1 block/s in %2.", nullptr,
+        runs.size()).arg(entries.size()).arg(destination);
+    return true;
+}
+
+/*!
+ * \cond internal
+ * \class LoggerArchivePrivate
+ *
+ * The LoggerArchivePrivate class provides private implementation for LoggerArchive.
+ */
+
+/*!
+ * \internal
+ * Constructs a new LoggerArchivePrivate object with public implementation \a q.
+ */
+LoggerArchivePrivate::LoggerArchivePrivate(LoggerArchive * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Encodes a session block (header and sample column) for \a samples from a session described by \a metadata, starting
+ * at sample index \a firstSample. If \a compress is `true`, the sample column is SampleCodec compressed.
+ */
+QByteArray LoggerArchivePrivate::encodeBlock(const DataLoggerService::Metadata &metadata,
+                                             const DataLoggerService::Samples &samples, const quint32 firstSample,
+                                             const bool compress)
+{
+    static_assert(sizeof(metadata.scale)          == 4, "Expected to be 4 bytes.");
+    static_assert(sizeof(metadata.range)          == 1, "Expected to be 1 byte.");
+    static_assert(sizeof(metadata.updateInterval) == 4, "Expected to be 4 bytes.");
+    static_assert(sizeof(metadata.timestamp)      == 4, "Expected to be 4 bytes.");
+
+    QByteArray block;
+    QDataStream stream(&block, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision); // 32-bit floats, not 64-bit.
+    const QByteArray encoded = (compress) ? SampleCodec::encode(samples) : QByteArray();
+    stream << (quint8)metadata.mode << metadata.range << (quint8)metadata.status
+           << ((compress) ? deltaVarintEncoding : rawEncoding) << metadata.scale << metadata.updateInterval
+           << metadata.timestamp << firstSample << (quint32)samples.size() << (quint32)encoded.size() << (quint32)0;
+    Q_ASSERT(block.size() == blockHeaderSize);
+    if (compress) {
+        stream.writeRawData(encoded.constData(), encoded.size());
+    } else for (const qint16 sample: samples) {
+        stream << sample;
+    }
+    while ((block.size() % 8) != 0) {
+        stream << (quint8)0;
+    }
+    return block;
+}
+
+/*!
+ * Encodes the archive file header.
+ */
+QByteArray LoggerArchivePrivate::encodeFileHeader()
+{
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(fileMagic, sizeof(fileMagic));
+    stream << version;
+    Q_ASSERT(header.size() == fileHeaderSize);
+    return header;
+}
+
+/*!
+ * Encodes a time index entry for \a session, whose block begins at file offset \a blockOffset.
+ */
+QByteArray LoggerArchivePrivate::encodeIndexEntry(const LoggerArchive::Session &session, const quint64 blockOffset)
+{
+    QByteArray entry;
+    QDataStream stream(&entry, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << session.firstTimestamp << session.lastTimestamp << blockOffset;
+    Q_ASSERT(entry.size() == indexEntrySize);
+    return entry;
+}
+
+/*!
+ * Encodes an archive footer, for a time index of \a entryCount entries, beginning at file offset \a indexOffset.
+ */
+QByteArray LoggerArchivePrivate::encodeFooter(const quint64 indexOffset, const quint32 entryCount)
+{
+    QByteArray footer;
+    QDataStream stream(&footer, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << indexOffset << entryCount;
+    stream.writeRawData(indexMagic, sizeof(indexMagic));
+    Q_ASSERT(footer.size() == footerSize);
+    return footer;
+}
+
+/*!
+ * Returns the timestamp, in milliseconds since the epoch, of the \a sample index within a session described by
+ * \a metadata.
+ */
+quint64 LoggerArchivePrivate::toTimestamp(const DataLoggerService::Metadata &metadata, const quint32 sample)
+{
+    return (quint64)metadata.timestamp * 1000 + (quint64)sample * metadata.updateInterval;
+}
+
+/*!
+ * Sets \a first and \a last to the indexes (within \a run) of the first and last samples that were logged between
+ * \a from and \a to (inclusive, and in milliseconds since the epoch).
+ *
+ * Samples are evenly spaced, so the range is calculated, rather than searched for. Returns `true` if the range
+ * includes at least one sample, otherwise `false`.
+ */
+bool LoggerArchivePrivate::sampleRange(const LoggerArchive::Session &run, const quint64 from, const quint64 to,
+                                       quint64 &first, quint64 &last)
+{
+    const quint64 count = run.metadata.numberOfSamples;
+    if ((count == 0) || (from > to) || (from > run.lastTimestamp) || (to < run.firstTimestamp)) {
+        return false;
+    }
+    const quint64 interval = run.metadata.updateInterval;
+    first = 0;
+    last = count - 1;
+    if (interval > 0) {
+        if (from > run.firstTimestamp) {
+            first = (from - run.firstTimestamp + interval - 1) / interval;
+        }
+        if (to < run.lastTimestamp) {
+            last = (to - run.firstTimestamp) / interval;
+        }
+    }
+    return (first <= last); // Else the range falls between two consecutive samples.
+}
+
+/*!
+ * Returns the aggregate of \a run's samples \a first to \a last (inclusive), given the raw \a minimum, \a maximum
+ * and \a sum of those samples.
+ *
+ * Aggregating raw samples, and scaling only the results, saves a multiplication per sample. Note, a negative scale
+ * swaps the minimum and maximum.
+ */
+LoggerArchive::Aggregate LoggerArchivePrivate::toAggregate(const LoggerArchive::Session &run, const quint64 first,
+                                                           const quint64 last, const qint16 minimum,
+                                                           const qint16 maximum, const qint64 sum)
+{
+    const float scale = run.metadata.scale;
+    const quint64 interval = run.metadata.updateInterval;
+    return {
+        last - first + 1,
+        ((scale < 0.0f) ? maximum : minimum) * scale,
+        ((scale < 0.0f) ? minimum : maximum) * scale,
+        (double)sum * scale,
+        run.firstTimestamp + first * interval,
+        run.firstTimestamp + last * interval,
+    };
+}
+
+/*!
+ * Calls \a visit with the index, and raw value, of each of the samples \a first to \a last (inclusive) of the session
+ * run at \a index, in order.
+ *
+ * Raw samples are read directly from the memory-mapped archive, without copying. Compressed samples are decoded from
+ * the run's first sample, up to \a last. Returns `true` on success, or `false` if the samples could not be decoded.
+ */
+template<typename Visitor>
+bool LoggerArchivePrivate::forEachSample(const qsizetype index, const quint64 first, const quint64 last,
+                                         Visitor visit) const
+{
+    if (const qint64 encodedSize = encodedSizes.at(index); encodedSize >= 0) {
+        DataLoggerService::Samples samples((int)(last + 1)); // Deltas can only be decoded from the first sample.
+        if (SampleCodec::decode(reinterpret_cast<const char *>(data + offsets.at(index)), encodedSize,
+                                samples.data(), samples.size()) < 0) {
+            qCWarning(lc).noquote() << tr("Invalid compressed archive samples at offset %1").arg(offsets.at(index));
+            return false;
+        }
+        for (quint64 sample = first; sample <= last; ++sample) {
+            visit(sample, samples.at((int)sample));
+        }
+        return true;
+    }
+
+    const uchar * column = data + offsets.at(index) + first * sizeof(qint16);
+    for (quint64 sample = first; sample <= last; ++sample, column += sizeof(qint16)) {
+        visit(sample, qFromLittleEndian<qint16>(column));
+    }
+    return true;
+}
+
+/*!
+ * Parses the archive \a bytes, of \a length bytes, populating #sessions and #offsets from the archive's time index.
+ *
+ * Returns `true` if \a bytes is a valid archive, otherwise `false`.
+ */
+bool LoggerArchivePrivate::parse(const uchar * const bytes, const qint64 length)
+{
+    sessions.clear();
+    offsets.clear();
+    encodedSizes.clear();
+    lastTimestamps.clear();
+    if (length < fileHeaderSize + footerSize) {
+        qCWarning(lc).noquote() << tr("Archive is too small: %Ln byte/s", nullptr, (int)length);
+        return false;
+    }
+    if ((std::memcmp(bytes, fileMagic, sizeof(fileMagic)) != 0) ||
+        (std::memcmp(bytes + length - sizeof(indexMagic), indexMagic, sizeof(indexMagic)) != 0)) {
+        qCWarning(lc).noquote() << tr("Not a logger archive.");
+        return false;
+    }
+    if (const quint32 fileVersion = qFromLittleEndian<quint32>(bytes + 4); fileVersion != version) {
+        qCWarning(lc).noquote() << tr("Unsupported archive version: %1").arg(fileVersion);
+        return false;
+    }
+
+    const uchar * const footer = bytes + length - footerSize;
+    const quint64 indexOffset = qFromLittleEndian<quint64>(footer);
+    const quint32 entryCount = qFromLittleEndian<quint32>(footer + 8);
+    if ((indexOffset < (quint64)fileHeaderSize) ||
+        (indexOffset + (quint64)entryCount * indexEntrySize + footerSize != (quint64)length)) {
+        qCWarning(lc).noquote() << tr("Invalid archive index: %Ln entry/s at offset %1", nullptr, (int)entryCount)
+            .arg(indexOffset);
+        return false;
+    }
+
+    sessions.reserve(entryCount);
+    offsets.reserve(entryCount);
+    encodedSizes.reserve(entryCount);
+    lastTimestamps.reserve(entryCount);
+    for (const uchar * entry = bytes + indexOffset; entry < footer; entry += indexEntrySize) {
+        const quint64 blockOffset = qFromLittleEndian<quint64>(entry + 16);
+        if ((blockOffset < (quint64)fileHeaderSize) || (blockOffset + blockHeaderSize > indexOffset)) {
+            qCWarning(lc).noquote() << tr("Invalid archive block offset: %1").arg(blockOffset);
+            return false;
+        }
+        const uchar * const header = bytes + blockOffset;
+        const quint8 encoding = header[3];
+        if ((encoding != rawEncoding) && (encoding != deltaVarintEncoding)) {
+            qCWarning(lc).noquote() << tr("Unsupported archive block encoding: %1 at offset %2").arg(encoding)
+                .arg(blockOffset);
+            return false;
+        }
+        const quint32 count = qFromLittleEndian<quint32>(header + 20);
+        const quint32 encodedSize = qFromLittleEndian<quint32>(header + 24);
+        const quint64 columnSize = (encoding == rawEncoding) ? ((quint64)count * sizeof(qint16)) : encodedSize;
+        if ((count > std::numeric_limits<quint16>::max()) ||
+            ((encoding == deltaVarintEncoding) && ((encodedSize < count) ||
+                                                   (encodedSize > SampleCodec::maxEncodedSize(count)))) ||
+            (blockOffset + blockHeaderSize + columnSize > indexOffset)) {
+            qCWarning(lc).noquote() << tr("Invalid archive block size: %Ln sample/s at offset %1", nullptr, (int)count)
+                .arg(blockOffset);
+            return false;
+        }
+        const LoggerArchive::Session session {
+            {
+                (DataLoggerService::LoggerStatus)header[2], qFromLittleEndian<float>(header + 4),
+                (DataLoggerService::Mode)header[0], header[1], qFromLittleEndian<quint32>(header + 8),
+                (quint16)count, qFromLittleEndian<quint32>(header + 12)
+            },
+            qFromLittleEndian<quint32>(header + 16),
+            qFromLittleEndian<quint64>(entry),
+            qFromLittleEndian<quint64>(entry + 8),
+        };
+        if ((!sessions.isEmpty()) && (session.firstTimestamp < sessions.last().firstTimestamp)) {
+            qCWarning(lc).noquote() << tr("Archive index is not in time order.");
+            return false;
+        }
+        sessions.append(session);
+        offsets.append(blockOffset + blockHeaderSize);
+        encodedSizes.append((encoding == rawEncoding) ? -1 : (qint64)encodedSize);
+        lastTimestamps.append((lastTimestamps.isEmpty()) ? session.lastTimestamp
+                                                         : std::max(lastTimestamps.last(), session.lastTimestamp));
+    }
+    return true;
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
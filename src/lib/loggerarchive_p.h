@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the LoggerArchivePrivate class.
+ */
+
+#ifndef QTPOKIT_LOGGERARCHIVE_P_H
+#define QTPOKIT_LOGGERARCHIVE_P_H
+
+#include <qtpokit/loggerarchive.h>
+
+#include <QFile>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT LoggerArchivePrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.logger.archive", QtInfoMsg); ///< Logging category.
+
+    static constexpr char fileMagic[4] { 'D', 'O', 'K', 'A' };  ///< Magic bytes at the start of an archive.
+    static constexpr char indexMagic[4] { 'D', 'O', 'K', 'I' }; ///< Magic bytes at the end of an archive.
+    static constexpr quint32 version { 1 };        ///< Archive format version written by this implementation.
+    static constexpr qint64 fileHeaderSize { 8 };  ///< Size of the archive's file header, in bytes.
+    static constexpr qint64 blockHeaderSize { 32 }; ///< Size of each session block's header, in bytes.
+    static constexpr qint64 indexEntrySize { 24 };  ///< Size of each time index entry, in bytes.
+    static constexpr qint64 footerSize { 16 };      ///< Size of the archive's footer, in bytes.
+    static constexpr quint8 rawEncoding { 0 };      ///< Block encoding of raw `int16` samples.
+    static constexpr quint8 deltaVarintEncoding { 1 }; ///< Block encoding of SampleCodec compressed samples.
+
+    QFile file;                 ///< Archive file, while mapped.
+    const uchar * data { nullptr }; ///< Memory-mapped archive contents, or `nullptr` if not open.
+    qint64 size { 0 };          ///< Size of the memory-mapped archive contents, in bytes.
+    QVector<LoggerArchive::Session> sessions; ///< Archived sessions, in time index (ie #firstTimestamp) order.
+    QVector<qint64> offsets;    ///< File offsets of each of the #sessions' sample columns.
+    QVector<qint64> encodedSizes; ///< Sizes of each of the #sessions' compressed sample columns, or -1 if raw.
+    QVector<quint64> lastTimestamps; ///< Running maximum of the #sessions' last timestamps, for seeking by time.
+    bool compressSamples { false }; ///< Whether to compress appended samples.
+
+    explicit LoggerArchivePrivate(LoggerArchive * const q);
+
+    static QByteArray encodeFileHeader();
+    static QByteArray encodeBlock(const DataLoggerService::Metadata &metadata,
+                                  const DataLoggerService::Samples &samples, const quint32 firstSample,
+                                  const bool compress = false);
+    static QByteArray encodeIndexEntry(const LoggerArchive::Session &session, const quint64 blockOffset);
+    static QByteArray encodeFooter(const quint64 indexOffset, const quint32 entryCount);
+    static quint64 toTimestamp(const DataLoggerService::Metadata &metadata, const quint32 sample);
+    static bool sampleRange(const LoggerArchive::Session &run, const quint64 from, const quint64 to,
+                            quint64 &first, quint64 &last);
+    static LoggerArchive::Aggregate toAggregate(const LoggerArchive::Session &run, const quint64 first,
+                                                const quint64 last, const qint16 minimum, const qint16 maximum,
+                                                const qint64 sum);
+
+    template<typename Visitor>
+    bool forEachSample(const qsizetype index, const quint64 first, const quint64 last, Visitor visit) const;
+
+    bool parse(const uchar * const bytes, const qint64 length);
+
+protected:
+    LoggerArchive * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(LoggerArchive)
+    Q_DISABLE_COPY(LoggerArchivePrivate)
+    QTPOKIT_BEFRIEND_TEST(LoggerArchive)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_LOGGERARCHIVE_P_H
@@ -0,0 +1,439 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the LoggerRollup and LoggerRollupPrivate classes.
+ */
+
+#include <qtpokit/loggerrollup.h>
+#include "loggerrollup_p.h"
+
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class LoggerRollup
+ *
+ * The LoggerRollup class builds, and reads, pre-aggregated tiers of a LoggerArchive's samples.
+ *
+ * Aggregating a long time range from an archive means visiting every sample in the range. A rollup stores the same
+ * aggregates (see LoggerArchive::downsample) for fixed-width, epoch-aligned, buckets at a few coarser resolutions (by
+ * default, seconds, minutes and hours), so a query at, or above, one of those resolutions only has to merge one bucket
+ * per tier width, instead of visiting every sample. Each tier is derived from the next finer tier that evenly divides
+ * it, so building all tiers visits each archived sample once.
+ *
+ * A rollup is only valid for the exact archive it was built from; open() refuses a rollup whose source archive has
+ * since changed (such as by LoggerArchive::append, or LoggerArchive::compact), so readers can always fall back to the
+ * archive itself. Tiers whose buckets would hold fewer than a few samples each, are omitted, since the archive's raw
+ * samples are then smaller, and no slower to aggregate.
+ *
+ * All values are little-endian. A rollup consists of:
+ *
+ * 1. a 32-byte file header: the magic bytes `DOKR`, a `uint32` format version (currently `1`), the `uint64` size, in
+ *    bytes, and `uint32` number of session runs, of the source archive, the `uint32` number of sections, and 8
+ *    reserved bytes;
+ * 2. a section table, with one 24-byte entry per tier per mode (`uint64` bucket width in milliseconds, `uint8` mode, 3
+ *    reserved bytes, `uint32` number of buckets, and the `uint64` file offset of the first bucket), in order of
+ *    increasing bucket width; and
+ * 3. each section's buckets, sorted by start time, each 48 bytes (`uint64` start in milliseconds since the epoch,
+ *    `uint64` sample count, `float32` minimum and maximum, `float64` sum, and the `uint64` timestamps of the first
+ *    and last samples).
+ */
+
+/*!
+ * Constructs a new LoggerRollup object for \a fileName, with \a parent.
+ *
+ * \see fileNameFor
+ */
+LoggerRollup::LoggerRollup(const QString &fileName, QObject * parent)
+    : QObject(parent), d_ptr(new LoggerRollupPrivate(this))
+{
+    Q_D(LoggerRollup);
+    d->file.setFileName(fileName);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new LoggerRollup object for \a fileName, with \a parent, and private implementation \a d.
+ */
+LoggerRollup::LoggerRollup(LoggerRollupPrivate * const d, const QString &fileName, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->file.setFileName(fileName);
+}
+/// \endcond
+
+/*!
+ * Destroys this LoggerRollup object, closing the rollup first if necessary.
+ */
+LoggerRollup::~LoggerRollup()
+{
+    close();
+    delete d_ptr;
+}
+
+/*!
+ * Returns the name of the rollup file.
+ */
+QString LoggerRollup::fileName() const
+{
+    Q_D(const LoggerRollup);
+    return d->file.fileName();
+}
+
+/*!
+ * Returns the conventional name of the rollup file for the archive named \a archiveFileName, ie alongside it, with an
+ * additional `.rollup` suffix.
+ */
+QString LoggerRollup::fileNameFor(const QString &archiveFileName)
+{
+    return archiveFileName + QStringLiteral(".rollup");
+}
+
+/*!
+ * Returns the default tier widths, in milliseconds: one second, one minute, and one hour.
+ */
+QVector<quint64> LoggerRollup::defaultTiers()
+{
+    return { 1000, 60*1000, 60*60*1000 };
+}
+
+/*!
+ * Builds the rollup from the samples of the (open) \a archive, with buckets of each of the \a tiers widths, in
+ * milliseconds, replacing any existing rollup file. The rollup is closed, if open, first.
+ *
+ * Returns `true` on success, otherwise `false`.
+ */
+bool LoggerRollup::build(const LoggerArchive &archive, const QVector<quint64> &tiers)
+{
+    Q_D(LoggerRollup);
+    close();
+    if (!archive.isOpen()) {
+        qCWarning(d->lc).noquote() << tr("Archive %1 is not open.").arg(archive.fileName());
+        return false;
+    }
+
+    // Build each tier from the next finer tier that evenly divides it, if any, otherwise from the archive itself.
+    QVector<quint64> widths = tiers;
+    widths.removeAll(0);
+    std::sort(widths.begin(), widths.end());
+    widths.erase(std::unique(widths.begin(), widths.end()), widths.end());
+    QVector<LoggerRollupPrivate::Tier> built;
+    for (qsizetype index = 0; index < widths.size(); ++index) {
+        qsizetype finer = index - 1;
+        while ((finer >= 0) && ((widths.at(index) % widths.at(finer)) != 0)) {
+            --finer;
+        }
+        built.append((finer < 0) ? LoggerRollupPrivate::rollup(archive, widths.at(index))
+                                 : LoggerRollupPrivate::rollup(built.at(finer), widths.at(index)));
+    }
+
+    // Choose the sections worth keeping, and lay them out after the header, and section table.
+    struct Entry {
+        LoggerRollupPrivate::Section section;                  ///< Section's table entry.
+        const QMap<quint64, LoggerArchive::Aggregate> * buckets; ///< Section's buckets.
+    };
+    QVector<Entry> entries;
+    for (qsizetype index = 0; index < widths.size(); ++index) {
+        for (auto mode = built.at(index).cbegin(); mode != built.at(index).cend(); ++mode) {
+            quint64 samples = 0;
+            for (const LoggerArchive::Aggregate &aggregate: mode.value()) {
+                samples += aggregate.count;
+            }
+            if ((mode.value().isEmpty()) ||
+                (samples < LoggerRollupPrivate::minimumBucketSamples * (quint64)mode.value().size())) {
+                continue; // The archive's raw samples would be smaller.
+            }
+            entries.append({ { widths.at(index), mode.key(), (quint32)mode.value().size(), 0 }, &mode.value() });
+        }
+    }
+    qint64 offset = LoggerRollupPrivate::headerSize + entries.size() * LoggerRollupPrivate::sectionSize;
+    for (Entry &entry: entries) {
+        entry.section.offset = offset;
+        offset += entry.section.count * LoggerRollupPrivate::bucketSize;
+    }
+
+    QByteArray header(LoggerRollupPrivate::headerSize, '\0');
+    uchar * const bytes = reinterpret_cast<uchar *>(header.data());
+    std::memcpy(bytes, LoggerRollupPrivate::fileMagic, sizeof(LoggerRollupPrivate::fileMagic));
+    qToLittleEndian<quint32>(LoggerRollupPrivate::version, bytes + 4);
+    qToLittleEndian<quint64>(QFileInfo(archive.fileName()).size(), bytes + 8);
+    qToLittleEndian<quint32>((quint32)archive.sessionCount(), bytes + 16);
+    qToLittleEndian<quint32>((quint32)entries.size(), bytes + 20);
+    for (const Entry &entry: std::as_const(entries)) {
+        QByteArray section(LoggerRollupPrivate::sectionSize, '\0');
+        uchar * const sectionBytes = reinterpret_cast<uchar *>(section.data());
+        qToLittleEndian<quint64>(entry.section.width, sectionBytes);
+        sectionBytes[8] = (quint8)entry.section.mode;
+        qToLittleEndian<quint32>(entry.section.count, sectionBytes + 12);
+        qToLittleEndian<quint64>(entry.section.offset, sectionBytes + 16);
+        header.append(section);
+    }
+
+    QSaveFile file(d->file.fileName());
+    bool ok = (file.open(QIODevice::WriteOnly)) && (file.write(header) == header.size());
+    for (const Entry &entry: std::as_const(entries)) {
+        for (auto bucket = entry.buckets->cbegin(); (ok) && (bucket != entry.buckets->cend()); ++bucket) {
+            ok = (file.write(LoggerRollupPrivate::encodeBucket(bucket.key(), bucket.value())) ==
+                  LoggerRollupPrivate::bucketSize);
+        }
+    }
+    if ((!ok) || (!file.commit())) {
+        qCWarning(d->lc).noquote() << tr("Failed to write rollup %1: %2").arg(file.fileName(), file.errorString());
+        return false;
+    }
+    qCDebug(d->lc).noquote() << tr("Built rollup %1 with %Ln section/s.", nullptr, entries.size())
+        .arg(file.fileName());
+    return true;
+}
+
+/*!
+ * Memory-maps the rollup file, and parses its section table.
+ *
+ * Returns `true` on success, otherwise `false` if the file could not be opened or mapped, is not a valid rollup, or was
+ * not built from the current contents of the (open) \a archive.
+ */
+bool LoggerRollup::open(const LoggerArchive &archive)
+{
+    Q_D(LoggerRollup);
+    close();
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        qCDebug(d->lc).noquote() << tr("Failed to open rollup %1: %2")
+            .arg(d->file.fileName(), d->file.errorString());
+        return false;
+    }
+    const qint64 size = d->file.size();
+    const uchar * const data = (size > 0) ? d->file.map(0, size) : nullptr;
+    if ((data == nullptr) || (!archive.isOpen()) ||
+        (!d->parse(data, size, QFileInfo(archive.fileName()).size(), (quint32)archive.sessionCount()))) {
+        d->file.close(); // Also unmaps, if mapped.
+        d->sections.clear();
+        return false;
+    }
+    d->data = data;
+    d->size = size;
+    qCDebug(d->lc).noquote() << tr("Opened rollup %1 with %Ln section/s.", nullptr, d->sections.size())
+        .arg(d->file.fileName());
+    return true;
+}
+
+/*!
+ * Returns `true` if the rollup is currently open (ie memory-mapped), otherwise `false`.
+ */
+bool LoggerRollup::isOpen() const
+{
+    Q_D(const LoggerRollup);
+    return (d->data != nullptr);
+}
+
+/*!
+ * Unmaps, and closes, the rollup file. Does nothing if the rollup is not open.
+ */
+void LoggerRollup::close()
+{
+    Q_D(LoggerRollup);
+    if (d->data != nullptr) {
+        d->file.unmap(const_cast<uchar *>(d->data));
+        d->data = nullptr;
+        d->size = 0;
+    }
+    d->file.close();
+    d->sections.clear();
+}
+
+/*!
+ * Returns the widths, in milliseconds, of the rolled up tiers for \a mode, in increasing order, or an empty list if the
+ * rollup is not open.
+ */
+QVector<quint64> LoggerRollup::tiers(const DataLoggerService::Mode mode) const
+{
+    Q_D(const LoggerRollup);
+    QVector<quint64> widths;
+    for (const LoggerRollupPrivate::Section &section: d->sections) {
+        if (section.mode == mode) {
+            widths.append(section.width);
+        }
+    }
+    return widths;
+}
+
+/*!
+ * Returns the \a mode tier's buckets of \a width milliseconds, that start between \a from and \a to (inclusive, and in
+ * milliseconds since the epoch), in time order. Returns an empty list if there is no such tier.
+ *
+ * Buckets are located by binary search, and only the returned buckets are read from the memory-mapped rollup.
+ */
+QVector<LoggerArchive::Bucket> LoggerRollup::buckets(const DataLoggerService::Mode mode, const quint64 width,
+                                                     const quint64 from, const quint64 to) const
+{
+    Q_D(const LoggerRollup);
+    const auto section = std::find_if(d->sections.cbegin(), d->sections.cend(),
+        [mode, width](const LoggerRollupPrivate::Section &entry) {
+            return (entry.mode == mode) && (entry.width == width);
+        });
+    if ((section == d->sections.cend()) || (from > to)) {
+        return { };
+    }
+    const uchar * const first = d->data + section->offset;
+    const auto start = [first](const quint32 index) {
+        return qFromLittleEndian<quint64>(first + index * LoggerRollupPrivate::bucketSize);
+    };
+    quint32 low = 0, high = section->count; // Binary search for the first bucket starting at, or after, from.
+    while (low < high) {
+        const quint32 middle = low + (high - low) / 2;
+        if (start(middle) < from) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    QVector<LoggerArchive::Bucket> buckets;
+    for (quint32 index = low; (index < section->count) && (start(index) <= to); ++index) {
+        buckets.append(d->decodeBucket(first + index * LoggerRollupPrivate::bucketSize));
+    }
+    return buckets;
+}
+
+/*!
+ * \cond internal
+ * \class LoggerRollupPrivate
+ *
+ * The LoggerRollupPrivate class provides private implementation for LoggerRollup.
+ */
+
+/*!
+ * \internal
+ * Constructs a new LoggerRollupPrivate object with public implementation \a q.
+ */
+LoggerRollupPrivate::LoggerRollupPrivate(LoggerRollup * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Returns buckets of \a width milliseconds, for each mode, aggregated from all of \a archive's session runs.
+ */
+LoggerRollupPrivate::Tier LoggerRollupPrivate::rollup(const LoggerArchive &archive, const quint64 width)
+{
+    Tier tier;
+    for (qsizetype index = 0; index < archive.sessionCount(); ++index) {
+        QMap<quint64, LoggerArchive::Aggregate> &buckets = tier[archive.session(index).metadata.mode];
+        const QVector<LoggerArchive::Bucket> runBuckets =
+            archive.downsample(index, 0, std::numeric_limits<quint64>::max(), width);
+        for (const LoggerArchive::Bucket &bucket: runBuckets) {
+            LoggerArchive::merge(buckets[bucket.start], bucket.aggregate);
+        }
+    }
+    return tier;
+}
+
+/*!
+ * Returns buckets of \a width milliseconds, for each mode, merged from the (finer) buckets of \a tier. \a width should
+ * be a multiple of \a tier's bucket width.
+ */
+LoggerRollupPrivate::Tier LoggerRollupPrivate::rollup(const Tier &tier, const quint64 width)
+{
+    Tier coarser;
+    for (auto mode = tier.cbegin(); mode != tier.cend(); ++mode) {
+        QMap<quint64, LoggerArchive::Aggregate> &buckets = coarser[mode.key()];
+        for (auto bucket = mode.value().cbegin(); bucket != mode.value().cend(); ++bucket) {
+            LoggerArchive::merge(buckets[bucket.key() - (bucket.key() % width)], bucket.value());
+        }
+    }
+    return coarser;
+}
+
+/*!
+ * Encodes a single bucket, starting at \a start, with \a aggregate.
+ */
+QByteArray LoggerRollupPrivate::encodeBucket(const quint64 start, const LoggerArchive::Aggregate &aggregate)
+{
+    QByteArray bucket(bucketSize, '\0');
+    uchar * const bytes = reinterpret_cast<uchar *>(bucket.data());
+    qToLittleEndian<quint64>(start, bytes);
+    qToLittleEndian<quint64>(aggregate.count, bytes + 8);
+    qToLittleEndian<float>(aggregate.minimum, bytes + 16);
+    qToLittleEndian<float>(aggregate.maximum, bytes + 20);
+    qToLittleEndian<double>(aggregate.sum, bytes + 24);
+    qToLittleEndian<quint64>(aggregate.firstTimestamp, bytes + 32);
+    qToLittleEndian<quint64>(aggregate.lastTimestamp, bytes + 40);
+    return bucket;
+}
+
+/*!
+ * Decodes a single bucket from \a bytes, which must be at least #bucketSize bytes.
+ */
+LoggerArchive::Bucket LoggerRollupPrivate::decodeBucket(const uchar * const bytes)
+{
+    return {
+        qFromLittleEndian<quint64>(bytes),
+        {
+            qFromLittleEndian<quint64>(bytes + 8),
+            qFromLittleEndian<float>(bytes + 16),
+            qFromLittleEndian<float>(bytes + 20),
+            qFromLittleEndian<double>(bytes + 24),
+            qFromLittleEndian<quint64>(bytes + 32),
+            qFromLittleEndian<quint64>(bytes + 40),
+        }
+    };
+}
+
+/*!
+ * Parses the rollup \a bytes, of \a length bytes, populating #sections from the rollup's section table.
+ *
+ * Returns `true` if \a bytes is a valid rollup, built from a source archive of \a sourceSize bytes and
+ * \a sourceSessions session runs, otherwise `false`.
+ */
+bool LoggerRollupPrivate::parse(const uchar * const bytes, const qint64 length, const qint64 sourceSize,
+                                const quint32 sourceSessions)
+{
+    sections.clear();
+    if ((length < headerSize) || (std::memcmp(bytes, fileMagic, sizeof(fileMagic)) != 0)) {
+        qCWarning(lc).noquote() << tr("Not a logger rollup.");
+        return false;
+    }
+    if (const quint32 fileVersion = qFromLittleEndian<quint32>(bytes + 4); fileVersion != version) {
+        qCWarning(lc).noquote() << tr("Unsupported rollup version: %1").arg(fileVersion);
+        return false;
+    }
+    if ((qFromLittleEndian<quint64>(bytes + 8) != (quint64)sourceSize) ||
+        (qFromLittleEndian<quint32>(bytes + 16) != sourceSessions)) {
+        qCDebug(lc).noquote() << tr("Rollup is out of date.");
+        return false;
+    }
+    const quint32 sectionCount = qFromLittleEndian<quint32>(bytes + 20);
+    const quint64 tableEnd = headerSize + (quint64)sectionCount * sectionSize;
+    if (tableEnd > (quint64)length) {
+        qCWarning(lc).noquote() << tr("Invalid rollup section table: %Ln section/s", nullptr, (int)sectionCount);
+        return false;
+    }
+    sections.reserve(sectionCount);
+    for (const uchar * entry = bytes + headerSize; entry < bytes + tableEnd; entry += sectionSize) {
+        const Section section {
+            qFromLittleEndian<quint64>(entry), (DataLoggerService::Mode)entry[8],
+            qFromLittleEndian<quint32>(entry + 12), (qint64)qFromLittleEndian<quint64>(entry + 16),
+        };
+        if ((section.width == 0) || ((quint64)section.offset < tableEnd) ||
+            ((quint64)section.offset + (quint64)section.count * bucketSize > (quint64)length)) {
+            qCWarning(lc).noquote() << tr("Invalid rollup section: %Ln bucket/s at offset %1", nullptr,
+                (int)section.count).arg(section.offset);
+            sections.clear();
+            return false;
+        }
+        sections.append(section);
+    }
+    return true;
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
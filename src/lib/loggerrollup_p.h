@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the LoggerRollupPrivate class.
+ */
+
+#ifndef QTPOKIT_LOGGERROLLUP_P_H
+#define QTPOKIT_LOGGERROLLUP_P_H
+
+#include <qtpokit/loggerrollup.h>
+
+#include <QFile>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT LoggerRollupPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// A single tier of buckets, for a single meter mode.
+    struct Section {
+        quint64 width;               ///< Width of each of the section's buckets, in milliseconds.
+        DataLoggerService::Mode mode; ///< Logger mode of the section's samples.
+        quint32 count;               ///< Number of buckets in the section.
+        qint64 offset;               ///< File offset of the section's first bucket.
+    };
+
+    /// Buckets, by start time, for each meter mode.
+    typedef QMap<DataLoggerService::Mode, QMap<quint64, LoggerArchive::Aggregate>> Tier;
+
+    static Q_LOGGING_CATEGORY(lc, "pokit.logger.rollup", QtInfoMsg); ///< Logging category.
+
+    static constexpr char fileMagic[4] { 'D', 'O', 'K', 'R' }; ///< Magic bytes at the start of a rollup.
+    static constexpr quint32 version { 1 };        ///< Rollup format version written by this implementation.
+    static constexpr qint64 headerSize { 32 };     ///< Size of the rollup's file header, in bytes.
+    static constexpr qint64 sectionSize { 24 };    ///< Size of each section's table entry, in bytes.
+    static constexpr qint64 bucketSize { 48 };     ///< Size of each bucket, in bytes.
+    static constexpr quint64 minimumBucketSamples { 4 }; ///< Minimum mean samples per bucket worth rolling up.
+
+    QFile file;                 ///< Rollup file, while mapped.
+    const uchar * data { nullptr }; ///< Memory-mapped rollup contents, or `nullptr` if not open.
+    qint64 size { 0 };          ///< Size of the memory-mapped rollup contents, in bytes.
+    QVector<Section> sections;  ///< Rollup sections, in file order.
+
+    explicit LoggerRollupPrivate(LoggerRollup * const q);
+
+    static Tier rollup(const LoggerArchive &archive, const quint64 width);
+    static Tier rollup(const Tier &tier, const quint64 width);
+    static QByteArray encodeBucket(const quint64 start, const LoggerArchive::Aggregate &aggregate);
+    static LoggerArchive::Bucket decodeBucket(const uchar * const bytes);
+
+    bool parse(const uchar * const bytes, const qint64 length, const qint64 sourceSize, const quint32 sourceSessions);
+
+protected:
+    LoggerRollup * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(LoggerRollup)
+    Q_DISABLE_COPY(LoggerRollupPrivate)
+    QTPOKIT_BEFRIEND_TEST(LoggerRollup)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_LOGGERROLLUP_P_H
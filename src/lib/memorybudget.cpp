@@ -0,0 +1,296 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the MemoryBudget class.
+ */
+
+#include <qtpokit/memorybudget.h>
+#include "../stringliterals_p.h"
+
+#include <QMutexLocker>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class MemoryBudget
+ *
+ * The MemoryBudget class accounts for the memory held by an application's buffers, and bounds it, for long-running
+ * processes that must not grow without limit.
+ *
+ * Each buffer accounts for its memory via its own MemoryBudget::Stream, which reserve()s memory before the buffer
+ * grows, and release()s it when the buffer shrinks (or is destroyed). A reservation is refused if it would take the
+ * stream beyond its quota (see Stream::setQuota() and setDefaultQuota()), or all of the budget's streams beyond the
+ * budget's limit (see setLimit()). Refusals are not errors: a buffer whose reservation is refused applies its own
+ * policy instead of growing, such as dropping, or decimating, its oldest values, or blocking its producer. By
+ * default, a budget has no limit, and streams no quotas, so accounting alone never changes any buffer's behaviour.
+ *
+ * The library's growable buffers (SamplePool and DsoCapture), along with its fixed-capacity RingBuffer, all account
+ * against the global() budget. MemoryBudget is thread-safe, so statistics() may be called from any thread, such as
+ * to report the application's memory usage alongside each service's AbstractPokitService::statistics().
+ */
+
+/*!
+ * \class MemoryBudget::Stream
+ *
+ * The MemoryBudget::Stream class accounts for the memory held by a single buffer. All of the stream's memory is
+ * released from its budget when the stream is destroyed, so buffers typically hold their stream as a member. The
+ * budget must outlive all of its streams.
+ */
+
+/// Returns \a kind as a (non-translated) string, suitable for machine-readable output.
+QString MemoryBudget::toString(const Kind kind)
+{
+    switch (kind) {
+    case Kind::RingBuffer: return u"ringBuffer"_s;
+    case Kind::SamplePool: return u"samplePool"_s;
+    case Kind::Capture:    return u"capture"_s;
+    case Kind::Output:     return u"output"_s;
+    case Kind::Spill:      return u"spill"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Constructs a new stream called \a name for a buffer of \a kind, accounted against \a budget.
+ */
+MemoryBudget::Stream::Stream(const QString &name, const Kind kind, MemoryBudget * const budget) : budget(budget)
+{
+    Q_ASSERT(budget);
+    current.name = name;
+    current.kind = kind;
+    const QMutexLocker scopedLock(&budget->mutex);
+    budget->streams.append(this);
+}
+
+/*!
+ * Destroys this stream, releasing all of its memory from its budget.
+ */
+MemoryBudget::Stream::~Stream()
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    budget->used -= current.bytes;
+    budget->streams.removeOne(this);
+}
+
+/*!
+ * Returns this stream's name.
+ */
+QString MemoryBudget::Stream::name() const
+{
+    return current.name;
+}
+
+/*!
+ * Returns the kind of buffer this stream accounts for.
+ */
+MemoryBudget::Kind MemoryBudget::Stream::kind() const
+{
+    return current.kind;
+}
+
+/*!
+ * Returns this stream's quota, in bytes, or 0 if this stream has no quota. Unless set via setQuota(), this is the
+ * budget's defaultQuota().
+ */
+qint64 MemoryBudget::Stream::quota() const
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    return effectiveQuota();
+}
+
+/*!
+ * Sets this stream's quota to \a bytes, or if \a bytes is 0, removes this stream's quota. Memory already held in
+ * excess of the new quota is not released, but further reservations will be refused until enough of it is.
+ */
+void MemoryBudget::Stream::setQuota(const qint64 bytes)
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    streamQuota = qMax<qint64>(bytes, 0);
+}
+
+/*!
+ * Returns \c true if reserving another \a bytes would keep this stream within its quota, and the budget within its
+ * limit, otherwise \c false. So `fits(0)` returns whether the stream (and budget) are currently within bounds.
+ *
+ * Unlike reserve(), this does not count a refusal. Note too that another stream may reserve the remaining budget,
+ * between fits() and the caller's own subsequent charge().
+ */
+bool MemoryBudget::Stream::fits(const qint64 bytes) const
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    const qint64 quota = effectiveQuota();
+    return ((quota == 0) || (current.bytes + bytes <= quota)) &&
+           ((budget->maxBytes == 0) || (budget->used + bytes <= budget->maxBytes));
+}
+
+/*!
+ * Reserves \a bytes for this stream, and returns \c true, if doing so keeps this stream within its quota, and the
+ * budget within its limit. Otherwise, counts a refusal, and returns \c false; the caller should then apply its own
+ * policy, such as dropping the oldest values, instead of growing.
+ */
+bool MemoryBudget::Stream::reserve(const qint64 bytes)
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    const qint64 quota = effectiveQuota();
+    if (((quota > 0) && (current.bytes + bytes > quota)) ||
+        ((budget->maxBytes > 0) && (budget->used + bytes > budget->maxBytes))) {
+        ++current.refusals;
+        ++budget->refusals;
+        return false;
+    }
+    current.bytes += bytes;
+    current.peak = qMax(current.peak, current.bytes);
+    budget->used += bytes;
+    budget->peak = qMax(budget->peak, budget->used);
+    return true;
+}
+
+/*!
+ * Accounts for another \a bytes held by this stream, even if doing so exceeds this stream's quota, or the budget's
+ * limit. This is for memory the caller cannot decline to hold, such as the one buffer that must always be kept.
+ */
+void MemoryBudget::Stream::charge(const qint64 bytes)
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    current.bytes += bytes;
+    current.peak = qMax(current.peak, current.bytes);
+    budget->used += bytes;
+    budget->peak = qMax(budget->peak, budget->used);
+}
+
+/*!
+ * Releases \a bytes previously reserved (or charged) by this stream.
+ */
+void MemoryBudget::Stream::release(const qint64 bytes)
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    Q_ASSERT(bytes <= current.bytes);
+    current.bytes -= bytes;
+    budget->used -= bytes;
+}
+
+/*!
+ * Counts a refusal, for callers that check fits() before applying their own policy, rather than calling reserve().
+ */
+void MemoryBudget::Stream::countRefusal()
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    ++current.refusals;
+    ++budget->refusals;
+}
+
+/*!
+ * Returns the number of bytes this stream currently holds.
+ */
+qint64 MemoryBudget::Stream::bytes() const
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    return current.bytes;
+}
+
+/*!
+ * Returns this stream's usage.
+ */
+MemoryBudget::Usage MemoryBudget::Stream::usage() const
+{
+    const QMutexLocker scopedLock(&budget->mutex);
+    Usage usage = current;
+    usage.quota = effectiveQuota();
+    return usage;
+}
+
+/*!
+ * Returns this stream's effective quota. Must be called with the budget's mutex held.
+ */
+qint64 MemoryBudget::Stream::effectiveQuota() const
+{
+    return (streamQuota < 0) ? budget->streamQuota : streamQuota;
+}
+
+/*!
+ * Constructs a new budget, with no limit, and no default quota.
+ */
+MemoryBudget::MemoryBudget()
+{
+
+}
+
+/*!
+ * Returns the application-wide budget, which the library's own buffers account against.
+ */
+MemoryBudget * MemoryBudget::global()
+{
+    static MemoryBudget budget;
+    return &budget;
+}
+
+/*!
+ * Returns this budget's limit, in bytes, or 0 if this budget has no limit.
+ */
+qint64 MemoryBudget::limit() const
+{
+    const QMutexLocker scopedLock(&mutex);
+    return maxBytes;
+}
+
+/*!
+ * Sets this budget's limit to \a bytes, across all of its streams, or if \a bytes is 0, removes the limit.
+ */
+void MemoryBudget::setLimit(const qint64 bytes)
+{
+    const QMutexLocker scopedLock(&mutex);
+    maxBytes = qMax<qint64>(bytes, 0);
+}
+
+/*!
+ * Returns the quota of each stream that has not had its own quota set, in bytes, or 0 for no quota.
+ */
+qint64 MemoryBudget::defaultQuota() const
+{
+    const QMutexLocker scopedLock(&mutex);
+    return streamQuota;
+}
+
+/*!
+ * Sets the quota of each stream that has not had its own quota set (see Stream::setQuota()) to \a bytes, or if
+ * \a bytes is 0, removes their quota.
+ */
+void MemoryBudget::setDefaultQuota(const qint64 bytes)
+{
+    const QMutexLocker scopedLock(&mutex);
+    streamQuota = qMax<qint64>(bytes, 0);
+}
+
+/*!
+ * Returns the number of bytes currently held by all of this budget's streams.
+ */
+qint64 MemoryBudget::bytes() const
+{
+    const QMutexLocker scopedLock(&mutex);
+    return used;
+}
+
+/*!
+ * Returns this budget's statistics, including the usage of each of its current streams.
+ */
+MemoryBudget::Statistics MemoryBudget::statistics() const
+{
+    const QMutexLocker scopedLock(&mutex);
+    Statistics statistics;
+    statistics.limit = maxBytes;
+    statistics.bytes = used;
+    statistics.peak = peak;
+    statistics.refusals = refusals;
+    statistics.streams.reserve(streams.size());
+    for (const Stream * const stream: streams) {
+        Usage usage = stream->current;
+        usage.quota = stream->effectiveQuota();
+        statistics.streams.append(usage);
+    }
+    return statistics;
+}
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the MeterAggregator and MeterAggregatorPrivate classes.
+ */
+
+#include <qtpokit/meteraggregator.h>
+#include "meteraggregator_p.h"
+
+#include <QDateTime>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class MeterAggregator
+ *
+ * The MeterAggregator class collapses multimeter readings into fixed, or sliding, time windows, emitting the number,
+ * minimum, maximum and mean of the readings in each window.
+ *
+ * Windows are period() milliseconds long, and start at multiples of step() milliseconds since the epoch. By default,
+ * step() is 0, meaning fixed (ie non-overlapping) windows. Otherwise, windows overlap, and each reading is aggregated
+ * into every window that spans it.
+ *
+ * Readings are only ever aggregated with other readings of the same mode and range, and erroneous readings (ie
+ * those with MultimeterService::MeterStatus::Error) are only aggregated with other erroneous readings. So if a
+ * reading's mode or range differs from the open windows', or only one of them is erroneous, then all open windows
+ * are emitted early (see flush()), before the reading starts new windows.
+ *
+ * A window is emitted, via windowReady, once the first reading after the end of that window arrives, or on flush().
+ */
+
+/*!
+ * Constructs a new MeterAggregator object that aggregates readings from \a service, with \a parent.
+ *
+ * \a service may be \c nullptr, in which case readings may be aggregated via addReading() instead.
+ */
+MeterAggregator::MeterAggregator(MultimeterService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new MeterAggregatorPrivate(this))
+{
+    Q_D(MeterAggregator);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new MeterAggregator object with \a service, \a parent, and private implementation \a d.
+ */
+MeterAggregator::MeterAggregator(
+    MeterAggregatorPrivate * const d, MultimeterService * const service, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service);
+}
+/// \endcond
+
+/*!
+ * Destroys this MeterAggregator object.
+ */
+MeterAggregator::~MeterAggregator()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the multimeter service this object aggregates readings from.
+ */
+MultimeterService * MeterAggregator::service() const
+{
+    Q_D(const MeterAggregator);
+    return d->service;
+}
+
+/*!
+ * Returns the length of each window, in milliseconds. The default is 1,000 (ie 1 second).
+ */
+quint32 MeterAggregator::period() const
+{
+    Q_D(const MeterAggregator);
+    return d->period;
+}
+
+/*!
+ * Sets the length of each window to \a period milliseconds. A \a period of 0 is treated as 1.
+ *
+ * Any open windows are emitted first, via flush().
+ */
+void MeterAggregator::setPeriod(const quint32 period)
+{
+    Q_D(MeterAggregator);
+    d->flush();
+    d->period = qMax(period, 1u);
+}
+
+/*!
+ * Returns the step between the start of consecutive windows, in milliseconds, or 0 for fixed windows.
+ */
+quint32 MeterAggregator::step() const
+{
+    Q_D(const MeterAggregator);
+    return d->step;
+}
+
+/*!
+ * Sets the step between the start of consecutive windows to \a step milliseconds.
+ *
+ * A \a step of 0 (the default), or of period() or more, gives fixed (ie non-overlapping) windows, while a smaller \a
+ * step gives sliding windows.
+ *
+ * Any open windows are emitted first, via flush().
+ */
+void MeterAggregator::setStep(const quint32 step)
+{
+    Q_D(MeterAggregator);
+    d->flush();
+    d->step = step;
+}
+
+/*!
+ * Aggregates \a reading, taken at \a timestamp milliseconds since the epoch.
+ *
+ * Readings from service() are aggregated automatically, with the time of their arrival. This slot allows readings
+ * from other sources (or with more accurate timestamps) to be aggregated too. Either way, timestamps should not
+ * decrease.
+ */
+void MeterAggregator::addReading(const MultimeterService::Reading &reading, const qint64 timestamp)
+{
+    Q_D(MeterAggregator);
+    d->addReading(reading, timestamp);
+}
+
+/*!
+ * Emits all open windows, even if they have not yet ended. Typically used when no more readings are expected.
+ */
+void MeterAggregator::flush()
+{
+    Q_D(MeterAggregator);
+    d->flush();
+}
+
+/*!
+ * Discards all open windows, without emitting them.
+ */
+void MeterAggregator::reset()
+{
+    Q_D(MeterAggregator);
+    d->windows.clear();
+}
+
+/*!
+ * \fn MeterAggregator::windowReady
+ *
+ * This signal is emitted when \a window has ended, or been flushed.
+ */
+
+/*!
+ * \cond internal
+ * \class MeterAggregatorPrivate
+ *
+ * The MeterAggregatorPrivate class provides private implementation for MeterAggregator.
+ */
+
+/*!
+ * Constructs a new MeterAggregatorPrivate object with public implementation \a q.
+ */
+MeterAggregatorPrivate::MeterAggregatorPrivate(MeterAggregator * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Sets \a newService as the multimeter service to aggregate readings from, disconnecting from any previous service.
+ */
+void MeterAggregatorPrivate::setService(MultimeterService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &MultimeterService::readingRead, this, &MeterAggregatorPrivate::readingRead);
+    }
+}
+
+/*!
+ * Returns the effective step between the start of consecutive windows, in milliseconds.
+ */
+quint32 MeterAggregatorPrivate::stride() const
+{
+    return ((step == 0) || (step > period)) ? period : step;
+}
+
+/*!
+ * Aggregates \a reading, taken at \a timestamp, into every window that spans it, first emitting any open windows that
+ * have ended, or that \a reading must be kept apart from.
+ */
+void MeterAggregatorPrivate::addReading(const MultimeterService::Reading &reading, const qint64 timestamp)
+{
+    const bool isError = (reading.status == MultimeterService::MeterStatus::Error);
+    if ((!windows.isEmpty()) && ((isError != error) || (reading.mode != mode) || (reading.range != range))) {
+        flush();
+    }
+    error = isError;
+    mode = reading.mode;
+    range = reading.range;
+
+    // Emit (and close) any windows that have ended.
+    while ((!windows.isEmpty()) && (windows.constFirst().start + period <= timestamp)) {
+        emitWindow(windows.constFirst());
+        windows.removeFirst();
+    }
+
+    // Open any windows that span timestamp, but are not open yet. That is, those aligned to the stride, and starting
+    // in the range (timestamp - period, timestamp]. The integer division is floored, for negative timestamps.
+    const qint64 stride = this->stride(), earliest = timestamp - period;
+    qint64 start = ((earliest / stride) - (((earliest % stride) < 0) ? 1 : 0)) * stride + stride;
+    if (!windows.isEmpty()) {
+        start = qMax(start, windows.constLast().start + stride);
+    }
+    for (; start <= timestamp; start += stride) {
+        windows.append({ start, 0, 0.0, std::numeric_limits<float>::infinity(),
+                         -std::numeric_limits<float>::infinity(), reading.status });
+    }
+
+    for (Accumulator &window: windows) {
+        ++window.count;
+        window.status = reading.status;
+        if (!isError) {
+            window.sum += reading.value;
+            window.minimum = qMin(window.minimum, reading.value);
+            window.maximum = qMax(window.maximum, reading.value);
+        }
+    }
+}
+
+/*!
+ * Emits MeterAggregator::windowReady for \a window.
+ */
+void MeterAggregatorPrivate::emitWindow(const Accumulator &window)
+{
+    Q_Q(MeterAggregator);
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    Q_EMIT q->windowReady({
+        window.start, window.start + period, window.count,
+        error ? nan : window.minimum,
+        error ? nan : window.maximum,
+        error ? nan : (float)(window.sum / window.count),
+        window.status, mode, range,
+    });
+}
+
+/*!
+ * Emits, and closes, all open windows.
+ */
+void MeterAggregatorPrivate::flush()
+{
+    const QVector<Accumulator> closing = windows;
+    windows.clear();
+    for (const Accumulator &window: closing) {
+        emitWindow(window);
+    }
+}
+
+/*!
+ * Aggregates \a reading, as read from #service just now.
+ */
+void MeterAggregatorPrivate::readingRead(const MultimeterService::Reading &reading)
+{
+    addReading(reading, QDateTime::currentMSecsSinceEpoch());
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
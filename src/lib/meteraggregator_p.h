@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterAggregatorPrivate class.
+ */
+
+#ifndef QTPOKIT_METERAGGREGATOR_P_H
+#define QTPOKIT_METERAGGREGATOR_P_H
+
+#include <qtpokit/meteraggregator.h>
+
+#include <QObject>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT MeterAggregatorPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Running aggregate of a single, still open, window.
+    struct Accumulator {
+        qint64 start;   ///< Start of the window, in milliseconds since the epoch.
+        quint64 count;  ///< Number of readings accumulated.
+        double sum;     ///< Sum of the accumulated reading values.
+        float minimum;  ///< Minimum accumulated reading value.
+        float maximum;  ///< Maximum accumulated reading value.
+        MultimeterService::MeterStatus status; ///< Status of the most recently accumulated reading.
+    };
+
+    MultimeterService * service { nullptr }; ///< Multimeter service to aggregate readings from.
+    quint32 period { 1000 }; ///< Window length, in milliseconds.
+    quint32 step { 0 };      ///< Window step, in milliseconds, or 0 for fixed (non-overlapping) windows.
+
+    QVector<Accumulator> windows; ///< Open windows, in #Accumulator::start order.
+    bool error { false };         ///< Whether the open #windows are aggregating erroneous readings.
+    MultimeterService::Mode mode { MultimeterService::Mode::Idle }; ///< Mode of the open #windows.
+    quint8 range { 0 };           ///< Range of the open #windows.
+
+    explicit MeterAggregatorPrivate(MeterAggregator * const q);
+
+    void setService(MultimeterService * const newService);
+
+    quint32 stride() const;
+    void addReading(const MultimeterService::Reading &reading, const qint64 timestamp);
+    void emitWindow(const Accumulator &window);
+    void flush();
+
+public Q_SLOTS:
+    void readingRead(const MultimeterService::Reading &reading);
+
+protected:
+    MeterAggregator * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(MeterAggregator)
+    Q_DISABLE_COPY(MeterAggregatorPrivate)
+    QTPOKIT_BEFRIEND_TEST(MeterAggregator)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERAGGREGATOR_P_H
@@ -0,0 +1,263 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the MeterDeadband and MeterDeadbandPrivate classes.
+ */
+
+#include <qtpokit/meterdeadband.h>
+#include "meterdeadband_p.h"
+
+#include <QDateTime>
+#include <QtMath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class MeterDeadband
+ *
+ * The MeterDeadband class filters multimeter readings down to just those that have changed, emitting each changed
+ * reading via readingAccepted, while suppressing readings that are unchanged within tolerance.
+ *
+ * A reading is considered changed if its status, mode or range differs from the last accepted reading's, or if its
+ * value differs from the last accepted value by more than the larger of absoluteDeadband() and relativeDeadband()
+ * (times the magnitude of the last accepted value). Since readings are always compared to the last *accepted*
+ * reading, slow drift is still reported, once it accumulates beyond the deadband.
+ *
+ * Additionally, if heartbeat() is non-zero, then a reading is always accepted once that many milliseconds have passed
+ * since the last accepted reading, so consumers can tell a steady value from a stalled connection.
+ *
+ * With the default deadbands of 0, only exactly repeated readings are suppressed.
+ */
+
+/*!
+ * Constructs a new MeterDeadband object that filters readings from \a service, with \a parent.
+ *
+ * \a service may be \c nullptr, in which case readings may be filtered via addReading() instead.
+ */
+MeterDeadband::MeterDeadband(MultimeterService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new MeterDeadbandPrivate(this))
+{
+    Q_D(MeterDeadband);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new MeterDeadband object with \a service, \a parent, and private implementation \a d.
+ */
+MeterDeadband::MeterDeadband(MeterDeadbandPrivate * const d, MultimeterService * const service, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service);
+}
+/// \endcond
+
+/*!
+ * Destroys this MeterDeadband object.
+ */
+MeterDeadband::~MeterDeadband()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the multimeter service this object filters readings from.
+ */
+MultimeterService * MeterDeadband::service() const
+{
+    Q_D(const MeterDeadband);
+    return d->service;
+}
+
+/*!
+ * Returns the absolute change in value, in the readings' own units, within which readings are suppressed.
+ */
+float MeterDeadband::absoluteDeadband() const
+{
+    Q_D(const MeterDeadband);
+    return d->absoluteDeadband;
+}
+
+/*!
+ * Sets the absolute change in value, in the readings' own units, within which readings are suppressed to \a deadband.
+ * Negative values are treated as 0.
+ */
+void MeterDeadband::setAbsoluteDeadband(const float deadband)
+{
+    Q_D(MeterDeadband);
+    d->absoluteDeadband = qMax(deadband, 0.0f);
+}
+
+/*!
+ * Returns the change in value, as a fraction of the last accepted value, within which readings are suppressed.
+ */
+float MeterDeadband::relativeDeadband() const
+{
+    Q_D(const MeterDeadband);
+    return d->relativeDeadband;
+}
+
+/*!
+ * Sets the change in value, as a fraction of the last accepted value, within which readings are suppressed to \a
+ * deadband. For example, `0.01` suppresses changes of up to 1%. Negative values are treated as 0.
+ */
+void MeterDeadband::setRelativeDeadband(const float deadband)
+{
+    Q_D(MeterDeadband);
+    d->relativeDeadband = qMax(deadband, 0.0f);
+}
+
+/*!
+ * Returns the maximum number of milliseconds between accepted readings, or 0 if there is no such maximum.
+ */
+quint32 MeterDeadband::heartbeat() const
+{
+    Q_D(const MeterDeadband);
+    return d->heartbeat;
+}
+
+/*!
+ * Sets the maximum number of milliseconds between accepted readings to \a heartbeat. That is, the first reading that
+ * arrives at least \a heartbeat milliseconds after the last accepted reading will be accepted, even if unchanged.
+ *
+ * A \a heartbeat of 0 (the default) means unchanged readings are always suppressed.
+ */
+void MeterDeadband::setHeartbeat(const quint32 heartbeat)
+{
+    Q_D(MeterDeadband);
+    d->heartbeat = heartbeat;
+}
+
+/*!
+ * Returns the number of readings accepted since construction, or the last reset().
+ */
+quint64 MeterDeadband::acceptedCount() const
+{
+    Q_D(const MeterDeadband);
+    return d->accepted;
+}
+
+/*!
+ * Returns the number of readings suppressed since construction, or the last reset().
+ */
+quint64 MeterDeadband::suppressedCount() const
+{
+    Q_D(const MeterDeadband);
+    return d->suppressed;
+}
+
+/*!
+ * Filters \a reading, taken at \a timestamp milliseconds since the epoch, returning \c true (and emitting
+ * readingAccepted) if it was accepted, or \c false if it was suppressed.
+ *
+ * Readings from service() are filtered automatically, with the time of their arrival. This slot allows readings from
+ * other sources to be filtered too, or for the caller to filter readings synchronously.
+ */
+bool MeterDeadband::addReading(const MultimeterService::Reading &reading, const qint64 timestamp)
+{
+    Q_D(MeterDeadband);
+    return d->addReading(reading, timestamp);
+}
+
+/*!
+ * Forgets the last accepted reading, such that the next reading will be accepted, and resets the accepted and
+ * suppressed counts.
+ */
+void MeterDeadband::reset()
+{
+    Q_D(MeterDeadband);
+    d->lastReading.reset();
+    d->lastTimestamp = 0;
+    d->accepted = 0;
+    d->suppressed = 0;
+}
+
+/*!
+ * \fn MeterDeadband::readingAccepted
+ *
+ * This signal is emitted when \a reading has changed (or the heartbeat() has expired) since the last accepted reading.
+ */
+
+/*!
+ * \cond internal
+ * \class MeterDeadbandPrivate
+ *
+ * The MeterDeadbandPrivate class provides private implementation for MeterDeadband.
+ */
+
+/*!
+ * Constructs a new MeterDeadbandPrivate object with public implementation \a q.
+ */
+MeterDeadbandPrivate::MeterDeadbandPrivate(MeterDeadband * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Sets \a newService as the multimeter service to filter readings from, disconnecting from any previous service.
+ */
+void MeterDeadbandPrivate::setService(MultimeterService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &MultimeterService::readingRead, this, &MeterDeadbandPrivate::readingRead);
+    }
+}
+
+/*!
+ * Returns \c true if \a reading differs from #lastReading by more than the deadbands, or if there is no #lastReading.
+ */
+bool MeterDeadbandPrivate::isChanged(const MultimeterService::Reading &reading) const
+{
+    if ((!lastReading) || (reading.status != lastReading->status) || (reading.mode != lastReading->mode) ||
+        (reading.range != lastReading->range)) {
+        return true;
+    }
+    if (reading.value == lastReading->value) {
+        return false; // Includes identical infinities, which would otherwise differ by NaN.
+    }
+    if ((!qIsFinite(reading.value)) || (!qIsFinite(lastReading->value))) {
+        // Changes to, from, or between infinity and NaN are always changes, but NaN does not change to NaN.
+        return !((qIsNaN(reading.value)) && (qIsNaN(lastReading->value)));
+    }
+    const float tolerance = qMax(absoluteDeadband, relativeDeadband * qAbs(lastReading->value));
+    return (qAbs(reading.value - lastReading->value) > tolerance);
+}
+
+/*!
+ * Accepts (and emits) \a reading, taken at \a timestamp, if it has changed, or the heartbeat has expired, otherwise
+ * suppresses it. Returns \c true if accepted.
+ */
+bool MeterDeadbandPrivate::addReading(const MultimeterService::Reading &reading, const qint64 timestamp)
+{
+    if ((!isChanged(reading)) && ((heartbeat == 0) || (timestamp - lastTimestamp < heartbeat))) {
+        ++suppressed;
+        return false;
+    }
+    lastReading = reading;
+    lastTimestamp = timestamp;
+    ++accepted;
+    Q_Q(MeterDeadband);
+    Q_EMIT q->readingAccepted(reading);
+    return true;
+}
+
+/*!
+ * Filters \a reading, as read from #service just now.
+ */
+void MeterDeadbandPrivate::readingRead(const MultimeterService::Reading &reading)
+{
+    addReading(reading, QDateTime::currentMSecsSinceEpoch());
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
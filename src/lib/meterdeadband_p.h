@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterDeadbandPrivate class.
+ */
+
+#ifndef QTPOKIT_METERDEADBAND_P_H
+#define QTPOKIT_METERDEADBAND_P_H
+
+#include <qtpokit/meterdeadband.h>
+
+#include <QObject>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT MeterDeadbandPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    MultimeterService * service { nullptr }; ///< Multimeter service to filter readings from.
+    float absoluteDeadband { 0.0f }; ///< Absolute change (in the reading's units) to suppress.
+    float relativeDeadband { 0.0f }; ///< Change, relative to the last accepted value, to suppress.
+    quint32 heartbeat { 0 };         ///< Maximum silence, in milliseconds, or 0 for no heartbeat.
+
+    std::optional<MultimeterService::Reading> lastReading; ///< Most recently accepted reading, if any.
+    qint64 lastTimestamp { 0 }; ///< Timestamp of #lastReading, in milliseconds since the epoch.
+    quint64 accepted { 0 };     ///< Number of readings accepted.
+    quint64 suppressed { 0 };   ///< Number of readings suppressed.
+
+    explicit MeterDeadbandPrivate(MeterDeadband * const q);
+
+    void setService(MultimeterService * const newService);
+
+    bool isChanged(const MultimeterService::Reading &reading) const;
+    bool addReading(const MultimeterService::Reading &reading, const qint64 timestamp);
+
+public Q_SLOTS:
+    void readingRead(const MultimeterService::Reading &reading);
+
+protected:
+    MeterDeadband * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(MeterDeadband)
+    Q_DISABLE_COPY(MeterDeadbandPrivate)
+    QTPOKIT_BEFRIEND_TEST(MeterDeadband)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERDEADBAND_P_H
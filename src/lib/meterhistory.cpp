@@ -0,0 +1,506 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the MeterHistory class.
+ */
+
+#include <qtpokit/meterhistory.h>
+
+#include <QtMath>
+
+#include <algorithm>
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class MeterHistory
+ *
+ * The MeterHistory class stores a (potentially very long) history of multimeter readings, such as those recorded by
+ * bursts, or shown by live charts, in a compact, columnar, form.
+ *
+ * Storing MultimeterService::TimedReading structs as-is costs 24 bytes per reading, of which only the value and the
+ * timestamp vary much from one reading to the next, and a fair bit is padding. So instead, readings are stored in
+ * chunks (of up to chunkSize() readings each), with each chunk holding its readings' properties in separate columns:
+ * * values, in a contiguous array of floats;
+ * * timestamps, as 32-bit deltas from the previous reading (enough for intervals of up to about 4.3 seconds), with
+ *   any larger (or negative) deltas escaped to a separate, and normally empty, array of 64-bit deltas;
+ * * and statuses, modes and ranges, which rarely change, run-length encoded together.
+ *
+ * So each reading typically costs just 8 bytes, plus a little per-chunk overhead. And since values are contiguous,
+ * scanning them (via spans()) is a simple loop over an array of floats, without striding over the other properties.
+ * Iterating readings in order (via begin() and end()) is cheap too, since timestamps are decoded incrementally; but
+ * random access (via at()) must decode timestamps from the start of a reading's chunk, so is best avoided in loops.
+ *
+ * Chunks are implicitly shared, so copying a history, or taking a slice() of it, only copies the (at most two)
+ * partially included chunks, while removeBefore() drops just the oldest chunks, making MeterHistory suitable for
+ * rolling histories too. Readings must be appended in non-decreasing timestamp order, for indexOf(), between() and
+ * removeBefore() to be meaningful.
+ */
+
+/*!
+ * \cond internal
+ * \struct MeterHistory::Run
+ *
+ * The MeterHistory::Run struct is a single entry of a chunk's run-length encoded statuses, modes and ranges. Each run
+ * extends until the next run's start, or the end of its chunk.
+ *
+ * \struct MeterHistory::Chunk
+ *
+ * The MeterHistory::Chunk struct holds the columns of a chunk of consecutive readings.
+ * \endcond
+ */
+
+/*!
+ * Constructs a new, empty, history, storing up to \a chunkSize readings per chunk.
+ */
+MeterHistory::MeterHistory(const qsizetype chunkSize)
+    : capacity(qBound((qsizetype)1, chunkSize, (qsizetype)std::numeric_limits<qint32>::max()))
+{
+
+}
+
+/*!
+ * Returns the maximum number of readings stored per chunk.
+ */
+qsizetype MeterHistory::chunkSize() const
+{
+    return capacity;
+}
+
+/*!
+ * Returns the number of chunks the history's readings are currently stored in.
+ */
+qsizetype MeterHistory::chunkCount() const
+{
+    return chunks.size();
+}
+
+/*!
+ * Returns the number of readings in the history.
+ */
+qsizetype MeterHistory::size() const
+{
+    return count;
+}
+
+/*!
+ * Returns \c true if the history has no readings, otherwise \c false.
+ */
+bool MeterHistory::isEmpty() const
+{
+    return count == 0;
+}
+
+/*!
+ * Returns the approximate number of bytes of memory used by the history, including memory allocated for readings not
+ * yet appended. Chunks shared with other histories (such as slices) are counted in full.
+ */
+qsizetype MeterHistory::memoryUsage() const
+{
+    qsizetype bytes = (qsizetype)(sizeof(MeterHistory) + (qsizetype)chunks.capacity() * sizeof(Chunk));
+    for (const Chunk &chunk: chunks) {
+        bytes += (qsizetype)(chunk.values.capacity() * sizeof(float) + chunk.deltas.capacity() * sizeof(quint32)
+            + chunk.wide.capacity() * sizeof(qint64) + chunk.runs.capacity() * sizeof(Run));
+    }
+    return bytes;
+}
+
+/*!
+ * Appends \a reading, received at \a timestamp, to the history.
+ */
+void MeterHistory::append(const qint64 timestamp, const MultimeterService::Reading &reading)
+{
+    if ((chunks.isEmpty()) || (chunks.constLast().values.size() >= capacity)) {
+        Chunk chunk;
+        chunk.values.reserve(capacity);
+        chunk.deltas.reserve(capacity);
+        chunks.append(chunk);
+    }
+
+    Chunk &chunk = chunks.last();
+    const qsizetype position = chunk.values.size();
+    if (position == 0) {
+        chunk.first = timestamp;
+        chunk.deltas.append(0);
+    } else if (const qint64 delta = timestamp - chunk.last; (delta < 0) || (delta >= wideDelta)) {
+        chunk.deltas.append(wideDelta);
+        chunk.wide.append(delta);
+    } else {
+        chunk.deltas.append((quint32)delta);
+    }
+    chunk.last = timestamp;
+    chunk.values.append(reading.value);
+
+    if ((chunk.runs.isEmpty()) || (chunk.runs.constLast().status != reading.status)
+        || (chunk.runs.constLast().mode != reading.mode) || (chunk.runs.constLast().range != reading.range))
+    {
+        chunk.runs.append({ (quint32)position, reading.status, reading.mode, reading.range });
+    }
+    ++count;
+}
+
+/*!
+ * Appends timed \a reading to the history.
+ */
+void MeterHistory::append(const MultimeterService::TimedReading &reading)
+{
+    append(reading.timestamp, reading.reading);
+}
+
+/*!
+ * Appends timed \a readings, such as a burst capture, to the history.
+ */
+void MeterHistory::append(const QVector<MultimeterService::TimedReading> &readings)
+{
+    for (const MultimeterService::TimedReading &reading: readings) {
+        append(reading.timestamp, reading.reading);
+    }
+}
+
+/*!
+ * Removes all readings from the history, releasing their memory.
+ */
+void MeterHistory::clear()
+{
+    chunks.clear();
+    count = 0;
+}
+
+/*!
+ * Returns the timestamp of the history's first (oldest) reading, or 0 if the history is empty.
+ */
+qint64 MeterHistory::firstTimestamp() const
+{
+    return (chunks.isEmpty()) ? 0 : chunks.constFirst().first;
+}
+
+/*!
+ * Returns the timestamp of the history's last (newest) reading, or 0 if the history is empty.
+ */
+qint64 MeterHistory::lastTimestamp() const
+{
+    return (chunks.isEmpty()) ? 0 : chunks.constLast().last;
+}
+
+/*!
+ * Returns the reading at \a index, decoding its timestamp from the start of its chunk. If \a index is out of range, an
+ * Error reading, with a NaN value, and a 0 timestamp, is returned instead.
+ *
+ * For accessing many readings, iterating via begin() and end() is much faster.
+ */
+MultimeterService::TimedReading MeterHistory::at(const qsizetype index) const
+{
+    qsizetype position = index;
+    const qsizetype chunkIndex = locate(position);
+    if (chunkIndex < 0) {
+        return { 0, { MultimeterService::MeterStatus::Error, qQNaN(), MultimeterService::Mode::Idle, 0 } };
+    }
+
+    const Chunk &chunk = chunks.at(chunkIndex);
+    qint64 timestamp = chunk.first;
+    qsizetype wide = 0;
+    for (qsizetype i = 1; i <= position; ++i) {
+        const quint32 delta = chunk.deltas.at(i);
+        timestamp += (delta == wideDelta) ? chunk.wide.at(wide++) : (qint64)delta;
+    }
+    const auto run = std::prev(std::upper_bound(chunk.runs.cbegin(), chunk.runs.cend(), (quint32)position,
+        [](const quint32 start, const Run &run) { return start < run.start; }));
+    return { timestamp, { run->status, chunk.values.at(position), run->mode, run->range } };
+}
+
+/*!
+ * Returns the index of the first reading with a timestamp at, or after, \a timestamp, or size() if there is none.
+ */
+qsizetype MeterHistory::indexOf(const qint64 timestamp) const
+{
+    qsizetype offset = 0;
+    for (const Chunk &chunk: chunks) {
+        if (chunk.last >= timestamp) {
+            qint64 current = chunk.first;
+            qsizetype wide = 0;
+            for (qsizetype position = 0; position < chunk.deltas.size(); ++position) {
+                if (position > 0) {
+                    const quint32 delta = chunk.deltas.at(position);
+                    current += (delta == wideDelta) ? chunk.wide.at(wide++) : (qint64)delta;
+                }
+                if (current >= timestamp) {
+                    return offset + position;
+                }
+            }
+        }
+        offset += chunk.values.size();
+    }
+    return count;
+}
+
+/*!
+ * Returns a new history, of the same chunkSize(), holding (up to) \a count readings from \a first onwards, or all
+ * readings from \a first onwards if \a count is negative.
+ *
+ * Chunks wholly within the slice are shared with this history, so are not copied unless either history subsequently
+ * modifies them.
+ */
+MeterHistory MeterHistory::slice(const qsizetype first, const qsizetype count) const
+{
+    MeterHistory result(capacity);
+    const qsizetype from = qBound((qsizetype)0, first, this->count);
+    const qsizetype to = (count < 0) ? this->count : from + qMin(count, this->count - from);
+    qsizetype offset = 0;
+    for (qsizetype index = 0; (index < chunks.size()) && (offset < to); ++index) {
+        const Chunk &chunk = chunks.at(index);
+        const qsizetype size = chunk.values.size();
+        if (offset + size > from) {
+            const qsizetype begin = qMax(from - offset, (qsizetype)0);
+            const qsizetype end = qMin(to - offset, size);
+            if ((begin == 0) && (end == size)) {
+                result.chunks.append(chunk);
+                result.count += size;
+            } else {
+                ConstIterator iter(this, index);
+                for (qsizetype position = 0; position < end; ++position, ++iter) {
+                    if (position >= begin) {
+                        result.append(*iter);
+                    }
+                }
+            }
+        }
+        offset += size;
+    }
+    return result;
+}
+
+/*!
+ * Returns a new history, of the same chunkSize(), holding the readings with timestamps at, or after, \a from, but
+ * before \a to.
+ */
+MeterHistory MeterHistory::between(const qint64 from, const qint64 to) const
+{
+    const qsizetype first = indexOf(from);
+    return slice(first, qMax(indexOf(to) - first, (qsizetype)0));
+}
+
+/*!
+ * Removes all readings with timestamps before \a timestamp, returning the number of readings removed. Whole chunks
+ * are simply released, so only the (at most one) chunk that is partially removed is copied.
+ */
+qsizetype MeterHistory::removeBefore(const qint64 timestamp)
+{
+    const qsizetype removed = indexOf(timestamp);
+    if (removed > 0) {
+        *this = slice(removed);
+    }
+    return removed;
+}
+
+/*!
+ * Returns the spans of (up to) \a count readings from \a first onwards, or all readings from \a first onwards if
+ * \a count is negative. Each span is a run of readings, within one chunk, that share the same status, mode and range,
+ * and whose values are contiguous. So statistics, for example, may be computed in simple loops over each span's
+ * values, skipping error spans entirely.
+ *
+ * The spans' values remain valid only until the history is next modified.
+ */
+QVector<MeterHistory::Span> MeterHistory::spans(const qsizetype first, const qsizetype count) const
+{
+    QVector<Span> result;
+    const qsizetype from = qBound((qsizetype)0, first, this->count);
+    const qsizetype to = (count < 0) ? this->count : from + qMin(count, this->count - from);
+    qsizetype offset = 0;
+    for (qsizetype index = 0; (index < chunks.size()) && (offset < to); ++index) {
+        const Chunk &chunk = chunks.at(index);
+        const qsizetype size = chunk.values.size();
+        if (offset + size > from) {
+            const qsizetype begin = qMax(from - offset, (qsizetype)0);
+            const qsizetype end = qMin(to - offset, size);
+            qint64 timestamp = chunk.first;
+            qsizetype position = 0, wide = 0;
+            for (qsizetype run = 0; run < chunk.runs.size(); ++run) {
+                const qsizetype runStart = qMax((qsizetype)chunk.runs.at(run).start, begin);
+                const qsizetype runEnd = qMin((run + 1 < chunk.runs.size())
+                    ? (qsizetype)chunk.runs.at(run + 1).start : size, end);
+                if (runStart >= runEnd) {
+                    continue;
+                }
+                for (; position < runStart; ++position) {
+                    const quint32 delta = chunk.deltas.at(position + 1);
+                    timestamp += (delta == wideDelta) ? chunk.wide.at(wide++) : (qint64)delta;
+                }
+                const Run &entry = chunk.runs.at(run);
+                result.append({ offset + runStart, runEnd - runStart, chunk.values.constData() + runStart,
+                                timestamp, entry.status, entry.mode, entry.range });
+            }
+        }
+        offset += size;
+    }
+    return result;
+}
+
+/*!
+ * Returns an iterator to the history's first reading.
+ */
+MeterHistory::ConstIterator MeterHistory::begin() const
+{
+    return ConstIterator(this, 0);
+}
+
+/*!
+ * Returns an iterator to just past the history's last reading.
+ */
+MeterHistory::ConstIterator MeterHistory::end() const
+{
+    return ConstIterator(this, chunks.size());
+}
+
+/*!
+ * Returns an iterator to the history's first reading.
+ */
+MeterHistory::ConstIterator MeterHistory::constBegin() const
+{
+    return begin();
+}
+
+/*!
+ * Returns an iterator to just past the history's last reading.
+ */
+MeterHistory::ConstIterator MeterHistory::constEnd() const
+{
+    return end();
+}
+
+/*!
+ * Returns the history's readings, as timed multimeter readings.
+ */
+QVector<MultimeterService::TimedReading> MeterHistory::toVector() const
+{
+    QVector<MultimeterService::TimedReading> readings;
+    readings.reserve(count);
+    for (const MultimeterService::TimedReading &reading: *this) {
+        readings.append(reading);
+    }
+    return readings;
+}
+
+/*!
+ * Returns a new history, storing up to \a chunkSize readings per chunk, holding timed \a readings.
+ */
+MeterHistory MeterHistory::fromVector(const QVector<MultimeterService::TimedReading> &readings,
+                                      const qsizetype chunkSize)
+{
+    MeterHistory history(chunkSize);
+    history.append(readings);
+    return history;
+}
+
+/*!
+ * \internal
+ * Returns the index of the chunk holding the reading at \a index, updating \a index to the reading's position within
+ * that chunk; or -1 if \a index is out of range.
+ */
+qsizetype MeterHistory::locate(qsizetype &index) const
+{
+    if ((index < 0) || (index >= count)) {
+        return -1;
+    }
+    for (qsizetype chunk = 0; chunk < chunks.size(); ++chunk) {
+        const qsizetype size = chunks.at(chunk).values.size();
+        if (index < size) {
+            return chunk;
+        }
+        index -= size;
+    }
+    return -1; // Unreachable, since index < count.
+}
+
+/*!
+ * \class MeterHistory::ConstIterator
+ *
+ * The MeterHistory::ConstIterator class iterates over a MeterHistory's readings, in order, yielding decoded copies of
+ * each. Iterators are invalidated by any modification of the history they iterate over.
+ */
+
+/*!
+ * \fn MeterHistory::ConstIterator::ConstIterator()
+ *
+ * Constructs a null iterator, not associated with any history.
+ */
+
+/*!
+ * \internal
+ * Constructs an iterator to the first reading of \a history's chunk at index \a chunk, or the end of \a history if
+ * \a chunk is out of range.
+ */
+MeterHistory::ConstIterator::ConstIterator(const MeterHistory * const history, const qsizetype chunk)
+    : history(history), chunk(chunk)
+{
+    enterChunk();
+}
+
+/*!
+ * Returns the current reading.
+ */
+MultimeterService::TimedReading MeterHistory::ConstIterator::operator*() const
+{
+    const Chunk &current = history->chunks.at(chunk);
+    const Run &entry = current.runs.at(run);
+    return { timestamp, { entry.status, current.values.at(position), entry.mode, entry.range } };
+}
+
+/*!
+ * Advances the iterator to the next reading, and returns a reference to the iterator.
+ */
+MeterHistory::ConstIterator &MeterHistory::ConstIterator::operator++()
+{
+    const Chunk &current = history->chunks.at(chunk);
+    if (++position >= current.values.size()) {
+        ++chunk;
+        enterChunk();
+        return *this;
+    }
+    const quint32 delta = current.deltas.at(position);
+    timestamp += (delta == wideDelta) ? current.wide.at(wide++) : (qint64)delta;
+    if ((run + 1 < current.runs.size()) && ((qsizetype)current.runs.at(run + 1).start == position)) {
+        ++run;
+    }
+    return *this;
+}
+
+/*!
+ * Advances the iterator to the next reading, and returns a copy of the iterator from before it was advanced.
+ */
+MeterHistory::ConstIterator MeterHistory::ConstIterator::operator++(int)
+{
+    ConstIterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+/*!
+ * Returns \c true if this iterator, and \a other, refer to the same reading of the same history, otherwise \c false.
+ */
+bool MeterHistory::ConstIterator::operator==(const ConstIterator &other) const
+{
+    return (history == other.history) && (chunk == other.chunk) && (position == other.position);
+}
+
+/*!
+ * Returns \c true if this iterator, and \a other, refer to different readings, otherwise \c false.
+ */
+bool MeterHistory::ConstIterator::operator!=(const ConstIterator &other) const
+{
+    return !(*this == other);
+}
+
+/*!
+ * \internal
+ * Resets the iterator to the first reading of the current #chunk, if there is one.
+ */
+void MeterHistory::ConstIterator::enterChunk()
+{
+    position = run = wide = 0;
+    timestamp = ((history != nullptr) && (chunk < history->chunks.size())) ? history->chunks.at(chunk).first : 0;
+}
+
+QTPOKIT_END_NAMESPACE
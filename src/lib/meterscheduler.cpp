@@ -0,0 +1,274 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the MeterScheduler and MeterSchedulerPrivate classes.
+ */
+
+#include <qtpokit/meterscheduler.h>
+#include "meterscheduler_p.h"
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class MeterScheduler
+ *
+ * The MeterScheduler class cycles a single multimeter service through a list of (mode, range, dwell) entries,
+ * round-robin, over one connection, so that (for example) DC voltage and DC current can both be measured by one
+ * Pokit device.
+ *
+ * Reading notifications are enabled once, by start(). Then, for each entry in turn, the entry's settings are written,
+ * immediately followed by a request to read the current reading. Since the Bluetooth stack processes requests in
+ * order, this pipelines the settings write with the first reading of each mode, rather than waiting for the write to
+ * be acknowledged, and then for the next notification.
+ *
+ * Readings that do not match the current entry's mode (and range, unless auto-ranging) are assumed to belong to the
+ * previous entry, and are discarded (see staleCount()). All other readings are emitted via readingReady, tagged with
+ * the index of their entry. The latency of each switch, from the settings write to the entry's first reading, is
+ * emitted via entryStarted, which can be used to tune each entry's dwell time.
+ */
+
+/*!
+ * Constructs a new MeterScheduler object that schedules measurements on \a service, with \a parent.
+ */
+MeterScheduler::MeterScheduler(MultimeterService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new MeterSchedulerPrivate(this))
+{
+    Q_D(MeterScheduler);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new MeterScheduler object with \a service, \a parent, and private implementation \a d.
+ */
+MeterScheduler::MeterScheduler(
+    MeterSchedulerPrivate * const d, MultimeterService * const service, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service);
+}
+/// \endcond
+
+/*!
+ * Destroys this MeterScheduler object.
+ */
+MeterScheduler::~MeterScheduler()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the multimeter service this object schedules measurements on.
+ */
+MultimeterService * MeterScheduler::service() const
+{
+    Q_D(const MeterScheduler);
+    return d->service;
+}
+
+/*!
+ * Returns the measurement schedule.
+ */
+QVector<MeterScheduler::Entry> MeterScheduler::entries() const
+{
+    Q_D(const MeterScheduler);
+    return d->entries;
+}
+
+/*!
+ * Sets the measurement schedule to \a entries. If the schedule is running, the new \a entries take effect from the
+ * next switch.
+ */
+void MeterScheduler::setEntries(const QVector<Entry> &entries)
+{
+    Q_D(MeterScheduler);
+    d->entries = entries;
+}
+
+/*!
+ * Returns the update interval, in milliseconds, written with each entry's settings. The default is 1,000.
+ */
+quint32 MeterScheduler::updateInterval() const
+{
+    Q_D(const MeterScheduler);
+    return d->updateInterval;
+}
+
+/*!
+ * Sets the update interval, in milliseconds, written with each entry's settings, to \a interval.
+ */
+void MeterScheduler::setUpdateInterval(const quint32 interval)
+{
+    Q_D(MeterScheduler);
+    d->updateInterval = interval;
+}
+
+/*!
+ * Returns \c true if the schedule is running.
+ */
+bool MeterScheduler::isRunning() const
+{
+    Q_D(const MeterScheduler);
+    return d->running;
+}
+
+/*!
+ * Returns the index of the current entry, or -1 if the schedule is not running.
+ */
+int MeterScheduler::currentIndex() const
+{
+    Q_D(const MeterScheduler);
+    return d->index;
+}
+
+/*!
+ * Returns the number of readings discarded, since the last start(), as belonging to a previous entry.
+ */
+quint64 MeterScheduler::staleCount() const
+{
+    Q_D(const MeterScheduler);
+    return d->stale;
+}
+
+/*!
+ * Starts the schedule, from the first entry. Returns \c true if the first entry's settings were successfully queued,
+ * or \c false if not (including if there is no service(), or no entries()).
+ *
+ * Even if the first entry's settings could not be queued, the schedule still runs, and will move on to the next entry
+ * once the first entry's dwell has passed.
+ */
+bool MeterScheduler::start()
+{
+    Q_D(MeterScheduler);
+    if ((!d->service) || (d->entries.isEmpty())) {
+        qCWarning(d->lc).noquote() << tr("Cannot start a schedule without a service and entries.");
+        return false;
+    }
+    d->running = true;
+    d->stale = 0;
+    d->service->enableReadingNotifications();
+    return d->beginEntry(0);
+}
+
+/*!
+ * Stops the schedule. The device is left in the current entry's mode, and reading notifications are left enabled.
+ */
+void MeterScheduler::stop()
+{
+    Q_D(MeterScheduler);
+    d->dwellTimer.stop();
+    d->running = false;
+    d->switching = false;
+    d->index = -1;
+}
+
+/*!
+ * \fn MeterScheduler::entryStarted
+ *
+ * This signal is emitted when the first reading for the entry at \a index has arrived, \a latency milliseconds after
+ * its settings were written.
+ */
+
+/*!
+ * \fn MeterScheduler::readingReady
+ *
+ * This signal is emitted when \a reading has been read for the entry at \a index.
+ */
+
+/*!
+ * \cond internal
+ * \class MeterSchedulerPrivate
+ *
+ * The MeterSchedulerPrivate class provides private implementation for MeterScheduler.
+ */
+
+/*!
+ * Constructs a new MeterSchedulerPrivate object with public implementation \a q.
+ */
+MeterSchedulerPrivate::MeterSchedulerPrivate(MeterScheduler * const q) : q_ptr(q)
+{
+    dwellTimer.setSingleShot(true);
+    connect(&dwellTimer, &QTimer::timeout, this, &MeterSchedulerPrivate::nextEntry);
+}
+
+/*!
+ * Sets \a newService as the multimeter service to schedule measurements on, disconnecting from any previous service.
+ */
+void MeterSchedulerPrivate::setService(MultimeterService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &MultimeterService::readingRead, this, &MeterSchedulerPrivate::readingRead);
+    }
+}
+
+/*!
+ * Switches to the entry at \a newIndex, by writing its settings, and requesting its first reading. Returns \c true if
+ * the settings write was successfully queued.
+ */
+bool MeterSchedulerPrivate::beginEntry(const int newIndex)
+{
+    index = newIndex;
+    const MeterScheduler::Entry &entry = entries.at(index);
+    qCDebug(lc).noquote() << tr("Switching to entry %1: %2").arg(index).arg(MultimeterService::toString(entry.mode));
+    switching = true;
+    switchTimer.start();
+    dwellTimer.start(entry.dwell);
+    if (!service->setSettings({ entry.mode, entry.range, updateInterval })) {
+        qCWarning(lc).noquote() << tr("Failed to write settings for entry %1.").arg(index);
+        return false;
+    }
+    service->readReadingCharacteristic(); // Queued after the settings write, so reads the new mode.
+    return true;
+}
+
+/*!
+ * Returns \c true if \a reading matches the current entry's mode, and range (unless auto-ranging).
+ */
+bool MeterSchedulerPrivate::isCurrent(const MultimeterService::Reading &reading) const
+{
+    const MeterScheduler::Entry &entry = entries.at(index);
+    return (reading.mode == entry.mode) && ((entry.range == autoRange) || (reading.range == entry.range));
+}
+
+/*!
+ * Switches to the next entry, wrapping around to the first entry after the last.
+ */
+void MeterSchedulerPrivate::nextEntry()
+{
+    if ((running) && (!entries.isEmpty())) {
+        beginEntry((index + 1) % entries.size());
+    }
+}
+
+/*!
+ * Emits \a reading, tagged with the current entry's index, unless it belongs to a previous entry.
+ */
+void MeterSchedulerPrivate::readingRead(const MultimeterService::Reading &reading)
+{
+    Q_Q(MeterScheduler);
+    if ((!running) || (index >= entries.size())) {
+        return;
+    }
+    if (!isCurrent(reading)) {
+        ++stale;
+        return;
+    }
+    if (switching) {
+        switching = false;
+        Q_EMIT q->entryStarted(index, switchTimer.elapsed());
+    }
+    Q_EMIT q->readingReady(reading, index);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
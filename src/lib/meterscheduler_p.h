@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterSchedulerPrivate class.
+ */
+
+#ifndef QTPOKIT_METERSCHEDULER_P_H
+#define QTPOKIT_METERSCHEDULER_P_H
+
+#include <qtpokit/meterscheduler.h>
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QTimer>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT MeterSchedulerPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.meter.scheduler", QtInfoMsg); ///< Logging category.
+
+    static constexpr quint8 autoRange { 255 }; ///< Range value of all Pokit products' AutoRange enumerators.
+
+    MultimeterService * service { nullptr }; ///< Multimeter service to schedule measurements on.
+    QVector<MeterScheduler::Entry> entries;  ///< Measurement schedule.
+    quint32 updateInterval { 1000 };         ///< Update interval, in milliseconds, for all entries.
+
+    bool running { false };      ///< Whether the schedule is running.
+    int index { -1 };            ///< Index of the current entry, or -1 if not running.
+    bool switching { false };    ///< Whether the current entry's first reading is yet to arrive.
+    QElapsedTimer switchTimer;   ///< Times the switch to the current entry.
+    QTimer dwellTimer;           ///< Times the current entry's dwell.
+    quint64 stale { 0 };         ///< Number of readings discarded as belonging to a previous entry.
+
+    explicit MeterSchedulerPrivate(MeterScheduler * const q);
+
+    void setService(MultimeterService * const newService);
+
+    bool beginEntry(const int newIndex);
+    bool isCurrent(const MultimeterService::Reading &reading) const;
+
+public Q_SLOTS:
+    void nextEntry();
+    void readingRead(const MultimeterService::Reading &reading);
+
+protected:
+    MeterScheduler * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(MeterScheduler)
+    Q_DISABLE_COPY(MeterSchedulerPrivate)
+    QTPOKIT_BEFRIEND_TEST(MeterScheduler)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERSCHEDULER_P_H
@@ -0,0 +1,245 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the MeterSettler and MeterSettlerPrivate classes.
+ */
+
+#include <qtpokit/metersettler.h>
+#include "metersettler_p.h"
+
+#include <QDateTime>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class MeterSettler
+ *
+ * The MeterSettler class tracks mode and range transitions in a stream of multimeter readings, such as when an
+ * auto-ranging device (ie one reporting MultimeterService::MeterStatus::AutoRangeOn) switches ranges, and separates
+ * the transitional readings that follow each transition from those taken after the value has settled.
+ *
+ * A transition is any change of mode or range between consecutive readings. Readings taken less than
+ * settleTime() milliseconds (for the new mode) after the most recent transition are considered unsettled, and are
+ * emitted via readingUnsettled, while all other readings are emitted via readingSettled. Consumers can therefore
+ * suppress transitional readings, by connecting to readingSettled only, or tag them, by connecting to both.
+ *
+ * The first reading is always considered settled, since no transition precedes it.
+ */
+
+/*!
+ * Constructs a new MeterSettler object that tracks readings from \a service, with \a parent.
+ *
+ * \a service may be \c nullptr, in which case readings may be tracked via addReading() instead.
+ */
+MeterSettler::MeterSettler(MultimeterService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new MeterSettlerPrivate(this))
+{
+    Q_D(MeterSettler);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new MeterSettler object with \a service, \a parent, and private implementation \a d.
+ */
+MeterSettler::MeterSettler(MeterSettlerPrivate * const d, MultimeterService * const service, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service);
+}
+/// \endcond
+
+/*!
+ * Destroys this MeterSettler object.
+ */
+MeterSettler::~MeterSettler()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the multimeter service this object tracks readings from.
+ */
+MultimeterService * MeterSettler::service() const
+{
+    Q_D(const MeterSettler);
+    return d->service;
+}
+
+/*!
+ * Returns the settle time, in milliseconds, for modes without their own settle time. The default is 500.
+ */
+quint32 MeterSettler::defaultSettleTime() const
+{
+    Q_D(const MeterSettler);
+    return d->defaultSettleTime;
+}
+
+/*!
+ * Sets the settle time, in milliseconds, for modes without their own settle time, to \a settleTime.
+ */
+void MeterSettler::setDefaultSettleTime(const quint32 settleTime)
+{
+    Q_D(MeterSettler);
+    d->defaultSettleTime = settleTime;
+}
+
+/*!
+ * Returns the settle time, in milliseconds, for \a mode. That is, how long after a transition to (or within) \a mode
+ * readings are considered unsettled.
+ */
+quint32 MeterSettler::settleTime(const MultimeterService::Mode mode) const
+{
+    Q_D(const MeterSettler);
+    return d->settleTimes.value(mode, d->defaultSettleTime);
+}
+
+/*!
+ * Sets the settle time, in milliseconds, for \a mode, to \a settleTime. For example, resistance and capacitance
+ * readings typically take longer to settle than voltage readings. A \a settleTime of 0 disables settling for \a mode.
+ */
+void MeterSettler::setSettleTime(const MultimeterService::Mode mode, const quint32 settleTime)
+{
+    Q_D(MeterSettler);
+    d->settleTimes.insert(mode, settleTime);
+}
+
+/*!
+ * Returns \c true if the most recent reading was settled (or there have been no readings yet).
+ */
+bool MeterSettler::isSettled() const
+{
+    Q_D(const MeterSettler);
+    return d->settled;
+}
+
+/*!
+ * Returns the number of mode or range transitions seen since construction, or the last reset().
+ */
+quint64 MeterSettler::transitionCount() const
+{
+    Q_D(const MeterSettler);
+    return d->transitions;
+}
+
+/*!
+ * Returns the number of unsettled readings seen since construction, or the last reset().
+ */
+quint64 MeterSettler::unsettledCount() const
+{
+    Q_D(const MeterSettler);
+    return d->unsettled;
+}
+
+/*!
+ * Tracks \a reading, taken at \a timestamp milliseconds since the epoch, returning \c true (and emitting
+ * readingSettled) if the value had settled, otherwise returning \c false (and emitting readingUnsettled).
+ *
+ * Readings from service() are tracked automatically, with the time of their arrival. This slot allows readings from
+ * other sources to be tracked too, or for the caller to track readings synchronously.
+ */
+bool MeterSettler::addReading(const MultimeterService::Reading &reading, const qint64 timestamp)
+{
+    Q_D(MeterSettler);
+    return d->addReading(reading, timestamp);
+}
+
+/*!
+ * Forgets the most recent reading, such that the next reading will be considered settled, and resets the transition
+ * and unsettled counts.
+ */
+void MeterSettler::reset()
+{
+    Q_D(MeterSettler);
+    d->lastReading.reset();
+    d->transitionTimestamp = 0;
+    d->settled = true;
+    d->transitions = 0;
+    d->unsettled = 0;
+}
+
+/*!
+ * \fn MeterSettler::readingSettled
+ *
+ * This signal is emitted when \a reading, taken at \a timestamp, was taken after the value had settled.
+ */
+
+/*!
+ * \fn MeterSettler::readingUnsettled
+ *
+ * This signal is emitted when \a reading, taken at \a timestamp, was taken before the value had settled following a
+ * mode or range transition.
+ */
+
+/*!
+ * \cond internal
+ * \class MeterSettlerPrivate
+ *
+ * The MeterSettlerPrivate class provides private implementation for MeterSettler.
+ */
+
+/*!
+ * Constructs a new MeterSettlerPrivate object with public implementation \a q.
+ */
+MeterSettlerPrivate::MeterSettlerPrivate(MeterSettler * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Sets \a newService as the multimeter service to track readings from, disconnecting from any previous service.
+ */
+void MeterSettlerPrivate::setService(MultimeterService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &MultimeterService::readingRead, this, &MeterSettlerPrivate::readingRead);
+    }
+}
+
+/*!
+ * Tracks \a reading, taken at \a timestamp, noting any transition from #lastReading, then emits it as either settled
+ * or unsettled. Returns \c true if settled.
+ */
+bool MeterSettlerPrivate::addReading(const MultimeterService::Reading &reading, const qint64 timestamp)
+{
+    Q_Q(MeterSettler);
+    if ((lastReading) && ((reading.mode != lastReading->mode) || (reading.range != lastReading->range))) {
+        // A new transition, possibly before the previous one settled, so (re)start the settle time.
+        transitionTimestamp = timestamp;
+        settled = false;
+        ++transitions;
+    }
+    lastReading = reading;
+
+    if ((!settled) && (timestamp - transitionTimestamp >= q->settleTime(reading.mode))) {
+        settled = true;
+    }
+    if (!settled) {
+        ++unsettled;
+        Q_EMIT q->readingUnsettled(reading, timestamp);
+        return false;
+    }
+    Q_EMIT q->readingSettled(reading, timestamp);
+    return true;
+}
+
+/*!
+ * Tracks \a reading, as read from #service just now.
+ */
+void MeterSettlerPrivate::readingRead(const MultimeterService::Reading &reading)
+{
+    addReading(reading, QDateTime::currentMSecsSinceEpoch());
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the MeterSettlerPrivate class.
+ */
+
+#ifndef QTPOKIT_METERSETTLER_P_H
+#define QTPOKIT_METERSETTLER_P_H
+
+#include <qtpokit/metersettler.h>
+
+#include <QMap>
+#include <QObject>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT MeterSettlerPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    MultimeterService * service { nullptr }; ///< Multimeter service to settle readings from.
+    quint32 defaultSettleTime { 500 };        ///< Settle time, in milliseconds, for modes not in #settleTimes.
+    QMap<MultimeterService::Mode, quint32> settleTimes; ///< Per-mode settle times, in milliseconds.
+
+    std::optional<MultimeterService::Reading> lastReading; ///< Most recent reading, if any.
+    qint64 transitionTimestamp { 0 }; ///< Timestamp of the most recent mode or range transition.
+    bool settled { true };            ///< Whether the value has settled since the most recent transition.
+    quint64 transitions { 0 };        ///< Number of mode or range transitions seen.
+    quint64 unsettled { 0 };          ///< Number of readings taken before the value settled.
+
+    explicit MeterSettlerPrivate(MeterSettler * const q);
+
+    void setService(MultimeterService * const newService);
+
+    bool addReading(const MultimeterService::Reading &reading, const qint64 timestamp);
+
+public Q_SLOTS:
+    void readingRead(const MultimeterService::Reading &reading);
+
+protected:
+    MeterSettler * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(MeterSettler)
+    Q_DISABLE_COPY(MeterSettlerPrivate)
+    QTPOKIT_BEFRIEND_TEST(MeterSettler)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_METERSETTLER_P_H
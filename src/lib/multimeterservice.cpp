@@ -7,13 +7,14 @@
  */
 
 #include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokittrace.h>
+#include <pokitcodec/pokitcodec.h>
+#include "characteristiclayout_p.h"
 #include "multimeterservice_p.h"
 #include "pokitproducts_p.h"
 #include "../stringliterals_p.h"
 
-#include <QDataStream>
-#include <QIODevice>
-#include <QtEndian>
+#include <utility>
 
 QTPOKIT_BEGIN_NAMESPACE
 DOKIT_USE_STRINGLITERALS
@@ -166,16 +167,18 @@ bool MultimeterService::readReadingCharacteristic()
 /*!
  * Configures the Pokit device's multimeter mode.
  *
+ * If an earlier settings write is still queued (that is, not yet sent to the device), then it is replaced by this one,
+ * so only the newest \a settings are written. And if the device supports it, the settings are written without
+ * response, for faster reconfiguration.
+ *
  * Returns `true` if the write request was successfully queued, `false` otherwise.
  *
  * Emits settingsWritten() if/when the \a settings have been written successfully.
  */
 bool MultimeterService::setSettings(const Settings &settings)
 {
-    Q_D(const MultimeterService);
-    const QLowEnergyCharacteristic characteristic =
-        d->getCharacteristic(CharacteristicUuids::settings);
-    if (!characteristic.isValid()) {
+    Q_D(MultimeterService);
+    if (!d->hasCharacteristic(CharacteristicUuids::settings)) {
         return false;
     }
 
@@ -184,16 +187,29 @@ bool MultimeterService::setSettings(const Settings &settings)
         return false;
     }
 
-    d->service->writeCharacteristic(characteristic, value);
-    return (d->service->error() != QLowEnergyService::ServiceError::CharacteristicWriteError);
+    return d->writeCharacteristic(CharacteristicUuids::settings, value);
+}
+
+/*!
+ * Asynchronous variant of setSettings().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the settings write. The future's result is
+ * \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> MultimeterService::setSettingsAsync(const Settings &settings)
+{
+    Q_D(MultimeterService);
+    return d->whenFinished([this, settings]{ return setSettings(settings); });
 }
 
 /*!
  * Returns the most recent value of the `Multimeter` service's `Reading` characteristic.
  *
- * The returned value, if any, is from the underlying Bluetooth stack's cache. If no such value is
- * currently available (ie the serviceDetailsDiscovered signal has not been emitted yet), then the
- * returned MultimeterService::Reading::value member will be a quiet NaN, which can be checked like:
+ * The returned value is the most recently read, or notified, reading, as held in a lock-free LatestValue cell. So
+ * this function may be called from any thread, at any rate, without locking, re-parsing, or touching the underlying
+ * Bluetooth stack's objects. If no such value is available yet (ie the `Reading` characteristic has not been read, or
+ * notified, yet), then the returned MultimeterService::Reading::value member will be a quiet NaN, which can be checked
+ * like:
  *
  * ```
  * const MultimeterService::Reading reading = multimeterService->reading();
@@ -205,10 +221,7 @@ bool MultimeterService::setSettings(const Settings &settings)
 MultimeterService::Reading MultimeterService::reading() const
 {
     Q_D(const MultimeterService);
-    const QLowEnergyCharacteristic characteristic =
-        d->getCharacteristic(CharacteristicUuids::reading);
-    return (characteristic.isValid()) ? MultimeterServicePrivate::parseReading(characteristic.value())
-        : Reading{ MeterStatus::Error, std::numeric_limits<float>::quiet_NaN(), Mode::Idle, 0 };
+    return d->latestReading.load();
 }
 
 /*!
@@ -226,6 +239,18 @@ bool MultimeterService::enableReadingNotifications()
     return d->enableCharacteristicNotificatons(CharacteristicUuids::reading);
 }
 
+/*!
+ * Asynchronous variant of enableReadingNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> MultimeterService::enableReadingNotificationsAsync()
+{
+    Q_D(MultimeterService);
+    return d->whenFinished([this]{ return enableReadingNotifications(); });
+}
+
 /*!
  * Disables client-side notifications of meter readings.
  *
@@ -239,6 +264,106 @@ bool MultimeterService::disableReadingNotifications()
     return d->disableCharacteristicNotificatons(CharacteristicUuids::reading);
 }
 
+/*!
+ * Asynchronous variant of disableReadingNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> MultimeterService::disableReadingNotificationsAsync()
+{
+    Q_D(MultimeterService);
+    return d->whenFinished([this]{ return disableReadingNotifications(); });
+}
+
+/*!
+ * Returns the buffer that parsed `Reading` values are pushed into, if any.
+ *
+ * \see setReadingsBuffer
+ */
+RingBuffer<MultimeterService::Reading> * MultimeterService::readingsBuffer() const
+{
+    Q_D(const MultimeterService);
+    return d->readingsBuffer;
+}
+
+/*!
+ * Sets the \a buffer that parsed `Reading` values will be pushed into, as well as being emitted via readingRead().
+ *
+ * This allows a consumer on another thread to drain the readings, without a slow consumer stalling the thread that
+ * handles this service's BLE events. This object does not take ownership of \a buffer, which must remain valid until
+ * replaced (or cleared, via \c nullptr). Only this service (on its controller's thread) may push into \a buffer.
+ *
+ * \see readingsBuffer
+ * \see RingBuffer
+ */
+void MultimeterService::setReadingsBuffer(RingBuffer<Reading> * const buffer)
+{
+    Q_D(MultimeterService);
+    d->readingsBuffer = buffer;
+}
+
+/*!
+ * Begins recording the next \a count readings to memory, with the time each was received, to be emitted together via
+ * burstCompleted() once all \a count have been recorded. Returns \c true if the burst was started, or \c false if
+ * \a count is not positive.
+ *
+ * Storage for all \a count readings is allocated up front, and while the burst is in progress, each reading is just
+ * parsed and appended to that storage; it is not emitted via readingRead() (or readingsBatchRead()), nor pushed into
+ * the readingsBuffer(), so that nothing but the recording itself happens between consecutive notifications. This gives
+ * the most accurate (ie least jittered) timestamps, for analysing the readings as a block, such as a settling curve.
+ *
+ * Any burst already in progress is discarded. Note, this only records readings; reading notifications must still be
+ * enabled (see enableReadingNotifications()), after setting the desired update interval (see setSettings()).
+ *
+ * \see cancelBurst
+ * \see isBursting
+ */
+bool MultimeterService::startBurst(const int count)
+{
+    Q_D(MultimeterService);
+    if (count <= 0) {
+        return false;
+    }
+    d->burst.clear();
+    d->burst.reserve(count);
+    d->burstSize = count;
+    return true;
+}
+
+/*!
+ * Stops the burst in progress (if any), returning the readings it had recorded so far, without emitting
+ * burstCompleted().
+ *
+ * \see startBurst
+ */
+QVector<MultimeterService::TimedReading> MultimeterService::cancelBurst()
+{
+    Q_D(MultimeterService);
+    d->burstSize = 0;
+    return std::exchange(d->burst, QVector<TimedReading>{});
+}
+
+/*!
+ * Returns \c true if a burst is in progress, otherwise \c false.
+ *
+ * \see startBurst
+ */
+bool MultimeterService::isBursting() const
+{
+    Q_D(const MultimeterService);
+    return d->burstSize > 0;
+}
+
+/*!
+ * \fn MultimeterService::burstCompleted
+ *
+ * This signal is emitted when the burst started by startBurst() has recorded all of its \a readings, in the order they
+ * were read (or notified).
+ *
+ * \see startBurst
+ */
+
 /*!
  * \fn MultimeterService::readingRead
  *
@@ -247,6 +372,16 @@ bool MultimeterService::disableReadingNotifications()
  * \see readReadingCharacteristic
  */
 
+/*!
+ * \fn MultimeterService::readingsBatchRead
+ *
+ * This signal is emitted, if batching is enabled (see setBatching()), with one or more consecutive \a readings, in the
+ * order they were read (or notified), each as also emitted via readingRead.
+ *
+ * \see readingRead
+ * \see setBatching
+ */
+
 /*!
  * \fn MultimeterService::settingsWritten
  *
@@ -265,12 +400,19 @@ bool MultimeterService::disableReadingNotifications()
 /*!
  * \internal
  * Constructs a new MultimeterServicePrivate object with public implementation \a q.
+ *
+ * The `Settings` characteristic is resumable, so after a reconnection the multimeter resumes the same mode and range.
+ * It is also coalesced, so that rapid reconfiguration (such as a user dragging a range, or interval, control) only
+ * writes the newest settings once the link is free, rather than queueing every intermediate write.
  */
 MultimeterServicePrivate::MultimeterServicePrivate(
     QLowEnergyController * controller, MultimeterService * const q)
     : AbstractPokitServicePrivate(MultimeterService::serviceUuid, controller, q)
 {
-
+    setNotificationHandler(MultimeterService::CharacteristicUuids::reading,
+        [this](const QByteArray &value){ emitReading(value); });
+    resumableCharacteristics.insert(MultimeterService::CharacteristicUuids::settings);
+    coalescedCharacteristics.insert(MultimeterService::CharacteristicUuids::settings);
 }
 
 /*!
@@ -278,18 +420,11 @@ MultimeterServicePrivate::MultimeterServicePrivate(
  */
 QByteArray MultimeterServicePrivate::encodeSettings(const MultimeterService::Settings &settings)
 {
-    static_assert(sizeof(settings.mode)           == 1, "Expected to be 1 byte.");
-    static_assert(sizeof(settings.range)          == 1, "Expected to be 1 byte.");
-    static_assert(sizeof(settings.updateInterval) == 4, "Expected to be 4 bytes.");
-
-    QByteArray value;
-    QDataStream stream(&value, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::LittleEndian);
-    stream.setFloatingPointPrecision(QDataStream::SinglePrecision); // 32-bit floats, not 64-bit.
-    stream << (quint8)settings.mode << settings.range << settings.updateInterval;
-
-    Q_ASSERT(value.size() == 6);
-    return value;
+    std::array<std::byte, PokitCodec::Multimeter::settingsSize> value{};
+    PokitCodec::Multimeter::encodeSettings({
+        static_cast<quint8>(settings.mode), settings.range, settings.updateInterval
+    }, value);
+    return CharacteristicLayout::toByteArray(value.data(), value.size());
 }
 
 /*!
@@ -297,23 +432,87 @@ QByteArray MultimeterServicePrivate::encodeSettings(const MultimeterService::Set
  */
 MultimeterService::Reading MultimeterServicePrivate::parseReading(const QByteArray &value)
 {
+    QTPOKIT_TRACE_ZONE(Parse, "multimeterReading");
     MultimeterService::Reading reading{
         MultimeterService::MeterStatus::Error,
         std::numeric_limits<float>::quiet_NaN(),
         MultimeterService::Mode::Idle, 0
     };
 
-    if (!checkSize(u"Reading"_s, value, 7, 7)) {
+    constexpr int size = PokitCodec::Multimeter::readingSize;
+    PokitCodec::Multimeter::Reading decoded{};
+    if ((!checkSize(u"Reading"_s, value, size, size)) ||
+        (!PokitCodec::Multimeter::parseReading(CharacteristicLayout::toByteSpan(value), decoded))) {
         return reading;
     }
 
-    reading.status = MultimeterService::MeterStatus(value.at(0));
-    reading.value  = qFromLittleEndian<float>(value.mid(1,4).constData());
-    reading.mode   = static_cast<MultimeterService::Mode>(value.at(5));
-    reading.range  = static_cast<quint8>(value.at(6));
+    reading.status = static_cast<MultimeterService::MeterStatus>(decoded.status);
+    reading.value  = decoded.value;
+    reading.mode   = static_cast<MultimeterService::Mode>(decoded.mode);
+    reading.range  = decoded.range;
     return reading;
 }
 
+/*!
+ * Parses the `Reading` \a value, stores it as the latestReading, pushes it into the readingsBuffer (if any), then
+ * emits readingRead, and counts its latencies (see countLatency()). If batching, the reading is also added to the
+ * batch in progress, which is emitted via readingsBatchRead once full. If a burst is in progress, the reading is only
+ * recorded, via recordBurst(), instead.
+ */
+void MultimeterServicePrivate::emitReading(const QByteArray &value)
+{
+    Q_Q(MultimeterService);
+    const MultimeterService::Reading reading = parseReading(value);
+    QTPOKIT_TRACE_POINT(Parse, "multimeterReading", 1);
+    if (burstSize > 0) {
+        recordBurst(reading);
+        return;
+    }
+    const qint64 parsedAt = steadyTimestamp();
+    latestReading.store(reading);
+    if (readingsBuffer) {
+        readingsBuffer->push(reading);
+    }
+    {
+        QTPOKIT_TRACE_ZONE(Emit, "multimeterReading");
+        Q_EMIT q->readingRead(reading);
+    }
+    QTPOKIT_TRACE_POINT(Emit, "multimeterReading", 1);
+    countLatency(parsedAt);
+    if (isBatching()) {
+        readingsBatch.append(reading);
+        batchAppended(readingsBatch.size());
+    }
+}
+
+/*!
+ * Stores \a reading as the latestReading, and appends it, with its receive time, to the burst in progress, emitting
+ * the burst via MultimeterService::burstCompleted once complete.
+ */
+void MultimeterServicePrivate::recordBurst(const MultimeterService::Reading &reading)
+{
+    Q_Q(MultimeterService);
+    latestReading.store(reading);
+    burst.append({ (receiveTimestamp < 0) ? steadyTimestamp() : receiveTimestamp, reading });
+    if (burst.size() >= burstSize) {
+        burstSize = 0;
+        QTPOKIT_TRACE_POINT(Emit, "multimeterBurst", burst.size());
+        Q_EMIT q->burstCompleted(std::exchange(burst, QVector<MultimeterService::TimedReading>{}));
+    }
+}
+
+/*!
+ * Implements AbstractPokitServicePrivate::emitBatch to emit, then clear, the readingsBatch, if not empty.
+ */
+void MultimeterServicePrivate::emitBatch()
+{
+    Q_Q(MultimeterService);
+    if (!readingsBatch.isEmpty()) {
+        Q_EMIT q->readingsBatchRead(readingsBatch);
+        readingsBatch.clear();
+    }
+}
+
 /*!
  * Implements AbstractPokitServicePrivate::characteristicRead to parse \a value, then emit a
  * specialised signal, for each supported \a characteristic.
@@ -323,9 +522,8 @@ void MultimeterServicePrivate::characteristicRead(const QLowEnergyCharacteristic
 {
     AbstractPokitServicePrivate::characteristicRead(characteristic, value);
 
-    Q_Q(MultimeterService);
     if (characteristic.uuid() == MultimeterService::CharacteristicUuids::reading) {
-        Q_EMIT q->readingRead(parseReading(value));
+        emitReading(value);
         return;
     }
 
@@ -373,7 +571,6 @@ void MultimeterServicePrivate::characteristicChanged(const QLowEnergyCharacteris
 {
     AbstractPokitServicePrivate::characteristicChanged(characteristic, newValue);
 
-    Q_Q(MultimeterService);
     if (characteristic.uuid() == MultimeterService::CharacteristicUuids::settings) {
         qCWarning(lc).noquote() << tr("Settings characteristic is write-only, but somehow updated")
             << serviceUuid << characteristic.name() << characteristic.uuid();
@@ -381,7 +578,7 @@ void MultimeterServicePrivate::characteristicChanged(const QLowEnergyCharacteris
     }
 
     if (characteristic.uuid() == MultimeterService::CharacteristicUuids::reading) {
-        Q_EMIT q->readingRead(parseReading(newValue));
+        emitReading(newValue);
         return;
     }
 
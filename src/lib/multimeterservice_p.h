@@ -9,6 +9,7 @@
 #ifndef QTPOKIT_MULTIMETERSERVICE_P_H
 #define QTPOKIT_MULTIMETERSERVICE_P_H
 
+#include <qtpokit/latestvalue.h>
 #include <qtpokit/multimeterservice.h>
 
 #include "abstractpokitservice_p.h"
@@ -20,6 +21,14 @@ class QTPOKIT_EXPORT MultimeterServicePrivate : public AbstractPokitServicePriva
     Q_OBJECT
 
 public:
+    RingBuffer<MultimeterService::Reading> * readingsBuffer { nullptr }; ///< Buffer to push readings into, if any.
+    QVector<MultimeterService::Reading> readingsBatch; ///< Readings not yet emitted via readingsBatchRead, if batching.
+    QVector<MultimeterService::TimedReading> burst; ///< Readings recorded so far by the burst in progress, if any.
+    int burstSize { 0 }; ///< Number of readings the burst in progress is to record, or 0 if not bursting.
+    LatestValue<MultimeterService::Reading> latestReading { MultimeterService::Reading{
+        MultimeterService::MeterStatus::Error, std::numeric_limits<float>::quiet_NaN(), MultimeterService::Mode::Idle, 0
+    } }; ///< Most recent reading, for reading() to load from any thread.
+
     explicit MultimeterServicePrivate(QLowEnergyController * controller, MultimeterService * const q);
 
     static QByteArray encodeSettings(const MultimeterService::Settings &settings);
@@ -27,6 +36,10 @@ public:
     static MultimeterService::Reading parseReading(const QByteArray &value);
 
 protected:
+    void emitReading(const QByteArray &value);
+    void recordBurst(const MultimeterService::Reading &reading);
+    void emitBatch() override;
+
     void characteristicRead(const QLowEnergyCharacteristic &characteristic,
                             const QByteArray &value) override;
     void characteristicWritten(const QLowEnergyCharacteristic &characteristic,
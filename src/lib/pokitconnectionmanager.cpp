@@ -0,0 +1,712 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the PokitConnectionManager and PokitConnectionManagerPrivate classes.
+ */
+
+#include <qtpokit/pokitconnectionmanager.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitdeviceregistry.h>
+#include "pokitconnectionmanager_p.h"
+#include "../stringliterals_p.h"
+
+#include <QBluetoothLocalDevice>
+#include <QLowEnergyController>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class PokitConnectionManager
+ *
+ * The PokitConnectionManager class shares a limited number of BLE connections, per local adapter, between requests
+ * for (potentially many more) Pokit devices, so that a single host can service far more devices than its Bluetooth
+ * controllers can hold connections to at once.
+ *
+ * Each request() returns a ticket. Once the requested device is connected, and its services discovered, the device
+ * is leased to that ticket, via granted. The requester then uses the device (such as to poll its status, or fetch its
+ * data logger samples), and release()s the ticket once done. Requests beyond the connection limit of their adapter
+ * (see setMaxConnections()) are queued, and then granted fairly: whenever a connection is free, the next request is
+ * the one for the device that was least recently granted, so a device that is requested repeatedly cannot starve the
+ * others. Requests for the same device are granted one at a time.
+ *
+ * Released devices are kept connected (warm) for idleTimeout() milliseconds, so that subsequent requests for the same
+ * device are granted immediately, without reconnecting. Idle connections are evicted early (least recently released
+ * first), whenever their connection is needed for a different device.
+ *
+ * Optionally, leases may be limited to leaseTimeout() milliseconds while other requests are waiting. Overdue leases
+ * are reported via leaseExpired, and then released, so that short jobs are time-sliced across all requested devices,
+ * even if some requesters are slow to release.
+ *
+ * Requesters that know when they will next need a device (such as scheduled jobs) may prewarm() its connection
+ * shortly beforehand, using a free connection, so that the later request is granted immediately, without waiting
+ * for the device to connect, and its services to be discovered.
+ *
+ * Hosts with more than one Bluetooth adapter may spread connections across them, either explicitly per request(), or
+ * automatically, by load and RSSI, via setAdapters().
+ *
+ * If a device fails to connect, or disconnects while leased, then its ticket is reported via failed, and is no longer
+ * valid.
+ */
+
+/*!
+ * Constructs a new Pokit connection manager with \a parent.
+ */
+PokitConnectionManager::PokitConnectionManager(QObject * parent)
+    : QObject(parent), d_ptr(new PokitConnectionManagerPrivate(this))
+{
+
+}
+
+/*!
+ * \cond internal
+ * Constructs a new Pokit connection manager with \a parent, and private implementation \a d.
+ */
+PokitConnectionManager::PokitConnectionManager(PokitConnectionManagerPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this PokitConnectionManager object, disconnecting all pooled devices.
+ */
+PokitConnectionManager::~PokitConnectionManager()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the maximum number of concurrent connections per local adapter, for adapters without their own limit.
+ */
+int PokitConnectionManager::maxConnections() const
+{
+    Q_D(const PokitConnectionManager);
+    return d->defaultLimit;
+}
+
+/*!
+ * Sets the maximum number of concurrent connections per local adapter, for adapters without their own limit, to \a
+ * connections. Values less than 1 are treated as 1. The default is 3, which is conservative enough for most
+ * controllers.
+ *
+ * Lowering the limit does not disconnect leased devices, but no new connections will be made until enough have been
+ * released.
+ */
+void PokitConnectionManager::setMaxConnections(const int connections)
+{
+    Q_D(PokitConnectionManager);
+    d->defaultLimit = qMax(connections, 1);
+    d->schedule();
+}
+
+/*!
+ * Returns the maximum number of concurrent connections via the local \a adapter.
+ */
+int PokitConnectionManager::maxConnections(const QBluetoothAddress &adapter) const
+{
+    Q_D(const PokitConnectionManager);
+    return d->limit(adapter);
+}
+
+/*!
+ * Sets the maximum number of concurrent connections via the local \a adapter (or the default adapter, if \a adapter
+ * is null) to \a connections. A \a connections value of 0 (or less) removes the adapter's own limit, such that the
+ * default maxConnections() applies again.
+ */
+void PokitConnectionManager::setMaxConnections(const QBluetoothAddress &adapter, const int connections)
+{
+    Q_D(PokitConnectionManager);
+    if (connections <= 0) {
+        d->adapterLimits.remove(adapter.toUInt64());
+    } else {
+        d->adapterLimits.insert(adapter.toUInt64(), connections);
+    }
+    d->schedule();
+}
+
+/*!
+ * Returns the local adapters that connections are automatically spread across, or an empty list if automatic adapter
+ * selection is disabled.
+ */
+QList<QBluetoothAddress> PokitConnectionManager::adapters() const
+{
+    Q_D(const PokitConnectionManager);
+    return d->adapters;
+}
+
+/*!
+ * Sets the local \a adapters that connections are automatically spread across, for requests that do not specify an
+ * adapter of their own. An empty list (the default) disables automatic adapter selection, such that those requests use
+ * the default adapter. localAdapters() returns all of the host's adapters, for convenience.
+ *
+ * Requests are assigned an adapter as they are scheduled: the adapter with a free connection that has the strongest
+ * signal from the device (as reported via updateRssi()), unless that adapter is substantially busier than the others,
+ * such that connections are spread across adapters by both load and RSSI. Devices whose RSSI has not been reported
+ * for any adapter are simply spread by load.
+ *
+ * \note Choosing an adapter requires Qt 5.14 or later. Earlier versions always use the default adapter.
+ */
+void PokitConnectionManager::setAdapters(const QList<QBluetoothAddress> &adapters)
+{
+    Q_D(PokitConnectionManager);
+    d->adapters = adapters;
+    d->schedule();
+}
+
+/*!
+ * Returns the addresses of all of the host's local Bluetooth adapters.
+ */
+QList<QBluetoothAddress> PokitConnectionManager::localAdapters()
+{
+    QList<QBluetoothAddress> adapters;
+    const QList<QBluetoothHostInfo> hosts = QBluetoothLocalDevice::allDevices();
+    for (const QBluetoothHostInfo &host: hosts) {
+        adapters.append(host.address());
+    }
+    return adapters;
+}
+
+/*!
+ * Returns the number of milliseconds released devices are kept connected for, in case they are requested again.
+ */
+quint32 PokitConnectionManager::idleTimeout() const
+{
+    Q_D(const PokitConnectionManager);
+    return d->idleTimeout;
+}
+
+/*!
+ * Sets the number of milliseconds released devices are kept connected for to \a timeout. A \a timeout of 0 disconnects
+ * devices as soon as they are released. The default is 30 seconds.
+ */
+void PokitConnectionManager::setIdleTimeout(const quint32 timeout)
+{
+    Q_D(PokitConnectionManager);
+    d->idleTimeout = timeout;
+}
+
+/*!
+ * Returns the maximum number of milliseconds a lease may be held while other requests are waiting, or 0 if leases are
+ * not limited.
+ */
+quint32 PokitConnectionManager::leaseTimeout() const
+{
+    Q_D(const PokitConnectionManager);
+    return d->leaseTimeout;
+}
+
+/*!
+ * Sets the maximum number of milliseconds a lease may be held while other requests are waiting to \a timeout. Leases
+ * held for longer are reported via leaseExpired, and then released. A \a timeout of 0 (the default) means leases are
+ * never expired.
+ *
+ * Lease timeouts are checked about once a second, so short timeouts are only approximate.
+ */
+void PokitConnectionManager::setLeaseTimeout(const quint32 timeout)
+{
+    Q_D(PokitConnectionManager);
+    d->leaseTimeout = timeout;
+}
+
+/*!
+ * Requests a connection to the Pokit device described by \a info, via the local \a adapter, and returns the request's
+ * ticket. If \a adapter is null, then the adapter is chosen automatically from adapters() (see setAdapters()), or is
+ * the default adapter if adapters() is empty.
+ *
+ * Once the device is leased to the ticket, granted is emitted, either immediately (if the device is already connected,
+ * and idle), or once a connection has been made. The ticket should then be release()d once the device is no longer
+ * needed. Release the ticket before it is granted to cancel the request.
+ *
+ * \note Choosing an \a adapter requires Qt 5.14 or later. Earlier versions always use the default adapter.
+ */
+quint32 PokitConnectionManager::request(const QBluetoothDeviceInfo &info, const QBluetoothAddress &adapter)
+{
+    Q_D(PokitConnectionManager);
+    if (d->nextTicket == 0) {
+        ++d->nextTicket; // Ticket 0 is reserved for "no ticket".
+    }
+    const quint32 ticket = d->nextTicket++;
+    d->pending.append({ ticket, PokitDeviceRegistry::key(info), info, adapter });
+    qCDebug(d->lc).noquote() << tr(R"(Connection to "%1" requested, with ticket %2.)").arg(info.name()).arg(ticket);
+    d->schedule();
+    return ticket;
+}
+
+/*!
+ * Releases the device leased to \a ticket (keeping it connected for idleTimeout() milliseconds), or cancels the
+ * request for \a ticket if not yet granted. Returns \c false if \a ticket is not valid, \c true otherwise.
+ */
+bool PokitConnectionManager::release(const quint32 ticket)
+{
+    Q_D(PokitConnectionManager);
+    const auto iter = std::find_if(d->pending.begin(), d->pending.end(),
+        [ticket](const PokitConnectionManagerPrivate::Request &request) { return request.ticket == ticket; });
+    if (iter != d->pending.end()) {
+        qCDebug(d->lc).noquote() << tr("Cancelled pending request %1.").arg(ticket);
+        d->pending.erase(iter);
+        return true;
+    }
+
+    const QString key = d->findTicket(ticket);
+    if (key.isNull()) {
+        return false;
+    }
+    PokitConnectionManagerPrivate::Connection &connection = d->connections[key];
+    if ((!connection.ready) || (d->idleTimeout == 0)) {
+        qCDebug(d->lc).noquote() << tr("Released ticket %1; disconnecting %2.").arg(ticket).arg(key);
+        d->removeConnection(key); // Cancels the connection attempt, if not yet ready.
+    } else {
+        qCDebug(d->lc).noquote() << tr("Released ticket %1; keeping %2 connected.").arg(ticket).arg(key);
+        connection.ticket = 0;
+        connection.idleSince = d->clock.elapsed();
+    }
+    d->schedule();
+    return true;
+}
+
+/*!
+ * Disconnects the device described by \a info, if connected but idle (ie released, and being kept connected for
+ * reuse), so that it is free to be connected to elsewhere, such as by another host. Returns \c true if the device
+ * was disconnected, \c false otherwise, including if the device is still leased (or being connected).
+ */
+bool PokitConnectionManager::disconnectIdle(const QBluetoothDeviceInfo &info)
+{
+    Q_D(PokitConnectionManager);
+    const QString key = PokitDeviceRegistry::key(info);
+    const auto iter = d->connections.constFind(key);
+    if ((iter == d->connections.constEnd()) || (iter->ticket != 0)) {
+        return false;
+    }
+    qCDebug(d->lc).noquote() << tr("Disconnecting idle %1, on request.").arg(key);
+    d->removeConnection(key);
+    d->schedule();
+    return true;
+}
+
+/*!
+ * Connects to the Pokit device described by \a info (and discovers its services), via the local \a adapter, without
+ * leasing it to any request, so that a request() made shortly afterwards is granted without the usual connection
+ * and discovery latency. Once connected, the device is kept warm for idleTimeout() milliseconds, just like a released
+ * device, so the request should follow within that time. Requests made while the device is still being connected
+ * are granted as soon as it is ready. If \a adapter is null, then the adapter is chosen as per request().
+ *
+ * Pre-warming only ever uses a free connection: it never evicts idle devices, nor delays pending requests. Returns
+ * \c true if the device is being connected, or is already connected (in which case an idle device's idle time is
+ * restarted), otherwise \c false, such as when the adapter has no free connection.
+ */
+bool PokitConnectionManager::prewarm(const QBluetoothDeviceInfo &info, const QBluetoothAddress &adapter)
+{
+    Q_D(PokitConnectionManager);
+    const QString key = PokitDeviceRegistry::key(info);
+    if (const auto iter = d->connections.find(key); iter != d->connections.end()) {
+        if ((iter->ticket == 0) && (iter->ready)) {
+            iter->idleSince = d->clock.elapsed(); // Keep the idle connection warm for a while longer.
+        }
+        return true;
+    }
+
+    PokitConnectionManagerPrivate::Request request{ 0, key, info, adapter };
+    if ((request.adapter.isNull()) && (!d->adapters.isEmpty())) {
+        request.adapter = d->chooseAdapter(key);
+    }
+    if (d->connectionCount(request.adapter) >= d->limit(request.adapter)) {
+        qCDebug(d->lc).noquote() << tr("Not pre-warming %1, since no connection is free.").arg(key);
+        return false;
+    }
+    qCDebug(d->lc).noquote() << tr("Pre-warming %1.").arg(key);
+    d->connections.insert(key, PokitConnectionManagerPrivate::Connection{ nullptr, request.adapter });
+    d->connectDevice(request);
+    return true;
+}
+
+/*!
+ * Returns the device currently leased to \a ticket, or \c nullptr if \a ticket has not been granted (or is not
+ * valid).
+ */
+PokitDevice * PokitConnectionManager::device(const quint32 ticket) const
+{
+    Q_D(const PokitConnectionManager);
+    const QString key = d->findTicket(ticket);
+    if (key.isNull()) {
+        return nullptr;
+    }
+    const PokitConnectionManagerPrivate::Connection &connection = d->connections[key];
+    return (connection.ready) ? connection.device : nullptr;
+}
+
+/*!
+ * Returns the number of pooled connections (leased, idle, or being connected) via the local \a adapter (or the
+ * default adapter, if \a adapter is null).
+ */
+int PokitConnectionManager::connectionCount(const QBluetoothAddress &adapter) const
+{
+    Q_D(const PokitConnectionManager);
+    return d->connectionCount(adapter);
+}
+
+/*!
+ * Returns the number of requests waiting for a device, or a free connection.
+ */
+int PokitConnectionManager::pendingCount() const
+{
+    Q_D(const PokitConnectionManager);
+    return (int)d->pending.size();
+}
+
+/*!
+ * Records the RSSI of the device described by \a info, as heard via the local \a adapter, for automatic adapter
+ * selection (see setAdapters()). Devices with no RSSI (ie 0) are ignored.
+ *
+ * This is typically connected to the PokitDiscoveryAgent::pokitDeviceDiscovered and
+ * PokitDiscoveryAgent::pokitDeviceUpdated signals of one discovery agent per adapter (see
+ * PokitDiscoveryAgent::adapterAddress()).
+ */
+void PokitConnectionManager::updateRssi(const QBluetoothDeviceInfo &info, const QBluetoothAddress &adapter)
+{
+    Q_D(PokitConnectionManager);
+    if (info.rssi() != 0) {
+        d->rssi[PokitDeviceRegistry::key(info)].insert(adapter.toUInt64(), info.rssi());
+    }
+}
+
+/*!
+ * \fn PokitConnectionManager::granted
+ *
+ * This signal is emitted when \a device has been leased to \a ticket. The device is connected, and its services
+ * discovered, so its services may be used straight away.
+ */
+
+/*!
+ * \fn PokitConnectionManager::failed
+ *
+ * This signal is emitted when the device requested for \a ticket could not be connected to, or disconnected while
+ * leased. The \a ticket is no longer valid, so need not be released.
+ */
+
+/*!
+ * \fn PokitConnectionManager::leaseExpired
+ *
+ * This signal is emitted when the lease for \a ticket has been held for longer than leaseTimeout(), while other
+ * requests were waiting. The lease is released immediately after this signal is emitted.
+ */
+
+/*!
+ * \cond internal
+ * \class PokitConnectionManagerPrivate
+ *
+ * The PokitConnectionManagerPrivate class provides private implementation for PokitConnectionManager.
+ */
+
+/*!
+ * Constructs a new PokitConnectionManagerPrivate object with public implementation \a q.
+ */
+PokitConnectionManagerPrivate::PokitConnectionManagerPrivate(PokitConnectionManager * const q) : q_ptr(q)
+{
+    clock.start();
+    connect(&housekeepingTimer, &QTimer::timeout, this, [this]() { housekeeping(clock.elapsed()); });
+}
+
+/*!
+ * Returns the connection limit for the local \a adapter.
+ */
+int PokitConnectionManagerPrivate::limit(const QBluetoothAddress &adapter) const
+{
+    return adapterLimits.value(adapter.toUInt64(), defaultLimit);
+}
+
+/*!
+ * Returns the number of pooled connections via the local \a adapter.
+ */
+int PokitConnectionManagerPrivate::connectionCount(const QBluetoothAddress &adapter) const
+{
+    return (int)std::count_if(connections.cbegin(), connections.cend(),
+        [&adapter](const Connection &connection) { return connection.adapter == adapter; });
+}
+
+/*!
+ * Returns the key of the pooled device leased (or being connected) for \a ticket, or a null string if none.
+ */
+QString PokitConnectionManagerPrivate::findTicket(const quint32 ticket) const
+{
+    if (ticket == 0) {
+        return QString();
+    }
+    for (auto iter = connections.cbegin(); iter != connections.cend(); ++iter) {
+        if (iter->ticket == ticket) {
+            return iter.key();
+        }
+    }
+    return QString();
+}
+
+/*!
+ * Returns the indexes of the #pending requests, in the order they should be considered for scheduling. That is, least
+ * recently granted devices first (never granted devices before all others), then in request order.
+ */
+QVector<int> PokitConnectionManagerPrivate::schedulingOrder() const
+{
+    QVector<int> order((qsizetype)pending.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](const int a, const int b) {
+        return lastGranted.value(pending.at(a).key, std::numeric_limits<qint64>::min()) <
+               lastGranted.value(pending.at(b).key, std::numeric_limits<qint64>::min());
+    });
+    return order;
+}
+
+/*!
+ * Returns the one of #adapters that the device identified by \a key should be connected via. That is, of the adapters
+ * with a free connection (or of all adapters, if none are free), the one with the lowest score, where each adapter
+ * scores the negated RSSI last reported (via updateRssi()) for the device via that adapter (or #unknownRssi), plus
+ * #loadPenalty scaled by the fraction of the adapter's connection limit already in use. So the device is connected via
+ * the adapter that hears it best, unless that adapter is substantially busier than the others.
+ */
+QBluetoothAddress PokitConnectionManagerPrivate::chooseAdapter(const QString &key) const
+{
+    const QHash<quint64, qint16> deviceRssi = rssi.value(key);
+    QBluetoothAddress best;
+    int bestScore = std::numeric_limits<int>::max();
+    bool bestIsFree = false;
+    for (const QBluetoothAddress &adapter: adapters) {
+        const int count = connectionCount(adapter), max = limit(adapter);
+        const bool isFree = (count < max);
+        const int score = ((count * loadPenalty) / max) - deviceRssi.value(adapter.toUInt64(), unknownRssi);
+        if (((isFree) && (!bestIsFree)) || ((isFree == bestIsFree) && (score < bestScore))) {
+            best = adapter;
+            bestScore = score;
+            bestIsFree = isFree;
+        }
+    }
+    return best;
+}
+
+/*!
+ * Grants, or begins connecting for, as many #pending requests as connection limits allow, in schedulingOrder().
+ */
+void PokitConnectionManagerPrivate::schedule()
+{
+    QVector<int> scheduled;
+    QVector<Request> toConnect;
+    QStringList toGrant;
+    const QVector<int> order = schedulingOrder();
+    for (const int index: order) {
+        const Request &request = pending.at(index);
+        const auto iter = connections.find(request.key);
+        if (iter != connections.end()) {
+            if (iter->ticket != 0) {
+                continue; // Already leased (or being connected) for another request.
+            }
+            iter->ticket = request.ticket;
+            if (iter->ready) {
+                toGrant.append(request.key); // Warm, and idle, so grant straight away.
+            } // Else being pre-warmed, so granted once discovery finishes.
+            scheduled.append(index);
+            continue;
+        }
+
+        Request assigned = request;
+        if ((assigned.adapter.isNull()) && (!adapters.isEmpty())) {
+            assigned.adapter = chooseAdapter(request.key);
+        }
+        if ((connectionCount(assigned.adapter) >= limit(assigned.adapter)) && (!evictIdle(assigned.adapter))) {
+            continue; // No free connection on this adapter (yet).
+        }
+        connections.insert(request.key, Connection{ nullptr, assigned.adapter, request.ticket });
+        toConnect.append(assigned);
+        scheduled.append(index);
+    }
+
+    // Remove the scheduled requests before connecting or granting, since signal receivers may make new requests.
+    std::sort(scheduled.begin(), scheduled.end(), std::greater<int>());
+    for (const int index: scheduled) {
+        pending.removeAt(index);
+    }
+    for (const Request &request: toConnect) {
+        connectDevice(request);
+    }
+    for (const QString &key: toGrant) {
+        grant(key);
+    }
+}
+
+/*!
+ * Records, and emits PokitConnectionManager::granted for, the lease of the device identified by \a key to its
+ * connection's ticket.
+ */
+void PokitConnectionManagerPrivate::grant(const QString &key)
+{
+    const auto iter = connections.find(key);
+    if ((iter == connections.end()) || (iter->ticket == 0)) {
+        return; // Released (or disconnected) already, such as by an earlier granted signal's receiver.
+    }
+    iter->leasedAt = clock.elapsed();
+    lastGranted.insert(key, iter->leasedAt);
+    qCDebug(lc).noquote() << tr("Granted %1 to ticket %2.").arg(key).arg(iter->ticket);
+    Q_Q(PokitConnectionManager);
+    Q_EMIT q->granted(iter->ticket, iter->device);
+}
+
+/*!
+ * Disconnects the least recently released idle device connected via \a adapter, if any, to free its connection.
+ * Returns \c true if a device was disconnected, \c false otherwise.
+ */
+bool PokitConnectionManagerPrivate::evictIdle(const QBluetoothAddress &adapter)
+{
+    auto oldest = connections.end();
+    for (auto iter = connections.begin(); iter != connections.end(); ++iter) {
+        if ((iter->adapter == adapter) && (iter->ticket == 0) && (iter->ready) &&
+            ((oldest == connections.end()) || (iter->idleSince < oldest->idleSince))) {
+            oldest = iter;
+        }
+    }
+    if (oldest == connections.end()) {
+        return false;
+    }
+    qCDebug(lc).noquote() << tr("Evicting idle connection to %1.").arg(oldest.key());
+    removeConnection(oldest.key());
+    return true;
+}
+
+/*!
+ * Creates a device for \a request (whose connection entry must already exist), and begins connecting to it.
+ */
+void PokitConnectionManagerPrivate::connectDevice(const Request &request)
+{
+    Q_Q(PokitConnectionManager);
+    PokitDevice * const device = new PokitDevice(request.info, request.adapter, q);
+    QLowEnergyController * const controller = device->controller();
+    connections[request.key].device = device;
+
+    const QString key = request.key;
+    const auto isCurrent = [this, key, device]() { return connections.value(key).device == device; };
+    connect(controller, &QLowEnergyController::connected, this, [controller]() {
+        if (controller->state() == QLowEnergyController::ConnectedState) {
+            controller->discoverServices(); // Unless a service has already begun discovery.
+        }
+    });
+    connect(controller, &QLowEnergyController::discoveryFinished, this, [this, key, isCurrent]() {
+        if (isCurrent()) discoveryFinished(key);
+    });
+    connect(controller, &QLowEnergyController::disconnected, this, [this, key, isCurrent]() {
+        if (isCurrent()) disconnected(key);
+    });
+    connect(controller,
+        #if (QT_VERSION < QT_VERSION_CHECK(6, 2, 0))
+        QOverload<QLowEnergyController::Error>::of(&QLowEnergyController::error),
+        #else
+        &QLowEnergyController::errorOccurred,
+        #endif
+        this, [this, key, isCurrent, controller](const QLowEnergyController::Error error) {
+            qCWarning(lc).noquote() << tr("Controller error for %1:").arg(key) << error;
+            if ((isCurrent()) && (controller->state() == QLowEnergyController::UnconnectedState)) {
+                disconnected(key); // Failed to connect, so no disconnected signal will follow.
+            }
+        }, Qt::QueuedConnection);
+
+    if (!housekeepingTimer.isActive()) {
+        housekeepingTimer.start(housekeepingInterval);
+    }
+    qCDebug(lc).noquote() << tr("Connecting to %1 (%2 of %3 connections).").arg(key)
+        .arg(connectionCount(request.adapter)).arg(limit(request.adapter));
+    controller->connectToDevice();
+}
+
+/*!
+ * Disconnects, and removes from the pool, the device identified by \a key.
+ */
+void PokitConnectionManagerPrivate::removeConnection(const QString &key)
+{
+    const Connection connection = connections.take(key);
+    if (connection.device) {
+        disconnect(connection.device->controller(), nullptr, this, nullptr);
+        if (connection.device->controller()->state() != QLowEnergyController::UnconnectedState) {
+            connection.device->disconnectFromDevice();
+        }
+        connection.device->deleteLater();
+    }
+    if (connections.isEmpty()) {
+        housekeepingTimer.stop();
+    }
+}
+
+/*!
+ * Disconnects idle devices released more than #idleTimeout milliseconds ago, and expires (then releases) leases held
+ * for more than #leaseTimeout milliseconds while other requests are waiting, as of #clock time \a now.
+ */
+void PokitConnectionManagerPrivate::housekeeping(const qint64 now)
+{
+    QStringList idle;
+    QVector<quint32> overdue;
+    for (auto iter = connections.cbegin(); iter != connections.cend(); ++iter) {
+        if (!iter->ready) {
+            continue;
+        }
+        if ((iter->ticket == 0) && (now - iter->idleSince >= idleTimeout)) {
+            idle.append(iter.key());
+        } else if ((iter->ticket != 0) && (leaseTimeout > 0) && (!pending.isEmpty()) &&
+                   (now - iter->leasedAt >= leaseTimeout)) {
+            overdue.append(iter->ticket);
+        }
+    }
+    for (const QString &key: idle) {
+        qCDebug(lc).noquote() << tr("Disconnecting idle %1.").arg(key);
+        removeConnection(key);
+    }
+
+    Q_Q(PokitConnectionManager);
+    for (const quint32 ticket: overdue) {
+        if (!findTicket(ticket).isNull()) {
+            qCDebug(lc).noquote() << tr("Lease for ticket %1 expired.").arg(ticket);
+            Q_EMIT q->leaseExpired(ticket);
+            q->release(ticket); // Returns false if the receiver has released it already.
+        }
+    }
+    schedule();
+}
+
+/*!
+ * Handles the completion of service discovery for the device identified by \a key, granting it to the ticket it was
+ * connected for, or else (if pre-warmed, and not yet requested) keeping it warm, as if just released.
+ */
+void PokitConnectionManagerPrivate::discoveryFinished(const QString &key)
+{
+    const auto iter = connections.find(key);
+    if ((iter == connections.end()) || (iter->ready)) {
+        return; // Removed already, or rediscovered by a service.
+    }
+    iter->ready = true;
+    if (iter->ticket == 0) {
+        qCDebug(lc).noquote() << tr("Pre-warmed %1.").arg(key);
+        iter->idleSince = clock.elapsed();
+        return;
+    }
+    grant(key);
+}
+
+/*!
+ * Handles the disconnection (or failed connection) of the device identified by \a key, emitting
+ * PokitConnectionManager::failed if it was leased, or being connected for, a request.
+ */
+void PokitConnectionManagerPrivate::disconnected(const QString &key)
+{
+    const quint32 ticket = connections.value(key).ticket;
+    qCDebug(lc).noquote() << tr("%1 disconnected.").arg(key);
+    removeConnection(key);
+    if (ticket != 0) {
+        Q_Q(PokitConnectionManager);
+        Q_EMIT q->failed(ticket);
+    }
+    schedule();
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitConnectionManagerPrivate class.
+ */
+
+#ifndef QTPOKIT_POKITCONNECTIONMANAGER_P_H
+#define QTPOKIT_POKITCONNECTIONMANAGER_P_H
+
+#include <qtpokit/pokitconnectionmanager.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT PokitConnectionManagerPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.ble.connections", QtInfoMsg); ///< Logging category.
+
+    static constexpr int housekeepingInterval { 1000 }; ///< Milliseconds between idle and lease timeout checks.
+    static constexpr int loadPenalty { 40 };            ///< Adapter score penalty, in dB, when fully loaded.
+    static constexpr qint16 unknownRssi { -100 };       ///< RSSI assumed for devices not (yet) heard via an adapter.
+
+    /// A pooled device, and its connection.
+    struct Connection {
+        PokitDevice * device { nullptr }; ///< Pooled device.
+        QBluetoothAddress adapter;        ///< Local adapter the device is connected via.
+        quint32 ticket { 0 };             ///< Request the device is leased (or being connected) for, or 0 if idle.
+        bool ready { false };             ///< Whether the device is connected, and its services discovered.
+        qint64 leasedAt { 0 };            ///< #clock time the current lease was granted.
+        qint64 idleSince { 0 };           ///< #clock time the device was last released.
+    };
+
+    /// A pending connection request.
+    struct Request {
+        quint32 ticket { 0 };         ///< Ticket, as returned by PokitConnectionManager::request().
+        QString key;                  ///< Device key, per PokitDeviceRegistry::key().
+        QBluetoothDeviceInfo info;    ///< Device to connect to.
+        QBluetoothAddress adapter;    ///< Local adapter to connect via.
+    };
+
+    QHash<QString, Connection> connections; ///< Pooled devices, by key.
+    QVector<Request> pending;               ///< Requests waiting for a device, or a free connection, in request order.
+    QHash<QString, qint64> lastGranted;     ///< #clock time each device was last granted, for fair scheduling.
+    QHash<quint64, int> adapterLimits;      ///< Per-adapter connection limits, by adapter address.
+    QList<QBluetoothAddress> adapters;      ///< Adapters to automatically spread connections across, if any.
+    QHash<QString, QHash<quint64, qint16>> rssi; ///< Last RSSI of each device, by key, via each adapter, by address.
+    int defaultLimit { 3 };                 ///< Connection limit for adapters without their own limit.
+    quint32 idleTimeout { 30000 };          ///< Milliseconds to keep released devices connected, for reuse.
+    quint32 leaseTimeout { 0 };             ///< Milliseconds a lease may be held while others wait, or 0 for no limit.
+    quint32 nextTicket { 1 };               ///< Ticket for the next request.
+    QElapsedTimer clock;                    ///< Monotonic clock, for lease and idle times.
+    QTimer housekeepingTimer;               ///< Periodically expires idle connections, and overdue leases.
+
+    explicit PokitConnectionManagerPrivate(PokitConnectionManager * const q);
+
+    int limit(const QBluetoothAddress &adapter) const;
+    int connectionCount(const QBluetoothAddress &adapter) const;
+    QString findTicket(const quint32 ticket) const;
+    QVector<int> schedulingOrder() const;
+    QBluetoothAddress chooseAdapter(const QString &key) const;
+    void schedule();
+    void grant(const QString &key);
+    bool evictIdle(const QBluetoothAddress &adapter);
+    void connectDevice(const Request &request);
+    void removeConnection(const QString &key);
+    void housekeeping(const qint64 now);
+
+public Q_SLOTS:
+    void discoveryFinished(const QString &key);
+    void disconnected(const QString &key);
+
+protected:
+    PokitConnectionManager * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(PokitConnectionManager)
+    Q_DISABLE_COPY(PokitConnectionManagerPrivate)
+    QTPOKIT_BEFRIEND_TEST(PokitConnectionManager)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POKITCONNECTIONMANAGER_P_H
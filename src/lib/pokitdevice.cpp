@@ -13,12 +13,18 @@
 #include <qtpokit/deviceinfoservice.h>
 #include <qtpokit/dsoservice.h>
 #include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokittrace.h>
 #include <qtpokit/statusservice.h>
 
 #include "pokitdevice_p.h"
+#include "pokitproducts_p.h"
 #include "../stringliterals_p.h"
 
 #include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QThread>
+#include <QTimer>
+#include <QtMath>
 
 QTPOKIT_BEGIN_NAMESPACE
 DOKIT_USE_STRINGLITERALS
@@ -30,11 +36,32 @@ DOKIT_USE_STRINGLITERALS
  *
  * It does this by wrapping QLowEnergyController to provide:
  * * convenient Pokit service factory methods (dataLogger(), deviceInformation(), dso(),
-     multimeter() and status()); and
+     multimeter() and status());
+ * * a device capabilities() profile, resolved once and shared by all of those services; and
  * * consistent debug logging of QLowEnergyController events.
  *
  * But this class is entirely optional, in that all features of all other QtPokit classes can be
  * used without this class.  It's just a (meaningful) convenience.
+ *
+ * The device, along with its controller (if created by this class) and all of its services, may be hosted on a
+ * dedicated BLE worker thread, via `QObject::moveToThread`, so that notifications are received and parsed without
+ * being delayed by (or delaying) the application's main thread, such as its GUI rendering. For example:
+ *
+ * ```
+ * auto thread = new QThread(this);
+ * auto device = new PokitDevice(deviceInfo); // No parent, since it will live on another thread.
+ * device->moveToThread(thread);
+ * connect(thread, &QThread::finished, device, &QObject::deleteLater);
+ * connect(device->multimeter(), &MultimeterService::readingRead, this, &MainWindow::showReading); // Queued.
+ * thread->start();
+ * QMetaObject::invokeMethod(device->controller(), &QLowEnergyController::connectToDevice);
+ * ```
+ *
+ * Parsed values then reach consumers on other threads via (automatically) queued connections, or via RingBuffer
+ * instances (see MultimeterService::setReadingsBuffer(), for example). The service accessors (such as multimeter()),
+ * prepareServices(), setConnectionProfile(), setReconnectPolicy() and disconnectFromDevice() may all be called from any
+ * thread, as may the services' GATT operations, which are queued to be issued on the device's thread. Controllers
+ * passed to the constructor must be moved to the same thread by the caller.
  */
 
 /*!
@@ -48,9 +75,45 @@ PokitDevice::PokitDevice(const QBluetoothDeviceInfo &deviceInfo, QObject *parent
     : QObject(parent), d_ptr(new PokitDevicePrivate(this))
 {
     Q_D(PokitDevice);
+    d->setParent(this); // So moveToThread() moves the private implementation too.
+    if (isPokitProduct(deviceInfo)) {
+        d->capabilities.product = pokitProduct(deviceInfo);
+    }
     d->setController(QLowEnergyController::createCentral(deviceInfo, this));
 }
 
+/*!
+ * Constructs a new Pokit device controller wrapper for \a deviceInfo, with \a parent, that connects via the local
+ * Bluetooth adapter whose address is \a localAdapter (or via the default adapter, if \a localAdapter is null).
+ *
+ * Hosts with more than one Bluetooth adapter may use this to spread connections across their adapters (see
+ * PokitConnectionManager::setAdapters() for an automatic policy), since each adapter can typically only maintain a
+ * handful of concurrent connections.
+ *
+ * \note Choosing an adapter requires Qt 5.14 or later. Earlier versions log a warning, and use the default adapter.
+ */
+PokitDevice::PokitDevice(const QBluetoothDeviceInfo &deviceInfo, const QBluetoothAddress &localAdapter,
+                         QObject *parent)
+    : QObject(parent), d_ptr(new PokitDevicePrivate(this))
+{
+    Q_D(PokitDevice);
+    d->setParent(this); // So moveToThread() moves the private implementation too.
+    d->localAdapter = localAdapter;
+    if (isPokitProduct(deviceInfo)) {
+        d->capabilities.product = pokitProduct(deviceInfo);
+    }
+    if (localAdapter.isNull()) {
+        d->setController(QLowEnergyController::createCentral(deviceInfo, this));
+        return;
+    }
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)) // Required adapter-specific createCentral() added in Qt 5.14.
+    d->setController(QLowEnergyController::createCentral(deviceInfo, localAdapter, this));
+    #else
+    qCWarning(d->lc).noquote() << tr("Choosing a local adapter requires Qt 5.14 or later; using the default adapter.");
+    d->setController(QLowEnergyController::createCentral(deviceInfo, this));
+    #endif
+}
+
 /*!
  * Constructs a new Pokit device controller wrapper for \a controller, with \a parent.
  */
@@ -58,6 +121,7 @@ PokitDevice::PokitDevice(QLowEnergyController *controller, QObject *parent)
     : QObject(parent), d_ptr(new PokitDevicePrivate(this))
 {
     Q_D(PokitDevice);
+    d->setParent(this); // So moveToThread() moves the private implementation too.
     d->setController(controller);
 }
 
@@ -71,7 +135,7 @@ PokitDevice::PokitDevice(QLowEnergyController *controller, QObject *parent)
 PokitDevice::PokitDevice(PokitDevicePrivate * const d, QObject * const parent)
     : QObject(parent), d_ptr(d)
 {
-
+    d->setParent(this); // So moveToThread() moves the private implementation too.
 }
 /// \endcond
 
@@ -101,14 +165,20 @@ const QLowEnergyController * PokitDevice::controller() const
     return d->controller;
 }
 
+/*!
+ * Returns the address of the local Bluetooth adapter this device was constructed to connect via, or a null address if
+ * it uses the default adapter (or was constructed with an existing controller).
+ */
+QBluetoothAddress PokitDevice::localAdapter() const
+{
+    Q_D(const PokitDevice);
+    return d->localAdapter;
+}
+
 /// \cond
 #define QTPOKIT_INTERNAL_GET_SERVICE(typeName, varName) \
     Q_D(PokitDevice);                                 \
-    const QMutexLocker scopedLock(&d->varName##Mutex);\
-    if (d->varName == nullptr) {                      \
-        d->varName = new typeName(d->controller);     \
-    }                                                 \
-    return d->varName                                 \
+    return d->getService(d->varName, d->varName##Mutex) \
 /// \endcond
 
 /*!
@@ -185,6 +255,377 @@ StatusService * PokitDevice::status()
 }
 #undef QTPOKIT_INTERNAL_GET_SERVICE
 
+/*!
+ * Returns a pointer to the \a service instance that uses this device's controller for access, as per the service
+ * accessors, such as multimeter(), or \c nullptr if \a service is unknown.
+ */
+AbstractPokitService * PokitDevice::service(const Service service)
+{
+    switch (service) {
+    case Service::Calibration: return calibration();
+    case Service::DataLogger:  return dataLogger();
+    case Service::DeviceInfo:  return deviceInformation();
+    case Service::Dso:         return dso();
+    case Service::Multimeter:  return multimeter();
+    case Service::Status:      return status();
+    }
+    return nullptr;
+}
+
+/*!
+ * Prepares all of \a services at once, emitting servicesPrepared once every one of them has either discovered its
+ * details, or failed.
+ *
+ * Each service accessor (such as dso()) lazily creates its service, which then discovers its own details once the
+ * device's services have been discovered. So services created one after another, such as once each earlier service
+ * is ready, are discovered one after another too. Instead, this function creates all of \a services up front, so
+ * their details are all requested at once, and multi-service start-up takes roughly as long as the slowest service,
+ * rather than the sum of them all.
+ *
+ * This may be called before connecting (which is best, since then discovery begins as soon as the device's services
+ * are known), or at any time afterwards. Services already prepared, since the device last (re)connected, are not
+ * discovered again, and if all of \a services are already prepared, then servicesPrepared is emitted straight away
+ * (via the event loop).
+ *
+ * Returns \c true if the services are being prepared, \c false if there is no controller.
+ *
+ * \see preparedServices
+ */
+bool PokitDevice::prepareServices(const Services services)
+{
+    Q_D(PokitDevice);
+    if (d->invokeOnDeviceThread([this, services]() { prepareServices(services); })) {
+        return (d->controller != nullptr);
+    }
+    if (!d->controller) {
+        return false;
+    }
+    qCDebug(d->lc).noquote() << tr("Preparing services: %1").arg(toString(services));
+    d->requestedServices |= services;
+    d->failedServices &= ~services; // Retried.
+    for (const Service flag: { Service::Calibration, Service::DataLogger, Service::DeviceInfo, Service::Dso,
+                               Service::Multimeter, Service::Status }) {
+        if (services.testFlag(flag)) {
+            d->watchService(flag, service(flag));
+        }
+    }
+    if ((d->requestedServices & d->preparedServices) == d->requestedServices) {
+        QTimer::singleShot(0, d, &PokitDevicePrivate::checkServicesPrepared); // After the caller has connected.
+    }
+    return true;
+}
+
+/*!
+ * Returns the services whose details have been discovered since the device last (re)connected, via
+ * prepareServices().
+ */
+PokitDevice::Services PokitDevice::preparedServices() const
+{
+    Q_D(const PokitDevice);
+    return d->preparedServices;
+}
+
+/*!
+ * Returns the capabilities resolved for this Pokit device so far.
+ *
+ * The Pokit product is resolved when the device's services have been discovered (or earlier, if this object was
+ * constructed with a QBluetoothDeviceInfo), and is then applied to each of this object's services that do not
+ * already have a product set. The firmware version, input and sampling limits, MAC address, and Data Logger settings
+ * layout are resolved when the status() and dataLogger() services' details have been discovered, respectively.
+ *
+ * Since these capabilities do not change for a given device, applications may choose to persist them (for example,
+ * keyed by the device's MAC address), and then restore them via setCapabilities() on subsequent connections.
+ *
+ * \see capabilitiesChanged
+ */
+PokitDevice::Capabilities PokitDevice::capabilities() const
+{
+    Q_D(const PokitDevice);
+    const QMutexLocker scopedLock(&d->capabilitiesMutex);
+    return d->capabilities;
+}
+
+/*!
+ * Sets this device's \a capabilities, such as those previously persisted by an application, and applies them to
+ * all of this object's services.
+ *
+ * \see capabilities
+ */
+void PokitDevice::setCapabilities(const Capabilities &capabilities)
+{
+    Q_D(PokitDevice);
+    {
+        const QMutexLocker scopedLock(&d->capabilitiesMutex);
+        d->capabilities = capabilities;
+    }
+    for (AbstractPokitService * const service: std::initializer_list<AbstractPokitService *>{
+        d->calibration, d->dataLogger, d->deviceInfo, d->dso, d->multimeter, d->status }) {
+        d->applyCapabilities(service);
+    }
+    Q_EMIT capabilitiesChanged(capabilities);
+}
+
+/*!
+ * Returns a human-readable name for the \a profile connection profile, or a null QString if unknown.
+ */
+QString PokitDevice::toString(const ConnectionProfile profile)
+{
+    switch (profile) {
+    case ConnectionProfile::Default:    return tr("Default");
+    case ConnectionProfile::LowLatency: return tr("Low latency");
+    case ConnectionProfile::LowPower:   return tr("Low power");
+    }
+    return QString();
+}
+
+/*!
+ * Returns a human-readable name for the \a service, or a null QString if unknown.
+ */
+QString PokitDevice::toString(const Service service)
+{
+    switch (service) {
+    case Service::Calibration: return tr("Calibration");
+    case Service::DataLogger:  return tr("Data Logger");
+    case Service::DeviceInfo:  return tr("Device Info");
+    case Service::Dso:         return tr("DSO");
+    case Service::Multimeter:  return tr("Multimeter");
+    case Service::Status:      return tr("Status");
+    }
+    return QString();
+}
+
+/*!
+ * Returns a human-readable, comma-separated, list of the \a services' names, or an empty QString if none.
+ */
+QString PokitDevice::toString(const Services services)
+{
+    QStringList names;
+    for (const Service service: { Service::Calibration, Service::DataLogger, Service::DeviceInfo, Service::Dso,
+                                  Service::Multimeter, Service::Status }) {
+        if (services.testFlag(service)) {
+            names.append(toString(service));
+        }
+    }
+    return names.join(u", "_s);
+}
+
+/*!
+ * Returns the BLE connection parameters requested for the \a profile connection profile.
+ *
+ * | Profile    | Interval (ms) | Latency | Supervision timeout (ms) |
+ * |------------|---------------|---------|--------------------------|
+ * | Default    | 30 - 50       | 0       | 5,000                    |
+ * | LowLatency | 7.5 - 15      | 0       | 2,000                    |
+ * | LowPower   | 100 - 250     | 4       | 6,000                    |
+ */
+QLowEnergyConnectionParameters PokitDevice::connectionParameters(const ConnectionProfile profile)
+{
+    QLowEnergyConnectionParameters parameters;
+    switch (profile) {
+    case ConnectionProfile::Default:
+        parameters.setIntervalRange(30.0, 50.0);
+        parameters.setLatency(0);
+        parameters.setSupervisionTimeout(5000);
+        break;
+    case ConnectionProfile::LowLatency:
+        parameters.setIntervalRange(7.5, 15.0); // 7.5ms is the minimum the Bluetooth Core Specification allows.
+        parameters.setLatency(0);
+        parameters.setSupervisionTimeout(2000);
+        break;
+    case ConnectionProfile::LowPower:
+        parameters.setIntervalRange(100.0, 250.0);
+        parameters.setLatency(4);
+        parameters.setSupervisionTimeout(6000); // Must exceed (1 + latency) * maximum interval * 2.
+        break;
+    }
+    return parameters;
+}
+
+/*!
+ * Returns the connection profile most recently requested via setConnectionProfile(), or
+ * ConnectionProfile::Default if none has been requested.
+ */
+PokitDevice::ConnectionProfile PokitDevice::connectionProfile() const
+{
+    Q_D(const PokitDevice);
+    return d->connectionProfile;
+}
+
+/*!
+ * Requests the BLE connection parameters of the \a profile connection profile (see connectionParameters()).
+ *
+ * If the device is already connected, the parameters are requested immediately, otherwise they will be requested as
+ * soon as the device connects. Either way, the Bluetooth stack, and the Pokit device, may choose other parameters, and
+ * some platforms (notably macOS, iOS and Windows) do not support connection update requests at all. The parameters
+ * actually used are reported via the controller's `QLowEnergyController::connectionUpdated` signal.
+ *
+ * Connection parameters are not persisted by the Pokit device, so callers that request a non-default profile for the
+ * duration of some operation should request ConnectionProfile::Default again afterwards, if the connection is to be
+ * kept open.
+ *
+ * Returns \c true if the request was made (or deferred until connected), \c false if there is no controller.
+ */
+bool PokitDevice::setConnectionProfile(const ConnectionProfile profile)
+{
+    Q_D(PokitDevice);
+    if (d->invokeOnDeviceThread([this, profile]() { setConnectionProfile(profile); })) {
+        return (d->controller != nullptr);
+    }
+    d->connectionProfile = profile;
+    d->connectionProfileRequested = true;
+    if (!d->controller) {
+        return false;
+    }
+    if (d->isConnected()) {
+        d->requestConnectionProfile();
+    }
+    return true;
+}
+
+/*!
+ * Returns the ATT MTU negotiated for the connection to the Pokit device, in bytes, or -1 if unknown.
+ *
+ * The MTU limits the size of each notification (to 3 bytes less than the MTU), and so determines how many
+ * notifications, and connection events, are needed to transfer DSO and data logger samples. The MTU is negotiated by
+ * the platform's Bluetooth stack, typically soon after connecting, and is only reported by Qt 6.
+ */
+int PokitDevice::mtu() const
+{
+    Q_D(const PokitDevice);
+    #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+    if (d->controller) {
+        return d->controller->mtu();
+    }
+    #else
+    Q_UNUSED(d)
+    #endif
+    return -1;
+}
+
+/*!
+ * Returns the policy for automatically reconnecting to the Pokit device after an unexpected disconnection.
+ *
+ * \see setReconnectPolicy
+ */
+PokitDevice::ReconnectPolicy PokitDevice::reconnectPolicy() const
+{
+    Q_D(const PokitDevice);
+    return d->reconnectPolicy;
+}
+
+/*!
+ * Sets the policy for automatically reconnecting to the Pokit device after an unexpected disconnection to \a policy.
+ *
+ * By default, ReconnectPolicy::maximumAttempts is 0, so no reconnection is attempted. Otherwise, whenever the device
+ * disconnects without disconnectFromDevice() having been called, reconnection is attempted after
+ * ReconnectPolicy::initialDelay milliseconds, and then (if that attempt fails) after exponentially increasing delays,
+ * up to ReconnectPolicy::maximumDelay, until either a reconnection succeeds, or ReconnectPolicy::maximumAttempts
+ * attempts have failed. Each delay is varied randomly, by up to ReconnectPolicy::jitter of itself, so that many hosts
+ * (or devices) that were disconnected at the same time do not all retry in lockstep.
+ *
+ * The reconnecting signal is emitted as each attempt is scheduled, then either reconnected or reconnectFailed. Once
+ * reconnected, each of this device's services re-creates its internal service object, then resumes its previously
+ * enabled notifications and settings (see AbstractPokitService::resumed).
+ */
+void PokitDevice::setReconnectPolicy(const ReconnectPolicy &policy)
+{
+    Q_D(PokitDevice);
+    if (d->invokeOnDeviceThread([this, policy]() { setReconnectPolicy(policy); })) {
+        return;
+    }
+    d->reconnectPolicy = policy;
+}
+
+/*!
+ * Returns the effective settings of the device's thread, as applied by setThreadPolicy(). If setThreadPolicy() has not
+ * been called (or has not yet been applied, on the device's thread), ThreadPolicy::State::applied is \c false.
+ *
+ * \see setThreadPolicy
+ */
+ThreadPolicy::State PokitDevice::threadPolicy() const
+{
+    Q_D(const PokitDevice);
+    const QMutexLocker scopedLock(&d->threadPolicyMutex);
+    return d->threadPolicy;
+}
+
+/*!
+ * Applies \a settings, such as CPU affinity and real-time priority, to the thread the device lives on, which (for a
+ * device hosted on a dedicated BLE worker thread) is the thread that receives, and parses, the device's notifications.
+ *
+ * If called from any other thread, the settings are applied on the device's thread, via its event loop, so once that
+ * thread is running. The resulting effective settings (including any settings the OS refused) are then logged, and
+ * available via threadPolicy().
+ *
+ * \see ThreadPolicy
+ */
+void PokitDevice::setThreadPolicy(const ThreadPolicy::Settings &settings)
+{
+    Q_D(PokitDevice);
+    if (d->invokeOnDeviceThread([this, settings]() { setThreadPolicy(settings); })) {
+        return;
+    }
+    const ThreadPolicy::State state = ThreadPolicy::apply(settings);
+    for (const QString &error: state.errors) {
+        qCWarning(d->lc).noquote() << error;
+    }
+    qCDebug(d->lc).noquote() << tr("Device thread running on CPUs %1, with %2 priority.")
+        .arg(ThreadPolicy::formatCpus(state.cpus), ThreadPolicy::toString(state.priority));
+    const QMutexLocker scopedLock(&d->threadPolicyMutex);
+    d->threadPolicy = state;
+}
+
+/*!
+ * Returns \c true if the device disconnected unexpectedly, and reconnection is currently being attempted.
+ */
+bool PokitDevice::isReconnecting() const
+{
+    Q_D(const PokitDevice);
+    return d->reconnectAttempts > 0;
+}
+
+/*!
+ * Disconnects from the Pokit device, without attempting to reconnect (regardless of reconnectPolicy()).
+ *
+ * Applications that use a reconnection policy should disconnect via this function, rather than via the controller's
+ * `QLowEnergyController::disconnectFromDevice`, which would otherwise be treated as an unexpected disconnection.
+ */
+void PokitDevice::disconnectFromDevice()
+{
+    Q_D(PokitDevice);
+    if (d->invokeOnDeviceThread([this]() { disconnectFromDevice(); })) {
+        return;
+    }
+    d->disconnectRequested = true;
+    d->reconnectAttempts = 0;
+    if (d->controller) {
+        d->controller->disconnectFromDevice();
+    }
+}
+
+/*!
+ * Returns a snapshot of this device's runtime statistics, including the number of (re)connections and controller
+ * errors, and the statistics of each service created so far (see AbstractPokitService::statistics()).
+ *
+ * Statistics are accumulated from construction, and may be fetched from any thread, such as periodically to monitor
+ * a link's health, or to judge how many devices a single host can handle.
+ */
+PokitDevice::Statistics PokitDevice::statistics() const
+{
+    Q_D(const PokitDevice);
+    Statistics statistics = [d]() {
+        const QMutexLocker scopedLock(&d->statisticsMutex);
+        return d->statistics;
+    }();
+    for (const AbstractPokitService * const service: std::initializer_list<const AbstractPokitService *>{
+        d->calibration, d->dataLogger, d->deviceInfo, d->dso, d->multimeter, d->status }) {
+        if (service != nullptr) {
+            statistics.services.append(service->statistics());
+        }
+    }
+    return statistics;
+}
+
 /*!
  * Returns a human-readable name for the \a uuid service, or a null QString if unknown.
  *
@@ -264,6 +705,27 @@ QString PokitDevice::charcteristicToString(const QBluetoothUuid &uuid)
     return hash.value(uuid);
 }
 
+/*!
+ * \fn void PokitDevice::reconnecting(const int attempt, const quint32 delay)
+ *
+ * This signal is emitted when reconnection attempt number \a attempt (starting at 1) has been scheduled, to begin in
+ * \a delay milliseconds.
+ *
+ * \see setReconnectPolicy
+ */
+
+/*!
+ * \fn void PokitDevice::reconnected()
+ *
+ * This signal is emitted when the device has reconnected, after an unexpected disconnection.
+ */
+
+/*!
+ * \fn void PokitDevice::reconnectFailed()
+ *
+ * This signal is emitted when the reconnection policy's maximum number of reconnection attempts have all failed.
+ */
+
 /*!
  * \cond internal
  * \class PokitDevicePrivate
@@ -279,6 +741,56 @@ PokitDevicePrivate::PokitDevicePrivate(PokitDevice * const q) : q_ptr(q)
 
 }
 
+/*!
+ * Invokes \a function on this object's thread, via a \a type connection, and returns \c true, if called from any other
+ * thread. Otherwise, returns \c false, and the caller should continue on this (the current) thread.
+ *
+ * This allows the device (along with its controller and services) to be hosted on a dedicated BLE worker thread, while
+ * still being controlled from other threads, such as an application's GUI thread.
+ */
+bool PokitDevicePrivate::invokeOnDeviceThread(const std::function<void()> &function, const Qt::ConnectionType type)
+{
+    if (QThread::currentThread() == thread()) {
+        return false;
+    }
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 10, 0))
+    Q_UNUSED(function)
+    Q_UNUSED(type)
+    qCWarning(lc).noquote() << tr("Cross-thread device access requires Qt 5.10 or later.");
+    return false;
+    #else
+    QMetaObject::invokeMethod(this, function, type);
+    return true;
+    #endif
+}
+
+/*!
+ * Returns \a service, first creating it (guarded by \a mutex) if not already created.
+ *
+ * The service is created on this object's thread (blocking the calling thread, if need be) with the device as its
+ * parent, so that moving the device to another thread moves all of its services too.
+ */
+template<class T>
+T * PokitDevicePrivate::getService(T * &service, QMutex &mutex)
+{
+    if (const QMutexLocker scopedLock(&mutex); service != nullptr) {
+        return service;
+    }
+    const auto create = [this, &service, &mutex]() {
+        const QMutexLocker scopedLock(&mutex);
+        if (service == nullptr) { // May have been created by another thread in the meantime.
+            Q_Q(PokitDevice);
+            service = new T(controller, q);
+            attachService(service);
+        }
+    };
+    if (!invokeOnDeviceThread(create, Qt::BlockingQueuedConnection)) {
+        create();
+    }
+    const QMutexLocker scopedLock(&mutex);
+    return service;
+}
+
 /*!
  * Sets \a newController to be used for accessing Pokit devices.
  *
@@ -344,11 +856,209 @@ void PokitDevicePrivate::setController(QLowEnergyController * newController)
             this, &PokitDevicePrivate::stateChanged);
 }
 
+/*!
+ * Applies the capabilities resolved so far to the newly created \a service, and connects its signals, so that any
+ * further capabilities can be resolved once the service's details have been discovered.
+ */
+void PokitDevicePrivate::attachService(AbstractPokitService * const service)
+{
+    applyCapabilities(service);
+    connect(service, &AbstractPokitService::serviceDetailsDiscovered,
+            this, &PokitDevicePrivate::updateCapabilities);
+}
+
+/*!
+ * Applies the capabilities resolved so far to \a service, if not \c nullptr.
+ *
+ * This sets the service's Pokit product, if not already set, and for DataLoggerService instances, the layout of the
+ * `Settings` characteristic, if known.
+ */
+void PokitDevicePrivate::applyCapabilities(AbstractPokitService * const service) const
+{
+    if (service == nullptr) {
+        return;
+    }
+    const PokitDevice::Capabilities resolved = [this]() {
+        const QMutexLocker scopedLock(&capabilitiesMutex);
+        return capabilities;
+    }();
+    if ((resolved.product) && (!service->pokitProduct())) {
+        service->setPokitProduct(*resolved.product);
+    }
+    if (resolved.loggerUpdateIntervalIs32bit) {
+        if (const auto logger = qobject_cast<DataLoggerService *>(service); logger != nullptr) {
+            logger->setUpdateIntervalIs32bit(*resolved.loggerUpdateIntervalIs32bit);
+        }
+    }
+}
+
+/*!
+ * Resolves any capabilities not yet known from the current status and data logger services, if any, and emits
+ * PokitDevice::capabilitiesChanged if anything new was resolved.
+ */
+void PokitDevicePrivate::updateCapabilities()
+{
+    PokitDevice::Capabilities resolved;
+    {
+        const QMutexLocker scopedLock(&capabilitiesMutex);
+        resolved = capabilities;
+    }
+    bool changed = false;
+
+    if ((resolved.firmwareVersion.isNull()) && (status != nullptr)) {
+        const StatusService::DeviceCharacteristics characteristics = status->deviceCharacteristics();
+        if (!characteristics.firmwareVersion.isNull()) {
+            resolved.firmwareVersion = characteristics.firmwareVersion;
+            resolved.maximumSamplingRate = characteristics.maximumSamplingRate;
+            resolved.samplingBufferSize = characteristics.samplingBufferSize;
+            resolved.maximumVoltage = characteristics.maximumVoltage;
+            resolved.maximumCurrent = characteristics.maximumCurrent;
+            resolved.maximumResistance = characteristics.maximumResistance;
+            resolved.capabilityMask = characteristics.capabilityMask;
+            resolved.macAddress = characteristics.macAddress;
+            changed = true;
+        }
+    }
+
+    if ((!resolved.loggerUpdateIntervalIs32bit) && (dataLogger != nullptr)) {
+        resolved.loggerUpdateIntervalIs32bit = dataLogger->updateIntervalIs32bit();
+        changed = changed || resolved.loggerUpdateIntervalIs32bit.has_value();
+    }
+
+    if (!changed) {
+        return;
+    }
+    qCDebug(lc).noquote() << tr("Resolved capabilities: firmware %1, %2 Hz maximum sampling rate, "
+        "%3 samples buffer, %4-bit logger interval.").arg(resolved.firmwareVersion.toString())
+        .arg(resolved.maximumSamplingRate).arg(resolved.samplingBufferSize)
+        .arg(resolved.loggerUpdateIntervalIs32bit.value_or(false) ? 32 : 16);
+    {
+        const QMutexLocker scopedLock(&capabilitiesMutex);
+        capabilities = resolved;
+    }
+    Q_Q(PokitDevice);
+    Q_EMIT q->capabilitiesChanged(resolved);
+}
+
+/*!
+ * Returns the delay, in milliseconds, before reconnection attempt number \a attempt (starting at 0) according to
+ * \a policy, with \a random (in the range [0, 1)) selecting the delay's jitter.
+ */
+quint32 PokitDevicePrivate::reconnectDelay(const PokitDevice::ReconnectPolicy &policy, const int attempt,
+                                           const double random)
+{
+    const double delay = qMin<double>(policy.initialDelay * qPow(qMax(policy.backoff, 1.0f), attempt),
+                                      qMax(policy.maximumDelay, policy.initialDelay));
+    const double jitter = qBound(0.0f, policy.jitter, 1.0f) * ((2.0 * random) - 1.0);
+    return (quint32)qRound64(delay * (1.0 + jitter));
+}
+
+/*!
+ * Schedules the next reconnection attempt, returning \c true if scheduled, or \c false (after emitting
+ * PokitDevice::reconnectFailed) if the reconnection policy's maximum attempts have already been made.
+ */
+bool PokitDevicePrivate::scheduleReconnect()
+{
+    Q_Q(PokitDevice);
+    if (reconnectAttempts >= reconnectPolicy.maximumAttempts) {
+        qCWarning(lc).noquote() << tr("Failed to reconnect after %Ln attempt/s.", nullptr, reconnectAttempts);
+        reconnectAttempts = 0;
+        {
+            const QMutexLocker scopedLock(&statisticsMutex);
+            ++statistics.reconnectFailures;
+        }
+        Q_EMIT q->reconnectFailed();
+        return false;
+    }
+    const quint32 delay = reconnectDelay(reconnectPolicy, reconnectAttempts++,
+                                         QRandomGenerator::global()->generateDouble());
+    qCInfo(lc).noquote() << tr("Reconnecting in %Ln millisecond/s (attempt %1 of %2).", nullptr, delay)
+        .arg(reconnectAttempts).arg(reconnectPolicy.maximumAttempts);
+    reconnectPending = true;
+    QTimer::singleShot(delay, this, [this]() {
+        reconnectPending = false;
+        if ((!disconnectRequested) && (reconnectAttempts > 0) && (controller)) {
+            controller->connectToDevice();
+        }
+    });
+    Q_EMIT q->reconnecting(reconnectAttempts, delay);
+    return true;
+}
+
+/*!
+ * Watches \a object, the \a service instance, for the outcome of its discovery, unless already watched. If \a object
+ * has already discovered its details, then \a service is marked prepared straight away.
+ */
+void PokitDevicePrivate::watchService(const PokitDevice::Service service, AbstractPokitService * const object)
+{
+    if ((object == nullptr) || (watchedServices.testFlag(service))) {
+        return;
+    }
+    watchedServices |= service;
+    connect(object, &AbstractPokitService::serviceDetailsDiscovered, this, [this, service]() {
+        servicePrepared(service, true);
+    });
+    connect(object, &AbstractPokitService::serviceErrorOccurred, this,
+        [this, service](const QLowEnergyService::ServiceError error) {
+            if (error != QLowEnergyService::ServiceError::NoError) {
+                servicePrepared(service, false);
+            }
+        });
+    if (const QLowEnergyService * const lowEnergyService = object->service(); (lowEnergyService) &&
+        (lowEnergyService->state() ==
+        #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+        QLowEnergyService::ServiceDiscovered
+        #else
+        QLowEnergyService::RemoteServiceDiscovered
+        #endif
+    )) {
+        preparedServices |= service;
+    }
+}
+
+/*!
+ * Records the outcome of preparing \a service, that is, whether its details were discovered (\a success), or not, and
+ * then reports any requested services that are now all prepared.
+ */
+void PokitDevicePrivate::servicePrepared(const PokitDevice::Service service, const bool success)
+{
+    qCDebug(lc).noquote() << ((success) ? tr("%1 service prepared.") : tr("%1 service failed to prepare."))
+        .arg(PokitDevice::toString(service));
+    if (success) {
+        preparedServices |= service;
+        failedServices &= ~PokitDevice::Services(service);
+    } else {
+        preparedServices &= ~PokitDevice::Services(service);
+        failedServices |= service;
+    }
+    checkServicesPrepared();
+}
+
+/*!
+ * Emits PokitDevice::servicesPrepared, if services have been requested, and every one of them has either been
+ * prepared, or failed.
+ */
+void PokitDevicePrivate::checkServicesPrepared()
+{
+    if ((!requestedServices) || ((requestedServices & (preparedServices | failedServices)) != requestedServices)) {
+        return;
+    }
+    const PokitDevice::Services prepared = requestedServices & preparedServices;
+    const PokitDevice::Services failed = requestedServices & failedServices;
+    requestedServices = {};
+    if (failed) {
+        qCWarning(lc).noquote() << tr("Failed to prepare services: %1").arg(PokitDevice::toString(failed));
+    }
+    Q_Q(PokitDevice);
+    Q_EMIT q->servicesPrepared(prepared, failed);
+}
+
 /*!
  * Handle connected signals.
  */
-void PokitDevicePrivate::connected() const
+void PokitDevicePrivate::connected()
 {
+    QTPOKIT_TRACE_ZONE(Connect, "connected");
     if (controller == nullptr) {
         qCCritical(lc).noquote() << tr("PokitDevicePrivate::connected slot invoked without a controller.");
         return; // Just to avoid the nullptr dereference below.
@@ -356,6 +1066,62 @@ void PokitDevicePrivate::connected() const
     qCDebug(lc).noquote() << tr(R"(Connected to "%1" (%2) at (%3).)").arg(
         controller->remoteName(), controller->remoteDeviceUuid().toString(),
         controller->remoteAddress().toString());
+    QTPOKIT_TRACE_POINT(Connect, "connected", 0);
+    Q_Q(PokitDevice);
+    qCDebug(lc).noquote() << tr("ATT MTU: %1").arg(q->mtu());
+    if (connectionProfileRequested) {
+        requestConnectionProfile();
+    }
+    disconnectRequested = false;
+    {
+        const QMutexLocker scopedLock(&statisticsMutex);
+        ++statistics.connections;
+        if (reconnectAttempts > 0) {
+            ++statistics.reconnections;
+        }
+    }
+    if (reconnectAttempts > 0) {
+        qCInfo(lc).noquote() << tr("Reconnected after %Ln attempt/s.", nullptr, reconnectAttempts);
+        reconnectAttempts = 0;
+        Q_EMIT q->reconnected();
+    }
+}
+
+/*!
+ * Returns \c true if #controller is connected to the device (including while discovering services), \c false
+ * otherwise.
+ */
+bool PokitDevicePrivate::isConnected() const
+{
+    if (controller == nullptr) {
+        return false;
+    }
+    switch (controller->state()) {
+    case QLowEnergyController::ConnectedState:
+    case QLowEnergyController::DiscoveringState:
+    case QLowEnergyController::DiscoveredState:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*!
+ * Requests the connection parameters of #connectionProfile from #controller.
+ *
+ * Returns \c true if the request was made, \c false if there is no controller.
+ */
+bool PokitDevicePrivate::requestConnectionProfile()
+{
+    if (controller == nullptr) {
+        return false;
+    }
+    const QLowEnergyConnectionParameters parameters = PokitDevice::connectionParameters(connectionProfile);
+    qCDebug(lc).noquote() << tr("Requesting %1 connection parameters:").arg(PokitDevice::toString(connectionProfile))
+        << parameters.minimumInterval() << parameters.maximumInterval() << parameters.latency()
+        << parameters.supervisionTimeout();
+    controller->requestConnectionUpdate(parameters);
+    return true;
 }
 
 /*!
@@ -369,27 +1135,69 @@ void PokitDevicePrivate::connectionUpdated(const QLowEnergyConnectionParameters
 }
 
 /*!
- * Handle disconnected signals.
+ * Handle disconnected signals, scheduling a reconnection attempt if the disconnection was unexpected, and the
+ * reconnection policy allows.
  */
-void PokitDevicePrivate::disconnected() const
+void PokitDevicePrivate::disconnected()
 {
     qCDebug(lc).noquote() << tr("Device disconnected.");
+    QTPOKIT_TRACE_POINT(Connect, "disconnected", 0);
+    {
+        const QMutexLocker scopedLock(&statisticsMutex);
+        ++statistics.disconnections;
+    }
+    preparedServices = {}; // Services are re-discovered on reconnection.
+    if ((!disconnectRequested) && (!reconnectPending) && (reconnectPolicy.maximumAttempts > 0)) {
+        scheduleReconnect();
+    }
 }
 
 /*!
  * Handle discoveryFinished signals.
  */
-void PokitDevicePrivate::discoveryFinished() const
+void PokitDevicePrivate::discoveryFinished()
 {
+    QTPOKIT_TRACE_ZONE(Discovery, "discoveryFinished");
     qCDebug(lc).noquote() << tr("Service discovery finished.");
+    QTPOKIT_TRACE_POINT(Discovery, "discoveryFinished", 0);
+    if ((controller == nullptr) || (!isPokitProduct(*controller))) {
+        return;
+    }
+
+    // Resolve the product once, and share it with any services created before discovery finished. Note, this slot
+    // was connected before any of the services' own slots, so those will see the product before creating their
+    // service objects.
+    const PokitProduct product = pokitProduct(*controller);
+    {
+        const QMutexLocker scopedLock(&capabilitiesMutex);
+        if (capabilities.product == product) {
+            return;
+        }
+        capabilities.product = product;
+    }
+    for (AbstractPokitService * const service: std::initializer_list<AbstractPokitService *>{
+        calibration, dataLogger, deviceInfo, dso, multimeter, status }) {
+        applyCapabilities(service);
+    }
+    Q_Q(PokitDevice);
+    Q_EMIT q->capabilitiesChanged(q->capabilities());
 }
 
 /*!
- * Handle error signals.
+ * Handle error signals, scheduling another reconnection attempt if \a newError ended the last one.
  */
-void PokitDevicePrivate::errorOccurred(QLowEnergyController::Error newError) const
+void PokitDevicePrivate::errorOccurred(QLowEnergyController::Error newError)
 {
     qCDebug(lc).noquote() << tr("Controller error:") << newError;
+    if (newError != QLowEnergyController::NoError) {
+        const QMutexLocker scopedLock(&statisticsMutex);
+        ++statistics.errors;
+    }
+    // A failed reconnection attempt reports an error, but (never having connected) no disconnection.
+    if ((reconnectAttempts > 0) && (!reconnectPending) && (!disconnectRequested) && (controller) &&
+        (controller->state() == QLowEnergyController::UnconnectedState)) {
+        scheduleReconnect();
+    }
 }
 
 /*!
@@ -9,7 +9,7 @@
 #ifndef QTPOKIT_POKITDEVICE_P_H
 #define QTPOKIT_POKITDEVICE_P_H
 
-#include <qtpokit/qtpokit_global.h>
+#include <qtpokit/pokitdevice.h>
 
 #include <QLoggingCategory>
 #include <QLowEnergyController>
@@ -17,6 +17,8 @@
 #include <QMutex>
 #include <QObject>
 
+#include <functional>
+
 QTPOKIT_BEGIN_NAMESPACE
 
 class CalibrationService;
@@ -26,7 +28,7 @@ class DsoService;
 class MultimeterService;
 class StatusService;
 
-class PokitDevice;
+class AbstractPokitService;
 
 class QTPOKIT_EXPORT PokitDevicePrivate : public QObject
 {
@@ -36,6 +38,7 @@ public:
     static Q_LOGGING_CATEGORY(lc, "pokit.ble.controller", QtInfoMsg); ///< Logging category.
 
     QLowEnergyController * controller { nullptr };    ///< BLE controller for accessing the Pokit device.
+    QBluetoothAddress localAdapter;                   ///< Local adapter requested, or null for the default adapter.
 
     CalibrationService * calibration { nullptr };     ///< Calibration service for this Pokit device.
     DataLoggerService * dataLogger { nullptr };       ///< Data Logger service for this Pokit device.
@@ -51,16 +54,53 @@ public:
     QMutex multimeterMutex;    ///< Mutex for protecting access to #multimeter.
     QMutex statusMutex;        ///< Mutex for protecting access to #status.
 
+    PokitDevice::Capabilities capabilities; ///< Capabilities resolved for this Pokit device.
+    mutable QMutex capabilitiesMutex;       ///< Mutex for protecting access to #capabilities.
+
+    /// Connection profile to request, once connected, if #connectionProfileRequested.
+    PokitDevice::ConnectionProfile connectionProfile { PokitDevice::ConnectionProfile::Default };
+    bool connectionProfileRequested { false }; ///< Whether #connectionProfile has been explicitly requested.
+
+    PokitDevice::ReconnectPolicy reconnectPolicy; ///< Policy for reconnecting after unexpected disconnections.
+    int reconnectAttempts { 0 };                  ///< Number of consecutive reconnection attempts made so far.
+    bool disconnectRequested { false };           ///< Whether the current (or last) disconnection was requested.
+    bool reconnectPending { false };              ///< Whether a reconnection attempt is currently scheduled.
+
+    PokitDevice::Services requestedServices; ///< Services requested via prepareServices(), but not yet reported.
+    PokitDevice::Services preparedServices;  ///< Services whose details have been discovered since (re)connecting.
+    PokitDevice::Services failedServices;    ///< Requested services that have failed to be prepared.
+    PokitDevice::Services watchedServices;   ///< Services whose discovery is being watched, for #preparedServices.
+
+    PokitDevice::Statistics statistics; ///< Connection statistics (services' are collected on demand).
+    mutable QMutex statisticsMutex;     ///< Mutex for protecting access to #statistics.
+
+    ThreadPolicy::State threadPolicy; ///< Effective settings of the device's thread, once set via setThreadPolicy().
+    mutable QMutex threadPolicyMutex; ///< Mutex for protecting access to #threadPolicy.
+
     explicit PokitDevicePrivate(PokitDevice * const q);
 
+    bool invokeOnDeviceThread(const std::function<void()> &function,
+                              const Qt::ConnectionType type = Qt::QueuedConnection);
+    template<class T> T * getService(T * &service, QMutex &mutex);
+
     void setController(QLowEnergyController * newController);
+    void attachService(AbstractPokitService * const service);
+    void applyCapabilities(AbstractPokitService * const service) const;
+    void updateCapabilities();
+    bool isConnected() const;
+    bool requestConnectionProfile();
+    static quint32 reconnectDelay(const PokitDevice::ReconnectPolicy &policy, const int attempt, const double random);
+    bool scheduleReconnect();
+    void watchService(const PokitDevice::Service service, AbstractPokitService * const object);
+    void servicePrepared(const PokitDevice::Service service, const bool success);
+    void checkServicesPrepared();
 
 public Q_SLOTS:
-    void connected() const;
+    void connected();
     void connectionUpdated(const QLowEnergyConnectionParameters &newParameters) const;
-    void disconnected() const;
-    void discoveryFinished() const;
-    void errorOccurred(QLowEnergyController::Error newError) const;
+    void disconnected();
+    void discoveryFinished();
+    void errorOccurred(QLowEnergyController::Error newError);
     void serviceDiscovered(const QBluetoothUuid &newService) const;
     void stateChanged(QLowEnergyController::ControllerState state) const;
 
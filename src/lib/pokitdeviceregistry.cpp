@@ -0,0 +1,488 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the PokitDeviceRegistry and PokitDeviceRegistryPrivate classes.
+ */
+
+#include <qtpokit/pokitdeviceregistry.h>
+#include <qtpokit/pokitdiscoveryagent.h>
+#include "pokitdeviceregistry_p.h"
+#include "pokitdiscoveryagent_p.h"
+#include "../stringliterals_p.h"
+
+#include <QDateTime>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class PokitDeviceRegistry
+ *
+ * The PokitDeviceRegistry class maintains a long-lived registry of nearby Pokit devices, via periodic (or continuous)
+ * background discovery, so that multiple consumers (such as GUI views, daemons and fleet tools) can share a single
+ * scan, and look devices up by key() in constant time.
+ *
+ * Once start()ed, the registry scans for scanDuration() milliseconds, then idles for scanInterval() milliseconds,
+ * repeating until stop()ped. So the default 10 second scans, every 30 seconds, give a one-in-three duty cycle, which
+ * keeps the registry current without monopolising the radio. A scanDuration() of 0 scans continuously.
+ *
+ * Newly discovered devices are reported via deviceAdded, devices seen again (or updated, per the discoveryAgent()'s
+ * update coalescing) via deviceUpdated, and devices not seen for maximumAge() milliseconds via deviceRemoved. Since
+ * connected devices typically stop advertising, devices reported as connected (or connecting) via
+ * setConnectionState() are never aged out.
+ */
+
+/*!
+ * Constructs a new Pokit device registry with \a parent, using \a deviceAdapter for discovery.
+ */
+PokitDeviceRegistry::PokitDeviceRegistry(const QBluetoothAddress &deviceAdapter, QObject * parent)
+    : QObject(parent), d_ptr(new PokitDeviceRegistryPrivate(this))
+{
+    Q_D(PokitDeviceRegistry);
+    d->setAgent(new PokitDiscoveryAgent(deviceAdapter, this));
+}
+
+/*!
+ * Constructs a new Pokit device registry with \a parent, using the default local adapter for discovery.
+ */
+PokitDeviceRegistry::PokitDeviceRegistry(QObject * parent)
+    : QObject(parent), d_ptr(new PokitDeviceRegistryPrivate(this))
+{
+    Q_D(PokitDeviceRegistry);
+    d->setAgent(new PokitDiscoveryAgent(this));
+}
+
+/*!
+ * \cond internal
+ * Constructs a new Pokit device registry with \a parent, and private implementation \a d.
+ */
+PokitDeviceRegistry::PokitDeviceRegistry(PokitDeviceRegistryPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setAgent(new PokitDiscoveryAgent(this));
+}
+/// \endcond
+
+/*!
+ * Destroys this PokitDeviceRegistry object.
+ */
+PokitDeviceRegistry::~PokitDeviceRegistry()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns a string version of the \a state enum label.
+ */
+QString PokitDeviceRegistry::toString(const ConnectionState &state)
+{
+    switch (state) {
+    case ConnectionState::Disconnected: return u"Disconnected"_s;
+    case ConnectionState::Connecting:   return u"Connecting"_s;
+    case ConnectionState::Connected:    return u"Connected"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Returns the discovery agent used by this registry, such as for configuring its update coalescing.
+ *
+ * The agent is owned by this registry, and should only be started (and stopped) via start() and stop().
+ */
+PokitDiscoveryAgent * PokitDeviceRegistry::discoveryAgent() const
+{
+    Q_D(const PokitDeviceRegistry);
+    return d->agent;
+}
+
+/*!
+ * Returns the duration of each scan, in milliseconds, or 0 if scanning continuously.
+ */
+quint32 PokitDeviceRegistry::scanDuration() const
+{
+    Q_D(const PokitDeviceRegistry);
+    return d->scanDuration;
+}
+
+/*!
+ * Sets the duration of each scan to \a duration milliseconds, or to scan continuously if \a duration is 0. Takes
+ * effect from the next scan.
+ *
+ * \note Before Qt 5.8, scan durations are platform defined.
+ */
+void PokitDeviceRegistry::setScanDuration(const quint32 duration)
+{
+    Q_D(PokitDeviceRegistry);
+    d->scanDuration = duration;
+}
+
+/*!
+ * Returns the idle time between scans, in milliseconds.
+ */
+quint32 PokitDeviceRegistry::scanInterval() const
+{
+    Q_D(const PokitDeviceRegistry);
+    return d->scanInterval;
+}
+
+/*!
+ * Sets the idle time between scans to \a interval milliseconds. An \a interval of 0 starts each scan as soon as the
+ * previous one finishes. Takes effect from the end of the current scan.
+ */
+void PokitDeviceRegistry::setScanInterval(const quint32 interval)
+{
+    Q_D(PokitDeviceRegistry);
+    d->scanInterval = interval;
+}
+
+/*!
+ * Returns the number of milliseconds since a (disconnected) device was last seen, before it is aged out, or 0 if
+ * devices are never aged out.
+ */
+quint32 PokitDeviceRegistry::maximumAge() const
+{
+    Q_D(const PokitDeviceRegistry);
+    return d->maximumAge;
+}
+
+/*!
+ * Sets the number of milliseconds since a (disconnected) device was last seen, before it is aged out, to \a age. An
+ * \a age of 0 means devices are never aged out. Naturally, this should be longer than the scanInterval().
+ */
+void PokitDeviceRegistry::setMaximumAge(const quint32 age)
+{
+    Q_D(PokitDeviceRegistry);
+    d->maximumAge = age;
+    if (d->running) {
+        d->ageTimer.stop();
+        if (age > 0) {
+            d->ageTimer.start((int)qMax(age / 4, 100u));
+        }
+    }
+}
+
+/*!
+ * Returns \c true if this registry is (periodically) scanning, \c false otherwise.
+ */
+bool PokitDeviceRegistry::isRunning() const
+{
+    Q_D(const PokitDeviceRegistry);
+    return d->running;
+}
+
+/*!
+ * Returns the key identifying the device described by \a info in this registry. That is, its address, or on
+ * platforms that do not expose device addresses (ie macOS), its UUID.
+ */
+QString PokitDeviceRegistry::key(const QBluetoothDeviceInfo &info)
+{
+    return PokitDiscoveryAgentPrivate::deviceKey(info);
+}
+
+/*!
+ * Returns the number of devices currently registered.
+ */
+int PokitDeviceRegistry::count() const
+{
+    Q_D(const PokitDeviceRegistry);
+    return (int)d->entries.size();
+}
+
+/*!
+ * Returns \c true if the device identified by \a key is currently registered, \c false otherwise.
+ */
+bool PokitDeviceRegistry::contains(const QString &key) const
+{
+    Q_D(const PokitDeviceRegistry);
+    return d->entries.contains(key);
+}
+
+/*!
+ * Returns the registered device identified by \a key, if any.
+ */
+std::optional<PokitDeviceRegistry::Entry> PokitDeviceRegistry::device(const QString &key) const
+{
+    Q_D(const PokitDeviceRegistry);
+    const auto iter = d->entries.constFind(key);
+    return (iter == d->entries.constEnd()) ? std::nullopt : std::optional<Entry>(*iter);
+}
+
+/*!
+ * Returns all currently registered devices, in no particular order.
+ */
+QVector<PokitDeviceRegistry::Entry> PokitDeviceRegistry::devices() const
+{
+    Q_D(const PokitDeviceRegistry);
+    QVector<Entry> devices;
+    devices.reserve((qsizetype)d->entries.size());
+    for (const Entry &entry: d->entries) {
+        devices.append(entry);
+    }
+    return devices;
+}
+
+/*!
+ * Records \a state as the connection state of the device identified by \a key, emitting deviceUpdated if changed.
+ * Returns \c false if no such device is registered, \c true otherwise.
+ *
+ * Consumers that connect to registered devices (such as via PokitDevice) should report their connection state here,
+ * so that other consumers can see it, and so that connected devices (which typically stop advertising) are not aged
+ * out.
+ */
+bool PokitDeviceRegistry::setConnectionState(const QString &key, const ConnectionState state)
+{
+    Q_D(PokitDeviceRegistry);
+    const auto iter = d->entries.find(key);
+    if (iter == d->entries.end()) {
+        return false;
+    }
+    if (iter->connectionState != state) {
+        iter->connectionState = state;
+        if (state == ConnectionState::Disconnected) {
+            iter->lastSeen = QDateTime::currentMSecsSinceEpoch(); // Restart the device's age from disconnection.
+        }
+        const Entry entry = *iter;
+        Q_EMIT deviceUpdated(entry);
+    }
+    return true;
+}
+
+/*!
+ * Starts (periodic) background discovery, if not already running.
+ */
+void PokitDeviceRegistry::start()
+{
+    Q_D(PokitDeviceRegistry);
+    if (d->running) {
+        return;
+    }
+    d->running = true;
+    if (d->maximumAge > 0) {
+        d->ageTimer.start((int)qMax(d->maximumAge / 4, 100u));
+    }
+    d->startScan();
+}
+
+/*!
+ * Stops background discovery. Registered devices are retained (see clear()), but are no longer aged out.
+ */
+void PokitDeviceRegistry::stop()
+{
+    Q_D(PokitDeviceRegistry);
+    d->running = false;
+    d->scanTimer.stop();
+    d->ageTimer.stop();
+    if (d->agent->isActive()) {
+        d->agent->stop();
+    }
+}
+
+/*!
+ * Removes all registered devices, emitting deviceRemoved for each.
+ */
+void PokitDeviceRegistry::clear()
+{
+    Q_D(PokitDeviceRegistry);
+    const QHash<QString, Entry> removed = d->entries;
+    d->entries.clear();
+    for (const Entry &entry: removed) {
+        Q_EMIT deviceRemoved(entry);
+    }
+}
+
+/*!
+ * \fn PokitDeviceRegistry::deviceAdded
+ *
+ * This signal is emitted when the Pokit device described by \a entry is first seen, or seen again after being aged
+ * out, or cleared.
+ */
+
+/*!
+ * \fn PokitDeviceRegistry::deviceUpdated
+ *
+ * This signal is emitted when the registered Pokit device described by \a entry is seen again, or updated, or its
+ * connection state changes.
+ */
+
+/*!
+ * \fn PokitDeviceRegistry::deviceRemoved
+ *
+ * This signal is emitted when the Pokit device described by \a entry is removed from the registry, such as when it
+ * has not been seen for maximumAge().
+ */
+
+/*!
+ * \cond internal
+ * \class PokitDeviceRegistryPrivate
+ *
+ * The PokitDeviceRegistryPrivate class provides private implementation for PokitDeviceRegistry.
+ */
+
+/*!
+ * Constructs a new PokitDeviceRegistryPrivate object with public implementation \a q.
+ */
+PokitDeviceRegistryPrivate::PokitDeviceRegistryPrivate(PokitDeviceRegistry * const q) : q_ptr(q)
+{
+    scanTimer.setSingleShot(true);
+    connect(&scanTimer, &QTimer::timeout, this, &PokitDeviceRegistryPrivate::startScan);
+    connect(&ageTimer, &QTimer::timeout, this, [this]() { ageOut(QDateTime::currentMSecsSinceEpoch()); });
+}
+
+/*!
+ * Sets \a newAgent as the agent to discover devices with.
+ */
+void PokitDeviceRegistryPrivate::setAgent(PokitDiscoveryAgent * const newAgent)
+{
+    agent = newAgent;
+    connect(agent, &PokitDiscoveryAgent::pokitDeviceDiscovered, this, &PokitDeviceRegistryPrivate::deviceDiscovered);
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    connect(agent, &PokitDiscoveryAgent::pokitDeviceUpdated, this, &PokitDeviceRegistryPrivate::deviceUpdated);
+    connect(agent, &QBluetoothDeviceDiscoveryAgent::deviceUpdated,
+            this, &PokitDeviceRegistryPrivate::advertisementReceived);
+    #endif
+    connect(agent,
+        #if (QT_VERSION < QT_VERSION_CHECK(6, 2, 0))
+            QOverload<PokitDiscoveryAgent::Error>::of(&PokitDiscoveryAgent::error),
+        #else
+            &QBluetoothDeviceDiscoveryAgent::errorOccurred,
+        #endif
+        this, &PokitDeviceRegistryPrivate::error);
+    connect(agent, &QBluetoothDeviceDiscoveryAgent::finished, this, &PokitDeviceRegistryPrivate::finished);
+}
+
+/*!
+ * Starts the next scan, if still running.
+ */
+void PokitDeviceRegistryPrivate::startScan()
+{
+    if ((!running) || (agent->isActive())) {
+        return;
+    }
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)) // Low energy discovery timeout added in Qt 5.8.
+    agent->setLowEnergyDiscoveryTimeout((int)scanDuration);
+    #endif
+    qCDebug(lc).noquote() << tr("Starting background scan, for %Ln millisecond(s).", nullptr, (int)scanDuration);
+    agent->start();
+}
+
+/*!
+ * Records that the device described by \a info was seen at \a now milliseconds since the epoch, emitting deviceAdded
+ * if it was not already registered, or deviceUpdated otherwise.
+ */
+void PokitDeviceRegistryPrivate::seen(const QBluetoothDeviceInfo &info, const qint64 now)
+{
+    Q_Q(PokitDeviceRegistry);
+    auto iter = entries.find(PokitDeviceRegistry::key(info));
+    const bool isNew = (iter == entries.end());
+    if (isNew) {
+        iter = entries.insert(PokitDeviceRegistry::key(info), PokitDeviceRegistry::Entry{});
+    }
+    iter->info = info;
+    iter->product = pokitProduct(info);
+    iter->name = info.name();
+    iter->rssi = info.rssi();
+    iter->lastSeen = now;
+    const PokitDeviceRegistry::Entry entry = *iter; // Copied, in case connected slots modify #entries.
+    if (isNew) {
+        qCDebug(lc).noquote() << tr(R"(Registered Pokit device "%1" at %2.)")
+            .arg(info.name(), PokitDeviceRegistry::key(info));
+        Q_EMIT q->deviceAdded(entry);
+    } else {
+        Q_EMIT q->deviceUpdated(entry);
+    }
+}
+
+/*!
+ * Removes (and emits deviceRemoved for) all disconnected devices not seen for more than #maximumAge milliseconds, as
+ * of \a now milliseconds since the epoch. Returns the number of devices removed.
+ */
+int PokitDeviceRegistryPrivate::ageOut(const qint64 now)
+{
+    if (maximumAge == 0) {
+        return 0;
+    }
+    QVector<PokitDeviceRegistry::Entry> removed;
+    for (auto iter = entries.begin(); iter != entries.end();) {
+        if ((iter->connectionState == PokitDeviceRegistry::ConnectionState::Disconnected) &&
+            (now - iter->lastSeen > maximumAge)) {
+            removed.append(*iter);
+            iter = entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    Q_Q(PokitDeviceRegistry);
+    for (const PokitDeviceRegistry::Entry &entry: removed) {
+        qCDebug(lc).noquote() << tr(R"(Pokit device "%1" at %2 aged out.)")
+            .arg(entry.name, PokitDeviceRegistry::key(entry.info));
+        Q_EMIT q->deviceRemoved(entry);
+    }
+    return (int)removed.size();
+}
+
+/*!
+ * Handles PokitDiscoveryAgent::pokitDeviceDiscovered signals, by registering \a info as seen just now.
+ */
+void PokitDeviceRegistryPrivate::deviceDiscovered(const QBluetoothDeviceInfo &info)
+{
+    seen(info, QDateTime::currentMSecsSinceEpoch());
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+/*!
+ * Handles PokitDiscoveryAgent::pokitDeviceUpdated signals, by registering \a info as seen just now. Currently \a
+ * updatedFields is unused, since all of the registry's fields are simply refreshed.
+ *
+ * \since Qt 5.12.0
+ */
+void PokitDeviceRegistryPrivate::deviceUpdated(
+    const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields)
+{
+    Q_UNUSED(updatedFields)
+    seen(info, QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+ * Handles (uncoalesced) QBluetoothDeviceDiscoveryAgent::deviceUpdated signals, by refreshing the last seen time of
+ * the device described by \a info, if registered. This keeps devices whose updates are coalesced away (such as those
+ * with steady RSSI) from being aged out, while still costing just one hash lookup per advertisement.
+ *
+ * \since Qt 5.12.0
+ */
+void PokitDeviceRegistryPrivate::advertisementReceived(const QBluetoothDeviceInfo &info)
+{
+    const auto iter = entries.find(PokitDeviceRegistry::key(info));
+    if (iter != entries.end()) {
+        iter->lastSeen = QDateTime::currentMSecsSinceEpoch();
+    }
+}
+#endif
+
+/*!
+ * Handles discovery \a error, by logging it, and retrying after the scan interval (but no sooner than
+ * #errorRetryInterval), if still running.
+ */
+void PokitDeviceRegistryPrivate::error(const QBluetoothDeviceDiscoveryAgent::Error error)
+{
+    qCWarning(lc).noquote() << tr("Background scan error:") << error;
+    if (running) {
+        scanTimer.start((int)qMax(scanInterval, errorRetryInterval));
+    }
+}
+
+/*!
+ * Handles the end of each scan, by scheduling the next scan, if still running.
+ */
+void PokitDeviceRegistryPrivate::finished()
+{
+    qCDebug(lc).noquote() << tr("Background scan finished; %Ln device(s) registered.", nullptr, (int)entries.size());
+    if (running) {
+        scanTimer.start((int)scanInterval);
+    }
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
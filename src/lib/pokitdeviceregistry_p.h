@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitDeviceRegistryPrivate class.
+ */
+
+#ifndef QTPOKIT_POKITDEVICEREGISTRY_P_H
+#define QTPOKIT_POKITDEVICEREGISTRY_P_H
+
+#include <qtpokit/pokitdeviceregistry.h>
+
+#include <QBluetoothDeviceDiscoveryAgent>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QTimer>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT PokitDeviceRegistryPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.ble.registry", QtInfoMsg); ///< Logging category.
+
+    static constexpr quint32 errorRetryInterval { 5000 }; ///< Minimum milliseconds before rescanning after an error.
+
+    PokitDiscoveryAgent * agent { nullptr };           ///< Agent for (periodic) device discovery.
+    QHash<QString, PokitDeviceRegistry::Entry> entries; ///< Registered devices, by PokitDeviceRegistry::key().
+    quint32 scanDuration { 10000 };  ///< Duration of each scan, in milliseconds, or 0 to scan continuously.
+    quint32 scanInterval { 20000 };  ///< Idle time between scans, in milliseconds.
+    quint32 maximumAge { 60000 };    ///< Milliseconds since last seen, before ageing out, or 0 to never age out.
+    bool running { false };          ///< Whether the registry is (periodically) scanning.
+    QTimer scanTimer;                ///< Times the idle period between scans.
+    QTimer ageTimer;                 ///< Periodically ages out devices no longer seen.
+
+    explicit PokitDeviceRegistryPrivate(PokitDeviceRegistry * const q);
+
+    void setAgent(PokitDiscoveryAgent * const newAgent);
+    void startScan();
+    void seen(const QBluetoothDeviceInfo &info, const qint64 now);
+    int ageOut(const qint64 now);
+
+public Q_SLOTS:
+    void deviceDiscovered(const QBluetoothDeviceInfo &info);
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    void deviceUpdated(const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields);
+    void advertisementReceived(const QBluetoothDeviceInfo &info);
+    #endif
+    void error(const QBluetoothDeviceDiscoveryAgent::Error error);
+    void finished();
+
+protected:
+    PokitDeviceRegistry * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(PokitDeviceRegistry)
+    Q_DISABLE_COPY(PokitDeviceRegistryPrivate)
+    QTPOKIT_BEFRIEND_TEST(PokitDeviceRegistry)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POKITDEVICEREGISTRY_P_H
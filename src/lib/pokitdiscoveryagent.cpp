@@ -9,12 +9,30 @@
 #include <qtpokit/pokitdiscoveryagent.h>
 #include <qtpokit/pokitproducts.h>
 #include "pokitdiscoveryagent_p.h"
+#include "../stringliterals_p.h"
 
 #include <qtpokit/statusservice.h>
 
 #include <QBluetoothUuid>
 
+#ifdef QTPOKIT_BLUEZ_SCAN_FILTER
+#include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QDBusObjectPath>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusReply>
+
+/// BlueZ interfaces, and their properties, as returned by org.freedesktop.DBus.ObjectManager.GetManagedObjects.
+typedef QMap<QString, QVariantMap> BluezInterfaceList;
+/// BlueZ objects, and their interfaces, as returned by org.freedesktop.DBus.ObjectManager.GetManagedObjects.
+typedef QMap<QDBusObjectPath, BluezInterfaceList> BluezManagedObjectList;
+Q_DECLARE_METATYPE(BluezInterfaceList)
+Q_DECLARE_METATYPE(BluezManagedObjectList)
+#endif
+
 QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
 
 /*!
  * \class PokitDiscoveryAgent
@@ -23,6 +41,17 @@ QTPOKIT_BEGIN_NAMESPACE
  *
  * After constructing a PokitDiscoveryAgent object, and subscribing to the relevant signals,
  * invoke start() to begin discovery.
+ *
+ * Where the platform allows it (currently, Linux with BlueZ 5, when built with Qt D-Bus), the scan is also filtered by
+ * the OS, to only those devices advertising a Pokit status service (see StatusService::ServiceUuids), so that busy RF
+ * environments do not flood the application with irrelevant advertisements. Either way, every discovered device is
+ * still checked via isPokitProduct(), so platforms (and adapters) without such filtering behave just the same.
+ *
+ * Since platforms typically report a device update for every advertisement received, pokitDeviceUpdated() is
+ * coalesced per device: RSSI may be smoothed via an exponential moving average (see setRssiSmoothing()), updates that
+ * change nothing meaningful (see setRssiThreshold()) are dropped, and updates may be limited to one per device per
+ * updateInterval(), with the most recent state of any held back updates emitted once that interval elapses. By
+ * default, only exact duplicates are dropped.
  */
 
 /*!
@@ -34,7 +63,8 @@ PokitDiscoveryAgent::PokitDiscoveryAgent(
     : QBluetoothDeviceDiscoveryAgent(deviceAdapter, parent),
       d_ptr(new PokitDiscoveryAgentPrivate(this))
 {
-
+    Q_D(PokitDiscoveryAgent);
+    d->adapterAddress = deviceAdapter;
 }
 
 /*!
@@ -57,7 +87,7 @@ PokitDiscoveryAgent::PokitDiscoveryAgent(
     QObject * const parent)
     : QBluetoothDeviceDiscoveryAgent(deviceAdapter, parent), d_ptr(d)
 {
-
+    d->adapterAddress = deviceAdapter;
 }
 
 /*!
@@ -79,6 +109,79 @@ PokitDiscoveryAgent::~PokitDiscoveryAgent()
     delete d_ptr;
 }
 
+/*!
+ * Returns the address of the local Bluetooth adapter this agent scans with, or a null address for the default adapter.
+ *
+ * Hosts with more than one Bluetooth adapter may scan with one agent per adapter, and feed each agent's discoveries to
+ * PokitConnectionManager::updateRssi(), so that connections are made via the adapter with the strongest signal.
+ */
+QBluetoothAddress PokitDiscoveryAgent::adapterAddress() const
+{
+    Q_D(const PokitDiscoveryAgent);
+    return d->adapterAddress;
+}
+
+/*!
+ * Returns the minimum number of milliseconds between pokitDeviceUpdated() signals for each device, or 0 for no limit.
+ */
+quint32 PokitDiscoveryAgent::updateInterval() const
+{
+    Q_D(const PokitDiscoveryAgent);
+    return d->updateInterval;
+}
+
+/*!
+ * Sets the minimum number of milliseconds between pokitDeviceUpdated() signals for each device to \a interval.
+ *
+ * Updates arriving sooner are held back, and merged with any later updates, until \a interval has elapsed since the
+ * device's previous update (or discovery). An \a interval of 0 (the default) emits updates as soon as they arrive.
+ */
+void PokitDiscoveryAgent::setUpdateInterval(const quint32 interval)
+{
+    Q_D(PokitDiscoveryAgent);
+    d->updateInterval = interval;
+}
+
+/*!
+ * Returns the weight given to each new RSSI, in the exponential moving average reported by pokitDeviceUpdated().
+ */
+float PokitDiscoveryAgent::rssiSmoothing() const
+{
+    Q_D(const PokitDiscoveryAgent);
+    return d->rssiSmoothing;
+}
+
+/*!
+ * Sets the weight given to each new RSSI, in the exponential moving average reported by pokitDeviceUpdated(), to \a
+ * smoothing. A \a smoothing of 1 (the default) disables smoothing, while smaller values smooth more heavily, such as
+ * `0.25` to average (roughly) the last 7 advertisements. Values are clamped to the range (0,1].
+ */
+void PokitDiscoveryAgent::setRssiSmoothing(const float smoothing)
+{
+    Q_D(PokitDiscoveryAgent);
+    d->rssiSmoothing = qBound(0.01f, smoothing, 1.0f);
+}
+
+/*!
+ * Returns the largest change in (smoothed) RSSI, in dBm, that is not worth reporting on its own.
+ */
+quint16 PokitDiscoveryAgent::rssiThreshold() const
+{
+    Q_D(const PokitDiscoveryAgent);
+    return d->rssiThreshold;
+}
+
+/*!
+ * Sets the largest change in (smoothed) RSSI, in dBm, that is not worth reporting on its own to \a threshold. That
+ * is, device updates are only emitted if the RSSI has changed by more than \a threshold since the device's previous
+ * update, or if any other fields have changed. A \a threshold of 0 (the default) drops only unchanged updates.
+ */
+void PokitDiscoveryAgent::setRssiThreshold(const quint16 threshold)
+{
+    Q_D(PokitDiscoveryAgent);
+    d->rssiThreshold = threshold;
+}
+
 /*!
  * Starts Pokit device discovery.
  *
@@ -90,7 +193,12 @@ void PokitDiscoveryAgent::start(QBluetoothDeviceDiscoveryAgent::DiscoveryMethods
     Q_D(PokitDiscoveryAgent);
     Q_ASSERT(methods == QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
     qCDebug(d->lc).noquote() << tr("Scanning for Bluetooth Low Energy devices.");
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    d->devices.clear();
+    d->flushTimer.stop();
+    #endif
     QBluetoothDeviceDiscoveryAgent::start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    d->applyScanFilter();
 }
 
 /*!
@@ -100,7 +208,12 @@ void PokitDiscoveryAgent::start()
 {
     Q_D(PokitDiscoveryAgent);
     qCDebug(d->lc).noquote() << tr("Scanning for Bluetooth Low Energy devices.");
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    d->devices.clear();
+    d->flushTimer.stop();
+    #endif
     QBluetoothDeviceDiscoveryAgent::start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    d->applyScanFilter();
 }
 
 /*!
@@ -113,7 +226,10 @@ void PokitDiscoveryAgent::start()
  * \fn void PokitDiscoveryAgent::pokitDeviceUpdated(const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields)
  *
  * This signal is emitted when the Pokit device described by \a info is updated. The
- * \a updatedFields flags tell which information has been updated.
+ * \a updatedFields flags tell which information has been updated, since this device's previous update (or discovery).
+ *
+ * Updates are coalesced per device, according to updateInterval(), rssiSmoothing() and rssiThreshold(), so \a info
+ * reports the (possibly smoothed) RSSI, and the most recent values of all other fields.
  */
 
 /*!
@@ -152,8 +268,197 @@ PokitDiscoveryAgentPrivate::PokitDiscoveryAgentPrivate(PokitDiscoveryAgent * con
 
     connect(q, &QBluetoothDeviceDiscoveryAgent::finished,
             this, &PokitDiscoveryAgentPrivate::finished);
+
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    clock.start();
+    flushTimer.setSingleShot(true);
+    connect(&flushTimer, &QTimer::timeout, this, [this]() { flushDevices(clock.elapsed()); });
+    #endif
+}
+
+/*!
+ * Returns the OS-level scan filter to apply, in the form of BlueZ's `org.bluez.Adapter1.SetDiscoveryFilter` argument.
+ * That is, Bluetooth Low Energy transport only, and only devices advertising a Pokit Meter, or Pokit Pro, status
+ * service.
+ */
+QVariantMap PokitDiscoveryAgentPrivate::scanFilter()
+{
+    return QVariantMap{
+        { u"Transport"_s, u"le"_s },
+        { u"UUIDs"_s, QStringList{
+            StatusService::ServiceUuids::pokitMeter.toString(QUuid::WithoutBraces),
+            StatusService::ServiceUuids::pokitPro.toString(QUuid::WithoutBraces),
+        }},
+    };
+}
+
+/*!
+ * Narrows the (just started) scan to only Pokit devices, via the OS, where supported.
+ *
+ * Qt provides no API for filtering scans by service UUID, so with BlueZ, this replaces the (transport-only) discovery
+ * filter Qt has just set with scanFilter(), via D-Bus. Since both share the system bus connection, BlueZ treats this
+ * as the same discovery client, and applies the new filter to the discovery already in progress. Failures are only
+ * logged, since the post-filter in deviceDiscovered() and deviceUpdated() still applies.
+ */
+void PokitDiscoveryAgentPrivate::applyScanFilter() const
+{
+    #ifdef QTPOKIT_BLUEZ_SCAN_FILTER
+    Q_Q(const PokitDiscoveryAgent);
+    if (!q->isActive()) {
+        return; // Failed to start, so nothing to filter.
+    }
+    qDBusRegisterMetaType<BluezInterfaceList>();
+    qDBusRegisterMetaType<BluezManagedObjectList>();
+    QDBusConnection bus = QDBusConnection::systemBus();
+
+    // Find the adapter Qt is scanning with (the first, if no specific adapter was requested, as Qt does).
+    const QString adapterInterface = u"org.bluez.Adapter1"_s;
+    const QDBusReply<BluezManagedObjectList> objects = bus.call(QDBusMessage::createMethodCall(u"org.bluez"_s,
+        u"/"_s, u"org.freedesktop.DBus.ObjectManager"_s, u"GetManagedObjects"_s), QDBus::Block, 1000);
+    if (!objects.isValid()) {
+        qCDebug(lc).noquote() << tr("Not filtering scan by service UUID:") << objects.error().message();
+        return;
+    }
+    QString adapterPath;
+    const BluezManagedObjectList objectList = objects.value();
+    for (auto iter = objectList.constBegin(); iter != objectList.constEnd(); ++iter) {
+        if ((iter->contains(adapterInterface)) && ((adapterAddress.isNull()) ||
+            (iter->value(adapterInterface).value(u"Address"_s).toString() == adapterAddress.toString()))) {
+            adapterPath = iter.key().path();
+            break;
+        }
+    }
+    if (adapterPath.isEmpty()) {
+        qCDebug(lc).noquote() << tr("Not filtering scan by service UUID: no BlueZ adapter found.");
+        return;
+    }
+
+    QDBusMessage request = QDBusMessage::createMethodCall(u"org.bluez"_s, adapterPath, adapterInterface,
+        u"SetDiscoveryFilter"_s);
+    request << scanFilter();
+    auto * const watcher = new QDBusPendingCallWatcher(bus.asyncCall(request), q_ptr);
+    connect(watcher, &QDBusPendingCallWatcher::finished, watcher, [adapterPath](QDBusPendingCallWatcher * const call) {
+        const QDBusPendingReply<> reply = *call;
+        if (reply.isError()) {
+            qCDebug(lc).noquote() << tr("Failed to filter scan by service UUID:") << reply.error().message();
+        } else {
+            qCDebug(lc).noquote() << tr("Filtering scan, on %1, by Pokit service UUIDs.").arg(adapterPath);
+        }
+        call->deleteLater();
+    });
+    #endif
+}
+
+/*!
+ * Returns a key uniquely identifying the device described by \a info. That is, its address, or on platforms that
+ * do not expose device addresses (ie macOS), its UUID.
+ */
+QString PokitDiscoveryAgentPrivate::deviceKey(const QBluetoothDeviceInfo &info)
+{
+    return (info.address().isNull()) ? info.deviceUuid().toString() : info.address().toString();
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+/*!
+ * Starts coalescing updates for the device described by \a info, discovered at #clock time \a now, replacing any
+ * previous record of this device.
+ */
+void PokitDiscoveryAgentPrivate::addDevice(const QBluetoothDeviceInfo &info, const qint64 now)
+{
+    devices.insert(deviceKey(info), { info, (float)info.rssi(), info.rssi(), now, {} });
 }
 
+/*!
+ * Merges \a info, with \a updatedFields, received at #clock time \a now, into the device's record, then emits
+ * PokitDiscoveryAgent::pokitDeviceUpdated() if anything meaningful has changed, and the device's update interval has
+ * elapsed. Returns \c true if the update was emitted, or \c false if it was dropped, or held back.
+ *
+ * Updates for devices not yet seen (such as those discovered before the current scan started) are always emitted.
+ */
+bool PokitDiscoveryAgentPrivate::updateDevice(
+    const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields, const qint64 now)
+{
+    const auto iter = devices.find(deviceKey(info));
+    if (iter == devices.end()) {
+        addDevice(info, now);
+        Q_Q(PokitDiscoveryAgent);
+        Q_EMIT q->pokitDeviceUpdated(info, updatedFields);
+        return true;
+    }
+
+    DeviceRecord &record = *iter;
+    if (updatedFields.testFlag(QBluetoothDeviceInfo::Field::RSSI)) {
+        record.smoothedRssi = (rssiSmoothing * info.rssi()) + ((1.0f - rssiSmoothing) * record.smoothedRssi);
+    }
+    record.info = info;
+    record.info.setRssi((qint16)qRound(record.smoothedRssi));
+    updatedFields.setFlag(QBluetoothDeviceInfo::Field::RSSI, false);
+    record.pendingFields |= updatedFields;
+    if (qAbs(record.info.rssi() - record.emittedRssi) > rssiThreshold) {
+        record.pendingFields |= QBluetoothDeviceInfo::Field::RSSI;
+    }
+
+    if (!record.pendingFields) {
+        return false; // Nothing meaningful has changed.
+    }
+    if (now - record.emittedAt < updateInterval) {
+        if (!flushTimer.isActive()) {
+            flushTimer.start((int)(updateInterval - (now - record.emittedAt)));
+        }
+        return false; // Held back until the interval elapses.
+    }
+    emitDevice(record, now);
+    return true;
+}
+
+/*!
+ * Emits any held back device updates whose update interval has elapsed by #clock time \a now, or all held back
+ * updates if \a force is \c true, then restarts #flushTimer for any that remain.
+ */
+void PokitDiscoveryAgentPrivate::flushDevices(const qint64 now, const bool force)
+{
+    QStringList due;
+    qint64 next = -1;
+    for (auto iter = devices.constBegin(); iter != devices.constEnd(); ++iter) {
+        if (!iter->pendingFields) {
+            continue;
+        }
+        const qint64 remaining = updateInterval - (now - iter->emittedAt);
+        if ((force) || (remaining <= 0)) {
+            due.append(iter.key());
+        } else if ((next < 0) || (remaining < next)) {
+            next = remaining;
+        }
+    }
+    if (next >= 0) {
+        flushTimer.start((int)next);
+    }
+    for (const QString &key: due) {
+        // Look each device up again, since slots connected to previous emissions may have restarted the scan.
+        const auto iter = devices.find(key);
+        if ((iter != devices.end()) && (iter->pendingFields)) {
+            emitDevice(*iter, now);
+        }
+    }
+}
+
+/*!
+ * Emits PokitDiscoveryAgent::pokitDeviceUpdated() for \a record's pending fields, as of #clock time \a now.
+ */
+void PokitDiscoveryAgentPrivate::emitDevice(DeviceRecord &record, const qint64 now)
+{
+    const QBluetoothDeviceInfo info = record.info; // Copied, in case connected slots modify #devices.
+    const QBluetoothDeviceInfo::Fields fields = record.pendingFields;
+    record.pendingFields = QBluetoothDeviceInfo::Fields();
+    record.emittedRssi = info.rssi();
+    record.emittedAt = now;
+    qCDebug(lc).noquote() << tr(R"(Pokit device "%1" at %2 updated with RSSI %3.)")
+        .arg(info.name(), info.address().toString()).arg(info.rssi());
+    Q_Q(PokitDiscoveryAgent);
+    Q_EMIT q->pokitDeviceUpdated(info, fields);
+}
+#endif
+
 /*!
  * Handle scan canceled signals, by simply logging the event for diagnostic purposes.
  */
@@ -173,6 +478,9 @@ void PokitDiscoveryAgentPrivate::deviceDiscovered(const QBluetoothDeviceInfo &in
     if (!isPokitProduct(info)) return;
     qCDebug(lc).noquote() << tr(R"(Discovered Pokit device "%1" at %2.)")
         .arg(info.name(), info.address().toString());
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    addDevice(info, clock.elapsed());
+    #endif
     Q_EMIT q->pokitDeviceDiscovered(info);
 }
 
@@ -180,18 +488,16 @@ void PokitDiscoveryAgentPrivate::deviceDiscovered(const QBluetoothDeviceInfo &in
 /*!
  * Handle deviceUpdated signals.
  *
- * Here we simply check if \a info describes a Pokit device, and if so, emit pokitDeviceUpdated().
+ * Here we check if \a info describes a Pokit device, and if so, coalesce it into the device's record via
+ * updateDevice(), which emits pokitDeviceUpdated() as appropriate.
  *
  * \since Qt 5.12.0
  */
 void PokitDiscoveryAgentPrivate::deviceUpdated(
     const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields)
 {
-    Q_Q(PokitDiscoveryAgent);
     if (!isPokitProduct(info)) return;
-    qCDebug(lc).noquote() << tr(R"(Pokit device "%1" at %2 updated with RSSI %3.)")
-        .arg(info.name(), info.address().toString()).arg(info.rssi());
-    Q_EMIT q->pokitDeviceUpdated(info, updatedFields);
+    updateDevice(info, updatedFields, clock.elapsed());
 }
 #endif
 
@@ -204,11 +510,16 @@ void PokitDiscoveryAgentPrivate::error(const QBluetoothDeviceDiscoveryAgent::Err
 }
 
 /*!
- * Handle scan finished signals, by simply logging the event for diagnostic purposes.
+ * Handle scan finished signals, by emitting any held back device updates, and logging the event for diagnostic
+ * purposes.
  */
-void PokitDiscoveryAgentPrivate::finished() const
+void PokitDiscoveryAgentPrivate::finished()
 {
     qCDebug(lc).noquote() << tr("Pokit device scan finished.");
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    flushTimer.stop();
+    flushDevices(clock.elapsed(), true);
+    #endif
 }
 
 /// \endcond
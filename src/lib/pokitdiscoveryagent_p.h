@@ -11,9 +11,14 @@
 
 #include <qtpokit/qtpokit_global.h>
 
+#include <QBluetoothAddress>
 #include <QBluetoothDeviceDiscoveryAgent>
 #include <QBluetoothDeviceInfo>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QLoggingCategory>
+#include <QTimer>
+#include <QVariantMap>
 
 QTPOKIT_BEGIN_NAMESPACE
 
@@ -26,8 +31,38 @@ class QTPOKIT_EXPORT PokitDiscoveryAgentPrivate : public QObject
 public:
     static Q_LOGGING_CATEGORY(lc, "pokit.ble.discovery", QtInfoMsg); ///< Logging category.
 
+    QBluetoothAddress adapterAddress; ///< Address of the local adapter to scan with, or null for the default adapter.
+    quint32 updateInterval { 0 };     ///< Minimum milliseconds between updates emitted for each device.
+    float rssiSmoothing { 1.0f };     ///< Weight of each new RSSI in the moving average, from (0,1].
+    quint16 rssiThreshold { 0 };      ///< Change in (smoothed) RSSI, in dBm, that is not worth emitting.
+
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    /// Coalesced state of a single discovered device.
+    struct DeviceRecord {
+        QBluetoothDeviceInfo info;                  ///< Latest device info, with smoothed RSSI.
+        float smoothedRssi { 0.0f };                ///< Exponential moving average of the device's RSSI.
+        qint16 emittedRssi { 0 };                   ///< RSSI most recently emitted, or discovered.
+        qint64 emittedAt { 0 };                     ///< #clock time of the most recent emission, or discovery.
+        QBluetoothDeviceInfo::Fields pendingFields; ///< Fields updated since the most recent emission.
+    };
+    QHash<QString, DeviceRecord> devices; ///< Coalesced state of discovered devices, by deviceKey().
+    QElapsedTimer clock;                  ///< Monotonic clock for rate limiting updates.
+    QTimer flushTimer;                    ///< Timer for emitting updates held back by #updateInterval.
+    #endif
+
     explicit PokitDiscoveryAgentPrivate(PokitDiscoveryAgent * const q);
 
+    static QVariantMap scanFilter();
+    void applyScanFilter() const;
+
+    static QString deviceKey(const QBluetoothDeviceInfo &info);
+    #if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    void addDevice(const QBluetoothDeviceInfo &info, const qint64 now);
+    bool updateDevice(const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields, const qint64 now);
+    void flushDevices(const qint64 now, const bool force = false);
+    void emitDevice(DeviceRecord &record, const qint64 now);
+    #endif
+
 public Q_SLOTS:
     void canceled() const;
     void deviceDiscovered(const QBluetoothDeviceInfo &info);
@@ -35,7 +70,7 @@ public Q_SLOTS:
     void deviceUpdated(const QBluetoothDeviceInfo &info, QBluetoothDeviceInfo::Fields updatedFields);
     #endif
     void error(const QBluetoothDeviceDiscoveryAgent::Error error) const;
-    void finished() const;
+    void finished();
 
 protected:
     PokitDiscoveryAgent * q_ptr; ///< Internal q-pointer.
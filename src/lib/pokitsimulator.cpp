@@ -0,0 +1,692 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the PokitSimulator and PokitSimulatorPrivate classes.
+ */
+
+#include <qtpokit/pokitsimulator.h>
+#include "pokitsimulator_p.h"
+
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/statusservice.h>
+
+#include <QDataStream>
+#include <QtEndian>
+#include <QtMath> // For M_PI, on all platforms.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class PokitSimulator
+ *
+ * The PokitSimulator class simulates a Pokit device, behind a PokitDevice's Multimeter, DSO, Data Logger, and Status
+ * services, so those services, and everything built on them, can be exercised without any Bluetooth hardware, and at
+ * rates (and payload sizes) well beyond what real devices support.
+ *
+ * Once started, the simulator handles each service's GATT requests, in place of the services' QLowEnergyService
+ * objects, and then emits each service's serviceDetailsDiscovered signal, as if the device had just connected.
+ * Requests are acknowledged after latency() milliseconds. Settings writes are decoded, and acted on as a device would:
+ * multimeter readings are notified every update interval (once reading notifications are enabled), DSO settings start
+ * a capture (whose metadata, then samples, are notified once the sampling window has passed), and Data Logger
+ * `Refresh` commands start a transfer of loggedSamples() samples. Characteristic values are delivered via the same
+ * parsing, and signals, as real devices' values, so consumers cannot tell the difference.
+ *
+ * Each Stream's Profile sets its notification interval, jitter, sample payload size, and failure rate. Failed requests
+ * are finished unsuccessfully, while failed values are truncated to half their length, as if corrupted in transit.
+ * Random choices use a default-seeded generator, so runs are repeatable.
+ *
+ * The simulator must live in the same thread as the device's services.
+ */
+
+/*!
+ * Returns \a stream as a user presentable string.
+ */
+QString PokitSimulator::toString(const Stream stream)
+{
+    switch (stream) {
+    case Stream::Multimeter: return tr("Multimeter");
+    case Stream::Dso:        return tr("DSO");
+    case Stream::DataLogger: return tr("Data Logger");
+    case Stream::Status:     return tr("Status");
+    }
+    return QString();
+}
+
+/*!
+ * Constructs a new PokitSimulator object that simulates \a device, with \a parent.
+ */
+PokitSimulator::PokitSimulator(PokitDevice * const device, QObject * parent)
+    : QObject(parent), d_ptr(new PokitSimulatorPrivate(this))
+{
+    Q_D(PokitSimulator);
+    d->device = device;
+}
+
+/*!
+ * \cond internal
+ * Constructs a new PokitSimulator object with \a device, \a parent, and private implementation \a d.
+ */
+PokitSimulator::PokitSimulator(
+    PokitSimulatorPrivate * const d, PokitDevice * const device, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->device = device;
+}
+/// \endcond
+
+/*!
+ * Destroys this PokitSimulator object, stopping the simulation first, if running.
+ */
+PokitSimulator::~PokitSimulator()
+{
+    stop();
+    delete d_ptr;
+}
+
+/*!
+ * Returns the device being simulated.
+ */
+PokitDevice * PokitSimulator::device() const
+{
+    Q_D(const PokitSimulator);
+    return d->device;
+}
+
+/*!
+ * Returns the Pokit product being simulated.
+ */
+PokitProduct PokitSimulator::product() const
+{
+    Q_D(const PokitSimulator);
+    return d->product;
+}
+
+/*!
+ * Sets the Pokit product to simulate to \a product. The default is PokitProduct::PokitPro. The product determines
+ * the format of some characteristic values, such as `Status`, and Data Logger `Metadata`, and is set on each service
+ * by start().
+ */
+void PokitSimulator::setProduct(const PokitProduct product)
+{
+    Q_D(PokitSimulator);
+    d->product = product;
+}
+
+/*!
+ * Returns the profile of \a stream.
+ */
+PokitSimulator::Profile PokitSimulator::profile(const Stream stream) const
+{
+    Q_D(const PokitSimulator);
+    return d->profile(stream);
+}
+
+/*!
+ * Sets the profile of \a stream to \a profile.
+ *
+ * A zero Profile::interval selects each stream's default: the written update interval for multimeter readings, one
+ * second for status notifications, and back-to-back (that is, as fast as the event loop allows) for DSO and Data
+ * Logger sample notifications.
+ */
+void PokitSimulator::setProfile(const Stream stream, const Profile &profile)
+{
+    Q_D(PokitSimulator);
+    d->profiles.at(static_cast<size_t>(stream)) = profile;
+}
+
+/*!
+ * Returns the number of milliseconds before each request is acknowledged.
+ */
+quint32 PokitSimulator::latency() const
+{
+    Q_D(const PokitSimulator);
+    return d->latency;
+}
+
+/*!
+ * Sets the number of milliseconds before each request is acknowledged to \a latency. The default is `0`, which still
+ * acknowledges requests asynchronously, as real devices do.
+ */
+void PokitSimulator::setLatency(const quint32 latency)
+{
+    Q_D(PokitSimulator);
+    d->latency = latency;
+}
+
+/*!
+ * Returns the number of samples held by the simulated Data Logger, as transferred by each `Refresh` command.
+ */
+quint16 PokitSimulator::loggedSamples() const
+{
+    Q_D(const PokitSimulator);
+    return d->loggedSamples;
+}
+
+/*!
+ * Sets the number of samples held by the simulated Data Logger to \a samples. The default is `1000`.
+ */
+void PokitSimulator::setLoggedSamples(const quint16 samples)
+{
+    Q_D(PokitSimulator);
+    d->loggedSamples = samples;
+}
+
+/*!
+ * Returns \c true if the simulation is running, otherwise \c false.
+ */
+bool PokitSimulator::isRunning() const
+{
+    Q_D(const PokitSimulator);
+    return d->running;
+}
+
+/*!
+ * Returns the simulation's statistics since it was last started.
+ */
+PokitSimulator::Statistics PokitSimulator::statistics() const
+{
+    Q_D(const PokitSimulator);
+    return d->statistics;
+}
+
+/*!
+ * Starts simulating the device, by handling its Multimeter, DSO, Data Logger, and Status services' requests, and then
+ * (asynchronously) emitting each service's serviceDetailsDiscovered signal.
+ */
+void PokitSimulator::start()
+{
+    Q_D(PokitSimulator);
+    if ((d->running) || (!d->device)) {
+        return;
+    }
+    qCInfo(d->lc).noquote() << tr("Simulating %1 device.").arg(QTPOKIT_PREPEND_NAMESPACE(toString)(d->product));
+    d->running = true;
+    d->statistics = Statistics{};
+    const QVector<AbstractPokitService *> services = d->services();
+    for (int index = 0; index < services.size(); ++index) {
+        const QPointer<AbstractPokitService> service = services.at(index);
+        const Stream stream = static_cast<Stream>(index);
+        service->setPokitProduct(d->product);
+        PokitSimulatorPrivate::servicePrivate(service)->requestHandler =
+            [d, service, stream](const AbstractPokitServicePrivate::Request &request) {
+                d->handleRequest(service, stream, request);
+            };
+        QTimer::singleShot(0, service.data(), [service]() { Q_EMIT service->serviceDetailsDiscovered(); });
+    }
+}
+
+/*!
+ * Stops simulating the device. Any in-flight requests are finished as failures, since they will never be
+ * acknowledged now, while later requests are issued to the services' QLowEnergyService objects (if any) as usual.
+ */
+void PokitSimulator::stop()
+{
+    Q_D(PokitSimulator);
+    if (!std::exchange(d->running, false)) {
+        return;
+    }
+    qCDebug(d->lc).noquote() << tr("Stopping simulation.");
+    d->meterTimer.stop();
+    d->dsoTimer.stop();
+    d->loggerTimer.stop();
+    d->statusTimer.stop();
+    d->notifying.clear();
+    for (AbstractPokitService * const service: d->services()) {
+        AbstractPokitServicePrivate * const serviceImpl = PokitSimulatorPrivate::servicePrivate(service);
+        serviceImpl->requestHandler = nullptr;
+        if (serviceImpl->inFlight) {
+            serviceImpl->finishRequest(false);
+        }
+    }
+}
+
+/*!
+ * \cond internal
+ * \class PokitSimulatorPrivate
+ *
+ * The PokitSimulatorPrivate class provides private implementation for PokitSimulator.
+ */
+
+/*!
+ * \internal
+ * Constructs a new PokitSimulatorPrivate object with public implementation \a q.
+ */
+PokitSimulatorPrivate::PokitSimulatorPrivate(PokitSimulator * const q) : q_ptr(q)
+{
+    for (QTimer * const timer: { &meterTimer, &dsoTimer, &loggerTimer, &statusTimer }) {
+        timer->setSingleShot(true); // Restarted by each tick, with a freshly jittered interval.
+    }
+    connect(&meterTimer, &QTimer::timeout, this, &PokitSimulatorPrivate::meterTick);
+    connect(&dsoTimer, &QTimer::timeout, this, &PokitSimulatorPrivate::dsoTick);
+    connect(&loggerTimer, &QTimer::timeout, this, &PokitSimulatorPrivate::loggerTick);
+    connect(&statusTimer, &QTimer::timeout, this, &PokitSimulatorPrivate::statusTick);
+}
+
+/*!
+ * Returns the simulated device's Multimeter, DSO, Data Logger, and Status services, in PokitSimulator::Stream order,
+ * or an empty vector if the device no longer exists.
+ */
+QVector<AbstractPokitService *> PokitSimulatorPrivate::services() const
+{
+    if (!device) {
+        return { };
+    }
+    return { device->multimeter(), device->dso(), device->dataLogger(), device->status() };
+}
+
+/*!
+ * Returns \a service's private implementation.
+ */
+AbstractPokitServicePrivate * PokitSimulatorPrivate::servicePrivate(AbstractPokitService * const service)
+{
+    return service->d_ptr;
+}
+
+/*!
+ * Returns the profile of \a stream.
+ */
+const PokitSimulator::Profile &PokitSimulatorPrivate::profile(const PokitSimulator::Stream stream) const
+{
+    return profiles.at(static_cast<size_t>(stream));
+}
+
+/*!
+ * Returns \c true, with probability of \a stream's failure rate, if the next request or value should fail.
+ */
+bool PokitSimulatorPrivate::roll(const PokitSimulator::Stream stream)
+{
+    const float rate = profile(stream).failureRate;
+    return (rate > 0.0f) && (std::uniform_real_distribution<float>(0.0f, 1.0f)(random) < rate);
+}
+
+/*!
+ * Returns the number of milliseconds until \a stream's next notification: \a stream's interval (or \a
+ * defaultInterval, if zero), randomly deviated by up to \a stream's jitter.
+ */
+int PokitSimulatorPrivate::nextInterval(const PokitSimulator::Stream stream, const quint32 defaultInterval)
+{
+    const PokitSimulator::Profile &streamProfile = profile(stream);
+    const qint64 interval = (streamProfile.interval == 0) ? defaultInterval : streamProfile.interval;
+    const qint64 jitter = (streamProfile.jitter == 0) ? 0 :
+        std::uniform_int_distribution<qint64>(-(qint64)streamProfile.jitter, streamProfile.jitter)(random);
+    return (int)std::clamp<qint64>(interval + jitter, 0, std::numeric_limits<int>::max());
+}
+
+/*!
+ * Returns the number of sample bytes per \a stream notification, which is always a whole number of samples.
+ */
+int PokitSimulatorPrivate::payloadSize(const PokitSimulator::Stream stream) const
+{
+    const int size = (profile(stream).payloadSize == 0) ? defaultPayloadSize : profile(stream).payloadSize;
+    return std::max(size - (size % 2), 2);
+}
+
+/*!
+ * Handles \a stream's \a request for \a service, by acknowledging it after #latency milliseconds (or failing it, with
+ * probability of \a stream's failure rate), and then acting on it as a real device would.
+ */
+void PokitSimulatorPrivate::handleRequest(const QPointer<AbstractPokitService> &service,
+                                          const PokitSimulator::Stream stream,
+                                          const AbstractPokitServicePrivate::Request &request)
+{
+    ++statistics.requests;
+    const bool fail = roll(stream);
+    QTimer::singleShot((int)latency, this, [this, service, request, fail]() {
+        if (!service) {
+            return;
+        }
+        AbstractPokitServicePrivate * const serviceImpl = servicePrivate(service);
+        if ((!serviceImpl->requestHandler) || (!serviceImpl->inFlight) ||
+            (serviceImpl->inFlight->id != request.id)) {
+            return; // Stopped (and so already finished) in the meantime.
+        }
+        if (fail) {
+            qCDebug(lc).noquote() << tr("Failing request %1.").arg(request.id);
+            ++statistics.failedRequests;
+            serviceImpl->finishRequest(false);
+            return;
+        }
+        serviceImpl->finishRequest(true);
+        switch (request.type) {
+        case AbstractPokitServicePrivate::Request::Type::ReadCharacteristic:
+            readCharacteristic(service, request.characteristic);
+            break;
+        case AbstractPokitServicePrivate::Request::Type::WriteCharacteristic:
+            writeCharacteristic(service, request.characteristic, request.value);
+            break;
+        case AbstractPokitServicePrivate::Request::Type::WriteDescriptor:
+            writeDescriptor(request.characteristic, (!request.value.isEmpty()) && (request.value.at(0) != 0));
+            break;
+        }
+    });
+}
+
+/*!
+ * Acts on \a value having been written to \a service's \a uuid characteristic, then emits the relevant signal.
+ */
+void PokitSimulatorPrivate::writeCharacteristic(AbstractPokitService * const service, const QBluetoothUuid &uuid,
+                                                const QByteArray &value)
+{
+    if (uuid == MultimeterService::CharacteristicUuids::settings) {
+        if (value.size() >= 6) {
+            meterSettings.mode           = static_cast<MultimeterService::Mode>(value.at(0));
+            meterSettings.range          = static_cast<quint8>(value.at(1));
+            meterSettings.updateInterval = qFromLittleEndian<quint32>(value.mid(2,4).constData());
+        }
+        Q_EMIT static_cast<MultimeterService *>(service)->settingsWritten();
+        if (meterTimer.isActive()) {
+            meterTimer.start(nextInterval(PokitSimulator::Stream::Multimeter, meterSettings.updateInterval));
+        }
+        return;
+    }
+
+    if (uuid == DsoService::CharacteristicUuids::settings) {
+        if (value.size() >= 13) {
+            dsoSettings.command         = static_cast<DsoService::Command>(value.at(0));
+            dsoSettings.triggerLevel    = qFromLittleEndian<float>(value.mid(1,4).constData());
+            dsoSettings.mode            = static_cast<DsoService::Mode>(value.at(5));
+            dsoSettings.range           = static_cast<quint8>(value.at(6));
+            dsoSettings.samplingWindow  = qFromLittleEndian<quint32>(value.mid(7,4).constData());
+            dsoSettings.numberOfSamples = qFromLittleEndian<quint16>(value.mid(11,2).constData());
+        }
+        Q_EMIT static_cast<DsoService *>(service)->settingsWritten();
+        dsoPending = (dsoSettings.mode != DsoService::Mode::Idle);
+        startDsoCapture();
+        return;
+    }
+
+    if (uuid == DataLoggerService::CharacteristicUuids::settings) {
+        const DataLoggerService::Command command = (value.isEmpty())
+            ? DataLoggerService::Command::Stop : static_cast<DataLoggerService::Command>(value.at(0));
+        if ((command == DataLoggerService::Command::Start) && (value.size() >= 11)) {
+            loggerSettings.mode           = static_cast<DataLoggerService::Mode>(value.at(3));
+            loggerSettings.range          = static_cast<quint8>(value.at(4));
+            loggerSettings.updateInterval = (value.size() >= 13) // 32-bit milliseconds, else 16-bit seconds.
+                ? qFromLittleEndian<quint32>(value.mid(5,4).constData())
+                : qFromLittleEndian<quint16>(value.mid(5,2).constData()) * 1000;
+            loggerSettings.timestamp      = qFromLittleEndian<quint32>(value.right(4).constData());
+        }
+        Q_EMIT static_cast<DataLoggerService *>(service)->settingsWritten();
+        if (command == DataLoggerService::Command::Refresh) {
+            startLoggerTransfer();
+        }
+        return;
+    }
+
+    if (uuid == StatusService::CharacteristicUuids::name) {
+        Q_EMIT static_cast<StatusService *>(service)->deviceNameWritten();
+    } else if (uuid == StatusService::CharacteristicUuids::flashLed) {
+        Q_EMIT static_cast<StatusService *>(service)->deviceLedFlashed();
+    } else if (uuid == StatusService::CharacteristicUuids::torch) {
+        Q_EMIT static_cast<StatusService *>(service)->torchStatusWritten();
+    } else {
+        qCDebug(lc).noquote() << tr(R"(Ignoring write to characteristic %1 "%2".)")
+            .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+    }
+}
+
+/*!
+ * Records \a uuid's notifications as enabled, or not, according to \a enable, starting (or stopping) the relevant
+ * notification stream.
+ */
+void PokitSimulatorPrivate::writeDescriptor(const QBluetoothUuid &uuid, const bool enable)
+{
+    if (enable) {
+        notifying.insert(uuid);
+    } else {
+        notifying.remove(uuid);
+    }
+
+    if (uuid == MultimeterService::CharacteristicUuids::reading) {
+        if (enable) {
+            meterTimer.start(nextInterval(PokitSimulator::Stream::Multimeter, meterSettings.updateInterval));
+        } else {
+            meterTimer.stop();
+        }
+    } else if (uuid == DsoService::CharacteristicUuids::metadata) {
+        startDsoCapture();
+    } else if (uuid == StatusService::CharacteristicUuids::status) {
+        if (enable) {
+            statusTimer.start(nextInterval(PokitSimulator::Stream::Status, defaultStatusInterval));
+        } else {
+            statusTimer.stop();
+        }
+    }
+}
+
+/*!
+ * Delivers the current value of \a service's \a uuid characteristic, if simulated.
+ */
+void PokitSimulatorPrivate::readCharacteristic(AbstractPokitService * const service, const QBluetoothUuid &uuid)
+{
+    if (uuid == MultimeterService::CharacteristicUuids::reading) {
+        deliver(service, PokitSimulator::Stream::Multimeter, uuid, meterReading());
+    } else if (uuid == DsoService::CharacteristicUuids::metadata) {
+        deliver(service, PokitSimulator::Stream::Dso, uuid, dsoMetadata());
+    } else if (uuid == DataLoggerService::CharacteristicUuids::metadata) {
+        deliver(service, PokitSimulator::Stream::DataLogger, uuid, loggerMetadata());
+    } else if (uuid == StatusService::CharacteristicUuids::status) {
+        deliver(service, PokitSimulator::Stream::Status, uuid, statusValue());
+    } else {
+        qCDebug(lc).noquote() << tr(R"(Characteristic %1 "%2" is not simulated.)")
+            .arg(uuid.toString(), PokitDevice::charcteristicToString(uuid));
+    }
+}
+
+/*!
+ * Delivers \a value to \a service, as if notified (or read) for its \a uuid characteristic, first truncating \a value
+ * with probability of \a stream's failure rate.
+ */
+void PokitSimulatorPrivate::deliver(AbstractPokitService * const service, const PokitSimulator::Stream stream,
+                                    const QBluetoothUuid &uuid, QByteArray value)
+{
+    if (roll(stream)) {
+        qCDebug(lc).noquote() << tr("Truncating %Ln byte/s value.", nullptr, value.size());
+        value.truncate(value.size() / 2);
+        ++statistics.truncatedValues;
+    }
+    ++statistics.values;
+    statistics.bytes += value.size();
+    servicePrivate(service)->simulateValue(uuid, value);
+}
+
+/*!
+ * Returns the next multimeter `Reading` value: a slow sine wave, around 1 (volt, or amp, etc), in the current mode.
+ */
+QByteArray PokitSimulatorPrivate::meterReading()
+{
+    const float reading = 1.0f + 0.5f * (float)std::sin((double)(readings++) * 2.0 * M_PI / 50.0);
+    QByteArray value;
+    QDataStream stream(&value, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision); // 32-bit floats, not 64-bit.
+    stream << (quint8)MultimeterService::MeterStatus::AutoRangeOff << reading << (quint8)meterSettings.mode
+           << meterSettings.range;
+    Q_ASSERT(value.size() == 7);
+    return value;
+}
+
+/*!
+ * Returns the DSO `Metadata` value for the current capture.
+ */
+QByteArray PokitSimulatorPrivate::dsoMetadata() const
+{
+    const quint32 samplingRate = (dsoSettings.samplingWindow == 0) ? 0 :
+        (quint32)((quint64)dsoSettings.numberOfSamples * 1000000 / dsoSettings.samplingWindow);
+    QByteArray value;
+    QDataStream stream(&value, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision); // 32-bit floats, not 64-bit.
+    stream << (quint8)DsoService::DsoStatus::Done << 0.001f << (quint8)dsoSettings.mode << dsoSettings.range
+           << dsoSettings.samplingWindow << dsoSettings.numberOfSamples << samplingRate;
+    Q_ASSERT(value.size() == 17);
+    return value;
+}
+
+/*!
+ * Returns the Data Logger `Metadata` value for the logged samples, in the simulated product's format.
+ */
+QByteArray PokitSimulatorPrivate::loggerMetadata() const
+{
+    QByteArray value;
+    QDataStream stream(&value, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision); // 32-bit floats, not 64-bit.
+    stream << (quint8)DataLoggerService::LoggerStatus::Done << 0.001f << (quint8)loggerSettings.mode
+           << loggerSettings.range;
+    if (product == PokitProduct::PokitMeter) {
+        stream << (quint16)((loggerSettings.updateInterval + 500) / 1000) << loggedSamples
+               << loggerSettings.timestamp;
+        Q_ASSERT(value.size() == 15); // According to Pokit API 1.00.
+    } else {
+        stream << loggerSettings.updateInterval << loggedSamples << (quint32)0 << (quint16)0
+               << loggerSettings.timestamp;
+        Q_ASSERT(value.size() == 23); // As per Pokit Pro devices.
+    }
+    return value;
+}
+
+/*!
+ * Returns the `Status` value for an idle device, with a good battery, in the simulated product's format.
+ */
+QByteArray PokitSimulatorPrivate::statusValue() const
+{
+    QByteArray value;
+    QDataStream stream(&value, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision); // 32-bit floats, not 64-bit.
+    stream << (quint8)StatusService::DeviceStatus::Idle << 4.0f << (quint8)StatusService::BatteryStatus::Good;
+    if (product != PokitProduct::PokitMeter) {
+        stream << (quint8)StatusService::SwitchPosition::Voltage
+               << (quint8)StatusService::ChargingStatus::Discharging;
+    }
+    return value;
+}
+
+/*!
+ * Returns \a count encoded samples of a sine wave, with \a period samples per cycle, and an amplitude of 1000 (that
+ * is, 1 volt, or amp, etc, at the simulated scale of 1mV per sample).
+ */
+QByteArray PokitSimulatorPrivate::samples(const int count, const int period)
+{
+    QByteArray value(count * 2, '\0');
+    for (int index = 0; index < count; ++index) {
+        const qint16 sample = (qint16)std::lround(1000.0 * std::sin(index * 2.0 * M_PI / period));
+        qToLittleEndian<qint16>(sample, value.data() + (index * 2));
+    }
+    return value;
+}
+
+/*!
+ * Starts the pending DSO capture, if any, once metadata notifications are enabled. The capture's metadata is then
+ * notified after the capture's sampling window, followed by its samples.
+ */
+void PokitSimulatorPrivate::startDsoCapture()
+{
+    if ((!dsoPending) || (!notifying.contains(DsoService::CharacteristicUuids::metadata))) {
+        return;
+    }
+    dsoPending = false;
+    qCDebug(lc).noquote() << tr("Capturing %Ln DSO sample/s.", nullptr, dsoSettings.numberOfSamples);
+    dsoSamples = samples(dsoSettings.numberOfSamples, 64);
+    dsoMetadataDue = true;
+    dsoTimer.start((int)std::min<quint32>(dsoSettings.samplingWindow / 1000, 60000));
+}
+
+/*!
+ * Starts transferring the Data Logger's samples: first the metadata, then the samples.
+ */
+void PokitSimulatorPrivate::startLoggerTransfer()
+{
+    qCDebug(lc).noquote() << tr("Transferring %Ln logged sample/s.", nullptr, loggedSamples);
+    loggerSamples = samples(loggedSamples, 50);
+    loggerMetadataDue = true;
+    loggerTimer.start(nextInterval(PokitSimulator::Stream::DataLogger, 0));
+}
+
+/*!
+ * Notifies the next multimeter reading, then schedules the next.
+ */
+void PokitSimulatorPrivate::meterTick()
+{
+    if (!device) {
+        return;
+    }
+    deliver(device->multimeter(), PokitSimulator::Stream::Multimeter,
+            MultimeterService::CharacteristicUuids::reading, meterReading());
+    meterTimer.start(nextInterval(PokitSimulator::Stream::Multimeter, meterSettings.updateInterval));
+}
+
+/*!
+ * Notifies the DSO capture's metadata, or its next payload of samples, then schedules the next, if any. Samples are
+ * dropped (as a real device would) if reading notifications are not enabled.
+ */
+void PokitSimulatorPrivate::dsoTick()
+{
+    if (!device) {
+        return;
+    }
+    if (std::exchange(dsoMetadataDue, false)) {
+        deliver(device->dso(), PokitSimulator::Stream::Dso, DsoService::CharacteristicUuids::metadata, dsoMetadata());
+    } else {
+        const QByteArray payload = dsoSamples.left(payloadSize(PokitSimulator::Stream::Dso));
+        dsoSamples.remove(0, payload.size());
+        if (notifying.contains(DsoService::CharacteristicUuids::reading)) {
+            deliver(device->dso(), PokitSimulator::Stream::Dso, DsoService::CharacteristicUuids::reading, payload);
+        }
+    }
+    if (!dsoSamples.isEmpty()) {
+        dsoTimer.start(nextInterval(PokitSimulator::Stream::Dso, 0));
+    }
+}
+
+/*!
+ * Notifies the Data Logger transfer's metadata, or its next payload of samples, then schedules the next, if any.
+ * Samples are dropped (as a real device would) if reading notifications are not enabled.
+ */
+void PokitSimulatorPrivate::loggerTick()
+{
+    if (!device) {
+        return;
+    }
+    if (std::exchange(loggerMetadataDue, false)) {
+        if (notifying.contains(DataLoggerService::CharacteristicUuids::metadata)) {
+            deliver(device->dataLogger(), PokitSimulator::Stream::DataLogger,
+                    DataLoggerService::CharacteristicUuids::metadata, loggerMetadata());
+        }
+    } else {
+        const QByteArray payload = loggerSamples.left(payloadSize(PokitSimulator::Stream::DataLogger));
+        loggerSamples.remove(0, payload.size());
+        if (notifying.contains(DataLoggerService::CharacteristicUuids::reading)) {
+            deliver(device->dataLogger(), PokitSimulator::Stream::DataLogger,
+                    DataLoggerService::CharacteristicUuids::reading, payload);
+        }
+    }
+    if (!loggerSamples.isEmpty()) {
+        loggerTimer.start(nextInterval(PokitSimulator::Stream::DataLogger, 0));
+    }
+}
+
+/*!
+ * Notifies the device's status, then schedules the next.
+ */
+void PokitSimulatorPrivate::statusTick()
+{
+    if (!device) {
+        return;
+    }
+    deliver(device->status(), PokitSimulator::Stream::Status, StatusService::CharacteristicUuids::status,
+            statusValue());
+    statusTimer.start(nextInterval(PokitSimulator::Stream::Status, defaultStatusInterval));
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
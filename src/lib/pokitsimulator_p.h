@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PokitSimulatorPrivate class.
+ */
+
+#ifndef QTPOKIT_POKITSIMULATOR_P_H
+#define QTPOKIT_POKITSIMULATOR_P_H
+
+#include <qtpokit/pokitsimulator.h>
+#include <qtpokit/dataloggerservice.h>
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+#include "abstractpokitservice_p.h"
+
+#include <QLoggingCategory>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+#include <array>
+#include <random>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class PokitDevice;
+
+class QTPOKIT_EXPORT PokitSimulatorPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.simulator", QtInfoMsg); ///< Logging category.
+
+    static constexpr quint16 defaultPayloadSize { 244 }; ///< Sample bytes per notification, by default.
+    static constexpr quint32 defaultStatusInterval { 1000 }; ///< Milliseconds between status notifications.
+
+    QPointer<PokitDevice> device;                          ///< Device being simulated.
+    PokitProduct product { PokitProduct::PokitPro };       ///< Product being simulated.
+    std::array<PokitSimulator::Profile, 4> profiles;       ///< Profile of each stream, by Stream value.
+    quint32 latency { 0 };                                 ///< Milliseconds to acknowledge each request.
+    quint16 loggedSamples { 1000 };                        ///< Samples held by the simulated Data Logger.
+    bool running { false };                                ///< Whether requests are being handled.
+    PokitSimulator::Statistics statistics;                 ///< Simulation statistics.
+    std::minstd_rand random;                               ///< Default-seeded, so every run is repeatable.
+
+    MultimeterService::Settings meterSettings {
+        MultimeterService::Mode::DcVoltage, 255, 1000 };  ///< Most recently written multimeter settings.
+    DsoService::Settings dsoSettings { DsoService::Command::FreeRunning, 0.0f,
+        DsoService::Mode::DcVoltage, 255, 1000000, 1000 }; ///< Most recently written DSO settings.
+    DataLoggerService::Settings loggerSettings { DataLoggerService::Command::Start, 0,
+        DataLoggerService::Mode::DcVoltage, 255, 60000, 0 }; ///< Most recently started logger settings.
+
+    QSet<QBluetoothUuid> notifying;   ///< Characteristics with notifications enabled.
+    bool dsoPending { false };        ///< Whether a DSO capture is waiting for metadata notifications.
+    bool dsoMetadataDue { false };    ///< Whether the DSO capture's metadata is yet to be notified.
+    bool loggerMetadataDue { false }; ///< Whether the Data Logger transfer's metadata is yet to be notified.
+    quint64 readings { 0 };           ///< Number of multimeter readings generated so far.
+    QByteArray dsoSamples;            ///< DSO sample bytes not yet notified.
+    QByteArray loggerSamples;         ///< Data Logger sample bytes not yet notified.
+
+    QTimer meterTimer;  ///< Times multimeter reading notifications.
+    QTimer dsoTimer;    ///< Times DSO metadata, then sample, notifications.
+    QTimer loggerTimer; ///< Times Data Logger metadata, then sample, notifications.
+    QTimer statusTimer; ///< Times status notifications.
+
+    explicit PokitSimulatorPrivate(PokitSimulator * const q);
+
+    QVector<AbstractPokitService *> services() const;
+    static AbstractPokitServicePrivate * servicePrivate(AbstractPokitService * const service);
+    const PokitSimulator::Profile &profile(const PokitSimulator::Stream stream) const;
+
+    bool roll(const PokitSimulator::Stream stream);
+    int nextInterval(const PokitSimulator::Stream stream, const quint32 defaultInterval);
+    int payloadSize(const PokitSimulator::Stream stream) const;
+
+    void handleRequest(const QPointer<AbstractPokitService> &service, const PokitSimulator::Stream stream,
+                       const AbstractPokitServicePrivate::Request &request);
+    void writeCharacteristic(AbstractPokitService * const service, const QBluetoothUuid &uuid,
+                             const QByteArray &value);
+    void writeDescriptor(const QBluetoothUuid &uuid, const bool enable);
+    void readCharacteristic(AbstractPokitService * const service, const QBluetoothUuid &uuid);
+    void deliver(AbstractPokitService * const service, const PokitSimulator::Stream stream,
+                 const QBluetoothUuid &uuid, QByteArray value);
+
+    QByteArray meterReading();
+    QByteArray dsoMetadata() const;
+    QByteArray loggerMetadata() const;
+    QByteArray statusValue() const;
+    static QByteArray samples(const int count, const int period);
+
+    void startDsoCapture();
+    void startLoggerTransfer();
+
+public Q_SLOTS:
+    void meterTick();
+    void dsoTick();
+    void loggerTick();
+    void statusTick();
+
+protected:
+    PokitSimulator * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(PokitSimulator)
+    Q_DISABLE_COPY(PokitSimulatorPrivate)
+    QTPOKIT_BEFRIEND_TEST(PokitSimulator)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POKITSIMULATOR_P_H
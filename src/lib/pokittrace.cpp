@@ -0,0 +1,322 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the PokitTrace namespace.
+ */
+
+#include <qtpokit/pokittrace.h>
+#include "../stringliterals_p.h"
+
+#include <atomic>
+#include <chrono>
+
+#if defined(QTPOKIT_TRACE_TRACY)
+  #include <tracy/TracyC.h>
+  #include <cstdio>
+  #include <cstring>
+  #include <vector>
+#elif defined(QTPOKIT_TRACE_PERFETTO)
+  #include <perfetto.h>
+  #include <mutex>
+
+PERFETTO_DEFINE_CATEGORIES(perfetto::Category("dokit").SetDescription("QtPokit library, and dokit app, stages"));
+PERFETTO_TRACK_EVENT_STATIC_STORAGE();
+#endif
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \namespace PokitTrace
+ *
+ * The PokitTrace namespace provides lightweight trace points, for diagnosing latency in the BLE pipeline (connection,
+ * discovery, GATT writes, notification receipt, parsing and emitting) without the overhead of debug logging.
+ *
+ * Trace points (see QTPOKIT_TRACE_POINT) record a timestamped Event into a fixed-capacity, lock-free, in-memory ring
+ * buffer, overwriting the oldest events once full. The buffer may be read, at any time, and from any thread, via
+ * events(), such as when the application exits, or after a latency spike has been observed.
+ *
+ * Trace points are only compiled in when `QTPOKIT_TRACE` is defined (see the `ENABLE_TRACE` CMake option), otherwise
+ * they expand to nothing, and events() is always empty.
+ *
+ * Optionally, trace points may also be forwarded to an external profiler, along with scoped zones (see
+ * QTPOKIT_TRACE_ZONE), frame marks (see QTPOKIT_TRACE_FRAME_MARK) and thread names (see QTPOKIT_TRACE_THREAD_NAME),
+ * so that the library's stages (and the applications' formatting and writing) appear on the profiler's per-thread
+ * timelines. The `TRACE_PROFILER` CMake option selects the profiler: `Tracy` (zones, messages, and frame marks, via
+ * Tracy's C API), or `Perfetto` (track event slices, and instants, via the Perfetto SDK's in-process, or system,
+ * backend). Without a profiler, zones, frame marks and thread names all expand to nothing.
+ */
+
+namespace PokitTrace {
+
+#ifdef QTPOKIT_TRACE
+namespace {
+
+constexpr quint32 slotCount { 8192 }; ///< Maximum number of events retained.
+
+/// A single event, and the position it was most recently written at.
+struct Slot {
+    std::atomic<quint64> sequence { 0 }; ///< Position of the event, doubled, plus one while being written.
+    std::atomic<qint64> timestamp { 0 }; ///< Event::timestamp.
+    std::atomic<quint8> stage { 0 };     ///< Event::stage.
+    std::atomic<const char *> label { nullptr }; ///< Event::label.
+    std::atomic<qint64> value { 0 };     ///< Event::value.
+};
+
+Slot slots[slotCount];                    ///< Storage for the recorded events.
+std::atomic<quint64> writePosition { 1 }; ///< Position of the next event (from 1, since 0 marks unwritten slots).
+std::atomic<quint64> readPosition { 1 };  ///< Position of the oldest event not yet cleared.
+
+}
+#endif
+
+#ifdef QTPOKIT_TRACE_PROFILER
+namespace {
+
+/// Returns \a stage as a static string, for profilers that only record string pointers.
+const char * stageName(const Stage stage)
+{
+    switch (stage) {
+    case Stage::Connect:   return "connect";
+    case Stage::Discovery: return "discovery";
+    case Stage::Write:     return "write";
+    case Stage::Notify:    return "notify";
+    case Stage::Parse:     return "parse";
+    case Stage::Emit:      return "emit";
+    case Stage::Format:    return "format";
+    case Stage::Output:    return "output";
+    }
+    return "";
+}
+
+#if defined(QTPOKIT_TRACE_TRACY)
+thread_local std::vector<TracyCZoneCtx> zones; ///< Current thread's open zones, innermost last.
+#elif defined(QTPOKIT_TRACE_PERFETTO)
+/// Initialises Perfetto (with both the in-process, and system, backends), and registers the track event categories,
+/// once per process.
+void initialisePerfetto()
+{
+    static std::once_flag once;
+    std::call_once(once, []() {
+        perfetto::TracingInitArgs args;
+        args.backends = perfetto::kInProcessBackend | perfetto::kSystemBackend;
+        perfetto::Tracing::Initialize(args);
+        perfetto::TrackEvent::Register();
+    });
+}
+#endif
+
+}
+#endif
+
+/*!
+ * Returns \a stage as a (non-translated) string, suitable for machine-readable output.
+ */
+QString toString(const Stage stage)
+{
+    switch (stage) {
+    case Stage::Connect:   return u"connect"_s;
+    case Stage::Discovery: return u"discovery"_s;
+    case Stage::Write:     return u"write"_s;
+    case Stage::Notify:    return u"notify"_s;
+    case Stage::Parse:     return u"parse"_s;
+    case Stage::Emit:      return u"emit"_s;
+    case Stage::Format:    return u"format"_s;
+    case Stage::Output:    return u"output"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Returns \c true if the library was built with trace points enabled, \c false otherwise.
+ */
+bool isEnabled()
+{
+    #ifdef QTPOKIT_TRACE
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+/*!
+ * Returns the maximum number of events retained, or 0 if trace points are not enabled.
+ */
+quint32 capacity()
+{
+    #ifdef QTPOKIT_TRACE
+    return slotCount;
+    #else
+    return 0;
+    #endif
+}
+
+/*!
+ * Records an event at \a stage, with \a label and \a value, overwriting the oldest event if the buffer is full.
+ *
+ * \a label must be a string with static storage duration (typically a string literal), since only the pointer is
+ * recorded. This function is lock-free, and may be called from any thread, though is typically invoked via the
+ * QTPOKIT_TRACE_POINT macro, so that it is compiled out when trace points are not enabled.
+ */
+void record(const Stage stage, const char * const label, const qint64 value)
+{
+    #ifdef QTPOKIT_TRACE
+    const qint64 timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const quint64 position = writePosition.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[position % slotCount];
+    slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp.store(timestamp, std::memory_order_relaxed);
+    slot.stage.store((quint8)stage, std::memory_order_relaxed);
+    slot.label.store(label, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.sequence.store(2 * position, std::memory_order_release);
+    #endif
+
+    #if defined(QTPOKIT_TRACE_TRACY)
+    char text[128];
+    const int length = std::snprintf(text, sizeof(text), "%s %s %lld", stageName(stage), label, (long long)value);
+    ___tracy_emit_message(text, (size_t)qBound(0, length, (int)sizeof(text) - 1), 0);
+    #elif defined(QTPOKIT_TRACE_PERFETTO)
+    initialisePerfetto();
+    TRACE_EVENT_INSTANT("dokit", perfetto::StaticString{label}, "stage", stageName(stage), "value", value);
+    #endif
+
+    #if !defined(QTPOKIT_TRACE) && !defined(QTPOKIT_TRACE_PROFILER)
+    Q_UNUSED(stage)
+    Q_UNUSED(label)
+    Q_UNUSED(value)
+    #endif
+}
+
+/*!
+ * Returns the retained events, oldest first.
+ *
+ * Events being written concurrently (or overwritten while being read) are skipped, rather than returned partially.
+ */
+QVector<Event> events()
+{
+    QVector<Event> events;
+    #ifdef QTPOKIT_TRACE
+    const quint64 end = writePosition.load(std::memory_order_acquire);
+    const quint64 begin = qMax(readPosition.load(std::memory_order_relaxed), (end > slotCount) ? end - slotCount : 1);
+    events.reserve((qsizetype)(end - begin));
+    for (quint64 position = begin; position < end; ++position) {
+        const Slot &slot = slots[position % slotCount];
+        if (slot.sequence.load(std::memory_order_acquire) != 2 * position) {
+            continue; // Still being written, or already overwritten.
+        }
+        const Event event {
+            slot.timestamp.load(std::memory_order_relaxed),
+            (Stage)slot.stage.load(std::memory_order_relaxed),
+            slot.label.load(std::memory_order_relaxed),
+            slot.value.load(std::memory_order_relaxed),
+        };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == 2 * position) {
+            events.append(event);
+        }
+    }
+    #endif
+    return events;
+}
+
+/*!
+ * Discards all events recorded so far.
+ */
+void clear()
+{
+    #ifdef QTPOKIT_TRACE
+    readPosition.store(writePosition.load(std::memory_order_acquire), std::memory_order_relaxed);
+    #endif
+}
+
+/*!
+ * Returns \c true if the library was built to forward trace points, and zones, to a profiler (see the
+ * `TRACE_PROFILER` CMake option), \c false otherwise.
+ */
+bool isProfilerEnabled()
+{
+    #ifdef QTPOKIT_TRACE_PROFILER
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+/*!
+ * Begins a profiler zone on the current thread, at \a stage, with static string \a label. Each zone must be ended,
+ * on the same thread, by endZone(), innermost first, which is why this is typically invoked via the
+ * QTPOKIT_TRACE_ZONE macro instead.
+ */
+void beginZone(const Stage stage, const char * const label)
+{
+    #if defined(QTPOKIT_TRACE_TRACY)
+    const char * const function = stageName(stage);
+    const quint64 location = ___tracy_alloc_srcloc_name(0, "", 0, function, std::strlen(function),
+                                                         label, std::strlen(label), 0);
+    zones.push_back(___tracy_emit_zone_begin_alloc(location, 1));
+    #elif defined(QTPOKIT_TRACE_PERFETTO)
+    initialisePerfetto();
+    TRACE_EVENT_BEGIN("dokit", perfetto::StaticString{label}, "stage", stageName(stage));
+    #else
+    Q_UNUSED(stage)
+    Q_UNUSED(label)
+    #endif
+}
+
+/*!
+ * Ends the current thread's innermost profiler zone, as begun by beginZone().
+ */
+void endZone()
+{
+    #if defined(QTPOKIT_TRACE_TRACY)
+    if (!zones.empty()) {
+        ___tracy_emit_zone_end(zones.back());
+        zones.pop_back();
+    }
+    #elif defined(QTPOKIT_TRACE_PERFETTO)
+    TRACE_EVENT_END("dokit");
+    #endif
+}
+
+/*!
+ * Marks the end of a frame, such as a GUI render tick, with static string \a name, so the profiler can show frame
+ * times (Tracy), or an instant per frame (Perfetto).
+ */
+void markFrame(const char * const name)
+{
+    #if defined(QTPOKIT_TRACE_TRACY)
+    ___tracy_emit_frame_mark(name);
+    #elif defined(QTPOKIT_TRACE_PERFETTO)
+    initialisePerfetto();
+    TRACE_EVENT_INSTANT("dokit", perfetto::StaticString{name});
+    #else
+    Q_UNUSED(name)
+    #endif
+}
+
+/*!
+ * Names the current thread \a name in the profiler's timeline. The name is copied, so need not be static.
+ */
+void setThreadName(const char * const name)
+{
+    #if defined(QTPOKIT_TRACE_TRACY)
+    ___tracy_set_thread_name(name);
+    #elif defined(QTPOKIT_TRACE_PERFETTO)
+    initialisePerfetto();
+    const perfetto::ThreadTrack track = perfetto::ThreadTrack::Current();
+    perfetto::protos::gen::TrackDescriptor descriptor = track.Serialize();
+    descriptor.mutable_thread()->set_thread_name(name);
+    perfetto::TrackEvent::SetTrackDescriptor(track, descriptor);
+    #else
+    Q_UNUSED(name)
+    #endif
+}
+
+}
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,288 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the PowerIntegrator and PowerIntegratorPrivate classes.
+ */
+
+#include <qtpokit/powerintegrator.h>
+#include "powerintegrator_p.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// Number of milliseconds per hour, for converting watt-milliseconds, and amp-milliseconds, to per-hour units.
+static constexpr double millisecondsPerHour { 3'600'000.0 };
+
+/*!
+ * \class PowerIntegrator
+ *
+ * The PowerIntegrator class derives power, energy and charge from two streams of timestamped samples: one of voltage,
+ * and one of current, typically from two Pokit devices (one measuring DC voltage, and one DC current) whose samples
+ * have been placed on a common timeline by a ClockAligner.
+ *
+ * The two devices sample at their own times, so the streams are joined: a result is derived at each sample time of
+ * either stream, with the other stream's value linearly interpolated between its samples either side of that time.
+ * So results are only derived once both streams have reached a time, and samples of the faster (or less delayed)
+ * stream are buffered (up to maxPendingSamples per stream) until the other stream catches up.
+ *
+ * Each result includes the instantaneous power, and the energy (in watt-hours) and charge (in amp-hours) integrated,
+ * via the trapezoidal rule, from the first result up to that result, along with the average power over that time.
+ * If maximumGap() is non-zero, then samples further apart than that are neither interpolated, nor integrated, across,
+ * so that (for example) a device briefly disconnecting does not corrupt the totals with made-up values.
+ *
+ * Within each stream, samples must be added in timestamp order. Samples not after their stream's previous sample,
+ * and non-finite samples (such as from overloaded ranges), are ignored.
+ */
+
+/*!
+ * Constructs a new PowerIntegrator object with \a parent.
+ */
+PowerIntegrator::PowerIntegrator(QObject * parent)
+    : QObject(parent), d_ptr(new PowerIntegratorPrivate(this))
+{
+
+}
+
+/*!
+ * \cond internal
+ * Constructs a new PowerIntegrator object with \a parent, and private implementation \a d.
+ */
+PowerIntegrator::PowerIntegrator(PowerIntegratorPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this PowerIntegrator object.
+ */
+PowerIntegrator::~PowerIntegrator()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the longest interval, in milliseconds, that may be interpolated, or integrated, across, or 0 (the default)
+ * for no limit.
+ */
+quint32 PowerIntegrator::maximumGap() const
+{
+    Q_D(const PowerIntegrator);
+    return d->maximumGap;
+}
+
+/*!
+ * Sets the longest interval that may be interpolated, or integrated, across to \a gap milliseconds, or 0 for no limit.
+ */
+void PowerIntegrator::setMaximumGap(const quint32 gap)
+{
+    Q_D(PowerIntegrator);
+    d->maximumGap = gap;
+}
+
+/*!
+ * Returns \c true if at least one result has been derived (since construction, or the last reset()).
+ */
+bool PowerIntegrator::hasResult() const
+{
+    Q_D(const PowerIntegrator);
+    return d->haveResult;
+}
+
+/*!
+ * Returns the latest result, if hasResult(), otherwise a zeroed result.
+ */
+PowerIntegrator::Result PowerIntegrator::result() const
+{
+    Q_D(const PowerIntegrator);
+    return d->result;
+}
+
+/*!
+ * Adds a voltage sample of \a volts, taken at \a timestamp (in milliseconds since the epoch), emitting resultReady for
+ * every result that can now be derived.
+ */
+void PowerIntegrator::addVoltage(const float volts, const qint64 timestamp)
+{
+    Q_D(PowerIntegrator);
+    d->addSample(d->voltages, volts, timestamp);
+}
+
+/*!
+ * Adds a current sample of \a amps, taken at \a timestamp (in milliseconds since the epoch), emitting resultReady for
+ * every result that can now be derived.
+ */
+void PowerIntegrator::addCurrent(const float amps, const qint64 timestamp)
+{
+    Q_D(PowerIntegrator);
+    d->addSample(d->currents, amps, timestamp);
+}
+
+/*!
+ * Discards all buffered samples, and the integrated totals, but not the maximumGap().
+ */
+void PowerIntegrator::reset()
+{
+    Q_D(PowerIntegrator);
+    d->voltages.clear();
+    d->currents.clear();
+    d->cursor = std::numeric_limits<qint64>::min();
+    d->haveResult = false;
+    d->result = { 0, 0.0f, 0.0f, 0.0f, 0.0, 0.0, 0.0, 0 };
+    d->wattMilliseconds = 0.0;
+    d->ampMilliseconds = 0.0;
+    d->integrating = false;
+}
+
+/*!
+ * \fn PowerIntegrator::resultReady
+ *
+ * This signal is emitted whenever a new \a result has been derived.
+ */
+
+/*!
+ * \cond internal
+ * \class PowerIntegratorPrivate
+ *
+ * The PowerIntegratorPrivate class provides private implementation for PowerIntegrator.
+ */
+
+/*!
+ * Constructs a new PowerIntegratorPrivate object with public implementation \a q.
+ */
+PowerIntegratorPrivate::PowerIntegratorPrivate(PowerIntegrator * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Appends \a value, taken at \a timestamp, to \a samples (either #voltages or #currents), then joins the two streams
+ * as far as they both reach. If \a samples already holds maxPendingSamples unjoined samples, the oldest is discarded.
+ */
+void PowerIntegratorPrivate::addSample(QVector<Sample> &samples, const float value, const qint64 timestamp)
+{
+    if (!qIsFinite(value)) {
+        return;
+    }
+    if ((!samples.isEmpty()) && (timestamp <= samples.constLast().timestamp)) {
+        qCDebug(lc).noquote() << tr("Ignoring out-of-order sample at %1 (after %2).").arg(timestamp)
+            .arg(samples.constLast().timestamp);
+        return;
+    }
+    if (samples.size() > PowerIntegrator::maxPendingSamples) {
+        qCDebug(lc).noquote() << tr("Discarding unjoined sample at %1.").arg(samples.constFirst().timestamp);
+        samples.removeFirst();
+    }
+    samples.append({ timestamp, value });
+    join();
+}
+
+/*!
+ * Derives a result at each sample time (of either stream) after #cursor, that both streams have reached, then trims
+ * each stream to just the samples still needed.
+ */
+void PowerIntegratorPrivate::join()
+{
+    if ((voltages.isEmpty()) || (currents.isEmpty())) {
+        return;
+    }
+    const qint64 horizon = qMin(voltages.constLast().timestamp, currents.constLast().timestamp);
+    const auto firstAfter = [this](const QVector<Sample> &samples) {
+        return (int)(std::upper_bound(samples.cbegin(), samples.cend(), cursor, [](const qint64 time,
+            const Sample &sample) { return time < sample.timestamp; }) - samples.cbegin());
+    };
+    int voltage = firstAfter(voltages), current = firstAfter(currents);
+    while (true) {
+        qint64 next = std::numeric_limits<qint64>::max();
+        if ((voltage < voltages.size()) && (voltages.at(voltage).timestamp <= horizon)) {
+            next = voltages.at(voltage).timestamp;
+        }
+        if ((current < currents.size()) && (currents.at(current).timestamp <= horizon)) {
+            next = qMin(next, currents.at(current).timestamp);
+        }
+        if (next == std::numeric_limits<qint64>::max()) {
+            break;
+        }
+        if ((voltage < voltages.size()) && (voltages.at(voltage).timestamp == next)) ++voltage;
+        if ((current < currents.size()) && (currents.at(current).timestamp == next)) ++current;
+        cursor = next;
+        addPoint(next, valueAt(voltages, next), valueAt(currents, next));
+    }
+    trim(voltages, cursor);
+    trim(currents, cursor);
+}
+
+/*!
+ * Returns the value of \a samples at \a timestamp, linearly interpolated between the samples either side of it if
+ * necessary, or NaN if \a samples do not span \a timestamp, or the samples either side are more than #maximumGap
+ * apart.
+ */
+float PowerIntegratorPrivate::valueAt(const QVector<Sample> &samples, const qint64 timestamp) const
+{
+    const auto after = std::upper_bound(samples.cbegin(), samples.cend(), timestamp,
+        [](const qint64 time, const Sample &sample) { return time < sample.timestamp; });
+    if (after == samples.cbegin()) {
+        return qQNaN(); // Before the first sample.
+    }
+    const Sample &before = *(after - 1);
+    if (before.timestamp == timestamp) {
+        return before.value;
+    }
+    if ((after == samples.cend()) || ((maximumGap > 0) && (after->timestamp - before.timestamp > maximumGap))) {
+        return qQNaN(); // Beyond the last sample, or within a gap.
+    }
+    const double fraction = (double)(timestamp - before.timestamp) / (double)(after->timestamp - before.timestamp);
+    return (float)(before.value + (after->value - before.value) * fraction);
+}
+
+/*!
+ * Derives (and emits) the result at \a timestamp, from \a voltage and \a current, integrating from the previous
+ * result, unless either value is unknown (NaN), or the previous result is more than #maximumGap ago.
+ */
+void PowerIntegratorPrivate::addPoint(const qint64 timestamp, const float voltage, const float current)
+{
+    if ((qIsNaN(voltage)) || (qIsNaN(current))) {
+        integrating = false; // Don't integrate across the unknown value/s.
+        return;
+    }
+    const float power = voltage * current;
+    const qint64 interval = timestamp - result.timestamp;
+    if ((integrating) && ((maximumGap == 0) || (interval <= maximumGap))) {
+        wattMilliseconds += (result.power + power) / 2.0 * (double)interval;
+        ampMilliseconds += (result.current + current) / 2.0 * (double)interval;
+        result.duration += interval;
+    }
+    result.timestamp = timestamp;
+    result.voltage = voltage;
+    result.current = current;
+    result.power = power;
+    result.averagePower = (result.duration > 0) ? wattMilliseconds / (double)result.duration : (double)power;
+    result.energy = wattMilliseconds / millisecondsPerHour;
+    result.charge = ampMilliseconds / millisecondsPerHour;
+    haveResult = integrating = true;
+    Q_Q(PowerIntegrator);
+    Q_EMIT q->resultReady(result);
+}
+
+/*!
+ * Removes all of \a samples before the latest sample at, or before, \a timestamp, since that sample is the earliest
+ * that later results may be interpolated from.
+ */
+void PowerIntegratorPrivate::trim(QVector<Sample> &samples, const qint64 timestamp)
+{
+    const auto after = std::upper_bound(samples.cbegin(), samples.cend(), timestamp,
+        [](const qint64 time, const Sample &sample) { return time < sample.timestamp; });
+    if (const qsizetype obsolete = (after - samples.cbegin()) - 1; obsolete > 0) {
+        samples.remove(0, obsolete);
+    }
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
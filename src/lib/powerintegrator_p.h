@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the PowerIntegratorPrivate class.
+ */
+
+#ifndef QTPOKIT_POWERINTEGRATOR_P_H
+#define QTPOKIT_POWERINTEGRATOR_P_H
+
+#include <qtpokit/powerintegrator.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+#include <QVector>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT PowerIntegratorPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.power.integrator", QtInfoMsg); ///< Logging category.
+
+    /// A single timestamped value, of either channel.
+    struct Sample {
+        qint64 timestamp; ///< Time of the sample, in milliseconds since the epoch.
+        float value;      ///< Value of the sample, in volts or amps.
+    };
+
+    quint32 maximumGap { 0 };  ///< Longest interval to interpolate, or integrate, across, or 0 for no limit.
+    QVector<Sample> voltages;  ///< Voltage samples not yet joined, preceded by the latest joined sample (if any).
+    QVector<Sample> currents;  ///< Current samples not yet joined, preceded by the latest joined sample (if any).
+    qint64 cursor { std::numeric_limits<qint64>::min() }; ///< Time of the latest joined point.
+
+    bool haveResult { false }; ///< Whether #result holds a result yet.
+    PowerIntegrator::Result result { 0, 0.0f, 0.0f, 0.0f, 0.0, 0.0, 0.0, 0 }; ///< Latest result.
+    double wattMilliseconds { 0.0 };    ///< Energy integrated so far, in watt-milliseconds.
+    double ampMilliseconds { 0.0 };     ///< Charge integrated so far, in amp-milliseconds.
+    bool integrating { false };         ///< Whether #result may be integrated from (ie is not followed by a gap).
+
+    explicit PowerIntegratorPrivate(PowerIntegrator * const q);
+
+    void addSample(QVector<Sample> &samples, const float value, const qint64 timestamp);
+    void join();
+    float valueAt(const QVector<Sample> &samples, const qint64 timestamp) const;
+    void addPoint(const qint64 timestamp, const float voltage, const float current);
+    static void trim(QVector<Sample> &samples, const qint64 timestamp);
+
+protected:
+    PowerIntegrator * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(PowerIntegrator)
+    Q_DISABLE_COPY(PowerIntegratorPrivate)
+    QTPOKIT_BEFRIEND_TEST(PowerIntegrator)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_POWERINTEGRATOR_P_H
@@ -0,0 +1,264 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the QuantileSketch class.
+ */
+
+#include <qtpokit/quantilesketch.h>
+
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class QuantileSketch
+ *
+ * The QuantileSketch class estimates percentiles of a stream of values, such as day-long data logger sessions, in a
+ * bounded amount of memory, in the style of a KLL sketch. That is, values are retained in a hierarchy of levels, in
+ * which each level-n value stands for 2^n of the values added. Whenever the sketch is full, the lowest full level is
+ * compacted: sorted, with every second value promoted to the next level (with double the weight), and the rest
+ * discarded. Level capacities shrink geometrically (by 2/3) from the highest level down, so no more than about three
+ * times accuracy() values are ever retained, no matter how many values are added.
+ *
+ * Percentiles are exact until the lowest level is first compacted (that is, for the first accuracy() or so values),
+ * and are otherwise typically within about 1% (of count()) of their true rank, for the default accuracy. Unlike the
+ * percentiles, the count(), minimum(), maximum() and mean() are always exact.
+ *
+ * Sketches may be merged, such as to combine hourly sketches into a daily one, with the same accuracy as if all of
+ * the values had been added to a single sketch. Compactions alternate between keeping odd, and even, values (rather
+ * than choosing randomly), so sketches are deterministic. QuantileSketch is not thread-safe.
+ */
+
+/*!
+ * Constructs a new, empty, QuantileSketch object with \a accuracy. Larger accuracies give more accurate percentiles,
+ * in proportionally more memory. Accuracies less than 8 are treated as 8.
+ */
+QuantileSketch::QuantileSketch(const int accuracy) : k(qMax(accuracy, 8))
+{
+
+}
+
+/*!
+ * Adds \a value to the sketch. NaN values are ignored.
+ */
+void QuantileSketch::add(const float value)
+{
+    if (qIsNaN(value)) {
+        return;
+    }
+    if (levels.isEmpty()) {
+        levels.resize(1);
+        levels[0].reserve(capacity(0));
+    }
+    if (total == 0) {
+        min = max = value;
+    } else {
+        min = qMin(min, value);
+        max = qMax(max, value);
+    }
+    levels[0].append(value);
+    ++retained;
+    ++total;
+    sum += (double)value;
+    while (retained >= maximumRetained()) {
+        compress();
+    }
+}
+
+/*!
+ * Adds all of the values added to \a other to this sketch. This sketch's accuracy() is unchanged.
+ */
+void QuantileSketch::merge(const QuantileSketch &other)
+{
+    if (other.isEmpty()) {
+        return;
+    }
+    if (levels.size() < other.levels.size()) {
+        levels.resize(other.levels.size());
+    }
+    for (int level = 0; level < other.levels.size(); ++level) {
+        levels[level].append(other.levels.at(level));
+    }
+    retained += other.retained;
+    if (total == 0) {
+        min = other.min;
+        max = other.max;
+    } else {
+        min = qMin(min, other.min);
+        max = qMax(max, other.max);
+    }
+    total += other.total;
+    sum += other.sum;
+    while (retained >= maximumRetained()) {
+        compress();
+    }
+}
+
+/*!
+ * Discards all added values, but retains the lowest level's allocation (if any), for re-use.
+ */
+void QuantileSketch::reset()
+{
+    levels.resize(qMin<qsizetype>(levels.size(), 1));
+    if (!levels.isEmpty()) {
+        levels[0].clear();
+    }
+    retained = 0;
+    total = 0;
+    min = max = 0.0f;
+    sum = 0.0;
+    oddOffset = false;
+}
+
+/*!
+ * Returns the accuracy parameter this sketch was constructed with (see QuantileSketch()).
+ */
+int QuantileSketch::accuracy() const
+{
+    return k;
+}
+
+/*!
+ * Returns \c true if no values have been added (since the last reset()), otherwise \c false.
+ */
+bool QuantileSketch::isEmpty() const
+{
+    return total == 0;
+}
+
+/*!
+ * Returns the number of values added.
+ */
+quint64 QuantileSketch::count() const
+{
+    return total;
+}
+
+/*!
+ * Returns the smallest value added (exactly), or 0 if none have been added.
+ */
+float QuantileSketch::minimum() const
+{
+    return min;
+}
+
+/*!
+ * Returns the largest value added (exactly), or 0 if none have been added.
+ */
+float QuantileSketch::maximum() const
+{
+    return max;
+}
+
+/*!
+ * Returns the mean of the values added (exactly), or NaN if none have been added.
+ */
+double QuantileSketch::mean() const
+{
+    return (total == 0) ? std::nan("") : sum / (double)total;
+}
+
+/*!
+ * Returns the (estimated) value that \a percent percent of added values are less than, or equal to, such as
+ * `percentile(99.0)` for the 99th percentile. Returns NaN if no values have been added.
+ *
+ * The 0th and 100th percentiles are the minimum() and maximum() values. Otherwise, the result is the retained value
+ * whose cumulative weight first reaches the percentile's (nearest) rank.
+ */
+float QuantileSketch::percentile(const double percent) const
+{
+    if (total == 0) {
+        return qQNaN();
+    }
+    if (percent <= 0.0) {
+        return min;
+    }
+    if (percent >= 100.0) {
+        return max;
+    }
+
+    QVector<std::pair<float, quint64>> weighted;
+    weighted.reserve(retained);
+    for (int level = 0; level < levels.size(); ++level) {
+        for (const float value: levels.at(level)) {
+            weighted.append({ value, (quint64)1 << level });
+        }
+    }
+    std::sort(weighted.begin(), weighted.end());
+
+    const quint64 rank = qBound<quint64>(1, (quint64)std::ceil(percent / 100.0 * (double)total), total);
+    quint64 cumulative = 0;
+    for (const auto &[value, weight]: std::as_const(weighted)) {
+        if ((cumulative += weight) >= rank) {
+            return value;
+        }
+    }
+    return max; // Should never be reached, since the weights always sum to the count.
+}
+
+/*!
+ * Returns the number of values currently retained by the sketch. This is bounded by (about three times) accuracy(),
+ * regardless of count(), and is mostly of interest for testing.
+ */
+qsizetype QuantileSketch::retainedCount() const
+{
+    return retained;
+}
+
+/*!
+ * Returns the capacity of \a level, given the sketch's current number of levels. The highest level's capacity is
+ * (one more than) accuracy(), and each level below that has 2/3 the capacity of the level above, but at least 2.
+ */
+qsizetype QuantileSketch::capacity(const int level) const
+{
+    const int depth = (int)levels.size() - level - 1;
+    return (qsizetype)std::ceil((double)k * std::pow(2.0 / 3.0, depth)) + 1;
+}
+
+/*!
+ * Returns the total capacity of all of the sketch's current levels.
+ */
+qsizetype QuantileSketch::maximumRetained() const
+{
+    qsizetype maximum = 0;
+    for (int level = 0; level < levels.size(); ++level) {
+        maximum += capacity(level);
+    }
+    return maximum;
+}
+
+/*!
+ * Compacts the lowest full level into the level above (adding a new level, if necessary). If the level holds an odd
+ * number of values, its largest value is kept, uncompacted, rather than being lost.
+ */
+void QuantileSketch::compress()
+{
+    for (int level = 0; level < levels.size(); ++level) {
+        if (levels.at(level).size() < capacity(level)) {
+            continue;
+        }
+        if (level + 1 >= levels.size()) {
+            levels.resize(level + 2);
+        }
+        QVector<float> &values = levels[level];
+        std::sort(values.begin(), values.end());
+        const qsizetype pairs = values.size() / 2;
+        QVector<float> &above = levels[level + 1];
+        above.reserve(above.size() + pairs);
+        for (qsizetype index = (oddOffset) ? 1 : 0; index < pairs * 2; index += 2) {
+            above.append(values.at(index));
+        }
+        oddOffset = !oddOffset;
+        values.remove(0, pairs * 2);
+        retained -= pairs;
+        return;
+    }
+}
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,425 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the ReferenceClock and ReferenceClockPrivate classes.
+ */
+
+#include <qtpokit/referenceclock.h>
+#include "referenceclock_p.h"
+#include "../stringliterals_p.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QMutexLocker>
+
+#include <cmath>
+#include <cstdlib>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/timex.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class ReferenceClock
+ *
+ * The ReferenceClock class disciplines host timestamps against a reference clock, and bounds their error, so that
+ * timestamps taken by different hosts (such as a cluster of `dokit daemon` gateways) may be compared, and their
+ * comparison trusted only as far as those bounds allow.
+ *
+ * The reference is either NTP, or a PTP hardware clock (PHC):
+ * * For Source::Ntp, the system clock is already disciplined by the kernel (on behalf of chronyd, ntpd, etc), so the
+ *   offset is always 0, but the kernel's synchronisation state, and its maximum error estimate, give the bound.
+ * * For Source::Ptp, the PHC (typically disciplined by ptp4l, and not necessarily the system clock's own reference) is
+ *   read between two readings of the system clock, several times, and the tightest such reading gives both the offset
+ *   (converted from the PHC's TAI timeline to UTC), and the bound. The PHC's own synchronisation is trusted, since the
+ *   kernel does not report it.
+ *
+ * Comparisons are repeated every updateInterval() milliseconds, and between comparisons the bound grows by
+ * #maximumDrift, plus the timestamps' own millisecond resolution. Both references are currently Linux only; elsewhere,
+ * setSource() fails, and the clock remains Source::System, whose timestamps are the system clock's, unbounded.
+ *
+ * now(), toReference() and status() may be called from any thread.
+ */
+
+/// Returns \a source as a (non-translated) string, suitable for machine-readable output.
+QString ReferenceClock::toString(const Source source)
+{
+    switch (source) {
+    case Source::System: return u"system"_s;
+    case Source::Ntp:    return u"ntp"_s;
+    case Source::Ptp:    return u"ptp"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Constructs a new ReferenceClock object with \a parent.
+ */
+ReferenceClock::ReferenceClock(QObject * parent) : QObject(parent), d_ptr(new ReferenceClockPrivate(this))
+{
+
+}
+
+/*!
+ * \cond internal
+ * Constructs a new ReferenceClock object with \a parent, and private implementation \a d.
+ */
+ReferenceClock::ReferenceClock(ReferenceClockPrivate * const d, QObject * const parent) : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this ReferenceClock object.
+ */
+ReferenceClock::~ReferenceClock()
+{
+    Q_D(ReferenceClock);
+    d->closeDevice();
+    delete d_ptr;
+}
+
+/*!
+ * Returns the reference this clock disciplines timestamps against. The default is Source::System.
+ */
+ReferenceClock::Source ReferenceClock::source() const
+{
+    Q_D(const ReferenceClock);
+    return d->source;
+}
+
+/*!
+ * Returns the PTP hardware clock device, such as `/dev/ptp0`, if source() is Source::Ptp, otherwise a null string.
+ */
+QString ReferenceClock::device() const
+{
+    Q_D(const ReferenceClock);
+    return d->device;
+}
+
+/*!
+ * Sets the reference to discipline timestamps against to \a source, and (for Source::Ptp) the PTP hardware clock
+ * \a device, which defaults to `/dev/ptp0`. The reference is compared with immediately, then every updateInterval().
+ *
+ * Returns \c true on success, otherwise \c false, with errorString() describing why, in which case the clock reverts
+ * to Source::System. Note, success only means the reference could be read; it may not (yet) be synchronised.
+ */
+bool ReferenceClock::setSource(const Source source, const QString &device)
+{
+    Q_D(ReferenceClock);
+    d->timer.stop();
+    d->closeDevice();
+    d->source = Source::System;
+    d->device.clear();
+    d->errorString.clear();
+
+    #if defined(Q_OS_LINUX)
+    if (source == Source::Ptp) {
+        d->device = device.isEmpty() ? u"/dev/ptp0"_s : device;
+        if (!d->openDevice()) {
+            d->device.clear();
+            update();
+            return false;
+        }
+    }
+    d->source = source;
+    #else
+    Q_UNUSED(device)
+    if (source != Source::System) {
+        d->errorString = tr("The %1 reference clock is not supported on this platform.").arg(toString(source));
+        update();
+        return false;
+    }
+    #endif
+
+    update();
+    if (d->source != Source::System) {
+        d->timer.start();
+    }
+    return true;
+}
+
+/*!
+ * Returns a human-readable description of the last setSource() failure, or an empty string if it succeeded.
+ */
+QString ReferenceClock::errorString() const
+{
+    Q_D(const ReferenceClock);
+    return d->errorString;
+}
+
+/*!
+ * Returns the interval between comparisons with the reference, in milliseconds. The default is
+ * #defaultUpdateInterval.
+ */
+int ReferenceClock::updateInterval() const
+{
+    Q_D(const ReferenceClock);
+    return d->timer.interval();
+}
+
+/*!
+ * Sets the interval between comparisons with the reference to \a interval milliseconds.
+ */
+void ReferenceClock::setUpdateInterval(const int interval)
+{
+    Q_D(ReferenceClock);
+    d->timer.setInterval(interval);
+}
+
+/*!
+ * Returns the latest comparison with the reference.
+ */
+ReferenceClock::Status ReferenceClock::status() const
+{
+    Q_D(const ReferenceClock);
+    const QMutexLocker scopedLock(&d->mutex);
+    return d->status;
+}
+
+/*!
+ * Returns the current time, disciplined against the reference, with a bound on its error.
+ */
+ReferenceClock::Timestamp ReferenceClock::now() const
+{
+    return toReference(QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+ * Returns \a systemTime, a system clock time in milliseconds since the epoch, disciplined against the reference, with a
+ * bound on its error. The bound grows with \a systemTime's distance from the latest comparison, so \a systemTime
+ * should be recent.
+ */
+ReferenceClock::Timestamp ReferenceClock::toReference(const qint64 systemTime) const
+{
+    return ReferenceClockPrivate::toReference(status(), systemTime);
+}
+
+/*!
+ * Compares the system clock with the reference now, rather than waiting for the next periodic comparison. Returns
+ * \c true if the reference could be read (though it may not be synchronised), otherwise \c false, with Status::error
+ * describing why.
+ */
+bool ReferenceClock::update()
+{
+    Q_D(ReferenceClock);
+    Status status;
+    switch (d->source) {
+    case Source::System:
+        status.error = d->errorString;
+        break;
+    case Source::Ntp:
+        status = d->readNtp();
+        break;
+    case Source::Ptp:
+        status = d->readPtp();
+        break;
+    }
+    status.source = d->source;
+    status.updated = QDateTime::currentMSecsSinceEpoch();
+
+    bool wasSynchronised = false;
+    {
+        const QMutexLocker scopedLock(&d->mutex);
+        wasSynchronised = d->status.synchronised;
+        d->status = status;
+    }
+    if (!status.error.isEmpty()) {
+        qCDebug(d->lc).noquote() << tr("Failed to read the %1 reference clock: %2")
+            .arg(toString(status.source), status.error);
+    }
+    if (status.synchronised != wasSynchronised) {
+        qCDebug(d->lc).noquote() << (status.synchronised ? tr("Reference clock synchronised.")
+            : tr("Reference clock no longer synchronised."));
+        Q_EMIT synchronisedChanged(status.synchronised);
+    }
+    return status.error.isEmpty();
+}
+
+/*!
+ * \fn ReferenceClock::synchronisedChanged
+ *
+ * This signal is emitted when the reference becomes synchronised, or stops being synchronised, per \a synchronised.
+ * While not synchronised, timestamps are unbounded.
+ */
+
+/*!
+ * \cond internal
+ * \class ReferenceClockPrivate
+ *
+ * The ReferenceClockPrivate class provides private implementation for ReferenceClock.
+ */
+
+/*!
+ * \internal
+ * Constructs a new ReferenceClockPrivate object with public implementation \a q.
+ */
+ReferenceClockPrivate::ReferenceClockPrivate(ReferenceClock * const q) : q_ptr(q)
+{
+    timer.setInterval(ReferenceClock::defaultUpdateInterval);
+    connect(&timer, &QTimer::timeout, q, &ReferenceClock::update);
+}
+
+/*!
+ * Opens the PTP hardware clock #device, setting #errorString on failure.
+ */
+bool ReferenceClockPrivate::openDevice()
+{
+    #if defined(Q_OS_LINUX)
+    fd = ::open(QFile::encodeName(device).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        errorString = ReferenceClock::tr("Failed to open PTP hardware clock %1: %2").arg(device,
+            qt_error_string(errno));
+        return false;
+    }
+    return true;
+    #else
+    errorString = ReferenceClock::tr("PTP hardware clocks are not supported on this platform.");
+    return false;
+    #endif
+}
+
+/*!
+ * Closes the PTP hardware clock #device, if open.
+ */
+void ReferenceClockPrivate::closeDevice()
+{
+    #if defined(Q_OS_LINUX)
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    #endif
+    fd = -1;
+}
+
+/*!
+ * Returns the kernel's NTP discipline state as a comparison: an offset of 0 (since the kernel has already applied the
+ * discipline to the system clock), bounded by the kernel's maximum error estimate, if synchronised.
+ */
+ReferenceClock::Status ReferenceClockPrivate::readNtp() const
+{
+    ReferenceClock::Status status;
+    #if defined(Q_OS_LINUX)
+    timex tx{};
+    const int state = ::ntp_adjtime(&tx);
+    if (state < 0) {
+        status.error = qt_error_string(errno);
+        return status;
+    }
+    status.synchronised = (state != TIME_ERROR) && (!(tx.status & STA_UNSYNC));
+    if (status.synchronised) {
+        // maxerror already includes the kernel's own drift allowance since the NTP daemon's last update, but not any
+        // (not yet slewed away) remaining offset, which is in nanoseconds if STA_NANO, else microseconds.
+        const qint64 remaining = std::abs((qint64)tx.offset) / ((tx.status & STA_NANO) ? 1000 : 1);
+        status.uncertainty = (qint64)tx.maxerror + remaining;
+    }
+    #else
+    status.error = ReferenceClock::tr("NTP discipline state is not available on this platform.");
+    #endif
+    return status;
+}
+
+/*!
+ * Reads the PTP hardware clock #device between pairs of system clock readings, and returns the tightest such reading
+ * as a comparison. See fromPtpReadings().
+ */
+ReferenceClock::Status ReferenceClockPrivate::readPtp() const
+{
+    ReferenceClock::Status status;
+    #if defined(Q_OS_LINUX)
+    if (fd < 0) {
+        status.error = ReferenceClock::tr("PTP hardware clock %1 is not open.").arg(device);
+        return status;
+    }
+    // The kernel's dynamic POSIX clock ID for a character device's file descriptor (aka FD_TO_CLOCKID in its docs).
+    const clockid_t clock = (clockid_t)((((unsigned int)~fd) << 3) | 3);
+    const auto toNanoseconds = [](const timespec &time) {
+        return (qint64)time.tv_sec * 1000000000 + (qint64)time.tv_nsec;
+    };
+
+    QVector<PtpReading> readings;
+    for (int count = 0; count < 5; ++count) {
+        timespec before{}, reference{}, after{};
+        if ((::clock_gettime(CLOCK_REALTIME, &before) != 0) || (::clock_gettime(clock, &reference) != 0)
+            || (::clock_gettime(CLOCK_REALTIME, &after) != 0))
+        {
+            status.error = ReferenceClock::tr("Failed to read PTP hardware clock %1: %2").arg(device,
+                qt_error_string(errno));
+            return status;
+        }
+        readings.append({ toNanoseconds(before), toNanoseconds(reference), toNanoseconds(after) });
+    }
+
+    // PHCs run on TAI (as ptp4l sets them), so the kernel's TAI offset (as set by ptp4l, phc2sys or chronyd) converts
+    // them to UTC. Without it, the offset would be wrong by (currently) 37 seconds, so stay unsynchronised instead.
+    timex tx{};
+    if ((::ntp_adjtime(&tx) < 0) || (tx.tai <= 0)) {
+        status.error = ReferenceClock::tr("The kernel's TAI offset is not set, so PTP time cannot be made UTC.");
+        return status;
+    }
+    return fromPtpReadings(readings, tx.tai);
+    #else
+    status.error = ReferenceClock::tr("PTP hardware clocks are not supported on this platform.");
+    return status;
+    #endif
+}
+
+/*!
+ * Returns a comparison from the tightest (that is, the shortest time between system clock readings) of \a readings,
+ * with the PTP hardware clock's time converted from TAI to UTC by \a taiOffset seconds. The offset is the PHC's time
+ * minus the midpoint of the system clock readings, and the bound is half the time between them.
+ */
+ReferenceClock::Status ReferenceClockPrivate::fromPtpReadings(const QVector<PtpReading> &readings,
+                                                              const qint64 taiOffset)
+{
+    ReferenceClock::Status status;
+    status.source = ReferenceClock::Source::Ptp;
+    const PtpReading * best = nullptr;
+    for (const PtpReading &reading: readings) {
+        if ((reading.after >= reading.before) && ((best == nullptr)
+            || (reading.after - reading.before < best->after - best->before))) {
+            best = &reading;
+        }
+    }
+    if (best == nullptr) {
+        status.error = ReferenceClock::tr("No valid PTP hardware clock readings.");
+        return status;
+    }
+    const qint64 midpoint = best->before + (best->after - best->before) / 2;
+    const qint64 offset = best->reference - taiOffset * 1000000000 - midpoint;
+    status.synchronised = true;
+    status.offset = (qint64)std::llround((double)offset / 1000.0);
+    status.uncertainty = (best->after - best->before + 1999) / 2000; // Half the width, in microseconds, rounded up.
+    return status;
+}
+
+/*!
+ * Returns \a systemTime disciplined by \a status, with the bound grown by #ReferenceClock::maximumDrift for the time
+ * since \a status was updated, plus 1ms for \a systemTime's own (truncated) millisecond resolution.
+ */
+ReferenceClock::Timestamp ReferenceClockPrivate::toReference(const ReferenceClock::Status &status,
+                                                               const qint64 systemTime)
+{
+    ReferenceClock::Timestamp timestamp;
+    timestamp.time = systemTime + (qint64)std::llround((double)status.offset / 1000.0);
+    if ((status.synchronised) && (status.uncertainty >= 0)) {
+        const qint64 elapsed = std::abs(systemTime - status.updated); // ms.
+        timestamp.uncertainty = status.uncertainty + 1000
+            + (qint64)std::ceil((double)elapsed * ReferenceClock::maximumDrift / 1000.0);
+    }
+    return timestamp;
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the ReferenceClockPrivate class.
+ */
+
+#ifndef QTPOKIT_REFERENCECLOCK_P_H
+#define QTPOKIT_REFERENCECLOCK_P_H
+
+#include <qtpokit/referenceclock.h>
+
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT ReferenceClockPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.clock.reference", QtInfoMsg); ///< Logging category.
+
+    /// A single reading of a PTP hardware clock, between two readings of the system clock, all in nanoseconds.
+    struct PtpReading {
+        qint64 before;    ///< System time, just before reading the PHC.
+        qint64 reference; ///< PHC time.
+        qint64 after;     ///< System time, just after reading the PHC.
+    };
+
+    ReferenceClock::Source source { ReferenceClock::Source::System }; ///< Reference compared against.
+    QString device;                 ///< PTP hardware clock device, such as `/dev/ptp0`, for Source::Ptp.
+    int fd { -1 };                  ///< Open #device's file descriptor, or -1 if not open.
+    QString errorString;            ///< Description of the last setSource() failure, if any.
+    QTimer timer;                   ///< Triggers periodic comparisons with the reference.
+    ReferenceClock::Status status;  ///< Latest comparison with the reference.
+    mutable QMutex mutex;           ///< Guards #status, so the clock may be read from any thread.
+
+    explicit ReferenceClockPrivate(ReferenceClock * const q);
+
+    bool openDevice();
+    void closeDevice();
+    ReferenceClock::Status readNtp() const;
+    ReferenceClock::Status readPtp() const;
+
+    static ReferenceClock::Status fromPtpReadings(const QVector<PtpReading> &readings, const qint64 taiOffset);
+    static ReferenceClock::Timestamp toReference(const ReferenceClock::Status &status, const qint64 systemTime);
+
+protected:
+    ReferenceClock * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(ReferenceClock)
+    Q_DISABLE_COPY(ReferenceClockPrivate)
+    QTPOKIT_BEFRIEND_TEST(ReferenceClock)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_REFERENCECLOCK_P_H
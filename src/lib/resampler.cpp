@@ -0,0 +1,392 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the Resampler and ResamplerPrivate classes.
+ */
+
+#include <qtpokit/resampler.h>
+#include "resampler_p.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class Resampler
+ *
+ * The Resampler class resamples one or more streams (ie channels) of timestamped samples, such as multimeter readings
+ * from one or more Pokit devices, onto a common, uniform grid of times, being multiples of period() since the epoch.
+ * Each time on the grid is emitted as a single row, via rowReady, with one value per channel, so that any number of
+ * channels may be exported as a single, wide table.
+ *
+ * Each channel is resampled according to the method(). Method::Linear interpolates between the samples either side of
+ * each grid time, and Method::Hold holds the latest sample at, or before, each grid time; if maximumGap() is non-zero,
+ * then neither bridges any interval longer than that (such as while a device was disconnected). Method::Decimate
+ * averages the samples within half a period either side of each grid time, so that sources sampled faster than the
+ * grid (such as DSO samples) are low-pass filtered, rather than aliased, as they are decimated. Any value that cannot
+ * be resampled (such as before a channel's first sample, or within a gap) is NaN.
+ *
+ * Within a channel, samples must be added in timestamp order; samples not after the channel's previous sample, and
+ * non-finite samples, are ignored. Each row is emitted once every channel has reached it, so the samples of channels
+ * that are ahead of the others are buffered (up to maxPendingSamples per channel) until the others catch up. Only
+ * the samples still needed are buffered, so memory is bounded, no matter how long the session. At the end of the
+ * streams, flush() emits the remaining rows, as far as the furthest channel.
+ */
+
+/*!
+ * Constructs a new Resampler object, for \a channels channels, with \a parent.
+ */
+Resampler::Resampler(const int channels, QObject * parent)
+    : Resampler(new ResamplerPrivate(this), channels, parent)
+{
+
+}
+
+/*!
+ * \cond internal
+ * Constructs a new Resampler object, for \a channels channels, with \a parent, and private implementation \a d.
+ */
+Resampler::Resampler(ResamplerPrivate * const d, const int channels, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->channels.resize(qMax(channels, 0));
+}
+/// \endcond
+
+/*!
+ * Destroys this Resampler object.
+ */
+Resampler::~Resampler()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the number of channels being resampled.
+ */
+int Resampler::channelCount() const
+{
+    Q_D(const Resampler);
+    return (int)d->channels.size();
+}
+
+/*!
+ * Returns how samples are resampled. The default is Method::Linear.
+ */
+Resampler::Method Resampler::method() const
+{
+    Q_D(const Resampler);
+    return d->method;
+}
+
+/*!
+ * Sets how samples are resampled to \a method. This should be set before any samples are added.
+ */
+void Resampler::setMethod(const Method method)
+{
+    Q_D(Resampler);
+    d->method = method;
+}
+
+/*!
+ * Returns the interval between grid times, in milliseconds. The default is 1000 (ie one row per second).
+ */
+quint32 Resampler::period() const
+{
+    Q_D(const Resampler);
+    return d->period;
+}
+
+/*!
+ * Sets the interval between grid times to \a period milliseconds. This should be set before any samples are added.
+ * A \a period of 0 is invalid, and ignored.
+ */
+void Resampler::setPeriod(const quint32 period)
+{
+    Q_D(Resampler);
+    if (period == 0) {
+        qCWarning(d->lc).noquote() << tr("Ignoring invalid resampling period: %1").arg(period);
+        return;
+    }
+    d->period = period;
+}
+
+/*!
+ * Returns the longest interval, in milliseconds, between samples that may be interpolated, or held, across, or 0
+ * (the default) for no limit. This does not apply to Method::Decimate.
+ */
+quint32 Resampler::maximumGap() const
+{
+    Q_D(const Resampler);
+    return d->maximumGap;
+}
+
+/*!
+ * Sets the longest interval between samples that may be interpolated, or held, across to \a gap milliseconds, or 0
+ * for no limit.
+ */
+void Resampler::setMaximumGap(const quint32 gap)
+{
+    Q_D(Resampler);
+    d->maximumGap = gap;
+}
+
+/*!
+ * Adds a \a value, taken at \a timestamp (in milliseconds since the epoch), to \a channel, then emits rowReady for
+ * each grid time that all channels have now reached.
+ */
+void Resampler::addSample(const int channel, const float value, const qint64 timestamp)
+{
+    Q_D(Resampler);
+    d->addSample(channel, value, timestamp);
+}
+
+/*!
+ * Emits rowReady for each remaining grid time, as far as the furthest channel has reached, resampling each channel
+ * from whatever samples it has. Typically, this is called once, at the end of the streams.
+ */
+void Resampler::flush()
+{
+    Q_D(Resampler);
+    if (!d->start(true)) {
+        return; // No samples yet.
+    }
+    qint64 last = std::numeric_limits<qint64>::min();
+    for (const ResamplerPrivate::Channel &channel: std::as_const(d->channels)) {
+        last = qMax(last, d->lastIndex(channel, true));
+    }
+    d->emitRows(last);
+}
+
+/*!
+ * Discards all buffered samples, and the grid's position, but not the method(), period() or maximumGap(). Remaining
+ * rows are not emitted first; call flush() before reset() for that.
+ */
+void Resampler::reset()
+{
+    Q_D(Resampler);
+    for (ResamplerPrivate::Channel &channel: d->channels) {
+        channel = ResamplerPrivate::Channel{};
+    }
+    d->next = std::numeric_limits<qint64>::min();
+}
+
+/*!
+ * \fn Resampler::rowReady
+ *
+ * This signal is emitted with one value per channel (in channel order), resampled at \a timestamp (in milliseconds
+ * since the epoch), being the next time on the grid. Any \a values that could not be resampled are NaN.
+ */
+
+/*!
+ * \cond internal
+ * \class ResamplerPrivate
+ *
+ * The ResamplerPrivate class provides private implementation for Resampler.
+ */
+
+/*!
+ * Constructs a new ResamplerPrivate object with public implementation \a q.
+ */
+ResamplerPrivate::ResamplerPrivate(Resampler * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Appends \a value, taken at \a timestamp, to \a channel (or to its current bin, for Resampler::Method::Decimate),
+ * then emits each row that all channels have now reached. If \a channel already holds maxPendingSamples samples (or
+ * bins), the oldest is discarded.
+ */
+void ResamplerPrivate::addSample(const int channel, const float value, const qint64 timestamp)
+{
+    if ((channel < 0) || (channel >= channels.size())) {
+        qCWarning(lc).noquote() << tr("Ignoring sample for invalid channel %1.").arg(channel);
+        return;
+    }
+    if (!qIsFinite(value)) {
+        qCDebug(lc).noquote() << tr("Ignoring non-finite sample at %1.").arg(timestamp);
+        return;
+    }
+    Channel &ch = channels[channel];
+    if ((ch.first != std::numeric_limits<qint64>::min()) && (timestamp <= ch.last)) {
+        qCDebug(lc).noquote() << tr("Ignoring out-of-order sample at %1 (after %2).").arg(timestamp).arg(ch.last);
+        return;
+    }
+
+    if (method == Resampler::Method::Decimate) {
+        const qint64 index = floorDiv(timestamp + period/2, period);
+        if ((!ch.bins.isEmpty()) && (ch.bins.constLast().index == index)) {
+            ch.bins.last().sum += value;
+            ++ch.bins.last().count;
+        } else {
+            if (ch.bins.size() >= Resampler::maxPendingSamples) {
+                qCDebug(lc).noquote() << tr("Discarding unresampled bin %1.").arg(ch.bins.constFirst().index);
+                ch.bins.removeFirst();
+            }
+            ch.bins.append({ index, value, 1 });
+        }
+    } else {
+        if (ch.samples.size() >= Resampler::maxPendingSamples) {
+            qCDebug(lc).noquote() << tr("Discarding unresampled sample at %1.").arg(ch.samples.constFirst().timestamp);
+            ch.samples.removeFirst();
+        }
+        ch.samples.append({ timestamp, value });
+    }
+    if (ch.first == std::numeric_limits<qint64>::min()) {
+        ch.first = timestamp;
+    }
+    ch.last = timestamp;
+
+    if (!start(false)) {
+        return; // Not all channels have samples yet.
+    }
+    qint64 last = std::numeric_limits<qint64>::max();
+    for (const Channel &other: std::as_const(channels)) {
+        last = qMin(last, lastIndex(other, false));
+    }
+    emitRows(last);
+}
+
+/*!
+ * Sets #next to the first grid time that any channel has reached, if not already set. Unless \a flushing, this
+ * waits for every channel to have at least one sample, so that rows are not emitted before a slow channel's first
+ * sample arrives. Returns \c true if #next is set.
+ */
+bool ResamplerPrivate::start(const bool flushing)
+{
+    if (next != std::numeric_limits<qint64>::min()) {
+        return true;
+    }
+    qint64 first = std::numeric_limits<qint64>::max();
+    for (const Channel &channel: std::as_const(channels)) {
+        if (channel.first != std::numeric_limits<qint64>::min()) {
+            first = qMin(first, firstIndex(channel));
+        } else if (!flushing) {
+            return false;
+        }
+    }
+    if (first == std::numeric_limits<qint64>::max()) {
+        return false; // No channels have samples.
+    }
+    next = first;
+    return true;
+}
+
+/*!
+ * Returns the index of the first grid time that \a channel may be resampled at.
+ */
+qint64 ResamplerPrivate::firstIndex(const Channel &channel) const
+{
+    if (method == Resampler::Method::Decimate) {
+        return floorDiv(channel.first + period/2, period); // The first sample's bin.
+    }
+    return -floorDiv(-channel.first, period); // The first grid time at, or after, the first sample.
+}
+
+/*!
+ * Returns the index of the last grid time that \a channel has reached. That is, the last grid time that no later
+ * samples could affect the resampled value of, or if \a flushing, the last grid time with any samples at all.
+ * Returns the lowest possible index if \a channel has no samples.
+ */
+qint64 ResamplerPrivate::lastIndex(const Channel &channel, const bool flushing) const
+{
+    if (channel.first == std::numeric_limits<qint64>::min()) {
+        return std::numeric_limits<qint64>::min();
+    }
+    if (method == Resampler::Method::Decimate) {
+        // A sample after (or at) the end of a bin completes that bin.
+        return floorDiv(channel.last + period/2, period) - (flushing ? 0 : 1);
+    }
+    return floorDiv(channel.last, period); // The last grid time at, or before, the latest sample.
+}
+
+/*!
+ * Emits a row for each grid time from #next to \a last (inclusive), then trims each channel to just the samples
+ * still needed.
+ */
+void ResamplerPrivate::emitRows(const qint64 last)
+{
+    Q_Q(Resampler);
+    QVector<float> values(channels.size());
+    for (; next <= last; ++next) {
+        for (int index = 0; index < channels.size(); ++index) {
+            values[index] = valueAt(channels.at(index), next);
+        }
+        Q_EMIT q->rowReady(next * (qint64)period, values);
+    }
+    for (Channel &channel: channels) {
+        trim(channel);
+    }
+}
+
+/*!
+ * Returns the value of \a channel resampled at the grid time with \a index, according to #method, or NaN if it
+ * cannot be resampled there.
+ */
+float ResamplerPrivate::valueAt(const Channel &channel, const qint64 index) const
+{
+    if (method == Resampler::Method::Decimate) {
+        const auto bin = std::lower_bound(channel.bins.cbegin(), channel.bins.cend(), index,
+            [](const Bin &candidate, const qint64 target) { return candidate.index < target; });
+        return ((bin == channel.bins.cend()) || (bin->index != index))
+            ? qQNaN() : (float)(bin->sum / (double)bin->count);
+    }
+
+    const qint64 timestamp = index * (qint64)period;
+    const auto after = std::upper_bound(channel.samples.cbegin(), channel.samples.cend(), timestamp,
+        [](const qint64 time, const Sample &sample) { return time < sample.timestamp; });
+    if (after == channel.samples.cbegin()) {
+        return qQNaN(); // Before the first sample.
+    }
+    const Sample &before = *(after - 1);
+    if (before.timestamp == timestamp) {
+        return before.value;
+    }
+    if (method == Resampler::Method::Hold) {
+        return ((maximumGap > 0) && (timestamp - before.timestamp > maximumGap)) ? qQNaN() : before.value;
+    }
+    if ((after == channel.samples.cend()) || ((maximumGap > 0) && (after->timestamp - before.timestamp > maximumGap))) {
+        return qQNaN(); // Beyond the last sample, or within a gap.
+    }
+    const double fraction = (double)(timestamp - before.timestamp) / (double)(after->timestamp - before.timestamp);
+    return (float)(before.value + (after->value - before.value) * fraction);
+}
+
+/*!
+ * Removes all of \a channel's samples before the latest sample at, or before, the #next grid time (since that sample
+ * is the earliest that later rows may be resampled from), and all of its bins before the #next grid time.
+ */
+void ResamplerPrivate::trim(Channel &channel) const
+{
+    if (method == Resampler::Method::Decimate) {
+        const auto bin = std::lower_bound(channel.bins.cbegin(), channel.bins.cend(), next,
+            [](const Bin &candidate, const qint64 target) { return candidate.index < target; });
+        channel.bins.remove(0, bin - channel.bins.cbegin());
+        return;
+    }
+    const qint64 timestamp = next * (qint64)period;
+    const auto after = std::upper_bound(channel.samples.cbegin(), channel.samples.cend(), timestamp,
+        [](const qint64 time, const Sample &sample) { return time < sample.timestamp; });
+    if (const qsizetype obsolete = (after - channel.samples.cbegin()) - 1; obsolete > 0) {
+        channel.samples.remove(0, obsolete);
+    }
+}
+
+/*!
+ * Returns \a numerator divided by \a denominator, rounded towards negative infinity (rather than towards zero, as
+ * integer division is), so that grid times before the epoch are indexed consistently.
+ */
+qint64 ResamplerPrivate::floorDiv(const qint64 numerator, const qint64 denominator)
+{
+    const qint64 quotient = numerator / denominator;
+    return (((numerator % denominator) != 0) && ((numerator < 0) != (denominator < 0))) ? quotient - 1 : quotient;
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
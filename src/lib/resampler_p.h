@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the ResamplerPrivate class.
+ */
+
+#ifndef QTPOKIT_RESAMPLER_P_H
+#define QTPOKIT_RESAMPLER_P_H
+
+#include <qtpokit/resampler.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+#include <QVector>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT ResamplerPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.resampler", QtInfoMsg); ///< Logging category.
+
+    /// A single timestamped sample.
+    struct Sample {
+        qint64 timestamp; ///< Time of the sample, in milliseconds since the epoch.
+        float value;      ///< Value of the sample.
+    };
+
+    /// The sum of a channel's samples nearest to a single grid time, for Resampler::Method::Decimate.
+    struct Bin {
+        qint64 index;   ///< Index of the grid time (ie the time divided by the period).
+        double sum;     ///< Sum of the samples' values.
+        quint32 count;  ///< Number of samples summed.
+    };
+
+    /// A single channel's samples, not yet resampled.
+    struct Channel {
+        QVector<Sample> samples; ///< Samples still needed, for Resampler::Method::Linear and Hold.
+        QVector<Bin> bins;       ///< Bins not yet resampled, for Resampler::Method::Decimate.
+        qint64 first { std::numeric_limits<qint64>::min() }; ///< Time of the channel's first sample, if any.
+        qint64 last { std::numeric_limits<qint64>::min() };  ///< Time of the channel's latest sample, if any.
+    };
+
+    Resampler::Method method { Resampler::Method::Linear }; ///< How samples are resampled.
+    quint32 period { 1000 };  ///< Interval between grid times, in milliseconds.
+    quint32 maximumGap { 0 }; ///< Longest interval to interpolate, or hold, across, or 0 for no limit.
+    QVector<Channel> channels;  ///< Each channel's pending samples.
+    qint64 next { std::numeric_limits<qint64>::min() }; ///< Index of the next grid time to emit, once known.
+
+    explicit ResamplerPrivate(Resampler * const q);
+
+    void addSample(const int channel, const float value, const qint64 timestamp);
+    bool start(const bool flushing);
+    qint64 firstIndex(const Channel &channel) const;
+    qint64 lastIndex(const Channel &channel, const bool flushing) const;
+    void emitRows(const qint64 last);
+    float valueAt(const Channel &channel, const qint64 index) const;
+    void trim(Channel &channel) const;
+    static qint64 floorDiv(const qint64 numerator, const qint64 denominator);
+
+protected:
+    Resampler * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(Resampler)
+    Q_DISABLE_COPY(ResamplerPrivate)
+    QTPOKIT_BEFRIEND_TEST(Resampler)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_RESAMPLER_P_H
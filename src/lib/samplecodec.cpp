@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the SampleCodec namespace.
+ */
+
+#include <qtpokit/samplecodec.h>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \namespace SampleCodec
+ *
+ * The SampleCodec namespace provides a compact, lossless encoding for series of `int16` samples, such as DSO and data
+ * logger samples. Since consecutive samples of slowly varying signals differ only slightly, each sample is encoded as
+ * its difference from the previous sample, zigzag-mapped to an unsigned value (so that small negative differences are
+ * small too), and then written as a little-endian base-128 varint. So differences of -64 to 63 take one byte, -8,192
+ * to 8,191 take two bytes, and all others three bytes.
+ *
+ * Differences are calculated modulo 2^16, so every `int16` series can be encoded, and no difference needs more than
+ * three bytes. The first sample is encoded relative to a \a previous value (zero by default). Consecutive runs of the
+ * same series may be encoded separately, and the results concatenated, by passing each run's last sample as the next
+ * run's \a previous value.
+ *
+ * The encoding is not self-describing; callers must record the number of encoded samples (or the encoded size)
+ * wherever the encoded bytes are stored.
+ */
+
+namespace SampleCodec {
+
+namespace {
+
+/*!
+ * Decodes up to \a count samples, relative to \a previous, from \a in to \a samples, stopping early if \a end is
+ * reached. \a in is advanced past the decoded bytes.
+ *
+ * Returns the number of samples decoded, or `-1` if the data ends part way through a sample, or is invalid.
+ */
+qsizetype decodeSamples(const uchar * &in, const uchar * const end, qint16 * const samples, const qsizetype count,
+                        quint16 previous)
+{
+    qsizetype index = 0;
+    for (; (index < count) && (in < end); ++index) {
+        quint32 value = *in++;
+        if (value & 0x80) { // Two (or three) byte varint; single bytes are by far the most common.
+            if (in == end) {
+                return -1;
+            }
+            value = (value & 0x7F) | ((quint32)(*in & 0x7F) << 7);
+            if (*in++ & 0x80) {
+                if ((in == end) || (*in > 0x03)) {
+                    return -1; // Truncated, or wider than 16 bits.
+                }
+                value |= (quint32)(*in++) << 14;
+            }
+        }
+        previous = (quint16)(previous + ((value >> 1) ^ (0u - (value & 1u)))); // Undo the zigzag, and the delta.
+        samples[index] = (qint16)previous;
+    }
+    return index;
+}
+
+}
+
+/*!
+ * Returns the maximum number of bytes that encode() may produce for \a count samples.
+ */
+qsizetype maxEncodedSize(const qsizetype count)
+{
+    return count * 3;
+}
+
+/*!
+ * Encodes \a count \a samples as zigzag varint deltas, with the first sample relative to \a previous, to \a data.
+ *
+ * \a data must have room for at least maxEncodedSize() bytes.
+ *
+ * Returns the number of bytes encoded.
+ */
+qsizetype encode(const qint16 * const samples, const qsizetype count, char * const data, const qint16 previous)
+{
+    char * out = data;
+    quint16 last = (quint16)previous;
+    for (qsizetype index = 0; index < count; ++index) {
+        const quint16 delta = (quint16)((quint16)samples[index] - last);
+        quint16 value = (quint16)((delta << 1) ^ ((delta & 0x8000) ? 0xFFFF : 0)); // Zigzag.
+        while (value >= 0x80) {
+            *out++ = (char)((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        *out++ = (char)value;
+        last = (quint16)samples[index];
+    }
+    return out - data;
+}
+
+/*!
+ * Returns \a samples encoded as zigzag varint deltas, with the first sample relative to \a previous.
+ */
+QByteArray encode(const QVector<qint16> &samples, const qint16 previous)
+{
+    QByteArray result(maxEncodedSize(samples.size()), Qt::Uninitialized);
+    result.truncate(encode(samples.constData(), samples.size(), result.data(), previous));
+    return result;
+}
+
+/*!
+ * Decodes \a count samples, encoded relative to \a previous, from the \a size bytes at \a data, to \a samples.
+ *
+ * \a samples must have room for at least \a count samples.
+ *
+ * Returns the number of bytes decoded, or `-1` if \a data does not contain \a count validly encoded samples.
+ */
+qsizetype decode(const char * const data, const qsizetype size, qint16 * const samples, const qsizetype count,
+                 const qint16 previous)
+{
+    const uchar * in = reinterpret_cast<const uchar *>(data);
+    const qsizetype decoded = decodeSamples(in, in + size, samples, count, (quint16)previous);
+    return (decoded == count) ? (qsizetype)(in - reinterpret_cast<const uchar *>(data)) : -1;
+}
+
+/*!
+ * Returns all of the samples encoded (by encode(), with the default \a previous value) in \a data.
+ *
+ * If \a ok is not `nullptr`, it is set to `true` on success, or `false` if \a data is invalid, in which case an empty
+ * vector is returned.
+ */
+QVector<qint16> decode(const QByteArray &data, bool * const ok)
+{
+    QVector<qint16> samples(data.size()); // Every sample takes at least one byte.
+    const uchar * in = reinterpret_cast<const uchar *>(data.constData());
+    const qsizetype decoded = decodeSamples(in, in + data.size(), samples.data(), samples.size(), 0);
+    if (ok) {
+        *ok = (decoded >= 0);
+    }
+    if (decoded < 0) {
+        return { };
+    }
+    samples.resize(decoded);
+    return samples;
+}
+
+}
+
+QTPOKIT_END_NAMESPACE
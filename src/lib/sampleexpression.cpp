@@ -0,0 +1,619 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the SampleExpression class.
+ */
+
+#include <qtpokit/sampleexpression.h>
+#include "../stringliterals_p.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class SampleExpression
+ *
+ * The SampleExpression class evaluates a formula, such as `(v - 0.5) * 40` or `max(a, b) > 3.3`, over blocks of
+ * values, for deriving channels (such as scaled sensor conversions, ratios and thresholds) from one, or more, named
+ * input streams.
+ *
+ * The formula is parsed just once, by compile(), into a short program of instructions, with constant sub-expressions
+ * folded away. Each instruction applies a single operation to whole runs (of up to #chunkSize) of values at a time,
+ * rather than the whole formula being interpreted for each value in turn. So the cost of interpretation is paid once
+ * per instruction, per run, while each instruction's inner loop is a simple, branch-free, loop over contiguous values,
+ * that the compiler can vectorise; and since runs are short, the temporaries holding intermediate results stay in the
+ * CPU's cache.
+ *
+ * Formulas support:
+ * * numbers (such as `3`, `0.5` and `1e-3`), and the constants `pi` and `e`;
+ * * variables, being the names given to compile(), which take precedence over constants of the same name;
+ * * the arithmetic operators `+`, `-`, `*`, `/`, `%` (remainder) and `^` (power, binding tighter than unary minus, so
+ *   `-2^2` is -4);
+ * * the comparison operators `<`, `<=`, `>`, `>=`, `==` and `!=`, and the logical operators `!`, `&&` and `||`, all
+ *   of which give 1 for true, and 0 for false, while treating any non-zero value as true;
+ * * the functions `abs`, `sqrt`, `exp`, `log` (natural), `log10`, `sin`, `cos`, `tan`, `floor`, `ceil` and `round` of
+ *   one argument; `min`, `max` and `pow` of two; and `clamp(x, lo, hi)` and `if(condition, then, else)` of three;
+ * * and parentheses, nested up to #maximumDepth deep.
+ *
+ * Both sides of logical operators, and `if()`, are always evaluated, since whole runs of values are evaluated at once.
+ * Evaluation is not thread-safe, since each SampleExpression reuses its own buffers for temporaries; but copies of a
+ * SampleExpression may be evaluated concurrently.
+ */
+
+/*!
+ * \cond internal
+ * \class SampleExpression::Compiler
+ *
+ * The SampleExpression::Compiler class parses a formula, by recursive descent, emitting instructions (or folding
+ * constants) as it goes, and reusing temporaries as soon as the instructions reading them have been emitted.
+ */
+class SampleExpression::Compiler
+{
+public:
+    explicit Compiler(SampleExpression &expression) : expression(expression), text(expression.source) { }
+
+    /// Compiles the whole formula, returning \c true on success, otherwise \c false with #error set.
+    bool run()
+    {
+        const Operand operand = parseOr();
+        skipSpaces();
+        if ((error.isEmpty()) && (position < text.size())) {
+            fail(unexpected());
+        }
+        expression.result = operand;
+        return error.isEmpty();
+    }
+
+    QString error; ///< Why the formula failed to compile, if it did.
+
+private:
+    SampleExpression &expression; ///< Expression being compiled.
+    const QString &text;          ///< Formula being compiled.
+    qsizetype position { 0 };     ///< Position of the next character to parse.
+    int depth { 0 };              ///< Current nesting depth.
+    QVector<int> available;       ///< Temporaries no longer in use, for reuse.
+
+    /// Records \a message as the #error, unless an earlier error has already been recorded.
+    void fail(const QString &message)
+    {
+        if (error.isEmpty()) {
+            error = message;
+        }
+    }
+
+    /// Returns a description of the unexpected next character (or end of the formula).
+    QString unexpected() const
+    {
+        return (position >= text.size()) ? tr("Unexpected end of expression")
+            : tr("Unexpected character '%1' at position %2").arg(text.at(position)).arg(position + 1);
+    }
+
+    void skipSpaces()
+    {
+        while ((position < text.size()) && (text.at(position).isSpace())) {
+            ++position;
+        }
+    }
+
+    /// Consumes \a token, if next (and not followed by \a unless), returning whether it was consumed.
+    bool accept(const QString &token, const QChar unless = QChar())
+    {
+        skipSpaces();
+        if ((!QStringView(text).mid(position).startsWith(token)) || ((!unless.isNull()) &&
+            (position + token.size() < text.size()) && (text.at(position + token.size()) == unless))) {
+            return false;
+        }
+        position += token.size();
+        return true;
+    }
+
+    /// Returns an operand applying \a op to \a operands, being a folded constant, if all \a operands are constants.
+    Operand emit(const Op op, const QVector<Operand> &operands)
+    {
+        Instruction instruction{ op, (int)operands.size(), { }, 0 };
+        bool constant = true;
+        for (int index = 0; index < instruction.arity; ++index) {
+            instruction.operands[index] = operands.at(index);
+            constant = constant && (operands.at(index).kind == Operand::Kind::Constant);
+        }
+        if (constant) {
+            const float * values[3];
+            qsizetype strides[3] { 0, 0, 0 };
+            for (int index = 0; index < instruction.arity; ++index) {
+                values[index] = &instruction.operands[index].value;
+            }
+            Operand folded;
+            execute(op, instruction.arity, values, strides, &folded.value, 1);
+            return folded;
+        }
+
+        // Release the operands' temporaries first, so the result may reuse one of them (evaluating in place).
+        for (int index = 0; index < instruction.arity; ++index) {
+            if (operands.at(index).kind == Operand::Kind::Temporary) {
+                available.append(operands.at(index).index);
+            }
+        }
+        instruction.target = (available.isEmpty()) ? expression.temporaries++ : available.takeLast();
+        expression.program.append(instruction);
+        return { Operand::Kind::Temporary, instruction.target, 0.0f };
+    }
+
+    Operand parseOr()
+    {
+        Operand left = parseAnd();
+        while ((error.isEmpty()) && (accept(u"||"_s))) {
+            left = emit(Op::Or, { left, parseAnd() });
+        }
+        return left;
+    }
+
+    Operand parseAnd()
+    {
+        Operand left = parseComparison();
+        while ((error.isEmpty()) && (accept(u"&&"_s))) {
+            left = emit(Op::And, { left, parseComparison() });
+        }
+        return left;
+    }
+
+    Operand parseComparison()
+    {
+        Operand left = parseAdditive();
+        while (error.isEmpty()) {
+            // Longest tokens first, so that `<=` is not taken for `<`. Op::Neg (being unary) means no operator.
+            const Op op = (accept(u"<="_s)) ? Op::Le : (accept(u">="_s)) ? Op::Ge : (accept(u"=="_s)) ? Op::Eq
+                : (accept(u"!="_s)) ? Op::Ne : (accept(u"<"_s)) ? Op::Lt : (accept(u">"_s)) ? Op::Gt : Op::Neg;
+            if (op == Op::Neg) {
+                break;
+            }
+            left = emit(op, { left, parseAdditive() });
+        }
+        return left;
+    }
+
+    Operand parseAdditive()
+    {
+        Operand left = parseMultiplicative();
+        while (error.isEmpty()) {
+            const Op op = (accept(u"+"_s)) ? Op::Add : (accept(u"-"_s)) ? Op::Sub : Op::Neg;
+            if (op == Op::Neg) {
+                break;
+            }
+            left = emit(op, { left, parseMultiplicative() });
+        }
+        return left;
+    }
+
+    Operand parseMultiplicative()
+    {
+        Operand left = parseUnary();
+        while (error.isEmpty()) {
+            const Op op = (accept(u"*"_s)) ? Op::Mul : (accept(u"/"_s)) ? Op::Div : (accept(u"%"_s)) ? Op::Mod
+                : Op::Neg;
+            if (op == Op::Neg) {
+                break;
+            }
+            left = emit(op, { left, parseUnary() });
+        }
+        return left;
+    }
+
+    Operand parseUnary()
+    {
+        if (++depth > maximumDepth) {
+            fail(tr("Expression nested more than %1 deep").arg(maximumDepth));
+        }
+        Operand operand;
+        if (!error.isEmpty()) {
+            // Already failed, so parse no further.
+        } else if (accept(u"-"_s)) {
+            operand = emit(Op::Neg, { parseUnary() });
+        } else if (accept(u"+"_s)) {
+            operand = parseUnary();
+        } else if (accept(u"!"_s, u'=')) {
+            operand = emit(Op::Not, { parseUnary() });
+        } else {
+            operand = parsePower();
+        }
+        --depth;
+        return operand;
+    }
+
+    Operand parsePower()
+    {
+        const Operand base = parsePrimary();
+        if ((error.isEmpty()) && (accept(u"^"_s))) {
+            return emit(Op::Pow, { base, parseUnary() }); // Right associative, so 2^3^2 is 2^9.
+        }
+        return base;
+    }
+
+    Operand parsePrimary()
+    {
+        skipSpaces();
+        if (accept(u"("_s)) {
+            const Operand operand = parseOr();
+            if ((error.isEmpty()) && (!accept(u")"_s))) {
+                fail(unexpected());
+            }
+            return operand;
+        }
+        if (position >= text.size()) {
+            fail(unexpected());
+            return { };
+        }
+
+        const QChar first = text.at(position);
+        const QChar next = (position + 1 < text.size()) ? text.at(position + 1) : QChar();
+        if ((first.isDigit()) || ((first == u'.') && (next.isDigit()))) {
+            return parseNumber();
+        }
+        if ((first.isLetter()) || (first == u'_')) {
+            const qsizetype start = position;
+            for (; position < text.size(); ++position) {
+                if ((!text.at(position).isLetterOrNumber()) && (text.at(position) != u'_')) {
+                    break;
+                }
+            }
+            const QString name = text.mid(start, position - start);
+            return (accept(u"("_s)) ? parseCall(name) : lookup(name);
+        }
+        fail(unexpected());
+        return { };
+    }
+
+    Operand parseNumber()
+    {
+        const qsizetype start = position;
+        const auto skipDigits = [this]() {
+            while ((position < text.size()) && (text.at(position).isDigit())) {
+                ++position;
+            }
+        };
+        skipDigits();
+        if ((position < text.size()) && (text.at(position) == u'.')) {
+            ++position;
+            skipDigits();
+        }
+        if ((position < text.size()) && ((text.at(position) == u'e') || (text.at(position) == u'E'))) {
+            const qsizetype mark = position++;
+            if ((position < text.size()) && ((text.at(position) == u'+') || (text.at(position) == u'-'))) {
+                ++position;
+            }
+            if ((position >= text.size()) || (!text.at(position).isDigit())) {
+                position = mark; // Not an exponent after all, such as the `e` of `2e`, so leave it be.
+            } else {
+                skipDigits();
+            }
+        }
+        bool ok = false;
+        Operand operand;
+        operand.value = text.mid(start, position - start).toFloat(&ok);
+        if (!ok) {
+            fail(tr("Invalid number at position %1: %2").arg(start + 1).arg(text.mid(start, position - start)));
+        }
+        return operand;
+    }
+
+    /// Returns the variable, or constant, called \a name.
+    Operand lookup(const QString &name)
+    {
+        if (const qsizetype index = expression.names.indexOf(name); index >= 0) {
+            return { Operand::Kind::Variable, (int)index, 0.0f };
+        }
+        if (name == u"pi"_s) {
+            return { Operand::Kind::Constant, 0, (float)M_PI };
+        }
+        if (name == u"e"_s) {
+            return { Operand::Kind::Constant, 0, (float)M_E };
+        }
+        fail(tr("Unknown variable: %1").arg(name));
+        return { };
+    }
+
+    /// Parses the arguments of a call to the function called \a name, whose opening parenthesis has been consumed.
+    Operand parseCall(const QString &name)
+    {
+        struct Function { const char16_t * name; Op op; int arity; };
+        static constexpr Function functions[] {
+            { u"abs",   Op::Abs,   1 }, { u"sqrt",  Op::Sqrt,  1 }, { u"exp",   Op::Exp,   1 },
+            { u"log",   Op::Log,   1 }, { u"log10", Op::Log10, 1 }, { u"sin",   Op::Sin,   1 },
+            { u"cos",   Op::Cos,   1 }, { u"tan",   Op::Tan,   1 }, { u"floor", Op::Floor, 1 },
+            { u"ceil",  Op::Ceil,  1 }, { u"round", Op::Round, 1 }, { u"min",   Op::Min,   2 },
+            { u"max",   Op::Max,   2 }, { u"pow",   Op::Pow,   2 }, { u"if",    Op::Select, 3 },
+            { u"clamp", Op::Max,   3 }, // Emitted as min(max(x, lo), hi).
+        };
+        const Function * const function = std::find_if(std::begin(functions), std::end(functions),
+            [&name](const Function &function) { return name == QStringView(function.name); });
+        if (function == std::end(functions)) {
+            fail(tr("Unknown function: %1").arg(name));
+            return { };
+        }
+
+        ++depth; // Arguments' own nesting is counted by parseUnary().
+        QVector<Operand> arguments;
+        if (!accept(u")"_s)) {
+            do {
+                arguments.append(parseOr());
+            } while ((error.isEmpty()) && (accept(u","_s)));
+            if ((error.isEmpty()) && (!accept(u")"_s))) {
+                fail(unexpected());
+            }
+        }
+        --depth;
+        if (!error.isEmpty()) {
+            return { };
+        }
+        if (arguments.size() != function->arity) {
+            fail(tr("Function %1 takes %n argument(s), not %2", nullptr, function->arity).arg(name)
+                .arg(arguments.size()));
+            return { };
+        }
+        if (name == u"clamp"_s) {
+            return emit(Op::Min, { emit(Op::Max, { arguments.at(0), arguments.at(1) }), arguments.at(2) });
+        }
+        return emit(function->op, arguments);
+    }
+};
+/// \endcond
+
+/*!
+ * Constructs a new, invalid, SampleExpression object. See compile().
+ */
+SampleExpression::SampleExpression()
+{
+
+}
+
+/*!
+ * Constructs a new SampleExpression object, and compiles \a formula over \a variables. See compile().
+ */
+SampleExpression::SampleExpression(const QString &formula, const QStringList &variables)
+{
+    compile(formula, variables);
+}
+
+/*!
+ * Compiles \a formula, in which \a variables refer to the corresponding (by index) inputs of evaluate(). Returns
+ * \c true on success, otherwise \c false, with errorString() describing why, in which case the expression is invalid.
+ */
+bool SampleExpression::compile(const QString &formula, const QStringList &variables)
+{
+    source = formula;
+    names = variables;
+    error.clear();
+    program.clear();
+    result = Operand();
+    temporaries = 0;
+
+    Compiler compiler(*this);
+    if (!compiler.run()) {
+        error = tr(R"(Invalid expression "%1": %2)").arg(formula, compiler.error);
+        program.clear();
+        temporaries = 0;
+    }
+    scratch.fill(0.0f, temporaries * chunkSize);
+    return error.isEmpty();
+}
+
+/*!
+ * Returns \c true if the expression has been successfully compiled, otherwise \c false.
+ */
+bool SampleExpression::isValid() const
+{
+    return (!source.isNull()) && (error.isEmpty());
+}
+
+/*!
+ * Returns the formula last given to compile().
+ */
+QString SampleExpression::formula() const
+{
+    return source;
+}
+
+/*!
+ * Returns the names of the variables last given to compile().
+ */
+QStringList SampleExpression::variables() const
+{
+    return names;
+}
+
+/*!
+ * Returns a human-readable description of why the formula failed to compile, or an empty string if it did not.
+ */
+QString SampleExpression::errorString() const
+{
+    return error;
+}
+
+/*!
+ * Returns the number of instructions the formula compiled to. For example, `2 * pi * f` compiles to just one
+ * instruction, since `2 * pi` is folded into a single constant, and a formula of just a constant, or a variable, to
+ * none at all.
+ */
+qsizetype SampleExpression::instructionCount() const
+{
+    return program.size();
+}
+
+/*!
+ * Returns the result of evaluating the expression for a single set of \a values, being one per variable; or NaN if
+ * the expression is invalid, or there are fewer \a values than variables.
+ *
+ * This is a convenience for occasional values, such as single meter readings. For blocks of values, the other
+ * evaluate() overload is much faster, per value.
+ */
+float SampleExpression::evaluate(const QVector<float> &values) const
+{
+    if (values.size() < names.size()) {
+        return qQNaN();
+    }
+    QVector<const float *> inputs;
+    inputs.reserve(values.size());
+    for (const float &value: values) {
+        inputs.append(&value);
+    }
+    float output = 0.0f;
+    evaluate(inputs, &output, 1);
+    return output;
+}
+
+/*!
+ * Evaluates the expression for \a count values of each of \a inputs (being one array per variable), writing the
+ * results to \a output, which may be the same array as any of \a inputs. If the expression is invalid, \a output is
+ * filled with NaN.
+ */
+void SampleExpression::evaluate(const QVector<const float *> &inputs, float * const output,
+                                const qsizetype count) const
+{
+    if ((!isValid()) || (inputs.size() < names.size())) {
+        std::fill(output, output + count, qQNaN());
+        return;
+    }
+    float * const temporary = scratch.data(); // Detaches from any copies, just once.
+    for (qsizetype offset = 0; offset < count; offset += chunkSize) {
+        const qsizetype length = std::min(chunkSize, count - offset);
+        const auto resolve = [&](const Operand &operand, const float * &values, qsizetype &stride) {
+            switch (operand.kind) {
+            case Operand::Kind::Variable:  values = inputs.at(operand.index) + offset;           stride = 1; break;
+            case Operand::Kind::Temporary: values = temporary + operand.index * chunkSize;       stride = 1; break;
+            case Operand::Kind::Constant:  values = &operand.value;                              stride = 0; break;
+            }
+        };
+
+        bool written = false;
+        for (qsizetype index = 0; index < program.size(); ++index) {
+            const Instruction &instruction = program.at(index);
+            const float * values[3] { nullptr, nullptr, nullptr };
+            qsizetype strides[3] { 0, 0, 0 };
+            for (int operand = 0; operand < instruction.arity; ++operand) {
+                resolve(instruction.operands[operand], values[operand], strides[operand]);
+            }
+            // The last instruction (which gives the result) writes straight to the output, rather than a temporary.
+            written = (index == program.size() - 1) && (result.kind == Operand::Kind::Temporary)
+                && (result.index == instruction.target);
+            execute(instruction.op, instruction.arity, values, strides,
+                    (written) ? output + offset : temporary + instruction.target * chunkSize, length);
+        }
+        if (!written) {
+            const float * values = nullptr;
+            qsizetype stride = 0;
+            resolve(result, values, stride);
+            if (stride == 0) {
+                std::fill(output + offset, output + offset + length, *values);
+            } else if (values != output + offset) {
+                std::copy(values, values + length, output + offset);
+            }
+        }
+    }
+}
+
+/// \cond internal
+namespace {
+
+constexpr float truth(const bool value) { return (value) ? 1.0f : 0.0f; }
+
+/// Sets each of \a count \a output values to \a func of \a a's (with \a sa stride, being 0 or 1) values.
+template<typename Func>
+void map(float * const output, const float * const a, const qsizetype sa, const qsizetype count, Func func)
+{
+    if (sa == 0) {
+        std::fill(output, output + count, func(*a));
+        return;
+    }
+    for (qsizetype index = 0; index < count; ++index) {
+        output[index] = func(a[index]);
+    }
+}
+
+/// Sets each of \a count \a output values to \a func of \a a's and \a b's (with \a sa and \a sb strides) values.
+template<typename Func>
+void map(float * const output, const float * const a, const qsizetype sa, const float * const b, const qsizetype sb,
+         const qsizetype count, Func func)
+{
+    // Separate loops for each combination of strides, so that each is a simple loop the compiler can vectorise.
+    if ((sa != 0) && (sb != 0)) {
+        for (qsizetype index = 0; index < count; ++index) {
+            output[index] = func(a[index], b[index]);
+        }
+    } else if (sa != 0) {
+        const float y = *b;
+        for (qsizetype index = 0; index < count; ++index) {
+            output[index] = func(a[index], y);
+        }
+    } else if (sb != 0) {
+        const float x = *a;
+        for (qsizetype index = 0; index < count; ++index) {
+            output[index] = func(x, b[index]);
+        }
+    } else {
+        std::fill(output, output + count, func(*a, *b));
+    }
+}
+
+}
+
+/*!
+ * Applies \a op, of \a arity, to \a count elements of each of \a operands (with \a strides of 0, for constants, or 1),
+ * writing the results to \a output, which may be the same array as any of the \a operands.
+ */
+void SampleExpression::execute(const Op op, const int arity, const float * const * const operands,
+                               const qsizetype * const strides, float * const output, const qsizetype count)
+{
+    Q_UNUSED(arity)
+    const float * const a = operands[0];
+    const float * const b = operands[1];
+    const qsizetype sa = strides[0], sb = strides[1];
+    switch (op) {
+    case Op::Neg:   map(output, a, sa, count, [](float x) { return -x; }); break;
+    case Op::Not:   map(output, a, sa, count, [](float x) { return truth(x == 0.0f); }); break;
+    case Op::Abs:   map(output, a, sa, count, [](float x) { return std::fabs(x); }); break;
+    case Op::Sqrt:  map(output, a, sa, count, [](float x) { return std::sqrt(x); }); break;
+    case Op::Exp:   map(output, a, sa, count, [](float x) { return std::exp(x); }); break;
+    case Op::Log:   map(output, a, sa, count, [](float x) { return std::log(x); }); break;
+    case Op::Log10: map(output, a, sa, count, [](float x) { return std::log10(x); }); break;
+    case Op::Sin:   map(output, a, sa, count, [](float x) { return std::sin(x); }); break;
+    case Op::Cos:   map(output, a, sa, count, [](float x) { return std::cos(x); }); break;
+    case Op::Tan:   map(output, a, sa, count, [](float x) { return std::tan(x); }); break;
+    case Op::Floor: map(output, a, sa, count, [](float x) { return std::floor(x); }); break;
+    case Op::Ceil:  map(output, a, sa, count, [](float x) { return std::ceil(x); }); break;
+    case Op::Round: map(output, a, sa, count, [](float x) { return std::round(x); }); break;
+    case Op::Add:   map(output, a, sa, b, sb, count, [](float x, float y) { return x + y; }); break;
+    case Op::Sub:   map(output, a, sa, b, sb, count, [](float x, float y) { return x - y; }); break;
+    case Op::Mul:   map(output, a, sa, b, sb, count, [](float x, float y) { return x * y; }); break;
+    case Op::Div:   map(output, a, sa, b, sb, count, [](float x, float y) { return x / y; }); break;
+    case Op::Mod:   map(output, a, sa, b, sb, count, [](float x, float y) { return std::fmod(x, y); }); break;
+    case Op::Pow:   map(output, a, sa, b, sb, count, [](float x, float y) { return std::pow(x, y); }); break;
+    case Op::Min:   map(output, a, sa, b, sb, count, [](float x, float y) { return std::fmin(x, y); }); break;
+    case Op::Max:   map(output, a, sa, b, sb, count, [](float x, float y) { return std::fmax(x, y); }); break;
+    case Op::Lt:    map(output, a, sa, b, sb, count, [](float x, float y) { return truth(x < y); }); break;
+    case Op::Le:    map(output, a, sa, b, sb, count, [](float x, float y) { return truth(x <= y); }); break;
+    case Op::Gt:    map(output, a, sa, b, sb, count, [](float x, float y) { return truth(x > y); }); break;
+    case Op::Ge:    map(output, a, sa, b, sb, count, [](float x, float y) { return truth(x >= y); }); break;
+    case Op::Eq:    map(output, a, sa, b, sb, count, [](float x, float y) { return truth(x == y); }); break;
+    case Op::Ne:    map(output, a, sa, b, sb, count, [](float x, float y) { return truth(x != y); }); break;
+    case Op::And:
+        map(output, a, sa, b, sb, count, [](float x, float y) { return truth((x != 0.0f) && (y != 0.0f)); }); break;
+    case Op::Or:
+        map(output, a, sa, b, sb, count, [](float x, float y) { return truth((x != 0.0f) || (y != 0.0f)); }); break;
+    case Op::Select: {
+        const float * const c = operands[2];
+        const qsizetype sc = strides[2];
+        for (qsizetype index = 0; index < count; ++index) {
+            output[index] = (a[index * sa] != 0.0f) ? b[index * sb] : c[index * sc];
+        }
+    }   break;
+    }
+}
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
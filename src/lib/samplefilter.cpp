@@ -0,0 +1,454 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the SampleFilter and SampleFilterPrivate classes.
+ */
+
+#include <qtpokit/samplefilter.h>
+#include "samplefilter_p.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class SampleFilter
+ *
+ * The SampleFilter class applies a streaming FIR filter, and/or a cascade of biquad IIR sections, to DSO or data
+ * logger samples, as each `Reading` notification arrives, so that samples arrive already filtered.
+ *
+ * Filter state is kept between calls to process() (and between notifications), so a series of samples may be
+ * filtered in chunks of any size, with the same result as filtering the whole series at once. The state is only
+ * cleared by reset(), which happens automatically at the start of each capture (or logging session) when attached to
+ * a service.
+ *
+ * The FIR filter (if any) is applied first, then the biquad sections, in order. Since each is linear and
+ * time-invariant, the order makes no difference to the result, other than rounding. FIR filtering is performed in
+ * single precision, one contiguous dot product per output value, which compilers readily vectorise. Biquad sections
+ * are inherently recursive, so are instead applied one section at a time over the whole block (keeping each
+ * section's state in registers), in double precision, since low cutoff frequencies are sensitive to rounding.
+ *
+ * Biquad sections may be given explicit coefficients (via custom()), or designed for a response (via lowPass(),
+ * highPass() or notch()), per Robert Bristow-Johnson's "Audio EQ Cookbook", once the sample rate is known. When
+ * attached to a service, the sample rate is taken from each capture's (or session's) metadata.
+ */
+
+/*!
+ * Constructs a new SampleFilter object, not attached to any service, with \a parent. Samples may be filtered via
+ * process() instead.
+ */
+SampleFilter::SampleFilter(QObject * parent)
+    : QObject(parent), d_ptr(new SampleFilterPrivate(this))
+{
+
+}
+
+/*!
+ * Constructs a new SampleFilter object that filters samples from DSO \a service, with \a parent.
+ */
+SampleFilter::SampleFilter(DsoService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new SampleFilterPrivate(this))
+{
+    Q_D(SampleFilter);
+    d->setService(service);
+}
+
+/*!
+ * Constructs a new SampleFilter object that filters samples from data logger \a service, with \a parent.
+ */
+SampleFilter::SampleFilter(DataLoggerService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new SampleFilterPrivate(this))
+{
+    Q_D(SampleFilter);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new SampleFilter object with \a parent, and private implementation \a d.
+ */
+SampleFilter::SampleFilter(SampleFilterPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this SampleFilter object.
+ */
+SampleFilter::~SampleFilter()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the service this object filters samples from, if any.
+ */
+AbstractPokitService * SampleFilter::service() const
+{
+    Q_D(const SampleFilter);
+    return d->service;
+}
+
+/*!
+ * Returns the biquad sections, as set by setBiquads().
+ */
+QVector<SampleFilter::Biquad> SampleFilter::biquads() const
+{
+    Q_D(const SampleFilter);
+    return d->sections;
+}
+
+/*!
+ * Sets the cascade of biquad \a sections to apply, in order, and resets the filter state.
+ */
+void SampleFilter::setBiquads(const QVector<Biquad> &sections)
+{
+    Q_D(SampleFilter);
+    d->sections = sections;
+    d->design();
+    d->clear();
+}
+
+/*!
+ * Returns the FIR filter taps, as set by setFirTaps().
+ */
+QVector<float> SampleFilter::firTaps() const
+{
+    Q_D(const SampleFilter);
+    return d->taps;
+}
+
+/*!
+ * Sets the FIR filter \a taps (ie its impulse response) to apply, and resets the filter state. An empty \a taps
+ * disables FIR filtering.
+ */
+void SampleFilter::setFirTaps(const QVector<float> &taps)
+{
+    Q_D(SampleFilter);
+    d->taps = taps;
+    d->reversedTaps = taps;
+    std::reverse(d->reversedTaps.begin(), d->reversedTaps.end());
+    d->clear();
+}
+
+/*!
+ * Returns \c true if this filter has neither FIR taps, nor biquad sections, and so passes samples through unchanged.
+ */
+bool SampleFilter::isEmpty() const
+{
+    Q_D(const SampleFilter);
+    return (d->taps.isEmpty()) && (d->sections.isEmpty());
+}
+
+/*!
+ * Returns the sample rate, in Hz, that biquad sections are designed for, or 0 if not known yet.
+ */
+double SampleFilter::sampleRate() const
+{
+    Q_D(const SampleFilter);
+    return d->sampleRate;
+}
+
+/*!
+ * Sets the sample \a rate, in Hz, to design biquad sections for. The filter state is kept, if \a rate is unchanged.
+ */
+void SampleFilter::setSampleRate(const double rate)
+{
+    Q_D(SampleFilter);
+    if (rate != d->sampleRate) {
+        d->sampleRate = rate;
+        d->design();
+    }
+}
+
+/*!
+ * Returns biquad \a section as designed for the current sampleRate(). That is, with coefficients for its response.
+ */
+SampleFilter::Biquad SampleFilter::designed(const qsizetype section) const
+{
+    Q_D(const SampleFilter);
+    return d->coefficients.at(section);
+}
+
+/*!
+ * Filters \a count \a values in place, continuing from the state left by any previous call.
+ */
+void SampleFilter::process(float * const values, const qsizetype count)
+{
+    Q_D(SampleFilter);
+    if (count <= 0) {
+        return;
+    }
+    d->processFir(values, count);
+    d->processBiquads(values, count);
+}
+
+/*!
+ * Filters \a values in place, continuing from the state left by any previous call.
+ */
+void SampleFilter::process(QVector<float> &values)
+{
+    process(values.data(), values.size());
+}
+
+/*!
+ * Returns a biquad section with a low-pass response, with cutoff \a frequency (in Hz), and quality factor \a q. The
+ * default \a q gives a maximally flat (Butterworth) pass band.
+ */
+SampleFilter::Biquad SampleFilter::lowPass(const double frequency, const double q)
+{
+    return { Response::LowPass, frequency, q, 1.0, 0.0, 0.0, 0.0, 0.0 };
+}
+
+/*!
+ * Returns a biquad section with a high-pass response, with cutoff \a frequency (in Hz), and quality factor \a q. The
+ * default \a q gives a maximally flat (Butterworth) pass band.
+ */
+SampleFilter::Biquad SampleFilter::highPass(const double frequency, const double q)
+{
+    return { Response::HighPass, frequency, q, 1.0, 0.0, 0.0, 0.0, 0.0 };
+}
+
+/*!
+ * Returns a biquad section with a notch response, centred on \a frequency (in Hz), with quality factor \a q. Higher
+ * \a q values give narrower notches; the default gives a bandwidth of a tenth of \a frequency, which suits rejecting
+ * 50Hz (or 60Hz) mains hum.
+ */
+SampleFilter::Biquad SampleFilter::notch(const double frequency, const double q)
+{
+    return { Response::Notch, frequency, q, 1.0, 0.0, 0.0, 0.0, 0.0 };
+}
+
+/*!
+ * Returns a biquad section with explicit coefficients \a b0, \a b1, \a b2, \a a1 and \a a2, normalised such that a0
+ * is 1. That is, for the transfer function (b0 + b1z⁻¹ + b2z⁻²) / (1 + a1z⁻¹ + a2z⁻²).
+ */
+SampleFilter::Biquad SampleFilter::custom(const double b0, const double b1, const double b2, const double a1,
+                                          const double a2)
+{
+    return { Response::Custom, 0.0, 0.0, b0, b1, b2, a1, a2 };
+}
+
+/*!
+ * Returns \a section with its coefficients designed for its response at \a sampleRate (in Hz).
+ *
+ * Response::Custom sections are returned unchanged. Other sections that cannot be designed (such as those whose
+ * frequency is not below the Nyquist frequency, or when \a sampleRate is not yet known) pass samples through
+ * unchanged.
+ */
+SampleFilter::Biquad SampleFilter::design(const Biquad &section, const double sampleRate)
+{
+    if (section.response == Response::Custom) {
+        return section;
+    }
+    Biquad result = section;
+    result.b0 = 1.0;
+    result.b1 = result.b2 = result.a1 = result.a2 = 0.0;
+    if (!SampleFilterPrivate::isDesignable(section, sampleRate)) {
+        return result;
+    }
+
+    const double w0 = 2.0 * M_PI * section.frequency / sampleRate;
+    const double cosW0 = qCos(w0);
+    const double alpha = qSin(w0) / (2.0 * section.q);
+    const double a0 = 1.0 + alpha;
+    switch (section.response) {
+    case Response::Custom: // Returned as-is, above.
+        break;
+    case Response::LowPass:
+        result.b0 = result.b2 = (1.0 - cosW0) / 2.0 / a0;
+        result.b1 = (1.0 - cosW0) / a0;
+        break;
+    case Response::HighPass:
+        result.b0 = result.b2 = (1.0 + cosW0) / 2.0 / a0;
+        result.b1 = -(1.0 + cosW0) / a0;
+        break;
+    case Response::Notch:
+        result.b0 = result.b2 = 1.0 / a0;
+        result.b1 = -2.0 * cosW0 / a0;
+        break;
+    }
+    result.a1 = -2.0 * cosW0 / a0;
+    result.a2 = (1.0 - alpha) / a0;
+    return result;
+}
+
+/*!
+ * Clears the filter state, such that the next value is filtered as if it were the first.
+ */
+void SampleFilter::reset()
+{
+    Q_D(SampleFilter);
+    d->clear();
+}
+
+/*!
+ * \fn SampleFilter::samplesFiltered
+ *
+ * This signal is emitted when samples from service() have been scaled (according to the current metadata), and
+ * filtered into \a values.
+ */
+
+/*!
+ * \cond internal
+ * \class SampleFilterPrivate
+ *
+ * The SampleFilterPrivate class provides private implementation for SampleFilter.
+ */
+
+/*!
+ * Constructs a new SampleFilterPrivate object with public implementation \a q.
+ */
+SampleFilterPrivate::SampleFilterPrivate(SampleFilter * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Sets \a newService as the service to filter samples from, disconnecting from any previous service. \a newService
+ * must be a DsoService, a DataLoggerService, or \c nullptr.
+ */
+void SampleFilterPrivate::setService(AbstractPokitService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (auto * const dso = qobject_cast<DsoService *>(service); dso) {
+        connect(dso, &DsoService::metadataRead, this, &SampleFilterPrivate::dsoMetadataRead);
+        connect(dso, &DsoService::samplesRead, this, &SampleFilterPrivate::samplesRead);
+    } else if (auto * const logger = qobject_cast<DataLoggerService *>(service); logger) {
+        connect(logger, &DataLoggerService::metadataRead, this, &SampleFilterPrivate::loggerMetadataRead);
+        connect(logger, &DataLoggerService::samplesRead, this, &SampleFilterPrivate::samplesRead);
+    }
+}
+
+/*!
+ * Returns \c true if \a section has explicit coefficients, or a response that can be designed at \a sampleRate. That
+ * is, with a positive quality factor, and a frequency between 0Hz and the Nyquist frequency.
+ */
+bool SampleFilterPrivate::isDesignable(const SampleFilter::Biquad &section, const double sampleRate)
+{
+    return (section.response == SampleFilter::Response::Custom) || ((sampleRate > 0.0) && (section.q > 0.0) &&
+        (section.frequency > 0.0) && (section.frequency < sampleRate / 2.0));
+}
+
+/*!
+ * Designs #coefficients for each of the #sections, at the #sampleRate.
+ */
+void SampleFilterPrivate::design()
+{
+    coefficients.resize(sections.size());
+    for (qsizetype index = 0; index < sections.size(); ++index) {
+        coefficients[index] = SampleFilter::design(sections.at(index), sampleRate);
+        if ((sampleRate > 0.0) && (!isDesignable(sections.at(index), sampleRate))) {
+            qCWarning(lc).noquote() << tr("Filter section %1 (%2Hz) cannot be designed for a %3Hz sample rate; "
+                "passing samples through instead.").arg(index + 1).arg(sections.at(index).frequency).arg(sampleRate);
+        }
+    }
+}
+
+/*!
+ * Clears all filter state.
+ */
+void SampleFilterPrivate::clear()
+{
+    states.fill({ 0.0, 0.0 }, sections.size());
+    window.fill(0.0f, std::max<qsizetype>(taps.size() - 1, 0));
+}
+
+/*!
+ * Applies the FIR taps (if any) to \a count \a values, in place.
+ *
+ * The #window holds the previous (taps - 1) inputs, to which the block of \a values is appended, so that each output
+ * is a single dot product over contiguous inputs. Afterwards, the most recent (taps - 1) inputs are kept for the next
+ * block.
+ */
+void SampleFilterPrivate::processFir(float * const values, const qsizetype count)
+{
+    const qsizetype length = reversedTaps.size();
+    if (length == 0) {
+        return;
+    }
+    const qsizetype history = length - 1;
+    window.resize(history + count);
+    std::copy(values, values + count, window.begin() + history);
+
+    const float * const input = window.constData();
+    const float * const h = reversedTaps.constData();
+    for (qsizetype n = 0; n < count; ++n) {
+        float sum = 0.0f;
+        for (qsizetype k = 0; k < length; ++k) {
+            sum += h[k] * input[n + k];
+        }
+        values[n] = sum;
+    }
+    window.remove(0, count); // Leaves the most recent (taps - 1) inputs.
+}
+
+/*!
+ * Applies each biquad section (if any), in order, to \a count \a values, in place.
+ */
+void SampleFilterPrivate::processBiquads(float * const values, const qsizetype count)
+{
+    for (qsizetype index = 0; index < coefficients.size(); ++index) {
+        const SampleFilter::Biquad &c = coefficients.at(index);
+        double z1 = states.at(index)[0], z2 = states.at(index)[1];
+        for (qsizetype n = 0; n < count; ++n) {
+            const double x = values[n];
+            const double y = c.b0 * x + z1;
+            z1 = c.b1 * x - c.a1 * y + z2;
+            z2 = c.b2 * x - c.a2 * y;
+            values[n] = (float)y;
+        }
+        states[index] = { z1, z2 };
+    }
+}
+
+/*!
+ * Resets the filter for the new capture described by DSO \a metadata, at its sampling rate.
+ */
+void SampleFilterPrivate::dsoMetadataRead(const DsoService::Metadata &metadata)
+{
+    scale = metadata.scale;
+    Q_Q(SampleFilter);
+    q->setSampleRate(metadata.samplingRate);
+    clear();
+}
+
+/*!
+ * Resets the filter for the new logging session described by data logger \a metadata, at its update interval.
+ */
+void SampleFilterPrivate::loggerMetadataRead(const DataLoggerService::Metadata &metadata)
+{
+    scale = metadata.scale;
+    Q_Q(SampleFilter);
+    q->setSampleRate((metadata.updateInterval == 0) ? 0.0 : 1000.0 / metadata.updateInterval);
+    clear();
+}
+
+/*!
+ * Scales, and filters, raw \a samples, then emits them via SampleFilter::samplesFiltered.
+ */
+void SampleFilterPrivate::samplesRead(const QVector<qint16> &samples)
+{
+    filtered.resize(samples.size());
+    std::transform(samples.constBegin(), samples.constEnd(), filtered.begin(),
+                   [this](const qint16 sample) { return sample * scale; });
+    Q_Q(SampleFilter);
+    q->process(filtered);
+    Q_EMIT q->samplesFiltered(filtered);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
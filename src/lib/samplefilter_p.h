@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SampleFilterPrivate class.
+ */
+
+#ifndef QTPOKIT_SAMPLEFILTER_P_H
+#define QTPOKIT_SAMPLEFILTER_P_H
+
+#include <qtpokit/samplefilter.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+
+#include <array>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT SampleFilterPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.sample.filter", QtInfoMsg); ///< Logging category.
+
+    AbstractPokitService * service { nullptr }; ///< DSO, or data logger, service to filter samples from, if any.
+    float scale { 1.0f };                       ///< Scale of the current capture's (or session's) raw samples.
+
+    QVector<SampleFilter::Biquad> sections;     ///< Biquad sections, as set (ie possibly yet to be designed).
+    QVector<SampleFilter::Biquad> coefficients; ///< Biquad sections, as designed for the #sampleRate.
+    QVector<std::array<double, 2>> states;      ///< Each biquad section's (transposed direct form II) state.
+    QVector<float> taps;                        ///< FIR taps, as set.
+    QVector<float> reversedTaps;                ///< FIR taps, in reverse order, for contiguous dot products.
+    QVector<float> window;                      ///< The most recent FIR inputs, followed by the current block.
+    double sampleRate { 0.0 };                  ///< Sample rate, in Hz, to design biquad sections for.
+    QVector<float> filtered;                    ///< Scaled and filtered values, reused for each samplesFiltered.
+
+    explicit SampleFilterPrivate(SampleFilter * const q);
+
+    void setService(AbstractPokitService * const newService);
+
+    static bool isDesignable(const SampleFilter::Biquad &section, const double sampleRate);
+    void design();
+    void clear();
+    void processFir(float * const values, const qsizetype count);
+    void processBiquads(float * const values, const qsizetype count);
+
+public Q_SLOTS:
+    void dsoMetadataRead(const DsoService::Metadata &metadata);
+    void loggerMetadataRead(const DataLoggerService::Metadata &metadata);
+    void samplesRead(const QVector<qint16> &samples);
+
+protected:
+    SampleFilter * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(SampleFilter)
+    Q_DISABLE_COPY(SampleFilterPrivate)
+    QTPOKIT_BEFRIEND_TEST(SampleFilter)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SAMPLEFILTER_P_H
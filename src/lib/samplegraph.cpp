@@ -0,0 +1,706 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the SampleGraph and SampleGraphPrivate classes.
+ */
+
+#include <qtpokit/samplegraph.h>
+#include "samplegraph_p.h"
+#include "resampler_p.h"
+#include "../stringliterals_p.h"
+
+#include <QElapsedTimer>
+#include <QtMath>
+
+#include <algorithm>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class SampleGraph
+ *
+ * The SampleGraph class routes a single stream of values, such as DSO samples, or meter readings, through a directed
+ * acyclic graph of processing stages, to any number of sinks. This allows one stream to be filtered, aggregated,
+ * gated by event detection, and/or resampled, in several different ways at once, without running (or parsing the
+ * stream) more than once.
+ *
+ * Values flow through the graph in Block%s. When a stage passes a block on to more than one stage (that is, fans
+ * out), every one of those stages shares the same block, since its values are an implicitly shared QVector; and
+ * stages that pass values through unchanged (such as a Stage::Detect stage whose whole block is within an event)
+ * pass the very same block on. New blocks (such as the scaled samples given to addSamples(), or a filter's output)
+ * are acquired from a SamplePool, so once the graph has warmed up, blocks are neither copied, nor allocated, no matter
+ * how many stages they fan out to. Sinks emit blockReady() for each block they receive, and so are typically
+ * connected to whatever writes the values out.
+ *
+ * The graph begins with a single, implicit, Stage::Source stage, named sourceName(). Other stages are added via
+ * addFilter(), addAggregator(), addDetector(), addResampler(), addExpression() and addSink(), each naming the (already
+ * added) stages it receives blocks from, so stages are always added, and processed, in topological order, and the
+ * graph can never contain a cycle. A stage with more than one input receives every block from each, in order of
+ * arrival, except for Stage::Expression stages, which pair up the values of their inputs (see addExpression()).
+ *
+ * Each stage counts the blocks and values it receives and passes on, its queue depth (the values it holds, such as
+ * those of a still open aggregate window), and the time spent processing, from which statistics() derives its
+ * throughput. The graph is not thread-safe, and must only be used by one thread, typically that of the service
+ * whose values it processes.
+ */
+
+/// Returns \a stage as a (non-translated) string, suitable for machine-readable output.
+QString SampleGraph::toString(const Stage stage)
+{
+    switch (stage) {
+    case Stage::Source:     return u"source"_s;
+    case Stage::Filter:     return u"filter"_s;
+    case Stage::Aggregate:  return u"aggregate"_s;
+    case Stage::Detect:     return u"detect"_s;
+    case Stage::Resample:   return u"resample"_s;
+    case Stage::Sink:       return u"sink"_s;
+    case Stage::Expression: return u"expression"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Constructs a new SampleGraph object, with just its source stage, and \a parent.
+ */
+SampleGraph::SampleGraph(QObject * parent)
+    : QObject(parent), d_ptr(new SampleGraphPrivate(this))
+{
+
+}
+
+/*!
+ * \cond internal
+ * Constructs a new SampleGraph object with \a parent, and private implementation \a d.
+ */
+SampleGraph::SampleGraph(SampleGraphPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this SampleGraph object.
+ */
+SampleGraph::~SampleGraph()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the name of the graph's implicit source stage, which is `source`.
+ */
+QString SampleGraph::sourceName()
+{
+    return u"source"_s;
+}
+
+/*!
+ * Returns the names of all of the graph's stages, including the source, in the order they were added.
+ */
+QStringList SampleGraph::stageNames() const
+{
+    Q_D(const SampleGraph);
+    QStringList names;
+    for (const SampleGraphPrivate::Node &node: d->nodes) {
+        names.append(node.statistics.name);
+    }
+    return names;
+}
+
+/*!
+ * Adds a Stage::Filter stage called \a name, that receives blocks from \a inputs (or from the source, if \a inputs is
+ * empty), and filters them via a SampleFilter with FIR \a taps and biquad \a sections. Returns \c true if the stage
+ * was added, or \c false (having logged a warning) if \a name is already taken, or any of \a inputs is unknown.
+ *
+ * Biquad sections are designed for each block's sample rate, per its Block::interval.
+ */
+bool SampleGraph::addFilter(const QString &name, const QStringList &inputs,
+                            const QVector<SampleFilter::Biquad> &sections, const QVector<float> &taps)
+{
+    Q_D(SampleGraph);
+    const int index = d->addNode(name, Stage::Filter, inputs);
+    if (index < 0) {
+        return false;
+    }
+    SampleFilter * const filter = new SampleFilter(this);
+    filter->setFirTaps(taps);
+    filter->setBiquads(sections);
+    d->nodes[index].filter = filter;
+    return true;
+}
+
+/*!
+ * Adds a Stage::Aggregate stage called \a name, that receives blocks from \a inputs (or from the source, if \a inputs
+ * is empty), and passes on the mean of their values within each fixed window of \a period milliseconds (aligned to
+ * the epoch), timestamped at the start of each window. Returns \c true if the stage was added, or \c false (having
+ * logged a warning) if \a period is 0, \a name is already taken, or any of \a inputs is unknown.
+ *
+ * Each window's mean is passed on once a value beyond the window is received, or the graph is flushed.
+ */
+bool SampleGraph::addAggregator(const QString &name, const QStringList &inputs, const quint32 period)
+{
+    Q_D(SampleGraph);
+    if (period == 0) {
+        qCWarning(d->lc).noquote() << tr("Invalid aggregation period for stage %1: %2").arg(name).arg(period);
+        return false;
+    }
+    const int index = d->addNode(name, Stage::Aggregate, inputs);
+    if (index < 0) {
+        return false;
+    }
+    d->nodes[index].period = period;
+    return true;
+}
+
+/*!
+ * Adds a Stage::Detect stage called \a name, that receives blocks from \a inputs (or from the source, if \a inputs is
+ * empty), detects events within them via an EventDetector with \a settings, and passes on only the values within
+ * events. Each detected event is emitted via eventFinished(), once it ends. Returns \c true if the stage was added,
+ * or \c false (having logged a warning) if \a settings are invalid, \a name is already taken, or any of \a inputs is
+ * unknown.
+ *
+ * Values are passed on as soon as they are within an event, so events shorter than the \a settings' minimum
+ * duration still have their values passed on, even though they are not emitted via eventFinished().
+ */
+bool SampleGraph::addDetector(const QString &name, const QStringList &inputs, const EventDetector::Settings &settings)
+{
+    Q_D(SampleGraph);
+    if (!EventDetector::isValid(settings)) {
+        qCWarning(d->lc).noquote() << tr("Invalid event detector settings for stage %1").arg(name);
+        return false;
+    }
+    const int index = d->addNode(name, Stage::Detect, inputs);
+    if (index < 0) {
+        return false;
+    }
+    EventDetector * const detector = new EventDetector(this);
+    detector->setSettings(settings);
+    connect(detector, &EventDetector::eventFinished, this, [this, name](const EventDetector::Event &event) {
+        Q_EMIT eventFinished(name, event);
+    });
+    d->nodes[index].detector = detector;
+    return true;
+}
+
+/*!
+ * Adds a Stage::Resample stage called \a name, that receives blocks from \a inputs (or from the source, if \a inputs
+ * is empty), and resamples their values onto a regular grid of \a period milliseconds, via a Resampler using
+ * \a method. Returns \c true if the stage was added, or \c false (having logged a warning) if \a period is 0, \a name
+ * is already taken, or any of \a inputs is unknown.
+ *
+ * Since the Resampler works in whole milliseconds, this is intended for streams of (at most) a few thousand values
+ * per second, such as meter readings, logger samples, or the output of a Stage::Aggregate stage.
+ */
+bool SampleGraph::addResampler(const QString &name, const QStringList &inputs, const quint32 period,
+                               const Resampler::Method method)
+{
+    Q_D(SampleGraph);
+    if (period == 0) {
+        qCWarning(d->lc).noquote() << tr("Invalid resampling period for stage %1: %2").arg(name).arg(period);
+        return false;
+    }
+    const int index = d->addNode(name, Stage::Resample, inputs);
+    if (index < 0) {
+        return false;
+    }
+    Resampler * const resampler = new Resampler(1, this);
+    resampler->setMethod(method);
+    resampler->setPeriod(period);
+    connect(resampler, &Resampler::rowReady, this, [d, index](const qint64 timestamp, const QVector<float> &values) {
+        SampleGraphPrivate::Node &node = d->nodes[index];
+        SampleGraphPrivate::appendRow(node.rows, timestamp, node.period, values.at(0));
+    });
+    d->nodes[index].period = period;
+    d->nodes[index].resampler = resampler;
+    return true;
+}
+
+/*!
+ * Adds a Stage::Expression stage called \a name, that receives blocks from \a inputs (or from the source, if \a inputs
+ * is empty), and passes on the result of \a formula (see SampleExpression), in which each of \a inputs (or `source`) is
+ * a variable, for each of their values. Returns \c true if the stage was added, or \c false (having logged a warning)
+ * if \a formula fails to compile, any of \a inputs is repeated, \a name is already taken, or any of \a inputs is
+ * unknown.
+ *
+ * With more than one input, each input's values are paired up with those of the other inputs, in order of arrival, so
+ * the inputs should share a single timeline (such as filters of the source, or aggregators of the same period), and
+ * timestamps follow the first input. Values are held on to until every input has provided its counterpart, and any
+ * still unpaired when the graph is flushed are discarded.
+ *
+ * The \a formula is compiled just once, and then evaluated over whole blocks at a time, so even complex formulas
+ * cost only a few nanoseconds per value.
+ */
+bool SampleGraph::addExpression(const QString &name, const QStringList &inputs, const QString &formula)
+{
+    Q_D(SampleGraph);
+    const QStringList variables = (inputs.isEmpty()) ? QStringList{ sourceName() } : inputs;
+    if (QStringList(variables).removeDuplicates() > 0) {
+        qCWarning(d->lc).noquote() << tr("Repeated input for stage %1: %2").arg(name, inputs.join(u','));
+        return false;
+    }
+    const SampleExpression expression(formula, variables);
+    if (!expression.isValid()) {
+        qCWarning(d->lc).noquote() << tr("Invalid formula for stage %1: %2").arg(name, expression.errorString());
+        return false;
+    }
+    const int index = d->addNode(name, Stage::Expression, inputs);
+    if (index < 0) {
+        return false;
+    }
+    SampleGraphPrivate::Node &node = d->nodes[index];
+    node.expression = expression;
+    for (const QString &input: variables) {
+        node.inputs.append(d->indexOf(input));
+    }
+    node.pending.resize(variables.size());
+    return true;
+}
+
+/*!
+ * Adds a Stage::Sink stage called \a name, that receives blocks from \a inputs (or from the source, if \a inputs is
+ * empty), and emits blockReady() for each. Returns \c true if the stage was added, or \c false (having logged a
+ * warning) if \a name is already taken, or any of \a inputs is unknown.
+ */
+bool SampleGraph::addSink(const QString &name, const QStringList &inputs)
+{
+    Q_D(SampleGraph);
+    return d->addNode(name, Stage::Sink, inputs) >= 0;
+}
+
+/*!
+ * Returns the statistics of all of the graph's stages, including the source, in the order they were added.
+ */
+QVector<SampleGraph::StageStatistics> SampleGraph::statistics() const
+{
+    Q_D(const SampleGraph);
+    QVector<StageStatistics> statistics;
+    statistics.reserve(d->nodes.size());
+    for (const SampleGraphPrivate::Node &node: d->nodes) {
+        statistics.append(node.statistics);
+        if (node.statistics.busyTime > 0) {
+            statistics.last().throughput = (double)node.statistics.valuesIn * 1e9 / (double)node.statistics.busyTime;
+        }
+    }
+    return statistics;
+}
+
+/*!
+ * Adds \a block to the graph's source, and so processes it through every stage. Empty blocks are ignored.
+ */
+void SampleGraph::addBlock(const SampleGraph::Block &block)
+{
+    Q_D(SampleGraph);
+    if (!block.values.isEmpty()) {
+        d->push(0, block);
+    }
+}
+
+/*!
+ * Adds \a samples (such as from a DsoService, or DataLoggerService) to the graph's source, as a single block of
+ * values, each \a scale times its sample, with the first taken at \a timestamp (in milliseconds since the epoch),
+ * and the rest every \a interval milliseconds.
+ *
+ * The block's values are written to a buffer from the graph's SamplePool, so are not allocated, once warmed up.
+ */
+void SampleGraph::addSamples(const DsoService::Samples &samples, const float scale, const qint64 timestamp,
+                             const double interval)
+{
+    Q_D(SampleGraph);
+    if (samples.isEmpty()) {
+        return;
+    }
+    QVector<float> &values = d->pool.acquire(samples.size());
+    std::transform(samples.constBegin(), samples.constEnd(), values.begin(),
+                   [scale](const qint16 sample) { return sample * scale; });
+    d->push(0, { timestamp, interval, values });
+}
+
+/*!
+ * Adds a single \a value (such as a meter reading), taken at \a timestamp (in milliseconds since the epoch), to the
+ * graph's source. The nominal \a interval, in milliseconds, between consecutive values, if known, is used by any
+ * Stage::Filter stages to design their biquad sections.
+ */
+void SampleGraph::addValue(const float value, const qint64 timestamp, const double interval)
+{
+    Q_D(SampleGraph);
+    QVector<float> &values = d->pool.acquire(1);
+    values[0] = value;
+    d->push(0, { timestamp, interval, values });
+}
+
+/*!
+ * Flushes every stage's queued values. That is, passes on any still open aggregate windows, and any resampled values
+ * still pending, and emits eventFinished() for any events still in progress. Typically invoked at the end of the
+ * stream, or before a discontinuity in it.
+ */
+void SampleGraph::flush()
+{
+    Q_D(SampleGraph);
+    // Stages are in topological order, so each stage is flushed only after all of its inputs have been.
+    for (int index = 0; index < d->nodes.size(); ++index) {
+        SampleGraphPrivate::Node &node = d->nodes[index];
+        QVector<Block> outputs;
+        switch (node.statistics.stage) {
+        case Stage::Aggregate:
+            if (node.statistics.queueDepth > 0) {
+                SampleGraphPrivate::appendRow(outputs, node.window * node.period, node.period,
+                                              (float)(node.sum / (double)node.statistics.queueDepth));
+            }
+            node.window = std::numeric_limits<qint64>::min();
+            node.sum = 0.0;
+            break;
+        case Stage::Detect:
+            node.detector->flush();
+            break;
+        case Stage::Resample:
+            node.resampler->flush();
+            outputs = std::exchange(d->nodes[index].rows, {});
+            break;
+        case Stage::Expression:
+            for (QVector<float> &pending: node.pending) {
+                pending.clear(); // Values with no counterparts in the other inputs, so nothing to pair them up with.
+            }
+            break;
+        default:
+            break;
+        }
+        d->nodes[index].statistics.queueDepth = 0;
+        d->pass(index, outputs);
+    }
+}
+
+/*!
+ * Discards every stage's queued values, and state (such as filter history), without passing anything on, such as
+ * ahead of an unrelated stream. Statistics are retained.
+ */
+void SampleGraph::reset()
+{
+    Q_D(SampleGraph);
+    for (SampleGraphPrivate::Node &node: d->nodes) {
+        if (node.filter) node.filter->reset();
+        if (node.detector) node.detector->reset();
+        if (node.resampler) node.resampler->reset();
+        node.window = std::numeric_limits<qint64>::min();
+        node.sum = 0.0;
+        node.rows.clear();
+        for (QVector<float> &pending: node.pending) {
+            pending.clear();
+        }
+        node.statistics.queueDepth = 0;
+    }
+}
+
+/*!
+ * \fn void SampleGraph::blockReady(const QString &sink, const SampleGraph::Block &block)
+ *
+ * This signal is emitted when \a sink receives \a block. The \a block's values are shared with the graph (and any
+ * other sinks), so receivers should copy any values they need to keep, rather than hold on to the block itself, so
+ * that its buffer may be reused.
+ */
+
+/*!
+ * \fn void SampleGraph::eventFinished(const QString &detector, const EventDetector::Event &event)
+ *
+ * This signal is emitted when the Stage::Detect stage called \a detector has detected \a event, once it ends.
+ */
+
+/*!
+ * \cond internal
+ * \class SampleGraphPrivate
+ *
+ * The SampleGraphPrivate class provides private implementation for SampleGraph.
+ */
+
+/*!
+ * \internal
+ * Constructs a new SampleGraphPrivate object, with just the source stage, and public implementation \a q.
+ */
+SampleGraphPrivate::SampleGraphPrivate(SampleGraph * const q) : q_ptr(q)
+{
+    Node source;
+    source.statistics.name = SampleGraph::sourceName();
+    source.statistics.stage = SampleGraph::Stage::Source;
+    nodes.append(source);
+}
+
+/*!
+ * Returns the index of the stage called \a name, or -1 if there is none.
+ */
+int SampleGraphPrivate::indexOf(const QString &name) const
+{
+    for (int index = 0; index < nodes.size(); ++index) {
+        if (nodes.at(index).statistics.name == name) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+/*!
+ * Appends a \a stage called \a name, receiving blocks from \a inputs (or the source, if \a inputs is empty), and
+ * returns its index, or returns -1 (having logged a warning) if \a name is empty or already taken, or any of \a inputs
+ * is unknown, or a sink (which pass nothing on).
+ */
+int SampleGraphPrivate::addNode(const QString &name, const SampleGraph::Stage stage, const QStringList &inputs)
+{
+    if ((name.isEmpty()) || (indexOf(name) >= 0)) {
+        qCWarning(lc).noquote() << tr("Invalid, or duplicate, stage name: %1").arg(name);
+        return -1;
+    }
+    const QStringList names = (inputs.isEmpty()) ? QStringList{ SampleGraph::sourceName() } : inputs;
+    QVector<int> indexes;
+    for (const QString &input: names) {
+        const int index = indexOf(input);
+        if (index < 0) {
+            qCWarning(lc).noquote() << tr("Unknown input for stage %1: %2").arg(name, input);
+            return -1;
+        }
+        if (nodes.at(index).statistics.stage == SampleGraph::Stage::Sink) {
+            qCWarning(lc).noquote() << tr("Sink %1 cannot be an input, for stage %2").arg(input, name);
+            return -1;
+        }
+        if (!indexes.contains(index)) {
+            indexes.append(index);
+        }
+    }
+
+    Node node;
+    node.statistics.name = name;
+    node.statistics.stage = stage;
+    node.statistics.inputs = names;
+    nodes.append(node);
+    for (const int index: indexes) {
+        nodes[index].outputs.append((int)nodes.size() - 1);
+    }
+    return (int)nodes.size() - 1;
+}
+
+/*!
+ * Processes \a block, from the stage at index \a from (if any), through the stage at \a index, then passes the stage's
+ * output on to each of its outputs (so recursively, depth-first, through the rest of the graph).
+ */
+void SampleGraphPrivate::push(const int index, const SampleGraph::Block &block, const int from)
+{
+    Q_Q(SampleGraph);
+    QElapsedTimer timer;
+    timer.start();
+    Node &node = nodes[index];
+    ++node.statistics.blocksIn;
+    node.statistics.valuesIn += block.values.size();
+    QVector<SampleGraph::Block> outputs;
+    switch (node.statistics.stage) {
+    case SampleGraph::Stage::Source:
+        outputs.append(block);
+        break;
+    case SampleGraph::Stage::Filter:
+        filter(node, block, outputs);
+        break;
+    case SampleGraph::Stage::Aggregate:
+        aggregate(node, block, outputs);
+        break;
+    case SampleGraph::Stage::Detect:
+        detect(node, block, outputs);
+        break;
+    case SampleGraph::Stage::Resample:
+        resample(node, block, outputs);
+        break;
+    case SampleGraph::Stage::Expression:
+        evaluate(node, from, block, outputs);
+        break;
+    case SampleGraph::Stage::Sink:
+        ++node.statistics.blocksOut;
+        node.statistics.valuesOut += block.values.size();
+        Q_EMIT q->blockReady(node.statistics.name, block);
+        break;
+    }
+    nodes[index].statistics.busyTime += timer.nsecsElapsed(); // Excluding downstream stages.
+    pass(index, outputs);
+}
+
+/*!
+ * Passes \a outputs of the stage at \a index on to each of that stage's outputs.
+ */
+void SampleGraphPrivate::pass(const int index, const QVector<SampleGraph::Block> &outputs)
+{
+    for (const SampleGraph::Block &output: outputs) {
+        ++nodes[index].statistics.blocksOut;
+        nodes[index].statistics.valuesOut += output.values.size();
+        for (const int next: nodes.at(index).outputs) {
+            push(next, output, index); // Shared, not copied.
+        }
+    }
+}
+
+/*!
+ * Filters \a block's values, via \a node's filter, into a new (pooled) block, appended to \a outputs.
+ */
+void SampleGraphPrivate::filter(Node &node, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs)
+{
+    if (block.interval > 0.0) {
+        node.filter->setSampleRate(1000.0 / block.interval); // Keeps the filter's state, if unchanged.
+    }
+    QVector<float> &values = pool.acquire(block.values.size());
+    std::copy(block.values.constBegin(), block.values.constEnd(), values.begin());
+    node.filter->process(values); // In place, since the pool holds the only reference to the buffer.
+    outputs.append({ block.timestamp, block.interval, values });
+}
+
+/*!
+ * Adds \a block's values to \a node's aggregate windows, appending the mean of each window closed to \a outputs.
+ */
+void SampleGraphPrivate::aggregate(Node &node, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs)
+{
+    qint64 count = node.statistics.queueDepth;
+    for (qsizetype index = 0; index < block.values.size(); ++index) {
+        const qint64 window = ResamplerPrivate::floorDiv(timestampOf(block, index), node.period);
+        if (window != node.window) {
+            if (count > 0) {
+                appendRow(outputs, node.window * node.period, node.period, (float)(node.sum / (double)count));
+            }
+            node.window = window;
+            node.sum = 0.0;
+            count = 0;
+        }
+        node.sum += block.values.at(index);
+        ++count;
+    }
+    setQueueDepth(node, count);
+}
+
+/*!
+ * Adds \a block's values to \a node's event detector, appending each run of values within an event to \a outputs.
+ * If the whole of \a block is within an event, then \a block itself is appended, rather than a copy.
+ */
+void SampleGraphPrivate::detect(Node &node, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs)
+{
+    qsizetype first = -1; // Index of the current run's first value, if any.
+    for (qsizetype index = 0; index < block.values.size(); ++index) {
+        node.detector->addValue(block.values.at(index), timestampOf(block, index));
+        if (node.detector->isActive()) {
+            if (first < 0) {
+                first = index;
+            }
+        } else if (first >= 0) {
+            outputs.append(copyOf(block, first, index - first));
+            first = -1;
+        }
+    }
+    if (first == 0) {
+        outputs.append(block);
+    } else if (first > 0) {
+        outputs.append(copyOf(block, first, block.values.size() - first));
+    }
+}
+
+/*!
+ * Adds \a block's values to \a node's resampler, appending the resulting rows (if any) to \a outputs.
+ */
+void SampleGraphPrivate::resample(Node &node, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs)
+{
+    qint64 depth = node.statistics.queueDepth;
+    for (qsizetype index = 0; index < block.values.size(); ++index) {
+        const qsizetype rows = node.rows.size();
+        node.resampler->addSample(0, block.values.at(index), timestampOf(block, index));
+        depth = (node.rows.size() > rows) ? 0 : depth + 1;
+    }
+    setQueueDepth(node, depth);
+    outputs.append(std::exchange(node.rows, {}));
+}
+
+/*!
+ * Adds \a block, from the stage at index \a from, to \a node's expression inputs, appending a new (pooled) block of
+ * the expression's results, for as many values as every input has now provided, to \a outputs.
+ *
+ * With just one input, the expression is evaluated straight from \a block's values, without holding on to them.
+ */
+void SampleGraphPrivate::evaluate(Node &node, const int from, const SampleGraph::Block &block,
+                                  QVector<SampleGraph::Block> &outputs)
+{
+    if (node.inputs.size() == 1) {
+        QVector<float> &values = pool.acquire(block.values.size());
+        node.expression.evaluate({ block.values.constData() }, values.data(), values.size());
+        outputs.append({ block.timestamp, block.interval, values });
+        return;
+    }
+
+    const qsizetype input = node.inputs.indexOf(from);
+    Q_ASSERT(input >= 0);
+    if ((input == 0) && (node.pending.constFirst().isEmpty())) {
+        node.pendingTimestamp = block.timestamp;
+        node.pendingInterval = block.interval;
+    }
+    node.pending[input].append(block.values);
+
+    qsizetype count = std::numeric_limits<qsizetype>::max(), depth = 0;
+    for (const QVector<float> &pending: std::as_const(node.pending)) {
+        count = std::min(count, (qsizetype)pending.size());
+        depth = std::max(depth, (qsizetype)pending.size());
+    }
+    if (count > 0) {
+        QVector<const float *> inputs;
+        inputs.reserve(node.pending.size());
+        for (const QVector<float> &pending: std::as_const(node.pending)) {
+            inputs.append(pending.constData());
+        }
+        QVector<float> &values = pool.acquire(count);
+        node.expression.evaluate(inputs, values.data(), count);
+        outputs.append({ node.pendingTimestamp, node.pendingInterval, values });
+        node.pendingTimestamp = timestampOf(outputs.constLast(), count);
+        for (QVector<float> &pending: node.pending) {
+            pending.remove(0, count);
+        }
+        depth -= count;
+    }
+    setQueueDepth(node, depth);
+}
+
+/*!
+ * Returns a new block, acquired from the pool, of \a count of \a block's values, starting from index \a first.
+ */
+SampleGraph::Block SampleGraphPrivate::copyOf(const SampleGraph::Block &block, const qsizetype first,
+                                              const qsizetype count)
+{
+    QVector<float> &values = pool.acquire(count);
+    std::copy(block.values.constBegin() + first, block.values.constBegin() + first + count, values.begin());
+    return { timestampOf(block, first), block.interval, values };
+}
+
+/*!
+ * Appends \a value, at \a timestamp, to the last of \a blocks, if it continues that block's grid of \a period
+ * milliseconds, otherwise appends a new block.
+ */
+void SampleGraphPrivate::appendRow(QVector<SampleGraph::Block> &blocks, const qint64 timestamp, const quint32 period,
+                                   const float value)
+{
+    if ((!blocks.isEmpty()) && (blocks.last().interval == period) &&
+        (blocks.last().timestamp + blocks.last().values.size() * (qint64)period == timestamp)) {
+        blocks.last().values.append(value);
+        return;
+    }
+    blocks.append({ timestamp, (double)period, { value } });
+}
+
+/*!
+ * Returns the timestamp of \a block's value at \a index, in milliseconds since the epoch.
+ */
+qint64 SampleGraphPrivate::timestampOf(const SampleGraph::Block &block, const qsizetype index)
+{
+    return block.timestamp + qRound64((double)index * block.interval);
+}
+
+/*!
+ * Sets \a node's queue depth to \a depth, tracking its peak.
+ */
+void SampleGraphPrivate::setQueueDepth(Node &node, const qint64 depth)
+{
+    node.statistics.queueDepth = depth;
+    node.statistics.peakQueueDepth = std::max(node.statistics.peakQueueDepth, depth);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SampleGraphPrivate class.
+ */
+
+#ifndef QTPOKIT_SAMPLEGRAPH_P_H
+#define QTPOKIT_SAMPLEGRAPH_P_H
+
+#include <qtpokit/samplegraph.h>
+#include <qtpokit/samplepool.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT SampleGraphPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.sample.graph", QtInfoMsg); ///< Logging category.
+
+    /// A single stage, and its state.
+    struct Node {
+        SampleGraph::StageStatistics statistics; ///< Stage's name, kind, inputs and statistics.
+        QVector<int> outputs;                    ///< Indexes of the stages this stage passes its blocks on to.
+        SampleFilter * filter { nullptr };       ///< Filter, if a SampleGraph::Stage::Filter stage.
+        EventDetector * detector { nullptr };    ///< Event detector, if a SampleGraph::Stage::Detect stage.
+        Resampler * resampler { nullptr };       ///< Resampler, if a SampleGraph::Stage::Resample stage.
+        quint32 period { 0 };                    ///< Window, or grid, period in milliseconds, if any.
+        qint64 window { std::numeric_limits<qint64>::min() }; ///< Index of the open aggregate window, if any.
+        double sum { 0.0 };                      ///< Sum of the open aggregate window's values.
+        QVector<SampleGraph::Block> rows;        ///< Resampled rows, gathered from the #resampler.
+        SampleExpression expression;             ///< Compiled formula, if a SampleGraph::Stage::Expression stage.
+        QVector<int> inputs;                     ///< Indexes of the stages providing the #expression's variables.
+        QVector<QVector<float>> pending;         ///< Values received from each of #inputs, not yet evaluated.
+        qint64 pendingTimestamp { 0 };           ///< Timestamp of the first input's first #pending value.
+        double pendingInterval { 0.0 };          ///< Interval between the first input's #pending values.
+    };
+
+    QVector<Node> nodes; ///< The graph's stages, in order of addition (and so, topologically sorted).
+    SamplePool<float> pool { SamplePool<float>::defaultCapacity, QStringLiteral("graph.samples") }; ///< Buffers.
+
+    explicit SampleGraphPrivate(SampleGraph * const q);
+
+    int indexOf(const QString &name) const;
+    int addNode(const QString &name, const SampleGraph::Stage stage, const QStringList &inputs);
+    void push(const int index, const SampleGraph::Block &block, const int from = -1);
+    void pass(const int index, const QVector<SampleGraph::Block> &outputs);
+    void filter(Node &node, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs);
+    void aggregate(Node &node, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs);
+    void detect(Node &node, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs);
+    void resample(Node &node, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs);
+    void evaluate(Node &node, const int from, const SampleGraph::Block &block, QVector<SampleGraph::Block> &outputs);
+    SampleGraph::Block copyOf(const SampleGraph::Block &block, const qsizetype first, const qsizetype count);
+    static void appendRow(QVector<SampleGraph::Block> &blocks, const qint64 timestamp, const quint32 period,
+                          const float value);
+    static qint64 timestampOf(const SampleGraph::Block &block, const qsizetype index);
+    static void setQueueDepth(Node &node, const qint64 depth);
+
+protected:
+    SampleGraph * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(SampleGraph)
+    Q_DISABLE_COPY(SampleGraphPrivate)
+    QTPOKIT_BEFRIEND_TEST(SampleGraph)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SAMPLEGRAPH_P_H
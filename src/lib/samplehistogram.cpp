@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the SampleHistogram class.
+ */
+
+#include <qtpokit/samplehistogram.h>
+
+#include <QtMath>
+
+#include <cmath>
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class SampleHistogram
+ *
+ * The SampleHistogram class records a distribution of sample values, such as data logger, or DSO, samples, in a fixed
+ * number of equal-width bins. The bins' width defaults to the resolution of the samples' range (see forScale()), so
+ * the distribution of a range's samples is recorded exactly, unless that would take more than maxBinCount bins, in
+ * which case the bins are widened, by powers of two, to fit. Either way, recording is just a bin lookup and
+ * increment, and memory is constant, no matter how many values are recorded.
+ *
+ * Values beyond the histogram's bounds are counted in the first, or last, bin. Percentiles are reported as the
+ * highest value of the bin the percentile falls in (but never more than the maximum value recorded), so are never
+ * understated. Histograms with the same bins may be merged, such as to combine hourly histograms into a daily one.
+ *
+ * The bin counts are only allocated once the first value is added, so histograms that are never added to are cheap
+ * to construct, and copy. SampleHistogram is not thread-safe.
+ */
+
+/*!
+ * Constructs a new, empty, SampleHistogram object, with bins from \a lowerBound to \a upperBound, each \a resolution
+ * wide, or wider, if the range would otherwise need more than maxBinCount bins. If \a upperBound is not greater than
+ * \a lowerBound, then the histogram has a single bin. If \a resolution is not positive, then the range is divided
+ * into maxBinCount bins.
+ */
+SampleHistogram::SampleHistogram(const float lowerBound, const float upperBound, const float resolution)
+    : lower(qIsFinite(lowerBound) ? lowerBound : 0.0f)
+{
+    const double span = ((qIsFinite(upperBound)) && (upperBound > lower)) ? (double)upperBound - lower : 0.0;
+    double binWidth = ((qIsFinite(resolution)) && (resolution > 0.0f)) ? (double)resolution
+        : (span > 0.0) ? span / maxBinCount : 1.0;
+    while (std::ceil(span / binWidth) > maxBinCount) {
+        binWidth *= 2.0;
+    }
+    width = (float)binWidth;
+    bins = qMax((int)std::ceil(span / binWidth), 1);
+}
+
+/*!
+ * Returns a histogram suitable for (unfiltered) data logger, or DSO, samples of \a scale. That is, spanning every
+ * possible raw 16-bit sample, with bins as fine as each range's resolution (\a scale) allows.
+ */
+SampleHistogram SampleHistogram::forScale(const float scale)
+{
+    const float lowerBound = std::numeric_limits<qint16>::min() * scale;
+    const float upperBound = std::numeric_limits<qint16>::max() * scale;
+    return SampleHistogram(qMin(lowerBound, upperBound), qMax(lowerBound, upperBound), qAbs(scale));
+}
+
+/*!
+ * Adds \a value to the histogram. NaN values are ignored.
+ */
+void SampleHistogram::add(const float value)
+{
+    if (qIsNaN(value)) {
+        return;
+    }
+    if (counts.isEmpty()) {
+        counts.fill(0, bins);
+    }
+    if (total == 0) {
+        min = max = value;
+    } else {
+        min = qMin(min, value);
+        max = qMax(max, value);
+    }
+    ++counts[binIndex(value)];
+    ++total;
+    sum += (double)value;
+}
+
+/*!
+ * Adds all of the values added to \a other to this histogram, and returns \c true, if both histograms have the same
+ * bins. Otherwise, returns \c false, leaving this histogram unchanged.
+ */
+bool SampleHistogram::merge(const SampleHistogram &other)
+{
+    if ((other.lower != lower) || (other.width != width) || (other.bins != bins)) {
+        return false;
+    }
+    if (other.isEmpty()) {
+        return true;
+    }
+    if (isEmpty()) {
+        counts = other.counts;
+        min = other.min;
+        max = other.max;
+    } else {
+        for (int index = 0; index < bins; ++index) {
+            counts[index] += other.counts.at(index);
+        }
+        min = qMin(min, other.min);
+        max = qMax(max, other.max);
+    }
+    total += other.total;
+    sum += other.sum;
+    return true;
+}
+
+/*!
+ * Discards all added values, but retains the bin counts' allocation (if any), for re-use.
+ */
+void SampleHistogram::reset()
+{
+    if (!counts.isEmpty()) {
+        counts.fill(0);
+    }
+    total = 0;
+    min = max = 0.0f;
+    sum = 0.0;
+}
+
+/*!
+ * Returns the lower bound of the histogram's first bin.
+ */
+float SampleHistogram::lowerBound() const
+{
+    return lower;
+}
+
+/*!
+ * Returns the width of each of the histogram's bins.
+ */
+float SampleHistogram::binWidth() const
+{
+    return width;
+}
+
+/*!
+ * Returns the number of bins in the histogram.
+ */
+int SampleHistogram::binCount() const
+{
+    return bins;
+}
+
+/*!
+ * Returns the index of the bin that \a value is counted in. NaN values are (nominally) in the first bin.
+ */
+int SampleHistogram::binIndex(const float value) const
+{
+    const double index = std::floor(((double)value - lower) / width);
+    return (!(index > 0.0)) ? 0 : (index >= bins - 1) ? bins - 1 : (int)index;
+}
+
+/*!
+ * Returns the highest value of the bin at \a index (that is, the upper bound of that bin).
+ */
+float SampleHistogram::binValue(const int index) const
+{
+    return (float)(lower + (double)(index + 1) * width);
+}
+
+/*!
+ * Returns the number of values counted in the bin at \a index.
+ */
+quint64 SampleHistogram::binTotal(const int index) const
+{
+    return ((counts.isEmpty()) || (index < 0) || (index >= bins)) ? 0 : counts.at(index);
+}
+
+/*!
+ * Returns \c true if no values have been added (since the last reset()), otherwise \c false.
+ */
+bool SampleHistogram::isEmpty() const
+{
+    return total == 0;
+}
+
+/*!
+ * Returns the number of values added.
+ */
+quint64 SampleHistogram::count() const
+{
+    return total;
+}
+
+/*!
+ * Returns the smallest value added (exactly, not to the bin's precision), or 0 if none have been added.
+ */
+float SampleHistogram::minimum() const
+{
+    return min;
+}
+
+/*!
+ * Returns the largest value added (exactly, not to the bin's precision), or 0 if none have been added.
+ */
+float SampleHistogram::maximum() const
+{
+    return max;
+}
+
+/*!
+ * Returns the mean of the values added (exactly, not to the bins' precision), or NaN if none have been added.
+ */
+double SampleHistogram::mean() const
+{
+    return (total == 0) ? std::nan("") : sum / (double)total;
+}
+
+/*!
+ * Returns the value that \a percent percent of added values are less than, or equal to, such as `percentile(99.0)`
+ * for the 99th percentile. Returns NaN if no values have been added.
+ *
+ * The 0th and 100th percentiles are the minimum() and maximum() values. Otherwise, the result is the highest value of
+ * the percentile's bin (see binValue()), but no more than maximum(). Since the last bin also counts any values beyond
+ * the histogram's upper bound, percentiles falling in the last bin are reported as maximum().
+ */
+float SampleHistogram::percentile(const double percent) const
+{
+    if (total == 0) {
+        return qQNaN();
+    }
+    if (percent <= 0.0) {
+        return min;
+    }
+    const quint64 rank = qBound<quint64>(1, (quint64)std::ceil(percent / 100.0 * (double)total), total);
+    quint64 cumulative = 0;
+    for (int index = binIndex(min); index < bins - 1; ++index) {
+        if ((cumulative += counts.at(index)) >= rank) {
+            return qMin(binValue(index), max);
+        }
+    }
+    return max;
+}
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the SaturationDetector class.
+ */
+
+#include <qtpokit/saturationdetector.h>
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class SaturationDetector
+ *
+ * The SaturationDetector class finds runs of saturated (that is, over-range, or clipped) raw samples, such as DSO, or
+ * data logger, samples at the limits of their range. Such samples are otherwise indistinguishable from real values, so
+ * a capture, or logging session, with a poor range choice is usually only found after the fact.
+ *
+ * Samples are saturated when their magnitude is at, or beyond, the threshold() (see the static threshold() overloads
+ * for deriving that from the products' range tables, and each capture's, or session's, scale). Each chunk of samples
+ * is first scanned in a single, branch-free, pass for its peak magnitude, and saturated count, which compilers
+ * vectorise. Only chunks with saturated samples (or that end a run begun by a previous chunk) are scanned again for
+ * the runs' boundaries. So the typical, unsaturated, chunk costs little more than reading it once.
+ *
+ * Runs may span chunks, in which case they are reported by the process() call that ends them (or by flush(), once
+ * there are no more samples). SaturationDetector is not thread-safe.
+ */
+
+/*!
+ * Constructs a new SaturationDetector object, treating raw samples with magnitudes of at least \a threshold as
+ * saturated.
+ */
+SaturationDetector::SaturationDetector(const qint16 threshold) : limit(std::max(threshold, (qint16)1))
+{
+
+}
+
+namespace {
+
+/*!
+ * Returns the raw sample magnitude nearest \a maxValue (in millivolts, or microamps, as per the range
+ * tables), for samples of \a scale volts, or amps, per raw unit, but never more than the raw samples' full scale. If
+ * \a maxValue or \a scale are unknown (zero), then the full scale is returned.
+ */
+qint16 thresholdOf(const quint32 maxValue, const double unitsPerValue, const float scale)
+{
+    const double magnitude = std::abs((double)scale) * unitsPerValue;
+    if ((maxValue == 0) || (!std::isfinite(magnitude)) || (magnitude <= 0.0)) {
+        return SaturationDetector::fullScaleSample;
+    }
+    return (qint16)std::clamp(std::round(maxValue / magnitude), 1.0, (double)SaturationDetector::fullScaleSample);
+}
+
+/*!
+ * Returns the range immediately above \a range, given the maximum values of \a range, and of the range above,
+ * or \a range if there is no higher range.
+ */
+quint8 nextRangeOf(const quint8 range, const quint32 maxValue, const quint32 nextMaxValue)
+{
+    return ((maxValue > 0) && (range < 254) && (nextMaxValue > maxValue)) ? (quint8)(range + 1) : range;
+}
+
+}
+
+/*!
+ * Returns the raw sample magnitude at which DSO samples of \a scale are saturated, in \a product's \a mode and
+ * \a range. That is, the magnitude of \a range's maximum value (from \a product's range tables), or the full scale,
+ * if less.
+ */
+qint16 SaturationDetector::threshold(const PokitProduct product, const DsoService::Mode mode, const quint8 range,
+                                     const float scale)
+{
+    switch (mode) {
+    case DsoService::Mode::Idle:
+        break;
+    case DsoService::Mode::DcVoltage:
+    case DsoService::Mode::AcVoltage:
+        return thresholdOf(DsoService::maxValue(product, range, mode), 1'000.0, scale);
+    case DsoService::Mode::DcCurrent:
+    case DsoService::Mode::AcCurrent:
+        return thresholdOf(DsoService::maxValue(product, range, mode), 1'000'000.0, scale);
+    }
+    return fullScaleSample;
+}
+
+/*!
+ * Returns the raw sample magnitude at which data logger samples of \a scale are saturated, in \a product's \a mode
+ * and \a range. That is, the magnitude of \a range's maximum value (from \a product's range tables), or the full
+ * scale, if less, or if \a mode has no ranges (such as Temperature).
+ */
+qint16 SaturationDetector::threshold(const PokitProduct product, const DataLoggerService::Mode mode,
+                                     const quint8 range, const float scale)
+{
+    switch (mode) {
+    case DataLoggerService::Mode::Idle:
+    case DataLoggerService::Mode::Temperature:
+        break;
+    case DataLoggerService::Mode::DcVoltage:
+    case DataLoggerService::Mode::AcVoltage:
+        return thresholdOf(DataLoggerService::maxValue(product, range, mode), 1'000.0, scale);
+    case DataLoggerService::Mode::DcCurrent:
+    case DataLoggerService::Mode::AcCurrent:
+        return thresholdOf(DataLoggerService::maxValue(product, range, mode), 1'000'000.0, scale);
+    }
+    return fullScaleSample;
+}
+
+/*!
+ * Returns the DSO range immediately above \a range, in \a product's \a mode, or \a range if there is none (such as
+ * when \a range is already the highest range, or is AutoRange).
+ *
+ * Since range tables list each product's ranges consecutively, in order of increasing maximum value (see
+ * RangeTable::isValid), the next range up is always the next enumerator value.
+ */
+quint8 SaturationDetector::nextRange(const PokitProduct product, const DsoService::Mode mode, const quint8 range)
+{
+    return nextRangeOf(range, DsoService::maxValue(product, range, mode),
+                       DsoService::maxValue(product, (quint8)(range + 1), mode));
+}
+
+/*!
+ * Returns the data logger range immediately above \a range, in \a product's \a mode, or \a range if there is none
+ * (such as when \a range is already the highest range, is AutoRange, or \a mode has no ranges).
+ */
+quint8 SaturationDetector::nextRange(const PokitProduct product, const DataLoggerService::Mode mode,
+                                     const quint8 range)
+{
+    return nextRangeOf(range, DataLoggerService::maxValue(product, range, mode),
+                       DataLoggerService::maxValue(product, (quint8)(range + 1), mode));
+}
+
+/*!
+ * Returns the magnitude at, or beyond, which raw samples are saturated.
+ */
+qint16 SaturationDetector::threshold() const
+{
+    return limit;
+}
+
+/*!
+ * Sets the magnitude at, or beyond, which raw samples are saturated to \a threshold (but no less than 1). This
+ * applies to subsequent process() calls; runs already in progress carry on.
+ */
+void SaturationDetector::setThreshold(const qint16 threshold)
+{
+    limit = std::max(threshold, (qint16)1);
+}
+
+/*!
+ * Scans the next \a size raw samples, as returned by \a sample for each index, for process() and processRaw().
+ */
+template<typename Sample>
+QVector<SaturationDetector::Segment> SaturationDetector::scan(const qsizetype size, const Sample &sample)
+{
+    const int threshold = limit;
+
+    // A single, branch-free, pass for the chunk's peak and saturated count, which compilers readily vectorise.
+    int peak = 0, hits = 0;
+    for (qsizetype index = 0; index < size; ++index) {
+        const int magnitude = std::abs((int)sample(index));
+        peak = std::max(peak, magnitude);
+        hits += (magnitude >= threshold) ? 1 : 0;
+    }
+    maximum = std::max(maximum, peak);
+    saturated += hits;
+
+    QVector<Segment> segments;
+    if (hits == 0) {
+        if ((runStart >= 0) && (size > 0)) {
+            segments.append({ runStart, processed - runStart }); // The previous chunk's run ended with that chunk.
+            runStart = -1;
+        }
+        processed += size;
+        return segments;
+    }
+
+    // Only now find the runs' boundaries.
+    for (qsizetype index = 0; index < size; ++index) {
+        const bool clipped = (std::abs((int)sample(index)) >= threshold);
+        if ((clipped) && (runStart < 0)) {
+            runStart = processed + index;
+        } else if ((!clipped) && (runStart >= 0)) {
+            segments.append({ runStart, processed + index - runStart });
+            runStart = -1;
+        }
+    }
+    processed += size;
+    return segments;
+}
+
+/*!
+ * Scans the next chunk of raw \a samples, returning any runs of saturated samples that ended within \a samples. A
+ * run still in progress at the end of \a samples is returned by a later process() call, or flush().
+ */
+QVector<SaturationDetector::Segment> SaturationDetector::process(const QVector<qint16> &samples)
+{
+    const qint16 * const data = samples.constData();
+    return scan(samples.size(), [data](const qsizetype index) { return data[index]; });
+}
+
+/*!
+ * Scans the next chunk of raw \a samples, as per process(), but as little-endian 16-bit integers (as read from the
+ * DSO, and data logger, services' Reading characteristics), without decoding them first. Any trailing odd byte is
+ * ignored.
+ */
+QVector<SaturationDetector::Segment> SaturationDetector::processRaw(const QByteArray &samples)
+{
+    const char * const data = samples.constData();
+    return scan(samples.size() / 2, [data](const qsizetype index) {
+        return qFromLittleEndian<qint16>(data + (index * 2));
+    });
+}
+
+/*!
+ * Ends the run of saturated samples in progress (if any), returning it. Typically invoked once all of a capture's, or
+ * session's, samples have been processed.
+ */
+std::optional<SaturationDetector::Segment> SaturationDetector::flush()
+{
+    if (runStart < 0) {
+        return std::nullopt;
+    }
+    const Segment segment{ runStart, processed - runStart };
+    runStart = -1;
+    return segment;
+}
+
+/*!
+ * Resets the detector, such as for a new capture, dropping any run in progress. The threshold() is unchanged.
+ */
+void SaturationDetector::reset()
+{
+    processed = saturated = 0;
+    maximum = 0;
+    runStart = -1;
+}
+
+/*!
+ * Returns the number of samples processed since the last reset().
+ */
+qint64 SaturationDetector::sampleCount() const
+{
+    return processed;
+}
+
+/*!
+ * Returns the number of saturated samples processed since the last reset().
+ */
+qint64 SaturationDetector::saturatedCount() const
+{
+    return saturated;
+}
+
+/*!
+ * Returns \c true if any saturated samples have been processed since the last reset().
+ */
+bool SaturationDetector::isSaturated() const
+{
+    return (saturated > 0);
+}
+
+/*!
+ * Returns the largest raw sample magnitude processed since the last reset(), or 0 if none.
+ */
+int SaturationDetector::peak() const
+{
+    return maximum;
+}
+
+QTPOKIT_END_NAMESPACE
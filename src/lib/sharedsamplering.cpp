@@ -0,0 +1,456 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the SharedSampleRing and SharedSampleRingPrivate classes.
+ */
+
+#include <qtpokit/sharedsamplering.h>
+#include "sharedsamplering_p.h"
+
+#include <cstring>
+#include <limits>
+#include <new>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class SharedSampleRing
+ *
+ * The SharedSampleRing class publishes parsed samples and readings into a named shared-memory ring buffer, for any
+ * number of other local processes to read, at their own pace, without the publisher ever waiting for them.
+ *
+ * Even a local socket costs a copy into, and out of, the kernel, and (often) a context switch, per message, which adds
+ * up at DSO sample rates. Instead, a publisher create()s a ring of fixed-size Record slots, and publish()es values
+ * into it, while readers attach() to the same key, and read() whatever has been published since they last looked.
+ *
+ * The segment begins with a small header (magic number, layout version, slot size, capacity, and the number of records
+ * published so far), followed by capacity() slots, each being a 64-bit sequence lock, and a 32-byte Record. Record N
+ * is always written to slot N % capacity(). Since the publisher never waits for readers, a reader that falls more than
+ * capacity() records behind will find that some records have been overwritten; these are skipped, and counted via
+ * overrunCount(), while the Record::sequence numbers of the records that are read reveal exactly where the gaps are.
+ * Each slot's sequence lock also lets readers detect (and skip) records overwritten while being read, so neither side
+ * ever takes a lock.
+ *
+ * For example, a reader might poll a ring like:
+ *
+ * ```
+ * SharedSampleRing ring;
+ * if (ring.attach(u"dokit"_s)) {
+ *     QVector<SharedSampleRing::Record> records;
+ *     ring.read(records);
+ * }
+ * ```
+ */
+
+/*!
+ * Constructs a new SharedSampleRing object with \a parent. The ring is not usable until either create()d, or
+ * attach()ed.
+ */
+SharedSampleRing::SharedSampleRing(QObject * parent)
+    : QObject(parent), d_ptr(new SharedSampleRingPrivate(this))
+{
+
+}
+
+/*!
+ * \cond internal
+ * Constructs a new SharedSampleRing object with \a parent, and private implementation \a d.
+ */
+SharedSampleRing::SharedSampleRing(SharedSampleRingPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this SharedSampleRing object, detaching from the shared memory segment, if attached. The segment itself is
+ * destroyed once the last process detaches from it.
+ */
+SharedSampleRing::~SharedSampleRing()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the key this ring was most recently created, or attached, with.
+ */
+QString SharedSampleRing::key() const
+{
+    Q_D(const SharedSampleRing);
+    return d->key;
+}
+
+/*!
+ * Returns \c true if this ring is attached to a shared memory segment (either as publisher, or reader).
+ */
+bool SharedSampleRing::isAttached() const
+{
+    Q_D(const SharedSampleRing);
+    return d->memory.isAttached();
+}
+
+/*!
+ * Returns \c true if this ring created its shared memory segment, and so may publish() to it.
+ */
+bool SharedSampleRing::isPublisher() const
+{
+    Q_D(const SharedSampleRing);
+    return (d->publisher) && (d->memory.isAttached());
+}
+
+/*!
+ * Returns the number of records this ring can hold, or 0 if not attached.
+ */
+quint32 SharedSampleRing::capacity() const
+{
+    Q_D(const SharedSampleRing);
+    return (d->memory.isAttached()) ? d->header()->capacity : 0;
+}
+
+/*!
+ * Returns a human-readable description of the last error, if any.
+ */
+QString SharedSampleRing::errorString() const
+{
+    Q_D(const SharedSampleRing);
+    return d->errorString;
+}
+
+/*!
+ * Creates a new shared memory ring, identified by \a key, with room for \a capacity records, for this object to
+ * publish to. Returns \c true on success, or \c false (see errorString()) on failure, such as if another publisher is
+ * already using \a key.
+ *
+ * A segment left behind by a publisher that did not exit cleanly (only possible on some Unix platforms) is removed
+ * first, as long as no readers are still attached to it.
+ */
+bool SharedSampleRing::create(const QString &key, const quint32 capacity)
+{
+    Q_D(SharedSampleRing);
+    detach();
+    if (capacity == 0) {
+        d->errorString = tr("Capacity must be greater than zero");
+        return false;
+    }
+    d->setKey(key);
+    const qint64 size = (qint64)sizeof(SharedSampleRingPrivate::Header) +
+        (qint64)capacity * (qint64)sizeof(SharedSampleRingPrivate::Slot);
+    if (size > std::numeric_limits<int>::max()) {
+        d->errorString = tr("Capacity %L1 is too large").arg(capacity);
+        return false;
+    }
+    if ((!d->memory.create((int)size)) && (d->memory.error() == QSharedMemory::AlreadyExists)) {
+        // Attaching, then detaching, destroys a stale segment, if no other process is attached to it.
+        if (d->memory.attach(QSharedMemory::ReadOnly)) {
+            d->memory.detach();
+        }
+        d->memory.create((int)size);
+    }
+    if (!d->memory.isAttached()) {
+        d->errorString = d->memory.errorString();
+        qCWarning(d->lc).noquote() << tr("Failed to create shared memory ring %1: %2").arg(key, d->errorString);
+        return false;
+    }
+
+    // Initialise the header, and all slots, before publishing anything.
+    SharedSampleRingPrivate::Header * const header = new (d->memory.data()) SharedSampleRingPrivate::Header;
+    header->magic    = SharedSampleRingPrivate::magic;
+    header->version  = SharedSampleRingPrivate::version;
+    header->slotSize = (quint16)sizeof(SharedSampleRingPrivate::Slot);
+    header->capacity = capacity;
+    header->reserved = 0;
+    SharedSampleRingPrivate::Slot * const slots = reinterpret_cast<SharedSampleRingPrivate::Slot *>(header + 1);
+    for (quint32 index = 0; index < capacity; ++index) {
+        new (slots + index) SharedSampleRingPrivate::Slot;
+        slots[index].lock.store(0, std::memory_order_relaxed);
+    }
+    header->published.store(0, std::memory_order_release);
+    d->publisher = true;
+    d->errorString.clear();
+    qCDebug(d->lc).noquote() << tr("Created shared memory ring %1, with room for %L2 records.").arg(key).arg(capacity);
+    return true;
+}
+
+/*!
+ * Attaches to the existing shared memory ring identified by \a key, for this object to read() from. Returns \c true on
+ * success, or \c false (see errorString()) on failure, such as if no publisher has created a ring with \a key.
+ *
+ * Reading begins with the oldest record still in the ring.
+ */
+bool SharedSampleRing::attach(const QString &key)
+{
+    Q_D(SharedSampleRing);
+    detach();
+    d->setKey(key);
+    if (!d->memory.attach(QSharedMemory::ReadOnly)) {
+        d->errorString = d->memory.errorString();
+        qCDebug(d->lc).noquote() << tr("Failed to attach to shared memory ring %1: %2").arg(key, d->errorString);
+        return false;
+    }
+    if (!d->validate()) {
+        qCWarning(d->lc).noquote() << tr("Invalid shared memory ring %1: %2").arg(key, d->errorString);
+        d->memory.detach();
+        return false;
+    }
+    const quint64 published = d->header()->published.load(std::memory_order_acquire);
+    d->nextSequence = (published > d->header()->capacity) ? published - d->header()->capacity : 0;
+    d->overruns = 0;
+    d->errorString.clear();
+    return true;
+}
+
+/*!
+ * Detaches from the shared memory segment, if attached.
+ */
+void SharedSampleRing::detach()
+{
+    Q_D(SharedSampleRing);
+    if (d->memory.isAttached()) {
+        d->memory.detach();
+    }
+    d->publisher = false;
+    d->nextSequence = 0;
+    d->overruns = 0;
+}
+
+/*!
+ * Returns the number of records published to this ring so far (by any publisher), or 0 if not attached.
+ */
+quint64 SharedSampleRing::published() const
+{
+    Q_D(const SharedSampleRing);
+    return (d->memory.isAttached()) ? d->header()->published.load(std::memory_order_acquire) : 0;
+}
+
+/*!
+ * Publishes \a record, returning \c true on success, or \c false if this object is not a publisher.
+ *
+ * The \a record's own Record::sequence is ignored, and replaced with the next record number.
+ */
+bool SharedSampleRing::publish(const Record &record)
+{
+    Q_D(SharedSampleRing);
+    if (!isPublisher()) {
+        return false;
+    }
+    d->write(record);
+    return true;
+}
+
+/*!
+ * Publishes multimeter \a reading, taken at \a timestamp (in microseconds since the epoch), from \a source. Returns
+ * \c true on success, or \c false if this object is not a publisher.
+ */
+bool SharedSampleRing::publish(const MultimeterService::Reading &reading, const qint64 timestamp,
+                               const quint16 source)
+{
+    Record record;
+    record.timestamp = timestamp;
+    record.value = reading.value;
+    record.source = source;
+    record.kind = Kind::MeterReading;
+    record.mode = (quint8)reading.mode;
+    record.range = reading.range;
+    record.status = (quint8)reading.status;
+    return publish(record);
+}
+
+/*!
+ * Publishes each of the DSO \a samples (scaled according to \a metadata), with the first taken at \a timestamp, and
+ * the rest \a interval apart (both in microseconds), from \a source. Returns \c true on success, or \c false if this
+ * object is not a publisher.
+ */
+bool SharedSampleRing::publish(const DsoService::Metadata &metadata, const DsoService::Samples &samples,
+                               const qint64 timestamp, const qint64 interval, const quint16 source)
+{
+    Q_D(SharedSampleRing);
+    if (!isPublisher()) {
+        return false;
+    }
+    Record record;
+    record.source = source;
+    record.kind = Kind::DsoSample;
+    record.mode = (quint8)metadata.mode;
+    record.range = metadata.range;
+    record.status = (quint8)metadata.status;
+    for (qsizetype index = 0; index < samples.size(); ++index) {
+        record.timestamp = timestamp + index * interval;
+        record.value = samples.at(index) * metadata.scale;
+        d->write(record);
+    }
+    return true;
+}
+
+/*!
+ * Returns the number of the next record read() will return, if still available.
+ */
+quint64 SharedSampleRing::nextSequence() const
+{
+    Q_D(const SharedSampleRing);
+    return d->nextSequence;
+}
+
+/*!
+ * Returns the number of records that were overwritten before this reader could read them.
+ */
+quint64 SharedSampleRing::overrunCount() const
+{
+    Q_D(const SharedSampleRing);
+    return d->overruns;
+}
+
+/*!
+ * Returns the number of records published, but not yet read by this reader (including any that will turn out to have
+ * been overwritten).
+ */
+qsizetype SharedSampleRing::available() const
+{
+    Q_D(const SharedSampleRing);
+    const quint64 published = this->published();
+    return (published > d->nextSequence) ? (qsizetype)(published - d->nextSequence) : 0;
+}
+
+/*!
+ * Appends up to \a maxRecords (or all, if negative) of the records published since the last read() to \a records, and
+ * returns the number appended.
+ *
+ * Records overwritten before they could be read are skipped, and counted by overrunCount().
+ */
+qsizetype SharedSampleRing::read(QVector<Record> &records, const qsizetype maxRecords)
+{
+    Q_D(SharedSampleRing);
+    if (!d->memory.isAttached()) {
+        return 0;
+    }
+    const SharedSampleRingPrivate::Header * const header = d->header();
+    const quint64 capacity = header->capacity;
+    qsizetype count = 0;
+    while ((maxRecords < 0) || (count < maxRecords)) {
+        const quint64 published = header->published.load(std::memory_order_acquire);
+        if (d->nextSequence >= published) {
+            break; // Caught up.
+        }
+        if (published - d->nextSequence > capacity) {
+            const quint64 oldest = published - capacity;
+            d->overruns += oldest - d->nextSequence;
+            d->nextSequence = oldest;
+        }
+
+        // Copy the record out, then check that it was not (being) overwritten while doing so.
+        const SharedSampleRingPrivate::Slot * const slot = d->slot(d->nextSequence);
+        const quint64 expected = 2 * d->nextSequence + 2;
+        Record record;
+        if (slot->lock.load(std::memory_order_acquire) == expected) {
+            std::memcpy(&record, &slot->record, sizeof(Record));
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        if ((slot->lock.load(std::memory_order_relaxed) != expected) || (record.sequence != d->nextSequence)) {
+            ++d->overruns; // Overwritten by a newer record.
+            ++d->nextSequence;
+            continue;
+        }
+        records.append(record);
+        ++d->nextSequence;
+        ++count;
+    }
+    return count;
+}
+
+/*!
+ * \cond internal
+ * \class SharedSampleRingPrivate
+ *
+ * The SharedSampleRingPrivate class provides private implementation for SharedSampleRing.
+ */
+
+/*!
+ * \internal
+ * Constructs a new SharedSampleRingPrivate object with public implementation \a q.
+ */
+SharedSampleRingPrivate::SharedSampleRingPrivate(SharedSampleRing * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Sets the shared memory segment's \a key.
+ */
+void SharedSampleRingPrivate::setKey(const QString &key)
+{
+    this->key = key;
+    #if (QT_VERSION < QT_VERSION_CHECK(6, 6, 0)) // QNativeIpcKey added (and setKey(QString) deprecated) in Qt 6.6.
+    memory.setKey(key);
+    #else
+    memory.setNativeKey(QSharedMemory::legacyNativeKey(key));
+    #endif
+}
+
+/*!
+ * Returns the segment's header. The segment must be attached.
+ */
+SharedSampleRingPrivate::Header * SharedSampleRingPrivate::header() const
+{
+    Q_ASSERT(memory.isAttached());
+    return reinterpret_cast<Header *>(const_cast<void *>(memory.constData()));
+}
+
+/*!
+ * Returns the slot that record number \a sequence is (or was) written to. The segment must be attached.
+ */
+SharedSampleRingPrivate::Slot * SharedSampleRingPrivate::slot(const quint64 sequence) const
+{
+    Header * const header = this->header();
+    return reinterpret_cast<Slot *>(header + 1) + (sequence % header->capacity);
+}
+
+/*!
+ * Returns \c true if the attached segment looks like a ring published by this (or a compatible) version, otherwise
+ * sets #errorString and returns \c false.
+ */
+bool SharedSampleRingPrivate::validate()
+{
+    if (memory.size() < (int)sizeof(Header)) {
+        errorString = tr("Segment is too small (%L1 bytes)").arg(memory.size());
+        return false;
+    }
+    const Header * const header = this->header();
+    if (header->magic != magic) {
+        errorString = tr("Unrecognised magic number 0x%1").arg(header->magic, 8, 16, QLatin1Char('0'));
+        return false;
+    }
+    if ((header->version != version) || (header->slotSize != sizeof(Slot))) {
+        errorString = tr("Unsupported layout version %1, with %2-byte slots").arg(header->version)
+            .arg(header->slotSize);
+        return false;
+    }
+    if ((header->capacity == 0) ||
+        ((qint64)memory.size() < (qint64)sizeof(Header) + (qint64)header->capacity * (qint64)sizeof(Slot))) {
+        errorString = tr("Segment (%L1 bytes) is too small for %L2 records").arg(memory.size())
+            .arg(header->capacity);
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * Writes \a record to the next slot, and then publishes it.
+ */
+void SharedSampleRingPrivate::write(const SharedSampleRing::Record &record)
+{
+    Header * const header = this->header();
+    const quint64 sequence = header->published.load(std::memory_order_relaxed); // We're the only writer.
+    Slot * const slot = this->slot(sequence);
+    slot->lock.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot->record, &record, sizeof(SharedSampleRing::Record));
+    slot->record.sequence = sequence;
+    slot->lock.store(2 * sequence + 2, std::memory_order_release);
+    header->published.store(sequence + 1, std::memory_order_release);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
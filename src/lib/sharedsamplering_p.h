@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SharedSampleRingPrivate class.
+ */
+
+#ifndef QTPOKIT_SHAREDSAMPLERING_P_H
+#define QTPOKIT_SHAREDSAMPLERING_P_H
+
+#include <qtpokit/sharedsamplering.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+#include <QSharedMemory>
+
+#include <atomic>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT SharedSampleRingPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.shm.ring", QtInfoMsg); ///< Logging category.
+
+    static constexpr quint32 magic { 0x474E5250 }; ///< Header magic number ("PRNG", little-endian).
+    static constexpr quint16 version { 1 };        ///< Layout version.
+
+    /// Layout of the start of the shared memory segment, padded to a (typical) cache line.
+    struct alignas(64) Header {
+        quint32 magic;                       ///< Always #SharedSampleRingPrivate::magic.
+        quint16 version;                     ///< Always #SharedSampleRingPrivate::version.
+        quint16 slotSize;                    ///< Size of each Slot, in bytes.
+        quint32 capacity;                    ///< Number of slots following the header.
+        quint32 reserved;                    ///< Reserved for future use; always 0.
+        std::atomic<quint64> published;      ///< Number of records published so far.
+    };
+
+    /// Layout of each slot, following the header.
+    struct Slot {
+        std::atomic<quint64> lock;           ///< Sequence lock: 2n+1 while writing record n, then 2n+2.
+        SharedSampleRing::Record record;     ///< The most recent record written to this slot.
+    };
+
+    static_assert(sizeof(SharedSampleRing::Record) == 32, "Record layout must not change");
+    static_assert(sizeof(Header) == 64, "Header layout must not change");
+    static_assert(sizeof(Slot) == 40, "Slot layout must not change");
+    static_assert(std::atomic<quint64>::is_always_lock_free, "Shared atomics must be lock (and address) free");
+
+    QSharedMemory memory;         ///< Shared memory segment.
+    QString key;                  ///< Key the segment was created, or attached, with.
+    QString errorString;          ///< Description of the last error, if any.
+    bool publisher { false };     ///< Whether this object created (and so publishes to) the segment.
+    quint64 nextSequence { 0 };   ///< Next record number to read, for readers.
+    quint64 overruns { 0 };       ///< Number of records overwritten before this reader could read them.
+
+    explicit SharedSampleRingPrivate(SharedSampleRing * const q);
+
+    void setKey(const QString &key);
+    Header * header() const;
+    Slot * slot(const quint64 sequence) const;
+    bool validate();
+    void write(const SharedSampleRing::Record &record);
+
+protected:
+    SharedSampleRing * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(SharedSampleRing)
+    Q_DISABLE_COPY(SharedSampleRingPrivate)
+    QTPOKIT_BEFRIEND_TEST(SharedSampleRing)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SHAREDSAMPLERING_P_H
@@ -0,0 +1,456 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the SoftwareTrigger and SoftwareTriggerPrivate classes.
+ */
+
+#include <qtpokit/softwaretrigger.h>
+#include "softwaretrigger_p.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class SoftwareTrigger
+ *
+ * The SoftwareTrigger class watches a stream of values, such as back-to-back DSO captures, or fast multimeter
+ * readings, for a trigger condition, and emits just the segments of the stream around each trigger, via triggered.
+ * This allows rare events to be caught, with their context, without recording everything.
+ *
+ * Unlike the DSO's own (hardware) trigger, which fires at most once per capture, and captures nothing from before the
+ * trigger, a SoftwareTrigger keeps a circular buffer of the most recent Settings::preTrigger values, so each segment
+ * begins with (up to) that many values from before the trigger sample, then continues for Settings::postTrigger
+ * values from the trigger sample onwards. While a segment is being captured, further triggers are ignored (ie the
+ * post-trigger period is also the hold-off period), and the next segment's pre-trigger values never overlap the
+ * previous segment.
+ *
+ * The supported conditions are:
+ *
+ * - Condition::Level triggers whenever a value is at or above (Slope::Rising), or at or below (Slope::Falling), the
+ *   trigger level, or at or beyond it in magnitude (Slope::Either). So a level that persists triggers segment after
+ *   segment.
+ * - Condition::Edge triggers when values cross the trigger level in the given direction/s. After each crossing, the
+ *   values must return beyond the level by at least Settings::hysteresis before the next crossing counts, so noise
+ *   near the level does not trigger repeatedly.
+ * - Condition::Window triggers when values leave the window between the lower and upper levels, through the top
+ *   (Slope::Rising), the bottom (Slope::Falling), or either. Values must first be (at least Settings::hysteresis)
+ *   inside the window for a departure to count.
+ * - Condition::PulseWidth triggers at the end of a positive (Slope::Rising) or negative (Slope::Falling) pulse beyond
+ *   the trigger level, if the pulse lasted between Settings::minWidth and Settings::maxWidth samples, inclusive. A
+ *   pulse begins with an edge (as per Condition::Edge), and ends once values return beyond the level by more than
+ *   Settings::hysteresis. This catches glitches (narrow pulses) and dropouts (wide ones) alike.
+ *
+ * Positions (and hence widths) are counted in samples, from the first value processed since construction, or the last
+ * reset(). Note that when attached to a DSO service, consecutive captures are treated as one continuous stream, even
+ * though there may be gaps in time between them.
+ */
+
+/*!
+ * Constructs a new SoftwareTrigger object, not attached to any service, with \a parent. Values may be processed via
+ * process() instead.
+ */
+SoftwareTrigger::SoftwareTrigger(QObject * parent)
+    : QObject(parent), d_ptr(new SoftwareTriggerPrivate(this))
+{
+
+}
+
+/*!
+ * Constructs a new SoftwareTrigger object that watches (scaled) samples from DSO \a service, with \a parent.
+ */
+SoftwareTrigger::SoftwareTrigger(DsoService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new SoftwareTriggerPrivate(this))
+{
+    Q_D(SoftwareTrigger);
+    d->setService(service);
+}
+
+/*!
+ * Constructs a new SoftwareTrigger object that watches reading values from multimeter \a service, with \a parent.
+ */
+SoftwareTrigger::SoftwareTrigger(MultimeterService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new SoftwareTriggerPrivate(this))
+{
+    Q_D(SoftwareTrigger);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new SoftwareTrigger object with \a parent, and private implementation \a d.
+ */
+SoftwareTrigger::SoftwareTrigger(SoftwareTriggerPrivate * const d, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+
+}
+/// \endcond
+
+/*!
+ * Destroys this SoftwareTrigger object.
+ */
+SoftwareTrigger::~SoftwareTrigger()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the service this object watches, if any.
+ */
+AbstractPokitService * SoftwareTrigger::service() const
+{
+    Q_D(const SoftwareTrigger);
+    return d->service;
+}
+
+/*!
+ * Returns the current trigger settings.
+ */
+SoftwareTrigger::Settings SoftwareTrigger::settings() const
+{
+    Q_D(const SoftwareTrigger);
+    return d->settings;
+}
+
+/*!
+ * Sets the trigger settings to \a settings, and resets the trigger, or if \a settings are not valid (see isValid()),
+ * logs a warning, and leaves the current settings unchanged.
+ */
+void SoftwareTrigger::setSettings(const Settings &settings)
+{
+    Q_D(SoftwareTrigger);
+    if (!isValid(settings)) {
+        qCWarning(d->lc).noquote() << tr("Invalid software trigger settings; keeping the current settings.");
+        return;
+    }
+    d->settings = settings;
+    d->clear();
+}
+
+/*!
+ * Returns \c true if a segment has been triggered, but not all of its post-trigger values have been processed yet.
+ */
+bool SoftwareTrigger::isCapturing() const
+{
+    Q_D(const SoftwareTrigger);
+    return d->postToGo > 0;
+}
+
+/*!
+ * Returns the number of values processed since construction, or the last reset().
+ */
+quint64 SoftwareTrigger::samplesProcessed() const
+{
+    Q_D(const SoftwareTrigger);
+    return d->position;
+}
+
+/*!
+ * Returns the number of segments triggered since construction, or the last reset().
+ */
+quint64 SoftwareTrigger::triggerCount() const
+{
+    Q_D(const SoftwareTrigger);
+    return d->triggers;
+}
+
+/*!
+ * Processes \a count \a values, in order, emitting triggered for each segment completed by them.
+ *
+ * Values from service() (if any) are processed automatically. This function allows values from other sources (such as
+ * filtered samples) to be processed instead.
+ */
+void SoftwareTrigger::process(const float * const values, const qsizetype count)
+{
+    Q_D(SoftwareTrigger);
+    for (qsizetype index = 0; index < count; ++index) {
+        const float value = values[index];
+        const bool trigger = d->isTrigger(value); // Always evaluated, to keep the condition state current.
+        if (d->postToGo > 0) {
+            d->segment.values.append(value);
+            if (--d->postToGo == 0) {
+                d->finishSegment();
+            }
+        } else if (trigger) {
+            d->startSegment(value);
+        } else {
+            d->pushHistory(value);
+        }
+        ++d->position;
+    }
+}
+
+/*!
+ * Processes \a values, in order, emitting triggered for each segment completed by them.
+ */
+void SoftwareTrigger::process(const QVector<float> &values)
+{
+    process(values.constData(), values.size());
+}
+
+/*!
+ * Returns the default settings, which trigger on level 0 rising edges, with 100 pre-trigger, and 900 post-trigger
+ * values.
+ */
+SoftwareTrigger::Settings SoftwareTrigger::defaultSettings()
+{
+    return { Condition::Edge, Slope::Rising, 0.0f, 0.0f, 0.0f, 1, 0, 100, 900 };
+}
+
+/*!
+ * Returns \c true if \a settings are valid. That is, with finite levels, a non-negative hysteresis, at least one
+ * post-trigger value, and for Condition::Window, a window wider than twice the hysteresis, or for
+ * Condition::PulseWidth, a maximum width (if any) no less than the minimum width, which must be at least 1.
+ */
+bool SoftwareTrigger::isValid(const Settings &settings)
+{
+    if ((!qIsFinite(settings.level)) || (!qIsFinite(settings.hysteresis)) || (!(settings.hysteresis >= 0.0f)) ||
+        (settings.postTrigger == 0)) {
+        return false;
+    }
+    switch (settings.condition) {
+    case Condition::Level:
+    case Condition::Edge:
+        return true;
+    case Condition::Window:
+        return (qIsFinite(settings.upperLevel)) && (settings.upperLevel - settings.level > 2 * settings.hysteresis);
+    case Condition::PulseWidth:
+        return (settings.minWidth > 0) && ((settings.maxWidth == 0) || (settings.maxWidth >= settings.minWidth));
+    }
+    return false; // Unknown condition.
+}
+
+/*!
+ * Emits the segment currently being captured (if any), with just the post-trigger values processed so far, such as
+ * when the stream has ended.
+ */
+void SoftwareTrigger::flush()
+{
+    Q_D(SoftwareTrigger);
+    if (d->postToGo > 0) {
+        d->finishSegment();
+    }
+}
+
+/*!
+ * Discards any pre-trigger values, and segment being captured, and resets the condition state, positions and trigger
+ * count, such that the next value is processed as if it were the first.
+ */
+void SoftwareTrigger::reset()
+{
+    Q_D(SoftwareTrigger);
+    d->clear();
+}
+
+/*!
+ * \fn SoftwareTrigger::triggered
+ *
+ * This signal is emitted when \a segment has been triggered, and either all of its post-trigger values have been
+ * processed, or flush() was called.
+ */
+
+/*!
+ * \cond internal
+ * \class SoftwareTriggerPrivate
+ *
+ * The SoftwareTriggerPrivate class provides private implementation for SoftwareTrigger.
+ */
+
+/*!
+ * \struct SoftwareTriggerPrivate::Tracker
+ *
+ * Falling values are tracked as negated rising values (with a negated level, and window), so that a single update()
+ * implementation handles both directions.
+ */
+
+/*!
+ * Constructs a new SoftwareTriggerPrivate object with public implementation \a q.
+ */
+SoftwareTriggerPrivate::SoftwareTriggerPrivate(SoftwareTrigger * const q) : q_ptr(q)
+{
+    clear();
+}
+
+/*!
+ * Sets the service to watch to \a newService, which may be a DsoService or MultimeterService (or \c nullptr).
+ */
+void SoftwareTriggerPrivate::setService(AbstractPokitService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (auto * const dso = qobject_cast<DsoService *>(service); dso) {
+        connect(dso, &DsoService::metadataRead, this, &SoftwareTriggerPrivate::dsoMetadataRead);
+        connect(dso, &DsoService::samplesRead, this, &SoftwareTriggerPrivate::dsoSamplesRead);
+    } else if (auto * const meter = qobject_cast<MultimeterService *>(service); meter) {
+        connect(meter, &MultimeterService::readingRead, this, &SoftwareTriggerPrivate::readingRead);
+    }
+}
+
+/*!
+ * Updates \a tracker with \a value, for a rising trigger at \a level (or a window from \a level to \a upper), and
+ * returns \c true if \a value triggers.
+ */
+bool SoftwareTriggerPrivate::update(Tracker &tracker, const float value, const float level, const float upper) const
+{
+    const float hysteresis = settings.hysteresis;
+    switch (settings.condition) {
+    case SoftwareTrigger::Condition::Level:
+        return value >= level;
+    case SoftwareTrigger::Condition::Edge:
+        if ((tracker.armed) && (value >= level)) {
+            tracker.armed = false;
+            return true;
+        }
+        tracker.armed |= (value < level - hysteresis);
+        return false;
+    case SoftwareTrigger::Condition::Window:
+        if ((tracker.armed) && (value > upper)) {
+            tracker.armed = false;
+            return true;
+        }
+        tracker.armed |= ((value >= level + hysteresis) && (value <= upper - hysteresis));
+        return false;
+    case SoftwareTrigger::Condition::PulseWidth:
+        if (tracker.width > 0) {
+            if (value >= level - hysteresis) {
+                ++tracker.width; // The pulse continues.
+                return false;
+            }
+            const quint64 width = tracker.width;
+            tracker.width = 0;
+            tracker.armed = true; // Since the value is now beyond the level, by more than the hysteresis.
+            return (width >= settings.minWidth) && ((settings.maxWidth == 0) || (width <= settings.maxWidth));
+        }
+        if ((tracker.armed) && (value >= level)) {
+            tracker.armed = false;
+            tracker.width = 1; // The pulse begins.
+            return false;
+        }
+        tracker.armed |= (value < level - hysteresis);
+        return false;
+    }
+    return false;
+}
+
+/*!
+ * Updates the condition state with \a value, and returns \c true if \a value triggers.
+ */
+bool SoftwareTriggerPrivate::isTrigger(const float value)
+{
+    if ((settings.condition == SoftwareTrigger::Condition::Level) &&
+        (settings.slope == SoftwareTrigger::Slope::Either)) {
+        return qAbs(value) >= qAbs(settings.level);
+    }
+    const bool isWindow = (settings.condition == SoftwareTrigger::Condition::Window);
+    const bool isRising = (settings.slope != SoftwareTrigger::Slope::Falling) &&
+        update(rising, value, settings.level, settings.upperLevel);
+    const bool isFalling = (settings.slope != SoftwareTrigger::Slope::Rising) &&
+        update(falling, -value, (isWindow) ? -settings.upperLevel : -settings.level, -settings.level);
+    return (isRising) || (isFalling);
+}
+
+/*!
+ * Appends \a value to the pre-trigger #history, dropping the oldest value if already full.
+ */
+void SoftwareTriggerPrivate::pushHistory(const float value)
+{
+    if (history.isEmpty()) {
+        return; // No pre-trigger values wanted.
+    }
+    if (historySize < history.size()) {
+        history[(historyStart + historySize++) % history.size()] = value;
+    } else {
+        history[historyStart] = value;
+        historyStart = (historyStart + 1) % history.size();
+    }
+}
+
+/*!
+ * Begins a new segment, triggered by \a value, with the pre-trigger #history.
+ */
+void SoftwareTriggerPrivate::startSegment(const float value)
+{
+    ++triggers;
+    segment.firstSample = position - (quint64)historySize;
+    segment.triggerSample = position;
+    segment.values.clear();
+    segment.values.reserve(historySize + settings.postTrigger);
+    for (qsizetype index = 0; index < historySize; ++index) {
+        segment.values.append(history.at((historyStart + index) % history.size()));
+    }
+    segment.values.append(value);
+    historyStart = historySize = 0;
+    qCDebug(lc).noquote() << tr("Triggered at sample %L1, with %Ln pre-trigger value/s.", nullptr,
+        segment.triggerSample - segment.firstSample).arg(segment.triggerSample);
+    if ((postToGo = settings.postTrigger - 1) == 0) {
+        finishSegment();
+    }
+}
+
+/*!
+ * Emits the segment being captured, and re-arms (though the condition state continues from the segment's values).
+ */
+void SoftwareTriggerPrivate::finishSegment()
+{
+    postToGo = 0;
+    Q_Q(SoftwareTrigger);
+    Q_EMIT q->triggered(segment);
+    segment.values.clear();
+}
+
+/*!
+ * Clears all trigger state, and (re)sizes #history for the current settings.
+ */
+void SoftwareTriggerPrivate::clear()
+{
+    rising = falling = Tracker{};
+    history.fill(0.0f, settings.preTrigger);
+    historyStart = historySize = 0;
+    segment = SoftwareTrigger::Segment{ 0, 0, { } };
+    postToGo = 0;
+    position = 0;
+    triggers = 0;
+}
+
+/*!
+ * Takes the scale for the samples of the DSO capture described by \a metadata.
+ */
+void SoftwareTriggerPrivate::dsoMetadataRead(const DsoService::Metadata &metadata)
+{
+    scale = metadata.scale;
+}
+
+/*!
+ * Scales, and processes, raw DSO \a samples.
+ */
+void SoftwareTriggerPrivate::dsoSamplesRead(const QVector<qint16> &samples)
+{
+    scaled.resize(samples.size());
+    std::transform(samples.constBegin(), samples.constEnd(), scaled.begin(),
+                   [this](const qint16 sample) { return sample * scale; });
+    Q_Q(SoftwareTrigger);
+    q->process(scaled);
+}
+
+/*!
+ * Processes multimeter \a reading's value.
+ */
+void SoftwareTriggerPrivate::readingRead(const MultimeterService::Reading &reading)
+{
+    Q_Q(SoftwareTrigger);
+    q->process(&reading.value, 1);
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the SoftwareTriggerPrivate class.
+ */
+
+#ifndef QTPOKIT_SOFTWARETRIGGER_P_H
+#define QTPOKIT_SOFTWARETRIGGER_P_H
+
+#include <qtpokit/softwaretrigger.h>
+
+#include <QLoggingCategory>
+#include <QObject>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT SoftwareTriggerPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.software.trigger", QtInfoMsg); ///< Logging category.
+
+    /// Trigger condition state, for one direction (with falling values tracked as negated rising values).
+    struct Tracker {
+        bool armed { false };  ///< Whether values have been on the near side of the level (or inside the window).
+        quint64 width { 0 };   ///< Width of the pulse in progress, in samples, or 0 if none.
+    };
+
+    AbstractPokitService * service { nullptr };   ///< DSO, or multimeter, service to trigger on, if any.
+    float scale { 1.0f };                         ///< Scale of the current DSO capture's raw samples.
+    SoftwareTrigger::Settings settings { SoftwareTrigger::defaultSettings() }; ///< Current trigger settings.
+
+    Tracker rising;                               ///< Condition state for rising values (or positive pulses).
+    Tracker falling;                              ///< Condition state for falling values (or negative pulses).
+    QVector<float> history;                       ///< Circular buffer of up to Settings::preTrigger recent values.
+    qsizetype historyStart { 0 };                 ///< Index of the oldest value in #history.
+    qsizetype historySize { 0 };                  ///< Number of values in #history.
+    SoftwareTrigger::Segment segment { 0, 0, { } }; ///< Segment being captured, if #postToGo is non-zero.
+    quint32 postToGo { 0 };                       ///< Number of post-trigger values still to capture.
+    quint64 position { 0 };                       ///< Position, within the whole stream, of the next value.
+    quint64 triggers { 0 };                       ///< Number of segments triggered.
+    QVector<float> scaled;                        ///< Scaled DSO samples, reused for each notification.
+
+    explicit SoftwareTriggerPrivate(SoftwareTrigger * const q);
+
+    void setService(AbstractPokitService * const newService);
+
+    bool update(Tracker &tracker, const float value, const float level, const float upper) const;
+    bool isTrigger(const float value);
+    void pushHistory(const float value);
+    void startSegment(const float value);
+    void finishSegment();
+    void clear();
+
+public Q_SLOTS:
+    void dsoMetadataRead(const DsoService::Metadata &metadata);
+    void dsoSamplesRead(const QVector<qint16> &samples);
+    void readingRead(const MultimeterService::Reading &reading);
+
+protected:
+    SoftwareTrigger * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(SoftwareTrigger)
+    Q_DISABLE_COPY(SoftwareTriggerPrivate)
+    QTPOKIT_BEFRIEND_TEST(SoftwareTrigger)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_SOFTWARETRIGGER_P_H
@@ -0,0 +1,543 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the StallWatchdog and StallWatchdogPrivate classes.
+ */
+
+#include <qtpokit/stallwatchdog.h>
+#include "stallwatchdog_p.h"
+#include "abstractpokitservice_p.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/abstractpokitservice.h>
+#include <qtpokit/pokitdevice.h>
+
+#include <QLowEnergyController>
+#include <QMutexLocker>
+#include <QtMath>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class StallWatchdog
+ *
+ * The StallWatchdog class detects when a service's notifications have silently stopped arriving (as some BLE stacks,
+ * and devices, are prone to do, without reporting any error), and attempts to recover from such stalls automatically.
+ *
+ * The watchdog knows the stream's expected cadence either from expectedInterval() (such as the multimeter's update
+ * interval), or by learning it from the intervals between values received (see learnedInterval()). The stream is
+ * considered stalled once no value has been received for stallTimeout(), that is, stallFactor() times the cadence, but
+ * no less than minimumTimeout().
+ *
+ * Each stall is then recovered from by escalating recovery actions, each given another stallTimeout() to take effect:
+ * first the service's notifications are re-enabled, then its last written settings are re-written, and finally the
+ * device is disconnected, so that PokitDevice's reconnection policy reconnects it, and resumes the service. The last
+ * action is repeated until values arrive again, unless the device has no reconnection policy (or none was given), in
+ * which case recoveryFailed is emitted (once per stall) instead.
+ *
+ * Stalls, and recoveries from them, are also counted in the service's statistics().
+ */
+
+/// Returns \a action as a (non-translated) string, suitable for machine-readable output.
+QString StallWatchdog::toString(const Action action)
+{
+    switch (action) {
+    case Action::ReenableNotifications: return u"ReenableNotifications"_s;
+    case Action::RewriteSettings:       return u"RewriteSettings"_s;
+    case Action::Reconnect:             return u"Reconnect"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Constructs a new StallWatchdog object that watches \a service's values, with \a parent.
+ *
+ * If \a device is not \c nullptr, it will be reconnected once less disruptive recovery actions have failed. Typically,
+ * \a device would be the device that created \a service.
+ */
+StallWatchdog::StallWatchdog(AbstractPokitService * const service, PokitDevice * const device, QObject * parent)
+    : QObject(parent), d_ptr(new StallWatchdogPrivate(this))
+{
+    Q_D(StallWatchdog);
+    d->setService(service, device);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new StallWatchdog object with \a service, \a device, \a parent, and private implementation \a d.
+ */
+StallWatchdog::StallWatchdog(StallWatchdogPrivate * const d, AbstractPokitService * const service,
+                             PokitDevice * const device, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service, device);
+}
+/// \endcond
+
+/*!
+ * Destroys this StallWatchdog object.
+ */
+StallWatchdog::~StallWatchdog()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the service this object watches.
+ */
+AbstractPokitService * StallWatchdog::service() const
+{
+    Q_D(const StallWatchdog);
+    return d->service;
+}
+
+/*!
+ * Returns the device this object reconnects to recover from stalls, if any.
+ */
+PokitDevice * StallWatchdog::device() const
+{
+    Q_D(const StallWatchdog);
+    return d->device;
+}
+
+/*!
+ * Returns the expected interval between values, in milliseconds, or 0 if the interval is to be learned instead.
+ */
+quint32 StallWatchdog::expectedInterval() const
+{
+    Q_D(const StallWatchdog);
+    return d->expectedInterval;
+}
+
+/*!
+ * Sets the expected interval between values to \a interval milliseconds. The default is 0, in which case the interval
+ * is learned from the values received (see learnedInterval()).
+ */
+void StallWatchdog::setExpectedInterval(const quint32 interval)
+{
+    Q_D(StallWatchdog);
+    d->expectedInterval = interval;
+    d->arm();
+}
+
+/*!
+ * Returns the interval between values learned so far, in milliseconds, or 0 if not enough values have been received to
+ * learn it yet. The learned interval is a moving average, so adapts to gradual changes in the stream's cadence, while
+ * tolerating occasional late (or early) values.
+ */
+quint32 StallWatchdog::learnedInterval() const
+{
+    Q_D(const StallWatchdog);
+    return (quint32)qCeil(d->learnedInterval);
+}
+
+/*!
+ * Returns the multiple of the interval between values, without any value, after which the stream is considered
+ * stalled.
+ */
+float StallWatchdog::stallFactor() const
+{
+    Q_D(const StallWatchdog);
+    return d->stallFactor;
+}
+
+/*!
+ * Sets the stall factor to \a factor. The default is 5. Values less than 1 (and non-finite values) are treated as 1.
+ */
+void StallWatchdog::setStallFactor(const float factor)
+{
+    Q_D(StallWatchdog);
+    d->stallFactor = (qIsFinite(factor)) ? qMax(factor, 1.0f) : 1.0f;
+    d->arm();
+}
+
+/*!
+ * Returns the minimum time without any value, in milliseconds, after which the stream is considered stalled.
+ */
+quint32 StallWatchdog::minimumTimeout() const
+{
+    Q_D(const StallWatchdog);
+    return d->minimumTimeout;
+}
+
+/*!
+ * Sets the minimum stall timeout to \a timeout milliseconds. The default is 2,000ms, which allows for the occasional
+ * delays typical of BLE connections, even for fast streams.
+ */
+void StallWatchdog::setMinimumTimeout(const quint32 timeout)
+{
+    Q_D(StallWatchdog);
+    d->minimumTimeout = timeout;
+    d->arm();
+}
+
+/*!
+ * Returns the time without any value, in milliseconds, after which the stream is considered stalled, or 0 if the
+ * stream's interval is not known (yet), in which case stalls cannot be detected.
+ */
+quint32 StallWatchdog::stallTimeout() const
+{
+    Q_D(const StallWatchdog);
+    return d->stallTimeout();
+}
+
+/*!
+ * Returns \c true if this watchdog has been started, and not stopped since.
+ */
+bool StallWatchdog::isActive() const
+{
+    Q_D(const StallWatchdog);
+    return d->active;
+}
+
+/*!
+ * Returns \c true if the stream is currently stalled, that is, a stall has been detected, and no value has been
+ * received since.
+ */
+bool StallWatchdog::isStalled() const
+{
+    Q_D(const StallWatchdog);
+    return d->stalled;
+}
+
+/*!
+ * Returns the number of stalls detected since construction.
+ */
+quint64 StallWatchdog::stallCount() const
+{
+    Q_D(const StallWatchdog);
+    return d->stalls;
+}
+
+/*!
+ * Returns the number of stalls recovered from (that is, after which values were received again) since construction.
+ */
+quint64 StallWatchdog::recoveryCount() const
+{
+    Q_D(const StallWatchdog);
+    return d->recoveries;
+}
+
+/*!
+ * Starts watching for stalls, as of now. This would typically be called once the service's notifications have been
+ * enabled, so that the time taken to set up the stream is not mistaken for a stall.
+ */
+void StallWatchdog::start()
+{
+    Q_D(StallWatchdog);
+    d->active = true;
+    d->lastValue = AbstractPokitServicePrivate::steadyTimestamp();
+    d->clearStall();
+    d->arm();
+}
+
+/*!
+ * Stops watching for stalls, such as when the application deliberately stops the stream. Any stall in progress is
+ * abandoned (that is, neither recovered from, nor failed).
+ */
+void StallWatchdog::stop()
+{
+    Q_D(StallWatchdog);
+    d->active = false;
+    d->clearStall();
+    d->timer.stop();
+}
+
+/*!
+ * \fn StallWatchdog::stalled
+ *
+ * This signal is emitted when a stall is detected, \a elapsed milliseconds since the last value (or start()).
+ */
+
+/*!
+ * \fn StallWatchdog::recoveryAttempted
+ *
+ * This signal is emitted when recovery \a action has been initiated, as the \a attempt'th (from 1) attempt to recover
+ * from the current stall.
+ */
+
+/*!
+ * \fn StallWatchdog::recovered
+ *
+ * This signal is emitted when a value is received after a stall, \a duration milliseconds after the stall was first
+ * detected.
+ */
+
+/*!
+ * \fn StallWatchdog::recoveryFailed
+ *
+ * This signal is emitted when all available recovery actions have been attempted without recovering from the current
+ * stall. The watchdog will remain stalled until a value is received, or it is stopped.
+ */
+
+/*!
+ * \cond internal
+ * \class StallWatchdogPrivate
+ *
+ * The StallWatchdogPrivate class provides private implementation for StallWatchdog.
+ */
+
+/*!
+ * Constructs a new StallWatchdogPrivate object with public implementation \a q.
+ */
+StallWatchdogPrivate::StallWatchdogPrivate(StallWatchdog * const q) : q_ptr(q)
+{
+    timer.setSingleShot(true);
+    connect(&timer, &QTimer::timeout, this, &StallWatchdogPrivate::timeout);
+}
+
+/*!
+ * Sets \a newService as the service to watch, and \a newDevice as the device to reconnect, disconnecting from any
+ * previous service.
+ */
+void StallWatchdogPrivate::setService(AbstractPokitService * const newService, PokitDevice * const newDevice)
+{
+    device = newDevice;
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &AbstractPokitService::valueReceived, this, &StallWatchdogPrivate::valueReceived);
+    }
+}
+
+/*!
+ * Returns the interval between values, in milliseconds, either as expected, or as learned, or 0 if neither is known.
+ */
+quint32 StallWatchdogPrivate::interval() const
+{
+    return (expectedInterval > 0) ? expectedInterval : (quint32)qCeil(learnedInterval);
+}
+
+/*!
+ * Returns the stall timeout, in milliseconds, or 0 if the interval is not known.
+ */
+quint32 StallWatchdogPrivate::stallTimeout() const
+{
+    const quint32 cadence = interval();
+    if (cadence == 0) {
+        return 0;
+    }
+    const double timeout = qMax((double)cadence * stallFactor, (double)minimumTimeout);
+    return (quint32)qCeil(qMin(timeout, (double)std::numeric_limits<int>::max()));
+}
+
+/*!
+ * (Re)starts the timer to expire one stall timeout after the last value, if active, and not already stalled (in which
+ * case the timer is timing the current recovery attempt instead).
+ */
+void StallWatchdogPrivate::arm()
+{
+    if ((!active) || (stalled)) {
+        return;
+    }
+    const quint32 timeout = stallTimeout();
+    if (timeout == 0) {
+        timer.stop();
+        return;
+    }
+    const qint64 elapsed = (AbstractPokitServicePrivate::steadyTimestamp() - lastValue) / 1000000;
+    timer.start((int)qMax<qint64>(timeout - elapsed, 0));
+}
+
+/*!
+ * Clears the current stall (if any), and its recovery progress.
+ */
+void StallWatchdogPrivate::clearStall()
+{
+    stalled = false;
+    stalledAt = -1;
+    attempts = 0;
+    nextAction = 1;
+    failed = false;
+}
+
+/*!
+ * Returns \a service's private implementation, since recovery actions use its internal request queue.
+ */
+AbstractPokitServicePrivate * StallWatchdogPrivate::servicePrivate(AbstractPokitService * const service)
+{
+    return service->d_ptr;
+}
+
+/*!
+ * Returns the \a index'th (from 1) recovery action, in order of escalation.
+ */
+StallWatchdog::Action StallWatchdogPrivate::action(const int index)
+{
+    switch (index) {
+    case 1:  return StallWatchdog::Action::ReenableNotifications;
+    case 2:  return StallWatchdog::Action::RewriteSettings;
+    default: return StallWatchdog::Action::Reconnect;
+    }
+}
+
+/*!
+ * Disables, then re-enables, notifications for all of the service's notifying characteristics. This recovers from
+ * devices (and BLE stacks) that have silently dropped a notification subscription. Returns \c false if the service has
+ * no notifications enabled, or any of the requests failed to be queued.
+ */
+bool StallWatchdogPrivate::reenableNotifications()
+{
+    AbstractPokitServicePrivate * const serviceImpl = servicePrivate(service);
+    const QSet<QBluetoothUuid> characteristics = serviceImpl->notifyingCharacteristics; // Copy; we modify it below.
+    bool result = !characteristics.isEmpty();
+    for (const QBluetoothUuid &uuid: characteristics) {
+        result &= serviceImpl->disableCharacteristicNotificatons(uuid);
+        result &= serviceImpl->enableCharacteristicNotificatons(uuid);
+    }
+    return result;
+}
+
+/*!
+ * Re-writes the service's last written settings (such as the multimeter's mode), which some devices need to restart
+ * a stream that has stopped. Returns \c false if the service has no settings to re-write, or any of the requests failed
+ * to be queued.
+ */
+bool StallWatchdogPrivate::rewriteSettings()
+{
+    AbstractPokitServicePrivate * const serviceImpl = servicePrivate(service);
+    const QHash<QBluetoothUuid, QByteArray> values = serviceImpl->resumeValues;
+    bool result = !values.isEmpty();
+    for (auto iter = values.constBegin(); iter != values.constEnd(); ++iter) {
+        result &= serviceImpl->writeCharacteristic(iter.key(), iter.value());
+    }
+    return result;
+}
+
+/*!
+ * Disconnects the device, which PokitDevice treats as an unexpected disconnection, such that its reconnect policy
+ * reconnects it, and resumes the service's notifications and settings. Returns \c false if there is no device, or the
+ * device has no reconnect policy.
+ */
+bool StallWatchdogPrivate::reconnect()
+{
+    if ((!device) || (device->reconnectPolicy().maximumAttempts <= 0) || (!device->controller())) {
+        return false;
+    }
+    if (!device->isReconnecting()) {
+        device->controller()->disconnectFromDevice();
+    }
+    return true;
+}
+
+/*!
+ * Counts a stall in the service's statistics.
+ */
+void StallWatchdogPrivate::countStall()
+{
+    ++stalls;
+    AbstractPokitServicePrivate * const serviceImpl = servicePrivate(service);
+    const QMutexLocker locker(&serviceImpl->statisticsMutex);
+    ++serviceImpl->statistics.stalls;
+}
+
+/*!
+ * Counts a recovery in the service's statistics.
+ */
+void StallWatchdogPrivate::countRecovery()
+{
+    ++recoveries;
+    AbstractPokitServicePrivate * const serviceImpl = servicePrivate(service);
+    const QMutexLocker locker(&serviceImpl->statisticsMutex);
+    ++serviceImpl->statistics.stallRecoveries;
+}
+
+/*!
+ * Handles a value received at \a timestamp (steady clock ns), refining the learned interval, and ending any stall in
+ * progress. Values of any \a characteristic count, since a stall of one typically means a stall of them all.
+ */
+void StallWatchdogPrivate::valueReceived(const QBluetoothUuid &characteristic, const qint64 timestamp)
+{
+    Q_UNUSED(characteristic)
+    if (!active) {
+        return;
+    }
+    // Only learn from consecutive values, since the gap spanning a start (or stall) is not the stream's cadence.
+    if ((!stalled) && (values > 0) && (lastValue >= 0) && (timestamp > lastValue)) {
+        const double gap = (timestamp - lastValue) / 1000000.0;
+        learnedInterval = (learnedInterval > 0.0) ? learnedInterval + learningRate * (gap - learnedInterval) : gap;
+    }
+    ++values;
+    lastValue = timestamp;
+    if (stalled) {
+        Q_Q(StallWatchdog);
+        const qint64 duration = qMax<qint64>(timestamp - stalledAt, 0) / 1000000;
+        clearStall();
+        countRecovery();
+        qCInfo(lc).noquote() << tr("Recovered from stall after %L1ms.").arg(duration);
+        Q_EMIT q->recovered(duration);
+    }
+    arm();
+}
+
+/*!
+ * Handles the expiry of #timer, which means either a (new) stall, or that the current recovery attempt has not (yet)
+ * succeeded, so escalates to the next recovery attempt.
+ */
+void StallWatchdogPrivate::timeout()
+{
+    if ((!active) || (!service)) {
+        return;
+    }
+    Q_Q(StallWatchdog);
+    if (!stalled) {
+        const qint64 now = AbstractPokitServicePrivate::steadyTimestamp();
+        const qint64 elapsed = (now - lastValue) / 1000000;
+        clearStall();
+        stalled = true;
+        stalledAt = now;
+        countStall();
+        qCWarning(lc).noquote() << tr("No values received for %L1ms (expected every %L2ms); stalled.")
+            .arg(elapsed).arg(interval());
+        Q_EMIT q->stalled(elapsed);
+    }
+
+    // Give reconnections in progress (by us, or otherwise) the chance to complete before escalating any further.
+    const int recoveryTimeout = (int)qMax(stallTimeout(), minimumTimeout);
+    if ((device) && (device->isReconnecting())) {
+        qCDebug(lc).noquote() << tr("Device is reconnecting; waiting before further recovery.");
+        timer.start(recoveryTimeout);
+        return;
+    }
+
+    // Escalate to the next applicable action (re-writing settings, for example, does not apply to all services). The
+    // last action, reconnecting, is repeated for as long as it remains applicable.
+    for (int index = nextAction; index <= 3; ++index) {
+        const StallWatchdog::Action candidate = action(index);
+        bool initiated = false;
+        switch (candidate) {
+        case StallWatchdog::Action::ReenableNotifications: initiated = reenableNotifications(); break;
+        case StallWatchdog::Action::RewriteSettings:       initiated = rewriteSettings();       break;
+        case StallWatchdog::Action::Reconnect:             initiated = reconnect();             break;
+        }
+        if (initiated) {
+            nextAction = qMin(index + 1, 3);
+            ++attempts;
+            qCInfo(lc).noquote() << tr("Attempting stall recovery %L1: %2.")
+                .arg(attempts).arg(StallWatchdog::toString(candidate));
+            Q_EMIT q->recoveryAttempted(candidate, attempts);
+            timer.start(recoveryTimeout);
+            return;
+        }
+    }
+
+    if (!failed) {
+        failed = true;
+        qCWarning(lc).noquote() << tr("All stall recovery actions failed.");
+        Q_EMIT q->recoveryFailed();
+    }
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the StallWatchdogPrivate class.
+ */
+
+#ifndef QTPOKIT_STALLWATCHDOG_P_H
+#define QTPOKIT_STALLWATCHDOG_P_H
+
+#include <qtpokit/stallwatchdog.h>
+
+#include <QBluetoothUuid>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class AbstractPokitServicePrivate;
+
+class QTPOKIT_EXPORT StallWatchdogPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.ble.watchdog", QtInfoMsg); ///< Logging category.
+
+    /// Weight of each new gap in #learnedInterval's exponentially weighted moving average.
+    static constexpr double learningRate { 0.125 };
+
+    QPointer<AbstractPokitService> service; ///< Service whose values to watch.
+    QPointer<PokitDevice> device;           ///< Device to reconnect, if any.
+    quint32 expectedInterval { 0 };         ///< Expected interval between values, in milliseconds, or 0 to learn it.
+    double learnedInterval { 0.0 };         ///< Moving average of recent intervals between values, in milliseconds.
+    float stallFactor { 5.0f };             ///< Multiple of the interval, without a value, that is a stall.
+    quint32 minimumTimeout { 2000 };        ///< Minimum time without a value that is a stall, in milliseconds.
+    QTimer timer;                           ///< Fires when the stall timeout (or current recovery attempt) expires.
+    bool active { false };                  ///< Whether this watchdog has been started (and not stopped since).
+    qint64 lastValue { -1 };                ///< Steady clock time of the last value (or start), in ns, or -1.
+    quint64 values { 0 };                   ///< Number of values received since started.
+    bool stalled { false };                 ///< Whether the service is currently stalled.
+    qint64 stalledAt { -1 };                ///< Steady clock time the current stall was detected, in ns, or -1.
+    int attempts { 0 };                     ///< Number of recovery attempts made for the current stall.
+    int nextAction { 1 };                   ///< Index (from 1) of the next recovery action to consider (see action()).
+    bool failed { false };                  ///< Whether all recovery actions have failed for the current stall.
+    quint64 stalls { 0 };                   ///< Number of stalls detected.
+    quint64 recoveries { 0 };               ///< Number of stalls recovered from.
+
+    explicit StallWatchdogPrivate(StallWatchdog * const q);
+
+    void setService(AbstractPokitService * const newService, PokitDevice * const newDevice);
+    quint32 interval() const;
+    quint32 stallTimeout() const;
+    void arm();
+    void clearStall();
+
+    static AbstractPokitServicePrivate * servicePrivate(AbstractPokitService * const service);
+    static StallWatchdog::Action action(const int index);
+    bool reenableNotifications();
+    bool rewriteSettings();
+    bool reconnect();
+    void countStall();
+    void countRecovery();
+
+protected:
+    StallWatchdog * q_ptr; ///< Internal q-pointer.
+
+protected Q_SLOTS:
+    void valueReceived(const QBluetoothUuid &characteristic, const qint64 timestamp);
+    void timeout();
+
+private:
+    Q_DECLARE_PUBLIC(StallWatchdog)
+    Q_DISABLE_COPY(StallWatchdogPrivate)
+    QTPOKIT_BEFRIEND_TEST(StallWatchdog)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_STALLWATCHDOG_P_H
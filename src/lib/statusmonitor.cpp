@@ -0,0 +1,357 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the StatusMonitor and StatusMonitorPrivate classes.
+ */
+
+#include <qtpokit/statusmonitor.h>
+#include "statusmonitor_p.h"
+#include "../stringliterals_p.h"
+
+#include <QtMath>
+
+#include <utility>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class StatusMonitor
+ *
+ * The StatusMonitor class watches a device's status, typically via StatusService::enableStatusNotifications(), and
+ * reports just the changes, via statusChanged, along with low battery and charging alerts, via alertRaised.
+ *
+ * Pokit devices can notify their status often, and in bursts, so statuses are first coalesced. That is, the first
+ * status is reported straight away, but then any statuses that arrive within coalesceInterval() of it are held, such
+ * that only the most recent of them is considered once the interval has elapsed. A coalesced status is reported if its
+ * device status, battery status, switch position or charging status differ from the last reported status's, or if its
+ * battery voltage differs from the last reported voltage by more than batteryDeadband().
+ *
+ * The battery is considered low if the device reports its battery status as StatusService::BatteryStatus::Low, or if
+ * its battery voltage is below lowBatteryThreshold() (if set). Once low, the battery is not considered recovered until
+ * the voltage exceeds the threshold by more than batteryDeadband(), so a voltage hovering around the threshold raises
+ * just the one alert.
+ *
+ * Note, this class does not enable the service's notifications itself, since the service may be shared with other
+ * users (such as other monitors, with other thresholds), which may already have done so.
+ */
+
+/// Returns \a alert as a (non-translated) string, suitable for machine-readable output.
+QString StatusMonitor::toString(const Alert alert)
+{
+    switch (alert) {
+    case Alert::LowBattery:       return u"LowBattery"_s;
+    case Alert::BatteryRecovered: return u"BatteryRecovered"_s;
+    case Alert::ChargingChanged:  return u"ChargingChanged"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Constructs a new StatusMonitor object that monitors statuses from \a service, with \a parent.
+ *
+ * \a service may be \c nullptr, in which case statuses may be monitored via addStatus() instead.
+ */
+StatusMonitor::StatusMonitor(StatusService * const service, QObject * parent)
+    : QObject(parent), d_ptr(new StatusMonitorPrivate(this))
+{
+    Q_D(StatusMonitor);
+    d->setService(service);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new StatusMonitor object with \a service, \a parent, and private implementation \a d.
+ */
+StatusMonitor::StatusMonitor(StatusMonitorPrivate * const d, StatusService * const service, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->setService(service);
+}
+/// \endcond
+
+/*!
+ * Destroys this StatusMonitor object.
+ */
+StatusMonitor::~StatusMonitor()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns the status service this object monitors statuses from.
+ */
+StatusService * StatusMonitor::service() const
+{
+    Q_D(const StatusMonitor);
+    return d->service;
+}
+
+/*!
+ * Returns the number of milliseconds over which statuses are coalesced.
+ */
+quint32 StatusMonitor::coalesceInterval() const
+{
+    Q_D(const StatusMonitor);
+    return (quint32)d->coalesceTimer.interval();
+}
+
+/*!
+ * Sets the number of milliseconds over which statuses are coalesced to \a interval. The default is 1,000ms.
+ *
+ * An \a interval of 0 disables coalescing, so that every status is considered as soon as it is added.
+ */
+void StatusMonitor::setCoalesceInterval(const quint32 interval)
+{
+    Q_D(StatusMonitor);
+    d->coalesceTimer.setInterval((int)qMin(interval, (quint32)std::numeric_limits<int>::max()));
+    if (interval == 0) {
+        d->flush();
+    }
+}
+
+/*!
+ * Returns the change in battery voltage, in volts, within which statuses are considered unchanged. This is also the
+ * hysteresis applied to lowBatteryThreshold().
+ */
+float StatusMonitor::batteryDeadband() const
+{
+    Q_D(const StatusMonitor);
+    return d->batteryDeadband;
+}
+
+/*!
+ * Sets the change in battery voltage, in volts, within which statuses are considered unchanged to \a deadband. The
+ * default is 0.05 volts. Negative values are treated as 0.
+ */
+void StatusMonitor::setBatteryDeadband(const float deadband)
+{
+    Q_D(StatusMonitor);
+    d->batteryDeadband = qMax(deadband, 0.0f);
+}
+
+/*!
+ * Returns the battery voltage below which the battery is considered low, or NaN if none (the default), in which case
+ * the battery is only considered low when the device itself says so.
+ */
+float StatusMonitor::lowBatteryThreshold() const
+{
+    Q_D(const StatusMonitor);
+    return d->lowBatteryThreshold;
+}
+
+/*!
+ * Sets the battery voltage below which the battery is considered low to \a threshold. Non-positive (and non-finite)
+ * values clear the threshold.
+ */
+void StatusMonitor::setLowBatteryThreshold(const float threshold)
+{
+    Q_D(StatusMonitor);
+    d->lowBatteryThreshold = ((qIsFinite(threshold)) && (threshold > 0.0f)) ? threshold
+        : std::numeric_limits<float>::quiet_NaN();
+}
+
+/*!
+ * Returns the most recently reported status, if any.
+ */
+std::optional<StatusService::Status> StatusMonitor::lastStatus() const
+{
+    Q_D(const StatusMonitor);
+    return d->lastStatus;
+}
+
+/*!
+ * Returns \c true if the battery was low, as of the most recently considered status.
+ */
+bool StatusMonitor::isBatteryLow() const
+{
+    Q_D(const StatusMonitor);
+    return d->batteryLow;
+}
+
+/*!
+ * Returns the number of statuses added (including those coalesced, and those unchanged) since construction, or the
+ * last reset().
+ */
+quint64 StatusMonitor::notificationCount() const
+{
+    Q_D(const StatusMonitor);
+    return d->notifications;
+}
+
+/*!
+ * Returns the number of statuses reported, via statusChanged, since construction, or the last reset().
+ */
+quint64 StatusMonitor::changeCount() const
+{
+    Q_D(const StatusMonitor);
+    return d->changes;
+}
+
+/*!
+ * Adds \a status to be monitored, coalescing it with any other statuses added within the coalesceInterval().
+ *
+ * Statuses from service() are added automatically. This slot allows statuses from other sources to be monitored too.
+ */
+void StatusMonitor::addStatus(const StatusService::Status &status)
+{
+    Q_D(StatusMonitor);
+    d->addStatus(status);
+}
+
+/*!
+ * Considers the most recently added status (if not already) now, rather than waiting for the coalesceInterval() to
+ * elapse. This is useful just before stopping, so the final status is not lost.
+ */
+void StatusMonitor::flush()
+{
+    Q_D(StatusMonitor);
+    d->flush();
+}
+
+/*!
+ * Forgets all statuses added, and reported, such that the next status will be reported, and resets the counts.
+ */
+void StatusMonitor::reset()
+{
+    Q_D(StatusMonitor);
+    d->coalesceTimer.stop();
+    d->pendingStatus.reset();
+    d->lastStatus.reset();
+    d->lastChargingStatus.reset();
+    d->batteryLow = false;
+    d->notifications = 0;
+    d->changes = 0;
+}
+
+/*!
+ * \fn StatusMonitor::statusChanged
+ *
+ * This signal is emitted when \a status has changed since the last reported status.
+ */
+
+/*!
+ * \fn StatusMonitor::alertRaised
+ *
+ * This signal is emitted when \a status raises \a alert. Alerts are raised after statusChanged (if also emitted) for
+ * the same \a status.
+ */
+
+/*!
+ * \cond internal
+ * \class StatusMonitorPrivate
+ *
+ * The StatusMonitorPrivate class provides private implementation for StatusMonitor.
+ */
+
+/*!
+ * Constructs a new StatusMonitorPrivate object with public implementation \a q.
+ */
+StatusMonitorPrivate::StatusMonitorPrivate(StatusMonitor * const q) : q_ptr(q)
+{
+    coalesceTimer.setInterval(1000);
+    coalesceTimer.setSingleShot(true);
+    connect(&coalesceTimer, &QTimer::timeout, this, &StatusMonitorPrivate::flush);
+}
+
+/*!
+ * Sets \a newService as the status service to monitor, disconnecting from any previous service.
+ */
+void StatusMonitorPrivate::setService(StatusService * const newService)
+{
+    if (newService == service) {
+        return;
+    }
+    if (service) {
+        disconnect(service, nullptr, this, nullptr);
+    }
+    service = newService;
+    if (service) {
+        connect(service, &StatusService::deviceStatusRead, this, &StatusMonitorPrivate::addStatus);
+    }
+}
+
+/*!
+ * Returns \c true if \a status differs from #lastStatus, or if there is no #lastStatus.
+ */
+bool StatusMonitorPrivate::isChanged(const StatusService::Status &status) const
+{
+    if ((!lastStatus) || (status.deviceStatus != lastStatus->deviceStatus) ||
+        (status.batteryStatus != lastStatus->batteryStatus) || (status.switchPosition != lastStatus->switchPosition) ||
+        (status.chargingStatus != lastStatus->chargingStatus)) {
+        return true;
+    }
+    if (status.batteryVoltage == lastStatus->batteryVoltage) {
+        return false;
+    }
+    if ((!qIsFinite(status.batteryVoltage)) || (!qIsFinite(lastStatus->batteryVoltage))) {
+        return !((qIsNaN(status.batteryVoltage)) && (qIsNaN(lastStatus->batteryVoltage)));
+    }
+    return (qAbs(status.batteryVoltage - lastStatus->batteryVoltage) > batteryDeadband);
+}
+
+/*!
+ * Returns \c true if \a status indicates a low battery, allowing for hysteresis if #batteryLow already.
+ */
+bool StatusMonitorPrivate::isBatteryLow(const StatusService::Status &status) const
+{
+    if (status.batteryStatus == StatusService::BatteryStatus::Low) {
+        return true;
+    }
+    if (!qIsFinite(lowBatteryThreshold)) {
+        return false;
+    }
+    return (batteryLow) ? !(status.batteryVoltage > lowBatteryThreshold + batteryDeadband)
+                        : (status.batteryVoltage < lowBatteryThreshold);
+}
+
+/*!
+ * Holds \a status until the coalesce interval elapses, or considers it straight away if nothing has been reported yet,
+ * or coalescing is disabled.
+ */
+void StatusMonitorPrivate::addStatus(const StatusService::Status &status)
+{
+    ++notifications;
+    pendingStatus = status;
+    if ((!lastStatus) || (coalesceTimer.interval() == 0)) {
+        flush();
+    } else if (!coalesceTimer.isActive()) {
+        coalesceTimer.start();
+    }
+}
+
+/*!
+ * Considers #pendingStatus (if any), reporting it if changed, and raising any alerts.
+ */
+void StatusMonitorPrivate::flush()
+{
+    coalesceTimer.stop();
+    if (!pendingStatus) {
+        return;
+    }
+    const StatusService::Status status = *std::exchange(pendingStatus, std::nullopt);
+    Q_Q(StatusMonitor);
+    if (isChanged(status)) {
+        lastStatus = status;
+        ++changes;
+        Q_EMIT q->statusChanged(status);
+    }
+    if (const bool low = isBatteryLow(status); low != batteryLow) {
+        batteryLow = low;
+        Q_EMIT q->alertRaised((low) ? StatusMonitor::Alert::LowBattery : StatusMonitor::Alert::BatteryRecovered,
+                              status);
+    }
+    if (status.chargingStatus) {
+        const bool changed = ((lastChargingStatus) && (*lastChargingStatus != *status.chargingStatus));
+        lastChargingStatus = status.chargingStatus;
+        if (changed) {
+            Q_EMIT q->alertRaised(StatusMonitor::Alert::ChargingChanged, status);
+        }
+    }
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
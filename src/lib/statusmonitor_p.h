@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the StatusMonitorPrivate class.
+ */
+
+#ifndef QTPOKIT_STATUSMONITOR_P_H
+#define QTPOKIT_STATUSMONITOR_P_H
+
+#include <qtpokit/statusmonitor.h>
+
+#include <QObject>
+#include <QTimer>
+
+#include <limits>
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT StatusMonitorPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    StatusService * service { nullptr }; ///< Status service to monitor.
+    float batteryDeadband { 0.05f };     ///< Change in battery voltage to suppress, and low battery hysteresis.
+    float lowBatteryThreshold { std::numeric_limits<float>::quiet_NaN() }; ///< Low battery voltage, if any.
+    QTimer coalesceTimer;                ///< Flushes #pendingStatus once the coalesce interval has elapsed.
+
+    std::optional<StatusService::Status> pendingStatus; ///< Most recent status yet to be flushed, if any.
+    std::optional<StatusService::Status> lastStatus;    ///< Most recently reported (ie changed) status, if any.
+    std::optional<StatusService::ChargingStatus> lastChargingStatus; ///< Most recently flushed charging status.
+    bool batteryLow { false };           ///< Whether the battery was low, as of the most recent flush.
+    quint64 notifications { 0 };         ///< Number of statuses added.
+    quint64 changes { 0 };               ///< Number of statuses reported as changed.
+
+    explicit StatusMonitorPrivate(StatusMonitor * const q);
+
+    void setService(StatusService * const newService);
+
+    bool isChanged(const StatusService::Status &status) const;
+    bool isBatteryLow(const StatusService::Status &status) const;
+    void addStatus(const StatusService::Status &status);
+    void flush();
+
+protected:
+    StatusMonitor * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(StatusMonitor)
+    Q_DISABLE_COPY(StatusMonitorPrivate)
+    QTPOKIT_BEFRIEND_TEST(StatusMonitor)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_STATUSMONITOR_P_H
@@ -7,11 +7,11 @@
  */
 
 #include <qtpokit/statusservice.h>
+#include <pokitcodec/pokitcodec.h>
+#include "characteristiclayout_p.h"
 #include "statusservice_p.h"
 #include "../stringliterals_p.h"
 
-#include <QtEndian>
-
 QTPOKIT_BEGIN_NAMESPACE
 DOKIT_USE_STRINGLITERALS
 
@@ -298,6 +298,18 @@ bool StatusService::enableStatusNotifications()
     return d->enableCharacteristicNotificatons(CharacteristicUuids::status);
 }
 
+/*!
+ * Asynchronous variant of enableStatusNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> StatusService::enableStatusNotificationsAsync()
+{
+    Q_D(StatusService);
+    return d->whenFinished([this]{ return enableStatusNotifications(); });
+}
+
 /*!
  * Disables client-side notifications of device status changes.
  *
@@ -311,6 +323,18 @@ bool StatusService::disableStatusNotifications()
     return d->disableCharacteristicNotificatons(CharacteristicUuids::status);
 }
 
+/*!
+ * Asynchronous variant of disableStatusNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> StatusService::disableStatusNotificationsAsync()
+{
+    Q_D(StatusService);
+    return d->whenFinished([this]{ return disableStatusNotifications(); });
+}
+
 /*!
  * Returns the most recent value of the `Status` services's `Device Name` characteristic.
  *
@@ -335,7 +359,7 @@ QString StatusService::deviceName() const
  */
 bool StatusService::setDeviceName(const QString &name)
 {
-    Q_D(const StatusService);
+    Q_D(StatusService);
     const QLowEnergyCharacteristic characteristic =
         d->getCharacteristic(CharacteristicUuids::name);
     if (!characteristic.isValid()) {
@@ -349,8 +373,7 @@ bool StatusService::setDeviceName(const QString &name)
         return false;
     }
 
-    d->service->writeCharacteristic(characteristic, value);
-    return (d->service->error() != QLowEnergyService::ServiceError::CharacteristicWriteError);
+    return d->writeCharacteristic(characteristic.uuid(), value);
 }
 
 /*!
@@ -370,7 +393,7 @@ bool StatusService::setDeviceName(const QString &name)
  */
 bool StatusService::flashLed()
 {
-    Q_D(const StatusService);
+    Q_D(StatusService);
     const QLowEnergyCharacteristic characteristic =
         d->getCharacteristic(CharacteristicUuids::flashLed);
     if (!characteristic.isValid()) {
@@ -382,8 +405,7 @@ bool StatusService::flashLed()
     // say that "any value other than 1 will be ignored", which makes sense given that all current
     // Pokit devices have only one LED.
     const QByteArray value(1, '\x01');
-    d->service->writeCharacteristic(characteristic, value);
-    return (d->service->error() != QLowEnergyService::ServiceError::CharacteristicWriteError);
+    return d->writeCharacteristic(characteristic.uuid(), value);
 }
 
 /*!
@@ -411,15 +433,14 @@ std::optional<StatusService::TorchStatus> StatusService::torchStatus() const
  */
 bool StatusService::setTorchStatus(const StatusService::TorchStatus status)
 {
-    Q_D(const StatusService);
+    Q_D(StatusService);
     const QLowEnergyCharacteristic characteristic = d->getCharacteristic(CharacteristicUuids::torch);
     if (!characteristic.isValid()) {
         return false;
     }
 
     const QByteArray value(1, static_cast<char>(status));
-    d->service->writeCharacteristic(characteristic, value);
-    return (d->service->error() != QLowEnergyService::ServiceError::CharacteristicWriteError);
+    return d->writeCharacteristic(characteristic.uuid(), value);
 }
 
 /*!
@@ -437,6 +458,18 @@ bool StatusService::enableTorchStatusNotifications()
     return d->enableCharacteristicNotificatons(CharacteristicUuids::torch);
 }
 
+/*!
+ * Asynchronous variant of enableTorchStatusNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> StatusService::enableTorchStatusNotificationsAsync()
+{
+    Q_D(StatusService);
+    return d->whenFinished([this]{ return enableTorchStatusNotifications(); });
+}
+
 /*!
  * Disables client-side notifications of torch status changes.
  *
@@ -450,6 +483,18 @@ bool StatusService::disableTorchStatusNotifications()
     return d->disableCharacteristicNotificatons(CharacteristicUuids::torch);
 }
 
+/*!
+ * Asynchronous variant of disableTorchStatusNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> StatusService::disableTorchStatusNotificationsAsync()
+{
+    Q_D(StatusService);
+    return d->whenFinished([this]{ return disableTorchStatusNotifications(); });
+}
+
 /*!
  * Enables client-side notifications of button presses.
  *
@@ -465,6 +510,18 @@ bool StatusService::enableButtonPressedNotifications()
     return d->enableCharacteristicNotificatons(CharacteristicUuids::buttonPress);
 }
 
+/*!
+ * Asynchronous variant of enableButtonPressedNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> StatusService::enableButtonPressedNotificationsAsync()
+{
+    Q_D(StatusService);
+    return d->whenFinished([this]{ return enableButtonPressedNotifications(); });
+}
+
 /*!
  * Disables client-side notifications of button presses.
  *
@@ -478,6 +535,18 @@ bool StatusService::disableButtonPressedNotifications()
     return d->disableCharacteristicNotificatons(CharacteristicUuids::buttonPress);
 }
 
+/*!
+ * Asynchronous variant of disableButtonPressedNotifications().
+ *
+ * Returns a future that finishes once the Pokit device has acknowledged the client characteristic configuration write.
+ * The future's result is \c true if the request was queued, and succeeded, otherwise \c false.
+ */
+QFuture<bool> StatusService::disableButtonPressedNotificationsAsync()
+{
+    Q_D(StatusService);
+    return d->whenFinished([this]{ return disableButtonPressedNotifications(); });
+}
+
 /*!
  * Returns the most recent value of the `Status` services's `Button Press` characteristic.
  *
@@ -566,12 +635,30 @@ std::optional<StatusService::ButtonStatus> StatusService::buttonPress() const
 /*!
  * \internal
  * Constructs a new StatusServicePrivate object with public implementation \a q.
+ *
+ * If \a controller has already discovered the device's services (such as for a device connected, and discovered, by
+ * PokitConnectionManager before its status service was first requested), then serviceDiscovered() will never be
+ * invoked, so the Status Service UUID is looked up from the controller's already-discovered services instead.
  */
 StatusServicePrivate::StatusServicePrivate(
     QLowEnergyController * controller, StatusService * const q)
     : AbstractPokitServicePrivate(QBluetoothUuid(), controller, q)
 {
-
+    setNotificationHandler(StatusService::CharacteristicUuids::status, [this](const QByteArray &value){
+        Q_Q(StatusService);
+        Q_EMIT q->deviceStatusRead(parseStatus(value));
+    });
+    if (controller) {
+        const QList<QBluetoothUuid> services = controller->services();
+        if (services.contains(StatusService::ServiceUuids::pokitMeter)) {
+            serviceUuid = StatusService::ServiceUuids::pokitMeter;
+        } else if (services.contains(StatusService::ServiceUuids::pokitPro)) {
+            serviceUuid = StatusService::ServiceUuids::pokitPro;
+        }
+        if (!serviceUuid.isNull()) {
+            createServiceObject();
+        }
+    }
 }
 
 /*!
@@ -585,21 +672,21 @@ StatusService::DeviceCharacteristics StatusServicePrivate::parseDeviceCharacteri
     };
     Q_ASSERT(characteristics.firmwareVersion.isNull());  // How we indicate failure.
 
-    if (!checkSize(u"Device Characteristics"_s, value, 20, 20)) {
+    constexpr int size = PokitCodec::Status::deviceCharacteristicsSize;
+    PokitCodec::Status::DeviceCharacteristics decoded{};
+    if ((!checkSize(u"Device Characteristics"_s, value, size, size)) ||
+        (!PokitCodec::Status::parseDeviceCharacteristics(CharacteristicLayout::toByteSpan(value), decoded))) {
         return characteristics;
     }
 
-    characteristics.firmwareVersion = QVersionNumber(
-                                          qFromLittleEndian<quint8 >(value.mid(0,1).constData()),
-                                          qFromLittleEndian<quint8 >(value.mid(1,1).constData()));
-    characteristics.maximumVoltage      = qFromLittleEndian<quint16>(value.mid(2,2).constData());
-    characteristics.maximumCurrent      = qFromLittleEndian<quint16>(value.mid(4,2).constData());
-    characteristics.maximumResistance   = qFromLittleEndian<quint16>(value.mid(6,2).constData());
-    characteristics.maximumSamplingRate = qFromLittleEndian<quint16>(value.mid(8,2).constData());
-    characteristics.samplingBufferSize  = qFromLittleEndian<quint16>(value.mid(10,2).constData());
-    characteristics.capabilityMask      = qFromLittleEndian<quint16>(value.mid(12,2).constData());
-    characteristics.macAddress = QBluetoothAddress(qFromBigEndian<quint64>
-                                                   ((QByteArray(2, '\0') + value.mid(14,6)).constData()));
+    characteristics.firmwareVersion = QVersionNumber(decoded.firmwareMajor, decoded.firmwareMinor);
+    characteristics.maximumVoltage      = decoded.maximumVoltage;
+    characteristics.maximumCurrent      = decoded.maximumCurrent;
+    characteristics.maximumResistance   = decoded.maximumResistance;
+    characteristics.maximumSamplingRate = decoded.maximumSamplingRate;
+    characteristics.samplingBufferSize  = decoded.samplingBufferSize;
+    characteristics.capabilityMask      = decoded.capabilityMask;
+    characteristics.macAddress = QBluetoothAddress(decoded.macAddress);
 
     qCDebug(lc).noquote() << tr("Firmware version:     ") << characteristics.firmwareVersion;
     qCDebug(lc).noquote() << tr("Maximum voltage:      ") << characteristics.maximumVoltage;
@@ -638,20 +725,22 @@ StatusService::Status StatusServicePrivate::parseStatus(const QByteArray &value)
      * the device's current charging status.
      */
 
-    if (!checkSize(u"Status"_s, value, 5, 8)) {
+    PokitCodec::Status::Status decoded{};
+    if ((!checkSize(u"Status"_s, value, PokitCodec::Status::minimumStatusSize, PokitCodec::Status::maximumStatusSize))
+        || (!PokitCodec::Status::parseStatus(CharacteristicLayout::toByteSpan(value), decoded))) {
         return status;
     }
 
-    status.deviceStatus = static_cast<StatusService::DeviceStatus>(value.at(0));
-    status.batteryVoltage = qFromLittleEndian<float>(value.mid(1,4).constData());
-    if (value.size() >= 6) { // Battery Status added to Pokit API docs v1.00.
-        status.batteryStatus = static_cast<StatusService::BatteryStatus>(value.at(5));
+    status.deviceStatus = static_cast<StatusService::DeviceStatus>(decoded.deviceStatus);
+    status.batteryVoltage = decoded.batteryVoltage;
+    if (decoded.batteryStatus) { // Battery Status added to Pokit API docs v1.00.
+        status.batteryStatus = static_cast<StatusService::BatteryStatus>(*decoded.batteryStatus);
     }
-    if (value.size() >= 7) { // Switch Position - as yet, undocumented by Pokit Innovations.
-        status.switchPosition = static_cast<StatusService::SwitchPosition>(value.at(6));
+    if (decoded.switchPosition) { // Switch Position - as yet, undocumented.
+        status.switchPosition = static_cast<StatusService::SwitchPosition>(*decoded.switchPosition);
     }
-    if (value.size() >= 8) { // Charging Status - as yet, undocumented by Pokit Innovations.
-        status.chargingStatus = static_cast<StatusService::ChargingStatus>(value.at(7));
+    if (decoded.chargingStatus) { // Charging Status - as yet, undocumented.
+        status.chargingStatus = static_cast<StatusService::ChargingStatus>(*decoded.chargingStatus);
     }
     qCDebug(lc).noquote() << tr("Device status:   %1 (%2)")
         .arg((quint8)status.deviceStatus).arg(StatusService::toString(status.deviceStatus));
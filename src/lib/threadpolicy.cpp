@@ -0,0 +1,261 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the ThreadPolicy class.
+ */
+
+#include <qtpokit/threadpolicy.h>
+#include "../stringliterals_p.h"
+
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#elif defined(Q_OS_UNIX)
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#if defined(Q_OS_LINUX)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/*!
+ * \class ThreadPolicy
+ *
+ * The ThreadPolicy class pins threads to chosen CPUs, and requests elevated (or real-time) scheduling priority for
+ * them, where the OS allows it, so that latency-sensitive threads (such as a PokitDevice's BLE worker thread) are not
+ * delayed by other workloads on busy hosts.
+ *
+ * Settings are applied to the calling thread, so are typically applied by the thread itself, as it starts (see
+ * PokitDevice::setThreadPolicy(), for example). Settings the OS refuses (such as real-time scheduling, without the
+ * necessary privileges) are not fatal: the thread continues with its existing settings, and the reason is reported
+ * via State::errors, alongside the thread's effective settings.
+ *
+ * Platform support varies:
+ * * Linux supports CPU affinity, real-time (`SCHED_FIFO`) scheduling, which typically requires `CAP_SYS_NICE` (or a
+ *   sufficient `RLIMIT_RTPRIO`), and high priority via negative (per-thread) nice values, which typically requires
+ *   `CAP_SYS_NICE` (or a sufficient `RLIMIT_NICE`).
+ * * Other POSIX systems (such as macOS) support real-time (`SCHED_FIFO`) scheduling, and high priority via the
+ *   highest `SCHED_OTHER` priority, but not CPU affinity.
+ * * Windows supports CPU affinity (for the first 64 CPUs), and high (`THREAD_PRIORITY_HIGHEST`) and real-time
+ *   (`THREAD_PRIORITY_TIME_CRITICAL`) priorities.
+ */
+
+/// Returns \a priority as a (non-translated) string, suitable for machine-readable output.
+QString ThreadPolicy::toString(const Priority priority)
+{
+    switch (priority) {
+    case Priority::Normal:   return u"normal"_s;
+    case Priority::High:     return u"high"_s;
+    case Priority::Realtime: return u"realtime"_s;
+    }
+    return QString();
+}
+
+/*!
+ * Applies \a settings to the calling thread, and returns the thread's resulting effective settings, including the
+ * reasons for any settings that could not be applied.
+ *
+ * An empty Settings::cpus leaves the thread's CPU affinity unchanged, as does Priority::Normal the thread's priority.
+ */
+ThreadPolicy::State ThreadPolicy::apply(const Settings &settings)
+{
+    QStringList errors;
+    QVector<int> pinnedCpus; // Only for platforms that can't report threads' CPU affinities.
+
+    if (!settings.cpus.isEmpty()) {
+        #if defined(Q_OS_LINUX)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int cpu: settings.cpus) {
+            if ((cpu >= 0) && (cpu < CPU_SETSIZE)) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); error != 0) {
+            errors.append(tr("Failed to pin thread to CPUs %1: %2").arg(formatCpus(settings.cpus),
+                qt_error_string(error)));
+        }
+        #elif defined(Q_OS_WIN)
+        DWORD_PTR mask = 0;
+        for (const int cpu: settings.cpus) {
+            if ((cpu >= 0) && (cpu < (int)(sizeof(mask) * 8))) {
+                mask |= (DWORD_PTR)1 << cpu;
+            }
+        }
+        if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+            errors.append(tr("Failed to pin thread to CPUs %1: %2").arg(formatCpus(settings.cpus),
+                qt_error_string()));
+        } else {
+            pinnedCpus = settings.cpus;
+        }
+        #else
+        errors.append(tr("Pinning threads to CPUs is not supported on this platform."));
+        #endif
+    }
+
+    switch (settings.priority) {
+    case Priority::Normal:
+        break;
+    case Priority::High: {
+        #if defined(Q_OS_LINUX)
+        // Linux's nice values are per-thread, when given a thread ID.
+        if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), -10) != 0) {
+            errors.append(tr("Failed to set high thread priority: %1").arg(qt_error_string(errno)));
+        }
+        #elif defined(Q_OS_WIN)
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST)) {
+            errors.append(tr("Failed to set high thread priority: %1").arg(qt_error_string()));
+        }
+        #elif defined(Q_OS_UNIX)
+        sched_param param{};
+        param.sched_priority = sched_get_priority_max(SCHED_OTHER);
+        if (const int error = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param); error != 0) {
+            errors.append(tr("Failed to set high thread priority: %1").arg(qt_error_string(error)));
+        }
+        #else
+        errors.append(tr("Thread priorities are not supported on this platform."));
+        #endif
+    }   break;
+    case Priority::Realtime: {
+        #if defined(Q_OS_WIN)
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+            errors.append(tr("Failed to set real-time thread priority: %1").arg(qt_error_string()));
+        }
+        #elif defined(Q_OS_UNIX)
+        sched_param param{};
+        param.sched_priority = std::clamp(settings.realtimePriority, sched_get_priority_min(SCHED_FIFO),
+                                          sched_get_priority_max(SCHED_FIFO));
+        if (const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param); error != 0) {
+            errors.append(tr("Failed to set real-time thread priority %1: %2").arg(param.sched_priority)
+                .arg(qt_error_string(error)));
+        }
+        #else
+        errors.append(tr("Thread priorities are not supported on this platform."));
+        #endif
+    }   break;
+    }
+
+    State state = current();
+    state.applied = true;
+    state.errors = errors;
+    if (state.cpus.isEmpty()) {
+        state.cpus = pinnedCpus;
+    }
+    return state;
+}
+
+/*!
+ * Returns the calling thread's effective settings, as far as the OS reports them. State::applied is always \c false,
+ * and State::cpus is empty wherever the OS does not report threads' CPU affinities (such as Windows, and macOS).
+ */
+ThreadPolicy::State ThreadPolicy::current()
+{
+    State state;
+
+    #if defined(Q_OS_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                state.cpus.append(cpu);
+            }
+        }
+    }
+    #endif
+
+    #if defined(Q_OS_WIN)
+    const int priority = GetThreadPriority(GetCurrentThread());
+    if (priority == THREAD_PRIORITY_TIME_CRITICAL) {
+        state.priority = Priority::Realtime;
+    } else if ((priority != THREAD_PRIORITY_ERROR_RETURN) && (priority > THREAD_PRIORITY_NORMAL)) {
+        state.priority = Priority::High;
+    }
+    #elif defined(Q_OS_UNIX)
+    int policy = SCHED_OTHER;
+    sched_param param{};
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+        if ((policy == SCHED_FIFO) || (policy == SCHED_RR)) {
+            state.priority = Priority::Realtime;
+            state.realtimePriority = param.sched_priority;
+        }
+        #if !defined(Q_OS_LINUX)
+        else if ((policy == SCHED_OTHER) && (param.sched_priority > sched_get_priority_min(SCHED_OTHER))
+              && (param.sched_priority == sched_get_priority_max(SCHED_OTHER))) {
+            state.priority = Priority::High;
+        }
+        #endif
+    }
+    #if defined(Q_OS_LINUX)
+    if (state.priority == Priority::Normal) {
+        errno = 0;
+        if (const int nice = getpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid)); (errno == 0) && (nice < 0)) {
+            state.priority = Priority::High;
+        }
+    }
+    #endif
+    #endif
+    return state;
+}
+
+/*!
+ * Returns the CPUs in \a list, a comma-separated list of CPU indexes and (inclusive) ranges, such as `0,2-3`, sorted
+ * and without duplicates. If \a ok is not \c nullptr, it is set to \c false if \a list is empty, or invalid.
+ */
+QVector<int> ThreadPolicy::parseCpus(const QString &list, bool * const ok)
+{
+    QVector<int> cpus;
+    bool valid = !list.trimmed().isEmpty();
+    for (const QString &item: list.split(u',')) {
+        const QStringList bounds = item.split(u'-');
+        bool firstOk = false, lastOk = false;
+        const int first = bounds.constFirst().trimmed().toInt(&firstOk);
+        const int last = bounds.constLast().trimmed().toInt(&lastOk);
+        if ((bounds.size() > 2) || (!firstOk) || (!lastOk) || (first < 0) || (last < first) || (last > 4095)) {
+            valid = false;
+            break;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.append(cpu);
+        }
+    }
+    if (ok != nullptr) {
+        *ok = valid;
+    }
+    if (!valid) {
+        return { };
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+/*!
+ * Returns \a cpus as a comma-separated list, with consecutive CPUs collapsed into ranges, such as `0,2-3`. This is the
+ * inverse of parseCpus(), for sorted lists without duplicates.
+ */
+QString ThreadPolicy::formatCpus(const QVector<int> &cpus)
+{
+    QStringList items;
+    for (qsizetype index = 0; index < cpus.size();) {
+        qsizetype end = index + 1;
+        while ((end < cpus.size()) && (cpus.at(end) == cpus.at(end - 1) + 1)) {
+            ++end;
+        }
+        items.append((end - index == 1) ? QString::number(cpus.at(index))
+            : u"%1-%2"_s.arg(cpus.at(index)).arg(cpus.at(end - 1)));
+        index = end;
+    }
+    return items.join(u',');
+}
+
+QTPOKIT_END_NAMESPACE
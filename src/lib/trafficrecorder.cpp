@@ -0,0 +1,306 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the TrafficRecorder and TrafficRecorderPrivate classes.
+ */
+
+#include <qtpokit/trafficrecorder.h>
+#include "trafficrecorder_p.h"
+#include "abstractpokitservice_p.h"
+
+#include <QDataStream>
+
+#include <algorithm>
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class TrafficRecorder
+ *
+ * The TrafficRecorder class records the raw characteristic traffic of one or more services, to a compact binary file,
+ * so that a field session can later be reproduced at the desk (or used as a realistic benchmark corpus) via
+ * TrafficReplayer.
+ *
+ * Every characteristic value read, written (once acknowledged), or notified by each added service is recorded, with
+ * its UUID, raw bytes, and host (steady clock) timestamp, before being parsed. So a recording captures even values the
+ * services fail to parse.
+ *
+ * All values are little-endian. A recording consists of:
+ *
+ * 1. an 8-byte file header: the magic bytes `DOKT`, followed by a `uint32` format version (currently `1`); and
+ * 2. one record per operation, each consisting of a `uint8` Operation, a `uint8` characteristic index, the
+ *    characteristic's 16-byte UUID (in RFC 4122 byte order, only if the index is the number of characteristics
+ *    defined by earlier records, so each UUID is written just once), a `uint32` number of microseconds since the
+ *    previous record (or `0` for the first record), a `uint16` value size in bytes, and then the value itself.
+ *
+ * So most records cost just 8 bytes, plus their value. Records are appended as they happen, so a recording cut short
+ * (for example, by a crash) is still readable up to its last complete record.
+ *
+ * Services may live in other threads (see PokitDevice), since records are written under a mutex. However, services
+ * should be added before they begin receiving values.
+ *
+ * \see TrafficReplayer
+ */
+
+/*!
+ * Returns \a operation as a user presentable string.
+ */
+QString TrafficRecorder::toString(const Operation operation)
+{
+    switch (operation) {
+    case Operation::Read:   return tr("Read");
+    case Operation::Write:  return tr("Write");
+    case Operation::Notify: return tr("Notify");
+    }
+    return QString();
+}
+
+/*!
+ * Constructs a new TrafficRecorder object that records to \a fileName, with \a parent.
+ *
+ * Recording does not begin until start() is invoked.
+ */
+TrafficRecorder::TrafficRecorder(const QString &fileName, QObject * parent)
+    : QObject(parent), d_ptr(new TrafficRecorderPrivate(this))
+{
+    Q_D(TrafficRecorder);
+    d->file.setFileName(fileName);
+}
+
+/*!
+ * \cond internal
+ * Constructs a new TrafficRecorder object with \a fileName, \a parent, and private implementation \a d.
+ */
+TrafficRecorder::TrafficRecorder(
+    TrafficRecorderPrivate * const d, const QString &fileName, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->file.setFileName(fileName);
+}
+/// \endcond
+
+/*!
+ * Destroys this TrafficRecorder object, stopping (and so flushing) the recording first, if recording.
+ */
+TrafficRecorder::~TrafficRecorder()
+{
+    Q_D(TrafficRecorder);
+    stop();
+    for (AbstractPokitService * const service: d->services) {
+        if (service) {
+            TrafficRecorderPrivate::servicePrivate(service)->trafficHandler = nullptr;
+        }
+    }
+    delete d_ptr;
+}
+
+/*!
+ * Returns the name of the file traffic is recorded to.
+ */
+QString TrafficRecorder::fileName() const
+{
+    Q_D(const TrafficRecorder);
+    return d->file.fileName();
+}
+
+/*!
+ * Records \a service's characteristic traffic (while recording), in place of any other recorder.
+ */
+void TrafficRecorder::addService(AbstractPokitService * const service)
+{
+    Q_D(TrafficRecorder);
+    if ((service == nullptr) || (d->services.contains(service))) {
+        return;
+    }
+    d->services.append(service);
+    TrafficRecorderPrivate::servicePrivate(service)->trafficHandler = [d](
+        const Operation operation, const QBluetoothUuid &uuid, const QByteArray &value, const qint64 timestamp) {
+        d->record(operation, uuid, value, timestamp);
+    };
+}
+
+/*!
+ * Stops recording \a service's characteristic traffic.
+ */
+void TrafficRecorder::removeService(AbstractPokitService * const service)
+{
+    Q_D(TrafficRecorder);
+    if ((service == nullptr) || (!d->services.removeOne(service))) {
+        return;
+    }
+    TrafficRecorderPrivate::servicePrivate(service)->trafficHandler = nullptr;
+}
+
+/*!
+ * Returns \c true if traffic is being recorded, otherwise \c false.
+ */
+bool TrafficRecorder::isRecording() const
+{
+    Q_D(const TrafficRecorder);
+    const QMutexLocker scopedLock(&d->mutex);
+    return d->recording;
+}
+
+/*!
+ * Returns the number of records written since recording last started.
+ */
+quint64 TrafficRecorder::recordCount() const
+{
+    Q_D(const TrafficRecorder);
+    const QMutexLocker scopedLock(&d->mutex);
+    return d->recordCount;
+}
+
+/*!
+ * Starts recording, replacing any existing file, by writing the recording's file header.
+ *
+ * Returns \c true if recording started (or was already recording), otherwise \c false.
+ */
+bool TrafficRecorder::start()
+{
+    Q_D(TrafficRecorder);
+    const QMutexLocker scopedLock(&d->mutex);
+    if (d->recording) {
+        return true;
+    }
+    if (!d->file.open(QIODevice::WriteOnly|QIODevice::Truncate)) {
+        qCWarning(d->lc).noquote() << tr("Failed to open recording %1: %2")
+            .arg(d->file.fileName(), d->file.errorString());
+        return false;
+    }
+
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(TrafficRecorderPrivate::fileMagic, sizeof(TrafficRecorderPrivate::fileMagic));
+    stream << TrafficRecorderPrivate::version;
+    Q_ASSERT(header.size() == TrafficRecorderPrivate::fileHeaderSize);
+    if (d->file.write(header) != header.size()) {
+        qCWarning(d->lc).noquote() << tr("Failed to write recording %1: %2")
+            .arg(d->file.fileName(), d->file.errorString());
+        d->file.close();
+        return false;
+    }
+
+    qCDebug(d->lc).noquote() << tr("Recording traffic to %1.").arg(d->file.fileName());
+    d->characteristics.clear();
+    d->firstTimestamp = -1;
+    d->lastOffset = 0;
+    d->recordCount = 0;
+    d->recording = true;
+    return true;
+}
+
+/*!
+ * Stops recording, flushing and closing the recording file. Does nothing if not recording.
+ */
+void TrafficRecorder::stop()
+{
+    Q_D(TrafficRecorder);
+    const QMutexLocker scopedLock(&d->mutex);
+    if (!d->recording) {
+        return;
+    }
+    d->recording = false;
+    d->file.close();
+    qCDebug(d->lc).noquote() << tr("Recorded %Ln record/s to %1.", nullptr, (int)d->recordCount)
+        .arg(d->file.fileName());
+}
+
+/*!
+ * \cond internal
+ * \class TrafficRecorderPrivate
+ *
+ * The TrafficRecorderPrivate class provides private implementation for TrafficRecorder.
+ */
+
+/*!
+ * \internal
+ * Constructs a new TrafficRecorderPrivate object with public implementation \a q.
+ */
+TrafficRecorderPrivate::TrafficRecorderPrivate(TrafficRecorder * const q) : q_ptr(q)
+{
+
+}
+
+/*!
+ * Returns \a service's private implementation.
+ */
+AbstractPokitServicePrivate * TrafficRecorderPrivate::servicePrivate(AbstractPokitService * const service)
+{
+    return service->d_ptr;
+}
+
+/*!
+ * Returns \a operation's \a value for characteristic \a uuid, at steady clock \a timestamp (in nanoseconds), encoded
+ * as a single record, defining \a uuid first (in #characteristics) if not already defined.
+ *
+ * Returns an empty byte array if \a uuid cannot be defined, since #maxCharacteristics are already defined. Values
+ * longer than 65535 bytes (far beyond any BLE characteristic) are truncated.
+ */
+QByteArray TrafficRecorderPrivate::encodeRecord(const TrafficRecorder::Operation operation,
+                                                const QBluetoothUuid &uuid, const QByteArray &value,
+                                                const qint64 timestamp)
+{
+    qsizetype index = characteristics.indexOf(uuid);
+    if ((index < 0) && (characteristics.size() >= maxCharacteristics)) {
+        qCWarning(lc).noquote() << tr("Too many characteristics to record: %1").arg(uuid.toString());
+        return QByteArray();
+    }
+    const bool define = (index < 0);
+    if (define) {
+        index = characteristics.size();
+        characteristics.append(uuid);
+    }
+
+    if (firstTimestamp < 0) {
+        firstTimestamp = timestamp;
+    }
+    const qint64 offset = std::max<qint64>((timestamp - firstTimestamp) / 1000, lastOffset);
+    const quint32 delta = (quint32)std::min<qint64>(offset - lastOffset, std::numeric_limits<quint32>::max());
+    lastOffset += delta;
+
+    const int size = std::min<int>((int)value.size(), std::numeric_limits<quint16>::max());
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << (quint8)operation << (quint8)index;
+    if (define) {
+        const QByteArray bytes = uuid.toRfc4122();
+        stream.writeRawData(bytes.constData(), (int)bytes.size());
+    }
+    stream << delta << (quint16)size;
+    stream.writeRawData(value.constData(), size);
+    return record;
+}
+
+/*!
+ * Appends \a operation's \a value for characteristic \a uuid, at steady clock \a timestamp (in nanoseconds), to the
+ * recording file, if recording. Called by each added service, on the service's own thread.
+ */
+void TrafficRecorderPrivate::record(const TrafficRecorder::Operation operation, const QBluetoothUuid &uuid,
+                                    const QByteArray &value, const qint64 timestamp)
+{
+    const QMutexLocker scopedLock(&mutex);
+    if (!recording) {
+        return;
+    }
+    const QByteArray record = encodeRecord(operation, uuid, value, timestamp);
+    if (record.isEmpty()) {
+        return;
+    }
+    if (file.write(record) != record.size()) {
+        qCWarning(lc).noquote() << tr("Failed to write recording %1: %2").arg(file.fileName(), file.errorString());
+        recording = false;
+        file.close();
+        return;
+    }
+    ++recordCount;
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
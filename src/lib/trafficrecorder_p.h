@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the TrafficRecorderPrivate class.
+ */
+
+#ifndef QTPOKIT_TRAFFICRECORDER_P_H
+#define QTPOKIT_TRAFFICRECORDER_P_H
+
+#include <qtpokit/trafficrecorder.h>
+#include <qtpokit/abstractpokitservice.h>
+
+#include <QFile>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class AbstractPokitServicePrivate;
+
+class QTPOKIT_EXPORT TrafficRecorderPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.traffic.recorder", QtInfoMsg); ///< Logging category.
+
+    static constexpr char fileMagic[4] { 'D', 'O', 'K', 'T' }; ///< Magic bytes at the start of a recording.
+    static constexpr quint32 version { 1 };       ///< Recording format version written by this implementation.
+    static constexpr qint64 fileHeaderSize { 8 }; ///< Size of the recording's file header, in bytes.
+    static constexpr int maxCharacteristics { 255 }; ///< Maximum number of distinct characteristics per recording.
+
+    QFile file;                              ///< Recording file, while recording.
+    QVector<QPointer<AbstractPokitService>> services; ///< Services whose traffic is recorded.
+    QVector<QBluetoothUuid> characteristics; ///< Characteristics defined so far, by record characteristic index.
+    qint64 firstTimestamp { -1 };            ///< Steady clock time of the first record, in ns, or -1 if none yet.
+    qint64 lastOffset { 0 };                 ///< Time of the last record, in microseconds since the first record.
+    quint64 recordCount { 0 };               ///< Number of records written since recording started.
+    bool recording { false };                ///< Whether traffic is being recorded.
+    mutable QMutex mutex;                    ///< Mutex for protecting access to the above, from service threads.
+
+    explicit TrafficRecorderPrivate(TrafficRecorder * const q);
+
+    static AbstractPokitServicePrivate * servicePrivate(AbstractPokitService * const service);
+
+    QByteArray encodeRecord(const TrafficRecorder::Operation operation, const QBluetoothUuid &uuid,
+                            const QByteArray &value, const qint64 timestamp);
+    void record(const TrafficRecorder::Operation operation, const QBluetoothUuid &uuid,
+                const QByteArray &value, const qint64 timestamp);
+
+protected:
+    TrafficRecorder * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(TrafficRecorder)
+    Q_DISABLE_COPY(TrafficRecorderPrivate)
+    QTPOKIT_BEFRIEND_TEST(TrafficRecorder)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_TRAFFICRECORDER_P_H
@@ -0,0 +1,415 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Defines the TrafficReplayer and TrafficReplayerPrivate classes.
+ */
+
+#include <qtpokit/trafficreplayer.h>
+#include "trafficreplayer_p.h"
+#include "trafficrecorder_p.h"
+
+#include <qtpokit/pokitdevice.h>
+
+#include <QFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/*!
+ * \class TrafficReplayer
+ *
+ * The TrafficReplayer class replays characteristic traffic recorded by TrafficRecorder, through one or more services'
+ * normal parsing, and signals, so that a recorded field session can be reproduced without the device, or any
+ * Bluetooth hardware at all.
+ *
+ * Once started, the replayer acknowledges each added service's GATT requests (in place of the services'
+ * QLowEnergyService objects), emits each service's serviceDetailsDiscovered signal, as if the device had just
+ * connected, and then delivers each recorded read and notification to the first added service that handles the
+ * record's characteristic. Records are delivered either at their recorded times, or as fast as possible (see
+ * setPacing()), the latter making recordings a realistic benchmark corpus for the parsers, and output stages.
+ *
+ * Recorded writes are skipped, since they were sent by the host, not the device. Likewise, values of characteristics
+ * that no added service notifies (such as one-off reads of device information) are skipped, since services only
+ * handle those via their QLowEnergyService objects. Both are counted by skippedCount().
+ *
+ * The replayer must live in the same thread as its services.
+ *
+ * \see TrafficRecorder
+ */
+
+/*!
+ * Constructs a new TrafficReplayer object that replays \a fileName, with \a parent.
+ */
+TrafficReplayer::TrafficReplayer(const QString &fileName, QObject * parent)
+    : QObject(parent), d_ptr(new TrafficReplayerPrivate(this))
+{
+    Q_D(TrafficReplayer);
+    d->fileName = fileName;
+}
+
+/*!
+ * \cond internal
+ * Constructs a new TrafficReplayer object with \a fileName, \a parent, and private implementation \a d.
+ */
+TrafficReplayer::TrafficReplayer(
+    TrafficReplayerPrivate * const d, const QString &fileName, QObject * const parent)
+    : QObject(parent), d_ptr(d)
+{
+    d->fileName = fileName;
+}
+/// \endcond
+
+/*!
+ * Destroys this TrafficReplayer object, stopping the replay first, if replaying.
+ */
+TrafficReplayer::~TrafficReplayer()
+{
+    stop();
+    delete d_ptr;
+}
+
+/*!
+ * Returns the name of the recording file replayed.
+ */
+QString TrafficReplayer::fileName() const
+{
+    Q_D(const TrafficReplayer);
+    return d->fileName;
+}
+
+/*!
+ * Loads the recording's records, replacing any loaded previously. start() loads the records first, if not already
+ * loaded.
+ *
+ * Returns \c true if the recording was loaded, otherwise \c false.
+ */
+bool TrafficReplayer::load()
+{
+    Q_D(TrafficReplayer);
+    QFile file(d->fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(d->lc).noquote() << tr("Failed to open recording %1: %2").arg(file.fileName(), file.errorString());
+        return false;
+    }
+    const std::optional<QVector<TrafficRecorder::Record>> records = d->parseRecords(file.readAll());
+    if (!records) {
+        qCWarning(d->lc).noquote() << tr("Failed to read recording %1").arg(file.fileName());
+        return false;
+    }
+    qCDebug(d->lc).noquote() << tr("Loaded %Ln record/s from %1.", nullptr, (int)records->size())
+        .arg(file.fileName());
+    d->records = *records;
+    d->loaded = true;
+    return true;
+}
+
+/*!
+ * Returns the records loaded by load(), if any.
+ */
+QVector<TrafficRecorder::Record> TrafficReplayer::records() const
+{
+    Q_D(const TrafficReplayer);
+    return d->records;
+}
+
+/*!
+ * Replays records through \a service, as well as any services added previously.
+ */
+void TrafficReplayer::addService(AbstractPokitService * const service)
+{
+    Q_D(TrafficReplayer);
+    if ((service != nullptr) && (!d->services.contains(service))) {
+        d->services.append(service);
+    }
+}
+
+/*!
+ * Stops replaying records through \a service. This should not be done while replaying.
+ */
+void TrafficReplayer::removeService(AbstractPokitService * const service)
+{
+    Q_D(TrafficReplayer);
+    d->services.removeOne(service);
+}
+
+/*!
+ * Returns the pacing of replayed records.
+ */
+TrafficReplayer::Pacing TrafficReplayer::pacing() const
+{
+    Q_D(const TrafficReplayer);
+    return d->pacing;
+}
+
+/*!
+ * Sets the pacing of replayed records to \a pacing. The default is Pacing::Recorded.
+ */
+void TrafficReplayer::setPacing(const Pacing pacing)
+{
+    Q_D(TrafficReplayer);
+    d->pacing = pacing;
+}
+
+/*!
+ * Returns \c true if records are being replayed, otherwise \c false.
+ */
+bool TrafficReplayer::isReplaying() const
+{
+    Q_D(const TrafficReplayer);
+    return d->replaying;
+}
+
+/*!
+ * Returns the number of records replayed since replaying last started.
+ */
+quint64 TrafficReplayer::replayedCount() const
+{
+    Q_D(const TrafficReplayer);
+    return d->replayed;
+}
+
+/*!
+ * Returns the number of records skipped (such as writes) since replaying last started.
+ */
+quint64 TrafficReplayer::skippedCount() const
+{
+    Q_D(const TrafficReplayer);
+    return d->skipped;
+}
+
+/*!
+ * Starts replaying records, from the first, by handling the added services' requests, (asynchronously) emitting each
+ * service's serviceDetailsDiscovered signal, and then delivering records according to pacing().
+ *
+ * Returns \c true if replaying started (or was already replaying), otherwise \c false.
+ */
+bool TrafficReplayer::start()
+{
+    Q_D(TrafficReplayer);
+    if (d->replaying) {
+        return true;
+    }
+    if ((!d->loaded) && (!load())) {
+        return false;
+    }
+    qCInfo(d->lc).noquote() << tr("Replaying %Ln record/s from %1.", nullptr, (int)d->records.size())
+        .arg(d->fileName);
+    d->replaying = true;
+    d->next = 0;
+    d->replayed = 0;
+    d->skipped = 0;
+    for (const QPointer<AbstractPokitService> &service: d->services) {
+        if (!service) {
+            continue;
+        }
+        TrafficReplayerPrivate::servicePrivate(service)->requestHandler =
+            [d, service](const AbstractPokitServicePrivate::Request &request) {
+                d->handleRequest(service, request);
+            };
+        QTimer::singleShot(0, service.data(), [service]() { Q_EMIT service->serviceDetailsDiscovered(); });
+    }
+    d->clock.start();
+    d->timer.start(0);
+    return true;
+}
+
+/*!
+ * Stops replaying records. Any in-flight requests are finished as failures, since they will never be acknowledged
+ * now, while later requests are issued to the services' QLowEnergyService objects (if any) as usual.
+ */
+void TrafficReplayer::stop()
+{
+    Q_D(TrafficReplayer);
+    if (!d->replaying) {
+        return;
+    }
+    d->timer.stop();
+    d->replaying = false;
+    for (AbstractPokitService * const service: d->services) {
+        if (!service) {
+            continue;
+        }
+        AbstractPokitServicePrivate * const serviceImpl = TrafficReplayerPrivate::servicePrivate(service);
+        serviceImpl->requestHandler = nullptr;
+        if (serviceImpl->inFlight) {
+            serviceImpl->finishRequest(false);
+        }
+    }
+}
+
+/*!
+ * \fn TrafficReplayer::finished
+ *
+ * This signal is emitted when all records have been replayed.
+ */
+
+/*!
+ * \cond internal
+ * \class TrafficReplayerPrivate
+ *
+ * The TrafficReplayerPrivate class provides private implementation for TrafficReplayer.
+ */
+
+/*!
+ * \internal
+ * Constructs a new TrafficReplayerPrivate object with public implementation \a q.
+ */
+TrafficReplayerPrivate::TrafficReplayerPrivate(TrafficReplayer * const q) : q_ptr(q)
+{
+    timer.setSingleShot(true); // Restarted by each tick, until all records have been replayed.
+    connect(&timer, &QTimer::timeout, this, &TrafficReplayerPrivate::tick);
+}
+
+/*!
+ * Returns \a service's private implementation.
+ */
+AbstractPokitServicePrivate * TrafficReplayerPrivate::servicePrivate(AbstractPokitService * const service)
+{
+    return service->d_ptr;
+}
+
+/*!
+ * Parses recording \a data (see TrafficRecorder for the format), returning its records, with timestamps relative to
+ * the first record.
+ *
+ * A recording that ends with an incomplete record, such as one cut short by a crash, yields all records before it.
+ * Returns `std::nullopt` if \a data is not a supported recording, or contains a corrupt record.
+ */
+std::optional<QVector<TrafficRecorder::Record>> TrafficReplayerPrivate::parseRecords(const QByteArray &data)
+{
+    const uchar * const bytes = reinterpret_cast<const uchar *>(data.constData());
+    if ((data.size() < TrafficRecorderPrivate::fileHeaderSize) ||
+        (std::memcmp(bytes, TrafficRecorderPrivate::fileMagic, sizeof(TrafficRecorderPrivate::fileMagic)) != 0)) {
+        qCWarning(lc).noquote() << tr("Not a traffic recording.");
+        return std::nullopt;
+    }
+    if (const quint32 fileVersion = qFromLittleEndian<quint32>(bytes + 4);
+        fileVersion != TrafficRecorderPrivate::version) {
+        qCWarning(lc).noquote() << tr("Unsupported recording version: %1").arg(fileVersion);
+        return std::nullopt;
+    }
+
+    QVector<TrafficRecorder::Record> records;
+    QVector<QBluetoothUuid> characteristics;
+    qint64 timestamp = 0;
+    for (qint64 offset = TrafficRecorderPrivate::fileHeaderSize; offset < data.size();) {
+        const qint64 remaining = data.size() - offset;
+        if (remaining < 2) {
+            qCWarning(lc).noquote() << tr("Ignoring incomplete record at offset %1").arg(offset);
+            break;
+        }
+        const quint8 operation = bytes[offset];
+        const quint8 index = bytes[offset + 1];
+        if ((operation > (quint8)TrafficRecorder::Operation::Notify) || (index > characteristics.size())) {
+            qCWarning(lc).noquote() << tr("Invalid record at offset %1").arg(offset);
+            return std::nullopt;
+        }
+        const bool define = (index == characteristics.size());
+        const qint64 headerSize = (define) ? 24 : 8;
+        if ((remaining < headerSize) ||
+            (remaining < headerSize + qFromLittleEndian<quint16>(bytes + offset + headerSize - 2))) {
+            qCWarning(lc).noquote() << tr("Ignoring incomplete record at offset %1").arg(offset);
+            break;
+        }
+        if (define) {
+            characteristics.append(QBluetoothUuid(QUuid::fromRfc4122(data.mid(offset + 2, 16))));
+        }
+        const quint32 delta = qFromLittleEndian<quint32>(bytes + offset + headerSize - 6);
+        const quint16 size = qFromLittleEndian<quint16>(bytes + offset + headerSize - 2);
+        timestamp += (qint64)delta * 1000;
+        records.append({ static_cast<TrafficRecorder::Operation>(operation), characteristics.at(index),
+                         data.mid(offset + headerSize, size), timestamp });
+        offset += headerSize + size;
+    }
+    return records;
+}
+
+/*!
+ * Handles \a request for \a service, by acknowledging it (asynchronously, as real devices do).
+ */
+void TrafficReplayerPrivate::handleRequest(const QPointer<AbstractPokitService> &service,
+                                           const AbstractPokitServicePrivate::Request &request)
+{
+    QTimer::singleShot(0, this, [service, request]() {
+        if (!service) {
+            return;
+        }
+        AbstractPokitServicePrivate * const serviceImpl = servicePrivate(service);
+        if ((!serviceImpl->requestHandler) || (!serviceImpl->inFlight) ||
+            (serviceImpl->inFlight->id != request.id)) {
+            return; // Stopped (and so already finished) in the meantime.
+        }
+        serviceImpl->finishRequest(true);
+    });
+}
+
+/*!
+ * Delivers \a record to the first service that handles its characteristic, and returns \c true, or returns \c false
+ * if \a record is a write, or no service handles its characteristic.
+ */
+bool TrafficReplayerPrivate::replay(const TrafficRecorder::Record &record)
+{
+    if (record.operation == TrafficRecorder::Operation::Write) {
+        return false;
+    }
+    for (AbstractPokitService * const service: services) {
+        if ((service) && (servicePrivate(service)->hasNotificationHandler(record.characteristic))) {
+            return servicePrivate(service)->simulateValue(record.characteristic, record.value);
+        }
+    }
+    qCDebug(lc).noquote() << tr(R"(No service handles recorded characteristic %1 "%2".)")
+        .arg(record.characteristic.toString(), PokitDevice::charcteristicToString(record.characteristic));
+    return false;
+}
+
+/*!
+ * Stops replaying (see TrafficReplayer::stop()), and emits TrafficReplayer::finished.
+ */
+void TrafficReplayerPrivate::finish()
+{
+    Q_Q(TrafficReplayer);
+    qCDebug(lc).noquote() << tr("Replayed %1 record/s, and skipped %2.").arg(replayed).arg(skipped);
+    q->stop();
+    Q_EMIT q->finished();
+}
+
+/*!
+ * Replays the next batch of records: up to #batchSize records, as fast as possible, or all records now due, at their
+ * recorded times. Then schedules the next batch, or finishes if all records have been replayed.
+ */
+void TrafficReplayerPrivate::tick()
+{
+    const bool paced = (pacing == TrafficReplayer::Pacing::Recorded);
+    const qint64 now = clock.nsecsElapsed();
+    for (int count = 0; (replaying) && (next < records.size()); ++count) {
+        const TrafficRecorder::Record &record = records.at(next);
+        if ((paced) ? (record.timestamp > now) : (count >= batchSize)) {
+            break;
+        }
+        ++next;
+        if (replay(record)) {
+            ++replayed;
+        } else {
+            ++skipped;
+        }
+    }
+
+    if (!replaying) {
+        return; // Stopped in the meantime, such as by a slot connected to a service's signal.
+    }
+    if (next >= records.size()) {
+        finish();
+        return;
+    }
+    const qint64 wait = (paced) ? (records.at(next).timestamp - clock.nsecsElapsed() + 999999) / 1000000 : 0;
+    timer.start((int)std::max<qint64>(wait, 0));
+}
+
+/// \endcond
+
+QTPOKIT_END_NAMESPACE
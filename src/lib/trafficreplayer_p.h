@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*!
+ * \file
+ * Declares the TrafficReplayerPrivate class.
+ */
+
+#ifndef QTPOKIT_TRAFFICREPLAYER_P_H
+#define QTPOKIT_TRAFFICREPLAYER_P_H
+
+#include <qtpokit/trafficreplayer.h>
+#include <qtpokit/abstractpokitservice.h>
+#include "abstractpokitservice_p.h"
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class QTPOKIT_EXPORT TrafficReplayerPrivate : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Q_LOGGING_CATEGORY(lc, "pokit.traffic.replayer", QtInfoMsg); ///< Logging category.
+
+    static constexpr int batchSize { 256 }; ///< Maximum records replayed per event loop pass, as fast as possible.
+
+    QString fileName;                           ///< Recording file to replay.
+    QVector<TrafficRecorder::Record> records;   ///< Records loaded from #fileName.
+    bool loaded { false };                      ///< Whether #records have been loaded.
+    QVector<QPointer<AbstractPokitService>> services; ///< Services to replay records through.
+    TrafficReplayer::Pacing pacing { TrafficReplayer::Pacing::Recorded }; ///< Pacing of replayed records.
+    bool replaying { false };                   ///< Whether records are being replayed.
+    qsizetype next { 0 };                       ///< Index of the next record to replay.
+    quint64 replayed { 0 };                     ///< Number of records replayed since replaying last started.
+    quint64 skipped { 0 };                      ///< Number of records skipped since replaying last started.
+    QElapsedTimer clock;                        ///< Time since replaying started.
+    QTimer timer;                               ///< Times the next batch of records.
+
+    explicit TrafficReplayerPrivate(TrafficReplayer * const q);
+
+    static AbstractPokitServicePrivate * servicePrivate(AbstractPokitService * const service);
+    static std::optional<QVector<TrafficRecorder::Record>> parseRecords(const QByteArray &data);
+
+    void handleRequest(const QPointer<AbstractPokitService> &service,
+                       const AbstractPokitServicePrivate::Request &request);
+    bool replay(const TrafficRecorder::Record &record);
+    void finish();
+
+public Q_SLOTS:
+    void tick();
+
+protected:
+    TrafficReplayer * q_ptr; ///< Internal q-pointer.
+
+private:
+    Q_DECLARE_PUBLIC(TrafficReplayer)
+    Q_DISABLE_COPY(TrafficReplayerPrivate)
+    QTPOKIT_BEFRIEND_TEST(TrafficReplayer)
+};
+
+QTPOKIT_END_NAMESPACE
+
+#endif // QTPOKIT_TRAFFICREPLAYER_P_H
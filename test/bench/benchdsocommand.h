@@ -0,0 +1,15 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class BenchDsoCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void outputSamples_data();
+    void outputSamples();
+};
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchencoders.h"
+
+#include <qtpokit/pokitmeter.h>
+
+#include "dataloggerservice_p.h"
+#include "dsoservice_p.h"
+#include "multimeterservice_p.h"
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void BenchEncoders::dsoEncodeSettings()
+{
+    const DsoService::Settings settings{
+        DsoService::Command::RisingEdgeTrigger, 1.5f, DsoService::Mode::DcVoltage,
+        +PokitMeter::VoltageRange::_12V, 100'000, 8192
+    };
+    QByteArray value;
+    QBENCHMARK {
+        value = DsoServicePrivate::encodeSettings(settings);
+    }
+    QCOMPARE(value.size(), 13);
+}
+
+void BenchEncoders::dataLoggerEncodeSettings_data()
+{
+    QTest::addColumn<bool>("updateIntervalIs32bit");
+    QTest::addRow("16-bit-interval") << false; // Pokit Meter.
+    QTest::addRow("32-bit-interval") << true;  // Pokit Pro.
+}
+
+void BenchEncoders::dataLoggerEncodeSettings()
+{
+    QFETCH(bool, updateIntervalIs32bit);
+    const DataLoggerService::Settings settings{
+        DataLoggerService::Command::Start, 0, DataLoggerService::Mode::DcVoltage,
+        +PokitMeter::VoltageRange::_12V, 60'000, 1653390313
+    };
+    QByteArray value;
+    QBENCHMARK {
+        value = DataLoggerServicePrivate::encodeSettings(settings, updateIntervalIs32bit);
+    }
+    QVERIFY(!value.isEmpty());
+}
+
+void BenchEncoders::multimeterEncodeSettings()
+{
+    const MultimeterService::Settings settings{
+        MultimeterService::Mode::AcVoltage, +PokitMeter::VoltageRange::_6V, 1000
+    };
+    QByteArray value;
+    QBENCHMARK {
+        value = MultimeterServicePrivate::encodeSettings(settings);
+    }
+    QCOMPARE(value, QByteArray("\x02\x02\xE8\x03\x00\x00", 6));
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(BenchEncoders))
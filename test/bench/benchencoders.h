@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class BenchEncoders : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void dsoEncodeSettings();
+
+    void dataLoggerEncodeSettings_data();
+    void dataLoggerEncodeSettings();
+
+    void multimeterEncodeSettings();
+};
+
+QTPOKIT_END_NAMESPACE
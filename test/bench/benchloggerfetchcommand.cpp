@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchloggerfetchcommand.h"
+#include "clibench.h"
+
+#include "loggerfetchcommand.h"
+
+#include <qtpokit/pokitmeter.h>
+#include <qtpokit/pokitproducts.h>
+
+#include <QElapsedTimer>
+#include <QLowEnergyController>
+
+// Each benchmark outputs a full (maximum length) synthetic logging session per iteration, in batches the size of one
+// notification's samples, to a null sink, so as to measure the CLI's formatting throughput, for each output format.
+
+void BenchLoggerFetchCommand::initTestCase()
+{
+    disableCommandLogging();
+}
+
+void BenchLoggerFetchCommand::outputSamples_data()
+{
+    // Batches of samples per notification, for the default ATT MTU, a Data Length Extension packet, and the maximum
+    // attribute length.
+    addOutputFormatRows({
+        AbstractCommand::OutputFormat::Csv,
+        AbstractCommand::OutputFormat::Json,
+        AbstractCommand::OutputFormat::Text,
+        AbstractCommand::OutputFormat::Binary,
+        AbstractCommand::OutputFormat::Ndjson,
+        AbstractCommand::OutputFormat::NdjsonEnvelope,
+        AbstractCommand::OutputFormat::Arrow,
+    }, { 10, 122, 256 });
+}
+
+void BenchLoggerFetchCommand::outputSamples()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(int, batchSize);
+
+    const DataLoggerService::Metadata metadata{ DataLoggerService::LoggerStatus::Done, 0.001f,
+        DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_12V, 1000, 6192, 1653390313 };
+    QVector<DataLoggerService::Samples> batches;
+    for (int first = 0; first < metadata.numberOfSamples; first += batchSize) {
+        DataLoggerService::Samples samples(qMin(batchSize, metadata.numberOfSamples - first));
+        for (int index = 0; index < samples.size(); ++index) {
+            samples[index] = (qint16)(((first + index) * 37) % 12000 - 6000); // A sawtooth, of varying widths.
+        }
+        batches.append(samples);
+    }
+
+    const NullOutputSink sink;
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()), &command);
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = format;
+    qint64 samples = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        command.metadataRead(metadata);
+        for (const DataLoggerService::Samples &batch: batches) {
+            command.outputSamples(batch);
+        }
+        samples += metadata.numberOfSamples;
+    }
+    reportOutputThroughput(samples, sink.bytes(), timer.nsecsElapsed());
+    QCOMPARE(command.samplesToGo, 0);
+}
+
+QTEST_MAIN(BenchLoggerFetchCommand)
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmetercommand.h"
+#include "clibench.h"
+
+#include "metercommand.h"
+
+#include <qtpokit/pokitmeter.h>
+#include <qtpokit/pokitproducts.h>
+
+#include <QElapsedTimer>
+#include <QLowEnergyController>
+
+// Each benchmark outputs a batch of synthetic readings per iteration, to a null sink, so as to measure the CLI's
+// formatting throughput, for each output format. Readings alternate between two ranges, as when auto-ranging.
+
+void BenchMeterCommand::initTestCase()
+{
+    disableCommandLogging();
+}
+
+void BenchMeterCommand::outputReading_data()
+{
+    addOutputFormatRows({
+        AbstractCommand::OutputFormat::Csv,
+        AbstractCommand::OutputFormat::Json,
+        AbstractCommand::OutputFormat::Text,
+        AbstractCommand::OutputFormat::Binary,
+        AbstractCommand::OutputFormat::Ndjson,
+        AbstractCommand::OutputFormat::Arrow,
+    }, { 1, 100 });
+}
+
+void BenchMeterCommand::outputReading()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(int, batchSize);
+
+    QVector<MultimeterService::Reading> readings(batchSize);
+    for (int index = 0; index < readings.size(); ++index) {
+        readings[index] = { MultimeterService::MeterStatus::AutoRangeOn, 1.0f + (float)index / 1000.0f,
+            MultimeterService::Mode::DcVoltage,
+            ((index % 2) == 0) ? +PokitMeter::VoltageRange::_2V : +PokitMeter::VoltageRange::_6V };
+    }
+
+    const NullOutputSink sink;
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()), &command);
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = format;
+    qint64 samples = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        for (const MultimeterService::Reading &reading: readings) {
+            command.outputReading(reading);
+        }
+        samples += readings.size();
+    }
+    reportOutputThroughput(samples, sink.bytes(), timer.nsecsElapsed());
+    QVERIFY(sink.bytes() > 0);
+}
+
+QTEST_MAIN(BenchMeterCommand)
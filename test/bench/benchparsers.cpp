@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchparsers.h"
+
+#include "dataloggerservice_p.h"
+#include "dsoservice_p.h"
+#include "multimeterservice_p.h"
+#include "statusservice_p.h"
+
+QTPOKIT_BEGIN_NAMESPACE
+
+// Adds a row for each realistic size of a samples characteristic value, of pseudo-random (but repeatable) samples.
+static void addSamplesRows()
+{
+    QTest::addColumn<QByteArray>("value");
+    for (const int size: { 20, 244, 512, 16384 }) {
+        QByteArray value(size, '\0');
+        quint32 state = 1;
+        for (char &byte: value) {
+            state = (state * 1103515245u) + 12345u; // Cheap LCG; the values themselves do not matter.
+            byte = (char)(state >> 24);
+        }
+        // 20 bytes fit the default 23-byte ATT MTU, 244 bytes a Data Length Extension packet, 512 bytes the maximum
+        // attribute length, and 16 KiB a whole 8192-sample DSO capture, as if delivered in one value.
+        QTest::addRow("%d-bytes", size) << value;
+    }
+}
+
+void BenchParsers::dsoParseMetadata_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addRow("PokitMeter")
+        << QByteArray("\x00\x98\xf7\x8b\x33\x02\x00\x40\x42\x0f\x00\x0a\x00\x0a\x00\x00\x00", 17);
+    QTest::addRow("PokitPro")
+        << QByteArray("\x00\xcc\xec\xba\x33\x02\x00\x40\x42\x0f\x00\xe8\x03\x0a\x00\x00\x00\x14\x00\x00\x00", 21);
+}
+
+void BenchParsers::dsoParseMetadata()
+{
+    QFETCH(QByteArray, value);
+    DsoService::Metadata metadata{};
+    QBENCHMARK {
+        metadata = DsoServicePrivate::parseMetadata(value);
+    }
+    QCOMPARE(metadata.status, DsoService::DsoStatus::Done);
+}
+
+void BenchParsers::dsoParseSamples_data()
+{
+    addSamplesRows();
+}
+
+void BenchParsers::dsoParseSamples()
+{
+    QFETCH(QByteArray, value);
+    DsoService::Samples samples;
+    QBENCHMARK {
+        samples = DsoServicePrivate::parseSamples(value);
+    }
+    QCOMPARE(samples.size(), value.size() / 2);
+}
+
+void BenchParsers::dataLoggerParseMetadata_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addRow("PokitMeter")
+        << QByteArray("\x00\x9f\x0f\x49\x37\x00\x04\x3c\x00\x00\x00\xe9\xbb\x8c\x62", 15);
+    QTest::addRow("PokitPro")
+        << QByteArray("\x00\x39\xf0\x45\x3c\x00\x04\x60\xea\x00\x00\x0d"
+                      "\x00\x00\x00\x30\x38\x00\x00\x43\xb9\x8c\x62", 23);
+}
+
+void BenchParsers::dataLoggerParseMetadata()
+{
+    QFETCH(QByteArray, value);
+    DataLoggerService::Metadata metadata{};
+    QBENCHMARK {
+        metadata = DataLoggerServicePrivate::parseMetadata(value);
+    }
+    QCOMPARE(metadata.status, DataLoggerService::LoggerStatus::Done);
+}
+
+void BenchParsers::dataLoggerParseSamples_data()
+{
+    addSamplesRows();
+}
+
+void BenchParsers::dataLoggerParseSamples()
+{
+    QFETCH(QByteArray, value);
+    DataLoggerService::Samples samples;
+    QBENCHMARK {
+        samples = DataLoggerServicePrivate::parseSamples(value);
+    }
+    QCOMPARE(samples.size(), value.size() / 2);
+}
+
+void BenchParsers::multimeterParseReading_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addRow("PokitMeter") << QByteArray("\x00\x00\x00\x00\x00\x01\x03", 7);
+    QTest::addRow("PokitPro") << QByteArray("\x00\x94\x89\xfa\x3b\x02\x00", 7);
+}
+
+void BenchParsers::multimeterParseReading()
+{
+    QFETCH(QByteArray, value);
+    MultimeterService::Reading reading{};
+    QBENCHMARK {
+        reading = MultimeterServicePrivate::parseReading(value);
+    }
+    QCOMPARE(reading.status, MultimeterService::MeterStatus::AutoRangeOff);
+}
+
+void BenchParsers::statusParseStatus_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addRow("PokitMeter") << QByteArray("\x00\x25\x07\x33\x40", 5);
+    QTest::addRow("PokitPro") << QByteArray("\x02\x64\x3b\x83\x40\x01\x00\x00", 8);
+}
+
+void BenchParsers::statusParseStatus()
+{
+    QFETCH(QByteArray, value);
+    StatusService::Status status{};
+    QBENCHMARK {
+        status = StatusServicePrivate::parseStatus(value);
+    }
+    QVERIFY(status.batteryVoltage > 2.0f);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(BenchParsers))
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class BenchParsers : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void dsoParseMetadata_data();
+    void dsoParseMetadata();
+
+    void dsoParseSamples_data();
+    void dsoParseSamples();
+
+    void dataLoggerParseMetadata_data();
+    void dataLoggerParseMetadata();
+
+    void dataLoggerParseSamples_data();
+    void dataLoggerParseSamples();
+
+    void multimeterParseReading_data();
+    void multimeterParseReading();
+
+    void statusParseStatus_data();
+    void statusParseStatus();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchreplayer.h"
+
+#include <qtpokit/dataloggerservice.h>
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitsimulator.h>
+#include <qtpokit/statusservice.h>
+#include <qtpokit/trafficrecorder.h>
+#include <qtpokit/trafficreplayer.h>
+
+#include <QEventLoop>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+// Replays a recording (see TrafficRecorder) as fast as possible, through the parsers and signals of a device's
+// Multimeter, DSO, Data Logger, and Status services, so as to measure QtPokit's throughput for real field traffic. The
+// recording can be set via the DOKIT_BENCH_RECORDING environment variable, otherwise a simulated session is recorded.
+
+void BenchReplayer::initTestCase()
+{
+    fileName = qEnvironmentVariable("DOKIT_BENCH_RECORDING");
+    if (!fileName.isEmpty()) {
+        return;
+    }
+
+    // Record 1000 multimeter readings, then an 8192 sample DSO capture, from a simulated device.
+    QVERIFY(dir.isValid());
+    fileName = dir.filePath(QStringLiteral("simulated.dokt"));
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    TrafficRecorder recorder(fileName);
+    recorder.addService(device.multimeter());
+    recorder.addService(device.dso());
+    QVERIFY(recorder.start());
+    simulator.start();
+
+    QEventLoop loop;
+    int received = 0;
+    connect(device.multimeter(), &MultimeterService::readingRead, &loop, [&]() {
+        if (++received == 1000) {
+            loop.quit();
+        }
+    });
+    connect(device.dso(), &DsoService::samplesRead, &loop, [&](const DsoService::Samples &values) {
+        if ((received += (int)values.size()) >= 8192) {
+            loop.quit();
+        }
+    });
+    device.multimeter()->setSettings({ MultimeterService::Mode::DcVoltage, 255, 0 });
+    device.multimeter()->enableReadingNotifications();
+    loop.exec();
+    device.multimeter()->disableReadingNotifications();
+
+    received = 0;
+    device.dso()->enableMetadataNotifications();
+    device.dso()->enableReadingNotifications();
+    device.dso()->setSettings({ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage, 255, 500, 8192 });
+    loop.exec();
+}
+
+void BenchReplayer::replay()
+{
+    PokitDevice device(nullptr);
+    TrafficReplayer replayer(fileName);
+    QVERIFY(replayer.load());
+    replayer.setPacing(TrafficReplayer::Pacing::AsFastAsPossible);
+    replayer.addService(device.multimeter());
+    replayer.addService(device.dso());
+    replayer.addService(device.dataLogger());
+    replayer.addService(device.status());
+
+    qint64 bytes = 0;
+    for (const TrafficRecorder::Record &record: replayer.records()) {
+        bytes += record.value.size();
+    }
+    qInfo().noquote() << QStringLiteral("Replaying %1 records (%2 bytes) from %3")
+        .arg(replayer.records().size()).arg(bytes).arg(fileName);
+
+    QEventLoop loop;
+    connect(&replayer, &TrafficReplayer::finished, &loop, &QEventLoop::quit);
+    QBENCHMARK {
+        replayer.start();
+        loop.exec();
+    }
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(BenchReplayer))
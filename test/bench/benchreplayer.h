@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTemporaryDir>
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class BenchReplayer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void replay();
+
+private:
+    QTemporaryDir dir;
+    QString fileName;
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchsimulator.h"
+
+#include <qtpokit/dataloggerservice.h>
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitsimulator.h>
+
+#include <QEventLoop>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+// Each benchmark drives a simulated device end-to-end: GATT requests, notifications, parsing, and signals, as per real
+// devices, but with no Bluetooth stack, and notifications back-to-back, so as to measure QtPokit's own throughput.
+
+// Adds a row for each sample payload size: the default ATT MTU, a Data Length Extension packet, and the maximum
+// attribute length.
+static void addPayloadRows(const QVector<int> &sampleCounts)
+{
+    QTest::addColumn<int>("samples");
+    QTest::addColumn<int>("payloadSize");
+    for (const int samples: sampleCounts) {
+        for (const int payloadSize: { 20, 244, 512 }) {
+            QTest::addRow("%d-samples-%d-bytes", samples, payloadSize) << samples << payloadSize;
+        }
+    }
+}
+
+void BenchSimulator::multimeterReadings_data()
+{
+    QTest::addColumn<int>("readings");
+    QTest::addRow("100") << 100;
+    QTest::addRow("1000") << 1000;
+}
+
+void BenchSimulator::multimeterReadings()
+{
+    QFETCH(int, readings);
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.start();
+
+    MultimeterService * const service = device.multimeter();
+    QEventLoop loop;
+    int received = 0;
+    connect(service, &MultimeterService::readingRead, &loop, [&]() {
+        if (++received >= readings) {
+            loop.quit();
+        }
+    });
+    service->setSettings({ MultimeterService::Mode::DcVoltage, 255, 0 }); // A zero interval notifies back-to-back.
+    service->enableReadingNotifications();
+    QBENCHMARK {
+        received = 0;
+        loop.exec();
+    }
+}
+
+void BenchSimulator::dsoCapture_data()
+{
+    addPayloadRows({ 1000, 8192 });
+}
+
+void BenchSimulator::dsoCapture()
+{
+    QFETCH(int, samples);
+    QFETCH(int, payloadSize);
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setProfile(PokitSimulator::Stream::Dso, { 0, 0, (quint16)payloadSize, 0.0f });
+    simulator.start();
+
+    DsoService * const service = device.dso();
+    QEventLoop loop;
+    int received = 0;
+    connect(service, &DsoService::samplesRead, &loop, [&](const DsoService::Samples &values) {
+        if ((received += (int)values.size()) >= samples) {
+            loop.quit();
+        }
+    });
+    service->enableMetadataNotifications();
+    service->enableReadingNotifications();
+    QBENCHMARK {
+        received = 0;
+        // A sub-millisecond sampling window, so captures are notified straight away.
+        service->setSettings({ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage, 255, 500,
+                               (quint16)samples });
+        loop.exec();
+    }
+}
+
+void BenchSimulator::dataLoggerTransfer_data()
+{
+    addPayloadRows({ 1000, 10000 });
+}
+
+void BenchSimulator::dataLoggerTransfer()
+{
+    QFETCH(int, samples);
+    QFETCH(int, payloadSize);
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setLoggedSamples((quint16)samples);
+    simulator.setProfile(PokitSimulator::Stream::DataLogger, { 0, 0, (quint16)payloadSize, 0.0f });
+    simulator.start();
+
+    DataLoggerService * const service = device.dataLogger();
+    QEventLoop loop;
+    int received = 0;
+    connect(service, &DataLoggerService::samplesRead, &loop, [&](const DataLoggerService::Samples &values) {
+        if ((received += (int)values.size()) >= samples) {
+            loop.quit();
+        }
+    });
+    service->enableMetadataNotifications();
+    service->enableReadingNotifications();
+    QBENCHMARK {
+        received = 0;
+        service->fetchSamples();
+        loop.exec();
+    }
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(BenchSimulator))
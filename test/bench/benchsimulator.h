@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class BenchSimulator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void multimeterReadings_data();
+    void multimeterReadings();
+
+    void dsoCapture_data();
+    void dsoCapture();
+
+    void dataLoggerTransfer_data();
+    void dataLoggerTransfer();
+};
+
+QTPOKIT_END_NAMESPACE
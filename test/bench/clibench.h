@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_BENCH_CLIBENCH_H
+#define DOKIT_BENCH_CLIBENCH_H
+
+#include "abstractcommand.h"
+
+#include <QDebug>
+#include <QLoggingCategory>
+#include <QTest>
+
+#include <iostream>
+
+Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
+
+/*!
+ * Implements a simple RAII redirection of std::cout to a null sink, that counts (but otherwise discards) the bytes
+ * written, so that benchmarks measure the cost of formatting output, rather than of the terminal (or file) behind it.
+ */
+class NullOutputSink : private std::streambuf
+{
+public:
+    NullOutputSink() : originalBuffer(std::cout.rdbuf(this))
+    {
+    }
+
+    ~NullOutputSink() override
+    {
+        std::cout.rdbuf(originalBuffer);
+    }
+
+    qint64 bytes() const
+    {
+        return count;
+    }
+
+protected:
+    int_type overflow(const int_type ch) override
+    {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            ++count;
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char_type *, const std::streamsize size) override
+    {
+        count += size;
+        return size;
+    }
+
+private:
+    std::streambuf * originalBuffer;
+    qint64 count { 0 };
+};
+
+/*!
+ * Adds a row for each of the given output \a formats, for each of the given sample \a batchSizes.
+ */
+inline void addOutputFormatRows(const QVector<AbstractCommand::OutputFormat> &formats,
+                                const QVector<int> &batchSizes)
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<int>("batchSize");
+    for (const AbstractCommand::OutputFormat format: formats) {
+        const char * const name = [format]() {
+            switch (format) {
+            case AbstractCommand::OutputFormat::Csv:            return "csv";
+            case AbstractCommand::OutputFormat::Json:           return "json";
+            case AbstractCommand::OutputFormat::Text:           return "text";
+            case AbstractCommand::OutputFormat::Binary:         return "binary";
+            case AbstractCommand::OutputFormat::Ndjson:         return "ndjson";
+            case AbstractCommand::OutputFormat::NdjsonEnvelope: return "ndjson-envelope";
+            case AbstractCommand::OutputFormat::Arrow:          return "arrow";
+            }
+            return "unknown";
+        }();
+        for (const int batchSize: batchSizes) {
+            QTest::addRow("%s-%d", name, batchSize) << format << batchSize;
+        }
+    }
+}
+
+/*!
+ * Reports the throughput of a benchmark that output \a samples samples, as \a bytes bytes, in \a nsecs nanoseconds.
+ *
+ * This complements Qt Test's own (per iteration) result, with figures comparable across formats and batch sizes.
+ */
+inline void reportOutputThroughput(const qint64 samples, const qint64 bytes, const qint64 nsecs)
+{
+    if ((samples <= 0) || (nsecs <= 0)) {
+        return;
+    }
+    qInfo().noquote() << QStringLiteral("%1: %2 samples/s, %3 bytes/sample")
+        .arg(QString::fromLatin1(QTest::currentDataTag()))
+        .arg((double)samples * 1e9 / (double)nsecs, 0, 'f', 0)
+        .arg((double)bytes / (double)samples, 0, 'f', 2);
+}
+
+/*!
+ * Disables the CLI's informational logging, such as the "Finished fetching" message logged at the end of each
+ * (synthetic) capture, which would otherwise swamp the benchmark results.
+ */
+inline void disableCommandLogging()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("dokit.cli.*.info=false\npokit.*.info=false"));
+}
+
+#endif // DOKIT_BENCH_CLIBENCH_H
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// Writes a seed corpus for each fuzz target, to a sub-directory (named for the target) of the given directory.
+//
+// Each corpus is seeded with a few real device values, and every value read or notified for the target's
+// characteristic in each of the given TrafficRecorder recordings (such as from `dokit meter --record <file>`). Corpus
+// files are named for the SHA-1 of their contents, as per libFuzzer, so duplicate values are written just once.
+
+#include "fuzztargets.h"
+
+#include <qtpokit/trafficreplayer.h>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+
+#include <cstdlib>
+#include <iostream>
+
+QTPOKIT_USE_NAMESPACE
+
+namespace {
+
+// Writes value to directory, returning true if it was not already there.
+bool writeValue(const QDir &directory, const QByteArray &value)
+{
+    QFile file(directory.filePath(QString::fromLatin1(QCryptographicHash::hash(value, QCryptographicHash::Sha1)
+        .toHex())));
+    if (file.exists()) {
+        return false;
+    }
+    if ((!file.open(QIODevice::WriteOnly)) || (file.write(value) != value.size())) {
+        std::cerr << "Failed to write " << qUtf8Printable(file.fileName()) << ": "
+                  << qUtf8Printable(file.errorString()) << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <output-directory> [recording...]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    QVector<TrafficRecorder::Record> records;
+    for (int index = 2; index < argc; ++index) {
+        TrafficReplayer replayer(QString::fromLocal8Bit(argv[index]));
+        if (!replayer.load()) {
+            std::cerr << "Failed to load recording " << argv[index] << std::endl;
+            return EXIT_FAILURE;
+        }
+        records.append(replayer.records());
+    }
+
+    const QDir output(QString::fromLocal8Bit(argv[1]));
+    for (const FuzzTarget &target: fuzzTargets()) {
+        if (!output.mkpath(QString::fromLatin1(target.name))) {
+            std::cerr << "Failed to create " << qUtf8Printable(output.filePath(QString::fromLatin1(target.name)))
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+        const QDir directory(output.filePath(QString::fromLatin1(target.name)));
+        int written = 0;
+        for (const QByteArray &seed: target.seeds) {
+            written += (writeValue(directory, seed)) ? 1 : 0;
+        }
+        for (const TrafficRecorder::Record &record: records) {
+            if ((record.characteristic == target.characteristic)
+                && (record.operation != TrafficRecorder::Operation::Write)) {
+                written += (writeValue(directory, record.value)) ? 1 : 0;
+            }
+        }
+        std::cout << target.name << ": " << written << " new corpus file(s)" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
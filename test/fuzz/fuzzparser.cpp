@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// Fuzz entry points for a single characteristic parser, chosen at compile time via DOKIT_FUZZ_TARGET.
+//
+// With DOKIT_LIBFUZZER, libFuzzer provides main(). Otherwise, main() runs each input given (files, or directories of
+// files, such as a corpus), or else stdin (as for AFL, in persistent mode where available). So the same target can be
+// fuzzed by AFL++ (which can also link libFuzzer targets directly, via afl-clang-fast's -fsanitize=fuzzer support),
+// and run over a corpus as a regression test. With -throughput, main() instead reports the parser's throughput over
+// the given inputs.
+
+#include "fuzztargets.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if !defined(DOKIT_FUZZ_TARGET)
+#error DOKIT_FUZZ_TARGET must name the fuzz target, such as "DsoMetadata"
+#endif
+
+QTPOKIT_USE_NAMESPACE
+
+namespace {
+
+const FuzzTarget &target()
+{
+    static const FuzzTarget * const found = findFuzzTarget(DOKIT_FUZZ_TARGET);
+    if (found == nullptr) {
+        std::cerr << "Unknown fuzz target: " << DOKIT_FUZZ_TARGET << std::endl;
+        std::abort();
+    }
+    return *found;
+}
+
+}
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***)
+{
+    disableParserLogging();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t * data, std::size_t size)
+{
+    // Copy the input, so that reads beyond it are caught by ASan, rather than hidden within a larger allocation.
+    target().parse(QByteArray(reinterpret_cast<const char *>(data), (int)size));
+    return 0;
+}
+
+#if !defined(DOKIT_LIBFUZZER)
+
+namespace {
+
+// Appends the contents of each file at path (or within it, if a directory) to inputs.
+bool readInputs(const QString &path, QVector<QByteArray> &inputs)
+{
+    const QFileInfo info(path);
+    if (info.isDir()) {
+        const QStringList names = QDir(path).entryList(QDir::Files, QDir::Name);
+        for (const QString &name: names) {
+            if (!readInputs(QDir(path).filePath(name), inputs)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::cerr << "Failed to open " << qUtf8Printable(path) << ": " << qUtf8Printable(file.errorString())
+                  << std::endl;
+        return false;
+    }
+    inputs.append(file.readAll());
+    return true;
+}
+
+// Parses all inputs, repeatedly, for at least the given number of seconds, then reports the throughput.
+void reportThroughput(const QVector<QByteArray> &inputs, const double seconds)
+{
+    qint64 bytesPerPass = 0;
+    for (const QByteArray &input: inputs) {
+        bytesPerPass += input.size();
+    }
+    quint64 passes = 0;
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        for (const QByteArray &input: inputs) {
+            target().parse(input);
+        }
+        ++passes;
+    } while (timer.nsecsElapsed() < (qint64)(seconds * 1e9));
+    const double elapsed = (double)timer.nsecsElapsed() / 1e9;
+    const double bytes = (double)bytesPerPass * (double)passes;
+    std::cout << target().name << ": " << inputs.size() << " input(s), " << bytesPerPass << " byte(s), "
+              << passes << " pass(es) in " << elapsed << " s: " << (bytes / elapsed / 1e6) << " MB/s, "
+              << ((double)inputs.size() * (double)passes / elapsed) << " values/s" << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    disableParserLogging();
+
+    bool throughput = false;
+    double seconds = 1.0;
+    QVector<QByteArray> inputs;
+    int paths = 0;
+    for (int index = 1; index < argc; ++index) {
+        if (std::strcmp(argv[index], "-throughput") == 0) {
+            throughput = true;
+        } else if (std::strncmp(argv[index], "-seconds=", 9) == 0) {
+            seconds = std::atof(argv[index] + 9);
+        } else if (argv[index][0] == '-') {
+            std::cerr << "Usage: " << argv[0] << " [-throughput [-seconds=N]] [file|directory...]" << std::endl;
+            return EXIT_FAILURE;
+        } else if (!readInputs(QString::fromLocal8Bit(argv[index]), inputs)) {
+            return EXIT_FAILURE;
+        } else {
+            ++paths;
+        }
+    }
+
+    if (paths == 0) {
+        QFile in;
+        #if defined(__AFL_LOOP) // AFL++ persistent mode, re-reading stdin for each input.
+        while (__AFL_LOOP(10000)) {
+            if (!in.open(stdin, QIODevice::ReadOnly)) {
+                return EXIT_FAILURE;
+            }
+            target().parse(in.readAll());
+            in.close();
+        }
+        return EXIT_SUCCESS;
+        #else
+        if (!in.open(stdin, QIODevice::ReadOnly)) {
+            return EXIT_FAILURE;
+        }
+        inputs.append(in.readAll());
+        #endif
+    }
+
+    if (throughput) {
+        if (inputs.isEmpty()) {
+            std::cerr << "No inputs to measure throughput with" << std::endl;
+            return EXIT_FAILURE;
+        }
+        reportThroughput(inputs, seconds);
+        return EXIT_SUCCESS;
+    }
+
+    for (const QByteArray &input: inputs) {
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t *>(input.constData()), (std::size_t)input.size());
+    }
+    std::cout << target().name << ": parsed " << inputs.size() << " input(s)" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+#endif // DOKIT_LIBFUZZER
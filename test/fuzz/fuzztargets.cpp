@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "fuzztargets.h"
+
+#include "dataloggerservice_p.h"
+#include "dsoservice_p.h"
+#include "multimeterservice_p.h"
+#include "statusservice_p.h"
+
+#include <QLoggingCategory>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+// Aborts if condition is false, so the fuzzer reports the offending input, just as it would for a crash.
+void check(const bool condition)
+{
+    if (!condition) {
+        std::abort();
+    }
+}
+
+// Values too short for each parser must be rejected wholesale, while longer values are parsed, with a warning.
+
+void parseDsoMetadata(const QByteArray &value)
+{
+    const DsoService::Metadata metadata = DsoServicePrivate::parseMetadata(value);
+    check((value.size() >= 17) || (metadata.status == DsoService::DsoStatus::Error));
+}
+
+void parseDsoSamples(const QByteArray &value)
+{
+    const DsoService::Samples samples = DsoServicePrivate::parseSamples(value);
+    check(samples.size() == (((value.size() % 2) == 0) ? value.size() / 2 : 0));
+}
+
+void parseLoggerMetadata(const QByteArray &value)
+{
+    const DataLoggerService::Metadata metadata = DataLoggerServicePrivate::parseMetadata(value);
+    check((value.size() >= 15) || (metadata.status == DataLoggerService::LoggerStatus::Error));
+}
+
+void parseLoggerSamples(const QByteArray &value)
+{
+    const DataLoggerService::Samples samples = DataLoggerServicePrivate::parseSamples(value);
+    check(samples.size() == (((value.size() % 2) == 0) ? value.size() / 2 : 0));
+}
+
+void parseMeterReading(const QByteArray &value)
+{
+    const MultimeterService::Reading reading = MultimeterServicePrivate::parseReading(value);
+    check((value.size() >= 7) || ((reading.status == MultimeterService::MeterStatus::Error)
+        && (std::isnan(reading.value))));
+}
+
+void parseStatus(const QByteArray &value)
+{
+    const StatusService::Status status = StatusServicePrivate::parseStatus(value);
+    check((value.size() >= 5) || (std::isnan(status.batteryVoltage)));
+}
+
+void parseDeviceCharacteristics(const QByteArray &value)
+{
+    const StatusService::DeviceCharacteristics characteristics =
+        StatusServicePrivate::parseDeviceCharacteristics(value);
+    check(characteristics.firmwareVersion.isNull() == (value.size() < 20));
+}
+
+}
+
+/*!
+ * Returns all fuzz targets, one per characteristic parser.
+ */
+const QVector<FuzzTarget> &fuzzTargets()
+{
+    static const QVector<FuzzTarget> targets {
+        { "DsoMetadata", DsoService::CharacteristicUuids::metadata, parseDsoMetadata, {
+            QByteArray("\x00\x98\xf7\x8b\x33\x02\x00\x40\x42\x0f\x00\x0a\x00\x0a\x00\x00\x00", 17),
+            QByteArray("\x00\xcc\xec\xba\x33\x02\x00\x40\x42\x0f\x00\xe8\x03\x0a\x00\x00\x00\x14\x00\x00\x00", 21),
+        } },
+        { "DsoSamples", DsoService::CharacteristicUuids::reading, parseDsoSamples, {
+            QByteArray("\x01\x00\xff\xff\x00\x80\xff\x7f", 8),
+            QByteArray(244, '\x10'),
+        } },
+        { "LoggerMetadata", DataLoggerService::CharacteristicUuids::metadata, parseLoggerMetadata, {
+            QByteArray("\x00\x9f\x0f\x49\x37\x00\x04\x3c\x00\x00\x00\xe9\xbb\x8c\x62", 15),
+            QByteArray("\x00\x39\xf0\x45\x3c\x00\x04\x60\xea\x00\x00\x0d"
+                       "\x00\x00\x00\x30\x38\x00\x00\x43\xb9\x8c\x62", 23),
+        } },
+        { "LoggerSamples", DataLoggerService::CharacteristicUuids::reading, parseLoggerSamples, {
+            QByteArray("\x01\x00\xff\xff\x00\x80\xff\x7f", 8),
+            QByteArray(244, '\x10'),
+        } },
+        { "MeterReading", MultimeterService::CharacteristicUuids::reading, parseMeterReading, {
+            QByteArray("\x00\x00\x00\x00\x00\x01\x03", 7),
+            QByteArray("\x00\x94\x89\xfa\x3b\x02\x00", 7),
+        } },
+        { "Status", StatusService::CharacteristicUuids::status, parseStatus, {
+            QByteArray("\x00\x25\x07\x33\x40", 5),
+            QByteArray("\x02\x64\x3b\x83\x40\x01\x00\x00", 8),
+        } },
+        { "DeviceCharacteristics", StatusService::CharacteristicUuids::deviceCharacteristics,
+          parseDeviceCharacteristics, {
+            QByteArray("\x01\x04\x3c\x00\x02\x00\xe8\x03\xe8\x03\x00\x20\x00\x00\x84\x2e\x14\x2c\x03\xa8", 20),
+            QByteArray("\x01\x03\x52\x03\x0a\x00\xb8\x0b\xe8\x03\x00\x40\x00\x00\x5c\x02\x72\x09\xaa\x25", 20),
+        } },
+    };
+    return targets;
+}
+
+/*!
+ * Returns the fuzz target called \a name, or \c nullptr if there is none.
+ */
+const FuzzTarget * findFuzzTarget(const char * const name)
+{
+    for (const FuzzTarget &target: fuzzTargets()) {
+        if (std::strcmp(target.name, name) == 0) {
+            return &target;
+        }
+    }
+    return nullptr;
+}
+
+/*!
+ * Disables QtPokit's logging, since parsers warn about every malformed value, which (when fuzzing) is most of them.
+ */
+void disableParserLogging()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("pokit.*=false"));
+}
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_TESTS_FUZZTARGETS_H
+#define DOKIT_TESTS_FUZZTARGETS_H
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QBluetoothUuid>
+#include <QByteArray>
+#include <QVector>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// A characteristic parser to fuzz.
+struct FuzzTarget {
+    const char * name;               ///< Name of the target, such as "DsoMetadata", as used for its corpus directory.
+    QBluetoothUuid characteristic;   ///< Characteristic whose (recorded) values the parser parses.
+    void (* parse)(const QByteArray &value); ///< Parses \a value, aborting if the result breaks an invariant.
+    QVector<QByteArray> seeds;       ///< Real device values, to seed the target's corpus with.
+};
+
+const QVector<FuzzTarget> &fuzzTargets();
+const FuzzTarget * findFuzzTarget(const char * const name);
+void disableParserLogging();
+
+QTPOKIT_END_NAMESPACE
+
+#endif // DOKIT_TESTS_FUZZTARGETS_H
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "allocationcounter.h"
+
+#include <cstdlib>
+#include <new>
+
+// Sanitizers replace the allocation functions themselves, so leave them be (and report counting as unsupported).
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define DOKIT_NO_ALLOCATION_COUNTING
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer) || __has_feature(thread_sanitizer)
+#define DOKIT_NO_ALLOCATION_COUNTING
+#endif
+#endif
+
+namespace {
+
+// Trivially-initialised, so safe to touch from within malloc(), even before main() or during thread start-up.
+thread_local quint64 allocations { 0 };
+
+}
+
+/*!
+ * Returns \c true if allocations are being counted, or \c false if not (such as when built with a sanitizer).
+ */
+bool AllocationCounter::isSupported()
+{
+    #if defined(DOKIT_NO_ALLOCATION_COUNTING)
+    return false;
+    #else
+    return true;
+    #endif
+}
+
+/*!
+ * Returns the number of allocations made by the current thread so far.
+ */
+quint64 AllocationCounter::total()
+{
+    return allocations;
+}
+
+#if !defined(DOKIT_NO_ALLOCATION_COUNTING)
+#if defined(__GLIBC__)
+
+// Replace glibc's malloc() family, forwarding to the real implementations, so that allocations made within shared
+// libraries (including libstdc++'s operator new) are counted too. free() needs no replacement.
+extern "C" {
+
+void * __libc_malloc(std::size_t size);
+void * __libc_calloc(std::size_t count, std::size_t size);
+void * __libc_realloc(void * pointer, std::size_t size);
+
+void * malloc(std::size_t size) noexcept
+{
+    ++allocations;
+    return __libc_malloc(size);
+}
+
+void * calloc(std::size_t count, std::size_t size) noexcept
+{
+    ++allocations;
+    return __libc_calloc(count, size);
+}
+
+void * realloc(void * pointer, std::size_t size) noexcept
+{
+    ++allocations;
+    return __libc_realloc(pointer, size);
+}
+
+}
+
+#else
+
+// Elsewhere, replace just the global operator new (and so, its matching operator delete).
+void * operator new(std::size_t size)
+{
+    ++allocations;
+    if (void * const pointer = std::malloc((size == 0) ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    ++allocations;
+    return std::malloc((size == 0) ? 1 : size);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void * pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, const std::nothrow_t &) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void * pointer, const std::nothrow_t &) noexcept
+{
+    std::free(pointer);
+}
+
+#endif // __GLIBC__
+#endif // DOKIT_NO_ALLOCATION_COUNTING
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_TESTS_ALLOCATIONCOUNTER_H
+#define DOKIT_TESTS_ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+/*!
+ * Implements a simple RAII count of the heap allocations made by the current thread.
+ *
+ * Allocations are counted by replacing the global allocation functions (see allocationcounter.cpp), so any test that
+ * includes this header must also compile allocationcounter.cpp. On glibc, malloc() itself is replaced, so allocations
+ * made inside Qt (such as by QByteArray and QVector) are counted too; elsewhere, only the global operator new is
+ * replaced, so counts may undercount. Either way, tests should assert upper bounds, not exact counts.
+ */
+class AllocationCounter
+{
+public:
+    AllocationCounter() : start(total())
+    {
+
+    }
+
+    /// Returns the number of allocations made by the current thread since construction (or the last reset()).
+    quint64 count() const
+    {
+        return total() - start;
+    }
+
+    /// Restarts counting from zero.
+    void reset()
+    {
+        start = total();
+    }
+
+    /*!
+     * Returns the number of allocations made by one call to \a func, after \a warmups calls to settle any one-off
+     * allocations (such as function-local statics, and buffers growing to their steady state capacity).
+     */
+    template<typename Func>
+    static quint64 measure(const Func &func, const int warmups = 1)
+    {
+        for (int warmup = 0; warmup < warmups; ++warmup) {
+            func();
+        }
+        const AllocationCounter counter;
+        func();
+        return counter.count();
+    }
+
+    static bool isSupported();
+    static quint64 total();
+
+private:
+    quint64 start; ///< Value of total() when counting (re)started.
+};
+
+#endif // DOKIT_TESTS_ALLOCATIONCOUNTER_H
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DOKIT_TESTS_ARCHIVEFIXTURE_H
+#define DOKIT_TESTS_ARCHIVEFIXTURE_H
+
+#include <qtpokit/dataloggerservice.h>
+#include <qtpokit/loggerarchive.h>
+
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVector>
+
+/// A run of samples to append to an archive, for createArchives().
+struct ArchiveRun {
+    QString fileName;                   ///< Archive's file name, relative to the fixture's root directory.
+    quint32 offset;                     ///< Seconds the run's session starts after the fixture's metadata's session.
+    DataLoggerService::Samples samples; ///< Samples to append.
+    qint64 firstSample { -1 };          ///< Index of the first sample within its session, or -1 for a whole session.
+};
+
+/*!
+ * Appends \a samples, from \a firstSample of a session starting \a offset seconds after \a metadata's session, to
+ * archive \a fileName.
+ */
+inline bool appendSamples(const QString &fileName, DataLoggerService::Metadata metadata, const quint32 offset,
+                          const DataLoggerService::Samples &samples, const quint32 firstSample = 0)
+{
+    metadata.timestamp += offset;
+    LoggerArchive archive(fileName);
+    return archive.append(metadata, samples, firstSample);
+}
+
+/*!
+ * Appends a session (of just \a samples) to archive \a fileName, starting \a offset seconds after \a metadata's
+ * session.
+ */
+inline bool appendSession(const QString &fileName, DataLoggerService::Metadata metadata, const quint32 offset,
+                          const DataLoggerService::Samples &samples)
+{
+    metadata.numberOfSamples = (quint16)samples.size();
+    return appendSamples(fileName, metadata, offset, samples);
+}
+
+/*!
+ * Populates \a dir with (empty) \a directories, then appends each of \a runs (of \a metadata's sessions), and finally
+ * writes a non-archive, `archives/notes.txt`. So \a directories must include `archives`.
+ */
+inline bool createArchives(const QTemporaryDir &dir, const DataLoggerService::Metadata &metadata,
+                           const QStringList &directories, const QVector<ArchiveRun> &runs)
+{
+    const QDir root(dir.path());
+    for (const QString &directory: directories) {
+        if (!root.mkpath(directory)) {
+            return false;
+        }
+    }
+    for (const ArchiveRun &run: runs) {
+        const QString fileName = root.filePath(run.fileName);
+        if (!((run.firstSample < 0) ? appendSession(fileName, metadata, run.offset, run.samples)
+              : appendSamples(fileName, metadata, run.offset, run.samples, (quint32)run.firstSample))) {
+            return false;
+        }
+    }
+    QFile notes(root.filePath(QStringLiteral("archives/notes.txt")));
+    return (notes.open(QIODevice::WriteOnly)) && (notes.write("Not an archive.") > 0);
+}
+
+/*!
+ * Returns \a strings, with any `{dir}` placeholders replaced with \a dir.
+ */
+inline QStringList withDir(QStringList strings, const QString &dir)
+{
+    for (QString &string: strings) {
+        string.replace(QStringLiteral("{dir}"), dir);
+    }
+    return strings;
+}
+
+#endif // DOKIT_TESTS_ARCHIVEFIXTURE_H
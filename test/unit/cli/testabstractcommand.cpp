@@ -2,12 +2,25 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "testabstractcommand.h"
+#include "outputstreamcapture.h"
+#include "../allocationcounter.h"
 #include "../stringliterals_p.h"
 
 #include "abstractcommand.h"
+#include "outputfilewriter.h"
 
+#include <qtpokit/memorybudget.h>
 #include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/samplecodec.h>
 
+#include <QBluetoothUuid>
+#include <QBuffer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <limits>
+
+Q_DECLARE_METATYPE(AbstractCommand::FlushPolicy)
 Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
 
 DOKIT_USE_STRINGLITERALS
@@ -73,6 +86,386 @@ void TestAbstractCommand::escapeCsvField()
     QCOMPARE(AbstractCommand::escapeCsvField(field), expected);
 }
 
+void TestAbstractCommand::escapeJsonString_data()
+{
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addRow("<empty>") << QString()               << QByteArray(R"("")");
+    QTest::addRow("abc")     << u"abc"_s                << QByteArray(R"("abc")");
+    QTest::addRow("a,c")     << u"a,c"_s                << QByteArray(R"("a,c")");
+    QTest::addRow(R"(a"c)")  << uR"(a"c)"_s             << QByteArray(R"("a\"c")");
+    QTest::addRow(R"(a\c)")  << uR"(a\c)"_s             << QByteArray(R"("a\\c")");
+    QTest::addRow("a\\nc")   << u"a\nc"_s               << QByteArray(R"("a\nc")");
+    QTest::addRow("a\\tc")   << u"a\tc"_s               << QByteArray(R"("a\tc")");
+    QTest::addRow("a\\x01c") << u"a\x01" "c"_s          << QByteArray(R"("a\u0001c")");
+    QTest::addRow("°C")      << QString::fromUtf8("°C") << QByteArray("\"\xC2\xB0""C\"");
+}
+
+void TestAbstractCommand::escapeJsonString()
+{
+    QFETCH(QString, string);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(AbstractCommand::escapeJsonString(string), expected);
+}
+
+void TestAbstractCommand::escapeLineProtocolTag_data()
+{
+    QTest::addColumn<QString>("tag");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addRow("<empty>")  << QString()               << QByteArray();
+    QTest::addRow("abc")      << u"abc"_s                << QByteArray("abc");
+    QTest::addRow("a,c")      << u"a,c"_s                << QByteArray(R"(a\,c)");
+    QTest::addRow("a=c")      << u"a=c"_s                << QByteArray(R"(a\=c)");
+    QTest::addRow("a c")      << u"a c"_s                << QByteArray(R"(a\ c)");
+    QTest::addRow(R"(a"c)")   << uR"(a"c)"_s             << QByteArray(R"(a"c)");
+    QTest::addRow(R"(a\c)")   << uR"(a\c)"_s             << QByteArray(R"(a\c)");
+    QTest::addRow("a\\nc")    << u"a\nc"_s               << QByteArray(R"(a\ c)");
+    QTest::addRow("Up to 6V") << u"Up to 6V"_s           << QByteArray(R"(Up\ to\ 6V)");
+    QTest::addRow("°C")       << QString::fromUtf8("°C") << QByteArray("\xC2\xB0""C");
+}
+
+void TestAbstractCommand::escapeLineProtocolTag()
+{
+    QFETCH(QString, tag);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(AbstractCommand::escapeLineProtocolTag(tag), expected);
+}
+
+void TestAbstractCommand::formatJsonNumber_data()
+{
+    QTest::addColumn<double>("number");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addRow("0")         << 0.0        << QByteArray("0");
+    QTest::addRow("1.5")       << 1.5        << QByteArray("1.5");
+    QTest::addRow("-0.25")     << -0.25      << QByteArray("-0.25");
+    QTest::addRow("150")       << 150.0      << QByteArray("150");
+    QTest::addRow("0.1f")      << (double)0.1f << QByteArray("0.1");
+    QTest::addRow("1e-05")     << 0.00001    << QByteArray("1e-05");
+    QTest::addRow("1234567")   << 1234567.0  << QByteArray("1.23457e+06");
+    QTest::addRow("infinity")  << std::numeric_limits<double>::infinity()  << QByteArray("null");
+    QTest::addRow("-infinity") << -std::numeric_limits<double>::infinity() << QByteArray("null");
+    QTest::addRow("nan")       << std::numeric_limits<double>::quiet_NaN() << QByteArray("null");
+}
+
+void TestAbstractCommand::formatJsonNumber()
+{
+    QFETCH(double, number);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(AbstractCommand::formatJsonNumber(number), expected);
+}
+
+void TestAbstractCommand::appendNumber_data()
+{
+    QTest::addColumn<float>("number");
+    QTest::addColumn<char>("format");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addRow("0")          << 0.0f         << 'g' << QByteArray("0");
+    QTest::addRow("1.5")        << 1.5f         << 'g' << QByteArray("1.5");
+    QTest::addRow("-0.25")      << -0.25f       << 'g' << QByteArray("-0.25");
+    QTest::addRow("0.1")        << 0.1f         << 'g' << QByteArray("0.1");
+    QTest::addRow("1e-05")      << 0.00001f     << 'g' << QByteArray("1e-05");
+    QTest::addRow("1234567")    << 1234567.0f   << 'g' << QByteArray("1.23457e+06");
+    QTest::addRow("123456")     << 123456.0f    << 'g' << QByteArray("123456");
+    QTest::addRow("0.0001")     << 0.0001f      << 'g' << QByteArray("0.0001");
+    QTest::addRow("0.5f")       << 0.5f         << 'f' << QByteArray("0.500000");
+    QTest::addRow("-150f")      << -150.0f      << 'f' << QByteArray("-150.000000");
+    QTest::addRow("1e-07f")     << 0.0000001f   << 'f' << QByteArray("0.000000");
+    QTest::addRow("1.5e")       << 1.5f         << 'e' << QByteArray("1.500000e+00");
+    QTest::addRow("inf")        << std::numeric_limits<float>::infinity()  << 'g' << QByteArray("inf");
+    QTest::addRow("-inf")       << -std::numeric_limits<float>::infinity() << 'f' << QByteArray("-inf");
+    QTest::addRow("nan")        << std::numeric_limits<float>::quiet_NaN() << 'g' << QByteArray("nan");
+}
+
+void TestAbstractCommand::appendNumber()
+{
+    QFETCH(float, number);
+    QFETCH(char, format);
+    QFETCH(QByteArray, expected);
+    QByteArray buffer("abc,");
+    AbstractCommand::appendNumber(buffer, number, format, 6);
+    QCOMPARE(buffer, QByteArray("abc,") + expected);
+    QCOMPARE(expected, QByteArray::number((double)number, format, 6)); // ie byte-identical to QByteArray::number().
+
+    buffer.clear();
+    AbstractCommand::appendNumber(buffer, (double)number, format, 6);
+    QCOMPARE(buffer, expected);
+}
+
+void TestAbstractCommand::appendNumber_shortest()
+{
+    for (const float number: { 0.1f, 1.0f / 3.0f, -2.5f, 123456.7f, 1e-07f }) {
+        QByteArray buffer;
+        AbstractCommand::appendNumber(buffer, number, 'g', QLocale::FloatingPointShortest);
+        QCOMPARE(buffer.toFloat(), number); // Round trips.
+        QVERIFY(buffer.size() <= 13);
+    }
+    QByteArray buffer;
+    AbstractCommand::appendNumber(buffer, 0.1f, 'g', QLocale::FloatingPointShortest);
+    QCOMPARE(buffer, QByteArray("0.1"));
+    buffer.clear();
+    AbstractCommand::appendNumber(buffer, 1.0f / 3.0f, 'g', QLocale::FloatingPointShortest);
+    QCOMPARE(buffer, QByteArray("0.33333334"));
+    buffer.clear();
+    AbstractCommand::appendNumber(buffer, 0.1, 'g', QLocale::FloatingPointShortest);
+    QCOMPARE(buffer, QByteArray("0.1"));
+}
+
+void TestAbstractCommand::appendNumber_integer()
+{
+    QByteArray buffer;
+    AbstractCommand::appendNumber(buffer, (qint64)0);
+    buffer.append(',');
+    AbstractCommand::appendNumber(buffer, (qint64)123);
+    buffer.append(',');
+    AbstractCommand::appendNumber(buffer, std::numeric_limits<qint64>::min());
+    QCOMPARE(buffer, QByteArray("0,123,") + QByteArray::number(std::numeric_limits<qint64>::min()));
+}
+
+void TestAbstractCommand::appendJsonNumber()
+{
+    QByteArray buffer("[");
+    AbstractCommand::appendJsonNumber(buffer, 1.5);
+    buffer.append(',');
+    AbstractCommand::appendJsonNumber(buffer, std::numeric_limits<double>::infinity());
+    buffer.append(',');
+    AbstractCommand::appendJsonNumber(buffer, 1234567.0);
+    QCOMPARE(buffer, QByteArray("[1.5,null,1.23457e+06"));
+}
+
+void TestAbstractCommand::binaryRecordSize()
+{
+    QCOMPARE(AbstractCommand::binaryRecordSize(AbstractCommand::BinaryBlock::DsoSamples),    (quint32)2);
+    QCOMPARE(AbstractCommand::binaryRecordSize(AbstractCommand::BinaryBlock::LoggerSamples), (quint32)2);
+    QCOMPARE(AbstractCommand::binaryRecordSize(AbstractCommand::BinaryBlock::MeterReadings), (quint32)8);
+}
+
+void TestAbstractCommand::writeBinaryHeader()
+{
+    QByteArray buffer;
+    AbstractCommand::writeBinaryHeader(buffer, AbstractCommand::BinaryBlock::DsoSamples, 1, 2, 0.5f, 1000,
+                                       Q_UINT64_C(0x0102030405060708), 3);
+    QCOMPARE(buffer, QByteArray::fromHex(
+        "444f4b42" "01" "01" "01" "02" "0000003f" "e8030000" "0807060504030201" "03000000" "02000000"));
+
+    // Compressed blocks have no fixed record size.
+    buffer.clear();
+    AbstractCommand::writeBinaryHeader(buffer, AbstractCommand::BinaryBlock::LoggerSamples, 1, 2, 0.5f, 1000,
+                                       Q_UINT64_C(0x0102030405060708), 3, true);
+    QCOMPARE(buffer, QByteArray::fromHex(
+        "444f4b42" "01" "02" "01" "02" "0000003f" "e8030000" "0807060504030201" "03000000" "00000000"));
+}
+
+void TestAbstractCommand::writeBinarySamples()
+{
+    QByteArray buffer("abc");
+    AbstractCommand::writeBinarySamples(buffer, { 1, -2, 300 });
+    AbstractCommand::writeBinarySamples(buffer, { });
+    QCOMPARE(buffer, QByteArray("abc") + QByteArray::fromHex("0100feff2c01"));
+
+    // Compressed samples continue on from, and update, the previous sample.
+    buffer.clear();
+    qint16 previous = 0;
+    AbstractCommand::writeBinarySamples(buffer, { 1, -2 }, &previous);
+    QCOMPARE(previous, (qint16)-2);
+    AbstractCommand::writeBinarySamples(buffer, { }, &previous);
+    QCOMPARE(previous, (qint16)-2);
+    AbstractCommand::writeBinarySamples(buffer, { 300 }, &previous);
+    QCOMPARE(previous, (qint16)300);
+    QCOMPARE(buffer, QByteArray::fromHex("0205dc04"));
+}
+
+void TestAbstractCommand::writeBinary_allocations()
+{
+    if (!AllocationCounter::isSupported()) {
+        QSKIP("Allocation counting is not supported by this build");
+    }
+
+    // Writing into a buffer with enough capacity reserved should not allocate, compressed or not.
+    const QVector<qint16> samples(1000, 1);
+    QByteArray buffer;
+    buffer.reserve(32 + SampleCodec::maxEncodedSize(samples.size()));
+    QCOMPARE(AllocationCounter::measure([&]{
+        buffer.truncate(0); // Retains the reserved capacity, unlike clear().
+        AbstractCommand::writeBinaryHeader(buffer, AbstractCommand::BinaryBlock::DsoSamples, 1, 2, 1.0f, 1000, 0,
+                                           (quint32)samples.size());
+        AbstractCommand::writeBinarySamples(buffer, samples);
+    }), (quint64)0);
+    QCOMPARE(buffer.size(), 32 + samples.size() * 2);
+
+    qint16 previous = 0;
+    QCOMPARE(AllocationCounter::measure([&]{
+        buffer.truncate(0); // Retains the reserved capacity, unlike clear().
+        previous = 0;
+        AbstractCommand::writeBinaryHeader(buffer, AbstractCommand::BinaryBlock::DsoSamples, 1, 2, 1.0f, 1000, 0,
+                                           (quint32)samples.size(), true);
+        AbstractCommand::writeBinarySamples(buffer, samples, &previous);
+    }), (quint64)0);
+    QCOMPARE(buffer.size(), 32 + samples.size()); // The first delta is 1, and the rest 0; one byte each.
+}
+
+void TestAbstractCommand::writeArrowSchema()
+{
+    QByteArray buffer("abc");
+    AbstractCommand::writeArrowSchema(buffer);
+    QCOMPARE(buffer.size(), 3 + 392);
+    QVERIFY(buffer.startsWith("abc"));
+    QCOMPARE(buffer.mid(3), QByteArray::fromHex(
+        "ffffffff80010000100000000c00170014001600100008000c0000000000000000000000000000001000000004000100"
+        "08000800000004000800000004000000040000002400000078000000bc00000000010000100012000400100011000800"
+        "00000c000000000014000000100000002800000038000000000a00000900000074696d657374616d700008000a000800"
+        "04000000000000000e000000080000000200000003000000555443000000000010001200040010001100080000000c00"
+        "10000000100000002000000024000000000300000500000076616c756500060006000400000000000a00000001000000"
+        "0000000010001200040010001100080000000c0000000000140000001000000020000000280000000002000004000000"
+        "6d6f64650000080009000400080000000a00000008000000000000000000000010001200040010001100080000000c00"
+        "10000000100000002000000028000000000200000500000072616e676500080009000400080000000a00000008000000"
+        "0000000000000000"));
+}
+
+void TestAbstractCommand::writeArrowRecordBatch()
+{
+    QByteArray buffer;
+    AbstractCommand::writeArrowRecordBatch(buffer, { 1700000000000000, 1700000000001000 }, { 1.5f, -0.25f }, 1, 2);
+    QCOMPARE(buffer.size(), 336);
+    QCOMPARE(buffer, QByteArray::fromHex(
+        "ffffffff20010000100000000c00170014001600100008000c0000000000000028000000000000001800000004000300"
+        "0a001800080010001400000000000000100000000000000002000000000000000c000000500000000000000004000000"
+        "020000000000000000000000000000000200000000000000000000000000000002000000000000000000000000000000"
+        "020000000000000000000000000000000000000008000000000000000000000000000000000000000000000000000000"
+        "100000000000000010000000000000000000000000000000100000000000000008000000000000001800000000000000"
+        "000000000000000018000000000000000200000000000000200000000000000000000000000000002000000000000000"
+        "020000000000000000401e18240a0600e8431e18240a06000000c03f000080be01010000000000000202000000000000"));
+
+    // The body (following the 8-byte prefix, and the FlatBuffer metadata) is each column, padded to 8 bytes.
+    QCOMPARE(buffer.right(40), QByteArray::fromHex(
+        "00401e18240a0600" "e8431e18240a0600" "0000c03f000080be" "0101000000000000" "0202000000000000"));
+
+    // Empty batches (such as from zero-sample notifications) are still valid.
+    buffer.clear();
+    AbstractCommand::writeArrowRecordBatch(buffer, { }, { }, 1, 2);
+    QVERIFY(buffer.startsWith(QByteArray::fromHex("ffffffff")));
+    QCOMPARE(buffer.size() % 8, 0);
+}
+
+void TestAbstractCommand::writeArrowEndOfStream()
+{
+    QByteArray buffer("abc");
+    AbstractCommand::writeArrowEndOfStream(buffer);
+    QCOMPARE(buffer, QByteArray("abc") + QByteArray::fromHex("ffffffff00000000"));
+}
+
+void TestAbstractCommand::output()
+{
+    const OutputStreamCapture capture(&std::cout);
+    {
+        MockCommand mock;
+        mock.output(QByteArray("one,"));
+        mock.output(u"two,"_s);
+        mock.output(QString::fromUtf8("°C"));
+        QCOMPARE(capture.data(), std::string()); // Nothing written until flushed.
+        QCOMPARE(mock.outputBuffer, QByteArray("one,two,") + QString::fromUtf8("°C").toUtf8());
+    }
+    QCOMPARE(capture.data(), (QByteArray("one,two,") + QString::fromUtf8("°C").toUtf8()).toStdString());
+}
+
+void TestAbstractCommand::outputArrowRecordBatch()
+{
+    QByteArray expected;
+    AbstractCommand::writeArrowSchema(expected);
+    AbstractCommand::writeArrowRecordBatch(expected, { 1000 }, { 1.5f }, 1, 2);
+    AbstractCommand::writeArrowRecordBatch(expected, { 2000, 3000 }, { 2.5f, 3.5f }, 3, 4);
+
+    const OutputStreamCapture capture(&std::cout);
+    {
+        MockCommand mock;
+        mock.outputArrowRecordBatch({ 1000 }, { 1.5f }, 1, 2); // Preceded by the schema.
+        mock.outputArrowRecordBatch({ 2000, 3000 }, { 2.5f, 3.5f }, 3, 4); // But only once.
+        QCOMPARE(mock.outputBuffer, expected);
+    }
+    AbstractCommand::writeArrowEndOfStream(expected); // Written by the destructor.
+    QCOMPARE(capture.data(), expected.toStdString());
+}
+
+void TestAbstractCommand::outputBatchComplete_data()
+{
+    QTest::addColumn<AbstractCommand::FlushPolicy>("policy");
+    QTest::addColumn<quint32>("size");
+    QTest::addColumn<QStringList>("expected"); // Expected stdout after each of three 4-byte batches.
+
+    QTest::addRow("batch") << AbstractCommand::FlushPolicy::Batch << (quint32)0
+        << QStringList{ u"abc\n"_s, u"abc\nabc\n"_s, u"abc\nabc\nabc\n"_s };
+    QTest::addRow("size") << AbstractCommand::FlushPolicy::Size << (quint32)6
+        << QStringList{ QString(), u"abc\nabc\n"_s, u"abc\nabc\n"_s };
+    QTest::addRow("exit") << AbstractCommand::FlushPolicy::Exit << (quint32)0
+        << QStringList{ QString(), QString(), QString() };
+}
+
+void TestAbstractCommand::outputBatchComplete()
+{
+    QFETCH(AbstractCommand::FlushPolicy, policy);
+    QFETCH(quint32, size);
+    QFETCH(QStringList, expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    {
+        MockCommand mock;
+        mock.flushPolicy = policy;
+        mock.flushSize = size;
+        for (const QString &batch: expected) {
+            mock.output(u"abc\n"_s);
+            mock.outputBatchComplete();
+            QCOMPARE(QString::fromStdString(capture.data()), batch);
+        }
+    }
+    QCOMPARE(QString::fromStdString(capture.data()), u"abc\nabc\nabc\n"_s); // All flushed on destruction.
+}
+
+void TestAbstractCommand::outputBatchComplete_latency()
+{
+    const OutputStreamCapture capture(&std::cout);
+    MockCommand mock;
+    mock.flushPolicy = AbstractCommand::FlushPolicy::Size;
+    mock.flushSize = 6;
+
+    // Nothing is tracked until enabled, nor for batches without a receive time, or without output.
+    mock.output(u"abc\n"_s);
+    mock.outputBatchComplete(AbstractCommand::steadyTimestamp());
+    QVERIFY(mock.formatLatency.isEmpty());
+    mock.latencyTracking = true;
+    mock.outputBatchComplete();
+    mock.flushOutput();
+    mock.outputBatchComplete(AbstractCommand::steadyTimestamp());
+    QVERIFY(mock.formatLatency.isEmpty());
+    QVERIFY(mock.writeLatency.isEmpty());
+
+    // Each batch's write latency is only recorded once its output is written (here, per the flush size).
+    const qint64 receivedAt = AbstractCommand::steadyTimestamp() - 1'000'000; // 1ms ago.
+    mock.output(u"abc\n"_s);
+    mock.outputBatchComplete(receivedAt);
+    QCOMPARE(mock.formatLatency.count(), (quint64)1);
+    QVERIFY(mock.formatLatency.minimum() >= 1'000'000);
+    QVERIFY(mock.writeLatency.isEmpty());
+    mock.output(u"abc\n"_s);
+    mock.outputBatchComplete(receivedAt);
+    QCOMPARE(mock.formatLatency.count(), (quint64)2);
+    QCOMPARE(mock.writeLatency.count(), (quint64)2);
+    QVERIFY(mock.writeLatency.minimum() >= mock.formatLatency.minimum());
+    QVERIFY(mock.unwrittenBatches.isEmpty());
+}
+
+void TestAbstractCommand::flushOutput()
+{
+    const OutputStreamCapture capture(&std::cout);
+    MockCommand mock;
+    mock.flushOutput(); // Nothing to flush.
+    QCOMPARE(capture.data(), std::string());
+    mock.output(QByteArray("abc"));
+    const auto capacity = mock.outputBuffer.capacity();
+    mock.flushOutput();
+    QCOMPARE(capture.data(), std::string("abc"));
+    QVERIFY(mock.outputBuffer.isEmpty());
+    QCOMPARE(mock.outputBuffer.capacity(), capacity); // Capacity is retained for re-use.
+}
+
 void TestAbstractCommand::parseMicroValue_data()
 {
     QTest::addColumn<QString>("value");
@@ -193,11 +586,86 @@ void TestAbstractCommand::parseWholeValue()
     QCOMPARE(actual, expected);
 }
 
+void TestAbstractCommand::parseDeviceList_data()
+{
+    QTest::addColumn<QStringList>("values");
+    QTest::addColumn<QStringList>("expected");
+    QTest::addRow("none")     << QStringList{ } << QStringList{ };
+    QTest::addRow("single")   << QStringList{ u"alpha"_s } << QStringList{ u"alpha"_s };
+    QTest::addRow("repeated") << QStringList{ u"alpha"_s, u"beta"_s } << QStringList{ u"alpha"_s, u"beta"_s };
+    QTest::addRow("list")     << QStringList{ u"alpha, beta,,gamma"_s, u"alpha"_s }
+                              << QStringList{ u"alpha"_s, u"beta"_s, u"gamma"_s };
+    QTest::addRow("empty")    << QStringList{ u" , "_s } << QStringList{ };
+}
+
+void TestAbstractCommand::parseDeviceList()
+{
+    QFETCH(QStringList, values);
+    QFETCH(QStringList, expected);
+    QCOMPARE(AbstractCommand::parseDeviceList(values), expected);
+}
+
+void TestAbstractCommand::readDeviceList()
+{
+    QBuffer buffer;
+    buffer.setData("# Bench A\nalpha\r\nbeta, gamma # Bench B\n\n#delta\n  alpha  ");
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QCOMPARE(AbstractCommand::readDeviceList(buffer), (QStringList{ u"alpha"_s, u"beta"_s, u"gamma"_s }));
+}
+
+void TestAbstractCommand::isMatchingDevice_data()
+{
+    const QBluetoothUuid uuid(QUuid::createUuid());
+    const QBluetoothDeviceInfo byAddress(QBluetoothAddress(u"11:22:33:44:55:66"_s), u"Pokit"_s, 0);
+    const QBluetoothDeviceInfo byUuid(uuid, u"Pokit"_s, 0);
+
+    QTest::addColumn<QBluetoothDeviceInfo>("info");
+    QTest::addColumn<QString>("device");
+    QTest::addColumn<bool>("expected");
+    QTest::addRow("any")           << byAddress << QString()                   << true;
+    QTest::addRow("name")          << byAddress << u"Pokit"_s                  << true;
+    QTest::addRow("address")       << byAddress << u"11:22:33:44:55:66"_s      << true;
+    QTest::addRow("uuid")          << byUuid    << uuid.toString()             << true;
+    QTest::addRow("other name")    << byAddress << u"Other"_s                  << false;
+    QTest::addRow("other address") << byAddress << u"66:55:44:33:22:11"_s      << false;
+    QTest::addRow("other uuid")    << byUuid    << QUuid::createUuid().toString() << false;
+}
+
+void TestAbstractCommand::isMatchingDevice()
+{
+    QFETCH(QBluetoothDeviceInfo, info);
+    QFETCH(QString, device);
+    QFETCH(bool, expected);
+    QCOMPARE(AbstractCommand::isMatchingDevice(info, device), expected);
+}
+
+void TestAbstractCommand::takeDevice()
+{
+    MockCommand mock;
+    mock.devicesToScanFor = QStringList{ u"alpha"_s, u"11:22:33:44:55:66"_s };
+
+    // Non-requested devices are not taken.
+    QCOMPARE(mock.takeDevice(QBluetoothDeviceInfo(QBluetoothAddress(), u"other"_s, 0)), QString());
+    QCOMPARE(mock.devicesToScanFor.size(), 2);
+
+    // Requested devices are taken, (only) once each.
+    const QBluetoothDeviceInfo beta(QBluetoothAddress(u"11:22:33:44:55:66"_s), u"beta"_s, 0);
+    QCOMPARE(mock.takeDevice(beta), u"11:22:33:44:55:66"_s);
+    QCOMPARE(mock.devicesToScanFor, QStringList{ u"alpha"_s });
+    QCOMPARE(mock.takeDevice(beta), QString());
+
+    // Taking the last requested device stops discovery (which is safe, even if not started).
+    QCOMPARE(mock.takeDevice(QBluetoothDeviceInfo(QBluetoothAddress(), u"alpha"_s, 0)), u"alpha"_s);
+    QVERIFY(mock.devicesToScanFor.isEmpty());
+    QVERIFY(!mock.discoveryAgent->isActive());
+}
+
 void TestAbstractCommand::processOptions()
 {
     QCommandLineParser parser;
     QVERIFY(parser.addOptions({
         { u"device"_s,       u"desc"_s, u"value"_s },
+        { u"flush"_s,        u"desc"_s, u"value"_s },
         { u"mockRequired"_s, u"desc"_s, u"value"_s },
         { u"output"_s,       u"desc"_s, u"value"_s },
         { u"timeout"_s,      u"desc"_s, u"value"_s },
@@ -233,6 +701,34 @@ void TestAbstractCommand::processOptions()
     QVERIFY(errors.isEmpty());
 }
 
+void TestAbstractCommand::processOptions_asyncLog_data()
+{
+    QTest::addColumn<QString>("argument");
+    QTest::addColumn<QStringList>("expectedErrors");
+    QTest::addRow("0")       << u"0"_s    << QStringList{ };
+    QTest::addRow("1000")    << u"1000"_s << QStringList{ };
+    QTest::addRow("<empty>") << QString() << QStringList{ u"Invalid async log rate limit: "_s };
+    QTest::addRow("-1")      << u"-1"_s   << QStringList{ u"Invalid async log rate limit: -1"_s };
+    QTest::addRow("1k")      << u"1k"_s   << QStringList{ u"Invalid async log rate limit: 1k"_s };
+}
+
+void TestAbstractCommand::processOptions_asyncLog()
+{
+    QFETCH(QString, argument);
+    QFETCH(QStringList, expectedErrors);
+
+    QCommandLineParser parser;
+    QVERIFY(parser.addOptions({
+        { u"async-log"_s,    u"desc"_s, u"value"_s },
+        { u"mockRequired"_s, u"desc"_s, u"value"_s },
+    }));
+    QVERIFY(parser.parse(QStringList{ u"executableName"_s, u"--mockRequired=abc123"_s,
+                                      u"--async-log"_s, argument }));
+
+    MockCommand mock;
+    QCOMPARE(mock.processOptions(parser), expectedErrors);
+}
+
 void TestAbstractCommand::processOptions_device_data()
 {
     QTest::addColumn<QString>("device");
@@ -247,6 +743,7 @@ void TestAbstractCommand::processOptions_device()
     QCommandLineParser parser;
     QVERIFY(parser.addOptions({
         { u"device"_s,       u"desc"_s, u"value"_s },
+        { u"flush"_s,        u"desc"_s, u"value"_s },
         { u"mockRequired"_s, u"desc"_s, u"value"_s },
         { u"output"_s,       u"desc"_s, u"value"_s },
         { u"timeout"_s,      u"desc"_s, u"value"_s },
@@ -264,6 +761,62 @@ void TestAbstractCommand::processOptions_device()
     QCOMPARE(mock.deviceToScanFor, device);
 }
 
+void TestAbstractCommand::processOptions_flush_data()
+{
+    QTest::addColumn<QString>("argument");
+    QTest::addColumn<AbstractCommand::FlushPolicy>("expected");
+    QTest::addColumn<quint32>("expectedSize");
+    QTest::addColumn<bool>("expectErrors");
+
+    // Valid values.
+    QTest::addRow("batch") << u"batch"_s << AbstractCommand::FlushPolicy::Batch << (quint32)0     << false;
+    QTest::addRow("BATCH") << u"BATCH"_s << AbstractCommand::FlushPolicy::Batch << (quint32)0     << false;
+    QTest::addRow("exit")  << u"exit"_s  << AbstractCommand::FlushPolicy::Exit  << (quint32)0     << false;
+    QTest::addRow("eXiT")  << u"eXiT"_s  << AbstractCommand::FlushPolicy::Exit  << (quint32)0     << false;
+    QTest::addRow("1")     << u"1"_s     << AbstractCommand::FlushPolicy::Size  << (quint32)1     << false;
+    QTest::addRow("4096")  << u"4096"_s  << AbstractCommand::FlushPolicy::Size  << (quint32)4096  << false;
+    QTest::addRow("64K")   << u"64K"_s   << AbstractCommand::FlushPolicy::Size  << (quint32)64000 << false;
+    QTest::addRow("64kB")  << u"64kB"_s  << AbstractCommand::FlushPolicy::Size  << (quint32)64000 << false;
+
+    // Invalid values should all remain as the default Batch.
+    QTest::addRow("<empty>") << QString() << AbstractCommand::FlushPolicy::Batch << (quint32)0 << true;
+    QTest::addRow("0")       << u"0"_s    << AbstractCommand::FlushPolicy::Batch << (quint32)0 << true;
+    QTest::addRow("-1")      << u"-1"_s   << AbstractCommand::FlushPolicy::Batch << (quint32)0 << true;
+    QTest::addRow("foo")     << u"foo"_s  << AbstractCommand::FlushPolicy::Batch << (quint32)0 << true;
+}
+
+void TestAbstractCommand::processOptions_flush()
+{
+    QFETCH(QString, argument);
+    QFETCH(AbstractCommand::FlushPolicy, expected);
+    QFETCH(quint32, expectedSize);
+    QFETCH(bool, expectErrors);
+
+    QCommandLineParser parser;
+    QVERIFY(parser.addOptions({
+        { u"device"_s,       u"desc"_s, u"value"_s },
+        { u"flush"_s,        u"desc"_s, u"value"_s },
+        { u"mockRequired"_s, u"desc"_s, u"value"_s },
+        { u"output"_s,       u"desc"_s, u"value"_s },
+        { u"timeout"_s,      u"desc"_s, u"value"_s },
+    }));
+    QVERIFY(parser.parse(QStringList{
+        u"executableName"_s,
+        u"--mockRequired=abc123"_s,
+        u"--flush"_s, argument
+    }));
+
+    MockCommand mock;
+    QCOMPARE(mock.flushPolicy, AbstractCommand::FlushPolicy::Batch); // The default policy is Batch.
+    const QStringList errors = mock.processOptions(parser);
+    QCOMPARE(!errors.isEmpty(), expectErrors);
+    QCOMPARE(mock.flushPolicy, expected);
+    QCOMPARE(mock.flushSize, expectedSize);
+    if (expected == AbstractCommand::FlushPolicy::Size) {
+        QVERIFY(mock.outputBuffer.capacity() >= (qsizetype)expectedSize);
+    }
+}
+
 void TestAbstractCommand::processOptions_output_data()
 {
     QTest::addColumn<QString>("argument");
@@ -286,6 +839,15 @@ void TestAbstractCommand::processOptions_output_data()
     QTest::addRow("foo")     << u"foo"_s << AbstractCommand::OutputFormat::Text << true;
     QTest::addRow("bar")     << u"bar"_s << AbstractCommand::OutputFormat::Text << true;
     QTest::addRow("tsv")     << u"tsv"_s << AbstractCommand::OutputFormat::Text << true;
+
+    // Binary is only supported by commands that opt in, which MockCommand does not.
+    QTest::addRow("binary")  << u"binary"_s << AbstractCommand::OutputFormat::Text << true;
+
+    // The same goes for Arrow, NDJSON, and its envelope variant.
+    QTest::addRow("arrow")           << u"arrow"_s           << AbstractCommand::OutputFormat::Text << true;
+    QTest::addRow("line-protocol")   << u"line-protocol"_s   << AbstractCommand::OutputFormat::Text << true;
+    QTest::addRow("ndjson")          << u"ndjson"_s          << AbstractCommand::OutputFormat::Text << true;
+    QTest::addRow("ndjson-envelope") << u"ndjson-envelope"_s << AbstractCommand::OutputFormat::Text << true;
 }
 
 void TestAbstractCommand::processOptions_output()
@@ -297,6 +859,7 @@ void TestAbstractCommand::processOptions_output()
     QCommandLineParser parser;
     QVERIFY(parser.addOptions({
         { u"device"_s,       u"desc"_s, u"value"_s },
+        { u"flush"_s,        u"desc"_s, u"value"_s },
         { u"mockRequired"_s, u"desc"_s, u"value"_s },
         { u"output"_s,       u"desc"_s, u"value"_s },
         { u"timeout"_s,      u"desc"_s, u"value"_s },
@@ -314,6 +877,179 @@ void TestAbstractCommand::processOptions_output()
     QCOMPARE(mock.format, expected);
 }
 
+void TestAbstractCommand::processOptions_outputFile_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("file")
+        << QStringList{ u"--output-file"_s, u"out.csv"_s } << QStringList{};
+    QTest::addRow("rotate")
+        << QStringList{ u"--output-file"_s, u"out.csv"_s, u"--rotate-size"_s, u"100M"_s,
+                        u"--rotate-interval"_s, u"3600"_s }
+        << QStringList{};
+    QTest::addRow("invalid-size")
+        << QStringList{ u"--output-file"_s, u"out.csv"_s, u"--rotate-size"_s, u"big"_s }
+        << QStringList{ u"Invalid rotate size: big"_s };
+    QTest::addRow("invalid-interval")
+        << QStringList{ u"--output-file"_s, u"out.csv"_s, u"--rotate-interval"_s, u"0"_s }
+        << QStringList{ u"Invalid rotate interval: 0"_s };
+    QTest::addRow("missing-file")
+        << QStringList{ u"--rotate-size"_s, u"1M"_s }
+        << QStringList{ u"Missing required option for --rotate-size: --output-file"_s };
+}
+
+void TestAbstractCommand::processOptions_outputFile()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedErrors);
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    for (QString &argument: arguments) {
+        if (argument == u"out.csv"_s) {
+            argument = dir.filePath(argument);
+        }
+    }
+
+    QCommandLineParser parser;
+    QVERIFY(parser.addOptions({
+        { u"mockRequired"_s,    u"desc"_s, u"value"_s },
+        { u"output-file"_s,     u"desc"_s, u"value"_s },
+        { u"rotate-interval"_s, u"desc"_s, u"value"_s },
+        { u"rotate-size"_s,     u"desc"_s, u"value"_s },
+    }));
+    QVERIFY(parser.parse(QStringList{ u"executableName"_s, u"--mockRequired=abc123"_s } + arguments));
+
+    {
+        MockCommand mock;
+        QCOMPARE(mock.processOptions(parser), expectedErrors);
+        if (!expectedErrors.isEmpty()) {
+            QVERIFY(!mock.outputFile);
+            return;
+        }
+        QVERIFY(mock.outputFile);
+        QVERIFY(mock.outputFile->isOpen());
+
+        // Output goes to the file, instead of stdout.
+        const OutputStreamCapture capture(&std::cout);
+        mock.output(QByteArray("abc\n"));
+        mock.outputBatchComplete();
+        QVERIFY(mock.outputBuffer.isEmpty());
+        QVERIFY(mock.outputBuffer.capacity() >= 4096); // Capacity is retained for re-use.
+        mock.output(QByteArray("def\n"));
+        mock.outputBatchComplete();
+        QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray());
+    } // Destroying the command closes the file, once all queued output has been written.
+
+    QFile file(dir.filePath(u"out.csv"_s));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("abc\ndef\n"));
+}
+
+void TestAbstractCommand::processOptions_backpressure_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<int>("expectedPolicy");
+    QTest::addColumn<QString>("expectedFileName");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("stdout")
+        << QStringList{} << -1 << QString() << QStringList{};
+    QTest::addRow("block") << QStringList{ u"--backpressure"_s, u"block"_s }
+        << (int)OutputFileWriter::OverflowPolicy::Block << u"stdout"_s << QStringList{};
+    QTest::addRow("drop-oldest") << QStringList{ u"--backpressure"_s, u"Drop-Oldest"_s }
+        << (int)OutputFileWriter::OverflowPolicy::DropOldest << u"stdout"_s << QStringList{};
+    QTest::addRow("file") << QStringList{ u"--output-file"_s, u"out.csv"_s }
+        << (int)OutputFileWriter::OverflowPolicy::DropNewest << u"out.csv"_s << QStringList{};
+    QTest::addRow("file-decimate")
+        << QStringList{ u"--output-file"_s, u"out.csv"_s, u"--backpressure"_s, u"decimate"_s }
+        << (int)OutputFileWriter::OverflowPolicy::Decimate << u"out.csv"_s << QStringList{};
+    QTest::addRow("invalid") << QStringList{ u"--backpressure"_s, u"drop-everything"_s }
+        << -1 << QString() << QStringList{ u"Unknown backpressure policy: drop-everything"_s };
+}
+
+void TestAbstractCommand::processOptions_backpressure()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(int, expectedPolicy);
+    QFETCH(QString, expectedFileName);
+    QFETCH(QStringList, expectedErrors);
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    for (QString &argument: arguments) {
+        if (argument == u"out.csv"_s) {
+            argument = dir.filePath(argument);
+        }
+    }
+
+    QCommandLineParser parser;
+    QVERIFY(parser.addOptions({
+        { u"backpressure"_s, u"desc"_s, u"value"_s },
+        { u"mockRequired"_s, u"desc"_s, u"value"_s },
+        { u"output-file"_s,  u"desc"_s, u"value"_s },
+    }));
+    QVERIFY(parser.parse(QStringList{ u"executableName"_s, u"--mockRequired=abc123"_s } + arguments));
+
+    MockCommand mock;
+    QCOMPARE(mock.processOptions(parser), expectedErrors);
+    if (expectedPolicy < 0) {
+        QVERIFY(!mock.outputFile); // Written to stdout directly, as ever.
+        return;
+    }
+    QVERIFY(mock.outputFile);
+    QVERIFY(mock.outputFile->isOpen());
+    QCOMPARE((int)mock.outputFile->overflowPolicy(), expectedPolicy);
+    QCOMPARE(QFileInfo(mock.outputFile->fileName()).fileName(), QFileInfo(expectedFileName).fileName());
+}
+
+void TestAbstractCommand::processOptions_memoryBudget_data()
+{
+    QTest::addColumn<QString>("argument");
+    QTest::addColumn<qint64>("expectedLimit");
+    QTest::addColumn<qint64>("expectedQuota");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("limit") << u"256M"_s << (qint64)256'000'000 << (qint64)0 << QStringList{};
+    QTest::addRow("quota") << u"1M,64k"_s << (qint64)1'000'000 << (qint64)64'000 << QStringList{};
+    QTest::addRow("bytes") << u"4096,1024"_s << (qint64)4096 << (qint64)1024 << QStringList{};
+
+    QTest::addRow("zero") << u"0"_s << (qint64)0 << (qint64)0
+        << QStringList{ u"Invalid memory budget: 0"_s };
+    QTest::addRow("invalid") << u"lots"_s << (qint64)0 << (qint64)0
+        << QStringList{ u"Invalid memory budget: lots"_s };
+    QTest::addRow("quotaOverLimit") << u"1M,2M"_s << (qint64)0 << (qint64)0
+        << QStringList{ u"Invalid memory budget: 1M,2M"_s };
+    QTest::addRow("tooMany") << u"1M,1k,1k"_s << (qint64)0 << (qint64)0
+        << QStringList{ u"Invalid memory budget: 1M,1k,1k"_s };
+}
+
+void TestAbstractCommand::processOptions_memoryBudget()
+{
+    QFETCH(QString, argument);
+    QFETCH(qint64, expectedLimit);
+    QFETCH(qint64, expectedQuota);
+    QFETCH(QStringList, expectedErrors);
+
+    QCommandLineParser parser;
+    QVERIFY(parser.addOptions({
+        { u"memory-budget"_s, u"desc"_s, u"value"_s },
+        { u"mockRequired"_s,  u"desc"_s, u"value"_s },
+    }));
+    QVERIFY(parser.parse(QStringList{ u"executableName"_s, u"--mockRequired=abc123"_s,
+                                      u"--memory-budget"_s, argument }));
+
+    MockCommand mock;
+    QCOMPARE(mock.processOptions(parser), expectedErrors);
+    QCOMPARE(MemoryBudget::global()->limit(), expectedLimit);
+    QCOMPARE(MemoryBudget::global()->defaultQuota(), expectedQuota);
+
+    // Restore the (unbounded) default, so as not to constrain any other tests' buffers.
+    MemoryBudget::global()->setLimit(0);
+    MemoryBudget::global()->setDefaultQuota(0);
+}
+
 void TestAbstractCommand::processOptions_timeout_data()
 {
     QTest::addColumn<QString>("argument");
@@ -347,6 +1083,7 @@ void TestAbstractCommand::processOptions_timeout()
     QCommandLineParser parser;
     QVERIFY(parser.addOptions({
         { u"device"_s,       u"desc"_s, u"value"_s },
+        { u"flush"_s,        u"desc"_s, u"value"_s },
         { u"mockRequired"_s, u"desc"_s, u"value"_s },
         { u"output"_s,       u"desc"_s, u"value"_s },
         { u"timeout"_s,      u"desc"_s, u"value"_s },
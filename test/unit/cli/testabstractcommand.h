@@ -15,6 +15,44 @@ private slots:
     void escapeCsvField_data();
     void escapeCsvField();
 
+    void escapeJsonString_data();
+    void escapeJsonString();
+
+    void escapeLineProtocolTag_data();
+    void escapeLineProtocolTag();
+
+    void formatJsonNumber_data();
+    void formatJsonNumber();
+
+    void appendNumber_data();
+    void appendNumber();
+    void appendNumber_shortest();
+    void appendNumber_integer();
+    void appendJsonNumber();
+
+    void binaryRecordSize();
+
+    void writeBinaryHeader();
+
+    void writeBinarySamples();
+    void writeBinary_allocations();
+
+    void writeArrowSchema();
+
+    void writeArrowRecordBatch();
+
+    void writeArrowEndOfStream();
+
+    void output();
+
+    void outputArrowRecordBatch();
+
+    void outputBatchComplete_data();
+    void outputBatchComplete();
+    void outputBatchComplete_latency();
+
+    void flushOutput();
+
     void parseMicroValue_data();
     void parseMicroValue();
 
@@ -24,14 +62,38 @@ private slots:
     void parseWholeValue_data();
     void parseWholeValue();
 
+    void parseDeviceList_data();
+    void parseDeviceList();
+
+    void readDeviceList();
+
+    void isMatchingDevice_data();
+    void isMatchingDevice();
+
+    void takeDevice();
+
     void processOptions();
 
+    void processOptions_asyncLog_data();
+    void processOptions_asyncLog();
+
     void processOptions_device_data();
     void processOptions_device();
 
+    void processOptions_flush_data();
+    void processOptions_flush();
+
     void processOptions_output_data();
     void processOptions_output();
 
+    void processOptions_outputFile_data();
+    void processOptions_outputFile();
+    void processOptions_backpressure_data();
+    void processOptions_backpressure();
+
+    void processOptions_memoryBudget_data();
+    void processOptions_memoryBudget();
+
     void processOptions_timeout_data();
     void processOptions_timeout();
 
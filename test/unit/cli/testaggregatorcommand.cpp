@@ -0,0 +1,453 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testaggregatorcommand.h"
+#include "../stringliterals_p.h"
+
+#include "aggregatorcommand.h"
+
+#include <qtpokit/samplecodec.h>
+
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTcpSocket>
+
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+// Returns \a json parsed as an object.
+QJsonObject object(const QByteArray &json)
+{
+    return QJsonDocument::fromJson(json).object();
+}
+
+// Returns \a object as compact JSON.
+QByteArray compact(const QJsonObject &object)
+{
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+}
+
+void TestAggregatorCommand::requiredOptions()
+{
+    AggregatorCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"listen"_s });
+}
+
+void TestAggregatorCommand::supportedOptions()
+{
+    AggregatorCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"socket"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestAggregatorCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QString>("expectedSocketName");
+    QTest::addColumn<QString>("expectedAddress");
+    QTest::addColumn<int>("expectedPort");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("missing-listen")
+        << QStringList{ }
+        << u"dokit-aggregator"_s << QString() << 0 << QStringList{ u"Missing required option: listen"_s };
+    QTest::addRow("port")
+        << QStringList{ u"--listen"_s, u"9465"_s }
+        << u"dokit-aggregator"_s << u"127.0.0.1"_s << 9465 << QStringList{};
+    QTest::addRow("options")
+        << QStringList{ u"--listen"_s, u"*:9465"_s, u"--socket"_s, u"/tmp/cluster.sock"_s }
+        << u"/tmp/cluster.sock"_s << QHostAddress(QHostAddress::Any).toString() << 9465 << QStringList{};
+    QTest::addRow("invalid-socket")
+        << QStringList{ u"--listen"_s, u"9465"_s, u"--socket"_s, u" "_s }
+        << QString() << u"127.0.0.1"_s << 9465 << QStringList{ u"Invalid socket name:  "_s };
+    QTest::addRow("invalid-listen")
+        << QStringList{ u"--listen"_s, u"localhost:0"_s }
+        << u"dokit-aggregator"_s << QString() << 0 << QStringList{ u"Invalid listen value: localhost:0"_s };
+}
+
+void TestAggregatorCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QString, expectedSocketName);
+    QFETCH(QString, expectedAddress);
+    QFETCH(int, expectedPort);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"listen"_s, u"description"_s, u"address"_s, u"localhost:9464"_s});
+    parser.addOption({u"socket"_s, u"description"_s, u"name"_s});
+    parser.process(arguments);
+
+    AggregatorCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.socketName, expectedSocketName);
+    QCOMPARE(command.listenAddress.toString(), expectedAddress);
+    QCOMPARE((int)command.listenPort, expectedPort);
+}
+
+void TestAggregatorCommand::handleRequest_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("missing-command")
+        << QByteArray(R"({"id":1})")
+        << QByteArray(R"({"error":"Missing command","id":1,"ok":false})");
+    QTest::addRow("unknown-command")
+        << QByteArray(R"({"id":"a","command":"assign"})")
+        << QByteArray(R"({"error":"Unknown command: assign","id":"a","ok":false})");
+    QTest::addRow("devices")
+        << QByteArray(R"({"id":2,"command":"devices"})")
+        << QByteArray(R"({"devices":[],"id":2,"ok":true})");
+    QTest::addRow("gateways")
+        << QByteArray(R"({"id":3,"command":"gateways"})")
+        << QByteArray(R"({"gateways":[],"id":3,"ok":true})");
+    QTest::addRow("unsubscribe")
+        << QByteArray(R"({"command":"unsubscribe"})")
+        << QByteArray(R"({"ok":true,"unsubscribed":0})");
+    QTest::addRow("status-no-devices")
+        << QByteArray(R"({"id":4,"command":"status"})")
+        << QByteArray(R"({"error":"No devices found","id":4,"ok":false})");
+    QTest::addRow("meter-unknown-device")
+        << QByteArray(R"({"id":5,"command":"meter","device":"foo","mode":"Vdc"})")
+        << QByteArray(R"({"error":"Device not found: \"foo\"","id":5,"ok":false})");
+    QTest::addRow("dso-invalid-encoding")
+        << QByteArray(R"({"id":6,"command":"dso","mode":"Vdc","encoding":"zstd"})")
+        << QByteArray(R"({"error":"Unsupported encoding: zstd (supported: json, delta-varint, delta-varint-zlib)",)"
+                      R"("id":6,"ok":false})");
+}
+
+void TestAggregatorCommand::handleRequest()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(QByteArray, expected);
+    AggregatorCommand command;
+    QCOMPARE(compact(command.handleRequest(nullptr, object(request))), expected);
+    QVERIFY(command.routes.isEmpty());
+}
+
+void TestAggregatorCommand::routing()
+{
+    AggregatorCommand command;
+    QTcpSocket gateway; // Never connected, since only used to identify the gateway.
+    command.gateways.insert(&gateway, { u"lab-1"_s, 2, {
+        { u"AA"_s, { object(R"({"key":"AA","name":"Pokit","rssi":-50})"), -50 } } }, { u"AA"_s } });
+    command.owners.insert(u"AA"_s, &gateway);
+    QBuffer client;
+    QVERIFY(client.open(QIODevice::ReadWrite));
+
+    // An unassigned device.
+    command.owners.clear();
+    QCOMPARE(compact(command.handleRequest(&client, object(R"({"id":"x","command":"status","device":"AA"})"))),
+             QByteArray(R"({"error":"No gateway has capacity for device \"AA\"","id":"x","ok":false})"));
+    command.owners.insert(u"AA"_s, &gateway);
+
+    // A subscription, by device name, forwarded with a new ID.
+    QVERIFY(command.handleRequest(&client, object(R"({"id":"m","command":"meter","device":"Pokit","mode":"Vdc"})"))
+        .isEmpty());
+    QCOMPARE(command.routes.size(), 1);
+    QCOMPARE(command.lastRouteId, (quint32)1);
+    QCOMPARE(command.routes.value(1).client.data(), &client);
+    QCOMPARE(command.routes.value(1).device, u"AA"_s);
+    QVERIFY(command.routes.value(1).encoding.isNull());
+    QVERIFY(command.routes.value(1).persistent);
+
+    // The response, and events, are routed back with the client's own ID.
+    command.handleMessage(&gateway, object(R"({"id":1,"ok":true})"));
+    command.handleMessage(&gateway, object(R"({"event":"reading","id":1,"value":1.5})"));
+    command.handleMessage(&gateway, object(R"({"event":"reading","id":9,"value":2.5})")); // Unknown, so ignored.
+    QCOMPARE(client.data(), QByteArray(R"({"id":"m","ok":true})" "\n" R"({"event":"reading","id":"m","value":1.5})"
+                                       "\n"));
+    QVERIFY(command.routes.value(1).answered);
+
+    // Responses from other gateways are ignored.
+    QTcpSocket other;
+    command.gateways.insert(&other, { u"lab-2"_s, 1, {}, {} });
+    command.handleMessage(&other, object(R"({"event":"reading","id":1,"value":3.5})"));
+    QCOMPARE(client.data().count('\n'), 2);
+
+    // A one-off request, completed by its response.
+    client.buffer().clear();
+    client.seek(0);
+    QVERIFY(command.handleRequest(&client, object(R"({"id":7,"command":"dso","mode":"Vdc"})")).isEmpty());
+    QCOMPARE(command.routes.size(), 2);
+    QCOMPARE(command.routes.value(2).encoding, u"json"_s);
+    QVERIFY(!command.routes.value(2).persistent);
+    command.handleMessage(&gateway, object(R"({"error":"Busy","id":2,"ok":false})"));
+    QCOMPARE(client.data(), QByteArray(R"({"error":"Busy","id":7,"ok":false})" "\n"));
+    QCOMPARE(command.routes.size(), 1);
+
+    // Unsubscribing removes the subscription.
+    QCOMPARE(compact(command.handleRequest(&client, object(R"({"id":8,"command":"unsubscribe","device":"AA"})"))),
+             QByteArray(R"({"id":8,"ok":true,"unsubscribed":1})"));
+    QVERIFY(command.routes.isEmpty());
+
+    // Gateways disconnecting fail their outstanding requests.
+    client.buffer().clear();
+    client.seek(0);
+    QVERIFY(command.handleRequest(&client, object(R"({"id":9,"command":"status"})")).isEmpty());
+    command.gatewayDisconnected(&gateway);
+    QCOMPARE(client.data(), QByteArray(R"({"device":"AA","error":"Gateway \"lab-1\" disconnected","id":9,)"
+                                       R"("ok":false})" "\n"));
+    QVERIFY(command.routes.isEmpty());
+    QVERIFY(!command.gateways.contains(&gateway));
+    QVERIFY(command.owners.isEmpty()); // Since the remaining gateway cannot see the device.
+}
+
+void TestAggregatorCommand::handoff()
+{
+    AggregatorCommand command;
+    QTcpSocket gateway1, gateway2; // Never connected, since only used to identify the gateways.
+    command.gateways.insert(&gateway1, { u"lab-1"_s, 2, {
+        { u"AA"_s, { object(R"({"key":"AA","name":"Pokit","rssi":-80})"), -80 } } }, { u"AA"_s } });
+    command.gateways.insert(&gateway2, { u"lab-2"_s, 2, {
+        { u"AA"_s, { object(R"({"key":"AA","name":"Pokit","rssi":-50})"), -50 } } }, { } });
+    command.owners.insert(u"AA"_s, &gateway1);
+    QBuffer client;
+    QVERIFY(client.open(QIODevice::ReadWrite));
+    QVERIFY(command.handleRequest(&client, object(R"({"id":"m","command":"meter","mode":"Vdc"})")).isEmpty());
+    command.handleMessage(&gateway1, object(R"({"id":1,"ok":true})"));
+
+    // The first report of a better gateway only starts the hold.
+    command.reassignDevices();
+    QCOMPARE(command.owners.value(u"AA"_s), &gateway1);
+    QCOMPARE(command.handoffs.value(u"AA"_s).gateway, u"lab-2"_s);
+
+    // Requests still in flight via the old gateway delay the handoff, even once the hold is over.
+    command.handoffs[u"AA"_s].since -= AggregatorCommand::handoffHold;
+    QVERIFY(command.handleRequest(&client, object(R"({"id":"d","command":"dso","mode":"Vdc"})")).isEmpty());
+    command.reassignDevices();
+    QCOMPARE(command.owners.value(u"AA"_s), &gateway1);
+    command.handleMessage(&gateway1, object(R"({"id":2,"ok":true,"values":[]})"));
+    QCOMPARE(command.routes.size(), 1);
+
+    // Then subscriptions move to the new gateway, once the old gateway has released the device.
+    client.buffer().clear();
+    client.seek(0);
+    command.reassignDevices();
+    QCOMPARE(command.owners.value(u"AA"_s), &gateway2);
+    QVERIFY(!command.handoffs.contains(u"AA"_s));
+    QCOMPARE(command.routes.value(1).gateway, &gateway2);
+    QVERIFY(command.routes.value(1).handoffAt >= 0);
+    QCOMPARE(client.data(), QByteArray(R"({"device":"AA","event":"handoff","from":"lab-1","id":"m","to":"lab-2"})"
+                                       "\n"));
+    QCOMPARE(command.releases.size(), 1);
+    QCOMPARE(command.releases.constBegin().key(), (quint32)3);
+    QCOMPARE(command.releases.constBegin()->devices, QStringList{ u"AA"_s });
+    command.handleMessage(&gateway1, object(R"({"event":"reading","id":1,"value":1.5})")); // Lost in the gap.
+    command.handleMessage(&gateway1, object(R"({"assigned":0,"id":3,"ok":true})"));
+    QVERIFY(command.releases.isEmpty());
+
+    // The new gateway's response marks the end of the gap, and its events follow.
+    client.buffer().clear();
+    client.seek(0);
+    command.handleMessage(&gateway2, object(R"({"id":1,"ok":true})"));
+    command.handleMessage(&gateway2, object(R"({"event":"reading","id":1,"value":2.5})"));
+    const QList<QByteArray> lines = client.data().split('\n');
+    QCOMPARE(lines.size(), 3);
+    const QJsonObject resumed = object(lines.at(0));
+    QCOMPARE(resumed.value(u"event"_s).toString(), u"resumed"_s);
+    QCOMPARE(resumed.value(u"id"_s).toString(), u"m"_s);
+    QCOMPARE(resumed.value(u"device"_s).toString(), u"AA"_s);
+    QCOMPARE(resumed.value(u"gateway"_s).toString(), u"lab-2"_s);
+    QVERIFY(resumed.value(u"gap"_s).toDouble() >= 0);
+    QCOMPARE(lines.at(1), QByteArray(R"({"event":"reading","id":"m","value":2.5})"));
+    QCOMPARE(command.routes.value(1).handoffAt, (qint64)-1);
+}
+
+void TestAggregatorCommand::devicesResponse()
+{
+    AggregatorCommand command;
+    QTcpSocket gateway1, gateway2, unregistered;
+    command.gateways.insert(&gateway1, { u"lab-1"_s, 2, {
+        { u"AA"_s, { object(R"({"key":"AA","rssi":-60})"), -60 } },
+        { u"BB"_s, { object(R"({"key":"BB","rssi":-70})"), -70 } } }, { u"BB"_s } });
+    command.gateways.insert(&gateway2, { u"lab-2"_s, 1, {
+        { u"AA"_s, { object(R"({"key":"AA","rssi":-40})"), -40 } } }, { u"AA"_s } });
+    command.gateways.insert(&unregistered, { });
+    command.owners.insert(u"AA"_s, &gateway2);
+    QCOMPARE(compact(command.devicesResponse(QJsonValue(1))), QByteArray(R"({"devices":[)"
+        R"({"gateway":"lab-2","gateways":[{"gateway":"lab-2","rssi":-40},{"gateway":"lab-1","rssi":-60}],)"
+        R"("key":"AA","rssi":-40},)"
+        R"({"gateway":null,"gateways":[{"gateway":"lab-1","rssi":-70}],"key":"BB","rssi":-70}],"id":1,"ok":true})"));
+}
+
+void TestAggregatorCommand::gatewaysResponse()
+{
+    AggregatorCommand command;
+    QTcpSocket gateway1, gateway2, unregistered;
+    command.gateways.insert(&gateway2, { u"lab-2"_s, 1, {
+        { u"AA"_s, { object(R"({"key":"AA"})"), -40 } } }, { u"AA"_s } });
+    command.gateways.insert(&gateway1, { u"lab-1"_s, 3, {}, {},
+        object(R"({"offset":0,"source":"ntp","synchronised":true,"uncertainty":1250})") });
+    command.gateways.insert(&unregistered, { });
+    QCOMPARE(compact(command.gatewaysResponse(QJsonValue())), QByteArray(R"({"gateways":[)"
+        R"({"address":"","assigned":0,"capacity":3,)"
+        R"("clock":{"offset":0,"source":"ntp","synchronised":true,"uncertainty":1250},"name":"lab-1","seen":0},)"
+        R"({"address":"","assigned":1,"capacity":1,"name":"lab-2","seen":1}],"ok":true})"));
+}
+
+void TestAggregatorCommand::assignDevices()
+{
+    using Assignment = QHash<QString, QString>;
+
+    // Each device goes to the gateway that hears it best.
+    QCOMPARE(AggregatorCommand::assignDevices(
+        { { u"AA"_s, { { u"lab-1"_s, -60 }, { u"lab-2"_s, -40 } } }, { u"BB"_s, { { u"lab-1"_s, -50 } } } },
+        { { u"lab-1"_s, 2 }, { u"lab-2"_s, 2 } }, { }),
+        (Assignment{ { u"AA"_s, u"lab-2"_s }, { u"BB"_s, u"lab-1"_s } }));
+
+    // Strongest signals first, overflowing to the next best gateway with capacity, or none at all.
+    QCOMPARE(AggregatorCommand::assignDevices(
+        { { u"AA"_s, { { u"lab-1"_s, -60 }, { u"lab-2"_s, -40 } } },
+          { u"BB"_s, { { u"lab-1"_s, -80 }, { u"lab-2"_s, -30 } } },
+          { u"CC"_s, { { u"lab-2"_s, -90 } } } },
+        { { u"lab-1"_s, 1 }, { u"lab-2"_s, 1 } }, { }),
+        (Assignment{ { u"AA"_s, u"lab-1"_s }, { u"BB"_s, u"lab-2"_s } }));
+
+    // Equal signals go to the first gateway, by name.
+    QCOMPARE(AggregatorCommand::assignDevices(
+        { { u"AA"_s, { { u"lab-2"_s, -50 }, { u"lab-1"_s, -50 } } } },
+        { { u"lab-1"_s, 1 }, { u"lab-2"_s, 1 } }, { }),
+        (Assignment{ { u"AA"_s, u"lab-1"_s } }));
+
+    // Devices stay with their current gateway, while it can still see them.
+    QCOMPARE(AggregatorCommand::assignDevices(
+        { { u"AA"_s, { { u"lab-1"_s, -70 }, { u"lab-2"_s, -40 } } } },
+        { { u"lab-1"_s, 1 }, { u"lab-2"_s, 1 } }, { { u"AA"_s, u"lab-1"_s } }),
+        (Assignment{ { u"AA"_s, u"lab-1"_s } }));
+    QCOMPARE(AggregatorCommand::assignDevices(
+        { { u"AA"_s, { { u"lab-2"_s, -40 } } } },
+        { { u"lab-1"_s, 1 }, { u"lab-2"_s, 1 } }, { { u"AA"_s, u"lab-1"_s } }),
+        (Assignment{ { u"AA"_s, u"lab-2"_s } }));
+
+    // Or until their current gateway is gone.
+    QCOMPARE(AggregatorCommand::assignDevices(
+        { { u"AA"_s, { { u"lab-1"_s, -70 }, { u"lab-2"_s, -40 } } } },
+        { { u"lab-2"_s, 1 } }, { { u"AA"_s, u"lab-1"_s } }),
+        (Assignment{ { u"AA"_s, u"lab-2"_s } }));
+    QCOMPARE(AggregatorCommand::assignDevices({ }, { { u"lab-1"_s, 1 } }, { }), Assignment{});
+
+    // Unless being handed off.
+    QCOMPARE(AggregatorCommand::assignDevices(
+        { { u"AA"_s, { { u"lab-1"_s, -70 }, { u"lab-2"_s, -40 } } }, { u"BB"_s, { { u"lab-1"_s, -70 } } } },
+        { { u"lab-1"_s, 2 }, { u"lab-2"_s, 2 } }, { { u"AA"_s, u"lab-1"_s }, { u"BB"_s, u"lab-1"_s } },
+        { u"AA"_s }),
+        (Assignment{ { u"AA"_s, u"lab-2"_s }, { u"BB"_s, u"lab-1"_s } }));
+}
+
+void TestAggregatorCommand::contestedDevices()
+{
+    using Contested = QHash<QString, QString>;
+
+    // Only gateways that hear the device better by at least the margin contest it.
+    QCOMPARE(AggregatorCommand::contestedDevices(
+        { { u"AA"_s, { { u"lab-1"_s, -70 }, { u"lab-2"_s, -62 } } },
+          { u"BB"_s, { { u"lab-1"_s, -70 }, { u"lab-2"_s, -63 } } } },
+        { { u"AA"_s, u"lab-1"_s }, { u"BB"_s, u"lab-1"_s } }, 8),
+        (Contested{ { u"AA"_s, u"lab-2"_s } }));
+
+    // The best of them, or the first by name, if equally good.
+    QCOMPARE(AggregatorCommand::contestedDevices(
+        { { u"AA"_s, { { u"lab-1"_s, -90 }, { u"lab-2"_s, -60 }, { u"lab-3"_s, -50 } } },
+          { u"BB"_s, { { u"lab-1"_s, -90 }, { u"lab-3"_s, -50 }, { u"lab-2"_s, -50 } } } },
+        { { u"AA"_s, u"lab-1"_s }, { u"BB"_s, u"lab-1"_s } }, 8),
+        (Contested{ { u"AA"_s, u"lab-3"_s }, { u"BB"_s, u"lab-2"_s } }));
+
+    // Devices without a current gateway, or that their gateway no longer sees, are not contested.
+    QCOMPARE(AggregatorCommand::contestedDevices(
+        { { u"AA"_s, { { u"lab-2"_s, -40 } } } }, { { u"AA"_s, u"lab-1"_s } }, 8), Contested{});
+    QCOMPARE(AggregatorCommand::contestedDevices(
+        { { u"AA"_s, { { u"lab-1"_s, -90 }, { u"lab-2"_s, -40 } } } }, { }, 8), Contested{});
+}
+
+void TestAggregatorCommand::parseEncoding_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<QString>("expectedEncoding");
+    QTest::addColumn<bool>("expectedOk");
+
+    QTest::addRow("default")        << QByteArray(R"({})") << u"json"_s << true;
+    QTest::addRow("json")           << QByteArray(R"({"encoding":"json"})") << u"json"_s << true;
+    QTest::addRow("delta-varint")   << QByteArray(R"({"encoding":"delta-varint"})") << u"delta-varint"_s << true;
+    QTest::addRow("zlib")
+        << QByteArray(R"({"encoding":"delta-varint-zlib"})") << u"delta-varint-zlib"_s << true;
+    QTest::addRow("unsupported")    << QByteArray(R"({"encoding":"zstd"})") << u"zstd"_s << false;
+}
+
+void TestAggregatorCommand::parseEncoding()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(QString, expectedEncoding);
+    QFETCH(bool, expectedOk);
+    bool ok = !expectedOk;
+    QCOMPARE(AggregatorCommand::parseEncoding(object(request), ok), expectedEncoding);
+    QCOMPARE(ok, expectedOk);
+}
+
+void TestAggregatorCommand::transcode()
+{
+    const QVector<qint16> samples{ 0, 10, -10, 100 };
+    const QByteArray encoded = SampleCodec::encode(samples);
+    const QJsonObject message{
+        { u"encoding"_s, u"delta-varint-zlib"_s },
+        { u"count"_s,    (qint64)samples.size() },
+        { u"scale"_s,    0.5 },
+        { u"samples"_s,  QString::fromLatin1(qCompress(encoded).toBase64()) },
+        { u"id"_s,       1 },
+        { u"ok"_s,       true },
+    };
+
+    // Passed through, as is, if already as requested, or if not encoded at all.
+    QCOMPARE(AggregatorCommand::transcode(message, u"delta-varint-zlib"_s), message);
+    QCOMPARE(AggregatorCommand::transcode(message, QString()), message);
+    const QJsonObject plain{ { u"ok"_s, true } };
+    QCOMPARE(AggregatorCommand::transcode(plain, u"json"_s), plain);
+
+    // Decompressed only.
+    QJsonObject expected = message;
+    expected.insert(u"encoding"_s, u"delta-varint"_s);
+    expected.insert(u"samples"_s, QString::fromLatin1(encoded.toBase64()));
+    QCOMPARE(AggregatorCommand::transcode(message, u"delta-varint"_s), expected);
+
+    // Decoded, and scaled.
+    QCOMPARE(compact(AggregatorCommand::transcode(message, u"json"_s)),
+             QByteArray(R"({"id":1,"ok":true,"values":[0,5,-5,50]})"));
+}
+
+void TestAggregatorCommand::okResponse()
+{
+    QCOMPARE(compact(AggregatorCommand::okResponse(QJsonValue(QJsonValue::Undefined))), QByteArray(R"({"ok":true})"));
+    QCOMPARE(compact(AggregatorCommand::okResponse(QJsonValue(), QJsonObject{ { u"a"_s, 1 } })),
+             QByteArray(R"({"a":1,"ok":true})"));
+    QCOMPARE(compact(AggregatorCommand::okResponse(QJsonValue(7))), QByteArray(R"({"id":7,"ok":true})"));
+}
+
+void TestAggregatorCommand::errorResponse()
+{
+    QCOMPARE(compact(AggregatorCommand::errorResponse(QJsonValue(QJsonValue::Undefined), u"Oops"_s)),
+             QByteArray(R"({"error":"Oops","ok":false})"));
+    QCOMPARE(compact(AggregatorCommand::errorResponse(QJsonValue(u"b"_s), u"Oops"_s)),
+             QByteArray(R"({"error":"Oops","id":"b","ok":false})"));
+}
+
+void TestAggregatorCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    AggregatorCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestAggregatorCommand)
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestAggregatorCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void handleRequest_data();
+    void handleRequest();
+
+    void routing();
+    void handoff();
+
+    void devicesResponse();
+    void gatewaysResponse();
+
+    void assignDevices();
+    void contestedDevices();
+
+    void parseEncoding_data();
+    void parseEncoding();
+
+    void transcode();
+
+    void okResponse();
+    void errorResponse();
+
+    void tr();
+};
@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testbenchcommand.h"
+#include "outputstreamcapture.h"
+#include "testdata.h"
+#include "../stringliterals_p.h"
+
+#include "benchcommand.h"
+
+Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
+Q_DECLARE_METATYPE(BenchCommand::Stage)
+
+DOKIT_USE_STRINGLITERALS
+
+class MockDeviceCommand : public DeviceCommand
+{
+public:
+    explicit MockDeviceCommand(QObject * const parent = nullptr) : DeviceCommand(parent)
+    {
+
+    }
+
+    AbstractPokitService * getService() override
+    {
+        return nullptr;
+    }
+};
+
+void TestBenchCommand::requiredOptions()
+{
+    BenchCommand command(this);
+    MockDeviceCommand mock;
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), mock.requiredOptions(parser));
+}
+
+void TestBenchCommand::supportedOptions()
+{
+    BenchCommand command(this);
+    MockDeviceCommand mock;
+    QCommandLineParser parser;
+    const QStringList expected = mock.supportedOptions(parser) + QStringList{ u"samples"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestBenchCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<int>("samplesPerStep");
+    QTest::addColumn<QStringList>("errors");
+
+    QTest::addRow("defaults")
+        << QStringList{} << AbstractCommand::OutputFormat::Json << 20 << QStringList{};
+
+    QTest::addRow("csv")
+        << QStringList{ u"--output"_s, u"csv"_s } << AbstractCommand::OutputFormat::Csv << 20 << QStringList{};
+
+    QTest::addRow("text")
+        << QStringList{ u"--output"_s, u"text"_s } << AbstractCommand::OutputFormat::Text << 20 << QStringList{};
+
+    QTest::addRow("samples")
+        << QStringList{ u"--samples"_s, u"50"_s } << AbstractCommand::OutputFormat::Json << 50 << QStringList{};
+
+    QTest::addRow("tooFew")
+        << QStringList{ u"--samples"_s, u"1"_s } << AbstractCommand::OutputFormat::Json << 20
+        << QStringList{ u"Invalid samples value: 1"_s };
+
+    QTest::addRow("tooMany")
+        << QStringList{ u"--samples"_s, u"1001"_s } << AbstractCommand::OutputFormat::Json << 20
+        << QStringList{ u"Invalid samples value: 1001"_s };
+
+    QTest::addRow("invalid")
+        << QStringList{ u"--samples"_s, u"invalid"_s } << AbstractCommand::OutputFormat::Json << 20
+        << QStringList{ u"Invalid samples value: invalid"_s };
+}
+
+void TestBenchCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(int, samplesPerStep);
+    QFETCH(QStringList, errors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+    parser.addOption({u"samples"_s, u"description"_s, u"count"_s});
+    parser.process(arguments);
+
+    BenchCommand command(this);
+    QCOMPARE(command.processOptions(parser), errors);
+    QCOMPARE(command.format, format);
+    QCOMPARE(command.samplesPerStep, samplesPerStep);
+}
+
+void TestBenchCommand::getService()
+{
+    // Unable to safely invoke BenchCommand::getService() without a valid Bluetooth device.
+}
+
+void TestBenchCommand::serviceDetailsDiscovered()
+{
+    // Unable to safely invoke BenchCommand::serviceDetailsDiscovered() without a valid service.
+}
+
+void TestBenchCommand::toString_Stage_data()
+{
+    QTest::addColumn<BenchCommand::Stage>("stage");
+    QTest::addColumn<QString>("expected");
+    QTest::addRow("MeterIntervals") << BenchCommand::Stage::MeterIntervals << u"meterIntervals"_s;
+    QTest::addRow("ModeSwitches")   << BenchCommand::Stage::ModeSwitches   << u"modeSwitches"_s;
+    QTest::addRow("DsoTransfers")   << BenchCommand::Stage::DsoTransfers   << u"dsoTransfers"_s;
+    QTest::addRow("LoggerFetch")    << BenchCommand::Stage::LoggerFetch    << u"loggerFetch"_s;
+    QTest::addRow("Done")           << BenchCommand::Stage::Done           << u"done"_s;
+    QTest::addRow("invalid") << (BenchCommand::Stage)0xFF << QString();
+}
+
+void TestBenchCommand::toString_Stage()
+{
+    QFETCH(BenchCommand::Stage, stage);
+    QFETCH(QString, expected);
+    QCOMPARE(BenchCommand::toString(stage), expected);
+}
+
+void TestBenchCommand::summarise()
+{
+    {   // Nothing measured.
+        const BenchCommand::Summary summary = BenchCommand::summarise({});
+        QCOMPARE(summary.count, (qsizetype)0);
+        QCOMPARE(summary.min, 0.0);
+        QCOMPARE(summary.mean, 0.0);
+        QCOMPARE(summary.max, 0.0);
+    }
+
+    {   // Durations are in nanoseconds, but summarised in milliseconds, regardless of order.
+        const BenchCommand::Summary summary = BenchCommand::summarise({ 30'000'000, 10'000'000, 50'000'000 });
+        QCOMPARE(summary.count, (qsizetype)3);
+        QCOMPARE(summary.min, 10.0);
+        QCOMPARE(summary.mean, 30.0);
+        QCOMPARE(summary.max, 50.0);
+    }
+}
+
+void TestBenchCommand::fastestInterval()
+{
+    QCOMPARE(BenchCommand::fastestInterval({}), (quint32)0);
+    QCOMPARE(BenchCommand::fastestInterval({ { 1000, 1500.0, false } }), (quint32)0);
+    QCOMPARE(BenchCommand::fastestInterval({ { 1000, 1000.0, true }, { 500, 500.0, true }, { 250, 400.0, false } }),
+             (quint32)500);
+}
+
+void TestBenchCommand::outputReport_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<bool>("measured");
+    QTest::addRow("full.csv")  << AbstractCommand::OutputFormat::Csv  << true;
+    QTest::addRow("full.json") << AbstractCommand::OutputFormat::Json << true;
+    QTest::addRow("full.txt")  << AbstractCommand::OutputFormat::Text << true;
+    QTest::addRow("empty.csv") << AbstractCommand::OutputFormat::Csv  << false;
+    QTest::addRow("empty.txt") << AbstractCommand::OutputFormat::Text << false;
+}
+
+void TestBenchCommand::outputReport()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(bool, measured);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    BenchCommand command;
+    command.format = format;
+    command.report.deviceName = u"Pokit Pro"_s;
+    command.report.host = u"example (Linux)"_s;
+    if (measured) {
+        command.report.model = u"Pokit Pro"_s;
+        command.report.adapter = u"00:11:22:33:44:55"_s;
+        command.report.connectTime = 123.5;
+        command.report.discoveryTime = 250.0;
+        command.report.intervals = { { 500, 500.5, true }, { 250, 251.5, true }, { 100, 150.0, false } };
+        command.report.modeSwitches = { 100'000'000, 200'000'000, 300'000'000 };
+        command.report.dsoTransfers = { 50'000'000 };
+        command.report.loggerSamples = 500;
+        command.report.loggerFetchTime = 800'000'000;
+        command.report.notifications = 123;
+        command.report.bytes = 456;
+    }
+    command.outputReport();
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestBenchCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    BenchCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestBenchCommand)
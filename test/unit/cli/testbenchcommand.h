@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestBenchCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void getService();
+
+    void serviceDetailsDiscovered();
+
+    void toString_Stage_data();
+    void toString_Stage();
+
+    void summarise();
+
+    void fastestInterval();
+
+    void outputReport_data();
+    void outputReport();
+
+    void tr();
+};
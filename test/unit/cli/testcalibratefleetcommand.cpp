@@ -0,0 +1,179 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testcalibratefleetcommand.h"
+#include "outputstreamcapture.h"
+#include "testdata.h"
+#include "../stringliterals_p.h"
+
+#include "calibratefleetcommand.h"
+
+#include <qtpokit/pokitconnectionmanager.h>
+
+Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
+
+DOKIT_USE_STRINGLITERALS
+
+void TestCalibrateFleetCommand::requiredOptions()
+{
+    CalibrateFleetCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"temperature"_s });
+}
+
+void TestCalibrateFleetCommand::supportedOptions()
+{
+    CalibrateFleetCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"device-list"_s, u"max-connections"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestCalibrateFleetCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedDevices");
+    QTest::addColumn<float>("expectedTemperature");
+    QTest::addColumn<int>("expectedMaxConnections");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("list")
+        << QStringList{ u"--device"_s, u"alpha, beta"_s, u"--device"_s, u"gamma"_s, u"--temperature"_s, u"21.5"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s, u"gamma"_s } << 21.5f << 3 << QStringList{};
+    QTest::addRow("empty")
+        << QStringList{ u"--device"_s, u" , "_s, u"--temperature"_s, u"21.5"_s }
+        << QStringList{ } << 21.5f << 3 << QStringList{ u"No devices to calibrate"_s };
+    QTest::addRow("connections")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--temperature"_s, u"-5"_s, u"--max-connections"_s, u"8"_s }
+        << QStringList{ u"alpha"_s } << -5.0f << 8 << QStringList{};
+    QTest::addRow("invalid-temperature")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--temperature"_s, u"warm"_s }
+        << QStringList{ u"alpha"_s } << std::numeric_limits<float>::quiet_NaN() << 3
+        << QStringList{ u"Unrecognised temperature format: warm"_s };
+    QTest::addRow("invalid-connections")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--temperature"_s, u"20"_s, u"--max-connections"_s, u"0"_s }
+        << QStringList{ u"alpha"_s } << 20.0f << 3 << QStringList{ u"Invalid max-connections value: 0"_s };
+}
+
+void TestCalibrateFleetCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedDevices);
+    QFETCH(float, expectedTemperature);
+    QFETCH(int, expectedMaxConnections);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"device-list"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"max-connections"_s, u"description"_s, u"count"_s});
+    parser.addOption({u"temperature"_s, u"description"_s, u"degrees"_s});
+    parser.process(arguments);
+
+    CalibrateFleetCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QStringList devices;
+    for (const auto &calibration: command.calibrations) {
+        devices.append(calibration.deviceName);
+    }
+    QCOMPARE(devices, expectedDevices);
+    QCOMPARE(command.devicesToScanFor, expectedDevices);
+    if (qIsNaN(expectedTemperature)) {
+        QVERIFY(qIsNaN(command.temperature));
+    } else {
+        QCOMPARE(command.temperature, expectedTemperature);
+    }
+    QCOMPARE(command.maxConnections, expectedMaxConnections);
+    QCOMPARE(command.manager->maxConnections(), expectedMaxConnections);
+}
+
+void TestCalibrateFleetCommand::deviceDiscoveryFinished()
+{
+    const OutputStreamCapture capture(&std::cout);
+    CalibrateFleetCommand command;
+    command.calibrations.append({ u"alpha"_s });
+    command.calibrations.append({ u"beta"_s });
+    command.calibrations[1].discovered = true; // Discovered, but still waiting for a connection.
+    QTest::ignoreMessage(QtWarningMsg, R"(Failed to find device "alpha".)");
+    command.deviceDiscoveryFinished();
+    QVERIFY(command.discoveryFinished);
+    QVERIFY(command.calibrations.at(0).finished);
+    QCOMPARE(command.calibrations.at(0).error, u"Device not found"_s);
+    QVERIFY(!command.calibrations.at(1).finished);
+    QVERIFY(!command.exiting);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray());
+}
+
+void TestCalibrateFleetCommand::indexOf()
+{
+    CalibrateFleetCommand command;
+    command.calibrations.append({ u"alpha"_s });
+    command.calibrations.append({ u"beta"_s });
+    command.calibrations[1].ticket = 7;
+    QCOMPARE(command.indexOf(7), 1);
+    QCOMPARE(command.indexOf(8), -1);
+    QCOMPARE(command.indexOf(0), -1); // Not a valid ticket, even though alpha has no ticket.
+}
+
+void TestCalibrateFleetCommand::finishCalibration()
+{
+    const OutputStreamCapture capture(&std::cout);
+    CalibrateFleetCommand command;
+    command.calibrations.append({ u"alpha"_s });
+    command.calibrations.append({ u"beta"_s });
+    command.discoveryFinished = true;
+
+    command.finishCalibration(0);
+    QVERIFY(command.calibrations.at(0).finished);
+    QVERIFY(command.calibrations.at(0).error.isNull());
+    QVERIFY(!command.exiting); // Still waiting for beta.
+
+    command.finishCalibration(0, u"ignored"_s); // Already finished, so ignored.
+    QVERIFY(command.calibrations.at(0).error.isNull());
+
+    command.finishCalibration(1, u"Connection failed"_s);
+    QVERIFY(command.calibrations.at(1).finished);
+    QCOMPARE(command.calibrations.at(1).error, u"Connection failed"_s);
+    QVERIFY(command.exiting);
+    QCOMPARE(QByteArray::fromStdString(capture.data()),
+             QByteArray("alpha: done\nbeta: failed (Connection failed)\nCalibrated 1 of 2 device/s.\n"));
+}
+
+void TestCalibrateFleetCommand::outputSummary_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addRow("fleet.csv")  << AbstractCommand::OutputFormat::Csv;
+    QTest::addRow("fleet.json") << AbstractCommand::OutputFormat::Json;
+    QTest::addRow("fleet.txt")  << AbstractCommand::OutputFormat::Text;
+}
+
+void TestCalibrateFleetCommand::outputSummary()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    CalibrateFleetCommand command;
+    command.format = format;
+    command.calibrations.append({ u"alpha"_s });
+    command.calibrations.append({ u"Pokit, B"_s });
+    command.calibrations.append({ u"gamma"_s });
+    command.calibrations[1].error = u"Device not found"_s;
+    command.outputSummary();
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestCalibrateFleetCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    CalibrateFleetCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestCalibrateFleetCommand)
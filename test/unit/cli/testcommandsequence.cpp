@@ -0,0 +1,214 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testcommandsequence.h"
+#include "../stringliterals_p.h"
+
+#include "commandsequence.h"
+
+#include <QFutureInterface>
+#include <QSignalSpy>
+
+DOKIT_USE_STRINGLITERALS
+
+// Returns a future that has already finished, with \a result.
+static QFuture<bool> finishedFuture(const bool result)
+{
+    QFutureInterface<bool> promise(QFutureInterfaceBase::Started);
+    promise.reportResult(result);
+    promise.reportFinished();
+    return promise.future();
+}
+
+// Returns a step that records its invocation, by appending \a name to \a issued, and returns \a promise's future.
+static CommandSequence::Step pendingStep(const QString &name, QStringList &issued, QFutureInterface<bool> &promise)
+{
+    return [name, &issued, &promise]() {
+        issued.append(name);
+        return promise.future();
+    };
+}
+
+// Finishes \a promise with \a result.
+static void finish(QFutureInterface<bool> &promise, const bool result)
+{
+    promise.reportResult(result);
+    promise.reportFinished();
+}
+
+void TestCommandSequence::then()
+{
+    CommandSequence sequence;
+    QCOMPARE(sequence.stageCount(), 0);
+    sequence.then(u"a"_s, []() { return finishedFuture(true); })
+        .then(u"b"_s, []() { return finishedFuture(true); });
+    QCOMPARE(sequence.stageCount(), 2);
+    QCOMPARE(sequence.stages.at(0).size(), 1);
+    QCOMPARE(sequence.stages.at(1).size(), 1);
+    QCOMPARE(sequence.stages.at(1).at(0).name, u"b"_s);
+    QCOMPARE(sequence.currentStage(), -1);
+    QVERIFY(!sequence.isRunning());
+}
+
+void TestCommandSequence::alongside()
+{
+    CommandSequence sequence;
+    sequence.alongside(u"a"_s, []() { return finishedFuture(true); }); // Starts the first stage.
+    QCOMPARE(sequence.stageCount(), 1);
+    sequence.alongside(u"b"_s, []() { return finishedFuture(true); })
+        .then(u"c"_s, []() { return finishedFuture(true); })
+        .alongside(u"d"_s, []() { return finishedFuture(true); });
+    QCOMPARE(sequence.stageCount(), 2);
+    QCOMPARE(sequence.stages.at(0).size(), 2);
+    QCOMPARE(sequence.stages.at(0).at(1).name, u"b"_s);
+    QCOMPARE(sequence.stages.at(1).size(), 2);
+    QCOMPARE(sequence.stages.at(1).at(1).name, u"d"_s);
+}
+
+void TestCommandSequence::start_empty()
+{
+    CommandSequence sequence;
+    const QSignalSpy finishedSpy(&sequence, &CommandSequence::finished);
+    sequence.start();
+    QCOMPARE(finishedSpy.count(), 1);
+    QVERIFY(!sequence.isRunning());
+}
+
+void TestCommandSequence::start_sequential()
+{
+    QStringList issued;
+    QFutureInterface<bool> first(QFutureInterfaceBase::Started), second(QFutureInterfaceBase::Started);
+    CommandSequence sequence;
+    sequence.then(u"first"_s, pendingStep(u"first"_s, issued, first))
+        .then(u"second"_s, pendingStep(u"second"_s, issued, second));
+    const QSignalSpy stageSpy(&sequence, &CommandSequence::stageFinished);
+    const QSignalSpy finishedSpy(&sequence, &CommandSequence::finished);
+
+    sequence.start();
+    QVERIFY(sequence.isRunning());
+    QCOMPARE(sequence.currentStage(), 0);
+    QCOMPARE(issued, QStringList{ u"first"_s }); // The second stage waits for the first.
+
+    finish(first, true);
+    QTRY_COMPARE(stageSpy.count(), 1);
+    QCOMPARE(stageSpy.at(0).at(0).toInt(), 0);
+    QCOMPARE(sequence.currentStage(), 1);
+    QCOMPARE(issued, (QStringList{ u"first"_s, u"second"_s }));
+    QCOMPARE(finishedSpy.count(), 0);
+
+    finish(second, true);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(stageSpy.count(), 2);
+    QCOMPARE(stageSpy.at(1).at(0).toInt(), 1);
+    QVERIFY(!sequence.isRunning());
+}
+
+void TestCommandSequence::start_concurrent()
+{
+    QStringList issued;
+    QFutureInterface<bool> a(QFutureInterfaceBase::Started), b(QFutureInterfaceBase::Started),
+        c(QFutureInterfaceBase::Started);
+    CommandSequence sequence;
+    sequence.then(u"a"_s, pendingStep(u"a"_s, issued, a))
+        .alongside(u"b"_s, pendingStep(u"b"_s, issued, b))
+        .then(u"c"_s, pendingStep(u"c"_s, issued, c));
+    const QSignalSpy stageSpy(&sequence, &CommandSequence::stageFinished);
+    const QSignalSpy finishedSpy(&sequence, &CommandSequence::finished);
+
+    sequence.start();
+    QCOMPARE(issued, (QStringList{ u"a"_s, u"b"_s })); // Issued together, before either has finished.
+
+    finish(b, true); // Out of order.
+    QTest::qWait(10);
+    QCOMPARE(stageSpy.count(), 0);
+    QCOMPARE(issued.size(), 2);
+
+    finish(a, true);
+    QTRY_COMPARE(stageSpy.count(), 1);
+    QCOMPARE(issued, (QStringList{ u"a"_s, u"b"_s, u"c"_s }));
+
+    finish(c, true);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+}
+
+void TestCommandSequence::start_failed()
+{
+    QStringList issued;
+    QFutureInterface<bool> a(QFutureInterfaceBase::Started), b(QFutureInterfaceBase::Started),
+        c(QFutureInterfaceBase::Started);
+    CommandSequence sequence;
+    sequence.then(u"a"_s, pendingStep(u"a"_s, issued, a))
+        .alongside(u"b"_s, pendingStep(u"b"_s, issued, b))
+        .then(u"c"_s, pendingStep(u"c"_s, issued, c));
+    const QSignalSpy failedSpy(&sequence, &CommandSequence::failed);
+    const QSignalSpy stageSpy(&sequence, &CommandSequence::stageFinished);
+    const QSignalSpy finishedSpy(&sequence, &CommandSequence::finished);
+
+    sequence.start();
+    QTest::ignoreMessage(QtWarningMsg, "Step a failed.");
+    finish(a, false);
+    QTRY_COMPARE(failedSpy.count(), 1);
+    QCOMPARE(failedSpy.at(0).at(0).toString(), u"a"_s);
+    QVERIFY(sequence.isRunning()); // Until the rest of the stage has finished.
+
+    QTest::ignoreMessage(QtWarningMsg, "Step b failed.");
+    finish(b, false);
+    QTRY_VERIFY(!sequence.isRunning());
+    QCOMPARE(failedSpy.count(), 1); // Only the first failure is reported.
+    QCOMPARE(stageSpy.count(), 0);
+    QCOMPARE(finishedSpy.count(), 0);
+    QCOMPARE(issued, (QStringList{ u"a"_s, u"b"_s })); // The next stage was never started.
+}
+
+void TestCommandSequence::start_cancelled()
+{
+    CommandSequence sequence;
+    sequence.then(u"cancelled"_s, []() {
+        QFutureInterface<bool> promise(QFutureInterfaceBase::Started);
+        promise.cancel();
+        promise.reportFinished();
+        return promise.future();
+    });
+    const QSignalSpy failedSpy(&sequence, &CommandSequence::failed);
+    QTest::ignoreMessage(QtWarningMsg, "Step cancelled failed.");
+    sequence.start();
+    QTRY_COMPARE(failedSpy.count(), 1);
+    QVERIFY(!sequence.isRunning());
+}
+
+void TestCommandSequence::start_running()
+{
+    QStringList issued;
+    QFutureInterface<bool> promise(QFutureInterfaceBase::Started);
+    CommandSequence sequence;
+    sequence.then(u"a"_s, pendingStep(u"a"_s, issued, promise));
+    sequence.start();
+    QTest::ignoreMessage(QtWarningMsg, "Command sequence is already running, at stage 1.");
+    sequence.start();
+    QCOMPARE(issued.size(), 1);
+    finish(promise, true);
+}
+
+void TestCommandSequence::start_again()
+{
+    int count = 0;
+    CommandSequence sequence;
+    sequence.then(u"a"_s, [&count]() { ++count; return finishedFuture(true); })
+        .alongside(u"b"_s, [&count]() { ++count; return finishedFuture(true); });
+    const QSignalSpy finishedSpy(&sequence, &CommandSequence::finished);
+    sequence.start();
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    sequence.start();
+    QTRY_COMPARE(finishedSpy.count(), 2);
+    QCOMPARE(count, 4);
+}
+
+void TestCommandSequence::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    CommandSequence sequence;
+    QVERIFY(!sequence.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestCommandSequence)
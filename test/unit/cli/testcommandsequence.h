@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestCommandSequence : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void then();
+    void alongside();
+
+    void start_empty();
+    void start_sequential();
+    void start_concurrent();
+    void start_failed();
+    void start_cancelled();
+    void start_running();
+    void start_again();
+
+    void tr();
+};
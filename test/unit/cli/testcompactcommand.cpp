@@ -0,0 +1,283 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testcompactcommand.h"
+#include "archivefixture.h"
+#include "../stringliterals_p.h"
+
+#include "compactcommand.h"
+#include "shardedworkerpool.h"
+
+#include <qtpokit/loggerarchive.h>
+#include <qtpokit/loggerrollup.h>
+#include <qtpokit/pokitmeter.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+const DataLoggerService::Metadata testMetadata{ DataLoggerService::LoggerStatus::Sampling, 0.5f,
+    DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V, 1000, 3, 1700000000 };
+
+// Populates \a dir with two incrementally fetched archives (and a non-archive) in `archives`, and an empty `empty`
+// directory. Archive a.bin has three runs of one session, and b.bin has two runs of another.
+bool createArchives(const QTemporaryDir &dir)
+{
+    return ::createArchives(dir, testMetadata, { u"archives"_s, u"empty"_s }, {
+        { u"archives/a.bin"_s, 0, { 1, 2 }, 0 }, { u"archives/a.bin"_s, 0, { 3, 4 }, 2 },
+        { u"archives/a.bin"_s, 0, { 5 }, 4 }, { u"archives/b.bin"_s, 600, { -1 }, 0 },
+        { u"archives/b.bin"_s, 600, { -2 }, 1 } });
+}
+
+}
+
+void TestCompactCommand::requiredOptions()
+{
+    CompactCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"archive"_s });
+}
+
+void TestCompactCommand::supportedOptions()
+{
+    CompactCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"compress"_s, u"merge"_s, u"workers"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestCompactCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedArchives"); // Each compaction's archives, joined by '+'.
+    QTest::addColumn<QStringList>("expectedOutputs");
+    QTest::addColumn<bool>("expectedCompress");
+    QTest::addColumn<int>("expectedThreads");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("missing-archive")
+        << QStringList{ }
+        << QStringList{ } << QStringList{ } << false << 0
+        << QStringList{ u"Missing required option: archive"_s };
+    QTest::addRow("file")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/a.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s } << QStringList{ u"{dir}/archives/a.bin"_s } << false << 0
+        << QStringList{ };
+    QTest::addRow("directory")
+        << QStringList{ u"--archive"_s, u"{dir}/archives"_s, u"--compress"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s, u"{dir}/archives/b.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s, u"{dir}/archives/b.bin"_s } << true << 0
+        << QStringList{ };
+    QTest::addRow("merge")
+        << QStringList{ u"--archive"_s, u"{dir}/archives"_s, u"--merge"_s, u"{dir}/merged.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin+{dir}/archives/b.bin"_s }
+        << QStringList{ u"{dir}/merged.bin"_s } << false << 0
+        << QStringList{ };
+    QTest::addRow("merge-into-archive")
+        << QStringList{ u"--archive"_s, u"{dir}/archives"_s, u"--merge"_s, u"{dir}/archives/a.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin+{dir}/archives/b.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s } << false << 0
+        << QStringList{ };
+    QTest::addRow("merge-over-other")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--merge"_s, u"{dir}/archives/a.bin"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << QStringList{ u"{dir}/archives/a.bin"_s } << false << 0
+        << QStringList{ u"Merge file already exists, but is not one of the archives: {dir}/archives/a.bin"_s };
+    QTest::addRow("merge-missing-dir")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--merge"_s, u"{dir}/missing/a.bin"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << QStringList{ u"{dir}/missing/a.bin"_s } << false << 0
+        << QStringList{ u"Merge file directory does not exist: {dir}/missing"_s };
+    QTest::addRow("repeated")
+        << QStringList{ u"--archive"_s, u"{dir}/archives"_s, u"--archive"_s, u"{dir}/archives/b.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s, u"{dir}/archives/b.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s, u"{dir}/archives/b.bin"_s } << false << 0
+        << QStringList{ u"Archive given more than once: {dir}/archives/b.bin"_s };
+    QTest::addRow("not-found")
+        << QStringList{ u"--archive"_s, u"{dir}/missing.bin"_s }
+        << QStringList{ } << QStringList{ } << false << 0
+        << QStringList{ u"Archive does not exist: {dir}/missing.bin"_s };
+    QTest::addRow("empty-directory")
+        << QStringList{ u"--archive"_s, u"{dir}/empty"_s }
+        << QStringList{ } << QStringList{ } << false << 0
+        << QStringList{ u"No archives found in {dir}/empty"_s };
+    QTest::addRow("workers")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--workers"_s, u"4"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << QStringList{ u"{dir}/archives/b.bin"_s } << false << 4
+        << QStringList{ };
+    QTest::addRow("invalid-workers")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--workers"_s, u"-1"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << QStringList{ u"{dir}/archives/b.bin"_s } << false << -1
+        << QStringList{ u"Invalid workers value: -1"_s };
+}
+
+void TestCompactCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedArchives);
+    QFETCH(QStringList, expectedOutputs);
+    QFETCH(bool, expectedCompress);
+    QFETCH(int, expectedThreads);
+    QFETCH(QStringList, expectedErrors);
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    arguments = withDir(arguments, dir.path());
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"compress"_s, u"description"_s});
+    parser.addOption({u"merge"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"workers"_s, u"description"_s, u"count"_s});
+    parser.process(arguments);
+
+    CompactCommand command(this);
+    QCOMPARE(command.processOptions(parser), withDir(expectedErrors, dir.path()));
+    QStringList archives, outputs;
+    for (const auto &item: command.compactions) {
+        archives.append(item.archives.join(u'+'));
+        outputs.append(item.output);
+    }
+    QCOMPARE(archives, withDir(expectedArchives, dir.path()));
+    QCOMPARE(outputs, withDir(expectedOutputs, dir.path()));
+    QCOMPARE(command.compress, expectedCompress);
+    QCOMPARE(command.threads, expectedThreads);
+}
+
+void TestCompactCommand::start()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    QCommandLineParser parser;
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"workers"_s, u"description"_s, u"count"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--archive"_s, dir.filePath(u"archives"_s), u"--workers"_s, u"2"_s });
+
+    CompactCommand command;
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(command.start());
+    QVERIFY(command.workers);
+    QCOMPARE(command.workers->threadCount(), 2);
+    QTRY_COMPARE(command.finished, 2);
+    for (const auto &item: command.compactions) {
+        QVERIFY2(item.error.isEmpty(), qUtf8Printable(item.error));
+        QCOMPARE(item.after.sessions, (qsizetype)1); // Each archive's runs were coalesced.
+        QVERIFY(item.after.bytes < item.before.bytes);
+        QVERIFY(QFile::exists(LoggerRollup::fileNameFor(item.output)));
+    }
+    QCOMPARE(command.compactions.at(0).before.sessions, (qsizetype)3);
+    QCOMPARE(command.compactions.at(1).before.sessions, (qsizetype)2);
+
+    LoggerArchive archive(dir.filePath(u"archives/a.bin"_s));
+    QVERIFY(archive.open());
+    QCOMPARE(archive.samples(0), (DataLoggerService::Samples{ 1, 2, 3, 4, 5 }));
+}
+
+void TestCompactCommand::start_merge()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    const QString merged = dir.filePath(u"merged.bin"_s);
+    QCommandLineParser parser;
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"merge"_s, u"description"_s, u"file"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--archive"_s, dir.filePath(u"archives"_s), u"--merge"_s, merged });
+
+    CompactCommand command;
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    const qint64 size = QFileInfo(dir.filePath(u"archives/a.bin"_s)).size();
+    QVERIFY(command.start());
+    QTRY_COMPARE(command.finished, 1);
+    QVERIFY2(command.compactions.at(0).error.isEmpty(), qUtf8Printable(command.compactions.at(0).error));
+    QCOMPARE(command.compactions.at(0).before.sessions, (qsizetype)5);
+    QCOMPARE(command.compactions.at(0).after.sessions, (qsizetype)2);
+
+    // The merged archive has both sessions, in time order, but the original archives are unchanged.
+    LoggerArchive archive(merged);
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)2);
+    QCOMPARE(archive.samples(0), (DataLoggerService::Samples{ 1, 2, 3, 4, 5 }));
+    QCOMPARE(archive.samples(1), (DataLoggerService::Samples{ -1, -2 }));
+    QCOMPARE(QFileInfo(dir.filePath(u"archives/a.bin"_s)).size(), size);
+    QVERIFY(QFile::exists(LoggerRollup::fileNameFor(merged)));
+}
+
+void TestCompactCommand::compactionFinished()
+{
+    CompactCommand command;
+    command.compactions.append({ { u"a.bin"_s }, u"a.bin"_s, QString(), { 3, 1000 }, { 1, 500 } });
+    command.compactions.append({ { u"b.bin"_s }, u"b.bin"_s, u"Disk full"_s, { }, { } });
+    command.compactionFinished(1);
+    QCOMPARE(command.finished, 1);
+
+    // The last compaction to finish reports the number that failed.
+    QTest::ignoreMessage(QtWarningMsg, "Failed to compact b.bin: Disk full");
+    QTest::ignoreMessage(QtWarningMsg, "Failed to compact 1 of 2 archive(s).");
+    command.compactionFinished(0);
+    QCOMPARE(command.finished, 2);
+}
+
+void TestCompactCommand::compact()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    const QString archive = dir.filePath(u"archives/a.bin"_s);
+    const qint64 size = QFileInfo(archive).size();
+    CompactCommand::Statistics before, after;
+    QCOMPARE(CompactCommand::compact({ archive }, archive, true, before, after), QString());
+    QCOMPARE(before.sessions, (qsizetype)3);
+    QCOMPARE(before.bytes, size);
+    QCOMPARE(after.sessions, (qsizetype)1);
+    QCOMPARE(after.bytes, QFileInfo(archive).size());
+    QCOMPARE(after.bytes, (qint64)(8 + (32+8) + 24 + 16)); // Five compressed samples, padded to eight bytes.
+
+    // The rollup is up to date, but with too few samples per second for a one second tier.
+    LoggerArchive compacted(archive);
+    QVERIFY(compacted.open());
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive));
+    QVERIFY(rollup.open(compacted));
+    QCOMPARE(rollup.tiers(DataLoggerService::Mode::DcVoltage), (QVector<quint64>{ 60000, 3600000 }));
+}
+
+void TestCompactCommand::compact_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    CompactCommand::Statistics before, after;
+
+    // Not an archive.
+    const QString notes = dir.filePath(u"archives/notes.txt"_s);
+    QTest::ignoreMessage(QtWarningMsg, qUtf8Printable(u"Failed to read archive %1"_s.arg(notes)));
+    QCOMPARE(CompactCommand::compact({ notes }, notes, false, before, after),
+             u"Invalid, or unreadable, archive: %1"_s.arg(notes));
+
+    // Not writable.
+    const QString output = dir.filePath(u"missing/a.bin"_s);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Failed to write archive %1: "_s
+        .arg(QRegularExpression::escape(output))));
+    QCOMPARE(CompactCommand::compact({ dir.filePath(u"archives/a.bin"_s) }, output, false, before, after),
+             u"Failed to write archive"_s);
+    QCOMPARE(after.sessions, (qsizetype)0);
+}
+
+void TestCompactCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    CompactCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestCompactCommand)
@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestCompactCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void start();
+    void start_merge();
+
+    void compactionFinished();
+
+    void compact();
+    void compact_invalid();
+
+    void tr();
+};
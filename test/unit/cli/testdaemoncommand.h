@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestDaemonCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void processOptions_jobs_data();
+    void processOptions_jobs();
+
+    void processOptions_prewarm_data();
+    void processOptions_prewarm();
+
+    void processOptions_listen_data();
+    void processOptions_listen();
+
+    void processOptions_aggregator_data();
+    void processOptions_aggregator();
+
+    void processOptions_referenceClock_data();
+    void processOptions_referenceClock();
+
+    void stamp();
+
+    void handleRequest_data();
+    void handleRequest();
+
+    void devicesResponse();
+
+    void parseMeterSettings_data();
+    void parseMeterSettings();
+
+    void parseDsoSettings_data();
+    void parseDsoSettings();
+
+    void parseStatusSettings_data();
+    void parseStatusSettings();
+
+    void parseCalibrationSettings_data();
+    void parseCalibrationSettings();
+
+    void parseEncoding_data();
+    void parseEncoding();
+
+    void parsePoints_data();
+    void parsePoints();
+
+    void parseRate_data();
+    void parseRate();
+
+    void encodeSamples();
+    void decimateSamples();
+
+    void toJson();
+
+    void toOptionValue();
+
+    void okResponse();
+    void errorResponse();
+
+    void maybeRelease();
+    void removeStatusWatchers();
+
+    void scheduleJob();
+    void removeScheduledJobs();
+    void runJob();
+    void finishJobs();
+    void schedulePrewarm();
+    void jitterFor();
+
+    void tr();
+};
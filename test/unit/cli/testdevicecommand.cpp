@@ -2,15 +2,32 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "testdevicecommand.h"
+#include "outputstreamcapture.h"
 #include "../github.h"
 #include "../stringliterals_p.h"
 
 #include "devicecommand.h"
 
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/memorybudget.h>
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/stallwatchdog.h>
 #include <qtpokit/statusservice.h>
 #include <qtpokit/pokitmeter.h>
 #include <qtpokit/pokitpro.h>
+#include <qtpokit/samplefilter.h>
+#include <qtpokit/trafficrecorder.h>
 
+#include <QDateTime>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
+Q_DECLARE_METATYPE(ChargeIntegrator::GapPolicy)
+Q_DECLARE_METATYPE(EventDetector::Quantity)
+Q_DECLARE_METATYPE(EventDetector::Direction)
 Q_DECLARE_METATYPE(PokitMeter::CurrentRange)
 Q_DECLARE_METATYPE(PokitMeter::ResistanceRange)
 Q_DECLARE_METATYPE(PokitMeter::VoltageRange)
@@ -18,6 +35,7 @@ Q_DECLARE_METATYPE(PokitPro::CapacitanceRange)
 Q_DECLARE_METATYPE(PokitPro::CurrentRange)
 Q_DECLARE_METATYPE(PokitPro::ResistanceRange)
 Q_DECLARE_METATYPE(PokitPro::VoltageRange)
+Q_DECLARE_METATYPE(ThreadPolicy::Priority)
 
 DOKIT_USE_STRINGLITERALS
 
@@ -46,6 +64,184 @@ protected slots:
     }
 };
 
+void TestDeviceCommand::supportedOptions()
+{
+    MockDeviceCommand command;
+    QCommandLineParser parser;
+    QVERIFY(command.supportedOptions(parser).contains(u"connection-profile"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"device-thread"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"discovery-cache"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"known-devices"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"latency-report"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"link-statistics"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"reconnect"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"record"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"sink-threads"_s));
+    QVERIFY(command.supportedOptions(parser).contains(u"device"_s)); // Inherited from AbstractCommand.
+}
+
+void TestDeviceCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<int>("expectedProfile"); // -1 for none.
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none") << QStringList{} << -1 << QStringList{};
+
+    QTest::addRow("default")
+        << QStringList{ u"--connection-profile"_s, u"default"_s }
+        << (int)PokitDevice::ConnectionProfile::Default << QStringList{};
+
+    QTest::addRow("low-latency")
+        << QStringList{ u"--connection-profile"_s, u"low-latency"_s }
+        << (int)PokitDevice::ConnectionProfile::LowLatency << QStringList{};
+
+    QTest::addRow("LowPower")
+        << QStringList{ u"--connection-profile"_s, u"LowPower"_s }
+        << (int)PokitDevice::ConnectionProfile::LowPower << QStringList{};
+
+    QTest::addRow("invalid")
+        << QStringList{ u"--connection-profile"_s, u"fastest"_s }
+        << -1 << QStringList{ u"Unknown connection profile: fastest"_s };
+}
+
+void TestDeviceCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(int, expectedProfile);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"connection-profile"_s, u"description"_s, u"profile"_s});
+    parser.process(arguments);
+
+    MockDeviceCommand command;
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.connectionProfile ? (int)*command.connectionProfile : -1, expectedProfile);
+}
+
+void TestDeviceCommand::processOptions_reconnect_data()
+{
+    QTest::addColumn<QString>("attempts");
+    QTest::addColumn<int>("expectedAttempts");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("1") << u"1"_s << 1 << QStringList{};
+    QTest::addRow("10") << u"10"_s << 10 << QStringList{};
+    QTest::addRow("0") << u"0"_s << 0 << QStringList{ u"Invalid reconnect attempts: 0"_s };
+    QTest::addRow("-1") << u"-1"_s << 0 << QStringList{ u"Invalid reconnect attempts: -1"_s };
+    QTest::addRow("abc") << u"abc"_s << 0 << QStringList{ u"Invalid reconnect attempts: abc"_s };
+    QTest::addRow("tooMany") << u"4294967295"_s << 0 << QStringList{ u"Invalid reconnect attempts: 4294967295"_s };
+}
+
+void TestDeviceCommand::processOptions_reconnect()
+{
+    QFETCH(QString, attempts);
+    QFETCH(int, expectedAttempts);
+    QFETCH(QStringList, expectedErrors);
+
+    QCommandLineParser parser;
+    parser.addOption({u"reconnect"_s, u"description"_s, u"attempts"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--reconnect"_s, attempts });
+
+    MockDeviceCommand command;
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.reconnectAttempts, expectedAttempts);
+}
+
+void TestDeviceCommand::processOptions_latencyReport()
+{
+    QCommandLineParser parser;
+    parser.addOption({u"latency-report"_s, u"description"_s});
+    parser.process(QStringList{ u"dokit"_s });
+
+    MockDeviceCommand command;
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(!command.latencyTracking);
+
+    parser.process(QStringList{ u"dokit"_s, u"--latency-report"_s });
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(command.latencyTracking);
+}
+
+void TestDeviceCommand::processOptions_linkStatistics()
+{
+    QCommandLineParser parser;
+    parser.addOption({u"link-statistics"_s, u"description"_s});
+    parser.process(QStringList{ u"dokit"_s });
+
+    MockDeviceCommand command;
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(!command.linkStatistics);
+
+    parser.process(QStringList{ u"dokit"_s, u"--link-statistics"_s });
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(command.linkStatistics);
+}
+
+void TestDeviceCommand::processOptions_record()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QCommandLineParser parser;
+    parser.addOption({u"record"_s, u"description"_s, u"file"_s});
+    parser.process(QStringList{ u"dokit"_s });
+
+    MockDeviceCommand command;
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(!command.recorder);
+
+    const QString fileName = dir.filePath(u"traffic.dokt"_s);
+    parser.process(QStringList{ u"dokit"_s, u"--record"_s, fileName });
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(command.recorder);
+    QVERIFY(command.recorder->isRecording());
+    QCOMPARE(command.recorder->fileName(), fileName);
+
+    MockDeviceCommand invalid;
+    const QString invalidFileName = dir.filePath(u"missing/traffic.dokt"_s);
+    parser.process(QStringList{ u"dokit"_s, u"--record"_s, invalidFileName });
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Failed to open recording "_s));
+    QCOMPARE(invalid.processOptions(parser), QStringList{ u"Failed to record traffic to "_s + invalidFileName });
+}
+
+void TestDeviceCommand::processOptions_threadPolicy()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QCommandLineParser parser;
+    parser.addOption({u"device-thread"_s, u"description"_s, u"policy"_s});
+    parser.addOption({u"output-file"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"sink-threads"_s, u"description"_s, u"policy"_s});
+    parser.process(QStringList{ u"dokit"_s });
+
+    MockDeviceCommand command;
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(!command.deviceThreadPolicy);
+    QVERIFY(!command.sinkThreadPolicy);
+
+    parser.process(QStringList{ u"dokit"_s, u"--device-thread"_s, u"1:realtime"_s, u"--sink-threads"_s,
+                                u"normal"_s, u"--output-file"_s, dir.filePath(u"out.csv"_s) });
+    MockDeviceCommand threaded;
+    QCOMPARE(threaded.processOptions(parser), QStringList{});
+    QVERIFY(threaded.deviceThreadPolicy);
+    QCOMPARE(threaded.deviceThreadPolicy->cpus, QVector<int>{ 1 });
+    QCOMPARE(threaded.deviceThreadPolicy->priority, ThreadPolicy::Priority::Realtime);
+    QVERIFY(threaded.sinkThreadPolicy);
+    QVERIFY(threaded.sinkThreadPolicy->cpus.isEmpty());
+    QVERIFY(threaded.outputFile);
+    QTRY_VERIFY(threaded.outputFile->threadPolicy().applied); // Applied by the writer thread itself.
+
+    parser.process(QStringList{ u"dokit"_s, u"--device-thread"_s, u"fastest"_s, u"--sink-threads"_s, u"1-"_s });
+    MockDeviceCommand invalid;
+    QCOMPARE(invalid.processOptions(parser), QStringList({ u"Invalid device thread policy: fastest"_s,
+                                                           u"Invalid sink threads policy: 1-"_s }));
+    QVERIFY(!invalid.deviceThreadPolicy);
+    QVERIFY(!invalid.sinkThreadPolicy);
+}
+
 void TestDeviceCommand::start()
 {
     if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
@@ -63,11 +259,294 @@ void TestDeviceCommand::start()
     QVERIFY(command.start());
 }
 
+void TestDeviceCommand::startWithDevice()
+{
+    // Cannot test DeviceCommand::startWithDevice() without a valid, connected, device.
+}
+
 void TestDeviceCommand::disconnect()
 {
     // Cannot test DeviceCommand::disconnect() without a valid device controller.
 }
 
+void TestDeviceCommand::finish_shared()
+{
+    MockDeviceCommand command;
+    command.deviceIsShared = true;
+    QSignalSpy spy(&command, &DeviceCommand::finished);
+    command.finish(EXIT_FAILURE);
+    command.finish(EXIT_SUCCESS);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(0).toInt(), EXIT_FAILURE);
+    QCOMPARE(spy.at(1).at(0).toInt(), EXIT_SUCCESS);
+}
+
+void TestDeviceCommand::usesDiscoveredValues()
+{
+    MockDeviceCommand command;
+    QVERIFY(!command.usesDiscoveredValues());
+}
+
+void TestDeviceCommand::restoreDiscoveryCache()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString serviceKey = u"test/services/"_s + QString::fromLatin1(DsoService::staticMetaObject.className());
+
+    // Without a cache, nothing should be restored.
+    MockDeviceCommand command;
+    DsoService service(nullptr);
+    command.restoreDiscoveryCache(&service);
+    QVERIFY(!service.skipValueDiscovery());
+
+    // With a cache, but no layout for this service, value discovery should not be skipped.
+    command.discoveryCache = new QSettings(dir.filePath(u"cache.ini"_s), QSettings::IniFormat, &command);
+    command.discoveryCacheKey = u"test"_s;
+    command.restoreDiscoveryCache(&service);
+    QVERIFY(!service.skipValueDiscovery());
+
+    // With a cached layout, value discovery should be skipped.
+    command.discoveryCache->setValue(serviceKey, QStringList{ u"a"_s, u"b"_s });
+    command.restoreDiscoveryCache(&service);
+    QVERIFY(service.skipValueDiscovery());
+    QCOMPARE(command.discoveryCache->group(), QString()); // Group restored.
+}
+
+void TestDeviceCommand::saveDiscoveryCache()
+{
+    // Services without service objects (ie not yet discovered) should be ignored.
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    MockDeviceCommand command;
+    command.discoveryCache = new QSettings(dir.filePath(u"cache.ini"_s), QSettings::IniFormat, &command);
+    command.discoveryCacheKey = u"test"_s;
+    command.saveDiscoveryCache(nullptr);
+    DsoService service(nullptr);
+    command.saveDiscoveryCache(&service);
+    QVERIFY(command.discoveryCache->allKeys().isEmpty());
+}
+
+void TestDeviceCommand::knownDevice()
+{
+    // Without a known-device store, no devices are known.
+    MockDeviceCommand command;
+    QVERIFY(!command.knownDevice(u"Pokit Pro"_s));
+
+    const QTemporaryDir dir;
+    command.knownDevices = new QSettings(dir.filePath(u"known.ini"_s), QSettings::IniFormat, &command);
+    command.knownDevices->setValue(u"11:22:33:44:55:66/name"_s, u"Bench"_s);
+    command.knownDevices->setValue(u"11:22:33:44:55:66/address"_s, u"11:22:33:44:55:66"_s);
+    command.knownDevices->setValue(u"11:22:33:44:55:66/product"_s, u"Pokit Pro"_s);
+    command.knownDevices->setValue(u"11:22:33:44:55:66/lastSeen"_s, u"2025-01-01T00:00:00Z"_s);
+    command.knownDevices->setValue(u"AA:BB:CC:DD:EE:FF/name"_s, u"Bench"_s);
+    command.knownDevices->setValue(u"AA:BB:CC:DD:EE:FF/address"_s, u"AA:BB:CC:DD:EE:FF"_s);
+    command.knownDevices->setValue(u"AA:BB:CC:DD:EE:FF/product"_s, u"Pokit Meter"_s);
+    command.knownDevices->setValue(u"AA:BB:CC:DD:EE:FF/lastSeen"_s, u"2025-06-01T00:00:00Z"_s);
+    const QString uuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    command.knownDevices->setValue(uuid + u"/name"_s, u"Mac"_s);
+    command.knownDevices->setValue(uuid + u"/uuid"_s, uuid);
+    command.knownDevices->setValue(uuid + u"/product"_s, u"Pokit Pro"_s);
+
+    QVERIFY(!command.knownDevice(QString()));
+    QVERIFY(!command.knownDevice(u"unknown"_s));
+
+    // Match by address.
+    std::optional<QBluetoothDeviceInfo> info = command.knownDevice(u"11:22:33:44:55:66"_s);
+    QVERIFY(info);
+    QCOMPARE(info->address(), QBluetoothAddress(u"11:22:33:44:55:66"_s));
+    QCOMPARE(info->name(), u"Bench"_s);
+    QVERIFY(isPokitProduct(*info));
+    QVERIFY(pokitProduct(*info) == PokitProduct::PokitPro);
+    QVERIFY(info->coreConfigurations() == QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+
+    // Match by name, preferring the most recently seen.
+    info = command.knownDevice(u"Bench"_s);
+    QVERIFY(info);
+    QCOMPARE(info->address(), QBluetoothAddress(u"AA:BB:CC:DD:EE:FF"_s));
+    QVERIFY(pokitProduct(*info) == PokitProduct::PokitMeter);
+
+    // Match by (macOS) UUID.
+    info = command.knownDevice(uuid);
+    QVERIFY(info);
+    QCOMPARE(info->deviceUuid(), QBluetoothUuid(uuid));
+    QVERIFY(info->address().isNull());
+    QVERIFY(pokitProduct(*info) == PokitProduct::PokitPro);
+}
+
+void TestDeviceCommand::saveKnownDevice()
+{
+    // Without a known-device store, saving is a no-op.
+    MockDeviceCommand command;
+    QBluetoothDeviceInfo info(QBluetoothAddress(u"11:22:33:44:55:66"_s), u"Bench"_s, 0);
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 13, 0))
+    info.setServiceUuids({ StatusService::ServiceUuids::pokitPro }, QBluetoothDeviceInfo::DataIncomplete);
+    #else
+    info.setServiceUuids({ StatusService::ServiceUuids::pokitPro });
+    #endif
+    command.saveKnownDevice(info);
+
+    const QTemporaryDir dir;
+    command.knownDevices = new QSettings(dir.filePath(u"known.ini"_s), QSettings::IniFormat, &command);
+    const QDateTime before = QDateTime::currentDateTimeUtc().addSecs(-1);
+    command.saveKnownDevice(info);
+    QCOMPARE(command.knownDevices->childGroups(), QStringList{ u"11:22:33:44:55:66"_s });
+    QCOMPARE(command.knownDevices->value(u"11:22:33:44:55:66/name"_s).toString(), u"Bench"_s);
+    QCOMPARE(command.knownDevices->value(u"11:22:33:44:55:66/product"_s).toString(), u"Pokit Pro"_s);
+    QVERIFY(!command.knownDevices->contains(u"11:22:33:44:55:66/uuid"_s));
+    QVERIFY(QDateTime::fromString(command.knownDevices->value(u"11:22:33:44:55:66/lastSeen"_s).toString(),
+                                  Qt::ISODate) >= before);
+    QCOMPARE(command.knownDevices->group(), QString()); // Group restored.
+
+    // Verify that saved devices are then known.
+    const std::optional<QBluetoothDeviceInfo> known = command.knownDevice(u"Bench"_s);
+    QVERIFY(known);
+    QCOMPARE(known->address(), info.address());
+    QVERIFY(pokitProduct(*known) == PokitProduct::PokitPro);
+}
+
+void TestDeviceCommand::formatStatistics()
+{
+    PokitDevice::Statistics statistics;
+    statistics.connections = 2;
+    statistics.disconnections = 1;
+    statistics.reconnections = 1;
+    statistics.errors = 3;
+    AbstractPokitService::Statistics service;
+    service.service = DsoService::serviceUuid;
+    service.notifications = 10;
+    service.reads = 2;
+    service.bytes = 500;
+    service.parseFailures = 1;
+    service.stalls = 2;
+    service.stallRecoveries = 1;
+    service.memoryBytes = 4096;
+    service.notificationGaps[0] = 4;
+    service.notificationGaps[5] = 5;
+    statistics.services.append(service);
+    statistics.services.append(AbstractPokitService::Statistics{}); // Service object not created yet.
+
+    const QStringList lines = DeviceCommand::formatStatistics(statistics).split(u'\n');
+    QCOMPARE(lines.size(), 7); // Including the empty string after the final newline.
+    QCOMPARE(lines.at(0), u"# link statistics"_s);
+    QCOMPARE(lines.at(1), u"device: connections=2 disconnections=1 reconnections=1 reconnectFailures=0 errors=3"_s);
+    QCOMPARE(lines.at(2), QStringLiteral("service \"DSO\": notifications=10 reads=2 bytes=500 parseFailures=1 errors=0 "
+        "stalls=2 stallRecoveries=1 memoryBytes=4096"));
+    QCOMPARE(lines.at(3), QStringLiteral("service \"DSO\": gaps(ms): <1=4 1-2=0 2-4=0 4-8=0 8-16=0 16-32=5 "
+        "32-64=0 64-128=0 128-256=0 256-512=0 512-1024=0 1024-2048=0 2048-4096=0 4096-8192=0 8192-16384=0 >=16384=0"));
+    QCOMPARE(lines.at(4), QStringLiteral("service \"unknown\": notifications=0 reads=0 bytes=0 parseFailures=0 "
+        "errors=0 stalls=0 stallRecoveries=0 memoryBytes=0"));
+    QVERIFY(lines.at(5).startsWith(u"service \"unknown\": gaps(ms): <1=0 1-2=0"_s));
+    QVERIFY(lines.at(6).isEmpty());
+}
+
+void TestDeviceCommand::formatSinkStatistics()
+{
+    OutputFileWriter::Statistics output;
+    output.bytesWritten = 1000;
+    output.writes = 3;
+    output.dropped = 2;
+    output.bytesDropped = 40;
+    output.blocked = 1;
+    output.blockedTime = 12'500'000;
+    QCOMPARE(DeviceCommand::formatSinkStatistics(u"stdout"_s, output),
+             u"sink \"stdout\": bytes=1000 writes=3 dropped=2 bytesDropped=40 blocked=1 blockedMs=12 errors=0\n"_s);
+
+    InfluxWriter::Statistics influx;
+    influx.points = 100;
+    influx.batches = 4;
+    influx.written = 2;
+    influx.retries = 5;
+    influx.dropped = 1;
+    QCOMPARE(DeviceCommand::formatSinkStatistics(influx),
+             u"sink \"influx\": points=100 skipped=0 batches=4 written=2 retries=5 rejected=0 dropped=1\n"_s);
+}
+
+void TestDeviceCommand::formatMemoryStatistics()
+{
+    MemoryBudget::Statistics statistics;
+    statistics.limit = 1'000'000;
+    statistics.bytes = 3072;
+    statistics.peak = 8192;
+    statistics.refusals = 3;
+    statistics.streams.append({ u"output"_s, MemoryBudget::Kind::Output, 3072, 8192, 4096, 3 });
+    statistics.streams.append({ u"ringBuffer"_s, MemoryBudget::Kind::RingBuffer, 0, 0, 0, 0 }); // Omitted.
+    QCOMPARE(DeviceCommand::formatMemoryStatistics(statistics), QStringLiteral(
+        "memory: limit=1000000 bytes=3072 peak=8192 refusals=3\n"
+        "memory \"output\": kind=output bytes=3072 peak=8192 quota=4096 refusals=3\n"));
+}
+
+void TestDeviceCommand::formatPipelineStatistics()
+{
+    QVector<SampleGraph::StageStatistics> statistics(2);
+    statistics[0] = { u"source"_s, SampleGraph::Stage::Source, { }, 2, 10, 2, 10, 0, 0, 3'000, 3'333'333.3 };
+    statistics[1] = { u"mean"_s, SampleGraph::Stage::Aggregate, { u"source"_s, u"lp"_s }, 2, 10, 1, 2, 3, 5, 1'500,
+                      6'666'666.7 };
+    QCOMPARE(DeviceCommand::formatPipelineStatistics(statistics), QStringLiteral(
+        "pipeline \"source\": stage=source inputs= blocksIn=2 valuesIn=10 blocksOut=2 valuesOut=10 queueDepth=0 "
+        "peakQueueDepth=0 busyUs=3 throughput=3333333\n"
+        "pipeline \"mean\": stage=aggregate inputs=source,lp blocksIn=2 valuesIn=10 blocksOut=1 valuesOut=2 "
+        "queueDepth=3 peakQueueDepth=5 busyUs=1 throughput=6666667\n"));
+}
+
+void TestDeviceCommand::formatThreadStatistics()
+{
+    ThreadPolicy::State state;
+    state.applied = true;
+    state.cpus = { 0, 2, 3 };
+    state.priority = ThreadPolicy::Priority::Realtime;
+    state.realtimePriority = 10;
+    QCOMPARE(DeviceCommand::formatThreadStatistics(u"device"_s, state),
+             u"thread \"device\": cpus=0,2-3 priority=realtime realtimePriority=10 errors=0\n"_s);
+
+    state = ThreadPolicy::State{};
+    state.errors = QStringList{ u"Failed to set high thread priority: Permission denied"_s };
+    QCOMPARE(DeviceCommand::formatThreadStatistics(u"out.csv"_s, state),
+             u"thread \"out.csv\": cpus= priority=normal realtimePriority=0 errors=1\n"_s);
+}
+
+void TestDeviceCommand::outputStatistics()
+{
+    // Verify safe handling, before any device has been found.
+    MockDeviceCommand command;
+    command.outputStatistics();
+}
+
+void TestDeviceCommand::formatLatencyReport()
+{
+    PokitDevice::Statistics statistics;
+    AbstractPokitService::Statistics service;
+    for (const qint64 latency: { 2'000, 4'000, 6'000, 8'000 }) {
+        service.parseLatency.record(latency);
+        service.emitLatency.record(latency * 10);
+    }
+    statistics.services.append(service);
+    service = AbstractPokitService::Statistics{};
+    service.parseLatency.record(1'000); // Merged with the first service's latencies.
+    statistics.services.append(service);
+    LatencyHistogram formatLatency, writeLatency;
+    formatLatency.record(50'000);
+
+    const QStringList lines = DeviceCommand::formatLatencyReport(statistics, formatLatency, writeLatency).split(u'\n');
+    QCOMPARE(lines.size(), 6); // Including the empty string after the final newline.
+    QCOMPARE(lines.at(0), u"# latency report (us)"_s);
+    QCOMPARE(lines.at(1), QStringLiteral("stage \"parse\": count=5 min=1.0 p50=4.0 p90=8.0 p99=8.0 p99.9=8.0 "
+        "max=8.0 jitter=4.0"));
+    QCOMPARE(lines.at(2), QStringLiteral("stage \"emit\": count=4 min=20.0 p50=41.0 p90=80.0 p99=80.0 p99.9=80.0 "
+        "max=80.0 jitter=39.0"));
+    QCOMPARE(lines.at(3), QStringLiteral("stage \"format\": count=1 min=50.0 p50=50.0 p90=50.0 p99=50.0 p99.9=50.0 "
+        "max=50.0 jitter=0.0"));
+    QCOMPARE(lines.at(4), QStringLiteral("stage \"write\": count=0 min=0.0 p50=0.0 p90=0.0 p99=0.0 p99.9=0.0 "
+        "max=0.0 jitter=0.0"));
+    QVERIFY(lines.at(5).isEmpty());
+}
+
+void TestDeviceCommand::outputLatencyReport()
+{
+    // Verify safe handling, before any device has been found.
+    MockDeviceCommand command;
+    command.outputLatencyReport();
+}
+
 void TestDeviceCommand::minRange_meter_current_data()
 {
     QTest::addColumn<quint32>("maxValue");
@@ -320,6 +799,544 @@ void TestDeviceCommand::minVoltageRange()
     QCOMPARE(actual, (quint8)PokitPro::VoltageRange::_125V);
 }
 
+void TestDeviceCommand::parseFilters_data()
+{
+    QTest::addColumn<QStringList>("specs");
+    QTest::addColumn<QVector<float>>("expectedTaps");
+    QTest::addColumn<QList<double>>("expectedFrequencies"); // Per biquad section; 0 for custom sections.
+    QTest::addColumn<QList<double>>("expectedQs");          // Per biquad section; 0 for custom sections.
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none")
+        << QStringList{} << QVector<float>{} << QList<double>{} << QList<double>{} << QStringList{};
+    QTest::addRow("lowpass")
+        << QStringList{ u"lowpass:100"_s } << QVector<float>{} << QList<double>{ 100.0 }
+        << QList<double>{ 0.7071067811865476 } << QStringList{};
+    QTest::addRow("highpass:q")
+        << QStringList{ u"HighPass:1.5kHz:0.5"_s } << QVector<float>{} << QList<double>{ 1500.0 }
+        << QList<double>{ 0.5 } << QStringList{};
+    QTest::addRow("notch")
+        << QStringList{ u"notch:50Hz"_s } << QVector<float>{} << QList<double>{ 50.0 } << QList<double>{ 10.0 }
+        << QStringList{};
+    QTest::addRow("biquad")
+        << QStringList{ u"biquad:1,0,0,-0.5,0"_s } << QVector<float>{} << QList<double>{ 0.0 }
+        << QList<double>{ 0.0 } << QStringList{};
+    QTest::addRow("fir")
+        << QStringList{ u"fir:0.25, 0.5, 0.25"_s } << QVector<float>{ 0.25f, 0.5f, 0.25f } << QList<double>{}
+        << QList<double>{} << QStringList{};
+    QTest::addRow("cascade")
+        << QStringList{ u"notch:60"_s, u"fir:1"_s, u"lowpass:0.5"_s } << QVector<float>{ 1.0f }
+        << QList<double>{ 60.0, 0.5 } << QList<double>{ 10.0, 0.7071067811865476 } << QStringList{};
+
+    QTest::addRow("unknown")
+        << QStringList{ u"bandpass:100"_s } << QVector<float>{} << QList<double>{} << QList<double>{}
+        << QStringList{ u"Unknown filter type: bandpass:100"_s };
+    QTest::addRow("missing-frequency")
+        << QStringList{ u"lowpass"_s } << QVector<float>{} << QList<double>{} << QList<double>{}
+        << QStringList{ u"Invalid filter: lowpass"_s };
+    QTest::addRow("invalid-frequency")
+        << QStringList{ u"lowpass:fast"_s } << QVector<float>{} << QList<double>{} << QList<double>{}
+        << QStringList{ u"Invalid filter: lowpass:fast"_s };
+    QTest::addRow("invalid-q")
+        << QStringList{ u"notch:50:0"_s, u"notch:50:-1"_s, u"notch:50:10:1"_s } << QVector<float>{}
+        << QList<double>{} << QList<double>{} << QStringList{ u"Invalid filter: notch:50:0"_s,
+           u"Invalid filter: notch:50:-1"_s, u"Invalid filter: notch:50:10:1"_s };
+    QTest::addRow("invalid-biquad")
+        << QStringList{ u"biquad:1,0,0,0"_s, u"biquad:1,0,0,0,x"_s } << QVector<float>{} << QList<double>{}
+        << QList<double>{} << QStringList{ u"Invalid filter: biquad:1,0,0,0"_s,
+           u"Invalid filter: biquad:1,0,0,0,x"_s };
+    QTest::addRow("invalid-fir")
+        << QStringList{ u"fir"_s, u"fir:"_s, u"fir:1,inf"_s } << QVector<float>{} << QList<double>{}
+        << QList<double>{} << QStringList{ u"Invalid filter: fir"_s, u"Invalid filter: fir:"_s,
+           u"Invalid filter: fir:1,inf"_s };
+    QTest::addRow("multiple-fir")
+        << QStringList{ u"fir:1"_s, u"fir:0.5,0.5"_s } << QVector<float>{} << QList<double>{} << QList<double>{}
+        << QStringList{ u"Only one FIR filter may be provided: fir:0.5,0.5"_s };
+}
+
+void TestDeviceCommand::parseFilters()
+{
+    QFETCH(QStringList, specs);
+    QFETCH(QVector<float>, expectedTaps);
+    QFETCH(QList<double>, expectedFrequencies);
+    QFETCH(QList<double>, expectedQs);
+    QFETCH(QStringList, expectedErrors);
+
+    SampleFilter filter;
+    QCOMPARE(DeviceCommand::parseFilters(specs, &filter), expectedErrors);
+    QCOMPARE(filter.firTaps(), expectedTaps);
+    const QVector<SampleFilter::Biquad> sections = filter.biquads();
+    QCOMPARE(sections.size(), expectedFrequencies.size());
+    for (qsizetype index = 0; index < sections.size(); ++index) {
+        QCOMPARE(sections.at(index).frequency, expectedFrequencies.at(index));
+        QCOMPARE(sections.at(index).q, expectedQs.at(index));
+        QCOMPARE(sections.at(index).response == SampleFilter::Response::Custom, expectedFrequencies.at(index) == 0.0);
+    }
+}
+
+void TestDeviceCommand::parseEvent_data()
+{
+    QTest::addColumn<QString>("spec");
+    QTest::addColumn<bool>("expected");
+    QTest::addColumn<EventDetector::Quantity>("expectedQuantity");
+    QTest::addColumn<EventDetector::Direction>("expectedDirection");
+    QTest::addColumn<float>("expectedThreshold");
+    QTest::addColumn<float>("expectedHysteresis");
+    QTest::addColumn<quint32>("expectedMinDuration");
+
+    using Quantity  = EventDetector::Quantity;
+    using Direction = EventDetector::Direction;
+    QTest::addRow("above")
+        << u"above:2.5"_s << true << Quantity::Value << Direction::Above << 2.5f << 0.0f << 0u;
+    QTest::addRow("below-hysteresis")
+        << u"Below:-1:0.25"_s << true << Quantity::Value << Direction::Below << -1.0f << 0.25f << 0u;
+    QTest::addRow("rate-above-duration")
+        << u"rate-above:10:1:500ms"_s << true << Quantity::RateOfChange << Direction::Above << 10.0f << 1.0f
+        << 500u;
+    QTest::addRow("rate-below-seconds")
+        << u"rate-below:-10::2s"_s << true << Quantity::RateOfChange << Direction::Below << -10.0f << 0.0f << 2000u;
+    QTest::addRow("zero-duration")
+        << u"above:1:0:0"_s << true << Quantity::Value << Direction::Above << 1.0f << 0.0f << 0u;
+
+    QTest::addRow("empty")
+        << QString() << false << Quantity::Value << Direction::Above << 0.0f << 0.0f << 0u;
+    QTest::addRow("no-threshold")
+        << u"above"_s << false << Quantity::Value << Direction::Above << 0.0f << 0.0f << 0u;
+    QTest::addRow("unknown-type")
+        << u"beside:1"_s << false << Quantity::Value << Direction::Above << 0.0f << 0.0f << 0u;
+    QTest::addRow("invalid-threshold")
+        << u"above:one"_s << false << Quantity::Value << Direction::Above << 0.0f << 0.0f << 0u;
+    QTest::addRow("negative-hysteresis")
+        << u"above:1:-1"_s << false << Quantity::Value << Direction::Above << 0.0f << 0.0f << 0u;
+    QTest::addRow("invalid-duration")
+        << u"above:1:0:soon"_s << false << Quantity::Value << Direction::Above << 0.0f << 0.0f << 0u;
+    QTest::addRow("too-many-parts")
+        << u"above:1:0:1s:more"_s << false << Quantity::Value << Direction::Above << 0.0f << 0.0f << 0u;
+}
+
+void TestDeviceCommand::parseEvent()
+{
+    QFETCH(QString, spec);
+    QFETCH(bool, expected);
+
+    EventDetector::Settings settings = EventDetector::defaultSettings();
+    QCOMPARE(DeviceCommand::parseEvent(spec, settings), expected);
+    if (expected) {
+        QFETCH(EventDetector::Quantity, expectedQuantity);
+        QFETCH(EventDetector::Direction, expectedDirection);
+        QFETCH(float, expectedThreshold);
+        QFETCH(float, expectedHysteresis);
+        QFETCH(quint32, expectedMinDuration);
+        QCOMPARE(settings.quantity,    expectedQuantity);
+        QCOMPARE(settings.direction,   expectedDirection);
+        QCOMPARE(settings.threshold,   expectedThreshold);
+        QCOMPARE(settings.hysteresis,  expectedHysteresis);
+        QCOMPARE(settings.minDuration, expectedMinDuration);
+    }
+}
+
+void TestDeviceCommand::parseThreadPolicy_data()
+{
+    QTest::addColumn<QString>("spec");
+    QTest::addColumn<bool>("expected");
+    QTest::addColumn<QVector<int>>("expectedCpus");
+    QTest::addColumn<ThreadPolicy::Priority>("expectedPriority");
+    QTest::addColumn<int>("expectedRealtimePriority");
+
+    using Priority = ThreadPolicy::Priority;
+    QTest::addRow("cpu")           << u"2"_s             << true << QVector<int>{ 2 }       << Priority::Normal   << 10;
+    QTest::addRow("cpus")          << u"0,2-3"_s         << true << QVector<int>{ 0, 2, 3 } << Priority::Normal   << 10;
+    QTest::addRow("high")          << u"high"_s          << true << QVector<int>{ }         << Priority::High     << 10;
+    QTest::addRow("realtime")      << u"Realtime"_s      << true << QVector<int>{ }         << Priority::Realtime << 10;
+    QTest::addRow("realtimeLevel") << u"realtime:50"_s   << true << QVector<int>{ }         << Priority::Realtime << 50;
+    QTest::addRow("cpusNormal")    << u"1:normal"_s      << true << QVector<int>{ 1 }       << Priority::Normal   << 10;
+    QTest::addRow("cpusHigh")      << u"1-2:high"_s      << true << QVector<int>{ 1, 2 }    << Priority::High     << 10;
+    QTest::addRow("cpusRealtime")  << u"3:realtime:99"_s << true << QVector<int>{ 3 }       << Priority::Realtime << 99;
+    QTest::addRow("noCpus")        << u":realtime:1"_s   << true << QVector<int>{ }         << Priority::Realtime << 1;
+
+    for (const QString &spec: { u""_s, u":"_s, u"2:"_s, u"fastest"_s, u"2:fastest"_s, u"-1"_s, u"realtime:0"_s,
+                                u"realtime:100"_s, u"realtime:abc"_s, u"high:10"_s, u"realtime:10:20"_s }) {
+        QTest::addRow("%s", spec.isEmpty() ? "empty" : qUtf8Printable(spec)) << spec << false << QVector<int>{ }
+            << ThreadPolicy::Priority::Normal << 0;
+    }
+}
+
+void TestDeviceCommand::parseThreadPolicy()
+{
+    QFETCH(QString, spec);
+    QFETCH(bool, expected);
+
+    ThreadPolicy::Settings settings;
+    QCOMPARE(DeviceCommand::parseThreadPolicy(spec, settings), expected);
+    if (expected) {
+        QFETCH(QVector<int>, expectedCpus);
+        QFETCH(ThreadPolicy::Priority, expectedPriority);
+        QFETCH(int, expectedRealtimePriority);
+        QCOMPARE(settings.cpus,             expectedCpus);
+        QCOMPARE(settings.priority,         expectedPriority);
+        QCOMPARE(settings.realtimePriority, expectedRealtimePriority);
+    }
+}
+
+void TestDeviceCommand::addEventDetectors()
+{
+    {
+        MockDeviceCommand command;
+        QCOMPARE(command.addEventDetectors({ u"above:1"_s, u" rate-below:-5 "_s }), QStringList{});
+        QCOMPARE(command.eventDetectors.size(), 2);
+        QCOMPARE(command.eventDetectors.at(0)->objectName(), u"above:1"_s);
+        QCOMPARE(command.eventDetectors.at(1)->objectName(), u"rate-below:-5"_s);
+        QCOMPARE(command.eventDetectors.at(1)->settings().quantity, EventDetector::Quantity::RateOfChange);
+    }
+
+    {
+        MockDeviceCommand command;
+        command.format = AbstractCommand::OutputFormat::Binary;
+        QCOMPARE(command.addEventDetectors({ u"above:1"_s, u"above:x"_s }), (QStringList{
+            u"Invalid event: above:x"_s,
+            u"Binary output is only supported for raw values, not --event"_s }));
+        QCOMPARE(command.eventDetectors.size(), 1);
+    }
+}
+
+void TestDeviceCommand::outputEvent_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("csv") << AbstractCommand::OutputFormat::Csv << QByteArray(
+        "condition,start,end,duration,peak,count,unit\n"
+        "above:2,2023-11-14T22:13:20.000Z,2023-11-14T22:13:21.500Z,1500,2.5,16,Vdc\n");
+    QTest::addRow("ndjson") << AbstractCommand::OutputFormat::Ndjson << QByteArray(
+        R"({"condition":"above:2","count":16,"duration":1500,"end":"2023-11-14T22:13:21.500Z","peak":2.5,)"
+        R"("start":"2023-11-14T22:13:20.000Z","unit":"Vdc"})" "\n");
+    QTest::addRow("text") << AbstractCommand::OutputFormat::Text << QByteArray(
+        "above:2: 2023-11-14T22:13:20.000Z to 2023-11-14T22:13:21.500Z (1500ms), peaking at 2.5 Vdc, "
+        "over 16 value/s\n");
+}
+
+void TestDeviceCommand::outputEvent()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(QByteArray, expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    MockDeviceCommand command;
+    command.format = format;
+    command.eventUnit = u"Vdc"_s;
+    command.outputEvent(u"above:2"_s, { 1700000000000, 1700000001500, 2.5f, 16 });
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestDeviceCommand::addPipeline_data()
+{
+    // Any %1 in the config, and expected errors, is replaced with a temporary directory, for the sinks' files.
+    QTest::addColumn<QString>("config");
+    QTest::addColumn<QStringList>("expectedStages");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("fanOut")
+        << u"lp = filter:lowpass:50; raw = sink:csv:%1/raw.csv; smooth = sink:ndjson:%1/lp.ndjson <- lp"_s
+        << QStringList{ u"source"_s, u"lp"_s, u"raw"_s, u"smooth"_s }
+        << QStringList{ };
+
+    QTest::addRow("comments")
+        << QStringLiteral("# Comment\nmean = aggregate:1s # One second windows.\nhigh = detect:above:5 <- mean\n"
+           "grid = resample:500ms:hold ; out = sink:csv:%1/out.csv <- high, grid\n")
+        << QStringList{ u"source"_s, u"mean"_s, u"high"_s, u"grid"_s, u"out"_s }
+        << QStringList{ };
+
+    QTest::addRow("expression")
+        << QStringLiteral("mA = expression:source * 1000; lp = filter:lowpass:50; "
+           "ripple = expression:abs(source - lp) <- source, lp; out = sink:csv:%1/out.csv <- mA, ripple")
+        << QStringList{ u"source"_s, u"mA"_s, u"lp"_s, u"ripple"_s, u"out"_s }
+        << QStringList{ };
+
+    QTest::addRow("noSinks")
+        << u"lp = filter:lowpass:50"_s
+        << QStringList{ u"source"_s, u"lp"_s }
+        << QStringList{ u"Pipeline has no sinks: lp = filter:lowpass:50"_s };
+
+    QTest::addRow("missingName")
+        << u" = sink:csv:%1/out.csv"_s
+        << QStringList{ u"source"_s }
+        << QStringList{ u"Invalid pipeline stage: = sink:csv:%1/out.csv"_s };
+
+    QTest::addRow("unknownType")
+        << u"out = tee"_s
+        << QStringList{ u"source"_s }
+        << QStringList{ u"Unknown pipeline stage type: out = tee"_s };
+
+    QTest::addRow("invalidFilter")
+        << u"lp = filter:bandpass:50; out = sink:csv:%1/out.csv"_s
+        << QStringList{ u"source"_s, u"out"_s }
+        << QStringList{ u"Unknown filter type: bandpass:50"_s };
+
+    QTest::addRow("invalidAggregate")
+        << u"mean = aggregate:x; out = sink:csv:%1/out.csv"_s
+        << QStringList{ u"source"_s, u"out"_s }
+        << QStringList{ u"Invalid pipeline stage: mean = aggregate:x"_s };
+
+    QTest::addRow("invalidDetect")
+        << u"high = detect:beyond:5; out = sink:csv:%1/out.csv"_s
+        << QStringList{ u"source"_s, u"out"_s }
+        << QStringList{ u"Invalid pipeline stage: high = detect:beyond:5"_s };
+
+    QTest::addRow("invalidResample")
+        << u"grid = resample:1s:cubic; out = sink:csv:%1/out.csv"_s
+        << QStringList{ u"source"_s, u"out"_s }
+        << QStringList{ u"Invalid pipeline stage: grid = resample:1s:cubic"_s };
+
+    QTest::addRow("invalidExpression")
+        << u"mA = expression:foo * 2; out = sink:csv:%1/out.csv"_s
+        << QStringList{ u"source"_s, u"out"_s }
+        << QStringList{ uR"(Invalid expression "foo * 2": Unknown variable: foo)"_s };
+
+    QTest::addRow("invalidSink")
+        << u"out = sink:xml:%1/out.xml"_s
+        << QStringList{ u"source"_s }
+        << QStringList{ u"Invalid pipeline stage: out = sink:xml:%1/out.xml"_s };
+
+    QTest::addRow("unknownInput")
+        << u"out = sink:csv:%1/out.csv <- missing"_s
+        << QStringList{ u"source"_s }
+        << QStringList{ u"Invalid pipeline stage: out = sink:csv:%1/out.csv <- missing"_s };
+
+    QTest::addRow("emptyInputs")
+        << u"out = sink:csv:%1/out.csv <- "_s
+        << QStringList{ u"source"_s }
+        << QStringList{ u"Invalid pipeline stage: out = sink:csv:%1/out.csv <-"_s };
+}
+
+void TestDeviceCommand::addPipeline()
+{
+    QFETCH(QString, config);
+    QFETCH(QStringList, expectedStages);
+    QFETCH(QStringList, expectedErrors);
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    for (QString &error: expectedErrors) {
+        error.replace(u"%1"_s, dir.path());
+    }
+    MockDeviceCommand command;
+    QCOMPARE(command.addPipeline(config.replace(u"%1"_s, dir.path())), expectedErrors);
+    QVERIFY(command.pipeline);
+    QCOMPARE(command.pipeline->stageNames(), expectedStages);
+}
+
+void TestDeviceCommand::outputPipelineBlock()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile file(dir.filePath(u"test.pipeline"_s));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write(QStringLiteral("raw = sink:csv:%1\n# Comment.\nhalf = filter:fir:0.5; json = sink:ndjson:%2 <- half\n")
+        .arg(dir.filePath(u"raw.csv"_s), dir.filePath(u"half.ndjson"_s)).toUtf8());
+    file.close();
+
+    // The pipeline is read from the file, and each block fanned out to both sinks.
+    MockDeviceCommand command;
+    QCOMPARE(command.addPipeline(u"@"_s + file.fileName()), QStringList{});
+    QCOMPARE(command.pipelineSinks.size(), 2);
+    command.pipeline->addBlock({ 1000, 0.5, { 1.0f, -2.0f } });
+    command.pipeline->addBlock({ 2000, 0.0, { qQNaN() } });
+    command.outputPipelineBlock(u"unknown"_s, { 3000, 0.0, { 1.0f } }); // Ignored.
+    command.flushPipeline(); // Closes the sinks' files.
+
+    QFile csv(dir.filePath(u"raw.csv"_s));
+    QVERIFY(csv.open(QIODevice::ReadOnly));
+    QCOMPARE(csv.readAll(), QByteArray("timestamp,value\n1000.000,1\n1000.500,-2\n2000.000,nan\n"));
+    QFile ndjson(dir.filePath(u"half.ndjson"_s));
+    QVERIFY(ndjson.open(QIODevice::ReadOnly));
+    QCOMPARE(ndjson.readAll(), QByteArray(
+        "{\"timestamp\":1000,\"interval\":0.5,\"values\":[0.5,-1]}\n"
+        "{\"timestamp\":2000,\"interval\":0,\"values\":[null]}\n"));
+
+    MockDeviceCommand missing;
+    const QStringList errors = missing.addPipeline(u"@"_s + dir.filePath(u"missing.pipeline"_s));
+    QCOMPARE(errors.size(), 1);
+    QVERIFY(errors.at(0).startsWith(u"Failed to read pipeline file "_s));
+}
+
+void TestDeviceCommand::addChargeIntegrator_data()
+{
+    QTest::addColumn<QString>("period");
+    QTest::addColumn<QString>("gap");
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<quint32>("expectedPeriod");
+    QTest::addColumn<ChargeIntegrator::GapPolicy>("expectedPolicy");
+    QTest::addColumn<quint32>("expectedMaximumGap");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("defaults")
+        << u"60s"_s << QString() << AbstractCommand::OutputFormat::Csv
+        << 60000u << ChargeIntegrator::GapPolicy::Exclude << 0u << QStringList{};
+    QTest::addRow("hold")
+        << u"3600s"_s << u"Hold"_s << AbstractCommand::OutputFormat::Csv
+        << 3600000u << ChargeIntegrator::GapPolicy::Hold << 0u << QStringList{};
+    QTest::addRow("interpolate:10s")
+        << u"500ms"_s << u" interpolate :10s"_s << AbstractCommand::OutputFormat::Json
+        << 500u << ChargeIntegrator::GapPolicy::Interpolate << 10000u << QStringList{};
+    QTest::addRow("invalid")
+        << u"0"_s << u"foo:bar"_s << AbstractCommand::OutputFormat::Binary
+        << 0u << ChargeIntegrator::GapPolicy::Exclude << 0u << QStringList{
+            u"Invalid charge value: 0"_s,
+            u"Invalid charge-gap value: foo:bar"_s,
+            u"Invalid charge-gap duration: bar"_s,
+            u"Binary output is only supported for raw values, not --charge"_s };
+    QTest::addRow("too-many-parts")
+        << u"1s"_s << u"hold:1s:2s"_s << AbstractCommand::OutputFormat::Arrow
+        << 1000u << ChargeIntegrator::GapPolicy::Hold << 0u << QStringList{
+            u"Invalid charge-gap value: hold:1s:2s"_s,
+            u"Arrow output is only supported for raw values, not --charge"_s };
+}
+
+void TestDeviceCommand::addChargeIntegrator()
+{
+    QFETCH(QString, period);
+    QFETCH(QString, gap);
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(quint32, expectedPeriod);
+    QFETCH(ChargeIntegrator::GapPolicy, expectedPolicy);
+    QFETCH(quint32, expectedMaximumGap);
+    QFETCH(QStringList, expectedErrors);
+
+    MockDeviceCommand command;
+    command.format = format;
+    QCOMPARE(command.addChargeIntegrator(period, gap), expectedErrors);
+    QVERIFY(command.chargeIntegrator);
+    QCOMPARE(command.chargeIntegrator->period(), expectedPeriod);
+    QCOMPARE(command.chargeIntegrator->gapPolicy(), expectedPolicy);
+    QCOMPARE(command.chargeIntegrator->maximumGap(), expectedMaximumGap);
+}
+
+void TestDeviceCommand::outputCharge_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("csv") << AbstractCommand::OutputFormat::Csv << QByteArray(
+        "start,end,count,charge,average_current,duration,gaps,gap_duration\n"
+        "2023-11-14T22:13:20.000Z,2023-11-14T23:13:20.000Z,3601,500.000000,500.000000,3600000,1,5000\n");
+    QTest::addRow("ndjson") << AbstractCommand::OutputFormat::Ndjson << QByteArray(
+        R"({"averageCurrent":500,"charge":500,"count":3601,"duration":3600000,"end":"2023-11-14T23:13:20.000Z",)"
+        R"("gapDuration":5000,"gaps":1,"start":"2023-11-14T22:13:20.000Z"})" "\n");
+    QTest::addRow("text") << AbstractCommand::OutputFormat::Text << QByteArray(
+        "2023-11-14T22:13:20.000Z to 2023-11-14T23:13:20.000Z: 500.000000 mAh, averaging 500.000000 mA over "
+        "3600000ms, with 1 gap/s (5000ms)\n");
+}
+
+void TestDeviceCommand::outputCharge()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(QByteArray, expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    MockDeviceCommand command;
+    command.format = format;
+    command.outputCharge({ 1700000000000, 1700003600000, 3601, 0.5, 0.5, 3600000, 1, 5000 }); // 0.5A for an hour.
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestDeviceCommand::setWatchdogFactor_data()
+{
+    QTest::addColumn<QString>("factor");
+    QTest::addColumn<float>("expectedFactor");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("integer")  << u"5"_s   << 5.0f << QStringList{ };
+    QTest::addRow("fraction") << u"2.5"_s << 2.5f << QStringList{ };
+    QTest::addRow("one")      << u"1"_s   << 1.0f << QStringList{ };
+    QTest::addRow("too-low")  << u"0.5"_s << 0.0f << QStringList{ u"Invalid watchdog value: 0.5"_s };
+    QTest::addRow("invalid")  << u"abc"_s << 0.0f << QStringList{ u"Invalid watchdog value: abc"_s };
+    QTest::addRow("infinite") << u"inf"_s << 0.0f << QStringList{ u"Invalid watchdog value: inf"_s };
+}
+
+void TestDeviceCommand::setWatchdogFactor()
+{
+    QFETCH(QString, factor);
+    QFETCH(float, expectedFactor);
+    QFETCH(QStringList, expectedErrors);
+    MockDeviceCommand command;
+    QCOMPARE(command.setWatchdogFactor(factor), expectedErrors);
+    QCOMPARE(command.watchdogFactor, expectedFactor);
+}
+
+void TestDeviceCommand::startWatchdog()
+{
+    MultimeterService service(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    MockDeviceCommand command;
+
+    // Without the watchdog option, there is no watchdog.
+    command.startWatchdog(&service, 1000);
+    QVERIFY(!command.watchdog);
+
+    // With the option, the watchdog is created, and started.
+    QVERIFY(command.setWatchdogFactor(u"3"_s).isEmpty());
+    command.startWatchdog(&service, 1000);
+    QVERIFY(command.watchdog);
+    QCOMPARE(command.watchdog->service(), (AbstractPokitService *)&service);
+    QCOMPARE(command.watchdog->stallFactor(), 3.0f);
+    QCOMPARE(command.watchdog->expectedInterval(), (quint32)1000);
+    QCOMPARE(command.watchdog->stallTimeout(), (quint32)3000);
+    QVERIFY(command.watchdog->isActive());
+
+    // Starting again (such as when settings are re-written) re-uses the same watchdog, with the new interval.
+    StallWatchdog * const watchdog = command.watchdog;
+    command.startWatchdog(&service, 500);
+    QCOMPARE(command.watchdog, watchdog);
+    QCOMPARE(command.watchdog->expectedInterval(), (quint32)500);
+    QCOMPARE(command.watchdog->stallTimeout(), (quint32)2000); // Minimum timeout.
+    QVERIFY(command.watchdog->isActive());
+}
+
+void TestDeviceCommand::setRawCounts()
+{
+    MockDeviceCommand command;
+    command.format = AbstractCommand::OutputFormat::Csv;
+    QCOMPARE(command.setRawCounts({}), QStringList{});
+    QVERIFY(command.rawCounts);
+
+    command.format = AbstractCommand::OutputFormat::Arrow;
+    QCOMPARE(command.setRawCounts({ u"filter"_s, u"stats"_s }), QStringList({
+        u"Raw counts are only supported for unmodified sample output, not --filter, --stats"_s,
+        u"Raw counts are only supported for CSV, NDJSON, NDJSON-Envelope and text output"_s }));
+    QVERIFY(!command.rawCounts);
+}
+
+void TestDeviceCommand::formatScale()
+{
+    QCOMPARE(DeviceCommand::formatScale(0.5f), QByteArray("0.5"));
+    QCOMPARE(DeviceCommand::formatScale(0.1f), QByteArray("0.1"));
+    QCOMPARE(DeviceCommand::formatScale(1.0f), QByteArray("1"));
+    QCOMPARE(DeviceCommand::formatScale(9.1552734e-05f).toFloat(), 9.1552734e-05f); // Lossless.
+}
+
+void TestDeviceCommand::declareRawCounts()
+{
+    MeasurementFormatter::Context context;
+    context.mode = u"DC voltage"_s;
+    context.unit = u"Vdc"_s;
+    context.range = u"Up to 2V"_s;
+
+    const OutputStreamCapture capture(&std::cout);
+    MockDeviceCommand command;
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.declareRawCounts(context, 0.5f);
+    command.declareRawCounts(context, 0.5f); // Unchanged, so not declared again.
+    command.declareRawCounts(context, 0.25f);
+    command.format = AbstractCommand::OutputFormat::Text;
+    command.declareRawCounts(context, 0.25f);
+    command.format = AbstractCommand::OutputFormat::NdjsonEnvelope; // Declared within each envelope instead.
+    command.declareRawCounts(context, 1.0f);
+    command.flushOutput();
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"mode":"DC voltage","unit":"Vdc","range":"Up to 2V","scale":0.5})" "\n"
+        R"({"mode":"DC voltage","unit":"Vdc","range":"Up to 2V","scale":0.25})" "\n"
+        "Raw counts of DC voltage, range Up to 2V, at 0.25 Vdc per count\n"));
+}
+
 void TestDeviceCommand::controllerError()
 {
     MockDeviceCommand command;
@@ -345,6 +1362,10 @@ void TestDeviceCommand::deviceDisconnected()
 {
     MockDeviceCommand command;
     command.deviceDisconnected(); // Just logs a debug message, and exits.
+
+    // Failed direct connections to known devices are ignored (while scanning instead).
+    command.connectingDirectly = true;
+    command.deviceDisconnected();
 }
 
 void TestDeviceCommand::serviceError()
@@ -374,6 +1395,56 @@ void TestDeviceCommand::serviceDetailsDiscovered()
     command.serviceDetailsDiscovered(); // Just logs a debug message.
 }
 
+void TestDeviceCommand::serviceResumed()
+{
+    MockDeviceCommand command;
+    QTest::ignoreMessage(QtWarningMsg, "Resumed after reconnecting; no values were received for 500ms.");
+    command.serviceResumed(2000000000, 2500000000);
+    QTest::ignoreMessage(QtWarningMsg, "Resumed after reconnecting.");
+    command.serviceResumed(-1, 2500000000);
+}
+
+void TestDeviceCommand::saveCapabilities()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    MockDeviceCommand command;
+    command.discoveryCache = new QSettings(dir.filePath(u"cache.ini"_s), QSettings::IniFormat, &command);
+    command.discoveryCacheKey = u"test"_s;
+
+    // Capabilities without a firmware version should be ignored.
+    PokitDevice::Capabilities capabilities;
+    command.saveCapabilities(capabilities);
+    QVERIFY(command.discoveryCache->allKeys().isEmpty());
+
+    capabilities.firmwareVersion = QVersionNumber(1, 4);
+    capabilities.maximumSamplingRate = 1000;
+    capabilities.samplingBufferSize = 8192;
+    capabilities.loggerUpdateIntervalIs32bit = true;
+    capabilities.maximumVoltage = 850;
+    capabilities.maximumCurrent = 10;
+    capabilities.macAddress = QBluetoothAddress(u"5C:02:72:09:AA:25"_s);
+    command.discoveryCache->setValue(u"test/services/DsoService"_s, QStringList{ u"a"_s });
+    command.saveCapabilities(capabilities);
+    QCOMPARE(command.discoveryCache->value(u"test/firmwareVersion"_s).toString(), u"1.4"_s);
+    QCOMPARE(command.discoveryCache->value(u"test/maximumSamplingRate"_s).toUInt(), 1000u);
+    QCOMPARE(command.discoveryCache->value(u"test/samplingBufferSize"_s).toUInt(), 8192u);
+    QCOMPARE(command.discoveryCache->value(u"test/loggerUpdateIntervalIs32bit"_s).toBool(), true);
+    QCOMPARE(command.discoveryCache->value(u"test/maximumVoltage"_s).toUInt(), 850u);
+    QCOMPARE(command.discoveryCache->value(u"test/maximumCurrent"_s).toUInt(), 10u);
+    QCOMPARE(command.discoveryCache->value(u"test/macAddress"_s).toString(), u"5C:02:72:09:AA:25"_s);
+    QVERIFY(command.discoveryCache->contains(u"test/services/DsoService"_s)); // Same firmware, so still valid.
+
+    // A changed firmware version should invalidate the cached service layouts.
+    capabilities.firmwareVersion = QVersionNumber(1, 5);
+    capabilities.loggerUpdateIntervalIs32bit.reset();
+    command.saveCapabilities(capabilities);
+    QCOMPARE(command.discoveryCache->value(u"test/firmwareVersion"_s).toString(), u"1.5"_s);
+    QVERIFY(!command.discoveryCache->contains(u"test/services/DsoService"_s));
+    QVERIFY(!command.discoveryCache->contains(u"test/loggerUpdateIntervalIs32bit"_s));
+    QCOMPARE(command.discoveryCache->group(), QString()); // Group restored.
+}
+
 void TestDeviceCommand::deviceDiscovered()
 {
     MockDeviceCommand command;
@@ -8,9 +8,41 @@ class TestDeviceCommand : public QObject
     Q_OBJECT
 
 private slots:
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void processOptions_reconnect_data();
+    void processOptions_reconnect();
+
+    void processOptions_latencyReport();
+    void processOptions_linkStatistics();
+    void processOptions_record();
+    void processOptions_threadPolicy();
+
     void start();
+    void startWithDevice();
 
     void disconnect();
+    void finish_shared();
+
+    void usesDiscoveredValues();
+    void restoreDiscoveryCache();
+    void saveDiscoveryCache();
+
+    void knownDevice();
+    void saveKnownDevice();
+
+    void formatStatistics();
+    void formatSinkStatistics();
+    void formatMemoryStatistics();
+    void formatPipelineStatistics();
+    void formatThreadStatistics();
+    void outputStatistics();
+
+    void formatLatencyReport();
+    void outputLatencyReport();
 
     void minRange_meter_current_data();
     void minRange_meter_current();
@@ -41,6 +73,39 @@ private slots:
 
     void minVoltageRange();
 
+    void parseFilters_data();
+    void parseFilters();
+
+    void parseEvent_data();
+    void parseEvent();
+
+    void parseThreadPolicy_data();
+    void parseThreadPolicy();
+
+    void addEventDetectors();
+
+    void outputEvent_data();
+    void outputEvent();
+
+    void addPipeline_data();
+    void addPipeline();
+    void outputPipelineBlock();
+
+    void addChargeIntegrator_data();
+    void addChargeIntegrator();
+
+    void outputCharge_data();
+    void outputCharge();
+
+    void setWatchdogFactor_data();
+    void setWatchdogFactor();
+
+    void startWatchdog();
+
+    void setRawCounts();
+    void formatScale();
+    void declareRawCounts();
+
     void controllerError();
 
     void deviceDisconnected();
@@ -49,6 +114,10 @@ private slots:
 
     void serviceDetailsDiscovered();
 
+    void serviceResumed();
+
+    void saveCapabilities();
+
     void deviceDiscovered();
 
     void deviceDiscoveryFinished();
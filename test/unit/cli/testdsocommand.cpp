@@ -9,10 +9,17 @@
 
 #include "dsocommand.h"
 
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QtEndian>
+
 Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
 Q_DECLARE_METATYPE(DsoService::Mode)
 Q_DECLARE_METATYPE(DsoService::Settings)
 Q_DECLARE_METATYPE(DsoService::Metadata)
+Q_DECLARE_METATYPE(DsoStatistics::Summary)
+Q_DECLARE_METATYPE(DsoSpectrum::Spectrum)
+Q_DECLARE_METATYPE(PokitProduct)
 
 typedef quint8 (* minRangeFunc)(const PokitProduct product, const quint32 maxValue);
 Q_DECLARE_METATYPE(minRangeFunc)
@@ -49,8 +56,12 @@ void TestDsoCommand::supportedOptions()
     MockDeviceCommand mock;
     QCommandLineParser parser;
     const QStringList expected = command.requiredOptions(parser) + mock.supportedOptions(parser) +
-        QStringList{ u"interval"_s,      u"samples"_s,
-                     u"trigger-level"_s, u"trigger-mode"_s };
+        QStringList{ u"auto-range"_s,    u"bandwidth"_s,     u"compress"_s,      u"continuous"_s,
+                     u"duration"_s,      u"filter"_s,        u"influx"_s,        u"interval"_s,
+                     u"long-capture"_s,  u"mark-clipping"_s, u"mqtt"_s,          u"pipeline"_s,
+                     u"post-trigger"_s,  u"pre-trigger"_s,   u"raw"_s,           u"samples"_s,
+                     u"shared-memory"_s, u"soft-trigger"_s,  u"spectrum"_s,      u"stats"_s,
+                     u"trigger-level"_s, u"trigger-mode"_s,  u"wav"_s };
     QCOMPARE(command.supportedOptions(parser), expected);
 }
 
@@ -369,6 +380,29 @@ void TestDsoCommand::processOptions_data()
             +PokitMeter::VoltageRange::_2V, 1000*1000, 1000}
         << &DsoCommand::minVoltageRange << 1000u
         << QStringList{ u"Invalid samples value: -123"_s };
+
+    QTest::addRow("binary")
+        << QStringList{
+           u"--mode"_s,  u"Vdc"_s,
+           u"--range"_s, u"1000mV"_s,
+           u"--output"_s, u"binary"_s }
+        << DsoService::Settings{
+            DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage,
+            +PokitMeter::VoltageRange::_2V, 1000*1000, 1000}
+        << &DsoCommand::minVoltageRange << 1000u
+        << QStringList{ };
+
+    QTest::addRow("binary-stats")
+        << QStringList{
+           u"--mode"_s,  u"Vdc"_s,
+           u"--range"_s, u"1000mV"_s,
+           u"--output"_s, u"binary"_s,
+           u"--stats"_s }
+        << DsoService::Settings{
+            DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage,
+            +PokitMeter::VoltageRange::_2V, 1000*1000, 1000}
+        << &DsoCommand::minVoltageRange << 1000u
+        << QStringList{ u"Binary output is only supported for raw samples, not --spectrum or --stats"_s };
 }
 
 void TestDsoCommand::processOptions()
@@ -388,6 +422,8 @@ void TestDsoCommand::processOptions()
     parser.addOption({u"trigger-mode"_s, u"description"_s, u"trigger-mode"_s});
     parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
     parser.addOption({u"samples"_s, u"description"_s, u"samples"_s});
+    parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+    parser.addOption({u"stats"_s, u"description"_s});
     parser.process(arguments);
 
     if (expectedSettings.numberOfSamples > 8192) {
@@ -408,6 +444,363 @@ void TestDsoCommand::processOptions()
     QCOMPARE(command.rangeOptionValue,         expectedRangeOptionValue);
 }
 
+void TestDsoCommand::processOptions_longCapture()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const auto process = [](const QStringList &arguments, DsoCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+        parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+        parser.addOption({u"trigger-level"_s, u"description"_s, u"trigger-level"_s});
+        parser.addOption({u"trigger-mode"_s, u"description"_s, u"trigger-mode"_s});
+        parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+        parser.addOption({u"samples"_s, u"description"_s, u"samples"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"continuous"_s, u"description"_s});
+        parser.addOption({u"long-capture"_s, u"description"_s});
+        parser.addOption({u"stats"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"2V"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {   // Sample counts beyond the device's buffer (and even 16 bits) are fine, and not applied to the settings.
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--long-capture"_s, u"--samples"_s, u"1M"_s, u"--interval"_s, u"10s"_s }, command),
+                 QStringList{});
+        QCOMPARE(command.longCapture.totalSamples, (quint64)1'000'000);
+        QCOMPARE(command.longCapture.totalWindow, (quint32)10'000'000);
+        QCOMPARE(command.settings.numberOfSamples, (quint16)1000);     // Default; replaced per segment.
+        QCOMPARE(command.settings.samplingWindow, (quint32)1'000'000); // Default; replaced per segment.
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--long-capture"_s }, command), (QStringList{
+            u"Missing required option for --long-capture: --samples"_s,
+            u"Missing required option for --long-capture: --interval"_s }));
+        QCOMPARE(command.longCapture.totalSamples, (quint64)0);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--long-capture"_s, u"--samples"_s, u"100k"_s, u"--interval"_s, u"1s"_s,
+                           u"--continuous"_s, u"--stats"_s }, command), (QStringList{
+            u"Only one of these options may be provided: continuous, long-capture"_s,
+            u"Long captures are only supported for raw samples, not --spectrum or --stats"_s }));
+    }
+}
+
+void TestDsoCommand::processOptions_bandwidth()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const auto process = [](const QStringList &arguments, DsoCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+        parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+        parser.addOption({u"bandwidth"_s, u"description"_s, u"frequency"_s});
+        parser.addOption({u"duration"_s, u"description"_s, u"period"_s});
+        parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+        parser.addOption({u"samples"_s, u"description"_s, u"samples"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"long-capture"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"2V"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {   // The settings themselves are not planned until the device's capabilities are known.
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--bandwidth"_s, u"10kHz"_s, u"--duration"_s, u"10s"_s }, command), QStringList{});
+        QCOMPARE(command.plannedBandwidth, 10'000u);
+        QCOMPARE(command.plannedDuration, 10'000'000u);
+        QCOMPARE(command.longCapture.totalSamples, (quint64)0);
+        QCOMPARE(command.settings.numberOfSamples, (quint16)1000);     // Default; replaced by the plan.
+        QCOMPARE(command.settings.samplingWindow, (quint32)1'000'000); // Default; replaced by the plan.
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--bandwidth"_s, u"50"_s }, command), QStringList{
+            u"If either option is provided, then both must be: bandwidth, duration"_s });
+        QCOMPARE(command.plannedBandwidth, 50u);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--bandwidth"_s, u"invalid"_s, u"--duration"_s, u"-1s"_s }, command), (QStringList{
+            u"Invalid bandwidth value: invalid"_s,
+            u"Invalid duration value: -1s"_s }));
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--bandwidth"_s, u"1kHz"_s, u"--duration"_s, u"1s"_s, u"--samples"_s, u"100"_s,
+                           u"--interval"_s, u"1s"_s }, command), (QStringList{
+            u"Only one of these options may be provided: bandwidth, interval"_s,
+            u"Only one of these options may be provided: bandwidth, samples"_s }));
+    }
+}
+
+void TestDsoCommand::processOptions_autoRange()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const auto process = [](const QStringList &arguments, DsoCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+        parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"auto-range"_s, u"description"_s});
+        parser.addOption({u"continuous"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"2V"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--continuous"_s, u"--auto-range"_s }, command), QStringList{});
+        QVERIFY(command.continuous);
+        QVERIFY(command.autoRange);
+        QCOMPARE(command.rangeOptionValue, 2000u); // Still the first capture's range.
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--continuous"_s }, command), QStringList{});
+        QVERIFY(!command.autoRange);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--auto-range"_s }, command),
+                 QStringList{ u"Missing required option for --auto-range: --continuous"_s });
+    }
+}
+
+void TestDsoCommand::processOptions_markClipping()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const auto process = [](const QStringList &arguments, DsoCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+        parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"mark-clipping"_s, u"description"_s});
+        parser.addOption({u"stats"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"2V"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--output"_s, u"json"_s }, command), QStringList{});
+        QVERIFY(!command.markClipping);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--mark-clipping"_s, u"--output"_s, u"text"_s }, command), QStringList{});
+        QVERIFY(command.markClipping);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--mark-clipping"_s, u"--output"_s, u"csv"_s }, command),
+                 QStringList{ u"Clipping markers are only supported for JSON, NDJSON and text output"_s });
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--mark-clipping"_s, u"--output"_s, u"json"_s, u"--stats"_s }, command),
+                 QStringList{ u"Clipping markers are only supported for sample output, not --soft-trigger, "
+                              "--spectrum or --stats"_s });
+    }
+}
+
+void TestDsoCommand::processOptions_raw()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const auto process = [](const QStringList &arguments, DsoCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+        parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"raw"_s, u"description"_s});
+        parser.addOption({u"spectrum"_s, u"description"_s});
+        parser.addOption({u"stats"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"2V"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--output"_s, u"csv"_s }, command), QStringList{});
+        QVERIFY(!command.rawCounts);
+    }
+
+    for (const QString &format: { u"csv"_s, u"ndjson"_s, u"ndjson-envelope"_s, u"text"_s }) {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--raw"_s, u"--output"_s, format }, command), QStringList{});
+        QVERIFY(command.rawCounts);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--raw"_s, u"--output"_s, u"json"_s }, command),
+                 QStringList{ u"Raw counts are only supported for CSV, NDJSON, NDJSON-Envelope and text output"_s });
+        QVERIFY(!command.rawCounts);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--raw"_s, u"--spectrum"_s, u"--stats"_s }, command),
+                 QStringList{ u"Raw counts are only supported for unmodified sample output, not --spectrum, "
+                              "--stats"_s });
+        QVERIFY(!command.rawCounts);
+    }
+}
+
+void TestDsoCommand::processOptions_filter()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const auto process = [](const QStringList &arguments, DsoCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+        parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"filter"_s, u"description"_s, u"spec"_s});
+        parser.addOption({u"spectrum"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"2V"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({}, command), QStringList{});
+        QVERIFY(command.filter == nullptr);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--filter"_s, u"notch:50"_s, u"--filter"_s, u"fir:0.5,0.5"_s }, command), QStringList{});
+        QVERIFY(command.filter != nullptr);
+        QCOMPARE(command.filter->biquads().size(), 1);
+        QCOMPARE(command.filter->firTaps(), (QVector<float>{ 0.5f, 0.5f }));
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--filter"_s, u"lowpass:10"_s, u"--output"_s, u"binary"_s, u"--spectrum"_s }, command),
+                 (QStringList{
+            u"Binary output is only supported for raw samples, not --spectrum or --stats"_s,
+            u"Binary output is only supported for raw samples, not --filter"_s,
+            u"Filters are only supported for sample output, not --spectrum or --stats"_s }));
+    }
+}
+
+void TestDsoCommand::processOptions_softTrigger()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const auto process = [](const QStringList &arguments, DsoCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+        parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"soft-trigger"_s, u"description"_s, u"spec"_s});
+        parser.addOption({u"pre-trigger"_s, u"description"_s, u"samples"_s});
+        parser.addOption({u"post-trigger"_s, u"description"_s, u"samples"_s});
+        parser.addOption({u"stats"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"2V"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({}, command), QStringList{});
+        QVERIFY(command.softwareTrigger == nullptr);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--soft-trigger"_s, u"edge:falling:1.5:0.1"_s }, command), QStringList{});
+        QVERIFY(command.softwareTrigger != nullptr);
+        const SoftwareTrigger::Settings settings = command.softwareTrigger->settings();
+        QCOMPARE(settings.condition, SoftwareTrigger::Condition::Edge);
+        QCOMPARE(settings.slope, SoftwareTrigger::Slope::Falling);
+        QCOMPARE(settings.level, 1.5f);
+        QCOMPARE(settings.hysteresis, 0.1f);
+        QCOMPARE(settings.preTrigger, SoftwareTrigger::defaultSettings().preTrigger);
+        QCOMPARE(settings.postTrigger, SoftwareTrigger::defaultSettings().postTrigger);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--soft-trigger"_s, u"pulse:either:0.5:10:20"_s,
+                           u"--pre-trigger"_s, u"0"_s, u"--post-trigger"_s, u"50"_s }, command), QStringList{});
+        QVERIFY(command.softwareTrigger != nullptr);
+        const SoftwareTrigger::Settings settings = command.softwareTrigger->settings();
+        QCOMPARE(settings.condition, SoftwareTrigger::Condition::PulseWidth);
+        QCOMPARE(settings.slope, SoftwareTrigger::Slope::Either);
+        QCOMPARE(settings.level, 0.5f);
+        QCOMPARE(settings.minWidth, 10U);
+        QCOMPARE(settings.maxWidth, 20U);
+        QCOMPARE(settings.preTrigger, 0U);
+        QCOMPARE(settings.postTrigger, 50U);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--soft-trigger"_s, u"window:rising:1:2"_s }, command), QStringList{});
+        QVERIFY(command.softwareTrigger != nullptr);
+        QCOMPARE(command.softwareTrigger->settings().condition, SoftwareTrigger::Condition::Window);
+        QCOMPARE(command.softwareTrigger->settings().upperLevel, 2.0f);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--soft-trigger"_s, u"window:rising:2:1"_s, u"--post-trigger"_s, u"none"_s }, command),
+                 (QStringList{
+            u"Invalid post-trigger value: none"_s,
+            u"Invalid soft-trigger value: window:rising:2:1"_s }));
+        QVERIFY(command.softwareTrigger == nullptr);
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--soft-trigger"_s, u"level:up:1"_s, u"--output"_s, u"binary"_s, u"--stats"_s }, command),
+                 (QStringList{
+            u"Binary output is only supported for raw samples, not --spectrum or --stats"_s,
+            u"Binary output is only supported for raw samples, not --soft-trigger"_s,
+            u"Software triggers are only supported for sample output, not --spectrum or --stats"_s,
+            u"Invalid soft-trigger value: level:up:1"_s }));
+    }
+
+    {
+        DsoCommand command(this);
+        QCOMPARE(process({ u"--pre-trigger"_s, u"10"_s }, command), (QStringList{
+            u"Missing required option for --pre-trigger: --soft-trigger"_s }));
+    }
+}
+
 void TestDsoCommand::getService()
 {
     // Unable to safely invoke DsoCommand::getService() without a valid Bluetooth device.
@@ -513,6 +906,615 @@ void TestDsoCommand::outputSamples()
     QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
 }
 
+void TestDsoCommand::outputSamples_arrow()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Arrow;
+    const qint64 before = QDateTime::currentMSecsSinceEpoch() * 1000;
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 3, 1000 });
+    const qint64 after = QDateTime::currentMSecsSinceEpoch() * 1000;
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+
+    // Timestamps are the (current) capture time, plus each sample's offset, at the capture's sampling rate.
+    const qint64 timestamp = command.captureTimestamp;
+    QVERIFY((timestamp >= before) && (timestamp <= after));
+    QByteArray expected;
+    AbstractCommand::writeArrowSchema(expected);
+    AbstractCommand::writeArrowRecordBatch(expected, { timestamp, timestamp + 1000 }, { 0.5f, -1.0f }, 1, 1);
+    AbstractCommand::writeArrowRecordBatch(expected, { timestamp + 2000 }, { 150.0f }, 1, 1);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestDsoCommand::outputSamples_lineProtocol()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::LineProtocol;
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 3, 1000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+
+    // Timestamps are the capture time, plus each sample's offset at the capture's sampling rate, in nanoseconds.
+    const QByteArray prefix(R"(dso,mode=DC\ voltage,range=Up\ to\ 2V,unit=Vdc value=)");
+    const qint64 timestamp = command.captureTimestamp * 1000;
+    QCOMPARE(QByteArray::fromStdString(capture.data()),
+        prefix + "0.5 " + QByteArray::number(timestamp) + '\n' +
+        prefix + "-1 " + QByteArray::number(timestamp + 1'000'000) + '\n' +
+        prefix + "150 " + QByteArray::number(timestamp + 2'000'000) + '\n');
+}
+
+void TestDsoCommand::outputSamples_binary()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Binary;
+    const quint64 before = (quint64)QDateTime::currentMSecsSinceEpoch();
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 3, 1000 });
+    const quint64 after = (quint64)QDateTime::currentMSecsSinceEpoch();
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+
+    // The header's timestamp is the (current) capture time, so verify its range, then compare the rest verbatim.
+    QByteArray output = QByteArray::fromStdString(capture.data());
+    QCOMPARE(output.size(), 32 + 6);
+    const quint64 timestamp = qFromLittleEndian<quint64>(output.constData() + 16);
+    QVERIFY((timestamp >= before) && (timestamp <= after));
+    output.replace(16, 8, QByteArray(8, '\0'));
+    QCOMPARE(output, QByteArray::fromHex(
+        "444f4b42" "01" "01" "01" "01" "0000003f" "e8030000" "0000000000000000" "03000000" "02000000"
+        "0100feff2c01"));
+}
+
+void TestDsoCommand::outputRawSamples()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Binary;
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 4, 1000 });
+    command.saturation.setThreshold(300);
+    command.outputRawSamples(QByteArray::fromHex("0100feff"));
+    QCOMPARE(command.samplesToGo, 2);
+    command.resendSkip = 1; // Such as after a resend, with the first sample already output.
+    command.outputRawSamples(QByteArray::fromHex("0100" "2c01" "0300"));
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.resendSkip, 0);
+    QCOMPARE(command.saturation.saturatedCount(), (qint64)1);
+
+    // Identical to the decoded samples' output, after the header (whose timestamp varies).
+    const QByteArray output = QByteArray::fromStdString(capture.data());
+    QCOMPARE(output.size(), 32 + 8);
+    QCOMPARE(output.mid(32), QByteArray::fromHex("0100feff2c010300"));
+}
+
+void TestDsoCommand::isPassthrough()
+{
+    DsoCommand command;
+    QVERIFY(!command.isPassthrough()); // Text output, by default.
+    command.format = AbstractCommand::OutputFormat::Binary;
+    QVERIFY(command.isPassthrough());
+    command.compressSamples = true;
+    QVERIFY(!command.isPassthrough()); // Compression requires decoded samples.
+}
+
+void TestDsoCommand::outputSamples_ndjson()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 3, 1000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"value":0.5,"unit":"Vdc","range":"Up to 2V","mode":"DC voltage"})" "\n"
+        R"({"value":-1,"unit":"Vdc","range":"Up to 2V","mode":"DC voltage"})" "\n"
+        R"({"value":150,"unit":"Vdc","range":"Up to 2V","mode":"DC voltage"})" "\n"));
+}
+
+void TestDsoCommand::outputSamples_ndjsonEnvelope()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::NdjsonEnvelope;
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 3, 1000 });
+    const QByteArray envelope(R"({"mode":"DC voltage","unit":"Vdc","range":"Up to 2V",)"
+                              R"("samplingRate":1000,"numberOfSamples":3,"values":[)");
+    command.outputSamples({ 1, -2 });
+    QCOMPARE(QByteArray::fromStdString(capture.data()), envelope + "0.5,-1"); // Values are streamed per batch.
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), envelope + "0.5,-1,150]}\n");
+}
+
+void TestDsoCommand::outputSamples_markClipping()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.markClipping = true;
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 6, 1000 });
+    QCOMPARE(command.saturation.threshold(), (qint16)4); // The 2V range's maximum, at 0.5V per raw sample.
+    command.outputSamples({ 1, -2, 4 });
+    command.outputSamples({ -5, 3, 4 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.saturation.saturatedCount(), (qint64)3);
+
+    // Each run is marked after the batch that ended it, or at the end of the capture.
+    const QByteArray prefix(R"({"value":)"), suffix(R"(,"unit":"Vdc","range":"Up to 2V","mode":"DC voltage"})" "\n");
+    QCOMPARE(QByteArray::fromStdString(capture.data()),
+        prefix + "0.5" + suffix + prefix + "-1" + suffix + prefix + "2" + suffix +
+        prefix + "-2.5" + suffix + prefix + "1.5" + suffix + prefix + "2" + suffix +
+        R"({"clipped":2,"firstSample":3,"range":"Up to 2V"})" "\n"
+        R"({"clipped":1,"firstSample":6,"range":"Up to 2V"})" "\n");
+}
+
+void TestDsoCommand::outputStatistics_data()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    QTest::addColumn<DsoStatistics::Summary>("summary");
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+
+    const QList<QPair<QString, DsoStatistics::Summary>> summaries{
+        { u"square"_s, { 8, -2.0f, 2.0f, 4.0f, 0.0f, 2.0f, 2.0f, 500.0f } },
+        { u"dc"_s,     { 5,  3.0f, 3.0f, 0.0f, 3.0f, 3.0f, 0.0f, std::numeric_limits<float>::quiet_NaN() } },
+    };
+    for (const auto &summary: summaries) {
+        QTest::newRow(qUtf8Printable(summary.first + u".csv"_s))
+            << summary.second << AbstractCommand::OutputFormat::Csv;
+        QTest::newRow(qUtf8Printable(summary.first + u".json"_s))
+            << summary.second << AbstractCommand::OutputFormat::Json;
+        QTest::newRow(qUtf8Printable(summary.first + u".txt"_s))
+            << summary.second << AbstractCommand::OutputFormat::Text;
+    }
+}
+
+void TestDsoCommand::outputStatistics()
+{
+    QFETCH(DsoStatistics::Summary, summary);
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 8, 1000 });
+    command.format = format;
+    command.outputStatistics(summary);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestDsoCommand::outputSpectrum_data()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    QTest::addColumn<DsoSpectrum::Spectrum>("spectrum");
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+
+    const DsoSpectrum::Spectrum spectrum{ 250.0f, { 0.5f, 1.0f, 0.25f } };
+    QTest::newRow("spectrum.csv")  << spectrum << AbstractCommand::OutputFormat::Csv;
+    QTest::newRow("spectrum.json") << spectrum << AbstractCommand::OutputFormat::Json;
+    QTest::newRow("spectrum.txt")  << spectrum << AbstractCommand::OutputFormat::Text;
+}
+
+void TestDsoCommand::outputSpectrum()
+{
+    QFETCH(DsoSpectrum::Spectrum, spectrum);
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 4, 1000 });
+    command.format = format;
+    command.outputSpectrum(spectrum, 1);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestDsoCommand::outputSamples_raw()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Csv;
+    command.rawCounts = true;
+    const DsoService::Metadata metadata{ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                                         +PokitMeter::VoltageRange::_2V, 1000, 3, 1000 };
+    command.metadataRead(metadata);
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+
+    // The same scale, mode and range should not be declared again, but a different scale should.
+    command.metadataRead(metadata);
+    command.outputSamples({ -32768, 32767, 0 });
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.25f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 1, 1000 });
+    command.outputSamples({ 7 });
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        "# mode=DC voltage,unit=Vdc,range=Up to 2V,scale=0.5\n"
+        "sample_number,count\n"
+        "1,1\n2,-2\n3,300\n4,-32768\n5,32767\n6,0\n"
+        "# mode=DC voltage,unit=Vdc,range=Up to 2V,scale=0.25\n"
+        "7,7\n"));
+}
+
+void TestDsoCommand::outputSamples_rawEnvelope()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::NdjsonEnvelope;
+    command.rawCounts = true;
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.1f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 3, 1000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"mode":"DC voltage","unit":"Vdc","range":"Up to 2V","samplingRate":1000,"numberOfSamples":3,)"
+        R"("scale":0.1,"counts":[1,-2,300]})" "\n"));
+}
+
+void TestDsoCommand::segmentSettings_data()
+{
+    QTest::addColumn<quint64>("totalSamples");
+    QTest::addColumn<quint32>("totalWindow");
+    QTest::addColumn<quint16>("segmentSize");
+    QTest::addColumn<QList<quint16>>("expectedSamples");
+    QTest::addColumn<QList<quint32>>("expectedWindows");
+
+    QTest::addRow("single")
+        << (quint64)1000 << (quint32)1'000'000 << (quint16)8192
+        << QList<quint16>{ 1000 } << QList<quint32>{ 1'000'000 };
+
+    QTest::addRow("exact")
+        << (quint64)16384 << (quint32)2'000'000 << (quint16)8192
+        << QList<quint16>{ 8192, 8192 } << QList<quint32>{ 1'000'000, 1'000'000 };
+
+    QTest::addRow("remainder")
+        << (quint64)20000 << (quint32)2'000'000 << (quint16)8192
+        << QList<quint16>{ 8192, 8192, 3616 } << QList<quint32>{ 819'200, 819'200, 361'600 };
+
+    // 10 samples over 1000us is 100us per sample, so segments of 3 samples are 300us, but rounding the total window
+    // to each segment's end (rather than each segment's window) keeps the windows summing to exactly 1000us.
+    QTest::addRow("rounding")
+        << (quint64)10 << (quint32)1000 << (quint16)3
+        << QList<quint16>{ 3, 3, 3, 1 } << QList<quint32>{ 300, 300, 300, 100 };
+
+    QTest::addRow("uneven-rounding")
+        << (quint64)3 << (quint32)100 << (quint16)1
+        << QList<quint16>{ 1, 1, 1 } << QList<quint32>{ 33, 34, 33 };
+}
+
+void TestDsoCommand::segmentSettings()
+{
+    QFETCH(quint64, totalSamples);
+    QFETCH(quint32, totalWindow);
+    QFETCH(quint16, segmentSize);
+    QFETCH(QList<quint16>, expectedSamples);
+    QFETCH(QList<quint32>, expectedWindows);
+
+    const DsoService::Settings settings{
+        DsoService::Command::RisingEdgeTrigger, 0.5f, DsoService::Mode::AcVoltage,
+        +PokitMeter::VoltageRange::_6V, 1'000'000, 1000 };
+    DsoCommand::LongCapture capture;
+    capture.totalSamples = totalSamples;
+    capture.totalWindow = totalWindow;
+    capture.segmentSize = segmentSize;
+
+    QList<quint16> samples;
+    QList<quint32> windows;
+    while (capture.firstSample < capture.totalSamples) {
+        const DsoService::Settings segment = DsoCommand::segmentSettings(settings, capture);
+        // Only the first segment waits for the trigger; the rest follow on as soon as possible.
+        QCOMPARE(segment.command, (capture.firstSample == 0) ? settings.command : DsoService::Command::FreeRunning);
+        QCOMPARE(segment.triggerLevel, settings.triggerLevel);
+        QCOMPARE(segment.mode,         settings.mode);
+        QCOMPARE(segment.range,        settings.range);
+        samples.append(segment.numberOfSamples);
+        windows.append(segment.samplingWindow);
+        capture.firstSample += segment.numberOfSamples;
+    }
+    QCOMPARE(samples, expectedSamples);
+    QCOMPARE(windows, expectedWindows);
+}
+
+void TestDsoCommand::planAcquisition_data()
+{
+    QTest::addColumn<quint32>("bandwidth");
+    QTest::addColumn<quint32>("duration");
+    QTest::addColumn<quint16>("maximumSamplingRate");
+    QTest::addColumn<quint16>("bufferSize");
+    QTest::addColumn<quint64>("expectedSamples");
+    QTest::addColumn<quint32>("expectedCaptures");
+    QTest::addColumn<quint32>("expectedMaximumBandwidth");
+
+    // Short durations fill a single buffer, even though far fewer samples would do.
+    QTest::addRow("single")
+        << 1'000u << 10'000u << (quint16)1000 << (quint16)8192 << (quint64)8192 << 1u << 400'000u;
+
+    // But never faster than the device's maximum sampling rate.
+    QTest::addRow("max-rate")
+        << 1'000u << 1'000u << (quint16)1000 << (quint16)8192 << (quint64)1000 << 1u << 400'000u;
+
+    // Longer durations are stitched from as few full buffers as can hold 2.5 samples per cycle.
+    QTest::addRow("stitched")
+        << 10'000u << 10'000'000u << (quint16)1000 << (quint16)8192 << (quint64)(31 * 8192) << 31u << 400'000u;
+    QTest::addRow("small-buffer")
+        << 100u << 1'000'000u << (quint16)1000 << (quint16)100 << (quint64)300 << 3u << 400'000u;
+
+    QTest::addRow("unknown-capabilities")
+        << 1'000u << 10'000u << (quint16)0 << (quint16)0 << (quint64)8192 << 1u << 400'000u;
+    QTest::addRow("slow-device")
+        << 1'000u << 10'000u << (quint16)100 << (quint16)8192 << (quint64)1000 << 1u << 40'000u;
+
+    QTest::addRow("too-fast")
+        << 500'000u << 1'000u << (quint16)1000 << (quint16)8192 << (quint64)0 << 0u << 400'000u;
+}
+
+void TestDsoCommand::planAcquisition()
+{
+    QFETCH(quint32, bandwidth);
+    QFETCH(quint32, duration);
+    QFETCH(quint16, maximumSamplingRate);
+    QFETCH(quint16, bufferSize);
+    QFETCH(quint64, expectedSamples);
+    QFETCH(quint32, expectedCaptures);
+    QFETCH(quint32, expectedMaximumBandwidth);
+
+    const DsoCommand::AcquisitionPlan plan =
+        DsoCommand::planAcquisition(bandwidth, duration, maximumSamplingRate, bufferSize);
+    QCOMPARE(plan.numberOfSamples, expectedSamples);
+    QCOMPARE(plan.samplingWindow, duration);
+    QCOMPARE(plan.segmentSize, (bufferSize > 0) ? bufferSize : (quint16)8192);
+    QCOMPARE(plan.captures, expectedCaptures);
+    QCOMPARE(plan.maximumBandwidth, expectedMaximumBandwidth);
+}
+
+void TestDsoCommand::nextRange_data()
+{
+    QTest::addColumn<PokitProduct>("product");
+    QTest::addColumn<DsoService::Mode>("mode");
+    QTest::addColumn<quint8>("range");
+    QTest::addColumn<float>("peak");
+    QTest::addColumn<bool>("clipped");
+    QTest::addColumn<quint8>("expected");
+
+    // Pokit Meter voltage ranges are 300mV, 2V, 6V, 12V, 30V and 60V.
+    QTest::addRow("steady")
+        << PokitProduct::PokitMeter << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_2V << 1.5f << false
+        << +PokitMeter::VoltageRange::_2V;
+    QTest::addRow("near-limit")
+        << PokitProduct::PokitMeter << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_2V << 1.9f << false
+        << +PokitMeter::VoltageRange::_6V;
+    QTest::addRow("clipped")
+        << PokitProduct::PokitMeter << DsoService::Mode::AcVoltage << +PokitMeter::VoltageRange::_300mV << 0.3f << true
+        << +PokitMeter::VoltageRange::_2V;
+    QTest::addRow("clipped-highest")
+        << PokitProduct::PokitMeter << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_60V << 60.0f << true
+        << +PokitMeter::VoltageRange::_60V;
+    QTest::addRow("step-down")
+        << PokitProduct::PokitMeter << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_30V << 1.0f << false
+        << +PokitMeter::VoltageRange::_2V;
+    QTest::addRow("step-down-negative")
+        << PokitProduct::PokitMeter << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_30V << -1.0f << false
+        << +PokitMeter::VoltageRange::_2V;
+    QTest::addRow("hysteresis")
+        << PokitProduct::PokitMeter << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_6V << 1.7f << false
+        << +PokitMeter::VoltageRange::_6V;
+    QTest::addRow("zero")
+        << PokitProduct::PokitMeter << DsoService::Mode::AcVoltage << +PokitMeter::VoltageRange::_12V << 0.0f << false
+        << +PokitMeter::VoltageRange::_300mV;
+
+    // Pokit Pro current ranges are 500uA, 2mA, 10mA, 125mA, 300mA, 3A and 10A.
+    QTest::addRow("pro-current-up")
+        << PokitProduct::PokitPro << DsoService::Mode::DcCurrent << +PokitPro::CurrentRange::_10mA << 0.0095f << false
+        << +PokitPro::CurrentRange::_125mA;
+    QTest::addRow("pro-current-down")
+        << PokitProduct::PokitPro << DsoService::Mode::AcCurrent << +PokitPro::CurrentRange::_3A << 0.001f << false
+        << +PokitPro::CurrentRange::_2mA;
+
+    // Ranges are left unchanged when there's nothing to choose from.
+    QTest::addRow("idle")
+        << PokitProduct::PokitMeter << DsoService::Mode::Idle << +PokitMeter::VoltageRange::_6V << 100.0f << true
+        << +PokitMeter::VoltageRange::_6V;
+    QTest::addRow("unknown-range")
+        << PokitProduct::PokitMeter << DsoService::Mode::DcVoltage << (quint8)42 << 100.0f << true
+        << (quint8)42;
+}
+
+void TestDsoCommand::nextRange()
+{
+    QFETCH(PokitProduct, product);
+    QFETCH(DsoService::Mode, mode);
+    QFETCH(quint8, range);
+    QFETCH(float, peak);
+    QFETCH(bool, clipped);
+    QFETCH(quint8, expected);
+    if (QByteArray(QTest::currentDataTag()) == "unknown-range") {
+        QTest::ignoreMessage(QtWarningMsg, "Unknown VoltageRange value: 42");
+    }
+    QCOMPARE(DsoCommand::nextRange(product, mode, range, peak, clipped), expected);
+}
+
+void TestDsoCommand::outputSegmentMarker_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("csv") << AbstractCommand::OutputFormat::Csv << QByteArray(",,Vdc,Up to 2V\n");
+    QTest::addRow("json") << AbstractCommand::OutputFormat::Json << QByteArray(
+        "{\n"
+        "    \"firstSample\": 8193,\n"
+        "    \"gap\": 2345,\n"
+        "    \"segment\": 2,\n"
+        "    \"start\": 1234567\n"
+        "}\n");
+    QTest::addRow("ndjson") << AbstractCommand::OutputFormat::Ndjson
+        << QByteArray(R"({"firstSample":8193,"gap":2345,"segment":2,"start":1234567})" "\n");
+    QTest::addRow("ndjson-envelope") << AbstractCommand::OutputFormat::NdjsonEnvelope
+        << QByteArray(R"({"firstSample":8193,"gap":2345,"segment":2,"start":1234567})" "\n");
+    QTest::addRow("text") << AbstractCommand::OutputFormat::Text
+        << QByteArray("-- segment 2, from sample 8193, after a gap of 2345us --\n");
+    QTest::addRow("binary") << AbstractCommand::OutputFormat::Binary << QByteArray();
+    QTest::addRow("arrow") << AbstractCommand::OutputFormat::Arrow << QByteArray();
+    QTest::addRow("line-protocol") << AbstractCommand::OutputFormat::LineProtocol << QByteArray();
+}
+
+void TestDsoCommand::outputSegmentMarker()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(QByteArray, expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = format;
+    command.metadata = { DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                         +PokitMeter::VoltageRange::_2V, 1000, 8192, 8192 };
+    command.outputSegmentMarker(1, 8192, 1'234'567, 2345);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestDsoCommand::captureTimedOut()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    DsoCommand command;
+    command.service = new DsoService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::NdjsonEnvelope;
+    const DsoService::Metadata metadata{ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                                         +PokitMeter::VoltageRange::_2V, 1000, 4, 1000 };
+    command.metadataRead(metadata);
+    QVERIFY(command.completionTimer->isActive());
+    command.outputSamples({ 1, -2 });
+    QVERIFY(command.completionTimer->isActive());
+
+    // Without a BLE controller the resend cannot be sent, but the window should still be re-requested.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(
+        u"^DSO capture stalled after 2 of 4 sample/s; requesting resend 1 of 3.$"_s));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Failed to request resend 1.$"_s));
+    command.captureTimedOut();
+    QCOMPARE(command.resends, 1);
+    QVERIFY(command.resending);
+    QVERIFY(command.completionTimer->isActive());
+
+    // The re-sent window should not re-open the envelope, and its first two samples should be skipped.
+    command.metadataRead(metadata);
+    QCOMPARE(command.resendSkip, 2);
+    QCOMPARE(command.samplesToGo, 2);
+    command.outputSamples({ 1 });
+    command.outputSamples({ -2, 4, 6 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.resendSkip, 0);
+    QVERIFY(!command.completionTimer->isActive());
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"mode":"DC voltage","unit":"Vdc","range":"Up to 2V",)"
+        R"("samplingRate":1000,"numberOfSamples":4,"values":[0.5,-1,2,3]})" "\n"));
+
+    // The next window should get its own resends.
+    command.metadataRead(metadata);
+    QCOMPARE(command.resends, 0);
+}
+
+void TestDsoCommand::captureTimedOut_incomplete()
+{
+    // Without a service to re-request from, a stalled window is given up on straight away.
+    DsoCommand command;
+    command.metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 1000, 4, 1000 });
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^DSO capture incomplete: received 0 of 4 sample/s.$"_s));
+    command.captureTimedOut();
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.resends, 0);
+
+    // Nothing further to time out.
+    command.captureTimedOut();
+}
+
 void TestDsoCommand::tr()
 {
     // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
@@ -14,6 +14,13 @@ private slots:
 
     void processOptions_data();
     void processOptions();
+    void processOptions_longCapture();
+    void processOptions_bandwidth();
+    void processOptions_autoRange();
+    void processOptions_markClipping();
+    void processOptions_raw();
+    void processOptions_filter();
+    void processOptions_softTrigger();
 
     void getService();
 
@@ -26,5 +33,41 @@ private slots:
     void outputSamples_data();
     void outputSamples();
 
+    void outputSamples_arrow();
+    void outputSamples_lineProtocol();
+    void outputSamples_binary();
+    void outputRawSamples();
+    void isPassthrough();
+
+    void outputSamples_ndjson();
+
+    void outputSamples_ndjsonEnvelope();
+
+    void outputSamples_markClipping();
+
+    void outputSamples_raw();
+    void outputSamples_rawEnvelope();
+
+    void segmentSettings_data();
+    void segmentSettings();
+
+    void planAcquisition_data();
+    void planAcquisition();
+
+    void nextRange_data();
+    void nextRange();
+
+    void outputSegmentMarker_data();
+    void outputSegmentMarker();
+
+    void outputStatistics_data();
+    void outputStatistics();
+
+    void outputSpectrum_data();
+    void outputSpectrum();
+
+    void captureTimedOut();
+    void captureTimedOut_incomplete();
+
     void tr();
 };
@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testexportcommand.h"
+#include "archivefixture.h"
+#include "../stringliterals_p.h"
+
+#include "exportcommand.h"
+#include "shardedworkerpool.h"
+
+#include <qtpokit/pokitmeter.h>
+
+#include <QTemporaryDir>
+
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+const DataLoggerService::Metadata testMetadata{ DataLoggerService::LoggerStatus::Done, 0.5f,
+    DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 };
+
+// Populates \a dir with two archives (and a non-archive) in `archives`, another archive in `other`, and empty `empty`
+// and `out` directories.
+bool createArchives(const QTemporaryDir &dir)
+{
+    return ::createArchives(dir, testMetadata, { u"archives"_s, u"other"_s, u"empty"_s, u"out"_s }, {
+        { u"archives/a.bin"_s, 0, { 1, 2, 3 } }, { u"archives/a.bin"_s, 600, { 4, 5 } },
+        { u"archives/b.bin"_s, 0, { -1 } }, { u"other/a.bin"_s, 0, { 6 } } });
+}
+
+}
+
+void TestExportCommand::requiredOptions()
+{
+    ExportCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"archive"_s });
+}
+
+void TestExportCommand::supportedOptions()
+{
+    ExportCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"output-dir"_s, u"workers"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestExportCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedArchives");
+    QTest::addColumn<QStringList>("expectedOutputs");
+    QTest::addColumn<int>("expectedThreads");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("missing-archive")
+        << QStringList{ }
+        << QStringList{ } << QStringList{ } << 0
+        << QStringList{ u"Missing required option: archive"_s };
+    QTest::addRow("file")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/a.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s } << QStringList{ u"{dir}/archives/a.parquet"_s } << 0
+        << QStringList{ };
+    QTest::addRow("directory")
+        << QStringList{ u"--archive"_s, u"{dir}/archives"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s, u"{dir}/archives/b.bin"_s }
+        << QStringList{ u"{dir}/archives/a.parquet"_s, u"{dir}/archives/b.parquet"_s } << 0
+        << QStringList{ };
+    QTest::addRow("output-dir")
+        << QStringList{ u"--archive"_s, u"{dir}/archives"_s, u"--output-dir"_s, u"{dir}/out"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s, u"{dir}/archives/b.bin"_s }
+        << QStringList{ u"{dir}/out/a.parquet"_s, u"{dir}/out/b.parquet"_s } << 0
+        << QStringList{ };
+    QTest::addRow("repeated")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/a.bin"_s, u"--archive"_s, u"{dir}/other/a.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s, u"{dir}/other/a.bin"_s }
+        << QStringList{ u"{dir}/archives/a.parquet"_s, u"{dir}/other/a.parquet"_s } << 0
+        << QStringList{ };
+    QTest::addRow("same-output")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/a.bin"_s, u"--archive"_s, u"{dir}/other/a.bin"_s,
+                        u"--output-dir"_s, u"{dir}/out"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s } << QStringList{ u"{dir}/out/a.parquet"_s } << 0
+        << QStringList{ u"More than one archive would be exported to {dir}/out/a.parquet"_s };
+    QTest::addRow("not-found")
+        << QStringList{ u"--archive"_s, u"{dir}/missing.bin"_s }
+        << QStringList{ } << QStringList{ } << 0
+        << QStringList{ u"Archive does not exist: {dir}/missing.bin"_s };
+    QTest::addRow("empty-directory")
+        << QStringList{ u"--archive"_s, u"{dir}/empty"_s }
+        << QStringList{ } << QStringList{ } << 0
+        << QStringList{ u"No archives found in {dir}/empty"_s };
+    QTest::addRow("invalid-output-dir")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--output-dir"_s, u"{dir}/missing"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << QStringList{ u"{dir}/missing/b.parquet"_s } << 0
+        << QStringList{ u"Output directory does not exist: {dir}/missing"_s };
+    QTest::addRow("workers")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--workers"_s, u"4"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << QStringList{ u"{dir}/archives/b.parquet"_s } << 4
+        << QStringList{ };
+    QTest::addRow("workers-auto")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--workers"_s, u"Auto"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << QStringList{ u"{dir}/archives/b.parquet"_s } << 0
+        << QStringList{ };
+    QTest::addRow("invalid-workers")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--workers"_s, u"-1"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << QStringList{ u"{dir}/archives/b.parquet"_s } << -1
+        << QStringList{ u"Invalid workers value: -1"_s };
+}
+
+void TestExportCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedArchives);
+    QFETCH(QStringList, expectedOutputs);
+    QFETCH(int, expectedThreads);
+    QFETCH(QStringList, expectedErrors);
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    arguments = withDir(arguments, dir.path());
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"output-dir"_s, u"description"_s, u"dir"_s});
+    parser.addOption({u"workers"_s, u"description"_s, u"count"_s});
+    parser.process(arguments);
+
+    ExportCommand command(this);
+    QCOMPARE(command.processOptions(parser), withDir(expectedErrors, dir.path()));
+    QStringList archives, outputs;
+    for (const auto &item: command.exports) {
+        archives.append(item.archive);
+        outputs.append(item.output);
+    }
+    QCOMPARE(archives, withDir(expectedArchives, dir.path()));
+    QCOMPARE(outputs, withDir(expectedOutputs, dir.path()));
+    QCOMPARE(command.threads, expectedThreads);
+}
+
+void TestExportCommand::start()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    QCommandLineParser parser;
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"workers"_s, u"description"_s, u"count"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--archive"_s, dir.filePath(u"archives"_s), u"--workers"_s, u"2"_s });
+
+    ExportCommand command;
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(command.start());
+    QVERIFY(command.workers);
+    QCOMPARE(command.workers->threadCount(), 2);
+    QTRY_COMPARE(command.finished, 2);
+    for (const auto &item: command.exports) {
+        QVERIFY2(item.error.isEmpty(), qUtf8Printable(item.error));
+        QVERIFY(QFile::exists(item.output));
+    }
+    QCOMPARE(command.exports.at(0).stats.rowGroups, (quint64)2);
+    QCOMPARE(command.exports.at(0).stats.rows, (quint64)5);
+    QCOMPARE(command.exports.at(1).stats.rowGroups, (quint64)1);
+    QCOMPARE(command.exports.at(1).stats.rows, (quint64)1);
+}
+
+void TestExportCommand::exportFinished()
+{
+    ExportCommand command;
+    command.exports.append({ u"a.bin"_s, u"a.parquet"_s, QString(), { 5, 2, 1234 } });
+    command.exports.append({ u"b.bin"_s, u"b.parquet"_s, u"Disk full"_s, { } });
+    command.exportFinished(1);
+    QCOMPARE(command.finished, 1);
+
+    // The last export to finish reports the number that failed.
+    QTest::ignoreMessage(QtWarningMsg, "Failed to export b.bin: Disk full");
+    QTest::ignoreMessage(QtWarningMsg, "Failed to export 1 of 2 archive(s).");
+    command.exportFinished(0);
+    QCOMPARE(command.finished, 2);
+}
+
+void TestExportCommand::findArchives()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+
+    // Files are taken as given, but directories include only the archives within.
+    QCOMPARE(ExportCommand::findArchives(dir.filePath(u"archives/notes.txt"_s)),
+             QStringList{ dir.filePath(u"archives/notes.txt"_s) });
+    QCOMPARE(ExportCommand::findArchives(dir.filePath(u"archives"_s)),
+             QStringList({ dir.filePath(u"archives/a.bin"_s), dir.filePath(u"archives/b.bin"_s) }));
+    QCOMPARE(ExportCommand::findArchives(dir.filePath(u"empty"_s)), QStringList{});
+}
+
+void TestExportCommand::outputFileName_data()
+{
+    QTest::addColumn<QString>("archive");
+    QTest::addColumn<QString>("outputDir");
+    QTest::addColumn<QString>("expected");
+
+    QTest::addRow("beside") << u"/data/logger.bin"_s << QString() << u"/data/logger.parquet"_s;
+    QTest::addRow("no-suffix") << u"/data/logger"_s << QString() << u"/data/logger.parquet"_s;
+    QTest::addRow("many-suffixes") << u"/data/bench.2024.bin"_s << QString() << u"/data/bench.2024.parquet"_s;
+    QTest::addRow("relative") << u"logger.bin"_s << QString() << u"logger.parquet"_s;
+    QTest::addRow("output-dir") << u"/data/logger.bin"_s << u"/exports/"_s << u"/exports/logger.parquet"_s;
+}
+
+void TestExportCommand::outputFileName()
+{
+    QFETCH(QString, archive);
+    QFETCH(QString, outputDir);
+    QFETCH(QString, expected);
+    QCOMPARE(ExportCommand::outputFileName(archive, outputDir), expected);
+}
+
+void TestExportCommand::convert()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    const QString output = dir.filePath(u"out/a.parquet"_s);
+    ParquetWriter::Statistics stats;
+    QCOMPARE(ExportCommand::convert(dir.filePath(u"archives/a.bin"_s), output, stats), QString());
+    QCOMPARE(stats.rowGroups, (quint64)2); // One per archived session.
+    QCOMPARE(stats.rows, (quint64)5);
+    QFile file(output);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(stats.bytes, file.size());
+    QCOMPARE(file.read(4), QByteArray("PAR1"));
+}
+
+void TestExportCommand::convert_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    ParquetWriter::Statistics stats;
+
+    // Not an archive.
+    const QString notes = dir.filePath(u"archives/notes.txt"_s);
+    QTest::ignoreMessage(QtWarningMsg, qUtf8Printable(u"Failed to read archive %1"_s.arg(notes)));
+    QCOMPARE(ExportCommand::convert(notes, dir.filePath(u"out/notes.parquet"_s), stats),
+             u"Invalid, or unreadable, archive"_s);
+    QVERIFY(!QFile::exists(dir.filePath(u"out/notes.parquet"_s)));
+
+    // Not writable.
+    const QString output = dir.filePath(u"missing/a.parquet"_s);
+    QVERIFY(ExportCommand::convert(dir.filePath(u"archives/a.bin"_s), output, stats)
+        .startsWith(u"Failed to open %1: "_s.arg(output)));
+    QCOMPARE(stats.rows, (quint64)0);
+}
+
+void TestExportCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    ExportCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestExportCommand)
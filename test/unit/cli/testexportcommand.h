@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestExportCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void start();
+
+    void exportFinished();
+
+    void findArchives();
+
+    void outputFileName_data();
+    void outputFileName();
+
+    void convert();
+    void convert_invalid();
+
+    void tr();
+};
@@ -0,0 +1,372 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testexportercommand.h"
+#include "../stringliterals_p.h"
+
+#include "exportercommand.h"
+
+#include <limits>
+
+Q_DECLARE_METATYPE(MultimeterService::Mode)
+
+DOKIT_USE_STRINGLITERALS
+
+void TestExporterCommand::requiredOptions()
+{
+    ExporterCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"mode"_s });
+}
+
+void TestExporterCommand::supportedOptions()
+{
+    ExporterCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"device-list"_s, u"dwell"_s, u"interval"_s, u"listen"_s, u"max-connections"_s, u"range"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestExporterCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedDevices");
+    QTest::addColumn<MultimeterService::Mode>("expectedMode");
+    QTest::addColumn<int>("expectedScheduleSize");
+    QTest::addColumn<quint32>("expectedRangeOptionValue");
+    QTest::addColumn<quint32>("expectedInterval");
+    QTest::addColumn<int>("expectedMaxConnections");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("list")
+        << QStringList{ u"--device"_s, u"alpha, beta"_s, u"--device"_s, u"gamma"_s, u"--mode"_s, u"Vdc"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s, u"gamma"_s } << MultimeterService::Mode::DcVoltage
+        << 0 << 0u << 1000u << 3 << QStringList{};
+    QTest::addRow("empty")
+        << QStringList{ u"--device"_s, u" , "_s, u"--mode"_s, u"Vdc"_s }
+        << QStringList{ } << MultimeterService::Mode::DcVoltage
+        << 0 << 0u << 1000u << 3 << QStringList{ u"No devices to export"_s };
+    QTest::addRow("options")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"AC current"_s, u"--range"_s, u"500mA"_s,
+                        u"--interval"_s, u"2s"_s, u"--max-connections"_s, u"8"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::AcCurrent
+        << 0 << 500u << 2000u << 8 << QStringList{};
+    QTest::addRow("schedule")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc,Adc,resistance"_s, u"--dwell"_s, u"5s"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 3 << 0u << 1000u << 3 << QStringList{};
+    QTest::addRow("invalid-mode")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"foo"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0 << 0u << 1000u << 3 << QStringList{ u"Unknown meter mode: foo"_s };
+    QTest::addRow("invalid-dwell")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s, u"--dwell"_s, u"5s"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0 << 0u << 1000u << 3 << QStringList{ u"The dwell option requires multiple modes"_s };
+    QTest::addRow("invalid-connections")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s, u"--max-connections"_s, u"0"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0 << 0u << 1000u << 3 << QStringList{ u"Invalid max-connections value: 0"_s };
+    QTest::addRow("invalid-range")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc,Adc"_s, u"--range"_s, u"10V"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 2 << 10000u << 1000u << 3 << QStringList{ u"The range option is only supported for a single mode"_s };
+}
+
+void TestExporterCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedDevices);
+    QFETCH(MultimeterService::Mode, expectedMode);
+    QFETCH(int, expectedScheduleSize);
+    QFETCH(quint32, expectedRangeOptionValue);
+    QFETCH(quint32, expectedInterval);
+    QFETCH(int, expectedMaxConnections);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"device-list"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"dwell"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+    parser.addOption({u"listen"_s, u"description"_s, u"address"_s});
+    parser.addOption({u"max-connections"_s, u"description"_s, u"count"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+    parser.process(arguments);
+
+    ExporterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QStringList devices;
+    for (const auto &exported: command.devices) {
+        devices.append(exported.deviceName);
+    }
+    QCOMPARE(devices, expectedDevices);
+    QCOMPARE(command.devicesToScanFor, expectedDevices);
+    QVERIFY(command.settings.mode == expectedMode);
+    QCOMPARE(command.schedule.size(), expectedScheduleSize);
+    for (const MeterScheduler::Entry &entry: command.schedule) {
+        QCOMPARE(entry.dwell, command.dwellTime);
+    }
+    QCOMPARE(command.rangeOptionValue, expectedRangeOptionValue);
+    QCOMPARE(command.settings.updateInterval, expectedInterval);
+    QCOMPARE(command.maxConnections, expectedMaxConnections);
+}
+
+void TestExporterCommand::processOptions_listen_data()
+{
+    QTest::addColumn<QString>("listen");
+    QTest::addColumn<QHostAddress>("expectedAddress");
+    QTest::addColumn<quint16>("expectedPort");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("port")      << u"1234"_s << QHostAddress(QHostAddress::LocalHost) << (quint16)1234 << QStringList{};
+    QTest::addRow("localhost") << u"localhost:80"_s << QHostAddress(QHostAddress::LocalHost) << (quint16)80
+                               << QStringList{};
+    QTest::addRow("any")       << u"*:9000"_s << QHostAddress(QHostAddress::Any) << (quint16)9000 << QStringList{};
+    QTest::addRow("ipv4")      << u"0.0.0.0:9464"_s << QHostAddress(u"0.0.0.0"_s) << (quint16)9464 << QStringList{};
+    QTest::addRow("ipv6")      << u"[::1]:9464"_s << QHostAddress(u"::1"_s) << (quint16)9464 << QStringList{};
+    QTest::addRow("no-port")   << u"127.0.0.1"_s << QHostAddress(QHostAddress::LocalHost) << (quint16)9464
+                               << QStringList{ u"Invalid listen value: 127.0.0.1"_s };
+    QTest::addRow("zero-port") << u":0"_s << QHostAddress(QHostAddress::LocalHost) << (quint16)9464
+                               << QStringList{ u"Invalid listen value: :0"_s };
+    QTest::addRow("big-port")  << u"65536"_s << QHostAddress(QHostAddress::LocalHost) << (quint16)9464
+                               << QStringList{ u"Invalid listen value: 65536"_s };
+    QTest::addRow("bad-host")  << u"nowhere:80"_s << QHostAddress(QHostAddress::LocalHost) << (quint16)9464
+                               << QStringList{ u"Invalid listen value: nowhere:80"_s };
+}
+
+void TestExporterCommand::processOptions_listen()
+{
+    QFETCH(QString, listen);
+    QFETCH(QHostAddress, expectedAddress);
+    QFETCH(quint16, expectedPort);
+    QFETCH(QStringList, expectedErrors);
+
+    QCommandLineParser parser;
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"listen"_s, u"description"_s, u"address"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s, u"--listen"_s, listen });
+
+    ExporterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.listenAddress, expectedAddress);
+    QCOMPARE(command.listenPort, expectedPort);
+}
+
+void TestExporterCommand::recordReading()
+{
+    ExporterCommand command(this);
+    command.devices.append({ u"alpha"_s });
+    constexpr auto status = MultimeterService::MeterStatus::AutoRangeOn;
+    command.recordReading(0, { status, 1.0f, MultimeterService::Mode::DcVoltage, 1 });
+    command.recordReading(0, { status, 2.0f, MultimeterService::Mode::DcVoltage, 1 });
+    command.recordReading(0, { status, 3.0f, MultimeterService::Mode::DcCurrent, 1 });
+
+    // Readings replace earlier ones of the same mode, so each device holds at most one reading per mode.
+    const auto &readings = command.devices.at(0).readings;
+    QCOMPARE(readings.size(), 2);
+    QCOMPARE(readings.value(MultimeterService::Mode::DcVoltage).reading.value, 2.0f);
+    QCOMPARE(readings.value(MultimeterService::Mode::DcVoltage).count, (quint64)2);
+    QVERIFY(readings.value(MultimeterService::Mode::DcVoltage).timestamp > 0);
+    QCOMPARE(readings.value(MultimeterService::Mode::DcCurrent).reading.value, 3.0f);
+    QCOMPARE(readings.value(MultimeterService::Mode::DcCurrent).count, (quint64)1);
+}
+
+void TestExporterCommand::handleRequest_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<QByteArray>("expectedStatusLine");
+    QTest::addColumn<QByteArray>("expectedContentType");
+    QTest::addColumn<bool>("expectBody");
+
+    QTest::addRow("get")
+        << QByteArray("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n")
+        << QByteArray("HTTP/1.1 200 OK") << QByteArray("text/plain; version=0.0.4; charset=utf-8") << true;
+    QTest::addRow("query")
+        << QByteArray("GET /metrics?foo=bar HTTP/1.0\n\n")
+        << QByteArray("HTTP/1.1 200 OK") << QByteArray("text/plain; version=0.0.4; charset=utf-8") << true;
+    QTest::addRow("openmetrics")
+        << QByteArray("GET /metrics HTTP/1.1\r\nAccept: application/openmetrics-text;version=1.0.0,text/plain;q=0.5"
+                      "\r\n\r\n")
+        << QByteArray("HTTP/1.1 200 OK")
+        << QByteArray("application/openmetrics-text; version=1.0.0; charset=utf-8") << true;
+    QTest::addRow("head")
+        << QByteArray("HEAD /metrics HTTP/1.1\r\n\r\n")
+        << QByteArray("HTTP/1.1 200 OK") << QByteArray("text/plain; version=0.0.4; charset=utf-8") << false;
+    QTest::addRow("not-found")
+        << QByteArray("GET / HTTP/1.1\r\n\r\n")
+        << QByteArray("HTTP/1.1 404 Not Found") << QByteArray("text/plain; charset=utf-8") << true;
+    QTest::addRow("post")
+        << QByteArray("POST /metrics HTTP/1.1\r\n\r\n")
+        << QByteArray("HTTP/1.1 405 Method Not Allowed") << QByteArray("text/plain; charset=utf-8") << true;
+    QTest::addRow("bad")
+        << QByteArray("garbage\r\n\r\n")
+        << QByteArray("HTTP/1.1 400 Bad Request") << QByteArray("text/plain; charset=utf-8") << true;
+}
+
+void TestExporterCommand::handleRequest()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(QByteArray, expectedStatusLine);
+    QFETCH(QByteArray, expectedContentType);
+    QFETCH(bool, expectBody);
+
+    ExporterCommand command(this);
+    const QByteArray response = command.handleRequest(request);
+    const qsizetype headEnd = response.indexOf("\r\n\r\n");
+    QVERIFY(headEnd > 0);
+    const QList<QByteArray> head = response.left(headEnd).split('\n');
+    QCOMPARE(head.first().trimmed(), expectedStatusLine);
+    QVERIFY(head.contains("Content-Type: " + expectedContentType + '\r'));
+    QCOMPARE(response.size() > headEnd + 4, expectBody);
+    QCOMPARE(command.scrapes, (quint64)((expectedStatusLine.contains(" 200 ")) ? 1 : 0));
+}
+
+void TestExporterCommand::metrics()
+{
+    ExporterCommand command(this);
+    command.devices.append({ u"alpha"_s });
+    command.devices.append({ u"be\"ta"_s });
+    command.devices[0].up = true;
+    command.devices[0].readings[MultimeterService::Mode::DcVoltage] = {
+        { MultimeterService::MeterStatus::AutoRangeOn, 1.5f, MultimeterService::Mode::DcVoltage, 1 },
+        1'700'000'000'123, 3
+    };
+    command.devices[0].readings[MultimeterService::Mode::Resistance] = {
+        { MultimeterService::MeterStatus::Ok, std::numeric_limits<float>::infinity(),
+          MultimeterService::Mode::Resistance, 1 }, 1'700'000'000'456, 1
+    };
+    command.devices[0].deviceStatus = StatusService::Status{
+        StatusService::DeviceStatus::MultimeterDcVoltage, 3.1f, StatusService::BatteryStatus::Good,
+        std::nullopt, StatusService::ChargingStatus::Charging
+    };
+
+    const QByteArray metrics = command.metrics(false);
+    const QList<QByteArray> lines = metrics.split('\n');
+    for (const QByteArray &expected: {
+        QByteArray("# HELP pokit_up Whether the device is currently connected."),
+        QByteArray("# TYPE pokit_up gauge"),
+        QByteArray("pokit_up{device=\"alpha\"} 1"),
+        QByteArray("pokit_up{device=\"be\\\"ta\"} 0"),
+        QByteArray("pokit_meter_reading{device=\"alpha\",mode=\"DC voltage\",unit=\"Vdc\"} 1.5"),
+        QByteArray("pokit_meter_reading{device=\"alpha\",mode=\"Resistance\",unit=\"\xCE\xA9\"} +Inf"),
+        QByteArray("pokit_meter_reading_timestamp_seconds{device=\"alpha\",mode=\"DC voltage\"} 1700000000.123"),
+        QByteArray("# TYPE pokit_meter_readings_total counter"),
+        QByteArray("pokit_meter_readings_total{device=\"alpha\",mode=\"DC voltage\"} 3"),
+        QByteArray("pokit_battery_voltage_volts{device=\"alpha\"} 3.1"),
+        QByteArray("# TYPE pokit_battery_status gauge"),
+        QByteArray("pokit_battery_status{device=\"alpha\",pokit_battery_status=\"Low\"} 0"),
+        QByteArray("pokit_battery_status{device=\"alpha\",pokit_battery_status=\"Good\"} 1"),
+        QByteArray("pokit_charging_status{device=\"alpha\",pokit_charging_status=\"Charging\"} 1"),
+        QByteArray("# TYPE pokit_device_status_info gauge"),
+        QByteArray("pokit_device_status_info{device=\"alpha\",status=\"MultimeterDcVoltage\"} 1"),
+        QByteArray("# TYPE pokit_connections_total counter"),
+        QByteArray("# TYPE pokit_service_notification_interval_seconds histogram"),
+        QByteArray("pokit_exporter_scrapes_total 0"),
+    }) {
+        QVERIFY2(lines.contains(expected), expected.constData());
+    }
+
+    // Undiscovered devices have no link statistics, nor status, and each sample appears exactly once.
+    QVERIFY(!metrics.contains("pokit_battery_voltage_volts{device=\"be\\\"ta\"}"));
+    QVERIFY(!metrics.contains("pokit_connections_total{"));
+    QCOMPARE(metrics.count("pokit_meter_reading{"), 2);
+    QVERIFY(!metrics.contains("# EOF"));
+    QVERIFY(metrics.endsWith('\n'));
+}
+
+void TestExporterCommand::metrics_openMetrics()
+{
+    ExporterCommand command(this);
+    command.devices.append({ u"alpha"_s });
+    command.devices[0].deviceStatus = StatusService::Status{
+        StatusService::DeviceStatus::Idle, 2.5f, StatusService::BatteryStatus::Low, std::nullopt, std::nullopt
+    };
+
+    const QByteArray metrics = command.metrics(true);
+    const QList<QByteArray> lines = metrics.split('\n');
+    for (const QByteArray &expected: {
+        QByteArray("# TYPE pokit_meter_readings counter"),
+        QByteArray("# TYPE pokit_battery_status stateset"),
+        QByteArray("pokit_battery_status{device=\"alpha\",pokit_battery_status=\"Low\"} 1"),
+        QByteArray("# TYPE pokit_device_status info"),
+        QByteArray("pokit_device_status_info{device=\"alpha\",status=\"Idle\"} 1"),
+        QByteArray("# TYPE pokit_connections counter"),
+        QByteArray("# TYPE pokit_exporter_scrapes counter"),
+        QByteArray("pokit_exporter_scrapes_total 0"),
+    }) {
+        QVERIFY2(lines.contains(expected), expected.constData());
+    }
+    QVERIFY(!metrics.contains("pokit_charging_status{")); // Not supported by this device.
+    QVERIFY(metrics.endsWith("\n# EOF\n"));
+}
+
+void TestExporterCommand::escapeLabelValue_data()
+{
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addRow("plain")     << u"Pokit Meter"_s << QByteArray("Pokit Meter");
+    QTest::addRow("quote")     << u"a\"b"_s << QByteArray("a\\\"b");
+    QTest::addRow("backslash") << u"a\\b"_s << QByteArray("a\\\\b");
+    QTest::addRow("newline")   << u"a\nb"_s << QByteArray("a\\nb");
+    QTest::addRow("unicode")   << u"Ω"_s << QByteArray("\xCE\xA9");
+}
+
+void TestExporterCommand::escapeLabelValue()
+{
+    QFETCH(QString, value);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(ExporterCommand::escapeLabelValue(value), expected);
+}
+
+void TestExporterCommand::formatValue_data()
+{
+    QTest::addColumn<double>("value");
+    QTest::addColumn<int>("precision");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addRow("integer")   << 42.0 << 15 << QByteArray("42");
+    QTest::addRow("fraction")  << 0.001 << 15 << QByteArray("0.001");
+    QTest::addRow("float")     << (double)0.1f << 7 << QByteArray("0.1");
+    QTest::addRow("timestamp") << 1700000000.123 << 15 << QByteArray("1700000000.123");
+    QTest::addRow("+inf")      << std::numeric_limits<double>::infinity() << 15 << QByteArray("+Inf");
+    QTest::addRow("-inf")      << -std::numeric_limits<double>::infinity() << 15 << QByteArray("-Inf");
+    QTest::addRow("nan")       << std::numeric_limits<double>::quiet_NaN() << 15 << QByteArray("NaN");
+}
+
+void TestExporterCommand::formatValue()
+{
+    QFETCH(double, value);
+    QFETCH(int, precision);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(ExporterCommand::formatValue(value, precision), expected);
+}
+
+void TestExporterCommand::httpResponse()
+{
+    QCOMPARE(ExporterCommand::httpResponse(200, "OK", "text/plain", "abc"),
+             QByteArray("HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 3\r\n"
+                        "Connection: close\r\n\r\nabc"));
+    QCOMPARE(ExporterCommand::httpResponse(200, "OK", "text/plain", "abc", false),
+             QByteArray("HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 3\r\n"
+                        "Connection: close\r\n\r\n"));
+    QCOMPARE(ExporterCommand::httpResponse(405, "Method Not Allowed", "text/plain", ""),
+             QByteArray("HTTP/1.1 405 Method Not Allowed\r\nContent-Type: text/plain\r\nContent-Length: 0\r\n"
+                        "Allow: GET, HEAD\r\nConnection: close\r\n\r\n"));
+}
+
+void TestExporterCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    ExporterCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestExporterCommand)
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestExporterCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void processOptions_listen_data();
+    void processOptions_listen();
+
+    void recordReading();
+
+    void handleRequest_data();
+    void handleRequest();
+
+    void metrics();
+    void metrics_openMetrics();
+
+    void escapeLabelValue_data();
+    void escapeLabelValue();
+
+    void formatValue_data();
+    void formatValue();
+
+    void httpResponse();
+
+    void tr();
+};
@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestInfluxWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void setUrl_data();
+    void setUrl();
+
+    void write_value();
+    void write_samples();
+    void write_nonFinite();
+
+    void batchSize();
+    void batchInterval();
+    void batchPerDevice();
+    void bufferSize();
+
+    void isRetryable_data();
+    void isRetryable();
+
+    void retryAfter_data();
+    void retryAfter();
+
+    void tr();
+};
@@ -12,6 +12,8 @@
 #include <qtpokit/pokitdevice.h>
 
 #include <QOperatingSystemVersion>
+#include <QSettings>
+#include <QTemporaryDir>
 
 Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
 
@@ -61,6 +63,62 @@ void TestInfoCommand::getService()
     // Unable to safely invoke InfoCommand::getService() without a valid Bluetooth device.
 }
 
+void TestInfoCommand::usesDiscoveredValues()
+{
+    InfoCommand command(this);
+    QVERIFY(command.usesDiscoveredValues());
+
+    // Once the device's information has been cached, discovered values are no longer needed.
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    command.discoveryCache = new QSettings(dir.filePath(u"cache.ini"_s), QSettings::IniFormat, &command);
+    command.discoveryCacheKey = u"test"_s;
+    QVERIFY(command.usesDiscoveredValues());
+    command.discoveryCache->setValue(u"test/deviceInfo/firmwareRevision"_s, u"1.4"_s);
+    QVERIFY(!command.usesDiscoveredValues());
+}
+
+void TestInfoCommand::cachedInfo()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    InfoCommand command(this);
+    InfoCommand::DeviceInfo info{ u"Pokit"_s, u"pokitPro"_s, u"2.0"_s, u"1.4"_s, u"1.1"_s, u"0123456789"_s };
+
+    // Without a cache, nothing should be saved, or read.
+    command.saveCachedInfo(info);
+    QVERIFY(!command.readCachedInfo());
+
+    command.discoveryCache = new QSettings(dir.filePath(u"cache.ini"_s), QSettings::IniFormat, &command);
+    command.discoveryCacheKey = u"test"_s;
+    QVERIFY(!command.readCachedInfo());
+
+    // Information without a firmware revision cannot be validated later, so should not be saved.
+    command.saveCachedInfo(InfoCommand::DeviceInfo{});
+    QVERIFY(!command.readCachedInfo());
+
+    command.saveCachedInfo(info);
+    std::optional<InfoCommand::DeviceInfo> cached = command.readCachedInfo();
+    QVERIFY(cached);
+    QCOMPARE(cached->manufacturer, info.manufacturer);
+    QCOMPARE(cached->modelNumber, info.modelNumber);
+    QCOMPARE(cached->hardwareRevision, info.hardwareRevision);
+    QCOMPARE(cached->firmwareRevision, info.firmwareRevision);
+    QCOMPARE(cached->softwareRevision, info.softwareRevision);
+    QCOMPARE(cached->serialNumber, info.serialNumber);
+    QCOMPARE(command.discoveryCache->group(), QString()); // Group restored.
+
+    // Saving should replace the previous information, including any no-longer-reported serial number.
+    info.firmwareRevision = u"1.5"_s;
+    info.serialNumber = QString();
+    command.saveCachedInfo(info);
+    cached = command.readCachedInfo();
+    QVERIFY(cached);
+    QCOMPARE(cached->firmwareRevision, u"1.5"_s);
+    QVERIFY(cached->serialNumber.isNull());
+    QCOMPARE(command.discoveryCache->group(), QString()); // Group restored.
+}
+
 void TestInfoCommand::serviceDetailsDiscovered_data()
 {
     if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
@@ -15,6 +15,9 @@ private slots:
     void processOptions();
 
     void getService();
+    void usesDiscoveredValues();
+
+    void cachedInfo();
 
     void serviceDetailsDiscovered_data();
     void serviceDetailsDiscovered();
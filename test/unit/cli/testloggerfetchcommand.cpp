@@ -9,16 +9,188 @@
 
 #include "loggerfetchcommand.h"
 
+#include <qtpokit/pokitdevice.h>
 #include <qtpokit/pokitmeter.h>
 #include <qtpokit/pokitpro.h>
 
+#include <QFile>
 #include <QRegularExpression>
+#include <QTemporaryDir>
+
+// Qt 6.5.0 added new QDateTime::fromSecsSinceEpoch() and fromMSecsSinceEpoch()
+// overloads, then Qt 6.6.0 deprecated some of of the older ones.
+#if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
+    #define DOKIT_QT_UTC Qt::UTC
+#else
+    #include <QTimeZone>
+    #define DOKIT_QT_UTC QTimeZone::UTC
+#endif
 
 Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
 Q_DECLARE_METATYPE(DataLoggerService::Metadata)
 
 DOKIT_USE_STRINGLITERALS
 
+class MockDeviceCommand : public DeviceCommand
+{
+public:
+    MockDeviceCommand(QObject * const parent = nullptr) : DeviceCommand(parent)
+    {
+
+    }
+
+    AbstractPokitService * getService() override
+    {
+        return nullptr;
+    }
+};
+
+void TestLoggerFetchCommand::supportedOptions()
+{
+    LoggerFetchCommand command(this);
+    MockDeviceCommand mock;
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + mock.supportedOptions(parser) +
+        QStringList{ u"archive"_s, u"charge"_s, u"charge-gap"_s, u"compress"_s, u"event"_s, u"filter"_s,
+                     u"incremental"_s, u"influx"_s, u"mark-clipping"_s, u"raw"_s, u"sqlite"_s, u"summary"_s,
+                     u"time-format"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestLoggerFetchCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QString>("expectArchive");
+    QTest::addColumn<bool>("expectCursors");
+    QTest::addColumn<bool>("expectEpochTimestamps");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none")
+        << QStringList{} << QString() << false << false << QStringList{};
+    QTest::addRow("archive")
+        << QStringList{ u"--archive"_s, u"logger.bin"_s } << u"logger.bin"_s << false << false << QStringList{};
+    QTest::addRow("compress")
+        << QStringList{ u"--compress"_s } << QString() << false << false << QStringList{};
+    QTest::addRow("compressArchive")
+        << QStringList{ u"--archive"_s, u"logger.bin"_s, u"--compress"_s } << u"logger.bin"_s << false << false
+        << QStringList{};
+    QTest::addRow("incremental")
+        << QStringList{ u"--incremental"_s } << QString() << true << false << QStringList{};
+    QTest::addRow("iso")
+        << QStringList{ u"--time-format"_s, u"iso"_s } << QString() << false << false << QStringList{};
+    QTest::addRow("epoch")
+        << QStringList{ u"--time-format"_s, u"Epoch"_s } << QString() << false << true << QStringList{};
+    QTest::addRow("invalid")
+        << QStringList{ u"--time-format"_s, u"foo"_s } << QString() << false << false
+        << QStringList{ u"Unknown time format: foo"_s };
+    QTest::addRow("filter")
+        << QStringList{ u"--filter"_s, u"highpass:0.01"_s } << QString() << false << false << QStringList{};
+    QTest::addRow("invalidFilter")
+        << QStringList{ u"--filter"_s, u"lowpass"_s } << QString() << false << false
+        << QStringList{ u"Invalid filter: lowpass"_s };
+    QTest::addRow("binaryFilter")
+        << QStringList{ u"--filter"_s, u"lowpass:1"_s, u"--output"_s, u"binary"_s } << QString() << false << false
+        << QStringList{ u"Binary output is only supported for raw samples, not --filter"_s };
+    QTest::addRow("event")
+        << QStringList{ u"--event"_s, u"below:3.3:0.1:10s"_s } << QString() << false << false << QStringList{};
+    QTest::addRow("invalidEvent")
+        << QStringList{ u"--event"_s, u"below"_s } << QString() << false << false
+        << QStringList{ u"Invalid event: below"_s };
+    QTest::addRow("arrowEvent")
+        << QStringList{ u"--event"_s, u"above:1"_s, u"--output"_s, u"arrow"_s } << QString() << false << false
+        << QStringList{ u"Arrow output is only supported for raw values, not --event"_s };
+    QTest::addRow("lineProtocolEvent")
+        << QStringList{ u"--event"_s, u"above:1"_s, u"--output"_s, u"line-protocol"_s } << QString() << false
+        << false << QStringList{ u"Line protocol output is only supported for raw values, not --event"_s };
+    QTest::addRow("summary")
+        << QStringList{ u"--summary"_s, u"3600s"_s } << QString() << false << false << QStringList{};
+    QTest::addRow("invalidSummary")
+        << QStringList{ u"--summary"_s, u"foo"_s } << QString() << false << false
+        << QStringList{ u"Invalid summary value: foo"_s };
+    QTest::addRow("binarySummary")
+        << QStringList{ u"--summary"_s, u"60s"_s, u"--output"_s, u"binary"_s } << QString() << false << false
+        << QStringList{ u"Binary output is only supported for raw samples, not --summary"_s };
+    QTest::addRow("eventSummary")
+        << QStringList{ u"--summary"_s, u"60s"_s, u"--event"_s, u"above:1"_s } << QString() << false << false
+        << QStringList{ u"The summary option cannot be combined with the event option"_s };
+    QTest::addRow("charge")
+        << QStringList{ u"--charge"_s, u"10s"_s, u"--charge-gap"_s, u"hold"_s } << QString() << false << false
+        << QStringList{};
+    QTest::addRow("chargeGap")
+        << QStringList{ u"--charge-gap"_s, u"hold"_s } << QString() << false << false
+        << QStringList{ u"The charge-gap option requires the charge option"_s };
+    QTest::addRow("eventCharge")
+        << QStringList{ u"--charge"_s, u"10s"_s, u"--event"_s, u"above:1"_s } << QString() << false << false
+        << QStringList{ u"The charge option cannot be combined with the event or summary options"_s };
+    QTest::addRow("markClipping")
+        << QStringList{ u"--mark-clipping"_s, u"--output"_s, u"ndjson"_s } << QString() << false << false
+        << QStringList{};
+    QTest::addRow("csvMarkClipping")
+        << QStringList{ u"--mark-clipping"_s, u"--output"_s, u"csv"_s } << QString() << false << false
+        << QStringList{ u"Clipping markers are only supported for JSON, NDJSON and text output"_s };
+    QTest::addRow("summaryMarkClipping")
+        << QStringList{ u"--mark-clipping"_s, u"--summary"_s, u"60s"_s, u"--output"_s, u"json"_s } << QString()
+        << false << false
+        << QStringList{ u"Clipping markers are only supported for sample output, not --charge, --event or "
+                        "--summary"_s };
+    QTest::addRow("raw")
+        << QStringList{ u"--raw"_s, u"--output"_s, u"ndjson-envelope"_s } << QString() << false << false
+        << QStringList{};
+    QTest::addRow("binaryRaw")
+        << QStringList{ u"--raw"_s, u"--output"_s, u"binary"_s } << QString() << false << false
+        << QStringList{ u"Raw counts are only supported for CSV, NDJSON, NDJSON-Envelope and text output"_s };
+    QTest::addRow("filterSummaryRaw")
+        << QStringList{ u"--raw"_s, u"--filter"_s, u"lowpass:1"_s, u"--summary"_s, u"60s"_s } << QString()
+        << false << false
+        << QStringList{ u"Raw counts are only supported for unmodified sample output, not --filter, --summary"_s };
+}
+
+void TestLoggerFetchCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QString, expectArchive);
+    QFETCH(bool, expectCursors);
+    QFETCH(bool, expectEpochTimestamps);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"charge"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"charge-gap"_s, u"description"_s, u"policy"_s});
+    parser.addOption({u"compress"_s, u"description"_s});
+    parser.addOption({u"event"_s, u"description"_s, u"spec"_s});
+    parser.addOption({u"filter"_s, u"description"_s, u"spec"_s});
+    parser.addOption({u"incremental"_s, u"description"_s});
+    parser.addOption({u"mark-clipping"_s, u"description"_s});
+    parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+    parser.addOption({u"raw"_s, u"description"_s});
+    parser.addOption({u"summary"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"time-format"_s, u"description"_s, u"format"_s});
+    parser.process(arguments);
+
+    LoggerFetchCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.archive != nullptr, !expectArchive.isEmpty());
+    QCOMPARE(command.compressSamples, arguments.contains(u"--compress"_s));
+    if (command.archive) {
+        QCOMPARE(command.archive->fileName(), expectArchive);
+        QCOMPARE(command.archive->compressSamples(), command.compressSamples);
+    }
+    QCOMPARE(command.cursors != nullptr, expectCursors);
+    if (expectCursors) {
+        QCOMPARE(command.cursors->group(), u"loggerFetchCursors"_s);
+    }
+    QCOMPARE(command.epochTimestamps, expectEpochTimestamps);
+    QCOMPARE(command.filter != nullptr, arguments.contains(u"--filter"_s));
+    QCOMPARE(command.summaryPeriod, (arguments.contains(u"3600s"_s)) ? 3600000u
+                                    : (arguments.contains(u"60s"_s)) ? 60000u : 0u);
+    QCOMPARE(command.chargeIntegrator != nullptr, arguments.contains(u"--charge"_s));
+    QCOMPARE(command.markClipping, arguments.contains(u"--mark-clipping"_s));
+    QCOMPARE(command.rawCounts, (arguments.contains(u"--raw"_s)) && (expectedErrors.isEmpty()));
+}
+
 void TestLoggerFetchCommand::getService()
 {
     // Unable to safely invoke LoggerFetchCommand::getService() without a valid Bluetooth device.
@@ -29,6 +201,17 @@ void TestLoggerFetchCommand::serviceDetailsDiscovered()
     // Unable to safely invoke LoggerFetchCommand::serviceDetailsDiscovered() without a valid service.
 }
 
+void TestLoggerFetchCommand::serviceResumed()
+{
+    // Only the interrupted, non-incremental, fetch can be tested without a valid service.
+    LoggerFetchCommand command;
+    command.samplesToGo = 10;
+    QTest::ignoreMessage(QtWarningMsg, "Resumed after reconnecting.");
+    QTest::ignoreMessage(QtCriticalMsg,
+        "Logger fetch interrupted; use --incremental to resume interrupted fetches.");
+    command.serviceResumed(-1, 0);
+}
+
 void TestLoggerFetchCommand::metadataRead()
 {
     const DataLoggerService::Metadata metadata{
@@ -52,6 +235,49 @@ void TestLoggerFetchCommand::metadataRead()
     QCOMPARE(command.timestamp,                (quint64)metadata.timestamp * (quint64)1000);
 }
 
+void TestLoggerFetchCommand::formatTimestamp_data()
+{
+    QTest::addColumn<quint32>("start");
+    QTest::addColumn<quint32>("interval");
+
+    QTest::addRow("1ms")      << (quint32)1700000000 << (quint32)1;
+    QTest::addRow("999ms")    << (quint32)1700000000 << (quint32)999;
+    QTest::addRow("1s")       << (quint32)1700000000 << (quint32)1000;
+    QTest::addRow("7.5s")     << (quint32)1700000000 << (quint32)7500;
+    QTest::addRow("1min")     << (quint32)1700000000 << (quint32)60000;
+    QTest::addRow("1h")       << (quint32)1700000000 << (quint32)3600000;
+    QTest::addRow("newYear")  << (quint32)1704067200 - 3 << (quint32)1000;   // 2023-12-31T23:59:57Z
+    QTest::addRow("leapDay")  << (quint32)1709164800 - 3 << (quint32)1000;   // 2024-02-28T23:59:57Z
+    QTest::addRow("y2038")    << (quint32)2147483647 - 3 << (quint32)1000;
+    QTest::addRow("epoch")    << (quint32)1 << (quint32)333;
+}
+
+void TestLoggerFetchCommand::formatTimestamp()
+{
+    QFETCH(quint32, start);
+    QFETCH(quint32, interval);
+
+    LoggerFetchCommand command;
+    command.metadata.timestamp = start;
+    quint64 msecs = (quint64)start * (quint64)1000;
+    for (int sample = 0; sample < 100; ++sample, msecs += interval) {
+        // Incremental ISO 8601 formatting should always match QDateTime's.
+        QCOMPARE(command.formatTimestamp(msecs), QDateTime::fromMSecsSinceEpoch((qint64)msecs, DOKIT_QT_UTC)
+            .toString(Qt::ISODateWithMs).toLatin1());
+    }
+
+    // Epoch timestamps are plain integers.
+    command.epochTimestamps = true;
+    QCOMPARE(command.formatTimestamp(msecs), QByteArray::number(msecs));
+    QCOMPARE(command.toJsonTimestamp(command.formatTimestamp(msecs)), QByteArray::number(msecs));
+
+    // As are timestamps for logging sessions without a start time.
+    command.epochTimestamps = false;
+    command.metadata.timestamp = 0;
+    QCOMPARE(command.formatTimestamp(1234), QByteArray("1234"));
+    QCOMPARE(command.toJsonTimestamp(QByteArray("1234")), QByteArray(R"("1234")"));
+}
+
 void TestLoggerFetchCommand::outputSamples_data()
 {
     if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
@@ -121,6 +347,510 @@ void TestLoggerFetchCommand::outputSamples()
     QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
 }
 
+void TestLoggerFetchCommand::outputSamples_arrow()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Arrow;
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.timestamp, Q_UINT64_C(1700000180000));
+
+    QByteArray expected;
+    AbstractCommand::writeArrowSchema(expected);
+    AbstractCommand::writeArrowRecordBatch(expected, { Q_INT64_C(1700000000000000), Q_INT64_C(1700000060000000) },
+                                           { 0.5f, -1.0f }, 1, 1);
+    AbstractCommand::writeArrowRecordBatch(expected, { Q_INT64_C(1700000120000000) }, { 150.0f }, 1, 1);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestLoggerFetchCommand::outputSamples_binary()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Binary;
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.timestamp, Q_UINT64_C(1700000180000));
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray::fromHex(
+        "444f4b42" "01" "02" "01" "01" "0000003f" "60ea0000" "0068e5cf8b010000" "03000000" "02000000"
+        "0100feff2c01"));
+}
+
+void TestLoggerFetchCommand::outputSamples_binaryCompressed()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Binary;
+    command.compressSamples = true;
+    command.previousSample = 123; // Should be reset by the block header.
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 }); // Continues on from the previous batch's last sample.
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray::fromHex(
+        "444f4b42" "01" "02" "01" "01" "0000003f" "60ea0000" "0068e5cf8b010000" "03000000" "00000000"
+        "0205dc04"));
+}
+
+void TestLoggerFetchCommand::outputSamples_ndjson()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"timestamp":"2023-11-14T22:13:20.000Z","value":0.5,)"
+        R"("unit":"Vdc","mode":"DC voltage","range":"Up to 2V"})" "\n"
+        R"({"timestamp":"2023-11-14T22:14:20.000Z","value":-1,)"
+        R"("unit":"Vdc","mode":"DC voltage","range":"Up to 2V"})" "\n"
+        R"({"timestamp":"2023-11-14T22:15:20.000Z","value":150,)"
+        R"("unit":"Vdc","mode":"DC voltage","range":"Up to 2V"})" "\n"));
+}
+
+void TestLoggerFetchCommand::outputSamples_markClipping()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.markClipping = true;
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 });
+    QCOMPARE(command.saturation.threshold(), (qint16)4); // The 2V range's maximum, at 0.5V per raw sample.
+    command.outputSamples({ 4, 1 });
+    command.outputSamples({ -300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.saturation.saturatedCount(), (qint64)2);
+
+    // Each run is marked after the batch that ended it, or at the end of the session, timestamped from its start.
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"timestamp":"2023-11-14T22:13:20.000Z","value":2,)"
+        R"("unit":"Vdc","mode":"DC voltage","range":"Up to 2V"})" "\n"
+        R"({"timestamp":"2023-11-14T22:14:20.000Z","value":0.5,)"
+        R"("unit":"Vdc","mode":"DC voltage","range":"Up to 2V"})" "\n"
+        R"({"clipped":1,"range":"Up to 2V","timestamp":"2023-11-14T22:13:20.000Z"})" "\n"
+        R"({"timestamp":"2023-11-14T22:15:20.000Z","value":-150,)"
+        R"("unit":"Vdc","mode":"DC voltage","range":"Up to 2V"})" "\n"
+        R"({"clipped":1,"range":"Up to 2V","timestamp":"2023-11-14T22:15:20.000Z"})" "\n"));
+}
+
+void TestLoggerFetchCommand::outputSamples_ndjsonEnvelope()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::NdjsonEnvelope;
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"mode":"DC voltage","unit":"Vdc","range":"Up to 2V","timestamp":"2023-11-14T22:13:20.000Z",)"
+        R"("updateInterval":60000,"numberOfSamples":3,"values":[0.5,-1,150]})" "\n"));
+}
+
+void TestLoggerFetchCommand::outputSamples_raw()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.epochTimestamps = true;
+    command.rawCounts = true;
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 2, 1700000000 });
+    command.outputSamples({ 1, -2 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"mode":"DC voltage","unit":"Vdc","range":"Up to 2V","scale":0.5})" "\n"
+        R"({"timestamp":1700000000000,"count":1})" "\n"
+        R"({"timestamp":1700000060000,"count":-2})" "\n"));
+}
+
+void TestLoggerFetchCommand::outputSamples_rawEnvelope()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::NdjsonEnvelope;
+    command.rawCounts = true;
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 });
+    command.outputSamples({ 1, -2 });
+    command.outputSamples({ 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"mode":"DC voltage","unit":"Vdc","range":"Up to 2V","timestamp":"2023-11-14T22:13:20.000Z",)"
+        R"("updateInterval":60000,"numberOfSamples":3,"scale":0.5,"counts":[1,-2,300]})" "\n"));
+}
+
+void TestLoggerFetchCommand::outputSamples_epoch()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.epochTimestamps = true;
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 2, 1700000000 });
+    command.outputSamples({ 1, -2 });
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"timestamp":1700000000000,"value":0.5,)"
+        R"("unit":"Vdc","mode":"DC voltage","range":"Up to 2V"})" "\n"
+        R"({"timestamp":1700000060000,"value":-1,)"
+        R"("unit":"Vdc","mode":"DC voltage","range":"Up to 2V"})" "\n"));
+}
+
+void TestLoggerFetchCommand::outputSamples_summary()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.summaryPeriod = 120000; // Two minutes, aligned to the epoch, so beginning 22:12, 22:14, 22:16, etc.
+    command.metadataRead({ DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V, 60000, 5, 1700000000 });
+    command.outputSamples({ 2, 4 });
+    command.outputSamples({ 6, 8, 10 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"count":1,"end":"2023-11-14T22:14:00.000Z","maximum":1,"mean":1,"minimum":1,"mode":"DC voltage",)"
+        R"("p50":1,"p95":1,"p99":1,"range":"Up to 2V","start":"2023-11-14T22:12:00.000Z","unit":"Vdc"})" "\n"
+        R"({"count":2,"end":"2023-11-14T22:16:00.000Z","maximum":3,"mean":2.5,"minimum":2,"mode":"DC voltage",)"
+        R"("p50":2,"p95":3,"p99":3,"range":"Up to 2V","start":"2023-11-14T22:14:00.000Z","unit":"Vdc"})" "\n"
+        R"({"count":2,"end":"2023-11-14T22:18:00.000Z","maximum":5,"mean":4.5,"minimum":4,"mode":"DC voltage",)"
+        R"("p50":4,"p95":5,"p99":5,"range":"Up to 2V","start":"2023-11-14T22:16:00.000Z","unit":"Vdc"})" "\n"));
+}
+
+void TestLoggerFetchCommand::outputSamples_incremental()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const DataLoggerService::Metadata metadata{ DataLoggerService::LoggerStatus::Done, 0.5f,
+        DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 };
+
+    // Without a cursor, all samples are output, and the cursor saved.
+    {
+        const OutputStreamCapture capture(&std::cout);
+        LoggerFetchCommand command;
+        command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+        command.service->setPokitProduct(PokitProduct::PokitMeter);
+        command.cursors = new QSettings(dir.filePath(u"cursors.ini"_s), QSettings::IniFormat, &command);
+        command.cursorKey = u"test"_s;
+        command.metadataRead(metadata);
+        command.outputSamples({ 1, -2 });
+        QCOMPARE(command.cursors->value(u"test/timestamp"_s).toUInt(), metadata.timestamp);
+        QCOMPARE(command.cursors->value(u"test/samples"_s).toUInt(), (quint32)2);
+        QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+            "2023-11-14T22:13:20.000Z 0.5 Vdc\n"
+            "2023-11-14T22:14:20.000Z -1 Vdc\n"));
+    }
+
+    // With a cursor for the same session, only the new samples are output.
+    {
+        const OutputStreamCapture capture(&std::cout);
+        LoggerFetchCommand command;
+        command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+        command.service->setPokitProduct(PokitProduct::PokitMeter);
+        command.cursors = new QSettings(dir.filePath(u"cursors.ini"_s), QSettings::IniFormat, &command);
+        command.cursorKey = u"test"_s;
+        QTest::ignoreMessage(QtInfoMsg, "Skipping 2 previously fetched logger sample/s.");
+        command.metadataRead(metadata);
+        QCOMPARE(command.samplesToGo, 1);
+        QCOMPARE(command.timestamp, Q_UINT64_C(1700000120000));
+        command.outputSamples({ 1 });
+        command.outputSamples({ -2, 300 });
+        QCOMPARE(command.samplesToGo, 0);
+        QCOMPARE(command.cursors->value(u"test/samples"_s).toUInt(), (quint32)3);
+        QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray("2023-11-14T22:15:20.000Z 150 Vdc\n"));
+    }
+
+    // With a cursor for a different session, all samples are output again.
+    {
+        const OutputStreamCapture capture(&std::cout);
+        LoggerFetchCommand command;
+        command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+        command.service->setPokitProduct(PokitProduct::PokitMeter);
+        command.cursors = new QSettings(dir.filePath(u"cursors.ini"_s), QSettings::IniFormat, &command);
+        command.cursorKey = u"test"_s;
+        DataLoggerService::Metadata newSession = metadata;
+        newSession.timestamp += 3600;
+        QTest::ignoreMessage(QtInfoMsg, "New logging session detected; fetching all logger samples.");
+        command.metadataRead(newSession);
+        QCOMPARE(command.samplesToGo, 3);
+        command.outputSamples({ 1, -2, 300 });
+        QCOMPARE(command.cursors->value(u"test/timestamp"_s).toUInt(), newSession.timestamp);
+        QCOMPARE(command.cursors->value(u"test/samples"_s).toUInt(), (quint32)3);
+        QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+            "2023-11-14T23:13:20.000Z 0.5 Vdc\n"
+            "2023-11-14T23:14:20.000Z -1 Vdc\n"
+            "2023-11-14T23:15:20.000Z 150 Vdc\n"));
+    }
+}
+
+void TestLoggerFetchCommand::outputSamples_archive()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"logger.bin"_s);
+    const DataLoggerService::Metadata metadata{ DataLoggerService::LoggerStatus::Done, 0.5f,
+        DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 };
+
+    // A full fetch, then an incremental fetch of the same (since grown) session, should archive each sample once.
+    for (const quint16 numberOfSamples: { 2, 3 }) {
+        const OutputStreamCapture capture(&std::cout);
+        LoggerFetchCommand command;
+        command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+        command.service->setPokitProduct(PokitProduct::PokitMeter);
+        command.archive = new LoggerArchive(fileName, &command);
+        command.cursors = new QSettings(dir.filePath(u"cursors.ini"_s), QSettings::IniFormat, &command);
+        command.cursorKey = u"test"_s;
+        DataLoggerService::Metadata session = metadata;
+        session.numberOfSamples = numberOfSamples;
+        command.metadataRead(session);
+        command.outputSamples({ 1 });
+        if (numberOfSamples == 2) {
+            QVERIFY(!QFile::exists(fileName)); // Not appended until the fetch completes.
+            command.outputSamples({ -2 });
+        } else {
+            QCOMPARE(command.samplesSkipped, (quint32)2);
+            command.outputSamples({ -2, 300 });
+        }
+        QCOMPARE(command.samplesToGo, 0);
+        QVERIFY(command.archiveSamples.isEmpty());
+    }
+
+    LoggerArchive archive(fileName);
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)2);
+    QCOMPARE(archive.session(0).metadata.mode, metadata.mode);
+    QCOMPARE(archive.session(0).metadata.range, metadata.range);
+    QCOMPARE(archive.session(0).metadata.scale, metadata.scale);
+    QCOMPARE(archive.session(0).firstSample, (quint32)0);
+    QCOMPARE(archive.samples(0), DataLoggerService::Samples({ 1, -2 }));
+    QCOMPARE(archive.session(1).firstSample, (quint32)2);
+    QCOMPARE(archive.session(1).firstTimestamp, Q_UINT64_C(1700000120000));
+    QCOMPARE(archive.samples(1), DataLoggerService::Samples({ 300 }));
+}
+
+void TestLoggerFetchCommand::outputSamples_tail()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.tail = true;
+    DataLoggerService::Metadata session{ DataLoggerService::LoggerStatus::Sampling, 0.5f,
+        DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V, 60000, 2, 1700000000 };
+
+    // The initial fetch outputs all samples, then waits for the session to grow.
+    command.refreshing = true;
+    command.metadataRead(session);
+    QVERIFY(!command.refreshing);
+    command.outputSamples({ 1, -2 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.samplesTailed, (quint32)2);
+    QVERIFY(command.pollTimer);
+    QVERIFY(command.pollTimer->isActive());
+    QCOMPARE(command.pollTimer->interval(), 60000);
+
+    // Unexpected samples, outside of a fetch, are ignored.
+    command.outputSamples({ 123 });
+
+    // Metadata without new samples does not trigger a fetch.
+    command.metadataRead(session);
+    QVERIFY(!command.refreshing);
+
+    // But once the session has grown, it is fetched again, and only the new samples output.
+    session.numberOfSamples = 3;
+    command.metadataRead(session);
+    QVERIFY(command.refreshing);
+    QTest::ignoreMessage(QtInfoMsg, "Skipping 2 previously fetched logger sample/s.");
+    command.metadataRead(session);
+    QCOMPARE(command.samplesToGo, 1);
+    command.metadataRead(session); // Mid-fetch notifications are ignored.
+    QVERIFY(!command.refreshing);
+    command.outputSamples({ 1, -2, 300 });
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.samplesTailed, (quint32)3);
+
+    // And a new session is fetched in full.
+    session.timestamp += 3600;
+    session.numberOfSamples = 1;
+    command.metadataRead(session);
+    QVERIFY(command.refreshing);
+    QTest::ignoreMessage(QtInfoMsg, "New logging session detected; fetching all logger samples.");
+    command.metadataRead(session);
+    QCOMPARE(command.samplesToGo, 1);
+    command.outputSamples({ 4 });
+    QCOMPARE(command.samplesTailed, (quint32)1);
+
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        "2023-11-14T22:13:20.000Z 0.5 Vdc\n"
+        "2023-11-14T22:14:20.000Z -1 Vdc\n"
+        "2023-11-14T22:15:20.000Z 150 Vdc\n"
+        "2023-11-14T23:13:20.000Z 2 Vdc\n"));
+}
+
+void TestLoggerFetchCommand::shouldDrain_data()
+{
+    QTest::addColumn<quint8>("drainPercent");
+    QTest::addColumn<quint16>("bufferSize");
+    QTest::addColumn<quint8>("status");
+    QTest::addColumn<quint16>("numberOfSamples");
+    QTest::addColumn<bool>("expected");
+
+    #define DOKIT_ADD_TEST_ROW(name, drainPercent, bufferSize, status, numberOfSamples, expected) \
+        QTest::addRow(name) << (quint8)drainPercent << (quint16)bufferSize \
+            << (quint8)DataLoggerService::LoggerStatus::status << (quint16)numberOfSamples << expected
+    DOKIT_ADD_TEST_ROW("disabled",            0, 1000, Sampling,    1000, false);
+    DOKIT_ADD_TEST_ROW("disabled:full",       0, 1000, BufferFull,  1000, false);
+    DOKIT_ADD_TEST_ROW("below",              90, 1000, Sampling,     899, false);
+    DOKIT_ADD_TEST_ROW("at",                 90, 1000, Sampling,     900, true);
+    DOKIT_ADD_TEST_ROW("above",              90, 1000, Sampling,     950, true);
+    DOKIT_ADD_TEST_ROW("full",               90, 1000, BufferFull,   100, true);
+    DOKIT_ADD_TEST_ROW("done",               90, 1000, Done,        1000, false);
+    DOKIT_ADD_TEST_ROW("error",              90, 1000, Error,       1000, false);
+    DOKIT_ADD_TEST_ROW("unknownSize",        90,    0, Sampling,    6000, false);
+    DOKIT_ADD_TEST_ROW("unknownSize:full",   90,    0, BufferFull,  6000, true);
+    #undef DOKIT_ADD_TEST_ROW
+}
+
+void TestLoggerFetchCommand::shouldDrain()
+{
+    QFETCH(quint8, drainPercent);
+    QFETCH(quint16, bufferSize);
+    QFETCH(quint8, status);
+    QFETCH(quint16, numberOfSamples);
+    QFETCH(bool, expected);
+
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    LoggerFetchCommand command;
+    command.drainPercent = drainPercent;
+    command.device = new PokitDevice(QBluetoothDeviceInfo(), &command);
+    PokitDevice::Capabilities capabilities;
+    capabilities.samplingBufferSize = bufferSize;
+    command.device->setCapabilities(capabilities);
+    command.metadata.status = (DataLoggerService::LoggerStatus)status;
+    command.metadata.numberOfSamples = numberOfSamples;
+    QCOMPARE(command.shouldDrain(), expected);
+}
+
+void TestLoggerFetchCommand::shouldDrain_clipped()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    LoggerFetchCommand command;
+    command.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.drainPercent = 90;
+    command.metadata.status = DataLoggerService::LoggerStatus::Sampling;
+    command.metadata.mode = DataLoggerService::Mode::DcVoltage;
+    command.metadata.range = +PokitMeter::VoltageRange::_2V;
+    command.metadata.numberOfSamples = 10; // Far below the drain percentage.
+    QVERIFY(!command.shouldDrain());
+
+    // Once clipped, sessions are drained straight away, to restart at the next range up.
+    command.saturation.setThreshold(100);
+    command.saturation.process({ 1, 100, 2 });
+    QVERIFY(command.shouldDrain());
+    QCOMPARE(command.nextRange(), +PokitMeter::VoltageRange::_6V);
+
+    // But not if there is no higher range.
+    command.metadata.range = +PokitMeter::VoltageRange::_60V;
+    QVERIFY(!command.shouldDrain());
+    QCOMPARE(command.nextRange(), +PokitMeter::VoltageRange::_60V);
+
+    // Nor if auto-drain was not requested.
+    command.metadata.range = +PokitMeter::VoltageRange::_2V;
+    command.drainPercent = 0;
+    QVERIFY(!command.shouldDrain());
+}
+
 void TestLoggerFetchCommand::tr()
 {
     // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
@@ -8,14 +8,51 @@ class TestLoggerFetchCommand : public QObject
     Q_OBJECT
 
 private slots:
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
     void getService();
 
     void serviceDetailsDiscovered();
+    void serviceResumed();
 
     void metadataRead();
 
+    void formatTimestamp_data();
+    void formatTimestamp();
+
     void outputSamples_data();
     void outputSamples();
 
+    void outputSamples_arrow();
+    void outputSamples_binary();
+
+    void outputSamples_binaryCompressed();
+
+    void outputSamples_ndjson();
+
+    void outputSamples_markClipping();
+
+    void outputSamples_ndjsonEnvelope();
+
+    void outputSamples_raw();
+    void outputSamples_rawEnvelope();
+
+    void outputSamples_epoch();
+
+    void outputSamples_summary();
+
+    void outputSamples_incremental();
+
+    void outputSamples_archive();
+
+    void outputSamples_tail();
+
+    void shouldDrain_data();
+    void shouldDrain();
+    void shouldDrain_clipped();
+
     void tr();
 };
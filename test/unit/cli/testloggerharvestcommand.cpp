@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testloggerharvestcommand.h"
+#include "outputstreamcapture.h"
+#include "testdata.h"
+#include "../github.h"
+#include "../stringliterals_p.h"
+
+#include "loggerharvestcommand.h"
+
+#include <qtpokit/pokitmeter.h>
+
+Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
+
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+// Two devices' sessions, that interleave (and tie) at 60 and 120 seconds.
+const DataLoggerService::Metadata alphaMetadata{ DataLoggerService::LoggerStatus::Done, 0.5f,
+    DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 };
+const DataLoggerService::Metadata betaMetadata{ DataLoggerService::LoggerStatus::Done, 0.25f,
+    DataLoggerService::Mode::AcCurrent, +PokitMeter::CurrentRange::_2A, 30000, 3, 1700000060 };
+
+}
+
+void TestLoggerHarvestCommand::requiredOptions()
+{
+    LoggerHarvestCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"device"_s });
+}
+
+void TestLoggerHarvestCommand::supportedOptions()
+{
+    LoggerHarvestCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"max-connections"_s, u"time-format"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestLoggerHarvestCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedDevices");
+    QTest::addColumn<int>("expectedMaxConnections");
+    QTest::addColumn<bool>("expectEpochTimestamps");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("single")
+        << QStringList{ u"--device"_s, u"alpha"_s }
+        << QStringList{ u"alpha"_s } << 3 << false << QStringList{};
+    QTest::addRow("repeated")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--device"_s, u"beta"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s } << 3 << false << QStringList{};
+    QTest::addRow("list")
+        << QStringList{ u"--device"_s, u"alpha, beta,,gamma"_s, u"--device"_s, u"alpha"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s, u"gamma"_s } << 3 << false << QStringList{};
+    QTest::addRow("empty")
+        << QStringList{ u"--device"_s, u" , "_s }
+        << QStringList{ } << 3 << false << QStringList{ u"No devices to harvest"_s };
+    QTest::addRow("max-connections")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--max-connections"_s, u"8"_s }
+        << QStringList{ u"alpha"_s } << 8 << false << QStringList{};
+    QTest::addRow("zero-connections")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--max-connections"_s, u"0"_s }
+        << QStringList{ u"alpha"_s } << 3 << false << QStringList{ u"Invalid max-connections value: 0"_s };
+    QTest::addRow("invalid-connections")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--max-connections"_s, u"foo"_s }
+        << QStringList{ u"alpha"_s } << 3 << false << QStringList{ u"Invalid max-connections value: foo"_s };
+    QTest::addRow("epoch")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--time-format"_s, u"Epoch"_s }
+        << QStringList{ u"alpha"_s } << 3 << true << QStringList{};
+    QTest::addRow("invalid-time-format")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--time-format"_s, u"foo"_s }
+        << QStringList{ u"alpha"_s } << 3 << false << QStringList{ u"Unknown time format: foo"_s };
+}
+
+void TestLoggerHarvestCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedDevices);
+    QFETCH(int, expectedMaxConnections);
+    QFETCH(bool, expectEpochTimestamps);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"max-connections"_s, u"description"_s, u"count"_s});
+    parser.addOption({u"time-format"_s, u"description"_s, u"format"_s});
+    parser.process(arguments);
+
+    LoggerHarvestCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QStringList devices;
+    for (const auto &harvest: command.harvests) {
+        devices.append(harvest.deviceName);
+    }
+    QCOMPARE(devices, expectedDevices);
+    QCOMPARE(command.maxConnections, expectedMaxConnections);
+    QCOMPARE(command.epochTimestamps, expectEpochTimestamps);
+}
+
+void TestLoggerHarvestCommand::deviceDiscoveryFinished()
+{
+    const OutputStreamCapture capture(&std::cout);
+    LoggerHarvestCommand command;
+    command.harvests.append({ u"alpha"_s });
+    command.harvests.append({ u"beta"_s });
+    QTest::ignoreMessage(QtWarningMsg, R"(Failed to find device "alpha".)");
+    QTest::ignoreMessage(QtWarningMsg, R"(Failed to find device "beta".)");
+    command.deviceDiscoveryFinished();
+    QVERIFY(command.discoveryFinished);
+    for (const auto &harvest: command.harvests) {
+        QVERIFY(harvest.finished);
+        QVERIFY(harvest.failed);
+    }
+    QVERIFY(command.outputComplete);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray());
+}
+
+void TestLoggerHarvestCommand::samplesRead_beforeMetadata()
+{
+    LoggerHarvestCommand command;
+    command.harvests.append({ u"alpha"_s });
+    QTest::ignoreMessage(QtWarningMsg, R"(Ignoring logger samples from device "alpha", received before metadata.)");
+    command.samplesRead(0, { 1, 2, 3 });
+    QVERIFY(command.harvests.at(0).samples.isEmpty());
+    QCOMPARE(command.harvests.at(0).samplesToGo, -1);
+}
+
+void TestLoggerHarvestCommand::outputSamples_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addRow("merged.csv")    << AbstractCommand::OutputFormat::Csv;
+    QTest::addRow("merged.json")   << AbstractCommand::OutputFormat::Json;
+    QTest::addRow("merged.ndjson") << AbstractCommand::OutputFormat::Ndjson;
+    QTest::addRow("merged.txt")    << AbstractCommand::OutputFormat::Text;
+}
+
+void TestLoggerHarvestCommand::outputSamples()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerHarvestCommand command;
+    command.format = format;
+    for (const auto &[name, metadata, samples]: {
+        std::make_tuple(u"alpha"_s, alphaMetadata, DataLoggerService::Samples{ 1, -2, 3 }),
+        std::make_tuple(u"beta"_s,  betaMetadata,  DataLoggerService::Samples{ 4, 8, 12 }) })
+    {
+        LoggerHarvestCommand::Harvest harvest{ name };
+        harvest.service = new DataLoggerService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()), &command);
+        harvest.service->setPokitProduct(PokitProduct::PokitMeter);
+        harvest.metadata = metadata;
+        harvest.samples = samples;
+        harvest.samplesToGo = 0;
+        command.harvests.append(harvest);
+    }
+    command.outputSamples();
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestLoggerHarvestCommand::outputSamples_epoch()
+{
+    const OutputStreamCapture capture(&std::cout);
+    LoggerHarvestCommand command;
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.epochTimestamps = true;
+    LoggerHarvestCommand::Harvest alpha{ u"alpha"_s }, beta{ u"beta"_s }; // No services, so no ranges.
+    alpha.metadata = alphaMetadata;
+    alpha.samples = { 1 };
+    beta.metadata = alphaMetadata;
+    beta.metadata.timestamp -= 1;
+    beta.samples = { 2 };
+    command.harvests = { alpha, beta };
+    command.outputSamples();
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"timestamp":1699999999000,"device":"beta","value":1,"unit":"Vdc","mode":"DC voltage"})" "\n"
+        R"({"timestamp":1700000000000,"device":"alpha","value":0.5,"unit":"Vdc","mode":"DC voltage"})" "\n"));
+}
+
+void TestLoggerHarvestCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    LoggerHarvestCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestLoggerHarvestCommand)
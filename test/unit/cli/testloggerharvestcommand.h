@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestLoggerHarvestCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void deviceDiscoveryFinished();
+
+    void samplesRead_beforeMetadata();
+
+    void outputSamples_data();
+    void outputSamples();
+
+    void outputSamples_epoch();
+
+    void tr();
+};
@@ -0,0 +1,259 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testloggerstartfleetcommand.h"
+#include "outputstreamcapture.h"
+#include "testdata.h"
+#include "../stringliterals_p.h"
+
+#include "loggerstartfleetcommand.h"
+
+#include <qtpokit/pokitconnectionmanager.h>
+
+#include <QDateTime>
+
+Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
+Q_DECLARE_METATYPE(DataLoggerService::Mode)
+
+DOKIT_USE_STRINGLITERALS
+
+void TestLoggerStartFleetCommand::requiredOptions()
+{
+    LoggerStartFleetCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"mode"_s });
+}
+
+void TestLoggerStartFleetCommand::supportedOptions()
+{
+    LoggerStartFleetCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"device-list"_s, u"interval"_s, u"max-connections"_s, u"range"_s, u"timestamp"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestLoggerStartFleetCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedDevices");
+    QTest::addColumn<DataLoggerService::Mode>("expectedMode");
+    QTest::addColumn<quint32>("expectedRangeOptionValue");
+    QTest::addColumn<quint32>("expectedUpdateInterval");
+    QTest::addColumn<bool>("expectedTimestampOption");
+    QTest::addColumn<int>("expectedMaxConnections");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("list")
+        << QStringList{ u"--device"_s, u"alpha, beta"_s, u"--device"_s, u"gamma"_s,
+                        u"--mode"_s, u"Vdc"_s, u"--range"_s, u"30V"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s, u"gamma"_s } << DataLoggerService::Mode::DcVoltage << 30'000u
+        << 60'000u << false << 3 << QStringList{};
+    QTest::addRow("empty")
+        << QStringList{ u"--device"_s, u" , "_s, u"--mode"_s, u"temp"_s }
+        << QStringList{ } << DataLoggerService::Mode::Temperature << 0u
+        << 60'000u << false << 0 << QStringList{ u"No devices to start"_s };
+    QTest::addRow("settings")
+        << QStringList{ u"--device"_s, u"alpha,beta"_s, u"--mode"_s, u"ac current"_s, u"--range"_s, u"2A"_s,
+                        u"--interval"_s, u"5s"_s, u"--timestamp"_s, u"1700000000"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s } << DataLoggerService::Mode::AcCurrent << 2'000u
+        << 5'000u << true << 2 << QStringList{};
+    QTest::addRow("connections")
+        << QStringList{ u"--device"_s, u"alpha,beta"_s, u"--mode"_s, u"temp"_s, u"--max-connections"_s, u"8"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s } << DataLoggerService::Mode::Temperature << 0u
+        << 60'000u << false << 8 << QStringList{};
+    QTest::addRow("too-few-connections")
+        << QStringList{ u"--device"_s, u"alpha,beta,gamma"_s, u"--mode"_s, u"temp"_s, u"--max-connections"_s, u"2"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s, u"gamma"_s } << DataLoggerService::Mode::Temperature << 0u
+        << 60'000u << false << 3
+        << QStringList{ u"The max-connections value (2) must allow all 3 device/s to be connected at once"_s };
+    QTest::addRow("invalid-connections")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"temp"_s, u"--max-connections"_s, u"0"_s }
+        << QStringList{ u"alpha"_s } << DataLoggerService::Mode::Temperature << 0u
+        << 60'000u << false << 1 << QStringList{ u"Invalid max-connections value: 0"_s };
+    QTest::addRow("invalid-mode")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"resistance"_s }
+        << QStringList{ u"alpha"_s } << DataLoggerService::Mode::DcVoltage << 0u
+        << 60'000u << false << 1 << QStringList{ u"Unknown logger mode: resistance"_s };
+    QTest::addRow("missing-range")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"dc voltage"_s }
+        << QStringList{ u"alpha"_s } << DataLoggerService::Mode::DcVoltage << 0u
+        << 60'000u << false << 1 << QStringList{ u"Missing required option for logger mode 'dc voltage': range"_s };
+}
+
+void TestLoggerStartFleetCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedDevices);
+    QFETCH(DataLoggerService::Mode, expectedMode);
+    QFETCH(quint32, expectedRangeOptionValue);
+    QFETCH(quint32, expectedUpdateInterval);
+    QFETCH(bool, expectedTimestampOption);
+    QFETCH(int, expectedMaxConnections);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"device-list"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+    parser.addOption({u"max-connections"_s, u"description"_s, u"count"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+    parser.addOption({u"timestamp"_s, u"description"_s, u"timestamp"_s});
+    parser.process(arguments);
+
+    LoggerStartFleetCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QStringList devices;
+    for (const auto &logger: command.loggers) {
+        devices.append(logger.deviceName);
+    }
+    QCOMPARE(devices, expectedDevices);
+    QCOMPARE(command.devicesToScanFor, expectedDevices);
+    QCOMPARE(command.settings.mode, expectedMode);
+    QCOMPARE(command.rangeOptionValue, expectedRangeOptionValue);
+    QCOMPARE(command.settings.updateInterval, expectedUpdateInterval);
+    QCOMPARE(command.timestampOption, expectedTimestampOption);
+    if (expectedTimestampOption) {
+        QCOMPARE(command.settings.timestamp, 1700000000u);
+    }
+    QCOMPARE(command.maxConnections, expectedMaxConnections);
+    QCOMPARE(command.manager->maxConnections(), qMax(expectedMaxConnections, 1));
+}
+
+void TestLoggerStartFleetCommand::deviceDiscoveryFinished()
+{
+    const OutputStreamCapture capture(&std::cout);
+    LoggerStartFleetCommand command;
+    command.loggers.append({ u"alpha"_s });
+    command.loggers.append({ u"beta"_s });
+    command.loggers[1].discovered = true; // Discovered, but still waiting for a connection.
+    QTest::ignoreMessage(QtWarningMsg, R"(Failed to find device "alpha".)");
+    command.deviceDiscoveryFinished();
+    QVERIFY(command.discoveryFinished);
+    QVERIFY(command.loggers.at(0).finished);
+    QCOMPARE(command.loggers.at(0).error, u"Device not found"_s);
+    QVERIFY(!command.loggers.at(1).finished);
+    QVERIFY(!command.started); // Still waiting for beta to be ready.
+    QVERIFY(!command.exiting);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray());
+}
+
+void TestLoggerStartFleetCommand::indexOf()
+{
+    LoggerStartFleetCommand command;
+    command.loggers.append({ u"alpha"_s });
+    command.loggers.append({ u"beta"_s });
+    command.loggers[1].ticket = 7;
+    QCOMPARE(command.indexOf(7), 1);
+    QCOMPARE(command.indexOf(8), -1);
+    QCOMPARE(command.indexOf(0), -1); // Not a valid ticket, even though alpha has no ticket.
+}
+
+void TestLoggerStartFleetCommand::checkReady()
+{
+    const OutputStreamCapture capture(&std::cout);
+    LoggerStartFleetCommand command;
+    command.loggers.append({ u"alpha"_s });
+    command.loggers.append({ u"beta"_s });
+    command.loggers[0].finished = true;
+    command.loggers[0].error = u"Connection failed"_s;
+
+    command.checkReady();
+    QVERIFY(!command.started); // Discovery has not finished yet.
+
+    command.discoveryFinished = true;
+    command.checkReady();
+    QVERIFY(!command.started); // Still waiting for beta to be ready.
+
+    // Once the last waiting logger fails, there is nothing left to start, so the summary is output.
+    const quint32 now = (quint32)QDateTime::currentSecsSinceEpoch();
+    command.finishLogger(1, u"Device not found"_s);
+    QVERIFY(command.started);
+    QVERIFY(command.exiting);
+    QVERIFY(command.settings.timestamp >= now); // Taken at start, since no timestamp option was given.
+    QVERIFY(QByteArray::fromStdString(capture.data()).startsWith("alpha: failed (Connection failed)\n"));
+}
+
+void TestLoggerStartFleetCommand::finishLogger()
+{
+    const OutputStreamCapture capture(&std::cout);
+    LoggerStartFleetCommand command;
+    command.loggers.append({ u"alpha"_s });
+    command.loggers.append({ u"beta"_s });
+    command.discoveryFinished = true;
+    command.started = true;
+    command.timestampOption = true;
+    command.settings.timestamp = 1700000000;
+
+    command.loggers[0].startedAt = 1'000'000;
+    command.finishLogger(0);
+    QVERIFY(command.loggers.at(0).finished);
+    QVERIFY(command.loggers.at(0).error.isNull());
+    QVERIFY(!command.exiting); // Still waiting for beta.
+
+    command.finishLogger(0, u"ignored"_s); // Already finished, so ignored.
+    QVERIFY(command.loggers.at(0).error.isNull());
+
+    command.finishLogger(1, u"Connection failed"_s);
+    QVERIFY(command.loggers.at(1).finished);
+    QCOMPARE(command.loggers.at(1).error, u"Connection failed"_s);
+    QVERIFY(command.exiting);
+    QCOMPARE(QByteArray::fromStdString(capture.data()),
+             QByteArray("alpha: started (+0.000ms)\nbeta: failed (Connection failed)\n"
+                        "Started 1 of 2 data logger/s, with timestamp 1700000000, within 0.000ms.\n"));
+}
+
+void TestLoggerStartFleetCommand::skew()
+{
+    LoggerStartFleetCommand command;
+    command.loggers.append({ u"alpha"_s });
+    command.loggers.append({ u"beta"_s });
+    command.loggers.append({ u"gamma"_s });
+    command.loggers[0].startedAt = 5'000'000;
+    command.loggers[2].startedAt = 2'000'000;
+    QCOMPARE(command.skew(0), (qint64)3'000'000);
+    QCOMPARE(command.skew(1), (qint64)-1); // Not started.
+    QCOMPARE(command.skew(2), (qint64)0);  // Started first.
+}
+
+void TestLoggerStartFleetCommand::outputSummary_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addRow("fleet.csv")  << AbstractCommand::OutputFormat::Csv;
+    QTest::addRow("fleet.json") << AbstractCommand::OutputFormat::Json;
+    QTest::addRow("fleet.txt")  << AbstractCommand::OutputFormat::Text;
+}
+
+void TestLoggerStartFleetCommand::outputSummary()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    LoggerStartFleetCommand command;
+    command.format = format;
+    command.settings.timestamp = 1700000000;
+    command.loggers.append({ u"alpha"_s });
+    command.loggers.append({ u"Pokit, B"_s });
+    command.loggers.append({ u"gamma"_s });
+    command.loggers[0].startedAt = 2'000'000;
+    command.loggers[1].error = u"Device not found"_s;
+    command.loggers[2].startedAt = 4'500'000;
+    command.outputSummary();
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestLoggerStartFleetCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    LoggerStartFleetCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestLoggerStartFleetCommand)
@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestLoggerStartFleetCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void deviceDiscoveryFinished();
+
+    void indexOf();
+
+    void checkReady();
+
+    void finishLogger();
+
+    void skew();
+
+    void outputSummary_data();
+    void outputSummary();
+
+    void tr();
+};
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testloggertailcommand.h"
+#include "../stringliterals_p.h"
+
+#include "loggertailcommand.h"
+
+DOKIT_USE_STRINGLITERALS
+
+void TestLoggerTailCommand::constructor()
+{
+    const LoggerTailCommand command(this);
+    QVERIFY(command.tail);
+}
+
+void TestLoggerTailCommand::supportedOptions()
+{
+    // The tail command supports all of the same options as the fetch command, plus the auto-drain and watchdog options.
+    const LoggerTailCommand command(this);
+    const LoggerFetchCommand fetch;
+    QCommandLineParser parser;
+    QCOMPARE(command.supportedOptions(parser), fetch.supportedOptions(parser) +
+        QStringList{ u"auto-drain"_s, u"watchdog"_s });
+}
+
+void TestLoggerTailCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<float>("expectedWatchdogFactor");
+    QTest::addColumn<quint8>("expectedDrainPercent");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none") << QStringList{ } << 0.0f << (quint8)0 << QStringList{ };
+    QTest::addRow("watchdog") << QStringList{ u"--watchdog"_s, u"4"_s } << 4.0f << (quint8)0 << QStringList{ };
+    QTest::addRow("invalid-watchdog") << QStringList{ u"--watchdog"_s, u"0"_s } << 0.0f << (quint8)0
+        << QStringList{ u"Invalid watchdog value: 0"_s };
+    QTest::addRow("auto-drain") << QStringList{ u"--auto-drain"_s, u"90"_s } << 0.0f << (quint8)90
+        << QStringList{ };
+    QTest::addRow("auto-drain:percent") << QStringList{ u"--auto-drain"_s, u"75%"_s } << 0.0f << (quint8)75
+        << QStringList{ };
+    QTest::addRow("auto-drain:full") << QStringList{ u"--auto-drain"_s, u"100"_s } << 0.0f << (quint8)100
+        << QStringList{ };
+    QTest::addRow("invalid-auto-drain:zero") << QStringList{ u"--auto-drain"_s, u"0"_s } << 0.0f << (quint8)0
+        << QStringList{ u"Invalid auto-drain value: 0"_s };
+    QTest::addRow("invalid-auto-drain:over") << QStringList{ u"--auto-drain"_s, u"101%"_s } << 0.0f << (quint8)0
+        << QStringList{ u"Invalid auto-drain value: 101%"_s };
+    QTest::addRow("invalid-auto-drain:text") << QStringList{ u"--auto-drain"_s, u"most"_s } << 0.0f << (quint8)0
+        << QStringList{ u"Invalid auto-drain value: most"_s };
+}
+
+void TestLoggerTailCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(float, expectedWatchdogFactor);
+    QFETCH(quint8, expectedDrainPercent);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"auto-drain"_s, u"description"_s, u"percent"_s});
+    parser.addOption({u"charge"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"charge-gap"_s, u"description"_s, u"policy"_s});
+    parser.addOption({u"compress"_s, u"description"_s});
+    parser.addOption({u"event"_s, u"description"_s, u"spec"_s});
+    parser.addOption({u"filter"_s, u"description"_s, u"spec"_s});
+    parser.addOption({u"incremental"_s, u"description"_s});
+    parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+    parser.addOption({u"summary"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"time-format"_s, u"description"_s, u"format"_s});
+    parser.addOption({u"watchdog"_s, u"description"_s, u"factor"_s});
+    parser.process(arguments);
+
+    LoggerTailCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.watchdogFactor, expectedWatchdogFactor);
+    QCOMPARE(command.drainPercent, expectedDrainPercent);
+}
+
+void TestLoggerTailCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    LoggerTailCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestLoggerTailCommand)
@@ -0,0 +1,19 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestLoggerTailCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void constructor();
+
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void tr();
+};
@@ -0,0 +1,294 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testmeasurementformatter.h"
+#include "../allocationcounter.h"
+#include "../stringliterals_p.h"
+
+#include "measurementformatter.h"
+
+#include <charconv>
+#include <limits>
+
+DOKIT_USE_STRINGLITERALS
+
+Q_DECLARE_METATYPE(MeasurementFormatter::Context)
+
+namespace {
+
+MeasurementFormatter::Context dsoContext()
+{
+    MeasurementFormatter::Context context;
+    context.mode = u"DC voltage"_s;
+    context.unit = u"Vdc"_s;
+    context.range = u"30V"_s;
+    context.csv.infix = ",";
+    context.csv.suffix = ",Vdc,30V\n";
+    context.ndjson.prefix = "{\"value\":";
+    context.ndjson.suffix = ",\"unit\":\"Vdc\"}\n";
+    context.text = u"%1 %2 Vdc\n"_s;
+    return context;
+}
+
+MeasurementFormatter::Context meterContext()
+{
+    MeasurementFormatter::Context context;
+    context.mode = u"Resistance"_s;
+    context.notation = 'f';
+    context.csv.prefix = "Resistance,";
+    context.csv.suffix = ",Ω,,1K\n";
+    context.ndjson.prefix = "{\"status\":\"\",\"value\":";
+    context.ndjson.suffix = "}\n";
+    context.jsonInfinity = "\"Infinity\"";
+    context.textPrefix = u"Mode: Resistance\n"_s;
+    context.text = u"Value: %1 Ω\n"_s;
+    context.textSuffix = u"Range: 1K\n"_s;
+    return context;
+}
+
+MeasurementFormatter::Context rawLoggerContext()
+{
+    MeasurementFormatter::Context context;
+    context.mode = u"DC voltage"_s;
+    context.unit = u"Vdc"_s;
+    context.range = u"30V"_s;
+    context.csv.infix = ",";
+    context.csv.suffix = "\n";
+    context.ndjson.prefix = "{\"timestamp\":";
+    context.ndjson.infix = ",\"count\":";
+    context.ndjson.suffix = "}\n";
+    context.text = u"%1 %2\n"_s;
+    return context;
+}
+
+}
+
+void TestMeasurementFormatter::context()
+{
+    QList<quint32> resolved;
+    MeasurementFormatter formatter([&resolved](const quint8 mode, const quint8 range, const quint8 status) {
+        resolved.append((quint32)mode | ((quint32)range << 8) | ((quint32)status << 16));
+        MeasurementFormatter::Context context;
+        context.mode = QString::number(mode);
+        context.range = QString::number(range);
+        context.status = QString::number(status);
+        return context;
+    });
+    QCOMPARE(formatter.size(), 0);
+
+    // Each distinct context is resolved just once.
+    QCOMPARE(formatter.context(1, 2).mode, u"1"_s);
+    QCOMPARE(formatter.context(1, 2).range, u"2"_s);
+    QCOMPARE(formatter.context(1, 2, 3).status, u"3"_s);
+    QCOMPARE(formatter.context(4, 2).mode, u"4"_s);
+    QCOMPARE(formatter.context(1, 2).status, u"0"_s);
+    QCOMPARE(formatter.context(1, 2, 3).status, u"3"_s);
+    QCOMPARE(resolved, (QList<quint32>{ 0x000201, 0x030201, 0x000204 }));
+    QCOMPARE(formatter.size(), 3);
+}
+
+void TestMeasurementFormatter::clear()
+{
+    int resolved = 0;
+    MeasurementFormatter formatter([&resolved](const quint8, const quint8, const quint8) {
+        ++resolved;
+        return MeasurementFormatter::Context{};
+    });
+    formatter.context(1, 2);
+    formatter.context(1, 2);
+    QCOMPARE(resolved, 1);
+    QCOMPARE(formatter.size(), 1);
+
+    formatter.clear();
+    QCOMPARE(formatter.size(), 0);
+    QVERIFY(formatter.last == nullptr);
+    formatter.context(1, 2);
+    QCOMPARE(resolved, 2);
+    QCOMPARE(formatter.size(), 1);
+}
+
+void TestMeasurementFormatter::appendCsv_data()
+{
+    QTest::addColumn<MeasurementFormatter::Context>("context");
+    QTest::addColumn<QByteArray>("lead");
+    QTest::addColumn<float>("value");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("dso")
+        << dsoContext() << QByteArray("123") << 1.5f << QByteArray("123,1.5,Vdc,30V\n");
+    QTest::addRow("dso-small")
+        << dsoContext() << QByteArray("0") << 0.000012345f << QByteArray("0,1.2345e-05,Vdc,30V\n");
+    QTest::addRow("meter")
+        << meterContext() << QByteArray() << 1.5f << QByteArray("Resistance,1.500000,Ω,,1K\n");
+    QTest::addRow("meter-inf")
+        << meterContext() << QByteArray() << std::numeric_limits<float>::infinity()
+        << QByteArray("Resistance,inf,Ω,,1K\n");
+}
+
+void TestMeasurementFormatter::appendCsv()
+{
+    QFETCH(MeasurementFormatter::Context, context);
+    QFETCH(QByteArray, lead);
+    QFETCH(float, value);
+    QFETCH(QByteArray, expected);
+    QByteArray buffer("existing\n");
+    MeasurementFormatter::appendCsv(buffer, context, lead, value);
+    QCOMPARE(buffer, QByteArray("existing\n") + expected);
+}
+
+void TestMeasurementFormatter::appendCsv_integerLead()
+{
+    QByteArray buffer;
+    MeasurementFormatter::appendCsv(buffer, dsoContext(), (qint64)1, 1.5f);
+    MeasurementFormatter::appendCsv(buffer, dsoContext(), (qint64)1234567, -0.125f);
+    QCOMPARE(buffer, QByteArray("1,1.5,Vdc,30V\n1234567,-0.125,Vdc,30V\n"));
+}
+
+void TestMeasurementFormatter::appendNdjson_data()
+{
+    QTest::addColumn<MeasurementFormatter::Context>("context");
+    QTest::addColumn<QByteArray>("lead");
+    QTest::addColumn<float>("value");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("dso")
+        << dsoContext() << QByteArray() << 1.5f << QByteArray("{\"value\":1.5,\"unit\":\"Vdc\"}\n");
+    QTest::addRow("dso-inf")
+        << dsoContext() << QByteArray() << std::numeric_limits<float>::infinity()
+        << QByteArray("{\"value\":null,\"unit\":\"Vdc\"}\n");
+    QTest::addRow("logger")
+        << []() {
+            MeasurementFormatter::Context context = dsoContext();
+            context.ndjson.prefix = "{\"timestamp\":";
+            context.ndjson.infix = ",\"value\":";
+            return context;
+        }() << QByteArray("\"2024-01-02T03:04:05Z\"") << -2.25f
+        << QByteArray("{\"timestamp\":\"2024-01-02T03:04:05Z\",\"value\":-2.25,\"unit\":\"Vdc\"}\n");
+    QTest::addRow("meter")
+        << meterContext() << QByteArray() << 1.5f << QByteArray("{\"status\":\"\",\"value\":1.5}\n");
+    QTest::addRow("meter-inf")
+        << meterContext() << QByteArray() << std::numeric_limits<float>::infinity()
+        << QByteArray("{\"status\":\"\",\"value\":\"Infinity\"}\n");
+    QTest::addRow("meter-nan")
+        << meterContext() << QByteArray() << std::numeric_limits<float>::quiet_NaN()
+        << QByteArray("{\"status\":\"\",\"value\":null}\n");
+}
+
+void TestMeasurementFormatter::appendNdjson()
+{
+    QFETCH(MeasurementFormatter::Context, context);
+    QFETCH(QByteArray, lead);
+    QFETCH(float, value);
+    QFETCH(QByteArray, expected);
+    QByteArray buffer;
+    MeasurementFormatter::appendNdjson(buffer, context, lead, value);
+    QCOMPARE(buffer, expected);
+}
+
+void TestMeasurementFormatter::appendLineProtocol_data()
+{
+    QTest::addColumn<float>("value");
+    QTest::addColumn<qint64>("timestamp");
+    QTest::addColumn<bool>("expectedResult");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("value")    << 1.5f     << (qint64)1700000000123456789 << true
+        << QByteArray("existing\ndso,unit=Vdc value=1.5 1700000000123456789\n");
+    QTest::addRow("negative") << -0.125f  << (qint64)0                   << true
+        << QByteArray("existing\ndso,unit=Vdc value=-0.125 0\n");
+    QTest::addRow("small")    << 1e-05f   << (qint64)1                   << true
+        << QByteArray("existing\ndso,unit=Vdc value=1e-05 1\n");
+    QTest::addRow("inf")      << std::numeric_limits<float>::infinity()  << (qint64)1 << false
+        << QByteArray("existing\n");
+    QTest::addRow("nan")      << std::numeric_limits<float>::quiet_NaN() << (qint64)1 << false
+        << QByteArray("existing\n");
+}
+
+void TestMeasurementFormatter::appendLineProtocol()
+{
+    QFETCH(float, value);
+    QFETCH(qint64, timestamp);
+    QFETCH(bool, expectedResult);
+    QFETCH(QByteArray, expected);
+    MeasurementFormatter::Context context = dsoContext();
+    context.lineProtocol = "dso,unit=Vdc value=";
+    QByteArray buffer("existing\n");
+    QCOMPARE(MeasurementFormatter::appendLineProtocol(buffer, context, value, timestamp), expectedResult);
+    QCOMPARE(buffer, expected);
+}
+
+void TestMeasurementFormatter::allocations()
+{
+    if (!AllocationCounter::isSupported()) {
+        QSKIP("Allocation counting is not supported by this build");
+    }
+    #if !defined(__cpp_lib_to_chars) || (__cpp_lib_to_chars < 201611L)
+    QSKIP("Floating point formatting falls back to QByteArray::number(), which allocates");
+    #endif
+
+    // At steady state (contexts resolved, and the output buffer grown), formatting should not allocate at all.
+    MeasurementFormatter formatter([](const quint8, const quint8, const quint8) { return dsoContext(); });
+    const QByteArray lead("2025-01-02T03:04:05.678");
+    QByteArray buffer;
+    buffer.reserve(16384); // Comfortably more than the ~5KiB formatted below.
+    QCOMPARE(AllocationCounter::measure([&]{
+        buffer.truncate(0); // Retains the reserved capacity, unlike clear().
+        for (qint64 index = 0; index < 50; ++index) {
+            const MeasurementFormatter::Context &context = formatter.context(1, 2);
+            MeasurementFormatter::appendCsv(buffer, context, index, -1.25f * (float)index);
+            MeasurementFormatter::appendCsv(buffer, context, lead, 0.1f);
+            MeasurementFormatter::appendNdjson(buffer, context, lead, 1e-05f);
+        }
+    }), (quint64)0);
+    QVERIFY(buffer.endsWith("1e-05,\"unit\":\"Vdc\"}\n"));
+    QCOMPARE(formatter.size(), 1);
+}
+
+void TestMeasurementFormatter::formatText_data()
+{
+    QTest::addColumn<MeasurementFormatter::Context>("context");
+    QTest::addColumn<QString>("lead");
+    QTest::addColumn<float>("value");
+    QTest::addColumn<QString>("expected");
+
+    QTest::addRow("dso")
+        << dsoContext() << u"123"_s << 1.5f << u"123 1.5 Vdc\n"_s;
+    QTest::addRow("meter")
+        << meterContext() << QString() << 1.5f << u"Mode: Resistance\nValue: 1.500000 Ω\nRange: 1K\n"_s;
+}
+
+void TestMeasurementFormatter::formatText()
+{
+    QFETCH(MeasurementFormatter::Context, context);
+    QFETCH(QString, lead);
+    QFETCH(float, value);
+    QFETCH(QString, expected);
+    QCOMPARE(MeasurementFormatter::formatText(context, lead, value), expected);
+}
+
+void TestMeasurementFormatter::appendCsvCount()
+{
+    QByteArray buffer("existing\n");
+    MeasurementFormatter::appendCsvCount(buffer, rawLoggerContext(), QByteArray("2025-01-02T03:04:05.678Z"), 123);
+    MeasurementFormatter::appendCsvCount(buffer, rawLoggerContext(), (qint64)1234567, -32768);
+    MeasurementFormatter::appendCsvCount(buffer, dsoContext(), (qint64)2, 32767);
+    QCOMPARE(buffer, QByteArray("existing\n2025-01-02T03:04:05.678Z,123\n1234567,-32768\n2,32767,Vdc,30V\n"));
+}
+
+void TestMeasurementFormatter::appendNdjsonCount()
+{
+    QByteArray buffer;
+    MeasurementFormatter::appendNdjsonCount(buffer, rawLoggerContext(), QByteArray("1700000000123"), -5);
+    MeasurementFormatter::appendNdjsonCount(buffer, rawLoggerContext(), QByteArray("\"2025-01-02T03:04:05.678Z\""), 0);
+    QCOMPARE(buffer, QByteArray(R"({"timestamp":1700000000123,"count":-5})" "\n"
+                                R"({"timestamp":"2025-01-02T03:04:05.678Z","count":0})" "\n"));
+}
+
+void TestMeasurementFormatter::formatTextCount()
+{
+    QCOMPARE(MeasurementFormatter::formatTextCount(rawLoggerContext(), u"123"_s, -42), u"123 -42\n"_s);
+    QCOMPARE(MeasurementFormatter::formatTextCount(meterContext(), QString(), 7),
+             u"Mode: Resistance\nValue: 7 Ω\nRange: 1K\n"_s);
+}
+
+QTEST_MAIN(TestMeasurementFormatter)
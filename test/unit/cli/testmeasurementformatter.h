@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestMeasurementFormatter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void context();
+    void clear();
+
+    void appendCsv_data();
+    void appendCsv();
+    void appendCsv_integerLead();
+
+    void appendNdjson_data();
+    void appendNdjson();
+
+    void appendLineProtocol_data();
+    void appendLineProtocol();
+
+    void allocations();
+
+    void formatText_data();
+    void formatText();
+
+    void appendCsvCount();
+    void appendNdjsonCount();
+    void formatTextCount();
+};
@@ -9,10 +9,17 @@
 
 #include "metercommand.h"
 
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QtEndian>
+#include <QTemporaryDir>
+#include <QUuid>
+
 #include <qtpokit/pokitmeter.h>
 #include <qtpokit/pokitpro.h>
 
 Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
+Q_DECLARE_METATYPE(MeterAggregator::Window)
 Q_DECLARE_METATYPE(MultimeterService::Mode)
 Q_DECLARE_METATYPE(MultimeterService::Reading)
 Q_DECLARE_METATYPE(MultimeterService::Settings)
@@ -52,7 +59,10 @@ void TestMeterCommand::supportedOptions()
     MockDeviceCommand mock;
     QCommandLineParser parser;
     const QStringList expected = command.requiredOptions(parser) + mock.supportedOptions(parser) +
-        QStringList{ u"interval"_s, u"range"_s, u"samples"_s };
+        QStringList{ u"aggregate"_s, u"aggregate-step"_s, u"battery-saver"_s, u"burst"_s, u"charge"_s,
+                     u"charge-gap"_s, u"deadband"_s, u"dwell"_s, u"event"_s, u"heartbeat"_s, u"influx"_s,
+                     u"interval"_s, u"mqtt"_s, u"pipeline"_s, u"range"_s, u"samples"_s, u"settle"_s,
+                     u"shared-memory"_s, u"sqlite"_s, u"watchdog"_s };
     QCOMPARE(command.supportedOptions(parser), expected);
 }
 
@@ -333,6 +343,591 @@ void TestMeterCommand::processOptions()
     QCOMPARE(command.rangeOptionValue,        expectedRangeOptionValue);
 }
 
+void TestMeterCommand::processOptions_aggregate_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<quint32>("expectedPeriod");
+    QTest::addColumn<quint32>("expectedStep");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none")
+        << QStringList{ } << 0u << 0u << QStringList{ };
+
+    QTest::addRow("fixed")
+        << QStringList{ u"--aggregate"_s, u"60s"_s } << 60000u << 0u << QStringList{ };
+
+    QTest::addRow("sliding")
+        << QStringList{ u"--aggregate"_s, u"10s"_s, u"--aggregate-step"_s, u"1000"_s }
+        << 10000u << 1000u << QStringList{ };
+
+    QTest::addRow("invalid-period")
+        << QStringList{ u"--aggregate"_s, u"abc"_s } << 0u << 0u
+        << QStringList{ u"Invalid aggregate value: abc"_s };
+
+    QTest::addRow("invalid-step")
+        << QStringList{ u"--aggregate"_s, u"1s"_s, u"--aggregate-step"_s, u"abc"_s } << 1000u << 0u
+        << QStringList{ u"Invalid aggregate-step value: abc"_s };
+
+    QTest::addRow("step-without-period")
+        << QStringList{ u"--aggregate-step"_s, u"1s"_s } << 0u << 1000u
+        << QStringList{ u"The aggregate-step option requires the aggregate option"_s };
+
+    QTest::addRow("binary")
+        << QStringList{ u"--aggregate"_s, u"1s"_s, u"--output"_s, u"binary"_s } << 1000u << 0u
+        << QStringList{ u"Binary output is only supported for raw readings, not --aggregate"_s };
+
+    QTest::addRow("arrow")
+        << QStringList{ u"--aggregate"_s, u"1s"_s, u"--output"_s, u"arrow"_s } << 1000u << 0u
+        << QStringList{ u"Arrow output is only supported for raw readings, not --aggregate"_s };
+
+    QTest::addRow("line-protocol")
+        << QStringList{ u"--aggregate"_s, u"1s"_s, u"--output"_s, u"line-protocol"_s } << 1000u << 0u
+        << QStringList{ u"Line protocol output is only supported for raw readings, not --aggregate"_s };
+}
+
+void TestMeterCommand::processOptions_aggregate()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(quint32, expectedPeriod);
+    QFETCH(quint32, expectedStep);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"Vdc"_s);
+    arguments.prepend(u"--mode"_s);
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"aggregate"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"aggregate-step"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+    parser.process(arguments);
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.aggregatePeriod,        expectedPeriod);
+    QCOMPARE(command.aggregateStep,          expectedStep);
+}
+
+void TestMeterCommand::processOptions_deadband_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<bool>("expectDeadband");
+    QTest::addColumn<float>("expectedAbsolute");
+    QTest::addColumn<float>("expectedRelative");
+    QTest::addColumn<quint32>("expectedHeartbeat");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none")
+        << QStringList{ } << false << 0.0f << 0.0f << 0u << QStringList{ };
+
+    QTest::addRow("absolute")
+        << QStringList{ u"--deadband"_s, u"0.5"_s } << true << 0.5f << 0.0f << 0u << QStringList{ };
+
+    QTest::addRow("relative")
+        << QStringList{ u"--deadband"_s, u"25%"_s } << true << 0.0f << 0.25f << 0u << QStringList{ };
+
+    QTest::addRow("both")
+        << QStringList{ u"--deadband"_s, u"0.5, 25%"_s } << true << 0.5f << 0.25f << 0u << QStringList{ };
+
+    QTest::addRow("heartbeat")
+        << QStringList{ u"--heartbeat"_s, u"60s"_s } << true << 0.0f << 0.0f << 60000u << QStringList{ };
+
+    QTest::addRow("deadband-and-heartbeat")
+        << QStringList{ u"--deadband"_s, u"0.5"_s, u"--heartbeat"_s, u"1000"_s }
+        << true << 0.5f << 0.0f << 1000u << QStringList{ };
+
+    QTest::addRow("invalid-deadband")
+        << QStringList{ u"--deadband"_s, u"abc"_s } << true << 0.0f << 0.0f << 0u
+        << QStringList{ u"Invalid deadband value: abc"_s };
+
+    QTest::addRow("invalid-heartbeat")
+        << QStringList{ u"--heartbeat"_s, u"abc"_s } << true << 0.0f << 0.0f << 0u
+        << QStringList{ u"Invalid heartbeat value: abc"_s };
+
+    QTest::addRow("aggregate")
+        << QStringList{ u"--deadband"_s, u"0.5"_s, u"--aggregate"_s, u"1s"_s } << true << 0.5f << 0.0f << 0u
+        << QStringList{ u"The deadband and heartbeat options cannot be combined with the aggregate option"_s };
+}
+
+void TestMeterCommand::processOptions_deadband()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(bool, expectDeadband);
+    QFETCH(float, expectedAbsolute);
+    QFETCH(float, expectedRelative);
+    QFETCH(quint32, expectedHeartbeat);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"Vdc"_s);
+    arguments.prepend(u"--mode"_s);
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"aggregate"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"deadband"_s, u"description"_s, u"tolerance"_s});
+    parser.addOption({u"heartbeat"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.process(arguments);
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.deadband != nullptr, expectDeadband);
+    if (command.deadband) {
+        QCOMPARE(command.deadband->absoluteDeadband(), expectedAbsolute);
+        QCOMPARE(command.deadband->relativeDeadband(), expectedRelative);
+        QCOMPARE(command.deadband->heartbeat(),        expectedHeartbeat);
+    }
+}
+
+void TestMeterCommand::processOptions_settle_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<quint32>("expectedSettleTime");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none")
+        << QStringList{ } << 0u << QStringList{ };
+
+    QTest::addRow("milliseconds")
+        << QStringList{ u"--settle"_s, u"300"_s } << 300u << QStringList{ };
+
+    QTest::addRow("seconds")
+        << QStringList{ u"--settle"_s, u"2s"_s } << 2000u << QStringList{ };
+
+    QTest::addRow("invalid")
+        << QStringList{ u"--settle"_s, u"abc"_s } << 0u
+        << QStringList{ u"Invalid settle value: abc"_s };
+}
+
+void TestMeterCommand::processOptions_settle()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(quint32, expectedSettleTime);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"Vdc"_s);
+    arguments.prepend(u"--mode"_s);
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"settle"_s, u"description"_s, u"period"_s});
+    parser.process(arguments);
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.settler != nullptr, expectedSettleTime > 0);
+    if (command.settler) {
+        QCOMPARE(command.settler->defaultSettleTime(), expectedSettleTime);
+    }
+}
+
+void TestMeterCommand::processOptions_event_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<int>("expectedDetectors");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none")
+        << QStringList{ } << 0 << QStringList{ };
+
+    QTest::addRow("single")
+        << QStringList{ u"--event"_s, u"above:12:0.5:1s"_s } << 1 << QStringList{ };
+
+    QTest::addRow("multiple")
+        << QStringList{ u"--event"_s, u"above:12"_s, u"--event"_s, u"rate-above:5"_s } << 2 << QStringList{ };
+
+    QTest::addRow("invalid")
+        << QStringList{ u"--event"_s, u"over:12"_s } << 0 << QStringList{ u"Invalid event: over:12"_s };
+
+    QTest::addRow("aggregate")
+        << QStringList{ u"--event"_s, u"above:12"_s, u"--aggregate"_s, u"1s"_s } << 1
+        << QStringList{ u"The event option cannot be combined with the aggregate, deadband or heartbeat options"_s };
+
+    QTest::addRow("schedule")
+        << QStringList{ u"--event"_s, u"above:12"_s, u"--mode"_s, u"Vdc,Adc"_s } << 1
+        << QStringList{ u"The event option is only supported for a single mode"_s };
+
+    QTest::addRow("binary")
+        << QStringList{ u"--event"_s, u"above:12"_s, u"--output"_s, u"binary"_s } << 1
+        << QStringList{ u"Binary output is only supported for raw values, not --event"_s };
+}
+
+void TestMeterCommand::processOptions_event()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(int, expectedDetectors);
+    QFETCH(QStringList, expectedErrors);
+
+    if (!arguments.contains(u"--mode"_s)) {
+        arguments.prepend(u"Vdc"_s);
+        arguments.prepend(u"--mode"_s);
+    }
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"aggregate"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"event"_s, u"description"_s, u"spec"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+    parser.process(arguments);
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.eventDetectors.size(), expectedDetectors);
+    if (expectedDetectors > 0) {
+        QCOMPARE(command.eventUnit, u"Vdc"_s);
+    }
+}
+
+void TestMeterCommand::processOptions_charge_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<quint32>("expectedMaximumGap");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none")
+        << QStringList{ u"--mode"_s, u"Adc"_s } << 0u << QStringList{ };
+
+    QTest::addRow("default")
+        << QStringList{ u"--mode"_s, u"Adc"_s, u"--charge"_s, u"60s"_s } << 3000u << QStringList{ };
+
+    QTest::addRow("interval")
+        << QStringList{ u"--mode"_s, u"Adc"_s, u"--charge"_s, u"60s"_s, u"--interval"_s, u"2s"_s }
+        << 6000u << QStringList{ };
+
+    QTest::addRow("gap")
+        << QStringList{ u"--mode"_s, u"Adc"_s, u"--charge"_s, u"60s"_s, u"--charge-gap"_s, u"hold:10s"_s }
+        << 10000u << QStringList{ };
+
+    QTest::addRow("voltage")
+        << QStringList{ u"--mode"_s, u"Vdc"_s, u"--charge"_s, u"60s"_s } << 3000u
+        << QStringList{ u"The charge option requires the (single) DC current mode"_s };
+
+    QTest::addRow("aggregate")
+        << QStringList{ u"--mode"_s, u"Adc"_s, u"--charge"_s, u"60s"_s, u"--aggregate"_s, u"1s"_s } << 3000u
+        << QStringList{
+            u"The charge option cannot be combined with the aggregate, deadband, event or heartbeat options"_s };
+
+    QTest::addRow("chargeGap")
+        << QStringList{ u"--mode"_s, u"Adc"_s, u"--charge-gap"_s, u"hold"_s } << 0u
+        << QStringList{ u"The charge-gap option requires the charge option"_s };
+}
+
+void TestMeterCommand::processOptions_charge()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(quint32, expectedMaximumGap);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"aggregate"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"charge"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"charge-gap"_s, u"description"_s, u"policy"_s});
+    parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.process(arguments);
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.chargeIntegrator != nullptr, arguments.contains(u"--charge"_s));
+    if (command.chargeIntegrator) {
+        QCOMPARE(command.chargeIntegrator->period(), 60000u);
+        QCOMPARE(command.chargeIntegrator->maximumGap(), expectedMaximumGap);
+    }
+}
+
+void TestMeterCommand::processOptions_batterySaver_data()
+{
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<quint32>("expectedInterval");
+    QTest::addColumn<float>("expectedConserveVoltage");
+    QTest::addColumn<float>("expectedCriticalVoltage");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("interval")
+        << u"60s"_s << 60000u << 3.5f << 3.3f << QStringList{ };
+
+    QTest::addRow("conserve")
+        << u"60s,3.6V"_s << 60000u << 3.6f << 3.3f << QStringList{ };
+
+    QTest::addRow("critical")
+        << u"60s,3.7,3.45v"_s << 60000u << 3.7f << 3.45f << QStringList{ };
+
+    QTest::addRow("zero")
+        << u"0"_s << 0u << 3.5f << 3.3f << QStringList{ u"Invalid battery-saver value: 0"_s };
+
+    QTest::addRow("voltage")
+        << u"60s,abc"_s << 60000u << 3.5f << 3.3f << QStringList{ u"Invalid battery-saver value: 60s,abc"_s };
+
+    QTest::addRow("negative")
+        << u"60s,-3.6"_s << 60000u << 3.5f << 3.3f << QStringList{ u"Invalid battery-saver value: 60s,-3.6"_s };
+
+    QTest::addRow("extra")
+        << u"60s,3.6,3.4,3.2"_s << 60000u << 3.5f << 3.3f
+        << QStringList{ u"Invalid battery-saver value: 60s,3.6,3.4,3.2"_s };
+
+    QTest::addRow("inverted")
+        << u"60s,3.3,3.5"_s << 60000u << 3.3f << 3.5f
+        << QStringList{ u"The battery-saver critical voltage must be less than its conserve voltage"_s };
+
+    QTest::addRow("short")
+        << u"500ms"_s << 500u << 3.5f << 3.3f
+        << QStringList{ u"The battery-saver interval must be longer than the meter interval"_s };
+}
+
+void TestMeterCommand::processOptions_batterySaver()
+{
+    QFETCH(QString, value);
+    QFETCH(quint32, expectedInterval);
+    QFETCH(float, expectedConserveVoltage);
+    QFETCH(float, expectedCriticalVoltage);
+    QFETCH(QStringList, expectedErrors);
+
+    QCommandLineParser parser;
+    parser.addOption({u"battery-saver"_s, u"description"_s, u"max"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--battery-saver"_s, value });
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.batterySaverInterval, expectedInterval);
+    QCOMPARE(command.conserveVoltage, expectedConserveVoltage);
+    QCOMPARE(command.criticalVoltage, expectedCriticalVoltage);
+    QVERIFY(!command.batteryPolicy); // Not created until the device's services are known.
+}
+
+void TestMeterCommand::processOptions_burst_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<int>("expectedCount");
+    QTest::addColumn<quint32>("expectedInterval");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("default-interval")
+        << QStringList{ u"--burst"_s, u"1000"_s } << 1000 << 10u << QStringList{ };
+
+    QTest::addRow("explicit-interval")
+        << QStringList{ u"--burst"_s, u"2000"_s, u"--interval"_s, u"50ms"_s } << 2000 << 50u << QStringList{ };
+
+    QTest::addRow("zero")
+        << QStringList{ u"--burst"_s, u"0"_s } << 0 << 10u << QStringList{ u"Invalid burst value: 0"_s };
+
+    QTest::addRow("invalid")
+        << QStringList{ u"--burst"_s, u"abc"_s } << 0 << 10u << QStringList{ u"Invalid burst value: abc"_s };
+
+    QTest::addRow("samples")
+        << QStringList{ u"--burst"_s, u"100"_s, u"--samples"_s, u"10"_s } << 100 << 10u
+        << QStringList{ u"The burst option cannot be combined with the aggregate, battery-saver, charge, deadband, "
+                        "event, heartbeat, samples, settle or watchdog options"_s };
+
+    QTest::addRow("ndjson")
+        << QStringList{ u"--burst"_s, u"100"_s, u"--output"_s, u"ndjson"_s } << 100 << 10u
+        << QStringList{ u"The burst option only supports CSV, JSON and Text output"_s };
+}
+
+void TestMeterCommand::processOptions_burst()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(int, expectedCount);
+    QFETCH(quint32, expectedInterval);
+    QFETCH(QStringList, expectedErrors);
+
+    QCommandLineParser parser;
+    parser.addOption({u"burst"_s, u"description"_s, u"count"_s});
+    parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+    parser.addOption({u"samples"_s, u"description"_s, u"count"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s } + arguments);
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.burstCount, expectedCount);
+    QCOMPARE(command.settings.updateInterval, expectedInterval);
+}
+
+void TestMeterCommand::processOptions_sharedMemory()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const QString key = u"dokit-test-"_s + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    QCommandLineParser parser;
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"shared-memory"_s, u"description"_s, u"key"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--shared-memory"_s, key });
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), QStringList{ });
+    QVERIFY(command.ring);
+    QVERIFY(command.ring->isPublisher());
+    QCOMPARE(command.ring->key(), key);
+
+    // Readings are published, as well as output.
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+    const OutputStreamCapture capture(&std::cout);
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.outputReading({
+        MultimeterService::MeterStatus::AutoRangeOff, 1.0f, MultimeterService::Mode::DcVoltage, 0
+    });
+    QVERIFY(!capture.data().empty());
+    QVector<SharedSampleRing::Record> records;
+    QCOMPARE(reader.read(records), (qsizetype)1);
+    QCOMPARE(records.at(0).value, 1.0f);
+    QVERIFY(records.at(0).kind == SharedSampleRing::Kind::MeterReading);
+}
+
+void TestMeterCommand::processOptions_mqtt()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    QCommandLineParser parser;
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"mqtt"_s, u"description"_s, u"url"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--mqtt"_s, u"mqtt://localhost/test?qos=3"_s });
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser),
+             QStringList{ u"Invalid MQTT URL mqtt://localhost/test?qos=3: Unsupported qos value: 3"_s });
+
+    QCommandLineParser validParser;
+    validParser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    validParser.addOption({u"mqtt"_s, u"description"_s, u"url"_s});
+    validParser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--mqtt"_s, u"mqtt://localhost/test"_s });
+    QCOMPARE(command.processOptions(validParser), QStringList{ });
+    QVERIFY(command.mqtt);
+
+    // Readings are added to the publisher's batch, as well as output.
+    const OutputStreamCapture capture(&std::cout);
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.outputReading({
+        MultimeterService::MeterStatus::AutoRangeOff, 1.0f, MultimeterService::Mode::DcVoltage, 0
+    });
+    QVERIFY(!capture.data().empty());
+    QCOMPARE(command.mqtt->statistics().values, (quint64)1);
+}
+
+void TestMeterCommand::processOptions_sqlite()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+    if (!QSqlDatabase::isDriverAvailable(u"QSQLITE"_s)) {
+        QSKIP("The Qt SQLite driver is not available");
+    }
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QCommandLineParser parser;
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"sqlite"_s, u"description"_s, u"file"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--mode"_s, u"Vdc"_s, u"--sqlite"_s, dir.filePath(u"meter.db"_s) });
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), QStringList{ });
+    QVERIFY(command.sqlite);
+    QVERIFY(command.sqlite->isOpen());
+
+    // Readings are stored, one transaction each, as well as output; error readings are not stored.
+    const OutputStreamCapture capture(&std::cout);
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.outputReading({
+        MultimeterService::MeterStatus::AutoRangeOff, 1.0f, MultimeterService::Mode::DcVoltage, 0
+    });
+    command.outputReading({
+        MultimeterService::MeterStatus::AutoRangeOff, 2.0f, MultimeterService::Mode::DcVoltage, 0
+    });
+    command.outputReading({
+        MultimeterService::MeterStatus::Error, 3.0f, MultimeterService::Mode::DcVoltage, 0
+    });
+    QVERIFY(!capture.data().empty());
+    QCOMPARE(command.sqlite->statistics().samples, (quint64)2);
+    QCOMPARE(command.sqlite->statistics().transactions, (quint64)2);
+    QCOMPARE(command.sqlite->statistics().sessions, (quint64)1);
+
+    // A range change begins a new session.
+    command.outputReading({
+        MultimeterService::MeterStatus::AutoRangeOff, 4.0f, MultimeterService::Mode::DcVoltage, 1
+    });
+    QCOMPARE(command.sqlite->statistics().sessions, (quint64)2);
+}
+
+void TestMeterCommand::processOptions_schedule_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QList<int>>("expectedModes");
+    QTest::addColumn<QList<int>>("expectedRanges");
+    QTest::addColumn<quint32>("expectedDwell");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("single")
+        << QStringList{ u"--mode"_s, u"Vdc"_s } << QList<int>{ } << QList<int>{ } << 10000u << QStringList{ };
+
+    QTest::addRow("multiple")
+        << QStringList{ u"--mode"_s, u"Vdc,Adc"_s }
+        << QList<int>{ 1, 3 } << QList<int>{ 255, 255 } << 10000u << QStringList{ };
+
+    QTest::addRow("rangeless")
+        << QStringList{ u"--mode"_s, u"Resistance, Diode, Temp"_s, u"--dwell"_s, u"30s"_s }
+        << QList<int>{ 5, 6, 8 } << QList<int>{ 255, 0, 0 } << 30000u << QStringList{ };
+
+    QTest::addRow("invalid-mode")
+        << QStringList{ u"--mode"_s, u"Vdc,invalid"_s } << QList<int>{ 1 } << QList<int>{ 255 } << 10000u
+        << QStringList{ u"Unknown meter mode: invalid"_s };
+
+    QTest::addRow("invalid-dwell")
+        << QStringList{ u"--mode"_s, u"Vdc,Adc"_s, u"--dwell"_s, u"abc"_s }
+        << QList<int>{ 1, 3 } << QList<int>{ 255, 255 } << 10000u << QStringList{ u"Invalid dwell value: abc"_s };
+
+    QTest::addRow("dwell-without-schedule")
+        << QStringList{ u"--mode"_s, u"Vdc"_s, u"--dwell"_s, u"1s"_s } << QList<int>{ } << QList<int>{ } << 10000u
+        << QStringList{ u"The dwell option requires multiple modes"_s };
+
+    QTest::addRow("range")
+        << QStringList{ u"--mode"_s, u"Vdc,Adc"_s, u"--range"_s, u"2V"_s }
+        << QList<int>{ 1, 3 } << QList<int>{ 255, 255 } << 10000u
+        << QStringList{ u"The range option is only supported for a single mode"_s };
+}
+
+void TestMeterCommand::processOptions_schedule()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QList<int>, expectedModes);
+    QFETCH(QList<int>, expectedRanges);
+    QFETCH(quint32, expectedDwell);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"dwell"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+    parser.process(arguments);
+
+    MeterCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE(command.dwellTime, expectedDwell);
+    QList<int> modes, ranges;
+    for (const MeterScheduler::Entry &entry: command.schedule) {
+        modes.append((int)entry.mode);
+        ranges.append(entry.range);
+        QCOMPARE(entry.dwell, expectedDwell);
+    }
+    QCOMPARE(modes, expectedModes);
+    QCOMPARE(ranges, expectedRanges);
+}
+
 void TestMeterCommand::getService()
 {
     // Unable to safely invoke MeterCommand::getService() without a valid Bluetooth device.
@@ -348,6 +943,14 @@ void TestMeterCommand::settingsWritten()
     // Unable to safely invoke MeterCommand::settingsWritten() without a valid Bluetooth service.
 }
 
+void TestMeterCommand::entryStarted()
+{
+    // Just logs the switch latency.
+    MeterCommand command;
+    command.schedule = { { MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::AutoRange, 1000 } };
+    command.entryStarted(0, 123);
+}
+
 void TestMeterCommand::outputReading_data()
 {
     if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
@@ -429,6 +1032,370 @@ void TestMeterCommand::outputReading()
     QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
 }
 
+void TestMeterCommand::outputReading_arrow()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Arrow;
+    const qint64 before = QDateTime::currentMSecsSinceEpoch() * 1000;
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOn, 1.5f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V });
+    const qint64 after = QDateTime::currentMSecsSinceEpoch() * 1000;
+
+    // The reading's timestamp is the first of the 32-byte body's four 8-byte (padded) columns.
+    const QByteArray output = QByteArray::fromStdString(capture.data());
+    QVERIFY(output.size() > 32);
+    const qint64 timestamp = qFromLittleEndian<qint64>(output.constData() + output.size() - 32);
+    QVERIFY((timestamp >= before) && (timestamp <= after));
+    QByteArray expected;
+    AbstractCommand::writeArrowSchema(expected);
+    AbstractCommand::writeArrowRecordBatch(expected, { timestamp }, { 1.5f }, 1, 1);
+    QCOMPARE(output, expected);
+}
+
+void TestMeterCommand::outputReading_lineProtocol()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::LineProtocol;
+    const qint64 before = QDateTime::currentMSecsSinceEpoch() * 1'000'000;
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOn, 1.5f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V });
+    const qint64 after = QDateTime::currentMSecsSinceEpoch() * 1'000'000;
+
+    // The reading's (nanosecond) timestamp follows the value, so verify its range, then compare the rest.
+    const QByteArray output = QByteArray::fromStdString(capture.data());
+    const QByteArray prefix(R"(meter,mode=DC\ voltage,range=Up\ to\ 2V,status=Auto\ Range\ On,unit=Vdc value=1.5 )");
+    QVERIFY(output.startsWith(prefix));
+    QVERIFY(output.endsWith('\n'));
+    bool ok = false;
+    const qint64 timestamp = output.mid(prefix.size(), output.size() - prefix.size() - 1).toLongLong(&ok);
+    QVERIFY(ok);
+    QVERIFY((timestamp >= before) && (timestamp <= after));
+}
+
+void TestMeterCommand::outputReading_binary()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Binary;
+    command.samplesToGo = 2;
+    const quint64 before = (quint64)QDateTime::currentMSecsSinceEpoch();
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOn, 1.5f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V });
+    const quint64 after = (quint64)QDateTime::currentMSecsSinceEpoch();
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOff, -0.25f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_6V });
+
+    // The header's timestamp is the (current) time of the first reading, so verify its range, then compare the rest.
+    QByteArray output = QByteArray::fromStdString(capture.data());
+    QCOMPARE(output.size(), 32 + 16);
+    const quint64 timestamp = qFromLittleEndian<quint64>(output.constData() + 16);
+    QVERIFY((timestamp >= before) && (timestamp <= after));
+    output.replace(16, 8, QByteArray(8, '\0'));
+    QCOMPARE(output, QByteArray::fromHex(
+        "444f4b42" "01" "03" "01" "ff" "0000803f" "e8030000" "0000000000000000" "02000000" "08000000"
+        "0000c03f" "01" "01" "01" "00"
+        "000080be" "00" "01" "02" "00"));
+}
+
+void TestMeterCommand::outputReading_ndjson()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOn, 1.5f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V });
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOff, -0.25f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_6V });
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"status":"Auto Range On","value":1.5,"mode":"DC voltage","unit":"Vdc","range":"Up to 2V"})" "\n"
+        R"({"status":"Auto Range Off","value":-0.25,"mode":"DC voltage","unit":"Vdc","range":"Up to 6V"})" "\n"));
+}
+
+void TestMeterCommand::outputReading_aggregate()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.samplesToGo = 2;
+    command.aggregator = new MeterAggregator(nullptr, &command);
+    QObject::connect(command.aggregator, &MeterAggregator::windowReady, &command, &MeterCommand::outputWindow);
+
+    // Readings are aggregated (here, manually) rather than output individually.
+    const MultimeterService::Reading reading{ MultimeterService::MeterStatus::AutoRangeOff, 1.5f,
+                                              MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V };
+    command.aggregator->addReading(reading, 1700000000100);
+    command.outputReading(reading);
+    QCOMPARE(command.samplesToGo, 1);
+    QVERIFY(capture.data().empty());
+
+    // Until the last requested reading, which flushes the aggregated window.
+    command.aggregator->addReading(reading, 1700000000200);
+    command.outputReading(reading);
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"count":2,"end":"2023-11-14T22:13:21.000Z","maximum":1.5,"mean":1.5,"minimum":1.5,"mode":"DC voltage",)"
+        R"("range":"Up to 2V","start":"2023-11-14T22:13:20.000Z","status":"Auto Range Off","unit":"Vdc"})" "\n"));
+}
+
+void TestMeterCommand::outputReading_deadband()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.samplesToGo = 4;
+    command.deadband = new MeterDeadband(nullptr, &command);
+    command.deadband->setAbsoluteDeadband(0.5f);
+
+    // Readings within the deadband of the last output reading are counted, but not output.
+    for (const float value: { 1.5f, 1.75f, 1.25f, 2.5f }) {
+        command.outputReading({ MultimeterService::MeterStatus::AutoRangeOff, value,
+                                MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V });
+    }
+    QCOMPARE(command.samplesToGo, 0);
+    QCOMPARE(command.deadband->acceptedCount(), (quint64)2);
+    QCOMPARE(command.deadband->suppressedCount(), (quint64)2);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"status":"Auto Range Off","value":1.5,"mode":"DC voltage","unit":"Vdc","range":"Up to 2V"})" "\n"
+        R"({"status":"Auto Range Off","value":2.5,"mode":"DC voltage","unit":"Vdc","range":"Up to 2V"})" "\n"));
+}
+
+void TestMeterCommand::outputReading_settle()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.samplesToGo = 2;
+    command.settler = new MeterSettler(nullptr, &command);
+    command.settler->setDefaultSettleTime(60000); // Long enough that this test never settles.
+
+    // Readings after a range change are discarded, without being counted.
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOn, 1.5f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V });
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOn, 3.5f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_6V });
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOn, 4.5f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_6V });
+    QCOMPARE(command.samplesToGo, 1);
+    QCOMPARE(command.settler->unsettledCount(), (quint64)2);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"status":"Auto Range On","value":1.5,"mode":"DC voltage","unit":"Vdc","range":"Up to 2V"})" "\n"));
+}
+
+void TestMeterCommand::outputReading_event()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.samplesToGo = 4;
+    command.eventUnit = u"Vdc"_s;
+    QCOMPARE(command.addEventDetectors({ u"above:2"_s }), QStringList{});
+
+    // Readings are only added to the event detector, which outputs the event once it has ended.
+    for (const float value: { 1.5f, 2.5f, 3.5f }) {
+        command.outputReading({ MultimeterService::MeterStatus::AutoRangeOff, value,
+                                MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_6V });
+    }
+    QCOMPARE(command.samplesToGo, 1);
+    QVERIFY(command.eventDetectors.at(0)->isActive());
+    QVERIFY(capture.data().empty());
+
+    // Including when flushed by the last requested reading.
+    command.outputReading({ MultimeterService::MeterStatus::AutoRangeOff, 3.0f,
+                            MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_6V });
+    QCOMPARE(command.samplesToGo, 0);
+    QVERIFY(!command.eventDetectors.at(0)->isActive());
+    const QByteArray output = QByteArray::fromStdString(capture.data());
+    QVERIFY2(output.startsWith(R"({"condition":"above:2","count":3,"duration":)"), output.constData());
+    QVERIFY2(output.contains(R"("peak":3.5,"start":")"), output.constData()); // Timestamps vary.
+    QVERIFY2(output.endsWith(R"(","unit":"Vdc"})" "\n"), output.constData());
+}
+
+void TestMeterCommand::outputWindow_data()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    QTest::addColumn<MeterAggregator::Window>("window");
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    const QList<QPair<QString, MeterAggregator::Window>> windows{
+        { u"fixed"_s, { 1700000000000, 1700000001000, 3, -0.5f, 1.25f, 0.375f,
+                         MultimeterService::MeterStatus::AutoRangeOff, MultimeterService::Mode::DcVoltage,
+                         +PokitMeter::VoltageRange::_2V } },
+        { u"error"_s, { 1700000000000, 1700000001000, 2, nan, nan, nan,
+                         MultimeterService::MeterStatus::Error, MultimeterService::Mode::DcVoltage,
+                         +PokitMeter::VoltageRange::_2V } },
+    };
+    for (const auto &window: windows) {
+        QTest::newRow(qUtf8Printable(window.first + u".csv"_s))
+            << window.second << AbstractCommand::OutputFormat::Csv;
+        QTest::newRow(qUtf8Printable(window.first + u".json"_s))
+            << window.second << AbstractCommand::OutputFormat::Json;
+        QTest::newRow(qUtf8Printable(window.first + u".txt"_s))
+            << window.second << AbstractCommand::OutputFormat::Text;
+    }
+}
+
+void TestMeterCommand::outputWindow()
+{
+    QFETCH(MeterAggregator::Window, window);
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = format;
+    command.outputWindow(window);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestMeterCommand::outputWindow_ndjson()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    command.outputWindow({ 1700000000000, 1700000001000, 2, nan, nan, nan, MultimeterService::MeterStatus::Error,
+                           MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V });
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"count":2,"end":"2023-11-14T22:13:21.000Z","mode":"DC voltage","range":"Up to 2V",)"
+        R"("start":"2023-11-14T22:13:20.000Z","status":"Error","unit":"Vdc"})" "\n"));
+}
+
+void TestMeterCommand::summariseBurst()
+{
+    const QVector<MultimeterService::TimedReading> readings{
+        { 1'000'000'000, { MultimeterService::MeterStatus::AutoRangeOff, 1.0f, MultimeterService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V } },
+        { 1'010'000'000, { MultimeterService::MeterStatus::AutoRangeOff, 1.5f, MultimeterService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V } },
+        { 1'021'000'000, { MultimeterService::MeterStatus::Error, 0.0f, MultimeterService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V } },
+    };
+    const MeterCommand::BurstSummary summary = MeterCommand::summariseBurst(readings);
+    QCOMPARE(summary.count, 3);
+    QCOMPARE(summary.errors, 1);
+    QCOMPARE(summary.duration, 21.0);
+    QCOMPARE(summary.meanInterval, 10.5);
+    QCOMPARE(summary.intervalJitter, 0.5);
+    QCOMPARE(summary.maxInterval, 11.0);
+    QCOMPARE(summary.minimum, 1.0);
+    QCOMPARE(summary.maximum, 1.5);
+    QCOMPARE(summary.mean, 1.25);
+    QCOMPARE(summary.stddev, 0.25);
+
+    // Histories give the same summary, regardless of how their readings are chunked.
+    const MeterCommand::BurstSummary chunked = MeterCommand::summariseBurst(MeterHistory::fromVector(readings, 2));
+    QCOMPARE(chunked.count, summary.count);
+    QCOMPARE(chunked.errors, summary.errors);
+    QCOMPARE(chunked.duration, summary.duration);
+    QCOMPARE(chunked.intervalJitter, summary.intervalJitter);
+    QCOMPARE(chunked.maxInterval, summary.maxInterval);
+    QCOMPARE(chunked.mean, summary.mean);
+    QCOMPARE(chunked.stddev, summary.stddev);
+
+    // An empty burst has no timing or values to summarise.
+    const MeterCommand::BurstSummary empty = MeterCommand::summariseBurst(QVector<MultimeterService::TimedReading>{ });
+    QCOMPARE(empty.count, 0);
+    QCOMPARE(empty.errors, 0);
+    QCOMPARE(empty.duration, 0.0);
+    QVERIFY(qIsNaN(empty.meanInterval));
+    QVERIFY(qIsNaN(empty.mean));
+}
+
+void TestMeterCommand::outputBurst_data()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::newRow("burst.csv")  << AbstractCommand::OutputFormat::Csv;
+    QTest::newRow("burst.json") << AbstractCommand::OutputFormat::Json;
+    QTest::newRow("burst.txt")  << AbstractCommand::OutputFormat::Text;
+}
+
+void TestMeterCommand::outputBurst()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterCommand command;
+    command.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+    command.service->setPokitProduct(PokitProduct::PokitMeter);
+    command.format = format;
+    command.outputBurst({
+        { 1'000'000'000, { MultimeterService::MeterStatus::AutoRangeOff, 1.0f, MultimeterService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V } },
+        { 1'010'000'000, { MultimeterService::MeterStatus::AutoRangeOff, 1.5f, MultimeterService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V } },
+        { 1'021'000'000, { MultimeterService::MeterStatus::Error, 0.0f, MultimeterService::Mode::DcVoltage,
+                           +PokitMeter::VoltageRange::_2V } },
+    });
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
 void TestMeterCommand::tr()
 {
     // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
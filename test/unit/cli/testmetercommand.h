@@ -15,14 +15,62 @@ private slots:
     void processOptions_data();
     void processOptions();
 
+    void processOptions_aggregate_data();
+    void processOptions_aggregate();
+
+    void processOptions_deadband_data();
+    void processOptions_deadband();
+
+    void processOptions_settle_data();
+    void processOptions_settle();
+
+    void processOptions_event_data();
+    void processOptions_event();
+    void processOptions_charge_data();
+    void processOptions_charge();
+    void processOptions_batterySaver_data();
+    void processOptions_batterySaver();
+    void processOptions_burst_data();
+    void processOptions_burst();
+    void processOptions_sharedMemory();
+    void processOptions_mqtt();
+    void processOptions_sqlite();
+
+    void processOptions_schedule_data();
+    void processOptions_schedule();
+
     void getService();
 
     void serviceDetailsDiscovered();
 
     void settingsWritten();
 
+    void entryStarted();
+
     void outputReading_data();
     void outputReading();
 
+    void outputReading_arrow();
+    void outputReading_lineProtocol();
+    void outputReading_binary();
+
+    void outputReading_ndjson();
+
+    void outputReading_aggregate();
+
+    void outputReading_deadband();
+
+    void outputReading_settle();
+    void outputReading_event();
+
+    void outputWindow_data();
+    void outputWindow();
+
+    void outputWindow_ndjson();
+
+    void summariseBurst();
+    void outputBurst_data();
+    void outputBurst();
+
     void tr();
 };
@@ -0,0 +1,540 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testmeterfleetcommand.h"
+#include "outputstreamcapture.h"
+#include "testdata.h"
+#include "../github.h"
+#include "../stringliterals_p.h"
+
+#include "meterfleetcommand.h"
+
+#include <qtpokit/pokitmeter.h>
+
+#include <QDateTime>
+#include <QTemporaryFile>
+#include <QThread>
+
+#include <limits>
+
+Q_DECLARE_METATYPE(AbstractCommand::OutputFormat)
+Q_DECLARE_METATYPE(MultimeterService::Mode)
+
+DOKIT_USE_STRINGLITERALS
+
+void TestMeterFleetCommand::requiredOptions()
+{
+    MeterFleetCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"mode"_s });
+
+    // The power option implies each device's mode.
+    parser.addOption({u"power"_s, u"description"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--power"_s });
+    QCOMPARE(command.requiredOptions(parser), QStringList{});
+}
+
+void TestMeterFleetCommand::supportedOptions()
+{
+    MeterFleetCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"align"_s, u"device-list"_s, u"interval"_s, u"max-connections"_s, u"power"_s, u"range"_s,
+        u"resample"_s, u"resample-method"_s, u"samples"_s, u"time-format"_s, u"workers"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestMeterFleetCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedDevices");
+    QTest::addColumn<MultimeterService::Mode>("expectedMode");
+    QTest::addColumn<quint32>("expectedRangeOptionValue");
+    QTest::addColumn<quint32>("expectedInterval");
+    QTest::addColumn<int>("expectedMaxConnections");
+    QTest::addColumn<qint64>("expectedSamplesToGo");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("list")
+        << QStringList{ u"--device"_s, u"alpha, beta"_s, u"--device"_s, u"gamma"_s, u"--mode"_s, u"Vdc"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s, u"gamma"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{};
+    QTest::addRow("empty")
+        << QStringList{ u"--device"_s, u" , "_s, u"--mode"_s, u"Vdc"_s }
+        << QStringList{ } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{ u"No devices to read"_s };
+    QTest::addRow("options")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"AC current"_s, u"--range"_s, u"500mA"_s,
+                        u"--interval"_s, u"2s"_s, u"--max-connections"_s, u"8"_s, u"--samples"_s, u"10"_s,
+                        u"--align"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::AcCurrent
+        << 500u << 2000u << 8 << (qint64)10 << QStringList{};
+    QTest::addRow("invalid-mode")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"foo"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::Idle
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{ u"Unknown meter mode: foo"_s };
+    QTest::addRow("invalid-connections")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s, u"--max-connections"_s, u"0"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{ u"Invalid max-connections value: 0"_s };
+    QTest::addRow("invalid-range")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"foo"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{ u"Invalid range value: foo"_s };
+    QTest::addRow("invalid-samples")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s, u"--samples"_s, u"0"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{ u"Invalid samples value: 0"_s };
+    QTest::addRow("power")
+        << QStringList{ u"--device"_s, u"alpha,beta"_s, u"--power"_s, u"--interval"_s, u"2s"_s, u"--range"_s,
+                        u"auto"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 2000u << 3 << (qint64)-1 << QStringList{};
+    QTest::addRow("invalid-power")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--power"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"2V"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{
+            u"The power option cannot be combined with the mode option"_s,
+            u"The power option requires exactly two devices: voltage, then current"_s,
+            u"The power option only supports the auto range"_s };
+    QTest::addRow("invalid-resample")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s, u"--resample"_s, u"foo"_s,
+                        u"--resample-method"_s, u"cubic"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{
+            u"Invalid resample value: foo"_s,
+            u"Unknown resample method: cubic"_s };
+    QTest::addRow("invalid-resample-power")
+        << QStringList{ u"--device"_s, u"alpha,beta"_s, u"--power"_s, u"--resample"_s, u"1s"_s }
+        << QStringList{ u"alpha"_s, u"beta"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{
+            u"The resample option cannot be combined with the power option"_s };
+    QTest::addRow("invalid-resample-method")
+        << QStringList{ u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s, u"--resample-method"_s, u"hold"_s }
+        << QStringList{ u"alpha"_s } << MultimeterService::Mode::DcVoltage
+        << 0u << 1000u << 3 << (qint64)-1 << QStringList{
+            u"The resample-method option requires the resample option"_s };
+}
+
+void TestMeterFleetCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedDevices);
+    QFETCH(MultimeterService::Mode, expectedMode);
+    QFETCH(quint32, expectedRangeOptionValue);
+    QFETCH(quint32, expectedInterval);
+    QFETCH(int, expectedMaxConnections);
+    QFETCH(qint64, expectedSamplesToGo);
+    QFETCH(QStringList, expectedErrors);
+
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"align"_s, u"description"_s});
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"device-list"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+    parser.addOption({u"max-connections"_s, u"description"_s, u"count"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"power"_s, u"description"_s});
+    parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+    parser.addOption({u"resample"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"resample-method"_s, u"description"_s, u"method"_s});
+    parser.addOption({u"samples"_s, u"description"_s, u"count"_s});
+    parser.addOption({u"time-format"_s, u"description"_s, u"format"_s});
+    parser.process(arguments);
+
+    MeterFleetCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QVERIFY(!command.resampler); // Only the processOptions_resample() test has valid resample options.
+    QStringList devices;
+    for (const auto &meter: command.meters) {
+        devices.append(meter.deviceName);
+        QCOMPARE(meter.samplesToGo, expectedSamplesToGo);
+    }
+    QCOMPARE(devices, expectedDevices);
+    QCOMPARE(command.devicesToScanFor, expectedDevices);
+    QVERIFY(command.settings.mode == expectedMode);
+    QCOMPARE(command.rangeOptionValue, expectedRangeOptionValue);
+    QCOMPARE(command.settings.updateInterval, expectedInterval);
+    QCOMPARE(command.maxConnections, expectedMaxConnections);
+    QCOMPARE(command.alignTimestamps, arguments.contains(u"--align"_s) || arguments.contains(u"--power"_s));
+    QCOMPARE(command.powerIntegrator != nullptr, arguments.contains(u"--power"_s));
+    if (command.powerIntegrator) {
+        QCOMPARE(command.powerIntegrator->maximumGap(), 3 * expectedInterval);
+    }
+}
+
+void TestMeterFleetCommand::processOptions_deviceList()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("# Bench A\nalpha\nbeta, gamma # Bench B\n\n  alpha  \n");
+    file.close();
+
+    QCommandLineParser parser;
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"device-list"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--device"_s, u"delta"_s, u"--device-list"_s, file.fileName(),
+                                u"--mode"_s, u"Vdc"_s });
+
+    MeterFleetCommand command(this);
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QStringList devices;
+    for (const auto &meter: command.meters) {
+        devices.append(meter.deviceName);
+    }
+    QCOMPARE(devices, (QStringList{ u"delta"_s, u"alpha"_s, u"beta"_s, u"gamma"_s }));
+
+    // A missing device list is an error.
+    QCommandLineParser missingParser;
+    missingParser.addOption({u"device-list"_s, u"description"_s, u"file"_s});
+    missingParser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    missingParser.process(QStringList{ u"dokit"_s, u"--device-list"_s, file.fileName() + u".missing"_s,
+                                       u"--mode"_s, u"Vdc"_s });
+    MeterFleetCommand missing(this);
+    const QStringList errors = missing.processOptions(missingParser);
+    QCOMPARE(errors.size(), 1);
+    QVERIFY(errors.constFirst().startsWith(u"Failed to open device list"_s));
+}
+
+void TestMeterFleetCommand::processOptions_resample()
+{
+    QCommandLineParser parser;
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"resample"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"resample-method"_s, u"description"_s, u"method"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--device"_s, u"alpha,beta,gamma"_s, u"--mode"_s, u"Vdc"_s,
+                                u"--interval"_s, u"2s"_s, u"--resample"_s, u"5s"_s, u"--resample-method"_s,
+                                u" Decimate "_s });
+
+    MeterFleetCommand command(this);
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(command.resampler);
+    QCOMPARE(command.resampler->channelCount(), 3);
+    QCOMPARE(command.resampler->period(), 5000u);
+    QCOMPARE(command.resampler->method(), Resampler::Method::Decimate);
+    QCOMPARE(command.resampler->maximumGap(), 6000u); // Three reading intervals.
+
+    // The method defaults to linear interpolation.
+    QCommandLineParser linearParser;
+    linearParser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    linearParser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    linearParser.addOption({u"resample"_s, u"description"_s, u"period"_s});
+    linearParser.process(QStringList{ u"dokit"_s, u"--device"_s, u"alpha"_s, u"--mode"_s, u"Vdc"_s,
+                                      u"--resample"_s, u"250ms"_s });
+    QCOMPARE(command.processOptions(linearParser), QStringList{});
+    QVERIFY(command.resampler);
+    QCOMPARE(command.resampler->channelCount(), 1);
+    QCOMPARE(command.resampler->period(), 250u);
+    QCOMPARE(command.resampler->method(), Resampler::Method::Linear);
+}
+
+void TestMeterFleetCommand::processOptions_workers_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<int>("expectedThreads"); // -1 for no workers.
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    QTest::addRow("none")    << QStringList{ } << -1 << QStringList{ };
+    QTest::addRow("count")   << QStringList{ u"--workers"_s, u"3"_s } << 3 << QStringList{ };
+    QTest::addRow("auto")    << QStringList{ u"--workers"_s, u" Auto "_s } << QThread::idealThreadCount()
+                             << QStringList{ };
+    QTest::addRow("zero")    << QStringList{ u"--workers"_s, u"0"_s } << QThread::idealThreadCount()
+                             << QStringList{ };
+    QTest::addRow("invalid") << QStringList{ u"--workers"_s, u"foo"_s } << -1
+                             << QStringList{ u"Invalid workers value: foo"_s };
+    QTest::addRow("negative") << QStringList{ u"--workers"_s, u"-2"_s } << -1
+                              << QStringList{ u"Invalid workers value: -2"_s };
+    QTest::addRow("resample") << QStringList{ u"--workers"_s, u"2"_s, u"--resample"_s, u"1s"_s } << -1
+        << QStringList{ u"The workers option cannot be combined with the power or resample options"_s };
+}
+
+void TestMeterFleetCommand::processOptions_workers()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(int, expectedThreads);
+    QFETCH(QStringList, expectedErrors);
+
+    QCommandLineParser parser;
+    parser.addOption({u"device"_s, u"description"_s, u"device"_s});
+    parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+    parser.addOption({u"resample"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"workers"_s, u"description"_s, u"count"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--device"_s, u"alpha,beta"_s, u"--mode"_s, u"Vdc"_s } + arguments);
+
+    MeterFleetCommand command(this);
+    QCOMPARE(command.processOptions(parser), expectedErrors);
+    QCOMPARE((command.workers) ? command.workers->threadCount() : -1, expectedThreads);
+}
+
+void TestMeterFleetCommand::deviceDiscoveryFinished()
+{
+    const OutputStreamCapture capture(&std::cout);
+    MeterFleetCommand command;
+    command.meters.append({ u"alpha"_s });
+    command.meters.append({ u"beta"_s });
+    QTest::ignoreMessage(QtWarningMsg, R"(Failed to find device "alpha".)");
+    QTest::ignoreMessage(QtWarningMsg, R"(Failed to find device "beta".)");
+    command.deviceDiscoveryFinished();
+    QVERIFY(command.discoveryFinished);
+    for (const auto &meter: command.meters) {
+        QVERIFY(meter.finished);
+        QVERIFY(meter.failed);
+    }
+    QVERIFY(command.exiting);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray());
+}
+
+void TestMeterFleetCommand::finishMeter()
+{
+    MeterFleetCommand command;
+    command.meters.append({ u"alpha"_s });
+    command.meters.append({ u"beta"_s });
+    command.meters[0].connected = true;
+    command.activeConnections = 1;
+    command.discoveryFinished = true;
+
+    command.finishMeter(0, false);
+    QVERIFY(command.meters.at(0).finished);
+    QVERIFY(!command.meters.at(0).failed);
+    QCOMPARE(command.activeConnections, 0);
+    QVERIFY(!command.exiting); // Still waiting for beta.
+
+    command.finishMeter(0, true); // Already finished, so ignored.
+    QVERIFY(!command.meters.at(0).failed);
+    QCOMPARE(command.activeConnections, 0);
+
+    QTest::ignoreMessage(QtWarningMsg, R"(Failed to read all meter readings from device "beta".)");
+    command.finishMeter(1, true);
+    QVERIFY(command.meters.at(1).finished);
+    QVERIFY(command.meters.at(1).failed);
+    QCOMPARE(command.activeConnections, 0); // Beta was never connected.
+    QVERIFY(command.exiting);
+}
+
+void TestMeterFleetCommand::outputReading_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addRow("fleet.csv")    << AbstractCommand::OutputFormat::Csv;
+    QTest::addRow("fleet.json")   << AbstractCommand::OutputFormat::Json;
+    QTest::addRow("fleet.ndjson") << AbstractCommand::OutputFormat::Ndjson;
+    QTest::addRow("fleet.txt")    << AbstractCommand::OutputFormat::Text;
+}
+
+void TestMeterFleetCommand::outputReading()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterFleetCommand command;
+    command.format = format;
+    for (const QString &name: { u"alpha"_s, u"beta"_s }) {
+        MeterFleetCommand::Meter meter{ name };
+        meter.service = new MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()), &command);
+        meter.service->setPokitProduct(PokitProduct::PokitMeter);
+        command.meters.append(meter);
+    }
+    command.outputReading(0, { MultimeterService::MeterStatus::AutoRangeOn, 1.5f,
+                               MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V }, 1700000000000);
+    command.outputReading(1, { MultimeterService::MeterStatus::AutoRangeOff, 0.25f,
+                               MultimeterService::Mode::AcCurrent, +PokitMeter::CurrentRange::_2A }, 1700000000500);
+    command.outputReading(0, { MultimeterService::MeterStatus::AutoRangeOn, 1.25f,
+                               MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V }, 1700000001000);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestMeterFleetCommand::readingTimestamp()
+{
+    MeterFleetCommand command;
+    command.meters.append({ u"alpha"_s });
+    const qint64 before = QDateTime::currentMSecsSinceEpoch();
+    QVERIFY(command.readingTimestamp(0) >= before);
+    QCOMPARE(command.meters.at(0).readings, (qint64)0); // Not aligning, so not counted.
+    QVERIFY(!command.aligner.contains(u"alpha"_s));
+
+    command.alignTimestamps = true;
+    const qint64 first = command.readingTimestamp(0);
+    QVERIFY(std::abs(first - before) < 60000);
+    command.readingTimestamp(0);
+    QCOMPARE(command.meters.at(0).readings, (qint64)2);
+    QCOMPARE(command.aligner.estimate(u"alpha"_s).observations, 2);
+}
+
+void TestMeterFleetCommand::outputReading_samples()
+{
+    const OutputStreamCapture capture(&std::cout);
+    MeterFleetCommand command;
+    command.format = AbstractCommand::OutputFormat::Ndjson;
+    command.epochTimestamps = true;
+    MeterFleetCommand::Meter meter{ u"alpha"_s }; // No service, so no range.
+    meter.samplesToGo = 1;
+    command.meters.append(meter);
+    const MultimeterService::Reading reading{ MultimeterService::MeterStatus::Ok, 20.5f,
+                                              MultimeterService::Mode::Temperature, 0 };
+    command.outputReading(0, reading, 1700000000000);
+    QCOMPARE(command.meters.at(0).samplesToGo, (qint64)0);
+    command.outputReading(0, reading, 1700000001000); // Ignored, since all requested samples have been output.
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        R"({"timestamp":1700000000000,"device":"alpha","status":"Ok","value":20.5,"mode":"Temperature",)"
+        R"("unit":"°C"})" "\n"));
+}
+
+void TestMeterFleetCommand::outputReading_power()
+{
+    // Readings are joined by the power integrator, instead of being output; an Error reading is not joined.
+    const OutputStreamCapture capture(&std::cout);
+    MeterFleetCommand command;
+    command.format = AbstractCommand::OutputFormat::Csv;
+    command.powerIntegrator = new PowerIntegrator(&command);
+    command.meters.append({ u"alpha"_s });
+    command.meters.append({ u"beta"_s });
+    command.meters[0].samplesToGo = 2;
+    command.outputReading(0, { MultimeterService::MeterStatus::AutoRangeOn, 5.0f,
+                               MultimeterService::Mode::DcVoltage, 0 }, 1000);
+    command.outputReading(0, { MultimeterService::MeterStatus::AutoRangeOn, 6.0f,
+                               MultimeterService::Mode::DcVoltage, 0 }, 2000);
+    command.outputReading(1, { MultimeterService::MeterStatus::Error, 9.0f,
+                               MultimeterService::Mode::DcCurrent, 0 }, 1500);
+    QVERIFY(!command.powerIntegrator->hasResult());
+    QCOMPARE(command.meters.at(0).samplesToGo, (qint64)0);
+    command.outputReading(1, { MultimeterService::MeterStatus::AutoRangeOn, 2.0f,
+                               MultimeterService::Mode::DcCurrent, 0 }, 1500);
+    QVERIFY(command.powerIntegrator->hasResult());
+    QCOMPARE(command.powerIntegrator->result().power, 11.0f); // 5.5V (interpolated) times 2A.
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray()); // Not connected to outputPower().
+}
+
+void TestMeterFleetCommand::outputReading_resample()
+{
+    // Readings are resampled onto the grid, instead of being output directly; an Error reading is not resampled.
+    const OutputStreamCapture capture(&std::cout);
+    MeterFleetCommand command;
+    command.format = AbstractCommand::OutputFormat::Csv;
+    command.epochTimestamps = true;
+    command.resampler = new Resampler(2, &command);
+    connect(command.resampler, &Resampler::rowReady, &command, &MeterFleetCommand::outputRow);
+    command.meters.append({ u"alpha"_s });
+    command.meters.append({ u"beta"_s });
+    command.meters[0].samplesToGo = 2;
+    command.outputReading(0, { MultimeterService::MeterStatus::AutoRangeOn, 5.0f,
+                               MultimeterService::Mode::DcVoltage, 0 }, 1000);
+    command.outputReading(0, { MultimeterService::MeterStatus::AutoRangeOn, 6.0f,
+                               MultimeterService::Mode::DcVoltage, 0 }, 2000);
+    command.outputReading(1, { MultimeterService::MeterStatus::Error, 9.0f,
+                               MultimeterService::Mode::DcVoltage, 0 }, 1500);
+    QCOMPARE(command.meters.at(0).samplesToGo, (qint64)0);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray()); // Waiting for beta's first reading.
+    command.outputReading(1, { MultimeterService::MeterStatus::AutoRangeOn, 2.0f,
+                               MultimeterService::Mode::DcVoltage, 0 }, 1500);
+    command.outputReading(1, { MultimeterService::MeterStatus::AutoRangeOn, 2.5f,
+                               MultimeterService::Mode::DcVoltage, 0 }, 2500);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray(
+        "timestamp,alpha,beta\n1000,5.000000,\n2000,6.000000,2.250000\n"));
+}
+
+void TestMeterFleetCommand::outputReading_workers()
+{
+    const OutputStreamCapture capture(&std::cout);
+    MeterFleetCommand command;
+    command.format = AbstractCommand::OutputFormat::Csv;
+    command.epochTimestamps = true;
+    command.meters.append({ u"alpha"_s }); // No services, so no ranges.
+    command.meters.append({ u"beta"_s });
+    command.workers = new ShardedWorkerPool(2, &command);
+    QObject::connect(command.workers, &ShardedWorkerPool::outputReady, &command,
+                     &MeterFleetCommand::outputFormatted);
+
+    for (int reading = 0; reading < 100; ++reading) {
+        command.outputReading(reading % 2, { MultimeterService::MeterStatus::Ok, (float)reading,
+                                             MultimeterService::Mode::Temperature, 0 }, 1700000000000 + reading);
+    }
+    command.workers->flush();
+
+    // The header is output first, and each device's readings in order, however the two devices' are interleaved.
+    const QList<QByteArray> lines = QByteArray::fromStdString(capture.data()).split('\n');
+    QCOMPARE(lines.size(), 1 + 100 + 1); // Header, readings, and the empty string after the last newline.
+    QCOMPARE(lines.constFirst(), QByteArray("timestamp,device,mode,value,unit,status,range"));
+    QList<int> alpha, beta;
+    for (const QByteArray &line: lines.mid(1, 100)) {
+        const QList<QByteArray> fields = line.split(',');
+        QCOMPARE(fields.size(), 7);
+        const int reading = (int)(fields.at(0).toLongLong() - 1700000000000);
+        QCOMPARE(fields.at(3).toDouble(), (double)reading);
+        ((fields.at(1) == "alpha") ? alpha : beta).append(reading);
+    }
+    QCOMPARE(alpha.size(), 50);
+    QCOMPARE(beta.size(), 50);
+    for (int index = 0; index < 50; ++index) {
+        QCOMPARE(alpha.at(index), 2 * index);
+        QCOMPARE(beta.at(index), 2 * index + 1);
+    }
+    QCOMPARE(command.workers->statistics().delivered, (quint64)100);
+}
+
+void TestMeterFleetCommand::outputPower_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addRow("power.csv")    << AbstractCommand::OutputFormat::Csv;
+    QTest::addRow("power.json")   << AbstractCommand::OutputFormat::Json;
+    QTest::addRow("power.ndjson") << AbstractCommand::OutputFormat::Ndjson;
+    QTest::addRow("power.txt")    << AbstractCommand::OutputFormat::Text;
+}
+
+void TestMeterFleetCommand::outputPower()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterFleetCommand command;
+    command.format = format;
+    command.outputPower({ 1700000000000, 5.0f, 0.5f, 2.5f, 2.5, 0.0, 0.0, 0 });
+    command.outputPower({ 1700003600000, 5.0f, 1.5f, 7.5f, 5.0, 5.0, 1.0, 3600000 }); // 1 hour at 5W, on average.
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestMeterFleetCommand::outputRow_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addRow("resample.csv")    << AbstractCommand::OutputFormat::Csv;
+    QTest::addRow("resample.json")   << AbstractCommand::OutputFormat::Json;
+    QTest::addRow("resample.ndjson") << AbstractCommand::OutputFormat::Ndjson;
+    QTest::addRow("resample.txt")    << AbstractCommand::OutputFormat::Text;
+}
+
+void TestMeterFleetCommand::outputRow()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    LOADTESTDATA(expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    MeterFleetCommand command;
+    command.format = format;
+    command.settings.mode = MultimeterService::Mode::DcVoltage;
+    command.meters.append({ u"alpha"_s });
+    command.meters.append({ u"beta"_s });
+    command.outputRow(1700000000000, { 1.5f, std::numeric_limits<float>::quiet_NaN() }); // Beta not yet resampled.
+    command.outputRow(1700000001000, { 1.25f, 0.5f });
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestMeterFleetCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    MeterFleetCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestMeterFleetCommand)
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestMeterFleetCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void processOptions_deviceList();
+    void processOptions_resample();
+    void processOptions_workers_data();
+    void processOptions_workers();
+
+    void deviceDiscoveryFinished();
+
+    void finishMeter();
+
+    void readingTimestamp();
+
+    void outputReading_data();
+    void outputReading();
+
+    void outputReading_samples();
+    void outputReading_power();
+    void outputReading_resample();
+    void outputReading_workers();
+
+    void outputPower_data();
+    void outputPower();
+
+    void outputRow_data();
+    void outputRow();
+
+    void tr();
+};
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestMqttPublisher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void setUrl_data();
+    void setUrl();
+
+    void topic_data();
+    void topic();
+
+    void publish_meterBinary();
+    void publish_meterJson();
+    void publish_dsoBinary();
+    void publish_dsoJson();
+
+    void batchSize();
+    void batchInterval();
+    void spillBuffer();
+
+    void handlePacket_connAck();
+    void handlePacket_pubAck();
+
+    void encodePacket_data();
+    void encodePacket();
+
+    void connectPacket();
+    void publishPacket();
+
+    void parsePacket_data();
+    void parsePacket();
+
+    void tr();
+};
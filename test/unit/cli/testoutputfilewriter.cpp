@@ -0,0 +1,262 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testoutputfilewriter.h"
+#include "../stringliterals_p.h"
+
+#include "outputfilewriter.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+QByteArray readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    return (file.open(QIODevice::ReadOnly)) ? file.readAll() : QByteArray();
+}
+
+}
+
+void TestOutputFileWriter::open()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"out.csv"_s);
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write("previous run"), (qint64)12);
+    }
+
+    OutputFileWriter writer;
+    QVERIFY(!writer.isOpen());
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.isOpen());
+    QCOMPARE(writer.fileName(), fileName);
+    writer.close();
+    QVERIFY(!writer.isOpen());
+    QCOMPARE(readFile(fileName), QByteArray()); // Truncated.
+    writer.close(); // Closing again is a no-op.
+}
+
+void TestOutputFileWriter::open_failure()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    OutputFileWriter writer;
+    QVERIFY(!writer.open(dir.filePath(u"no-such-dir/out.csv"_s)));
+    QVERIFY(!writer.isOpen());
+    QVERIFY(!writer.errorString().isEmpty());
+}
+
+void TestOutputFileWriter::write()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"out.csv"_s);
+    OutputFileWriter writer;
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.write(QByteArray("one\n")));
+    QVERIFY(writer.write(QByteArray()));
+    QVERIFY(writer.write(QByteArray("two\n")));
+    writer.close(); // Writes all queued output first.
+    QCOMPARE(readFile(fileName), QByteArray("one\ntwo\n"));
+
+    const OutputFileWriter::Statistics stats = writer.statistics();
+    QCOMPARE(stats.bytesWritten, (quint64)8);
+    QVERIFY(stats.writes >= 1); // Depending on whether the two writes were coalesced.
+    QCOMPARE(stats.dropped, (quint64)0);
+    QCOMPARE(stats.rotations, (quint64)0);
+    QCOMPARE(stats.errors, (quint64)0);
+}
+
+void TestOutputFileWriter::write_queueFull()
+{
+    // Without open(), there is no writer thread to drain the queue, so it can be filled deterministically.
+    OutputFileWriter writer;
+    writer.setQueueSize(10);
+    QVERIFY(writer.write(QByteArray(16, 'a'))); // An empty queue accepts any one buffer.
+    QVERIFY(!writer.write(QByteArray(1, 'b')));
+    QCOMPARE(writer.queuedBytes, (qint64)16);
+
+    writer.queue.clear();
+    writer.queuedBytes = 0;
+    QVERIFY(writer.write(QByteArray(6, 'c')));
+    QVERIFY(writer.write(QByteArray(4, 'd')));
+    QVERIFY(!writer.write(QByteArray(1, 'e')));
+
+    const OutputFileWriter::Statistics stats = writer.statistics();
+    QCOMPARE(stats.dropped, (quint64)2);
+    QCOMPARE(stats.bytesDropped, (quint64)2);
+}
+
+void TestOutputFileWriter::write_dropOldest()
+{
+    OutputFileWriter writer;
+    writer.setOverflowPolicy(OutputFileWriter::OverflowPolicy::DropOldest);
+    writer.setQueueSize(10);
+    QVERIFY(writer.write(QByteArray(4, 'a')));
+    QVERIFY(writer.write(QByteArray(4, 'b')));
+    QVERIFY(!writer.write(QByteArray(4, 'c'))); // Drops the oldest, to make room.
+    QCOMPARE((QList<QByteArray>)writer.queue, QList<QByteArray>({ QByteArray(4, 'b'), QByteArray(4, 'c') }));
+    QCOMPARE(writer.queuedBytes, (qint64)8);
+    QVERIFY(!writer.write(QByteArray(9, 'd'))); // Drops both, to make room.
+    QCOMPARE((QList<QByteArray>)writer.queue, QList<QByteArray>({ QByteArray(9, 'd') }));
+
+    const OutputFileWriter::Statistics stats = writer.statistics();
+    QCOMPARE(stats.dropped, (quint64)3);
+    QCOMPARE(stats.bytesDropped, (quint64)12);
+}
+
+void TestOutputFileWriter::write_decimate()
+{
+    OutputFileWriter writer;
+    writer.setOverflowPolicy(OutputFileWriter::OverflowPolicy::Decimate);
+    writer.setQueueSize(5);
+    for (const char c: { 'a', 'b', 'c', 'd', 'e' }) {
+        QVERIFY(writer.write(QByteArray(1, c)));
+    }
+    QVERIFY(!writer.write(QByteArray(1, 'f'))); // Drops every second queued buffer.
+    QCOMPARE((QList<QByteArray>)writer.queue, QList<QByteArray>({ "a", "c", "e", "f" }));
+    QCOMPARE(writer.queuedBytes, (qint64)4);
+    QCOMPARE(writer.statistics().dropped, (quint64)2);
+
+    // When decimating can't make enough room, the new buffer is dropped too.
+    writer.queue.clear();
+    writer.queue.enqueue(QByteArray(5, 'g'));
+    writer.queuedBytes = 5;
+    QVERIFY(!writer.write(QByteArray(1, 'h')));
+    QCOMPARE((QList<QByteArray>)writer.queue, QList<QByteArray>({ QByteArray(5, 'g') }));
+    QCOMPARE(writer.statistics().dropped, (quint64)3);
+    QCOMPARE(writer.statistics().bytesDropped, (quint64)3);
+}
+
+void TestOutputFileWriter::write_block()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"out.csv"_s);
+    OutputFileWriter writer;
+    writer.setOverflowPolicy(OutputFileWriter::OverflowPolicy::Block);
+    writer.setQueueSize(1);
+    QVERIFY(writer.open(fileName));
+    QByteArray expected;
+    for (int index = 0; index < 100; ++index) {
+        const QByteArray line = QByteArray::number(index) + '\n';
+        QVERIFY(writer.write(line)); // Waits for room, rather than dropping anything.
+        expected.append(line);
+    }
+    writer.close();
+    QCOMPARE(readFile(fileName), expected);
+
+    const OutputFileWriter::Statistics stats = writer.statistics();
+    QCOMPARE(stats.dropped, (quint64)0);
+    QCOMPARE(stats.bytesWritten, (quint64)expected.size());
+    QVERIFY(stats.blockedTime >= 0); // How often, and for how long, writes blocked depends on the writer thread.
+}
+
+void TestOutputFileWriter::overflowPolicy()
+{
+    OutputFileWriter writer;
+    QCOMPARE(writer.overflowPolicy(), OutputFileWriter::OverflowPolicy::DropNewest);
+    writer.setOverflowPolicy(OutputFileWriter::OverflowPolicy::Block);
+    QCOMPARE(writer.overflowPolicy(), OutputFileWriter::OverflowPolicy::Block);
+
+    // Without a writer thread, there is nothing to wait for, so blocking writes are queued regardless.
+    writer.setQueueSize(1);
+    QVERIFY(writer.write(QByteArray("a")));
+    QVERIFY(writer.write(QByteArray("b")));
+    QCOMPARE(writer.queuedBytes, (qint64)2);
+    QCOMPARE(writer.statistics().blocked, (quint64)0);
+}
+
+void TestOutputFileWriter::threadPolicy()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    OutputFileWriter writer;
+    QVERIFY(!writer.threadPolicy().applied);
+
+    // Without a writer thread, the settings are held until the thread starts.
+    writer.setThreadPolicy(ThreadPolicy::Settings{});
+    QVERIFY(!writer.threadPolicy().applied);
+    QVERIFY(writer.open(dir.filePath(u"out.csv"_s)));
+    QTRY_VERIFY(writer.threadPolicy().applied);
+    QVERIFY(writer.threadPolicy().errors.isEmpty());
+
+    // Once running, the writer thread applies new settings when woken.
+    const QVector<int> cpus = ThreadPolicy::current().cpus;
+    if (!cpus.isEmpty()) {
+        writer.setThreadPolicy({ { cpus.constFirst() } });
+        QTRY_COMPARE(writer.threadPolicy().cpus, QVector<int>{ cpus.constFirst() });
+    }
+    writer.close();
+}
+
+void TestOutputFileWriter::rotate_size()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"out.csv"_s);
+    OutputFileWriter writer;
+    writer.setRotation(15, 0);
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.write(QByteArray("aaaaaaaaaa")));
+    QVERIFY(writer.write(QByteArray("bbbbbbbbbb")));
+    QVERIFY(writer.write(QByteArray("cccccccccc")));
+    writer.close();
+
+    QCOMPARE(readFile(dir.filePath(u"out.1.csv"_s)), QByteArray("aaaaaaaaaa"));
+    QCOMPARE(readFile(dir.filePath(u"out.2.csv"_s)), QByteArray("bbbbbbbbbb"));
+    QCOMPARE(readFile(fileName), QByteArray("cccccccccc"));
+    QCOMPARE(writer.statistics().rotations, (quint64)2);
+    QCOMPARE(writer.statistics().errors, (quint64)0);
+}
+
+void TestOutputFileWriter::rotationDue()
+{
+    OutputFileWriter writer;
+    QVERIFY(!writer.rotationDue(100, 1000)); // Never rotates, by default.
+
+    writer.setRotation(100, 60000);
+    writer.fileOpened = 1000;
+    QVERIFY(!writer.rotationDue(1000, 100000)); // Empty files are never rotated.
+
+    writer.fileSize = 50;
+    QVERIFY(!writer.rotationDue(50, 1000));
+    QVERIFY(writer.rotationDue(51, 1000));      // Would exceed the maximum size.
+    QVERIFY(!writer.rotationDue(1, 60999));
+    QVERIFY(writer.rotationDue(1, 61000));      // Reached the maximum age.
+}
+
+void TestOutputFileWriter::rotatedFileName_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<int>("index");
+    QTest::addColumn<QString>("expected");
+    QTest::addRow("suffix")    << u"meter.csv"_s            << 3 << u"meter.3.csv"_s;
+    QTest::addRow("no-suffix") << u"/tmp/output"_s          << 1 << u"/tmp/output.1"_s;
+    QTest::addRow("suffixes")  << u"a.d/archive.tar.gz"_s   << 12 << u"a.d/archive.tar.12.gz"_s;
+}
+
+void TestOutputFileWriter::rotatedFileName()
+{
+    QFETCH(QString, fileName);
+    QFETCH(int, index);
+    QFETCH(QString, expected);
+    QCOMPARE(OutputFileWriter::rotatedFileName(fileName, index), expected);
+}
+
+void TestOutputFileWriter::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    OutputFileWriter writer;
+    QVERIFY(!writer.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestOutputFileWriter)
@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestOutputFileWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void open();
+    void open_failure();
+
+    void write();
+    void write_queueFull();
+    void write_dropOldest();
+    void write_decimate();
+    void write_block();
+
+    void overflowPolicy();
+    void threadPolicy();
+
+    void rotate_size();
+    void rotationDue();
+
+    void rotatedFileName_data();
+    void rotatedFileName();
+
+    void tr();
+};
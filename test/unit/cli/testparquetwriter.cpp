@@ -0,0 +1,299 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testparquetwriter.h"
+#include "../stringliterals_p.h"
+
+#include "parquetwriter.h"
+
+#include <qtpokit/pokitmeter.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+DOKIT_USE_STRINGLITERALS
+
+// Returns the entire contents of \a fileName, or a null byte array if it could not be read.
+static QByteArray readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    return (file.open(QIODevice::ReadOnly)) ? file.readAll() : QByteArray();
+}
+
+static const LoggerArchive::Session testSession {
+    { DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V,
+      60000, 4, 1700000000 },
+    0, Q_UINT64_C(1700000000000), Q_UINT64_C(1700000180000)
+};
+
+void TestParquetWriter::open()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"logger.parquet"_s);
+    ParquetWriter writer;
+    QVERIFY(!writer.isOpen());
+    QVERIFY(writer.fileName().isNull());
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.isOpen());
+    QCOMPARE(writer.fileName(), fileName);
+    QVERIFY(writer.errorString().isEmpty());
+    QVERIFY(writer.close());
+    QVERIFY(!writer.isOpen());
+
+    // Even without any row groups, the file is a valid Parquet file, with a schema.
+    const QByteArray data = readFile(fileName);
+    QVERIFY(data.startsWith("PAR1"));
+    QVERIFY(data.endsWith("PAR1"));
+    QCOMPARE(writer.statistics().bytes, (qint64)data.size());
+    QCOMPARE(writer.statistics().rowGroups, (quint64)0);
+}
+
+void TestParquetWriter::open_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ParquetWriter writer;
+    QVERIFY(!writer.open(dir.filePath(u"missing/logger.parquet"_s)));
+    QVERIFY(!writer.isOpen());
+    QVERIFY(!writer.errorString().isEmpty());
+}
+
+void TestParquetWriter::write()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"logger.parquet"_s);
+    ParquetWriter writer;
+    writer.setSourceName(u"logger.bin"_s);
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.write(testSession, { 1, -2, 1, 1 }));
+    QCOMPARE(writer.statistics().rows, (quint64)4);
+    QCOMPARE(writer.statistics().rowGroups, (quint64)1);
+
+    // Each session is a single row group, of one chunk per column.
+    QCOMPARE(writer.rowGroups.size(), 1);
+    const ParquetWriter::RowGroup group = writer.rowGroups.constFirst();
+    QCOMPARE(group.numRows, (qint64)4);
+    QCOMPARE(group.chunks.size(), ParquetWriter::columnCount);
+    for (const ParquetWriter::Chunk &chunk: group.chunks) {
+        QCOMPARE(chunk.numValues, (qint64)4);
+    }
+
+    // Timestamps are plain encoded, straight after the file's magic bytes.
+    const ParquetWriter::Chunk &timestamps = group.chunks.at(0);
+    QCOMPARE(timestamps.dictionaryPageOffset, (qint64)-1);
+    QCOMPARE(timestamps.dataPageOffset, (qint64)4);
+    QCOMPARE(timestamps.minValue, QByteArray::fromHex("0068e5cf8b010000"));
+    QCOMPARE(timestamps.maxValue, QByteArray::fromHex("2027e8cf8b010000"));
+
+    // The session's properties are constant.
+    QCOMPARE(group.chunks.at(1).minValue, QByteArray::fromHex("0068e5cf8b010000"));
+    QCOMPARE(group.chunks.at(2).minValue, QByteArray("DC voltage"));
+    QCOMPARE(group.chunks.at(3).minValue, QByteArray("Vdc"));
+    QCOMPARE(group.chunks.at(3).maxValue, QByteArray("Vdc"));
+    QCOMPARE(group.chunks.at(4).minValue, QByteArray::fromHex("01000000"));
+
+    // The samples, and their values, share the same dictionary indexes.
+    const ParquetWriter::Chunk &samples = group.chunks.at(5);
+    const ParquetWriter::Chunk &values = group.chunks.at(6);
+    QCOMPARE(samples.minValue, QByteArray::fromHex("feffffff"));
+    QCOMPARE(samples.maxValue, QByteArray::fromHex("01000000"));
+    QCOMPARE(values.minValue, QByteArray::fromHex("000080bf"));
+    QCOMPARE(values.maxValue, QByteArray::fromHex("0000003f"));
+    const QByteArray metadata = writer.fileMetaData();
+    QVERIFY(writer.close());
+
+    const QByteArray data = readFile(fileName);
+    QCOMPARE(writer.statistics().bytes, (qint64)data.size());
+    QVERIFY(data.startsWith("PAR1"));
+    QVERIFY(data.endsWith("PAR1"));
+    QCOMPARE(qFromLittleEndian<quint32>(data.constData() + data.size() - 8), (quint32)metadata.size());
+    QCOMPARE(data.mid(data.size() - 8 - metadata.size(), metadata.size()), metadata);
+
+    const QByteArray dictionary = ParquetWriter::gzip(QByteArray::fromHex("01000000" "feffffff"));
+    QCOMPARE(data.mid(samples.dictionaryPageOffset, samples.dataPageOffset - samples.dictionaryPageOffset),
+             ParquetWriter::pageHeader(true, 2, ParquetWriter::Encoding::Plain, 8, dictionary.size()) + dictionary);
+    const QByteArray indexes = ParquetWriter::gzip(QByteArray::fromHex("010302"));
+    const QByteArray page = ParquetWriter::pageHeader(false, 4, ParquetWriter::Encoding::RleDictionary, 3,
+                                                      indexes.size()) + indexes;
+    QCOMPARE(data.mid(samples.dataPageOffset, page.size()), page);
+    QCOMPARE(samples.compressedSize, (qint64)(samples.dataPageOffset - samples.dictionaryPageOffset + page.size()));
+    QCOMPARE(data.mid(values.dataPageOffset, page.size()), page);
+}
+
+void TestParquetWriter::write_empty()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ParquetWriter writer;
+    QVERIFY(writer.open(dir.filePath(u"logger.parquet"_s)));
+    QVERIFY(writer.write(testSession, { })); // No-op.
+    QCOMPARE(writer.statistics().rowGroups, (quint64)0);
+    QVERIFY(writer.rowGroups.isEmpty());
+}
+
+void TestParquetWriter::write_notOpen()
+{
+    ParquetWriter writer;
+    QVERIFY(!writer.write(testSession, { 1, 2, 3 }));
+    QCOMPARE(writer.errorString(), u"No Parquet file open"_s);
+}
+
+void TestParquetWriter::close()
+{
+    ParquetWriter writer;
+    QVERIFY(writer.close()); // Nothing to close.
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"logger.parquet"_s);
+    {
+        ParquetWriter writer;
+        QVERIFY(writer.open(fileName));
+        QVERIFY(writer.write(testSession, { 1, 2, 3, 4 }));
+    } // Closed on destruction.
+    QVERIFY(readFile(fileName).endsWith("PAR1"));
+}
+
+void TestParquetWriter::fileMetaData()
+{
+    ParquetWriter writer;
+    writer.setSourceName(u"logger.bin"_s);
+    const QByteArray metadata = writer.fileMetaData();
+
+    // Version 1, then a list of 8 schema elements, beginning with the root, named "schema", with 7 children.
+    QVERIFY(metadata.startsWith(QByteArray::fromHex("1502" "198c" "4806") + "schema" + QByteArray::fromHex("150e00")));
+    for (const char * const name: { "timestamp", "session", "mode", "unit", "range", "sample", "value" }) {
+        QVERIFY(metadata.contains(name));
+    }
+    QVERIFY(metadata.contains("dokit.archive"));
+    QVERIFY(metadata.contains("logger.bin"));
+    QVERIFY(metadata.endsWith(QByteArray(1, '\0')));
+}
+
+void TestParquetWriter::pageHeader_data()
+{
+    QTest::addColumn<bool>("dictionary");
+    QTest::addColumn<int>("numValues");
+    QTest::addColumn<int>("encoding"); // ParquetWriter::Encoding is private, so not a registered metatype.
+    QTest::addColumn<int>("uncompressedSize");
+    QTest::addColumn<int>("compressedSize");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("data") << false << 3 << (int)ParquetWriter::Encoding::RleDictionary << 10 << 20
+        << QByteArray::fromHex("1500" "1514" "1528" "2c" "1506" "1510" "1506" "1506" "00" "00");
+    QTest::addRow("dictionary") << true << 3 << (int)ParquetWriter::Encoding::Plain << 10 << 20
+        << QByteArray::fromHex("1504" "1514" "1528" "4c" "1506" "1500" "00" "00");
+    QTest::addRow("large") << false << 6192 << (int)ParquetWriter::Encoding::Plain << 49536 << 1234
+        << QByteArray::fromHex("1500" "15808606" "15a413" "2c" "15e060" "1500" "1506" "1506" "00" "00");
+}
+
+void TestParquetWriter::pageHeader()
+{
+    QFETCH(bool, dictionary);
+    QFETCH(int, numValues);
+    QFETCH(int, encoding);
+    QFETCH(int, uncompressedSize);
+    QFETCH(int, compressedSize);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(ParquetWriter::pageHeader(dictionary, numValues, (ParquetWriter::Encoding)encoding, uncompressedSize,
+                                       compressedSize), expected);
+}
+
+void TestParquetWriter::encodeIndexes_data()
+{
+    QTest::addColumn<QVector<quint32>>("indexes");
+    QTest::addColumn<int>("bitWidth");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("empty") << QVector<quint32>{ } << 1 << QByteArray::fromHex("01");
+    QTest::addRow("run") << QVector<quint32>(10, 0) << 1 << QByteArray::fromHex("01" "1400");
+    QTest::addRow("bit-packed") << QVector<quint32>{ 0, 1, 2, 3, 4, 5, 6, 7 } << 3
+        << QByteArray::fromHex("03" "03" "88c6fa"); // As per the Parquet format's own example.
+    QTest::addRow("padded") << QVector<quint32>{ 5, 5, 5 } << 3 << QByteArray::fromHex("03" "03" "6d0100");
+    QTest::addRow("mixed") << (QVector<quint32>{ 1, 2, 3 } + QVector<quint32>(20, 0)) << 2
+        << QByteArray::fromHex("02" "0339" "00" "1e00"); // Tops up the bit-packed group from the following run.
+    QTest::addRow("wide") << QVector<quint32>(8, 0x1234) << 13 << QByteArray::fromHex("0d" "10" "3412");
+}
+
+void TestParquetWriter::encodeIndexes()
+{
+    QFETCH(QVector<quint32>, indexes);
+    QFETCH(int, bitWidth);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(ParquetWriter::encodeIndexes(indexes, bitWidth), expected);
+}
+
+void TestParquetWriter::bitWidth_data()
+{
+    QTest::addColumn<quint32>("maxValue");
+    QTest::addColumn<int>("expected");
+
+    QTest::addRow("0") << (quint32)0 << 1;
+    QTest::addRow("1") << (quint32)1 << 1;
+    QTest::addRow("2") << (quint32)2 << 2;
+    QTest::addRow("3") << (quint32)3 << 2;
+    QTest::addRow("4") << (quint32)4 << 3;
+    QTest::addRow("255") << (quint32)255 << 8;
+    QTest::addRow("256") << (quint32)256 << 9;
+    QTest::addRow("max") << (quint32)0xFFFFFFFF << 32;
+}
+
+void TestParquetWriter::bitWidth()
+{
+    QFETCH(quint32, maxValue);
+    QFETCH(int, expected);
+    QCOMPARE(ParquetWriter::bitWidth(maxValue), expected);
+}
+
+void TestParquetWriter::gzip_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::addRow("empty") << QByteArray();
+    QTest::addRow("text") << QByteArray("hello hello hello");
+    QTest::addRow("binary") << QByteArray::fromHex("0100feff2c01").repeated(100);
+}
+
+void TestParquetWriter::gzip()
+{
+    QFETCH(QByteArray, data);
+    const QByteArray result = ParquetWriter::gzip(data);
+    QVERIFY(result.startsWith(QByteArray::fromHex("1f8b08000000000000ff")));
+    QCOMPARE(qFromLittleEndian<quint32>(result.constData() + result.size() - 8), ParquetWriter::crc32(data));
+    QCOMPARE(qFromLittleEndian<quint32>(result.constData() + result.size() - 4), (quint32)data.size());
+
+    // The deflate stream is zlib's, as per qCompress(), without its size prefix, header, and Adler-32 trailer.
+    const QByteArray zlib = qCompress(data);
+    const QByteArray deflate = (data.isEmpty()) ? QByteArray::fromHex("0300") : zlib.mid(6, zlib.size() - 10);
+    QCOMPARE(result.mid(10, result.size() - 18), deflate);
+}
+
+void TestParquetWriter::crc32_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<quint32>("expected");
+
+    QTest::addRow("empty") << QByteArray() << (quint32)0;
+    QTest::addRow("check") << QByteArray("123456789") << (quint32)0xCBF43926; // The standard check value.
+    QTest::addRow("fox") << QByteArray("The quick brown fox jumps over the lazy dog") << (quint32)0x414FA339;
+}
+
+void TestParquetWriter::crc32()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(quint32, expected);
+    QCOMPARE(ParquetWriter::crc32(data), expected);
+}
+
+void TestParquetWriter::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    ParquetWriter writer;
+    QVERIFY(!writer.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestParquetWriter)
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestParquetWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void open();
+    void open_invalid();
+
+    void write();
+    void write_empty();
+    void write_notOpen();
+
+    void close();
+
+    void fileMetaData();
+
+    void pageHeader_data();
+    void pageHeader();
+
+    void encodeIndexes_data();
+    void encodeIndexes();
+
+    void bitWidth_data();
+    void bitWidth();
+
+    void gzip_data();
+    void gzip();
+
+    void crc32_data();
+    void crc32();
+
+    void tr();
+};
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testphasetimer.h"
+#include "../stringliterals_p.h"
+
+#include "metercommand.h"
+#include "phasetimer.h"
+
+#include <QCommandLineParser>
+#include <QRegularExpression>
+
+DOKIT_USE_STRINGLITERALS
+
+Q_DECLARE_METATYPE(PhaseTimer::Phase)
+
+void TestPhaseTimer::cleanup()
+{
+    PhaseTimer::reset(); // The timer is static, so would otherwise leak between tests.
+}
+
+void TestPhaseTimer::mark()
+{
+    PhaseTimer::start();
+    QVERIFY(PhaseTimer::isStarted());
+    for (int index = 0; index < PhaseTimer::phaseCount; ++index) {
+        QCOMPARE(PhaseTimer::elapsed((PhaseTimer::Phase)index), (qint64)-1);
+    }
+
+    PhaseTimer::mark(PhaseTimer::Phase::Application);
+    const qint64 application = PhaseTimer::elapsed(PhaseTimer::Phase::Application);
+    QVERIFY(application >= 0);
+
+    // Only the first occurrence of each phase is recorded.
+    PhaseTimer::mark(PhaseTimer::Phase::Application);
+    QCOMPARE(PhaseTimer::elapsed(PhaseTimer::Phase::Application), application);
+
+    PhaseTimer::mark(PhaseTimer::Phase::Options);
+    QVERIFY(PhaseTimer::elapsed(PhaseTimer::Phase::Options) >= application);
+    QCOMPARE(PhaseTimer::elapsed(PhaseTimer::Phase::Translations), (qint64)-1);
+}
+
+void TestPhaseTimer::mark_notStarted()
+{
+    QVERIFY(!PhaseTimer::isStarted());
+    PhaseTimer::mark(PhaseTimer::Phase::FirstOutput);
+    QCOMPARE(PhaseTimer::elapsed(PhaseTimer::Phase::FirstOutput), (qint64)-1);
+}
+
+void TestPhaseTimer::reset()
+{
+    PhaseTimer::start();
+    PhaseTimer::mark(PhaseTimer::Phase::Command);
+    QVERIFY(PhaseTimer::elapsed(PhaseTimer::Phase::Command) >= 0);
+    PhaseTimer::reset();
+    QVERIFY(!PhaseTimer::isStarted());
+    QCOMPARE(PhaseTimer::elapsed(PhaseTimer::Phase::Command), (qint64)-1);
+
+    // Restarting also discards earlier phases.
+    PhaseTimer::start();
+    PhaseTimer::mark(PhaseTimer::Phase::Command);
+    PhaseTimer::start();
+    QCOMPARE(PhaseTimer::elapsed(PhaseTimer::Phase::Command), (qint64)-1);
+}
+
+void TestPhaseTimer::toString_data()
+{
+    QTest::addColumn<PhaseTimer::Phase>("phase");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(phase, expected) \
+        QTest::addRow(#phase) << PhaseTimer::Phase::phase << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(Application,     "application");
+    DOKIT_ADD_TEST_ROW(Translations,    "translations");
+    DOKIT_ADD_TEST_ROW(Options,         "options");
+    DOKIT_ADD_TEST_ROW(Command,         "command");
+    DOKIT_ADD_TEST_ROW(DeviceFound,     "device-found");
+    DOKIT_ADD_TEST_ROW(Connected,       "connected");
+    DOKIT_ADD_TEST_ROW(Discovered,      "discovered");
+    DOKIT_ADD_TEST_ROW(SettingsWritten, "settings-written");
+    DOKIT_ADD_TEST_ROW(FirstOutput,     "first-output");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (PhaseTimer::Phase)PhaseTimer::phaseCount << QString();
+}
+
+void TestPhaseTimer::toString()
+{
+    QFETCH(PhaseTimer::Phase, phase);
+    QFETCH(QString, expected);
+    QCOMPARE(PhaseTimer::toString(phase), expected);
+}
+
+void TestPhaseTimer::report()
+{
+    QCOMPARE(PhaseTimer::report(), u"# elapsed(ms) delta(ms) phase\n"_s);
+
+    PhaseTimer::start();
+    PhaseTimer::mark(PhaseTimer::Phase::Application);
+    PhaseTimer::mark(PhaseTimer::Phase::FirstOutput);
+    PhaseTimer::mark(PhaseTimer::Phase::Command); // Out of enum order, so reported after first-output.
+
+    const QStringList lines = PhaseTimer::report().split(u'\n');
+    QCOMPARE(lines.size(), 5);
+    QCOMPARE(lines.constLast(), QString()); // Since the report ends with a newline.
+    QCOMPARE(lines.at(0), u"# elapsed(ms) delta(ms) phase"_s);
+    const QRegularExpression pattern(u"^ *[0-9]+\\.[0-9]{3} +[0-9]+\\.[0-9]{3} ([a-z-]+)$"_s);
+    const QStringList expected{ u"application"_s, u"first-output"_s, u"command"_s };
+    for (int index = 0; index < expected.size(); ++index) {
+        const QRegularExpressionMatch match = pattern.match(lines.at(index + 1));
+        QVERIFY2(match.hasMatch(), qUtf8Printable(lines.at(index + 1)));
+        QCOMPARE(match.captured(1), expected.at(index));
+    }
+}
+
+void TestPhaseTimer::benchmark_commandStartup()
+{
+    // Benchmark the offline phases of a typical `meter` command's startup, from parsing its command line, to having
+    // processed its options. The remaining (device-found, connected, discovered, settings-written and first-output)
+    // phases require a real device, so are only measured by the `--timings` option itself.
+    const QStringList arguments{ u"dokit"_s, u"meter"_s, u"--mode"_s, u"Vdc"_s, u"--range"_s, u"auto"_s };
+    QBENCHMARK {
+        QCommandLineParser parser;
+        parser.addOption({u"mode"_s, u"description"_s, u"mode"_s});
+        parser.addOption({u"range"_s, u"description"_s, u"range"_s});
+        parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+        parser.addOption({u"samples"_s, u"description"_s, u"samples"_s});
+        parser.process(arguments);
+        MeterCommand command(this);
+        QVERIFY(command.processOptions(parser).isEmpty());
+    }
+}
+
+void TestPhaseTimer::tr()
+{
+    // Exercise the inline tr() function (added by the Q_DECLARE_TR_FUNCTIONS macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    QVERIFY(!PhaseTimer::tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestPhaseTimer)
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestPhaseTimer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+
+    void mark();
+    void mark_notStarted();
+    void reset();
+
+    void toString_data();
+    void toString();
+
+    void report();
+
+    void benchmark_commandStartup();
+
+    void tr();
+};
@@ -0,0 +1,455 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testquerycommand.h"
+#include "archivefixture.h"
+#include "outputstreamcapture.h"
+#include "../stringliterals_p.h"
+
+#include "querycommand.h"
+#include "shardedworkerpool.h"
+
+#include <qtpokit/loggerrollup.h>
+#include <qtpokit/pokitmeter.h>
+
+#include <QTemporaryDir>
+
+#include <array>
+#include <limits>
+
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+const DataLoggerService::Metadata testMetadata{ DataLoggerService::LoggerStatus::Done, 0.5f,
+    DataLoggerService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V, 60000, 3, 1700000000 };
+
+// Populates \a dir with two archives (and a non-archive) in `archives`, and an empty `empty` directory.
+bool createArchives(const QTemporaryDir &dir)
+{
+    return ::createArchives(dir, testMetadata, { u"archives"_s, u"empty"_s }, {
+        { u"archives/a.bin"_s, 0, { 1, 2, 3 } }, { u"archives/a.bin"_s, 600, { 4, 5 } },
+        { u"archives/b.bin"_s, 0, { -1 } } });
+}
+
+}
+
+void TestQueryCommand::requiredOptions()
+{
+    QueryCommand command(this);
+    QCommandLineParser parser;
+    QCOMPARE(command.requiredOptions(parser), QStringList{ u"archive"_s });
+}
+
+void TestQueryCommand::supportedOptions()
+{
+    QueryCommand command(this);
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + QStringList{
+        u"async-log"_s, u"backpressure"_s, u"debug"_s, u"device"_s, u"d"_s, u"flush"_s, u"memory-budget"_s,
+        u"output"_s, u"output-file"_s, u"rotate-interval"_s, u"rotate-size"_s, u"timeout"_s, u"timings"_s, u"trace"_s,
+        u"aggregate"_s, u"from"_s, u"time-format"_s, u"to"_s, u"workers"_s };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestQueryCommand::processOptions_data()
+{
+    QTest::addColumn<QStringList>("arguments");
+    QTest::addColumn<QStringList>("expectedArchives");
+    QTest::addColumn<quint64>("expectedFrom");
+    QTest::addColumn<quint64>("expectedTo");
+    QTest::addColumn<quint64>("expectedWidth");
+    QTest::addColumn<QStringList>("expectedErrors");
+
+    const quint64 max = std::numeric_limits<quint64>::max();
+    QTest::addRow("missing-archive")
+        << QStringList{ }
+        << QStringList{ } << (quint64)0 << max << (quint64)0
+        << QStringList{ u"Missing required option: archive"_s };
+    QTest::addRow("file")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/a.bin"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s } << (quint64)0 << max << (quint64)0
+        << QStringList{ };
+    QTest::addRow("directory")
+        << QStringList{ u"--archive"_s, u"{dir}/archives"_s }
+        << QStringList{ u"{dir}/archives/a.bin"_s, u"{dir}/archives/b.bin"_s } << (quint64)0 << max << (quint64)0
+        << QStringList{ };
+    QTest::addRow("not-found")
+        << QStringList{ u"--archive"_s, u"{dir}/missing.bin"_s }
+        << QStringList{ } << (quint64)0 << max << (quint64)0
+        << QStringList{ u"Archive does not exist: {dir}/missing.bin"_s };
+    QTest::addRow("empty-directory")
+        << QStringList{ u"--archive"_s, u"{dir}/empty"_s }
+        << QStringList{ } << (quint64)0 << max << (quint64)0
+        << QStringList{ u"No archives found in {dir}/empty"_s };
+    QTest::addRow("epoch-range")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--from"_s, u"1700000000000"_s,
+                        u"--to"_s, u"1700000600000"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << (quint64)1700000000000 << (quint64)1700000600000
+        << (quint64)0 << QStringList{ };
+    QTest::addRow("iso-range")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--from"_s, u"2023-11-14T22:13:20Z"_s,
+                        u"--to"_s, u"2023-11-14T22:23:20.500Z"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << (quint64)1700000000000 << (quint64)1700000600500
+        << (quint64)0 << QStringList{ };
+    QTest::addRow("invalid-range")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--from"_s, u"yesterday"_s,
+                        u"--to"_s, u"-1"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << (quint64)0 << max << (quint64)0
+        << QStringList{ u"Invalid from value: yesterday"_s, u"Invalid to value: -1"_s };
+    QTest::addRow("reversed-range")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--from"_s, u"2000"_s, u"--to"_s, u"1000"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << (quint64)2000 << (quint64)1000 << (quint64)0
+        << QStringList{ u"The from time must not be after the to time"_s };
+    QTest::addRow("aggregate")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--aggregate"_s, u"3600s"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << (quint64)0 << max << (quint64)3600000
+        << QStringList{ };
+    QTest::addRow("invalid-aggregate")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--aggregate"_s, u"often"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << (quint64)0 << max << (quint64)0
+        << QStringList{ u"Invalid aggregate value: often"_s };
+    QTest::addRow("invalid-time-format")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--time-format"_s, u"julian"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << (quint64)0 << max << (quint64)0
+        << QStringList{ u"Unknown time format: julian"_s };
+    QTest::addRow("invalid-workers")
+        << QStringList{ u"--archive"_s, u"{dir}/archives/b.bin"_s, u"--workers"_s, u"-1"_s }
+        << QStringList{ u"{dir}/archives/b.bin"_s } << (quint64)0 << max << (quint64)0
+        << QStringList{ u"Invalid workers value: -1"_s };
+}
+
+void TestQueryCommand::processOptions()
+{
+    QFETCH(QStringList, arguments);
+    QFETCH(QStringList, expectedArchives);
+    QFETCH(quint64, expectedFrom);
+    QFETCH(quint64, expectedTo);
+    QFETCH(quint64, expectedWidth);
+    QFETCH(QStringList, expectedErrors);
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    arguments = withDir(arguments, dir.path());
+    arguments.prepend(u"dokit"_s); // The first argument is always the app name.
+
+    QCommandLineParser parser;
+    parser.addOption({u"aggregate"_s, u"description"_s, u"period"_s});
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"from"_s, u"description"_s, u"time"_s});
+    parser.addOption({u"time-format"_s, u"description"_s, u"format"_s});
+    parser.addOption({u"to"_s, u"description"_s, u"time"_s});
+    parser.addOption({u"workers"_s, u"description"_s, u"count"_s});
+    parser.process(arguments);
+
+    QueryCommand command(this);
+    QCOMPARE(command.processOptions(parser), withDir(expectedErrors, dir.path()));
+    QStringList archives;
+    for (const auto &item: command.queries) {
+        archives.append(item.archive);
+    }
+    QCOMPARE(archives, withDir(expectedArchives, dir.path()));
+    QCOMPARE(command.from, expectedFrom);
+    QCOMPARE(command.to, expectedTo);
+    QCOMPARE(command.bucketWidth, expectedWidth);
+}
+
+void TestQueryCommand::start()
+{
+    const OutputStreamCapture capture(&std::cout);
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    QCommandLineParser parser;
+    parser.addOption({u"archive"_s, u"description"_s, u"file"_s});
+    parser.addOption({u"workers"_s, u"description"_s, u"count"_s});
+    parser.process(QStringList{ u"dokit"_s, u"--archive"_s, dir.filePath(u"archives"_s), u"--workers"_s, u"2"_s });
+
+    QueryCommand command;
+    QCOMPARE(command.processOptions(parser), QStringList{});
+    QVERIFY(command.start());
+    QVERIFY(command.workers);
+    QCOMPARE(command.workers->threadCount(), 2);
+    QTRY_COMPARE(command.finished, 2);
+    for (const auto &item: command.queries) {
+        QVERIFY2(item.error.isEmpty(), qUtf8Printable(item.error));
+        QCOMPARE(item.series.size(), 1);
+    }
+    QCOMPARE(command.queries.at(0).sessions, (qsizetype)2);
+    QCOMPARE(command.queries.at(0).series.at(0).total.count, (quint64)5);
+    QCOMPARE(command.queries.at(1).sessions, (qsizetype)1);
+    QCOMPARE(command.queries.at(1).series.at(0).total.count, (quint64)1);
+}
+
+void TestQueryCommand::queryFinished()
+{
+    const OutputStreamCapture capture(&std::cout);
+    QueryCommand command;
+    command.queries.append({ u"a.bin"_s, QString(), 0, { } });
+    command.queries.append({ u"b.bin"_s, u"Disk error"_s, 0, { } });
+    command.queryFinished(1);
+    QCOMPARE(command.finished, 1);
+
+    // The last query to finish reports the number that failed.
+    QTest::ignoreMessage(QtWarningMsg, "Failed to query b.bin: Disk error");
+    QTest::ignoreMessage(QtWarningMsg, "Failed to query 1 of 2 archive(s).");
+    command.queryFinished(0);
+    QCOMPARE(command.finished, 2);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), QByteArray()); // Neither had any results.
+}
+
+void TestQueryCommand::outputResults_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<quint64>("bucketWidth");
+    QTest::addColumn<bool>("epochTimestamps");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("csv") << AbstractCommand::OutputFormat::Csv << (quint64)0 << false << QByteArray(
+        "start,end,archive,mode,count,minimum,maximum,mean,unit\n"
+        "2023-11-14T22:13:20.000Z,2023-11-14T22:24:20.000Z,a.bin,DC voltage,5,0.5,2.5,1.5,Vdc\n");
+    QTest::addRow("csv-buckets") << AbstractCommand::OutputFormat::Csv << (quint64)600000 << false << QByteArray(
+        "start,end,archive,mode,count,minimum,maximum,mean,unit\n"
+        "2023-11-14T22:10:00.000Z,2023-11-14T22:20:00.000Z,a.bin,DC voltage,3,0.5,1.5,1,Vdc\n"
+        "2023-11-14T22:20:00.000Z,2023-11-14T22:30:00.000Z,a.bin,DC voltage,2,2,2.5,2.25,Vdc\n");
+    QTest::addRow("ndjson") << AbstractCommand::OutputFormat::Ndjson << (quint64)0 << true << QByteArray(
+        R"({"archive":"a.bin","count":5,"end":1700000660000,"maximum":2.5,"mean":1.5,"minimum":0.5,)"
+        R"("mode":"DC voltage","start":1700000000000,"unit":"Vdc"})" "\n");
+    QTest::addRow("text") << AbstractCommand::OutputFormat::Text << (quint64)0 << false << QByteArray(
+        "2023-11-14T22:13:20.000Z 2023-11-14T22:24:20.000Z a.bin DC voltage count=5 min=0.5 max=2.5 mean=1.5 Vdc\n");
+}
+
+void TestQueryCommand::outputResults()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(quint64, bucketWidth);
+    QFETCH(bool, epochTimestamps);
+    QFETCH(QByteArray, expected);
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    const OutputStreamCapture capture(&std::cout);
+    QueryCommand command;
+    command.format = format;
+    command.bucketWidth = bucketWidth;
+    command.epochTimestamps = epochTimestamps;
+    QueryCommand::Query item{ dir.filePath(u"archives/a.bin"_s), QString(), 0, { } };
+    QCOMPARE(QueryCommand::query(item.archive, 0, std::numeric_limits<quint64>::max(), bucketWidth, item.sessions,
+                                 item.series), QString());
+    command.queries.append(item);
+    command.queries.append({ u"failed.bin"_s, u"Disk error"_s, 0, { } }); // Has no results to output.
+    command.outputResults();
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
+void TestQueryCommand::parseTime_data()
+{
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<bool>("expectedOk");
+    QTest::addColumn<quint64>("expected");
+
+    QTest::addRow("zero")        << u"0"_s                            << true  << (quint64)0;
+    QTest::addRow("epoch")       << u" 1700000000000 "_s              << true  << (quint64)1700000000000;
+    QTest::addRow("utc")         << u"2023-11-14T22:13:20Z"_s         << true  << (quint64)1700000000000;
+    QTest::addRow("utc-ms")      << u"2023-11-14T22:13:20.250Z"_s     << true  << (quint64)1700000000250;
+    QTest::addRow("offset")      << u"2023-11-15T08:13:20+10:00"_s    << true  << (quint64)1700000000000;
+    QTest::addRow("empty")       << QString()                         << false << (quint64)0;
+    QTest::addRow("negative")    << u"-1"_s                           << false << (quint64)0;
+    QTest::addRow("words")       << u"yesterday"_s                    << false << (quint64)0;
+    QTest::addRow("pre-epoch")   << u"1969-12-31T23:59:59Z"_s         << false << (quint64)0;
+}
+
+void TestQueryCommand::parseTime()
+{
+    QFETCH(QString, value);
+    QFETCH(bool, expectedOk);
+    QFETCH(quint64, expected);
+    quint64 msecs = 0;
+    QCOMPARE(QueryCommand::parseTime(value, msecs), expectedOk);
+    QCOMPARE(msecs, expected);
+}
+
+void TestQueryCommand::query_data()
+{
+    QTest::addColumn<quint64>("from");
+    QTest::addColumn<quint64>("to");
+    QTest::addColumn<quint64>("width");
+    QTest::addColumn<qsizetype>("expectedSessions");
+    QTest::addColumn<quint64>("expectedCount");
+    QTest::addColumn<double>("expectedSum");
+    QTest::addColumn<QVector<quint64>>("expectedStarts");
+
+    // Archive a.bin has samples { 1, 2, 3 } (scaled by 0.5) from 1,700,000,000s, at 60s intervals, and { 4, 5 } from
+    // 600s later.
+    const quint64 max = std::numeric_limits<quint64>::max();
+    QTest::addRow("all") << (quint64)0 << max << (quint64)0
+        << (qsizetype)2 << (quint64)5 << 7.5 << QVector<quint64>{ };
+    QTest::addRow("partial") << (quint64)1700000060000 << (quint64)1700000600000 << (quint64)0
+        << (qsizetype)2 << (quint64)3 << 4.5 << QVector<quint64>{ };
+    QTest::addRow("first") << (quint64)0 << (quint64)1700000300000 << (quint64)0
+        << (qsizetype)1 << (quint64)3 << 3.0 << QVector<quint64>{ };
+    QTest::addRow("gap") << (quint64)1700000200000 << (quint64)1700000500000 << (quint64)0
+        << (qsizetype)0 << (quint64)0 << 0.0 << QVector<quint64>{ };
+    QTest::addRow("buckets") << (quint64)0 << max << (quint64)600000
+        << (qsizetype)2 << (quint64)5 << 7.5 << QVector<quint64>{ 1699999800000, 1700000400000 };
+    QTest::addRow("merged-buckets") << (quint64)0 << max << (quint64)3600000
+        << (qsizetype)2 << (quint64)5 << 7.5 << QVector<quint64>{ 1699999200000 };
+}
+
+void TestQueryCommand::query()
+{
+    QFETCH(quint64, from);
+    QFETCH(quint64, to);
+    QFETCH(quint64, width);
+    QFETCH(qsizetype, expectedSessions);
+    QFETCH(quint64, expectedCount);
+    QFETCH(double, expectedSum);
+    QFETCH(QVector<quint64>, expectedStarts);
+
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    qsizetype sessions = -1;
+    QVector<QueryCommand::Series> series;
+    QCOMPARE(QueryCommand::query(dir.filePath(u"archives/a.bin"_s), from, to, width, sessions, series), QString());
+    QCOMPARE(sessions, expectedSessions);
+    QCOMPARE(series.size(), (expectedCount == 0) ? 0 : 1);
+    if (series.isEmpty()) {
+        return;
+    }
+    QCOMPARE(series.at(0).mode, DataLoggerService::Mode::DcVoltage);
+    QCOMPARE(series.at(0).total.count, expectedCount);
+    QCOMPARE(series.at(0).total.sum, expectedSum);
+    QVector<quint64> starts;
+    quint64 bucketsCount = 0;
+    for (const LoggerArchive::Bucket &bucket: series.at(0).buckets) {
+        starts.append(bucket.start);
+        bucketsCount += bucket.aggregate.count;
+    }
+    QCOMPARE(starts, expectedStarts);
+    if (width > 0) {
+        QCOMPARE(bucketsCount, expectedCount);
+    }
+}
+
+void TestQueryCommand::query_modes()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString archive = dir.filePath(u"mixed.bin"_s);
+    DataLoggerService::Metadata current = testMetadata;
+    current.mode = DataLoggerService::Mode::AcCurrent;
+    QVERIFY(appendSession(archive, current, 0, { 1, 2, 3 }));
+    QVERIFY(appendSession(archive, testMetadata, 60, { 10, 20 })); // DC voltage, overlapping the first run.
+    QVERIFY(appendSession(archive, current, 600, { 4 }));
+
+    qsizetype sessions = -1;
+    QVector<QueryCommand::Series> series;
+    QCOMPARE(QueryCommand::query(archive, 0, std::numeric_limits<quint64>::max(), 0, sessions, series), QString());
+    QCOMPARE(sessions, (qsizetype)3);
+    QCOMPARE(series.size(), 2); // In mode order.
+    QCOMPARE(series.at(0).mode, DataLoggerService::Mode::DcVoltage);
+    QCOMPARE(series.at(0).total.count, (quint64)2);
+    QCOMPARE(series.at(0).total.minimum, 5.0f);
+    QCOMPARE(series.at(0).total.maximum, 10.0f);
+    QCOMPARE(series.at(1).mode, DataLoggerService::Mode::AcCurrent);
+    QCOMPARE(series.at(1).total.count, (quint64)4);
+    QCOMPARE(series.at(1).total.minimum, 0.5f);
+    QCOMPARE(series.at(1).total.maximum, 2.0f);
+    QCOMPARE(series.at(1).total.firstTimestamp, (quint64)1700000000000);
+    QCOMPARE(series.at(1).total.lastTimestamp, (quint64)1700000600000);
+}
+
+void TestQueryCommand::query_rollup()
+{
+    // Ten minutes of samples, at 1s intervals, from 20s past the minute.
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString archive = dir.filePath(u"dense.bin"_s);
+    DataLoggerService::Metadata metadata = testMetadata;
+    metadata.updateInterval = 1000;
+    DataLoggerService::Samples samples;
+    for (int index = 0; index < 600; ++index) {
+        samples.append((qint16)((index % 50) - 25));
+    }
+    {
+        LoggerArchive source(archive);
+        QVERIFY(source.append(metadata, samples));
+    }
+
+    // Query ranges that are: unbounded, within a single minute, and spanning whole and partial minutes.
+    const quint64 max = std::numeric_limits<quint64>::max();
+    const QVector<std::array<quint64, 3>> ranges {
+        { 0, max, 0 }, { 0, max, 120000 },
+        { 1700000030500, 1700000050000, 0 },
+        { 1700000030500, 1700000500250, 0 }, { 1700000030500, 1700000500250, 5000 },
+        { 1700000030500, 1700000500250, 120000 }, { 1700000040000, 1700000519999, 60000 },
+    };
+    QVector<QVector<QueryCommand::Series>> expected;
+    for (const auto &[from, to, width]: ranges) {
+        qsizetype sessions = -1;
+        expected.append(QVector<QueryCommand::Series>{});
+        QCOMPARE(QueryCommand::query(archive, from, to, width, sessions, expected.last()), QString());
+        QCOMPARE(sessions, (qsizetype)1);
+    }
+
+    // Querying via the rollup's tiers should give the same results as scanning the archive.
+    {
+        LoggerArchive source(archive);
+        QVERIFY(source.open());
+        LoggerRollup rollup(LoggerRollup::fileNameFor(archive));
+        QVERIFY(rollup.build(source));
+        QVERIFY(rollup.open(source));
+        QCOMPARE(rollup.tiers(metadata.mode), (QVector<quint64>{ 60000, 3600000 }));
+    }
+    for (qsizetype index = 0; index < ranges.size(); ++index) {
+        const auto &[from, to, width] = ranges.at(index);
+        qsizetype sessions = -1;
+        QVector<QueryCommand::Series> series;
+        QCOMPARE(QueryCommand::query(archive, from, to, width, sessions, series), QString());
+        QCOMPARE(sessions, (qsizetype)1);
+        QCOMPARE(series.size(), expected.at(index).size());
+        for (qsizetype mode = 0; mode < series.size(); ++mode) {
+            const QueryCommand::Series &actual = series.at(mode), &scanned = expected.at(index).at(mode);
+            QCOMPARE(actual.total.count,          scanned.total.count);
+            QCOMPARE(actual.total.minimum,        scanned.total.minimum);
+            QCOMPARE(actual.total.maximum,        scanned.total.maximum);
+            QCOMPARE(actual.total.sum,            scanned.total.sum);
+            QCOMPARE(actual.total.firstTimestamp, scanned.total.firstTimestamp);
+            QCOMPARE(actual.total.lastTimestamp,  scanned.total.lastTimestamp);
+            QCOMPARE(actual.buckets.size(), scanned.buckets.size());
+            for (qsizetype bucket = 0; bucket < actual.buckets.size(); ++bucket) {
+                QCOMPARE(actual.buckets.at(bucket).start,           scanned.buckets.at(bucket).start);
+                QCOMPARE(actual.buckets.at(bucket).aggregate.count, scanned.buckets.at(bucket).aggregate.count);
+                QCOMPARE(actual.buckets.at(bucket).aggregate.sum,   scanned.buckets.at(bucket).aggregate.sum);
+            }
+        }
+    }
+}
+
+void TestQueryCommand::query_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createArchives(dir));
+    const QString notes = dir.filePath(u"archives/notes.txt"_s);
+    qsizetype sessions = -1;
+    QVector<QueryCommand::Series> series;
+    QTest::ignoreMessage(QtWarningMsg, qUtf8Printable(u"Failed to read archive %1"_s.arg(notes)));
+    QCOMPARE(QueryCommand::query(notes, 0, std::numeric_limits<quint64>::max(), 0, sessions, series),
+             u"Invalid, or unreadable, archive"_s);
+    QCOMPARE(sessions, (qsizetype)-1);
+    QVERIFY(series.isEmpty());
+}
+
+void TestQueryCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    QueryCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestQueryCommand)
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestQueryCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+    void supportedOptions();
+
+    void processOptions_data();
+    void processOptions();
+
+    void start();
+
+    void queryFinished();
+
+    void outputResults_data();
+    void outputResults();
+
+    void parseTime_data();
+    void parseTime();
+
+    void query_data();
+    void query();
+    void query_modes();
+    void query_rollup();
+    void query_invalid();
+
+    void tr();
+};
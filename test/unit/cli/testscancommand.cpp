@@ -62,7 +62,10 @@ void TestScanCommand::supportedOptions()
     BaseCommand base;
     ScanCommand command(this);
     QCommandLineParser parser;
-    QCOMPARE(command.supportedOptions(parser), base.supportedOptions(parser));
+    QCOMPARE(command.supportedOptions(parser), base.supportedOptions(parser) + QStringList{
+        u"interval"_s,
+        u"watch"_s,
+    });
 }
 
 void TestScanCommand::processOptions()
@@ -72,6 +75,57 @@ void TestScanCommand::processOptions()
     QCOMPARE(command.processOptions(parser), QStringList{});
 }
 
+void TestScanCommand::processOptions_watch()
+{
+    const auto process = [](const QStringList &arguments, ScanCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"timeout"_s, u"description"_s, u"period"_s});
+        parser.addOption({u"watch"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {   // Watching defaults to NDJSON output, every 5 seconds, until interrupted.
+        ScanCommand command(this);
+        QCOMPARE(process({ u"--watch"_s }, command), QStringList{});
+        QCOMPARE(command.watch, true);
+        QCOMPARE(command.format, AbstractCommand::OutputFormat::Ndjson);
+        QCOMPARE(command.refreshInterval, (quint32)5000);
+        QCOMPARE(command.watchTimeout, (quint32)0);
+    }
+
+    {   // But an explicit output format, interval and timeout are all respected.
+        ScanCommand command(this);
+        QCOMPARE(process({ u"--watch"_s, u"--output"_s, u"csv"_s, u"--interval"_s, u"2s"_s,
+                           u"--timeout"_s, u"60s"_s }, command), QStringList{});
+        QCOMPARE(command.format, AbstractCommand::OutputFormat::Csv);
+        QCOMPARE(command.refreshInterval, (quint32)2000);
+        QCOMPARE(command.watchTimeout, (quint32)60'000);
+    }
+
+    {   // Without watching, the timeout applies to the scan only, and the output format is unchanged.
+        ScanCommand command(this);
+        QCOMPARE(process({ u"--timeout"_s, u"60s"_s }, command), QStringList{});
+        QCOMPARE(command.watch, false);
+        QCOMPARE(command.format, AbstractCommand::OutputFormat::Text);
+        QCOMPARE(command.watchTimeout, (quint32)0);
+    }
+
+    {   // The interval only applies to watching.
+        ScanCommand command(this);
+        QCOMPARE(process({ u"--interval"_s, u"2s"_s }, command),
+                 QStringList{ u"Missing required option for --interval: --watch"_s });
+    }
+
+    {
+        ScanCommand command(this);
+        QCOMPARE(process({ u"--watch"_s, u"--interval"_s, u"0"_s }, command),
+                 QStringList{ u"Invalid interval value: 0"_s });
+    }
+}
+
 void TestScanCommand::start()
 {
     if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
@@ -163,6 +217,135 @@ void TestScanCommand::deviceDiscoveryFinished()
     command.deviceDiscoveryFinished(); // Just logs a debug message, and exits.
 }
 
+void TestScanCommand::diff()
+{
+    // Give each device both an address and a UUID, since PokitDeviceRegistry::key() uses the latter on macOS.
+    const auto entry = [](const uint index, const QString &name, const qint16 rssi) {
+        QBluetoothDeviceInfo info(QBluetoothAddress((quint64)index), name, 0);
+        info.setDeviceUuid(QBluetoothUuid(QUuid(index, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)));
+        PokitDeviceRegistry::Entry entry;
+        entry.info = info;
+        entry.name = name;
+        entry.rssi = rssi;
+        return entry;
+    };
+    const auto format = [](const QVector<ScanCommand::WatchChange> &changes) {
+        QStringList list;
+        for (const ScanCommand::WatchChange &change: changes) {
+            list.append(u"%1 %2 %3 %4 %5 %6"_s.arg(ScanCommand::toString(change.event), change.device, change.name)
+                .arg(change.rssi).arg(change.previousName).arg(change.previousRssi));
+        }
+        return list;
+    };
+    const QString key1 = PokitDeviceRegistry::key(entry(1, QString(), 0).info);
+    const QString key2 = PokitDeviceRegistry::key(entry(2, QString(), 0).info);
+    QVERIFY(key1 < key2);
+
+    QHash<QString, ScanCommand::WatchedDevice> watched;
+    QCOMPARE(format(ScanCommand::diff(watched, { })), QStringList{});
+    QCOMPARE(format(ScanCommand::diff(watched, { entry(2, u"two"_s, -70), entry(1, u"one"_s, -60) })), QStringList({
+        u"appeared %1 one -60  0"_s.arg(key1),
+        u"appeared %1 two -70  0"_s.arg(key2),
+    }));
+    QCOMPARE(watched.size(), 2);
+
+    // Nothing has changed significantly, so nothing to report.
+    QCOMPARE(format(ScanCommand::diff(watched, { entry(1, u"one"_s, -69), entry(2, u"two"_s, -61) })), QStringList{});
+    QCOMPARE(watched.value(key1).rssi, (qint16)-60);
+
+    // Small changes accumulate, relative to the last reported RSSI.
+    QCOMPARE(format(ScanCommand::diff(watched, { entry(1, u"one"_s, -70), entry(2, u"to"_s, -61) })), QStringList({
+        u"rssi %1 one -70  -60"_s.arg(key1),
+        u"renamed %1 to -61 two 0"_s.arg(key2),
+    }));
+    QCOMPARE(watched.value(key1).rssi, (qint16)-70);
+    QCOMPARE(watched.value(key2).name, u"to"_s);
+
+    QCOMPARE(format(ScanCommand::diff(watched, { entry(1, u"one"_s, -70) })), QStringList({
+        u"disappeared %1 to -70  0"_s.arg(key2),
+    }));
+    QCOMPARE(watched.size(), 1);
+
+    // Devices may re-appear.
+    QCOMPARE(format(ScanCommand::diff(watched, { entry(2, u"to"_s, -50), entry(1, u"one"_s, -70) })), QStringList({
+        u"appeared %1 to -50  0"_s.arg(key2),
+    }));
+}
+
+void TestScanCommand::outputChanges_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("csv") << AbstractCommand::OutputFormat::Csv << QByteArray(
+        "timestamp,event,device,name,signal_strength,previous_name,previous_signal_strength\n"
+        "1234567,appeared,dev1,Pokit Meter,-60,,\n"
+        "1234567,renamed,dev2,Lab Pro,-70,\"Pro, Old\",\n"
+        "1234567,rssi,dev1,Pokit Meter,-75,,-60\n"
+        "1234567,disappeared,dev3,Old,-80,,\n");
+    QTest::addRow("json") << AbstractCommand::OutputFormat::Json << QByteArray(
+        "{\n"
+        "    \"device\": \"dev1\",\n"
+        "    \"event\": \"appeared\",\n"
+        "    \"name\": \"Pokit Meter\",\n"
+        "    \"rssi\": -60,\n"
+        "    \"timestamp\": 1234567\n"
+        "}\n"
+        "{\n"
+        "    \"device\": \"dev2\",\n"
+        "    \"event\": \"renamed\",\n"
+        "    \"name\": \"Lab Pro\",\n"
+        "    \"previousName\": \"Pro, Old\",\n"
+        "    \"rssi\": -70,\n"
+        "    \"timestamp\": 1234567\n"
+        "}\n"
+        "{\n"
+        "    \"device\": \"dev1\",\n"
+        "    \"event\": \"rssi\",\n"
+        "    \"name\": \"Pokit Meter\",\n"
+        "    \"previousRssi\": -60,\n"
+        "    \"rssi\": -75,\n"
+        "    \"timestamp\": 1234567\n"
+        "}\n"
+        "{\n"
+        "    \"device\": \"dev3\",\n"
+        "    \"event\": \"disappeared\",\n"
+        "    \"name\": \"Old\",\n"
+        "    \"rssi\": -80,\n"
+        "    \"timestamp\": 1234567\n"
+        "}\n");
+    QTest::addRow("ndjson") << AbstractCommand::OutputFormat::Ndjson << QByteArray(
+        R"({"device":"dev1","event":"appeared","name":"Pokit Meter","rssi":-60,"timestamp":1234567})" "\n"
+        R"({"device":"dev2","event":"renamed","name":"Lab Pro","previousName":"Pro, Old","rssi":-70,)"
+        R"("timestamp":1234567})" "\n"
+        R"({"device":"dev1","event":"rssi","name":"Pokit Meter","previousRssi":-60,"rssi":-75,"timestamp":1234567})"
+        "\n"
+        R"({"device":"dev3","event":"disappeared","name":"Old","rssi":-80,"timestamp":1234567})" "\n");
+    QTest::addRow("text") << AbstractCommand::OutputFormat::Text << QByteArray(
+        "appeared dev1 Pokit Meter -60\n"
+        "renamed dev2 Lab Pro -70 (was Pro, Old)\n"
+        "rssi dev1 Pokit Meter -75 (was -60)\n"
+        "disappeared dev3 Old -80\n");
+}
+
+void TestScanCommand::outputChanges()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(QByteArray, expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    ScanCommand command;
+    command.format = format;
+    command.outputChanges({
+        { ScanCommand::WatchEvent::Appeared,    u"dev1"_s, u"Pokit Meter"_s, -60, QString(), 0 },
+        { ScanCommand::WatchEvent::Renamed,     u"dev2"_s, u"Lab Pro"_s, -70, u"Pro, Old"_s, 0 },
+        { ScanCommand::WatchEvent::RssiChanged, u"dev1"_s, u"Pokit Meter"_s, -75, QString(), -60 },
+        { ScanCommand::WatchEvent::Disappeared, u"dev3"_s, u"Old"_s, -80, QString(), 0 },
+    }, 1'234'567);
+    command.outputChanges({ }, 1'234'568); // No changes, so no output (not even a CSV header).
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
 void TestScanCommand::toJson_info_data()
 {
     QTest::addColumn<QBluetoothDeviceInfo>("info");
@@ -13,6 +13,7 @@ private slots:
     void supportedOptions();
 
     void processOptions();
+    void processOptions_watch();
 
     void start();
 
@@ -24,6 +25,11 @@ private slots:
 
     void deviceDiscoveryFinished();
 
+    void diff();
+
+    void outputChanges_data();
+    void outputChanges();
+
     void toJson_info_data();
     void toJson_info();
 
@@ -0,0 +1,281 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsessioncommand.h"
+#include "../stringliterals_p.h"
+
+#include "sessioncommand.h"
+
+#include <QFile>
+#include <QTemporaryFile>
+
+DOKIT_USE_STRINGLITERALS
+
+class MockDeviceCommand : public DeviceCommand
+{
+public:
+    explicit MockDeviceCommand(QObject * const parent = nullptr) : DeviceCommand(parent)
+    {
+
+    }
+
+    AbstractPokitService * getService() override
+    {
+        return nullptr;
+    }
+
+    QStringList processOptions(const QCommandLineParser &parser) override
+    {
+        return (parser.value(u"mode"_s) == u"bad"_s) ? QStringList{ u"Unknown meter mode: bad"_s } : QStringList{};
+    }
+};
+
+void TestSessionCommand::requiredOptions()
+{
+    SessionCommand command(this);
+    MockDeviceCommand mock;
+    QCommandLineParser parser;
+    const QStringList expected = mock.requiredOptions(parser);
+    QCOMPARE(command.requiredOptions(parser), expected);
+}
+
+void TestSessionCommand::supportedOptions()
+{
+    SessionCommand command(this);
+    MockDeviceCommand mock;
+    QCommandLineParser parser;
+    const QStringList expected = command.requiredOptions(parser) + mock.supportedOptions(parser) + QStringList{
+        u"script"_s,
+    };
+    QCOMPARE(command.supportedOptions(parser), expected);
+}
+
+void TestSessionCommand::processOptions_script()
+{
+    QTemporaryFile script;
+    QVERIFY(script.open());
+    script.write("status\n");
+    script.close();
+
+    QCommandLineParser parser;
+    parser.addOptions({
+        {u"script"_s, u"description"_s, u"file"_s},
+    });
+
+    {
+        SessionCommand command(this);
+        parser.process(QStringList{ u"app"_s, u"session"_s, u"--script"_s, script.fileName() });
+        QCOMPARE(command.processOptions(parser), QStringList{});
+        QCOMPARE(command.scriptFileName, script.fileName());
+        QVERIFY(command.input);
+        QCOMPARE(command.scriptServices, PokitDevice::Services(PokitDevice::Service::Status));
+        QCOMPARE(command.input->readLine(), QByteArray("status\n")); // Still read from the start.
+        QVERIFY(!command.notifier); // Scripts are read directly, as fast as their commands run.
+        QVERIFY(!command.interactive);
+    }
+
+    {
+        SessionCommand command(this);
+        const QString fileName = script.fileName() + u".missing"_s;
+        parser.process(QStringList{ u"app"_s, u"session"_s, u"--script"_s, fileName });
+        const QStringList errors = command.processOptions(parser);
+        QCOMPARE(errors.size(), 1);
+        QVERIFY(errors.constFirst().startsWith(u"Failed to open script %1: "_s.arg(fileName)));
+    }
+}
+
+void TestSessionCommand::getService()
+{
+    // Unable to safely invoke SessionCommand::getService() without a valid Bluetooth device.
+}
+
+void TestSessionCommand::usesDiscoveredValues()
+{
+    SessionCommand command(this);
+    QVERIFY(command.usesDiscoveredValues());
+}
+
+void TestSessionCommand::servicesPrepared()
+{
+    // Unable to safely invoke SessionCommand::servicesPrepared() without a valid, connected, device.
+}
+
+void TestSessionCommand::sessionOptions()
+{
+    // Every option that configures the device connection must apply to the whole session.
+    const QStringList options = SessionCommand::sessionOptions();
+    for (const QString &option: { u"connection-profile"_s, u"device"_s, u"device-thread"_s, u"discovery-cache"_s,
+                                  u"known-devices"_s, u"link-statistics"_s, u"reconnect"_s, u"record"_s }) {
+        QVERIFY2(options.contains(option), qUtf8Printable(option));
+    }
+    QVERIFY(options.contains(u"script"_s));
+}
+
+void TestSessionCommand::servicesOf_command()
+{
+    QCOMPARE(SessionCommand::servicesOf(u"dso"_s), PokitDevice::Services(PokitDevice::Service::Dso));
+    QCOMPARE(SessionCommand::servicesOf(u"logger-tail"_s), PokitDevice::Services(PokitDevice::Service::DataLogger));
+    QCOMPARE(SessionCommand::servicesOf(u"set-torch"_s), PokitDevice::Services(PokitDevice::Service::Status));
+    QCOMPARE(SessionCommand::servicesOf(u"quit"_s), PokitDevice::Services());
+    QCOMPARE(SessionCommand::servicesOf(QString()), PokitDevice::Services());
+}
+
+void TestSessionCommand::servicesOf_script()
+{
+    SessionCommand command(this);
+    command.setCommandFactory([](QCommandLineParser &parser) {
+        parser.addOptions({
+            {u"mode"_s, u"description"_s, u"mode"_s},
+            {u"output"_s, u"description"_s, u"format"_s},
+        });
+    }, nullptr);
+    const QByteArray script(
+        "# A comment, then a blank line.\n"
+        "\n"
+        "meter --mode Vdc\n"
+        "--output csv dso --mode Vdc # Options may precede the command.\n"
+        "info --unknown\n"
+        "logger-fetch 'unterminated\n"
+        "quit\n");
+    QCOMPARE(command.servicesOf(script), PokitDevice::Service::Dso|PokitDevice::Service::Multimeter);
+    QCOMPARE(command.servicesOf(QByteArray()), PokitDevice::Services());
+}
+
+void TestSessionCommand::runCommand_data()
+{
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<bool>("interactive");
+    QTest::addColumn<QStringList>("expectedCreated");
+    QTest::addColumn<int>("expectedFailures");
+    QTest::addColumn<bool>("expectedEnding");
+
+    QTest::addRow("blank")             << u"\n"_s                    << true  << QStringList{} << 0 << false;
+    QTest::addRow("comment")           << u"  # A comment.\n"_s      << true  << QStringList{} << 0 << false;
+    QTest::addRow("quit")              << u"quit\n"_s                << true  << QStringList{} << 0 << true;
+    QTest::addRow("exit")              << u" exit "_s                << true  << QStringList{} << 0 << true;
+    QTest::addRow("unterminated")      << u"mock --mode 'Vdc\n"_s    << true  << QStringList{} << 1 << false;
+    QTest::addRow("unknown-option")    << u"mock --bogus\n"_s        << true  << QStringList{} << 1 << false;
+    QTest::addRow("session-option")    << u"mock --device abc\n"_s   << true  << QStringList{} << 1 << false;
+    QTest::addRow("missing-command")   << u"--mode Vdc\n"_s          << true  << QStringList{} << 1 << false;
+    QTest::addRow("multiple-commands") << u"mock mock\n"_s           << true  << QStringList{} << 1 << false;
+    QTest::addRow("unknown-command")   << u"scan\n"_s                << true  << QStringList{ u"scan"_s } << 1 << false;
+    QTest::addRow("options-error")     << u"mock --mode bad\n"_s     << true  << QStringList{ u"mock"_s } << 1 << false;
+    QTest::addRow("non-interactive")   << u"scan\n"_s                << false << QStringList{ u"scan"_s } << 1 << true;
+}
+
+void TestSessionCommand::runCommand()
+{
+    QFETCH(QString, line);
+    QFETCH(bool, interactive);
+    QFETCH(QStringList, expectedCreated);
+    QFETCH(int, expectedFailures);
+    QFETCH(bool, expectedEnding);
+
+    QStringList created;
+    SessionCommand command(this);
+    command.interactive = interactive;
+    command.setCommandFactory(
+        [](QCommandLineParser &parser) {
+            parser.addOptions({
+                {{u"d"_s, u"device"_s}, u"description"_s, u"device"_s},
+                {u"mode"_s, u"description"_s, u"mode"_s},
+                {u"reconnect"_s, u"description"_s, u"attempts"_s},
+            });
+        },
+        [&created](const QString &name, QObject * const parent) -> DeviceCommand * {
+            created.append(name);
+            return (name == u"mock"_s) ? new MockDeviceCommand(parent) : nullptr;
+        });
+    command.runCommand(line);
+    QCOMPARE(created, expectedCreated);
+    QCOMPARE(command.failures, expectedFailures);
+    QCOMPARE(command.ending, expectedEnding);
+    QVERIFY(!command.current); // No row gets as far as starting a command.
+}
+
+void TestSessionCommand::commandFailed_data()
+{
+    QTest::addColumn<bool>("interactive");
+    QTest::addColumn<bool>("expectedEnding");
+    QTest::addRow("script")      << false << true;
+    QTest::addRow("interactive") << true  << false;
+}
+
+void TestSessionCommand::commandFailed()
+{
+    QFETCH(bool, interactive);
+    QFETCH(bool, expectedEnding);
+
+    SessionCommand command(this);
+    command.interactive = interactive;
+    command.commandFailed(u"ignored"_s);
+    QCOMPARE(command.failures, 1);
+    QCOMPARE(command.ending, expectedEnding);
+    command.commandFailed(u"ignored"_s);
+    QCOMPARE(command.failures, 2);
+    QCOMPARE(command.ending, expectedEnding);
+}
+
+void TestSessionCommand::endSession()
+{
+    SessionCommand command(this);
+    QVERIFY(!command.ending);
+    command.endSession();
+    QVERIFY(command.ending);
+    command.endSession(); // Ignored, since the session has already ended.
+    QVERIFY(command.ending);
+}
+
+void TestSessionCommand::splitArguments_data()
+{
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<QStringList>("expected");
+    QTest::addColumn<bool>("expectError");
+
+    QTest::addRow("empty") << QString() << QStringList{} << false;
+    QTest::addRow("whitespace") << u" \t\n"_s << QStringList{} << false;
+    QTest::addRow("simple") << u"meter --mode Vdc"_s
+        << QStringList{ u"meter"_s, u"--mode"_s, u"Vdc"_s } << false;
+    QTest::addRow("padded") << u"  meter\t--mode   Vdc \r\n"_s
+        << QStringList{ u"meter"_s, u"--mode"_s, u"Vdc"_s } << false;
+    QTest::addRow("single-quotes") << u"set-name --new-name 'My \"Meter\"'"_s
+        << QStringList{ u"set-name"_s, u"--new-name"_s, u"My \"Meter\""_s } << false;
+    QTest::addRow("double-quotes") << uR"(set-name --new-name "My \"Big\" \\Meter\!")"_s
+        << QStringList{ u"set-name"_s, u"--new-name"_s, uR"(My "Big" \Meter\!)"_s } << false;
+    QTest::addRow("escaped-space") << uR"(set-name --new-name My\ Meter)"_s
+        << QStringList{ u"set-name"_s, u"--new-name"_s, u"My Meter"_s } << false;
+    QTest::addRow("adjacent-quotes") << uR"(--new-name=My' '"Meter")"_s
+        << QStringList{ u"--new-name=My Meter"_s } << false;
+    QTest::addRow("empty-quotes") << u"meter '' \"\""_s
+        << QStringList{ u"meter"_s, QString(), QString() } << false;
+    QTest::addRow("comment") << u"meter # --mode Vdc"_s
+        << QStringList{ u"meter"_s } << false;
+    QTest::addRow("hash-within") << u"set-name --new-name Meter#1"_s
+        << QStringList{ u"set-name"_s, u"--new-name"_s, u"Meter#1"_s } << false;
+    QTest::addRow("quoted-hash") << u"set-name --new-name '#1'"_s
+        << QStringList{ u"set-name"_s, u"--new-name"_s, u"#1"_s } << false;
+    QTest::addRow("trailing-backslash") << uR"(meter \)"_s
+        << QStringList{ u"meter"_s, uR"(\)"_s } << false;
+    QTest::addRow("unterminated-single") << u"meter --mode 'Vdc"_s << QStringList{} << true;
+    QTest::addRow("unterminated-double") << u"meter --mode \"Vdc"_s << QStringList{} << true;
+}
+
+void TestSessionCommand::splitArguments()
+{
+    QFETCH(QString, line);
+    QFETCH(QStringList, expected);
+    QFETCH(bool, expectError);
+    QString error;
+    QCOMPARE(SessionCommand::splitArguments(line, error), expected);
+    QCOMPARE(!error.isEmpty(), expectError);
+}
+
+void TestSessionCommand::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    SessionCommand command;
+    QVERIFY(!command.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestSessionCommand)
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestSessionCommand : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void requiredOptions();
+
+    void supportedOptions();
+
+    void processOptions_script();
+
+    void getService();
+    void usesDiscoveredValues();
+
+    void servicesPrepared();
+
+    void sessionOptions();
+
+    void servicesOf_command();
+    void servicesOf_script();
+
+    void runCommand_data();
+    void runCommand();
+
+    void commandFailed_data();
+    void commandFailed();
+
+    void endSession();
+
+    void splitArguments_data();
+    void splitArguments();
+
+    void tr();
+};
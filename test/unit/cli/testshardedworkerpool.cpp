@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testshardedworkerpool.h"
+
+#include "shardedworkerpool.h"
+
+#include <QSignalSpy>
+#include <QThread>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+void TestShardedWorkerPool::threadCount()
+{
+    QCOMPARE(ShardedWorkerPool(3).threadCount(), 3);
+    QCOMPARE(ShardedWorkerPool(0).threadCount(), QThread::idealThreadCount());
+    QCOMPARE(ShardedWorkerPool(-1).threadCount(), QThread::idealThreadCount());
+}
+
+void TestShardedWorkerPool::submit()
+{
+    ShardedWorkerPool pool(2);
+    QSignalSpy spy(&pool, &ShardedWorkerPool::outputReady);
+    pool.submit(7, []() { return QByteArray("seven"); });
+    QTRY_COMPARE(spy.count(), 1); // Delivered asynchronously, via the event loop.
+    QCOMPARE(spy.at(0).at(0).toInt(), 7);
+    QCOMPARE(spy.at(0).at(1).toByteArray(), QByteArray("seven"));
+
+    const ShardedWorkerPool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.submitted, (quint64)1);
+    QCOMPARE(stats.completed, (quint64)1);
+    QCOMPARE(stats.delivered, (quint64)1);
+    QCOMPARE(stats.maxQueued, (qsizetype)1);
+}
+
+void TestShardedWorkerPool::submit_ordered()
+{
+    // However the shards' outputs interleave, each shard's outputs are delivered in the order submitted.
+    ShardedWorkerPool pool(4);
+    QHash<int, QList<int>> outputs;
+    connect(&pool, &ShardedWorkerPool::outputReady, this, [&outputs](const int shard, const QByteArray &output) {
+        outputs[shard].append(output.toInt());
+    });
+    constexpr int shards = 4, jobs = 250;
+    for (int job = 0; job < jobs; ++job) {
+        for (int shard = 0; shard < shards; ++shard) {
+            pool.submit(shard, [job]() { return QByteArray::number(job); });
+        }
+    }
+    pool.flush();
+    QCOMPARE(outputs.size(), shards);
+    for (int shard = 0; shard < shards; ++shard) {
+        const QList<int> &output = outputs[shard];
+        QCOMPARE(output.size(), jobs);
+        for (int job = 0; job < jobs; ++job) {
+            QCOMPARE(output.at(job), job);
+        }
+    }
+    QCOMPARE(pool.statistics().delivered, (quint64)(shards * jobs));
+}
+
+void TestShardedWorkerPool::submit_concurrent()
+{
+    // Shard 0's job can only finish once shard 1's job has started, so this only completes (without timing out) if
+    // different shards' jobs really are processed concurrently.
+    ShardedWorkerPool pool(2);
+    std::mutex mutex;
+    std::condition_variable started;
+    bool secondStarted = false;
+    std::atomic<bool> timedOut { false };
+    pool.submit(0, [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!started.wait_for(lock, std::chrono::seconds(10), [&]() { return secondStarted; })) {
+            timedOut = true;
+        }
+        return QByteArray("first");
+    });
+    pool.submit(1, [&]() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            secondStarted = true;
+        }
+        started.notify_all();
+        return QByteArray("second");
+    });
+    pool.flush();
+    QVERIFY(!timedOut);
+}
+
+void TestShardedWorkerPool::flush()
+{
+    ShardedWorkerPool pool(2);
+    QSignalSpy spy(&pool, &ShardedWorkerPool::outputReady);
+    for (int job = 0; job < 10; ++job) {
+        pool.submit(job % 3, [job]() { QThread::msleep(1); return QByteArray::number(job); });
+    }
+    pool.flush();
+    QCOMPARE(spy.count(), 10); // Delivered before flush() returned, without any event loop.
+    const ShardedWorkerPool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.submitted, (quint64)10);
+    QCOMPARE(stats.completed, (quint64)10);
+    QCOMPARE(stats.delivered, (quint64)10);
+    QVERIFY(stats.maxQueued >= 1);
+
+    QCoreApplication::processEvents(); // Any deliveries queued meanwhile find nothing (more) to deliver.
+    QCOMPARE(spy.count(), 10);
+}
+
+void TestShardedWorkerPool::flush_empty()
+{
+    ShardedWorkerPool pool(1);
+    QSignalSpy spy(&pool, &ShardedWorkerPool::outputReady);
+    pool.flush();
+    QCOMPARE(spy.count(), 0);
+}
+
+void TestShardedWorkerPool::destroy()
+{
+    std::atomic<int> completed { 0 };
+    {
+        ShardedWorkerPool pool(1);
+        for (int job = 0; job < 100; ++job) {
+            pool.submit(0, [&completed]() { QThread::msleep(1); ++completed; return QByteArray(); });
+        }
+    } // Waits for the current job, but discards the rest.
+    QVERIFY(completed < 100);
+}
+
+void TestShardedWorkerPool::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    ShardedWorkerPool pool(1);
+    QVERIFY(!pool.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestShardedWorkerPool)
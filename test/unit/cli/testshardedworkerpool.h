@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestShardedWorkerPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void threadCount();
+
+    void submit();
+    void submit_ordered();
+    void submit_concurrent();
+
+    void flush();
+    void flush_empty();
+
+    void destroy();
+
+    void tr();
+};
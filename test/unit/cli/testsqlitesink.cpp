@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsqlitesink.h"
+#include "../stringliterals_p.h"
+
+#include "sqlitesink.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+DOKIT_USE_STRINGLITERALS
+
+// Returns the first value of the first row of \a statement's results, via a second connection to \a fileName.
+static QVariant queryValue(const QString &fileName, const QString &statement)
+{
+    const QString connectionName = u"testsqlitesink"_s;
+    QVariant value;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(u"QSQLITE"_s, connectionName);
+        db.setDatabaseName(fileName);
+        if (db.open()) {
+            QSqlQuery query(db);
+            if ((query.exec(statement)) && (query.next())) {
+                value = query.value(0);
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return value;
+}
+
+static const SqliteSink::Session testSession {
+    u"Pokit Pro"_s, u"meter"_s, u"DC voltage"_s, u"Vdc"_s, u"Up to 30V"_s, 1000, 1234567890000
+};
+
+void TestSqliteSink::open()
+{
+    if (!QSqlDatabase::isDriverAvailable(u"QSQLITE"_s)) {
+        QSKIP("The Qt SQLite driver is not available");
+    }
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"samples.db"_s);
+    SqliteSink sink;
+    QVERIFY(!sink.isOpen());
+    QVERIFY(sink.fileName().isNull());
+    QVERIFY(sink.open(fileName));
+    QVERIFY(sink.isOpen());
+    QCOMPARE(sink.fileName(), fileName);
+    QVERIFY(sink.errorString().isEmpty());
+
+    // The journal mode is persistent, so is visible to other connections too.
+    QCOMPARE(queryValue(fileName, u"PRAGMA journal_mode"_s).toString(), u"wal"_s);
+    QCOMPARE(queryValue(fileName, QStringLiteral("SELECT COUNT(*) FROM sqlite_master "
+        "WHERE name IN ('devices', 'sessions', 'samples', 'readings', 'samples_session_timestamp')")).toInt(), 5);
+
+    // Re-opening an existing database should leave its schema as-is.
+    SqliteSink other;
+    QVERIFY(other.open(fileName));
+    QVERIFY(sink.open(fileName));
+    QVERIFY(sink.isOpen());
+}
+
+void TestSqliteSink::open_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SqliteSink sink;
+    QVERIFY(!sink.open(dir.filePath(u"missing/samples.db"_s)));
+    QVERIFY(!sink.isOpen());
+    QVERIFY(sink.fileName().isNull());
+    QVERIFY(!sink.errorString().isEmpty());
+}
+
+void TestSqliteSink::setSession()
+{
+    if (!QSqlDatabase::isDriverAvailable(u"QSQLITE"_s)) {
+        QSKIP("The Qt SQLite driver is not available");
+    }
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"samples.db"_s);
+    SqliteSink sink;
+    QVERIFY(sink.open(fileName));
+    QCOMPARE(sink.sessionId(), (qint64)-1);
+
+    QVERIFY(sink.setSession(testSession));
+    const qint64 first = sink.sessionId();
+    QVERIFY(first >= 0);
+    QCOMPARE(sink.statistics().sessions, (quint64)1);
+
+    // The same session, other than its start time, should continue the current session.
+    SqliteSink::Session session = testSession;
+    session.started += 1000;
+    QVERIFY(sink.setSession(session));
+    QCOMPARE(sink.sessionId(), first);
+    QCOMPARE(sink.statistics().sessions, (quint64)1);
+
+    // A range change should begin a new session.
+    session.range = u"Up to 6V"_s;
+    QVERIFY(sink.setSession(session));
+    QVERIFY(sink.sessionId() >= 0);
+    QVERIFY(sink.sessionId() != first);
+    QCOMPARE(sink.statistics().sessions, (quint64)2);
+
+    // And returning to the first session (with the same start time) should resume it.
+    QVERIFY(sink.setSession(testSession));
+    QCOMPARE(sink.sessionId(), first);
+    QCOMPARE(sink.statistics().sessions, (quint64)3);
+
+    // Null units and ranges should be resumable too.
+    session = testSession;
+    session.mode = u"Continuity"_s;
+    session.unit = session.range = QString();
+    QVERIFY(sink.setSession(session));
+    const qint64 continuity = sink.sessionId();
+    sink.endSession();
+    QVERIFY(sink.setSession(session));
+    QCOMPARE(sink.sessionId(), continuity);
+
+    QCOMPARE(queryValue(fileName, u"SELECT COUNT(*) FROM devices"_s).toInt(), 1);
+    QCOMPARE(queryValue(fileName, u"SELECT COUNT(*) FROM sessions"_s).toInt(), 3);
+    QVERIFY(queryValue(fileName, u"SELECT unit FROM sessions WHERE mode = 'Continuity'"_s).isNull());
+}
+
+void TestSqliteSink::endSession()
+{
+    if (!QSqlDatabase::isDriverAvailable(u"QSQLITE"_s)) {
+        QSKIP("The Qt SQLite driver is not available");
+    }
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SqliteSink sink;
+    QVERIFY(sink.open(dir.filePath(u"samples.db"_s)));
+    QVERIFY(sink.setSession(testSession));
+    sink.addSample(testSession.started, 1.0);
+    sink.endSession();
+    QCOMPARE(sink.sessionId(), (qint64)-1);
+    QVERIFY(sink.pending.isEmpty());
+    QCOMPARE(sink.statistics().samples, (quint64)1);
+    QCOMPARE(sink.statistics().transactions, (quint64)1);
+
+    // Samples are then ignored until the next session is set.
+    sink.addSample(testSession.started + 1000, 2.0);
+    QVERIFY(sink.pending.isEmpty());
+}
+
+void TestSqliteSink::addSample_noSession()
+{
+    if (!QSqlDatabase::isDriverAvailable(u"QSQLITE"_s)) {
+        QSKIP("The Qt SQLite driver is not available");
+    }
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SqliteSink sink;
+    QVERIFY(sink.open(dir.filePath(u"samples.db"_s)));
+    sink.addSample(testSession.started, 1.0);
+    QVERIFY(sink.pending.isEmpty());
+    QVERIFY(sink.commit());
+    QCOMPARE(sink.statistics().transactions, (quint64)0);
+}
+
+void TestSqliteSink::commit()
+{
+    if (!QSqlDatabase::isDriverAvailable(u"QSQLITE"_s)) {
+        QSKIP("The Qt SQLite driver is not available");
+    }
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"samples.db"_s);
+    SqliteSink sink;
+    QVERIFY(sink.open(fileName));
+    QVERIFY(sink.setSession(testSession));
+
+    // Two multi-row inserts, and then 50 single-row inserts, all in a single transaction.
+    const int count = SqliteSink::rowsPerInsert * 2 + 50;
+    for (int index = 0; index < count; ++index) {
+        sink.addSample(testSession.started + index * testSession.interval, index * 0.5);
+    }
+    QCOMPARE(sink.pending.size(), (qsizetype)count);
+    QVERIFY(sink.commit());
+    QVERIFY(sink.pending.isEmpty());
+    QCOMPARE(sink.statistics().samples, (quint64)count);
+    QCOMPARE(sink.statistics().transactions, (quint64)1);
+    QCOMPARE(sink.statistics().failures, (quint64)0);
+
+    QCOMPARE(queryValue(fileName, u"SELECT COUNT(*) FROM samples"_s).toInt(), count);
+    QCOMPARE(queryValue(fileName, u"SELECT SUM(value) FROM samples"_s).toDouble(), 0.5 * (count - 1) * count / 2);
+    QCOMPARE(queryValue(fileName, u"SELECT MAX(timestamp) FROM samples"_s).toLongLong(),
+             testSession.started + (count - 1) * testSession.interval);
+    QCOMPARE(queryValue(fileName, u"SELECT COUNT(*) FROM readings WHERE device = 'Pokit Pro'"_s).toInt(), count);
+
+    // Committing nothing should not begin a transaction.
+    QVERIFY(sink.commit());
+    QCOMPARE(sink.statistics().transactions, (quint64)1);
+}
+
+void TestSqliteSink::commit_closed()
+{
+    SqliteSink sink;
+    QVERIFY(!sink.setSession(testSession));
+    QVERIFY(!sink.errorString().isEmpty());
+    sink.addSample(testSession.started, 1.0);
+    QVERIFY(sink.pending.isEmpty());
+    QVERIFY(sink.commit());
+    QCOMPARE(sink.statistics().sessions, (quint64)0);
+}
+
+void TestSqliteSink::sameSession_data()
+{
+    QTest::addColumn<QString>("field");
+    QTest::addColumn<bool>("expected");
+    QTest::addRow("identical") << QString()       << true;
+    QTest::addRow("started")   << u"started"_s  << true;
+    QTest::addRow("device")    << u"device"_s   << false;
+    QTest::addRow("command")   << u"command"_s  << false;
+    QTest::addRow("mode")      << u"mode"_s     << false;
+    QTest::addRow("unit")      << u"unit"_s     << false;
+    QTest::addRow("range")     << u"range"_s    << false;
+    QTest::addRow("interval")  << u"interval"_s << false;
+}
+
+void TestSqliteSink::sameSession()
+{
+    QFETCH(QString, field);
+    QFETCH(bool, expected);
+    SqliteSink::Session session = testSession;
+    if (field == u"started"_s)  session.started  += 1;
+    if (field == u"device"_s)   session.device   = u"Pokit Meter"_s;
+    if (field == u"command"_s)  session.command  = u"logger"_s;
+    if (field == u"mode"_s)     session.mode     = u"AC voltage"_s;
+    if (field == u"unit"_s)     session.unit     = u"Vac"_s;
+    if (field == u"range"_s)    session.range    = u"Up to 6V"_s;
+    if (field == u"interval"_s) session.interval += 1;
+    QCOMPARE(SqliteSink::sameSession(testSession, session), expected);
+    QCOMPARE(SqliteSink::sameSession(session, testSession), expected);
+}
+
+void TestSqliteSink::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    SqliteSink sink;
+    QVERIFY(!sink.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestSqliteSink)
@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestSqliteSink : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void open();
+    void open_invalid();
+
+    void setSession();
+    void endSession();
+
+    void addSample_noSession();
+
+    void commit();
+    void commit_closed();
+
+    void sameSession_data();
+    void sameSession();
+
+    void tr();
+};
@@ -44,7 +44,8 @@ void TestStatusCommand::supportedOptions()
     StatusCommand command(this);
     MockDeviceCommand mock;
     QCommandLineParser parser;
-    const QStringList expected = command.requiredOptions(parser) + mock.supportedOptions(parser);
+    const QStringList expected = command.requiredOptions(parser) + mock.supportedOptions(parser) + QStringList{
+        u"interval"_s, u"low-battery"_s, u"watch"_s };
     QCOMPARE(command.supportedOptions(parser), expected);
 }
 
@@ -55,11 +56,72 @@ void TestStatusCommand::processOptions()
     QCOMPARE(command.processOptions(parser), QStringList());
 }
 
+void TestStatusCommand::processOptions_watch()
+{
+    const auto process = [](const QStringList &arguments, StatusCommand &command) {
+        QCommandLineParser parser;
+        parser.addOption({u"interval"_s, u"description"_s, u"interval"_s});
+        parser.addOption({u"low-battery"_s, u"description"_s, u"voltage"_s});
+        parser.addOption({u"output"_s, u"description"_s, u"format"_s});
+        parser.addOption({u"watch"_s, u"description"_s});
+        parser.process(QStringList{ u"dokit"_s } + arguments);
+        return command.processOptions(parser);
+    };
+
+    {   // Watching defaults to NDJSON output, coalesced over 1 second, with no low battery threshold.
+        StatusCommand command(this);
+        QCOMPARE(process({ u"--watch"_s }, command), QStringList{});
+        QCOMPARE(command.watch, true);
+        QCOMPARE(command.format, AbstractCommand::OutputFormat::Ndjson);
+        QCOMPARE(command.coalesceInterval, (quint32)1000);
+        QCOMPARE(command.lowBatteryThreshold, (quint32)0);
+    }
+
+    {   // But an explicit output format, interval and low battery threshold are all respected.
+        StatusCommand command(this);
+        QCOMPARE(process({ u"--watch"_s, u"--output"_s, u"ndjson"_s, u"--interval"_s, u"5s"_s,
+                           u"--low-battery"_s, u"3.5V"_s }, command), QStringList{});
+        QCOMPARE(command.format, AbstractCommand::OutputFormat::Ndjson);
+        QCOMPARE(command.coalesceInterval, (quint32)5000);
+        QCOMPARE(command.lowBatteryThreshold, (quint32)3500);
+    }
+
+    {   // NDJSON output, the interval and low battery threshold all only apply to watching.
+        StatusCommand command(this);
+        QCOMPARE(process({ u"--output"_s, u"ndjson"_s }, command),
+                 QStringList{ u"NDJSON output is not supported by this command"_s });
+        QCOMPARE(process({ u"--interval"_s, u"5s"_s, u"--low-battery"_s, u"3.5"_s }, command), QStringList({
+            u"Missing required option for --interval: --watch"_s,
+            u"Missing required option for --low-battery: --watch"_s }));
+        QCOMPARE(command.watch, false);
+    }
+
+    {   // Invalid values are reported.
+        StatusCommand command(this);
+        QCOMPARE(process({ u"--watch"_s, u"--interval"_s, u"soon"_s, u"--low-battery"_s, u"low"_s }, command),
+                 QStringList({ u"Invalid interval value: soon"_s, u"Invalid low-battery value: low"_s }));
+    }
+}
+
 void TestStatusCommand::getService()
 {
     // Unable to safely invoke StatusCommand::getService() without a valid Bluetooth device.
 }
 
+void TestStatusCommand::usesDiscoveredValues()
+{
+    StatusCommand command(this);
+    QVERIFY(command.usesDiscoveredValues());
+}
+
+void TestStatusCommand::supportsNdjsonOutput()
+{
+    StatusCommand command(this);
+    QVERIFY(!command.supportsNdjsonOutput());
+    command.watch = true;
+    QVERIFY(command.supportsNdjsonOutput());
+}
+
 void TestStatusCommand::serviceDetailsDiscovered()
 {
     if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
@@ -123,6 +185,62 @@ void TestStatusCommand::outputDeviceStatus()
     QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
 }
 
+void TestStatusCommand::outputStatusChange_data()
+{
+    QTest::addColumn<AbstractCommand::OutputFormat>("format");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("csv") << AbstractCommand::OutputFormat::Csv << QByteArray(
+        "timestamp,event,device_status,battery_voltage,battery_status,switch_position,charging_status\n"
+        "1234567,statuschanged,idle,3.5,good,,\n"
+        "1234568,lowbattery,idle,3.25,low,voltage,discharging\n");
+    QTest::addRow("json") << AbstractCommand::OutputFormat::Json << QByteArray(
+        "{\n"
+        "    \"battery\": {\n"
+        "        \"level\": 3.5,\n"
+        "        \"status\": \"Good\"\n"
+        "    },\n"
+        "    \"deviceStatus\": \"Idle\",\n"
+        "    \"event\": \"StatusChanged\",\n"
+        "    \"timestamp\": 1234567\n"
+        "}\n"
+        "{\n"
+        "    \"battery\": {\n"
+        "        \"level\": 3.25,\n"
+        "        \"status\": \"Low\"\n"
+        "    },\n"
+        "    \"chargingStatus\": \"Discharging\",\n"
+        "    \"deviceStatus\": \"Idle\",\n"
+        "    \"event\": \"LowBattery\",\n"
+        "    \"switchPosition\": \"Voltage\",\n"
+        "    \"timestamp\": 1234568\n"
+        "}\n");
+    QTest::addRow("ndjson") << AbstractCommand::OutputFormat::Ndjson << QByteArray(
+        R"({"battery":{"level":3.5,"status":"Good"},"deviceStatus":"Idle","event":"StatusChanged",)"
+        R"("timestamp":1234567})" "\n"
+        R"({"battery":{"level":3.25,"status":"Low"},"chargingStatus":"Discharging","deviceStatus":"Idle",)"
+        R"("event":"LowBattery","switchPosition":"Voltage","timestamp":1234568})" "\n");
+    QTest::addRow("text") << AbstractCommand::OutputFormat::Text << QByteArray(
+        "1970-01-01T00:20:34.567Z StatusChanged Idle 3.5V Good\n"
+        "1970-01-01T00:20:34.568Z LowBattery Idle 3.25V Low Voltage Discharging\n");
+}
+
+void TestStatusCommand::outputStatusChange()
+{
+    QFETCH(AbstractCommand::OutputFormat, format);
+    QFETCH(QByteArray, expected);
+
+    const OutputStreamCapture capture(&std::cout);
+    StatusCommand command;
+    command.format = format;
+    command.outputStatusChange(u"StatusChanged"_s, { StatusService::DeviceStatus::Idle, 3.5f,
+        StatusService::BatteryStatus::Good, std::nullopt, std::nullopt }, 1'234'567);
+    command.outputStatusChange(u"LowBattery"_s, { StatusService::DeviceStatus::Idle, 3.25f,
+        StatusService::BatteryStatus::Low, StatusService::SwitchPosition::Voltage,
+        StatusService::ChargingStatus::Discharging }, 1'234'568);
+    QCOMPARE(QByteArray::fromStdString(capture.data()), expected);
+}
+
 void TestStatusCommand::tr()
 {
     // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
@@ -13,13 +13,19 @@ private slots:
     void supportedOptions();
 
     void processOptions();
+    void processOptions_watch();
 
     void getService();
+    void usesDiscoveredValues();
+    void supportsNdjsonOutput();
 
     void serviceDetailsDiscovered();
 
     void outputDeviceStatus_data();
     void outputDeviceStatus();
 
+    void outputStatusChange_data();
+    void outputStatusChange();
+
     void tr();
 };
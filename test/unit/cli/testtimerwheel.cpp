@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testtimerwheel.h"
+
+#include "timerwheel.h"
+
+#include <QRandomGenerator>
+
+void TestTimerWheel::construct()
+{
+    const TimerWheel wheel(100, 1234);
+    QCOMPARE(wheel.tickInterval(), (qint64)100);
+    QCOMPARE(wheel.currentTime(), (qint64)1200);
+    QCOMPARE(wheel.size(), 0);
+    QCOMPARE(TimerWheel(0).tickInterval(), (qint64)1); // Clamped.
+}
+
+void TestTimerWheel::schedule()
+{
+    TimerWheel wheel(100);
+    wheel.schedule(1, 450);
+    QVERIFY(wheel.contains(1));
+    QVERIFY(!wheel.contains(2));
+    QCOMPARE(wheel.size(), 1);
+    QCOMPARE(wheel.dueTime(1), (qint64)500); // Rounded up to a whole tick.
+    QCOMPARE(wheel.dueTime(2), (qint64)-1);
+
+    QCOMPARE(wheel.advance(499), QVector<quint32>{});
+    QCOMPARE(wheel.currentTime(), (qint64)400);
+    QCOMPARE(wheel.advance(500), QVector<quint32>{ 1 });
+    QCOMPARE(wheel.size(), 0);
+    QVERIFY(!wheel.contains(1));
+    QCOMPARE(wheel.advance(10000), QVector<quint32>{});
+}
+
+void TestTimerWheel::schedule_past()
+{
+    TimerWheel wheel(100, 1000);
+    wheel.schedule(1, 0);
+    wheel.schedule(2, 1000);
+    QCOMPARE(wheel.dueTime(1), (qint64)1100);
+    QCOMPARE(wheel.dueTime(2), (qint64)1100);
+    QCOMPARE(wheel.advance(1000), QVector<quint32>{});
+    QCOMPARE(wheel.advance(1100), (QVector<quint32>{ 1, 2 }));
+}
+
+void TestTimerWheel::schedule_replace()
+{
+    TimerWheel wheel(10);
+    wheel.schedule(1, 100);
+    wheel.schedule(1, 50000); // Replaces the first schedule, leaving a stale slot entry behind.
+    QCOMPARE(wheel.size(), 1);
+    QCOMPARE(wheel.advance(49990), QVector<quint32>{});
+    QCOMPARE(wheel.advance(50000), QVector<quint32>{ 1 });
+
+    wheel.schedule(2, 90000);
+    wheel.schedule(2, 60000); // Rescheduled sooner.
+    QCOMPARE(wheel.advance(60000), QVector<quint32>{ 2 });
+    QCOMPARE(wheel.advance(100000), QVector<quint32>{});
+}
+
+void TestTimerWheel::cancel()
+{
+    TimerWheel wheel(100);
+    wheel.schedule(1, 1000);
+    wheel.schedule(2, 1000);
+    QVERIFY(wheel.cancel(1));
+    QVERIFY(!wheel.cancel(1));
+    QVERIFY(!wheel.cancel(3));
+    QCOMPARE(wheel.size(), 1);
+    QCOMPARE(wheel.advance(1000), QVector<quint32>{ 2 });
+
+    // A cancelled timer's stale slot entry must not expire a later reuse of the same ID.
+    wheel.schedule(3, 2000);
+    QVERIFY(wheel.cancel(3));
+    wheel.schedule(3, 3000);
+    QCOMPARE(wheel.advance(2000), QVector<quint32>{});
+    QCOMPARE(wheel.advance(3000), QVector<quint32>{ 3 });
+}
+
+void TestTimerWheel::advance_order()
+{
+    TimerWheel wheel(1);
+    wheel.schedule(1, 300);
+    wheel.schedule(2, 20);
+    wheel.schedule(3, 5000);
+    wheel.schedule(4, 300);
+    QCOMPARE(wheel.advance(10000), (QVector<quint32>{ 2, 1, 4, 3 }));
+}
+
+void TestTimerWheel::advance_cascade_data()
+{
+    QTest::addColumn<qint64>("start");
+    QTest::addColumn<qint64>("due");
+
+    // Due times (in ticks) that land in each level, from various (misaligned) starting ticks.
+    for (const qint64 start: { qint64(0), qint64(1), qint64(63), qint64(4095), qint64(12345) }) {
+        for (const qint64 due: { qint64(1), qint64(63), qint64(64), qint64(65), qint64(4095), qint64(4096),
+                                 qint64(4097), qint64(262143), qint64(262144), qint64(1000000) }) {
+            QTest::addRow("%lld+%lld", start, due) << start << (start + due);
+        }
+    }
+}
+
+void TestTimerWheel::advance_cascade()
+{
+    QFETCH(qint64, start);
+    QFETCH(qint64, due);
+
+    TimerWheel wheel(1, start);
+    wheel.schedule(1, due);
+    QCOMPARE(wheel.advance(due - 1), QVector<quint32>{}); // Not a moment too soon,
+    QCOMPARE(wheel.advance(due), QVector<quint32>{ 1 });  // nor too late.
+}
+
+void TestTimerWheel::advance_beyondRange()
+{
+    const qint64 due = TimerWheel::maxTicks + 100; // Held in the coarsest level until it comes into range.
+    TimerWheel wheel(1);
+    wheel.schedule(1, due);
+    QCOMPARE(wheel.advance(due - 1), QVector<quint32>{});
+    QCOMPARE(wheel.advance(due), QVector<quint32>{ 1 });
+}
+
+void TestTimerWheel::advance_jump()
+{
+    TimerWheel wheel(100);
+    QCOMPARE(wheel.advance(3600000), QVector<quint32>{}); // Empty, so jumps straight there.
+    QCOMPARE(wheel.currentTime(), (qint64)3600000);
+    wheel.schedule(1, 3600000 + 250);
+    QCOMPARE(wheel.dueTime(1), (qint64)3600300);
+    QCOMPARE(wheel.advance(3600300), QVector<quint32>{ 1 });
+}
+
+void TestTimerWheel::advance_many()
+{
+    QRandomGenerator random(42); // Deterministic.
+    QHash<quint32, qint64> expected;
+    TimerWheel wheel(1);
+    for (quint32 id = 1; id <= 10000; ++id) {
+        const qint64 due = random.bounded(300000) + 1;
+        wheel.schedule(id, due);
+        expected.insert(id, due);
+    }
+    QCOMPARE(wheel.size(), 10000);
+    for (qint64 now = 1; now <= 300000; now += 97) { // Advance in (misaligned) steps of several ticks.
+        const QVector<quint32> expired = wheel.advance(now);
+        for (const quint32 id: expired) {
+            const qint64 due = expected.take(id);
+            QVERIFY2((due <= now) && (due > now - 97), qPrintable(QString::number(id)));
+        }
+    }
+    wheel.advance(300000);
+    QCOMPARE(wheel.size(), 0);
+    QVERIFY(expected.isEmpty());
+}
+
+QTEST_MAIN(TestTimerWheel)
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestTimerWheel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void construct();
+
+    void schedule();
+    void schedule_past();
+    void schedule_replace();
+
+    void cancel();
+
+    void advance_order();
+    void advance_cascade_data();
+    void advance_cascade();
+    void advance_beyondRange();
+    void advance_jump();
+    void advance_many();
+};
@@ -0,0 +1,233 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testwavwriter.h"
+#include "../stringliterals_p.h"
+
+#include "wavwriter.h"
+
+#include <qtpokit/pokitmeter.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+DOKIT_USE_STRINGLITERALS
+
+Q_DECLARE_METATYPE(MeasurementFormatter::Context)
+
+// Returns the entire contents of \a fileName, or a null byte array if it could not be read.
+static QByteArray readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    return (file.open(QIODevice::ReadOnly)) ? file.readAll() : QByteArray();
+}
+
+static const DsoService::Metadata testMetadata {
+    DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V, 1000, 3, 1000
+};
+
+static MeasurementFormatter::Context testContext()
+{
+    MeasurementFormatter::Context context;
+    context.mode = u"DC voltage"_s;
+    context.unit = u"Vdc"_s;
+    context.range = u"Up to 2V"_s;
+    return context;
+}
+
+void TestWavWriter::open()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"capture.wav"_s);
+    WavWriter writer;
+    QVERIFY(!writer.isOpen());
+    QVERIFY(writer.fileName().isNull());
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.isOpen());
+    QCOMPARE(writer.fileName(), fileName);
+    QVERIFY(writer.errorString().isEmpty());
+
+    // The header is not written until the first samples are.
+    QVERIFY(QFile::exists(fileName));
+    QCOMPARE(QFile(fileName).size(), (qint64)0);
+}
+
+void TestWavWriter::open_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    WavWriter writer;
+    QVERIFY(!writer.open(dir.filePath(u"missing/capture.wav"_s)));
+    QVERIFY(!writer.isOpen());
+    QVERIFY(!writer.errorString().isEmpty());
+    QVERIFY(!writer.write(testMetadata, testContext(), { 1, 2, 3 }));
+}
+
+void TestWavWriter::write()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"capture.wav"_s);
+    {
+        WavWriter writer;
+        QVERIFY(writer.open(fileName));
+        QVERIFY(writer.write(testMetadata, testContext(), { 1, -2 }));
+        QVERIFY(writer.write(testMetadata, testContext(), { 300 }));
+        QVERIFY(writer.write(testMetadata, testContext(), { })); // No-op.
+        QCOMPARE(writer.statistics().samples, (quint64)3);
+        QCOMPARE(writer.statistics().files, (quint64)1);
+    } // Committed on destruction.
+
+    // The raw samples follow the header verbatim, with the scale (and labels) in the header's comment.
+    QCOMPARE(readFile(fileName),
+        WavWriter::header(1000, "scale=0.5;unit=Vdc;mode=DC voltage;range=Up to 2V", 6) +
+        QByteArray::fromHex("0100" "feff" "2c01"));
+}
+
+void TestWavWriter::writeRaw()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"capture.wav"_s);
+    {
+        WavWriter writer;
+        QVERIFY(writer.open(fileName));
+        QVERIFY(writer.writeRaw(testMetadata, testContext(), QByteArray::fromHex("0100" "feff")));
+        QVERIFY(writer.writeRaw(testMetadata, testContext(), QByteArray::fromHex("2c01" "ff"))); // Odd byte ignored.
+        QVERIFY(writer.writeRaw(testMetadata, testContext(), QByteArray::fromHex("ff"))); // No-op.
+        QCOMPARE(writer.statistics().samples, (quint64)3);
+    }
+
+    // Identical to the decoded samples' file.
+    QCOMPARE(readFile(fileName),
+        WavWriter::header(1000, "scale=0.5;unit=Vdc;mode=DC voltage;range=Up to 2V", 6) +
+        QByteArray::fromHex("0100" "feff" "2c01"));
+}
+
+void TestWavWriter::write_append()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"capture.wav"_s);
+    WavWriter writer;
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.write(testMetadata, testContext(), { 1, 2, 3 }));
+    QVERIFY(writer.commit());
+    QVERIFY(writer.write(testMetadata, testContext(), { 4, 5 })); // Such as the next continuous capture.
+    QVERIFY(writer.commit());
+    QCOMPARE(writer.statistics().files, (quint64)1);
+    QCOMPARE(writer.statistics().commits, (quint64)2);
+    QCOMPARE(readFile(fileName), WavWriter::header(1000, WavWriter::comment(0.5f, testContext()), 10) +
+        QByteArray::fromHex("0100" "0200" "0300" "0400" "0500"));
+}
+
+void TestWavWriter::write_newFile()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"capture.wav"_s);
+    WavWriter writer;
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.write(testMetadata, testContext(), { 1, 2, 3 }));
+
+    // A different range (and therefore scale) cannot share the same file, so starts the next one.
+    DsoService::Metadata metadata = testMetadata;
+    metadata.scale = 2.0f;
+    metadata.range = +PokitMeter::VoltageRange::_6V;
+    QVERIFY(writer.write(metadata, testContext(), { 4, 5 }));
+    QCOMPARE(writer.fileName(), dir.filePath(u"capture.1.wav"_s));
+    QVERIFY(writer.commit());
+    QCOMPARE(writer.statistics().files, (quint64)2);
+
+    QCOMPARE(readFile(fileName), WavWriter::header(1000, WavWriter::comment(0.5f, testContext()), 6) +
+        QByteArray::fromHex("0100" "0200" "0300"));
+    QCOMPARE(readFile(dir.filePath(u"capture.1.wav"_s)),
+        WavWriter::header(1000, WavWriter::comment(2.0f, testContext()), 4) + QByteArray::fromHex("0400" "0500"));
+}
+
+void TestWavWriter::write_zeroRate()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    WavWriter writer;
+    QVERIFY(writer.open(dir.filePath(u"capture.wav"_s)));
+    DsoService::Metadata metadata = testMetadata;
+    metadata.samplingRate = 0;
+    QVERIFY(!writer.write(metadata, testContext(), { 1, 2, 3 }));
+    QCOMPARE(writer.errorString(), u"Unsupported sampling rate: 0"_s);
+    QCOMPARE(writer.statistics().errors, (quint64)1);
+    QCOMPARE(writer.statistics().samples, (quint64)0);
+}
+
+void TestWavWriter::commit()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(u"capture.wav"_s);
+    WavWriter writer;
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.commit()); // Nothing to commit yet.
+    QCOMPARE(writer.statistics().commits, (quint64)0);
+
+    // Until committed, the header still describes an empty data chunk, so the file is valid, but without the samples.
+    const QByteArray header = WavWriter::header(1000, WavWriter::comment(0.5f, testContext()), 0);
+    QVERIFY(writer.write(testMetadata, testContext(), { 1, 2 }));
+    QCOMPARE(readFile(fileName).left(header.size()), header);
+    QVERIFY(writer.commit());
+    QCOMPARE(readFile(fileName), WavWriter::header(1000, WavWriter::comment(0.5f, testContext()), 4) +
+        QByteArray::fromHex("0100" "0200"));
+    QVERIFY(writer.commit()); // Nothing more to commit.
+    QCOMPARE(writer.statistics().commits, (quint64)1);
+}
+
+void TestWavWriter::comment_data()
+{
+    QTest::addColumn<float>("scale");
+    QTest::addColumn<MeasurementFormatter::Context>("context");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("labels") << 0.000244140625f << testContext()
+        << QByteArray("scale=0.000244140625;unit=Vdc;mode=DC voltage;range=Up to 2V");
+    QTest::addRow("no-range") << 1.5f << []() {
+            MeasurementFormatter::Context context = testContext();
+            context.range.clear();
+            return context;
+        }() << QByteArray("scale=1.5;unit=Vdc;mode=DC voltage");
+    QTest::addRow("exact") << 0.1f << MeasurementFormatter::Context{} << QByteArray("scale=0.100000001");
+}
+
+void TestWavWriter::comment()
+{
+    QFETCH(float, scale);
+    QFETCH(MeasurementFormatter::Context, context);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(WavWriter::comment(scale, context), expected);
+}
+
+void TestWavWriter::header()
+{
+    QCOMPARE(WavWriter::header(1000, "scale=0.5", 6), QByteArray::fromHex(
+        "52494646" "48000000" "57415645"                           // RIFF, 72 bytes, WAVE
+        "666d7420" "10000000" "0100" "0100" "e8030000" "d0070000" "0200" "1000" // fmt, PCM, mono, 1kHz, 16-bit
+        "4c495354" "16000000" "494e464f"                           // LIST, 22 bytes, INFO
+        "49434d54" "0a000000" "7363616c653d302e3500"               // ICMT, 10 bytes, "scale=0.5\0"
+        "64617461" "06000000"));                                   // data, 6 bytes
+
+    // Odd-length comments are padded, to keep every chunk word-aligned.
+    const QByteArray header = WavWriter::header(1000, "scale=10", 0);
+    QCOMPARE(header.mid(36, 8), QByteArray::fromHex("4c495354" "16000000")); // LIST, 22 bytes.
+    QCOMPARE(header.mid(48, 18), QByteArray::fromHex("49434d54" "09000000" "7363616c653d31300000")); // ICMT, 9 bytes.
+    QCOMPARE(header.mid(66, 4), QByteArray("data"));
+    QCOMPARE(header.size(), 74);
+}
+
+void TestWavWriter::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    WavWriter writer;
+    QVERIFY(!writer.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestWavWriter)
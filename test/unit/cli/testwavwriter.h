@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestWavWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void open();
+    void open_invalid();
+
+    void write();
+    void write_append();
+    void write_newFile();
+    void write_zeroRate();
+    void writeRaw();
+
+    void commit();
+
+    void comment_data();
+    void comment();
+
+    void header();
+
+    void tr();
+};
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testwebsocketconnection.h"
+#include "../stringliterals_p.h"
+
+#include "websocketconnection.h"
+
+#include <QTcpSocket>
+#include <QtEndian>
+
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+// Returns a single client frame, with \a header, and \a payload masked by \a mask, as per RFC 6455.
+QByteArray clientFrame(const quint8 header, const QByteArray &payload, const QByteArray &mask = "\x37\xfa\x21\x3d")
+{
+    QByteArray frame(1, (char)header);
+    if (payload.size() < 126) {
+        frame.append((char)(0x80 | payload.size()));
+    } else {
+        char length[2];
+        qToBigEndian<quint16>((quint16)payload.size(), length);
+        frame.append((char)(0x80 | 126)).append(length, sizeof(length));
+    }
+    frame.append(mask);
+    for (qsizetype index = 0; index < payload.size(); ++index) {
+        frame.append((char)(payload.at(index) ^ mask.at(index % 4)));
+    }
+    return frame;
+}
+
+}
+
+void TestWebSocketConnection::maxQueued()
+{
+    WebSocketConnection connection(new QTcpSocket);
+    QCOMPARE(connection.maxQueued(), WebSocketConnection::defaultMaxQueued);
+    connection.setMaxQueued(1024);
+    QCOMPARE(connection.maxQueued(), (qint64)1024);
+    QVERIFY(!connection.isHandshakeComplete());
+    QCOMPARE(connection.droppedMessages(), (quint64)0);
+    QVERIFY(connection.isSequential());
+    QCOMPARE(connection.bytesAvailable(), (qint64)0);
+    QVERIFY(!connection.canReadLine());
+}
+
+void TestWebSocketConnection::acceptKey()
+{
+    // The example from RFC 6455, section 1.3.
+    QCOMPARE(WebSocketConnection::acceptKey("dGhlIHNhbXBsZSBub25jZQ=="), QByteArray("s3pPLMBiTxaQ9kYGzzhZRbK+xOo="));
+}
+
+void TestWebSocketConnection::handshakeResponse_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<QByteArray>("expectedResponse");
+    QTest::addColumn<bool>("expectedAccepted");
+
+    QTest::addRow("valid")
+        << QByteArray("GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: keep-alive, Upgrade\r\n"
+                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n")
+        << QByteArray("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n\r\n")
+        << true;
+    QTest::addRow("case-insensitive")
+        << QByteArray("GET /dokit HTTP/1.1\r\nUPGRADE: WebSocket\r\nconnection: upgrade\r\n"
+                      "sec-websocket-key: dGhlIHNhbXBsZSBub25jZQ==\r\nsec-websocket-version: 13\r\n\r\n")
+        << QByteArray("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n\r\n")
+        << true;
+    QTest::addRow("not-get")
+        << QByteArray("POST / HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\r\n")
+        << QByteArray("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n")
+        << false;
+    QTest::addRow("not-upgrade")
+        << QByteArray("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n")
+        << QByteArray("HTTP/1.1 426 Upgrade Required\r\nUpgrade: websocket\r\nConnection: close\r\n\r\n")
+        << false;
+    QTest::addRow("old-version")
+        << QByteArray("GET / HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 8\r\n\r\n")
+        << QByteArray("HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\nConnection: close\r\n\r\n")
+        << false;
+    QTest::addRow("no-key")
+        << QByteArray("GET / HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Version: 13\r\n\r\n")
+        << QByteArray("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n")
+        << false;
+}
+
+void TestWebSocketConnection::handshakeResponse()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(QByteArray, expectedResponse);
+    QFETCH(bool, expectedAccepted);
+    bool accepted = !expectedAccepted;
+    QCOMPARE(WebSocketConnection::handshakeResponse(request, accepted), expectedResponse);
+    QCOMPARE(accepted, expectedAccepted);
+}
+
+void TestWebSocketConnection::encodeFrame_data()
+{
+    QTest::addColumn<int>("payloadSize");
+    QTest::addColumn<QByteArray>("expectedHeader");
+
+    QTest::addRow("empty")  << 0       << QByteArray("\x81\x00", 2);
+    QTest::addRow("short")  << 125     << QByteArray("\x81\x7d", 2);
+    QTest::addRow("16-bit") << 126     << QByteArray("\x81\x7e\x00\x7e", 4);
+    QTest::addRow("16-max") << 65535   << QByteArray("\x81\x7e\xff\xff", 4);
+    QTest::addRow("64-bit") << 65536   << QByteArray("\x81\x7f\x00\x00\x00\x00\x00\x01\x00\x00", 10);
+}
+
+void TestWebSocketConnection::encodeFrame()
+{
+    QFETCH(int, payloadSize);
+    QFETCH(QByteArray, expectedHeader);
+    const QByteArray payload(payloadSize, 'x');
+    const QByteArray frame = WebSocketConnection::encodeFrame(WebSocketConnection::Opcode::Text, payload);
+    QCOMPARE(frame.left(expectedHeader.size()), expectedHeader);
+    QCOMPARE(frame.mid(expectedHeader.size()), payload);
+}
+
+void TestWebSocketConnection::parseFrame_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("expectedSize");
+    QTest::addColumn<int>("expectedHeader");
+    QTest::addColumn<QByteArray>("expectedPayload");
+
+    const QByteArray text = clientFrame(0x81, "Hello");
+    const QByteArray large = clientFrame(0x81, QByteArray(300, 'y'));
+    QTest::addRow("empty")      << QByteArray() << 0 << 0 << QByteArray();
+    QTest::addRow("text")       << text << (int)text.size() << 0x81 << QByteArray("Hello");
+    QTest::addRow("trailing")   << text + "more" << (int)text.size() << 0x81 << QByteArray("Hello");
+    QTest::addRow("incomplete") << text.chopped(1) << 0 << 0x81 << QByteArray();
+    QTest::addRow("16-bit")     << large << (int)large.size() << 0x81 << QByteArray(300, 'y');
+    QTest::addRow("fragment")   << clientFrame(0x01, "Hel") << 9 << 0x01 << QByteArray("Hel");
+    QTest::addRow("ping")       << clientFrame(0x89, "hi") << 8 << 0x89 << QByteArray("hi");
+    QTest::addRow("unmasked")   << QByteArray("\x81\x05Hello", 7) << -1 << 0x81 << QByteArray();
+    QTest::addRow("reserved")   << clientFrame(0xC1, "Hello") << -1 << 0xC1 << QByteArray();
+    QTest::addRow("fragmented-control") << clientFrame(0x09, "hi") << -1 << 0x09 << QByteArray();
+    QTest::addRow("large-control") << clientFrame(0x89, QByteArray(126, 'z')) << -1 << 0x89 << QByteArray();
+    QTest::addRow("too-large")
+        << QByteArray("\x81\xff\x00\x00\x00\x00\x00\x01\x00\x01", 10) << -1 << 0x81 << QByteArray();
+}
+
+void TestWebSocketConnection::parseFrame()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, expectedSize);
+    QFETCH(int, expectedHeader);
+    QFETCH(QByteArray, expectedPayload);
+    quint8 header = 0;
+    QByteArray payload;
+    QCOMPARE((int)WebSocketConnection::parseFrame(data, header, payload), expectedSize);
+    QCOMPARE((int)header, expectedHeader);
+    QCOMPARE(payload, expectedPayload);
+}
+
+void TestWebSocketConnection::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    WebSocketConnection connection(new QTcpSocket);
+    QVERIFY(!connection.tr("ignored").isEmpty());
+}
+
+QTEST_MAIN(TestWebSocketConnection)
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QTest>
+
+class TestWebSocketConnection : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void maxQueued();
+
+    void acceptKey();
+
+    void handshakeResponse_data();
+    void handshakeResponse();
+
+    void encodeFrame_data();
+    void encodeFrame();
+
+    void parseFrame_data();
+    void parseFrame();
+
+    void tr();
+};
@@ -11,6 +11,11 @@
 #include <QLowEnergyController>
 #include <QRegularExpression>
 #include <QSignalSpy>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <thread>
 
 Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitProduct))
 
@@ -30,6 +35,15 @@ public:
     bool readCharacteristics() override { return false; } // Ignored by our tests.
 };
 
+void TestAbstractPokitService::initTestCase()
+{
+    // Register the types used by AbstractPokitService::valueReceived and AbstractPokitService::requestFinished, so
+    // QSignalSpy can record their arguments.
+    qRegisterMetaType<QBluetoothUuid>("QBluetoothUuid");
+    qRegisterMetaType<qint64>("qint64");
+    qRegisterMetaType<quint64>("quint64");
+}
+
 void TestAbstractPokitService::autoDiscover()
 {
     MockPokitService service(nullptr);
@@ -40,6 +54,16 @@ void TestAbstractPokitService::autoDiscover()
     QVERIFY(service.autoDiscover());
 }
 
+void TestAbstractPokitService::skipValueDiscovery()
+{
+    MockPokitService service(nullptr);
+    QVERIFY(!service.skipValueDiscovery()); // Off, by default.
+    service.setSkipValueDiscovery();
+    QVERIFY(service.skipValueDiscovery());
+    service.setSkipValueDiscovery(false);
+    QVERIFY(!service.skipValueDiscovery());
+}
+
 void TestAbstractPokitService::pokitProduct_data()
 {
     QTest::addColumn<PokitProduct>("product");
@@ -66,6 +90,148 @@ void TestAbstractPokitService::service_()
     QCOMPARE(constService.service(), nullptr);
 }
 
+void TestAbstractPokitService::receiveTimestamp()
+{
+    MockPokitService service(nullptr);
+    QCOMPARE(service.receiveTimestamp(), -1);
+    service.d_ptr->receiveTimestamp = 123;
+    QCOMPARE(service.receiveTimestamp(), 123);
+}
+
+void TestAbstractPokitService::mtu()
+{
+    MockPokitService service(nullptr);
+    QCOMPARE(service.mtu(), -1); // No controller, so unknown.
+}
+
+void TestAbstractPokitService::lastRequestId()
+{
+    MockPokitService service(nullptr);
+    QCOMPARE(service.lastRequestId(), 0);
+    service.d_ptr->lastRequestId = 123;
+    QCOMPARE(service.lastRequestId(), 123);
+}
+
+void TestAbstractPokitService::pendingRequestCount()
+{
+    MockPokitService service(nullptr);
+    QCOMPARE(service.pendingRequestCount(), 0);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+    service.d_ptr->requests.enqueue({ 1, Type::ReadCharacteristic, QBluetoothUuid::createUuid(), QByteArray() });
+    service.d_ptr->requests.enqueue({ 2, Type::ReadCharacteristic, QBluetoothUuid::createUuid(), QByteArray() });
+    QCOMPARE(service.pendingRequestCount(), 2);
+    service.d_ptr->inFlight = { 3, Type::WriteCharacteristic, QBluetoothUuid::createUuid(), QByteArray("x") };
+    QCOMPARE(service.pendingRequestCount(), 3); // Includes the in-flight request.
+}
+
+void TestAbstractPokitService::statistics()
+{
+    MockPokitService service(nullptr);
+    AbstractPokitService::Statistics statistics = service.statistics();
+    QVERIFY(statistics.service.isNull()); // No service object created yet.
+    QCOMPARE(statistics.notifications, (quint64)0);
+    QCOMPARE(statistics.reads, (quint64)0);
+    QCOMPARE(statistics.bytes, (quint64)0);
+    QCOMPARE(statistics.parseFailures, (quint64)0);
+    QCOMPARE(statistics.errors, (quint64)0);
+    QCOMPARE(statistics.stalls, (quint64)0);
+    QCOMPARE(statistics.stallRecoveries, (quint64)0);
+    QCOMPARE(statistics.memoryBytes, (qint64)0); // No buffers accounted for.
+    QCOMPARE(statistics.notificationGaps, QVector<quint64>(AbstractPokitService::notificationGapBuckets, 0));
+    QVERIFY(statistics.parseLatency.isEmpty());
+    QVERIFY(statistics.emitLatency.isEmpty());
+
+    service.d_ptr->statistics.notifications = 123;
+    service.d_ptr->statistics.errors = 4;
+    statistics = service.statistics();
+    QCOMPARE(statistics.notifications, (quint64)123);
+    QCOMPARE(statistics.errors, (quint64)4);
+}
+
+void TestAbstractPokitService::batching()
+{
+    MockPokitService service(nullptr);
+    QCOMPARE(service.batching().maxCount, 0u);
+    QCOMPARE(service.batching().maxLatency, 0u);
+    QVERIFY(!service.d_ptr->isBatching());
+
+    service.setBatching({ 1, 0 }); // Batches of one notification are no batching at all.
+    QVERIFY(!service.d_ptr->isBatching());
+
+    service.setBatching({ 10, 0 });
+    QCOMPARE(service.batching().maxCount, 10u);
+    QVERIFY(service.d_ptr->isBatching());
+
+    service.setBatching({ 0, 5000 });
+    QCOMPARE(service.batching().maxCount, 0u);
+    QCOMPARE(service.batching().maxLatency, 5000u);
+    QVERIFY(service.d_ptr->isBatching());
+
+    // The mock service has no batches of its own, so flushing is harmless.
+    service.d_ptr->batchAppended(1);
+    QVERIFY(service.d_ptr->batchTimer);
+    QVERIFY(service.d_ptr->batchTimer->isActive());
+    QCOMPARE(service.d_ptr->batchTimer->interval(), 5);
+    service.flushBatch();
+    QVERIFY(!service.d_ptr->batchTimer->isActive());
+    QCOMPARE(service.d_ptr->batchStarted, (qint64)-1);
+}
+
+void TestAbstractPokitService::readCharacteristicsAsync()
+{
+    // Verify that failure to queue the reads (MockPokitService never does) finishes the future immediately.
+    MockPokitService service(nullptr);
+    const QFuture<bool> future = service.readCharacteristicsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
+}
+
+void TestAbstractPokitService::subscribe()
+{
+    // Verify that subscriptions fail safely, when no Bluetooth device is connected.
+    MockPokitService service(nullptr);
+    const QBluetoothUuid uuid = QBluetoothUuid::createUuid();
+    QVERIFY(!service.subscribe(uuid));
+    QVERIFY(!service.unsubscribe(uuid));
+    QCOMPARE(service.subscriberCount(uuid), 0);
+
+    // Record CCCD writes, without completing them, so they remain visible (in-flight, or queued) below.
+    QVector<QByteArray> writes;
+    service.d_ptr->requestHandler = [&writes](const AbstractPokitServicePrivate::Request &request) {
+        QVERIFY(request.type == AbstractPokitServicePrivate::Request::Type::WriteDescriptor);
+        writes.append(request.value);
+    };
+    const auto cccdWrites = [&]() { return writes.size() + service.d_ptr->requests.size(); };
+
+    // Verify that only the first subscriber enables notifications.
+    QVERIFY(service.subscribe(uuid));
+    QVERIFY(service.subscribe(uuid));
+    QCOMPARE(service.subscriberCount(uuid), 2);
+    QCOMPARE(cccdWrites(), 0); // Deferred until flushed.
+    service.d_ptr->flushSubscriptions();
+    QCOMPARE(cccdWrites(), 1);
+    QCOMPARE(writes.first(), QByteArray::fromHex("0100"));
+    QVERIFY(service.d_ptr->notifyingCharacteristics.contains(uuid));
+
+    // Verify that only the last subscriber disables notifications.
+    QVERIFY(service.unsubscribe(uuid));
+    QCOMPARE(service.subscriberCount(uuid), 1);
+    QVERIFY(service.d_ptr->pendingSubscriptions.isEmpty());
+    QVERIFY(service.unsubscribe(uuid));
+    QCOMPARE(service.subscriberCount(uuid), 0);
+    service.d_ptr->flushSubscriptions();
+    QCOMPARE(cccdWrites(), 2);
+    QVERIFY(!service.d_ptr->notifyingCharacteristics.contains(uuid));
+    QVERIFY(!service.unsubscribe(uuid)); // No subscribers left.
+
+    // Verify that a subscribe and unsubscribe, between flushes, cancel each other out.
+    QVERIFY(service.subscribe(uuid));
+    QVERIFY(service.unsubscribe(uuid));
+    service.d_ptr->flushSubscriptions();
+    QCOMPARE(cccdWrites(), 2);
+    QVERIFY(service.d_ptr->pendingSubscriptions.isEmpty());
+}
+
 void TestAbstractPokitService::createServiceObject()
 {
     if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
@@ -116,6 +282,28 @@ void TestAbstractPokitService::getCharacteristic()
     }
 }
 
+void TestAbstractPokitService::resolveCharacteristics()
+{
+    // Verify safe error handling (can't resolve characteristics without a Bluetooth device).
+    MockPokitService service(nullptr);
+    const QBluetoothUuid uuid = QBluetoothUuid::createUuid();
+    service.d_ptr->characteristics.insert(uuid, { });
+    service.d_ptr->resolveCharacteristics();
+    QVERIFY(service.d_ptr->characteristics.isEmpty());
+    QVERIFY(!service.d_ptr->getClientConfiguration(uuid).isValid());
+
+    // Verify that cached characteristics are served without a service object, but dropped on any state change.
+    service.d_ptr->characteristics.insert(uuid, { });
+    QVERIFY(!service.d_ptr->getCharacteristic(uuid).isValid());
+    QVERIFY(!service.d_ptr->getClientConfiguration(uuid).isValid());
+    #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+    service.d_ptr->stateChanged(QLowEnergyService::ServiceState::DiscoveringServices);
+    #else
+    service.d_ptr->stateChanged(QLowEnergyService::ServiceState::RemoteServiceDiscovering);
+    #endif
+    QVERIFY(service.d_ptr->characteristics.isEmpty());
+}
+
 void TestAbstractPokitService::readCharacteristic()
 {
     // Verify that characteristic reads fail safely, when no Bluetooth device is connected.
@@ -209,6 +397,526 @@ void TestAbstractPokitService::toHexString()
     QCOMPARE(AbstractPokitServicePrivate::toHexString(data, max), expected);
 }
 
+void TestAbstractPokitService::steadyTimestamp()
+{
+    const qint64 first = AbstractPokitServicePrivate::steadyTimestamp();
+    const qint64 second = AbstractPokitServicePrivate::steadyTimestamp();
+    QVERIFY(first > 0);
+    QVERIFY(second >= first);
+}
+
+void TestAbstractPokitService::countParseFailure()
+{
+    const quint64 before = AbstractPokitServicePrivate::parseFailureCount();
+    AbstractPokitServicePrivate::countParseFailure();
+    QCOMPARE(AbstractPokitServicePrivate::parseFailureCount(), before + 1);
+
+    // Verify that checkSize() counts its rejections, but not its (non-failing) warnings.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^short requires 2 byte/s"_s));
+    QVERIFY(!AbstractPokitServicePrivate::checkSize(u"short"_s, QByteArray("\x01"), 2));
+    QCOMPARE(AbstractPokitServicePrivate::parseFailureCount(), before + 2);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^long has 1 extraneous byte/s"_s));
+    QVERIFY(AbstractPokitServicePrivate::checkSize(u"long"_s, QByteArray("\x01\x02"), 1, 1));
+    QCOMPARE(AbstractPokitServicePrivate::parseFailureCount(), before + 2);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^long has 1 extraneous byte/s"_s));
+    QVERIFY(!AbstractPokitServicePrivate::checkSize(u"long"_s, QByteArray("\x01\x02"), 1, 1, true));
+    QCOMPARE(AbstractPokitServicePrivate::parseFailureCount(), before + 3);
+
+    // Verify that failures are counted per thread.
+    quint64 otherThreadCount = 123;
+    std::thread([&otherThreadCount]() {
+        otherThreadCount = AbstractPokitServicePrivate::parseFailureCount();
+    }).join();
+    QCOMPARE(otherThreadCount, (quint64)0);
+}
+
+void TestAbstractPokitService::notificationGapBucket_data()
+{
+    QTest::addColumn<qint64>("gap");
+    QTest::addColumn<int>("expected");
+    QTest::addRow("negative") << (qint64)-1000000       << 0;
+    QTest::addRow("0ns")      << (qint64)0              << 0;
+    QTest::addRow("999us")    << (qint64)999999         << 0;
+    QTest::addRow("1ms")      << (qint64)1000000        << 1;
+    QTest::addRow("1.9ms")    << (qint64)1900000        << 1;
+    QTest::addRow("2ms")      << (qint64)2000000        << 2;
+    QTest::addRow("7ms")      << (qint64)7000000        << 3;
+    QTest::addRow("8ms")      << (qint64)8000000        << 4;
+    QTest::addRow("16383ms")  << (qint64)16383000000    << 14;
+    QTest::addRow("16384ms")  << (qint64)16384000000    << 15;
+    QTest::addRow("1h")       << (qint64)3600000000000  << 15;
+}
+
+void TestAbstractPokitService::notificationGapBucket()
+{
+    QFETCH(qint64, gap);
+    QFETCH(int, expected);
+    QCOMPARE(AbstractPokitServicePrivate::notificationGapBucket(gap), expected);
+}
+
+void TestAbstractPokitService::countValue()
+{
+    MockPokitService service(nullptr);
+    service.d_ptr->countValue(QByteArray(5, '\x01'), 0); // A read.
+    service.d_ptr->countValue(QByteArray(3, '\x01'), 1, 1000000000);
+    service.d_ptr->countValue(QByteArray(3, '\x01'), 0, 1000500000); // 0.5ms after the first notification.
+    service.d_ptr->countValue(QByteArray(3, '\x01'), 0, 1010500000); // 10ms after the second notification.
+    const AbstractPokitService::Statistics statistics = service.statistics();
+    QCOMPARE(statistics.reads, (quint64)1);
+    QCOMPARE(statistics.notifications, (quint64)3);
+    QCOMPARE(statistics.bytes, (quint64)14);
+    QCOMPARE(statistics.parseFailures, (quint64)1);
+    QVector<quint64> expectedGaps(AbstractPokitService::notificationGapBuckets, 0);
+    expectedGaps[0] = 1;
+    expectedGaps[4] = 1;
+    QCOMPARE(statistics.notificationGaps, expectedGaps);
+    QCOMPARE(service.d_ptr->notifyTimestamp, (qint64)1010500000);
+}
+
+void TestAbstractPokitService::countLatency()
+{
+    MockPokitService service(nullptr);
+    service.d_ptr->countLatency(AbstractPokitServicePrivate::steadyTimestamp()); // Nothing received yet.
+    QVERIFY(service.statistics().parseLatency.isEmpty());
+
+    service.d_ptr->receiveTimestamp = AbstractPokitServicePrivate::steadyTimestamp() - 2'000'000; // 2ms ago.
+    const qint64 parsedAt = service.d_ptr->receiveTimestamp + 1'000'000; // 1ms after receipt.
+    service.d_ptr->countLatency(parsedAt);
+    const AbstractPokitService::Statistics statistics = service.statistics();
+    QCOMPARE(statistics.parseLatency.count(), (quint64)1);
+    QCOMPARE(statistics.parseLatency.minimum(), (qint64)1'000'000);
+    QCOMPARE(statistics.emitLatency.count(), (quint64)1);
+    QVERIFY(statistics.emitLatency.minimum() >= 2'000'000);
+}
+
+void TestAbstractPokitService::beginTransfer()
+{
+    MockPokitService service(nullptr);
+    QVERIFY(!service.d_ptr->transfer);
+    service.d_ptr->beginTransfer(0); // Nothing to transfer.
+    QVERIFY(!service.d_ptr->transfer);
+
+    service.d_ptr->beginTransfer(100);
+    QVERIFY(service.d_ptr->transfer);
+    QCOMPARE(service.d_ptr->transfer->expectedBytes, 100);
+    QCOMPARE(service.d_ptr->transfer->bytes, 0);
+    QCOMPARE(service.d_ptr->transfer->packets, 0);
+
+    // Beginning another transfer replaces the incomplete one.
+    service.d_ptr->countTransfer(QByteArray(20, '\0'));
+    service.d_ptr->beginTransfer(200);
+    QVERIFY(service.d_ptr->transfer);
+    QCOMPARE(service.d_ptr->transfer->expectedBytes, 200);
+    QCOMPARE(service.d_ptr->transfer->bytes, 0);
+    QCOMPARE(service.d_ptr->transfer->packets, 0);
+}
+
+void TestAbstractPokitService::countTransfer()
+{
+    MockPokitService service(nullptr);
+    service.d_ptr->countTransfer(QByteArray(20, '\0')); // No transfer in progress, so should be ignored.
+    QVERIFY(!service.d_ptr->transfer);
+
+    service.d_ptr->beginTransfer(50);
+    service.d_ptr->countTransfer(QByteArray(20, '\0'));
+    QVERIFY(service.d_ptr->transfer);
+    QCOMPARE(service.d_ptr->transfer->bytes, 20);
+    QCOMPARE(service.d_ptr->transfer->packets, 1);
+    service.d_ptr->countTransfer(QByteArray(20, '\0'));
+    QCOMPARE(service.d_ptr->transfer->bytes, 40);
+    QCOMPARE(service.d_ptr->transfer->packets, 2);
+    service.d_ptr->countTransfer(QByteArray(10, '\0'));
+    QVERIFY(!service.d_ptr->transfer); // All expected bytes received, so ended.
+}
+
+void TestAbstractPokitService::endTransfer()
+{
+    MockPokitService service(nullptr);
+    service.d_ptr->endTransfer(); // No transfer in progress, so should be a no-op.
+    QVERIFY(!service.d_ptr->transfer);
+
+    service.d_ptr->beginTransfer(50);
+    service.d_ptr->countTransfer(QByteArray(20, '\0'));
+    service.d_ptr->endTransfer();
+    QVERIFY(!service.d_ptr->transfer);
+}
+
+void TestAbstractPokitService::resume()
+{
+    MockPokitService service(nullptr);
+    const QBluetoothUuid notifying = QBluetoothUuid::createUuid(), setting = QBluetoothUuid::createUuid();
+    service.d_ptr->resumableCharacteristics.insert(setting);
+    QVERIFY(!service.d_ptr->writeCharacteristic(setting, QByteArray("x"))); // Fails without a service object.
+    QVERIFY(service.d_ptr->resumeValues.isEmpty()); // So nothing to resume.
+
+    // Re-enabling and re-writing will fail without a service object, but should not lose what is to be resumed.
+    service.d_ptr->notifyingCharacteristics.insert(notifying);
+    service.d_ptr->resumeValues.insert(setting, QByteArray("x"));
+    service.d_ptr->receiveTimestamp = 123;
+    QSignalSpy spy(&service, &AbstractPokitService::resumed);
+    service.d_ptr->resume();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.constFirst().at(0).toLongLong(), 123);
+    QVERIFY(spy.constFirst().at(1).toLongLong() >= 123);
+    QCOMPARE(service.d_ptr->notifyingCharacteristics, QSet<QBluetoothUuid>{ notifying });
+    QCOMPARE(service.d_ptr->resumeValues.value(setting), QByteArray("x"));
+}
+
+void TestAbstractPokitService::queueRequest()
+{
+    // Block the queue with an in-flight request, so queued requests remain queued.
+    MockPokitService service(nullptr);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+    service.d_ptr->inFlight = { 0, Type::WriteCharacteristic, QBluetoothUuid::createUuid(), QByteArray("x") };
+    QSignalSpy spy(&service, &AbstractPokitService::requestFinished);
+
+    const QBluetoothUuid first = QBluetoothUuid::createUuid(), second = QBluetoothUuid::createUuid();
+    QCOMPARE(service.d_ptr->queueRequest(Type::ReadCharacteristic, first), 1);
+    QCOMPARE(service.d_ptr->queueRequest(Type::ReadCharacteristic, second), 2);
+    QCOMPARE(service.d_ptr->queueRequest(Type::WriteCharacteristic, first, QByteArray("y")), 3);
+    QCOMPARE(service.lastRequestId(), 3);
+
+    // Verify that duplicate pending reads are coalesced, but duplicate writes are not.
+    QCOMPARE(service.d_ptr->queueRequest(Type::ReadCharacteristic, first), 1);
+    QCOMPARE(service.lastRequestId(), 1);
+    QCOMPARE(service.d_ptr->queueRequest(Type::WriteCharacteristic, first, QByteArray("y")), 4);
+    QCOMPARE(service.d_ptr->requests.size(), 4);
+    QCOMPARE(service.pendingRequestCount(), 5);
+
+    // Verify that pending writes of coalesced characteristics are coalesced too, with the last writer winning.
+    service.d_ptr->coalescedCharacteristics.insert(second);
+    QCOMPARE(service.d_ptr->queueRequest(Type::WriteCharacteristic, second, QByteArray("a")), 5);
+    QCOMPARE(service.d_ptr->queueRequest(Type::WriteCharacteristic, second, QByteArray("b")), 5);
+    QCOMPARE(service.d_ptr->queueRequest(Type::WriteCharacteristic, second, QByteArray("c")), 5);
+    QCOMPARE(service.lastRequestId(), 5);
+    QCOMPARE(service.d_ptr->requests.size(), 5);
+    QCOMPARE(service.d_ptr->requests.last().value, QByteArray("c"));
+    QCOMPARE(spy.count(), 0); // Nothing issued, or finished, yet.
+}
+
+void TestAbstractPokitService::processRequests()
+{
+    // Verify that requests which cannot be issued (here, for lack of a service) fail immediately, in order.
+    MockPokitService service(nullptr);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+    QSignalSpy spy(&service, &AbstractPokitService::requestFinished);
+    QVERIFY(!service.d_ptr->readCharacteristic(QBluetoothUuid::createUuid())); // Rejected before queuing.
+    QCOMPARE(spy.count(), 0);
+    service.d_ptr->requests.enqueue({ 1, Type::ReadCharacteristic, QBluetoothUuid::createUuid(), QByteArray() });
+    service.d_ptr->requests.enqueue({ 2, Type::WriteDescriptor, QBluetoothUuid::createUuid(), QByteArray("x") });
+    service.d_ptr->processRequests();
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(0).toULongLong(), 1);
+    QCOMPARE(spy.at(0).at(1).toBool(), false);
+    QCOMPARE(spy.at(1).at(0).toULongLong(), 2);
+    QCOMPARE(spy.at(1).at(1).toBool(), false);
+    QCOMPARE(service.pendingRequestCount(), 0);
+    QVERIFY(!service.d_ptr->inFlight);
+}
+
+void TestAbstractPokitService::completeUnacknowledgedWrite()
+{
+    MockPokitService service(nullptr);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+    const AbstractPokitServicePrivate::Request request{ 1, Type::WriteCharacteristic, QBluetoothUuid::createUuid(),
+                                                        QByteArray("x") };
+    service.d_ptr->inFlight = request;
+    QSignalSpy spy(&service, &AbstractPokitService::requestFinished);
+
+    // Verify that the write is completed (successfully) later, rather than synchronously.
+    service.d_ptr->completeUnacknowledgedWrite(QLowEnergyCharacteristic(), request);
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toULongLong(), 1);
+    QCOMPARE(spy.at(0).at(1).toBool(), true);
+    QVERIFY(!service.d_ptr->inFlight);
+
+    // Verify that the completion is ignored if the request has already finished some other way (such as an error).
+    service.d_ptr->inFlight = request;
+    service.d_ptr->completeUnacknowledgedWrite(QLowEnergyCharacteristic(), request);
+    service.d_ptr->finishRequest(false);
+    QCOMPARE(spy.count(), 2);
+    QTest::qWait(10);
+    QCOMPARE(spy.count(), 2);
+}
+
+void TestAbstractPokitService::completeRequest()
+{
+    MockPokitService service(nullptr);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+    const QBluetoothUuid uuid = QBluetoothUuid::createUuid();
+    service.d_ptr->inFlight = { 1, Type::ReadCharacteristic, uuid, QByteArray() };
+    service.d_ptr->requests.enqueue({ 2, Type::WriteCharacteristic, uuid, QByteArray("x") });
+    QSignalSpy spy(&service, &AbstractPokitService::requestFinished);
+
+    // Verify that non-matching completions are ignored.
+    service.d_ptr->completeRequest(Type::WriteCharacteristic, uuid);
+    service.d_ptr->completeRequest(Type::ReadCharacteristic, QBluetoothUuid::createUuid());
+    QCOMPARE(spy.count(), 0);
+    QCOMPARE(service.pendingRequestCount(), 2);
+
+    // Verify that the matching completion succeeds, and the next request is then issued (and here, fails).
+    service.d_ptr->completeRequest(Type::ReadCharacteristic, uuid);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(0).toULongLong(), 1);
+    QCOMPARE(spy.at(0).at(1).toBool(), true);
+    QCOMPARE(spy.at(1).at(0).toULongLong(), 2);
+    QCOMPARE(spy.at(1).at(1).toBool(), false);
+    QCOMPARE(service.pendingRequestCount(), 0);
+
+    // Verify that descriptor writes complete regardless of UUID (since Qt does not report the characteristic).
+    service.d_ptr->inFlight = { 3, Type::WriteDescriptor, uuid, QByteArray("x") };
+    service.d_ptr->completeRequest(Type::WriteDescriptor, QBluetoothUuid());
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(2).at(0).toULongLong(), 3);
+    QCOMPARE(spy.at(2).at(1).toBool(), true);
+}
+
+void TestAbstractPokitService::requestTimedOut()
+{
+    MockPokitService service(nullptr);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+    QSignalSpy spy(&service, &AbstractPokitService::requestFinished);
+
+    // Verify that the timeout is ignored if nothing is in flight.
+    service.d_ptr->requestTimedOut();
+    QCOMPARE(spy.count(), 0);
+
+    // Verify that requests whose completions never arrive fail, without stalling the requests queued behind them.
+    QVector<quint64> issued;
+    service.d_ptr->requestHandler = [&issued](const AbstractPokitServicePrivate::Request &request) {
+        issued.append(request.id); // But never finish the request.
+    };
+    service.d_ptr->requestTimeout = 10;
+    service.d_ptr->requests.enqueue({ 1, Type::ReadCharacteristic, QBluetoothUuid::createUuid(), QByteArray() });
+    service.d_ptr->requests.enqueue({ 2, Type::WriteCharacteristic, QBluetoothUuid::createUuid(), QByteArray("x") });
+    service.d_ptr->processRequests();
+    QCOMPARE(issued, QVector<quint64>{ 1 });
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(issued, (QVector<quint64>{ 1, 2 }));
+    for (int index = 0; index < spy.count(); ++index) {
+        QCOMPARE(spy.at(index).at(0).toULongLong(), (quint64)index + 1);
+        QCOMPARE(spy.at(index).at(1).toBool(), false);
+    }
+    QVERIFY(!service.d_ptr->inFlight);
+    QVERIFY(!service.d_ptr->requestTimer->isActive());
+
+    // Verify that requests completing in time stop the timer.
+    service.d_ptr->requests.enqueue({ 3, Type::ReadCharacteristic, QBluetoothUuid::createUuid(), QByteArray() });
+    service.d_ptr->processRequests();
+    QVERIFY(service.d_ptr->requestTimer->isActive());
+    service.d_ptr->finishRequest(true);
+    QVERIFY(!service.d_ptr->requestTimer->isActive());
+    QTest::qWait(20);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(2).at(1).toBool(), true);
+}
+
+void TestAbstractPokitService::requestTimedOut_lateCompletion()
+{
+    MockPokitService service(nullptr);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+    const QBluetoothUuid uuid = QBluetoothUuid::createUuid();
+    QSignalSpy spy(&service, &AbstractPokitService::requestFinished);
+
+    // Verify that a late characteristicWritten for a timed out write is not credited to the next same-UUID write.
+    service.d_ptr->inFlight = { 1, Type::WriteCharacteristic, uuid, QByteArray("a") };
+    service.d_ptr->requestTimedOut();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toULongLong(), 1);
+    QCOMPARE(spy.at(0).at(1).toBool(), false);
+    QCOMPARE(service.d_ptr->abandoned.size(), 1);
+    service.d_ptr->inFlight = { 2, Type::WriteCharacteristic, uuid, QByteArray("b") };
+    service.d_ptr->completeRequest(Type::WriteCharacteristic, uuid); // Request 1's late completion.
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(service.d_ptr->inFlight);
+    QCOMPARE(service.d_ptr->inFlight->id, (quint64)2);
+    QVERIFY(service.d_ptr->abandoned.isEmpty());
+    service.d_ptr->completeRequest(Type::WriteCharacteristic, uuid); // Request 2's own completion.
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toULongLong(), 2);
+    QCOMPARE(spy.at(1).at(1).toBool(), true);
+    QVERIFY(!service.d_ptr->inFlight);
+
+    // Verify the same for descriptor writes, which do not identify their characteristic.
+    service.d_ptr->inFlight = { 3, Type::WriteDescriptor, uuid, QByteArray("x") };
+    service.d_ptr->requestTimedOut();
+    service.d_ptr->inFlight = { 4, Type::WriteDescriptor, QBluetoothUuid::createUuid(), QByteArray("x") };
+    service.d_ptr->completeRequest(Type::WriteDescriptor, QBluetoothUuid());
+    QCOMPARE(spy.count(), 3);
+    QVERIFY(service.d_ptr->inFlight);
+    QCOMPARE(service.d_ptr->inFlight->id, (quint64)4);
+
+    // Verify that abandoned requests are forgotten once all requests have failed.
+    service.d_ptr->inFlight = { 5, Type::ReadCharacteristic, uuid, QByteArray() };
+    service.d_ptr->requestTimedOut();
+    QCOMPARE(service.d_ptr->abandoned.size(), 1);
+    service.d_ptr->failRequests();
+    QVERIFY(service.d_ptr->abandoned.isEmpty());
+}
+
+void TestAbstractPokitService::failRequests()
+{
+    MockPokitService service(nullptr);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+    service.d_ptr->inFlight = { 1, Type::ReadCharacteristic, QBluetoothUuid::createUuid(), QByteArray() };
+    service.d_ptr->requests.enqueue({ 2, Type::ReadCharacteristic, QBluetoothUuid::createUuid(), QByteArray() });
+    service.d_ptr->requests.enqueue({ 3, Type::WriteCharacteristic, QBluetoothUuid::createUuid(), QByteArray() });
+    QSignalSpy spy(&service, &AbstractPokitService::requestFinished);
+    service.d_ptr->failRequests();
+    QCOMPARE(spy.count(), 3);
+    for (int index = 0; index < spy.count(); ++index) {
+        QCOMPARE(spy.at(index).at(0).toULongLong(), (quint64)index + 1);
+        QCOMPARE(spy.at(index).at(1).toBool(), false);
+    }
+    QCOMPARE(service.pendingRequestCount(), 0);
+}
+
+void TestAbstractPokitService::whenFinished()
+{
+    MockPokitService service(nullptr);
+    using Type = AbstractPokitServicePrivate::Request::Type;
+
+    // Verify that futures finish immediately if nothing was queued.
+    QFuture<bool> future = service.d_ptr->whenFinished([]{ return false; });
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
+    future = service.d_ptr->whenFinished([]{ return true; });
+    QVERIFY(future.isFinished());
+    QVERIFY(future.result());
+
+    // Block the queue with an in-flight request, so queued requests remain queued.
+    service.d_ptr->inFlight = { 0, Type::WriteCharacteristic, QBluetoothUuid::createUuid(), QByteArray("x") };
+    const QBluetoothUuid uuid = QBluetoothUuid::createUuid();
+    future = service.d_ptr->whenFinished([&service, &uuid]{
+        service.d_ptr->queueRequest(Type::ReadCharacteristic, uuid);
+        service.d_ptr->queueRequest(Type::ReadCharacteristic, QBluetoothUuid::createUuid());
+        return true;
+    });
+    QVERIFY(!future.isFinished());
+
+    // Verify that a coalesced request is waited on too.
+    QFuture<bool> coalesced = service.d_ptr->whenFinished([&service, &uuid]{
+        service.d_ptr->queueRequest(Type::ReadCharacteristic, uuid);
+        return true;
+    });
+    QVERIFY(!coalesced.isFinished());
+
+    // Verify that futures finish only once all of their requests have finished.
+    service.d_ptr->requests.clear();
+    service.d_ptr->inFlight.reset();
+    service.d_ptr->notifyFinished(1, true);
+    QVERIFY(!future.isFinished());
+    QVERIFY(coalesced.isFinished());
+    QVERIFY(coalesced.result());
+    service.d_ptr->notifyFinished(2, false);
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
+    QVERIFY(service.d_ptr->waiters.isEmpty());
+}
+
+void TestAbstractPokitService::whenFinished_destroyed()
+{
+    // Verify that outstanding futures are finished (as failures) when their service is destroyed.
+    auto service = new MockPokitService(nullptr);
+    service->d_ptr->inFlight = { 0, AbstractPokitServicePrivate::Request::Type::WriteCharacteristic,
+                                 QBluetoothUuid::createUuid(), QByteArray("x") };
+    const QFuture<bool> future = service->d_ptr->whenFinished([service]{
+        service->d_ptr->queueRequest(AbstractPokitServicePrivate::Request::Type::ReadCharacteristic,
+                                     QBluetoothUuid::createUuid());
+        return true;
+    });
+    QVERIFY(!future.isFinished());
+    delete service;
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
+}
+
+void TestAbstractPokitService::whenFinished_thread()
+{
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 10, 0))
+    QSKIP("Cross-thread service access requires Qt 5.10 or later");
+    #else
+    // Verify that futures requested from another thread are issued, and finished, on the service's own thread.
+    QThread thread;
+    auto service = new MockPokitService(nullptr);
+    service->moveToThread(&thread);
+    connect(&thread, &QThread::finished, service, &QObject::deleteLater);
+    thread.start();
+
+    std::atomic<QThread *> issuedOn { nullptr };
+    QFuture<bool> future = service->d_ptr->whenFinished([&issuedOn]{
+        issuedOn = QThread::currentThread();
+        return false;
+    });
+    future.waitForFinished();
+    QCOMPARE(issuedOn.load(), &thread);
+    QVERIFY(!future.result());
+
+    thread.quit();
+    QVERIFY(thread.wait());
+    #endif
+}
+
+void TestAbstractPokitService::invokeOnServiceThread()
+{
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 10, 0))
+    QSKIP("Cross-thread service access requires Qt 5.10 or later");
+    #else
+    auto service = new MockPokitService(nullptr);
+    bool invoked = false;
+    QVERIFY(!service->d_ptr->invokeOnServiceThread([&invoked]{ invoked = true; })); // Already on its thread.
+    QVERIFY(!invoked);
+
+    // The private implementation (as a child of the service) moves with the service.
+    QThread thread;
+    service->moveToThread(&thread);
+    QCOMPARE(service->d_ptr->thread(), &thread);
+    connect(&thread, &QThread::finished, service, &QObject::deleteLater);
+    thread.start();
+
+    std::atomic<QThread *> invokedOn { nullptr };
+    QVERIFY(service->d_ptr->invokeOnServiceThread([&invokedOn]{ invokedOn = QThread::currentThread(); }));
+    QTRY_COMPARE(invokedOn.load(), &thread);
+
+    // GATT operations from other threads are queued (and here, fail on the service's thread, without a service).
+    QVERIFY(service->d_ptr->readCharacteristic(QBluetoothUuid::createUuid()));
+    QVERIFY(service->d_ptr->writeCharacteristic(QBluetoothUuid::createUuid(), QByteArray("x")));
+
+    thread.quit();
+    QVERIFY(thread.wait());
+    #endif
+}
+
+void TestAbstractPokitService::setNotificationHandler()
+{
+    MockPokitService service(nullptr);
+    QVERIFY(service.d_ptr->notificationHandlers.isEmpty());
+    const QBluetoothUuid first = QBluetoothUuid::createUuid(), second = QBluetoothUuid::createUuid();
+    int handled = 0;
+    service.d_ptr->setNotificationHandler(first, [&handled](const QByteArray &){ handled = 1; });
+    service.d_ptr->setNotificationHandler(second, [&handled](const QByteArray &){ handled = 2; });
+    QCOMPARE(service.d_ptr->notificationHandlers.size(), 2);
+
+    // Verify that existing handlers are replaced, not duplicated.
+    service.d_ptr->setNotificationHandler(first, [&handled](const QByteArray &){ handled = 3; });
+    QCOMPARE(service.d_ptr->notificationHandlers.size(), 2);
+    QCOMPARE(service.d_ptr->notificationHandlers.at(0).first, first);
+    service.d_ptr->notificationHandlers.at(0).second(QByteArray());
+    QCOMPARE(handled, 3);
+    QVERIFY(service.d_ptr->notificationRoutes.isEmpty()); // No service, so nothing to route yet.
+}
+
+void TestAbstractPokitService::resolveNotificationRoutes()
+{
+    // Verify safe error handling (can't resolve handles without a Bluetooth device).
+    MockPokitService service(nullptr);
+    service.d_ptr->notificationRoutes.insert(1, [](const QByteArray &){ });
+    service.d_ptr->resolveNotificationRoutes();
+    QVERIFY(service.d_ptr->notificationRoutes.isEmpty());
+}
+
 void TestAbstractPokitService::connected()
 {
     if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
@@ -251,6 +959,18 @@ void TestAbstractPokitService::errorOccurred()
     QSignalSpy spy(&service, &AbstractPokitService::serviceErrorOccurred);
     service.d_ptr->errorOccurred(QLowEnergyService::ServiceError::UnknownError);
     QCOMPARE(spy.count(), 1);
+
+    // Verify that errors fail the in-flight request, if any.
+    QSignalSpy finishedSpy(&service, &AbstractPokitService::requestFinished);
+    service.d_ptr->inFlight = { 1, AbstractPokitServicePrivate::Request::Type::WriteCharacteristic,
+                                QBluetoothUuid::createUuid(), QByteArray("x") };
+    service.d_ptr->errorOccurred(QLowEnergyService::ServiceError::CharacteristicWriteError);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(service.statistics().errors, (quint64)2);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.at(0).at(0).toULongLong(), 1);
+    QCOMPARE(finishedSpy.at(0).at(1).toBool(), false);
+    QVERIFY(!service.d_ptr->inFlight);
 }
 
 void TestAbstractPokitService::serviceDiscovered()
@@ -281,6 +1001,65 @@ void TestAbstractPokitService::stateChanged()
     service.d_ptr->stateChanged(QLowEnergyService::ServiceState::RemoteServiceDiscovered);
     #endif
     QCOMPARE(spy.count(), 1); // Signaled.
+
+    // Verify that queued requests fail when the service becomes invalid.
+    service.d_ptr->requests.enqueue({ 1, AbstractPokitServicePrivate::Request::Type::ReadCharacteristic,
+                                      QBluetoothUuid::createUuid(), QByteArray() });
+    QSignalSpy finishedSpy(&service, &AbstractPokitService::requestFinished);
+    service.d_ptr->stateChanged(QLowEnergyService::ServiceState::InvalidService);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(service.pendingRequestCount(), 0);
+}
+
+void TestAbstractPokitService::notified()
+{
+    MockPokitService service(nullptr);
+    const QLowEnergyCharacteristic characteristic =
+        service.d_ptr->getCharacteristic(QUuid::createUuid());
+    QSignalSpy spy(&service, &AbstractPokitService::valueReceived);
+
+    // Verify that unrouted notifications are still handled (via characteristicChanged).
+    service.d_ptr->notified(characteristic, QByteArray());
+    QCOMPARE(spy.count(), 1);
+
+    // Verify that routed notifications go to their handler, and are still timestamped.
+    QByteArray handled;
+    service.d_ptr->notificationRoutes.insert(characteristic.handle(),
+        [&handled](const QByteArray &value){ handled = value; });
+    service.d_ptr->notified(characteristic, QByteArray("\x01\x02"));
+    QCOMPARE(handled, QByteArray("\x01\x02"));
+    QCOMPARE(spy.count(), 2);
+
+    // Verify that notifications, and their handlers' parse failures, are counted.
+    service.d_ptr->notificationRoutes.insert(characteristic.handle(), [](const QByteArray &value){
+        AbstractPokitServicePrivate::checkSize(u"value"_s, value, 4);
+    });
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^value requires 4 byte/s"_s));
+    service.d_ptr->notified(characteristic, QByteArray("\x01\x02\x03"));
+    const AbstractPokitService::Statistics statistics = service.statistics();
+    QCOMPARE(statistics.notifications, (quint64)3);
+    QCOMPARE(statistics.bytes, (quint64)5);
+    QCOMPARE(statistics.parseFailures, (quint64)1);
+    quint64 gaps = 0;
+    for (const quint64 count: statistics.notificationGaps) {
+        gaps += count;
+    }
+    QCOMPARE(gaps, (quint64)2);
+}
+
+void TestAbstractPokitService::valueRead()
+{
+    MockPokitService service(nullptr);
+    const QLowEnergyCharacteristic characteristic =
+        service.d_ptr->getCharacteristic(QUuid::createUuid());
+    QSignalSpy spy(&service, &AbstractPokitService::valueReceived);
+    service.d_ptr->valueRead(characteristic, QByteArray("\x01\x02"));
+    QCOMPARE(spy.count(), 1); // Dispatched via characteristicRead().
+    const AbstractPokitService::Statistics statistics = service.statistics();
+    QCOMPARE(statistics.reads, (quint64)1);
+    QCOMPARE(statistics.notifications, (quint64)0);
+    QCOMPARE(statistics.bytes, (quint64)2);
+    QCOMPARE(statistics.parseFailures, (quint64)0);
 }
 
 void TestAbstractPokitService::characteristicRead()
@@ -289,7 +1068,12 @@ void TestAbstractPokitService::characteristicRead()
     MockPokitService service(nullptr);
     const QLowEnergyCharacteristic characteristic =
         service.d_ptr->getCharacteristic(QUuid::createUuid());
+    QSignalSpy spy(&service, &AbstractPokitService::valueReceived);
+    const qint64 before = AbstractPokitServicePrivate::steadyTimestamp();
     service.d_ptr->characteristicRead(characteristic, QByteArray());
+    QVERIFY(service.receiveTimestamp() >= before);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(1).toLongLong(), service.receiveTimestamp());
 }
 
 void TestAbstractPokitService::characteristicWritten()
@@ -307,7 +1091,12 @@ void TestAbstractPokitService::characteristicChanged()
     MockPokitService service(nullptr);
     const QLowEnergyCharacteristic characteristic =
         service.d_ptr->getCharacteristic(QUuid::createUuid());
+    QSignalSpy spy(&service, &AbstractPokitService::valueReceived);
+    const qint64 before = AbstractPokitServicePrivate::steadyTimestamp();
     service.d_ptr->characteristicChanged(characteristic, QByteArray());
+    QVERIFY(service.receiveTimestamp() >= before);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(1).toLongLong(), service.receiveTimestamp());
 }
 
 void TestAbstractPokitService::tr()
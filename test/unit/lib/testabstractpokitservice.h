@@ -12,19 +12,32 @@ class TestAbstractPokitService : public QObject
     Q_OBJECT
 
 private slots:
+    void initTestCase();
+
     // AbstractPokitService tests.
 
     void autoDiscover();
+    void skipValueDiscovery();
 
     void pokitProduct_data();
     void pokitProduct();
 
     void service_();
 
+    void receiveTimestamp();
+    void mtu();
+    void lastRequestId();
+    void pendingRequestCount();
+    void statistics();
+    void batching();
+    void readCharacteristicsAsync();
+    void subscribe();
+
     // AbstractPokitServicePrivate tests.
     // Most of these only test safe error handling, since more would require mocking Qt's BLE classes.
     void createServiceObject();
     void getCharacteristic();
+    void resolveCharacteristics();
     void readCharacteristic();
     void enableCharacteristicNotificatons();
     void disableCharacteristicNotificatons();
@@ -35,11 +48,43 @@ private slots:
     void toHexString_data();
     void toHexString();
 
+    void steadyTimestamp();
+
+    void countParseFailure();
+    void notificationGapBucket_data();
+    void notificationGapBucket();
+    void countValue();
+    void countLatency();
+
+    void beginTransfer();
+    void countTransfer();
+    void endTransfer();
+
+    void resume();
+
+    void queueRequest();
+    void processRequests();
+    void completeUnacknowledgedWrite();
+    void completeRequest();
+    void requestTimedOut();
+    void requestTimedOut_lateCompletion();
+    void failRequests();
+    void whenFinished();
+    void whenFinished_destroyed();
+    void whenFinished_thread();
+
+    void invokeOnServiceThread();
+
+    void setNotificationHandler();
+    void resolveNotificationRoutes();
+
     void connected();
     void discoveryFinished();
     void errorOccurred();
     void serviceDiscovered();
     void stateChanged();
+    void notified();
+    void valueRead();
 
     void characteristicRead();
     void characteristicWritten();
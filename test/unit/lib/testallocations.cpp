@@ -0,0 +1,222 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testallocations.h"
+#include "../allocationcounter.h"
+
+#include <qtpokit/dsocapture.h>
+#include <qtpokit/ringbuffer.h>
+#include <qtpokit/samplepool.h>
+#include <qtpokit/sharedsamplering.h>
+#include "dataloggerservice_p.h"
+#include "dsoservice_p.h"
+#include "multimeterservice_p.h"
+#include "statusservice_p.h"
+
+#include <QUuid>
+
+#include <memory>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+// Before Qt 6.4, the string literal labels that parsers pass to checkSize() are built on the heap.
+constexpr quint64 labelAllocations { (QT_VERSION < QT_VERSION_CHECK(6, 4, 0)) ? 1u : 0u };
+
+// A little-endian sample payload, of the size Pokit devices typically notify.
+QByteArray samplesValue(const int count)
+{
+    QByteArray value;
+    for (int index = 0; index < count; ++index) {
+        value.append((char)(index & 0xFF)).append((char)(index >> 8));
+    }
+    return value;
+}
+
+}
+
+void TestAllocations::init()
+{
+    if (!AllocationCounter::isSupported()) {
+        QSKIP("Allocation counting is not supported by this build");
+    }
+}
+
+void TestAllocations::counter()
+{
+    QCOMPARE(AllocationCounter::measure([]{ }), (quint64)0);
+
+    std::unique_ptr<int> pointer;
+    QVERIFY(AllocationCounter::measure([&pointer]{ pointer.reset(new int(1)); }) >= (quint64)1);
+
+    AllocationCounter counter;
+    pointer.reset(new int(2));
+    QVERIFY(counter.count() >= (quint64)1);
+    counter.reset();
+    QCOMPARE(counter.count(), (quint64)0);
+}
+
+void TestAllocations::parseReading()
+{
+    const QByteArray value("\x01\x00\x00\x80\x3F\x02\x03", 7);
+    MultimeterService::Reading reading{};
+    QVERIFY(AllocationCounter::measure([&]{ reading = MultimeterServicePrivate::parseReading(value); })
+        <= labelAllocations);
+    QCOMPARE(reading.value, 1.0f);
+}
+
+void TestAllocations::parseStatus()
+{
+    const QByteArray value("\x01\x00\x00\x80\x40\x02\x01\x00", 8);
+    StatusService::Status status{};
+    QVERIFY(AllocationCounter::measure([&]{ status = StatusServicePrivate::parseStatus(value); })
+        <= labelAllocations);
+    QCOMPARE(status.batteryVoltage, 4.0f);
+}
+
+void TestAllocations::parseDsoMetadata()
+{
+    const QByteArray value("\x01\x00\x00\x80\x3F\x02\x03\x10\x27\x00\x00\xE8\x03\x40\x42\x0F\x00", 17);
+    DsoService::Metadata metadata{};
+    QVERIFY(AllocationCounter::measure([&]{ metadata = DsoServicePrivate::parseMetadata(value); })
+        <= labelAllocations);
+    QCOMPARE(metadata.numberOfSamples, (quint16)1000);
+}
+
+void TestAllocations::parseDsoSamples()
+{
+    // Just the returned vector itself.
+    const QByteArray value = samplesValue(100);
+    DsoService::Samples samples;
+    QVERIFY(AllocationCounter::measure([&]{ samples = DsoServicePrivate::parseSamples(value); }) <= (quint64)1);
+    QCOMPARE((int)samples.size(), 100);
+}
+
+void TestAllocations::parseDsoSamples_pooled()
+{
+    // Once the pool holds a buffer for both the previous samples (still held) and the next, nothing at all.
+    const QByteArray value = samplesValue(100);
+    SamplePool<qint16> pool;
+    DsoService::Samples samples;
+    QCOMPARE(AllocationCounter::measure([&]{ samples = DsoServicePrivate::parseSamples(value, pool); }, 2),
+             (quint64)0);
+    QCOMPARE((int)samples.size(), 100);
+    QCOMPARE(samples.at(99), (qint16)99);
+    QCOMPARE(pool.overflowCount(), (quint64)0);
+}
+
+void TestAllocations::decodeSamples()
+{
+    const QByteArray value = samplesValue(100);
+    qint16 samples[100];
+    bool decoded = false;
+    QCOMPARE(AllocationCounter::measure([&]{
+        decoded = DsoServicePrivate::decodeSamples(value.constData(), value.size(), samples);
+    }), (quint64)0);
+    QVERIFY(decoded);
+    QCOMPARE(samples[99], (qint16)99);
+}
+
+void TestAllocations::parseLoggerMetadata()
+{
+    const QByteArray value("\x01\x00\x00\x80\x3F\x02\x03\xE8\x03\x00\x00\x0A\x00"
+                           "\x00\x00\x00\x00\x00\x00\x01\x02\x03\x04", 23);
+    DataLoggerService::Metadata metadata{};
+    QVERIFY(AllocationCounter::measure([&]{ metadata = DataLoggerServicePrivate::parseMetadata(value); })
+        <= labelAllocations);
+    QCOMPARE(metadata.numberOfSamples, (quint16)10);
+}
+
+void TestAllocations::parseLoggerSamples()
+{
+    // Just the returned vector itself; not one per sample.
+    const QByteArray value = samplesValue(100);
+    DataLoggerService::Samples samples;
+    QVERIFY(AllocationCounter::measure([&]{ samples = DataLoggerServicePrivate::parseSamples(value); })
+        <= (quint64)1);
+    QCOMPARE((int)samples.size(), 100);
+}
+
+void TestAllocations::parseLoggerSamples_pooled()
+{
+    const QByteArray value = samplesValue(100);
+    SamplePool<qint16> pool;
+    DataLoggerService::Samples samples;
+    QCOMPARE(AllocationCounter::measure([&]{ samples = DataLoggerServicePrivate::parseSamples(value, pool); }, 2),
+             (quint64)0);
+    QCOMPARE((int)samples.size(), 100);
+    QCOMPARE(samples.at(99), (qint16)99);
+    QCOMPARE(pool.overflowCount(), (quint64)0);
+}
+
+void TestAllocations::dsoCapture()
+{
+    // Once both capture buffers have grown to size, assembling repeat captures should not allocate at all.
+    DsoService service(nullptr);
+    DsoCapture capture(&service);
+    const DsoService::Metadata metadata{
+        DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 1000, 0 };
+    const DsoService::Samples chunk(100, 1);
+    QCOMPARE(AllocationCounter::measure([&]{
+        Q_EMIT service.metadataRead(metadata);
+        for (int index = 0; index < 10; ++index) {
+            Q_EMIT service.samplesRead(chunk);
+        }
+    }, 2), (quint64)0);
+    QCOMPARE(capture.sequenceNumber(), (quint64)3);
+}
+
+void TestAllocations::ringBuffer()
+{
+    RingBuffer<MultimeterService::Reading> readings(16);
+    MultimeterService::Reading reading{};
+    bool popped = false;
+    QCOMPARE(AllocationCounter::measure([&]{
+        readings.push({ MultimeterService::MeterStatus::Ok, 1.0f, MultimeterService::Mode::DcVoltage, 0 });
+        popped = readings.pop(reading);
+    }), (quint64)0);
+    QVERIFY(popped);
+    QCOMPARE(reading.value, 1.0f);
+
+    // Implicitly shared values are passed through by reference count alone.
+    RingBuffer<DsoService::Samples> captures(4);
+    const DsoService::Samples samples(1000, 1);
+    DsoService::Samples capture;
+    QCOMPARE(AllocationCounter::measure([&]{
+        captures.push(samples);
+        popped = captures.pop(capture);
+    }), (quint64)0);
+    QVERIFY(popped);
+    QCOMPARE((int)capture.size(), 1000);
+}
+
+void TestAllocations::sharedSampleRing()
+{
+    const QString key = QStringLiteral("dokit-test-") + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 1024));
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+
+    const MultimeterService::Reading reading{
+        MultimeterService::MeterStatus::Ok, 1.0f, MultimeterService::Mode::DcVoltage, 0 };
+    const DsoService::Metadata metadata{
+        DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 100, 0 };
+    const DsoService::Samples samples(100, 1);
+    QVector<SharedSampleRing::Record> records;
+    records.reserve(101);
+    qsizetype read = 0;
+    QCOMPARE(AllocationCounter::measure([&]{
+        publisher.publish(reading, 1);
+        publisher.publish(metadata, samples, 2, 1);
+        records.clear(); // Retains capacity.
+        read = reader.read(records);
+    }), (quint64)0);
+    QCOMPARE(read, (qsizetype)101);
+    QCOMPARE(reader.overrunCount(), (quint64)0);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestAllocations))
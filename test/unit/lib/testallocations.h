@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestAllocations : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void counter();
+
+    void parseReading();
+    void parseStatus();
+
+    void parseDsoMetadata();
+    void parseDsoSamples();
+    void parseDsoSamples_pooled();
+    void decodeSamples();
+
+    void parseLoggerMetadata();
+    void parseLoggerSamples();
+    void parseLoggerSamples_pooled();
+
+    void dsoCapture();
+
+    void ringBuffer();
+    void sharedSampleRing();
+};
+
+QTPOKIT_END_NAMESPACE
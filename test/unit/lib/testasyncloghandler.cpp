@@ -0,0 +1,189 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testasyncloghandler.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/asyncloghandler.h>
+
+#include <QLoggingCategory>
+#include <QRegularExpression>
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+static Q_LOGGING_CATEGORY(lc, "dokit.test.async", QtInfoMsg);
+
+namespace {
+
+/// Returns the lines written to \a stream (such as by the handler) so far.
+QStringList linesOf(FILE * const stream)
+{
+    std::fflush(stream);
+    const long size = std::ftell(stream);
+    std::rewind(stream);
+    QByteArray bytes(size, '\0');
+    bytes.resize((int)std::fread(bytes.data(), 1, (size_t)size, stream));
+    QStringList lines = QString::fromLocal8Bit(bytes).split(u'\n');
+    if (lines.constLast().isEmpty()) {
+        lines.removeLast();
+    }
+    return lines;
+}
+
+}
+
+void TestAsyncLogHandler::init()
+{
+    qSetMessagePattern(u"%{category}: %{message}"_s);
+}
+
+void TestAsyncLogHandler::cleanup()
+{
+    AsyncLogHandler::uninstall(); // In case of a failed test.
+    qSetMessagePattern(QString());
+}
+
+void TestAsyncLogHandler::install()
+{
+    FILE * const stream = std::tmpfile();
+    QVERIFY(stream);
+    AsyncLogHandler::Settings settings;
+    settings.stream = stream;
+    QVERIFY(!AsyncLogHandler::isInstalled());
+    QVERIFY(!AsyncLogHandler::uninstall());
+    QVERIFY(AsyncLogHandler::install(settings));
+    QVERIFY(AsyncLogHandler::isInstalled());
+    QVERIFY(!AsyncLogHandler::install(settings)); // Already installed.
+    QVERIFY(AsyncLogHandler::uninstall());
+    QVERIFY(!AsyncLogHandler::isInstalled());
+    QVERIFY(!AsyncLogHandler::uninstall());
+    QCOMPARE(linesOf(stream), QStringList{ });
+    std::fclose(stream);
+}
+
+void TestAsyncLogHandler::write()
+{
+    FILE * const stream = std::tmpfile();
+    QVERIFY(stream);
+    AsyncLogHandler::Settings settings;
+    settings.stream = stream;
+    QVERIFY(AsyncLogHandler::install(settings));
+    qCInfo(lc).noquote() << "first";
+    qCWarning(lc).noquote() << "second";
+    qCDebug(lc).noquote() << "filtered"; // Below the category's threshold, so never reaches the handler.
+    AsyncLogHandler::flush();
+    QCOMPARE(linesOf(stream), QStringList({ u"dokit.test.async: first"_s, u"dokit.test.async: second"_s }));
+
+    const AsyncLogHandler::Statistics statistics = AsyncLogHandler::statistics();
+    QCOMPARE(statistics.queued, (quint64)2);
+    QCOMPARE(statistics.written, (quint64)2);
+    QCOMPARE(statistics.dropped, (quint64)0);
+    QCOMPARE(statistics.suppressed, (quint64)0);
+
+    // Messages logged after uninstalling go to the original handler, and the final statistics are retained.
+    QVERIFY(AsyncLogHandler::uninstall());
+    qCInfo(lc).noquote() << "third";
+    QCOMPARE(linesOf(stream).size(), 2);
+    QCOMPARE(AsyncLogHandler::statistics().written, (quint64)2);
+    std::fclose(stream);
+}
+
+void TestAsyncLogHandler::write_threads()
+{
+    constexpr int threadCount { 4 };
+    constexpr int messageCount { 1000 };
+    FILE * const stream = std::tmpfile();
+    QVERIFY(stream);
+    AsyncLogHandler::Settings settings;
+    settings.capacity = threadCount * messageCount; // Enough that none can be dropped.
+    settings.stream = stream;
+    QVERIFY(AsyncLogHandler::install(settings));
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threadCount; ++thread) {
+        threads.emplace_back([thread]() {
+            for (int message = 0; message < messageCount; ++message) {
+                qCInfo(lc).noquote() << thread << message;
+            }
+        });
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+    QVERIFY(AsyncLogHandler::uninstall());
+
+    const AsyncLogHandler::Statistics statistics = AsyncLogHandler::statistics();
+    QCOMPARE(statistics.queued, (quint64)(threadCount * messageCount));
+    QCOMPARE(statistics.written, statistics.queued);
+    QCOMPARE(statistics.dropped, (quint64)0);
+
+    // Every message is written whole, and each thread's messages in order.
+    const QStringList lines = linesOf(stream);
+    QCOMPARE(lines.size(), threadCount * messageCount);
+    QVector<int> next(threadCount, 0);
+    for (const QString &line: lines) {
+        const QStringList fields = line.split(u' ');
+        QCOMPARE(fields.size(), 3);
+        QCOMPARE(fields.at(0), u"dokit.test.async:"_s);
+        const int thread = fields.at(1).toInt();
+        QCOMPARE(fields.at(2).toInt(), next[thread]++);
+    }
+    std::fclose(stream);
+}
+
+void TestAsyncLogHandler::rateLimit()
+{
+    FILE * const stream = std::tmpfile();
+    QVERIFY(stream);
+    AsyncLogHandler::Settings settings;
+    settings.rateLimit = 3;
+    settings.stream = stream;
+    QVERIFY(AsyncLogHandler::install(settings));
+    for (int message = 0; message < 10; ++message) {
+        qCInfo(lc).noquote() << message;
+    }
+    qCCritical(lc).noquote() << "critical"; // Never rate-limited.
+    AsyncLogHandler::flush();
+    QCOMPARE(linesOf(stream), QStringList({ u"dokit.test.async: 0"_s, u"dokit.test.async: 1"_s,
+        u"dokit.test.async: 2"_s, u"dokit.test.async: critical"_s }));
+
+    const AsyncLogHandler::Statistics statistics = AsyncLogHandler::statistics();
+    QCOMPARE(statistics.queued, (quint64)4);
+    QCOMPARE(statistics.written, (quint64)4);
+    QCOMPARE(statistics.dropped, (quint64)0);
+    QCOMPARE(statistics.suppressed, (quint64)7);
+    QVERIFY(AsyncLogHandler::uninstall());
+    std::fclose(stream);
+}
+
+void TestAsyncLogHandler::prefixContext()
+{
+    FILE * const stream = std::tmpfile();
+    QVERIFY(stream);
+    AsyncLogHandler::Settings settings;
+    settings.prefixContext = true;
+    settings.stream = stream;
+    QVERIFY(AsyncLogHandler::install(settings));
+    qCInfo(lc).noquote() << "message";
+    QVERIFY(AsyncLogHandler::uninstall());
+    const QStringList lines = linesOf(stream);
+    QCOMPARE(lines.size(), 1);
+    const QRegularExpression pattern(u"^ *[0-9]+\\.[0-9]{3} 0x[0-9a-f]+ dokit\\.test\\.async: message$"_s);
+    QVERIFY2(pattern.match(lines.constFirst()).hasMatch(), qPrintable(lines.constFirst()));
+    std::fclose(stream);
+}
+
+void TestAsyncLogHandler::tr()
+{
+    // Exercise the inline tr() function (added by the Q_DECLARE_TR_FUNCTIONS macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    QVERIFY(!AsyncLogHandler::tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestAsyncLogHandler))
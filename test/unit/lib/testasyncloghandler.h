@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestAsyncLogHandler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void install();
+
+    void write();
+    void write_threads();
+
+    void rateLimit();
+
+    void prefixContext();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
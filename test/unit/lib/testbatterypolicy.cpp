@@ -0,0 +1,306 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testbatterypolicy.h"
+
+#include <qtpokit/batterypolicy.h>
+#include "batterypolicy_p.h"
+
+#include <QSignalSpy>
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(BatteryPolicy::Level))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(BatteryPolicy::Decision))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(StatusService::Status))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+StatusService::Status status(const float voltage,
+    const StatusService::BatteryStatus battery = StatusService::BatteryStatus::Good,
+    const std::optional<StatusService::ChargingStatus> charging = std::nullopt)
+{
+    return { StatusService::DeviceStatus::Idle, voltage, battery, std::nullopt, charging };
+}
+
+}
+
+void TestBatteryPolicy::initTestCase()
+{
+    // Register the types used by BatteryPolicy's signals, so QSignalSpy can record their arguments.
+    qRegisterMetaType<BatteryPolicy::Decision>("BatteryPolicy::Decision");
+    qRegisterMetaType<StatusService::Status>("StatusService::Status");
+}
+
+void TestBatteryPolicy::toString_Level_data()
+{
+    QTest::addColumn<BatteryPolicy::Level>("level");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(level, expected) \
+        QTest::addRow(#level) << BatteryPolicy::Level::level << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(Normal,   "Normal");
+    DOKIT_ADD_TEST_ROW(Conserve, "Conserve");
+    DOKIT_ADD_TEST_ROW(Critical, "Critical");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (BatteryPolicy::Level)255 << QString();
+}
+
+void TestBatteryPolicy::toString_Level()
+{
+    QFETCH(BatteryPolicy::Level, level);
+    QFETCH(QString, expected);
+    QCOMPARE(BatteryPolicy::toString(level), expected);
+}
+
+void TestBatteryPolicy::service()
+{
+    const BatteryPolicy policy(nullptr);
+    QVERIFY(!policy.service());
+
+    StatusService service(nullptr);
+    BatteryPolicy policyWithService(&service);
+    QCOMPARE(policyWithService.service(), &service);
+
+    // Statuses from the service are added automatically.
+    Q_EMIT service.deviceStatusRead(status(3.0f, StatusService::BatteryStatus::Low));
+    QVERIFY(policyWithService.lastStatus());
+    QCOMPARE(policyWithService.level(), BatteryPolicy::Level::Critical);
+}
+
+void TestBatteryPolicy::baseInterval()
+{
+    BatteryPolicy policy(nullptr);
+    QCOMPARE(policy.baseInterval(), (quint32)1000);
+    policy.setBaseInterval(500);
+    QCOMPARE(policy.baseInterval(), (quint32)500);
+    QCOMPARE(policy.decision().updateInterval, (quint32)500);
+}
+
+void TestBatteryPolicy::maximumInterval()
+{
+    BatteryPolicy policy(nullptr);
+    QCOMPARE(policy.maximumInterval(), (quint32)0);
+    policy.setMaximumInterval(60000);
+    QCOMPARE(policy.maximumInterval(), (quint32)60000);
+}
+
+void TestBatteryPolicy::conserveFactor()
+{
+    BatteryPolicy policy(nullptr);
+    QCOMPARE(policy.conserveFactor(), 4.0f);
+    policy.setConserveFactor(2.5f);
+    QCOMPARE(policy.conserveFactor(), 2.5f);
+    policy.setConserveFactor(0.5f);
+    QCOMPARE(policy.conserveFactor(), 1.0f);
+    policy.setConserveFactor(std::numeric_limits<float>::infinity());
+    QCOMPARE(policy.conserveFactor(), 1.0f);
+}
+
+void TestBatteryPolicy::conserveVoltage()
+{
+    BatteryPolicy policy(nullptr);
+    QVERIFY(qIsNaN(policy.conserveVoltage()));
+    policy.setConserveVoltage(3.5f);
+    QCOMPARE(policy.conserveVoltage(), 3.5f);
+    policy.setConserveVoltage(0.0f);
+    QVERIFY(qIsNaN(policy.conserveVoltage()));
+    policy.setConserveVoltage(std::numeric_limits<float>::infinity());
+    QVERIFY(qIsNaN(policy.conserveVoltage()));
+}
+
+void TestBatteryPolicy::criticalVoltage()
+{
+    BatteryPolicy policy(nullptr);
+    QVERIFY(qIsNaN(policy.criticalVoltage()));
+    policy.setCriticalVoltage(3.3f);
+    QCOMPARE(policy.criticalVoltage(), 3.3f);
+    policy.setCriticalVoltage(-1.0f);
+    QVERIFY(qIsNaN(policy.criticalVoltage()));
+}
+
+void TestBatteryPolicy::hysteresis()
+{
+    BatteryPolicy policy(nullptr);
+    QCOMPARE(policy.hysteresis(), 0.05f);
+    policy.setHysteresis(0.1f);
+    QCOMPARE(policy.hysteresis(), 0.1f);
+    policy.setHysteresis(-1.0f);
+    QCOMPARE(policy.hysteresis(), 0.0f);
+}
+
+void TestBatteryPolicy::levelFor_data()
+{
+    QTest::addColumn<BatteryPolicy::Level>("current");
+    QTest::addColumn<StatusService::Status>("status");
+    QTest::addColumn<BatteryPolicy::Level>("expected");
+
+    // Thresholds of 3.5V (conserve) and 3.3V (critical), with the default 0.05V hysteresis.
+    QTest::addRow("healthy") << BatteryPolicy::Level::Normal << status(3.9f) << BatteryPolicy::Level::Normal;
+    QTest::addRow("conserve") << BatteryPolicy::Level::Normal << status(3.45f) << BatteryPolicy::Level::Conserve;
+    QTest::addRow("critical") << BatteryPolicy::Level::Normal << status(3.2f) << BatteryPolicy::Level::Critical;
+    QTest::addRow("low-status") << BatteryPolicy::Level::Normal
+        << status(3.9f, StatusService::BatteryStatus::Low) << BatteryPolicy::Level::Critical;
+    QTest::addRow("nan-normal") << BatteryPolicy::Level::Normal << status(std::numeric_limits<float>::quiet_NaN())
+        << BatteryPolicy::Level::Normal;
+    QTest::addRow("nan-conserve") << BatteryPolicy::Level::Conserve << status(std::numeric_limits<float>::quiet_NaN())
+        << BatteryPolicy::Level::Conserve;
+
+    // Hysteresis.
+    QTest::addRow("conserve-within-hysteresis") << BatteryPolicy::Level::Conserve << status(3.52f)
+        << BatteryPolicy::Level::Conserve;
+    QTest::addRow("conserve-recovered") << BatteryPolicy::Level::Conserve << status(3.56f)
+        << BatteryPolicy::Level::Normal;
+    QTest::addRow("critical-within-hysteresis") << BatteryPolicy::Level::Critical << status(3.32f)
+        << BatteryPolicy::Level::Critical;
+    QTest::addRow("critical-to-conserve") << BatteryPolicy::Level::Critical << status(3.4f)
+        << BatteryPolicy::Level::Conserve;
+    QTest::addRow("normal-just-above") << BatteryPolicy::Level::Normal << status(3.52f)
+        << BatteryPolicy::Level::Normal;
+
+    // Charging (or charged) is always normal.
+    QTest::addRow("charging") << BatteryPolicy::Level::Critical
+        << status(3.2f, StatusService::BatteryStatus::Low, StatusService::ChargingStatus::Charging)
+        << BatteryPolicy::Level::Normal;
+    QTest::addRow("charged") << BatteryPolicy::Level::Conserve
+        << status(3.4f, StatusService::BatteryStatus::Good, StatusService::ChargingStatus::Charged)
+        << BatteryPolicy::Level::Normal;
+    QTest::addRow("discharging") << BatteryPolicy::Level::Normal
+        << status(3.4f, StatusService::BatteryStatus::Good, StatusService::ChargingStatus::Discharging)
+        << BatteryPolicy::Level::Conserve;
+}
+
+void TestBatteryPolicy::levelFor()
+{
+    QFETCH(BatteryPolicy::Level, current);
+    QFETCH(StatusService::Status, status);
+    QFETCH(BatteryPolicy::Level, expected);
+    BatteryPolicy policy(nullptr);
+    policy.setConserveVoltage(3.5f);
+    policy.setCriticalVoltage(3.3f);
+    policy.d_ptr->level = current;
+    QCOMPARE(policy.d_ptr->levelFor(status), expected);
+}
+
+void TestBatteryPolicy::decide_data()
+{
+    QTest::addColumn<BatteryPolicy::Level>("level");
+    QTest::addColumn<quint32>("baseInterval");
+    QTest::addColumn<quint32>("maximumInterval");
+    QTest::addColumn<quint32>("expectedInterval");
+    QTest::addColumn<bool>("expectLowPower");
+    QTest::addColumn<bool>("expectLogging");
+
+    QTest::addRow("normal")           << BatteryPolicy::Level::Normal   << 1000u << 0u     << 1000u  << false << false;
+    QTest::addRow("conserve")         << BatteryPolicy::Level::Conserve << 1000u << 0u     << 4000u  << true  << false;
+    QTest::addRow("conserve-capped")  << BatteryPolicy::Level::Conserve << 1000u << 3000u  << 3000u  << true  << false;
+    QTest::addRow("critical")         << BatteryPolicy::Level::Critical << 1000u << 0u     << 16000u << true  << true;
+    QTest::addRow("critical-maximum") << BatteryPolicy::Level::Critical << 1000u << 60000u << 60000u << true  << true;
+    QTest::addRow("base-exceeds-max") << BatteryPolicy::Level::Critical << 5000u << 2000u  << 5000u  << true  << true;
+    QTest::addRow("zero-base")        << BatteryPolicy::Level::Critical << 0u    << 0u     << 0u     << true  << true;
+    QTest::addRow("huge")             << BatteryPolicy::Level::Critical << std::numeric_limits<quint32>::max() << 0u
+                                      << std::numeric_limits<quint32>::max() << true << true;
+}
+
+void TestBatteryPolicy::decide()
+{
+    QFETCH(BatteryPolicy::Level, level);
+    QFETCH(quint32, baseInterval);
+    QFETCH(quint32, maximumInterval);
+    QFETCH(quint32, expectedInterval);
+    QFETCH(bool, expectLowPower);
+    QFETCH(bool, expectLogging);
+    BatteryPolicy policy(nullptr);
+    policy.setBaseInterval(baseInterval);
+    policy.setMaximumInterval(maximumInterval);
+    const BatteryPolicy::Decision decision = policy.d_ptr->decide(level);
+    QCOMPARE(decision.level, level);
+    QCOMPARE(decision.updateInterval, expectedInterval);
+    QCOMPARE(decision.connectionProfile, (expectLowPower) ? PokitDevice::ConnectionProfile::LowPower
+        : PokitDevice::ConnectionProfile::Default);
+    QCOMPARE(decision.preferLogging, expectLogging);
+}
+
+void TestBatteryPolicy::addStatus()
+{
+    BatteryPolicy policy(nullptr);
+    policy.setConserveVoltage(3.5f);
+    policy.setCriticalVoltage(3.3f);
+    policy.setMaximumInterval(30000);
+    QSignalSpy spy(&policy, &BatteryPolicy::decisionChanged);
+
+    // Healthy statuses change nothing.
+    policy.addStatus(status(3.9f));
+    QCOMPARE(policy.level(), BatteryPolicy::Level::Normal);
+    QCOMPARE(spy.count(), 0);
+
+    policy.addStatus(status(3.45f));
+    QCOMPARE(policy.level(), BatteryPolicy::Level::Conserve);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<BatteryPolicy::Decision>().updateInterval, (quint32)4000);
+
+    // Repeated (or recovering, but within hysteresis) statuses change nothing further.
+    policy.addStatus(status(3.44f));
+    policy.addStatus(status(3.53f));
+    QCOMPARE(spy.count(), 1);
+
+    policy.addStatus(status(3.25f));
+    QCOMPARE(policy.level(), BatteryPolicy::Level::Critical);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).value<BatteryPolicy::Decision>().updateInterval, (quint32)30000);
+    QVERIFY(spy.at(1).at(0).value<BatteryPolicy::Decision>().preferLogging);
+    QCOMPARE(policy.lastStatus()->batteryVoltage, 3.25f);
+}
+
+void TestBatteryPolicy::addStatus_charging()
+{
+    BatteryPolicy policy(nullptr);
+    QSignalSpy spy(&policy, &BatteryPolicy::decisionChanged);
+    policy.addStatus(status(3.0f, StatusService::BatteryStatus::Low, StatusService::ChargingStatus::Discharging));
+    QCOMPARE(policy.level(), BatteryPolicy::Level::Critical);
+    policy.addStatus(status(3.1f, StatusService::BatteryStatus::Low, StatusService::ChargingStatus::Charging));
+    QCOMPARE(policy.level(), BatteryPolicy::Level::Normal);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).value<BatteryPolicy::Decision>().updateInterval, (quint32)1000);
+    QCOMPARE(spy.at(1).at(0).value<BatteryPolicy::Decision>().connectionProfile,
+             PokitDevice::ConnectionProfile::Default);
+}
+
+void TestBatteryPolicy::addStatus_settingsChanged()
+{
+    // Changing the policy's settings re-decides for the current level.
+    BatteryPolicy policy(nullptr);
+    policy.addStatus(status(3.0f, StatusService::BatteryStatus::Low));
+    QCOMPARE(policy.decision().updateInterval, (quint32)16000);
+    QSignalSpy spy(&policy, &BatteryPolicy::decisionChanged);
+    policy.setMaximumInterval(10000);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<BatteryPolicy::Decision>().updateInterval, (quint32)10000);
+    policy.setMaximumInterval(10000);
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestBatteryPolicy::reset()
+{
+    BatteryPolicy policy(nullptr);
+    policy.addStatus(status(3.0f, StatusService::BatteryStatus::Low));
+    QSignalSpy spy(&policy, &BatteryPolicy::decisionChanged);
+    policy.reset();
+    QVERIFY(!policy.lastStatus());
+    QCOMPARE(policy.level(), BatteryPolicy::Level::Normal);
+    QCOMPARE(policy.decision().updateInterval, (quint32)1000);
+    QCOMPARE(spy.count(), 0);
+}
+
+void TestBatteryPolicy::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    BatteryPolicy policy(nullptr);
+    QVERIFY(!policy.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestBatteryPolicy))
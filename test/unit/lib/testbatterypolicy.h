@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestBatteryPolicy : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void toString_Level_data();
+    void toString_Level();
+
+    void service();
+    void baseInterval();
+    void maximumInterval();
+    void conserveFactor();
+    void conserveVoltage();
+    void criticalVoltage();
+    void hysteresis();
+
+    void levelFor_data();
+    void levelFor();
+
+    void decide_data();
+    void decide();
+
+    void addStatus();
+    void addStatus_charging();
+    void addStatus_settingsChanged();
+
+    void reset();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testcharacteristiclayout.h"
+
+#include "characteristiclayout_p.h"
+
+#include <qtpokit/dsoservice.h>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+// An arbitrary layout, with each kind of field (enumeration, float, integer and raw bytes).
+namespace TestLayout {
+    using Status    = CharacteristicLayout::Field<DsoService::DsoStatus>;
+    using Scale     = CharacteristicLayout::Field<float,   Status>;
+    using Count     = CharacteristicLayout::Field<quint16, Scale>;
+    using Reserved  = CharacteristicLayout::Bytes<3,       Count>;
+    using Timestamp = CharacteristicLayout::Field<quint32, Reserved>;
+    using Signed    = CharacteristicLayout::Field<qint16,  Timestamp>;
+    using Layout = CharacteristicLayout::Layout<Status, Scale, Count, Reserved, Timestamp, Signed>;
+}
+
+}
+
+void TestCharacteristicLayout::offsets()
+{
+    using namespace TestLayout;
+    static_assert(Status::offset    ==  0);
+    static_assert(Scale::offset     ==  1);
+    static_assert(Count::offset     ==  5);
+    static_assert(Reserved::offset  ==  7);
+    static_assert(Timestamp::offset == 10);
+    static_assert(Signed::offset    == 14);
+    static_assert(Layout::size      == 16);
+    static_assert(std::tuple_size_v<Layout::Buffer> == 16);
+    static_assert(Layout::hasField<Reserved>);
+    static_assert(!Layout::hasField<CharacteristicLayout::Field<quint8>>);
+    QCOMPARE((qsizetype)Layout::size, (qsizetype)16);
+}
+
+void TestCharacteristicLayout::includes()
+{
+    using namespace TestLayout;
+    QVERIFY(Layout::includes<Status>(1));
+    QVERIFY(!Layout::includes<Scale>(4));
+    QVERIFY(Layout::includes<Scale>(5));
+    QVERIFY(!Layout::includes<Signed>(15));
+    QVERIFY(Layout::includes<Signed>(16));
+    QVERIFY(Layout::includes<Signed>(100));
+}
+
+void TestCharacteristicLayout::read()
+{
+    using namespace TestLayout;
+    const QByteArray value = QByteArray::fromHex("01" "0000c03f" "3412" "aabbcc" "78563412" "feff");
+    QCOMPARE(value.size(), (int)Layout::size);
+    const char * const data = value.constData();
+    QCOMPARE(Layout::read<Status>(data), DsoService::DsoStatus::Sampling);
+    QCOMPARE(Layout::read<Scale>(data), 1.5f);
+    QCOMPARE(Layout::read<Count>(data), (quint16)0x1234);
+    QVERIFY(Layout::bytes<Reserved>(data) == data + 7);
+    QCOMPARE(QByteArray(Layout::bytes<Reserved>(data), Reserved::size), QByteArray::fromHex("aabbcc"));
+    QCOMPARE(Layout::read<Timestamp>(data), (quint32)0x12345678);
+    QCOMPARE(Layout::read<Signed>(data), (qint16)-2);
+}
+
+void TestCharacteristicLayout::write()
+{
+    using namespace TestLayout;
+    Layout::Buffer buffer{};
+    Layout::write<Status>(buffer, DsoService::DsoStatus::Error);
+    Layout::write<Scale>(buffer, 1.5f);
+    Layout::write<Count>(buffer, (quint16)0x1234);
+    Layout::write<Timestamp>(buffer, (quint32)0x12345678);
+    Layout::write<Signed>(buffer, (qint16)-2);
+    // Note, the Reserved bytes are left as zero-initialised.
+    QCOMPARE(Layout::toByteArray(buffer),
+             QByteArray::fromHex("ff" "0000c03f" "3412" "000000" "78563412" "feff"));
+}
+
+void TestCharacteristicLayout::roundTrip()
+{
+    using namespace TestLayout;
+    Layout::Buffer buffer{};
+    Layout::write<Status>(buffer, DsoService::DsoStatus::Done);
+    Layout::write<Scale>(buffer, -123.25f);
+    Layout::write<Count>(buffer, std::numeric_limits<quint16>::max());
+    Layout::write<Timestamp>(buffer, std::numeric_limits<quint32>::max());
+    Layout::write<Signed>(buffer, std::numeric_limits<qint16>::min());
+    const QByteArray value = Layout::toByteArray(buffer);
+    QCOMPARE(Layout::read<Status>(value.constData()), DsoService::DsoStatus::Done);
+    QCOMPARE(Layout::read<Scale>(value.constData()), -123.25f);
+    QCOMPARE(Layout::read<Count>(value.constData()), std::numeric_limits<quint16>::max());
+    QCOMPARE(Layout::read<Timestamp>(value.constData()), std::numeric_limits<quint32>::max());
+    QCOMPARE(Layout::read<Signed>(value.constData()), std::numeric_limits<qint16>::min());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestCharacteristicLayout))
@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestCharacteristicLayout : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void offsets();
+    void includes();
+    void read();
+    void write();
+    void roundTrip();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,210 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testchargeintegrator.h"
+
+#include <qtpokit/chargeintegrator.h>
+#include "chargeintegrator_p.h"
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(ChargeIntegrator::GapPolicy))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+/// Returns all of the totals emitted by \a integrator while invoking \a function.
+template<typename Func>
+QVector<ChargeIntegrator::Total> totalsOf(ChargeIntegrator &integrator, Func function)
+{
+    QVector<ChargeIntegrator::Total> totals;
+    const QMetaObject::Connection connection = QObject::connect(&integrator, &ChargeIntegrator::totalReady,
+        [&totals](const ChargeIntegrator::Total &total) { totals.append(total); });
+    function();
+    QObject::disconnect(connection);
+    return totals;
+}
+
+}
+
+void TestChargeIntegrator::defaults()
+{
+    ChargeIntegrator integrator;
+    QCOMPARE(integrator.period(), 0u);
+    QCOMPARE(integrator.maximumGap(), 0u);
+    QCOMPARE(integrator.gapPolicy(), ChargeIntegrator::GapPolicy::Exclude);
+    QVERIFY(!integrator.hasTotal());
+    QCOMPARE(integrator.total().count, (quint64)0);
+    QCOMPARE(integrator.total().charge, 0.0);
+}
+
+void TestChargeIntegrator::setters()
+{
+    ChargeIntegrator integrator;
+    integrator.setPeriod(60000);
+    integrator.setMaximumGap(3000);
+    integrator.setGapPolicy(ChargeIntegrator::GapPolicy::Hold);
+    QCOMPARE(integrator.period(), 60000u);
+    QCOMPARE(integrator.maximumGap(), 3000u);
+    QCOMPARE(integrator.gapPolicy(), ChargeIntegrator::GapPolicy::Hold);
+}
+
+void TestChargeIntegrator::addSample()
+{
+    // Unevenly spaced samples, integrated via trapezoids of 1A for 1s, and 1.5A for 2s.
+    ChargeIntegrator integrator;
+    integrator.addSample(1.0f, 1000);
+    QVERIFY(integrator.hasTotal());
+    QCOMPARE(integrator.total().averageCurrent, 1.0); // Nothing integrated yet.
+    integrator.addSample(1.0f, 2000);
+    integrator.addSample(2.0f, 4000);
+
+    const ChargeIntegrator::Total total = integrator.total();
+    QCOMPARE(total.start, (qint64)1000);
+    QCOMPARE(total.end, (qint64)4000);
+    QCOMPARE(total.count, (quint64)3);
+    QCOMPARE(total.charge, 4000.0 / 3'600'000.0);
+    QCOMPARE(total.averageCurrent, 4000.0 / 3000.0);
+    QCOMPARE(total.duration, (qint64)3000);
+    QCOMPARE(total.gaps, (quint64)0);
+    QCOMPARE(total.gapDuration, (qint64)0);
+
+    // Negative currents (ie in the opposite direction) are subtracted.
+    integrator.addSample(-2.0f, 5000); // A trapezoid of 0A, for 1s.
+    integrator.addSample(-2.0f, 6000);
+    QCOMPARE(integrator.total().charge, 2000.0 / 3'600'000.0);
+}
+
+void TestChargeIntegrator::addSample_gaps_data()
+{
+    QTest::addColumn<ChargeIntegrator::GapPolicy>("policy");
+    QTest::addColumn<double>("expectedAmpMilliseconds");
+    QTest::addColumn<qint64>("expectedDuration");
+
+    // 1A for 1s, then a 9s gap, before a 3A sample.
+    QTest::addRow("exclude")     << ChargeIntegrator::GapPolicy::Exclude     << 1000.0  << (qint64)1000;
+    QTest::addRow("hold")        << ChargeIntegrator::GapPolicy::Hold        << 10000.0 << (qint64)10000;
+    QTest::addRow("interpolate") << ChargeIntegrator::GapPolicy::Interpolate << 19000.0 << (qint64)10000;
+}
+
+void TestChargeIntegrator::addSample_gaps()
+{
+    QFETCH(ChargeIntegrator::GapPolicy, policy);
+    QFETCH(double, expectedAmpMilliseconds);
+    QFETCH(qint64, expectedDuration);
+
+    ChargeIntegrator integrator;
+    integrator.setMaximumGap(2000);
+    integrator.setGapPolicy(policy);
+    integrator.addSample(1.0f, 0);
+    integrator.addSample(1.0f, 1000);
+    integrator.addSample(3.0f, 10000);
+
+    const ChargeIntegrator::Total total = integrator.total();
+    QCOMPARE(total.count, (quint64)3);
+    QCOMPARE(total.charge, expectedAmpMilliseconds / 3'600'000.0);
+    QCOMPARE(total.duration, expectedDuration);
+    QCOMPARE(total.averageCurrent, expectedAmpMilliseconds / (double)expectedDuration);
+    QCOMPARE(total.gaps, (quint64)1);
+    QCOMPARE(total.gapDuration, (qint64)9000);
+
+    // Without a maximum gap, the same interval is integrated as any other.
+    integrator.reset();
+    integrator.setMaximumGap(0);
+    integrator.addSample(1.0f, 0);
+    integrator.addSample(1.0f, 1000);
+    integrator.addSample(3.0f, 10000);
+    QCOMPARE(integrator.total().charge, 19000.0 / 3'600'000.0);
+    QCOMPARE(integrator.total().gaps, (quint64)0);
+}
+
+void TestChargeIntegrator::addSample_ignored()
+{
+    ChargeIntegrator integrator;
+    integrator.addSample(1.0f, 1000);
+    integrator.addSample(2.0f, 1000); // Not after the previous sample.
+    integrator.addSample(3.0f, 500);  // Before the previous sample.
+    integrator.addSample(std::numeric_limits<float>::infinity(), 2000);
+    integrator.addSample(std::numeric_limits<float>::quiet_NaN(), 3000);
+    QCOMPARE(integrator.total().count, (quint64)1);
+    QCOMPARE(integrator.d_func()->previous, 1.0f);
+
+    // So the next valid sample is integrated from the first.
+    integrator.addSample(1.0f, 4000);
+    QCOMPARE(integrator.total().count, (quint64)2);
+    QCOMPARE(integrator.total().duration, (qint64)3000);
+    QCOMPARE(integrator.total().charge, 3000.0 / 3'600'000.0);
+}
+
+void TestChargeIntegrator::period()
+{
+    ChargeIntegrator integrator;
+    integrator.setPeriod(1000);
+    const QVector<ChargeIntegrator::Total> totals = totalsOf(integrator, [&integrator]() {
+        for (const qint64 timestamp: { 100, 600, 1100, 1600, 2100 }) {
+            integrator.addSample(1.0f, timestamp);
+        }
+    });
+    QCOMPARE(totals.size(), 2); // As of the last samples of the first two periods.
+    QCOMPARE(totals.at(0).end, (qint64)600);
+    QCOMPARE(totals.at(0).count, (quint64)2);
+    QCOMPARE(totals.at(0).charge, 500.0 / 3'600'000.0);
+    QCOMPARE(totals.at(1).start, (qint64)100);
+    QCOMPARE(totals.at(1).end, (qint64)1600);
+    QCOMPARE(totals.at(1).count, (quint64)4);
+    QCOMPARE(totals.at(1).charge, 1500.0 / 3'600'000.0); // Still running totals, not per-period ones.
+    QVERIFY(integrator.d_func()->pending); // The 2100 sample is yet to be emitted.
+}
+
+void TestChargeIntegrator::flush()
+{
+    ChargeIntegrator integrator;
+    QCOMPARE(totalsOf(integrator, [&integrator]() { integrator.flush(); }).size(), 0); // Nothing to emit.
+
+    integrator.addSample(0.5f, 0);
+    integrator.addSample(0.5f, 3'600'000);
+    const QVector<ChargeIntegrator::Total> totals = totalsOf(integrator, [&integrator]() {
+        integrator.flush();
+        integrator.flush(); // Unchanged, so not emitted again.
+    });
+    QCOMPARE(totals.size(), 1);
+    QCOMPARE(totals.at(0).charge, 0.5); // 0.5A for an hour.
+    QCOMPARE(totals.at(0).averageCurrent, 0.5);
+}
+
+void TestChargeIntegrator::reset()
+{
+    ChargeIntegrator integrator;
+    integrator.setPeriod(1000);
+    integrator.setMaximumGap(2000);
+    integrator.setGapPolicy(ChargeIntegrator::GapPolicy::Interpolate);
+    integrator.addSample(1.0f, 0);
+    integrator.addSample(1.0f, 5000);
+    QVERIFY(integrator.hasTotal());
+
+    QCOMPARE(totalsOf(integrator, [&integrator]() { integrator.reset(); }).size(), 0); // Not emitted.
+    QVERIFY(!integrator.hasTotal());
+    QCOMPARE(integrator.total().charge, 0.0);
+    QCOMPARE(integrator.total().gaps, (quint64)0);
+    QVERIFY(!integrator.d_func()->pending);
+    QCOMPARE(integrator.period(), 1000u); // Unchanged.
+    QCOMPARE(integrator.maximumGap(), 2000u);
+    QCOMPARE(integrator.gapPolicy(), ChargeIntegrator::GapPolicy::Interpolate);
+
+    integrator.addSample(2.0f, 10000); // The first sample again, so not integrated from anything.
+    QCOMPARE(integrator.total().start, (qint64)10000);
+    QCOMPARE(integrator.total().charge, 0.0);
+}
+
+void TestChargeIntegrator::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    ChargeIntegrator integrator;
+    QVERIFY(!integrator.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestChargeIntegrator))
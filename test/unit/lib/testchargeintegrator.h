@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestChargeIntegrator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaults();
+    void setters();
+
+    void addSample();
+    void addSample_gaps_data();
+    void addSample_gaps();
+    void addSample_ignored();
+
+    void period();
+    void flush();
+    void reset();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testclockaligner.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/clockaligner.h>
+#include "clockaligner_p.h"
+
+#include <QDateTime>
+
+#include <cmath>
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+void TestClockAligner::window()
+{
+    ClockAligner aligner;
+    QCOMPARE(aligner.window(), 64);
+    for (int index = 0; index < 10; ++index) {
+        aligner.addObservation(u"a"_s, index * 100, 5000 + index * 100);
+    }
+    QCOMPARE(aligner.estimate(u"a"_s).observations, 10);
+
+    aligner.setWindow(4);
+    QCOMPARE(aligner.window(), 4);
+    QCOMPARE(aligner.estimate(u"a"_s).observations, 4); // Trimmed to the most recent.
+    QCOMPARE(aligner.d_func()->clocks.value(u"a"_s).observations.first().deviceTime, (qint64)600);
+    aligner.addObservation(u"a"_s, 1000, 6000);
+    QCOMPARE(aligner.estimate(u"a"_s).observations, 4);
+
+    aligner.setWindow(1);
+    QCOMPARE(aligner.window(), 2);
+}
+
+void TestClockAligner::maximumDrift()
+{
+    ClockAligner aligner;
+    QCOMPARE(aligner.maximumDrift(), 1000.0);
+    aligner.setMaximumDrift(250.0);
+    QCOMPARE(aligner.maximumDrift(), 250.0);
+    aligner.setMaximumDrift(-50.0);
+    QCOMPARE(aligner.maximumDrift(), 50.0);
+}
+
+void TestClockAligner::devices()
+{
+    ClockAligner aligner;
+    QVERIFY(aligner.devices().isEmpty());
+    QVERIFY(!aligner.contains(u"a"_s));
+    aligner.addObservation(u"a"_s, 0, 100);
+    aligner.addObservation(u"b"_s, 0, 200);
+    QStringList devices = aligner.devices();
+    devices.sort();
+    QCOMPARE(devices, QStringList({ u"a"_s, u"b"_s }));
+    QVERIFY(aligner.contains(u"a"_s));
+
+    aligner.remove(u"a"_s);
+    QCOMPARE(aligner.devices(), QStringList{ u"b"_s });
+    QCOMPARE(aligner.estimate(u"a"_s).observations, 0);
+    aligner.clear();
+    QVERIFY(aligner.devices().isEmpty());
+}
+
+void TestClockAligner::addObservation_single()
+{
+    ClockAligner aligner;
+    aligner.addObservation(u"a"_s, 1000, 5000);
+    const ClockAligner::Estimate estimate = aligner.estimate(u"a"_s);
+    QCOMPARE(estimate.offset, (qint64)4000);
+    QCOMPARE(estimate.drift, 0.0);
+    QCOMPARE(estimate.observations, 1);
+    QCOMPARE(aligner.toHostTime(u"a"_s, 2000), (qint64)6000);
+}
+
+void TestClockAligner::addObservation_latency()
+{
+    // Samples every 100ms, arriving with 5, 20, 0 and 10ms of latency respectively.
+    ClockAligner aligner;
+    aligner.addObservation(u"a"_s,   0, 4005);
+    aligner.addObservation(u"a"_s, 100, 4120);
+    aligner.addObservation(u"a"_s, 200, 4200);
+    aligner.addObservation(u"a"_s, 300, 4310);
+
+    // The jitter alone suggests a (clamped) drift, but the line is lowered to the earliest-arriving sample.
+    const ClockAligner::Estimate estimate = aligner.estimate(u"a"_s);
+    QCOMPARE(estimate.drift, -1000.0);
+    QCOMPARE(estimate.offset, (qint64)4000);
+    QCOMPARE(estimate.observations, 4);
+    QCOMPARE(aligner.toHostTime(u"a"_s, 200), (qint64)4200);
+
+    // Without the jitter-suggested drift, every sample is aligned to 4000ms after its device time.
+    aligner.setMaximumDrift(0.0);
+    aligner.addObservation(u"a"_s, 400, 4415);
+    QCOMPARE(aligner.estimate(u"a"_s).drift, 0.0);
+    for (const qint64 deviceTime: { 0, 100, 200, 300, 400, 500 }) {
+        QCOMPARE(aligner.toHostTime(u"a"_s, deviceTime), deviceTime + 4000);
+    }
+}
+
+void TestClockAligner::addObservation_drift()
+{
+    // A device clock running 100 ppm slow, ie 100ms behind for every 1,000 seconds.
+    ClockAligner aligner;
+    for (qint64 deviceTime = 0; deviceTime <= 1000000; deviceTime += 100000) {
+        aligner.addObservation(u"a"_s, deviceTime, 1000 + deviceTime + (deviceTime / 10000));
+    }
+    const ClockAligner::Estimate estimate = aligner.estimate(u"a"_s);
+    QCOMPARE(estimate.drift, 100.0);
+    QCOMPARE(estimate.offset, (qint64)1100);
+    QCOMPARE(estimate.observations, 11);
+    QCOMPARE(aligner.toHostTime(u"a"_s, 500000), (qint64)501050);
+    QCOMPARE(aligner.toHostTime(u"a"_s, 2000000), (qint64)2001200);
+}
+
+void TestClockAligner::addObservation_restart()
+{
+    ClockAligner aligner;
+    aligner.addObservation(u"a"_s, 1000, 5000);
+    aligner.addObservation(u"a"_s, 2000, 6000);
+    QCOMPARE(aligner.estimate(u"a"_s).observations, 2);
+    aligner.addObservation(u"a"_s, 500, 9000); // Device time went backwards, so start again.
+    QCOMPARE(aligner.estimate(u"a"_s).observations, 1);
+    QCOMPARE(aligner.estimate(u"a"_s).offset, (qint64)8500);
+}
+
+void TestClockAligner::toHostTime_unknown()
+{
+    const ClockAligner aligner;
+    QCOMPARE(aligner.toHostTime(u"unknown"_s, 1234), (qint64)1234);
+}
+
+void TestClockAligner::hostTime()
+{
+    const qint64 first = ClockAligner::hostTime();
+    const qint64 second = ClockAligner::hostTime();
+    QVERIFY(second >= first);
+    QVERIFY(std::abs(first - QDateTime::currentMSecsSinceEpoch()) < 60000); // Anchored to the epoch.
+}
+
+void TestClockAligner::loggerSampleTime()
+{
+    DataLoggerService::Metadata metadata{
+        DataLoggerService::LoggerStatus::Sampling, 1.0f, DataLoggerService::Mode::DcVoltage, 0, 500, 10, 1000
+    };
+    QCOMPARE(ClockAligner::loggerSampleTime(metadata, 0), (qint64)1000000);
+    QCOMPARE(ClockAligner::loggerSampleTime(metadata, 3), (qint64)1001500);
+    metadata.timestamp = std::numeric_limits<quint32>::max();
+    QCOMPARE(ClockAligner::loggerSampleTime(metadata, 1), (qint64)4294967295000 + 500);
+}
+
+void TestClockAligner::resample_data()
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    QTest::addColumn<QVector<qint64>>("times");
+    QTest::addColumn<QVector<float>>("values");
+    QTest::addColumn<qint64>("start");
+    QTest::addColumn<quint32>("step");
+    QTest::addColumn<QVector<float>>("expected");
+
+    QTest::addRow("empty")
+        << QVector<qint64>{} << QVector<float>{} << (qint64)0 << (quint32)10 << QVector<float>{ nan, nan };
+    QTest::addRow("exact")
+        << QVector<qint64>{ 0, 10, 20 } << QVector<float>{ 1, 2, 3 } << (qint64)0 << (quint32)10
+        << QVector<float>{ 1, 2, 3 };
+    QTest::addRow("interpolated")
+        << QVector<qint64>{ 0, 10, 20 } << QVector<float>{ 0, 1, 2 } << (qint64)-5 << (quint32)5
+        << QVector<float>{ nan, 0.0f, 0.5f, 1.0f, 1.5f, 2.0f, nan };
+    QTest::addRow("uneven")
+        << QVector<qint64>{ 100, 104, 124 } << QVector<float>{ 10, 20, 0 } << (qint64)102 << (quint32)12
+        << QVector<float>{ 15.0f, 10.0f, nan };
+    QTest::addRow("mismatched")
+        << QVector<qint64>{ 0, 10, 20 } << QVector<float>{ 0, 1 } << (qint64)0 << (quint32)10
+        << QVector<float>{ 0.0f, 1.0f, nan };
+}
+
+void TestClockAligner::resample()
+{
+    QFETCH(QVector<qint64>, times);
+    QFETCH(QVector<float>, values);
+    QFETCH(qint64, start);
+    QFETCH(quint32, step);
+    QFETCH(QVector<float>, expected);
+    const QVector<float> resampled = ClockAligner::resample(times, values, start, step, (int)expected.size());
+    QCOMPARE(resampled.size(), expected.size());
+    for (int index = 0; index < resampled.size(); ++index) {
+        if (std::isnan(expected.at(index))) {
+            QVERIFY2(std::isnan(resampled.at(index)), qPrintable(QString::number(index)));
+        } else {
+            QCOMPARE(resampled.at(index), expected.at(index));
+        }
+    }
+}
+
+void TestClockAligner::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    ClockAligner aligner;
+    QVERIFY(!aligner.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestClockAligner))
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestClockAligner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void window();
+    void maximumDrift();
+
+    void devices();
+
+    void addObservation_single();
+    void addObservation_latency();
+    void addObservation_drift();
+    void addObservation_restart();
+
+    void toHostTime_unknown();
+
+    void hostTime();
+
+    void loggerSampleTime();
+
+    void resample_data();
+    void resample();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -10,6 +10,7 @@
 #include "dataloggerservice_p.h"
 
 #include <QRegularExpression>
+#include <QSignalSpy>
 
 Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(DataLoggerService::Mode))
 Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(DataLoggerService::Settings))
@@ -140,6 +141,9 @@ void TestDataLoggerService::setSettings()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DataLoggerService service(nullptr);
     QVERIFY(!service.setSettings({}));
+    const QFuture<bool> future = service.setSettingsAsync({});
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDataLoggerService::startLogger()
@@ -149,6 +153,9 @@ void TestDataLoggerService::startLogger()
     DataLoggerService::Settings settings;
     settings.command = DataLoggerService::Command::Start;
     QVERIFY(!service.startLogger(settings));
+    const QFuture<bool> future = service.startLoggerAsync(settings);
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 
     #ifndef QT_NO_DEBUG
     qInfo("Skipping some test conditions that would otherwise Q_ASSERT.");
@@ -169,6 +176,9 @@ void TestDataLoggerService::stopLogger()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DataLoggerService service(nullptr);
     QVERIFY(!service.stopLogger());
+    const QFuture<bool> future = service.stopLoggerAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDataLoggerService::fetchSamples()
@@ -176,6 +186,19 @@ void TestDataLoggerService::fetchSamples()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DataLoggerService service(nullptr);
     QVERIFY(!service.fetchSamples());
+    const QFuture<bool> future = service.fetchSamplesAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
+}
+
+void TestDataLoggerService::updateIntervalIs32bit()
+{
+    DataLoggerService service(nullptr);
+    QVERIFY(!service.updateIntervalIs32bit()); // Not known, since there's no metadata yet.
+    service.setUpdateIntervalIs32bit(true);
+    QVERIFY(service.updateIntervalIs32bit() == true);
+    service.setUpdateIntervalIs32bit(false);
+    QVERIFY(service.updateIntervalIs32bit() == false);
 }
 
 void TestDataLoggerService::metadata()
@@ -183,6 +206,16 @@ void TestDataLoggerService::metadata()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DataLoggerService service(nullptr);
     QVERIFY(qIsNaN(service.metadata().scale));
+
+    // Parsed metadata is then returned from the latest value cell (sample from a real Pokit Meter device).
+    service.d_func()->emitMetadata(QByteArray("\x00\x9f\x0f\x49\x37\x00\x04\x3c\x00\x00\x00\xe9\xbb\x8c\x62", 15));
+    const DataLoggerService::Metadata metadata = service.metadata();
+    QCOMPARE(metadata.status, DataLoggerService::LoggerStatus::Done);
+    QCOMPARE(metadata.scale, 1.198417067e-05f);
+    QCOMPARE(metadata.range, (quint8)4);
+    QCOMPARE(metadata.updateInterval, (quint32)60000);
+    QCOMPARE(metadata.timestamp, (quint32)1653390313);
+    QCOMPARE(service.d_func()->latestMetadata.storeCount(), (quint64)1);
 }
 
 void TestDataLoggerService::enableMetadataNotifications()
@@ -190,6 +223,9 @@ void TestDataLoggerService::enableMetadataNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DataLoggerService service(nullptr);
     QVERIFY(!service.enableMetadataNotifications());
+    const QFuture<bool> future = service.enableMetadataNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDataLoggerService::disableMetadataNotifications()
@@ -197,6 +233,9 @@ void TestDataLoggerService::disableMetadataNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DataLoggerService service(nullptr);
     QVERIFY(!service.disableMetadataNotifications());
+    const QFuture<bool> future = service.disableMetadataNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDataLoggerService::enableReadingNotifications()
@@ -204,6 +243,9 @@ void TestDataLoggerService::enableReadingNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DataLoggerService service(nullptr);
     QVERIFY(!service.enableReadingNotifications());
+    const QFuture<bool> future = service.enableReadingNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDataLoggerService::disableReadingNotifications()
@@ -211,6 +253,60 @@ void TestDataLoggerService::disableReadingNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DataLoggerService service(nullptr);
     QVERIFY(!service.disableReadingNotifications());
+    const QFuture<bool> future = service.disableReadingNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
+}
+
+void TestDataLoggerService::samplesBuffer()
+{
+    DataLoggerService service(nullptr);
+    QCOMPARE(service.samplesBuffer(), nullptr);
+
+    RingBuffer<DataLoggerService::Samples> buffer(2);
+    service.setSamplesBuffer(&buffer);
+    QCOMPARE(service.samplesBuffer(), &buffer);
+
+    // Parsed samples should be pushed into the buffer, as well as emitted.
+    const QByteArray value = QByteArray("\xff\x7f\x01\x00", 4);
+    service.d_func()->emitSamples(value);
+    DataLoggerService::Samples samples;
+    QVERIFY(buffer.pop(samples));
+    QCOMPARE(samples, DataLoggerServicePrivate::parseSamples(value));
+    QVERIFY(buffer.isEmpty());
+
+    service.setSamplesBuffer(nullptr);
+    QCOMPARE(service.samplesBuffer(), nullptr);
+    service.d_func()->emitSamples(value);
+    QVERIFY(buffer.isEmpty());
+}
+
+void TestDataLoggerService::rawSamplesRead()
+{
+    // Register the types used by the signals below, so QSignalSpy can record their arguments.
+    qRegisterMetaType<DataLoggerService::Samples>("DataLoggerService::Samples");
+
+    DataLoggerService service(nullptr);
+    QSignalSpy rawSpy(&service, &DataLoggerService::rawSamplesRead);
+    const QByteArray value = QByteArray("\x01\x00\xff\xff", 4);
+    service.d_func()->emitSamples(value);
+    QCOMPARE(rawSpy.count(), 1);
+    const QByteArray raw = rawSpy.at(0).at(0).toByteArray();
+    QCOMPARE(raw, value);
+    QCOMPARE(raw.constData(), value.constData()); // Shared, not copied.
+
+    // Odd-sized values are not emitted raw, but parsed (and rejected) as usual.
+    service.d_func()->emitSamples(QByteArray("\x01\x00\xff", 3));
+    QCOMPARE(rawSpy.count(), 1);
+    QCOMPARE(service.statistics().parseFailures, (quint64)1);
+
+    // Samples are still decoded, and emitted, for anything else that requires them.
+    QSignalSpy samplesSpy(&service, &DataLoggerService::samplesRead);
+    service.d_func()->emitSamples(value);
+    QCOMPARE(rawSpy.count(), 2);
+    QCOMPARE(samplesSpy.count(), 1);
+    QCOMPARE(qvariant_cast<DataLoggerService::Samples>(samplesSpy.at(0).at(0)),
+             DataLoggerServicePrivate::parseSamples(value));
 }
 
 void TestDataLoggerService::encodeSettings_data()
@@ -411,6 +507,57 @@ void TestDataLoggerService::parseSamples()
     QCOMPARE(DataLoggerServicePrivate::parseSamples(data), expected);
 }
 
+void TestDataLoggerService::parseSamples_pooled_data()
+{
+    parseSamples_data();
+}
+
+void TestDataLoggerService::parseSamples_pooled()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(DataLoggerService::Samples, expected);
+    if ((data.size()%2) != 0) {
+        for (int count = 0; count < 2; ++count) {
+            QTest::ignoreMessage(QtWarningMsg, QRegularExpression(
+                uR"(^Samples value has odd size \d+ \(should be even\): 0x[a-zA-Z0-9,]*$)"_s));
+        }
+    }
+    SamplePool<qint16> pool(1);
+    const DataLoggerService::Samples first = DataLoggerServicePrivate::parseSamples(data, pool);
+    QCOMPARE(first, expected);
+    // The pool's only buffer is still held by first, so this one comes from outside of the pool.
+    QCOMPARE(DataLoggerServicePrivate::parseSamples(data, pool), expected);
+}
+
+void TestDataLoggerService::scaleSamples_data()
+{
+    QTest::addColumn<DataLoggerService::Samples>("samples");
+    QTest::addColumn<float>("scale");
+    QTest::addColumn<DataLoggerService::ScaledSamples>("expected");
+
+    QTest::addRow("empty") << DataLoggerService::Samples() << 1.0f << DataLoggerService::ScaledSamples();
+
+    QTest::addRow("unit")
+        << DataLoggerService::Samples({0,1,-1,32767,-32768}) << 1.0f
+        << DataLoggerService::ScaledSamples({0.0f,1.0f,-1.0f,32767.0f,-32768.0f});
+
+    QTest::addRow("quarter")
+        << DataLoggerService::Samples({0,4,-8,100}) << 0.25f
+        << DataLoggerService::ScaledSamples({0.0f,1.0f,-2.0f,25.0f});
+
+    QTest::addRow("zero")
+        << DataLoggerService::Samples({123,-456}) << 0.0f
+        << DataLoggerService::ScaledSamples({0.0f,0.0f});
+}
+
+void TestDataLoggerService::scaleSamples()
+{
+    QFETCH(DataLoggerService::Samples, samples);
+    QFETCH(float, scale);
+    QFETCH(DataLoggerService::ScaledSamples, expected);
+    QCOMPARE(DataLoggerServicePrivate::scaleSamples(samples, scale), expected);
+}
+
 void TestDataLoggerService::characteristicRead()
 {
     // Unfortunately we cannot construct QLowEnergyCharacteristic objects to test signal emissions.
@@ -28,6 +28,7 @@ private slots:
     void startLogger();
     void stopLogger();
     void fetchSamples();
+    void updateIntervalIs32bit();
 
     void metadata();
     void enableMetadataNotifications();
@@ -36,6 +37,9 @@ private slots:
     void enableReadingNotifications();
     void disableReadingNotifications();
 
+    void samplesBuffer();
+    void rawSamplesRead();
+
     void encodeSettings_data();
     void encodeSettings();
 
@@ -44,6 +48,11 @@ private slots:
 
     void parseSamples_data();
     void parseSamples();
+    void parseSamples_pooled_data();
+    void parseSamples_pooled();
+
+    void scaleSamples_data();
+    void scaleSamples();
 
     void characteristicRead();
     void characteristicWritten();
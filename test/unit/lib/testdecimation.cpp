@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testdecimation.h"
+
+#include <qtpokit/decimation.h>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+/// Returns \a values as points, with x values equal to their indexes.
+static QVector<QPointF> toPoints(const QVector<qreal> &values)
+{
+    QVector<QPointF> points;
+    for (qsizetype index = 0; index < values.size(); ++index) {
+        points.append(QPointF((qreal)index, values.at(index)));
+    }
+    return points;
+}
+
+/// Test samples with an obvious peak (8) and trough (-6) in the middle.
+static const QVector<qint16> testSamples{ 0, 5, -3, 2, 8, 1, -6, 4, 0, 3 };
+
+void TestDecimation::minMax_data()
+{
+    QTest::addColumn<QVector<QPointF>>("points");
+    QTest::addColumn<qsizetype>("buckets");
+    QTest::addColumn<QVector<QPointF>>("expected");
+
+    const QVector<QPointF> points = toPoints({ 0, 5, -3, 2, 8, 1, -6, 4, 0, 3 });
+
+    QTest::addRow("empty")
+        << QVector<QPointF>{} << (qsizetype)2 << QVector<QPointF>{};
+
+    QTest::addRow("noBuckets")
+        << points << (qsizetype)0 << points;
+
+    QTest::addRow("short")
+        << points << (qsizetype)5 << points;
+
+    QTest::addRow("2buckets")
+        << points << (qsizetype)2
+        << QVector<QPointF>{ { 2, -3 }, { 4, 8 }, { 6, -6 }, { 7, 4 } };
+
+    QTest::addRow("3buckets")
+        << points << (qsizetype)3
+        << QVector<QPointF>{ { 1, 5 }, { 2, -3 }, { 4, 8 }, { 5, 1 }, { 6, -6 }, { 7, 4 } };
+
+    QTest::addRow("flat")
+        << toPoints({ 1, 1, 1, 1, 1, 1 }) << (qsizetype)2
+        << QVector<QPointF>{ { 0, 1 }, { 3, 1 } };
+}
+
+void TestDecimation::minMax()
+{
+    QFETCH(QVector<QPointF>, points);
+    QFETCH(qsizetype, buckets);
+    QFETCH(QVector<QPointF>, expected);
+    QCOMPARE(Decimation::minMax(points, buckets), expected);
+}
+
+void TestDecimation::minMax_Dso()
+{
+    const DsoService::Metadata metadata{
+        DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage, 0, 10'000, 10, 1000
+    };
+    QCOMPARE(Decimation::minMax(metadata, testSamples, 2),
+             QVector<QPointF>({ { 0.002, -1.5 }, { 0.004, 4.0 }, { 0.006, -3.0 }, { 0.007, 2.0 } }));
+    QCOMPARE(Decimation::minMax(metadata, testSamples, 5).size(), testSamples.size()); // Unreduced.
+}
+
+void TestDecimation::minMax_DataLogger()
+{
+    const DataLoggerService::Metadata metadata{
+        DataLoggerService::LoggerStatus::Done, 2.0f, DataLoggerService::Mode::DcVoltage, 0, 500, 10, 0
+    };
+    QCOMPARE(Decimation::minMax(metadata, testSamples, 2),
+             QVector<QPointF>({ { 1.0, -6.0 }, { 2.0, 16.0 }, { 3.0, -12.0 }, { 3.5, 8.0 } }));
+}
+
+void TestDecimation::largestTriangleThreeBuckets_data()
+{
+    QTest::addColumn<QVector<QPointF>>("points");
+    QTest::addColumn<qsizetype>("threshold");
+    QTest::addColumn<QVector<QPointF>>("expected");
+
+    const QVector<QPointF> points = toPoints({ 0, 5, -3, 2, 8, 1, -6, 4, 0, 3 });
+
+    QTest::addRow("empty")
+        << QVector<QPointF>{} << (qsizetype)4 << QVector<QPointF>{};
+
+    QTest::addRow("tooFew")
+        << points << (qsizetype)2 << points;
+
+    QTest::addRow("short")
+        << points << (qsizetype)10 << points;
+
+    QTest::addRow("4points")
+        << points << (qsizetype)4
+        << QVector<QPointF>{ { 0, 0 }, { 4, 8 }, { 6, -6 }, { 9, 3 } };
+
+    QTest::addRow("5points")
+        << points << (qsizetype)5
+        << QVector<QPointF>{ { 0, 0 }, { 2, -3 }, { 4, 8 }, { 6, -6 }, { 9, 3 } };
+
+    QTest::addRow("line")
+        << toPoints({ 0, 1, 2, 3, 4, 5, 6, 7 }) << (qsizetype)3
+        << QVector<QPointF>{ { 0, 0 }, { 1, 1 }, { 7, 7 } };
+}
+
+void TestDecimation::largestTriangleThreeBuckets()
+{
+    QFETCH(QVector<QPointF>, points);
+    QFETCH(qsizetype, threshold);
+    QFETCH(QVector<QPointF>, expected);
+    QCOMPARE(Decimation::largestTriangleThreeBuckets(points, threshold), expected);
+}
+
+void TestDecimation::largestTriangleThreeBuckets_Dso()
+{
+    const DsoService::Metadata metadata{
+        DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage, 0, 10'000, 10, 1000
+    };
+    QCOMPARE(Decimation::largestTriangleThreeBuckets(metadata, testSamples, 4),
+             QVector<QPointF>({ { 0.0, 0.0 }, { 0.004, 4.0 }, { 0.006, -3.0 }, { 0.009, 1.5 } }));
+    QCOMPARE(Decimation::largestTriangleThreeBuckets(metadata, testSamples, 10).size(), testSamples.size());
+}
+
+void TestDecimation::largestTriangleThreeBuckets_DataLogger()
+{
+    const DataLoggerService::Metadata metadata{
+        DataLoggerService::LoggerStatus::Done, 2.0f, DataLoggerService::Mode::DcVoltage, 0, 500, 10, 0
+    };
+    QCOMPARE(Decimation::largestTriangleThreeBuckets(metadata, testSamples, 4),
+             QVector<QPointF>({ { 0.0, 0.0 }, { 2.0, 16.0 }, { 3.0, -12.0 }, { 4.5, 6.0 } }));
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestDecimation))
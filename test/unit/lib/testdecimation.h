@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestDecimation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void minMax_data();
+    void minMax();
+
+    void minMax_Dso();
+
+    void minMax_DataLogger();
+
+    void largestTriangleThreeBuckets_data();
+    void largestTriangleThreeBuckets();
+
+    void largestTriangleThreeBuckets_Dso();
+
+    void largestTriangleThreeBuckets_DataLogger();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,339 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testdsocapture.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/dsocapture.h>
+#include "dsocapture_p.h"
+
+#include <QRegularExpression>
+#include <QSignalSpy>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(DsoService::Metadata))
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+typedef QList<DsoService::Samples> SamplesList;
+
+void TestDsoCapture::initTestCase()
+{
+    // Register the types used by DsoCapture::captureComplete, so QSignalSpy can record its arguments.
+    qRegisterMetaType<DsoService::Metadata>("DsoService::Metadata");
+    qRegisterMetaType<DsoService::Samples>("DsoService::Samples");
+    qRegisterMetaType<quint64>("quint64");
+    qRegisterMetaType<qsizetype>("qsizetype");
+}
+
+void TestDsoCapture::service()
+{
+    DsoService service(nullptr);
+    DsoCapture capture(&service);
+    QCOMPARE(capture.service(), &service);
+
+    // Changing services should disconnect from the old one.
+    DsoService other(nullptr);
+    capture.d_func()->setService(&other);
+    QCOMPARE(capture.service(), &other);
+    QVERIFY(!QObject::disconnect(&service, nullptr, capture.d_func(), nullptr));
+
+    capture.d_func()->setService(nullptr);
+    QCOMPARE(capture.service(), nullptr);
+}
+
+void TestDsoCapture::reset()
+{
+    DsoCapture capture(nullptr);
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 4, 0 });
+    capture.d_func()->samplesRead({ 1, 2 });
+    QCOMPARE(capture.samplesReceived(), (qsizetype)2);
+    capture.reset();
+    QCOMPARE(capture.samplesReceived(), (qsizetype)0);
+    QVERIFY(capture.samples().isEmpty());
+    QVERIFY(!capture.isComplete());
+
+    // Samples after a reset should be ignored, until the next metadata arrives.
+    capture.d_func()->samplesRead({ 3, 4, 5, 6 });
+    QCOMPARE(capture.samplesReceived(), (qsizetype)0);
+}
+
+void TestDsoCapture::metadataRead()
+{
+    DsoCapture capture(nullptr);
+    QVERIFY(!capture.isComplete());
+    QVERIFY(qIsNaN(capture.metadata().scale));
+
+    const DsoService::Metadata metadata{
+        DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::AcCurrent, 1, 2000, 1000, 500000 };
+    capture.d_func()->metadataRead(metadata);
+    QCOMPARE(capture.metadata().scale, metadata.scale);
+    QCOMPARE(capture.metadata().numberOfSamples, metadata.numberOfSamples);
+    QCOMPARE(capture.d_func()->expected, (qsizetype)metadata.numberOfSamples);
+    QCOMPARE(capture.d_func()->samples.size(), (int)metadata.numberOfSamples);
+    QCOMPARE(capture.samplesReceived(), (qsizetype)0);
+    QVERIFY(!capture.isComplete());
+}
+
+void TestDsoCapture::metadataRead_error()
+{
+    DsoCapture capture(nullptr);
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 10, 0 });
+    QCOMPARE(capture.d_func()->expected, (qsizetype)10);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^DSO reported an error; discarding capture.$"_s));
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Error, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 10, 0 });
+    QCOMPARE(capture.d_func()->expected, (qsizetype)0);
+    QVERIFY(!capture.isComplete());
+}
+
+void TestDsoCapture::metadataRead_memoryQuota()
+{
+    DsoCapture capture(nullptr);
+    capture.d_func()->memory.setQuota(100);
+    QSignalSpy spy(&capture, &DsoCapture::captureFailed);
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 10, 0 });
+    QCOMPARE(capture.d_func()->expected, (qsizetype)10);
+    QCOMPARE(capture.d_func()->memory.bytes(), (qint64)20);
+
+    // A capture that would grow the buffer beyond its quota is discarded, rather than the buffer growing.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(
+        u"^Capture of 100 sample/s would exceed its memory quota; discarding capture.$"_s));
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 100, 0 });
+    QCOMPARE(capture.d_func()->expected, (qsizetype)0);
+    QCOMPARE(capture.d_func()->memory.bytes(), (qint64)20);
+    QCOMPARE(capture.d_func()->memory.usage().refusals, (quint64)1);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(spy.first().at(0).value<DsoService::Metadata>().numberOfSamples, (quint16)100);
+    QCOMPARE(spy.first().at(1).toLongLong(), (qint64)0);
+    QVERIFY(!capture.isComplete());
+}
+
+void TestDsoCapture::samplesRead_data()
+{
+    QTest::addColumn<quint16>("numberOfSamples");
+    QTest::addColumn<SamplesList>("chunks");
+    QTest::addColumn<DsoService::Samples>("expected");
+
+    QTest::addRow("single")
+        << (quint16)4 << SamplesList{ { 1, 2, 3, 4 } } << DsoService::Samples{ 1, 2, 3, 4 };
+
+    QTest::addRow("chunked")
+        << (quint16)5 << SamplesList{ { 1, 2 }, { -3, -4 }, { 5 } } << DsoService::Samples{ 1, 2, -3, -4, 5 };
+
+    QTest::addRow("incomplete")
+        << (quint16)5 << SamplesList{ { 1, 2 }, { 3 } } << DsoService::Samples();
+
+    QTest::addRow("overflow")
+        << (quint16)3 << SamplesList{ { 1, 2 }, { 3, 4 } } << DsoService::Samples{ 1, 2, 3 };
+}
+
+void TestDsoCapture::samplesRead()
+{
+    QFETCH(quint16, numberOfSamples);
+    QFETCH(SamplesList, chunks);
+    QFETCH(DsoService::Samples, expected);
+
+    DsoCapture capture(nullptr);
+    QSignalSpy spy(&capture, &DsoCapture::captureComplete);
+    capture.d_func()->metadataRead(
+        { DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, numberOfSamples, 0 });
+
+    qsizetype total = 0;
+    for (const DsoService::Samples &chunk: chunks) {
+        if (total + chunk.size() > numberOfSamples) {
+            QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Received \\d+ more sample/s than expected.$"_s));
+        }
+        capture.d_func()->samplesRead(chunk);
+        total += chunk.size();
+    }
+
+    QCOMPARE(spy.size(), (expected.isEmpty()) ? 0 : 1);
+    QCOMPARE(capture.isComplete(), !expected.isEmpty());
+    QCOMPARE(capture.sequenceNumber(), (quint64)((expected.isEmpty()) ? 0 : 1));
+    QCOMPARE(capture.samples(), expected);
+    if (!expected.isEmpty()) {
+        QCOMPARE(spy.first().at(1).value<DsoService::Samples>(), expected);
+        QCOMPARE(spy.first().at(2).toULongLong(), (quint64)1);
+    }
+}
+
+void TestDsoCapture::samplesRead_sequence()
+{
+    DsoCapture capture(nullptr);
+    QSignalSpy spy(&capture, &DsoCapture::captureComplete);
+    for (quint64 sequenceNumber = 1; sequenceNumber <= 3; ++sequenceNumber) {
+        capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 2, 0 });
+        capture.d_func()->samplesRead({ (qint16)sequenceNumber, (qint16)-sequenceNumber });
+        QCOMPARE(capture.sequenceNumber(), sequenceNumber);
+        QCOMPARE(spy.size(), (int)sequenceNumber);
+        QCOMPARE(spy.last().at(1).value<DsoService::Samples>(),
+                 DsoService::Samples({ (qint16)sequenceNumber, (qint16)-sequenceNumber }));
+        QCOMPARE(spy.last().at(2).toULongLong(), sequenceNumber);
+    }
+
+    // Earlier captures handed out must not be modified by later ones (ie the buffers are swapped, not reused).
+    QCOMPARE(spy.at(0).at(1).value<DsoService::Samples>(), DsoService::Samples({ 1, -1 }));
+    QCOMPARE(spy.at(1).at(1).value<DsoService::Samples>(), DsoService::Samples({ 2, -2 }));
+}
+
+void TestDsoCapture::continuous()
+{
+    DsoCapture capture(nullptr);
+    QVERIFY(!capture.isContinuous());
+
+    // Continuous mode requires a DSO service.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Cannot start continuous capture without a DSO service.$"_s));
+    QVERIFY(!capture.startContinuous({ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage, 0, 1000, 10 }));
+    QVERIFY(!capture.isContinuous());
+
+    // Without a BLE service, the initial request will fail too.
+    DsoService service(nullptr);
+    capture.d_func()->setService(&service);
+    QVERIFY(!capture.startContinuous({ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage, 0, 1000, 10 }));
+    QVERIFY(!capture.isContinuous());
+
+    capture.d_func()->continuousSettings =
+        DsoService::Settings{ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::DcVoltage, 0, 1000, 10 };
+    QVERIFY(capture.isContinuous());
+    capture.stopContinuous();
+    QVERIFY(!capture.isContinuous());
+}
+
+void TestDsoCapture::completionTimeout()
+{
+    DsoCapture capture(nullptr);
+    QCOMPARE(capture.completionTimeout(), DsoCapture::defaultCompletionTimeout);
+    QCOMPARE(capture.maxResends(), DsoCapture::defaultMaxResends);
+
+    capture.setCompletionTimeout(123);
+    capture.setMaxResends(5);
+    QCOMPARE(capture.completionTimeout(), 123);
+    QCOMPARE(capture.maxResends(), 5);
+
+    // The timer should run only while a capture is in progress.
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 4, 0 });
+    QVERIFY(capture.d_func()->completionTimer.isActive());
+    QCOMPARE(capture.d_func()->completionTimer.interval(), 123);
+    capture.d_func()->samplesRead({ 1, 2 });
+    QVERIFY(capture.d_func()->completionTimer.isActive());
+    capture.d_func()->samplesRead({ 3, 4 });
+    QVERIFY(!capture.d_func()->completionTimer.isActive());
+
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 4, 0 });
+    QVERIFY(capture.d_func()->completionTimer.isActive());
+    capture.reset();
+    QVERIFY(!capture.d_func()->completionTimer.isActive());
+
+    // Zero disables the timeout, and negative values are clamped.
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 4, 0 });
+    capture.setCompletionTimeout(-1);
+    capture.setMaxResends(-1);
+    QCOMPARE(capture.completionTimeout(), 0);
+    QCOMPARE(capture.maxResends(), 0);
+    QVERIFY(!capture.d_func()->completionTimer.isActive());
+    capture.d_func()->samplesRead({ 1, 2 });
+    QVERIFY(!capture.d_func()->completionTimer.isActive());
+}
+
+void TestDsoCapture::completionTimedOut()
+{
+    // Without a BLE controller the resends cannot be sent, but each should still count against the limit.
+    DsoService service(nullptr);
+    DsoCapture capture(&service);
+    capture.setMaxResends(2);
+    QSignalSpy spy(&capture, &DsoCapture::captureFailed);
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 5, 0 });
+    capture.d_func()->samplesRead({ 1, 2, 3 });
+
+    for (int resend = 1; resend <= 2; ++resend) {
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(
+            u"^Capture stalled after 3 of 5 sample/s; requesting resend %1 of 2.$"_s.arg(resend)));
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Failed to request resend %1.$"_s.arg(resend)));
+        capture.d_func()->completionTimedOut();
+        QCOMPARE(capture.d_func()->resends, resend);
+        QVERIFY(capture.d_func()->resending);
+        QVERIFY(capture.d_func()->completionTimer.isActive());
+        QCOMPARE(spy.size(), 0);
+    }
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(
+        u"^Abandoning capture after 3 of 5 sample/s, and 2 resend/s.$"_s));
+    capture.d_func()->completionTimedOut();
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(spy.first().at(0).value<DsoService::Metadata>().numberOfSamples, (quint16)5);
+    QCOMPARE(spy.first().at(1).toLongLong(), (qint64)3);
+    QCOMPARE(capture.d_func()->expected, (qsizetype)0);
+    QCOMPARE(capture.d_func()->resends, 0);
+    QVERIFY(!capture.d_func()->completionTimer.isActive());
+    QVERIFY(!capture.isComplete());
+
+    // Further timeouts, with no capture in progress, should do nothing.
+    capture.d_func()->completionTimedOut();
+    QCOMPARE(spy.size(), 1);
+}
+
+void TestDsoCapture::completionTimedOut_resent()
+{
+    DsoCapture capture(nullptr);
+    capture.setMaxResends(1);
+    QSignalSpy completeSpy(&capture, &DsoCapture::captureComplete);
+    QSignalSpy failedSpy(&capture, &DsoCapture::captureFailed);
+    const DsoService::Metadata metadata{ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 4, 0 };
+    capture.d_func()->metadataRead(metadata);
+    capture.d_func()->samplesRead({ 1, 2 });
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Capture stalled after .*$"_s));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Failed to request resend 1.$"_s));
+    capture.d_func()->completionTimedOut();
+
+    // The re-sent metadata should restart the buffer, but not the resend count.
+    capture.d_func()->metadataRead(metadata);
+    QCOMPARE(capture.samplesReceived(), (qsizetype)0);
+    QCOMPARE(capture.d_func()->resends, 1);
+    QVERIFY(!capture.d_func()->resending);
+    capture.d_func()->samplesRead({ 1, 2, 3, 4 });
+    QCOMPARE(completeSpy.size(), 1);
+    QCOMPARE(failedSpy.size(), 0);
+    QCOMPARE(capture.samples(), DsoService::Samples({ 1, 2, 3, 4 }));
+
+    // The next capture should get its own resends.
+    capture.d_func()->metadataRead(metadata);
+    QCOMPARE(capture.d_func()->resends, 0);
+}
+
+void TestDsoCapture::completionTimedOut_timer()
+{
+    DsoCapture capture(nullptr);
+    capture.setCompletionTimeout(10);
+    capture.setMaxResends(0);
+    QSignalSpy spy(&capture, &DsoCapture::captureFailed);
+    QTest::ignoreMessage(QtWarningMsg,
+        QRegularExpression(u"^Abandoning capture after 1 of 2 sample/s, and 0 resend/s.$"_s));
+    capture.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 2, 0 });
+    capture.d_func()->samplesRead({ 1 });
+    QVERIFY(spy.wait(1000));
+    QCOMPARE(spy.first().at(1).toLongLong(), (qint64)1);
+}
+
+void TestDsoCapture::samplesRead_unexpected()
+{
+    // Samples without preceding metadata should be ignored.
+    DsoCapture capture(nullptr);
+    QSignalSpy spy(&capture, &DsoCapture::captureComplete);
+    capture.d_func()->samplesRead({ 1, 2, 3 });
+    QCOMPARE(capture.samplesReceived(), (qsizetype)0);
+    QCOMPARE(spy.size(), 0);
+}
+
+void TestDsoCapture::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    DsoCapture capture(nullptr);
+    QVERIFY(!capture.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestDsoCapture))
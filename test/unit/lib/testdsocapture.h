@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestDsoCapture : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void service();
+    void reset();
+
+    void metadataRead();
+    void metadataRead_error();
+    void metadataRead_memoryQuota();
+
+    void samplesRead_data();
+    void samplesRead();
+    void samplesRead_unexpected();
+    void samplesRead_sequence();
+
+    void continuous();
+
+    void completionTimeout();
+    void completionTimedOut();
+    void completionTimedOut_resent();
+    void completionTimedOut_timer();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
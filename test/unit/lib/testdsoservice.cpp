@@ -10,6 +10,7 @@
 #include "dsoservice_p.h"
 
 #include <QRegularExpression>
+#include <QSignalSpy>
 
 Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(DsoService::Mode))
 Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(DsoService::Settings))
@@ -135,6 +136,9 @@ void TestDsoService::setSettings()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DsoService service(nullptr);
     QVERIFY(!service.setSettings({}));
+    const QFuture<bool> future = service.setSettingsAsync({});
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDsoService::startDso()
@@ -144,6 +148,9 @@ void TestDsoService::startDso()
     DsoService::Settings settings;
     settings.command = DsoService::Command::FreeRunning;
     QVERIFY(!service.startDso(settings));
+    const QFuture<bool> future = service.startDsoAsync(settings);
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
     settings.command = DsoService::Command::RisingEdgeTrigger;
     QVERIFY(!service.startDso(settings));
     settings.command = DsoService::Command::FallingEdgeTrigger;
@@ -164,6 +171,9 @@ void TestDsoService::fetchSamples()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DsoService service(nullptr);
     QVERIFY(!service.fetchSamples());
+    const QFuture<bool> future = service.fetchSamplesAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDsoService::metadata()
@@ -171,6 +181,18 @@ void TestDsoService::metadata()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DsoService service(nullptr);
     QVERIFY(qIsNaN(service.metadata().scale));
+
+    // Parsed metadata is then returned from the latest value cell.
+    service.d_func()->emitMetadata(QByteArray::fromHex("01" "0000c03f" "01" "03" "e8030000" "6400" "40420f00"));
+    const DsoService::Metadata metadata = service.metadata();
+    QCOMPARE(metadata.status, DsoService::DsoStatus::Sampling);
+    QCOMPARE(metadata.scale, 1.5f);
+    QCOMPARE(metadata.mode, DsoService::Mode::DcVoltage);
+    QCOMPARE(metadata.range, (quint8)3);
+    QCOMPARE(metadata.samplingWindow, (quint32)1000);
+    QCOMPARE(metadata.numberOfSamples, (quint16)100);
+    QCOMPARE(metadata.samplingRate, (quint32)1000000);
+    QCOMPARE(service.d_func()->latestMetadata.storeCount(), (quint64)1);
 }
 
 void TestDsoService::enableMetadataNotifications()
@@ -178,6 +200,9 @@ void TestDsoService::enableMetadataNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DsoService service(nullptr);
     QVERIFY(!service.enableMetadataNotifications());
+    const QFuture<bool> future = service.enableMetadataNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDsoService::disableMetadataNotifications()
@@ -185,6 +210,9 @@ void TestDsoService::disableMetadataNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DsoService service(nullptr);
     QVERIFY(!service.disableMetadataNotifications());
+    const QFuture<bool> future = service.disableMetadataNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDsoService::enableReadingNotifications()
@@ -192,6 +220,9 @@ void TestDsoService::enableReadingNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DsoService service(nullptr);
     QVERIFY(!service.enableReadingNotifications());
+    const QFuture<bool> future = service.enableReadingNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestDsoService::disableReadingNotifications()
@@ -199,6 +230,117 @@ void TestDsoService::disableReadingNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     DsoService service(nullptr);
     QVERIFY(!service.disableReadingNotifications());
+    const QFuture<bool> future = service.disableReadingNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
+}
+
+void TestDsoService::samplesBuffer()
+{
+    DsoService service(nullptr);
+    QCOMPARE(service.samplesBuffer(), nullptr);
+
+    RingBuffer<DsoService::Samples> buffer(2);
+    service.setSamplesBuffer(&buffer);
+    QCOMPARE(service.samplesBuffer(), &buffer);
+
+    // Parsed samples should be pushed into the buffer, as well as emitted.
+    const QByteArray value = QByteArray("\x01\x00\xff\xff", 4);
+    service.d_func()->emitSamples(value);
+    DsoService::Samples samples;
+    QVERIFY(buffer.pop(samples));
+    QCOMPARE(samples, DsoServicePrivate::parseSamples(value));
+    QVERIFY(buffer.isEmpty());
+
+    service.setSamplesBuffer(nullptr);
+    QCOMPARE(service.samplesBuffer(), nullptr);
+    service.d_func()->emitSamples(value);
+    QVERIFY(buffer.isEmpty());
+}
+
+void TestDsoService::samplesMemory()
+{
+    // The memory held by the service's sample pool is reported via the service's statistics.
+    DsoService service(nullptr);
+    QCOMPARE(service.statistics().memoryBytes, (qint64)0);
+    service.d_func()->emitSamples(QByteArray("\x01\x00\xff\xff\x02\x00", 6));
+    QCOMPARE(service.statistics().memoryBytes, (qint64)(3 * sizeof(qint16)));
+}
+
+void TestDsoService::rawSamplesRead()
+{
+    // Register the types used by the signals below, so QSignalSpy can record their arguments.
+    qRegisterMetaType<DsoService::Samples>("DsoService::Samples");
+
+    DsoService service(nullptr);
+    QSignalSpy rawSpy(&service, &DsoService::rawSamplesRead);
+    const QByteArray value = QByteArray("\x01\x00\xff\xff", 4);
+    service.d_func()->emitSamples(value);
+    QCOMPARE(rawSpy.count(), 1);
+    const QByteArray raw = rawSpy.at(0).at(0).toByteArray();
+    QCOMPARE(raw, value);
+    QCOMPARE(raw.constData(), value.constData()); // Shared, not copied.
+
+    // Odd-sized values are not emitted raw, but parsed (and rejected) as usual.
+    service.d_func()->emitSamples(QByteArray("\x01\x00\xff", 3));
+    QCOMPARE(rawSpy.count(), 1);
+    QCOMPARE(service.statistics().parseFailures, (quint64)1);
+
+    // Samples are still decoded, and emitted, for anything else that requires them.
+    QSignalSpy samplesSpy(&service, &DsoService::samplesRead);
+    service.d_func()->emitSamples(value);
+    QCOMPARE(rawSpy.count(), 2);
+    QCOMPARE(samplesSpy.count(), 1);
+    QCOMPARE(qvariant_cast<DsoService::Samples>(samplesSpy.at(0).at(0)), DsoServicePrivate::parseSamples(value));
+}
+
+void TestDsoService::samplesBatchRead()
+{
+    // Register the types used by the signals below, so QSignalSpy can record their arguments.
+    qRegisterMetaType<DsoService::Metadata>("DsoService::Metadata");
+    qRegisterMetaType<DsoService::Samples>("DsoService::Samples");
+    qRegisterMetaType<QVector<DsoService::Samples>>("QVector<DsoService::Samples>");
+
+    DsoService service(nullptr);
+    QSignalSpy samplesSpy(&service, &DsoService::samplesRead);
+    QSignalSpy batchSpy(&service, &DsoService::samplesBatchRead);
+    const QByteArray value = QByteArray("\x01\x00\xff\xff", 4);
+    service.d_func()->emitSamples(value);
+    QCOMPARE(samplesSpy.count(), 1);
+    QCOMPARE(batchSpy.count(), 0); // Batching is disabled by default.
+
+    // Batches of (up to) three notifications.
+    service.setBatching({ 3, 0 });
+    for (int count = 0; count < 7; ++count) {
+        service.d_func()->emitSamples(value);
+    }
+    QCOMPARE(samplesSpy.count(), 8); // Still emitted for every notification.
+    QCOMPARE(batchSpy.count(), 2);
+    const auto batch = qvariant_cast<QVector<DsoService::Samples>>(batchSpy.at(0).at(0));
+    QCOMPARE(batch, QVector<DsoService::Samples>(3, DsoServicePrivate::parseSamples(value)));
+
+    // The next metadata flushes the last (partial) batch, before being emitted itself.
+    QSignalSpy metadataSpy(&service, &DsoService::metadataRead);
+    QObject::connect(&service, &DsoService::metadataRead, [&]{ QCOMPARE(batchSpy.count(), 3); });
+    service.d_func()->emitMetadata(QByteArray("\x00\x00\x00\x80\x3f\x01\x02\x03\x00\x00\x00\x04\x00"
+                                              "\x05\x00\x00\x00", 17));
+    QCOMPARE(metadataSpy.count(), 1);
+    QCOMPARE(batchSpy.count(), 3);
+    QCOMPARE(qvariant_cast<QVector<DsoService::Samples>>(batchSpy.at(2).at(0)).size(), 1);
+
+    // The end of the metadata's transfer (4 samples, in two notifications) flushes the batch early.
+    service.d_func()->emitSamples(value);
+    QCOMPARE(batchSpy.count(), 3);
+    service.d_func()->emitSamples(value);
+    QCOMPARE(batchSpy.count(), 4);
+    QCOMPARE(qvariant_cast<QVector<DsoService::Samples>>(batchSpy.at(3).at(0)).size(), 2);
+
+    // Disabling batching flushes any batch in progress.
+    service.d_func()->emitSamples(value);
+    service.setBatching({});
+    QCOMPARE(batchSpy.count(), 5);
+    service.d_func()->emitSamples(value);
+    QCOMPARE(batchSpy.count(), 5);
 }
 
 void TestDsoService::encodeSettings_data()
@@ -342,6 +484,75 @@ void TestDsoService::parseSamples()
     QCOMPARE(DsoServicePrivate::parseSamples(data), expected);
 }
 
+void TestDsoService::parseSamples_pooled_data()
+{
+    parseSamples_data();
+}
+
+void TestDsoService::parseSamples_pooled()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(DsoService::Samples, expected);
+    if ((data.size()%2) != 0) {
+        for (int count = 0; count < 2; ++count) {
+            QTest::ignoreMessage(QtWarningMsg, QRegularExpression(
+                uR"(^Samples value has odd size \d+ \(should be even\): 0x[a-zA-Z0-9,]*$)"_s));
+        }
+    }
+    SamplePool<qint16> pool(1);
+    const DsoService::Samples first = DsoServicePrivate::parseSamples(data, pool);
+    QCOMPARE(first, expected);
+    // The pool's only buffer is still held by first, so this one comes from outside of the pool.
+    QCOMPARE(DsoServicePrivate::parseSamples(data, pool), expected);
+}
+
+void TestDsoService::scaleSamples_data()
+{
+    QTest::addColumn<DsoService::Samples>("samples");
+    QTest::addColumn<float>("scale");
+    QTest::addColumn<DsoService::ScaledSamples>("expected");
+
+    QTest::addRow("empty") << DsoService::Samples() << 1.0f << DsoService::ScaledSamples();
+
+    QTest::addRow("unit")
+        << DsoService::Samples({0,1,-1,32767,-32768}) << 1.0f
+        << DsoService::ScaledSamples({0.0f,1.0f,-1.0f,32767.0f,-32768.0f});
+
+    QTest::addRow("quarter")
+        << DsoService::Samples({0,4,-8,100}) << 0.25f
+        << DsoService::ScaledSamples({0.0f,1.0f,-2.0f,25.0f});
+
+    QTest::addRow("zero")
+        << DsoService::Samples({123,-456}) << 0.0f
+        << DsoService::ScaledSamples({0.0f,0.0f});
+}
+
+void TestDsoService::scaleSamples()
+{
+    QFETCH(DsoService::Samples, samples);
+    QFETCH(float, scale);
+    QFETCH(DsoService::ScaledSamples, expected);
+    QCOMPARE(DsoServicePrivate::scaleSamples(samples, scale), expected);
+}
+
+void TestDsoService::decodeSamples_data()
+{
+    parseSamples_data();
+}
+
+void TestDsoService::decodeSamples()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(DsoService::Samples, expected);
+    DsoService::Samples samples(data.size()/2, 0x1234); // Pre-filled, to verify odd-sized data is not decoded.
+    QCOMPARE(DsoServicePrivate::decodeSamples(data.constData(), data.size(), samples.data()), (data.size()%2) == 0);
+    if ((data.size()%2) == 0) {
+        QCOMPARE(samples, expected);
+    } else {
+        QCOMPARE(samples, DsoService::Samples(data.size()/2, 0x1234));
+    }
+}
+
 void TestDsoService::characteristicRead()
 {
     // Unfortunately we cannot construct QLowEnergyCharacteristic objects to test signal emissions.
@@ -35,6 +35,11 @@ private slots:
     void enableReadingNotifications();
     void disableReadingNotifications();
 
+    void samplesBuffer();
+    void samplesMemory();
+    void rawSamplesRead();
+    void samplesBatchRead();
+
     void encodeSettings_data();
     void encodeSettings();
 
@@ -43,6 +48,14 @@ private slots:
 
     void parseSamples_data();
     void parseSamples();
+    void parseSamples_pooled_data();
+    void parseSamples_pooled();
+
+    void scaleSamples_data();
+    void scaleSamples();
+
+    void decodeSamples_data();
+    void decodeSamples();
 
     void characteristicRead();
     void characteristicWritten();
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testdsospectrum.h"
+
+#include <qtpokit/dsocapture.h>
+#include <qtpokit/dsospectrum.h>
+#include "dsospectrum_p.h"
+
+#include <QSignalSpy>
+#include <QtMath>
+
+#include <algorithm>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(DsoSpectrum::Spectrum))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestDsoSpectrum::initTestCase()
+{
+    // Register the types used by DsoSpectrum::spectrumReady, so QSignalSpy can record its arguments.
+    qRegisterMetaType<DsoSpectrum::Spectrum>("DsoSpectrum::Spectrum");
+    qRegisterMetaType<quint64>("quint64");
+}
+
+void TestDsoSpectrum::capture()
+{
+    DsoSpectrum spectrum(nullptr);
+    QCOMPARE(spectrum.capture(), nullptr);
+
+    DsoCapture capture(nullptr);
+    spectrum.d_func()->setCapture(&capture);
+    QCOMPARE(spectrum.capture(), &capture);
+
+    spectrum.d_func()->setCapture(nullptr);
+    QCOMPARE(spectrum.capture(), nullptr);
+    QVERIFY(!QObject::disconnect(&capture, nullptr, spectrum.d_func(), nullptr));
+}
+
+void TestDsoSpectrum::analyse_tooShort()
+{
+    DsoSpectrum spectrum(nullptr);
+    const DsoService::Metadata metadata{ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::AcVoltage, 0, 0, 1, 1000 };
+    QVERIFY(spectrum.analyse(metadata, {}).magnitudes.isEmpty());
+    QVERIFY(spectrum.analyse(metadata, { 123 }).magnitudes.isEmpty());
+}
+
+void TestDsoSpectrum::analyse_sine()
+{
+    // A 0.5 DC offset, plus a unit-amplitude sinusoid exactly in bin 64 of a 1024-point FFT at 1024Hz (ie 64Hz at 1Hz
+    // per bin), with each sample count being 1mV.
+    DsoService::Samples samples;
+    for (int index = 0; index < 1024; ++index) {
+        samples.append((qint16)qRound(500.0 + 1000.0 * qSin(2.0 * M_PI * 64.0 * index / 1024.0)));
+    }
+    const DsoService::Metadata metadata{
+        DsoService::DsoStatus::Done, 0.001f, DsoService::Mode::AcVoltage, 0, 1000000, 1024, 1024 };
+
+    DsoSpectrum spectrum(nullptr);
+    const DsoSpectrum::Spectrum result = spectrum.analyse(metadata, samples);
+    QCOMPARE(result.resolution, 1.0f);
+    QCOMPARE(result.magnitudes.size(), 513);
+    QVERIFY(qAbs(result.magnitudes.at(0) - 0.5f) < 0.001f);
+    QCOMPARE((qsizetype)(std::max_element(result.magnitudes.cbegin() + 1, result.magnitudes.cend())
+                         - result.magnitudes.cbegin()), (qsizetype)64);
+    QVERIFY(qAbs(result.magnitudes.at(64) - 1.0f) < 0.001f);
+    QVERIFY(result.magnitudes.at(100) < 0.001f);
+}
+
+void TestDsoSpectrum::analyse_padded()
+{
+    // Three samples will be zero-padded to a four-point FFT.
+    const DsoService::Metadata metadata{ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 3, 1000 };
+    DsoSpectrum spectrum(nullptr);
+    const DsoSpectrum::Spectrum result = spectrum.analyse(metadata, { 1, 2, 3 });
+    QCOMPARE(result.resolution, 250.0f);
+    QCOMPARE(result.magnitudes.size(), 3);
+    QCOMPARE(result.magnitudes.at(0), 2.0f);
+    QCOMPARE(result.magnitudes.at(1), 4.0f);
+    QCOMPARE(result.magnitudes.at(2), 2.0f);
+}
+
+void TestDsoSpectrum::analyse_twoSamples()
+{
+    // Two samples are too few for a Hann window (which would be all zeros), so are analysed with a rectangular one.
+    const DsoService::Metadata metadata{ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 2, 1000 };
+    DsoSpectrum spectrum(nullptr);
+    const DsoSpectrum::Spectrum result = spectrum.analyse(metadata, { 1, 3 });
+    QCOMPARE(result.resolution, 500.0f);
+    QCOMPARE(result.magnitudes.size(), 2);
+    QCOMPARE(result.magnitudes.at(0), 2.0f);
+    QCOMPARE(result.magnitudes.at(1), 1.0f);
+}
+
+void TestDsoSpectrum::plan()
+{
+    DsoSpectrum spectrum(nullptr);
+    DsoSpectrumPrivate * const d = spectrum.d_func();
+    d->plan(1000);
+    QCOMPARE(d->plannedSize, (qsizetype)1000);
+    QCOMPARE(d->fftSize, (qsizetype)1024);
+    QCOMPARE(d->window.size(), 1000);
+    QCOMPARE(d->bitReversal.size(), 512);
+    QCOMPARE(d->twiddles.size(), 256);
+    QCOMPARE(d->unpackTwiddles.size(), 513);
+    QCOMPARE(d->buffer.size(), 512);
+    QCOMPARE(d->bitReversal.at(1), (qsizetype)256);
+
+    // Re-planning for the same size should re-use the existing plan.
+    const float * const window = d->window.constData();
+    d->plan(1000);
+    QCOMPARE(d->window.constData(), window);
+
+    d->plan(4);
+    QCOMPARE(d->fftSize, (qsizetype)4);
+    QCOMPARE(d->bitReversal, QVector<qsizetype>({ 0, 1 }));
+}
+
+void TestDsoSpectrum::captureComplete()
+{
+    DsoSpectrum spectrum(nullptr);
+    QSignalSpy spy(&spectrum, &DsoSpectrum::spectrumReady);
+    spectrum.d_func()->captureComplete(
+        { DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 3, 1000 }, { 1, 2, 3 }, 42);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(spy.first().at(0).value<DsoSpectrum::Spectrum>().magnitudes.size(), 3);
+    QCOMPARE(spy.first().at(1).toULongLong(), (quint64)42);
+}
+
+void TestDsoSpectrum::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    DsoSpectrum spectrum(nullptr);
+    QVERIFY(!spectrum.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestDsoSpectrum))
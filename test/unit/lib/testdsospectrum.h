@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestDsoSpectrum : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void capture();
+
+    void analyse_tooShort();
+    void analyse_sine();
+    void analyse_padded();
+    void analyse_twoSamples();
+
+    void plan();
+
+    void captureComplete();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testdsostatistics.h"
+
+#include <qtpokit/dsostatistics.h>
+#include "dsostatistics_p.h"
+
+#include <QSignalSpy>
+#include <QtMath>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(DsoStatistics::Summary))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestDsoStatistics::initTestCase()
+{
+    // Register the type used by DsoStatistics::summaryReady, so QSignalSpy can record its arguments.
+    qRegisterMetaType<DsoStatistics::Summary>("DsoStatistics::Summary");
+}
+
+void TestDsoStatistics::service()
+{
+    DsoService service(nullptr);
+    DsoStatistics statistics(&service);
+    QCOMPARE(statistics.service(), &service);
+
+    DsoService other(nullptr);
+    statistics.d_func()->setService(&other);
+    QCOMPARE(statistics.service(), &other);
+    QVERIFY(!QObject::disconnect(&service, nullptr, statistics.d_func(), nullptr));
+}
+
+void TestDsoStatistics::reset()
+{
+    DsoStatistics statistics(nullptr);
+    statistics.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 4, 0 });
+    statistics.d_func()->samplesRead({ 1, 2, 3 });
+    QCOMPARE(statistics.summary().count, (quint64)3);
+    statistics.reset();
+    QCOMPARE(statistics.summary().count, (quint64)0);
+}
+
+void TestDsoStatistics::summary_empty()
+{
+    DsoStatistics statistics(nullptr);
+    const DsoStatistics::Summary summary = statistics.summary();
+    QCOMPARE(summary.count, (quint64)0);
+    QVERIFY(qIsNaN(summary.minimum));
+    QVERIFY(qIsNaN(summary.maximum));
+    QVERIFY(qIsNaN(summary.mean));
+    QVERIFY(qIsNaN(summary.rms));
+    QVERIFY(qIsNaN(summary.frequency));
+}
+
+void TestDsoStatistics::summary_square()
+{
+    // A +/-2 square wave, alternating every sample, at 1kHz (ie 500Hz fundamental).
+    DsoStatistics statistics(nullptr);
+    statistics.d_func()->metadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::AcVoltage, 0, 0, 8, 1000 });
+    statistics.d_func()->samplesRead({ -4, 4, -4, 4, -4, 4, -4, 4 });
+    const DsoStatistics::Summary summary = statistics.summary();
+    QCOMPARE(summary.count, (quint64)8);
+    QCOMPARE(summary.minimum, -2.0f);
+    QCOMPARE(summary.maximum, 2.0f);
+    QCOMPARE(summary.peakToPeak, 4.0f);
+    QCOMPARE(summary.mean + 1.0f, 1.0f); // Fuzzy-compare against zero.
+    QCOMPARE(summary.rms, 2.0f);
+    QCOMPARE(summary.standardDeviation, 2.0f);
+    QCOMPARE(summary.frequency, 500.0f);
+}
+
+void TestDsoStatistics::summary_sine()
+{
+    // 10 cycles of a 50Hz sine wave, with 1.0 DC offset, sampled at 1kHz.
+    DsoService::Samples samples;
+    for (int index = 0; index < 200; ++index) {
+        samples.append((qint16)qRound(1000.0 + 1000.0 * qSin(2.0 * M_PI * 50.0 * index / 1000.0)));
+    }
+    DsoStatistics statistics(nullptr);
+    statistics.d_func()->metadataRead(
+        { DsoService::DsoStatus::Done, 0.001f, DsoService::Mode::AcVoltage, 0, 0, (quint16)samples.size(), 1000 });
+    statistics.d_func()->samplesRead(samples);
+    const DsoStatistics::Summary summary = statistics.summary();
+    QCOMPARE(summary.count, (quint64)samples.size());
+    QVERIFY(qAbs(summary.mean - 1.0f) < 0.01f);
+    QVERIFY(qAbs(summary.peakToPeak - 2.0f) < 0.01f);
+    QVERIFY(qAbs(summary.standardDeviation - (float)M_SQRT1_2) < 0.01f);
+    QVERIFY(qAbs(summary.rms - qSqrt(1.5f)) < 0.01f);
+    QVERIFY(qAbs(summary.frequency - 50.0f) < 0.5f);
+}
+
+void TestDsoStatistics::summary_dc()
+{
+    // A constant signal has no frequency.
+    DsoStatistics statistics(nullptr);
+    statistics.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 5, 1000 });
+    statistics.d_func()->samplesRead({ 3, 3, 3, 3, 3 });
+    const DsoStatistics::Summary summary = statistics.summary();
+    QCOMPARE(summary.peakToPeak, 0.0f);
+    QCOMPARE(summary.mean, 3.0f);
+    QCOMPARE(summary.rms, 3.0f);
+    QCOMPARE(summary.standardDeviation + 1.0f, 1.0f); // Fuzzy-compare against zero.
+    QVERIFY(qIsNaN(summary.frequency));
+}
+
+void TestDsoStatistics::summarise()
+{
+    // The same square wave as summary_square, but without any service, or incremental accumulation.
+    const DsoService::Metadata metadata{ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::AcVoltage, 0, 0, 8, 1000 };
+    const DsoStatistics::Summary summary = DsoStatistics::summarise(metadata, { -4, 4, -4, 4, -4, 4, -4, 4 });
+    QCOMPARE(summary.count, (quint64)8);
+    QCOMPARE(summary.minimum, -2.0f);
+    QCOMPARE(summary.maximum, 2.0f);
+    QCOMPARE(summary.rms, 2.0f);
+    QCOMPARE(summary.frequency, 500.0f);
+
+    QCOMPARE(DsoStatistics::summarise(metadata, { }).count, (quint64)0);
+}
+
+void TestDsoStatistics::samplesRead_beforeMetadata()
+{
+    DsoStatistics statistics(nullptr);
+    statistics.d_func()->samplesRead({ 1, 2, 3 });
+    QCOMPARE(statistics.summary().count, (quint64)0);
+}
+
+void TestDsoStatistics::samplesRead_chunked()
+{
+    DsoStatistics statistics(nullptr);
+    QSignalSpy spy(&statistics, &DsoStatistics::summaryReady);
+    statistics.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 5, 0 });
+    statistics.d_func()->samplesRead({ 1, 2 });
+    QCOMPARE(spy.size(), 0);
+    statistics.d_func()->samplesRead({ 3, 4, 5 });
+    QCOMPARE(spy.size(), 1);
+    const DsoStatistics::Summary summary = spy.first().first().value<DsoStatistics::Summary>();
+    QCOMPARE(summary.count, (quint64)5);
+    QCOMPARE(summary.minimum, 1.0f);
+    QCOMPARE(summary.maximum, 5.0f);
+    QCOMPARE(summary.mean, 3.0f);
+
+    // Further samples (beyond those promised by the metadata) should not emit again.
+    statistics.d_func()->samplesRead({ 6 });
+    QCOMPARE(spy.size(), 1);
+
+    // But the next capture should.
+    statistics.d_func()->metadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 1, 0 });
+    statistics.d_func()->samplesRead({ 7 });
+    QCOMPARE(spy.size(), 2);
+}
+
+void TestDsoStatistics::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    DsoStatistics statistics(nullptr);
+    QVERIFY(!statistics.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestDsoStatistics))
@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestDsoStatistics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void service();
+    void reset();
+
+    void summary_empty();
+    void summary_square();
+    void summary_sine();
+    void summary_dc();
+    void summarise();
+
+    void samplesRead_beforeMetadata();
+    void samplesRead_chunked();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
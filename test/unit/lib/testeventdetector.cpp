@@ -0,0 +1,290 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testeventdetector.h"
+
+#include <qtpokit/eventdetector.h>
+#include "eventdetector_p.h"
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(EventDetector::Settings))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(EventDetector::Event))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+/// Returns all of the events finished by \a detector while adding \a values, 100ms apart, from 1,000ms.
+QVector<EventDetector::Event> eventsOf(EventDetector &detector, const QVector<float> &values)
+{
+    QVector<EventDetector::Event> events;
+    const QMetaObject::Connection connection = QObject::connect(&detector, &EventDetector::eventFinished,
+        [&events](const EventDetector::Event &event) { events.append(event); });
+    for (qsizetype index = 0; index < values.size(); ++index) {
+        detector.addValue(values.at(index), 1000 + index * 100);
+    }
+    QObject::disconnect(connection);
+    return events;
+}
+
+}
+
+void TestEventDetector::service()
+{
+    EventDetector unattached;
+    QVERIFY(unattached.service() == nullptr);
+
+    MultimeterService meter(nullptr);
+    EventDetector meterDetector(&meter);
+    QCOMPARE(meterDetector.service(), static_cast<AbstractPokitService *>(&meter));
+
+    DataLoggerService logger(nullptr);
+    EventDetector loggerDetector(&logger);
+    QCOMPARE(loggerDetector.service(), static_cast<AbstractPokitService *>(&logger));
+}
+
+void TestEventDetector::isValid_data()
+{
+    QTest::addColumn<EventDetector::Settings>("settings");
+    QTest::addColumn<bool>("expected");
+
+    using Quantity  = EventDetector::Quantity;
+    using Direction = EventDetector::Direction;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    QTest::addRow("default")     << EventDetector::defaultSettings() << true;
+    QTest::addRow("rate")        << EventDetector::Settings{ Quantity::RateOfChange, Direction::Below, -5.0f, 1.0f,
+                                    1000 } << true;
+    QTest::addRow("nan")         << EventDetector::Settings{ Quantity::Value, Direction::Above, nan, 0.0f, 0 }
+                                 << false;
+    QTest::addRow("inf")         << EventDetector::Settings{ Quantity::Value, Direction::Above, inf, 0.0f, 0 }
+                                 << false;
+    QTest::addRow("negative-hysteresis") << EventDetector::Settings{ Quantity::Value, Direction::Above, 1.0f, -0.1f,
+                                    0 } << false;
+    QTest::addRow("bad-quantity") << EventDetector::Settings{ (Quantity)2, Direction::Above, 1.0f, 0.0f, 0 }
+                                  << false;
+    QTest::addRow("bad-direction") << EventDetector::Settings{ Quantity::Value, (Direction)2, 1.0f, 0.0f, 0 }
+                                   << false;
+}
+
+void TestEventDetector::isValid()
+{
+    QFETCH(EventDetector::Settings, settings);
+    QFETCH(bool, expected);
+    QCOMPARE(EventDetector::isValid(settings), expected);
+}
+
+void TestEventDetector::setSettings()
+{
+    EventDetector detector;
+    const EventDetector::Settings settings{
+        EventDetector::Quantity::RateOfChange, EventDetector::Direction::Below, -2.0f, 0.5f, 250 };
+    detector.setSettings(settings);
+    QCOMPARE(detector.settings().quantity, settings.quantity);
+    QCOMPARE(detector.settings().direction, settings.direction);
+    QCOMPARE(detector.settings().threshold, settings.threshold);
+    QCOMPARE(detector.settings().hysteresis, settings.hysteresis);
+    QCOMPARE(detector.settings().minDuration, settings.minDuration);
+
+    QTest::ignoreMessage(QtWarningMsg, "Invalid event detector settings; keeping the current settings.");
+    detector.setSettings({ EventDetector::Quantity::Value, EventDetector::Direction::Above,
+                           std::numeric_limits<float>::quiet_NaN(), 0.0f, 0 });
+    QCOMPARE(detector.settings().threshold, settings.threshold);
+}
+
+void TestEventDetector::addValue_data()
+{
+    QTest::addColumn<EventDetector::Settings>("settings");
+    QTest::addColumn<QVector<float>>("values");
+    QTest::addColumn<QVector<EventDetector::Event>>("expected");
+
+    using Quantity  = EventDetector::Quantity;
+    using Direction = EventDetector::Direction;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    QTest::addRow("above")
+        << EventDetector::Settings{ Quantity::Value, Direction::Above, 1.0f, 0.0f, 0 }
+        << QVector<float>{ 0.0f, 1.0f, 2.0f, 0.5f, 1.5f, 0.0f }
+        << QVector<EventDetector::Event>{ { 1100, 1200, 2.0f, 2 }, { 1400, 1400, 1.5f, 1 } };
+
+    QTest::addRow("above-hysteresis")
+        << EventDetector::Settings{ Quantity::Value, Direction::Above, 1.0f, 0.5f, 0 }
+        << QVector<float>{ 0.0f, 1.0f, 0.6f, 1.2f, 0.4f, 0.0f }
+        << QVector<EventDetector::Event>{ { 1100, 1300, 1.2f, 3 } };
+
+    QTest::addRow("below-hysteresis")
+        << EventDetector::Settings{ Quantity::Value, Direction::Below, -1.0f, 0.2f, 0 }
+        << QVector<float>{ 0.0f, -1.0f, -0.9f, -2.0f, -0.7f, 0.0f }
+        << QVector<EventDetector::Event>{ { 1100, 1300, -2.0f, 3 } };
+
+    QTest::addRow("min-duration")
+        << EventDetector::Settings{ Quantity::Value, Direction::Above, 1.0f, 0.0f, 200 }
+        << QVector<float>{ 2.0f, 2.0f, 0.0f, 2.0f, 3.0f, 2.0f, 0.0f }
+        << QVector<EventDetector::Event>{ { 1300, 1500, 3.0f, 3 } };
+
+    QTest::addRow("rate-above")
+        << EventDetector::Settings{ Quantity::RateOfChange, Direction::Above, 5.0f, 0.0f, 0 }
+        << QVector<float>{ 0.0f, 0.0f, 1.0f, 2.0f, 2.1f, 2.1f }
+        << QVector<EventDetector::Event>{ { 1200, 1300, 10.0f, 2 } };
+
+    QTest::addRow("rate-below")
+        << EventDetector::Settings{ Quantity::RateOfChange, Direction::Below, -5.0f, 0.0f, 0 }
+        << QVector<float>{ 2.0f, 1.0f, 0.0f, 0.0f }
+        << QVector<EventDetector::Event>{ { 1100, 1200, -10.0f, 2 } };
+
+    QTest::addRow("nan-ignored")
+        << EventDetector::Settings{ Quantity::Value, Direction::Above, 1.0f, 0.0f, 0 }
+        << QVector<float>{ 2.0f, nan, 2.0f, 0.0f }
+        << QVector<EventDetector::Event>{ { 1000, 1200, 2.0f, 2 } };
+
+    QTest::addRow("none")
+        << EventDetector::Settings{ Quantity::Value, Direction::Above, 10.0f, 0.0f, 0 }
+        << QVector<float>{ 0.0f, 1.0f, 9.9f, 0.0f }
+        << QVector<EventDetector::Event>{ };
+}
+
+void TestEventDetector::addValue()
+{
+    QFETCH(EventDetector::Settings, settings);
+    QFETCH(QVector<float>, values);
+    QFETCH(QVector<EventDetector::Event>, expected);
+
+    EventDetector detector;
+    detector.setSettings(settings);
+    const QVector<EventDetector::Event> events = eventsOf(detector, values);
+    QCOMPARE(events.size(), expected.size());
+    for (qsizetype index = 0; index < events.size(); ++index) {
+        QCOMPARE(events.at(index).start, expected.at(index).start);
+        QCOMPARE(events.at(index).end,   expected.at(index).end);
+        QCOMPARE(events.at(index).peak,  expected.at(index).peak);
+        QCOMPARE(events.at(index).count, expected.at(index).count);
+    }
+    QCOMPARE(detector.eventCount(), (quint64)expected.size());
+    QVERIFY(!detector.isActive());
+}
+
+void TestEventDetector::eventStarted()
+{
+    EventDetector detector;
+    detector.setSettings({ EventDetector::Quantity::Value, EventDetector::Direction::Above, 1.0f, 0.0f, 100 });
+    QVector<EventDetector::Event> started;
+    connect(&detector, &EventDetector::eventStarted,
+            [&started](const EventDetector::Event &event) { started.append(event); });
+
+    detector.addValue(2.0f, 1000);
+    QVERIFY(detector.isActive());
+    QVERIFY(started.isEmpty()); // Not yet lasted the minimum duration.
+    QCOMPARE(detector.eventCount(), (quint64)0);
+
+    detector.addValue(3.0f, 1100);
+    QCOMPARE(started.size(), 1);
+    QCOMPARE(started.at(0).start, (qint64)1000);
+    QCOMPARE(started.at(0).end, (qint64)1100);
+    QCOMPARE(started.at(0).peak, 3.0f);
+    QCOMPARE(detector.eventCount(), (quint64)1);
+
+    detector.addValue(4.0f, 1200);
+    QCOMPARE(started.size(), 1); // Only reported once per event.
+}
+
+void TestEventDetector::flush()
+{
+    EventDetector detector;
+    detector.setSettings({ EventDetector::Quantity::Value, EventDetector::Direction::Above, 1.0f, 0.0f, 0 });
+    QVector<EventDetector::Event> events;
+    connect(&detector, &EventDetector::eventFinished,
+            [&events](const EventDetector::Event &event) { events.append(event); });
+
+    detector.addValue(0.0f, 1000);
+    detector.addValue(5.0f, 1100);
+    detector.addValue(4.0f, 1200);
+    QVERIFY(detector.isActive());
+    QVERIFY(events.isEmpty());
+
+    detector.flush();
+    QVERIFY(!detector.isActive());
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.at(0).start, (qint64)1100);
+    QCOMPARE(events.at(0).end, (qint64)1200);
+    QCOMPARE(events.at(0).peak, 5.0f);
+    QCOMPARE(events.at(0).count, (quint64)2);
+
+    detector.flush(); // Nothing left to flush.
+    QCOMPARE(events.size(), 1);
+
+    // Events shorter than the minimum duration are not flushed either.
+    detector.setSettings({ EventDetector::Quantity::Value, EventDetector::Direction::Above, 1.0f, 0.0f, 1000 });
+    detector.addValue(5.0f, 2000);
+    detector.flush();
+    QCOMPARE(events.size(), 1);
+}
+
+void TestEventDetector::reset()
+{
+    EventDetector detector;
+    detector.setSettings({ EventDetector::Quantity::RateOfChange, EventDetector::Direction::Above, 5.0f, 0.0f, 0 });
+    QVector<EventDetector::Event> events;
+    connect(&detector, &EventDetector::eventFinished,
+            [&events](const EventDetector::Event &event) { events.append(event); });
+
+    detector.addValue(0.0f, 1000);
+    detector.addValue(1.0f, 1100);
+    QVERIFY(detector.isActive());
+    QCOMPARE(detector.eventCount(), (quint64)1);
+
+    detector.reset();
+    QVERIFY(!detector.isActive());
+    QCOMPARE(detector.eventCount(), (quint64)0);
+    detector.flush();
+    QVERIFY(events.isEmpty()); // The event in progress was discarded, not finished.
+
+    // The previous value was cleared too, so the first value after a reset has no rate of change.
+    detector.addValue(10.0f, 1200);
+    QVERIFY(!detector.isActive());
+}
+
+void TestEventDetector::readingRead()
+{
+    EventDetector detector;
+    detector.setSettings({ EventDetector::Quantity::Value, EventDetector::Direction::Above, 1.0f, 0.0f, 0 });
+
+    detector.d_func()->readingRead({ MultimeterService::MeterStatus::Error, 5.0f,
+                                     MultimeterService::Mode::DcVoltage, 0 });
+    QVERIFY(!detector.isActive()); // Erroneous readings are ignored.
+
+    detector.d_func()->readingRead({ MultimeterService::MeterStatus::AutoRangeOn, 5.0f,
+                                     MultimeterService::Mode::DcVoltage, 0 });
+    QVERIFY(detector.isActive());
+    QCOMPARE(detector.eventCount(), (quint64)1);
+}
+
+void TestEventDetector::loggerSamplesRead()
+{
+    EventDetector detector;
+    detector.setSettings({ EventDetector::Quantity::Value, EventDetector::Direction::Below, -1.0f, 0.0f, 0 });
+    QVector<EventDetector::Event> events;
+    connect(&detector, &EventDetector::eventFinished,
+            [&events](const EventDetector::Event &event) { events.append(event); });
+
+    detector.d_func()->loggerMetadataRead({ DataLoggerService::LoggerStatus::Done, 0.25f,
+        DataLoggerService::Mode::DcVoltage, 0, 100, 5, 1'700'000'000 });
+    detector.d_func()->loggerSamplesRead({ 0, -4, -8, 0, 0 });
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.at(0).start, (qint64)1'700'000'000'100);
+    QCOMPARE(events.at(0).end, (qint64)1'700'000'000'200);
+    QCOMPARE(events.at(0).peak, -2.0f);
+    QCOMPARE(events.at(0).count, (quint64)2);
+}
+
+void TestEventDetector::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    EventDetector detector;
+    QVERIFY(!detector.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestEventDetector))
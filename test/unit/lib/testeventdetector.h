@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestEventDetector : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void service();
+
+    void isValid_data();
+    void isValid();
+
+    void setSettings();
+
+    void addValue_data();
+    void addValue();
+
+    void eventStarted();
+    void flush();
+    void reset();
+
+    void readingRead();
+    void loggerSamplesRead();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testlatencyhistogram.h"
+
+#include <qtpokit/latencyhistogram.h>
+
+#include <cmath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestLatencyHistogram::empty()
+{
+    const LatencyHistogram histogram;
+    QVERIFY(histogram.isEmpty());
+    QCOMPARE(histogram.count(), (quint64)0);
+    QCOMPARE(histogram.minimum(), (qint64)0);
+    QCOMPARE(histogram.maximum(), (qint64)0);
+    QVERIFY(std::isnan(histogram.mean()));
+    QCOMPARE(histogram.percentile(50.0), (qint64)0);
+}
+
+void TestLatencyHistogram::bucketIndex_data()
+{
+    QTest::addColumn<qint64>("nanoseconds");
+    QTest::addColumn<int>("expected");
+    QTest::addRow("negative")  << (qint64)-5 << 0;
+    QTest::addRow("zero")      << (qint64)0 << 0;
+    QTest::addRow("exact")     << (qint64)63 << 63;
+    QTest::addRow("firstWide") << (qint64)64 << 64;
+    QTest::addRow("sameWide")  << (qint64)65 << 64;
+    QTest::addRow("nextWide")  << (qint64)66 << 65;
+    QTest::addRow("topWide")   << (qint64)127 << 95;
+    QTest::addRow("nextPower") << (qint64)128 << 96;
+    QTest::addRow("1ms")       << (qint64)1'000'000 << 509;
+    QTest::addRow("max")       << ((qint64)1 << LatencyHistogram::maxValueBits) - 1
+                               << LatencyHistogram::bucketCount - 1;
+    QTest::addRow("clamped")   << ((qint64)1 << 50) << LatencyHistogram::bucketCount - 1;
+}
+
+void TestLatencyHistogram::bucketIndex()
+{
+    QFETCH(qint64, nanoseconds);
+    QFETCH(int, expected);
+    QCOMPARE(LatencyHistogram::bucketIndex(nanoseconds), expected);
+}
+
+void TestLatencyHistogram::bucketValue()
+{
+    // Each bucket's value is the highest value recorded in that bucket.
+    for (int index = 0; index < LatencyHistogram::bucketCount; ++index) {
+        const qint64 value = LatencyHistogram::bucketValue(index);
+        QCOMPARE(LatencyHistogram::bucketIndex(value), index);
+        QCOMPARE(LatencyHistogram::bucketIndex(value + 1), qMin(index + 1, LatencyHistogram::bucketCount - 1));
+    }
+    QCOMPARE(LatencyHistogram::bucketValue(509), (qint64)1'015'807);
+
+    // And every value is recorded to within 1/subBucketCount.
+    for (qint64 value = 1; value < ((qint64)1 << LatencyHistogram::maxValueBits); value = value * 3 + 1) {
+        const qint64 bucketValue = LatencyHistogram::bucketValue(LatencyHistogram::bucketIndex(value));
+        QVERIFY(bucketValue >= value);
+        QVERIFY((double)(bucketValue - value) <= (double)value / LatencyHistogram::subBucketCount);
+    }
+}
+
+void TestLatencyHistogram::record()
+{
+    LatencyHistogram histogram;
+    for (const qint64 value: { 20, 10, 30 }) {
+        histogram.record(value);
+    }
+    QVERIFY(!histogram.isEmpty());
+    QCOMPARE(histogram.count(), (quint64)3);
+    QCOMPARE(histogram.minimum(), (qint64)10);
+    QCOMPARE(histogram.maximum(), (qint64)30);
+    QCOMPARE(histogram.mean(), 20.0);
+}
+
+void TestLatencyHistogram::record_clamped()
+{
+    LatencyHistogram histogram;
+    histogram.record(-5); // Recorded as zero.
+    histogram.record((qint64)1 << 45);
+    QCOMPARE(histogram.count(), (quint64)2);
+    QCOMPARE(histogram.minimum(), (qint64)0);
+    QCOMPARE(histogram.maximum(), (qint64)1 << 45);
+    QCOMPARE(histogram.percentile(50.0), (qint64)0);
+    QCOMPARE(histogram.percentile(100.0), (qint64)1 << 45);
+}
+
+void TestLatencyHistogram::percentile_data()
+{
+    QTest::addColumn<double>("percent");
+    QTest::addColumn<qint64>("expected");
+    QTest::addRow("0")    <<   0.0 << (qint64)1;
+    QTest::addRow("50")   <<  50.0 << (qint64)50;
+    QTest::addRow("90")   <<  90.0 << (qint64)91; // The highest value in the bucket of 90 and 91.
+    QTest::addRow("99")   <<  99.0 << (qint64)99;
+    QTest::addRow("99.9") <<  99.9 << (qint64)100;
+    QTest::addRow("100")  << 100.0 << (qint64)100; // No more than the maximum, despite the bucket of 100 and 101.
+    QTest::addRow("200")  << 200.0 << (qint64)100;
+}
+
+void TestLatencyHistogram::percentile()
+{
+    QFETCH(double, percent);
+    QFETCH(qint64, expected);
+    LatencyHistogram histogram;
+    for (qint64 value = 100; value > 0; --value) {
+        histogram.record(value);
+    }
+    QCOMPARE(histogram.percentile(percent), expected);
+}
+
+void TestLatencyHistogram::merge()
+{
+    LatencyHistogram first, second, empty;
+    first.record(1);
+    first.record(2);
+    second.record(3);
+    second.record(100);
+
+    LatencyHistogram merged;
+    merged.merge(empty);
+    QVERIFY(merged.isEmpty());
+    merged.merge(first);
+    QCOMPARE(merged.count(), (quint64)2);
+    QCOMPARE(merged.percentile(50.0), (qint64)1);
+    merged.merge(second);
+    merged.merge(empty);
+    QCOMPARE(merged.count(), (quint64)4);
+    QCOMPARE(merged.minimum(), (qint64)1);
+    QCOMPARE(merged.maximum(), (qint64)100);
+    QCOMPARE(merged.mean(), 26.5);
+    QCOMPARE(merged.percentile(50.0), (qint64)2);
+    QCOMPARE(merged.percentile(75.0), (qint64)3);
+}
+
+void TestLatencyHistogram::reset()
+{
+    LatencyHistogram histogram;
+    histogram.record(1000);
+    histogram.reset();
+    QVERIFY(histogram.isEmpty());
+    QCOMPARE(histogram.count(), (quint64)0);
+    QCOMPARE(histogram.percentile(50.0), (qint64)0);
+    QVERIFY(std::isnan(histogram.mean()));
+
+    histogram.record(7);
+    QCOMPARE(histogram.count(), (quint64)1);
+    QCOMPARE(histogram.minimum(), (qint64)7);
+    QCOMPARE(histogram.maximum(), (qint64)7);
+    QCOMPARE(histogram.percentile(99.0), (qint64)7);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestLatencyHistogram))
@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestLatencyHistogram : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+
+    void bucketIndex_data();
+    void bucketIndex();
+
+    void bucketValue();
+
+    void record();
+    void record_clamped();
+
+    void percentile_data();
+    void percentile();
+
+    void merge();
+
+    void reset();
+};
+
+QTPOKIT_END_NAMESPACE
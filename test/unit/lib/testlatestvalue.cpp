@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testlatestvalue.h"
+
+#include <qtpokit/latestvalue.h>
+
+#include <atomic>
+#include <thread>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+// A value spanning several words, each of which a torn load would leave inconsistent with the others.
+struct Triple {
+    quint32 first { 0 };
+    float second { 0.0f };
+    quint64 third { 0 };
+    quint16 fourth { 0 };
+};
+
+}
+
+void TestLatestValue::initial()
+{
+    const LatestValue<Triple> value(Triple{ 1, 2.0f, 3, 4 });
+    QCOMPARE(value.storeCount(), (quint64)0);
+    const Triple loaded = value.load();
+    QCOMPARE(loaded.first, (quint32)1);
+    QCOMPARE(loaded.second, 2.0f);
+    QCOMPARE(loaded.third, (quint64)3);
+    QCOMPARE(loaded.fourth, (quint16)4);
+
+    const LatestValue<int> defaulted;
+    QCOMPARE(defaulted.load(), 0);
+}
+
+void TestLatestValue::storeLoad()
+{
+    LatestValue<Triple> value;
+    for (quint32 index = 1; index <= 3; ++index) {
+        value.store(Triple{ index, (float)index, index, (quint16)index });
+        QCOMPARE(value.storeCount(), (quint64)index);
+        const Triple loaded = value.load();
+        QCOMPARE(loaded.first, index);
+        QCOMPARE(loaded.third, (quint64)index);
+        QCOMPARE(loaded.fourth, (quint16)index);
+    }
+}
+
+void TestLatestValue::concurrent()
+{
+    LatestValue<Triple> value;
+
+    constexpr quint32 count = 200000;
+    std::atomic<bool> done { false };
+    std::thread writer([&value, &done]{
+        for (quint32 index = 1; index <= count; ++index) {
+            value.store(Triple{ index, (float)index, index, (quint16)index });
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    // Every load must be a value that was stored in full, and never older than a previous load.
+    bool consistent = true, ordered = true;
+    for (quint32 previous = 0; !done.load(std::memory_order_acquire);) {
+        const Triple loaded = value.load();
+        if ((loaded.third != loaded.first) || (loaded.second != (float)loaded.first)
+            || (loaded.fourth != (quint16)loaded.first)) {
+            consistent = false;
+        }
+        if (loaded.first < previous) {
+            ordered = false;
+        }
+        previous = loaded.first;
+    }
+    writer.join();
+
+    QVERIFY(consistent);
+    QVERIFY(ordered);
+    QCOMPARE(value.storeCount(), (quint64)count);
+    QCOMPARE(value.load().first, count);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestLatestValue))
@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestLatestValue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initial();
+    void storeLoad();
+    void concurrent();
+};
+
+QTPOKIT_END_NAMESPACE
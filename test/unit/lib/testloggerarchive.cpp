@@ -0,0 +1,654 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testloggerarchive.h"
+
+#include <qtpokit/loggerarchive.h>
+#include "loggerarchive_p.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+// Two sessions: ten samples at 1s intervals from 1,000s, and four samples at 500ms intervals from 2,001s.
+const DataLoggerService::Metadata firstMetadata {
+    DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage, 1, 1000, 10, 1000
+};
+const DataLoggerService::Samples firstSamples { -50, -40, -30, -20, -10, 0, 10, 20, 30, 40 };
+const DataLoggerService::Metadata secondMetadata {
+    DataLoggerService::LoggerStatus::Sampling, 0.25f, DataLoggerService::Mode::DcCurrent, 2, 500, 6, 2000
+};
+const DataLoggerService::Samples secondSamples { 1, 2, 3, 4 };
+
+bool writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    return (file.open(QIODevice::WriteOnly)) && (file.write(contents) == contents.size());
+}
+
+}
+
+void TestLoggerArchive::fileName()
+{
+    const LoggerArchive archive(QStringLiteral("example.bin"));
+    QCOMPARE(archive.fileName(), QStringLiteral("example.bin"));
+    QVERIFY(!archive.isOpen());
+    QCOMPARE(archive.sessionCount(), (qsizetype)0);
+}
+
+void TestLoggerArchive::open_missing()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("missing.bin")));
+    QVERIFY(!archive.open());
+    QVERIFY(!archive.isOpen());
+}
+
+void TestLoggerArchive::open_data()
+{
+    QTest::addColumn<QByteArray>("contents");
+    QTest::addColumn<QString>("warning");
+    QTest::addColumn<bool>("expected");
+
+    const QByteArray header = QByteArray::fromHex("444f4b4101000000");                 // "DOKA", version 1.
+    const QByteArray footer = QByteArray::fromHex("0800000000000000" "00000000" "444f4b49"); // Empty index.
+
+    QTest::addRow("empty")      << QByteArray() << QString() << false;
+    QTest::addRow("tooSmall")   << header << QStringLiteral("Archive is too small: 8 byte/s") << false;
+    QTest::addRow("emptyIndex") << header + footer << QString() << true;
+    QTest::addRow("badMagic")   << QByteArray("DOKX\x01\0\0\0", 8) + footer
+                                << QStringLiteral("Not a logger archive.") << false;
+    QTest::addRow("badFooter")  << header + footer.left(12) + "DOKX"
+                                << QStringLiteral("Not a logger archive.") << false;
+    QTest::addRow("badVersion") << QByteArray::fromHex("444f4b4102000000") + footer
+                                << QStringLiteral("Unsupported archive version: 2") << false;
+    QTest::addRow("badIndex")   << header + QByteArray::fromHex("0900000000000000" "00000000" "444f4b49")
+                                << QStringLiteral("Invalid archive index: 0 entry/s at offset 9") << false;
+    QTest::addRow("badOffset")  << header
+        + QByteArray::fromHex("e803000000000000" "e803000000000000" "0000000000000000") // Block at offset 0.
+        + QByteArray::fromHex("0800000000000000" "01000000" "444f4b49")
+        << QStringLiteral("Invalid archive block offset: 0") << false;
+    QTest::addRow("badCount")   << header
+        + QByteArray::fromHex("01010000" "0000803f" "00000000" "00000000" "00000000" "ff000000" "0000000000000000")
+        + QByteArray::fromHex("e803000000000000" "e803000000000000" "0800000000000000") // 255 samples, in 0 bytes.
+        + QByteArray::fromHex("2800000000000000" "01000000" "444f4b49")
+        << QStringLiteral("Invalid archive block size: 255 sample/s at offset 8") << false;
+    QTest::addRow("badEncoding") << header
+        + QByteArray::fromHex("01010002" "0000803f" "00000000" "00000000" "00000000" "00000000" "0000000000000000")
+        + QByteArray::fromHex("e803000000000000" "e803000000000000" "0800000000000000")
+        + QByteArray::fromHex("2800000000000000" "01000000" "444f4b49")
+        << QStringLiteral("Unsupported archive block encoding: 2 at offset 8") << false;
+    QTest::addRow("badEncodedSize") << header
+        + QByteArray::fromHex("01010001" "0000803f" "00000000" "00000000" "00000000" "02000000" "0100000000000000")
+        + QByteArray::fromHex("0200000000000000") // 2 samples, but only 1 encoded byte.
+        + QByteArray::fromHex("e803000000000000" "e803000000000000" "0800000000000000")
+        + QByteArray::fromHex("3000000000000000" "01000000" "444f4b49")
+        << QStringLiteral("Invalid archive block size: 2 sample/s at offset 8") << false;
+}
+
+void TestLoggerArchive::open()
+{
+    QFETCH(QByteArray, contents);
+    QFETCH(QString, warning);
+    QFETCH(bool, expected);
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("archive.bin"));
+    QVERIFY(writeFile(fileName, contents));
+
+    LoggerArchive archive(fileName);
+    if (!warning.isEmpty()) {
+        QTest::ignoreMessage(QtWarningMsg, warning.toUtf8().constData());
+    }
+    if (!expected) {
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Failed to read archive ")));
+    }
+    QCOMPARE(archive.open(), expected);
+    QCOMPARE(archive.isOpen(), expected);
+    QCOMPARE(archive.sessionCount(), (qsizetype)0);
+}
+
+void TestLoggerArchive::append()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(archive.append(firstMetadata, firstSamples));
+    QVERIFY(archive.append(secondMetadata, secondSamples, 2));
+    QVERIFY(!archive.isOpen());
+
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)2);
+
+    const LoggerArchive::Session first = archive.session(0);
+    QCOMPARE(first.metadata.status,          firstMetadata.status);
+    QCOMPARE(first.metadata.scale,           firstMetadata.scale);
+    QCOMPARE(first.metadata.mode,            firstMetadata.mode);
+    QCOMPARE(first.metadata.range,           firstMetadata.range);
+    QCOMPARE(first.metadata.updateInterval,  firstMetadata.updateInterval);
+    QCOMPARE(first.metadata.numberOfSamples, (quint16)10);
+    QCOMPARE(first.metadata.timestamp,       firstMetadata.timestamp);
+    QCOMPARE(first.firstSample,    (quint32)0);
+    QCOMPARE(first.firstTimestamp, (quint64)1000000);
+    QCOMPARE(first.lastTimestamp,  (quint64)1009000);
+    QCOMPARE(archive.samples(0), firstSamples);
+
+    // Only the archived samples are counted, not all of the session's samples.
+    const LoggerArchive::Session second = archive.session(1);
+    QCOMPARE(second.metadata.status,          secondMetadata.status);
+    QCOMPARE(second.metadata.scale,           secondMetadata.scale);
+    QCOMPARE(second.metadata.mode,            secondMetadata.mode);
+    QCOMPARE(second.metadata.numberOfSamples, (quint16)4);
+    QCOMPARE(second.firstSample,    (quint32)2);
+    QCOMPARE(second.firstTimestamp, (quint64)2001000);
+    QCOMPARE(second.lastTimestamp,  (quint64)2002500);
+    QCOMPARE(archive.samples(1), secondSamples);
+
+    // Header, two blocks (with padding), two index entries, and the footer.
+    QCOMPARE(QFileInfo(archive.fileName()).size(), (qint64)(8 + (32+24) + (32+8) + 2*24 + 16));
+}
+
+void TestLoggerArchive::append_compressed()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(!archive.compressSamples());
+    QVERIFY(archive.append(firstMetadata, firstSamples));
+    archive.setCompressSamples(true);
+    QVERIFY(archive.compressSamples());
+    QVERIFY(archive.append(secondMetadata, secondSamples, 2));
+
+    // Archives may mix raw and compressed runs.
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)2);
+    QCOMPARE(archive.samples(0), firstSamples);
+    QCOMPARE(archive.samples(1), secondSamples);
+    QCOMPARE(archive.session(1).metadata.numberOfSamples, (quint16)4);
+    QCOMPARE(archive.session(1).lastTimestamp, (quint64)2002500);
+
+    // Compressing the first session too, takes one byte per sample (plus padding), instead of two.
+    const QString fileName = dir.filePath(QStringLiteral("compressed.bin"));
+    LoggerArchive compressed(fileName);
+    compressed.setCompressSamples(true);
+    QVERIFY(compressed.append(firstMetadata, firstSamples));
+    QVERIFY(compressed.append(secondMetadata, secondSamples, 2));
+    QCOMPARE(QFileInfo(fileName).size(), (qint64)(8 + (32+16) + (32+8) + 2*24 + 16));
+    QVERIFY(compressed.open());
+    QCOMPARE(compressed.samples(0), firstSamples);
+    QCOMPARE(compressed.samples(1), secondSamples);
+}
+
+void TestLoggerArchive::append_empty()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(archive.append(firstMetadata, { }));
+    QVERIFY(!QFile::exists(archive.fileName()));
+
+    const DataLoggerService::Samples tooMany(std::numeric_limits<quint16>::max() + 1);
+    QTest::ignoreMessage(QtWarningMsg, "Too many samples to archive as a single session: 65536");
+    QVERIFY(!archive.append(firstMetadata, tooMany));
+    QVERIFY(!QFile::exists(archive.fileName()));
+}
+
+void TestLoggerArchive::append_order()
+{
+    // Append the later session first; the time index should still be in time order.
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(archive.append(secondMetadata, secondSamples, 2));
+    QVERIFY(archive.append(firstMetadata, firstSamples));
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)2);
+    QCOMPARE(archive.session(0).firstTimestamp, (quint64)1000000);
+    QCOMPARE(archive.session(1).firstTimestamp, (quint64)2001000);
+    QCOMPARE(archive.samples(0), firstSamples);
+    QCOMPARE(archive.samples(1), secondSamples);
+}
+
+void TestLoggerArchive::append_whileOpen()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(archive.append(firstMetadata, firstSamples));
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)1);
+
+    // The archive should be re-opened, with the new session available.
+    QVERIFY(archive.append(secondMetadata, secondSamples, 2));
+    QVERIFY(archive.isOpen());
+    QCOMPARE(archive.sessionCount(), (qsizetype)2);
+    QCOMPARE(archive.samples(1), secondSamples);
+
+    archive.close();
+    QVERIFY(!archive.isOpen());
+    QCOMPARE(archive.sessionCount(), (qsizetype)0);
+}
+
+void TestLoggerArchive::compact()
+{
+    // Incremental fetches of both sessions, split (and partially duplicated) across two archives.
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive first(dir.filePath(QStringLiteral("first.bin")));
+    QVERIFY(first.append(firstMetadata, firstSamples.mid(0, 4)));
+    QVERIFY(first.append(secondMetadata, secondSamples.mid(0, 2), 2));
+    QVERIFY(first.append(firstMetadata, firstSamples.mid(4, 3), 4));
+    LoggerArchive second(dir.filePath(QStringLiteral("second.bin")));
+    QVERIFY(second.append(firstMetadata, firstSamples.mid(5, 5), 5)); // Overlaps the previous run by two samples.
+    QVERIFY(second.append(secondMetadata, secondSamples.mid(2), 4));
+
+    const QString fileName = dir.filePath(QStringLiteral("compacted.bin"));
+    QVERIFY(LoggerArchive::compact({ first.fileName(), second.fileName() }, fileName));
+    LoggerArchive archive(fileName);
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)2);
+
+    const LoggerArchive::Session session = archive.session(0);
+    QCOMPARE(session.metadata.mode,            firstMetadata.mode);
+    QCOMPARE(session.metadata.numberOfSamples, (quint16)10);
+    QCOMPARE(session.firstSample,    (quint32)0);
+    QCOMPARE(session.firstTimestamp, (quint64)1000000);
+    QCOMPARE(session.lastTimestamp,  (quint64)1009000);
+    QCOMPARE(archive.samples(0), firstSamples);
+    QCOMPARE(archive.session(1).metadata.status, secondMetadata.status);
+    QCOMPARE(archive.session(1).firstSample, (quint32)2);
+    QCOMPARE(archive.session(1).lastTimestamp, (quint64)2002500);
+    QCOMPARE(archive.samples(1), secondSamples);
+
+    // Header, two blocks (with padding), two index entries, and the footer.
+    QCOMPARE(QFileInfo(fileName).size(), (qint64)(8 + (32+24) + (32+8) + 2*24 + 16));
+
+    // Compressing is optional, and non-contiguous runs remain separate blocks.
+    archive.close();
+    QVERIFY(first.append(firstMetadata, firstSamples.mid(9), 9)); // Skips samples 7 and 8.
+    QVERIFY(LoggerArchive::compact({ first.fileName() }, fileName, true));
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)3);
+    QCOMPARE(archive.samples(0), firstSamples.mid(0, 7));
+    QCOMPARE(archive.session(1).firstSample, (quint32)9);
+    QCOMPARE(archive.samples(1), firstSamples.mid(9));
+    QCOMPARE(archive.samples(2), secondSamples.mid(0, 2));
+}
+
+void TestLoggerArchive::compact_inPlace()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    for (int index = 0; index < firstSamples.size(); index += 2) {
+        QVERIFY(archive.append(firstMetadata, firstSamples.mid(index, 2), index));
+    }
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)5);
+    archive.close();
+
+    QVERIFY(LoggerArchive::compact({ archive.fileName() }, archive.fileName()));
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)1);
+    QCOMPARE(archive.samples(0), firstSamples);
+}
+
+void TestLoggerArchive::compact_overflow()
+{
+    // Sessions longer than a single block can hold, are continued in consecutive blocks.
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    constexpr int maxSamples { std::numeric_limits<quint16>::max() };
+    DataLoggerService::Samples samples(maxSamples);
+    for (int index = 0; index < samples.size(); ++index) {
+        samples[index] = (qint16)(index % 1000);
+    }
+    QVERIFY(archive.append(firstMetadata, samples));
+    QVERIFY(archive.append(firstMetadata, samples.mid(0, 10), maxSamples));
+
+    const QString fileName = dir.filePath(QStringLiteral("compacted.bin"));
+    QVERIFY(LoggerArchive::compact({ archive.fileName() }, fileName));
+    LoggerArchive compacted(fileName);
+    QVERIFY(compacted.open());
+    QCOMPARE(compacted.sessionCount(), (qsizetype)2);
+    QCOMPARE(compacted.session(0).metadata.numberOfSamples, (quint16)maxSamples);
+    QCOMPARE(compacted.samples(0), samples);
+    QCOMPARE(compacted.session(1).firstSample, (quint32)maxSamples);
+    QCOMPARE(compacted.samples(1), samples.mid(0, 10));
+}
+
+void TestLoggerArchive::compact_missing()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("compacted.bin"));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Failed to open archive .*")));
+    QVERIFY(!LoggerArchive::compact({ dir.filePath(QStringLiteral("missing.bin")) }, fileName));
+    QVERIFY(!QFile::exists(fileName));
+}
+
+void TestLoggerArchive::findSession_data()
+{
+    QTest::addColumn<quint64>("timestamp");
+    QTest::addColumn<qsizetype>("expected");
+
+    QTest::addRow("zero")        << (quint64)0       << (qsizetype)-1;
+    QTest::addRow("before")      << (quint64)999999  << (qsizetype)-1;
+    QTest::addRow("firstStart")  << (quint64)1000000 << (qsizetype)0;
+    QTest::addRow("firstMiddle") << (quint64)1005500 << (qsizetype)0;
+    QTest::addRow("firstEnd")    << (quint64)1009000 << (qsizetype)0;
+    QTest::addRow("gap")         << (quint64)1009001 << (qsizetype)-1;
+    QTest::addRow("secondStart") << (quint64)2001000 << (qsizetype)1;
+    QTest::addRow("secondEnd")   << (quint64)2002500 << (qsizetype)1;
+    QTest::addRow("after")       << (quint64)2002501 << (qsizetype)-1;
+    QTest::addRow("max")   << std::numeric_limits<quint64>::max() << (qsizetype)-1;
+}
+
+void TestLoggerArchive::findSession()
+{
+    QFETCH(quint64, timestamp);
+    QFETCH(qsizetype, expected);
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QCOMPARE(archive.findSession(timestamp), (qsizetype)-1); // Not open.
+    QVERIFY(archive.append(firstMetadata, firstSamples));
+    QVERIFY(archive.append(secondMetadata, secondSamples, 2));
+    QVERIFY(archive.open());
+    QCOMPARE(archive.findSession(timestamp), expected);
+}
+
+void TestLoggerArchive::findSessions_data()
+{
+    QTest::addColumn<quint64>("from");
+    QTest::addColumn<quint64>("to");
+    QTest::addColumn<QVector<qsizetype>>("expected");
+
+    const quint64 max = std::numeric_limits<quint64>::max();
+    QTest::addRow("all")      << (quint64)0       << max              << QVector<qsizetype>{ 0, 1 };
+    QTest::addRow("before")   << (quint64)0       << (quint64)999999  << QVector<qsizetype>{ };
+    QTest::addRow("first")    << (quint64)1000000 << (quint64)1000000 << QVector<qsizetype>{ 0 };
+    QTest::addRow("gap")      << (quint64)1009001 << (quint64)2000999 << QVector<qsizetype>{ };
+    QTest::addRow("span")     << (quint64)1005000 << (quint64)2001000 << QVector<qsizetype>{ 0, 1 };
+    QTest::addRow("second")   << (quint64)2002000 << max              << QVector<qsizetype>{ 1 };
+    QTest::addRow("after")    << (quint64)2002501 << max              << QVector<qsizetype>{ };
+    QTest::addRow("reversed") << (quint64)2002000 << (quint64)1000000 << QVector<qsizetype>{ };
+}
+
+void TestLoggerArchive::findSessions()
+{
+    QFETCH(quint64, from);
+    QFETCH(quint64, to);
+    QFETCH(QVector<qsizetype>, expected);
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QCOMPARE(archive.findSessions(from, to), QVector<qsizetype>{ }); // Not open.
+    QVERIFY(archive.append(firstMetadata, firstSamples));
+    QVERIFY(archive.append(secondMetadata, secondSamples, 2));
+    QVERIFY(archive.open());
+    QCOMPARE(archive.findSessions(from, to), expected);
+}
+
+void TestLoggerArchive::findSessions_overlapping()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+
+    // Two short runs, from 1,002s and 1,004s, within the first (long) run, as if from other devices.
+    DataLoggerService::Metadata metadata = firstMetadata;
+    QVERIFY(archive.append(metadata, firstSamples));
+    metadata.timestamp = 1002;
+    QVERIFY(archive.append(metadata, { 1 }));
+    metadata.timestamp = 1004;
+    QVERIFY(archive.append(metadata, { 2, 3 }));
+    QVERIFY(archive.open());
+    QCOMPARE(archive.sessionCount(), (qsizetype)3);
+
+    QCOMPARE(archive.findSessions(1002000, 1002000), (QVector<qsizetype>{ 0, 1 }));
+    QCOMPARE(archive.findSessions(1002500, 1004000), (QVector<qsizetype>{ 0, 2 }));
+    QCOMPARE(archive.findSessions(1006000, 1007000), QVector<qsizetype>{ 0 }); // Short runs have ended.
+    QCOMPARE(archive.findSessions(1009001, 1010000), QVector<qsizetype>{ });
+
+    // The most recently started run containing the timestamp, even if later runs have ended already.
+    QCOMPARE(archive.findSession(1000000), (qsizetype)0);
+    QCOMPARE(archive.findSession(1002000), (qsizetype)1);
+    QCOMPARE(archive.findSession(1003000), (qsizetype)0);
+    QCOMPARE(archive.findSession(1004500), (qsizetype)2);
+    QCOMPARE(archive.findSession(1006000), (qsizetype)0);
+    QCOMPARE(archive.findSession(1009001), (qsizetype)-1);
+}
+
+void TestLoggerArchive::samples_data()
+{
+    QTest::addColumn<quint64>("from");
+    QTest::addColumn<quint64>("to");
+    QTest::addColumn<DataLoggerService::Samples>("expected");
+
+    const quint64 max = std::numeric_limits<quint64>::max();
+    QTest::addRow("all")       << (quint64)0       << max             << firstSamples;
+    QTest::addRow("exact")     << (quint64)1000000 << (quint64)1009000 << firstSamples;
+    QTest::addRow("partial")   << (quint64)1000500 << (quint64)1002000 << DataLoggerService::Samples{ -40, -30 };
+    QTest::addRow("single")    << (quint64)1003000 << (quint64)1003000 << DataLoggerService::Samples{ -20 };
+    QTest::addRow("between")   << (quint64)1003200 << (quint64)1003800 << DataLoggerService::Samples{ };
+    QTest::addRow("head")      << (quint64)0       << (quint64)1001999 << DataLoggerService::Samples{ -50, -40 };
+    QTest::addRow("tail")      << (quint64)1008000 << max             << DataLoggerService::Samples{ 30, 40 };
+    QTest::addRow("before")    << (quint64)0       << (quint64)999999  << DataLoggerService::Samples{ };
+    QTest::addRow("after")     << (quint64)1009001 << max             << DataLoggerService::Samples{ };
+    QTest::addRow("reversed")  << (quint64)1009000 << (quint64)1000000 << DataLoggerService::Samples{ };
+}
+
+void TestLoggerArchive::samples()
+{
+    QFETCH(quint64, from);
+    QFETCH(quint64, to);
+    QFETCH(DataLoggerService::Samples, expected);
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    for (const bool compress: { false, true }) {
+        LoggerArchive archive(dir.filePath((compress) ? QStringLiteral("compressed.bin") : QStringLiteral("raw.bin")));
+        archive.setCompressSamples(compress);
+        QVERIFY(archive.append(firstMetadata, firstSamples));
+        QVERIFY(archive.open());
+        QCOMPARE(archive.samples(0, from, to), expected);
+    }
+}
+
+void TestLoggerArchive::aggregate_data()
+{
+    QTest::addColumn<quint64>("from");
+    QTest::addColumn<quint64>("to");
+    QTest::addColumn<quint64>("count");
+    QTest::addColumn<float>("minimum");
+    QTest::addColumn<float>("maximum");
+    QTest::addColumn<double>("sum");
+    QTest::addColumn<quint64>("firstTimestamp");
+    QTest::addColumn<quint64>("lastTimestamp");
+
+    const quint64 max = std::numeric_limits<quint64>::max();
+    QTest::addRow("all")     << (quint64)0       << max              << (quint64)10 << -25.0f << 20.0f << -25.0
+                             << (quint64)1000000 << (quint64)1009000;
+    QTest::addRow("partial") << (quint64)1000500 << (quint64)1002000 << (quint64)2  << -20.0f << -15.0f << -35.0
+                             << (quint64)1001000 << (quint64)1002000;
+    QTest::addRow("single")  << (quint64)1003000 << (quint64)1003000 << (quint64)1  << -10.0f << -10.0f << -10.0
+                             << (quint64)1003000 << (quint64)1003000;
+    QTest::addRow("tail")    << (quint64)1008000 << max              << (quint64)2  << 15.0f  << 20.0f  << 35.0
+                             << (quint64)1008000 << (quint64)1009000;
+    QTest::addRow("between") << (quint64)1003200 << (quint64)1003800 << (quint64)0  << 0.0f   << 0.0f   << 0.0
+                             << (quint64)0       << (quint64)0;
+    QTest::addRow("after")   << (quint64)1009001 << max              << (quint64)0  << 0.0f   << 0.0f   << 0.0
+                             << (quint64)0       << (quint64)0;
+}
+
+void TestLoggerArchive::aggregate()
+{
+    QFETCH(quint64, from);
+    QFETCH(quint64, to);
+    QFETCH(quint64, count);
+    QFETCH(float, minimum);
+    QFETCH(float, maximum);
+    QFETCH(double, sum);
+    QFETCH(quint64, firstTimestamp);
+    QFETCH(quint64, lastTimestamp);
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    for (const bool compress: { false, true }) {
+        LoggerArchive archive(dir.filePath((compress) ? QStringLiteral("compressed.bin") : QStringLiteral("raw.bin")));
+        archive.setCompressSamples(compress);
+        QVERIFY(archive.append(firstMetadata, firstSamples));
+        QVERIFY(archive.open());
+        const LoggerArchive::Aggregate aggregate = archive.aggregate(0, from, to);
+        QCOMPARE(aggregate.count, count);
+        QCOMPARE(aggregate.minimum, minimum);
+        QCOMPARE(aggregate.maximum, maximum);
+        QCOMPARE(aggregate.sum, sum);
+        QCOMPARE(aggregate.firstTimestamp, firstTimestamp);
+        QCOMPARE(aggregate.lastTimestamp, lastTimestamp);
+    }
+}
+
+void TestLoggerArchive::aggregate_negativeScale()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    DataLoggerService::Metadata metadata = firstMetadata;
+    metadata.scale = -0.5f;
+    QVERIFY(archive.append(metadata, firstSamples));
+    QVERIFY(archive.open());
+    const LoggerArchive::Aggregate aggregate = archive.aggregate(0, 0, std::numeric_limits<quint64>::max());
+    QCOMPARE(aggregate.count, (quint64)10);
+    QCOMPARE(aggregate.minimum, -20.0f); // ie 40 * -0.5
+    QCOMPARE(aggregate.maximum, 25.0f);  // ie -50 * -0.5
+    QCOMPARE(aggregate.sum, 25.0);
+}
+
+void TestLoggerArchive::downsample_data()
+{
+    QTest::addColumn<quint64>("from");
+    QTest::addColumn<quint64>("to");
+    QTest::addColumn<quint64>("width");
+    QTest::addColumn<QVector<quint64>>("starts");
+    QTest::addColumn<QVector<quint64>>("counts");
+    QTest::addColumn<QVector<float>>("minimums");
+    QTest::addColumn<QVector<float>>("maximums");
+    QTest::addColumn<QVector<double>>("sums");
+
+    const quint64 max = std::numeric_limits<quint64>::max();
+    QTest::addRow("all") << (quint64)0 << max << (quint64)4000
+        << QVector<quint64>{ 1000000, 1004000, 1008000 } << QVector<quint64>{ 4, 4, 2 }
+        << QVector<float>{ -25.0f, -5.0f, 15.0f } << QVector<float>{ -10.0f, 10.0f, 20.0f }
+        << QVector<double>{ -70.0, 10.0, 35.0 };
+    QTest::addRow("partial") << (quint64)1002000 << (quint64)1005000 << (quint64)4000
+        << QVector<quint64>{ 1000000, 1004000 } << QVector<quint64>{ 2, 2 }
+        << QVector<float>{ -15.0f, -5.0f } << QVector<float>{ -10.0f, 0.0f }
+        << QVector<double>{ -25.0, -5.0 };
+    QTest::addRow("wide") << (quint64)0 << max << (quint64)3600000
+        << QVector<quint64>{ 0 } << QVector<quint64>{ 10 }
+        << QVector<float>{ -25.0f } << QVector<float>{ 20.0f } << QVector<double>{ -25.0 };
+    QTest::addRow("narrow") << (quint64)1007000 << max << (quint64)1
+        << QVector<quint64>{ 1007000, 1008000, 1009000 } << QVector<quint64>{ 1, 1, 1 }
+        << QVector<float>{ 10.0f, 15.0f, 20.0f } << QVector<float>{ 10.0f, 15.0f, 20.0f }
+        << QVector<double>{ 10.0, 15.0, 20.0 };
+    QTest::addRow("between") << (quint64)1003200 << (quint64)1003800 << (quint64)1000
+        << QVector<quint64>{ } << QVector<quint64>{ } << QVector<float>{ } << QVector<float>{ }
+        << QVector<double>{ };
+}
+
+void TestLoggerArchive::downsample()
+{
+    QFETCH(quint64, from);
+    QFETCH(quint64, to);
+    QFETCH(quint64, width);
+    QFETCH(QVector<quint64>, starts);
+    QFETCH(QVector<quint64>, counts);
+    QFETCH(QVector<float>, minimums);
+    QFETCH(QVector<float>, maximums);
+    QFETCH(QVector<double>, sums);
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    for (const bool compress: { false, true }) {
+        LoggerArchive archive(dir.filePath((compress) ? QStringLiteral("compressed.bin") : QStringLiteral("raw.bin")));
+        archive.setCompressSamples(compress);
+        QVERIFY(archive.append(firstMetadata, firstSamples));
+        QVERIFY(archive.open());
+        const QVector<LoggerArchive::Bucket> buckets = archive.downsample(0, from, to, width);
+        QCOMPARE(buckets.size(), starts.size());
+        quint64 total = 0;
+        for (qsizetype index = 0; index < buckets.size(); ++index) {
+            const LoggerArchive::Bucket &bucket = buckets.at(index);
+            QCOMPARE(bucket.start, starts.at(index));
+            QCOMPARE(bucket.aggregate.count, counts.at(index));
+            QCOMPARE(bucket.aggregate.minimum, minimums.at(index));
+            QCOMPARE(bucket.aggregate.maximum, maximums.at(index));
+            QCOMPARE(bucket.aggregate.sum, sums.at(index));
+            QVERIFY(bucket.aggregate.firstTimestamp >= bucket.start);
+            QVERIFY(bucket.aggregate.lastTimestamp < bucket.start + width);
+            total += bucket.aggregate.count;
+        }
+        QCOMPARE(total, archive.aggregate(0, from, to).count);
+    }
+}
+
+void TestLoggerArchive::merge()
+{
+    LoggerArchive::Aggregate aggregate;
+    LoggerArchive::merge(aggregate, { }); // Empty into empty.
+    QCOMPARE(aggregate.count, (quint64)0);
+
+    LoggerArchive::merge(aggregate, { 2, -1.0f, 3.0f, 2.0, 2000, 3000 }); // Into empty.
+    QCOMPARE(aggregate.count, (quint64)2);
+    QCOMPARE(aggregate.minimum, -1.0f);
+    QCOMPARE(aggregate.maximum, 3.0f);
+    QCOMPARE(aggregate.sum, 2.0);
+    QCOMPARE(aggregate.firstTimestamp, (quint64)2000);
+    QCOMPARE(aggregate.lastTimestamp, (quint64)3000);
+
+    LoggerArchive::merge(aggregate, { }); // Empty into non-empty.
+    QCOMPARE(aggregate.count, (quint64)2);
+
+    LoggerArchive::merge(aggregate, { 3, -2.0f, 1.0f, -1.5, 1000, 2500 });
+    QCOMPARE(aggregate.count, (quint64)5);
+    QCOMPARE(aggregate.minimum, -2.0f);
+    QCOMPARE(aggregate.maximum, 3.0f);
+    QCOMPARE(aggregate.sum, 0.5);
+    QCOMPARE(aggregate.firstTimestamp, (quint64)1000);
+    QCOMPARE(aggregate.lastTimestamp, (quint64)3000);
+}
+
+void TestLoggerArchive::encodeBlock()
+{
+    const DataLoggerService::Metadata metadata {
+        DataLoggerService::LoggerStatus::Sampling, 1.0f, DataLoggerService::Mode::AcVoltage, 3, 500, 123, 0x12345678
+    };
+    QCOMPARE(LoggerArchivePrivate::encodeBlock(metadata, { 1, -2, 0x1234 }, 7),
+             QByteArray::fromHex("02030100" "0000803f" "f4010000" "78563412" "07000000" "03000000" "0000000000000000"
+                                 "0100feff" "34120000"));
+
+    // Compressed blocks record their encoding, and encoded size.
+    QCOMPARE(LoggerArchivePrivate::encodeBlock(metadata, { 1, -2, 0x1234 }, 7, true),
+             QByteArray::fromHex("02030101" "0000803f" "f4010000" "78563412" "07000000" "03000000" "04000000" "00000000"
+                                 "0205ec48" "00000000"));
+}
+
+void TestLoggerArchive::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    const LoggerArchive archive(QString{});
+    QVERIFY(!archive.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestLoggerArchive))
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestLoggerArchive : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fileName();
+
+    void open_missing();
+
+    void open_data();
+    void open();
+
+    void append();
+    void append_compressed();
+    void append_empty();
+    void append_order();
+    void append_whileOpen();
+
+    void compact();
+    void compact_inPlace();
+    void compact_overflow();
+    void compact_missing();
+
+    void findSession_data();
+    void findSession();
+
+    void findSessions_data();
+    void findSessions();
+    void findSessions_overlapping();
+
+    void samples_data();
+    void samples();
+
+    void aggregate_data();
+    void aggregate();
+    void aggregate_negativeScale();
+
+    void downsample_data();
+    void downsample();
+
+    void merge();
+
+    void encodeBlock();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
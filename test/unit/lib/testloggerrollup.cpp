@@ -0,0 +1,269 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testloggerrollup.h"
+
+#include <qtpokit/loggerrollup.h>
+#include "loggerrollup_p.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+constexpr quint64 maxTimestamp { std::numeric_limits<quint64>::max() };
+
+// Two sessions: forty voltage samples at 250ms intervals from 1,000s, and four current samples at 1s intervals from
+// 2,000s. So the voltage has four samples per second, but the current has only one.
+const DataLoggerService::Metadata voltageMetadata {
+    DataLoggerService::LoggerStatus::Done, 0.5f, DataLoggerService::Mode::DcVoltage, 1, 250, 40, 1000
+};
+const DataLoggerService::Metadata currentMetadata {
+    DataLoggerService::LoggerStatus::Done, 0.25f, DataLoggerService::Mode::DcCurrent, 2, 1000, 4, 2000
+};
+
+DataLoggerService::Samples voltageSamples()
+{
+    DataLoggerService::Samples samples;
+    for (int index = 0; index < 40; ++index) {
+        samples.append((qint16)(index - 20));
+    }
+    return samples;
+}
+
+const DataLoggerService::Samples currentSamples { 4, -3, 2, -1 };
+
+bool writeArchive(LoggerArchive &archive)
+{
+    return (archive.append(voltageMetadata, voltageSamples())) && (archive.append(currentMetadata, currentSamples)) &&
+           (archive.open());
+}
+
+void compareBuckets(const QVector<LoggerArchive::Bucket> &actual, const QVector<LoggerArchive::Bucket> &expected)
+{
+    QCOMPARE(actual.size(), expected.size());
+    for (qsizetype index = 0; index < actual.size(); ++index) {
+        QCOMPARE(actual.at(index).start,                    expected.at(index).start);
+        QCOMPARE(actual.at(index).aggregate.count,          expected.at(index).aggregate.count);
+        QCOMPARE(actual.at(index).aggregate.minimum,        expected.at(index).aggregate.minimum);
+        QCOMPARE(actual.at(index).aggregate.maximum,        expected.at(index).aggregate.maximum);
+        QCOMPARE(actual.at(index).aggregate.sum,            expected.at(index).aggregate.sum);
+        QCOMPARE(actual.at(index).aggregate.firstTimestamp, expected.at(index).aggregate.firstTimestamp);
+        QCOMPARE(actual.at(index).aggregate.lastTimestamp,  expected.at(index).aggregate.lastTimestamp);
+    }
+}
+
+}
+
+void TestLoggerRollup::fileName()
+{
+    const LoggerRollup rollup(QStringLiteral("/some/file.rollup"));
+    QCOMPARE(rollup.fileName(), QStringLiteral("/some/file.rollup"));
+}
+
+void TestLoggerRollup::fileNameFor()
+{
+    QCOMPARE(LoggerRollup::fileNameFor(QStringLiteral("/some/file.doka")), QStringLiteral("/some/file.doka.rollup"));
+}
+
+void TestLoggerRollup::defaultTiers()
+{
+    QCOMPARE(LoggerRollup::defaultTiers(), (QVector<quint64>{ 1000, 60000, 3600000 }));
+}
+
+void TestLoggerRollup::build()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(writeArchive(archive));
+
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive.fileName()));
+    QVERIFY(rollup.build(archive));
+    QVERIFY(!rollup.isOpen());
+    QVERIFY(rollup.open(archive));
+    QVERIFY(rollup.isOpen());
+
+    // Current samples are only one per second, so are not worth rolling up into one second buckets.
+    QCOMPARE(rollup.tiers(DataLoggerService::Mode::DcVoltage), (QVector<quint64>{ 1000, 60000, 3600000 }));
+    QCOMPARE(rollup.tiers(DataLoggerService::Mode::DcCurrent), (QVector<quint64>{ 60000, 3600000 }));
+    QCOMPARE(rollup.tiers(DataLoggerService::Mode::AcVoltage), QVector<quint64>{});
+
+    // Header, five section table entries, and ten voltage-seconds, two minutes and two hours, of buckets.
+    QCOMPARE(QFile(rollup.fileName()).size(), (qint64)(32 + 5*24 + (10+2+2)*48));
+
+    rollup.close();
+    QVERIFY(!rollup.isOpen());
+    QCOMPARE(rollup.tiers(DataLoggerService::Mode::DcVoltage), QVector<quint64>{});
+}
+
+void TestLoggerRollup::build_closed()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive.fileName()));
+    QTest::ignoreMessage(QtWarningMsg, qUtf8Printable(QStringLiteral("Archive %1 is not open.")
+        .arg(archive.fileName())));
+    QVERIFY(!rollup.build(archive));
+    QVERIFY(!QFile::exists(rollup.fileName()));
+}
+
+void TestLoggerRollup::build_indivisible()
+{
+    // Tiers that are not multiples of any finer tier, are built from the archive directly.
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(writeArchive(archive));
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive.fileName()));
+    QVERIFY(rollup.build(archive, { 1500, 0, 1000, 1500, 3000 })); // Zero, and duplicate, widths are ignored.
+    QVERIFY(rollup.open(archive));
+    QCOMPARE(rollup.tiers(DataLoggerService::Mode::DcVoltage), (QVector<quint64>{ 1000, 1500, 3000 }));
+    for (const quint64 width: { 1000, 1500, 3000 }) {
+        compareBuckets(rollup.buckets(DataLoggerService::Mode::DcVoltage, width, 0, maxTimestamp),
+                       archive.downsample(0, 0, maxTimestamp, width));
+    }
+}
+
+void TestLoggerRollup::open_missing()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(writeArchive(archive));
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive.fileName()));
+    QVERIFY(!rollup.open(archive));
+    QVERIFY(!rollup.isOpen());
+}
+
+void TestLoggerRollup::open_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(writeArchive(archive));
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive.fileName()));
+    {
+        QFile file(rollup.fileName());
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(file.write(QByteArray(64, 'x')) == 64);
+    }
+    QTest::ignoreMessage(QtWarningMsg, "Not a logger rollup.");
+    QVERIFY(!rollup.open(archive));
+    QVERIFY(!rollup.isOpen());
+}
+
+void TestLoggerRollup::open_stale()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(writeArchive(archive));
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive.fileName()));
+    QVERIFY(rollup.build(archive));
+
+    // Appending to the archive, leaves the rollup out of date.
+    QVERIFY(archive.append(currentMetadata, currentSamples, 4));
+    QVERIFY(archive.isOpen());
+    QVERIFY(!rollup.open(archive));
+    QVERIFY(rollup.build(archive));
+    QVERIFY(rollup.open(archive));
+}
+
+void TestLoggerRollup::buckets()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(writeArchive(archive));
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive.fileName()));
+    QVERIFY(rollup.build(archive));
+    QVERIFY(rollup.open(archive));
+
+    // Every tier should match downsampling the archive directly.
+    compareBuckets(rollup.buckets(DataLoggerService::Mode::DcVoltage, 1000, 0, maxTimestamp),
+                   archive.downsample(0, 0, maxTimestamp, 1000));
+    compareBuckets(rollup.buckets(DataLoggerService::Mode::DcVoltage, 60000, 0, maxTimestamp),
+                   archive.downsample(0, 0, maxTimestamp, 60000));
+    compareBuckets(rollup.buckets(DataLoggerService::Mode::DcVoltage, 3600000, 0, maxTimestamp),
+                   archive.downsample(0, 0, maxTimestamp, 3600000));
+    compareBuckets(rollup.buckets(DataLoggerService::Mode::DcCurrent, 60000, 0, maxTimestamp),
+                   archive.downsample(1, 0, maxTimestamp, 60000));
+
+    // The hour tier holds the whole session's aggregate.
+    const QVector<LoggerArchive::Bucket> hours =
+        rollup.buckets(DataLoggerService::Mode::DcVoltage, 3600000, 0, maxTimestamp);
+    QCOMPARE(hours.size(), (qsizetype)1);
+    QCOMPARE(hours.at(0).start, (quint64)0);
+    QCOMPARE(hours.at(0).aggregate.count, (quint64)40);
+    QCOMPARE(hours.at(0).aggregate.minimum, -10.0f);
+    QCOMPARE(hours.at(0).aggregate.maximum, 9.5f);
+    QCOMPARE(hours.at(0).aggregate.sum, -10.0);
+    QCOMPARE(hours.at(0).aggregate.firstTimestamp, (quint64)1000000);
+    QCOMPARE(hours.at(0).aggregate.lastTimestamp, (quint64)1009750);
+
+    // Tiers that were not rolled up, have no buckets.
+    QVERIFY(rollup.buckets(DataLoggerService::Mode::DcCurrent, 1000, 0, maxTimestamp).isEmpty());
+    QVERIFY(rollup.buckets(DataLoggerService::Mode::DcVoltage, 2000, 0, maxTimestamp).isEmpty());
+}
+
+void TestLoggerRollup::buckets_range()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LoggerArchive archive(dir.filePath(QStringLiteral("archive.bin")));
+    QVERIFY(writeArchive(archive));
+    LoggerRollup rollup(LoggerRollup::fileNameFor(archive.fileName()));
+    QVERIFY(rollup.build(archive));
+    QVERIFY(rollup.open(archive));
+
+    // Only buckets starting within the range are returned, found by binary search.
+    const auto starts = [&rollup](const quint64 from, const quint64 to) {
+        QVector<quint64> starts;
+        for (const LoggerArchive::Bucket &bucket: rollup.buckets(DataLoggerService::Mode::DcVoltage, 1000, from, to)) {
+            starts.append(bucket.start);
+        }
+        return starts;
+    };
+    QCOMPARE(starts(1003000, 1005000), (QVector<quint64>{ 1003000, 1004000, 1005000 }));
+    QCOMPARE(starts(1002500, 1004999), (QVector<quint64>{ 1003000, 1004000 }));
+    QCOMPARE(starts(0, 1000999),       (QVector<quint64>{ 1000000 }));
+    QCOMPARE(starts(1009000, maxTimestamp), (QVector<quint64>{ 1009000 }));
+    QCOMPARE(starts(1010000, maxTimestamp), QVector<quint64>{});
+    QCOMPARE(starts(0, 999999),        QVector<quint64>{});
+    QCOMPARE(starts(1005000, 1004000), QVector<quint64>{});
+}
+
+void TestLoggerRollup::encodeBucket()
+{
+    const LoggerArchive::Aggregate aggregate { 3, -1.0f, 2.0f, 1.5, 0x0102030405060708, 0x1112131415161718 };
+    const QByteArray bucket = LoggerRollupPrivate::encodeBucket(0x1234, aggregate);
+    QCOMPARE(bucket, QByteArray::fromHex("3412000000000000" "0300000000000000" "000080bf" "00000040" "000000000000f83f"
+                                         "0807060504030201" "1817161514131211"));
+    const LoggerArchive::Bucket decoded =
+        LoggerRollupPrivate::decodeBucket(reinterpret_cast<const uchar *>(bucket.constData()));
+    QCOMPARE(decoded.start, (quint64)0x1234);
+    QCOMPARE(decoded.aggregate.count,          aggregate.count);
+    QCOMPARE(decoded.aggregate.minimum,        aggregate.minimum);
+    QCOMPARE(decoded.aggregate.maximum,        aggregate.maximum);
+    QCOMPARE(decoded.aggregate.sum,            aggregate.sum);
+    QCOMPARE(decoded.aggregate.firstTimestamp, aggregate.firstTimestamp);
+    QCOMPARE(decoded.aggregate.lastTimestamp,  aggregate.lastTimestamp);
+}
+
+void TestLoggerRollup::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    const LoggerRollup rollup(QString{});
+    QVERIFY(!rollup.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestLoggerRollup))
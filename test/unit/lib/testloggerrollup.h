@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestLoggerRollup : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fileName();
+    void fileNameFor();
+    void defaultTiers();
+
+    void build();
+    void build_closed();
+    void build_indivisible();
+
+    void open_missing();
+    void open_invalid();
+    void open_stale();
+
+    void buckets();
+    void buckets_range();
+
+    void encodeBucket();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
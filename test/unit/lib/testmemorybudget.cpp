@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testmemorybudget.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/memorybudget.h>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(MemoryBudget)::Kind)
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+void TestMemoryBudget::toString_data()
+{
+    QTest::addColumn<MemoryBudget::Kind>("kind");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(kind, expected) \
+        QTest::addRow(#kind) << MemoryBudget::Kind::kind << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(RingBuffer, "ringBuffer");
+    DOKIT_ADD_TEST_ROW(SamplePool, "samplePool");
+    DOKIT_ADD_TEST_ROW(Capture,    "capture");
+    DOKIT_ADD_TEST_ROW(Output,     "output");
+    DOKIT_ADD_TEST_ROW(Spill,      "spill");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (MemoryBudget::Kind)255 << QString();
+}
+
+void TestMemoryBudget::toString()
+{
+    QFETCH(MemoryBudget::Kind, kind);
+    QFETCH(QString, expected);
+    QCOMPARE(MemoryBudget::toString(kind), expected);
+}
+
+void TestMemoryBudget::unbounded()
+{
+    MemoryBudget budget;
+    QCOMPARE(budget.limit(), (qint64)0);
+    QCOMPARE(budget.defaultQuota(), (qint64)0);
+    MemoryBudget::Stream stream(u"test"_s, MemoryBudget::Kind::Output, &budget);
+    QCOMPARE(stream.name(), u"test"_s);
+    QCOMPARE(stream.kind(), MemoryBudget::Kind::Output);
+    QCOMPARE(stream.quota(), (qint64)0);
+    QVERIFY(stream.reserve(1'000'000'000));
+    QCOMPARE(stream.bytes(), (qint64)1'000'000'000);
+    QCOMPARE(budget.bytes(), (qint64)1'000'000'000);
+    QCOMPARE(stream.usage().refusals, (quint64)0);
+}
+
+void TestMemoryBudget::reserve_quota()
+{
+    MemoryBudget budget;
+    MemoryBudget::Stream stream(u"test"_s, MemoryBudget::Kind::Spill, &budget);
+    stream.setQuota(100);
+    QCOMPARE(stream.quota(), (qint64)100);
+    QVERIFY(stream.reserve(60));
+    QVERIFY(!stream.reserve(41)); // Would exceed the quota.
+    QVERIFY(stream.reserve(40));  // Exactly reaches the quota.
+    QVERIFY(!stream.reserve(1));
+    QCOMPARE(stream.bytes(), (qint64)100);
+    QCOMPARE(stream.usage().refusals, (quint64)2);
+    QCOMPARE(budget.statistics().refusals, (quint64)2);
+
+    // Removing the quota allows further reservations.
+    stream.setQuota(0);
+    QVERIFY(stream.reserve(1));
+}
+
+void TestMemoryBudget::reserve_defaultQuota()
+{
+    MemoryBudget budget;
+    MemoryBudget::Stream first(u"first"_s, MemoryBudget::Kind::Output, &budget);
+    MemoryBudget::Stream second(u"second"_s, MemoryBudget::Kind::Output, &budget);
+    budget.setDefaultQuota(50);
+    second.setQuota(200); // Overrides the default.
+    QCOMPARE(first.quota(), (qint64)50);
+    QCOMPARE(second.quota(), (qint64)200);
+    QVERIFY(!first.reserve(51));
+    QVERIFY(second.reserve(51));
+
+    // Changes to the default apply to streams that have not had their own quota set (including since creation).
+    budget.setDefaultQuota(60);
+    QCOMPARE(first.quota(), (qint64)60);
+    QVERIFY(first.reserve(51));
+}
+
+void TestMemoryBudget::reserve_limit()
+{
+    MemoryBudget budget;
+    budget.setLimit(100);
+    QCOMPARE(budget.limit(), (qint64)100);
+    MemoryBudget::Stream first(u"first"_s, MemoryBudget::Kind::Capture, &budget);
+    MemoryBudget::Stream second(u"second"_s, MemoryBudget::Kind::Capture, &budget);
+    QVERIFY(first.reserve(70));
+    QVERIFY(!second.reserve(31)); // Within second's (lack of) quota, but not the budget's limit.
+    QVERIFY(second.reserve(30));
+    QCOMPARE(budget.bytes(), (qint64)100);
+    QCOMPARE(first.usage().refusals, (quint64)0);
+    QCOMPARE(second.usage().refusals, (quint64)1);
+
+    // Releasing from one stream makes room for another.
+    first.release(20);
+    QVERIFY(second.reserve(20));
+    QCOMPARE(second.bytes(), (qint64)50);
+}
+
+void TestMemoryBudget::charge()
+{
+    MemoryBudget budget;
+    budget.setLimit(10);
+    MemoryBudget::Stream stream(u"test"_s, MemoryBudget::Kind::Output, &budget);
+    stream.charge(25); // Beyond the limit, but charged anyway.
+    QCOMPARE(stream.bytes(), (qint64)25);
+    QCOMPARE(budget.bytes(), (qint64)25);
+    QCOMPARE(stream.usage().refusals, (quint64)0);
+    QVERIFY(!stream.reserve(1));
+    stream.countRefusal();
+    QCOMPARE(stream.usage().refusals, (quint64)2);
+}
+
+void TestMemoryBudget::release()
+{
+    MemoryBudget budget;
+    MemoryBudget::Stream stream(u"test"_s, MemoryBudget::Kind::Output, &budget);
+    QVERIFY(stream.reserve(100));
+    stream.release(60);
+    QCOMPARE(stream.bytes(), (qint64)40);
+    QCOMPARE(budget.bytes(), (qint64)40);
+    const MemoryBudget::Usage usage = stream.usage();
+    QCOMPARE(usage.bytes, (qint64)40);
+    QCOMPARE(usage.peak, (qint64)100); // Peaks are retained.
+    QCOMPARE(budget.statistics().peak, (qint64)100);
+}
+
+void TestMemoryBudget::fits()
+{
+    MemoryBudget budget;
+    budget.setLimit(100);
+    MemoryBudget::Stream stream(u"test"_s, MemoryBudget::Kind::Output, &budget);
+    stream.setQuota(50);
+    QVERIFY(stream.fits(0));
+    QVERIFY(stream.fits(50));
+    QVERIFY(!stream.fits(51));
+    stream.charge(60);
+    QVERIFY(!stream.fits(0)); // Already over quota.
+    QCOMPARE(stream.usage().refusals, (quint64)0); // Unlike reserve(), fits() never counts refusals.
+}
+
+void TestMemoryBudget::statistics()
+{
+    MemoryBudget budget;
+    budget.setLimit(1000);
+    budget.setDefaultQuota(400);
+    MemoryBudget::Stream first(u"first"_s, MemoryBudget::Kind::RingBuffer, &budget);
+    MemoryBudget::Stream second(u"second"_s, MemoryBudget::Kind::Spill, &budget);
+    second.setQuota(500);
+    QVERIFY(first.reserve(300));
+    QVERIFY(second.reserve(200));
+    QVERIFY(!second.reserve(400));
+
+    const MemoryBudget::Statistics statistics = budget.statistics();
+    QCOMPARE(statistics.limit, (qint64)1000);
+    QCOMPARE(statistics.bytes, (qint64)500);
+    QCOMPARE(statistics.peak, (qint64)500);
+    QCOMPARE(statistics.refusals, (quint64)1);
+    QCOMPARE(statistics.streams.size(), (qsizetype)2);
+    QCOMPARE(statistics.streams.at(0).name, u"first"_s);
+    QCOMPARE(statistics.streams.at(0).kind, MemoryBudget::Kind::RingBuffer);
+    QCOMPARE(statistics.streams.at(0).bytes, (qint64)300);
+    QCOMPARE(statistics.streams.at(0).quota, (qint64)400);
+    QCOMPARE(statistics.streams.at(0).refusals, (quint64)0);
+    QCOMPARE(statistics.streams.at(1).name, u"second"_s);
+    QCOMPARE(statistics.streams.at(1).kind, MemoryBudget::Kind::Spill);
+    QCOMPARE(statistics.streams.at(1).bytes, (qint64)200);
+    QCOMPARE(statistics.streams.at(1).quota, (qint64)500);
+    QCOMPARE(statistics.streams.at(1).refusals, (quint64)1);
+}
+
+void TestMemoryBudget::streamDestroyed()
+{
+    MemoryBudget budget;
+    {
+        MemoryBudget::Stream stream(u"test"_s, MemoryBudget::Kind::Output, &budget);
+        QVERIFY(stream.reserve(100));
+        QCOMPARE(budget.statistics().streams.size(), (qsizetype)1);
+    }
+    QCOMPARE(budget.bytes(), (qint64)0);
+    QCOMPARE(budget.statistics().peak, (qint64)100);
+    QVERIFY(budget.statistics().streams.isEmpty());
+}
+
+void TestMemoryBudget::global()
+{
+    QVERIFY(MemoryBudget::global());
+    QCOMPARE(MemoryBudget::global(), MemoryBudget::global());
+    const qint64 before = MemoryBudget::global()->bytes();
+    {
+        // Streams default to the global budget.
+        MemoryBudget::Stream stream(u"test"_s, MemoryBudget::Kind::Output);
+        stream.charge(10);
+        QCOMPARE(MemoryBudget::global()->bytes(), before + 10);
+    }
+    QCOMPARE(MemoryBudget::global()->bytes(), before);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestMemoryBudget))
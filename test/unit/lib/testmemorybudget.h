@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestMemoryBudget : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toString_data();
+    void toString();
+
+    void unbounded();
+
+    void reserve_quota();
+    void reserve_defaultQuota();
+    void reserve_limit();
+
+    void charge();
+    void release();
+    void fits();
+
+    void statistics();
+    void streamDestroyed();
+
+    void global();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testmeteraggregator.h"
+
+#include <qtpokit/meteraggregator.h>
+#include "meteraggregator_p.h"
+
+#include <QDateTime>
+#include <QSignalSpy>
+#include <QtMath>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(MeterAggregator::Window))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+MultimeterService::Reading reading(const float value, const quint8 range = 1,
+    const MultimeterService::MeterStatus status = MultimeterService::MeterStatus::AutoRangeOff)
+{
+    return { status, value, MultimeterService::Mode::DcVoltage, range };
+}
+
+MeterAggregator::Window window(const QSignalSpy &spy, const int index)
+{
+    return spy.at(index).first().value<MeterAggregator::Window>();
+}
+
+}
+
+void TestMeterAggregator::initTestCase()
+{
+    // Register the type used by MeterAggregator::windowReady, so QSignalSpy can record its arguments.
+    qRegisterMetaType<MeterAggregator::Window>("MeterAggregator::Window");
+}
+
+void TestMeterAggregator::service()
+{
+    MultimeterService service(nullptr);
+    MeterAggregator aggregator(&service);
+    QCOMPARE(aggregator.service(), &service);
+
+    MultimeterService other(nullptr);
+    aggregator.d_func()->setService(&other);
+    QCOMPARE(aggregator.service(), &other);
+    QVERIFY(!QObject::disconnect(&service, nullptr, aggregator.d_func(), nullptr));
+}
+
+void TestMeterAggregator::period()
+{
+    MeterAggregator aggregator(nullptr);
+    QCOMPARE(aggregator.period(), 1000u);
+    aggregator.setPeriod(60000);
+    QCOMPARE(aggregator.period(), 60000u);
+    aggregator.setPeriod(0);
+    QCOMPARE(aggregator.period(), 1u);
+}
+
+void TestMeterAggregator::step()
+{
+    MeterAggregator aggregator(nullptr);
+    QCOMPARE(aggregator.step(), 0u);
+    QCOMPARE(aggregator.d_func()->stride(), 1000u);
+    aggregator.setStep(250);
+    QCOMPARE(aggregator.step(), 250u);
+    QCOMPARE(aggregator.d_func()->stride(), 250u);
+    aggregator.setStep(5000); // Larger than the period, so fixed windows.
+    QCOMPARE(aggregator.d_func()->stride(), 1000u);
+}
+
+void TestMeterAggregator::addReading_fixed()
+{
+    MeterAggregator aggregator(nullptr);
+    QSignalSpy spy(&aggregator, &MeterAggregator::windowReady);
+    aggregator.addReading(reading(1.0f), 10100);
+    aggregator.addReading(reading(3.0f), 10500);
+    aggregator.addReading(reading(2.0f), 10999);
+    QCOMPARE(spy.size(), 0);
+
+    aggregator.addReading(reading(5.0f), 11000); // Ends the first window, and starts the next.
+    QCOMPARE(spy.size(), 1);
+    MeterAggregator::Window first = window(spy, 0);
+    QCOMPARE(first.start, (qint64)10000);
+    QCOMPARE(first.end, (qint64)11000);
+    QCOMPARE(first.count, (quint64)3);
+    QCOMPARE(first.minimum, 1.0f);
+    QCOMPARE(first.maximum, 3.0f);
+    QCOMPARE(first.mean, 2.0f);
+    QCOMPARE(first.status, MultimeterService::MeterStatus::AutoRangeOff);
+    QCOMPARE(first.mode, MultimeterService::Mode::DcVoltage);
+    QCOMPARE(first.range, (quint8)1);
+
+    // Windows without readings are skipped, rather than emitted empty.
+    aggregator.addReading(reading(7.0f), 13200);
+    QCOMPARE(spy.size(), 2);
+    const MeterAggregator::Window second = window(spy, 1);
+    QCOMPARE(second.start, (qint64)11000);
+    QCOMPARE(second.count, (quint64)1);
+    QCOMPARE(second.mean, 5.0f);
+
+    aggregator.flush();
+    QCOMPARE(spy.size(), 3);
+    QCOMPARE(window(spy, 2).start, (qint64)13000);
+    QCOMPARE(window(spy, 2).end, (qint64)14000);
+}
+
+void TestMeterAggregator::addReading_sliding()
+{
+    MeterAggregator aggregator(nullptr);
+    aggregator.setPeriod(1000);
+    aggregator.setStep(500);
+    QSignalSpy spy(&aggregator, &MeterAggregator::windowReady);
+    aggregator.addReading(reading(1.0f), 1200); // Spanned by windows starting at 500 and 1000.
+    aggregator.addReading(reading(2.0f), 1600); // Spanned by windows starting at 1000 and 1500.
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(window(spy, 0).start, (qint64)500);
+    QCOMPARE(window(spy, 0).end, (qint64)1500);
+    QCOMPARE(window(spy, 0).count, (quint64)1);
+    QCOMPARE(window(spy, 0).mean, 1.0f);
+
+    aggregator.addReading(reading(6.0f), 2100); // Spanned by windows starting at 1500 and 2000.
+    QCOMPARE(spy.size(), 2);
+    QCOMPARE(window(spy, 1).start, (qint64)1000);
+    QCOMPARE(window(spy, 1).count, (quint64)2);
+    QCOMPARE(window(spy, 1).minimum, 1.0f);
+    QCOMPARE(window(spy, 1).maximum, 2.0f);
+    QCOMPARE(window(spy, 1).mean, 1.5f);
+
+    aggregator.flush();
+    QCOMPARE(spy.size(), 4);
+    QCOMPARE(window(spy, 2).start, (qint64)1500);
+    QCOMPARE(window(spy, 2).count, (quint64)2);
+    QCOMPARE(window(spy, 2).mean, 4.0f);
+    QCOMPARE(window(spy, 3).start, (qint64)2000);
+    QCOMPARE(window(spy, 3).count, (quint64)1);
+    QCOMPARE(window(spy, 3).mean, 6.0f);
+}
+
+void TestMeterAggregator::addReading_rangeChange()
+{
+    MeterAggregator aggregator(nullptr);
+    QSignalSpy spy(&aggregator, &MeterAggregator::windowReady);
+    aggregator.addReading(reading(1.0f, 1), 100);
+    aggregator.addReading(reading(100.0f, 2), 200); // Different range, so kept apart.
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(window(spy, 0).count, (quint64)1);
+    QCOMPARE(window(spy, 0).maximum, 1.0f);
+    QCOMPARE(window(spy, 0).range, (quint8)1);
+
+    aggregator.flush();
+    QCOMPARE(spy.size(), 2);
+    QCOMPARE(window(spy, 1).start, (qint64)0);
+    QCOMPARE(window(spy, 1).count, (quint64)1);
+    QCOMPARE(window(spy, 1).minimum, 100.0f);
+    QCOMPARE(window(spy, 1).range, (quint8)2);
+}
+
+void TestMeterAggregator::addReading_error()
+{
+    MeterAggregator aggregator(nullptr);
+    QSignalSpy spy(&aggregator, &MeterAggregator::windowReady);
+    aggregator.addReading(reading(1.0f), 100);
+    aggregator.addReading(reading(0.0f, 1, MultimeterService::MeterStatus::Error), 200);
+    aggregator.addReading(reading(0.0f, 1, MultimeterService::MeterStatus::Error), 300);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(window(spy, 0).mean, 1.0f);
+
+    aggregator.addReading(reading(2.0f), 400); // No longer erroneous, so kept apart again.
+    QCOMPARE(spy.size(), 2);
+    const MeterAggregator::Window errors = window(spy, 1);
+    QCOMPARE(errors.count, (quint64)2);
+    QCOMPARE(errors.status, MultimeterService::MeterStatus::Error);
+    QVERIFY(qIsNaN(errors.minimum));
+    QVERIFY(qIsNaN(errors.maximum));
+    QVERIFY(qIsNaN(errors.mean));
+
+    aggregator.flush();
+    QCOMPARE(spy.size(), 3);
+    QCOMPARE(window(spy, 2).mean, 2.0f);
+}
+
+void TestMeterAggregator::flush()
+{
+    MeterAggregator aggregator(nullptr);
+    QSignalSpy spy(&aggregator, &MeterAggregator::windowReady);
+    aggregator.flush(); // Nothing to flush.
+    QCOMPARE(spy.size(), 0);
+
+    aggregator.addReading(reading(1.0f), 100);
+    aggregator.setPeriod(5000); // Flushes windows of the old period.
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(window(spy, 0).end, (qint64)1000);
+    aggregator.flush();
+    QCOMPARE(spy.size(), 1);
+}
+
+void TestMeterAggregator::reset()
+{
+    MeterAggregator aggregator(nullptr);
+    QSignalSpy spy(&aggregator, &MeterAggregator::windowReady);
+    aggregator.addReading(reading(1.0f), 100);
+    aggregator.reset();
+    aggregator.flush();
+    QCOMPARE(spy.size(), 0);
+}
+
+void TestMeterAggregator::readingRead()
+{
+    MeterAggregator aggregator(nullptr);
+    aggregator.setPeriod(3600000);
+    QSignalSpy spy(&aggregator, &MeterAggregator::windowReady);
+    aggregator.d_func()->readingRead(reading(1.0f));
+    aggregator.flush();
+    QCOMPARE(spy.size(), 1);
+    const MeterAggregator::Window hour = window(spy, 0);
+    QVERIFY(hour.start <= QDateTime::currentMSecsSinceEpoch());
+    QCOMPARE(hour.end, hour.start + 3600000);
+    QCOMPARE(hour.start % 3600000, (qint64)0);
+}
+
+void TestMeterAggregator::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    MeterAggregator aggregator(nullptr);
+    QVERIFY(!aggregator.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestMeterAggregator))
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestMeterAggregator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void service();
+    void period();
+    void step();
+
+    void addReading_fixed();
+    void addReading_sliding();
+    void addReading_rangeChange();
+    void addReading_error();
+
+    void flush();
+    void reset();
+
+    void readingRead();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testmeterdeadband.h"
+
+#include <qtpokit/meterdeadband.h>
+#include "meterdeadband_p.h"
+
+#include <QSignalSpy>
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(MultimeterService::Reading))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+MultimeterService::Reading reading(const float value, const quint8 range = 1,
+    const MultimeterService::MeterStatus status = MultimeterService::MeterStatus::AutoRangeOff)
+{
+    return { status, value, MultimeterService::Mode::DcVoltage, range };
+}
+
+}
+
+void TestMeterDeadband::initTestCase()
+{
+    // Register the type used by MeterDeadband::readingAccepted, so QSignalSpy can record its arguments.
+    qRegisterMetaType<MultimeterService::Reading>("MultimeterService::Reading");
+}
+
+void TestMeterDeadband::service()
+{
+    MultimeterService service(nullptr);
+    MeterDeadband deadband(&service);
+    QCOMPARE(deadband.service(), &service);
+
+    MultimeterService other(nullptr);
+    deadband.d_func()->setService(&other);
+    QCOMPARE(deadband.service(), &other);
+    QVERIFY(!QObject::disconnect(&service, nullptr, deadband.d_func(), nullptr));
+}
+
+void TestMeterDeadband::absoluteDeadband()
+{
+    MeterDeadband deadband(nullptr);
+    QCOMPARE(deadband.absoluteDeadband(), 0.0f);
+    deadband.setAbsoluteDeadband(0.25f);
+    QCOMPARE(deadband.absoluteDeadband(), 0.25f);
+    deadband.setAbsoluteDeadband(-1.0f);
+    QCOMPARE(deadband.absoluteDeadband(), 0.0f);
+}
+
+void TestMeterDeadband::relativeDeadband()
+{
+    MeterDeadband deadband(nullptr);
+    QCOMPARE(deadband.relativeDeadband(), 0.0f);
+    deadband.setRelativeDeadband(0.01f);
+    QCOMPARE(deadband.relativeDeadband(), 0.01f);
+    deadband.setRelativeDeadband(-1.0f);
+    QCOMPARE(deadband.relativeDeadband(), 0.0f);
+}
+
+void TestMeterDeadband::heartbeat()
+{
+    MeterDeadband deadband(nullptr);
+    QCOMPARE(deadband.heartbeat(), 0u);
+    deadband.setHeartbeat(60000);
+    QCOMPARE(deadband.heartbeat(), 60000u);
+}
+
+void TestMeterDeadband::isChanged_data()
+{
+    QTest::addColumn<float>("absolute");
+    QTest::addColumn<float>("relative");
+    QTest::addColumn<MultimeterService::Reading>("last");
+    QTest::addColumn<MultimeterService::Reading>("next");
+    QTest::addColumn<bool>("expected");
+
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+
+    QTest::addRow("identical")      << 0.0f << 0.0f << reading(1.0f) << reading(1.0f) << false;
+    QTest::addRow("changed")        << 0.0f << 0.0f << reading(1.0f) << reading(1.001f) << true;
+    QTest::addRow("withinAbsolute") << 0.1f << 0.0f << reading(1.0f) << reading(1.0625f) << false;
+    QTest::addRow("beyondAbsolute") << 0.1f << 0.0f << reading(1.0f) << reading(0.875f) << true;
+    QTest::addRow("withinRelative") << 0.0f << 0.1f << reading(10.0f) << reading(10.5f) << false;
+    QTest::addRow("beyondRelative") << 0.0f << 0.1f << reading(10.0f) << reading(8.5f) << true;
+    QTest::addRow("largerApplies")  << 1.0f << 0.1f << reading(2.0f) << reading(2.75f) << false;
+    QTest::addRow("range")          << 1.0f << 0.0f << reading(1.0f, 1) << reading(1.0f, 2) << true;
+    QTest::addRow("status")         << 1.0f << 0.0f << reading(1.0f)
+        << reading(1.0f, 1, MultimeterService::MeterStatus::Error) << true;
+    QTest::addRow("sameInfinity")   << 0.0f << 0.1f << reading(inf) << reading(inf) << false;
+    QTest::addRow("fromInfinity")   << 0.0f << 0.1f << reading(inf) << reading(5.0f) << true;
+    QTest::addRow("toInfinity")     << 1e9f << 0.0f << reading(5.0f) << reading(inf) << true;
+    QTest::addRow("nans")           << 0.0f << 0.0f << reading(nan) << reading(nan) << false;
+    QTest::addRow("fromNaN")        << 1.0f << 0.0f << reading(nan) << reading(1.0f) << true;
+}
+
+void TestMeterDeadband::isChanged()
+{
+    QFETCH(float, absolute);
+    QFETCH(float, relative);
+    QFETCH(MultimeterService::Reading, last);
+    QFETCH(MultimeterService::Reading, next);
+    QFETCH(bool, expected);
+
+    MeterDeadband deadband(nullptr);
+    deadband.setAbsoluteDeadband(absolute);
+    deadband.setRelativeDeadband(relative);
+    QVERIFY(deadband.d_func()->isChanged(last)); // The first reading is always a change.
+    deadband.d_func()->lastReading = last;
+    QCOMPARE(deadband.d_func()->isChanged(next), expected);
+}
+
+void TestMeterDeadband::addReading()
+{
+    MeterDeadband deadband(nullptr);
+    deadband.setAbsoluteDeadband(0.5f);
+    QSignalSpy spy(&deadband, &MeterDeadband::readingAccepted);
+    QVERIFY( deadband.addReading(reading(1.0f), 1000));
+    QVERIFY(!deadband.addReading(reading(1.25f), 2000));
+    QVERIFY(!deadband.addReading(reading(0.75f), 3000));
+    QVERIFY( deadband.addReading(reading(2.0f), 4000));
+    QCOMPARE(spy.size(), 2);
+    QCOMPARE(spy.at(0).first().value<MultimeterService::Reading>().value, 1.0f);
+    QCOMPARE(spy.at(1).first().value<MultimeterService::Reading>().value, 2.0f);
+    QCOMPARE(deadband.acceptedCount(), (quint64)2);
+    QCOMPARE(deadband.suppressedCount(), (quint64)2);
+}
+
+void TestMeterDeadband::addReading_drift()
+{
+    // Readings are compared to the last accepted reading, so slow drift is eventually reported.
+    MeterDeadband deadband(nullptr);
+    deadband.setAbsoluteDeadband(0.5f);
+    QVERIFY( deadband.addReading(reading(1.0f), 0));
+    QVERIFY(!deadband.addReading(reading(1.25f), 1));
+    QVERIFY(!deadband.addReading(reading(1.5f), 2));
+    QVERIFY( deadband.addReading(reading(1.75f), 3));
+    QVERIFY(!deadband.addReading(reading(1.5f), 4));
+}
+
+void TestMeterDeadband::addReading_heartbeat()
+{
+    MeterDeadband deadband(nullptr);
+    deadband.setHeartbeat(1000);
+    QVERIFY( deadband.addReading(reading(1.0f), 10000));
+    QVERIFY(!deadband.addReading(reading(1.0f), 10500));
+    QVERIFY(!deadband.addReading(reading(1.0f), 10999));
+    QVERIFY( deadband.addReading(reading(1.0f), 11000)); // Heartbeat.
+    QVERIFY(!deadband.addReading(reading(1.0f), 11999));
+    QVERIFY( deadband.addReading(reading(2.0f), 12500)); // Changed, which restarts the heartbeat.
+    QVERIFY(!deadband.addReading(reading(2.0f), 13000));
+    QVERIFY( deadband.addReading(reading(2.0f), 13500));
+}
+
+void TestMeterDeadband::reset()
+{
+    MeterDeadband deadband(nullptr);
+    QVERIFY( deadband.addReading(reading(1.0f), 0));
+    QVERIFY(!deadband.addReading(reading(1.0f), 1));
+    deadband.reset();
+    QCOMPARE(deadband.acceptedCount(), (quint64)0);
+    QCOMPARE(deadband.suppressedCount(), (quint64)0);
+    QVERIFY( deadband.addReading(reading(1.0f), 2));
+}
+
+void TestMeterDeadband::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    MeterDeadband deadband(nullptr);
+    QVERIFY(!deadband.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestMeterDeadband))
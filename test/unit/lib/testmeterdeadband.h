@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestMeterDeadband : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void service();
+    void absoluteDeadband();
+    void relativeDeadband();
+    void heartbeat();
+
+    void isChanged_data();
+    void isChanged();
+
+    void addReading();
+    void addReading_drift();
+    void addReading_heartbeat();
+
+    void reset();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
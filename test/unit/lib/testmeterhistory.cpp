@@ -0,0 +1,293 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testmeterhistory.h"
+
+#include <qtpokit/meterhistory.h>
+
+#include <QtMath>
+
+#include <utility>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+/// Returns \a count readings, 10ms apart, with values 0, 1, 2..., switching to auto-range every 5th reading, and an
+/// error every 7th.
+QVector<MultimeterService::TimedReading> makeReadings(const int count)
+{
+    QVector<MultimeterService::TimedReading> readings;
+    for (int index = 0; index < count; ++index) {
+        readings.append({ 1'000'000'000 + index * 10'000'000LL, {
+            (index % 7 == 6) ? MultimeterService::MeterStatus::Error
+                : (index % 5 == 4) ? MultimeterService::MeterStatus::AutoRangeOn
+                : MultimeterService::MeterStatus::AutoRangeOff,
+            (float)index, MultimeterService::Mode::DcVoltage, (quint8)(index / 10) } });
+    }
+    return readings;
+}
+
+/// Returns \c true if \a actual and \a expected have the same timestamps, statuses, values, modes and ranges.
+bool equal(const QVector<MultimeterService::TimedReading> &actual,
+           const QVector<MultimeterService::TimedReading> &expected)
+{
+    if (actual.size() != expected.size()) {
+        return false;
+    }
+    for (qsizetype index = 0; index < actual.size(); ++index) {
+        const MultimeterService::TimedReading &a = actual.at(index), &b = expected.at(index);
+        if ((a.timestamp != b.timestamp) || (a.reading.status != b.reading.status)
+            || (a.reading.value != b.reading.value) || (a.reading.mode != b.reading.mode)
+            || (a.reading.range != b.reading.range))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+void TestMeterHistory::empty()
+{
+    const MeterHistory history;
+    QCOMPARE(history.chunkSize(), MeterHistory::defaultChunkSize);
+    QCOMPARE(history.chunkCount(), (qsizetype)0);
+    QCOMPARE(history.size(), (qsizetype)0);
+    QVERIFY(history.isEmpty());
+    QCOMPARE(history.firstTimestamp(), (qint64)0);
+    QCOMPARE(history.lastTimestamp(), (qint64)0);
+    QCOMPARE(history.indexOf(123), (qsizetype)0);
+    QVERIFY(history.begin() == history.end());
+    QVERIFY(history.spans().isEmpty());
+    QVERIFY(history.toVector().isEmpty());
+
+    // Out-of-range readings are errors.
+    const MultimeterService::TimedReading reading = history.at(0);
+    QCOMPARE(reading.reading.status, MultimeterService::MeterStatus::Error);
+    QVERIFY(qIsNaN(reading.reading.value));
+
+    // Chunks hold at least one reading.
+    QCOMPARE(MeterHistory(0).chunkSize(), (qsizetype)1);
+}
+
+void TestMeterHistory::append_data()
+{
+    QTest::addColumn<int>("chunkSize");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("expectedChunks");
+
+    QTest::addRow("one")       << 4096 <<   1 << 1;
+    QTest::addRow("oneChunk")  << 4096 << 100 << 1;
+    QTest::addRow("fullChunk") <<   10 << 100 << 10;
+    QTest::addRow("partial")   <<    7 << 100 << 15;
+    QTest::addRow("tiny")      <<    1 <<  20 << 20;
+}
+
+void TestMeterHistory::append()
+{
+    QFETCH(int, chunkSize);
+    QFETCH(int, count);
+    QFETCH(int, expectedChunks);
+
+    const QVector<MultimeterService::TimedReading> readings = makeReadings(count);
+    MeterHistory history(chunkSize);
+    for (const MultimeterService::TimedReading &reading: readings) {
+        history.append(reading);
+    }
+    QCOMPARE(history.size(), (qsizetype)count);
+    QCOMPARE(history.chunkCount(), (qsizetype)expectedChunks);
+    QCOMPARE(history.firstTimestamp(), readings.constFirst().timestamp);
+    QCOMPARE(history.lastTimestamp(), readings.constLast().timestamp);
+    QVERIFY(equal(history.toVector(), readings));
+
+    // Iterating gives the same readings.
+    QVector<MultimeterService::TimedReading> iterated;
+    for (const MultimeterService::TimedReading &reading: history) {
+        iterated.append(reading);
+    }
+    QVERIFY(equal(iterated, readings));
+
+    // As does appending all at once.
+    QVERIFY(equal(MeterHistory::fromVector(readings, chunkSize).toVector(), readings));
+
+    history.clear();
+    QVERIFY(history.isEmpty());
+    QCOMPARE(history.chunkCount(), (qsizetype)0);
+}
+
+void TestMeterHistory::append_wideDeltas()
+{
+    // Deltas beyond 32 bits, and negative deltas (such as from clock adjustments), are preserved too.
+    const MultimeterService::Reading reading{ MultimeterService::MeterStatus::Ok, 1.0f,
+                                              MultimeterService::Mode::Temperature, 0 };
+    const QVector<MultimeterService::TimedReading> readings{
+        { -5, reading }, { 0, reading }, { 10'000'000'000, reading }, { 9'999'999'000, reading },
+        { 0xFFFFFFFF + 9'999'999'000LL, reading }, { 0xFFFFFFFE + 0xFFFFFFFF + 9'999'999'000LL, reading },
+    };
+    for (const int chunkSize: { 1, 2, 4096 }) {
+        const MeterHistory history = MeterHistory::fromVector(readings, chunkSize);
+        QVERIFY(equal(history.toVector(), readings));
+        for (qsizetype index = 0; index < readings.size(); ++index) {
+            QCOMPARE(history.at(index).timestamp, readings.at(index).timestamp);
+        }
+    }
+}
+
+void TestMeterHistory::at()
+{
+    const QVector<MultimeterService::TimedReading> readings = makeReadings(50);
+    const MeterHistory history = MeterHistory::fromVector(readings, 8);
+    for (qsizetype index = 0; index < readings.size(); ++index) {
+        QVERIFY(equal({ history.at(index) }, { readings.at(index) }));
+    }
+    QCOMPARE(history.at(-1).reading.status, MultimeterService::MeterStatus::Error);
+    QCOMPARE(history.at(50).reading.status, MultimeterService::MeterStatus::Error);
+}
+
+void TestMeterHistory::indexOf()
+{
+    const MeterHistory history = MeterHistory::fromVector(makeReadings(50), 8);
+    QCOMPARE(history.indexOf(0), (qsizetype)0);
+    QCOMPARE(history.indexOf(1'000'000'000), (qsizetype)0);
+    QCOMPARE(history.indexOf(1'000'000'001), (qsizetype)1);
+    QCOMPARE(history.indexOf(1'080'000'000), (qsizetype)8);
+    QCOMPARE(history.indexOf(1'075'000'000), (qsizetype)8);
+    QCOMPARE(history.indexOf(1'490'000'000), (qsizetype)49);
+    QCOMPARE(history.indexOf(1'490'000'001), (qsizetype)50);
+}
+
+void TestMeterHistory::slice_data()
+{
+    QTest::addColumn<int>("first");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("expectedSize");
+
+    QTest::addRow("all")            <<  0 << -1 << 50;
+    QTest::addRow("none")           <<  0 <<  0 <<  0;
+    QTest::addRow("fromStart")      <<  0 <<  5 <<  5;
+    QTest::addRow("wholeChunks")    <<  8 << 16 << 16;
+    QTest::addRow("acrossChunks")   <<  5 << 20 << 20;
+    QTest::addRow("withinChunk")    << 17 <<  3 <<  3;
+    QTest::addRow("toEnd")          << 45 << -1 <<  5;
+    QTest::addRow("beyondEnd")      << 45 << 10 <<  5;
+    QTest::addRow("afterEnd")       << 60 <<  1 <<  0;
+    QTest::addRow("negativeFirst")  << -5 <<  2 <<  2;
+}
+
+void TestMeterHistory::slice()
+{
+    QFETCH(int, first);
+    QFETCH(int, count);
+    QFETCH(int, expectedSize);
+
+    const QVector<MultimeterService::TimedReading> readings = makeReadings(50);
+    const MeterHistory history = MeterHistory::fromVector(readings, 8);
+    MeterHistory slice = history.slice(first, count);
+    QCOMPARE(slice.size(), (qsizetype)expectedSize);
+    QCOMPARE(slice.chunkSize(), history.chunkSize());
+    QVERIFY(equal(slice.toVector(), readings.mid(qMax(first, 0), expectedSize)));
+
+    // Appending to the slice leaves the original history unchanged.
+    slice.append(readings.constLast());
+    QCOMPARE(slice.size(), (qsizetype)expectedSize + 1);
+    QVERIFY(equal({ slice.at(expectedSize) }, { readings.constLast() }));
+    QVERIFY(equal(history.toVector(), readings));
+}
+
+void TestMeterHistory::between()
+{
+    const QVector<MultimeterService::TimedReading> readings = makeReadings(50);
+    const MeterHistory history = MeterHistory::fromVector(readings, 8);
+    QVERIFY(equal(history.between(1'100'000'000, 1'200'000'000).toVector(), readings.mid(10, 10)));
+    QVERIFY(equal(history.between(1'095'000'000, 1'205'000'000).toVector(), readings.mid(10, 11)));
+    QVERIFY(equal(history.between(0, 2'000'000'000).toVector(), readings));
+    QVERIFY(history.between(1'200'000'000, 1'100'000'000).isEmpty());
+}
+
+void TestMeterHistory::removeBefore()
+{
+    const QVector<MultimeterService::TimedReading> readings = makeReadings(50);
+    MeterHistory history = MeterHistory::fromVector(readings, 8);
+    QCOMPARE(history.removeBefore(0), (qsizetype)0);
+    QCOMPARE(history.size(), (qsizetype)50);
+
+    // Whole chunks are dropped, along with any earlier readings of the next.
+    QCOMPARE(history.removeBefore(1'180'000'000), (qsizetype)18);
+    QCOMPARE(history.size(), (qsizetype)32);
+    QCOMPARE(history.firstTimestamp(), (qint64)1'180'000'000);
+    QVERIFY(equal(history.toVector(), readings.mid(18)));
+
+    // Further appends continue as normal.
+    history.append(2'000'000'000, readings.constFirst().reading);
+    QCOMPARE(history.size(), (qsizetype)33);
+    QCOMPARE(history.lastTimestamp(), (qint64)2'000'000'000);
+
+    QCOMPARE(history.removeBefore(3'000'000'000), (qsizetype)33);
+    QVERIFY(history.isEmpty());
+}
+
+void TestMeterHistory::spans()
+{
+    const QVector<MultimeterService::TimedReading> readings = makeReadings(50);
+    const MeterHistory history = MeterHistory::fromVector(readings, 8);
+    for (const auto &[first, count]: QVector<std::pair<qsizetype, qsizetype>>{ { 0, -1 }, { 3, 30 }, { 49, 1 } }) {
+        qsizetype next = first;
+        for (const MeterHistory::Span &span: history.spans(first, count)) {
+            QCOMPARE(span.first, next);
+            QVERIFY(span.count > 0);
+            QCOMPARE(span.timestamp, readings.at(span.first).timestamp);
+            for (qsizetype index = 0; index < span.count; ++index) {
+                const MultimeterService::Reading &reading = readings.at(span.first + index).reading;
+                QCOMPARE(span.values[index], reading.value);
+                QCOMPARE(span.status, reading.status);
+                QCOMPARE(span.mode, reading.mode);
+                QCOMPARE(span.range, reading.range);
+            }
+            next += span.count;
+        }
+        QCOMPARE(next, (count < 0) ? readings.size() : first + count);
+    }
+
+    // Runs of unchanged status, mode and range, within a chunk, are a single span.
+    const MultimeterService::Reading reading{ MultimeterService::MeterStatus::Ok, 1.0f,
+                                              MultimeterService::Mode::Diode, 0 };
+    MeterHistory steady(4);
+    for (qint64 timestamp = 0; timestamp < 10; ++timestamp) {
+        steady.append(timestamp, reading);
+    }
+    const QVector<MeterHistory::Span> steadySpans = steady.spans();
+    QCOMPARE(steadySpans.size(), 3);
+    QCOMPARE(steadySpans.at(0).count, (qsizetype)4);
+    QCOMPARE(steadySpans.at(2).count, (qsizetype)2);
+    QCOMPARE(steadySpans.at(2).timestamp, (qint64)8);
+}
+
+void TestMeterHistory::memoryUsage()
+{
+    // Regular readings cost about a third of the memory of TimedReading structs.
+    QVector<MultimeterService::TimedReading> readings;
+    for (int index = 0; index < 100'000; ++index) {
+        readings.append({ index * 100'000'000LL, { MultimeterService::MeterStatus::AutoRangeOff, (float)index,
+                                                   MultimeterService::Mode::DcVoltage, 1 } });
+    }
+    const MeterHistory history = MeterHistory::fromVector(readings);
+    QCOMPARE(history.chunkCount(), (qsizetype)25);
+    QVERIFY(history.memoryUsage() < readings.size() * (qsizetype)sizeof(MultimeterService::TimedReading) / 2);
+    QVERIFY(history.memoryUsage() >= readings.size() * (qsizetype)(sizeof(float) + sizeof(quint32)));
+
+    // Slices share whole chunks, but still count them.
+    QVERIFY(history.slice(0, 4096).memoryUsage() >= 4096 * (qsizetype)(sizeof(float) + sizeof(quint32)));
+}
+
+void TestMeterHistory::tr()
+{
+    // Exercise the inline tr() function (added by the Q_DECLARE_TR_FUNCTIONS macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    QVERIFY(!MeterHistory::tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestMeterHistory))
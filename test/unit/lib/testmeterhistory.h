@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestMeterHistory : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+
+    void append_data();
+    void append();
+
+    void append_wideDeltas();
+
+    void at();
+    void indexOf();
+
+    void slice_data();
+    void slice();
+
+    void between();
+    void removeBefore();
+
+    void spans();
+
+    void memoryUsage();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
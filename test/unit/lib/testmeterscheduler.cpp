@@ -0,0 +1,210 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testmeterscheduler.h"
+
+#include <qtpokit/meterscheduler.h>
+#include <qtpokit/pokitmeter.h>
+#include "meterscheduler_p.h"
+
+#include <QSignalSpy>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(MultimeterService::Mode))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(MultimeterService::Reading))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+const QVector<MeterScheduler::Entry> schedule {
+    { MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::AutoRange, 10000 },
+    { MultimeterService::Mode::DcCurrent, +PokitMeter::CurrentRange::_150mA,     5000 },
+};
+
+MultimeterService::Reading reading(const MultimeterService::Mode mode, const quint8 range)
+{
+    return { MultimeterService::MeterStatus::AutoRangeOff, 1.0f, mode, range };
+}
+
+}
+
+void TestMeterScheduler::initTestCase()
+{
+    // Register the types used by MeterScheduler's signals, so QSignalSpy can record its arguments.
+    qRegisterMetaType<MultimeterService::Reading>("MultimeterService::Reading");
+    qRegisterMetaType<qint64>("qint64");
+}
+
+void TestMeterScheduler::service()
+{
+    MultimeterService service(nullptr);
+    MeterScheduler scheduler(&service);
+    QCOMPARE(scheduler.service(), &service);
+
+    MultimeterService other(nullptr);
+    scheduler.d_func()->setService(&other);
+    QCOMPARE(scheduler.service(), &other);
+    QVERIFY(!QObject::disconnect(&service, nullptr, scheduler.d_func(), nullptr));
+}
+
+void TestMeterScheduler::entries()
+{
+    MeterScheduler scheduler(nullptr);
+    QVERIFY(scheduler.entries().isEmpty());
+    scheduler.setEntries(schedule);
+    QCOMPARE(scheduler.entries().size(), 2);
+    QCOMPARE(scheduler.entries().at(1).mode,  MultimeterService::Mode::DcCurrent);
+    QCOMPARE(scheduler.entries().at(1).range, +PokitMeter::CurrentRange::_150mA);
+    QCOMPARE(scheduler.entries().at(1).dwell, 5000u);
+}
+
+void TestMeterScheduler::updateInterval()
+{
+    MeterScheduler scheduler(nullptr);
+    QCOMPARE(scheduler.updateInterval(), 1000u);
+    scheduler.setUpdateInterval(250);
+    QCOMPARE(scheduler.updateInterval(), 250u);
+}
+
+void TestMeterScheduler::start()
+{
+    // Cannot start without a service, or entries.
+    MeterScheduler noService(nullptr);
+    noService.setEntries(schedule);
+    QVERIFY(!noService.start());
+    QVERIFY(!noService.isRunning());
+
+    MultimeterService service(nullptr);
+    MeterScheduler scheduler(&service);
+    QVERIFY(!scheduler.start());
+    QVERIFY(!scheduler.isRunning());
+    QCOMPARE(scheduler.currentIndex(), -1);
+
+    // Without a Bluetooth device, the settings write fails, but the schedule still runs.
+    scheduler.setEntries(schedule);
+    QVERIFY(!scheduler.start());
+    QVERIFY(scheduler.isRunning());
+    QCOMPARE(scheduler.currentIndex(), 0);
+    QVERIFY(scheduler.d_func()->dwellTimer.isActive());
+    QCOMPARE(scheduler.d_func()->dwellTimer.interval(), 10000);
+}
+
+void TestMeterScheduler::stop()
+{
+    MultimeterService service(nullptr);
+    MeterScheduler scheduler(&service);
+    scheduler.setEntries(schedule);
+    scheduler.start();
+    scheduler.stop();
+    QVERIFY(!scheduler.isRunning());
+    QCOMPARE(scheduler.currentIndex(), -1);
+    QVERIFY(!scheduler.d_func()->dwellTimer.isActive());
+}
+
+void TestMeterScheduler::isCurrent_data()
+{
+    QTest::addColumn<int>("index");
+    QTest::addColumn<MultimeterService::Mode>("mode");
+    QTest::addColumn<quint8>("range");
+    QTest::addColumn<bool>("expected");
+
+    QTest::addRow("auto:matching") << 0 << MultimeterService::Mode::DcVoltage
+        << +PokitMeter::VoltageRange::_6V << true;
+    QTest::addRow("auto:otherMode") << 0 << MultimeterService::Mode::DcCurrent
+        << +PokitMeter::CurrentRange::_150mA << false;
+    QTest::addRow("fixed:matching") << 1 << MultimeterService::Mode::DcCurrent
+        << +PokitMeter::CurrentRange::_150mA << true;
+    QTest::addRow("fixed:otherRange") << 1 << MultimeterService::Mode::DcCurrent
+        << +PokitMeter::CurrentRange::_2A << false;
+    QTest::addRow("fixed:otherMode") << 1 << MultimeterService::Mode::DcVoltage
+        << +PokitMeter::CurrentRange::_150mA << false;
+}
+
+void TestMeterScheduler::isCurrent()
+{
+    QFETCH(int, index);
+    QFETCH(MultimeterService::Mode, mode);
+    QFETCH(quint8, range);
+    QFETCH(bool, expected);
+
+    MeterScheduler scheduler(nullptr);
+    scheduler.setEntries(schedule);
+    scheduler.d_func()->index = index;
+    QCOMPARE(scheduler.d_func()->isCurrent(reading(mode, range)), expected);
+}
+
+void TestMeterScheduler::nextEntry()
+{
+    MultimeterService service(nullptr);
+    MeterScheduler scheduler(&service);
+    scheduler.setEntries(schedule);
+    scheduler.d_func()->nextEntry(); // Does nothing until started.
+    QCOMPARE(scheduler.currentIndex(), -1);
+
+    scheduler.start();
+    scheduler.d_func()->nextEntry();
+    QCOMPARE(scheduler.currentIndex(), 1);
+    QCOMPARE(scheduler.d_func()->dwellTimer.interval(), 5000);
+    scheduler.d_func()->nextEntry();
+    QCOMPARE(scheduler.currentIndex(), 0); // Wrapped around.
+    QCOMPARE(scheduler.d_func()->dwellTimer.interval(), 10000);
+}
+
+void TestMeterScheduler::readingRead()
+{
+    MultimeterService service(nullptr);
+    MeterScheduler scheduler(&service);
+    scheduler.setEntries(schedule);
+    QSignalSpy startedSpy(&scheduler, &MeterScheduler::entryStarted);
+    QSignalSpy readySpy(&scheduler, &MeterScheduler::readingReady);
+    scheduler.start();
+
+    // Readings from the previous mode are discarded.
+    scheduler.d_func()->readingRead(reading(MultimeterService::Mode::DcCurrent, +PokitMeter::CurrentRange::_150mA));
+    QCOMPARE(scheduler.staleCount(), (quint64)1);
+    QCOMPARE(startedSpy.size(), 0);
+    QCOMPARE(readySpy.size(), 0);
+
+    // The first reading of the current mode starts the entry.
+    scheduler.d_func()->readingRead(reading(MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V));
+    scheduler.d_func()->readingRead(reading(MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_6V));
+    QCOMPARE(startedSpy.size(), 1);
+    QCOMPARE(startedSpy.at(0).at(0).toInt(), 0);
+    QVERIFY(startedSpy.at(0).at(1).toLongLong() >= 0);
+    QCOMPARE(readySpy.size(), 2);
+    QCOMPARE(readySpy.at(1).at(0).value<MultimeterService::Reading>().range, +PokitMeter::VoltageRange::_6V);
+    QCOMPARE(readySpy.at(1).at(1).toInt(), 0);
+
+    // Then the next entry.
+    scheduler.d_func()->nextEntry();
+    scheduler.d_func()->readingRead(reading(MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_6V));
+    scheduler.d_func()->readingRead(reading(MultimeterService::Mode::DcCurrent, +PokitMeter::CurrentRange::_150mA));
+    QCOMPARE(scheduler.staleCount(), (quint64)2);
+    QCOMPARE(startedSpy.size(), 2);
+    QCOMPARE(startedSpy.at(1).at(0).toInt(), 1);
+    QCOMPARE(readySpy.size(), 3);
+    QCOMPARE(readySpy.at(2).at(1).toInt(), 1);
+}
+
+void TestMeterScheduler::readingRead_stopped()
+{
+    MultimeterService service(nullptr);
+    MeterScheduler scheduler(&service);
+    scheduler.setEntries(schedule);
+    QSignalSpy readySpy(&scheduler, &MeterScheduler::readingReady);
+    scheduler.d_func()->readingRead(reading(MultimeterService::Mode::DcVoltage, +PokitMeter::VoltageRange::_2V));
+    QCOMPARE(readySpy.size(), 0);
+    QCOMPARE(scheduler.staleCount(), (quint64)0);
+}
+
+void TestMeterScheduler::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    MeterScheduler scheduler(nullptr);
+    QVERIFY(!scheduler.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestMeterScheduler))
@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestMeterScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void service();
+    void entries();
+    void updateInterval();
+
+    void start();
+    void stop();
+
+    void isCurrent_data();
+    void isCurrent();
+
+    void nextEntry();
+
+    void readingRead();
+    void readingRead_stopped();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testmetersettler.h"
+
+#include <qtpokit/metersettler.h>
+#include "metersettler_p.h"
+
+#include <QSignalSpy>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(MultimeterService::Reading))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+MultimeterService::Reading reading(const quint8 range,
+    const MultimeterService::Mode mode = MultimeterService::Mode::DcVoltage)
+{
+    return { MultimeterService::MeterStatus::AutoRangeOn, 1.0f, mode, range };
+}
+
+}
+
+void TestMeterSettler::initTestCase()
+{
+    // Register the types used by MeterSettler's signals, so QSignalSpy can record their arguments.
+    qRegisterMetaType<MultimeterService::Reading>("MultimeterService::Reading");
+    qRegisterMetaType<qint64>("qint64");
+}
+
+void TestMeterSettler::service()
+{
+    MultimeterService service(nullptr);
+    MeterSettler settler(&service);
+    QCOMPARE(settler.service(), &service);
+
+    MultimeterService other(nullptr);
+    settler.d_func()->setService(&other);
+    QCOMPARE(settler.service(), &other);
+    QVERIFY(!QObject::disconnect(&service, nullptr, settler.d_func(), nullptr));
+}
+
+void TestMeterSettler::defaultSettleTime()
+{
+    MeterSettler settler(nullptr);
+    QCOMPARE(settler.defaultSettleTime(), 500u);
+    settler.setDefaultSettleTime(1000);
+    QCOMPARE(settler.defaultSettleTime(), 1000u);
+    QCOMPARE(settler.settleTime(MultimeterService::Mode::DcVoltage), 1000u);
+}
+
+void TestMeterSettler::settleTime()
+{
+    MeterSettler settler(nullptr);
+    settler.setSettleTime(MultimeterService::Mode::Resistance, 2000);
+    QCOMPARE(settler.settleTime(MultimeterService::Mode::Resistance), 2000u);
+    QCOMPARE(settler.settleTime(MultimeterService::Mode::DcVoltage), 500u);
+    settler.setDefaultSettleTime(100);
+    QCOMPARE(settler.settleTime(MultimeterService::Mode::Resistance), 2000u);
+    QCOMPARE(settler.settleTime(MultimeterService::Mode::DcVoltage), 100u);
+}
+
+void TestMeterSettler::addReading()
+{
+    MeterSettler settler(nullptr);
+    QSignalSpy settledSpy(&settler, &MeterSettler::readingSettled);
+    QSignalSpy unsettledSpy(&settler, &MeterSettler::readingUnsettled);
+    QVERIFY(settler.isSettled());
+
+    QVERIFY( settler.addReading(reading(1), 1000)); // The first reading is always settled.
+    QVERIFY( settler.addReading(reading(1), 1100));
+    QVERIFY(!settler.addReading(reading(2), 1200)); // Range transition.
+    QVERIFY(!settler.isSettled());
+    QVERIFY(!settler.addReading(reading(2), 1699));
+    QVERIFY( settler.addReading(reading(2), 1700)); // Settled.
+    QVERIFY( settler.isSettled());
+    QVERIFY( settler.addReading(reading(2), 1800));
+
+    QCOMPARE(settledSpy.size(), 4);
+    QCOMPARE(unsettledSpy.size(), 2);
+    QCOMPARE(unsettledSpy.at(0).at(0).value<MultimeterService::Reading>().range, (quint8)2);
+    QCOMPARE(unsettledSpy.at(0).at(1).toLongLong(), 1200);
+    QCOMPARE(settledSpy.at(2).at(1).toLongLong(), 1700);
+    QCOMPARE(settler.transitionCount(), (quint64)1);
+    QCOMPARE(settler.unsettledCount(), (quint64)2);
+}
+
+void TestMeterSettler::addReading_mode()
+{
+    // Mode transitions use the new mode's settle time.
+    MeterSettler settler(nullptr);
+    settler.setSettleTime(MultimeterService::Mode::Resistance, 2000);
+    QVERIFY( settler.addReading(reading(1), 0));
+    QVERIFY(!settler.addReading(reading(1, MultimeterService::Mode::Resistance), 1000));
+    QVERIFY(!settler.addReading(reading(1, MultimeterService::Mode::Resistance), 2999));
+    QVERIFY( settler.addReading(reading(1, MultimeterService::Mode::Resistance), 3000));
+    QVERIFY(!settler.addReading(reading(1), 4000));
+    QVERIFY( settler.addReading(reading(1), 4500));
+    QCOMPARE(settler.transitionCount(), (quint64)2);
+}
+
+void TestMeterSettler::addReading_retransition()
+{
+    // A transition before the previous transition has settled restarts the settle time.
+    MeterSettler settler(nullptr);
+    QVERIFY( settler.addReading(reading(1), 0));
+    QVERIFY(!settler.addReading(reading(2), 100));
+    QVERIFY(!settler.addReading(reading(3), 400));
+    QVERIFY(!settler.addReading(reading(3), 800));
+    QVERIFY( settler.addReading(reading(3), 900));
+    QCOMPARE(settler.transitionCount(), (quint64)2);
+    QCOMPARE(settler.unsettledCount(), (quint64)3);
+}
+
+void TestMeterSettler::addReading_disabled()
+{
+    MeterSettler settler(nullptr);
+    settler.setDefaultSettleTime(0);
+    QVERIFY(settler.addReading(reading(1), 0));
+    QVERIFY(settler.addReading(reading(2), 0));
+    QCOMPARE(settler.transitionCount(), (quint64)1);
+    QCOMPARE(settler.unsettledCount(), (quint64)0);
+}
+
+void TestMeterSettler::reset()
+{
+    MeterSettler settler(nullptr);
+    QVERIFY( settler.addReading(reading(1), 0));
+    QVERIFY(!settler.addReading(reading(2), 1));
+    settler.reset();
+    QVERIFY(settler.isSettled());
+    QCOMPARE(settler.transitionCount(), (quint64)0);
+    QCOMPARE(settler.unsettledCount(), (quint64)0);
+    QVERIFY( settler.addReading(reading(3), 2)); // No longer a transition, since the last reading was forgotten.
+}
+
+void TestMeterSettler::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    MeterSettler settler(nullptr);
+    QVERIFY(!settler.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestMeterSettler))
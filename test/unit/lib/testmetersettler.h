@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestMeterSettler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void service();
+    void defaultSettleTime();
+    void settleTime();
+
+    void addReading();
+    void addReading_mode();
+    void addReading_retransition();
+    void addReading_disabled();
+
+    void reset();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -10,6 +10,7 @@
 #include "multimeterservice_p.h"
 
 #include <QRegularExpression>
+#include <QSignalSpy>
 
 Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(MultimeterService::Mode))
 Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(MultimeterService::Settings))
@@ -161,6 +162,9 @@ void TestMultimeterService::setSettings()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     MultimeterService service(nullptr);
     QVERIFY(!service.setSettings({}));
+    const QFuture<bool> future = service.setSettingsAsync({});
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestMultimeterService::reading()
@@ -168,6 +172,15 @@ void TestMultimeterService::reading()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     MultimeterService service(nullptr);
     QVERIFY(qIsNaN(service.reading().value));
+
+    // Parsed readings are then returned from the latest value cell.
+    service.d_func()->emitReading(QByteArray("\x01\x00\x00\xc0\x3f\x01\x02", 7));
+    const MultimeterService::Reading reading = service.reading();
+    QCOMPARE(reading.status, MultimeterService::MeterStatus::AutoRangeOn);
+    QCOMPARE(reading.value, 1.5f);
+    QCOMPARE(reading.mode, MultimeterService::Mode::DcVoltage);
+    QCOMPARE(reading.range, (quint8)2);
+    QCOMPARE(service.d_func()->latestReading.storeCount(), (quint64)1);
 }
 
 void TestMultimeterService::enableReadingNotifications()
@@ -175,6 +188,9 @@ void TestMultimeterService::enableReadingNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     MultimeterService service(nullptr);
     QVERIFY(!service.enableReadingNotifications());
+    const QFuture<bool> future = service.enableReadingNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestMultimeterService::disableReadingNotifications()
@@ -182,6 +198,123 @@ void TestMultimeterService::disableReadingNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     MultimeterService service(nullptr);
     QVERIFY(!service.disableReadingNotifications());
+    const QFuture<bool> future = service.disableReadingNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
+}
+
+void TestMultimeterService::readingsBuffer()
+{
+    MultimeterService service(nullptr);
+    QCOMPARE(service.readingsBuffer(), nullptr);
+
+    RingBuffer<MultimeterService::Reading> buffer(2);
+    service.setReadingsBuffer(&buffer);
+    QCOMPARE(service.readingsBuffer(), &buffer);
+
+    // Parsed readings should be pushed into the buffer, as well as emitted.
+    service.d_func()->emitReading(QByteArray("\x00\x00\x00\x80\x3f\x01\x03", 7));
+    MultimeterService::Reading reading{ MultimeterService::MeterStatus::Error, 0.0f, MultimeterService::Mode::Idle, 0 };
+    QVERIFY(buffer.pop(reading));
+    QCOMPARE(reading.status, MultimeterService::MeterStatus::AutoRangeOff);
+    QCOMPARE(reading.value, 1.0f);
+    QCOMPARE(reading.mode, MultimeterService::Mode::DcVoltage);
+    QCOMPARE(reading.range, (quint8)3);
+    QVERIFY(buffer.isEmpty());
+
+    service.setReadingsBuffer(nullptr);
+    QCOMPARE(service.readingsBuffer(), nullptr);
+    service.d_func()->emitReading(QByteArray("\x00\x00\x00\x80\x3f\x01\x03", 7));
+    QVERIFY(buffer.isEmpty());
+}
+
+void TestMultimeterService::readingsBatchRead()
+{
+    // Register the type used by readingsBatchRead, so QSignalSpy can record its arguments.
+    qRegisterMetaType<QVector<MultimeterService::Reading>>("QVector<MultimeterService::Reading>");
+
+    MultimeterService service(nullptr);
+    QSignalSpy batchSpy(&service, &MultimeterService::readingsBatchRead);
+    const QByteArray value("\x00\x00\x00\x80\x3f\x01\x03", 7);
+
+    // Batches of however many readings arrive within 10ms.
+    service.setBatching({ 0, 10'000 });
+    for (int count = 0; count < 5; ++count) {
+        service.d_func()->emitReading(value);
+    }
+    QCOMPARE(batchSpy.count(), 0);
+    QVERIFY(batchSpy.wait()); // Emitted by the batch timer, even though no more readings arrive.
+    QCOMPARE(batchSpy.count(), 1);
+    const auto readings = qvariant_cast<QVector<MultimeterService::Reading>>(batchSpy.at(0).at(0));
+    QCOMPARE(readings.size(), 5);
+    QCOMPARE(readings.last().value, 1.0f);
+    QCOMPARE(readings.last().range, (quint8)3);
+
+    // No batches are emitted without readings.
+    QVERIFY(!batchSpy.wait(50));
+    QCOMPARE(batchSpy.count(), 1);
+}
+
+void TestMultimeterService::startBurst()
+{
+    // Register the type used by burstCompleted, so QSignalSpy can record its arguments.
+    qRegisterMetaType<QVector<MultimeterService::TimedReading>>("QVector<MultimeterService::TimedReading>");
+
+    MultimeterService service(nullptr);
+    QSignalSpy readingSpy(&service, &MultimeterService::readingRead);
+    QSignalSpy burstSpy(&service, &MultimeterService::burstCompleted);
+    QVERIFY(!service.isBursting());
+    QVERIFY(!service.startBurst(0));
+    QVERIFY(!service.isBursting());
+
+    RingBuffer<MultimeterService::Reading> buffer(4);
+    service.setReadingsBuffer(&buffer);
+    QVERIFY(service.startBurst(3));
+    QVERIFY(service.isBursting());
+    QVERIFY(service.d_func()->burst.capacity() >= 3); // Preallocated.
+
+    // Readings are only recorded (not emitted, nor buffered) until the burst is complete.
+    const qint64 start = AbstractPokitServicePrivate::steadyTimestamp();
+    service.d_func()->emitReading(QByteArray("\x00\x00\x00\x80\x3f\x01\x03", 7));
+    service.d_func()->emitReading(QByteArray("\x00\x00\x00\x00\x40\x01\x03", 7));
+    QCOMPARE(burstSpy.count(), 0);
+    QCOMPARE(service.reading().value, 2.0f); // Still kept up to date.
+    service.d_func()->emitReading(QByteArray("\x00\x00\x00\x80\x3f\x01\x03", 7));
+    QCOMPARE(readingSpy.count(), 0);
+    QVERIFY(buffer.isEmpty());
+    QVERIFY(!service.isBursting());
+    QCOMPARE(burstSpy.count(), 1);
+    const auto readings = qvariant_cast<QVector<MultimeterService::TimedReading>>(burstSpy.at(0).at(0));
+    QCOMPARE(readings.size(), 3);
+    QCOMPARE(readings.at(0).reading.value, 1.0f);
+    QCOMPARE(readings.at(1).reading.value, 2.0f);
+    QCOMPARE(readings.at(2).reading.mode, MultimeterService::Mode::DcVoltage);
+    QVERIFY(readings.at(0).timestamp >= start);
+    QVERIFY(readings.at(1).timestamp >= readings.at(0).timestamp);
+    QVERIFY(readings.at(2).timestamp >= readings.at(1).timestamp);
+
+    // Once complete, readings are emitted as usual again.
+    service.d_func()->emitReading(QByteArray("\x00\x00\x00\x80\x3f\x01\x03", 7));
+    QCOMPARE(readingSpy.count(), 1);
+    QCOMPARE(burstSpy.count(), 1);
+    QVERIFY(!buffer.isEmpty());
+}
+
+void TestMultimeterService::cancelBurst()
+{
+    MultimeterService service(nullptr);
+    QSignalSpy burstSpy(&service, &MultimeterService::burstCompleted);
+    QVERIFY(service.cancelBurst().isEmpty()); // No burst in progress.
+
+    QVERIFY(service.startBurst(10));
+    service.d_func()->emitReading(QByteArray("\x00\x00\x00\x80\x3f\x01\x03", 7));
+    service.d_func()->emitReading(QByteArray("\x00\x00\x00\x00\x40\x01\x03", 7));
+    const QVector<MultimeterService::TimedReading> readings = service.cancelBurst();
+    QVERIFY(!service.isBursting());
+    QCOMPARE(readings.size(), 2);
+    QCOMPARE(readings.at(1).reading.value, 2.0f);
+    QCOMPARE(burstSpy.count(), 0);
+    QVERIFY(service.cancelBurst().isEmpty()); // Already cancelled.
 }
 
 void TestMultimeterService::encodeSettings_data()
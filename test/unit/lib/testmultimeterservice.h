@@ -30,6 +30,12 @@ private slots:
     void enableReadingNotifications();
     void disableReadingNotifications();
 
+    void readingsBuffer();
+    void readingsBatchRead();
+
+    void startBurst();
+    void cancelBurst();
+
     void encodeSettings_data();
     void encodeSettings();
 
@@ -0,0 +1,276 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testpokitcodec.h"
+
+#include <pokitcodec/pokitcodec.h>
+#include "characteristiclayout_p.h"
+
+#include <limits>
+
+Q_DECLARE_METATYPE(std::optional<quint8>)
+
+QTPOKIT_BEGIN_NAMESPACE
+
+using CharacteristicLayout::toByteArray;
+using CharacteristicLayout::toByteSpan;
+
+void TestPokitCodec::fromLittleEndian()
+{
+    const QByteArray value = QByteArray::fromHex("78563412" "feff" "0000c03f" "efcdab9078563412");
+    const char * const data = value.constData();
+    QCOMPARE(PokitCodec::fromLittleEndian<quint8>(data), (quint8)0x78);
+    QCOMPARE(PokitCodec::fromLittleEndian<quint32>(data), (quint32)0x12345678);
+    QCOMPARE(PokitCodec::fromLittleEndian<qint16>(data + 4), (qint16)-2);
+    QCOMPARE(PokitCodec::fromLittleEndian<float>(data + 6), 1.5f);
+    QCOMPARE(PokitCodec::fromLittleEndian<quint64>(data + 10), (quint64)0x1234567890abcdef);
+
+    // Bytes may be std::byte, as well as char.
+    const std::byte * const bytes = reinterpret_cast<const std::byte *>(data);
+    QCOMPARE(PokitCodec::fromLittleEndian<quint32>(bytes), (quint32)0x12345678);
+}
+
+void TestPokitCodec::toLittleEndian()
+{
+    std::array<std::byte, 18> buffer{};
+    PokitCodec::toLittleEndian((quint32)0x12345678, buffer.data());
+    PokitCodec::toLittleEndian((qint16)-2, buffer.data() + 4);
+    PokitCodec::toLittleEndian(1.5f, buffer.data() + 6);
+    PokitCodec::toLittleEndian((quint64)0x1234567890abcdef, buffer.data() + 10);
+    QCOMPARE(toByteArray(buffer.data(), buffer.size()),
+             QByteArray::fromHex("78563412" "feff" "0000c03f" "efcdab9078563412"));
+}
+
+void TestPokitCodec::decodeSamples_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addColumn<bool>("expected");
+    QTest::addColumn<QVector<qint16>>("samples");
+    QTest::addRow("empty") << QByteArray() << true << QVector<qint16>{ };
+    QTest::addRow("one") << QByteArray::fromHex("feff") << true << QVector<qint16>{ -2 };
+    QTest::addRow("three") << QByteArray::fromHex("feff" "0100" "0080") << true
+        << QVector<qint16>{ -2, 1, std::numeric_limits<qint16>::min() };
+    QTest::addRow("odd") << QByteArray::fromHex("feff01") << false << QVector<qint16>{ 123 }; // Left untouched.
+}
+
+void TestPokitCodec::decodeSamples()
+{
+    QFETCH(QByteArray, value);
+    QFETCH(bool, expected);
+    QFETCH(QVector<qint16>, samples);
+    QVector<qint16> actual(samples.size(), 123);
+    QCOMPARE(PokitCodec::decodeSamples(toByteSpan(value), actual.data()), expected);
+    QCOMPARE(actual, samples);
+}
+
+void TestPokitCodec::encodeTemperature()
+{
+    std::array<std::byte, PokitCodec::Calibration::temperatureSize> buffer{};
+    QCOMPARE(PokitCodec::Calibration::encodeTemperature(-123456.0f, buffer), buffer.size());
+    QCOMPARE(toByteArray(buffer.data(), buffer.size()), QByteArray("\x00\x20\xf1\xc7", 4));
+
+    // Buffers that are too small are left untouched.
+    std::array<std::byte, 3> small{};
+    QCOMPARE(PokitCodec::Calibration::encodeTemperature(1.0f, small), (std::size_t)0);
+    QCOMPARE(toByteArray(small.data(), small.size()), QByteArray(3, '\0'));
+}
+
+void TestPokitCodec::encodeDataLoggerSettings()
+{
+    const PokitCodec::DataLogger::Settings settings{ 1, 0x1234, 2, 3, 1500, 0x12345678 };
+    std::array<std::byte, PokitCodec::DataLogger::proSettingsSize> buffer{};
+
+    // Pokit Meter devices take the update interval in (rounded) seconds.
+    QCOMPARE(PokitCodec::DataLogger::encodeSettings(settings, false, buffer),
+             PokitCodec::DataLogger::meterSettingsSize);
+    QCOMPARE(toByteArray(buffer.data(), PokitCodec::DataLogger::meterSettingsSize),
+             QByteArray::fromHex("01" "3412" "02" "03" "0200" "78563412"));
+
+    // Pokit Pro devices take the update interval in milliseconds.
+    QCOMPARE(PokitCodec::DataLogger::encodeSettings(settings, true, buffer),
+             PokitCodec::DataLogger::proSettingsSize);
+    QCOMPARE(toByteArray(buffer.data(), buffer.size()),
+             QByteArray::fromHex("01" "3412" "02" "03" "dc050000" "78563412"));
+
+    // Pokit Meter settings fit in a smaller buffer than Pokit Pro settings.
+    std::array<std::byte, PokitCodec::DataLogger::meterSettingsSize> small{};
+    QCOMPARE(PokitCodec::DataLogger::encodeSettings(settings, true, small), (std::size_t)0);
+    QCOMPARE(PokitCodec::DataLogger::encodeSettings(settings, false, small), small.size());
+}
+
+void TestPokitCodec::parseDataLoggerMetadata_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addColumn<bool>("expected");
+    QTest::addColumn<float>("scale");
+    QTest::addColumn<quint8>("range");
+    QTest::addColumn<quint32>("updateInterval");
+    QTest::addColumn<quint16>("numberOfSamples");
+    QTest::addColumn<quint32>("timestamp");
+
+    // Sample from a real Pokit Meter device.
+    const QByteArray meter("\x00\x9f\x0f\x49\x37\x00\x04\x3c\x00\x00\x00\xe9\xbb\x8c\x62", 15);
+    QTest::addRow("PokitMeter") << meter << true << 1.198417067e-05f << (quint8)4
+        << (quint32)60000 << (quint16)0 << (quint32)1653390313;
+
+    // Sample from a real Pokit Pro device.
+    const QByteArray pro("\x00\x39\xf0\x45\x3c\x00\x04\x60\xea\x00\x00\x0d"
+                         "\x00\x00\x00\x30\x38\x00\x00\x43\xb9\x8c\x62", 23);
+    QTest::addRow("PokitPro") << pro << true << 0.01208119933f << (quint8)4
+        << (quint32)60000 << (quint16)13 << (quint32)1653389635;
+
+    // Neither layout, so only the common fields are decoded (the rest are left as initialised).
+    QTest::addRow("extended") << (pro + QByteArray(3, '\x01')) << false << 0.01208119933f << (quint8)4
+        << (quint32)0 << (quint16)0 << (quint32)0;
+
+    // Too short to decode at all.
+    QTest::addRow("too-small") << meter.left(14) << false << 0.0f << (quint8)0
+        << (quint32)0 << (quint16)0 << (quint32)0;
+}
+
+void TestPokitCodec::parseDataLoggerMetadata()
+{
+    QFETCH(QByteArray, value);
+    QFETCH(bool, expected);
+    QFETCH(float, scale);
+    QFETCH(quint8, range);
+    QFETCH(quint32, updateInterval);
+    QFETCH(quint16, numberOfSamples);
+    QFETCH(quint32, timestamp);
+    PokitCodec::DataLogger::Metadata metadata{};
+    QCOMPARE(PokitCodec::DataLogger::parseMetadata(toByteSpan(value), metadata), expected);
+    QCOMPARE(metadata.status, (quint8)0);
+    QCOMPARE(metadata.scale, scale);
+    QCOMPARE(metadata.mode, (quint8)0);
+    QCOMPARE(metadata.range, range);
+    QCOMPARE(metadata.updateInterval, updateInterval);
+    QCOMPARE(metadata.numberOfSamples, numberOfSamples);
+    QCOMPARE(metadata.timestamp, timestamp);
+}
+
+void TestPokitCodec::encodeDsoSettings()
+{
+    std::array<std::byte, PokitCodec::Dso::settingsSize> buffer{};
+    QCOMPARE(PokitCodec::Dso::encodeSettings({ 1, 1.5f, 2, 3, 0x12345678, 0x1000 }, buffer), buffer.size());
+    QCOMPARE(toByteArray(buffer.data(), buffer.size()),
+             QByteArray::fromHex("01" "0000c03f" "02" "03" "78563412" "0010"));
+
+    std::array<std::byte, PokitCodec::Dso::settingsSize - 1> small{};
+    QCOMPARE(PokitCodec::Dso::encodeSettings({ 1, 1.5f, 2, 3, 0x12345678, 0x1000 }, small), (std::size_t)0);
+}
+
+void TestPokitCodec::parseDsoMetadata()
+{
+    const QByteArray value = QByteArray::fromHex("01" "0000c03f" "02" "03" "e8030000" "6400" "40420f00");
+    QCOMPARE((std::size_t)value.size(), PokitCodec::Dso::metadataSize);
+    PokitCodec::Dso::Metadata metadata{};
+    QVERIFY(PokitCodec::Dso::parseMetadata(toByteSpan(value), metadata));
+    QCOMPARE(metadata.status, (quint8)1);
+    QCOMPARE(metadata.scale, 1.5f);
+    QCOMPARE(metadata.mode, (quint8)2);
+    QCOMPARE(metadata.range, (quint8)3);
+    QCOMPARE(metadata.samplingWindow, (quint32)1000);
+    QCOMPARE(metadata.numberOfSamples, (quint16)100);
+    QCOMPARE(metadata.samplingRate, (quint32)1000000);
+
+    // Too short, so left untouched.
+    PokitCodec::Dso::Metadata untouched{};
+    QVERIFY(!PokitCodec::Dso::parseMetadata(toByteSpan(value.left(16)), untouched));
+    QCOMPARE(untouched.samplingRate, (quint32)0);
+}
+
+void TestPokitCodec::encodeMultimeterSettings()
+{
+    std::array<std::byte, PokitCodec::Multimeter::settingsSize> buffer{};
+    QCOMPARE(PokitCodec::Multimeter::encodeSettings({ 2, 3, 1000 }, buffer), buffer.size());
+    QCOMPARE(toByteArray(buffer.data(), buffer.size()), QByteArray::fromHex("02" "03" "e8030000"));
+
+    std::array<std::byte, PokitCodec::Multimeter::settingsSize - 1> small{};
+    QCOMPARE(PokitCodec::Multimeter::encodeSettings({ 2, 3, 1000 }, small), (std::size_t)0);
+}
+
+void TestPokitCodec::parseReading()
+{
+    const QByteArray value = QByteArray::fromHex("01" "0000c03f" "02" "03");
+    PokitCodec::Multimeter::Reading reading{};
+    QVERIFY(PokitCodec::Multimeter::parseReading(toByteSpan(value), reading));
+    QCOMPARE(reading.status, (quint8)1);
+    QCOMPARE(reading.value, 1.5f);
+    QCOMPARE(reading.mode, (quint8)2);
+    QCOMPARE(reading.range, (quint8)3);
+
+    // Trailing bytes are ignored.
+    PokitCodec::Multimeter::Reading extended{};
+    QVERIFY(PokitCodec::Multimeter::parseReading(toByteSpan(value + QByteArray(2, '\xff')), extended));
+    QCOMPARE(extended.range, (quint8)3);
+
+    // Too short, so left untouched.
+    PokitCodec::Multimeter::Reading untouched{};
+    QVERIFY(!PokitCodec::Multimeter::parseReading(toByteSpan(value.left(6)), untouched));
+    QCOMPARE(untouched.value, 0.0f);
+}
+
+void TestPokitCodec::parseDeviceCharacteristics()
+{
+    // Sample from a real Pokit Meter device.
+    const QByteArray value("\x01\x04\x3c\x00\x02\x00\xe8\x03\xe8\x03"
+                           "\x00\x20\x00\x00\x84\x2e\x14\x2c\x03\xa8", 20);
+    PokitCodec::Status::DeviceCharacteristics characteristics{};
+    QVERIFY(PokitCodec::Status::parseDeviceCharacteristics(toByteSpan(value), characteristics));
+    QCOMPARE(characteristics.firmwareMajor, (quint8)1);
+    QCOMPARE(characteristics.firmwareMinor, (quint8)4);
+    QCOMPARE(characteristics.maximumVoltage, (quint16)60);
+    QCOMPARE(characteristics.maximumCurrent, (quint16)2);
+    QCOMPARE(characteristics.maximumResistance, (quint16)1000);
+    QCOMPARE(characteristics.maximumSamplingRate, (quint16)1000);
+    QCOMPARE(characteristics.samplingBufferSize, (quint16)8192);
+    QCOMPARE(characteristics.capabilityMask, (quint16)0);
+    QCOMPARE(characteristics.macAddress, (quint64)0x842E142C03A8); // Big-endian.
+
+    PokitCodec::Status::DeviceCharacteristics untouched{};
+    QVERIFY(!PokitCodec::Status::parseDeviceCharacteristics(toByteSpan(value.left(19)), untouched));
+    QCOMPARE(untouched.macAddress, (quint64)0);
+}
+
+void TestPokitCodec::parseStatus_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addColumn<bool>("expected");
+    QTest::addColumn<std::optional<quint8>>("batteryStatus");
+    QTest::addColumn<std::optional<quint8>>("switchPosition");
+    QTest::addColumn<std::optional<quint8>>("chargingStatus");
+
+    const QByteArray common = QByteArray::fromHex("02" "00006040"); // Pokit API 0.02.
+    QTest::addRow("too-small") << common.left(4) << false
+        << std::optional<quint8>() << std::optional<quint8>() << std::optional<quint8>();
+    QTest::addRow("5-bytes") << common << true
+        << std::optional<quint8>() << std::optional<quint8>() << std::optional<quint8>();
+    QTest::addRow("6-bytes") << common + QByteArray::fromHex("01") << true // Pokit API 1.00.
+        << std::optional<quint8>(1) << std::optional<quint8>() << std::optional<quint8>();
+    QTest::addRow("8-bytes") << common + QByteArray::fromHex("010203") << true // Pokit Pro.
+        << std::optional<quint8>(1) << std::optional<quint8>(2) << std::optional<quint8>(3);
+}
+
+void TestPokitCodec::parseStatus()
+{
+    QFETCH(QByteArray, value);
+    QFETCH(bool, expected);
+    QFETCH(std::optional<quint8>, batteryStatus);
+    QFETCH(std::optional<quint8>, switchPosition);
+    QFETCH(std::optional<quint8>, chargingStatus);
+    PokitCodec::Status::Status status{ 0, 0.0f, 0xFF, 0xFF, 0xFF }; // Optionals reset, if parsed.
+    QCOMPARE(PokitCodec::Status::parseStatus(toByteSpan(value), status), expected);
+    if (expected) {
+        QCOMPARE(status.deviceStatus, (quint8)2);
+        QCOMPARE(status.batteryVoltage, 3.5f);
+        QCOMPARE(status.batteryStatus, batteryStatus);
+        QCOMPARE(status.switchPosition, switchPosition);
+        QCOMPARE(status.chargingStatus, chargingStatus);
+    } else {
+        QCOMPARE(status.batteryStatus, std::optional<quint8>(0xFF)); // Left untouched.
+    }
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestPokitCodec))
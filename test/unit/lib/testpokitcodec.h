@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestPokitCodec : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fromLittleEndian();
+    void toLittleEndian();
+
+    void decodeSamples_data();
+    void decodeSamples();
+
+    void encodeTemperature();
+
+    void encodeDataLoggerSettings();
+    void parseDataLoggerMetadata_data();
+    void parseDataLoggerMetadata();
+
+    void encodeDsoSettings();
+    void parseDsoMetadata();
+
+    void encodeMultimeterSettings();
+    void parseReading();
+
+    void parseDeviceCharacteristics();
+    void parseStatus_data();
+    void parseStatus();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,434 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testpokitconnectionmanager.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/pokitconnectionmanager.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitdeviceregistry.h>
+#include "pokitconnectionmanager_p.h"
+
+#include <QSignalSpy>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+QBluetoothDeviceInfo deviceInfo(const QString &address)
+{
+    return QBluetoothDeviceInfo(QBluetoothAddress(address), u"Pokit"_s, 0);
+}
+
+// Pools a (device-less) connection, that is already connected and discovered, so no Bluetooth hardware is needed.
+void addConnection(PokitConnectionManager &manager, const QString &address, const quint32 ticket = 0,
+                   const qint64 since = 0, const QBluetoothAddress &adapter = QBluetoothAddress())
+{
+    PokitConnectionManagerPrivate::Connection connection;
+    connection.ready = true;
+    connection.ticket = ticket;
+    connection.leasedAt = since;
+    connection.idleSince = since;
+    connection.adapter = adapter;
+    manager.d_func()->connections.insert(PokitDeviceRegistry::key(deviceInfo(address)), connection);
+}
+
+}
+
+void TestPokitConnectionManager::maxConnections()
+{
+    PokitConnectionManager manager;
+    QCOMPARE(manager.maxConnections(), 3);
+    manager.setMaxConnections(5);
+    QCOMPARE(manager.maxConnections(), 5);
+    QCOMPARE(manager.maxConnections(QBluetoothAddress()), 5);
+    manager.setMaxConnections(0);
+    QCOMPARE(manager.maxConnections(), 1);
+}
+
+void TestPokitConnectionManager::maxConnections_adapter()
+{
+    PokitConnectionManager manager;
+    const QBluetoothAddress adapter(u"11:22:33:44:55:66"_s);
+    QCOMPARE(manager.maxConnections(adapter), 3);
+    manager.setMaxConnections(adapter, 7);
+    QCOMPARE(manager.maxConnections(adapter), 7);
+    QCOMPARE(manager.maxConnections(QBluetoothAddress()), 3);
+    QCOMPARE(manager.maxConnections(), 3);
+    manager.setMaxConnections(adapter, 0);
+    QCOMPARE(manager.maxConnections(adapter), 3);
+}
+
+void TestPokitConnectionManager::idleTimeout()
+{
+    PokitConnectionManager manager;
+    QCOMPARE(manager.idleTimeout(), (quint32)30000);
+    manager.setIdleTimeout(1234);
+    QCOMPARE(manager.idleTimeout(), (quint32)1234);
+}
+
+void TestPokitConnectionManager::leaseTimeout()
+{
+    PokitConnectionManager manager;
+    QCOMPARE(manager.leaseTimeout(), (quint32)0);
+    manager.setLeaseTimeout(5678);
+    QCOMPARE(manager.leaseTimeout(), (quint32)5678);
+}
+
+void TestPokitConnectionManager::adapters()
+{
+    PokitConnectionManager manager;
+    QVERIFY(manager.adapters().isEmpty());
+    const QList<QBluetoothAddress> adapters{
+        QBluetoothAddress(u"11:11:11:11:11:11"_s), QBluetoothAddress(u"22:22:22:22:22:22"_s) };
+    manager.setAdapters(adapters);
+    QCOMPARE(manager.adapters(), adapters);
+    manager.setAdapters({});
+    QVERIFY(manager.adapters().isEmpty());
+}
+
+void TestPokitConnectionManager::request_warm()
+{
+    PokitConnectionManager manager;
+    addConnection(manager, u"00:00:00:00:00:01"_s);
+    QSignalSpy spy(&manager, &PokitConnectionManager::granted);
+    const quint32 ticket = manager.request(deviceInfo(u"00:00:00:00:00:01"_s));
+    QCOMPARE(ticket, (quint32)1);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<quint32>(), ticket);
+    QCOMPARE(manager.pendingCount(), 0);
+    QCOMPARE(manager.connectionCount(), 1);
+    QCOMPARE(manager.d_func()->findTicket(ticket), PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:01"_s)));
+}
+
+void TestPokitConnectionManager::request_queued()
+{
+    PokitConnectionManager manager;
+    manager.setMaxConnections(2);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101);
+    addConnection(manager, u"00:00:00:00:00:02"_s, 102);
+    QSignalSpy spy(&manager, &PokitConnectionManager::granted);
+    const quint32 ticket = manager.request(deviceInfo(u"00:00:00:00:00:03"_s));
+    QCOMPARE(spy.count(), 0);
+    QCOMPARE(manager.pendingCount(), 1);
+    QCOMPARE(manager.connectionCount(), 2);
+    QVERIFY(manager.device(ticket) == nullptr);
+}
+
+void TestPokitConnectionManager::request_busy()
+{
+    PokitConnectionManager manager;
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101);
+    QSignalSpy spy(&manager, &PokitConnectionManager::granted);
+    const quint32 ticket = manager.request(deviceInfo(u"00:00:00:00:00:01"_s));
+    QCOMPARE(spy.count(), 0); // Already leased to ticket 101.
+    QCOMPARE(manager.pendingCount(), 1);
+
+    QVERIFY(manager.release(101));
+    QCOMPARE(spy.count(), 1); // The same (warm) connection is now leased to the second request.
+    QCOMPARE(spy.at(0).at(0).value<quint32>(), ticket);
+    QCOMPARE(manager.pendingCount(), 0);
+    QCOMPARE(manager.connectionCount(), 1);
+}
+
+void TestPokitConnectionManager::release_pending()
+{
+    PokitConnectionManager manager;
+    manager.setMaxConnections(1);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101);
+    const quint32 ticket = manager.request(deviceInfo(u"00:00:00:00:00:02"_s));
+    QCOMPARE(manager.pendingCount(), 1);
+    QVERIFY(manager.release(ticket));
+    QCOMPARE(manager.pendingCount(), 0);
+    QVERIFY(!manager.release(ticket));
+}
+
+void TestPokitConnectionManager::release_leased()
+{
+    PokitConnectionManager manager;
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101);
+    QVERIFY(manager.release(101));
+    QCOMPARE(manager.connectionCount(), 1); // Kept connected, for reuse.
+    const PokitConnectionManagerPrivate::Connection connection = manager.d_func()->connections.cbegin().value();
+    QCOMPARE(connection.ticket, (quint32)0);
+    QVERIFY(manager.d_func()->findTicket(101).isNull());
+    QVERIFY(!manager.release(101));
+}
+
+void TestPokitConnectionManager::release_noIdle()
+{
+    PokitConnectionManager manager;
+    manager.setIdleTimeout(0);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101);
+    QVERIFY(manager.release(101));
+    QCOMPARE(manager.connectionCount(), 0);
+}
+
+void TestPokitConnectionManager::release_invalid()
+{
+    PokitConnectionManager manager;
+    QVERIFY(!manager.release(0));
+    QVERIFY(!manager.release(123));
+    QVERIFY(manager.device(123) == nullptr);
+}
+
+void TestPokitConnectionManager::disconnectIdle()
+{
+    PokitConnectionManager manager;
+    addConnection(manager, u"00:00:00:00:00:01"_s, 0, 100);
+    addConnection(manager, u"00:00:00:00:00:02"_s, 102, 100); // Leased, so not disconnected.
+    QVERIFY(!manager.disconnectIdle(deviceInfo(u"00:00:00:00:00:03"_s))); // Not connected at all.
+    QVERIFY(!manager.disconnectIdle(deviceInfo(u"00:00:00:00:00:02"_s)));
+    QVERIFY(manager.disconnectIdle(deviceInfo(u"00:00:00:00:00:01"_s)));
+    QCOMPARE(manager.connectionCount(), 1);
+    QVERIFY(!manager.disconnectIdle(deviceInfo(u"00:00:00:00:00:01"_s)));
+    QCOMPARE(manager.d_func()->findTicket(102), PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:02"_s)));
+}
+
+void TestPokitConnectionManager::prewarm_warm()
+{
+    PokitConnectionManager manager;
+    addConnection(manager, u"00:00:00:00:00:01"_s, 0, -1000);
+    addConnection(manager, u"00:00:00:00:00:02"_s, 102, -1000);
+    QVERIFY(manager.prewarm(deviceInfo(u"00:00:00:00:00:01"_s)));
+    QVERIFY(manager.prewarm(deviceInfo(u"00:00:00:00:00:02"_s)));
+    QCOMPARE(manager.connectionCount(), 2);
+
+    // The idle connection's idle time restarts, while the leased connection is left as-is.
+    const auto * const d = manager.d_func();
+    QVERIFY(d->connections.value(PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:01"_s))).idleSince >= 0);
+    QCOMPARE(d->connections.value(PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:02"_s))).idleSince,
+             (qint64)-1000);
+}
+
+void TestPokitConnectionManager::prewarm_full()
+{
+    PokitConnectionManager manager;
+    manager.setMaxConnections(2);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101);
+    addConnection(manager, u"00:00:00:00:00:02"_s); // Idle, but never evicted for pre-warming.
+    QVERIFY(!manager.prewarm(deviceInfo(u"00:00:00:00:00:03"_s)));
+    QCOMPARE(manager.connectionCount(), 2);
+    QVERIFY(manager.d_func()->connections.contains(PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:02"_s))));
+}
+
+void TestPokitConnectionManager::prewarm_requested()
+{
+    // A connection that is still being pre-warmed is taken by the next request, and granted once discovered.
+    PokitConnectionManager manager;
+    addConnection(manager, u"00:00:00:00:00:01"_s);
+    const QString key = PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:01"_s));
+    auto * const d = manager.d_func();
+    d->connections[key].ready = false;
+    QSignalSpy spy(&manager, &PokitConnectionManager::granted);
+    const quint32 ticket = manager.request(deviceInfo(u"00:00:00:00:00:01"_s));
+    QCOMPARE(spy.count(), 0);
+    QCOMPARE(manager.pendingCount(), 0);
+    QCOMPARE(d->findTicket(ticket), key);
+
+    d->discoveryFinished(key);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<quint32>(), ticket);
+}
+
+void TestPokitConnectionManager::prewarm_unrequested()
+{
+    // A pre-warmed connection, not yet requested, is kept warm once discovered, as if just released.
+    PokitConnectionManager manager;
+    manager.setIdleTimeout(100);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 0, -1000);
+    const QString key = PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:01"_s));
+    auto * const d = manager.d_func();
+    d->connections[key].ready = false;
+    QSignalSpy spy(&manager, &PokitConnectionManager::granted);
+    d->discoveryFinished(key);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(d->connections.value(key).ready);
+    const qint64 idleSince = d->connections.value(key).idleSince;
+    QVERIFY(idleSince >= 0);
+
+    d->housekeeping(idleSince + 99);
+    QCOMPARE(manager.connectionCount(), 1);
+    d->housekeeping(idleSince + 100);
+    QCOMPARE(manager.connectionCount(), 0);
+}
+
+void TestPokitConnectionManager::schedulingOrder()
+{
+    PokitConnectionManager manager;
+    auto * const d = manager.d_func();
+    for (const QString &address: { u"00:00:00:00:00:01"_s, u"00:00:00:00:00:02"_s, u"00:00:00:00:00:03"_s,
+                                   u"00:00:00:00:00:04"_s }) {
+        const QBluetoothDeviceInfo info = deviceInfo(address);
+        d->pending.append({ d->nextTicket++, PokitDeviceRegistry::key(info), info, QBluetoothAddress() });
+    }
+    d->lastGranted.insert(d->pending.at(0).key, 500);
+    d->lastGranted.insert(d->pending.at(2).key, 200);
+    // Never granted devices first (in request order), then least recently granted.
+    QCOMPARE(d->schedulingOrder(), QVector<int>({ 1, 3, 2, 0 }));
+}
+
+void TestPokitConnectionManager::updateRssi()
+{
+    PokitConnectionManager manager;
+    const QBluetoothAddress adapter1(u"11:11:11:11:11:11"_s), adapter2(u"22:22:22:22:22:22"_s);
+    QBluetoothDeviceInfo info = deviceInfo(u"00:00:00:00:00:01"_s);
+    info.setRssi(-70);
+    manager.updateRssi(info, adapter1);
+    info.setRssi(-50);
+    manager.updateRssi(info, adapter2);
+    info.setRssi(0); // Unknown, so ignored.
+    manager.updateRssi(info, adapter2);
+    const QHash<quint64, qint16> rssi = manager.d_func()->rssi.value(PokitDeviceRegistry::key(info));
+    QCOMPARE(rssi.size(), 2);
+    QCOMPARE(rssi.value(adapter1.toUInt64()), (qint16)-70);
+    QCOMPARE(rssi.value(adapter2.toUInt64()), (qint16)-50);
+}
+
+void TestPokitConnectionManager::chooseAdapter_load()
+{
+    PokitConnectionManager manager;
+    auto * const d = manager.d_func();
+    const QBluetoothAddress adapter1(u"11:11:11:11:11:11"_s), adapter2(u"22:22:22:22:22:22"_s);
+    QVERIFY(d->chooseAdapter(u"any"_s).isNull()); // No adapters to choose from.
+
+    manager.setAdapters({ adapter1, adapter2 });
+    QCOMPARE(d->chooseAdapter(u"any"_s), adapter1); // Equal, so the first.
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101, 0, adapter1);
+    QCOMPARE(d->chooseAdapter(u"any"_s), adapter2); // Least loaded.
+    addConnection(manager, u"00:00:00:00:00:02"_s, 102, 0, adapter2);
+    QCOMPARE(d->chooseAdapter(u"any"_s), adapter1);
+}
+
+void TestPokitConnectionManager::chooseAdapter_rssi()
+{
+    PokitConnectionManager manager;
+    auto * const d = manager.d_func();
+    const QBluetoothAddress adapter1(u"11:11:11:11:11:11"_s), adapter2(u"22:22:22:22:22:22"_s);
+    manager.setAdapters({ adapter1, adapter2 });
+    QBluetoothDeviceInfo info = deviceInfo(u"00:00:00:00:00:09"_s);
+    const QString key = PokitDeviceRegistry::key(info);
+    info.setRssi(-80);
+    manager.updateRssi(info, adapter1);
+    info.setRssi(-60);
+    manager.updateRssi(info, adapter2);
+    QCOMPARE(d->chooseAdapter(key), adapter2); // Strongest signal.
+
+    // A slightly busier adapter is still preferred for a much stronger signal.
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101, 0, adapter2);
+    QCOMPARE(d->chooseAdapter(key), adapter2);
+
+    // But not once it's substantially busier.
+    addConnection(manager, u"00:00:00:00:00:02"_s, 102, 0, adapter2);
+    QCOMPARE(d->chooseAdapter(key), adapter1);
+}
+
+void TestPokitConnectionManager::chooseAdapter_full()
+{
+    PokitConnectionManager manager;
+    auto * const d = manager.d_func();
+    const QBluetoothAddress adapter1(u"11:11:11:11:11:11"_s), adapter2(u"22:22:22:22:22:22"_s);
+    manager.setAdapters({ adapter1, adapter2 });
+    manager.setMaxConnections(adapter1, 1);
+    QBluetoothDeviceInfo info = deviceInfo(u"00:00:00:00:00:09"_s);
+    info.setRssi(-40);
+    manager.updateRssi(info, adapter1);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101, 0, adapter1);
+    addConnection(manager, u"00:00:00:00:00:02"_s, 102, 0, adapter2);
+    addConnection(manager, u"00:00:00:00:00:03"_s, 103, 0, adapter2);
+    // Adapter 1 is full, so adapter 2 is chosen, regardless of signal strength, or load.
+    QCOMPARE(d->chooseAdapter(PokitDeviceRegistry::key(info)), adapter2);
+}
+
+void TestPokitConnectionManager::evictIdle()
+{
+    PokitConnectionManager manager;
+    auto * const d = manager.d_func();
+    QVERIFY(!d->evictIdle(QBluetoothAddress()));
+    addConnection(manager, u"00:00:00:00:00:01"_s, 0, 200);
+    addConnection(manager, u"00:00:00:00:00:02"_s, 0, 100);
+    addConnection(manager, u"00:00:00:00:00:03"_s, 103, 50); // Leased, so never evicted.
+    QVERIFY(!d->evictIdle(QBluetoothAddress(u"11:22:33:44:55:66"_s))); // No connections on that adapter.
+    QVERIFY(d->evictIdle(QBluetoothAddress()));
+    QCOMPARE(manager.connectionCount(), 2);
+    QVERIFY(!d->connections.contains(PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:02"_s))));
+    QVERIFY(d->evictIdle(QBluetoothAddress()));
+    QVERIFY(!d->evictIdle(QBluetoothAddress()));
+    QCOMPARE(manager.connectionCount(), 1);
+}
+
+void TestPokitConnectionManager::housekeeping_idle()
+{
+    PokitConnectionManager manager;
+    manager.setIdleTimeout(100);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 0, 1000);
+    addConnection(manager, u"00:00:00:00:00:02"_s, 102, 0); // Leased, so never idle.
+    manager.d_func()->housekeeping(1099);
+    QCOMPARE(manager.connectionCount(), 2);
+    manager.d_func()->housekeeping(1100);
+    QCOMPARE(manager.connectionCount(), 1);
+    QCOMPARE(manager.d_func()->findTicket(102), PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:02"_s)));
+}
+
+void TestPokitConnectionManager::housekeeping_lease()
+{
+    PokitConnectionManager manager;
+    manager.setLeaseTimeout(100);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101, 1000);
+    const quint32 ticket = manager.request(deviceInfo(u"00:00:00:00:00:01"_s));
+    QSignalSpy expiredSpy(&manager, &PokitConnectionManager::leaseExpired);
+    QSignalSpy grantedSpy(&manager, &PokitConnectionManager::granted);
+
+    manager.d_func()->housekeeping(1099);
+    QCOMPARE(expiredSpy.count(), 0);
+    QCOMPARE(grantedSpy.count(), 0);
+
+    manager.d_func()->housekeeping(1100);
+    QCOMPARE(expiredSpy.count(), 1);
+    QCOMPARE(expiredSpy.at(0).at(0).value<quint32>(), (quint32)101);
+    QCOMPARE(grantedSpy.count(), 1);
+    QCOMPARE(grantedSpy.at(0).at(0).value<quint32>(), ticket);
+    QCOMPARE(manager.pendingCount(), 0);
+}
+
+void TestPokitConnectionManager::housekeeping_noneWaiting()
+{
+    PokitConnectionManager manager;
+    manager.setLeaseTimeout(100);
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101, 0);
+    QSignalSpy spy(&manager, &PokitConnectionManager::leaseExpired);
+    manager.d_func()->housekeeping(10000);
+    QCOMPARE(spy.count(), 0); // Leases only expire while other requests are waiting.
+    QVERIFY(!manager.d_func()->findTicket(101).isNull());
+}
+
+void TestPokitConnectionManager::disconnected()
+{
+    PokitConnectionManager manager;
+    addConnection(manager, u"00:00:00:00:00:01"_s, 101);
+    addConnection(manager, u"00:00:00:00:00:02"_s);
+    QSignalSpy spy(&manager, &PokitConnectionManager::failed);
+
+    manager.d_func()->disconnected(PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:02"_s)));
+    QCOMPARE(spy.count(), 0); // Idle, so no request has failed.
+    QCOMPARE(manager.connectionCount(), 1);
+
+    manager.d_func()->disconnected(PokitDeviceRegistry::key(deviceInfo(u"00:00:00:00:00:01"_s)));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<quint32>(), (quint32)101);
+    QCOMPARE(manager.connectionCount(), 0);
+    QVERIFY(!manager.release(101));
+}
+
+void TestPokitConnectionManager::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    PokitConnectionManager manager;
+    QVERIFY(!manager.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestPokitConnectionManager))
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestPokitConnectionManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void maxConnections();
+    void maxConnections_adapter();
+    void idleTimeout();
+    void leaseTimeout();
+    void adapters();
+
+    void request_warm();
+    void request_queued();
+    void request_busy();
+
+    void release_pending();
+    void release_leased();
+    void release_noIdle();
+    void release_invalid();
+    void disconnectIdle();
+
+    void prewarm_warm();
+    void prewarm_full();
+    void prewarm_requested();
+    void prewarm_unrequested();
+
+    void schedulingOrder();
+
+    void updateRssi();
+
+    void chooseAdapter_load();
+    void chooseAdapter_rssi();
+    void chooseAdapter_full();
+
+    void evictIdle();
+
+    void housekeeping_idle();
+    void housekeeping_lease();
+    void housekeeping_noneWaiting();
+
+    void disconnected();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
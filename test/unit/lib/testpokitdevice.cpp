@@ -15,6 +15,13 @@
 #include <qtpokit/multimeterservice.h>
 #include <qtpokit/statusservice.h>
 
+#include <QSignalSpy>
+#include <QThread>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitDevice::ConnectionProfile))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitDevice::ReconnectPolicy))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitDevice::Services))
+
 QTPOKIT_BEGIN_NAMESPACE
 DOKIT_USE_STRINGLITERALS
 
@@ -30,6 +37,13 @@ void TestPokitDevice::controller_const()
     QCOMPARE(device.controller(), nullptr);
 }
 
+void TestPokitDevice::localAdapter()
+{
+    // Only the default adapter, since constructing with a non-existent adapter may fail on some platforms.
+    const PokitDevice device(nullptr);
+    QVERIFY(device.localAdapter().isNull());
+}
+
 void TestPokitDevice::calibration()
 {
     PokitDevice device(nullptr);
@@ -90,6 +104,327 @@ void TestPokitDevice::status()
     QCOMPARE(device.status(), service); // safe manner, too).
 }
 
+void TestPokitDevice::service()
+{
+    PokitDevice device(nullptr);
+    QCOMPARE(device.service(PokitDevice::Service::Calibration), device.calibration());
+    QCOMPARE(device.service(PokitDevice::Service::DataLogger), device.dataLogger());
+    QCOMPARE(device.service(PokitDevice::Service::DeviceInfo), device.deviceInformation());
+    QCOMPARE(device.service(PokitDevice::Service::Dso), device.dso());
+    QCOMPARE(device.service(PokitDevice::Service::Multimeter), device.multimeter());
+    QCOMPARE(device.service(PokitDevice::Service::Status), device.status());
+    QCOMPARE(device.service((PokitDevice::Service)0x40), nullptr);
+}
+
+void TestPokitDevice::toString_service()
+{
+    QCOMPARE(PokitDevice::toString(PokitDevice::Service::Dso), u"DSO"_s);
+    QCOMPARE(PokitDevice::toString((PokitDevice::Service)0x40), QString());
+    QCOMPARE(PokitDevice::toString(PokitDevice::Service::Multimeter|PokitDevice::Service::Status),
+             u"Multimeter, Status"_s);
+    QCOMPARE(PokitDevice::toString(PokitDevice::Services()), QString());
+}
+
+void TestPokitDevice::prepareServices()
+{
+    // Verify safe error handling (can't do much else without a Bluetooth device).
+    PokitDevice device(nullptr);
+    QVERIFY(!device.prepareServices(PokitDevice::Service::Dso|PokitDevice::Service::Status));
+    QCOMPARE(device.preparedServices(), PokitDevice::Services());
+}
+
+void TestPokitDevice::servicePrepared()
+{
+    qRegisterMetaType<PokitDevice::Services>("PokitDevice::Services");
+    PokitDevice device(nullptr);
+    QSignalSpy spy(&device, &PokitDevice::servicesPrepared);
+    PokitDevicePrivate * const d = device.d_func();
+    d->requestedServices = PokitDevice::Service::Dso|PokitDevice::Service::Multimeter|PokitDevice::Service::Status;
+
+    // Nothing is reported until every requested service has either been prepared, or failed.
+    d->servicePrepared(PokitDevice::Service::Multimeter, true);
+    d->servicePrepared(PokitDevice::Service::Calibration, true); // Not requested.
+    d->servicePrepared(PokitDevice::Service::Status, false);
+    QCOMPARE(spy.count(), 0);
+    d->servicePrepared(PokitDevice::Service::Dso, true);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(qvariant_cast<PokitDevice::Services>(spy.at(0).at(0)),
+             PokitDevice::Service::Dso|PokitDevice::Service::Multimeter);
+    QCOMPARE(qvariant_cast<PokitDevice::Services>(spy.at(0).at(1)),
+             PokitDevice::Services(PokitDevice::Service::Status));
+    QCOMPARE(device.preparedServices(), PokitDevice::Service::Calibration|PokitDevice::Service::Dso|
+             PokitDevice::Service::Multimeter);
+
+    // Each request is reported once, and prepared services are forgotten on disconnection.
+    d->servicePrepared(PokitDevice::Service::Status, true);
+    QCOMPARE(spy.count(), 1);
+    d->disconnected();
+    QCOMPARE(device.preparedServices(), PokitDevice::Services());
+}
+
+void TestPokitDevice::capabilities()
+{
+    const PokitDevice device(nullptr);
+    const PokitDevice::Capabilities capabilities = device.capabilities();
+    QVERIFY(!capabilities.product);
+    QVERIFY(capabilities.firmwareVersion.isNull());
+    QVERIFY(!capabilities.loggerUpdateIntervalIs32bit);
+    QCOMPARE(capabilities.maximumSamplingRate, (quint16)0);
+    QCOMPARE(capabilities.samplingBufferSize, (quint16)0);
+    QCOMPARE(capabilities.maximumVoltage, (quint16)0);
+    QVERIFY(capabilities.macAddress.isNull());
+}
+
+void TestPokitDevice::setCapabilities()
+{
+    PokitDevice device(nullptr);
+    DataLoggerService * const dataLogger = device.dataLogger();
+    DsoService * const dso = device.dso();
+    dso->setPokitProduct(PokitProduct::PokitMeter); // Products already set should not be overridden.
+    QSignalSpy spy(&device, &PokitDevice::capabilitiesChanged);
+
+    device.setCapabilities({ PokitProduct::PokitPro, QVersionNumber(1, 4), true, 1000, 8192, 850, 10, 3000, 0,
+                             QBluetoothAddress(u"5C:02:72:09:AA:25"_s) });
+    QCOMPARE(spy.count(), 1);
+    const PokitDevice::Capabilities capabilities = device.capabilities();
+    QVERIFY(capabilities.product == PokitProduct::PokitPro);
+    QCOMPARE(capabilities.firmwareVersion, QVersionNumber(1, 4));
+    QVERIFY(capabilities.loggerUpdateIntervalIs32bit == true);
+    QCOMPARE(capabilities.maximumSamplingRate, (quint16)1000);
+    QCOMPARE(capabilities.samplingBufferSize, (quint16)8192);
+    QCOMPARE(capabilities.maximumVoltage, (quint16)850);
+    QCOMPARE(capabilities.maximumCurrent, (quint16)10);
+    QCOMPARE(capabilities.maximumResistance, (quint16)3000);
+    QCOMPARE(capabilities.macAddress, QBluetoothAddress(u"5C:02:72:09:AA:25"_s));
+
+    // Existing services should have the capabilities applied.
+    QVERIFY(dataLogger->pokitProduct() == PokitProduct::PokitPro);
+    QVERIFY(dataLogger->updateIntervalIs32bit() == true);
+    QVERIFY(dso->pokitProduct() == PokitProduct::PokitMeter);
+
+    // As should services created afterwards.
+    QVERIFY(device.status()->pokitProduct() == PokitProduct::PokitPro);
+    QVERIFY(device.multimeter()->pokitProduct() == PokitProduct::PokitPro);
+}
+
+void TestPokitDevice::toString_connectionProfile_data()
+{
+    QTest::addColumn<PokitDevice::ConnectionProfile>("profile");
+    QTest::addColumn<QString>("expected");
+    QTest::addRow("Default")    << PokitDevice::ConnectionProfile::Default    << u"Default"_s;
+    QTest::addRow("LowLatency") << PokitDevice::ConnectionProfile::LowLatency << u"Low latency"_s;
+    QTest::addRow("LowPower")   << PokitDevice::ConnectionProfile::LowPower   << u"Low power"_s;
+    QTest::addRow("invalid") << (PokitDevice::ConnectionProfile)255 << QString();
+}
+
+void TestPokitDevice::toString_connectionProfile()
+{
+    QFETCH(PokitDevice::ConnectionProfile, profile);
+    QFETCH(QString, expected);
+    QCOMPARE(PokitDevice::toString(profile), expected);
+}
+
+void TestPokitDevice::connectionParameters_data()
+{
+    QTest::addColumn<PokitDevice::ConnectionProfile>("profile");
+    QTest::addRow("Default")    << PokitDevice::ConnectionProfile::Default;
+    QTest::addRow("LowLatency") << PokitDevice::ConnectionProfile::LowLatency;
+    QTest::addRow("LowPower")   << PokitDevice::ConnectionProfile::LowPower;
+}
+
+void TestPokitDevice::connectionParameters()
+{
+    // Verify that all profiles are within the limits of the Bluetooth Core Specification.
+    QFETCH(PokitDevice::ConnectionProfile, profile);
+    const QLowEnergyConnectionParameters parameters = PokitDevice::connectionParameters(profile);
+    QVERIFY(parameters.minimumInterval() >= 7.5);
+    QVERIFY(parameters.minimumInterval() <= parameters.maximumInterval());
+    QVERIFY(parameters.maximumInterval() <= 4000.0);
+    QVERIFY(parameters.latency() >= 0);
+    QVERIFY(parameters.latency() <= 499);
+    QVERIFY(parameters.supervisionTimeout() >= 100);
+    QVERIFY(parameters.supervisionTimeout() <= 32000);
+    QVERIFY(parameters.supervisionTimeout() > (1 + parameters.latency()) * parameters.maximumInterval() * 2);
+}
+
+void TestPokitDevice::setConnectionProfile()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    // Verify that the profile is recorded, even when it cannot be requested yet.
+    PokitDevice device(nullptr);
+    QCOMPARE(device.connectionProfile(), PokitDevice::ConnectionProfile::Default);
+    QVERIFY(!device.setConnectionProfile(PokitDevice::ConnectionProfile::LowLatency));
+    QCOMPARE(device.connectionProfile(), PokitDevice::ConnectionProfile::LowLatency);
+    QVERIFY(device.d_func()->connectionProfileRequested);
+
+    // Verify that the request is deferred until connected.
+    QLowEnergyController * const tempController =
+        QLowEnergyController::createCentral(QBluetoothDeviceInfo());
+    device.d_func()->setController(tempController);
+    QVERIFY(device.setConnectionProfile(PokitDevice::ConnectionProfile::LowPower));
+    QCOMPARE(device.connectionProfile(), PokitDevice::ConnectionProfile::LowPower);
+    device.d_func()->setController(nullptr);
+    delete tempController;
+}
+
+void TestPokitDevice::mtu()
+{
+    PokitDevice device(nullptr);
+    QCOMPARE(device.mtu(), -1); // No controller, so unknown.
+}
+
+void TestPokitDevice::reconnectPolicy()
+{
+    PokitDevice device(nullptr);
+    QCOMPARE(device.reconnectPolicy().maximumAttempts, 0); // Never reconnect, by default.
+    QCOMPARE(device.reconnectPolicy().initialDelay, 1000u);
+    QCOMPARE(device.reconnectPolicy().maximumDelay, 60000u);
+    QVERIFY(!device.isReconnecting());
+
+    device.setReconnectPolicy({ 5, 250, 10000, 1.5f, 0.0f });
+    QCOMPARE(device.reconnectPolicy().maximumAttempts, 5);
+    QCOMPARE(device.reconnectPolicy().initialDelay, 250u);
+    QCOMPARE(device.reconnectPolicy().maximumDelay, 10000u);
+    QCOMPARE(device.reconnectPolicy().backoff, 1.5f);
+    QCOMPARE(device.reconnectPolicy().jitter, 0.0f);
+    QVERIFY(!device.isReconnecting());
+}
+
+void TestPokitDevice::reconnectDelay_data()
+{
+    QTest::addColumn<PokitDevice::ReconnectPolicy>("policy");
+    QTest::addColumn<int>("attempt");
+    QTest::addColumn<double>("random");
+    QTest::addColumn<quint32>("expected");
+
+    const PokitDevice::ReconnectPolicy defaults;
+    QTest::addRow("first") << defaults << 0 << 0.5 << 1000u;
+    QTest::addRow("fourth") << defaults << 3 << 0.5 << 8000u;
+    QTest::addRow("capped") << defaults << 10 << 0.5 << 60000u;
+    QTest::addRow("minJitter") << defaults << 0 << 0.0 << 750u;
+    QTest::addRow("maxJitter") << defaults << 1 << 1.0 << 2500u;
+    QTest::addRow("noBackoff") << PokitDevice::ReconnectPolicy{ 1, 1000, 60000, 0.5f, 0.0f } << 5 << 0.0 << 1000u;
+    QTest::addRow("lowMaximum") << PokitDevice::ReconnectPolicy{ 1, 1000, 100, 2.0f, 0.0f } << 5 << 0.0 << 1000u;
+}
+
+void TestPokitDevice::reconnectDelay()
+{
+    QFETCH(PokitDevice::ReconnectPolicy, policy);
+    QFETCH(int, attempt);
+    QFETCH(double, random);
+    QFETCH(quint32, expected);
+    QCOMPARE(PokitDevicePrivate::reconnectDelay(policy, attempt, random), expected);
+}
+
+void TestPokitDevice::scheduleReconnect()
+{
+    PokitDevice device(nullptr);
+    QSignalSpy reconnecting(&device, &PokitDevice::reconnecting);
+    QSignalSpy failed(&device, &PokitDevice::reconnectFailed);
+
+    // With the default policy, no reconnection attempts are allowed.
+    QTest::ignoreMessage(QtWarningMsg, "Failed to reconnect after 0 attempt/s.");
+    QVERIFY(!device.d_func()->scheduleReconnect());
+    QCOMPARE(reconnecting.count(), 0);
+    QCOMPARE(failed.count(), 1);
+
+    // Otherwise, attempts are scheduled until the maximum is reached.
+    device.setReconnectPolicy({ 1, 1000, 1000, 2.0f, 0.0f });
+    QVERIFY(device.d_func()->scheduleReconnect());
+    QVERIFY(device.isReconnecting());
+    QCOMPARE(reconnecting.count(), 1);
+    QCOMPARE(reconnecting.constFirst().at(0).toInt(), 1);
+    QCOMPARE(reconnecting.constFirst().at(1).toUInt(), 1000u);
+    QTest::ignoreMessage(QtWarningMsg, "Failed to reconnect after 1 attempt/s.");
+    QVERIFY(!device.d_func()->scheduleReconnect());
+    QVERIFY(!device.isReconnecting());
+    QCOMPARE(failed.count(), 2);
+}
+
+void TestPokitDevice::disconnectFromDevice()
+{
+    PokitDevice device(nullptr);
+    device.setReconnectPolicy({ 1, 1000, 1000, 2.0f, 0.0f });
+    QVERIFY(device.d_func()->scheduleReconnect());
+    QVERIFY(device.isReconnecting());
+    device.disconnectFromDevice(); // Safe without a controller, and cancels reconnection.
+    QVERIFY(!device.isReconnecting());
+    QVERIFY(device.d_func()->disconnectRequested);
+
+    // Requested disconnections do not trigger reconnection.
+    QSignalSpy reconnecting(&device, &PokitDevice::reconnecting);
+    device.d_func()->reconnectPending = false;
+    device.d_func()->disconnected();
+    QCOMPARE(reconnecting.count(), 0);
+}
+
+void TestPokitDevice::statistics()
+{
+    PokitDevice device(nullptr);
+    PokitDevice::Statistics statistics = device.statistics();
+    QCOMPARE(statistics.connections, (quint64)0);
+    QCOMPARE(statistics.disconnections, (quint64)0);
+    QCOMPARE(statistics.reconnections, (quint64)0);
+    QCOMPARE(statistics.reconnectFailures, (quint64)0);
+    QCOMPARE(statistics.errors, (quint64)0);
+    QVERIFY(statistics.services.isEmpty()); // No services created yet.
+
+    device.d_func()->disconnected();
+    device.d_func()->errorOccurred(QLowEnergyController::Error::UnknownError);
+    device.d_func()->errorOccurred(QLowEnergyController::Error::NoError); // Not counted.
+    QTest::ignoreMessage(QtWarningMsg, "Failed to reconnect after 0 attempt/s.");
+    QVERIFY(!device.d_func()->scheduleReconnect()); // No attempts allowed, so fails immediately.
+
+    // Verify that each created service's statistics are included.
+    device.dso();
+    device.multimeter();
+    statistics = device.statistics();
+    QCOMPARE(statistics.disconnections, (quint64)1);
+    QCOMPARE(statistics.reconnectFailures, (quint64)1);
+    QCOMPARE(statistics.errors, (quint64)1);
+    QCOMPARE(statistics.services.size(), 2);
+    QCOMPARE(statistics.services.at(0).notifications, (quint64)0);
+    QCOMPARE(statistics.services.at(0).notificationGaps.size(), AbstractPokitService::notificationGapBuckets);
+}
+
+void TestPokitDevice::workerThread()
+{
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 10, 0))
+    QSKIP("Cross-thread device access requires Qt 5.10 or later");
+    #else
+    QThread thread;
+    auto device = new PokitDevice(nullptr);
+    DsoService * const dso = device->dso(); // Created before moving to the worker thread.
+    QCOMPARE(dso->parent(), device);
+
+    // The private implementation, and existing services, should move with the device.
+    device->moveToThread(&thread);
+    QCOMPARE(device->d_func()->thread(), &thread);
+    QCOMPARE(dso->thread(), &thread);
+    connect(&thread, &QThread::finished, device, &QObject::deleteLater);
+    thread.start();
+
+    // Services created later, from other threads, should be created on the worker thread.
+    MultimeterService * const multimeter = device->multimeter();
+    QVERIFY(multimeter);
+    QCOMPARE(multimeter->thread(), &thread);
+    QCOMPARE(multimeter->parent(), device);
+    QCOMPARE(device->multimeter(), multimeter);
+
+    // Control methods should be safe to call from other threads.
+    device->setReconnectPolicy({ 3, 1000, 1000, 2.0f, 0.0f });
+    QTRY_COMPARE(device->reconnectPolicy().maximumAttempts, 3);
+    QVERIFY(!device->setConnectionProfile(PokitDevice::ConnectionProfile::LowLatency)); // No controller.
+    device->disconnectFromDevice();
+
+    thread.quit();
+    QVERIFY(thread.wait());
+    #endif
+}
+
 void TestPokitDevice::serviceToString_data()
 {
     QTest::addColumn<QBluetoothUuid>("uuid");
@@ -281,6 +616,46 @@ void TestPokitDevice::stateChanged()
     device.d_func()->stateChanged(QLowEnergyController::ControllerState::ClosingState);
 }
 
+void TestPokitDevice::updateCapabilities()
+{
+    PokitDevice device(nullptr);
+    QSignalSpy spy(&device, &PokitDevice::capabilitiesChanged);
+    device.d_func()->updateCapabilities(); // Nothing to resolve, since no services exist yet.
+    QCOMPARE(spy.count(), 0);
+
+    device.status();
+    device.dataLogger();
+    device.d_func()->updateCapabilities(); // Still nothing to resolve, since no services have been discovered.
+    QCOMPARE(spy.count(), 0);
+
+    device.dataLogger()->setUpdateIntervalIs32bit(false);
+    device.d_func()->updateCapabilities();
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(device.capabilities().loggerUpdateIntervalIs32bit == false);
+    QVERIFY(device.capabilities().firmwareVersion.isNull());
+
+    device.d_func()->updateCapabilities(); // Already resolved, so no further signals.
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestPokitDevice::isConnected()
+{
+    if (gitHubActionsRunnerOsVersion() >= QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 14)) {
+        QSKIP("BLE controller operations hang on GitHub Actions's macOS 14 runners");
+    }
+
+    PokitDevice device(nullptr);
+    QVERIFY(!device.d_func()->isConnected());
+    QVERIFY(!device.d_func()->requestConnectionProfile());
+
+    QLowEnergyController * const tempController =
+        QLowEnergyController::createCentral(QBluetoothDeviceInfo());
+    device.d_func()->setController(tempController);
+    QVERIFY(!device.d_func()->isConnected()); // Never connected.
+    device.d_func()->setController(nullptr);
+    delete tempController;
+}
+
 void TestPokitDevice::tr()
 {
     // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
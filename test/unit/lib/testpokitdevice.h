@@ -14,6 +14,7 @@ class TestPokitDevice : public QObject
 private slots:
     void controller();
     void controller_const();
+    void localAdapter();
 
     void calibration();
     void dataLogger();
@@ -21,6 +22,34 @@ private slots:
     void dso();
     void multimeter();
     void status();
+    void service();
+
+    void toString_service();
+    void prepareServices();
+    void servicePrepared();
+
+    void capabilities();
+    void setCapabilities();
+
+    void toString_connectionProfile_data();
+    void toString_connectionProfile();
+
+    void connectionParameters_data();
+    void connectionParameters();
+
+    void setConnectionProfile();
+
+    void mtu();
+
+    void reconnectPolicy();
+    void reconnectDelay_data();
+    void reconnectDelay();
+    void scheduleReconnect();
+    void disconnectFromDevice();
+
+    void statistics();
+
+    void workerThread();
 
     void serviceToString_data();
     void serviceToString();
@@ -38,6 +67,9 @@ private slots:
     void serviceDiscovered();
     void stateChanged();
 
+    void updateCapabilities();
+    void isConnected();
+
     void tr();
 };
 
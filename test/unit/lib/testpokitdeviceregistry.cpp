@@ -0,0 +1,305 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testpokitdeviceregistry.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/pokitdeviceregistry.h>
+#include <qtpokit/pokitdiscoveryagent.h>
+#include <qtpokit/statusservice.h>
+#include "pokitdeviceregistry_p.h"
+
+#include <QRegularExpression>
+#include <QSignalSpy>
+
+#include <limits>
+
+// QBluetoothDeviceInfo::setServiceUuids deprecated the completeness argument in Qt 5.13.
+#if (QT_VERSION < QT_VERSION_CHECK(5, 13, 0))
+#define DATA_COMPLETENESS , QBluetoothDeviceInfo::DataUnavailable
+#else
+#define DATA_COMPLETENESS
+#endif
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitDeviceRegistry::ConnectionState))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitDeviceRegistry::Entry))
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+QBluetoothDeviceInfo pokitPro(const QString &address, const QString &name, const qint16 rssi = -60)
+{
+    QBluetoothDeviceInfo info(QBluetoothAddress(address), name, 0);
+    info.setServiceUuids({ StatusService::ServiceUuids::pokitPro } DATA_COMPLETENESS);
+    info.setRssi(rssi);
+    return info;
+}
+
+}
+
+void TestPokitDeviceRegistry::initTestCase()
+{
+    // Register the type used by PokitDeviceRegistry's signals, so QSignalSpy can record their arguments.
+    qRegisterMetaType<PokitDeviceRegistry::Entry>("PokitDeviceRegistry::Entry");
+}
+
+void TestPokitDeviceRegistry::toString_ConnectionState_data()
+{
+    QTest::addColumn<PokitDeviceRegistry::ConnectionState>("state");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(state, expected) \
+        QTest::addRow(#state) << PokitDeviceRegistry::ConnectionState::state << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(Disconnected, "Disconnected");
+    DOKIT_ADD_TEST_ROW(Connecting,   "Connecting");
+    DOKIT_ADD_TEST_ROW(Connected,    "Connected");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (PokitDeviceRegistry::ConnectionState)255 << QString();
+}
+
+void TestPokitDeviceRegistry::toString_ConnectionState()
+{
+    QFETCH(PokitDeviceRegistry::ConnectionState, state);
+    QFETCH(QString, expected);
+    QCOMPARE(PokitDeviceRegistry::toString(state), expected);
+}
+
+void TestPokitDeviceRegistry::discoveryAgent()
+{
+    PokitDeviceRegistry registry;
+    QVERIFY(registry.discoveryAgent() != nullptr);
+    QCOMPARE(registry.discoveryAgent()->parent(), (QObject *)&registry);
+    QVERIFY(!registry.isRunning());
+}
+
+void TestPokitDeviceRegistry::scanDuration()
+{
+    PokitDeviceRegistry registry;
+    QCOMPARE(registry.scanDuration(), (quint32)10000);
+    registry.setScanDuration(0);
+    QCOMPARE(registry.scanDuration(), (quint32)0);
+}
+
+void TestPokitDeviceRegistry::scanInterval()
+{
+    PokitDeviceRegistry registry;
+    QCOMPARE(registry.scanInterval(), (quint32)20000);
+    registry.setScanInterval(1234);
+    QCOMPARE(registry.scanInterval(), (quint32)1234);
+}
+
+void TestPokitDeviceRegistry::maximumAge()
+{
+    PokitDeviceRegistry registry;
+    QCOMPARE(registry.maximumAge(), (quint32)60000);
+    registry.setMaximumAge(4000);
+    QCOMPARE(registry.maximumAge(), (quint32)4000);
+    QVERIFY(!registry.d_func()->ageTimer.isActive()); // Not running.
+
+    registry.d_func()->running = true;
+    registry.setMaximumAge(8000);
+    QVERIFY(registry.d_func()->ageTimer.isActive());
+    QCOMPARE(registry.d_func()->ageTimer.interval(), 2000);
+    registry.setMaximumAge(0);
+    QVERIFY(!registry.d_func()->ageTimer.isActive());
+}
+
+void TestPokitDeviceRegistry::key()
+{
+    QCOMPARE(PokitDeviceRegistry::key(pokitPro(u"11:22:33:44:55:66"_s, u"Pokit"_s)), u"11:22:33:44:55:66"_s);
+
+    const QBluetoothUuid uuid(QUuid::createUuid());
+    QCOMPARE(PokitDeviceRegistry::key(QBluetoothDeviceInfo(uuid, u"Pokit"_s, 0)), uuid.toString());
+}
+
+void TestPokitDeviceRegistry::seen()
+{
+    PokitDeviceRegistry registry;
+    QSignalSpy added(&registry, &PokitDeviceRegistry::deviceAdded);
+    QSignalSpy updated(&registry, &PokitDeviceRegistry::deviceUpdated);
+
+    registry.d_func()->seen(pokitPro(u"11:22:33:44:55:66"_s, u"Pokit"_s, -60), 1000);
+    QCOMPARE(added.count(), 1);
+    QCOMPARE(updated.count(), 0);
+    const auto entry = added.constFirst().at(0).value<PokitDeviceRegistry::Entry>();
+    QVERIFY(entry.product == PokitProduct::PokitPro);
+    QCOMPARE(entry.name, u"Pokit"_s);
+    QCOMPARE(entry.rssi, (qint16)-60);
+    QCOMPARE(entry.lastSeen, (qint64)1000);
+    QVERIFY(entry.connectionState == PokitDeviceRegistry::ConnectionState::Disconnected);
+
+    // Seeing the same device again updates, rather than duplicates, its entry.
+    registry.d_func()->seen(pokitPro(u"11:22:33:44:55:66"_s, u"Renamed"_s, -50), 2000);
+    QCOMPARE(added.count(), 1);
+    QCOMPARE(updated.count(), 1);
+    QCOMPARE(registry.count(), 1);
+    const auto update = updated.constFirst().at(0).value<PokitDeviceRegistry::Entry>();
+    QCOMPARE(update.name, u"Renamed"_s);
+    QCOMPARE(update.rssi, (qint16)-50);
+    QCOMPARE(update.lastSeen, (qint64)2000);
+
+    registry.d_func()->seen(pokitPro(u"66:55:44:33:22:11"_s, u"Other"_s), 3000);
+    QCOMPARE(added.count(), 2);
+    QCOMPARE(registry.count(), 2);
+}
+
+void TestPokitDeviceRegistry::seen_lookup()
+{
+    PokitDeviceRegistry registry;
+    QVERIFY(!registry.contains(u"11:22:33:44:55:66"_s));
+    QVERIFY(!registry.device(u"11:22:33:44:55:66"_s).has_value());
+    QVERIFY(registry.devices().isEmpty());
+
+    registry.d_func()->seen(pokitPro(u"11:22:33:44:55:66"_s, u"Pokit"_s), 1000);
+    QVERIFY(registry.contains(u"11:22:33:44:55:66"_s));
+    const auto entry = registry.device(u"11:22:33:44:55:66"_s);
+    QVERIFY(entry.has_value());
+    QCOMPARE(entry->name, u"Pokit"_s);
+    QCOMPARE(registry.devices().size(), 1);
+    QCOMPARE(registry.devices().constFirst().name, u"Pokit"_s);
+}
+
+void TestPokitDeviceRegistry::setConnectionState()
+{
+    PokitDeviceRegistry registry;
+    QSignalSpy updated(&registry, &PokitDeviceRegistry::deviceUpdated);
+    QVERIFY(!registry.setConnectionState(u"11:22:33:44:55:66"_s, PokitDeviceRegistry::ConnectionState::Connected));
+
+    registry.d_func()->seen(pokitPro(u"11:22:33:44:55:66"_s, u"Pokit"_s), 1000);
+    QVERIFY(registry.setConnectionState(u"11:22:33:44:55:66"_s, PokitDeviceRegistry::ConnectionState::Connected));
+    QCOMPARE(updated.count(), 1);
+    QVERIFY(updated.constFirst().at(0).value<PokitDeviceRegistry::Entry>().connectionState ==
+            PokitDeviceRegistry::ConnectionState::Connected);
+
+    // Unchanged states are not re-emitted.
+    QVERIFY(registry.setConnectionState(u"11:22:33:44:55:66"_s, PokitDeviceRegistry::ConnectionState::Connected));
+    QCOMPARE(updated.count(), 1);
+
+    // Disconnecting restarts the device's age.
+    QVERIFY(registry.setConnectionState(u"11:22:33:44:55:66"_s, PokitDeviceRegistry::ConnectionState::Disconnected));
+    QCOMPARE(updated.count(), 2);
+    QVERIFY(registry.device(u"11:22:33:44:55:66"_s)->lastSeen > 1000);
+}
+
+void TestPokitDeviceRegistry::ageOut()
+{
+    PokitDeviceRegistry registry;
+    registry.setMaximumAge(5000);
+    QSignalSpy removed(&registry, &PokitDeviceRegistry::deviceRemoved);
+    const auto d = registry.d_func();
+    d->seen(pokitPro(u"11:22:33:44:55:66"_s, u"Stale"_s), 1000);
+    d->seen(pokitPro(u"22:33:44:55:66:77"_s, u"Connected"_s), 1000);
+    d->seen(pokitPro(u"33:44:55:66:77:88"_s, u"Fresh"_s), 4000);
+    d->entries[u"22:33:44:55:66:77"_s].connectionState = PokitDeviceRegistry::ConnectionState::Connected;
+
+    QCOMPARE(d->ageOut(6000), 0); // Not more than 5 seconds old, yet.
+    QCOMPARE(d->ageOut(6001), 1);
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(removed.constFirst().at(0).value<PokitDeviceRegistry::Entry>().name, u"Stale"_s);
+    QVERIFY(!registry.contains(u"11:22:33:44:55:66"_s));
+
+    // Connected devices are never aged out.
+    QCOMPARE(d->ageOut(100000), 1);
+    QCOMPARE(removed.constLast().at(0).value<PokitDeviceRegistry::Entry>().name, u"Fresh"_s);
+    QCOMPARE(registry.count(), 1);
+    QVERIFY(registry.contains(u"22:33:44:55:66:77"_s));
+}
+
+void TestPokitDeviceRegistry::ageOut_disabled()
+{
+    PokitDeviceRegistry registry;
+    registry.setMaximumAge(0);
+    registry.d_func()->seen(pokitPro(u"11:22:33:44:55:66"_s, u"Pokit"_s), 1000);
+    QCOMPARE(registry.d_func()->ageOut(std::numeric_limits<qint64>::max()), 0);
+    QCOMPARE(registry.count(), 1);
+}
+
+void TestPokitDeviceRegistry::advertisementReceived()
+{
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    QSKIP("Not applicable before Qt version 5.12.");
+    #else
+    PokitDeviceRegistry registry;
+    QSignalSpy updated(&registry, &PokitDeviceRegistry::deviceUpdated);
+    const QBluetoothDeviceInfo info = pokitPro(u"11:22:33:44:55:66"_s, u"Pokit"_s);
+
+    // Unregistered devices are ignored.
+    registry.d_func()->advertisementReceived(info);
+    QCOMPARE(registry.count(), 0);
+
+    // Registered devices are refreshed, silently.
+    registry.d_func()->seen(info, 1000);
+    registry.d_func()->advertisementReceived(info);
+    QVERIFY(registry.device(u"11:22:33:44:55:66"_s)->lastSeen > 1000);
+    QCOMPARE(updated.count(), 0);
+    #endif
+}
+
+void TestPokitDeviceRegistry::clear()
+{
+    PokitDeviceRegistry registry;
+    QSignalSpy removed(&registry, &PokitDeviceRegistry::deviceRemoved);
+    registry.d_func()->seen(pokitPro(u"11:22:33:44:55:66"_s, u"First"_s), 1000);
+    registry.d_func()->seen(pokitPro(u"66:55:44:33:22:11"_s, u"Second"_s), 1000);
+    registry.clear();
+    QCOMPARE(registry.count(), 0);
+    QCOMPARE(removed.count(), 2);
+}
+
+void TestPokitDeviceRegistry::stop()
+{
+    // Verify safe handling, without starting a real scan (which would impact Bluetooth devices).
+    PokitDeviceRegistry registry;
+    const auto d = registry.d_func();
+    d->running = true;
+    d->scanTimer.start(60000);
+    d->ageTimer.start(60000);
+    registry.stop();
+    QVERIFY(!registry.isRunning());
+    QVERIFY(!d->scanTimer.isActive());
+    QVERIFY(!d->ageTimer.isActive());
+}
+
+void TestPokitDeviceRegistry::error()
+{
+    PokitDeviceRegistry registry;
+    const auto d = registry.d_func();
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Background scan error: .*$"_s));
+    d->error(QBluetoothDeviceDiscoveryAgent::Error::UnknownError);
+    QVERIFY(!d->scanTimer.isActive()); // Not running, so no retry.
+
+    d->running = true;
+    d->scanInterval = 0;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Background scan error: .*$"_s));
+    d->error(QBluetoothDeviceDiscoveryAgent::Error::UnknownError);
+    QVERIFY(d->scanTimer.isActive());
+    QCOMPARE(d->scanTimer.interval(), (int)PokitDeviceRegistryPrivate::errorRetryInterval);
+    registry.stop();
+}
+
+void TestPokitDeviceRegistry::finished()
+{
+    PokitDeviceRegistry registry;
+    const auto d = registry.d_func();
+    d->finished();
+    QVERIFY(!d->scanTimer.isActive()); // Not running, so no next scan.
+
+    d->running = true;
+    d->finished();
+    QVERIFY(d->scanTimer.isActive());
+    QCOMPARE(d->scanTimer.interval(), 20000);
+    registry.stop();
+}
+
+void TestPokitDeviceRegistry::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    PokitDeviceRegistry registry;
+    QVERIFY(!registry.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestPokitDeviceRegistry))
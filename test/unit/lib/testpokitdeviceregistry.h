@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestPokitDeviceRegistry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void toString_ConnectionState_data();
+    void toString_ConnectionState();
+
+    void discoveryAgent();
+    void scanDuration();
+    void scanInterval();
+    void maximumAge();
+
+    void key();
+
+    void seen();
+    void seen_lookup();
+
+    void setConnectionState();
+
+    void ageOut();
+    void ageOut_disabled();
+
+    void advertisementReceived();
+
+    void clear();
+
+    void stop();
+
+    void error();
+    void finished();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
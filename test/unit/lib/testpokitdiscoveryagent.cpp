@@ -30,6 +30,168 @@ DOKIT_USE_STRINGLITERALS
 //    QSKIP("Cannot test without impacting Bluetooth devices.");
 //}
 
+void TestPokitDiscoveryAgent::adapterAddress()
+{
+    // Only the default adapter, since constructing with a non-existent adapter may fail on some platforms.
+    const PokitDiscoveryAgent service(nullptr);
+    QVERIFY(service.d_func()->adapterAddress.isNull());
+    QVERIFY(service.adapterAddress().isNull());
+}
+
+void TestPokitDiscoveryAgent::updateInterval()
+{
+    PokitDiscoveryAgent service(nullptr);
+    QCOMPARE(service.updateInterval(), (quint32)0);
+    service.setUpdateInterval(500);
+    QCOMPARE(service.updateInterval(), (quint32)500);
+    QCOMPARE(service.d_func()->updateInterval, (quint32)500);
+}
+
+void TestPokitDiscoveryAgent::rssiSmoothing_data()
+{
+    QTest::addColumn<float>("smoothing");
+    QTest::addColumn<float>("expected");
+    QTest::addRow("none")     << 1.0f   << 1.0f;
+    QTest::addRow("quarter")  << 0.25f  << 0.25f;
+    QTest::addRow("zero")     << 0.0f   << 0.01f;
+    QTest::addRow("negative") << -1.0f  << 0.01f;
+    QTest::addRow("large")    << 2.0f   << 1.0f;
+}
+
+void TestPokitDiscoveryAgent::rssiSmoothing()
+{
+    QFETCH(float, smoothing);
+    QFETCH(float, expected);
+    PokitDiscoveryAgent service(nullptr);
+    QCOMPARE(service.rssiSmoothing(), 1.0f);
+    service.setRssiSmoothing(smoothing);
+    QCOMPARE(service.rssiSmoothing(), expected);
+}
+
+void TestPokitDiscoveryAgent::rssiThreshold()
+{
+    PokitDiscoveryAgent service(nullptr);
+    QCOMPARE(service.rssiThreshold(), (quint16)0);
+    service.setRssiThreshold(3);
+    QCOMPARE(service.rssiThreshold(), (quint16)3);
+    QCOMPARE(service.d_func()->rssiThreshold, (quint16)3);
+}
+
+void TestPokitDiscoveryAgent::scanFilter()
+{
+    const QVariantMap filter = PokitDiscoveryAgentPrivate::scanFilter();
+    QCOMPARE(filter.size(), 2);
+    QCOMPARE(filter.value(u"Transport"_s).toString(), u"le"_s);
+    const QStringList expected{ POKIT_METER_STATUS_SERVICE_UUID, POKIT_PRO_STATUS_SERVICE_UUID };
+    QCOMPARE(filter.value(u"UUIDs"_s).toStringList(), expected);
+}
+
+void TestPokitDiscoveryAgent::applyScanFilter()
+{
+    // Verify safe handling when not scanning (can't do much else without a Bluetooth device).
+    const PokitDiscoveryAgent service(nullptr);
+    QVERIFY(!service.isActive());
+    service.d_func()->applyScanFilter();
+}
+
+void TestPokitDiscoveryAgent::deviceKey()
+{
+    const QBluetoothDeviceInfo byAddress(QBluetoothAddress(u"11:22:33:44:55:66"_s), u"Pokit"_s, 0);
+    QCOMPARE(PokitDiscoveryAgentPrivate::deviceKey(byAddress), u"11:22:33:44:55:66"_s);
+
+    const QBluetoothUuid uuid(QUuid::createUuid());
+    const QBluetoothDeviceInfo byUuid(uuid, u"Pokit"_s, 0);
+    QCOMPARE(PokitDiscoveryAgentPrivate::deviceKey(byUuid), uuid.toString());
+}
+
+void TestPokitDiscoveryAgent::updateDevice()
+{
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    QSKIP("Not applicable before Qt version 5.12.");
+    #else
+    PokitDiscoveryAgent service(nullptr);
+    service.setUpdateInterval(100);
+    service.setRssiSmoothing(0.5f);
+    service.setRssiThreshold(2);
+    QSignalSpy spy(&service, &PokitDiscoveryAgent::pokitDeviceUpdated);
+    const auto d = service.d_func();
+    const QBluetoothDeviceInfo::Fields rssiField(QBluetoothDeviceInfo::Field::RSSI);
+
+    QBluetoothDeviceInfo info(QBluetoothAddress(u"11:22:33:44:55:66"_s), u"Pokit"_s, 0);
+    info.setRssi(-60);
+    d->addDevice(info, 0);
+    QCOMPARE(d->devices.size(), 1);
+
+    // Unchanged RSSI is dropped, even once the interval has elapsed.
+    QVERIFY(!d->updateDevice(info, rssiField, 200));
+    QCOMPARE(spy.count(), 0);
+
+    // Smoothed RSSI changes within the threshold are dropped.
+    info.setRssi(-64); // Smoothed to -62.
+    QVERIFY(!d->updateDevice(info, rssiField, 300));
+    QCOMPARE(d->devices.constBegin()->info.rssi(), (qint16)-62);
+    QCOMPARE(spy.count(), 0);
+
+    // Smoothed RSSI changes beyond the threshold are emitted.
+    info.setRssi(-70); // Smoothed to -66.
+    QVERIFY(d->updateDevice(info, rssiField, 400));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.constLast().at(0).value<QBluetoothDeviceInfo>().rssi(), (qint16)-66);
+    QVERIFY(d->devices.constBegin()->pendingFields == QBluetoothDeviceInfo::Fields());
+
+    // Other field changes, within the interval, are held back.
+    info.setRssi(-66);
+    QVERIFY(!d->updateDevice(info, QBluetoothDeviceInfo::Field::ManufacturerData, 450));
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(d->flushTimer.isActive());
+    QVERIFY(d->devices.constBegin()->pendingFields ==
+            QBluetoothDeviceInfo::Fields(QBluetoothDeviceInfo::Field::ManufacturerData));
+
+    // Updates for devices not yet seen are always emitted.
+    const QBluetoothDeviceInfo other(QBluetoothAddress(u"66:55:44:33:22:11"_s), u"Other"_s, 0);
+    QVERIFY(d->updateDevice(other, QBluetoothDeviceInfo::Fields(), 460));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(d->devices.size(), 2);
+    #endif
+}
+
+void TestPokitDiscoveryAgent::flushDevices()
+{
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    QSKIP("Not applicable before Qt version 5.12.");
+    #else
+    PokitDiscoveryAgent service(nullptr);
+    service.setUpdateInterval(100);
+    QSignalSpy spy(&service, &PokitDiscoveryAgent::pokitDeviceUpdated);
+    const auto d = service.d_func();
+
+    QBluetoothDeviceInfo first(QBluetoothAddress(u"11:22:33:44:55:66"_s), u"First"_s, 0);
+    QBluetoothDeviceInfo second(QBluetoothAddress(u"66:55:44:33:22:11"_s), u"Second"_s, 0);
+    d->addDevice(first, 0);
+    d->addDevice(second, 50);
+    first.setRssi(-50);
+    second.setRssi(-50);
+    QVERIFY(!d->updateDevice(first, QBluetoothDeviceInfo::Field::RSSI, 10));
+    QVERIFY(!d->updateDevice(second, QBluetoothDeviceInfo::Field::RSSI, 60));
+    QCOMPARE(spy.count(), 0);
+
+    // Only the first device's interval has elapsed.
+    d->flushDevices(120);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.constLast().at(0).value<QBluetoothDeviceInfo>().name(), u"First"_s);
+    QVERIFY(d->flushTimer.isActive());
+
+    // Nothing new is pending for the first device, so only the second is emitted.
+    d->flushDevices(150);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.constLast().at(0).value<QBluetoothDeviceInfo>().name(), u"Second"_s);
+    QCOMPARE(spy.constLast().at(0).value<QBluetoothDeviceInfo>().rssi(), (qint16)-50);
+
+    d->flushDevices(1000);
+    QCOMPARE(spy.count(), 2);
+    #endif
+}
+
 void TestPokitDiscoveryAgent::cancelled()
 {
     // Verify safe error handling (can't do much else without a Bluetooth device).
@@ -103,6 +265,30 @@ void TestPokitDiscoveryAgent::finished()
     service.d_func()->finished();
 }
 
+void TestPokitDiscoveryAgent::finished_flush()
+{
+    #if (QT_VERSION < QT_VERSION_CHECK(5, 12, 0)) // Required signal, and Fields, added in Qt 5.12.
+    QSKIP("Not applicable before Qt version 5.12.");
+    #else
+    PokitDiscoveryAgent service(nullptr);
+    service.setUpdateInterval(60000);
+    QSignalSpy spy(&service, &PokitDiscoveryAgent::pokitDeviceUpdated);
+    const auto d = service.d_func();
+
+    QBluetoothDeviceInfo info(QBluetoothAddress(u"11:22:33:44:55:66"_s), u"Pokit"_s, 0);
+    info.setServiceUuids({ StatusService::ServiceUuids::pokitPro } DATA_COMPLETENESS);
+    d->deviceDiscovered(info);
+    info.setRssi(-40);
+    d->deviceUpdated(info, QBluetoothDeviceInfo::Field::RSSI);
+    QCOMPARE(spy.count(), 0); // Held back, for (up to) a minute.
+
+    // Held back updates are emitted when the scan finishes.
+    d->finished();
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!d->flushTimer.isActive());
+    #endif
+}
+
 void TestPokitDiscoveryAgent::tr()
 {
     // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
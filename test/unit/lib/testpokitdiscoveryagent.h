@@ -14,6 +14,25 @@ class TestPokitDiscoveryAgent : public QObject
 private slots:
     //void start(); // Cannot test without impacting Bluetooth devices.
 
+    void adapterAddress();
+
+    void updateInterval();
+
+    void rssiSmoothing_data();
+    void rssiSmoothing();
+
+    void rssiThreshold();
+
+    void scanFilter();
+
+    void applyScanFilter();
+
+    void deviceKey();
+
+    void updateDevice();
+
+    void flushDevices();
+
     void cancelled();
 
     void deviceDiscovered_data();
@@ -26,6 +45,8 @@ private slots:
 
     void finished();
 
+    void finished_flush();
+
     void tr();
 };
 
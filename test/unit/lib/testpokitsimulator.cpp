@@ -0,0 +1,316 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testpokitsimulator.h"
+
+#include <qtpokit/dataloggerservice.h>
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitsimulator.h>
+#include <qtpokit/statusservice.h>
+#include "abstractpokitservice_p.h"
+#include "pokitsimulator_p.h"
+
+#include <QSignalSpy>
+
+#include <optional>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitSimulator::Stream))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestPokitSimulator::toString_Stream_data()
+{
+    QTest::addColumn<PokitSimulator::Stream>("stream");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(stream, expected) \
+        QTest::addRow(#stream) << PokitSimulator::Stream::stream << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(Multimeter, "Multimeter");
+    DOKIT_ADD_TEST_ROW(Dso,        "DSO");
+    DOKIT_ADD_TEST_ROW(DataLogger, "Data Logger");
+    DOKIT_ADD_TEST_ROW(Status,     "Status");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (PokitSimulator::Stream)4 << QString();
+}
+
+void TestPokitSimulator::toString_Stream()
+{
+    QFETCH(PokitSimulator::Stream, stream);
+    QFETCH(QString, expected);
+    QCOMPARE(PokitSimulator::toString(stream), expected);
+}
+
+void TestPokitSimulator::device()
+{
+    PokitSimulator noDevice(nullptr);
+    QCOMPARE(noDevice.device(), nullptr);
+
+    PokitDevice * const device = new PokitDevice(nullptr);
+    const PokitSimulator simulator(device);
+    QCOMPARE(simulator.device(), device);
+    delete device;
+    QCOMPARE(simulator.device(), nullptr); // Tracked via QPointer.
+}
+
+void TestPokitSimulator::product()
+{
+    PokitSimulator simulator(nullptr);
+    QCOMPARE(simulator.product(), PokitProduct::PokitPro);
+    simulator.setProduct(PokitProduct::PokitMeter);
+    QCOMPARE(simulator.product(), PokitProduct::PokitMeter);
+}
+
+void TestPokitSimulator::profile()
+{
+    PokitSimulator simulator(nullptr);
+    const PokitSimulator::Profile defaults = simulator.profile(PokitSimulator::Stream::Dso);
+    QCOMPARE(defaults.interval, 0u);
+    QCOMPARE(defaults.jitter, 0u);
+    QCOMPARE(defaults.payloadSize, (quint16)0);
+    QCOMPARE(defaults.failureRate, 0.0f);
+
+    simulator.setProfile(PokitSimulator::Stream::Dso, { 5, 2, 100, 0.5f });
+    const PokitSimulator::Profile profile = simulator.profile(PokitSimulator::Stream::Dso);
+    QCOMPARE(profile.interval, 5u);
+    QCOMPARE(profile.jitter, 2u);
+    QCOMPARE(profile.payloadSize, (quint16)100);
+    QCOMPARE(profile.failureRate, 0.5f);
+    QCOMPARE(simulator.profile(PokitSimulator::Stream::Multimeter).interval, 0u); // Others are unaffected.
+
+    // Payload sizes are always whole samples, and intervals never negative, however jittered.
+    simulator.setProfile(PokitSimulator::Stream::Dso, { 1, 10, 101, 0.0f });
+    QCOMPARE(simulator.d_func()->payloadSize(PokitSimulator::Stream::Dso), 100);
+    QCOMPARE(simulator.d_func()->payloadSize(PokitSimulator::Stream::DataLogger), 244);
+    for (int count = 0; count < 100; ++count) {
+        const int interval = simulator.d_func()->nextInterval(PokitSimulator::Stream::Dso, 0);
+        QVERIFY(interval >= 0);
+        QVERIFY(interval <= 11);
+    }
+}
+
+void TestPokitSimulator::latency()
+{
+    PokitSimulator simulator(nullptr);
+    QCOMPARE(simulator.latency(), 0u);
+    simulator.setLatency(123);
+    QCOMPARE(simulator.latency(), 123u);
+}
+
+void TestPokitSimulator::loggedSamples()
+{
+    PokitSimulator simulator(nullptr);
+    QCOMPARE(simulator.loggedSamples(), (quint16)1000);
+    simulator.setLoggedSamples(123);
+    QCOMPARE(simulator.loggedSamples(), (quint16)123);
+}
+
+void TestPokitSimulator::start()
+{
+    PokitSimulator noDevice(nullptr);
+    noDevice.start();
+    QVERIFY(!noDevice.isRunning());
+
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setProduct(PokitProduct::PokitMeter);
+    QSignalSpy discovered(device.dso(), &AbstractPokitService::serviceDetailsDiscovered);
+    simulator.start();
+    QVERIFY(simulator.isRunning());
+    QVERIFY(PokitSimulatorPrivate::servicePrivate(device.multimeter())->requestHandler);
+    QVERIFY(PokitSimulatorPrivate::servicePrivate(device.dso())->requestHandler);
+    QVERIFY(PokitSimulatorPrivate::servicePrivate(device.dataLogger())->requestHandler);
+    QVERIFY(PokitSimulatorPrivate::servicePrivate(device.status())->requestHandler);
+    QVERIFY(device.status()->pokitProduct());
+    QCOMPARE(*device.status()->pokitProduct(), PokitProduct::PokitMeter);
+    QCOMPARE(discovered.count(), 0); // Asynchronously, as for real devices.
+    QTRY_COMPARE(discovered.count(), 1);
+}
+
+void TestPokitSimulator::stop()
+{
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setLatency(60000);
+    simulator.start();
+
+    StatusService * const service = device.status();
+    QSignalSpy finished(service, &AbstractPokitService::requestFinished);
+    QVERIFY(service->readStatusCharacteristic());
+    QVERIFY(PokitSimulatorPrivate::servicePrivate(service)->inFlight);
+    QCOMPARE(finished.count(), 0);
+
+    simulator.stop();
+    QVERIFY(!simulator.isRunning());
+    QVERIFY(!PokitSimulatorPrivate::servicePrivate(service)->requestHandler);
+    QCOMPARE(finished.count(), 1); // The in-flight request can never be acknowledged now.
+    QCOMPARE(finished.at(0).at(1).toBool(), false);
+}
+
+void TestPokitSimulator::multimeter()
+{
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setProfile(PokitSimulator::Stream::Multimeter, { 1, 0, 0, 0.0f });
+    simulator.start();
+
+    MultimeterService * const service = device.multimeter();
+    QSignalSpy written(service, &MultimeterService::settingsWritten);
+    QVector<MultimeterService::Reading> readings;
+    connect(service, &MultimeterService::readingRead, this, [&readings](const MultimeterService::Reading &reading) {
+        readings.append(reading);
+    });
+    QVERIFY(service->setSettings({ MultimeterService::Mode::DcCurrent, 255, 1000 }));
+    QTRY_COMPARE(written.count(), 1);
+    QVERIFY(readings.isEmpty()); // Not until notifications are enabled.
+
+    QVERIFY(service->enableReadingNotifications());
+    QTRY_VERIFY(readings.size() >= 3);
+    for (const MultimeterService::Reading &reading: std::as_const(readings)) {
+        QCOMPARE(reading.mode, MultimeterService::Mode::DcCurrent);
+        QCOMPARE(reading.range, (quint8)255);
+        QVERIFY(reading.value >= 0.5f);
+        QVERIFY(reading.value <= 1.5f);
+    }
+    QCOMPARE(simulator.statistics().values, (quint64)readings.size());
+    QCOMPARE(simulator.statistics().bytes, (quint64)readings.size() * 7);
+}
+
+void TestPokitSimulator::dso()
+{
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setProfile(PokitSimulator::Stream::Dso, { 0, 0, 100, 0.0f });
+    simulator.start();
+
+    DsoService * const service = device.dso();
+    std::optional<DsoService::Metadata> metadata;
+    int samples = 0, notifications = 0;
+    connect(service, &DsoService::metadataRead, this, [&metadata](const DsoService::Metadata &meta) {
+        metadata = meta;
+    });
+    connect(service, &DsoService::samplesRead, this, [&](const DsoService::Samples &values) {
+        samples += (int)values.size();
+        ++notifications;
+    });
+    QVERIFY(service->setSettings({ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::AcVoltage, 255,
+                                   1000, 1000 }));
+    QVERIFY(service->enableMetadataNotifications());
+    QVERIFY(service->enableReadingNotifications());
+    QTRY_COMPARE(samples, 1000);
+    QVERIFY(metadata);
+    QCOMPARE(metadata->status, DsoService::DsoStatus::Done);
+    QCOMPARE(metadata->mode, DsoService::Mode::AcVoltage);
+    QCOMPARE(metadata->samplingWindow, 1000u);
+    QCOMPARE(metadata->numberOfSamples, (quint16)1000);
+    QCOMPARE(metadata->samplingRate, 1000000u);
+    QCOMPARE(notifications, 20); // 1000 samples, at 50 samples (100 bytes) per notification.
+}
+
+void TestPokitSimulator::dataLogger()
+{
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setLoggedSamples(500);
+    simulator.start();
+
+    DataLoggerService * const service = device.dataLogger();
+    std::optional<DataLoggerService::Metadata> metadata;
+    int samples = 0;
+    connect(service, &DataLoggerService::metadataRead, this, [&metadata](const DataLoggerService::Metadata &meta) {
+        metadata = meta;
+    });
+    connect(service, &DataLoggerService::samplesRead, this, [&samples](const DataLoggerService::Samples &values) {
+        samples += (int)values.size();
+    });
+    QVERIFY(service->startLogger({ DataLoggerService::Command::Start, 0, DataLoggerService::Mode::DcCurrent, 255,
+                                   5000, 12345 }));
+    QVERIFY(service->enableMetadataNotifications());
+    QVERIFY(service->enableReadingNotifications());
+    QVERIFY(service->fetchSamples());
+    QTRY_COMPARE(samples, 500);
+    QVERIFY(metadata);
+    QCOMPARE(metadata->mode, DataLoggerService::Mode::DcCurrent);
+    QCOMPARE(metadata->updateInterval, 5000u);
+    QCOMPARE(metadata->numberOfSamples, (quint16)500);
+    QCOMPARE(metadata->timestamp, 12345u);
+}
+
+void TestPokitSimulator::status()
+{
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setProduct(PokitProduct::PokitMeter);
+    simulator.setProfile(PokitSimulator::Stream::Status, { 1, 0, 0, 0.0f });
+    simulator.start();
+
+    StatusService * const service = device.status();
+    QVector<StatusService::Status> statuses;
+    connect(service, &StatusService::deviceStatusRead, this, [&statuses](const StatusService::Status &status) {
+        statuses.append(status);
+    });
+    QVERIFY(service->readStatusCharacteristic());
+    QTRY_COMPARE((int)statuses.size(), 1);
+    QCOMPARE(statuses.at(0).deviceStatus, StatusService::DeviceStatus::Idle);
+    QCOMPARE(statuses.at(0).batteryVoltage, 4.0f);
+    QCOMPARE(statuses.at(0).batteryStatus, StatusService::BatteryStatus::Good);
+    QVERIFY(!statuses.at(0).switchPosition); // Pokit Meters do not report switch positions.
+
+    QVERIFY(service->enableStatusNotifications());
+    QTRY_VERIFY(statuses.size() >= 3);
+}
+
+void TestPokitSimulator::failedRequests()
+{
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setProfile(PokitSimulator::Stream::Multimeter, { 1, 0, 0, 1.0f });
+    simulator.start();
+
+    MultimeterService * const service = device.multimeter();
+    QSignalSpy written(service, &MultimeterService::settingsWritten);
+    QSignalSpy finished(service, &AbstractPokitService::requestFinished);
+    QVERIFY(service->setSettings({ MultimeterService::Mode::DcVoltage, 255, 1000 }));
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(finished.at(0).at(1).toBool(), false);
+    QCOMPARE(written.count(), 0);
+    QCOMPARE(simulator.statistics().requests, (quint64)1);
+    QCOMPARE(simulator.statistics().failedRequests, (quint64)1);
+}
+
+void TestPokitSimulator::truncatedValues()
+{
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.start();
+
+    // Deliver values directly, so only values (and not requests) fail.
+    simulator.setProfile(PokitSimulator::Stream::Multimeter, { 1, 0, 0, 1.0f });
+    MultimeterService * const service = device.multimeter();
+    int errors = 0;
+    connect(service, &MultimeterService::readingRead, this, [&errors](const MultimeterService::Reading &reading) {
+        errors += (reading.status == MultimeterService::MeterStatus::Error) ? 1 : 0;
+    });
+    const quint64 failures = service->statistics().parseFailures;
+    for (int count = 0; count < 10; ++count) {
+        simulator.d_func()->meterTick();
+    }
+    simulator.stop();
+    QCOMPARE(errors, 10); // Still emitted, but as error readings.
+    QCOMPARE(simulator.statistics().values, (quint64)10);
+    QCOMPARE(simulator.statistics().truncatedValues, (quint64)10);
+    QCOMPARE(simulator.statistics().bytes, (quint64)30); // 7 byte readings, truncated to 3 bytes each.
+    QCOMPARE(service->statistics().parseFailures, failures + 10);
+}
+
+void TestPokitSimulator::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    PokitSimulator simulator(nullptr);
+    QVERIFY(!simulator.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestPokitSimulator))
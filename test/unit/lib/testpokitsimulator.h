@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestPokitSimulator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toString_Stream_data();
+    void toString_Stream();
+
+    void device();
+    void product();
+    void profile();
+    void latency();
+    void loggedSamples();
+
+    void start();
+    void stop();
+
+    void multimeter();
+    void dso();
+    void dataLogger();
+    void status();
+
+    void failedRequests();
+    void truncatedValues();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testpokittrace.h"
+
+#include <qtpokit/pokittrace.h>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitTrace::Stage))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestPokitTrace::init()
+{
+    PokitTrace::clear(); // Start each test with an empty trace.
+}
+
+void TestPokitTrace::toString_data()
+{
+    QTest::addColumn<PokitTrace::Stage>("stage");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(stage, expected) \
+        QTest::addRow(#stage) << PokitTrace::Stage::stage << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(Connect,   "connect");
+    DOKIT_ADD_TEST_ROW(Discovery, "discovery");
+    DOKIT_ADD_TEST_ROW(Write,     "write");
+    DOKIT_ADD_TEST_ROW(Notify,    "notify");
+    DOKIT_ADD_TEST_ROW(Parse,     "parse");
+    DOKIT_ADD_TEST_ROW(Emit,      "emit");
+    DOKIT_ADD_TEST_ROW(Format,    "format");
+    DOKIT_ADD_TEST_ROW(Output,    "output");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (PokitTrace::Stage)255 << QString();
+}
+
+void TestPokitTrace::toString()
+{
+    QFETCH(PokitTrace::Stage, stage);
+    QFETCH(QString, expected);
+    QCOMPARE(PokitTrace::toString(stage), expected);
+}
+
+void TestPokitTrace::capacity()
+{
+    #ifdef QTPOKIT_TRACE
+    QVERIFY(PokitTrace::isEnabled());
+    QVERIFY(PokitTrace::capacity() > 0);
+    #else
+    QVERIFY(!PokitTrace::isEnabled());
+    QCOMPARE(PokitTrace::capacity(), 0u);
+    #endif
+}
+
+void TestPokitTrace::record()
+{
+    PokitTrace::record(PokitTrace::Stage::Write, "first", 1);
+    PokitTrace::record(PokitTrace::Stage::Notify, "second", 20);
+    const QVector<PokitTrace::Event> events = PokitTrace::events();
+    if (!PokitTrace::isEnabled()) {
+        QVERIFY(events.isEmpty()); // Recording is a no-op when not enabled.
+        return;
+    }
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events.at(0).stage, PokitTrace::Stage::Write);
+    QCOMPARE(QByteArray(events.at(0).label), QByteArray("first"));
+    QCOMPARE(events.at(0).value, (qint64)1);
+    QCOMPARE(events.at(1).stage, PokitTrace::Stage::Notify);
+    QCOMPARE(QByteArray(events.at(1).label), QByteArray("second"));
+    QCOMPARE(events.at(1).value, (qint64)20);
+    QVERIFY(events.at(0).timestamp > 0);
+    QVERIFY(events.at(1).timestamp >= events.at(0).timestamp);
+}
+
+void TestPokitTrace::record_overflow()
+{
+    if (!PokitTrace::isEnabled()) {
+        QSKIP("Trace points are not enabled");
+    }
+    // Once full, the oldest events should be overwritten.
+    const quint32 capacity = PokitTrace::capacity();
+    for (quint32 index = 0; index < capacity + 10; ++index) {
+        PokitTrace::record(PokitTrace::Stage::Parse, "overflow", index);
+    }
+    const QVector<PokitTrace::Event> events = PokitTrace::events();
+    QCOMPARE(events.size(), (qsizetype)capacity);
+    QCOMPARE(events.constFirst().value, (qint64)10);
+    QCOMPARE(events.constLast().value, (qint64)capacity + 9);
+}
+
+void TestPokitTrace::clear()
+{
+    PokitTrace::record(PokitTrace::Stage::Emit, "cleared", 0);
+    PokitTrace::clear();
+    QVERIFY(PokitTrace::events().isEmpty());
+    PokitTrace::record(PokitTrace::Stage::Emit, "kept", 0);
+    QCOMPARE(PokitTrace::events().size(), PokitTrace::isEnabled() ? 1 : 0);
+}
+
+void TestPokitTrace::tracePoint()
+{
+    // The macro should record exactly when enabled, and otherwise not even evaluate its arguments.
+    int evaluated = 0;
+    QTPOKIT_TRACE_POINT(Connect, "macro", ++evaluated);
+    #if defined(QTPOKIT_TRACE) || defined(QTPOKIT_TRACE_PROFILER)
+    QCOMPARE(evaluated, 1);
+    #else
+    QCOMPARE(evaluated, 0);
+    #endif
+    #ifdef QTPOKIT_TRACE
+    QCOMPARE(PokitTrace::events().size(), 1);
+    #else
+    QVERIFY(PokitTrace::events().isEmpty());
+    #endif
+}
+
+void TestPokitTrace::zone()
+{
+    #ifdef QTPOKIT_TRACE_PROFILER
+    QVERIFY(PokitTrace::isProfilerEnabled());
+    #else
+    QVERIFY(!PokitTrace::isProfilerEnabled());
+    #endif
+
+    // Zones (including nested zones), frame marks and thread names should never record trace events.
+    QTPOKIT_TRACE_THREAD_NAME("testZone");
+    {
+        QTPOKIT_TRACE_ZONE(Format, "outer");
+        {
+            QTPOKIT_TRACE_ZONE(Output, "inner");
+        }
+        QTPOKIT_TRACE_FRAME_MARK("frame");
+    }
+    PokitTrace::endZone(); // Unbalanced ends should be harmless.
+    QVERIFY(PokitTrace::events().isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestPokitTrace))
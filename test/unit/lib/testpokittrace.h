@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestPokitTrace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void toString_data();
+    void toString();
+
+    void capacity();
+
+    void record();
+    void record_overflow();
+
+    void clear();
+
+    void tracePoint();
+    void zone();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testpowerintegrator.h"
+
+#include <qtpokit/powerintegrator.h>
+#include "powerintegrator_p.h"
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PowerIntegrator::Result))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+/// Returns all of the results emitted by \a integrator while invoking \a function.
+template<typename Func>
+QVector<PowerIntegrator::Result> resultsOf(PowerIntegrator &integrator, Func function)
+{
+    QVector<PowerIntegrator::Result> results;
+    const QMetaObject::Connection connection = QObject::connect(&integrator, &PowerIntegrator::resultReady,
+        [&results](const PowerIntegrator::Result &result) { results.append(result); });
+    function();
+    QObject::disconnect(connection);
+    return results;
+}
+
+}
+
+void TestPowerIntegrator::maximumGap()
+{
+    PowerIntegrator integrator;
+    QCOMPARE(integrator.maximumGap(), 0u);
+    integrator.setMaximumGap(1500);
+    QCOMPARE(integrator.maximumGap(), 1500u);
+    QVERIFY(!integrator.hasResult());
+}
+
+void TestPowerIntegrator::join()
+{
+    // Voltage and current sampled at alternating times, so each stream is interpolated at the other's sample times.
+    PowerIntegrator integrator;
+    const QVector<PowerIntegrator::Result> results = resultsOf(integrator, [&integrator]() {
+        integrator.addVoltage(10.0f, 0);
+        integrator.addCurrent(1.0f, 500);
+        integrator.addVoltage(12.0f, 1000);
+        integrator.addCurrent(2.0f, 1500);
+        integrator.addVoltage(14.0f, 2000);
+        integrator.addCurrent(3.0f, 2500);
+    });
+    QCOMPARE(results.size(), 4); // At 500, 1000, 1500 and 2000; the voltage at 0, and current at 2500, are unspanned.
+
+    QCOMPARE(results.at(0).timestamp, (qint64)500);
+    QCOMPARE(results.at(0).voltage, 11.0f);
+    QCOMPARE(results.at(0).current, 1.0f);
+    QCOMPARE(results.at(0).power, 11.0f);
+    QCOMPARE(results.at(0).averagePower, 11.0); // Nothing integrated yet.
+    QCOMPARE(results.at(0).energy, 0.0);
+    QCOMPARE(results.at(0).duration, (qint64)0);
+
+    QCOMPARE(results.at(1).timestamp, (qint64)1000);
+    QCOMPARE(results.at(1).voltage, 12.0f);
+    QCOMPARE(results.at(1).current, 1.5f);
+    QCOMPARE(results.at(1).power, 18.0f);
+    QCOMPARE(results.at(1).averagePower, 14.5);
+    QCOMPARE(results.at(1).duration, (qint64)500);
+
+    QCOMPARE(results.at(2).timestamp, (qint64)1500);
+    QCOMPARE(results.at(2).voltage, 13.0f);
+    QCOMPARE(results.at(2).current, 2.0f);
+    QCOMPARE(results.at(2).power, 26.0f);
+
+    // Trapezoids of (11+18)/2, (18+26)/2 and (26+35)/2 watts, for 500ms each, is 33,500 watt-milliseconds.
+    const PowerIntegrator::Result &last = results.at(3);
+    QCOMPARE(last.timestamp, (qint64)2000);
+    QCOMPARE(last.voltage, 14.0f);
+    QCOMPARE(last.current, 2.5f);
+    QCOMPARE(last.power, 35.0f);
+    QCOMPARE(last.duration, (qint64)1500);
+    QCOMPARE(last.energy, 33500.0 / 3'600'000.0);
+    QCOMPARE(last.averagePower, 33500.0 / 1500.0);
+    QCOMPARE(last.charge, 2625.0 / 3'600'000.0); // Trapezoids of 1.25, 1.75 and 2.25 amps, for 500ms each.
+
+    QVERIFY(integrator.hasResult());
+    QCOMPARE(integrator.result().timestamp, last.timestamp);
+    QCOMPARE(integrator.result().energy, last.energy);
+
+    // Only the samples still needed for interpolation remain buffered.
+    QCOMPARE(integrator.d_func()->voltages.size(), 1);
+    QCOMPARE(integrator.d_func()->currents.size(), 2);
+}
+
+void TestPowerIntegrator::join_gap()
+{
+    // A constant 10W, with the voltage stream missing 3s of samples.
+    const auto addSamples = [](PowerIntegrator &integrator) {
+        integrator.addVoltage(10.0f, 0);
+        for (const qint64 timestamp: { 0, 1000, 2000, 3000 }) {
+            integrator.addCurrent(1.0f, timestamp);
+        }
+        integrator.addVoltage(10.0f, 3000);
+    };
+
+    // Without a maximum gap, the voltage is interpolated across the gap.
+    PowerIntegrator bridged;
+    QCOMPARE(resultsOf(bridged, [&]() { addSamples(bridged); }).size(), 4);
+    QCOMPARE(bridged.result().duration, (qint64)3000);
+    QCOMPARE(bridged.result().energy, 30000.0 / 3'600'000.0);
+    QCOMPARE(bridged.result().charge, 3000.0 / 3'600'000.0);
+
+    // With a 1s maximum gap, neither interpolated, nor integrated across.
+    PowerIntegrator gapped;
+    gapped.setMaximumGap(1000);
+    const QVector<PowerIntegrator::Result> results = resultsOf(gapped, [&]() { addSamples(gapped); });
+    QCOMPARE(results.size(), 2);
+    QCOMPARE(results.at(0).timestamp, (qint64)0);
+    QCOMPARE(results.at(1).timestamp, (qint64)3000);
+    QCOMPARE(results.at(1).power, 10.0f);
+    QCOMPARE(results.at(1).duration, (qint64)0);
+    QCOMPARE(results.at(1).energy, 0.0);
+}
+
+void TestPowerIntegrator::join_ignored()
+{
+    PowerIntegrator integrator;
+    integrator.addVoltage(1.0f, 100);
+    integrator.addVoltage(2.0f, 100); // Not after the previous sample.
+    integrator.addVoltage(3.0f, 50);  // Before the previous sample.
+    integrator.addVoltage(std::numeric_limits<float>::infinity(), 200);
+    integrator.addVoltage(std::numeric_limits<float>::quiet_NaN(), 300);
+    QCOMPARE(integrator.d_func()->voltages.size(), 1);
+    QCOMPARE(integrator.d_func()->voltages.at(0).value, 1.0f);
+    QVERIFY(!integrator.hasResult());
+}
+
+void TestPowerIntegrator::join_pending()
+{
+    // With no current samples, voltage samples are buffered, but only up to the limit.
+    PowerIntegrator integrator;
+    for (int index = 0; index < PowerIntegrator::maxPendingSamples * 2; ++index) {
+        integrator.addVoltage(1.0f, index);
+    }
+    QCOMPARE(integrator.d_func()->voltages.size(), PowerIntegrator::maxPendingSamples + 1);
+    QCOMPARE(integrator.d_func()->voltages.constLast().timestamp, (qint64)PowerIntegrator::maxPendingSamples * 2 - 1);
+
+    // Then joined once current samples (within the buffered range) arrive.
+    QCOMPARE(resultsOf(integrator, [&integrator]() {
+        integrator.addCurrent(2.0f, PowerIntegrator::maxPendingSamples * 2 - 2);
+    }).size(), 1);
+    QCOMPARE(integrator.result().power, 2.0f);
+}
+
+void TestPowerIntegrator::reset()
+{
+    PowerIntegrator integrator;
+    integrator.setMaximumGap(1000);
+    integrator.addVoltage(5.0f, 0);
+    integrator.addCurrent(1.0f, 0);
+    integrator.addCurrent(1.0f, 1000);
+    integrator.addVoltage(5.0f, 1000);
+    QVERIFY(integrator.hasResult());
+    QVERIFY(integrator.result().energy > 0.0);
+
+    integrator.reset();
+    QVERIFY(!integrator.hasResult());
+    QCOMPARE(integrator.result().energy, 0.0);
+    QCOMPARE(integrator.result().charge, 0.0);
+    QCOMPARE(integrator.result().duration, (qint64)0);
+    QVERIFY(integrator.d_func()->voltages.isEmpty());
+    QVERIFY(integrator.d_func()->currents.isEmpty());
+    QCOMPARE(integrator.maximumGap(), 1000u); // Unchanged.
+
+    // Earlier timestamps are accepted again, after a reset.
+    integrator.addVoltage(1.0f, 0);
+    integrator.addCurrent(1.0f, 0);
+    QVERIFY(integrator.hasResult());
+    QCOMPARE(integrator.result().power, 1.0f);
+}
+
+void TestPowerIntegrator::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    PowerIntegrator integrator;
+    QVERIFY(!integrator.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestPowerIntegrator))
@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestPowerIntegrator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void maximumGap();
+
+    void join();
+    void join_gap();
+    void join_ignored();
+    void join_pending();
+
+    void reset();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
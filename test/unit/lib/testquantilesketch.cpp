@@ -0,0 +1,183 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testquantilesketch.h"
+
+#include <qtpokit/quantilesketch.h>
+
+#include <QtMath>
+
+#include <cmath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestQuantileSketch::empty()
+{
+    const QuantileSketch sketch;
+    QVERIFY(sketch.isEmpty());
+    QCOMPARE(sketch.accuracy(), QuantileSketch::defaultAccuracy);
+    QCOMPARE(sketch.count(), (quint64)0);
+    QCOMPARE(sketch.minimum(), 0.0f);
+    QCOMPARE(sketch.maximum(), 0.0f);
+    QVERIFY(std::isnan(sketch.mean()));
+    QVERIFY(qIsNaN(sketch.percentile(50.0)));
+    QCOMPARE(sketch.retainedCount(), (qsizetype)0);
+}
+
+void TestQuantileSketch::accuracy()
+{
+    QCOMPARE(QuantileSketch(100).accuracy(), 100);
+    QCOMPARE(QuantileSketch(8).accuracy(), 8);
+    QCOMPARE(QuantileSketch(1).accuracy(), 8);
+    QCOMPARE(QuantileSketch(-1).accuracy(), 8);
+}
+
+void TestQuantileSketch::add()
+{
+    QuantileSketch sketch;
+    for (const float value: { 20.0f, 10.0f, 30.0f }) {
+        sketch.add(value);
+    }
+    QVERIFY(!sketch.isEmpty());
+    QCOMPARE(sketch.count(), (quint64)3);
+    QCOMPARE(sketch.minimum(), 10.0f);
+    QCOMPARE(sketch.maximum(), 30.0f);
+    QCOMPARE(sketch.mean(), 20.0);
+    QCOMPARE(sketch.percentile(50.0), 20.0f);
+    QCOMPARE(sketch.retainedCount(), (qsizetype)3);
+}
+
+void TestQuantileSketch::add_nan()
+{
+    QuantileSketch sketch;
+    sketch.add(qQNaN());
+    QVERIFY(sketch.isEmpty());
+    sketch.add(-1.0f);
+    sketch.add(qQNaN());
+    sketch.add(qInf());
+    QCOMPARE(sketch.count(), (quint64)2);
+    QCOMPARE(sketch.minimum(), -1.0f);
+    QCOMPARE(sketch.maximum(), (float)qInf());
+    QCOMPARE(sketch.percentile(50.0), -1.0f);
+}
+
+void TestQuantileSketch::percentile_data()
+{
+    QTest::addColumn<double>("percent");
+    QTest::addColumn<float>("expected");
+    QTest::addRow("0")    <<   0.0 <<  0.0f;
+    QTest::addRow("1")    <<   1.0 <<  0.0f;
+    QTest::addRow("50")   <<  50.0 << 49.0f;
+    QTest::addRow("95")   <<  95.0 << 94.0f;
+    QTest::addRow("99")   <<  99.0 << 98.0f;
+    QTest::addRow("99.9") <<  99.9 << 99.0f;
+    QTest::addRow("100")  << 100.0 << 99.0f;
+    QTest::addRow("200")  << 200.0 << 99.0f;
+}
+
+void TestQuantileSketch::percentile()
+{
+    // Fewer values than the lowest level's capacity, so these percentiles are exact.
+    QFETCH(double, percent);
+    QFETCH(float, expected);
+    QuantileSketch sketch;
+    for (int index = 0; index < 100; ++index) {
+        sketch.add((float)((index * 7919) % 100)); // 0 to 99, in a scrambled order.
+    }
+    QCOMPARE(sketch.retainedCount(), (qsizetype)100);
+    QCOMPARE(sketch.percentile(percent), expected);
+}
+
+void TestQuantileSketch::percentile_large_data()
+{
+    QTest::addColumn<double>("percent");
+    QTest::addRow("1")  <<  1.0;
+    QTest::addRow("25") << 25.0;
+    QTest::addRow("50") << 50.0;
+    QTest::addRow("95") << 95.0;
+    QTest::addRow("99") << 99.0;
+}
+
+void TestQuantileSketch::percentile_large()
+{
+    QFETCH(double, percent);
+    constexpr int count = 100'000;
+    QuantileSketch sketch;
+    for (int index = 0; index < count; ++index) {
+        sketch.add((float)((index * 7919) % count)); // 0 to 99,999, in a scrambled order.
+    }
+    QCOMPARE(sketch.count(), (quint64)count);
+    QCOMPARE(sketch.minimum(), 0.0f);
+    QCOMPARE(sketch.maximum(), (float)(count - 1));
+    QCOMPARE(sketch.mean(), (count - 1) / 2.0);
+
+    // Memory is bounded by the accuracy, not the count.
+    QVERIFY(sketch.retainedCount() < 4 * sketch.accuracy());
+
+    // And the percentile is within 1% of its true rank.
+    const float estimate = sketch.percentile(percent);
+    QVERIFY2(qAbs(estimate - percent / 100.0 * count) <= count / 100.0, qPrintable(QString::number(estimate)));
+}
+
+void TestQuantileSketch::merge()
+{
+    QuantileSketch first, second, empty;
+    first.add(1.0f);
+    first.add(2.0f);
+    second.add(3.0f);
+    second.add(100.0f);
+
+    QuantileSketch merged;
+    merged.merge(empty);
+    QVERIFY(merged.isEmpty());
+    merged.merge(first);
+    QCOMPARE(merged.count(), (quint64)2);
+    QCOMPARE(merged.percentile(50.0), 1.0f);
+    merged.merge(second);
+    merged.merge(empty);
+    QCOMPARE(merged.count(), (quint64)4);
+    QCOMPARE(merged.minimum(), 1.0f);
+    QCOMPARE(merged.maximum(), 100.0f);
+    QCOMPARE(merged.mean(), 26.5);
+    QCOMPARE(merged.percentile(50.0), 2.0f);
+    QCOMPARE(merged.percentile(75.0), 3.0f);
+
+    // Merging many (compacted) sketches remains bounded, and accurate.
+    constexpr int count = 100'000;
+    QuantileSketch halves[2];
+    for (int index = 0; index < count; ++index) {
+        halves[index % 2].add((float)((index * 7919) % count));
+    }
+    halves[0].merge(halves[1]);
+    QCOMPARE(halves[0].count(), (quint64)count);
+    QCOMPARE(halves[0].minimum(), 0.0f);
+    QCOMPARE(halves[0].maximum(), (float)(count - 1));
+    QVERIFY(halves[0].retainedCount() < 4 * halves[0].accuracy());
+    for (const double percent: { 1.0, 50.0, 99.0 }) {
+        QVERIFY(qAbs(halves[0].percentile(percent) - percent / 100.0 * count) <= count / 100.0);
+    }
+}
+
+void TestQuantileSketch::reset()
+{
+    QuantileSketch sketch;
+    for (int value = 0; value < 10'000; ++value) {
+        sketch.add((float)value);
+    }
+    sketch.reset();
+    QVERIFY(sketch.isEmpty());
+    QCOMPARE(sketch.count(), (quint64)0);
+    QCOMPARE(sketch.retainedCount(), (qsizetype)0);
+    QVERIFY(qIsNaN(sketch.percentile(50.0)));
+    QVERIFY(std::isnan(sketch.mean()));
+
+    sketch.add(7.0f);
+    QCOMPARE(sketch.count(), (quint64)1);
+    QCOMPARE(sketch.minimum(), 7.0f);
+    QCOMPARE(sketch.maximum(), 7.0f);
+    QCOMPARE(sketch.percentile(99.0), 7.0f);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestQuantileSketch))
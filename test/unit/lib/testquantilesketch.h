@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestQuantileSketch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+
+    void accuracy();
+
+    void add();
+    void add_nan();
+
+    void percentile_data();
+    void percentile();
+
+    void percentile_large_data();
+    void percentile_large();
+
+    void merge();
+
+    void reset();
+};
+
+QTPOKIT_END_NAMESPACE
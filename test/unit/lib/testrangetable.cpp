@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testrangetable.h"
+
+#include <qtpokit/pokitmeter.h>
+#include <qtpokit/pokitpro.h>
+#include <qtpokit/rangetable.h>
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitMeter::VoltageRange))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(PokitPro::ResistanceRange))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+    enum class TestRange : quint8 { A = 0, B = 1, C = 2, AutoRange = 255 };
+}
+
+void TestRangeTable::isValid()
+{
+    static_assert(RangeTable::isValid(PokitMeter::currentRanges));
+    static_assert(RangeTable::isValid(PokitMeter::resistanceRanges));
+    static_assert(RangeTable::isValid(PokitMeter::voltageRanges));
+    static_assert(RangeTable::isValid(PokitPro::capacitanceRanges));
+    static_assert(RangeTable::isValid(PokitPro::currentRanges));
+    static_assert(RangeTable::isValid(PokitPro::resistanceRanges));
+    static_assert(RangeTable::isValid(PokitPro::voltageRanges));
+
+    constexpr std::array<RangeInfo<TestRange>, 3> valid {{
+        { TestRange::A, 1, "A" }, { TestRange::B, 2, "B" }, { TestRange::C, 3, "C" } }};
+    constexpr std::array<RangeInfo<TestRange>, 3> misnumbered {{
+        { TestRange::A, 1, "A" }, { TestRange::C, 2, "C" }, { TestRange::B, 3, "B" } }};
+    constexpr std::array<RangeInfo<TestRange>, 3> unordered {{
+        { TestRange::A, 1, "A" }, { TestRange::B, 3, "B" }, { TestRange::C, 2, "C" } }};
+    constexpr std::array<RangeInfo<TestRange>, 3> duplicated {{
+        { TestRange::A, 1, "A" }, { TestRange::B, 2, "B" }, { TestRange::C, 2, "C" } }};
+    constexpr std::array<RangeInfo<TestRange>, 1> zero {{ { TestRange::A, 0, "A" } }};
+    constexpr std::array<RangeInfo<TestRange>, 0> empty {};
+    QVERIFY(RangeTable::isValid(valid));
+    QVERIFY(!RangeTable::isValid(misnumbered));
+    QVERIFY(!RangeTable::isValid(unordered));
+    QVERIFY(!RangeTable::isValid(duplicated));
+    QVERIFY(!RangeTable::isValid(zero));
+    QVERIFY(!RangeTable::isValid(empty));
+}
+
+void TestRangeTable::find()
+{
+    static_assert(RangeTable::find(PokitMeter::voltageRanges, PokitMeter::VoltageRange::_6V)->maxValue == 6'000);
+    static_assert(RangeTable::find(PokitMeter::voltageRanges, PokitMeter::VoltageRange::AutoRange) == nullptr);
+
+    for (const auto &info: PokitPro::currentRanges) {
+        const RangeInfo<PokitPro::CurrentRange> * const found = RangeTable::find(PokitPro::currentRanges, info.range);
+        QVERIFY(found != nullptr);
+        QCOMPARE(found->maxValue, info.maxValue);
+        QCOMPARE(found->label, info.label);
+    }
+    QVERIFY(RangeTable::find(PokitPro::currentRanges, (PokitPro::CurrentRange)7) == nullptr);
+    QVERIFY(RangeTable::find(PokitPro::currentRanges, PokitPro::CurrentRange::AutoRange) == nullptr);
+}
+
+void TestRangeTable::maxValue_data()
+{
+    QTest::addColumn<PokitMeter::VoltageRange>("range");
+    QTest::addColumn<quint32>("expected");
+
+    QTest::addRow("300mV")   << PokitMeter::VoltageRange::_300mV    << (quint32)   300;
+    QTest::addRow("12V")     << PokitMeter::VoltageRange::_12V      << (quint32)12'000;
+    QTest::addRow("60V")     << PokitMeter::VoltageRange::_60V      << (quint32)60'000;
+    QTest::addRow("auto")    << PokitMeter::VoltageRange::AutoRange << (quint32)60'000;
+    QTest::addRow("unknown") << (PokitMeter::VoltageRange)6         << (quint32)     0;
+}
+
+void TestRangeTable::maxValue()
+{
+    QFETCH(PokitMeter::VoltageRange, range);
+    QFETCH(quint32, expected);
+    QCOMPARE(RangeTable::maxValue(PokitMeter::voltageRanges, range), expected);
+}
+
+void TestRangeTable::minRange_data()
+{
+    QTest::addColumn<quint32>("value");
+    QTest::addColumn<PokitPro::ResistanceRange>("expected");
+
+    QTest::addRow("0")       << (quint32)        0 << PokitPro::ResistanceRange::AutoRange;
+    QTest::addRow("1")       << (quint32)        1 << PokitPro::ResistanceRange::_30;
+    QTest::addRow("30")      << (quint32)       30 << PokitPro::ResistanceRange::_30;
+    QTest::addRow("31")      << (quint32)       31 << PokitPro::ResistanceRange::_75;
+    QTest::addRow("5K")      << (quint32)    5'000 << PokitPro::ResistanceRange::_5K;
+    QTest::addRow("5K+1")    << (quint32)    5'001 << PokitPro::ResistanceRange::_10K;
+    QTest::addRow("600K")    << (quint32)  600'000 << PokitPro::ResistanceRange::_700K;
+    QTest::addRow("3M")      << (quint32)3'000'000 << PokitPro::ResistanceRange::_3M;
+    QTest::addRow("3M+1")    << (quint32)3'000'001 << PokitPro::ResistanceRange::AutoRange;
+    QTest::addRow("max")     << std::numeric_limits<quint32>::max() << PokitPro::ResistanceRange::AutoRange;
+}
+
+void TestRangeTable::minRange()
+{
+    QFETCH(quint32, value);
+    QFETCH(PokitPro::ResistanceRange, expected);
+    QCOMPARE(RangeTable::minRange(PokitPro::resistanceRanges, value), expected);
+}
+
+void TestRangeTable::isSaturated_data()
+{
+    QTest::addColumn<PokitMeter::VoltageRange>("range");
+    QTest::addColumn<double>("value");
+    QTest::addColumn<bool>("expected");
+
+    QTest::addRow("zero")     << PokitMeter::VoltageRange::_2V       <<      0.0 << false;
+    QTest::addRow("within")   << PokitMeter::VoltageRange::_2V       <<  1'999.9 << false;
+    QTest::addRow("at")       << PokitMeter::VoltageRange::_2V       <<  2'000.0 << true;
+    QTest::addRow("beyond")   << PokitMeter::VoltageRange::_2V       <<  2'500.0 << true;
+    QTest::addRow("negative") << PokitMeter::VoltageRange::_2V       << -2'000.0 << true;
+    QTest::addRow("auto")     << PokitMeter::VoltageRange::AutoRange << 99'999.0 << false;
+    QTest::addRow("unknown")  << (PokitMeter::VoltageRange)42        << 99'999.0 << false;
+}
+
+void TestRangeTable::isSaturated()
+{
+    QFETCH(PokitMeter::VoltageRange, range);
+    QFETCH(double, value);
+    QFETCH(bool, expected);
+    QCOMPARE(RangeTable::isSaturated(PokitMeter::voltageRanges, range, value), expected);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestRangeTable))
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestRangeTable : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void isValid();
+
+    void find();
+
+    void maxValue_data();
+    void maxValue();
+
+    void minRange_data();
+    void minRange();
+
+    void isSaturated_data();
+    void isSaturated();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testreferenceclock.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/referenceclock.h>
+#include "referenceclock_p.h"
+
+#include <QDateTime>
+#include <QSignalSpy>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(ReferenceClock)::Source)
+Q_DECLARE_METATYPE(QVector<QTPOKIT_PREPEND_NAMESPACE(ReferenceClockPrivate)::PtpReading>)
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+void TestReferenceClock::toString_data()
+{
+    QTest::addColumn<ReferenceClock::Source>("source");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(source, expected) \
+        QTest::addRow(#source) << ReferenceClock::Source::source << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(System, "system");
+    DOKIT_ADD_TEST_ROW(Ntp,    "ntp");
+    DOKIT_ADD_TEST_ROW(Ptp,    "ptp");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (ReferenceClock::Source)255 << QString();
+}
+
+void TestReferenceClock::toString()
+{
+    QFETCH(ReferenceClock::Source, source);
+    QFETCH(QString, expected);
+    QCOMPARE(ReferenceClock::toString(source), expected);
+}
+
+void TestReferenceClock::system()
+{
+    ReferenceClock clock;
+    QCOMPARE(clock.source(), ReferenceClock::Source::System);
+    QVERIFY(clock.device().isNull());
+    QVERIFY(clock.errorString().isEmpty());
+    QVERIFY(!clock.status().synchronised);
+    QCOMPARE(clock.status().uncertainty, (qint64)-1);
+
+    QVERIFY(clock.update());
+    QCOMPARE(clock.status().source, ReferenceClock::Source::System);
+    QVERIFY(clock.status().error.isEmpty());
+    QVERIFY(clock.status().updated > 0);
+
+    const qint64 before = QDateTime::currentMSecsSinceEpoch();
+    const ReferenceClock::Timestamp now = clock.now();
+    QVERIFY(now.time >= before);
+    QVERIFY(now.time <= QDateTime::currentMSecsSinceEpoch());
+    QCOMPARE(now.uncertainty, (qint64)-1);
+
+    QVERIFY(clock.setSource(ReferenceClock::Source::System));
+    QVERIFY(!clock.d_func()->timer.isActive());
+}
+
+void TestReferenceClock::updateInterval()
+{
+    ReferenceClock clock;
+    QCOMPARE(clock.updateInterval(), ReferenceClock::defaultUpdateInterval);
+    clock.setUpdateInterval(250);
+    QCOMPARE(clock.updateInterval(), 250);
+}
+
+void TestReferenceClock::setSource_ntp()
+{
+    ReferenceClock clock;
+    #if defined(Q_OS_LINUX)
+    QVERIFY(clock.setSource(ReferenceClock::Source::Ntp));
+    QCOMPARE(clock.source(), ReferenceClock::Source::Ntp);
+    QVERIFY(clock.errorString().isEmpty());
+    QVERIFY(clock.d_func()->timer.isActive());
+
+    // Whether this host is synchronised is beyond the test's control, but the status must be consistent either way.
+    const ReferenceClock::Status status = clock.status();
+    QCOMPARE(status.source, ReferenceClock::Source::Ntp);
+    QCOMPARE(status.offset, (qint64)0);
+    QCOMPARE(status.uncertainty >= 0, status.synchronised);
+    QCOMPARE(clock.now().uncertainty >= 1000, status.synchronised);
+    #else
+    QVERIFY(!clock.setSource(ReferenceClock::Source::Ntp));
+    QCOMPARE(clock.source(), ReferenceClock::Source::System);
+    QVERIFY(!clock.errorString().isEmpty());
+    QVERIFY(!clock.d_func()->timer.isActive());
+    #endif
+
+    QVERIFY(clock.setSource(ReferenceClock::Source::System));
+    QCOMPARE(clock.source(), ReferenceClock::Source::System);
+    QVERIFY(clock.errorString().isEmpty());
+    QVERIFY(!clock.d_func()->timer.isActive());
+    QVERIFY(!clock.status().synchronised);
+}
+
+void TestReferenceClock::setSource_ptp_missing()
+{
+    ReferenceClock clock;
+    QSignalSpy spy(&clock, &ReferenceClock::synchronisedChanged);
+    QVERIFY(!clock.setSource(ReferenceClock::Source::Ptp, u"/nonexistent/ptp0"_s));
+    QCOMPARE(clock.source(), ReferenceClock::Source::System);
+    QVERIFY(clock.device().isEmpty());
+    QVERIFY(!clock.errorString().isEmpty());
+    QCOMPARE(clock.status().error, clock.errorString());
+    QVERIFY(!clock.status().synchronised);
+    QVERIFY(!clock.d_func()->timer.isActive());
+    QCOMPARE(clock.d_func()->fd, -1);
+    QCOMPARE(spy.count(), 0);
+}
+
+void TestReferenceClock::fromPtpReadings_data()
+{
+    using Reading = ReferenceClockPrivate::PtpReading;
+    constexpr qint64 tai = 37; // Seconds.
+    constexpr qint64 taiNs = tai * 1000000000;
+    QTest::addColumn<QVector<Reading>>("readings");
+    QTest::addColumn<qint64>("taiOffset");
+    QTest::addColumn<bool>("synchronised");
+    QTest::addColumn<qint64>("offset");
+    QTest::addColumn<qint64>("uncertainty");
+
+    QTest::addRow("empty") << QVector<Reading>{ } << tai << false << (qint64)0 << (qint64)-1;
+    QTest::addRow("backwards") << QVector<Reading>{ { 10000, taiNs, 5000 } } << tai << false << (qint64)0
+                               << (qint64)-1;
+    QTest::addRow("single") << QVector<Reading>{ { 1000000, taiNs + 1500000, 1002000 } } << tai << true
+                            << (qint64)499 << (qint64)1;
+    QTest::addRow("tightest") << QVector<Reading>{ { 0, taiNs + 100000, 10000 }, { 20000, taiNs + 125000, 22000 },
+                                                   { 30000, taiNs + 200000, 50000 } } << tai << true
+                              << (qint64)104 << (qint64)1;
+    QTest::addRow("rounded") << QVector<Reading>{ { 0, taiNs, 3001 } } << tai << true << (qint64)-2 << (qint64)2;
+    QTest::addRow("behind") << QVector<Reading>{ { 5000000, taiNs, 5000000 } } << tai << true << (qint64)-5000
+                            << (qint64)0;
+}
+
+void TestReferenceClock::fromPtpReadings()
+{
+    QFETCH(QVector<ReferenceClockPrivate::PtpReading>, readings);
+    QFETCH(qint64, taiOffset);
+    QFETCH(bool, synchronised);
+    QFETCH(qint64, offset);
+    QFETCH(qint64, uncertainty);
+    const ReferenceClock::Status status = ReferenceClockPrivate::fromPtpReadings(readings, taiOffset);
+    QCOMPARE(status.source, ReferenceClock::Source::Ptp);
+    QCOMPARE(status.synchronised, synchronised);
+    QCOMPARE(status.error.isEmpty(), synchronised);
+    QCOMPARE(status.offset, offset);
+    QCOMPARE(status.uncertainty, uncertainty);
+}
+
+void TestReferenceClock::toReference_data()
+{
+    QTest::addColumn<bool>("synchronised");
+    QTest::addColumn<qint64>("offset");
+    QTest::addColumn<qint64>("uncertainty");
+    QTest::addColumn<qint64>("systemTime");
+    QTest::addColumn<qint64>("expectedTime");
+    QTest::addColumn<qint64>("expectedUncertainty");
+
+    #define DOKIT_ADD_TEST_ROW(name, synchronised, offset, uncertainty, systemTime, time, expected) \
+        QTest::addRow(name) << synchronised << (qint64)offset << (qint64)uncertainty << (qint64)systemTime \
+            << (qint64)time << (qint64)expected
+    DOKIT_ADD_TEST_ROW("unsynchronised",     false,     0,  -1, 1000, 1000,   -1);
+    DOKIT_ADD_TEST_ROW("unsynchronised+off", false,  3000,  -1, 1000, 1003,   -1);
+    DOKIT_ADD_TEST_ROW("unbounded",          true,      0,  -1, 1000, 1000,   -1);
+    DOKIT_ADD_TEST_ROW("immediate",          true,      0, 250, 1000, 1000, 1250);
+    DOKIT_ADD_TEST_ROW("offset",             true,   2600, 250, 1000, 1003, 1250);
+    DOKIT_ADD_TEST_ROW("negative",           true,  -2400, 250, 1000,  998, 1250);
+    DOKIT_ADD_TEST_ROW("elapsed",            true,      0, 250, 2000, 2000, 1750);
+    DOKIT_ADD_TEST_ROW("before",             true,      0, 250,    0,    0, 1750);
+    DOKIT_ADD_TEST_ROW("partial",            true,      0,   0, 1003, 1003, 1002);
+    #undef DOKIT_ADD_TEST_ROW
+}
+
+void TestReferenceClock::toReference()
+{
+    QFETCH(bool, synchronised);
+    QFETCH(qint64, offset);
+    QFETCH(qint64, uncertainty);
+    QFETCH(qint64, systemTime);
+    QFETCH(qint64, expectedTime);
+    QFETCH(qint64, expectedUncertainty);
+
+    ReferenceClock::Status status;
+    status.synchronised = synchronised;
+    status.offset = offset;
+    status.uncertainty = uncertainty;
+    status.updated = 1000;
+    const ReferenceClock::Timestamp timestamp = ReferenceClockPrivate::toReference(status, systemTime);
+    QCOMPARE(timestamp.time, expectedTime);
+    QCOMPARE(timestamp.uncertainty, expectedUncertainty);
+}
+
+void TestReferenceClock::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    ReferenceClock clock;
+    QVERIFY(!clock.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestReferenceClock))
@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestReferenceClock : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toString_data();
+    void toString();
+
+    void system();
+    void updateInterval();
+
+    void setSource_ntp();
+    void setSource_ptp_missing();
+
+    void fromPtpReadings_data();
+    void fromPtpReadings();
+
+    void toReference_data();
+    void toReference();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
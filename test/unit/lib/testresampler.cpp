@@ -0,0 +1,239 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testresampler.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/resampler.h>
+#include "resampler_p.h"
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+/// Returns all of the rows emitted by \a resampler while invoking \a function, each as "timestamp:value,value...".
+template<typename Func>
+QStringList rowsOf(Resampler &resampler, Func function)
+{
+    QStringList rows;
+    const QMetaObject::Connection connection = QObject::connect(&resampler, &Resampler::rowReady,
+        [&rows](const qint64 timestamp, const QVector<float> &values) {
+            QStringList strings;
+            for (const float value: values) {
+                strings.append(QString::number(value));
+            }
+            rows.append(QString::number(timestamp) + QLatin1Char(':') + strings.join(QLatin1Char(',')));
+        });
+    function();
+    QObject::disconnect(connection);
+    return rows;
+}
+
+}
+
+void TestResampler::defaults()
+{
+    Resampler resampler(2);
+    QCOMPARE(resampler.channelCount(), 2);
+    QCOMPARE(resampler.method(), Resampler::Method::Linear);
+    QCOMPARE(resampler.period(), 1000u);
+    QCOMPARE(resampler.maximumGap(), 0u);
+    QCOMPARE(Resampler(-1).channelCount(), 0);
+}
+
+void TestResampler::setters()
+{
+    Resampler resampler(1);
+    resampler.setMethod(Resampler::Method::Decimate);
+    resampler.setPeriod(250);
+    resampler.setMaximumGap(3000);
+    QCOMPARE(resampler.method(), Resampler::Method::Decimate);
+    QCOMPARE(resampler.period(), 250u);
+    QCOMPARE(resampler.maximumGap(), 3000u);
+
+    resampler.setPeriod(0); // Invalid, so ignored.
+    QCOMPARE(resampler.period(), 250u);
+}
+
+void TestResampler::addSample_linear()
+{
+    Resampler resampler(1);
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.addSample(0, 1.0f, 500); }), QStringList{});
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.addSample(0, 3.0f, 1500); }),
+             QStringList{ u"1000:2"_s });
+    QCOMPARE(rowsOf(resampler, [&resampler]() {
+        resampler.addSample(0, 5.0f, 2500);
+        resampler.addSample(0, 6.0f, 5000); // Interpolated across, since there is no maximum gap.
+    }), QStringList({ u"2000:4"_s, u"3000:5.2"_s, u"4000:5.6"_s, u"5000:6"_s }));
+
+    // Not interpolated across intervals longer than the maximum gap.
+    resampler.setMaximumGap(1500);
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.addSample(0, 8.0f, 7000); }),
+             QStringList({ u"6000:nan"_s, u"7000:8"_s }));
+}
+
+void TestResampler::addSample_hold()
+{
+    Resampler resampler(1);
+    resampler.setMethod(Resampler::Method::Hold);
+    QCOMPARE(rowsOf(resampler, [&resampler]() {
+        resampler.addSample(0, 1.0f, 0);
+        resampler.addSample(0, 3.0f, 1500);
+        resampler.addSample(0, 5.0f, 2000);
+    }), QStringList({ u"0:1"_s, u"1000:1"_s, u"2000:5"_s }));
+
+    // Not held across intervals longer than the maximum gap.
+    resampler.setMaximumGap(1500);
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.addSample(0, 7.0f, 5500); }),
+             QStringList({ u"3000:5"_s, u"4000:nan"_s, u"5000:nan"_s }));
+}
+
+void TestResampler::addSample_decimate()
+{
+    // Each grid time is the average of the samples within half a period either side of it.
+    Resampler resampler(1);
+    resampler.setMethod(Resampler::Method::Decimate);
+    QCOMPARE(rowsOf(resampler, [&resampler]() {
+        resampler.addSample(0, 1.0f, 0);
+        resampler.addSample(0, 3.0f, 400);
+    }), QStringList{}); // The first bin is not yet complete.
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.addSample(0, 5.0f, 600); }), QStringList{ u"0:2"_s });
+    QCOMPARE(rowsOf(resampler, [&resampler]() {
+        resampler.addSample(0, 7.0f, 1200);
+        resampler.addSample(0, 9.0f, 1600);
+        resampler.addSample(0, 9.0f, 3500); // Leaves an empty bin (at 2000).
+    }), QStringList({ u"1000:6"_s, u"2000:9"_s, u"3000:nan"_s }));
+    QCOMPARE(resampler.d_func()->channels.at(0).bins.size(), 1);
+
+    // The maximum gap does not apply to decimation (empty bins are NaN, regardless).
+    resampler.setMaximumGap(1);
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.flush(); }), QStringList{ u"4000:9"_s });
+}
+
+void TestResampler::addSample_channels()
+{
+    Resampler resampler(2);
+    QCOMPARE(rowsOf(resampler, [&resampler]() {
+        resampler.addSample(0,  0.0f,    0);
+        resampler.addSample(0, 10.0f, 1000);
+        resampler.addSample(0, 20.0f, 2000);
+    }), QStringList{}); // Waiting for the second channel.
+    QCOMPARE(resampler.d_func()->channels.at(0).samples.size(), 3);
+
+    // Rows start from the first channel's first sample, but only as far as both channels have reached.
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.addSample(1, 100.0f, 1000); }),
+             QStringList({ u"0:0,nan"_s, u"1000:10,100"_s }));
+    QCOMPARE(resampler.d_func()->channels.at(0).samples.size(), 1); // Trimmed to the samples still needed.
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.addSample(1, 300.0f, 3000); }),
+             QStringList{ u"2000:20,200"_s });
+
+    // Flushing completes the rows as far as the furthest channel.
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.flush(); }), QStringList{ u"3000:nan,300"_s });
+}
+
+void TestResampler::addSample_ignored()
+{
+    Resampler resampler(1);
+    QCOMPARE(rowsOf(resampler, [&resampler]() {
+        resampler.addSample(-1, 1.0f, 1000);
+        resampler.addSample( 1, 1.0f, 1000);
+        resampler.addSample( 0, std::numeric_limits<float>::quiet_NaN(), 1000);
+        resampler.addSample( 0, std::numeric_limits<float>::infinity(), 1000);
+    }), QStringList{});
+    QCOMPARE(resampler.d_func()->channels.at(0).samples.size(), 0);
+
+    resampler.addSample(0, 1.0f, 1500);
+    resampler.addSample(0, 2.0f, 1500); // Not after the previous sample.
+    resampler.addSample(0, 2.0f, 1400);
+    QCOMPARE(resampler.d_func()->channels.at(0).samples.size(), 1);
+    QCOMPARE(resampler.d_func()->channels.at(0).samples.at(0).value, 1.0f);
+}
+
+void TestResampler::addSample_pending()
+{
+    // The second channel never reports, so the first channel's samples are discarded, oldest first.
+    Resampler resampler(2);
+    for (int index = 0; index < Resampler::maxPendingSamples + 10; ++index) {
+        resampler.addSample(0, (float)index, index * 10);
+    }
+    QCOMPARE(resampler.d_func()->channels.at(0).samples.size(), Resampler::maxPendingSamples);
+    QCOMPARE(resampler.d_func()->channels.at(0).samples.constFirst().timestamp, (qint64)100);
+
+    resampler.reset();
+    resampler.setMethod(Resampler::Method::Decimate);
+    resampler.setPeriod(1);
+    for (int index = 0; index < Resampler::maxPendingSamples + 10; ++index) {
+        resampler.addSample(0, (float)index, index);
+    }
+    QCOMPARE(resampler.d_func()->channels.at(0).bins.size(), Resampler::maxPendingSamples);
+    QCOMPARE(resampler.d_func()->channels.at(0).bins.constFirst().index, (qint64)10);
+}
+
+void TestResampler::flush()
+{
+    Resampler resampler(2);
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.flush(); }), QStringList{}); // No samples yet.
+
+    // Flushing does not wait for channels without any samples.
+    resampler.setMethod(Resampler::Method::Hold);
+    resampler.addSample(1, 1.0f, -1500); // Before the epoch.
+    resampler.addSample(1, 2.0f, 500);
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.flush(); }),
+             QStringList({ u"-1000:nan,1"_s, u"0:nan,1"_s }));
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.flush(); }), QStringList{}); // Nothing new.
+}
+
+void TestResampler::reset()
+{
+    Resampler resampler(1);
+    resampler.setMethod(Resampler::Method::Hold);
+    resampler.setPeriod(500);
+    resampler.setMaximumGap(2000);
+    resampler.addSample(0, 1.0f, 1000);
+    resampler.addSample(0, 2.0f, 2000);
+    resampler.reset();
+    QCOMPARE(resampler.d_func()->channels.at(0).samples.size(), 0);
+    QCOMPARE(resampler.d_func()->next, std::numeric_limits<qint64>::min());
+    QCOMPARE(resampler.method(), Resampler::Method::Hold);
+    QCOMPARE(resampler.period(), 500u);
+    QCOMPARE(resampler.maximumGap(), 2000u);
+
+    // Samples before the previous samples are accepted again.
+    QCOMPARE(rowsOf(resampler, [&resampler]() { resampler.addSample(0, 3.0f, 500); }), QStringList{ u"500:3"_s });
+}
+
+void TestResampler::floorDiv_data()
+{
+    QTest::addColumn<qint64>("numerator");
+    QTest::addColumn<qint64>("denominator");
+    QTest::addColumn<qint64>("expected");
+    QTest::addRow("zero")        << (qint64)0     << (qint64)1000 << (qint64)0;
+    QTest::addRow("exact")       << (qint64)2000  << (qint64)1000 << (qint64)2;
+    QTest::addRow("positive")    << (qint64)1999  << (qint64)1000 << (qint64)1;
+    QTest::addRow("negative")    << (qint64)-1    << (qint64)1000 << (qint64)-1;
+    QTest::addRow("negExact")    << (qint64)-1000 << (qint64)1000 << (qint64)-1;
+    QTest::addRow("negPositive") << (qint64)-1001 << (qint64)1000 << (qint64)-2;
+}
+
+void TestResampler::floorDiv()
+{
+    QFETCH(qint64, numerator);
+    QFETCH(qint64, denominator);
+    QFETCH(qint64, expected);
+    QCOMPARE(ResamplerPrivate::floorDiv(numerator, denominator), expected);
+}
+
+void TestResampler::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    Resampler resampler(1);
+    QVERIFY(!resampler.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestResampler))
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestResampler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaults();
+    void setters();
+
+    void addSample_linear();
+    void addSample_hold();
+    void addSample_decimate();
+    void addSample_channels();
+    void addSample_ignored();
+    void addSample_pending();
+
+    void flush();
+    void reset();
+
+    void floorDiv_data();
+    void floorDiv();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
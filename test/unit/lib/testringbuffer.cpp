@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testringbuffer.h"
+
+#include <qtpokit/ringbuffer.h>
+
+#include <QVector>
+
+#include <thread>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestRingBuffer::capacity()
+{
+    QCOMPARE(RingBuffer<int>(1).capacity(), 1u);
+    QCOMPARE(RingBuffer<int>(100).capacity(), 100u);
+    QCOMPARE(RingBuffer<int>(0).capacity(), 1u); // Clamped to at least one.
+}
+
+void TestRingBuffer::policy()
+{
+    QCOMPARE(RingBuffer<int>(1).policy(), RingBuffer<int>::OverflowPolicy::DropOldest);
+    QCOMPARE(RingBuffer<int>(1, RingBuffer<int>::OverflowPolicy::Block).policy(),
+             RingBuffer<int>::OverflowPolicy::Block);
+}
+
+void TestRingBuffer::pushPop()
+{
+    RingBuffer<QVector<qint16>> buffer(4);
+    QVERIFY(buffer.isEmpty());
+    QVector<qint16> value;
+    QVERIFY(!buffer.pop(value));
+
+    buffer.push({ 1, 2 });
+    buffer.push({ 3 });
+    QCOMPARE(buffer.size(), 2u);
+    QVERIFY(!buffer.isEmpty());
+
+    QVERIFY(buffer.pop(value));
+    QCOMPARE(value, QVector<qint16>({ 1, 2 }));
+    QVERIFY(buffer.pop(value));
+    QCOMPARE(value, QVector<qint16>({ 3 }));
+    QVERIFY(!buffer.pop(value));
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.overflowCount(), (quint64)0);
+    QCOMPARE(buffer.droppedCount(), (quint64)0);
+}
+
+void TestRingBuffer::wrapAround()
+{
+    RingBuffer<int> buffer(3);
+    int value = -1;
+    for (int index = 0; index < 100; ++index) {
+        buffer.push(index);
+        buffer.push(index * 2);
+        QVERIFY(buffer.pop(value));
+        QCOMPARE(value, index);
+        QVERIFY(buffer.pop(value));
+        QCOMPARE(value, index * 2);
+    }
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.overflowCount(), (quint64)0);
+}
+
+void TestRingBuffer::dropOldest()
+{
+    RingBuffer<int> buffer(3);
+    for (int index = 1; index <= 5; ++index) {
+        buffer.push(index);
+    }
+    QCOMPARE(buffer.size(), 3u);
+    QCOMPARE(buffer.overflowCount(), (quint64)2);
+    QCOMPARE(buffer.droppedCount(), (quint64)2);
+
+    int value = -1;
+    for (const int expected: { 3, 4, 5 }) {
+        QVERIFY(buffer.pop(value));
+        QCOMPARE(value, expected);
+    }
+    QVERIFY(!buffer.pop(value));
+
+    // Overflow again, after wrapping around.
+    for (int index = 6; index <= 10; ++index) {
+        buffer.push(index);
+    }
+    QCOMPARE(buffer.droppedCount(), (quint64)4);
+    for (const int expected: { 8, 9, 10 }) {
+        QVERIFY(buffer.pop(value));
+        QCOMPARE(value, expected);
+    }
+    QVERIFY(buffer.isEmpty());
+}
+
+void TestRingBuffer::block()
+{
+    RingBuffer<int> buffer(2, RingBuffer<int>::OverflowPolicy::Block);
+    buffer.push(1);
+    buffer.push(2);
+
+    // The next push should block until the consumer pops a value.
+    std::thread producer([&buffer]{ buffer.push(3); });
+    while (buffer.overflowCount() == 0) {
+        std::this_thread::yield();
+    }
+    QCOMPARE(buffer.size(), 2u);
+
+    int value = -1;
+    QVERIFY(buffer.pop(value));
+    QCOMPARE(value, 1);
+    producer.join();
+
+    for (const int expected: { 2, 3 }) {
+        QVERIFY(buffer.pop(value));
+        QCOMPARE(value, expected);
+    }
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.overflowCount(), (quint64)1);
+    QCOMPARE(buffer.droppedCount(), (quint64)0);
+}
+
+void TestRingBuffer::concurrent_data()
+{
+    QTest::addColumn<quint32>("capacity");
+    QTest::addColumn<bool>("block");
+
+    QTest::addRow("tiny/dropOldest")  << 1u    << false;
+    QTest::addRow("small/dropOldest") << 16u   << false;
+    QTest::addRow("large/dropOldest") << 4096u << false;
+    QTest::addRow("tiny/block")       << 1u    << true;
+    QTest::addRow("small/block")      << 16u   << true;
+    QTest::addRow("large/block")      << 4096u << true;
+}
+
+void TestRingBuffer::concurrent()
+{
+    QFETCH(quint32, capacity);
+    QFETCH(bool, block);
+    RingBuffer<quint64> buffer(capacity, block
+        ? RingBuffer<quint64>::OverflowPolicy::Block : RingBuffer<quint64>::OverflowPolicy::DropOldest);
+
+    constexpr quint64 count = 100000;
+    std::thread producer([&buffer]{
+        for (quint64 value = 0; value < count; ++value) {
+            buffer.push(value);
+        }
+        buffer.push(count); // Sentinel.
+    });
+
+    // Values must be popped in strictly increasing order, and (when blocking) without gaps.
+    quint64 popped = 0, value = 0, previous = 0;
+    bool first = true, ordered = true;
+    for (bool done = false; !done;) {
+        if (!buffer.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (!first && value <= previous) {
+            ordered = false;
+        }
+        first = false;
+        previous = value;
+        done = (value == count);
+        popped += done ? 0 : 1;
+    }
+    producer.join();
+
+    QVERIFY(ordered);
+    QVERIFY(buffer.isEmpty());
+    if (block) {
+        QCOMPARE(popped, count);
+        QCOMPARE(buffer.droppedCount(), (quint64)0);
+    } else {
+        QCOMPARE(popped + buffer.droppedCount(), count);
+    }
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestRingBuffer))
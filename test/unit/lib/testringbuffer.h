@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacity();
+    void policy();
+
+    void pushPop();
+    void wrapAround();
+
+    void dropOldest();
+
+    void block();
+
+    void concurrent_data();
+    void concurrent();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsamplecodec.h"
+
+#include <qtpokit/samplecodec.h>
+
+#include <QRandomGenerator>
+
+#include <limits>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestSampleCodec::maxEncodedSize()
+{
+    QCOMPARE(SampleCodec::maxEncodedSize(0), (qsizetype)0);
+    QCOMPARE(SampleCodec::maxEncodedSize(1), (qsizetype)3);
+    QCOMPARE(SampleCodec::maxEncodedSize(1000), (qsizetype)3000);
+}
+
+void TestSampleCodec::encode_data()
+{
+    QTest::addColumn<QVector<qint16>>("samples");
+    QTest::addColumn<qint16>("previous");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("empty")     << QVector<qint16>{ } << (qint16)0 << QByteArray();
+    QTest::addRow("small")     << QVector<qint16>{ 0, 1, -1, 2 } << (qint16)0 << QByteArray::fromHex("00020306");
+    QTest::addRow("twoBytes")  << QVector<qint16>{ 100 } << (qint16)0 << QByteArray::fromHex("c801");
+    QTest::addRow("max")       << QVector<qint16>{ std::numeric_limits<qint16>::max() } << (qint16)0
+                               << QByteArray::fromHex("feff03");
+    QTest::addRow("min")       << QVector<qint16>{ std::numeric_limits<qint16>::min() } << (qint16)0
+                               << QByteArray::fromHex("ffff03");
+    QTest::addRow("ramp")      << QVector<qint16>{ -50, -40, -30, -20 } << (qint16)0
+                               << QByteArray::fromHex("63141414");
+    QTest::addRow("previous")  << QVector<qint16>{ -40, -30 } << (qint16)-50 << QByteArray::fromHex("1414");
+    QTest::addRow("wrapAround") << QVector<qint16>{ std::numeric_limits<qint16>::min() }
+                                << std::numeric_limits<qint16>::max() << QByteArray::fromHex("02");
+}
+
+void TestSampleCodec::encode()
+{
+    QFETCH(QVector<qint16>, samples);
+    QFETCH(qint16, previous);
+    QFETCH(QByteArray, expected);
+    QCOMPARE(SampleCodec::encode(samples, previous), expected);
+}
+
+void TestSampleCodec::encode_raw()
+{
+    // Encoding into a caller-owned buffer should write only the encoded bytes, leaving the rest untouched.
+    const QVector<qint16> samples{ 100, 110, -50 };
+    QByteArray data(SampleCodec::maxEncodedSize(samples.size()) + 1, '\xAA');
+    QCOMPARE(SampleCodec::encode(samples.constData(), samples.size(), data.data()), (qsizetype)5);
+    QCOMPARE(data, QByteArray::fromHex("c80114bf02" "aaaaaaaaaa"));
+
+    // And relative to a given previous value, with nothing to encode writing nothing.
+    QCOMPARE(SampleCodec::encode(samples.constData() + 1, 1, data.data(), 100), (qsizetype)1);
+    QCOMPARE(data.left(1), QByteArray::fromHex("14"));
+    QCOMPARE(SampleCodec::encode(samples.constData(), 0, data.data()), (qsizetype)0);
+}
+
+void TestSampleCodec::decode_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QVector<qint16>>("expected");
+
+    QTest::addRow("empty")    << QByteArray() << QVector<qint16>{ };
+    QTest::addRow("small")    << QByteArray::fromHex("00020306") << QVector<qint16>{ 0, 1, -1, 2 };
+    QTest::addRow("twoBytes") << QByteArray::fromHex("c801") << QVector<qint16>{ 100 };
+    QTest::addRow("extremes") << QByteArray::fromHex("feff03" "02")
+                              << QVector<qint16>{ std::numeric_limits<qint16>::max(),
+                                                  std::numeric_limits<qint16>::min() };
+    QTest::addRow("ramp")     << QByteArray::fromHex("63141414") << QVector<qint16>{ -50, -40, -30, -20 };
+}
+
+void TestSampleCodec::decode()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QVector<qint16>, expected);
+    bool ok = false;
+    QCOMPARE(SampleCodec::decode(data, &ok), expected);
+    QVERIFY(ok);
+}
+
+void TestSampleCodec::decode_invalid_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::addRow("truncated2") << QByteArray::fromHex("0080");
+    QTest::addRow("truncated3") << QByteArray::fromHex("00ff80");
+    QTest::addRow("tooWide")    << QByteArray::fromHex("ffff04");
+}
+
+void TestSampleCodec::decode_invalid()
+{
+    QFETCH(QByteArray, data);
+    bool ok = true;
+    QCOMPARE(SampleCodec::decode(data, &ok), QVector<qint16>{ });
+    QVERIFY(!ok);
+    QCOMPARE(SampleCodec::decode(data), QVector<qint16>{ }); // Without the optional ok argument.
+}
+
+void TestSampleCodec::decode_count()
+{
+    // Decoding exactly count samples returns the number of bytes decoded, ignoring any following bytes.
+    const QByteArray data = QByteArray::fromHex("c80114" "ffff");
+    QVector<qint16> samples(2);
+    QCOMPARE(SampleCodec::decode(data.constData(), data.size(), samples.data(), 2), (qsizetype)3);
+    QCOMPARE(samples, QVector<qint16>({ 100, 110 }));
+
+    // Too few samples available.
+    samples.resize(5);
+    QCOMPARE(SampleCodec::decode(data.constData(), 3, samples.data(), 5), (qsizetype)-1);
+
+    // And relative to a given previous value.
+    QCOMPARE(SampleCodec::decode(data.constData() + 2, 1, samples.data(), 1, -50), (qsizetype)1);
+    QCOMPARE(samples.first(), (qint16)-40);
+}
+
+void TestSampleCodec::decode_runs()
+{
+    // Separately encoded runs, continuing from each previous run's last sample, concatenate into one series.
+    const QVector<qint16> first{ 10, 12, 9 }, second{ 7, 7, 100 };
+    const QByteArray data = SampleCodec::encode(first) + SampleCodec::encode(second, first.last());
+    QCOMPARE(SampleCodec::decode(data), first + second);
+}
+
+void TestSampleCodec::roundTrip()
+{
+    // A slowly varying signal should round-trip exactly, in around one byte per sample.
+    QVector<qint16> samples;
+    qint16 value = 0;
+    for (int index = 0; index < 10000; ++index) {
+        value = (qint16)(value + QRandomGenerator::global()->bounded(-20, 21));
+        samples.append(value);
+    }
+    const QByteArray encoded = SampleCodec::encode(samples);
+    QCOMPARE(encoded.size(), samples.size()); // All deltas fit in one byte.
+    QCOMPARE(SampleCodec::decode(encoded), samples);
+
+    // As should arbitrary samples, in at most three bytes per sample.
+    for (qint16 &sample: samples) {
+        sample = (qint16)QRandomGenerator::global()->bounded(std::numeric_limits<qint16>::min(),
+                                                              std::numeric_limits<qint16>::max() + 1);
+    }
+    const QByteArray random = SampleCodec::encode(samples);
+    QVERIFY(random.size() <= SampleCodec::maxEncodedSize(samples.size()));
+    QCOMPARE(SampleCodec::decode(random), samples);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSampleCodec))
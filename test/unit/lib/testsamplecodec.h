@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSampleCodec : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void maxEncodedSize();
+
+    void encode_data();
+    void encode();
+    void encode_raw();
+
+    void decode_data();
+    void decode();
+
+    void decode_invalid_data();
+    void decode_invalid();
+
+    void decode_count();
+
+    void decode_runs();
+
+    void roundTrip();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsampleexpression.h"
+
+#include <qtpokit/sampleexpression.h>
+
+#include <QtMath>
+
+#include <cmath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestSampleExpression::empty()
+{
+    const SampleExpression expression;
+    QVERIFY(!expression.isValid());
+    QVERIFY(expression.formula().isNull());
+    QVERIFY(expression.variables().isEmpty());
+    QVERIFY(expression.errorString().isEmpty());
+    QCOMPARE(expression.instructionCount(), (qsizetype)0);
+    QVERIFY(qIsNaN(expression.evaluate({ })));
+}
+
+void TestSampleExpression::compile()
+{
+    SampleExpression expression(QStringLiteral("foo"));
+    QVERIFY(!expression.isValid());
+    QVERIFY(expression.compile(QStringLiteral("(a - 0.5) * 40"), { QStringLiteral("a") }));
+    QVERIFY(expression.isValid());
+    QCOMPARE(expression.formula(), QStringLiteral("(a - 0.5) * 40"));
+    QCOMPARE(expression.variables(), QStringList{ QStringLiteral("a") });
+    QVERIFY(expression.errorString().isEmpty());
+    QCOMPARE(expression.instructionCount(), (qsizetype)2);
+    QCOMPARE(expression.evaluate({ 1.5f }), 40.0f);
+
+    // Recompiling replaces the previous program entirely.
+    QVERIFY(!expression.compile(QStringLiteral("a +"), { QStringLiteral("a") }));
+    QVERIFY(!expression.isValid());
+    QCOMPARE(expression.instructionCount(), (qsizetype)0);
+    QVERIFY(qIsNaN(expression.evaluate({ 1.5f })));
+}
+
+void TestSampleExpression::compile_invalid_data()
+{
+    QTest::addColumn<QString>("formula");
+    QTest::addColumn<QString>("expected");
+
+    #define DOKIT_ADD_TEST_ROW(name, formula, error) \
+        QTest::addRow(name) << QStringLiteral(formula) \
+            << QStringLiteral(R"(Invalid expression "%1": %2)").arg(QStringLiteral(formula), QStringLiteral(error))
+    DOKIT_ADD_TEST_ROW("empty",              "",       "Unexpected end of expression");
+    DOKIT_ADD_TEST_ROW("missingOperand",     "1+",     "Unexpected end of expression");
+    DOKIT_ADD_TEST_ROW("missingParenthesis", "(a",     "Unexpected end of expression");
+    DOKIT_ADD_TEST_ROW("missingOperator",    "a b",    "Unexpected character 'b' at position 3");
+    DOKIT_ADD_TEST_ROW("assignment",         "a = b",  "Unexpected character '=' at position 3");
+    DOKIT_ADD_TEST_ROW("invalidCharacter",   "$",      "Unexpected character '$' at position 1");
+    DOKIT_ADD_TEST_ROW("invalidNumber",      "1..2",   "Unexpected character '.' at position 3");
+    DOKIT_ADD_TEST_ROW("unknownVariable",    "foo",    "Unknown variable: foo");
+    DOKIT_ADD_TEST_ROW("unknownFunction",    "foo(1)", "Unknown function: foo");
+    DOKIT_ADD_TEST_ROW("wrongArity",         "min(1)", "Function min takes 2 argument(s), not 1");
+    #undef DOKIT_ADD_TEST_ROW
+
+    const QString deep = QString(SampleExpression::maximumDepth + 1, QLatin1Char('('))
+        + QLatin1Char('1') + QString(SampleExpression::maximumDepth + 1, QLatin1Char(')'));
+    QTest::addRow("tooDeep") << deep
+        << QStringLiteral(R"(Invalid expression "%1": Expression nested more than %2 deep)")
+            .arg(deep).arg(SampleExpression::maximumDepth);
+}
+
+void TestSampleExpression::compile_invalid()
+{
+    QFETCH(QString, formula);
+    QFETCH(QString, expected);
+    SampleExpression expression;
+    QVERIFY(!expression.compile(formula, { QStringLiteral("a"), QStringLiteral("b") }));
+    QVERIFY(!expression.isValid());
+    QCOMPARE(expression.errorString(), expected);
+}
+
+void TestSampleExpression::evaluate_data()
+{
+    QTest::addColumn<QString>("formula");
+    QTest::addColumn<float>("expected");
+    QTest::addColumn<int>("instructions");
+
+    // All rows are evaluated with a = 1.5, and b = 4.
+    #define DOKIT_ADD_TEST_ROW(formula, expected, instructions) \
+        QTest::addRow(formula) << QStringLiteral(formula) << (float)(expected) << (instructions)
+    DOKIT_ADD_TEST_ROW("7",                     7,                 0);
+    DOKIT_ADD_TEST_ROW("a",                     1.5,               0);
+    DOKIT_ADD_TEST_ROW("1+2*3",                 7,                 0);
+    DOKIT_ADD_TEST_ROW("-2^2",                  -4,                0);
+    DOKIT_ADD_TEST_ROW("2^3^2",                 512,               0);
+    DOKIT_ADD_TEST_ROW("10 % 4",                2,                 0);
+    DOKIT_ADD_TEST_ROW("1e-3*1000",             1,                 0);
+    DOKIT_ADD_TEST_ROW("e",                     M_E,               0);
+    DOKIT_ADD_TEST_ROW(".5+b",                  4.5,               1);
+    DOKIT_ADD_TEST_ROW("2*pi*a",                2.0*M_PI*1.5,      1);
+    DOKIT_ADD_TEST_ROW("!a",                    0,                 1);
+    DOKIT_ADD_TEST_ROW("a != b",                1,                 1);
+    DOKIT_ADD_TEST_ROW("a*2+b",                 7,                 2);
+    DOKIT_ADD_TEST_ROW("a - -b",                5.5,               2);
+    DOKIT_ADD_TEST_ROW("abs(-a)",               1.5,               2);
+    DOKIT_ADD_TEST_ROW("sqrt(b)+log10(100)",    4,                 2);
+    DOKIT_ADD_TEST_ROW("max(a,b) > 3.3",        1,                 2);
+    DOKIT_ADD_TEST_ROW("if(a > 1, a, b)",       1.5,               2);
+    DOKIT_ADD_TEST_ROW("clamp(a*10, 0, 12)",    12,                3);
+    DOKIT_ADD_TEST_ROW("a<=b && b>=4 || 0",     1,                 4);
+    #undef DOKIT_ADD_TEST_ROW
+}
+
+void TestSampleExpression::evaluate()
+{
+    QFETCH(QString, formula);
+    QFETCH(float, expected);
+    QFETCH(int, instructions);
+    const SampleExpression expression(formula, { QStringLiteral("a"), QStringLiteral("b") });
+    QVERIFY2(expression.isValid(), qPrintable(expression.errorString()));
+    QCOMPARE(expression.instructionCount(), (qsizetype)instructions);
+    QCOMPARE(expression.evaluate({ 1.5f, 4.0f }), expected);
+}
+
+void TestSampleExpression::evaluate_block()
+{
+    // More than one chunk, and not a multiple of the chunk size, to exercise the final partial chunk.
+    const qsizetype count = SampleExpression::chunkSize * 3 + 17;
+    QVector<float> a(count), b(count), output(count);
+    for (qsizetype index = 0; index < count; ++index) {
+        a[index] = (float)index;
+        b[index] = (float)(index * 2);
+    }
+
+    const SampleExpression expression(QStringLiteral("(a*a + b) / 2 - if(a > 500, 1, 0)"),
+                                      { QStringLiteral("a"), QStringLiteral("b") });
+    QVERIFY2(expression.isValid(), qPrintable(expression.errorString()));
+    expression.evaluate({ a.constData(), b.constData() }, output.data(), count);
+    for (qsizetype index = 0; index < count; ++index) {
+        QCOMPARE(output.at(index), (a.at(index) * a.at(index) + b.at(index)) / 2.0f - ((a.at(index) > 500) ? 1 : 0));
+    }
+
+    // Formulas of just a variable, or a constant, compile to no instructions, but still write every output.
+    const SampleExpression variable(QStringLiteral("b"), { QStringLiteral("a"), QStringLiteral("b") });
+    variable.evaluate({ a.constData(), b.constData() }, output.data(), count);
+    QCOMPARE(output, b);
+
+    const SampleExpression constant(QStringLiteral("3"), { QStringLiteral("a"), QStringLiteral("b") });
+    constant.evaluate({ a.constData(), b.constData() }, output.data(), count);
+    QCOMPARE(output, QVector<float>(count, 3.0f));
+}
+
+void TestSampleExpression::evaluate_inPlace()
+{
+    const qsizetype count = SampleExpression::chunkSize + 1;
+    QVector<float> values(count);
+    for (qsizetype index = 0; index < count; ++index) {
+        values[index] = (float)index;
+    }
+    const SampleExpression expression(QStringLiteral("x*2 + x"), { QStringLiteral("x") });
+    expression.evaluate({ values.constData() }, values.data(), count);
+    for (qsizetype index = 0; index < count; ++index) {
+        QCOMPARE(values.at(index), (float)(index * 3));
+    }
+}
+
+void TestSampleExpression::evaluate_invalid()
+{
+    QVector<float> output(3, 1.0f);
+    const SampleExpression invalid(QStringLiteral("a +"), { QStringLiteral("a") });
+    invalid.evaluate({ output.constData() }, output.data(), output.size());
+    for (const float value: output) {
+        QVERIFY(qIsNaN(value));
+    }
+
+    // Too few values, or inputs, for the expression's variables.
+    const SampleExpression expression(QStringLiteral("a + b"), { QStringLiteral("a"), QStringLiteral("b") });
+    QVERIFY(qIsNaN(expression.evaluate({ 1.0f })));
+    output.fill(1.0f);
+    expression.evaluate({ output.constData() }, output.data(), output.size());
+    QVERIFY(qIsNaN(output.at(0)));
+}
+
+void TestSampleExpression::tr()
+{
+    // Exercise the inline tr() function (added by the Q_DECLARE_TR_FUNCTIONS macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    QVERIFY(!SampleExpression::tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSampleExpression))
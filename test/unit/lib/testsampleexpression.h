@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSampleExpression : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+
+    void compile();
+
+    void compile_invalid_data();
+    void compile_invalid();
+
+    void evaluate_data();
+    void evaluate();
+
+    void evaluate_block();
+    void evaluate_inPlace();
+    void evaluate_invalid();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
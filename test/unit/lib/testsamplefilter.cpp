@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsamplefilter.h"
+
+#include <qtpokit/samplefilter.h>
+#include "samplefilter_p.h"
+
+#include <QSignalSpy>
+#include <QtMath>
+
+#include <complex>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(SampleFilter::Biquad))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+/// Returns the magnitude of \a section's frequency response at \a frequency, for \a sampleRate.
+double gain(const SampleFilter::Biquad &section, const double frequency, const double sampleRate)
+{
+    const std::complex<double> z1 = std::polar(1.0, -2.0 * M_PI * frequency / sampleRate); // ie z⁻¹
+    return std::abs((section.b0 + section.b1 * z1 + section.b2 * z1 * z1) /
+                    (1.0 + section.a1 * z1 + section.a2 * z1 * z1));
+}
+
+/// Returns \a count samples of a unit sine wave at \a frequency, sampled at \a sampleRate.
+QVector<float> sine(const double frequency, const double sampleRate, const qsizetype count)
+{
+    QVector<float> values(count);
+    for (qsizetype index = 0; index < count; ++index) {
+        values[index] = (float)qSin(2.0 * M_PI * frequency * index / sampleRate);
+    }
+    return values;
+}
+
+/// Returns the largest magnitude of \a values, from index \a from onwards.
+float peak(const QVector<float> &values, const qsizetype from)
+{
+    float result = 0.0f;
+    for (qsizetype index = from; index < values.size(); ++index) {
+        result = qMax(result, qAbs(values.at(index)));
+    }
+    return result;
+}
+
+}
+
+void TestSampleFilter::initTestCase()
+{
+    // Register the type used by SampleFilter::samplesFiltered, so QSignalSpy can record its arguments.
+    qRegisterMetaType<QVector<float>>("QVector<float>");
+}
+
+void TestSampleFilter::service()
+{
+    SampleFilter unattached;
+    QVERIFY(unattached.service() == nullptr);
+
+    DsoService dso(nullptr);
+    SampleFilter dsoFilter(&dso);
+    QCOMPARE(dsoFilter.service(), static_cast<AbstractPokitService *>(&dso));
+
+    DataLoggerService logger(nullptr);
+    SampleFilter loggerFilter(&logger);
+    QCOMPARE(loggerFilter.service(), static_cast<AbstractPokitService *>(&logger));
+
+    loggerFilter.d_func()->setService(&dso);
+    QCOMPARE(loggerFilter.service(), static_cast<AbstractPokitService *>(&dso));
+    QVERIFY(!QObject::disconnect(&logger, nullptr, loggerFilter.d_func(), nullptr));
+}
+
+void TestSampleFilter::isEmpty()
+{
+    SampleFilter filter;
+    QVERIFY(filter.isEmpty());
+    QVector<float> values{ 1.0f, -2.0f, 3.5f };
+    filter.process(values);
+    QCOMPARE(values, (QVector<float>{ 1.0f, -2.0f, 3.5f }));
+
+    filter.setFirTaps({ 1.0f });
+    QVERIFY(!filter.isEmpty());
+    filter.setFirTaps({ });
+    filter.setBiquads({ SampleFilter::lowPass(10.0) });
+    QVERIFY(!filter.isEmpty());
+    QCOMPARE(filter.biquads().size(), 1);
+}
+
+void TestSampleFilter::design_data()
+{
+    QTest::addColumn<SampleFilter::Biquad>("section");
+    QTest::addColumn<double>("frequency");
+    QTest::addColumn<double>("expectedGain");
+
+    // Sampled at 1kHz, so the Nyquist frequency is 500Hz.
+    QTest::addRow("low-pass:dc")        << SampleFilter::lowPass(100.0)  <<   0.0 << 1.0;
+    QTest::addRow("low-pass:cutoff")    << SampleFilter::lowPass(100.0)  << 100.0 << M_SQRT1_2;
+    QTest::addRow("low-pass:nyquist")   << SampleFilter::lowPass(100.0)  << 500.0 << 0.0;
+    QTest::addRow("high-pass:dc")       << SampleFilter::highPass(100.0) <<   0.0 << 0.0;
+    QTest::addRow("high-pass:cutoff")   << SampleFilter::highPass(100.0) << 100.0 << M_SQRT1_2;
+    QTest::addRow("high-pass:nyquist")  << SampleFilter::highPass(100.0) << 500.0 << 1.0;
+    QTest::addRow("notch:dc")           << SampleFilter::notch(50.0)     <<   0.0 << 1.0;
+    QTest::addRow("notch:centre")       << SampleFilter::notch(50.0)     <<  50.0 << 0.0;
+    QTest::addRow("notch:nyquist")      << SampleFilter::notch(50.0)     << 500.0 << 1.0;
+    QTest::addRow("custom:passthrough") << SampleFilter::custom(1.0, 0.0, 0.0, 0.0, 0.0) << 123.0 << 1.0;
+    QTest::addRow("custom:half")        << SampleFilter::custom(0.5, 0.0, 0.0, 0.0, 0.0) << 123.0 << 0.5;
+}
+
+void TestSampleFilter::design()
+{
+    QFETCH(SampleFilter::Biquad, section);
+    QFETCH(double, frequency);
+    QFETCH(double, expectedGain);
+    const SampleFilter::Biquad designed = SampleFilter::design(section, 1000.0);
+    QCOMPARE(designed.response, section.response);
+    QCOMPARE(gain(designed, frequency, 1000.0) + 1.0, expectedGain + 1.0); // +1 to fuzzy-compare against zero.
+}
+
+void TestSampleFilter::design_invalid()
+{
+    const auto isPassThrough = [](const SampleFilter::Biquad &section) {
+        return (section.b0 == 1.0) && (section.b1 == 0.0) && (section.b2 == 0.0) && (section.a1 == 0.0) &&
+               (section.a2 == 0.0);
+    };
+    QVERIFY(isPassThrough(SampleFilter::design(SampleFilter::lowPass(100.0), 0.0)));   // Unknown sample rate.
+    QVERIFY(isPassThrough(SampleFilter::design(SampleFilter::lowPass(500.0), 1000.0))); // Not below Nyquist.
+    QVERIFY(isPassThrough(SampleFilter::design(SampleFilter::lowPass(0.0), 1000.0)));
+    QVERIFY(isPassThrough(SampleFilter::design(SampleFilter::notch(50.0, 0.0), 1000.0)));
+
+    // Sections are (re)designed as the sample rate changes, with a warning for those that cannot be designed.
+    SampleFilter filter;
+    filter.setBiquads({ SampleFilter::lowPass(100.0) });
+    QVERIFY(isPassThrough(filter.designed(0)));
+    QTest::ignoreMessage(QtWarningMsg,
+        "Filter section 1 (100Hz) cannot be designed for a 150Hz sample rate; passing samples through instead.");
+    filter.setSampleRate(150.0);
+    QVERIFY(isPassThrough(filter.designed(0)));
+    filter.setSampleRate(1000.0);
+    QVERIFY(!isPassThrough(filter.designed(0)));
+    QCOMPARE(filter.sampleRate(), 1000.0);
+}
+
+void TestSampleFilter::process_fir()
+{
+    // A 4-tap moving average, starting from a zero history.
+    SampleFilter filter;
+    filter.setFirTaps({ 0.25f, 0.25f, 0.25f, 0.25f });
+    QCOMPARE(filter.firTaps().size(), 4);
+    QVector<float> values{ 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+    filter.process(values);
+    QCOMPARE(values, (QVector<float>{ 0.25f, 0.75f, 1.5f, 2.5f, 3.5f, 4.5f }));
+
+    // Asymmetric taps, to verify their order (ie y[n] = h[0]x[n] + h[1]x[n-1]); setting taps clears the history.
+    filter.setFirTaps({ 1.0f, -1.0f });
+    values = { 1.0f, 4.0f, 9.0f };
+    filter.process(values);
+    QCOMPARE(values, (QVector<float>{ 1.0f, 3.0f, 5.0f }));
+}
+
+void TestSampleFilter::process_notch()
+{
+    // 50Hz mains hum should be rejected, while 5Hz passes (almost) unchanged, once the filter has settled.
+    SampleFilter filter;
+    filter.setBiquads({ SampleFilter::notch(50.0) });
+    filter.setSampleRate(1000.0);
+    QVector<float> hum = sine(50.0, 1000.0, 2000);
+    filter.process(hum);
+    QVERIFY2(peak(hum, 1000) < 0.01f, qPrintable(QString::number(peak(hum, 1000))));
+
+    filter.reset();
+    QVector<float> signal = sine(5.0, 1000.0, 2000);
+    filter.process(signal);
+    QVERIFY2(peak(signal, 1000) > 0.99f, qPrintable(QString::number(peak(signal, 1000))));
+}
+
+void TestSampleFilter::process_chunked()
+{
+    // Filtering in chunks of any size must give exactly the same result as filtering all at once.
+    const QVector<float> input = sine(37.0, 1000.0, 257);
+    const auto configure = [](SampleFilter &filter) {
+        filter.setFirTaps({ 0.1f, 0.2f, 0.4f, 0.2f, 0.1f });
+        filter.setBiquads({ SampleFilter::highPass(5.0), SampleFilter::lowPass(120.0, 0.9) });
+        filter.setSampleRate(1000.0);
+    };
+
+    SampleFilter whole;
+    configure(whole);
+    QVector<float> expected = input;
+    whole.process(expected);
+
+    for (const qsizetype chunkSize: { 1, 3, 10, 64, 300 }) {
+        SampleFilter chunked;
+        configure(chunked);
+        QVector<float> actual = input;
+        for (qsizetype offset = 0; offset < actual.size(); offset += chunkSize) {
+            chunked.process(actual.data() + offset, qMin(chunkSize, actual.size() - offset));
+        }
+        QCOMPARE(actual, expected);
+    }
+}
+
+void TestSampleFilter::reset()
+{
+    SampleFilter filter;
+    filter.setFirTaps({ 0.5f, 0.5f });
+    filter.setBiquads({ SampleFilter::lowPass(10.0) });
+    filter.setSampleRate(100.0);
+    QVector<float> values{ 100.0f, 100.0f };
+    filter.process(values);
+
+    filter.reset();
+    values = { 0.0f, 0.0f, 0.0f };
+    filter.process(values);
+    QCOMPARE(values, (QVector<float>{ 0.0f, 0.0f, 0.0f })); // No ringing from before the reset.
+}
+
+void TestSampleFilter::samplesRead_dso()
+{
+    SampleFilter filter;
+    filter.setFirTaps({ 0.5f, 0.5f });
+    QSignalSpy spy(&filter, &SampleFilter::samplesFiltered);
+
+    filter.d_func()->dsoMetadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage, 0, 0, 4, 1000 });
+    QCOMPARE(filter.sampleRate(), 1000.0);
+    filter.d_func()->samplesRead({ 2, 4 });
+    filter.d_func()->samplesRead({ 6, 8 }); // State continues across notifications.
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(0).value<QVector<float>>(), (QVector<float>{ 0.5f, 1.5f }));
+    QCOMPARE(spy.at(1).at(0).value<QVector<float>>(), (QVector<float>{ 2.5f, 3.5f }));
+
+    // A new capture starts afresh.
+    filter.d_func()->dsoMetadataRead({ DsoService::DsoStatus::Done, 1.0f, DsoService::Mode::DcVoltage, 0, 0, 2, 500 });
+    QCOMPARE(filter.sampleRate(), 500.0);
+    filter.d_func()->samplesRead({ 2, 4 });
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(2).at(0).value<QVector<float>>(), (QVector<float>{ 1.0f, 3.0f }));
+}
+
+void TestSampleFilter::samplesRead_logger()
+{
+    SampleFilter filter;
+    QSignalSpy spy(&filter, &SampleFilter::samplesFiltered);
+    filter.d_func()->loggerMetadataRead({ DataLoggerService::LoggerStatus::Done, 0.25f,
+        DataLoggerService::Mode::DcVoltage, 0, 100, 3, 0 });
+    QCOMPARE(filter.sampleRate(), 10.0); // One sample every 100ms.
+    filter.d_func()->samplesRead({ 4, -8, 12 });
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<QVector<float>>(), (QVector<float>{ 1.0f, -2.0f, 3.0f }));
+
+    filter.d_func()->loggerMetadataRead({ DataLoggerService::LoggerStatus::Done, 0.25f,
+        DataLoggerService::Mode::DcVoltage, 0, 0, 3, 0 });
+    QCOMPARE(filter.sampleRate(), 0.0);
+}
+
+void TestSampleFilter::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    SampleFilter filter;
+    QVERIFY(!filter.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSampleFilter))
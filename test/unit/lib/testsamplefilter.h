@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSampleFilter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void service();
+
+    void isEmpty();
+
+    void design_data();
+    void design();
+    void design_invalid();
+
+    void process_fir();
+    void process_notch();
+    void process_chunked();
+
+    void reset();
+
+    void samplesRead_dso();
+    void samplesRead_logger();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
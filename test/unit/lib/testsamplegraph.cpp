@@ -0,0 +1,348 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsamplegraph.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/samplegraph.h>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(SampleGraph)::Stage)
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+/// A single block emitted by a sink.
+struct Emitted {
+    QString sink;             ///< Name of the sink that emitted the block.
+    SampleGraph::Block block; ///< The emitted block.
+};
+
+/// Returns all of the blocks emitted by \a graph's sinks while invoking \a function.
+template<typename Func>
+QVector<Emitted> blocksOf(SampleGraph &graph, Func function)
+{
+    QVector<Emitted> blocks;
+    const QMetaObject::Connection connection = QObject::connect(&graph, &SampleGraph::blockReady,
+        [&blocks](const QString &sink, const SampleGraph::Block &block) { blocks.append({ sink, block }); });
+    function();
+    QObject::disconnect(connection);
+    return blocks;
+}
+
+}
+
+void TestSampleGraph::toString_data()
+{
+    QTest::addColumn<SampleGraph::Stage>("stage");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(stage, expected) \
+        QTest::addRow(#stage) << SampleGraph::Stage::stage << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(Source,     "source");
+    DOKIT_ADD_TEST_ROW(Filter,     "filter");
+    DOKIT_ADD_TEST_ROW(Aggregate,  "aggregate");
+    DOKIT_ADD_TEST_ROW(Detect,     "detect");
+    DOKIT_ADD_TEST_ROW(Resample,   "resample");
+    DOKIT_ADD_TEST_ROW(Sink,       "sink");
+    DOKIT_ADD_TEST_ROW(Expression, "expression");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (SampleGraph::Stage)255 << QString();
+}
+
+void TestSampleGraph::toString()
+{
+    QFETCH(SampleGraph::Stage, stage);
+    QFETCH(QString, expected);
+    QCOMPARE(SampleGraph::toString(stage), expected);
+}
+
+void TestSampleGraph::defaults()
+{
+    const SampleGraph graph;
+    QCOMPARE(SampleGraph::sourceName(), u"source"_s);
+    QCOMPARE(graph.stageNames(), QStringList{ u"source"_s });
+    const QVector<SampleGraph::StageStatistics> statistics = graph.statistics();
+    QCOMPARE(statistics.size(), 1);
+    QCOMPARE(statistics.at(0).name, u"source"_s);
+    QCOMPARE(statistics.at(0).stage, SampleGraph::Stage::Source);
+    QCOMPARE(statistics.at(0).inputs, QStringList{});
+    QCOMPARE(statistics.at(0).blocksIn, (quint64)0);
+    QCOMPARE(statistics.at(0).throughput, 0.0);
+}
+
+void TestSampleGraph::addStage_invalid()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addSink(u"out"_s, { }));
+    QVERIFY(!graph.addSink(u"out"_s, { }));                         // Duplicate name.
+    QVERIFY(!graph.addSink(u"source"_s, { }));                      // Duplicate name.
+    QVERIFY(!graph.addSink(QString(), { }));                        // Empty name.
+    QVERIFY(!graph.addFilter(u"lp"_s, { u"missing"_s }, { }));      // Unknown input.
+    QVERIFY(!graph.addFilter(u"lp"_s, { u"out"_s }, { }));          // Sinks pass nothing on.
+    QVERIFY(!graph.addAggregator(u"mean"_s, { }, 0));               // Invalid period.
+    QVERIFY(!graph.addResampler(u"grid"_s, { }, 0));                // Invalid period.
+    QVERIFY(!graph.addDetector(u"high"_s, { }, { EventDetector::Quantity::Value, EventDetector::Direction::Above,
+                                                 qQNaN(), 0.0f, 0 })); // Invalid threshold.
+    QVERIFY(!graph.addExpression(u"x"_s, { }, u"foo + 1"_s));                         // Unknown variable.
+    QVERIFY(!graph.addExpression(u"x"_s, { u"source"_s, u"source"_s }, u"source"_s)); // Repeated input.
+    QVERIFY(!graph.addExpression(u"x"_s, { u"missing"_s }, u"missing"_s));            // Unknown input.
+    QCOMPARE(graph.stageNames(), QStringList({ u"source"_s, u"out"_s }));
+}
+
+void TestSampleGraph::fanOut()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addSink(u"a"_s, { }));
+    QVERIFY(graph.addSink(u"b"_s, { u"source"_s, u"source"_s })); // Duplicate inputs are only connected once.
+    const SampleGraph::Block block{ 1000, 10.0, { 1.0f, 2.0f, 3.0f } };
+    const QVector<Emitted> blocks = blocksOf(graph, [&graph, &block]() { graph.addBlock(block); });
+    QCOMPARE(blocks.size(), 2);
+    QCOMPARE(blocks.at(0).sink, u"a"_s);
+    QCOMPARE(blocks.at(1).sink, u"b"_s);
+    for (const Emitted &emitted: blocks) {
+        QCOMPARE(emitted.block.timestamp, (qint64)1000);
+        QCOMPARE(emitted.block.interval, 10.0);
+        QCOMPARE(emitted.block.values.constData(), block.values.constData()); // Shared, not copied.
+    }
+
+    // Empty blocks are ignored.
+    QCOMPARE(blocksOf(graph, [&graph]() { graph.addBlock({ 0, 0.0, { } }); }).size(), 0);
+}
+
+void TestSampleGraph::filter()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addFilter(u"avg"_s, { }, { }, { 0.5f, 0.5f }));
+    QVERIFY(graph.addSink(u"out"_s, { u"avg"_s }));
+    const SampleGraph::Block block{ 0, 1.0, { 2.0f, 4.0f, 6.0f } };
+    QVector<Emitted> blocks = blocksOf(graph, [&graph, &block]() { graph.addBlock(block); });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>({ 1.0f, 3.0f, 5.0f }));
+    QVERIFY(blocks.at(0).block.values.constData() != block.values.constData());
+    QCOMPARE(block.values, QVector<float>({ 2.0f, 4.0f, 6.0f })); // Input left unchanged.
+
+    // The filter's state carries on across blocks.
+    blocks = blocksOf(graph, [&graph]() { graph.addBlock({ 3, 1.0, { 8.0f } }); });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)3);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>{ 7.0f });
+}
+
+void TestSampleGraph::aggregate()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addAggregator(u"mean"_s, { }, 1000));
+    QVERIFY(graph.addSink(u"out"_s, { u"mean"_s }));
+    QVector<Emitted> blocks = blocksOf(graph, [&graph]() {
+        graph.addBlock({ 0, 250.0, { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f } });
+    });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)0);
+    QCOMPARE(blocks.at(0).block.interval, 1000.0);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>({ 2.5f, 6.5f }));
+
+    // The open window is passed on once a value beyond it is received, even after a gap.
+    blocks = blocksOf(graph, [&graph]() { graph.addBlock({ 5000, 0.0, { 1.0f } }); });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)2000);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>{ 9.0f });
+    blocks = blocksOf(graph, [&graph]() { graph.addBlock({ 5500, 0.0, { 3.0f } }); });
+    QCOMPARE(blocks.size(), 0);
+}
+
+void TestSampleGraph::detect()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addDetector(u"high"_s, { }, { EventDetector::Quantity::Value, EventDetector::Direction::Above,
+                                                1.0f, 0.0f, 0 }));
+    QVERIFY(graph.addSink(u"out"_s, { u"high"_s }));
+    QVector<EventDetector::Event> events;
+    connect(&graph, &SampleGraph::eventFinished, this,
+        [&events](const QString &detector, const EventDetector::Event &event) {
+            QCOMPARE(detector, u"high"_s);
+            events.append(event);
+        });
+
+    QVector<Emitted> blocks = blocksOf(graph, [&graph]() {
+        graph.addBlock({ 0, 10.0, { 0.0f, 2.0f, 3.0f, 0.0f, 5.0f } });
+    });
+    QCOMPARE(blocks.size(), 2);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)10);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>({ 2.0f, 3.0f }));
+    QCOMPARE(blocks.at(1).block.timestamp, (qint64)40);
+    QCOMPARE(blocks.at(1).block.values, QVector<float>{ 5.0f });
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.at(0).start, (qint64)10);
+    QCOMPARE(events.at(0).end, (qint64)20);
+    QCOMPARE(events.at(0).peak, 3.0f);
+    QCOMPARE(events.at(0).count, (quint64)2);
+
+    // Blocks wholly within an event are passed on as-is.
+    const SampleGraph::Block block{ 50, 10.0, { 6.0f, 7.0f } };
+    blocks = blocksOf(graph, [&graph, &block]() { graph.addBlock(block); });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.values.constData(), block.values.constData());
+
+    graph.flush();
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events.at(1).start, (qint64)40);
+    QCOMPARE(events.at(1).end, (qint64)60);
+    QCOMPARE(events.at(1).peak, 7.0f);
+    QCOMPARE(events.at(1).count, (quint64)3);
+}
+
+void TestSampleGraph::resample()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addResampler(u"grid"_s, { }, 1000));
+    QVERIFY(graph.addSink(u"out"_s, { u"grid"_s }));
+    QVector<Emitted> blocks = blocksOf(graph, [&graph]() { graph.addBlock({ 500, 1000.0, { 1.0f, 3.0f } }); });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)1000);
+    QCOMPARE(blocks.at(0).block.interval, 1000.0);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>{ 2.0f });
+
+    blocks = blocksOf(graph, [&graph]() { graph.addBlock({ 2500, 0.0, { 5.0f } }); });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)2000);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>{ 4.0f });
+}
+
+void TestSampleGraph::expression()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addExpression(u"scaled"_s, { }, u"source * 2 + 1"_s));
+    QVERIFY(graph.addFilter(u"avg"_s, { }, { }, { 0.5f, 0.5f }));
+    QVERIFY(graph.addExpression(u"diff"_s, { u"source"_s, u"avg"_s }, u"source - avg"_s));
+    QVERIFY(graph.addSink(u"a"_s, { u"scaled"_s }));
+    QVERIFY(graph.addSink(u"b"_s, { u"diff"_s }));
+    const SampleGraph::Block block{ 0, 1.0, { 2.0f, 4.0f, 6.0f } };
+    QVector<Emitted> blocks = blocksOf(graph, [&graph, &block]() { graph.addBlock(block); });
+    QCOMPARE(blocks.size(), 2);
+    QCOMPARE(blocks.at(0).sink, u"a"_s);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)0);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>({ 5.0f, 9.0f, 13.0f }));
+    QCOMPARE(blocks.at(1).sink, u"b"_s);
+    QCOMPARE(blocks.at(1).block.timestamp, (qint64)0);
+    QCOMPARE(blocks.at(1).block.values, QVector<float>({ 1.0f, 1.0f, 1.0f }));
+    QCOMPARE(block.values, QVector<float>({ 2.0f, 4.0f, 6.0f })); // Input left unchanged.
+
+    // Values are paired up across blocks, with timestamps following the first input.
+    blocks = blocksOf(graph, [&graph]() { graph.addBlock({ 3, 1.0, { 8.0f } }); });
+    QCOMPARE(blocks.size(), 2);
+    QCOMPARE(blocks.at(1).block.timestamp, (qint64)3);
+    QCOMPARE(blocks.at(1).block.values, QVector<float>{ 1.0f });
+    const QVector<SampleGraph::StageStatistics> statistics = graph.statistics();
+    QCOMPARE(statistics.at(3).stage, SampleGraph::Stage::Expression);
+    QCOMPARE(statistics.at(3).inputs, QStringList({ u"source"_s, u"avg"_s }));
+    QCOMPARE(statistics.at(3).queueDepth, (qint64)0);
+    QCOMPARE(statistics.at(3).peakQueueDepth, (qint64)3); // The filter's values, awaiting the source's.
+}
+
+void TestSampleGraph::addValue()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addSink(u"out"_s, { }));
+    QVector<Emitted> blocks = blocksOf(graph, [&graph]() { graph.addValue(1.5f, 1000, 100.0); });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)1000);
+    QCOMPARE(blocks.at(0).block.interval, 100.0);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>{ 1.5f });
+
+    blocks = blocksOf(graph, [&graph]() {
+        graph.addSamples(DsoService::Samples{ 1, 2, 3 }, 0.5f, 2000, 1.0);
+        graph.addSamples(DsoService::Samples{ }, 0.5f, 3000, 1.0); // Ignored.
+    });
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)2000);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>({ 0.5f, 1.0f, 1.5f }));
+}
+
+void TestSampleGraph::statistics()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addAggregator(u"mean"_s, { }, 1000));
+    QVERIFY(graph.addSink(u"out"_s, { u"mean"_s }));
+    graph.addBlock({ 0, 250.0, { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f } });
+
+    const QVector<SampleGraph::StageStatistics> statistics = graph.statistics();
+    QCOMPARE(statistics.size(), 3);
+    QCOMPARE(statistics.at(0).blocksIn, (quint64)1);
+    QCOMPARE(statistics.at(0).valuesIn, (quint64)5);
+    QCOMPARE(statistics.at(0).blocksOut, (quint64)1);
+    QCOMPARE(statistics.at(0).valuesOut, (quint64)5);
+    QCOMPARE(statistics.at(0).queueDepth, (qint64)0);
+
+    QCOMPARE(statistics.at(1).name, u"mean"_s);
+    QCOMPARE(statistics.at(1).stage, SampleGraph::Stage::Aggregate);
+    QCOMPARE(statistics.at(1).inputs, QStringList{ u"source"_s });
+    QCOMPARE(statistics.at(1).blocksIn, (quint64)1);
+    QCOMPARE(statistics.at(1).valuesIn, (quint64)5);
+    QCOMPARE(statistics.at(1).blocksOut, (quint64)1);
+    QCOMPARE(statistics.at(1).valuesOut, (quint64)1);
+    QCOMPARE(statistics.at(1).queueDepth, (qint64)1);     // The second window's first value.
+    QCOMPARE(statistics.at(1).peakQueueDepth, (qint64)1);
+
+    QCOMPARE(statistics.at(2).name, u"out"_s);
+    QCOMPARE(statistics.at(2).stage, SampleGraph::Stage::Sink);
+    QCOMPARE(statistics.at(2).inputs, QStringList{ u"mean"_s });
+    QCOMPARE(statistics.at(2).blocksIn, (quint64)1);
+    QCOMPARE(statistics.at(2).valuesIn, (quint64)1);
+    QCOMPARE(statistics.at(2).blocksOut, (quint64)1);
+    QCOMPARE(statistics.at(2).valuesOut, (quint64)1);
+
+    for (const SampleGraph::StageStatistics &stage: statistics) {
+        QVERIFY(stage.busyTime >= 0);
+        QVERIFY(stage.throughput >= 0.0);
+    }
+}
+
+void TestSampleGraph::flush()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addAggregator(u"mean"_s, { }, 1000));
+    QVERIFY(graph.addAggregator(u"slow"_s, { u"mean"_s }, 10'000));
+    QVERIFY(graph.addSink(u"out"_s, { u"mean"_s, u"slow"_s }));
+    graph.addBlock({ 0, 500.0, { 1.0f, 3.0f, 5.0f } });
+
+    // Each stage is flushed after its inputs, so the slow window includes the mean window's final value.
+    const QVector<Emitted> blocks = blocksOf(graph, [&graph]() { graph.flush(); });
+    QCOMPARE(blocks.size(), 2);
+    QCOMPARE(blocks.at(0).block.timestamp, (qint64)1000);
+    QCOMPARE(blocks.at(0).block.values, QVector<float>{ 5.0f });
+    QCOMPARE(blocks.at(1).block.timestamp, (qint64)0);
+    QCOMPARE(blocks.at(1).block.interval, 10'000.0);
+    QCOMPARE(blocks.at(1).block.values, QVector<float>{ 3.5f });
+    for (const SampleGraph::StageStatistics &stage: graph.statistics()) {
+        QCOMPARE(stage.queueDepth, (qint64)0);
+    }
+
+    // Nothing left to flush.
+    QCOMPARE(blocksOf(graph, [&graph]() { graph.flush(); }).size(), 0);
+}
+
+void TestSampleGraph::reset()
+{
+    SampleGraph graph;
+    QVERIFY(graph.addAggregator(u"mean"_s, { }, 1000));
+    QVERIFY(graph.addSink(u"out"_s, { u"mean"_s }));
+    graph.addBlock({ 0, 500.0, { 1.0f } });
+    QCOMPARE(graph.statistics().at(1).queueDepth, (qint64)1);
+    graph.reset();
+    QCOMPARE(graph.statistics().at(1).queueDepth, (qint64)0);
+    QCOMPARE(graph.statistics().at(1).valuesIn, (quint64)1); // Statistics are retained.
+    QCOMPARE(blocksOf(graph, [&graph]() { graph.flush(); }).size(), 0);
+}
+
+void TestSampleGraph::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    SampleGraph graph;
+    QVERIFY(!graph.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSampleGraph))
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSampleGraph : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toString_data();
+    void toString();
+
+    void defaults();
+    void addStage_invalid();
+
+    void fanOut();
+    void filter();
+    void aggregate();
+    void detect();
+    void resample();
+    void expression();
+    void addValue();
+
+    void statistics();
+    void flush();
+    void reset();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsamplehistogram.h"
+
+#include <qtpokit/samplehistogram.h>
+
+#include <QtMath>
+
+#include <cmath>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestSampleHistogram::empty()
+{
+    const SampleHistogram histogram(0.0f, 10.0f, 1.0f);
+    QVERIFY(histogram.isEmpty());
+    QCOMPARE(histogram.count(), (quint64)0);
+    QCOMPARE(histogram.minimum(), 0.0f);
+    QCOMPARE(histogram.maximum(), 0.0f);
+    QVERIFY(std::isnan(histogram.mean()));
+    QVERIFY(qIsNaN(histogram.percentile(50.0)));
+    QCOMPARE(histogram.binTotal(0), (quint64)0);
+}
+
+void TestSampleHistogram::bins_data()
+{
+    QTest::addColumn<float>("lowerBound");
+    QTest::addColumn<float>("upperBound");
+    QTest::addColumn<float>("resolution");
+    QTest::addColumn<float>("expectedLowerBound");
+    QTest::addColumn<float>("expectedWidth");
+    QTest::addColumn<int>("expectedCount");
+    QTest::addRow("exact")     << 0.0f <<    10.0f << 1.0f << 0.0f << 1.0f << 10;
+    QTest::addRow("partial")   << 0.0f <<    10.5f << 1.0f << 0.0f << 1.0f << 11;
+    QTest::addRow("negative")  << -5.0f <<    5.0f << 0.5f << -5.0f << 0.5f << 20;
+    QTest::addRow("widened")   << 0.0f << 10000.0f << 1.0f << 0.0f << 4.0f << 2500;
+    QTest::addRow("noWidth")   << 0.0f <<  4096.0f << 0.0f << 0.0f << 1.0f << 4096;
+    QTest::addRow("noSpan")    << 5.0f <<     5.0f << 1.0f << 5.0f << 1.0f << 1;
+    QTest::addRow("inverted")  << 5.0f <<     0.0f << 1.0f << 5.0f << 1.0f << 1;
+    QTest::addRow("nanBounds") << qQNaN() << qQNaN() << 1.0f << 0.0f << 1.0f << 1;
+}
+
+void TestSampleHistogram::bins()
+{
+    QFETCH(float, lowerBound);
+    QFETCH(float, upperBound);
+    QFETCH(float, resolution);
+    QFETCH(float, expectedLowerBound);
+    QFETCH(float, expectedWidth);
+    QFETCH(int, expectedCount);
+    const SampleHistogram histogram(lowerBound, upperBound, resolution);
+    QCOMPARE(histogram.lowerBound(), expectedLowerBound);
+    QCOMPARE(histogram.binWidth(), expectedWidth);
+    QCOMPARE(histogram.binCount(), expectedCount);
+    QVERIFY(histogram.binCount() <= SampleHistogram::maxBinCount);
+}
+
+void TestSampleHistogram::forScale()
+{
+    // A 16-bit range of 0.5 resolution needs 65,536 bins, so is widened (16 times) to 4,096 bins.
+    const SampleHistogram histogram = SampleHistogram::forScale(0.5f);
+    QCOMPARE(histogram.lowerBound(), -16384.0f);
+    QCOMPARE(histogram.binWidth(), 8.0f);
+    QCOMPARE(histogram.binCount(), SampleHistogram::maxBinCount);
+    QCOMPARE(histogram.binIndex(-16384.0f), 0);
+    QCOMPARE(histogram.binIndex(16383.5f), SampleHistogram::maxBinCount - 1);
+
+    // A negative scale spans the same (mirrored) range.
+    const SampleHistogram mirrored = SampleHistogram::forScale(-0.5f);
+    QCOMPARE(mirrored.lowerBound(), -16383.5f);
+    QCOMPARE(mirrored.binWidth(), 8.0f);
+    QCOMPARE(mirrored.binCount(), SampleHistogram::maxBinCount);
+}
+
+void TestSampleHistogram::binIndex_data()
+{
+    QTest::addColumn<float>("value");
+    QTest::addColumn<int>("expected");
+    QTest::addRow("below")     << -1.0f <<  0;
+    QTest::addRow("lower")     <<  0.0f <<  0;
+    QTest::addRow("firstTop")  << 0.99f <<  0;
+    QTest::addRow("second")    <<  1.0f <<  1;
+    QTest::addRow("last")      <<  9.5f <<  9;
+    QTest::addRow("upper")     << 10.0f <<  9;
+    QTest::addRow("above")     << 100.0f << 9;
+    QTest::addRow("-infinity") << -(float)qInf() << 0;
+    QTest::addRow("+infinity") << (float)qInf() << 9;
+}
+
+void TestSampleHistogram::binIndex()
+{
+    QFETCH(float, value);
+    QFETCH(int, expected);
+    const SampleHistogram histogram(0.0f, 10.0f, 1.0f);
+    QCOMPARE(histogram.binIndex(value), expected);
+}
+
+void TestSampleHistogram::add()
+{
+    SampleHistogram histogram(0.0f, 10.0f, 1.0f);
+    for (const float value: { 2.5f, 1.5f, 2.0f, qQNaN(), 20.0f }) {
+        histogram.add(value);
+    }
+    QVERIFY(!histogram.isEmpty());
+    QCOMPARE(histogram.count(), (quint64)4);
+    QCOMPARE(histogram.minimum(), 1.5f);
+    QCOMPARE(histogram.maximum(), 20.0f);
+    QCOMPARE(histogram.mean(), 6.5);
+    QCOMPARE(histogram.binTotal(1), (quint64)1);
+    QCOMPARE(histogram.binTotal(2), (quint64)2);
+    QCOMPARE(histogram.binTotal(9), (quint64)1); // Beyond the upper bound.
+    QCOMPARE(histogram.binTotal(-1), (quint64)0);
+    QCOMPARE(histogram.binTotal(10), (quint64)0);
+}
+
+void TestSampleHistogram::percentile_data()
+{
+    QTest::addColumn<double>("percent");
+    QTest::addColumn<float>("expected");
+    QTest::addRow("0")   <<   0.0 << 0.5f;
+    QTest::addRow("10")  <<  10.0 << 1.0f;
+    QTest::addRow("50")  <<  50.0 << 5.0f;
+    QTest::addRow("90")  <<  90.0 << 9.0f;
+    QTest::addRow("95")  <<  95.0 << 9.5f; // The last bin, so the maximum.
+    QTest::addRow("100") << 100.0 << 9.5f;
+    QTest::addRow("200") << 200.0 << 9.5f;
+}
+
+void TestSampleHistogram::percentile()
+{
+    QFETCH(double, percent);
+    QFETCH(float, expected);
+    SampleHistogram histogram(0.0f, 10.0f, 1.0f);
+    for (int index = 9; index >= 0; --index) {
+        histogram.add(index + 0.5f);
+    }
+    QCOMPARE(histogram.percentile(percent), expected);
+}
+
+void TestSampleHistogram::merge()
+{
+    SampleHistogram first(0.0f, 100.0f, 1.0f), second(0.0f, 100.0f, 1.0f), empty(0.0f, 100.0f, 1.0f);
+    first.add(1.0f);
+    first.add(2.0f);
+    second.add(3.0f);
+    second.add(50.0f);
+
+    SampleHistogram merged(0.0f, 100.0f, 1.0f);
+    QVERIFY(merged.merge(empty));
+    QVERIFY(merged.isEmpty());
+    QVERIFY(merged.merge(first));
+    QCOMPARE(merged.count(), (quint64)2);
+    QCOMPARE(merged.percentile(50.0), 2.0f);
+    QVERIFY(merged.merge(second));
+    QVERIFY(merged.merge(empty));
+    QCOMPARE(merged.count(), (quint64)4);
+    QCOMPARE(merged.minimum(), 1.0f);
+    QCOMPARE(merged.maximum(), 50.0f);
+    QCOMPARE(merged.mean(), 14.0);
+    QCOMPARE(merged.binTotal(3), (quint64)1);
+    QCOMPARE(merged.percentile(75.0), 4.0f);
+
+    // Histograms with different bins cannot be merged.
+    QVERIFY(!merged.merge(SampleHistogram(0.0f, 100.0f, 2.0f)));
+    QVERIFY(!merged.merge(SampleHistogram(1.0f, 101.0f, 1.0f)));
+    QVERIFY(!merged.merge(SampleHistogram(0.0f, 200.0f, 1.0f)));
+    QCOMPARE(merged.count(), (quint64)4);
+}
+
+void TestSampleHistogram::reset()
+{
+    SampleHistogram histogram(0.0f, 10.0f, 1.0f);
+    histogram.add(5.0f);
+    histogram.reset();
+    QVERIFY(histogram.isEmpty());
+    QCOMPARE(histogram.count(), (quint64)0);
+    QCOMPARE(histogram.binTotal(5), (quint64)0);
+    QVERIFY(qIsNaN(histogram.percentile(50.0)));
+    QVERIFY(std::isnan(histogram.mean()));
+
+    histogram.add(7.0f);
+    QCOMPARE(histogram.count(), (quint64)1);
+    QCOMPARE(histogram.minimum(), 7.0f);
+    QCOMPARE(histogram.maximum(), 7.0f);
+    QCOMPARE(histogram.percentile(99.0), 7.0f);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSampleHistogram))
@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSampleHistogram : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+
+    void bins_data();
+    void bins();
+
+    void forScale();
+
+    void binIndex_data();
+    void binIndex();
+
+    void add();
+
+    void percentile_data();
+    void percentile();
+
+    void merge();
+
+    void reset();
+};
+
+QTPOKIT_END_NAMESPACE
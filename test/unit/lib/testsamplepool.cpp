@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsamplepool.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/memorybudget.h>
+#include <qtpokit/ringbuffer.h>
+#include <qtpokit/samplepool.h>
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+void TestSamplePool::capacity()
+{
+    QCOMPARE(SamplePool<qint16>().capacity(), SamplePool<qint16>::defaultCapacity);
+    QCOMPARE(SamplePool<qint16>(4).capacity(), (qsizetype)4);
+    QCOMPARE(SamplePool<qint16>(0).capacity(), (qsizetype)1); // Clamped to at least one.
+    QCOMPARE(SamplePool<qint16>(4).size(), (qsizetype)0);
+}
+
+void TestSamplePool::acquire()
+{
+    SamplePool<qint16> pool(4);
+    QVector<qint16> &buffer = pool.acquire(10);
+    QCOMPARE(buffer.size(), (qsizetype)10);
+    QVERIFY(buffer.isDetached());
+    QCOMPARE(pool.size(), (qsizetype)1);
+    QCOMPARE(pool.available(), (qsizetype)1); // Nothing else holds a reference yet.
+    QCOMPARE(pool.allocationCount(), (quint64)1);
+    QCOMPARE(pool.reuseCount(), (quint64)0);
+    QCOMPARE(pool.overflowCount(), (quint64)0);
+}
+
+void TestSamplePool::acquire_empty()
+{
+    SamplePool<qint16> pool(4);
+    QVERIFY(pool.acquire(0).isEmpty());
+    QVERIFY(pool.acquire(-1).isEmpty());
+    QCOMPARE(pool.size(), (qsizetype)0);
+    QCOMPARE(pool.allocationCount(), (quint64)0);
+    QCOMPARE(pool.overflowCount(), (quint64)0);
+}
+
+void TestSamplePool::reuse()
+{
+    SamplePool<qint16> pool(1);
+    QVector<qint16> samples = pool.acquire(10);
+    const qint16 * const storage = samples.constData();
+    QCOMPARE(pool.available(), (qsizetype)0); // Still in use by samples.
+
+    samples = QVector<qint16>(); // Released.
+    QCOMPARE(pool.available(), (qsizetype)1);
+    samples = pool.acquire(5); // Smaller, so within the existing capacity.
+    QCOMPARE(samples.constData(), storage);
+    QCOMPARE(samples.size(), (qsizetype)5);
+    QCOMPARE(pool.reuseCount(), (quint64)1);
+    QCOMPARE(pool.allocationCount(), (quint64)1);
+    QCOMPARE(pool.overflowCount(), (quint64)0);
+}
+
+void TestSamplePool::reuse_roundRobin()
+{
+    SamplePool<qint16> pool(3);
+    QVector<qint16> held[3];
+    for (QVector<qint16> &samples: held) {
+        samples = pool.acquire(10);
+    }
+    QCOMPARE(pool.size(), (qsizetype)3);
+    QCOMPARE(pool.available(), (qsizetype)0);
+    const qint16 * const storage[3] { held[0].constData(), held[1].constData(), held[2].constData() };
+    for (QVector<qint16> &samples: held) {
+        samples = QVector<qint16>();
+    }
+    QCOMPARE(pool.available(), (qsizetype)3);
+
+    // Released buffers are reused in turn, rather than always reusing the first.
+    for (int index = 0; index < 6; ++index) {
+        QCOMPARE(pool.acquire(10).constData(), storage[index % 3]);
+    }
+    QCOMPARE(pool.reuseCount(), (quint64)6);
+    QCOMPARE(pool.allocationCount(), (quint64)3);
+    QCOMPARE(pool.overflowCount(), (quint64)0);
+}
+
+void TestSamplePool::overflow()
+{
+    SamplePool<qint16> pool(2);
+    const QVector<qint16> first = pool.acquire(10);
+    const QVector<qint16> second = pool.acquire(10);
+    const QVector<qint16> third = pool.acquire(10); // All pooled buffers still in use.
+    QCOMPARE(third.size(), (qsizetype)10);
+    QVERIFY(third.constData() != first.constData());
+    QVERIFY(third.constData() != second.constData());
+    QCOMPARE(pool.size(), (qsizetype)2);
+    QCOMPARE(pool.allocationCount(), (quint64)2);
+    QCOMPARE(pool.overflowCount(), (quint64)1);
+}
+
+void TestSamplePool::overflow_quota()
+{
+    // With room in its quota for just one buffer of 10 samples, the pool falls back to spare buffers, not growing.
+    MemoryBudget budget;
+    budget.setDefaultQuota(10 * (qint64)sizeof(qint16));
+    SamplePool<qint16> pool(4, u"test"_s, &budget);
+    QVector<qint16> first = pool.acquire(10);
+    QCOMPARE(pool.memoryStream().bytes(), (qint64)20);
+    const QVector<qint16> second = pool.acquire(10); // First is still in use.
+    QCOMPARE(second.size(), (qsizetype)10);
+    QCOMPARE(pool.size(), (qsizetype)1);
+    QCOMPARE(pool.overflowCount(), (quint64)1);
+    QCOMPARE(pool.memoryStream().usage().refusals, (quint64)1);
+
+    // Nor may the pool's one buffer grow beyond the quota, once released.
+    first = QVector<qint16>();
+    QCOMPARE(pool.acquire(20).size(), (qsizetype)20);
+    QCOMPARE(pool.reuseCount(), (quint64)0);
+    QCOMPARE(pool.overflowCount(), (quint64)2);
+    QCOMPARE(budget.bytes(), (qint64)20);
+}
+
+void TestSamplePool::shared()
+{
+    // Samples pushed into a ring buffer share the pool's storage, and are only reused once popped (and released).
+    SamplePool<qint16> pool(4);
+    RingBuffer<QVector<qint16>> ring(2);
+    QVector<qint16> &buffer = pool.acquire(3);
+    buffer[0] = 1; buffer[1] = 2; buffer[2] = 3;
+    const qint16 * const storage = buffer.constData();
+    ring.push(buffer);
+    QCOMPARE(pool.available(), (qsizetype)0);
+
+    QVERIFY(pool.acquire(3).constData() != storage); // Not reused, since the ring still holds it.
+
+    QVector<qint16> popped;
+    QVERIFY(ring.pop(popped));
+    QCOMPARE(popped.constData(), storage);
+    QCOMPARE(popped, QVector<qint16>({ 1, 2, 3 }));
+    popped = QVector<qint16>();
+    QCOMPARE(pool.available(), (qsizetype)2);
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSamplePool))
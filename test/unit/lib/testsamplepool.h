@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSamplePool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacity();
+
+    void acquire();
+    void acquire_empty();
+
+    void reuse();
+    void reuse_roundRobin();
+
+    void overflow();
+    void overflow_quota();
+
+    void shared();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsaturationdetector.h"
+
+#include <qtpokit/pokitmeter.h>
+#include <qtpokit/pokitpro.h>
+#include <qtpokit/saturationdetector.h>
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(DsoService::Mode))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestSaturationDetector::threshold_dso_data()
+{
+    QTest::addColumn<DsoService::Mode>("mode");
+    QTest::addColumn<quint8>("range");
+    QTest::addColumn<float>("scale");
+    QTest::addColumn<qint16>("expected");
+
+    // Full scale, as per real devices, is capped at the raw samples' full scale.
+    QTest::addRow("2V/2048") << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_2V << 2.0f / 2048.0f
+                             << SaturationDetector::fullScaleSample;
+    QTest::addRow("2V/1mV")  << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_2V << 0.001f
+                             << (qint16)2000;
+    QTest::addRow("negativeScale") << DsoService::Mode::AcVoltage << +PokitMeter::VoltageRange::_2V << -0.001f
+                                   << (qint16)2000;
+    QTest::addRow("150mA")   << DsoService::Mode::DcCurrent << +PokitMeter::CurrentRange::_150mA << 0.0001f
+                             << (qint16)1500;
+    QTest::addRow("tiny")    << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_300mV << 1.0f
+                             << (qint16)1;
+
+    // Unknown scales, modes and ranges fall back to the raw samples' full scale.
+    QTest::addRow("noScale") << DsoService::Mode::DcVoltage << +PokitMeter::VoltageRange::_2V << 0.0f
+                             << SaturationDetector::fullScaleSample;
+    QTest::addRow("idle")    << DsoService::Mode::Idle << (quint8)0 << 0.001f
+                             << SaturationDetector::fullScaleSample;
+    QTest::addRow("unknown") << DsoService::Mode::DcVoltage << (quint8)100 << 0.001f
+                             << SaturationDetector::fullScaleSample;
+}
+
+void TestSaturationDetector::threshold_dso()
+{
+    QFETCH(DsoService::Mode, mode);
+    QFETCH(quint8, range);
+    QFETCH(float, scale);
+    QFETCH(qint16, expected);
+    QCOMPARE(SaturationDetector::threshold(PokitProduct::PokitMeter, mode, range, scale), expected);
+}
+
+void TestSaturationDetector::threshold_logger()
+{
+    QCOMPARE(SaturationDetector::threshold(PokitProduct::PokitMeter, DataLoggerService::Mode::DcVoltage,
+                                           +PokitMeter::VoltageRange::_2V, 0.001f), (qint16)2000);
+    QCOMPARE(SaturationDetector::threshold(PokitProduct::PokitPro, DataLoggerService::Mode::DcVoltage,
+                                           +PokitPro::VoltageRange::_2V, 0.001f), (qint16)2000);
+    QCOMPARE(SaturationDetector::threshold(PokitProduct::PokitMeter, DataLoggerService::Mode::Temperature,
+                                           0, 0.001f), SaturationDetector::fullScaleSample);
+}
+
+void TestSaturationDetector::nextRange()
+{
+    // Each range steps up to the next, until the highest.
+    QCOMPARE(SaturationDetector::nextRange(PokitProduct::PokitMeter, DsoService::Mode::DcVoltage,
+                                           +PokitMeter::VoltageRange::_2V), +PokitMeter::VoltageRange::_6V);
+    QCOMPARE(SaturationDetector::nextRange(PokitProduct::PokitMeter, DsoService::Mode::DcVoltage,
+                                           +PokitMeter::VoltageRange::_60V), +PokitMeter::VoltageRange::_60V);
+    QCOMPARE(SaturationDetector::nextRange(PokitProduct::PokitMeter, DataLoggerService::Mode::DcCurrent,
+                                           +PokitMeter::CurrentRange::_150mA), +PokitMeter::CurrentRange::_300mA);
+
+    // AutoRange, unknown ranges, and modes without ranges, are left as is.
+    QCOMPARE(SaturationDetector::nextRange(PokitProduct::PokitMeter, DsoService::Mode::DcVoltage,
+                                           +PokitMeter::VoltageRange::AutoRange), +PokitMeter::VoltageRange::AutoRange);
+    QCOMPARE(SaturationDetector::nextRange(PokitProduct::PokitMeter, DsoService::Mode::DcVoltage, 100),
+             (quint8)100);
+    QCOMPARE(SaturationDetector::nextRange(PokitProduct::PokitMeter, DataLoggerService::Mode::Temperature, 0),
+             (quint8)0);
+}
+
+void TestSaturationDetector::process_data()
+{
+    QTest::addColumn<QVector<qint16>>("samples");
+    QTest::addColumn<QVector<qint64>>("expectedRuns"); // First, count pairs.
+    QTest::addColumn<qint64>("expectedSaturated");
+    QTest::addColumn<int>("expectedPeak");
+    QTest::addColumn<bool>("expectOpenRun");
+
+    QTest::addRow("empty")   << QVector<qint16>{} << QVector<qint64>{} << (qint64)0 << 0 << false;
+    QTest::addRow("clean")   << QVector<qint16>{ 0, 1, -99, 99 } << QVector<qint64>{} << (qint64)0 << 99 << false;
+    QTest::addRow("single")  << QVector<qint16>{ 0, 100, 0 } << QVector<qint64>{ 1, 1 } << (qint64)1 << 100 << false;
+    QTest::addRow("negative") << QVector<qint16>{ 0, -100, -101, 0 } << QVector<qint64>{ 1, 2 } << (qint64)2 << 101
+                              << false;
+    QTest::addRow("two")     << QVector<qint16>{ 100, 0, 0, 200, 100, 0 } << QVector<qint64>{ 0, 1, 3, 2 }
+                             << (qint64)3 << 200 << false;
+    QTest::addRow("trailing") << QVector<qint16>{ 0, 0, 100 } << QVector<qint64>{} << (qint64)1 << 100 << true;
+    QTest::addRow("extreme") << QVector<qint16>{ std::numeric_limits<qint16>::min(), 0 } << QVector<qint64>{ 0, 1 }
+                             << (qint64)1 << 32768 << false;
+}
+
+void TestSaturationDetector::process()
+{
+    QFETCH(QVector<qint16>, samples);
+    QFETCH(QVector<qint64>, expectedRuns);
+    QFETCH(qint64, expectedSaturated);
+    QFETCH(int, expectedPeak);
+    QFETCH(bool, expectOpenRun);
+
+    SaturationDetector detector(100);
+    const QVector<SaturationDetector::Segment> segments = detector.process(samples);
+    QCOMPARE(segments.size() * 2, expectedRuns.size());
+    for (qsizetype index = 0; index < segments.size(); ++index) {
+        QCOMPARE(segments.at(index).first, expectedRuns.at(index * 2));
+        QCOMPARE(segments.at(index).count, expectedRuns.at(index * 2 + 1));
+    }
+    QCOMPARE(detector.sampleCount(), (qint64)samples.size());
+    QCOMPARE(detector.saturatedCount(), expectedSaturated);
+    QCOMPARE(detector.isSaturated(), expectedSaturated > 0);
+    QCOMPARE(detector.peak(), expectedPeak);
+    QCOMPARE(detector.flush().has_value(), expectOpenRun);
+}
+
+void TestSaturationDetector::process_spanningChunks()
+{
+    SaturationDetector detector(100);
+    QVERIFY(detector.process({ 0, 0, 100 }).isEmpty());       // Run begins.
+    QVERIFY(detector.process({ 100, -100, 100 }).isEmpty());  // Run continues.
+    QVERIFY(detector.process({}).isEmpty());                  // Nothing to end the run.
+
+    // The run ends with the previous chunk, even though this chunk has no saturated samples itself.
+    const QVector<SaturationDetector::Segment> segments = detector.process({ 0, 0 });
+    QCOMPARE(segments.size(), 1);
+    QCOMPARE(segments.at(0).first, (qint64)2);
+    QCOMPARE(segments.at(0).count, (qint64)4);
+    QCOMPARE(detector.sampleCount(), (qint64)8);
+    QCOMPARE(detector.saturatedCount(), (qint64)4);
+    QVERIFY(!detector.flush());
+}
+
+void TestSaturationDetector::processRaw_data()
+{
+    process_data();
+}
+
+void TestSaturationDetector::processRaw()
+{
+    QFETCH(QVector<qint16>, samples);
+    QFETCH(qint64, expectedSaturated);
+    QFETCH(int, expectedPeak);
+    QFETCH(bool, expectOpenRun);
+
+    // Little-endian bytes, as per the devices' Reading characteristics, plus a trailing odd byte, to be ignored.
+    QByteArray bytes;
+    for (const qint16 sample: samples) {
+        bytes.append((char)(sample & 0xFF)).append((char)((sample >> 8) & 0xFF));
+    }
+    bytes.append('\xFF');
+
+    SaturationDetector expected(100), detector(100);
+    const QVector<SaturationDetector::Segment> expectedSegments = expected.process(samples);
+    const QVector<SaturationDetector::Segment> segments = detector.processRaw(bytes);
+    QCOMPARE(segments.size(), expectedSegments.size());
+    for (qsizetype index = 0; index < segments.size(); ++index) {
+        QCOMPARE(segments.at(index).first, expectedSegments.at(index).first);
+        QCOMPARE(segments.at(index).count, expectedSegments.at(index).count);
+    }
+    QCOMPARE(detector.sampleCount(), (qint64)samples.size());
+    QCOMPARE(detector.saturatedCount(), expectedSaturated);
+    QCOMPARE(detector.peak(), expectedPeak);
+    QCOMPARE(detector.flush().has_value(), expectOpenRun);
+}
+
+void TestSaturationDetector::flush()
+{
+    SaturationDetector detector;
+    QCOMPARE(detector.threshold(), SaturationDetector::fullScaleSample);
+    QVERIFY(!detector.flush());
+    QVERIFY(detector.process({ 0, 2047, -2048 }).isEmpty());
+    const std::optional<SaturationDetector::Segment> segment = detector.flush();
+    QVERIFY(segment);
+    QCOMPARE(segment->first, (qint64)1);
+    QCOMPARE(segment->count, (qint64)2);
+    QVERIFY(!detector.flush()); // Flushed already.
+}
+
+void TestSaturationDetector::reset()
+{
+    SaturationDetector detector(10);
+    detector.process({ 1, 20, 30 });
+    detector.setThreshold(0); // Thresholds are at least 1.
+    QCOMPARE(detector.threshold(), (qint16)1);
+    detector.reset();
+    QCOMPARE(detector.threshold(), (qint16)1); // Unchanged by reset().
+    QCOMPARE(detector.sampleCount(), (qint64)0);
+    QCOMPARE(detector.saturatedCount(), (qint64)0);
+    QVERIFY(!detector.isSaturated());
+    QCOMPARE(detector.peak(), 0);
+    QVERIFY(!detector.flush()); // The run in progress was dropped.
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSaturationDetector))
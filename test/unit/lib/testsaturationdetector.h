@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSaturationDetector : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void threshold_dso_data();
+    void threshold_dso();
+
+    void threshold_logger();
+
+    void nextRange();
+
+    void process_data();
+    void process();
+
+    void process_spanningChunks();
+
+    void processRaw_data();
+    void processRaw();
+
+    void flush();
+
+    void reset();
+};
+
+QTPOKIT_END_NAMESPACE
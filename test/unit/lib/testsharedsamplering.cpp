@@ -0,0 +1,296 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsharedsamplering.h"
+
+#include <qtpokit/sharedsamplering.h>
+#include "sharedsamplering_p.h"
+
+#include <QUuid>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+// Segments are system-wide, so give each ring a unique key, to avoid clashing with concurrent test runs.
+QString uniqueKey()
+{
+    return QStringLiteral("dokit-test-") + QUuid::createUuid().toString(QUuid::WithoutBraces);
+}
+
+SharedSampleRing::Record record(const float value)
+{
+    SharedSampleRing::Record record;
+    record.timestamp = (qint64)(value * 1000);
+    record.value = value;
+    record.kind = SharedSampleRing::Kind::LoggerSample;
+    return record;
+}
+
+}
+
+void TestSharedSampleRing::create()
+{
+    SharedSampleRing ring;
+    QVERIFY(!ring.isAttached());
+    QVERIFY(!ring.isPublisher());
+    QCOMPARE(ring.capacity(), (quint32)0);
+    QCOMPARE(ring.published(), (quint64)0);
+
+    const QString key = uniqueKey();
+    QVERIFY(ring.create(key, 16));
+    QCOMPARE(ring.key(), key);
+    QVERIFY(ring.isAttached());
+    QVERIFY(ring.isPublisher());
+    QCOMPARE(ring.capacity(), (quint32)16);
+    QCOMPARE(ring.published(), (quint64)0);
+    QVERIFY(ring.errorString().isEmpty());
+
+    ring.detach();
+    QVERIFY(!ring.isAttached());
+    QVERIFY(!ring.isPublisher());
+}
+
+void TestSharedSampleRing::create_zeroCapacity()
+{
+    SharedSampleRing ring;
+    QVERIFY(!ring.create(uniqueKey(), 0));
+    QVERIFY(!ring.isAttached());
+    QVERIFY(!ring.errorString().isEmpty());
+}
+
+void TestSharedSampleRing::create_inUse()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 4));
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+
+    // A second publisher cannot take over a segment that others are still attached to.
+    SharedSampleRing other;
+    QVERIFY(!other.create(key, 4));
+    QVERIFY(!other.isAttached());
+    QVERIFY(!other.errorString().isEmpty());
+}
+
+void TestSharedSampleRing::attach_missing()
+{
+    SharedSampleRing ring;
+    QVERIFY(!ring.attach(uniqueKey()));
+    QVERIFY(!ring.isAttached());
+    QVERIFY(!ring.errorString().isEmpty());
+    QVector<SharedSampleRing::Record> records;
+    QCOMPARE(ring.read(records), (qsizetype)0);
+}
+
+void TestSharedSampleRing::attach_invalid()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 4));
+    publisher.d_func()->header()->magic = 0x12345678;
+
+    SharedSampleRing reader;
+    QVERIFY(!reader.attach(key));
+    QVERIFY(!reader.isAttached());
+    QCOMPARE(reader.errorString(), QStringLiteral("Unrecognised magic number 0x12345678"));
+
+    publisher.d_func()->header()->magic = SharedSampleRingPrivate::magic;
+    publisher.d_func()->header()->version = SharedSampleRingPrivate::version + 1;
+    QVERIFY(!reader.attach(key));
+    QCOMPARE(reader.errorString(), QStringLiteral("Unsupported layout version 2, with 40-byte slots"));
+}
+
+void TestSharedSampleRing::publishRead()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 8));
+    QVERIFY(publisher.publish(record(1.0f)));
+
+    // New readers start from the oldest record still in the ring.
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+    QVERIFY(!reader.isPublisher());
+    QCOMPARE(reader.capacity(), (quint32)8);
+    QCOMPARE(reader.nextSequence(), (quint64)0);
+    QCOMPARE(reader.available(), (qsizetype)1);
+
+    QVERIFY(publisher.publish(record(2.0f)));
+    QVERIFY(publisher.publish(record(3.0f)));
+    QCOMPARE(publisher.published(), (quint64)3);
+    QCOMPARE(reader.published(), (quint64)3);
+    QCOMPARE(reader.available(), (qsizetype)3);
+
+    QVector<SharedSampleRing::Record> records;
+    QCOMPARE(reader.read(records), (qsizetype)3);
+    QCOMPARE(records.size(), 3);
+    for (int index = 0; index < records.size(); ++index) {
+        QCOMPARE(records.at(index).sequence, (quint64)index);
+        QCOMPARE(records.at(index).timestamp, (qint64)(index + 1) * 1000);
+        QCOMPARE(records.at(index).value, (float)(index + 1));
+        QVERIFY(records.at(index).kind == SharedSampleRing::Kind::LoggerSample);
+    }
+    QCOMPARE(reader.available(), (qsizetype)0);
+    QCOMPARE(reader.overrunCount(), (quint64)0);
+
+    // Nothing more to read, until more is published.
+    QCOMPARE(reader.read(records), (qsizetype)0);
+    QVERIFY(publisher.publish(record(4.0f)));
+    QCOMPARE(reader.read(records), (qsizetype)1);
+    QCOMPARE(records.size(), 4);
+    QCOMPARE(records.last().sequence, (quint64)3);
+}
+
+void TestSharedSampleRing::publish_reading()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 4));
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+
+    const MultimeterService::Reading reading{
+        MultimeterService::MeterStatus::AutoRangeOn, 1.5f, MultimeterService::Mode::DcVoltage, 3
+    };
+    QVERIFY(publisher.publish(reading, 1234567, 2));
+
+    QVector<SharedSampleRing::Record> records;
+    QCOMPARE(reader.read(records), (qsizetype)1);
+    QCOMPARE(records.at(0).sequence, (quint64)0);
+    QCOMPARE(records.at(0).timestamp, (qint64)1234567);
+    QCOMPARE(records.at(0).value, 1.5f);
+    QCOMPARE(records.at(0).source, (quint16)2);
+    QVERIFY(records.at(0).kind == SharedSampleRing::Kind::MeterReading);
+    QCOMPARE(records.at(0).mode, (quint8)MultimeterService::Mode::DcVoltage);
+    QCOMPARE(records.at(0).range, (quint8)3);
+    QCOMPARE(records.at(0).status, (quint8)MultimeterService::MeterStatus::AutoRangeOn);
+}
+
+void TestSharedSampleRing::publish_samples()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 8));
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+
+    const DsoService::Metadata metadata{
+        DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::AcVoltage, 2, 1000, 3, 3000
+    };
+    QVERIFY(publisher.publish(metadata, DsoService::Samples{ 2, -4, 6 }, 1000000, 333, 1));
+    QCOMPARE(publisher.published(), (quint64)3);
+
+    QVector<SharedSampleRing::Record> records;
+    QCOMPARE(reader.read(records), (qsizetype)3);
+    const float values[] { 1.0f, -2.0f, 3.0f };
+    for (int index = 0; index < records.size(); ++index) {
+        QCOMPARE(records.at(index).sequence, (quint64)index);
+        QCOMPARE(records.at(index).timestamp, (qint64)(1000000 + index * 333));
+        QCOMPARE(records.at(index).value, values[index]);
+        QCOMPARE(records.at(index).source, (quint16)1);
+        QVERIFY(records.at(index).kind == SharedSampleRing::Kind::DsoSample);
+        QCOMPARE(records.at(index).mode, (quint8)DsoService::Mode::AcVoltage);
+        QCOMPARE(records.at(index).range, (quint8)2);
+        QCOMPARE(records.at(index).status, (quint8)DsoService::DsoStatus::Done);
+    }
+}
+
+void TestSharedSampleRing::publish_notPublisher()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 4));
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+
+    QVERIFY(!reader.publish(record(1.0f)));
+    QVERIFY(!reader.publish(MultimeterService::Reading{}, 0));
+    QVERIFY(!reader.publish(DsoService::Metadata{}, DsoService::Samples{ 1 }, 0, 1));
+    QCOMPARE(publisher.published(), (quint64)0);
+
+    SharedSampleRing detached;
+    QVERIFY(!detached.publish(record(1.0f)));
+}
+
+void TestSharedSampleRing::read_maxRecords()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 8));
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+    for (int index = 0; index < 5; ++index) {
+        QVERIFY(publisher.publish(record((float)index)));
+    }
+
+    QVector<SharedSampleRing::Record> records;
+    QCOMPARE(reader.read(records, 2), (qsizetype)2);
+    QCOMPARE(reader.nextSequence(), (quint64)2);
+    QCOMPARE(reader.read(records, 0), (qsizetype)0);
+    QCOMPARE(reader.read(records, 10), (qsizetype)3);
+    QCOMPARE(records.size(), 5);
+    QCOMPARE(records.last().sequence, (quint64)4);
+}
+
+void TestSharedSampleRing::read_overrun()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 4));
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+
+    // The publisher never waits, so a slow reader loses all but the most recent (capacity) records.
+    for (int index = 0; index < 10; ++index) {
+        QVERIFY(publisher.publish(record((float)index)));
+    }
+    QCOMPARE(reader.available(), (qsizetype)10);
+    QVector<SharedSampleRing::Record> records;
+    QCOMPARE(reader.read(records), (qsizetype)4);
+    QCOMPARE(reader.overrunCount(), (quint64)6);
+    for (int index = 0; index < records.size(); ++index) {
+        QCOMPARE(records.at(index).sequence, (quint64)(index + 6));
+        QCOMPARE(records.at(index).value, (float)(index + 6));
+    }
+
+    // Readers attaching later start from the oldest surviving record, without counting earlier ones as overruns.
+    SharedSampleRing late;
+    QVERIFY(late.attach(key));
+    QCOMPARE(late.nextSequence(), (quint64)6);
+    records.clear();
+    QCOMPARE(late.read(records), (qsizetype)4);
+    QCOMPARE(late.overrunCount(), (quint64)0);
+}
+
+void TestSharedSampleRing::read_overwritten()
+{
+    const QString key = uniqueKey();
+    SharedSampleRing publisher;
+    QVERIFY(publisher.create(key, 4));
+    SharedSampleRing reader;
+    QVERIFY(reader.attach(key));
+    QVERIFY(publisher.publish(record(1.0f)));
+    QVERIFY(publisher.publish(record(2.0f)));
+
+    // Simulate the publisher being part-way through overwriting the first slot.
+    publisher.d_func()->slot(0)->lock.store(2 * 4 + 1);
+
+    QVector<SharedSampleRing::Record> records;
+    QCOMPARE(reader.read(records), (qsizetype)1);
+    QCOMPARE(records.at(0).sequence, (quint64)1);
+    QCOMPARE(reader.overrunCount(), (quint64)1);
+}
+
+void TestSharedSampleRing::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    const SharedSampleRing ring;
+    QVERIFY(!ring.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSharedSampleRing))
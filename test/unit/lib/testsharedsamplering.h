@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSharedSampleRing : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void create();
+    void create_zeroCapacity();
+    void create_inUse();
+
+    void attach_missing();
+    void attach_invalid();
+
+    void publishRead();
+    void publish_reading();
+    void publish_samples();
+    void publish_notPublisher();
+
+    void read_maxRecords();
+    void read_overrun();
+    void read_overwritten();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
@@ -0,0 +1,340 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testsoftwaretrigger.h"
+
+#include <qtpokit/softwaretrigger.h>
+#include "softwaretrigger_p.h"
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(SoftwareTrigger::Settings))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+/// Returns the default settings, but with \a condition, \a slope, \a level and \a postTrigger, and no pre-trigger.
+SoftwareTrigger::Settings settingsFor(const SoftwareTrigger::Condition condition, const SoftwareTrigger::Slope slope,
+                                      const float level, const quint32 postTrigger = 1)
+{
+    SoftwareTrigger::Settings settings = SoftwareTrigger::defaultSettings();
+    settings.condition = condition;
+    settings.slope = slope;
+    settings.level = level;
+    settings.preTrigger = 0;
+    settings.postTrigger = postTrigger;
+    return settings;
+}
+
+/// Returns all of the segments emitted by \a trigger while processing \a values (in chunks of \a chunkSize, if any).
+QVector<SoftwareTrigger::Segment> segmentsOf(SoftwareTrigger &trigger, const QVector<float> &values,
+                                             const qsizetype chunkSize = 0)
+{
+    QVector<SoftwareTrigger::Segment> segments;
+    const QMetaObject::Connection connection = QObject::connect(&trigger, &SoftwareTrigger::triggered,
+        [&segments](const SoftwareTrigger::Segment &segment) { segments.append(segment); });
+    if (chunkSize <= 0) {
+        trigger.process(values);
+    } else {
+        for (qsizetype offset = 0; offset < values.size(); offset += chunkSize) {
+            trigger.process(values.constData() + offset, qMin(chunkSize, values.size() - offset));
+        }
+    }
+    QObject::disconnect(connection);
+    return segments;
+}
+
+}
+
+void TestSoftwareTrigger::service()
+{
+    SoftwareTrigger unattached;
+    QVERIFY(unattached.service() == nullptr);
+
+    DsoService dso(nullptr);
+    SoftwareTrigger dsoTrigger(&dso);
+    QCOMPARE(dsoTrigger.service(), static_cast<AbstractPokitService *>(&dso));
+
+    MultimeterService meter(nullptr);
+    SoftwareTrigger meterTrigger(&meter);
+    QCOMPARE(meterTrigger.service(), static_cast<AbstractPokitService *>(&meter));
+}
+
+void TestSoftwareTrigger::isValid_data()
+{
+    QTest::addColumn<SoftwareTrigger::Settings>("settings");
+    QTest::addColumn<bool>("expected");
+
+    using Condition = SoftwareTrigger::Condition;
+    using Slope     = SoftwareTrigger::Slope;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    QTest::addRow("default")          << SoftwareTrigger::defaultSettings() << true;
+    QTest::addRow("level")            << SoftwareTrigger::Settings{ Condition::Level, Slope::Either, -1.0f, 0.0f,
+                                         0.0f, 0, 0, 0, 1 } << true;
+    QTest::addRow("no-post-trigger")  << SoftwareTrigger::Settings{ Condition::Edge, Slope::Rising, 1.0f, 0.0f,
+                                         0.0f, 0, 0, 10, 0 } << false;
+    QTest::addRow("nan-level")        << SoftwareTrigger::Settings{ Condition::Edge, Slope::Rising, nan, 0.0f,
+                                         0.0f, 0, 0, 10, 10 } << false;
+    QTest::addRow("negative-hysteresis") << SoftwareTrigger::Settings{ Condition::Edge, Slope::Rising, 1.0f, 0.0f,
+                                         -0.1f, 0, 0, 10, 10 } << false;
+    QTest::addRow("window")           << SoftwareTrigger::Settings{ Condition::Window, Slope::Either, -1.0f, 1.0f,
+                                         0.5f, 0, 0, 10, 10 } << true;
+    QTest::addRow("window-narrow")    << SoftwareTrigger::Settings{ Condition::Window, Slope::Either, -1.0f, 1.0f,
+                                         1.0f, 0, 0, 10, 10 } << false;
+    QTest::addRow("window-inverted")  << SoftwareTrigger::Settings{ Condition::Window, Slope::Either, 1.0f, -1.0f,
+                                         0.0f, 0, 0, 10, 10 } << false;
+    QTest::addRow("pulse")            << SoftwareTrigger::Settings{ Condition::PulseWidth, Slope::Rising, 1.0f, 0.0f,
+                                         0.0f, 5, 10, 10, 10 } << true;
+    QTest::addRow("pulse-unbounded")  << SoftwareTrigger::Settings{ Condition::PulseWidth, Slope::Rising, 1.0f, 0.0f,
+                                         0.0f, 5, 0, 10, 10 } << true;
+    QTest::addRow("pulse-no-minimum") << SoftwareTrigger::Settings{ Condition::PulseWidth, Slope::Rising, 1.0f, 0.0f,
+                                         0.0f, 0, 10, 10, 10 } << false;
+    QTest::addRow("pulse-inverted")   << SoftwareTrigger::Settings{ Condition::PulseWidth, Slope::Rising, 1.0f, 0.0f,
+                                         0.0f, 10, 5, 10, 10 } << false;
+}
+
+void TestSoftwareTrigger::isValid()
+{
+    QFETCH(SoftwareTrigger::Settings, settings);
+    QFETCH(bool, expected);
+    QCOMPARE(SoftwareTrigger::isValid(settings), expected);
+}
+
+void TestSoftwareTrigger::setSettings()
+{
+    SoftwareTrigger trigger;
+    SoftwareTrigger::Settings settings = settingsFor(SoftwareTrigger::Condition::Level,
+                                                     SoftwareTrigger::Slope::Falling, -2.0f, 5);
+    trigger.setSettings(settings);
+    QCOMPARE(trigger.settings().condition, SoftwareTrigger::Condition::Level);
+    QCOMPARE(trigger.settings().slope, SoftwareTrigger::Slope::Falling);
+    QCOMPARE(trigger.settings().level, -2.0f);
+    QCOMPARE(trigger.settings().postTrigger, 5u);
+
+    settings.postTrigger = 0;
+    QTest::ignoreMessage(QtWarningMsg, "Invalid software trigger settings; keeping the current settings.");
+    trigger.setSettings(settings);
+    QCOMPARE(trigger.settings().postTrigger, 5u);
+}
+
+void TestSoftwareTrigger::process_data()
+{
+    QTest::addColumn<SoftwareTrigger::Settings>("settings");
+    QTest::addColumn<QVector<float>>("values");
+    QTest::addColumn<QList<quint64>>("expectedTriggers");
+
+    using Condition = SoftwareTrigger::Condition;
+    using Slope     = SoftwareTrigger::Slope;
+
+    const QVector<float> pulses{ 0.0f, 2.0f, 0.0f, 2.0f, 2.0f, 0.0f, 2.0f, 2.0f, 2.0f, 2.0f, 0.0f };
+    QTest::addRow("edge:rising")  << settingsFor(Condition::Edge, Slope::Rising, 1.0f)  << pulses
+                                  << QList<quint64>{ 1, 3, 6 };
+    QTest::addRow("edge:falling") << settingsFor(Condition::Edge, Slope::Falling, 1.0f) << pulses
+                                  << QList<quint64>{ 2, 5, 10 };
+    QTest::addRow("edge:either")  << settingsFor(Condition::Edge, Slope::Either, 1.0f)  << pulses
+                                  << QList<quint64>{ 1, 2, 3, 5, 6, 10 };
+    QTest::addRow("edge:starts-high") << settingsFor(Condition::Edge, Slope::Rising, 1.0f) // Not armed until low.
+                                  << QVector<float>{ 2.0f, 2.0f, 0.0f, 2.0f } << QList<quint64>{ 3 };
+
+    SoftwareTrigger::Settings hysteresis = settingsFor(Condition::Edge, Slope::Rising, 1.0f);
+    hysteresis.hysteresis = 0.5f;
+    const QVector<float> noisy{ 0.0f, 1.0f, 0.8f, 1.0f, 0.4f, 1.0f };
+    QTest::addRow("edge:noisy")      << settingsFor(Condition::Edge, Slope::Rising, 1.0f) << noisy
+                                     << QList<quint64>{ 1, 3, 5 };
+    QTest::addRow("edge:hysteresis") << hysteresis << noisy << QList<quint64>{ 1, 5 };
+
+    // Level triggers persist, so trigger again as soon as each (two value) segment is complete.
+    const QVector<float> levels{ 0.0f, 2.0f, 2.0f, 2.0f, 2.0f, -2.0f, -2.0f, 0.0f };
+    QTest::addRow("level:rising")  << settingsFor(Condition::Level, Slope::Rising, 1.0f, 2) << levels
+                                   << QList<quint64>{ 1, 3 };
+    QTest::addRow("level:falling") << settingsFor(Condition::Level, Slope::Falling, -1.0f, 2) << levels
+                                   << QList<quint64>{ 5 };
+    QTest::addRow("level:either")  << settingsFor(Condition::Level, Slope::Either, 1.0f, 2) << levels
+                                   << QList<quint64>{ 1, 3, 5 };
+
+    SoftwareTrigger::Settings window = settingsFor(Condition::Window, Slope::Either, -1.0f);
+    window.upperLevel = 1.0f;
+    const QVector<float> excursions{ 2.0f, 0.0f, 2.0f, 0.0f, -2.0f, 2.0f, 0.5f, 2.0f };
+    QTest::addRow("window:either") << window << excursions << QList<quint64>{ 2, 4, 5, 7 };
+    window.slope = Slope::Rising;
+    QTest::addRow("window:rising") << window << excursions << QList<quint64>{ 2, 5, 7 };
+    window.slope = Slope::Falling;
+    QTest::addRow("window:falling") << window << excursions << QList<quint64>{ 4 };
+    window.slope = Slope::Either;
+    window.hysteresis = 0.6f; // So 0.5 is no longer far enough inside the window to re-arm.
+    QTest::addRow("window:hysteresis") << window << excursions << QList<quint64>{ 2, 4, 5 };
+
+    // Pulses of widths 1, 2 and 4 samples, ending at positions 2, 5 and 10.
+    SoftwareTrigger::Settings pulse = settingsFor(Condition::PulseWidth, Slope::Rising, 1.0f);
+    pulse.minWidth = 2;
+    pulse.maxWidth = 3;
+    QTest::addRow("pulse:2-3") << pulse << pulses << QList<quint64>{ 5 };
+    pulse.minWidth = 1;
+    pulse.maxWidth = 1;
+    QTest::addRow("pulse:glitch") << pulse << pulses << QList<quint64>{ 2 };
+    pulse.minWidth = 3;
+    pulse.maxWidth = 0;
+    QTest::addRow("pulse:wide") << pulse << pulses << QList<quint64>{ 10 };
+    pulse.minWidth = 1;
+    pulse.slope = Slope::Falling; // Two negative pulses (each of width 1) below 1, ending at positions 3 and 6.
+    QTest::addRow("pulse:negative") << pulse << pulses << QList<quint64>{ 3, 6 };
+}
+
+void TestSoftwareTrigger::process()
+{
+    QFETCH(SoftwareTrigger::Settings, settings);
+    QFETCH(QVector<float>, values);
+    QFETCH(QList<quint64>, expectedTriggers);
+
+    SoftwareTrigger trigger;
+    trigger.setSettings(settings);
+    const QVector<SoftwareTrigger::Segment> segments = segmentsOf(trigger, values);
+    QList<quint64> triggers;
+    for (const SoftwareTrigger::Segment &segment: segments) {
+        triggers.append(segment.triggerSample);
+    }
+    QCOMPARE(triggers, expectedTriggers);
+    QCOMPARE(trigger.triggerCount(), (quint64)expectedTriggers.size());
+    QCOMPARE(trigger.samplesProcessed(), (quint64)values.size());
+}
+
+void TestSoftwareTrigger::process_segments()
+{
+    SoftwareTrigger trigger;
+    SoftwareTrigger::Settings settings = settingsFor(SoftwareTrigger::Condition::Edge,
+                                                     SoftwareTrigger::Slope::Rising, 1.0f, 3);
+    settings.preTrigger = 2;
+    trigger.setSettings(settings);
+
+    const QVector<SoftwareTrigger::Segment> segments = segmentsOf(trigger,
+        { 0.0f, 0.1f, 0.2f, 2.0f, 2.1f, 2.2f, 2.3f, 0.3f, 0.4f, 2.4f, 2.5f, 2.6f, 0.5f, 3.0f });
+    QCOMPARE(segments.size(), 2);
+    QCOMPARE(segments.at(0).firstSample, (quint64)1); // Just the two most recent pre-trigger values.
+    QCOMPARE(segments.at(0).triggerSample, (quint64)3);
+    QCOMPARE(segments.at(0).values, (QVector<float>{ 0.1f, 0.2f, 2.0f, 2.1f, 2.2f }));
+    QCOMPARE(segments.at(1).firstSample, (quint64)7);  // Pre-trigger values never overlap the previous segment.
+    QCOMPARE(segments.at(1).triggerSample, (quint64)9);
+    QCOMPARE(segments.at(1).values, (QVector<float>{ 0.3f, 0.4f, 2.4f, 2.5f, 2.6f }));
+    QVERIFY(trigger.isCapturing()); // The third segment (triggered by the last value) is still in progress.
+
+    // Triggering at the very start of the stream leaves fewer pre-trigger values.
+    trigger.reset();
+    const QVector<SoftwareTrigger::Segment> early = segmentsOf(trigger, { 0.0f, 2.0f, 2.0f, 2.0f });
+    QCOMPARE(early.size(), 1);
+    QCOMPARE(early.at(0).firstSample, (quint64)0);
+    QCOMPARE(early.at(0).triggerSample, (quint64)1);
+    QCOMPARE(early.at(0).values, (QVector<float>{ 0.0f, 2.0f, 2.0f, 2.0f }));
+}
+
+void TestSoftwareTrigger::process_chunked()
+{
+    // Processing in chunks of any size must give exactly the same segments as processing all at once.
+    QVector<float> values;
+    for (int index = 0; index < 500; ++index) {
+        values.append((float)((index * 37) % 101) / 50.0f - 1.0f); // A pseudo-random sawtooth from -1 to +1.
+    }
+    SoftwareTrigger::Settings settings = settingsFor(SoftwareTrigger::Condition::Edge,
+                                                     SoftwareTrigger::Slope::Either, 0.5f, 7);
+    settings.preTrigger = 5;
+    settings.hysteresis = 0.1f;
+
+    SoftwareTrigger whole;
+    whole.setSettings(settings);
+    const QVector<SoftwareTrigger::Segment> expected = segmentsOf(whole, values);
+    QVERIFY(expected.size() > 10);
+
+    for (const qsizetype chunkSize: { 1, 3, 7, 64, 1000 }) {
+        SoftwareTrigger chunked;
+        chunked.setSettings(settings);
+        const QVector<SoftwareTrigger::Segment> actual = segmentsOf(chunked, values, chunkSize);
+        QCOMPARE(actual.size(), expected.size());
+        for (qsizetype index = 0; index < actual.size(); ++index) {
+            QCOMPARE(actual.at(index).firstSample, expected.at(index).firstSample);
+            QCOMPARE(actual.at(index).triggerSample, expected.at(index).triggerSample);
+            QCOMPARE(actual.at(index).values, expected.at(index).values);
+        }
+    }
+}
+
+void TestSoftwareTrigger::flush()
+{
+    SoftwareTrigger trigger;
+    trigger.setSettings(settingsFor(SoftwareTrigger::Condition::Level, SoftwareTrigger::Slope::Rising, 1.0f, 100));
+    QVERIFY(segmentsOf(trigger, { 0.0f, 2.0f, 3.0f }).isEmpty());
+    QVERIFY(trigger.isCapturing());
+
+    QVector<SoftwareTrigger::Segment> segments;
+    connect(&trigger, &SoftwareTrigger::triggered,
+            [&segments](const SoftwareTrigger::Segment &segment) { segments.append(segment); });
+    trigger.flush();
+    QCOMPARE(segments.size(), 1);
+    QCOMPARE(segments.at(0).triggerSample, (quint64)1);
+    QCOMPARE(segments.at(0).values, (QVector<float>{ 2.0f, 3.0f })); // Truncated.
+    QVERIFY(!trigger.isCapturing());
+
+    trigger.flush(); // Nothing more to flush.
+    QCOMPARE(segments.size(), 1);
+}
+
+void TestSoftwareTrigger::reset()
+{
+    SoftwareTrigger trigger;
+    trigger.setSettings(settingsFor(SoftwareTrigger::Condition::Edge, SoftwareTrigger::Slope::Rising, 1.0f, 10));
+    QVERIFY(segmentsOf(trigger, { 0.0f, 2.0f }).isEmpty());
+    QVERIFY(trigger.isCapturing());
+    QCOMPARE(trigger.triggerCount(), (quint64)1);
+
+    trigger.reset();
+    QVERIFY(!trigger.isCapturing());
+    QCOMPARE(trigger.triggerCount(), (quint64)0);
+    QCOMPARE(trigger.samplesProcessed(), (quint64)0);
+    QVERIFY(segmentsOf(trigger, { 2.0f }).isEmpty()); // No longer armed, since not yet seen below the level.
+    QVERIFY(!trigger.isCapturing());
+}
+
+void TestSoftwareTrigger::dsoSamplesRead()
+{
+    SoftwareTrigger trigger;
+    trigger.setSettings(settingsFor(SoftwareTrigger::Condition::Edge, SoftwareTrigger::Slope::Rising, 1.0f, 2));
+    QVector<SoftwareTrigger::Segment> segments;
+    connect(&trigger, &SoftwareTrigger::triggered,
+            [&segments](const SoftwareTrigger::Segment &segment) { segments.append(segment); });
+
+    trigger.d_func()->dsoMetadataRead({ DsoService::DsoStatus::Done, 0.5f, DsoService::Mode::DcVoltage, 0, 0, 5,
+                                        1000 });
+    trigger.d_func()->dsoSamplesRead({ 0, 1, 4 });
+    trigger.d_func()->dsoSamplesRead({ 6, 0 }); // Segments continue across notifications.
+    QCOMPARE(segments.size(), 1);
+    QCOMPARE(segments.at(0).triggerSample, (quint64)2);
+    QCOMPARE(segments.at(0).values, (QVector<float>{ 2.0f, 3.0f }));
+}
+
+void TestSoftwareTrigger::readingRead()
+{
+    SoftwareTrigger trigger;
+    trigger.setSettings(settingsFor(SoftwareTrigger::Condition::Edge, SoftwareTrigger::Slope::Falling, 1.0f, 1));
+    QVector<SoftwareTrigger::Segment> segments;
+    connect(&trigger, &SoftwareTrigger::triggered,
+            [&segments](const SoftwareTrigger::Segment &segment) { segments.append(segment); });
+
+    for (const float value: { 2.0f, 1.5f, 0.5f }) {
+        trigger.d_func()->readingRead({ MultimeterService::MeterStatus::AutoRangeOn, value,
+                                        MultimeterService::Mode::DcVoltage, 0 });
+    }
+    QCOMPARE(segments.size(), 1);
+    QCOMPARE(segments.at(0).triggerSample, (quint64)2);
+    QCOMPARE(segments.at(0).values, (QVector<float>{ 0.5f }));
+}
+
+void TestSoftwareTrigger::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    SoftwareTrigger trigger;
+    QVERIFY(!trigger.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestSoftwareTrigger))
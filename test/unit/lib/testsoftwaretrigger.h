@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestSoftwareTrigger : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void service();
+
+    void isValid_data();
+    void isValid();
+
+    void setSettings();
+
+    void process_data();
+    void process();
+
+    void process_segments();
+    void process_chunked();
+
+    void flush();
+    void reset();
+
+    void dsoSamplesRead();
+    void readingRead();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
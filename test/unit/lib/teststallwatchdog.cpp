@@ -0,0 +1,335 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "teststallwatchdog.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/stallwatchdog.h>
+#include "abstractpokitservice_p.h"
+#include "stallwatchdog_p.h"
+
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTimer>
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(StallWatchdog::Action))
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+namespace {
+
+/// Service whose requests are recorded, and acknowledged straight away, rather than issued to a real device.
+class RecordingService : public MultimeterService
+{
+public:
+    QVector<AbstractPokitServicePrivate::Request> requests; ///< Requests issued so far.
+
+    RecordingService() : MultimeterService(QLowEnergyController::createCentral(QBluetoothDeviceInfo()))
+    {
+        AbstractPokitServicePrivate * const d = StallWatchdogPrivate::servicePrivate(this);
+        d->requestHandler = [this, d](const AbstractPokitServicePrivate::Request &request) {
+            requests.append(request);
+            QTimer::singleShot(0, d, [d]() { if (d->inFlight) d->finishRequest(true); });
+        };
+    }
+
+    /// Emits a value, as if just received.
+    void receive()
+    {
+        Q_EMIT valueReceived(CharacteristicUuids::reading, AbstractPokitServicePrivate::steadyTimestamp());
+    }
+};
+
+}
+
+void TestStallWatchdog::initTestCase()
+{
+    // Register the types used by StallWatchdog's signals, so QSignalSpy can record their arguments.
+    qRegisterMetaType<StallWatchdog::Action>("StallWatchdog::Action");
+}
+
+void TestStallWatchdog::toString_Action_data()
+{
+    QTest::addColumn<StallWatchdog::Action>("action");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(action, expected) \
+        QTest::addRow(#action) << StallWatchdog::Action::action << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(ReenableNotifications, "ReenableNotifications");
+    DOKIT_ADD_TEST_ROW(RewriteSettings,       "RewriteSettings");
+    DOKIT_ADD_TEST_ROW(Reconnect,             "Reconnect");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (StallWatchdog::Action)255 << QString();
+}
+
+void TestStallWatchdog::toString_Action()
+{
+    QFETCH(StallWatchdog::Action, action);
+    QFETCH(QString, expected);
+    QCOMPARE(StallWatchdog::toString(action), expected);
+}
+
+void TestStallWatchdog::service()
+{
+    RecordingService service;
+    PokitDevice device(nullptr);
+    const StallWatchdog watchdog(&service, &device);
+    QCOMPARE(watchdog.service(), (AbstractPokitService *)&service);
+    QCOMPARE(watchdog.device(), &device);
+
+    const StallWatchdog noDevice(&service);
+    QVERIFY(!noDevice.device());
+}
+
+void TestStallWatchdog::expectedInterval()
+{
+    StallWatchdog watchdog(nullptr);
+    QCOMPARE(watchdog.expectedInterval(), (quint32)0); // Learned by default.
+    watchdog.setExpectedInterval(1000);
+    QCOMPARE(watchdog.expectedInterval(), (quint32)1000);
+    watchdog.setExpectedInterval(0);
+    QCOMPARE(watchdog.expectedInterval(), (quint32)0);
+}
+
+void TestStallWatchdog::stallFactor()
+{
+    StallWatchdog watchdog(nullptr);
+    QCOMPARE(watchdog.stallFactor(), 5.0f);
+    watchdog.setStallFactor(2.5f);
+    QCOMPARE(watchdog.stallFactor(), 2.5f);
+    watchdog.setStallFactor(0.5f);
+    QCOMPARE(watchdog.stallFactor(), 1.0f);
+    watchdog.setStallFactor(std::numeric_limits<float>::quiet_NaN());
+    QCOMPARE(watchdog.stallFactor(), 1.0f);
+}
+
+void TestStallWatchdog::minimumTimeout()
+{
+    StallWatchdog watchdog(nullptr);
+    QCOMPARE(watchdog.minimumTimeout(), (quint32)2000);
+    watchdog.setMinimumTimeout(500);
+    QCOMPARE(watchdog.minimumTimeout(), (quint32)500);
+}
+
+void TestStallWatchdog::stallTimeout_data()
+{
+    QTest::addColumn<quint32>("interval");
+    QTest::addColumn<float>("factor");
+    QTest::addColumn<quint32>("minimum");
+    QTest::addColumn<quint32>("expected");
+
+    QTest::addRow("unknown")     << 0u    << 5.0f << 2000u << 0u;
+    QTest::addRow("minimum")     << 100u  << 5.0f << 2000u << 2000u;
+    QTest::addRow("factor")      << 1000u << 5.0f << 2000u << 5000u;
+    QTest::addRow("fractional")  << 1000u << 1.5f << 0u    << 1500u;
+    QTest::addRow("max")         << std::numeric_limits<quint32>::max() << 5.0f << 0u
+                                 << (quint32)std::numeric_limits<int>::max();
+}
+
+void TestStallWatchdog::stallTimeout()
+{
+    QFETCH(quint32, interval);
+    QFETCH(float, factor);
+    QFETCH(quint32, minimum);
+    QFETCH(quint32, expected);
+    StallWatchdog watchdog(nullptr);
+    watchdog.setExpectedInterval(interval);
+    watchdog.setStallFactor(factor);
+    watchdog.setMinimumTimeout(minimum);
+    QCOMPARE(watchdog.stallTimeout(), expected);
+}
+
+void TestStallWatchdog::learnedInterval()
+{
+    RecordingService service;
+    StallWatchdog watchdog(&service);
+    QCOMPARE(watchdog.learnedInterval(), (quint32)0);
+
+    // Values are ignored until started.
+    const qint64 start = AbstractPokitServicePrivate::steadyTimestamp();
+    Q_EMIT service.valueReceived(MultimeterService::CharacteristicUuids::reading, start);
+    Q_EMIT service.valueReceived(MultimeterService::CharacteristicUuids::reading, start + 100000000);
+    QCOMPARE(watchdog.learnedInterval(), (quint32)0);
+    QCOMPARE(watchdog.stallTimeout(), (quint32)0);
+
+    // The first value's gap (since start) is not learned, but each consecutive value's is.
+    watchdog.start();
+    const qint64 first = AbstractPokitServicePrivate::steadyTimestamp() + 50000000;
+    Q_EMIT service.valueReceived(MultimeterService::CharacteristicUuids::reading, first);
+    QCOMPARE(watchdog.learnedInterval(), (quint32)0);
+    Q_EMIT service.valueReceived(MultimeterService::CharacteristicUuids::reading, first + 100000000);
+    QCOMPARE(watchdog.learnedInterval(), (quint32)100);
+    Q_EMIT service.valueReceived(MultimeterService::CharacteristicUuids::reading, first + 200000000);
+    QCOMPARE(watchdog.learnedInterval(), (quint32)100);
+
+    // A longer gap moves the average only part of the way.
+    Q_EMIT service.valueReceived(MultimeterService::CharacteristicUuids::reading, first + 500000000);
+    QCOMPARE(watchdog.learnedInterval(), (quint32)125); // 100 + (300 - 100) / 8.
+    QCOMPARE(watchdog.stallTimeout(), (quint32)2000); // Minimum timeout still applies.
+
+    // The expected interval, if set, takes precedence.
+    watchdog.setExpectedInterval(1000);
+    QCOMPARE(watchdog.stallTimeout(), (quint32)5000);
+}
+
+void TestStallWatchdog::start()
+{
+    RecordingService service;
+    StallWatchdog watchdog(&service);
+    QVERIFY(!watchdog.isActive());
+    watchdog.start();
+    QVERIFY(watchdog.isActive());
+    QVERIFY(!watchdog.isStalled());
+    QVERIFY(!watchdog.d_ptr->timer.isActive()); // Interval unknown, so stalls cannot be detected yet.
+
+    watchdog.setExpectedInterval(1000);
+    QVERIFY(watchdog.d_ptr->timer.isActive());
+    QVERIFY(watchdog.d_ptr->timer.remainingTime() <= 5000);
+}
+
+void TestStallWatchdog::stop()
+{
+    RecordingService service;
+    StallWatchdog watchdog(&service);
+    watchdog.setExpectedInterval(1000);
+    watchdog.start();
+    QVERIFY(watchdog.d_ptr->timer.isActive());
+    watchdog.stop();
+    QVERIFY(!watchdog.isActive());
+    QVERIFY(!watchdog.d_ptr->timer.isActive());
+
+    // Values are ignored once stopped.
+    service.receive();
+    QVERIFY(!watchdog.d_ptr->timer.isActive());
+}
+
+void TestStallWatchdog::stall_reenable()
+{
+    RecordingService service;
+    QVERIFY(service.enableReadingNotifications());
+    QTRY_VERIFY(!StallWatchdogPrivate::servicePrivate(&service)->inFlight);
+    service.requests.clear();
+
+    StallWatchdog watchdog(&service);
+    watchdog.setExpectedInterval(10);
+    watchdog.setMinimumTimeout(50);
+    QSignalSpy stalled(&watchdog, &StallWatchdog::stalled);
+    QSignalSpy attempted(&watchdog, &StallWatchdog::recoveryAttempted);
+    watchdog.start();
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^No values received for .*; stalled\\.$"_s));
+    QVERIFY(stalled.wait());
+    QVERIFY(watchdog.isStalled());
+    QCOMPARE(watchdog.stallCount(), (quint64)1);
+    QCOMPARE(service.statistics().stalls, (quint64)1);
+    QVERIFY(stalled.at(0).at(0).toLongLong() >= 45); // Coarse timers may fire up to 5% early.
+
+    // The first recovery attempt re-enables the reading notifications.
+    QCOMPARE(attempted.count(), 1);
+    QCOMPARE(attempted.at(0).at(0).value<StallWatchdog::Action>(), StallWatchdog::Action::ReenableNotifications);
+    QCOMPARE(attempted.at(0).at(1).toInt(), 1);
+    QTRY_COMPARE(service.requests.size(), 2);
+    QCOMPARE(service.requests.at(0).type, AbstractPokitServicePrivate::Request::Type::WriteDescriptor);
+    QCOMPARE(service.requests.at(0).characteristic, MultimeterService::CharacteristicUuids::reading);
+    QCOMPARE(service.requests.at(0).value, QByteArray::fromHex("0000"));
+    QCOMPARE(service.requests.at(1).type, AbstractPokitServicePrivate::Request::Type::WriteDescriptor);
+    QCOMPARE(service.requests.at(1).characteristic, MultimeterService::CharacteristicUuids::reading);
+    QCOMPARE(service.requests.at(1).value, QByteArray::fromHex("0100"));
+    QVERIFY(StallWatchdogPrivate::servicePrivate(&service)->notifyingCharacteristics.contains(
+        MultimeterService::CharacteristicUuids::reading));
+}
+
+void TestStallWatchdog::stall_escalate()
+{
+    RecordingService service;
+    QVERIFY(service.enableReadingNotifications());
+    QVERIFY(StallWatchdogPrivate::servicePrivate(&service)->writeCharacteristic(
+        MultimeterService::CharacteristicUuids::settings, QByteArray::fromHex("010203e8030000")));
+    QTRY_VERIFY(!StallWatchdogPrivate::servicePrivate(&service)->inFlight);
+    service.requests.clear();
+
+    StallWatchdog watchdog(&service); // No device, so cannot reconnect.
+    watchdog.setExpectedInterval(10);
+    watchdog.setMinimumTimeout(50);
+    QSignalSpy attempted(&watchdog, &StallWatchdog::recoveryAttempted);
+    QSignalSpy failed(&watchdog, &StallWatchdog::recoveryFailed);
+    watchdog.start();
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^No values received for .*; stalled\\.$"_s));
+    QTest::ignoreMessage(QtWarningMsg, "All stall recovery actions failed.");
+    QVERIFY(failed.wait(1000));
+    QCOMPARE(attempted.count(), 2);
+    QCOMPARE(attempted.at(0).at(0).value<StallWatchdog::Action>(), StallWatchdog::Action::ReenableNotifications);
+    QCOMPARE(attempted.at(1).at(0).value<StallWatchdog::Action>(), StallWatchdog::Action::RewriteSettings);
+    QCOMPARE(attempted.at(1).at(1).toInt(), 2);
+    QTRY_COMPARE(service.requests.size(), 3);
+    QCOMPARE(service.requests.at(2).type, AbstractPokitServicePrivate::Request::Type::WriteCharacteristic);
+    QCOMPARE(service.requests.at(2).characteristic, MultimeterService::CharacteristicUuids::settings);
+    QCOMPARE(service.requests.at(2).value, QByteArray::fromHex("010203e8030000"));
+
+    // Failure is reported only once per stall.
+    QTest::qWait(200);
+    QCOMPARE(failed.count(), 1);
+    QCOMPARE(attempted.count(), 2);
+    QVERIFY(watchdog.isStalled());
+}
+
+void TestStallWatchdog::stall_recovered()
+{
+    RecordingService service;
+    QVERIFY(service.enableReadingNotifications());
+    StallWatchdog watchdog(&service);
+    watchdog.setExpectedInterval(10);
+    watchdog.setMinimumTimeout(50);
+    QSignalSpy stalled(&watchdog, &StallWatchdog::stalled);
+    QSignalSpy recovered(&watchdog, &StallWatchdog::recovered);
+    watchdog.start();
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^No values received for .*; stalled\\.$"_s));
+    QVERIFY(stalled.wait());
+    QVERIFY(watchdog.isStalled());
+
+    service.receive();
+    QVERIFY(!watchdog.isStalled());
+    QCOMPARE(recovered.count(), 1);
+    QVERIFY(recovered.at(0).at(0).toLongLong() >= 0);
+    QCOMPARE(watchdog.recoveryCount(), (quint64)1);
+    QCOMPARE(service.statistics().stalls, (quint64)1);
+    QCOMPARE(service.statistics().stallRecoveries, (quint64)1);
+    QVERIFY(watchdog.d_ptr->timer.isActive()); // Watching for the next stall.
+    QCOMPARE(watchdog.d_ptr->attempts, 0);
+    QCOMPARE(watchdog.d_ptr->nextAction, 1);
+}
+
+void TestStallWatchdog::stall_notDuringStart()
+{
+    // Values arriving on time never stall.
+    RecordingService service;
+    StallWatchdog watchdog(&service);
+    watchdog.setExpectedInterval(10);
+    watchdog.setMinimumTimeout(100);
+    QSignalSpy stalled(&watchdog, &StallWatchdog::stalled);
+    watchdog.start();
+    for (int count = 0; count < 10; ++count) {
+        QTest::qWait(20);
+        service.receive();
+    }
+    QCOMPARE(stalled.count(), 0);
+    QCOMPARE(watchdog.stallCount(), (quint64)0);
+}
+
+void TestStallWatchdog::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    StallWatchdog watchdog(nullptr);
+    QVERIFY(!watchdog.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestStallWatchdog))
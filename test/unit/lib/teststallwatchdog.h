@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestStallWatchdog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void toString_Action_data();
+    void toString_Action();
+
+    void service();
+    void expectedInterval();
+    void stallFactor();
+    void minimumTimeout();
+
+    void stallTimeout_data();
+    void stallTimeout();
+
+    void learnedInterval();
+
+    void start();
+    void stop();
+
+    void stall_reenable();
+    void stall_escalate();
+    void stall_recovered();
+    void stall_notDuringStart();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
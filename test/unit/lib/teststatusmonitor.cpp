@@ -0,0 +1,298 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "teststatusmonitor.h"
+
+#include <qtpokit/statusmonitor.h>
+#include "statusmonitor_p.h"
+
+#include <QSignalSpy>
+
+#include <limits>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(StatusMonitor::Alert))
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(StatusService::Status))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+StatusService::Status status(const float voltage,
+    const StatusService::BatteryStatus battery = StatusService::BatteryStatus::Good,
+    const std::optional<StatusService::ChargingStatus> charging = std::nullopt,
+    const StatusService::DeviceStatus device = StatusService::DeviceStatus::Idle)
+{
+    return { device, voltage, battery, std::nullopt, charging };
+}
+
+}
+
+void TestStatusMonitor::initTestCase()
+{
+    // Register the types used by StatusMonitor's signals, so QSignalSpy can record their arguments.
+    qRegisterMetaType<StatusMonitor::Alert>("StatusMonitor::Alert");
+    qRegisterMetaType<StatusService::Status>("StatusService::Status");
+}
+
+void TestStatusMonitor::toString_Alert_data()
+{
+    QTest::addColumn<StatusMonitor::Alert>("alert");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(alert, expected) \
+        QTest::addRow(#alert) << StatusMonitor::Alert::alert << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(LowBattery,       "LowBattery");
+    DOKIT_ADD_TEST_ROW(BatteryRecovered, "BatteryRecovered");
+    DOKIT_ADD_TEST_ROW(ChargingChanged,  "ChargingChanged");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (StatusMonitor::Alert)255 << QString();
+}
+
+void TestStatusMonitor::toString_Alert()
+{
+    QFETCH(StatusMonitor::Alert, alert);
+    QFETCH(QString, expected);
+    QCOMPARE(StatusMonitor::toString(alert), expected);
+}
+
+void TestStatusMonitor::service()
+{
+    StatusService service(nullptr);
+    StatusMonitor monitor(&service);
+    QCOMPARE(monitor.service(), &service);
+
+    StatusService other(nullptr);
+    monitor.d_func()->setService(&other);
+    QCOMPARE(monitor.service(), &other);
+    QVERIFY(!QObject::disconnect(&service, nullptr, monitor.d_func(), nullptr));
+
+    // Statuses read by the service are monitored automatically.
+    QSignalSpy spy(&monitor, &StatusMonitor::statusChanged);
+    Q_EMIT other.deviceStatusRead(status(3.9f));
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(monitor.notificationCount(), (quint64)1);
+}
+
+void TestStatusMonitor::coalesceInterval()
+{
+    StatusMonitor monitor(nullptr);
+    QCOMPARE(monitor.coalesceInterval(), 1000u);
+    monitor.setCoalesceInterval(250);
+    QCOMPARE(monitor.coalesceInterval(), 250u);
+
+    // Disabling coalescing flushes any status being held.
+    monitor.addStatus(status(3.9f));
+    monitor.addStatus(status(3.0f));
+    QVERIFY(monitor.d_func()->pendingStatus);
+    monitor.setCoalesceInterval(0);
+    QCOMPARE(monitor.coalesceInterval(), 0u);
+    QVERIFY(!monitor.d_func()->pendingStatus);
+    QCOMPARE(monitor.lastStatus()->batteryVoltage, 3.0f);
+}
+
+void TestStatusMonitor::batteryDeadband()
+{
+    StatusMonitor monitor(nullptr);
+    QCOMPARE(monitor.batteryDeadband(), 0.05f);
+    monitor.setBatteryDeadband(0.1f);
+    QCOMPARE(monitor.batteryDeadband(), 0.1f);
+    monitor.setBatteryDeadband(-1.0f);
+    QCOMPARE(monitor.batteryDeadband(), 0.0f);
+}
+
+void TestStatusMonitor::lowBatteryThreshold()
+{
+    StatusMonitor monitor(nullptr);
+    QVERIFY(qIsNaN(monitor.lowBatteryThreshold()));
+    monitor.setLowBatteryThreshold(3.3f);
+    QCOMPARE(monitor.lowBatteryThreshold(), 3.3f);
+    monitor.setLowBatteryThreshold(0.0f);
+    QVERIFY(qIsNaN(monitor.lowBatteryThreshold()));
+    monitor.setLowBatteryThreshold(std::numeric_limits<float>::infinity());
+    QVERIFY(qIsNaN(monitor.lowBatteryThreshold()));
+}
+
+void TestStatusMonitor::isChanged_data()
+{
+    QTest::addColumn<StatusService::Status>("last");
+    QTest::addColumn<StatusService::Status>("next");
+    QTest::addColumn<bool>("expected");
+
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    using Battery = StatusService::BatteryStatus;
+    using Charging = StatusService::ChargingStatus;
+
+    QTest::addRow("identical")      << status(3.9f) << status(3.9f) << false;
+    QTest::addRow("withinDeadband") << status(3.9f) << status(3.875f) << false;
+    QTest::addRow("beyondDeadband") << status(3.9f) << status(3.8f) << true;
+    QTest::addRow("batteryStatus")  << status(3.9f) << status(3.9f, Battery::Low) << true;
+    QTest::addRow("chargingAdded")  << status(3.9f) << status(3.9f, Battery::Good, Charging::Charging) << true;
+    QTest::addRow("charging")       << status(3.9f, Battery::Good, Charging::Discharging)
+                                    << status(3.9f, Battery::Good, Charging::Charging) << true;
+    QTest::addRow("deviceStatus")   << status(3.9f) << status(3.9f, Battery::Good, std::nullopt,
+                                                              StatusService::DeviceStatus::DsoModeSampling) << true;
+    QTest::addRow("nans")           << status(nan) << status(nan) << false;
+    QTest::addRow("fromNaN")        << status(nan) << status(3.9f) << true;
+    QTest::addRow("toNaN")          << status(3.9f) << status(nan) << true;
+}
+
+void TestStatusMonitor::isChanged()
+{
+    QFETCH(StatusService::Status, last);
+    QFETCH(StatusService::Status, next);
+    QFETCH(bool, expected);
+
+    StatusMonitor monitor(nullptr);
+    QVERIFY(monitor.d_func()->isChanged(last)); // The first status is always a change.
+    monitor.d_func()->lastStatus = last;
+    QCOMPARE(monitor.d_func()->isChanged(next), expected);
+}
+
+void TestStatusMonitor::isBatteryLow_data()
+{
+    QTest::addColumn<float>("threshold");
+    QTest::addColumn<bool>("wasLow");
+    QTest::addColumn<StatusService::Status>("next");
+    QTest::addColumn<bool>("expected");
+
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    using Battery = StatusService::BatteryStatus;
+
+    QTest::addRow("noThreshold")     << nan << false << status(1.0f) << false;
+    QTest::addRow("deviceSaysLow")   << nan << false << status(3.9f, Battery::Low) << true;
+    QTest::addRow("aboveThreshold")  << 3.5f << false << status(3.6f) << false;
+    QTest::addRow("belowThreshold")  << 3.5f << false << status(3.4f) << true;
+    QTest::addRow("hysteresis")      << 3.5f << true << status(3.525f) << true;
+    QTest::addRow("recovered")       << 3.5f << true << status(3.6f) << false;
+    QTest::addRow("nanStaysLow")     << 3.5f << true << status(nan) << true;
+    QTest::addRow("nanIsNotLow")     << 3.5f << false << status(nan) << false;
+}
+
+void TestStatusMonitor::isBatteryLow()
+{
+    QFETCH(float, threshold);
+    QFETCH(bool, wasLow);
+    QFETCH(StatusService::Status, next);
+    QFETCH(bool, expected);
+
+    StatusMonitor monitor(nullptr);
+    monitor.setLowBatteryThreshold(threshold);
+    monitor.d_func()->batteryLow = wasLow;
+    QCOMPARE(monitor.d_func()->isBatteryLow(next), expected);
+}
+
+void TestStatusMonitor::addStatus()
+{
+    StatusMonitor monitor(nullptr);
+    monitor.setCoalesceInterval(0);
+    QSignalSpy spy(&monitor, &StatusMonitor::statusChanged);
+    monitor.addStatus(status(3.9f));
+    monitor.addStatus(status(3.89f));
+    monitor.addStatus(status(3.8f));
+    monitor.addStatus(status(3.8f, StatusService::BatteryStatus::Good, StatusService::ChargingStatus::Charging));
+    QCOMPARE(spy.size(), 3);
+    QCOMPARE(spy.at(0).first().value<StatusService::Status>().batteryVoltage, 3.9f);
+    QCOMPARE(spy.at(1).first().value<StatusService::Status>().batteryVoltage, 3.8f);
+    QVERIFY(spy.at(2).first().value<StatusService::Status>().chargingStatus);
+    QCOMPARE(monitor.notificationCount(), (quint64)4);
+    QCOMPARE(monitor.changeCount(), (quint64)3);
+}
+
+void TestStatusMonitor::addStatus_coalesced()
+{
+    StatusMonitor monitor(nullptr);
+    monitor.setCoalesceInterval(50);
+    QSignalSpy spy(&monitor, &StatusMonitor::statusChanged);
+
+    // The first status is reported straight away, but later ones are coalesced.
+    monitor.addStatus(status(3.9f));
+    QCOMPARE(spy.size(), 1);
+    monitor.addStatus(status(3.5f));
+    monitor.addStatus(status(3.7f));
+    monitor.addStatus(status(3.6f));
+    QCOMPARE(spy.size(), 1);
+    QTRY_COMPARE(spy.size(), 2);
+    QCOMPARE(spy.at(1).first().value<StatusService::Status>().batteryVoltage, 3.6f);
+
+    // Coalesced statuses that end up unchanged are not reported.
+    monitor.addStatus(status(3.2f));
+    monitor.addStatus(status(3.61f));
+    monitor.flush();
+    QCOMPARE(spy.size(), 2);
+    QCOMPARE(monitor.notificationCount(), (quint64)6);
+    QCOMPARE(monitor.changeCount(), (quint64)2);
+
+    // Flushing with nothing held does nothing.
+    monitor.flush();
+    QCOMPARE(spy.size(), 2);
+}
+
+void TestStatusMonitor::addStatus_lowBattery()
+{
+    StatusMonitor monitor(nullptr);
+    monitor.setCoalesceInterval(0);
+    monitor.setLowBatteryThreshold(3.5f);
+    QSignalSpy spy(&monitor, &StatusMonitor::alertRaised);
+    monitor.addStatus(status(3.6f));
+    monitor.addStatus(status(3.45f));
+    monitor.addStatus(status(3.52f)); // Within hysteresis, so still low.
+    monitor.addStatus(status(3.4f));
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(spy.at(0).at(0).value<StatusMonitor::Alert>(), StatusMonitor::Alert::LowBattery);
+    QCOMPARE(spy.at(0).at(1).value<StatusService::Status>().batteryVoltage, 3.45f);
+    QVERIFY(monitor.isBatteryLow());
+
+    monitor.addStatus(status(3.7f));
+    QCOMPARE(spy.size(), 2);
+    QCOMPARE(spy.at(1).at(0).value<StatusMonitor::Alert>(), StatusMonitor::Alert::BatteryRecovered);
+    QVERIFY(!monitor.isBatteryLow());
+}
+
+void TestStatusMonitor::addStatus_charging()
+{
+    using Battery = StatusService::BatteryStatus;
+    using Charging = StatusService::ChargingStatus;
+    StatusMonitor monitor(nullptr);
+    monitor.setCoalesceInterval(0);
+    QSignalSpy spy(&monitor, &StatusMonitor::alertRaised);
+
+    // The first known charging status sets the baseline, without raising an alert.
+    monitor.addStatus(status(3.8f, Battery::Good, Charging::Discharging));
+    monitor.addStatus(status(3.8f, Battery::Good, Charging::Discharging));
+    monitor.addStatus(status(3.8f, Battery::Good, std::nullopt)); // Unknown, so not a change.
+    QCOMPARE(spy.size(), 0);
+    monitor.addStatus(status(3.9f, Battery::Good, Charging::Charging));
+    monitor.addStatus(status(4.1f, Battery::Good, Charging::Charged));
+    QCOMPARE(spy.size(), 2);
+    QCOMPARE(spy.at(0).at(0).value<StatusMonitor::Alert>(), StatusMonitor::Alert::ChargingChanged);
+    QCOMPARE(*spy.at(0).at(1).value<StatusService::Status>().chargingStatus, Charging::Charging);
+    QCOMPARE(*spy.at(1).at(1).value<StatusService::Status>().chargingStatus, Charging::Charged);
+}
+
+void TestStatusMonitor::reset()
+{
+    StatusMonitor monitor(nullptr);
+    monitor.setLowBatteryThreshold(3.5f);
+    monitor.addStatus(status(3.0f));
+    monitor.addStatus(status(3.1f));
+    QVERIFY(monitor.isBatteryLow());
+    QVERIFY(monitor.lastStatus());
+    monitor.reset();
+    QVERIFY(!monitor.isBatteryLow());
+    QVERIFY(!monitor.lastStatus());
+    QVERIFY(!monitor.d_func()->pendingStatus);
+    QVERIFY(!monitor.d_func()->coalesceTimer.isActive());
+    QCOMPARE(monitor.notificationCount(), (quint64)0);
+    QCOMPARE(monitor.changeCount(), (quint64)0);
+}
+
+void TestStatusMonitor::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    StatusMonitor monitor(nullptr);
+    QVERIFY(!monitor.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestStatusMonitor))
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestStatusMonitor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void toString_Alert_data();
+    void toString_Alert();
+
+    void service();
+    void coalesceInterval();
+    void batteryDeadband();
+    void lowBatteryThreshold();
+
+    void isChanged_data();
+    void isChanged();
+
+    void isBatteryLow_data();
+    void isBatteryLow();
+
+    void addStatus();
+    void addStatus_coalesced();
+    void addStatus_lowBattery();
+    void addStatus_charging();
+
+    void reset();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
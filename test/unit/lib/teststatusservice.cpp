@@ -253,6 +253,9 @@ void TestStatusService::enableStatusNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     StatusService service(nullptr);
     QVERIFY(!service.enableStatusNotifications());
+    const QFuture<bool> future = service.enableStatusNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestStatusService::disableStatusNotifications()
@@ -260,6 +263,9 @@ void TestStatusService::disableStatusNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     StatusService service(nullptr);
     QVERIFY(!service.disableStatusNotifications());
+    const QFuture<bool> future = service.disableStatusNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestStatusService::deviceName()
@@ -302,6 +308,9 @@ void TestStatusService::enableTorchStatusNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     StatusService service(nullptr);
     QVERIFY(!service.enableTorchStatusNotifications());
+    const QFuture<bool> future = service.enableTorchStatusNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestStatusService::disableTorchStatusNotifications()
@@ -309,6 +318,9 @@ void TestStatusService::disableTorchStatusNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     StatusService service(nullptr);
     QVERIFY(!service.disableTorchStatusNotifications());
+    const QFuture<bool> future = service.disableTorchStatusNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestStatusService::buttonPress()
@@ -323,6 +335,9 @@ void TestStatusService::enableButtonPressedNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     StatusService service(nullptr);
     QVERIFY(!service.enableButtonPressedNotifications());
+    const QFuture<bool> future = service.enableButtonPressedNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestStatusService::disableButtonPressedNotifications()
@@ -330,6 +345,9 @@ void TestStatusService::disableButtonPressedNotifications()
     // Verify safe error handling (can't do much else without a Bluetooth device).
     StatusService service(nullptr);
     QVERIFY(!service.disableButtonPressedNotifications());
+    const QFuture<bool> future = service.disableButtonPressedNotificationsAsync();
+    QVERIFY(future.isFinished());
+    QVERIFY(!future.result());
 }
 
 void TestStatusService::parseDeviceCharacteristics_data()
@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testthreadpolicy.h"
+#include "../stringliterals_p.h"
+
+#include <qtpokit/threadpolicy.h>
+
+#include <thread>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(ThreadPolicy)::Priority)
+
+QTPOKIT_BEGIN_NAMESPACE
+DOKIT_USE_STRINGLITERALS
+
+/// Returns the result of applying \a settings to a new thread, so the test's own thread is left unchanged.
+static ThreadPolicy::State applyOnNewThread(const ThreadPolicy::Settings &settings)
+{
+    ThreadPolicy::State state;
+    std::thread thread([&state, &settings]() { state = ThreadPolicy::apply(settings); });
+    thread.join();
+    return state;
+}
+
+void TestThreadPolicy::toString_data()
+{
+    QTest::addColumn<ThreadPolicy::Priority>("priority");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(priority, expected) \
+        QTest::addRow(#priority) << ThreadPolicy::Priority::priority << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(Normal,   "normal");
+    DOKIT_ADD_TEST_ROW(High,     "high");
+    DOKIT_ADD_TEST_ROW(Realtime, "realtime");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (ThreadPolicy::Priority)255 << QString();
+}
+
+void TestThreadPolicy::toString()
+{
+    QFETCH(ThreadPolicy::Priority, priority);
+    QFETCH(QString, expected);
+    QCOMPARE(ThreadPolicy::toString(priority), expected);
+}
+
+void TestThreadPolicy::parseCpus_data()
+{
+    QTest::addColumn<QString>("list");
+    QTest::addColumn<QVector<int>>("expected");
+    QTest::addColumn<bool>("ok");
+
+    QTest::addRow("single")     << u"3"_s         << QVector<int>{ 3 }          << true;
+    QTest::addRow("list")       << u"0,2"_s       << QVector<int>{ 0, 2 }       << true;
+    QTest::addRow("range")      << u"2-4"_s       << QVector<int>{ 2, 3, 4 }    << true;
+    QTest::addRow("mixed")      << u"6, 0-1,3"_s  << QVector<int>{ 0, 1, 3, 6 } << true;
+    QTest::addRow("duplicates") << u"1,0-2,1"_s   << QVector<int>{ 0, 1, 2 }    << true;
+    QTest::addRow("empty")      << QString()      << QVector<int>{ }            << false;
+    QTest::addRow("blank")      << u" "_s         << QVector<int>{ }            << false;
+    QTest::addRow("negative")   << u"-1"_s        << QVector<int>{ }            << false;
+    QTest::addRow("reversed")   << u"4-2"_s       << QVector<int>{ }            << false;
+    QTest::addRow("openRange")  << u"2-"_s        << QVector<int>{ }            << false;
+    QTest::addRow("twoDashes")  << u"1-2-3"_s     << QVector<int>{ }            << false;
+    QTest::addRow("emptyItem")  << u"1,,2"_s      << QVector<int>{ }            << false;
+    QTest::addRow("notANumber") << u"one"_s       << QVector<int>{ }            << false;
+    QTest::addRow("tooLarge")   << u"4096"_s      << QVector<int>{ }            << false;
+}
+
+void TestThreadPolicy::parseCpus()
+{
+    QFETCH(QString, list);
+    QFETCH(QVector<int>, expected);
+    QFETCH(bool, ok);
+    bool parsed = !ok;
+    QCOMPARE(ThreadPolicy::parseCpus(list, &parsed), expected);
+    QCOMPARE(parsed, ok);
+    QCOMPARE(ThreadPolicy::parseCpus(list), expected); // And without ok.
+}
+
+void TestThreadPolicy::formatCpus_data()
+{
+    QTest::addColumn<QVector<int>>("cpus");
+    QTest::addColumn<QString>("expected");
+
+    QTest::addRow("empty")  << QVector<int>{ }                   << QString();
+    QTest::addRow("single") << QVector<int>{ 3 }                 << u"3"_s;
+    QTest::addRow("list")   << QVector<int>{ 0, 2 }              << u"0,2"_s;
+    QTest::addRow("range")  << QVector<int>{ 2, 3, 4 }           << u"2-4"_s;
+    QTest::addRow("mixed")  << QVector<int>{ 0, 1, 3, 5, 6, 7 }  << u"0-1,3,5-7"_s;
+}
+
+void TestThreadPolicy::formatCpus()
+{
+    QFETCH(QVector<int>, cpus);
+    QFETCH(QString, expected);
+    QCOMPARE(ThreadPolicy::formatCpus(cpus), expected);
+    if (!cpus.isEmpty()) {
+        QCOMPARE(ThreadPolicy::parseCpus(expected), cpus); // Round-trip.
+    }
+}
+
+void TestThreadPolicy::current()
+{
+    const ThreadPolicy::State state = ThreadPolicy::current();
+    QVERIFY(!state.applied);
+    QVERIFY(state.errors.isEmpty());
+    #if defined(Q_OS_LINUX)
+    QVERIFY(!state.cpus.isEmpty()); // Linux reports every thread's CPU affinity.
+    #endif
+}
+
+void TestThreadPolicy::apply_normal()
+{
+    const ThreadPolicy::State before = ThreadPolicy::current();
+    const ThreadPolicy::State state = applyOnNewThread(ThreadPolicy::Settings{});
+    QVERIFY(state.applied);
+    QVERIFY(state.errors.isEmpty());
+    QCOMPARE(state.cpus, before.cpus); // New threads inherit their creator's affinity.
+}
+
+void TestThreadPolicy::apply_cpus()
+{
+    const QVector<int> available = ThreadPolicy::current().cpus;
+    if (available.isEmpty()) {
+        QSKIP("This platform does not report threads' CPU affinities.");
+    }
+    const ThreadPolicy::State state = applyOnNewThread({ { available.constLast() } });
+    QVERIFY(state.applied);
+    QVERIFY2(state.errors.isEmpty(), qUtf8Printable(state.errors.join(u'\n')));
+    QCOMPARE(state.cpus, QVector<int>{ available.constLast() });
+    QCOMPARE(ThreadPolicy::current().cpus, available); // This thread is unchanged.
+}
+
+void TestThreadPolicy::apply_priority_data()
+{
+    QTest::addColumn<ThreadPolicy::Priority>("priority");
+    QTest::addRow("high")     << ThreadPolicy::Priority::High;
+    QTest::addRow("realtime") << ThreadPolicy::Priority::Realtime;
+}
+
+void TestThreadPolicy::apply_priority()
+{
+    QFETCH(ThreadPolicy::Priority, priority);
+    ThreadPolicy::Settings settings;
+    settings.priority = priority;
+    settings.realtimePriority = 1;
+    const ThreadPolicy::State state = applyOnNewThread(settings);
+    QVERIFY(state.applied);
+
+    // Elevated priorities typically require privileges, so either the priority was applied, or the reason not.
+    if (state.errors.isEmpty()) {
+        QCOMPARE(state.priority, priority);
+        #if defined(Q_OS_UNIX)
+        QCOMPARE(state.realtimePriority, (priority == ThreadPolicy::Priority::Realtime) ? 1 : 0);
+        #endif
+    } else {
+        QCOMPARE(state.errors.size(), 1);
+        QCOMPARE(state.priority, ThreadPolicy::Priority::Normal);
+    }
+}
+
+void TestThreadPolicy::tr()
+{
+    // Exercise the inline tr() function (added by the Q_DECLARE_TR_FUNCTIONS macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    QVERIFY(!ThreadPolicy::tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestThreadPolicy))
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestThreadPolicy : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toString_data();
+    void toString();
+
+    void parseCpus_data();
+    void parseCpus();
+
+    void formatCpus_data();
+    void formatCpus();
+
+    void current();
+
+    void apply_normal();
+    void apply_cpus();
+    void apply_priority_data();
+    void apply_priority();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
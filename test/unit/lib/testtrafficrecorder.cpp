@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testtrafficrecorder.h"
+
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitsimulator.h>
+#include <qtpokit/trafficrecorder.h>
+#include "abstractpokitservice_p.h"
+#include "trafficrecorder_p.h"
+#include "trafficreplayer_p.h"
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+
+Q_DECLARE_METATYPE(QTPOKIT_PREPEND_NAMESPACE(TrafficRecorder::Operation))
+
+QTPOKIT_BEGIN_NAMESPACE
+
+void TestTrafficRecorder::toString_Operation_data()
+{
+    QTest::addColumn<TrafficRecorder::Operation>("operation");
+    QTest::addColumn<QString>("expected");
+    #define DOKIT_ADD_TEST_ROW(operation, expected) \
+        QTest::addRow(#operation) << TrafficRecorder::Operation::operation << QStringLiteral(expected)
+    DOKIT_ADD_TEST_ROW(Read,   "Read");
+    DOKIT_ADD_TEST_ROW(Write,  "Write");
+    DOKIT_ADD_TEST_ROW(Notify, "Notify");
+    #undef DOKIT_ADD_TEST_ROW
+    QTest::addRow("invalid") << (TrafficRecorder::Operation)3 << QString();
+}
+
+void TestTrafficRecorder::toString_Operation()
+{
+    QFETCH(TrafficRecorder::Operation, operation);
+    QFETCH(QString, expected);
+    QCOMPARE(TrafficRecorder::toString(operation), expected);
+}
+
+void TestTrafficRecorder::fileName()
+{
+    const TrafficRecorder recorder(QStringLiteral("example.dokt"));
+    QCOMPARE(recorder.fileName(), QStringLiteral("example.dokt"));
+}
+
+void TestTrafficRecorder::addService()
+{
+    PokitDevice device(nullptr);
+    AbstractPokitServicePrivate * const service = TrafficRecorderPrivate::servicePrivate(device.dso());
+    QVERIFY(!service->trafficHandler);
+    {
+        TrafficRecorder recorder(QStringLiteral("example.dokt"));
+        recorder.addService(nullptr); // Ignored.
+        recorder.addService(device.dso());
+        recorder.addService(device.dso()); // Ignored, since already added.
+        QVERIFY(service->trafficHandler);
+        QCOMPARE((int)recorder.d_func()->services.size(), 1);
+    }
+    QVERIFY(!service->trafficHandler); // Removed by the recorder's destructor.
+}
+
+void TestTrafficRecorder::removeService()
+{
+    PokitDevice device(nullptr);
+    AbstractPokitServicePrivate * const service = TrafficRecorderPrivate::servicePrivate(device.dso());
+    TrafficRecorder recorder(QStringLiteral("example.dokt"));
+    recorder.addService(device.dso());
+    QVERIFY(service->trafficHandler);
+    recorder.removeService(device.multimeter()); // Ignored, since never added.
+    QVERIFY(service->trafficHandler);
+    recorder.removeService(device.dso());
+    QVERIFY(!service->trafficHandler);
+    QVERIFY(recorder.d_func()->services.isEmpty());
+}
+
+void TestTrafficRecorder::start()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TrafficRecorder recorder(dir.filePath(QStringLiteral("traffic.dokt")));
+    QVERIFY(!recorder.isRecording());
+    QVERIFY(recorder.start());
+    QVERIFY(recorder.isRecording());
+    QVERIFY(recorder.start()); // Already recording.
+    QCOMPARE(recorder.recordCount(), (quint64)0);
+    recorder.stop();
+
+    QFile file(recorder.fileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("DOKT\x01\x00\x00\x00", 8));
+}
+
+void TestTrafficRecorder::start_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TrafficRecorder recorder(dir.filePath(QStringLiteral("missing/traffic.dokt")));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Failed to open recording ")));
+    QVERIFY(!recorder.start());
+    QVERIFY(!recorder.isRecording());
+}
+
+void TestTrafficRecorder::stop()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TrafficRecorder recorder(dir.filePath(QStringLiteral("traffic.dokt")));
+    recorder.stop(); // Does nothing, since not recording.
+    QVERIFY(recorder.start());
+    recorder.d_func()->record(TrafficRecorder::Operation::Notify, QBluetoothUuid(quint16(1)), "abc", 1000);
+    QCOMPARE(recorder.recordCount(), (quint64)1);
+    recorder.stop();
+    QVERIFY(!recorder.isRecording());
+
+    // Once stopped, traffic is no longer recorded.
+    recorder.d_func()->record(TrafficRecorder::Operation::Notify, QBluetoothUuid(quint16(1)), "abc", 2000);
+    QCOMPARE(recorder.recordCount(), (quint64)1);
+    QCOMPARE(QFile(recorder.fileName()).size(), 8 + 24 + 3);
+}
+
+void TestTrafficRecorder::encodeRecord()
+{
+    TrafficRecorder recorder(QStringLiteral("example.dokt"));
+    TrafficRecorderPrivate * const d = recorder.d_func();
+    const QBluetoothUuid first = MultimeterService::CharacteristicUuids::reading;
+    const QBluetoothUuid second = MultimeterService::CharacteristicUuids::settings;
+
+    // The first record for each characteristic defines it, by UUID.
+    QCOMPARE(d->encodeRecord(TrafficRecorder::Operation::Notify, first, "abc", 5000),
+             QByteArray("\x02\x00", 2) + first.toRfc4122() + QByteArray("\x00\x00\x00\x00\x03\x00" "abc", 9));
+    QCOMPARE(d->encodeRecord(TrafficRecorder::Operation::Read, first, QByteArray(), 5000 + 1500000),
+             QByteArray("\x00\x00\xDC\x05\x00\x00\x00\x00", 8)); // 1500us after the first.
+    QCOMPARE(d->encodeRecord(TrafficRecorder::Operation::Write, second, "x", 5000 + 2500000),
+             QByteArray("\x01\x01", 2) + second.toRfc4122() + QByteArray("\xE8\x03\x00\x00\x01\x00" "x", 7));
+
+    // Timestamps never go backwards.
+    QCOMPARE(d->encodeRecord(TrafficRecorder::Operation::Notify, second, "y", 0),
+             QByteArray("\x02\x01\x00\x00\x00\x00\x01\x00" "y", 9));
+    QCOMPARE(d->characteristics, (QVector<QBluetoothUuid>{ first, second }));
+    QCOMPARE(d->lastOffset, (qint64)2500);
+}
+
+void TestTrafficRecorder::encodeRecord_tooMany()
+{
+    TrafficRecorder recorder(QStringLiteral("example.dokt"));
+    TrafficRecorderPrivate * const d = recorder.d_func();
+    for (int index = 0; index < TrafficRecorderPrivate::maxCharacteristics; ++index) {
+        QVERIFY(!d->encodeRecord(TrafficRecorder::Operation::Notify, QBluetoothUuid((quint16)index), "a", 0)
+            .isEmpty());
+    }
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Too many characteristics to record: ")));
+    QVERIFY(d->encodeRecord(TrafficRecorder::Operation::Notify, QBluetoothUuid((quint16)999), "a", 0).isEmpty());
+    QVERIFY(!d->encodeRecord(TrafficRecorder::Operation::Notify, QBluetoothUuid((quint16)1), "a", 0).isEmpty());
+}
+
+void TestTrafficRecorder::record()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    PokitDevice device(nullptr);
+    PokitSimulator simulator(&device);
+    simulator.setProfile(PokitSimulator::Stream::Multimeter, { 1, 0, 0, 0.0f });
+    TrafficRecorder recorder(dir.filePath(QStringLiteral("traffic.dokt")));
+    recorder.addService(device.multimeter());
+    QVERIFY(recorder.start());
+    simulator.start();
+
+    MultimeterService * const service = device.multimeter();
+    int readings = 0;
+    connect(service, &MultimeterService::readingRead, this, [&readings]() { ++readings; });
+    QVERIFY(service->setSettings({ MultimeterService::Mode::DcCurrent, 255, 1000 }));
+    QVERIFY(service->enableReadingNotifications());
+    QTRY_VERIFY(readings >= 3);
+    simulator.stop();
+    recorder.stop();
+    QCOMPARE(recorder.recordCount(), (quint64)readings + 1);
+
+    QFile file(recorder.fileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const auto records = TrafficReplayerPrivate::parseRecords(file.readAll());
+    QVERIFY(records);
+    QCOMPARE((int)records->size(), readings + 1);
+    QCOMPARE(records->at(0).operation, TrafficRecorder::Operation::Write);
+    QCOMPARE(records->at(0).characteristic, MultimeterService::CharacteristicUuids::settings);
+    QCOMPARE((int)records->at(0).value.size(), 6);
+    QCOMPARE(records->at(0).timestamp, (qint64)0);
+    for (int index = 1; index < records->size(); ++index) {
+        QCOMPARE(records->at(index).operation, TrafficRecorder::Operation::Notify);
+        QCOMPARE(records->at(index).characteristic, MultimeterService::CharacteristicUuids::reading);
+        QCOMPARE((int)records->at(index).value.size(), 7);
+        QVERIFY(records->at(index).timestamp >= records->at(index - 1).timestamp);
+    }
+}
+
+void TestTrafficRecorder::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    TrafficRecorder recorder(QString{});
+    QVERIFY(!recorder.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestTrafficRecorder))
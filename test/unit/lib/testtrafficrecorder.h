@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestTrafficRecorder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toString_Operation_data();
+    void toString_Operation();
+
+    void fileName();
+    void addService();
+    void removeService();
+
+    void start();
+    void start_invalid();
+    void stop();
+
+    void encodeRecord();
+    void encodeRecord_tooMany();
+
+    void record();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE
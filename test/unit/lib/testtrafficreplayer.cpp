@@ -0,0 +1,349 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "testtrafficreplayer.h"
+
+#include <qtpokit/deviceinfoservice.h>
+#include <qtpokit/dsoservice.h>
+#include <qtpokit/multimeterservice.h>
+#include <qtpokit/pokitdevice.h>
+#include <qtpokit/pokitsimulator.h>
+#include <qtpokit/trafficrecorder.h>
+#include <qtpokit/trafficreplayer.h>
+#include "abstractpokitservice_p.h"
+#include "trafficrecorder_p.h"
+#include "trafficreplayer_p.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <optional>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+namespace {
+
+/// A DC voltage multimeter `Reading` value, of 1 volt.
+const QByteArray readingValue("\x00\x00\x00\x80\x3F\x01\x00", 7);
+
+/// Returns a recording of \a records, as written by TrafficRecorder.
+QByteArray recording(const QVector<TrafficRecorder::Record> &records)
+{
+    TrafficRecorderPrivate recorder(nullptr);
+    QByteArray data("DOKT\x01\x00\x00\x00", 8);
+    for (const TrafficRecorder::Record &record: records) {
+        data += recorder.encodeRecord(record.operation, record.characteristic, record.value, record.timestamp);
+    }
+    return data;
+}
+
+/// Writes \a data to \a fileName, and returns \c true on success.
+bool writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(fileName);
+    return (file.open(QIODevice::WriteOnly)) && (file.write(data) == data.size());
+}
+
+}
+
+void TestTrafficReplayer::fileName()
+{
+    const TrafficReplayer replayer(QStringLiteral("example.dokt"));
+    QCOMPARE(replayer.fileName(), QStringLiteral("example.dokt"));
+}
+
+void TestTrafficReplayer::pacing()
+{
+    TrafficReplayer replayer(QStringLiteral("example.dokt"));
+    QCOMPARE(replayer.pacing(), TrafficReplayer::Pacing::Recorded);
+    replayer.setPacing(TrafficReplayer::Pacing::AsFastAsPossible);
+    QCOMPARE(replayer.pacing(), TrafficReplayer::Pacing::AsFastAsPossible);
+}
+
+void TestTrafficReplayer::addService()
+{
+    PokitDevice device(nullptr);
+    TrafficReplayer replayer(QStringLiteral("example.dokt"));
+    replayer.addService(nullptr); // Ignored.
+    replayer.addService(device.dso());
+    replayer.addService(device.dso()); // Ignored, since already added.
+    replayer.addService(device.multimeter());
+    QCOMPARE((int)replayer.d_func()->services.size(), 2);
+    replayer.removeService(device.dso());
+    QCOMPARE((int)replayer.d_func()->services.size(), 1);
+    QCOMPARE(replayer.d_func()->services.at(0).data(), device.multimeter());
+}
+
+void TestTrafficReplayer::load()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("traffic.dokt"));
+    QVERIFY(writeFile(fileName, recording({
+        { TrafficRecorder::Operation::Write, MultimeterService::CharacteristicUuids::settings, "abcdef", 0 },
+        { TrafficRecorder::Operation::Notify, MultimeterService::CharacteristicUuids::reading, readingValue, 2000000 },
+    })));
+
+    TrafficReplayer replayer(fileName);
+    QVERIFY(replayer.records().isEmpty());
+    QVERIFY(replayer.load());
+    const QVector<TrafficRecorder::Record> records = replayer.records();
+    QCOMPARE((int)records.size(), 2);
+    QCOMPARE(records.at(0).operation, TrafficRecorder::Operation::Write);
+    QCOMPARE(records.at(0).characteristic, MultimeterService::CharacteristicUuids::settings);
+    QCOMPARE(records.at(0).value, QByteArray("abcdef"));
+    QCOMPARE(records.at(0).timestamp, (qint64)0);
+    QCOMPARE(records.at(1).operation, TrafficRecorder::Operation::Notify);
+    QCOMPARE(records.at(1).characteristic, MultimeterService::CharacteristicUuids::reading);
+    QCOMPARE(records.at(1).value, readingValue);
+    QCOMPARE(records.at(1).timestamp, (qint64)2000000);
+}
+
+void TestTrafficReplayer::load_invalid()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TrafficReplayer missing(dir.filePath(QStringLiteral("missing.dokt")));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Failed to open recording ")));
+    QVERIFY(!missing.load());
+
+    const QString fileName = dir.filePath(QStringLiteral("invalid.dokt"));
+    QVERIFY(writeFile(fileName, "not a recording"));
+    TrafficReplayer invalid(fileName);
+    QTest::ignoreMessage(QtWarningMsg, "Not a traffic recording.");
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Failed to read recording ")));
+    QVERIFY(!invalid.load());
+}
+
+void TestTrafficReplayer::parseRecords_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("expected"); // Number of records, or -1 for invalid.
+    QTest::addColumn<QString>("warning");
+
+    const QByteArray valid = recording({
+        { TrafficRecorder::Operation::Notify, MultimeterService::CharacteristicUuids::reading, readingValue, 0 },
+        { TrafficRecorder::Operation::Read, MultimeterService::CharacteristicUuids::reading, readingValue, 1000 },
+    });
+    QTest::addRow("empty") << QByteArray() << -1 << QStringLiteral("Not a traffic recording.");
+    QTest::addRow("magic") << QByteArray("DOKA\x01\x00\x00\x00", 8) << -1
+                           << QStringLiteral("Not a traffic recording.");
+    QTest::addRow("version") << QByteArray("DOKT\x02\x00\x00\x00", 8) << -1
+                             << QStringLiteral("Unsupported recording version: 2");
+    QTest::addRow("header") << valid.left(8) << 0 << QString();
+    QTest::addRow("valid") << valid << 2 << QString();
+    QTest::addRow("incomplete") << valid.left(valid.size() - 1) << 1
+                                << QStringLiteral("Ignoring incomplete record at offset 39");
+    QTest::addRow("operation") << (valid + QByteArray("\x03\x00\x00\x00\x00\x00\x00\x00", 8)) << -1
+                               << QStringLiteral("Invalid record at offset 54");
+    QTest::addRow("index") << (valid + QByteArray("\x02\x02\x00\x00\x00\x00\x00\x00", 8)) << -1
+                           << QStringLiteral("Invalid record at offset 54");
+}
+
+void TestTrafficReplayer::parseRecords()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, expected);
+    QFETCH(QString, warning);
+    if (!warning.isEmpty()) {
+        QTest::ignoreMessage(QtWarningMsg, warning.toUtf8());
+    }
+    const auto records = TrafficReplayerPrivate::parseRecords(data);
+    QCOMPARE((records) ? (int)records->size() : -1, expected);
+}
+
+void TestTrafficReplayer::start()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    TrafficReplayer missing(dir.filePath(QStringLiteral("missing.dokt")));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Failed to open recording ")));
+    QVERIFY(!missing.start());
+    QVERIFY(!missing.isReplaying());
+
+    const QString fileName = dir.filePath(QStringLiteral("traffic.dokt"));
+    QVERIFY(writeFile(fileName, recording({
+        { TrafficRecorder::Operation::Notify, MultimeterService::CharacteristicUuids::reading, readingValue, 0 },
+    })));
+    PokitDevice device(nullptr);
+    TrafficReplayer replayer(fileName);
+    replayer.addService(device.multimeter());
+    QSignalSpy discovered(device.multimeter(), &AbstractPokitService::serviceDetailsDiscovered);
+    QSignalSpy finished(&replayer, &TrafficReplayer::finished);
+    QVERIFY(replayer.start());
+    QVERIFY(replayer.isReplaying());
+    QVERIFY(replayer.start()); // Already replaying.
+    QVERIFY(TrafficReplayerPrivate::servicePrivate(device.multimeter())->requestHandler);
+    QCOMPARE(discovered.count(), 0); // Asynchronously, as for real devices.
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(discovered.count(), 1);
+    QVERIFY(!replayer.isReplaying());
+    QVERIFY(!TrafficReplayerPrivate::servicePrivate(device.multimeter())->requestHandler);
+    QCOMPARE(replayer.replayedCount(), (quint64)1);
+    QCOMPARE(replayer.skippedCount(), (quint64)0);
+}
+
+void TestTrafficReplayer::stop()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("traffic.dokt"));
+    QVERIFY(writeFile(fileName, recording({
+        { TrafficRecorder::Operation::Notify, MultimeterService::CharacteristicUuids::reading, readingValue,
+          60000000000LL },
+    })));
+    PokitDevice device(nullptr);
+    TrafficReplayer replayer(fileName);
+    MultimeterService * const service = device.multimeter();
+    replayer.addService(service);
+    replayer.stop(); // Does nothing, since not replaying.
+    QVERIFY(replayer.start());
+
+    // Requests are acknowledged while replaying.
+    QSignalSpy finished(service, &AbstractPokitService::requestFinished);
+    QVERIFY(service->setSettings({ MultimeterService::Mode::DcVoltage, 255, 1000 }));
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(finished.at(0).at(1).toBool(), true);
+
+    replayer.stop();
+    QVERIFY(!replayer.isReplaying());
+    QVERIFY(!TrafficReplayerPrivate::servicePrivate(service)->requestHandler);
+    QCOMPARE(replayer.replayedCount(), (quint64)0); // The only record was not due for another minute.
+}
+
+void TestTrafficReplayer::replay_asFastAsPossible()
+{
+    QVector<TrafficRecorder::Record> records{
+        { TrafficRecorder::Operation::Write, MultimeterService::CharacteristicUuids::settings, "abcdef", 0 },
+    };
+    for (int index = 0; index < 600; ++index) {
+        records.append({ TrafficRecorder::Operation::Notify, MultimeterService::CharacteristicUuids::reading,
+                         readingValue, index * 1000000000LL });
+    }
+    records.append({ TrafficRecorder::Operation::Read, DeviceInfoService::CharacteristicUuids::modelNumber, "x",
+                     600000000000LL });
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("traffic.dokt"));
+    QVERIFY(writeFile(fileName, recording(records)));
+
+    PokitDevice device(nullptr);
+    MultimeterService * const service = device.multimeter();
+    QVector<float> values;
+    connect(service, &MultimeterService::readingRead, this, [&values](const MultimeterService::Reading &reading) {
+        values.append(reading.value);
+    });
+    TrafficReplayer replayer(fileName);
+    replayer.setPacing(TrafficReplayer::Pacing::AsFastAsPossible);
+    replayer.addService(service);
+    QSignalSpy finished(&replayer, &TrafficReplayer::finished);
+    QVERIFY(replayer.start());
+
+    // Records are replayed in batches, regardless of their recorded times.
+    replayer.d_func()->tick();
+    QCOMPARE(replayer.replayedCount() + replayer.skippedCount(), (quint64)TrafficReplayerPrivate::batchSize);
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE((int)values.size(), 600);
+    QCOMPARE(values.first(), 1.0f);
+    QCOMPARE(replayer.replayedCount(), (quint64)600);
+    QCOMPARE(replayer.skippedCount(), (quint64)2); // The settings write, and the unhandled model number read.
+    QCOMPARE(service->statistics().values, (quint64)600);
+}
+
+void TestTrafficReplayer::replay_recorded()
+{
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("traffic.dokt"));
+    const QBluetoothUuid uuid = MultimeterService::CharacteristicUuids::reading;
+    QVERIFY(writeFile(fileName, recording({
+        { TrafficRecorder::Operation::Notify, uuid, readingValue, 0 },
+        { TrafficRecorder::Operation::Notify, uuid, readingValue, 50000000 },  // 50ms.
+        { TrafficRecorder::Operation::Notify, uuid, readingValue, 100000000 }, // 100ms.
+    })));
+
+    PokitDevice device(nullptr);
+    TrafficReplayer replayer(fileName);
+    replayer.addService(device.multimeter());
+    QSignalSpy finished(&replayer, &TrafficReplayer::finished);
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(replayer.start());
+
+    // Only records already due are replayed.
+    replayer.d_func()->tick();
+    QCOMPARE(replayer.replayedCount(), (quint64)1);
+    QTRY_COMPARE(finished.count(), 1);
+    QVERIFY(timer.elapsed() >= 100);
+    QCOMPARE(replayer.replayedCount(), (quint64)3);
+}
+
+void TestTrafficReplayer::replay_recording()
+{
+    // Record a simulated DSO capture.
+    const QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("traffic.dokt"));
+    {
+        PokitDevice device(nullptr);
+        PokitSimulator simulator(&device);
+        simulator.setProfile(PokitSimulator::Stream::Dso, { 0, 0, 100, 0.0f });
+        TrafficRecorder recorder(fileName);
+        recorder.addService(device.dso());
+        QVERIFY(recorder.start());
+        simulator.start();
+        int samples = 0;
+        connect(device.dso(), &DsoService::samplesRead, this, [&samples](const DsoService::Samples &values) {
+            samples += (int)values.size();
+        });
+        QVERIFY(device.dso()->setSettings({ DsoService::Command::FreeRunning, 0.0f, DsoService::Mode::AcVoltage,
+                                            255, 1000, 1000 }));
+        QVERIFY(device.dso()->enableMetadataNotifications());
+        QVERIFY(device.dso()->enableReadingNotifications());
+        QTRY_COMPARE(samples, 1000);
+    }
+
+    // Then replay it, through another device's DSO service.
+    PokitDevice device(nullptr);
+    std::optional<DsoService::Metadata> metadata;
+    int samples = 0;
+    connect(device.dso(), &DsoService::metadataRead, this, [&metadata](const DsoService::Metadata &meta) {
+        metadata = meta;
+    });
+    connect(device.dso(), &DsoService::samplesRead, this, [&samples](const DsoService::Samples &values) {
+        samples += (int)values.size();
+    });
+    TrafficReplayer replayer(fileName);
+    replayer.setPacing(TrafficReplayer::Pacing::AsFastAsPossible);
+    replayer.addService(device.dso());
+    QSignalSpy finished(&replayer, &TrafficReplayer::finished);
+    QVERIFY(replayer.start());
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(samples, 1000);
+    QVERIFY(metadata);
+    QCOMPARE(metadata->mode, DsoService::Mode::AcVoltage);
+    QCOMPARE(metadata->numberOfSamples, (quint16)1000);
+    const QVector<TrafficRecorder::Record> records = replayer.records();
+    const auto writes = std::count_if(records.cbegin(), records.cend(), [](const TrafficRecorder::Record &record) {
+        return record.operation == TrafficRecorder::Operation::Write;
+    });
+    QCOMPARE((int)writes, 1); // The settings write.
+    QCOMPARE(replayer.skippedCount(), (quint64)writes);
+    QCOMPARE(replayer.replayedCount(), (quint64)(records.size() - writes)); // Metadata, and samples, notifications.
+}
+
+void TestTrafficReplayer::tr()
+{
+    // Exercise the inline tr() function (added by the Q_OBJECT macro) to avoid false negatives in
+    // test coverage.  There is no need to actually test tr() here, since its part of the Qt API.
+    TrafficReplayer replayer(QString{});
+    QVERIFY(!replayer.tr("ignored").isEmpty());
+}
+
+QTPOKIT_END_NAMESPACE
+
+QTEST_MAIN(QTPOKIT_PREPEND_NAMESPACE(TestTrafficReplayer))
@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2022-2025 Paul Colby <git@colby.id.au>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <qtpokit/qtpokit_global.h>
+
+#include <QTest>
+
+QTPOKIT_BEGIN_NAMESPACE
+
+class TestTrafficReplayer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fileName();
+    void pacing();
+    void addService();
+
+    void load();
+    void load_invalid();
+
+    void parseRecords_data();
+    void parseRecords();
+
+    void start();
+    void stop();
+
+    void replay_asFastAsPossible();
+    void replay_recorded();
+    void replay_recording();
+
+    void tr();
+};
+
+QTPOKIT_END_NAMESPACE